@@ -0,0 +1,162 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <nlohmann/json.hpp>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Helpers for the JSON reports of the benchmarks, see compare_reports.py for the consumer.
+//
+// A report looks like
+// {
+//   "schema_version": 1,
+//   "benchmark": "<name of the binary>",
+//   "fingerprint": {<engine config and files, see makeEngineFingerprint>},
+//   "options": {<command line options>},
+//   "runs": [{"params": {...}, "metrics": {...}, "distributions": {"<name>": {<see makeDistribution>}}}]
+// }
+// Runs of two reports are matched by their params.
+namespace tensorrt_llm::benchmark::report
+{
+
+int constexpr kSchemaVersion = 1;
+
+inline nlohmann::json makeReport(std::string const& benchmark, nlohmann::json fingerprint, nlohmann::json options)
+{
+    nlohmann::json report;
+    report["schema_version"] = kSchemaVersion;
+    report["benchmark"] = benchmark;
+    report["fingerprint"] = std::move(fingerprint);
+    report["options"] = std::move(options);
+    report["runs"] = nlohmann::json::array();
+    return report;
+}
+
+//! \brief Summary statistics of a distribution, with the raw values so that reports can be tested for significance.
+inline nlohmann::json makeDistribution(std::vector<float> values)
+{
+    nlohmann::json distribution;
+    distribution["count"] = values.size();
+    if (values.empty())
+    {
+        return distribution;
+    }
+    std::sort(values.begin(), values.end());
+    auto const count = static_cast<double>(values.size());
+    auto const mean = std::accumulate(values.begin(), values.end(), 0.0) / count;
+    auto const variance = std::accumulate(values.begin(), values.end(), 0.0,
+                              [mean](double acc, float value) { return acc + (value - mean) * (value - mean); })
+        / count;
+    auto const percentile = [&values, count](int p)
+    { return values[std::max(static_cast<int>(std::ceil(p / 100.0 * count)) - 1, 0)]; };
+
+    distribution["mean"] = mean;
+    distribution["stddev"] = std::sqrt(variance);
+    distribution["min"] = values.front();
+    distribution["max"] = values.back();
+    distribution["p50"] = percentile(50);
+    distribution["p90"] = percentile(90);
+    distribution["p99"] = percentile(99);
+    distribution["values"] = values;
+    return distribution;
+}
+
+//! \brief Identify the engine a report was measured with: its build and model config, and the names and sizes of the
+//! engine files. The hash only covers config.json, it changes with any build option.
+inline nlohmann::json makeEngineFingerprint(std::filesystem::path const& engineDir)
+{
+    nlohmann::json fingerprint;
+    fingerprint["engine_dir"] = std::filesystem::absolute(engineDir).string();
+
+    auto const configPath = engineDir / "config.json";
+    if (std::filesystem::exists(configPath))
+    {
+        std::ifstream configStream(configPath);
+        std::stringstream configText;
+        configText << configStream.rdbuf();
+        std::stringstream hash;
+        hash << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>{}(configText.str());
+        fingerprint["config_hash"] = hash.str();
+
+        auto const config = nlohmann::json::parse(configText.str(), nullptr, false, true);
+        if (!config.is_discarded())
+        {
+            for (auto const* key : {"version", "build_config", "pretrained_config", "builder_config", "plugin_config"})
+            {
+                if (config.contains(key))
+                {
+                    fingerprint[key] = config[key];
+                }
+            }
+        }
+    }
+
+    auto& engines = fingerprint["engines"] = nlohmann::json::object();
+    for (auto const& entry : std::filesystem::directory_iterator(engineDir))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".engine")
+        {
+            engines[entry.path().filename().string()] = entry.file_size();
+        }
+    }
+    return fingerprint;
+}
+
+inline void writeReport(std::filesystem::path const& path, nlohmann::json const& report)
+{
+    std::ofstream outFile(path);
+    TLLM_CHECK_WITH_INFO(outFile.is_open(), "Error opening file '%s' for writing.", path.string().c_str());
+    outFile << report.dump(2) << "\n";
+}
+
+//! \brief The run of a report matching params, e.g. a run of the same dataset with a different configuration to compare
+//! against.
+inline nlohmann::json readRun(std::filesystem::path const& reportPath, nlohmann::json const& params)
+{
+    std::ifstream reportFile(reportPath);
+    TLLM_CHECK_WITH_INFO(reportFile.is_open(), "Error opening baseline report '%s'.", reportPath.string().c_str());
+    auto report = nlohmann::json::parse(reportFile);
+    for (auto& run : report.at("runs"))
+    {
+        if (run.value("params", nlohmann::json::object()) == params)
+        {
+            return std::move(run);
+        }
+    }
+    TLLM_THROW("Baseline report '%s' has no run with params %s", reportPath.string().c_str(), params.dump().c_str());
+}
+
+//! \brief The token throughput of the run of a report matching params, e.g. a run of the same dataset without
+//! speculative decoding or without LoRA to compare against.
+inline double readBaselineTokenThroughput(std::filesystem::path const& reportPath, nlohmann::json const& params)
+{
+    return readRun(reportPath, params).at("metrics").at("token_throughput(token/sec)").get<double>();
+}
+
+} // namespace tensorrt_llm::benchmark::report
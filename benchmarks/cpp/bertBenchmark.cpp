@@ -14,6 +14,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "benchmarkReport.h"
+#include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/plugins/api/tllmPlugin.h"
 #include "tensorrt_llm/runtime/iTensor.h"
@@ -29,12 +31,16 @@
 #include <fstream>
 #include <iostream>
 #include <nlohmann/json.hpp>
+#include <numeric>
+#include <optional>
+#include <random>
 #include <sstream>
 #include <string>
 
 using namespace tensorrt_llm::runtime;
 
 namespace tc = tensorrt_llm::common;
+namespace treport = tensorrt_llm::benchmark::report;
 namespace trt = nvinfer1;
 
 namespace
@@ -73,36 +79,120 @@ std::string engineFilename(
         + std::to_string(worldConfig.getRank()) + ".engine";
 }
 
+bool hasInput(TllmRuntime const& rt, char const* name)
+{
+    return rt.getEngine().getTensorIOMode(name) == nvinfer1::TensorIOMode::kINPUT;
+}
+
+// Lengths of the sequences of a batch: inLen for all of them, or uniform in [minInLen, inLen] to mimic skewed
+// traffic on packed engines.
+std::vector<SizeType32> sampleInputLengths(int batchSize, int inLen, int minInLen, std::mt19937& generator)
+{
+    std::vector<SizeType32> inputLengths(batchSize, inLen);
+    if (minInLen > 0 && minInLen < inLen)
+    {
+        std::uniform_int_distribution<SizeType32> distr(minInLen, inLen);
+        for (auto& len : inputLengths)
+        {
+            len = distr(generator);
+        }
+    }
+    return inputLengths;
+}
+
+// Inputs of an engine built with remove_input_padding: all the sequences are packed without padding.
+void setPackedInputs(TllmRuntime& rt, TllmRuntime::TensorMap& tensorMap, std::vector<SizeType32> const& inputLengths)
+{
+    auto& allocator = rt.getBufferManager();
+    auto const batchSize = static_cast<SizeType32>(inputLengths.size());
+    auto const numTokens = std::accumulate(inputLengths.begin(), inputLengths.end(), SizeType32{0});
+    auto const maxInputLength = *std::max_element(inputLengths.begin(), inputLengths.end());
+
+    std::vector<SizeType32> inputIdsHost(numTokens, 0);
+    tensorMap.insert(std::make_pair("input_ids",
+        std::shared_ptr<ITensor>{allocator.copyFrom(inputIdsHost, ITensor::makeShape({numTokens}), MemoryType::kGPU)}));
+    tensorMap.insert(std::make_pair("input_lengths",
+        std::shared_ptr<ITensor>{
+            allocator.copyFrom(inputLengths, ITensor::makeShape({batchSize}), MemoryType::kGPU)}));
+    if (hasInput(rt, "token_type_ids"))
+    {
+        tensorMap.insert(std::make_pair("token_type_ids",
+            std::shared_ptr<ITensor>{
+                allocator.copyFrom(inputIdsHost, ITensor::makeShape({numTokens}), MemoryType::kGPU)}));
+    }
+    if (hasInput(rt, "position_ids"))
+    {
+        std::vector<SizeType32> positionIdsHost;
+        positionIdsHost.reserve(numTokens);
+        for (auto const len : inputLengths)
+        {
+            for (SizeType32 pos = 0; pos < len; ++pos)
+            {
+                positionIdsHost.push_back(pos);
+            }
+        }
+        tensorMap.insert(std::make_pair("position_ids",
+            std::shared_ptr<ITensor>{
+                allocator.copyFrom(positionIdsHost, ITensor::makeShape({numTokens}), MemoryType::kGPU)}));
+    }
+    if (hasInput(rt, "max_input_length"))
+    {
+        // Only the shape of max_input_length is read.
+        tensorMap.insert(std::make_pair("max_input_length",
+            std::shared_ptr<ITensor>{
+                allocator.gpu(ITensor::makeShape({maxInputLength}), nvinfer1::DataType::kINT32)}));
+    }
+}
+
 void benchmarkBert(std::string const& modelName, std::filesystem::path const& dataPath,
-    std::vector<int> const& batchSizes, std::vector<int> const& inLens, std::vector<float> const& gpuWeightsPercents,
-    std::shared_ptr<nvinfer1::ILogger> const& logger, int warmUp, int numRuns, int duration)
+    std::vector<int> const& batchSizes, std::vector<int> const& inLens, int minInLen,
+    std::vector<float> const& gpuWeightsPercents, std::shared_ptr<nvinfer1::ILogger> const& logger, int warmUp,
+    int numRuns, int duration, std::optional<std::string> const& reportJsonFile)
 {
     auto const worldConfig = WorldConfig::mpi();
     auto const enginePath = dataPath / engineFilename(dataPath, worldConfig, modelName);
 
+    auto report = treport::makeReport("bertBenchmark", treport::makeEngineFingerprint(dataPath),
+        {{"model", modelName}, {"min_input_len", minInLen}, {"warm_up", warmUp}, {"num_runs", numRuns},
+            {"duration", duration}, {"packed_inputs", false}});
+
     for (float gpuWeightsPercent : gpuWeightsPercents)
     {
         auto rt = std::make_shared<TllmRuntime>(RawEngine(enginePath), logger.get(), gpuWeightsPercent);
         rt->addContext(0);
+        // Packed engines take input_ids as [num_tokens] instead of [batch_size, input_length].
+        bool const packedInputs = rt->getEngine().getTensorShape("input_ids").nbDims == 1;
+        report["options"]["packed_inputs"] = packedInputs;
+        std::mt19937 generator(42);
         for (auto inLen : inLens)
         {
             for (auto const batchSize : batchSizes)
             {
                 auto& allocator = rt->getBufferManager();
                 TllmRuntime::TensorMap tensorMap{};
+                auto numTokens = batchSize * inLen;
 
-                // input_ids
-                std::vector<SizeType32> inputIdsHost(batchSize * inLen, inLen);
-                auto inputIdsBuffer = std::shared_ptr<ITensor>{
-                    allocator.copyFrom(inputIdsHost, ITensor::makeShape({batchSize, inLen}), MemoryType::kGPU)};
-                allocator.setZero(*inputIdsBuffer);
-                tensorMap.insert(std::make_pair("input_ids", inputIdsBuffer));
-                // input_lengths
-                std::vector<SizeType32> inputLengthsHost(batchSize);
-                auto inLensBuffer = std::shared_ptr<ITensor>{
-                    allocator.copyFrom(inputLengthsHost, ITensor::makeShape({batchSize}), MemoryType::kGPU)};
-                allocator.setZero(*inLensBuffer);
-                tensorMap.insert(std::make_pair("input_lengths", inLensBuffer));
+                if (packedInputs)
+                {
+                    auto const inputLengths = sampleInputLengths(batchSize, inLen, minInLen, generator);
+                    numTokens = std::accumulate(inputLengths.begin(), inputLengths.end(), 0);
+                    setPackedInputs(*rt, tensorMap, inputLengths);
+                }
+                else
+                {
+                    // input_ids
+                    std::vector<SizeType32> inputIdsHost(batchSize * inLen, inLen);
+                    auto inputIdsBuffer = std::shared_ptr<ITensor>{
+                        allocator.copyFrom(inputIdsHost, ITensor::makeShape({batchSize, inLen}), MemoryType::kGPU)};
+                    allocator.setZero(*inputIdsBuffer);
+                    tensorMap.insert(std::make_pair("input_ids", inputIdsBuffer));
+                    // input_lengths
+                    std::vector<SizeType32> inputLengthsHost(batchSize);
+                    auto inLensBuffer = std::shared_ptr<ITensor>{
+                        allocator.copyFrom(inputLengthsHost, ITensor::makeShape({batchSize}), MemoryType::kGPU)};
+                    allocator.setZero(*inLensBuffer);
+                    tensorMap.insert(std::make_pair("input_lengths", inLensBuffer));
+                }
 
                 rt->setInputTensors(0, tensorMap);
                 rt->setOutputTensors(0, tensorMap);
@@ -117,6 +207,7 @@ void benchmarkBert(std::string const& modelName, std::filesystem::path const& da
 
                 int iterIdx = 0;
                 float curDuration = 0;
+                std::vector<float> latencies;
                 while (iterIdx < numRuns || curDuration / 1000 < duration)
                 {
                     auto const start = std::chrono::steady_clock::now();
@@ -125,22 +216,51 @@ void benchmarkBert(std::string const& modelName, std::filesystem::path const& da
                     auto const end = std::chrono::steady_clock::now();
 
                     iterIdx += 1;
-                    curDuration += (static_cast<float>(
-                                        std::chrono::duration_cast<std::chrono::microseconds>(end - start).count())
-                        / 1000);
+                    auto const latency
+                        = static_cast<float>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count())
+                        / 1000;
+                    curDuration += latency;
+                    if (reportJsonFile)
+                    {
+                        latencies.push_back(latency);
+                    }
                 }
                 printf("Benchmarking done. Iteration: %d, duration: %.2f sec.\n", iterIdx, curDuration / 1000);
 
                 auto averageLatency = curDuration / iterIdx;
 
-                if (worldConfig.getRank() == 0)
+                if (worldConfig.getRank() == 0 && packedInputs)
+                {
+                    printf("[BENCHMARK] batch_size %d input_length %d num_tokens %d latency(ms) %.2f "
+                           "tokens_per_sec %.2f\n",
+                        batchSize, inLen, numTokens, averageLatency, numTokens * 1000.f / averageLatency);
+                }
+                else if (worldConfig.getRank() == 0)
                 {
                     printf("[BENCHMARK] batch_size %d input_length %d latency(ms) %.2f\n", batchSize, inLen,
                         averageLatency);
                 }
+
+                if (worldConfig.getRank() == 0 && reportJsonFile)
+                {
+                    auto const [freeMem, totalMem] = tc::getDeviceMemoryInfo(false);
+                    nlohmann::json run;
+                    run["params"] = {{"batch_size", batchSize}, {"input_length", inLen},
+                        {"gpu_weights_percent", gpuWeightsPercent}};
+                    run["metrics"] = {{"num_tokens", numTokens}, {"iterations", iterIdx},
+                        {"avg_latency(ms)", averageLatency}, {"tokens_per_sec", numTokens * 1000.f / averageLatency},
+                        {"gpu_mem_usage(bytes)", totalMem - freeMem}};
+                    run["distributions"]["latency(ms)"] = treport::makeDistribution(std::move(latencies));
+                    report["runs"].push_back(std::move(run));
+                }
             }
         }
     }
+
+    if (worldConfig.getRank() == 0 && reportJsonFile)
+    {
+        treport::writeReport(reportJsonFile.value(), report);
+    }
 }
 
 } // namespace
@@ -160,6 +280,10 @@ int main(int argc, char* argv[])
         "Specify input length(s) you want to benchmark. Multiple input lengths can be "
         "separated by \";\", example: \"60;128\".",
         cxxopts::value<std::string>()->default_value("128"));
+    options.add_options()("min_input_len",
+        "For engines built with remove_input_padding, sample the length of every sequence uniformly between "
+        "min_input_len and input_len instead of using input_len for all of them.",
+        cxxopts::value<int>()->default_value("0"));
 
     options.add_options()("log_level", "Choose log level between verbose/info/warning/error/internal_error.",
         cxxopts::value<std::string>()->default_value("error"));
@@ -174,6 +298,10 @@ int main(int argc, char* argv[])
         "by \";\", "
         "example: \"0.0;0.5;1.0\".",
         cxxopts::value<std::string>()->default_value("1.0"));
+    options.add_options()("report_json_file",
+        "Write a JSON report with the latency distribution of every configuration. Reports of two runs can be "
+        "compared with compare_reports.py.",
+        cxxopts::value<std::string>());
 
     auto result = options.parse(argc, argv);
 
@@ -258,8 +386,10 @@ int main(int argc, char* argv[])
     try
     {
         benchmarkBert(result["model"].as<std::string>(), result["engine_dir"].as<std::string>(), batchSizes, inLens,
-            gpuWeightsPercents, logger, result["warm_up"].as<int>(), result["num_runs"].as<int>(),
-            result["duration"].as<int>());
+            result["min_input_len"].as<int>(), gpuWeightsPercents, logger, result["warm_up"].as<int>(),
+            result["num_runs"].as<int>(), result["duration"].as<int>(),
+            result.count("report_json_file") ? std::make_optional(result["report_json_file"].as<std::string>())
+                                             : std::nullopt);
     }
     catch (std::exception const& e)
     {
@@ -0,0 +1,157 @@
+# SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Compare two JSON reports written with --report_json_file and flag regressions.
+
+Distributions are compared with a two-sided Mann-Whitney U test on their raw
+values. A distribution regresses if the test is significant and its median got
+worse by more than the threshold. Scalar metrics have no samples to test, they
+regress if they got worse by more than the scalar threshold.
+
+The exit code is 1 if any run regressed.
+"""
+import json
+import math
+import sys
+
+import click
+
+# Metrics for which a larger value is better, everything else is a latency or a
+# resource usage.
+HIGHER_IS_BETTER = ("throughput", "tokens_per_sec", "goodput", "attainment",
+                    "acceptance_rate", "reused_blocks", "tokens_per_step",
+                    "speedup", "hit_rate", "bandwidth")
+# Counters describing the workload rather than its performance.
+IGNORED_METRICS = ("num_samples", "num_tokens", "iterations",
+                   "kv_cache_max_num_blocks", "kv_cache_tokens_per_block",
+                   "kv_cache_bytes_per_token", "window(ms)")
+
+
+def higher_is_better(name):
+    return any(key in name for key in HIGHER_IS_BETTER)
+
+
+def mann_whitney_u(xs, ys):
+    """Two-sided p-value of the Mann-Whitney U test, normal approximation with tie correction."""
+    n1, n2 = len(xs), len(ys)
+    values = sorted([(x, 0) for x in xs] + [(y, 1) for y in ys])
+    ranks = [0.0] * len(values)
+    tie_term = 0.0
+    i = 0
+    while i < len(values):
+        j = i
+        while j + 1 < len(values) and values[j + 1][0] == values[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2 + 1
+        ties = j - i + 1
+        tie_term += ties**3 - ties
+        i = j + 1
+    rank_sum = sum(rank for rank, (_, group) in zip(ranks, values)
+                   if group == 0)
+    u = rank_sum - n1 * (n1 + 1) / 2
+    n = n1 + n2
+    variance = n1 * n2 / 12 * ((n + 1) - tie_term / (n * (n - 1)))
+    if variance <= 0:
+        return 1.0
+    z = (abs(u - n1 * n2 / 2) - 0.5) / math.sqrt(variance)
+    return math.erfc(max(z, 0.0) / math.sqrt(2))
+
+
+def relative_change(base, new):
+    if base == 0:
+        return 0.0 if new == 0 else math.inf
+    return (new - base) / abs(base)
+
+
+def run_key(run):
+    return json.dumps(run.get("params", {}), sort_keys=True)
+
+
+def compare_run(base, new, alpha, threshold, scalar_threshold):
+    rows = []
+    for name, base_dist in base.get("distributions", {}).items():
+        new_dist = new.get("distributions", {}).get(name)
+        if not new_dist or not base_dist.get("values") or not new_dist.get(
+                "values"):
+            continue
+        change = relative_change(base_dist["p50"], new_dist["p50"])
+        worse = -change if higher_is_better(name) else change
+        p_value = mann_whitney_u(base_dist["values"], new_dist["values"])
+        regressed = p_value < alpha and worse > threshold
+        rows.append((name, base_dist["p50"], new_dist["p50"], change, p_value,
+                     regressed))
+    for name, base_value in base.get("metrics", {}).items():
+        new_value = new.get("metrics", {}).get(name)
+        if new_value is None or name in IGNORED_METRICS:
+            continue
+        change = relative_change(base_value, new_value)
+        worse = -change if higher_is_better(name) else change
+        rows.append((name, base_value, new_value, change, None,
+                     worse > scalar_threshold))
+    return rows
+
+
+@click.command()
+@click.argument("base", type=click.File("r"))
+@click.argument("new", type=click.File("r"))
+@click.option("--alpha",
+              type=float,
+              default=0.01,
+              help="Significance level of the distribution tests.")
+@click.option(
+    "--threshold",
+    type=float,
+    default=0.02,
+    help="Relative change of the median below which distributions never regress."
+)
+@click.option("--scalar-threshold",
+              type=float,
+              default=0.05,
+              help="Relative change above which scalar metrics regress.")
+def compare(base, new, alpha, threshold, scalar_threshold):
+    base_report = json.load(base)
+    new_report = json.load(new)
+    if base_report.get("benchmark") != new_report.get("benchmark"):
+        raise click.UsageError(
+            f"Cannot compare a {base_report.get('benchmark')} report with a "
+            f"{new_report.get('benchmark')} report")
+    for key in ("config_hash", "engines"):
+        if base_report["fingerprint"].get(key) != new_report["fingerprint"].get(
+                key):
+            click.echo(f"Warning: the engines differ in {key}")
+    if base_report.get("options") != new_report.get("options"):
+        click.echo("Warning: the benchmark options differ")
+
+    new_runs = {run_key(run): run for run in new_report["runs"]}
+    num_regressions = 0
+    for base_run in base_report["runs"]:
+        key = run_key(base_run)
+        if key not in new_runs:
+            click.echo(f"Run {key} is missing from the new report")
+            continue
+        click.echo(f"Run {key}")
+        for name, base_value, new_value, change, p_value, regressed in compare_run(
+                base_run, new_runs[key], alpha, threshold, scalar_threshold):
+            p_text = "" if p_value is None else f" p={p_value:.3g}"
+            flag = "  REGRESSION" if regressed else ""
+            click.echo(f"  {name}: {base_value:.4g} -> {new_value:.4g} "
+                       f"({change:+.2%}{p_text}){flag}")
+            num_regressions += regressed
+    click.echo(f"{num_regressions} regression(s)")
+    sys.exit(1 if num_regressions else 0)
+
+
+if __name__ == "__main__":
+    compare()
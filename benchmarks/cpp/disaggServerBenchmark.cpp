@@ -0,0 +1,756 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Disaggregated serving benchmark. The prompts of a dataset run as context-only requests on context executors, and
+// every context response continues as a generation-only request on a generation executor, which pulls the KV cache of
+// the prompt from the context executor. Reports the KV cache transfer time and bandwidth of the requests next to their
+// time to first token and inter-token latency. The latencies have the names of gptManagerBenchmark and the runs its
+// params, so compare_reports.py compares a report against an aggregated run of the same dataset.
+//
+// The executors run in orchestrator mode: MPI rank 0 holds all of them and drives the requests, the other ranks run
+// the instances, context instances first, each on as many consecutive ranks as its engine has. The ranks of an
+// instance can be on a different node than the ones of another instance.
+#include "benchmarkReport.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/dataType.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/plugins/api/tllmPlugin.h"
+#include "tensorrt_llm/runtime/gptJsonConfig.h"
+#include "tensorrt_llm/runtime/tllmLogger.h"
+
+#include <NvInfer.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cxxopts.hpp>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+namespace tc = tensorrt_llm::common;
+namespace texec = tensorrt_llm::executor;
+namespace treport = tensorrt_llm::benchmark::report;
+namespace mpi = tensorrt_llm::mpi;
+namespace trt = nvinfer1;
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct Sample
+{
+    texec::VecTokens inputIds;
+    SizeType32 outputLen;
+};
+
+std::vector<Sample> parseDataset(std::filesystem::path const& datasetPath, std::size_t maxNumSamples)
+{
+    TLLM_CHECK_WITH_INFO(std::filesystem::exists(datasetPath), "File does not exist: %s", datasetPath.c_str());
+    std::ifstream jsonStream(datasetPath);
+    auto const json = nlohmann::json::parse(jsonStream, nullptr, true, true);
+    std::vector<Sample> samples;
+    for (auto const& sample : json.at("samples"))
+    {
+        if (samples.size() >= maxNumSamples)
+        {
+            break;
+        }
+        samples.push_back(
+            Sample{sample.at("input_ids").get<texec::VecTokens>(), sample.at("output_len").get<SizeType32>()});
+    }
+    return samples;
+}
+
+//! Bytes of KV cache per prompt token that a context instance sends, over all layers and ranks.
+double getKvCacheBytesPerToken(GptJsonConfig const& jsonConfig)
+{
+    auto const& modelConfig = jsonConfig.getModelConfig();
+    // The heads are per rank, replicated when the engine has fewer KV heads than ranks
+    return 2.0 * modelConfig.getNbAttentionLayers() * modelConfig.getNbKvHeads() * jsonConfig.getTensorParallelism()
+        * modelConfig.getKvCacheSizePerHead() * static_cast<double>(tc::getDTypeSize(modelConfig.getKvDataType()));
+}
+
+double msBetween(Clock::time_point start, Clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+struct RequestRecord
+{
+    SizeType32 inputLength{0};
+    SizeType32 maxTokens{0};
+    //! Tokens received so far, the first one from the context instance
+    SizeType32 numTokens{0};
+    Clock::time_point start;
+    Clock::time_point contextEnd;
+    std::optional<Clock::time_point> firstGenerationTokenTs;
+    Clock::time_point end;
+    bool hasError{false};
+    std::optional<texec::DisServingRequestStats> disServingStats;
+};
+
+//! The instances of a phase, which take new requests by the number of requests they are running.
+class InstancePool
+{
+public:
+    explicit InstancePool(std::deque<texec::Executor>& executors)
+        : mExecutors{executors}
+        , mNumActive(executors.size(), 0)
+    {
+    }
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return mExecutors.size();
+    }
+
+    texec::Executor& get(std::size_t instance)
+    {
+        return mExecutors.at(instance);
+    }
+
+    //! \brief The least busy instance, which counts the new request from now on.
+    std::size_t acquire()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto const instance = static_cast<std::size_t>(
+            std::distance(mNumActive.begin(), std::min_element(mNumActive.begin(), mNumActive.end())));
+        ++mNumActive[instance];
+        return instance;
+    }
+
+    void release(std::size_t instance)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        --mNumActive.at(instance);
+    }
+
+private:
+    std::deque<texec::Executor>& mExecutors;
+    std::mutex mMutex;
+    std::vector<SizeType32> mNumActive;
+};
+
+//! Drives requests through context and generation instances, on the orchestrator rank.
+class DisaggServer
+{
+public:
+    DisaggServer(std::deque<texec::Executor>& contextExecutors, std::deque<texec::Executor>& generationExecutors,
+        std::chrono::milliseconds waitSleep, std::optional<SizeType32> endId)
+        : mContext{contextExecutors}
+        , mGeneration{generationExecutors}
+        , mWaitSleep{waitSleep}
+        , mEndId{endId}
+    {
+    }
+
+    //! \brief Run the samples, enqueued after the given delays (s) and with at most concurrency requests in flight.
+    std::vector<RequestRecord> run(std::vector<Sample> const& samples, std::vector<double> const& delays,
+        std::optional<SizeType32> concurrency)
+    {
+        mRecords.assign(samples.size(), RequestRecord{});
+        mContextRequests.clear();
+        mGenerationRequests.clear();
+        mSamples = &samples;
+        mNumDone = 0;
+
+        std::vector<std::thread> threads;
+        for (std::size_t instance = 0; instance < mContext.size(); ++instance)
+        {
+            threads.emplace_back([this, instance]() { pollContext(instance); });
+        }
+        for (std::size_t instance = 0; instance < mGeneration.size(); ++instance)
+        {
+            threads.emplace_back([this, instance]() { pollGeneration(instance); });
+        }
+        std::thread statsThread([this]() { collectStats(); });
+
+        for (std::size_t i = 0; i < samples.size(); ++i)
+        {
+            while (concurrency && static_cast<SizeType32>(i - mNumDone) >= concurrency.value())
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            auto const& sample = samples[i];
+            texec::Request request{sample.inputIds, sample.outputLen, true, texec::SamplingConfig{},
+                texec::OutputConfig{}, mEndId};
+            request.setRequestType(texec::RequestType::REQUEST_TYPE_CONTEXT_ONLY);
+            auto const instance = mContext.acquire();
+            {
+                // Held over the enqueue, so the pollers find the request when its response arrives
+                std::lock_guard<std::mutex> lock(mMutex);
+                auto& record = mRecords[i];
+                record.inputLength = static_cast<SizeType32>(sample.inputIds.size());
+                record.maxTokens = sample.outputLen;
+                record.start = Clock::now();
+                mContextRequests[{instance, mContext.get(instance).enqueueRequest(request)}] = i;
+            }
+            if (i + 1 < samples.size() && delays.at(i) > 0.0)
+            {
+                std::this_thread::sleep_for(std::chrono::duration<double>(delays.at(i)));
+            }
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        mStatsDone = true;
+        statsThread.join();
+        mStatsDone = false;
+        return std::move(mRecords);
+    }
+
+private:
+    [[nodiscard]] bool isDone() const
+    {
+        return mNumDone >= mSamples->size();
+    }
+
+    void finish(RequestRecord& record, bool hasError)
+    {
+        record.end = Clock::now();
+        record.hasError = hasError;
+        ++mNumDone;
+    }
+
+    void pollContext(std::size_t instance)
+    {
+        auto& executor = mContext.get(instance);
+        while (!isDone())
+        {
+            for (auto const& response : executor.awaitResponses(mWaitSleep))
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                auto const it = mContextRequests.find({instance, response.getRequestId()});
+                if (it == mContextRequests.end())
+                {
+                    continue;
+                }
+                auto const sampleIdx = it->second;
+                auto& record = mRecords[sampleIdx];
+                if (response.hasError() || !response.getResult().contextPhaseParams)
+                {
+                    TLLM_LOG_ERROR("Context phase of request %zu failed: %s", sampleIdx,
+                        response.hasError() ? response.getErrorMsg().c_str() : "no context phase params");
+                    mContextRequests.erase(it);
+                    mContext.release(instance);
+                    finish(record, true);
+                    continue;
+                }
+                if (!response.getResult().isFinal)
+                {
+                    continue;
+                }
+                record.contextEnd = Clock::now();
+                record.numTokens = 1;
+                mContextRequests.erase(it);
+                mContext.release(instance);
+                if (record.maxTokens <= 1)
+                {
+                    finish(record, false);
+                    continue;
+                }
+
+                auto const& sample = mSamples->at(sampleIdx);
+                texec::Request request{sample.inputIds, sample.outputLen, true, texec::SamplingConfig{},
+                    texec::OutputConfig{}, mEndId};
+                request.setRequestType(texec::RequestType::REQUEST_TYPE_GENERATION_ONLY);
+                request.setContextPhaseParams(response.getResult().contextPhaseParams.value());
+                auto const generationInstance = mGeneration.acquire();
+                mGenerationRequests[{generationInstance, mGeneration.get(generationInstance).enqueueRequest(request)}]
+                    = sampleIdx;
+            }
+        }
+    }
+
+    void pollGeneration(std::size_t instance)
+    {
+        auto& executor = mGeneration.get(instance);
+        while (!isDone())
+        {
+            for (auto const& response : executor.awaitResponses(mWaitSleep))
+            {
+                auto const now = Clock::now();
+                std::lock_guard<std::mutex> lock(mMutex);
+                auto const it = mGenerationRequests.find({instance, response.getRequestId()});
+                if (it == mGenerationRequests.end())
+                {
+                    continue;
+                }
+                auto& record = mRecords[it->second];
+                if (response.hasError())
+                {
+                    TLLM_LOG_ERROR("Generation phase of request %zu failed: %s", it->second,
+                        response.getErrorMsg().c_str());
+                    mGeneration.release(instance);
+                    finish(record, true);
+                    continue;
+                }
+                auto const& result = response.getResult();
+                auto const numTokens
+                    = result.outputTokenIds.empty() ? 0 : static_cast<SizeType32>(result.outputTokenIds.front().size());
+                if (numTokens > 0 && !record.firstGenerationTokenTs)
+                {
+                    record.firstGenerationTokenTs = now;
+                }
+                // Bounded by the max tokens in case the generation instance returns the context token again
+                record.numTokens = std::min(record.numTokens + numTokens, record.maxTokens);
+                if (result.isFinal)
+                {
+                    mGeneration.release(instance);
+                    finish(record, false);
+                }
+            }
+        }
+    }
+
+    //! The transfer stats of a request are in the request stats of the generation instance.
+    void collectStats()
+    {
+        auto const collect = [this]()
+        {
+            for (std::size_t instance = 0; instance < mGeneration.size(); ++instance)
+            {
+                for (auto const& iteration : mGeneration.get(instance).getLatestRequestStats())
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    for (auto const& stats : iteration.requestStats)
+                    {
+                        auto const it = mGenerationRequests.find({instance, stats.id});
+                        if (stats.disServingStats && it != mGenerationRequests.end())
+                        {
+                            mRecords[it->second].disServingStats = stats.disServingStats;
+                        }
+                    }
+                }
+            }
+        };
+        while (!mStatsDone)
+        {
+            collect();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        // The stats of the iterations that finished the last requests
+        collect();
+    }
+
+    InstancePool mContext;
+    InstancePool mGeneration;
+    std::chrono::milliseconds mWaitSleep;
+    std::optional<SizeType32> mEndId;
+
+    std::mutex mMutex;
+    std::vector<Sample> const* mSamples{nullptr};
+    std::vector<RequestRecord> mRecords;
+    //! Sample of every request, by instance and request id
+    std::map<std::pair<std::size_t, texec::IdType>, std::size_t> mContextRequests;
+    std::map<std::pair<std::size_t, texec::IdType>, std::size_t> mGenerationRequests;
+    std::atomic<std::size_t> mNumDone{0};
+    std::atomic<bool> mStatsDone{false};
+};
+
+std::vector<double> computeDelays(std::size_t numSamples, std::optional<float> requestRate, int seed)
+{
+    std::vector<double> delays(numSamples, 0.0);
+    if (requestRate && requestRate.value() > 0.F)
+    {
+        std::mt19937 generator(seed);
+        std::exponential_distribution<double> distribution(requestRate.value());
+        std::generate(delays.begin(), delays.end(), [&]() { return distribution(generator); });
+    }
+    return delays;
+}
+
+double mean(std::vector<float> const& values)
+{
+    return values.empty() ? 0.0 : std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+}
+
+struct Metrics
+{
+    nlohmann::json run;
+    double tokenThroughput{0.0};
+};
+
+Metrics computeMetrics(std::vector<RequestRecord> const& records, double totalLatencyMs, double kvBytesPerToken,
+    std::size_t numContextInstances, std::size_t numGenerationInstances)
+{
+    std::vector<float> seqLatencies;
+    std::vector<float> ftLatencies;
+    std::vector<float> itLatencies;
+    std::vector<float> handoffLatencies;
+    std::vector<float> transferTimes;
+    std::vector<float> exposedTransferTimes;
+    std::vector<float> transferBandwidths;
+    int numSamples = 0;
+    int numErrorSamples = 0;
+    std::int64_t numInputTokens = 0;
+    std::int64_t numOutputTokens = 0;
+    for (auto const& record : records)
+    {
+        if (record.hasError)
+        {
+            ++numErrorSamples;
+            continue;
+        }
+        ++numSamples;
+        numInputTokens += record.inputLength;
+        numOutputTokens += record.numTokens;
+        seqLatencies.push_back(msBetween(record.start, record.end));
+        ftLatencies.push_back(msBetween(record.start, record.contextEnd));
+        if (record.numTokens > 1)
+        {
+            itLatencies.push_back(msBetween(record.contextEnd, record.end) / (record.numTokens - 1));
+        }
+        std::optional<double> handoffMs;
+        if (record.firstGenerationTokenTs)
+        {
+            handoffMs = msBetween(record.contextEnd, record.firstGenerationTokenTs.value());
+            handoffLatencies.push_back(handoffMs.value());
+        }
+        if (record.disServingStats)
+        {
+            auto const& stats = record.disServingStats.value();
+            transferTimes.push_back(stats.kvCacheTransferMS);
+            if (handoffMs)
+            {
+                // Only the part of the transfer after the context response delays the first generated token
+                exposedTransferTimes.push_back(std::min(stats.kvCacheTransferMS, handoffMs.value()));
+            }
+            if (stats.kvCacheTransferMS > 0.0)
+            {
+                // Bytes per ms to GB/s
+                transferBandwidths.push_back(record.inputLength * kvBytesPerToken / stats.kvCacheTransferMS / 1e6);
+            }
+        }
+    }
+
+    Metrics result;
+    auto const totalSeconds = totalLatencyMs / 1000;
+    result.tokenThroughput = numOutputTokens / totalSeconds;
+    auto& metrics = result.run["metrics"];
+    metrics["num_samples"] = numSamples;
+    metrics["num_error_samples"] = numErrorSamples;
+    metrics["total_latency(ms)"] = totalLatencyMs;
+    metrics["seq_throughput(seq/sec)"] = numSamples / totalSeconds;
+    metrics["token_throughput(token/sec)"] = result.tokenThroughput;
+    metrics["context_throughput_per_instance(token/sec)"] = numInputTokens / totalSeconds / numContextInstances;
+    metrics["generation_throughput_per_instance(token/sec)"]
+        = numOutputTokens / totalSeconds / numGenerationInstances;
+    metrics["kv_cache_bytes_per_token"] = kvBytesPerToken;
+
+    auto& distributions = result.run["distributions"];
+    distributions["sequence_latency(ms)"] = treport::makeDistribution(std::move(seqLatencies));
+    distributions["time_to_first_token(ms)"] = treport::makeDistribution(std::move(ftLatencies));
+    distributions["inter_token_latency(ms)"] = treport::makeDistribution(std::move(itLatencies));
+    distributions["generation_handoff(ms)"] = treport::makeDistribution(std::move(handoffLatencies));
+    distributions["kv_cache_transfer(ms)"] = treport::makeDistribution(std::move(transferTimes));
+    distributions["kv_cache_transfer_exposed(ms)"] = treport::makeDistribution(std::move(exposedTransferTimes));
+    distributions["kv_cache_transfer_bandwidth(GB/s)"] = treport::makeDistribution(std::move(transferBandwidths));
+    return result;
+}
+
+void printDistribution(std::string const& name, nlohmann::json const& distribution)
+{
+    if (distribution.value("count", 0) == 0)
+    {
+        return;
+    }
+    printf("[BENCHMARK] avg_%s %.2f\n", name.c_str(), distribution.at("mean").get<double>());
+    printf("[BENCHMARK] p50_%s %.2f\n", name.c_str(), distribution.at("p50").get<double>());
+    printf("[BENCHMARK] p99_%s %.2f\n", name.c_str(), distribution.at("p99").get<double>());
+}
+
+void report(nlohmann::json const& run, std::optional<nlohmann::json> const& aggregatedRun)
+{
+    auto const& metrics = run.at("metrics");
+    for (auto const& [name, value] : metrics.items())
+    {
+        printf("[BENCHMARK] %s %.2f\n", name.c_str(), value.get<double>());
+    }
+    printf("\n");
+    for (auto const& [name, distribution] : run.at("distributions").items())
+    {
+        printDistribution(name, distribution);
+    }
+    if (!aggregatedRun)
+    {
+        return;
+    }
+    printf("\n");
+    auto const& aggregatedDistributions = aggregatedRun->value("distributions", nlohmann::json::object());
+    for (auto const* name : {"time_to_first_token(ms)", "inter_token_latency(ms)", "sequence_latency(ms)"})
+    {
+        if (aggregatedDistributions.contains(name) && aggregatedDistributions.at(name).value("count", 0) > 0)
+        {
+            printDistribution(std::string{"aggregated_"} + name, aggregatedDistributions.at(name));
+        }
+    }
+    printf("[BENCHMARK] disagg_speedup %.3f\n", run.at("metrics").value("disagg_speedup", 0.0));
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options("TensorRT-LLM C++ Disaggregated Serving Benchmark",
+        "Runs the context and the generation phase of a dataset on separate executors.");
+    options.add_options()("h,help", "Print usage");
+    options.add_options()("context_engine_dir", "Directory of the engine of the context instances.",
+        cxxopts::value<std::string>());
+    options.add_options()("generation_engine_dir",
+        "Directory of the engine of the generation instances, the context engine by default.",
+        cxxopts::value<std::string>());
+    options.add_options()("num_context_instances", "Number of context instances.",
+        cxxopts::value<int>()->default_value("1"));
+    options.add_options()("num_generation_instances", "Number of generation instances.",
+        cxxopts::value<int>()->default_value("1"));
+    options.add_options()("dataset", "Dataset that is used for benchmarking BatchManager.",
+        cxxopts::value<std::string>()->default_value(""));
+    options.add_options()(
+        "max_num_samples", "maximum number of samples to use from dataset/generate", cxxopts::value<int>());
+    options.add_options()(
+        "warm_up", "Specify warm up iterations before benchmark starts.", cxxopts::value<int>()->default_value("2"));
+    options.add_options()("request_rate",
+        "Request rate in reqs/sec with exponential inter-arrival times. Skipping this arg or negative value will "
+        "trigger offline/0-delay.",
+        cxxopts::value<float>());
+    options.add_options()("concurrency", "Concurrent number of requests in flight.", cxxopts::value<int>());
+    options.add_options()("random_seed", "integer random seed for exponential time delays.",
+        cxxopts::value<int>()->default_value("420"));
+    options.add_options()("eos_id", "Specify the end-of-sequence token id.",
+        cxxopts::value<texec::TokenIdType>()->default_value("-1"));
+    options.add_options()("kv_cache_free_gpu_mem_fraction", "K-V Cache Free Gpu Mem Fraction.",
+        cxxopts::value<float>()->default_value("0.9"));
+    options.add_options()("enable_kv_cache_reuse", "Enables the KV cache reuse of the context instances.",
+        cxxopts::value<bool>()->default_value("false"));
+    options.add_options()("wait_sleep", "Specify how many milliseconds to wait for responses before polling again.",
+        cxxopts::value<int>()->default_value("25"));
+    options.add_options()("report_json_file",
+        "Write a JSON report with the full latency and KV cache transfer distributions. Its runs match the ones of "
+        "gptManagerBenchmark reports of the same dataset for compare_reports.py.",
+        cxxopts::value<std::string>());
+    options.add_options()("aggregated_report",
+        "JSON report of gptManagerBenchmark with --streaming on the same dataset, to compare the latencies and the "
+        "token throughput against.",
+        cxxopts::value<std::string>());
+    options.add_options()("log_level", "Choose log level between verbose/info/warning/error/internal_error.",
+        cxxopts::value<std::string>()->default_value("error"));
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help"))
+    {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+    if (!result.count("context_engine_dir"))
+    {
+        std::cout << options.help() << std::endl;
+        TLLM_LOG_ERROR("Please specify the context engine directory.");
+        return 1;
+    }
+    std::filesystem::path const contextEngineDir{result["context_engine_dir"].as<std::string>()};
+    std::filesystem::path const generationEngineDir{result.count("generation_engine_dir")
+            ? result["generation_engine_dir"].as<std::string>()
+            : contextEngineDir.string()};
+    auto const datasetPath = result["dataset"].as<std::string>();
+    auto const numContextInstances = result["num_context_instances"].as<int>();
+    auto const numGenerationInstances = result["num_generation_instances"].as<int>();
+
+    auto logger = std::make_shared<TllmLogger>();
+    auto const logLevel = result["log_level"].as<std::string>();
+    if (logLevel == "verbose")
+    {
+        logger->setLevel(trt::ILogger::Severity::kVERBOSE);
+    }
+    else if (logLevel == "info")
+    {
+        logger->setLevel(trt::ILogger::Severity::kINFO);
+    }
+    else if (logLevel == "warning")
+    {
+        logger->setLevel(trt::ILogger::Severity::kWARNING);
+    }
+    else if (logLevel == "error")
+    {
+        logger->setLevel(trt::ILogger::Severity::kERROR);
+    }
+    else if (logLevel == "internal_error")
+    {
+        logger->setLevel(trt::ILogger::Severity::kINTERNAL_ERROR);
+    }
+    else
+    {
+        TLLM_LOG_ERROR("Unexpected log level: " + logLevel);
+        return 1;
+    }
+    initTrtLlmPlugins(logger.get());
+
+    try
+    {
+        mpi::initialize(mpi::MpiThreadSupport::THREAD_MULTIPLE);
+        auto const& world = mpi::MpiComm::world();
+        auto const isOrchestrator = world.getRank() == 0;
+
+        auto const contextConfig = GptJsonConfig::parse(contextEngineDir / "config.json");
+        auto const generationConfig = GptJsonConfig::parse(generationEngineDir / "config.json");
+        auto const contextRanks = contextConfig.getWorldSize();
+        auto const generationRanks = generationConfig.getWorldSize();
+        TLLM_CHECK_WITH_INFO(numContextInstances > 0 && numGenerationInstances > 0,
+            "At least one context and one generation instance are required.");
+        TLLM_CHECK_WITH_INFO(
+            world.getSize() == 1 + numContextInstances * contextRanks + numGenerationInstances * generationRanks,
+            "Launch 1 + %d * %d + %d * %d MPI ranks: the orchestrator, then the ranks of the context and of the "
+            "generation instances.",
+            numContextInstances, contextRanks, numGenerationInstances, generationRanks);
+
+        texec::KvCacheConfig kvCacheConfig;
+        kvCacheConfig.setFreeGpuMemoryFraction(result["kv_cache_free_gpu_mem_fraction"].as<float>());
+        auto const makeExecutors = [&](std::filesystem::path const& engineDir, int numInstances, int numRanks,
+                                       int firstRank, bool enableBlockReuse, bool requestStats)
+        {
+            std::deque<texec::Executor> executors;
+            for (int instance = 0; instance < numInstances; ++instance)
+            {
+                std::vector<SizeType32> participantIds(numRanks);
+                std::iota(participantIds.begin(), participantIds.end(), firstRank + instance * numRanks);
+                texec::ParallelConfig parallelConfig{texec::CommunicationType::kMPI,
+                    texec::CommunicationMode::kORCHESTRATOR, std::nullopt, participantIds,
+                    texec::OrchestratorConfig{isOrchestrator, "", nullptr, false}};
+                auto instanceKvCacheConfig = kvCacheConfig;
+                instanceKvCacheConfig.setEnableBlockReuse(enableBlockReuse);
+                texec::ExecutorConfig executorConfig;
+                executorConfig.setKvCacheConfig(instanceKvCacheConfig);
+                executorConfig.setParallelConfig(parallelConfig);
+                if (requestStats)
+                {
+                    executorConfig.setRequestStatsMaxIterations(1000);
+                }
+                executors.emplace_back(engineDir, texec::ModelType::kDECODER_ONLY, executorConfig);
+            }
+            return executors;
+        };
+        auto contextExecutors = makeExecutors(contextEngineDir, numContextInstances, contextRanks, 1,
+            result["enable_kv_cache_reuse"].as<bool>(), false);
+        auto generationExecutors = makeExecutors(generationEngineDir, numGenerationInstances, generationRanks,
+            1 + numContextInstances * contextRanks, false, true);
+
+        // Only the orchestrator rank drives the requests
+        if (!isOrchestrator)
+        {
+            return 0;
+        }
+
+        auto const maxNumSamples = result.count("max_num_samples")
+            ? static_cast<std::size_t>(result["max_num_samples"].as<int>())
+            : std::numeric_limits<std::size_t>::max();
+        auto const samples = parseDataset(datasetPath, maxNumSamples);
+        TLLM_CHECK_WITH_INFO(!samples.empty(), "The dataset has no samples.");
+        auto const endId = result["eos_id"].as<texec::TokenIdType>();
+        DisaggServer server{contextExecutors, generationExecutors,
+            std::chrono::milliseconds(result["wait_sleep"].as<int>()),
+            endId >= 0 ? std::make_optional(endId) : std::nullopt};
+
+        auto const warmUp = result["warm_up"].as<int>();
+        if (warmUp > 0)
+        {
+            std::vector<Sample> const warmUpSamples(warmUp, samples.front());
+            server.run(warmUpSamples, std::vector<double>(warmUpSamples.size(), 0.0), std::nullopt);
+        }
+
+        std::optional<float> requestRate;
+        if (result.count("request_rate"))
+        {
+            requestRate = result["request_rate"].as<float>();
+        }
+        std::optional<SizeType32> concurrency;
+        if (result.count("concurrency"))
+        {
+            concurrency = result["concurrency"].as<int>();
+        }
+        auto const delays = computeDelays(samples.size(), requestRate, result["random_seed"].as<int>());
+        auto const start = Clock::now();
+        auto const records = server.run(samples, delays, concurrency);
+        auto const totalLatencyMs = msBetween(start, Clock::now());
+
+        auto metrics = computeMetrics(records, totalLatencyMs, getKvCacheBytesPerToken(contextConfig),
+            contextExecutors.size(), generationExecutors.size());
+        auto& run = metrics.run;
+        // The params of gptManagerBenchmark runs, so that reports of aggregated runs of the dataset match
+        run["params"] = {{"dataset", std::filesystem::path(datasetPath).filename().string()}, {"beam_width", 1}};
+        std::optional<nlohmann::json> aggregatedRun;
+        if (result.count("aggregated_report"))
+        {
+            aggregatedRun = treport::readRun(result["aggregated_report"].as<std::string>(), run["params"]);
+            auto const aggregatedThroughput
+                = aggregatedRun->at("metrics").at("token_throughput(token/sec)").get<double>();
+            run["metrics"]["disagg_speedup"]
+                = aggregatedThroughput > 0.0 ? metrics.tokenThroughput / aggregatedThroughput : 0.0;
+        }
+        report(run, aggregatedRun);
+
+        if (result.count("report_json_file"))
+        {
+            nlohmann::json reportOptions;
+            reportOptions["num_context_instances"] = numContextInstances;
+            reportOptions["num_generation_instances"] = numGenerationInstances;
+            reportOptions["context_ranks_per_instance"] = contextRanks;
+            reportOptions["generation_ranks_per_instance"] = generationRanks;
+            reportOptions["enable_kv_cache_reuse"] = result["enable_kv_cache_reuse"].as<bool>();
+            if (requestRate)
+            {
+                reportOptions["request_rate"] = requestRate.value();
+            }
+            if (concurrency)
+            {
+                reportOptions["concurrency"] = concurrency.value();
+            }
+            nlohmann::json fingerprint;
+            fingerprint["context"] = treport::makeEngineFingerprint(contextEngineDir);
+            fingerprint["generation"] = treport::makeEngineFingerprint(generationEngineDir);
+            auto jsonReport = treport::makeReport("disaggServerBenchmark", std::move(fingerprint), reportOptions);
+            jsonReport["runs"].push_back(std::move(run));
+            treport::writeReport(result["report_json_file"].as<std::string>(), jsonReport);
+        }
+    }
+    catch (std::exception const& e)
+    {
+        TLLM_LOG_ERROR(e.what());
+        return 1;
+    }
+    return 0;
+}
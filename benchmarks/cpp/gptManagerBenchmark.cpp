@@ -15,6 +15,10 @@
  * limitations under the License.
  */
 
+#include "benchmarkReport.h"
+#include "multiLoraWorkload.h"
+#include "specDecProfile.h"
+#include "sweep.h"
 #include "tensorrt_llm/batch_manager/GptManager.h"
 #include "tensorrt_llm/batch_manager/inferenceRequest.h"
 #include "tensorrt_llm/batch_manager/namedTensor.h"
@@ -28,6 +32,7 @@
 #include "tensorrt_llm/plugins/api/tllmPlugin.h"
 #include "tensorrt_llm/runtime/common.h"
 #include "tensorrt_llm/runtime/gptJsonConfig.h"
+#include "tensorrt_llm/runtime/loraCacheCounters.h"
 #include "tensorrt_llm/runtime/tllmLogger.h"
 #include "tensorrt_llm/runtime/utils/numpyUtils.h"
 #include "tensorrt_llm/runtime/worldConfig.h"
@@ -37,12 +42,14 @@
 #include <cxxopts.hpp>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <numeric>
 #include <optional>
 #include <random>
 #include <string>
 #include <thread>
+#include <unordered_set>
 #include <utility>
 
 using namespace tensorrt_llm::batch_manager;
@@ -50,6 +57,10 @@ using namespace tensorrt_llm::runtime;
 
 namespace tc = tensorrt_llm::common;
 namespace texec = tensorrt_llm::executor;
+namespace treport = tensorrt_llm::benchmark::report;
+namespace tlora = tensorrt_llm::benchmark::lora;
+namespace tspec = tensorrt_llm::benchmark::specdec;
+namespace tsweep = tensorrt_llm::benchmark::sweep;
 namespace mpi = tensorrt_llm::mpi;
 namespace trt = nvinfer1;
 
@@ -150,8 +161,21 @@ struct BenchmarkParams
     bool enableChunkedContext{false};
     bool streaming{false};
     bool enableExpDelays{false};
+    // Enqueue every sample at its recorded arrival time
+    bool traceReplay{false};
+    // Latency targets of the SLO attainment and goodput metrics
+    std::optional<float> ttftSloMs{std::nullopt};
+    std::optional<float> itlSloMs{std::nullopt};
+    // Structured report with the full distributions, see benchmarkReport.h
+    std::optional<std::string> reportJsonFile{std::nullopt};
+    // Per draft position acceptance of speculative decoding, see specDecProfile.h
+    bool specDecodingProfile{false};
+    // Report of a run of the same dataset without speculative decoding, to compute the speedup against
+    std::optional<std::string> specDecodingBaselineReport{std::nullopt};
     std::optional<float> requestRate{std::nullopt};
     std::optional<int> concurrency{std::nullopt};
+    // Grid of concurrencies and lengths run on one executor instead of a single run, see sweep.h
+    std::optional<tsweep::SweepConfig> sweep{std::nullopt};
     std::optional<SizeType32> maxBatchSize{std::nullopt};
     std::optional<SizeType32> maxNumTokens{std::nullopt};
     int randomSeed = 430;
@@ -164,6 +188,10 @@ struct BenchmarkParams
     std::optional<std::string> loraDir{std::nullopt};
     SizeType32 loraDeviceNumModLayers{0};
     size_t loraHostCacheSize{1024 * 2024 * 1024};
+    // Zipf distributed adapters of a multi-LoRA serving benchmark, see multiLoraWorkload.h
+    std::optional<tlora::MultiLoraConfig> multiLora{std::nullopt};
+    // Report of a run of the same dataset with the base model only, to compute the LoRA speedup against
+    std::optional<std::string> loraBaselineReport{std::nullopt};
 
     // KV cache block offloading
     size_t kvHostCacheSize{0};
@@ -404,6 +432,8 @@ struct BenchInfo
     std::optional<float> avgGenT2TLatency{};
     bool firstTokenSeen{false};
     SizeType32 decodingIter{0};
+    // Whether the request was the first of its LoRA adapter in the run, unset for requests without LoRA
+    std::optional<bool> coldAdapter{};
 };
 
 class Recorder
@@ -426,11 +456,54 @@ public:
         mStart = std::chrono::steady_clock::now();
     }
 
+    //! A request meets the SLO if its time to first token and its average inter-token latency are within the targets.
+    void setLatencySlos(std::optional<float> ttftSloMs, std::optional<float> itlSloMs)
+    {
+        mTtftSloMs = ttftSloMs;
+        mItlSloMs = itlSloMs;
+    }
+
+    //! Profile the acceptance of speculative decoding, which needs the tokens of every step, i.e. streaming.
+    void enableSpecDecodingProfile(SizeType32 maxDraftLen, std::optional<double> baselineTokenThroughput)
+    {
+        TLLM_CHECK_WITH_INFO(mStreaming, "The speculative decoding profile requires streaming.");
+        mSpecDecProfile.emplace(maxDraftLen);
+        mBaselineTokenThroughput = baselineTokenThroughput;
+    }
+
+    //! Split the latencies by requests to new and to known LoRA adapters, and report the adapter cache stats.
+    void enableLoraProfile(std::optional<double> baselineTokenThroughput)
+    {
+        mLoraProfile = true;
+        mLoraBaselineTokenThroughput = baselineTokenThroughput;
+    }
+
     void finalize()
     {
         mEnd = std::chrono::steady_clock::now();
     }
 
+    //! Forget the requests recorded so far, between the points of a sweep.
+    void clearRequests()
+    {
+        mRequestBenchInfos.clear();
+        mResponseTensors.clear();
+    }
+
+    //! Timings of the recorded requests, to measure a window of a sweep point.
+    [[nodiscard]] std::vector<tsweep::RequestTiming> getRequestTimings() const
+    {
+        std::vector<tsweep::RequestTiming> timings;
+        timings.reserve(mRequestBenchInfos.size());
+        for (auto const& [requestId, info] : mRequestBenchInfos)
+        {
+            timings.push_back(tsweep::RequestTiming{info.start, info.end,
+                info.firstTokenSeen ? std::make_optional(info.firstTokenTs) : std::nullopt, info.outputLength,
+                info.hasError});
+        }
+        return timings;
+    }
+
     void recordStart(std::shared_ptr<InferenceRequest> request, uint64_t requestId)
     {
         auto const inputLength = request->getInputIds()->getSize();
@@ -453,13 +526,23 @@ public:
         mRequestBenchInfos[requestId] = BenchInfo(inputLength, start);
     }
 
+    //! The first request of an adapter in the run is cold, its adapter is loaded into the caches on the way.
+    void recordLoraTask(uint64_t requestId, uint64_t taskId)
+    {
+        if (mLoraProfile)
+        {
+            mRequestBenchInfos[requestId].coldAdapter = mLoraTasks.insert(taskId).second;
+        }
+    }
+
     void recordEnd(uint64_t requestId, bool hasError)
     {
         mRequestBenchInfos[requestId].end = std::chrono::steady_clock::now();
         mRequestBenchInfos[requestId].hasError = hasError;
     }
 
-    void recordToken(uint64_t requestId)
+    //! A streaming response, which holds the numTokens tokens of a step. Speculative decoding emits several.
+    void recordToken(uint64_t requestId, SizeType32 numTokens = 1)
     {
         TLLM_CHECK(mStreaming);
         TLLM_CHECK_WITH_INFO(mBeamWidth == 1, "gptManagerBenchmark streaming mode does not support beam > 1");
@@ -470,7 +553,18 @@ public:
             mRequestBenchInfos[requestId].firstTokenSeen = true;
         }
 
-        mRequestBenchInfos[requestId].outputLength += 1;
+        mRequestBenchInfos[requestId].outputLength += numTokens;
+        if (mSpecDecProfile)
+        {
+            mSpecDecProfile->recordStep(requestId, numTokens);
+        }
+    }
+
+    void recordToken(uint64_t requestId, texec::Response const& response)
+    {
+        auto const& outputTokenIds = response.getResult().outputTokenIds;
+        this->recordToken(
+            requestId, outputTokenIds.empty() ? 0 : static_cast<SizeType32>(outputTokenIds.front().size()));
     }
 
     void recordEnd(uint64_t requestId, std::list<NamedTensor> const& responseTensors, bool hasError)
@@ -532,7 +626,7 @@ public:
             }
             else
             {
-                this->recordToken(requestId);
+                this->recordToken(requestId, response);
             }
         }
     }
@@ -575,6 +669,11 @@ public:
 
         int totalOutputTokens{0};
         int totalDecodingIter{0};
+        int numSloSamples{0};
+        mColdAdapterLatencies.clear();
+        mWarmAdapterLatencies.clear();
+        mColdAdapterFtLatencies.clear();
+        mWarmAdapterFtLatencies.clear();
         mNumErrorSamples = 0;
         mNumSamples = 0;
         for (auto reqInfo : mRequestBenchInfos)
@@ -594,6 +693,20 @@ public:
                         genT2TLatencies.push_back(reqInfo.second.avgGenT2TLatency.value());
                     }
                 }
+                if (meetsSlo(reqInfo.second))
+                {
+                    ++numSloSamples;
+                }
+                if (reqInfo.second.coldAdapter)
+                {
+                    auto const cold = reqInfo.second.coldAdapter.value();
+                    (cold ? mColdAdapterLatencies : mWarmAdapterLatencies).push_back(reqInfo.second.latency);
+                    if (mStreaming)
+                    {
+                        (cold ? mColdAdapterFtLatencies : mWarmAdapterFtLatencies)
+                            .push_back(reqInfo.second.firstTokenLatency);
+                    }
+                }
                 ++mNumSamples;
             }
             else
@@ -605,6 +718,9 @@ public:
         mTotalLatency = std::chrono::duration<float, std::milli>(mEnd - mStart).count();
         mSeqThroughput = mNumSamples / (mTotalLatency / 1000);
         mTokenThroughput = totalOutputTokens / (mTotalLatency / 1000);
+        // Failed requests count as misses.
+        mSloAttainment = 100.F * numSloSamples / std::max(mNumSamples + mNumErrorSamples, 1);
+        mGoodput = numSloSamples / (mTotalLatency / 1000);
         mAcceptanceRate = totalDecodingIter
             ? (static_cast<float>(totalOutputTokens) / static_cast<float>(totalDecodingIter))
             : 0.0f;
@@ -645,6 +761,128 @@ public:
                 mMinGenT2TLatency = genT2TLatencies.front();
             }
         }
+
+        mReqLatencies = std::move(reqLatencies);
+        mFtLatencies = std::move(ftLatencies);
+        mGenT2TLatencies = std::move(genT2TLatencies);
+    }
+
+    //! Called from the stats thread of the executor server.
+    void recordIterationStats(texec::IterationStats const& stats)
+    {
+        std::lock_guard<std::mutex> lk(mIterStatsMutex);
+        mIterLatencies.push_back(static_cast<float>(stats.iterLatencyMS));
+        mPeakGpuMemUsage = std::max(mPeakGpuMemUsage, stats.gpuMemUsage);
+        mPeakCpuMemUsage = std::max(mPeakCpuMemUsage, stats.cpuMemUsage);
+        mPeakPinnedMemUsage = std::max(mPeakPinnedMemUsage, stats.pinnedMemUsage);
+        if (stats.kvCacheStats)
+        {
+            auto const& kvStats = stats.kvCacheStats.value();
+            mKvMaxNumBlocks = kvStats.maxNumBlocks;
+            mKvTokensPerBlock = kvStats.tokensPerBlock;
+            mKvPeakUsedBlocks = std::max(mKvPeakUsedBlocks, kvStats.usedNumBlocks);
+            // Cumulative counters, the latest value covers the whole run.
+            mKvAllocTotalBlocks = kvStats.allocTotalBlocks;
+            mKvReusedBlocks = kvStats.reusedBlocks;
+        }
+        // Counts since the previous read, the LoRA caches live in this process
+        {
+            auto const loraStats = tensorrt_llm::runtime::LoraCacheCounters::getInstance().getStats();
+            mLoraCacheStats.numHostHits += loraStats.numHostHits;
+            mLoraCacheStats.numHostMisses += loraStats.numHostMisses;
+            mLoraCacheStats.numHostEvictions += loraStats.numHostEvictions;
+            mLoraCacheStats.numDeviceHits += loraStats.numDeviceHits;
+            mLoraCacheStats.numDeviceMisses += loraStats.numDeviceMisses;
+            mLoraCacheStats.numDeviceEvictions += loraStats.numDeviceEvictions;
+            mLoraCacheStats.hostLoadMS += loraStats.hostLoadMS;
+            mLoraCacheStats.deviceLoadMS += loraStats.deviceLoadMS;
+        }
+    }
+
+    //! Run entry of the JSON report, call after calculateMetrics.
+    nlohmann::json toJson()
+    {
+        nlohmann::json run;
+        auto& metrics = run["metrics"];
+        metrics["num_samples"] = mNumSamples;
+        metrics["num_error_samples"] = mNumErrorSamples;
+        metrics["total_latency(ms)"] = mTotalLatency;
+        metrics["seq_throughput(seq/sec)"] = mSeqThroughput;
+        metrics["token_throughput(token/sec)"] = mTokenThroughput;
+        metrics["avg_acceptance_rate(tokens/decoding steps)"] = mAcceptanceRate;
+        if (hasSlos())
+        {
+            metrics["slo_attainment(%)"] = mSloAttainment;
+            metrics["goodput(seq/sec)"] = mGoodput;
+        }
+
+        auto& distributions = run["distributions"];
+        distributions["sequence_latency(ms)"] = treport::makeDistribution(mReqLatencies);
+        if (mStreaming)
+        {
+            distributions["time_to_first_token(ms)"] = treport::makeDistribution(mFtLatencies);
+            distributions["inter_token_latency(ms)"] = treport::makeDistribution(mGenT2TLatencies);
+        }
+
+        std::lock_guard<std::mutex> lk(mIterStatsMutex);
+        if (!mIterLatencies.empty())
+        {
+            distributions["iteration_latency(ms)"] = treport::makeDistribution(mIterLatencies);
+            metrics["peak_gpu_mem_usage(bytes)"] = mPeakGpuMemUsage;
+            metrics["peak_cpu_mem_usage(bytes)"] = mPeakCpuMemUsage;
+            metrics["peak_pinned_mem_usage(bytes)"] = mPeakPinnedMemUsage;
+            if (mKvMaxNumBlocks > 0)
+            {
+                metrics["kv_cache_max_num_blocks"] = mKvMaxNumBlocks;
+                metrics["kv_cache_tokens_per_block"] = mKvTokensPerBlock;
+                metrics["kv_cache_peak_used_blocks"] = mKvPeakUsedBlocks;
+                metrics["kv_cache_alloc_total_blocks"] = mKvAllocTotalBlocks;
+                metrics["kv_cache_reused_blocks"] = mKvReusedBlocks;
+            }
+        }
+        if (mSpecDecProfile)
+        {
+            auto& speculative = run["speculative"] = mSpecDecProfile->toJson();
+            metrics["spec_tokens_per_step"] = mSpecDecProfile->getTokensPerStep();
+            if (mBaselineTokenThroughput)
+            {
+                speculative["baseline_token_throughput(token/sec)"] = mBaselineTokenThroughput.value();
+                metrics["spec_speedup"] = getSpecDecodingSpeedup();
+            }
+        }
+        if (mLoraProfile)
+        {
+            auto& lora = run["lora"];
+            lora["num_adapters"] = mLoraTasks.size();
+            lora["num_cold_requests"] = mColdAdapterLatencies.size();
+            lora["num_warm_requests"] = mWarmAdapterLatencies.size();
+            lora["host_hits"] = mLoraCacheStats.numHostHits;
+            lora["host_misses"] = mLoraCacheStats.numHostMisses;
+            lora["host_evictions"] = mLoraCacheStats.numHostEvictions;
+            lora["device_hits"] = mLoraCacheStats.numDeviceHits;
+            lora["device_misses"] = mLoraCacheStats.numDeviceMisses;
+            lora["device_evictions"] = mLoraCacheStats.numDeviceEvictions;
+            lora["host_load_time(ms)"] = mLoraCacheStats.hostLoadMS;
+            lora["device_load_time(ms)"] = mLoraCacheStats.deviceLoadMS;
+            metrics["lora_host_hit_rate"] = getHitRate(mLoraCacheStats.numHostHits, mLoraCacheStats.numHostMisses);
+            metrics["lora_device_hit_rate"]
+                = getHitRate(mLoraCacheStats.numDeviceHits, mLoraCacheStats.numDeviceMisses);
+            if (mLoraBaselineTokenThroughput)
+            {
+                lora["baseline_token_throughput(token/sec)"] = mLoraBaselineTokenThroughput.value();
+                metrics["lora_speedup"] = getSpeedup(mLoraBaselineTokenThroughput.value());
+            }
+            distributions["cold_adapter_sequence_latency(ms)"] = treport::makeDistribution(mColdAdapterLatencies);
+            distributions["warm_adapter_sequence_latency(ms)"] = treport::makeDistribution(mWarmAdapterLatencies);
+            if (mStreaming)
+            {
+                distributions["cold_adapter_time_to_first_token(ms)"]
+                    = treport::makeDistribution(mColdAdapterFtLatencies);
+                distributions["warm_adapter_time_to_first_token(ms)"]
+                    = treport::makeDistribution(mWarmAdapterFtLatencies);
+            }
+        }
+        return run;
     }
 
     void report()
@@ -681,6 +919,60 @@ public:
             printf("[BENCHMARK] p90_inter_token_latency(ms) %.2f\n", mP90GenT2TLatency);
             printf("[BENCHMARK] p50_inter_token_latency(ms) %.2f\n\n", mP50GenT2TLatency);
         }
+
+        if (hasSlos())
+        {
+            printf("[BENCHMARK] slo_attainment(%%) %.2f\n", mSloAttainment);
+            printf("[BENCHMARK] goodput(seq/sec) %.2f\n\n", mGoodput);
+        }
+
+        if (mSpecDecProfile)
+        {
+            printf("[BENCHMARK] spec_tokens_per_step %.2f\n", mSpecDecProfile->getTokensPerStep());
+            auto const acceptance = mSpecDecProfile->getAcceptanceByPosition();
+            for (std::size_t position = 0; position < acceptance.size(); ++position)
+            {
+                printf("[BENCHMARK] spec_acceptance_rate(position %zu) %.3f\n", position, acceptance[position]);
+            }
+            if (mBaselineTokenThroughput)
+            {
+                printf("[BENCHMARK] baseline_token_throughput(token/sec) %.2f\n", mBaselineTokenThroughput.value());
+                printf("[BENCHMARK] spec_speedup %.3f\n", getSpecDecodingSpeedup());
+            }
+            printf("\n");
+        }
+
+        if (mLoraProfile)
+        {
+            auto const mean = [](std::vector<float> const& values)
+            { return values.empty() ? 0.F : std::accumulate(values.begin(), values.end(), 0.F) / values.size(); };
+            printf("[BENCHMARK] lora_num_adapters %zu\n", mLoraTasks.size());
+            printf("[BENCHMARK] lora_avg_cold_adapter_sequence_latency(ms) %.2f\n", mean(mColdAdapterLatencies));
+            printf("[BENCHMARK] lora_avg_warm_adapter_sequence_latency(ms) %.2f\n", mean(mWarmAdapterLatencies));
+            if (mStreaming)
+            {
+                printf("[BENCHMARK] lora_avg_cold_adapter_time_to_first_token(ms) %.2f\n",
+                    mean(mColdAdapterFtLatencies));
+                printf("[BENCHMARK] lora_avg_warm_adapter_time_to_first_token(ms) %.2f\n",
+                    mean(mWarmAdapterFtLatencies));
+            }
+            std::lock_guard<std::mutex> lk(mIterStatsMutex);
+            printf("[BENCHMARK] lora_host_hit_rate %.3f\n",
+                getHitRate(mLoraCacheStats.numHostHits, mLoraCacheStats.numHostMisses));
+            printf("[BENCHMARK] lora_device_hit_rate %.3f\n",
+                getHitRate(mLoraCacheStats.numDeviceHits, mLoraCacheStats.numDeviceMisses));
+            printf("[BENCHMARK] lora_host_evictions %lu\n", mLoraCacheStats.numHostEvictions);
+            printf("[BENCHMARK] lora_device_evictions %lu\n", mLoraCacheStats.numDeviceEvictions);
+            printf("[BENCHMARK] lora_host_load_time(ms) %.2f\n", mLoraCacheStats.hostLoadMS);
+            printf("[BENCHMARK] lora_device_load_time(ms) %.2f\n", mLoraCacheStats.deviceLoadMS);
+            if (mLoraBaselineTokenThroughput)
+            {
+                printf("[BENCHMARK] baseline_token_throughput(token/sec) %.2f\n",
+                    mLoraBaselineTokenThroughput.value());
+                printf("[BENCHMARK] lora_speedup %.3f\n", getSpeedup(mLoraBaselineTokenThroughput.value()));
+            }
+            printf("\n");
+        }
     }
 
     void writeOpMetricsToCsv()
@@ -702,6 +994,10 @@ public:
 
                 headers.insert(headers.end(), streamingHeaders.begin(), streamingHeaders.end());
             }
+            if (hasSlos())
+            {
+                headers.insert(headers.end(), {"slo_attainment(%)", "goodput(seq/sec)"});
+            }
 
             std::ofstream outputFile(mOpCsvFile);
 
@@ -722,6 +1018,10 @@ public:
                                << mAvgGenT2TLatency << "," << mMaxGenT2TLatency << "," << mMinGenT2TLatency << ","
                                << mP99GenT2TLatency << "," << mP90GenT2TLatency << "," << mP50GenT2TLatency;
                 }
+                if (hasSlos())
+                {
+                    outputFile << "," << mSloAttainment << "," << mGoodput;
+                }
 
                 outputFile << "\n";
             }
@@ -759,6 +1059,33 @@ public:
     }
 
 private:
+    [[nodiscard]] double getSpecDecodingSpeedup() const
+    {
+        return getSpeedup(mBaselineTokenThroughput.value());
+    }
+
+    [[nodiscard]] double getSpeedup(double baselineTokenThroughput) const
+    {
+        return baselineTokenThroughput > 0.0 ? mTokenThroughput / baselineTokenThroughput : 0.0;
+    }
+
+    [[nodiscard]] static double getHitRate(std::uint64_t numHits, std::uint64_t numMisses)
+    {
+        return numHits + numMisses > 0 ? static_cast<double>(numHits) / static_cast<double>(numHits + numMisses) : 0.0;
+    }
+
+    [[nodiscard]] bool hasSlos() const
+    {
+        return mTtftSloMs.has_value() || mItlSloMs.has_value();
+    }
+
+    [[nodiscard]] bool meetsSlo(BenchInfo const& info) const
+    {
+        // Single-token requests have no inter-token latency.
+        return (!mTtftSloMs || info.firstTokenLatency <= mTtftSloMs.value())
+            && (!mItlSloMs || info.avgGenT2TLatency.value_or(0.F) <= mItlSloMs.value());
+    }
+
     std::unordered_map<uint64_t, BenchInfo> mRequestBenchInfos;
 
     std::chrono::time_point<std::chrono::steady_clock> mStart;
@@ -787,6 +1114,36 @@ private:
     float mP50GenT2TLatency{};
     float mMaxGenT2TLatency{};
     float mMinGenT2TLatency{};
+    std::optional<float> mTtftSloMs;
+    std::optional<float> mItlSloMs;
+    float mSloAttainment{};
+    float mGoodput{};
+    std::vector<float> mReqLatencies;
+    std::vector<float> mFtLatencies;
+    std::vector<float> mGenT2TLatencies;
+
+    std::mutex mIterStatsMutex;
+    std::vector<float> mIterLatencies;
+    size_t mPeakGpuMemUsage{};
+    size_t mPeakCpuMemUsage{};
+    size_t mPeakPinnedMemUsage{};
+    SizeType32 mKvMaxNumBlocks{};
+    SizeType32 mKvTokensPerBlock{};
+    SizeType32 mKvPeakUsedBlocks{};
+    SizeType32 mKvAllocTotalBlocks{};
+    SizeType32 mKvReusedBlocks{};
+
+    std::optional<tspec::SpecDecProfile> mSpecDecProfile;
+    std::optional<double> mBaselineTokenThroughput;
+
+    bool mLoraProfile{false};
+    std::optional<double> mLoraBaselineTokenThroughput;
+    std::unordered_set<uint64_t> mLoraTasks;
+    std::vector<float> mColdAdapterLatencies;
+    std::vector<float> mWarmAdapterLatencies;
+    std::vector<float> mColdAdapterFtLatencies;
+    std::vector<float> mWarmAdapterFtLatencies;
+    texec::LoraCacheStats mLoraCacheStats{};
 
     std::string mOpCsvFile;
     bool mStreaming;
@@ -865,9 +1222,9 @@ public:
             TLLM_LOG_ERROR("not a supported executor model type in executor server.");
         }
 
-        if (logIterationData)
+        if (logIterationData || benchmarkParams.reportJsonFile)
         {
-            mCollectStatsThread = std::thread(&ExecutorServer::collectStats, this);
+            mCollectStatsThread = std::thread(&ExecutorServer::collectStats, this, logIterationData);
         }
     }
 
@@ -886,10 +1243,13 @@ public:
         {
             std::vector<SizeType32> inputLengths;
             std::vector<SizeType32> maxNewTokens;
+            std::vector<std::optional<uint64_t>> loraTaskIds;
             for (auto const& request : requests)
             {
                 inputLengths.push_back(request.getInputTokenIds().size());
                 maxNewTokens.push_back(request.getMaxTokens());
+                auto const loraConfig = request.getLoraConfig();
+                loraTaskIds.push_back(loraConfig ? std::make_optional(loraConfig->getTaskId()) : std::nullopt);
             }
             auto const start = std::chrono::steady_clock::now();
             auto reqIds = mExecutor->enqueueRequests(std::move(requests));
@@ -898,6 +1258,10 @@ public:
                 if (!warmup)
                 {
                     mRecorder->recordStart(inputLengths.at(req), maxNewTokens.at(req), reqIds.at(req), start);
+                    if (loraTaskIds.at(req))
+                    {
+                        mRecorder->recordLoraTask(reqIds.at(req), loraTaskIds.at(req).value());
+                    }
                 }
                 mActiveCount++;
             }
@@ -913,6 +1277,11 @@ public:
         mNumFinished = 0;
     }
 
+    void setConcurrency(std::optional<int> concurrency)
+    {
+        mConcurrency = concurrency;
+    }
+
     bool canEnqueue(int numSentRequests) const
     {
         return !mConcurrency || (numSentRequests - mNumFinished < mConcurrency);
@@ -940,21 +1309,25 @@ public:
                 {
                     if (!warmup && !response.hasError())
                     {
-                        mRecorder->recordToken(reqId);
+                        mRecorder->recordToken(reqId, response);
                     }
                 }
             }
         }
     }
 
-    void collectStats() const
+    void collectStats(bool logIterationData) const
     {
         while (!mShutdown)
         {
             auto iterStats = mExecutor->getLatestIterationStats();
             for (auto const& iterStat : iterStats)
             {
-                TLLM_LOG_INFO(texec::JsonSerialization::toJsonStr(iterStat));
+                if (logIterationData)
+                {
+                    TLLM_LOG_INFO(texec::JsonSerialization::toJsonStr(iterStat));
+                }
+                mRecorder->recordIterationStats(iterStat);
             }
             auto const waitSleep = std::chrono::milliseconds(50);
             std::this_thread::sleep_for(waitSleep);
@@ -1263,6 +1636,9 @@ struct Sample
     std::vector<int32_t> inputIds;
     int32_t outputLen;
     int32_t taskId;
+    // Seconds since the start of the trace
+    double arrivalTime{0.0};
+    texec::PriorityType priority{texec::Request::kDefaultPriority};
 };
 
 using Samples = std::vector<Sample>;
@@ -1277,6 +1653,8 @@ Samples parseWorkloadJson(
     auto json = nlohmann::json::parse(jsonStream, nullptr, allowExceptions, ignoreComments);
 
     Samples samples;
+    // Samples with the same prefix_id share their first prefix_len tokens with the first sample of that id.
+    std::unordered_map<int64_t, std::vector<int32_t>> prefixes;
 
     for (auto const& sample : json["samples"])
     {
@@ -1284,11 +1662,22 @@ Samples parseWorkloadJson(
             break;
         int32_t taskId = sample.count("task_id") ? sample["task_id"].template get<int32_t>() : -1;
         auto input_ids(sample["input_ids"].template get<std::vector<int32_t>>());
+        if (sample.count("prefix_id"))
+        {
+            auto const prefixLen = std::min(sample.value("prefix_len", input_ids.size()), input_ids.size());
+            auto const [it, inserted] = prefixes.try_emplace(sample["prefix_id"].template get<int64_t>(),
+                input_ids.begin(), input_ids.begin() + static_cast<std::ptrdiff_t>(prefixLen));
+            if (!inserted)
+            {
+                std::copy_n(it->second.begin(), std::min(prefixLen, it->second.size()), input_ids.begin());
+            }
+        }
         if (maxPromptLen && (input_ids.size() > maxPromptLen.value()))
         {
             input_ids.resize(maxPromptLen.value());
         }
-        samples.emplace_back(Sample{std::move(input_ids), sample["output_len"], taskId});
+        samples.emplace_back(Sample{std::move(input_ids), sample["output_len"], taskId,
+            sample.value("arrival_time", 0.0), sample.value("priority", texec::Request::kDefaultPriority)});
     }
     return samples;
 }
@@ -1398,7 +1787,8 @@ texec::Request makeExecutorRequest(Sample const& sample, SizeType32 const& beamW
 {
     auto samplingConfig = texec::SamplingConfig{beamWidth};
     auto outputConfig = texec::OutputConfig{false, returnContextLogits, returnGenerationLogits, false};
-    return texec::Request(sample.inputIds, sample.outputLen, streaming, samplingConfig, outputConfig, eosId, padId,
+    auto request = texec::Request(sample.inputIds, sample.outputLen, streaming, samplingConfig, outputConfig, eosId,
+        padId,
         std::nullopt,    // positionIds
         std::nullopt,    // badWords
         std::nullopt,    // stopWords
@@ -1409,6 +1799,77 @@ texec::Request makeExecutorRequest(Sample const& sample, SizeType32 const& beamW
         lookaheadConfig, // lookaheadConfig
         std::nullopt,    // logitsPostProcessorName
         encoderInputTokenIds.has_value() ? encoderInputTokenIds : std::nullopt);
+    request.setPriority(sample.priority);
+    return request;
+}
+
+//! Params of a run of the JSON report, runs of two reports with the same params are compared.
+nlohmann::json makeRunParams(std::string const& datasetPath, int beamWidth)
+{
+    return {{"dataset", std::filesystem::path(datasetPath).filename().string()}, {"beam_width", beamWidth}};
+}
+
+nlohmann::json makeReportOptions(std::string const& api, BenchmarkParams const& benchmarkParams)
+{
+    nlohmann::json options;
+    options["api"] = api;
+    options["streaming"] = benchmarkParams.streaming;
+    options["enable_kv_cache_reuse"] = benchmarkParams.enableBlockReuse;
+    options["enable_chunked_context"] = benchmarkParams.enableChunkedContext;
+    options["trace_replay"] = benchmarkParams.traceReplay;
+    options["spec_decoding_profile"] = benchmarkParams.specDecodingProfile;
+    if (benchmarkParams.multiLora)
+    {
+        auto const& multiLora = benchmarkParams.multiLora.value();
+        options["multi_lora"] = {{"adapters", multiLora.numAdapters}, {"ranks", multiLora.ranks},
+            {"zipf", multiLora.zipfExponent}, {"cold_ratio", multiLora.coldRatio}};
+    }
+    options["gpu_weights_percent"] = benchmarkParams.gpuWeightsPercent;
+    if (benchmarkParams.requestRate)
+    {
+        options["request_rate"] = benchmarkParams.requestRate.value();
+    }
+    if (benchmarkParams.concurrency)
+    {
+        options["concurrency"] = benchmarkParams.concurrency.value();
+    }
+    if (benchmarkParams.maxBatchSize)
+    {
+        options["max_batch_size"] = benchmarkParams.maxBatchSize.value();
+    }
+    if (benchmarkParams.maxNumTokens)
+    {
+        options["max_num_tokens"] = benchmarkParams.maxNumTokens.value();
+    }
+    if (benchmarkParams.freeGpuMemoryFraction)
+    {
+        options["kv_cache_free_gpu_mem_fraction"] = benchmarkParams.freeGpuMemoryFraction.value();
+    }
+    if (benchmarkParams.sweep)
+    {
+        auto const& sweep = benchmarkParams.sweep.value();
+        auto& sweepOptions = options["sweep"];
+        sweepOptions["concurrencies"] = sweep.concurrencies;
+        sweepOptions["shapes"] = nlohmann::json::array();
+        for (auto const& shape : sweep.shapes)
+        {
+            sweepOptions["shapes"].push_back({shape.inputLen, shape.outputLen});
+        }
+        sweepOptions["warm_up_rounds"] = sweep.warmUpRounds;
+        sweepOptions["window_rounds"] = sweep.windowRounds;
+    }
+    return options;
+}
+
+void writeJsonReport(Recorder& recorder, std::string const& api, std::filesystem::path const& engineDir,
+    std::string const& datasetPath, int beamWidth, BenchmarkParams const& benchmarkParams)
+{
+    auto report = treport::makeReport(
+        "gptManagerBenchmark", treport::makeEngineFingerprint(engineDir), makeReportOptions(api, benchmarkParams));
+    auto run = recorder.toJson();
+    run["params"] = makeRunParams(datasetPath, beamWidth);
+    report["runs"].push_back(std::move(run));
+    treport::writeReport(benchmarkParams.reportJsonFile.value(), report);
 }
 
 void benchmarkGptManager(std::filesystem::path const& engineDir, TrtGptModelType modelType,
@@ -1560,6 +2021,10 @@ void benchmarkGptManager(std::filesystem::path const& engineDir, TrtGptModelType
         recorder->report();
         recorder->writeOpMetricsToCsv();
         recorder->dumpResponseSeqs();
+        if (benchmarkParams.reportJsonFile)
+        {
+            writeJsonReport(*recorder, "gptManager", engineDir, datasetPath, beamWidth, benchmarkParams);
+        }
         if (dumpProfile)
         {
             // Do per-layer profiling after normal benchmarking to avoid introducing perf overhead.
@@ -1586,6 +2051,135 @@ void benchmarkGptManager(std::filesystem::path const& engineDir, TrtGptModelType
     gptServer->waitBatchManager();
 }
 
+//! Run every point of the sweep grid on the executor, then report the points and the throughput-latency frontier.
+void runSweep(ExecutorServer& executorServer, Recorder& recorder, Samples const& samples, SizeType32 vocabSize,
+    int beamWidth, std::optional<int32_t> const& eosId, std::optional<int32_t> const& padId,
+    bool returnContextLogits, bool returnGenerationLogits, std::filesystem::path const& engineDir,
+    std::string const& datasetPath, BenchmarkParams const& benchmarkParams)
+{
+    auto const& config = benchmarkParams.sweep.value();
+    auto const grid = tsweep::makeGrid(config);
+    std::mt19937 generator(benchmarkParams.randomSeed);
+    std::uniform_int_distribution<int32_t> tokenDistribution(0, vocabSize - 1);
+
+    std::vector<nlohmann::json> runs;
+    std::vector<double> throughputs;
+    std::vector<double> latencies;
+    for (auto const& point : grid)
+    {
+        auto const numWarmUp = static_cast<std::size_t>(config.warmUpRounds) * point.concurrency;
+        auto const numRequests = numWarmUp + static_cast<std::size_t>(config.windowRounds) * point.concurrency;
+        std::vector<texec::Request> requests;
+        requests.reserve(numRequests);
+        for (std::size_t i = 0; i < numRequests; ++i)
+        {
+            Sample sample = samples.at(i % samples.size());
+            if (point.shape)
+            {
+                sample.inputIds.resize(point.shape->inputLen);
+                std::generate(sample.inputIds.begin(), sample.inputIds.end(),
+                    [&]() { return tokenDistribution(generator); });
+                sample.outputLen = point.shape->outputLen;
+            }
+            requests.emplace_back(makeExecutorRequest(sample, beamWidth, eosId, padId, benchmarkParams.streaming,
+                returnContextLogits, returnGenerationLogits, std::nullopt, benchmarkParams.requestLookaheadConfig));
+        }
+
+        recorder.clearRequests();
+        executorServer.setConcurrency(point.concurrency);
+        executorServer.resetNumFinished();
+        std::thread waitThread([numRequests, &executorServer]() { executorServer.waitForResponses(numRequests); });
+        tsweep::Clock::time_point windowStart;
+        tsweep::Clock::time_point windowEnd;
+        std::size_t numSentRequests = 0;
+        while (numSentRequests < numRequests)
+        {
+            if (executorServer.canEnqueue(numSentRequests))
+            {
+                if (numSentRequests == numWarmUp)
+                {
+                    windowStart = tsweep::Clock::now();
+                }
+                if (numSentRequests == numRequests - 1)
+                {
+                    windowEnd = tsweep::Clock::now();
+                }
+                executorServer.enqueue({requests.at(numSentRequests)});
+                numSentRequests += 1;
+            }
+        }
+        waitThread.join();
+
+        auto window = tsweep::measureWindow(recorder.getRequestTimings(), windowStart, windowEnd);
+        nlohmann::json run;
+        run["params"] = makeRunParams(datasetPath, beamWidth);
+        run["params"]["concurrency"] = point.concurrency;
+        if (point.shape)
+        {
+            run["params"]["input_len"] = point.shape->inputLen;
+            run["params"]["output_len"] = point.shape->outputLen;
+        }
+        auto& metrics = run["metrics"];
+        metrics["num_samples"] = window.numSamples;
+        metrics["num_error_samples"] = window.numErrorSamples;
+        metrics["window(ms)"] = window.windowMs;
+        metrics["seq_throughput(seq/sec)"] = window.seqThroughput;
+        metrics["token_throughput(token/sec)"] = window.tokenThroughput;
+        auto& distributions = run["distributions"];
+        distributions["sequence_latency(ms)"] = treport::makeDistribution(std::move(window.seqLatencies));
+        if (benchmarkParams.streaming)
+        {
+            distributions["time_to_first_token(ms)"] = treport::makeDistribution(std::move(window.ftLatencies));
+            distributions["inter_token_latency(ms)"] = treport::makeDistribution(std::move(window.itLatencies));
+        }
+        auto const& seqLatency = distributions["sequence_latency(ms)"];
+        throughputs.push_back(window.tokenThroughput);
+        latencies.push_back(seqLatency.value("p99", 0.0));
+        printf("[BENCHMARK] sweep concurrency %d input_len %d output_len %d token_throughput(token/sec) %.2f "
+               "p99_sequence_latency(ms) %.2f\n",
+            point.concurrency, point.shape ? point.shape->inputLen : -1, point.shape ? point.shape->outputLen : -1,
+            window.tokenThroughput, latencies.back());
+        runs.push_back(std::move(run));
+    }
+
+    // The frontier of every shape, the points of a shape are consecutive in the grid by increasing concurrency
+    printf("\n[BENCHMARK] throughput-latency frontier\n");
+    for (std::size_t begin = 0; begin < grid.size();)
+    {
+        auto end = begin + 1;
+        while (end < grid.size() && grid[end].concurrency > grid[end - 1].concurrency)
+        {
+            ++end;
+        }
+        auto const onFrontier = tsweep::getFrontier(std::vector<double>(throughputs.begin() + begin,
+                                                        throughputs.begin() + end),
+            std::vector<double>(latencies.begin() + begin, latencies.begin() + end));
+        for (auto i = begin; i < end; ++i)
+        {
+            runs[i]["sweep"]["on_frontier"] = static_cast<bool>(onFrontier[i - begin]);
+            if (onFrontier[i - begin])
+            {
+                printf("[BENCHMARK] frontier concurrency %d input_len %d output_len %d token_throughput(token/sec) "
+                       "%.2f p99_sequence_latency(ms) %.2f\n",
+                    grid[i].concurrency, grid[i].shape ? grid[i].shape->inputLen : -1,
+                    grid[i].shape ? grid[i].shape->outputLen : -1, throughputs[i], latencies[i]);
+            }
+        }
+        begin = end;
+    }
+
+    if (benchmarkParams.reportJsonFile)
+    {
+        auto report = treport::makeReport("gptManagerBenchmark", treport::makeEngineFingerprint(engineDir),
+            makeReportOptions("executor", benchmarkParams));
+        for (auto& run : runs)
+        {
+            report["runs"].push_back(std::move(run));
+        }
+        treport::writeReport(benchmarkParams.reportJsonFile.value(), report);
+    }
+}
+
 void benchmarkExecutor(std::optional<std::filesystem::path> const& decoderEngineDir,
     std::optional<std::filesystem::path> const& encoderEngineDir, TrtGptModelType modelType,
     std::string const& datasetPath, std::string const& opCsvFile, int maxNumSamples, int beamWidth, int warmUp,
@@ -1598,10 +2192,46 @@ void benchmarkExecutor(std::optional<std::filesystem::path> const& decoderEngine
     auto worldRank = world.getRank();
 
     // Load dataset
-    auto const samples = parseWorkloadJson(datasetPath, maxNumSamples, maxPromptLen);
+    auto samples = parseWorkloadJson(datasetPath, maxNumSamples, maxPromptLen);
     auto const numSamples = samples.size();
+    if (benchmarkParams.traceReplay)
+    {
+        std::stable_sort(samples.begin(), samples.end(),
+            [](Sample const& lhs, Sample const& rhs) { return lhs.arrivalTime < rhs.arrivalTime; });
+    }
 
     auto recorder = std::make_shared<Recorder>(opCsvFile, benchmarkParams.streaming, beamWidth);
+    recorder->setLatencySlos(benchmarkParams.ttftSloMs, benchmarkParams.itlSloMs);
+    if (benchmarkParams.specDecodingProfile)
+    {
+        TLLM_CHECK_WITH_INFO(
+            decoderEngineDir.has_value(), "The speculative decoding profile requires a decoder engine.");
+        auto const jsonConfig = GptJsonConfig::parse(decoderEngineDir.value() / "config.json");
+        std::optional<double> baselineTokenThroughput;
+        if (benchmarkParams.specDecodingBaselineReport)
+        {
+            baselineTokenThroughput = treport::readBaselineTokenThroughput(
+                benchmarkParams.specDecodingBaselineReport.value(), makeRunParams(datasetPath, beamWidth));
+        }
+        recorder->enableSpecDecodingProfile(
+            jsonConfig.getModelConfig().getMaxDecodingDraftTokens(), baselineTokenThroughput);
+    }
+    std::optional<tlora::MultiLoraWorkload> loraWorkload;
+    std::optional<tlora::SyntheticLoraAdapters> loraAdapters;
+    if (benchmarkParams.multiLora)
+    {
+        TLLM_CHECK_WITH_INFO(decoderEngineDir.has_value(), "The multi-LoRA workload requires a decoder engine.");
+        auto const jsonConfig = GptJsonConfig::parse(decoderEngineDir.value() / "config.json");
+        loraWorkload.emplace(benchmarkParams.multiLora.value(), benchmarkParams.randomSeed);
+        loraAdapters.emplace(jsonConfig.getModelConfig(), benchmarkParams.multiLora->ranks);
+        std::optional<double> baselineTokenThroughput;
+        if (benchmarkParams.loraBaselineReport)
+        {
+            baselineTokenThroughput = treport::readBaselineTokenThroughput(
+                benchmarkParams.loraBaselineReport.value(), makeRunParams(datasetPath, beamWidth));
+        }
+        recorder->enableLoraProfile(baselineTokenThroughput);
+    }
     int32_t decoderStartTokenId = 0;
     std::shared_ptr<ExecutorServer> executorServer;
 
@@ -1710,6 +2340,15 @@ void benchmarkExecutor(std::optional<std::filesystem::path> const& decoderEngine
             executorServer->waitForResponses(warmUp, true);
         }
 
+        if (benchmarkParams.sweep)
+        {
+            auto const jsonConfig = GptJsonConfig::parse(decoderEngineDir.value() / "config.json");
+            runSweep(*executorServer, *recorder, samples, jsonConfig.getModelConfig().getVocabSize(), beamWidth, eosId,
+                padId, returnContextLogits, returnGenerationLogits, decoderEngineDir.value(), datasetPath,
+                benchmarkParams);
+            return;
+        }
+
         // Benchmark
         {
             auto timeDelays = computeTimeDelays(benchmarkParams, numSamples - 1);
@@ -1721,13 +2360,19 @@ void benchmarkExecutor(std::optional<std::filesystem::path> const& decoderEngine
             for (std::size_t i = 0; i < numSamples; ++i)
             {
                 std::optional<texec::LoraConfig> loraConfig;
-                if (samples[i].taskId >= 0)
+                if (loraWorkload)
+                {
+                    auto const adapter = loraWorkload->next();
+                    loraConfig = loraAdapters->makeConfig(adapter.taskId, adapter.rank);
+                }
+                else if (samples[i].taskId >= 0)
                 {
                     loraConfig = texec::LoraConfig(samples[i].taskId);
                 }
                 if (executorModelType == texec::ModelType::kENCODER_DECODER)
                 {
                     Sample s{std::vector<int32_t>{decoderStartTokenId}, samples[i].outputLen, samples[i].taskId};
+                    s.priority = samples[i].priority;
                     requests.emplace_back(makeExecutorRequest(s, beamWidth, eosId, padId, benchmarkParams.streaming,
                         returnContextLogits, returnGenerationLogits, loraConfig, benchmarkParams.requestLookaheadConfig,
                         samples[i].inputIds));
@@ -1743,7 +2388,24 @@ void benchmarkExecutor(std::optional<std::filesystem::path> const& decoderEngine
             bool const hasDelay
                 = std::any_of(timeDelays.begin(), timeDelays.end(), [](auto const& delay) { return delay > 0.0; });
             executorServer->resetNumFinished();
-            if (!staticEmulatedBatchSize)
+            if (benchmarkParams.traceReplay)
+            {
+                std::thread waitThread(
+                    [numSamples, executorServer]() { executorServer->waitForResponses(numSamples); });
+
+                // Open loop: every request is sent at its arrival time, even if earlier ones have not finished.
+                auto const replayStart = std::chrono::steady_clock::now();
+                auto const traceStart = numSamples > 0 ? samples.front().arrivalTime : 0.0;
+                for (std::size_t i = 0; i < numSamples; ++i)
+                {
+                    std::this_thread::sleep_until(replayStart
+                        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(samples[i].arrivalTime - traceStart)));
+                    executorServer->enqueue({requests.at(i)});
+                }
+                waitThread.join();
+            }
+            else if (!staticEmulatedBatchSize)
             {
                 // Launch a thread that will wait for responses
                 std::thread waitThread(
@@ -1789,6 +2451,11 @@ void benchmarkExecutor(std::optional<std::filesystem::path> const& decoderEngine
         recorder->calculateMetrics();
         recorder->report();
         recorder->writeOpMetricsToCsv();
+        if (benchmarkParams.reportJsonFile)
+        {
+            writeJsonReport(*recorder, "executor", decoderEngineDir.value_or(encoderEngineDir.value_or("")),
+                datasetPath, beamWidth, benchmarkParams);
+        }
         // Send terminateReqId to terminate servers on all ranks
         // Sever on rank 0 will broadcast the terminate signal to other servers on multi-GPU cases
         // gptServer->enqueue(std::make_shared<InferenceRequest>(terminateReqId));
@@ -1878,6 +2545,56 @@ int main(int argc, char* argv[])
         "request rate in reqs/sec. Skipping this arg or negative value will trigger offline/0-delay.",
         cxxopts::value<float>());
     options.add_options()("concurrency", "Concurrent number of connections with the server.", cxxopts::value<int>());
+    options.add_options()("report_json_file",
+        "Write a JSON report with the full latency distributions, iteration stats and engine fingerprint. Reports of "
+        "two runs can be compared with compare_reports.py.",
+        cxxopts::value<std::string>());
+    options.add_options()("spec_decoding_profile",
+        "Profile speculative decoding: the acceptance rate of every draft position per request. Requires streaming and "
+        "the executor api.",
+        cxxopts::value<bool>()->default_value("false"));
+    options.add_options()("spec_decoding_baseline_report",
+        "JSON report of a run of the same dataset without speculative decoding, to report the speedup of the token "
+        "throughput against. Requires spec_decoding_profile.",
+        cxxopts::value<std::string>());
+    options.add_options()("multi_lora_adapters",
+        "Serve every request with a LoRA adapter drawn from a Zipf distribution over this many adapters, with "
+        "synthetic weights, replacing the task ids of the dataset. Requires the executor api.",
+        cxxopts::value<int>());
+    options.add_options()("multi_lora_ranks", "Ranks of the multi-LoRA adapters in turn, e.g. \"8,16,64\".",
+        cxxopts::value<std::vector<int>>()->default_value("8"));
+    options.add_options()("multi_lora_zipf", "Zipf exponent of the multi-LoRA adapter popularity, 0 is uniform.",
+        cxxopts::value<double>()->default_value("1.0"));
+    options.add_options()("multi_lora_cold_ratio",
+        "Share of the multi-LoRA requests that go to an adapter never seen before.",
+        cxxopts::value<double>()->default_value("0.0"));
+    options.add_options()("lora_baseline_report",
+        "JSON report of a run of the same dataset with the base model only, to report the speedup of the token "
+        "throughput against. Requires multi_lora_adapters.",
+        cxxopts::value<std::string>());
+    options.add_options()("trace_replay",
+        "Enqueue every sample at its arrival_time (seconds) from the dataset. Only supported with the executor api.",
+        cxxopts::value<bool>()->default_value("false"));
+    options.add_options()("sweep_concurrency",
+        "Sweep the concurrencies, e.g. \"1,4,16,64\", on one executor and report the throughput-latency frontier "
+        "instead of a single run. Only supported with the executor api and decoder engines.",
+        cxxopts::value<std::vector<int>>());
+    options.add_options()("sweep_lengths",
+        "Input and output lengths of the synthetic prompts of the sweep, e.g. \"128:128,1024:256\". The samples of "
+        "the dataset by default.",
+        cxxopts::value<std::string>());
+    options.add_options()("sweep_warm_up_rounds",
+        "Requests of every sweep point before its steady-state window, in multiples of the concurrency.",
+        cxxopts::value<int>()->default_value("1"));
+    options.add_options()("sweep_window_rounds",
+        "Requests of every sweep point in its steady-state window, in multiples of the concurrency.",
+        cxxopts::value<int>()->default_value("8"));
+    options.add_options()("ttft_slo_ms",
+        "Time to first token target (ms) of the SLO attainment and goodput metrics, requires streaming.",
+        cxxopts::value<float>());
+    options.add_options()("itl_slo_ms",
+        "Average inter-token latency target (ms) of the SLO attainment and goodput metrics, requires streaming.",
+        cxxopts::value<float>());
     options.add_options()("max_batch_size", "The max runtime batch size when benchmarking", cxxopts::value<int>());
     options.add_options()(
         "max_num_tokens", "The max runtime number of tokens per batch when benchmarking", cxxopts::value<int>());
@@ -1895,7 +2612,7 @@ int main(int argc, char* argv[])
     options.add_options()("return_generation_logits", "Whether to return generation logits.",
         cxxopts::value<bool>()->default_value("false"));
 
-    options.add_options()("scheduler_policy", "Choose scheduler policy between max_utilization/guaranteed_no_evict.",
+    options.add_options()("scheduler_policy", "Choose scheduler policy between max_utilization/guaranteed_no_evict/priority_preemptive.",
         cxxopts::value<std::string>()->default_value("guaranteed_no_evict"));
 
     options.add_options()("first_batch_delay",
@@ -2064,6 +2781,78 @@ int main(int argc, char* argv[])
         benchmarkParams.concurrency = result["concurrency"].as<int>();
     }
 
+    // Argument: JSON report
+    if (result.count("report_json_file"))
+    {
+        benchmarkParams.reportJsonFile = result["report_json_file"].as<std::string>();
+    }
+
+    // Argument: speculative decoding profile
+    benchmarkParams.specDecodingProfile = result["spec_decoding_profile"].as<bool>();
+    if (result.count("spec_decoding_baseline_report"))
+    {
+        benchmarkParams.specDecodingBaselineReport = result["spec_decoding_baseline_report"].as<std::string>();
+    }
+    TLLM_CHECK_WITH_INFO(benchmarkParams.streaming || !benchmarkParams.specDecodingProfile,
+        "spec_decoding_profile requires streaming.");
+    TLLM_CHECK_WITH_INFO(benchmarkParams.specDecodingProfile || !benchmarkParams.specDecodingBaselineReport,
+        "spec_decoding_baseline_report requires spec_decoding_profile.");
+
+    // Argument: multi-LoRA workload
+    if (result.count("multi_lora_adapters"))
+    {
+        tlora::MultiLoraConfig multiLora;
+        multiLora.numAdapters = result["multi_lora_adapters"].as<int>();
+        multiLora.ranks = result["multi_lora_ranks"].as<std::vector<int>>();
+        multiLora.zipfExponent = result["multi_lora_zipf"].as<double>();
+        multiLora.coldRatio = result["multi_lora_cold_ratio"].as<double>();
+        benchmarkParams.multiLora = multiLora;
+    }
+    if (result.count("lora_baseline_report"))
+    {
+        benchmarkParams.loraBaselineReport = result["lora_baseline_report"].as<std::string>();
+    }
+    TLLM_CHECK_WITH_INFO(benchmarkParams.multiLora || !benchmarkParams.loraBaselineReport,
+        "lora_baseline_report requires multi_lora_adapters.");
+
+    // Argument: trace replay
+    benchmarkParams.traceReplay = result["trace_replay"].as<bool>();
+    TLLM_CHECK_WITH_INFO(
+        !(benchmarkParams.traceReplay && (result.count("request_rate") || result.count("concurrency"))),
+        "trace_replay cannot be combined with request_rate or concurrency.");
+
+    // Argument: sweep
+    if (result.count("sweep_concurrency"))
+    {
+        tsweep::SweepConfig sweep;
+        sweep.concurrencies = result["sweep_concurrency"].as<std::vector<int>>();
+        if (result.count("sweep_lengths"))
+        {
+            sweep.shapes = tsweep::parseShapes(result["sweep_lengths"].as<std::string>());
+        }
+        sweep.warmUpRounds = result["sweep_warm_up_rounds"].as<int>();
+        sweep.windowRounds = result["sweep_window_rounds"].as<int>();
+        benchmarkParams.sweep = sweep;
+    }
+    TLLM_CHECK_WITH_INFO(benchmarkParams.sweep || !result.count("sweep_lengths"),
+        "sweep_lengths requires sweep_concurrency.");
+    TLLM_CHECK_WITH_INFO(!(benchmarkParams.sweep
+                             && (benchmarkParams.traceReplay || result.count("request_rate")
+                                 || result.count("concurrency"))),
+        "sweep_concurrency cannot be combined with trace_replay, request_rate or concurrency.");
+
+    // Argument: SLO targets
+    if (result.count("ttft_slo_ms"))
+    {
+        benchmarkParams.ttftSloMs = result["ttft_slo_ms"].as<float>();
+    }
+    if (result.count("itl_slo_ms"))
+    {
+        benchmarkParams.itlSloMs = result["itl_slo_ms"].as<float>();
+    }
+    TLLM_CHECK_WITH_INFO(benchmarkParams.streaming || !(benchmarkParams.ttftSloMs || benchmarkParams.itlSloMs),
+        "ttft_slo_ms and itl_slo_ms require streaming.");
+
     // Argument: request rate
     if (result.count("max_batch_size"))
     {
@@ -2156,6 +2945,19 @@ int main(int argc, char* argv[])
 
         batchTimeout = std::chrono::milliseconds{result["static_emulated_timeout"].as<int32_t>()};
     }
+    TLLM_CHECK_WITH_INFO(!benchmarkParams.traceReplay || (api == "executor" && !staticEmulatedBatchSize),
+        "trace_replay is only supported with the executor api and without static_emulated_batch_size.");
+    TLLM_CHECK_WITH_INFO(!benchmarkParams.specDecodingProfile || api == "executor",
+        "spec_decoding_profile is only supported with the executor api.");
+    TLLM_CHECK_WITH_INFO(!benchmarkParams.multiLora || api == "executor",
+        "multi_lora_adapters is only supported with the executor api.");
+    TLLM_CHECK_WITH_INFO(!benchmarkParams.multiLora || !benchmarkParams.loraDir,
+        "multi_lora_adapters generates its own adapters and cannot be combined with lora_dir.");
+    TLLM_CHECK_WITH_INFO(!benchmarkParams.sweep
+            || (api == "executor" && !staticEmulatedBatchSize && !result.count("encoder_engine_dir")
+                && !benchmarkParams.multiLora),
+        "sweep_concurrency is only supported with the executor api and decoder engines, without "
+        "static_emulated_batch_size and multi_lora_adapters.");
 
     // Argument: Scheduler policy
     texec::CapacitySchedulerPolicy capacitySchedulerPolicy;
@@ -2168,6 +2970,10 @@ int main(int argc, char* argv[])
     {
         capacitySchedulerPolicy = texec::CapacitySchedulerPolicy::kGUARANTEED_NO_EVICT;
     }
+    else if (capacitySchedulerPolicyArg == "priority_preemptive")
+    {
+        capacitySchedulerPolicy = texec::CapacitySchedulerPolicy::kPRIORITY_PREEMPTIVE;
+    }
     else
     {
         TLLM_LOG_ERROR("Unexpected scheduler policy: " + capacitySchedulerPolicyArg);
@@ -0,0 +1,183 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/executor/tensor.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/modelConfig.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Load generator of multi-LoRA serving benchmarks.
+//
+// Production traffic to a LoRA endpoint is skewed: a few adapters get most of the requests and a long tail of them is
+// rarely used, so the adapter caches see a mix of hits and cold loads. The workload assigns every request an adapter
+// drawn from a Zipf distribution over numAdapters adapters, adapter k with a probability proportional to
+// 1 / (k + 1)^zipfExponent, and sends a share of the requests to adapters that were never seen before. The adapters
+// have the ranks of the rank mix in turn. All adapters of a rank share zero weights, which cost as much to load and
+// run as real ones of the rank.
+namespace tensorrt_llm::benchmark::lora
+{
+
+struct MultiLoraConfig
+{
+    //! Number of adapters the popular requests are spread over
+    std::int32_t numAdapters{0};
+    //! Ranks of the adapters, adapter k has rank ranks[k % ranks.size()]
+    std::vector<std::int32_t> ranks{8};
+    //! Skew of the adapter popularity, 0 is uniform
+    double zipfExponent{1.0};
+    //! Share of the requests that go to a new adapter
+    double coldRatio{0.0};
+};
+
+class MultiLoraWorkload
+{
+public:
+    struct Assignment
+    {
+        std::uint64_t taskId;
+        std::int32_t rank;
+    };
+
+    MultiLoraWorkload(MultiLoraConfig config, std::uint32_t seed)
+        : mConfig{std::move(config)}
+        , mGenerator{seed}
+        , mNextColdTaskId{static_cast<std::uint64_t>(std::max(mConfig.numAdapters, 0))}
+    {
+        TLLM_CHECK_WITH_INFO(mConfig.numAdapters > 0, "The multi-LoRA workload needs at least one adapter.");
+        TLLM_CHECK_WITH_INFO(!mConfig.ranks.empty()
+                && std::all_of(mConfig.ranks.begin(), mConfig.ranks.end(), [](auto rank) { return rank > 0; }),
+            "The ranks of the multi-LoRA workload must be positive.");
+        TLLM_CHECK_WITH_INFO(mConfig.zipfExponent >= 0.0, "The Zipf exponent must not be negative.");
+        TLLM_CHECK_WITH_INFO(
+            mConfig.coldRatio >= 0.0 && mConfig.coldRatio <= 1.0, "The cold adapter ratio must be in [0, 1].");
+        auto const weights = getZipfWeights(mConfig.numAdapters, mConfig.zipfExponent);
+        mPopularity = std::discrete_distribution<std::uint64_t>(weights.begin(), weights.end());
+    }
+
+    //! \brief The adapter of the next request.
+    Assignment next()
+    {
+        auto const taskId = mConfig.coldRatio > 0.0 && mUniform(mGenerator) < mConfig.coldRatio
+            ? mNextColdTaskId++
+            : mPopularity(mGenerator);
+        return {taskId, getRank(taskId)};
+    }
+
+    [[nodiscard]] std::int32_t getRank(std::uint64_t taskId) const
+    {
+        return mConfig.ranks[taskId % mConfig.ranks.size()];
+    }
+
+    //! \brief Number of new adapters handed out so far.
+    [[nodiscard]] std::uint64_t getNumColdAdapters() const
+    {
+        return mNextColdTaskId - static_cast<std::uint64_t>(mConfig.numAdapters);
+    }
+
+    //! \brief Relative popularity of the adapters, 1 / (k + 1)^exponent for adapter k.
+    [[nodiscard]] static std::vector<double> getZipfWeights(std::int32_t numAdapters, double exponent)
+    {
+        std::vector<double> weights(std::max(numAdapters, 0));
+        for (std::size_t k = 0; k < weights.size(); ++k)
+        {
+            weights[k] = 1.0 / std::pow(static_cast<double>(k + 1), exponent);
+        }
+        return weights;
+    }
+
+private:
+    MultiLoraConfig mConfig;
+    std::mt19937 mGenerator;
+    std::discrete_distribution<std::uint64_t> mPopularity;
+    std::uniform_real_distribution<double> mUniform{0.0, 1.0};
+    std::uint64_t mNextColdTaskId;
+};
+
+//! \brief Zero LoRA weights of every module and layer of a model, one set per rank, for the requests of the workload.
+//! \details Every request carries the weights of its adapter, so that an adapter evicted from the host cache is loaded
+//! again instead of failing the request.
+class SyntheticLoraAdapters
+{
+public:
+    //! Values per row of a LoRA config: module id, layer id and rank
+    static std::int32_t constexpr kConfigRowSize = 3;
+
+    SyntheticLoraAdapters(runtime::ModelConfig const& modelConfig, std::vector<std::int32_t> const& ranks)
+    {
+        auto const& modules = modelConfig.getLoraModules();
+        TLLM_CHECK_WITH_INFO(!modules.empty(), "The multi-LoRA workload requires an engine built with LoRA modules.");
+        auto const numLayers = modelConfig.getNbAttentionLayers();
+        auto const numRows = static_cast<runtime::SizeType32>(numLayers * modules.size());
+        for (auto const rank : ranks)
+        {
+            TLLM_CHECK_WITH_INFO(rank <= modelConfig.getMaxLoraRank(),
+                "LoRA rank %d exceeds the max LoRA rank %d of the engine.", rank, modelConfig.getMaxLoraRank());
+            if (mAdapters.count(rank) > 0)
+            {
+                continue;
+            }
+            runtime::SizeType32 width = 0;
+            for (auto const& module : modules)
+            {
+                width = std::max(width, module.flattenedInOutSize(rank));
+            }
+            auto weights = runtime::BufferManager::cpu(
+                runtime::ITensor::makeShape({numRows, width}), modelConfig.getDataType());
+            std::memset(weights->data(), 0, weights->getSizeInBytes());
+            auto config = runtime::BufferManager::cpu(
+                runtime::ITensor::makeShape({numRows, kConfigRowSize}), nvinfer1::DataType::kINT32);
+            auto* configRows = runtime::bufferCast<std::int32_t>(*config);
+            for (runtime::SizeType32 layer = 0; layer < numLayers; ++layer)
+            {
+                for (std::size_t m = 0; m < modules.size(); ++m)
+                {
+                    auto* row = configRows + (layer * modules.size() + m) * kConfigRowSize;
+                    row[0] = modules[m].value();
+                    row[1] = layer;
+                    row[2] = rank;
+                }
+            }
+            mAdapters.emplace(rank,
+                std::make_pair(executor::detail::ofITensor(std::move(weights)),
+                    executor::detail::ofITensor(std::move(config))));
+        }
+    }
+
+    [[nodiscard]] executor::LoraConfig makeConfig(std::uint64_t taskId, std::int32_t rank) const
+    {
+        auto const& [weights, config] = mAdapters.at(rank);
+        return executor::LoraConfig(taskId, weights, config);
+    }
+
+private:
+    std::map<std::int32_t, std::pair<executor::Tensor, executor::Tensor>> mAdapters;
+};
+
+} // namespace tensorrt_llm::benchmark::lora
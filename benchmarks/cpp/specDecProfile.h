@@ -0,0 +1,161 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <numeric>
+#include <string>
+#include <vector>
+
+// Acceptance profile of speculative decoding runs, for the "speculative" entry of the JSON reports.
+//
+// Every decoding step of a request with speculative decoding emits the accepted draft tokens plus one token of the
+// target model. A step that accepted k draft tokens accepted the draft positions 0..k-1 and rejected position k,
+// unless k is the max draft length. The profile keeps the histogram of k per request and over all requests, from
+// which the acceptance rate of every draft position follows: the share of the steps reaching the position that
+// accepted it. This is what tree shapes and lookahead window sizes are tuned on, positions with a low conditional
+// acceptance rate are not worth drafting.
+namespace tensorrt_llm::benchmark::specdec
+{
+
+class SpecDecProfile
+{
+public:
+    //! \param maxDraftLen Max number of draft tokens per step of the engine, 0 if unknown. Unknown, the longest
+    //! accepted draft observed counts as the max.
+    explicit SpecDecProfile(std::int32_t maxDraftLen = 0)
+        : mMaxDraftLen{std::max(maxDraftLen, 0)}
+    {
+    }
+
+    //! \brief Record a step of a request that emitted numTokens tokens. The first step of every request is its
+    //! context phase, which drafts nothing and is skipped.
+    void recordStep(std::uint64_t requestId, std::int32_t numTokens)
+    {
+        auto [it, isNew] = mRequestSteps.try_emplace(requestId);
+        if (isNew || numTokens <= 0)
+        {
+            return;
+        }
+        auto const accepted = static_cast<std::size_t>(numTokens - 1);
+        addTo(it->second, accepted);
+        addTo(mHistogram, accepted);
+    }
+
+    //! \brief Number of steps that accepted k draft tokens, by k.
+    [[nodiscard]] std::vector<std::uint64_t> const& getHistogram() const noexcept
+    {
+        return mHistogram;
+    }
+
+    [[nodiscard]] std::uint64_t getNumSteps() const
+    {
+        return std::accumulate(mHistogram.begin(), mHistogram.end(), std::uint64_t{0});
+    }
+
+    //! \brief Mean number of tokens emitted per step, accepted draft tokens plus the token of the target model.
+    [[nodiscard]] double getTokensPerStep() const
+    {
+        auto const numSteps = getNumSteps();
+        if (numSteps == 0)
+        {
+            return 0.0;
+        }
+        double accepted{0.0};
+        for (std::size_t k = 0; k < mHistogram.size(); ++k)
+        {
+            accepted += static_cast<double>(k * mHistogram[k]);
+        }
+        return 1.0 + accepted / static_cast<double>(numSteps);
+    }
+
+    //! \brief Acceptance rate of every draft position, given that the previous positions were accepted.
+    [[nodiscard]] std::vector<double> getAcceptanceByPosition() const
+    {
+        return acceptanceByPosition(mHistogram, getMaxDraftLen());
+    }
+
+    [[nodiscard]] std::int32_t getMaxDraftLen() const noexcept
+    {
+        return mMaxDraftLen > 0 ? mMaxDraftLen : static_cast<std::int32_t>(std::max(mHistogram.size(), size_t{1}) - 1);
+    }
+
+    [[nodiscard]] static std::vector<double> acceptanceByPosition(
+        std::vector<std::uint64_t> const& histogram, std::int32_t maxDraftLen)
+    {
+        std::vector<double> rates(static_cast<std::size_t>(maxDraftLen), 0.0);
+        // Steps that reached the position, i.e. accepted all the positions before it
+        std::uint64_t reached{0};
+        for (auto const count : histogram)
+        {
+            reached += count;
+        }
+        for (std::size_t position = 0; position < rates.size() && reached > 0; ++position)
+        {
+            auto const rejected = position < histogram.size() ? histogram[position] : 0;
+            rates[position] = static_cast<double>(reached - rejected) / static_cast<double>(reached);
+            reached -= rejected;
+        }
+        return rates;
+    }
+
+    [[nodiscard]] nlohmann::json toJson() const
+    {
+        auto const maxDraftLen = getMaxDraftLen();
+        nlohmann::json profile;
+        profile["max_draft_len"] = maxDraftLen;
+        profile["num_steps"] = getNumSteps();
+        profile["tokens_per_step"] = getTokensPerStep();
+        profile["accepted_length_histogram"] = padded(mHistogram, maxDraftLen);
+        profile["acceptance_by_position"] = getAcceptanceByPosition();
+        auto& requests = profile["requests"] = nlohmann::json::array();
+        for (auto const& [requestId, histogram] : mRequestSteps)
+        {
+            requests.push_back({{"request_id", requestId},
+                {"accepted_length_histogram", padded(histogram, maxDraftLen)},
+                {"acceptance_by_position", acceptanceByPosition(histogram, maxDraftLen)}});
+        }
+        return profile;
+    }
+
+private:
+    static void addTo(std::vector<std::uint64_t>& histogram, std::size_t accepted)
+    {
+        if (histogram.size() <= accepted)
+        {
+            histogram.resize(accepted + 1, 0);
+        }
+        ++histogram[accepted];
+    }
+
+    static std::vector<std::uint64_t> padded(std::vector<std::uint64_t> histogram, std::int32_t maxDraftLen)
+    {
+        histogram.resize(std::max(histogram.size(), static_cast<std::size_t>(maxDraftLen) + 1), 0);
+        return histogram;
+    }
+
+    std::int32_t mMaxDraftLen;
+    std::vector<std::uint64_t> mHistogram;
+    // Ordered, so that the requests of a report are sorted by id
+    std::map<std::uint64_t, std::vector<std::uint64_t>> mRequestSteps;
+};
+
+} // namespace tensorrt_llm::benchmark::specdec
@@ -0,0 +1,222 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the time from process start to an executor ready for requests, broken down into the startup phases of
+// common::getStartupStats. Every run of the binary is one sample: a startup is only cold once per process.
+#include "benchmarkReport.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/startupProfiler.h"
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/plugins/api/tllmPlugin.h"
+#include "tensorrt_llm/runtime/gptJsonConfig.h"
+#include "tensorrt_llm/runtime/tllmLogger.h"
+#include "tensorrt_llm/runtime/warmupPlanner.h"
+
+#include <NvInfer.h>
+#include <chrono>
+#include <cxxopts.hpp>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+namespace texec = tensorrt_llm::executor;
+namespace treport = tensorrt_llm::benchmark::report;
+namespace trt = nvinfer1;
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<texec::SizeType32> parseList(std::string const& arg)
+{
+    std::istringstream stream{arg};
+    std::vector<texec::SizeType32> values;
+    for (std::string token; std::getline(stream, token, ';');)
+    {
+        values.push_back(std::stoi(token));
+    }
+    return values;
+}
+
+double msSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void printStartupStats(texec::StartupStats const& stats, double constructionMs, std::optional<double> warmupMs)
+{
+    std::cout << std::fixed << std::setprecision(1) << "[BENCHMARK] executor_construction_ms " << constructionMs
+              << "\n";
+    if (warmupMs)
+    {
+        std::cout << "[BENCHMARK] warmup_ms " << *warmupMs << "\n";
+    }
+    std::cout << "[BENCHMARK] startup_total_ms " << stats.totalDurationMS << "\n";
+    for (auto const& phase : stats.phases)
+    {
+        std::cout << "[BENCHMARK] " << std::left << std::setw(24) << phase.name << std::right << std::setw(12)
+                  << phase.durationMS << " ms" << std::setw(8) << phase.count << "x" << std::setw(8)
+                  << (stats.totalDurationMS > 0 ? 100.0 * phase.durationMS / stats.totalDurationMS : 0.0) << " %\n";
+    }
+    std::cout << std::flush;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto const processStart = Clock::now();
+
+    cxxopts::Options options(
+        "TensorRT-LLM C++ Startup Benchmark", "Time to bring up an executor, broken down into startup phases.");
+    options.add_options()("h,help", "Print usage");
+    options.add_options()("engine_dir", "Directory that store the engines.", cxxopts::value<std::string>());
+    options.add_options()("free_gpu_memory_fraction", "Fraction of the free GPU memory given to the KV cache.",
+        cxxopts::value<float>()->default_value("0.9"));
+    options.add_options()("warmup", "Run a warmup after construction and include it in the time to ready.",
+        cxxopts::value<bool>()->default_value("false"));
+    options.add_options()("warmup_batch_sizes",
+        "Batch sizes of the warmup, separated by \";\", example: \"1;8;64\".",
+        cxxopts::value<std::string>()->default_value("1"));
+    options.add_options()("warmup_input_lens",
+        "Input lengths of the warmup, separated by \";\", example: \"128;1024\".",
+        cxxopts::value<std::string>()->default_value("128"));
+    options.add_options()(
+        "warmup_output_len", "Output length of the warmup.", cxxopts::value<int>()->default_value("8"));
+    options.add_options()("log_level", "Choose log level between verbose/info/warning/error/internal_error.",
+        cxxopts::value<std::string>()->default_value("error"));
+    options.add_options()("report_json_file",
+        "Write a JSON report with the duration of every startup phase. Reports of two runs, e.g. of two releases, can "
+        "be compared with compare_reports.py.",
+        cxxopts::value<std::string>());
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help"))
+    {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    if (!result.count("engine_dir"))
+    {
+        std::cout << options.help() << std::endl;
+        TLLM_LOG_ERROR("Please specify engine directory.");
+        return 1;
+    }
+    std::filesystem::path const engineDir{result["engine_dir"].as<std::string>()};
+
+    auto logger = std::make_shared<TllmLogger>();
+    auto const logLevel = result["log_level"].as<std::string>();
+    if (logLevel == "verbose")
+    {
+        logger->setLevel(trt::ILogger::Severity::kVERBOSE);
+    }
+    else if (logLevel == "info")
+    {
+        logger->setLevel(trt::ILogger::Severity::kINFO);
+    }
+    else if (logLevel == "warning")
+    {
+        logger->setLevel(trt::ILogger::Severity::kWARNING);
+    }
+    else if (logLevel == "error")
+    {
+        logger->setLevel(trt::ILogger::Severity::kERROR);
+    }
+    else if (logLevel == "internal_error")
+    {
+        logger->setLevel(trt::ILogger::Severity::kINTERNAL_ERROR);
+    }
+    else
+    {
+        TLLM_LOG_ERROR("Unexpected log level: " + logLevel);
+        return 1;
+    }
+    initTrtLlmPlugins(logger.get());
+
+    try
+    {
+        texec::KvCacheConfig kvCacheConfig;
+        kvCacheConfig.setFreeGpuMemoryFraction(result["free_gpu_memory_fraction"].as<float>());
+        texec::ExecutorConfig executorConfig;
+        executorConfig.setKvCacheConfig(kvCacheConfig);
+
+        auto const constructionStart = Clock::now();
+        texec::Executor executor{engineDir, texec::ModelType::kDECODER_ONLY, executorConfig};
+        auto const constructionMs = msSince(constructionStart);
+
+        std::optional<double> warmupMs;
+        if (result["warmup"].as<bool>())
+        {
+            texec::WarmupConfig const warmupConfig{parseList(result["warmup_batch_sizes"].as<std::string>()),
+                parseList(result["warmup_input_lens"].as<std::string>()), result["warmup_output_len"].as<int>()};
+            auto const jsonConfig = GptJsonConfig::parse(engineDir / "config.json");
+            auto const limits
+                = WarmupPlanner::getLimits(jsonConfig.getModelConfig(), executorConfig.getEnableChunkedContext());
+            auto const warmupStart = Clock::now();
+            [[maybe_unused]] auto const warmupStats = WarmupPlanner::run(executor, warmupConfig, limits);
+            warmupMs = msSince(warmupStart);
+        }
+        auto const timeToReadyMs = msSince(processStart);
+
+        // In leader mode, the stats and the report come from the rank that accepts requests.
+        if (!executor.canEnqueueRequests())
+        {
+            return 0;
+        }
+        auto const stats = tensorrt_llm::common::getStartupStats();
+        std::cout << std::fixed << std::setprecision(1) << "[BENCHMARK] time_to_ready_ms " << timeToReadyMs << "\n";
+        printStartupStats(stats, constructionMs, warmupMs);
+
+        if (result.count("report_json_file"))
+        {
+            nlohmann::json reportOptions;
+            reportOptions["free_gpu_memory_fraction"] = result["free_gpu_memory_fraction"].as<float>();
+            reportOptions["warmup"] = result["warmup"].as<bool>();
+            auto report = treport::makeReport(
+                "startupBenchmark", treport::makeEngineFingerprint(engineDir), std::move(reportOptions));
+
+            nlohmann::json run;
+            run["params"]["warmup"] = result["warmup"].as<bool>();
+            auto& metrics = run["metrics"];
+            metrics["time_to_ready_ms"] = timeToReadyMs;
+            metrics["executor_construction_ms"] = constructionMs;
+            metrics["startup_total_ms"] = stats.totalDurationMS;
+            for (auto const& phase : stats.phases)
+            {
+                metrics[phase.name + "_ms"] = phase.durationMS;
+            }
+            report["runs"].push_back(std::move(run));
+            treport::writeReport(result["report_json_file"].as<std::string>(), report);
+        }
+    }
+    catch (std::exception const& e)
+    {
+        TLLM_LOG_ERROR(e.what());
+        return 1;
+    }
+    return 0;
+}
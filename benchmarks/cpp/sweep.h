@@ -0,0 +1,206 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Grid of operating points of an in-process sweep, and the measurement of every point.
+//
+// Every point runs a closed loop of requests at a fixed concurrency, the requests of a point have a fixed input and
+// output length or the lengths of the dataset. The first warmUpRounds * concurrency requests fill the batch, the
+// steady-state window spans from the enqueue of the next request to the enqueue of the last one, after which the
+// number of requests in flight drains. Latencies are taken over the requests enqueued in the window, the throughput
+// over the tokens generated in the window. The points of a shape that no other point of the shape beats in both
+// throughput and p99 latency form the throughput-latency frontier.
+namespace tensorrt_llm::benchmark::sweep
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct SweepShape
+{
+    std::int32_t inputLen;
+    std::int32_t outputLen;
+};
+
+struct SweepConfig
+{
+    std::vector<std::int32_t> concurrencies;
+    //! Input and output lengths of the synthetic prompts, empty to run the samples of the dataset
+    std::vector<SweepShape> shapes;
+    //! Requests before the window, in multiples of the concurrency
+    std::int32_t warmUpRounds{1};
+    //! Requests in the window, in multiples of the concurrency
+    std::int32_t windowRounds{8};
+};
+
+struct SweepPoint
+{
+    std::int32_t concurrency;
+    std::optional<SweepShape> shape;
+};
+
+//! \brief Parse input and output lengths, e.g. "128:128,1024:256".
+inline std::vector<SweepShape> parseShapes(std::string const& input)
+{
+    std::vector<SweepShape> shapes;
+    std::istringstream stream(input);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        auto const colon = item.find(':');
+        TLLM_CHECK_WITH_INFO(colon != std::string::npos, "Expected input_len:output_len, got \"%s\".", item.c_str());
+        SweepShape const shape{std::stoi(item.substr(0, colon)), std::stoi(item.substr(colon + 1))};
+        TLLM_CHECK_WITH_INFO(shape.inputLen > 0 && shape.outputLen > 0, "Sweep lengths must be positive.");
+        shapes.push_back(shape);
+    }
+    return shapes;
+}
+
+//! \brief The points of the grid, by shape and then by increasing concurrency.
+inline std::vector<SweepPoint> makeGrid(SweepConfig const& config)
+{
+    TLLM_CHECK_WITH_INFO(!config.concurrencies.empty(), "The sweep needs at least one concurrency.");
+    TLLM_CHECK_WITH_INFO(std::all_of(config.concurrencies.begin(), config.concurrencies.end(),
+                             [](auto concurrency) { return concurrency > 0; }),
+        "Sweep concurrencies must be positive.");
+    TLLM_CHECK_WITH_INFO(config.warmUpRounds >= 1 && config.windowRounds >= 1,
+        "The sweep needs at least one warm-up and one window round.");
+    auto concurrencies = config.concurrencies;
+    std::sort(concurrencies.begin(), concurrencies.end());
+    concurrencies.erase(std::unique(concurrencies.begin(), concurrencies.end()), concurrencies.end());
+
+    std::vector<std::optional<SweepShape>> shapes(config.shapes.begin(), config.shapes.end());
+    if (shapes.empty())
+    {
+        shapes.emplace_back(std::nullopt);
+    }
+    std::vector<SweepPoint> grid;
+    for (auto const& shape : shapes)
+    {
+        for (auto const concurrency : concurrencies)
+        {
+            grid.push_back(SweepPoint{concurrency, shape});
+        }
+    }
+    return grid;
+}
+
+struct RequestTiming
+{
+    Clock::time_point start;
+    Clock::time_point end;
+    //! Set for streaming requests
+    std::optional<Clock::time_point> firstToken;
+    std::int32_t outputLength{0};
+    bool hasError{false};
+};
+
+struct WindowMetrics
+{
+    std::int32_t numSamples{0};
+    std::int32_t numErrorSamples{0};
+    double windowMs{0.0};
+    double seqThroughput{0.0};
+    double tokenThroughput{0.0};
+    std::vector<float> seqLatencies;
+    std::vector<float> ftLatencies;
+    std::vector<float> itLatencies;
+};
+
+//! \brief Metrics of the steady-state window [windowStart, windowEnd).
+//! \details The tokens of a request count towards the throughput in the share of its lifetime that overlaps the
+//! window, as if they were generated at a constant rate, so long requests straddling the window edges count for what
+//! they generated inside it.
+inline WindowMetrics measureWindow(
+    std::vector<RequestTiming> const& timings, Clock::time_point windowStart, Clock::time_point windowEnd)
+{
+    auto const ms = [](Clock::duration duration)
+    { return std::chrono::duration<double, std::milli>(duration).count(); };
+    WindowMetrics metrics;
+    metrics.windowMs = ms(windowEnd - windowStart);
+    double numTokens = 0.0;
+    double numSequences = 0.0;
+    for (auto const& timing : timings)
+    {
+        if (timing.hasError)
+        {
+            metrics.numErrorSamples += timing.start >= windowStart && timing.start < windowEnd;
+            continue;
+        }
+        auto const lifetime = ms(timing.end - timing.start);
+        auto const overlap = ms(std::min(timing.end, windowEnd) - std::max(timing.start, windowStart));
+        if (lifetime > 0.0 && overlap > 0.0)
+        {
+            numTokens += timing.outputLength * overlap / lifetime;
+        }
+        if (timing.end >= windowStart && timing.end < windowEnd)
+        {
+            numSequences += 1.0;
+        }
+        if (timing.start < windowStart || timing.start >= windowEnd)
+        {
+            continue;
+        }
+        ++metrics.numSamples;
+        metrics.seqLatencies.push_back(static_cast<float>(lifetime));
+        if (timing.firstToken)
+        {
+            metrics.ftLatencies.push_back(static_cast<float>(ms(timing.firstToken.value() - timing.start)));
+            if (timing.outputLength > 1)
+            {
+                metrics.itLatencies.push_back(
+                    static_cast<float>(ms(timing.end - timing.firstToken.value()) / (timing.outputLength - 1)));
+            }
+        }
+    }
+    if (metrics.windowMs > 0.0)
+    {
+        metrics.seqThroughput = numSequences / (metrics.windowMs / 1000);
+        metrics.tokenThroughput = numTokens / (metrics.windowMs / 1000);
+    }
+    return metrics;
+}
+
+//! \brief Whether every point is on the frontier: no other point has at least its throughput and at most its latency,
+//! with one of them strictly better.
+inline std::vector<bool> getFrontier(std::vector<double> const& throughputs, std::vector<double> const& latencies)
+{
+    TLLM_CHECK(throughputs.size() == latencies.size());
+    std::vector<bool> onFrontier(throughputs.size(), true);
+    for (std::size_t i = 0; i < throughputs.size(); ++i)
+    {
+        for (std::size_t j = 0; j < throughputs.size() && onFrontier[i]; ++j)
+        {
+            auto const dominates = throughputs[j] >= throughputs[i] && latencies[j] <= latencies[i]
+                && (throughputs[j] > throughputs[i] || latencies[j] < latencies[i]);
+            onFrontier[i] = !dominates;
+        }
+    }
+    return onFrontier;
+}
+
+} // namespace tensorrt_llm::benchmark::sweep
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+using BlockHashType = std::uint64_t;
+
+//! \brief Chained 64-bit hashes of KV cache blocks.
+//! \details The hash of a block covers its tokens, the LoRA task id and the hash of the previous block of the
+//! sequence, so a single value identifies the whole prefix ending with the block. It is computed once per block and
+//! used as lookup key afterwards, without building BlockKey objects or hashing token vectors again.
+//!
+//! These hashes are independent of BlockKeyHasher, which keys the reuse tree of the block manager. They are the
+//! block hashes of the KVCacheEvents emitted through KVCacheEventManager and of the in-tree indices built on them.
+struct ChainedBlockHasher
+{
+    [[nodiscard]] static BlockHashType mix(BlockHashType value) noexcept
+    {
+        value = (value ^ (value >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+        value = (value ^ (value >> 27)) * UINT64_C(0x94d049bb133111eb);
+        return value ^ (value >> 31);
+    }
+
+    //! \brief Hash the tokens [begin, end) of a block, chaining in the hash of the previous block of the sequence.
+    [[nodiscard]] static BlockHashType hash(runtime::VecUniqueTokens::const_iterator begin,
+        runtime::VecUniqueTokens::const_iterator end, runtime::LoraTaskIdType loraTaskId,
+        BlockHashType parentHash = 0) noexcept
+    {
+        auto seed = static_cast<BlockHashType>(std::distance(begin, end));
+        for (auto it = begin; it != end; ++it)
+        {
+            uint32_t a = static_cast<uint32_t>(it->tokenId);
+            a = ((a >> 16) ^ a) * 0x45d9f3b;
+            a = ((a >> 16) ^ a) * 0x45d9f3b;
+            a = (a >> 16) ^ a;
+
+            auto const b = mix(it->tokenExtraId);
+
+            seed ^= a + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= b + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+
+        seed ^= mix(loraTaskId) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= mix(parentHash) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+};
+
+//! \brief Compute the chained hashes of all blocks holding tokens.
+//! \details Entry i covers tokens [0, (i + 1) * tokensPerBlock). A trailing partial block is hashed only if
+//! includePartialBlock is set.
+[[nodiscard]] inline std::vector<BlockHashType> computeBlockHashes(runtime::VecUniqueTokens const& tokens,
+    runtime::SizeType32 tokensPerBlock, runtime::LoraTaskIdType loraTaskId, bool includePartialBlock = false)
+{
+    TLLM_CHECK(tokensPerBlock > 0);
+    auto const numTokens = static_cast<runtime::SizeType32>(tokens.size());
+    auto const numBlocks = includePartialBlock ? (numTokens + tokensPerBlock - 1) / tokensPerBlock
+                                               : numTokens / tokensPerBlock;
+    std::vector<BlockHashType> blockHashes;
+    blockHashes.reserve(numBlocks);
+    BlockHashType parentHash{0};
+    for (runtime::SizeType32 blockIdx = 0; blockIdx < numBlocks; ++blockIdx)
+    {
+        auto const begin = tokens.begin() + blockIdx * tokensPerBlock;
+        auto const end = tokens.begin() + std::min(numTokens, (blockIdx + 1) * tokensPerBlock);
+        parentHash = ChainedBlockHasher::hash(begin, end, loraTaskId, parentHash);
+        blockHashes.push_back(parentHash);
+    }
+    return blockHashes;
+}
+
+// Chained block hashes are already well mixed, use them as bucket index directly.
+struct BlockHashIdentity
+{
+    std::size_t operator()(BlockHashType blockHash) const noexcept
+    {
+        return static_cast<std::size_t>(blockHash);
+    }
+};
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
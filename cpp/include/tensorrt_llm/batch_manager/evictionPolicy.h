@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <chrono>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+//! \brief Queue of free blocks bucketed by retention priority.
+//! \details Eviction takes the least recently released block of the lowest non-empty priority bucket, so blocks of
+//! one-off requests are reused before blocks of pinned prefixes such as shared system prompts. A block released with a
+//! retention duration falls back to the default priority once the duration has expired, see refresh().
+//! \tparam BlockPtrT Handle of a block, must be hashable (e.g. std::shared_ptr<KVCacheBlock>).
+template <typename BlockPtrT>
+class PriorityFreeBlockQueue
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using Priority = executor::RetentionPriority;
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr Priority kMinPriority = executor::KvCacheRetentionConfig::kMinRetentionPriority;
+    static constexpr Priority kMaxPriority = executor::KvCacheRetentionConfig::kMaxRetentionPriority;
+    static constexpr Priority kDefaultPriority = executor::KvCacheRetentionConfig::kDefaultRetentionPriority;
+
+    PriorityFreeBlockQueue()
+        : mBuckets(kMaxPriority - kMinPriority + 1)
+    {
+    }
+
+    //! \brief Add a freed block to the queue.
+    //! \param toFront Put the block at the front of its bucket, i.e. evict it before older blocks of equal priority.
+    void release(BlockPtrT const& block, Priority priority = kDefaultPriority,
+        std::optional<std::chrono::milliseconds> duration = std::nullopt, bool toFront = false,
+        Clock::time_point now = Clock::now())
+    {
+        TLLM_CHECK_WITH_INFO(mEntries.find(block) == mEntries.end(), "Block is already in the free queue");
+        TLLM_CHECK_WITH_INFO(priority >= kMinPriority && priority <= kMaxPriority, "Invalid retention priority %d",
+            priority);
+        std::optional<Clock::time_point> expiry;
+        if (duration && priority != kDefaultPriority)
+        {
+            expiry = now + *duration;
+        }
+        insert(block, priority, expiry, toFront);
+    }
+
+    //! \brief Add a freed block using the retention config of the request that stored it.
+    void release(BlockPtrT const& block, std::optional<executor::KvCacheRetentionConfig> const& config,
+        bool toFront = false, Clock::time_point now = Clock::now())
+    {
+        if (config)
+        {
+            release(block, config->getPriority(), config->getDuration(), toFront, now);
+        }
+        else
+        {
+            release(block, kDefaultPriority, std::nullopt, toFront, now);
+        }
+    }
+
+    //! \brief Remove and return the next block to evict.
+    [[nodiscard]] BlockPtrT popFront()
+    {
+        for (auto& bucket : mBuckets)
+        {
+            if (!bucket.empty())
+            {
+                auto block = std::move(bucket.front());
+                bucket.pop_front();
+                mEntries.erase(block);
+                return block;
+            }
+        }
+        TLLM_THROW("No free blocks left");
+    }
+
+    //! \brief Return the next block to evict without removing it.
+    [[nodiscard]] BlockPtrT const& front() const
+    {
+        for (auto const& bucket : mBuckets)
+        {
+            if (!bucket.empty())
+            {
+                return bucket.front();
+            }
+        }
+        TLLM_THROW("No free blocks left");
+    }
+
+    //! \brief Remove a block from the queue, e.g. because it is reused.
+    //! \return false if the block is not in the queue.
+    bool remove(BlockPtrT const& block)
+    {
+        auto const it = mEntries.find(block);
+        if (it == mEntries.end())
+        {
+            return false;
+        }
+        bucketOf(it->second.priority).erase(it->second.it);
+        mEntries.erase(it);
+        return true;
+    }
+
+    //! \brief Demote blocks whose retention duration has expired to the default priority.
+    //! \return Number of demoted blocks.
+    SizeType32 refresh(Clock::time_point now = Clock::now())
+    {
+        std::vector<BlockPtrT> expired;
+        for (auto const& [block, entry] : mEntries)
+        {
+            if (entry.expiry && *entry.expiry <= now)
+            {
+                expired.push_back(block);
+            }
+        }
+        for (auto const& block : expired)
+        {
+            auto const it = mEntries.find(block);
+            bucketOf(it->second.priority).erase(it->second.it);
+            mEntries.erase(it);
+            // Expired blocks are older than anything released at default priority since.
+            insert(block, kDefaultPriority, std::nullopt, true);
+        }
+        return static_cast<SizeType32>(expired.size());
+    }
+
+    [[nodiscard]] bool contains(BlockPtrT const& block) const
+    {
+        return mEntries.find(block) != mEntries.end();
+    }
+
+    [[nodiscard]] std::optional<Priority> getPriority(BlockPtrT const& block) const
+    {
+        auto const it = mEntries.find(block);
+        return it == mEntries.end() ? std::nullopt : std::make_optional(it->second.priority);
+    }
+
+    [[nodiscard]] SizeType32 size() const noexcept
+    {
+        return static_cast<SizeType32>(mEntries.size());
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return mEntries.empty();
+    }
+
+private:
+    using Bucket = std::list<BlockPtrT>;
+
+    struct Entry
+    {
+        Priority priority;
+        typename Bucket::iterator it;
+        std::optional<Clock::time_point> expiry;
+    };
+
+    [[nodiscard]] Bucket& bucketOf(Priority priority)
+    {
+        return mBuckets[priority - kMinPriority];
+    }
+
+    void insert(BlockPtrT const& block, Priority priority, std::optional<Clock::time_point> expiry, bool toFront)
+    {
+        auto& bucket = bucketOf(priority);
+        auto const it = toFront ? bucket.insert(bucket.begin(), block) : bucket.insert(bucket.end(), block);
+        mEntries.emplace(block, Entry{priority, it, expiry});
+    }
+
+    // One LRU list per priority, least recently released block at the front
+    std::vector<Bucket> mBuckets;
+    std::unordered_map<BlockPtrT, Entry> mEntries;
+};
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/batch_manager/blockHash.h"
+#include "tensorrt_llm/common/boundedQueue.h"
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+//! \brief Collects the events emitted by the block manager when blocks are stored for reuse, removed from the
+//! reuse tree, or moved between GPU and host memory.
+//! \details Events are pushed into a bounded lock-free queue, so emitting never blocks the scheduling loop. When the
+//! queue is full the event is dropped; consumers detect this through a gap in the event ids and getNumDroppedEvents,
+//! and should resynchronize their view of the cache.
+//!
+//! Block hashes are the chained hashes of computeBlockHashes, so that consumers can match the blocks of the events
+//! against the hashes of their own prompts, e.g. runtime::DataParallelRouter.
+class KVCacheEventManager
+{
+public:
+    using IdType = executor::IdType;
+
+    explicit KVCacheEventManager(std::size_t maxNumEvents)
+        : mEvents{maxNumEvents}
+    {
+    }
+
+    void enqueueStoredEvent(std::optional<IdType> parentHash, std::vector<executor::KVCacheStoredBlockData> blocks)
+    {
+        if (blocks.empty())
+        {
+            return;
+        }
+        enqueue(executor::KVCacheStoredData{parentHash, std::move(blocks)});
+    }
+
+    //! \brief Emit the full blocks of a sequence from block firstBlockIdx on as stored.
+    //! \details The hashes of the blocks and of their parent are computed from the tokens with computeBlockHashes.
+    void enqueueStoredEvent(runtime::VecUniqueTokens const& tokens, runtime::SizeType32 tokensPerBlock,
+        std::optional<IdType> loraId, runtime::SizeType32 firstBlockIdx = 0,
+        executor::KVCacheLevel cacheLevel = executor::KVCacheLevel::kGPU)
+    {
+        auto const blockHashes = computeBlockHashes(tokens, tokensPerBlock, loraId.value_or(0));
+        auto const numBlocks = static_cast<runtime::SizeType32>(blockHashes.size());
+        std::vector<executor::KVCacheStoredBlockData> blocks;
+        for (auto blockIdx = firstBlockIdx; blockIdx < numBlocks; ++blockIdx)
+        {
+            executor::KVCacheStoredBlockData block{blockHashes[blockIdx]};
+            auto const begin = tokens.begin() + blockIdx * tokensPerBlock;
+            auto const end = begin + tokensPerBlock;
+            bool const hasExtraIds
+                = std::any_of(begin, end, [](runtime::UniqueToken const& token) { return token.tokenExtraId != 0; });
+            for (auto it = begin; it != end; ++it)
+            {
+                block.tokens.push_back(it->tokenId);
+                if (hasExtraIds)
+                {
+                    block.tokenExtraIds.push_back(it->tokenExtraId);
+                }
+            }
+            block.loraId = loraId;
+            block.cacheLevel = cacheLevel;
+            blocks.push_back(std::move(block));
+        }
+        auto const parentHash
+            = firstBlockIdx > 0 && firstBlockIdx <= numBlocks ? std::optional<IdType>{blockHashes[firstBlockIdx - 1]}
+                                                               : std::nullopt;
+        enqueueStoredEvent(parentHash, std::move(blocks));
+    }
+
+    void enqueueRemovedEvent(std::vector<IdType> blockHashes)
+    {
+        if (blockHashes.empty())
+        {
+            return;
+        }
+        enqueue(executor::KVCacheRemovedData{std::move(blockHashes)});
+    }
+
+    void enqueueUpdatedEvent(IdType blockHash, executor::KVCacheLevel oldLevel, executor::KVCacheLevel newLevel)
+    {
+        enqueue(executor::KVCacheUpdatedData{blockHash, oldLevel, newLevel});
+    }
+
+    //! \brief Remove and return all events emitted so far, oldest first.
+    [[nodiscard]] std::deque<executor::KVCacheEvent> getEvents()
+    {
+        std::deque<executor::KVCacheEvent> events;
+        while (auto event = mEvents.tryPop())
+        {
+            events.push_back(std::move(*event));
+        }
+        return events;
+    }
+
+    [[nodiscard]] std::uint64_t getNumDroppedEvents() const noexcept
+    {
+        return mNumDroppedEvents.load(std::memory_order_relaxed);
+    }
+
+private:
+    void enqueue(executor::KVCacheEventData data)
+    {
+        auto const eventId = mNextEventId.fetch_add(1, std::memory_order_relaxed);
+        if (!mEvents.tryPush(executor::KVCacheEvent{eventId, std::move(data)}))
+        {
+            mNumDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    common::BoundedQueue<executor::KVCacheEvent> mEvents;
+    std::atomic<IdType> mNextEventId{0};
+    std::atomic<std::uint64_t> mNumDroppedEvents{0};
+};
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
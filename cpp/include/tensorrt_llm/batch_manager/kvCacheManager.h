@@ -23,13 +23,17 @@
 #include "tensorrt_llm/runtime/common.h"
 #include "tensorrt_llm/runtime/cudaStream.h"
 #include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/kvBlockCopyBatch.h"
 #include "tensorrt_llm/runtime/modelConfig.h"
+#include "tensorrt_llm/runtime/uvmPrefetcher.h"
 #include "tensorrt_llm/runtime/worldConfig.h"
 
 #include <NvInferRuntime.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <list>
 #include <memory>
 #include <optional>
@@ -327,6 +331,43 @@ public:
 
     void replaceSharedBlock(GenerationRequest& sequence, SizeType32 blockIdx);
 
+    //! \brief Replace the block at blockIdx of every beam that shares it by a private copy, like replaceSharedBlock,
+    //! but collect the copies in copies instead of copying right away, so the copies of all sequences of an iteration
+    //! run in one launch. The shared block stays referenced until copies is executed, which must happen before the
+    //! forward pass writes into the new blocks and while the block manager is alive.
+    //! \param numValidTokens Tokens of the block written so far, the other slots are not copied
+    void replaceSharedBlockDeferred(GenerationRequest& sequence, SizeType32 blockIdx, SizeType32 numValidTokens,
+        runtime::KvBlockCopyBatch& copies)
+    {
+        auto& allocatedBlocks = mAllocatedBlocksPerSeq.at(sequence.getSequenceSlotIdx());
+        for (SizeType32 beamIdx = 0; beamIdx < sequence.getBeamWidth(); ++beamIdx)
+        {
+            auto const sharedId = sequence.getCacheBlockIds().at(beamIdx).at(blockIdx);
+            auto shared = mAllBlocksById.at(sharedId);
+            if (!shared->isShared())
+            {
+                continue;
+            }
+            auto const it = std::find_if(allocatedBlocks.begin(), allocatedBlocks.end(),
+                [sharedId](auto const& block) { return block->getBlockId() == sharedId; });
+            TLLM_CHECK_WITH_INFO(it != allocatedBlocks.end(), "Block %d is not allocated to the sequence", sharedId);
+            auto block = getFreeBlock();
+            block->incRefCount();
+            *it = block;
+            sequence.changeCacheBlock(beamIdx, blockIdx, block->getBlockId());
+            // The reference of the beam on the shared block is dropped once the copy is enqueued
+            copies.add(computeBlockPointer(block)->data(), computeBlockPointer(shared)->data(), numValidTokens,
+                [this, shared]() mutable
+                {
+                    shared->decRefCount();
+                    if (!shared->hasRefs())
+                    {
+                        releaseBlock(shared);
+                    }
+                });
+        }
+    }
+
     //! \brief Release blocks of the sequence. Store blocks for reuse if llmReqeust is provided.
     void releaseBlocks(GenerationRequest& sequence, std::shared_ptr<LlmRequest> const& llmRequest = nullptr);
 
@@ -336,6 +377,103 @@ public:
     //! \brief Release last block in the sequence
     void releaseLastBlock(GenerationRequest& sequence);
 
+    //! \brief Shrink a sequence whose KV cache was compacted to its first newNumTokens tokens and release the blocks
+    //! past them, see runtime::KvCacheEvictionPolicy.
+    void releaseEvictedBlocks(GenerationRequest& sequence, SizeType32 newNumTokens)
+    {
+        auto const numTokens = sequence.getNumTokens();
+        TLLM_CHECK(newNumTokens >= 0 && newNumTokens <= numTokens);
+        auto const numBlocks = (numTokens + mTokensPerBlock - 1) / mTokensPerBlock;
+        auto const newNumBlocks = (newNumTokens + mTokensPerBlock - 1) / mTokensPerBlock;
+        for (auto blockIdx = newNumBlocks; blockIdx < numBlocks; ++blockIdx)
+        {
+            releaseLastBlock(sequence);
+        }
+        sequence.removeTokens(numTokens - newNumTokens);
+    }
+
+    //! \brief Whether the primary pool is in managed memory, see allocatePools.
+    [[nodiscard]] bool isUvm() const
+    {
+        return mPrimaryPool && mPrimaryPool->getMemoryType() == runtime::MemoryType::kUVM;
+    }
+
+    //! \brief Collect the primary blocks of a sequence for prefetching to the device or advising to the host. Blocks
+    //! offloaded to the secondary pool are skipped.
+    void addUvmRanges(GenerationRequest const& sequence, bool toDevice, runtime::UvmPrefetcher& prefetcher) const
+    {
+        for (auto const& block : mAllocatedBlocksPerSeq.at(sequence.getSequenceSlotIdx()))
+        {
+            if (!block->isPrimary())
+            {
+                continue;
+            }
+            auto const blockPointer = computeBlockPointer(block);
+            if (toDevice)
+            {
+                prefetcher.toDevice(blockPointer->data(), blockPointer->getSizeInBytes());
+            }
+            else
+            {
+                prefetcher.toHost(blockPointer->data(), blockPointer->getSizeInBytes());
+            }
+        }
+    }
+
+    //! \brief Release the blocks of a beam search sequence that no beam reads anymore, see
+    //! runtime::BeamBlockReachability. The lists of the beams keep their length, their entries at released blocks point
+    //! to a block read at the same index, which is never read through them.
+    //! \param reachable For the leading block indices, which beams are read there
+    //! \return The number of blocks returned to the free queue
+    SizeType32 releaseUnreachableBlocks(GenerationRequest& sequence, std::vector<std::vector<bool>> const& reachable)
+    {
+        auto const& blockIds = sequence.getCacheBlockIds();
+        auto& allocatedBlocks = mAllocatedBlocksPerSeq.at(sequence.getSequenceSlotIdx());
+        SizeType32 numReleased{0};
+        for (SizeType32 blockIdx = 0; blockIdx < static_cast<SizeType32>(reachable.size()); ++blockIdx)
+        {
+            auto const& beams = reachable[blockIdx];
+            auto const readBeam = std::find(beams.begin(), beams.end(), true);
+            if (readBeam == beams.end())
+            {
+                continue;
+            }
+            // Blocks read through any beam, blocks shared by beams count as read for all of them
+            std::vector<KVCacheBlock::IdType> readIds;
+            for (SizeType32 beamIdx = 0; beamIdx < sequence.getBeamWidth(); ++beamIdx)
+            {
+                if (beams.at(beamIdx))
+                {
+                    readIds.push_back(blockIds.at(beamIdx).at(blockIdx));
+                }
+            }
+            auto const aliasId = blockIds.at(std::distance(beams.begin(), readBeam)).at(blockIdx);
+            for (SizeType32 beamIdx = 0; beamIdx < sequence.getBeamWidth(); ++beamIdx)
+            {
+                auto const blockId = blockIds.at(beamIdx).at(blockIdx);
+                if (std::find(readIds.begin(), readIds.end(), blockId) != readIds.end())
+                {
+                    continue;
+                }
+                // Hand the reference of the beam over to the alias, so releasing the sequence stays balanced
+                auto const it = std::find_if(allocatedBlocks.begin(), allocatedBlocks.end(),
+                    [blockId](auto const& block) { return block->getBlockId() == blockId; });
+                TLLM_CHECK_WITH_INFO(it != allocatedBlocks.end(), "Block %d is not allocated to the sequence", blockId);
+                auto block = *it;
+                *it = mAllBlocksById.at(aliasId);
+                (*it)->incRefCount();
+                sequence.changeCacheBlock(beamIdx, blockIdx, aliasId);
+                block->decRefCount();
+                if (!block->hasRefs())
+                {
+                    releaseBlock(block);
+                    ++numReleased;
+                }
+            }
+        }
+        return numReleased;
+    }
+
     [[nodiscard]] SizeType32 getNumFreeBlocks() const noexcept
     {
         return mFreePrimaryBlocks.size();
@@ -599,6 +737,51 @@ public:
 
     void removeSequence(SizeType32 seqSlotIdx, std::shared_ptr<LlmRequest> const& llmRequest = nullptr);
 
+    /// @brief Release the blocks of a beam search request that no beam reads anymore, so that the scheduler can hand
+    /// them to other requests before the request finishes. See BlockManager::releaseUnreachableBlocks.
+    /// @return The number of released blocks
+    SizeType32 releaseUnreachableBlocks(SizeType32 seqSlotIdx, std::vector<std::vector<bool>> const& reachable)
+    {
+        return mBlockManager.releaseUnreachableBlocks(*mSequences.at(seqSlotIdx), reachable);
+    }
+
+    [[nodiscard]] bool isUvm() const
+    {
+        return mBlockManager.isUvm();
+    }
+
+    /// @brief Move the blocks of an oversubscribed UVM pool ahead of their use. The scheduler calls this once it knows
+    /// the next iteration, with the requests it schedules, whose blocks are prefetched to the device while the current
+    /// iteration runs, and the requests it pauses, whose blocks are advised towards the host. The caller executes the
+    /// prefetcher on a stream of its own. Does nothing unless the pools were allocated in managed memory.
+    void prefetchUvmBlocks(std::vector<SizeType32> const& scheduledSeqSlotIdxs,
+        std::vector<SizeType32> const& pausedSeqSlotIdxs, runtime::UvmPrefetcher& prefetcher) const
+    {
+        if (!isUvm())
+        {
+            return;
+        }
+        for (auto const seqSlotIdx : scheduledSeqSlotIdxs)
+        {
+            mBlockManager.addUvmRanges(*mSequences.at(seqSlotIdx), true, prefetcher);
+        }
+        for (auto const seqSlotIdx : pausedSeqSlotIdxs)
+        {
+            mBlockManager.addUvmRanges(*mSequences.at(seqSlotIdx), false, prefetcher);
+        }
+    }
+
+    /// @brief Give every beam of a request a private copy of the shared block at blockIdx, with the copy deferred to
+    /// copies. See BlockManager::replaceSharedBlockDeferred.
+    void replaceSharedBlockDeferred(SizeType32 seqSlotIdx, SizeType32 blockIdx, runtime::KvBlockCopyBatch& copies)
+    {
+        auto& sequence = *mSequences.at(seqSlotIdx);
+        auto const tokensPerBlock = getTokensPerBlock();
+        auto const numValidTokens
+            = std::clamp(sequence.getNumTokens() - blockIdx * tokensPerBlock, SizeType32{0}, tokensPerBlock);
+        mBlockManager.replaceSharedBlockDeferred(sequence, blockIdx, numValidTokens, copies);
+    }
+
     void schedulingRemoveSequence(SizeType32 seqSlotIdx);
 
     [[nodiscard]] runtime::ITensor::UniquePtr getBlockPoolPointers() const;
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::batch_manager::kv_cache_manager
+{
+
+//! \brief Issues copies of KV cache blocks between the secondary (host) and primary (GPU) pools on a dedicated
+//! stream, so that onboarding can overlap with the forward pass of the current iteration.
+//! \details Every transfer records an event on the copy stream. Consumers never block the host: they make their own
+//! stream wait on the event of the blocks they are about to read, either one at a time or for all pending blocks.
+//! Completed events are recycled to avoid creating CUDA events on the scheduling path.
+class KVCacheTransferManager
+{
+public:
+    using SizeType32 = tensorrt_llm::runtime::SizeType32;
+    using IdType = std::int32_t;
+    using CudaStreamPtr = std::shared_ptr<runtime::CudaStream>;
+    using EventPtr = std::shared_ptr<runtime::CudaEvent>;
+
+    explicit KVCacheTransferManager(CudaStreamPtr copyStream = std::make_shared<runtime::CudaStream>())
+        : mCopyStream{std::move(copyStream)}
+        , mBufferManager{mCopyStream}
+    {
+    }
+
+    //! \brief Start an asynchronous copy of the block with id blockId from src to dst.
+    //! \details src and dst are the raw blocks (K & V, all layers) in their respective pools. The copy is ordered
+    //! after the work enqueued on computeStream so far, which may still read dst or write src, e.g. the forward pass
+    //! of the block that dst held before. If a transfer for the same block is still in flight, the new copy is ordered
+    //! after it by the copy stream.
+    void copyBlockAsync(
+        IdType blockId, runtime::ITensor const& src, runtime::ITensor& dst, runtime::CudaStream const& computeStream)
+    {
+        TLLM_CHECK_WITH_INFO(src.getSizeInBytes() == dst.getSizeInBytes(),
+            "Source and destination block sizes differ (%zu vs %zu)", src.getSizeInBytes(), dst.getSizeInBytes());
+        auto computeEvent = acquireEvent();
+        computeStream.record(*computeEvent);
+        mCopyStream->wait(*computeEvent);
+        releaseEvent(std::move(computeEvent));
+
+        mBufferManager.copy(src, dst);
+        auto event = acquireEvent();
+        mCopyStream->record(*event);
+        auto const [it, inserted] = mPendingTransfers.try_emplace(blockId, event);
+        if (!inserted)
+        {
+            releaseEvent(std::move(it->second));
+            it->second = std::move(event);
+        }
+    }
+
+    //! \brief Make stream wait until the pending transfer of blockId, if any, has completed.
+    //! \details Does not block the host. Returns true if the block had a pending transfer.
+    bool waitBlock(IdType blockId, runtime::CudaStream const& stream)
+    {
+        auto it = mPendingTransfers.find(blockId);
+        if (it == mPendingTransfers.end())
+        {
+            return false;
+        }
+        stream.wait(*it->second);
+        releaseEvent(std::move(it->second));
+        mPendingTransfers.erase(it);
+        return true;
+    }
+
+    //! \brief Make stream wait until the pending transfers of all blockIds have completed.
+    //! \return Number of blocks that had a pending transfer.
+    SizeType32 waitBlocks(std::vector<IdType> const& blockIds, runtime::CudaStream const& stream)
+    {
+        SizeType32 numWaited{0};
+        for (auto const blockId : blockIds)
+        {
+            numWaited += waitBlock(blockId, stream) ? 1 : 0;
+        }
+        return numWaited;
+    }
+
+    //! \brief Make stream wait for every transfer issued so far.
+    void waitAll(runtime::CudaStream const& stream)
+    {
+        if (mPendingTransfers.empty())
+        {
+            return;
+        }
+        // Transfers are serialized on the copy stream, recording once waits for all of them.
+        auto event = acquireEvent();
+        mCopyStream->record(*event);
+        stream.wait(*event);
+        mFreeEvents.push_back(std::move(event));
+        for (auto& [blockId, pendingEvent] : mPendingTransfers)
+        {
+            releaseEvent(std::move(pendingEvent));
+        }
+        mPendingTransfers.clear();
+    }
+
+    //! \brief Drop bookkeeping of transfers that have already completed on the device.
+    //! \details Non-blocking, intended to be called once per iteration.
+    void pollCompleted()
+    {
+        for (auto it = mPendingTransfers.begin(); it != mPendingTransfers.end();)
+        {
+            auto const status = ::cudaEventQuery(it->second->get());
+            if (status == cudaSuccess)
+            {
+                releaseEvent(std::move(it->second));
+                it = mPendingTransfers.erase(it);
+            }
+            else
+            {
+                TLLM_CHECK_WITH_INFO(status == cudaErrorNotReady, "KV cache block transfer failed: %s",
+                    ::cudaGetErrorString(status));
+                ++it;
+            }
+        }
+    }
+
+    [[nodiscard]] bool isPending(IdType blockId) const
+    {
+        return mPendingTransfers.find(blockId) != mPendingTransfers.end();
+    }
+
+    [[nodiscard]] SizeType32 getNumPendingTransfers() const noexcept
+    {
+        return static_cast<SizeType32>(mPendingTransfers.size());
+    }
+
+    [[nodiscard]] runtime::CudaStream const& getCopyStream() const noexcept
+    {
+        return *mCopyStream;
+    }
+
+private:
+    [[nodiscard]] EventPtr acquireEvent()
+    {
+        if (mFreeEvents.empty())
+        {
+            return std::make_shared<runtime::CudaEvent>();
+        }
+        auto event = std::move(mFreeEvents.back());
+        mFreeEvents.pop_back();
+        return event;
+    }
+
+    void releaseEvent(EventPtr event)
+    {
+        // Re-recording an event that was waited on is safe: stream waits capture the state at the time of the call.
+        mFreeEvents.push_back(std::move(event));
+    }
+
+    // Stream on which all block transfers are issued
+    CudaStreamPtr mCopyStream;
+    // Buffer manager bound to the copy stream
+    runtime::BufferManager mBufferManager;
+    // Event of the latest transfer of each block that has not been waited on yet
+    std::unordered_map<IdType, EventPtr> mPendingTransfers;
+    // Recycled events
+    std::vector<EventPtr> mFreeEvents;
+};
+
+} // namespace tensorrt_llm::batch_manager::kv_cache_manager
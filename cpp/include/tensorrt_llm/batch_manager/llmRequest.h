@@ -212,6 +212,7 @@ public:
         {
             mState = LlmRequestState::kDISAGG_GENERATION_INIT;
         }
+        mSamplingConfig.numReturnSequences = mNumReturnSequences;
         if (mIsStreaming && mSamplingConfig.beamWidth > 1 && !mReturnAllGeneratedTokens)
         {
             TLLM_LOG_WARNING(
@@ -444,6 +445,13 @@ public:
         return mNumReturnSequences;
     }
 
+    /// @brief Whether the return sequences are independent samples of the prompt rather than beams. Each sample after
+    /// the first runs in a child request, see createChildRequest, sharing the KV cache blocks of the prompt.
+    [[nodiscard]] bool isParallelSampling() const noexcept
+    {
+        return mSamplingConfig.beamWidth == 1 && mNumReturnSequences > 1;
+    }
+
     /// @brief Get child requests spawned by this req.
     /// @return A vector of child requests.
     [[nodiscard]] std::vector<RequestPtr> const& getChildRequests() const
@@ -651,6 +659,7 @@ public:
             "Cannot set numReturnSequences %d smaller than the number %ld of child requests that have already created.",
             numReturnSequences, mChildRequests.size());
         mNumReturnSequences = numReturnSequences;
+        mSamplingConfig.numReturnSequences = mNumReturnSequences;
         mSequenceFinalVec->resize(mNumReturnSequences);
     }
 
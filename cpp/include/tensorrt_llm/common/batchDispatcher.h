@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/boundedQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace tensorrt_llm::common
+{
+
+//! \brief Fans batches of items out to registered consumers from a single producer thread.
+//! \details Consumers are either callbacks, invoked on the producer thread, or queues drained by a consumer thread.
+//! Registration is copy-on-write, so dispatch only takes a reference to the current consumer list and never waits on
+//! a registration in progress. A batch is delivered once per dispatch, so consumers are woken once per batch rather
+//! than once per item.
+template <typename T>
+class BatchDispatcher
+{
+public:
+    using Batch = std::vector<T>;
+    using Callback = std::function<void(Batch const&)>;
+    using Queue = BoundedQueue<Batch>;
+    using ConsumerId = std::uint64_t;
+
+    BatchDispatcher()
+        : mConsumers{std::make_shared<ConsumerList const>()}
+    {
+    }
+
+    //! \brief Register a callback. It runs on the dispatching thread and must not block.
+    ConsumerId registerCallback(Callback callback)
+    {
+        TLLM_CHECK_WITH_INFO(static_cast<bool>(callback), "Callback must not be empty");
+        return addConsumer(Consumer{0, std::move(callback), nullptr});
+    }
+
+    //! \brief Register a queue. Batches that do not fit in the queue are dropped and counted.
+    ConsumerId registerQueue(std::shared_ptr<Queue> queue)
+    {
+        TLLM_CHECK_WITH_INFO(queue != nullptr, "Queue must not be null");
+        return addConsumer(Consumer{0, nullptr, std::move(queue)});
+    }
+
+    //! \return false if no consumer with this id is registered.
+    bool unregister(ConsumerId id)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto consumers = std::make_shared<ConsumerList>(*std::atomic_load(&mConsumers));
+        auto const it = std::find_if(
+            consumers->begin(), consumers->end(), [id](Consumer const& consumer) { return consumer.id == id; });
+        if (it == consumers->end())
+        {
+            return false;
+        }
+        consumers->erase(it);
+        std::atomic_store(&mConsumers, std::shared_ptr<ConsumerList const>(std::move(consumers)));
+        return true;
+    }
+
+    [[nodiscard]] bool hasConsumers() const
+    {
+        return !std::atomic_load(&mConsumers)->empty();
+    }
+
+    //! \brief Deliver batch to all consumers. Empty batches are not delivered.
+    void dispatch(Batch const& batch)
+    {
+        if (batch.empty())
+        {
+            return;
+        }
+        auto const consumers = std::atomic_load(&mConsumers);
+        for (auto const& consumer : *consumers)
+        {
+            if (consumer.callback)
+            {
+                consumer.callback(batch);
+            }
+            else if (!consumer.queue->tryPush(batch))
+            {
+                mNumDroppedBatches.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    [[nodiscard]] std::size_t getNumDroppedBatches() const noexcept
+    {
+        return mNumDroppedBatches.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Consumer
+    {
+        ConsumerId id;
+        Callback callback;
+        std::shared_ptr<Queue> queue;
+    };
+
+    using ConsumerList = std::vector<Consumer>;
+
+    ConsumerId addConsumer(Consumer consumer)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        consumer.id = mNextId++;
+        auto const id = consumer.id;
+        auto consumers = std::make_shared<ConsumerList>(*std::atomic_load(&mConsumers));
+        consumers->push_back(std::move(consumer));
+        std::atomic_store(&mConsumers, std::shared_ptr<ConsumerList const>(std::move(consumers)));
+        return id;
+    }
+
+    // Serializes registrations, dispatch does not take it
+    std::mutex mMutex;
+    ConsumerId mNextId{0};
+    std::shared_ptr<ConsumerList const> mConsumers;
+    std::atomic<std::size_t> mNumDroppedBatches{0};
+};
+
+} // namespace tensorrt_llm::common
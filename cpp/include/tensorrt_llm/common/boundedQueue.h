@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace tensorrt_llm::common
+{
+
+//! \brief Bounded lock-free multi-producer multi-consumer queue.
+//! \details Ring buffer where every cell carries a sequence number telling producers and consumers whose turn it is
+//! (D. Vyukov's bounded MPMC queue). push fails instead of blocking when the queue is full, so producers on a hot path
+//! never wait for consumers.
+template <typename T>
+class BoundedQueue
+{
+public:
+    //! \param capacity Maximum number of elements, rounded up to the next power of two.
+    explicit BoundedQueue(std::size_t capacity)
+        : mCapacity{roundUpPowerOfTwo(capacity)}
+        , mMask{mCapacity - 1}
+        , mCells{std::make_unique<Cell[]>(mCapacity)}
+    {
+        TLLM_CHECK_WITH_INFO(capacity > 0, "Queue capacity must be positive");
+        for (std::size_t i = 0; i < mCapacity; ++i)
+        {
+            mCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(BoundedQueue const&) = delete;
+    BoundedQueue& operator=(BoundedQueue const&) = delete;
+
+    //! \return false if the queue is full, value is left untouched in that case.
+    bool tryPush(T&& value)
+    {
+        auto pos = mEnqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &mCells[pos & mMask];
+            auto const sequence = cell->sequence.load(std::memory_order_acquire);
+            auto const diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0)
+            {
+                if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = mEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPush(T const& value)
+    {
+        T copy{value};
+        return tryPush(std::move(copy));
+    }
+
+    //! \return std::nullopt if the queue is empty.
+    std::optional<T> tryPop()
+    {
+        auto pos = mDequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &mCells[pos & mMask];
+            auto const sequence = cell->sequence.load(std::memory_order_acquire);
+            auto const diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (mDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return std::nullopt;
+            }
+            else
+            {
+                pos = mDequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        std::optional<T> value{std::move(cell->value)};
+        cell->value = T{};
+        cell->sequence.store(pos + mCapacity, std::memory_order_release);
+        return value;
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept
+    {
+        return mCapacity;
+    }
+
+    //! \brief Approximate number of elements, exact only when no other thread modifies the queue.
+    [[nodiscard]] std::size_t sizeApprox() const noexcept
+    {
+        auto const enqueuePos = mEnqueuePos.load(std::memory_order_relaxed);
+        auto const dequeuePos = mDequeuePos.load(std::memory_order_relaxed);
+        return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    static std::size_t roundUpPowerOfTwo(std::size_t value)
+    {
+        std::size_t result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    static constexpr std::size_t kCacheLineSize = 64;
+
+    std::size_t const mCapacity;
+    std::size_t const mMask;
+    std::unique_ptr<Cell[]> mCells;
+    alignas(kCacheLineSize) std::atomic<std::size_t> mEnqueuePos{0};
+    alignas(kCacheLineSize) std::atomic<std::size_t> mDequeuePos{0};
+};
+
+} // namespace tensorrt_llm::common
@@ -27,6 +27,7 @@
 #include <cuda_bf16.h>
 #endif
 
+#include <chrono>
 #include <cstdlib>
 #include <memory>
 
@@ -211,6 +212,17 @@ enum class MpiThreadSupport : int
     THREAD_MULTIPLE = MPI_THREAD_MULTIPLE,
 };
 
+//! \brief How MpiComm::recvPoll waits for a message.
+//! \details The receiver probes in a busy loop for spinDuration, which catches messages that follow closely, e.g. the
+//! requests of the next iteration. Afterwards it sleeps between probes, starting with minSleep and doubling up to
+//! maxSleep, so an idle receiver does not burn a core.
+struct PollConfig
+{
+    std::chrono::microseconds spinDuration{50};
+    std::chrono::microseconds minSleep{5};
+    std::chrono::microseconds maxSleep{1000};
+};
+
 class MpiRequest
 {
 public:
@@ -387,9 +399,18 @@ public:
     //! \brief Returns if a message with the specified source and tag is available
     bool iprobe(int source, int tag, MPI_Status* status) const;
 
-    //! \brief Poll every periodMs until a message is available
+    //! \brief Poll until a message is available, sleeping at most periodMs between probes. Use 0 for a busy loop.
     void recvPoll(int source, int tag, int periodMs) const;
 
+    //! \brief Poll until a message is available, spinning first and then sleeping as configured.
+    void recvPoll(int source, int tag, PollConfig const& config) const;
+
+    //! \brief Broadcast payload from root with point-to-point messages: a fixed-size header carrying the payload size,
+    //! followed by the payload.
+    //! \details Receivers wait for the header with recvPoll, instead of blocking in a collective, and allocate the
+    //! payload once. Messages of one call use tag, so calls must not overlap on the same tag.
+    void bcastWithHeader(std::vector<char>& payload, int root, int tag, PollConfig const& config = {}) const;
+
     bool operator==(MpiComm const& rhs) const
     {
         return mComm == rhs.mComm;
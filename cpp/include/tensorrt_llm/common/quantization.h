@@ -97,6 +97,11 @@ public:
         return QuantMode(BaseType(1u) << 3 | BaseType(1u) << 4 | BaseType(1u) << 9);
     }
 
+    static constexpr QuantMode int4KvCache() noexcept
+    {
+        return QuantMode(BaseType(1u) << 10);
+    }
+
     constexpr BaseType value() const noexcept
     {
         return mValue;
@@ -152,6 +157,11 @@ public:
         return isSet(fp8KvCache());
     }
 
+    constexpr bool hasInt4KvCache() const noexcept
+    {
+        return isSet(int4KvCache());
+    }
+
     constexpr bool hasFp8Qdq() const noexcept
     {
         return isSet(fp8Qdq());
@@ -164,12 +174,13 @@ public:
 
     constexpr bool hasKvCacheQuant() const noexcept
     {
-        return hasInt8KvCache() || hasFp8KvCache();
+        return hasInt8KvCache() || hasFp8KvCache() || hasInt4KvCache();
     }
 
     static constexpr QuantMode fromDescription(bool quantizeWeights = false, bool quantizeActivations = false,
         bool perToken = false, bool perChannel = false, bool perGroup = false, bool useInt4Weights = false,
-        bool useInt8KvCache = false, bool useFp8KvCache = false, bool useFp8Qdq = false, bool useFp8RowWise = false)
+        bool useInt8KvCache = false, bool useFp8KvCache = false, bool useFp8Qdq = false, bool useFp8RowWise = false,
+        bool useInt4KvCache = false)
     {
         QuantMode quantMode{};
         if (quantizeWeights)
@@ -218,6 +229,11 @@ public:
             quantMode += fp8RowWise();
         }
 
+        if (useInt4KvCache)
+        {
+            quantMode += int4KvCache();
+        }
+
         return quantMode;
     }
 
@@ -292,6 +308,10 @@ public:
         {
             quantMode += fp8KvCache();
         }
+        else if (kvCacheQuantAlgo == "INT4")
+        {
+            quantMode += int4KvCache();
+        }
 
         return quantMode;
     }
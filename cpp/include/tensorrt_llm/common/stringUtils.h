@@ -22,6 +22,7 @@
 #include <cuda_fp16.h>
 
 #include <memory>  // std::make_unique
+#include <optional>
 #include <sstream> // std::stringstream
 #include <string>
 #include <unordered_set>
@@ -110,4 +111,10 @@ inline bool strStartsWith(std::string const& str, std::string const& prefix)
 /// @brief Split a string into a set of strings using a delimiter
 std::unordered_set<std::string> str2set(std::string const& input, char delimiter);
 
+/// @brief Encode bytes as lowercase hex digits, two per byte
+std::string toHex(std::string const& bytes);
+
+/// @brief Decode lowercase hex digits, std::nullopt if the input is not a valid encoding
+std::optional<std::string> fromHex(std::string const& hex);
+
 } // namespace tensorrt_llm::common
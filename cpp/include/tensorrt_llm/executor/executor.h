@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/executor/tensor.h"
 #include "tensorrt_llm/executor/types.h"
 
@@ -28,6 +29,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace tensorrt_llm::mpi
@@ -160,6 +162,53 @@ private:
     std::optional<SizeType32> mNoRepeatNgramSize;
 };
 
+/// @brief Coalescing of the streamed responses of a request, so that the consumer wakes up once per few tokens
+/// instead of once per token. Held tokens are delivered as one response when any of the set conditions holds, and
+/// always with the last response of a sequence. Without any condition, the tokens are only delivered at the end.
+class ResponseCoalescingConfig
+{
+public:
+    explicit ResponseCoalescingConfig(std::optional<SizeType32> maxTokens = std::nullopt,
+        std::optional<std::chrono::milliseconds> maxDelay = std::nullopt, VecTokens flushTokens = {})
+        : mMaxTokens{maxTokens}
+        , mMaxDelay{maxDelay}
+        , mFlushTokens{std::move(flushTokens)}
+    {
+        TLLM_CHECK_WITH_INFO(!maxTokens || *maxTokens > 0, "Max tokens must be positive");
+        TLLM_CHECK_WITH_INFO(!maxDelay || maxDelay->count() >= 0, "Max delay must not be negative");
+    }
+
+    [[nodiscard]] std::optional<SizeType32> getMaxTokens() const noexcept
+    {
+        return mMaxTokens;
+    }
+
+    [[nodiscard]] std::optional<std::chrono::milliseconds> getMaxDelay() const noexcept
+    {
+        return mMaxDelay;
+    }
+
+    [[nodiscard]] VecTokens const& getFlushTokens() const noexcept
+    {
+        return mFlushTokens;
+    }
+
+    bool operator==(ResponseCoalescingConfig const& other) const noexcept
+    {
+        return mMaxTokens == other.mMaxTokens && mMaxDelay == other.mMaxDelay && mFlushTokens == other.mFlushTokens;
+    }
+
+private:
+    friend class Serialization;
+
+    /// @brief Deliver once this many tokens are held
+    std::optional<SizeType32> mMaxTokens;
+    /// @brief Deliver once the oldest held token waited this long
+    std::optional<std::chrono::milliseconds> mMaxDelay;
+    /// @brief Deliver after any of these tokens, e.g. the ones ending a sentence or a line
+    VecTokens mFlushTokens;
+};
+
 /// @brief Configuration that controls the outputs of a Result
 class OutputConfig
 {
@@ -280,6 +329,179 @@ private:
     SizeType32 mVerificationSetSize;
 };
 
+/// @brief Configuration for the retention of KV cache blocks once they are freed, see
+/// batch_manager::kv_cache_manager::PriorityFreeBlockQueue. Blocks of higher priority are evicted after blocks of lower
+/// priority, blocks of equal priority in LRU order.
+class KvCacheRetentionConfig
+{
+public:
+    static constexpr RetentionPriority kMinRetentionPriority = 0;
+    static constexpr RetentionPriority kMaxRetentionPriority = 100;
+    static constexpr RetentionPriority kDefaultRetentionPriority = 35;
+
+    explicit KvCacheRetentionConfig(RetentionPriority priority = kDefaultRetentionPriority,
+        std::optional<std::chrono::milliseconds> duration = std::nullopt)
+        : mPriority{priority}
+        , mDuration{duration}
+    {
+        TLLM_CHECK_WITH_INFO(priority >= kMinRetentionPriority && priority <= kMaxRetentionPriority,
+            "Retention priority must be in [%d, %d], got %d", kMinRetentionPriority, kMaxRetentionPriority, priority);
+    }
+
+    [[nodiscard]] RetentionPriority getPriority() const noexcept
+    {
+        return mPriority;
+    }
+
+    [[nodiscard]] std::optional<std::chrono::milliseconds> getDuration() const noexcept
+    {
+        return mDuration;
+    }
+
+    bool operator==(KvCacheRetentionConfig const& other) const noexcept
+    {
+        return mPriority == other.mPriority && mDuration == other.mDuration;
+    }
+
+private:
+    friend class Serialization;
+
+    /// @brief The retention priority of the blocks stored by the request
+    RetentionPriority mPriority;
+    /// @brief How long the priority applies after the blocks are freed. Afterwards they fall back to the default
+    /// priority. Applies indefinitely if not set.
+    std::optional<std::chrono::milliseconds> mDuration;
+};
+
+/// @brief Latency targets of a request, see runtime::LatencySloTracker for the slack and attainment they define.
+class LatencySloConfig
+{
+public:
+    explicit LatencySloConfig(std::optional<std::chrono::milliseconds> timeToFirstToken = std::nullopt,
+        std::optional<std::chrono::milliseconds> interTokenLatency = std::nullopt)
+        : mTimeToFirstToken{timeToFirstToken}
+        , mInterTokenLatency{interTokenLatency}
+    {
+        TLLM_CHECK_WITH_INFO(
+            !timeToFirstToken || timeToFirstToken->count() > 0, "Time to first token must be positive");
+        TLLM_CHECK_WITH_INFO(
+            !interTokenLatency || interTokenLatency->count() > 0, "Inter-token latency must be positive");
+    }
+
+    [[nodiscard]] std::optional<std::chrono::milliseconds> getTimeToFirstToken() const noexcept
+    {
+        return mTimeToFirstToken;
+    }
+
+    [[nodiscard]] std::optional<std::chrono::milliseconds> getInterTokenLatency() const noexcept
+    {
+        return mInterTokenLatency;
+    }
+
+    bool operator==(LatencySloConfig const& other) const noexcept
+    {
+        return mTimeToFirstToken == other.mTimeToFirstToken && mInterTokenLatency == other.mInterTokenLatency;
+    }
+
+private:
+    friend class Serialization;
+
+    /// @brief Deadline for the first generated token, measured from the arrival of the request
+    std::optional<std::chrono::milliseconds> mTimeToFirstToken;
+    /// @brief Target for the average time between two generated tokens after the first one
+    std::optional<std::chrono::milliseconds> mInterTokenLatency;
+};
+
+/// @brief Shapes of the synthetic batches run by runtime::WarmupPlanner::run.
+/// Every combination of batch size and input length that fits the engine limits is run once.
+class WarmupConfig
+{
+public:
+    explicit WarmupConfig(std::vector<SizeType32> batchSizes = {1}, std::vector<SizeType32> inputLengths = {128},
+        SizeType32 outputLength = 8)
+        : mBatchSizes{std::move(batchSizes)}
+        , mInputLengths{std::move(inputLengths)}
+        , mOutputLength{outputLength}
+    {
+        TLLM_CHECK_WITH_INFO(!mBatchSizes.empty() && !mInputLengths.empty(), "Warmup shapes must not be empty");
+        TLLM_CHECK_WITH_INFO(outputLength > 0, "Warmup output length must be positive");
+    }
+
+    [[nodiscard]] std::vector<SizeType32> const& getBatchSizes() const noexcept
+    {
+        return mBatchSizes;
+    }
+
+    [[nodiscard]] std::vector<SizeType32> const& getInputLengths() const noexcept
+    {
+        return mInputLengths;
+    }
+
+    [[nodiscard]] SizeType32 getOutputLength() const noexcept
+    {
+        return mOutputLength;
+    }
+
+    bool operator==(WarmupConfig const& other) const noexcept
+    {
+        return mBatchSizes == other.mBatchSizes && mInputLengths == other.mInputLengths
+            && mOutputLength == other.mOutputLength;
+    }
+
+private:
+    friend class Serialization;
+
+    /// @brief Batch sizes to warm up, e.g. the CUDA graph buckets
+    std::vector<SizeType32> mBatchSizes;
+    /// @brief Input lengths to warm up, covering the sizes that select different GEMM tactics and attention kernels
+    std::vector<SizeType32> mInputLengths;
+    /// @brief Number of tokens generated per synthetic request, so generation kernels and graphs are warmed up too
+    SizeType32 mOutputLength;
+};
+
+/// @brief KV cache watermarks at which a replica stops taking new work, instead of accepting it and pausing in-flight
+/// requests to make room. The commitment is the share of the primary pool used by in-flight requests or needed by the
+/// prompts of queued ones, see AdmissionHeadroom. Applied by runtime::AdmissionController in front of the executor.
+class AdmissionControlConfig
+{
+public:
+    explicit AdmissionControlConfig(
+        std::optional<float> deferWatermark = std::nullopt, std::optional<float> rejectWatermark = std::nullopt)
+        : mDeferWatermark{deferWatermark}
+        , mRejectWatermark{rejectWatermark}
+    {
+        TLLM_CHECK_WITH_INFO(!deferWatermark || (*deferWatermark > 0.F && *deferWatermark <= 1.F),
+            "Defer watermark must be in (0, 1]");
+        TLLM_CHECK_WITH_INFO(!rejectWatermark || (*rejectWatermark > 0.F && *rejectWatermark <= 1.F),
+            "Reject watermark must be in (0, 1]");
+        TLLM_CHECK_WITH_INFO(!deferWatermark || !rejectWatermark || *deferWatermark <= *rejectWatermark,
+            "Defer watermark must not be above the reject watermark");
+    }
+
+    [[nodiscard]] std::optional<float> getDeferWatermark() const noexcept
+    {
+        return mDeferWatermark;
+    }
+
+    [[nodiscard]] std::optional<float> getRejectWatermark() const noexcept
+    {
+        return mRejectWatermark;
+    }
+
+    bool operator==(AdmissionControlConfig const& other) const noexcept
+    {
+        return mDeferWatermark == other.mDeferWatermark && mRejectWatermark == other.mRejectWatermark;
+    }
+
+private:
+    friend class Serialization;
+
+    /// @brief Commitment from which new requests are queued but not scheduled
+    std::optional<float> mDeferWatermark;
+    /// @brief Commitment from which new requests are rejected with AdmissionRejectedError
+    std::optional<float> mRejectWatermark;
+};
+
 class ContextPhaseParams
 {
 public:
@@ -473,6 +695,31 @@ struct Result
     bool isSequenceFinal;
 };
 
+/// @brief The state of an in-flight request, collected by its owner from the results of the executor running it, to
+/// continue it on another executor. See runtime::RequestMigration.
+struct MigratedRequest
+{
+    /// @brief The request as it was enqueued on the exporting executor
+    Request request;
+
+    /// @brief The tokens the request generated so far, without the prompt. Only requests with one beam migrate.
+    VecTokens generatedTokens;
+
+    /// @brief The log probabilities of the generated tokens, if the request returns them
+    std::optional<VecLogProbs> logProbs;
+
+    /// @brief The cumulative log probability of the generated tokens, if the request returns it
+    std::optional<FloatType> cumLogProb;
+
+    /// @brief The step of the random stream of the request, see kernels::RandomState. The importing executor resumes
+    /// the stream there, so it samples what the exporting executor would have sampled.
+    std::uint64_t randomStep{0};
+
+    /// @brief The cache and communication state of the exporting executor. The importing executor pulls the KV cache
+    /// of the prompt and of the generated tokens with it, as the generation instance of disaggregated serving does.
+    ContextPhaseParams contextPhaseParams;
+};
+
 /// @brief Class that holds either an error or a result
 class Response
 {
@@ -777,6 +1024,58 @@ private:
     std::optional<size_t> mHostCacheSize;
 };
 
+/// @brief Configuration of draft-target speculative decoding.
+/// @details Every generation step, the draft model runs over the eligible requests for up to maxDraftLen batched
+/// steps, the target verifies the draft tokens, and the KV cache of both models is rewound past the first rejected
+/// draft token. The draft loop is planned with runtime::planDraftSteps, runtime::getDraftLen and one
+/// runtime::DraftTargetSequence per request.
+class DraftTargetConfig
+{
+public:
+    /// @param draftModelPath Path to the folder of the draft engine.
+    /// @param maxDraftLen Maximum number of draft tokens per request and step, the target engine must accept as many.
+    /// @param draftKvCacheFraction Share of the KV cache memory given to the draft model, the target gets the rest.
+    /// Not set to split it by the per token KV cache size of the two models.
+    explicit DraftTargetConfig(std::filesystem::path draftModelPath, SizeType32 maxDraftLen,
+        std::optional<FloatType> draftKvCacheFraction = std::nullopt)
+        : mDraftModelPath{std::move(draftModelPath)}
+        , mMaxDraftLen{maxDraftLen}
+        , mDraftKvCacheFraction{draftKvCacheFraction}
+    {
+        TLLM_CHECK_WITH_INFO(maxDraftLen > 0, "The max draft length must be positive");
+        TLLM_CHECK_WITH_INFO(!draftKvCacheFraction || (*draftKvCacheFraction > 0.F && *draftKvCacheFraction < 1.F),
+            "The draft KV cache fraction must be in (0, 1)");
+    }
+
+    [[nodiscard]] std::filesystem::path const& getDraftModelPath() const noexcept
+    {
+        return mDraftModelPath;
+    }
+
+    [[nodiscard]] SizeType32 getMaxDraftLen() const noexcept
+    {
+        return mMaxDraftLen;
+    }
+
+    [[nodiscard]] std::optional<FloatType> getDraftKvCacheFraction() const noexcept
+    {
+        return mDraftKvCacheFraction;
+    }
+
+    bool operator==(DraftTargetConfig const& other) const noexcept
+    {
+        return mDraftModelPath == other.mDraftModelPath && mMaxDraftLen == other.mMaxDraftLen
+            && mDraftKvCacheFraction == other.mDraftKvCacheFraction;
+    }
+
+private:
+    friend class Serialization;
+
+    std::filesystem::path mDraftModelPath;
+    SizeType32 mMaxDraftLen;
+    std::optional<FloatType> mDraftKvCacheFraction;
+};
+
 /// @brief Configuration class for the decoding.
 class DecodingConfig
 {
@@ -813,6 +1112,189 @@ private:
     std::optional<MedusaChoices> mMedusaChoices;
 };
 
+/// @brief Configuration of the Medusa tree tuning, which reshapes the Medusa choices to the accepted paths.
+/// @details The Medusa decoding layer counts how often each node of the tree is accepted. Every updateInterval
+/// iterations, runtime::MedusaTreeTuner rebuilds the tree from the nodes with the highest acceptance rates, within the
+/// maxDecodingTokens of the engine, and the owner switches to it between two iterations. The tree of DecodingConfig,
+/// or the default tree of the engine, is the start.
+class MedusaTreeTuningConfig
+{
+public:
+    /// @param updateInterval Number of iterations between two tree updates.
+    /// @param pinned Keep the starting tree, e.g. for reproducible outputs. The acceptance rates are still reported.
+    /// @param maxChildRank Highest top-K rank of a Medusa head a node of the tree may use, at most 15.
+    /// @param smoothing Weight of the previous rates when folding in the counts of an interval, in [0, 1).
+    explicit MedusaTreeTuningConfig(
+        SizeType32 updateInterval = 256, bool pinned = false, SizeType32 maxChildRank = 10, FloatType smoothing = 0.5F)
+        : mUpdateInterval{updateInterval}
+        , mPinned{pinned}
+        , mMaxChildRank{maxChildRank}
+        , mSmoothing{smoothing}
+    {
+        TLLM_CHECK_WITH_INFO(updateInterval > 0, "The update interval must be positive");
+        TLLM_CHECK_WITH_INFO(maxChildRank > 0 && maxChildRank <= 15, "The max child rank must be in [1, 15]");
+        TLLM_CHECK_WITH_INFO(smoothing >= 0.F && smoothing < 1.F, "The smoothing must be in [0, 1)");
+    }
+
+    [[nodiscard]] SizeType32 getUpdateInterval() const noexcept
+    {
+        return mUpdateInterval;
+    }
+
+    [[nodiscard]] bool getPinned() const noexcept
+    {
+        return mPinned;
+    }
+
+    [[nodiscard]] SizeType32 getMaxChildRank() const noexcept
+    {
+        return mMaxChildRank;
+    }
+
+    [[nodiscard]] FloatType getSmoothing() const noexcept
+    {
+        return mSmoothing;
+    }
+
+    bool operator==(MedusaTreeTuningConfig const& other) const noexcept
+    {
+        return mUpdateInterval == other.mUpdateInterval && mPinned == other.mPinned
+            && mMaxChildRank == other.mMaxChildRank && mSmoothing == other.mSmoothing;
+    }
+
+private:
+    friend class Serialization;
+
+    SizeType32 mUpdateInterval;
+    bool mPinned;
+    SizeType32 mMaxChildRank;
+    FloatType mSmoothing;
+};
+
+/// @brief Runtime tuning of the max batch size and max number of tokens the scheduler applies, within the limits of
+/// the engine and of the ExecutorConfig. The throughput-optimal limits depend on the mix of input and output lengths
+/// and on the KV cache occupancy, which change while the executor runs. See runtime::BatchLimitTuner.
+class BatchLimitTuningConfig
+{
+public:
+    /// @param objective What the tuner optimizes.
+    /// @param targetIterLatencyMS Iteration latency to stay below, required for kLATENCY_BOUND.
+    /// @param updateInterval Number of iterations measured before every decision.
+    /// @param kvCacheWatermark Share of the KV cache in use from which the limits are lowered, in (0, 1].
+    /// @param minBatchSize Lowest max batch size the tuner applies.
+    /// @param minNumTokens Lowest max number of tokens the tuner applies.
+    explicit BatchLimitTuningConfig(BatchLimitTuningObjective objective = BatchLimitTuningObjective::kMAX_THROUGHPUT,
+        std::optional<FloatType> targetIterLatencyMS = std::nullopt, SizeType32 updateInterval = 16,
+        FloatType kvCacheWatermark = 0.95F, SizeType32 minBatchSize = 1, SizeType32 minNumTokens = 64)
+        : mObjective{objective}
+        , mTargetIterLatencyMS{targetIterLatencyMS}
+        , mUpdateInterval{updateInterval}
+        , mKvCacheWatermark{kvCacheWatermark}
+        , mMinBatchSize{minBatchSize}
+        , mMinNumTokens{minNumTokens}
+    {
+        TLLM_CHECK_WITH_INFO(objective != BatchLimitTuningObjective::kLATENCY_BOUND || targetIterLatencyMS,
+            "The latency bound objective requires a target iteration latency");
+        TLLM_CHECK_WITH_INFO(!targetIterLatencyMS || *targetIterLatencyMS > 0.F,
+            "The target iteration latency must be positive");
+        TLLM_CHECK_WITH_INFO(updateInterval > 0, "The update interval must be positive");
+        TLLM_CHECK_WITH_INFO(
+            kvCacheWatermark > 0.F && kvCacheWatermark <= 1.F, "The KV cache watermark must be in (0, 1]");
+        TLLM_CHECK_WITH_INFO(minBatchSize > 0 && minNumTokens > 0, "The min batch size and tokens must be positive");
+    }
+
+    [[nodiscard]] BatchLimitTuningObjective getObjective() const noexcept
+    {
+        return mObjective;
+    }
+
+    [[nodiscard]] std::optional<FloatType> getTargetIterLatencyMS() const noexcept
+    {
+        return mTargetIterLatencyMS;
+    }
+
+    [[nodiscard]] SizeType32 getUpdateInterval() const noexcept
+    {
+        return mUpdateInterval;
+    }
+
+    [[nodiscard]] FloatType getKvCacheWatermark() const noexcept
+    {
+        return mKvCacheWatermark;
+    }
+
+    [[nodiscard]] SizeType32 getMinBatchSize() const noexcept
+    {
+        return mMinBatchSize;
+    }
+
+    [[nodiscard]] SizeType32 getMinNumTokens() const noexcept
+    {
+        return mMinNumTokens;
+    }
+
+    bool operator==(BatchLimitTuningConfig const& other) const noexcept
+    {
+        return mObjective == other.mObjective && mTargetIterLatencyMS == other.mTargetIterLatencyMS
+            && mUpdateInterval == other.mUpdateInterval && mKvCacheWatermark == other.mKvCacheWatermark
+            && mMinBatchSize == other.mMinBatchSize && mMinNumTokens == other.mMinNumTokens;
+    }
+
+private:
+    friend class Serialization;
+
+    BatchLimitTuningObjective mObjective;
+    std::optional<FloatType> mTargetIterLatencyMS;
+    SizeType32 mUpdateInterval;
+    FloatType mKvCacheWatermark;
+    SizeType32 mMinBatchSize;
+    SizeType32 mMinNumTokens;
+};
+
+/// @brief Where the threads of the executor run and where its pinned host memory is placed. A thread far from the
+/// NUMA node of its GPU adds latency to every iteration on multi-socket hosts. See runtime::CpuAffinity.
+/// @details Every rank, the orchestrator and its worker processes alike, resolves the config for the device it uses,
+/// so one config applies consistently to all of them. It is applied to the thread that constructs the executor, before
+/// the executor starts its threads and worker pools, which inherit the affinity.
+class CpuAffinityConfig
+{
+public:
+    /// @param deviceCpus CPUs the threads of the rank using a device may run on, by device id. Ranks on devices
+    /// not in the map use the CPUs local to the NUMA node of their device, see ParallelConfig::getDeviceIds.
+    /// @param numaLocalHostMemory Place pinned host allocations, e.g. the pinned pools, on the NUMA node of the device.
+    explicit CpuAffinityConfig(
+        std::map<SizeType32, std::vector<SizeType32>> deviceCpus = {}, bool numaLocalHostMemory = true)
+        : mDeviceCpus{std::move(deviceCpus)}
+        , mNumaLocalHostMemory{numaLocalHostMemory}
+    {
+        for (auto const& [deviceId, cpus] : mDeviceCpus)
+        {
+            TLLM_CHECK_WITH_INFO(!cpus.empty(), "No CPUs given for device %d", deviceId);
+        }
+    }
+
+    [[nodiscard]] std::map<SizeType32, std::vector<SizeType32>> const& getDeviceCpus() const noexcept
+    {
+        return mDeviceCpus;
+    }
+
+    [[nodiscard]] bool getNumaLocalHostMemory() const noexcept
+    {
+        return mNumaLocalHostMemory;
+    }
+
+    bool operator==(CpuAffinityConfig const& other) const noexcept
+    {
+        return mDeviceCpus == other.mDeviceCpus && mNumaLocalHostMemory == other.mNumaLocalHostMemory;
+    }
+
+private:
+    friend class Serialization;
+
+    std::map<SizeType32, std::vector<SizeType32>> mDeviceCpus;
+    bool mNumaLocalHostMemory;
+};
+
 class LogitsPostProcessorConfig
 {
 public:
@@ -21,7 +21,9 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <stdexcept>
 #include <string>
+#include <variant>
 #include <vector>
 
 #include <cuda_fp16.h>
@@ -61,8 +63,16 @@ using LogitsPostProcessorMap = std::unordered_map<std::string, LogitsPostProcess
 using LogitsPostProcessorBatched = std::function<void(std::vector<IdType> const&, std::vector<Tensor>&,
     std::vector<std::reference_wrapper<BeamTokens const>> const&, StreamPtr const&,
     std::vector<std::optional<IdType>> const&)>;
+/// @brief Signals that an asynchronous logits post processor enqueued all its work on the stream it was given.
+using LogitsPostProcessorDone = std::function<void()>;
+/// @brief Batched logits post processor that does not block the generation loop. It enqueues its GPU work on the given
+/// stream and calls the done callback, possibly from another thread, once it is enqueued. Sampling waits for that work.
+using LogitsPostProcessorBatchedAsync = std::function<void(std::vector<IdType> const&, std::vector<Tensor>&,
+    std::vector<std::reference_wrapper<BeamTokens const>> const&, StreamPtr const&,
+    std::vector<std::optional<IdType>> const&, LogitsPostProcessorDone const&)>;
 using MedusaChoices = std::vector<std::vector<SizeType32>>;
 using PriorityType = float;
+using RetentionPriority = SizeType32;
 using BufferView = std::basic_string_view<uint8_t>;
 
 enum class DataType
@@ -198,6 +208,11 @@ enum class CapacitySchedulerPolicy
     /// @brief GUARANTEED_NO_EVICT uses KV cache more conservatively guaranteeing that a request, once started, will run
     /// to completion without eviction.
     kGUARANTEED_NO_EVICT = 1,
+
+    /// @brief PRIORITY_PREEMPTIVE admits requests by Request priority. Under KV cache pressure it pauses the lowest
+    /// priority in-flight requests and offloads their blocks to the secondary pool, so that higher priority requests
+    /// can be admitted. Paused requests resume from the offloaded blocks instead of running the context phase again.
+    kPRIORITY_PREEMPTIVE = 2,
 };
 
 std::ostream& operator<<(std::ostream& os, CapacitySchedulerPolicy policy);
@@ -210,10 +225,62 @@ enum class ContextChunkingPolicy
     /// @brief Iterate through each context request in sequence and attempt to increase its chunk
     /// count until the constraint is exceeded.
     kEQUAL_PROGRESS = 1,
+
+    /// @brief Order context requests and their chunks by slack, i.e. the time left until they miss their time to first
+    /// token target, discounted by the remaining prefill work. Requests without a target are scheduled last, in first
+    /// come first served order.
+    kLEAST_SLACK_FIRST = 2,
+
+    /// @brief Sequential chunking like kFIRST_COME_FIRST_SERVED, but the context token budget of each iteration is
+    /// derived from a target iteration latency instead of maxNumTokens. The latency is modeled online from the measured
+    /// iteration latency against the scheduled context and generation tokens, and maxNumTokens stays the upper bound.
+    kLATENCY_TARGET = 3,
 };
 
 std::ostream& operator<<(std::ostream& os, ContextChunkingPolicy policy);
 
+/// @brief What to do with a new request given the KV cache commitment, see AdmissionControlConfig
+enum class AdmissionDecision
+{
+    /// @brief The request is queued and scheduled as usual.
+    kADMIT = 0,
+
+    /// @brief The request is queued, but not scheduled until the commitment drops below the defer watermark.
+    kDEFER = 1,
+
+    /// @brief The request is rejected with AdmissionRejectedError. Retrying later, or on another replica, is safe.
+    kREJECT = 2,
+};
+
+/// @brief What the batch limit tuner optimizes, see BatchLimitTuningConfig
+enum class BatchLimitTuningObjective
+{
+    /// @brief Maximize the tokens processed per second.
+    kMAX_THROUGHPUT = 0,
+
+    /// @brief Keep the iteration latency below a target, and use the largest batches that meet it.
+    kLATENCY_BOUND = 1,
+};
+
+/// @brief Change of the batch limits decided by the tuner after an iteration, see runtime::BatchLimitTuner
+enum class BatchLimitDecision
+{
+    /// @brief The limits are kept.
+    kKEEP = 0,
+
+    /// @brief The limits are raised, the batches were full and throughput or latency allow larger ones.
+    kRAISE = 1,
+
+    /// @brief The limits are lowered because the previous raise did not pay off in throughput.
+    kLOWER_THROUGHPUT = 2,
+
+    /// @brief The limits are lowered because the iteration latency exceeded the target.
+    kLOWER_LATENCY = 3,
+
+    /// @brief The limits are lowered because the KV cache ran full or requests were paused.
+    kLOWER_KV_PRESSURE = 4,
+};
+
 enum class CommunicationType
 {
     kMPI = 0
@@ -248,6 +315,128 @@ struct KvCacheStats
     SizeType32 reusedBlocks;
 };
 
+/// @brief Memory level a KV cache block resides in
+enum class KVCacheLevel
+{
+    kGPU = 0,
+    kHOST = 1,
+};
+
+/// @brief A block stored for reuse
+struct KVCacheStoredBlockData
+{
+    /// @brief Chained hash of the block, covers all tokens up to and including this block
+    IdType blockHash;
+    /// @brief The tokens of the block
+    VecTokens tokens;
+    /// @brief The extra ids of the tokens (e.g. for prompt tuning), empty if not used
+    VecTokenExtraIds tokenExtraIds;
+    /// @brief The LoRA task id of the request that stored the block
+    std::optional<IdType> loraId;
+    /// @brief Memory level the block was stored in
+    KVCacheLevel cacheLevel{KVCacheLevel::kGPU};
+};
+
+/// @brief A chain of blocks stored for reuse
+struct KVCacheStoredData
+{
+    /// @brief Hash of the block the chain is attached to, not set if the chain starts a new sequence
+    std::optional<IdType> parentHash;
+    /// @brief The stored blocks, in sequence order
+    std::vector<KVCacheStoredBlockData> blocks;
+};
+
+/// @brief Blocks removed from the reuse tree, e.g. because they were evicted
+struct KVCacheRemovedData
+{
+    std::vector<IdType> blockHashes;
+};
+
+/// @brief A block moved between memory levels
+struct KVCacheUpdatedData
+{
+    IdType blockHash;
+    KVCacheLevel oldCacheLevel;
+    KVCacheLevel newCacheLevel;
+};
+
+using KVCacheEventData = std::variant<KVCacheStoredData, KVCacheRemovedData, KVCacheUpdatedData>;
+
+/// @brief An event emitted by the KV cache manager. Together, the events describe the content of the reuse tree and
+/// can be used to maintain an approximate copy of it, e.g. for cache-aware request routing.
+struct KVCacheEvent
+{
+    /// @brief Monotonically increasing id of the event. Gaps indicate events dropped because the buffer was full.
+    IdType eventId;
+    KVCacheEventData data;
+};
+
+/// @brief Duration of one phase of a warmup, see runtime::WarmupPlanner
+struct WarmupPhaseStats
+{
+    /// @brief Name of the phase, e.g. "context" or "generation"
+    std::string name;
+    /// @brief Number of synthetic batches run in the phase
+    SizeType32 numBatches;
+    /// @brief Duration of the phase (ms)
+    double durationMS;
+};
+
+/// @brief Struct that holds the result of a warmup, see runtime::WarmupPlanner
+struct WarmupStats
+{
+    std::vector<WarmupPhaseStats> phases;
+    /// @brief Total duration of the warmup (ms)
+    double totalDurationMS;
+};
+
+/// @brief Time spent in one phase of the startup of an executor
+struct StartupPhaseStats
+{
+    /// @brief Name of the phase, e.g. "engine_read" or "trt_deserialize"
+    std::string name;
+    /// @brief Number of times the phase was entered, e.g. once per optimization profile for "context_creation"
+    SizeType32 count;
+    /// @brief Summed duration of the phase (ms)
+    double durationMS;
+};
+
+/// @brief Struct that holds the result of common::getStartupStats
+struct StartupStats
+{
+    std::vector<StartupPhaseStats> phases;
+    /// @brief Wall time from the start of the first phase to the end of the last one (ms). Phases can nest, so it
+    /// is not the sum of the phases.
+    double totalDurationMS;
+};
+
+/// @brief Struct that holds the result of runtime::AdmissionController::evaluate, for routers to balance load before a
+/// replica runs out of KV cache and starts pausing in-flight requests
+struct AdmissionHeadroom
+{
+    /// @brief Number of free blocks in the primary KV cache pool
+    SizeType32 freeNumBlocks;
+    /// @brief Number of blocks the queued requests need for their prompts
+    SizeType32 queuedNumBlocks;
+    /// @brief Free blocks left once the queued requests are admitted, negative if they do not all fit
+    SizeType32 headroomNumBlocks;
+    /// @brief Share of the pool used by in-flight requests or needed by queued ones
+    double commitment;
+    /// @brief Estimated wait of a new request for blocks (ms), from the rate at which in-flight requests released
+    /// blocks in recent iterations. Zero if the queued requests fit, not set if they do not and no release was seen.
+    std::optional<double> estimatedQueueDelayMS;
+    /// @brief What happens to a request enqueued now
+    AdmissionDecision decision;
+};
+
+/// @brief Thrown for a new request when the reject watermark of AdmissionControlConfig is reached. The executor is
+/// healthy, the request was not accepted and can be retried.
+class AdmissionRejectedError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
 /// @brief Struct that holds the stats of static batching models for a single iteration
 struct StaticBatchingStats
 {
@@ -282,6 +471,93 @@ struct InflightBatchingStats
     float avgNumDecodedTokensPerIter;
 };
 
+/// @brief Struct that holds the memory usage of one subsystem, read with runtime::MemoryCounters::getTagStats
+struct MemoryTagStats
+{
+    /// @brief Name of the subsystem, e.g. "kv_cache"
+    std::string tag;
+    /// @brief GPU memory usage in bytes
+    size_t gpuMemUsage;
+    /// @brief CPU memory usage in bytes
+    size_t cpuMemUsage;
+    /// @brief Pinned memory usage in bytes
+    size_t pinnedMemUsage;
+    /// @brief Highest GPU memory usage so far in bytes
+    size_t peakGpuMemUsage;
+    /// @brief Highest CPU memory usage so far in bytes
+    size_t peakCpuMemUsage;
+    /// @brief Highest pinned memory usage so far in bytes
+    size_t peakPinnedMemUsage;
+};
+
+/// @brief Struct that holds the routing load of the experts of one MoE layer, read with
+/// runtime::MoeLoadCounters::getStats
+struct MoeLayerLoadStats
+{
+    /// @brief Name of the MoE layer
+    std::string layer;
+    /// @brief Number of tokens routed to each expert since the previous stats, a token counts once per expert it
+    /// selected
+    std::vector<std::uint64_t> numTokensPerExpert;
+    /// @brief Tokens of the busiest expert over the mean tokens per expert, 1 when the routing is balanced
+    double maxToMeanRatio;
+};
+
+/// @brief Struct that holds the stats of the pinned staging pool of request inputs and outputs, read with
+/// runtime::PinnedStagingPool::getStats
+struct PinnedStagingStats
+{
+    /// @brief Pinned memory held by the slabs of the pool in bytes
+    size_t reservedBytes;
+    /// @brief Bytes handed out, rounded up to the size classes
+    size_t usedBytes;
+    /// @brief Number of allocations since the previous stats
+    std::uint64_t numAllocations;
+    /// @brief Number of allocations since the previous stats that needed a new slab or were too large for the slabs
+    std::uint64_t numMisses;
+    /// @brief Bytes of unused slabs freed by trimming since the previous stats
+    size_t trimmedBytes;
+};
+
+/// @brief Struct that holds the stats of TensorRT weight streaming, read with
+/// runtime::TllmRuntime::takeWeightStreamingStats
+struct WeightStreamingStats
+{
+    /// @brief Bytes of the streamable weights of the engine
+    int64_t streamableBytes;
+    /// @brief Bytes of the streamable weights kept on the GPU
+    int64_t budgetBytes;
+    /// @brief Estimated bytes copied from the host for the forward passes since the previous stats, the streamable
+    /// weights over the budget once per forward pass
+    int64_t streamedBytes;
+    /// @brief Number of forward passes since the previous stats
+    std::uint64_t numForwards;
+    /// @brief Number of times the budget was adapted to the free memory since the previous stats
+    std::uint64_t numBudgetChanges;
+};
+
+/// @brief Struct that holds the stats of the LoRA adapter caches, read with runtime::LoraCacheCounters::getStats.
+/// The counts are since the previous read.
+struct LoraCacheStats
+{
+    /// @brief Number of requests whose adapter was already in the host cache
+    std::uint64_t numHostHits;
+    /// @brief Number of requests whose adapter was loaded into the host cache
+    std::uint64_t numHostMisses;
+    /// @brief Number of adapters evicted from the host cache
+    std::uint64_t numHostEvictions;
+    /// @brief Number of adapters that were already in the device cache
+    std::uint64_t numDeviceHits;
+    /// @brief Number of adapters copied into the device cache
+    std::uint64_t numDeviceMisses;
+    /// @brief Number of adapters evicted from the device cache
+    std::uint64_t numDeviceEvictions;
+    /// @brief Time spent loading adapter weights into the host cache (ms)
+    double hostLoadMS;
+    /// @brief Time spent copying adapters into the device cache (ms)
+    double deviceLoadMS;
+};
+
 /// @brief Struct that holds the stats of a single iteration
 struct IterationStats
 {
@@ -340,6 +616,33 @@ struct DisServingRequestStats
     double kvCacheTransferMS;
 };
 
+/// @brief The most likely tokens at one output position and their log probabilities, most likely first
+struct TopLogProbs
+{
+    VecTokens tokens;
+    VecLogProbs logProbs;
+};
+
+/// @brief Struct that holds the timeline of a request, see runtime::RequestTimingCollector. Times are in ms since the
+/// arrival of the request, measured on the steady clock.
+struct RequestTimingStats
+{
+    /// @brief Arrival time of the request in us since the epoch of the steady clock, to correlate requests
+    int64_t arrivalTimeUs{0};
+    /// @brief When the request was scheduled for the first time. The difference to the arrival is the queueing delay.
+    std::optional<double> firstScheduledMS;
+    /// @brief When each context chunk completed. Has a single entry without chunked context.
+    std::vector<double> contextChunkEndMS;
+    /// @brief When the first token was generated
+    std::optional<double> firstTokenMS;
+    /// @brief When the last token so far was generated
+    std::optional<double> lastTokenMS;
+    /// @brief Total time the request spent paused or evicted until it was scheduled again (ms)
+    double pausedMS{0.0};
+    /// @brief Number of times the request was paused
+    SizeType32 numPauses{0};
+};
+
 /// @brief Struct that holds the stats of a single request
 struct RequestStats
 {
@@ -422,6 +725,13 @@ public:
         return DecodingMode{kTopKTopP | kUsePenalties | kUseBanTokens | kStandardStopCriteria};
     }
 
+    /// @brief Samples with top-K, top-P and min-P jointly by rejection sampling, see useRejectionSampling
+    static auto constexpr MinP()
+    {
+        return DecodingMode{
+            kTopKTopP | kMinP | kUseRejectionSampling | kUsePenalties | kUseBanTokens | kStandardStopCriteria};
+    }
+
     static auto constexpr BeamSearch()
     {
         return DecodingMode{kBeamSearch | kUsePenalties | kUseBanTokens | kStandardStopCriteria};
@@ -442,6 +752,23 @@ public:
         return DecodingMode{kExplicitDraftTokens | kStandardStopCriteria | kUseExplicitEosStop};
     }
 
+    /// @brief Sample top-K/top-P without sorting the probabilities: candidates are drawn from the distribution and
+    /// rejected until one of them lies within the threshold. Needs no workspace and few passes over the vocabulary.
+    auto constexpr useRejectionSampling(bool useRejection)
+    {
+        mState = setBitTo(kUseRejectionSampling, useRejection);
+        return *this;
+    }
+
+    /// @brief Sample top-K requests with a kernel that finds the candidates and their softmax in a single pass over the
+    /// raw logits, for top-K up to 64. The log probabilities are over the full vocabulary, as without
+    /// normalizeLogProbs. Not supported with rejection sampling.
+    auto constexpr useFusedSampling(bool useFused)
+    {
+        mState = setBitTo(kUseFusedSampling, useFused);
+        return *this;
+    }
+
     auto constexpr useTemperature(bool useTemp)
     {
         mState = setBitTo(kUseTemperature, useTemp);
@@ -539,6 +866,21 @@ public:
         return allBitSet(kTopKTopP);
     }
 
+    [[nodiscard]] bool constexpr isMinP() const
+    {
+        return anyBitSet(kMinP);
+    }
+
+    [[nodiscard]] bool constexpr isUseRejectionSampling() const
+    {
+        return anyBitSet(kUseRejectionSampling);
+    }
+
+    [[nodiscard]] bool constexpr isUseFusedSampling() const
+    {
+        return anyBitSet(kUseFusedSampling);
+    }
+
     [[nodiscard]] bool constexpr isBeamSearch() const
     {
         return anyBitSet(kBeamSearch);
@@ -672,6 +1014,10 @@ private:
     static UnderlyingType constexpr kMedusa{1u << (kNumFlags + 4)};
     static UnderlyingType constexpr kLookahead{1u << (kNumFlags + 5)};
     static UnderlyingType constexpr kExplicitDraftTokens{1u << (kNumFlags + 6)};
+    // Appended after the modes to keep the values of the existing bits
+    static UnderlyingType constexpr kMinP{1u << (kNumFlags + 7)};
+    static UnderlyingType constexpr kUseRejectionSampling{1u << (kNumFlags + 8)};
+    static UnderlyingType constexpr kUseFusedSampling{1u << (kNumFlags + 9)};
     static UnderlyingType constexpr kTopKTopP{kTopK | kTopP};
 
     [[nodiscard]] bool constexpr anyBitSet(UnderlyingType bits) const
@@ -744,6 +1090,18 @@ static_assert(DecodingMode::TopKTopP().isUseBanWords());
 static_assert(DecodingMode::TopKTopP().isUseOccurrencePenalty());
 static_assert(DecodingMode::TopKTopP().isUseStopCriteria());
 static_assert(!DecodingMode::TopKTopP().isAuto());
+static_assert(!DecodingMode::TopKTopP().isMinP());
+static_assert(!DecodingMode::TopKTopP().isUseRejectionSampling());
+static_assert(DecodingMode::TopKTopP().useRejectionSampling(true).isUseRejectionSampling());
+static_assert(!DecodingMode::TopKTopP().isUseFusedSampling());
+static_assert(DecodingMode::TopKTopP().useFusedSampling(true).isUseFusedSampling());
+static_assert(DecodingMode::TopKTopP().useFusedSampling(true).isTopKandTopP());
+
+static_assert(DecodingMode::MinP().isMinP());
+static_assert(DecodingMode::MinP().isTopKandTopP());
+static_assert(DecodingMode::MinP().isUseRejectionSampling());
+static_assert(DecodingMode::MinP().isUseOccurrencePenalty());
+static_assert(!DecodingMode::MinP().isBeamSearch());
 static_assert(!DecodingMode::TopKTopP().isBeamSearch());
 static_assert(!DecodingMode::TopKTopP().isMedusa());
 static_assert(!DecodingMode::TopKTopP().isLookahead());
@@ -60,6 +60,11 @@ public:
         return 0;
     }
 
+    [[nodiscard]] __host__ __device__ static constexpr uint64_t getRandomStep()
+    {
+        return 0;
+    }
+
     [[nodiscard]] __host__ __device__ static constexpr runtime::SizeType32 getTopK()
     {
         return 0;
@@ -85,6 +90,11 @@ public:
         return -1;
     }
 
+    [[nodiscard]] __host__ __device__ static constexpr float getMinP()
+    {
+        return 0.0f;
+    }
+
     [[nodiscard]] __host__ __device__ static constexpr float getBeamSearchDiversity()
     {
         return 0.f;
@@ -100,6 +110,16 @@ public:
         return 1;
     }
 
+    [[nodiscard]] __host__ __device__ static constexpr runtime::SizeType32 getNumBeamGroups()
+    {
+        return 1;
+    }
+
+    [[nodiscard]] __host__ __device__ static constexpr float getBeamGroupDiversityPenalty()
+    {
+        return 1.f;
+    }
+
     [[nodiscard]] __host__ __device__ static constexpr bool getNormalizeLogProbs()
     {
         return false;
@@ -110,6 +130,16 @@ public:
         return {};
     }
 
+    [[nodiscard]] __host__ __device__ static constexpr float getTypicalAcceptanceThreshold()
+    {
+        return 0.f;
+    }
+
+    [[nodiscard]] __host__ __device__ static constexpr float getTypicalAcceptanceAlpha()
+    {
+        return 0.3f;
+    }
+
     [[nodiscard]] __host__ __device__ static constexpr runtime::SizeType32 getNoRepeatNgramSize()
     {
         return 1 << 30;
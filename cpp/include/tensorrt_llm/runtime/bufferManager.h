@@ -22,6 +22,7 @@
 #include "tensorrt_llm/runtime/iTensor.h"
 #include <NvInferRuntime.h>
 
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <string>
@@ -35,6 +36,17 @@ namespace tensorrt_llm::runtime
 /// @brief Forward declaration as only used through pointer.
 class CudaMemPool;
 
+//! \brief The logical stream classes GPU memory is allocated for. With TRTLLM_STREAM_MEMPOOLS=1 each class allocates
+//! from a pool of its own, so that scratch allocations on side streams do not fragment the pool of the forward pass.
+enum class MemoryPoolClass : std::int8_t
+{
+    kPRIMARY = 0,   //!< The forward pass and everything without a class of its own
+    kDECODER = 1,   //!< Decoding layers, on the decoder stream
+    kCOPY = 2,      //!< Host and device transfers on copy streams
+    kLORA = 3,      //!< LoRA weight uploads
+    kEMERGENCY = 4, //!< Reserved up front, kPRIMARY allocations fall back to it when the device is out of memory
+};
+
 //! \brief A helper class for managing memory on host and device.
 class BufferManager
 {
@@ -50,7 +62,10 @@ public:
     //!
     //! \param[in] cudaStream The cuda stream to use for all operations on GPU (allocation, de-allocation, copying,
     //! etc.).
-    explicit BufferManager(CudaStreamPtr stream, bool trimPool = false);
+    //! \param[in] trimPool Whether to trim the memory pool on destruction.
+    //! \param[in] poolClass The class of the pool device memory is allocated from, see CudaMemPool::getPoolForDevice.
+    explicit BufferManager(
+        CudaStreamPtr stream, bool trimPool = false, MemoryPoolClass poolClass = MemoryPoolClass::kPRIMARY);
 
     //! \brief Destructor.
     ~BufferManager()
@@ -93,6 +108,13 @@ public:
     //! \brief Allocates a pinned `ITensor` of the given dimensions on the CPU in the default memory pool.
     [[nodiscard]] static ITensorPtr pinnedPool(nvinfer1::Dims dims, nvinfer1::DataType type = kBYTE_TYPE);
 
+    //! \brief Allocates a pinned `IBuffer` of the given size from the PinnedStagingPool. Use it for the host side of
+    //! per-request copies, e.g. input tokens or returned logits.
+    [[nodiscard]] static IBufferPtr pinnedStaging(std::size_t size, nvinfer1::DataType type = kBYTE_TYPE);
+
+    //! \brief Allocates a pinned `ITensor` of the given dimensions from the PinnedStagingPool.
+    [[nodiscard]] static ITensorPtr pinnedStaging(nvinfer1::Dims dims, nvinfer1::DataType type = kBYTE_TYPE);
+
     //! \brief Allocates an `IBuffer` of the given size in UVM.
     [[nodiscard]] static IBufferPtr managed(std::size_t size, nvinfer1::DataType type = kBYTE_TYPE);
 
@@ -201,6 +223,8 @@ private:
 
     CudaStreamPtr mStream;
     CudaMemPoolPtr mPool;
+    //! Pool kPRIMARY allocations fall back to when the device is out of memory, if one is reserved
+    CudaMemPoolPtr mEmergencyPool;
     bool const mTrimPool;
 };
 
@@ -51,6 +51,10 @@ public:
         TensorPtr numBeamsCBA;        // [BS]
         TensorPtr minNormedScoresCBA; // [BS]
         TensorPtr batchDones;         // [BS]
+        // Backtracked paths of the unfinished beams, updated incrementally
+        TensorPtr pathIds;            // [BS, BM, MSL], token ids along the path of the beam
+        TensorPtr pathBeams;          // [BS, BM, MSL], beam the path passes through at each step
+        TensorPtr pathLengths;        // [BS, BM], number of steps of the path up to date
 
         void empty(BufferManager& manager);
 
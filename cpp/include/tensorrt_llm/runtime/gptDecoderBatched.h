@@ -19,10 +19,12 @@
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/cudaEvent.h"
 #include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/decoderStatusBlock.h"
 #include "tensorrt_llm/runtime/generationOutput.h"
 #include "tensorrt_llm/runtime/gptDecoder.h"
 #include "tensorrt_llm/runtime/iGptDecoderBatched.h"
 #include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/outputTokenRing.h"
 
 #include <memory>
 #include <vector>
@@ -64,6 +66,21 @@ public:
 
     TokenPtr forwardAsync(decoder_batch::Output& output, decoder_batch::Input const& input) override;
 
+    //! @brief Like `forwardAsync`, with constrained decoding, see TokenBitmaskBuilder. Tokens whose bit is cleared in
+    //! `tokenBitmask` are masked before sampling.
+    //! @param tokenBitmask [maxBatchSize, ceilDiv(vocabSize, 32)], int32, on gpu, rows indexed by decoder slot, or
+    //! nullptr
+    //! @param statusBlock Status block to enqueue a snapshot of the finished states into behind the step, or nullptr,
+    //! see the `forwardSync` overload taking it
+    //! @param outputTokenRing Rings [maxBatchSize] to append the tokens of the step to, with their log probs and
+    //! finish reasons, or nullptr. Readers stream from the rings without copying the output ids.
+    //! @param outputTokenRingSeqs [maxBatchSize], int32, on gpu, request sequence numbers of the rings. The caller sets
+    //! the slots of `newRequests` to the value of `OutputTokenRing::startRequest`, publishing only requests without
+    //! beam search.
+    TokenPtr forwardAsync(decoder_batch::Output& output, decoder_batch::Input const& input,
+        TensorPtr const& tokenBitmask, DecoderStatusBlock* statusBlock = nullptr,
+        OutputTokenRing const* outputTokenRing = nullptr, TensorPtr const& outputTokenRingSeqs = nullptr);
+
     void forwardSync(decoder_batch::Token const& token) override;
 
     void forwardSync(
@@ -73,6 +90,14 @@ public:
 
     void forwardSync() override;
 
+    //! @brief Like `forwardSync(token)`, but learn about completions from the snapshots the steps enqueued into
+    //! `statusBlock` instead of waiting for the step of the token. Waits at most for the previous step, so
+    //! `getFinished` lags the device by up to one step. Slots that finished on the device in the meantime are decoded
+    //! once more, which the finished states turn into a no-op.
+    //! @param statusBlock [maxBatchSize, maxBeamWidth] of `setup`, written by every `forwardAsync` since the setup.
+    //! The caller calls `statusBlock.startRequest` for the slots of `newRequests`.
+    void forwardSync(decoder_batch::Token const& token, DecoderStatusBlock& statusBlock);
+
     //! @return [batchSize], indicators of finished requests
     [[nodiscard]] std::vector<bool> getFinished() const override
     {
@@ -244,6 +269,16 @@ private:
     //! @brief Initialize the decoder at `batchSlot` with a new `request`.
     void newRequest(SizeType32 batchSlot, decoder_batch::Request const& request, SamplingConfig const& samplingConfig);
 
+    //! @brief Whether a request can be initialized by newRequestsBatched.
+    [[nodiscard]] static bool canSetupBatched(
+        decoder_batch::Request const& request, SamplingConfig const& samplingConfig);
+
+    //! @brief Initialize several requests without beam search and speculative decoding. All device side setup is
+    //! packed into one staging buffer and applied with a single copy and a single kernel.
+    void newRequestsBatched(std::vector<SizeType32> const& seqSlots,
+        std::vector<decoder_batch::Request const*> const& requests,
+        std::vector<SamplingConfig const*> const& samplingConfigs);
+
     //! @brief Allocate buffers for speculative decoding.
     void allocateSpeculativeDecodingBuffers();
 
@@ -273,15 +308,19 @@ private:
     //! @brief Updates finished state on host for all active requests
     void updateFinished(decoder_batch::Token const& token);
 
+    //! @brief Updates finished state on host from the newest snapshot of the status block
+    void updateFinishedFromStatus(decoder_batch::Token const& token, DecoderStatusBlock& statusBlock);
+
     //! @brief Sets inputs for explicit draft tokens.
     void setExplicitDraftTokensInputs(decoder_batch::Input const& input);
 
     //! @brief Calls decoders for tokens per engine step
-    void forwardDispatch(decoder_batch::Output& output, decoder_batch::Input const& input, ForwardType forwardType);
+    void forwardDispatch(decoder_batch::Output& output, decoder_batch::Input const& input, ForwardType forwardType,
+        ITensor const* tokenBitmask);
 
     //! @brief Calls decoder for whole batch
-    void forwardDecoder(
-        SizeType32 step, decoder_batch::Output& output, decoder_batch::Input const& input, ForwardType forwardType);
+    void forwardDecoder(SizeType32 step, decoder_batch::Output& output, decoder_batch::Input const& input,
+        ForwardType forwardType, ITensor const* tokenBitmask);
 
 private:
     std::size_t const mVocabSize;
@@ -302,7 +341,7 @@ private:
 
     std::vector<bool> mAcceptByLogits;
     TensorPtr mNumDraftTokens;
-    TensorPtr mCurandStates;
+    TensorPtr mRandomStates;
 
     std::vector<SizeType32> mNbSteps;
     std::vector<bool> mFinished;
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "common.h"
+#include "tensorrt_llm/common/cudaDriverWrapper.h"
 #include "tensorrt_llm/kernels/customAllReduceKernels.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/iTensor.h"
@@ -34,6 +35,10 @@ public:
     // MAX_ALL_REDUCE_BLOCKS for block_barrier, 1 for multi_gpu_barrier
     size_t static constexpr FLAGS_SIZE = (tensorrt_llm::kernels::MAX_ALL_REDUCE_BLOCKS + 1) * sizeof(uint32_t);
 
+    //! The number of ranks of the tensor parallel group sharing the IPC buffers: the whole group when it fits on one
+    //! node, else the ranks of one node when the group spans whole nodes, else 0 and no buffers are shared.
+    [[nodiscard]] static SizeType32 getNodeGroupSize(WorldConfig const& worldConfig);
+
     IpcMemory(
         std::size_t bufferSize, BufferManager const& manager, WorldConfig const& worldConfig, bool openIpc = true);
     ~IpcMemory();
@@ -44,6 +49,7 @@ public:
     IpcMemory(IpcMemory&&) = default;
     IpcMemory& operator=(IpcMemory&&) = default;
 
+    //! The buffers of the getNodeGroupSize ranks sharing them, by their rank within the node.
     [[nodiscard]] std::vector<void*> const& getCommPtrs() const
     {
         return mCommPtrs;
@@ -53,12 +59,52 @@ private:
     void allocateIpcMemory(std::size_t bufferSize, BufferManager const& manager, WorldConfig const& worldConfig);
     void destroyIpcMemory();
 
-    SizeType32 mTpRank;
+    // The rank among the ranks sharing the buffers.
+    SizeType32 mNodeRank;
     std::vector<void*> mCommPtrs;
     BufferPtr mBuffer;
     bool mOpenIpc;
 };
 
+//! A buffer of every rank of the tensor parallel group bound to one NVLink SHARP multicast object. Writes through the
+//! multicast pointer reach the buffers of all ranks, multimem loads through it are reduced by the NVSwitch.
+class IpcMulticastMemory
+{
+public:
+    //! Whether all ranks of the tensor parallel group are on one node and their GPUs support multicast objects.
+    //! Collective over the tensor parallel group.
+    static bool isSupported(WorldConfig const& worldConfig);
+
+    //! Collective over the tensor parallel group.
+    IpcMulticastMemory(std::size_t bufferSize, WorldConfig const& worldConfig);
+    ~IpcMulticastMemory();
+
+    IpcMulticastMemory(IpcMulticastMemory const&) = delete;
+    IpcMulticastMemory& operator=(IpcMulticastMemory const&) = delete;
+
+    [[nodiscard]] void* getUnicastPtr() const
+    {
+        return reinterpret_cast<void*>(mUcPtr);
+    }
+
+    [[nodiscard]] void* getMulticastPtr() const
+    {
+        return reinterpret_cast<void*>(mMcPtr);
+    }
+
+private:
+    void allocateMulticastMemory(std::size_t bufferSize, WorldConfig const& worldConfig);
+    void destroyMulticastMemory();
+
+    std::shared_ptr<common::CUDADriverWrapper> mDriver;
+    CUdevice mDevice{0};
+    std::size_t mSize{0};
+    CUmemGenericAllocationHandle mUcHandle{0};
+    CUmemGenericAllocationHandle mMcHandle{0};
+    CUdeviceptr mUcPtr{0};
+    CUdeviceptr mMcPtr{0};
+};
+
 class AllReduceBuffers
 {
 public:
@@ -69,6 +115,8 @@ public:
 
     TensorPtr mAllReduceCommPtrs;
     std::vector<runtime::IpcMemory> mIpcMemoryHandles;
+    //! The buffer of the NVLS strategy, null when multicast is unsupported.
+    std::unique_ptr<runtime::IpcMulticastMemory> mMulticastMemory;
 };
 
 } // namespace tensorrt_llm::runtime
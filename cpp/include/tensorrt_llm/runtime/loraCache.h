@@ -28,10 +28,12 @@
 #include <NvInferRuntime.h>
 
 #include <deque>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <stdexcept>
 #include <unordered_map>
 
@@ -72,6 +74,9 @@ public:
     /**
      * \brief claim pages
      *
+     * Any free pages are claimed, in any block. Pages of a task need not be adjacent, since the weights of a module
+     * never span pages, so free pages left between pinned tasks are never too fragmented to claim.
+     *
      * \param[in] numPages number of pages to claim
      * \returns a tuple, where the first values is a boolean indicating whether pages were claimed.  If the first value
      * is true the second value will have a list of pageIds
@@ -175,6 +180,12 @@ public:
 
     using TaskLayerModuleConfigListPtr = std::shared_ptr<std::vector<TaskLayerModuleConfig>>;
 
+    /**
+     * Fills the first usedSlots[i] slots of pages[i] with the weights of a task and returns once they are written.
+     */
+    using PageFillFn
+        = std::function<void(std::vector<TensorPtr> const& pages, std::vector<SizeType32> const& usedSlots)>;
+
     /**
      * param[in] pageManagerConfig: a LoraCachePageManagerConfig
      * param[in] modelConfig: a ModelConfig
@@ -194,6 +205,19 @@ public:
      */
     void put(TaskIdType taskId, TensorPtr weights, TensorPtr config, bool load = true);
 
+    /**
+     * \brief put a task in the cache and claim pages for it like put, but let fillPages write the weights into the
+     * pages, e.g. the shard of this rank received from another rank, see LoraShardScatter. The weights must be laid
+     * out in the pages as copyToPages lays them out for the WorldConfig of this cache.
+     *
+     * \param[in] taskId: the task id
+     * \param[in] config: lora config tensor
+     * \param[in] fillPages: called once the pages are claimed
+     * \returns -- false if the task is already in the cache, fillPages is not called then
+     * \throws std::runtime_error if the pages cannot be claimed, fillPages is not called then
+     */
+    bool putPages(TaskIdType taskId, TensorPtr config, PageFillFn const& fillPages);
+
     /**
      * \brief load task weights.  This method must be called after put.  It is designed to be called asynchronously
      * after put returns with load = false
@@ -273,13 +297,32 @@ public:
     [[nodiscard]] bool fits(TensorPtr config) const;
 
     /**
-     * \brief copy task to another cache. Caches must have the same page size.
+     * \brief copy task to another cache. Caches must have the same page size. Tasks copied to a quantized device cache,
+     * see isQuantized, are quantized on the way.
      * \param[in] taskId: the task id to copy
      * \param[in] otherCache: the LoraCache to move the task to
      * \param[in] markDone: mark the copied task done as it's copied
      */
     void copyTask(TaskIdType taskId, LoraCache& deviceCache, bool markDone = false);
 
+    /**
+     * \returns -- true if the cache stores the adapters quantized with per-row scales instead of in the model data
+     * type. GPU caches are quantized when TRTLLM_LORA_DEVICE_CACHE_DTYPE is set, with as many pages as fit in the
+     * memory of the configured pages. Quantized caches can only be filled by copyTask.
+     */
+    [[nodiscard]] bool isQuantized() const noexcept
+    {
+        return mQuantized;
+    }
+
+    /**
+     * \returns -- the configuration of the pages, after quantization, see isQuantized
+     */
+    [[nodiscard]] LoraCachePageManagerConfig const& getPageManagerConfig() const noexcept
+    {
+        return mPageManagerConfig;
+    }
+
     /**
      * \returns -- total number of pages allocated to cache (used or not)
      */
@@ -392,6 +435,18 @@ private:
 
     using TaskValuePtr = std::shared_ptr<TaskValue>;
 
+    /**
+     * \brief Location of the weights of a config row in the pages of a task
+     */
+    struct RowLocation
+    {
+        SizeType32 row;
+        // index into the pages of the task
+        SizeType32 pageIdx;
+        SizeType32 slotIdx;
+        SizeType32 numSlots;
+    };
+
     enum ValueStatus
     {
         // task is not in the cache (inProgress or Done)
@@ -405,6 +460,7 @@ private:
     LoraCachePageManagerConfig mPageManagerConfig;
     ModelConfig mModelConfig;
     WorldConfig mWorldConfig;
+    bool mQuantized{false};
 
     // Protects mCachePageManager
     mutable std::mutex mPagesMutex;
@@ -428,6 +484,19 @@ private:
     template <typename T>
     static void splitTransposeCpuInner(ITensor& output, ITensor const& input, SizeType32 tpSize, SizeType32 tpRank);
 
+    /**
+     * \brief locate the rows of config of the local layers in pages, one row after the other
+     */
+    static std::vector<RowLocation> locateRows(TensorPtr const& config, ModelConfig const& modelConfig,
+        WorldConfig const& worldConfig, std::unordered_map<SizeType32, LoraModule> const& moduleIdToModule,
+        SizeType32 slotsPerPage, SizeType32 pageWidth);
+
+    /**
+     * \brief add a task to the cache and claim its pages, unless the task is already in the cache
+     * \returns -- the new task, std::nullopt if the task is already in the cache
+     */
+    std::optional<TaskValuePtr> addTask(TaskIdType taskId, TensorPtr const& config);
+
     void loadWeights(TaskValue& cacheValue, TensorPtr weights, TensorPtr config);
     void bumpTaskInProgress(TaskIdType taskId);
     [[nodiscard]] ValueStatus getStatus(TaskIdType taskId) const;
@@ -440,6 +509,23 @@ private:
      */
     [[nodiscard]] std::vector<std::size_t> claimPagesWithEvict(SizeType32 numPages);
 
+    /**
+     * \returns -- number of slots a module of a task takes in this cache
+     */
+    [[nodiscard]] SizeType32 determineNumSlots(LoraModule const& module, SizeType32 adapterSize) const;
+
+    /**
+     * \returns -- number of pages needed to store a task of another cache in this cache
+     */
+    [[nodiscard]] SizeType32 determineNumPages(std::vector<TaskLayerModuleConfig> const& configs) const;
+
+    /**
+     * Internal helper method used inside copyTask to quantize the weights of a task into the pages of a quantized
+     * target cache.  Not thread safe on its own
+     */
+    void copyTaskQuantizePages(TaskValue& targetTaskValue, TaskValue const& sourceTaskValue,
+        std::vector<size_t> const& targetPageIds, LoraCache& targetCache, size_t bufferManagerOffset) const;
+
     /**
      * Internal helper method used inside copyTask.  Not thread safe on its own
      */
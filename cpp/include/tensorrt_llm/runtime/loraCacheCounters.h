@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+
+#include <cstddef>
+#include <mutex>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Hits, misses, evictions and load times of the LoRA caches of the process.
+//! \details The host cache counts a hit for every request whose adapter it already holds and a miss for every adapter
+//! it loads. The device cache counts a hit for every adapter that is already resident when a batch needs it and a miss
+//! for every adapter copied in from the host cache.
+class LoraCacheCounters
+{
+public:
+    enum class Tier
+    {
+        kHOST,
+        kDEVICE,
+    };
+
+    LoraCacheCounters() = default;
+
+    //! \brief The tier of a cache by the memory its pages are in.
+    [[nodiscard]] static Tier getTier(MemoryType memoryType) noexcept
+    {
+        return memoryType == MemoryType::kGPU ? Tier::kDEVICE : Tier::kHOST;
+    }
+
+    void recordHit(Tier tier);
+
+    void recordMiss(Tier tier);
+
+    void recordEvictions(Tier tier, std::size_t numEvictions);
+
+    void recordLoadTime(Tier tier, double loadMS);
+
+    //! \brief The stats since the previous call, which then restart from zero.
+    [[nodiscard]] executor::LoraCacheStats getStats();
+
+    static LoraCacheCounters& getInstance();
+
+private:
+    std::mutex mMutex;
+    executor::LoraCacheStats mStats{};
+};
+
+} // namespace tensorrt_llm::runtime
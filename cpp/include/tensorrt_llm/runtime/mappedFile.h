@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Read-only memory mapping of a whole file.
+//! \details Pages are backed by the page cache, so processes mapping the same file, e.g. the ranks of a node loading
+//! the same engine, share one copy in host memory, and no private buffer holds the file.
+class MappedFile
+{
+public:
+    //! \param prefetch Start reading the whole file in the background, for files that are consumed front to back.
+    explicit MappedFile(std::filesystem::path path, bool prefetch = true);
+    ~MappedFile();
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    [[nodiscard]] void const* data() const noexcept
+    {
+        return mData;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return mSize;
+    }
+
+    [[nodiscard]] std::filesystem::path const& getPath() const noexcept
+    {
+        return mPath;
+    }
+
+    //! \brief Tell the kernel that the pages are not needed anymore, e.g. after deserializing an engine. The mapping
+    //! stays valid, pages are read again on access.
+    void release() const noexcept;
+
+    //! \brief Read all pages into the page cache now, blocking until they are resident.
+    void populate() const noexcept;
+
+private:
+    std::filesystem::path mPath;
+    void* mData{nullptr};
+    std::size_t mSize{0};
+};
+
+} // namespace tensorrt_llm::runtime
@@ -17,21 +17,64 @@
 #pragma once
 
 #include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/executor/types.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 
+#include <array>
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace tensorrt_llm::runtime
 {
 
+//! \brief The subsystem an allocation is accounted to.
+enum class MemoryTag : std::uint8_t
+{
+    kUNTAGGED = 0,
+    kWEIGHTS = 1,
+    kACTIVATIONS = 2,
+    kKV_CACHE = 3,
+    kDECODER = 4,
+    kLORA = 5,
+    kIO_BUFFERS = 6,
+};
+
 class MemoryCounters
 {
 public:
     using SizeType32 = std::size_t;
     using DiffType = std::ptrdiff_t;
 
+    static auto constexpr kNumTags = static_cast<std::size_t>(MemoryTag::kIO_BUFFERS) + 1;
+    static auto constexpr kNumMemoryTypes = static_cast<std::size_t>(MemoryType::kPINNEDPOOL) + 1;
+
+    //! \brief Accounts the buffers that the current thread creates while the scope is alive to a tag.
+    //! \details A buffer keeps the tag it was created with for its lifetime, including later resizes. Scopes nest,
+    //! the innermost one wins.
+    class TagScope
+    {
+    public:
+        explicit TagScope(MemoryTag tag) noexcept
+            : mPrevTag{getCurrentTag()}
+        {
+            setCurrentTag(tag);
+        }
+
+        ~TagScope()
+        {
+            setCurrentTag(mPrevTag);
+        }
+
+        TagScope(TagScope const&) = delete;
+        TagScope& operator=(TagScope const&) = delete;
+
+    private:
+        MemoryTag mPrevTag;
+    };
+
     MemoryCounters() = default;
 
     [[nodiscard]] SizeType32 getGpu() const
@@ -158,6 +201,28 @@ public:
 
     void deallocate(MemoryType memoryType, SizeType32 size);
 
+    //! \brief Account size bytes to a tag, in addition to the per memory type totals.
+    void allocate(MemoryTag tag, MemoryType memoryType, SizeType32 size);
+
+    void deallocate(MemoryTag tag, MemoryType memoryType, SizeType32 size);
+
+    [[nodiscard]] SizeType32 getTagged(MemoryTag tag, MemoryType memoryType) const;
+
+    //! \brief High-water mark of getTagged since construction or the last resetTaggedPeaks.
+    [[nodiscard]] SizeType32 getTaggedPeak(MemoryTag tag, MemoryType memoryType) const;
+
+    //! \brief Reset the high-water marks to the current usage, e.g. to measure the peak of a single phase.
+    void resetTaggedPeaks();
+
+    //! \brief Usage and peak per tag, for tags that have seen any allocation.
+    [[nodiscard]] std::vector<executor::MemoryTagStats> getTagStats() const;
+
+    [[nodiscard]] static MemoryTag getCurrentTag() noexcept;
+
+    static void setCurrentTag(MemoryTag tag) noexcept;
+
+    [[nodiscard]] static char const* getTagName(MemoryTag tag);
+
     static MemoryCounters& getInstance();
 
     static std::string bytesToString(SizeType32 bytes, int precision = 2);
@@ -169,6 +234,8 @@ public:
 private:
     std::atomic<SizeType32> mGpu{}, mCpu{}, mPinned{}, mUVM{}, mPinnedPool{};
     std::atomic<DiffType> mGpuDiff{}, mCpuDiff{}, mPinnedDiff{}, mUVMDiff{}, mPinnedPoolDiff{};
+    std::array<std::array<std::atomic<SizeType32>, kNumMemoryTypes>, kNumTags> mTagged{};
+    std::array<std::array<std::atomic<SizeType32>, kNumMemoryTypes>, kNumTags> mTaggedPeak{};
 };
 
 } // namespace tensorrt_llm::runtime
@@ -196,6 +196,17 @@ public:
         return mSizePerHead;
     }
 
+    //! Elements of getKvDataType() per head and token in the kv cache. INT4 kv caches store the packed values followed
+    //! by one fp16 scale per group of 32 channels, see kernels/int4KvCacheUtils.h.
+    [[nodiscard]] SizeType32 constexpr getKvCacheSizePerHead() const noexcept
+    {
+        if (getQuantMode().hasInt4KvCache())
+        {
+            return mSizePerHead / 2 + mSizePerHead / 32 * 2;
+        }
+        return mSizePerHead;
+    }
+
     void constexpr setSizePerHead(SizeType32 sizePerHead) noexcept
     {
         mSizePerHead = sizePerHead;
@@ -554,8 +565,9 @@ public:
         {
             return nvinfer1::DataType::kFP8;
         }
-        else if (getQuantMode().hasInt8KvCache())
+        else if (getQuantMode().hasInt8KvCache() || getQuantMode().hasInt4KvCache())
         {
+            // INT4 kv caches are byte buffers holding packed values and their scales.
             return nvinfer1::DataType::kINT8;
         }
         else
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Decides which experts of an offloaded MoE layer are resident in its device expert slots.
+//! \details All the experts of the layer are in host memory and only numSlots of them fit on the device. Before every
+//! step the router logits tell which experts the tokens select. The tokens are split into chunks whose experts fit
+//! into the slots, and the missing experts of every chunk are loaded in place of the resident experts that the chunk
+//! does not use and that were selected the least over recent steps, so the frequently selected experts stay resident.
+class MoeExpertResidency
+{
+public:
+    struct Load
+    {
+        SizeType32 expert;
+        SizeType32 slot;
+    };
+
+    struct Chunk
+    {
+        SizeType32 beginToken;
+        SizeType32 endToken;
+        //! Experts to copy into their slots before the chunk runs
+        std::vector<Load> loads;
+        //! Whether a load replaces an expert the previous chunk reads, the loads then wait for that chunk
+        bool overwritesPrevious{false};
+        //! The slot of every expert while the chunk runs. Experts that are not resident point to slot 0, no token of
+        //! the chunk selects them.
+        std::vector<SizeType32> expertSlots;
+    };
+
+    //! \param decay Weight of the past selection counts kept on every step
+    MoeExpertResidency(SizeType32 numExperts, SizeType32 numSlots, SizeType32 topK, float decay = 0.99f);
+
+    //! \brief Plan a step and update the residency, the loads of the chunks must be done in order.
+    //! \param routing Router logits [numTokens, numExperts] on the host. Every expert whose logit is at least the k-th
+    //! largest one of a token counts as selected, so ties never select an expert that is not resident.
+    //! \throws std::runtime_error if a single token selects more experts than there are slots
+    [[nodiscard]] std::vector<Chunk> plan(float const* routing, SizeType32 numTokens);
+
+    //! \brief The expert held by every slot, -1 for slots that were never loaded.
+    [[nodiscard]] std::vector<SizeType32> const& getSlotExperts() const noexcept
+    {
+        return mSlotExperts;
+    }
+
+    //! \brief Decayed selection count of an expert, which orders the experts for eviction.
+    [[nodiscard]] float getFrequency(SizeType32 expert) const
+    {
+        return mFrequencies.at(expert);
+    }
+
+    [[nodiscard]] SizeType32 getNumExperts() const noexcept
+    {
+        return mNumExperts;
+    }
+
+    [[nodiscard]] SizeType32 getNumSlots() const noexcept
+    {
+        return static_cast<SizeType32>(mSlotExperts.size());
+    }
+
+private:
+    //! \returns -- the slots the chunk reads
+    std::vector<bool> assignSlots(
+        Chunk& chunk, std::vector<SizeType32> const& experts, std::vector<bool> const& usedByPrevious);
+
+    SizeType32 mNumExperts;
+    SizeType32 mTopK;
+    float mDecay;
+    std::vector<SizeType32> mSlotExperts;
+    std::vector<SizeType32> mExpertSlots;
+    std::vector<float> mFrequencies;
+    std::vector<float> mScratch;
+};
+
+//! \brief The host copies of the experts of offloaded MoE layers, by layer name.
+//! \details A MoE plugin with expert offloading holds only the expert slots in its weights. The application registers
+//! all experts of the layer before the engine runs, each per expert weight of the plugin as a pinned host tensor
+//! [numExperts, ...] in the order of the plugin inputs: fc1 and fc2 weights, then the fc1 and fc2 biases and the
+//! per expert quantization scales that the plugin takes. The plugin instances of a layer (the clones TensorRT makes
+//! for its execution contexts) share the slots, so they share one residency as well.
+class MoeOffloadedExperts
+{
+public:
+    struct Layer
+    {
+        std::vector<ITensor::SharedPtr> hostExperts;
+        std::unique_ptr<MoeExpertResidency> residency;
+        //! Held by a plugin from planning a step until all its chunks are enqueued
+        std::mutex mutex;
+    };
+
+    MoeOffloadedExperts() = default;
+
+    //! \brief Register the experts of a layer, replacing earlier ones.
+    void registerLayer(std::string const& layer, std::vector<ITensor::SharedPtr> hostExperts);
+
+    //! \brief The experts of a registered layer, with its residency created on first use.
+    //! \throws std::runtime_error if the layer was not registered or its slots do not match earlier calls
+    [[nodiscard]] std::shared_ptr<Layer> getLayer(std::string const& layer, SizeType32 numSlots, SizeType32 topK);
+
+    void unregisterLayer(std::string const& layer);
+
+    static MoeOffloadedExperts& getInstance();
+
+private:
+    std::mutex mMutex;
+    std::map<std::string, std::shared_ptr<Layer>> mLayers;
+};
+
+} // namespace tensorrt_llm::runtime
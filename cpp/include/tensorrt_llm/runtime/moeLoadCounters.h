@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Per expert token counts of the MoE layers of the process.
+//! \details The MoE plugins acquire a device histogram per layer when TRTLLM_MOE_LOAD_STATS is set and the routing
+//! kernels add every selected expert to it. The plugin instances of a layer (the clones TensorRT makes for its
+//! execution contexts) share the histogram of the layer name.
+class MoeLoadCounters
+{
+public:
+    MoeLoadCounters() = default;
+
+    //! \brief The device histogram [numExperts] of a layer, zeroed when it is first acquired.
+    [[nodiscard]] std::int32_t* acquire(std::string const& layer, std::int32_t numExperts);
+
+    //! \brief Release a histogram, it is freed with its last user.
+    void release(std::string const& layer);
+
+    //! \brief The counts of every layer since the previous call, which then restart from zero.
+    //! \details Synchronizes with the device, call it between iterations so no routing kernel is in flight.
+    [[nodiscard]] std::vector<executor::MoeLayerLoadStats> getStats();
+
+    static MoeLoadCounters& getInstance();
+
+private:
+    struct Layer
+    {
+        IBuffer::SharedPtr counts;
+        std::int32_t numUsers{0};
+    };
+
+    std::mutex mMutex;
+    std::map<std::string, Layer> mLayers;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief executorWorker processes that outlive the executors of an orchestrator.
+//! \details The pool spawns its workers once. The configuration of every executor attached to the pool is sent to the
+//! running workers, which create their executor, serve until the executor of the orchestrator shuts down and then wait
+//! for the next configuration. Their CUDA contexts, NCCL communicators and JIT kernel caches stay initialized across
+//! executors, so a restart or a model swap only loads the new engine. One executor at a time runs on a pool, it must
+//! be shut down before the next one is created and before the pool is destroyed.
+class OrchestratorWorkerPool
+{
+public:
+    //! Argument of executorWorker processes spawned by a pool, which serve executors until the pool releases them.
+    static constexpr char const* kPersistentFlag = "--persistent";
+    //! Broadcast in place of the size of the next configuration to release the workers.
+    static constexpr std::int64_t kReleaseWorkers = 0;
+
+    //! \brief Spawn numWorkers processes of workerExecutablePath, one per rank of the engines attached later.
+    OrchestratorWorkerPool(std::string workerExecutablePath, SizeType32 numWorkers);
+
+    //! \brief Release the workers, which exit.
+    ~OrchestratorWorkerPool();
+
+    OrchestratorWorkerPool(OrchestratorWorkerPool const&) = delete;
+    OrchestratorWorkerPool& operator=(OrchestratorWorkerPool const&) = delete;
+
+    [[nodiscard]] SizeType32 getNumWorkers() const noexcept
+    {
+        return mNumWorkers;
+    }
+
+    //! \brief The configuration of an orchestrator executor of the engine in modelPath that runs on the workers of the
+    //! pool instead of spawning its own.
+    //! \throws std::runtime_error if the engine has a world size different from the number of workers
+    [[nodiscard]] executor::ExecutorConfig attach(
+        std::filesystem::path const& modelPath, executor::ExecutorConfig config) const;
+
+private:
+    std::string mWorkerExecutablePath;
+    SizeType32 mNumWorkers;
+    //! Intercommunicator between the orchestrator and the workers
+    std::shared_ptr<mpi::MpiComm> mComm;
+};
+
+} // namespace tensorrt_llm::runtime
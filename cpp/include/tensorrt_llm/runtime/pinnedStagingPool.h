@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/types.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Size-class slab allocator for the pinned host buffers that stage request inputs and outputs.
+//! \details Input tokens, prompt tuning tables, draft tokens and returned logits are copied between host and device
+//! once per request. Allocating and registering pinned memory for each of them is slow at high request rates, so
+//! requests up to kMaxClassSize are rounded up to a power of two and served from a free list of that size, refilled
+//! with kSlabSize pinned slabs. Larger requests go to the pinned MemoryPool (PinnedPoolAllocator). trimTo frees the
+//! slabs nothing is allocated from, like CudaMemPool::memoryPoolTrimTo does for device memory.
+//! Use BufferManager::pinnedStaging to allocate buffers from the process-wide instance.
+class PinnedStagingPool
+{
+public:
+    static std::size_t constexpr kMinClassSize{std::size_t{1} << 8};   // 256 B
+    static std::size_t constexpr kMaxClassSize{std::size_t{1} << 20};  // 1 MiB
+    static std::size_t constexpr kSlabSize{std::size_t{1} << 22};      // 4 MiB
+    static std::size_t constexpr kNumClasses{13};
+
+    PinnedStagingPool() = default;
+    ~PinnedStagingPool();
+
+    PinnedStagingPool(PinnedStagingPool const&) = delete;
+    PinnedStagingPool& operator=(PinnedStagingPool const&) = delete;
+
+    [[nodiscard]] void* allocate(std::size_t size);
+
+    //! \brief Return memory, size must be the size it was allocated with.
+    void deallocate(void* ptr, std::size_t size);
+
+    //! \brief Free unused slabs until the slabs of the pool hold at most bytesToKeep bytes.
+    //! \return The number of bytes freed.
+    std::size_t trimTo(std::size_t bytesToKeep);
+
+    //! \brief Pinned memory held by the slabs in bytes.
+    [[nodiscard]] std::size_t getReservedSize() const;
+
+    //! \brief Bytes handed out, rounded up to the size classes.
+    [[nodiscard]] std::size_t getUsedSize() const;
+
+    //! \brief The stats since the previous call, the counters then restart from zero.
+    [[nodiscard]] executor::PinnedStagingStats getStats();
+
+    //! \brief The size class of a request, kNumClasses for requests served by the pinned MemoryPool.
+    [[nodiscard]] static std::size_t getSizeClass(std::size_t size) noexcept;
+
+    static PinnedStagingPool& getInstance();
+
+private:
+    struct Slab
+    {
+        std::size_t sizeClass;
+        std::uint32_t numBlocks;
+        std::uint32_t numFree;
+    };
+
+    void allocateSlab(std::size_t sizeClass);
+
+    std::mutex mutable mMutex;
+    std::array<std::vector<void*>, kNumClasses> mFreeLists{};
+    //! Slabs by base address
+    std::map<std::uintptr_t, Slab> mSlabs;
+    std::unordered_map<void*, std::size_t> mLargeAllocations;
+    std::size_t mUsedSize{0};
+    std::uint64_t mNumAllocations{0};
+    std::uint64_t mNumMisses{0};
+    std::size_t mTrimmedSize{0};
+};
+
+} // namespace tensorrt_llm::runtime
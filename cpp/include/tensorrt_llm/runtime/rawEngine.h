@@ -18,11 +18,14 @@
 
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/executor/tensor.h"
+#include "tensorrt_llm/runtime/mappedFile.h"
 
 #include <NvInferRuntime.h>
 #include <filesystem>
 #include <map>
+#include <memory>
 #include <optional>
+#include <string>
 
 namespace tensorrt_llm::runtime
 {
@@ -34,7 +37,8 @@ public:
     {
         FilePath,
         AddressWithSize,
-        HostMemory
+        HostMemory,
+        MemoryMapped
     };
 
     explicit RawEngine(std::filesystem::path enginePath) noexcept
@@ -56,6 +60,14 @@ public:
     {
     }
 
+    //! \brief Engine deserialized from a memory mapping of the engine file, see MappedFile.
+    explicit RawEngine(std::shared_ptr<MappedFile const> mappedFile) noexcept
+        : mType(MemoryMapped)
+        , mEnginePath(mappedFile->getPath())
+        , mMappedFile(std::move(mappedFile))
+    {
+    }
+
     [[nodiscard]] Type getType() const
     {
         return mType;
@@ -88,6 +100,18 @@ public:
         mManagedWeightsMap = std::move(managedWeightsMap);
     }
 
+    //! \brief Runtimes created from raw engines with the same share key on one device share the deserialized engine,
+    //! see EngineRegistry.
+    void setShareKey(std::string shareKey)
+    {
+        mShareKey = std::move(shareKey);
+    }
+
+    [[nodiscard]] std::optional<std::string> const& getShareKeyOpt() const
+    {
+        return mShareKey;
+    }
+
     [[nodiscard]] void const* getAddress() const
     {
         TLLM_CHECK(mType == AddressWithSize);
@@ -106,6 +130,12 @@ public:
         return mEngineBuffer;
     }
 
+    [[nodiscard]] MappedFile const& getMappedFile() const
+    {
+        TLLM_CHECK(mType == MemoryMapped);
+        return *mMappedFile;
+    }
+
 private:
     Type mType;
     std::optional<std::filesystem::path> mEnginePath;
@@ -117,7 +147,9 @@ private:
     };
 
     nvinfer1::IHostMemory const* mEngineBuffer{};
+    std::shared_ptr<MappedFile const> mMappedFile;
     std::optional<std::map<std::string, tensorrt_llm::executor::Tensor>> mManagedWeightsMap;
+    std::optional<std::string> mShareKey;
 };
 
 } // namespace tensorrt_llm::runtime
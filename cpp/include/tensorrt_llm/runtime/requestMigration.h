@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Continues a migrated request on the importing executor.
+//! \details The importing executor runs the prompt and the exported tokens as the input of the request, their KV
+//! cache pulled from the exporting executor, so its results hold only the tokens it generates after the exported ones.
+//! The results are stitched to the exported tokens, so the client sees the results the exporting executor would have
+//! returned. Streamed results without all generated tokens only hold the new tokens and pass unchanged.
+class RequestMigration
+{
+public:
+    //! \throws std::runtime_error if the request has several beams, no generated tokens or no tokens left to generate
+    explicit RequestMigration(executor::MigratedRequest migrated);
+
+    //! \brief Tokens whose KV cache is pulled from the exporting executor, all but the last generated token, which is
+    //! the first input of the next step.
+    [[nodiscard]] SizeType32 getNumCachedTokens() const noexcept
+    {
+        return mPromptLen + static_cast<SizeType32>(mMigrated.generatedTokens.size()) - 1;
+    }
+
+    //! \brief The input of the request on the importing executor, the prompt followed by the generated tokens.
+    [[nodiscard]] executor::VecTokens getInputTokenIds() const;
+
+    //! \brief The tokens left to generate.
+    [[nodiscard]] SizeType32 getMaxNewTokens() const noexcept
+    {
+        return mMigrated.request.getMaxTokens() - static_cast<SizeType32>(mMigrated.generatedTokens.size());
+    }
+
+    //! \brief The step to resume the random stream of the request at, see SamplingConfig::randomStep.
+    [[nodiscard]] std::uint64_t getRandomStep() const noexcept
+    {
+        return mMigrated.randomStep;
+    }
+
+    [[nodiscard]] executor::MigratedRequest const& getMigratedRequest() const noexcept
+    {
+        return mMigrated;
+    }
+
+    //! \brief Prepend the exported tokens and log probabilities to a result of the importing executor.
+    void stitch(executor::Result& result) const;
+
+private:
+    executor::MigratedRequest mMigrated;
+    SizeType32 mPromptLen;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -141,6 +141,9 @@ public:
         randomSeed = fuseValues<uint64_t>(
             configs, [&configs](size_t ci) { return configs[ci].randomSeed; },
             layers::DefaultDecodingParams::getSeed());
+        randomStep = fuseValues<uint64_t>(
+            configs, [&configs](size_t ci) { return configs[ci].randomStep; },
+            layers::DefaultDecodingParams::getRandomStep());
         topPDecay = fuseValues<FloatType>(
             configs, [&configs](size_t ci) { return configs[ci].topPDecay; },
             layers::DefaultDecodingParams::getTopPDecay());
@@ -150,6 +153,8 @@ public:
         topPResetIds = fuseValues<TokenIdType>(
             configs, [&configs](size_t ci) { return configs[ci].topPResetIds; },
             layers::DefaultDecodingParams::getTopPResetId());
+        minP = fuseValues<FloatType>(
+            configs, [&configs](size_t ci) { return configs[ci].minP; }, layers::DefaultDecodingParams::getMinP());
         beamSearchDiversityRate = fuseValues<FloatType>(
             configs, [&configs](size_t ci) { return configs[ci].beamSearchDiversityRate; },
             layers::DefaultDecodingParams::getBeamSearchDiversity());
@@ -159,9 +164,23 @@ public:
         earlyStopping = fuseValues<SizeType32>(
             configs, [&configs](size_t ci) { return configs[ci].earlyStopping; },
             layers::DefaultDecodingParams::getEarlyStopping());
+        numBeamGroups = fuseValues<SizeType32>(
+            configs, [&configs](size_t ci) { return configs[ci].numBeamGroups; },
+            layers::DefaultDecodingParams::getNumBeamGroups());
+        beamGroupDiversityPenalty = fuseValues<FloatType>(
+            configs, [&configs](size_t ci) { return configs[ci].beamGroupDiversityPenalty; },
+            layers::DefaultDecodingParams::getBeamGroupDiversityPenalty());
         topKMedusaHeads = fuseValues<std::vector<SizeType32>>(
             configs, [&configs](size_t ci) { return configs[ci].topKMedusaHeads; },
             layers::DefaultDecodingParams::getTopKMedusaHeads());
+        typicalAcceptanceThreshold = fuseValues<FloatType>(
+            configs, [&configs](size_t ci) { return configs[ci].typicalAcceptanceThreshold; },
+            layers::DefaultDecodingParams::getTypicalAcceptanceThreshold());
+        typicalAcceptanceAlpha = fuseValues<FloatType>(
+            configs, [&configs](size_t ci) { return configs[ci].typicalAcceptanceAlpha; },
+            layers::DefaultDecodingParams::getTypicalAcceptanceAlpha());
+        useDraftRejectionSampling = fuseValues<bool>(
+            configs, [&configs](size_t ci) { return configs[ci].useDraftRejectionSampling; }, false);
         outputLogProbs = fuseValues<bool>(
             configs, [&configs](size_t ci) { return configs[ci].outputLogProbs; }, false);
         cumLogProbs = fuseValues<bool>(
@@ -220,11 +239,20 @@ public:
                 "Requested beam width %d is incorrect. Must be > 0. To de-activate beam searching set beamWidth to 1.",
                 beamWidth);
         }
+        if (numReturnSequences && (*numReturnSequences <= 0 || (beamWidth > 1 && *numReturnSequences > beamWidth)))
+        {
+            TLLM_LOG_WARNING(
+                "Requested number of return sequences %d is incorrect. Must be > 0 and at most the beam width %d with "
+                "beam search.",
+                *numReturnSequences, beamWidth);
+            valid = false;
+        }
         valid &= validateVec("topK", topK, -1);
         valid &= validateVec("topP", topP, -fltEpsilon, {1.f});
         valid &= validateVec("topPMin", topPMin, 0.f, {1.f});
         valid &= validateVec("topPDecay", topPDecay, 0.f, {1.f});
         valid &= validateVec("topPResetIds", topPResetIds, -1);
+        valid &= validateVec("minP", minP, -fltEpsilon, {1.f});
 
         valid &= validateVec("temperature", temperature, -fltEpsilon);
         valid &= validateVec("repetitionPenalty", repetitionPenalty, 0.f);
@@ -232,6 +260,21 @@ public:
         valid &= validateVec("noRepeatNgramSize", noRepeatNgramSize, 0);
 
         valid &= validateVec("beamSearchDiversityRate", beamSearchDiversityRate, -fltEpsilon);
+        valid &= validateVec("numBeamGroups", numBeamGroups, 0);
+        valid &= validateVec("beamGroupDiversityPenalty", beamGroupDiversityPenalty, -fltEpsilon);
+        if (numBeamGroups)
+        {
+            for (auto const groups : *numBeamGroups)
+            {
+                if (beamWidth % groups != 0)
+                {
+                    TLLM_LOG_WARNING("beamWidth (%d) must be a multiple of numBeamGroups (%d)", beamWidth, groups);
+                    valid = false;
+                }
+            }
+        }
+        valid &= validateVec("typicalAcceptanceThreshold", typicalAcceptanceThreshold, -fltEpsilon, {1.f});
+        valid &= validateVec("typicalAcceptanceAlpha", typicalAcceptanceAlpha, -fltEpsilon);
 
         // Detect greedy sampling and overwrite params.
         if (temperature)
@@ -276,34 +319,53 @@ public:
     OptVec<SizeType32> topK;          // [1] or [batch_size] on cpu
     OptVec<FloatType> topP;           // [1] or [batch_size] on cpu
     OptVec<uint64_t> randomSeed;      // [1] or [batch_size] on cpu
+    OptVec<uint64_t> randomStep;      // [1] or [batch_size] on cpu, the step to resume the random stream at
     OptVec<FloatType> topPDecay;      // [batch_size], must between [0, 1]
     OptVec<FloatType> topPMin;        // [batch_size], must between [0, 1]
     OptVec<TokenIdType> topPResetIds; // [batch_size]
+    OptVec<FloatType> minP;           // [1] or [batch_size], must between [0, 1]. Only used by rejection sampling
 
     // beam search layer
     OptVec<FloatType> beamSearchDiversityRate; // [1] or [batch_size]
     OptVec<FloatType> lengthPenalty;           // [1] or [batch_size]
     OptVec<SizeType32> earlyStopping;          // [1] or [batch_size]
+    // Diverse beam search, beamWidth / numBeamGroups beams per group
+    OptVec<SizeType32> numBeamGroups;            // [1] or [batch_size], must divide beamWidth
+    OptVec<FloatType> beamGroupDiversityPenalty; // [1] or [batch_size], per token picked by a previous group
 
     // speculative decoding, only the first value is used (in gptDecoderBatched.cpp)
     OptVec<FloatType> draftAcceptanceThreshold; // [1] or [batch_size]
 
     // medusa params
     OptVec<std::vector<runtime::SizeType32>> topKMedusaHeads; // [batchSize, maxMedusaHeads]
+    // Accept draft tokens with target probability above min(threshold, alpha * exp(-entropy)). 0 disables it
+    OptVec<FloatType> typicalAcceptanceThreshold; // [1] or [batch_size], must between [0, 1]
+    OptVec<FloatType> typicalAcceptanceAlpha;     // [1] or [batch_size], must be >= 0
+    OptVec<bool> useDraftRejectionSampling;       // [1] or [batch_size], match drafts against the full target softmax
 
     std::optional<bool> normalizeLogProbs;
 
+    // Sequences returned for the request, per request and not fused, see executor::Request::getNumReturnSequences
+    std::optional<SizeType32> numReturnSequences;
+
     bool operator==(SamplingConfig const& other) const
     {
         return beamWidth == other.beamWidth && temperature == other.temperature && minLength == other.minLength
             && repetitionPenalty == other.repetitionPenalty && presencePenalty == other.presencePenalty
             && frequencyPenalty == other.frequencyPenalty && noRepeatNgramSize == other.noRepeatNgramSize
             && topK == other.topK && topP == other.topP && randomSeed == other.randomSeed
+            && randomStep == other.randomStep
             && topPDecay == other.topPDecay && topPMin == other.topPMin && topPResetIds == other.topPResetIds
-            && beamSearchDiversityRate == other.beamSearchDiversityRate && lengthPenalty == other.lengthPenalty
-            && earlyStopping == other.earlyStopping && draftAcceptanceThreshold == other.draftAcceptanceThreshold
-            && topKMedusaHeads == other.topKMedusaHeads && normalizeLogProbs == other.normalizeLogProbs
-            && outputLogProbs == other.outputLogProbs && cumLogProbs == other.cumLogProbs;
+            && minP == other.minP && beamSearchDiversityRate == other.beamSearchDiversityRate
+            && lengthPenalty == other.lengthPenalty && earlyStopping == other.earlyStopping
+            && numBeamGroups == other.numBeamGroups && beamGroupDiversityPenalty == other.beamGroupDiversityPenalty
+            && draftAcceptanceThreshold == other.draftAcceptanceThreshold
+            && topKMedusaHeads == other.topKMedusaHeads
+            && typicalAcceptanceThreshold == other.typicalAcceptanceThreshold
+            && typicalAcceptanceAlpha == other.typicalAcceptanceAlpha
+            && useDraftRejectionSampling == other.useDraftRejectionSampling
+            && normalizeLogProbs == other.normalizeLogProbs && outputLogProbs == other.outputLogProbs && cumLogProbs == other.cumLogProbs
+            && numReturnSequences == other.numReturnSequences;
     }
 };
 
@@ -50,6 +50,11 @@ public:
         return SpeculativeDecodingMode{kExplicitDraftTokens};
     }
 
+    static auto constexpr PromptLookup()
+    {
+        return SpeculativeDecodingMode{kPromptLookup};
+    }
+
     [[nodiscard]] bool constexpr isNone() const
     {
         return anyBitSet(kNone);
@@ -75,6 +80,17 @@ public:
         return anyBitSet(kExplicitDraftTokens);
     }
 
+    [[nodiscard]] bool constexpr isPromptLookup() const
+    {
+        return anyBitSet(kPromptLookup);
+    }
+
+    //! Draft tokens are supplied with the request and verified with the external draft tokens acceptance kernels.
+    [[nodiscard]] bool constexpr acceptsDraftTokensExternal() const
+    {
+        return anyBitSet(kDraftTokensExternal | kPromptLookup);
+    }
+
     [[nodiscard]] bool constexpr updatesPositionIds() const
     {
         return anyBitSet(kLookaheadDecoding | kExplicitDraftTokens);
@@ -98,7 +114,7 @@ public:
     [[nodiscard]] bool constexpr variableDraftLength() const
     {
         // Add Lookahead, when lookahead supports it.
-        return anyBitSet(kDraftTokensExternal | kExplicitDraftTokens);
+        return anyBitSet(kDraftTokensExternal | kExplicitDraftTokens | kPromptLookup);
     }
 
     [[nodiscard]] bool constexpr hasDraftLogits() const
@@ -130,6 +146,8 @@ private:
     static UnderlyingType constexpr kMedusa{1U << 2U};
     static UnderlyingType constexpr kLookaheadDecoding{1U << 3U};
     static UnderlyingType constexpr kExplicitDraftTokens{1U << 4U};
+    // Draft tokens are copied from the prompt and the output by n-gram matching, no draft model is used.
+    static UnderlyingType constexpr kPromptLookup{1U << 5U};
 
     [[nodiscard]] bool constexpr anyBitSet(UnderlyingType bits) const
     {
@@ -174,4 +192,13 @@ static_assert(!SpeculativeDecodingMode::ExplicitDraftTokens().isDraftTokensExter
 static_assert(!SpeculativeDecodingMode::ExplicitDraftTokens().isMedusa());
 static_assert(!SpeculativeDecodingMode::ExplicitDraftTokens().isLookaheadDecoding());
 
+static_assert(SpeculativeDecodingMode::PromptLookup().isPromptLookup());
+static_assert(!SpeculativeDecodingMode::PromptLookup().isNone());
+static_assert(!SpeculativeDecodingMode::PromptLookup().isDraftTokensExternal());
+static_assert(!SpeculativeDecodingMode::PromptLookup().isMedusa());
+static_assert(!SpeculativeDecodingMode::PromptLookup().isLookaheadDecoding());
+static_assert(!SpeculativeDecodingMode::PromptLookup().isExplicitDraftTokens());
+static_assert(SpeculativeDecodingMode::PromptLookup().acceptsDraftTokensExternal());
+static_assert(SpeculativeDecodingMode::DraftTokensExternal().acceptsDraftTokensExternal());
+
 } // namespace tensorrt_llm::runtime
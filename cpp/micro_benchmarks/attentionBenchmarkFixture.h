@@ -0,0 +1,632 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <nlohmann/json.hpp>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+#include "tensorrt_llm/common/workspace.h"
+#include "tensorrt_llm/kernels/contextFusedMultiHeadAttention/fmhaRunner.h"
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention.h"
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/decoderXQARunner.h"
+#include "tensorrt_llm/kernels/kvCacheUtils.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cuda.h>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace tensorrt_llm::kernels;
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+static BufferManager::CudaStreamPtr streamPtr;
+static std::unique_ptr<BufferManager> bufferManager;
+static int deviceCount;
+static char* workloadFile = nullptr;
+
+enum class AttentionKernel : int
+{
+    // Generation phase, one new token per sequence against a paged KV cache
+    MMHA = 0,
+    XQA = 1,
+    // Context phase, causal attention over the whole prompt
+    FMHA = 2,
+    // Context phase reading the KV from the paged KV cache, as with chunked context or KV cache reuse
+    PAGED_FMHA = 3,
+    END
+};
+
+enum class KvCacheType : int
+{
+    // Same type as the activations
+    SAME = 0,
+    INT8 = 1,
+    FP8 = 2,
+    END
+};
+
+inline char const* toString(AttentionKernel kernel)
+{
+    switch (kernel)
+    {
+    case AttentionKernel::MMHA: return "mmha";
+    case AttentionKernel::XQA: return "xqa";
+    case AttentionKernel::FMHA: return "fmha";
+    case AttentionKernel::PAGED_FMHA: return "paged_fmha";
+    default: TLLM_THROW("Unrecognised attention kernel");
+    }
+}
+
+inline char const* toString(KvCacheType type)
+{
+    switch (type)
+    {
+    case KvCacheType::SAME: return "same";
+    case KvCacheType::INT8: return "int8";
+    case KvCacheType::FP8: return "fp8";
+    default: TLLM_THROW("Unrecognised KV cache type");
+    }
+}
+
+//! \brief Peak DRAM bandwidth of the current device in bytes per second.
+inline double getPeakMemoryBandwidth()
+{
+    int device;
+    int memoryClockKHz;
+    int busWidthBits;
+    check_cuda_error(cudaGetDevice(&device));
+    check_cuda_error(cudaDeviceGetAttribute(&memoryClockKHz, cudaDevAttrMemoryClockRate, device));
+    check_cuda_error(cudaDeviceGetAttribute(&busWidthBits, cudaDevAttrGlobalMemoryBusWidth, device));
+    // Double data rate
+    return 2.0 * memoryClockKHz * 1000.0 * busWidthBits / 8.0;
+}
+
+template <class T>
+struct AttentionTypeTraits;
+
+template <>
+struct AttentionTypeTraits<half>
+{
+    // MMHA is instantiated for uint16_t rather than half
+    using MmhaType = uint16_t;
+    constexpr static Data_type DATA_TYPE = DATA_TYPE_FP16;
+};
+
+#ifdef ENABLE_BF16
+template <>
+struct AttentionTypeTraits<__nv_bfloat16>
+{
+    using MmhaType = __nv_bfloat16;
+    constexpr static Data_type DATA_TYPE = DATA_TYPE_BF16;
+};
+#endif
+
+template <class DataType_>
+class AttentionBenchmark : public benchmark::Fixture
+{
+public:
+    using DataType = DataType_;
+    using MmhaType = typename AttentionTypeTraits<DataType>::MmhaType;
+    constexpr static Data_type DATA_TYPE = AttentionTypeTraits<DataType>::DATA_TYPE;
+    // Upper bound of the KV splits of multi-block MMHA, as in the MMHA tuner
+    constexpr static int MAX_SEQ_LEN_TILE = 64;
+
+    std::vector<BufferManager::IBufferPtr> managed_buffers;
+
+    // Deprecated, just here to suppress warnings
+    void SetUp(benchmark::State const& s) override
+    {
+        abort();
+    }
+
+    void TearDown(benchmark::State const& s) override
+    {
+        abort();
+    }
+
+    cudaEvent_t mStartEvent, mEndEvent;
+
+    void SetUp(benchmark::State& s) override
+    {
+        assert(bufferManager);
+        // Makes sure nothing from a previous iteration hangs around
+        check_cuda_error(cudaDeviceSynchronize());
+        check_cuda_error(cudaEventCreate(&mStartEvent));
+        check_cuda_error(cudaEventCreate(&mEndEvent));
+    }
+
+    void TearDown(benchmark::State& s) override
+    {
+        managed_buffers.clear();
+        mXqaRunner.reset();
+        mFmhaRunner.reset();
+        check_cuda_error(cudaEventDestroy(mStartEvent));
+        check_cuda_error(cudaEventDestroy(mEndEvent));
+        check_cuda_error(cudaDeviceSynchronize());
+    }
+
+    template <class T>
+    T* allocBuffer(size_t size)
+    {
+        auto i_buffer = bufferManager->gpu(size * sizeof(T));
+        check_cuda_error(cudaGetLastError());
+        managed_buffers.emplace_back(std::move(i_buffer));
+        T* ptr = static_cast<T*>(managed_buffers.back()->data());
+        check_cuda_error(cudaMemsetAsync(ptr, 0x0, size * sizeof(T), streamPtr->get()));
+        return ptr;
+    }
+
+    template <class T>
+    T* copyToDevice(std::vector<T> const& values)
+    {
+        T* ptr = allocBuffer<T>(values.size());
+        check_cuda_error(
+            cudaMemcpyAsync(ptr, values.data(), values.size() * sizeof(T), cudaMemcpyHostToDevice, streamPtr->get()));
+        return ptr;
+    }
+
+    // Problem description, set from the benchmark arguments
+    AttentionKernel mKernel{};
+    KvCacheType mKvCacheType{};
+    int mBatchSize{};
+    int mSeqLen{};
+    int mNumHeads{};
+    int mNumKvHeads{};
+    int mHeadSize{};
+    int mTokensPerBlock{};
+    int mBeamWidth{};
+    bool mMultiBlock{};
+
+    int numSequences() const
+    {
+        return mBatchSize * mBeamWidth;
+    }
+
+    size_t kvElementSize() const
+    {
+        return mKvCacheType == KvCacheType::SAME ? sizeof(DataType) : 1;
+    }
+
+    Data_type kvCacheDataType() const
+    {
+        switch (mKvCacheType)
+        {
+        case KvCacheType::INT8: return DATA_TYPE_INT8;
+        case KvCacheType::FP8: return DATA_TYPE_E4M3;
+        default: return DATA_TYPE;
+        }
+    }
+
+    //! \brief Bytes the kernel has to move through DRAM at least, the basis of the reported bandwidth.
+    double bytesPerIteration() const
+    {
+        double const elem = sizeof(DataType);
+        double const qkvTokenBytes = (mNumHeads + 2.0 * mNumKvHeads) * mHeadSize * elem;
+        double const outTokenBytes = static_cast<double>(mNumHeads) * mHeadSize * elem;
+        double const kvTokenBytes = 2.0 * mNumKvHeads * mHeadSize * kvElementSize();
+        double const numTokens = static_cast<double>(mBatchSize) * mSeqLen;
+        switch (mKernel)
+        {
+        case AttentionKernel::MMHA:
+        case AttentionKernel::XQA:
+            // Every beam reads its own KV, the new token is read from the QKV and appended to the cache
+            return numSequences() * (mSeqLen * kvTokenBytes + qkvTokenBytes + outTokenBytes);
+        case AttentionKernel::FMHA: return numTokens * (qkvTokenBytes + outTokenBytes);
+        case AttentionKernel::PAGED_FMHA:
+            return numTokens * (static_cast<double>(mNumHeads) * mHeadSize * elem + kvTokenBytes + outTokenBytes);
+        default: TLLM_THROW("Unrecognised attention kernel");
+        }
+    }
+
+    // Synthetic paged KV cache. Every sequence owns its blocks, the K and V blocks of a sequence are interleaved in the
+    // pool in the order the block offsets table lists them.
+    KVBlockArray mKvBlockArray{};
+    int mMaxBlocksPerSeq{};
+    float* mKvScaleOrigQuant{};
+    float* mKvScaleQuantOrig{};
+
+    void initKvCache()
+    {
+        mMaxBlocksPerSeq = (mSeqLen + mTokensPerBlock - 1) / mTokensPerBlock;
+        auto const bytesPerToken = static_cast<int32_t>(mNumKvHeads * mHeadSize * kvElementSize());
+        auto const numBlocks = static_cast<size_t>(numSequences()) * mMaxBlocksPerSeq * 2;
+        auto* pool = allocBuffer<int8_t>(numBlocks * mTokensPerBlock * bytesPerToken);
+
+        std::vector<KVCacheIndex> offsets;
+        offsets.reserve(numBlocks);
+        for (size_t i = 0; i < numBlocks; i++)
+        {
+            offsets.emplace_back(static_cast<KVCacheIndex::UnderlyingType>(i));
+        }
+        mKvBlockArray = KVBlockArray(numSequences(), mMaxBlocksPerSeq, mTokensPerBlock, bytesPerToken, mSeqLen, 0,
+            pool, nullptr, copyToDevice(offsets));
+
+        mKvScaleOrigQuant = copyToDevice(std::vector<float>{1.f});
+        mKvScaleQuantOrig = copyToDevice(std::vector<float>{1.f});
+    }
+
+    // Generation phase buffers
+    DataType* mQkv{};
+    DataType* mOutput{};
+    int* mSequenceLengths{};
+    int* mContextLengths{};
+    int* mCacheIndirection{};
+    std::vector<int> mHostPastKvLengths;
+
+    void initGenerationBuffers()
+    {
+        auto const numSeqs = static_cast<size_t>(numSequences());
+        mQkv = allocBuffer<DataType>(numSeqs * (mNumHeads + 2 * mNumKvHeads) * mHeadSize);
+        mOutput = allocBuffer<DataType>(numSeqs * mNumHeads * mHeadSize);
+        // Every sequence attends to mSeqLen tokens, including the new one
+        mSequenceLengths = copyToDevice(std::vector<int>(numSeqs, mSeqLen));
+        mContextLengths = copyToDevice(std::vector<int>(numSeqs, 1));
+        mHostPastKvLengths.assign(mBatchSize, mSeqLen - 1);
+        // Each beam reads its own KV so that the beams do not hit in L2 for each other
+        std::vector<int> indirection(numSeqs * mSeqLen);
+        for (size_t seq = 0; seq < numSeqs; seq++)
+        {
+            std::fill_n(indirection.begin() + seq * mSeqLen, mSeqLen, static_cast<int>(seq % mBeamWidth));
+        }
+        mCacheIndirection = copyToDevice(indirection);
+    }
+
+    // MMHA
+    Masked_multihead_attention_params<MmhaType> mMmhaParams{};
+
+    std::optional<std::string> initMmha()
+    {
+        if (!mmha_supported(mHeadSize))
+        {
+            return "MMHA does not support the head size";
+        }
+        initGenerationBuffers();
+        auto const numSeqs = numSequences();
+        auto& params = mMmhaParams;
+        params = {};
+        params.out = reinterpret_cast<MmhaType*>(mOutput);
+        params.q = reinterpret_cast<MmhaType const*>(mQkv);
+        params.k = params.q + mNumHeads * mHeadSize;
+        params.v = params.k + mNumKvHeads * mHeadSize;
+        params.stride = (mNumHeads + 2 * mNumKvHeads) * mHeadSize;
+        params.batch_size = numSeqs;
+        params.beam_width = mBeamWidth;
+        params.max_attention_window_size = mSeqLen;
+        params.cyclic_attention_window_size = mSeqLen;
+        params.length_per_sample = mSequenceLengths;
+        params.input_lengths = mContextLengths;
+        params.timestep = mSeqLen - 1;
+        params.cache_indir = mBeamWidth > 1 ? mCacheIndirection : nullptr;
+        params.num_heads = mNumHeads;
+        params.num_kv_heads = mNumKvHeads;
+        params.hidden_size_per_head = mHeadSize;
+        params.inv_sqrt_dh = 1.f / std::sqrt(static_cast<float>(mHeadSize));
+        params.qk_tanh_inverse_scale = 1.f;
+        params.int8_kv_cache = mKvCacheType == KvCacheType::INT8;
+        params.fp8_kv_cache = mKvCacheType == KvCacheType::FP8;
+        params.kv_scale_orig_quant = mKvScaleOrigQuant;
+        params.kv_scale_quant_orig = mKvScaleQuantOrig;
+        params.multi_block_mode = mMultiBlock;
+        params.min_seq_len_tile = 1;
+        params.max_seq_len_tile = mMultiBlock ? MAX_SEQ_LEN_TILE : 1;
+        auto const numPartials = static_cast<size_t>(numSeqs) * mNumHeads * params.max_seq_len_tile;
+        params.partial_out = reinterpret_cast<MmhaType*>(allocBuffer<DataType>(numPartials * mHeadSize));
+        params.partial_sum = allocBuffer<float>(numPartials);
+        params.partial_max = allocBuffer<float>(numPartials);
+        params.block_counter = allocBuffer<int>(static_cast<size_t>(numSeqs) * mNumHeads);
+        params.multi_processor_count = getMultiProcessorCount();
+        return std::nullopt;
+    }
+
+    void runMmha()
+    {
+        // The kernels update the multi-block state of the params
+        auto launchParams = mMmhaParams;
+        masked_multihead_attention(launchParams, mKvBlockArray, KVLinearBuffer{}, streamPtr->get());
+    }
+
+    // XQA
+    std::unique_ptr<DecoderXQARunner> mXqaRunner;
+    XQAParams mXqaParams{};
+
+    std::optional<std::string> initXqa()
+    {
+        initGenerationBuffers();
+        auto const kvType = kvCacheDataType();
+        // Same restrictions as the GPT attention plugin
+        bool const multiBlock = mMultiBlock && kvType != DATA_TYPE_INT8
+            && (kvType != DATA_TYPE_E4M3 || getSMVersion() == 90);
+
+        auto& params = mXqaParams;
+        params = {};
+        params.data_type = DATA_TYPE;
+        params.kv_cache_data_type = kvType;
+        if (kvType == DATA_TYPE_INT8)
+        {
+            params.kv_cache_quant_mode = QuantMode::int8KvCache();
+        }
+        else if (kvType == DATA_TYPE_E4M3)
+        {
+            params.kv_cache_quant_mode = QuantMode::fp8KvCache();
+        }
+        params.output = mOutput;
+        params.qkv = mQkv;
+        params.cache_indir = mCacheIndirection;
+        params.kv_scale_orig_quant = mKvScaleOrigQuant;
+        params.kv_scale_quant_orig = mKvScaleQuantOrig;
+        params.host_past_key_value_lengths = mHostPastKvLengths.data();
+        params.sequence_lengths = mSequenceLengths;
+        params.context_lengths = mContextLengths;
+        params.batch_size = mBatchSize;
+        params.beam_width = mBeamWidth;
+        params.max_attention_window_size = mSeqLen;
+        params.cyclic_attention_window_size = mSeqLen;
+        params.timestep = mSeqLen - 1;
+        params.generation_input_length = 1;
+        params.total_num_input_tokens = numSequences();
+        params.num_q_heads = mNumHeads;
+        params.num_kv_heads = mNumKvHeads;
+        params.head_size = mHeadSize;
+        params.unidirectional = 1;
+        params.q_scaling = 1.0f;
+        params.rotary_embedding_dim = mHeadSize;
+        params.rotary_embedding_base = 10000.0f;
+        params.rotary_embedding_scale_type = RotaryScalingType::kNONE;
+        params.rotary_embedding_scale = 1.0f;
+        params.rotary_embedding_max_positions = mSeqLen;
+        params.position_embedding_type = PositionEmbeddingType::kROPE_GPT_NEOX;
+        params.mask_type = AttentionMaskType::CAUSAL;
+        params.paged_kv_cache = true;
+        params.tokens_per_block = mTokensPerBlock;
+        params.max_blocks_per_sequence = mMaxBlocksPerSeq;
+        params.cross_attention = false;
+        params.multi_block_mode = multiBlock;
+
+        mXqaRunner = std::make_unique<DecoderXQARunner>(DATA_TYPE, mNumHeads, mNumKvHeads, mHeadSize, multiBlock);
+        if (!mXqaRunner->shouldUse(params, /*forConfigurePlugin=*/false))
+        {
+            return "XQA does not support the config";
+        }
+        mXqaRunner->prepare(params);
+
+        auto const numSeqs = numSequences();
+        size_t const workspaces[] = {mXqaRunner->getWorkspaceSize(numSeqs), sizeof(int) * (numSeqs + 1),
+            sizeof(float) * numSeqs * mHeadSize / 2};
+        params.workspaces = allocBuffer<int8_t>(calculateTotalWorkspaceSize(workspaces, 3));
+        params.semaphores = allocBuffer<int32_t>(static_cast<size_t>(mNumHeads) * numSeqs);
+        return std::nullopt;
+    }
+
+    void runXqa()
+    {
+        mXqaRunner->dispatch(mXqaParams, mKvBlockArray, streamPtr->get());
+    }
+
+    // Context FMHA
+    std::unique_ptr<FusedMHARunnerV2> mFmhaRunner;
+    MHARunnerParams mFmhaParams{};
+
+    std::optional<std::string> initFmha()
+    {
+        if (mBeamWidth != 1)
+        {
+            return "The context phase has no beams";
+        }
+        bool const paged = mKernel == AttentionKernel::PAGED_FMHA;
+        if (!paged && mKvCacheType != KvCacheType::SAME)
+        {
+            return "The KV cache type only applies to the paged FMHA";
+        }
+
+        MHARunnerFixedParams fixedParams{};
+        fixedParams.dataType = DATA_TYPE;
+        fixedParams.forceFp32Acc = false;
+        fixedParams.attentionMaskType = ContextAttentionMaskType::CAUSAL;
+        fixedParams.attentionInputLayout = paged ? AttentionInputLayout::Q_PAGED_KV : AttentionInputLayout::PACKED_QKV;
+        fixedParams.isSPadded = false;
+        fixedParams.numQHeads = mNumHeads;
+        fixedParams.numKvHeads = mNumKvHeads;
+        fixedParams.headSize = mHeadSize;
+        fixedParams.qScaling = 1.0f;
+        fixedParams.qkTanhScale = 0.f;
+        fixedParams.hasAlibi = false;
+        fixedParams.scaleAlibi = false;
+        fixedParams.kvCacheDataType = paged ? kvCacheDataType() : DATA_TYPE;
+        mFmhaRunner = std::make_unique<FusedMHARunnerV2>(fixedParams);
+        if (!mFmhaRunner->isFmhaSupported())
+        {
+            return "Context FMHA does not support the config";
+        }
+
+        auto const numTokens = static_cast<size_t>(mBatchSize) * mSeqLen;
+        std::vector<int> cuSeqLens(mBatchSize + 1);
+        for (int i = 0; i <= mBatchSize; i++)
+        {
+            cuSeqLens[i] = i * mSeqLen;
+        }
+        auto* cuSeqLensPtr = copyToDevice(cuSeqLens);
+
+        auto& params = mFmhaParams;
+        params = {};
+        params.b = mBatchSize;
+        params.qSeqLen = mSeqLen;
+        params.kvSeqLen = mSeqLen;
+        params.slidingWindowSize = mSeqLen;
+        params.totalQSeqLen = static_cast<int>(numTokens);
+        params.totalKvSeqLen = static_cast<int>(numTokens);
+        if (paged)
+        {
+            params.qPtr = allocBuffer<DataType>(numTokens * mNumHeads * mHeadSize);
+            params.pagedKvCache = mKvBlockArray;
+        }
+        else
+        {
+            params.qkvPtr = allocBuffer<DataType>(numTokens * (mNumHeads + 2 * mNumKvHeads) * mHeadSize);
+        }
+        params.outputPtr = allocBuffer<DataType>(numTokens * mNumHeads * mHeadSize);
+        params.cuQSeqLenPtr = cuSeqLensPtr;
+        params.cuKvSeqLenPtr = cuSeqLensPtr;
+        params.tileCounterPtr = allocBuffer<uint32_t>(1);
+        params.kvScaleQuantOrigPtr = mKvScaleQuantOrig;
+        params.stream = streamPtr->get();
+        return std::nullopt;
+    }
+
+    void runFmha()
+    {
+        mFmhaRunner->run(mFmhaParams);
+    }
+
+    void runKernel()
+    {
+        switch (mKernel)
+        {
+        case AttentionKernel::MMHA: runMmha(); break;
+        case AttentionKernel::XQA: runXqa(); break;
+        case AttentionKernel::FMHA:
+        case AttentionKernel::PAGED_FMHA: runFmha(); break;
+        default: TLLM_THROW("Unrecognised attention kernel");
+        }
+    }
+
+    float benchmarkLoop()
+    {
+        {
+            NVTX3_SCOPED_RANGE(BenchmarkLoopIteration);
+            check_cuda_error(cudaEventRecord(mStartEvent, streamPtr->get()));
+            runKernel();
+            check_cuda_error(cudaEventRecord(mEndEvent, streamPtr->get()));
+            check_cuda_error(cudaStreamSynchronize(streamPtr->get()));
+        }
+
+        float ms;
+        check_cuda_error(cudaEventElapsedTime(&ms, mStartEvent, mEndEvent));
+        return ms;
+    }
+
+    void runBenchmark(benchmark::State& state);
+};
+
+template <class DataType_>
+void AttentionBenchmark<DataType_>::runBenchmark(benchmark::State& state)
+{
+    NVTX3_SCOPED_RANGE(FullBenchmark);
+    mKernel = static_cast<AttentionKernel>(state.range(0));
+    mKvCacheType = static_cast<KvCacheType>(state.range(1));
+    mBatchSize = state.range(2);
+    mSeqLen = state.range(3);
+    mNumHeads = state.range(4);
+    mNumKvHeads = state.range(5);
+    mHeadSize = state.range(6);
+    mTokensPerBlock = state.range(7);
+    mBeamWidth = state.range(8);
+    mMultiBlock = state.range(9);
+
+    state.counters["batch_size"] = mBatchSize;
+    state.counters["seq_len"] = mSeqLen;
+    state.counters["num_heads"] = mNumHeads;
+    state.counters["num_kv_heads"] = mNumKvHeads;
+    state.counters["head_size"] = mHeadSize;
+    state.counters["tokens_per_block"] = mTokensPerBlock;
+    state.counters["beam_width"] = mBeamWidth;
+    state.counters["multi_block"] = (int) mMultiBlock;
+
+    std::string label = std::string(toString(mKernel)) + ",kv=" + toString(mKvCacheType);
+    if (mKernel == AttentionKernel::XQA)
+    {
+        // The implementation is picked once per process, rerun with TRTLLM_ENABLE_XQA_JIT=0 for the precompiled one
+        label += getEnvEnableXQAJIT().value_or(true) ? ",jit" : ",precompiled";
+    }
+    state.SetLabel(label);
+
+    if (mNumKvHeads <= 0 || mNumHeads % mNumKvHeads != 0)
+    {
+        state.SkipWithMessage("num_heads must be a multiple of num_kv_heads");
+        return;
+    }
+    if (mKvCacheType == KvCacheType::FP8)
+    {
+#ifdef ENABLE_FP8
+        if (getSMVersion() < 89)
+        {
+            state.SkipWithMessage("GPU does not support FP8");
+            return;
+        }
+#else
+        state.SkipWithMessage("FP8 is not enabled in this build");
+        return;
+#endif
+    }
+
+    initKvCache();
+    std::optional<std::string> unsupported;
+    switch (mKernel)
+    {
+    case AttentionKernel::MMHA: unsupported = initMmha(); break;
+    case AttentionKernel::XQA: unsupported = initXqa(); break;
+    case AttentionKernel::FMHA:
+    case AttentionKernel::PAGED_FMHA: unsupported = initFmha(); break;
+    default: unsupported = "Unrecognised attention kernel";
+    }
+    if (unsupported)
+    {
+        state.SkipWithMessage(unsupported->c_str());
+        managed_buffers.clear();
+        return;
+    }
+    check_cuda_error(cudaStreamSynchronize(streamPtr->get()));
+
+    // Warm up, also compiles the XQA kernels on the first use
+    runKernel();
+    check_cuda_error(cudaStreamSynchronize(streamPtr->get()));
+
+    double totalSeconds = 0;
+    {
+        NVTX3_SCOPED_RANGE(BenchmarkRun);
+        for (auto _ : state)
+        {
+            float ms = benchmarkLoop();
+            state.SetIterationTime(ms / 1000.f);
+            totalSeconds += ms / 1000.0;
+        }
+    }
+
+    double const bytes = bytesPerIteration();
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    if (totalSeconds > 0)
+    {
+        double const bandwidth = bytes * state.iterations() / totalSeconds;
+        state.counters["hbm_GBps"] = bandwidth / 1e9;
+        state.counters["hbm_peak_pct"] = 100.0 * bandwidth / getPeakMemoryBandwidth();
+    }
+
+    // Cleanup all the benchmark state
+    managed_buffers.clear();
+    check_cuda_error(cudaDeviceSynchronize());
+}
@@ -0,0 +1,360 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Include the fixture with the actual benchmark code
+#include "attentionBenchmarkFixture.h"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+
+/*
+ * Below is all the setup for parameterising the benchmarks
+ */
+
+#define BENCHMARK_BASIC(dtype)                                                                                         \
+    BENCHMARK_TEMPLATE_DEFINE_F(AttentionBenchmark, Basic_##dtype, dtype)(benchmark::State & state)                    \
+    {                                                                                                                  \
+        runBenchmark(state);                                                                                           \
+    }
+
+#define BENCHMARK_BASIC_DO_REGISTER(dtype)                                                                             \
+    BENCHMARK_REGISTER_F(AttentionBenchmark, Basic_##dtype)->Apply(argGen<AttentionBenchmark<dtype>>)
+
+template <class Enum>
+Enum parseEnum(std::string const& name, std::map<std::string, Enum> const& names, char const* field)
+{
+    auto const it = names.find(name);
+    if (it == names.end())
+    {
+        throw std::invalid_argument("Invalid " + std::string(field) + " " + name);
+    }
+    return it->second;
+}
+
+// Accepts a single value or an array of values to sweep
+template <class T>
+std::vector<T> getSweep(nlohmann::json const& run_config, std::string const& name, std::vector<T> def)
+{
+    if (!run_config.contains(name))
+    {
+        return def;
+    }
+    auto const& entry = run_config.at(name);
+    if (entry.is_array())
+    {
+        return entry.get<std::vector<T>>();
+    }
+    return {entry.get<T>()};
+}
+
+template <class BenchClass>
+void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
+{
+    std::ifstream file{workloadFile};
+    if (!file)
+    {
+        throw std::invalid_argument("Could not open workload file " + std::string(workloadFile));
+    }
+    auto const json = nlohmann::json::parse(file);
+
+    static std::map<std::string, AttentionKernel> const kernel_names{{"mmha", AttentionKernel::MMHA},
+        {"xqa", AttentionKernel::XQA}, {"fmha", AttentionKernel::FMHA}, {"paged_fmha", AttentionKernel::PAGED_FMHA}};
+    static std::map<std::string, KvCacheType> const kv_cache_names{
+        {"same", KvCacheType::SAME}, {"int8", KvCacheType::INT8}, {"fp8", KvCacheType::FP8}};
+
+    for (auto const& run_config : json)
+    {
+        // Filter out the types we don't care about testing
+        if (run_config.contains("dtypes"))
+        {
+            std::vector<std::string> dtypes;
+            run_config["dtypes"].get_to(dtypes);
+
+            auto hasDtype = [&](char const* d)
+            { return std::any_of(dtypes.begin(), dtypes.end(), [&](auto const& n) { return n == d; }); };
+
+            if (std::is_same_v<typename BenchClass::DataType, half> && !hasDtype("float16") && !hasDtype("half"))
+            {
+                continue;
+            }
+            else if (!std::is_same_v<typename BenchClass::DataType, half> && !hasDtype("bfloat16")
+                && !hasDtype("bf16"))
+            {
+                continue;
+            }
+        }
+
+        std::vector<AttentionKernel> kernels;
+        for (auto const& name : getSweep<std::string>(run_config, "kernels", {"mmha", "xqa"}))
+        {
+            kernels.push_back(parseEnum(name, kernel_names, "kernel"));
+        }
+        std::vector<KvCacheType> kv_cache_types;
+        for (auto const& name : getSweep<std::string>(run_config, "kv_cache_dtype", {"same"}))
+        {
+            kv_cache_types.push_back(parseEnum(name, kv_cache_names, "kv_cache_dtype"));
+        }
+
+        auto check_positive = [](std::vector<int> values, char const* name)
+        {
+            if (std::any_of(values.begin(), values.end(), [](int v) { return v < 1; }))
+            {
+                throw std::invalid_argument(std::string(name) + " must be a positive integer");
+            }
+            return values;
+        };
+        auto const batch_sizes = check_positive(getSweep<int>(run_config, "batch_size", {}), "batch_size");
+        auto const seq_lens = check_positive(getSweep<int>(run_config, "seq_len", {}), "seq_len");
+        if (batch_sizes.empty() || seq_lens.empty())
+        {
+            throw std::invalid_argument("batch_size and seq_len are required");
+        }
+        auto const num_heads = check_positive(getSweep<int>(run_config, "num_heads", {32}), "num_heads");
+        auto const num_kv_heads = getSweep<int>(run_config, "num_kv_heads", {});
+        auto const head_sizes = check_positive(getSweep<int>(run_config, "head_size", {128}), "head_size");
+        auto const tokens_per_block
+            = check_positive(getSweep<int>(run_config, "tokens_per_block", {64}), "tokens_per_block");
+        auto const beam_widths = check_positive(getSweep<int>(run_config, "beam_width", {1}), "beam_width");
+        auto const multi_block = getSweep<int>(run_config, "multi_block", {1});
+
+        for (auto kernel : kernels)
+            for (auto kv_type : kv_cache_types)
+                for (auto batch : batch_sizes)
+                    for (auto seq : seq_lens)
+                        for (auto heads : num_heads)
+                            for (auto kv_heads : num_kv_heads.empty() ? std::vector<int>{heads} : num_kv_heads)
+                                for (auto head_size : head_sizes)
+                                    for (auto block : tokens_per_block)
+                                        for (auto beam : beam_widths)
+                                            for (auto mb : multi_block)
+                                                benchmark->Args({(int) kernel, (int) kv_type, batch, seq, heads,
+                                                    kv_heads, head_size, block, beam, mb});
+    }
+}
+
+template <class BenchClass>
+void argGenHardcoded(benchmark::internal::Benchmark* benchmark)
+{
+    auto kernels = {AttentionKernel::MMHA, AttentionKernel::XQA};
+    auto kv_cache_types = {KvCacheType::SAME, KvCacheType::INT8, KvCacheType::FP8};
+    auto batch_sizes = {1, 8, 64};
+    auto seq_lens = {1024, 8192};
+    auto head_configs = {std::pair{32, 8}, std::pair{32, 32}}; // {num_heads, num_kv_heads}
+    auto head_size = 128;
+    auto tokens_per_block = {64};                              // {16, 32, 64, 128};
+    auto multi_block = {0, 1};
+
+    for (auto kernel : kernels)
+        for (auto kv_type : kv_cache_types)
+            for (auto batch : batch_sizes)
+                for (auto seq : seq_lens)
+                    for (auto [heads, kv_heads] : head_configs)
+                        for (auto block : tokens_per_block)
+                            for (auto mb : multi_block)
+                                benchmark->Args({(int) kernel, (int) kv_type, batch, seq, heads, kv_heads,
+                                    head_size, block, 1, mb});
+
+    // Context phase, the tokens per block only matter for the paged FMHA
+    for (auto kernel : {AttentionKernel::FMHA, AttentionKernel::PAGED_FMHA})
+        for (auto batch : {1, 8})
+            for (auto seq : {1024, 4096})
+                for (auto [heads, kv_heads] : head_configs)
+                    benchmark->Args({(int) kernel, (int) KvCacheType::SAME, batch, seq, heads, kv_heads, head_size,
+                        64, 1, 0});
+}
+
+template <class BenchClass>
+void argGen(benchmark::internal::Benchmark* benchmark)
+{
+    // Generic setup
+    benchmark->UseManualTime();
+    benchmark->ArgNames({"Kernel", "KV Cache Type", "Batch Size", "Seq Len", "Num Heads", "Num KV Heads", "Head Size",
+        "Tokens Per Block", "Beam Width", "Multi Block"});
+
+    if (workloadFile)
+        argGenLoadFile<BenchClass>(benchmark);
+    else
+        argGenHardcoded<BenchClass>(benchmark);
+}
+
+BENCHMARK_BASIC(half)
+#ifdef ENABLE_BF16
+using bfloat16 = __nv_bfloat16;
+BENCHMARK_BASIC(bfloat16)
+#endif
+
+void delayedRegisterBenchmark()
+{
+    BENCHMARK_BASIC_DO_REGISTER(half);
+    if (workloadFile)
+    {
+        // Extra ones we don't want for hardcoded runs
+#ifdef ENABLE_BF16
+        BENCHMARK_BASIC_DO_REGISTER(bfloat16);
+#endif
+    }
+}
+
+void doCleanup()
+{
+    bufferManager.reset();
+    streamPtr.reset();
+}
+
+void help()
+{
+    std::cout << "Usage: attentionBenchmark [--input_file <file>] [benchmark options]\n";
+    std::cout
+        << "--input_file\t\tA JSON file describing the benchmark configurations\n\n"
+        << "File schema\n"
+           "[\n"
+           "  {\n"
+           "    \"kernels\": [string, ...], (optional)\n"
+           "    \"kv_cache_dtype\": [string, ...], (optional)\n"
+           "    \"batch_size\": [int, ...],\n"
+           "    \"seq_len\": [int, ...],\n"
+           "    \"num_heads\": [int, ...], (optional)\n"
+           "    \"num_kv_heads\": [int, ...], (optional)\n"
+           "    \"head_size\": [int, ...], (optional)\n"
+           "    \"tokens_per_block\": [int, ...], (optional)\n"
+           "    \"beam_width\": [int, ...], (optional)\n"
+           "    \"multi_block\": [int, ...], (optional)\n"
+           "    \"dtypes\": [string, ...], (optional)\n"
+           "  },\n"
+           "  ...\n"
+           "]\n"
+           "Every field takes a single value or an array of values to sweep. Explanation:\n"
+           "- \"kernels\" - The kernels to run. Defaults to [\"mmha\", \"xqa\"]. Allowed values are:\n"
+           "  - mmha: masked multi-head attention, the generation phase fallback\n"
+           "  - xqa: XQA generation kernels. Whether the JIT or the precompiled kernels run is decided once per "
+           "process,\n"
+           "    set TRTLLM_ENABLE_XQA_JIT=0 to run the precompiled kernels. The label names the implementation\n"
+           "  - fmha: context FMHA with packed QKV input\n"
+           "  - paged_fmha: context FMHA reading the KV from the paged KV cache\n"
+           "- \"kv_cache_dtype\" - The KV cache type, one of same (as the activations), int8 or fp8. Defaults to "
+           "same\n"
+           "- \"batch_size\" - The number of requests\n"
+           "- \"seq_len\" - The KV length of every request, including the new token in the generation phase. The "
+           "prompt length\n"
+           "in the context phase\n"
+           "- \"num_heads\" - The number of query heads. Defaults to 32\n"
+           "- \"num_kv_heads\" - The number of KV heads. Defaults to num_heads\n"
+           "- \"head_size\" - The head size. Defaults to 128\n"
+           "- \"tokens_per_block\" - The tokens per block of the paged KV cache. Defaults to 64\n"
+           "- \"beam_width\" - The beam width of the generation phase, every beam has its own KV. Defaults to 1\n"
+           "- \"multi_block\" - If the generation kernels may split the KV, 0 = off, 1 = on. Defaults to 1\n"
+           "- \"dtypes\" - A list of activation dtypes to run this config through.\n"
+           "Allowed values are: half, bfloat16\n"
+           "If this argument is omitted all dtypes will be run.\n"
+           "\n"
+           "Unsupported configs are skipped with a message. Besides the time every benchmark reports the bytes the "
+           "kernel has\n"
+           "to move at least per iteration as bytes_per_second, and the achieved DRAM bandwidth as hbm_GBps and "
+           "hbm_peak_pct\n"
+           "\n";
+
+    std::cout << "benchmark options:\n";
+    benchmark::PrintDefaultHelp();
+}
+
+void gbenchCustomHelp()
+{
+    help();
+    // google-benchmark calls exit() so we need to cleanup manually
+    doCleanup();
+}
+
+int parseArgsAndRunBench(int argc, char** argv)
+{
+    try
+    {
+        int shift = 0;
+        for (int i = 1; i < argc; i++)
+        {
+            argv[i - shift] = argv[i];
+            if (strcmp("--input_file", argv[i]) == 0)
+            {
+                i += 1;
+                if (i == argc)
+                {
+                    std::cerr << "Missing file name for input_file\n";
+                    return -1;
+                }
+                workloadFile = argv[i];
+                if (workloadFile[0] == '-')
+                {
+                    std::cerr << "Workload file " << workloadFile << " not a valid file name\n";
+                    return -2;
+                }
+                shift += 2;
+            }
+            else if (strcmp("--help", argv[i]) == 0 || strcmp("-h", argv[i]) == 0)
+            {
+                help();
+                return 0;
+            }
+        }
+        argc -= shift;
+
+        // Delay after we know if the user passed a config file
+        delayedRegisterBenchmark();
+
+        benchmark::Initialize(&argc, argv, &gbenchCustomHelp);
+
+        if (argc > 1)
+        {
+            help();
+            std::cout << std::flush; // Force flush
+            // Print the error second, so it's easy to see
+            std::cerr << "\nUnrecognised argument: " << argv[1] << std::endl;
+            return -4;
+        }
+
+        benchmark::RunSpecifiedBenchmarks();
+        benchmark::Shutdown();
+
+        return 0;
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "Exiting benchmarks with exception: " << e.what() << std::endl;
+        return -3;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    deviceCount = getDeviceCount();
+    if (deviceCount < 0)
+        return 0;
+    streamPtr = std::make_shared<CudaStream>();
+    bufferManager = std::make_unique<BufferManager>(streamPtr);
+
+    int res = -1;
+    try
+    {
+        res = parseArgsAndRunBench(argc, argv);
+    }
+    catch (std::exception const& e)
+    {
+        std::cout << "Benchmark exited with unhandled exception: " << e.what() << std::endl;
+    }
+
+    doCleanup();
+    return res;
+}
@@ -0,0 +1,592 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <nlohmann/json.hpp>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+#include "tensorrt_llm/kernels/beamSearchKernels.h"
+#include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/samplingTopKKernels.h"
+#include "tensorrt_llm/layers/beamSearchLayer.h"
+#include "tensorrt_llm/layers/decodingParams.h"
+#include "tensorrt_llm/layers/penaltyLayer.h"
+#include "tensorrt_llm/layers/stopCriteriaLayer.h"
+#include "tensorrt_llm/layers/topKSamplingLayer.h"
+#include "tensorrt_llm/layers/topPSamplingLayer.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/decodingLayerWorkspace.h"
+#include "tensorrt_llm/runtime/runtimeKernels.h"
+
+#include <curand_kernel.h>
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::layers;
+using namespace tensorrt_llm::runtime;
+
+namespace tle = tensorrt_llm::executor;
+
+static BufferManager::CudaStreamPtr streamPtr;
+static std::shared_ptr<BufferManager> bufferManager;
+static int deviceCount;
+static char* workloadFile = nullptr;
+
+enum class DecodingLayerType : int
+{
+    TOP_K = 0,
+    // Top-P with the AIR radix select kernels
+    AIR_TOP_P = 1,
+    // Top-P with the sort based kernels
+    TOP_P = 2,
+    PENALTY = 3,
+    BEAM_SEARCH = 4,
+    // Stop words and max length checks
+    STOP_CRITERIA = 5,
+    END
+};
+
+// Bits of the penalties argument
+enum PenaltyFlags : int
+{
+    kTemperature = 1 << 0,
+    kRepetitionPenalty = 1 << 1,
+    kPresencePenalty = 1 << 2,
+    kFrequencyPenalty = 1 << 3,
+    kMinLength = 1 << 4,
+};
+
+inline char const* toString(DecodingLayerType layer)
+{
+    switch (layer)
+    {
+    case DecodingLayerType::TOP_K: return "top_k";
+    case DecodingLayerType::AIR_TOP_P: return "air_top_p";
+    case DecodingLayerType::TOP_P: return "top_p";
+    case DecodingLayerType::PENALTY: return "penalty";
+    case DecodingLayerType::BEAM_SEARCH: return "beam_search";
+    case DecodingLayerType::STOP_CRITERIA: return "stop_criteria";
+    default: TLLM_THROW("Unrecognised decoding layer");
+    }
+}
+
+//! \brief Times one forwardAsync of a single decoding layer on a batch of random logits.
+//!
+//! Every sequence is a slot of the batch and has already generated seqLen tokens. The state the layers advance
+//! (logits, sequence lengths, finished states and beam hypotheses) is restored before each iteration, outside of
+//! the timed region, so that all iterations decode the same step.
+template <class T>
+class DecodingLayerBenchmark : public benchmark::Fixture
+{
+public:
+    using DataType = T;
+    using TensorPtr = ITensor::SharedPtr;
+
+    // Deprecated, just here to suppress warnings
+    void SetUp(benchmark::State const& s) override
+    {
+        abort();
+    }
+
+    void TearDown(benchmark::State const& s) override
+    {
+        abort();
+    }
+
+    cudaEvent_t mStartEvent, mEndEvent;
+
+    void SetUp(benchmark::State& s) override
+    {
+        assert(bufferManager);
+        // Makes sure nothing from a previous iteration hangs around
+        check_cuda_error(cudaDeviceSynchronize());
+        check_cuda_error(cudaEventCreate(&mStartEvent));
+        check_cuda_error(cudaEventCreate(&mEndEvent));
+    }
+
+    void TearDown(benchmark::State& s) override
+    {
+        freeBuffers();
+        check_cuda_error(cudaEventDestroy(mStartEvent));
+        check_cuda_error(cudaEventDestroy(mEndEvent));
+        check_cuda_error(cudaDeviceSynchronize());
+    }
+
+    // Problem description, set from the benchmark arguments
+    DecodingLayerType mLayerType{};
+    SizeType32 mBatchSize{};
+    SizeType32 mVocabSize{};
+    SizeType32 mBeamWidth{};
+    SizeType32 mSeqLen{};
+    SizeType32 mTopK{};
+    float mTopP{};
+    int mPenalties{};
+    SizeType32 mNumStopWords{};
+    SizeType32 mStopWordLen{};
+
+    // Room for the token generated by the benchmarked step
+    SizeType32 mMaxSeqLen{};
+
+    std::shared_ptr<BaseLayer> mLayer;
+    std::shared_ptr<DecodingLayerWorkspace> mWorkspace;
+    std::shared_ptr<DecodingInputs> mInputs;
+    std::shared_ptr<BaseDecodingOutputs> mOutputs;
+
+    // Logits every iteration starts from, and the logits read by the penalty layer
+    TensorPtr mPristineLogits;
+    TensorPtr mInputLogits;
+
+    TensorPtr mBatchSlots;
+    TensorPtr mEndIds;
+    TensorPtr mInputLengths;
+    TensorPtr mSequenceLengths;
+    TensorPtr mFinished;
+    TensorPtr mCumLogProbs;
+    TensorPtr mOutputIds;
+    TensorPtr mParentIds;
+    TensorPtr mOutputIdsPtrs;
+    TensorPtr mParentIdsPtrs;
+    TensorPtr mCurandStates;
+
+    TensorPtr mSrcCacheIndirection;
+    TensorPtr mTgtCacheIndirection;
+    std::vector<TensorPtr> mBeamHypothesesBuffers;
+    TensorPtr mNumBeamsCBA;
+    TensorPtr mBatchDones;
+
+    TensorPtr mSequenceLimitLength;
+    TensorPtr mStopWords;
+    TensorPtr mStopWordsPtrs;
+    TensorPtr mStopWordsLengths;
+
+    void freeBuffers()
+    {
+        mLayer.reset();
+        mWorkspace.reset();
+        mInputs.reset();
+        mOutputs.reset();
+        for (auto* tensor :
+            {&mPristineLogits, &mInputLogits, &mBatchSlots, &mEndIds, &mInputLengths, &mSequenceLengths, &mFinished,
+                &mCumLogProbs, &mOutputIds, &mParentIds, &mOutputIdsPtrs, &mParentIdsPtrs, &mCurandStates,
+                &mSrcCacheIndirection, &mTgtCacheIndirection, &mNumBeamsCBA, &mBatchDones, &mSequenceLimitLength,
+                &mStopWords, &mStopWordsPtrs, &mStopWordsLengths})
+        {
+            tensor->reset();
+        }
+        mBeamHypothesesBuffers.clear();
+    }
+
+    bool isSampling() const
+    {
+        return mLayerType == DecodingLayerType::TOP_K || mLayerType == DecodingLayerType::AIR_TOP_P
+            || mLayerType == DecodingLayerType::TOP_P;
+    }
+
+    tle::DecodingMode getDecodingMode() const
+    {
+        auto mode = mBeamWidth > 1 ? tle::DecodingMode::BeamSearch()
+                                   : (mLayerType == DecodingLayerType::TOP_K ? tle::DecodingMode::TopK()
+                                                                             : tle::DecodingMode::TopP());
+        return mode.useTemperature(mPenalties & kTemperature)
+            .useRepetitionPenalty(mPenalties & kRepetitionPenalty)
+            .usePresencePenalty(mPenalties & kPresencePenalty)
+            .useFrequencyPenalty(mPenalties & kFrequencyPenalty)
+            .useMinLength(mPenalties & kMinLength)
+            .useStopWords(mNumStopWords > 0);
+    }
+
+    //! \brief Returns why the configuration cannot be benchmarked, if it cannot.
+    std::optional<std::string> checkSupported() const
+    {
+        if (isSampling() && mBeamWidth != 1)
+        {
+            return "Sampling layers only support a beam width of 1";
+        }
+        if (mLayerType == DecodingLayerType::BEAM_SEARCH && mBeamWidth <= 1)
+        {
+            return "Beam search needs a beam width larger than 1";
+        }
+        auto const maxTopK = std::min(mVocabSize, tensorrt_llm::kernels::TOP_K_MAX);
+        if (mLayerType == DecodingLayerType::TOP_K && (mTopK <= 0 || mTopK > maxTopK))
+        {
+            return "top_k must be in [1, min(vocab_size, 1024)]";
+        }
+        if ((mLayerType == DecodingLayerType::AIR_TOP_P || mLayerType == DecodingLayerType::TOP_P)
+            && (mTopP <= 0.f || mTopP > 1.f))
+        {
+            return "top_p must be in (0, 1000]";
+        }
+        if (mLayerType == DecodingLayerType::PENALTY && mPenalties == 0)
+        {
+            return "The penalty layer needs at least one penalty";
+        }
+        return std::nullopt;
+    }
+
+    void initLayer()
+    {
+        DecoderDomain const domain(mBatchSize, mBeamWidth, mVocabSize, mVocabSize);
+        auto const mode = getDecodingMode();
+        switch (mLayerType)
+        {
+        case DecodingLayerType::TOP_K: mLayer = std::make_shared<TopKSamplingLayer<T>>(domain, bufferManager); break;
+        case DecodingLayerType::AIR_TOP_P:
+        case DecodingLayerType::TOP_P:
+            mLayer = std::make_shared<TopPSamplingLayer<T>>(
+                domain, bufferManager, /*isDeterministic*/ true, mLayerType == DecodingLayerType::AIR_TOP_P);
+            break;
+        case DecodingLayerType::PENALTY: mLayer = std::make_shared<PenaltyLayer<T>>(mode, domain, bufferManager); break;
+        case DecodingLayerType::BEAM_SEARCH:
+            mLayer = std::make_shared<BeamSearchLayer<T>>(domain, bufferManager);
+            break;
+        case DecodingLayerType::STOP_CRITERIA:
+            mLayer = std::make_shared<StopCriteriaLayer<T>>(mode, domain, bufferManager);
+            break;
+        default: TLLM_THROW("Unrecognised decoding layer");
+        }
+        mWorkspace = std::make_shared<DecodingLayerWorkspace>(
+            bufferManager, domain, TRTDataType<T>::value, mLayer->getWorkspaceSize());
+    }
+
+    void initBuffers()
+    {
+        std::mt19937 gen(0xD3C0);
+        std::uniform_int_distribution<TokenIdType> tokenDist(0, mVocabSize - 2);
+        auto const numSequences = mBatchSize * mBeamWidth;
+
+        std::vector<SizeType32> batchSlots(mBatchSize);
+        std::iota(batchSlots.begin(), batchSlots.end(), 0);
+        mBatchSlots = bufferManager->copyFrom(batchSlots, ITensor::makeShape({mBatchSize}), MemoryType::kPINNED);
+
+        // Keeps the last token out of the prompts so that EOS never finishes a sequence early
+        mEndIds = bufferManager->copyFrom(
+            std::vector<TokenIdType>(mBatchSize, mVocabSize - 1), ITensor::makeShape({mBatchSize}), MemoryType::kGPU);
+        mInputLengths = bufferManager->copyFrom(
+            std::vector<SizeType32>(numSequences, 1), ITensor::makeShape({mBatchSize, mBeamWidth}), MemoryType::kGPU);
+        mSequenceLengths = bufferManager->gpu(ITensor::makeShape({mBatchSize, mBeamWidth}), nvinfer1::DataType::kINT32);
+        mFinished = bufferManager->gpu(ITensor::makeShape({mBatchSize, mBeamWidth}),
+            TRTDataType<tensorrt_llm::kernels::FinishedState::UnderlyingType>::value);
+        mCumLogProbs = bufferManager->gpu(ITensor::makeShape({mBatchSize, mBeamWidth}), nvinfer1::DataType::kFLOAT);
+        bufferManager->setZero(*mCumLogProbs);
+
+        // Random history, the penalties and the stop words scan it
+        std::vector<TokenIdType> outputIds(numSequences * mMaxSeqLen);
+        std::generate(outputIds.begin(), outputIds.end(), [&]() { return tokenDist(gen); });
+        auto const idsShape = ITensor::makeShape({mBatchSize, mBeamWidth, mMaxSeqLen});
+        mOutputIds = bufferManager->copyFrom(outputIds, idsShape, MemoryType::kGPU);
+        mParentIds = bufferManager->gpu(idsShape, nvinfer1::DataType::kINT32);
+        bufferManager->setZero(*mParentIds);
+
+        mOutputIdsPtrs = BufferManager::pinned(ITensor::makeShape({mBatchSize}), nvinfer1::DataType::kINT64);
+        mParentIdsPtrs = BufferManager::pinned(ITensor::makeShape({mBatchSize}), nvinfer1::DataType::kINT64);
+        auto** outputIdsPtrs = reinterpret_cast<TokenIdType**>(bufferCast<int64_t>(*mOutputIdsPtrs));
+        auto** parentIdsPtrs = reinterpret_cast<TokenIdType**>(bufferCast<int64_t>(*mParentIdsPtrs));
+        for (SizeType32 bi = 0; bi < mBatchSize; ++bi)
+        {
+            outputIdsPtrs[bi] = bufferCast<TokenIdType>(*mOutputIds) + bi * mBeamWidth * mMaxSeqLen;
+            parentIdsPtrs[bi] = bufferCast<TokenIdType>(*mParentIds) + bi * mBeamWidth * mMaxSeqLen;
+        }
+
+        std::normal_distribution<float> logitDist(0.f, 4.f);
+        std::vector<T> logits(static_cast<size_t>(numSequences) * mVocabSize);
+        std::generate(logits.begin(), logits.end(), [&]() { return static_cast<T>(logitDist(gen)); });
+        auto const logitsShape = ITensor::makeShape({mBatchSize, mBeamWidth, mVocabSize});
+        mPristineLogits = bufferManager->copyFrom(logits, logitsShape, MemoryType::kGPU);
+        mInputLogits = bufferManager->gpu(logitsShape, TRTDataType<T>::value);
+
+        mWorkspace->setDeviceBatchSlots(mBatchSlots);
+        mWorkspace->getDeviceRuntimeLogits()->reshape(
+            isSampling() ? ITensor::makeShape({mBatchSize, mVocabSize}) : logitsShape);
+    }
+
+    void initBeamSearchBuffers()
+    {
+        auto const idsShape = ITensor::makeShape({mBatchSize, mBeamWidth, mMaxSeqLen});
+        mSrcCacheIndirection = bufferManager->gpu(idsShape, nvinfer1::DataType::kINT32);
+        mTgtCacheIndirection = bufferManager->gpu(idsShape, nvinfer1::DataType::kINT32);
+        bufferManager->setZero(*mSrcCacheIndirection);
+        bufferManager->setZero(*mTgtCacheIndirection);
+
+        auto const alloc = [this](ITensor::Shape shape, nvinfer1::DataType type)
+        {
+            auto tensor = bufferManager->gpu(shape, type);
+            bufferManager->setZero(*tensor);
+            mBeamHypothesesBuffers.push_back(tensor);
+            return tensor;
+        };
+        auto const cbaIdsShape = ITensor::makeShape({mBatchSize, 2 * mBeamWidth, mMaxSeqLen});
+        auto const cbaShape = ITensor::makeShape({mBatchSize, 2 * mBeamWidth});
+        auto const batchShape = ITensor::makeShape({mBatchSize});
+
+        auto bh = std::make_unique<tensorrt_llm::kernels::BeamHypotheses>();
+        bh->outputIdsCBA = bufferCast<SizeType32>(*alloc(cbaIdsShape, nvinfer1::DataType::kINT32));
+        bh->logProbsCBA = bufferCast<float>(*alloc(cbaIdsShape, nvinfer1::DataType::kFLOAT));
+        bh->sequenceLengthsCBA = bufferCast<SizeType32>(*alloc(cbaShape, nvinfer1::DataType::kINT32));
+        bh->cumLogProbsCBA = bufferCast<float>(*alloc(cbaShape, nvinfer1::DataType::kFLOAT));
+        bh->normedScoresCBA = bufferCast<float>(*alloc(cbaShape, nvinfer1::DataType::kFLOAT));
+        bh->minNormedScoresCBA = bufferCast<float>(*alloc(batchShape, nvinfer1::DataType::kFLOAT));
+        mNumBeamsCBA = alloc(batchShape, nvinfer1::DataType::kINT32);
+        mBatchDones = alloc(batchShape, nvinfer1::DataType::kBOOL);
+        bh->numBeamsCBA = bufferCast<SizeType32>(*mNumBeamsCBA);
+        bh->batchDones = bufferCast<bool>(*mBatchDones);
+
+        auto outputs = std::make_shared<BeamSearchOutputs>(mOutputIds);
+        outputs->tgtCacheIndirection = mTgtCacheIndirection;
+        outputs->beamHypotheses = std::move(bh);
+        mOutputs = outputs;
+        mInputs->srcCacheIndirection = mSrcCacheIndirection;
+    }
+
+    void initStopCriteriaBuffers()
+    {
+        auto& stopInputs = mInputs->stopCriteriaInputs;
+        stopInputs = std::make_shared<StopCriteriaDecodingInputs>(mBatchSize);
+        mSequenceLimitLength = bufferManager->copyFrom(
+            std::vector<SizeType32>(mBatchSize, mMaxSeqLen), ITensor::makeShape({mBatchSize}), MemoryType::kGPU);
+        stopInputs->sequenceLimitLength = mSequenceLimitLength;
+        if (mNumStopWords == 0)
+        {
+            return;
+        }
+
+        // Same layout as the executor: [batch, 2, maxLen], the tokens then the end offsets of the words padded with -1
+        auto const maxLen = mNumStopWords * mStopWordLen;
+        std::mt19937 gen(0x570B);
+        std::uniform_int_distribution<TokenIdType> tokenDist(0, mVocabSize - 2);
+        mStopWords = BufferManager::pinned(ITensor::makeShape({mBatchSize, 2, maxLen}), nvinfer1::DataType::kINT32);
+        mStopWordsPtrs = BufferManager::pinned(ITensor::makeShape({mBatchSize}), nvinfer1::DataType::kINT64);
+        mStopWordsLengths = BufferManager::pinned(ITensor::makeShape({mBatchSize}), nvinfer1::DataType::kINT32);
+        auto* stopWords = bufferCast<TokenIdType>(*mStopWords);
+        auto** stopWordsPtrs = reinterpret_cast<TokenIdType**>(bufferCast<int64_t>(*mStopWordsPtrs));
+        auto* stopWordsLengths = bufferCast<SizeType32>(*mStopWordsLengths);
+        std::fill(stopWords, stopWords + mBatchSize * 2 * maxLen, -1);
+        for (SizeType32 bi = 0; bi < mBatchSize; ++bi)
+        {
+            auto* tokens = stopWords + bi * 2 * maxLen;
+            std::generate(tokens, tokens + maxLen, [&]() { return tokenDist(gen); });
+            for (SizeType32 wi = 0; wi < mNumStopWords; ++wi)
+            {
+                tokens[maxLen + wi] = (wi + 1) * mStopWordLen;
+            }
+            stopWordsPtrs[bi] = tokens;
+            stopWordsLengths[bi] = maxLen;
+        }
+        stopInputs->maxStopWordsLen = maxLen;
+        stopInputs->stopWordsPtr = mStopWordsPtrs;
+        stopInputs->stopWordsLengths = mStopWordsLengths;
+    }
+
+    std::shared_ptr<BaseSetupParams> makeSetupParams() const
+    {
+        switch (mLayerType)
+        {
+        case DecodingLayerType::TOP_K:
+        case DecodingLayerType::AIR_TOP_P:
+        case DecodingLayerType::TOP_P:
+        {
+            auto params = std::make_shared<SamplingSetupParams>();
+            params->randomSeed = std::vector<uint64_t>{0};
+            params->runtimeTopK = std::vector<SizeType32>{mLayerType == DecodingLayerType::TOP_K ? mTopK : 0};
+            params->runtimeTopP = std::vector<float>{mLayerType == DecodingLayerType::TOP_K ? 1.f : mTopP};
+            return params;
+        }
+        case DecodingLayerType::PENALTY:
+        {
+            auto params = std::make_shared<PenaltySetupParams>();
+            params->temperature = std::vector<float>{0.7f};
+            params->repetitionPenalty = std::vector<float>{1.2f};
+            params->presencePenalty = std::vector<float>{0.5f};
+            params->frequencyPenalty = std::vector<float>{0.5f};
+            // Longer than the sequences so that the EOS logit gets masked
+            params->minLength = std::vector<SizeType32>{mMaxSeqLen + 1};
+            return params;
+        }
+        case DecodingLayerType::BEAM_SEARCH:
+        {
+            auto params = std::make_shared<BeamSearchSetupParams>();
+            params->beamSearchDiversityRate = std::vector<float>{0.f};
+            params->lengthPenalty = std::vector<float>{1.f};
+            params->earlyStopping = std::vector<int>{1};
+            return params;
+        }
+        default: return std::make_shared<BaseSetupParams>();
+        }
+    }
+
+    void initInputsOutputs()
+    {
+        if (isSampling())
+        {
+            auto inputs = std::make_shared<SamplingInputs>(mEndIds, mBatchSlots, 0, 0, mBatchSize);
+            mCurandStates = bufferManager->gpu(
+                ITensor::makeShape({mBatchSize, sizeof(curandState_t)}), nvinfer1::DataType::kINT8);
+            inputs->curandStates = reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*mCurandStates));
+            mInputs = inputs;
+        }
+        else
+        {
+            mInputs = std::make_shared<DecodingInputs>(mEndIds, mBatchSlots, 0, 0, mBatchSize, mMaxSeqLen, 0);
+        }
+        // The penalty layer writes the runtime logits the other layers read
+        mInputs->logits
+            = mLayerType == DecodingLayerType::PENALTY ? mInputLogits : mWorkspace->getDeviceRuntimeLogits();
+        mInputs->inputLengths = mInputLengths;
+        mInputs->finished = mFinished;
+
+        if (mLayerType == DecodingLayerType::BEAM_SEARCH)
+        {
+            initBeamSearchBuffers();
+        }
+        else
+        {
+            mOutputs = std::make_shared<BaseDecodingOutputs>(mOutputIds);
+        }
+        if (mLayerType == DecodingLayerType::STOP_CRITERIA)
+        {
+            initStopCriteriaBuffers();
+        }
+        mOutputs->outputIdsPtr = mOutputIdsPtrs;
+        mOutputs->parentIdsPtr = mParentIdsPtrs;
+        mOutputs->finished = mFinished;
+        mOutputs->sequenceLength = mSequenceLengths;
+        mOutputs->cumLogProbs = mCumLogProbs;
+        mOutputs->parentIds = mParentIds;
+    }
+
+    void initLayerState()
+    {
+        mLayer->setup(mBatchSize, mBeamWidth, mBatchSlots, makeSetupParams(), mWorkspace);
+        mWorkspace->resize(mLayer->getWorkspaceSize());
+        if (isSampling())
+        {
+            mWorkspace->initializeDeviceCurandStates(
+                std::vector<uint64_t>{0}, mBatchSize, mWorkspace->getDeviceBatchSlots(), mCurandStates);
+        }
+    }
+
+    //! \brief Restores the state the previous iteration advanced.
+    void resetState()
+    {
+        auto const& stream = *streamPtr;
+        auto const logitsBytes = mPristineLogits->getSizeInBytes();
+        check_cuda_error(cudaMemcpyAsync(mWorkspace->getDeviceRuntimeLogits()->data(), mPristineLogits->data(),
+            logitsBytes, cudaMemcpyDeviceToDevice, stream.get()));
+        if (mLayerType == DecodingLayerType::PENALTY)
+        {
+            bufferManager->copy(*mPristineLogits, *mInputLogits);
+        }
+        tensorrt_llm::runtime::kernels::invokeFill(*mSequenceLengths, mSeqLen, stream);
+        bufferManager->setZero(*mFinished);
+        if (mNumBeamsCBA)
+        {
+            bufferManager->setZero(*mNumBeamsCBA);
+            bufferManager->setZero(*mBatchDones);
+        }
+    }
+
+    float benchmarkLoop()
+    {
+        resetState();
+        {
+            NVTX3_SCOPED_RANGE(BenchmarkLoopIteration);
+            check_cuda_error(cudaEventRecord(mStartEvent, streamPtr->get()));
+            mLayer->forwardAsync(mOutputs, mInputs, mWorkspace);
+            check_cuda_error(cudaEventRecord(mEndEvent, streamPtr->get()));
+            check_cuda_error(cudaStreamSynchronize(streamPtr->get()));
+        }
+
+        float ms;
+        check_cuda_error(cudaEventElapsedTime(&ms, mStartEvent, mEndEvent));
+        return ms;
+    }
+
+    void runBenchmark(benchmark::State& state);
+};
+
+template <class T>
+void DecodingLayerBenchmark<T>::runBenchmark(benchmark::State& state)
+{
+    NVTX3_SCOPED_RANGE(FullBenchmark);
+    mLayerType = static_cast<DecodingLayerType>(state.range(0));
+    mBatchSize = state.range(1);
+    mVocabSize = state.range(2);
+    mBeamWidth = state.range(3);
+    mSeqLen = state.range(4);
+    mTopK = state.range(5);
+    mTopP = state.range(6) / 1000.f;
+    mPenalties = state.range(7);
+    mNumStopWords = state.range(8);
+    mStopWordLen = state.range(9);
+    mMaxSeqLen = mSeqLen + 1;
+
+    state.counters["batch_size"] = mBatchSize;
+    state.counters["vocab_size"] = mVocabSize;
+    state.counters["beam_width"] = mBeamWidth;
+    state.counters["seq_len"] = mSeqLen;
+    state.counters["top_k"] = mTopK;
+    state.counters["top_p"] = mTopP;
+    state.counters["penalties"] = mPenalties;
+    state.counters["stop_words"] = mNumStopWords;
+    state.counters["stop_word_len"] = mStopWordLen;
+    state.SetLabel(toString(mLayerType));
+
+    if (auto const unsupported = checkSupported())
+    {
+        state.SkipWithMessage(unsupported->c_str());
+        return;
+    }
+
+    initLayer();
+    initBuffers();
+    initInputsOutputs();
+    initLayerState();
+    check_cuda_error(cudaStreamSynchronize(streamPtr->get()));
+
+    // Warm up
+    benchmarkLoop();
+
+    {
+        NVTX3_SCOPED_RANGE(BenchmarkRun);
+        for (auto _ : state)
+        {
+            float ms = benchmarkLoop();
+            state.SetIterationTime(ms / 1000.f);
+        }
+    }
+
+    // One token per sequence, and the logits of every sequence are read at least once
+    state.SetItemsProcessed(state.iterations() * mBatchSize * mBeamWidth);
+    if (mLayerType != DecodingLayerType::STOP_CRITERIA)
+    {
+        state.SetBytesProcessed(state.iterations() * mPristineLogits->getSizeInBytes());
+    }
+
+    // Cleanup all the benchmark state
+    freeBuffers();
+    check_cuda_error(cudaDeviceSynchronize());
+}
@@ -0,0 +1,369 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Include the fixture with the actual benchmark code
+#include "decodingLayerBenchmarkFixture.h"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+
+/*
+ * Below is all the setup for parameterising the benchmarks
+ */
+
+#define BENCHMARK_BASIC(dtype)                                                                                         \
+    BENCHMARK_TEMPLATE_DEFINE_F(DecodingLayerBenchmark, Basic_##dtype, dtype)(benchmark::State & state)                \
+    {                                                                                                                  \
+        runBenchmark(state);                                                                                           \
+    }
+
+#define BENCHMARK_BASIC_DO_REGISTER(dtype)                                                                             \
+    BENCHMARK_REGISTER_F(DecodingLayerBenchmark, Basic_##dtype)->Apply(argGen<DecodingLayerBenchmark<dtype>>)
+
+// Accepts a single value or an array of values to sweep
+template <class T>
+std::vector<T> getSweep(nlohmann::json const& run_config, std::string const& name, std::vector<T> def)
+{
+    if (!run_config.contains(name))
+    {
+        return def;
+    }
+    auto const& entry = run_config.at(name);
+    if (entry.is_array())
+    {
+        return entry.get<std::vector<T>>();
+    }
+    return {entry.get<T>()};
+}
+
+template <class BenchClass>
+void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
+{
+    std::ifstream file{workloadFile};
+    if (!file)
+    {
+        throw std::invalid_argument("Could not open workload file " + std::string(workloadFile));
+    }
+    auto const json = nlohmann::json::parse(file);
+
+    static std::map<std::string, DecodingLayerType> const layer_names{{"top_k", DecodingLayerType::TOP_K},
+        {"air_top_p", DecodingLayerType::AIR_TOP_P}, {"top_p", DecodingLayerType::TOP_P},
+        {"penalty", DecodingLayerType::PENALTY}, {"beam_search", DecodingLayerType::BEAM_SEARCH},
+        {"stop_criteria", DecodingLayerType::STOP_CRITERIA}};
+    static std::map<std::string, int> const penalty_names{{"temperature", kTemperature},
+        {"repetition", kRepetitionPenalty}, {"presence", kPresencePenalty}, {"frequency", kFrequencyPenalty},
+        {"min_length", kMinLength}};
+
+    for (auto const& run_config : json)
+    {
+        // Filter out the types we don't care about testing
+        if (run_config.contains("dtypes"))
+        {
+            std::vector<std::string> dtypes;
+            run_config["dtypes"].get_to(dtypes);
+
+            auto hasDtype = [&](char const* d)
+            { return std::any_of(dtypes.begin(), dtypes.end(), [&](auto const& n) { return n == d; }); };
+
+            if (std::is_same_v<typename BenchClass::DataType, float> && !hasDtype("float32") && !hasDtype("float"))
+            {
+                continue;
+            }
+            else if (std::is_same_v<typename BenchClass::DataType, half> && !hasDtype("float16") && !hasDtype("half"))
+            {
+                continue;
+            }
+        }
+
+        std::vector<DecodingLayerType> layers;
+        for (auto const& name : getSweep<std::string>(run_config, "layers", {"top_k", "air_top_p"}))
+        {
+            auto const it = layer_names.find(name);
+            if (it == layer_names.end())
+            {
+                throw std::invalid_argument("Invalid layer " + name);
+            }
+            layers.push_back(it->second);
+        }
+
+        // Every entry of "penalties" is a list of penalties applied together
+        std::vector<int> penalty_sets;
+        if (run_config.contains("penalties"))
+        {
+            for (auto const& names : run_config.at("penalties"))
+            {
+                int flags = 0;
+                for (auto const& name : names.get<std::vector<std::string>>())
+                {
+                    auto const it = penalty_names.find(name);
+                    if (it == penalty_names.end())
+                    {
+                        throw std::invalid_argument("Invalid penalty " + name);
+                    }
+                    flags |= it->second;
+                }
+                penalty_sets.push_back(flags);
+            }
+        }
+        else
+        {
+            penalty_sets.push_back(kTemperature | kRepetitionPenalty | kPresencePenalty | kFrequencyPenalty);
+        }
+
+        auto check_positive = [](std::vector<int> values, char const* name)
+        {
+            if (std::any_of(values.begin(), values.end(), [](int v) { return v < 1; }))
+            {
+                throw std::invalid_argument(std::string(name) + " must be a positive integer");
+            }
+            return values;
+        };
+        auto const batch_sizes = check_positive(getSweep<int>(run_config, "batch_size", {}), "batch_size");
+        if (batch_sizes.empty())
+        {
+            throw std::invalid_argument("batch_size is required");
+        }
+        auto const vocab_sizes = check_positive(getSweep<int>(run_config, "vocab_size", {32000}), "vocab_size");
+        auto const beam_widths = check_positive(getSweep<int>(run_config, "beam_width", {1}), "beam_width");
+        auto const seq_lens = check_positive(getSweep<int>(run_config, "seq_len", {128}), "seq_len");
+        auto const top_ks = getSweep<int>(run_config, "top_k", {50});
+        auto const top_ps = getSweep<float>(run_config, "top_p", {0.9f});
+        auto const num_stop_words = getSweep<int>(run_config, "num_stop_words", {0});
+        auto const stop_word_lens = check_positive(getSweep<int>(run_config, "stop_word_len", {2}), "stop_word_len");
+
+        for (auto layer : layers)
+            for (auto batch : batch_sizes)
+                for (auto vocab : vocab_sizes)
+                    for (auto beam : beam_widths)
+                        for (auto seq : seq_lens)
+                            for (auto top_k : top_ks)
+                                for (auto top_p : top_ps)
+                                    for (auto penalties : penalty_sets)
+                                        for (auto stop_words : num_stop_words)
+                                            for (auto stop_word_len : stop_word_lens)
+                                                benchmark->Args({(int) layer, batch, vocab, beam, seq, top_k,
+                                                    (int) std::lround(top_p * 1000), penalties, stop_words,
+                                                    stop_word_len});
+    }
+}
+
+template <class BenchClass>
+void argGenHardcoded(benchmark::internal::Benchmark* benchmark)
+{
+    auto batch_sizes = {1, 16, 64, 256};
+    auto vocab_sizes = {32000, 128256};
+    auto seq_len = 512;
+    auto all_penalties = kTemperature | kRepetitionPenalty | kPresencePenalty | kFrequencyPenalty | kMinLength;
+
+    for (auto batch : batch_sizes)
+        for (auto vocab : vocab_sizes)
+        {
+            for (auto top_k : {1, 50, 1024})
+                benchmark->Args({(int) DecodingLayerType::TOP_K, batch, vocab, 1, seq_len, top_k, 1000, 0, 0, 1});
+            for (auto layer : {DecodingLayerType::AIR_TOP_P, DecodingLayerType::TOP_P})
+                for (auto top_p : {500, 900, 990})
+                    benchmark->Args({(int) layer, batch, vocab, 1, seq_len, 0, top_p, 0, 0, 1});
+            for (auto penalties : {(int) kTemperature, all_penalties})
+                benchmark->Args({(int) DecodingLayerType::PENALTY, batch, vocab, 1, seq_len, 0, 1000, penalties, 0, 1});
+            for (auto beam : {2, 4, 8})
+                benchmark->Args({(int) DecodingLayerType::BEAM_SEARCH, batch, vocab, beam, seq_len, 0, 1000, 0, 0, 1});
+            for (auto stop_words : {0, 4, 16})
+                benchmark->Args(
+                    {(int) DecodingLayerType::STOP_CRITERIA, batch, vocab, 1, seq_len, 0, 1000, 0, stop_words, 4});
+        }
+}
+
+template <class BenchClass>
+void argGen(benchmark::internal::Benchmark* benchmark)
+{
+    // Generic setup
+    benchmark->UseManualTime();
+    benchmark->ArgNames({"Layer", "Batch Size", "Vocab Size", "Beam Width", "Seq Len", "Top K", "Top P (per mille)",
+        "Penalties", "Stop Words", "Stop Word Len"});
+
+    if (workloadFile)
+        argGenLoadFile<BenchClass>(benchmark);
+    else
+        argGenHardcoded<BenchClass>(benchmark);
+}
+
+BENCHMARK_BASIC(float)
+BENCHMARK_BASIC(half)
+
+void delayedRegisterBenchmark()
+{
+    BENCHMARK_BASIC_DO_REGISTER(half);
+    if (workloadFile)
+    {
+        // Extra ones we don't want for hardcoded runs
+        BENCHMARK_BASIC_DO_REGISTER(float);
+    }
+}
+
+void doCleanup()
+{
+    bufferManager.reset();
+    streamPtr.reset();
+}
+
+void help()
+{
+    std::cout << "Usage: decodingLayerBenchmark [--input_file <file>] [benchmark options]\n";
+    std::cout
+        << "--input_file\t\tA JSON file describing the benchmark configurations\n\n"
+        << "File schema\n"
+           "[\n"
+           "  {\n"
+           "    \"layers\": [string, ...], (optional)\n"
+           "    \"batch_size\": [int, ...],\n"
+           "    \"vocab_size\": [int, ...], (optional)\n"
+           "    \"beam_width\": [int, ...], (optional)\n"
+           "    \"seq_len\": [int, ...], (optional)\n"
+           "    \"top_k\": [int, ...], (optional)\n"
+           "    \"top_p\": [float, ...], (optional)\n"
+           "    \"penalties\": [[string, ...], ...], (optional)\n"
+           "    \"num_stop_words\": [int, ...], (optional)\n"
+           "    \"stop_word_len\": [int, ...], (optional)\n"
+           "    \"dtypes\": [string, ...], (optional)\n"
+           "  },\n"
+           "  ...\n"
+           "]\n"
+           "Every field but penalties takes a single value or an array of values to sweep. Explanation:\n"
+           "- \"layers\" - The decoding layers to run. Defaults to [\"top_k\", \"air_top_p\"]. Allowed values are:\n"
+           "  - top_k: TopKSamplingLayer\n"
+           "  - air_top_p: TopPSamplingLayer with the AIR radix select kernels\n"
+           "  - top_p: TopPSamplingLayer with the sort based kernels\n"
+           "  - penalty: PenaltyLayer\n"
+           "  - beam_search: BeamSearchLayer, needs a beam width larger than 1\n"
+           "  - stop_criteria: StopCriteriaLayer, the stop words and max length checks\n"
+           "- \"batch_size\" - The number of requests\n"
+           "- \"vocab_size\" - The vocabulary size. Defaults to 32000\n"
+           "- \"beam_width\" - The beam width. The sampling layers only support 1. Defaults to 1\n"
+           "- \"seq_len\" - The number of tokens every request already generated, scanned by the penalties and the "
+           "stop words.\n"
+           "Defaults to 128\n"
+           "- \"top_k\" - The top K of the top_k layer, at most 1024. Defaults to 50\n"
+           "- \"top_p\" - The top P of the top_p layers. Defaults to 0.9\n"
+           "- \"penalties\" - The sets of penalties of the penalty layer, every set is benchmarked on its own. "
+           "Allowed values are:\n"
+           "  temperature, repetition, presence, frequency, min_length. Defaults to [[\"temperature\", "
+           "\"repetition\",\n"
+           "  \"presence\", \"frequency\"]]\n"
+           "- \"num_stop_words\" - The number of stop words of every request. Defaults to 0\n"
+           "- \"stop_word_len\" - The number of tokens of every stop word. Defaults to 2\n"
+           "- \"dtypes\" - A list of logits dtypes to run this config through.\n"
+           "Allowed values are: float, half\n"
+           "If this argument is omitted all dtypes will be run.\n"
+           "\n"
+           "Unsupported configs are skipped with a message. Every iteration decodes the same step, the state the "
+           "layer advances\n"
+           "is restored outside of the timed region. Besides the time every benchmark reports the tokens generated "
+           "per second as\n"
+           "items_per_second, and the logits read per second as bytes_per_second\n"
+           "\n";
+
+    std::cout << "benchmark options:\n";
+    benchmark::PrintDefaultHelp();
+}
+
+void gbenchCustomHelp()
+{
+    help();
+    // google-benchmark calls exit() so we need to cleanup manually
+    doCleanup();
+}
+
+int parseArgsAndRunBench(int argc, char** argv)
+{
+    try
+    {
+        int shift = 0;
+        for (int i = 1; i < argc; i++)
+        {
+            argv[i - shift] = argv[i];
+            if (strcmp("--input_file", argv[i]) == 0)
+            {
+                i += 1;
+                if (i == argc)
+                {
+                    std::cerr << "Missing file name for input_file\n";
+                    return -1;
+                }
+                workloadFile = argv[i];
+                if (workloadFile[0] == '-')
+                {
+                    std::cerr << "Workload file " << workloadFile << " not a valid file name\n";
+                    return -2;
+                }
+                shift += 2;
+            }
+            else if (strcmp("--help", argv[i]) == 0 || strcmp("-h", argv[i]) == 0)
+            {
+                help();
+                return 0;
+            }
+        }
+        argc -= shift;
+
+        // Delay after we know if the user passed a config file
+        delayedRegisterBenchmark();
+
+        benchmark::Initialize(&argc, argv, &gbenchCustomHelp);
+
+        if (argc > 1)
+        {
+            help();
+            std::cout << std::flush; // Force flush
+            // Print the error second, so it's easy to see
+            std::cerr << "\nUnrecognised argument: " << argv[1] << std::endl;
+            return -4;
+        }
+
+        benchmark::RunSpecifiedBenchmarks();
+        benchmark::Shutdown();
+
+        return 0;
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "Exiting benchmarks with exception: " << e.what() << std::endl;
+        return -3;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    deviceCount = getDeviceCount();
+    if (deviceCount < 0)
+        return 0;
+    streamPtr = std::make_shared<CudaStream>();
+    bufferManager = std::make_shared<BufferManager>(streamPtr);
+
+    int res = -1;
+    try
+    {
+        res = parseArgsAndRunBench(argc, argv);
+    }
+    catch (std::exception const& e)
+    {
+        std::cout << "Benchmark exited with unhandled exception: " << e.what() << std::endl;
+    }
+
+    doCleanup();
+    return res;
+}
@@ -0,0 +1,366 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host side cost of the KV cache manager. Nothing here launches kernels, besides the copies between the primary and
+// the secondary pool, so the benchmarks measure CPU time.
+
+#include <benchmark/benchmark.h>
+
+#include "tensorrt_llm/batch_manager/kvCacheManager.h"
+#include "tensorrt_llm/batch_manager/llmRequest.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/samplingConfig.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace tensorrt_llm::batch_manager;
+using namespace tensorrt_llm::batch_manager::kv_cache_manager;
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+std::atomic<int64_t> gNumAllocations{0};
+} // namespace
+
+// Counts the heap allocations of the benchmarked operations
+void* operator new(std::size_t size)
+{
+    gNumAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto* ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept
+{
+    std::free(ptr);
+}
+
+static BufferManager::CudaStreamPtr streamPtr;
+
+namespace
+{
+
+// Small blocks, the pools are only touched when blocks move between the primary and the secondary pool
+SizeType32 constexpr kNumLayers = 1;
+SizeType32 constexpr kNumKvHeads = 1;
+SizeType32 constexpr kSizePerHead = 32;
+SizeType32 constexpr kTokensPerBlock = 64;
+
+struct Workload
+{
+    SizeType32 batchSize;
+    SizeType32 inputLength;
+    SizeType32 outputLength;
+    SizeType32 beamWidth;
+    // Percentage of the prompt shared by all requests, 0 disables block reuse
+    SizeType32 reusePercent;
+    // Offload the evicted reusable blocks to a secondary pool as large as the primary one
+    bool secondaryPool;
+    // Sliding window, 0 attends to the whole sequence
+    SizeType32 attentionWindow;
+
+    explicit Workload(benchmark::State const& state)
+        : batchSize(state.range(0))
+        , inputLength(state.range(1))
+        , outputLength(state.range(2))
+        , beamWidth(state.range(3))
+        , reusePercent(state.range(4))
+        , secondaryPool(state.range(5) != 0)
+        , attentionWindow(state.range(6))
+    {
+    }
+
+    [[nodiscard]] SizeType32 getMaxSeqLen() const
+    {
+        return inputLength + outputLength;
+    }
+
+    [[nodiscard]] SizeType32 getMaxAttentionWindow() const
+    {
+        return attentionWindow > 0 ? std::min(attentionWindow, getMaxSeqLen()) : getMaxSeqLen();
+    }
+};
+
+std::optional<std::string> checkSupported(Workload const& workload)
+{
+    if (workload.reusePercent > 0 && workload.getMaxAttentionWindow() < workload.getMaxSeqLen())
+    {
+        return "Block reuse is not supported with a sliding window";
+    }
+    if (workload.secondaryPool && workload.reusePercent == 0)
+    {
+        return "The secondary pool only holds reusable blocks";
+    }
+    if (workload.getMaxAttentionWindow() < workload.inputLength)
+    {
+        return "The attention window must hold the prompt";
+    }
+    return std::nullopt;
+}
+
+std::unique_ptr<KVCacheManager> createKvCacheManager(Workload const& workload)
+{
+    auto const maxAttentionWindow = workload.getMaxAttentionWindow();
+    // One more block for the partially filled block of every beam
+    auto const blocksPerBeam = tensorrt_llm::common::ceilDiv(maxAttentionWindow, kTokensPerBlock) + 1;
+    auto const blocksInPrimaryPool = workload.batchSize * workload.beamWidth * blocksPerBeam;
+    auto const blocksInSecondaryPool = workload.secondaryPool ? blocksInPrimaryPool : 0;
+
+    auto manager = std::make_unique<KVCacheManager>(kNumLayers, kNumKvHeads, kSizePerHead, kTokensPerBlock,
+        blocksInPrimaryPool, blocksInSecondaryPool, workload.batchSize, workload.beamWidth, maxAttentionWindow,
+        /*sinkTokenLength*/ 0, /*useOneMoreBlock*/ false, streamPtr, workload.reusePercent > 0);
+    manager->allocatePools(nvinfer1::DataType::kHALF);
+    return manager;
+}
+
+//! \brief Creates one request per batch slot. The shared prefix is the same for all the requests of the process,
+//! the rest of the prompt is unique to every request so that it is never reused.
+std::vector<std::shared_ptr<LlmRequest>> createRequests(Workload const& workload, LlmRequest::RequestIdType& nextId)
+{
+    auto const sharedLength = workload.inputLength * workload.reusePercent / 100;
+    std::vector<std::shared_ptr<LlmRequest>> requests;
+    requests.reserve(workload.batchSize);
+    for (SizeType32 i = 0; i < workload.batchSize; ++i)
+    {
+        auto const requestId = nextId++;
+        auto tokens = std::make_shared<LlmRequest::VecTokens>(workload.inputLength);
+        for (SizeType32 t = 0; t < workload.inputLength; ++t)
+        {
+            (*tokens)[t] = t < sharedLength ? t : static_cast<TokenIdType>(requestId * workload.inputLength + t);
+        }
+        requests.push_back(std::make_shared<LlmRequest>(
+            requestId, workload.outputLength, std::move(tokens), SamplingConfig{workload.beamWidth}, false));
+    }
+    return requests;
+}
+
+void addSequences(KVCacheManager& manager, Workload const& workload,
+    std::vector<std::shared_ptr<LlmRequest>> const& requests)
+{
+    for (SizeType32 slot = 0; slot < workload.batchSize; ++slot)
+    {
+        manager.addSequence(slot, workload.inputLength, workload.beamWidth, requests[slot]);
+    }
+}
+
+void removeSequences(KVCacheManager& manager, Workload const& workload,
+    std::vector<std::shared_ptr<LlmRequest>> const& requests)
+{
+    for (SizeType32 slot = 0; slot < workload.batchSize; ++slot)
+    {
+        manager.removeSequence(slot, requests[slot]);
+    }
+}
+
+void setCounters(benchmark::State& state, int64_t numOps, int64_t numAllocations)
+{
+    state.counters["ops_per_second"] = benchmark::Counter(static_cast<double>(numOps), benchmark::Counter::kIsRate);
+    state.counters["allocs_per_op"] = numOps > 0 ? static_cast<double>(numAllocations) / numOps : 0.0;
+}
+
+//! \brief The context phase of a batch: addSequence, storeContextBlocks and removeSequence of every request, which
+//! releases its blocks. One op is one request.
+void BM_ContextPhase(benchmark::State& state)
+{
+    Workload const workload(state);
+    if (auto const unsupported = checkSupported(workload))
+    {
+        state.SkipWithMessage(unsupported->c_str());
+        return;
+    }
+    auto manager = createKvCacheManager(workload);
+    LlmRequest::RequestIdType nextId = 0;
+
+    // Outside of the loop so that the requests are destroyed while the timing is paused
+    std::vector<std::shared_ptr<LlmRequest>> requests;
+    int64_t numAllocations = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        requests = createRequests(workload, nextId);
+        auto const allocationsBefore = gNumAllocations.load(std::memory_order_relaxed);
+        state.ResumeTiming();
+
+        addSequences(*manager, workload, requests);
+        if (manager->isEnableBlockReuse())
+        {
+            for (SizeType32 slot = 0; slot < workload.batchSize; ++slot)
+            {
+                manager->storeContextBlocks(slot, requests[slot]);
+            }
+        }
+        removeSequences(*manager, workload, requests);
+
+        state.PauseTiming();
+        numAllocations += gNumAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+        state.ResumeTiming();
+    }
+
+    setCounters(state, state.iterations() * workload.batchSize, numAllocations);
+    auto const numAllocTotalBlocks = manager->getNumAllocTotalBlocks();
+    state.counters["reused_blocks_pct"]
+        = numAllocTotalBlocks > 0 ? 100.0 * manager->getNumReusedBlocks() / numAllocTotalBlocks : 0.0;
+}
+
+//! \brief Generation steps of a full batch, addToken on every request. One op is one addToken. The batch is replaced
+//! with new requests once they reach their output length.
+void BM_GenerationStep(benchmark::State& state)
+{
+    Workload const workload(state);
+    if (auto const unsupported = checkSupported(workload))
+    {
+        state.SkipWithMessage(unsupported->c_str());
+        return;
+    }
+    auto manager = createKvCacheManager(workload);
+    LlmRequest::RequestIdType nextId = 0;
+    auto requests = createRequests(workload, nextId);
+    addSequences(*manager, workload, requests);
+    SizeType32 step = 0;
+
+    int64_t numAllocations = 0;
+    for (auto _ : state)
+    {
+        if (step == workload.outputLength)
+        {
+            state.PauseTiming();
+            removeSequences(*manager, workload, requests);
+            requests = createRequests(workload, nextId);
+            addSequences(*manager, workload, requests);
+            step = 0;
+            state.ResumeTiming();
+        }
+
+        auto const allocationsBefore = gNumAllocations.load(std::memory_order_relaxed);
+        for (SizeType32 slot = 0; slot < workload.batchSize; ++slot)
+        {
+            manager->addToken(slot);
+        }
+        numAllocations += gNumAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+        ++step;
+    }
+
+    setCounters(state, state.iterations() * workload.batchSize, numAllocations);
+}
+
+//! \brief Packing the block offsets of a full batch into the host tensor copied to the engine every step. One op is
+//! one beam.
+void BM_BlockOffsets(benchmark::State& state)
+{
+    Workload const workload(state);
+    if (auto const unsupported = checkSupported(workload))
+    {
+        state.SkipWithMessage(unsupported->c_str());
+        return;
+    }
+    auto manager = createKvCacheManager(workload);
+    LlmRequest::RequestIdType nextId = 0;
+    auto const requests = createRequests(workload, nextId);
+    addSequences(*manager, workload, requests);
+
+    // Same shape as the kv_cache_block_offsets of the engine
+    auto const offsets = BufferManager::cpu(
+        ITensor::makeShape({workload.batchSize * workload.beamWidth, 2, manager->getMaxBlocksPerSeq()}),
+        nvinfer1::DataType::kINT32);
+
+    int64_t numAllocations = 0;
+    for (auto _ : state)
+    {
+        auto const allocationsBefore = gNumAllocations.load(std::memory_order_relaxed);
+        manager->getBlockOffsetsOfBatch(*offsets, 0, workload.batchSize, workload.beamWidth);
+        numAllocations += gNumAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+        benchmark::DoNotOptimize(offsets->data());
+    }
+
+    setCounters(state, state.iterations() * workload.batchSize * workload.beamWidth, numAllocations);
+}
+
+void workloadArgs(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"Batch Size", "Input Len", "Output Len", "Beam Width", "Reuse Pct", "Secondary Pool",
+        "Attention Window"});
+
+    for (auto batch : {8, 64, 256})
+        for (auto [input, output] : {std::pair{128, 128}, std::pair{2048, 256}, std::pair{8192, 512}})
+        {
+            // No reuse, with beams, with a sliding window
+            benchmark->Args({batch, input, output, 1, 0, 0, 0});
+            benchmark->Args({batch, input, output, 4, 0, 0, 0});
+            benchmark->Args({batch, input, output, 1, 0, 0, input + output / 2});
+            // Reuse of a shared system prompt, with and without offloading to the secondary pool
+            for (auto reuse : {50, 90})
+                for (auto secondary : {0, 1})
+                    benchmark->Args({batch, input, output, 1, reuse, secondary, 0});
+        }
+}
+
+} // namespace
+
+BENCHMARK(BM_ContextPhase)->Apply(workloadArgs);
+BENCHMARK(BM_GenerationStep)->Apply(workloadArgs);
+BENCHMARK(BM_BlockOffsets)->Apply(workloadArgs);
+
+int main(int argc, char** argv)
+{
+    if (tensorrt_llm::common::getDeviceCount() <= 0)
+    {
+        std::cerr << "kvCacheManagerBenchmark needs a GPU for the KV cache pools\n";
+        return 0;
+    }
+    streamPtr = std::make_shared<CudaStream>();
+
+    int res = 0;
+    try
+    {
+        benchmark::Initialize(&argc, argv);
+        if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        {
+            res = 1;
+        }
+        else
+        {
+            benchmark::RunSpecifiedBenchmarks();
+        }
+        benchmark::Shutdown();
+    }
+    catch (std::exception const& e)
+    {
+        std::cerr << "Benchmark exited with unhandled exception: " << e.what() << std::endl;
+        res = -3;
+    }
+
+    streamPtr.reset();
+    return res;
+}
@@ -20,6 +20,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include "mixtureOfExpertsBackendBenchmarkMpi.h"
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/common/nvtxUtils.h"
@@ -29,7 +30,9 @@
 #include "tensorrt_llm/runtime/cudaStream.h"
 
 #include <algorithm>
+#include <array>
 #include <cuda.h>
+#include <fstream>
 #include <memory>
 #include <numeric>
 #include <random>
@@ -254,6 +257,69 @@ struct VectoredRoutingConfig : public RoutingConfig
     }
 };
 
+/**
+ * Replays the experts selected in a routing trace, a JSON array with the experts of every recorded token in the order
+ * they were selected. Each run takes the next tokens of the trace and in multi-GPU runs every rank takes its own.
+ */
+struct TraceRoutingConfig : public RoutingConfig
+{
+    std::vector<std::vector<int>> trace;
+    int64_t num_experts;
+    std::string name;
+    int64_t next_token = 0;
+
+    TraceRoutingConfig(std::vector<std::vector<int>> trace, int64_t num_experts, std::string name = "trace")
+        : trace(std::move(trace))
+        , num_experts(num_experts)
+        , name(std::move(name))
+    {
+        TLLM_CHECK_WITH_INFO(!this->trace.empty(), "Routing trace %s has no tokens", this->name.c_str());
+        for (auto const& experts : this->trace)
+        {
+            TLLM_CHECK_WITH_INFO(std::all_of(experts.begin(), experts.end(),
+                                     [num_experts](int expert) { return expert >= 0 && expert < num_experts; }),
+                "Routing trace %s selects an expert out of range of the %ld experts", this->name.c_str(), num_experts);
+        }
+    }
+
+    std::string getName() override
+    {
+        return name;
+    }
+
+    bool isDeterministic() const override
+    {
+        return false;
+    }
+
+    void setRouting(float* routing_output, int64_t num_experts, int64_t k, int64_t num_tokens) override
+    {
+        TLLM_CHECK(num_experts == this->num_experts);
+        std::vector<float> input(num_experts * num_tokens, 0);
+        int64_t const first_token = next_token + moe_benchmark::getWorldRank() * num_tokens;
+        for (int64_t token = 0; token < num_tokens; token++)
+        {
+            auto const& experts = trace[(first_token + token) % trace.size()];
+            TLLM_CHECK_WITH_INFO(static_cast<int64_t>(experts.size()) >= k,
+                "Routing trace %s has tokens with fewer than k experts", name.c_str());
+            // Decreasing logits keep the order of the selection
+            for (int64_t choice = 0; choice < k; choice++)
+            {
+                input[token * num_experts + experts[choice]] = static_cast<float>(k - choice);
+            }
+        }
+        next_token = (next_token + num_tokens * moe_benchmark::getWorldSize()) % trace.size();
+        check_cuda_error(cudaMemcpyAsync(
+            routing_output, input.data(), input.size() * sizeof(float), cudaMemcpyHostToDevice, streamPtr->get()));
+        check_cuda_error(cudaStreamSynchronize(streamPtr->get()));
+    }
+
+    bool supportsConfig(int64_t num_experts, int64_t, int64_t) const override
+    {
+        return num_experts == this->num_experts;
+    }
+};
+
 }; // namespace
 
 constexpr int LOAD_BALANCED_ROUTING_CONFIG = 0;
@@ -366,6 +432,10 @@ public:
 
     cudaEvent_t mStartEvent, mEndEvent;
 
+    // Per phase times of the runs, reported per iteration
+    MoePhaseEvents mPhaseEvents{};
+    std::array<double, MoePhaseEvents::kEnd> mPhaseTimes{};
+
     void SetUp(benchmark::State& s) override
     {
         assert(bufferManager);
@@ -378,14 +448,26 @@ public:
         check_cuda_error(cudaDeviceSynchronize());
         check_cuda_error(cudaEventCreate(&mStartEvent));
         check_cuda_error(cudaEventCreate(&mEndEvent));
+        for (auto& event : mPhaseEvents.events)
+        {
+            check_cuda_error(cudaEventCreate(&event));
+        }
+        mPhaseTimes.fill(0);
+        mMoERunner.phase_events_ = &mPhaseEvents;
     }
 
     void TearDown(benchmark::State& s) override
     {
         managed_buffers.clear();
 
+        mMoERunner.phase_events_ = nullptr;
+        mMoERunner.all_to_all_comm_.reset();
         check_cuda_error(cudaEventDestroy(mStartEvent));
         check_cuda_error(cudaEventDestroy(mEndEvent));
+        for (auto& event : mPhaseEvents.events)
+        {
+            check_cuda_error(cudaEventDestroy(event));
+        }
         check_cuda_error(cudaDeviceSynchronize());
     }
 
@@ -453,11 +535,13 @@ public:
         mGatedMultiplier = mIsGated ? 2 : 1;
         auto const gated_inter = mInterSize * mGatedMultiplier;
 
-        size_t workspace_size = mMoERunner.getWorkspaceSize(
-            mTotalTokens, mHiddenSize, mInterSize, mNumExperts, mK, mActType, mNormMode, {}, mUseLora);
+        size_t workspace_size = mMoERunner.getWorkspaceSize(mTotalTokens, mHiddenSize, mInterSize, mNumExperts, mK,
+            mActType, mNormMode, parallelism_config, mUseLora);
 
         mWorkspace = allocBuffer<char>(workspace_size);
-        size_t const expert_matrix_size = mNumExperts * mHiddenSize * mInterSize;
+        // Each rank only holds the weights of its experts
+        int64_t const num_experts_per_node = mNumExperts / parallelism_config.ep_size;
+        size_t const expert_matrix_size = num_experts_per_node * mHiddenSize * mInterSize;
 
         mExpertWeight1
             = allocBuffer<WeightStorage>(expert_matrix_size * mGatedMultiplier / WEIGHT_ELEM_PER_BYTE - 8192);
@@ -467,22 +551,22 @@ public:
         mExpertBias2 = nullptr;
         if (mUseBias)
         {
-            mExpertBias1 = allocBuffer<DataType>(mNumExperts * gated_inter);
-            mExpertBias2 = allocBuffer<DataType>(mNumExperts * mHiddenSize);
+            mExpertBias1 = allocBuffer<DataType>(num_experts_per_node * gated_inter);
+            mExpertBias2 = allocBuffer<DataType>(num_experts_per_node * mHiddenSize);
         }
 
         if constexpr (INT_QUANT)
         {
-            mExpertIntScale1 = allocBuffer<DataType>(mNumExperts * gated_inter);
-            mExpertIntScale2 = allocBuffer<DataType>(mNumExperts * mHiddenSize);
+            mExpertIntScale1 = allocBuffer<DataType>(num_experts_per_node * gated_inter);
+            mExpertIntScale2 = allocBuffer<DataType>(num_experts_per_node * mHiddenSize);
 
             mQuantParams = QuantParams::Int(mExpertIntScale1, mExpertIntScale2);
         }
         else if constexpr (FP8)
         {
-            mExpertFP8Scale1 = allocBuffer<float>(mNumExperts);
+            mExpertFP8Scale1 = allocBuffer<float>(num_experts_per_node);
             mExpertFP8Scale2 = allocBuffer<float>(1);
-            mExpertFP8Scale3 = allocBuffer<float>(mNumExperts);
+            mExpertFP8Scale3 = allocBuffer<float>(num_experts_per_node);
 
             mQuantParams = QuantParams::FP8(mExpertFP8Scale1, mExpertFP8Scale2, mExpertFP8Scale3);
         }
@@ -518,6 +602,14 @@ public:
             check_cuda_error(cudaStreamSynchronize(streamPtr->get()));
         }
 
+        for (int phase = 0; phase < MoePhaseEvents::kEnd; phase++)
+        {
+            float phase_ms;
+            check_cuda_error(
+                cudaEventElapsedTime(&phase_ms, mPhaseEvents.events[phase], mPhaseEvents.events[phase + 1]));
+            mPhaseTimes[phase] += phase_ms;
+        }
+
         float ms;
         check_cuda_error(cudaEventElapsedTime(&ms, mStartEvent, mEndEvent));
         return ms;
@@ -665,6 +757,7 @@ void MixtureOfExpertsBenchmark<TypeTuple_>::runBenchmark(benchmark::State& state
     int tactic_idx1 = state.range(11);
     int tactic_idx2 = state.range(12);
     int const routing_config = state.range(13);
+    bool const use_all_to_all = state.range(14);
 
     state.counters["num_experts"] = num_experts;
     state.counters["top_k"] = top_k;
@@ -678,12 +771,13 @@ void MixtureOfExpertsBenchmark<TypeTuple_>::runBenchmark(benchmark::State& state
     state.counters["act_fn"] = (int) mActType;
     state.counters["norm_mode"] = (int) mNormMode;
     state.counters["routing_config"] = (int) routing_config;
+    state.counters["all_to_all"] = (int) use_all_to_all;
     state.counters["dtype"] = (int) toDTypeID();
 
     std::stringstream ss;
-    ss << "Experts,K,Hidden,Inter,TP,EP,Rank,Tokens,Bias,Actfn,Norm Mode,Tactic,Routing=";
+    ss << "Experts,K,Hidden,Inter,TP,EP,Rank,Tokens,Bias,Actfn,Norm Mode,Tactic,All To All,Routing=";
     for (auto v : {num_experts, top_k, hidden_size, inter_size, tp_size, ep_size, world_rank, num_tokens,
-             (int) mUseBias, (int) mActType, (int) mNormMode, tactic_idx1, tactic_idx2})
+             (int) mUseBias, (int) mActType, (int) mNormMode, tactic_idx1, tactic_idx2, (int) use_all_to_all})
     {
         ss << v << ",";
     }
@@ -691,8 +785,28 @@ void MixtureOfExpertsBenchmark<TypeTuple_>::runBenchmark(benchmark::State& state
     // state.SetLabel(ss.str());
     state.SetLabel(routingConfigCache.at(routing_config)->getName());
 
-    // Always use EP size for moe config until we support TP+EP, we just divide the inter size for TP
-    MOEParallelismConfig parallelism_config{tp_size, world_rank / ep_size, ep_size, world_rank % ep_size};
+    // Multi-GPU runs need every rank of the layout, a single GPU simulates the rank it is given
+    int const world_size = moe_benchmark::getWorldSize();
+    if (world_size > 1 && tp_size * ep_size != world_size)
+    {
+        state.SkipWithMessage("TP * EP does not match the number of MPI ranks");
+        return;
+    }
+    if (use_all_to_all && world_size != tp_size * ep_size)
+    {
+        state.SkipWithMessage("The all-to-all needs one MPI rank per GPU of the layout");
+        return;
+    }
+
+    // TP ranks run their slice of the inter size, the TP all-reduce of the output is not part of the benchmark
+    MOEParallelismConfig parallelism_config{
+        tp_size, world_rank / ep_size, ep_size, world_rank % ep_size, use_all_to_all};
+    if (use_all_to_all)
+    {
+        // Collective over all the ranks
+        mMoERunner.all_to_all_comm_ = moe_benchmark::createAllToAllCommunicator(parallelism_config);
+        mUseBias = false;
+    }
     initBuffersPermute(num_tokens, hidden_size, inter_size, num_experts, top_k, routing_config, parallelism_config);
 
     // Parse the tactic, does checks for "auto" mode and out of range
@@ -715,6 +829,7 @@ void MixtureOfExpertsBenchmark<TypeTuple_>::runBenchmark(benchmark::State& state
 
     {
         NVTX3_SCOPED_RANGE(BenchmarkRun);
+        moe_benchmark::barrier();
         for (auto _ : state)
         {
             float ms = benchmarkLoop(parallelism_config);
@@ -724,6 +839,15 @@ void MixtureOfExpertsBenchmark<TypeTuple_>::runBenchmark(benchmark::State& state
 
     state.SetItemsProcessed(state.iterations() * num_tokens);
 
+    std::vector<double> phase_times(mPhaseTimes.begin(), mPhaseTimes.end());
+    moe_benchmark::maxOverRanks(phase_times);
+    static std::array<char const*, MoePhaseEvents::kEnd> const phase_names{
+        "gating_ms", "permute_ms", "dispatch_ms", "gemm1_ms", "gemm2_ms", "combine_ms"};
+    for (int phase = 0; phase < MoePhaseEvents::kEnd; phase++)
+    {
+        state.counters[phase_names[phase]] = benchmark::Counter(phase_times[phase], benchmark::Counter::kAvgIterations);
+    }
+
     // Cleanup all the benchmark state
     managed_buffers.clear();
     check_cuda_error(cudaDeviceSynchronize());
@@ -287,6 +287,23 @@ std::optional<int> loadRoutingValues(nlohmann::json entry, int64_t num_experts,
     return routing_config;
 }
 
+int loadRoutingTrace(nlohmann::json entry, int64_t num_experts, std::string config_name)
+{
+    if (!entry.is_string())
+    {
+        throw std::invalid_argument("routing_trace must be the path of a routing trace file");
+    }
+    std::ifstream file{entry.get<std::string>()};
+    if (!file)
+    {
+        throw std::invalid_argument("Could not open routing trace " + entry.get<std::string>());
+    }
+    std::vector<std::vector<int>> trace;
+    nlohmann::json::parse(file).get_to(trace);
+    routingConfigCache.push_back(std::make_shared<TraceRoutingConfig>(std::move(trace), num_experts, config_name));
+    return routingConfigCache.size() - 1;
+}
+
 // This is suboptimal for large benchmark files as we reread it for every data type
 template <class BenchClass>
 void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
@@ -315,7 +332,8 @@ void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
         if (run_config.contains("routing_values_name"))
         {
             run_config["routing_values_name"].get_to(config_name);
-            if (!run_config.contains("routing_values") && !run_config.contains("routing_distribution"))
+            if (!run_config.contains("routing_values") && !run_config.contains("routing_distribution")
+                && !run_config.contains("routing_trace"))
             {
                 throw std::invalid_argument("Setting routing value configuration name but missing routing values");
             }
@@ -350,6 +368,10 @@ void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
                 routing_config = loadRoutingValues<RandomDistributionRoutingConfig>(
                     run_config["routing_distribution"], num_experts, config_name);
             }
+            else if (run_config.contains("routing_trace"))
+            {
+                routing_config = loadRoutingTrace(run_config["routing_trace"], num_experts, config_name);
+            }
         }
         // Use the selected config or fall back to balanced
         routing_config = routing_config.value_or(LOAD_BALANCED_ROUTING_CONFIG);
@@ -434,7 +456,16 @@ void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
         int ep_size = get_or("ep_size", 1);
         int world_rank = get_or("world_rank", 0);
         int bias = get_or("bias", 0);
-        TLLM_CHECK_WITH_INFO(world_rank < tp_size * ep_size, "Rank is out of bounds of tp*ep");
+        int all_to_all = get_or("all_to_all", 0);
+        if (moe_benchmark::getWorldSize() > 1)
+        {
+            // Every rank runs its part of the layout, configs for other rank counts are skipped by the benchmark
+            world_rank = moe_benchmark::getWorldRank();
+        }
+        else
+        {
+            TLLM_CHECK_WITH_INFO(world_rank < tp_size * ep_size, "Rank is out of bounds of tp*ep");
+        }
 
         auto get_range = [&](std::string name, int min = 1, int max = INT32_MAX)
         {
@@ -465,7 +496,8 @@ void argGenLoadFile(benchmark::internal::Benchmark* benchmark)
                     get_range("norm_mode", 0, (int) MOEExpertScaleNormalizationMode::RENORMALIZE), //
                     t1,                                                                            //
                     t2,                                                                            //
-                    *routing_config});
+                    *routing_config,                                                               //
+                    all_to_all});
             }
         }
     }
@@ -503,10 +535,12 @@ void argGenHardcoded(benchmark::internal::Benchmark* benchmark)
                                             for (auto tactic2 : cutlass_tactic)
                                                 for (auto routing : routing_config)
                                                     benchmark->Args({num_expert, k, size, inter_size, 1, 1, 0, tokens,
-                                                        bias, (int) act, (int) norm, tactic1, tactic2, routing});
+                                                        bias, (int) act, (int) norm, tactic1, tactic2, routing, 0});
                     }
 }
 
+constexpr int MPI_BENCHMARK_ITERATIONS = 100;
+
 template <class BenchClass>
 void argGen(benchmark::internal::Benchmark* benchmark)
 {
@@ -526,7 +560,13 @@ void argGen(benchmark::internal::Benchmark* benchmark)
     // Generic setup
     benchmark->UseManualTime();
     benchmark->ArgNames({"Num Experts", "K", "Hidden Size", "Inter Size", "TP Size", "EP Size", "World Rank",
-        "Num Tokens", "Use Bias", "Activation Function", "Norm Mode", "Tactic ID 1", "Tactic ID 2", "Routing ID"});
+        "Num Tokens", "Use Bias", "Activation Function", "Norm Mode", "Tactic ID 1", "Tactic ID 2", "Routing ID",
+        "All To All"});
+    if (moe_benchmark::getWorldSize() > 1)
+    {
+        // The ranks exchange tokens every iteration, so they must all run the same number
+        benchmark->Iterations(MPI_BENCHMARK_ITERATIONS);
+    }
 
     if (workloadFile)
         argGenLoadFile<BenchClass>(benchmark);
@@ -571,9 +611,22 @@ void doCleanup()
     streamPtr.reset();
 }
 
+// Only the first rank prints, the per phase timings it reports are those of the slowest rank
+class NullReporter : public benchmark::BenchmarkReporter
+{
+public:
+    bool ReportContext(Context const&) override
+    {
+        return true;
+    }
+
+    void ReportRuns(std::vector<Run> const&) override {}
+};
+
 void help()
 {
-    std::cout << "Usage: mixtureOfExpertsBackendBenchmark [--input_file <file>] [benchmark options]\n";
+    std::cout << "Usage: [mpirun -n <ranks>] mixtureOfExpertsBackendBenchmark [--input_file <file>] "
+                 "[benchmark options]\n";
     std::cout
         << "--input_file\t\tA JSON file describing the benchmark configurations\n\n"
         << "File schema\n"
@@ -597,6 +650,8 @@ void help()
            "    \"routing_values_name\": string, (optional)\n"
            "    \"routing_values\": [float, ...], or string, (optional, length is a multiple of num_experts)\n"
            "    \"routing_distribution\": [float, ...], or string, (optional, length is num_experts)\n"
+           "    \"routing_trace\": string, (optional)\n"
+           "    \"all_to_all\": int, (optional)\n"
            "  },\n"
            "  ...\n"
            "]\n"
@@ -607,7 +662,9 @@ void help()
            "- \"inter_size\" - The inter size\n"
            "- \"tp_size\" - The TP size to use\n"
            "- \"ep_size\" - The EP size to use\n"
-           "- \"world_rank\" - The world rank = tp_rank * ep_size + ep_rank\n"
+           "- \"world_rank\" - The world rank = tp_rank * ep_size + ep_rank. Under MPI every rank runs its own world "
+           "rank\n"
+           "and configs where tp_size * ep_size is not the number of ranks are skipped\n"
            "- \"num_tokens\" - The total number of tokens to benchmark\n"
            "- \"bias\" - If bias should be used, 0 = no bias, 1 = bias\n"
            "- \"act_fn\" - The enum value of the activation function. See\n"
@@ -656,6 +713,19 @@ void help()
            "- \"routing_distribution\" - instead of explicitly setting routing_values, define a random distribution "
            "that experts will be randomly sampled from."
            "There is also pre-defined config \"uniform\", which is short-hand for a random uniform distribution\n"
+           "- \"routing_trace\" - instead of routing values, replay the path of a JSON file holding, for every "
+           "recorded token,\n"
+           "the array of experts it selected, in order. Each iteration replays the next tokens and under MPI every "
+           "rank replays different ones\n"
+           "- \"all_to_all\" - If the tokens are exchanged between the EP ranks, 0 = each rank holds all tokens, "
+           "1 = all-to-all.\n"
+           "Needs one MPI rank per GPU of the layout\n"
+           "\n"
+           "Multi-GPU runs use one MPI rank per GPU and run a fixed number of iterations. Besides the total time every "
+           "benchmark reports\n"
+           "the time per iteration of the gating, permute, dispatch, gemm1, gemm2 and combine phases, of the slowest "
+           "rank.\n"
+           "TP ranks run their slice of inter_size, the TP all-reduce after the MOE layer is not timed\n"
            "\n";
 
     std::cout << "benchmark options:\n";
@@ -715,7 +785,15 @@ int parseArgsAndRunBench(int argc, char** argv)
             return -4;
         }
 
-        benchmark::RunSpecifiedBenchmarks();
+        if (moe_benchmark::getWorldRank() == 0)
+        {
+            benchmark::RunSpecifiedBenchmarks();
+        }
+        else
+        {
+            NullReporter reporter;
+            benchmark::RunSpecifiedBenchmarks(&reporter);
+        }
         benchmark::Shutdown();
 
         return 0;
@@ -729,9 +807,14 @@ int parseArgsAndRunBench(int argc, char** argv)
 
 int main(int argc, char** argv)
 {
+    moe_benchmark::initializeMpi();
     deviceCount = getDeviceCount();
     if (deviceCount < 0)
         return 0;
+    if (moe_benchmark::getWorldSize() > 1)
+    {
+        check_cuda_error(cudaSetDevice(moe_benchmark::getWorldRank() % deviceCount));
+    }
     streamPtr = std::make_shared<CudaStream>();
     bufferManager = std::make_unique<BufferManager>(streamPtr);
 
@@ -0,0 +1,144 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mixtureOfExpertsBackendBenchmarkMpi.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/mpiUtils.h"
+
+#if ENABLE_MULTI_DEVICE
+#include "tensorrt_llm/runtime/utils/multiDeviceUtils.h"
+#include <nccl.h>
+#endif // ENABLE_MULTI_DEVICE
+
+using namespace tensorrt_llm::kernels;
+
+namespace moe_benchmark
+{
+
+#if ENABLE_MULTI_DEVICE
+namespace
+{
+
+// The world rank is tp_rank * ep_size + ep_rank, so the ep ranks of a tp group are consecutive
+class NcclAllToAllCommunicator : public MoeAllToAllCommunicator
+{
+public:
+    explicit NcclAllToAllCommunicator(MOEParallelismConfig const& parallelism_config)
+    {
+        auto const group = COMM_SESSION.split(parallelism_config.tp_rank, parallelism_config.ep_rank);
+        ncclUniqueId id;
+        if (parallelism_config.ep_rank == 0)
+        {
+            TLLM_NCCL_CHECK(ncclGetUniqueId(&id));
+        }
+        group.bcastValue(id, 0);
+        TLLM_NCCL_CHECK(ncclCommInitRank(&mComm, parallelism_config.ep_size, id, parallelism_config.ep_rank));
+    }
+
+    ~NcclAllToAllCommunicator() override
+    {
+        if (ncclCommDestroy(mComm) != ncclSuccess)
+        {
+            TLLM_LOG_WARNING("Failed to destroy NCCL communicator.");
+        }
+    }
+
+    void allToAll(void const* send, std::vector<size_t> const& sendOffsets, std::vector<size_t> const& sendSizes,
+        void* recv, std::vector<size_t> const& recvOffsets, std::vector<size_t> const& recvSizes,
+        cudaStream_t stream) override
+    {
+        TLLM_NCCL_CHECK(ncclGroupStart());
+        for (size_t peer = 0; peer < sendSizes.size(); ++peer)
+        {
+            if (sendSizes[peer] > 0)
+            {
+                TLLM_NCCL_CHECK(ncclSend(static_cast<char const*>(send) + sendOffsets[peer], sendSizes[peer],
+                    ncclInt8, peer, mComm, stream));
+            }
+            if (recvSizes[peer] > 0)
+            {
+                TLLM_NCCL_CHECK(ncclRecv(static_cast<char*>(recv) + recvOffsets[peer], recvSizes[peer], ncclInt8,
+                    peer, mComm, stream));
+            }
+        }
+        TLLM_NCCL_CHECK(ncclGroupEnd());
+    }
+
+private:
+    ncclComm_t mComm{};
+};
+
+} // namespace
+#endif // ENABLE_MULTI_DEVICE
+
+void initializeMpi()
+{
+#if ENABLE_MULTI_DEVICE
+    tensorrt_llm::mpi::initialize();
+#endif // ENABLE_MULTI_DEVICE
+}
+
+int getWorldRank()
+{
+#if ENABLE_MULTI_DEVICE
+    return COMM_SESSION.getRank();
+#else
+    return 0;
+#endif // ENABLE_MULTI_DEVICE
+}
+
+int getWorldSize()
+{
+#if ENABLE_MULTI_DEVICE
+    return COMM_SESSION.getSize();
+#else
+    return 1;
+#endif // ENABLE_MULTI_DEVICE
+}
+
+void barrier()
+{
+#if ENABLE_MULTI_DEVICE
+    COMM_SESSION.barrier();
+#endif // ENABLE_MULTI_DEVICE
+}
+
+void maxOverRanks(std::vector<double>& values)
+{
+#if ENABLE_MULTI_DEVICE
+    if (getWorldSize() > 1)
+    {
+        std::vector<double> result(values.size());
+        COMM_SESSION.allreduce(values.data(), result.data(), static_cast<int>(values.size()),
+            tensorrt_llm::mpi::MpiType::kDOUBLE, tensorrt_llm::mpi::MpiOp::MAX);
+        values = std::move(result);
+    }
+#endif // ENABLE_MULTI_DEVICE
+}
+
+std::shared_ptr<MoeAllToAllCommunicator> createAllToAllCommunicator(MOEParallelismConfig const& parallelism_config)
+{
+#if ENABLE_MULTI_DEVICE
+    return std::make_shared<NcclAllToAllCommunicator>(parallelism_config);
+#else
+    TLLM_THROW("The MOE all-to-all needs multi device support");
+#endif // ENABLE_MULTI_DEVICE
+}
+
+} // namespace moe_benchmark
@@ -0,0 +1,48 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "tensorrt_llm/kernels/mixtureOfExperts/moe_kernels.h"
+
+#include <memory>
+#include <vector>
+
+/*
+ * Multi-GPU runs of the MOE benchmark, launched with one MPI rank per GPU. The CUDA sources of the benchmark are not
+ * built with the multi device flags, so everything touching MPI or NCCL lives in the host translation unit. Without
+ * multi device support the benchmark is a single rank.
+ */
+namespace moe_benchmark
+{
+
+void initializeMpi();
+
+int getWorldRank();
+
+int getWorldSize();
+
+// Keeps the ranks in step between benchmark cases
+void barrier();
+
+// Replaces every value with its largest value over the ranks, so the report shows the slowest rank
+void maxOverRanks(std::vector<double>& values);
+
+// The all-to-all of the expert parallel group of this rank, created collectively by all the ranks
+std::shared_ptr<tensorrt_llm::kernels::MoeAllToAllCommunicator> createAllToAllCommunicator(
+    tensorrt_llm::kernels::MOEParallelismConfig const& parallelism_config);
+
+} // namespace moe_benchmark
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Fills the all-reduce strategy table by timing every strategy and AllReduceStrategyConfig of the custom all-reduce,
+// and NCCL, across message sizes on the current node. Run it with one rank per GPU of the TP group:
+//
+//   mpirun -n 8 allReduceStrategyTuner --output=/path/to/allreduce_strategies.txt
+//
+// The all-reduce plugin loads the table from TRTLLM_ALLREDUCE_STRATEGY_TABLE_FILE and its AUTO strategy picks the
+// fastest measured candidate of every message size. Entries of an existing output file are kept unless they are
+// tuned again.
+
+#include "tensorrt_llm/allreduce_tuning/collectiveRunner.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/customAllReduceUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/kernels/allReduceStrategyTable.h"
+#include "tensorrt_llm/kernels/customAllReduceKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/ipcUtils.h"
+#include "tensorrt_llm/runtime/ncclCommunicator.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <cuda_fp16.h>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace tc = tensorrt_llm::common;
+namespace tat = tensorrt_llm::allreduce_tuning;
+namespace tk = tensorrt_llm::kernels;
+namespace tr = tensorrt_llm::runtime;
+
+namespace
+{
+
+using Choice = tk::AllReduceStrategyTable::Choice;
+
+void printUsage(char const* program)
+{
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --output=FILE           strategy file to write, existing entries are kept\n"
+              << "  --min_size=BYTES        smallest message size, rounded up to a power of two (default 1024)\n"
+              << "  --max_size=BYTES        largest message size, capped to the custom all-reduce workspace\n"
+              << "                          (default 0, the workspace size)\n"
+              << "  --iterations=N          timed all-reduces per candidate (default 20)\n";
+}
+
+std::vector<Choice> getCandidates(bool hasNvls)
+{
+    std::vector<Choice> candidates{{tk::AllReduceStrategyType::NCCL, tk::AllReduceStrategyConfig(0)}};
+    for (auto const strategy : {tk::AllReduceStrategyType::ONESHOT, tk::AllReduceStrategyType::TWOSHOT})
+    {
+        for (auto const config : {tk::AllReduceStrategyConfig(0), tk::AllReduceStrategyConfig::USE_MEMCPY,
+                 tk::AllReduceStrategyConfig::PUSH_MODE})
+        {
+            candidates.push_back({strategy, config});
+        }
+    }
+    if (hasNvls)
+    {
+        candidates.push_back({tk::AllReduceStrategyType::NVLS, tk::AllReduceStrategyConfig(0)});
+    }
+    return candidates;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::map<std::string, std::string> options{
+        {"output", ""}, {"min_size", "1024"}, {"max_size", "0"}, {"iterations", "20"}};
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg{argv[i]};
+        auto const eq = arg.find('=');
+        if (arg == "--help" || arg.rfind("--", 0) != 0 || eq == std::string::npos
+            || options.count(arg.substr(2, eq - 2)) == 0)
+        {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+        options[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+    }
+    if (options["output"].empty())
+    {
+        TLLM_LOG_ERROR("No output file, set --output");
+        return 1;
+    }
+
+    tensorrt_llm::mpi::initialize(tensorrt_llm::mpi::MpiThreadSupport::THREAD_MULTIPLE);
+    auto const worldConfig = tr::WorldConfig::mpi(tc::getDeviceCount(), COMM_SESSION.getSize(), 1);
+    TLLM_CUDA_CHECK(cudaSetDevice(worldConfig.getDevice()));
+    auto const tpSize = worldConfig.getTensorParallelism();
+    auto const isLeader = worldConfig.getRank() == 0;
+
+    auto const workspaceSize = tensorrt_llm::utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(tpSize);
+    auto const requestedMaxSize = std::stoull(options["max_size"]);
+    size_t const maxSize = requestedMaxSize == 0 ? workspaceSize : std::min<size_t>(requestedMaxSize, workspaceSize);
+    auto const minBucket = tk::AllReduceStrategyTable::getBucket(std::stoull(options["min_size"]));
+    auto const iterations = std::stoi(options["iterations"]);
+
+    tk::AllReduceStrategyTable tuned;
+    if (isLeader && std::filesystem::exists(options["output"]) && !tuned.loadFile(options["output"]))
+    {
+        return 1;
+    }
+
+    auto stream = std::make_shared<tr::CudaStream>();
+    tr::BufferManager const manager{stream};
+    // Sized for maxSize bytes of fp32 activations, the fp16 messages below use half of it.
+    tr::AllReduceBuffers buffers{1, 1, static_cast<tr::SizeType32>(maxSize / sizeof(float)), 1, manager, worldConfig};
+    tr::NcclCommunicator const nccl{worldConfig};
+    tat::CollectiveRunner const runner{
+        buffers, nccl, tpSize, worldConfig.getTensorParallelRank(), manager, maxSize, nvinfer1::DataType::kHALF};
+
+    auto const candidates = getCandidates(buffers.mMulticastMemory != nullptr);
+    auto const sm = tc::getSMVersion();
+
+    cudaEvent_t start;
+    cudaEvent_t stop;
+    TLLM_CUDA_CHECK(cudaEventCreate(&start));
+    TLLM_CUDA_CHECK(cudaEventCreate(&stop));
+    for (auto bucket = minBucket; (size_t{1} << bucket) <= maxSize; ++bucket)
+    {
+        auto const messageBytes = size_t{1} << bucket;
+        auto const numElts = messageBytes / sizeof(half);
+        Choice best = candidates.front();
+        float bestTime = 0.f;
+        for (auto const& choice : candidates)
+        {
+            tat::Candidate const candidate{tat::Collective::kALL_REDUCE, choice.strategy, choice.config};
+            if (!runner.isSupported(candidate, numElts))
+            {
+                continue;
+            }
+            auto const time = tat::timeCandidate(runner, candidate, numElts, iterations, *stream, start, stop);
+            if (choice.strategy == tk::AllReduceStrategyType::NCCL || time < bestTime)
+            {
+                best = choice;
+                bestTime = time;
+            }
+        }
+        tuned.set(tk::AllReduceStrategyTable::makeKey(sm, tpSize, messageBytes), best);
+        if (isLeader)
+        {
+            TLLM_LOG_INFO("message_size=%zu: strategy %d config %d, %.3f us", messageBytes,
+                static_cast<int>(best.strategy), static_cast<int>(best.config), bestTime * 1000.f);
+        }
+    }
+    TLLM_CUDA_CHECK(cudaEventDestroy(start));
+    TLLM_CUDA_CHECK(cudaEventDestroy(stop));
+
+    if (isLeader)
+    {
+        if (!tuned.saveFile(options["output"]))
+        {
+            return 1;
+        }
+        TLLM_LOG_INFO("Wrote %zu all-reduce strategy entries to %s", tuned.size(), options["output"].c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,460 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the strategies of the custom all-reduce with the NCCL all-reduce, all-gather and reduce-scatter of the
+// nccl plugins on the current node, and prints the NVLink and PCIe topology they run on. Run it with one rank per GPU:
+//
+//   mpirun -n 8 collectiveBenchmark --tp_sizes=2,8 --dtypes=half,bf16 --fusion_ops=none,residual_rms_norm
+//
+// Every TP size runs as world_size / tp_size concurrent TP groups, so all GPUs stay busy as in a TPxPP engine. The
+// latency is the average over the iterations of the slowest rank, the bus bandwidth follows the nccl-tests
+// convention. With --strategy_table, the fastest all-reduce of every message size of the unfused runs of the first
+// dtype is written in the format of allReduceStrategyTuner, for the AUTO strategy of the all-reduce plugin.
+
+#include "tensorrt_llm/allreduce_tuning/collectiveRunner.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/customAllReduceUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/kernels/allReduceStrategyTable.h"
+#include "tensorrt_llm/kernels/customAllReduceKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/ipcUtils.h"
+#include "tensorrt_llm/runtime/ncclCommunicator.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <nvml.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tc = tensorrt_llm::common;
+namespace tat = tensorrt_llm::allreduce_tuning;
+namespace tk = tensorrt_llm::kernels;
+namespace tr = tensorrt_llm::runtime;
+
+namespace
+{
+
+void printUsage(char const* program)
+{
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --min_size=BYTES        smallest message size, rounded up to a power of two (default 1024)\n"
+              << "  --max_size=BYTES        largest message size (default 0, the custom all-reduce workspace of\n"
+              << "                          the largest TP size)\n"
+              << "  --dtypes=LIST           comma separated half, bf16 and float (default half)\n"
+              << "  --tp_sizes=LIST         comma separated TP sizes dividing the world size (default every even\n"
+              << "                          divisor)\n"
+              << "  --collectives=LIST      comma separated all_reduce, all_gather and reduce_scatter (default all)\n"
+              << "  --fusion_ops=LIST       comma separated none and residual_rms_norm, the fusions of the\n"
+              << "                          all-reduce (default none)\n"
+              << "  --hidden_size=N         hidden size of the norm fusion (default 4096)\n"
+              << "  --iterations=N          timed collectives per candidate (default 20)\n"
+              << "  --strategy_table=FILE   all-reduce strategy file to write, existing entries are kept\n";
+}
+
+std::vector<std::string> splitList(std::string const& list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream{list};
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+nvinfer1::DataType parseDataType(std::string const& name)
+{
+    static std::map<std::string, nvinfer1::DataType> const dataTypes{{"half", nvinfer1::DataType::kHALF},
+        {"bf16", nvinfer1::DataType::kBF16}, {"float", nvinfer1::DataType::kFLOAT}};
+    auto const it = dataTypes.find(name);
+    TLLM_CHECK_WITH_INFO(it != dataTypes.end(), "Unknown dtype %s", name.c_str());
+    return it->second;
+}
+
+tk::AllReduceFusionOp parseFusionOp(std::string const& name)
+{
+    static std::map<std::string, tk::AllReduceFusionOp> const fusionOps{
+        {"none", tk::AllReduceFusionOp::NONE}, {"residual_rms_norm", tk::AllReduceFusionOp::RESIDUAL_RMS_NORM}};
+    auto const it = fusionOps.find(name);
+    TLLM_CHECK_WITH_INFO(it != fusionOps.end(), "Unknown fusion op %s", name.c_str());
+    return it->second;
+}
+
+tat::Collective parseCollective(std::string const& name)
+{
+    static std::map<std::string, tat::Collective> const collectives{{"all_reduce", tat::Collective::kALL_REDUCE},
+        {"all_gather", tat::Collective::kALL_GATHER}, {"reduce_scatter", tat::Collective::kREDUCE_SCATTER}};
+    auto const it = collectives.find(name);
+    TLLM_CHECK_WITH_INFO(it != collectives.end(), "Unknown collective %s", name.c_str());
+    return it->second;
+}
+
+std::vector<tat::Candidate> getCandidates(std::vector<tat::Collective> const& collectives, bool hasNvls)
+{
+    std::vector<tat::Candidate> candidates;
+    for (auto const collective : collectives)
+    {
+        candidates.push_back({collective, tk::AllReduceStrategyType::NCCL, tk::AllReduceStrategyConfig(0)});
+        if (collective != tat::Collective::kALL_REDUCE)
+        {
+            continue;
+        }
+        for (auto const strategy : {tk::AllReduceStrategyType::ONESHOT, tk::AllReduceStrategyType::TWOSHOT})
+        {
+            for (auto const config : {tk::AllReduceStrategyConfig(0), tk::AllReduceStrategyConfig::USE_MEMCPY,
+                     tk::AllReduceStrategyConfig::PUSH_MODE})
+            {
+                candidates.push_back({collective, strategy, config});
+            }
+        }
+        if (hasNvls)
+        {
+            candidates.push_back({collective, tk::AllReduceStrategyType::NVLS, tk::AllReduceStrategyConfig(0)});
+        }
+    }
+    return candidates;
+}
+
+void checkNvml(nvmlReturn_t result, char const* call)
+{
+    TLLM_CHECK_WITH_INFO(result == NVML_SUCCESS, "%s failed: %s", call, nvmlErrorString(result));
+}
+
+class NvmlSession
+{
+public:
+    NvmlSession()
+    {
+        checkNvml(nvmlInit(), "nvmlInit");
+    }
+
+    ~NvmlSession()
+    {
+        nvmlShutdown();
+    }
+};
+
+// The PCI bus ids of the NVLink peers of a GPU, a GPU or an NVSwitch, one entry per active link.
+std::vector<std::string> getNvLinkPeers(nvmlDevice_t device)
+{
+    std::vector<std::string> peers;
+    for (unsigned int link = 0; link < NVML_NVLINK_MAX_LINKS; ++link)
+    {
+        nvmlEnableState_t isActive;
+        if (nvmlDeviceGetNvLinkState(device, link, &isActive) != NVML_SUCCESS || isActive != NVML_FEATURE_ENABLED)
+        {
+            continue;
+        }
+        nvmlPciInfo_t remotePciInfo;
+        if (nvmlDeviceGetNvLinkRemotePciInfo_v2(device, link, &remotePciInfo) == NVML_SUCCESS)
+        {
+            peers.emplace_back(remotePciInfo.busId);
+        }
+    }
+    return peers;
+}
+
+bool isGpu(std::string const& busId)
+{
+    nvmlDevice_t device;
+    return nvmlDeviceGetHandleByPciBusId_v2(busId.c_str(), &device) == NVML_SUCCESS;
+}
+
+std::string getPcieLevel(nvmlDevice_t first, nvmlDevice_t second)
+{
+    nvmlGpuTopologyLevel_t level;
+    if (nvmlDeviceGetTopologyCommonAncestor(first, second, &level) != NVML_SUCCESS)
+    {
+        return "?";
+    }
+    switch (level)
+    {
+    case NVML_TOPOLOGY_INTERNAL:
+    case NVML_TOPOLOGY_SINGLE: return "PIX";
+    case NVML_TOPOLOGY_MULTIPLE: return "PXB";
+    case NVML_TOPOLOGY_HOSTBRIDGE: return "PHB";
+    case NVML_TOPOLOGY_NODE: return "NODE";
+    default: return "SYS";
+    }
+}
+
+// Prints the connection of every pair of GPUs of the node of rank 0, in the legend of nvidia-smi topo -m:
+// NV<n> for n direct NVLinks, NVS through an NVSwitch, else the closest common PCIe ancestor, and whether CUDA peer
+// access works over it.
+void printTopology(std::vector<int> const& devices)
+{
+    NvmlSession const nvmlSession;
+    auto const numDevices = devices.size();
+    std::vector<nvmlDevice_t> handles(numDevices);
+    std::vector<std::string> busIds(numDevices);
+    std::vector<std::vector<std::string>> peers(numDevices);
+    for (size_t i = 0; i < numDevices; ++i)
+    {
+        char cudaBusId[NVML_DEVICE_PCI_BUS_ID_BUFFER_SIZE];
+        TLLM_CUDA_CHECK(cudaDeviceGetPCIBusId(cudaBusId, sizeof(cudaBusId), devices[i]));
+        checkNvml(nvmlDeviceGetHandleByPciBusId_v2(cudaBusId, &handles[i]), "nvmlDeviceGetHandleByPciBusId_v2");
+        nvmlPciInfo_t pciInfo;
+        checkNvml(nvmlDeviceGetPciInfo_v3(handles[i], &pciInfo), "nvmlDeviceGetPciInfo_v3");
+        busIds[i] = pciInfo.busId;
+        peers[i] = getNvLinkPeers(handles[i]);
+    }
+
+    std::cout << "Topology of the GPUs of rank 0's node:\n" << std::setw(8) << "";
+    for (auto const device : devices)
+    {
+        std::cout << std::setw(12) << ("GPU" + std::to_string(device));
+    }
+    std::cout << "\n";
+    for (size_t i = 0; i < numDevices; ++i)
+    {
+        std::cout << std::setw(8) << ("GPU" + std::to_string(devices[i]));
+        for (size_t j = 0; j < numDevices; ++j)
+        {
+            std::string connection = "X";
+            if (i != j)
+            {
+                auto const directLinks = std::count(peers[i].begin(), peers[i].end(), busIds[j]);
+                auto const sharesSwitch = std::any_of(peers[i].begin(), peers[i].end(),
+                    [&](auto const& peer)
+                    { return !isGpu(peer) && std::find(peers[j].begin(), peers[j].end(), peer) != peers[j].end(); });
+                int canAccessPeer = 0;
+                TLLM_CUDA_CHECK(cudaDeviceCanAccessPeer(&canAccessPeer, devices[i], devices[j]));
+                connection = directLinks > 0 ? "NV" + std::to_string(directLinks)
+                    : sharesSwitch           ? std::string{"NVS"}
+                                             : getPcieLevel(handles[i], handles[j]) + (canAccessPeer ? "" : ",noP2P");
+            }
+            std::cout << std::setw(12) << connection;
+        }
+        std::cout << "  " << busIds[i] << "\n";
+    }
+}
+
+void printHeader(std::vector<tat::Candidate> const& candidates, int tpSize, std::string const& dtype,
+    std::string const& fusionOp, int numGroups)
+{
+    std::cout << "\ntp_size=" << tpSize << " (" << numGroups << " concurrent groups), dtype=" << dtype
+              << ", fusion_op=" << fusionOp << ": latency in us / bus bandwidth in GB/s\n"
+              << std::setw(12) << "size";
+    for (auto const& candidate : candidates)
+    {
+        std::cout << std::setw(22) << candidate.getName();
+    }
+    std::cout << "\n";
+}
+
+std::string formatCell(float milliseconds, double busBytes)
+{
+    std::ostringstream cell;
+    cell << std::fixed << std::setprecision(1) << milliseconds * 1000.f << " / " << std::setprecision(1)
+         << busBytes / (milliseconds * 1e6);
+    return cell.str();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::map<std::string, std::string> options{{"min_size", "1024"}, {"max_size", "0"}, {"dtypes", "half"},
+        {"tp_sizes", ""}, {"collectives", "all_reduce,all_gather,reduce_scatter"}, {"fusion_ops", "none"},
+        {"hidden_size", "4096"}, {"iterations", "20"}, {"strategy_table", ""}};
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg{argv[i]};
+        auto const eq = arg.find('=');
+        if (arg == "--help" || arg.rfind("--", 0) != 0 || eq == std::string::npos
+            || options.count(arg.substr(2, eq - 2)) == 0)
+        {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+        options[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+    }
+
+    tensorrt_llm::mpi::initialize(tensorrt_llm::mpi::MpiThreadSupport::THREAD_MULTIPLE);
+    auto const worldSize = COMM_SESSION.getSize();
+    auto const rank = COMM_SESSION.getRank();
+    auto const isLeader = rank == 0;
+    auto const gpusPerNode = tc::getDeviceCount();
+
+    std::vector<int> tpSizes;
+    for (auto const& tpSize : splitList(options["tp_sizes"]))
+    {
+        tpSizes.push_back(std::stoi(tpSize));
+    }
+    if (options["tp_sizes"].empty())
+    {
+        for (int tpSize = 2; tpSize <= worldSize; tpSize += 2)
+        {
+            if (worldSize % tpSize == 0)
+            {
+                tpSizes.push_back(tpSize);
+            }
+        }
+    }
+    for (auto const tpSize : tpSizes)
+    {
+        if (tpSize < 2 || worldSize % tpSize != 0)
+        {
+            TLLM_LOG_ERROR("TP size %d does not divide the world size %d into groups of 2 or more ranks", tpSize,
+                worldSize);
+            return 1;
+        }
+    }
+    if (tpSizes.empty())
+    {
+        TLLM_LOG_ERROR("No TP size to benchmark, launch at least 2 ranks");
+        return 1;
+    }
+
+    std::vector<std::string> const dtypeNames = splitList(options["dtypes"]);
+    std::vector<std::string> const fusionOpNames = splitList(options["fusion_ops"]);
+    std::vector<tat::Collective> collectives;
+    for (auto const& name : splitList(options["collectives"]))
+    {
+        collectives.push_back(parseCollective(name));
+    }
+    auto const hiddenSize = std::stoi(options["hidden_size"]);
+    auto const iterations = std::stoi(options["iterations"]);
+    auto const maxTpSize = *std::max_element(tpSizes.begin(), tpSizes.end());
+    auto const requestedMaxSize = std::stoull(options["max_size"]);
+    size_t const maxSize = requestedMaxSize == 0
+        ? tensorrt_llm::utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(maxTpSize)
+        : requestedMaxSize;
+    auto const minBucket = tk::AllReduceStrategyTable::getBucket(std::stoull(options["min_size"]));
+    auto const& tablePath = options["strategy_table"];
+
+    tk::AllReduceStrategyTable tuned;
+    if (isLeader && !tablePath.empty() && std::filesystem::exists(tablePath) && !tuned.loadFile(tablePath))
+    {
+        return 1;
+    }
+
+    auto const device = tr::WorldConfig::mpi(gpusPerNode, worldSize, 1).getDevice();
+    TLLM_CUDA_CHECK(cudaSetDevice(device));
+    std::vector<int> localDevices(LOCAL_COMM_SESSION.getSize());
+    LOCAL_COMM_SESSION.allgather(&device, localDevices.data(), 1, tensorrt_llm::mpi::MpiType::kINT32);
+    if (isLeader)
+    {
+        printTopology(localDevices);
+    }
+
+    auto stream = std::make_shared<tr::CudaStream>();
+    tr::BufferManager const manager{stream};
+    auto const sm = tc::getSMVersion();
+    cudaEvent_t start;
+    cudaEvent_t stop;
+    TLLM_CUDA_CHECK(cudaEventCreate(&start));
+    TLLM_CUDA_CHECK(cudaEventCreate(&stop));
+
+    for (auto const tpSize : tpSizes)
+    {
+        auto const worldConfig = tr::WorldConfig::mpi(gpusPerNode, tpSize, worldSize / tpSize);
+        auto const tpRank = worldConfig.getTensorParallelRank();
+        // Sized for maxSize bytes of fp32 activations, the widest dtype.
+        tr::AllReduceBuffers buffers{
+            1, 1, static_cast<tr::SizeType32>(maxSize / sizeof(float)), 1, manager, worldConfig};
+        auto const tpComm = COMM_SESSION.split(worldConfig.getPipelineParallelRank(), tpRank);
+        tr::NcclCommunicator const nccl{tpSize, tpRank, tpComm};
+        auto const candidates = getCandidates(collectives, buffers.mMulticastMemory != nullptr);
+        if (isLeader)
+        {
+            std::cout << "\ntp_size=" << tpSize << ": NVLS " << (buffers.mMulticastMemory ? "available" : "unavailable")
+                      << "\n";
+        }
+
+        for (size_t dtypeIdx = 0; dtypeIdx < dtypeNames.size(); ++dtypeIdx)
+        {
+            auto const dataType = parseDataType(dtypeNames[dtypeIdx]);
+            auto const eltSize = tc::getDTypeSize(dataType);
+            for (auto const& fusionOpName : fusionOpNames)
+            {
+                auto const fusionOp = parseFusionOp(fusionOpName);
+                tat::CollectiveRunner const runner{
+                    buffers, nccl, tpSize, tpRank, manager, maxSize, dataType, fusionOp, hiddenSize};
+                auto const tuneTable = !tablePath.empty() && dtypeIdx == 0 && fusionOp == tk::AllReduceFusionOp::NONE;
+                if (isLeader)
+                {
+                    printHeader(candidates, tpSize, dtypeNames[dtypeIdx], fusionOpName, worldSize / tpSize);
+                }
+
+                for (auto bucket = minBucket; (size_t{1} << bucket) <= maxSize; ++bucket)
+                {
+                    auto const messageBytes = size_t{1} << bucket;
+                    auto const numElts = messageBytes / eltSize;
+                    tk::AllReduceStrategyTable::Choice best{};
+                    float bestTime = 0.f;
+                    std::ostringstream row;
+                    row << std::setw(12) << messageBytes;
+                    for (auto const& candidate : candidates)
+                    {
+                        // Every group has to time the same candidates, the timing synchronizes all ranks.
+                        int supported = runner.isSupported(candidate, numElts) ? 1 : 0;
+                        int allSupported = 0;
+                        COMM_SESSION.allreduce(&supported, &allSupported, 1, tensorrt_llm::mpi::MpiType::kINT32,
+                            tensorrt_llm::mpi::MpiOp::MIN);
+                        if (allSupported == 0)
+                        {
+                            row << std::setw(22) << "-";
+                            continue;
+                        }
+                        auto const time
+                            = tat::timeCandidate(runner, candidate, numElts, iterations, *stream, start, stop);
+                        row << std::setw(22)
+                            << formatCell(time, messageBytes * candidate.getBusBandwidthFactor(tpSize));
+                        auto const isAllReduce = candidate.collective == tat::Collective::kALL_REDUCE;
+                        if (isAllReduce && (candidate.strategy == tk::AllReduceStrategyType::NCCL || time < bestTime))
+                        {
+                            best = {candidate.strategy, candidate.config};
+                            bestTime = time;
+                        }
+                    }
+                    if (isLeader)
+                    {
+                        std::cout << row.str() << "\n";
+                    }
+                    if (tuneTable && bestTime > 0.f)
+                    {
+                        tuned.set(tk::AllReduceStrategyTable::makeKey(sm, tpSize, messageBytes), best);
+                    }
+                }
+            }
+        }
+    }
+    TLLM_CUDA_CHECK(cudaEventDestroy(start));
+    TLLM_CUDA_CHECK(cudaEventDestroy(stop));
+
+    if (isLeader && !tablePath.empty())
+    {
+        if (!tuned.saveFile(tablePath))
+        {
+            return 1;
+        }
+        TLLM_LOG_INFO("Wrote %zu all-reduce strategy entries to %s", tuned.size(), tablePath.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/customAllReduceUtils.h"
+#include "tensorrt_llm/common/dataType.h"
+#include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/kernels/customAllReduceKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/ipcUtils.h"
+#include "tensorrt_llm/runtime/ncclCommunicator.h"
+
+#include <string>
+
+// Runs and times the collectives compared by allReduceStrategyTuner and collectiveBenchmark: the strategies of the
+// custom all-reduce and the NCCL collectives, on one TP group.
+namespace tensorrt_llm::allreduce_tuning
+{
+
+enum class Collective
+{
+    kALL_REDUCE,
+    kALL_GATHER,
+    kREDUCE_SCATTER,
+};
+
+//! \brief A collective and, for the all-reduce, the implementation. The all-gather and the reduce-scatter are NCCL's.
+struct Candidate
+{
+    Collective collective;
+    kernels::AllReduceStrategyType strategy;
+    kernels::AllReduceStrategyConfig config;
+
+    [[nodiscard]] std::string getName() const
+    {
+        switch (collective)
+        {
+        case Collective::kALL_GATHER: return "nccl_allgather";
+        case Collective::kREDUCE_SCATTER: return "nccl_reducescatter";
+        default: break;
+        }
+        std::string name;
+        switch (strategy)
+        {
+        case kernels::AllReduceStrategyType::NCCL: return "nccl";
+        case kernels::AllReduceStrategyType::ONESHOT: name = "oneshot"; break;
+        case kernels::AllReduceStrategyType::TWOSHOT: name = "twoshot"; break;
+        case kernels::AllReduceStrategyType::NVLS: name = "nvls"; break;
+        default: name = std::to_string(static_cast<int>(strategy)); break;
+        }
+        if (kernels::hasConfigFlag(config, kernels::AllReduceStrategyConfig::USE_MEMCPY))
+        {
+            name += "_memcpy";
+        }
+        if (kernels::hasConfigFlag(config, kernels::AllReduceStrategyConfig::PUSH_MODE))
+        {
+            name += "_push";
+        }
+        return name;
+    }
+
+    //! \brief Bytes a link carries per message byte with an optimal algorithm, the bus bandwidth factor of nccl-tests.
+    [[nodiscard]] double getBusBandwidthFactor(int tpSize) const
+    {
+        auto const factor = static_cast<double>(tpSize - 1) / tpSize;
+        return collective == Collective::kALL_REDUCE ? 2 * factor : factor;
+    }
+};
+
+//! \brief Runs the candidates on messages of up to maxBytes. The message size is the size of the all-reduce, the
+//! output of the all-gather and the input of the reduce-scatter.
+class CollectiveRunner
+{
+public:
+    CollectiveRunner(runtime::AllReduceBuffers& buffers, runtime::NcclCommunicator const& nccl, int tpSize,
+        int tpRank, runtime::BufferManager const& manager, size_t maxBytes, nvinfer1::DataType dataType,
+        kernels::AllReduceFusionOp fusionOp = kernels::AllReduceFusionOp::NONE, int hiddenSize = 0)
+        : mBuffers(buffers)
+        , mNccl(nccl)
+        , mTpSize(tpSize)
+        , mTpRank(tpRank)
+        , mDataType(dataType)
+        , mFusionOp(fusionOp)
+        , mHiddenSize(hiddenSize)
+        , mMaxElts(maxBytes / common::getDTypeSize(dataType))
+    {
+        TLLM_CHECK_WITH_INFO(fusionOp == kernels::AllReduceFusionOp::NONE
+                || fusionOp == kernels::AllReduceFusionOp::RESIDUAL_RMS_NORM,
+            "Only the residual RMS norm fusion is benchmarked");
+        TLLM_CHECK_WITH_INFO(fusionOp == kernels::AllReduceFusionOp::NONE || hiddenSize > 0,
+            "The norm fusion needs a hidden size");
+        mInput = manager.gpu(mMaxElts, dataType);
+        mOutput = manager.gpu(mMaxElts, dataType);
+        manager.setZero(*mInput);
+        if (fusionOp != kernels::AllReduceFusionOp::NONE)
+        {
+            mResidual = manager.gpu(mMaxElts, dataType);
+            mIntermediate = manager.gpu(mMaxElts, dataType);
+            mWeight = manager.gpu(hiddenSize, dataType);
+            manager.setZero(*mResidual);
+            manager.setZero(*mWeight);
+        }
+    }
+
+    [[nodiscard]] bool isSupported(Candidate const& candidate, size_t numElts) const
+    {
+        if (numElts > mMaxElts)
+        {
+            return false;
+        }
+        auto const fused = mFusionOp != kernels::AllReduceFusionOp::NONE;
+        if (candidate.collective != Collective::kALL_REDUCE)
+        {
+            return !fused && numElts % mTpSize == 0;
+        }
+        if (fused && numElts % mHiddenSize != 0)
+        {
+            return false;
+        }
+        if (candidate.strategy == kernels::AllReduceStrategyType::NCCL)
+        {
+            return true;
+        }
+        // The custom all-reduce needs the IPC buffers of peer access and fits in them, it has no fused NVLS kernel.
+        auto const hasPeerAccess = !mBuffers.mIpcMemoryHandles.front().getCommPtrs().empty();
+        auto const workspaceElts
+            = utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(mTpSize) / common::getDTypeSize(mDataType);
+        if (candidate.strategy == kernels::AllReduceStrategyType::NVLS
+            && (mBuffers.mMulticastMemory == nullptr || fused))
+        {
+            return false;
+        }
+        return hasPeerAccess && numElts <= workspaceElts
+            && kernels::configurationSupported(candidate.strategy, numElts, mTpSize, mDataType);
+    }
+
+    void run(Candidate const& candidate, size_t numElts, runtime::CudaStream const& stream) const
+    {
+        using runtime::IBuffer;
+        switch (candidate.collective)
+        {
+        case Collective::kALL_GATHER:
+        {
+            auto const input = IBuffer::slice(mInput, 0, numElts / mTpSize);
+            auto output = IBuffer::slice(mOutput, 0, numElts);
+            mNccl.allGather(*input, *output, stream);
+            return;
+        }
+        case Collective::kREDUCE_SCATTER:
+        {
+            auto const input = IBuffer::slice(mInput, 0, numElts);
+            auto output = IBuffer::slice(mOutput, 0, numElts / mTpSize);
+            mNccl.reduceScatter(*input, *output, stream);
+            return;
+        }
+        default: break;
+        }
+
+        auto const fused = mFusionOp != kernels::AllReduceFusionOp::NONE;
+        kernels::AllReduceParams params{};
+        if (candidate.strategy != kernels::AllReduceStrategyType::NCCL)
+        {
+            // Every launch bumps the barrier flag of the workspace.
+            params = kernels::AllReduceParams::deserialize(static_cast<int64_t*>(mBuffers.mAllReduceCommPtrs->data()),
+                mTpSize, mTpRank, mBuffers.mMulticastMemory != nullptr);
+            params.local_input_buffer_ptr = mInput->data();
+        }
+        params.local_output_buffer_ptr = mOutput->data();
+        params.elts_total = numElts;
+        if (fused)
+        {
+            params.fusion_params.residual_buffer = mResidual->data();
+            params.fusion_params.weight_buffer = mWeight->data();
+            params.fusion_params.hidden_size = mHiddenSize;
+            params.fusion_params.eps = 1e-5f;
+            params.fusion_params.intermediate_buffer = mIntermediate->data();
+        }
+
+        if (candidate.strategy == kernels::AllReduceStrategyType::NCCL)
+        {
+            // As the all-reduce plugin, the fusion all-reduces into the intermediate buffer and runs the norm on it.
+            auto const input = IBuffer::slice(mInput, 0, numElts);
+            auto output = IBuffer::slice(fused ? mIntermediate : mOutput, 0, numElts);
+            mNccl.allReduce(*input, *output, stream);
+            if (fused)
+            {
+                kernels::residualRmsNorm(params, mDataType, mFusionOp, stream.get());
+            }
+            return;
+        }
+        kernels::customAllReduce(params, mDataType, candidate.strategy, candidate.config, mFusionOp, stream.get());
+    }
+
+private:
+    runtime::AllReduceBuffers& mBuffers;
+    runtime::NcclCommunicator const& mNccl;
+    int mTpSize;
+    int mTpRank;
+    nvinfer1::DataType mDataType;
+    kernels::AllReduceFusionOp mFusionOp;
+    int mHiddenSize;
+    size_t mMaxElts;
+    runtime::IBuffer::SharedPtr mInput;
+    runtime::IBuffer::SharedPtr mOutput;
+    runtime::IBuffer::SharedPtr mResidual;
+    runtime::IBuffer::SharedPtr mIntermediate;
+    runtime::IBuffer::SharedPtr mWeight;
+};
+
+//! \brief The average time in milliseconds of the slowest rank. All ranks of the session have to call it with the
+//! same arguments.
+inline float timeCandidate(CollectiveRunner const& runner, Candidate const& candidate, size_t numElts, int iterations,
+    runtime::CudaStream const& stream, cudaEvent_t start, cudaEvent_t stop)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        runner.run(candidate, numElts, stream);
+    }
+    stream.synchronize();
+    COMM_SESSION.barrier();
+    TLLM_CUDA_CHECK(cudaEventRecord(start, stream.get()));
+    for (int i = 0; i < iterations; ++i)
+    {
+        runner.run(candidate, numElts, stream);
+    }
+    TLLM_CUDA_CHECK(cudaEventRecord(stop, stream.get()));
+    TLLM_CUDA_CHECK(cudaEventSynchronize(stop));
+    float milliseconds = 0.f;
+    TLLM_CUDA_CHECK(cudaEventElapsedTime(&milliseconds, start, stop));
+    float slowest = 0.f;
+    COMM_SESSION.allreduce(&milliseconds, &slowest, 1, mpi::MpiType::kFLOAT, mpi::MpiOp::MAX);
+    return slowest / iterations;
+}
+
+} // namespace tensorrt_llm::allreduce_tuning
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/commLane.h"
+#include "tensorrt_llm/common/assert.h"
+
+namespace tensorrt_llm::common
+{
+
+namespace
+{
+thread_local int currentCommLane = 0;
+} // namespace
+
+int getCommLane() noexcept
+{
+    return currentCommLane;
+}
+
+CommLaneScope::CommLaneScope(int lane)
+    : mPreviousLane{currentCommLane}
+{
+    TLLM_CHECK_WITH_INFO(0 <= lane && lane < kNbCommLanes, "Communication lane %d out of range [0, %d)", lane,
+        kNbCommLanes);
+    currentCommLane = lane;
+}
+
+CommLaneScope::~CommLaneScope()
+{
+    currentCommLane = mPreviousLane;
+}
+
+} // namespace tensorrt_llm::common
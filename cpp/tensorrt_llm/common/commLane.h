@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+namespace tensorrt_llm::common
+{
+
+/// @brief Number of communication lanes, the micro batches of a step that may run their collectives concurrently.
+int constexpr kNbCommLanes = 2;
+
+/// @brief The communication lane of the engine enqueues of the calling thread, 0 unless a CommLaneScope is active.
+/// @details Collective plugins run the collectives of every lane on a communicator of their own, so that two execution
+/// contexts enqueued on different streams never interleave their operations on one communicator.
+int getCommLane() noexcept;
+
+/// @brief Sets the communication lane of the calling thread while it is alive.
+class CommLaneScope
+{
+public:
+    explicit CommLaneScope(int lane);
+
+    ~CommLaneScope();
+
+    CommLaneScope(CommLaneScope const&) = delete;
+    CommLaneScope& operator=(CommLaneScope const&) = delete;
+
+private:
+    int mPreviousLane;
+};
+
+} // namespace tensorrt_llm::common
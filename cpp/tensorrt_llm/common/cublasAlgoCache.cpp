@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/cublasAlgoCache.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/stringUtils.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace tensorrt_llm::common
+{
+
+namespace
+{
+
+std::string getTemporarySuffix()
+{
+#if defined(_WIN32)
+    auto const pid = _getpid();
+#else
+    auto const pid = getpid();
+#endif
+    return ".tmp." + std::to_string(pid);
+}
+
+int roundUpToPowerOfTwo(int v)
+{
+    int rounded = 1;
+    while (rounded < v)
+    {
+        rounded *= 2;
+    }
+    return rounded;
+}
+
+} // namespace
+
+CublasAlgoCache::CublasAlgoCache(std::string path)
+    : mPath(std::move(path))
+{
+}
+
+std::string const& CublasAlgoCache::getEnvironmentKey()
+{
+    static std::string const key = []()
+    {
+        std::ostringstream os;
+        os << "sm" << getSMVersion() << " cublasLt" << cublasLtGetVersion();
+        return os.str();
+    }();
+    return key;
+}
+
+std::string CublasAlgoCache::getKey(std::string const& environment, cublasOperation_t transa,
+    cublasOperation_t transb, int m, int n, int k, int lda, int ldb, int ldc, cudaDataType_t aType,
+    cudaDataType_t bType, cudaDataType_t cType, cublasComputeType_t computeType, cudaDataType_t scaleType)
+{
+    bool const isTransA = transa != CUBLAS_OP_N;
+    bool const isTransB = transb != CUBLAS_OP_N;
+    std::ostringstream os;
+    os << environment << ' ' << (isTransA ? 'T' : 'N') << (isTransB ? 'T' : 'N') << " m=" << m
+       << " n=" << roundUpToPowerOfTwo(n) << " k=" << k << " pad=" << lda - (isTransA ? k : m) << ','
+       << ldb - (isTransB ? n : k) << ',' << ldc - m << " types=" << static_cast<int>(aType) << ','
+       << static_cast<int>(bType) << ',' << static_cast<int>(cType) << " compute=" << static_cast<int>(computeType)
+       << " scale=" << static_cast<int>(scaleType);
+    return os.str();
+}
+
+std::optional<cublasLtMatmulAlgo_t> CublasAlgoCache::lookup(std::string const& key) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto const it = mEntries.find(key);
+    if (it == mEntries.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void CublasAlgoCache::store(std::string const& key, cublasLtMatmulAlgo_t const& algo)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries[key] = algo;
+}
+
+size_t CublasAlgoCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+bool CublasAlgoCache::load(std::istream& is)
+{
+    std::vector<std::pair<std::string, cublasLtMatmulAlgo_t>> entries;
+    std::string line;
+    while (std::getline(is, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        auto const separator = line.find(' ');
+        auto const bytes = separator == std::string::npos ? std::nullopt : fromHex(line.substr(0, separator));
+        if (!bytes || bytes->size() != sizeof(cublasLtMatmulAlgo_t) || separator + 1 >= line.size())
+        {
+            TLLM_LOG_WARNING("Malformed cuBLASLt algo cache entry '%s'.", line.c_str());
+            return false;
+        }
+        cublasLtMatmulAlgo_t algo;
+        std::memcpy(&algo, bytes->data(), sizeof(cublasLtMatmulAlgo_t));
+        entries.emplace_back(line.substr(separator + 1), algo);
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto& [key, algo] : entries)
+    {
+        // Entries of this process are newer than the ones on disk.
+        mEntries.emplace(std::move(key), algo);
+    }
+    return true;
+}
+
+void CublasAlgoCache::save(std::ostream& os) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    os << "# <hex algo> <environment> <transposes> m=<m> n=<n bucket> k=<k> pad=<a,b,c> types=<a,b,c> "
+          "compute=<type> scale=<type>\n";
+    for (auto const& [key, algo] : mEntries)
+    {
+        os << toHex(std::string(reinterpret_cast<char const*>(&algo), sizeof(cublasLtMatmulAlgo_t))) << ' ' << key
+           << '\n';
+    }
+}
+
+bool CublasAlgoCache::flush()
+{
+    {
+        std::ifstream file(mPath);
+        if (file)
+        {
+            load(file);
+        }
+    }
+
+    std::error_code ec;
+    auto const tmpPath = mPath + getTemporarySuffix();
+    {
+        std::ofstream file(tmpPath, std::ios::trunc);
+        if (file)
+        {
+            save(file);
+        }
+        if (!file)
+        {
+            TLLM_LOG_WARNING("Cannot write the cuBLASLt algo cache %s.", tmpPath.c_str());
+            file.close();
+            fs::remove(tmpPath, ec);
+            return false;
+        }
+    }
+    fs::rename(tmpPath, mPath, ec);
+    if (ec)
+    {
+        TLLM_LOG_WARNING("Cannot publish the cuBLASLt algo cache %s: %s", mPath.c_str(), ec.message().c_str());
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+CublasAlgoCache* CublasAlgoCache::getGlobal()
+{
+    static std::unique_ptr<CublasAlgoCache> const cache = []() -> std::unique_ptr<CublasAlgoCache>
+    {
+        auto const path = getEnvCublasAlgoCacheFile();
+        if (!path)
+        {
+            return nullptr;
+        }
+        auto instance = std::make_unique<CublasAlgoCache>(*path);
+        std::ifstream file(*path);
+        if (file && instance->load(file))
+        {
+            TLLM_LOG_INFO("Loaded %zu cuBLASLt algos from %s.", instance->size(), path->c_str());
+        }
+        return instance;
+    }();
+    return cache.get();
+}
+
+} // namespace tensorrt_llm::common
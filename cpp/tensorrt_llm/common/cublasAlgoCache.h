@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cublasLt.h>
+
+#include <iosfwd>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace tensorrt_llm::common
+{
+
+// Persistent database of the cuBLASLt algos chosen for GEMM problems, shared by processes.
+//
+// The GEMM plugin profiler stores the algo that won the timing of every profiled problem, and CublasMMWrapper looks
+// up the GEMMs it runs without an algo, storing the cuBLASLt heuristic's first choice on a miss. A runtime that skipped
+// profiling thus runs the algos an engine build timed, and the heuristic runs once per problem across processes
+// instead of on every call. Algos are only valid for the cuBLASLt version and GPU they were chosen on, so keys start
+// with both and one file can serve several GPUs and toolkits. The file holds one "<hex algo> <key>" entry per line and
+// is merged and atomically replaced on every flush, like GemmTacticCache.
+class CublasAlgoCache
+{
+public:
+    explicit CublasAlgoCache(std::string path);
+
+    // Environment part of the keys, e.g. "sm90 cublasLt120401".
+    static std::string const& getEnvironmentKey();
+
+    // Key of a GEMM problem in the column-major terms of cuBLASLt. n, the dimension that follows the number of tokens
+    // for the GEMMs of TensorRT-LLM, is rounded up to a power of two like the m buckets of the GEMM plugin profiler,
+    // and the leading dimensions are kept as their padding, so that all the token counts of a bucket share an entry.
+    // The algo of an entry must be checked against the actual problem before it is used.
+    static std::string getKey(std::string const& environment, cublasOperation_t transa, cublasOperation_t transb,
+        int m, int n, int k, int lda, int ldb, int ldc, cudaDataType_t aType, cudaDataType_t bType,
+        cudaDataType_t cType, cublasComputeType_t computeType, cudaDataType_t scaleType);
+
+    [[nodiscard]] std::optional<cublasLtMatmulAlgo_t> lookup(std::string const& key) const;
+
+    void store(std::string const& key, cublasLtMatmulAlgo_t const& algo);
+
+    // Returns false and leaves the cache unchanged if the stream holds a malformed entry.
+    bool load(std::istream& is);
+
+    void save(std::ostream& os) const;
+
+    // Merge the entries on disk and write them back with the new ones. Failures are logged and return false.
+    bool flush();
+
+    [[nodiscard]] size_t size() const;
+
+    // The cache of TRTLLM_CUBLAS_ALGO_CACHE_FILE, nullptr if it isn't set.
+    static CublasAlgoCache* getGlobal();
+
+private:
+    std::string mPath;
+    mutable std::mutex mMutex;
+    std::unordered_map<std::string, cublasLtMatmulAlgo_t> mEntries;
+};
+
+} // namespace tensorrt_llm::common
@@ -16,6 +16,7 @@
 
 #include "tensorrt_llm/common/cublasMMWrapper.h"
 #include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cublasAlgoCache.h"
 #include "tensorrt_llm/common/cublasVersionCheck.h"
 #include <algorithm>
 
@@ -147,9 +148,15 @@ void CublasMMWrapper::Gemm(cublasOperation_t transa, cublasOperation_t transb, i
         {
             hasAlgo = checkTactic(transa, transb, m, n, k, lda, ldb, ldc, algo);
         }
+        std::optional<cublasLtMatmulAlgo_t> cachedAlgo;
+        if (!hasAlgo)
+        {
+            cachedAlgo = getCachedAlgo(transa, transb, m, n, k, lda, ldb, ldc);
+        }
+        cublasLtMatmulAlgo_t const* selectedAlgo = hasAlgo ? &algo : (cachedAlgo ? &*cachedAlgo : NULL);
 
         check_cuda_error(cublasLtMatmul(getCublasLtHandle(), mOperationDesc, alpha, A, mADesc, B, mBDesc, beta, C,
-            mCDesc, C, mCDesc, (hasAlgo ? (&algo) : NULL), mCublasWorkspace, workspaceSize, mStream));
+            mCDesc, C, mCDesc, selectedAlgo, mCublasWorkspace, workspaceSize, mStream));
 
         sync_check_cuda_error();
     }
@@ -298,6 +305,52 @@ bool CublasMMWrapper::checkTactic(cublasOperation_t transa, cublasOperation_t tr
     return true;
 }
 
+std::optional<cublasLtMatmulAlgo_t> CublasMMWrapper::getCachedAlgo(cublasOperation_t transa, cublasOperation_t transb,
+    int const m, int const n, int const k, int const lda, int const ldb, int const ldc)
+{
+    auto* algoCache = CublasAlgoCache::getGlobal();
+    if (algoCache == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    auto const key = CublasAlgoCache::getKey(CublasAlgoCache::getEnvironmentKey(), transa, transb, m, n, k, lda, ldb,
+        ldc, mAType, mBType, mCType, mComputeType, mScaleType);
+    auto const cached = algoCache->lookup(key);
+    if (cached)
+    {
+        // Other problems of the n bucket may not support the algo
+        return checkTactic(transa, transb, m, n, k, lda, ldb, ldc, *cached) ? cached : std::nullopt;
+    }
+
+    auto const heuristics = getTactics(transa, transb, m, n, k, lda, ldb, ldc);
+    auto const it = std::find_if(heuristics.begin(), heuristics.end(),
+        [](cublasLtMatmulHeuristicResult_t const& heuristic)
+        { return heuristic.state == CUBLAS_STATUS_SUCCESS && heuristic.workspaceSize <= CUBLAS_WORKSPACE_SIZE; });
+    if (it == heuristics.end())
+    {
+        return std::nullopt;
+    }
+    algoCache->store(key, it->algo);
+    algoCache->flush();
+    return it->algo;
+}
+
+void CublasMMWrapper::storeCachedAlgo(cublasOperation_t transa, cublasOperation_t transb, int const m, int const n,
+    int const k, int const lda, int const ldb, int const ldc, cublasLtMatmulAlgo_t const& algo)
+{
+    auto* algoCache = CublasAlgoCache::getGlobal();
+    if (algoCache == nullptr)
+    {
+        return;
+    }
+
+    algoCache->store(CublasAlgoCache::getKey(CublasAlgoCache::getEnvironmentKey(), transa, transb, m, n, k, lda, ldb,
+                         ldc, mAType, mBType, mCType, mComputeType, mScaleType),
+        algo);
+    algoCache->flush();
+}
+
 std::vector<cublasLtMatmulHeuristicResult_t> CublasMMWrapper::getTactics(cublasOperation_t transa,
     cublasOperation_t transb, int const m, int const n, int const k, int const lda, int const ldb, int const ldc)
 {
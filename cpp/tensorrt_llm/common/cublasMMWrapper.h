@@ -104,6 +104,15 @@ public:
         cublasLtMatmulDesc_t computeDesc, cublasLtMatrixLayout_t Adesc, cublasLtMatrixLayout_t Bdesc,
         cublasLtMatrixLayout_t Cdesc, cublasLtMatrixLayout_t Ddesc);
 
+    // The algo of the problem in CublasAlgoCache for the current GEMM config. On a miss, the first result of the
+    // cuBLASLt heuristic is stored for the next processes. std::nullopt if the cache is disabled or no algo fits.
+    std::optional<cublasLtMatmulAlgo_t> getCachedAlgo(cublasOperation_t transa, cublasOperation_t transb, int const m,
+        int const n, int const k, int const lda, int const ldb, int const ldc);
+
+    // Store the algo chosen for the problem, e.g. by profiling, in CublasAlgoCache, if it is enabled.
+    void storeCachedAlgo(cublasOperation_t transa, cublasOperation_t transb, int const m, int const n, int const k,
+        int const lda, int const ldb, int const ldc, cublasLtMatmulAlgo_t const& algo);
+
     using MatrixLayout = std::tuple<cudaDataType_t, cublasLtOrder_t, uint64_t, uint64_t>;
     using cache_idx_t = std::tuple<cublasLtMatmulDesc_t, std::array<MatrixLayout, 4>>;
 
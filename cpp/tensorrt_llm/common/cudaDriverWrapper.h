@@ -82,6 +82,46 @@ public:
 
     CUresult cuMemcpyDtoH(void* dstHost, CUdeviceptr srcDevice, size_t ByteCount) const;
 
+    CUresult cuDeviceGetAttribute(int* pi, CUdevice_attribute attrib, CUdevice dev) const;
+
+    CUresult cuMemCreate(CUmemGenericAllocationHandle* handle, size_t size, CUmemAllocationProp const* prop,
+        unsigned long long flags) const;
+
+    CUresult cuMemRelease(CUmemGenericAllocationHandle handle) const;
+
+    CUresult cuMemAddressReserve(
+        CUdeviceptr* ptr, size_t size, size_t alignment, CUdeviceptr addr, unsigned long long flags) const;
+
+    CUresult cuMemAddressFree(CUdeviceptr ptr, size_t size) const;
+
+    CUresult cuMemMap(CUdeviceptr ptr, size_t size, size_t offset, CUmemGenericAllocationHandle handle,
+        unsigned long long flags) const;
+
+    CUresult cuMemUnmap(CUdeviceptr ptr, size_t size) const;
+
+    CUresult cuMemSetAccess(CUdeviceptr ptr, size_t size, CUmemAccessDesc const* desc, size_t count) const;
+
+    CUresult cuMemGetAllocationGranularity(
+        size_t* granularity, CUmemAllocationProp const* prop, CUmemAllocationGranularity_flags option) const;
+
+    CUresult cuMemExportToShareableHandle(void* shareableHandle, CUmemGenericAllocationHandle handle,
+        CUmemAllocationHandleType handleType, unsigned long long flags) const;
+
+    CUresult cuMemImportFromShareableHandle(
+        CUmemGenericAllocationHandle* handle, void* osHandle, CUmemAllocationHandleType shHandleType) const;
+
+    CUresult cuMulticastCreate(CUmemGenericAllocationHandle* mcHandle, CUmulticastObjectProp const* prop) const;
+
+    CUresult cuMulticastAddDevice(CUmemGenericAllocationHandle mcHandle, CUdevice dev) const;
+
+    CUresult cuMulticastBindMem(CUmemGenericAllocationHandle mcHandle, size_t mcOffset,
+        CUmemGenericAllocationHandle memHandle, size_t memOffset, size_t size, unsigned long long flags) const;
+
+    CUresult cuMulticastUnbind(CUmemGenericAllocationHandle mcHandle, CUdevice dev, size_t mcOffset, size_t size) const;
+
+    CUresult cuMulticastGetGranularity(
+        size_t* granularity, CUmulticastObjectProp const* prop, CUmulticastGranularity_flags option) const;
+
 private:
     void* handle;
     CUresult (*_cuGetErrorName)(CUresult, char const**);
@@ -106,6 +146,25 @@ private:
         cuuint32_t const* boxDim, cuuint32_t const* elementStrides, CUtensorMapInterleave interleave,
         CUtensorMapSwizzle swizzle, CUtensorMapL2promotion l2Promotion, CUtensorMapFloatOOBfill oobFill);
     CUresult (*_cuMemcpyDtoH)(void* dstHost, CUdeviceptr srcDevice, size_t ByteCount);
+    CUresult (*_cuDeviceGetAttribute)(int*, CUdevice_attribute, CUdevice);
+    CUresult (*_cuMemCreate)(CUmemGenericAllocationHandle*, size_t, CUmemAllocationProp const*, unsigned long long);
+    CUresult (*_cuMemRelease)(CUmemGenericAllocationHandle);
+    CUresult (*_cuMemAddressReserve)(CUdeviceptr*, size_t, size_t, CUdeviceptr, unsigned long long);
+    CUresult (*_cuMemAddressFree)(CUdeviceptr, size_t);
+    CUresult (*_cuMemMap)(CUdeviceptr, size_t, size_t, CUmemGenericAllocationHandle, unsigned long long);
+    CUresult (*_cuMemUnmap)(CUdeviceptr, size_t);
+    CUresult (*_cuMemSetAccess)(CUdeviceptr, size_t, CUmemAccessDesc const*, size_t);
+    CUresult (*_cuMemGetAllocationGranularity)(
+        size_t*, CUmemAllocationProp const*, CUmemAllocationGranularity_flags);
+    CUresult (*_cuMemExportToShareableHandle)(
+        void*, CUmemGenericAllocationHandle, CUmemAllocationHandleType, unsigned long long);
+    CUresult (*_cuMemImportFromShareableHandle)(CUmemGenericAllocationHandle*, void*, CUmemAllocationHandleType);
+    CUresult (*_cuMulticastCreate)(CUmemGenericAllocationHandle*, CUmulticastObjectProp const*);
+    CUresult (*_cuMulticastAddDevice)(CUmemGenericAllocationHandle, CUdevice);
+    CUresult (*_cuMulticastBindMem)(
+        CUmemGenericAllocationHandle, size_t, CUmemGenericAllocationHandle, size_t, size_t, unsigned long long);
+    CUresult (*_cuMulticastUnbind)(CUmemGenericAllocationHandle, CUdevice, size_t, size_t);
+    CUresult (*_cuMulticastGetGranularity)(size_t*, CUmulticastObjectProp const*, CUmulticastGranularity_flags);
 };
 
 inline void cuErrCheck_(CUresult stat, CUDADriverWrapper const* wrap, char const* file, int line)
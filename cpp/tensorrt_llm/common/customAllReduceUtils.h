@@ -22,6 +22,14 @@ namespace tensorrt_llm::utils::customAllReduceUtils
 {
 
 constexpr size_t NUM_POINTERS_PER_RANK = 4;
+// The NVLS unicast and multicast pointers, stored after the NUM_POINTERS_PER_RANK pointers and the barrier flag.
+constexpr size_t NUM_NVLS_POINTERS = 2;
+
+//! Whether a workspace of workspaceSize int64 elements holds the NVLS pointers.
+inline bool hasNvlsPointers(size_t workspaceSize, int worldSize) noexcept
+{
+    return workspaceSize >= NUM_POINTERS_PER_RANK * worldSize + 1 + NUM_NVLS_POINTERS;
+}
 
 // WARNING: MUST BE KEPT IN SYNC with tensorrt_llm/plugin/plugin.py
 inline size_t getMaxRequiredWorkspaceSize(int worldSize) noexcept
@@ -18,7 +18,9 @@
 #include "envUtils.h"
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/logger.h"
+#include <algorithm>
 #include <cstdlib>
+#include <thread>
 
 namespace tensorrt_llm::common
 {
@@ -73,6 +75,76 @@ std::optional<bool> getEnvEnableXQAJIT()
     }
 }
 
+std::optional<std::string> getEnvXQAJITCacheDir()
+{
+    static std::optional<std::string> const cacheDir = []() -> std::optional<std::string>
+    {
+        char const* const env = std::getenv("TRTLLM_XQA_JIT_CACHE_DIR");
+        if (env == nullptr || env[0] == '\0')
+        {
+            return std::nullopt;
+        }
+        return std::string{env};
+    }();
+    return cacheDir;
+}
+
+std::optional<std::string> getEnvMmhaMultiBlockTuningFile()
+{
+    static std::optional<std::string> const tuningFile = []() -> std::optional<std::string>
+    {
+        char const* const env = std::getenv("TRTLLM_MMHA_MULTI_BLOCK_TUNING_FILE");
+        if (env == nullptr || env[0] == '\0')
+        {
+            return std::nullopt;
+        }
+        return std::string{env};
+    }();
+    return tuningFile;
+}
+
+std::optional<std::string> getEnvGemmTacticCacheFile()
+{
+    static std::optional<std::string> const cacheFile = []() -> std::optional<std::string>
+    {
+        char const* const env = std::getenv("TRTLLM_GEMM_TACTIC_CACHE_FILE");
+        if (env == nullptr || env[0] == '\0')
+        {
+            return std::nullopt;
+        }
+        return std::string{env};
+    }();
+    return cacheFile;
+}
+
+std::optional<std::string> getEnvCublasAlgoCacheFile()
+{
+    static std::optional<std::string> const cacheFile = []() -> std::optional<std::string>
+    {
+        char const* const env = std::getenv("TRTLLM_CUBLAS_ALGO_CACHE_FILE");
+        if (env == nullptr || env[0] == '\0')
+        {
+            return std::nullopt;
+        }
+        return std::string{env};
+    }();
+    return cacheFile;
+}
+
+std::optional<std::string> getEnvAllReduceStrategyTableFile()
+{
+    static std::optional<std::string> const tableFile = []() -> std::optional<std::string>
+    {
+        char const* const env = std::getenv("TRTLLM_ALLREDUCE_STRATEGY_TABLE_FILE");
+        if (env == nullptr || env[0] == '\0')
+        {
+            return std::nullopt;
+        }
+        return std::string{env};
+    }();
+    return tableFile;
+}
+
 // Tune the number of blocks per sequence for accuracy/performance purpose.
 bool getEnvMmhaMultiblockDebug()
 {
@@ -157,4 +229,118 @@ bool getEnvEnablePDL()
     return enablePDL;
 }
 
+std::optional<int32_t> getEnvMaxConcurrentEngineReads()
+{
+    static std::optional<int32_t> const maxConcurrentReads = getIntEnv("TRTLLM_MAX_CONCURRENT_ENGINE_READS");
+    return maxConcurrentReads;
+}
+
+std::optional<int32_t> getEnvCascadeAttentionMinPrefixBlocks()
+{
+    static std::optional<int32_t> const minPrefixBlocks = getIntEnv("TRTLLM_CASCADE_ATTENTION_MIN_PREFIX_BLOCKS");
+    return minPrefixBlocks;
+}
+
+bool getEnvDisableGqaGenerationAttention()
+{
+    static bool const disable = (getIntEnv("TRTLLM_DISABLE_GQA_GENERATION_ATTENTION").value_or(0) == 1);
+    return disable;
+}
+
+bool getEnvMoeLoadStats()
+{
+    static bool const moeLoadStats = (getIntEnv("TRTLLM_MOE_LOAD_STATS").value_or(0) == 1);
+    return moeLoadStats;
+}
+
+bool getEnvPipelineAsyncSend()
+{
+    static bool const asyncSend = (getIntEnv("TRTLLM_PP_ASYNC_SEND").value_or(0) == 1);
+    return asyncSend;
+}
+
+bool getEnvStreamMemPools()
+{
+    static bool const streamMemPools = (getIntEnv("TRTLLM_STREAM_MEMPOOLS").value_or(0) == 1);
+    return streamMemPools;
+}
+
+std::optional<int32_t> getEnvStreamMemPoolReleaseThresholdMB()
+{
+    static std::optional<int32_t> const releaseThreshold = getIntEnv("TRTLLM_STREAM_MEMPOOL_RELEASE_THRESHOLD_MB");
+    return releaseThreshold;
+}
+
+std::optional<int32_t> getEnvEmergencyMemPoolSizeMB()
+{
+    static std::optional<int32_t> const emergencySize = getIntEnv("TRTLLM_EMERGENCY_MEMPOOL_MB");
+    return emergencySize;
+}
+
+std::optional<int32_t> getEnvPromptEmbeddingCacheSizeMB()
+{
+    static std::optional<int32_t> const cacheSize = getIntEnv("TRTLLM_PROMPT_EMBEDDING_CACHE_MB");
+    return cacheSize;
+}
+
+std::optional<int32_t> getEnvPromptEmbeddingCacheHostSizeMB()
+{
+    static std::optional<int32_t> const hostSize = getIntEnv("TRTLLM_PROMPT_EMBEDDING_CACHE_HOST_MB");
+    return hostSize;
+}
+
+std::optional<int32_t> getEnvWeightStreamingHeadroomMB()
+{
+    static std::optional<int32_t> const headroom = getIntEnv("TRTLLM_WEIGHT_STREAMING_HEADROOM_MB");
+    return headroom;
+}
+
+bool getEnvShareEngines()
+{
+    static bool const shareEngines = (getIntEnv("TRTLLM_SHARE_ENGINES").value_or(0) == 1);
+    return shareEngines;
+}
+
+int getEnvWeightPreprocessThreads()
+{
+    static int const numThreads = []
+    {
+        auto const fromEnv = getIntEnv("TRTLLM_WEIGHT_PREPROCESS_THREADS");
+        return fromEnv.value_or(std::max(static_cast<int32_t>(std::thread::hardware_concurrency()), 1));
+    }();
+    return numThreads;
+}
+
+std::optional<int32_t> getEnvKvCacheScaleCalibrationSteps()
+{
+    static std::optional<int32_t> const steps = getIntEnv("TRTLLM_KV_CACHE_SCALE_CALIBRATION_STEPS");
+    return steps;
+}
+
+std::optional<std::string> getEnvLoraDeviceCacheDataType()
+{
+    static std::optional<std::string> const dataType = []() -> std::optional<std::string>
+    {
+        char const* const env = std::getenv("TRTLLM_LORA_DEVICE_CACHE_DTYPE");
+        if (env == nullptr || env[0] == '\0')
+        {
+            return std::nullopt;
+        }
+        return std::string{env};
+    }();
+    return dataType;
+}
+
+std::optional<int32_t> getEnvLookaheadSharedPoolKeys()
+{
+    static std::optional<int32_t> const keys = getIntEnv("TRTLLM_LOOKAHEAD_SHARED_POOL_KEYS");
+    return keys;
+}
+
+bool getEnvOverlapEncoder()
+{
+    static bool const overlapEncoder = (getIntEnv("TRTLLM_OVERLAP_ENCODER").value_or(0) == 1);
+    return overlapEncoder;
+}
+
 } // namespace tensorrt_llm::common
@@ -18,6 +18,7 @@
 #pragma once
 #include <cstdint>
 #include <optional>
+#include <string>
 
 namespace tensorrt_llm::common
 {
@@ -30,6 +31,12 @@ bool forceXQAKernels();
 // Returns the value of TRTLLM_ENABLE_XQA_JIT env var. If such env var doesn't exist, std::nullopt is returned.
 std::optional<bool> getEnvEnableXQAJIT();
 
+// Directory of the persistent cache for XQA JIT cubins.
+//
+// Returns the value of TRTLLM_XQA_JIT_CACHE_DIR env var. If it doesn't exist or is empty, std::nullopt is returned and
+// cubins are compiled by every process.
+std::optional<std::string> getEnvXQAJITCacheDir();
+
 // Tune the number of blocks per sequence for accuracy/performance purpose.
 bool getEnvMmhaMultiblockDebug();
 
@@ -37,7 +44,136 @@ int getEnvMmhaBlocksPerSequence();
 
 int getEnvMmhaKernelBlockSize();
 
+// File of tuned numbers of blocks per sequence of the MMHA multi-block mode, see MultiBlockTuningTable.
+//
+// Returns the value of TRTLLM_MMHA_MULTI_BLOCK_TUNING_FILE env var. If it doesn't exist or is empty, std::nullopt is
+// returned and the number of blocks is chosen by a heuristic.
+std::optional<std::string> getEnvMmhaMultiBlockTuningFile();
+
+// File of GEMM tactics shared by engine builds.
+//
+// Returns the value of TRTLLM_GEMM_TACTIC_CACHE_FILE env var. If it doesn't exist or is empty, std::nullopt is returned
+// and every build profiles its GEMMs.
+std::optional<std::string> getEnvGemmTacticCacheFile();
+
+// File of cuBLASLt algos shared by the GEMM plugin profiler and CublasMMWrapper, see CublasAlgoCache.
+//
+// Returns the value of TRTLLM_CUBLAS_ALGO_CACHE_FILE env var. If it doesn't exist or is empty, std::nullopt is returned
+// and GEMMs without an algo let cuBLASLt pick one on every call.
+std::optional<std::string> getEnvCublasAlgoCacheFile();
+
+// File of measured all-reduce strategies, see AllReduceStrategyTable.
+//
+// Returns the value of TRTLLM_ALLREDUCE_STRATEGY_TABLE_FILE env var. If it doesn't exist or is empty, std::nullopt is
+// returned and the AUTO all-reduce strategy uses its built-in message size thresholds.
+std::optional<std::string> getEnvAllReduceStrategyTableFile();
+
 // Whether PDL is enabled.
 bool getEnvEnablePDL();
 
+// Maximum number of ranks of a node that read their engine at the same time during startup.
+//
+// Returns the value of TRTLLM_MAX_CONCURRENT_ENGINE_READS env var. If it doesn't exist or is not positive,
+// std::nullopt is returned and all ranks read at once.
+std::optional<int32_t> getEnvMaxConcurrentEngineReads();
+
+// Smallest KV cache prefix, in blocks, that generation sequences must share to use cascade attention.
+//
+// Returns the value of TRTLLM_CASCADE_ATTENTION_MIN_PREFIX_BLOCKS env var. If it doesn't exist or is not positive,
+// std::nullopt is returned and cascade attention is disabled.
+std::optional<int32_t> getEnvCascadeAttentionMinPrefixBlocks();
+
+// Whether the generation phase of grouped-query attention falls back to the masked MHA kernels rather than to the
+// tensor-core GQA kernels when XQA does not support the configuration, see kernels::invokeGqaGenerationAttention.
+//
+// Returns true if the TRTLLM_DISABLE_GQA_GENERATION_ATTENTION env var is set to 1.
+bool getEnvDisableGqaGenerationAttention();
+
+// Whether the MoE layers count the tokens routed to each expert, see runtime::MoeLoadCounters.
+//
+// Returns true if the TRTLLM_MOE_LOAD_STATS env var is set to 1.
+bool getEnvMoeLoadStats();
+
+// Whether the send plugin of pipeline parallel engines sends its activations on a side stream, so that the next micro
+// batch computes while they are in flight.
+//
+// Returns true if the TRTLLM_PP_ASYNC_SEND env var is set to 1.
+bool getEnvPipelineAsyncSend();
+
+// Whether the decoder, copy and LoRA streams allocate from memory pools of their own instead of the primary pool, see
+// runtime::MemoryPoolClass.
+//
+// Returns true if the TRTLLM_STREAM_MEMPOOLS env var is set to 1.
+bool getEnvStreamMemPools();
+
+// Reserved memory, in MiB, above which the pools of the side streams return memory to the device.
+//
+// Returns the value of TRTLLM_STREAM_MEMPOOL_RELEASE_THRESHOLD_MB env var. If it doesn't exist or is not positive,
+// std::nullopt is returned and the pools keep up to 64 MiB.
+std::optional<int32_t> getEnvStreamMemPoolReleaseThresholdMB();
+
+// Memory, in MiB, reserved up front for the emergency pool that allocations of the forward pass fall back to.
+//
+// Returns the value of TRTLLM_EMERGENCY_MEMPOOL_MB env var. If it doesn't exist or is not positive, std::nullopt is
+// returned and no emergency pool is created.
+std::optional<int32_t> getEnvEmergencyMemPoolSizeMB();
+
+// Device memory, in MiB, of the cache of prompt embedding tables that requests reference by id, see
+// runtime::PromptEmbeddingCache.
+//
+// Returns the value of TRTLLM_PROMPT_EMBEDDING_CACHE_MB env var. If it doesn't exist or is not positive, std::nullopt
+// is returned and tables are not cached.
+std::optional<int32_t> getEnvPromptEmbeddingCacheSizeMB();
+
+// Pinned host memory, in MiB, that the prompt embedding cache spills tables evicted from the device to.
+//
+// Returns the value of TRTLLM_PROMPT_EMBEDDING_CACHE_HOST_MB env var. If it doesn't exist or is not positive,
+// std::nullopt is returned and evicted tables are dropped.
+std::optional<int32_t> getEnvPromptEmbeddingCacheHostSizeMB();
+
+// Free device memory, in MiB, to keep when adapting the weight streaming budget between iterations, see
+// runtime::WeightStreamingBudget.
+//
+// Returns the value of TRTLLM_WEIGHT_STREAMING_HEADROOM_MB env var. If it doesn't exist or is not positive,
+// std::nullopt is returned and the budget stays at the one set by gpu_weights_percent.
+std::optional<int32_t> getEnvWeightStreamingHeadroomMB();
+
+// Whether runtimes of the same engine file or buffer in one process share the deserialized engine and its weights,
+// see runtime::EngineRegistry.
+//
+// Returns true if the TRTLLM_SHARE_ENGINES env var is set to 1.
+bool getEnvShareEngines();
+
+// Number of host threads preprocessing quantized weights for the mixed type GEMMs, see
+// kernels::cutlass_kernels::preprocess_weights_for_mixed_gemm.
+//
+// Returns the value of TRTLLM_WEIGHT_PREPROCESS_THREADS env var. If it doesn't exist or is not positive, the number of
+// hardware threads is returned.
+int getEnvWeightPreprocessThreads();
+
+// Number of context steps during which the attention layers of an engine with an 8-bit kv cache calibrate the cache
+// scales from the K and V values they write, instead of using the kv_cache_scaling_factor of the checkpoint.
+//
+// Returns the value of TRTLLM_KV_CACHE_SCALE_CALIBRATION_STEPS env var. If it doesn't exist or is not positive,
+// std::nullopt is returned and the scales of the engine are used.
+std::optional<int32_t> getEnvKvCacheScaleCalibrationSteps();
+
+// Data type of the device LoRA cache pages, "int8" or "fp8" to store the adapters quantized with per-row scales.
+//
+// Returns the value of TRTLLM_LORA_DEVICE_CACHE_DTYPE env var. If it doesn't exist or is empty, std::nullopt is
+// returned and the adapters are stored in the model data type.
+std::optional<std::string> getEnvLoraDeviceCacheDataType();
+
+// Number of keys of the n-gram pool the lookahead requests of a model share, see LookaheadSharedPool.
+//
+// Returns the value of TRTLLM_LOOKAHEAD_SHARED_POOL_KEYS env var. If it doesn't exist or is not positive,
+// std::nullopt is returned and every request only guesses from its own n-grams.
+std::optional<int32_t> getEnvLookaheadSharedPoolKeys();
+
+// Whether the executor of an encoder-decoder model runs the encoder on a stream of its own, overlapped with the
+// decoder iterations, see runtime::AsyncEncoderRunner.
+//
+// Returns true if the TRTLLM_OVERLAP_ENCODER env var is set to 1.
+bool getEnvOverlapEncoder();
+
 } // namespace tensorrt_llm::common
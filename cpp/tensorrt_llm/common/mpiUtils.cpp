@@ -22,6 +22,7 @@
 
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/startupProfiler.h"
 #include "tensorrt_llm/runtime/common.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 
@@ -154,7 +155,10 @@ void initialize(MpiThreadSupport threadMode, bool forwardAbortToParent)
         TLLM_LOG_INFO("Initializing MPI with thread mode %d", threadMode);
         int providedMode;
         auto requiredMode = static_cast<int>(threadMode);
-        MPICHECK(MPI_Init_thread(nullptr, nullptr, requiredMode, &providedMode));
+        {
+            common::StartupProfiler::ScopedPhase const startupPhase{common::StartupPhase::kMPI_INIT};
+            MPICHECK(MPI_Init_thread(nullptr, nullptr, requiredMode, &providedMode));
+        }
         TLLM_CHECK_WITH_INFO(providedMode >= requiredMode, "MPI_Init_thread failed");
         std::atexit([]() { MPI_Finalize(); });
 
@@ -337,10 +341,75 @@ bool MpiComm::iprobe(int source, int tag, MPI_Status* status) const
 
 void MpiComm::recvPoll(int source, int tag, int periodMs) const
 {
+    PollConfig config;
+    config.maxSleep = std::chrono::milliseconds(periodMs);
+    config.minSleep = std::min(config.minSleep, config.maxSleep);
+    recvPoll(source, tag, config);
+}
+
+void MpiComm::recvPoll(int source, int tag, PollConfig const& config) const
+{
+    using Clock = std::chrono::steady_clock;
     MPI_Status status;
+    if (config.maxSleep.count() == 0)
+    {
+        while (!iprobe(source, tag, &status))
+        {
+        }
+        return;
+    }
+
+    auto const spinEnd = Clock::now() + config.spinDuration;
+    while (!iprobe(source, tag, &status))
+    {
+        if (Clock::now() >= spinEnd)
+        {
+            break;
+        }
+    }
+    auto sleep = std::max(config.minSleep, std::chrono::microseconds{1});
     while (!iprobe(source, tag, &status))
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds(periodMs));
+        std::this_thread::sleep_for(sleep);
+        sleep = std::min(sleep * 2, config.maxSleep);
+    }
+}
+
+void MpiComm::bcastWithHeader(std::vector<char>& payload, int root, int tag, PollConfig const& config) const
+{
+    auto const rank = getRank();
+    if (rank == root)
+    {
+        auto const size = static_cast<std::int64_t>(payload.size());
+        TLLM_CHECK_WITH_INFO(size <= std::numeric_limits<int32_t>::max(), "Payload of %ld bytes is too large", size);
+        std::vector<std::shared_ptr<MpiRequest>> requests;
+        for (int dest = 0; dest < getSize(); ++dest)
+        {
+            if (dest == root)
+            {
+                continue;
+            }
+            requests.push_back(sendAsync(&size, 1, MpiType::kINT64, dest, tag));
+            if (size > 0)
+            {
+                requests.push_back(sendAsync(payload.data(), payload.size(), MpiType::kBYTE, dest, tag));
+            }
+        }
+        for (auto const& request : requests)
+        {
+            request->wait();
+        }
+    }
+    else
+    {
+        recvPoll(root, tag, config);
+        std::int64_t size{0};
+        recv(&size, 1, MpiType::kINT64, root, tag);
+        payload.resize(size);
+        if (size > 0)
+        {
+            recv(payload.data(), payload.size(), MpiType::kBYTE, root, tag);
+        }
     }
 }
 
@@ -20,6 +20,10 @@
 #include <nvtx3/nvtx3.hpp>
 
 #include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
 
 namespace tensorrt_llm::common::nvtx
 {
@@ -39,6 +43,138 @@ inline nvtx3::color nextColor()
 #endif
 }
 
+//! \brief The NVTX domain of TensorRT-LLM, so that its ranges can be filtered apart from those of CUDA libraries.
+struct Domain
+{
+    static constexpr char const* name{"TensorRT-LLM"};
+};
+
+//! \brief The subsystems of the hot path, one NVTX category and color each.
+enum class Category : std::uint32_t
+{
+    kSCHEDULER = 1,
+    kKV = 2,
+    kDECODER = 3,
+    kCOMM = 4,
+    kLORA = 5,
+    kRESPONSE = 6,
+    //! Executor iterations and the forward of the engine
+    kEXECUTOR = 7,
+};
+
+inline char const* getCategoryName(Category category)
+{
+    switch (category)
+    {
+    case Category::kSCHEDULER: return "scheduler";
+    case Category::kKV: return "kv";
+    case Category::kDECODER: return "decoder";
+    case Category::kCOMM: return "comm";
+    case Category::kLORA: return "lora";
+    case Category::kRESPONSE: return "response";
+    case Category::kEXECUTOR: return "executor";
+    }
+    return "unknown";
+}
+
+inline nvtx3::color getCategoryColor(Category category)
+{
+    switch (category)
+    {
+    case Category::kSCHEDULER: return nvtx3::color{0xff4e79a7};
+    case Category::kKV: return nvtx3::color{0xfff28e2b};
+    case Category::kDECODER: return nvtx3::color{0xff59a14f};
+    case Category::kCOMM: return nvtx3::color{0xffe15759};
+    case Category::kLORA: return nvtx3::color{0xffb07aa1};
+    case Category::kRESPONSE: return nvtx3::color{0xff76b7b2};
+    case Category::kEXECUTOR: return nvtx3::color{0xffbab0ac};
+    }
+    return nvtx3::color{0xffffffff};
+}
+
+//! \brief Whether a profiler injected itself into NVTX, e.g. Nsight Systems. Read once per process.
+inline bool isProfilerAttached()
+{
+#ifndef NVTX_DISABLE
+    static bool const attached = std::getenv("NVTX_INJECTION64_PATH") != nullptr;
+    return attached;
+#else
+    return false;
+#endif
+}
+
+//! \brief The category of the domain, its name is registered on first use.
+inline nvtx3::category getCategory(Category category)
+{
+    static bool const registered = []
+    {
+        for (auto const c : {Category::kSCHEDULER, Category::kKV, Category::kDECODER, Category::kCOMM, Category::kLORA,
+                 Category::kRESPONSE, Category::kEXECUTOR})
+        {
+            nvtx3::named_category_in<Domain>{static_cast<nvtx3::category::id_type>(c), getCategoryName(c)};
+        }
+        return true;
+    }();
+    static_cast<void>(registered);
+    return nvtx3::category{static_cast<nvtx3::category::id_type>(category)};
+}
+
+//! \brief The requests and tokens of an iteration, appended to the range name.
+struct BatchComposition
+{
+    std::int32_t numContextRequests{0};
+    std::int32_t numGenerationRequests{0};
+    std::int64_t numTokens{0};
+};
+
+//! \brief A range of the TensorRT-LLM domain, optionally carrying the iteration as payload and the batch composition
+//! in its message.
+//! \details Without a profiler attached, construction is one branch on a cached flag: nothing is formatted and no
+//! NVTX call is made. Builds with NVTX_DISABLE compile the range away.
+class ScopedRange
+{
+public:
+    explicit ScopedRange(Category category, char const* name, std::optional<std::uint64_t> iteration = std::nullopt,
+        std::optional<BatchComposition> const& batch = std::nullopt)
+    {
+#ifndef NVTX_DISABLE
+        if (!isProfilerAttached())
+        {
+            return;
+        }
+        std::string formatted;
+        if (batch)
+        {
+            formatted = std::string{name} + " ctx=" + std::to_string(batch->numContextRequests) + " gen="
+                + std::to_string(batch->numGenerationRequests) + " tokens=" + std::to_string(batch->numTokens);
+        }
+        nvtx3::message const message = batch ? nvtx3::message{formatted} : nvtx3::message{name};
+        if (iteration)
+        {
+            mRange.emplace(nvtx3::event_attributes{
+                getCategory(category), getCategoryColor(category), nvtx3::payload{*iteration}, message});
+        }
+        else
+        {
+            mRange.emplace(nvtx3::event_attributes{getCategory(category), getCategoryColor(category), message});
+        }
+#endif
+    }
+
+    ScopedRange(ScopedRange const&) = delete;
+    ScopedRange& operator=(ScopedRange const&) = delete;
+
+private:
+#ifndef NVTX_DISABLE
+    std::optional<nvtx3::scoped_range_in<Domain>> mRange;
+#endif
+};
+
 } // namespace tensorrt_llm::common::nvtx
 
 #define NVTX3_SCOPED_RANGE(range) ::nvtx3::scoped_range range##_range(::tensorrt_llm::common::nvtx::nextColor(), #range)
+
+//! A range of the TensorRT-LLM domain in one of the categories of tensorrt_llm::common::nvtx::Category, e.g.
+//! TLLM_NVTX_SCOPED_RANGE(kDECODER, forwardAsync).
+#define TLLM_NVTX_SCOPED_RANGE(category, range)                                                                        \
+    ::tensorrt_llm::common::nvtx::ScopedRange range##_range(::tensorrt_llm::common::nvtx::Category::category, #range)
@@ -17,14 +17,27 @@
 #include "safetensors.h"
 #include "nlohmann/json.hpp"
 #include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
 #include <NvInferRuntime.h>
+#include <algorithm>
+#include <cerrno>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <map>
 #include <memory>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace tensorrt_llm::common::safetensors
 {
 using nvinfer1::DataType;
@@ -52,6 +65,95 @@ static DataType convertDataTypeStrToEnum(std::string const& str)
     TLLM_THROW("Unsupported data type: " + str);
 }
 
+#if !defined(_WIN32)
+//! Read-only shared mapping of a safetensors file, optionally registered as pinned memory.
+class FileMapping
+{
+public:
+    FileMapping(char const* filename, bool pin)
+    {
+        auto const fd = ::open(filename, O_RDONLY);
+        TLLM_CHECK_WITH_INFO(fd >= 0, "Failed to open file: %s: %s", filename, std::strerror(errno));
+        struct stat st = {};
+        if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(int64_t))
+        {
+            ::close(fd);
+            TLLM_THROW("%s is not a safetensors file", filename);
+        }
+        mSize = static_cast<std::size_t>(st.st_size);
+        auto* data = ::mmap(nullptr, mSize, PROT_READ, MAP_SHARED, fd, 0);
+        auto const err = errno;
+        ::close(fd);
+        TLLM_CHECK_WITH_INFO(data != MAP_FAILED, "Failed to map %s: %s", filename, std::strerror(err));
+        mData = static_cast<std::byte const*>(data);
+        if (pin)
+        {
+            auto const status = cudaHostRegister(data, mSize, cudaHostRegisterReadOnly);
+            if (status == cudaSuccess)
+            {
+                mPinned = true;
+            }
+            else
+            {
+                cudaGetLastError();
+                TLLM_LOG_WARNING("Failed to register %s as pinned memory: %s", filename, cudaGetErrorString(status));
+            }
+        }
+    }
+
+    ~FileMapping()
+    {
+        if (mPinned)
+        {
+            cudaHostUnregister(const_cast<std::byte*>(mData));
+        }
+        ::munmap(const_cast<std::byte*>(mData), mSize);
+    }
+
+    FileMapping(FileMapping const&) = delete;
+    FileMapping& operator=(FileMapping const&) = delete;
+
+    [[nodiscard]] std::byte const* data() const noexcept
+    {
+        return mData;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return mSize;
+    }
+
+private:
+    std::byte const* mData{nullptr};
+    std::size_t mSize{0};
+    bool mPinned{false};
+};
+
+class SafeTensorArray : public INdArray
+{
+    std::vector<int64_t> mShape;
+    DataType mDataType;
+    std::byte const* mData;
+    // Keeps the mapping alive for as long as the view
+    std::shared_ptr<FileMapping const> mMapping;
+
+public:
+    SafeTensorArray(std::shared_ptr<FileMapping const> mapping, std::string const& dtypeStr,
+        std::vector<int64_t> const& shape, int64_t offsetBegin, int64_t offsetEnd)
+        : mShape(shape)
+        , mDataType(convertDataTypeStrToEnum(dtypeStr))
+        , mData(mapping->data() + offsetBegin)
+        , mMapping(std::move(mapping))
+    {
+        TLLM_CHECK_WITH_INFO(offsetBegin <= offsetEnd && static_cast<std::size_t>(offsetEnd) <= mMapping->size(),
+            "Tensor data [%ld, %ld) exceeds the file size %zu", offsetBegin, offsetEnd, mMapping->size());
+    }
+
+    [[nodiscard]] void const* data() const override
+    {
+        return mData;
+    }
+#else
 class SafeTensorArray : public INdArray
 {
     std::vector<int64_t> mShape;
@@ -84,6 +186,7 @@ public:
 
         return mData.get();
     }
+#endif
 
     [[nodiscard]] int ndim() const override
     {
@@ -107,10 +210,25 @@ class SafeTensor : public ISafeTensor
     int64_t mJsonSize;
     std::map<std::string, std::string> mMetadata;
     std::map<std::string, nlohmann::basic_json<>> mTensorInfo;
+#if !defined(_WIN32)
+    std::shared_ptr<FileMapping const> mMapping;
+#else
     std::shared_ptr<std::ifstream> mFs;
+#endif
 
 public:
-    SafeTensor(char const* filename)
+#if !defined(_WIN32)
+    SafeTensor(char const* filename, bool pinMapping)
+        : mMapping(std::make_shared<FileMapping const>(filename, pinMapping))
+    {
+        std::memcpy(&mJsonSize, mMapping->data(), sizeof(mJsonSize));
+        TLLM_CHECK_WITH_INFO(mJsonSize >= 0 && sizeof(mJsonSize) + mJsonSize <= mMapping->size(),
+            "Invalid safetensors header size in %s", filename);
+        auto const* json = reinterpret_cast<char const*>(mMapping->data()) + sizeof(mJsonSize);
+        parseHeader(nlohmann::json::parse(json, json + mJsonSize));
+    }
+#else
+    SafeTensor(char const* filename, [[maybe_unused]] bool pinMapping)
         : mFs(new std::ifstream(filename, std::ios::binary))
     {
         if (!mFs->is_open())
@@ -120,19 +238,9 @@ public:
         mFs->read(reinterpret_cast<char*>(&mJsonSize), sizeof(mJsonSize));
         std::vector<char> jsonBuffer(mJsonSize);
         mFs->read(jsonBuffer.data(), mJsonSize);
-        nlohmann::json attributes = nlohmann::json::parse(jsonBuffer);
-        for (auto const& [key, value] : attributes.items())
-        {
-            if (key == "__metadata__")
-            {
-                mMetadata = value;
-            }
-            else
-            {
-                mTensorInfo[key] = value;
-            }
-        }
+        parseHeader(nlohmann::json::parse(jsonBuffer));
     }
+#endif
 
     std::vector<std::string> keys() override
     {
@@ -152,16 +260,87 @@ public:
         {
             auto const& value = it->second;
             int64_t offset = mJsonSize + sizeof(mJsonSize);
-            return std::make_shared<SafeTensorArray>(mFs, value["dtype"], value["shape"],
+#if !defined(_WIN32)
+            auto const& source = mMapping;
+#else
+            auto const& source = mFs;
+#endif
+            return std::make_shared<SafeTensorArray>(source, value["dtype"], value["shape"],
                 static_cast<int64_t>(value["data_offsets"][0]) + offset,
                 static_cast<int64_t>(value["data_offsets"][1]) + offset);
         }
         TLLM_THROW("Tensor not found: " + std::string(name));
     }
+
+    void prefetch(std::vector<std::string> const& names, int numThreads) override
+    {
+#if !defined(_WIN32)
+        std::vector<std::pair<int64_t, int64_t>> ranges;
+        ranges.reserve(names.size());
+        int64_t const offset = mJsonSize + sizeof(mJsonSize);
+        for (auto const& name : names)
+        {
+            auto const it = mTensorInfo.find(name);
+            TLLM_CHECK_WITH_INFO(it != mTensorInfo.end(), "Tensor not found: %s", name.c_str());
+            ranges.emplace_back(static_cast<int64_t>(it->second["data_offsets"][0]) + offset,
+                static_cast<int64_t>(it->second["data_offsets"][1]) + offset);
+        }
+
+        // Touching one byte per page faults the pages in, threads fetch interleaved tensors to spread the reads.
+        auto const pageSize = static_cast<int64_t>(::sysconf(_SC_PAGESIZE));
+        auto const* data = mMapping->data();
+        auto fetch = [&ranges, pageSize, data](std::size_t first, std::size_t stride)
+        {
+            std::uint8_t sum{0};
+            for (auto i = first; i < ranges.size(); i += stride)
+            {
+                for (auto pos = ranges[i].first; pos < ranges[i].second; pos += pageSize)
+                {
+                    sum ^= std::to_integer<std::uint8_t>(data[pos]);
+                }
+            }
+            // Keep the reads from being optimized away
+            static_cast<void>(*static_cast<std::uint8_t volatile*>(&sum));
+        };
+        auto const numWorkers = static_cast<std::size_t>(
+            std::clamp(numThreads, 1, std::max(1, static_cast<int>(ranges.size()))));
+        std::vector<std::thread> workers;
+        workers.reserve(numWorkers - 1);
+        for (std::size_t i = 1; i < numWorkers; ++i)
+        {
+            workers.emplace_back(fetch, i, numWorkers);
+        }
+        fetch(0, numWorkers);
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+#else
+        // Tensors are read on access through the shared stream, which cannot be done in parallel
+        static_cast<void>(names);
+        static_cast<void>(numThreads);
+#endif
+    }
+
+private:
+    void parseHeader(nlohmann::json const& attributes)
+    {
+        for (auto const& [key, value] : attributes.items())
+        {
+            if (key == "__metadata__")
+            {
+                mMetadata = value;
+            }
+            else
+            {
+                mTensorInfo[key] = value;
+            }
+        }
+    }
 };
 
-std::shared_ptr<ISafeTensor> ISafeTensor::open(char const* filename)
+std::shared_ptr<ISafeTensor> ISafeTensor::open(char const* filename, bool pinMapping)
 {
-    return std::make_shared<SafeTensor>(filename);
+    return std::make_shared<SafeTensor>(filename, pinMapping);
 }
 } // namespace tensorrt_llm::common::safetensors
@@ -19,9 +19,12 @@
 #include "tensorrt_llm/common/logger.h"
 #include <NvInferRuntime.h>
 #include <cstdint>
+#include <cstring>
 #include <map>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace tensorrt_llm::common::safetensors
 {
@@ -52,9 +55,15 @@ public:
 class ISafeTensor
 {
 public:
-    static std::shared_ptr<ISafeTensor> open(char const* filename);
+    //! \brief Open a safetensors file. The file is memory mapped and tensors are views into the mapping, which stays
+    //! alive as long as any of them.
+    //! \param pinMapping Register the mapping as pinned host memory, so copies to the device are direct DMA transfers.
+    //! This reads the whole file on open.
+    static std::shared_ptr<ISafeTensor> open(char const* filename, bool pinMapping = false);
     virtual std::shared_ptr<INdArray> getTensor(char const* name) = 0;
     virtual std::vector<std::string> keys() = 0;
+    //! \brief Read the data of the given tensors into host memory from numThreads threads in parallel.
+    virtual void prefetch(std::vector<std::string> const& names, int numThreads) = 0;
     virtual ~ISafeTensor() = default;
 };
 
@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/shmRingBuffer.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tensorrt_llm::common
+{
+
+namespace
+{
+std::uint64_t constexpr kMagic = 0x7472746c6c6d7368; // "trtllmsh"
+std::size_t constexpr kAlignment = 8;
+std::uint32_t constexpr kPaddingType = 0;
+
+struct RecordHeader
+{
+    std::uint32_t type;
+    std::uint32_t size;
+};
+
+static_assert(sizeof(RecordHeader) == kAlignment);
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared memory positions must be lock free");
+} // namespace
+
+struct ShmRingBuffer::Control
+{
+    std::uint64_t magic;
+    std::uint64_t capacity;
+    // Producer and consumer positions grow monotonically, the offset into the ring is position % capacity
+    alignas(64) std::atomic<std::uint64_t> head;
+    alignas(64) std::atomic<std::uint64_t> tail;
+};
+
+ShmRingBuffer ShmRingBuffer::create(std::string name, std::size_t capacity)
+{
+#if defined(_WIN32)
+    TLLM_THROW("Shared memory ring buffers are not supported on Windows");
+#else
+    TLLM_CHECK_WITH_INFO(capacity > 0 && capacity % kAlignment == 0, "Capacity %zu must be a positive multiple of %zu",
+        capacity, kAlignment);
+    auto const fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    TLLM_CHECK_WITH_INFO(fd >= 0, "Failed to create shared memory %s: %s", name.c_str(), std::strerror(errno));
+    auto const mappedSize = sizeof(Control) + capacity;
+    void* data = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(mappedSize)) == 0)
+    {
+        data = ::mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    auto const err = errno;
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        ::shm_unlink(name.c_str());
+        TLLM_THROW("Failed to map shared memory %s: %s", name.c_str(), std::strerror(err));
+    }
+    auto* control = new (data) Control{};
+    control->capacity = capacity;
+    control->head.store(0, std::memory_order_relaxed);
+    control->tail.store(0, std::memory_order_relaxed);
+    control->magic = kMagic;
+    return ShmRingBuffer{std::move(name), control, mappedSize, true};
+#endif
+}
+
+ShmRingBuffer ShmRingBuffer::open(std::string name)
+{
+#if defined(_WIN32)
+    TLLM_THROW("Shared memory ring buffers are not supported on Windows");
+#else
+    auto const fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+    TLLM_CHECK_WITH_INFO(fd >= 0, "Failed to open shared memory %s: %s", name.c_str(), std::strerror(errno));
+    struct stat st = {};
+    void* data = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) > sizeof(Control))
+    {
+        data = ::mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    auto const err = errno;
+    ::close(fd);
+    TLLM_CHECK_WITH_INFO(data != MAP_FAILED, "Failed to map shared memory %s: %s", name.c_str(), std::strerror(err));
+    auto* control = static_cast<Control*>(data);
+    auto const mappedSize = static_cast<std::size_t>(st.st_size);
+    if (control->magic != kMagic || sizeof(Control) + control->capacity != mappedSize)
+    {
+        ::munmap(data, mappedSize);
+        TLLM_THROW("Shared memory %s is not a ring buffer", name.c_str());
+    }
+    ShmRingBuffer ring{std::move(name), control, mappedSize, false};
+    ring.mPendingHead = control->head.load(std::memory_order_acquire);
+    ring.mPendingTail = control->tail.load(std::memory_order_acquire);
+    return ring;
+#endif
+}
+
+ShmRingBuffer::ShmRingBuffer(std::string name, Control* control, std::size_t mappedSize, bool owner)
+    : mName{std::move(name)}
+    , mControl{control}
+    , mMappedSize{mappedSize}
+    , mOwner{owner}
+{
+}
+
+ShmRingBuffer::ShmRingBuffer(ShmRingBuffer&& other) noexcept
+    : mName{std::move(other.mName)}
+    , mControl{std::exchange(other.mControl, nullptr)}
+    , mMappedSize{other.mMappedSize}
+    , mOwner{std::exchange(other.mOwner, false)}
+    , mPendingHead{other.mPendingHead}
+    , mPendingTail{other.mPendingTail}
+    , mHasReservation{other.mHasReservation}
+    , mHasMessage{other.mHasMessage}
+{
+}
+
+ShmRingBuffer& ShmRingBuffer::operator=(ShmRingBuffer&& other) noexcept
+{
+    // other releases the previous segment of this
+    std::swap(mName, other.mName);
+    std::swap(mControl, other.mControl);
+    std::swap(mMappedSize, other.mMappedSize);
+    std::swap(mOwner, other.mOwner);
+    std::swap(mPendingHead, other.mPendingHead);
+    std::swap(mPendingTail, other.mPendingTail);
+    std::swap(mHasReservation, other.mHasReservation);
+    std::swap(mHasMessage, other.mHasMessage);
+    return *this;
+}
+
+ShmRingBuffer::~ShmRingBuffer()
+{
+#if !defined(_WIN32)
+    if (mControl != nullptr)
+    {
+        ::munmap(mControl, mMappedSize);
+    }
+    if (mOwner)
+    {
+        ::shm_unlink(mName.c_str());
+    }
+#endif
+}
+
+std::size_t ShmRingBuffer::getCapacity() const noexcept
+{
+    return mControl->capacity;
+}
+
+std::size_t ShmRingBuffer::getRecordSize(std::size_t size) noexcept
+{
+    return (sizeof(RecordHeader) + size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+std::byte* ShmRingBuffer::getData() const noexcept
+{
+    return reinterpret_cast<std::byte*>(mControl + 1);
+}
+
+std::byte* ShmRingBuffer::tryReserve(std::uint32_t type, std::size_t size)
+{
+    TLLM_CHECK_WITH_INFO(!mHasReservation, "The previous message has not been committed");
+    TLLM_CHECK_WITH_INFO(type != kPaddingType, "Message type %u is reserved", kPaddingType);
+    auto const capacity = mControl->capacity;
+    auto const recordSize = getRecordSize(size);
+    TLLM_CHECK_WITH_INFO(recordSize <= capacity, "Message of %zu bytes exceeds ring capacity %zu", size, capacity);
+
+    auto head = mControl->head.load(std::memory_order_relaxed);
+    auto const tail = mControl->tail.load(std::memory_order_acquire);
+    auto const offset = head % capacity;
+    auto const contiguous = capacity - offset;
+    auto const paddingSize = contiguous < recordSize ? contiguous : 0;
+    if (head - tail + paddingSize + recordSize > capacity)
+    {
+        return nullptr;
+    }
+    auto* data = getData();
+    if (paddingSize > 0)
+    {
+        new (data + offset) RecordHeader{kPaddingType, static_cast<std::uint32_t>(paddingSize - sizeof(RecordHeader))};
+        head += paddingSize;
+    }
+    auto* header = new (data + head % capacity) RecordHeader{type, static_cast<std::uint32_t>(size)};
+    mPendingHead = head + recordSize;
+    mHasReservation = true;
+    return reinterpret_cast<std::byte*>(header + 1);
+}
+
+void ShmRingBuffer::commit()
+{
+    TLLM_CHECK_WITH_INFO(mHasReservation, "No message has been reserved");
+    mControl->head.store(mPendingHead, std::memory_order_release);
+    mHasReservation = false;
+}
+
+std::optional<ShmRingBuffer::Message> ShmRingBuffer::tryRead()
+{
+    TLLM_CHECK_WITH_INFO(!mHasMessage, "The previous message has not been released");
+    auto const capacity = mControl->capacity;
+    auto tail = mControl->tail.load(std::memory_order_relaxed);
+    auto const head = mControl->head.load(std::memory_order_acquire);
+    auto const* data = getData();
+    while (tail != head)
+    {
+        auto const* header = reinterpret_cast<RecordHeader const*>(data + tail % capacity);
+        auto const recordSize = getRecordSize(header->size);
+        if (header->type == kPaddingType)
+        {
+            tail += recordSize;
+            continue;
+        }
+        mPendingTail = tail + recordSize;
+        mHasMessage = true;
+        return Message{header->type, reinterpret_cast<std::byte const*>(header + 1), header->size};
+    }
+    return std::nullopt;
+}
+
+void ShmRingBuffer::release()
+{
+    TLLM_CHECK_WITH_INFO(mHasMessage, "No message has been read");
+    mControl->tail.store(mPendingTail, std::memory_order_release);
+    mHasMessage = false;
+}
+
+namespace shm
+{
+
+namespace
+{
+template <typename Flat>
+bool tryWriteFlat(ShmRingBuffer& ring, MessageType type, Flat const& flat, executor::VecTokens const& tokens)
+{
+    auto const tokensSize = tokens.size() * sizeof(executor::TokenIdType);
+    auto* data = ring.tryReserve(static_cast<std::uint32_t>(type), sizeof(Flat) + tokensSize);
+    if (data == nullptr)
+    {
+        return false;
+    }
+    std::memcpy(data, &flat, sizeof(Flat));
+    if (tokensSize > 0)
+    {
+        std::memcpy(data + sizeof(Flat), tokens.data(), tokensSize);
+    }
+    ring.commit();
+    return true;
+}
+} // namespace
+
+bool tryWriteRequest(ShmRingBuffer& ring, executor::IdType requestId, executor::VecTokens const& inputTokens,
+    executor::SizeType32 maxTokens, bool streaming)
+{
+    FlatRequest const flat{requestId, maxTokens, static_cast<executor::SizeType32>(inputTokens.size()), streaming};
+    return tryWriteFlat(ring, MessageType::kREQUEST, flat, inputTokens);
+}
+
+bool tryWriteResponse(
+    ShmRingBuffer& ring, executor::IdType requestId, executor::VecTokens const& tokens, bool isFinal)
+{
+    FlatResponse const flat{requestId, static_cast<executor::SizeType32>(tokens.size()), isFinal};
+    return tryWriteFlat(ring, MessageType::kRESPONSE, flat, tokens);
+}
+
+FlatRequest const& asRequest(ShmRingBuffer::Message const& message)
+{
+    TLLM_CHECK_WITH_INFO(message.type == static_cast<std::uint32_t>(MessageType::kREQUEST), "Message is no request");
+    auto const& flat = *reinterpret_cast<FlatRequest const*>(message.data);
+    TLLM_CHECK(message.size == sizeof(FlatRequest) + flat.numInputTokens * sizeof(executor::TokenIdType));
+    return flat;
+}
+
+FlatResponse const& asResponse(ShmRingBuffer::Message const& message)
+{
+    TLLM_CHECK_WITH_INFO(message.type == static_cast<std::uint32_t>(MessageType::kRESPONSE), "Message is no response");
+    auto const& flat = *reinterpret_cast<FlatResponse const*>(message.data);
+    TLLM_CHECK(message.size == sizeof(FlatResponse) + flat.numTokens * sizeof(executor::TokenIdType));
+    return flat;
+}
+
+} // namespace shm
+
+} // namespace tensorrt_llm::common
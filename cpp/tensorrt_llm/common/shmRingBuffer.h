@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tensorrt_llm::common
+{
+
+//! \brief Single-producer single-consumer ring buffer of messages in POSIX shared memory.
+//! \details Used as a same-node transport between the orchestrator and the executor workers. A message is a
+//! contiguous record, so the consumer reads it in place. Records that do not fit before the end of the ring are
+//! preceded by a padding record and start at the beginning of the ring.
+class ShmRingBuffer
+{
+public:
+    struct Message
+    {
+        std::uint32_t type;
+        std::byte const* data;
+        std::size_t size;
+    };
+
+    //! \brief Create the shared memory segment name, e.g. "/trtllm_requests_0". The creator removes it on destruction.
+    static ShmRingBuffer create(std::string name, std::size_t capacity);
+
+    //! \brief Attach to a segment created by another process. The creator must have returned from create, e.g. it sends
+    //! the name to the consumer only afterwards.
+    static ShmRingBuffer open(std::string name);
+
+    ShmRingBuffer(ShmRingBuffer&& other) noexcept;
+    ShmRingBuffer& operator=(ShmRingBuffer&& other) noexcept;
+    ShmRingBuffer(ShmRingBuffer const&) = delete;
+    ShmRingBuffer& operator=(ShmRingBuffer const&) = delete;
+    ~ShmRingBuffer();
+
+    //! \brief Reserve a message of size bytes. Returns nullptr if the ring is too full.
+    //! \details The message is visible to the consumer after commit.
+    [[nodiscard]] std::byte* tryReserve(std::uint32_t type, std::size_t size);
+
+    //! \brief Publish the reserved message.
+    void commit();
+
+    //! \brief The oldest message, if any. Its data stays valid until release.
+    [[nodiscard]] std::optional<Message> tryRead();
+
+    //! \brief Free the message returned by tryRead.
+    void release();
+
+    [[nodiscard]] std::size_t getCapacity() const noexcept;
+
+    //! \brief Bytes the ring takes for a message of size bytes.
+    [[nodiscard]] static std::size_t getRecordSize(std::size_t size) noexcept;
+
+private:
+    struct Control;
+
+    ShmRingBuffer(std::string name, Control* control, std::size_t mappedSize, bool owner);
+
+    [[nodiscard]] std::byte* getData() const noexcept;
+
+    std::string mName;
+    Control* mControl;
+    std::size_t mMappedSize;
+    bool mOwner;
+    // Positions of the uncommitted write and of the unreleased read
+    std::uint64_t mPendingHead{0};
+    std::uint64_t mPendingTail{0};
+    bool mHasReservation{false};
+    bool mHasMessage{false};
+};
+
+//! \brief Flat layouts of the messages exchanged over a ShmRingBuffer. Tokens follow the fixed fields inline.
+namespace shm
+{
+
+enum class MessageType : std::uint32_t
+{
+    kREQUEST = 1,
+    kRESPONSE = 2,
+    kITERATION_STATS = 3,
+    kREQUEST_STATS = 4,
+};
+
+struct FlatRequest
+{
+    executor::IdType requestId;
+    executor::SizeType32 maxTokens;
+    executor::SizeType32 numInputTokens;
+    bool streaming;
+
+    [[nodiscard]] executor::TokenIdType const* getInputTokens() const noexcept
+    {
+        return reinterpret_cast<executor::TokenIdType const*>(this + 1);
+    }
+};
+
+struct FlatResponse
+{
+    executor::IdType requestId;
+    executor::SizeType32 numTokens;
+    bool isFinal;
+
+    [[nodiscard]] executor::TokenIdType const* getTokens() const noexcept
+    {
+        return reinterpret_cast<executor::TokenIdType const*>(this + 1);
+    }
+};
+
+//! \brief Write a request. Returns false if the ring is too full.
+[[nodiscard]] bool tryWriteRequest(ShmRingBuffer& ring, executor::IdType requestId,
+    executor::VecTokens const& inputTokens, executor::SizeType32 maxTokens, bool streaming);
+
+//! \brief Write a response carrying new tokens. Returns false if the ring is too full.
+[[nodiscard]] bool tryWriteResponse(
+    ShmRingBuffer& ring, executor::IdType requestId, executor::VecTokens const& tokens, bool isFinal);
+
+//! \brief View a message as a request, without copying.
+[[nodiscard]] FlatRequest const& asRequest(ShmRingBuffer::Message const& message);
+
+//! \brief View a message as a response, without copying.
+[[nodiscard]] FlatResponse const& asResponse(ShmRingBuffer::Message const& message);
+
+} // namespace shm
+
+} // namespace tensorrt_llm::common
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/startupProfiler.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+namespace tensorrt_llm::common
+{
+
+StartupProfiler& StartupProfiler::getInstance()
+{
+    static StartupProfiler profiler;
+    return profiler;
+}
+
+char const* StartupProfiler::getPhaseName(StartupPhase phase)
+{
+    switch (phase)
+    {
+    case StartupPhase::kMPI_INIT: return "mpi_init";
+    case StartupPhase::kENGINE_READ: return "engine_read";
+    case StartupPhase::kTRT_DESERIALIZE: return "trt_deserialize";
+    case StartupPhase::kCONTEXT_CREATION: return "context_creation";
+    case StartupPhase::kMANAGED_WEIGHTS_LOAD: return "managed_weights_load";
+    case StartupPhase::kKV_CACHE_ALLOCATION: return "kv_cache_allocation";
+    case StartupPhase::kLORA_PRELOAD: return "lora_preload";
+    case StartupPhase::kXQA_JIT: return "xqa_jit";
+    case StartupPhase::kWARMUP: return "warmup";
+    }
+    TLLM_THROW("Unknown startup phase %d", static_cast<int>(phase));
+}
+
+void StartupProfiler::record(StartupPhase phase, Clock::time_point start, Clock::time_point end)
+{
+    auto const durationMs = std::chrono::duration<double, std::milli>(end - start).count();
+    TLLM_LOG_DEBUG("Startup phase %s took %.1f ms", getPhaseName(phase), durationMs);
+    std::lock_guard<std::mutex> const lock(mMutex);
+    auto& phaseTime = mPhases.at(static_cast<std::size_t>(phase));
+    ++phaseTime.count;
+    phaseTime.durationMs += durationMs;
+    if (!mFirstStart || start < *mFirstStart)
+    {
+        mFirstStart = start;
+    }
+    if (!mLastEnd || end > *mLastEnd)
+    {
+        mLastEnd = end;
+    }
+}
+
+executor::StartupStats StartupProfiler::getStats() const
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    executor::StartupStats stats{};
+    for (std::size_t i = 0; i < kNUM_PHASES; ++i)
+    {
+        if (mPhases[i].count > 0)
+        {
+            stats.phases.push_back(executor::StartupPhaseStats{
+                getPhaseName(static_cast<StartupPhase>(i)), mPhases[i].count, mPhases[i].durationMs});
+        }
+    }
+    if (mFirstStart)
+    {
+        stats.totalDurationMS = std::chrono::duration<double, std::milli>(*mLastEnd - *mFirstStart).count();
+    }
+    return stats;
+}
+
+void StartupProfiler::reset()
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    mPhases = {};
+    mFirstStart.reset();
+    mLastEnd.reset();
+}
+
+} // namespace tensorrt_llm::common
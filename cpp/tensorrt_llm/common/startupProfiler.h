@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/types.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+namespace tensorrt_llm::common
+{
+
+//! \brief Phases of bringing up an executor, in the order they usually run.
+enum class StartupPhase : std::int8_t
+{
+    kMPI_INIT,
+    kENGINE_READ,
+    kTRT_DESERIALIZE,
+    kCONTEXT_CREATION,
+    kMANAGED_WEIGHTS_LOAD,
+    kKV_CACHE_ALLOCATION,
+    kLORA_PRELOAD,
+    kXQA_JIT,
+    kWARMUP,
+};
+
+//! \brief Accumulates the time spent in the startup phases of the process.
+//! \details The components time themselves with ScopedPhase, the profiler of the process is a singleton because they
+//! are created far apart: MPI in mpi::initialize, the engine in TllmRuntime, the XQA kernels on the first enqueue.
+//! A phase entered several times, e.g. the context creation of every optimization profile or the JIT compilation of
+//! every kernel, sums its durations. Phases may nest, the XQA compilation runs during the warmup for example.
+class StartupProfiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t kNUM_PHASES = static_cast<std::size_t>(StartupPhase::kWARMUP) + 1;
+
+    //! \brief Times a phase from construction to destruction.
+    class ScopedPhase
+    {
+    public:
+        explicit ScopedPhase(StartupPhase phase, StartupProfiler& profiler = getInstance())
+            : mProfiler{profiler}
+            , mPhase{phase}
+            , mStart{Clock::now()}
+        {
+        }
+
+        ~ScopedPhase()
+        {
+            mProfiler.record(mPhase, mStart, Clock::now());
+        }
+
+        ScopedPhase(ScopedPhase const&) = delete;
+        ScopedPhase& operator=(ScopedPhase const&) = delete;
+
+    private:
+        StartupProfiler& mProfiler;
+        StartupPhase mPhase;
+        Clock::time_point mStart;
+    };
+
+    static StartupProfiler& getInstance();
+
+    //! \brief Name of a phase in the stats, e.g. "trt_deserialize".
+    [[nodiscard]] static char const* getPhaseName(StartupPhase phase);
+
+    void record(StartupPhase phase, Clock::time_point start, Clock::time_point end);
+
+    //! \brief The phases entered since construction or the last reset, in the order of StartupPhase.
+    //! \details The total is the wall time from the start of the first phase to the end of the last one. It is less
+    //! than the sum of the phases when they nest or run on several threads, and includes the time between them.
+    [[nodiscard]] executor::StartupStats getStats() const;
+
+    void reset();
+
+private:
+    struct PhaseTime
+    {
+        std::int32_t count{0};
+        double durationMs{0.0};
+    };
+
+    mutable std::mutex mMutex;
+    std::array<PhaseTime, kNUM_PHASES> mPhases{};
+    std::optional<Clock::time_point> mFirstStart;
+    std::optional<Clock::time_point> mLastEnd;
+};
+
+//! \brief The time spent in each phase of bringing up the executors of this process.
+//! \details Phases that did not run are left out. The XQA kernels are compiled on first use, so the stats keep growing
+//! until the warmup or the first requests have run.
+[[nodiscard]] inline executor::StartupStats getStartupStats()
+{
+    return StartupProfiler::getInstance().getStats();
+}
+
+} // namespace tensorrt_llm::common
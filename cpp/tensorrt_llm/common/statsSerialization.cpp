@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/common/statsSerialization.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/timestampUtils.h"
+
+#include <cstring>
+#include <type_traits>
+
+namespace tensorrt_llm::common
+{
+
+namespace
+{
+namespace tle = tensorrt_llm::executor;
+
+// Presence bits of the optional parts of the records
+std::uint32_t constexpr kHasKvCacheStats = 1U << 0;
+std::uint32_t constexpr kHasCrossKvCacheStats = 1U << 1;
+std::uint32_t constexpr kHasStaticBatchingStats = 1U << 2;
+std::uint32_t constexpr kHasInflightBatchingStats = 1U << 3;
+
+std::uint32_t constexpr kScheduled = 1U << 0;
+std::uint32_t constexpr kPaused = 1U << 1;
+std::uint32_t constexpr kHasDisServingStats = 1U << 2;
+
+//! Writes trivially copyable values back to back. Without data it only counts the bytes.
+class Writer
+{
+public:
+    explicit Writer(std::byte* data = nullptr)
+        : mData{data}
+    {
+    }
+
+    template <typename T>
+    void write(T const& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (mData != nullptr)
+        {
+            std::memcpy(mData + mSize, &value, sizeof(T));
+        }
+        mSize += sizeof(T);
+    }
+
+    [[nodiscard]] std::size_t getSize() const noexcept
+    {
+        return mSize;
+    }
+
+private:
+    std::byte* mData;
+    std::size_t mSize{0};
+};
+
+class Reader
+{
+public:
+    Reader(std::byte const* data, std::size_t size)
+        : mData{data}
+        , mSize{size}
+    {
+    }
+
+    template <typename T>
+    T read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        TLLM_CHECK_WITH_INFO(mOffset + sizeof(T) <= mSize, "Stats record of %zu bytes is truncated", mSize);
+        T value;
+        std::memcpy(&value, mData + mOffset, sizeof(T));
+        mOffset += sizeof(T);
+        return value;
+    }
+
+private:
+    std::byte const* mData;
+    std::size_t mSize;
+    std::size_t mOffset{0};
+};
+
+void writeKvCacheStats(Writer& writer, tle::KvCacheStats const& stats)
+{
+    writer.write(stats.maxNumBlocks);
+    writer.write(stats.freeNumBlocks);
+    writer.write(stats.usedNumBlocks);
+    writer.write(stats.tokensPerBlock);
+    writer.write(stats.allocTotalBlocks);
+    writer.write(stats.allocNewBlocks);
+    writer.write(stats.reusedBlocks);
+}
+
+tle::KvCacheStats readKvCacheStats(Reader& reader)
+{
+    tle::KvCacheStats stats{};
+    stats.maxNumBlocks = reader.read<tle::SizeType32>();
+    stats.freeNumBlocks = reader.read<tle::SizeType32>();
+    stats.usedNumBlocks = reader.read<tle::SizeType32>();
+    stats.tokensPerBlock = reader.read<tle::SizeType32>();
+    stats.allocTotalBlocks = reader.read<tle::SizeType32>();
+    stats.allocNewBlocks = reader.read<tle::SizeType32>();
+    stats.reusedBlocks = reader.read<tle::SizeType32>();
+    return stats;
+}
+
+void writeIterationStats(Writer& writer, tle::IterationStats const& stats)
+{
+    writer.write(StatsSerialization::kSchemaVersion);
+    writer.write(parseTimestamp(stats.timestamp));
+    writer.write(stats.iter);
+    writer.write(stats.iterLatencyMS);
+    writer.write(stats.newActiveRequestsQueueLatencyMS);
+    writer.write(stats.numActiveRequests);
+    writer.write(stats.numQueuedRequests);
+    writer.write(stats.numCompletedRequests);
+    writer.write(stats.maxNumActiveRequests);
+    writer.write(static_cast<std::uint64_t>(stats.gpuMemUsage));
+    writer.write(static_cast<std::uint64_t>(stats.cpuMemUsage));
+    writer.write(static_cast<std::uint64_t>(stats.pinnedMemUsage));
+
+    std::uint32_t flags{0};
+    flags |= stats.kvCacheStats ? kHasKvCacheStats : 0;
+    flags |= stats.crossKvCacheStats ? kHasCrossKvCacheStats : 0;
+    flags |= stats.staticBatchingStats ? kHasStaticBatchingStats : 0;
+    flags |= stats.inflightBatchingStats ? kHasInflightBatchingStats : 0;
+    writer.write(flags);
+    if (stats.kvCacheStats)
+    {
+        writeKvCacheStats(writer, *stats.kvCacheStats);
+    }
+    if (stats.crossKvCacheStats)
+    {
+        writeKvCacheStats(writer, *stats.crossKvCacheStats);
+    }
+    if (stats.staticBatchingStats)
+    {
+        auto const& batching = *stats.staticBatchingStats;
+        writer.write(batching.numScheduledRequests);
+        writer.write(batching.numContextRequests);
+        writer.write(batching.numCtxTokens);
+        writer.write(batching.numGenTokens);
+        writer.write(batching.emptyGenSlots);
+    }
+    if (stats.inflightBatchingStats)
+    {
+        auto const& batching = *stats.inflightBatchingStats;
+        writer.write(batching.numScheduledRequests);
+        writer.write(batching.numContextRequests);
+        writer.write(batching.numGenRequests);
+        writer.write(batching.numPausedRequests);
+        writer.write(batching.numCtxTokens);
+        writer.write(batching.microBatchId);
+        writer.write(batching.avgNumDecodedTokensPerIter);
+    }
+}
+
+void writeRequestStats(Writer& writer, tle::RequestStats const& stats)
+{
+    writer.write(stats.id);
+    writer.write(static_cast<std::uint32_t>(stats.stage));
+    writer.write(stats.contextPrefillPosition);
+    writer.write(stats.numGeneratedTokens);
+    writer.write(stats.avgNumDecodedTokensPerIter);
+
+    std::uint32_t flags{0};
+    flags |= stats.scheduled ? kScheduled : 0;
+    flags |= stats.paused ? kPaused : 0;
+    flags |= stats.disServingStats ? kHasDisServingStats : 0;
+    writer.write(flags);
+
+    if (stats.disServingStats)
+    {
+        writer.write(stats.disServingStats->kvCacheTransferMS);
+    }
+}
+
+void writeRequestStatsPerIteration(Writer& writer, tle::RequestStatsPerIteration const& stats)
+{
+    writer.write(StatsSerialization::kSchemaVersion);
+    writer.write(stats.iter);
+    writer.write(static_cast<std::uint32_t>(stats.requestStats.size()));
+    for (auto const& requestStats : stats.requestStats)
+    {
+        writeRequestStats(writer, requestStats);
+    }
+}
+
+std::uint32_t readVersion(Reader& reader)
+{
+    auto const version = reader.read<std::uint32_t>();
+    TLLM_CHECK_WITH_INFO(version >= 1, "Invalid stats schema version %u", version);
+    return version;
+}
+
+tle::RequestStats readRequestStats(Reader& reader)
+{
+    tle::RequestStats stats{};
+    stats.id = reader.read<tle::IdType>();
+    stats.stage = static_cast<tle::RequestStage>(reader.read<std::uint32_t>());
+    stats.contextPrefillPosition = reader.read<tle::SizeType32>();
+    stats.numGeneratedTokens = reader.read<tle::SizeType32>();
+    stats.avgNumDecodedTokensPerIter = reader.read<float>();
+
+    auto const flags = reader.read<std::uint32_t>();
+    stats.scheduled = (flags & kScheduled) != 0;
+    stats.paused = (flags & kPaused) != 0;
+    if (flags & kHasDisServingStats)
+    {
+        tle::DisServingRequestStats disServingStats{};
+        disServingStats.kvCacheTransferMS = reader.read<double>();
+        stats.disServingStats = disServingStats;
+    }
+    return stats;
+}
+
+template <typename Stats>
+void appendRecords(std::deque<Stats> const& stats, shm::MessageType type, std::vector<char>& buffer)
+{
+    for (auto const& entry : stats)
+    {
+        auto const size = StatsSerialization::serializedSize(entry);
+        auto const offset = buffer.size();
+        buffer.resize(offset + 2 * sizeof(std::uint32_t) + size);
+        auto* data = reinterpret_cast<std::byte*>(buffer.data() + offset);
+        Writer header{data};
+        header.write(static_cast<std::uint32_t>(type));
+        header.write(static_cast<std::uint32_t>(size));
+        StatsSerialization::serialize(entry, data + header.getSize());
+    }
+}
+} // namespace
+
+std::size_t StatsSerialization::serializedSize(executor::IterationStats const& stats)
+{
+    Writer writer;
+    writeIterationStats(writer, stats);
+    return writer.getSize();
+}
+
+void StatsSerialization::serialize(executor::IterationStats const& stats, std::byte* data)
+{
+    Writer writer{data};
+    writeIterationStats(writer, stats);
+}
+
+executor::IterationStats StatsSerialization::deserializeIterationStats(std::byte const* data, std::size_t size)
+{
+    Reader reader{data, size};
+    readVersion(reader);
+    tle::IterationStats stats{};
+    auto const timestampUs = reader.read<std::int64_t>();
+    if (timestampUs != 0)
+    {
+        stats.timestamp = formatTimestamp(timestampUs);
+    }
+    stats.iter = reader.read<tle::IterationType>();
+    stats.iterLatencyMS = reader.read<double>();
+    stats.newActiveRequestsQueueLatencyMS = reader.read<double>();
+    stats.numActiveRequests = reader.read<tle::SizeType32>();
+    stats.numQueuedRequests = reader.read<tle::SizeType32>();
+    stats.numCompletedRequests = reader.read<tle::SizeType32>();
+    stats.maxNumActiveRequests = reader.read<tle::SizeType32>();
+    stats.gpuMemUsage = reader.read<std::uint64_t>();
+    stats.cpuMemUsage = reader.read<std::uint64_t>();
+    stats.pinnedMemUsage = reader.read<std::uint64_t>();
+
+    auto const flags = reader.read<std::uint32_t>();
+    if (flags & kHasKvCacheStats)
+    {
+        stats.kvCacheStats = readKvCacheStats(reader);
+    }
+    if (flags & kHasCrossKvCacheStats)
+    {
+        stats.crossKvCacheStats = readKvCacheStats(reader);
+    }
+    if (flags & kHasStaticBatchingStats)
+    {
+        tle::StaticBatchingStats batching{};
+        batching.numScheduledRequests = reader.read<tle::SizeType32>();
+        batching.numContextRequests = reader.read<tle::SizeType32>();
+        batching.numCtxTokens = reader.read<tle::SizeType32>();
+        batching.numGenTokens = reader.read<tle::SizeType32>();
+        batching.emptyGenSlots = reader.read<tle::SizeType32>();
+        stats.staticBatchingStats = batching;
+    }
+    if (flags & kHasInflightBatchingStats)
+    {
+        tle::InflightBatchingStats batching{};
+        batching.numScheduledRequests = reader.read<tle::SizeType32>();
+        batching.numContextRequests = reader.read<tle::SizeType32>();
+        batching.numGenRequests = reader.read<tle::SizeType32>();
+        batching.numPausedRequests = reader.read<tle::SizeType32>();
+        batching.numCtxTokens = reader.read<tle::SizeType32>();
+        batching.microBatchId = reader.read<tle::SizeType32>();
+        batching.avgNumDecodedTokensPerIter = reader.read<float>();
+        stats.inflightBatchingStats = batching;
+    }
+    return stats;
+}
+
+std::size_t StatsSerialization::serializedSize(executor::RequestStatsPerIteration const& stats)
+{
+    Writer writer;
+    writeRequestStatsPerIteration(writer, stats);
+    return writer.getSize();
+}
+
+void StatsSerialization::serialize(executor::RequestStatsPerIteration const& stats, std::byte* data)
+{
+    Writer writer{data};
+    writeRequestStatsPerIteration(writer, stats);
+}
+
+executor::RequestStatsPerIteration StatsSerialization::deserializeRequestStatsPerIteration(
+    std::byte const* data, std::size_t size)
+{
+    Reader reader{data, size};
+    readVersion(reader);
+    tle::RequestStatsPerIteration stats;
+    stats.iter = reader.read<tle::IterationType>();
+    auto const numRequests = reader.read<std::uint32_t>();
+    stats.requestStats.reserve(numRequests);
+    for (std::uint32_t i = 0; i < numRequests; ++i)
+    {
+        stats.requestStats.push_back(readRequestStats(reader));
+    }
+    return stats;
+}
+
+void StatsSerialization::append(std::deque<executor::IterationStats> const& stats, std::vector<char>& buffer)
+{
+    appendRecords(stats, shm::MessageType::kITERATION_STATS, buffer);
+}
+
+void StatsSerialization::append(std::deque<executor::RequestStatsPerIteration> const& stats, std::vector<char>& buffer)
+{
+    appendRecords(stats, shm::MessageType::kREQUEST_STATS, buffer);
+}
+
+StatsSerialization::Stats StatsSerialization::deserializeStats(std::vector<char> const& buffer)
+{
+    Stats stats;
+    auto const* data = reinterpret_cast<std::byte const*>(buffer.data());
+    std::size_t offset{0};
+    while (offset < buffer.size())
+    {
+        Reader header{data + offset, buffer.size() - offset};
+        auto const type = static_cast<shm::MessageType>(header.read<std::uint32_t>());
+        auto const size = header.read<std::uint32_t>();
+        offset += 2 * sizeof(std::uint32_t);
+        TLLM_CHECK_WITH_INFO(offset + size <= buffer.size(), "Stats record of %u bytes is truncated", size);
+        if (type == shm::MessageType::kITERATION_STATS)
+        {
+            stats.iterationStats.push_back(deserializeIterationStats(data + offset, size));
+        }
+        else if (type == shm::MessageType::kREQUEST_STATS)
+        {
+            stats.requestStats.push_back(deserializeRequestStatsPerIteration(data + offset, size));
+        }
+        offset += size;
+    }
+    return stats;
+}
+
+namespace shm
+{
+
+namespace
+{
+template <typename Stats>
+bool tryWriteStats(ShmRingBuffer& ring, MessageType type, Stats const& stats)
+{
+    auto const size = StatsSerialization::serializedSize(stats);
+    auto* data = ring.tryReserve(static_cast<std::uint32_t>(type), size);
+    if (data == nullptr)
+    {
+        return false;
+    }
+    StatsSerialization::serialize(stats, data);
+    ring.commit();
+    return true;
+}
+} // namespace
+
+bool tryWriteIterationStats(ShmRingBuffer& ring, executor::IterationStats const& stats)
+{
+    return tryWriteStats(ring, MessageType::kITERATION_STATS, stats);
+}
+
+bool tryWriteRequestStats(ShmRingBuffer& ring, executor::RequestStatsPerIteration const& stats)
+{
+    return tryWriteStats(ring, MessageType::kREQUEST_STATS, stats);
+}
+
+executor::IterationStats asIterationStats(ShmRingBuffer::Message const& message)
+{
+    TLLM_CHECK_WITH_INFO(message.type == static_cast<std::uint32_t>(MessageType::kITERATION_STATS),
+        "Message is no iteration stats");
+    return StatsSerialization::deserializeIterationStats(message.data, message.size);
+}
+
+executor::RequestStatsPerIteration asRequestStats(ShmRingBuffer::Message const& message)
+{
+    TLLM_CHECK_WITH_INFO(
+        message.type == static_cast<std::uint32_t>(MessageType::kREQUEST_STATS), "Message is no request stats");
+    return StatsSerialization::deserializeRequestStatsPerIteration(message.data, message.size);
+}
+
+} // namespace shm
+
+} // namespace tensorrt_llm::common
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "tensorrt_llm/common/shmRingBuffer.h"
+#include "tensorrt_llm/executor/types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace tensorrt_llm::common
+{
+
+//! \brief Compact binary encoding of the iteration and request stats.
+//! \details JsonSerialization builds a JSON tree and a string per stats object, which costs real CPU when request
+//! stats are collected at high QPS. The binary records are fixed-layout and carry the iteration timestamp as
+//! microseconds since the Unix epoch, so the serving host only copies numbers and formatting happens wherever the
+//! records are read.
+//!
+//! Each record starts with the schema version. New versions only append fields, readers of an older version ignore
+//! the bytes they do not know.
+class StatsSerialization
+{
+public:
+    static constexpr std::uint32_t kSchemaVersion = 1;
+
+    //! \brief Stats decoded from a bulk buffer, in the order of the buffer.
+    struct Stats
+    {
+        std::vector<executor::IterationStats> iterationStats;
+        std::vector<executor::RequestStatsPerIteration> requestStats;
+    };
+
+    // IterationStats
+    [[nodiscard]] static std::size_t serializedSize(executor::IterationStats const& stats);
+    //! \brief Write the record to data, which holds serializedSize(stats) bytes.
+    static void serialize(executor::IterationStats const& stats, std::byte* data);
+    [[nodiscard]] static executor::IterationStats deserializeIterationStats(std::byte const* data, std::size_t size);
+
+    // RequestStatsPerIteration
+    [[nodiscard]] static std::size_t serializedSize(executor::RequestStatsPerIteration const& stats);
+    static void serialize(executor::RequestStatsPerIteration const& stats, std::byte* data);
+    [[nodiscard]] static executor::RequestStatsPerIteration deserializeRequestStatsPerIteration(
+        std::byte const* data, std::size_t size);
+
+    //! \brief Append records to a bulk buffer, each preceded by its shm::MessageType and size as two uint32.
+    //! \details Meant for pulling the stats queues of the executor in one go, e.g. into a file.
+    static void append(std::deque<executor::IterationStats> const& stats, std::vector<char>& buffer);
+    static void append(std::deque<executor::RequestStatsPerIteration> const& stats, std::vector<char>& buffer);
+
+    //! \brief Decode every record of a bulk buffer. Records of unknown type are skipped.
+    [[nodiscard]] static Stats deserializeStats(std::vector<char> const& buffer);
+};
+
+namespace shm
+{
+
+//! \brief Write the stats of an iteration to a ring, e.g. one read by a stats collector process. Returns false if the
+//! ring is too full, the caller decides whether to drop the stats.
+[[nodiscard]] bool tryWriteIterationStats(ShmRingBuffer& ring, executor::IterationStats const& stats);
+
+//! \brief Write the request stats of an iteration to a ring. Returns false if the ring is too full.
+[[nodiscard]] bool tryWriteRequestStats(ShmRingBuffer& ring, executor::RequestStatsPerIteration const& stats);
+
+//! \brief Decode a message written by tryWriteIterationStats.
+[[nodiscard]] executor::IterationStats asIterationStats(ShmRingBuffer::Message const& message);
+
+//! \brief Decode a message written by tryWriteRequestStats.
+[[nodiscard]] executor::RequestStatsPerIteration asRequestStats(ShmRingBuffer::Message const& message);
+
+} // namespace shm
+
+} // namespace tensorrt_llm::common
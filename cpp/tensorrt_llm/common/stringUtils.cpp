@@ -73,4 +73,50 @@ std::unordered_set<std::string> str2set(std::string const& input, char delimiter
     return values;
 };
 
+std::string toHex(std::string const& bytes)
+{
+    static char const* const digits = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(2 * bytes.size());
+    for (auto const byte : bytes)
+    {
+        auto const value = static_cast<unsigned char>(byte);
+        hex.push_back(digits[value >> 4]);
+        hex.push_back(digits[value & 0xf]);
+    }
+    return hex;
+}
+
+std::optional<std::string> fromHex(std::string const& hex)
+{
+    auto const nibble = [](char c) -> int
+    {
+        if (c >= '0' && c <= '9')
+        {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f')
+        {
+            return c - 'a' + 10;
+        }
+        return -1;
+    };
+    if (hex.size() % 2 != 0)
+    {
+        return std::nullopt;
+    }
+    std::string bytes(hex.size() / 2, '\0');
+    for (size_t i = 0; i < bytes.size(); ++i)
+    {
+        auto const high = nibble(hex[2 * i]);
+        auto const low = nibble(hex[2 * i + 1]);
+        if (high < 0 || low < 0)
+        {
+            return std::nullopt;
+        }
+        bytes[i] = static_cast<char>((high << 4) | low);
+    }
+    return bytes;
+}
+
 } // namespace tensorrt_llm::common
@@ -15,6 +15,7 @@
  */
 
 #include <chrono>
+#include <ctime>
 #include <iomanip>
 #include <sstream>
 
@@ -25,18 +26,48 @@ namespace tensorrt_llm::common
 
 std::string getCurrentTimestamp()
 {
-    auto now = std::chrono::system_clock::now();
-    auto now_t = std::chrono::system_clock::to_time_t(now);
-    auto tm = *std::localtime(&now_t);
+    return formatTimestamp(getCurrentTimestampUs());
+}
+
+std::int64_t getCurrentTimestampUs()
+{
+    auto const now = std::chrono::system_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+}
 
-    auto epoch_to_now = now.time_since_epoch();
-    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(epoch_to_now);
-    auto us = std::chrono::duration_cast<std::chrono::microseconds>(epoch_to_now - seconds);
+std::string formatTimestamp(std::int64_t timestampUs)
+{
+    auto const seconds = timestampUs / 1000000;
+    auto const us = timestampUs % 1000000;
+    auto const time = static_cast<std::time_t>(seconds);
+    auto tm = *std::localtime(&time);
 
     std::ostringstream stream;
     stream << std::put_time(&tm, "%m-%d-%Y %H:%M:%S");
-    stream << "." << std::setfill('0') << std::setw(6) << us.count();
+    stream << "." << std::setfill('0') << std::setw(6) << us;
     return stream.str();
 }
 
+std::int64_t parseTimestamp(std::string const& timestamp)
+{
+    std::tm tm{};
+    std::istringstream stream(timestamp);
+    stream >> std::get_time(&tm, "%m-%d-%Y %H:%M:%S");
+    char separator{};
+    std::int64_t us{0};
+    stream >> separator >> us;
+    if (stream.fail() || (separator != '.' && separator != ':') || us < 0 || us >= 1000000)
+    {
+        return 0;
+    }
+    // Let mktime work out whether daylight saving time was in effect
+    tm.tm_isdst = -1;
+    auto const seconds = std::mktime(&tm);
+    if (seconds == static_cast<std::time_t>(-1))
+    {
+        return 0;
+    }
+    return static_cast<std::int64_t>(seconds) * 1000000 + us;
+}
+
 } // namespace tensorrt_llm::common
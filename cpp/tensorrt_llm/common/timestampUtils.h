@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <cstdint>
 #include <string>
 
 namespace tensorrt_llm::common
@@ -22,4 +23,14 @@ namespace tensorrt_llm::common
 /// @brief Get the current timestamp in the format "MM-DD-YYYY HH:MM:SS:uuuuuu"
 std::string getCurrentTimestamp();
 
+/// @brief Get the current time in microseconds since the Unix epoch
+std::int64_t getCurrentTimestampUs();
+
+/// @brief Format microseconds since the Unix epoch like getCurrentTimestamp, in local time
+std::string formatTimestamp(std::int64_t timestampUs);
+
+/// @brief Parse a timestamp formatted by getCurrentTimestamp back to microseconds since the Unix epoch
+/// @return 0 if the timestamp is malformed
+std::int64_t parseTimestamp(std::string const& timestamp);
+
 } // namespace tensorrt_llm::common
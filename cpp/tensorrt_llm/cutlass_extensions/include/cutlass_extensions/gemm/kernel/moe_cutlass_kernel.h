@@ -34,9 +34,12 @@
 
 #include "cutlass_extensions/gemm/kernel/gemm_moe_problem_visitor.h"
 #include "cutlass_extensions/tile_interleaved_layout.h"
+#include "cutlass_extensions/weight_only_quant_op.h"
 
 #include "tensorrt_llm/kernels/cutlass_kernels/moe_gemm/moe_sm90_traits.h"
 
+#include <type_traits>
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 namespace cutlass
@@ -62,6 +65,19 @@ struct use_dq_gemm<Mma, void_t<typename Mma::IteratorScale>> : platform::true_ty
 {
 };
 
+// The scaling mode of a dequantizing Mma, UNDEFINED for the other ones.
+template <typename Mma, typename = void>
+struct dq_gemm_quant_op
+{
+    static constexpr WeightOnlyQuantOp value = WeightOnlyQuantOp::UNDEFINED;
+};
+
+template <typename Mma>
+struct dq_gemm_quant_op<Mma, void_t<typename Mma::IteratorScale>>
+{
+    static constexpr WeightOnlyQuantOp value = Mma::QuantOp;
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 template <typename Mma_,          ///! Threadblock-scoped matrix multiply-accumulate
@@ -110,6 +126,7 @@ public:
     using ArchTag = typename Mma::ArchTag;
 
     static int const kStages = Mma::kStages;
+    static constexpr WeightOnlyQuantOp QuantOp = dq_gemm_quant_op<Mma>::value;
     static int const kAlignmentA = MapArguments::kAlignmentA;
     static int const kAlignmentB = MapArguments::kAlignmentB;
     static int const kAlignmentC = Epilogue::OutputTileIterator::kElementsPerAccess;
@@ -142,6 +159,7 @@ public:
         ElementA* ptr_A;
         ElementB* ptr_B;
         ElementScale* weight_scales;
+        ElementScale* weight_zeros;
         ElementC* ptr_C;
         ElementC* ptr_D;
         bool C_is_broadcast;
@@ -165,6 +183,7 @@ public:
             , ptr_A(nullptr)
             , ptr_B(nullptr)
             , weight_scales(nullptr)
+            , weight_zeros(nullptr)
             , ptr_C(nullptr)
             , ptr_D(nullptr)
             , total_tokens_including_expert(nullptr)
@@ -178,9 +197,10 @@ public:
         /// Ctor
         CUTLASS_HOST_DEVICE
         Arguments(int problem_count, int threadblock_count, int group_size, typename EpilogueOutputOp::Params output_op,
-            ElementA const* ptr_A, ElementB const* ptr_B, ElementScale const* weight_scales, ElementC const* ptr_C,
-            bool C_is_broadcast, ElementC* ptr_D, int64_t const* total_tokens_including_expert, int64_t gemm_n,
-            int64_t gemm_k, GemmCoord* host_problem_sizes = nullptr)
+            ElementA const* ptr_A, ElementB const* ptr_B, ElementScale const* weight_scales,
+            ElementScale const* weight_zeros, ElementC const* ptr_C, bool C_is_broadcast, ElementC* ptr_D,
+            int64_t const* total_tokens_including_expert, int64_t gemm_n, int64_t gemm_k,
+            GemmCoord* host_problem_sizes = nullptr)
             : problem_count(problem_count)
             , threadblock_count(threadblock_count)
             , group_size(group_size)
@@ -188,6 +208,7 @@ public:
             , ptr_A(const_cast<ElementA*>(ptr_A))
             , ptr_B(const_cast<ElementB*>(ptr_B))
             , weight_scales(const_cast<ElementScale*>(weight_scales))
+            , weight_zeros(const_cast<ElementScale*>(weight_zeros))
             , ptr_C(const_cast<ElementC*>(ptr_C))
             , C_is_broadcast{C_is_broadcast}
             , ptr_D(ptr_D)
@@ -221,6 +242,7 @@ public:
         ElementA* ptr_A;
         ElementB* ptr_B;
         ElementScale* weight_scales;
+        ElementScale* weight_zeros;
         ElementC* ptr_C;
         ElementC* ptr_D;
 
@@ -233,6 +255,7 @@ public:
             : ptr_A(nullptr)
             , ptr_B(nullptr)
             , weight_scales(nullptr)
+            , weight_zeros(nullptr)
             , ptr_C(nullptr)
             , ptr_D(nullptr)
             , C_is_broadcast(true)
@@ -249,6 +272,7 @@ public:
             , ptr_A(args.ptr_A)
             , ptr_B(args.ptr_B)
             , weight_scales(args.weight_scales)
+            , weight_zeros(args.weight_zeros)
             , ptr_C(args.ptr_C)
             , ptr_D(args.ptr_D)
             , C_is_broadcast(args.C_is_broadcast)
@@ -262,10 +286,12 @@ public:
             problem_visitor = typename ProblemVisitor::Params(args.total_tokens_including_expert, args.gemm_n,
                 args.gemm_k, args.problem_count, workspace, tile_count);
             threadblock_count = args.threadblock_count;
+            group_size = args.group_size;
             output_op = args.output_op;
             ptr_A = args.ptr_A;
             ptr_B = args.ptr_B;
             weight_scales = args.weight_scales;
+            weight_zeros = args.weight_zeros;
             ptr_C = args.ptr_C;
             ptr_D = args.ptr_D;
             C_is_broadcast = args.C_is_broadcast;
@@ -303,6 +329,25 @@ public:
                 CUTLASS_TRACE_HOST("MoeFCGemm::can_implement() - weight scales are required for uint8_t and uint4b_t");
                 return Status::kInvalid;
             }
+            if constexpr (isFinegrained(QuantOp))
+            {
+                if ((args.group_size != 64 && args.group_size != 128) || args.gemm_k % args.group_size != 0)
+                {
+                    CUTLASS_TRACE_HOST("MoeFCGemm::can_implement() - group size must be 64 or 128 and divide gemm_k");
+                    return Status::kInvalid;
+                }
+            }
+            else if (args.group_size != args.gemm_k)
+            {
+                CUTLASS_TRACE_HOST("MoeFCGemm::can_implement() - scale shape should be (1, gemm_n)");
+                return Status::kInvalid;
+            }
+            if (hasZero(QuantOp) != (args.weight_zeros != nullptr))
+            {
+                CUTLASS_TRACE_HOST("MoeFCGemm::can_implement() - weight zeros are only used by the scale and zeros "
+                                   "mode, where they are required");
+                return Status::kInvalid;
+            }
         }
         else if (args.weight_scales != nullptr)
         {
@@ -330,6 +375,26 @@ public:
         return 0;
     }
 
+    // Initializes the fine grained scale+bias iterator. Needed since the fine grained iterator
+    // has a different constructor signature than a regular cutlass iterator
+    template <typename IteratorScale, WeightOnlyQuantOp op, std::enable_if_t<isFinegrained(op), bool> = true>
+    CUTLASS_DEVICE static IteratorScale initialize_scale(typename IteratorScale::Params const& params,
+        typename IteratorScale::Pointer pointer_scale, typename IteratorScale::Pointer pointer_zero,
+        typename IteratorScale::TensorCoord extent, int thread_id,
+        typename IteratorScale::TensorCoord const& threadblock_offset, int group_size)
+    {
+        return IteratorScale(params, pointer_scale, pointer_zero, extent, thread_id, threadblock_offset, group_size);
+    }
+
+    template <typename IteratorScale, WeightOnlyQuantOp op, std::enable_if_t<!isFinegrained(op), bool> = true>
+    CUTLASS_DEVICE static IteratorScale initialize_scale(typename IteratorScale::Params const& params,
+        typename IteratorScale::Pointer pointer_scale, typename IteratorScale::Pointer pointer_zero,
+        typename IteratorScale::TensorCoord extent, int thread_id,
+        typename IteratorScale::TensorCoord const& threadblock_offset, int group_size)
+    {
+        return IteratorScale(params, pointer_scale, extent, thread_id, threadblock_offset);
+    }
+
     CUTLASS_DEVICE
     void run_kernel_(Params const& params, SharedStorage& shared_storage)
     {
@@ -434,13 +499,18 @@ public:
             __syncthreads();
 
             // Compute threadblock-scoped matrix multiply-add
-            ElementScale* weight_scale_ptr = params.weight_scales + problem_idx * problem_size.n();
-
             if constexpr (use_dq_gemm<Mma>::value)
             {
-                const MatrixCoord scale_extent = {1, problem_size.n()};
-                typename Mma::IteratorScale iterator_scale(Mma::IteratorScale::Layout(scale_extent.column()),
-                    weight_scale_ptr, scale_extent, thread_idx, tb_offset_scale);
+                // Fine grained scales (and zeros) are [gemm_k / group_size, gemm_n] per expert
+                int64_t const scale_rows = isFinegrained(QuantOp) ? problem_size.k() / params.group_size : 1;
+                int64_t const scale_offset = problem_idx * scale_rows * problem_size.n();
+                ElementScale* weight_scale_ptr = params.weight_scales + scale_offset;
+                ElementScale* weight_zero_ptr = hasZero(QuantOp) ? params.weight_zeros + scale_offset : nullptr;
+
+                const MatrixCoord scale_extent = {static_cast<int>(scale_rows), problem_size.n()};
+                typename Mma::IteratorScale iterator_scale = initialize_scale<typename Mma::IteratorScale, QuantOp>(
+                    typename Mma::IteratorScale::Layout(scale_extent.column()), weight_scale_ptr, weight_zero_ptr,
+                    scale_extent, thread_idx, tb_offset_scale, params.group_size);
 
                 mma(gemm_k_iterations, accumulators, iterator_A, iterator_B, iterator_scale, accumulators);
             }
@@ -148,6 +148,9 @@ struct CutlassGemmConfig
     ClusterShape cluster_shape = ClusterShape::ClusterShape_1x1x1;
     bool is_sm90 = false;
 
+    // Not a CUTLASS kernel: the plugin profilers offer the small batch cuda kernels as an extra tactic.
+    bool enableCudaKernel = false;
+
     CutlassGemmConfig() {}
 
     CutlassGemmConfig(CutlassTileConfig tile_config, SplitKStyle split_k_style, int split_k_factor, int stages)
@@ -173,7 +176,11 @@ struct CutlassGemmConfig
     {
         std::stringstream tactic;
         tactic << "Cutlass GEMM Tactic";
-        if (tile_config_sm90 != tensorrt_llm::cutlass_extensions::CutlassTileConfigSM90::ChooseWithHeuristic)
+        if (enableCudaKernel)
+        {
+            tactic << "\n\tstyle=cuda kernel";
+        }
+        else if (tile_config_sm90 != tensorrt_llm::cutlass_extensions::CutlassTileConfigSM90::ChooseWithHeuristic)
         {
             assert(is_sm90 && "Invalid cutlass GEMM config");
             tactic << "\n\tstyle=TMA"
@@ -199,7 +206,11 @@ struct CutlassGemmConfig
 inline std::ostream& operator<<(std::ostream& out, CutlassGemmConfig const& config)
 {
     // clang-format off
-    if (config.is_sm90)
+    if (config.enableCudaKernel)
+    {
+        out << "cuda_kernel";
+    }
+    else if (config.is_sm90)
     {
         out << "tile_config_sm90_enum: " << int(config.tile_config_sm90)
             << ", mainloop_schedule_enum: " << int(config.mainloop_schedule)
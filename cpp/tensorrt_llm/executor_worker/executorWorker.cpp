@@ -15,14 +15,23 @@
  */
 
 #include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
 #include "tensorrt_llm/common/logger.h"
 #include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/common/startupProfiler.h"
 #include "tensorrt_llm/executor/executor.h"
 #include "tensorrt_llm/executor/serialization.h"
 #include "tensorrt_llm/plugins/api/tllmPlugin.h"
+#include "tensorrt_llm/runtime/engineLoadCoordinator.h"
+#include "tensorrt_llm/runtime/mappedFile.h"
+#include "tensorrt_llm/runtime/orchestratorWorkerPool.h"
 #include <csignal>
+#include <filesystem>
+#include <memory>
+#include <string_view>
 
 namespace tle = tensorrt_llm::executor;
+namespace tr = tensorrt_llm::runtime;
 
 int main(int argc, char* argv[])
 {
@@ -59,37 +68,76 @@ int main(int argc, char* argv[])
     // performance.
     TLLM_CUDA_CHECK(::cudaSetDeviceFlags(cudaDeviceScheduleYield));
 
-    // Since parentComm is an intercommunicator, input root
-    // is the rank of the parent process in his group
-    // (always 0 as the parent size is checked before)
-
-    // Receive from the parent the executor configuration
-    int64_t bufferSize;
-    MPICHECK(MPI_Bcast(&bufferSize, 1, MPI_INT64_T, 0, parentComm));
-    std::vector<char> buffer(bufferSize);
-    MPICHECK(MPI_Bcast(buffer.data(), bufferSize, MPI_CHAR, 0, parentComm));
-    std::istringstream is(std::string(buffer.begin(), buffer.end()));
-    auto modelPath = tle::Serialization::deserializeString(is);
-    auto modelType = tle::Serialization::deserializeModelType(is);
-    auto executorConfig = tle::Serialization::deserializeExecutorConfig(is);
-
-    // Create the orchestrator config for workers
+    // Workers of an OrchestratorWorkerPool serve one executor after the other until the pool releases them.
+    bool const persistent = argc > 1 && std::string_view{argv[1]} == tr::OrchestratorWorkerPool::kPersistentFlag;
     auto orchLeaderComm = std::make_shared<tensorrt_llm::mpi::MpiComm>(parentComm, true);
-    auto parallelConfig = executorConfig.getParallelConfig();
-    TLLM_CHECK_WITH_INFO(parallelConfig.has_value(), "Parallel config should have a value.");
-    TLLM_CHECK_WITH_INFO(
-        parallelConfig.value().getOrchestratorConfig().has_value(), "Orchestrator config should have a value.");
-    auto orchConfig = parallelConfig.value().getOrchestratorConfig().value();
-    TLLM_CHECK_WITH_INFO(parallelConfig.has_value(), "Parallel config should have a value.");
-    auto newOrchConfig = tle::OrchestratorConfig(false, orchConfig.getWorkerExecutablePath(), orchLeaderComm);
-    parallelConfig.value().setOrchestratorConfig(newOrchConfig);
-    executorConfig.setParallelConfig(parallelConfig.value());
-    // In orchestrator mode, the spawned threads will wait for termination signal from orchestrator
-    auto executor = tle::Executor(modelPath, modelType, executorConfig);
-
-    // Wait for all workers to have created their instances
-    MPI_Barrier(parentComm);
-    TLLM_LOG_INFO("Executor instance created by worker");
+
+    do
+    {
+        // Since parentComm is an intercommunicator, input root
+        // is the rank of the parent process in his group
+        // (always 0 as the parent size is checked before)
+
+        // Receive from the parent the executor configuration
+        int64_t bufferSize;
+        MPICHECK(MPI_Bcast(&bufferSize, 1, MPI_INT64_T, 0, parentComm));
+        if (persistent && bufferSize == tr::OrchestratorWorkerPool::kReleaseWorkers)
+        {
+            TLLM_LOG_INFO("Worker released by its pool");
+            break;
+        }
+        std::vector<char> buffer(bufferSize);
+        MPICHECK(MPI_Bcast(buffer.data(), bufferSize, MPI_CHAR, 0, parentComm));
+        std::istringstream is(std::string(buffer.begin(), buffer.end()));
+        auto modelPath = tle::Serialization::deserializeString(is);
+        auto modelType = tle::Serialization::deserializeModelType(is);
+        auto executorConfig = tle::Serialization::deserializeExecutorConfig(is);
+
+        // Create the orchestrator config for workers
+        auto parallelConfig = executorConfig.getParallelConfig();
+        TLLM_CHECK_WITH_INFO(parallelConfig.has_value(), "Parallel config should have a value.");
+        TLLM_CHECK_WITH_INFO(
+            parallelConfig.value().getOrchestratorConfig().has_value(), "Orchestrator config should have a value.");
+        auto orchConfig = parallelConfig.value().getOrchestratorConfig().value();
+        auto newOrchConfig = tle::OrchestratorConfig(false, orchConfig.getWorkerExecutablePath(), orchLeaderComm);
+        parallelConfig.value().setOrchestratorConfig(newOrchConfig);
+        executorConfig.setParallelConfig(parallelConfig.value());
+
+        // Read the engines of the local ranks in waves, so they do not all contend for the filesystem at once. The
+        // engine then deserializes from the page cache while the next wave is reading.
+        auto const& localComm = tensorrt_llm::mpi::MpiComm::localSession();
+        auto const worldRank = tensorrt_llm::mpi::MpiComm::world().getRank();
+        tr::EngineLoadCoordinator loadCoordinator{
+            localComm.getRank(), localComm.getSize(), tensorrt_llm::common::getEnvMaxConcurrentEngineReads()};
+        auto const enginePath = std::filesystem::path{modelPath} / ("rank" + std::to_string(worldRank) + ".engine");
+        std::unique_ptr<tr::MappedFile> engineFile;
+        loadCoordinator.startPhase("read");
+        loadCoordinator.runStaggered(
+            [&]()
+            {
+                if (std::filesystem::exists(enginePath))
+                {
+                    tensorrt_llm::common::StartupProfiler::ScopedPhase const startupPhase{
+                        tensorrt_llm::common::StartupPhase::kENGINE_READ};
+                    engineFile = std::make_unique<tr::MappedFile>(enginePath);
+                    engineFile->populate();
+                }
+            },
+            [&]() { localComm.barrier(); });
+
+        // In orchestrator mode, the spawned threads will wait for termination signal from orchestrator
+        loadCoordinator.startPhase("deserialize");
+        auto executor = tle::Executor(modelPath, modelType, executorConfig);
+        loadCoordinator.stopPhase();
+        engineFile.reset();
+        TLLM_LOG_INFO("Rank %d (read wave %d of %d) loaded its engine: %s", worldRank, loadCoordinator.getWave() + 1,
+            loadCoordinator.getNumWaves(), loadCoordinator.getReport().c_str());
+
+        // Wait for all workers to have created their instances
+        MPI_Barrier(parentComm);
+        TLLM_LOG_INFO("Executor instance created by worker");
+        // The executor is destroyed at the end of the iteration, after the orchestrator shut it down.
+    } while (persistent);
 
 #endif // ENABLE_MULTI_DEVICE
 
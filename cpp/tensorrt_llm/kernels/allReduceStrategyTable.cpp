@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/kernels/allReduceStrategyTable.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+bool isValidChoice(int32_t strategy, int32_t config)
+{
+    using ConfigType = std::underlying_type_t<AllReduceStrategyConfig>;
+    auto const allConfigs = static_cast<ConfigType>(AllReduceStrategyConfig::USE_MEMCPY)
+        | static_cast<ConfigType>(AllReduceStrategyConfig::PUSH_MODE);
+    bool const isStrategy = strategy == static_cast<int32_t>(AllReduceStrategyType::NCCL)
+        || strategy == static_cast<int32_t>(AllReduceStrategyType::ONESHOT)
+        || strategy == static_cast<int32_t>(AllReduceStrategyType::TWOSHOT)
+        || strategy == static_cast<int32_t>(AllReduceStrategyType::NVLS);
+    return isStrategy && config >= 0 && (config & ~allConfigs) == 0;
+}
+
+} // namespace
+
+int32_t AllReduceStrategyTable::getBucket(size_t messageBytes) noexcept
+{
+    int32_t bucket = 0;
+    while ((size_t{1} << bucket) < messageBytes)
+    {
+        ++bucket;
+    }
+    return bucket;
+}
+
+AllReduceStrategyTable::Key AllReduceStrategyTable::makeKey(int32_t sm, int32_t tpSize, size_t messageBytes)
+{
+    return Key{sm, tpSize, getBucket(messageBytes)};
+}
+
+size_t AllReduceStrategyTable::KeyHash::operator()(Key const& key) const noexcept
+{
+    size_t seed = 0;
+    for (auto const value : {key.sm, key.tpSize, key.sizeBucket})
+    {
+        seed ^= std::hash<int32_t>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+std::optional<AllReduceStrategyTable::Choice> AllReduceStrategyTable::lookup(Key const& key) const
+{
+    if (mEmpty.load(std::memory_order_acquire))
+    {
+        return std::nullopt;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto const it = mEntries.find(key);
+    if (it == mEntries.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void AllReduceStrategyTable::set(Key const& key, Choice choice)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries[key] = choice;
+    mEmpty.store(false, std::memory_order_release);
+}
+
+size_t AllReduceStrategyTable::size() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+bool AllReduceStrategyTable::load(std::istream& is)
+{
+    std::vector<std::pair<Key, Choice>> entries;
+    std::string line;
+    while (std::getline(is, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        Key key{};
+        int32_t strategy{};
+        int32_t config{};
+        if (!(fields >> key.sm >> key.tpSize >> key.sizeBucket >> strategy >> config)
+            || !isValidChoice(strategy, config))
+        {
+            TLLM_LOG_WARNING("Malformed all-reduce strategy entry '%s'.", line.c_str());
+            return false;
+        }
+        entries.emplace_back(key,
+            Choice{static_cast<AllReduceStrategyType>(strategy), static_cast<AllReduceStrategyConfig>(config)});
+    }
+    for (auto const& [key, choice] : entries)
+    {
+        set(key, choice);
+    }
+    return true;
+}
+
+void AllReduceStrategyTable::save(std::ostream& os) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    os << "# sm tpSize sizeBucket strategy config\n";
+    for (auto const& [key, choice] : mEntries)
+    {
+        os << key.sm << ' ' << key.tpSize << ' ' << key.sizeBucket << ' ' << static_cast<int32_t>(choice.strategy)
+           << ' ' << static_cast<int32_t>(choice.config) << '\n';
+    }
+}
+
+bool AllReduceStrategyTable::loadFile(std::string const& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        TLLM_LOG_WARNING("Cannot open the all-reduce strategy file %s.", path.c_str());
+        return false;
+    }
+    return load(file);
+}
+
+bool AllReduceStrategyTable::saveFile(std::string const& path) const
+{
+    std::ofstream file(path);
+    if (file)
+    {
+        save(file);
+    }
+    if (!file)
+    {
+        TLLM_LOG_WARNING("Cannot write the all-reduce strategy file %s.", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+AllReduceStrategyTable& AllReduceStrategyTable::getGlobal()
+{
+    static AllReduceStrategyTable& table = []() -> AllReduceStrategyTable&
+    {
+        static AllReduceStrategyTable instance;
+        if (auto const path = common::getEnvAllReduceStrategyTableFile())
+        {
+            if (instance.loadFile(*path))
+            {
+                TLLM_LOG_INFO("Loaded %zu all-reduce strategy entries from %s.", instance.size(), path->c_str());
+            }
+        }
+        return instance;
+    }();
+    return table;
+}
+
+std::optional<AllReduceStrategyTable::Choice> AllReduceStrategyTable::lookupGlobal(
+    int32_t tpSize, size_t messageBytes)
+{
+    auto const& table = getGlobal();
+    if (table.mEmpty.load(std::memory_order_acquire))
+    {
+        return std::nullopt;
+    }
+    static int32_t const sm = common::getSMVersion();
+    return table.lookup(makeKey(sm, tpSize, messageBytes));
+}
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/kernels/customAllReduceKernels.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+// Measured all-reduce strategy of every message size, used by the AUTO strategy instead of its fixed thresholds.
+//
+// Entries are keyed by the GPU arch, the TP size and power-of-two buckets of the message size in bytes, and are
+// filled offline by the allReduceStrategyTuner micro benchmark, which times every strategy and
+// AllReduceStrategyConfig on the actual node. The table is persisted as a text file with one
+// "sm tpSize sizeBucket strategy config" entry per line. Message sizes without an entry keep the heuristic.
+class AllReduceStrategyTable
+{
+public:
+    struct Key
+    {
+        int32_t sm;
+        int32_t tpSize;
+        // ceil(log2(message size in bytes)).
+        int32_t sizeBucket;
+
+        bool operator==(Key const& other) const noexcept
+        {
+            return sm == other.sm && tpSize == other.tpSize && sizeBucket == other.sizeBucket;
+        }
+    };
+
+    struct Choice
+    {
+        AllReduceStrategyType strategy;
+        AllReduceStrategyConfig config;
+    };
+
+    static int32_t getBucket(size_t messageBytes) noexcept;
+
+    static Key makeKey(int32_t sm, int32_t tpSize, size_t messageBytes);
+
+    std::optional<Choice> lookup(Key const& key) const;
+
+    void set(Key const& key, Choice choice);
+
+    [[nodiscard]] size_t size() const;
+
+    // Returns false and leaves the table unchanged if the stream holds a malformed entry.
+    bool load(std::istream& is);
+
+    void save(std::ostream& os) const;
+
+    // File variants of load and save. Failures are logged and return false.
+    bool loadFile(std::string const& path);
+    bool saveFile(std::string const& path) const;
+
+    // The table used by the all-reduce plugin, loaded from TRTLLM_ALLREDUCE_STRATEGY_TABLE_FILE on first use.
+    static AllReduceStrategyTable& getGlobal();
+
+    // Look up the measured strategy of the global table for the current device.
+    static std::optional<Choice> lookupGlobal(int32_t tpSize, size_t messageBytes);
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(Key const& key) const noexcept;
+    };
+
+    mutable std::mutex mMutex;
+    std::unordered_map<Key, Choice, KeyHash> mEntries;
+    // Lets lookups of an empty table skip the lock.
+    std::atomic<bool> mEmpty{true};
+};
+
+} // namespace kernels
+} // namespace tensorrt_llm
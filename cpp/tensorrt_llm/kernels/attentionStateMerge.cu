@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/attentionStateMerge.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+constexpr int kMaxBlockSize = 256;
+
+} // namespace
+
+// One CUDA block per (token, head) row.
+template <typename T>
+__global__ void mergeAttentionStatesKernel(
+    T* out, float* lse, T const* partOut, float const* partLse, int32_t headSize)
+{
+    auto const row = static_cast<int64_t>(blockIdx.x);
+    float const lseA = lse[row];
+    float const lseB = partLse[row];
+    float const maxLse = fmaxf(lseA, lseB);
+    if (maxLse == -INFINITY)
+    {
+        // Neither side attended a key, out stays as is
+        return;
+    }
+    float const weightA = __expf(lseA - maxLse);
+    float const weightB = __expf(lseB - maxLse);
+    float const sum = weightA + weightB;
+    float const scaleA = weightA / sum;
+    float const scaleB = weightB / sum;
+    for (int32_t dim = threadIdx.x; dim < headSize; dim += blockDim.x)
+    {
+        auto const idx = row * headSize + dim;
+        out[idx] = cuda_cast<T>(cuda_cast<float>(out[idx]) * scaleA + cuda_cast<float>(partOut[idx]) * scaleB);
+    }
+    // All threads have read lse above
+    __syncthreads();
+    if (threadIdx.x == 0)
+    {
+        lse[row] = maxLse + __logf(sum);
+    }
+}
+
+template <typename T>
+void invokeMergeAttentionStates(T* out, float* lse, T const* partOut, float const* partLse, int32_t numTokens,
+    int32_t numHeads, int32_t headSize, cudaStream_t stream)
+{
+    auto const numRows = static_cast<int64_t>(numTokens) * numHeads;
+    if (numRows == 0)
+    {
+        return;
+    }
+    TLLM_CHECK_WITH_INFO(numRows <= std::numeric_limits<int32_t>::max(), "Too many rows to merge (%ld)", numRows);
+    auto const blockSize = std::min(kMaxBlockSize, (headSize + 31) / 32 * 32);
+    mergeAttentionStatesKernel<T><<<static_cast<uint32_t>(numRows), blockSize, 0, stream>>>(
+        out, lse, partOut, partLse, headSize);
+    sync_check_cuda_error();
+}
+
+#define INSTANTIATE_MERGE_ATTENTION_STATES(T)                                                                          \
+    template void invokeMergeAttentionStates<T>(T * out, float* lse, T const* partOut, float const* partLse,           \
+        int32_t numTokens, int32_t numHeads, int32_t headSize, cudaStream_t stream)
+
+INSTANTIATE_MERGE_ATTENTION_STATES(float);
+INSTANTIATE_MERGE_ATTENTION_STATES(half);
+#ifdef ENABLE_BF16
+INSTANTIATE_MERGE_ATTENTION_STATES(__nv_bfloat16);
+#endif
+
+#undef INSTANTIATE_MERGE_ATTENTION_STATES
+
+} // namespace kernels
+} // namespace tensorrt_llm
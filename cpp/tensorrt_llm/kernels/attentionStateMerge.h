@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+//! \brief Merge the attention of queries over one range of keys into their attention over another range.
+//! \details out and lse hold the normalized output and the log-sum-exp of the scaled scores over the keys attended so
+//! far, partOut and partLse the same over a disjoint range of keys, e.g. the KV chunk of another rank in ring
+//! attention. Afterwards out and lse cover both ranges, as if the softmax had run over all keys at once. A row with
+//! lse = -inf attended no key, e.g. a chunk masked out by causality, and does not contribute.
+//! \param out [numTokens, numHeads, headSize], updated in place
+//! \param lse [numTokens, numHeads], updated in place
+//! \param partOut [numTokens, numHeads, headSize]
+//! \param partLse [numTokens, numHeads]
+template <typename T>
+void invokeMergeAttentionStates(T* out, float* lse, T const* partOut, float const* partLse, int32_t numTokens,
+    int32_t numHeads, int32_t headSize, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
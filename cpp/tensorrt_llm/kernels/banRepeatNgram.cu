@@ -162,12 +162,198 @@ void invokeBanRepeatNgram(T* logits, TokenIdType const** output_ids_buf, Finishe
     sync_check_cuda_error();
 }
 
+namespace
+{
+unsigned long long constexpr kEMPTY_NGRAM_ENTRY = ~0ull;
+SizeType32 constexpr kNGRAM_BLOCK_SIZE = 256;
+
+__device__ uint32_t hashNgramPrefix(TokenIdType const* ids, SizeType32 start, SizeType32 length)
+{
+    // FNV-1a over the tokens
+    uint32_t h = 2166136261u;
+    for (SizeType32 ti = 0; ti < length; ++ti)
+    {
+        h = (h ^ static_cast<uint32_t>(ids[start + ti])) * 16777619u;
+    }
+    return h;
+}
+
+__device__ bool equalTokens(TokenIdType const* ids, SizeType32 lhsStart, SizeType32 rhsStart, SizeType32 length)
+{
+    for (SizeType32 ti = 0; ti < length; ++ti)
+    {
+        if (ids[lhsStart + ti] != ids[rhsStart + ti])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+__device__ unsigned long long makeNgramEntry(uint32_t hash, SizeType32 lastPos)
+{
+    return (static_cast<unsigned long long>(hash) << 32) | static_cast<uint32_t>(lastPos);
+}
+
+__device__ uint32_t getEntryHash(unsigned long long entry)
+{
+    return static_cast<uint32_t>(entry >> 32);
+}
+
+__device__ SizeType32 getEntryPos(unsigned long long entry)
+{
+    return static_cast<SizeType32>(entry & 0xffffffffull);
+}
+
+//! Inserts the n-gram ending at lastPos, unless the same n-gram is already in the table
+__device__ void insertNgram(unsigned long long* table, SizeType32 mask, TokenIdType const* ids, SizeType32 lastPos,
+    SizeType32 ngramSize)
+{
+    auto const firstPos = lastPos - ngramSize + 1;
+    auto const hash = hashNgramPrefix(ids, firstPos, ngramSize - 1);
+    auto const entry = makeNgramEntry(hash, lastPos);
+    for (auto idx = static_cast<SizeType32>(hash & static_cast<uint32_t>(mask));; idx = (idx + 1) & mask)
+    {
+        auto const old = atomicCAS(table + idx, kEMPTY_NGRAM_ENTRY, entry);
+        // Threads inserting equal n-grams probe the same slots, so the loser of a race finds the winner's entry
+        if (old == kEMPTY_NGRAM_ENTRY
+            || (getEntryHash(old) == hash
+                && equalTokens(ids, getEntryPos(old) - ngramSize + 1, firstPos, ngramSize)))
+        {
+            return;
+        }
+    }
+}
+
+__global__ void resetNgramTables(NgramTablesParams params, SizeType32 const* slots)
+{
+    auto const batchSlot = slots[blockIdx.x];
+    auto* table = params.tables + static_cast<size_t>(batchSlot) * params.tableSize;
+    for (auto idx = static_cast<SizeType32>(threadIdx.x); idx < params.tableSize;
+         idx += static_cast<SizeType32>(blockDim.x))
+    {
+        table[idx] = kEMPTY_NGRAM_ENTRY;
+    }
+    if (threadIdx.x == 0)
+    {
+        params.numIndexed[batchSlot] = 0;
+    }
+}
+
+template <typename T>
+__global__ void banRepeatNgramIncremental(NgramTablesParams params, T* logits, TokenIdType const** outputIds,
+    FinishedState const* finished, SizeType32 const* batchSlots, SizeType32 const* sequenceLengths,
+    SizeType32 const* noRepeatNgramSizes, SizeType32 vocabSizePadded)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = batchSlots != nullptr ? batchSlots[batchIdx] : batchIdx;
+    auto const ngramSize = noRepeatNgramSizes[batchSlot];
+    if (ngramSize == 0 || (finished != nullptr && finished[batchSlot].isFinished()))
+    {
+        return;
+    }
+
+    auto const seqLen = sequenceLengths[batchSlot];
+    auto const* ids = outputIds[batchSlot];
+    auto* table = params.tables + static_cast<size_t>(batchSlot) * params.tableSize;
+    auto const mask = params.tableSize - 1;
+
+    auto numIndexed = params.numIndexed[batchSlot];
+    if (numIndexed > seqLen)
+    {
+        // The sequence was rolled back, index it again
+        for (auto idx = static_cast<SizeType32>(threadIdx.x); idx < params.tableSize;
+             idx += static_cast<SizeType32>(blockDim.x))
+        {
+            table[idx] = kEMPTY_NGRAM_ENTRY;
+        }
+        numIndexed = 0;
+        __syncthreads();
+    }
+
+    // Index the n-grams ending at the new tokens, all of them at the first call after a reset
+    auto const firstPos = max(numIndexed, ngramSize - 1);
+    for (auto lastPos = firstPos + static_cast<SizeType32>(threadIdx.x); lastPos < seqLen;
+         lastPos += static_cast<SizeType32>(blockDim.x))
+    {
+        insertNgram(table, mask, ids, lastPos, ngramSize);
+    }
+    __syncthreads();
+
+    if (threadIdx.x != 0)
+    {
+        return;
+    }
+    params.numIndexed[batchSlot] = seqLen;
+    if (seqLen < ngramSize)
+    {
+        return;
+    }
+
+    // Ban the token following every earlier occurrence of the last ngramSize - 1 tokens
+    auto const prefixPos = seqLen - ngramSize + 1;
+    auto const hash = hashNgramPrefix(ids, prefixPos, ngramSize - 1);
+    for (auto idx = static_cast<SizeType32>(hash & static_cast<uint32_t>(mask));; idx = (idx + 1) & mask)
+    {
+        auto const entry = table[idx];
+        if (entry == kEMPTY_NGRAM_ENTRY)
+        {
+            break;
+        }
+        auto const lastPos = getEntryPos(entry);
+        if (getEntryHash(entry) == hash && equalTokens(ids, lastPos - ngramSize + 1, prefixPos, ngramSize - 1))
+        {
+            auto const bannedToken = ids[lastPos];
+            if (0 <= bannedToken && bannedToken < vocabSizePadded)
+            {
+                logits[batchIdx * vocabSizePadded + bannedToken] = static_cast<T>(-INFINITY);
+            }
+        }
+    }
+}
+} // namespace
+
+SizeType32 getNgramTableSize(SizeType32 maxSeqLen)
+{
+    SizeType32 tableSize = 1;
+    while (tableSize < 2 * maxSeqLen)
+    {
+        tableSize *= 2;
+    }
+    return tableSize;
+}
+
+void invokeResetNgramTables(
+    NgramTablesParams const& params, SizeType32 const* slots, SizeType32 numSlots, cudaStream_t stream)
+{
+    if (numSlots == 0)
+    {
+        return;
+    }
+    resetNgramTables<<<numSlots, kNGRAM_BLOCK_SIZE, 0, stream>>>(params, slots);
+    sync_check_cuda_error();
+}
+
+template <typename T>
+void invokeBanRepeatNgramIncremental(NgramTablesParams const& params, T* logits, TokenIdType const** outputIds,
+    FinishedState const* finished, SizeType32 const* batchSlots, SizeType32 const* sequenceLengths,
+    SizeType32 batchSize, SizeType32 const* noRepeatNgramSizes, SizeType32 vocabSizePadded, cudaStream_t stream)
+{
+    banRepeatNgramIncremental<<<batchSize, kNGRAM_BLOCK_SIZE, 0, stream>>>(
+        params, logits, outputIds, finished, batchSlots, sequenceLengths, noRepeatNgramSizes, vocabSizePadded);
+    sync_check_cuda_error();
+}
+
 #define INVOKE_BAN_REPEAT_NGRAM(T)                                                                                     \
     template void invokeBanRepeatNgram(T* logits, TokenIdType const** output_ids_buf,                                  \
         const FinishedState* finished_buf, SizeType32 const** parent_ids_buf, SizeType32 const* batch_slot,            \
         SizeType32 const* sequence_lengths, SizeType32 batch_size, SizeType32 beam_width, SizeType32 max_seq_len,      \
         SizeType32 const* no_repeat_ngram_size_buf, SizeType32 vocab_size_padded, SizeType32 max_step,                 \
-        cudaStream_t stream);
+        cudaStream_t stream);                                                                                          \
+    template void invokeBanRepeatNgramIncremental(NgramTablesParams const& params, T* logits,                          \
+        TokenIdType const** outputIds, FinishedState const* finished, SizeType32 const* batchSlots,                    \
+        SizeType32 const* sequenceLengths, SizeType32 batchSize, SizeType32 const* noRepeatNgramSizes,                 \
+        SizeType32 vocabSizePadded, cudaStream_t stream);
 
 INVOKE_BAN_REPEAT_NGRAM(float)
 INVOKE_BAN_REPEAT_NGRAM(half)
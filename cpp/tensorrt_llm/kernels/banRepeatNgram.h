@@ -33,5 +33,51 @@ void invokeBanRepeatNgram(T* logits, runtime::TokenIdType const** output_ids_buf
     runtime::SizeType32 max_seq_len, runtime::SizeType32 const* no_repeat_ngram_size_buf,
     runtime::SizeType32 vocab_size_padded, runtime::SizeType32 max_step, cudaStream_t stream);
 
+//! \brief Per-slot open addressing hash tables of the n-grams of each sequence, so that banning repeated n-grams costs
+//! O(new tokens) per step instead of O(sequence length). An entry packs the hash of the first ngramSize - 1 tokens of
+//! an n-gram with the position of its last token. Only for beamWidth == 1, where a sequence owns its whole history.
+struct NgramTablesParams
+{
+    //! [maxBatchSize, tableSize], on gpu
+    unsigned long long* tables{nullptr};
+    //! [maxBatchSize], on gpu. Number of tokens of each sequence whose n-grams are in its table
+    runtime::SizeType32* numIndexed{nullptr};
+    //! Power of 2 and at least twice the max sequence length, from getNgramTableSize
+    runtime::SizeType32 tableSize{0};
+};
+
+//! @returns number of entries of a table for sequences of up to maxSeqLen tokens
+[[nodiscard]] runtime::SizeType32 getNgramTableSize(runtime::SizeType32 maxSeqLen);
+
+//! \brief Clears the tables of slots, e.g. for new requests
+//!
+//! \param params tables
+//! \param slots input buffer [numSlots], on gpu. Slots to clear
+//! \param numSlots number of slots to clear
+//! \param stream stream
+void invokeResetNgramTables(NgramTablesParams const& params, runtime::SizeType32 const* slots,
+    runtime::SizeType32 numSlots, cudaStream_t stream);
+
+//! \brief Same as invokeBanRepeatNgram for beamWidth == 1. Adds the n-grams of the tokens generated since the last
+//! call, possibly more than one per step, to the table of each slot and bans the tokens following the last
+//! ngramSize - 1 tokens wherever they occurred before. A table is rebuilt from the start of the sequence when the
+//! sequence got shorter than what the table holds.
+//!
+//! \param params tables
+//! \param logits input/output buffer [batchSize, vocabSizePadded]
+//! \param outputIds input buffer [maxBatchSize][maxSeqLen]
+//! \param finished input buffer [maxBatchSize], optional. Finished sequences are skipped
+//! \param batchSlots input buffer [batchSize], optional
+//! \param sequenceLengths input buffer [maxBatchSize]
+//! \param batchSize batch size
+//! \param noRepeatNgramSizes input buffer [maxBatchSize]. 0 disables banning for a slot
+//! \param vocabSizePadded padded vocab size
+//! \param stream stream
+template <typename T>
+void invokeBanRepeatNgramIncremental(NgramTablesParams const& params, T* logits,
+    runtime::TokenIdType const** outputIds, FinishedState const* finished, runtime::SizeType32 const* batchSlots,
+    runtime::SizeType32 const* sequenceLengths, runtime::SizeType32 batchSize,
+    runtime::SizeType32 const* noRepeatNgramSizes, runtime::SizeType32 vocabSizePadded, cudaStream_t stream);
+
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/batchPrepKernels.h"
+
+#ifndef CUDART_VERSION
+#error CUDART_VERSION Undefined!
+#elif (CUDART_VERSION >= 11050)
+#include <cub/cub.cuh>
+#else
+#include "3rdparty/cub/cub.cuh"
+#endif
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+constexpr int kBatchPrepThreads = 1024;
+
+__device__ int32_t getRowSlot(BatchPrepParams const& params, int32_t row)
+{
+    auto const request = row < params.numContextRequests
+        ? row
+        : params.numContextRequests + (row - params.numContextRequests) / params.beamWidth;
+    return params.batchSlots[request];
+}
+
+//! A single CTA, the steps are separated by __syncthreads: apply the deltas of the slots, scan the tokens of the
+//! rows, write the rows and the tokens, and advance the slots.
+__global__ void batchPrepKernel(BatchPrepParams params)
+{
+    using BlockScan = cub::BlockScan<int32_t, kBatchPrepThreads>;
+    __shared__ typename BlockScan::TempStorage tempStorage;
+    __shared__ int32_t rowOffset;
+
+    auto const tid = static_cast<int32_t>(threadIdx.x);
+    auto const numRows = params.numContextRequests + params.numGenRequests * params.beamWidth;
+
+    for (int32_t i = tid; i < params.numFinishedSlots; i += kBatchPrepThreads)
+    {
+        params.slotPastLengths[params.finishedSlots[i]] = 0;
+        params.slotPromptLengths[params.finishedSlots[i]] = 0;
+    }
+    __syncthreads();
+    for (int32_t i = tid; i < params.numNewSlots; i += kBatchPrepThreads)
+    {
+        params.slotPastLengths[params.newSlots[i]] = 0;
+        params.slotPromptLengths[params.newSlots[i]] = params.newPromptLengths[i];
+    }
+    if (tid == 0)
+    {
+        rowOffset = 0;
+    }
+    __syncthreads();
+
+    // Rows and the tokens of the generation rows, the context rows come first so their offsets are also the offsets
+    // of their chunks in contextTokens
+    for (int32_t rowBegin = 0; rowBegin < numRows; rowBegin += kBatchPrepThreads)
+    {
+        auto const row = rowBegin + tid;
+        auto const isValid = row < numRows;
+        auto const isContext = row < params.numContextRequests;
+        int32_t slot{0};
+        int32_t numTokens{0};
+        if (isValid)
+        {
+            slot = getRowSlot(params, row);
+            numTokens = isContext ? params.contextChunkLengths[row] : 1;
+        }
+        int32_t offset{0};
+        int32_t aggregate{0};
+        BlockScan(tempStorage).ExclusiveSum(numTokens, offset, aggregate);
+        offset += rowOffset;
+        if (isValid)
+        {
+            auto const pastLength = params.slotPastLengths[slot];
+            params.inputOffsets[row] = offset;
+            params.contextLengths[row] = params.slotPromptLengths[slot];
+            params.sequenceLengths[row] = pastLength + numTokens;
+            if (!isContext)
+            {
+                auto const beam = (row - params.numContextRequests) % params.beamWidth;
+                params.inputIds[offset] = params.newTokens[slot * params.beamWidth + beam];
+                params.positionIds[offset] = pastLength;
+            }
+        }
+        __syncthreads();
+        if (tid == 0)
+        {
+            rowOffset += aggregate;
+        }
+        __syncthreads();
+    }
+    if (tid == 0)
+    {
+        params.inputOffsets[numRows] = rowOffset;
+    }
+    __syncthreads();
+
+    // Tokens of the context chunks, the row of a token is found by bisecting the offsets
+    auto const numContextTokens
+        = params.numContextRequests > 0 ? params.inputOffsets[params.numContextRequests] : int32_t{0};
+    for (int32_t token = tid; token < numContextTokens; token += kBatchPrepThreads)
+    {
+        int32_t lo{0};
+        int32_t hi{params.numContextRequests - 1};
+        while (lo < hi)
+        {
+            auto const mid = (lo + hi + 1) / 2;
+            if (params.inputOffsets[mid] <= token)
+            {
+                lo = mid;
+            }
+            else
+            {
+                hi = mid - 1;
+            }
+        }
+        auto const slot = params.batchSlots[lo];
+        params.inputIds[token] = params.contextTokens[token];
+        params.positionIds[token] = params.slotPastLengths[slot] + token - params.inputOffsets[lo];
+    }
+    __syncthreads();
+
+    // Advance the slots once all rows read their past lengths, once per request
+    auto const numRequests = params.numContextRequests + params.numGenRequests;
+    for (int32_t request = tid; request < numRequests; request += kBatchPrepThreads)
+    {
+        auto const slot = params.batchSlots[request];
+        params.slotPastLengths[slot] += request < params.numContextRequests ? params.contextChunkLengths[request] : 1;
+    }
+}
+
+} // namespace
+
+void invokeBatchPrep(BatchPrepParams const& params, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(params.beamWidth > 0, "Beam width must be positive");
+    TLLM_CHECK_WITH_INFO(params.numGenRequests == 0 || params.newTokens != nullptr,
+        "Generation requests read their tokens from newTokens");
+    batchPrepKernel<<<1, kBatchPrepThreads, 0, stream>>>(params);
+    sync_check_cuda_error();
+}
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cuda_runtime_api.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+// Input preparation of a continuous batching step on the device. The lengths of the sequences are kept per batch slot
+// on the device across steps, so the host only uploads what changed: the slots of new and finished requests, the
+// scheduled slots and the prompt tokens of the context chunks. The tokens of the generation requests are read from
+// the tokens the decoder produced at the previous step.
+//
+// The step has numContextRequests context requests, with one row each, followed by numGenRequests generation
+// requests, with beamWidth rows each. The outputs have one entry per row, or per token for inputIds and positionIds,
+// and inputOffsets can be passed to invokeBuildDecoderInfo.
+
+struct BatchPrepParams
+{
+    // State of the slots with shape [maxBatchSize], kept across steps. Tokens of the slot in the KV cache.
+    int32_t* slotPastLengths{nullptr};
+    // Prompt length of the request in the slot.
+    int32_t* slotPromptLengths{nullptr};
+
+    // Slots freed since the previous step with shape [numFinishedSlots].
+    int32_t const* finishedSlots{nullptr};
+    int32_t numFinishedSlots{0};
+    // Slots of the requests added since the previous step with shape [numNewSlots]. Freed first, then added.
+    int32_t const* newSlots{nullptr};
+    // Prompt lengths of the new requests with shape [numNewSlots].
+    int32_t const* newPromptLengths{nullptr};
+    int32_t numNewSlots{0};
+
+    // Slots scheduled in the step, context requests first, with shape [numContextRequests + numGenRequests].
+    int32_t const* batchSlots{nullptr};
+    int32_t numContextRequests{0};
+    int32_t numGenRequests{0};
+    int32_t beamWidth{1};
+    // Tokens of the context chunks packed in request order with shape [sum(contextChunkLengths)].
+    int32_t const* contextTokens{nullptr};
+    // Tokens of the chunk of each context request with shape [numContextRequests].
+    int32_t const* contextChunkLengths{nullptr};
+    // Tokens of the previous step with shape [maxBatchSize, beamWidth].
+    int32_t const* newTokens{nullptr};
+
+    // Outputs, packed input ids and position ids with shape [numTokens].
+    int32_t* inputIds{nullptr};
+    int32_t* positionIds{nullptr};
+    // Prompt lengths with shape [numRows].
+    int32_t* contextLengths{nullptr};
+    // Lengths including the tokens of the step with shape [numRows].
+    int32_t* sequenceLengths{nullptr};
+    // Exclusive prefix sum of the tokens of the rows with shape [numRows + 1], like cu_seqlens.
+    int32_t* inputOffsets{nullptr};
+};
+
+// Build the inputs of a step and advance the lengths of the scheduled slots by the tokens of the step. A single
+// launch on the stream, the order with the decoder writing newTokens is kept by the stream.
+void invokeBatchPrep(BatchPrepParams const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -22,7 +22,7 @@ namespace tensorrt_llm
 {
 namespace kernels
 {
-static constexpr int nMaxBeamWidth = 64; // max beam width supported now
+static constexpr int nMaxBeamWidth = 256; // max beam width supported now
 static constexpr int nBlockSizeForSmallBeamWidth = 256;
 static constexpr int nMaxVocabPartForStage1FastKernel = 128;
 
@@ -48,6 +48,9 @@ struct BeamHypotheses
     float const* diversityRates{nullptr};           // [BS]
     float const* lengthPenalties{nullptr};          // [BS]
     int const* earlyStoppings{nullptr};             // [BS]
+    int const* beamWidths{nullptr};                 // [BS]             beam width per request, optional, <= nBeamWidth
+    int const* numBeamGroups{nullptr};              // [BS]             diverse beam search groups, optional
+    float const* groupDiversityPenalties{nullptr};  // [BS]             penalty of tokens picked by previous groups
 
     // Pointers from input
     int const* inputLengths{nullptr};               // [BS, BM]         %% context_length
@@ -83,6 +86,11 @@ struct BeamHypotheses
     int const* outputIdsUnfinish{nullptr};          // [BS, BM, MSL]   %% self.output_ids
     int const* parentIdsUnfinish{nullptr};          // [BS, BM, MSL]   %% self.parent_ids
 
+    // Pointers of the backtracked paths of the unfinished beams, optional, kept up to date by invokeUpdateBeamPaths
+    int* pathIds{nullptr};                          // [BS, BM, MSL]    token ids along the path
+    int* pathBeams{nullptr};                        // [BS, BM, MSL]    beam of the path at each step
+    int* pathLengths{nullptr};                      // [BS, BM]         steps of the path up to date
+
     // clang-format on
 };
 
@@ -40,16 +40,351 @@ namespace kernels
 
 #pragma nv_diag_suppress static_var_with_dynamic_init
 
+//! \brief Copies a beam finished by the candidate topId into the candidate-beam-array at index nCBA.
+__device__ __forceinline__ void copyBeamToCBA(BeamHypotheses& bh, int const slot, int const nCBA, int const topId,
+    float const cumLogProb, float const score, float const* smemCumLogProbs)
+{
+    int const nMBS{bh.nMaxBatchSize};
+    int const nBMMax{bh.nBeamWidth};
+    int const nV{bh.nVocabSize};
+    // The last token
+    int indexPrev = (topId / nV) % nBMMax;
+    int const step = bh.sequenceLengths[slot * nBMMax + indexPrev];
+    int const offsetCBA = (slot * nBMMax * 2 + nCBA) * bh.nMaxSeqLen;
+    bh.outputIdsCBA[offsetCBA + step] = bh.endIds[slot];
+    if (bh.logProbsCBA != nullptr)
+    {
+        bh.logProbsCBA[offsetCBA + step] = cumLogProb - smemCumLogProbs[indexPrev];
+    }
+    // Previous tokens
+    for (int j = step - 1; j >= 0; j--)
+    {
+        bh.outputIdsCBA[offsetCBA + j] = bh.outputIdsPtr[slot][indexPrev * bh.nMaxSeqLen + j];
+        indexPrev = bh.parentIdsPtr[slot][indexPrev * bh.nMaxSeqLen + j];
+    }
+    if (bh.logProbsCBA != nullptr && bh.logProbsTiled != nullptr)
+    {
+        indexPrev = (topId / nV) % nBMMax;
+        for (int j = step - 1; j >= 0; j--)
+        {
+            int const index = (j * nMBS + slot) * nBMMax + indexPrev;
+            bh.logProbsCBA[offsetCBA + j] = bh.logProbsTiled[index];
+            indexPrev = bh.parentIdsPtr[slot][indexPrev * bh.nMaxSeqLen + j];
+        }
+    }
+    // Other parameters
+    int const index = slot * (nBMMax * 2) + nCBA;
+    bh.sequenceLengthsCBA[index] = step;
+    bh.normedScoresCBA[index] = score;
+    bh.cumLogProbsCBA[index] = cumLogProb;
+}
+
+//! \brief Stage 3 of diverse beam search for the request of the block, see beamStage3Kernel.
+//! \details The beams of the request form nGroup groups of nBM / nGroup beams, searched one after the other. The
+//! candidates of a group are penalized by groupDiversityPenalty for every group before it that picked the same token
+//! for the next step (Hamming diversity). Every group keeps its own nBM / nGroup finished beams in the
+//! candidate-beam-array and is done on its own, the request is done with its last group. The finished beams of all
+//! groups are sorted together by finalize.
+//!
+//! The top 2 * nBM candidates of every beam hold the top 2 * nBM / nGroup of its group under the penalty, since the
+//! previous groups pick fewer than nBM tokens. The group of the finished beam k is kept in sequenceLengthsCBA of
+//! the beam nBM + k, which invokeInsertUnfinishedPath only fills once the request is finalized.
 template <typename T, int PAD_2K, int THREADBLOCK_SIZE>
-__launch_bounds__(THREADBLOCK_SIZE) __global__
-    void beamStage3Kernel(int const* __restrict pTempId, T const* __restrict pTempVal, BeamHypotheses bh)
+__device__ void beamStage3Grouped(int const* __restrict pTempId, T const* __restrict pTempVal,
+    T* __restrict pTempValScratch, BeamHypotheses& bh, float const* smemCumLogProbs)
+{
+    int const bid = blockIdx.x; // Index of Batch
+    int const tid = threadIdx.x;
+    auto const slot = bh.batchSlots[bid];
+    int const nMBS{bh.nMaxBatchSize}; // Only for bh.logProbsTiled
+    int const nBMMax{bh.nBeamWidth};
+    int const nBM{bh.beamWidths == nullptr ? nBMMax : bh.beamWidths[slot]};
+    int const nGroup{bh.numBeamGroups[slot]};
+    int const nBMGroup{nBM / nGroup};
+    int const nCandidate{nBMMax * nBMMax * 2};
+    int const nV{bh.nVocabSize};
+    float const diversityRate{bh.diversityRates[slot]};
+    float const groupDiversityPenalty{bh.groupDiversityPenalties[slot]};
+    float const lengthPenalty{bh.lengthPenalties[slot]};
+    int const earlyStopping{bh.earlyStoppings[slot]};
+    int const offsetCBA{slot * nBMMax * 2};
+    int* groupsCBA = bh.sequenceLengthsCBA + offsetCBA + nBMMax;
+
+    T const MAX_T_VAL = std::is_same_v<T, half> ? HALF_FLT_MAX : FLT_MAX;
+
+    __shared__ int smemChosenTokens[PAD_2K / 2]; // Tokens picked for the next step by the groups searched so far
+    __shared__ int nChosenTokens;
+    __shared__ bool smemGroupDone[PAD_2K / 2];
+
+    if (tid == 0)
+    {
+        nChosenTokens = 0;
+        if (bh.numBeamsCBA[slot] == 0)
+        {
+            bh.minNormedScoresCBA[slot] = FLT_MAX;
+        }
+    }
+    if (tid < nGroup)
+    {
+        // All beams of a done group are finished
+        bool isGroupDone{true};
+        for (int beam = tid * nBMGroup; beam < (tid + 1) * nBMGroup; ++beam)
+        {
+            isGroupDone &= bh.finished[slot * nBMMax + beam].isFinished();
+        }
+        smemGroupDone[tid] = isGroupDone;
+    }
+    __syncthreads();
+
+    bool allGroupsDone{true};
+    for (int g = 0; g < nGroup; ++g)
+    {
+        allGroupsDone &= smemGroupDone[g];
+    }
+    if (allGroupsDone)
+    {
+        return;
+    }
+
+    pTempId += bid * nCandidate;
+    pTempVal += bid * nCandidate;
+
+    using KVPair = cub::KeyValuePair<int, T>;
+    cub::ArgMax argmax;
+    extern __shared__ char smem[];
+    T* smemVal = pTempValScratch != nullptr ? pTempValScratch + bid * nCandidate : reinterpret_cast<T*>(smem);
+
+    using BlockReduce = cub::BlockReduce<KVPair, THREADBLOCK_SIZE>;
+    __shared__ typename BlockReduce::TempStorage smemReduceBuffer;
+    __shared__ KVPair smemTopKV[PAD_2K];
+    __shared__ int threadToUpdate;
+
+    for (int g = 0; g < nGroup; ++g)
+    {
+        int const beamBegin = g * nBMGroup;
+        if (smemGroupDone[g])
+        {
+            if (tid < nBMGroup)
+            {
+                // Finished beams keep their parent and get the end token
+                int const beam = beamBegin + tid;
+                int const step = bh.sequenceLengths[slot * nBMMax + beam];
+                bh.outputIdsPtr[slot][beam * bh.nMaxSeqLen + step] = beam * nV + bh.endIds[slot];
+            }
+            continue;
+        }
+
+        KVPair topKVPairPartial{nCandidate - 1, -MAX_T_VAL};
+        for (int i = tid; i < nCandidate; i += THREADBLOCK_SIZE)
+        {
+            int const indexBeam = i / 2 / nBMMax;
+            bool const isValid
+                = indexBeam >= beamBegin && indexBeam < beamBegin + nBMGroup && i % (2 * nBMMax) < 2 * nBM;
+            T val = -MAX_T_VAL;
+            if (isValid)
+            {
+                int const tokenId = pTempId[i] % nV;
+                int nPicked{0};
+                for (int j = 0; j < nChosenTokens; ++j)
+                {
+                    nPicked += smemChosenTokens[j] == tokenId;
+                }
+                val = pTempVal[i] + static_cast<T>(diversityRate * indexBeam - groupDiversityPenalty * nPicked);
+            }
+            topKVPairPartial = argmax(topKVPairPartial, {i, val});
+            smemVal[i] = val;
+        }
+        __syncthreads();
+
+        for (int i = 0; i < 2 * nBMGroup; ++i)
+        {
+            KVPair topKVPair = BlockReduce(smemReduceBuffer).Reduce(topKVPairPartial, argmax);
+            if (tid == 0)
+            {
+                smemTopKV[i] = topKVPair;
+                smemVal[topKVPair.key] = -MAX_T_VAL;
+                threadToUpdate = topKVPair.key % THREADBLOCK_SIZE;
+            }
+            __syncthreads();
+            if (tid == threadToUpdate && i < 2 * nBMGroup - 1)
+            {
+                topKVPairPartial.key = nCandidate - 1;
+                topKVPairPartial.value = -MAX_T_VAL;
+                for (int index = tid; index < nCandidate; index += THREADBLOCK_SIZE)
+                {
+                    topKVPairPartial = argmax(topKVPairPartial, {index, smemVal[index]});
+                }
+            }
+        }
+
+        if (tid == 0)
+        {
+            // Finished beams of the group and the worst of their scores
+            int nCBAGroup{0};
+            float minScoreGroup{FLT_MAX};
+            for (int k = 0; k < bh.numBeamsCBA[slot]; ++k)
+            {
+                if (groupsCBA[k] == g)
+                {
+                    nCBAGroup++;
+                    minScoreGroup = min(minScoreGroup, bh.normedScoresCBA[offsetCBA + k]);
+                }
+            }
+
+            int nBeamForNextStep{0};
+            for (int i = 0; i < 2 * nBMGroup; ++i)
+            {
+                int const topKey = smemTopKV[i].key;
+                int const topId = pTempId[topKey];
+                // Finished beams are ranked by their log probs, the penalties only steer the search
+                float const cumLogProb = (float) pTempVal[topKey];
+                bool const isEndToken = topId % nV == bh.endIds[slot];
+                if (i < nBMGroup && isEndToken)
+                {
+                    int const indexBatchBeam = slot * nBMMax + (topId / nV) % nBMMax;
+                    int const nSeqLen = bh.sequenceLengths[indexBatchBeam] + 1 - bh.inputLengths[indexBatchBeam];
+                    float const score = applyLengthPenalty(cumLogProb, nSeqLen, lengthPenalty);
+                    int nCBA = bh.numBeamsCBA[slot];
+                    if (nCBAGroup == nBMGroup)
+                    {
+                        if (score < minScoreGroup)
+                        {
+                            if (earlyStopping)
+                            {
+                                break;
+                            }
+                            continue;
+                        }
+                        // Replace the worst finished beam of the group
+                        for (int k = 0; k < bh.numBeamsCBA[slot]; ++k)
+                        {
+                            if (groupsCBA[k] == g && bh.normedScoresCBA[offsetCBA + k] == minScoreGroup)
+                            {
+                                nCBA = k;
+                                break;
+                            }
+                        }
+                    }
+                    else
+                    {
+                        nCBAGroup++;
+                        bh.numBeamsCBA[slot]++;
+                    }
+                    copyBeamToCBA(bh, slot, nCBA, topId, cumLogProb, score, smemCumLogProbs);
+                    groupsCBA[nCBA] = g;
+                    minScoreGroup = FLT_MAX;
+                    bh.minNormedScoresCBA[slot] = FLT_MAX;
+                    for (int k = 0; k < bh.numBeamsCBA[slot]; ++k)
+                    {
+                        float const scoreCBA = bh.normedScoresCBA[offsetCBA + k];
+                        minScoreGroup = groupsCBA[k] == g ? min(minScoreGroup, scoreCBA) : minScoreGroup;
+                        bh.minNormedScoresCBA[slot] = min(bh.minNormedScoresCBA[slot], scoreCBA);
+                    }
+                }
+                else if (!isEndToken)
+                {
+                    int const beam = beamBegin + nBeamForNextStep;
+                    int const step = bh.sequenceLengths[slot * nBMMax + beam];
+                    bh.outputIdsPtr[slot][beam * bh.nMaxSeqLen + step] = topId;
+                    if (bh.logProbsTiled != nullptr)
+                    {
+                        int const index = step * nMBS * nBMMax + slot * nBMMax + beam;
+                        bh.logProbsTiled[index] = cumLogProb - smemCumLogProbs[(topId / nV) % nBMMax];
+                    }
+                    bh.cumLogProbs[slot * nBMMax + beam] = cumLogProb;
+                    smemChosenTokens[nChosenTokens++] = topId % nV;
+                    nBeamForNextStep++;
+                }
+                if (nBeamForNextStep >= nBMGroup)
+                {
+                    break;
+                }
+            }
+            // Beams left without a token after an early stop keep their parent
+            for (int beam = beamBegin + nBeamForNextStep; beam < beamBegin + nBMGroup; ++beam)
+            {
+                int const step = bh.sequenceLengths[slot * nBMMax + beam];
+                bh.outputIdsPtr[slot][beam * bh.nMaxSeqLen + step] = beam * nV + bh.endIds[slot];
+            }
+
+            bool isGroupDone{false};
+            if (nCBAGroup == nBMGroup)
+            {
+                if (earlyStopping == 1)
+                {
+                    isGroupDone = true;
+                }
+                else
+                {
+                    int const indexBatchBeam = slot * nBMMax + beamBegin;
+                    int nSeqLen = bh.sequenceLengths[indexBatchBeam] + 1 - bh.inputLengths[indexBatchBeam];
+                    if (earlyStopping != 0 && lengthPenalty > 0.0f)
+                    {
+                        nSeqLen = bh.nMaxSeqLen - bh.inputLengths[indexBatchBeam];
+                    }
+                    float const bestCumLogProbs = (float) pTempVal[smemTopKV[0].key];
+                    isGroupDone = minScoreGroup >= applyLengthPenalty(bestCumLogProbs, nSeqLen, lengthPenalty);
+                }
+            }
+            smemGroupDone[g] = isGroupDone;
+        }
+        __syncthreads();
+    }
+
+    if (tid == 0)
+    {
+        bool isDone{true};
+        for (int g = 0; g < nGroup; ++g)
+        {
+            isDone &= smemGroupDone[g];
+        }
+        bh.batchDones[slot] = isDone;
+    }
+
+    // Update sequenceLengths, parentIdsPtr, outputIdsPtr and finished
+    __shared__ int smemSeqLen[PAD_2K / 2];
+    if (tid < nBM)
+    {
+        smemSeqLen[tid] = bh.sequenceLengths[slot * nBMMax + tid];
+    }
+    __syncthreads();
+
+    if (tid < nBM)
+    {
+        int const indexBatchBeam = slot * nBMMax + tid;
+        int const step = smemSeqLen[tid];
+        if (!bh.finished[indexBatchBeam].isFinished())
+        {
+            smemSeqLen[tid]++;
+        }
+        int const newId = bh.outputIdsPtr[slot][tid * bh.nMaxSeqLen + step];
+        int const newBeamId = (newId / nV) % nBMMax;
+        int const newTokenId = newId % nV;
+        bh.sequenceLengths[indexBatchBeam] = smemSeqLen[newBeamId];
+        if (newTokenId == bh.endIds[slot])
+        {
+            bh.finished[indexBatchBeam].setFinishedEOS();
+        }
+        bh.parentIdsPtr[slot][tid * bh.nMaxSeqLen + step] = newBeamId;
+        bh.outputIdsPtr[slot][tid * bh.nMaxSeqLen + step] = newTokenId;
+        if (smemGroupDone[tid / nBMGroup])
+        {
+            bh.finished[indexBatchBeam].setFinished();
+        }
+    }
+}
+
+template <typename T, int PAD_2K, int THREADBLOCK_SIZE>
+__launch_bounds__(THREADBLOCK_SIZE) __global__ void beamStage3Kernel(
+    int const* __restrict pTempId, T const* __restrict pTempVal, T* __restrict pTempValScratch, BeamHypotheses bh)
 {
     int const bid = blockIdx.x; // Index of Batch
     int const tid = threadIdx.x;
     auto const slot = bh.batchSlots[bid];
     int const nMBS{bh.nMaxBatchSize};    // Only for bh.logProbsTiled
-    int const nBM{bh.nBeamWidth};
-    int const nCandidate{nBM * nBM * 2}; // Keep top 2K candidates from each beam output
+    int const nBMMax{bh.nBeamWidth};     // Stride of the beams of a request in all buffers
+    int const nBM{bh.beamWidths == nullptr ? nBMMax : bh.beamWidths[slot]};
+    int const nCandidate{nBMMax * nBMMax * 2}; // Keep top 2K candidates from each beam output
     int const nV{bh.nVocabSize};
     float const diversityRate{bh.diversityRates[slot]};
     float const lengthPenalty{bh.lengthPenalties[slot]};
@@ -66,10 +401,16 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
     }
     if (tid < nBM)
     {
-        smemCumLogProbs[tid] = bh.cumLogProbs[slot * nBM + tid];
+        smemCumLogProbs[tid] = bh.cumLogProbs[slot * nBMMax + tid];
     }
     __syncthreads();
 
+    if (bh.numBeamGroups != nullptr && bh.numBeamsCBA != nullptr && bh.numBeamGroups[slot] > 1)
+    {
+        beamStage3Grouped<T, PAD_2K, THREADBLOCK_SIZE>(pTempId, pTempVal, pTempValScratch, bh, smemCumLogProbs);
+        return;
+    }
+
     if (bh.numBeamsCBA != nullptr)
     {
         // Beam search is enabled
@@ -79,7 +420,7 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
             bh.minNormedScoresCBA[slot] = FLT_MAX;
         }
         else if (earlyStopping == 1 && bh.numBeamsCBA[slot] == nBM
-            || earlyStopping != 1 && bh.finished[slot * nBM].isFinished())
+            || earlyStopping != 1 && bh.finished[slot * nBMMax].isFinished())
         {
             // Condition of early return:
             // 1. In EarlyStopping mode, and we have got enough beams
@@ -97,13 +438,17 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
     using KVPair = cub::KeyValuePair<int, T>;
     KVPair topKVPairPartial{nCandidate - 1, -MAX_T_VAL};
     cub::ArgMax argmax;
+    // Candidates are polluted once selected, in shared memory or in a global scratch buffer if they do not fit
     extern __shared__ char smem[];
-    T* smemVal = reinterpret_cast<T*>(smem);
+    T* smemVal = pTempValScratch != nullptr ? pTempValScratch + bid * nCandidate : reinterpret_cast<T*>(smem);
 
     for (int i = tid; i < nCandidate; i += THREADBLOCK_SIZE)
     {
-        int const index = bh.numBeamsCBA == nullptr ? i % nBM : i / 2 / nBM;
-        T const val = pTempVal[i] + static_cast<T>(diversityRate * index);
+        // Beams beyond the beam width of the request and their candidates were not computed
+        int const indexBeam = i / 2 / nBMMax;
+        bool const isValid = indexBeam < nBM && i % (2 * nBMMax) < 2 * nBM;
+        int const index = bh.numBeamsCBA == nullptr ? i % nBMMax : indexBeam;
+        T const val = isValid ? pTempVal[i] + static_cast<T>(diversityRate * index) : -MAX_T_VAL;
         topKVPairPartial = argmax(topKVPairPartial, {i, val});
         smemVal[i] = val;
     }
@@ -151,7 +496,7 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
             {
                 // Condition of this branch
                 // This token is end-token and belongs to top nBM range in Beam search mode
-                int const nSeqLen = bh.sequenceLengths[slot * nBM + i] + 1 - bh.inputLengths[slot * nBM + i];
+                int const nSeqLen = bh.sequenceLengths[slot * nBMMax + i] + 1 - bh.inputLengths[slot * nBMMax + i];
                 float const score = applyLengthPenalty(topValue, nSeqLen, lengthPenalty);
                 int nCBA = bh.numBeamsCBA[slot];
                 if (nCBA == nBM)
@@ -177,56 +522,25 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
                         // Find the candidate beam index with the worst score and erase it
                         for (int j = 0; j < nBM; j++)
                         {
-                            if (bh.normedScoresCBA[slot * (nBM * 2) + j] == bh.minNormedScoresCBA[slot])
+                            if (bh.normedScoresCBA[slot * (nBMMax * 2) + j] == bh.minNormedScoresCBA[slot])
                             {
                                 nCBA = j;
                                 bh.numBeamsCBA[slot]--;
                                 bh.minNormedScoresCBA[slot] = FLT_MAX;
-                                bh.normedScoresCBA[slot * (nBM * 2) + j] = score;
+                                bh.normedScoresCBA[slot * (nBMMax * 2) + j] = score;
                                 for (int l = 0; l < nBM; l++)
                                 {
-                                    bh.minNormedScoresCBA[slot]
-                                        = min(bh.minNormedScoresCBA[slot], bh.normedScoresCBA[slot * (nBM * 2) + l]);
+                                    bh.minNormedScoresCBA[slot] = min(
+                                        bh.minNormedScoresCBA[slot], bh.normedScoresCBA[slot * (nBMMax * 2) + l]);
                                 }
                                 break;
                             }
                         }
                     }
                 }
-                // Copy finished beam from work tree to CBA
-                // The last token
-                int indexPrev = (pTempId[topKey] / nV) % nBM;
-                int const step = bh.sequenceLengths[slot * nBM + indexPrev];
-                int const offsetCBA = (slot * nBM * 2 + nCBA) * bh.nMaxSeqLen;
-                bh.outputIdsCBA[offsetCBA + step] = bh.endIds[slot];
-                if (bh.logProbsCBA != nullptr)
-                {
-                    bh.logProbsCBA[offsetCBA + step]
-                        = (float) pTempVal[topKey] - smemCumLogProbs[(pTempId[topKey] / nV) % nBM];
-                }
-                // Previous tokens
-                for (int j = step - 1; j >= 0; j--)
-                {
-                    bh.outputIdsCBA[offsetCBA + j] = bh.outputIdsPtr[slot][indexPrev * bh.nMaxSeqLen + j];
-                    indexPrev = bh.parentIdsPtr[slot][indexPrev * bh.nMaxSeqLen + j];
-                }
-                if (bh.logProbsCBA != nullptr && bh.logProbsTiled != nullptr)
-                {
-                    indexPrev = (pTempId[topKey] / nV) % nBM;
-                    for (int j = step - 1; j >= 0; j--)
-                    {
-                        int const index = (j * nMBS + slot) * nBM + indexPrev;
-                        bh.logProbsCBA[offsetCBA + j] = bh.logProbsTiled[index];
-                        indexPrev = bh.parentIdsPtr[slot][indexPrev * bh.nMaxSeqLen + j];
-                    }
-                }
-                // Other parameters
-                int const index = slot * (nBM * 2) + nCBA;
-                bh.sequenceLengthsCBA[index] = step;
-                bh.normedScoresCBA[index] = score;
-                bh.minNormedScoresCBA[slot] = min(bh.minNormedScoresCBA[slot], bh.normedScoresCBA[index]);
+                copyBeamToCBA(bh, slot, nCBA, pTempId[topKey], (float) pTempVal[topKey], score, smemCumLogProbs);
+                bh.minNormedScoresCBA[slot] = min(bh.minNormedScoresCBA[slot], score);
                 bh.numBeamsCBA[slot]++;
-                bh.cumLogProbsCBA[index] = (float) pTempVal[topKey];
             }
             else if (i < nBM || bh.numBeamsCBA != nullptr && !isEndToken)
             {
@@ -234,16 +548,16 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
                 // 1. bh.numBeamsCBA == nullptr && i <  nBM, i.e., beam search is disable
                 // 2. bh.numBeamsCBA != nullptr && i <  nBM && isEndToken == false, i.e., add token at the end
                 // 3. bh.numBeamsCBA != nullptr && i >= nBM && isEndToken == false, i.e., add token at the end
-                int const step = bh.sequenceLengths[slot * nBM + nBeamForNextStep];
+                int const step = bh.sequenceLengths[slot * nBMMax + nBeamForNextStep];
                 // Copy the selected token to work tree
                 bh.outputIdsPtr[slot][nBeamForNextStep * bh.nMaxSeqLen + step] = pTempId[topKey];
                 if (bh.logProbsTiled != nullptr)
                 {
-                    int const index = step * nMBS * nBM + slot * nBM + nBeamForNextStep;
-                    int const indexBeam = pTempId[topKey] / nV % nBM;
+                    int const index = step * nMBS * nBMMax + slot * nBMMax + nBeamForNextStep;
+                    int const indexBeam = pTempId[topKey] / nV % nBMMax;
                     bh.logProbsTiled[index] = (float) pTempVal[topKey] - smemCumLogProbs[indexBeam];
                 }
-                bh.cumLogProbs[slot * nBM + nBeamForNextStep] = (float) pTempVal[topKey];
+                bh.cumLogProbs[slot * nBMMax + nBeamForNextStep] = (float) pTempVal[topKey];
                 nBeamForNextStep++;
             }
             else
@@ -282,7 +596,7 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
         else
         {
             // enough beams in NonEarlyStopping mode
-            int nSeqLen = bh.sequenceLengths[slot * nBM] + 1 - bh.inputLengths[slot * nBM];
+            int nSeqLen = bh.sequenceLengths[slot * nBMMax] + 1 - bh.inputLengths[slot * nBMMax];
             float const bestCumLogProbs = smemTopKV[0].value;
             // According to semantics of HF, smemTopKV[0].value is used as bestCumLogProbs
             // But maybe bh.cumLogProbs[slot * nBM + i] is more suitable?
@@ -290,7 +604,7 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
             if (earlyStopping != 0 && lengthPenalty > 0.0f)
             {
                 // Specialization for earlyStopping == "never" and lengthPenalty > 0 in HF
-                nSeqLen = bh.nMaxSeqLen - bh.inputLengths[slot * nBM];
+                nSeqLen = bh.nMaxSeqLen - bh.inputLengths[slot * nBMMax];
             }
             float const bestAttainableScore = applyLengthPenalty(bestCumLogProbs, nSeqLen, lengthPenalty);
             bh.batchDones[slot] = bh.minNormedScoresCBA[slot] >= bestAttainableScore;
@@ -302,20 +616,20 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
     __shared__ int smemSeqLen[PAD_2K / 2];
     if (tid < nBM)
     {
-        smemSeqLen[tid] = bh.sequenceLengths[slot * nBM + tid];
+        smemSeqLen[tid] = bh.sequenceLengths[slot * nBMMax + tid];
     }
     __syncthreads();
 
     if (tid < nBM)
     {
-        int const indexBatchBeam = slot * nBM + tid;
+        int const indexBatchBeam = slot * nBMMax + tid;
         int const step = smemSeqLen[tid];
         if (!bh.finished[indexBatchBeam].isFinished())
         {
             smemSeqLen[tid]++;
         }
         int const newId = bh.outputIdsPtr[slot][tid * bh.nMaxSeqLen + step];
-        int const newBeamId = (newId / nV) % nBM;
+        int const newBeamId = (newId / nV) % nBMMax;
         int const newTokenId = newId % nV;
         bh.sequenceLengths[indexBatchBeam] = smemSeqLen[newBeamId];
         if (newTokenId == bh.endIds[slot])
@@ -353,15 +667,21 @@ template <typename T, int PAD_2K, int THREADBLOCK_SIZE>
 __launch_bounds__(THREADBLOCK_SIZE, 1) __global__
     void beamStage1Kernel(T const* __restrict logits, T const* __restrict bias, float* __restrict pTemp,
         int const* __restrict endIds, FinishedState const* __restrict finished, int const nV, int const nVLocal,
-        runtime::SizeType32 const* batchSlots, int dyn_smem_size)
+        runtime::SizeType32 const* batchSlots, int const* __restrict beamWidths, int dyn_smem_size)
 {
     constexpr auto PACKED_TOP_KMD_SIZE = 2 * PAD_2K + 2;
-    int const nBM = gridDim.y;
+    int const nBMMax = gridDim.y;
     int const tid = threadIdx.x;
     int const slot = batchSlots[blockIdx.x];
+    int const nBM = beamWidths == nullptr ? nBMMax : beamWidths[slot];
+    if (blockIdx.y >= nBM)
+    {
+        // Beam beyond the beam width of the request
+        return;
+    }
     int const section_start = nVLocal * blockIdx.z;
     int const section_end = std::min(section_start + nVLocal, nV);
-    auto const nVOffset = (blockIdx.x * nBM + blockIdx.y) * nV;
+    auto const nVOffset = (blockIdx.x * nBMMax + blockIdx.y) * nV;
     int const valid_smem_length = section_end - section_start;
     T const MAX_T_VAL = std::is_same_v<T, half> ? HALF_FLT_MAX : FLT_MAX;
 
@@ -381,7 +701,7 @@ __launch_bounds__(THREADBLOCK_SIZE, 1) __global__
     KVPair topKVPairPartial{-1, -MAX_T_VAL};
     cub::ArgMax argmax;
 
-    if (finished[slot * nBM + blockIdx.y].isFinished())
+    if (finished[slot * nBMMax + blockIdx.y].isFinished())
     {
         for (int i = section_start + tid; i < section_end; i += THREADBLOCK_SIZE)
         {
@@ -464,8 +784,8 @@ __launch_bounds__(THREADBLOCK_SIZE, 1) __global__
     __syncthreads();
 
     // Write the smemOutput into pTemp
-    float* local_temp_buffer
-        = pTemp + (blockIdx.x * nBM + blockIdx.y) * PACKED_TOP_KMD_SIZE * gridDim.z + blockIdx.z * PACKED_TOP_KMD_SIZE;
+    float* local_temp_buffer = pTemp + (blockIdx.x * nBMMax + blockIdx.y) * PACKED_TOP_KMD_SIZE * gridDim.z
+        + blockIdx.z * PACKED_TOP_KMD_SIZE;
     for (int i = tid; i < PACKED_TOP_KMD_SIZE; i += THREADBLOCK_SIZE)
     {
         local_temp_buffer[i] = smemOutput[i];
@@ -475,13 +795,20 @@ __launch_bounds__(THREADBLOCK_SIZE, 1) __global__
 template <typename T, int PAD_2K, int THREADBLOCK_SIZE, bool IS_FAST_KERNEL>
 __launch_bounds__(THREADBLOCK_SIZE) __global__
     void beamStage2Kernel(int* __restrict pTempId, T* __restrict pTempVal, float* __restrict pTemp,
-        float const* __restrict cumLogProbs, runtime::SizeType32 const* batchSlots, int const nV, int const nVPart)
+        float const* __restrict cumLogProbs, runtime::SizeType32 const* batchSlots, int const* __restrict beamWidths,
+        int const nV, int const nVPart)
 {
     constexpr int PACKED_TOP_KMD_SIZE = 2 * PAD_2K + 2;
-    auto const nBM = gridDim.y;
+    int const nBMMax = gridDim.y;
     auto const gbid = blockIdx.x * gridDim.y + blockIdx.y;
     int const tid = threadIdx.x;
     auto const slot = batchSlots[blockIdx.x];
+    int const nBM = beamWidths == nullptr ? nBMMax : beamWidths[slot];
+    if (blockIdx.y >= nBM)
+    {
+        // Beam beyond the beam width of the request
+        return;
+    }
     T const MAX_T_VAL = std::is_same_v<T, half> ? HALF_FLT_MAX : FLT_MAX;
 
     using KVPair = cub::KeyValuePair<int, T>;
@@ -561,7 +888,7 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
     if (tid == 0)
     {
         float d_total_log = logf(total_md.d);
-        auto const cumLogProbsValue = cumLogProbs[slot * nBM + blockIdx.y];
+        auto const cumLogProbsValue = cumLogProbs[slot * nBMMax + blockIdx.y];
 
         for (int i = 0; i < 2 * nBM; ++i)
         {
@@ -569,8 +896,8 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
             // Old version (do softmax in `beamStage*Kernel`) is below
             // We reserve this because we do not know whether HF will unify its workflow as simpling
             // float val = (float) buf_smem_kv[i].value - total_md.m - d_total_log;
-            pTempId[gbid * 2 * nBM + i] = buf_smem_kv[i].key;
-            pTempVal[gbid * 2 * nBM + i] = val + cumLogProbsValue;
+            pTempId[gbid * 2 * nBMMax + i] = buf_smem_kv[i].key;
+            pTempVal[gbid * 2 * nBMMax + i] = val + cumLogProbsValue;
         }
     }
 }
@@ -584,14 +911,14 @@ __launch_bounds__(THREADBLOCK_SIZE) __global__
         }                                                                                                              \
         beamStage2Kernel<T, PAD_2K, N_VOCAB_PART, IS_FAST_KERNEL>                                                      \
             <<<dim3(nBS, nBM), N_VOCAB_PART, IS_FAST_KERNEL * nShareMemory, stream>>>(                                 \
-                pTempId, pTempVal, pTemp, cumLogProbs, batchSlots, nV, nVPart);                                        \
+                pTempId, pTempVal, pTemp, cumLogProbs, batchSlots, beamWidths, nV, nVPart);                            \
     }                                                                                                                  \
     return;
 
 template <typename T, int PAD_2K>
 __inline__ void beamStage2KernelLauncher(float* pTemp, float const* cumLogProbs, int* pTempId, T* pTempVal,
-    runtime::SizeType32 const* batchSlots, int const nBS, int const nBM, int const nVPart, int const nV,
-    int const max_smem_per_block, cudaStream_t stream)
+    runtime::SizeType32 const* batchSlots, int const* beamWidths, int const nBS, int const nBM, int const nVPart,
+    int const nV, int const max_smem_per_block, cudaStream_t stream)
 {
     // TODO: rewrite kernel to remove dependence of constant block size to reduce compilation time
     size_t const nShareMemory = sizeof(float) * nVPart * (2 * PAD_2K + 2) + sizeof(cub::KeyValuePair<int, T>) * PAD_2K;
@@ -627,6 +954,8 @@ void topKSoftMaxKernelLauncher(T const* logits, T const* bias, void* workspace,
     // ┣━━━━━━━━━━┫ ----------------------------------------- Change "PAD_K" into "BM" -------------
     // ┃ pTempVal ┃ BS * PAD_K * PAD_K * 2                  |                          | float     |
     // ┣━━━━━━━━━━┫ ----------------------------------------- in the left formulas     -------------
+    // ┃ pScratch ┃ BS * PAD_K * PAD_K * 2                  |                          | float     |
+    // ┣━━━━━━━━━━┫ --------------------------------------------------------------------------------
     // ┃ pTemp    ┃ BS * PAD_K * VP * (2 * (PAD_K * 2) + 2) |                          | float     |
     // ┗━━━━━━━━━━┛ --------------------------------------------------------------------------------
 
@@ -652,23 +981,29 @@ void topKSoftMaxKernelLauncher(T const* logits, T const* bias, void* workspace,
     //   writes output topk_id into in pTempId, writes topk_value + cumLogProbs into pTempVal.
 
     // beamStage3Kernel: gridDim(BS,1,1), blockDim(128,1,1)
+    // The BM * BM * 2 candidates of a batch are kept in share memory, or in pScratch for large beam widths.
     // Each TheadBlock is responsible for one batch, doing work below:
     //   + moves one beam into candidate-beam-array if it is finished (gemerated end_id in this step).
     //   + selects BM elements for the next generation step if not.
     //   + maintains related score array, min_normed_score / batchDones / finished, etc..
 
+    // With bh.beamWidths, requests may use fewer beams than BM. Their other beams are skipped by all stages, while
+    // the buffers keep the layout of BM beams per request.
+
     int constexpr nBlockSize = (PAD_K < 16) ? ((PAD_K < 8) ? nBlockSizeForSmallBeamWidth : 128) : 64;
     int const nBS{bh.nBatchSize};
     int const nBM{bh.nBeamWidth};
     int const nV{bh.nVocabSize};
     int const* endIds{bh.endIds};
     runtime::SizeType32 const* batchSlots{bh.batchSlots};
+    int const* beamWidths{bh.beamWidths};
     FinishedState const* finished{bh.finished};
 
     int const offset = roundUp(nBS * nBM * nBM * 2, 4);
     int* pTempId = reinterpret_cast<int*>(workspace);
     T* pTempVal = reinterpret_cast<T*>(pTempId + offset);
-    float* pTemp = reinterpret_cast<float*>(pTempVal + offset);
+    T* pScratch = pTempVal + offset;
+    float* pTemp = reinterpret_cast<float*>(pScratch + offset);
 
     // Upper limit count of ThreadBlock, gotten by using no share memory
     int max_active_blocks = -1;
@@ -713,26 +1048,33 @@ void topKSoftMaxKernelLauncher(T const* logits, T const* bias, void* workspace,
 
     dim3 gridSize(nBS, nBM, nVPart);
     beamStage1Kernel<T, 2 * PAD_K, nBlockSize><<<gridSize, nBlockSize, dyn_smem_size, stream>>>(
-        logits, bias, pTemp, endIds, finished, nV, nVocabChunk, batchSlots, dyn_smem_size);
+        logits, bias, pTemp, endIds, finished, nV, nVocabChunk, batchSlots, beamWidths, dyn_smem_size);
 
     sync_check_cuda_error();
 
-    beamStage2KernelLauncher<T, 2 * PAD_K>(
-        pTemp, bh.cumLogProbs, pTempId, pTempVal, batchSlots, nBS, nBM, nVPart, nV, max_smem_per_block, stream);
+    beamStage2KernelLauncher<T, 2 * PAD_K>(pTemp, bh.cumLogProbs, pTempId, pTempVal, batchSlots, beamWidths, nBS, nBM,
+        nVPart, nV, max_smem_per_block, stream);
 
     sync_check_cuda_error();
 
     // Keep top 2K candidates in case of k candidates finishes in one iteration
-    size_t const nShareMemory = sizeof(T) * nBM * nBM * 2;
+    size_t nShareMemory = sizeof(T) * nBM * nBM * 2;
     size_t constexpr nBlockSizeStage3 = (PAD_K + 31) / 32 * 32; // can not use `roundUp()`
-    if (nShareMemory >= (48 << 10))
+    TLLM_CUDA_CHECK(cudaFuncGetAttributes(&attr, beamStage3Kernel<T, PAD_K * 2, nBlockSizeStage3>));
+    bool const useScratch = nShareMemory + attr.sharedSizeBytes > static_cast<size_t>(max_smem_per_block);
+    if (useScratch)
+    {
+        // Each pass over the candidates reads global memory instead of share memory
+        nShareMemory = 0;
+    }
+    else if (nShareMemory >= (48 << 10))
     {
         TLLM_CUDA_CHECK(cudaFuncSetAttribute(beamStage3Kernel<T, PAD_K * 2, nBlockSizeStage3>,
             cudaFuncAttributeMaxDynamicSharedMemorySize, nShareMemory));
     }
 
-    beamStage3Kernel<T, PAD_K * 2, nBlockSizeStage3>
-        <<<nBS, nBlockSizeStage3, nShareMemory, stream>>>(pTempId, pTempVal, bh);
+    beamStage3Kernel<T, PAD_K * 2, nBlockSizeStage3><<<nBS, nBlockSizeStage3, nShareMemory, stream>>>(
+        pTempId, pTempVal, useScratch ? pScratch : nullptr, bh);
     sync_check_cuda_error();
 }
 
@@ -84,6 +84,43 @@ void invokeBuildRelativeAttentionBias(T* relative_attention_bias, T const* relat
         head_num, seq_len, num_bucket, is_bidirectional, max_distance);
 }
 
+template <typename T>
+__global__ void buildRelativeAttentionBiasPerDistance(T* relative_attention_bias_per_distance,
+    T const* relative_attention_bias_table, int const num_bucket, int const max_distance)
+{
+    int const head_id = blockIdx.x;
+    int const max_exact = num_bucket / 2;
+    for (int relative_position = threadIdx.x; relative_position < max_distance; relative_position += blockDim.x)
+    {
+        bool is_small = relative_position < max_exact;
+
+        int relative_position_if_large = max_exact
+            + (int) (logf(relative_position * 1.0f / max_exact) / logf((float) max_distance / max_exact)
+                * (num_bucket - max_exact));
+
+        relative_position_if_large = min(relative_position_if_large, num_bucket - 1);
+
+        int const relative_buckets = is_small ? relative_position : relative_position_if_large;
+
+        relative_attention_bias_per_distance[head_id * max_distance + relative_position]
+            = relative_attention_bias_table[head_id * num_bucket + relative_buckets];
+    }
+}
+
+template <typename T>
+void invokeBuildRelativeAttentionBiasPerDistance(T* relative_attention_bias_per_distance,
+    T const* relative_attention_bias_table, int const head_num, int const num_bucket, int const max_distance,
+    cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(max_distance > num_bucket / 2,
+        "The per distance relative attention bias needs max_distance (%d) > num_bucket / 2 (%d).", max_distance,
+        num_bucket / 2);
+    dim3 grid(head_num);
+    dim3 block(256);
+    buildRelativeAttentionBiasPerDistance<<<grid, block, 0, stream>>>(
+        relative_attention_bias_per_distance, relative_attention_bias_table, num_bucket, max_distance);
+}
+
 template void invokeBuildRelativeAttentionBias<float>(float* relative_attention_bias,
     float const* relative_attention_bias_table, int const head_num, int const seq_len, int const num_bucket,
     bool const is_bidirectional, int const max_distance, cudaStream_t stream);
@@ -98,5 +135,19 @@ template void invokeBuildRelativeAttentionBias<__nv_bfloat16>(__nv_bfloat16* rel
     bool const is_bidirectional, int const max_distance, cudaStream_t stream);
 #endif
 
+template void invokeBuildRelativeAttentionBiasPerDistance<float>(float* relative_attention_bias_per_distance,
+    float const* relative_attention_bias_table, int const head_num, int const num_bucket, int const max_distance,
+    cudaStream_t stream);
+
+template void invokeBuildRelativeAttentionBiasPerDistance<half>(half* relative_attention_bias_per_distance,
+    half const* relative_attention_bias_table, int const head_num, int const num_bucket, int const max_distance,
+    cudaStream_t stream);
+
+#ifdef ENABLE_BF16
+template void invokeBuildRelativeAttentionBiasPerDistance<__nv_bfloat16>(
+    __nv_bfloat16* relative_attention_bias_per_distance, __nv_bfloat16 const* relative_attention_bias_table,
+    int const head_num, int const num_bucket, int const max_distance, cudaStream_t stream);
+#endif
+
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -29,5 +29,13 @@ void invokeBuildRelativeAttentionBias(T* relative_attention_bias, T const* relat
     int const head_num, int const seq_len, int const num_bucket, bool const is_bidirectional, int const max_distance,
     cudaStream_t stream);
 
+// Gathers the unidirectional relative attention bias of every distance in [0, max_distance) from the bucketed table
+// [head_num, num_bucket] into [head_num, max_distance]. Distances of max_distance and beyond all fall into the last
+// bucket, i.e. share the bias of distance max_distance - 1, as long as max_distance > num_bucket / 2.
+template <typename T>
+void invokeBuildRelativeAttentionBiasPerDistance(T* relative_attention_bias_per_distance,
+    T const* relative_attention_bias_table, int const head_num, int const num_bucket, int const max_distance,
+    cudaStream_t stream);
+
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/reduceKernelUtils.cuh"
+#include "tensorrt_llm/kernels/cascadeAttentionKernels.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+constexpr int kNumWarps = 8;
+constexpr int kQueriesPerWarp = 4;
+constexpr int kQueriesPerCta = kNumWarps * kQueriesPerWarp;
+constexpr int kTileTokens = 32;
+constexpr int kMaxHeadSize = 256;
+
+//! Views into CascadeAttentionParams::prefixGroups
+struct PrefixGroupsView
+{
+    int32_t const* groupOffsets;
+    int32_t const* seqIdx;
+    int32_t const* prefixLengths;
+    int32_t const* seqPrefixLengths;
+
+    __device__ PrefixGroupsView(int32_t const* packed, int32_t numGroups, int32_t numGroupedSeqs)
+        : groupOffsets{packed}
+        , seqIdx{packed + numGroups + 1}
+        , prefixLengths{packed + numGroups + 1 + numGroupedSeqs}
+        , seqPrefixLengths{packed + 2 * numGroups + 1 + numGroupedSeqs}
+    {
+    }
+};
+
+//! Partial softmax states: unnormalized output, running max and running sum of every (state, sequence, head).
+//! States [0, numSplits) cover the suffix splits, states [numSplits, 2 * numSplits) the prefix splits.
+struct PartialStates
+{
+    float* acc;
+    float* max;
+    float* sum;
+
+    __host__ __device__ PartialStates(void* workspace, int32_t batchSize, int32_t numHeads, int32_t headSize,
+        int32_t numSplits)
+    {
+        auto const numRows = static_cast<size_t>(2 * numSplits) * batchSize * numHeads;
+        acc = static_cast<float*>(workspace);
+        max = acc + numRows * headSize;
+        sum = max + numRows;
+    }
+};
+
+//! \brief Attend up to kQueriesPerWarp queries of a warp to the KV tokens [tokenBegin, tokenEnd) of kvSeqIdx.
+//! \details K/V tiles are loaded into shared memory once and used by all warps of the CTA. Lane l of a warp owns
+//! dims l, l + 32, ... of the head. A query with rowIdx < 0 is inactive.
+template <typename T, int kDimsPerLane>
+__device__ void attendKvRange(CascadeAttentionParams<T> const& params, PartialStates const& states, int32_t stateIdx,
+    int32_t kvSeqIdx, int32_t kvHeadIdx, int32_t tokenBegin, int32_t tokenEnd, int32_t const (&seqIdx)[kQueriesPerWarp],
+    int32_t const (&headIdx)[kQueriesPerWarp])
+{
+    extern __shared__ char smem[];
+    T* sK = reinterpret_cast<T*>(smem);
+    T* sV = sK + kTileTokens * params.headSize;
+
+    auto const headSize = params.headSize;
+    auto const lane = static_cast<int32_t>(threadIdx.x % 32);
+    float const negInf = -INFINITY;
+
+    float q[kQueriesPerWarp][kDimsPerLane];
+    float acc[kQueriesPerWarp][kDimsPerLane];
+    float rowMax[kQueriesPerWarp];
+    float rowSum[kQueriesPerWarp];
+#pragma unroll
+    for (int j = 0; j < kQueriesPerWarp; ++j)
+    {
+        rowMax[j] = negInf;
+        rowSum[j] = 0.f;
+#pragma unroll
+        for (int i = 0; i < kDimsPerLane; ++i)
+        {
+            acc[j][i] = 0.f;
+            q[j][i] = 0.f;
+            if (seqIdx[j] >= 0)
+            {
+                auto const qOffset = (static_cast<size_t>(seqIdx[j]) * params.numHeads + headIdx[j]) * headSize;
+                q[j][i] = cuda_cast<float>(params.q[qOffset + lane + 32 * i]) * params.qkScale;
+            }
+        }
+    }
+
+    for (int32_t tileBegin = tokenBegin; tileBegin < tokenEnd; tileBegin += kTileTokens)
+    {
+        auto const numTokens = min(kTileTokens, tokenEnd - tileBegin);
+        __syncthreads();
+        for (int32_t idx = threadIdx.x; idx < numTokens * headSize; idx += blockDim.x)
+        {
+            auto const token = tileBegin + idx / headSize;
+            auto const channel = idx % headSize;
+            auto const localIdx = params.kvCache.getKVLocalIdx(token, kvHeadIdx, headSize, channel);
+            sK[idx] = reinterpret_cast<T const*>(params.kvCache.getKBlockPtr(kvSeqIdx, token))[localIdx];
+            sV[idx] = reinterpret_cast<T const*>(params.kvCache.getVBlockPtr(kvSeqIdx, token))[localIdx];
+        }
+        __syncthreads();
+
+#pragma unroll
+        for (int j = 0; j < kQueriesPerWarp; ++j)
+        {
+            if (seqIdx[j] < 0)
+            {
+                continue;
+            }
+            // Lane t holds the score of token t of the tile.
+            float score = negInf;
+            for (int32_t t = 0; t < numTokens; ++t)
+            {
+                float partial = 0.f;
+#pragma unroll
+                for (int i = 0; i < kDimsPerLane; ++i)
+                {
+                    partial += q[j][i] * cuda_cast<float>(sK[t * headSize + lane + 32 * i]);
+                }
+                partial = warpReduceSum(partial);
+                score = lane == t ? partial : score;
+            }
+            float const newMax = fmaxf(rowMax[j], warpReduceMax(score));
+            float const p = lane < numTokens ? __expf(score - newMax) : 0.f;
+            float const correction = __expf(rowMax[j] - newMax);
+            rowSum[j] = rowSum[j] * correction + warpReduceSum(p);
+            rowMax[j] = newMax;
+#pragma unroll
+            for (int i = 0; i < kDimsPerLane; ++i)
+            {
+                acc[j][i] *= correction;
+            }
+            for (int32_t t = 0; t < numTokens; ++t)
+            {
+                float const pt = __shfl_sync(0xffffffff, p, t);
+#pragma unroll
+                for (int i = 0; i < kDimsPerLane; ++i)
+                {
+                    acc[j][i] += pt * cuda_cast<float>(sV[t * headSize + lane + 32 * i]);
+                }
+            }
+        }
+    }
+
+#pragma unroll
+    for (int j = 0; j < kQueriesPerWarp; ++j)
+    {
+        if (seqIdx[j] < 0)
+        {
+            continue;
+        }
+        auto const row = (static_cast<size_t>(stateIdx) * params.batchSize + seqIdx[j]) * params.numHeads + headIdx[j];
+#pragma unroll
+        for (int i = 0; i < kDimsPerLane; ++i)
+        {
+            states.acc[row * headSize + lane + 32 * i] = acc[j][i];
+        }
+        if (lane == 0)
+        {
+            states.max[row] = rowMax[j];
+            states.sum[row] = rowSum[j];
+        }
+    }
+}
+
+//! \brief Split range s of numSplits over [begin, end), rounded to whole tiles.
+__device__ inline void getSplitRange(int32_t& begin, int32_t& end, int32_t split, int32_t numSplits)
+{
+    auto const numTiles = (end - begin + kTileTokens - 1) / kTileTokens;
+    auto const tilesPerSplit = (numTiles + numSplits - 1) / numSplits;
+    auto const splitBegin = begin + split * tilesPerSplit * kTileTokens;
+    end = min(end, splitBegin + tilesPerSplit * kTileTokens);
+    begin = splitBegin;
+}
+
+// grid (numGroups * tilesPerGroup, numKvHeads, numSplits). Queries of a group are (sequence, query head of the KV
+// head) pairs, numbered sequence-major.
+template <typename T, int kDimsPerLane>
+__global__ void cascadePrefixAttentionKernel(CascadeAttentionParams<T> const params, int32_t tilesPerGroup)
+{
+    PrefixGroupsView const groups{params.prefixGroups, params.numGroups, params.numGroupedSeqs};
+    PartialStates const states{params.workspace, params.batchSize, params.numHeads, params.headSize, params.numSplits};
+    auto const groupIdx = static_cast<int32_t>(blockIdx.x) / tilesPerGroup;
+    auto const tileIdx = static_cast<int32_t>(blockIdx.x) % tilesPerGroup;
+    auto const kvHeadIdx = static_cast<int32_t>(blockIdx.y);
+    auto const split = static_cast<int32_t>(blockIdx.z);
+    auto const headsPerKv = params.numHeads / params.numKvHeads;
+
+    auto const groupBegin = groups.groupOffsets[groupIdx];
+    auto const groupSize = groups.groupOffsets[groupIdx + 1] - groupBegin;
+    auto const numQueries = groupSize * headsPerKv;
+    if (tileIdx * kQueriesPerCta >= numQueries)
+    {
+        return;
+    }
+
+    auto const warpIdx = static_cast<int32_t>(threadIdx.x / 32);
+    int32_t seqIdx[kQueriesPerWarp];
+    int32_t headIdx[kQueriesPerWarp];
+#pragma unroll
+    for (int j = 0; j < kQueriesPerWarp; ++j)
+    {
+        auto const query = tileIdx * kQueriesPerCta + warpIdx * kQueriesPerWarp + j;
+        seqIdx[j] = query < numQueries ? groups.seqIdx[groupBegin + query / headsPerKv] : -1;
+        headIdx[j] = kvHeadIdx * headsPerKv + query % headsPerKv;
+    }
+
+    int32_t begin = 0;
+    int32_t end = groups.prefixLengths[groupIdx];
+    getSplitRange(begin, end, split, params.numSplits);
+    // All members of the group reach the prefix through the same blocks, read them through the first one.
+    attendKvRange<T, kDimsPerLane>(params, states, params.numSplits + split, groups.seqIdx[groupBegin], kvHeadIdx,
+        begin, end, seqIdx, headIdx);
+}
+
+// grid (batchSize * tilesPerSeq, numKvHeads, numSplits).
+template <typename T, int kDimsPerLane>
+__global__ void cascadeSuffixAttentionKernel(CascadeAttentionParams<T> const params, int32_t tilesPerSeq)
+{
+    PrefixGroupsView const groups{params.prefixGroups, params.numGroups, params.numGroupedSeqs};
+    PartialStates const states{params.workspace, params.batchSize, params.numHeads, params.headSize, params.numSplits};
+    auto const batchIdx = static_cast<int32_t>(blockIdx.x) / tilesPerSeq;
+    auto const tileIdx = static_cast<int32_t>(blockIdx.x) % tilesPerSeq;
+    auto const kvHeadIdx = static_cast<int32_t>(blockIdx.y);
+    auto const split = static_cast<int32_t>(blockIdx.z);
+    auto const headsPerKv = params.numHeads / params.numKvHeads;
+
+    auto const warpIdx = static_cast<int32_t>(threadIdx.x / 32);
+    int32_t seqIdx[kQueriesPerWarp];
+    int32_t headIdx[kQueriesPerWarp];
+#pragma unroll
+    for (int j = 0; j < kQueriesPerWarp; ++j)
+    {
+        auto const query = tileIdx * kQueriesPerCta + warpIdx * kQueriesPerWarp + j;
+        seqIdx[j] = query < headsPerKv ? batchIdx : -1;
+        headIdx[j] = kvHeadIdx * headsPerKv + query;
+    }
+
+    int32_t begin = groups.seqPrefixLengths[batchIdx];
+    int32_t end = params.sequenceLengths[batchIdx];
+    getSplitRange(begin, end, split, params.numSplits);
+    attendKvRange<T, kDimsPerLane>(params, states, split, batchIdx, kvHeadIdx, begin, end, seqIdx, headIdx);
+}
+
+// grid (batchSize, numHeads), block headSize threads.
+template <typename T>
+__global__ void cascadeMergeStatesKernel(CascadeAttentionParams<T> const params)
+{
+    PrefixGroupsView const groups{params.prefixGroups, params.numGroups, params.numGroupedSeqs};
+    PartialStates const states{params.workspace, params.batchSize, params.numHeads, params.headSize, params.numSplits};
+    auto const batchIdx = static_cast<int32_t>(blockIdx.x);
+    auto const headIdx = static_cast<int32_t>(blockIdx.y);
+    auto const dim = static_cast<int32_t>(threadIdx.x);
+    // Prefix states are only written for grouped sequences.
+    auto const numStates = groups.seqPrefixLengths[batchIdx] > 0 ? 2 * params.numSplits : params.numSplits;
+    auto const getRow = [&](int32_t stateIdx)
+    { return (static_cast<size_t>(stateIdx) * params.batchSize + batchIdx) * params.numHeads + headIdx; };
+
+    float globalMax = -INFINITY;
+    for (int32_t s = 0; s < numStates; ++s)
+    {
+        globalMax = fmaxf(globalMax, states.max[getRow(s)]);
+    }
+    float sum = 0.f;
+    float out = 0.f;
+    for (int32_t s = 0; s < numStates; ++s)
+    {
+        auto const row = getRow(s);
+        // Empty splits hold max = -inf and contribute nothing.
+        float const scale = states.sum[row] > 0.f ? __expf(states.max[row] - globalMax) : 0.f;
+        sum += states.sum[row] * scale;
+        out += states.acc[row * params.headSize + dim] * scale;
+    }
+    params.out[(static_cast<size_t>(batchIdx) * params.numHeads + headIdx) * params.headSize + dim]
+        = cuda_cast<T>(out / sum);
+}
+
+template <typename T, int kDimsPerLane>
+void launchCascadeAttention(CascadeAttentionParams<T> const& params, cudaStream_t stream)
+{
+    auto const smemSize = 2 * kTileTokens * params.headSize * sizeof(T);
+    auto const headsPerKv = params.numHeads / params.numKvHeads;
+    dim3 const block(kNumWarps * 32);
+
+    if (params.numGroups > 0)
+    {
+        auto const tilesPerGroup = static_cast<int32_t>(divUp(params.maxGroupSize * headsPerKv, kQueriesPerCta));
+        dim3 const grid(params.numGroups * tilesPerGroup, params.numKvHeads, params.numSplits);
+        cascadePrefixAttentionKernel<T, kDimsPerLane><<<grid, block, smemSize, stream>>>(params, tilesPerGroup);
+    }
+    auto const tilesPerSeq = static_cast<int32_t>(divUp(headsPerKv, kQueriesPerCta));
+    dim3 const suffixGrid(params.batchSize * tilesPerSeq, params.numKvHeads, params.numSplits);
+    cascadeSuffixAttentionKernel<T, kDimsPerLane><<<suffixGrid, block, smemSize, stream>>>(params, tilesPerSeq);
+
+    dim3 const mergeGrid(params.batchSize, params.numHeads);
+    cascadeMergeStatesKernel<T><<<mergeGrid, params.headSize, 0, stream>>>(params);
+}
+
+} // namespace
+
+std::vector<int32_t> CascadePrefixGroups::pack() const
+{
+    std::vector<int32_t> packed;
+    packed.reserve(groupOffsets.size() + seqIdx.size() + prefixLengths.size() + seqPrefixLengths.size());
+    for (auto const* array : {&groupOffsets, &seqIdx, &prefixLengths, &seqPrefixLengths})
+    {
+        packed.insert(packed.end(), array->begin(), array->end());
+    }
+    return packed;
+}
+
+CascadePrefixGroups buildCascadePrefixGroups(KVCacheIndex const* hostBlockOffsets, int32_t const* hostSequenceLengths,
+    int32_t batchSize, int32_t maxBlocksPerSeq, int32_t tokensPerBlock, int32_t maxAttentionWindow,
+    int32_t minPrefixBlocks)
+{
+    TLLM_CHECK(minPrefixBlocks > 0);
+    auto const getKBlocks = [&](int32_t seq) { return hostBlockOffsets + seq * maxBlocksPerSeq * 2; };
+    auto const getBlockId = [](KVCacheIndex const& index)
+    { return static_cast<int64_t>(index.get()) | (index.isPrimary() ? 0 : (int64_t{1} << 32)); };
+    // Full blocks before the current token, only they can be shared.
+    auto const getNumFullBlocks = [&](int32_t seq)
+    {
+        auto const seqLength = hostSequenceLengths[seq];
+        return seqLength > maxAttentionWindow ? 0 : std::min((seqLength - 1) / tokensPerBlock, maxBlocksPerSeq);
+    };
+
+    // Bucket sequences by their first block, in batch order.
+    std::unordered_map<int64_t, std::vector<int32_t>> buckets;
+    std::vector<int64_t> bucketOrder;
+    for (int32_t seq = 0; seq < batchSize; ++seq)
+    {
+        if (getNumFullBlocks(seq) < minPrefixBlocks)
+        {
+            continue;
+        }
+        auto const firstBlock = getBlockId(getKBlocks(seq)[0]);
+        auto& bucket = buckets[firstBlock];
+        if (bucket.empty())
+        {
+            bucketOrder.push_back(firstBlock);
+        }
+        bucket.push_back(seq);
+    }
+
+    CascadePrefixGroups groups;
+    groups.seqPrefixLengths.assign(batchSize, 0);
+    groups.groupOffsets.push_back(0);
+    for (auto const firstBlock : bucketOrder)
+    {
+        auto const& bucket = buckets[firstBlock];
+        if (bucket.size() < 2)
+        {
+            continue;
+        }
+        auto const leader = bucket.front();
+        auto const* leaderBlocks = getKBlocks(leader);
+        int32_t prefixBlocks = getNumFullBlocks(leader);
+        std::vector<int32_t> members{leader};
+        for (auto it = bucket.begin() + 1; it != bucket.end(); ++it)
+        {
+            auto const* blocks = getKBlocks(*it);
+            auto const maxCommon = std::min(prefixBlocks, getNumFullBlocks(*it));
+            int32_t common = 0;
+            while (common < maxCommon && getBlockId(blocks[common]) == getBlockId(leaderBlocks[common]))
+            {
+                ++common;
+            }
+            if (common >= minPrefixBlocks)
+            {
+                members.push_back(*it);
+                prefixBlocks = common;
+            }
+        }
+        if (members.size() < 2)
+        {
+            continue;
+        }
+        auto const prefixLength = prefixBlocks * tokensPerBlock;
+        for (auto const seq : members)
+        {
+            groups.seqIdx.push_back(seq);
+            groups.seqPrefixLengths[seq] = prefixLength;
+        }
+        groups.groupOffsets.push_back(static_cast<int32_t>(groups.seqIdx.size()));
+        groups.prefixLengths.push_back(prefixLength);
+        groups.maxGroupSize = std::max(groups.maxGroupSize, static_cast<int32_t>(members.size()));
+    }
+    return groups;
+}
+
+size_t getCascadeAttentionWorkspaceSize(int32_t batchSize, int32_t numHeads, int32_t headSize, int32_t numSplits)
+{
+    auto const numRows = static_cast<size_t>(2 * numSplits) * batchSize * numHeads;
+    return sizeof(float) * numRows * (headSize + 2);
+}
+
+template <typename T>
+void invokeCascadeAttention(CascadeAttentionParams<T> const& params, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(params.headSize % 32 == 0 && params.headSize <= kMaxHeadSize,
+        "Cascade attention supports head sizes that are multiples of 32 up to %d, got %d", kMaxHeadSize,
+        params.headSize);
+    TLLM_CHECK(params.numHeads % params.numKvHeads == 0);
+    TLLM_CHECK(params.numSplits > 0);
+    TLLM_CHECK_WITH_INFO(params.kvCache.mSinkTokens == 0, "Cascade attention does not support sink tokens");
+
+    switch (params.headSize / 32)
+    {
+    case 1: launchCascadeAttention<T, 1>(params, stream); break;
+    case 2: launchCascadeAttention<T, 2>(params, stream); break;
+    case 3: launchCascadeAttention<T, 3>(params, stream); break;
+    case 4: launchCascadeAttention<T, 4>(params, stream); break;
+    case 5: launchCascadeAttention<T, 5>(params, stream); break;
+    case 6: launchCascadeAttention<T, 6>(params, stream); break;
+    case 7: launchCascadeAttention<T, 7>(params, stream); break;
+    case 8: launchCascadeAttention<T, 8>(params, stream); break;
+    }
+    sync_check_cuda_error();
+}
+
+template void invokeCascadeAttention<float>(CascadeAttentionParams<float> const& params, cudaStream_t stream);
+template void invokeCascadeAttention<half>(CascadeAttentionParams<half> const& params, cudaStream_t stream);
+#ifdef ENABLE_BF16
+template void invokeCascadeAttention<__nv_bfloat16>(
+    CascadeAttentionParams<__nv_bfloat16> const& params, cudaStream_t stream);
+#endif
+
+} // namespace kernels
+} // namespace tensorrt_llm
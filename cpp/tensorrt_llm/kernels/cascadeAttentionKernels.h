@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/kernels/kvCacheUtils.h"
+
+#include <cstdint>
+#include <cuda_runtime.h>
+#include <vector>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+//! \brief Groups of generation sequences whose KV caches start with the same blocks, e.g. a reused system prompt.
+//! \details All sequences of a group reach their first prefixLengths[g] tokens through the same blocks, so cascade
+//! attention reads these blocks once per group instead of once per sequence.
+struct CascadePrefixGroups
+{
+    //! Sequences of group g are seqIdx[groupOffsets[g]] .. seqIdx[groupOffsets[g + 1] - 1], [numGroups + 1]
+    std::vector<int32_t> groupOffsets;
+    //! [numGroupedSeqs]
+    std::vector<int32_t> seqIdx;
+    //! Length of the shared prefix of each group in tokens, a multiple of tokensPerBlock, [numGroups]
+    std::vector<int32_t> prefixLengths;
+    //! Shared prefix length of each sequence, 0 for sequences outside any group, [batchSize]
+    std::vector<int32_t> seqPrefixLengths;
+    int32_t maxGroupSize{0};
+
+    [[nodiscard]] int32_t getNumGroups() const
+    {
+        return static_cast<int32_t>(prefixLengths.size());
+    }
+
+    //! \brief All arrays in one buffer, so the caller copies them to the device with a single copy.
+    //! \details The layout is [groupOffsets, seqIdx, prefixLengths, seqPrefixLengths].
+    [[nodiscard]] std::vector<int32_t> pack() const;
+};
+
+//! \brief Detect groups of sequences sharing their leading KV cache blocks.
+//! \details Only full blocks before the current token are shared. A group takes the longest prefix common to all of
+//! its members, members that share fewer than minPrefixBlocks blocks with the first sequence of the group are left
+//! out of it. Sequences whose KV cache wraps around the attention window are never grouped.
+//! \param hostBlockOffsets Host copy of KVBlockArray::data, [batchSize, 2, maxBlocksPerSeq]
+//! \param hostSequenceLengths Tokens in the KV cache of each sequence including the current one, [batchSize]
+CascadePrefixGroups buildCascadePrefixGroups(KVCacheIndex const* hostBlockOffsets, int32_t const* hostSequenceLengths,
+    int32_t batchSize, int32_t maxBlocksPerSeq, int32_t tokensPerBlock, int32_t maxAttentionWindow,
+    int32_t minPrefixBlocks);
+
+template <typename T>
+struct CascadeAttentionParams
+{
+    //! Queries of the current token with position embedding applied, [batchSize, numHeads, headSize]
+    T const* q{nullptr};
+    //! [batchSize, numHeads, headSize]
+    T* out{nullptr};
+    //! Paged KV cache which already holds K and V of the current token
+    KVBlockArray kvCache{};
+    //! Tokens in the KV cache of each sequence including the current one, [batchSize]
+    int32_t const* sequenceLengths{nullptr};
+    //! Device copy of CascadePrefixGroups::pack()
+    int32_t const* prefixGroups{nullptr};
+    //! Partial softmax states, getCascadeAttentionWorkspaceSize bytes
+    void* workspace{nullptr};
+
+    int32_t batchSize{0};
+    int32_t numHeads{0};
+    int32_t numKvHeads{0};
+    int32_t headSize{0};
+    int32_t numGroups{0};
+    int32_t numGroupedSeqs{0};
+    int32_t maxGroupSize{0};
+    //! Number of CTAs the KV range of every prefix and every suffix is split across
+    int32_t numSplits{1};
+    //! Scale applied to Q.K, usually 1 / (sqrt(headSize) * qScaling)
+    float qkScale{1.f};
+
+    void setPrefixGroups(CascadePrefixGroups const& groups, int32_t const* devicePackedGroups)
+    {
+        prefixGroups = devicePackedGroups;
+        numGroups = groups.getNumGroups();
+        numGroupedSeqs = static_cast<int32_t>(groups.seqIdx.size());
+        maxGroupSize = groups.maxGroupSize;
+    }
+};
+
+[[nodiscard]] size_t getCascadeAttentionWorkspaceSize(
+    int32_t batchSize, int32_t numHeads, int32_t headSize, int32_t numSplits);
+
+//! \brief Generation-phase attention that reads shared prefix blocks once per group of sequences.
+//! \details The attention of each query is split into the part over its group's shared prefix and the part over the
+//! rest of its sequence. Prefix CTAs attend all queries of a group, i.e. all of its sequences and all query heads of
+//! a KV head, to each tile of prefix K/V loaded once into shared memory. Suffix CTAs handle the remaining tokens of
+//! every sequence, which is its whole KV cache for sequences outside any group. Both write partial softmax states
+//! that a final pass merges into out. Supports a non-quantized paged KV cache without sink tokens, head sizes that
+//! are multiples of 32 up to 256, and beam width 1.
+template <typename T>
+void invokeCascadeAttention(CascadeAttentionParams<T> const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -614,13 +614,67 @@ void FusedMHARunnerV2::setSeparateQKvTmaDescriptors(MHARunnerParams runnerParams
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void FusedMHARunnerV2::runGenericPagedKvFmha(MHARunnerParams const& runnerParams)
+{
+    PagedKvFmhaParams params;
+    params.qPtr = runnerParams.qPtr;
+    params.outputPtr = runnerParams.outputPtr;
+    params.pagedKvCache = runnerParams.pagedKvCache;
+    params.cuQSeqLens = reinterpret_cast<int const*>(runnerParams.cuQSeqLenPtr);
+    params.cuKvSeqLens = reinterpret_cast<int const*>(runnerParams.cuKvSeqLenPtr);
+    params.kvScaleQuantOrig = runnerParams.kvScaleQuantOrigPtr;
+    params.dataType = mFixedParams.dataType;
+    params.kvCacheDataType = mFixedParams.kvCacheDataType;
+    params.attentionMaskType = mFixedParams.attentionMaskType;
+    params.isSPadded = mFixedParams.isSPadded;
+    params.b = runnerParams.b;
+    params.maxQSeqLen = runnerParams.qSeqLen;
+    params.numQHeads = mFixedParams.numQHeads;
+    params.numKvHeads = mFixedParams.numKvHeads;
+    params.headSize = mFixedParams.headSize;
+    params.slidingWindowSize = runnerParams.slidingWindowSize;
+
+    // Same order of scales and bias as the pre-compiled kernels.
+    float const inv_sqrt_scale = (1.f / (sqrtf(mFixedParams.headSize) * mFixedParams.qScaling));
+    bool const scaleAfterAlibi = mFixedParams.hasAlibi && mFixedParams.scaleAlibi;
+    params.scaleBmm1 = scaleAfterAlibi ? 1.0f : inv_sqrt_scale;
+    params.qkTanhScale = mFixedParams.qkTanhScale;
+    if (mFixedParams.qkTanhScale != 0.f)
+    {
+        params.scaleBmm1 /= mFixedParams.qkTanhScale;
+    }
+    params.hasAlibi = mFixedParams.hasAlibi;
+    if (mFixedParams.hasAlibi)
+    {
+        params.alibiParams = AlibiParams(mFixedParams.numQHeads, runnerParams.kvSeqLen, mFixedParams.tpSize,
+            mFixedParams.tpRank, scaleAfterAlibi ? inv_sqrt_scale : 1.0f);
+    }
+
+    invokePagedKvFmha(params, runnerParams.stream);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void FusedMHARunnerV2::run(MHARunnerParams runnerParams)
 {
+    if (mUseGenericPagedKvFmha)
+    {
+        runGenericPagedKvFmha(runnerParams);
+        return;
+    }
+
     // Note that we must set the launch params first.
     // Set the launch params.
     setupLaunchParams(runnerParams);
     // Set the kernel params.
     setupKernelParams(runnerParams);
+    // Some runtime variants (e.g. sliding window causal) might not have pre-compiled paged kv kernels.
+    if (mFixedParams.attentionInputLayout == AttentionInputLayout::Q_PAGED_KV
+        && !xmmaKernel->checkIfKernelExist(mKernelParams, mLaunchParams) && isPagedKvFmhaSupported(mFixedParams))
+    {
+        runGenericPagedKvFmha(runnerParams);
+        return;
+    }
     // Need to set tma descriptors additionally.
     if (mSM == kSM_90 && mLaunchParams.use_tma)
     {
@@ -687,6 +741,18 @@ bool FusedMHARunnerV2::isFmhaSupported()
 {
     bool foundKernels = xmmaKernel->checkIfKernelExist(mFixedParams);
 
+    // The pre-compiled paged kv kernels read the kv cache in the fmha data type.
+    bool const isKvCacheQuantized = mFixedParams.attentionInputLayout == AttentionInputLayout::Q_PAGED_KV
+        && mFixedParams.kvCacheDataType != mFixedParams.dataType;
+    if ((!foundKernels || isKvCacheQuantized) && isPagedKvFmhaSupported(mFixedParams))
+    {
+        TLLM_LOG_DEBUG("Use the generic paged kv fmha kernels for %s in sm_%d.",
+            mFixedParams.convertToStrOutput().c_str(), mSM);
+        mUseGenericPagedKvFmha = true;
+        return true;
+    }
+    foundKernels = foundKernels && !isKvCacheQuantized;
+
     if (!foundKernels)
     {
         TLLM_LOG_WARNING("Fall back to unfused MHA for %s in sm_%d.", mFixedParams.convertToStrOutput().c_str(), mSM);
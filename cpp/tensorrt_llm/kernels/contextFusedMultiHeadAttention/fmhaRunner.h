@@ -29,6 +29,7 @@
 
 #include "fused_multihead_attention_common.h"
 #include "fused_multihead_attention_v2.h"
+#include "pagedKvFmha.h"
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tmaDescriptor.h"
 
@@ -58,6 +59,12 @@ public:
     // Run the fmha kernel.
     void run(MHARunnerParams runnerParams);
 
+    // Do we run the generic paged kv kernels instead of the pre-compiled ones ?
+    bool isGenericPagedKvFmha() const
+    {
+        return mUseGenericPagedKvFmha;
+    }
+
 private:
     // Set the kernel params.
     void setupKernelParams(MHARunnerParams runnerParams);
@@ -71,6 +78,9 @@ private:
     // Set the tma descriptors for separate q and kv input.
     void setSeparateQKvTmaDescriptors(MHARunnerParams runnerParams);
 
+    // Run the generic paged kv kernels.
+    void runGenericPagedKvFmha(MHARunnerParams const& runnerParams);
+
     // Check if it is a valid sequence length (only used by non-flash-attention kernels).
     bool isValidS(int s) const;
 
@@ -96,6 +106,8 @@ private:
     size_t mTotalDeviceMemory;
     // The class that stores all the kernels.
     FusedMultiHeadAttentionXMMAKernelV2 const* xmmaKernel;
+    // Use the generic paged kv kernels (no pre-compiled kernel supports the Q_PAGED_KV attention).
+    bool mUseGenericPagedKvFmha = false;
 };
 
 } // namespace kernels
@@ -117,6 +117,8 @@ struct MHARunnerFixedParams
     int tpSize = 1;
     // The tensor parallel rank (alibi).
     int tpRank = 0;
+    // The kv cache data type (only used by Q_PAGED_KV).
+    Data_type kvCacheDataType = DATA_TYPE_FP16;
 
     // Convert to string for debug.
     std::string convertToStrOutput()
@@ -204,6 +206,8 @@ struct MHARunnerParams
     float const* scaleBmm1Ptr;
     // The bmm2 scale device ptr (only used by fp8 kernels).
     float const* scaleBmm2Ptr;
+    // The kv cache dequantization scale device ptr (only used with int8/fp8 paged kv caches).
+    float const* kvScaleQuantOrigPtr = nullptr;
     // The cuda stream.
     cudaStream_t stream;
     bool forceFp32Acc = false;
@@ -367,6 +367,12 @@ public:
         return findIter != mFunctions.end();
     }
 
+    // Check if the kernel selected by the runtime parameters exists.
+    bool checkIfKernelExist(Fused_multihead_attention_params_v2 const& params, Launch_params const& launch_params) const
+    {
+        return mFunctions.find(hashFromParams(params, launch_params)) != mFunctions.end();
+    }
+
     void getStepSize(uint32_t& out_step_q, uint32_t& out_step_kv, Fused_multihead_attention_params_v2 const& params,
         Launch_params const& launch_params) const override
     {
@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/kernels/contextFusedMultiHeadAttention/pagedKvFmha.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/reduceKernelUtils.cuh"
+#include "tensorrt_llm/kernels/int4KvCacheUtils.h"
+
+#include <type_traits>
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+constexpr int kNumWarps = 8;
+constexpr int kQueriesPerWarp = 4;
+constexpr int kQueriesPerCta = kNumWarps * kQueriesPerWarp;
+constexpr int kTileTokens = 32;
+constexpr int kMaxHeadSize = 256;
+
+// Kv cache element type tag of the INT4 kv cache, whose rows carry their own group scales.
+struct Int4KvCache
+{
+};
+
+__device__ inline float getAlibiSlope(AlibiParams const& alibi, int headIdx)
+{
+    auto const h = headIdx + alibi.head_idx_offset;
+    return h < alibi.h_pow_2 ? exp2f((h + 1) * 2 * alibi.alibi_neg4_div_h)
+                             : exp2f((2 * (h - alibi.h_pow_2) + 1) * alibi.alibi_neg4_div_h);
+}
+
+// grid (divUp(maxQSeqLen * numQHeads / numKvHeads, kQueriesPerCta), numKvHeads, b). The queries of a CTA are
+// (q token, q head of the kv head) pairs, numbered token-major. Each CTA loads tiles of K and V (dequantized to
+// float) into shared memory and every warp attends its queries to them with an online softmax. Lane l of a warp owns
+// dims l, l + 32, ... of the head, and holds the score of token l of the tile.
+template <typename T, typename TKv, int kDimsPerLane>
+__global__ void pagedKvFmhaKernel(PagedKvFmhaParams const params)
+{
+    extern __shared__ char smem[];
+    float* sK = reinterpret_cast<float*>(smem);
+    float* sV = sK + kTileTokens * params.headSize;
+
+    auto const batchIdx = static_cast<int32_t>(blockIdx.z);
+    auto const kvHeadIdx = static_cast<int32_t>(blockIdx.y);
+    auto const headsPerKv = params.numQHeads / params.numKvHeads;
+    auto const qSeqBegin = params.cuQSeqLens[batchIdx];
+    auto const qSeqLen = params.cuQSeqLens[batchIdx + 1] - qSeqBegin;
+    auto const kvSeqLen = params.cuKvSeqLens[batchIdx + 1] - params.cuKvSeqLens[batchIdx];
+    // The q tokens are the last tokens of the sequence.
+    auto const pastKvLen = kvSeqLen - qSeqLen;
+    auto const numQueries = qSeqLen * headsPerKv;
+    auto const ctaQueryBegin = static_cast<int32_t>(blockIdx.x) * kQueriesPerCta;
+    if (ctaQueryBegin >= numQueries)
+    {
+        return;
+    }
+    auto const ctaQueryEnd = min(ctaQueryBegin + kQueriesPerCta, numQueries);
+
+    bool const isCausal = params.attentionMaskType != ContextAttentionMaskType::PADDING;
+    auto const window = params.slidingWindowSize;
+    int32_t tokenBegin = 0;
+    int32_t tokenEnd = kvSeqLen;
+    if (isCausal)
+    {
+        auto const firstPos = pastKvLen + ctaQueryBegin / headsPerKv;
+        auto const lastPos = pastKvLen + (ctaQueryEnd - 1) / headsPerKv;
+        tokenBegin = max(0, firstPos - window + 1);
+        tokenEnd = lastPos + 1;
+    }
+
+    auto const headSize = params.headSize;
+    auto const lane = static_cast<int32_t>(threadIdx.x % 32);
+    auto const warpQueryBegin = ctaQueryBegin + static_cast<int32_t>(threadIdx.x / 32) * kQueriesPerWarp;
+    auto const qRowBegin = params.isSPadded ? batchIdx * params.maxQSeqLen : qSeqBegin;
+    float const negInf = -INFINITY;
+    constexpr bool kInt4Kv = std::is_same_v<TKv, Int4KvCache>;
+    float const kvScale = (!std::is_same_v<T, TKv> && !kInt4Kv && params.kvScaleQuantOrig != nullptr)
+        ? params.kvScaleQuantOrig[0]
+        : 1.f;
+    float const scaleAfterAlibi = params.hasAlibi ? params.alibiParams.scale_after_alibi : 1.f;
+    T const* qPtr = reinterpret_cast<T const*>(params.qPtr);
+
+    bool active[kQueriesPerWarp];
+    int32_t pos[kQueriesPerWarp];
+    size_t qOffset[kQueriesPerWarp];
+    float alibiSlope[kQueriesPerWarp];
+    float q[kQueriesPerWarp][kDimsPerLane];
+    float acc[kQueriesPerWarp][kDimsPerLane];
+    float rowMax[kQueriesPerWarp];
+    float rowSum[kQueriesPerWarp];
+#pragma unroll
+    for (int j = 0; j < kQueriesPerWarp; ++j)
+    {
+        auto const query = warpQueryBegin + j;
+        auto const tokenIdx = query / headsPerKv;
+        auto const headIdx = kvHeadIdx * headsPerKv + query % headsPerKv;
+        active[j] = query < ctaQueryEnd;
+        pos[j] = pastKvLen + tokenIdx;
+        qOffset[j] = (static_cast<size_t>(qRowBegin + tokenIdx) * params.numQHeads + headIdx) * headSize;
+        alibiSlope[j] = params.hasAlibi ? getAlibiSlope(params.alibiParams, headIdx) : 0.f;
+        rowMax[j] = negInf;
+        rowSum[j] = 0.f;
+#pragma unroll
+        for (int i = 0; i < kDimsPerLane; ++i)
+        {
+            acc[j][i] = 0.f;
+            q[j][i] = active[j] ? cuda_cast<float>(qPtr[qOffset[j] + lane + 32 * i]) : 0.f;
+        }
+    }
+
+    for (int32_t tileBegin = tokenBegin; tileBegin < tokenEnd; tileBegin += kTileTokens)
+    {
+        auto const numTokens = min(kTileTokens, tokenEnd - tileBegin);
+        __syncthreads();
+        for (int32_t idx = threadIdx.x; idx < numTokens * headSize; idx += blockDim.x)
+        {
+            auto const token = params.pagedKvCache.getKVTokenIdx(tileBegin + idx / headSize);
+            if constexpr (kInt4Kv)
+            {
+                auto const rowIdx
+                    = params.pagedKvCache.getKVLocalIdx(token, kvHeadIdx, getInt4KvCacheRowBytes(headSize), 0);
+                auto const* kRow = reinterpret_cast<uint8_t const*>(params.pagedKvCache.getKBlockPtr(batchIdx, token));
+                auto const* vRow = reinterpret_cast<uint8_t const*>(params.pagedKvCache.getVBlockPtr(batchIdx, token));
+                sK[idx] = dequantizeInt4KvCacheRow(kRow + rowIdx, headSize, idx % headSize);
+                sV[idx] = dequantizeInt4KvCacheRow(vRow + rowIdx, headSize, idx % headSize);
+            }
+            else
+            {
+                auto const localIdx = params.pagedKvCache.getKVLocalIdx(token, kvHeadIdx, headSize, idx % headSize);
+                auto const k
+                    = reinterpret_cast<TKv const*>(params.pagedKvCache.getKBlockPtr(batchIdx, token))[localIdx];
+                auto const v
+                    = reinterpret_cast<TKv const*>(params.pagedKvCache.getVBlockPtr(batchIdx, token))[localIdx];
+                sK[idx] = cuda_cast<float>(k) * kvScale;
+                sV[idx] = cuda_cast<float>(v) * kvScale;
+            }
+        }
+        __syncthreads();
+
+#pragma unroll
+        for (int j = 0; j < kQueriesPerWarp; ++j)
+        {
+            if (!active[j])
+            {
+                continue;
+            }
+            auto const token = tileBegin + lane;
+            bool const valid = lane < numTokens && (!isCausal || (token <= pos[j] && token > pos[j] - window));
+            float score = negInf;
+            for (int32_t t = 0; t < numTokens; ++t)
+            {
+                float partial = 0.f;
+#pragma unroll
+                for (int i = 0; i < kDimsPerLane; ++i)
+                {
+                    partial += q[j][i] * sK[t * headSize + lane + 32 * i];
+                }
+                partial = warpReduceSum(partial);
+                score = lane == t ? partial : score;
+            }
+            score *= params.scaleBmm1;
+            if (params.qkTanhScale != 0.f)
+            {
+                score = params.qkTanhScale * tanhf(score);
+            }
+            score = (score + alibiSlope[j] * (token - pos[j])) * scaleAfterAlibi;
+            score = valid ? score : negInf;
+
+            float const newMax = fmaxf(rowMax[j], warpReduceMax(score));
+            if (newMax == negInf)
+            {
+                // All the tokens of the tile are masked.
+                continue;
+            }
+            float const p = valid ? __expf(score - newMax) : 0.f;
+            float const correction = __expf(rowMax[j] - newMax);
+            rowSum[j] = rowSum[j] * correction + warpReduceSum(p);
+            rowMax[j] = newMax;
+#pragma unroll
+            for (int i = 0; i < kDimsPerLane; ++i)
+            {
+                acc[j][i] *= correction;
+            }
+            for (int32_t t = 0; t < numTokens; ++t)
+            {
+                float const pt = __shfl_sync(0xffffffff, p, t);
+#pragma unroll
+                for (int i = 0; i < kDimsPerLane; ++i)
+                {
+                    acc[j][i] += pt * sV[t * headSize + lane + 32 * i];
+                }
+            }
+        }
+    }
+
+    T* outputPtr = reinterpret_cast<T*>(params.outputPtr);
+#pragma unroll
+    for (int j = 0; j < kQueriesPerWarp; ++j)
+    {
+        if (!active[j])
+        {
+            continue;
+        }
+        float const invSum = rowSum[j] > 0.f ? 1.f / rowSum[j] : 0.f;
+#pragma unroll
+        for (int i = 0; i < kDimsPerLane; ++i)
+        {
+            outputPtr[qOffset[j] + lane + 32 * i] = cuda_cast<T>(acc[j][i] * invSum);
+        }
+    }
+}
+
+template <typename T, typename TKv, int kDimsPerLane>
+void launchPagedKvFmhaKernel(PagedKvFmhaParams const& params, cudaStream_t stream)
+{
+    auto const smemSize = static_cast<int>(2 * kTileTokens * params.headSize * sizeof(float));
+    auto const kernel = pagedKvFmhaKernel<T, TKv, kDimsPerLane>;
+    if (smemSize >= 48 * 1024)
+    {
+        TLLM_CUDA_CHECK(cudaFuncSetAttribute(kernel, cudaFuncAttributeMaxDynamicSharedMemorySize, smemSize));
+    }
+    auto const headsPerKv = params.numQHeads / params.numKvHeads;
+    dim3 const grid(static_cast<uint32_t>(divUp(params.maxQSeqLen * headsPerKv, kQueriesPerCta)), params.numKvHeads,
+        params.b);
+    kernel<<<grid, kNumWarps * 32, smemSize, stream>>>(params);
+}
+
+template <typename T, typename TKv>
+void dispatchPagedKvFmhaHeadSize(PagedKvFmhaParams const& params, cudaStream_t stream)
+{
+    switch (params.headSize / 32)
+    {
+    case 1: launchPagedKvFmhaKernel<T, TKv, 1>(params, stream); break;
+    case 2: launchPagedKvFmhaKernel<T, TKv, 2>(params, stream); break;
+    case 3: launchPagedKvFmhaKernel<T, TKv, 3>(params, stream); break;
+    case 4: launchPagedKvFmhaKernel<T, TKv, 4>(params, stream); break;
+    case 5: launchPagedKvFmhaKernel<T, TKv, 5>(params, stream); break;
+    case 6: launchPagedKvFmhaKernel<T, TKv, 6>(params, stream); break;
+    case 7: launchPagedKvFmhaKernel<T, TKv, 7>(params, stream); break;
+    case 8: launchPagedKvFmhaKernel<T, TKv, 8>(params, stream); break;
+    }
+}
+
+template <typename T>
+void dispatchPagedKvFmhaKvType(PagedKvFmhaParams const& params, cudaStream_t stream)
+{
+    if (params.kvCacheDataType == params.dataType)
+    {
+        dispatchPagedKvFmhaHeadSize<T, T>(params, stream);
+    }
+    else if (params.kvCacheDataType == DATA_TYPE_INT8)
+    {
+        dispatchPagedKvFmhaHeadSize<T, int8_t>(params, stream);
+    }
+    else if (params.kvCacheDataType == DATA_TYPE_INT4)
+    {
+        dispatchPagedKvFmhaHeadSize<T, Int4KvCache>(params, stream);
+    }
+#ifdef ENABLE_FP8
+    else if (params.kvCacheDataType == DATA_TYPE_E4M3)
+    {
+        dispatchPagedKvFmhaHeadSize<T, __nv_fp8_e4m3>(params, stream);
+    }
+#endif
+    else
+    {
+        TLLM_THROW("Unsupported kv cache data type of the paged kv fmha kernels.");
+    }
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool isPagedKvFmhaSupported(MHARunnerFixedParams const& params)
+{
+    bool const supportedDataType = params.dataType == DATA_TYPE_FP16 || params.dataType == DATA_TYPE_BF16;
+    bool supportedKvCacheDataType = params.kvCacheDataType == params.dataType
+        || params.kvCacheDataType == DATA_TYPE_INT8 || params.kvCacheDataType == DATA_TYPE_INT4;
+#ifdef ENABLE_FP8
+    supportedKvCacheDataType |= params.kvCacheDataType == DATA_TYPE_E4M3;
+#endif
+    return params.attentionInputLayout == AttentionInputLayout::Q_PAGED_KV && supportedDataType
+        && supportedKvCacheDataType && params.attentionMaskType != ContextAttentionMaskType::CUSTOM_MASK
+        && params.headSize % 32 == 0 && params.headSize <= kMaxHeadSize
+        && params.numQHeads % params.numKvHeads == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void invokePagedKvFmha(PagedKvFmhaParams const& params, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(params.headSize % 32 == 0 && params.headSize <= kMaxHeadSize,
+        "Paged kv fmha supports head sizes that are multiples of 32 up to %d, got %d", kMaxHeadSize, params.headSize);
+    TLLM_CHECK(params.numQHeads % params.numKvHeads == 0);
+    TLLM_CHECK_WITH_INFO(params.attentionMaskType != ContextAttentionMaskType::CUSTOM_MASK,
+        "Paged kv fmha does not support custom masks");
+
+    switch (params.dataType)
+    {
+    case DATA_TYPE_FP32: dispatchPagedKvFmhaKvType<float>(params, stream); break;
+    case DATA_TYPE_FP16: dispatchPagedKvFmhaKvType<half>(params, stream); break;
+#ifdef ENABLE_BF16
+    case DATA_TYPE_BF16: dispatchPagedKvFmhaKvType<__nv_bfloat16>(params, stream); break;
+#endif
+    default: TLLM_THROW("Unsupported data type of the paged kv fmha kernels.");
+    }
+    sync_check_cuda_error();
+}
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/kernels/contextFusedMultiHeadAttention/fused_multihead_attention_common.h"
+#include "tensorrt_llm/kernels/kvCacheUtils.h"
+
+#include <climits>
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The generic paged kv context attention kernels read K and V from the paged kv cache directly, so the tokens of a
+// context chunk (or of a request that reuses cached prefix blocks) attend to all earlier tokens of their sequence.
+// They cover the configurations the pre-compiled Q_PAGED_KV kernels don't, e.g. int8/fp8 kv caches, sliding windows,
+// alibi or head sizes without a cubin, instead of falling back to unfused MHA.
+struct PagedKvFmhaParams
+{
+    // The Q buffer with shape [numQTokens, numQHeads, headSize] ([b, maxQSeqLen, numQHeads, headSize] if isSPadded).
+    void const* qPtr = nullptr;
+    // The output buffer with the same shape as the Q buffer.
+    void* outputPtr = nullptr;
+    // The paged kv cache array (K and V of the q tokens must have been written already).
+    KVBlockArray pagedKvCache;
+    // The cumulative Q sequence lengths with shape [b + 1].
+    int const* cuQSeqLens = nullptr;
+    // The cumulative KV sequence lengths with shape [b + 1] (including the q tokens).
+    int const* cuKvSeqLens = nullptr;
+    // The dequantization scale of int8/fp8 kv caches (device ptr with 1 element).
+    float const* kvScaleQuantOrig = nullptr;
+    // The Q/output data type (fp16, bf16 or fp32).
+    Data_type dataType = DATA_TYPE_FP16;
+    // The kv cache data type (same as dataType, int8, e4m3 or int4 with per-group scales).
+    Data_type kvCacheDataType = DATA_TYPE_FP16;
+    // The attention mask type (padding, causal or sliding_window_causal).
+    ContextAttentionMaskType attentionMaskType = ContextAttentionMaskType::CAUSAL;
+    // Are the sequences in the Q buffer padded ?
+    bool isSPadded = false;
+    // The batch size.
+    int b = 0;
+    // The max q sequence length.
+    int maxQSeqLen = 0;
+    // The number of Q heads.
+    int numQHeads = 0;
+    // The number of Kv heads.
+    int numKvHeads = 0;
+    // The head size.
+    int headSize = 0;
+    // Causal masks only pay attention to (q_i - slidingWindowSize, q_i].
+    int slidingWindowSize = INT_MAX;
+    // The scores are computed as qkTanhScale * tanh(q * k * scaleBmm1), or q * k * scaleBmm1 if qkTanhScale == 0.
+    float scaleBmm1 = 1.f;
+    float qkTanhScale = 0.f;
+    // Do we apply alibi ? The scores then become (scores + alibi) * alibiParams.scale_after_alibi.
+    bool hasAlibi = false;
+    // The alibi params (the slopes are computed from the global head index).
+    AlibiParams alibiParams;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Check if the generic paged kv kernels support the attention.
+bool isPagedKvFmhaSupported(MHARunnerFixedParams const& params);
+
+void invokePagedKvFmha(PagedKvFmhaParams const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -18,6 +18,7 @@
 
 #include "cumsumLastDim.h"
 
+#include <algorithm>
 #include <cub/cub.cuh>
 
 namespace tensorrt_llm
@@ -27,13 +28,69 @@ namespace kernels
 
 ///////////////
 
+// Half and bfloat16 rows are summed in float, the rounding error of a 16-bit running sum grows with the length.
+template <typename T>
+struct CumsumAccType
+{
+    using Type = T;
+};
+
+template <>
+struct CumsumAccType<half>
+{
+    using Type = float;
+};
+
+#ifdef ENABLE_BF16
+template <>
+struct CumsumAccType<__nv_bfloat16>
+{
+    using Type = float;
+};
+#endif
+
+// Long rows are scanned by many blocks with a decoupled look-back. Each block takes the next tile in row-major order
+// from a counter, so the tiles before it have all started, scans it and publishes its aggregate. It then walks back
+// over the tiles of the row until it finds one that published its inclusive prefix.
+static constexpr int LOOK_BACK_THREADS_PER_BLOCK = 256;
+static constexpr int LOOK_BACK_ITEMS_PER_THREAD = 16;
+static constexpr int LOOK_BACK_TILE_SIZE = LOOK_BACK_THREADS_PER_BLOCK * LOOK_BACK_ITEMS_PER_THREAD;
+// The rows scanned by one launch, the workspace holds the tile states of that many rows.
+static constexpr SizeType32 LOOK_BACK_MAX_ROWS = 16;
+
+// A tile state packs the status in the upper 32 bits and the bits of the value in the lower 32 bits.
+static constexpr uint32_t TILE_STATUS_INVALID = 0;
+static constexpr uint32_t TILE_STATUS_AGGREGATE = 1;
+static constexpr uint32_t TILE_STATUS_PREFIX = 2;
+
+template <typename AccT>
+__device__ __forceinline__ unsigned long long packTileState(uint32_t status, AccT value)
+{
+    static_assert(sizeof(AccT) == sizeof(uint32_t));
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (static_cast<unsigned long long>(status) << 32) | bits;
+}
+
+template <typename AccT>
+__device__ __forceinline__ AccT unpackTileValue(unsigned long long state)
+{
+    auto const bits = static_cast<uint32_t>(state & 0xffffffffULL);
+    AccT value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static SizeType32 getLookBackNumTiles(SizeType32 inputLength)
+{
+    return (inputLength + LOOK_BACK_TILE_SIZE - 1) / LOOK_BACK_TILE_SIZE;
+}
+
 template <typename T>
 size_t invokeComputeCumsumLastDimWorkspaceSize(SizeType32 inputLength)
 {
-    T* iodata = nullptr;
-    size_t tempStorageBytes;
-    cub::DeviceScan::InclusiveSum(nullptr, tempStorageBytes, iodata, iodata, inputLength);
-    return tempStorageBytes;
+    // The tile counter, then the tile states
+    return sizeof(unsigned long long) * (1 + LOOK_BACK_MAX_ROWS * getLookBackNumTiles(inputLength));
 }
 
 #define INSTANTIATE_COMPUTE_CUMSUM_LastDim_WORKSPACE_SIZE_DATA_TYPE(T)                                                 \
@@ -47,14 +104,21 @@ INSTANTIATE_COMPUTE_CUMSUM_LastDim_WORKSPACE_SIZE_DATA_TYPE(__nv_bfloat16);
 #endif
 #undef INSTANTIATE_COMPUTE_CUMSUM_LastDim_WORKSPACE_SIZE_DATA_TYPE
 
+static bool useCumsumLastDimLookBack(SizeType32 batchSize, SizeType32 inputLength)
+{
+    // One block per row leaves most of the GPU idle when there are fewer rows than SMs, and those rows take long.
+    return inputLength >= LOOK_BACK_TILE_SIZE && batchSize < tensorrt_llm::common::getMultiProcessorCount();
+}
+
 ///////////////
 
 template <typename T, int THREADS_PER_BLOCK, int ITEMS_PER_THREAD, cub::BlockScanAlgorithm ALGORITHM>
 __global__ void cumsum_last_dim(T const* d_in, T* d_out, int length)
 {
+    using AccT = typename CumsumAccType<T>::Type;
     typedef cub::BlockLoad<T, THREADS_PER_BLOCK, ITEMS_PER_THREAD, cub::BLOCK_LOAD_WARP_TRANSPOSE> BlockLoadT;
     typedef cub::BlockStore<T, THREADS_PER_BLOCK, ITEMS_PER_THREAD, cub::BLOCK_STORE_WARP_TRANSPOSE> BlockStoreT;
-    typedef cub::BlockScan<T, THREADS_PER_BLOCK, ALGORITHM> BlockScanT;
+    typedef cub::BlockScan<AccT, THREADS_PER_BLOCK, ALGORITHM> BlockScanT;
 
     int const row_idx = blockIdx.x;
     T const* local_d_in = d_in + row_idx * length;
@@ -69,7 +133,7 @@ __global__ void cumsum_last_dim(T const* d_in, T* d_out, int length)
     } temp_storage;
 
     int tile_size = THREADS_PER_BLOCK * ITEMS_PER_THREAD;
-    T aggregate = static_cast<T>(0);
+    AccT aggregate = static_cast<AccT>(0);
     T const* cur_d_in = local_d_in;
     T* cur_d_out = local_d_out;
     for (int tile_start = 0; tile_start < length;
@@ -77,35 +141,141 @@ __global__ void cumsum_last_dim(T const* d_in, T* d_out, int length)
     {
         int cur_tile_size = (tile_start + tile_size) <= length ? tile_size : (length - tile_start);
         T data[ITEMS_PER_THREAD]; // Per-thread tile data
+        AccT acc[ITEMS_PER_THREAD];
 
         // Load items into a blocked arrangement
         BlockLoadT(temp_storage.load).Load(cur_d_in, data, cur_tile_size, static_cast<T>(0));
+#pragma unroll
+        for (int i = 0; i < ITEMS_PER_THREAD; ++i)
+        {
+            acc[i] = static_cast<AccT>(data[i]);
+        }
         if (threadIdx.x == 0)
         {
-            data[0] += aggregate;
+            acc[0] += aggregate;
         }
         __syncthreads();
 
-        BlockScanT(temp_storage.scan).InclusiveSum(data, data, aggregate);
+        BlockScanT(temp_storage.scan).InclusiveSum(acc, acc, aggregate);
         __syncthreads();
 
+#pragma unroll
+        for (int i = 0; i < ITEMS_PER_THREAD; ++i)
+        {
+            data[i] = static_cast<T>(acc[i]);
+        }
         // Store items from a blocked arrangement
         BlockStoreT(temp_storage.store).Store(cur_d_out, data, cur_tile_size);
         __syncthreads();
     }
 }
 
+template <typename T>
+__global__ void cumsum_last_dim_look_back(
+    T const* d_in, T* d_out, int length, int num_tiles, unsigned int* tile_counter, unsigned long long* tile_states)
+{
+    using AccT = typename CumsumAccType<T>::Type;
+    typedef cub::BlockLoad<T, LOOK_BACK_THREADS_PER_BLOCK, LOOK_BACK_ITEMS_PER_THREAD, cub::BLOCK_LOAD_WARP_TRANSPOSE>
+        BlockLoadT;
+    typedef cub::BlockStore<T, LOOK_BACK_THREADS_PER_BLOCK, LOOK_BACK_ITEMS_PER_THREAD,
+        cub::BLOCK_STORE_WARP_TRANSPOSE>
+        BlockStoreT;
+    typedef cub::BlockScan<AccT, LOOK_BACK_THREADS_PER_BLOCK, cub::BLOCK_SCAN_WARP_SCANS> BlockScanT;
+
+    __shared__ union TempStorage
+    {
+        typename BlockLoadT::TempStorage load;
+        typename BlockStoreT::TempStorage store;
+        typename BlockScanT::TempStorage scan;
+    } temp_storage;
+    __shared__ unsigned int s_tile_idx;
+    __shared__ AccT s_exclusive_prefix;
+
+    if (threadIdx.x == 0)
+    {
+        s_tile_idx = atomicAdd(tile_counter, 1);
+    }
+    __syncthreads();
+    int const row_idx = s_tile_idx / num_tiles;
+    int const tile_idx = s_tile_idx % num_tiles;
+    int const tile_start = tile_idx * LOOK_BACK_TILE_SIZE;
+    int const cur_tile_size = min(LOOK_BACK_TILE_SIZE, length - tile_start);
+    T const* cur_d_in = d_in + static_cast<size_t>(row_idx) * length + tile_start;
+    T* cur_d_out = d_out + static_cast<size_t>(row_idx) * length + tile_start;
+    unsigned long long* row_states = tile_states + row_idx * num_tiles;
+
+    T data[LOOK_BACK_ITEMS_PER_THREAD];
+    AccT acc[LOOK_BACK_ITEMS_PER_THREAD];
+    BlockLoadT(temp_storage.load).Load(cur_d_in, data, cur_tile_size, static_cast<T>(0));
+#pragma unroll
+    for (int i = 0; i < LOOK_BACK_ITEMS_PER_THREAD; ++i)
+    {
+        acc[i] = static_cast<AccT>(data[i]);
+    }
+    __syncthreads();
+
+    AccT aggregate;
+    BlockScanT(temp_storage.scan).InclusiveSum(acc, acc, aggregate);
+
+    if (threadIdx.x == 0)
+    {
+        AccT exclusive_prefix = static_cast<AccT>(0);
+        if (tile_idx == 0)
+        {
+            atomicExch(&row_states[0], packTileState(TILE_STATUS_PREFIX, aggregate));
+        }
+        else
+        {
+            // Publish the aggregate first, so that the tiles after this one need not wait for the look-back
+            atomicExch(&row_states[tile_idx], packTileState(TILE_STATUS_AGGREGATE, aggregate));
+            for (int prev = tile_idx - 1; prev >= 0; --prev)
+            {
+                unsigned long long state;
+                do
+                {
+                    state = atomicAdd(&row_states[prev], 0ULL);
+                } while (static_cast<uint32_t>(state >> 32) == TILE_STATUS_INVALID);
+                exclusive_prefix += unpackTileValue<AccT>(state);
+                if (static_cast<uint32_t>(state >> 32) == TILE_STATUS_PREFIX)
+                {
+                    break;
+                }
+            }
+            atomicExch(&row_states[tile_idx], packTileState(TILE_STATUS_PREFIX, exclusive_prefix + aggregate));
+        }
+        s_exclusive_prefix = exclusive_prefix;
+    }
+    __syncthreads();
+
+    AccT const exclusive_prefix = s_exclusive_prefix;
+#pragma unroll
+    for (int i = 0; i < LOOK_BACK_ITEMS_PER_THREAD; ++i)
+    {
+        data[i] = static_cast<T>(acc[i] + exclusive_prefix);
+    }
+    BlockStoreT(temp_storage.store).Store(cur_d_out, data, cur_tile_size);
+}
+
 ///////////////
 
 template <typename T>
-void invokeDeviceScan(SizeType32 batchSize, SizeType32 inputLength, void const* __restrict__ input,
-    void* __restrict__ output, void* d_temp_storage, size_t tempStorageBytes, cudaStream_t stream)
+void invokeLookBackScan(SizeType32 batchSize, SizeType32 inputLength, void const* __restrict__ input,
+    void* __restrict__ output, void* workspace, size_t tempStorageBytes, cudaStream_t stream)
 {
-    for (SizeType32 i = 0; i < batchSize; i++)
+    TLLM_CHECK_WITH_INFO(tempStorageBytes >= invokeComputeCumsumLastDimWorkspaceSize<T>(inputLength),
+        "Workspace too small for the look-back scan");
+    auto const numTiles = getLookBackNumTiles(inputLength);
+    auto* tileCounter = reinterpret_cast<unsigned int*>(workspace);
+    auto* tileStates = reinterpret_cast<unsigned long long*>(workspace) + 1;
+    for (SizeType32 rowStart = 0; rowStart < batchSize; rowStart += LOOK_BACK_MAX_ROWS)
     {
-        T const* inputPtr = reinterpret_cast<T const*>(input) + i * inputLength;
-        T* outputPtr = reinterpret_cast<T*>(output) + i * inputLength;
-        cub::DeviceScan::InclusiveSum(d_temp_storage, tempStorageBytes, inputPtr, outputPtr, inputLength, stream);
+        auto const numRows = std::min(LOOK_BACK_MAX_ROWS, batchSize - rowStart);
+        T const* inputPtr = reinterpret_cast<T const*>(input) + static_cast<size_t>(rowStart) * inputLength;
+        T* outputPtr = reinterpret_cast<T*>(output) + static_cast<size_t>(rowStart) * inputLength;
+        TLLM_CUDA_CHECK(cudaMemsetAsync(
+            workspace, 0, sizeof(unsigned long long) * (1 + static_cast<size_t>(numRows) * numTiles), stream));
+        cumsum_last_dim_look_back<T><<<numRows * numTiles, LOOK_BACK_THREADS_PER_BLOCK, 0, stream>>>(
+            inputPtr, outputPtr, inputLength, numTiles, tileCounter, tileStates);
     }
 }
 
@@ -116,9 +286,9 @@ void invokeCumsumLastDim(SizeType32 batchSize, SizeType32 inputLength, void cons
     void* __restrict__ output, void* deviceTempStorage, size_t tempStorageBytes, cudaStream_t stream)
 {
 
-    if (deviceTempStorage != nullptr) // we need to use DeviceScan
+    if (deviceTempStorage != nullptr && useCumsumLastDimLookBack(batchSize, inputLength))
     {
-        invokeDeviceScan<T>(batchSize, inputLength, input, output, deviceTempStorage, tempStorageBytes, stream);
+        invokeLookBackScan<T>(batchSize, inputLength, input, output, deviceTempStorage, tempStorageBytes, stream);
         return;
     }
 
@@ -19,6 +19,7 @@
 #include "tensorrt_llm/common/cudaTypeUtils.cuh"
 #include "tensorrt_llm/common/dataType.h"
 #include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/quantTypeUtils.cuh"
 #include <tuple>
 #include <type_traits>
 
@@ -242,7 +243,89 @@ inline __device__ int4 rms_norm(float denom, PackedStruct& vec, PackedStruct& we
     return ret.packed;
 }
 
-template <typename T, bool Bias = false, bool Residual = false, bool Affine = false, bool UseSmem = false>
+inline __device__ float warp_reduce_max(float val)
+{
+    val = fmaxf(val, __shfl_xor_sync(~0, val, 16));
+    val = fmaxf(val, __shfl_xor_sync(~0, val, 8));
+    val = fmaxf(val, __shfl_xor_sync(~0, val, 4));
+    val = fmaxf(val, __shfl_xor_sync(~0, val, 2));
+    val = fmaxf(val, __shfl_xor_sync(~0, val, 1));
+    return val;
+}
+
+inline __device__ float block_reduce_max(float val)
+{
+    __shared__ float smem[details::kWarpSize];
+    int lane_id = threadIdx.x % details::kWarpSize, warp_id = threadIdx.x / details::kWarpSize,
+        warp_num = blockDim.x / details::kWarpSize;
+    val = warp_reduce_max(val);
+    if (lane_id == 0)
+    {
+        smem[warp_id] = val;
+    }
+    __syncthreads();
+    val = lane_id < warp_num ? smem[lane_id] : 0.f;
+    val = warp_reduce_max(val);
+    return val;
+}
+
+template <typename T, typename PackedStruct>
+inline __device__ float accumulate_abs_max(float amax, PackedStruct& vec)
+{
+    static constexpr int kLoopNum = sizeof(PackedStruct) / sizeof(T);
+#pragma unroll
+    for (int i = 0; i < kLoopNum; ++i)
+    {
+        amax = fmaxf(amax, fabsf(static_cast<float>(reinterpret_cast<T*>(vec.unpacked)[i])));
+    }
+    return amax;
+}
+
+// Quantizes the normed row token_idx of the block with a per token scale and writes the quantized values to the
+// output buffer and the dequantization scale to scale_out_buffer. With UseSmem the normed row is read back from smem,
+// otherwise every thread owns at most one packed vector, the one in vec.
+template <typename T, typename QuantT, bool UseSmem, typename PackedStruct>
+inline __device__ void quantize_per_token(
+    AllReduceParams const& params, int token_idx, float amax, PackedStruct& vec, T const* smem)
+{
+    static constexpr int kPackedSize = details::kBytesPerAccess / sizeof(T);
+    using QuantVals = common::QuantTypeStaticVals<QuantT>;
+
+    struct alignas(kPackedSize * sizeof(QuantT)) QuantPacked
+    {
+        QuantT unpacked[kPackedSize];
+    };
+
+    int const hidden_size = params.fusion_params.hidden_size;
+    QuantT* quant_out = reinterpret_cast<QuantT*>(params.local_output_buffer_ptr) + token_idx * hidden_size;
+
+    amax = fmaxf(block_reduce_max(amax), 1e-6f);
+    float const quant_scale = fminf(QuantVals::MAX_VAL / amax, QuantVals::MIN_SCALING_FACTOR_RCP);
+    for (int offset = threadIdx.x * kPackedSize; offset < hidden_size; offset += blockDim.x * kPackedSize)
+    {
+        if constexpr (UseSmem)
+        {
+            vec.packed = *reinterpret_cast<int4 const*>(&smem[offset]);
+        }
+        QuantPacked quant_vec;
+#pragma unroll
+        for (int i = 0; i < kPackedSize; ++i)
+        {
+            float const v = static_cast<float>(reinterpret_cast<T*>(vec.unpacked)[i]);
+            quant_vec.unpacked[i] = common::cuda_cast<QuantT>(v * quant_scale);
+        }
+        *reinterpret_cast<QuantPacked*>(&quant_out[offset]) = quant_vec;
+    }
+    if (threadIdx.x == 0)
+    {
+        params.fusion_params.scale_out_buffer[token_idx]
+            = fmaxf(amax / QuantVals::MAX_VAL, QuantVals::MIN_SCALING_FACTOR);
+    }
+}
+
+// QuantT is void when the normed output is written as is.
+template <typename T, bool Bias = false, bool Residual = false, bool Affine = false, bool UseSmem = false,
+    typename QuantT = void>
 __global__ void rms_norm_kernel(AllReduceParams params)
 {
     static constexpr int kPackedSize = details::kBytesPerAccess / sizeof(T);
@@ -299,6 +382,7 @@ __global__ void rms_norm_kernel(AllReduceParams params)
     }
     acc = block_reduce_sum(acc);
     float denom = __fsqrt_rn(__fdividef(acc, params.fusion_params.hidden_size) + params.fusion_params.eps);
+    float amax = 0.f;
     for (int offset = thread_offset; offset < params.fusion_params.hidden_size; offset += blockDim.x * kPackedSize)
     {
         if constexpr (UseSmem)
@@ -310,14 +394,29 @@ __global__ void rms_norm_kernel(AllReduceParams params)
             weight_vec.packed = *reinterpret_cast<int4 const*>(weight_buffer + offset);
         }
         inter_vec.packed = rms_norm<T, Affine>(denom, inter_vec, weight_vec);
-        *reinterpret_cast<int4*>(&local_final_output_buffer[offset]) = inter_vec.packed;
+        if constexpr (std::is_void_v<QuantT>)
+        {
+            *reinterpret_cast<int4*>(&local_final_output_buffer[offset]) = inter_vec.packed;
+        }
+        else
+        {
+            amax = accumulate_abs_max<T>(amax, inter_vec);
+            if constexpr (UseSmem)
+            {
+                *reinterpret_cast<int4*>(&smem[offset]) = inter_vec.packed;
+            }
+        }
+    }
+    if constexpr (!std::is_void_v<QuantT>)
+    {
+        quantize_per_token<T, QuantT, UseSmem>(params, bid, amax, inter_vec, smem);
     }
 #if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
     cudaTriggerProgrammaticLaunchCompletion();
 #endif
 }
 
-template <typename T, bool Bias = false, bool Residual = false, bool Affine = false>
+template <typename T, bool Bias = false, bool Residual = false, bool Affine = false, typename QuantT = void>
 void rms_norm_kernel_launcher(AllReduceParams params, cudaStream_t stream)
 {
     static constexpr int kPackedSize = details::kBytesPerAccess / sizeof(T);
@@ -353,11 +452,11 @@ void rms_norm_kernel_launcher(AllReduceParams params, cudaStream_t stream)
             kernelConfig.numAttrs = 1;
 
             TLLM_CUDA_CHECK(
-                cudaLaunchKernelEx(&kernelConfig, rms_norm_kernel<T, Bias, Residual, Affine, true>, params));
+                cudaLaunchKernelEx(&kernelConfig, rms_norm_kernel<T, Bias, Residual, Affine, true, QuantT>, params));
         }
         else
         {
-            rms_norm_kernel<T, Bias, Residual, Affine, true><<<cta_num, cta_size, smem_size, stream>>>(params);
+            rms_norm_kernel<T, Bias, Residual, Affine, true, QuantT><<<cta_num, cta_size, smem_size, stream>>>(params);
         }
     }
     else
@@ -378,16 +477,17 @@ void rms_norm_kernel_launcher(AllReduceParams params, cudaStream_t stream)
             kernelConfig.numAttrs = 1;
 
             TLLM_CUDA_CHECK(
-                cudaLaunchKernelEx(&kernelConfig, rms_norm_kernel<T, Bias, Residual, Affine, false>, params));
+                cudaLaunchKernelEx(&kernelConfig, rms_norm_kernel<T, Bias, Residual, Affine, false, QuantT>, params));
         }
         else
         {
-            rms_norm_kernel<T, Bias, Residual, Affine, false><<<cta_num, cta_size, smem_size, stream>>>(params);
+            rms_norm_kernel<T, Bias, Residual, Affine, false, QuantT><<<cta_num, cta_size, smem_size, stream>>>(params);
         }
     }
 }
 
-template <typename T, int RanksPerNode, bool Bias = false, bool Affine = false, bool UseSmem = false>
+template <typename T, int RanksPerNode, bool Bias = false, bool Affine = false, bool UseSmem = false,
+    typename QuantT = void>
 static __global__ void __launch_bounds__(1024, 1) one_shot_all_reduce_norm_kernel(AllReduceParams params)
 {
     static constexpr int kPackedSize = details::kBytesPerAccess / sizeof(T);
@@ -476,6 +576,7 @@ static __global__ void __launch_bounds__(1024, 1) one_shot_all_reduce_norm_kerne
         }
         acc = block_reduce_sum(acc);
         float denom = __fsqrt_rn(__fdividef(acc, params.fusion_params.hidden_size) + params.fusion_params.eps);
+        float amax = 0.f;
         for (int offset = thread_offset; offset < params.fusion_params.hidden_size; offset += blockDim.x * kPackedSize)
         {
             if constexpr (UseSmem)
@@ -487,7 +588,22 @@ static __global__ void __launch_bounds__(1024, 1) one_shot_all_reduce_norm_kerne
                 weight_vec.packed = *reinterpret_cast<int4 const*>(weight_buffer + offset);
             }
             sum_vec.packed = rms_norm<T, Affine>(denom, sum_vec, weight_vec);
-            *reinterpret_cast<int4*>(&local_final_output_buffer[norm_offset + offset]) = sum_vec.packed;
+            if constexpr (std::is_void_v<QuantT>)
+            {
+                *reinterpret_cast<int4*>(&local_final_output_buffer[norm_offset + offset]) = sum_vec.packed;
+            }
+            else
+            {
+                amax = accumulate_abs_max<T>(amax, sum_vec);
+                if constexpr (UseSmem)
+                {
+                    *reinterpret_cast<int4*>(&smem[offset]) = sum_vec.packed;
+                }
+            }
+        }
+        if constexpr (!std::is_void_v<QuantT>)
+        {
+            quantize_per_token<T, QuantT, UseSmem>(params, bid * norm_per_block + norm_idx, amax, sum_vec, smem);
         }
     }
 #if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
@@ -495,7 +611,7 @@ static __global__ void __launch_bounds__(1024, 1) one_shot_all_reduce_norm_kerne
 #endif
 }
 
-template <typename T, int RanksPerNode, bool Bias, bool Affine>
+template <typename T, int RanksPerNode, bool Bias, bool Affine, typename QuantT = void>
 void one_shot_all_reduce_norm_kernel_launcher(AllReduceParams params, cudaStream_t stream)
 {
     static constexpr int kPackedSize = details::kBytesPerAccess / sizeof(T);
@@ -534,11 +650,11 @@ void one_shot_all_reduce_norm_kernel_launcher(AllReduceParams params, cudaStream
             kernelConfig.numAttrs = 1;
 
             TLLM_CUDA_CHECK(cudaLaunchKernelEx(
-                &kernelConfig, one_shot_all_reduce_norm_kernel<T, RanksPerNode, Bias, Affine, true>, params));
+                &kernelConfig, one_shot_all_reduce_norm_kernel<T, RanksPerNode, Bias, Affine, true, QuantT>, params));
         }
         else
         {
-            one_shot_all_reduce_norm_kernel<T, RanksPerNode, Bias, Affine, true>
+            one_shot_all_reduce_norm_kernel<T, RanksPerNode, Bias, Affine, true, QuantT>
                 <<<cta_num, cta_size, smem_size, stream>>>(params);
         }
     }
@@ -560,11 +676,11 @@ void one_shot_all_reduce_norm_kernel_launcher(AllReduceParams params, cudaStream
 
             TLLM_LOG_DEBUG("Enable PDL in one_shot_all_reduce_norm_kernel");
             TLLM_CUDA_CHECK(cudaLaunchKernelEx(
-                &kernelConfig, one_shot_all_reduce_norm_kernel<T, RanksPerNode, Bias, Affine, false>, params));
+                &kernelConfig, one_shot_all_reduce_norm_kernel<T, RanksPerNode, Bias, Affine, false, QuantT>, params));
         }
         else
         {
-            one_shot_all_reduce_norm_kernel<T, RanksPerNode, Bias, Affine, false>
+            one_shot_all_reduce_norm_kernel<T, RanksPerNode, Bias, Affine, false, QuantT>
                 <<<cta_num, cta_size, smem_size, stream>>>(params);
         }
     }
@@ -896,11 +1012,461 @@ static __global__ void __launch_bounds__(512, 1) twoShotAllReduceKernel(AllReduc
 #endif
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef ENABLE_FP8
+// Layout of the shareable buffer of the compressed one-shot kernel: the FP8 values of the message, then, 16 bytes
+// aligned, the float dequantization scale of every chunk. A chunk is the 32 packed vectors of one warp.
+template <typename T>
+struct CompressedPayload
+{
+    static constexpr int kPackedElts = 16 / sizeof(T);
+    static constexpr size_t kChunkElts = WARP_SIZE * kPackedElts;
+
+    static __host__ __device__ size_t numChunks(size_t elts)
+    {
+        return (elts + kChunkElts - 1) / kChunkElts;
+    }
+
+    static __host__ __device__ size_t scalesOffset(size_t elts)
+    {
+        return (elts + 15) / 16 * 16;
+    }
+};
+
+template <typename T, int RANKS_PER_NODE, bool Bias = false, bool Residual = false>
+static __global__ void __launch_bounds__(512, 1) compressedOneShotAllReduceKernel(AllReduceParams params)
+{
+    // Like the one-shot kernel with a copied input, but the shareable buffers hold FP8:
+    // 1. Every warp quantizes its chunks of local_input with one scale per chunk into the local shareable buffer
+    // 2. B0 on every GPU wait for each other (block_barrier), the chunks of a block are the same on every GPU
+    // 3. Every warp dequantizes its chunks of all GPUs, sums them in FP32 from rank 0 on for a stable order, adds the
+    //    bias and residual of the fusions and writes the result to local_output
+    using Payload = CompressedPayload<T>;
+    static constexpr int PACKED_ELTS = Payload::kPackedElts;
+    using PackedType = typename PackedOn16Bytes<T>::Type;
+    using QuantVals = common::QuantTypeStaticVals<__nv_fp8_e4m3>;
+
+    struct alignas(PACKED_ELTS) Fp8Packed
+    {
+        __nv_fp8_e4m3 unpacked[PACKED_ELTS];
+    };
+
+    int const bidx = blockIdx.x;
+    int const tidx = threadIdx.x;
+    int const grid_size = gridDim.x;
+    int const lane = tidx % WARP_SIZE;
+    size_t const warp = (static_cast<size_t>(bidx) * blockDim.x + tidx) / WARP_SIZE;
+    size_t const num_warps = static_cast<size_t>(grid_size) * blockDim.x / WARP_SIZE;
+    size_t const num_chunks = Payload::numChunks(params.elts_total);
+    size_t const scales_offset = Payload::scalesOffset(params.elts_total);
+
+    T const* local_input_buffer = reinterpret_cast<T const*>(params.local_input_buffer_ptr);
+    T* local_output_buffer = reinterpret_cast<T*>(params.local_output_buffer_ptr);
+    uint8_t* local_shared_buffer = reinterpret_cast<uint8_t*>(params.peer_comm_buffer_ptrs[params.local_rank]);
+
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    cudaGridDependencySynchronize();
+#endif
+
+    for (size_t chunk = warp; chunk < num_chunks; chunk += num_warps)
+    {
+        size_t const offset = chunk * Payload::kChunkElts + lane * PACKED_ELTS;
+        bool const valid = offset < params.elts_total;
+        PackedType vals;
+        vals.packed = {0, 0, 0, 0};
+        if (valid)
+        {
+            vals.packed = *reinterpret_cast<int4 const*>(&local_input_buffer[offset]);
+        }
+        // All lanes take part in the reduction, the ones past the message with zeros.
+        float const amax
+            = fmaxf(reduce_fusion::warp_reduce_max(reduce_fusion::accumulate_abs_max<T>(0.f, vals)), 1e-6f);
+        float const quant_scale = fminf(QuantVals::MAX_VAL / amax, QuantVals::MIN_SCALING_FACTOR_RCP);
+        if (valid)
+        {
+            Fp8Packed quant_vals;
+#pragma unroll
+            for (int i = 0; i < PACKED_ELTS; ++i)
+            {
+                quant_vals.unpacked[i]
+                    = __nv_fp8_e4m3(static_cast<float>(reinterpret_cast<T*>(vals.unpacked)[i]) * quant_scale);
+            }
+            *reinterpret_cast<Fp8Packed*>(&local_shared_buffer[offset]) = quant_vals;
+        }
+        if (lane == 0)
+        {
+            reinterpret_cast<float*>(local_shared_buffer + scales_offset)[chunk]
+                = fmaxf(amax / QuantVals::MAX_VAL, QuantVals::MIN_SCALING_FACTOR);
+        }
+    }
+    block_barrier(
+        params.peer_barrier_ptrs_in, params.barrier_flag, params.local_rank, RANKS_PER_NODE, tidx, bidx, grid_size);
+
+    for (size_t chunk = warp; chunk < num_chunks; chunk += num_warps)
+    {
+        size_t const offset = chunk * Payload::kChunkElts + lane * PACKED_ELTS;
+        if (offset >= params.elts_total)
+        {
+            continue;
+        }
+        float acc[PACKED_ELTS] = {};
+#pragma unroll
+        for (int rank = 0; rank < RANKS_PER_NODE; ++rank)
+        {
+            auto const* peer_buffer = reinterpret_cast<uint8_t const*>(params.peer_comm_buffer_ptrs[rank]);
+            float const scale = reinterpret_cast<float const*>(peer_buffer + scales_offset)[chunk];
+            Fp8Packed const quant_vals = *reinterpret_cast<Fp8Packed const*>(&peer_buffer[offset]);
+#pragma unroll
+            for (int i = 0; i < PACKED_ELTS; ++i)
+            {
+                acc[i] += static_cast<float>(quant_vals.unpacked[i]) * scale;
+            }
+        }
+        if constexpr (Bias)
+        {
+            PackedType bias_vec;
+            T const* bias_buffer = reinterpret_cast<T const*>(params.fusion_params.bias_buffer);
+            bias_vec.packed = *reinterpret_cast<int4 const*>(bias_buffer + offset % params.fusion_params.hidden_size);
+#pragma unroll
+            for (int i = 0; i < PACKED_ELTS; ++i)
+            {
+                acc[i] += static_cast<float>(reinterpret_cast<T*>(bias_vec.unpacked)[i]);
+            }
+        }
+        if constexpr (Residual)
+        {
+            PackedType residual_vec;
+            residual_vec.packed = *reinterpret_cast<int4 const*>(
+                reinterpret_cast<T const*>(params.fusion_params.residual_buffer) + offset);
+#pragma unroll
+            for (int i = 0; i < PACKED_ELTS; ++i)
+            {
+                acc[i] += static_cast<float>(reinterpret_cast<T*>(residual_vec.unpacked)[i]);
+            }
+        }
+        PackedType sums;
+#pragma unroll
+        for (int i = 0; i < PACKED_ELTS; ++i)
+        {
+            reinterpret_cast<T*>(sums.unpacked)[i] = static_cast<T>(acc[i]);
+        }
+        *reinterpret_cast<int4*>(&local_output_buffer[offset]) = sums.packed;
+    }
+
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    cudaTriggerProgrammaticLaunchCompletion();
+#endif
+}
+#endif // ENABLE_FP8
+
+template <typename T, int RANKS_PER_NODE, bool Bias = false, bool Residual = false>
+void compressedOneShotKernelLaunch(AllReduceParams& params, cudaStream_t stream)
+{
+#ifdef ENABLE_FP8
+    // One warp per chunk, the blocks of every GPU quantize and read the same chunks.
+    size_t const total_threads = CompressedPayload<T>::numChunks(params.elts_total) * WARP_SIZE;
+    size_t const threads_per_block = std::min(DEFAULT_BLOCK_SIZE, total_threads);
+    size_t const blocks_per_grid
+        = std::min(static_cast<size_t>(MAX_ALL_REDUCE_BLOCKS), divUp(total_threads, threads_per_block));
+    compressedOneShotAllReduceKernel<T, RANKS_PER_NODE, Bias, Residual>
+        <<<blocks_per_grid, threads_per_block, 0, stream>>>(params);
+#else
+    TLLM_THROW("The FP8 compressed all-reduce needs a build with FP8 enabled.");
+#endif
+}
+
+// multimem.ld_reduce loads the 16 bytes at a multicast address from every rank bound to it and returns their sum,
+// multimem.st writes 16 bytes to all of them. Both need sm_90 and the NVSwitch to do the work.
+template <typename T>
+inline __device__ int4 multimem_ld_reduce_add(T const* mc_ptr);
+
+template <>
+inline __device__ int4 multimem_ld_reduce_add<float>(float const* mc_ptr)
+{
+    int4 ret{0, 0, 0, 0};
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    asm volatile("multimem.ld_reduce.relaxed.sys.global.add.v4.f32 {%0, %1, %2, %3}, [%4];"
+                 : "=r"(ret.x), "=r"(ret.y), "=r"(ret.z), "=r"(ret.w)
+                 : "l"(mc_ptr)
+                 : "memory");
+#endif
+    return ret;
+}
+
+template <>
+inline __device__ int4 multimem_ld_reduce_add<half>(half const* mc_ptr)
+{
+    int4 ret{0, 0, 0, 0};
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    asm volatile("multimem.ld_reduce.relaxed.sys.global.add.acc::f32.v4.f16x2 {%0, %1, %2, %3}, [%4];"
+                 : "=r"(ret.x), "=r"(ret.y), "=r"(ret.z), "=r"(ret.w)
+                 : "l"(mc_ptr)
+                 : "memory");
+#endif
+    return ret;
+}
+
+#ifdef ENABLE_BF16
+template <>
+inline __device__ int4 multimem_ld_reduce_add<__nv_bfloat16>(__nv_bfloat16 const* mc_ptr)
+{
+    int4 ret{0, 0, 0, 0};
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    asm volatile("multimem.ld_reduce.relaxed.sys.global.add.acc::f32.v4.bf16x2 {%0, %1, %2, %3}, [%4];"
+                 : "=r"(ret.x), "=r"(ret.y), "=r"(ret.z), "=r"(ret.w)
+                 : "l"(mc_ptr)
+                 : "memory");
+#endif
+    return ret;
+}
+#endif
+
+inline __device__ void multimem_st(void* mc_ptr, int4 const& val)
+{
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    asm volatile("multimem.st.relaxed.sys.global.v4.b32 [%0], {%1, %2, %3, %4};" ::"l"(mc_ptr), "r"(val.x),
+                 "r"(val.y), "r"(val.z), "r"(val.w)
+                 : "memory");
+#endif
+}
+
+template <typename T, int RANKS_PER_NODE>
+static __global__ void __launch_bounds__(512, 1) nvlsAllReduceKernel(AllReduceParams params)
+{
+    // The message is partitioned like in the two-shot kernel, but the reduce-scatter and the all-gather steps are
+    // done by the switch:
+    // 1. B0 copies all chunks it is responsible for, from local_input to the local (unicast) view of the NVLS buffer
+    // 2. B0 on every GPU wait for each other (block_barrier #0)
+    // 3. B0 on GPU r reduces its chunk of the GPU r responsibility part with one multimem.ld_reduce from the
+    //    multicast address and writes the sum back to the buffers of all GPUs with one multimem.st
+    // 4. B0 on every GPU wait for each other (block_barrier #1)
+    // 5. B0 copies all its chunks, now holding the sums, from the local view of the NVLS buffer to local_output
+    //
+    // Compared to two-shot, every sum is read and broadcast once over NVLink instead of RANKS_PER_NODE times.
+
+    int const bidx = blockIdx.x;
+    int const tidx = threadIdx.x;
+    int const grid_size = gridDim.x;
+
+    // The number of elements packed into one for comms
+    static constexpr int PACKED_ELTS = 16 / sizeof(T);
+
+    T const* local_input_buffer = reinterpret_cast<T const*>(params.local_input_buffer_ptr);
+    T* local_uc_buffer = reinterpret_cast<T*>(params.nvls_uc_ptr);
+    T* mc_buffer = reinterpret_cast<T*>(params.nvls_mc_ptr);
+    T* local_output_buffer = reinterpret_cast<T*>(params.local_output_buffer_ptr);
+
+    size_t const chunk_start = bidx * params.elts_per_block + tidx * PACKED_ELTS;
+    size_t const chunk_end = min(chunk_start + params.elts_per_block, params.elts_per_rank);
+
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    cudaGridDependencySynchronize();
+#endif
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+#pragma unroll
+        for (int ii = 0; ii < RANKS_PER_NODE; ++ii)
+        {
+            size_t offset_rank = ii * params.elts_per_rank + local_offset;
+            if (offset_rank >= params.elts_total)
+            {
+                continue;
+            }
+            *reinterpret_cast<int4*>(&local_uc_buffer[offset_rank])
+                = *reinterpret_cast<int4 const*>(&local_input_buffer[offset_rank]);
+        }
+    }
+    // The buffer is written through its unicast mapping and read through the multicast one, the writes of the whole
+    // block must be visible through the other mapping before the barrier releases the other GPUs.
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    asm volatile("fence.proxy.alias;" ::: "memory");
+#endif
+    __syncthreads();
+    block_barrier(
+        params.peer_barrier_ptrs_in, params.barrier_flag, params.local_rank, RANKS_PER_NODE, tidx, bidx, grid_size);
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+        size_t const responsible_block_offset = local_offset + params.rank_offset;
+        int4 const sums = multimem_ld_reduce_add(&mc_buffer[responsible_block_offset]);
+        multimem_st(&mc_buffer[responsible_block_offset], sums);
+    }
+    // Likewise for the multimem stores, which are read back through the unicast mapping.
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    asm volatile("fence.proxy.alias;" ::: "memory");
+#endif
+    __syncthreads();
+    block_barrier(
+        params.peer_barrier_ptrs_out, params.barrier_flag, params.local_rank, RANKS_PER_NODE, tidx, bidx, grid_size);
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+#pragma unroll
+        for (int ii = 0; ii < RANKS_PER_NODE; ++ii)
+        {
+            size_t offset_rank = ii * params.elts_per_rank + local_offset;
+            if (offset_rank >= params.elts_total)
+            {
+                continue;
+            }
+            *reinterpret_cast<int4*>(&local_output_buffer[offset_rank])
+                = *reinterpret_cast<int4 const*>(&local_uc_buffer[offset_rank]);
+        }
+    }
+
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    cudaTriggerProgrammaticLaunchCompletion();
+#endif
+}
+
+template <typename T, int RANKS_PER_NODE>
+static __global__ void __launch_bounds__(512, 1) nodeReduceScatterKernel(AllReduceParams params)
+{
+    // Steps 1. to 3. of the two-shot kernel: the sums of the GPU responsibility part stay in the local shareable
+    // buffer, where the inter-node all-reduce and nodeAllGatherKernel pick them up.
+    int const bidx = blockIdx.x;
+    int const tidx = threadIdx.x;
+    int const grid_size = gridDim.x;
+
+    // The number of elements packed into one for comms
+    static constexpr int PACKED_ELTS = 16 / sizeof(T);
+    using PackedType = typename PackedOn16Bytes<T>::Type;
+
+    T const* local_input_buffer = reinterpret_cast<T const*>(params.local_input_buffer_ptr);
+    T* local_shared_buffer = reinterpret_cast<T*>(params.peer_comm_buffer_ptrs[params.local_rank]);
+
+    size_t const chunk_start = bidx * params.elts_per_block + tidx * PACKED_ELTS;
+    size_t const chunk_end = min(chunk_start + params.elts_per_block, params.elts_per_rank);
+
+    T* buffers[RANKS_PER_NODE];
+#pragma unroll
+    for (int ii = 0; ii < RANKS_PER_NODE; ++ii)
+    {
+        // A mapping of the ranks to scatter reads as much as possible
+        int rank = (params.local_rank + ii) % RANKS_PER_NODE;
+        buffers[ii] = reinterpret_cast<T*>(params.peer_comm_buffer_ptrs[rank]);
+    }
+
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    cudaGridDependencySynchronize();
+#endif
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+#pragma unroll
+        for (int ii = 0; ii < RANKS_PER_NODE; ++ii)
+        {
+            size_t offset_rank = ii * params.elts_per_rank + local_offset;
+            if (offset_rank >= params.elts_total)
+            {
+                continue;
+            }
+            *reinterpret_cast<int4*>(&local_shared_buffer[offset_rank])
+                = *reinterpret_cast<int4 const*>(&local_input_buffer[offset_rank]);
+        }
+    }
+    block_barrier(
+        params.peer_barrier_ptrs_in, params.barrier_flag, params.local_rank, RANKS_PER_NODE, tidx, bidx, grid_size);
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+        size_t const responsible_block_offset = local_offset + params.rank_offset;
+
+        PackedType vals[RANKS_PER_NODE];
+#pragma unroll
+        for (int ii = 0; ii < RANKS_PER_NODE; ++ii)
+        {
+            vals[ii].packed = *reinterpret_cast<int4 const*>(&buffers[ii][responsible_block_offset]);
+        }
+
+        PackedType sums;
+        sums.packed = {0, 0, 0, 0};
+#pragma unroll
+        for (int rank = 0; rank < RANKS_PER_NODE; ++rank)
+        {
+            // Always reduce from rank 0 to ensure stable reduce order.
+            int ii = (rank + RANKS_PER_NODE - params.local_rank) % RANKS_PER_NODE;
+            sums.packed = add128b(sums, vals[ii]);
+        }
+        *reinterpret_cast<int4*>(&local_shared_buffer[responsible_block_offset]) = sums.packed;
+    }
+
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    cudaTriggerProgrammaticLaunchCompletion();
+#endif
+}
+
+template <typename T, int RANKS_PER_NODE>
+static __global__ void __launch_bounds__(512, 1) nodeAllGatherKernel(AllReduceParams params)
+{
+    // Steps 4. and 5. of the two-shot kernel. The barrier also makes sure the other GPUs of the node are done with
+    // the inter-node all-reduce of their part.
+    int const bidx = blockIdx.x;
+    int const tidx = threadIdx.x;
+    int const grid_size = gridDim.x;
+
+    // The number of elements packed into one for comms
+    static constexpr int PACKED_ELTS = 16 / sizeof(T);
+
+    T* local_output_buffer = reinterpret_cast<T*>(params.local_output_buffer_ptr);
+
+    size_t const chunk_start = bidx * params.elts_per_block + tidx * PACKED_ELTS;
+    size_t const chunk_end = min(chunk_start + params.elts_per_block, params.elts_per_rank);
+
+    T* buffers[RANKS_PER_NODE];
+    int ranks[RANKS_PER_NODE];
+#pragma unroll
+    for (int ii = 0; ii < RANKS_PER_NODE; ++ii)
+    {
+        int rank = (params.local_rank + ii) % RANKS_PER_NODE;
+        ranks[ii] = rank;
+        buffers[ii] = reinterpret_cast<T*>(params.peer_comm_buffer_ptrs[rank]);
+    }
+
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    cudaGridDependencySynchronize();
+#endif
+
+    block_barrier(
+        params.peer_barrier_ptrs_out, params.barrier_flag, params.local_rank, RANKS_PER_NODE, tidx, bidx, grid_size);
+
+    for (size_t local_offset = chunk_start; local_offset < chunk_end; local_offset += blockDim.x * PACKED_ELTS)
+    {
+#pragma unroll
+        for (int ii = 0; ii < RANKS_PER_NODE; ++ii)
+        {
+            // use round-robin gathering from other ranks
+            size_t offset_rank = ranks[ii] * params.elts_per_rank + local_offset;
+            if (offset_rank >= params.elts_total)
+            {
+                continue;
+            }
+            *reinterpret_cast<int4*>(&local_output_buffer[offset_rank])
+                = *reinterpret_cast<int4 const*>(&buffers[ii][offset_rank]);
+        }
+    }
+
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+    cudaTriggerProgrammaticLaunchCompletion();
+#endif
+}
+
 bool configurationSupported(AllReduceStrategyType algo, size_t msg_size, size_t n_ranks, nvinfer1::DataType type)
 {
     size_t elts_per_thread = 16 / common::getDTypeSize(type);
-    int const msg_align = (algo == AllReduceStrategyType::TWOSHOT) ? n_ranks * elts_per_thread : elts_per_thread;
-    bool supported_algo = (algo == AllReduceStrategyType::ONESHOT || algo == AllReduceStrategyType::TWOSHOT);
+    // For HIERARCHICAL, n_ranks is the number of ranks per node.
+    bool const scatters = (algo == AllReduceStrategyType::TWOSHOT || algo == AllReduceStrategyType::NVLS
+        || algo == AllReduceStrategyType::HIERARCHICAL);
+    int const msg_align = scatters ? n_ranks * elts_per_thread : elts_per_thread;
+    bool supported_algo = (algo == AllReduceStrategyType::ONESHOT || algo == AllReduceStrategyType::TWOSHOT
+        || algo == AllReduceStrategyType::HIERARCHICAL);
+    if (algo == AllReduceStrategyType::NVLS)
+    {
+        // multimem instructions exist from Hopper on, the multicast buffer itself is checked by AllReduceBuffers.
+        supported_algo = common::getSMVersion() >= 90;
+    }
     return supported_algo && (msg_size % msg_align == 0);
 }
 
@@ -920,6 +1486,8 @@ std::tuple<int, int> kernelLaunchConfig(AllReduceStrategyType algo, AllReducePar
         break;
     }
     case AllReduceStrategyType::TWOSHOT:
+    case AllReduceStrategyType::NVLS:
+    case AllReduceStrategyType::HIERARCHICAL:
     {
         TLLM_CHECK(params.elts_total % (elts_per_thread * params.ranks_per_node) == 0);
         size_t const total_threads = roundUp(params.elts_total / (elts_per_thread * params.ranks_per_node), WARP_SIZE);
@@ -957,15 +1525,23 @@ std::tuple<int, int> kernelLaunchConfig(AllReduceStrategyType algo, AllReducePar
 }
 
 template <typename T, int RANKS_PER_NODE, bool PUSH_MODE = false, bool USE_MEMCPY = false, bool Bias = false,
-    bool Affine = false>
+    bool Affine = false, typename QuantT = void>
 void AllReduceNormKernelLaunch(AllReduceStrategyType algo, AllReduceStrategyConfig config, AllReduceFusionOp fusionOp,
     AllReduceParams& params, cudaStream_t stream)
 {
-    TLLM_CHECK_WITH_INFO(fusionOp == AllReduceFusionOp::RESIDUAL_RMS_NORM, "Unsupported AllReduceFusionOp: %d",
-        static_cast<int>(fusionOp));
-    if (algo == AllReduceStrategyType::ONESHOT)
+    if (algo == AllReduceStrategyType::ONESHOT && hasConfigFlag(config, AllReduceStrategyConfig::COMPRESS_FP8))
+    {
+        // The compressed kernel adds the bias and the residual, the norm runs on its output like after two-shot.
+        auto output_ptr = params.local_output_buffer_ptr;
+        params.local_output_buffer_ptr = params.fusion_params.intermediate_buffer;
+        compressedOneShotKernelLaunch<T, RANKS_PER_NODE, Bias, true>(params, stream);
+        params.local_output_buffer_ptr = output_ptr;
+        reduce_fusion::rms_norm_kernel_launcher<T, false, false, Affine, QuantT>(params, stream);
+    }
+    else if (algo == AllReduceStrategyType::ONESHOT)
     {
-        reduce_fusion::one_shot_all_reduce_norm_kernel_launcher<T, RANKS_PER_NODE, Bias, Affine>(params, stream);
+        reduce_fusion::one_shot_all_reduce_norm_kernel_launcher<T, RANKS_PER_NODE, Bias, Affine, QuantT>(
+            params, stream);
     }
     else
     {
@@ -1004,7 +1580,31 @@ void AllReduceNormKernelLaunch(AllReduceStrategyType algo, AllReduceStrategyConf
                 <<<blocks_per_grid, threads_per_block, 0, stream>>>(params);
         }
         params.local_output_buffer_ptr = output_ptr;
-        reduce_fusion::rms_norm_kernel_launcher<T, false, false, Affine>(params, stream);
+        reduce_fusion::rms_norm_kernel_launcher<T, false, false, Affine, QuantT>(params, stream);
+    }
+}
+
+template <typename T, int RANKS_PER_NODE, bool PUSH_MODE, bool USE_MEMCPY, bool Bias, bool Affine>
+void AllReduceNormQuantDispatch(AllReduceStrategyType algo, AllReduceStrategyConfig config,
+    AllReduceFusionOp fusionOp, AllReduceParams& params, cudaStream_t stream)
+{
+    switch (fusionOp)
+    {
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM:
+        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, Bias, Affine>(
+            algo, config, fusionOp, params, stream);
+        break;
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_INT8:
+        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, Bias, Affine, int8_t>(
+            algo, config, fusionOp, params, stream);
+        break;
+#ifdef ENABLE_FP8
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_FP8:
+        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, Bias, Affine, __nv_fp8_e4m3>(
+            algo, config, fusionOp, params, stream);
+        break;
+#endif
+    default: TLLM_THROW("Unsupported AllReduceFusionOp: %d", static_cast<int>(fusionOp));
     }
 }
 
@@ -1014,22 +1614,22 @@ void AllReduceNormDispatch(AllReduceStrategyType algo, AllReduceStrategyConfig c
 {
     if (params.fusion_params.bias_buffer && params.fusion_params.weight_buffer)
     {
-        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, true, true>(
+        AllReduceNormQuantDispatch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, true, true>(
             algo, config, fusionOp, params, stream);
     }
     else if (params.fusion_params.bias_buffer && !params.fusion_params.weight_buffer)
     {
-        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, true, false>(
+        AllReduceNormQuantDispatch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, true, false>(
             algo, config, fusionOp, params, stream);
     }
     else if (!params.fusion_params.bias_buffer && params.fusion_params.weight_buffer)
     {
-        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, false, true>(
+        AllReduceNormQuantDispatch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, false, true>(
             algo, config, fusionOp, params, stream);
     }
     else
     {
-        AllReduceNormKernelLaunch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, false, false>(
+        AllReduceNormQuantDispatch<T, RANKS_PER_NODE, PUSH_MODE, USE_MEMCPY, false, false>(
             algo, config, fusionOp, params, stream);
     }
 }
@@ -1042,6 +1642,18 @@ void AllReduceDispatch(AllReduceStrategyType algo, AllReduceStrategyConfig confi
     TLLM_CHECK_WITH_INFO(!(USE_MEMCPY && PUSH_MODE), "Memcpy cannot be used with PUSH_MODE.");
     size_t elts_per_thread = 16 / sizeof(T);
     auto [blocks_per_grid, threads_per_block] = kernelLaunchConfig(algo, params, elts_per_thread);
+    if (algo == AllReduceStrategyType::NVLS)
+    {
+        // The NVLS kernel always stages the input itself, the memcpy and push modes do not apply.
+        nvlsAllReduceKernel<T, RANKS_PER_NODE><<<blocks_per_grid, threads_per_block, 0, stream>>>(params);
+        return;
+    }
+    if (algo == AllReduceStrategyType::ONESHOT && hasConfigFlag(config, AllReduceStrategyConfig::COMPRESS_FP8))
+    {
+        // The compressed kernel quantizes the input itself, the memcpy and push modes do not apply.
+        compressedOneShotKernelLaunch<T, RANKS_PER_NODE>(params, stream);
+        return;
+    }
     if (USE_MEMCPY)
     {
         cudaMemcpyAsync(params.peer_comm_buffer_ptrs[params.local_rank], params.local_input_buffer_ptr,
@@ -1117,8 +1729,10 @@ void AllReduceDispatchType(AllReduceParams& params, AllReduceStrategyType strat,
     }
 }
 
-AllReduceParams AllReduceParams::deserialize(int64_t* buffer, size_t tpSize, size_t tpRank)
+AllReduceParams AllReduceParams::deserialize(
+    int64_t* buffer, size_t tpSize, size_t tpRank, bool hasNvls, size_t nodeSize)
 {
+    auto const ranksPerNode = nodeSize == 0 ? tpSize : nodeSize;
     void* const* buffer_ptrs = reinterpret_cast<void* const*>(buffer);
     auto const flag_ptr = &buffer[4 * tpSize];
     // cannot use 0 since 0 represents released state for barrier
@@ -1131,21 +1745,24 @@ AllReduceParams AllReduceParams::deserialize(int64_t* buffer, size_t tpSize, siz
     // before copying input tensor to workspace.
     auto const buffer_offset = (flag_value % 2 == 0) ? 0 : tpSize;
 
-    for (int i = 0; i < tpSize; ++i)
+    for (int i = 0; i < ranksPerNode; ++i)
     {
         params.peer_comm_buffer_ptrs[i] = buffer_ptrs[buffer_offset + i];
     }
-    for (int i = 0; i < tpSize; ++i)
+    for (int i = 0; i < ranksPerNode; ++i)
     {
         params.peer_barrier_ptrs_in[i] = reinterpret_cast<uint32_t*>(buffer_ptrs[2 * tpSize + i]);
     }
-    for (int i = 0; i < tpSize; ++i)
+    for (int i = 0; i < ranksPerNode; ++i)
     {
         params.peer_barrier_ptrs_out[i] = reinterpret_cast<uint32_t*>(buffer_ptrs[3 * tpSize + i]);
     }
     params.barrier_flag = flag_value;
-    params.ranks_per_node = tpSize;
-    params.local_rank = tpRank;
+    params.ranks_per_node = ranksPerNode;
+    params.local_rank = tpRank % ranksPerNode;
+    // The NVLS buffer needs no ping-pong: the kernel stages its input after both barriers of the previous call.
+    params.nvls_uc_ptr = hasNvls ? reinterpret_cast<void*>(flag_ptr[1]) : nullptr;
+    params.nvls_mc_ptr = hasNvls ? reinterpret_cast<void*>(flag_ptr[2]) : nullptr;
 
     return params;
 }
@@ -1155,6 +1772,15 @@ void customAllReduce(kernels::AllReduceParams& params, nvinfer1::DataType dataTy
 {
     TLLM_CHECK_WITH_INFO(configurationSupported(strat, params.elts_total, params.ranks_per_node, dataType),
         "Custom all-reduce configuration unsupported");
+    if (strat == AllReduceStrategyType::NVLS && fusionOp != AllReduceFusionOp::NONE)
+    {
+        // The norm fusions have no NVLS variant, they run the two-shot kernels over the same workspace.
+        strat = AllReduceStrategyType::TWOSHOT;
+    }
+    TLLM_CHECK_WITH_INFO(strat != AllReduceStrategyType::NVLS || params.nvls_mc_ptr != nullptr,
+        "The all-reduce workspace has no NVLS buffer");
+    TLLM_CHECK_WITH_INFO(strat != AllReduceStrategyType::HIERARCHICAL,
+        "The hierarchical all-reduce runs through hierarchicalReduceScatter and hierarchicalAllGather");
 
     sync_check_cuda_error();
 
@@ -1172,36 +1798,113 @@ void customAllReduce(kernels::AllReduceParams& params, nvinfer1::DataType dataTy
     sync_check_cuda_error();
 }
 
+template <typename T, int RANKS_PER_NODE>
+void hierarchicalKernelLaunch(AllReduceParams& params, bool reduceScatter, cudaStream_t stream)
+{
+    size_t elts_per_thread = 16 / sizeof(T);
+    auto [blocks_per_grid, threads_per_block]
+        = kernelLaunchConfig(AllReduceStrategyType::HIERARCHICAL, params, elts_per_thread);
+    if (reduceScatter)
+    {
+        nodeReduceScatterKernel<T, RANKS_PER_NODE><<<blocks_per_grid, threads_per_block, 0, stream>>>(params);
+    }
+    else
+    {
+        nodeAllGatherKernel<T, RANKS_PER_NODE><<<blocks_per_grid, threads_per_block, 0, stream>>>(params);
+    }
+}
+
 template <typename T>
+void hierarchicalDispatchRanksPerNode(AllReduceParams& params, bool reduceScatter, cudaStream_t stream)
+{
+    switch (params.ranks_per_node)
+    {
+    case 2: hierarchicalKernelLaunch<T, 2>(params, reduceScatter, stream); break;
+    case 4: hierarchicalKernelLaunch<T, 4>(params, reduceScatter, stream); break;
+    case 6: hierarchicalKernelLaunch<T, 6>(params, reduceScatter, stream); break;
+    case 8: hierarchicalKernelLaunch<T, 8>(params, reduceScatter, stream); break;
+    default: TLLM_THROW("Custom all reduce only supported on {2, 4, 6, 8} GPUs per node.");
+    }
+}
+
+void hierarchicalDispatchType(
+    AllReduceParams& params, nvinfer1::DataType dataType, bool reduceScatter, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(configurationSupported(
+                             AllReduceStrategyType::HIERARCHICAL, params.elts_total, params.ranks_per_node, dataType),
+        "Custom all-reduce configuration unsupported");
+    sync_check_cuda_error();
+    switch (dataType)
+    {
+    case nvinfer1::DataType::kFLOAT: hierarchicalDispatchRanksPerNode<float>(params, reduceScatter, stream); break;
+    case nvinfer1::DataType::kHALF: hierarchicalDispatchRanksPerNode<half>(params, reduceScatter, stream); break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16:
+        hierarchicalDispatchRanksPerNode<__nv_bfloat16>(params, reduceScatter, stream);
+        break;
+#endif
+    default: TLLM_THROW("Unsupported dataType for customAllReduce");
+    }
+    sync_check_cuda_error();
+}
+
+void hierarchicalReduceScatter(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream)
+{
+    hierarchicalDispatchType(params, dataType, true, stream);
+}
+
+void hierarchicalAllGather(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream)
+{
+    hierarchicalDispatchType(params, dataType, false, stream);
+}
+
+template <typename T, typename QuantT = void>
 void launchResidualRmsNormKernel(kernels::AllReduceParams& params, cudaStream_t stream)
 {
     if (params.fusion_params.bias_buffer && params.fusion_params.weight_buffer)
     {
-        reduce_fusion::rms_norm_kernel_launcher<T, true, true, true>(params, stream);
+        reduce_fusion::rms_norm_kernel_launcher<T, true, true, true, QuantT>(params, stream);
     }
     else if (params.fusion_params.bias_buffer && !params.fusion_params.weight_buffer)
     {
-        reduce_fusion::rms_norm_kernel_launcher<T, true, true, false>(params, stream);
+        reduce_fusion::rms_norm_kernel_launcher<T, true, true, false, QuantT>(params, stream);
     }
     else if (!params.fusion_params.bias_buffer && params.fusion_params.weight_buffer)
     {
-        reduce_fusion::rms_norm_kernel_launcher<T, false, true, true>(params, stream);
+        reduce_fusion::rms_norm_kernel_launcher<T, false, true, true, QuantT>(params, stream);
     }
     else
     {
-        reduce_fusion::rms_norm_kernel_launcher<T, false, true, false>(params, stream);
+        reduce_fusion::rms_norm_kernel_launcher<T, false, true, false, QuantT>(params, stream);
+    }
+}
+
+template <typename T>
+void launchResidualRmsNormQuantKernel(kernels::AllReduceParams& params, AllReduceFusionOp fusionOp, cudaStream_t stream)
+{
+    switch (fusionOp)
+    {
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM: launchResidualRmsNormKernel<T>(params, stream); break;
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_INT8: launchResidualRmsNormKernel<T, int8_t>(params, stream); break;
+#ifdef ENABLE_FP8
+    case AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_FP8:
+        launchResidualRmsNormKernel<T, __nv_fp8_e4m3>(params, stream);
+        break;
+#endif
+    default: TLLM_THROW("Unsupported AllReduceFusionOp: %d", static_cast<int>(fusionOp));
     }
 }
 
-void residualRmsNorm(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream)
+void residualRmsNorm(kernels::AllReduceParams& params, nvinfer1::DataType dataType, AllReduceFusionOp fusionOp,
+    cudaStream_t stream)
 {
     sync_check_cuda_error();
     switch (dataType)
     {
-    case nvinfer1::DataType::kFLOAT: launchResidualRmsNormKernel<float>(params, stream); break;
-    case nvinfer1::DataType::kHALF: launchResidualRmsNormKernel<half>(params, stream); break;
+    case nvinfer1::DataType::kFLOAT: launchResidualRmsNormQuantKernel<float>(params, fusionOp, stream); break;
+    case nvinfer1::DataType::kHALF: launchResidualRmsNormQuantKernel<half>(params, fusionOp, stream); break;
 #ifdef ENABLE_BF16
-    case nvinfer1::DataType::kBF16: launchResidualRmsNormKernel<__nv_bfloat16>(params, stream); break;
+    case nvinfer1::DataType::kBF16: launchResidualRmsNormQuantKernel<__nv_bfloat16>(params, fusionOp, stream); break;
 #endif
     default: TLLM_THROW("Unsupported dataType for customAllReduce");
     }
@@ -19,6 +19,7 @@
 #include <NvInferRuntime.h>
 #include <cuda_bf16.h>
 #include <cuda_fp16.h>
+#include <type_traits>
 
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/cudaUtils.h"
@@ -39,20 +40,44 @@ enum class AllReduceStrategyType : int8_t
     ONESHOT = 1,
     TWOSHOT = 2,
     AUTO = 3,
+    // In-switch reduction through NVLink SHARP multicast memory, see AllReduceBuffers.
+    NVLS = 4,
+    // For TP groups spanning nodes: reduce-scatter within the node over the IPC buffers, all-reduce of the local slice
+    // over the nodes with NCCL, then all-gather within the node. See hierarchicalReduceScatter.
+    HIERARCHICAL = 5,
 };
 
 enum class AllReduceStrategyConfig : int8_t
 {
     USE_MEMCPY = 1 << 0,
     PUSH_MODE = 1 << 1,
+    // The one-shot all-reduce shares FP8 values with one scale per chunk instead of the input and accumulates in
+    // FP32: up to 4x less traffic between the GPUs for a lossy sum. Needs an FP8 enabled build.
+    COMPRESS_FP8 = 1 << 2,
 };
 
+inline bool hasConfigFlag(AllReduceStrategyConfig config, AllReduceStrategyConfig flag)
+{
+    using ConfigType = std::underlying_type_t<AllReduceStrategyConfig>;
+    return (static_cast<ConfigType>(config) & static_cast<ConfigType>(flag)) != 0;
+}
+
 enum class AllReduceFusionOp : int8_t
 {
     NONE = 0,
     RESIDUAL_RMS_NORM = 1,
+    // The normed output is quantized per token, the output buffer receives the quantized values and
+    // fusion_params.scale_out_buffer the dequantization scale of every token.
+    RESIDUAL_RMS_NORM_QUANT_FP8 = 2,
+    RESIDUAL_RMS_NORM_QUANT_INT8 = 3,
 };
 
+inline bool isQuantFusionOp(AllReduceFusionOp op)
+{
+    return op == AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_FP8
+        || op == AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_INT8;
+}
+
 struct AllReduceFusionParams
 {
     AllReduceFusionParams()
@@ -60,6 +85,7 @@ struct AllReduceFusionParams
         , residual_buffer(nullptr)
         , weight_buffer(nullptr)
         , intermediate_buffer(nullptr)
+        , scale_out_buffer(nullptr)
     {
     }
 
@@ -73,6 +99,8 @@ struct AllReduceFusionParams
     float eps;
     // new residual
     void* intermediate_buffer;
+    // per token dequantization scales of the quantized fusion ops
+    float* scale_out_buffer;
 };
 
 struct AllReduceParams
@@ -88,10 +116,17 @@ struct AllReduceParams
     void* peer_comm_buffer_ptrs[MAX_RANKS_PER_NODE];
     void* local_output_buffer_ptr;
     void const* local_input_buffer_ptr;
+    // The local unicast and the multicast mappings of the NVLS buffer, null when the workspace has none.
+    void* nvls_uc_ptr;
+    void* nvls_mc_ptr;
 
     AllReduceFusionParams fusion_params;
 
-    static AllReduceParams deserialize(int64_t* buffer, size_t tpSize, size_t tpRank);
+    //! With hasNvls the NVLS pointers, stored after the barrier flag, are read as well. With a nodeSize below tpSize
+    //! the IPC buffers are shared by the nodeSize ranks of a node only, and their pointers are the first nodeSize of
+    //! every tpSize pointers of the buffer.
+    static AllReduceParams deserialize(
+        int64_t* buffer, size_t tpSize, size_t tpRank, bool hasNvls = false, size_t nodeSize = 0);
 };
 
 bool configurationSupported(AllReduceStrategyType algo, size_t msg_size, size_t n_ranks, nvinfer1::DataType type);
@@ -99,6 +134,17 @@ bool configurationSupported(AllReduceStrategyType algo, size_t msg_size, size_t
 void customAllReduce(kernels::AllReduceParams& params, nvinfer1::DataType dataType, AllReduceStrategyType strat,
     AllReduceStrategyConfig config, AllReduceFusionOp fusionOp, cudaStream_t stream);
 
-void residualRmsNorm(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream);
+void residualRmsNorm(kernels::AllReduceParams& params, nvinfer1::DataType dataType, AllReduceFusionOp fusionOp,
+    cudaStream_t stream);
+
+//! The first step of the HIERARCHICAL strategy: sums the slice [rank_offset, rank_offset + elts_per_rank) of the
+//! message over the ranks of the node into the same slice of the local IPC buffer,
+//! params.peer_comm_buffer_ptrs[local_rank], and sets rank_offset and elts_per_rank. The caller then all-reduces that
+//! slice over the nodes, in place.
+void hierarchicalReduceScatter(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream);
+
+//! The last step of the HIERARCHICAL strategy: gathers the slices of all ranks of the node from their IPC buffers into
+//! the local output. Takes the params of the hierarchicalReduceScatter call.
+void hierarchicalAllGather(kernels::AllReduceParams& params, nvinfer1::DataType dataType, cudaStream_t stream);
 
 } // namespace tensorrt_llm::kernels
@@ -17,10 +17,15 @@
 #include "tensorrt_llm/kernels/cutlass_kernels/cutlass_preprocessors.h"
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/cudaBf16Wrapper.h"
+#include "tensorrt_llm/common/envUtils.h"
 #include "tensorrt_llm/common/stringUtils.h"
 
 #include "cutlass_extensions/gemm/kernel/mixed_gemm_B_layout.h"
 
+#include <algorithm>
+#include <exception>
+#include <thread>
+
 using namespace tensorrt_llm::common;
 
 namespace tensorrt_llm
@@ -30,6 +35,59 @@ namespace kernels
 namespace cutlass_kernels
 {
 
+namespace
+{
+
+// Runs func(begin, end) on contiguous ranges of [0, num_items), one per host thread. Every loop below is independent
+// across its items, and running them on one core made converting large checkpoints take hours. Ranges have at least
+// min_items_per_thread items so that small tensors do not pay for the threads.
+template <typename Func>
+void parallel_for(size_t num_items, size_t min_items_per_thread, Func const& func)
+{
+    size_t const max_threads = (num_items + min_items_per_thread - 1) / std::max<size_t>(min_items_per_thread, 1);
+    size_t const num_threads = std::min<size_t>(getEnvWeightPreprocessThreads(), max_threads);
+    if (num_threads <= 1)
+    {
+        func(size_t{0}, num_items);
+        return;
+    }
+
+    size_t const items_per_thread = (num_items + num_threads - 1) / num_threads;
+    std::vector<std::exception_ptr> errors(num_threads);
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (size_t t = 0; t < num_threads; ++t)
+    {
+        size_t const begin = t * items_per_thread;
+        size_t const end = std::min(begin + items_per_thread, num_items);
+        threads.emplace_back(
+            [&func, &errors, t, begin, end]
+            {
+                try
+                {
+                    func(begin, end);
+                }
+                catch (...)
+                {
+                    errors[t] = std::current_exception();
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    for (auto const& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+} // namespace
+
 struct LayoutDetails
 {
     enum class Layout
@@ -217,29 +275,33 @@ void permute_B_rows_for_mixed_gemm(int8_t* permuted_quantized_tensor, int8_t con
 
     TLLM_CHECK_WITH_INFO(size_t(B_ROWS_PER_MMA) == row_permutation.size(), "Unexpected number of LDSM rows permuted.");
 
-    for (int expert = 0; expert < num_experts; ++expert)
-    {
-        const int64_t matrix_offset = expert * int64_t(num_rows) * int64_t(num_vec_cols);
-        for (int base_row = 0; base_row < num_rows; base_row += B_ROWS_PER_MMA)
+    const size_t num_row_tiles = num_rows / B_ROWS_PER_MMA;
+    parallel_for(num_experts * num_row_tiles, 64,
+        [&](size_t begin, size_t end)
         {
-            for (int tile_row = 0; tile_row < B_ROWS_PER_MMA; ++tile_row)
+            for (size_t item = begin; item < end; ++item)
             {
-
-                for (int write_col = 0; write_col < num_vec_cols; ++write_col)
+                const int64_t expert = item / num_row_tiles;
+                int const base_row = (item % num_row_tiles) * B_ROWS_PER_MMA;
+                const int64_t matrix_offset = expert * int64_t(num_rows) * int64_t(num_vec_cols);
+                for (int tile_row = 0; tile_row < B_ROWS_PER_MMA; ++tile_row)
                 {
-                    int const write_row = base_row + tile_row;
-                    int const tile_read_row = row_permutation[tile_row];
-                    int const read_row = base_row + tile_read_row;
-                    int const read_col = write_col;
 
-                    const int64_t read_offset = matrix_offset + int64_t(read_row) * num_vec_cols + read_col;
-                    const int64_t write_offset = matrix_offset + int64_t(write_row) * num_vec_cols + write_col;
+                    for (int write_col = 0; write_col < num_vec_cols; ++write_col)
+                    {
+                        int const write_row = base_row + tile_row;
+                        int const tile_read_row = row_permutation[tile_row];
+                        int const read_row = base_row + tile_read_row;
+                        int const read_col = write_col;
+
+                        const int64_t read_offset = matrix_offset + int64_t(read_row) * num_vec_cols + read_col;
+                        const int64_t write_offset = matrix_offset + int64_t(write_row) * num_vec_cols + write_col;
 
-                    output_byte_ptr[write_offset] = input_byte_ptr[read_offset];
+                        output_byte_ptr[write_offset] = input_byte_ptr[read_offset];
+                    }
                 }
             }
-        }
-    }
+        });
 }
 
 // We need to use this transpose to correctly handle packed int4 and int8 data
@@ -269,7 +331,6 @@ void subbyte_transpose_impl(
 
     static constexpr int M_TILE_L1 = 64;
     static constexpr int N_TILE_L1 = M_TILE_L1 / ELTS_PER_BYTE;
-    uint8_t cache_buf[M_TILE_L1][N_TILE_L1];
 
     static constexpr int VECTOR_WIDTH = std::min(32, N_TILE_L1);
 
@@ -284,105 +345,109 @@ void subbyte_transpose_impl(
     int const num_m_tiles = (num_rows + M_TILE_L1 - 1) / M_TILE_L1;
     int const num_n_tiles = (col_bytes + N_TILE_L1 - 1) / N_TILE_L1;
 
-    for (size_t expert = 0; expert < num_experts; ++expert)
-    {
-        const size_t matrix_offset = expert * num_rows * col_bytes;
-        for (size_t row_tile_start = 0; row_tile_start < num_rows; row_tile_start += M_TILE_L1)
+    parallel_for(num_experts * num_m_tiles, 1,
+        [&](size_t begin, size_t end)
         {
-            for (size_t col_tile_start_byte = 0; col_tile_start_byte < col_bytes; col_tile_start_byte += N_TILE_L1)
+            uint8_t cache_buf[M_TILE_L1][N_TILE_L1];
+            for (size_t item = begin; item < end; ++item)
             {
-
-                int const row_limit = std::min(row_tile_start + M_TILE_L1, num_rows);
-                int const col_limit = std::min(col_tile_start_byte + N_TILE_L1, col_bytes);
-
-                for (int ii = 0; ii < M_TILE_L1; ++ii)
+                const size_t expert = item / num_m_tiles;
+                const size_t row_tile_start = (item % num_m_tiles) * M_TILE_L1;
+                const size_t matrix_offset = expert * num_rows * col_bytes;
+                for (size_t col_tile_start_byte = 0; col_tile_start_byte < col_bytes; col_tile_start_byte += N_TILE_L1)
                 {
-                    int const row = row_tile_start + ii;
 
-                    for (int jj = 0; jj < N_TILE_L1; jj += VECTOR_WIDTH)
-                    {
-                        int const col = col_tile_start_byte + jj;
+                    int const row_limit = std::min(row_tile_start + M_TILE_L1, num_rows);
+                    int const col_limit = std::min(col_tile_start_byte + N_TILE_L1, col_bytes);
 
-                        const size_t logical_src_offset = matrix_offset + row * col_bytes + col;
+                    for (int ii = 0; ii < M_TILE_L1; ++ii)
+                    {
+                        int const row = row_tile_start + ii;
 
-                        if (row < row_limit && col < col_limit)
+                        for (int jj = 0; jj < N_TILE_L1; jj += VECTOR_WIDTH)
                         {
-                            for (int v = 0; v < VECTOR_WIDTH; ++v)
+                            int const col = col_tile_start_byte + jj;
+
+                            const size_t logical_src_offset = matrix_offset + row * col_bytes + col;
+
+                            if (row < row_limit && col < col_limit)
                             {
-                                cache_buf[ii][jj + v] = input_byte_ptr[logical_src_offset + v];
+                                for (int v = 0; v < VECTOR_WIDTH; ++v)
+                                {
+                                    cache_buf[ii][jj + v] = input_byte_ptr[logical_src_offset + v];
+                                }
                             }
                         }
                     }
-                }
 
-                if constexpr (bits_per_elt == 8)
-                {
-                    for (int ii = 0; ii < M_TILE_L1; ++ii)
+                    if constexpr (bits_per_elt == 8)
                     {
-                        for (int jj = ii + 1; jj < N_TILE_L1; ++jj)
+                        for (int ii = 0; ii < M_TILE_L1; ++ii)
                         {
-                            std::swap(cache_buf[ii][jj], cache_buf[jj][ii]);
+                            for (int jj = ii + 1; jj < N_TILE_L1; ++jj)
+                            {
+                                std::swap(cache_buf[ii][jj], cache_buf[jj][ii]);
+                            }
                         }
                     }
-                }
-                else if constexpr (bits_per_elt == 4)
-                {
-
-                    for (int ii = 0; ii < M_TILE_L1; ++ii)
+                    else if constexpr (bits_per_elt == 4)
                     {
-                        // Using M_TILE_L1 here is deliberate since we assume that the cache tile
-                        // is square in the number of elements (not necessarily the number of bytes).
-                        for (int jj = ii + 1; jj < M_TILE_L1; ++jj)
+
+                        for (int ii = 0; ii < M_TILE_L1; ++ii)
                         {
-                            int const ii_byte = ii / ELTS_PER_BYTE;
-                            int const ii_bit_offset = ii % ELTS_PER_BYTE;
+                            // Using M_TILE_L1 here is deliberate since we assume that the cache tile
+                            // is square in the number of elements (not necessarily the number of bytes).
+                            for (int jj = ii + 1; jj < M_TILE_L1; ++jj)
+                            {
+                                int const ii_byte = ii / ELTS_PER_BYTE;
+                                int const ii_bit_offset = ii % ELTS_PER_BYTE;
 
-                            int const jj_byte = jj / ELTS_PER_BYTE;
-                            int const jj_bit_offset = jj % ELTS_PER_BYTE;
+                                int const jj_byte = jj / ELTS_PER_BYTE;
+                                int const jj_bit_offset = jj % ELTS_PER_BYTE;
 
-                            uint8_t src_elt = 0xF & (cache_buf[ii][jj_byte] >> (4 * jj_bit_offset));
-                            uint8_t tgt_elt = 0xF & (cache_buf[jj][ii_byte] >> (4 * ii_bit_offset));
+                                uint8_t src_elt = 0xF & (cache_buf[ii][jj_byte] >> (4 * jj_bit_offset));
+                                uint8_t tgt_elt = 0xF & (cache_buf[jj][ii_byte] >> (4 * ii_bit_offset));
 
-                            cache_buf[ii][jj_byte] &= (0xF0 >> (4 * jj_bit_offset));
-                            cache_buf[jj][ii_byte] &= (0xF0 >> (4 * ii_bit_offset));
+                                cache_buf[ii][jj_byte] &= (0xF0 >> (4 * jj_bit_offset));
+                                cache_buf[jj][ii_byte] &= (0xF0 >> (4 * ii_bit_offset));
 
-                            cache_buf[ii][jj_byte] |= (tgt_elt << (4 * jj_bit_offset));
-                            cache_buf[jj][ii_byte] |= (src_elt << (4 * ii_bit_offset));
+                                cache_buf[ii][jj_byte] |= (tgt_elt << (4 * jj_bit_offset));
+                                cache_buf[jj][ii_byte] |= (src_elt << (4 * ii_bit_offset));
+                            }
                         }
                     }
-                }
-                else
-                {
-                    TLLM_CHECK_WITH_INFO(false, "Unsupported quantization type.");
-                }
+                    else
+                    {
+                        TLLM_CHECK_WITH_INFO(false, "Unsupported quantization type.");
+                    }
 
-                const size_t row_tile_start_trans = col_tile_start_byte * ELTS_PER_BYTE;
-                const size_t col_tile_start_byte_trans = row_tile_start / ELTS_PER_BYTE;
+                    const size_t row_tile_start_trans = col_tile_start_byte * ELTS_PER_BYTE;
+                    const size_t col_tile_start_byte_trans = row_tile_start / ELTS_PER_BYTE;
 
-                int const row_limit_trans = std::min(row_tile_start_trans + M_TILE_L1, num_cols);
-                int const col_limit_trans = std::min(col_tile_start_byte_trans + N_TILE_L1, col_bytes_trans);
+                    int const row_limit_trans = std::min(row_tile_start_trans + M_TILE_L1, num_cols);
+                    int const col_limit_trans = std::min(col_tile_start_byte_trans + N_TILE_L1, col_bytes_trans);
 
-                for (int ii = 0; ii < M_TILE_L1; ++ii)
-                {
-                    int const row = row_tile_start_trans + ii;
-                    for (int jj = 0; jj < N_TILE_L1; jj += VECTOR_WIDTH)
+                    for (int ii = 0; ii < M_TILE_L1; ++ii)
                     {
-                        int const col = col_tile_start_byte_trans + jj;
+                        int const row = row_tile_start_trans + ii;
+                        for (int jj = 0; jj < N_TILE_L1; jj += VECTOR_WIDTH)
+                        {
+                            int const col = col_tile_start_byte_trans + jj;
 
-                        const size_t logical_tgt_offset = matrix_offset + row * col_bytes_trans + col;
+                            const size_t logical_tgt_offset = matrix_offset + row * col_bytes_trans + col;
 
-                        if (row < row_limit_trans && col < col_limit_trans)
-                        {
-                            for (int v = 0; v < VECTOR_WIDTH; ++v)
+                            if (row < row_limit_trans && col < col_limit_trans)
                             {
-                                output_byte_ptr[logical_tgt_offset + v] = cache_buf[ii][jj + v];
+                                for (int v = 0; v < VECTOR_WIDTH; ++v)
+                                {
+                                    output_byte_ptr[logical_tgt_offset + v] = cache_buf[ii][jj + v];
+                                }
                             }
                         }
                     }
                 }
             }
-        }
-    }
+        });
 }
 
 void subbyte_transpose(int8_t* transposed_quantized_tensor, int8_t const* quantized_tensor,
@@ -410,11 +475,10 @@ void subbyte_transpose(int8_t* transposed_quantized_tensor, int8_t const* quanti
 
 void add_bias_and_interleave_int8s_inplace(int8_t* int8_tensor, const size_t num_elts)
 {
-    for (int ii = 0; ii < num_elts; ++ii)
-    {
-        int8_tensor[ii] = int8_t(int(int8_tensor[ii]) + 128);
-    }
+    TLLM_CHECK_WITH_INFO(num_elts % 4 == 0, "Dimensions of int8 tensor must be a multiple of 4 for register relayout");
 
+    // Both steps are done register by register, each register is independent of the others.
+    // Step 1 adds the bias making the int8s unsigned.
     // Step 2 will transform the layout of a 32-bit register in CUDA in order to match the int4 layout. This has no
     // performance benefit and is purely so that int4 and int8 have the same layout.
     // Pictorially, this does the following:
@@ -425,66 +489,76 @@ void add_bias_and_interleave_int8s_inplace(int8_t* int8_tensor, const size_t num
     // bit 32                                                      0
     //      [elt_3  elt_1  elt_2  elt_0] (each elt occupies 8 bits)
 
-    TLLM_CHECK_WITH_INFO(num_elts % 4 == 0, "Dimensions of int8 tensor must be a multiple of 4 for register relayout");
-    for (size_t base = 0; base < num_elts; base += 4)
-    {
-        std::swap(int8_tensor[base + 1], int8_tensor[base + 2]);
-    }
+    parallel_for(num_elts / 4, 1 << 16,
+        [int8_tensor](size_t begin, size_t end)
+        {
+            for (size_t base = 4 * begin; base < 4 * end; base += 4)
+            {
+                for (size_t ii = base; ii < base + 4; ++ii)
+                {
+                    int8_tensor[ii] = int8_t(int(int8_tensor[ii]) + 128);
+                }
+                std::swap(int8_tensor[base + 1], int8_tensor[base + 2]);
+            }
+        });
 }
 
 void add_bias_and_interleave_int4s_inplace(int8_t* packed_int4_tensor, const size_t num_elts)
 {
-    int const num_bytes = num_elts / 2;
-
-    // Step 1 will be to transform all the int4s to unsigned in order to make the dequantize take as little
-    // instructions as possible in the CUDA code.
-    for (size_t ii = 0; ii < num_bytes; ++ii)
-    {
-        int8_t transformed_packed_int4s = 0;
-        int8_t transformed_first_elt
-            = (int8_t(packed_int4_tensor[ii] << 4) >> 4) + 8; // The double shift here is to ensure sign extension
-        int8_t transformed_second_elt = (packed_int4_tensor[ii] >> 4) + 8;
-
-        TLLM_CHECK_WITH_INFO(
-            transformed_first_elt >= 0 && transformed_first_elt <= 15, "Illegal result for int4 transform (first elt)");
-        TLLM_CHECK_WITH_INFO(transformed_second_elt >= 0 && transformed_second_elt <= 15,
-            "Illegal result for int4 transform (second elt)");
-
-        // We don't need to mask in these ops since everything should be in the range 0-15
-        transformed_packed_int4s |= transformed_first_elt;
-        transformed_packed_int4s |= (transformed_second_elt << 4);
-        packed_int4_tensor[ii] = transformed_packed_int4s;
-    }
-
-    // Step 2 will transform the layout of a 32-bit register in CUDA in order to minimize the number of shift & logical
-    // instructions That are needed to extract the int4s in the GEMM main loop. Pictorially, the loop below will do the
-    // following: Take as input a 32 bit register with layout: bit 32 0
-    //      [elt_7  elt_6  elt_5  elt_4  elt_3  elt_2  elt_1  elt_0] (each elt occupies 4 bits)
-    //
-    // And it will rearrange the output 32 bit register to be the following:
-    // bit 32                                                      0
-    //      [elt_7  elt_5  elt_3  elt_1  elt_6  elt_4  elt_2  elt_0] (each elt occupies 4 bits)
-
+    const size_t num_bytes = num_elts / 2;
     TLLM_CHECK_WITH_INFO(num_bytes % 4 == 0, "Dimensions of int4 tensor must be a multiple of 8 for register relayout");
     const size_t num_registers = num_bytes / 4;
 
-    uint32_t* register_ptr = reinterpret_cast<uint32_t*>(packed_int4_tensor);
-    for (size_t ii = 0; ii < num_registers; ++ii)
-    {
-        const uint32_t current_register = register_ptr[ii];
-        uint32_t transformed_register = 0;
-
-        for (int dest_idx = 0; dest_idx < 8; ++dest_idx)
+    // Both steps are done register by register, each register is independent of the others.
+    parallel_for(num_registers, 1 << 16,
+        [packed_int4_tensor](size_t begin, size_t end)
         {
-            int const src_idx = dest_idx < 4 ? 2 * dest_idx : 2 * (dest_idx - 4) + 1;
-            int const src_shift = 4 * src_idx;
-            int const dest_shift = 4 * dest_idx;
+            // Step 1 will be to transform all the int4s to unsigned in order to make the dequantize take as little
+            // instructions as possible in the CUDA code.
+            for (size_t ii = 4 * begin; ii < 4 * end; ++ii)
+            {
+                int8_t transformed_packed_int4s = 0;
+                // The double shift here is to ensure sign extension
+                int8_t transformed_first_elt = (int8_t(packed_int4_tensor[ii] << 4) >> 4) + 8;
+                int8_t transformed_second_elt = (packed_int4_tensor[ii] >> 4) + 8;
+
+                TLLM_CHECK_WITH_INFO(transformed_first_elt >= 0 && transformed_first_elt <= 15,
+                    "Illegal result for int4 transform (first elt)");
+                TLLM_CHECK_WITH_INFO(transformed_second_elt >= 0 && transformed_second_elt <= 15,
+                    "Illegal result for int4 transform (second elt)");
+
+                // We don't need to mask in these ops since everything should be in the range 0-15
+                transformed_packed_int4s |= transformed_first_elt;
+                transformed_packed_int4s |= (transformed_second_elt << 4);
+                packed_int4_tensor[ii] = transformed_packed_int4s;
+            }
 
-            const uint32_t src_bits = (current_register >> src_shift) & 0xF;
-            transformed_register |= (src_bits << dest_shift);
-        }
-        register_ptr[ii] = transformed_register;
-    }
+            // Step 2 will transform the layout of a 32-bit register in CUDA in order to minimize the number of shift &
+            // logical instructions That are needed to extract the int4s in the GEMM main loop. Pictorially, the loop
+            // below will do the following: Take as input a 32 bit register with layout: bit 32 0
+            //      [elt_7  elt_6  elt_5  elt_4  elt_3  elt_2  elt_1  elt_0] (each elt occupies 4 bits)
+            //
+            // And it will rearrange the output 32 bit register to be the following:
+            // bit 32                                                      0
+            //      [elt_7  elt_5  elt_3  elt_1  elt_6  elt_4  elt_2  elt_0] (each elt occupies 4 bits)
+            uint32_t* register_ptr = reinterpret_cast<uint32_t*>(packed_int4_tensor);
+            for (size_t ii = begin; ii < end; ++ii)
+            {
+                const uint32_t current_register = register_ptr[ii];
+                uint32_t transformed_register = 0;
+
+                for (int dest_idx = 0; dest_idx < 8; ++dest_idx)
+                {
+                    int const src_idx = dest_idx < 4 ? 2 * dest_idx : 2 * (dest_idx - 4) + 1;
+                    int const src_shift = 4 * src_idx;
+                    int const dest_shift = 4 * dest_idx;
+
+                    const uint32_t src_bits = (current_register >> src_shift) & 0xF;
+                    transformed_register |= (src_bits << dest_shift);
+                }
+                register_ptr[ii] = transformed_register;
+            }
+        });
 }
 
 void add_bias_and_interleave_quantized_tensor_inplace(int8_t* tensor, const size_t num_elts, QuantType quant_type)
@@ -536,28 +610,31 @@ void interleave_column_major_tensor(int8_t* interleaved_quantized_tensor, int8_t
     int const vec_rows_per_tile = rows_per_tile / elts_in_int32;
     int const interleave = details.columns_interleaved;
 
-    for (int expert = 0; expert < num_experts; ++expert)
-    {
-        const int64_t matrix_offset = expert * int64_t(num_vec_rows) * int64_t(num_cols);
-        for (int read_col = 0; read_col < num_cols; ++read_col)
+    parallel_for(num_experts * num_cols, 256,
+        [&](size_t begin, size_t end)
         {
-            const int64_t write_col = read_col / interleave;
-            for (int base_vec_row = 0; base_vec_row < num_vec_rows; base_vec_row += vec_rows_per_tile)
+            for (size_t item = begin; item < end; ++item)
             {
-                for (int vec_read_row = base_vec_row;
-                     vec_read_row < std::min(num_vec_rows, base_vec_row + vec_rows_per_tile); ++vec_read_row)
+                const int64_t expert = item / num_cols;
+                int const read_col = item % num_cols;
+                const int64_t matrix_offset = expert * int64_t(num_vec_rows) * int64_t(num_cols);
+                const int64_t write_col = read_col / interleave;
+                for (int base_vec_row = 0; base_vec_row < num_vec_rows; base_vec_row += vec_rows_per_tile)
                 {
-                    const int64_t vec_write_row = interleave * base_vec_row
-                        + vec_rows_per_tile * (read_col % interleave) + vec_read_row % vec_rows_per_tile;
+                    for (int vec_read_row = base_vec_row;
+                         vec_read_row < std::min(num_vec_rows, base_vec_row + vec_rows_per_tile); ++vec_read_row)
+                    {
+                        const int64_t vec_write_row = interleave * base_vec_row
+                            + vec_rows_per_tile * (read_col % interleave) + vec_read_row % vec_rows_per_tile;
 
-                    const int64_t read_offset = matrix_offset + int64_t(read_col) * num_vec_rows + vec_read_row;
-                    const int64_t write_offset
-                        = matrix_offset + int64_t(write_col) * num_vec_rows * interleave + vec_write_row;
-                    output_byte_ptr[write_offset] = input_byte_ptr[read_offset];
+                        const int64_t read_offset = matrix_offset + int64_t(read_col) * num_vec_rows + vec_read_row;
+                        const int64_t write_offset
+                            = matrix_offset + int64_t(write_col) * num_vec_rows * interleave + vec_write_row;
+                        output_byte_ptr[write_offset] = input_byte_ptr[read_offset];
+                    }
                 }
             }
-        }
-    }
+        });
 }
 
 void preprocess_weights_for_mixed_gemm(int8_t* preprocessed_quantized_weight, int8_t const* row_major_quantized_weight,
@@ -572,43 +649,46 @@ void preprocess_weights_for_mixed_gemm(int8_t* preprocessed_quantized_weight, in
     LayoutDetails details = getLayoutDetailsForTransform(quant_type, arch);
 
     TLLM_CHECK_WITH_INFO(shape.size() == 2 || shape.size() == 3, "Shape must be 2-D or 3-D");
+    const size_t num_experts = shape.size() == 2 ? 1 : shape[0];
+    std::vector<size_t> const matrix_shape{shape.end() - 2, shape.end()};
 
-    size_t num_elts = 1;
-    for (auto const& dim : shape)
-    {
-        num_elts *= dim;
-    }
-
+    const size_t num_elts = matrix_shape[0] * matrix_shape[1];
     const size_t num_bytes = num_elts * get_weight_quant_bits(quant_type) / 8;
 
+    // The experts are independent, preprocessing them one at a time bounds the buffers to one expert instead of the
+    // whole tensor.
     std::vector<int8_t> src_buf(num_bytes);
     std::vector<int8_t> dst_buf(num_bytes);
-    std::copy(row_major_quantized_weight, row_major_quantized_weight + num_bytes, src_buf.begin());
-
-    // Works on row major data, so issue this permutation first.
-    if (details.uses_imma_ldsm)
+    for (size_t expert = 0; expert < num_experts; ++expert)
     {
-        permute_B_rows_for_mixed_gemm(dst_buf.data(), src_buf.data(), shape, quant_type, arch);
-        src_buf.swap(dst_buf);
-    }
+        int8_t const* expert_weight = row_major_quantized_weight + expert * num_bytes;
+        std::copy(expert_weight, expert_weight + num_bytes, src_buf.begin());
 
-    if (details.layoutB == LayoutDetails::Layout::COLUMN_MAJOR)
-    {
-        subbyte_transpose(dst_buf.data(), src_buf.data(), shape, quant_type);
-        src_buf.swap(dst_buf);
-    }
+        // Works on row major data, so issue this permutation first.
+        if (details.uses_imma_ldsm)
+        {
+            permute_B_rows_for_mixed_gemm(dst_buf.data(), src_buf.data(), matrix_shape, quant_type, arch);
+            src_buf.swap(dst_buf);
+        }
 
-    if (details.columns_interleaved > 1)
-    {
-        interleave_column_major_tensor(dst_buf.data(), src_buf.data(), shape, quant_type, details);
-        src_buf.swap(dst_buf);
-    }
+        if (details.layoutB == LayoutDetails::Layout::COLUMN_MAJOR)
+        {
+            subbyte_transpose(dst_buf.data(), src_buf.data(), matrix_shape, quant_type);
+            src_buf.swap(dst_buf);
+        }
 
-    if (arch >= 70 && arch < 90)
-    {
-        add_bias_and_interleave_quantized_tensor_inplace(src_buf.data(), num_elts, quant_type);
+        if (details.columns_interleaved > 1)
+        {
+            interleave_column_major_tensor(dst_buf.data(), src_buf.data(), matrix_shape, quant_type, details);
+            src_buf.swap(dst_buf);
+        }
+
+        if (arch >= 70 && arch < 90)
+        {
+            add_bias_and_interleave_quantized_tensor_inplace(src_buf.data(), num_elts, quant_type);
+        }
+        std::copy(src_buf.begin(), src_buf.end(), preprocessed_quantized_weight + expert * num_bytes);
     }
-    std::copy(src_buf.begin(), src_buf.end(), preprocessed_quantized_weight);
 }
 
 /*
@@ -647,9 +727,9 @@ Outputs
   */
 
 template <typename ComputeType, typename WeightType>
-void symmetric_quantize(int8_t* processed_quantized_weight, int8_t* unprocessed_quantized_weight,
+void symmetric_quantize_groupwise(int8_t* processed_quantized_weight, int8_t* unprocessed_quantized_weight,
     ComputeType* scale_ptr, WeightType const* input_weight_ptr, std::vector<size_t> const& shape, QuantType quant_type,
-    bool force_interleave)
+    size_t group_size, bool force_interleave)
 {
 
     TLLM_CHECK_WITH_INFO(processed_quantized_weight, "Processed quantized tensor is NULL");
@@ -661,101 +741,145 @@ void symmetric_quantize(int8_t* processed_quantized_weight, int8_t* unprocessed_
     const size_t num_rows = shape.size() == 2 ? shape[0] : shape[1];
     const size_t num_cols = shape.size() == 2 ? shape[1] : shape[2];
 
+    TLLM_CHECK_WITH_INFO(group_size > 0 && num_rows % group_size == 0,
+        "Number of rows %zu must be a multiple of the group size %zu", num_rows, group_size);
+    const size_t num_groups = num_rows / group_size;
+
     int const bits_in_type = get_weight_quant_bits(quant_type);
     int const bytes_per_out_col = num_cols * bits_in_type / 8;
 
     int const bits_per_weigtht_element = get_weight_quant_bits(quant_type);
 
+    // Without a caller buffer for the unprocessed weights, one expert worth is enough since every expert is
+    // preprocessed right after it is quantized.
     std::vector<int8_t> weight_buf;
     if (unprocessed_quantized_weight == nullptr)
     {
-        weight_buf.resize(num_experts * num_rows * num_cols);
-        unprocessed_quantized_weight = weight_buf.data();
+        weight_buf.resize(num_rows * bytes_per_out_col);
     }
 
-    int const input_mat_size = num_rows * num_cols;
-    int const quantized_mat_size = num_rows * bytes_per_out_col;
+    const size_t input_mat_size = num_rows * num_cols;
+    const size_t quantized_mat_size = num_rows * bytes_per_out_col;
     float const quant_range_scale = 1.f / float(1 << (bits_in_type - 1));
+    std::vector<size_t> const matrix_shape{num_rows, num_cols};
 
-    std::vector<float> per_col_max(num_cols);
-
-    for (int expert = 0; expert < num_experts; ++expert)
+    for (size_t expert = 0; expert < num_experts; ++expert)
     {
         WeightType const* current_weight = input_weight_ptr + expert * input_mat_size;
-        int8_t* current_quantized_weight = unprocessed_quantized_weight + expert * quantized_mat_size;
-
-        // First we find the per column max for this expert weight.
-        for (int jj = 0; jj < num_cols; ++jj)
-        {
-            per_col_max[jj] = 0.f;
-        }
+        int8_t* current_quantized_weight = unprocessed_quantized_weight != nullptr
+            ? unprocessed_quantized_weight + expert * quantized_mat_size
+            : weight_buf.data();
 
-        for (int ii = 0; ii < num_rows; ++ii)
-        {
-            WeightType const* current_weight_row = current_weight + ii * num_cols;
-            for (int jj = 0; jj < num_cols; ++jj)
+        // The groups are independent, each has its own scales and rows.
+        parallel_for(num_groups, 1,
+            [&](size_t begin, size_t end)
             {
-                per_col_max[jj] = std::max(per_col_max[jj], std::abs(float(current_weight_row[jj])));
-            }
-        }
+                std::vector<float> per_col_max(num_cols);
+                for (size_t group = begin; group < end; ++group)
+                {
+                    int const group_begin = group * group_size;
+                    int const group_end = group_begin + group_size;
 
-        // Then, we construct the scales
-        ComputeType* current_scales = scale_ptr + expert * num_cols;
-        for (int jj = 0; jj < num_cols; ++jj)
-        {
-            per_col_max[jj] *= quant_range_scale;
-            current_scales[jj] = ComputeType(per_col_max[jj]);
-        }
+                    // First we find the per column max for the rows of this group.
+                    for (int jj = 0; jj < num_cols; ++jj)
+                    {
+                        per_col_max[jj] = 0.f;
+                    }
 
-        // Finally, construct the weights.
-        for (int ii = 0; ii < num_rows; ++ii)
-        {
-            int8_t* current_quantized_weight_row = current_quantized_weight + ii * bytes_per_out_col;
-            WeightType const* current_weight_row = current_weight + ii * num_cols;
-            for (int jj = 0; jj < bytes_per_out_col; ++jj)
-            {
+                    for (int ii = group_begin; ii < group_end; ++ii)
+                    {
+                        WeightType const* current_weight_row = current_weight + ii * num_cols;
+                        for (int jj = 0; jj < num_cols; ++jj)
+                        {
+                            per_col_max[jj] = std::max(per_col_max[jj], std::abs(float(current_weight_row[jj])));
+                        }
+                    }
 
-                if (bits_per_weigtht_element == 8)
-                {
-                    float const col_scale = per_col_max[jj];
-                    float const weight_elt = float(current_weight_row[jj]);
-                    float const scaled_weight = (col_scale != 0.0f) ? round(weight_elt / col_scale) : 0.0f;
-                    const int8_t clipped_weight = int8_t(std::max(-128.f, std::min(127.f, scaled_weight)));
-                    current_quantized_weight_row[jj] = clipped_weight;
-                }
-                else if (bits_per_weigtht_element == 4)
-                {
+                    // Then, we construct the scales
+                    ComputeType* current_scales = scale_ptr + (expert * num_groups + group) * num_cols;
+                    for (int jj = 0; jj < num_cols; ++jj)
+                    {
+                        per_col_max[jj] *= quant_range_scale;
+                        current_scales[jj] = ComputeType(per_col_max[jj]);
+                    }
 
-                    // We will pack two int4 elements per iteration of the inner loop.
-                    int8_t packed_int4s = 0;
-                    for (int packed_idx = 0; packed_idx < 2; ++packed_idx)
+                    // Finally, construct the weights.
+                    for (int ii = group_begin; ii < group_end; ++ii)
                     {
-                        int const input_idx = 2 * jj + packed_idx;
-                        if (input_idx < num_cols)
+                        int8_t* current_quantized_weight_row = current_quantized_weight + ii * bytes_per_out_col;
+                        WeightType const* current_weight_row = current_weight + ii * num_cols;
+                        for (int jj = 0; jj < bytes_per_out_col; ++jj)
                         {
-                            float const col_scale = per_col_max[input_idx];
-                            float const weight_elt = float(current_weight_row[input_idx]);
-                            float const scaled_weight = (col_scale != 0.0f) ? round(weight_elt / col_scale) : 0.0f;
-                            int int_weight = int(scaled_weight);
-                            const int8_t clipped_weight = std::max(-8, std::min(7, int_weight));
-
-                            // Kill the sign extension bits (hence 0x0F mask) then shift to upper bits
-                            // if packing the second int4 and or the bits into the final result.
-                            packed_int4s |= ((clipped_weight & 0x0F) << (4 * packed_idx));
+
+                            if (bits_per_weigtht_element == 8)
+                            {
+                                float const col_scale = per_col_max[jj];
+                                float const weight_elt = float(current_weight_row[jj]);
+                                float const scaled_weight = (col_scale != 0.0f) ? round(weight_elt / col_scale) : 0.0f;
+                                const int8_t clipped_weight = int8_t(std::max(-128.f, std::min(127.f, scaled_weight)));
+                                current_quantized_weight_row[jj] = clipped_weight;
+                            }
+                            else if (bits_per_weigtht_element == 4)
+                            {
+
+                                // We will pack two int4 elements per iteration of the inner loop.
+                                int8_t packed_int4s = 0;
+                                for (int packed_idx = 0; packed_idx < 2; ++packed_idx)
+                                {
+                                    int const input_idx = 2 * jj + packed_idx;
+                                    if (input_idx < num_cols)
+                                    {
+                                        float const col_scale = per_col_max[input_idx];
+                                        float const weight_elt = float(current_weight_row[input_idx]);
+                                        float const scaled_weight
+                                            = (col_scale != 0.0f) ? round(weight_elt / col_scale) : 0.0f;
+                                        int int_weight = int(scaled_weight);
+                                        const int8_t clipped_weight = std::max(-8, std::min(7, int_weight));
+
+                                        // Kill the sign extension bits (hence 0x0F mask) then shift to upper bits
+                                        // if packing the second int4 and or the bits into the final result.
+                                        packed_int4s |= ((clipped_weight & 0x0F) << (4 * packed_idx));
+                                    }
+                                }
+                                current_quantized_weight_row[jj] = packed_int4s;
+                            }
+                            else
+                            {
+                                TLLM_CHECK_WITH_INFO(false, "Unsupported quantization type");
+                            }
                         }
                     }
-                    current_quantized_weight_row[jj] = packed_int4s;
-                }
-                else
-                {
-                    TLLM_CHECK_WITH_INFO(false, "Unsupported quantization type");
                 }
-            }
-        }
+            });
+
+        preprocess_weights_for_mixed_gemm(processed_quantized_weight + expert * quantized_mat_size,
+            current_quantized_weight, matrix_shape, quant_type, force_interleave);
     }
+}
+
+template void symmetric_quantize_groupwise<half, float>(
+    int8_t*, int8_t*, half*, float const*, std::vector<size_t> const&, QuantType, size_t, bool);
 
-    preprocess_weights_for_mixed_gemm(
-        processed_quantized_weight, unprocessed_quantized_weight, shape, quant_type, force_interleave);
+template void symmetric_quantize_groupwise<half, half>(
+    int8_t*, int8_t*, half*, half const*, std::vector<size_t> const&, QuantType, size_t, bool);
+
+#ifdef ENABLE_BF16
+template void symmetric_quantize_groupwise<__nv_bfloat16, __nv_bfloat16>(
+    int8_t*, int8_t*, __nv_bfloat16*, __nv_bfloat16 const*, std::vector<size_t> const&, QuantType, size_t, bool);
+
+template void symmetric_quantize_groupwise<__nv_bfloat16, float>(
+    int8_t*, int8_t*, __nv_bfloat16*, float const*, std::vector<size_t> const&, QuantType, size_t, bool);
+#endif
+
+template <typename ComputeType, typename WeightType>
+void symmetric_quantize(int8_t* processed_quantized_weight, int8_t* unprocessed_quantized_weight,
+    ComputeType* scale_ptr, WeightType const* input_weight_ptr, std::vector<size_t> const& shape, QuantType quant_type,
+    bool force_interleave)
+{
+    TLLM_CHECK_WITH_INFO(shape.size() == 2 || shape.size() == 3, "Shape must be 2-D or 3-D");
+    const size_t num_rows = shape.size() == 2 ? shape[0] : shape[1];
+    symmetric_quantize_groupwise(processed_quantized_weight, unprocessed_quantized_weight, scale_ptr, input_weight_ptr,
+        shape, quant_type, num_rows, force_interleave);
 }
 
 template void symmetric_quantize<half, float>(
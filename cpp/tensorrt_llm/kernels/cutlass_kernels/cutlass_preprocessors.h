@@ -71,6 +71,13 @@ void symmetric_quantize(int8_t* processed_quantized_weight, int8_t* unprocessed_
     ComputeType* scale_ptr, WeightType const* input_weight_ptr, std::vector<size_t> const& shape, QuantType quant_type,
     bool force_interleave);
 
+// Group wise variant for the fine grained weight only kernels, every group_size rows of a column share a scale so the
+// scales are [num_experts, num_rows / group_size, num_cols].
+template <typename ComputeType, typename WeightType>
+void symmetric_quantize_groupwise(int8_t* processed_quantized_weight, int8_t* unprocessed_quantized_weight,
+    ComputeType* scale_ptr, WeightType const* input_weight_ptr, std::vector<size_t> const& shape, QuantType quant_type,
+    size_t group_size, bool force_interleave);
+
 } // namespace cutlass_kernels
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -178,16 +178,19 @@ public:
     static constexpr bool use_fp8 = false;
 #endif
 
+    // Weight only quantized experts take [num_experts, gemm_k / group_size, gemm_n] weight scales, and weight zeros of
+    // the same shape for asymmetric quantization. A group_size of 0 or gemm_k is one scale per output column, finer
+    // groups of 64 or 128 rows are supported from sm80.
     void moeGemmBiasAct(T const* A, WeightType const* B, ScaleBiasType const* weight_scales,
-        ScaleBiasType const* biases, bool bias_is_broadcast, void* C, int64_t const* total_tokens_including_expert,
-        HopperGroupedGemmInput layout_info, int64_t total_rows, int64_t gemm_n, int64_t gemm_k, int num_experts,
-        ActivationType activation_type, bool use_fused_moe, float const** alpha_scale_ptr_array, cudaStream_t stream,
-        cutlass_extensions::CutlassGemmConfig chosen_conf);
+        ScaleBiasType const* weight_zeros, int64_t group_size, ScaleBiasType const* biases, bool bias_is_broadcast,
+        void* C, int64_t const* total_tokens_including_expert, HopperGroupedGemmInput layout_info, int64_t total_rows,
+        int64_t gemm_n, int64_t gemm_k, int num_experts, ActivationType activation_type, bool use_fused_moe,
+        float const** alpha_scale_ptr_array, cudaStream_t stream, cutlass_extensions::CutlassGemmConfig chosen_conf);
 
-    void moeGemm(T const* A, WeightType const* B, ScaleBiasType const* weight_scales, void* C,
-        int64_t const* total_tokens_including_expert, HopperGroupedGemmInput layout_info, int64_t total_rows,
-        int64_t gemm_n, int64_t gemm_k, int num_experts, bool use_fused_moe, float const** alpha_scale_ptr_array,
-        cudaStream_t stream, cutlass_extensions::CutlassGemmConfig chosen_conf);
+    void moeGemm(T const* A, WeightType const* B, ScaleBiasType const* weight_scales, ScaleBiasType const* weight_zeros,
+        int64_t group_size, void* C, int64_t const* total_tokens_including_expert, HopperGroupedGemmInput layout_info,
+        int64_t total_rows, int64_t gemm_n, int64_t gemm_k, int num_experts, bool use_fused_moe,
+        float const** alpha_scale_ptr_array, cudaStream_t stream, cutlass_extensions::CutlassGemmConfig chosen_conf);
 
     std::vector<cutlass_extensions::CutlassGemmConfig> getConfigs() const;
     static std::vector<cutlass_extensions::CutlassGemmConfig> getConfigs(int sm);
@@ -207,17 +210,17 @@ public:
 private:
     template <typename EpilogueTag>
     void dispatchToArch(T const* A, WeightType const* B, ScaleBiasType const* weight_scales,
-        ScaleBiasType const* biases, bool bias_is_broadcast, void* C, int64_t const* total_tokens_including_expert,
-        HopperGroupedGemmInput layout_info, int64_t total_rows, int64_t gemm_n, int64_t gemm_k, int num_experts,
-        cutlass_extensions::CutlassGemmConfig gemm_config, bool use_fused_moe, float const** alpha_scale_ptr_array,
-        cudaStream_t stream, int* occupancy = nullptr);
+        ScaleBiasType const* weight_zeros, int64_t group_size, ScaleBiasType const* biases, bool bias_is_broadcast,
+        void* C, int64_t const* total_tokens_including_expert, HopperGroupedGemmInput layout_info, int64_t total_rows,
+        int64_t gemm_n, int64_t gemm_k, int num_experts, cutlass_extensions::CutlassGemmConfig gemm_config,
+        bool use_fused_moe, float const** alpha_scale_ptr_array, cudaStream_t stream, int* occupancy = nullptr);
 
     template <typename EpilogueTag>
-    void runGemm(T const* A, WeightType const* B, ScaleBiasType const* weight_scales, ScaleBiasType const* biases,
-        bool bias_is_broadcast, void* C, int64_t const* total_tokens_including_expert,
-        HopperGroupedGemmInput layout_info, int64_t total_rows, int64_t gemm_n, int64_t gemm_k, int num_experts,
-        bool use_fused_moe, float const** alpha_scale_ptr_array, cudaStream_t stream,
-        cutlass_extensions::CutlassGemmConfig chosen_conf);
+    void runGemm(T const* A, WeightType const* B, ScaleBiasType const* weight_scales, ScaleBiasType const* weight_zeros,
+        int64_t group_size, ScaleBiasType const* biases, bool bias_is_broadcast, void* C,
+        int64_t const* total_tokens_including_expert, HopperGroupedGemmInput layout_info, int64_t total_rows,
+        int64_t gemm_n, int64_t gemm_k, int num_experts, bool use_fused_moe, float const** alpha_scale_ptr_array,
+        cudaStream_t stream, cutlass_extensions::CutlassGemmConfig chosen_conf);
 
 private:
     int sm_{};
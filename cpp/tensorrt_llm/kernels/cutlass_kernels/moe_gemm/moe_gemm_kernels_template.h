@@ -70,13 +70,99 @@ namespace kernels::cutlass_kernels
 {
 
 // ============================= Variable batched Gemm things ===========================
+template <typename T, typename WeightType, typename GemmOutputType, typename arch, typename EpilogueTag,
+    typename ThreadblockShape, typename WarpShape, int Stages, cutlass::WeightOnlyQuantOp QuantOp>
+void genericMoeGroupedGemmLauncher(T const* A, WeightType const* B, GemmOutputType const* weight_scales,
+    GemmOutputType const* weight_zeros, int64_t group_size, GemmOutputType const* biases, bool bias_is_broadcast,
+    GemmOutputType* C, int64_t const* total_tokens_including_expert, int64_t gemm_n, int64_t gemm_k, int num_experts,
+    int const multi_processor_count, float const** alpha_scale_ptr_array, cudaStream_t stream, int* kernel_occupancy)
+{
+    // The cutlass type for the input elements. This is needed to convert to cutlass::half_t if necessary.
+    using ElementType = typename TllmToCutlassTypeAdapter<T>::type;
+    using CutlassGemmOutputType = typename TllmToCutlassTypeAdapter<GemmOutputType>::type;
+    using CutlassWeightType = typename TllmToCutlassTypeAdapter<WeightType>::type;
+
+    // We need separate config for each architecture since we will target different tensorcore instructions. For
+    // float, we do not target TCs.
+    using MixedGemmArchTraits = cutlass::gemm::kernel::MixedGemmArchTraits<ElementType, CutlassWeightType, arch>;
+    using ElementAccumulator = typename MixedGemmArchTraits::AccType;
+    using TaggedOperator =
+        typename cutlass::arch::TagOperator<typename MixedGemmArchTraits::Operator, QuantOp>::TaggedOperator;
+
+    using EpilogueOp = typename tensorrt_llm::cutlass_extensions::Epilogue<CutlassGemmOutputType,
+        MixedGemmArchTraits::ElementsPerAccessC, ElementAccumulator, EpilogueTag>::Op;
+
+    typename EpilogueOp::Params epilogue_op(
+        ElementAccumulator(1.f), biases ? ElementAccumulator(1.f) : ElementAccumulator(0.f));
+
+#if defined(ENABLE_FP8)
+    if constexpr ((std::is_same_v<T, __nv_fp8_e4m3>
+                      || std::is_same_v<T, __nv_fp8_e5m2>) &&std::is_same_v<EpilogueTag,
+                      cutlass_extensions::EpilogueOpDefault>)
+    {
+        TLLM_CHECK_WITH_INFO(weight_scales == nullptr && biases == nullptr && alpha_scale_ptr_array,
+            "weight_scales and biases should be nullptr and alpha_scale_ptr_array shouldn't be nullptr for FP8 "
+            "Ada");
+        epilogue_op.alpha_ptr_array = alpha_scale_ptr_array;
+    }
+#endif
+
+    // Finally, set up the kernel.
+    using GemmKernel_ = typename cutlass::gemm::kernel::DefaultGemmGrouped<ElementType, cutlass::layout::RowMajor,
+        cutlass::ComplexTransform::kNone, MixedGemmArchTraits::ElementsPerAccessA, CutlassWeightType,
+        typename MixedGemmArchTraits::LayoutB, cutlass::ComplexTransform::kNone,
+        MixedGemmArchTraits::ElementsPerAccessB, CutlassGemmOutputType, cutlass::layout::RowMajor, ElementAccumulator,
+        typename MixedGemmArchTraits::OperatorClass, arch, ThreadblockShape, WarpShape,
+        typename MixedGemmArchTraits::InstructionShape, EpilogueOp,
+        cutlass::gemm::threadblock::GemmBatchedIdentityThreadblockSwizzle, Stages,
+        cutlass::gemm::kernel::GroupScheduleMode::kDeviceOnly, TaggedOperator>::GemmKernel;
+
+    using GemmKernel = cutlass::gemm::kernel::MoeFCGemm<typename GemmKernel_::Mma, typename GemmKernel_::Epilogue,
+        typename GemmKernel_::ThreadblockSwizzle,
+        arch, // Ensure top level arch is used for dispatch
+        GemmKernel_::kGroupScheduleMode>;
+
+    using GemmGrouped = cutlass::gemm::device::GemmGrouped<GemmKernel>;
+
+    if (kernel_occupancy != nullptr)
+    {
+        *kernel_occupancy = tensorrt_llm::cutlass_extensions::compute_occupancy_for_kernel<GemmKernel>();
+        return;
+    }
+    int occupancy = std::min(2, GemmGrouped::maximum_active_blocks());
+    TLLM_CHECK_WITH_INFO(occupancy > 0, "GPU lacks the shared memory resources to run GroupedGEMM kernel");
+    int const threadblock_count = multi_processor_count * occupancy;
+
+    typename GemmGrouped::Arguments args(num_experts, threadblock_count, group_size, epilogue_op,
+        reinterpret_cast<ElementType const*>(A), reinterpret_cast<CutlassWeightType const*>(B),
+        reinterpret_cast<CutlassGemmOutputType const*>(weight_scales),
+        reinterpret_cast<CutlassGemmOutputType const*>(weight_zeros),
+        reinterpret_cast<CutlassGemmOutputType const*>(biases), bias_is_broadcast,
+        reinterpret_cast<CutlassGemmOutputType*>(C), total_tokens_including_expert, gemm_n, gemm_k);
+
+    GemmGrouped gemm;
+
+    auto can_implement = gemm.can_implement(args);
+    TLLM_CHECK_WITH_INFO(can_implement == cutlass::Status::kSuccess,
+        "MoE FC kernel will fail for params. Error: " + std::string(cutlassGetStatusString(can_implement)));
+
+    auto init_status = gemm.initialize(args);
+    TLLM_CHECK_WITH_INFO(init_status == cutlass::Status::kSuccess,
+        "Failed to initialize cutlass grouped gemm. Error: " + std::string(cutlassGetStatusString(init_status)));
+
+    auto run_status = gemm.run(stream);
+    TLLM_CHECK_WITH_INFO(run_status == cutlass::Status::kSuccess,
+        "Failed to run cutlass grouped gemm. Error: " + std::string(cutlassGetStatusString(run_status)));
+}
+
+// group_size is the number of rows of K sharing a weight scale (and zero), 0 or gemm_k for one scale per column.
 template <typename T, typename WeightType, typename GemmOutputType, typename arch, typename EpilogueTag,
     typename ThreadblockShape, typename WarpShape, int Stages>
 void genericMoeGemmKernelLauncher(T const* A, WeightType const* B, GemmOutputType const* weight_scales,
-    GemmOutputType const* biases, bool bias_is_broadcast, GemmOutputType* C,
-    int64_t const* total_tokens_including_expert, int64_t num_rows, int64_t gemm_n, int64_t gemm_k, int num_experts,
-    cutlass_extensions::CutlassGemmConfig gemm_config, int const multi_processor_count, bool use_fused_moe,
-    float const** alpha_scale_ptr_array, cudaStream_t stream, int* kernel_occupancy = nullptr)
+    GemmOutputType const* weight_zeros, int64_t group_size, GemmOutputType const* biases, bool bias_is_broadcast,
+    GemmOutputType* C, int64_t const* total_tokens_including_expert, int64_t num_rows, int64_t gemm_n, int64_t gemm_k,
+    int num_experts, cutlass_extensions::CutlassGemmConfig gemm_config, int const multi_processor_count,
+    bool use_fused_moe, float const** alpha_scale_ptr_array, cudaStream_t stream, int* kernel_occupancy = nullptr)
 {
 #if defined(ENABLE_FP8)
     static_assert(cutlass::platform::is_same<T, __nv_bfloat16>::value || cutlass::platform::is_same<T, half>::value
@@ -100,81 +186,48 @@ void genericMoeGemmKernelLauncher(T const* A, WeightType const* B, GemmOutputTyp
     static_assert(!cutlass::platform::is_same<arch, cutlass::arch::Sm90>::value,
         "Sm90 architecture should use specialised kernels");
 
-    // The cutlass type for the input elements. This is needed to convert to cutlass::half_t if necessary.
     using ElementType = typename TllmToCutlassTypeAdapter<T>::type;
-    using CutlassGemmOutputType = typename TllmToCutlassTypeAdapter<GemmOutputType>::type;
     using CutlassWeightType = typename TllmToCutlassTypeAdapter<WeightType>::type;
     if (!use_fused_moe)
     {
-        // We need separate config for each architecture since we will target different tensorcore instructions. For
-        // float, we do not target TCs.
-        using MixedGemmArchTraits = cutlass::gemm::kernel::MixedGemmArchTraits<ElementType, CutlassWeightType, arch>;
-        using ElementAccumulator = typename MixedGemmArchTraits::AccType;
-
-        using EpilogueOp = typename tensorrt_llm::cutlass_extensions::Epilogue<CutlassGemmOutputType,
-            MixedGemmArchTraits::ElementsPerAccessC, ElementAccumulator, EpilogueTag>::Op;
-
-        typename EpilogueOp::Params epilogue_op(
-            ElementAccumulator(1.f), biases ? ElementAccumulator(1.f) : ElementAccumulator(0.f));
-
-#if defined(ENABLE_FP8)
-        if constexpr ((std::is_same_v<T, __nv_fp8_e4m3>
-                          || std::is_same_v<T, __nv_fp8_e5m2>) &&std::is_same_v<EpilogueTag,
-                          cutlass_extensions::EpilogueOpDefault>)
+        using cutlass::WeightOnlyQuantOp;
+        int64_t const scale_group_size = group_size > 0 ? group_size : gemm_k;
+        bool const is_finegrained = weight_zeros != nullptr || scale_group_size != gemm_k;
+        auto launch = [&](auto quant_op)
+        {
+            genericMoeGroupedGemmLauncher<T, WeightType, GemmOutputType, arch, EpilogueTag, ThreadblockShape,
+                WarpShape, Stages, decltype(quant_op)::value>(A, B, weight_scales, weight_zeros, scale_group_size,
+                biases, bias_is_broadcast, C, total_tokens_including_expert, gemm_n, gemm_k, num_experts,
+                multi_processor_count, alpha_scale_ptr_array, stream, kernel_occupancy);
+        };
+        using PerColumn = std::integral_constant<WeightOnlyQuantOp, WeightOnlyQuantOp::PER_COLUMN_SCALE_ONLY>;
+
+        if constexpr (!std::is_same_v<T, WeightType> && arch::kMinComputeCapability >= 80)
         {
-            TLLM_CHECK_WITH_INFO(weight_scales == nullptr && biases == nullptr && alpha_scale_ptr_array,
-                "weight_scales and biases should be nullptr and alpha_scale_ptr_array shouldn't be nullptr for FP8 "
-                "Ada");
-            epilogue_op.alpha_ptr_array = alpha_scale_ptr_array;
+            if (!is_finegrained)
+            {
+                launch(PerColumn{});
+                return;
+            }
+            TLLM_CHECK_WITH_INFO(scale_group_size == 64 || scale_group_size == 128,
+                "Only group size 64 and 128 supported for fine grained MoE weights, got %ld", scale_group_size);
+            TLLM_CHECK_WITH_INFO(gemm_k % scale_group_size == 0, "gemm_k %ld is not a multiple of group size %ld",
+                gemm_k, scale_group_size);
+            if (weight_zeros != nullptr)
+            {
+                launch(std::integral_constant<WeightOnlyQuantOp, WeightOnlyQuantOp::FINEGRAINED_SCALE_AND_ZEROS>{});
+            }
+            else
+            {
+                launch(std::integral_constant<WeightOnlyQuantOp, WeightOnlyQuantOp::FINEGRAINED_SCALE_ONLY>{});
+            }
         }
-#endif
-
-        // Finally, set up the kernel.
-        using GemmKernel_ = typename cutlass::gemm::kernel::DefaultGemmGrouped<ElementType, cutlass::layout::RowMajor,
-            cutlass::ComplexTransform::kNone, MixedGemmArchTraits::ElementsPerAccessA, CutlassWeightType,
-            typename MixedGemmArchTraits::LayoutB, cutlass::ComplexTransform::kNone,
-            MixedGemmArchTraits::ElementsPerAccessB, CutlassGemmOutputType, cutlass::layout::RowMajor,
-            ElementAccumulator, typename MixedGemmArchTraits::OperatorClass, arch, ThreadblockShape, WarpShape,
-            typename MixedGemmArchTraits::InstructionShape, EpilogueOp,
-            cutlass::gemm::threadblock::GemmBatchedIdentityThreadblockSwizzle, Stages,
-            cutlass::gemm::kernel::GroupScheduleMode::kDeviceOnly, typename MixedGemmArchTraits::Operator>::GemmKernel;
-
-        using GemmKernel = cutlass::gemm::kernel::MoeFCGemm<typename GemmKernel_::Mma, typename GemmKernel_::Epilogue,
-            typename GemmKernel_::ThreadblockSwizzle,
-            arch, // Ensure top level arch is used for dispatch
-            GemmKernel_::kGroupScheduleMode>;
-
-        using GemmGrouped = cutlass::gemm::device::GemmGrouped<GemmKernel>;
-
-        if (kernel_occupancy != nullptr)
+        else
         {
-            *kernel_occupancy = tensorrt_llm::cutlass_extensions::compute_occupancy_for_kernel<GemmKernel>();
-            return;
+            TLLM_CHECK_WITH_INFO(!is_finegrained,
+                "Fine grained weight scales are only supported for weight only quantized experts on sm80+");
+            launch(PerColumn{});
         }
-        int occupancy = std::min(2, GemmGrouped::maximum_active_blocks());
-        TLLM_CHECK_WITH_INFO(occupancy > 0, "GPU lacks the shared memory resources to run GroupedGEMM kernel");
-        int const threadblock_count = multi_processor_count * occupancy;
-
-        int const group_size = gemm_k;
-        typename GemmGrouped::Arguments args(num_experts, threadblock_count, group_size, epilogue_op,
-            reinterpret_cast<ElementType const*>(A), reinterpret_cast<CutlassWeightType const*>(B),
-            reinterpret_cast<CutlassGemmOutputType const*>(weight_scales),
-            reinterpret_cast<CutlassGemmOutputType const*>(biases), bias_is_broadcast,
-            reinterpret_cast<CutlassGemmOutputType*>(C), total_tokens_including_expert, gemm_n, gemm_k);
-
-        GemmGrouped gemm;
-
-        auto can_implement = gemm.can_implement(args);
-        TLLM_CHECK_WITH_INFO(can_implement == cutlass::Status::kSuccess,
-            "MoE FC kernel will fail for params. Error: " + std::string(cutlassGetStatusString(can_implement)));
-
-        auto init_status = gemm.initialize(args);
-        TLLM_CHECK_WITH_INFO(init_status == cutlass::Status::kSuccess,
-            "Failed to initialize cutlass grouped gemm. Error: " + std::string(cutlassGetStatusString(init_status)));
-
-        auto run_status = gemm.run(stream);
-        TLLM_CHECK_WITH_INFO(run_status == cutlass::Status::kSuccess,
-            "Failed to run cutlass grouped gemm. Error: " + std::string(cutlassGetStatusString(run_status)));
     }
     else if constexpr (sizeof(ElementType) == 2 && sizeof(CutlassWeightType) == 2
         && (std::is_same_v<EpilogueTag, cutlass_extensions::EpilogueOpDefaultSilu>
@@ -194,11 +247,11 @@ void genericMoeGemmKernelLauncher(T const* A, WeightType const* B, GemmOutputTyp
 
 template <typename T, typename WeightType, typename GemmOutputType, typename Arch, typename EpilogueTag,
     typename ThreadblockShape, typename WarpShape, int Stages>
-static void dispatch(T const* A, WeightType const* B, GemmOutputType const* weight_scales, GemmOutputType const* biases,
-    bool bias_is_broadcast, GemmOutputType* C, int64_t const* total_tokens_including_expert, int64_t num_rows,
-    int64_t gemm_n, int64_t gemm_k, int num_experts, cutlass_extensions::CutlassGemmConfig gemm_config,
-    int multi_processor_count, bool use_fused_moe, float const** alpha_scale_ptr_array, cudaStream_t stream,
-    int* occupancy = nullptr)
+static void dispatch(T const* A, WeightType const* B, GemmOutputType const* weight_scales,
+    GemmOutputType const* weight_zeros, int64_t group_size, GemmOutputType const* biases, bool bias_is_broadcast,
+    GemmOutputType* C, int64_t const* total_tokens_including_expert, int64_t num_rows, int64_t gemm_n, int64_t gemm_k,
+    int num_experts, cutlass_extensions::CutlassGemmConfig gemm_config, int multi_processor_count, bool use_fused_moe,
+    float const** alpha_scale_ptr_array, cudaStream_t stream, int* occupancy = nullptr)
 {
 
     static_assert(!std::is_same_v<Arch, cutlass::arch::Sm90>, "Use TMA specialised functions for arch SM90");
@@ -212,9 +265,9 @@ static void dispatch(T const* A, WeightType const* B, GemmOutputType const* weig
         && (!isFp8 || std::is_same_v<Arch, cutlass::arch::Sm89>) )
     {
         kernels::cutlass_kernels::genericMoeGemmKernelLauncher<T, WeightType, GemmOutputType, Arch, EpilogueTag,
-            ThreadblockShape, WarpShape, Stages>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, num_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            ThreadblockShape, WarpShape, Stages>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, num_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
     }
     else
     {
@@ -226,27 +279,30 @@ static void dispatch(T const* A, WeightType const* B, GemmOutputType const* weig
 template <typename T, typename WeightType, typename GemmOutputType, typename arch, typename EpilogueTag,
     typename ThreadblockShape, typename WarpShape>
 void dispatchGemmConfig(T const* A, WeightType const* B, GemmOutputType const* weight_scales,
-    GemmOutputType const* biases, bool bias_is_broadcast, GemmOutputType* C,
-    int64_t const* total_tokens_including_expert, int64_t num_rows, int64_t gemm_n, int64_t gemm_k, int num_experts,
-    cutlass_extensions::CutlassGemmConfig gemm_config, int multi_processor_count, bool use_fused_moe,
+    GemmOutputType const* weight_zeros, int64_t group_size, GemmOutputType const* biases, bool bias_is_broadcast,
+    GemmOutputType* C, int64_t const* total_tokens_including_expert, int64_t num_rows, int64_t gemm_n, int64_t gemm_k,
+    int num_experts, cutlass_extensions::CutlassGemmConfig gemm_config, int multi_processor_count, bool use_fused_moe,
     float const** alpha_scale_ptr_array, cudaStream_t stream, int* occupancy = nullptr)
 {
     switch (gemm_config.stages)
     {
     case 2:
         dispatch<T, WeightType, GemmOutputType, arch, EpilogueTag, ThreadblockShape, WarpShape, 2>(A, B, weight_scales,
-            biases, bias_is_broadcast, C, total_tokens_including_expert, num_rows, gemm_n, gemm_k, num_experts,
-            gemm_config, multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            weight_zeros, group_size, biases, bias_is_broadcast, C, total_tokens_including_expert, num_rows, gemm_n,
+            gemm_k, num_experts, gemm_config, multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream,
+            occupancy);
         break;
     case 3:
         dispatch<T, WeightType, GemmOutputType, arch, EpilogueTag, ThreadblockShape, WarpShape, 3>(A, B, weight_scales,
-            biases, bias_is_broadcast, C, total_tokens_including_expert, num_rows, gemm_n, gemm_k, num_experts,
-            gemm_config, multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            weight_zeros, group_size, biases, bias_is_broadcast, C, total_tokens_including_expert, num_rows, gemm_n,
+            gemm_k, num_experts, gemm_config, multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream,
+            occupancy);
         break;
     case 4:
         dispatch<T, WeightType, GemmOutputType, arch, EpilogueTag, ThreadblockShape, WarpShape, 4>(A, B, weight_scales,
-            biases, bias_is_broadcast, C, total_tokens_including_expert, num_rows, gemm_n, gemm_k, num_experts,
-            gemm_config, multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            weight_zeros, group_size, biases, bias_is_broadcast, C, total_tokens_including_expert, num_rows, gemm_n,
+            gemm_k, num_experts, gemm_config, multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream,
+            occupancy);
         break;
     default: TLLM_THROW("dispatchGemmConfig does not support stages %d", gemm_config.stages); break;
     }
@@ -261,9 +317,9 @@ template <typename T, typename WeightType, typename GemmOutputType, typename arc
 #endif
         && std::is_same<T, WeightType>::value>::type* = nullptr>
 void dispatchMoeGemmToCutlass(T const* A, WeightType const* B, GemmOutputType const* weight_scales,
-    GemmOutputType const* biases, bool bias_is_broadcast, GemmOutputType* C,
-    int64_t const* total_tokens_including_expert, int64_t total_rows, int64_t gemm_n, int64_t gemm_k, int num_experts,
-    cutlass_extensions::CutlassGemmConfig gemm_config, int multi_processor_count, bool use_fused_moe,
+    GemmOutputType const* weight_zeros, int64_t group_size, GemmOutputType const* biases, bool bias_is_broadcast,
+    GemmOutputType* C, int64_t const* total_tokens_including_expert, int64_t total_rows, int64_t gemm_n, int64_t gemm_k,
+    int num_experts, cutlass_extensions::CutlassGemmConfig gemm_config, int multi_processor_count, bool use_fused_moe,
     float const** alpha_scale_ptr_array, cudaStream_t stream, int* occupancy = nullptr)
 {
     switch (gemm_config.tile_config)
@@ -273,9 +329,9 @@ void dispatchMoeGemmToCutlass(T const* A, WeightType const* B, GemmOutputType co
         if constexpr (arch::kMinComputeCapability >= 75)
         {
             dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<16, 128, 64>,
-                cutlass::gemm::GemmShape<16, 32, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-                total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
-                multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+                cutlass::gemm::GemmShape<16, 32, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+                bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts,
+                gemm_config, multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         }
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape16x256x64_WarpShape16x64x64:
@@ -283,28 +339,28 @@ void dispatchMoeGemmToCutlass(T const* A, WeightType const* B, GemmOutputType co
         if constexpr (arch::kMinComputeCapability >= 75)
         {
             dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<16, 256, 64>,
-                cutlass::gemm::GemmShape<16, 64, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-                total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
-                multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+                cutlass::gemm::GemmShape<16, 64, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+                bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts,
+                gemm_config, multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         }
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape32x128x64_WarpShape32x32x64:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<32, 128, 64>,
-            cutlass::gemm::GemmShape<32, 32, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<32, 32, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape64x128x64_WarpShape32x64x64:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<64, 128, 64>,
-            cutlass::gemm::GemmShape<32, 64, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<32, 64, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape128x128x64_WarpShape64x32x64:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<128, 128, 64>,
-            cutlass::gemm::GemmShape<64, 32, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<64, 32, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::Undefined: TLLM_THROW("GEMM config undefined."); break;
     case cutlass_extensions::CutlassTileConfig::ChooseWithHeuristic:
@@ -320,9 +376,9 @@ void dispatchMoeGemmToCutlass(T const* A, WeightType const* B, GemmOutputType co
 template <typename T, typename WeightType, typename GemmOutputType, typename arch, typename EpilogueTag,
     typename std::enable_if<!std::is_same<T, float>::value && !std::is_same<T, WeightType>::value>::type* = nullptr>
 void dispatchMoeGemmToCutlass(T const* A, WeightType const* B, GemmOutputType const* weight_scales,
-    GemmOutputType const* biases, bool bias_is_broadcast, GemmOutputType* C,
-    int64_t const* total_tokens_including_expert, int64_t total_rows, int64_t gemm_n, int64_t gemm_k, int num_experts,
-    cutlass_extensions::CutlassGemmConfig gemm_config, int multi_processor_count, bool use_fused_moe,
+    GemmOutputType const* weight_zeros, int64_t group_size, GemmOutputType const* biases, bool bias_is_broadcast,
+    GemmOutputType* C, int64_t const* total_tokens_including_expert, int64_t total_rows, int64_t gemm_n, int64_t gemm_k,
+    int num_experts, cutlass_extensions::CutlassGemmConfig gemm_config, int multi_processor_count, bool use_fused_moe,
     float const** alpha_scale_ptr_array, cudaStream_t stream, int* occupancy = nullptr)
 {
     switch (gemm_config.tile_config)
@@ -332,9 +388,9 @@ void dispatchMoeGemmToCutlass(T const* A, WeightType const* B, GemmOutputType co
         if constexpr (arch::kMinComputeCapability >= 75)
         {
             dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<16, 128, 64>,
-                cutlass::gemm::GemmShape<16, 32, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-                total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
-                multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+                cutlass::gemm::GemmShape<16, 32, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+                bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts,
+                gemm_config, multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         }
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape16x256x64_WarpShape16x64x64:
@@ -342,28 +398,28 @@ void dispatchMoeGemmToCutlass(T const* A, WeightType const* B, GemmOutputType co
         if constexpr (arch::kMinComputeCapability >= 75)
         {
             dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<16, 256, 64>,
-                cutlass::gemm::GemmShape<16, 64, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-                total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
-                multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+                cutlass::gemm::GemmShape<16, 64, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+                bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts,
+                gemm_config, multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         }
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape32x128x64_WarpShape32x32x64:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<32, 128, 64>,
-            cutlass::gemm::GemmShape<32, 32, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<32, 32, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape64x128x64_WarpShape64x32x64:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<64, 128, 64>,
-            cutlass::gemm::GemmShape<64, 32, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<64, 32, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape128x128x64_WarpShape128x32x64:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<128, 128, 64>,
-            cutlass::gemm::GemmShape<128, 32, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<128, 32, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::Undefined: TLLM_THROW("GEMM config undefined."); break;
     case cutlass_extensions::CutlassTileConfig::ChooseWithHeuristic:
@@ -380,54 +436,54 @@ template <typename T, typename WeightType, typename GemmOutputType, typename arc
     typename std::enable_if<(std::is_same<T, __nv_fp8_e4m3>::value || std::is_same<T, __nv_fp8_e5m2>::value)
         && std::is_same<T, WeightType>::value>::type* = nullptr>
 void dispatchMoeGemmToCutlass(T const* A, WeightType const* B, GemmOutputType const* weight_scales,
-    GemmOutputType const* biases, bool bias_is_broadcast, GemmOutputType* C,
-    int64_t const* total_tokens_including_expert, int64_t total_rows, int64_t gemm_n, int64_t gemm_k, int num_experts,
-    cutlass_extensions::CutlassGemmConfig gemm_config, int multi_processor_count, bool use_fused_moe,
+    GemmOutputType const* weight_zeros, int64_t group_size, GemmOutputType const* biases, bool bias_is_broadcast,
+    GemmOutputType* C, int64_t const* total_tokens_including_expert, int64_t total_rows, int64_t gemm_n, int64_t gemm_k,
+    int num_experts, cutlass_extensions::CutlassGemmConfig gemm_config, int multi_processor_count, bool use_fused_moe,
     float const** alpha_scale_ptr_array, cudaStream_t stream, int* occupancy = nullptr)
 {
     switch (gemm_config.tile_config)
     {
     case cutlass_extensions::CutlassTileConfig::CtaShape16x256x128_WarpShape16x64x128:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<16, 256, 128>,
-            cutlass::gemm::GemmShape<16, 64, 128>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<16, 64, 128>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape32x128x64_WarpShape32x32x64:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<32, 128, 64>,
-            cutlass::gemm::GemmShape<32, 32, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<32, 32, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape64x128x64_WarpShape64x32x64:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<64, 128, 64>,
-            cutlass::gemm::GemmShape<64, 32, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<64, 32, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape64x64x128_WarpShape32x64x64:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<64, 64, 128>,
-            cutlass::gemm::GemmShape<32, 64, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<32, 64, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape128x64x64_WarpShape64x32x64:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<128, 64, 64>,
-            cutlass::gemm::GemmShape<64, 32, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<64, 32, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape128x256x64_WarpShape64x64x64:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<128, 256, 64>,
-            cutlass::gemm::GemmShape<64, 64, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<64, 64, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::CtaShape256x128x64_WarpShape64x64x64:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<256, 128, 64>,
-            cutlass::gemm::GemmShape<64, 64, 64>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<64, 64, 64>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::Undefined: TLLM_THROW("GEMM config undefined."); break;
     case cutlass_extensions::CutlassTileConfig::ChooseWithHeuristic:
@@ -442,18 +498,18 @@ void dispatchMoeGemmToCutlass(T const* A, WeightType const* B, GemmOutputType co
 template <typename T, typename WeightType, typename GemmOutputType, typename arch, typename EpilogueTag,
     typename std::enable_if<std::is_same<T, float>::value>::type* = nullptr>
 void dispatchMoeGemmToCutlass(T const* A, WeightType const* B, GemmOutputType const* weight_scales,
-    GemmOutputType const* biases, bool bias_is_broadcast, GemmOutputType* C,
-    int64_t const* total_tokens_including_expert, int64_t total_rows, int64_t gemm_n, int64_t gemm_k, int num_experts,
-    cutlass_extensions::CutlassGemmConfig gemm_config, int multi_processor_count, bool use_fused_moe,
+    GemmOutputType const* weight_zeros, int64_t group_size, GemmOutputType const* biases, bool bias_is_broadcast,
+    GemmOutputType* C, int64_t const* total_tokens_including_expert, int64_t total_rows, int64_t gemm_n, int64_t gemm_k,
+    int num_experts, cutlass_extensions::CutlassGemmConfig gemm_config, int multi_processor_count, bool use_fused_moe,
     float const** alpha_scale_ptr_array, cudaStream_t stream, int* occupancy = nullptr)
 {
     switch (gemm_config.tile_config)
     {
     case cutlass_extensions::CutlassTileConfig::CtaShape128x128x8_WarpShape64x64x8:
         dispatchGemmConfig<T, WeightType, GemmOutputType, arch, EpilogueTag, cutlass::gemm::GemmShape<128, 128, 8>,
-            cutlass::gemm::GemmShape<64, 64, 8>>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count,
-            use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            cutlass::gemm::GemmShape<64, 64, 8>>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts, gemm_config,
+            multi_processor_count, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
         break;
     case cutlass_extensions::CutlassTileConfig::Undefined: TLLM_THROW("GEMM config undefined."); break;
     case cutlass_extensions::CutlassTileConfig::ChooseWithHeuristic:
@@ -583,10 +639,11 @@ MoeGemmRunner<T, WeightType, OutputType, ScaleBiasType>::MoeGemmRunner()
 template <typename T, typename WeightType, typename OutputType, typename ScaleBiasType>
 template <typename EpilogueTag>
 void MoeGemmRunner<T, WeightType, OutputType, ScaleBiasType>::dispatchToArch<EpilogueTag>(T const* A,
-    WeightType const* B, ScaleBiasType const* weight_scales, ScaleBiasType const* biases, bool bias_is_broadcast,
-    void* C_void, int64_t const* total_tokens_including_expert, HopperGroupedGemmInput hopper_input, int64_t total_rows,
-    int64_t gemm_n, int64_t gemm_k, int num_experts, cutlass_extensions::CutlassGemmConfig gemm_config,
-    bool use_fused_moe, float const** alpha_scale_ptr_array, cudaStream_t stream, int* occupancy)
+    WeightType const* B, ScaleBiasType const* weight_scales, ScaleBiasType const* weight_zeros, int64_t group_size,
+    ScaleBiasType const* biases, bool bias_is_broadcast, void* C_void, int64_t const* total_tokens_including_expert,
+    HopperGroupedGemmInput hopper_input, int64_t total_rows, int64_t gemm_n, int64_t gemm_k, int num_experts,
+    cutlass_extensions::CutlassGemmConfig gemm_config, bool use_fused_moe, float const** alpha_scale_ptr_array,
+    cudaStream_t stream, int* occupancy)
 {
     static_assert(std::is_same_v<ScaleBiasType, OutputType>,
         "Separate Scale/Bias type is not supported. This is assumed to be the gemm output type");
@@ -603,14 +660,16 @@ void MoeGemmRunner<T, WeightType, OutputType, ScaleBiasType>::dispatchToArch<Epi
     if (sm_ >= 70 && sm_ < 75)
     {
         dispatchMoeGemmToCutlass<T, WeightType, ScaleBiasType, cutlass::arch::Sm70, EpilogueTag>(A, B, weight_scales,
-            biases, bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts,
-            gemm_config, multi_processor_count_, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            weight_zeros, group_size, biases, bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n,
+            gemm_k, num_experts, gemm_config, multi_processor_count_, use_fused_moe, alpha_scale_ptr_array, stream,
+            occupancy);
     }
     else if (sm_ >= 75 && sm_ < 80)
     {
         dispatchMoeGemmToCutlass<T, WeightType, ScaleBiasType, cutlass::arch::Sm75, EpilogueTag>(A, B, weight_scales,
-            biases, bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k, num_experts,
-            gemm_config, multi_processor_count_, use_fused_moe, alpha_scale_ptr_array, stream, occupancy);
+            weight_zeros, group_size, biases, bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n,
+            gemm_k, num_experts, gemm_config, multi_processor_count_, use_fused_moe, alpha_scale_ptr_array, stream,
+            occupancy);
     }
     else if (sm_ >= 80 && sm_ < 90)
     {
@@ -623,16 +682,16 @@ void MoeGemmRunner<T, WeightType, OutputType, ScaleBiasType>::dispatchToArch<Epi
 
             TLLM_CHECK_WITH_INFO(sm_ == 89, "For sm >= 80 and < 90, fp8 is only supported with sm == 89");
             dispatchMoeGemmToCutlass<T, WeightType, ScaleBiasType, cutlass::arch::Sm89, EpilogueTag>(A, B,
-                weight_scales, biases, bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k,
-                num_experts, gemm_config, multi_processor_count_, use_fused_moe, alpha_scale_ptr_array, stream,
-                occupancy);
+                weight_scales, weight_zeros, group_size, biases, bias_is_broadcast, C, total_tokens_including_expert,
+                total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count_, use_fused_moe,
+                alpha_scale_ptr_array, stream, occupancy);
         }
         else
         {
             dispatchMoeGemmToCutlass<T, WeightType, ScaleBiasType, cutlass::arch::Sm80, EpilogueTag>(A, B,
-                weight_scales, biases, bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k,
-                num_experts, gemm_config, multi_processor_count_, use_fused_moe, alpha_scale_ptr_array, stream,
-                occupancy);
+                weight_scales, weight_zeros, group_size, biases, bias_is_broadcast, C, total_tokens_including_expert,
+                total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count_, use_fused_moe,
+                alpha_scale_ptr_array, stream, occupancy);
         }
     }
     else if (sm_ >= 90)
@@ -682,9 +741,9 @@ void MoeGemmRunner<T, WeightType, OutputType, ScaleBiasType>::dispatchToArch<Epi
             TLLM_CHECK_WITH_INFO(!gemm_config.is_sm90,
                 "GEMM config is for SM90 configuration, but this configuration is not valid for Hppper");
             dispatchMoeGemmToCutlass<T, WeightType, ScaleBiasType, cutlass::arch::Sm80, EpilogueTag>(A, B,
-                weight_scales, biases, bias_is_broadcast, C, total_tokens_including_expert, total_rows, gemm_n, gemm_k,
-                num_experts, gemm_config, multi_processor_count_, use_fused_moe, alpha_scale_ptr_array, stream,
-                occupancy);
+                weight_scales, weight_zeros, group_size, biases, bias_is_broadcast, C, total_tokens_including_expert,
+                total_rows, gemm_n, gemm_k, num_experts, gemm_config, multi_processor_count_, use_fused_moe,
+                alpha_scale_ptr_array, stream, occupancy);
         }
         else
         {
@@ -755,54 +814,56 @@ size_t MoeGemmRunner<T, WeightType, OutputType, ScaleBiasType>::calcMaxWorkspace
 template <typename T, typename WeightType, typename OutputType, typename ScaleBiasType>
 template <typename EpilogueTag>
 void MoeGemmRunner<T, WeightType, OutputType, ScaleBiasType>::runGemm(T const* A, WeightType const* B,
-    ScaleBiasType const* weight_scales, ScaleBiasType const* biases, bool bias_is_broadcast, void* C,
-    int64_t const* total_tokens_including_expert, HopperGroupedGemmInput hopper_input, int64_t total_rows,
-    int64_t gemm_n, int64_t gemm_k, int num_experts, bool use_fused_moe, float const** alpha_scale_ptr_array,
-    cudaStream_t stream, cutlass_extensions::CutlassGemmConfig chosen_conf)
+    ScaleBiasType const* weight_scales, ScaleBiasType const* weight_zeros, int64_t group_size,
+    ScaleBiasType const* biases, bool bias_is_broadcast, void* C, int64_t const* total_tokens_including_expert,
+    HopperGroupedGemmInput hopper_input, int64_t total_rows, int64_t gemm_n, int64_t gemm_k, int num_experts,
+    bool use_fused_moe, float const** alpha_scale_ptr_array, cudaStream_t stream,
+    cutlass_extensions::CutlassGemmConfig chosen_conf)
 {
-    dispatchToArch<EpilogueTag>(A, B, weight_scales, biases, bias_is_broadcast, C, total_tokens_including_expert,
-        hopper_input, total_rows, gemm_n, gemm_k, num_experts, chosen_conf, use_fused_moe, alpha_scale_ptr_array,
-        stream, nullptr);
+    dispatchToArch<EpilogueTag>(A, B, weight_scales, weight_zeros, group_size, biases, bias_is_broadcast, C,
+        total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts, chosen_conf,
+        use_fused_moe, alpha_scale_ptr_array, stream, nullptr);
 }
 
 template <typename T, typename WeightType, typename OutputType, typename ScaleBiasType>
 void MoeGemmRunner<T, WeightType, OutputType, ScaleBiasType>::moeGemmBiasAct(T const* A, WeightType const* B,
-    ScaleBiasType const* weight_scales, ScaleBiasType const* biases, bool bias_is_broadcast, void* C,
-    int64_t const* total_tokens_including_expert, HopperGroupedGemmInput hopper_input, int64_t total_rows,
-    int64_t gemm_n, int64_t gemm_k, int num_experts, ActivationType activation_type, bool use_fused_moe,
-    float const** alpha_scale_ptr_array, cudaStream_t stream, cutlass_extensions::CutlassGemmConfig chosen_conf)
+    ScaleBiasType const* weight_scales, ScaleBiasType const* weight_zeros, int64_t group_size,
+    ScaleBiasType const* biases, bool bias_is_broadcast, void* C, int64_t const* total_tokens_including_expert,
+    HopperGroupedGemmInput hopper_input, int64_t total_rows, int64_t gemm_n, int64_t gemm_k, int num_experts,
+    ActivationType activation_type, bool use_fused_moe, float const** alpha_scale_ptr_array, cudaStream_t stream,
+    cutlass_extensions::CutlassGemmConfig chosen_conf)
 {
     switch (activation_type)
     {
     case ActivationType::Relu:
-        runGemm<cutlass_extensions::EpilogueOpDefaultReLU>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts, use_fused_moe,
-            alpha_scale_ptr_array, stream, chosen_conf);
+        runGemm<cutlass_extensions::EpilogueOpDefaultReLU>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts,
+            use_fused_moe, alpha_scale_ptr_array, stream, chosen_conf);
         break;
     case ActivationType::Gelu:
-        runGemm<cutlass_extensions::EpilogueOpDefaultFtGelu>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts, use_fused_moe,
-            alpha_scale_ptr_array, stream, chosen_conf);
+        runGemm<cutlass_extensions::EpilogueOpDefaultFtGelu>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts,
+            use_fused_moe, alpha_scale_ptr_array, stream, chosen_conf);
         break;
     case ActivationType::Silu:
-        runGemm<cutlass_extensions::EpilogueOpDefaultSilu>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts, use_fused_moe,
-            alpha_scale_ptr_array, stream, chosen_conf);
+        runGemm<cutlass_extensions::EpilogueOpDefaultSilu>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts,
+            use_fused_moe, alpha_scale_ptr_array, stream, chosen_conf);
         break;
     case ActivationType::Identity:
-        runGemm<cutlass_extensions::EpilogueOpDefault>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts, use_fused_moe,
-            alpha_scale_ptr_array, stream, chosen_conf);
+        runGemm<cutlass_extensions::EpilogueOpDefault>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts,
+            use_fused_moe, alpha_scale_ptr_array, stream, chosen_conf);
         break;
     case ActivationType::Swiglu:
-        runGemm<cutlass_extensions::EpilogueOpDefaultSilu>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts, use_fused_moe,
-            alpha_scale_ptr_array, stream, chosen_conf);
+        runGemm<cutlass_extensions::EpilogueOpDefaultSilu>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts,
+            use_fused_moe, alpha_scale_ptr_array, stream, chosen_conf);
         break;
     case ActivationType::Geglu:
-        runGemm<cutlass_extensions::EpilogueOpDefaultFtGelu>(A, B, weight_scales, biases, bias_is_broadcast, C,
-            total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts, use_fused_moe,
-            alpha_scale_ptr_array, stream, chosen_conf);
+        runGemm<cutlass_extensions::EpilogueOpDefaultFtGelu>(A, B, weight_scales, weight_zeros, group_size, biases,
+            bias_is_broadcast, C, total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts,
+            use_fused_moe, alpha_scale_ptr_array, stream, chosen_conf);
         break;
     case ActivationType::InvalidType: TLLM_THROW("Activation type for fpA_intB must be valid."); break;
     default: TLLM_THROW("Invalid activation type."); break;
@@ -811,14 +872,14 @@ void MoeGemmRunner<T, WeightType, OutputType, ScaleBiasType>::moeGemmBiasAct(T c
 
 template <typename T, typename WeightType, typename OutputType, typename ScaleBiasType>
 void MoeGemmRunner<T, WeightType, OutputType, ScaleBiasType>::moeGemm(T const* A, WeightType const* B,
-    ScaleBiasType const* weight_scales, void* C, int64_t const* total_tokens_including_expert,
-    HopperGroupedGemmInput hopper_input, int64_t total_rows, int64_t gemm_n, int64_t gemm_k, int num_experts,
-    bool use_fused_moe, float const** alpha_scale_ptr_array, cudaStream_t stream,
-    cutlass_extensions::CutlassGemmConfig chosen_conf)
+    ScaleBiasType const* weight_scales, ScaleBiasType const* weight_zeros, int64_t group_size, void* C,
+    int64_t const* total_tokens_including_expert, HopperGroupedGemmInput hopper_input, int64_t total_rows,
+    int64_t gemm_n, int64_t gemm_k, int num_experts, bool use_fused_moe, float const** alpha_scale_ptr_array,
+    cudaStream_t stream, cutlass_extensions::CutlassGemmConfig chosen_conf)
 {
-    runGemm<cutlass_extensions::EpilogueOpDefault>(A, B, weight_scales, nullptr, true, C, total_tokens_including_expert,
-        hopper_input, total_rows, gemm_n, gemm_k, num_experts, use_fused_moe, alpha_scale_ptr_array, stream,
-        chosen_conf);
+    runGemm<cutlass_extensions::EpilogueOpDefault>(A, B, weight_scales, weight_zeros, group_size, nullptr, true, C,
+        total_tokens_including_expert, hopper_input, total_rows, gemm_n, gemm_k, num_experts, use_fused_moe,
+        alpha_scale_ptr_array, stream, chosen_conf);
 }
 
 } // namespace tensorrt_llm
@@ -127,6 +127,10 @@ struct Multihead_attention_params_base
     float const* rotary_embedding_inv_freq_cache = nullptr;
     float rotary_embedding_short_m_scale = 1.0f;
     float rotary_embedding_long_m_scale = 1.0f;
+    // Per-request rotary inv freq with shape [batch_beam, rotary_embedding_dim / 2] and magnitude scale with shape
+    // [batch_beam] (YaRN, LongRoPE), see rotaryScalingUtils.h. They replace the inv freq cache and m scales above.
+    float const* rotary_embedding_inv_freq = nullptr;
+    float const* rotary_embedding_mscale = nullptr;
     int rotary_embedding_max_positions = 0;
     int rotary_embedding_original_max_positions = 0;
     int rotary_cogvlm_vision_start = -1;
@@ -148,6 +152,9 @@ struct Multihead_attention_params_base
     T const* relative_attention_bias = nullptr;
     int relative_attention_bias_stride = 0;
     int max_distance = 0;
+    // The implicit relative attention bias is pre-gathered per distance ([head_num/TP, max_distance], see
+    // invokeBuildRelativeAttentionBiasPerDistance) instead of being looked up from the bucketed table.
+    bool relative_attention_bias_per_distance = false;
 
     // block sparse config
     bool block_sparse_attention = false;
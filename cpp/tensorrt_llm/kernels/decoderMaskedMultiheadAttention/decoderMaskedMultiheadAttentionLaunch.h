@@ -16,6 +16,7 @@
 #pragma once
 
 #include "decoderMaskedMultiheadAttentionTemplate.h"
+#include "multiBlockTuningTable.h"
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/envUtils.h"
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention.h"
@@ -122,6 +123,10 @@ inline void multi_block_grid_setup(dim3& grid, Multihead_attention_params<T, DO_
     else
     {
         max_seq_len_tile = std::min(mmha::divUp(tlength + 1, seq_len_per_kv_loop), max_seq_len_tile);
+        // Tuned number of blocks of this arch, head config and batch/kv length buckets, if any.
+        auto const tuned_seq_len_tile = MultiBlockTuningTable::lookupGlobal(
+            params.num_heads, params.num_kv_heads, params.hidden_size_per_head, params.batch_size, tlength + 1);
+        balanced_seq_len_tile = tuned_seq_len_tile.value_or(balanced_seq_len_tile);
     }
 
     params.seq_len_tile = std::clamp(balanced_seq_len_tile, params.min_seq_len_tile, max_seq_len_tile);
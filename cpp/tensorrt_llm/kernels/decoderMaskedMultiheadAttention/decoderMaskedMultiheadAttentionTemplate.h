@@ -1477,6 +1477,8 @@ __global__ void __launch_bounds__(MAX_THEADS_PER_BLOCK, MIN_BLOCKS_PER_SM) maske
     int relative_attention_bias_stride
         = params.relative_attention_bias_stride; // num_buckets might be modified below, save it beforehand
     [[maybe_unused]] int max_distance = params.max_distance;
+    // The bias is already gathered per distance, with stride max_distance: no bucketing needed.
+    [[maybe_unused]] bool const relative_attention_bias_per_distance = params.relative_attention_bias_per_distance;
 
     // The actual sequence length excluding the paddings.
     // minus 1 because it includes the current timestep while tlength denotes the kv cache length.
@@ -1537,11 +1539,20 @@ __global__ void __launch_bounds__(MAX_THEADS_PER_BLOCK, MIN_BLOCKS_PER_SM) maske
     float const* rotary_embedding_inv_freq_cache = params.rotary_embedding_scale_type != RotaryScalingType::kDYNAMIC
         ? params.rotary_embedding_inv_freq_cache
         : nullptr;
+    bool const per_request_rotary_scaling = params.rotary_embedding_inv_freq != nullptr;
+    if (per_request_rotary_scaling)
+    {
+        rotary_embedding_inv_freq_cache
+            = params.rotary_embedding_inv_freq + batch_beam_idx * (params.rotary_embedding_dim / 2);
+    }
     if (is_valid_qk_vec)
     {
-        mmha::update_rotary_base_n_scale(rotary_embedding_base, rotary_embedding_scale,
-            params.rotary_embedding_scale_type, params.rotary_embedding_dim, params.rotary_embedding_max_positions,
-            current_pos_idx);
+        if (!per_request_rotary_scaling)
+        {
+            mmha::update_rotary_base_n_scale(rotary_embedding_base, rotary_embedding_scale,
+                params.rotary_embedding_scale_type, params.rotary_embedding_dim, params.rotary_embedding_max_positions,
+                current_pos_idx);
+        }
         // Query
         // The stride between tokens. We may be able to always use params.stride.
         uint32_t q_stride = params.stride ? static_cast<uint32_t>(params.stride) : (num_heads * Dh);
@@ -1689,9 +1700,10 @@ __global__ void __launch_bounds__(MAX_THEADS_PER_BLOCK, MIN_BLOCKS_PER_SM) maske
         constexpr int tidx_factor = (QK_VEC_SIZE > 1) ? QK_VEC_SIZE / 2 : 1;
         if (do_rotary)
         {
-            float rotary_embedding_m_scale = tlength <= params.rotary_embedding_original_max_positions
-                ? params.rotary_embedding_short_m_scale
-                : params.rotary_embedding_long_m_scale;
+            float rotary_embedding_m_scale = per_request_rotary_scaling
+                ? params.rotary_embedding_mscale[batch_beam_idx]
+                : (tlength <= params.rotary_embedding_original_max_positions ? params.rotary_embedding_short_m_scale
+                                                                              : params.rotary_embedding_long_m_scale);
             mmha::vec_from_smem_transpose(q, q_smem_, transpose_idx, smem_pitch);
             if (HANDLE_KV)
             {
@@ -1979,13 +1991,20 @@ __global__ void __launch_bounds__(MAX_THEADS_PER_BLOCK, MIN_BLOCKS_PER_SM) maske
                 // (ref: tensorrt_llm/layers/attention.py compute_relative_bias())
                 relative_position = relative_position >= 0 ? 0 : -relative_position;
 
-                int max_exact = num_buckets / 2;
-                bool is_small = relative_position < max_exact;
-                int relative_position_if_large = max_exact
-                    + (int) (logf(relative_position * 1.0f / max_exact) / logf((float) max_distance / max_exact)
-                        * (num_buckets - max_exact));
-                relative_position_if_large = min(relative_position_if_large, num_buckets - 1);
-                relative_buckets += is_small ? relative_position : relative_position_if_large;
+                if (relative_attention_bias_per_distance)
+                {
+                    relative_buckets = min(relative_position, max_distance - 1);
+                }
+                else
+                {
+                    int max_exact = num_buckets / 2;
+                    bool is_small = relative_position < max_exact;
+                    int relative_position_if_large = max_exact
+                        + (int) (logf(relative_position * 1.0f / max_exact) / logf((float) max_distance / max_exact)
+                            * (num_buckets - max_exact));
+                    relative_position_if_large = min(relative_position_if_large, num_buckets - 1);
+                    relative_buckets += is_small ? relative_position : relative_position_if_large;
+                }
                 relative_attention_bias_ptr
                     = relative_attention_bias_ptr_fixed + (tlength - local_time_now) + relative_buckets;
             }
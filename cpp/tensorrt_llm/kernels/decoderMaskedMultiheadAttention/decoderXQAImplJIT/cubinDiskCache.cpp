@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "cubinDiskCache.h"
+#include "serializationUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/stringUtils.h"
+
+#include <atomic>
+#include <chrono>
+#include <cuda_runtime_api.h>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <thread>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+namespace jit
+{
+
+namespace
+{
+
+constexpr uint32_t kMagic = 0x434a5854; // "TXJC"
+
+// Header, key size and cubin size.
+constexpr size_t kEntryOverhead = 4 * sizeof(uint32_t);
+
+uint64_t getProcessId()
+{
+#if defined(_WIN32)
+    return static_cast<uint64_t>(_getpid());
+#else
+    return static_cast<uint64_t>(getpid());
+#endif
+}
+
+// Unique within and across processes, so that concurrent writers never share a temporary file.
+std::string getTemporarySuffix()
+{
+    static std::atomic<uint64_t> counter{0};
+    auto const threadHash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    return tensorrt_llm::common::fmtstr(".tmp.%lu.%zx.%lu", static_cast<unsigned long>(getProcessId()), threadHash,
+        static_cast<unsigned long>(counter.fetch_add(1)));
+}
+
+} // anonymous namespace
+
+CubinDiskCache::CubinDiskCache(std::string const& rootDir, int SM)
+{
+    auto const versionDir = "v" + std::to_string(kVersion);
+    auto const toolchainDir = tensorrt_llm::common::fmtstr("sm%d_cuda%d", SM, CUDART_VERSION);
+    mDirectory = (fs::path(rootDir) / versionDir / toolchainDir).string();
+}
+
+std::string CubinDiskCache::getEntryPath(uint64_t keyHash) const
+{
+    auto const fileName = tensorrt_llm::common::fmtstr("%016lx.cubin", static_cast<unsigned long>(keyHash));
+    return (fs::path(mDirectory) / fileName).string();
+}
+
+std::optional<CubinDiskCache::Entry> CubinDiskCache::load(uint64_t keyHash) const
+{
+    auto const path = getEntryPath(keyHash);
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return std::nullopt;
+    }
+    std::vector<uint8_t> const content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    if (content.size() < kEntryOverhead)
+    {
+        TLLM_LOG_WARNING("Ignoring truncated XQA JIT cache entry %s", path.c_str());
+        return std::nullopt;
+    }
+
+    uint8_t const* buffer = content.data();
+    size_t remaining = content.size();
+    auto const magic = readFromBuffer<uint32_t>(buffer, remaining);
+    auto const version = readFromBuffer<uint32_t>(buffer, remaining);
+    if (magic != kMagic || version != kVersion)
+    {
+        TLLM_LOG_WARNING("Ignoring XQA JIT cache entry %s with unexpected header", path.c_str());
+        return std::nullopt;
+    }
+
+    Entry entry;
+    auto const keySize = readFromBuffer<uint32_t>(buffer, remaining);
+    if (keySize + sizeof(uint32_t) > remaining)
+    {
+        TLLM_LOG_WARNING("Ignoring truncated XQA JIT cache entry %s", path.c_str());
+        return std::nullopt;
+    }
+    entry.key.assign(buffer, buffer + keySize);
+    buffer += keySize;
+    remaining -= keySize;
+
+    auto const cubinSize = readFromBuffer<uint32_t>(buffer, remaining);
+    if (cubinSize != remaining)
+    {
+        TLLM_LOG_WARNING("Ignoring truncated XQA JIT cache entry %s", path.c_str());
+        return std::nullopt;
+    }
+    entry.cubin.assign(buffer, buffer + cubinSize);
+
+    TLLM_LOG_DEBUG("Loaded XQA JIT cubin from %s", path.c_str());
+    return entry;
+}
+
+void CubinDiskCache::store(uint64_t keyHash, Entry const& entry) const
+{
+    auto const path = getEntryPath(keyHash);
+
+    std::error_code ec;
+    // Other processes may create the directory at the same time, which is fine.
+    fs::create_directories(mDirectory, ec);
+    if (ec)
+    {
+        TLLM_LOG_WARNING("Failed to create XQA JIT cache directory %s: %s", mDirectory.c_str(), ec.message().c_str());
+        return;
+    }
+
+    std::vector<uint8_t> content(kEntryOverhead + entry.key.size() + entry.cubin.size());
+    uint8_t* buffer = content.data();
+    size_t remaining = content.size();
+    writeToBuffer<uint32_t>(kMagic, buffer, remaining);
+    writeToBuffer<uint32_t>(kVersion, buffer, remaining);
+    writeToBuffer<uint32_t>(static_cast<uint32_t>(entry.key.size()), buffer, remaining);
+    std::copy(entry.key.begin(), entry.key.end(), buffer);
+    buffer += entry.key.size();
+    remaining -= entry.key.size();
+    writeToBuffer<uint32_t>(static_cast<uint32_t>(entry.cubin.size()), buffer, remaining);
+    std::copy(entry.cubin.begin(), entry.cubin.end(), buffer);
+
+    auto const tmpPath = path + getTemporarySuffix();
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<char const*>(content.data()), static_cast<std::streamsize>(content.size()));
+        if (!file.good())
+        {
+            TLLM_LOG_WARNING("Failed to write XQA JIT cache entry %s", tmpPath.c_str());
+            file.close();
+            fs::remove(tmpPath, ec);
+            return;
+        }
+    }
+
+    // Atomically publish the entry. If another process stored the same key meanwhile, either copy is valid.
+    fs::rename(tmpPath, path, ec);
+    if (ec)
+    {
+        TLLM_LOG_WARNING("Failed to publish XQA JIT cache entry %s: %s", path.c_str(), ec.message().c_str());
+        fs::remove(tmpPath, ec);
+        return;
+    }
+    TLLM_LOG_DEBUG("Stored XQA JIT cubin to %s", path.c_str());
+}
+
+} // namespace jit
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+namespace jit
+{
+
+// A persistent cache of serialized cubins shared between processes.
+//
+// Entries live in a directory keyed by the cache format version, the GPU arch and the CUDA version, e.g.
+// <root>/v1/sm90_cuda12040/<key hash>.cubin. Every entry stores its serialized key next to the serialized cubin so
+// that hash collisions are detected by the reader. Entries are written to a temporary file and renamed into place, so
+// concurrent readers and writers, e.g. all ranks of a node, only ever observe complete entries. Failures to read or
+// write the cache are not fatal, the cubin is compiled instead.
+class CubinDiskCache
+{
+public:
+    // Bump when the serialization of keys or cubins, or the JIT compiler producing them, changes.
+    static constexpr uint32_t kVersion = 1;
+
+    struct Entry
+    {
+        std::vector<uint8_t> key;
+        std::vector<uint8_t> cubin;
+    };
+
+    CubinDiskCache(std::string const& rootDir, int SM);
+
+    // Returns std::nullopt if the entry does not exist or is not valid.
+    std::optional<Entry> load(uint64_t keyHash) const;
+
+    // Best effort, logs a warning on failure.
+    void store(uint64_t keyHash, Entry const& entry) const;
+
+    std::string const& getDirectory() const noexcept
+    {
+        return mDirectory;
+    }
+
+private:
+    std::string getEntryPath(uint64_t keyHash) const;
+
+    std::string mDirectory;
+};
+
+} // namespace jit
+} // namespace kernels
+} // namespace tensorrt_llm
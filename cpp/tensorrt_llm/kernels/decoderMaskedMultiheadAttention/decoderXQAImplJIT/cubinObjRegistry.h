@@ -17,9 +17,14 @@
 #include "cubinObj.h"
 
 #include "compileEngine.h"
+#include "cubinDiskCache.h"
 #include "serializationUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/startupProfiler.h"
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/decoderXQAImplCommon.h"
 #include <functional>
+#include <memory>
+#include <optional>
 #include <unordered_map>
 
 namespace tensorrt_llm
@@ -70,6 +75,7 @@ public:
         {
             result->mMap.insert(p);
         }
+        result->mDiskCache = mDiskCache;
         return result;
     }
 
@@ -111,6 +117,13 @@ public:
         TLLM_CHECK(remaining_buffer_size == 0);
     }
 
+    // Looks up cubins missing from mMap in diskCache before compiling them, and stores compiled cubins into it.
+    void setDiskCache(std::shared_ptr<CubinDiskCache const> diskCache)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mDiskCache = std::move(diskCache);
+    }
+
     // Compiles and inserts the cubin if not found in mMap. Does nothing otherwise.
     void insertCubinIfNotExists(Key const& key, CompileEngine* compileEngine)
     {
@@ -124,7 +137,15 @@ public:
             return;
         }
 
+        common::StartupProfiler::ScopedPhase const startupPhase{common::StartupPhase::kXQA_JIT};
+        if (auto cachedObj = loadFromDiskCache(key))
+        {
+            mMap.insert({key, std::move(*cachedObj)});
+            return;
+        }
+
         CubinObj obj = compileEngine->compile();
+        storeToDiskCache(key, obj);
         mMap.insert({key, std::move(obj)});
         return;
     }
@@ -164,7 +185,46 @@ public:
     }
 
 private:
+    std::optional<CubinObj> loadFromDiskCache(Key const& key) const
+    {
+        if (!mDiskCache)
+        {
+            return std::nullopt;
+        }
+        auto entry = mDiskCache->load(Hash{}(key));
+        // Entries of colliding keys are treated as misses.
+        if (!entry || entry->key.size() != key.getSerializationSize()
+            || !(Key(entry->key.data(), entry->key.size()) == key))
+        {
+            return std::nullopt;
+        }
+        try
+        {
+            return CubinObj(entry->cubin.data(), entry->cubin.size());
+        }
+        catch (std::exception const& e)
+        {
+            TLLM_LOG_WARNING("Ignoring corrupted XQA JIT cache entry: %s", e.what());
+            return std::nullopt;
+        }
+    }
+
+    void storeToDiskCache(Key const& key, CubinObj const& obj) const
+    {
+        if (!mDiskCache)
+        {
+            return;
+        }
+        CubinDiskCache::Entry entry;
+        entry.key.resize(key.getSerializationSize());
+        key.serialize(entry.key.data(), entry.key.size());
+        entry.cubin.resize(obj.getSerializationSize());
+        obj.serialize(entry.cubin.data(), entry.cubin.size());
+        mDiskCache->store(Hash{}(key), entry);
+    }
+
     std::unordered_map<Key, CubinObj, Hash> mMap;
+    std::shared_ptr<CubinDiskCache const> mDiskCache;
     mutable std::mutex mMutex;
 };
 
@@ -150,9 +150,24 @@ template void DecoderXQARunner::run(
     XQAParams const& xqa_params, KVBlockArray const& kv_block_array, cudaStream_t const& stream);
 
 //// DecoderXQARunner::Resource
+namespace
+{
+
+void attachDiskCacheFromEnv(jit::CubinObjRegistry& registry)
+{
+    if (auto const cacheDir = tensorrt_llm::common::getEnvXQAJITCacheDir())
+    {
+        registry.setDiskCache(
+            std::make_shared<jit::CubinDiskCache>(cacheDir.value(), tensorrt_llm::common::getSMVersion()));
+    }
+}
+
+} // namespace
+
 DecoderXQARunner::Resource::Resource()
     : mCubinObjRegistry(std::make_unique<jit::CubinObjRegistry>())
 {
+    attachDiskCacheFromEnv(*mCubinObjRegistry);
 }
 
 DecoderXQARunner::Resource::Resource(DecoderXQARunner::Resource const& other)
@@ -173,6 +188,7 @@ DecoderXQARunner::Resource& DecoderXQARunner::Resource::operator=(DecoderXQARunn
 DecoderXQARunner::Resource::Resource(void const* buffer, size_t buffer_size)
     : mCubinObjRegistry(std::make_unique<jit::CubinObjRegistry>(buffer, buffer_size))
 {
+    attachDiskCacheFromEnv(*mCubinObjRegistry);
 }
 
 size_t DecoderXQARunner::Resource::getSerializationSize() const noexcept
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "multiBlockTuningTable.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+int32_t MultiBlockTuningTable::getBucket(int32_t value) noexcept
+{
+    int32_t bucket = 0;
+    while ((int64_t{1} << bucket) < value)
+    {
+        ++bucket;
+    }
+    return bucket;
+}
+
+MultiBlockTuningTable::Key MultiBlockTuningTable::makeKey(
+    int32_t sm, int32_t numHeads, int32_t numKvHeads, int32_t headSize, int32_t batchSize, int32_t kvLength)
+{
+    return Key{sm, numHeads, numKvHeads, headSize, getBucket(batchSize), getBucket(kvLength)};
+}
+
+size_t MultiBlockTuningTable::KeyHash::operator()(Key const& key) const noexcept
+{
+    size_t seed = 0;
+    for (auto const value :
+        {key.sm, key.numHeads, key.numKvHeads, key.headSize, key.batchBucket, key.kvLenBucket})
+    {
+        seed ^= std::hash<int32_t>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+std::optional<int32_t> MultiBlockTuningTable::lookup(Key const& key) const
+{
+    if (mEmpty.load(std::memory_order_acquire))
+    {
+        return std::nullopt;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto const it = mEntries.find(key);
+    if (it == mEntries.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void MultiBlockTuningTable::set(Key const& key, int32_t numSplits)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries[key] = numSplits;
+    mEmpty.store(false, std::memory_order_release);
+}
+
+size_t MultiBlockTuningTable::size() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+bool MultiBlockTuningTable::load(std::istream& is)
+{
+    std::vector<std::pair<Key, int32_t>> entries;
+    std::string line;
+    while (std::getline(is, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        Key key{};
+        int32_t numSplits{};
+        if (!(fields >> key.sm >> key.numHeads >> key.numKvHeads >> key.headSize >> key.batchBucket >> key.kvLenBucket
+                >> numSplits)
+            || numSplits < 1)
+        {
+            TLLM_LOG_WARNING("Malformed multi-block tuning entry '%s'.", line.c_str());
+            return false;
+        }
+        entries.emplace_back(key, numSplits);
+    }
+    for (auto const& [key, numSplits] : entries)
+    {
+        set(key, numSplits);
+    }
+    return true;
+}
+
+void MultiBlockTuningTable::save(std::ostream& os) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    os << "# sm numHeads numKvHeads headSize batchBucket kvLenBucket numSplits\n";
+    for (auto const& [key, numSplits] : mEntries)
+    {
+        os << key.sm << ' ' << key.numHeads << ' ' << key.numKvHeads << ' ' << key.headSize << ' ' << key.batchBucket
+           << ' ' << key.kvLenBucket << ' ' << numSplits << '\n';
+    }
+}
+
+bool MultiBlockTuningTable::loadFile(std::string const& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        TLLM_LOG_WARNING("Cannot open the multi-block tuning file %s.", path.c_str());
+        return false;
+    }
+    return load(file);
+}
+
+bool MultiBlockTuningTable::saveFile(std::string const& path) const
+{
+    std::ofstream file(path);
+    if (file)
+    {
+        save(file);
+    }
+    if (!file)
+    {
+        TLLM_LOG_WARNING("Cannot write the multi-block tuning file %s.", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+MultiBlockTuningTable& MultiBlockTuningTable::getGlobal()
+{
+    static MultiBlockTuningTable& table = []() -> MultiBlockTuningTable&
+    {
+        static MultiBlockTuningTable instance;
+        if (auto const path = common::getEnvMmhaMultiBlockTuningFile())
+        {
+            if (instance.loadFile(*path))
+            {
+                TLLM_LOG_INFO("Loaded %zu multi-block tuning entries from %s.", instance.size(), path->c_str());
+            }
+        }
+        return instance;
+    }();
+    return table;
+}
+
+std::optional<int32_t> MultiBlockTuningTable::lookupGlobal(
+    int32_t numHeads, int32_t numKvHeads, int32_t headSize, int32_t batchSize, int32_t kvLength)
+{
+    auto const& table = getGlobal();
+    if (table.mEmpty.load(std::memory_order_acquire))
+    {
+        return std::nullopt;
+    }
+    static int32_t const sm = common::getSMVersion();
+    return table.lookup(makeKey(sm, numHeads, numKvHeads, headSize, batchSize, kvLength));
+}
+
+} // namespace kernels
+} // namespace tensorrt_llm
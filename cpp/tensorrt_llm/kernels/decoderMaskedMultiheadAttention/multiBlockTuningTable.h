@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+// Tuned number of KV splits (blocks per sequence) of the multi-block mode of the MMHA kernels.
+//
+// Entries are keyed by the GPU arch, the head configuration and power-of-two buckets of the batch size and of the KV
+// length, and are filled offline by the mmhaMultiBlockTuner micro benchmark. The table is persisted as a text file
+// with one "sm numHeads numKvHeads headSize batchBucket kvLenBucket numSplits" entry per line. Kernels without an
+// entry keep the occupancy-based heuristic.
+class MultiBlockTuningTable
+{
+public:
+    struct Key
+    {
+        int32_t sm;
+        int32_t numHeads;
+        int32_t numKvHeads;
+        int32_t headSize;
+        // ceil(log2(batch size)).
+        int32_t batchBucket;
+        // ceil(log2(kv length)).
+        int32_t kvLenBucket;
+
+        bool operator==(Key const& other) const noexcept
+        {
+            return sm == other.sm && numHeads == other.numHeads && numKvHeads == other.numKvHeads
+                && headSize == other.headSize && batchBucket == other.batchBucket && kvLenBucket == other.kvLenBucket;
+        }
+    };
+
+    static int32_t getBucket(int32_t value) noexcept;
+
+    static Key makeKey(
+        int32_t sm, int32_t numHeads, int32_t numKvHeads, int32_t headSize, int32_t batchSize, int32_t kvLength);
+
+    std::optional<int32_t> lookup(Key const& key) const;
+
+    void set(Key const& key, int32_t numSplits);
+
+    [[nodiscard]] size_t size() const;
+
+    // Returns false and leaves the table unchanged if the stream holds a malformed entry.
+    bool load(std::istream& is);
+
+    void save(std::ostream& os) const;
+
+    // File variants of load and save. Failures are logged and return false.
+    bool loadFile(std::string const& path);
+    bool saveFile(std::string const& path) const;
+
+    // The table used by the kernels, loaded from TRTLLM_MMHA_MULTI_BLOCK_TUNING_FILE on first use.
+    static MultiBlockTuningTable& getGlobal();
+
+    // Look up the tuned number of splits of the global table for the current device.
+    static std::optional<int32_t> lookupGlobal(
+        int32_t numHeads, int32_t numKvHeads, int32_t headSize, int32_t batchSize, int32_t kvLength);
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(Key const& key) const noexcept;
+    };
+
+    mutable std::mutex mMutex;
+    std::unordered_map<Key, int32_t, KeyHash> mEntries;
+    // Lets lookups of an empty table skip the lock.
+    std::atomic<bool> mEmpty{true};
+};
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -28,41 +28,43 @@ namespace tensorrt_llm
 namespace kernels
 {
 
-__global__ void curandInitialize(curandState_t* state, int const* batchSlots, int const size, uint64_t const randomSeed)
+__global__ void randomStateInitialize(
+    RandomState* state, int const* batchSlots, int const size, uint64_t const randomSeed)
 {
     int const idx = threadIdx.x + blockIdx.x * blockDim.x;
     if (idx < size)
     {
         auto const batchSlot = batchSlots != nullptr ? batchSlots[idx] : idx;
-        curand_init(randomSeed, 0, 0, &state[batchSlot]);
+        // Counter based, the slot starts at step 0 of its seed
+        state[batchSlot] = RandomState{randomSeed, 0};
     }
 }
 
-void invokeCurandInitialize(
-    curandState_t* state, int const* batchSlots, size_t const batchSize, uint64_t const randomSeed, cudaStream_t stream)
+void invokeRandomStateInitialize(
+    RandomState* state, int const* batchSlots, size_t const batchSize, uint64_t const randomSeed, cudaStream_t stream)
 {
     dim3 block(256);
     dim3 grid((int) (ceil(batchSize * 1.0 / 256)));
-    curandInitialize<<<grid, block, 0, stream>>>(state, batchSlots, batchSize, randomSeed);
+    randomStateInitialize<<<grid, block, 0, stream>>>(state, batchSlots, batchSize, randomSeed);
 }
 
-__global__ void curandBatchInitialize(
-    curandState_t* states, SizeType32 const* batchSlots, SizeType32 const size, uint64_t const* randomSeeds)
+__global__ void randomStateBatchInitialize(RandomState* states, SizeType32 const* batchSlots, SizeType32 const size,
+    uint64_t const* randomSeeds, uint64_t const* randomSteps)
 {
     SizeType32 const bid = threadIdx.x + blockIdx.x * blockDim.x;
     if (bid < size)
     {
         auto const batchSlot = batchSlots != nullptr ? batchSlots[bid] : bid;
-        curand_init(randomSeeds[bid], 0, 0, &states[batchSlot]);
+        states[batchSlot] = RandomState{randomSeeds[bid], randomSteps != nullptr ? randomSteps[bid] : 0};
     }
 }
 
-void invokeCurandBatchInitialize(curandState_t* states, SizeType32 const* batchSlots, size_t const batchSize,
-    uint64_t const* randomSeeds, cudaStream_t stream)
+void invokeRandomStateBatchInitialize(RandomState* states, SizeType32 const* batchSlots, size_t const batchSize,
+    uint64_t const* randomSeeds, cudaStream_t stream, uint64_t const* randomSteps)
 {
     dim3 block(256);
     dim3 grid(static_cast<SizeType32>(ceil(batchSize * 1.0 / 256)));
-    curandBatchInitialize<<<grid, block, 0, stream>>>(states, batchSlots, batchSize, randomSeeds);
+    randomStateBatchInitialize<<<grid, block, 0, stream>>>(states, batchSlots, batchSize, randomSeeds, randomSteps);
 }
 
 template <typename T>
@@ -201,5 +203,27 @@ template void invokeScatterDecodingParams(
 template void invokeScatterDecodingParams(
     int32_t const* src, int32_t* dst, int const* batchSlots, int batchSize, cudaStream_t stream);
 
+__global__ void scatterSlotParamsKernel(SlotParamUpdate const* updates, int numUpdates)
+{
+    auto const updateIdx = static_cast<int>(blockIdx.x * blockDim.x + threadIdx.x);
+    if (updateIdx >= numUpdates)
+    {
+        return;
+    }
+    auto const update = updates[updateIdx];
+    *static_cast<uint32_t*>(update.dst) = update.value;
+}
+
+void invokeScatterSlotParams(SlotParamUpdate const* updates, int numUpdates, cudaStream_t stream)
+{
+    if (numUpdates == 0)
+    {
+        return;
+    }
+    constexpr int THREADS_PER_CTA = 256;
+    dim3 grid(divUp(numUpdates, THREADS_PER_CTA));
+    scatterSlotParamsKernel<<<grid, THREADS_PER_CTA, 0, stream>>>(updates, numUpdates);
+}
+
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -17,8 +17,8 @@
 #pragma once
 
 #include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/kernels/philoxRandom.h"
 #include <cstdint>
-#include <curand_kernel.h>
 
 namespace tensorrt_llm
 {
@@ -161,25 +161,27 @@ static_assert(FinishedState::finishedEOS().isFinishedEOS());
 static_assert(FinishedState::finishedStopWords().isFinishedStopWords());
 static_assert(FinishedState::finishedMaxLength().isFinishedMaxLength());
 
-//! \brief Initialize batchSize curand states with given seed.
+//! \brief Initialize batchSize random states with given seed. Only writes the seed, the generator is counter based.
 //!
-//! \param state output buffer [maxBatchSize]. Curand states to be initialized
+//! \param state output buffer [maxBatchSize]. Random states to be initialized
 //! \param batchSlots input buffer[batchSize], optional. Indices of rows of data in memory pool
 //! \param batchSize number of states to initialize
 //! \param randomSeed seed to initialize states
 //! \param stream stream
-void invokeCurandInitialize(
-    curandState_t* state, int const* batchSlots, const size_t batchSize, uint64_t randomSeed, cudaStream_t stream);
+void invokeRandomStateInitialize(
+    RandomState* state, int const* batchSlots, const size_t batchSize, uint64_t randomSeed, cudaStream_t stream);
 
-//! \brief Initialize batchSize curand states with given seed per request.
+//! \brief Initialize batchSize random states with given seed per request.
 //!
-//! \param state output buffer [maxBatchSize] of curand states to be initialized
+//! \param state output buffer [maxBatchSize] of random states to be initialized
 //! \param batchSlots input buffer[batchSize], optional. Indices of rows of data in memory pool
 //! \param batchSize number of states to initialize
 //! \param randomSeeds input buffer [maxBatchSize] with seeds
 //! \param stream stream
-void invokeCurandBatchInitialize(curandState_t* states, int const* batchSlots, const size_t batchSize,
-    uint64_t const* randomSeeds, cudaStream_t stream);
+//! \param randomSteps input buffer [maxBatchSize], optional. Steps the states start at, to resume the random stream
+//! of a request that drew numbers elsewhere before, e.g. on the executor it was migrated from. 0 if nullptr
+void invokeRandomStateBatchInitialize(RandomState* states, int const* batchSlots, const size_t batchSize,
+    uint64_t const* randomSeeds, cudaStream_t stream, uint64_t const* randomSteps = nullptr);
 
 //! \brief Applies mask, adds bias to logits and computes softmax values.
 //! Sets -MAX_FLT value for tokens in range [vocabSize; vocabSizePadded) to prevent them from being chosen.
@@ -220,5 +222,21 @@ void invokeAddBiasSoftMax(T* logits, T** logitsPtrs, T* probs, T const* bias, in
 template <typename T>
 void invokeScatterDecodingParams(T const* src, T* dst, int const* batchSlots, int batchSize, cudaStream_t stream);
 
+//! \brief Single update of a 4-byte per-slot decoding parameter, already resolved to its destination address
+struct SlotParamUpdate
+{
+    //! Address of the parameter of one slot in a device array
+    void* dst;
+    //! New value, bit-copied from float or int32_t
+    uint32_t value;
+};
+
+//! \brief Applies a packed list of per-slot parameter updates, possibly targeting different parameter arrays
+//!
+//! \param updates input buffer [numUpdates] on device
+//! \param numUpdates number of updates
+//! \param stream stream
+void invokeScatterSlotParams(SlotParamUpdate const* updates, int numUpdates, cudaStream_t stream);
+
 } // namespace kernels
 } // namespace tensorrt_llm
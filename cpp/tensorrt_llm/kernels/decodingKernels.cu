@@ -382,11 +382,101 @@ __global__ void insertUnfinishedPathKernel(BeamHypotheses bh)
     }
 }
 
+__global__ void insertUnfinishedPathFromBeamPathsKernel(BeamHypotheses bh)
+{
+    // Same as insertUnfinishedPathKernel, but the paths are ready in bh.pathIds and only need a copy
+    int const bid = blockIdx.x; // Index of Batch
+    int const tid = threadIdx.x;
+    int const nBM{bh.nBeamWidth};
+    int const nMBS{bh.nMaxBatchSize}; // Only for bh.logProbsTiled
+    int const nMSL{bh.nMaxSeqLen};
+    bool const bOutputLogProbs{bh.logProbsCBA != nullptr && bh.logProbsTiled != nullptr};
+    int const indexDstStart{bh.numBeamsCBA[bid]};
+
+    if (bh.batchDones[bid])
+    {
+        return;
+    }
+
+    for (int i = 0; i < nBM; ++i)
+    {
+        int const srcBeam = bid * nBM + i;
+        int const dstBeam = bid * nBM * 2 + i + indexDstStart;
+        int const step = bh.sequenceLengths[srcBeam] - 1;
+
+        for (int j = tid; j <= step; j += blockDim.x)
+        {
+            bh.outputIdsCBA[dstBeam * nMSL + j] = bh.pathIds[srcBeam * nMSL + j];
+            if (bOutputLogProbs)
+            {
+                int const prevId = bh.pathBeams[srcBeam * nMSL + j];
+                bh.logProbsCBA[dstBeam * nMSL + j] = bh.logProbsTiled[j * nMBS * nBM + bid * nBM + prevId];
+            }
+        }
+        if (tid == 0)
+        {
+            bh.sequenceLengthsCBA[dstBeam] = bh.sequenceLengths[srcBeam];
+            bh.normedScoresCBA[dstBeam] = applyLengthPenalty(
+                bh.cumLogProbs[srcBeam], step - bh.inputLengths[srcBeam] + 1, bh.lengthPenalties[bid]);
+            bh.cumLogProbsCBA[dstBeam] = bh.cumLogProbs[srcBeam];
+        }
+    }
+    if (tid == 0)
+    {
+        bh.numBeamsCBA[bid] += nBM;
+    }
+}
+
 void invokeInsertUnfinishedPath(BeamHypotheses& bh, cudaStream_t stream)
 {
+    if (bh.pathIds != nullptr)
+    {
+        insertUnfinishedPathFromBeamPathsKernel<<<bh.nBatchSize, 256, 0, stream>>>(bh);
+        return;
+    }
     insertUnfinishedPathKernel<<<bh.nBatchSize, 1, 0, stream>>>(bh);
 }
 
+__global__ void updateBeamPathsKernel(BeamHypotheses bh)
+{
+    int const bid = blockIdx.x;   // Index of Batch
+    int const beam = threadIdx.x; // Index of Beam
+    int const nBM{bh.nBeamWidth};
+    int const nMSL{bh.nMaxSeqLen};
+    if (beam >= nBM)
+    {
+        return;
+    }
+
+    int const indexBatchBeam = bid * nBM + beam;
+    int const step = bh.sequenceLengths[indexBatchBeam] - 1;
+    int const nUpToDate = bh.pathLengths[indexBatchBeam];
+    int* pathIds = bh.pathIds + indexBatchBeam * nMSL;
+    int* pathBeams = bh.pathBeams + indexBatchBeam * nMSL;
+
+    int prevId = beam;
+    for (int j = step; j >= 0; --j)
+    {
+        if (j < nUpToDate && pathBeams[j] == prevId)
+        {
+            // Joined the previous path, the steps before are unchanged
+            break;
+        }
+        int const index = bid * nBM * nMSL + prevId * nMSL + j;
+        pathIds[j] = bh.outputIdsUnfinish[index];
+        pathBeams[j] = prevId;
+        prevId = bh.parentIdsUnfinish[index];
+    }
+    bh.pathLengths[indexBatchBeam] = step + 1;
+}
+
+void invokeUpdateBeamPaths(BeamHypotheses& bh, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(bh.pathIds != nullptr && bh.pathBeams != nullptr && bh.pathLengths != nullptr,
+        "Beam paths are not allocated.");
+    updateBeamPathsKernel<<<bh.nBatchSize, bh.nBeamWidth, 0, stream>>>(bh);
+}
+
 __global__ void finalizeKernel(BeamHypotheses bh)
 {
     // Do index sort on bh.normedScoresCBA, then move buffers from CBA to output by the order of index
@@ -638,6 +728,26 @@ void invokeInitializeOutput(TokenIdType* finalOutputIds, TokenIdType const* endI
     initializeOutput<<<batchBeam, 256, 0, stream>>>(finalOutputIds, endIds, nMaxSeqLen);
 }
 
+__global__ void fillBatchPtrs(void** ptrs, void const* base, std::size_t strideBytes, SizeType32 const* dstSlots,
+    SizeType32 const* srcSlots, SizeType32 batchSize)
+{
+    for (auto bi = static_cast<SizeType32>(blockIdx.x * blockDim.x + threadIdx.x); bi < batchSize;
+         bi += static_cast<SizeType32>(blockDim.x * gridDim.x))
+    {
+        auto const dst = dstSlots == nullptr ? bi : dstSlots[bi];
+        auto const src = srcSlots == nullptr ? bi : srcSlots[bi];
+        ptrs[dst] = const_cast<char*>(static_cast<char const*>(base)) + src * strideBytes;
+    }
+}
+
+void invokeFillBatchPtrs(void** ptrs, void const* base, std::size_t strideBytes, SizeType32 const* dstSlots,
+    SizeType32 const* srcSlots, SizeType32 batchSize, cudaStream_t stream)
+{
+    SizeType32 const blockSize{256};
+    fillBatchPtrs<<<divUp(batchSize, blockSize), blockSize, 0, stream>>>(
+        ptrs, base, strideBytes, dstSlots, srcSlots, batchSize);
+}
+
 __global__ void copyNextStepIds(TokenIdType* nextStepIds, TokenIdType const* const* outputIdsPtr,
     SizeType32 const* sequenceLengths, SizeType32 const* numNewTokens, SizeType32 const* batchSlots,
     SizeType32 batchSize, SizeType32 maxBatchSize, SizeType32 beamWidth, SizeType32 maxSeqLen,
@@ -789,6 +899,14 @@ void gatherTree(DecodingOutput const& decodingOutput, DecodingInput const& decod
     bh.finished = bufferCast<tensorrt_llm::kernels::FinishedState>(*decodingOutput.finishReasons);
     bh.outputIdsUnfinish = bufferCast<TokenIdType>(*decodingOutput.ids);
     bh.parentIdsUnfinish = bufferCast<TokenIdType>(*decodingOutput.parentIds);
+    if (auto const& paths = decodingOutput.beamHypotheses; paths.pathIds && paths.pathIds->getSize() > 0)
+    {
+        bh.pathIds = bufferCast<TokenIdType>(*paths.pathIds);
+        bh.pathBeams = bufferCast<SizeType32>(*paths.pathBeams);
+        bh.pathLengths = bufferCast<SizeType32>(*paths.pathLengths);
+        tensorrt_llm::kernels::invokeUpdateBeamPaths(bh, stream);
+        sync_check_cuda_error();
+    }
 
     // This is where transpose is done
     tensorrt_llm::kernels::invokeInsertUnfinishedPath(bh, stream);
@@ -60,6 +60,15 @@ Do gatherTree on beam search to get final result.
 */
 void invokeGatherTree(gatherTreeParam param);
 
+//! \brief Bring the backtracked paths of the unfinished beams, bh.pathIds and bh.pathBeams, up to the current step.
+//! \details The path of a beam is walked back through bh.parentIdsUnfinish only until it joins the path it had at the
+//! previous update, since the history of a beam never changes once written. A step of beam search only rewrites the
+//! tail of the paths where the beams branched off, so the cost of an update is the number of changed tokens instead
+//! of the sequence length. Paths whose bh.pathLengths is 0 are walked in full.
+void invokeUpdateBeamPaths(BeamHypotheses& bh, cudaStream_t stream);
+
+//! \brief Move all unfinished beams to the CBA. With bh.pathIds set, the paths are copied from the up to date paths,
+//! see invokeUpdateBeamPaths, otherwise they are backtracked through bh.parentIdsUnfinish.
 void invokeInsertUnfinishedPath(BeamHypotheses& bh, cudaStream_t stream);
 
 void invokeFinalize(BeamHypotheses& bh, cudaStream_t stream);
@@ -112,6 +121,12 @@ void invokeCopyNextStepIds(runtime::TokenIdType* nextStepIds, runtime::TokenIdTy
     runtime::SizeType32 beamWidth, runtime::SizeType32 maxSeqLen, runtime::SizeType32 maxTokensPerStep,
     cudaStream_t stream);
 
+//! \brief Fill a table of pointers on the device, ptrs[dst] = base + src * strideBytes for every bi in [0, batchSize).
+//! dst is dstSlots[bi] and src is srcSlots[bi], or bi when the slots are nullptr. Unlike a table written on the host
+//! and copied every step, the kernel reads the current batch slots on the device and can be captured in a CUDA graph.
+void invokeFillBatchPtrs(void** ptrs, void const* base, std::size_t strideBytes, runtime::SizeType32 const* dstSlots,
+    runtime::SizeType32 const* srcSlots, runtime::SizeType32 batchSize, cudaStream_t stream);
+
 void invokeTransposeLogProbs(float* output_log_probs, float* output_log_probs_tiled,
     runtime::SizeType32 const* sequence_lengths, runtime::SizeType32 const* batchSlots, runtime::SizeType32 batch_size,
     runtime::SizeType32 max_batch_size, runtime::SizeType32 beam_width, runtime::SizeType32 max_seq_len,
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/fp8BlockScaleGemm.h"
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+// A CTA computes a 64x64 tile of D with 2x2 warps of 32x32 and consumes one scale group of k per iteration.
+constexpr int kTileM = 64;
+constexpr int kTileN = 64;
+constexpr int kTileK = kFp8BlockScaleGroupSize;
+constexpr int kThreads = 128;
+// Rows of 144 bytes spread the fragment loads of the 8 rows x 4 columns of a warp over all the smem banks.
+constexpr int kSmemStride = kTileK + 16;
+constexpr int kVecsPerRow = kTileK / 16;
+
+static_assert(kFp8BlockScaleGroupSize % kTileN == 0, "A CTA must not straddle two weight blocks");
+
+// The 16x8 fragments of the m16n8k32 MMA: thread (group = lane / 4, idInGroup = lane % 4) holds rows group and
+// group + 8 and columns 2 * idInGroup and 2 * idInGroup + 1 of the accumulator.
+using Fragments = float[2][4][4];
+
+__device__ inline void mmaTileGroup(
+    Fragments& acc, uint8_t const* smemA, uint8_t const* smemB, int warpRow, int warpCol, int lane)
+{
+    int const group = lane / 4;
+    int const idInGroup = lane % 4;
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 890
+#pragma unroll
+    for (int kk = 0; kk < kTileK; kk += 32)
+    {
+        uint32_t a[2][4];
+        uint32_t b[4][2];
+#pragma unroll
+        for (int mi = 0; mi < 2; ++mi)
+        {
+            auto const* base = smemA + (warpRow + mi * 16 + group) * kSmemStride + kk + idInGroup * 4;
+            a[mi][0] = *reinterpret_cast<uint32_t const*>(base);
+            a[mi][1] = *reinterpret_cast<uint32_t const*>(base + 8 * kSmemStride);
+            a[mi][2] = *reinterpret_cast<uint32_t const*>(base + 16);
+            a[mi][3] = *reinterpret_cast<uint32_t const*>(base + 8 * kSmemStride + 16);
+        }
+#pragma unroll
+        for (int ni = 0; ni < 4; ++ni)
+        {
+            auto const* base = smemB + (warpCol + ni * 8 + group) * kSmemStride + kk + idInGroup * 4;
+            b[ni][0] = *reinterpret_cast<uint32_t const*>(base);
+            b[ni][1] = *reinterpret_cast<uint32_t const*>(base + 16);
+        }
+#pragma unroll
+        for (int mi = 0; mi < 2; ++mi)
+        {
+#pragma unroll
+            for (int ni = 0; ni < 4; ++ni)
+            {
+                float* c = acc[mi][ni];
+                asm volatile(
+                    "mma.sync.aligned.m16n8k32.row.col.f32.e4m3.e4m3.f32 {%0, %1, %2, %3}, {%4, %5, %6, %7}, "
+                    "{%8, %9}, {%0, %1, %2, %3};\n"
+                    : "+f"(c[0]), "+f"(c[1]), "+f"(c[2]), "+f"(c[3])
+                    : "r"(a[mi][0]), "r"(a[mi][1]), "r"(a[mi][2]), "r"(a[mi][3]), "r"(b[ni][0]), "r"(b[ni][1]));
+            }
+        }
+    }
+#else
+    // Same fragment layout, computed with FMAs.
+    auto const* fp8A = reinterpret_cast<__nv_fp8_e4m3 const*>(smemA);
+    auto const* fp8B = reinterpret_cast<__nv_fp8_e4m3 const*>(smemB);
+    for (int mi = 0; mi < 2; ++mi)
+    {
+        for (int ni = 0; ni < 4; ++ni)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                int const row = warpRow + mi * 16 + group + (i / 2) * 8;
+                int const col = warpCol + ni * 8 + idInGroup * 2 + i % 2;
+                float sum = 0.f;
+                for (int kk = 0; kk < kTileK; ++kk)
+                {
+                    sum += static_cast<float>(fp8A[row * kSmemStride + kk])
+                        * static_cast<float>(fp8B[col * kSmemStride + kk]);
+                }
+                acc[mi][ni][i] += sum;
+            }
+        }
+    }
+#endif
+}
+
+template <typename T>
+__global__ void __launch_bounds__(kThreads) fp8BlockScaleGemmKernel(T* D, uint8_t const* A, float const* aScales,
+    uint8_t const* B, float const* bScales, int m, int n, int k)
+{
+    __shared__ __align__(16) uint8_t smemA[kTileM * kSmemStride];
+    __shared__ __align__(16) uint8_t smemB[kTileN * kSmemStride];
+
+    int const tileRow = blockIdx.y * kTileM;
+    int const tileCol = blockIdx.x * kTileN;
+    int const numGroups = k / kTileK;
+    int const warpIdx = threadIdx.x / 32;
+    int const lane = threadIdx.x % 32;
+    int const warpRow = (warpIdx / 2) * 32;
+    int const warpCol = (warpIdx % 2) * 32;
+    int const group = lane / 4;
+    int const idInGroup = lane % 4;
+
+    Fragments acc = {};
+    for (int g = 0; g < numGroups; ++g)
+    {
+        for (int i = threadIdx.x; i < kTileM * kVecsPerRow; i += kThreads)
+        {
+            int const r = i / kVecsPerRow;
+            int const c = (i % kVecsPerRow) * 16;
+            auto const offset = static_cast<size_t>(g) * kTileK + c;
+            uint4 aVec = make_uint4(0, 0, 0, 0);
+            uint4 bVec = make_uint4(0, 0, 0, 0);
+            if (tileRow + r < m)
+            {
+                aVec = *reinterpret_cast<uint4 const*>(A + static_cast<size_t>(tileRow + r) * k + offset);
+            }
+            if (tileCol + r < n)
+            {
+                bVec = *reinterpret_cast<uint4 const*>(B + static_cast<size_t>(tileCol + r) * k + offset);
+            }
+            *reinterpret_cast<uint4*>(smemA + r * kSmemStride + c) = aVec;
+            *reinterpret_cast<uint4*>(smemB + r * kSmemStride + c) = bVec;
+        }
+        __syncthreads();
+
+        // The scales change with every group, so the group is accumulated on its own before scaling.
+        Fragments partial = {};
+        mmaTileGroup(partial, smemA, smemB, warpRow, warpCol, lane);
+
+        float const bScale = bScales[(tileCol / kFp8BlockScaleGroupSize) * numGroups + g];
+#pragma unroll
+        for (int mi = 0; mi < 2; ++mi)
+        {
+            int const row = tileRow + warpRow + mi * 16 + group;
+            float const scale0 = row < m ? aScales[static_cast<size_t>(row) * numGroups + g] * bScale : 0.f;
+            float const scale1 = row + 8 < m ? aScales[static_cast<size_t>(row + 8) * numGroups + g] * bScale : 0.f;
+#pragma unroll
+            for (int ni = 0; ni < 4; ++ni)
+            {
+                acc[mi][ni][0] += partial[mi][ni][0] * scale0;
+                acc[mi][ni][1] += partial[mi][ni][1] * scale0;
+                acc[mi][ni][2] += partial[mi][ni][2] * scale1;
+                acc[mi][ni][3] += partial[mi][ni][3] * scale1;
+            }
+        }
+        __syncthreads();
+    }
+
+#pragma unroll
+    for (int mi = 0; mi < 2; ++mi)
+    {
+#pragma unroll
+        for (int ni = 0; ni < 4; ++ni)
+        {
+#pragma unroll
+            for (int i = 0; i < 4; ++i)
+            {
+                int const row = tileRow + warpRow + mi * 16 + group + (i / 2) * 8;
+                int const col = tileCol + warpCol + ni * 8 + idInGroup * 2 + i % 2;
+                if (row < m && col < n)
+                {
+                    D[static_cast<size_t>(row) * n + col] = cuda_cast<T>(acc[mi][ni][i]);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+template <typename T>
+void invokeFp8BlockScaleGemm(T* D, __nv_fp8_e4m3 const* A, float const* aScales, __nv_fp8_e4m3 const* B,
+    float const* bScales, int m, int n, int k, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(k > 0 && k % kFp8BlockScaleGroupSize == 0,
+        "The block-scaled fp8 GEMM needs k (%d) to be a multiple of %d.", k, kFp8BlockScaleGroupSize);
+    if (m == 0 || n == 0)
+    {
+        return;
+    }
+    dim3 const grid((n + kTileN - 1) / kTileN, (m + kTileM - 1) / kTileM);
+    fp8BlockScaleGemmKernel<T><<<grid, kThreads, 0, stream>>>(D, reinterpret_cast<uint8_t const*>(A), aScales,
+        reinterpret_cast<uint8_t const*>(B), bScales, m, n, k);
+    sync_check_cuda_error();
+}
+
+template void invokeFp8BlockScaleGemm<float>(float* D, __nv_fp8_e4m3 const* A, float const* aScales,
+    __nv_fp8_e4m3 const* B, float const* bScales, int m, int n, int k, cudaStream_t stream);
+template void invokeFp8BlockScaleGemm<half>(half* D, __nv_fp8_e4m3 const* A, float const* aScales,
+    __nv_fp8_e4m3 const* B, float const* bScales, int m, int n, int k, cudaStream_t stream);
+#ifdef ENABLE_BF16
+template void invokeFp8BlockScaleGemm<__nv_bfloat16>(__nv_bfloat16* D, __nv_fp8_e4m3 const* A, float const* aScales,
+    __nv_fp8_e4m3 const* B, float const* bScales, int m, int n, int k, cudaStream_t stream);
+#endif
+
+} // namespace kernels
+} // namespace tensorrt_llm
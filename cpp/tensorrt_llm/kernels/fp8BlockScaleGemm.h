@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cuda_fp8.h>
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+// Both the activation groups and the weight blocks of the block-scaled fp8 GEMM span 128 elements.
+static constexpr int kFp8BlockScaleGroupSize = 128;
+
+//! \brief D[m, n] = sum over the k groups g of (A[:, g] * B[:, g]^T) * aScales[m, g] * bScales[n / 128, g].
+//!
+//! \param D [m, n] row-major output.
+//! \param A [m, k] row-major e4m3 activations, quantized per 128 columns of a row by invokePerTokenGroupQuantization.
+//! \param aScales [m, k / 128] dequantization scales of the activation groups.
+//! \param B [n, k] e4m3 weights, k contiguous like the weights of the fp8 rowwise GEMM.
+//! \param bScales [ceil(n / 128), k / 128] dequantization scales of the 128x128 weight blocks.
+//!
+//! k must be a multiple of 128. Uses the fp8 tensor cores on SM89 and newer and fp32 FMAs on older GPUs.
+template <typename T>
+void invokeFp8BlockScaleGemm(T* D, __nv_fp8_e4m3 const* A, float const* aScales, __nv_fp8_e4m3 const* B,
+    float const* bScales, int m, int n, int k, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
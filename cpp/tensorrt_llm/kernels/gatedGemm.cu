@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/gatedGemm.h"
+
+#include <type_traits>
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+// A CTA computes a 64x64 tile of D, that is 64 columns of both the up and the gate projections, with 2x2 warps of
+// 32x32 and 64 bytes of k per iteration. The tiles are laid out in bytes: the fragments of the 16-bit m16n8k16 MMA
+// and of the 8-bit m16n8k32 MMA take the same bytes, so all the input types share the loads.
+constexpr int kTileM = 64;
+constexpr int kTileN = 64;
+constexpr int kTileKBytes = 64;
+constexpr int kThreads = 128;
+// Rows of 80 bytes spread the fragment loads of the 8 rows x 4 columns of a warp over all the smem banks.
+constexpr int kSmemStride = kTileKBytes + 16;
+constexpr int kVecsPerRow = kTileKBytes / 16;
+
+static_assert(kTileM == kTileN, "A, the up and the gate tiles are loaded by the same loop");
+
+template <typename InT>
+using AccType = std::conditional_t<std::is_same_v<InT, int8_t>, int32_t, float>;
+
+template <typename InT>
+using Fragments = AccType<InT>[2][4][4];
+
+template <typename InT>
+__device__ constexpr bool hasMma()
+{
+#if defined(__CUDA_ARCH__)
+    return __CUDA_ARCH__ >= (std::is_same_v<InT, __nv_fp8_e4m3> ? 890 : 800);
+#else
+    return false;
+#endif
+}
+
+template <typename InT>
+__device__ inline AccType<InT> toAcc(InT val)
+{
+    if constexpr (std::is_same_v<InT, int8_t>)
+    {
+        return static_cast<int32_t>(val);
+    }
+    else
+    {
+        return cuda_cast<float>(val);
+    }
+}
+
+template <typename InT>
+__device__ inline void mma(AccType<InT>* c, uint32_t const (&a)[4], uint32_t const (&b)[2])
+{
+    if constexpr (std::is_same_v<InT, half>)
+    {
+        asm volatile(
+            "mma.sync.aligned.m16n8k16.row.col.f32.f16.f16.f32 {%0, %1, %2, %3}, {%4, %5, %6, %7}, {%8, %9}, "
+            "{%0, %1, %2, %3};\n"
+            : "+f"(c[0]), "+f"(c[1]), "+f"(c[2]), "+f"(c[3])
+            : "r"(a[0]), "r"(a[1]), "r"(a[2]), "r"(a[3]), "r"(b[0]), "r"(b[1]));
+    }
+#ifdef ENABLE_BF16
+    else if constexpr (std::is_same_v<InT, __nv_bfloat16>)
+    {
+        asm volatile(
+            "mma.sync.aligned.m16n8k16.row.col.f32.bf16.bf16.f32 {%0, %1, %2, %3}, {%4, %5, %6, %7}, {%8, %9}, "
+            "{%0, %1, %2, %3};\n"
+            : "+f"(c[0]), "+f"(c[1]), "+f"(c[2]), "+f"(c[3])
+            : "r"(a[0]), "r"(a[1]), "r"(a[2]), "r"(a[3]), "r"(b[0]), "r"(b[1]));
+    }
+#endif
+#ifdef ENABLE_FP8
+    else if constexpr (std::is_same_v<InT, __nv_fp8_e4m3>)
+    {
+        asm volatile(
+            "mma.sync.aligned.m16n8k32.row.col.f32.e4m3.e4m3.f32 {%0, %1, %2, %3}, {%4, %5, %6, %7}, {%8, %9}, "
+            "{%0, %1, %2, %3};\n"
+            : "+f"(c[0]), "+f"(c[1]), "+f"(c[2]), "+f"(c[3])
+            : "r"(a[0]), "r"(a[1]), "r"(a[2]), "r"(a[3]), "r"(b[0]), "r"(b[1]));
+    }
+#endif
+    else
+    {
+        static_assert(std::is_same_v<InT, int8_t>, "Unsupported input type");
+        asm volatile(
+            "mma.sync.aligned.m16n8k32.row.col.s32.s8.s8.s32 {%0, %1, %2, %3}, {%4, %5, %6, %7}, {%8, %9}, "
+            "{%0, %1, %2, %3};\n"
+            : "+r"(c[0]), "+r"(c[1]), "+r"(c[2]), "+r"(c[3])
+            : "r"(a[0]), "r"(a[1]), "r"(a[2]), "r"(a[3]), "r"(b[0]), "r"(b[1]));
+    }
+}
+
+// The 16x8 fragments of the MMAs: thread (group = lane / 4, idInGroup = lane % 4) holds rows group and group + 8 and
+// columns 2 * idInGroup and 2 * idInGroup + 1 of the accumulator.
+template <typename InT>
+__device__ inline void mmaTile(
+    Fragments<InT>& acc, uint8_t const* smemA, uint8_t const* smemB, int warpRow, int warpCol, int lane)
+{
+    int const group = lane / 4;
+    int const idInGroup = lane % 4;
+    if constexpr (hasMma<InT>())
+    {
+#pragma unroll
+        for (int kk = 0; kk < kTileKBytes; kk += 32)
+        {
+            uint32_t a[2][4];
+            uint32_t b[4][2];
+#pragma unroll
+            for (int mi = 0; mi < 2; ++mi)
+            {
+                auto const* base = smemA + (warpRow + mi * 16 + group) * kSmemStride + kk + idInGroup * 4;
+                a[mi][0] = *reinterpret_cast<uint32_t const*>(base);
+                a[mi][1] = *reinterpret_cast<uint32_t const*>(base + 8 * kSmemStride);
+                a[mi][2] = *reinterpret_cast<uint32_t const*>(base + 16);
+                a[mi][3] = *reinterpret_cast<uint32_t const*>(base + 8 * kSmemStride + 16);
+            }
+#pragma unroll
+            for (int ni = 0; ni < 4; ++ni)
+            {
+                auto const* base = smemB + (warpCol + ni * 8 + group) * kSmemStride + kk + idInGroup * 4;
+                b[ni][0] = *reinterpret_cast<uint32_t const*>(base);
+                b[ni][1] = *reinterpret_cast<uint32_t const*>(base + 16);
+            }
+#pragma unroll
+            for (int mi = 0; mi < 2; ++mi)
+            {
+#pragma unroll
+                for (int ni = 0; ni < 4; ++ni)
+                {
+                    mma<InT>(acc[mi][ni], a[mi], b[ni]);
+                }
+            }
+        }
+    }
+    else
+    {
+        // Same fragment layout, computed with FMAs.
+        constexpr int kStride = kSmemStride / sizeof(InT);
+        constexpr int kTileK = kTileKBytes / sizeof(InT);
+        auto const* typedA = reinterpret_cast<InT const*>(smemA);
+        auto const* typedB = reinterpret_cast<InT const*>(smemB);
+        for (int mi = 0; mi < 2; ++mi)
+        {
+            for (int ni = 0; ni < 4; ++ni)
+            {
+                for (int i = 0; i < 4; ++i)
+                {
+                    int const row = warpRow + mi * 16 + group + (i / 2) * 8;
+                    int const col = warpCol + ni * 8 + idInGroup * 2 + i % 2;
+                    AccType<InT> sum = 0;
+                    for (int kk = 0; kk < kTileK; ++kk)
+                    {
+                        sum += toAcc(typedA[row * kStride + kk]) * toAcc(typedB[col * kStride + kk]);
+                    }
+                    acc[mi][ni][i] += sum;
+                }
+            }
+        }
+    }
+}
+
+template <typename InT, typename OutT>
+__global__ void __launch_bounds__(kThreads) gatedGemmKernel(OutT* D, uint8_t const* A, uint8_t const* B,
+    OutT const* bias, float const* tokenScales, float const* channelScales, int m, int n, int k, float scaleD0,
+    float scaleD1, float scaleOutput, GatedActivationType activation)
+{
+    __shared__ __align__(16) uint8_t smemA[kTileM * kSmemStride];
+    __shared__ __align__(16) uint8_t smemUp[kTileN * kSmemStride];
+    __shared__ __align__(16) uint8_t smemGate[kTileN * kSmemStride];
+
+    int const halfN = n / 2;
+    auto const rowBytes = static_cast<size_t>(k) * sizeof(InT);
+    int const tileRow = blockIdx.y * kTileM;
+    int const tileCol = blockIdx.x * kTileN;
+    int const warpIdx = threadIdx.x / 32;
+    int const lane = threadIdx.x % 32;
+    int const warpRow = (warpIdx / 2) * 32;
+    int const warpCol = (warpIdx % 2) * 32;
+    int const group = lane / 4;
+    int const idInGroup = lane % 4;
+
+    Fragments<InT> up = {};
+    Fragments<InT> gate = {};
+    for (size_t kBytes = 0; kBytes < rowBytes; kBytes += kTileKBytes)
+    {
+        for (int i = threadIdx.x; i < kTileM * kVecsPerRow; i += kThreads)
+        {
+            int const r = i / kVecsPerRow;
+            int const c = (i % kVecsPerRow) * 16;
+            bool const inK = kBytes + c < rowBytes;
+            uint4 aVec = make_uint4(0, 0, 0, 0);
+            uint4 upVec = make_uint4(0, 0, 0, 0);
+            uint4 gateVec = make_uint4(0, 0, 0, 0);
+            if (inK && tileRow + r < m)
+            {
+                aVec = *reinterpret_cast<uint4 const*>(A + (tileRow + r) * rowBytes + kBytes + c);
+            }
+            if (inK && tileCol + r < halfN)
+            {
+                upVec = *reinterpret_cast<uint4 const*>(B + (tileCol + r) * rowBytes + kBytes + c);
+                gateVec = *reinterpret_cast<uint4 const*>(B + (halfN + tileCol + r) * rowBytes + kBytes + c);
+            }
+            *reinterpret_cast<uint4*>(smemA + r * kSmemStride + c) = aVec;
+            *reinterpret_cast<uint4*>(smemUp + r * kSmemStride + c) = upVec;
+            *reinterpret_cast<uint4*>(smemGate + r * kSmemStride + c) = gateVec;
+        }
+        __syncthreads();
+
+        mmaTile<InT>(up, smemA, smemUp, warpRow, warpCol, lane);
+        mmaTile<InT>(gate, smemA, smemGate, warpRow, warpCol, lane);
+        __syncthreads();
+    }
+
+#pragma unroll
+    for (int mi = 0; mi < 2; ++mi)
+    {
+#pragma unroll
+        for (int ni = 0; ni < 4; ++ni)
+        {
+#pragma unroll
+            for (int i = 0; i < 4; ++i)
+            {
+                int const row = tileRow + warpRow + mi * 16 + group + (i / 2) * 8;
+                int const col = tileCol + warpCol + ni * 8 + idInGroup * 2 + i % 2;
+                if (row >= m || col >= halfN)
+                {
+                    continue;
+                }
+                float const tokenScale = tokenScales != nullptr ? tokenScales[row] : 1.f;
+                float upValue = static_cast<float>(up[mi][ni][i]) * scaleD0 * tokenScale;
+                float gateValue = static_cast<float>(gate[mi][ni][i]) * scaleD1 * tokenScale;
+                if (channelScales != nullptr)
+                {
+                    upValue *= channelScales[col];
+                    gateValue *= channelScales[halfN + col];
+                }
+                if (bias != nullptr)
+                {
+                    upValue += cuda_cast<float>(bias[col]);
+                    gateValue += cuda_cast<float>(bias[halfN + col]);
+                }
+                float const activated = activation == GatedActivationType::kSWIGLU
+                    ? gateValue / (1.f + __expf(-gateValue))
+                    : 0.5f * gateValue * (1.f + erff(gateValue * 0.70710678f));
+                D[static_cast<size_t>(row) * halfN + col] = cuda_cast<OutT>(scaleOutput * upValue * activated);
+            }
+        }
+    }
+}
+
+} // namespace
+
+template <typename InT, typename OutT>
+void invokeGatedGemm(OutT* D, InT const* A, InT const* B, OutT const* bias, float const* tokenScales,
+    float const* channelScales, int m, int n, int k, float scaleD0, float scaleD1, float scaleOutput,
+    GatedActivationType activation, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(n % 2 == 0, "The gated GEMM needs an even number of out channels (%d).", n);
+    TLLM_CHECK_WITH_INFO(k > 0 && (k * sizeof(InT)) % 16 == 0,
+        "The gated GEMM needs rows of 16-byte multiples, got k = %d.", k);
+    if (m == 0 || n == 0)
+    {
+        return;
+    }
+    dim3 const grid((n / 2 + kTileN - 1) / kTileN, (m + kTileM - 1) / kTileM);
+    gatedGemmKernel<InT, OutT><<<grid, kThreads, 0, stream>>>(D, reinterpret_cast<uint8_t const*>(A),
+        reinterpret_cast<uint8_t const*>(B), bias, tokenScales, channelScales, m, n, k, scaleD0, scaleD1, scaleOutput,
+        activation);
+    sync_check_cuda_error();
+}
+
+#define INSTANTIATE_GATED_GEMM(InT, OutT)                                                                              \
+    template void invokeGatedGemm<InT, OutT>(OutT * D, InT const* A, InT const* B, OutT const* bias,                   \
+        float const* tokenScales, float const* channelScales, int m, int n, int k, float scaleD0, float scaleD1,       \
+        float scaleOutput, GatedActivationType activation, cudaStream_t stream)
+
+INSTANTIATE_GATED_GEMM(half, half);
+INSTANTIATE_GATED_GEMM(int8_t, half);
+#ifdef ENABLE_BF16
+INSTANTIATE_GATED_GEMM(__nv_bfloat16, __nv_bfloat16);
+INSTANTIATE_GATED_GEMM(int8_t, __nv_bfloat16);
+#endif
+#ifdef ENABLE_FP8
+INSTANTIATE_GATED_GEMM(__nv_fp8_e4m3, __nv_fp8_e4m3);
+#endif
+
+#undef INSTANTIATE_GATED_GEMM
+
+} // namespace kernels
+} // namespace tensorrt_llm
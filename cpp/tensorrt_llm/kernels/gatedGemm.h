@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+enum class GatedActivationType
+{
+    kSWIGLU = 0,
+    kGEGLU = 1,
+};
+
+//! \brief The gated MLP projection in one GEMM: the up and gate projections share the tiles of A and the activation
+//! is applied before the output is written, so the [m, n] output of the two projections never goes to memory.
+//!
+//! D[i, j] = scaleOutput * (scaleD0 * s(i, j) * up[i, j] + bias[j]) * act(scaleD1 * s(i, j') * gate[i, j] + bias[j'])
+//! with up = A * B[0, n/2)^T, gate = A * B[n/2, n)^T, j' = n/2 + j and s(i, j) = tokenScales[i] * channelScales[j],
+//! the order of the halves of the fp8 CUTLASS fused gated GEMM.
+//!
+//! \param D [m, n / 2] row-major output.
+//! \param A [m, k] row-major activations, fp16, bf16, e4m3 or int8.
+//! \param B [n, k] weights of the up projection followed by those of the gate projection, k contiguous.
+//! \param bias Optional [n] bias, added after scaling.
+//! \param tokenScales Optional [m] per-token scales, for SmoothQuant int8 activations.
+//! \param channelScales Optional [n] per-channel scales, for SmoothQuant int8 weights.
+//! \param activation SiLU for SwiGLU, the erf GELU for GeGLU.
+//!
+//! Uses the mma.sync tensor cores on SM80 and newer, SM89 for e4m3, and FMAs on older GPUs. The rows of A and B must
+//! be multiples of 16 bytes.
+template <typename InT, typename OutT>
+void invokeGatedGemm(OutT* D, InT const* A, InT const* B, OutT const* bias, float const* tokenScales,
+    float const* channelScales, int m, int n, int k, float scaleD0, float scaleD1, float scaleOutput,
+    GatedActivationType activation, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
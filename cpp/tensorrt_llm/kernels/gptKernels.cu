@@ -21,6 +21,7 @@
 #include "tensorrt_llm/common/reduceKernelUtils.cuh"
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttentionUtils.h"
 #include "tensorrt_llm/kernels/gptKernels.h"
+#include "tensorrt_llm/kernels/rotaryScalingUtils.h"
 #include <cub/cub.cuh>
 
 using namespace tensorrt_llm::common;
@@ -210,21 +211,46 @@ __global__ __launch_bounds__(THREADS_PER_BLOCK) void computeSeqAndPaddingOffsets
     int halfRotaryEmbeddingDim = params.rotaryEmbeddingDim / 2;
     if (params.rotaryEmbeddingDim > 0 && zid < params.rotaryEmbeddingDim)
     {
-        mmha::update_rotary_base_n_scale(params.rotaryEmbeddingBase, params.rotaryEmbeddingScale,
-            params.rotaryScalingType, params.rotaryEmbeddingDim, params.rotaryEmbeddingMaxPositions,
-            params.seqKVLengths[batchIdx]);
-        // Recompute the rotary scales when it is dynamic scaling.
-        if (params.rotaryScalingType == RotaryScalingType::kDYNAMIC || params.rotaryEmbeddingInvFreqCache == nullptr)
+        int const seqKVLength = params.seqKVLengths[batchIdx];
+        float invFreq;
+        float mscale = 1.f;
+        if (params.rotaryScalingType == RotaryScalingType::kYARN)
         {
-            float const invFreq = params.rotaryEmbeddingScale
-                / powf(params.rotaryEmbeddingBase, zid / (float) params.rotaryEmbeddingDim);
-            params.rotaryEmbeddingInvFreq[batchIdx * halfRotaryEmbeddingDim + threadIdx.x] = invFreq;
+            float const scale = getDynamicRotaryScale(
+                seqKVLength, params.rotaryEmbeddingOriginalMaxPositions, params.rotaryEmbeddingScale);
+            invFreq = getYarnInvFreq(threadIdx.x, params.rotaryEmbeddingDim, params.rotaryEmbeddingBase, scale,
+                params.rotaryEmbeddingOriginalMaxPositions);
+            mscale = getYarnMscale(scale);
+        }
+        else if (params.rotaryEmbeddingLongInvFreqCache != nullptr)
+        {
+            // LongRoPE switches from the short to the long factors past the original context.
+            bool const useLongFactors = seqKVLength > params.rotaryEmbeddingOriginalMaxPositions;
+            invFreq = useLongFactors ? params.rotaryEmbeddingLongInvFreqCache[threadIdx.x]
+                                     : params.rotaryEmbeddingInvFreqCache[threadIdx.x];
+            mscale = useLongFactors ? params.rotaryEmbeddingLongMscale : params.rotaryEmbeddingShortMscale;
         }
         else
         {
-            // Otherwise, expand the inv freq cache to batch size.
-            float const invFreqCache = params.rotaryEmbeddingInvFreqCache[threadIdx.x];
-            params.rotaryEmbeddingInvFreq[batchIdx * halfRotaryEmbeddingDim + threadIdx.x] = invFreqCache;
+            mmha::update_rotary_base_n_scale(params.rotaryEmbeddingBase, params.rotaryEmbeddingScale,
+                params.rotaryScalingType, params.rotaryEmbeddingDim, params.rotaryEmbeddingMaxPositions, seqKVLength);
+            // Recompute the rotary scales when it is dynamic scaling.
+            if (params.rotaryScalingType == RotaryScalingType::kDYNAMIC
+                || params.rotaryEmbeddingInvFreqCache == nullptr)
+            {
+                invFreq = params.rotaryEmbeddingScale
+                    / powf(params.rotaryEmbeddingBase, zid / (float) params.rotaryEmbeddingDim);
+            }
+            else
+            {
+                // Otherwise, expand the inv freq cache to batch size.
+                invFreq = params.rotaryEmbeddingInvFreqCache[threadIdx.x];
+            }
+        }
+        params.rotaryEmbeddingInvFreq[batchIdx * halfRotaryEmbeddingDim + threadIdx.x] = invFreq;
+        if (params.rotaryEmbeddingMscale != nullptr && threadIdx.x == 0)
+        {
+            params.rotaryEmbeddingMscale[batchIdx] = mscale;
         }
     }
 
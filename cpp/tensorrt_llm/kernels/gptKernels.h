@@ -65,7 +65,9 @@ enum class RotaryScalingType : int8_t
     kLINEAR = 1,
     kDYNAMIC = 2,
     kLONG = 3,
-    kLLAMA3 = 4
+    kLLAMA3 = 4,
+    // YaRN with a scale chosen per request from its length, see rotaryScalingUtils.h.
+    kYARN = 5
 };
 
 struct BlockSparseParams
@@ -163,6 +165,15 @@ struct BuildDecoderInfoParams
     float2* rotaryEmbeddingCoeffCache;
     // Dynamic scaling;
     int rotaryEmbeddingMaxPositions;
+    // LongRoPE: the inv_freq of the long factors with shape [halfRotaryDim], used by the sequences longer than
+    // rotaryEmbeddingOriginalMaxPositions instead of rotaryEmbeddingInvFreqCache. Optional.
+    float const* rotaryEmbeddingLongInvFreqCache;
+    float rotaryEmbeddingShortMscale;
+    float rotaryEmbeddingLongMscale;
+    // YaRN and LongRoPE: the context length the model was trained with.
+    int rotaryEmbeddingOriginalMaxPositions;
+    // The magnitude scale of the cos/sin of each sequence with shape [batchSize]. Optional.
+    float* rotaryEmbeddingMscale;
 
     std::string toString() const
     {
@@ -206,6 +217,11 @@ struct BuildDecoderInfoParams
         ss << "rotaryEmbeddingInvFreqCache: " << rotaryEmbeddingInvFreqCache << std::endl;
         ss << "rotaryEmbeddingCoeffCache: " << rotaryEmbeddingCoeffCache << std::endl;
         ss << "rotaryEmbeddingMaxPositions: " << rotaryEmbeddingMaxPositions << std::endl;
+        ss << "rotaryEmbeddingLongInvFreqCache: " << rotaryEmbeddingLongInvFreqCache << std::endl;
+        ss << "rotaryEmbeddingShortMscale: " << rotaryEmbeddingShortMscale << std::endl;
+        ss << "rotaryEmbeddingLongMscale: " << rotaryEmbeddingLongMscale << std::endl;
+        ss << "rotaryEmbeddingOriginalMaxPositions: " << rotaryEmbeddingOriginalMaxPositions << std::endl;
+        ss << "rotaryEmbeddingMscale: " << rotaryEmbeddingMscale << std::endl;
 
         return ss.str();
     }
@@ -0,0 +1,469 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/gqaGenerationAttention.h"
+
+#include <type_traits>
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+// A CTA attends the query heads [16 * headTile, 16 * headTile + 16) of a KV head, the M of the m16n8k16 MMAs. Its
+// warps walk the KV range of the split in tiles of 16 tokens, tile w, w + 4, ... for warp w, each with an online
+// softmax of its own, and the 4 states are merged through shared memory at the end.
+constexpr int kNumWarps = 4;
+constexpr int kThreads = kNumWarps * 32;
+constexpr int kHeadsPerCta = 16;
+constexpr int kTileTokens = 16;
+constexpr int kMaxHeadSize = 256;
+// Elements per 16-byte vector, the unit of all the global and shared memory copies.
+constexpr int kVecSize = 8;
+// Rows padded by 16 bytes spread the fragment loads of the 8 rows x 4 columns of a warp over all the smem banks.
+constexpr int kSmemPad = kVecSize;
+
+static_assert(kHeadsPerCta == kTileTokens, "The K/V tile and the query rows share the smem row count");
+
+//! Partial softmax states of the splits: unnormalized output, running max and running sum of every
+//! (split, sequence, head).
+struct PartialStates
+{
+    float* acc;
+    float* max;
+    float* sum;
+
+    __host__ __device__ PartialStates(
+        void* workspace, int32_t batchSize, int32_t numHeads, int32_t headSize, int32_t numSplits)
+    {
+        auto const numRows = static_cast<size_t>(numSplits) * batchSize * numHeads;
+        acc = static_cast<float*>(workspace);
+        max = acc + numRows * headSize;
+        sum = max + numRows;
+    }
+};
+
+template <typename T>
+__device__ inline uint32_t packFloat2(float x, float y)
+{
+    using T2 = typename TypeConverter<T>::Type;
+    auto const packed = cuda_cast<T2>(make_float2(x, y));
+    return reinterpret_cast<uint32_t const&>(packed);
+}
+
+template <typename T>
+__device__ inline uint32_t packElements(T x, T y)
+{
+    using T2 = typename TypeConverter<T>::Type;
+    T2 packed;
+    packed.x = x;
+    packed.y = y;
+    return reinterpret_cast<uint32_t const&>(packed);
+}
+
+template <typename T>
+__device__ inline void mma(float (&c)[4], uint32_t const (&a)[4], uint32_t const (&b)[2])
+{
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 800
+    if constexpr (std::is_same_v<T, half>)
+    {
+        asm volatile(
+            "mma.sync.aligned.m16n8k16.row.col.f32.f16.f16.f32 {%0, %1, %2, %3}, {%4, %5, %6, %7}, {%8, %9}, "
+            "{%0, %1, %2, %3};\n"
+            : "+f"(c[0]), "+f"(c[1]), "+f"(c[2]), "+f"(c[3])
+            : "r"(a[0]), "r"(a[1]), "r"(a[2]), "r"(a[3]), "r"(b[0]), "r"(b[1]));
+    }
+    else
+    {
+        asm volatile(
+            "mma.sync.aligned.m16n8k16.row.col.f32.bf16.bf16.f32 {%0, %1, %2, %3}, {%4, %5, %6, %7}, {%8, %9}, "
+            "{%0, %1, %2, %3};\n"
+            : "+f"(c[0]), "+f"(c[1]), "+f"(c[2]), "+f"(c[3])
+            : "r"(a[0]), "r"(a[1]), "r"(a[2]), "r"(a[3]), "r"(b[0]), "r"(b[1]));
+    }
+#endif
+}
+
+// grid (batchSize, numKvHeads * headTilesPerKv, numSplits). The 16x8 fragments of the MMAs: thread (group = lane / 4,
+// idInGroup = lane % 4) holds rows group and group + 8 and columns 2 * idInGroup and 2 * idInGroup + 1 of the
+// accumulator, i.e. query heads group and group + 8 of the CTA.
+template <typename T, typename KVCacheBuffer, int kDimTiles>
+__global__ void __launch_bounds__(kThreads) gqaGenerationAttentionKernel(
+    GqaGenerationAttentionParams<T, KVCacheBuffer> const params, int32_t headTilesPerKv)
+{
+    constexpr int kHeadSize = kDimTiles * 16;
+    constexpr int kStride = kHeadSize + kSmemPad;
+    constexpr int kVecsPerRow = kHeadSize / kVecSize;
+
+    extern __shared__ __align__(16) char smem[];
+    auto const warpIdx = static_cast<int32_t>(threadIdx.x / 32);
+    auto const lane = static_cast<int32_t>(threadIdx.x % 32);
+    auto const group = lane / 4;
+    auto const idInGroup = lane % 4;
+    T* sQ = reinterpret_cast<T*>(smem);
+    T* sK = sQ + (1 + 2 * warpIdx) * kTileTokens * kStride;
+    T* sV = sK + kTileTokens * kStride;
+    float* sMax = reinterpret_cast<float*>(sQ + (1 + 2 * kNumWarps) * kTileTokens * kStride);
+    float* sSum = sMax + kNumWarps * kHeadsPerCta;
+
+    auto const batchIdx = static_cast<int32_t>(blockIdx.x);
+    auto const kvHeadIdx = static_cast<int32_t>(blockIdx.y) / headTilesPerKv;
+    auto const headTile = static_cast<int32_t>(blockIdx.y) % headTilesPerKv;
+    auto const split = static_cast<int32_t>(blockIdx.z);
+    auto const headsPerKv = params.numHeads / params.numKvHeads;
+    auto const headBegin = kvHeadIdx * headsPerKv + headTile * kHeadsPerCta;
+    auto const numRows = min(kHeadsPerCta, headsPerKv - headTile * kHeadsPerCta);
+
+    for (int32_t idx = threadIdx.x; idx < kHeadsPerCta * kVecsPerRow; idx += kThreads)
+    {
+        auto const row = idx / kVecsPerRow;
+        auto const col = idx % kVecsPerRow * kVecSize;
+        uint4 vec{0, 0, 0, 0};
+        if (row < numRows)
+        {
+            auto const qOffset = (static_cast<size_t>(batchIdx) * params.numHeads + headBegin + row) * kHeadSize + col;
+            vec = *reinterpret_cast<uint4 const*>(params.q + qOffset);
+        }
+        *reinterpret_cast<uint4*>(sQ + row * kStride + col) = vec;
+    }
+    __syncthreads();
+
+    auto const seqLength = params.sequenceLengths[batchIdx];
+    auto const tokenBegin = max(0, seqLength - params.attentionWindowSize);
+    auto const numTiles = (seqLength - tokenBegin + kTileTokens - 1) / kTileTokens;
+    auto const tilesPerSplit = (numTiles + params.numSplits - 1) / params.numSplits;
+    auto const tileBegin = split * tilesPerSplit;
+    auto const tileEnd = min(numTiles, tileBegin + tilesPerSplit);
+
+    float const negInf = -INFINITY;
+    float acc[2 * kDimTiles][4];
+    float rowMax[2] = {negInf, negInf};
+    float rowSum[2] = {0.f, 0.f};
+#pragma unroll
+    for (int n = 0; n < 2 * kDimTiles; ++n)
+    {
+#pragma unroll
+        for (int i = 0; i < 4; ++i)
+        {
+            acc[n][i] = 0.f;
+        }
+    }
+
+    for (int32_t tile = tileBegin + warpIdx; tile < tileEnd; tile += kNumWarps)
+    {
+        auto const tileToken = tokenBegin + tile * kTileTokens;
+        auto const numTokens = min(kTileTokens, seqLength - tileToken);
+        for (int32_t idx = lane; idx < kTileTokens * kVecsPerRow; idx += 32)
+        {
+            auto const token = idx / kVecsPerRow;
+            auto const col = idx % kVecsPerRow * kVecSize;
+            uint4 k{0, 0, 0, 0};
+            uint4 v{0, 0, 0, 0};
+            if (token < numTokens)
+            {
+                auto const kvToken = params.kvCache.getKVTokenIdx(tileToken + token);
+                auto const localIdx = params.kvCache.getKVLocalIdx(kvToken, kvHeadIdx, kHeadSize, col);
+                k = *reinterpret_cast<uint4 const*>(
+                    reinterpret_cast<T const*>(params.kvCache.getKBlockPtr(batchIdx, kvToken)) + localIdx);
+                v = *reinterpret_cast<uint4 const*>(
+                    reinterpret_cast<T const*>(params.kvCache.getVBlockPtr(batchIdx, kvToken)) + localIdx);
+            }
+            *reinterpret_cast<uint4*>(sK + token * kStride + col) = k;
+            *reinterpret_cast<uint4*>(sV + token * kStride + col) = v;
+        }
+        __syncwarp();
+
+        // S = Q.K^T for the 16 query heads and tokens [0, 8) and [8, 16) of the tile.
+        float s[2][4] = {{0.f, 0.f, 0.f, 0.f}, {0.f, 0.f, 0.f, 0.f}};
+#pragma unroll
+        for (int kt = 0; kt < kDimTiles; ++kt)
+        {
+            auto const col = kt * 16 + 2 * idInGroup;
+            uint32_t const a[4] = {*reinterpret_cast<uint32_t const*>(sQ + group * kStride + col),
+                *reinterpret_cast<uint32_t const*>(sQ + (group + 8) * kStride + col),
+                *reinterpret_cast<uint32_t const*>(sQ + group * kStride + col + 8),
+                *reinterpret_cast<uint32_t const*>(sQ + (group + 8) * kStride + col + 8)};
+#pragma unroll
+            for (int nt = 0; nt < 2; ++nt)
+            {
+                auto const* kRow = sK + (nt * 8 + group) * kStride + col;
+                uint32_t const b[2]
+                    = {*reinterpret_cast<uint32_t const*>(kRow), *reinterpret_cast<uint32_t const*>(kRow + 8)};
+                mma<T>(s[nt], a, b);
+            }
+        }
+
+        // Online softmax of rows group (r = 0) and group + 8 (r = 1), whose scores are spread over the 4 threads of
+        // the group.
+#pragma unroll
+        for (int r = 0; r < 2; ++r)
+        {
+            float tileMax = negInf;
+#pragma unroll
+            for (int nt = 0; nt < 2; ++nt)
+            {
+#pragma unroll
+                for (int i = 0; i < 2; ++i)
+                {
+                    auto const token = nt * 8 + 2 * idInGroup + i;
+                    auto& score = s[nt][2 * r + i];
+                    score = token < numTokens ? score * params.qkScale : negInf;
+                    tileMax = fmaxf(tileMax, score);
+                }
+            }
+            tileMax = fmaxf(tileMax, __shfl_xor_sync(0xffffffff, tileMax, 1));
+            tileMax = fmaxf(tileMax, __shfl_xor_sync(0xffffffff, tileMax, 2));
+            // Every tile holds at least one token, so newMax is finite.
+            float const newMax = fmaxf(rowMax[r], tileMax);
+            float const correction = __expf(rowMax[r] - newMax);
+            rowMax[r] = newMax;
+            rowSum[r] *= correction;
+#pragma unroll
+            for (int n = 0; n < 2 * kDimTiles; ++n)
+            {
+                acc[n][2 * r] *= correction;
+                acc[n][2 * r + 1] *= correction;
+            }
+#pragma unroll
+            for (int nt = 0; nt < 2; ++nt)
+            {
+#pragma unroll
+                for (int i = 0; i < 2; ++i)
+                {
+                    auto& score = s[nt][2 * r + i];
+                    score = __expf(score - newMax);
+                    rowSum[r] += score;
+                }
+            }
+        }
+
+        // The accumulators of S are the A fragments of P for O += P.V, with the tokens as k.
+        uint32_t const p[4] = {packFloat2<T>(s[0][0], s[0][1]), packFloat2<T>(s[0][2], s[0][3]),
+            packFloat2<T>(s[1][0], s[1][1]), packFloat2<T>(s[1][2], s[1][3])};
+#pragma unroll
+        for (int n = 0; n < 2 * kDimTiles; ++n)
+        {
+            auto const* vCol = sV + 2 * idInGroup * kStride + n * 8 + group;
+            uint32_t const b[2]
+                = {packElements(vCol[0], vCol[kStride]), packElements(vCol[8 * kStride], vCol[9 * kStride])};
+            mma<T>(acc[n], p, b);
+        }
+        __syncwarp();
+    }
+
+    // Merge the states of the warps.
+#pragma unroll
+    for (int r = 0; r < 2; ++r)
+    {
+        rowSum[r] += __shfl_xor_sync(0xffffffff, rowSum[r], 1);
+        rowSum[r] += __shfl_xor_sync(0xffffffff, rowSum[r], 2);
+        if (idInGroup == 0)
+        {
+            sMax[warpIdx * kHeadsPerCta + group + 8 * r] = rowMax[r];
+            sSum[warpIdx * kHeadsPerCta + group + 8 * r] = rowSum[r];
+        }
+    }
+    __syncthreads();
+
+    auto const getCtaMax = [&](int row)
+    {
+        float ctaMax = negInf;
+#pragma unroll
+        for (int w = 0; w < kNumWarps; ++w)
+        {
+            ctaMax = fmaxf(ctaMax, sMax[w * kHeadsPerCta + row]);
+        }
+        return ctaMax;
+    };
+    // Warps without tokens hold max = -inf and contribute nothing.
+    auto const getScale = [](float max, float ctaMax) { return max == -INFINITY ? 0.f : __expf(max - ctaMax); };
+
+    // The K/V smem of the warp is done with, it takes the scaled output of the warp.
+    float* sOut = reinterpret_cast<float*>(sK);
+#pragma unroll
+    for (int r = 0; r < 2; ++r)
+    {
+        auto const row = group + 8 * r;
+        float const scale = getScale(rowMax[r], getCtaMax(row));
+#pragma unroll
+        for (int n = 0; n < 2 * kDimTiles; ++n)
+        {
+            auto const col = n * 8 + 2 * idInGroup;
+            sOut[row * kHeadSize + col] = acc[n][2 * r] * scale;
+            sOut[row * kHeadSize + col + 1] = acc[n][2 * r + 1] * scale;
+        }
+    }
+    __syncthreads();
+
+    PartialStates const states{params.workspace, params.batchSize, params.numHeads, kHeadSize, params.numSplits};
+    for (int32_t idx = threadIdx.x; idx < numRows * kHeadSize; idx += kThreads)
+    {
+        auto const row = idx / kHeadSize;
+        auto const dim = idx % kHeadSize;
+        float const ctaMax = getCtaMax(row);
+        float sum = 0.f;
+        float out = 0.f;
+#pragma unroll
+        for (int w = 0; w < kNumWarps; ++w)
+        {
+            sum += sSum[w * kHeadsPerCta + row] * getScale(sMax[w * kHeadsPerCta + row], ctaMax);
+            out += reinterpret_cast<float const*>(sQ + (1 + 2 * w) * kTileTokens * kStride)[row * kHeadSize + dim];
+        }
+        auto const headIdx = headBegin + row;
+        if (params.numSplits == 1)
+        {
+            params.out[(static_cast<size_t>(batchIdx) * params.numHeads + headIdx) * kHeadSize + dim]
+                = cuda_cast<T>(out / sum);
+            continue;
+        }
+        auto const stateRow = (static_cast<size_t>(split) * params.batchSize + batchIdx) * params.numHeads + headIdx;
+        states.acc[stateRow * kHeadSize + dim] = out;
+        if (dim == 0)
+        {
+            states.max[stateRow] = ctaMax;
+            states.sum[stateRow] = sum;
+        }
+    }
+}
+
+// grid (batchSize, numHeads), block headSize threads.
+template <typename T, typename KVCacheBuffer>
+__global__ void gqaMergeStatesKernel(GqaGenerationAttentionParams<T, KVCacheBuffer> const params)
+{
+    PartialStates const states{params.workspace, params.batchSize, params.numHeads, params.headSize, params.numSplits};
+    auto const batchIdx = static_cast<int32_t>(blockIdx.x);
+    auto const headIdx = static_cast<int32_t>(blockIdx.y);
+    auto const dim = static_cast<int32_t>(threadIdx.x);
+    auto const getRow = [&](int32_t split)
+    { return (static_cast<size_t>(split) * params.batchSize + batchIdx) * params.numHeads + headIdx; };
+
+    float globalMax = -INFINITY;
+    for (int32_t s = 0; s < params.numSplits; ++s)
+    {
+        globalMax = fmaxf(globalMax, states.max[getRow(s)]);
+    }
+    float sum = 0.f;
+    float out = 0.f;
+    for (int32_t s = 0; s < params.numSplits; ++s)
+    {
+        auto const row = getRow(s);
+        // Empty splits hold max = -inf and contribute nothing.
+        float const scale = states.sum[row] > 0.f ? __expf(states.max[row] - globalMax) : 0.f;
+        sum += states.sum[row] * scale;
+        out += states.acc[row * params.headSize + dim] * scale;
+    }
+    params.out[(static_cast<size_t>(batchIdx) * params.numHeads + headIdx) * params.headSize + dim]
+        = cuda_cast<T>(out / sum);
+}
+
+template <typename T, typename KVCacheBuffer, int kDimTiles>
+void launchGqaGenerationAttention(GqaGenerationAttentionParams<T, KVCacheBuffer> const& params, cudaStream_t stream)
+{
+    constexpr int kStride = kDimTiles * 16 + kSmemPad;
+    auto const headsPerKv = params.numHeads / params.numKvHeads;
+    auto const headTilesPerKv = static_cast<int32_t>(divUp(headsPerKv, kHeadsPerCta));
+    size_t const smemSize = sizeof(T) * (1 + 2 * kNumWarps) * kTileTokens * kStride
+        + 2 * sizeof(float) * kNumWarps * kHeadsPerCta;
+
+    auto* kernel = gqaGenerationAttentionKernel<T, KVCacheBuffer, kDimTiles>;
+    if (smemSize > 48 * 1024)
+    {
+        TLLM_CUDA_CHECK(cudaFuncSetAttribute(kernel, cudaFuncAttributeMaxDynamicSharedMemorySize, smemSize));
+    }
+    dim3 const grid(params.batchSize, params.numKvHeads * headTilesPerKv, params.numSplits);
+    kernel<<<grid, kThreads, smemSize, stream>>>(params, headTilesPerKv);
+
+    if (params.numSplits > 1)
+    {
+        dim3 const mergeGrid(params.batchSize, params.numHeads);
+        gqaMergeStatesKernel<T, KVCacheBuffer><<<mergeGrid, params.headSize, 0, stream>>>(params);
+    }
+}
+
+} // namespace
+
+size_t getGqaGenerationAttentionWorkspaceSize(int32_t batchSize, int32_t numHeads, int32_t headSize, int32_t numSplits)
+{
+    if (numSplits <= 1)
+    {
+        return 0;
+    }
+    auto const numRows = static_cast<size_t>(numSplits) * batchSize * numHeads;
+    return sizeof(float) * numRows * (headSize + 2);
+}
+
+bool isGqaGenerationAttentionSupported(int32_t sm, int32_t headSize)
+{
+    return sm >= 80 && headSize % 16 == 0 && headSize <= kMaxHeadSize;
+}
+
+template <typename T, typename KVCacheBuffer>
+void invokeGqaGenerationAttention(GqaGenerationAttentionParams<T, KVCacheBuffer> const& params, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(isGqaGenerationAttentionSupported(getSMVersion(), params.headSize),
+        "GQA generation attention supports head sizes that are multiples of 16 up to %d on SM80 or newer, got %d",
+        kMaxHeadSize, params.headSize);
+    TLLM_CHECK(params.numHeads % params.numKvHeads == 0);
+    TLLM_CHECK(params.numSplits > 0 && params.numSplits <= kGqaGenerationAttentionMaxSplits);
+    TLLM_CHECK(params.numSplits == 1 || params.workspace != nullptr);
+    TLLM_CHECK(params.attentionWindowSize > 0);
+    TLLM_CHECK_WITH_INFO(params.kvCache.mSinkTokens == 0, "GQA generation attention does not support sink tokens");
+
+    switch (params.headSize / 16)
+    {
+    case 1: launchGqaGenerationAttention<T, KVCacheBuffer, 1>(params, stream); break;
+    case 2: launchGqaGenerationAttention<T, KVCacheBuffer, 2>(params, stream); break;
+    case 3: launchGqaGenerationAttention<T, KVCacheBuffer, 3>(params, stream); break;
+    case 4: launchGqaGenerationAttention<T, KVCacheBuffer, 4>(params, stream); break;
+    case 5: launchGqaGenerationAttention<T, KVCacheBuffer, 5>(params, stream); break;
+    case 6: launchGqaGenerationAttention<T, KVCacheBuffer, 6>(params, stream); break;
+    case 7: launchGqaGenerationAttention<T, KVCacheBuffer, 7>(params, stream); break;
+    case 8: launchGqaGenerationAttention<T, KVCacheBuffer, 8>(params, stream); break;
+    case 9: launchGqaGenerationAttention<T, KVCacheBuffer, 9>(params, stream); break;
+    case 10: launchGqaGenerationAttention<T, KVCacheBuffer, 10>(params, stream); break;
+    case 11: launchGqaGenerationAttention<T, KVCacheBuffer, 11>(params, stream); break;
+    case 12: launchGqaGenerationAttention<T, KVCacheBuffer, 12>(params, stream); break;
+    case 13: launchGqaGenerationAttention<T, KVCacheBuffer, 13>(params, stream); break;
+    case 14: launchGqaGenerationAttention<T, KVCacheBuffer, 14>(params, stream); break;
+    case 15: launchGqaGenerationAttention<T, KVCacheBuffer, 15>(params, stream); break;
+    case 16: launchGqaGenerationAttention<T, KVCacheBuffer, 16>(params, stream); break;
+    }
+    sync_check_cuda_error();
+}
+
+#define INSTANTIATE_GQA_GENERATION_ATTENTION(T, KVCacheBuffer)                                                         \
+    template void invokeGqaGenerationAttention<T, KVCacheBuffer>(                                                      \
+        GqaGenerationAttentionParams<T, KVCacheBuffer> const& params, cudaStream_t stream)
+
+INSTANTIATE_GQA_GENERATION_ATTENTION(half, KVBlockArray);
+INSTANTIATE_GQA_GENERATION_ATTENTION(half, KVLinearBuffer);
+#ifdef ENABLE_BF16
+INSTANTIATE_GQA_GENERATION_ATTENTION(__nv_bfloat16, KVBlockArray);
+INSTANTIATE_GQA_GENERATION_ATTENTION(__nv_bfloat16, KVLinearBuffer);
+#endif
+
+#undef INSTANTIATE_GQA_GENERATION_ATTENTION
+
+} // namespace kernels
+} // namespace tensorrt_llm
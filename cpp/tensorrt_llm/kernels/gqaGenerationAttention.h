@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/kernels/kvCacheUtils.h"
+
+#include <cstdint>
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+//! Upper bound of the number of CTAs that split the KV range of a sequence in GQA generation attention.
+constexpr int32_t kGqaGenerationAttentionMaxSplits = 16;
+
+template <typename T, typename KVCacheBuffer>
+struct GqaGenerationAttentionParams
+{
+    //! Queries of the current token with position embedding applied, [batchSize, numHeads, headSize]
+    T const* q{nullptr};
+    //! [batchSize, numHeads, headSize]
+    T* out{nullptr};
+    //! KV cache which already holds K and V of the current token
+    KVCacheBuffer kvCache{};
+    //! Tokens in the KV cache of each sequence including the current one, [batchSize]
+    int32_t const* sequenceLengths{nullptr};
+    //! Partial softmax states of the splits, getGqaGenerationAttentionWorkspaceSize bytes. Unused with one split.
+    void* workspace{nullptr};
+
+    int32_t batchSize{0};
+    int32_t numHeads{0};
+    int32_t numKvHeads{0};
+    int32_t headSize{0};
+    //! Sequences attend their last attentionWindowSize tokens, the KV cache wraps around after them
+    int32_t attentionWindowSize{0};
+    //! Number of CTAs the KV range of every sequence is split across, at most kGqaGenerationAttentionMaxSplits
+    int32_t numSplits{1};
+    //! Scale applied to Q.K, usually 1 / (sqrt(headSize) * qScaling)
+    float qkScale{1.f};
+};
+
+[[nodiscard]] size_t getGqaGenerationAttentionWorkspaceSize(
+    int32_t batchSize, int32_t numHeads, int32_t headSize, int32_t numSplits);
+
+//! \brief Whether invokeGqaGenerationAttention runs on a device of the given SM version with the given head size.
+[[nodiscard]] bool isGqaGenerationAttentionSupported(int32_t sm, int32_t headSize);
+
+//! \brief Generation-phase attention of grouped-query models with tensor cores.
+//! \details A CTA attends up to 16 query heads sharing a KV head, the rows of m16n8k16 MMAs, to a range of the KV
+//! cache of a sequence. Each K/V token is read from global memory once per CTA instead of once per query head as in
+//! the masked MHA kernels, and both Q.K^T and P.V run on tensor cores with an online softmax in registers. With more
+//! than one split, partial softmax states are merged by a second pass. Supports fp16 and bf16 with a non-quantized
+//! KV cache without sink tokens, head sizes that are multiples of 16 up to 256, beam width 1, and SM80 or newer.
+template <typename T, typename KVCacheBuffer>
+void invokeGqaGenerationAttention(GqaGenerationAttentionParams<T, KVCacheBuffer> const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
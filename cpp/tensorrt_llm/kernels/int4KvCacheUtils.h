@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cuda_fp16.h>
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+// INT4 kv caches store the (head, token) rows of a block as sizePerHead / 2 bytes of packed int4 values (two channels
+// per byte, the even channel in the low nibble), followed by one fp16 scale per group of kInt4KvCacheGroupSize
+// channels of the row. The scales are computed on write, the static kv cache scales are not used. The kv cache
+// manager and KVBlockArray see a byte cache with getInt4KvCacheRowBytes(sizePerHead) elements per head and token.
+static constexpr int32_t kInt4KvCacheGroupSize = 32;
+
+__host__ __device__ constexpr int32_t getInt4KvCacheRowBytes(int32_t sizePerHead)
+{
+    return sizePerHead / 2 + sizePerHead / kInt4KvCacheGroupSize * static_cast<int32_t>(sizeof(half));
+}
+
+// Dequantize channel channelIdx of a row of an int4 kv cache.
+__device__ inline float dequantizeInt4KvCacheRow(uint8_t const* row, int32_t sizePerHead, int32_t channelIdx)
+{
+    auto const packed = row[channelIdx / 2];
+    auto const nibble = static_cast<int32_t>((channelIdx % 2 == 0) ? (packed & 0xF) : (packed >> 4));
+    auto const* scales = reinterpret_cast<half const*>(row + sizePerHead / 2);
+    return static_cast<float>((nibble ^ 8) - 8) * __half2float(scales[channelIdx / kInt4KvCacheGroupSize]);
+}
+
+} // namespace kernels
+} // namespace tensorrt_llm
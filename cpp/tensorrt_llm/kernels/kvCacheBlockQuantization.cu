@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/quantTypeUtils.cuh"
+#include "tensorrt_llm/common/reduceKernelUtils.cuh"
+#include "tensorrt_llm/kernels/kvCacheBlockQuantization.h"
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+constexpr int kBlockSize = 256;
+
+} // namespace
+
+// One CUDA block per (head slice, cache block): reduce the absolute maximum of the slice, then quantize it.
+template <typename T, typename QuantT>
+__global__ void quantizeKvCacheBlocksKernel(
+    QuantT* dst, float* scales, T const* const* srcBlocks, int32_t numHeadSlices, int32_t headSliceSize)
+{
+    auto const sliceIdx = static_cast<int64_t>(blockIdx.x);
+    auto const blockId = static_cast<int64_t>(blockIdx.y);
+    T const* src = srcBlocks[blockId] + sliceIdx * headSliceSize;
+    auto const outOffset = (blockId * numHeadSlices + sliceIdx) * headSliceSize;
+
+    float localMax = 0.f;
+    for (int32_t idx = threadIdx.x; idx < headSliceSize; idx += blockDim.x)
+    {
+        localMax = fmaxf(localMax, fabsf(cuda_cast<float>(src[idx])));
+    }
+    float const absMax = blockAllReduceMax<float>(localMax);
+
+    float const maxVal = QuantTypeStaticVals<QuantT>::MAX_VAL;
+    float const scale = absMax > 0.f ? absMax / maxVal : 1.f;
+    float const scaleRcp = 1.f / scale;
+    if (threadIdx.x == 0)
+    {
+        scales[blockId * numHeadSlices + sliceIdx] = scale;
+    }
+
+    for (int32_t idx = threadIdx.x; idx < headSliceSize; idx += blockDim.x)
+    {
+        auto const val = fminf(fmaxf(cuda_cast<float>(src[idx]) * scaleRcp, -maxVal), maxVal);
+        dst[outOffset + idx] = cuda_cast<QuantT>(val);
+    }
+}
+
+template <typename T, typename QuantT>
+__global__ void dequantizeKvCacheBlocksKernel(
+    T* const* dstBlocks, QuantT const* src, float const* scales, int32_t numHeadSlices, int32_t headSliceSize)
+{
+    auto const sliceIdx = static_cast<int64_t>(blockIdx.x);
+    auto const blockId = static_cast<int64_t>(blockIdx.y);
+    T* dst = dstBlocks[blockId] + sliceIdx * headSliceSize;
+    auto const inOffset = (blockId * numHeadSlices + sliceIdx) * headSliceSize;
+    float const scale = scales[blockId * numHeadSlices + sliceIdx];
+
+    for (int32_t idx = threadIdx.x; idx < headSliceSize; idx += blockDim.x)
+    {
+        dst[idx] = cuda_cast<T>(cuda_cast<float>(src[inOffset + idx]) * scale);
+    }
+}
+
+template <typename T, typename QuantT>
+void invokeQuantizeKvCacheBlocks(QuantT* dst, float* scales, T const* const* srcBlocks, int32_t numBlocks,
+    int32_t numHeadSlices, int32_t headSliceSize, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(numBlocks <= 65535, "Too many blocks to quantize at once (%d)", numBlocks);
+    if (numBlocks == 0)
+    {
+        return;
+    }
+    dim3 const grid(numHeadSlices, numBlocks);
+    quantizeKvCacheBlocksKernel<T, QuantT>
+        <<<grid, kBlockSize, 0, stream>>>(dst, scales, srcBlocks, numHeadSlices, headSliceSize);
+    sync_check_cuda_error();
+}
+
+template <typename T, typename QuantT>
+void invokeDequantizeKvCacheBlocks(T* const* dstBlocks, QuantT const* src, float const* scales, int32_t numBlocks,
+    int32_t numHeadSlices, int32_t headSliceSize, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(numBlocks <= 65535, "Too many blocks to dequantize at once (%d)", numBlocks);
+    if (numBlocks == 0)
+    {
+        return;
+    }
+    dim3 const grid(numHeadSlices, numBlocks);
+    dequantizeKvCacheBlocksKernel<T, QuantT>
+        <<<grid, kBlockSize, 0, stream>>>(dstBlocks, src, scales, numHeadSlices, headSliceSize);
+    sync_check_cuda_error();
+}
+
+#define INSTANTIATE_KV_CACHE_BLOCK_QUANTIZATION(T, QuantT)                                                             \
+    template void invokeQuantizeKvCacheBlocks<T, QuantT>(QuantT * dst, float* scales, T const* const* srcBlocks,       \
+        int32_t numBlocks, int32_t numHeadSlices, int32_t headSliceSize, cudaStream_t stream);                         \
+    template void invokeDequantizeKvCacheBlocks<T, QuantT>(T* const* dstBlocks, QuantT const* src,                     \
+        float const* scales, int32_t numBlocks, int32_t numHeadSlices, int32_t headSliceSize, cudaStream_t stream)
+
+INSTANTIATE_KV_CACHE_BLOCK_QUANTIZATION(float, int8_t);
+INSTANTIATE_KV_CACHE_BLOCK_QUANTIZATION(half, int8_t);
+#ifdef ENABLE_BF16
+INSTANTIATE_KV_CACHE_BLOCK_QUANTIZATION(__nv_bfloat16, int8_t);
+#endif
+#ifdef ENABLE_FP8
+INSTANTIATE_KV_CACHE_BLOCK_QUANTIZATION(float, __nv_fp8_e4m3);
+INSTANTIATE_KV_CACHE_BLOCK_QUANTIZATION(half, __nv_fp8_e4m3);
+#ifdef ENABLE_BF16
+INSTANTIATE_KV_CACHE_BLOCK_QUANTIZATION(__nv_bfloat16, __nv_fp8_e4m3);
+#endif
+#endif
+
+#undef INSTANTIATE_KV_CACHE_BLOCK_QUANTIZATION
+
+} // namespace kernels
+} // namespace tensorrt_llm
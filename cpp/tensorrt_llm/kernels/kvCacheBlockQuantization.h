@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+//! \brief Quantize KV cache blocks with one scale per head slice.
+//! \details A block of the KV cache is laid out as [numLayers, 2, numKvHeads, tokensPerBlock, sizePerHead], i.e.
+//! numHeadSlices = numLayers * 2 * numKvHeads contiguous slices of headSliceSize = tokensPerBlock * sizePerHead
+//! elements. Each slice is scaled by its own absolute maximum. dst and scales may point to mapped pinned host memory,
+//! in which case the kernel performs the offload itself and only the quantized bytes cross PCIe.
+//! \param dst Quantized blocks, [numBlocks, numHeadSlices, headSliceSize]
+//! \param scales Dequantization scales, [numBlocks, numHeadSlices]
+//! \param srcBlocks Pointers to the numBlocks source blocks, device memory
+template <typename T, typename QuantT>
+void invokeQuantizeKvCacheBlocks(QuantT* dst, float* scales, T const* const* srcBlocks, int32_t numBlocks,
+    int32_t numHeadSlices, int32_t headSliceSize, cudaStream_t stream);
+
+//! \brief Inverse of invokeQuantizeKvCacheBlocks, used when blocks are onboarded back into the primary pool.
+//! \param dstBlocks Pointers to the numBlocks destination blocks, device memory
+template <typename T, typename QuantT>
+void invokeDequantizeKvCacheBlocks(T* const* dstBlocks, QuantT const* src, float const* scales, int32_t numBlocks,
+    int32_t numHeadSlices, int32_t headSliceSize, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/reduceKernelUtils.cuh"
+#include "tensorrt_llm/kernels/kvCacheEvictionKernels.h"
+
+#include <cfloat>
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+constexpr int kScoreThreads = 256;
+constexpr int kCompactionThreads = 256;
+
+template <typename T, typename KVCacheBuffer>
+__device__ float computeTokenLogit(KVCacheBuffer const& kvCacheBuffer, float const* qSmem, int32_t seqIdx,
+    int32_t tokenIdx, int32_t kvHeadIdx, int32_t headSize, float qkScale)
+{
+    auto const kvTokenIdx = kvCacheBuffer.getKVTokenIdx(tokenIdx);
+    auto const* kBlock = reinterpret_cast<T const*>(kvCacheBuffer.getKBlockPtr(seqIdx, kvTokenIdx));
+    auto const* k = kBlock + kvCacheBuffer.getKVLocalIdx(kvTokenIdx, kvHeadIdx, headSize, 0);
+    float qk = 0.f;
+    for (int32_t d = 0; d < headSize; ++d)
+    {
+        qk += qSmem[d] * cuda_cast<float>(k[d]);
+    }
+    return qk * qkScale;
+}
+
+//! One CTA per (head, sequence). The first pass computes the softmax statistics online, the second one adds the
+//! probabilities of the tokens to the scores of the sequence.
+template <typename T, typename KVCacheBuffer>
+__global__ void accumulateKvTokenScoresKernel(KvTokenScoreParams<T, KVCacheBuffer> params)
+{
+    extern __shared__ float qSmem[];
+
+    auto const headIdx = static_cast<int32_t>(blockIdx.x);
+    auto const seqIdx = static_cast<int32_t>(blockIdx.y);
+    auto const kvHeadIdx = headIdx / (params.numHeads / params.numKvHeads);
+    auto const seqLen = params.sequenceLengths[seqIdx];
+
+    auto const* q = params.q + (static_cast<size_t>(seqIdx) * params.numHeads + headIdx) * params.headSize;
+    for (int32_t d = threadIdx.x; d < params.headSize; d += blockDim.x)
+    {
+        qSmem[d] = cuda_cast<float>(q[d]);
+    }
+    __syncthreads();
+
+    float threadMax = -FLT_MAX;
+    float threadSum = 0.f;
+    for (int32_t t = threadIdx.x; t < seqLen; t += blockDim.x)
+    {
+        auto const logit = computeTokenLogit<T>(
+            params.kvCacheBuffer, qSmem, seqIdx, t, kvHeadIdx, params.headSize, params.qkScale);
+        auto const newMax = fmaxf(threadMax, logit);
+        threadSum = threadSum * __expf(threadMax - newMax) + __expf(logit - newMax);
+        threadMax = newMax;
+    }
+    auto const blockMax = blockReduceMax<float>(threadMax);
+    auto const blockSum = blockReduceSum<float>(threadSum * __expf(threadMax - blockMax));
+    auto const invSum = 1.f / (blockSum + 1e-6f);
+
+    auto* scores = params.tokenScores + static_cast<size_t>(seqIdx) * params.maxNumTokens;
+    for (int32_t t = threadIdx.x; t < seqLen; t += blockDim.x)
+    {
+        auto const logit = computeTokenLogit<T>(
+            params.kvCacheBuffer, qSmem, seqIdx, t, kvHeadIdx, params.headSize, params.qkScale);
+        atomicAdd(&scores[t], __expf(logit - blockMax) * invSum);
+    }
+}
+
+//! Staging layout of the compaction workspace: [batchSize, maxNumKeptTokens, 2, numKvHeads, bytesPerHead] for K/V,
+//! followed by [batchSize, maxNumKeptTokens] scores.
+struct CompactionStaging
+{
+    uint32_t* kv;
+    float* scores;
+
+    __host__ __device__ CompactionStaging(
+        void* workspace, int32_t batchSize, int32_t maxNumKeptTokens, int32_t numKvHeads, int32_t bytesPerHead)
+    {
+        kv = static_cast<uint32_t*>(workspace);
+        scores = reinterpret_cast<float*>(reinterpret_cast<char*>(workspace)
+            + static_cast<size_t>(batchSize) * maxNumKeptTokens * 2 * numKvHeads * bytesPerHead);
+    }
+};
+
+template <typename KVCacheBuffer>
+__device__ uint32_t* getTokenHeadPtr(
+    KVCacheBuffer const& kvCacheBuffer, int32_t seqIdx, int32_t tokenIdx, int32_t kvIdx, int32_t headIdx,
+    int32_t bytesPerHead)
+{
+    auto const kvTokenIdx = kvCacheBuffer.getKVTokenIdx(tokenIdx);
+    auto* block = reinterpret_cast<char*>(kvIdx == 0 ? kvCacheBuffer.getKBlockPtr(seqIdx, kvTokenIdx)
+                                                     : kvCacheBuffer.getVBlockPtr(seqIdx, kvTokenIdx));
+    return reinterpret_cast<uint32_t*>(block + kvCacheBuffer.getKVLocalIdx(kvTokenIdx, headIdx, bytesPerHead, 0));
+}
+
+//! One CTA per (kept token, sequence). The kept tokens are staged first since a destination slot may still hold the
+//! source of another kept token.
+template <typename KVCacheBuffer, bool kGather>
+__global__ void compactKvCacheKernel(KvCacheCompactionParams<KVCacheBuffer> params)
+{
+    auto const keptIdx = static_cast<int32_t>(blockIdx.x);
+    auto const seqIdx = static_cast<int32_t>(blockIdx.y);
+    if (keptIdx >= params.numKeptTokens[seqIdx])
+    {
+        return;
+    }
+    auto const srcTokenIdx = params.keptTokenIdx[static_cast<size_t>(seqIdx) * params.maxNumKeptTokens + keptIdx];
+    if (srcTokenIdx == keptIdx)
+    {
+        // Already in place.
+        return;
+    }
+
+    CompactionStaging staging{
+        params.workspace, params.batchSize, params.maxNumKeptTokens, params.numKvHeads, params.bytesPerHead};
+    auto const wordsPerHead = params.bytesPerHead / 4;
+    auto const wordsPerToken = 2 * params.numKvHeads * wordsPerHead;
+    auto* stagedToken
+        = staging.kv + (static_cast<size_t>(seqIdx) * params.maxNumKeptTokens + keptIdx) * wordsPerToken;
+    auto const tokenIdx = kGather ? srcTokenIdx : keptIdx;
+
+    for (int32_t i = threadIdx.x; i < wordsPerToken; i += blockDim.x)
+    {
+        auto const kvIdx = i / (params.numKvHeads * wordsPerHead);
+        auto const headIdx = (i / wordsPerHead) % params.numKvHeads;
+        auto const wordIdx = i % wordsPerHead;
+        auto* cache = getTokenHeadPtr(params.kvCacheBuffer, seqIdx, tokenIdx, kvIdx, headIdx, params.bytesPerHead);
+        if (kGather)
+        {
+            stagedToken[i] = cache[wordIdx];
+        }
+        else
+        {
+            cache[wordIdx] = stagedToken[i];
+        }
+    }
+
+    if (params.tokenScores != nullptr && threadIdx.x == 0)
+    {
+        auto* scores = params.tokenScores + static_cast<size_t>(seqIdx) * params.maxNumTokens;
+        auto& stagedScore = staging.scores[static_cast<size_t>(seqIdx) * params.maxNumKeptTokens + keptIdx];
+        if (kGather)
+        {
+            stagedScore = scores[srcTokenIdx];
+        }
+        else
+        {
+            scores[keptIdx] = stagedScore;
+        }
+    }
+}
+
+} // namespace
+
+template <typename T, typename KVCacheBuffer>
+void invokeAccumulateKvTokenScores(KvTokenScoreParams<T, KVCacheBuffer> const& params, cudaStream_t stream)
+{
+    TLLM_CHECK(params.numKvHeads > 0 && params.numHeads % params.numKvHeads == 0);
+    TLLM_CHECK(params.headSize > 0);
+    dim3 const grid(params.numHeads, params.batchSize);
+    auto const smemSize = params.headSize * sizeof(float);
+    accumulateKvTokenScoresKernel<T, KVCacheBuffer><<<grid, kScoreThreads, smemSize, stream>>>(params);
+    sync_check_cuda_error();
+}
+
+size_t getKvCacheCompactionWorkspaceSize(
+    int32_t batchSize, int32_t maxNumKeptTokens, int32_t numKvHeads, int32_t bytesPerHead)
+{
+    auto const numKeptTokens = static_cast<size_t>(batchSize) * maxNumKeptTokens;
+    return numKeptTokens * 2 * numKvHeads * bytesPerHead + numKeptTokens * sizeof(float);
+}
+
+template <typename KVCacheBuffer>
+void invokeCompactKvCache(KvCacheCompactionParams<KVCacheBuffer> const& params, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(
+        params.bytesPerHead % 4 == 0, "KV cache compaction needs a multiple of 4 bytes per head, got %d",
+        params.bytesPerHead);
+    TLLM_CHECK(params.workspace != nullptr);
+    if (params.batchSize == 0 || params.maxNumKeptTokens == 0)
+    {
+        return;
+    }
+    dim3 const grid(params.maxNumKeptTokens, params.batchSize);
+    compactKvCacheKernel<KVCacheBuffer, true><<<grid, kCompactionThreads, 0, stream>>>(params);
+    compactKvCacheKernel<KVCacheBuffer, false><<<grid, kCompactionThreads, 0, stream>>>(params);
+    sync_check_cuda_error();
+}
+
+#define INSTANTIATE_KV_TOKEN_SCORES(T, KVCacheBuffer)                                                                  \
+    template void invokeAccumulateKvTokenScores<T, KVCacheBuffer>(                                                     \
+        KvTokenScoreParams<T, KVCacheBuffer> const& params, cudaStream_t stream);
+
+INSTANTIATE_KV_TOKEN_SCORES(float, KVBlockArray)
+INSTANTIATE_KV_TOKEN_SCORES(float, KVLinearBuffer)
+INSTANTIATE_KV_TOKEN_SCORES(half, KVBlockArray)
+INSTANTIATE_KV_TOKEN_SCORES(half, KVLinearBuffer)
+#ifdef ENABLE_BF16
+INSTANTIATE_KV_TOKEN_SCORES(__nv_bfloat16, KVBlockArray)
+INSTANTIATE_KV_TOKEN_SCORES(__nv_bfloat16, KVLinearBuffer)
+#endif
+#undef INSTANTIATE_KV_TOKEN_SCORES
+
+template void invokeCompactKvCache<KVBlockArray>(
+    KvCacheCompactionParams<KVBlockArray> const& params, cudaStream_t stream);
+template void invokeCompactKvCache<KVLinearBuffer>(
+    KvCacheCompactionParams<KVLinearBuffer> const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
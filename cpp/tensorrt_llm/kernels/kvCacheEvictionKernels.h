@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/kernels/kvCacheUtils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cuda_runtime_api.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+// KV cache compression by token eviction (attention sinks, recent tokens and heavy hitters). The tokens to keep are
+// chosen on the host by runtime::KvCacheEvictionPolicy from the scores accumulated by invokeAccumulateKvTokenScores;
+// invokeCompactKvCache then moves them to the first positions of each sequence.
+
+template <typename T, typename KVCacheBuffer>
+struct KvTokenScoreParams
+{
+    // The (position embedded) queries of the generation step with shape [batchSize, numHeads, headSize].
+    T const* q{nullptr};
+    // Non-quantized kv cache holding the K of the tokens, including the current one.
+    KVCacheBuffer kvCacheBuffer{};
+    // The number of tokens of each sequence in the cache, with shape [batchSize].
+    int32_t const* sequenceLengths{nullptr};
+    // The accumulated attention probabilities of the tokens, summed over heads, with shape [batchSize, maxNumTokens].
+    float* tokenScores{nullptr};
+    int32_t batchSize{0};
+    int32_t numHeads{0};
+    int32_t numKvHeads{0};
+    int32_t headSize{0};
+    int32_t maxNumTokens{0};
+    float qkScale{1.f};
+};
+
+// Add the attention probabilities of the queries over the cached tokens to tokenScores (H2O).
+template <typename T, typename KVCacheBuffer>
+void invokeAccumulateKvTokenScores(KvTokenScoreParams<T, KVCacheBuffer> const& params, cudaStream_t stream);
+
+template <typename KVCacheBuffer>
+struct KvCacheCompactionParams
+{
+    KVCacheBuffer kvCacheBuffer{};
+    // Ascending indices of the tokens kept by each sequence with shape [batchSize, maxNumKeptTokens].
+    int32_t const* keptTokenIdx{nullptr};
+    // The number of kept tokens of each sequence with shape [batchSize].
+    int32_t const* numKeptTokens{nullptr};
+    // Optional, the token scores with shape [batchSize, maxNumTokens] are compacted along with the cache. The scores
+    // past the kept tokens are left as is.
+    float* tokenScores{nullptr};
+    // Staging buffer of getKvCacheCompactionWorkspaceSize bytes.
+    void* workspace{nullptr};
+    int32_t batchSize{0};
+    int32_t maxNumKeptTokens{0};
+    int32_t maxNumTokens{0};
+    int32_t numKvHeads{0};
+    // Bytes of one head of one token in the cache, a multiple of 4.
+    int32_t bytesPerHead{0};
+};
+
+size_t getKvCacheCompactionWorkspaceSize(
+    int32_t batchSize, int32_t maxNumKeptTokens, int32_t numKvHeads, int32_t bytesPerHead);
+
+// Move the kept K/V tokens of each sequence to positions [0, numKeptTokens), e.g. one layer of the cache. Works for
+// any kv cache data type. The sequence then has numKeptTokens tokens and its trailing blocks can be released.
+template <typename KVCacheBuffer>
+void invokeCompactKvCache(KvCacheCompactionParams<KVCacheBuffer> const& params, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
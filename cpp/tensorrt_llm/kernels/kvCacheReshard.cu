@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/kvCacheReshard.h"
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+constexpr int kBlockSize = 256;
+
+//! \brief Byte offsets of head slice sliceIdx of a block, in the block and in the contiguous buffer.
+__device__ inline void getHeadSliceOffsets(
+    KvCacheBlockSlice const& slice, int64_t blockId, int32_t sliceIdx, int64_t& blockOffset, int64_t& bufferOffset)
+{
+    auto const head = sliceIdx % slice.numSliceHeads;
+    auto const layerKv = sliceIdx / slice.numSliceHeads;
+    auto const layer = layerKv / 2;
+    auto const kv = layerKv % 2;
+    auto const numHeadSlices = static_cast<int64_t>(slice.numSliceLayers) * 2 * slice.numSliceHeads;
+    blockOffset = ((static_cast<int64_t>(slice.layerBegin + layer) * 2 + kv) * slice.numKvHeads + slice.headBegin
+                      + head)
+        * slice.headSliceBytes;
+    bufferOffset = (blockId * numHeadSlices + sliceIdx) * slice.headSliceBytes;
+}
+
+} // namespace
+
+// One CUDA block per (head slice, cache block), head slices are contiguous on both sides.
+template <typename VecT>
+__global__ void gatherKvCacheSliceKernel(void* dst, void const* const* srcBlocks, KvCacheBlockSlice slice)
+{
+    auto const blockId = static_cast<int64_t>(blockIdx.y);
+    int64_t blockOffset;
+    int64_t bufferOffset;
+    getHeadSliceOffsets(slice, blockId, blockIdx.x, blockOffset, bufferOffset);
+    auto const* src = reinterpret_cast<VecT const*>(static_cast<uint8_t const*>(srcBlocks[blockId]) + blockOffset);
+    auto* out = reinterpret_cast<VecT*>(static_cast<uint8_t*>(dst) + bufferOffset);
+    auto const numVecs = slice.headSliceBytes / static_cast<int64_t>(sizeof(VecT));
+    for (int64_t idx = threadIdx.x; idx < numVecs; idx += blockDim.x)
+    {
+        out[idx] = src[idx];
+    }
+}
+
+template <typename VecT>
+__global__ void scatterKvCacheSliceKernel(void* const* dstBlocks, void const* src, KvCacheBlockSlice slice)
+{
+    auto const blockId = static_cast<int64_t>(blockIdx.y);
+    int64_t blockOffset;
+    int64_t bufferOffset;
+    getHeadSliceOffsets(slice, blockId, blockIdx.x, blockOffset, bufferOffset);
+    auto const* in = reinterpret_cast<VecT const*>(static_cast<uint8_t const*>(src) + bufferOffset);
+    auto* out = reinterpret_cast<VecT*>(static_cast<uint8_t*>(dstBlocks[blockId]) + blockOffset);
+    auto const numVecs = slice.headSliceBytes / static_cast<int64_t>(sizeof(VecT));
+    for (int64_t idx = threadIdx.x; idx < numVecs; idx += blockDim.x)
+    {
+        out[idx] = in[idx];
+    }
+}
+
+namespace
+{
+
+dim3 getGrid(int32_t numBlocks, KvCacheBlockSlice const& slice)
+{
+    TLLM_CHECK_WITH_INFO(numBlocks <= 65535, "Too many blocks to reshard at once (%d)", numBlocks);
+    TLLM_CHECK_WITH_INFO(slice.layerBegin >= 0 && slice.layerBegin + slice.numSliceLayers <= slice.numLayers,
+        "Layers [%d, %d) out of range [0, %d)", slice.layerBegin, slice.layerBegin + slice.numSliceLayers,
+        slice.numLayers);
+    TLLM_CHECK_WITH_INFO(slice.headBegin >= 0 && slice.headBegin + slice.numSliceHeads <= slice.numKvHeads,
+        "Heads [%d, %d) out of range [0, %d)", slice.headBegin, slice.headBegin + slice.numSliceHeads,
+        slice.numKvHeads);
+    return dim3(slice.numSliceLayers * 2 * slice.numSliceHeads, numBlocks);
+}
+
+} // namespace
+
+void invokeGatherKvCacheSlice(
+    void* dst, void const* const* srcBlocks, int32_t numBlocks, KvCacheBlockSlice const& slice, cudaStream_t stream)
+{
+    auto const grid = getGrid(numBlocks, slice);
+    if (numBlocks == 0 || grid.x == 0)
+    {
+        return;
+    }
+    // Head slices of the usual head sizes are multiples of 16 bytes, blocks and buffers are allocated aligned
+    if (slice.headSliceBytes % sizeof(uint4) == 0)
+    {
+        gatherKvCacheSliceKernel<uint4><<<grid, kBlockSize, 0, stream>>>(dst, srcBlocks, slice);
+    }
+    else
+    {
+        gatherKvCacheSliceKernel<uint8_t><<<grid, kBlockSize, 0, stream>>>(dst, srcBlocks, slice);
+    }
+    sync_check_cuda_error();
+}
+
+void invokeScatterKvCacheSlice(
+    void* const* dstBlocks, void const* src, int32_t numBlocks, KvCacheBlockSlice const& slice, cudaStream_t stream)
+{
+    auto const grid = getGrid(numBlocks, slice);
+    if (numBlocks == 0 || grid.x == 0)
+    {
+        return;
+    }
+    if (slice.headSliceBytes % sizeof(uint4) == 0)
+    {
+        scatterKvCacheSliceKernel<uint4><<<grid, kBlockSize, 0, stream>>>(dstBlocks, src, slice);
+    }
+    else
+    {
+        scatterKvCacheSliceKernel<uint8_t><<<grid, kBlockSize, 0, stream>>>(dstBlocks, src, slice);
+    }
+    sync_check_cuda_error();
+}
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+//! \brief A range of layers and KV heads inside the blocks of a KV cache pool.
+//! \details A block is laid out as [numLayers, 2, numKvHeads, tokensPerBlock, sizePerHead], so every (layer, K/V,
+//! head) is a contiguous head slice of headSliceBytes = tokensPerBlock * sizePerHead * sizeof(element) bytes.
+struct KvCacheBlockSlice
+{
+    //! The layout of the blocks
+    int32_t numLayers;
+    int32_t numKvHeads;
+    int64_t headSliceBytes;
+    //! The range, relative to the blocks
+    int32_t layerBegin;
+    int32_t numSliceLayers;
+    int32_t headBegin;
+    int32_t numSliceHeads;
+};
+
+//! \brief Gather a slice out of KV cache blocks into a contiguous buffer, to send it to a rank with another layout.
+//! \param dst [numBlocks, numSliceLayers, 2, numSliceHeads, headSliceBytes], device memory
+//! \param srcBlocks Pointers to the numBlocks source blocks, device memory
+void invokeGatherKvCacheSlice(
+    void* dst, void const* const* srcBlocks, int32_t numBlocks, KvCacheBlockSlice const& slice, cudaStream_t stream);
+
+//! \brief Inverse of invokeGatherKvCacheSlice, writes a received buffer into the KV cache blocks of the receiver.
+//! \param dstBlocks Pointers to the numBlocks destination blocks, device memory
+void invokeScatterKvCacheSlice(
+    void* const* dstBlocks, void const* src, int32_t numBlocks, KvCacheBlockSlice const& slice, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
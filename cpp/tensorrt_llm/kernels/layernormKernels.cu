@@ -15,6 +15,7 @@
  */
 
 #include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/quantTypeUtils.cuh"
 #include "tensorrt_llm/common/reduceKernelUtils.cuh"
 #include "tensorrt_llm/kernels/layernormKernels.h"
 
@@ -26,16 +27,34 @@ namespace kernels
 {
 
 template <typename Tf, typename T>
-__inline__ __device__ Tf compute_layernorm(Tf val, float s_mean, float s_variance, T const* gamma, T const* beta, int i)
+__inline__ __device__ Tf compute_layernorm(
+    Tf val, float s_mean, float s_variance, T const* gamma, T const* beta, T const* pre_quant_scale, int i)
 {
     Tf ret = (val - s_mean) * s_variance * cuda_cast<Tf>(gamma[i]);
     if (beta != nullptr)
     {
         ret = ret + cuda_cast<Tf>(beta[i]);
     }
+    if (pre_quant_scale != nullptr)
+    {
+        ret = ret * cuda_cast<Tf>(pre_quant_scale[i]);
+    }
     return ret;
 }
 
+// The input of the norm, with the residual added in the precision of the residual stream, as the separate add did.
+template <typename T>
+__inline__ __device__ T load_layernorm_input(T const* input, T const* residual, int index)
+{
+    using float_packed_t = typename packed_as<float, num_elems<T>::value>::type;
+    T val = input[index];
+    if (residual != nullptr)
+    {
+        val = cuda_cast<T>(cuda_cast<float_packed_t>(val) + cuda_cast<float_packed_t>(residual[index]));
+    }
+    return val;
+}
+
 /* Computes the layernorm https://pytorch.org/docs/stable/generated/torch.nn.LayerNorm.html
  * normed_output <- ( (input - E[input]) / Sqrt(Var[input] + eps) ) * gamma + beta
  * input is [tokens, hidden_dim]. Mean and Variance are per-row (i.e. per-token)
@@ -54,19 +73,29 @@ __inline__ __device__ Tf compute_layernorm(Tf val, float s_mean, float s_varianc
  * use_shmem controls if we cache input values into shared memory
  *
  * Optional: with dynamic scaling, the last pass doesn't write immediately but finds the
- *           amax per row. A final pass scales to int8 accordingly, and writes output to
+ *           amax per row. A final pass scales to int8 or fp8 accordingly, and writes output to
  *           normed_output_quant.
+ *
+ * Optional: with a residual, the norm applies to input + residual and the sum is written to residual_out, the
+ *           residual of the next layer. With a pre-quant scale, the normed output is scaled per channel before
+ *           quantization, see generalRmsNorm.
  */
-template <typename T, bool USE_DIFF_OF_SQUARES = false>
+template <typename T, typename QuantT, bool USE_DIFF_OF_SQUARES = false>
 __global__ void generalLayerNorm(T const* input, T const* gamma, T const* beta, T* normed_output, float const eps,
     int tokens, int hidden_dim, float const* scale_orig_quant_per_tensor, float* scale_orig_quant_per_token,
-    int8_t* normed_output_quant, bool use_shmem)
+    QuantT* normed_output_quant, bool use_shmem, T const* residual, T* residual_out, T const* pre_quant_scale)
 {
     constexpr auto num_elems_T = num_elems<T>::value;
-    using int8_packed_t = typename packed_as<int8_t, num_elems_T>::type;
+    using QuantT_packed_t = typename packed_as<QuantT, num_elems_T>::type;
     using float_packed_t = typename packed_as<float, num_elems_T>::type;
     using T_scalar = typename packed_as<T, 1>::type;
 
+    // The quantized data type's maximum value (upper-bound).
+    static constexpr float MAX_QUANT_VAL = QuantTypeStaticVals<QuantT>::MAX_VAL;
+    // The minimum scaling factor (lower-bound), keeps fp8 scales of near-zero rows representable. No-op for int8.
+    static constexpr float MIN_SCALING_FACTOR = QuantTypeStaticVals<QuantT>::MIN_SCALING_FACTOR;
+    static constexpr float MIN_SCALING_FACTOR_RCP = QuantTypeStaticVals<QuantT>::MIN_SCALING_FACTOR_RCP;
+
     extern __shared__ __align__(sizeof(float)) char _shmem[];
     T* shmem = reinterpret_cast<T*>(_shmem);
     __shared__ float s_mean;
@@ -83,11 +112,15 @@ __global__ void generalLayerNorm(T const* input, T const* gamma, T const* beta,
     int const n_elems = hidden_dim / num_elems_T;
     for (int i = tidx; i < n_elems; i += blockDim.x)
     {
-        const T val = input[bidx * n_elems + i];
+        const T val = load_layernorm_input(input, residual, bidx * n_elems + i);
         if (use_shmem)
         {
             shmem[i] = val;
         }
+        if (residual_out != nullptr)
+        {
+            residual_out[bidx * n_elems + i] = val;
+        }
 
         const float_packed_t val_f = cuda_cast<float_packed_t>(val);
         local_sum += cuda_sum<float>(val_f);
@@ -121,11 +154,16 @@ __global__ void generalLayerNorm(T const* input, T const* gamma, T const* beta,
     }
     __syncthreads();
 
+    // Without the shared memory cache, later passes read the sum back, which also works when residual_out is input
+    T const* reload_input = residual_out != nullptr ? residual_out : input;
+    T const* reload_residual = residual_out != nullptr ? nullptr : residual;
+
     if (!USE_DIFF_OF_SQUARES)
     {
         for (int i = tidx; i < n_elems; i += blockDim.x)
         {
-            const T val = use_shmem ? shmem[i] : input[bidx * n_elems + i];
+            int const index = bidx * n_elems + i;
+            const T val = use_shmem ? shmem[i] : load_layernorm_input(reload_input, reload_residual, index);
             float_packed_t diff = cuda_cast<float_packed_t>(val) - s_mean;
             local_var_sum += cuda_sum<float>(diff * diff);
         }
@@ -147,8 +185,9 @@ __global__ void generalLayerNorm(T const* input, T const* gamma, T const* beta,
     for (int i = tidx; i < n_elems; i += blockDim.x)
     {
         int const index = bidx * n_elems + i;
-        const float_packed_t val_f = cuda_cast<float_packed_t>(use_shmem ? shmem[i] : input[index]);
-        const T val = cuda_cast<T>(compute_layernorm(val_f, s_mean, s_variance, gamma, beta, i));
+        const T val_in = use_shmem ? shmem[i] : load_layernorm_input(reload_input, reload_residual, index);
+        const float_packed_t val_f = cuda_cast<float_packed_t>(val_in);
+        const T val = cuda_cast<T>(compute_layernorm(val_f, s_mean, s_variance, gamma, beta, pre_quant_scale, i));
 
         if (with_per_token_scaling)
         {
@@ -160,8 +199,8 @@ __global__ void generalLayerNorm(T const* input, T const* gamma, T const* beta,
         }
         else if (with_per_tensor_scaling)
         {
-            reinterpret_cast<int8_packed_t*>(normed_output_quant)[index]
-                = cuda_cast<int8_packed_t>(cuda_cast<float_packed_t>(val) * scale_orig_quant);
+            reinterpret_cast<QuantT_packed_t*>(normed_output_quant)[index]
+                = cuda_cast<QuantT_packed_t>(cuda_cast<float_packed_t>(val) * scale_orig_quant);
         }
         else
         {
@@ -172,65 +211,67 @@ __global__ void generalLayerNorm(T const* input, T const* gamma, T const* beta,
     if (with_per_token_scaling)
     {
         float abs_max_f = blockAllReduceMax(cuda_cast<float>(amax));
-        float const dynamic_per_token_scale = 127.f / abs_max_f;
+        float const dynamic_per_token_scale = fminf(MAX_QUANT_VAL / abs_max_f, MIN_SCALING_FACTOR_RCP);
         for (int i = tidx; i < n_elems; i += blockDim.x)
         {
             int const index = bidx * n_elems + i;
-            float_packed_t val_f = cuda_cast<float_packed_t>(use_shmem ? shmem[i] : input[index]);
+            const T val_in = use_shmem ? shmem[i] : load_layernorm_input(reload_input, reload_residual, index);
+            float_packed_t val_f = cuda_cast<float_packed_t>(val_in);
             if (!use_shmem)
             {
-                val_f = compute_layernorm(val_f, s_mean, s_variance, gamma, beta, i);
+                val_f = compute_layernorm(val_f, s_mean, s_variance, gamma, beta, pre_quant_scale, i);
             }
 
-            reinterpret_cast<int8_packed_t*>(normed_output_quant)[index]
-                = cuda_cast<int8_packed_t>(val_f * cuda_cast<float_packed_t>(dynamic_per_token_scale));
+            reinterpret_cast<QuantT_packed_t*>(normed_output_quant)[index]
+                = cuda_cast<QuantT_packed_t>(val_f * cuda_cast<float_packed_t>(dynamic_per_token_scale));
         }
         if (tidx == 0)
         {
-            scale_orig_quant_per_token[bidx] = abs_max_f / 127.f;
+            scale_orig_quant_per_token[bidx] = fmaxf(abs_max_f / MAX_QUANT_VAL, MIN_SCALING_FACTOR);
         }
     }
 }
 
-template <bool USE_DIFF_OF_SQUARES, typename T>
+template <bool USE_DIFF_OF_SQUARES, typename T, typename QuantT>
 void dispatch_layernorm_type_square_method(T const* input, T const* gamma, T const* beta, T* normed_output,
     float const eps, int tokens, int hidden_dim, float const* scale_orig_quant_per_tensor,
-    float* scale_orig_quant_per_token, int8_t* normed_output_quant, const dim3 grid, const dim3 block,
-    const size_t shmem_size, cudaStream_t stream)
+    float* scale_orig_quant_per_token, QuantT* normed_output_quant, T const* residual, T* residual_out,
+    T const* pre_quant_scale, const dim3 grid, const dim3 block, const size_t shmem_size, cudaStream_t stream)
 {
     if (shmem_size >= (48 << 10))
     {
-        cudaError_t ret = cudaFuncSetAttribute(
-            generalLayerNorm<T, USE_DIFF_OF_SQUARES>, cudaFuncAttributeMaxDynamicSharedMemorySize, shmem_size);
+        cudaError_t ret = cudaFuncSetAttribute(generalLayerNorm<T, QuantT, USE_DIFF_OF_SQUARES>,
+            cudaFuncAttributeMaxDynamicSharedMemorySize, shmem_size);
     }
-    generalLayerNorm<T, USE_DIFF_OF_SQUARES><<<grid, block, shmem_size, stream>>>(input, gamma, beta, normed_output,
-        eps, tokens, hidden_dim, scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, true);
+    generalLayerNorm<T, QuantT, USE_DIFF_OF_SQUARES><<<grid, block, shmem_size, stream>>>(input, gamma, beta,
+        normed_output, eps, tokens, hidden_dim, scale_orig_quant_per_tensor, scale_orig_quant_per_token,
+        normed_output_quant, true, residual, residual_out, pre_quant_scale);
 }
 
-template <typename T>
+template <typename T, typename QuantT>
 void dispatch_layernorm_type(T const* input, T const* gamma, T const* beta, T* normed_output, float const eps,
     int tokens, int hidden_dim, float const* scale_orig_quant_per_tensor, float* scale_orig_quant_per_token,
-    int8_t* normed_output_quant, const dim3 grid, const dim3 block, const size_t shmem_size, cudaStream_t stream,
-    bool use_diff_of_squares)
+    QuantT* normed_output_quant, T const* residual, T* residual_out, T const* pre_quant_scale, const dim3 grid,
+    const dim3 block, const size_t shmem_size, cudaStream_t stream, bool use_diff_of_squares)
 {
     if (use_diff_of_squares)
     {
         dispatch_layernorm_type_square_method<true>(input, gamma, beta, normed_output, eps, tokens, hidden_dim,
-            scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, grid, block, shmem_size,
-            stream);
+            scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, residual, residual_out,
+            pre_quant_scale, grid, block, shmem_size, stream);
     }
     else
     {
         dispatch_layernorm_type_square_method<false>(input, gamma, beta, normed_output, eps, tokens, hidden_dim,
-            scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, grid, block, shmem_size,
-            stream);
+            scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, residual, residual_out,
+            pre_quant_scale, grid, block, shmem_size, stream);
     }
 }
 
-template <typename T>
+template <typename T, typename QuantT>
 void invokeGeneralLayerNorm(T* out, T const* input, T const* gamma, T const* beta, float const eps, int const tokens,
     int const hidden_dim, cudaStream_t stream, bool use_diff_of_squares, float const* scale, float* dynamic_scale,
-    int8_t* normed_output_quant)
+    QuantT* normed_output_quant, T const* residual, T* residual_out, T const* pre_quant_scale)
 {
     dim3 grid(tokens);
     dim3 block(min(hidden_dim, 1024));
@@ -251,25 +292,37 @@ void invokeGeneralLayerNorm(T* out, T const* input, T const* gamma, T const* bet
         using Tp = typename packed_as<T, vec_size>::type;
         dispatch_layernorm_type(reinterpret_cast<Tp const*>(input), reinterpret_cast<Tp const*>(gamma),
             reinterpret_cast<Tp const*>(beta), reinterpret_cast<Tp*>(out), eps, tokens, hidden_dim, scale,
-            dynamic_scale, normed_output_quant, grid, block, shmem_size, stream, use_diff_of_squares);
+            dynamic_scale, normed_output_quant, reinterpret_cast<Tp const*>(residual),
+            reinterpret_cast<Tp*>(residual_out), reinterpret_cast<Tp const*>(pre_quant_scale), grid, block,
+            shmem_size, stream, use_diff_of_squares);
     }
     else
     {
         dispatch_layernorm_type(input, gamma, beta, out, eps, tokens, hidden_dim, scale, dynamic_scale,
-            normed_output_quant, grid, block, shmem_size, stream, use_diff_of_squares);
+            normed_output_quant, residual, residual_out, pre_quant_scale, grid, block, shmem_size, stream,
+            use_diff_of_squares);
     }
 }
 
-#define INSTANTIATE_GENERAL_LAYERNORM(T)                                                                               \
+#define INSTANTIATE_GENERAL_LAYERNORM(T, QuantT)                                                                       \
     template void invokeGeneralLayerNorm(T* out, const T* input, const T* gamma, const T* beta, const float eps,       \
         const int tokens, const int hidden_dim, cudaStream_t stream, bool use_diff_of_squares, const float* scale,     \
-        float* dynamic_scale, int8_t* normed_output_quant);
+        float* dynamic_scale, QuantT* normed_output_quant, T const* residual, T* residual_out,                         \
+        T const* pre_quant_scale);
 
-INSTANTIATE_GENERAL_LAYERNORM(float);
-INSTANTIATE_GENERAL_LAYERNORM(half);
+INSTANTIATE_GENERAL_LAYERNORM(float, int8_t);
+INSTANTIATE_GENERAL_LAYERNORM(half, int8_t);
 
 #ifdef ENABLE_BF16
-INSTANTIATE_GENERAL_LAYERNORM(__nv_bfloat16);
+INSTANTIATE_GENERAL_LAYERNORM(__nv_bfloat16, int8_t);
+#endif
+
+#ifdef ENABLE_FP8
+INSTANTIATE_GENERAL_LAYERNORM(float, __nv_fp8_e4m3);
+INSTANTIATE_GENERAL_LAYERNORM(half, __nv_fp8_e4m3);
+#ifdef ENABLE_BF16
+INSTANTIATE_GENERAL_LAYERNORM(__nv_bfloat16, __nv_fp8_e4m3);
+#endif
 #endif
 
 } // namespace kernels
@@ -26,10 +26,13 @@ namespace tensorrt_llm
 namespace kernels
 {
 
-template <typename T>
+//! QuantT is int8_t or __nv_fp8_e4m3. With residual, normalizes input + residual and writes the sum to residual_out
+//! if set. With pre_quant_scale [hidden_dim], scales the normed output per channel before it is quantized or written.
+template <typename T, typename QuantT = int8_t>
 void invokeGeneralLayerNorm(T* out, T const* input, T const* gamma, T const* beta, float const eps, int const tokens,
     int const hidden_dim, cudaStream_t stream = 0, bool use_diff_of_squares = true, float const* scale = nullptr,
-    float* dynamic_scale = nullptr, int8_t* out_quant = nullptr);
+    float* dynamic_scale = nullptr, QuantT* out_quant = nullptr, T const* residual = nullptr,
+    T* residual_out = nullptr, T const* pre_quant_scale = nullptr);
 
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/lmHeadGemv.h"
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+// A warp computes one column of the logits, its lanes take 16 weights of the row at a time. The row is reused from
+// L1 for every tile of kTileM rows, so the weights are read from DRAM once whatever m is.
+constexpr int kThreads = 256;
+constexpr int kWarps = kThreads / 32;
+constexpr int kTileM = 4;
+constexpr int kVecSize = kLmHeadGemvKAlignment;
+
+template <typename T, typename WeightT>
+__global__ void lmHeadGemvKernel(float* logits, T const* act, WeightT const* weight, float const* scales,
+    int const* lastTokenIds, int seqStride, int m, int n, int k)
+{
+    static_assert(sizeof(WeightT) == 1, "The weights must take a byte per element");
+    int const warp = threadIdx.x / 32;
+    int const lane = threadIdx.x % 32;
+    int const col = blockIdx.x * kWarps + warp;
+    if (col >= n)
+    {
+        return;
+    }
+    // 16 activations of a row take one or two vectors of 16 bytes
+    constexpr int kActVecs = kVecSize * sizeof(T) / sizeof(uint4);
+    auto const* weightRow = weight + static_cast<size_t>(col) * k;
+    float const scale = scales[col];
+
+    for (int tileRow = 0; tileRow < m; tileRow += kTileM)
+    {
+        T const* rows[kTileM];
+#pragma unroll
+        for (int i = 0; i < kTileM; ++i)
+        {
+            int const row = tileRow + i;
+            if (row < m)
+            {
+                auto const actRow = lastTokenIds != nullptr ? row * seqStride + lastTokenIds[row] - 1 : row;
+                rows[i] = act + static_cast<size_t>(actRow) * k;
+            }
+            else
+            {
+                rows[i] = nullptr;
+            }
+        }
+
+        float acc[kTileM] = {};
+        for (int c = lane * kVecSize; c < k; c += 32 * kVecSize)
+        {
+            uint4 const weightVec = *reinterpret_cast<uint4 const*>(weightRow + c);
+            auto const* w = reinterpret_cast<WeightT const*>(&weightVec);
+            float wf[kVecSize];
+#pragma unroll
+            for (int j = 0; j < kVecSize; ++j)
+            {
+                wf[j] = cuda_cast<float>(w[j]);
+            }
+#pragma unroll
+            for (int i = 0; i < kTileM; ++i)
+            {
+                if (rows[i] == nullptr)
+                {
+                    continue;
+                }
+                uint4 actVec[kActVecs];
+#pragma unroll
+                for (int v = 0; v < kActVecs; ++v)
+                {
+                    actVec[v] = reinterpret_cast<uint4 const*>(rows[i] + c)[v];
+                }
+                auto const* a = reinterpret_cast<T const*>(actVec);
+#pragma unroll
+                for (int j = 0; j < kVecSize; ++j)
+                {
+                    acc[i] += cuda_cast<float>(a[j]) * wf[j];
+                }
+            }
+        }
+
+#pragma unroll
+        for (int i = 0; i < kTileM; ++i)
+        {
+#pragma unroll
+            for (int offset = 16; offset > 0; offset /= 2)
+            {
+                acc[i] += __shfl_xor_sync(0xffffffff, acc[i], offset);
+            }
+            int const row = tileRow + i;
+            if (lane == 0 && row < m)
+            {
+                logits[static_cast<size_t>(row) * n + col] = acc[i] * scale;
+            }
+        }
+    }
+}
+
+} // namespace
+
+template <typename T, typename WeightT>
+void invokeLmHeadGemv(float* logits, T const* act, WeightT const* weight, float const* scales,
+    int const* lastTokenIds, int seqStride, int m, int n, int k, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(k > 0 && k % kLmHeadGemvKAlignment == 0,
+        "The LM head GEMV needs k (%d) to be a multiple of %d.", k, kLmHeadGemvKAlignment);
+    if (m == 0 || n == 0)
+    {
+        return;
+    }
+    dim3 const grid((n + kWarps - 1) / kWarps);
+    lmHeadGemvKernel<T, WeightT>
+        <<<grid, kThreads, 0, stream>>>(logits, act, weight, scales, lastTokenIds, seqStride, m, n, k);
+    sync_check_cuda_error();
+}
+
+#define INSTANTIATE_LM_HEAD_GEMV(T, WeightT)                                                                           \
+    template void invokeLmHeadGemv<T, WeightT>(float* logits, T const* act, WeightT const* weight,                     \
+        float const* scales, int const* lastTokenIds, int seqStride, int m, int n, int k, cudaStream_t stream)
+
+INSTANTIATE_LM_HEAD_GEMV(half, int8_t);
+#ifdef ENABLE_FP8
+INSTANTIATE_LM_HEAD_GEMV(half, __nv_fp8_e4m3);
+#endif
+#ifdef ENABLE_BF16
+INSTANTIATE_LM_HEAD_GEMV(__nv_bfloat16, int8_t);
+#ifdef ENABLE_FP8
+INSTANTIATE_LM_HEAD_GEMV(__nv_bfloat16, __nv_fp8_e4m3);
+#endif
+#endif
+
+#undef INSTANTIATE_LM_HEAD_GEMV
+
+} // namespace kernels
+} // namespace tensorrt_llm
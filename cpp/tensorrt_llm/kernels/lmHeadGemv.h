@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+// The weight rows are read 16 bytes at a time, k must be a multiple of this.
+static constexpr int kLmHeadGemvKAlignment = 16;
+
+//! \brief logits[i, j] = (sum over c of act[row(i), c] * weight[j, c]) * scales[j], accumulated and written in fp32.
+//!
+//! The LM head of a quantized model: the weights take a byte per element, half the bytes of the fp16/bf16 head that
+//! every decoding step reads, and the logits keep full precision for sampling.
+//!
+//! \param logits [m, n] row-major fp32 output.
+//! \param act Activations of the hidden states, k contiguous.
+//! \param weight [n, k] int8 or e4m3 weights, k contiguous like the lm_head weights of the checkpoint.
+//! \param scales [n] per-channel dequantization scales of the weights.
+//! \param lastTokenIds Optional [m] 1-based positions of the last token of every sequence, which fuses the gather of
+//! the last tokens into the GEMM: row(i) = i * seqStride + lastTokenIds[i] - 1. Without it row(i) = i.
+//! \param seqStride Rows of act per sequence for padded inputs, 0 for packed inputs whose lastTokenIds are the
+//! cumulative sequence lengths.
+//!
+//! k must be a multiple of kLmHeadGemvKAlignment. The kernel is a GEMV on the CUDA cores meant for the decoding
+//! steps: the weights are read from DRAM once, but the FMAs grow with m, so it does not suit the context phase
+//! without the gather.
+template <typename T, typename WeightT>
+void invokeLmHeadGemv(float* logits, T const* act, WeightT const* weight, float const* scales,
+    int const* lastTokenIds, int seqStride, int m, int n, int k, cudaStream_t stream);
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -17,6 +17,9 @@
 #include "tensorrt_llm/common/cudaTypeUtils.cuh"
 #include "tensorrt_llm/kernels/lookupKernels.h"
 
+#include <algorithm>
+#include <cstdint>
+
 using namespace tensorrt_llm::common;
 
 namespace tensorrt_llm
@@ -54,22 +57,95 @@ __global__ void lookup_kernel(Tout* output, Idx const* input, Tin const* weight,
         }
         else
         {
-            embedding = (Tout) weight[word_index * n_embed + col_index];
-            if (perTokenScales != nullptr)
-            {
-                embedding *= perTokenScales[word_index];
-            }
+            float const scale = perTokenScales != nullptr ? cuda_cast<float>(perTokenScales[word_index]) : 1.f;
+            embedding = cuda_cast<Tout>(cuda_cast<float>(weight[word_index * n_embed + col_index]) * scale);
         }
         output[index] = embedding;
     } // end for index
 }
 
+/* Vectorized variant for long prefills. A group of threads gathers the row of one token with VEC-element loads and
+stores, so that the id is read, and the offset applied, once per token instead of once per element. When the hidden size
+is small, a warp holds several groups and gathers several tokens at once. Quantized tables (INT8, FP8) are dequantized
+by the per-row scale of the looked-up word in FP32.
+ */
+template <typename Tout, typename Tin, typename Idx, int VEC>
+__global__ void lookup_vec_kernel(Tout* output, Idx const* input, Tin const* weight, int64_t const token_num,
+    Idx const offset, Idx const size, Idx const n_embed, Tout const* perTokenScales, int const threads_per_token)
+{
+    struct alignas(sizeof(Tout) * VEC) OutVec
+    {
+        Tout v[VEC];
+    };
+
+    struct alignas(sizeof(Tin) * VEC) InVec
+    {
+        Tin v[VEC];
+    };
+
+    int const lane = threadIdx.x % threads_per_token;
+    int64_t const tokens_per_block = blockDim.x / threads_per_token;
+    Idx const vec_num = n_embed / VEC;
+    for (int64_t token = blockIdx.x * tokens_per_block + threadIdx.x / threads_per_token; token < token_num;
+         token += gridDim.x * tokens_per_block)
+    {
+        int64_t const word_index = input[token] - offset;
+        bool const valid = word_index >= 0 && word_index < size;
+        float const scale = valid && perTokenScales != nullptr ? cuda_cast<float>(perTokenScales[word_index]) : 1.f;
+        auto* out_row = reinterpret_cast<OutVec*>(output + token * n_embed);
+        auto const* in_row = reinterpret_cast<InVec const*>(weight + (valid ? word_index : 0) * n_embed);
+        for (Idx vec_index = lane; vec_index < vec_num; vec_index += threads_per_token)
+        {
+            OutVec embedding;
+            if (valid)
+            {
+                InVec const packed = in_row[vec_index];
+#pragma unroll
+                for (int i = 0; i < VEC; ++i)
+                {
+                    embedding.v[i] = cuda_cast<Tout>(cuda_cast<float>(packed.v[i]) * scale);
+                }
+            }
+            else
+            {
+#pragma unroll
+                for (int i = 0; i < VEC; ++i)
+                {
+                    embedding.v[i] = Tout(0.f);
+                }
+            }
+            out_row[vec_index] = embedding;
+        }
+    }
+}
+
 template <typename Tout, typename Tin, typename Idx>
 void invokeLookUp(Tout* out, Idx const* input, Tin const* weight, int64_t const token_num, Idx const offset,
     Idx const size, Idx const n_embed, Tout const* perTokenScales, cudaStream_t stream)
 {
     int64_t constexpr max_block_num = 65536;
     Idx constexpr max_block_size = 512;
+
+    // 16-byte stores of the output, the loads of a quantized table are narrower
+    int constexpr vec_size = 16 / sizeof(Tout);
+    bool const aligned = n_embed % vec_size == 0 && reinterpret_cast<uintptr_t>(out) % 16 == 0
+        && reinterpret_cast<uintptr_t>(weight) % (sizeof(Tin) * vec_size) == 0;
+    if (aligned)
+    {
+        int const warp_size = 32;
+        int threads_per_token = 1;
+        while (threads_per_token < warp_size && threads_per_token * vec_size < n_embed)
+        {
+            threads_per_token *= 2;
+        }
+        int const block_size = 256;
+        int64_t const tokens_per_block = block_size / threads_per_token;
+        dim3 grid(std::min((token_num + tokens_per_block - 1) / tokens_per_block, max_block_num));
+        lookup_vec_kernel<Tout, Tin, Idx, vec_size><<<grid, block_size, 0, stream>>>(
+            out, input, weight, token_num, offset, size, n_embed, perTokenScales, threads_per_token);
+        return;
+    }
+
     dim3 grid(min(token_num, max_block_num));
     dim3 block(min(n_embed, max_block_size));
     lookup_kernel<Tout, Tin, Idx>
@@ -91,5 +167,13 @@ INSTANTIATE_LOOK_UP(__nv_bfloat16, __nv_bfloat16, int);
 INSTANTIATE_LOOK_UP(__nv_bfloat16, int8_t, int);
 #endif
 
+#ifdef ENABLE_FP8
+INSTANTIATE_LOOK_UP(float, __nv_fp8_e4m3, int);
+INSTANTIATE_LOOK_UP(half, __nv_fp8_e4m3, int);
+#ifdef ENABLE_BF16
+INSTANTIATE_LOOK_UP(__nv_bfloat16, __nv_fp8_e4m3, int);
+#endif
+#endif
+
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -21,6 +21,7 @@
 #include "tensorrt_llm/common/cublasMMWrapper.h"
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/kernels/groupGemm.h"
+#include "tensorrt_llm/kernels/lora/loraSgmv.h"
 #include "tensorrt_llm/kernels/splitkGroupGemm.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 
@@ -34,6 +35,12 @@ using tensorrt_llm::kernels::CublasGemmWrapperPtr;
 namespace tensorrt_llm::kernels
 {
 
+namespace
+{
+// Beyond this many tokens the CUDA core SGMV kernels lose to the tensor core grouped GEMMs.
+int64_t constexpr kSgmvMaxTokens = 512;
+} // namespace
+
 // TODO should reuse the function in gemmPlugin
 void _getProblemParams(cublasOperation_t& transa, cublasOperation_t& transb, int& m, int& n, int& k, int& lda, int& ldb,
     int& ldc, bool transA, bool transB, int M, int N, int K)
@@ -75,6 +82,7 @@ LoraImpl::LoraImpl(int in_hidden_size, std::vector<int> out_hidden_sizes, int tr
     , mType(type)
     , mMaxLowRank(max_low_rank)
     , mCublasWrapper(cublasWrapper)
+    , mQuantizedWeightType(getLoraQuantizedCacheType())
 {
     mOutHiddenSizes.resize(mNumLoraModules);
     mOutHiddenSizes.assign(out_hidden_sizes.begin(), out_hidden_sizes.end());
@@ -110,6 +118,11 @@ int64_t getGemmParamsWorkSpaceSize(int64_t nbReq)
     return std::max(getSplitkGroupedGemmParamsWorkSpaceSize(nbReq), getGroupedGemmParamsWorkSpaceSize(nbReq));
 }
 
+int64_t getSgmvParamsWorkSpaceSize(int64_t numTokens, int64_t numReqs, int64_t maxLoraModuleNum)
+{
+    return getLoraSgmvTilesWorkSpaceSize(maxLoraModuleNum * getLoraSgmvMaxTiles(numTokens, numReqs));
+}
+
 int64_t getSplitkGroupedGemmWorkSpaceSize(
     int64_t numTokens, int64_t maxLoraModuleNum, int64_t maxLowRank, int64_t splitKSlices)
 {
@@ -132,7 +145,8 @@ size_t LoraImpl::getWorkspaceSize(
 
     return (size_t) getGemmWorkSpaceSize(numTokens, mNumLoraModules, mMaxLowRank, mSplitKSlices)
         + getLowRankWorkSpaceSize(numTokens, mNumLoraModules, mMaxLowRank, typeSize)
-        + getGemmParamsWorkSpaceSize(numReqs * mNumLoraModules);
+        + std::max(getGemmParamsWorkSpaceSize(numReqs * mNumLoraModules),
+            getSgmvParamsWorkSpaceSize(numTokens, numReqs, mNumLoraModules));
 }
 
 void LoraImpl::setBestTactic(std::optional<Config> config)
@@ -193,6 +207,19 @@ int LoraImpl::run(int64_t numTokens, int64_t numReqs, void const* input, int32_t
         }
     }
 
+    // SGMV runs any mix of adapters and ranks in two launches, long prefill segments are better served by the tensor
+    // core grouped GEMMs.
+    char* useSgmvChar = std::getenv("LORA_USE_SGMV");
+    bool useSgmv = !useUnifiedGemm && (useSgmvChar == nullptr || std::string(useSgmvChar) != "OFF")
+        && numTokens <= kSgmvMaxTokens && mInHiddenSize % 8 == 0 && mTransA == false && mTransB == true;
+    if (mQuantizedWeightType)
+    {
+        TLLM_CHECK_WITH_INFO(mInHiddenSize % 8 == 0 && mTransA == false && mTransB == true && weightIndex == 0,
+            "Quantized LoRA cache pages are only supported by the SGMV LoRA kernels");
+        useUnifiedGemm = false;
+        useSgmv = true;
+    }
+
     // TODO can add batch_size == 1 case
     if (useUnifiedGemm)
     {
@@ -231,6 +258,31 @@ int LoraImpl::run(int64_t numTokens, int64_t numReqs, void const* input, int32_t
             }
         }
     }
+    else if (useSgmv)
+    {
+        std::vector<LoraSgmvTile> tiles;
+        int32_t maxOutHiddenSize = 0;
+        for (int loraModuleIdx = 0; loraModuleIdx < mNumLoraModules; loraModuleIdx++)
+        {
+            int64_t const* loraWeightsPtrModule
+                = reinterpret_cast<int64_t const*>(&loraWeightsPtr[loraModuleIdx * numTokens * 2]);
+            void* lowRankModule
+                = static_cast<char*>(lowRankWorkSpace) + loraModuleIdx * numTokens * mMaxLowRank * typeSize;
+            appendLoraSgmvTiles(tiles, numTokens, &loraRanks[loraModuleIdx * numTokens], loraWeightsPtrModule,
+                mInHiddenSize, mOutHiddenSizes[loraModuleIdx], weightIndex, typeSize, lowRankModule,
+                outputs[loraModuleIdx]);
+            maxOutHiddenSize = std::max(maxOutHiddenSize, mOutHiddenSizes[loraModuleIdx]);
+        }
+        for (auto const& tile : tiles)
+        {
+            TLLM_CHECK_WITH_INFO(tile.rank <= mMaxLowRank,
+                fmtstr("Invalid low_rank (%d). low_rank must be smaller than mMaxLowRank (%d)", tile.rank,
+                    mMaxLowRank));
+        }
+        loraSgmv(tiles, input, mInHiddenSize, mMaxLowRank, maxOutHiddenSize, groupGemmParamsWorkSpace,
+            getSgmvParamsWorkSpaceSize(numTokens, numReqs, mNumLoraModules), mType,
+            mQuantizedWeightType.value_or(mType), stream);
+    }
     else
     {
         std::vector<cutlass::gemm::GemmCoord> problem_sizes;
@@ -18,6 +18,7 @@
 #include "tensorrt_llm/common/cublasMMWrapper.h"
 #include "tensorrt_llm/common/dataType.h"
 #include <cassert>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -61,6 +62,8 @@ private:
     std::vector<int> mOutHiddenSizes;
     int mMaxLowRank;
     int const mSplitKSlices = 16;
+    // Set when the device LoRA cache stores quantized adapters, only the SGMV kernels dequantize them
+    std::optional<nvinfer1::DataType> mQuantizedWeightType;
 
     std::optional<Config> mBestConfig;
 };
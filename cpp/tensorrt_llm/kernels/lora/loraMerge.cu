@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/kernels/lora/loraMerge.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm::kernels
+{
+
+namespace
+{
+int constexpr kMergeBlockSize = 256;
+
+// One block row per output row: the out weights of the row are staged in shared memory and every thread accumulates
+// the low rank product of its columns, reading the in weights coalesced.
+template <typename T>
+__global__ void loraMergeKernel(T* weight, T const* inWeight, T const* outWeight, int64_t inHiddenSize, int32_t rank,
+    float scale)
+{
+    extern __shared__ float smemOut[];
+    int const row = blockIdx.y;
+    for (int r = threadIdx.x; r < rank; r += blockDim.x)
+    {
+        smemOut[r] = scale * cuda_cast<float>(outWeight[static_cast<int64_t>(row) * rank + r]);
+    }
+    __syncthreads();
+
+    int64_t const col = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    if (col >= inHiddenSize)
+    {
+        return;
+    }
+    float acc = 0.f;
+    for (int r = 0; r < rank; ++r)
+    {
+        acc += smemOut[r] * cuda_cast<float>(inWeight[r * inHiddenSize + col]);
+    }
+    auto& value = weight[static_cast<int64_t>(row) * inHiddenSize + col];
+    value = cuda_cast<T>(cuda_cast<float>(value) + acc);
+}
+
+template <typename T>
+void loraMerge_(void* weight, void const* inWeight, void const* outWeight, int64_t inHiddenSize,
+    int32_t outHiddenSize, int32_t rank, float scale, cudaStream_t stream)
+{
+    dim3 const grid(static_cast<unsigned>(divUp(inHiddenSize, kMergeBlockSize)), outHiddenSize);
+    auto const smemSize = rank * sizeof(float);
+    loraMergeKernel<T><<<grid, kMergeBlockSize, smemSize, stream>>>(static_cast<T*>(weight),
+        static_cast<T const*>(inWeight), static_cast<T const*>(outWeight), inHiddenSize, rank, scale);
+}
+} // namespace
+
+void invokeLoraMerge(void* weight, void const* inWeight, void const* outWeight, int64_t inHiddenSize,
+    int32_t outHiddenSize, int32_t rank, float scale, nvinfer1::DataType type, cudaStream_t stream)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    if (rank == 0 || outHiddenSize == 0 || inHiddenSize == 0)
+    {
+        return;
+    }
+    TLLM_CHECK_WITH_INFO(rank * sizeof(float) <= 48 * 1024, "LoRA merge does not support rank %d", rank);
+    if (type == nvinfer1::DataType::kHALF)
+    {
+        loraMerge_<half>(weight, inWeight, outWeight, inHiddenSize, outHiddenSize, rank, scale, stream);
+    }
+    else if (type == nvinfer1::DataType::kFLOAT)
+    {
+        loraMerge_<float>(weight, inWeight, outWeight, inHiddenSize, outHiddenSize, rank, scale, stream);
+    }
+#ifdef ENABLE_BF16
+    else if (type == nvinfer1::DataType::kBF16)
+    {
+        loraMerge_<__nv_bfloat16>(weight, inWeight, outWeight, inHiddenSize, outHiddenSize, rank, scale, stream);
+    }
+#endif
+    else
+    {
+        TLLM_THROW("Unsupported data type for LoRA merge");
+    }
+    sync_check_cuda_error();
+}
+
+} // namespace tensorrt_llm::kernels
@@ -0,0 +1,37 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <NvInferRuntime.h>
+#include <cuda_runtime.h>
+
+#include <cstdint>
+
+namespace tensorrt_llm::kernels
+{
+
+//! \brief Add scale * outWeight * inWeight to the rows of a linear weight, folding a LoRA module into it.
+//! \param weight First of the outHiddenSize rows [outHiddenSize, inHiddenSize] to update, rows are contiguous.
+//! \param inWeight In weights [rank, inHiddenSize] of the module, as stored in the LoRA cache.
+//! \param outWeight Out weights [outHiddenSize, rank] of the module.
+//! \param scale 1 to merge the module, -1 to take it out again.
+//! \details The product is accumulated in fp32 and added to the weight in its own precision.
+void invokeLoraMerge(void* weight, void const* inWeight, void const* outWeight, int64_t inHiddenSize,
+    int32_t outHiddenSize, int32_t rank, float scale, nvinfer1::DataType type, cudaStream_t stream);
+
+} // namespace tensorrt_llm::kernels
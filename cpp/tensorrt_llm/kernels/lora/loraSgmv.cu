@@ -0,0 +1,331 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/kernels/lora/loraSgmv.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
+
+#include <algorithm>
+#include <type_traits>
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm::kernels
+{
+
+namespace
+{
+int constexpr kSgmvBlockSize = 256;
+
+// Vector of the bytes of kVecSize weights, the in weights are loaded as wide as the input.
+template <int kBytes>
+struct WeightVecType;
+
+template <>
+struct WeightVecType<16>
+{
+    using Type = uint4;
+};
+
+template <>
+struct WeightVecType<8>
+{
+    using Type = uint2;
+};
+
+template <>
+struct WeightVecType<4>
+{
+    using Type = uint32_t;
+};
+
+template <typename W>
+__device__ inline float weightToFloat(W value)
+{
+    return cuda_cast<float>(value);
+}
+
+template <>
+__device__ inline float weightToFloat(int8_t value)
+{
+    return static_cast<float>(value);
+}
+
+#ifdef ENABLE_FP8
+template <>
+__device__ inline float weightToFloat(__nv_fp8_e4m3 value)
+{
+    return static_cast<float>(value);
+}
+#endif
+
+// Per-row scales stored in front of quantized weights of numRows rows.
+__device__ inline float const* getWeightScales(void const* weight, int64_t numRows)
+{
+    return reinterpret_cast<float const*>(static_cast<char const*>(weight) - getLoraQuantScalesSize(numRows));
+}
+
+// Each warp reduces one row of the in weights over the hidden dimension for all tokens of the tile.
+template <typename T, typename W>
+__global__ void loraSgmvShrinkKernel(
+    LoraSgmvTile const* tiles, T const* input, int64_t inHiddenSize, int32_t maxLowRank)
+{
+    bool constexpr kQuantized = !std::is_same_v<T, W>;
+    int constexpr kVecSize = 16 / sizeof(T);
+    using WeightVec = typename WeightVecType<kVecSize * sizeof(W)>::Type;
+    auto const tile = tiles[blockIdx.x];
+    int const warpId = threadIdx.x / 32;
+    int const laneId = threadIdx.x % 32;
+    int const numWarps = blockDim.x / 32;
+
+    auto const* tileInput = input + tile.tokenStart * inHiddenSize;
+    auto* lowRank = static_cast<T*>(tile.lowRank) + static_cast<int64_t>(tile.tokenStart) * maxLowRank;
+    for (int r = warpId; r < tile.rank; r += numWarps)
+    {
+        auto const* weight = static_cast<W const*>(tile.inWeight) + r * inHiddenSize;
+        float acc[kLoraSgmvTileTokens] = {};
+        for (int64_t k = laneId * kVecSize; k < inHiddenSize; k += 32 * kVecSize)
+        {
+            alignas(16) W weightVec[kVecSize];
+            *reinterpret_cast<WeightVec*>(weightVec) = *reinterpret_cast<WeightVec const*>(weight + k);
+#pragma unroll
+            for (int t = 0; t < kLoraSgmvTileTokens; ++t)
+            {
+                if (t < tile.numTokens)
+                {
+                    alignas(16) T inputVec[kVecSize];
+                    *reinterpret_cast<uint4*>(inputVec)
+                        = *reinterpret_cast<uint4 const*>(tileInput + t * inHiddenSize + k);
+#pragma unroll
+                    for (int i = 0; i < kVecSize; ++i)
+                    {
+                        acc[t] += weightToFloat(weightVec[i]) * cuda_cast<float>(inputVec[i]);
+                    }
+                }
+            }
+        }
+#pragma unroll
+        for (int t = 0; t < kLoraSgmvTileTokens; ++t)
+        {
+#pragma unroll
+            for (int mask = 16; mask > 0; mask >>= 1)
+            {
+                acc[t] += __shfl_xor_sync(0xffffffff, acc[t], mask);
+            }
+        }
+        if (laneId == 0)
+        {
+            float const scale = kQuantized ? getWeightScales(tile.inWeight, tile.rank)[r] : 1.f;
+            for (int t = 0; t < tile.numTokens; ++t)
+            {
+                lowRank[t * maxLowRank + r] = cuda_cast<T>(acc[t] * scale);
+            }
+        }
+    }
+}
+
+// Each thread computes one output column for all tokens of the tile from the low rank activations in shared memory.
+template <typename T, typename W>
+__global__ void loraSgmvExpandKernel(LoraSgmvTile const* tiles, int32_t maxLowRank)
+{
+    bool constexpr kQuantized = !std::is_same_v<T, W>;
+    extern __shared__ float smemLowRank[]; // [kLoraSgmvTileTokens, rank]
+    auto const tile = tiles[blockIdx.x];
+
+    auto const* lowRank = static_cast<T const*>(tile.lowRank) + static_cast<int64_t>(tile.tokenStart) * maxLowRank;
+    for (int idx = threadIdx.x; idx < tile.numTokens * tile.rank; idx += blockDim.x)
+    {
+        int const t = idx / tile.rank;
+        int const r = idx % tile.rank;
+        smemLowRank[idx] = cuda_cast<float>(lowRank[t * maxLowRank + r]);
+    }
+    __syncthreads();
+
+    auto* output = static_cast<T*>(tile.output) + static_cast<int64_t>(tile.tokenStart) * tile.outHiddenSize;
+    for (int n = blockIdx.y * blockDim.x + threadIdx.x; n < tile.outHiddenSize; n += gridDim.y * blockDim.x)
+    {
+        auto const* weight = static_cast<W const*>(tile.outWeight) + static_cast<int64_t>(n) * tile.rank;
+        float acc[kLoraSgmvTileTokens] = {};
+        for (int r = 0; r < tile.rank; ++r)
+        {
+            float const w = weightToFloat(weight[r]);
+            // Rows past numTokens are not initialized, their results are dropped.
+#pragma unroll
+            for (int t = 0; t < kLoraSgmvTileTokens; ++t)
+            {
+                acc[t] += w * smemLowRank[t * tile.rank + r];
+            }
+        }
+        float const scale = kQuantized ? getWeightScales(tile.outWeight, tile.outHiddenSize)[n] : 1.f;
+        for (int t = 0; t < tile.numTokens; ++t)
+        {
+            output[t * tile.outHiddenSize + n] = cuda_cast<T>(acc[t] * scale);
+        }
+    }
+}
+
+template <typename T, typename W>
+void loraSgmv_(LoraSgmvTile const* tiles, int32_t numTiles, void const* input, int64_t inHiddenSize,
+    int32_t maxLowRank, int32_t maxOutHiddenSize, cudaStream_t stream)
+{
+    loraSgmvShrinkKernel<T, W>
+        <<<numTiles, kSgmvBlockSize, 0, stream>>>(tiles, static_cast<T const*>(input), inHiddenSize, maxLowRank);
+    sync_check_cuda_error();
+
+    dim3 const grid(numTiles, divUp(maxOutHiddenSize, kSgmvBlockSize));
+    auto const smemSize = kLoraSgmvTileTokens * maxLowRank * sizeof(float);
+    TLLM_CHECK_WITH_INFO(smemSize <= 48 * 1024, "SGMV LoRA does not support max low rank %d", maxLowRank);
+    loraSgmvExpandKernel<T, W><<<grid, kSgmvBlockSize, smemSize, stream>>>(tiles, maxLowRank);
+    sync_check_cuda_error();
+}
+
+template <typename T>
+void loraSgmvWeightType_(LoraSgmvTile const* tiles, int32_t numTiles, void const* input, int64_t inHiddenSize,
+    int32_t maxLowRank, int32_t maxOutHiddenSize, nvinfer1::DataType type, nvinfer1::DataType weightType,
+    cudaStream_t stream)
+{
+    if (weightType == type)
+    {
+        loraSgmv_<T, T>(tiles, numTiles, input, inHiddenSize, maxLowRank, maxOutHiddenSize, stream);
+    }
+    else if (weightType == nvinfer1::DataType::kINT8)
+    {
+        loraSgmv_<T, int8_t>(tiles, numTiles, input, inHiddenSize, maxLowRank, maxOutHiddenSize, stream);
+    }
+#ifdef ENABLE_FP8
+    else if (weightType == nvinfer1::DataType::kFP8)
+    {
+        loraSgmv_<T, __nv_fp8_e4m3>(tiles, numTiles, input, inHiddenSize, maxLowRank, maxOutHiddenSize, stream);
+    }
+#endif
+    else
+    {
+        TLLM_THROW("Unsupported LoRA weight data type for SGMV LoRA");
+    }
+}
+} // namespace
+
+void appendLoraSgmvTiles(std::vector<LoraSgmvTile>& tiles, int64_t numTokens, int32_t const* ranks,
+    int64_t const* weightPtrs, int64_t inHiddenSize, int32_t outHiddenSize, int64_t weightIndex, int64_t typeSize,
+    void* lowRank, void* output)
+{
+    int64_t rowId = 0;
+    while (rowId < numTokens)
+    {
+        auto const rank = ranks[rowId];
+        int64_t count = 1;
+        while (rowId + count < numTokens && ranks[rowId + count] == rank
+            && weightPtrs[rowId * 2] == weightPtrs[(rowId + count) * 2]
+            && weightPtrs[rowId * 2 + 1] == weightPtrs[(rowId + count) * 2 + 1])
+        {
+            ++count;
+        }
+        if (rank > 0)
+        {
+            auto const* inWeight = reinterpret_cast<char const*>(weightPtrs[rowId * 2])
+                + inHiddenSize * rank * typeSize * weightIndex;
+            auto const* outWeight = reinterpret_cast<char const*>(weightPtrs[rowId * 2 + 1])
+                + static_cast<int64_t>(outHiddenSize) * rank * typeSize * weightIndex;
+            for (int64_t start = rowId; start < rowId + count; start += kLoraSgmvTileTokens)
+            {
+                auto const tileTokens = std::min<int64_t>(kLoraSgmvTileTokens, rowId + count - start);
+                tiles.push_back(LoraSgmvTile{static_cast<int32_t>(start), static_cast<int32_t>(tileTokens), rank,
+                    outHiddenSize, inWeight, outWeight, lowRank, output});
+            }
+        }
+        rowId += count;
+    }
+}
+
+std::optional<nvinfer1::DataType> getLoraQuantizedCacheType()
+{
+    static std::optional<nvinfer1::DataType> const dataType = []() -> std::optional<nvinfer1::DataType>
+    {
+        auto const env = getEnvLoraDeviceCacheDataType();
+        if (!env)
+        {
+            return std::nullopt;
+        }
+        if (*env == "int8")
+        {
+            return nvinfer1::DataType::kINT8;
+        }
+#ifdef ENABLE_FP8
+        if (*env == "fp8")
+        {
+            return nvinfer1::DataType::kFP8;
+        }
+#endif
+        TLLM_THROW("Unsupported TRTLLM_LORA_DEVICE_CACHE_DTYPE %s, expected int8 or fp8", env->c_str());
+    }();
+    return dataType;
+}
+
+int64_t getLoraSgmvMaxTiles(int64_t numTokens, int64_t numReqs)
+{
+    return divUp(numTokens, kLoraSgmvTileTokens) + numReqs;
+}
+
+int64_t getLoraSgmvTilesWorkSpaceSize(int64_t maxNumTiles)
+{
+    return divUp(maxNumTiles * sizeof(LoraSgmvTile), 16) * 16;
+}
+
+void loraSgmv(std::vector<LoraSgmvTile> const& tiles, void const* input, int64_t inHiddenSize, int32_t maxLowRank,
+    int32_t maxOutHiddenSize, void* tilesWorkSpace, int64_t tilesWorkSpaceSize, nvinfer1::DataType type,
+    nvinfer1::DataType weightType, cudaStream_t stream)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    if (tiles.empty())
+    {
+        return;
+    }
+    TLLM_CHECK_WITH_INFO(inHiddenSize % 8 == 0, "SGMV LoRA needs a hidden size multiple of 8, got %ld", inHiddenSize);
+    auto const tilesSize = static_cast<int64_t>(tiles.size() * sizeof(LoraSgmvTile));
+    TLLM_CHECK_WITH_INFO(tilesSize <= tilesWorkSpaceSize,
+        "SGMV LoRA tiles (%ld bytes) exceed the workspace (%ld bytes)", tilesSize, tilesWorkSpaceSize);
+    check_cuda_error(cudaMemcpyAsync(tilesWorkSpace, tiles.data(), tilesSize, cudaMemcpyHostToDevice, stream));
+
+    auto const* deviceTiles = static_cast<LoraSgmvTile const*>(tilesWorkSpace);
+    auto const numTiles = static_cast<int32_t>(tiles.size());
+    if (type == nvinfer1::DataType::kHALF)
+    {
+        loraSgmvWeightType_<half>(
+            deviceTiles, numTiles, input, inHiddenSize, maxLowRank, maxOutHiddenSize, type, weightType, stream);
+    }
+    else if (type == nvinfer1::DataType::kFLOAT)
+    {
+        loraSgmvWeightType_<float>(
+            deviceTiles, numTiles, input, inHiddenSize, maxLowRank, maxOutHiddenSize, type, weightType, stream);
+    }
+#ifdef ENABLE_BF16
+    else if (type == nvinfer1::DataType::kBF16)
+    {
+        loraSgmvWeightType_<__nv_bfloat16>(
+            deviceTiles, numTiles, input, inHiddenSize, maxLowRank, maxOutHiddenSize, type, weightType, stream);
+    }
+#endif
+    else
+    {
+        TLLM_THROW("Unsupported data type for SGMV LoRA");
+    }
+}
+
+} // namespace tensorrt_llm::kernels
@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <NvInferRuntime.h>
+#include <cuda_runtime.h>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::kernels
+{
+
+//! Number of consecutive tokens of a segment processed by one thread block, the LoRA weights are read once per tile.
+int constexpr kLoraSgmvTileTokens = 8;
+
+//! \brief Bytes of the per-row float scales stored right before the quantized in or out weights of a LoRA module in
+//! a quantized LoRA cache, padded so that the weights stay 16 byte aligned. Quantized weights are stored with one
+//! scale per row: per rank row of the in weights and per output row of the out weights.
+__host__ __device__ inline int64_t getLoraQuantScalesSize(int64_t numRows)
+{
+    return (numRows * static_cast<int64_t>(sizeof(float)) + 15) / 16 * 16;
+}
+
+//! \brief The data type of quantized device LoRA cache pages selected by TRTLLM_LORA_DEVICE_CACHE_DTYPE, kINT8 or kFP8,
+//! std::nullopt if the device cache stores the adapters in the model data type.
+std::optional<nvinfer1::DataType> getLoraQuantizedCacheType();
+
+//! \brief A tile of up to kLoraSgmvTileTokens consecutive tokens of one LoRA module that share the same adapter.
+struct LoraSgmvTile
+{
+    //! Index of the first token of the tile
+    int32_t tokenStart;
+    int32_t numTokens;
+    int32_t rank;
+    //! Output hidden size of the module
+    int32_t outHiddenSize;
+    //! In weights [rank, inHiddenSize], read in place from the LoRA cache pages
+    void const* inWeight;
+    //! Out weights [outHiddenSize, rank]
+    void const* outWeight;
+    //! Low rank activations [numTokens, maxLowRank] of the module
+    void* lowRank;
+    //! Output [numTokens, outHiddenSize] of the module
+    void* output;
+};
+
+//! \brief Split the segments of tokens that share an adapter into tiles, appending them to tiles.
+//! \param ranks Ranks of the tokens of one module, 0 for tokens without LoRA.
+//! \param weightPtrs Pairs of (in, out) weight pointers of the tokens of one module.
+void appendLoraSgmvTiles(std::vector<LoraSgmvTile>& tiles, int64_t numTokens, int32_t const* ranks,
+    int64_t const* weightPtrs, int64_t inHiddenSize, int32_t outHiddenSize, int64_t weightIndex, int64_t typeSize,
+    void* lowRank, void* output);
+
+//! \brief Upper bound of the number of tiles of one module, segments never span requests.
+int64_t getLoraSgmvMaxTiles(int64_t numTokens, int64_t numReqs);
+
+int64_t getLoraSgmvTilesWorkSpaceSize(int64_t maxNumTiles);
+
+//! \brief Segmented gather matrix-vector LoRA: shrink every token to its adapter's rank and expand it back, for any mix
+//! of adapters and ranks in a single pair of launches.
+//! \details The outputs of tokens without a tile are left untouched. inHiddenSize must be a multiple of 8.
+//! \param weightType Data type of the LoRA weights, type or a quantized type of getLoraQuantizedCacheType whose
+//! weights are dequantized with the scales in front of them, see getLoraQuantScalesSize.
+void loraSgmv(std::vector<LoraSgmvTile> const& tiles, void const* input, int64_t inHiddenSize, int32_t maxLowRank,
+    int32_t maxOutHiddenSize, void* tilesWorkSpace, int64_t tilesWorkSpaceSize, nvinfer1::DataType type,
+    nvinfer1::DataType weightType, cudaStream_t stream);
+
+} // namespace tensorrt_llm::kernels
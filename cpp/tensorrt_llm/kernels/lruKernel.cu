@@ -349,9 +349,9 @@ __launch_bounds__(128, 2) __global__ void rg_lru_update_kernel(lruParams params)
         return;
     int const sample = blockIdx.y; // batch id
     int const slot_idx = params.slot_mapping_ptr == nullptr ? sample : params.slot_mapping_ptr[sample];
-    int const idx = sample * num_channels + channel;
+    int const step_tokens = max(params.step_tokens, 1);
+    float* intermediate_state = reinterpret_cast<float*>(params.intermediate_state_ptr);
     int const gate_num_channels = enable_fuse_gate ? num_channels * 2 : num_channels;
-    int const gate_base_idx = sample * gate_num_channels;
     int const gx_dim_idx = enable_fuse_gate ? channel / block_size * block_size * 2 + channel % block_size : channel;
     int const ga_dim_idx = enable_fuse_gate ? gx_dim_idx + block_size : channel;
 
@@ -361,55 +361,69 @@ __launch_bounds__(128, 2) __global__ void rg_lru_update_kernel(lruParams params)
     float param_a = cuda_cast<float>(A[channel]);
     float c = param_a <= 20.f ? -8.0f * __logf(1.0f + __expf(param_a)) : -8.0f * param_a;
 
-    // Read y
-    float y_reg;
-    if (y_bias)
+    for (int token = sample * step_tokens; token < (sample + 1) * step_tokens; ++token)
     {
-        y_reg = cuda_cast<float>(y[idx] + y_bias[channel]);
-        // GELU
-        float k0 = float(0.7978845608028654);
-        float k1 = float(0.044715);
-        float y_tanh = k0 * y_reg * (1.0 + k1 * y_reg * y_reg);
-        float exp_val = -1.f * cuda_abs(y_tanh * 2);
-        y_reg = 0.5f * y_reg
-            * (1.f + copysignf_pos(__fdividef((1.f - __expf(exp_val)), (1.f + __expf(exp_val))), y_tanh));
-    }
-    else if (y)
-    {
-        y_reg = cuda_cast<float>(y[idx]);
-    }
-    else
-    {
-        y_reg = 1.f;
-    }
-    // Read gate_x
-    float gate_x_reg, gate_a_reg;
-    if (enable_gate_bias)
-    {
-        gate_x_reg = cuda_cast<float>(-gate_x[gate_base_idx + gx_dim_idx] - gate_x_bias[gx_dim_idx]);
-        gate_a_reg = cuda_cast<float>(-gate_a[gate_base_idx + ga_dim_idx] - gate_a_bias[ga_dim_idx]);
+        int const idx = token * num_channels + channel;
+        int const gate_base_idx = token * gate_num_channels;
+
+        // Read y
+        float y_reg;
+        if (y_bias)
+        {
+            y_reg = cuda_cast<float>(y[idx] + y_bias[channel]);
+            // GELU
+            float k0 = float(0.7978845608028654);
+            float k1 = float(0.044715);
+            float y_tanh = k0 * y_reg * (1.0 + k1 * y_reg * y_reg);
+            float exp_val = -1.f * cuda_abs(y_tanh * 2);
+            y_reg = 0.5f * y_reg
+                * (1.f + copysignf_pos(__fdividef((1.f - __expf(exp_val)), (1.f + __expf(exp_val))), y_tanh));
+        }
+        else if (y)
+        {
+            y_reg = cuda_cast<float>(y[idx]);
+        }
+        else
+        {
+            y_reg = 1.f;
+        }
+        // Read gate_x
+        float gate_x_reg, gate_a_reg;
+        if (enable_gate_bias)
+        {
+            gate_x_reg = cuda_cast<float>(-gate_x[gate_base_idx + gx_dim_idx] - gate_x_bias[gx_dim_idx]);
+            gate_a_reg = cuda_cast<float>(-gate_a[gate_base_idx + ga_dim_idx] - gate_a_bias[ga_dim_idx]);
+        }
+        else
+        {
+            gate_x_reg = cuda_cast<float>(-gate_x[gate_base_idx + gx_dim_idx]);
+            gate_a_reg = cuda_cast<float>(-gate_a[gate_base_idx + ga_dim_idx]);
+        }
+        // Get gated inputs
+        float sigmoid_x = __fdividef(1.0f, (1.0f + __expf(gate_x_reg)));
+        float sigmoid_a = __fdividef(1.0f, (1.0f + __expf(gate_a_reg)));
+        float log_a = sigmoid_a * c;
+        float a = __expf(log_a);
+        float a_square = __expf(2.0 * log_a);
+        float outf = y_reg;
+        float normalized_x = cuda_cast<float>(x[idx]) * sigmoid_x * sqrtf(1 - a_square);
+
+        // RNN update
+        state_reg = a * state_reg + normalized_x;
+        outf *= state_reg;
+
+        // Write output and state
+        output[idx] = cuda_cast<T>(outf);
+        if (intermediate_state)
+        {
+            intermediate_state[idx] = state_reg;
+        }
     }
-    else
+
+    if (!intermediate_state)
     {
-        gate_x_reg = cuda_cast<float>(-gate_x[gate_base_idx + gx_dim_idx]);
-        gate_a_reg = cuda_cast<float>(-gate_a[gate_base_idx + ga_dim_idx]);
+        state[slot_idx * num_channels + channel] = state_reg;
     }
-    // Get gated inputs
-    float sigmoid_x = __fdividef(1.0f, (1.0f + __expf(gate_x_reg)));
-    float sigmoid_a = __fdividef(1.0f, (1.0f + __expf(gate_a_reg)));
-    float log_a = sigmoid_a * c;
-    float a = __expf(log_a);
-    float a_square = __expf(2.0 * log_a);
-    float outf = y_reg;
-    float normalized_x = cuda_cast<float>(x[idx]) * sigmoid_x * sqrtf(1 - a_square);
-
-    // RNN update
-    state_reg = a * state_reg + normalized_x;
-    outf *= state_reg;
-
-    // Write output and state
-    output[sample * num_channels + channel] = cuda_cast<T>(outf);
-    state[slot_idx * num_channels + channel] = state_reg;
 }
 
 template <typename T>
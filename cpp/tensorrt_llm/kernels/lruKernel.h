@@ -45,6 +45,12 @@ struct lruParams
     void* __restrict__ out_ptr;
     int const* __restrict__ last_token_ids_ptr;
     int const* __restrict__ slot_mapping_ptr;
+
+    // Generation steps may process several tokens per sequence, e.g. to verify draft tokens. If set, the state after
+    // each token is written to intermediate_state_ptr [batch, step_tokens, width] and the state itself is left for
+    // invokeCommitRecurrentStates to update once the accepted tokens are known.
+    int step_tokens; // 0 or 1 for a single token
+    void* __restrict__ intermediate_state_ptr;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
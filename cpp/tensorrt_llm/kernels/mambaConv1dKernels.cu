@@ -1092,8 +1092,10 @@ __launch_bounds__(64, 8) __global__
     input_t* state_out = reinterpret_cast<input_t*>(params.state_out_ptr);
     input_t* weight = reinterpret_cast<input_t*>(params.weight_ptr);
     input_t* bias = reinterpret_cast<input_t*>(params.bias_ptr);
+    input_t* intermediate_state = reinterpret_cast<input_t*>(params.intermediate_state_ptr);
 
     int num_channels = params.dim;
+    int const step_tokens = max(params.step_tokens, 1);
     int const micro_batch = blockIdx.y;
     int const channel = (blockIdx.x * blockDim.x + threadIdx.x) * CHANNELS_PER_THREAD;
     int const num_channels_in = num_channels + params.pre_stride + params.post_stride;
@@ -1109,6 +1111,7 @@ __launch_bounds__(64, 8) __global__
     output += channel;
     state_in += channel;
     state_out += channel;
+    intermediate_state += intermediate_state ? channel : 0;
 
     float reg_weight[DCONV][CHANNELS_PER_THREAD];
     float reg_bias[CHANNELS_PER_THREAD];
@@ -1128,8 +1131,6 @@ __launch_bounds__(64, 8) __global__
          ++sample)
     {
         int const slot_idx = params.state_slot_mapping_ptr == nullptr ? sample : params.state_slot_mapping_ptr[sample];
-        input_t* token_input = input + sample * num_channels_in;
-        input_t* token_output = output + sample * params.dim;
         input_t* token_state_in = state_in + slot_idx * (params.dconv - 1) * params.dim;
         input_t* token_state_out = state_out + slot_idx * (params.dconv - 1) * params.dim;
 #pragma unroll
@@ -1137,45 +1138,75 @@ __launch_bounds__(64, 8) __global__
         {
             packed_load_to_float<input_t, CHANNELS_PER_THREAD>(token_state_in + i * params.dim, &reg_input[i][0]);
         }
-        packed_load_to_float<input_t, CHANNELS_PER_THREAD>(token_input, &reg_input[DCONV - 1][0]);
 
-#pragma unroll
-        for (int c = 0; c < CHANNELS_PER_THREAD; ++c)
-        {
-            reg_result[c] = 0.0f;
-        }
-        // conv
-#pragma unroll
-        for (int row = 0; row < DCONV; ++row)
+        // Tokens of a sequence are processed in order, sliding the window by one for each of them.
+        for (int token = sample * step_tokens; token < (sample + 1) * step_tokens; ++token)
         {
+            input_t* token_input = input + token * num_channels_in;
+            input_t* token_output = output + token * params.dim;
+            packed_load_to_float<input_t, CHANNELS_PER_THREAD>(token_input, &reg_input[DCONV - 1][0]);
+
 #pragma unroll
             for (int c = 0; c < CHANNELS_PER_THREAD; ++c)
             {
-                reg_result[c] += reg_weight[row][c] * reg_input[row][c];
+                reg_result[c] = 0.0f;
             }
-        }
-        // add bias
+            // conv
 #pragma unroll
-        for (int c = 0; c < CHANNELS_PER_THREAD; ++c)
-        {
-            reg_result[c] += reg_bias[c];
-        }
-        // Silu
-        if (params.apply_silu)
-        {
+            for (int row = 0; row < DCONV; ++row)
+            {
+#pragma unroll
+                for (int c = 0; c < CHANNELS_PER_THREAD; ++c)
+                {
+                    reg_result[c] += reg_weight[row][c] * reg_input[row][c];
+                }
+            }
+            // add bias
 #pragma unroll
             for (int c = 0; c < CHANNELS_PER_THREAD; ++c)
             {
-                float sigmoid = reg_result[c] < -20.0 ? 0.0f : 1.0f / (1.0f + __expf(-reg_result[c]));
-                reg_result[c] *= sigmoid;
+                reg_result[c] += reg_bias[c];
             }
-        }
-        packed_store_float_to<input_t, CHANNELS_PER_THREAD>(&reg_result[0], token_output);
+            // Silu
+            if (params.apply_silu)
+            {
+#pragma unroll
+                for (int c = 0; c < CHANNELS_PER_THREAD; ++c)
+                {
+                    float sigmoid = reg_result[c] < -20.0 ? 0.0f : 1.0f / (1.0f + __expf(-reg_result[c]));
+                    reg_result[c] *= sigmoid;
+                }
+            }
+            packed_store_float_to<input_t, CHANNELS_PER_THREAD>(&reg_result[0], token_output);
 
 #pragma unroll
-        for (int i = 0; i < DCONV - 1; ++i)
+            for (int i = 0; i < DCONV - 1; ++i)
+            {
+#pragma unroll
+                for (int c = 0; c < CHANNELS_PER_THREAD; ++c)
+                {
+                    reg_input[i][c] = reg_input[i + 1][c];
+                }
+            }
+            if (intermediate_state)
+            {
+                input_t* token_intermediate_state = intermediate_state + token * (params.dconv - 1) * params.dim;
+#pragma unroll
+                for (int i = 0; i < DCONV - 1; ++i)
+                {
+                    packed_store_float_to<input_t, CHANNELS_PER_THREAD>(
+                        &reg_input[i][0], token_intermediate_state + i * params.dim);
+                }
+            }
+        }
+
+        if (!intermediate_state)
         {
-            packed_store_float_to<input_t, CHANNELS_PER_THREAD>(&reg_input[i + 1][0], token_state_out + i * params.dim);
+#pragma unroll
+            for (int i = 0; i < DCONV - 1; ++i)
+            {
+                packed_store_float_to<input_t, CHANNELS_PER_THREAD>(&reg_input[i][0], token_state_out + i * params.dim);
+            }
         }
     }
 }
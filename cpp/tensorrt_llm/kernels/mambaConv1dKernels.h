@@ -37,6 +37,12 @@ struct MambaConv1dParamsBase
     void* __restrict__ out_ptr;
     int const* __restrict__ last_token_ids_ptr;
     int const* __restrict__ state_slot_mapping_ptr;
+
+    // Generation steps may process several tokens per sequence, e.g. to verify draft tokens. If set, the conv state
+    // after each token is written to intermediate_state_ptr [batch, step_tokens, dconv - 1, dim] and state_out_ptr is
+    // left for invokeCommitRecurrentStates to update once the accepted tokens are known.
+    int step_tokens; // 0 or 1 for a single token
+    void* __restrict__ intermediate_state_ptr;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -133,7 +133,7 @@ __launch_bounds__(TPB) __global__
 template <int TPB>
 __launch_bounds__(TPB) __global__ void moeTopK(float const* inputs_after_softmax, bool const* finished, float* output,
     int* indices, int* source_rows, int const num_experts, int const k, int const startk, int const endk,
-    int const start_expert, int const end_expert, MOEExpertScaleNormalizationMode norm_mode)
+    int const start_expert, int const end_expert, MOEExpertScaleNormalizationMode norm_mode, int* expert_counts)
 {
 
     using cub_kvp = cub::KeyValuePair<int, float>;
@@ -187,6 +187,10 @@ __launch_bounds__(TPB) __global__ void moeTopK(float const* inputs_after_softmax
             indices[idx] = should_process_row ? (expert - start_expert) : (num_experts + expert);
             assert(indices[idx] >= 0);
             source_rows[idx] = k_idx * num_rows + block_row;
+            if (expert_counts && row_is_active)
+            {
+                atomicAdd(expert_counts + expert, 1);
+            }
 
             if (norm_mode == MOEExpertScaleNormalizationMode::RENORMALIZE)
             {
@@ -225,7 +229,8 @@ __launch_bounds__(TPB) __global__ void moeTopK(float const* inputs_after_softmax
 template <int VPT, int NUM_EXPERTS, int WARPS_PER_CTA, int BYTES_PER_LDG>
 __launch_bounds__(WARPS_PER_CTA* WARP_SIZE) __global__ void topkGatingSoftmax(float const* input, bool const* finished,
     float* output, int64_t const num_rows, int* indices, int* source_rows, int const k, int const startk,
-    int const endk, int const start_expert, int const end_expert, MOEExpertScaleNormalizationMode norm_mode)
+    int const endk, int const start_expert, int const end_expert, MOEExpertScaleNormalizationMode norm_mode,
+    int* expert_counts)
 {
     // We begin by enforcing compile time assertions and setting up compile time constants.
     static_assert(VPT == (VPT & -VPT), "VPT must be power of 2");
@@ -403,6 +408,10 @@ __launch_bounds__(WARPS_PER_CTA* WARP_SIZE) __global__ void topkGatingSoftmax(fl
             output[idx] = max_val;
             indices[idx] = should_process_row ? (expert - start_expert) : (NUM_EXPERTS + expert);
             source_rows[idx] = k_idx * num_rows + thread_row;
+            if (expert_counts && row_is_active)
+            {
+                atomicAdd(expert_counts + expert, 1);
+            }
 
             // Accumulate renorm scalar
             if (norm_mode == MOEExpertScaleNormalizationMode::RENORMALIZE)
@@ -457,7 +466,7 @@ struct TopkConstants
 template <int EXPERTS, int WARPS_PER_TB>
 void topkGatingSoftmaxLauncherHelper(float const* input, bool const* finished, float* output, int* indices,
     int* source_row, int64_t const num_rows, int const k, int const startk, int const endk, int const start_expert,
-    int const end_expert, MOEExpertScaleNormalizationMode norm_mode, cudaStream_t stream)
+    int const end_expert, MOEExpertScaleNormalizationMode norm_mode, int* expert_counts, cudaStream_t stream)
 {
     static constexpr std::size_t MAX_BYTES_PER_LDG = 16;
 
@@ -470,12 +479,14 @@ void topkGatingSoftmaxLauncherHelper(float const* input, bool const* finished, f
 
     dim3 block_dim(WARP_SIZE, WARPS_PER_TB);
     topkGatingSoftmax<VPT, EXPERTS, WARPS_PER_TB, BYTES_PER_LDG><<<num_blocks, block_dim, 0, stream>>>(
-        input, finished, output, num_rows, indices, source_row, k, startk, endk, start_expert, end_expert, norm_mode);
+        input, finished, output, num_rows, indices, source_row, k, startk, endk, start_expert, end_expert, norm_mode,
+        expert_counts);
 }
 
 void topkGatingSoftmaxKernelLauncher(float const* input, float* output, float* softmax_temp_output, int* indices,
     int* source_row, int64_t const num_rows, int const num_experts, int const k, int const startk, int const endk,
-    int const start_expert, int const end_expert, MOEExpertScaleNormalizationMode norm_mode, cudaStream_t stream)
+    int const start_expert, int const end_expert, MOEExpertScaleNormalizationMode norm_mode, int* expert_counts,
+    cudaStream_t stream)
 {
     static constexpr int WARPS_PER_TB = 4;
 
@@ -484,55 +495,55 @@ void topkGatingSoftmaxKernelLauncher(float const* input, float* output, float* s
     case 1:
     {
         topkGatingSoftmaxLauncherHelper<1, WARPS_PER_TB>(input, nullptr, output, indices, source_row, num_rows, k,
-            startk, endk, start_expert, end_expert, norm_mode, stream);
+            startk, endk, start_expert, end_expert, norm_mode, expert_counts, stream);
         break;
     }
     case 2:
     {
         topkGatingSoftmaxLauncherHelper<2, WARPS_PER_TB>(input, nullptr, output, indices, source_row, num_rows, k,
-            startk, endk, start_expert, end_expert, norm_mode, stream);
+            startk, endk, start_expert, end_expert, norm_mode, expert_counts, stream);
         break;
     }
     case 4:
     {
         topkGatingSoftmaxLauncherHelper<4, WARPS_PER_TB>(input, nullptr, output, indices, source_row, num_rows, k,
-            startk, endk, start_expert, end_expert, norm_mode, stream);
+            startk, endk, start_expert, end_expert, norm_mode, expert_counts, stream);
         break;
     }
     case 8:
     {
         topkGatingSoftmaxLauncherHelper<8, WARPS_PER_TB>(input, nullptr, output, indices, source_row, num_rows, k,
-            startk, endk, start_expert, end_expert, norm_mode, stream);
+            startk, endk, start_expert, end_expert, norm_mode, expert_counts, stream);
         break;
     }
     case 16:
     {
         topkGatingSoftmaxLauncherHelper<16, WARPS_PER_TB>(input, nullptr, output, indices, source_row, num_rows, k,
-            startk, endk, start_expert, end_expert, norm_mode, stream);
+            startk, endk, start_expert, end_expert, norm_mode, expert_counts, stream);
         break;
     }
     case 32:
     {
         topkGatingSoftmaxLauncherHelper<32, WARPS_PER_TB>(input, nullptr, output, indices, source_row, num_rows, k,
-            startk, endk, start_expert, end_expert, norm_mode, stream);
+            startk, endk, start_expert, end_expert, norm_mode, expert_counts, stream);
         break;
     }
     case 64:
     {
         topkGatingSoftmaxLauncherHelper<64, WARPS_PER_TB>(input, nullptr, output, indices, source_row, num_rows, k,
-            startk, endk, start_expert, end_expert, norm_mode, stream);
+            startk, endk, start_expert, end_expert, norm_mode, expert_counts, stream);
         break;
     }
     case 128:
     {
         topkGatingSoftmaxLauncherHelper<128, WARPS_PER_TB>(input, nullptr, output, indices, source_row, num_rows, k,
-            startk, endk, start_expert, end_expert, norm_mode, stream);
+            startk, endk, start_expert, end_expert, norm_mode, expert_counts, stream);
         break;
     }
     case 256:
     {
         topkGatingSoftmaxLauncherHelper<256, WARPS_PER_TB>(input, nullptr, output, indices, source_row, num_rows, k,
-            startk, endk, start_expert, end_expert, norm_mode, stream);
+            startk, endk, start_expert, end_expert, norm_mode, expert_counts, stream);
         break;
     }
     default:
@@ -541,7 +552,7 @@ void topkGatingSoftmaxKernelLauncher(float const* input, float* output, float* s
         TLLM_CHECK(softmax_temp_output != nullptr);
         moeSoftmax<TPB><<<num_rows, TPB, 0, stream>>>(input, nullptr, softmax_temp_output, num_experts);
         moeTopK<TPB><<<num_rows, TPB, 0, stream>>>(softmax_temp_output, nullptr, output, indices, source_row,
-            num_experts, k, startk, endk, start_expert, end_expert, norm_mode);
+            num_experts, k, startk, endk, start_expert, end_expert, norm_mode, expert_counts);
     }
     }
 }
@@ -583,7 +594,7 @@ __global__ void sparseMixerMask(float const* input, float* output, int const* in
 
 void sparseMixerTopkSoftmax(float const* input, float* output, float* mixer_temp_output, float* softmax_temp_output,
     int* indices, int* source_row, int64_t const num_rows, int const num_experts, int const k, int const start_expert,
-    int const end_expert, float epsilon, cudaStream_t stream)
+    int const end_expert, float epsilon, int* expert_counts, cudaStream_t stream)
 {
     // TODO we need to update the sparseMixerMask() function to mask all previous experts instead of just the most
     //  recent one.
@@ -599,25 +610,74 @@ void sparseMixerTopkSoftmax(float const* input, float* output, float* mixer_temp
             input, mixer_temp_output, indices, k_idx, k, num_rows, num_experts, start_expert, epsilon);
 
         topkGatingSoftmaxKernelLauncher(mixer_temp_output, output, softmax_temp_output, indices, source_row, num_rows,
-            num_experts, k, k_idx, k_idx + 1, start_expert, end_expert, MOEExpertScaleNormalizationMode::NONE, stream);
+            num_experts, k, k_idx, k_idx + 1, start_expert, end_expert, MOEExpertScaleNormalizationMode::NONE,
+            expert_counts, stream);
     }
 }
 
 void selectExpertsForTokens(float const* input, float* output, float* mixer_temp_output, float* softmax_temp_output,
     int* indices, int* source_row, int64_t const num_rows, int const num_experts, int const k, int const start_expert,
-    int const end_expert, float mixer_epsilon, MOEExpertScaleNormalizationMode norm_mode, cudaStream_t stream)
+    int const end_expert, float mixer_epsilon, MOEExpertScaleNormalizationMode norm_mode, int* expert_counts,
+    cudaStream_t stream)
 {
     if (norm_mode == MOEExpertScaleNormalizationMode::SPARSE_MIXER)
     {
         TLLM_CHECK_WITH_INFO(mixer_temp_output, "Sparse mixer output is null when running sparse mixer");
         sparseMixerTopkSoftmax(input, output, mixer_temp_output, softmax_temp_output, indices, source_row, num_rows,
-            num_experts, k, start_expert, end_expert, mixer_epsilon, stream);
+            num_experts, k, start_expert, end_expert, mixer_epsilon, expert_counts, stream);
     }
     else
     {
         topkGatingSoftmaxKernelLauncher(input, output, softmax_temp_output, indices, source_row, num_rows, num_experts,
-            k, 0, k, start_expert, end_expert, norm_mode, stream);
+            k, 0, k, start_expert, end_expert, norm_mode, expert_counts, stream);
+    }
+}
+
+// ============================== Redundant Experts =================================
+__global__ void mapExpertsToReplicasKernel(int* expert_for_source_row, int64_t const num_rows, int const k,
+    int const* replica_offsets, int const* replica_slots, int const num_physical_experts, int const start_expert,
+    int const end_expert)
+{
+    int64_t const idx = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+    if (idx >= num_rows * k)
+    {
+        return;
+    }
+
+    int const logical_expert = expert_for_source_row[idx];
+    int const first_replica = replica_offsets[logical_expert];
+    int const num_replicas = replica_offsets[logical_expert + 1] - first_replica;
+    // Consecutive tokens of an expert go to its replicas in turn
+    int64_t const token = idx / k;
+    int const expert = replica_slots[first_replica + token % num_replicas];
+
+    bool const node_uses_expert = expert >= start_expert && expert < end_expert;
+    expert_for_source_row[idx] = node_uses_expert ? (expert - start_expert) : (num_physical_experts + expert);
+}
+
+// Routes the tokens like selectExpertsForTokens. With redundant experts the router picks among the logical experts and
+// every pick is then moved to one of the physical replicas of the expert, num_experts and the expert range of the node
+// are physical.
+void routeTokensToExperts(float const* input, float* output, float* mixer_temp_output, float* softmax_temp_output,
+    int* indices, int* source_row, int64_t const num_rows, int const num_experts, int const k, int const start_expert,
+    int const end_expert, float mixer_epsilon, MOEExpertScaleNormalizationMode norm_mode,
+    MoeExpertReplicas const& replicas, int* expert_counts, cudaStream_t stream)
+{
+    if (!replicas.enabled())
+    {
+        selectExpertsForTokens(input, output, mixer_temp_output, softmax_temp_output, indices, source_row, num_rows,
+            num_experts, k, start_expert, end_expert, mixer_epsilon, norm_mode, expert_counts, stream);
+        return;
     }
+
+    int const num_logical_experts = replicas.num_logical_experts;
+    selectExpertsForTokens(input, output, mixer_temp_output, softmax_temp_output, indices, source_row, num_rows,
+        num_logical_experts, k, 0, num_logical_experts, mixer_epsilon, norm_mode, expert_counts, stream);
+
+    int const threads = 256;
+    int const blocks = ceilDiv(num_rows * k, threads);
+    mapExpertsToReplicasKernel<<<blocks, threads, 0, stream>>>(indices, num_rows, k, replicas.replica_offsets,
+        replicas.replica_slots, num_experts, start_expert, end_expert);
 }
 
 // ========================== CUB Sorting things ====================================
@@ -1073,6 +1133,96 @@ void finalizeMoeRoutingKernelLauncher(GemmOutputType const* expanded_permuted_ro
         expanded_source_row_to_expanded_dest_row, expert_for_source_row, cols, k, num_valid_ptr);
 }
 
+// ============================== All-to-all =================================
+__global__ void computeAllToAllSendCountsKernel(
+    int64_t const* expert_first_token_offset, int64_t* send_counts, int64_t const num_experts)
+{
+    int const expert = blockIdx.x * blockDim.x + threadIdx.x;
+    if (expert >= num_experts)
+    {
+        return;
+    }
+    send_counts[expert] = expert_first_token_offset[expert + 1] - expert_first_token_offset[expert];
+}
+
+void computeAllToAllSendCounts(
+    int64_t const* expert_first_token_offset, int64_t* send_counts, int const num_experts, cudaStream_t stream)
+{
+    int const threads = std::min(1024, num_experts);
+    int const blocks = (num_experts + threads - 1) / threads;
+    computeAllToAllSendCountsKernel<<<blocks, threads, 0, stream>>>(
+        expert_first_token_offset, send_counts, num_experts);
+}
+
+// The received rows are grouped by source rank, then by local expert. The GEMMs need them grouped by local expert, so
+// every (source rank, local expert) block gets a start in both orders. Sizes are a few hundred blocks at most.
+__global__ void computeAllToAllLayoutKernel(int64_t const* recv_counts, int64_t* expert_first_token_offset,
+    int64_t* source_major_starts, int64_t* expert_major_starts, int const ep_size, int const num_experts_per_node)
+{
+    int64_t source_major = 0;
+    for (int block = 0; block < ep_size * num_experts_per_node; ++block)
+    {
+        source_major_starts[block] = source_major;
+        source_major += recv_counts[block];
+    }
+    int64_t expert_major = 0;
+    for (int expert = 0; expert < num_experts_per_node; ++expert)
+    {
+        expert_first_token_offset[expert] = expert_major;
+        for (int rank = 0; rank < ep_size; ++rank)
+        {
+            int const block = rank * num_experts_per_node + expert;
+            expert_major_starts[block] = expert_major;
+            expert_major += recv_counts[block];
+        }
+    }
+    expert_first_token_offset[num_experts_per_node] = expert_major;
+}
+
+void computeAllToAllLayout(int64_t const* recv_counts, int64_t* expert_first_token_offset,
+    int64_t* source_major_starts, int64_t* expert_major_starts, int const ep_size, int const num_experts_per_node,
+    cudaStream_t stream)
+{
+    computeAllToAllLayoutKernel<<<1, 1, 0, stream>>>(recv_counts, expert_first_token_offset, source_major_starts,
+        expert_major_starts, ep_size, num_experts_per_node);
+}
+
+constexpr static int REGROUP_THREADS_PER_BLOCK = 256;
+constexpr static int REGROUP_ROW_SLICES = 32;
+
+// Copies every (source rank, local expert) block of rows between the source major and the expert major orders
+template <bool TO_EXPERT_MAJOR>
+__global__ void regroupAllToAllRowsKernel(int4 const* input, int4* output, int64_t const* block_counts,
+    int64_t const* source_major_starts, int64_t const* expert_major_starts, int64_t const row_vecs)
+{
+    int64_t const block = blockIdx.x;
+    int64_t const num_rows = block_counts[block];
+    int64_t const input_start = TO_EXPERT_MAJOR ? source_major_starts[block] : expert_major_starts[block];
+    int64_t const output_start = TO_EXPERT_MAJOR ? expert_major_starts[block] : source_major_starts[block];
+    for (int64_t row = blockIdx.y; row < num_rows; row += gridDim.y)
+    {
+        int4 const* input_row = input + (input_start + row) * row_vecs;
+        int4* output_row = output + (output_start + row) * row_vecs;
+        for (int64_t vec = threadIdx.x; vec < row_vecs; vec += blockDim.x)
+        {
+            output_row[vec] = input_row[vec];
+        }
+    }
+}
+
+void regroupAllToAllRows(void const* input, void* output, int64_t const* block_counts,
+    int64_t const* source_major_starts, int64_t const* expert_major_starts, int const num_blocks,
+    size_t const row_bytes, bool to_expert_major, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(row_bytes % sizeof(int4) == 0, "The all-to-all rows must be multiples of 16 bytes");
+    int64_t const row_vecs = row_bytes / sizeof(int4);
+    dim3 const grid(num_blocks, REGROUP_ROW_SLICES);
+    int const threads = std::min<int64_t>(REGROUP_THREADS_PER_BLOCK, row_vecs);
+    auto* const func = to_expert_major ? &regroupAllToAllRowsKernel<true> : &regroupAllToAllRowsKernel<false>;
+    func<<<grid, threads, 0, stream>>>(static_cast<int4 const*>(input), static_cast<int4*>(output), block_counts,
+        source_major_starts, expert_major_starts, row_vecs);
+}
+
 // ============================== Gated Activation =================================
 constexpr static int ACTIVATION_THREADS_PER_BLOCK = 256;
 
@@ -1228,6 +1378,189 @@ void doActivation(T* output, GemmOutputType const* gemm_result, float const* fp8
         expert_first_token_offset, num_experts, inter_size, isGatedActivation(activation_type));
 }
 
+// ============================== Small M GEMV =================================
+// With only a few tokens every selected expert sees one or two rows, so instead of sorting and permuting them for the
+// grouped GEMMs each (token, expert) pair is computed directly from the routing result: one warp per output element
+// reads the expert's weight row and the token, and the second kernel also does the k-way reduction of finalize.
+constexpr static int GEMV_WARPS_PER_BLOCK = 4;
+
+template <class T>
+__device__ float moeGemvWarpDot(T const* weights, T const* input, int64_t size)
+{
+    constexpr int64_t GEMV_ELEM_PER_THREAD = 128 / cutlass::sizeof_bits<T>::value;
+
+    using DataElem = cutlass::Array<T, GEMV_ELEM_PER_THREAD>;
+    using ComputeElem = cutlass::Array<float, GEMV_ELEM_PER_THREAD>;
+    auto const* weights_vec = reinterpret_cast<DataElem const*>(weights);
+    auto const* input_vec = reinterpret_cast<DataElem const*>(input);
+    assert(size % GEMV_ELEM_PER_THREAD == 0);
+    int64_t const num_elems = size / GEMV_ELEM_PER_THREAD;
+
+    float sum = 0.f;
+    for (int64_t elem_index = threadIdx.x % WARP_SIZE; elem_index < num_elems; elem_index += WARP_SIZE)
+    {
+        auto const weight = arrayConvert<DataElem, ComputeElem>(weights_vec[elem_index]);
+        auto const value = arrayConvert<DataElem, ComputeElem>(input_vec[elem_index]);
+#pragma unroll
+        for (int i = 0; i < GEMV_ELEM_PER_THREAD; i++)
+        {
+            sum += weight[i] * value[i];
+        }
+    }
+#pragma unroll
+    for (int mask = WARP_SIZE / 2; mask > 0; mask /= 2)
+    {
+        sum += __shfl_xor_sync(0xffffffff, sum, mask);
+    }
+    return sum;
+}
+
+// FC1 with bias and activation of every expanded row, in the token major order of expert_for_source_row
+template <class T, class ScaleBiasType, template <class> class ActFn>
+__global__ void moeGemvFc1Kernel(T* output, T const* input, T const* weights, ScaleBiasType const* bias,
+    int const* expert_for_source_row, int64_t hidden_size, int64_t inter_size, int num_experts_per_node, int64_t k,
+    bool gated)
+{
+    int64_t const expanded_row = blockIdx.x;
+    int64_t const col = blockIdx.y * GEMV_WARPS_PER_BLOCK + threadIdx.x / WARP_SIZE;
+    int64_t const expert = expert_for_source_row[expanded_row];
+    // Experts of other ranks are skipped like the rows past num_valid_tokens of the grouped path
+    if (expert >= num_experts_per_node || col >= inter_size)
+    {
+        return;
+    }
+
+    int64_t const gated_size_mul = gated ? 2 : 1;
+    int64_t const gated_off = gated ? inter_size : 0;
+    T const* input_row = input + (expanded_row / k) * hidden_size;
+    T const* expert_weights = weights + expert * inter_size * gated_size_mul * hidden_size;
+    ScaleBiasType const* expert_bias = bias ? bias + expert * inter_size * gated_size_mul : nullptr;
+
+    float fc1_value = moeGemvWarpDot(expert_weights + (col + gated_off) * hidden_size, input_row, hidden_size);
+    if (expert_bias)
+    {
+        fc1_value += static_cast<float>(expert_bias[col + gated_off]);
+    }
+
+    ActFn<float> fn{};
+    float gate_act = fn(fc1_value);
+
+    if (gated)
+    {
+        float gate_mul = moeGemvWarpDot(expert_weights + col * hidden_size, input_row, hidden_size);
+        if (expert_bias)
+        {
+            gate_mul += static_cast<float>(expert_bias[col]);
+        }
+        gate_act = gate_act * gate_mul;
+    }
+
+    if (threadIdx.x % WARP_SIZE == 0)
+    {
+        output[expanded_row * inter_size + col] = static_cast<T>(gate_act);
+    }
+}
+
+// FC2 of the k expanded rows of a token, with bias, scaled and reduced like finalizeMoeRoutingKernel
+template <class T, class OutputType, class ScaleBiasType, ScaleMode SCALE_MODE>
+__global__ void moeGemvFc2Kernel(OutputType* output, T const* fc1_result, T const* weights, ScaleBiasType const* bias,
+    float const* scales, int const* expert_for_source_row, int64_t hidden_size, int64_t inter_size,
+    int num_experts_per_node, int64_t k)
+{
+    int64_t const token = blockIdx.x;
+    int64_t const col = blockIdx.y * GEMV_WARPS_PER_BLOCK + threadIdx.x / WARP_SIZE;
+    if (col >= hidden_size)
+    {
+        return;
+    }
+
+    bool has_valid = false;
+    float sum = 0.f;
+    float row_rescale = 0.f;
+    for (int64_t k_idx = 0; k_idx < k; ++k_idx)
+    {
+        int64_t const expanded_row = token * k + k_idx;
+        float const row_scale = (SCALE_MODE == ScaleMode::NO_SCALE) ? 1.f : scales[expanded_row];
+        if constexpr (SCALE_MODE == ScaleMode::RENORM_SCALE)
+        {
+            row_rescale = row_rescale + row_scale;
+        }
+
+        int64_t const expert = expert_for_source_row[expanded_row];
+        if (expert >= num_experts_per_node)
+        {
+            continue;
+        }
+
+        float expert_result = moeGemvWarpDot(
+            weights + (expert * hidden_size + col) * inter_size, fc1_result + expanded_row * inter_size, inter_size);
+        if (bias)
+        {
+            expert_result += static_cast<float>(bias[expert * hidden_size + col]);
+        }
+        sum += row_scale * expert_result;
+        has_valid = true;
+    }
+
+    if (SCALE_MODE == ScaleMode::RENORM_SCALE && has_valid)
+    {
+        assert(row_rescale != 0.f);
+        sum /= row_rescale;
+    }
+
+    if (threadIdx.x % WARP_SIZE == 0)
+    {
+        output[token * hidden_size + col] = static_cast<OutputType>(sum);
+    }
+}
+
+template <class T, class ScaleBiasType>
+void moeGemvFc1Launcher(T const* input, T const* fc1_weights, ScaleBiasType const* fc1_bias,
+    int const* expert_for_source_row, T* fc1_result, int64_t num_rows, int64_t hidden_size, int64_t inter_size,
+    int num_experts_per_node, int64_t k, ActivationType activation_type, cudaStream_t stream)
+{
+    int64_t const threads = GEMV_WARPS_PER_BLOCK * WARP_SIZE;
+
+    auto fn_list = std::array{
+        &moeGemvFc1Kernel<T, ScaleBiasType, cutlass::epilogue::thread::GELU>,    // Gelu
+        &moeGemvFc1Kernel<T, ScaleBiasType, cutlass::epilogue::thread::ReLu>,    // Relu
+        &moeGemvFc1Kernel<T, ScaleBiasType, cutlass::epilogue::thread::SiLu>,    // Silu
+        &moeGemvFc1Kernel<T, ScaleBiasType, cutlass::epilogue::thread::SiLu>,    // Swiglu
+        &moeGemvFc1Kernel<T, ScaleBiasType, cutlass::epilogue::thread::GELU>,    // Geglu
+        &moeGemvFc1Kernel<T, ScaleBiasType, cutlass::epilogue::thread::Identity> // Identity
+    };
+    dim3 const blocks(num_rows * k, ceilDiv(inter_size, GEMV_WARPS_PER_BLOCK));
+    fn_list[static_cast<int>(activation_type)]<<<blocks, threads, 0, stream>>>(fc1_result, input, fc1_weights,
+        fc1_bias, expert_for_source_row, hidden_size, inter_size, num_experts_per_node, k,
+        isGatedActivation(activation_type));
+}
+
+template <class T, class OutputType, class ScaleBiasType>
+void moeGemvFc2Launcher(T const* fc1_result, T const* fc2_weights, ScaleBiasType const* fc2_bias,
+    float const* scales, int const* expert_for_source_row, OutputType* final_output, int64_t num_rows,
+    int64_t hidden_size, int64_t inter_size, int num_experts_per_node, int64_t k,
+    MOEParallelismConfig parallelism_config, MOEExpertScaleNormalizationMode normalization_mode, cudaStream_t stream)
+{
+    int64_t const threads = GEMV_WARPS_PER_BLOCK * WARP_SIZE;
+
+    // Only add bias on rank 0 for tensor parallelism
+    ScaleBiasType const* bias_ptr = parallelism_config.tp_rank == 0 ? fc2_bias : nullptr;
+
+    ScaleMode renorm_scales = ScaleMode::DEFAULT;
+    if (normalization_mode == MOEExpertScaleNormalizationMode::RENORMALIZE)
+    {
+        renorm_scales = k == 1 ? ScaleMode::NO_SCALE : ScaleMode::RENORM_SCALE;
+    }
+    auto fn_list = std::array{
+        &moeGemvFc2Kernel<T, OutputType, ScaleBiasType, ScaleMode::NO_SCALE>,
+        &moeGemvFc2Kernel<T, OutputType, ScaleBiasType, ScaleMode::DEFAULT>,
+        &moeGemvFc2Kernel<T, OutputType, ScaleBiasType, ScaleMode::RENORM_SCALE>,
+    };
+    dim3 const blocks(num_rows, ceilDiv(hidden_size, GEMV_WARPS_PER_BLOCK));
+    fn_list[static_cast<int>(renorm_scales)]<<<blocks, threads, 0, stream>>>(final_output, fc1_result, fc2_weights,
+        bias_ptr, scales, expert_for_source_row, hidden_size, inter_size, num_experts_per_node, k);
+}
+
 // ============================== Lora Add Bias =================================
 constexpr static int LORA_KERNELS_THREADS_PER_BLOCK = 256;
 
@@ -1414,11 +1747,16 @@ template <class T, class WeightType, class OutputType, class ScaleBiasType, clas
 std::vector<size_t> CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::getWorkspaceDeviceBufferSizes(
     int64_t const num_rows, int64_t const hidden_size, int64_t const inter_size, int const num_experts,
     int const num_experts_per_node, int const k, ActivationType activation_type,
-    MOEExpertScaleNormalizationMode norm_mode, bool use_lora) const
+    MOEExpertScaleNormalizationMode norm_mode, bool use_lora, bool use_all_to_all) const
 {
     size_t const num_moe_inputs = k * num_rows;
-    size_t const permuted_elems = num_moe_inputs * hidden_size;
-    size_t const interbuf_elems = num_moe_inputs * inter_size;
+    // With the all-to-all the experts of this rank may receive the rows of every rank in the group, at most
+    // min(k, num_experts_per_node) per token. num_rows bounds the rows of every rank.
+    size_t const num_expert_rows = use_all_to_all
+        ? num_experts / num_experts_per_node * num_rows * std::min(k, num_experts_per_node)
+        : num_moe_inputs;
+    size_t const permuted_elems = num_expert_rows * hidden_size;
+    size_t const interbuf_elems = num_expert_rows * inter_size;
     size_t glu_inter_elems = 0;
     bool is_gated_activation = isGatedActivation(activation_type);
     if (is_gated_activation)
@@ -1436,24 +1774,28 @@ std::vector<size_t> CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType,
 
     size_t const gemm_output_dtype = sizeof(UnfusedGemmOutputType);
 
+    // The router picks among the logical experts
+    int const num_routed_experts = expert_replicas_.enabled() ? expert_replicas_.num_logical_experts : num_experts;
     size_t sparse_mixer_outs = 0;
     if (norm_mode == MOEExpertScaleNormalizationMode::SPARSE_MIXER)
     {
-        sparse_mixer_outs = num_rows * num_experts;
+        sparse_mixer_outs = num_rows * num_routed_experts;
     }
 
     size_t num_softmax_outs = 0;
-    bool const is_pow_2 = (num_experts != 0) && ((num_experts & (num_experts - 1)) == 0);
-    if (!is_pow_2 || num_experts > 256)
+    bool const is_pow_2 = (num_routed_experts != 0) && ((num_routed_experts & (num_routed_experts - 1)) == 0);
+    if (!is_pow_2 || num_routed_experts > 256)
     {
-        num_softmax_outs = num_rows * num_experts;
+        num_softmax_outs = num_rows * num_routed_experts;
     }
 
     size_t const source_rows_size = num_moe_inputs * sizeof(int);
     size_t const permuted_rows_size = num_moe_inputs * sizeof(int);
     size_t const permuted_experts_size = num_moe_inputs * sizeof(int);
     size_t const permuted_data_size = permuted_elems * sizeof(T);
-    size_t const expert_first_token_offset_size = (num_experts_per_node + 1) * sizeof(int64_t);
+    // The all-to-all sorts the rows over all the experts to group them by destination rank
+    size_t const expert_first_token_offset_size
+        = ((use_all_to_all ? num_experts : num_experts_per_node) + 1) * sizeof(int64_t);
     size_t const sparse_mixer_out_size = sparse_mixer_outs * sizeof(float);
     size_t const softmax_out_size = num_softmax_outs * sizeof(float);
     size_t const permuted_scales_size = mayHaveFinalizeFused() ? num_moe_inputs * sizeof(float) : 0;
@@ -1475,6 +1817,11 @@ std::vector<size_t> CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType,
     size_t const lora_add_bias_size = use_lora ? lora_fc1_result_size : 0;
     size_t const lora_fc2_result_size = use_lora ? permuted_elems * sizeof(ScaleBiasType) : 0;
 
+    // The send/recv counts and the (source rank, local expert) block starts, then the rows as received from the ranks
+    size_t const a2a_counts_size
+        = use_all_to_all ? (4 * num_experts + num_experts_per_node + 1) * sizeof(int64_t) : 0;
+    size_t const a2a_rows_size = use_all_to_all ? permuted_elems * std::max(sizeof(T), gemm_output_dtype) : 0;
+
     // We do some overlapping of the large workspace buffers. Although we could overlap some of the other buffers, they
     // are small enough (i.e no factor of hidden size) they will only be a couple MiB at most, so we don't bother
     // in the case of fused activation we overlap permuted_data and fc2_result
@@ -1514,7 +1861,9 @@ std::vector<size_t> CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType,
         lora_input_size,                //
         lora_fc1_result_size,           //
         lora_add_bias_size,             //
-        lora_fc2_result_size};
+        lora_fc2_result_size,           //
+        a2a_counts_size,                //
+        a2a_rows_size};
     return workspace;
 }
 
@@ -1526,8 +1875,8 @@ size_t CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::get
 {
     int const ep_size = parallelism_config.ep_size;
     TLLM_CHECK_WITH_INFO(num_experts % ep_size == 0, "Number of experts must be a multiple of ep size");
-    auto workspace = getWorkspaceDeviceBufferSizes(
-        num_rows, hidden_size, inter_size, num_experts, num_experts / ep_size, k, activation_type, norm_mode, use_lora);
+    auto workspace = getWorkspaceDeviceBufferSizes(num_rows, hidden_size, inter_size, num_experts,
+        num_experts / ep_size, k, activation_type, norm_mode, use_lora, parallelism_config.use_all_to_all);
     auto ws_size = tensorrt_llm::common::calculateTotalWorkspaceSize(workspace.data(), workspace.size());
     TLLM_LOG_DEBUG("Mixture Of Experts Plugin requires workspace of %2f MiB", ws_size / 1024.f / 1024.f);
     return ws_size;
@@ -1537,11 +1886,11 @@ template <class T, class WeightType, class OutputType, class ScaleBiasType, clas
 void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::configureWsPtrs(char* ws_ptr,
     int64_t const num_rows, int64_t const hidden_size, int64_t const inter_size, int const num_experts,
     int const num_experts_per_node, int const k, ActivationType activation_type,
-    MOEExpertScaleNormalizationMode norm_mode, bool use_lora)
+    MOEExpertScaleNormalizationMode norm_mode, bool use_lora, bool use_all_to_all)
 
 {
-    auto ws_sizes = getWorkspaceDeviceBufferSizes(
-        num_rows, hidden_size, inter_size, num_experts, num_experts_per_node, k, activation_type, norm_mode, use_lora);
+    auto ws_sizes = getWorkspaceDeviceBufferSizes(num_rows, hidden_size, inter_size, num_experts, num_experts_per_node,
+        k, activation_type, norm_mode, use_lora, use_all_to_all);
 
     std::vector<int8_t*> ws_sliced{(int8_t*) ws_ptr};
     for (auto size : ws_sizes)
@@ -1563,8 +1912,9 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::confi
     }
 
     softmax_out_ = nullptr;
-    bool const is_pow_2 = (num_experts != 0) && ((num_experts & (num_experts - 1)) == 0);
-    if (!is_pow_2 || num_experts > 256)
+    int const num_routed_experts = expert_replicas_.enabled() ? expert_replicas_.num_logical_experts : num_experts;
+    bool const is_pow_2 = (num_routed_experts != 0) && ((num_routed_experts & (num_routed_experts - 1)) == 0);
+    if (!is_pow_2 || num_routed_experts > 256)
     {
         softmax_out_ = (float*) ws_sliced[5];
     }
@@ -1613,6 +1963,23 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::confi
         lora_add_bias_ = (ScaleBiasType*) ws_sliced[15];
         lora_fc2_result_ = (ScaleBiasType*) ws_sliced[16];
     }
+
+    a2a_send_counts_ = {};
+    a2a_recv_counts_ = {};
+    a2a_expert_first_token_offset_ = {};
+    a2a_source_major_starts_ = {};
+    a2a_expert_major_starts_ = {};
+    a2a_rows_ = {};
+
+    if (use_all_to_all)
+    {
+        a2a_send_counts_ = (int64_t*) ws_sliced[17];
+        a2a_recv_counts_ = a2a_send_counts_ + num_experts;
+        a2a_source_major_starts_ = a2a_recv_counts_ + num_experts;
+        a2a_expert_major_starts_ = a2a_source_major_starts_ + num_experts;
+        a2a_expert_first_token_offset_ = a2a_expert_major_starts_ + num_experts;
+        a2a_rows_ = ws_sliced[18];
+    }
 }
 
 void sortAndScanSoftmaxOutput(int* expert_for_source_row, int* source_rows, int* permuted_experts, int* permuted_rows,
@@ -1639,10 +2006,11 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::gemm1
     void* const intermediate_result, int64_t const* const expert_first_token_offset,
     HopperGroupedGemmInput const hopper_input_template, WeightType const* const fc1_expert_weights,
     ScaleBiasType const* const fc1_expert_biases, int64_t const* const num_valid_tokens_ptr,
-    ScaleBiasType const* const fc1_int_scales, float const* const fc1_fp8_dequant, float const* const fc2_fp8_quant,
-    int64_t const expanded_num_rows, int64_t const hidden_size, int64_t const inter_size,
-    int const num_experts_per_node, ActivationType fc1_activation_type, float const** alpha_scale_ptr_array,
-    bool bias_is_broadcast, cudaStream_t stream, cutlass_extensions::CutlassGemmConfig config)
+    ScaleBiasType const* const fc1_int_scales, ScaleBiasType const* const fc1_int_zeros, int64_t const group_size,
+    float const* const fc1_fp8_dequant, float const* const fc2_fp8_quant, int64_t const expanded_num_rows,
+    int64_t const hidden_size, int64_t const inter_size, int const num_experts_per_node,
+    ActivationType fc1_activation_type, float const** alpha_scale_ptr_array, bool bias_is_broadcast,
+    cudaStream_t stream, cutlass_extensions::CutlassGemmConfig config)
 {
     bool const using_hopper_gemm1 = gemm_runner.isHopperSpecialised(config);
     bool const is_gated_activation = isGatedActivation(fc1_activation_type);
@@ -1668,7 +2036,7 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::gemm1
             static_cast<UnfusedGemmOutputType*>(gemm_output), stream);
         sync_check_cuda_error();
 
-        gemm_runner.moeGemm(input, nullptr, nullptr, nullptr, total_tokens_including_expert, hopper_input,
+        gemm_runner.moeGemm(input, nullptr, nullptr, nullptr, 0, nullptr, total_tokens_including_expert, hopper_input,
             expanded_num_rows, fc1_out_size, hidden_size, num_experts_per_node, false, alpha_scale_ptr_array, stream,
             config);
 
@@ -1688,7 +2056,7 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::gemm1
         alpha_scale_ptr_array
             = computeFP8DequantScale(alpha_scale_ptr_array, num_experts_per_node, fc1_fp8_dequant, stream);
 
-        gemm_runner.moeGemm(input, fc1_expert_weights, nullptr,
+        gemm_runner.moeGemm(input, fc1_expert_weights, nullptr, nullptr, 0,
             reinterpret_cast<UnfusedGemmOutputType*>(intermediate_result), total_tokens_including_expert,
             HopperGroupedGemmInput{}, expanded_num_rows, fc1_out_size, hidden_size, num_experts_per_node, false,
             alpha_scale_ptr_array, stream, config);
@@ -1703,9 +2071,10 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::gemm1
     {
         TLLM_CHECK(!use_ampere_activation_fusion);
         TLLM_CHECK(!config.is_sm90);
-        gemm_runner.moeGemmBiasAct(input, fc1_expert_weights, fc1_int_scales, fc1_expert_biases, bias_is_broadcast,
-            output, total_tokens_including_expert, HopperGroupedGemmInput{}, expanded_num_rows, fc1_out_size,
-            hidden_size, num_experts_per_node, fc1_activation_type, false, alpha_scale_ptr_array, stream, config);
+        gemm_runner.moeGemmBiasAct(input, fc1_expert_weights, fc1_int_scales, fc1_int_zeros, group_size,
+            fc1_expert_biases, bias_is_broadcast, output, total_tokens_including_expert, HopperGroupedGemmInput{},
+            expanded_num_rows, fc1_out_size, hidden_size, num_experts_per_node, fc1_activation_type, false,
+            alpha_scale_ptr_array, stream, config);
 
         sync_check_cuda_error();
     }
@@ -1719,10 +2088,10 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::gemm1
         // Run the GEMM with activation function overridden with `Identity`, we do the activation separately
         ActivationType activation_type = use_ampere_activation_fusion ? fc1_activation_type : ActivationType::Identity;
         void* gemm_result = use_ampere_activation_fusion ? static_cast<void*>(output) : intermediate_result;
-        gemm_runner.moeGemmBiasAct(input, fc1_expert_weights, fc1_int_scales, fc1_expert_biases, bias_is_broadcast,
-            gemm_result, total_tokens_including_expert, HopperGroupedGemmInput{}, expanded_num_rows, fc1_out_size,
-            hidden_size, num_experts_per_node, activation_type, use_ampere_activation_fusion, alpha_scale_ptr_array,
-            stream, config);
+        gemm_runner.moeGemmBiasAct(input, fc1_expert_weights, fc1_int_scales, fc1_int_zeros, group_size,
+            fc1_expert_biases, bias_is_broadcast, gemm_result, total_tokens_including_expert, HopperGroupedGemmInput{},
+            expanded_num_rows, fc1_out_size, hidden_size, num_experts_per_node, activation_type,
+            use_ampere_activation_fusion, alpha_scale_ptr_array, stream, config);
 
         sync_check_cuda_error();
 
@@ -1743,13 +2112,14 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::gemm2
     OutputType* const final_output, int64_t const* const expert_first_token_offset,
     HopperGroupedGemmInput const hopper_input_template, WeightType const* const fc2_expert_weights,
     ScaleBiasType const* const fc2_expert_biases, ScaleBiasType const* const fc2_int_scales,
-    float const* const fc2_fp8_dequant, float const* const token_topk_unpermuted_scales,
-    float const* const token_topk_permuted_scales, int const* const expanded_source_row_to_expanded_dest_row,
-    int const* expanded_dest_row_to_expanded_source_row, int const* const expert_for_source_row,
-    int64_t const* const num_valid_tokens_ptr, int64_t const num_rows, int64_t const expanded_num_rows,
-    int64_t const hidden_size, int64_t const inter_size, int const num_experts_per_node, int64_t const k,
-    bool using_hopper_fused_finalize, float const** alpha_scale_ptr_array, bool use_lora, void* fc2_lora,
-    cudaStream_t stream, MOEParallelismConfig parallelism_config, cutlass_extensions::CutlassGemmConfig config)
+    ScaleBiasType const* const fc2_int_zeros, int64_t const group_size, float const* const fc2_fp8_dequant,
+    float const* const token_topk_unpermuted_scales, float const* const token_topk_permuted_scales,
+    int const* const expanded_source_row_to_expanded_dest_row, int const* expanded_dest_row_to_expanded_source_row,
+    int const* const expert_for_source_row, int64_t const* const num_valid_tokens_ptr, int64_t const num_rows,
+    int64_t const expanded_num_rows, int64_t const hidden_size, int64_t const inter_size,
+    int const num_experts_per_node, int64_t const k, bool using_hopper_fused_finalize,
+    float const** alpha_scale_ptr_array, bool use_lora, void* fc2_lora, cudaStream_t stream,
+    MOEParallelismConfig parallelism_config, cutlass_extensions::CutlassGemmConfig config)
 {
     int64_t const* total_tokens_including_expert = expert_first_token_offset + 1;
 
@@ -1783,7 +2153,7 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::gemm2
 
     bool fuse_lora_bias = use_lora && !(use_fp8 || using_hopper_gemm2);
 
-    gemm_runner.moeGemmBiasAct(input, fc2_expert_weights, fc2_int_scales,
+    gemm_runner.moeGemmBiasAct(input, fc2_expert_weights, fc2_int_scales, fc2_int_zeros, group_size,
         fuse_lora_bias ? static_cast<ScaleBiasType const*>(fc2_lora) : nullptr, false, gemm_output,
         total_tokens_including_expert, hopper_input, expanded_num_rows, hidden_size, inter_size, num_experts_per_node,
         ActivationType::Identity, false, alpha_scale_ptr_array, stream, config);
@@ -1802,7 +2172,12 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::gemm2
     bool has_different_output_type_ampere = use_fp8 && !using_hopper_gemm2;
     bool has_different_output_type_hopper = !using_hopper_fused_finalize && using_hopper_gemm2;
 
-    if (has_different_output_type_ampere || has_different_output_type_hopper)
+    if (final_output == nullptr)
+    {
+        // The all-to-all finalizes the rows on the rank of their tokens
+        TLLM_CHECK(!using_hopper_fused_finalize);
+    }
+    else if (has_different_output_type_ampere || has_different_output_type_hopper)
     {
         finalizeMoeRoutingKernelLauncher<T, OutputType, UnfusedGemmOutputType>(
             static_cast<UnfusedGemmOutputType const*>(gemm_output), final_output, fc2_expert_biases,
@@ -2035,6 +2410,8 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::runMo
     auto const* fc2_expert_weights = static_cast<WeightType const*>(fc2_expert_weights_void);
     auto const* fc1_int_scales = reinterpret_cast<ScaleBiasType const*>(quant_params.fc1_weight_scales);
     auto const* fc2_int_scales = reinterpret_cast<ScaleBiasType const*>(quant_params.fc2_weight_scales);
+    auto const* fc1_int_zeros = reinterpret_cast<ScaleBiasType const*>(quant_params.fc1_weight_zeros);
+    auto const* fc2_int_zeros = reinterpret_cast<ScaleBiasType const*>(quant_params.fc2_weight_zeros);
 
     auto const* fc1_fp8_dequant = quant_params.dequant_fc1;
     auto const* fc2_fp8_quant = quant_params.quant_fc2;
@@ -2045,8 +2422,9 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::runMo
     auto* token_topk_unpermuted_scales = static_cast<float*>(token_topk_final_scales_void);
 
     TLLM_CHECK_WITH_INFO(finished == nullptr, "Using 'finished' is deprecated and will be removed in future versions");
-    TLLM_CHECK_WITH_INFO(
-        num_rows == active_rows, "Using 'finished' is deprecated and will be removed in future versions");
+    // The all-to-all sizes the workspace with num_rows, the largest row count of the ranks in the group
+    TLLM_CHECK_WITH_INFO(num_rows == active_rows || (parallelism_config.use_all_to_all && active_rows <= num_rows),
+        "Using 'finished' is deprecated and will be removed in future versions");
     TLLM_CHECK(input_activations);
     TLLM_CHECK(gating_output);
     TLLM_CHECK(fc1_expert_weights);
@@ -2056,6 +2434,9 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::runMo
     TLLM_CHECK(expanded_source_row_to_expanded_dest_row);
     TLLM_CHECK(expert_for_source_row);
     TLLM_CHECK(num_experts % parallelism_config.ep_size == 0);
+    TLLM_CHECK_WITH_INFO(
+        !expert_replicas_.enabled() || (expert_replicas_.replica_offsets && expert_replicas_.replica_slots),
+        "Redundant experts need the replicas of every logical expert");
     TLLM_CHECK_WITH_INFO(hidden_size >= 128 / cutlass::sizeof_bits<WeightType>::value,
         "Hidden size is too small to meet alignment requirements for MOE GEMM");
     TLLM_CHECK_WITH_INFO(hidden_size % (128 / cutlass::sizeof_bits<WeightType>::value) == 0,
@@ -2081,6 +2462,12 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::runMo
 
         TLLM_CHECK_WITH_INFO(fc1_fp8_dequant == nullptr && fc2_fp8_quant == nullptr && fc2_fp8_dequant == nullptr,
             "FP8 scales are provided for integer quantization");
+        TLLM_CHECK_WITH_INFO((fc1_int_zeros == nullptr && fc2_int_zeros == nullptr)
+                || (fc1_int_zeros != nullptr && fc2_int_zeros != nullptr && quant_params.group_size > 0),
+            "Weight zeros must be given for both matmuls along with a group size");
+        TLLM_CHECK_WITH_INFO(quant_params.group_size == 0
+                || (hidden_size % quant_params.group_size == 0 && inter_size % quant_params.group_size == 0),
+            "Hidden and inter size must be multiples of the weight scale group size");
     }
     else if (fp8_scales_required)
     {
@@ -2114,21 +2501,56 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::runMo
         TLLM_CHECK_WITH_INFO(
             fc2_fp8_dequant == nullptr, "Scales are ignored for fp32/fp16/bf16 but received quant scale for FC2");
     }
+    TLLM_CHECK_WITH_INFO(
+        int_scales_required || (quant_params.group_size == 0 && fc1_int_zeros == nullptr && fc2_int_zeros == nullptr),
+        "Group wise weight scales are only supported for integer weights");
 
     int const num_experts_per_node = num_experts / parallelism_config.ep_size;
 
     configureWsPtrs(workspace_ptr, num_rows, hidden_size, inter_size, num_experts, num_experts_per_node, k,
-        fc1_activation_type, normalization_mode, use_lora);
+        fc1_activation_type, normalization_mode, use_lora, parallelism_config.use_all_to_all);
+
+    if (parallelism_config.use_all_to_all)
+    {
+        TLLM_CHECK_WITH_INFO(all_to_all_comm_, "The MoE all-to-all needs a communicator for the expert parallel group");
+        TLLM_CHECK_WITH_INFO(!fc1_expert_biases && !fc2_expert_biases, "Bias is not supported with the MoE all-to-all");
+        TLLM_CHECK_WITH_INFO(!use_lora, "LoRA is not supported with the MoE all-to-all");
+        runMoeAllToAll(input_activations, gating_output, fc1_expert_weights, fc1_activation_type, fc2_expert_weights,
+            fc1_int_scales, fc2_int_scales, quant_params, active_rows, hidden_size, inter_size, num_experts, k,
+            final_output, token_topk_unpermuted_scales, expanded_source_row_to_expanded_dest_row, expert_for_source_row,
+            sparse_mixer_epsilon, parallelism_config, normalization_mode, stream);
+        return;
+    }
 
     int const start_expert = num_experts_per_node * parallelism_config.ep_rank;
     int const end_expert = start_expert + num_experts_per_node;
 
-    selectExpertsForTokens(gating_output, token_topk_unpermuted_scales, sparse_mixer_out_, softmax_out_,
+    recordPhases(MoePhaseEvents::kGating, MoePhaseEvents::kGating, stream);
+    routeTokensToExperts(gating_output, token_topk_unpermuted_scales, sparse_mixer_out_, softmax_out_,
         expert_for_source_row, source_rows_, num_rows, num_experts, k, start_expert, end_expert, sparse_mixer_epsilon,
-        normalization_mode, stream);
+        normalization_mode, expert_replicas_, expert_load_histogram_, stream);
 
     sync_check_cuda_error();
 
+    // The GEMVs read the weights of unquantized experts in place, quantized ones are laid out for the grouped GEMMs
+    if constexpr (std::is_same_v<T, WeightType> && !use_fp8)
+    {
+        if (num_rows <= gemv_max_rows_ && !use_lora)
+        {
+            recordPhases(MoePhaseEvents::kPermute, MoePhaseEvents::kGemm1, stream);
+            moeGemvFc1Launcher(input_activations, fc1_expert_weights, fc1_expert_biases, expert_for_source_row,
+                fc1_result_, num_rows, hidden_size, inter_size, num_experts_per_node, k, fc1_activation_type, stream);
+            recordPhases(MoePhaseEvents::kGemm2, MoePhaseEvents::kGemm2, stream);
+            moeGemvFc2Launcher(fc1_result_, fc2_expert_weights, fc2_expert_biases, token_topk_unpermuted_scales,
+                expert_for_source_row, final_output, num_rows, hidden_size, inter_size, num_experts_per_node, k,
+                parallelism_config, normalization_mode, stream);
+            recordPhases(MoePhaseEvents::kCombine, MoePhaseEvents::kEnd, stream);
+            sync_check_cuda_error();
+            return;
+        }
+    }
+
+    recordPhases(MoePhaseEvents::kPermute, MoePhaseEvents::kPermute, stream);
     sortAndScanSoftmaxOutput(expert_for_source_row, source_rows_, permuted_experts_, permuted_rows_,
         expert_first_token_offset_, num_rows, num_experts, num_experts_per_node, k, sorter_,
         static_cast<void*>(sorter_ws_), stream);
@@ -2177,10 +2599,12 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::runMo
         }
     }
 
+    recordPhases(MoePhaseEvents::kDispatch, MoePhaseEvents::kGemm1, stream);
     Self::gemm1(moe_gemm_runner_, permuted_data_, fc1_result_, glu_inter_result_, expert_first_token_offset_,
         hopper_grouped_gemm_input_, fc1_expert_weights, fc1_expert_biases, num_valid_tokens_ptr, fc1_int_scales,
-        fc1_fp8_dequant, fc2_fp8_quant, expanded_num_rows, hidden_size, inter_size, num_experts_per_node,
-        fc1_activation_type, alpha_scale_ptr_array_, !use_lora, stream, *gemm1_config_);
+        fc1_int_zeros, quant_params.group_size, fc1_fp8_dequant, fc2_fp8_quant, expanded_num_rows, hidden_size,
+        inter_size, num_experts_per_node, fc1_activation_type, alpha_scale_ptr_array_, !use_lora, stream,
+        *gemm1_config_);
 
     sync_check_cuda_error();
 
@@ -2191,14 +2615,189 @@ void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::runMo
         sync_check_cuda_error();
     }
 
+    recordPhases(MoePhaseEvents::kGemm2, MoePhaseEvents::kGemm2, stream);
     Self::gemm2(moe_gemm_runner_, fc1_result_, fc2_result_, final_output, expert_first_token_offset_,
-        hopper_grouped_gemm_input_, fc2_expert_weights, fc2_expert_biases, fc2_int_scales, fc2_fp8_dequant,
-        token_topk_unpermuted_scales, permuted_scales_, expanded_source_row_to_expanded_dest_row, permuted_rows_,
-        expert_for_source_row, num_valid_tokens_ptr, num_rows, expanded_num_rows, hidden_size, inter_size,
-        num_experts_per_node, k, !use_deterministic_hopper_reduce_, alpha_scale_ptr_array_, use_lora, lora_fc2_result_,
-        stream, parallelism_config, *gemm2_config_);
+        hopper_grouped_gemm_input_, fc2_expert_weights, fc2_expert_biases, fc2_int_scales, fc2_int_zeros,
+        quant_params.group_size, fc2_fp8_dequant, token_topk_unpermuted_scales, permuted_scales_,
+        expanded_source_row_to_expanded_dest_row, permuted_rows_, expert_for_source_row, num_valid_tokens_ptr, num_rows,
+        expanded_num_rows, hidden_size, inter_size, num_experts_per_node, k, !use_deterministic_hopper_reduce_,
+        alpha_scale_ptr_array_, use_lora, lora_fc2_result_, stream, parallelism_config, *gemm2_config_);
+    recordPhases(MoePhaseEvents::kCombine, MoePhaseEvents::kEnd, stream);
+
+    sync_check_cuda_error();
+}
+
+template <class T, class WeightType, class OutputType, class ScaleBiasType, class Enable>
+void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::runMoeAllToAll(T const* input_activations,
+    float const* gating_output, WeightType const* fc1_expert_weights, ActivationType fc1_activation_type,
+    WeightType const* fc2_expert_weights, ScaleBiasType const* fc1_int_scales, ScaleBiasType const* fc2_int_scales,
+    QuantParams quant_params, int64_t const active_rows, int64_t const hidden_size, int64_t const inter_size,
+    int const num_experts, int const k, OutputType* final_output, float* token_topk_unpermuted_scales,
+    int* expanded_source_row_to_expanded_dest_row, int* expert_for_source_row, float sparse_mixer_epsilon,
+    MOEParallelismConfig parallelism_config, MOEExpertScaleNormalizationMode normalization_mode, cudaStream_t stream)
+{
+    int const ep_size = parallelism_config.ep_size;
+    int const num_experts_per_node = num_experts / ep_size;
+
+    // Dispatch: route the local tokens over all the experts. Sorted by expert, the expanded rows are grouped by the
+    // rank owning their expert, expert_first_token_offset_ gives the range sent to every rank.
+    recordPhases(MoePhaseEvents::kGating, MoePhaseEvents::kGating, stream);
+    if (active_rows > 0)
+    {
+        routeTokensToExperts(gating_output, token_topk_unpermuted_scales, sparse_mixer_out_, softmax_out_,
+            expert_for_source_row, source_rows_, active_rows, num_experts, k, 0, num_experts, sparse_mixer_epsilon,
+            normalization_mode, expert_replicas_, expert_load_histogram_, stream);
+        recordPhases(MoePhaseEvents::kPermute, MoePhaseEvents::kPermute, stream);
+        sortAndScanSoftmaxOutput(expert_for_source_row, source_rows_, permuted_experts_, permuted_rows_,
+            expert_first_token_offset_, active_rows, num_experts, num_experts, k, sorter_,
+            static_cast<void*>(sorter_ws_), stream);
+        expandInputRowsKernelLauncher(input_activations, permuted_data_, token_topk_unpermuted_scales,
+            permuted_scales_, permuted_rows_, expanded_source_row_to_expanded_dest_row, active_rows, nullptr,
+            hidden_size, k, stream);
+    }
+    else
+    {
+        recordPhases(MoePhaseEvents::kPermute, MoePhaseEvents::kPermute, stream);
+        // A rank without tokens still takes part in the exchanges
+        check_cuda_error(cudaMemsetAsync(expert_first_token_offset_, 0, (num_experts + 1) * sizeof(int64_t), stream));
+    }
+    sync_check_cuda_error();
+
+    recordPhases(MoePhaseEvents::kDispatch, MoePhaseEvents::kDispatch, stream);
+    computeAllToAllSendCounts(expert_first_token_offset_, a2a_send_counts_, num_experts, stream);
+    size_t const counts_bytes = num_experts_per_node * sizeof(int64_t);
+    std::vector<size_t> counts_offsets(ep_size);
+    std::vector<size_t> const counts_sizes(ep_size, counts_bytes);
+    for (int rank = 0; rank < ep_size; ++rank)
+    {
+        counts_offsets[rank] = rank * counts_bytes;
+    }
+    all_to_all_comm_->allToAll(
+        a2a_send_counts_, counts_offsets, counts_sizes, a2a_recv_counts_, counts_offsets, counts_sizes, stream);
+
+    // The row exchanges and the GEMMs are sized on the host
+    auto& host_offsets = host_a2a_workspace_.host_expert_first_token_offset;
+    auto& host_recv_counts = host_a2a_workspace_.host_recv_counts;
+    host_offsets.resize(num_experts + 1);
+    host_recv_counts.resize(num_experts);
+    TLLM_CUDA_CHECK(cudaMemcpyAsync(host_offsets.data(), expert_first_token_offset_,
+        (num_experts + 1) * sizeof(int64_t), cudaMemcpyDeviceToHost, stream));
+    TLLM_CUDA_CHECK(cudaMemcpyAsync(host_recv_counts.data(), a2a_recv_counts_, num_experts * sizeof(int64_t),
+        cudaMemcpyDeviceToHost, stream));
+    TLLM_CUDA_CHECK(cudaStreamSynchronize(stream));
+
+    // Rows per rank, sent from / returned to the sorted expanded rows and received into / returned from a2a_rows_
+    std::vector<int64_t> local_starts(ep_size);
+    std::vector<int64_t> local_rows(ep_size);
+    std::vector<int64_t> remote_starts(ep_size);
+    std::vector<int64_t> remote_rows(ep_size);
+    int64_t expert_rows = 0;
+    for (int rank = 0; rank < ep_size; ++rank)
+    {
+        local_starts[rank] = host_offsets[rank * num_experts_per_node];
+        local_rows[rank] = host_offsets[(rank + 1) * num_experts_per_node] - local_starts[rank];
+        auto const* rank_counts = host_recv_counts.data() + rank * num_experts_per_node;
+        remote_starts[rank] = expert_rows;
+        remote_rows[rank] = std::accumulate(rank_counts, rank_counts + num_experts_per_node, int64_t{0});
+        expert_rows += remote_rows[rank];
+    }
+    auto const toBytes = [ep_size](std::vector<int64_t> const& rows, size_t row_bytes)
+    {
+        std::vector<size_t> bytes(ep_size);
+        for (int rank = 0; rank < ep_size; ++rank)
+        {
+            bytes[rank] = rows[rank] * row_bytes;
+        }
+        return bytes;
+    };
+
+    size_t const input_row_bytes = hidden_size * sizeof(T);
+    all_to_all_comm_->allToAll(permuted_data_, toBytes(local_starts, input_row_bytes),
+        toBytes(local_rows, input_row_bytes), a2a_rows_, toBytes(remote_starts, input_row_bytes),
+        toBytes(remote_rows, input_row_bytes), stream);
+
+    computeAllToAllLayout(a2a_recv_counts_, a2a_expert_first_token_offset_, a2a_source_major_starts_,
+        a2a_expert_major_starts_, ep_size, num_experts_per_node, stream);
+    regroupAllToAllRows(a2a_rows_, permuted_data_, a2a_recv_counts_, a2a_source_major_starts_,
+        a2a_expert_major_starts_, num_experts, input_row_bytes, true, stream);
 
     sync_check_cuda_error();
+
+    // The experts of this rank on the received rows, unfinalized
+    bool const gemm2_using_hopper = moe_gemm_runner_.isHopperSpecialised(*gemm2_config_);
+    bool const has_unfused_gemm_output = use_fp8 || gemm2_using_hopper;
+    recordPhases(MoePhaseEvents::kGemm1, MoePhaseEvents::kGemm1, stream);
+    if (expert_rows > 0)
+    {
+        int64_t const* num_valid_tokens_ptr = a2a_expert_first_token_offset_ + num_experts_per_node;
+        Self::gemm1(moe_gemm_runner_, permuted_data_, fc1_result_, glu_inter_result_, a2a_expert_first_token_offset_,
+            hopper_grouped_gemm_input_, fc1_expert_weights, nullptr, num_valid_tokens_ptr, fc1_int_scales,
+            static_cast<ScaleBiasType const*>(quant_params.fc1_weight_zeros), quant_params.group_size,
+            quant_params.dequant_fc1, quant_params.quant_fc2, expert_rows, hidden_size, inter_size,
+            num_experts_per_node, fc1_activation_type, alpha_scale_ptr_array_, true, stream, *gemm1_config_);
+
+        sync_check_cuda_error();
+
+        recordPhases(MoePhaseEvents::kGemm2, MoePhaseEvents::kGemm2, stream);
+        Self::gemm2(moe_gemm_runner_, fc1_result_, fc2_result_, nullptr, a2a_expert_first_token_offset_,
+            hopper_grouped_gemm_input_, fc2_expert_weights, nullptr, fc2_int_scales,
+            static_cast<ScaleBiasType const*>(quant_params.fc2_weight_zeros), quant_params.group_size,
+            quant_params.dequant_fc2, nullptr, nullptr, nullptr, nullptr, nullptr, num_valid_tokens_ptr, active_rows,
+            expert_rows, hidden_size, inter_size, num_experts_per_node, k, false, alpha_scale_ptr_array_, false,
+            nullptr, stream, parallelism_config, *gemm2_config_);
+
+        sync_check_cuda_error();
+    }
+    else
+    {
+        recordPhases(MoePhaseEvents::kGemm2, MoePhaseEvents::kGemm2, stream);
+    }
+
+    // Combine: every result goes back to the rank of its token, where it takes the place of the row sent
+    recordPhases(MoePhaseEvents::kCombine, MoePhaseEvents::kCombine, stream);
+    size_t const output_row_bytes = hidden_size * (has_unfused_gemm_output ? sizeof(UnfusedGemmOutputType) : sizeof(T));
+    regroupAllToAllRows(fc2_result_, a2a_rows_, a2a_recv_counts_, a2a_source_major_starts_, a2a_expert_major_starts_,
+        num_experts, output_row_bytes, false, stream);
+    all_to_all_comm_->allToAll(a2a_rows_, toBytes(remote_starts, output_row_bytes),
+        toBytes(remote_rows, output_row_bytes), fc2_result_, toBytes(local_starts, output_row_bytes),
+        toBytes(local_rows, output_row_bytes), stream);
+
+    if (active_rows > 0)
+    {
+        auto const* no_bias = static_cast<ScaleBiasType const*>(nullptr);
+        if (has_unfused_gemm_output)
+        {
+            finalizeMoeRoutingKernelLauncher<T, OutputType, UnfusedGemmOutputType>(
+                static_cast<UnfusedGemmOutputType const*>(fc2_result_), final_output, no_bias,
+                token_topk_unpermuted_scales, expanded_source_row_to_expanded_dest_row, expert_for_source_row,
+                active_rows, hidden_size, k, nullptr, parallelism_config, MOEExpertScaleNormalizationMode::NONE,
+                stream);
+        }
+        else
+        {
+            finalizeMoeRoutingKernelLauncher<T, OutputType, T>(static_cast<T const*>(fc2_result_), final_output,
+                no_bias, token_topk_unpermuted_scales, expanded_source_row_to_expanded_dest_row, expert_for_source_row,
+                active_rows, hidden_size, k, nullptr, parallelism_config, MOEExpertScaleNormalizationMode::NONE,
+                stream);
+        }
+    }
+    recordPhases(MoePhaseEvents::kEnd, MoePhaseEvents::kEnd, stream);
+
+    sync_check_cuda_error();
+}
+
+template <class T, class WeightType, class OutputType, class ScaleBiasType, class Enable>
+void CutlassMoeFCRunner<T, WeightType, OutputType, ScaleBiasType, Enable>::recordPhases(
+    MoePhaseEvents::Phase first, MoePhaseEvents::Phase last, cudaStream_t stream) const
+{
+    if (!phase_events_)
+    {
+        return;
+    }
+    for (int phase = first; phase <= last; ++phase)
+    {
+        check_cuda_error(cudaEventRecord(phase_events_->events[phase], stream));
+    }
 }
 
 template <class T, class WeightType, class OutputType, class ScaleBiasType, class Enable>
@@ -2550,6 +3149,8 @@ void GemmProfilerBackend::runProfiler(
             bias,                                             //
             expert_first_token_offset + num_experts_per_node, //
             quant_params.fc1_weight_scales,                   //
+            quant_params.fc1_weight_zeros,                    //
+            quant_params.group_size,                          //
             quant_params.dequant_fc1,                         //
             quant_params.quant_fc2,                           //
             expanded_num_tokens,                              //
@@ -2573,6 +3174,8 @@ void GemmProfilerBackend::runProfiler(
             weights,                                        //
             bias,                                           //
             quant_params.fc2_weight_scales,                 //
+            quant_params.fc2_weight_zeros,                  //
+            quant_params.group_size,                        //
             quant_params.dequant_fc2,                       //
             token_topk_unpermuted_scales,                   //
             token_topk_permuted_scales,                     //
@@ -21,9 +21,12 @@
 #include "tensorrt_llm/common/quantization.h"
 #include "tensorrt_llm/kernels/cutlass_kernels/moe_gemm/moe_gemm_kernels.h"
 #include "tensorrt_llm/kernels/lora/lora.h"
+#include <array>
 #include <cuda_runtime_api.h>
+#include <memory>
 #include <optional>
 #include <random>
+#include <vector>
 
 namespace tensorrt_llm::kernels
 {
@@ -83,6 +86,12 @@ enum class MOEExpertScaleNormalizationMode : int
  * Regardless of parallelism mode:
  *  * The input routing values must be the complete routing for all tokens/experts (required for softmax)
  *  * An allreduce must be run on the result to combine the results from different nodes if parallelism > 1
+ *
+ * Expert Parallelism with all-to-all (use_all_to_all) instead moves the tokens to the experts: every rank routes its
+ * own tokens, sends each expanded row only to the rank owning its expert (dispatch), runs its experts on the rows it
+ * received and sends the results back to the rank of the token (combine), which finalizes them. The result of a rank
+ * is complete for its tokens, no allreduce is needed. The rows are exchanged by the MoeAllToAllCommunicator set on the
+ * runner, the mode does not support tensor parallelism, biases or LoRA.
  */
 struct MOEParallelismConfig
 {
@@ -90,14 +99,16 @@ struct MOEParallelismConfig
     int tp_rank = 0;
     int ep_size = 1;
     int ep_rank = 0;
+    bool use_all_to_all = false;
 
     MOEParallelismConfig() = default;
 
-    MOEParallelismConfig(int tp_size, int tp_rank, int ep_size, int ep_rank)
+    MOEParallelismConfig(int tp_size, int tp_rank, int ep_size, int ep_rank, bool use_all_to_all = false)
         : tp_size(tp_size)
         , tp_rank(tp_rank)
         , ep_size(ep_size)
         , ep_rank(ep_rank)
+        , use_all_to_all(use_all_to_all)
     {
         // Do some basic sanity checks
         TLLM_CHECK(tp_rank < tp_size);
@@ -106,22 +117,86 @@ struct MOEParallelismConfig
         TLLM_CHECK(ep_rank < ep_size);
         TLLM_CHECK(ep_rank >= 0);
         TLLM_CHECK(ep_size >= 1);
+        TLLM_CHECK_WITH_INFO(!use_all_to_all || tp_size == 1, "The MoE all-to-all does not support tensor parallelism");
     }
 
     bool operator==(MOEParallelismConfig const& other) const
     {
         return tp_size == other.tp_size && tp_rank == other.tp_rank && ep_size == other.ep_size
-            && ep_rank == other.ep_rank;
+            && ep_rank == other.ep_rank && use_all_to_all == other.use_all_to_all;
     }
 
     friend std::ostream& operator<<(std::ostream& os, MOEParallelismConfig const& config)
     {
         os << "tp_size: " << config.tp_size << ", tp_rank: " << config.tp_rank << ", ep_size: " << config.ep_size
-           << ", ep_rank: " << config.ep_rank;
+           << ", ep_rank: " << config.ep_rank << ", use_all_to_all: " << config.use_all_to_all;
         return os;
     }
 };
 
+/**
+ * \brief Exchanges the expanded rows between the ranks of the expert parallel group in the all-to-all mode
+ *
+ * Every rank sends send_sizes[r] bytes at send + send_offsets[r] to rank r of the group and receives recv_sizes[r]
+ * bytes from rank r at recv + recv_offsets[r], all ranks taking part in every call. The offsets and sizes are in bytes
+ * and on the host, zero sizes skip the peer.
+ */
+class MoeAllToAllCommunicator
+{
+public:
+    virtual ~MoeAllToAllCommunicator() = default;
+
+    virtual void allToAll(void const* send, std::vector<size_t> const& send_offsets,
+        std::vector<size_t> const& send_sizes, void* recv, std::vector<size_t> const& recv_offsets,
+        std::vector<size_t> const& recv_sizes, cudaStream_t stream)
+        = 0;
+};
+
+/**
+ * \brief Redundant experts: hot experts get replicas in extra expert slots, usually placed on other ranks
+ *
+ * The weights hold the physical experts (the num_experts of runMoe) and the router the num_logical_experts logical
+ * ones. The replicas of logical expert e are the physical experts replica_slots[replica_offsets[e], replica_offsets[e +
+ * 1]), every logical expert has at least one. The tokens routed to an expert are spread round robin over its replicas.
+ * Both arrays are on the device, they are only read when routing so the workspace can be sized without them. With
+ * expert offloading there are fewer physical experts, the expert slots, and only the experts the tokens select have
+ * their slot as replica.
+ */
+struct MoeExpertReplicas
+{
+    int num_logical_experts = 0;
+    int const* replica_offsets = nullptr;
+    int const* replica_slots = nullptr;
+
+    bool enabled() const
+    {
+        return num_logical_experts > 0;
+    }
+};
+
+/**
+ * \brief Events runMoe records on its stream at the start of each of its phases and at its end, for benchmarks
+ *
+ * Phases a path does not have are recorded back to back. Without the all-to-all GEMM2 includes the finalize fused
+ * into it, the GEMV path for small batches times FC1 and FC2 as the two GEMMs.
+ */
+struct MoePhaseEvents
+{
+    enum Phase : int
+    {
+        kGating = 0,
+        kPermute,
+        kDispatch,
+        kGemm1,
+        kGemm2,
+        kCombine,
+        kEnd,
+        kNumEvents
+    };
+
+    std::array<cudaEvent_t, kNumEvents> events{};
+};
+
 struct QuantParams
 {
     // Int weight only quantization params
@@ -135,6 +210,12 @@ struct QuantParams
     float const* quant_final = nullptr;
     float const* dequant_input = nullptr;
 
+    // Group wise int weight only quantization params, the scales (and zeros) are [num_experts, k / group_size, n] for
+    // a [k, n] expert matrix. A group_size of 0 means one scale per column and no zeros
+    void const* fc1_weight_zeros = nullptr;
+    void const* fc2_weight_zeros = nullptr;
+    int64_t group_size = 0;
+
     static QuantParams FP8(float const* dequant_fc1, float const* quant_fc2, float const* dequant_fc2,
         float const* quant_final = nullptr, float const* dequant_input = nullptr)
     {
@@ -145,6 +226,13 @@ struct QuantParams
     {
         return QuantParams{fc1_weight_scales, fc2_weight_scales, nullptr, nullptr, nullptr, nullptr, nullptr};
     }
+
+    static QuantParams GroupWise(int64_t group_size, void const* fc1_weight_scales, void const* fc2_weight_scales,
+        void const* fc1_weight_zeros = nullptr, void const* fc2_weight_zeros = nullptr)
+    {
+        return QuantParams{fc1_weight_scales, fc2_weight_scales, nullptr, nullptr, nullptr, nullptr, nullptr,
+            fc1_weight_zeros, fc2_weight_zeros, group_size};
+    }
 };
 
 struct LoraParams
@@ -219,29 +307,40 @@ public:
     virtual void gemm1(void const* const input, void* const output, void* const intermediate_result,
         int64_t const* const expert_first_token_offset, HopperGroupedGemmInput hopper_input_template,
         void const* const fc1_expert_weights, void const* const fc1_expert_biases,
-        int64_t const* const num_valid_tokens_ptr, void const* const fc1_int_scales, float const* const fc1_fp8_dequant,
-        float const* const fc2_fp8_quant, int64_t const expanded_num_rows, int64_t const hidden_size,
-        int64_t const inter_size, int const num_experts_per_node, ActivationType fc1_activation_type,
-        float const** alpha_scale_ptr_array, bool bias_is_broadcast, cudaStream_t stream,
-        cutlass_extensions::CutlassGemmConfig config)
+        int64_t const* const num_valid_tokens_ptr, void const* const fc1_int_scales, void const* const fc1_int_zeros,
+        int64_t const group_size, float const* const fc1_fp8_dequant, float const* const fc2_fp8_quant,
+        int64_t const expanded_num_rows, int64_t const hidden_size, int64_t const inter_size,
+        int const num_experts_per_node, ActivationType fc1_activation_type, float const** alpha_scale_ptr_array,
+        bool bias_is_broadcast, cudaStream_t stream, cutlass_extensions::CutlassGemmConfig config)
         = 0;
 
     virtual void gemm2(void const* const input, void* const gemm_output, void* const final_output,
         int64_t const* const expert_first_token_offset, HopperGroupedGemmInput const hopper_input_template,
         void const* const fc2_expert_weights, void const* const fc2_expert_biases, void const* const fc2_int_scales,
-        float const* const fc2_fp8_dequant, float const* const token_topk_unpermuted_scales,
-        float const* const token_topk_permuted_scales, int const* const expanded_source_row_to_expanded_dest_row,
-        int const* expanded_dest_row_to_expanded_source_row, int const* const expert_for_source_row,
-        int64_t const* const num_valid_tokens_ptr, int64_t const num_rows, int64_t const expanded_num_rows,
-        int64_t const hidden_size, int64_t const inter_size, int const num_experts_per_node, int64_t const k,
-        bool using_hopper_fused_finalize, float const** alpha_scale_ptr_array, bool use_lora, void* fc2_lora,
-        cudaStream_t stream, MOEParallelismConfig parallelism_config, cutlass_extensions::CutlassGemmConfig config)
+        void const* const fc2_int_zeros, int64_t const group_size, float const* const fc2_fp8_dequant,
+        float const* const token_topk_unpermuted_scales, float const* const token_topk_permuted_scales,
+        int const* const expanded_source_row_to_expanded_dest_row, int const* expanded_dest_row_to_expanded_source_row,
+        int const* const expert_for_source_row, int64_t const* const num_valid_tokens_ptr, int64_t const num_rows,
+        int64_t const expanded_num_rows, int64_t const hidden_size, int64_t const inter_size,
+        int const num_experts_per_node, int64_t const k, bool using_hopper_fused_finalize,
+        float const** alpha_scale_ptr_array, bool use_lora, void* fc2_lora, cudaStream_t stream,
+        MOEParallelismConfig parallelism_config, cutlass_extensions::CutlassGemmConfig config)
         = 0;
 
     virtual size_t getGemmWorkspaceSize(int num_experts) const = 0;
 
     bool is_profiler = false;
     bool use_deterministic_hopper_reduce_ = false;
+    // Moves the rows between the ranks when the parallelism config uses the all-to-all
+    std::shared_ptr<MoeAllToAllCommunicator> all_to_all_comm_;
+    // When set, every expert a token selects is counted into it, indexed by the logical expert
+    int* expert_load_histogram_ = nullptr;
+    MoeExpertReplicas expert_replicas_;
+    // Up to this many tokens the unquantized experts run as GEMVs over the selected experts, skipping the sort and the
+    // grouped GEMMs. That path does not write expanded_source_row_to_expanded_dest_row.
+    int64_t gemv_max_rows_ = 0;
+    // When set, the start of every phase is recorded into it
+    MoePhaseEvents* phase_events_ = nullptr;
 };
 
 // Assumes inputs activations are row major. Weights need to be preprocessed by th_op/weight_quantize.cc .
@@ -313,61 +412,63 @@ public:
         T* const output, void* const intermediate_result, int64_t const* const expert_first_token_offset,
         HopperGroupedGemmInput const hopper_input_template, WeightType const* const fc1_expert_weights,
         ScaleBiasType const* const fc1_expert_biases, int64_t const* const num_valid_tokens_ptr,
-        ScaleBiasType const* const fc1_int_scales, float const* const fc1_fp8_dequant, float const* const fc2_fp8_quant,
-        int64_t const expanded_num_rows, int64_t const hidden_size, int64_t const inter_size,
-        int const num_experts_per_node, ActivationType fc1_activation_type, float const** alpha_scale_ptr_array,
-        bool bias_is_broadcast, cudaStream_t stream, cutlass_extensions::CutlassGemmConfig config);
+        ScaleBiasType const* const fc1_int_scales, ScaleBiasType const* const fc1_int_zeros, int64_t const group_size,
+        float const* const fc1_fp8_dequant, float const* const fc2_fp8_quant, int64_t const expanded_num_rows,
+        int64_t const hidden_size, int64_t const inter_size, int const num_experts_per_node,
+        ActivationType fc1_activation_type, float const** alpha_scale_ptr_array, bool bias_is_broadcast,
+        cudaStream_t stream, cutlass_extensions::CutlassGemmConfig config);
 
     static void gemm2(MoeGemmRunner<T, WeightType, OutputType, ScaleBiasType>& gemm_runner, T const* const input,
         void* const gemm_output, OutputType* const final_output, int64_t const* const expert_first_token_offset,
         HopperGroupedGemmInput const hopper_input_template, WeightType const* const fc2_expert_weights,
         ScaleBiasType const* const fc2_expert_biases, ScaleBiasType const* const fc2_int_scales,
-        float const* const fc2_fp8_dequant, float const* const token_topk_unpermuted_scales,
-        float const* const token_topk_permuted_scales, int const* const expanded_source_row_to_expanded_dest_row,
-        int const* expanded_dest_row_to_expanded_source_row, int const* const expert_for_source_row,
-        int64_t const* const num_valid_tokens_ptr, int64_t const num_rows, int64_t const expanded_num_rows,
-        int64_t const hidden_size, int64_t const inter_size, int const num_experts_per_node, int64_t const k,
-        bool using_hopper_fused_finalize, float const** alpha_scale_ptr_array, bool use_lora, void* fc2_lora,
-        cudaStream_t stream, MOEParallelismConfig parallelism_config, cutlass_extensions::CutlassGemmConfig config);
+        ScaleBiasType const* const fc2_int_zeros, int64_t const group_size, float const* const fc2_fp8_dequant,
+        float const* const token_topk_unpermuted_scales, float const* const token_topk_permuted_scales,
+        int const* const expanded_source_row_to_expanded_dest_row, int const* expanded_dest_row_to_expanded_source_row,
+        int const* const expert_for_source_row, int64_t const* const num_valid_tokens_ptr, int64_t const num_rows,
+        int64_t const expanded_num_rows, int64_t const hidden_size, int64_t const inter_size,
+        int const num_experts_per_node, int64_t const k, bool using_hopper_fused_finalize,
+        float const** alpha_scale_ptr_array, bool use_lora, void* fc2_lora, cudaStream_t stream,
+        MOEParallelismConfig parallelism_config, cutlass_extensions::CutlassGemmConfig config);
 
     // Overrides to allow us to forward on to the internal functions with the pointers using the correct type
     void gemm1(void const* const input, void* const output, void* const intermediate_result,
         int64_t const* const expert_first_token_offset, HopperGroupedGemmInput hopper_input_template,
         void const* const fc1_expert_weights, void const* const fc1_expert_biases,
-        int64_t const* const num_valid_tokens_ptr, void const* const fc1_int_scales, float const* const fc1_fp8_dequant,
-        float const* const fc2_fp8_quant, int64_t const expanded_num_rows, int64_t const hidden_size,
-        int64_t const inter_size, int const num_experts_per_node, ActivationType fc1_activation_type,
-        float const** alpha_scale_ptr_array, bool bias_is_broadcast, cudaStream_t stream,
-        cutlass_extensions::CutlassGemmConfig config) override
+        int64_t const* const num_valid_tokens_ptr, void const* const fc1_int_scales, void const* const fc1_int_zeros,
+        int64_t const group_size, float const* const fc1_fp8_dequant, float const* const fc2_fp8_quant,
+        int64_t const expanded_num_rows, int64_t const hidden_size, int64_t const inter_size,
+        int const num_experts_per_node, ActivationType fc1_activation_type, float const** alpha_scale_ptr_array,
+        bool bias_is_broadcast, cudaStream_t stream, cutlass_extensions::CutlassGemmConfig config) override
     {
         return Self::gemm1(moe_gemm_runner_, static_cast<T const*>(input), static_cast<T*>(output), intermediate_result,
             expert_first_token_offset, hopper_input_template, static_cast<WeightType const*>(fc1_expert_weights),
             static_cast<ScaleBiasType const*>(fc1_expert_biases), num_valid_tokens_ptr,
-            static_cast<ScaleBiasType const*>(fc1_int_scales), fc1_fp8_dequant, fc2_fp8_quant, expanded_num_rows,
-            hidden_size, inter_size, num_experts_per_node, fc1_activation_type, alpha_scale_ptr_array,
-            bias_is_broadcast, stream, config);
+            static_cast<ScaleBiasType const*>(fc1_int_scales), static_cast<ScaleBiasType const*>(fc1_int_zeros),
+            group_size, fc1_fp8_dequant, fc2_fp8_quant, expanded_num_rows, hidden_size, inter_size,
+            num_experts_per_node, fc1_activation_type, alpha_scale_ptr_array, bias_is_broadcast, stream, config);
     }
 
     void gemm2(void const* const input, void* const gemm_output, void* const final_output,
         int64_t const* const expert_first_token_offset, HopperGroupedGemmInput const hopper_input_template,
         void const* const fc2_expert_weights, void const* const fc2_expert_biases, void const* const fc2_int_scales,
-        float const* const fc2_fp8_dequant, float const* const token_topk_unpermuted_scales,
-        float const* const token_topk_permuted_scales, int const* const expanded_source_row_to_expanded_dest_row,
-        int const* expanded_dest_row_to_expanded_source_row, int const* const expert_for_source_row,
-        int64_t const* const num_valid_tokens_ptr, int64_t const num_rows, int64_t const expanded_num_rows,
-        int64_t const hidden_size, int64_t const inter_size, int const num_experts_per_node, int64_t const k,
-        bool using_hopper_fused_finalize, float const** alpha_scale_ptr_array, bool use_lora, void* fc2_lora,
-        cudaStream_t stream, MOEParallelismConfig parallelism_config,
-        cutlass_extensions::CutlassGemmConfig config) override
+        void const* const fc2_int_zeros, int64_t const group_size, float const* const fc2_fp8_dequant,
+        float const* const token_topk_unpermuted_scales, float const* const token_topk_permuted_scales,
+        int const* const expanded_source_row_to_expanded_dest_row, int const* expanded_dest_row_to_expanded_source_row,
+        int const* const expert_for_source_row, int64_t const* const num_valid_tokens_ptr, int64_t const num_rows,
+        int64_t const expanded_num_rows, int64_t const hidden_size, int64_t const inter_size,
+        int const num_experts_per_node, int64_t const k, bool using_hopper_fused_finalize,
+        float const** alpha_scale_ptr_array, bool use_lora, void* fc2_lora, cudaStream_t stream,
+        MOEParallelismConfig parallelism_config, cutlass_extensions::CutlassGemmConfig config) override
     {
         return Self::gemm2(moe_gemm_runner_, static_cast<T const*>(input), gemm_output,
             static_cast<OutputType*>(final_output), expert_first_token_offset, hopper_input_template,
             static_cast<WeightType const*>(fc2_expert_weights), static_cast<ScaleBiasType const*>(fc2_expert_biases),
-            static_cast<ScaleBiasType const*>(fc2_int_scales), fc2_fp8_dequant, token_topk_unpermuted_scales,
-            token_topk_permuted_scales, expanded_source_row_to_expanded_dest_row,
-            expanded_dest_row_to_expanded_source_row, expert_for_source_row, num_valid_tokens_ptr, num_rows,
-            expanded_num_rows, hidden_size, inter_size, num_experts_per_node, k, using_hopper_fused_finalize,
-            alpha_scale_ptr_array, use_lora, fc2_lora, stream, parallelism_config, config);
+            static_cast<ScaleBiasType const*>(fc2_int_scales), static_cast<ScaleBiasType const*>(fc2_int_zeros),
+            group_size, fc2_fp8_dequant, token_topk_unpermuted_scales, token_topk_permuted_scales,
+            expanded_source_row_to_expanded_dest_row, expanded_dest_row_to_expanded_source_row, expert_for_source_row,
+            num_valid_tokens_ptr, num_rows, expanded_num_rows, hidden_size, inter_size, num_experts_per_node, k,
+            using_hopper_fused_finalize, alpha_scale_ptr_array, use_lora, fc2_lora, stream, parallelism_config, config);
     }
 
     virtual size_t getGemmWorkspaceSize(int num_experts) const override
@@ -382,10 +483,19 @@ private:
         cudaStream_t stream);
     std::vector<size_t> getWorkspaceDeviceBufferSizes(int64_t const num_rows, int64_t const hidden_size,
         int64_t const inter_size, int const num_experts, int const num_experts_per_node, int const k,
-        ActivationType activation_type, MOEExpertScaleNormalizationMode norm_mode, bool use_lora) const;
+        ActivationType activation_type, MOEExpertScaleNormalizationMode norm_mode, bool use_lora,
+        bool use_all_to_all) const;
     void configureWsPtrs(char* ws_ptr, int64_t const num_rows, int64_t const hidden_size, int64_t const inter_size,
         int const num_experts, int const num_experts_per_node, int const k, ActivationType activation_type,
-        MOEExpertScaleNormalizationMode norm_mode, bool use_lora);
+        MOEExpertScaleNormalizationMode norm_mode, bool use_lora, bool use_all_to_all);
+
+    void runMoeAllToAll(T const* input_activations, float const* gating_output, WeightType const* fc1_expert_weights,
+        ActivationType fc1_activation_type, WeightType const* fc2_expert_weights, ScaleBiasType const* fc1_int_scales,
+        ScaleBiasType const* fc2_int_scales, QuantParams quant_params, int64_t const active_rows,
+        int64_t const hidden_size, int64_t const inter_size, int const num_experts, int const k,
+        OutputType* final_output, float* token_topk_unpermuted_scales, int* expanded_source_row_to_expanded_dest_row,
+        int* expert_for_source_row, float sparse_mixer_epsilon, MOEParallelismConfig parallelism_config,
+        MOEExpertScaleNormalizationMode normalization_mode, cudaStream_t stream);
 
 private:
     bool mayHaveDifferentGEMMOutputType() const
@@ -400,6 +510,9 @@ private:
         return moe_gemm_runner_.supportsHopperSpecialisation() && !use_deterministic_hopper_reduce_;
     }
 
+    // Records the start of the phases first to last into phase_events_, the ones before last are empty
+    void recordPhases(MoePhaseEvents::Phase first, MoePhaseEvents::Phase last, cudaStream_t stream) const;
+
     bool setupLoraWorkspace(int64_t expanded_num_rows, int64_t num_rows, int64_t inter_size, int64_t hidden_size,
         int start_expert, bool is_gated_activation, int num_experts_per_node, bool needs_num_valid,
         LoraParams& lora_params, cudaStream_t stream);
@@ -442,6 +555,22 @@ private:
 
     HopperGroupedGemmInput hopper_grouped_gemm_input_;
 
+    // All-to-all mode. The counts are indexed by [rank][expert of the rank], the blocks by [source rank][local expert]
+    int64_t* a2a_send_counts_{};
+    int64_t* a2a_recv_counts_{};
+    int64_t* a2a_expert_first_token_offset_{};
+    int64_t* a2a_source_major_starts_{};
+    int64_t* a2a_expert_major_starts_{};
+    void* a2a_rows_{};
+
+    struct HostAllToAllWorkspace
+    {
+        std::vector<int64_t> host_expert_first_token_offset;
+        std::vector<int64_t> host_recv_counts;
+    };
+
+    HostAllToAllWorkspace host_a2a_workspace_;
+
     struct HostLoraWorkspace
     {
         std::vector<int> host_permuted_rows;
@@ -21,6 +21,7 @@
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/reduceKernelUtils.cuh"
 #include "tensorrt_llm/kernels/penaltyKernels.h"
+#include "tensorrt_llm/kernels/penaltyTables.cuh"
 #include "tensorrt_llm/layers/defaultDecodingParams.h"
 
 using namespace tensorrt_llm::common;
@@ -36,14 +37,15 @@ __device__ bool almostEqual(float a, float b, float epsilon)
     return fabs(a - b) < epsilon;
 }
 
-template <typename T>
+//! UPDATE_ONLY_ only updates the occurrences of penaltyWorkspace and leaves the logits untouched.
+template <typename T, bool UPDATE_ONLY_>
 __global__ void batchApplyPenalty(T const* const* inputLogits, T* outputLogits, T const* biases,
-    TokenIdType* penaltyWorkspace, TokenIdType const* penaltyWorkspacePrev, float const* temperatures,
-    float const* repetitionPenalties, float const* presencePenalties, float const* frequencyPenalties,
-    SizeType32 maxSeqLen, SizeType32 vocabSize, SizeType32 vocabSizePadded, TokenIdType const** outputIdsPtr,
-    SizeType32 const** parentIdsPtr, SizeType32 const* inputLengths, SizeType32 const* sequenceLengths,
-    SizeType32 const* minLengths, TokenIdType const* endIds, SizeType32 const* batchSlots,
-    SizeType32 const* tokensPerStep)
+    TokenIdType* penaltyWorkspace, TokenIdType const* penaltyWorkspacePrev, SizeType32 penaltyTableSize,
+    float const* temperatures, float const* repetitionPenalties, float const* presencePenalties,
+    float const* frequencyPenalties, SizeType32 maxSeqLen, SizeType32 vocabSize, SizeType32 vocabSizePadded,
+    TokenIdType const** outputIdsPtr, SizeType32 const** parentIdsPtr, SizeType32 const* inputLengths,
+    SizeType32 const* sequenceLengths, SizeType32 const* minLengths, TokenIdType const* endIds,
+    SizeType32 const* batchSlots, SizeType32 const* tokensPerStep)
 {
     auto const beamWidth = static_cast<SizeType32>(gridDim.y);
     auto const maxTokensPerStep = static_cast<SizeType32>(gridDim.z);
@@ -98,16 +100,23 @@ __global__ void batchApplyPenalty(T const* const* inputLogits, T* outputLogits,
         hasMinLength |= (minLength > 0);
     }
 
-    // Initialize or update the number of occurrences of tokens
+    // Initialize or update the number of occurrences of tokens.
+    // Sparse tables only hold the tokens of the sequence, so they are cleared and updated in O(seqLen) per request.
+    bool const sparse = penaltyTableSize > 0;
+    auto const rowSize = sparse ? 2 * penaltyTableSize : vocabSize;
+    TokenIdType* tableKeys{nullptr};
+    TokenIdType* tableCounts{nullptr};
     if (accumulateVocab)
     {
-        penaltyWorkspace += batchBeamStepIdx * vocabSize;
+        penaltyWorkspace += batchBeamStepIdx * rowSize;
+        tableKeys = penaltyWorkspace;
+        tableCounts = penaltyWorkspace + penaltyTableSize;
         if (currentStep <= inputLen)
         { // Context phase
-            for (auto index = static_cast<SizeType32>(threadIdx.x); index < vocabSize;
+            for (auto index = static_cast<SizeType32>(threadIdx.x); index < rowSize;
                  index += static_cast<SizeType32>(blockDim.x))
             {
-                penaltyWorkspace[index] = 0;
+                penaltyWorkspace[index] = (sparse && index < penaltyTableSize) ? kEmptyPenaltyTableKey : 0;
             }
             __syncthreads();
             for (auto step = static_cast<SizeType32>(threadIdx.x); step < inputLen;
@@ -117,7 +126,14 @@ __global__ void batchApplyPenalty(T const* const* inputLogits, T* outputLogits,
                 auto penaltyIndex = outputIdsPtr[batchSlot][beamIdx * maxSeqLen + step];
                 if (penaltyIndex < vocabSize)
                 {
-                    atomicAdd(&penaltyWorkspace[penaltyIndex], 1);
+                    if (sparse)
+                    {
+                        countInPenaltyTable(tableKeys, tableCounts, penaltyTableSize, penaltyIndex);
+                    }
+                    else
+                    {
+                        atomicAdd(&penaltyWorkspace[penaltyIndex], 1);
+                    }
                 }
             }
         }
@@ -126,8 +142,8 @@ __global__ void batchApplyPenalty(T const* const* inputLogits, T* outputLogits,
             if (beamWidth > 1)
             {
                 auto parentBeam = parentIdsPtr[batchSlot][beamIdx * maxSeqLen + currentStep - 1];
-                penaltyWorkspacePrev += ((batchIdx * beamWidth + parentBeam) * maxTokensPerStep + stepIdx) * vocabSize;
-                for (auto index = static_cast<SizeType32>(threadIdx.x); index < vocabSize;
+                penaltyWorkspacePrev += ((batchIdx * beamWidth + parentBeam) * maxTokensPerStep + stepIdx) * rowSize;
+                for (auto index = static_cast<SizeType32>(threadIdx.x); index < rowSize;
                      index += static_cast<SizeType32>(blockDim.x))
                 {
                     penaltyWorkspace[index] = penaltyWorkspacePrev[index];
@@ -139,12 +155,23 @@ __global__ void batchApplyPenalty(T const* const* inputLogits, T* outputLogits,
                 auto penaltyIndex = outputIdsPtr[batchSlot][beamIdx * maxSeqLen + currentStep - 1];
                 if (penaltyIndex < vocabSize)
                 {
-                    penaltyWorkspace[penaltyIndex] += 1;
+                    if (sparse)
+                    {
+                        countInPenaltyTable(tableKeys, tableCounts, penaltyTableSize, penaltyIndex);
+                    }
+                    else
+                    {
+                        penaltyWorkspace[penaltyIndex] += 1;
+                    }
                 }
             }
         }
         __syncthreads();
     }
+    if (UPDATE_ONLY_)
+    {
+        return;
+    }
 
     // Apply bias and penalties
     auto const inLogitsPtr = inputLogits[batchIdx] + (beamIdx * maxTokensPerStep + stepIdx) * vocabSizePadded;
@@ -166,27 +193,10 @@ __global__ void batchApplyPenalty(T const* const* inputLogits, T* outputLogits,
             {
                 logit *= invTemperature;
             }
-            if (accumulateVocab)
+            if (accumulateVocab && !sparse)
             {
-                SizeType32 numOccurences = penaltyWorkspace[index];
-                if (numOccurences > 0)
-                {
-                    // Repetition
-                    if (repetitionPenalties != nullptr)
-                    {
-                        logit = logit < 0.0f ? logit * repetitionPenalty : logit / repetitionPenalty;
-                    }
-                    // Presence
-                    if (presencePenalties != nullptr)
-                    {
-                        logit -= presencePenalty;
-                    }
-                    // Frequency
-                    if (frequencyPenalties != nullptr)
-                    {
-                        logit -= frequencyPenalty * numOccurences;
-                    }
-                }
+                logit = applyOccurrencePenalties(logit, penaltyWorkspace[index], repetitionPenalties,
+                    repetitionPenalty, presencePenalties, presencePenalty, frequencyPenalties, frequencyPenalty);
             }
             // do clamp to prevent overflow
             if (logit > static_cast<float>(-MASK_VAL))
@@ -204,6 +214,32 @@ __global__ void batchApplyPenalty(T const* const* inputLogits, T* outputLogits,
             outLogitsPtr[index] = MASK_VAL;
         }
     }
+    if (accumulateVocab && sparse)
+    {
+        // Penalize only the logits of tokens which occurred, recomputing them from the input logits
+        __syncthreads();
+        for (auto slot = static_cast<SizeType32>(threadIdx.x); slot < penaltyTableSize;
+             slot += static_cast<SizeType32>(blockDim.x))
+        {
+            auto const index = tableKeys[slot];
+            if (index == kEmptyPenaltyTableKey)
+            {
+                continue;
+            }
+            auto logit = static_cast<float>(inLogitsPtr[index]);
+            if (biases != nullptr)
+            {
+                logit += static_cast<float>(biasBase[index]);
+            }
+            if (hasTemperature)
+            {
+                logit *= invTemperature;
+            }
+            logit = applyOccurrencePenalties(logit, tableCounts[slot], repetitionPenalties, repetitionPenalty,
+                presencePenalties, presencePenalty, frequencyPenalties, frequencyPenalty);
+            outLogitsPtr[index] = fminf(fmaxf(logit, static_cast<float>(MASK_VAL)), static_cast<float>(-MASK_VAL));
+        }
+    }
     if (hasMinLength)
     {
         __syncthreads();
@@ -221,16 +257,46 @@ void invokeBatchApplyPenalty(InvokeBatchApplyPenaltyParams<T> const& params)
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
     dim3 block(512);
     dim3 grid(params.batchSize, params.beamWidth, params.maxTokensPerStep);
-    batchApplyPenalty<T><<<grid, block, 0, params.stream>>>(params.inputLogits, params.outputLogits, params.biases,
-        params.penaltyWorkspace, params.penaltyWorkspacePrev, params.temperatures, params.repetitionPenalties,
-        params.presencePenalties, params.frequencyPenalties, params.maxSeqLen, params.vocabSize, params.vocabSizePadded,
-        params.outputIdsPtr, params.parentIdsPtr, params.inputLengths, params.sequenceLengths, params.minLengths,
-        params.endIds, params.batchSlots, params.tokensPerStep);
+    batchApplyPenalty<T, false><<<grid, block, 0, params.stream>>>(params.inputLogits, params.outputLogits,
+        params.biases, params.penaltyWorkspace, params.penaltyWorkspacePrev, params.penaltyTableSize,
+        params.temperatures, params.repetitionPenalties, params.presencePenalties, params.frequencyPenalties,
+        params.maxSeqLen, params.vocabSize, params.vocabSizePadded, params.outputIdsPtr, params.parentIdsPtr,
+        params.inputLengths, params.sequenceLengths, params.minLengths, params.endIds, params.batchSlots,
+        params.tokensPerStep);
 }
 
 template void invokeBatchApplyPenalty(InvokeBatchApplyPenaltyParams<float> const& params);
 
 template void invokeBatchApplyPenalty(InvokeBatchApplyPenaltyParams<half> const& params);
 
+template <typename T>
+void invokeBatchUpdatePenaltyOccurrences(InvokeBatchApplyPenaltyParams<T> const& params)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    dim3 block(256);
+    dim3 grid(params.batchSize, params.beamWidth, params.maxTokensPerStep);
+    batchApplyPenalty<T, true><<<grid, block, 0, params.stream>>>(params.inputLogits, params.outputLogits,
+        params.biases, params.penaltyWorkspace, params.penaltyWorkspacePrev, params.penaltyTableSize,
+        params.temperatures, params.repetitionPenalties, params.presencePenalties, params.frequencyPenalties,
+        params.maxSeqLen, params.vocabSize, params.vocabSizePadded, params.outputIdsPtr, params.parentIdsPtr,
+        params.inputLengths, params.sequenceLengths, params.minLengths, params.endIds, params.batchSlots,
+        params.tokensPerStep);
+}
+
+template void invokeBatchUpdatePenaltyOccurrences(InvokeBatchApplyPenaltyParams<float> const& params);
+
+template void invokeBatchUpdatePenaltyOccurrences(InvokeBatchApplyPenaltyParams<half> const& params);
+
+SizeType32 getPenaltyTableSize(SizeType32 maxSeqLen, SizeType32 vocabSize)
+{
+    // Keep the load factor of the tables at most 1/2
+    SizeType32 tableSize{1};
+    while (tableSize < 2 * maxSeqLen)
+    {
+        tableSize *= 2;
+    }
+    return 2 * tableSize < vocabSize ? tableSize : 0;
+}
+
 } // namespace kernels
 } // namespace tensorrt_llm
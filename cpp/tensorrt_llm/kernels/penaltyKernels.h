@@ -53,10 +53,30 @@ struct InvokeBatchApplyPenaltyParams
     runtime::SizeType32 maxTokensPerStep;
     runtime::SizeType32 const* tokensPerStep;
     cudaStream_t stream;
+    //! Number of entries of the per-request (token, count) hash tables, a power of 2. 0 counts occurrences in dense
+    //! [vocabSize] rows of penaltyWorkspace. Otherwise each row holds tableSize keys followed by tableSize counts and
+    //! only the logits of tokens in the table are penalized.
+    runtime::SizeType32 penaltyTableSize{0};
 };
 
 template <typename T>
 void invokeBatchApplyPenalty(InvokeBatchApplyPenaltyParams<T> const& params);
 
+//! \brief Only update the token occurrences in params.penaltyWorkspace, for samplers that apply the penalties while
+//! reading the logits (invokeFusedSampling). The logits are neither read nor written.
+template <typename T>
+void invokeBatchUpdatePenaltyOccurrences(InvokeBatchApplyPenaltyParams<T> const& params);
+
+//! @returns size of the occurrence hash tables for sequences of up to maxSeqLen tokens, 0 if dense rows of vocabSize
+//! counts are smaller
+runtime::SizeType32 getPenaltyTableSize(runtime::SizeType32 maxSeqLen, runtime::SizeType32 vocabSize);
+
+//! @returns number of TokenIdType entries per row of the penalty workspace
+inline runtime::SizeType32 getPenaltyWorkspaceRowSize(
+    runtime::SizeType32 penaltyTableSize, runtime::SizeType32 vocabSize)
+{
+    return penaltyTableSize > 0 ? 2 * penaltyTableSize : vocabSize;
+}
+
 } // namespace kernels
 } // namespace tensorrt_llm
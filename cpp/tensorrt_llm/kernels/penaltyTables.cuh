@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+
+namespace tensorrt_llm::kernels
+{
+
+//! Marks a free entry of a penalty occurrence table
+runtime::TokenIdType constexpr kEmptyPenaltyTableKey{-1};
+
+__device__ __forceinline__ std::uint32_t getPenaltyTableSlot(runtime::TokenIdType token, runtime::SizeType32 tableSize)
+{
+    return (static_cast<std::uint32_t>(token) * 2654435761U) & static_cast<std::uint32_t>(tableSize - 1);
+}
+
+//! \brief Count one occurrence of token in an open addressing (token, count) table with tableSize entries.
+//! The table is sized to never fill up, see getPenaltyTableSize.
+__device__ __forceinline__ void countInPenaltyTable(runtime::TokenIdType* keys, runtime::TokenIdType* counts,
+    runtime::SizeType32 tableSize, runtime::TokenIdType token)
+{
+    auto const mask = static_cast<std::uint32_t>(tableSize - 1);
+    auto slot = getPenaltyTableSlot(token, tableSize);
+    while (true)
+    {
+        auto const key = atomicCAS(&keys[slot], kEmptyPenaltyTableKey, token);
+        if (key == kEmptyPenaltyTableKey || key == token)
+        {
+            atomicAdd(&counts[slot], 1);
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+//! @returns number of occurrences of token in the table
+__device__ __forceinline__ runtime::SizeType32 findInPenaltyTable(runtime::TokenIdType const* keys,
+    runtime::TokenIdType const* counts, runtime::SizeType32 tableSize, runtime::TokenIdType token)
+{
+    auto const mask = static_cast<std::uint32_t>(tableSize - 1);
+    auto slot = getPenaltyTableSlot(token, tableSize);
+    while (true)
+    {
+        auto const key = keys[slot];
+        if (key == token)
+        {
+            return counts[slot];
+        }
+        if (key == kEmptyPenaltyTableKey)
+        {
+            return 0;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+__device__ __forceinline__ float applyOccurrencePenalties(float logit, runtime::SizeType32 numOccurences,
+    float const* repetitionPenalties, float repetitionPenalty, float const* presencePenalties, float presencePenalty,
+    float const* frequencyPenalties, float frequencyPenalty)
+{
+    if (numOccurences > 0)
+    {
+        // Repetition
+        if (repetitionPenalties != nullptr)
+        {
+            logit = logit < 0.0f ? logit * repetitionPenalty : logit / repetitionPenalty;
+        }
+        // Presence
+        if (presencePenalties != nullptr)
+        {
+            logit -= presencePenalty;
+        }
+        // Frequency
+        if (frequencyPenalties != nullptr)
+        {
+            logit -= frequencyPenalty * numOccurences;
+        }
+    }
+    return logit;
+}
+
+} // namespace tensorrt_llm::kernels
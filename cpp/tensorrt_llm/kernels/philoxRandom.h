@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm::kernels
+{
+
+//! \brief Random state of a batch slot for the counter-based Philox4x32-10 generator.
+//! \details The numbers are a pure function of (seed, step, position), so setting up a slot is writing its seed, a
+//! slot samples the same numbers whichever slots it shares the batch with, and the positions of a step, e.g. the
+//! draft tokens of speculative decoding, get independent streams without a state of their own. At 16 bytes, the
+//! state is also a third of a curandState_t to load and store on every sampling call.
+struct RandomState
+{
+    //! The seed of the request in the slot
+    std::uint64_t seed;
+    //! Number of steps the slot drew numbers for
+    std::uint64_t step;
+};
+
+namespace philox
+{
+
+std::uint32_t constexpr kM0 = 0xD2511F53;
+std::uint32_t constexpr kM1 = 0xCD9E8D57;
+std::uint32_t constexpr kW0 = 0x9E3779B9;
+std::uint32_t constexpr kW1 = 0xBB67AE85;
+
+__host__ __device__ inline std::uint32_t mulhilo(std::uint32_t a, std::uint32_t b, std::uint32_t& hi)
+{
+#if defined(__CUDA_ARCH__)
+    hi = __umulhi(a, b);
+    return a * b;
+#else
+    auto const product = static_cast<std::uint64_t>(a) * b;
+    hi = static_cast<std::uint32_t>(product >> 32);
+    return static_cast<std::uint32_t>(product);
+#endif
+}
+
+} // namespace philox
+
+//! \brief The Philox4x32-10 block of counter under key.
+__host__ __device__ inline uint4 philox4x32(uint4 counter, uint2 key)
+{
+#pragma unroll
+    for (int round = 0; round < 10; ++round)
+    {
+        std::uint32_t hi0;
+        std::uint32_t hi1;
+        auto const lo0 = philox::mulhilo(philox::kM0, counter.x, hi0);
+        auto const lo1 = philox::mulhilo(philox::kM1, counter.z, hi1);
+        counter = make_uint4(hi1 ^ counter.y ^ key.x, lo1, hi0 ^ counter.w ^ key.y, lo0);
+        key.x += philox::kW0;
+        key.y += philox::kW1;
+    }
+    return counter;
+}
+
+//! \brief 32 random bits for the current step of the slot at position, without advancing it.
+__host__ __device__ inline std::uint32_t randomBits(RandomState const& state, std::uint32_t position = 0)
+{
+    auto const counter = make_uint4(static_cast<std::uint32_t>(state.step),
+        static_cast<std::uint32_t>(state.step >> 32), position, 0);
+    auto const key = make_uint2(static_cast<std::uint32_t>(state.seed), static_cast<std::uint32_t>(state.seed >> 32));
+    return philox4x32(counter, key).x;
+}
+
+//! \brief A uniform number in (0, 1] for the current step of the slot at position, without advancing it.
+__host__ __device__ inline float randomUniform(RandomState const& state, std::uint32_t position = 0)
+{
+    // 24 bits, exactly representable, and 0 excluded like curand_uniform
+    return static_cast<float>((randomBits(state, position) >> 8) + 1) * (1.F / 16777216.F);
+}
+
+//! \brief A uniform number in (0, 1] at position 0 of the current step, then advance the slot to the next step.
+__host__ __device__ inline float randomUniform(RandomState* state)
+{
+    auto const value = randomUniform(*state);
+    ++state->step;
+    return value;
+}
+
+//! \brief 32 random bits at position 0 of the current step, then advance the slot to the next step.
+__host__ __device__ inline std::uint32_t randomBits(RandomState* state)
+{
+    auto const value = randomBits(*state);
+    ++state->step;
+    return value;
+}
+
+} // namespace tensorrt_llm::kernels
@@ -321,6 +321,65 @@ void invokePerTokenQuantization(QuantT* dst, T const* src, const int64_t numRows
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// One warp per (row, group). The scales are bounded below like the fp8 rowwise ones.
+template <typename T, typename QuantT>
+__global__ void perTokenGroupQuantization(
+    QuantT* dst, T const* src, const int64_t numGroups, int const groupSize, float* scalePtr)
+{
+    static constexpr float MAX_QUANT_VAL = QuantTypeStaticVals<QuantT>::MAX_VAL;
+    static constexpr float MIN_SCALING_FACTOR = QuantTypeStaticVals<QuantT>::MIN_SCALING_FACTOR;
+    static constexpr float MIN_SCALING_FACTOR_RCP = QuantTypeStaticVals<QuantT>::MIN_SCALING_FACTOR_RCP;
+
+    const int64_t groupIdx = static_cast<int64_t>(blockIdx.x) * (blockDim.x / 32) + threadIdx.x / 32;
+    if (groupIdx >= numGroups)
+    {
+        return;
+    }
+    int const lane = threadIdx.x % 32;
+    // The groups of a row are contiguous, so the group index is also the offset of the group in units of groupSize.
+    T const* srcGroup = src + groupIdx * groupSize;
+    QuantT* dstGroup = dst + groupIdx * groupSize;
+
+    float localMax = 1e-6f;
+    for (int i = lane; i < groupSize; i += 32)
+    {
+        localMax = fmaxf(localMax, fabsf(cuda_cast<float>(srcGroup[i])));
+    }
+    float const groupMax = warpReduceMax(localMax);
+
+    if (lane == 0)
+    {
+        scalePtr[groupIdx] = cuda_max(groupMax / MAX_QUANT_VAL, MIN_SCALING_FACTOR);
+    }
+    float const scaleOrigQuant = fminf(MAX_QUANT_VAL / groupMax, MIN_SCALING_FACTOR_RCP);
+    for (int i = lane; i < groupSize; i += 32)
+    {
+        dstGroup[i] = cuda_cast<QuantT>(cuda_cast<float>(srcGroup[i]) * scaleOrigQuant);
+    }
+}
+
+template <typename T, typename QuantT>
+void invokePerTokenGroupQuantization(QuantT* dst, T const* src, const int64_t numRows, const int64_t numCols,
+    int const groupSize, float* scalePtr, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(groupSize > 0 && groupSize % 32 == 0, "The group size (%d) must be a multiple of 32.",
+        groupSize);
+    TLLM_CHECK_WITH_INFO(numCols % groupSize == 0, "The number of columns (%ld) must be a multiple of the group size.",
+        numCols);
+    const int64_t numGroups = numRows * (numCols / groupSize);
+    if (numGroups == 0)
+    {
+        return;
+    }
+    int constexpr kWarpsPerBlock = 8;
+    const dim3 block(kWarpsPerBlock * 32);
+    const dim3 grid((numGroups + kWarpsPerBlock - 1) / kWarpsPerBlock);
+    perTokenGroupQuantization<T, QuantT><<<grid, block, 0, stream>>>(dst, src, numGroups, groupSize, scalePtr);
+    sync_check_cuda_error();
+}
+
 #define INSTANTIATE_INVOKE_PER_TOKEN_QUANTIZATION(T, QuantT)                                                           \
     template void invokePerTokenQuantization(QuantT* dst, const T* src, const int64_t numRows, const int64_t numCols,  \
         float const* clampPtr, float* scalePtr, QuantMode quantMode, cudaStream_t stream)
@@ -339,5 +398,23 @@ INSTANTIATE_INVOKE_PER_TOKEN_QUANTIZATION(__nv_bfloat16, __nv_fp8_e4m3);
 #endif
 #endif
 
+#define INSTANTIATE_INVOKE_PER_TOKEN_GROUP_QUANTIZATION(T, QuantT)                                                     \
+    template void invokePerTokenGroupQuantization(QuantT* dst, const T* src, const int64_t numRows,                    \
+        const int64_t numCols, int const groupSize, float* scalePtr, cudaStream_t stream)
+
+INSTANTIATE_INVOKE_PER_TOKEN_GROUP_QUANTIZATION(float, int8_t);
+INSTANTIATE_INVOKE_PER_TOKEN_GROUP_QUANTIZATION(half, int8_t);
+#ifdef ENABLE_BF16
+INSTANTIATE_INVOKE_PER_TOKEN_GROUP_QUANTIZATION(__nv_bfloat16, int8_t);
+#endif
+
+#ifdef ENABLE_FP8
+INSTANTIATE_INVOKE_PER_TOKEN_GROUP_QUANTIZATION(float, __nv_fp8_e4m3);
+INSTANTIATE_INVOKE_PER_TOKEN_GROUP_QUANTIZATION(half, __nv_fp8_e4m3);
+#ifdef ENABLE_BF16
+INSTANTIATE_INVOKE_PER_TOKEN_GROUP_QUANTIZATION(__nv_bfloat16, __nv_fp8_e4m3);
+#endif
+#endif
+
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -32,5 +32,12 @@ template <typename T, typename QuantT>
 void invokePerTokenQuantization(QuantT* dst, T const* src, const int64_t numRows, const int64_t numCols,
     float const* clampPtr, float* scalePtr, tensorrt_llm::common::QuantMode quantMode, cudaStream_t stream = 0);
 
+// Quantize every group of groupSize consecutive columns of a row with its own scale. scalePtr is
+// [numRows, numCols / groupSize]; with fp8 and groups of 128 these are the activation scales of the block-scaled fp8
+// GEMM.
+template <typename T, typename QuantT>
+void invokePerTokenGroupQuantization(QuantT* dst, T const* src, const int64_t numRows, const int64_t numCols,
+    int const groupSize, float* scalePtr, cudaStream_t stream = 0);
+
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -27,16 +27,34 @@ namespace kernels
 {
 
 template <typename Tf, typename T>
-__inline__ __device__ Tf compute_rmsnorm(Tf val, float s_variance, T const* gamma, T const* beta, int i)
+__inline__ __device__ Tf compute_rmsnorm(
+    Tf val, float s_variance, T const* gamma, T const* beta, T const* pre_quant_scale, int i)
 {
     Tf ret = val * s_variance * cuda_cast<Tf>(gamma[i]);
     if (beta != nullptr)
     {
         ret = ret + cuda_cast<Tf>(beta[i]);
     }
+    if (pre_quant_scale != nullptr)
+    {
+        ret = ret * cuda_cast<Tf>(pre_quant_scale[i]);
+    }
     return ret;
 }
 
+// The input of the norm, with the residual added in the precision of the residual stream, as the separate add did.
+template <typename T>
+__inline__ __device__ T load_rmsnorm_input(T const* input, T const* residual, int index)
+{
+    using float_packed_t = typename packed_as<float, num_elems<T>::value>::type;
+    T val = input[index];
+    if (residual != nullptr)
+    {
+        val = cuda_cast<T>(cuda_cast<float_packed_t>(val) + cuda_cast<float_packed_t>(residual[index]));
+    }
+    return val;
+}
+
 /* Computes the rmsnorm https://pytorch.org/docs/stable/generated/torch.nn.rmsnorm.html
  * normed_output <- ( input / Sqrt(E[input²] + eps) ) * gamma + beta
  * input is [tokens, hidden_dim]. Mean and Variance are per-row (i.e. per-token)
@@ -49,11 +67,17 @@ __inline__ __device__ Tf compute_rmsnorm(Tf val, float s_variance, T const* gamm
  * Optional: with dynamic scaling, the last pass doesn't write immediately but finds the
  *           amax per row. A final pass scales to int8 accordingly, and writes output to
  *           normed_output_quant.
+ *
+ * Optional: with a residual, the norm applies to input + residual and the sum is written to residual_out, the
+ *           residual of the next layer. With a pre-quant scale, the normed output is scaled per channel, as the
+ *           activation scaling of SmoothQuant and AWQ, before quantization. Fusing both saves the activation round
+ *           trips of a separate add and scaling kernel.
  */
 template <typename T, typename QuantT, bool USE_SHMEM>
 __global__ void generalRmsNorm(T const* input, T const* gamma, T const* beta, T* normed_output, float const eps,
     int tokens, int hidden_dim, float const* clampPtr, float const* scale_orig_quant_per_tensor,
-    float* scale_orig_quant_per_token, QuantT* normed_output_quant, bool hasFp8MinScaling)
+    float* scale_orig_quant_per_token, QuantT* normed_output_quant, bool hasFp8MinScaling, T const* residual,
+    T* residual_out, T const* pre_quant_scale)
 {
     constexpr auto num_elems_T = num_elems<T>::value;
     // using int8_packed_t = typename packed_as<int8_t, num_elems_T>::type;
@@ -86,11 +110,15 @@ __global__ void generalRmsNorm(T const* input, T const* gamma, T const* beta, T*
     int const n_elems = hidden_dim / num_elems_T;
     for (int i = tidx; i < n_elems; i += blockDim.x)
     {
-        const T val = input[bidx * n_elems + i];
+        const T val = load_rmsnorm_input(input, residual, bidx * n_elems + i);
         if (USE_SHMEM)
         {
             shmem[i] = val;
         }
+        if (residual_out != nullptr)
+        {
+            residual_out[bidx * n_elems + i] = val;
+        }
 
         const float_packed_t val_f = cuda_cast<float_packed_t>(val);
 
@@ -108,6 +136,10 @@ __global__ void generalRmsNorm(T const* input, T const* gamma, T const* beta, T*
     }
     __syncthreads();
 
+    // Without the shared memory cache, later passes read the sum back, which also works when residual_out is input
+    T const* reload_input = residual_out != nullptr ? residual_out : input;
+    T const* reload_residual = residual_out != nullptr ? nullptr : residual;
+
     bool const with_per_token_scaling = scale_orig_quant_per_token != nullptr;
     bool const with_per_tensor_scaling = scale_orig_quant_per_tensor != nullptr;
     const float_packed_t scale_orig_quant
@@ -117,8 +149,9 @@ __global__ void generalRmsNorm(T const* input, T const* gamma, T const* beta, T*
     for (int i = tidx; i < n_elems; i += blockDim.x)
     {
         int const index = bidx * n_elems + i;
-        const float_packed_t val_f = cuda_cast<float_packed_t>(USE_SHMEM ? shmem[i] : input[index]);
-        T val = cuda_cast<T>(compute_rmsnorm(val_f, s_variance, gamma, beta, i));
+        const T val_in = USE_SHMEM ? shmem[i] : load_rmsnorm_input(reload_input, reload_residual, index);
+        const float_packed_t val_f = cuda_cast<float_packed_t>(val_in);
+        T val = cuda_cast<T>(compute_rmsnorm(val_f, s_variance, gamma, beta, pre_quant_scale, i));
 
         if (with_per_token_scaling)
         {
@@ -149,10 +182,11 @@ __global__ void generalRmsNorm(T const* input, T const* gamma, T const* beta, T*
         for (int i = tidx; i < n_elems; i += blockDim.x)
         {
             int const index = bidx * n_elems + i;
-            float_packed_t val_f = cuda_cast<float_packed_t>(USE_SHMEM ? shmem[i] : input[index]);
+            const T val_in = USE_SHMEM ? shmem[i] : load_rmsnorm_input(reload_input, reload_residual, index);
+            float_packed_t val_f = cuda_cast<float_packed_t>(val_in);
             if (!USE_SHMEM)
             {
-                val_f = compute_rmsnorm(val_f, s_variance, gamma, beta, i);
+                val_f = compute_rmsnorm(val_f, s_variance, gamma, beta, pre_quant_scale, i);
             }
 
             reinterpret_cast<QuantT_packed_t*>(normed_output_quant)[index]
@@ -170,8 +204,9 @@ __global__ void generalRmsNorm(T const* input, T const* gamma, T const* beta, T*
 template <typename T, typename QuantT>
 void dispatch_rmsnorm_type_square_method(T const* input, T const* gamma, T const* beta, T* normed_output,
     float const eps, int tokens, int hidden_dim, float const* clampPtr, float const* scale_orig_quant_per_tensor,
-    float* scale_orig_quant_per_token, QuantT* normed_output_quant, bool const hasFp8MinScaling, const dim3 grid,
-    const dim3 block, const size_t shmem_size, cudaStream_t stream)
+    float* scale_orig_quant_per_token, QuantT* normed_output_quant, bool const hasFp8MinScaling, T const* residual,
+    T* residual_out, T const* pre_quant_scale, const dim3 grid, const dim3 block, const size_t shmem_size,
+    cudaStream_t stream)
 {
     // Do we use shared memory to cache intermediate results.
     bool use_shmem = true;
@@ -187,31 +222,31 @@ void dispatch_rmsnorm_type_square_method(T const* input, T const* gamma, T const
     {
         generalRmsNorm<T, QuantT, true><<<grid, block, shmem_size, stream>>>(input, gamma, beta, normed_output, eps,
             tokens, hidden_dim, clampPtr, scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant,
-            hasFp8MinScaling);
+            hasFp8MinScaling, residual, residual_out, pre_quant_scale);
     }
     else
     {
         generalRmsNorm<T, QuantT, false><<<grid, block, shmem_size, stream>>>(input, gamma, beta, normed_output, eps,
             tokens, hidden_dim, clampPtr, scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant,
-            hasFp8MinScaling);
+            hasFp8MinScaling, residual, residual_out, pre_quant_scale);
     }
 }
 
 template <typename T, typename QuantT>
 void dispatch_rmsnorm_type(T const* input, T const* gamma, T const* beta, T* normed_output, float const eps, int tokens,
     int hidden_dim, float const* clampPtr, float const* scale_orig_quant_per_tensor, float* scale_orig_quant_per_token,
-    QuantT* normed_output_quant, bool const hasFp8MinScaling, const dim3 grid, const dim3 block,
-    const size_t shmem_size, cudaStream_t stream)
+    QuantT* normed_output_quant, bool const hasFp8MinScaling, T const* residual, T* residual_out,
+    T const* pre_quant_scale, const dim3 grid, const dim3 block, const size_t shmem_size, cudaStream_t stream)
 {
     dispatch_rmsnorm_type_square_method(input, gamma, beta, normed_output, eps, tokens, hidden_dim, clampPtr,
-        scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, hasFp8MinScaling, grid, block,
-        shmem_size, stream);
+        scale_orig_quant_per_tensor, scale_orig_quant_per_token, normed_output_quant, hasFp8MinScaling, residual,
+        residual_out, pre_quant_scale, grid, block, shmem_size, stream);
 }
 
 template <typename T, typename QuantT>
 void invokeGeneralRmsNorm(T* out, T const* input, T const* gamma, T const* beta, float const eps, int const tokens,
     int const hidden_dim, QuantMode quantMode, cudaStream_t stream, float const* clampPtr, float const* scale,
-    float* dynamic_scale, QuantT* normed_output_quant)
+    float* dynamic_scale, QuantT* normed_output_quant, T const* residual, T* residual_out, T const* pre_quant_scale)
 {
     dim3 grid(tokens);
     dim3 block(min(hidden_dim, 1024));
@@ -235,19 +270,23 @@ void invokeGeneralRmsNorm(T* out, T const* input, T const* gamma, T const* beta,
         using Tp = typename packed_as<T, vec_size>::type;
         dispatch_rmsnorm_type(reinterpret_cast<Tp const*>(input), reinterpret_cast<Tp const*>(gamma),
             reinterpret_cast<Tp const*>(beta), reinterpret_cast<Tp*>(out), eps, tokens, hidden_dim, clampPtr, scale,
-            dynamic_scale, normed_output_quant, hasFp8MinScaling, grid, block, shmem_size, stream);
+            dynamic_scale, normed_output_quant, hasFp8MinScaling, reinterpret_cast<Tp const*>(residual),
+            reinterpret_cast<Tp*>(residual_out), reinterpret_cast<Tp const*>(pre_quant_scale), grid, block,
+            shmem_size, stream);
     }
     else
     {
         dispatch_rmsnorm_type(input, gamma, beta, out, eps, tokens, hidden_dim, clampPtr, scale, dynamic_scale,
-            normed_output_quant, hasFp8MinScaling, grid, block, shmem_size, stream);
+            normed_output_quant, hasFp8MinScaling, residual, residual_out, pre_quant_scale, grid, block, shmem_size,
+            stream);
     }
 }
 
 #define INSTANTIATE_GENERAL_RMSNORM(T, QuantT)                                                                         \
     template void invokeGeneralRmsNorm(T* out, const T* input, const T* gamma, const T* beta, const float eps,         \
         const int tokens, const int hidden_dim, QuantMode quantMode, cudaStream_t stream, float const* clampPtr,       \
-        const float* scale, float* dynamic_scale, QuantT* normed_output_quant);
+        const float* scale, float* dynamic_scale, QuantT* normed_output_quant, T const* residual, T* residual_out,     \
+        T const* pre_quant_scale);
 
 INSTANTIATE_GENERAL_RMSNORM(float, int8_t);
 INSTANTIATE_GENERAL_RMSNORM(half, int8_t);
@@ -27,11 +27,14 @@ namespace tensorrt_llm
 namespace kernels
 {
 
+//! With residual, normalizes input + residual and writes the sum to residual_out if set. With pre_quant_scale
+//! [hidden_dim], scales the normed output per channel before it is quantized or written.
 template <typename T, typename QuantT>
 void invokeGeneralRmsNorm(T* out, T const* input, T const* gamma, T const* beta, float const eps, int const tokens,
     int const hidden_dim, tensorrt_llm::common::QuantMode quantMode, cudaStream_t stream = 0,
     float const* clampPtr = nullptr, float const* scale = nullptr, float* dynamic_scale = nullptr,
-    QuantT* out_quant = nullptr);
+    QuantT* out_quant = nullptr, T const* residual = nullptr, T* residual_out = nullptr,
+    T const* pre_quant_scale = nullptr);
 
 } // namespace kernels
 } // namespace tensorrt_llm
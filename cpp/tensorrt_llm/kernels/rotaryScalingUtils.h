@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+// Per-request long context RoPE scaling. The frequencies of a request are chosen from its current kv length by
+// invokeBuildDecoderInfo, the attention kernels compute the cos/sin from them on the fly and multiply both by the
+// magnitude scale (mscale) of the request.
+
+// The YaRN defaults: dims rotating more than kYarnBetaFast times within the original context are extrapolated,
+// dims rotating less than kYarnBetaSlow times are interpolated and the dims in between are blended.
+static constexpr float kYarnBetaFast = 32.f;
+static constexpr float kYarnBetaSlow = 1.f;
+
+// The scale a sequence of seqLen tokens needs: 1 within the original context, seqLen / originalMaxPositions past it,
+// clamped to maxScale.
+__host__ __device__ inline float getDynamicRotaryScale(int seqLen, int originalMaxPositions, float maxScale)
+{
+    if (originalMaxPositions <= 0 || seqLen <= originalMaxPositions)
+    {
+        return 1.f;
+    }
+    return fminf(static_cast<float>(seqLen) / originalMaxPositions, fmaxf(maxScale, 1.f));
+}
+
+// The (fractional) dim index whose wavelength fits numRotations times in the original context.
+__host__ __device__ inline float getYarnCorrectionDim(
+    float numRotations, int rotaryDim, float base, int originalMaxPositions)
+{
+    constexpr float kTwoPi = 6.283185307179586f;
+    return rotaryDim * logf(originalMaxPositions / (numRotations * kTwoPi)) / (2.f * logf(base));
+}
+
+// The inverse frequency of the rotary pair pairIdx in [0, rotaryDim / 2) with YaRN scaling.
+__host__ __device__ inline float getYarnInvFreq(
+    int pairIdx, int rotaryDim, float base, float scale, int originalMaxPositions)
+{
+    float const extrapolated = 1.f / powf(base, 2 * pairIdx / static_cast<float>(rotaryDim));
+    if (scale <= 1.f)
+    {
+        return extrapolated;
+    }
+    float const low
+        = fmaxf(floorf(getYarnCorrectionDim(kYarnBetaFast, rotaryDim, base, originalMaxPositions)), 0.f);
+    float high = fminf(
+        ceilf(getYarnCorrectionDim(kYarnBetaSlow, rotaryDim, base, originalMaxPositions)), rotaryDim - 1.f);
+    if (high <= low)
+    {
+        high = low + 0.001f;
+    }
+    float const ramp = fminf(fmaxf((pairIdx - low) / (high - low), 0.f), 1.f);
+    // The high frequency dims (ramp = 0) are extrapolated, the low frequency ones (ramp = 1) are interpolated.
+    return extrapolated * (1.f - ramp) + extrapolated / scale * ramp;
+}
+
+// The YaRN attention temperature, applied to both q and k through the cos/sin.
+__host__ __device__ inline float getYarnMscale(float scale)
+{
+    return scale <= 1.f ? 1.f : 0.1f * logf(scale) + 1.f;
+}
+
+} // namespace kernels
+} // namespace tensorrt_llm
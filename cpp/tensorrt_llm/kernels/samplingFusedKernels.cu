@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CUDART_VERSION
+#error CUDART_VERSION Undefined!
+#elif (CUDART_VERSION >= 11050)
+#include <cub/cub.cuh>
+#else
+#include "3rdparty/cub/cub.cuh"
+#endif
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/reduceKernelUtils.cuh"
+#include "tensorrt_llm/kernels/penaltyTables.cuh"
+#include "tensorrt_llm/kernels/samplingFusedKernels.h"
+#include "tensorrt_llm/layers/defaultDecodingParams.h"
+
+#include <float.h>
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+namespace tensorrt_llm::kernels
+{
+
+namespace
+{
+//! Number of logits of a request processed by one block of the first stage, kept in shared memory
+SizeType32 constexpr kSegmentSize = 4096;
+SizeType32 constexpr kStage1BlockSize = 256;
+SizeType32 constexpr kStage2BlockSize = 128;
+
+//! Running maximum and sum of exp(logit - max) of a set of logits
+struct SoftMaxPartial
+{
+    float max;
+    float sum;
+};
+
+__device__ __forceinline__ SoftMaxPartial mergeSoftMaxPartials(SoftMaxPartial const& a, SoftMaxPartial const& b)
+{
+    auto const max = fmaxf(a.max, b.max);
+    return {max, a.sum * __expf(a.max - max) + b.sum * __expf(b.max - max)};
+}
+
+__device__ __forceinline__ bool isDefault(float value, float defaultValue)
+{
+    return fabs(value - defaultValue) < 1e-9f;
+}
+
+struct FusedSamplingWorkspace
+{
+    float* candidateLogits;       // [batchSize, numSegments, FUSED_SAMPLING_TOP_K_MAX]
+    TokenIdType* candidateIds;    // [batchSize, numSegments, FUSED_SAMPLING_TOP_K_MAX]
+    SoftMaxPartial* softMaxParts; // [batchSize, numSegments]
+};
+
+template <typename T>
+__device__ __forceinline__ bool skipRequest(FusedSamplingKernelParams<T> const& params, SizeType32 batchSlot)
+{
+    FinishedState const finishState
+        = params.finishedInput != nullptr ? params.finishedInput[batchSlot] : FinishedState::empty();
+    return (params.skipDecode != nullptr && params.skipDecode[batchSlot]) || finishState.isSkipDecoding()
+        || finishState.isFinished();
+}
+
+//! \brief Processes one segment of the vocabulary of a request. Computes the logits after bias, temperature and
+//! penalties into shared memory, their softmax partial sums and the K largest of them.
+template <typename T>
+__global__ void fusedSamplingStage1(FusedSamplingKernelParams<T> const params, FusedSamplingWorkspace workspace)
+{
+    using BlockReduceTopK = cub::BlockReduce<TopK_2<float>, kStage1BlockSize>;
+    using BlockReduceSoftMax = cub::BlockReduce<SoftMaxPartial, kStage1BlockSize>;
+    __shared__ union
+    {
+        typename BlockReduceTopK::TempStorage topK;
+        typename BlockReduceSoftMax::TempStorage softMax;
+    } tempStorage;
+    __shared__ float sLogits[kSegmentSize];
+
+    auto const tid = static_cast<SizeType32>(threadIdx.x);
+    auto const segmentIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const numSegments = static_cast<SizeType32>(gridDim.x);
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.y);
+    auto const batchSlot = params.batchSlots != nullptr ? params.batchSlots[batchIdx] : batchIdx;
+    if (skipRequest(params, batchSlot))
+    {
+        return;
+    }
+
+    float invTemperature{1.f};
+    bool hasTemperature{false};
+    if (params.temperatures != nullptr)
+    {
+        auto const temperature = params.temperatures[batchSlot];
+        invTemperature = 1.0f / (temperature + 1e-6f);
+        hasTemperature = !isDefault(temperature, layers::DefaultDecodingParams::getTemperature());
+    }
+    float repetitionPenalty{layers::DefaultDecodingParams::getRepetitionPenalty()};
+    float presencePenalty{layers::DefaultDecodingParams::getPresencePenalty()};
+    float frequencyPenalty{layers::DefaultDecodingParams::getFrequencyPenalty()};
+    bool hasOccurrencePenalty{false};
+    if (params.repetitionPenalties != nullptr)
+    {
+        repetitionPenalty = params.repetitionPenalties[batchSlot];
+        hasOccurrencePenalty |= !isDefault(repetitionPenalty, layers::DefaultDecodingParams::getRepetitionPenalty());
+    }
+    if (params.presencePenalties != nullptr)
+    {
+        presencePenalty = params.presencePenalties[batchSlot];
+        hasOccurrencePenalty |= !isDefault(presencePenalty, layers::DefaultDecodingParams::getPresencePenalty());
+    }
+    if (params.frequencyPenalties != nullptr)
+    {
+        frequencyPenalty = params.frequencyPenalties[batchSlot];
+        hasOccurrencePenalty |= !isDefault(frequencyPenalty, layers::DefaultDecodingParams::getFrequencyPenalty());
+    }
+    auto const endId = params.endIds[batchSlot];
+    auto const maskEndId = params.minLengths != nullptr
+        && params.sequenceLengths[batchSlot] - params.inputLengths[batchSlot] < params.minLengths[batchSlot];
+
+    auto const tableSize = params.penaltyTableSize;
+    auto const* tableKeys = params.penaltyWorkspace + batchIdx * 2 * tableSize;
+    auto const* tableCounts = tableKeys + tableSize;
+    auto const* logits = params.logitsPtrs[batchIdx];
+    auto const* bias = params.biases != nullptr ? params.biases + batchSlot * params.vocabSizePadded : nullptr;
+    float const maskVal = std::is_same<T, half>::value ? -HALF_FLT_MAX : -FLT_MAX;
+
+    auto const segmentBegin = segmentIdx * kSegmentSize;
+    auto const segmentLen = min(kSegmentSize, params.vocabSize - segmentBegin);
+    SoftMaxPartial partialSoftMax{-FLT_MAX, 0.f};
+    for (auto i = tid; i < segmentLen; i += kStage1BlockSize)
+    {
+        auto const tokenId = segmentBegin + i;
+        auto logit = static_cast<float>(logits[tokenId]);
+        if (bias != nullptr)
+        {
+            logit += static_cast<float>(bias[tokenId]);
+        }
+        if (hasTemperature)
+        {
+            logit *= invTemperature;
+        }
+        if (hasOccurrencePenalty)
+        {
+            logit = applyOccurrencePenalties(logit, findInPenaltyTable(tableKeys, tableCounts, tableSize, tokenId),
+                params.repetitionPenalties, repetitionPenalty, params.presencePenalties, presencePenalty,
+                params.frequencyPenalties, frequencyPenalty);
+        }
+        logit = fminf(fmaxf(logit, maskVal), -maskVal);
+        if (maskEndId && tokenId == endId)
+        {
+            logit = maskVal;
+        }
+        sLogits[i] = logit;
+        partialSoftMax = mergeSoftMaxPartials(partialSoftMax, SoftMaxPartial{logit, 1.f});
+    }
+    auto const totalSoftMax = BlockReduceSoftMax(tempStorage.softMax).Reduce(partialSoftMax, mergeSoftMaxPartials);
+    auto const partIdx = batchIdx * numSegments + segmentIdx;
+    if (tid == 0)
+    {
+        workspace.softMaxParts[partIdx] = totalSoftMax;
+    }
+    __syncthreads();
+
+    auto const k = params.topKs != nullptr ? params.topKs[batchSlot] : params.maxTopK;
+    auto* candidateLogits = workspace.candidateLogits + partIdx * FUSED_SAMPLING_TOP_K_MAX;
+    auto* candidateIds = workspace.candidateIds + partIdx * FUSED_SAMPLING_TOP_K_MAX;
+    for (SizeType32 ite = 0; ite < k; ite++)
+    {
+        TopK_2<float> partial;
+        for (auto i = tid; i < segmentLen; i += kStage1BlockSize)
+        {
+            partial.insert(sLogits[i], i);
+        }
+        auto const total = BlockReduceTopK(tempStorage.topK).Reduce(partial, reduce_topk_op_2<float>);
+        if (tid == 0)
+        {
+            candidateLogits[ite] = total.p >= 0 ? total.u : -FLT_MAX;
+            candidateIds[ite] = total.p >= 0 ? segmentBegin + total.p : -1;
+            if (total.p >= 0)
+            {
+                sLogits[total.p] = -FLT_MAX;
+            }
+        }
+        __syncthreads();
+    }
+}
+
+//! \brief Merges the candidates and partial sums of all segments of a request and samples a token of them.
+template <typename T>
+__global__ void fusedSamplingStage2(
+    FusedSamplingKernelParams<T> const params, FusedSamplingWorkspace workspace, SizeType32 numSegments)
+{
+    using BlockReduceTopK = cub::BlockReduce<TopK_2<float>, kStage2BlockSize>;
+    __shared__ typename BlockReduceTopK::TempStorage tempStorage;
+    __shared__ TokenIdType sIds[FUSED_SAMPLING_TOP_K_MAX];
+    __shared__ float sLogits[FUSED_SAMPLING_TOP_K_MAX];
+
+    auto const tid = static_cast<SizeType32>(threadIdx.x);
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = params.batchSlots != nullptr ? params.batchSlots[batchIdx] : batchIdx;
+    FinishedState const finishState
+        = params.finishedInput != nullptr ? params.finishedInput[batchSlot] : FinishedState::empty();
+    if ((params.skipDecode != nullptr && params.skipDecode[batchSlot]) || finishState.isSkipDecoding())
+    {
+        return;
+    }
+    if (finishState.isFinished())
+    {
+        if (tid == 0 && params.finishedOutput != nullptr)
+        {
+            params.finishedOutput[batchSlot] = finishState;
+        }
+        return;
+    }
+
+    auto const k = params.topKs != nullptr ? params.topKs[batchSlot] : params.maxTopK;
+    auto const probThreshold = params.topPs != nullptr ? params.topPs[batchSlot] : params.maxTopP;
+    auto* candidateLogits = workspace.candidateLogits + batchIdx * numSegments * FUSED_SAMPLING_TOP_K_MAX;
+    auto const* candidateIds = workspace.candidateIds + batchIdx * numSegments * FUSED_SAMPLING_TOP_K_MAX;
+    auto const numCandidates = numSegments * FUSED_SAMPLING_TOP_K_MAX;
+
+    for (SizeType32 ite = 0; ite < k; ite++)
+    {
+        TopK_2<float> partial;
+        for (auto i = tid; i < numCandidates; i += kStage2BlockSize)
+        {
+            // Each segment wrote its k largest logits only
+            if (i % FUSED_SAMPLING_TOP_K_MAX < k)
+            {
+                partial.insert(candidateLogits[i], i);
+            }
+        }
+        auto const total = BlockReduceTopK(tempStorage).Reduce(partial, reduce_topk_op_2<float>);
+        if (tid == 0)
+        {
+            sIds[ite] = total.p >= 0 ? candidateIds[total.p] : -1;
+            sLogits[ite] = total.u;
+            if (total.p >= 0)
+            {
+                candidateLogits[total.p] = -FLT_MAX;
+            }
+        }
+        __syncthreads();
+    }
+
+    if (tid == 0)
+    {
+        SoftMaxPartial softMax{-FLT_MAX, 0.f};
+        for (SizeType32 si = 0; si < numSegments; ++si)
+        {
+            softMax = mergeSoftMaxPartials(softMax, workspace.softMaxParts[batchIdx * numSegments + si]);
+        }
+
+        float topKSum{0.f};
+        for (SizeType32 ki = 0; ki < k; ki++)
+        {
+            topKSum += __expf(sLogits[ki] - sLogits[0]);
+        }
+        auto randNum = randomUniform(params.randomState + batchSlot) * probThreshold * topKSum;
+        SizeType32 selected = k - 1;
+        for (SizeType32 ki = 0; ki < k; ki++)
+        {
+            randNum -= __expf(sLogits[ki] - sLogits[0]);
+            if (randNum <= 0.0f)
+            {
+                selected = ki;
+                break;
+            }
+        }
+        // If the id is -1 here we force output token to the last from vocabulary to get vivid indicator of smth
+        // going wrong for the debug
+        auto const outputId = sIds[selected] >= 0 ? sIds[selected] : params.vocabSize - 1;
+        auto const seqLen = params.sequenceLengths[batchSlot];
+        params.outputIdsPtrs[batchSlot][seqLen] = outputId;
+        if (params.cumLogProbs != nullptr || params.outputLogProbs != nullptr)
+        {
+            auto const logProb = sLogits[selected] - softMax.max - __logf(softMax.sum);
+            if (params.cumLogProbs != nullptr)
+            {
+                params.cumLogProbs[batchSlot] += logProb;
+            }
+            if (params.outputLogProbs != nullptr)
+            {
+                params.outputLogProbs[seqLen * params.maxBatchSize + batchSlot] = logProb;
+            }
+        }
+        if (outputId == params.endIds[batchSlot])
+        {
+            if (params.finishedOutput != nullptr)
+            {
+                params.finishedOutput[batchSlot].setFinishedEOS();
+            }
+            // Do not increase seq len when EOS is generated. Seq len should always contain only tokens to be
+            // outputted
+        }
+        else
+        {
+            params.sequenceLengths[batchSlot] += 1;
+        }
+    }
+}
+} // namespace
+
+SizeType32 getFusedSamplingNumSegments(SizeType32 vocabSize)
+{
+    return static_cast<SizeType32>(divUp(vocabSize, kSegmentSize));
+}
+
+std::vector<size_t> getFusedSamplingWorkspaceSizes(SizeType32 batchSize, SizeType32 vocabSize)
+{
+    auto const numParts = static_cast<size_t>(batchSize) * getFusedSamplingNumSegments(vocabSize);
+    return {numParts * FUSED_SAMPLING_TOP_K_MAX * sizeof(float),
+        numParts * FUSED_SAMPLING_TOP_K_MAX * sizeof(TokenIdType), numParts * sizeof(SoftMaxPartial)};
+}
+
+template <typename T>
+void invokeFusedSampling(FusedSamplingKernelParams<T> const& params, cudaStream_t stream)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    params.checkParams();
+
+    std::vector<void*> alignedPointers;
+    calcAlignedPointers(
+        alignedPointers, params.workspace, getFusedSamplingWorkspaceSizes(params.batchSize, params.vocabSize));
+    FusedSamplingWorkspace const workspace{static_cast<float*>(alignedPointers[0]),
+        static_cast<TokenIdType*>(alignedPointers[1]), static_cast<SoftMaxPartial*>(alignedPointers[2])};
+
+    auto const numSegments = getFusedSamplingNumSegments(params.vocabSize);
+    dim3 grid1(numSegments, params.batchSize);
+    fusedSamplingStage1<T><<<grid1, kStage1BlockSize, 0, stream>>>(params, workspace);
+    fusedSamplingStage2<T><<<params.batchSize, kStage2BlockSize, 0, stream>>>(params, workspace, numSegments);
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template void invokeFusedSampling(FusedSamplingKernelParams<float> const& params, cudaStream_t stream);
+
+template void invokeFusedSampling(FusedSamplingKernelParams<half> const& params, cudaStream_t stream);
+
+} // namespace tensorrt_llm::kernels
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/memoryUtils.h"
+#include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/philoxRandom.h"
+#include "tensorrt_llm/runtime/common.h"
+
+namespace tensorrt_llm::kernels
+{
+
+//! Largest K supported by invokeFusedSampling
+static constexpr runtime::SizeType32 FUSED_SAMPLING_TOP_K_MAX = 64;
+
+template <typename T>
+struct FusedSamplingKernelParams
+{
+    //! input buffer [batchSize][vocabSizePadded], array of pointers to the raw logits.
+    T const* const* logitsPtrs{nullptr};
+    //! input buffer [maxBatchSize, vocabSizePadded], optional. Bias added to the logits.
+    T const* biases{nullptr};
+
+    //! input buffers [maxBatchSize], optional. Same semantics as in InvokeBatchApplyPenaltyParams.
+    float const* temperatures{nullptr};
+    float const* repetitionPenalties{nullptr};
+    float const* presencePenalties{nullptr};
+    float const* frequencyPenalties{nullptr};
+    runtime::SizeType32 const* minLengths{nullptr};
+    //! input buffer [maxBatchSize], required with minLengths.
+    runtime::SizeType32 const* inputLengths{nullptr};
+    //! input buffer [batchSize, 2 * penaltyTableSize], required with occurrence penalties. Sparse occurrence tables,
+    //! kept up to date by invokeBatchUpdatePenaltyOccurrences.
+    runtime::TokenIdType const* penaltyWorkspace{nullptr};
+    runtime::SizeType32 penaltyTableSize{0};
+
+    //! input buffer [maxBatchSize], optional. K for topK sampling per request, in range [1; 64].
+    //! If nullptr maxTopK is used for all requests.
+    runtime::SizeType32 const* topKs{nullptr};
+    //! input buffer [maxBatchSize], optional. P applied to the top-K tokens per request, in range (0.0, 1.0].
+    //! If nullptr maxTopP is used for all requests.
+    float const* topPs{nullptr};
+    runtime::SizeType32 maxTopK{FUSED_SAMPLING_TOP_K_MAX};
+    float maxTopP{1.0f};
+
+    //! input buffer [maxBatchSize]. Initialized random states
+    RandomState* randomState{nullptr};
+    //! output buffer [maxBatchSize][maxSeqLen]. Pointers to rows with output tokens per request.
+    runtime::TokenIdType** outputIdsPtrs{nullptr};
+    //! input/output buffer [maxBatchSize]. Current sequence length of the request, excluding endId tokens.
+    runtime::SizeType32* sequenceLengths{nullptr};
+    //! input buffer [maxBatchSize]. EOS token ids per request
+    runtime::TokenIdType const* endIds{nullptr};
+    //! input buffer [maxBatchSize], optional. If true, request exits early.
+    FinishedState const* finishedInput{nullptr};
+    //! output buffer [maxBatchSize], optional.
+    FinishedState* finishedOutput{nullptr};
+    //! input buffer [maxBatchSize], optional. Flags whether to skip decoding per request
+    bool const* skipDecode{nullptr};
+    //! input/output buffer [maxBatchSize], optional. Cumulative log probability of selected tokens.
+    float* cumLogProbs{nullptr};
+    //! output buffer [maxSeqLen, maxBatchSize], optional. Log probability of the selected token in the distribution
+    //! over the full vocabulary after bias, temperature and penalties.
+    float* outputLogProbs{nullptr};
+    //! input buffer[batchSize], optional. Indices of rows of data in memory pool.
+    runtime::SizeType32 const* batchSlots{nullptr};
+
+    //! Required. Workspace of size getFusedSamplingWorkspaceSize.
+    void* workspace{nullptr};
+
+    runtime::SizeType32 batchSize{-1};
+    runtime::SizeType32 maxBatchSize{-1};
+    runtime::SizeType32 vocabSize{-1};
+    runtime::SizeType32 vocabSizePadded{-1};
+
+    void checkParams() const
+    {
+        TLLM_CHECK(batchSize > 0);
+        TLLM_CHECK(maxBatchSize >= batchSize);
+        TLLM_CHECK(0 < vocabSize && vocabSize <= vocabSizePadded);
+        TLLM_CHECK(logitsPtrs);
+        TLLM_CHECK(outputIdsPtrs);
+        TLLM_CHECK(sequenceLengths);
+        TLLM_CHECK(endIds);
+        TLLM_CHECK(randomState);
+        TLLM_CHECK(workspace);
+        TLLM_CHECK(minLengths == nullptr || inputLengths != nullptr);
+        auto const hasOccurrencePenalties
+            = repetitionPenalties != nullptr || presencePenalties != nullptr || frequencyPenalties != nullptr;
+        TLLM_CHECK_WITH_INFO(!hasOccurrencePenalties || (penaltyWorkspace != nullptr && penaltyTableSize > 0),
+            "Fused sampling applies occurrence penalties only with sparse occurrence tables");
+        TLLM_CHECK(0 < maxTopP && maxTopP <= 1.f);
+        TLLM_CHECK(0 < maxTopK && maxTopK <= FUSED_SAMPLING_TOP_K_MAX);
+    }
+};
+
+// clang-format off
+//! \brief Applies bias, temperature, occurrence and min length penalties and samples top-K **and** top-P in a single
+//! pass over the logits. Only the sampled ids and log probs are written, the processed logits are not materialized.
+//! The vocabulary of each request is split into segments processed by separate blocks, whose top-K candidates and
+//! softmax partial sums are merged by a second, small kernel. Supports beamWidth == 1 and one token per step.
+// clang-format on
+template <typename T>
+void invokeFusedSampling(FusedSamplingKernelParams<T> const& params, cudaStream_t stream);
+
+//! @returns number of vocabulary segments processed by separate blocks
+[[nodiscard]] runtime::SizeType32 getFusedSamplingNumSegments(runtime::SizeType32 vocabSize);
+
+[[nodiscard]] std::vector<size_t> getFusedSamplingWorkspaceSizes(
+    runtime::SizeType32 batchSize, runtime::SizeType32 vocabSize);
+
+//! \brief Returns workspace size in bytes needed by invokeFusedSampling
+[[nodiscard]] inline size_t getFusedSamplingWorkspaceSize(runtime::SizeType32 batchSize, runtime::SizeType32 vocabSize)
+{
+    return tensorrt_llm::common::calcAlignedSize(getFusedSamplingWorkspaceSizes(batchSize, vocabSize), 256);
+}
+
+} // namespace tensorrt_llm::kernels
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CUDART_VERSION
+#error CUDART_VERSION Undefined!
+#elif (CUDART_VERSION >= 11050)
+#include <cub/cub.cuh>
+#else
+#include "3rdparty/cub/cub.cuh"
+#endif
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/reduceKernelUtils.cuh"
+#include "tensorrt_llm/kernels/samplingRejectionKernels.h"
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+namespace tensorrt_llm::kernels
+{
+
+namespace
+{
+SizeType32 constexpr kRejectionSamplingBlockSize = 512;
+
+//! Probability mass and number of the tokens more likely than a pivot
+struct MassCount
+{
+    float mass;
+    SizeType32 count;
+};
+
+struct MassCountSum
+{
+    __device__ __forceinline__ MassCount operator()(MassCount const& a, MassCount const& b) const
+    {
+        return {a.mass + b.mass, a.count + b.count};
+    }
+};
+
+struct RunningPrefixOp
+{
+    float runningTotal;
+
+    __device__ float operator()(float blockAggregate)
+    {
+        auto const oldPrefix = runningTotal;
+        runningTotal += blockAggregate;
+        return oldPrefix;
+    }
+};
+
+template <typename T, SizeType32 BLOCK_SIZE>
+__global__ void rejectionSampling(RejectionSamplingKernelParams<T> const params)
+{
+    using BlockReduceMax = cub::BlockReduce<TopK_2<float>, BLOCK_SIZE>;
+    using BlockReduceMassCount = cub::BlockReduce<MassCount, BLOCK_SIZE>;
+    using BlockScan = cub::BlockScan<float, BLOCK_SIZE>;
+    __shared__ union
+    {
+        typename BlockReduceMax::TempStorage max;
+        typename BlockReduceMassCount::TempStorage massCount;
+        typename BlockScan::TempStorage scan;
+    } tempStorage;
+    __shared__ SizeType32 sMaxId;
+    __shared__ float sLow;
+    __shared__ float sTotalMass;
+    __shared__ float sMass;
+    __shared__ float sRandNum;
+    __shared__ SizeType32 sCandidate;
+    __shared__ bool sAccepted;
+
+    auto const tid = static_cast<SizeType32>(threadIdx.x);
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = params.batchSlots[batchIdx];
+    FinishedState const finishState
+        = params.finishedInput != nullptr ? params.finishedInput[batchSlot] : FinishedState::empty();
+    if ((params.skipDecode != nullptr && params.skipDecode[batchSlot]) || finishState.isSkipDecoding())
+    {
+        return;
+    }
+    if (finishState.isFinished())
+    {
+        if (tid == 0 && params.finishedOutput != nullptr)
+        {
+            params.finishedOutput[batchSlot] = finishState;
+        }
+        return;
+    }
+
+    auto const vocabSize = params.vocabSizePadded;
+    auto const* probs = params.probs + batchIdx * vocabSize;
+    auto const topK = params.topKs[batchSlot] > 0 ? params.topKs[batchSlot] : vocabSize;
+    auto const topP = params.topPs[batchSlot];
+    auto const minP = params.minPs != nullptr ? params.minPs[batchSlot] : 0.f;
+
+    // Reduces the mass and the number of tokens strictly more likely than pivot
+    auto const reduceAbove = [&](float pivot)
+    {
+        MassCount partial{0.f, 0};
+        for (auto vi = tid; vi < vocabSize; vi += BLOCK_SIZE)
+        {
+            auto const prob = static_cast<float>(probs[vi]);
+            if (prob > pivot)
+            {
+                partial.mass += prob;
+                partial.count += 1;
+            }
+        }
+        auto const total = BlockReduceMassCount(tempStorage.massCount).Reduce(partial, MassCountSum{});
+        __syncthreads();
+        return total;
+    };
+
+    // First pass: the most likely token and the total mass, 1 up to rounding
+    {
+        TopK_2<float> partialMax;
+        for (auto vi = tid; vi < vocabSize; vi += BLOCK_SIZE)
+        {
+            partialMax.insert(static_cast<float>(probs[vi]), vi);
+        }
+        auto const totalMax = BlockReduceMax(tempStorage.max).Reduce(partialMax, reduce_topk_op_2<float>);
+        if (tid == 0)
+        {
+            sMaxId = totalMax.p;
+            // Min-P keeps the tokens with prob >= minP * maxProb, i.e. excludes those below the pivot
+            sLow = minP > 0.f ? nextafterf(minP * totalMax.u, 0.f) : 0.f;
+        }
+        __syncthreads();
+    }
+    auto low = sLow;
+    {
+        auto const distribution = reduceAbove(0.f);
+        auto const kept = low > 0.f ? reduceAbove(low) : distribution;
+        if (tid == 0)
+        {
+            sTotalMass = distribution.mass;
+            sMass = kept.mass;
+        }
+        __syncthreads();
+    }
+
+    auto selected = sMaxId;
+    if (topK > 1)
+    {
+        auto mass = sMass;
+        for (SizeType32 round = 0; round < params.maxRejectionRounds; ++round)
+        {
+            // Draw a candidate from the probabilities above the pivot by inverse transform sampling, every round at
+            // its own position of the step
+            if (tid == 0)
+            {
+                sRandNum = randomUniform(params.randomState[batchSlot], static_cast<std::uint32_t>(round)) * mass;
+                sCandidate = -1;
+            }
+            __syncthreads();
+            RunningPrefixOp prefixOp{0.f};
+            auto const end = (vocabSize + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+            for (auto vi = tid; vi < end; vi += BLOCK_SIZE)
+            {
+                auto const prob = vi < vocabSize ? static_cast<float>(probs[vi]) : 0.f;
+                float threadOffset;
+                BlockScan(tempStorage.scan).InclusiveSum(prob > low ? prob : 0.f, threadOffset, prefixOp);
+                auto const count = __syncthreads_count(sRandNum <= threadOffset);
+                if (count != 0)
+                {
+                    // The prefix sums grow with the thread index, the first thread past the threshold is selected
+                    if (tid == BLOCK_SIZE - count)
+                    {
+                        sCandidate = vi;
+                    }
+                    break;
+                }
+            }
+            __syncthreads();
+            auto const candidate = sCandidate;
+            if (candidate < 0)
+            {
+                // Rounding of the prefix sums can leave the drawn number out of reach
+                break;
+            }
+
+            // Accept the candidate if it lies within top-K and top-P, reject it and all less likely tokens otherwise
+            auto const pivot = static_cast<float>(probs[candidate]);
+            auto const above = reduceAbove(pivot);
+            if (tid == 0)
+            {
+                sAccepted = above.count < topK && above.mass < topP * sTotalMass;
+                sMass = above.mass;
+            }
+            __syncthreads();
+            if (sAccepted)
+            {
+                selected = candidate;
+                break;
+            }
+            low = pivot;
+            mass = sMass;
+        }
+    }
+
+    if (tid == 0)
+    {
+        // One step per token, however many rounds it took
+        ++params.randomState[batchSlot].step;
+        auto const currentStep = params.sequenceLength[batchSlot];
+        params.outputIds[batchSlot][currentStep] = selected;
+        if (params.cumLogProbs != nullptr || params.outputLogProbs != nullptr)
+        {
+            auto const logProb = logf(static_cast<float>(probs[selected]));
+            if (params.cumLogProbs != nullptr)
+            {
+                params.cumLogProbs[batchSlot] += logProb;
+            }
+            if (params.outputLogProbs != nullptr)
+            {
+                params.outputLogProbs[currentStep * params.maxBatchSize + batchSlot] = logProb;
+            }
+        }
+        if (params.finishedOutput != nullptr && params.endIds != nullptr)
+        {
+            if (selected == params.endIds[batchSlot])
+            {
+                params.finishedOutput[batchSlot].setFinishedEOS();
+                // Do not increase seq len when EOS is generated. Seq len should always contain only tokens to be
+                // outputted
+            }
+            else
+            {
+                params.sequenceLength[batchSlot] += 1;
+            }
+        }
+    }
+}
+} // namespace
+
+template <typename T>
+void invokeBatchRejectionSampling(RejectionSamplingKernelParams<T> const& params, cudaStream_t stream)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    params.checkParams();
+
+    rejectionSampling<T, kRejectionSamplingBlockSize>
+        <<<params.batchSize, kRejectionSamplingBlockSize, 0, stream>>>(params);
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template void invokeBatchRejectionSampling(RejectionSamplingKernelParams<float> const& params, cudaStream_t stream);
+template void invokeBatchRejectionSampling(RejectionSamplingKernelParams<half> const& params, cudaStream_t stream);
+
+} // namespace tensorrt_llm::kernels
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/philoxRandom.h"
+#include "tensorrt_llm/runtime/common.h"
+
+namespace tensorrt_llm::kernels
+{
+template <typename T>
+struct RejectionSamplingKernelParams
+{
+    //! Only reachable for adversarial distributions, as every round on average halves the probability mass left to
+    //! reject.
+    static runtime::SizeType32 constexpr kDefaultMaxRejectionRounds = 32;
+
+    //! input buffer [batchSize, vocabSizePadded], required. Probabilities of each token in the vocab.
+    T const* probs{nullptr};
+
+    //! output buffer [maxBatchSize][maxSeqLen], required. Contains pointers to rows with output tokens per request.
+    runtime::TokenIdType** outputIds{nullptr};
+
+    //! input buffer [maxBatchSize], required. K per request, 0 disables top-K. Any K is supported.
+    runtime::SizeType32 const* topKs{nullptr};
+    //! input buffer [maxBatchSize], required. P per request in range (0.0; 1.0], 1.0 disables top-P.
+    float const* topPs{nullptr};
+    //! input buffer [maxBatchSize], optional. Min-P per request in range [0.0; 1.0], 0.0 disables min-P.
+    //! Tokens with probability below minP * max(probs) are not sampled.
+    float const* minPs{nullptr};
+
+    //! input/output buffer [maxBatchSize], required. Current sequence length of the request up to, but excluding endId
+    //! token.
+    runtime::SizeType32* sequenceLength{nullptr};
+    //! input buffer [maxBatchSize], optional. EOS token ids per request
+    runtime::TokenIdType const* endIds{nullptr};
+    //! input buffer[batchSize], required. Indices of rows of data in memory pool.
+    runtime::SizeType32 const* batchSlots{nullptr};
+
+    //! input buffer [maxBatchSize], optional. Exit early if true.
+    FinishedState const* finishedInput{nullptr};
+    //! output buffer [maxBatchSize], optional. Set flag if sequence has finished (if finished || outputId == endId).
+    FinishedState* finishedOutput{nullptr};
+    //! input buffer [maxBatchSize], optional. Flags whether to skip decoding per request
+    bool const* skipDecode{nullptr};
+
+    //! input/output buffer [maxBatchSize], optional. Cumulative log probability of selected tokens. Ignored if nullptr.
+    float* cumLogProbs{nullptr};
+    //! output buffer [maxSeqLen, maxBatchSize], optional. Log probability of the selected token in the full
+    //! distribution, i.e. log_prob = log P(i | i is in vocab).
+    float* outputLogProbs{nullptr};
+    //! input/output buffer [maxBatchSize], required. Random states properly initialized using
+    //! invokeRandomStateInitialize per request. Advanced by one step per sampled token.
+    RandomState* randomState{nullptr};
+
+    //! Number of rejection rounds after which the most likely token is taken, see invokeBatchRejectionSampling.
+    runtime::SizeType32 maxRejectionRounds{kDefaultMaxRejectionRounds};
+
+    runtime::SizeType32 batchSize{-1};
+    runtime::SizeType32 maxBatchSize{-1};
+    runtime::SizeType32 vocabSizePadded{-1};
+
+    void checkParams() const
+    {
+        TLLM_CHECK(batchSize > 0);
+        TLLM_CHECK(maxBatchSize > 0);
+        TLLM_CHECK(maxBatchSize >= batchSize);
+        TLLM_CHECK(vocabSizePadded > 0);
+        TLLM_CHECK(probs);
+        TLLM_CHECK(outputIds);
+        TLLM_CHECK(topKs);
+        TLLM_CHECK(topPs);
+        TLLM_CHECK(sequenceLength);
+        TLLM_CHECK(batchSlots);
+        TLLM_CHECK(randomState);
+        TLLM_CHECK(maxRejectionRounds >= 0);
+
+        TLLM_CHECK(((finishedOutput == nullptr) ^ (endIds == nullptr)) == 0);
+    }
+};
+
+// clang-format off
+//! \brief Given probs, samples with top-K, top-P and min-P without sorting the vocabulary and without workspace.
+//! Each request is sampled by a block with rejection: a candidate is drawn from the probabilities above a pivot, and
+//! accepted if fewer than K tokens and less than P probability mass are more likely than it. Otherwise its probability
+//! becomes the new pivot. The pivot only grows, so the most likely token is always accepted eventually, and the
+//! expected number of rounds is logarithmic in the size of the rejected set. Every round takes two passes over the
+//! probabilities of the request. The thresholds are applied jointly to the full distribution. Min-P sets the initial
+//! pivot and K == 1 is served by a single argmax pass.
+//! If no candidate is accepted within maxRejectionRounds rounds, or rounding of the prefix sums leaves the drawn number
+//! out of reach, the most likely token is taken instead. Round r draws position r of the current step of the random
+//! state of the request, and the step advances once per sampled token, so a token draws the same numbers however
+//! many rounds the previous ones took.
+//! Fills sampled tokens to outputIds. Updates sequenceLength, finished state, cumLogProbs inplace.
+// clang-format on
+template <typename T>
+void invokeBatchRejectionSampling(RejectionSamplingKernelParams<T> const& params, cudaStream_t stream);
+
+} // namespace tensorrt_llm::kernels
@@ -131,7 +131,7 @@ template <typename T, int BLOCK_SIZE_, int BLOCKS_PER_BEAM_>
 __global__ void topKStage2Sampling(SizeType32 const* __restrict topKTmpIdBuf, T* topKTmpValBuf, TokenIdType** idsPtrs,
     TokenIdType* ids, SizeType32* sequenceLengths, FinishedState const* finishedInput, FinishedState* finishedOutput,
     float* cumLogProbs, float* outputLogProbs, SizeType32 maxTopK, SizeType32 const* topKs, float topP,
-    float const* topPs, curandState_t* curandState, TokenIdType const* endIds, SizeType32 vocabSize,
+    float const* topPs, RandomState* randomState, TokenIdType const* endIds, SizeType32 vocabSize,
     bool const* skipDecode, SizeType32 const* batchSlots, SizeType32 maxBatchSize, bool normalizeLogProbs,
     bool logitHasProbs, SizeType32 const* tokensPerStep, SizeType32 maxTokensPerStep, SizeType32 maxSeqLen,
     bool returnAllTopK)
@@ -215,7 +215,11 @@ __global__ void topKStage2Sampling(SizeType32 const* __restrict topKTmpIdBuf, T*
 
     if (tid == 0)
     {
-        auto randNum = static_cast<float>(curand_uniform(curandState + batchSlot) * probThreshold * sSum);
+        // With several tokens per step, all blocks of the slot draw at their own position of the same step, which
+        // advanceRandomStates moves on once they are done.
+        auto const uniform = maxTokensPerStep == 1 ? randomUniform(randomState + batchSlot)
+                                                   : randomUniform(randomState[batchSlot], tokenIdx);
+        auto randNum = static_cast<float>(uniform * probThreshold * sSum);
         auto* outputIdsRequestPtr = idsPtrs == nullptr ? ids + batchSlot * maxSeqLen : idsPtrs[batchSlot];
         for (SizeType32 ki = 0; ki < k; ki++)
         {
@@ -276,6 +280,25 @@ __global__ void topKStage2Sampling(SizeType32 const* __restrict topKTmpIdBuf, T*
     }
 }
 
+__global__ void advanceRandomStates(RandomState* randomState, FinishedState const* finishedInput,
+    bool const* skipDecode, SizeType32 const* batchSlots, SizeType32 const* tokensPerStep, SizeType32 batchSize)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x * blockDim.x + threadIdx.x);
+    if (batchIdx >= batchSize)
+    {
+        return;
+    }
+    auto const batchSlot = batchSlots[batchIdx];
+    FinishedState const finishState = finishedInput != nullptr ? finishedInput[batchSlot] : FinishedState::empty();
+    // Same slots as topKStage2Sampling draws for
+    if ((skipDecode != nullptr && skipDecode[batchSlot]) || finishState.isSkipDecoding() || finishState.isFinished()
+        || tokensPerStep[batchSlot] == 0)
+    {
+        return;
+    }
+    ++randomState[batchSlot].step;
+}
+
 #define CASE_K(K_MAX, BLOCK_SIZE_1_, BLOCK_SIZE_2_, BLOCKS_PER_BEAM_)                                                  \
     do                                                                                                                 \
     {                                                                                                                  \
@@ -294,11 +317,18 @@ __global__ void topKStage2Sampling(SizeType32 const* __restrict topKTmpIdBuf, T*
                 <<<grid, block, K_MAX * sizeof(SizeType32) + K_MAX * sizeof(float), stream>>>(topKTmpIdBuf,            \
                     topKTmpValBuf, params.outputIdsPtrs, params.outputIds, params.sequenceLengths,                     \
                     params.finishedInput, params.finishedOutput, params.cumLogProbs, params.outputLogProbs,            \
-                    params.maxTopK, params.topKs, params.maxTopP, params.topPs, params.curandState, params.endIds,     \
+                    params.maxTopK, params.topKs, params.maxTopP, params.topPs, params.randomState, params.endIds,     \
                     params.vocabSizePadded, params.skipDecode, params.batchSlots, params.maxBatchSize,                 \
                     params.normalizeLogProbs, params.logitsHasProbs, params.tokensPerStep, params.maxTokensPerStep,    \
                     params.maxSeqLen, params.returnAllTopK);                                                           \
         }                                                                                                              \
+        if (params.maxTokensPerStep > 1)                                                                               \
+        {                                                                                                              \
+            dim3 block(std::min(static_cast<uint32_t>(params.batchSize), 256u));                                       \
+            dim3 grid(divUp(static_cast<uint32_t>(params.batchSize), block.x));                                        \
+            advanceRandomStates<<<grid, block, 0, stream>>>(params.randomState, params.finishedInput,                  \
+                params.skipDecode, params.batchSlots, params.tokensPerStep, params.batchSize);                         \
+        }                                                                                                              \
     } while (0)
 
 template <typename T>
@@ -331,25 +361,47 @@ void invokeBatchTopKSampling(TopKSamplingKernelParams<T> const& params, cudaStre
         ++logMaxTopK;
     }
 
+    if (useTopKSplitRows(params.batchSize, params.maxTokensPerStep, params.maxTopK, params.vocabSizePadded))
+    {
+        switch (logMaxTopK)
+        {
+        case 0:
+        case 1:
+        case 2:
+        case 3: // 0 < maxTopK <= 16
+            CASE_K(16, 256, 256, TOP_K_SPLIT_BLOCKS_PER_BEAM);
+            break;
+        case 4: // 16 < maxTopK <= 32
+            CASE_K(32, 256, 256, TOP_K_SPLIT_BLOCKS_PER_BEAM);
+            break;
+        case 5: // 32 < maxTopK <= 64
+            CASE_K(64, 256, 512, TOP_K_SPLIT_BLOCKS_PER_BEAM);
+            break;
+        default: TLLM_CHECK_WITH_INFO(false, "Split TopK kernel supports 1 <= k <= 64 but got k=%d", params.maxTopK);
+        }
+        TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+        return;
+    }
+
     switch (logMaxTopK)
     {
     case 0:
     case 1:
     case 2:
     case 3: // 0 < maxTopK <= 16
-        CASE_K(16, 128, 128, 8);
+        CASE_K(16, 128, 128, TOP_K_BLOCKS_PER_BEAM);
         break;
     case 4: // 16 < maxTopK <= 32
-        CASE_K(32, 256, 128, 8);
+        CASE_K(32, 256, 128, TOP_K_BLOCKS_PER_BEAM);
         break;
     case 5: // 32 < maxTopK <= 64
-        CASE_K(64, 256, 256, 8);
+        CASE_K(64, 256, 256, TOP_K_BLOCKS_PER_BEAM);
         break;
     case 6:
     case 7:
     case 8:
     case 9: // 64 < maxTopK <= 1024
-        CASE_K(1024, 256, 256, 8);
+        CASE_K(1024, 256, 256, TOP_K_BLOCKS_PER_BEAM);
         break;
     default: TLLM_CHECK_WITH_INFO(false, "TopK kernel supports 1 <= k <= 1024 but got k=%d", params.maxTopK);
     }
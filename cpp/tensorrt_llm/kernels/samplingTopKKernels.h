@@ -18,14 +18,35 @@
 
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/philoxRandom.h"
 #include "tensorrt_llm/runtime/common.h"
-#include <curand_kernel.h>
+#include <algorithm>
 
 namespace tensorrt_llm::kernels
 {
 
 static constexpr runtime::SizeType32 TOP_K_MAX = 1024;
 
+//! Number of blocks sharing a row of logits in the first stage of invokeBatchTopKSampling
+static constexpr runtime::SizeType32 TOP_K_BLOCKS_PER_BEAM = 8;
+//! Number of blocks sharing a row when rows are split, see useTopKSplitRows
+static constexpr runtime::SizeType32 TOP_K_SPLIT_BLOCKS_PER_BEAM = 64;
+//! Largest number of rows and K for which rows are split
+static constexpr runtime::SizeType32 TOP_K_SPLIT_MAX_ROWS = 16;
+static constexpr runtime::SizeType32 TOP_K_SPLIT_MAX_K = 64;
+static constexpr runtime::SizeType32 TOP_K_SPLIT_MIN_VOCAB_SIZE = 65536;
+
+//! \brief Decides whether invokeBatchTopKSampling spreads each row over TOP_K_SPLIT_BLOCKS_PER_BEAM blocks.
+//! A few long rows, e.g. a single request of a multilingual model, keep only a few SMs busy with the default split
+//! and the latency is dominated by the k passes over the slice of each block. Splitting more shortens the slices at
+//! the cost of k times more candidates to merge in the second stage, which is cheap for small K.
+[[nodiscard]] inline bool useTopKSplitRows(runtime::SizeType32 batchSize, runtime::SizeType32 maxTokensPerStep,
+    runtime::SizeType32 maxTopK, runtime::SizeType32 vocabSizePadded)
+{
+    return vocabSizePadded >= TOP_K_SPLIT_MIN_VOCAB_SIZE && batchSize * maxTokensPerStep <= TOP_K_SPLIT_MAX_ROWS
+        && maxTopK <= TOP_K_SPLIT_MAX_K;
+}
+
 template <typename T>
 struct TopKSamplingKernelParams
 {
@@ -82,8 +103,8 @@ struct TopKSamplingKernelParams
     //! Ignored if nullptr.
     float* outputLogProbs{nullptr};
 
-    //! input buffer [maxBatchSize]. Initialized curand states
-    curandState_t* curandState{nullptr};
+    //! input/output buffer [maxBatchSize]. Initialized random states, advanced by one step for every sampled slot
+    RandomState* randomState{nullptr};
     //! input buffer [maxBatchSize]. K for topK sampling per request.
     //! Supported K is in range [1; 1024]. Where K=1 is greedy search.
     //! If nullptr maxTopK is used for all requests.
@@ -131,7 +152,7 @@ struct TopKSamplingKernelParams
         }
 
         TLLM_CHECK(workspace);
-        TLLM_CHECK(curandState);
+        TLLM_CHECK(randomState);
 
         TLLM_CHECK(maxTokensPerStep != 1 || returnAllTopK || sequenceLengths);
         TLLM_CHECK(maxTokensPerStep != 1 || returnAllTopK || endIds);
@@ -160,11 +181,18 @@ template <typename T>
 [[nodiscard]] std::vector<size_t> getTopKWorkspaceSizes(runtime::SizeType32 batchSize,
     runtime::SizeType32 maxTokensPerStep, runtime::SizeType32 maxTopK, runtime::SizeType32 vocabSizePadded)
 {
-    runtime::SizeType32 constexpr maxBlockPerBeam = 8;
-    auto const tempLogProbsBufSize = sizeof(T) * batchSize * maxTokensPerStep * vocabSizePadded;         // type T
-    auto const topKTmpIdsBufSize
-        = sizeof(runtime::SizeType32) * batchSize * maxTokensPerStep * maxTopK * maxBlockPerBeam;        // type int
-    auto const topKTmpValBufSize = sizeof(T) * batchSize * maxTokensPerStep * maxTopK * maxBlockPerBeam; // type T
+    auto const numRows = static_cast<size_t>(batchSize) * maxTokensPerStep;
+    // Candidates of the first stage. Rows are split only for small batches and K, see useTopKSplitRows
+    auto numCandidates = numRows * maxTopK * TOP_K_BLOCKS_PER_BEAM;
+    if (vocabSizePadded >= TOP_K_SPLIT_MIN_VOCAB_SIZE)
+    {
+        numCandidates = std::max(numCandidates,
+            std::min<size_t>(numRows, TOP_K_SPLIT_MAX_ROWS) * std::min(maxTopK, TOP_K_SPLIT_MAX_K)
+                * TOP_K_SPLIT_BLOCKS_PER_BEAM);
+    }
+    auto const tempLogProbsBufSize = sizeof(T) * numRows * vocabSizePadded;     // type T
+    auto const topKTmpIdsBufSize = sizeof(runtime::SizeType32) * numCandidates; // type int
+    auto const topKTmpValBufSize = sizeof(T) * numCandidates;                   // type T
 
     return {tempLogProbsBufSize, topKTmpIdsBufSize, topKTmpValBufSize};
 }
@@ -198,7 +198,7 @@ __device__ void epilogue(SizeType32 batchId, SizeType32 currentStep, SizeType32
 template <typename T, int blockSize>
 __global__ void topPSsampling(T* sortedProbs, TokenIdType* sortedIdVals, TokenIdType** ids, SizeType32* sequenceLength,
     FinishedState const* finishedInput, FinishedState* finishedOutput, float* cumLogProbs, float* outputLogProbs,
-    SizeType32 const* beginOffsetBuf, SizeType32 const* offsetBuf, SizeType32 vocabSize, curandState_t* curandState,
+    SizeType32 const* beginOffsetBuf, SizeType32 const* offsetBuf, SizeType32 vocabSize, RandomState* randomState,
     float const* topPs, TokenIdType const* endIds, SizeType32 maxBatchSize, bool const* skipDecode,
     SizeType32 const* batchSlots)
 {
@@ -242,7 +242,7 @@ __global__ void topPSsampling(T* sortedProbs, TokenIdType* sortedIdVals, TokenId
     // will choose the token which probability makes cumulative probability sum to exceed P'
     if (threadIdx.x == 0)
     {
-        randNumS = curand_uniform(curandState + blockIdx.x) * probThreshold;
+        randNumS = randomUniform(randomState + blockIdx.x) * probThreshold;
     }
 
     // if beginOffsetBuf and offsetBuf of sorting have same value,
@@ -372,7 +372,7 @@ void invokeBatchTopPSampling(TopPSamplingKernelParams<T> const& params, cudaStre
     // Sample with Top P given sorted tokens
     topPSsampling<T, SAMPLING_BLOCK_SIZE><<<grid, SAMPLING_BLOCK_SIZE, 0, stream>>>(sortedProbs, sortedIdVals,
         params.outputIds, params.sequenceLength, params.finishedInput, params.finishedOutput, params.cumLogProbs,
-        params.outputLogProbs, beginOffsetBuf, offsetBuf + 1, params.vocabSizePadded, params.curandState, params.topPs,
+        params.outputLogProbs, beginOffsetBuf, offsetBuf + 1, params.vocabSizePadded, params.randomState, params.topPs,
         params.endIds, params.maxBatchSize, params.skipDecode, params.batchSlots);
     sync_check_cuda_error();
 
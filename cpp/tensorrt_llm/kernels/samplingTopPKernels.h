@@ -17,8 +17,8 @@
 
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/philoxRandom.h"
 #include "tensorrt_llm/runtime/common.h"
-#include <curand_kernel.h>
 
 namespace tensorrt_llm::kernels
 {
@@ -59,9 +59,9 @@ struct TopPSamplingKernelParams
     //! output buffer [maxBatchSize], optional. Log probs is the probability induced by the TopP sampling.
     //! I.e., log_prob = log P(i | i is in vocab).
     float* outputLogProbs{nullptr};
-    //! input buffer [maxBatchSize], required. Curand states properly initialized using
-    //! invokeCurandInitialize per request.
-    curandState_t* curandState{nullptr};
+    //! input buffer [maxBatchSize], required. Random states properly initialized using
+    //! invokeRandomStateInitialize per request.
+    RandomState* randomState{nullptr};
 
     //! The appropriate block configuration calculated based on the number of multiprocessors, occupancy,
     //! batchSize and vocabSizePadded. Required for AirTopP
@@ -84,7 +84,7 @@ struct TopPSamplingKernelParams
         TLLM_CHECK(outputIds);
         TLLM_CHECK(workspace);
         TLLM_CHECK(sequenceLength);
-        TLLM_CHECK(curandState);
+        TLLM_CHECK(randomState);
         TLLM_CHECK(topPs);
 
         TLLM_CHECK(((finishedOutput == nullptr) ^ (endIds == nullptr)) == 0);
@@ -16,6 +16,8 @@
 
 #include <cuda_runtime_api.h>
 
+#include <algorithm>
+
 #include <cooperative_groups/memcpy_async.h>
 #include <cuda/pipeline>
 
@@ -491,101 +493,115 @@ __launch_bounds__(128, 2) __global__ void selective_scan_update_kernel(SSMParams
     int const group = head / (nheads / ngroups);
 
     int const slot_idx = params.slot_mapping_ptr == nullptr ? sample : params.slot_mapping_ptr[sample];
+    int const step_tokens = max(params.step_tokens, 1);
     int const dt_d_idx = MAMBA_V1 ? channel : head;
     int const bc_dim = MAMBA_V1 ? 2 * DSTATE : 2 * ngroups * DSTATE;
     int const x_dim = MAMBA_V1 ? num_channels : num_channels + bc_dim;
     int const z_dim = MAMBA_V1 ? num_channels : 2 * num_channels + bc_dim + nheads;
     int const dt_dim = MAMBA_V1 ? num_channels : (z ? z_dim : z_dim - num_channels);
-    int const dt_offset = MAMBA_V1 ? sample * dt_dim : sample * dt_dim + dt_dim - nheads;
-    int const bc_offset = MAMBA_V1 ? sample * (bc_dim + params.dt_rank) : sample * (num_channels + bc_dim);
     int const b_offset = MAMBA_V1 ? params.dt_rank : num_channels + DSTATE * group;
     int const c_offset = MAMBA_V1 ? params.dt_rank + DSTATE : num_channels + DSTATE * (ngroups + group);
 
-    input_t* my_state = &state[slot_idx * num_channels * DSTATE];
-    input_t* my_output = &output[sample * num_channels];
+    int const state_size = num_channels * DSTATE;
+    input_t* my_state = &state[slot_idx * state_size];
+    input_t* intermediate_state = reinterpret_cast<input_t*>(params.intermediate_state_ptr);
 
     int const state_loops = (DSTATE + STATE_UNROLL - 1) / STATE_UNROLL;
 
-    float my_x, my_dt, my_z, my_dt_bias, out;
-    my_x = toFloat(x[sample * x_dim + channel]);
-    my_z = z ? toFloat(z[sample * z_dim + channel]) : 0.f;
-    my_dt = toFloat(dt[dt_offset + dt_d_idx]);
-    my_dt_bias = dt_bias ? toFloat(dt_bias[dt_d_idx]) : 0.f;
-    out = D ? toFloat(D[dt_d_idx]) * my_x : 0.f;
-
-    float dt_b = my_dt + my_dt_bias;
-    float dt_b_sp = 1.0f;
-    if (dt_softplus)
-    {
-        dt_b_sp = dt_b <= 20.f ? __logf(1.f + __expf(dt_b)) : dt_b; // softplus
-    }
+    float my_dt_bias = dt_bias ? toFloat(dt_bias[dt_d_idx]) : 0.f;
+    float my_D = D ? toFloat(D[dt_d_idx]) : 0.f;
 
-    if (MAMBA_V1)
+    float rA[MAMBA_V1 ? DSTATE : 1];
+    float rState[MAMBA_V1 ? DSTATE : 1];
+    if constexpr (MAMBA_V1)
     {
-        float rA[DSTATE];
-        float rB[DSTATE];
-        float rC[DSTATE];
-        float rState[DSTATE];
 #pragma unroll
         for (int i = 0; i < DSTATE; i++)
         {
             rA[i] = toFloat(A[i * num_channels + channel]);
-            rB[i] = toFloat(B[bc_offset + b_offset + i]);
-            rC[i] = toFloat(C[bc_offset + c_offset + i]);
             rState[i] = toFloat(my_state[i * num_channels + channel]);
         }
-#pragma unroll
-        for (int i = 0; i < DSTATE; i++)
-        {
-            float dA = __expf(rA[i] * dt_b_sp);
-            float dB = rB[i] * dt_b_sp;
-            float sdA = rState[i] * dA;
-            float dBx = dB * my_x;
-            float newState = sdA + dBx;
-            // Write the new state back out to the cache
-            convertAndStore(&my_state[i * num_channels + channel], newState);
-            out += newState * rC[i];
-        }
     }
-    else
+
+    // Tokens of a sequence are processed in order, each one starting from the state left by the previous one.
+    for (int t = 0; t < step_tokens; t++)
     {
-        float A_tmp = toFloat(A[head]);
-        float rB[STATE_UNROLL];
-        float rC[STATE_UNROLL];
-        float rState[STATE_UNROLL];
-        for (int si = 0; si < state_loops; si++)
+        int const token = sample * step_tokens + t;
+        int const dt_offset = MAMBA_V1 ? token * dt_dim : token * dt_dim + dt_dim - nheads;
+        int const bc_offset = MAMBA_V1 ? token * (bc_dim + params.dt_rank) : token * (num_channels + bc_dim);
+        input_t const* state_in
+            = (t == 0 || !intermediate_state) ? my_state : &intermediate_state[(token - 1) * state_size];
+        input_t* state_out = intermediate_state ? &intermediate_state[token * state_size] : my_state;
+
+        float my_x, my_dt, my_z, out;
+        my_x = toFloat(x[token * x_dim + channel]);
+        my_z = z ? toFloat(z[token * z_dim + channel]) : 0.f;
+        my_dt = toFloat(dt[dt_offset + dt_d_idx]);
+        out = my_D * my_x;
+
+        float dt_b = my_dt + my_dt_bias;
+        float dt_b_sp = 1.0f;
+        if (dt_softplus)
+        {
+            dt_b_sp = dt_b <= 20.f ? __logf(1.f + __expf(dt_b)) : dt_b; // softplus
+        }
+
+        if constexpr (MAMBA_V1)
         {
-            int i_offset = si * STATE_UNROLL;
-#pragma unroll
-            for (int i = 0; i < STATE_UNROLL; i++)
-            {
-                rB[i] = toFloat(B[bc_offset + b_offset + i_offset + i]);
-                rC[i] = toFloat(C[bc_offset + c_offset + i_offset + i]);
-                rState[i] = toFloat(my_state[(head * DSTATE + i_offset + i) * head_dim + head_chl]);
-            }
 #pragma unroll
-            for (int i = 0; i < STATE_UNROLL; i++)
+            for (int i = 0; i < DSTATE; i++)
             {
-                float dA = __expf(A_tmp * dt_b_sp);
-                float dB = rB[i] * dt_b_sp;
+                float dA = __expf(rA[i] * dt_b_sp);
+                float dB = toFloat(B[bc_offset + b_offset + i]) * dt_b_sp;
                 float sdA = rState[i] * dA;
                 float dBx = dB * my_x;
                 float newState = sdA + dBx;
+                rState[i] = newState;
                 // Write the new state back out to the cache
-                convertAndStore(&my_state[(head * DSTATE + i_offset + i) * head_dim + head_chl], newState);
-                out += newState * rC[i];
+                convertAndStore(&state_out[i * num_channels + channel], newState);
+                out += newState * toFloat(C[bc_offset + c_offset + i]);
+            }
+        }
+        else
+        {
+            float A_tmp = toFloat(A[head]);
+            float rB[STATE_UNROLL];
+            float rC[STATE_UNROLL];
+            float rStateChunk[STATE_UNROLL];
+            for (int si = 0; si < state_loops; si++)
+            {
+                int i_offset = si * STATE_UNROLL;
+#pragma unroll
+                for (int i = 0; i < STATE_UNROLL; i++)
+                {
+                    rB[i] = toFloat(B[bc_offset + b_offset + i_offset + i]);
+                    rC[i] = toFloat(C[bc_offset + c_offset + i_offset + i]);
+                    rStateChunk[i] = toFloat(state_in[(head * DSTATE + i_offset + i) * head_dim + head_chl]);
+                }
+#pragma unroll
+                for (int i = 0; i < STATE_UNROLL; i++)
+                {
+                    float dA = __expf(A_tmp * dt_b_sp);
+                    float dB = rB[i] * dt_b_sp;
+                    float sdA = rStateChunk[i] * dA;
+                    float dBx = dB * my_x;
+                    float newState = sdA + dBx;
+                    // Write the new state back out to the cache
+                    convertAndStore(&state_out[(head * DSTATE + i_offset + i) * head_dim + head_chl], newState);
+                    out += newState * rC[i];
+                }
             }
         }
-    }
 
-    if (z)
-    {
-        float sig_z = __fdividef(1.f, (1.f + __expf(0.f - my_z)));
-        float silu_z = my_z * sig_z;
-        out *= silu_z;
-    }
+        if (z)
+        {
+            float sig_z = __fdividef(1.f, (1.f + __expf(0.f - my_z)));
+            float silu_z = my_z * sig_z;
+            out *= silu_z;
+        }
 
-    convertAndStore(&my_output[channel], out);
+        convertAndStore(&output[token * num_channels + channel], out);
+    }
 }
 
 template <typename input_t, typename weight_t>
@@ -624,5 +640,174 @@ INSTANTIATE_SELECTIVE_SCAN_UPDATE_DATA_TYPE(__nv_bfloat16, float);
 #endif
 #undef INSTANTIATE_SELECTIVE_SCAN_UPDATE_DATA_TYPE
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// One block per (head, sample) and one thread per head channel. Every block also computes the conv of the B and C
+// channels of its group, which are shared by all heads of the group. Their conv state may only be shifted once every
+// block of the group has read it, so the blocks count themselves in on a semaphore and the last one does the update.
+template <typename input_t, typename weight_t, int DSTATE = 128, int DCONV = 4, int STATE_UNROLL = 16>
+__global__ void mamba2_conv1d_selective_scan_update_kernel(MambaConv1dSelectiveScanParams params)
+{
+    auto const* input = reinterpret_cast<input_t const*>(params.in_ptr);
+    auto const* conv_weight = reinterpret_cast<input_t const*>(params.conv_weight_ptr);
+    auto const* conv_bias = reinterpret_cast<input_t const*>(params.conv_bias_ptr);
+    auto* conv_state = reinterpret_cast<input_t*>(params.conv_state_ptr);
+    auto* ssm_state = reinterpret_cast<input_t*>(params.ssm_state_ptr);
+    auto const* A = reinterpret_cast<weight_t const*>(params.A_ptr);
+    auto const* D = reinterpret_cast<weight_t const*>(params.D_ptr);
+    auto const* dt_bias = reinterpret_cast<weight_t const*>(params.delta_bias_ptr);
+    auto* output = reinterpret_cast<input_t*>(params.out_ptr);
+
+    __shared__ float s_BC[2 * DSTATE];
+    __shared__ bool s_is_last_block;
+
+    int const head = blockIdx.x;
+    int const sample = blockIdx.y;
+    int const num_channels = params.dim;
+    int const head_dim = num_channels / params.nheads;
+    int const heads_per_group = params.nheads / params.ngroups;
+    int const group = head / heads_per_group;
+    int const conv_dim = num_channels + 2 * params.ngroups * DSTATE;
+    int const in_dim = num_channels + conv_dim + params.nheads;
+    int const slot_idx = params.slot_mapping_ptr == nullptr ? sample : params.slot_mapping_ptr[sample];
+
+    input_t const* token_z = input + sample * in_dim;
+    input_t const* token_xBC = token_z + num_channels;
+    input_t* token_conv_state = conv_state + slot_idx * (DCONV - 1) * conv_dim;
+
+    auto const conv = [&](int conv_channel, bool update_state)
+    {
+        float window[DCONV];
+#pragma unroll
+        for (int i = 0; i < DCONV - 1; ++i)
+        {
+            window[i] = toFloat(token_conv_state[i * conv_dim + conv_channel]);
+        }
+        window[DCONV - 1] = toFloat(token_xBC[conv_channel]);
+        float result = toFloat(conv_bias[conv_channel]);
+#pragma unroll
+        for (int i = 0; i < DCONV; ++i)
+        {
+            result += toFloat(conv_weight[i * conv_dim + conv_channel]) * window[i];
+        }
+        if (update_state)
+        {
+#pragma unroll
+            for (int i = 0; i < DCONV - 1; ++i)
+            {
+                convertAndStore(&token_conv_state[i * conv_dim + conv_channel], window[i + 1]);
+            }
+        }
+        // SiLU
+        return result < -20.f ? 0.f : result / (1.f + __expf(-result));
+    };
+
+    auto const bc_channel = [&](int i)
+    {
+        return i < DSTATE ? num_channels + group * DSTATE + i
+                          : num_channels + (params.ngroups + group) * DSTATE + (i - DSTATE);
+    };
+
+    for (int i = threadIdx.x; i < 2 * DSTATE; i += blockDim.x)
+    {
+        s_BC[i] = conv(bc_channel(i), false);
+    }
+
+    // The x channels of a head belong to this block alone, their conv state is shifted right away.
+    int const head_chl = threadIdx.x;
+    int const channel = head * head_dim + head_chl;
+    float const my_x = head_chl < head_dim ? conv(channel, true) : 0.f;
+
+    __syncthreads();
+    if (threadIdx.x == 0)
+    {
+        int* semaphore = params.semaphore_ptr + sample * params.ngroups + group;
+        s_is_last_block = atomicAdd(semaphore, 1) == heads_per_group - 1;
+        if (s_is_last_block)
+        {
+            *semaphore = 0;
+        }
+    }
+    __syncthreads();
+    if (s_is_last_block)
+    {
+        for (int i = threadIdx.x; i < 2 * DSTATE; i += blockDim.x)
+        {
+            int const conv_channel = bc_channel(i);
+#pragma unroll
+            for (int j = 0; j < DCONV - 2; ++j)
+            {
+                token_conv_state[j * conv_dim + conv_channel] = token_conv_state[(j + 1) * conv_dim + conv_channel];
+            }
+            token_conv_state[(DCONV - 2) * conv_dim + conv_channel] = token_xBC[conv_channel];
+        }
+    }
+
+    if (head_chl >= head_dim)
+    {
+        return;
+    }
+
+    float dt = toFloat(token_z[num_channels + conv_dim + head]) + (dt_bias ? toFloat(dt_bias[head]) : 0.f);
+    if (params.delta_softplus)
+    {
+        dt = dt <= 20.f ? __logf(1.f + __expf(dt)) : dt;
+    }
+    float const dA = __expf(toFloat(A[head]) * dt);
+    float out = D ? toFloat(D[head]) * my_x : 0.f;
+
+    input_t* my_state = ssm_state + slot_idx * num_channels * DSTATE + head * DSTATE * head_dim + head_chl;
+    for (int si = 0; si < DSTATE; si += STATE_UNROLL)
+    {
+        float rState[STATE_UNROLL];
+#pragma unroll
+        for (int i = 0; i < STATE_UNROLL; i++)
+        {
+            rState[i] = toFloat(my_state[(si + i) * head_dim]);
+        }
+#pragma unroll
+        for (int i = 0; i < STATE_UNROLL; i++)
+        {
+            float const newState = rState[i] * dA + s_BC[si + i] * dt * my_x;
+            convertAndStore(&my_state[(si + i) * head_dim], newState);
+            out += newState * s_BC[DSTATE + si + i];
+        }
+    }
+
+    if (params.z_enabled)
+    {
+        float const z = toFloat(token_z[channel]);
+        out *= z / (1.f + __expf(-z));
+    }
+    convertAndStore(&output[sample * num_channels + channel], out);
+}
+
+template <typename input_t, typename weight_t>
+void invokeMambaConv1dSelectiveScanUpdate(MambaConv1dSelectiveScanParams& params, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(params.dstate == 128, "Fused conv1d selective scan only supports dstate 128");
+    TLLM_CHECK_WITH_INFO(params.dconv == 4, "Fused conv1d selective scan only supports dconv 4");
+    TLLM_CHECK_WITH_INFO(params.nheads % params.ngroups == 0, "nheads must be divisible by ngroups");
+    TLLM_CHECK_WITH_INFO(params.dim % params.nheads == 0, "dim must be divisible by nheads");
+    TLLM_CHECK_WITH_INFO(params.semaphore_ptr != nullptr, "Fused conv1d selective scan needs its semaphores");
+
+    int const headDim = params.dim / params.nheads;
+    int const threads = std::max(32, (headDim + 31) / 32 * 32);
+    TLLM_CHECK_WITH_INFO(threads <= 1024, "Head dim %d is too large", headDim);
+    dim3 grid(params.nheads, params.batch);
+    mamba2_conv1d_selective_scan_update_kernel<input_t, weight_t><<<grid, threads, 0, stream>>>(params);
+}
+
+#define INSTANTIATE_MAMBA_CONV1D_SELECTIVE_SCAN_UPDATE_DATA_TYPE(input_t, weight_t)                                    \
+    template void invokeMambaConv1dSelectiveScanUpdate<input_t, weight_t>(                                             \
+        MambaConv1dSelectiveScanParams & params, cudaStream_t stream)
+
+INSTANTIATE_MAMBA_CONV1D_SELECTIVE_SCAN_UPDATE_DATA_TYPE(float, float);
+INSTANTIATE_MAMBA_CONV1D_SELECTIVE_SCAN_UPDATE_DATA_TYPE(half, float);
+#ifdef ENABLE_BF16
+INSTANTIATE_MAMBA_CONV1D_SELECTIVE_SCAN_UPDATE_DATA_TYPE(__nv_bfloat16, float);
+#endif
+#undef INSTANTIATE_MAMBA_CONV1D_SELECTIVE_SCAN_UPDATE_DATA_TYPE
+
 } // namespace kernels
 } // namespace tensorrt_llm
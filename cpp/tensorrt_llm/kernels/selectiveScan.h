@@ -67,6 +67,12 @@ struct SSMParamsBase
     void* __restrict__ desc_ptr;
     int const* __restrict__ last_token_ids_ptr;
     int const* __restrict__ slot_mapping_ptr;
+
+    // Generation steps may process several tokens per sequence, e.g. to verify draft tokens. If set, the state after
+    // each token is written to intermediate_state_ptr [batch, step_tokens, state size] and the state itself is left
+    // for invokeCommitRecurrentStates to update once the accepted tokens are known.
+    int step_tokens; // 0 or 1 for a single token
+    void* __restrict__ intermediate_state_ptr;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -79,5 +85,42 @@ void invokeChunkScan(SSMParamsBase& params, cudaStream_t stream, tensorrt_llm::c
 
 template <typename input_t, typename weight_t>
 void invokeSelectiveScanUpdate(SSMParamsBase& params, cudaStream_t stream);
+
+// Single token decode step of a Mamba2 mixer in one kernel: the causal conv1d of xBC with its state update, SiLU and
+// the selective scan state update, starting from the in_proj output.
+struct MambaConv1dSelectiveScanParams
+{
+    int batch, dim, dstate, nheads, ngroups, dconv;
+    bool delta_softplus;
+
+    // [batch, 2 * dim + 2 * ngroups * dstate + nheads], the in_proj output laid out as z, xBC, dt
+    void const* __restrict__ in_ptr;
+    // [dconv, dim + 2 * ngroups * dstate] and [dim + 2 * ngroups * dstate]
+    void const* __restrict__ conv_weight_ptr;
+    void const* __restrict__ conv_bias_ptr;
+    // [num_slots, dconv - 1, dim + 2 * ngroups * dstate], updated in place
+    void* __restrict__ conv_state_ptr;
+    // [num_slots, nheads, dstate, dim / nheads], updated in place
+    void* __restrict__ ssm_state_ptr;
+    // [nheads] each
+    void const* __restrict__ A_ptr;
+    void const* __restrict__ D_ptr;
+    void const* __restrict__ delta_bias_ptr;
+    // Gate the output with SiLU(z)
+    bool z_enabled;
+    // [batch, dim]
+    void* __restrict__ out_ptr;
+    int const* __restrict__ slot_mapping_ptr;
+    // [batch * ngroups] zero initialized counters, the kernel leaves them zeroed
+    int* __restrict__ semaphore_ptr;
+};
+
+inline size_t getMambaConv1dSelectiveScanWorkspaceSize(int maxBatchSize, int ngroups)
+{
+    return sizeof(int) * maxBatchSize * ngroups;
+}
+
+template <typename input_t, typename weight_t>
+void invokeMambaConv1dSelectiveScanUpdate(MambaConv1dSelectiveScanParams& params, cudaStream_t stream);
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -207,7 +207,7 @@ __global__ void fillContextBuffers(FillContextExplicitDraftTokensParams<T> param
     if (threadIdx.x == 0)
     {
         // Generate new random data for sampling.
-        params.randDataSample[batchSlot] = static_cast<T>(curand_uniform(params.curandState + batchSlot));
+        params.randDataSample[batchSlot] = static_cast<T>(randomUniform(params.randomState + batchSlot));
 
         // Copy temperature.
         params.outputTemperatures[batchSlot] = __frcp_rn(params.inputTemperatures[batchSlot]);
@@ -241,22 +241,22 @@ __global__ void fillRandData(FillRandDataExplicitDraftTokensParams<T> const para
         auto const bid = static_cast<SizeType32>(blockIdx.x);
         auto const batchSlot = params.batchSlots ? params.batchSlots[bid] : bid;
 
-        auto curandState = params.curandState[batchSlot];
+        auto& randomState = params.randomState[batchSlot];
 
-        // Generate new random data for sampling.
-        params.randDataSample[batchSlot] = static_cast<T>(curand_uniform(&curandState));
+        // Generate new random data for sampling at position 0 of the step.
+        params.randDataSample[batchSlot] = static_cast<T>(randomUniform(randomState));
 
         if (!params.skipVerification)
         {
             for (auto idx = 0; idx < params.numPaths * params.draftLength; idx++)
             {
-                // Generate new random data for token verification.
+                // Generate new random data for token verification, one position per draft token.
                 auto const offset = flat_index2(batchSlot, idx, params.numPaths * params.draftLength);
-                params.randDataVerification[offset] = static_cast<T>(curand_uniform(&curandState));
+                params.randDataVerification[offset] = static_cast<T>(randomUniform(randomState, idx + 1));
             }
         }
 
-        params.curandState[batchSlot] = curandState;
+        ++randomState.step;
     }
 }
 } // namespace
@@ -381,16 +381,16 @@ __global__ void extractExplicitDraftTokens(ExtractExplicitDraftTokensParams<T> p
         // Set number of tokens passed to the engine per request for the next iteration.
         params.outputGenerationLengths[batchSlot] = numNextDraftTokens;
 
-        auto curandState = params.curandState[batchSlot];
-        // Generate new random data for sampling.
-        params.randDataSample[batchSlot] = static_cast<T>(curand_uniform(&curandState));
+        auto& randomState = params.randomState[batchSlot];
+        // Generate new random data for sampling at position 0 of the step.
+        params.randDataSample[batchSlot] = static_cast<T>(randomUniform(randomState));
         for (auto idx = 0; idx < params.numPaths * (params.maxPathLength - 1); idx++)
         {
-            // Generate new random data for token verification.
+            // Generate new random data for token verification, one position per draft token.
             auto const offset = flat_index2(batchSlot, idx, params.numPaths * (params.maxPathLength - 1));
-            params.randDataVerification[offset] = static_cast<T>(curand_uniform(&curandState));
+            params.randDataVerification[offset] = static_cast<T>(randomUniform(randomState, idx + 1));
         }
-        params.curandState[batchSlot] = curandState;
+        ++randomState.step;
 
         // Increase seqLen by accepted len.
         params.sequenceLengths[batchSlot] = curSeqLen + bestPathLength;
@@ -479,6 +479,8 @@ void invokeCopyProbs(uint8_t const* srcDataPtr, uint8_t* dstDataPtr, SizeType32
 template <typename T>
 void invokeCopyProbs(ExtractExplicitDraftTokensParams<T> const& params, cudaStream_t stream)
 {
+    TLLM_CHECK(params.nextDraftProbs);
+
     auto srcDataPtr = reinterpret_cast<uint8_t const*>(params.nextDraftProbs);
     auto dstDataPtr = reinterpret_cast<uint8_t*>(params.outputDraftProbs);
     auto const numCopyElems = params.numPaths * (params.maxPathLength - 1) * params.vocabSize;
@@ -494,6 +496,230 @@ template void invokeCopyProbs(ExtractExplicitDraftTokensParams<half> const& para
 template void invokeCopyProbs(ExtractExplicitDraftTokensParams<__nv_bfloat16> const& params, cudaStream_t stream);
 #endif // ENABLE_BF16
 
+namespace
+{
+__device__ __forceinline__ float getCandidateKey(float score)
+{
+    // NaN scores would break the strict ordering of the candidates.
+    return isnan(score) ? -INFINITY : score;
+}
+
+template <typename T>
+__global__ void buildDynamicDraftTree(DynamicDraftTreeParams<T> params)
+{
+    auto const bid = static_cast<SizeType32>(blockIdx.x);
+    auto const numCandidates = params.numCandidates
+        ? max(min(params.numCandidates[bid], params.maxNumCandidates), 1)
+        : params.maxNumCandidates;
+
+    extern __shared__ SizeType32 shTree[];
+    // Candidate index at each rank.
+    auto* shOrder = shTree;
+    // Node index of each candidate, -1 if the candidate is not in the tree.
+    auto* shNodeIndices = shOrder + params.maxNumCandidates;
+    // Whether the node has children.
+    auto* shHasChild = shNodeIndices + params.maxNumCandidates;
+    __shared__ SizeType32 shTreeSize;
+
+    auto const* scores = params.candidateScores + bid * params.maxNumCandidates;
+    auto const* parents = params.candidateParents + bid * params.maxNumCandidates;
+    auto const* tokens = params.candidateTokens + bid * params.maxNumCandidates;
+    auto* treeCandidates = params.treeCandidateIndices + bid * params.maxDecodingTokens;
+    auto* treeParents = params.treeParents + bid * params.maxDecodingTokens;
+    auto* treeDepths = params.treeDepths + bid * params.maxDecodingTokens;
+
+    // Rank candidates by descending score. The root always goes first.
+    for (auto ci = static_cast<SizeType32>(threadIdx.x); ci < numCandidates; ci += static_cast<SizeType32>(blockDim.x))
+    {
+        SizeType32 rank = 0;
+        if (ci > 0)
+        {
+            auto const key = getCandidateKey(scores[ci]);
+            rank = 1;
+            for (SizeType32 cj = 1; cj < numCandidates; ++cj)
+            {
+                auto const otherKey = getCandidateKey(scores[cj]);
+                rank += (otherKey > key || (otherKey == key && cj < ci)) ? 1 : 0;
+            }
+        }
+        shOrder[rank] = ci;
+        shNodeIndices[ci] = -1;
+    }
+    __syncthreads();
+
+    if (threadIdx.x == 0)
+    {
+        shNodeIndices[0] = 0;
+        shHasChild[0] = 0;
+        treeCandidates[0] = 0;
+        treeParents[0] = -1;
+        treeDepths[0] = 0;
+
+        SizeType32 treeSize = 1;
+        SizeType32 numLeaves = 1;
+        for (SizeType32 ri = 1; ri < numCandidates && treeSize < params.maxDecodingTokens; ++ri)
+        {
+            auto const ci = shOrder[ri];
+            auto const parent = parents[ci];
+            if (parent < 0 || parent >= numCandidates || shNodeIndices[parent] < 0)
+            {
+                continue;
+            }
+            auto const parentNode = shNodeIndices[parent];
+            auto const depth = treeDepths[parentNode] + 1;
+            // Expanding a leaf keeps the number of paths, branching adds one.
+            auto const newPath = shHasChild[parentNode] != 0;
+            if (depth >= params.maxPathLength || (newPath && numLeaves == params.numPaths))
+            {
+                continue;
+            }
+            numLeaves += newPath ? 1 : 0;
+            shHasChild[parentNode] = 1;
+            shHasChild[treeSize] = 0;
+            shNodeIndices[ci] = treeSize;
+            treeCandidates[treeSize] = ci;
+            treeParents[treeSize] = parentNode;
+            treeDepths[treeSize] = depth;
+            ++treeSize;
+        }
+        shTreeSize = treeSize;
+        params.generationLengths[bid] = treeSize;
+    }
+    __syncthreads();
+
+    // Write one path per leaf, paths shorter than maxPathLength are padded with their leaf.
+    if (threadIdx.x == 0)
+    {
+        auto* pathTokens = params.nextDraftTokens + bid * params.numPaths * params.maxPathLength;
+        auto* pathIndices = params.nextDraftIndices + bid * params.numPaths * params.maxPathLength;
+        SizeType32 pi = 0;
+        for (SizeType32 ni = 0; ni < shTreeSize; ++ni)
+        {
+            if (shHasChild[ni])
+            {
+                continue;
+            }
+            auto* leafTokens = pathTokens + pi * params.maxPathLength;
+            auto* leafIndices = pathIndices + pi * params.maxPathLength;
+            for (auto node = ni; node >= 0; node = treeParents[node])
+            {
+                leafTokens[treeDepths[node]] = tokens[treeCandidates[node]];
+                leafIndices[treeDepths[node]] = node;
+            }
+            for (auto di = treeDepths[ni] + 1; di < params.maxPathLength; ++di)
+            {
+                leafTokens[di] = tokens[treeCandidates[ni]];
+                leafIndices[di] = ni;
+            }
+            ++pi;
+        }
+        for (; pi < params.numPaths; ++pi)
+        {
+            for (SizeType32 di = 0; di < params.maxPathLength; ++di)
+            {
+                pathTokens[pi * params.maxPathLength + di] = tokens[0];
+                pathIndices[pi * params.maxPathLength + di] = 0;
+            }
+        }
+    }
+}
+
+template <typename T>
+__global__ void packDynamicDraftTree(DynamicDraftTreeParams<T> params)
+{
+    auto const bid = static_cast<SizeType32>(blockIdx.x);
+    auto const treeSize = params.generationLengths[bid];
+    auto const startId = (bid == 0) ? 0 : params.generationLengthInclusiveSum[bid - 1];
+    auto const maxGenerationLength = params.maxGenerationLength[0];
+
+    auto const* tokens = params.candidateTokens + bid * params.maxNumCandidates;
+    auto const* treeCandidates = params.treeCandidateIndices + bid * params.maxDecodingTokens;
+    auto const* treeParents = params.treeParents + bid * params.maxDecodingTokens;
+    auto const* treeDepths = params.treeDepths + bid * params.maxDecodingTokens;
+    auto const basePosId = params.positionIdsBase[bid];
+
+    for (auto ti = static_cast<SizeType32>(threadIdx.x); ti < treeSize; ti += static_cast<SizeType32>(blockDim.x))
+    {
+        params.nextFlatTokens[startId + ti] = tokens[treeCandidates[ti]];
+        params.packedPosIds[startId + ti] = basePosId + treeDepths[ti];
+    }
+
+    // Each node attends to itself and its ancestors.
+    for (auto ti = static_cast<SizeType32>(threadIdx.x); ti < maxGenerationLength;
+         ti += static_cast<SizeType32>(blockDim.x))
+    {
+        auto* maskRow = params.masks + (bid * maxGenerationLength + ti) * maxGenerationLength;
+        for (SizeType32 tj = 0; tj < maxGenerationLength; ++tj)
+        {
+            maskRow[tj] = false;
+        }
+        if (ti < treeSize)
+        {
+            for (auto node = ti; node >= 0; node = treeParents[node])
+            {
+                maskRow[node] = true;
+            }
+        }
+    }
+}
+
+template <typename T>
+__global__ void gatherDynamicDraftTreeProbs(DynamicDraftTreeParams<T> params)
+{
+    auto const bid = static_cast<SizeType32>(blockIdx.x);
+    auto const maxDraftPathLength = params.maxPathLength - 1;
+    auto const pathIdx = static_cast<SizeType32>(blockIdx.y) / maxDraftPathLength;
+    auto const draftIdx = static_cast<SizeType32>(blockIdx.y) % maxDraftPathLength;
+    auto const batchSlot = params.batchSlots[bid];
+
+    auto const node = params.nextDraftIndices[(bid * params.numPaths + pathIdx) * params.maxPathLength + draftIdx + 1];
+    auto const candidateIdx = params.treeCandidateIndices[bid * params.maxDecodingTokens + node];
+    auto* dstPtr = params.outputDraftProbs
+        + (static_cast<uint64_t>(batchSlot * params.numPaths + pathIdx) * maxDraftPathLength + draftIdx)
+            * params.vocabSize;
+    T const* srcPtr = params.candidateProbs
+        ? params.candidateProbs
+            + static_cast<uint64_t>(bid * params.maxNumCandidates + candidateIdx) * params.vocabSize
+        : nullptr;
+    for (auto vi = static_cast<SizeType32>(threadIdx.x); vi < params.vocabSize;
+         vi += static_cast<SizeType32>(blockDim.x))
+    {
+        dstPtr[vi] = srcPtr ? srcPtr[vi] : static_cast<T>(0.f);
+    }
+}
+} // namespace
+
+template <typename T>
+void invokeBuildDynamicDraftTree(DynamicDraftTreeParams<T> const& params, cudaStream_t stream)
+{
+    SizeType32 constexpr BLOCK_SIZE = 256;
+    auto const shmSize = (2 * params.maxNumCandidates + params.maxDecodingTokens) * sizeof(SizeType32);
+    buildDynamicDraftTree<<<params.batchSize, BLOCK_SIZE, shmSize, stream>>>(params);
+}
+
+template void invokeBuildDynamicDraftTree(DynamicDraftTreeParams<float> const& params, cudaStream_t stream);
+template void invokeBuildDynamicDraftTree(DynamicDraftTreeParams<half> const& params, cudaStream_t stream);
+#if ENABLE_BF16
+template void invokeBuildDynamicDraftTree(DynamicDraftTreeParams<__nv_bfloat16> const& params, cudaStream_t stream);
+#endif // ENABLE_BF16
+
+template <typename T>
+void invokePackDynamicDraftTree(DynamicDraftTreeParams<T> const& params, cudaStream_t stream)
+{
+    SizeType32 constexpr BLOCK_SIZE = 128;
+    packDynamicDraftTree<<<params.batchSize, BLOCK_SIZE, 0, stream>>>(params);
+
+    SizeType32 constexpr PROBS_BLOCK_SIZE = 256;
+    dim3 const grid(params.batchSize, params.numPaths * (params.maxPathLength - 1));
+    gatherDynamicDraftTreeProbs<<<grid, PROBS_BLOCK_SIZE, 0, stream>>>(params);
+}
+
+template void invokePackDynamicDraftTree(DynamicDraftTreeParams<float> const& params, cudaStream_t stream);
+template void invokePackDynamicDraftTree(DynamicDraftTreeParams<half> const& params, cudaStream_t stream);
+#if ENABLE_BF16
+template void invokePackDynamicDraftTree(DynamicDraftTreeParams<__nv_bfloat16> const& params, cudaStream_t stream);
+#endif // ENABLE_BF16
+
 namespace
 {
 template <typename T>
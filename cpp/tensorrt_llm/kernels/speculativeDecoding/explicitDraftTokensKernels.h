@@ -17,10 +17,10 @@
 #pragma once
 
 #include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/kernels/philoxRandom.h"
 #include "tensorrt_llm/runtime/common.h"
 #include <cuda_fp16.h>
 #include <cuda_runtime.h>
-#include <curand_kernel.h>
 
 namespace tensorrt_llm::kernels::speculative_decoding
 {
@@ -33,7 +33,7 @@ struct FillRandDataExplicitDraftTokensParams
     //! [maxBatchSize, maxNumPaths, maxPathDraftLength]
     T* randDataVerification{nullptr};
     //! [maxBatchSize]
-    curandState_t* curandState{nullptr};
+    RandomState* randomState{nullptr};
     //! [forwardBatchSize]
     runtime::SizeType32 const* batchSlots{nullptr};
 
@@ -47,7 +47,7 @@ struct FillRandDataExplicitDraftTokensParams
     {
         TLLM_CHECK(randDataSample);
         TLLM_CHECK(randDataVerification);
-        TLLM_CHECK(curandState);
+        TLLM_CHECK(randomState);
 
         TLLM_CHECK(batchSize > 0);
         TLLM_CHECK(numPaths > 0);
@@ -68,7 +68,7 @@ struct FillContextExplicitDraftTokensParams
     //! [maxBatchSize]
     float const* inputTemperatures{nullptr};
     //! [maxBatchSize]
-    curandState_t* curandState{nullptr};
+    RandomState* randomState{nullptr};
     //! [forwardBatchSize]
     runtime::SizeType32 const* batchSlots{nullptr};
 
@@ -79,7 +79,7 @@ struct FillContextExplicitDraftTokensParams
         TLLM_CHECK(randDataSample);
         TLLM_CHECK(outputTemperatures);
         TLLM_CHECK(inputTemperatures);
-        TLLM_CHECK(curandState);
+        TLLM_CHECK(randomState);
         TLLM_CHECK(batchSlots);
 
         TLLM_CHECK(batchSize > 0);
@@ -156,7 +156,7 @@ struct ExtractExplicitDraftTokensParams
     //! [maxBatchSize]
     float const* inputTemperatures{nullptr};
     //! [maxBatchSize]
-    curandState_t* curandState{nullptr};
+    RandomState* randomState{nullptr};
     runtime::SizeType32 batchSize{0};
     runtime::SizeType32 numPaths{0};
     runtime::SizeType32 maxPathLength{0};
@@ -179,7 +179,6 @@ struct ExtractExplicitDraftTokensParams
         TLLM_CHECK(inputTemperatures);
 
         TLLM_CHECK(outputDraftProbs);
-        TLLM_CHECK(nextDraftProbs);
 
         TLLM_CHECK(outputNextDraftTokens);
         TLLM_CHECK(unpackedNextDraftTokens);
@@ -192,7 +191,7 @@ struct ExtractExplicitDraftTokensParams
         TLLM_CHECK(bestPathIndices);
         TLLM_CHECK(outputBestPathIndices);
 
-        TLLM_CHECK(curandState);
+        TLLM_CHECK(randomState);
         TLLM_CHECK(batchSlots);
         TLLM_CHECK(nextDraftTokens);
         TLLM_CHECK(nextFlatTokens);
@@ -232,6 +231,110 @@ void invokeExtractExplicitDraftTokens(ExtractExplicitDraftTokensParams<T> const&
 template <typename T>
 void invokeCopyProbs(ExtractExplicitDraftTokensParams<T> const& params, cudaStream_t stream);
 
+template <typename T>
+struct DynamicDraftTreeParams
+{
+    //! Tokens proposed by the draft head. Candidate 0 is the root of the tree, i.e. the token accepted at this step.
+    //! [forwardBatchSize, maxNumCandidates]
+    runtime::TokenIdType const* candidateTokens{nullptr};
+    //! Cumulative log probs of the candidates along their paths from the root.
+    //! [forwardBatchSize, maxNumCandidates]
+    float const* candidateScores{nullptr};
+    //! Index of the parent candidate, parents precede their children. Ignored for the root.
+    //! [forwardBatchSize, maxNumCandidates]
+    runtime::SizeType32 const* candidateParents{nullptr};
+    //! Number of valid candidates per request, optional. maxNumCandidates if not set.
+    //! [forwardBatchSize]
+    runtime::SizeType32 const* numCandidates{nullptr};
+    //! Draft distributions the candidates were sampled from, optional. Zero probs are written if not set.
+    //! [forwardBatchSize, maxNumCandidates, vocabSize]
+    T const* candidateProbs{nullptr};
+    //! [forwardBatchSize]
+    runtime::SizeType32 const* positionIdsBase{nullptr};
+    //! [forwardBatchSize]
+    runtime::SizeType32 const* batchSlots{nullptr};
+
+    //! Candidate index of each tree node. Nodes are ordered such that parents precede their children.
+    //! [forwardBatchSize, maxDecodingTokens]
+    runtime::SizeType32* treeCandidateIndices{nullptr};
+    //! Node index of the parent of each tree node, -1 for the root.
+    //! [forwardBatchSize, maxDecodingTokens]
+    runtime::SizeType32* treeParents{nullptr};
+    //! [forwardBatchSize, maxDecodingTokens]
+    runtime::SizeType32* treeDepths{nullptr};
+    //! Number of tree nodes.
+    //! [forwardBatchSize]
+    runtime::SizeType32* generationLengths{nullptr};
+    //! One path from the root to each leaf of the tree. Unused paths point to the root.
+    //! [forwardBatchSize, maxNumPaths, maxPathLength]
+    runtime::TokenIdType* nextDraftTokens{nullptr};
+    //! [forwardBatchSize, maxNumPaths, maxPathLength]
+    runtime::SizeType32* nextDraftIndices{nullptr};
+
+    //! [forwardBatchSize]
+    runtime::SizeType32 const* generationLengthInclusiveSum{nullptr};
+    //! [1]
+    runtime::SizeType32 const* maxGenerationLength{nullptr};
+    //! [forwardBatchSize * maxDecodingTokens]
+    runtime::TokenIdType* nextFlatTokens{nullptr};
+    //! [forwardBatchSize * maxDecodingTokens]
+    runtime::SizeType32* packedPosIds{nullptr};
+    //! [forwardBatchSize, maxGenerationLength, maxGenerationLength]
+    bool* masks{nullptr};
+    //! [maxBatchSize, maxNumPaths, maxPathDraftLength, vocabSize]
+    T* outputDraftProbs{nullptr};
+
+    runtime::SizeType32 batchSize{0};
+    runtime::SizeType32 maxNumCandidates{0};
+    runtime::SizeType32 numPaths{0};
+    runtime::SizeType32 maxPathLength{0};
+    runtime::SizeType32 maxDecodingTokens{0};
+    runtime::SizeType32 vocabSize{0};
+
+    void checkParams() const
+    {
+        TLLM_CHECK(candidateTokens);
+        TLLM_CHECK(candidateScores);
+        TLLM_CHECK(candidateParents);
+        TLLM_CHECK(positionIdsBase);
+        TLLM_CHECK(batchSlots);
+
+        TLLM_CHECK(treeCandidateIndices);
+        TLLM_CHECK(treeParents);
+        TLLM_CHECK(treeDepths);
+        TLLM_CHECK(generationLengths);
+        TLLM_CHECK(nextDraftTokens);
+        TLLM_CHECK(nextDraftIndices);
+
+        TLLM_CHECK(generationLengthInclusiveSum);
+        TLLM_CHECK(maxGenerationLength);
+        TLLM_CHECK(nextFlatTokens);
+        TLLM_CHECK(packedPosIds);
+        TLLM_CHECK(masks);
+        TLLM_CHECK(outputDraftProbs);
+
+        TLLM_CHECK(batchSize > 0);
+        TLLM_CHECK(maxNumCandidates > 0 && maxNumCandidates <= 4096);
+        TLLM_CHECK(numPaths > 0);
+        TLLM_CHECK(maxPathLength > 1);
+        TLLM_CHECK(maxDecodingTokens > 0 && maxDecodingTokens <= numPaths * (maxPathLength - 1) + 1);
+        TLLM_CHECK(vocabSize > 0);
+    }
+};
+
+//! @brief Builds the draft tree for the next step from the candidates expanded by the draft head (EAGLE-2 style).
+//! Keeps the candidates with the highest cumulative scores, ties broken by the lower index, as long as their parent is
+//! kept, the tree has at most `maxDecodingTokens` nodes, `maxPathLength` levels and `numPaths` leaves. Writes the tree
+//! to `tree*`, its size to `generationLengths` and the root-to-leaf paths to `nextDraftTokens` and `nextDraftIndices`.
+template <typename T>
+void invokeBuildDynamicDraftTree(DynamicDraftTreeParams<T> const& params, cudaStream_t stream);
+
+//! @brief Packs the tree built by invokeBuildDynamicDraftTree into the layout of the ExplicitDraftTokens network
+//! outputs: `nextFlatTokens` and `packedPosIds` at `generationLengthInclusiveSum` offsets and boolean ancestor `masks`.
+//! Gathers the draft probs of the path tokens to `outputDraftProbs` at batch slots.
+template <typename T>
+void invokePackDynamicDraftTree(DynamicDraftTreeParams<T> const& params, cudaStream_t stream);
+
 template <typename T>
 struct PackExplicitDraftTokensParams
 {
@@ -93,7 +93,7 @@ namespace
 {
 template <typename T>
 __global__ void acceptDraftTokensByLogitsKernel(T const* draftProbs, T* targetProbs, SizeType32 const* numsDraftTokens,
-    FinishedState* finished, curandState_t* curandState, SizeType32 const* batchSlots, SizeType32 batchSize,
+    FinishedState* finished, RandomState* randomState, SizeType32 const* batchSlots, SizeType32 batchSize,
     SizeType32 maxBatchSize, SizeType32 maxDraftTokens, SizeType32 beamWidth, SizeType32 vocabSize,
     bool randomThreshold, float constantThreshold)
 {
@@ -120,7 +120,7 @@ __global__ void acceptDraftTokensByLogitsKernel(T const* draftProbs, T* targetPr
     __shared__ float threshold;
     if (threadIdx.x == 0)
     {
-        threshold = randomThreshold ? curand_uniform(curandState + batchSlot) : constantThreshold;
+        threshold = randomThreshold ? randomUniform(randomState + batchSlot) : constantThreshold;
     }
     __syncthreads();
 
@@ -219,7 +219,7 @@ __global__ void correctAcceptedStatesAndLogits(T const* draftProbs, T* targetPro
 
 template <typename T>
 void acceptDraftTokensByLogits(T* draftLogits, T** targetLogits, T* draftProbs, T* targetProbs,
-    SizeType32 const* numsDraftTokens, FinishedState* finished, curandState_t* curandState,
+    SizeType32 const* numsDraftTokens, FinishedState* finished, RandomState* randomState,
     SizeType32 const* batchSlots, SizeType32 batchSize, SizeType32 maxBatchSize, SizeType32 beamWidth,
     SizeType32 vocabSize, SizeType32 vocabSizePadded, SizeType32 maxDraftTokens, bool randomThreshold,
     float constantThreshold, cudaStream_t stream)
@@ -239,7 +239,7 @@ void acceptDraftTokensByLogits(T* draftLogits, T** targetLogits, T* draftProbs,
         dim3 block(1024);
         dim3 grid(batchSize * beamWidth, maxDraftTokens);
         acceptDraftTokensByLogitsKernel<<<grid, block, 0, stream>>>(draftProbs, targetProbs, numsDraftTokens, finished,
-            curandState, batchSlots, batchSize, maxBatchSize, maxDraftTokens, beamWidth, vocabSizePadded,
+            randomState, batchSlots, batchSize, maxBatchSize, maxDraftTokens, beamWidth, vocabSizePadded,
             randomThreshold, constantThreshold);
     }
     {
@@ -251,12 +251,12 @@ void acceptDraftTokensByLogits(T* draftLogits, T** targetLogits, T* draftProbs,
 }
 
 template void acceptDraftTokensByLogits(float* draftLogits, float** targetLogits, float* draftProbs, float* targetProbs,
-    SizeType32 const* numsDraftTokens, FinishedState* finished, curandState_t* curandState,
+    SizeType32 const* numsDraftTokens, FinishedState* finished, RandomState* randomState,
     SizeType32 const* batchSlots, SizeType32 batchSize, SizeType32 maxBatchSize, SizeType32 beamWidth,
     SizeType32 vocabSize, SizeType32 vocabSizePadded, SizeType32 maxDraftTokens, bool randomThreshold,
     float constantThreshold, cudaStream_t stream);
 template void acceptDraftTokensByLogits(half* draftLogits, half** targetLogits, half* draftProbs, half* targetProbs,
-    SizeType32 const* numsDraftTokens, FinishedState* finished, curandState_t* curandState,
+    SizeType32 const* numsDraftTokens, FinishedState* finished, RandomState* randomState,
     SizeType32 const* batchSlots, SizeType32 batchSize, SizeType32 maxBatchSize, SizeType32 beamWidth,
     SizeType32 vocabSize, SizeType32 vocabSizePadded, SizeType32 maxDraftTokens, bool randomThreshold,
     float constantThreshold, cudaStream_t stream);
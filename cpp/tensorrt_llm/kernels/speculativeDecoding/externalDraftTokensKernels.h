@@ -17,11 +17,11 @@
 #pragma once
 
 #include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/philoxRandom.h"
 #include "tensorrt_llm/kernels/speculativeDecoding/common.h"
 #include "tensorrt_llm/runtime/common.h"
 #include <cuda_fp16.h>
 #include <cuda_runtime.h>
-#include <curand_kernel.h>
 
 namespace tensorrt_llm::kernels::speculative_decoding
 {
@@ -74,8 +74,8 @@ void invokeAcceptDraftTokensByIds(runtime::TokenIdType const* draftIds, runtime:
 //! \param numsDraftTokens input buffer [batchSize]. Number of draft tokens per request
 //! \param finished output buffer [draftTokens, batchSize, beamWidth].
 //! At each step sets to NOT_FINISHED if token is accepted or SKIP_DECODING if token is not accepted
-//! \param curandState input buffer [batchSize]. Curand states properly
-//! initialized using invokeCurandInitialize per request.
+//! \param randomState input buffer [batchSize]. Random states properly
+//! initialized using invokeRandomStateInitialize per request.
 //! \param batchSlots input buffer [batchSize], address map from local index
 //! to global index [0, batchSize] -> [0, maxBatchSize]
 //! \param batchSize current batch size
@@ -89,7 +89,7 @@ void invokeAcceptDraftTokensByIds(runtime::TokenIdType const* draftIds, runtime:
 //! \param stream stream
 template <typename T>
 void acceptDraftTokensByLogits(T* draftLogits, T** targetLogits, T* draftProbs, T* targetProbs,
-    runtime::SizeType32 const* numsDraftTokens, FinishedState* finished, curandState_t* curandState,
+    runtime::SizeType32 const* numsDraftTokens, FinishedState* finished, RandomState* randomState,
     runtime::SizeType32 const* batchSlots, runtime::SizeType32 batchSize, runtime::SizeType32 maxBatchSize,
     runtime::SizeType32 beamWidth, runtime::SizeType32 vocabSize, runtime::SizeType32 vocabSizePadded,
     runtime::SizeType32 maxDraftTokens, bool randomThreshold, float constantThreshold, cudaStream_t stream);
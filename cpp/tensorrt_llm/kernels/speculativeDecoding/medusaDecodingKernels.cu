@@ -46,7 +46,7 @@ __global__ void acceptDraftTokensByIdsWithPaths(TokenIdType* outputIds, TokenIdT
     FinishedState* finishedFinal, SizeType32 const* batchSlots, SizeType32 const* paths, TokenIdType const* endIds,
     T const** medusaLogits, T const** logitsPtrs, SizeType32* curTokensPerStep, SizeType32 const* targetTokensPerStep,
     SizeType32* bestPathIds, SizeType32 batchSize, SizeType32 vocabSize, SizeType32 maxBatchSize, SizeType32 maxSeqLen,
-    SizeType32 maxNumHeads, SizeType32 maxDecodingTokens)
+    SizeType32 maxNumHeads, SizeType32 maxDecodingTokens, MedusaAcceptanceParams<T> acceptanceParams)
 {
     auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
     auto const batchSlot = batchSlots[batchIdx];
@@ -54,6 +54,8 @@ __global__ void acceptDraftTokensByIdsWithPaths(TokenIdType* outputIds, TokenIdT
     auto const endId = endIds[batchSlot];
     auto const numTokensPerStep = curTokensPerStep[batchSlot];
     auto const maxNumDraftTokens = maxNumHeads + 1;
+    auto const isTypical = acceptanceParams.modes != nullptr
+        && acceptanceParams.modes[batchSlot] == MedusaAcceptanceMode::kTYPICAL;
 
     int4 partialMax{-1, -1, 0, 0};
     // Go over different paths and construct implicit sequences
@@ -90,8 +92,17 @@ __global__ void acceptDraftTokensByIdsWithPaths(TokenIdType* outputIds, TokenIdT
             // In context phase, no draft tokens are given. Set draft token to -1 to get guaranteed rejection
             auto const draftToken = tokenId >= numTokensPerStep ? -1 : draftIds[draftTokenIdx];
             // Check if draft tokens are the same as target tokens
-            bool const accepted = draftToken == targetToken;
-            hasEnd = targetToken == endId;
+            bool accepted = draftToken == targetToken;
+            if (isTypical && !accepted && draftToken >= 0)
+            {
+                // Accept draft tokens that are plausible under the target distribution of the parent node
+                auto const parentRow = flat_index2(batchSlot, nextIdx, maxDecodingTokens);
+                auto const logit = static_cast<float>(acceptanceParams.logits[flat_index3(
+                    batchIdx, nextIdx, draftToken, maxDecodingTokens, acceptanceParams.vocabSizePadded)]);
+                accepted = __expf(logit - acceptanceParams.logNormalizers[parentRow])
+                    > acceptanceParams.thresholds[parentRow];
+            }
+            hasEnd = (accepted ? draftToken : targetToken) == endId;
             if (!accepted || hasEnd)
             {
                 acceptedLength = hasEnd ? ti - 1 : ti;
@@ -125,24 +136,32 @@ __global__ void acceptDraftTokensByIdsWithPaths(TokenIdType* outputIds, TokenIdT
 
     auto const acceptedLength = totalShared.x;
     auto const bestPathIdx = totalShared.y;
+    auto const bestPathHasEnd = totalShared.z;
     auto const bestNextIdx = numTokensPerStep == 1 ? 0 : totalShared.w;
     auto const pathOffset = flat_index3(batchSlot, bestPathIdx, 0, maxDecodingTokens, maxNumDraftTokens);
     for (auto ti = static_cast<SizeType32>(threadIdx.x); ti < acceptedLength; ti += static_cast<SizeType32>(blockDim.x))
     {
-        auto const tokenId = paths[pathOffset + ti];
-        auto const targetSrcTokenIdx = batchSlot * maxDecodingTokens + tokenId;
         auto const outputTokenIdx = batchSlot * maxSeqLen + inputLength + ti;
-        auto const targetToken = targetIds[targetSrcTokenIdx];
-        // Copy accepted tokens to the sequence with draft tokens (outputIds === outputIds)
-        outputIds[outputTokenIdx] = targetToken;
+        // Copy accepted tokens to the sequence with draft tokens (outputIds === outputIds).
+        // With typical acceptance, accepted draft tokens may differ from the target tokens of their parents.
+        // Unless the path ended with EOS, the last token is the target token after the last accepted draft token
+        if (ti + 1 < acceptedLength || bestPathHasEnd)
+        {
+            auto const draftTokenId = paths[pathOffset + ti + 1];
+            outputIds[outputTokenIdx] = draftIds[batchSlot * (maxDecodingTokens - 1) + draftTokenId - 1];
+        }
+        else
+        {
+            auto const tokenId = paths[pathOffset + ti];
+            outputIds[outputTokenIdx] = targetIds[batchSlot * maxDecodingTokens + tokenId];
+        }
     }
 
     // Leading thread reconstructs winning path and sets new data
     if (threadIdx.x == 0)
     {
-        auto const hasEnd = totalShared.z;
         // Set end condition
-        if (hasEnd)
+        if (bestPathHasEnd)
         {
             finishedFinal[batchSlot].setFinishedEOS();
         }
@@ -172,7 +191,7 @@ void acceptDraftTokensByIdsWithPaths(TokenIdType* outputIds, TokenIdType const*
     SizeType32 const* batchSlots, SizeType32 const* paths, TokenIdType const* endIds, T const** medusaLogits,
     T const** logitsPtrs, SizeType32* curTokensPerStep, SizeType32 const* targetTokensPerStep, SizeType32* bestPathIds,
     SizeType32 batchSize, SizeType32 vocabSize, SizeType32 maxBatchSize, SizeType32 maxSeqLen, SizeType32 maxNumHeads,
-    SizeType32 maxDecodingTokens, cudaStream_t stream)
+    SizeType32 maxDecodingTokens, MedusaAcceptanceParams<T> const& acceptanceParams, cudaStream_t stream)
 {
     constexpr SizeType32 BLOCK_SIZE = 256;
     dim3 block(BLOCK_SIZE);
@@ -180,7 +199,7 @@ void acceptDraftTokensByIdsWithPaths(TokenIdType* outputIds, TokenIdType const*
     acceptDraftTokensByIdsWithPaths<T, BLOCK_SIZE><<<grid, block, 0, stream>>>(outputIds, draftIds, targetIds,
         sequenceLengths, acceptedLengths, finishedFinal, batchSlots, paths, endIds, medusaLogits, logitsPtrs,
         curTokensPerStep, targetTokensPerStep, bestPathIds, batchSize, vocabSize, maxBatchSize, maxSeqLen, maxNumHeads,
-        maxDecodingTokens);
+        maxDecodingTokens, acceptanceParams);
 }
 
 template void acceptDraftTokensByIdsWithPaths(TokenIdType* outputIds, TokenIdType const* draftIds,
@@ -189,17 +208,124 @@ template void acceptDraftTokensByIdsWithPaths(TokenIdType* outputIds, TokenIdTyp
     float const** medusaLogits, float const** logitsPtrs, SizeType32* curTokensPerStep,
     SizeType32 const* targetTokensPerStep, SizeType32* bestPathIds, SizeType32 batchSize, SizeType32 vocabSize,
     SizeType32 maxBatchSize, SizeType32 maxSeqLen, SizeType32 maxNumHeads, SizeType32 maxDecodingTokens,
-    cudaStream_t stream);
+    MedusaAcceptanceParams<float> const& acceptanceParams, cudaStream_t stream);
 template void acceptDraftTokensByIdsWithPaths(TokenIdType* outputIds, TokenIdType const* draftIds,
     TokenIdType const* targetIds, SizeType32* sequenceLengths, SizeType32* acceptedLengths,
     FinishedState* finishedFinal, SizeType32 const* batchSlots, SizeType32 const* paths, TokenIdType const* endIds,
     half const** medusaLogits, half const** logitsPtrs, SizeType32* curTokensPerStep,
     SizeType32 const* targetTokensPerStep, SizeType32* bestPathIds, SizeType32 batchSize, SizeType32 vocabSize,
     SizeType32 maxBatchSize, SizeType32 maxSeqLen, SizeType32 maxNumHeads, SizeType32 maxDecodingTokens,
-    cudaStream_t stream);
+    MedusaAcceptanceParams<half> const& acceptanceParams, cudaStream_t stream);
 
 namespace
 {
+template <typename T, SizeType32 BLOCK_SIZE>
+__global__ void computeMedusaAcceptanceStats(TokenIdType* targetIds, float* logNormalizers, float* thresholds,
+    T const* logits, MedusaAcceptanceMode const* modes, float const* typicalEpsilons, float const* typicalAlphas,
+    SizeType32 const* tokensPerStep, RandomState* randomState, SizeType32 const* batchSlots,
+    SizeType32 maxDecodingTokens, SizeType32 vocabSize, SizeType32 vocabSizePadded)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = batchSlots[batchIdx];
+    auto const mode = modes[batchSlot];
+    if (mode == MedusaAcceptanceMode::kEXACT_MATCH)
+    {
+        return;
+    }
+
+    typedef cub::BlockReduce<float, BLOCK_SIZE> BlockReduce;
+    typedef cub::BlockScan<float, BLOCK_SIZE> BlockScan;
+    __shared__ union
+    {
+        typename BlockReduce::TempStorage reduce;
+        typename BlockScan::TempStorage scan;
+    } tempStorage;
+    __shared__ float rowMaxShared;
+    __shared__ float sampleMassShared;
+
+    auto const numRows = tokensPerStep[batchSlot];
+    for (SizeType32 ri = 0; ri < numRows; ++ri)
+    {
+        auto const* rowLogits = logits + flat_index3(batchIdx, ri, 0, maxDecodingTokens, vocabSizePadded);
+
+        float localMax = -FLT_MAX;
+        for (auto vi = static_cast<SizeType32>(threadIdx.x); vi < vocabSize; vi += BLOCK_SIZE)
+        {
+            localMax = max(localMax, static_cast<float>(rowLogits[vi]));
+        }
+        float const rowMax = BlockReduce(tempStorage.reduce).Reduce(localMax, cub::Max());
+        if (threadIdx.x == 0)
+        {
+            rowMaxShared = rowMax;
+        }
+        __syncthreads();
+
+        // Sum of exp(logit - max) and sum of exp(logit - max) * (logit - max) for the entropy
+        float localSum = 0.f;
+        float localWeightedSum = 0.f;
+        for (auto vi = static_cast<SizeType32>(threadIdx.x); vi < vocabSize; vi += BLOCK_SIZE)
+        {
+            auto const diff = static_cast<float>(rowLogits[vi]) - rowMaxShared;
+            auto const weight = __expf(diff);
+            if (weight > 0.f)
+            {
+                localSum += weight;
+                localWeightedSum += weight * diff;
+            }
+        }
+
+        auto const rowIdx = flat_index2(batchSlot, ri, maxDecodingTokens);
+        if (mode == MedusaAcceptanceMode::kTYPICAL)
+        {
+            float const sum = BlockReduce(tempStorage.reduce).Sum(localSum);
+            __syncthreads();
+            float const weightedSum = BlockReduce(tempStorage.reduce).Sum(localWeightedSum);
+            if (threadIdx.x == 0)
+            {
+                auto const logSum = __logf(sum);
+                // H = -sum(p * log(p)) = log(sum) - sum(w * diff) / sum
+                auto const entropy = logSum - weightedSum / sum;
+                logNormalizers[rowIdx] = rowMaxShared + logSum;
+                thresholds[rowIdx] = min(typicalEpsilons[batchSlot], typicalAlphas[batchSlot] * __expf(-entropy));
+            }
+        }
+        else
+        {
+            // Inverse transform sampling over the strided partition of the vocabulary across threads
+            float prefix;
+            float total;
+            BlockScan(tempStorage.scan).ExclusiveSum(localSum, prefix, total);
+            if (threadIdx.x == 0)
+            {
+                // randomUniform returns (0, 1]
+                sampleMassShared = randomUniform(randomState + batchSlot) * total;
+            }
+            __syncthreads();
+            auto const sampleMass = sampleMassShared;
+            if (localSum > 0.f && prefix < sampleMass && sampleMass <= prefix + localSum)
+            {
+                auto mass = prefix;
+                SizeType32 selected = -1;
+                for (auto vi = static_cast<SizeType32>(threadIdx.x); vi < vocabSize; vi += BLOCK_SIZE)
+                {
+                    auto const weight = __expf(static_cast<float>(rowLogits[vi]) - rowMaxShared);
+                    if (weight > 0.f)
+                    {
+                        selected = vi;
+                        mass += weight;
+                        if (mass >= sampleMass)
+                        {
+                            break;
+                        }
+                    }
+                }
+                targetIds[rowIdx] = selected;
+            }
+        }
+        __syncthreads();
+    }
+}
+
 __global__ void scatterMedusaDraftTokens(TokenIdType* treeDraftIds, TokenIdType const* sourceDraftIds,
     SizeType32 const* treeIds, SizeType32 const* tokensPerStepData, SizeType32 const* batchSlots,
     SizeType32 maxDecodingTokens)
@@ -217,8 +343,53 @@ __global__ void scatterMedusaDraftTokens(TokenIdType* treeDraftIds, TokenIdType
         treeDraftIds[treeDraftIdx] = sourceDraftIds[sourceDraftIdx];
     }
 }
+
+__global__ void countAcceptedTreeNodes(SizeType32* nodeAcceptCounts, SizeType32 const* acceptedLengths,
+    SizeType32 const* bestPathIds, SizeType32 const* paths, SizeType32 const* batchSlots, SizeType32 batchSize,
+    SizeType32 maxDecodingTokens, SizeType32 maxPathLen)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x * blockDim.x + threadIdx.x);
+    if (batchIdx >= batchSize)
+    {
+        return;
+    }
+    auto const batchSlot = batchSlots[batchIdx];
+    auto const numAcceptedNodes = min(acceptedLengths[batchSlot], maxPathLen);
+    auto const pathIdx = flat_index3(batchSlot, bestPathIds[batchSlot], 0, maxDecodingTokens, maxPathLen);
+    atomicAdd(&nodeAcceptCounts[0], 1);
+    // The first node of a path is the root, its accepted draft nodes follow
+    for (SizeType32 ti = 1; ti < numAcceptedNodes; ++ti)
+    {
+        auto const nodeIdx = paths[pathIdx + ti];
+        if (nodeIdx > 0 && nodeIdx < maxDecodingTokens)
+        {
+            atomicAdd(&nodeAcceptCounts[nodeIdx], 1);
+        }
+    }
+}
 } // namespace
 
+template <typename T>
+void invokeComputeMedusaAcceptanceStats(TokenIdType* targetIds, float* logNormalizers, float* thresholds,
+    T const* logits, MedusaAcceptanceMode const* modes, float const* typicalEpsilons, float const* typicalAlphas,
+    SizeType32 const* tokensPerStep, RandomState* randomState, SizeType32 const* batchSlots, SizeType32 batchSize,
+    SizeType32 maxDecodingTokens, SizeType32 vocabSize, SizeType32 vocabSizePadded, cudaStream_t stream)
+{
+    constexpr SizeType32 BLOCK_SIZE = 256;
+    computeMedusaAcceptanceStats<T, BLOCK_SIZE><<<batchSize, BLOCK_SIZE, 0, stream>>>(targetIds, logNormalizers,
+        thresholds, logits, modes, typicalEpsilons, typicalAlphas, tokensPerStep, randomState, batchSlots,
+        maxDecodingTokens, vocabSize, vocabSizePadded);
+}
+
+template void invokeComputeMedusaAcceptanceStats(TokenIdType* targetIds, float* logNormalizers, float* thresholds,
+    float const* logits, MedusaAcceptanceMode const* modes, float const* typicalEpsilons, float const* typicalAlphas,
+    SizeType32 const* tokensPerStep, RandomState* randomState, SizeType32 const* batchSlots, SizeType32 batchSize,
+    SizeType32 maxDecodingTokens, SizeType32 vocabSize, SizeType32 vocabSizePadded, cudaStream_t stream);
+template void invokeComputeMedusaAcceptanceStats(TokenIdType* targetIds, float* logNormalizers, float* thresholds,
+    half const* logits, MedusaAcceptanceMode const* modes, float const* typicalEpsilons, float const* typicalAlphas,
+    SizeType32 const* tokensPerStep, RandomState* randomState, SizeType32 const* batchSlots, SizeType32 batchSize,
+    SizeType32 maxDecodingTokens, SizeType32 vocabSize, SizeType32 vocabSizePadded, cudaStream_t stream);
+
 void scatterMedusaDraftTokens(TokenIdType* treeDraftIds, TokenIdType const* sourceDraftIds, SizeType32 const* treeIds,
     SizeType32 const* tokensPerStep, SizeType32 const* batchSlots, SizeType32 maxDecodingTokens, SizeType32 batchSize,
     cudaStream_t stream)
@@ -227,4 +398,13 @@ void scatterMedusaDraftTokens(TokenIdType* treeDraftIds, TokenIdType const* sour
     scatterMedusaDraftTokens<<<batchSize, BLOCK_SIZE, 0, stream>>>(
         treeDraftIds, sourceDraftIds, treeIds, tokensPerStep, batchSlots, maxDecodingTokens);
 }
+
+void invokeCountAcceptedTreeNodes(SizeType32* nodeAcceptCounts, SizeType32 const* acceptedLengths,
+    SizeType32 const* bestPathIds, SizeType32 const* paths, SizeType32 const* batchSlots, SizeType32 batchSize,
+    SizeType32 maxDecodingTokens, SizeType32 maxPathLen, cudaStream_t stream)
+{
+    constexpr SizeType32 BLOCK_SIZE = 128;
+    countAcceptedTreeNodes<<<divUp(batchSize, BLOCK_SIZE), BLOCK_SIZE, 0, stream>>>(nodeAcceptCounts, acceptedLengths,
+        bestPathIds, paths, batchSlots, batchSize, maxDecodingTokens, maxPathLen);
+}
 } // namespace tensorrt_llm::kernels::speculative_decoding
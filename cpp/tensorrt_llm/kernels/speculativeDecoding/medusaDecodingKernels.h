@@ -17,15 +17,46 @@
 #pragma once
 
 #include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/philoxRandom.h"
 #include "tensorrt_llm/kernels/speculativeDecoding/common.h"
 #include "tensorrt_llm/runtime/common.h"
 #include <cuda_fp16.h>
 #include <cuda_runtime.h>
-#include <curand_kernel.h>
 
 namespace tensorrt_llm::kernels::speculative_decoding
 {
 
+//! \brief Verification of Medusa draft tokens against the target distribution of their parent tree node
+enum class MedusaAcceptanceMode : runtime::SizeType32
+{
+    //! Draft token is accepted if it is equal to the token sampled from the target logits with top-K
+    kEXACT_MATCH = 0,
+    //! Draft token is accepted if its target probability exceeds min(epsilon, alpha * exp(-H)), where H is the entropy
+    //! of the target distribution. The token after the last accepted one is the sampled target token
+    kTYPICAL = 1,
+    //! Target tokens are sampled from the full target distribution and matched against the draft tokens. For the
+    //! deterministic draft tokens of Medusa, this is rejection sampling: each tree node keeps the target distribution
+    kREJECTION = 2,
+};
+
+//! \brief Per request verification state passed to acceptDraftTokensByIdsWithPaths.
+//! Only needed when some request does not use MedusaAcceptanceMode::kEXACT_MATCH.
+template <typename T>
+struct MedusaAcceptanceParams
+{
+    //! input buffer [batchSize, maxDecodingTokens, vocabSizePadded], target logits of the tree nodes
+    T const* logits{nullptr};
+    //! input buffer [maxBatchSize], MedusaAcceptanceMode per request
+    MedusaAcceptanceMode const* modes{nullptr};
+    //! input buffer [maxBatchSize, maxDecodingTokens], log of the softmax denominator of each target row.
+    //! Filled by invokeComputeMedusaAcceptanceStats for kTYPICAL requests
+    float const* logNormalizers{nullptr};
+    //! input buffer [maxBatchSize, maxDecodingTokens], typical acceptance threshold of each target row.
+    //! Filled by invokeComputeMedusaAcceptanceStats for kTYPICAL requests
+    float const* thresholds{nullptr};
+    runtime::SizeType32 vocabSizePadded{0};
+};
+
 //! \brief verifies draft medusa tokens given target tokens. Modifies outputIds tensor accordingly filling it with
 //! accepted tokens. Fills logitsPtrs tensor with the pointers to the respective medusa logits tensor according
 //! to the next after the last accepted token.
@@ -56,6 +87,7 @@ namespace tensorrt_llm::kernels::speculative_decoding
 //! \param maxSeqLen maximum sequence length of output ids
 //! \param maxNumHeads maximum number of medusa heads
 //! \param maxDecodingTokens maximum number of tokens per step configured in the system
+//! \param acceptanceParams verification mode per request, all requests use exact match if modes is nullptr
 //! \param stream stream
 template <typename T>
 void acceptDraftTokensByIdsWithPaths(runtime::TokenIdType* outputIds, runtime::TokenIdType const* draftIds,
@@ -65,7 +97,34 @@ void acceptDraftTokensByIdsWithPaths(runtime::TokenIdType* outputIds, runtime::T
     runtime::SizeType32* curTokensPerStep, runtime::SizeType32 const* targetTokensPerStep,
     runtime::SizeType32* bestPathIds, runtime::SizeType32 batchSize, runtime::SizeType32 maxBatchSize,
     runtime::SizeType32 vocabSize, runtime::SizeType32 maxSeqLen, runtime::SizeType32 maxNumHeads,
-    runtime::SizeType32 maxDecodingTokens, cudaStream_t stream);
+    runtime::SizeType32 maxDecodingTokens, MedusaAcceptanceParams<T> const& acceptanceParams, cudaStream_t stream);
+
+//! \brief prepares verification of the requests that do not use exact match. For kTYPICAL requests, computes the
+//! log normalizer and the typical acceptance threshold min(epsilon, alpha * exp(-H)) of every target row. For
+//! kREJECTION requests, samples targetIds from the full softmax of the target rows, replacing the top-K samples.
+//! A block per request processes its rows one after another, so a single random state per request is enough.
+//!
+//! \param targetIds input/output buffer [maxBatchSize, maxDecodingTokens], tokens sampled from the target rows
+//! \param logNormalizers output buffer [maxBatchSize, maxDecodingTokens]
+//! \param thresholds output buffer [maxBatchSize, maxDecodingTokens]
+//! \param logits input buffer [batchSize, maxDecodingTokens, vocabSizePadded], target logits
+//! \param modes input buffer [maxBatchSize], MedusaAcceptanceMode per request
+//! \param typicalEpsilons input buffer [maxBatchSize], posterior threshold epsilon of typical acceptance
+//! \param typicalAlphas input buffer [maxBatchSize], scale of the entropy dependent threshold of typical acceptance
+//! \param tokensPerStep input buffer [maxBatchSize], number of valid target rows per request
+//! \param randomState input buffer [maxBatchSize], random states per request
+//! \param batchSlots input buffer [batchSize], address map from local index to global index
+//! \param batchSize current batch size
+//! \param maxDecodingTokens maximum number of tokens per step configured in the system
+//! \param vocabSize vocab size
+//! \param vocabSizePadded padded vocab size, stride of the logits rows
+//! \param stream stream
+template <typename T>
+void invokeComputeMedusaAcceptanceStats(runtime::TokenIdType* targetIds, float* logNormalizers, float* thresholds,
+    T const* logits, MedusaAcceptanceMode const* modes, float const* typicalEpsilons, float const* typicalAlphas,
+    runtime::SizeType32 const* tokensPerStep, RandomState* randomState, runtime::SizeType32 const* batchSlots,
+    runtime::SizeType32 batchSize, runtime::SizeType32 maxDecodingTokens, runtime::SizeType32 vocabSize,
+    runtime::SizeType32 vocabSizePadded, cudaStream_t stream);
 
 //! \brief assembles draft tokens to treeDraftIds from sourceDraftIds using indices of treeIds
 //!
@@ -86,4 +145,22 @@ void scatterMedusaDraftTokens(runtime::TokenIdType* treeDraftIds, runtime::Token
     runtime::SizeType32 const* treeIds, runtime::SizeType32 const* tokensPerStep, runtime::SizeType32 const* batchSlots,
     runtime::SizeType32 maxDecodingTokens, runtime::SizeType32 batchSize, cudaStream_t stream);
 
+//! \brief accumulates how often each node of the Medusa tree is accepted. For every request, adds 1 to
+//! nodeAcceptCounts[0], the root, and 1 to the counter of every draft node on its best path that was accepted.
+//! The counters are shared by all requests, since they run the same tree.
+//!
+//! \param nodeAcceptCounts input/output buffer [maxDecodingTokens], counters indexed by the linear idx of the nodes
+//! \param acceptedLengths input buffer [maxBatchSize], number of new tokens per request, accepted draft tokens + 1
+//! \param bestPathIds input buffer [maxBatchSize], index of the best path of each request
+//! \param paths input buffer [maxBatchSize, maxDecodingTokens, maxPathLen], linear idx of the nodes on every path
+//! \param batchSlots input buffer [batchSize], address map from local index to global index
+//! \param batchSize current batch size
+//! \param maxDecodingTokens maximum number of tokens per step configured in the system
+//! \param maxPathLen maximum path length
+//! \param stream stream
+void invokeCountAcceptedTreeNodes(runtime::SizeType32* nodeAcceptCounts, runtime::SizeType32 const* acceptedLengths,
+    runtime::SizeType32 const* bestPathIds, runtime::SizeType32 const* paths, runtime::SizeType32 const* batchSlots,
+    runtime::SizeType32 batchSize, runtime::SizeType32 maxDecodingTokens, runtime::SizeType32 maxPathLen,
+    cudaStream_t stream);
+
 } // namespace tensorrt_llm::kernels::speculative_decoding
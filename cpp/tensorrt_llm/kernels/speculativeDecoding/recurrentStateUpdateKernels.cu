@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "recurrentStateUpdateKernels.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace tensorrt_llm::kernels::speculative_decoding
+{
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+template <typename VecT>
+__global__ void commitRecurrentStatesKernel(VecT* states, VecT const* intermediateStates,
+    SizeType32 const* acceptedLengths, SizeType32 const* slotMapping, SizeType32 stepTokens, std::size_t stateSize)
+{
+    auto const seqIdx = static_cast<SizeType32>(blockIdx.y);
+    auto const slot = slotMapping == nullptr ? seqIdx : slotMapping[seqIdx];
+    auto const acceptedLength = acceptedLengths[seqIdx];
+    // Nothing to commit if the step was not run for this sequence.
+    if (acceptedLength <= 0)
+    {
+        return;
+    }
+    auto const token = static_cast<std::size_t>(seqIdx) * stepTokens + min(acceptedLength, stepTokens) - 1;
+    auto const* src = intermediateStates + token * stateSize;
+    auto* dst = states + static_cast<std::size_t>(slot) * stateSize;
+    for (auto idx = static_cast<std::size_t>(blockIdx.x) * blockDim.x + threadIdx.x; idx < stateSize;
+         idx += static_cast<std::size_t>(gridDim.x) * blockDim.x)
+    {
+        dst[idx] = src[idx];
+    }
+}
+
+template <typename VecT>
+void launchCommitRecurrentStates(void* states, void const* intermediateStates, SizeType32 const* acceptedLengths,
+    SizeType32 const* slotMapping, SizeType32 batchSize, SizeType32 stepTokens, std::size_t stateSizeInBytes,
+    cudaStream_t stream)
+{
+    SizeType32 constexpr kBlockSize = 256;
+    SizeType32 constexpr kMaxBlocksPerSeq = 64;
+    auto const stateSize = stateSizeInBytes / sizeof(VecT);
+    auto const blocksPerSeq
+        = static_cast<SizeType32>(std::min<std::size_t>(kMaxBlocksPerSeq, common::divUp(stateSize, kBlockSize)));
+    dim3 const grid(blocksPerSeq, batchSize);
+    commitRecurrentStatesKernel<VecT><<<grid, kBlockSize, 0, stream>>>(static_cast<VecT*>(states),
+        static_cast<VecT const*>(intermediateStates), acceptedLengths, slotMapping, stepTokens, stateSize);
+}
+} // namespace
+
+void invokeCommitRecurrentStates(void* states, void const* intermediateStates, SizeType32 const* acceptedLengths,
+    SizeType32 const* slotMapping, SizeType32 batchSize, SizeType32 stepTokens, std::size_t stateSizeInBytes,
+    cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(stepTokens > 0, "A generation step has at least one token");
+    if (batchSize == 0 || stateSizeInBytes == 0)
+    {
+        return;
+    }
+    auto const aligned = [&](std::size_t alignment)
+    {
+        return stateSizeInBytes % alignment == 0 && reinterpret_cast<std::uintptr_t>(states) % alignment == 0
+            && reinterpret_cast<std::uintptr_t>(intermediateStates) % alignment == 0;
+    };
+    if (aligned(sizeof(int4)))
+    {
+        launchCommitRecurrentStates<int4>(states, intermediateStates, acceptedLengths, slotMapping, batchSize,
+            stepTokens, stateSizeInBytes, stream);
+    }
+    else if (aligned(sizeof(int)))
+    {
+        launchCommitRecurrentStates<int>(states, intermediateStates, acceptedLengths, slotMapping, batchSize,
+            stepTokens, stateSizeInBytes, stream);
+    }
+    else
+    {
+        launchCommitRecurrentStates<char>(states, intermediateStates, acceptedLengths, slotMapping, batchSize,
+            stepTokens, stateSizeInBytes, stream);
+    }
+    sync_check_cuda_error();
+}
+
+} // namespace tensorrt_llm::kernels::speculative_decoding
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2023-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include <cstddef>
+#include <cuda_runtime_api.h>
+
+namespace tensorrt_llm::kernels::speculative_decoding
+{
+
+/*!
+ * Commit the recurrent states of the accepted tokens after a multi-token generation step of a Mamba or LRU layer.
+ * The step kernels write the state after every token to an intermediate buffer when given one; this copies the state
+ * after the last accepted token of each sequence back to its state slot. The copy is type agnostic and serves SSM,
+ * conv and LRU states alike. Only linear draft chains map to one state per position, tree shaped drafts are not
+ * supported by recurrent layers.
+ * @param states : [numSlots, stateSizeInBytes] states of the layer
+ * @param intermediateStates : [batchSize, stepTokens, stateSizeInBytes] states after every token of the step
+ * @param acceptedLengths : [batchSize] number of tokens of the step kept by each sequence, in [1, stepTokens]
+ * @param slotMapping : [batchSize] state slot of each sequence, nullptr if the slot is the batch index
+ * @param batchSize : Number of sequences
+ * @param stepTokens : Number of tokens per sequence in the step
+ * @param stateSizeInBytes : Size of the state of one sequence
+ * @param stream : CUDA stream to use.
+ */
+void invokeCommitRecurrentStates(void* states, void const* intermediateStates,
+    runtime::SizeType32 const* acceptedLengths, runtime::SizeType32 const* slotMapping, runtime::SizeType32 batchSize,
+    runtime::SizeType32 stepTokens, std::size_t stateSizeInBytes, cudaStream_t stream);
+
+} // namespace tensorrt_llm::kernels::speculative_decoding
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/tokenBitmask.h"
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+namespace tensorrt_llm::kernels
+{
+
+namespace
+{
+template <typename T>
+__global__ void applyTokenBitmaskKernel(T* const* logitsPtrs, std::int32_t const* bitmask,
+    SizeType32 const* batchSlots, SizeType32 vocabSize, SizeType32 vocabSizePadded, SizeType32 bitmaskSize)
+{
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.y);
+    auto const beamIdx = static_cast<SizeType32>(blockIdx.z);
+    auto const batchSlot = batchSlots[batchIdx];
+    auto* logits = logitsPtrs[batchIdx] + static_cast<int64_t>(beamIdx) * vocabSizePadded;
+    auto const* mask = reinterpret_cast<std::uint32_t const*>(bitmask) + static_cast<int64_t>(batchSlot) * bitmaskSize;
+
+    // Each thread covers one word of the mask, i.e. 32 consecutive tokens
+    auto const wordIdx = static_cast<SizeType32>(blockIdx.x * blockDim.x + threadIdx.x);
+    auto const begin = wordIdx * 32;
+    if (begin >= vocabSizePadded)
+    {
+        return;
+    }
+    auto const word = wordIdx < bitmaskSize ? mask[wordIdx] : 0u;
+    if (word == 0xffffffffu && begin + 32 <= vocabSize)
+    {
+        return;
+    }
+    auto const end = min(begin + 32, vocabSizePadded);
+    for (SizeType32 vi = begin; vi < end; ++vi)
+    {
+        if (vi >= vocabSize || ((word >> (vi - begin)) & 1u) == 0)
+        {
+            logits[vi] = static_cast<T>(-INFINITY);
+        }
+    }
+}
+} // namespace
+
+template <typename T>
+void invokeApplyTokenBitmask(T* const* logitsPtrs, std::int32_t const* bitmask, SizeType32 const* batchSlots,
+    SizeType32 batchSize, SizeType32 beamWidth, SizeType32 vocabSize, SizeType32 vocabSizePadded, cudaStream_t stream)
+{
+    SizeType32 constexpr blockSize = 256;
+    auto const numWords = getTokenBitmaskSize(vocabSizePadded);
+    dim3 const grid((numWords + blockSize - 1) / blockSize, batchSize, beamWidth);
+    applyTokenBitmaskKernel<<<grid, blockSize, 0, stream>>>(
+        logitsPtrs, bitmask, batchSlots, vocabSize, vocabSizePadded, getTokenBitmaskSize(vocabSize));
+    sync_check_cuda_error();
+}
+
+template void invokeApplyTokenBitmask(float* const* logitsPtrs, std::int32_t const* bitmask,
+    SizeType32 const* batchSlots, SizeType32 batchSize, SizeType32 beamWidth, SizeType32 vocabSize,
+    SizeType32 vocabSizePadded, cudaStream_t stream);
+template void invokeApplyTokenBitmask(half* const* logitsPtrs, std::int32_t const* bitmask,
+    SizeType32 const* batchSlots, SizeType32 batchSize, SizeType32 beamWidth, SizeType32 vocabSize,
+    SizeType32 vocabSizePadded, cudaStream_t stream);
+
+} // namespace tensorrt_llm::kernels
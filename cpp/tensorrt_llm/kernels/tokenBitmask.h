@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm::kernels
+{
+
+//! \brief Number of 32-bit words of the packed token bitmask of one request.
+inline runtime::SizeType32 constexpr getTokenBitmaskSize(runtime::SizeType32 vocabSize)
+{
+    return (vocabSize + 31) / 32;
+}
+
+//! \brief Mask the logits of disallowed tokens before sampling, e.g. for grammar constrained decoding.
+//! \details Bit v % 32 of word v / 32 of the bitmask row of a request is set if token v is allowed. The logits of
+//! tokens whose bit is cleared, and of the padding of the vocabulary, are set to -inf.
+//! \param logitsPtrs [batchSize] pointers to the logits of each request, [beamWidth, vocabSizePadded] each
+//! \param bitmask [maxBatchSize, bitmaskSize] packed bitmasks, bitmaskSize = getTokenBitmaskSize(vocabSize)
+//! \param batchSlots [batchSize] row of the bitmask of each request
+template <typename T>
+void invokeApplyTokenBitmask(T* const* logitsPtrs, std::int32_t const* bitmask, runtime::SizeType32 const* batchSlots,
+    runtime::SizeType32 batchSize, runtime::SizeType32 beamWidth, runtime::SizeType32 vocabSize,
+    runtime::SizeType32 vocabSizePadded, cudaStream_t stream);
+
+} // namespace tensorrt_llm::kernels
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CUDART_VERSION
+#error CUDART_VERSION Undefined!
+#elif (CUDART_VERSION >= 11050)
+#include <cub/cub.cuh>
+#else
+#include "3rdparty/cub/cub.cuh"
+#endif
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/topLogProbsKernels.h"
+
+#include <cfloat>
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+namespace tensorrt_llm::kernels
+{
+
+namespace
+{
+template <typename T, int32_t BLOCK_SIZE>
+__global__ void topLogProbsKernel(T const* __restrict logits, SizeType32 const* batchSlots,
+    SizeType32 const* numTopLogProbs, TokenIdType* outputIds, float* outputLogProbs, SizeType32 vocabSize,
+    SizeType32 vocabSizePadded, SizeType32 maxNumTopLogProbs)
+{
+    using Pair = cub::KeyValuePair<SizeType32, float>;
+    using BlockReduceFloat = cub::BlockReduce<float, BLOCK_SIZE>;
+    using BlockReducePair = cub::BlockReduce<Pair, BLOCK_SIZE>;
+    __shared__ union
+    {
+        typename BlockReduceFloat::TempStorage reduceFloat;
+        typename BlockReducePair::TempStorage reducePair;
+    } tempStorage;
+    __shared__ float sMax;
+    __shared__ float sLogSum;
+    __shared__ Pair sSelected;
+
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = batchSlots != nullptr ? batchSlots[batchIdx] : batchIdx;
+    auto const numTop = numTopLogProbs != nullptr ? min(numTopLogProbs[batchSlot], maxNumTopLogProbs)
+                                                  : maxNumTopLogProbs;
+    auto const* rowLogits = logits + static_cast<int64_t>(batchIdx) * vocabSizePadded;
+
+    float threadMax = -FLT_MAX;
+    for (SizeType32 vi = threadIdx.x; vi < vocabSize; vi += BLOCK_SIZE)
+    {
+        threadMax = fmaxf(threadMax, static_cast<float>(rowLogits[vi]));
+    }
+    auto const blockMax = BlockReduceFloat(tempStorage.reduceFloat).Reduce(threadMax, cub::Max());
+    if (threadIdx.x == 0)
+    {
+        sMax = blockMax;
+    }
+    __syncthreads();
+
+    float threadSum = 0.f;
+    for (SizeType32 vi = threadIdx.x; vi < vocabSize; vi += BLOCK_SIZE)
+    {
+        threadSum += __expf(static_cast<float>(rowLogits[vi]) - sMax);
+    }
+    auto const blockSum = BlockReduceFloat(tempStorage.reduceFloat).Sum(threadSum);
+    if (threadIdx.x == 0)
+    {
+        sLogSum = sMax + __logf(blockSum);
+        sSelected = Pair{-1, FLT_MAX};
+    }
+    __syncthreads();
+
+    // Select one token per pass. Candidates rank below the previous selection in (value desc, id asc) order, so no
+    // token has to be marked as taken.
+    auto* rowIds = outputIds + static_cast<int64_t>(batchSlot) * maxNumTopLogProbs;
+    auto* rowLogProbs = outputLogProbs + static_cast<int64_t>(batchSlot) * maxNumTopLogProbs;
+    for (SizeType32 ki = 0; ki < numTop; ++ki)
+    {
+        auto const prev = sSelected;
+        Pair threadBest{-1, -FLT_MAX};
+        for (SizeType32 vi = threadIdx.x; vi < vocabSize; vi += BLOCK_SIZE)
+        {
+            auto const value = static_cast<float>(rowLogits[vi]);
+            bool const belowPrev = value < prev.value || (value == prev.value && vi > prev.key);
+            bool const better = value > threadBest.value || threadBest.key < 0;
+            if (belowPrev && better)
+            {
+                threadBest = Pair{vi, value};
+            }
+        }
+        auto const blockBest = BlockReducePair(tempStorage.reducePair).Reduce(threadBest, cub::ArgMax());
+        __syncthreads();
+        if (threadIdx.x == 0)
+        {
+            sSelected = blockBest;
+            rowIds[ki] = blockBest.key;
+            rowLogProbs[ki] = blockBest.value - sLogSum;
+        }
+        __syncthreads();
+    }
+    for (SizeType32 ki = numTop + threadIdx.x; ki < maxNumTopLogProbs; ki += BLOCK_SIZE)
+    {
+        rowIds[ki] = -1;
+        rowLogProbs[ki] = -FLT_MAX;
+    }
+}
+} // namespace
+
+template <typename T>
+void invokeTopLogProbs(TopLogProbsKernelParams<T> const& params, cudaStream_t stream)
+{
+    params.checkParams();
+    SizeType32 constexpr BLOCK_SIZE = 256;
+    topLogProbsKernel<T, BLOCK_SIZE><<<params.batchSize, BLOCK_SIZE, 0, stream>>>(params.logits, params.batchSlots,
+        params.numTopLogProbs, params.outputIds, params.outputLogProbs, params.vocabSize, params.vocabSizePadded,
+        params.maxNumTopLogProbs);
+    sync_check_cuda_error();
+}
+
+template void invokeTopLogProbs(TopLogProbsKernelParams<float> const& params, cudaStream_t stream);
+template void invokeTopLogProbs(TopLogProbsKernelParams<half> const& params, cudaStream_t stream);
+
+} // namespace tensorrt_llm::kernels
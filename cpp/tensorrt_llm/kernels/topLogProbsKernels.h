@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm::kernels
+{
+
+static constexpr runtime::SizeType32 TOP_LOG_PROBS_MAX = 32;
+
+template <typename T>
+struct TopLogProbsKernelParams
+{
+    //! input buffer [batchSize, vocabSizePadded]. Logits of the current step.
+    T const* logits{nullptr};
+    //! input buffer [batchSize], optional. Indices of rows of the outputs in memory pool.
+    //! Linear indexing (batchIdx) is used if nullptr.
+    runtime::SizeType32 const* batchSlots{nullptr};
+    //! input buffer [maxBatchSize], optional. Number of alternatives per request, at most maxNumTopLogProbs.
+    //! If nullptr, maxNumTopLogProbs is used for all requests.
+    runtime::SizeType32 const* numTopLogProbs{nullptr};
+
+    //! output buffer [maxBatchSize, maxNumTopLogProbs]. Token ids of the alternatives, most likely first.
+    //! May be mapped pinned host memory, so that only these pairs are copied to the host.
+    runtime::TokenIdType* outputIds{nullptr};
+    //! output buffer [maxBatchSize, maxNumTopLogProbs]. Log probabilities of the alternatives, computed with the
+    //! log-softmax over the full vocabulary. May be mapped pinned host memory.
+    float* outputLogProbs{nullptr};
+
+    runtime::SizeType32 batchSize{-1};
+    runtime::SizeType32 maxBatchSize{-1};
+    //! Number of valid logits per row. Padding columns are ignored.
+    runtime::SizeType32 vocabSize{-1};
+    runtime::SizeType32 vocabSizePadded{-1};
+    runtime::SizeType32 maxNumTopLogProbs{-1};
+
+    void checkParams() const
+    {
+        TLLM_CHECK(logits);
+        TLLM_CHECK(outputIds);
+        TLLM_CHECK(outputLogProbs);
+        TLLM_CHECK(batchSize > 0);
+        TLLM_CHECK(maxBatchSize >= batchSize);
+        TLLM_CHECK(vocabSize > 0);
+        TLLM_CHECK(vocabSizePadded >= vocabSize);
+        TLLM_CHECK(maxNumTopLogProbs > 0 && maxNumTopLogProbs <= TOP_LOG_PROBS_MAX);
+        TLLM_CHECK(maxNumTopLogProbs <= vocabSize);
+    }
+};
+
+//! \brief Compute the top-N tokens of each row and their log probabilities.
+//! \details Fuses the log-softmax with the top-N selection: one block per request reduces the maximum and the sum of
+//! exponentials of its row, then selects the N largest logits. Unlike returning generation logits, which copies
+//! [beamWidth, vocabSize] values per token to the host, only N (id, log prob) pairs per request are written.
+//! Slots [numTopLogProbs, maxNumTopLogProbs) of a request are filled with id -1.
+template <typename T>
+void invokeTopLogProbs(TopLogProbsKernelParams<T> const& params, cudaStream_t stream);
+
+} // namespace tensorrt_llm::kernels
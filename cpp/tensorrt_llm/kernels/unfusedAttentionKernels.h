@@ -58,7 +58,9 @@ enum class KvCacheDataType
 {
     BASE = 0,
     INT8,
-    FP8
+    FP8,
+    // 4-bit values with a half scale per kInt4KvCacheGroupSize channels, see int4KvCacheUtils.h.
+    INT4
 };
 
 enum class RotaryPositionEmbeddingType
@@ -95,6 +97,9 @@ struct QKVPreprocessingParams
     // shape is {rotary_embedding_max_positions, rotary_embedding_dim}. eg (2048, 128)
     float2 const* rotary_coef_cache_buffer{nullptr};
     float const* kvScaleOrigQuant{nullptr};
+    // When set, the largest absolute K and V values written to an 8-bit cache are folded into it per kv head, shape
+    // {kv_head_num, 2}, to calibrate the cache scales online, see invokeUpdateKvCacheScales.
+    float* kv_cache_amax{nullptr};
     int const* spec_decoding_position_offsets{nullptr};
 
     // Scalars.
@@ -123,6 +128,9 @@ struct QKVPreprocessingParams
     int multi_processor_count{0};
     int rotary_vision_start{0};
     int rotary_vision_length{0};
+    // The per-request magnitude scale of the cos/sin with shape {batch_size}, see rotaryScalingUtils.h. When set,
+    // rotary_embedding_inv_freq holds per-request frequencies (YaRN, LongRoPE) and no cos/sin table is used.
+    float const* rotary_embedding_mscale{nullptr};
     // Pre-compute on host.
     int half_rotary_dim{0};
     int q_hidden_size{0};
@@ -161,6 +169,7 @@ struct QKVPreprocessingParams
                   runtime::ITensor::makeShape({batch_size, rotary_embedding_dim / 2})));
         ss << "rotary_coef_cache_buffer: " << rotary_coef_cache_buffer << std::endl;
         ss << "kvScaleOrigQuant: " << kvScaleOrigQuant << std::endl;
+        ss << "kv_cache_amax: " << kv_cache_amax << std::endl;
         ss << "spec_decoding_position_offsets: " << spec_decoding_position_offsets << std::endl;
         ss << "batch_size: " << batch_size << std::endl;
         ss << "max_input_seq_len: " << max_input_seq_len << std::endl;
@@ -183,6 +192,7 @@ struct QKVPreprocessingParams
         ss << "enable_paged_kv_fmha: " << std::boolalpha << enable_paged_kv_fmha << std::endl;
         ss << "quantized_fp8_output: " << quantized_fp8_output << std::endl;
         ss << "multi_processor_count: " << multi_processor_count << std::endl;
+        ss << "rotary_embedding_mscale: " << rotary_embedding_mscale << std::endl;
 
         return ss.str();
     }
@@ -243,6 +253,17 @@ void invokeTranspose4dBatchMajor(T const* k_src, T const* v_src, KVCacheBuffer&
 template <typename T, typename T_cache, typename KVCacheBuffer>
 void invokeApplyBiasRopeUpdateKVCacheDispatch(QKVPreprocessingParams<T, KVCacheBuffer> params, cudaStream_t stream);
 
+// Quantize the (already rotated) K and V of QKV into an INT4 kv cache, and copy Q for paged kv fmha.
+template <typename T, typename KVCacheBuffer>
+void invokeUpdateInt4KVCache(QKVPreprocessingParams<T, KVCacheBuffer> const& params, cudaStream_t stream);
+
+// Derive the per-tensor scales of an 8-bit kv cache from the amax of K and V tracked per kv head by the QKV
+// preprocessing, kvCacheAmax {kvHeadNum, 2}. scales receives the orig->quant scale, quantMax / amax, followed by the
+// quant->orig scale. quantMax is the largest quantized value, 448 for fp8 and 127 for int8. Nothing is written while
+// no value has been tracked.
+void invokeUpdateKvCacheScales(
+    float const* kvCacheAmax, int kvHeadNum, float quantMax, float* scales, cudaStream_t stream);
+
 // NOTE: this kernel is in-place, QKV will be modified, if other kernels need that, may need copy or use before it.
 template <typename T, typename KVCacheBuffer>
 void invokeQKVPreprocessing(QKVPreprocessingParams<T, KVCacheBuffer> params, cudaStream_t stream)
@@ -258,6 +279,15 @@ void invokeQKVPreprocessing(QKVPreprocessingParams<T, KVCacheBuffer> params, cud
         invokeApplyBiasRopeUpdateKVCacheDispatch<T, __nv_fp8_e4m3, KVCacheBuffer>(params, stream);
     }
 #endif // ENABLE_FP8
+    else if (params.cache_type == KvCacheDataType::INT4)
+    {
+        // Apply bias and rope in place first, then quantize K/V by groups of channels.
+        auto inPlaceParams = params;
+        inPlaceParams.kv_cache_buffer.data = nullptr;
+        inPlaceParams.enable_paged_kv_fmha = false;
+        invokeApplyBiasRopeUpdateKVCacheDispatch<T, T, KVCacheBuffer>(inPlaceParams, stream);
+        invokeUpdateInt4KVCache(params, stream);
+    }
     else
     {
         invokeApplyBiasRopeUpdateKVCacheDispatch<T, T, KVCacheBuffer>(params, stream);
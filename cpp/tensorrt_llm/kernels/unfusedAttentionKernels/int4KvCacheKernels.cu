@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaTypeUtils.cuh"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/reduceKernelUtils.cuh"
+#include "tensorrt_llm/kernels/int4KvCacheUtils.h"
+#include "tensorrt_llm/kernels/unfusedAttentionKernels.h"
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+constexpr int kInt4KvCacheTokensPerBlock = 4;
+
+// Quantize one head of K or V into a row of the int4 kv cache. Lane l of the warp handles channel l of each group.
+template <typename T>
+__device__ void quantizeInt4KvCacheRow(uint8_t* row, T const* src, int sizePerHead, int lane)
+{
+    auto* scales = reinterpret_cast<half*>(row + sizePerHead / 2);
+    for (int groupBegin = 0; groupBegin < sizePerHead; groupBegin += kInt4KvCacheGroupSize)
+    {
+        float const val = cuda_cast<float>(src[groupBegin + lane]);
+        half const scaleHalf = __float2half(warpReduceMax(fabsf(val)) / 7.f);
+        float const scale = __half2float(scaleHalf);
+        int const quantized = scale > 0.f ? min(max(__float2int_rn(val / scale), -8), 7) : 0;
+        int const nibble = quantized & 0xF;
+        int const nextNibble = __shfl_down_sync(0xffffffff, nibble, 1);
+        if (lane % 2 == 0)
+        {
+            row[(groupBegin + lane) / 2] = static_cast<uint8_t>(nibble | (nextNibble << 4));
+        }
+        if (lane == 0)
+        {
+            scales[groupBegin / kInt4KvCacheGroupSize] = scaleHalf;
+        }
+    }
+}
+
+// grid (divUp(max_input_seq_len, kInt4KvCacheTokensPerBlock), head_num + kv_head_num, batch_size), block (32,
+// kInt4KvCacheTokensPerBlock). The first head_num heads copy Q for paged kv fmha, the others quantize K and V.
+template <typename T, typename KVCacheBuffer>
+__global__ void updateInt4KVCacheKernel(QKVPreprocessingParams<T, KVCacheBuffer> params)
+{
+    int const batch_idx = blockIdx.z;
+    int const local_token_idx = blockIdx.x * blockDim.y + threadIdx.y;
+    int const lane = threadIdx.x;
+    bool const variable_sequence_length = params.cu_seq_lens != nullptr;
+    int const cache_seq_len = params.cache_seq_lens[batch_idx];
+    int const actual_seq_len = variable_sequence_length ? params.seq_lens[batch_idx] : params.max_input_seq_len;
+    if (local_token_idx >= actual_seq_len)
+    {
+        return;
+    }
+    int const global_token_idx = local_token_idx
+        + ((variable_sequence_length && params.remove_padding) ? params.cu_seq_lens[batch_idx]
+                                                               : batch_idx * params.max_input_seq_len);
+    // Chunked attention: takes past_kv_sequence_length into consideration.
+    int const token_idx_in_seq = (cache_seq_len - actual_seq_len) + local_token_idx;
+    T const* src = params.QKV + static_cast<size_t>(global_token_idx) * params.hidden_size;
+
+    if (static_cast<int>(blockIdx.y) < params.head_num)
+    {
+        if (params.enable_paged_kv_fmha)
+        {
+            int const head_offset = blockIdx.y * params.size_per_head;
+            T* dst = params.Q + static_cast<size_t>(global_token_idx) * params.q_hidden_size + head_offset;
+            for (int channel = lane; channel < params.size_per_head; channel += 32)
+            {
+                dst[channel] = src[head_offset + channel];
+            }
+        }
+        return;
+    }
+
+    // Tokens that the cyclic kv cache has already dropped.
+    if (token_idx_in_seq < max(cache_seq_len - params.cyclic_kv_cache_len, 0))
+    {
+        return;
+    }
+    int const kv_head_idx = blockIdx.y - params.head_num;
+    int const token_kv_idx = params.kv_cache_buffer.getKVTokenIdx(token_idx_in_seq);
+    int const row_idx = params.kv_cache_buffer.getKVLocalIdx(
+        token_kv_idx, kv_head_idx, getInt4KvCacheRowBytes(params.size_per_head), 0);
+    T const* k_src = src + params.q_hidden_size + kv_head_idx * params.size_per_head;
+    T const* v_src = k_src + params.kv_hidden_size;
+    auto* k_row = reinterpret_cast<uint8_t*>(params.kv_cache_buffer.getKBlockPtr(batch_idx, token_kv_idx)) + row_idx;
+    auto* v_row = reinterpret_cast<uint8_t*>(params.kv_cache_buffer.getVBlockPtr(batch_idx, token_kv_idx)) + row_idx;
+    quantizeInt4KvCacheRow(k_row, k_src, params.size_per_head, lane);
+    quantizeInt4KvCacheRow(v_row, v_src, params.size_per_head, lane);
+}
+
+} // namespace
+
+template <typename T, typename KVCacheBuffer>
+void invokeUpdateInt4KVCache(QKVPreprocessingParams<T, KVCacheBuffer> const& params, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(params.size_per_head % kInt4KvCacheGroupSize == 0,
+        "INT4 kv cache requires the head size to be a multiple of %d.", kInt4KvCacheGroupSize);
+    TLLM_CHECK_WITH_INFO(params.sink_token_len == 0, "INT4 kv cache does not support sink tokens.");
+    TLLM_CHECK_WITH_INFO(!params.position_shift_enabled, "INT4 kv cache does not support position shift.");
+
+    dim3 const block(32, kInt4KvCacheTokensPerBlock);
+    dim3 const grid(divUp(params.max_input_seq_len, kInt4KvCacheTokensPerBlock), params.head_num + params.kv_head_num,
+        params.batch_size);
+    updateInt4KVCacheKernel<T, KVCacheBuffer><<<grid, block, 0, stream>>>(params);
+    sync_check_cuda_error();
+}
+
+#define INSTANTIATE_UPDATE_INT4_KV_CACHE(T, KVCacheBuffer)                                                             \
+    template void invokeUpdateInt4KVCache<T, KVCacheBuffer>(                                                           \
+        QKVPreprocessingParams<T, KVCacheBuffer> const& params, cudaStream_t stream)
+
+INSTANTIATE_UPDATE_INT4_KV_CACHE(float, KVBlockArray);
+INSTANTIATE_UPDATE_INT4_KV_CACHE(float, KVLinearBuffer);
+INSTANTIATE_UPDATE_INT4_KV_CACHE(half, KVBlockArray);
+INSTANTIATE_UPDATE_INT4_KV_CACHE(half, KVLinearBuffer);
+#ifdef ENABLE_BF16
+INSTANTIATE_UPDATE_INT4_KV_CACHE(__nv_bfloat16, KVBlockArray);
+INSTANTIATE_UPDATE_INT4_KV_CACHE(__nv_bfloat16, KVLinearBuffer);
+#endif
+#undef INSTANTIATE_UPDATE_INT4_KV_CACHE
+
+} // namespace kernels
+} // namespace tensorrt_llm
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/reduceKernelUtils.cuh"
+#include "tensorrt_llm/kernels/unfusedAttentionKernels.h"
+
+using namespace tensorrt_llm::common;
+
+namespace tensorrt_llm
+{
+namespace kernels
+{
+
+namespace
+{
+
+// One warp reduces the amax of all kv heads, K and V alike, since the attention kernels read a single scale.
+__global__ void updateKvCacheScalesKernel(float const* kvCacheAmax, int kvHeadNum, float quantMax, float* scales)
+{
+    float amax = 0.f;
+    for (int idx = threadIdx.x; idx < 2 * kvHeadNum; idx += blockDim.x)
+    {
+        amax = fmaxf(amax, kvCacheAmax[idx]);
+    }
+    amax = warpReduceMax(amax);
+    if (threadIdx.x == 0 && amax > 0.f)
+    {
+        scales[0] = quantMax / amax;
+        scales[1] = amax / quantMax;
+    }
+}
+
+} // namespace
+
+void invokeUpdateKvCacheScales(
+    float const* kvCacheAmax, int kvHeadNum, float quantMax, float* scales, cudaStream_t stream)
+{
+    updateKvCacheScalesKernel<<<1, 32, 0, stream>>>(kvCacheAmax, kvHeadNum, quantMax, scales);
+    sync_check_cuda_error();
+}
+
+} // namespace kernels
+} // namespace tensorrt_llm
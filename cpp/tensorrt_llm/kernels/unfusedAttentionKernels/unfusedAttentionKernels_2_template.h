@@ -217,8 +217,8 @@ struct Rotary_base_t<float, RotaryPositionEmbeddingType::GPTJ>
 template <typename VecType, typename T, int VEC_SIZE, bool RECOMPUTE>
 inline __device__ void apply_rotary_embedding_gptneox(VecType& q, VecType& q_pair, VecType& k, VecType& k_pair,
     bool first_half, float2 (&rotary_coef_cache)[VEC_SIZE], float const* rotary_inv_freq_buffer,
-    int const rotary_dim_idx, int const half_rotary_dim, int const rotary_position, int const vision_start = -1,
-    int const vision_length = -1)
+    int const rotary_dim_idx, int const half_rotary_dim, int const rotary_position, float const rotary_mscale,
+    int const vision_start = -1, int const vision_length = -1)
 {
     // Each thread holds NUM_ELTS elements.
     // Currently we apply the rotary embedding in float data type for accuracy reasons.
@@ -254,7 +254,8 @@ inline __device__ void apply_rotary_embedding_gptneox(VecType& q, VecType& q_pai
             }
             float const rotary_inv_freq = float(real_rotary_position)
                 * rotary_inv_freq_buffer[min(rotary_dim_idx + elt_id, half_rotary_dim - 1)];
-            rotary_coef_cache[elt_id] = make_float2(cosf(rotary_inv_freq), sinf(rotary_inv_freq));
+            rotary_coef_cache[elt_id]
+                = make_float2(cosf(rotary_inv_freq) * rotary_mscale, sinf(rotary_inv_freq) * rotary_mscale);
         }
 
         // Mask non-rotary dim.
@@ -268,7 +269,8 @@ inline __device__ void apply_rotary_embedding_gptneox(VecType& q, VecType& q_pai
 
 template <typename VecType, typename T, int VEC_SIZE, bool RECOMPUTE>
 inline __device__ void apply_rotary_embedding_gptj(VecType& q, VecType& k, float2 (&rotary_coef_cache)[VEC_SIZE],
-    float const* rotary_inv_freq_buffer, int const rotary_dim_idx, int const half_rotary_dim, int const rotary_position)
+    float const* rotary_inv_freq_buffer, int const rotary_dim_idx, int const half_rotary_dim, int const rotary_position,
+    float const rotary_mscale)
 {
     // Each thread holds NUM_ELTS elements.
     // Currently we apply the rotary embedding in float data type for accuracy reasons.
@@ -285,7 +287,8 @@ inline __device__ void apply_rotary_embedding_gptj(VecType& q, VecType& k, float
         {
             float const rotary_inv_freq
                 = float(rotary_position) * rotary_inv_freq_buffer[min(rotary_dim_idx + elt_id, half_rotary_dim - 1)];
-            rotary_coef_cache[elt_id] = make_float2(cosf(rotary_inv_freq), sinf(rotary_inv_freq));
+            rotary_coef_cache[elt_id]
+                = make_float2(cosf(rotary_inv_freq) * rotary_mscale, sinf(rotary_inv_freq) * rotary_mscale);
         }
 
         mmha::apply_rotary_embedding_gptj(q_, k_, rotary_coef_cache[elt_id]);
@@ -298,6 +301,35 @@ inline __device__ void apply_rotary_embedding_gptj(VecType& q, VecType& k, float
     }
 }
 
+// Largest absolute value of the N elements of type T packed in vec.
+template <typename T, int N, typename Vec>
+inline __device__ float vecAbsMax(Vec const& vec)
+{
+    static_assert(sizeof(Vec) == N * sizeof(T), "The vector must hold N elements of type T.");
+    auto const* elts = reinterpret_cast<T const*>(&vec);
+    float amax = 0.f;
+#pragma unroll
+    for (int i = 0; i < N; ++i)
+    {
+        amax = fmaxf(amax, fabsf(cuda_cast<float>(elts[i])));
+    }
+    return amax;
+}
+
+// Fold the K and V amax of the threads of a warp into kvCacheAmax [kv_head_num, 2], see
+// QKVPreprocessingParams::kv_cache_amax. All threads of the warp must call it.
+inline __device__ void trackKvCacheAmax(float* kvCacheAmax, int kvHeadIdx, float kAmax, float vAmax)
+{
+    kAmax = warpReduceMax(kAmax);
+    vAmax = warpReduceMax(vAmax);
+    if ((threadIdx.x % WARP_SIZE) == 0 && (kAmax > 0.f || vAmax > 0.f))
+    {
+        // Non-negative floats are ordered like their bit patterns.
+        atomicMax(reinterpret_cast<int*>(&kvCacheAmax[2 * kvHeadIdx]), __float_as_int(kAmax));
+        atomicMax(reinterpret_cast<int*>(&kvCacheAmax[2 * kvHeadIdx + 1]), __float_as_int(vAmax));
+    }
+}
+
 template <typename T, typename TCache, int Dh_MAX, bool ADD_BIAS, bool STORE_QKV, typename KVCacheBuffer,
     RotaryPositionEmbeddingType ROTARY_TYPE, bool DYNAMIC_ROTARY_SCALING, bool FP8_OUTPUT>
 __global__ void applyBiasRopeUpdateKVCache(QKVPreprocessingParams<T, KVCacheBuffer> params)
@@ -366,6 +398,10 @@ __global__ void applyBiasRopeUpdateKVCache(QKVPreprocessingParams<T, KVCacheBuff
     // Reuse the rotary coefficients for the same rotary position.
     float2 rotary_coef_cache[ROTARY_COEF_VEC_SIZE];
 
+    // Amax of the K and V values the thread wrote to the 8-bit cache.
+    float kAmax = 0.f;
+    float vAmax = 0.f;
+
     int local_token_idx = blockIdx.x * blockDim.y + threadIdx.y;
     {
         int cached_rotary_position = -1;
@@ -393,6 +429,9 @@ __global__ void applyBiasRopeUpdateKVCache(QKVPreprocessingParams<T, KVCacheBuff
                 continue;
             }
 
+            float const rotary_mscale
+                = params.rotary_embedding_mscale != nullptr ? params.rotary_embedding_mscale[batch_idx] : 1.0f;
+
             // Is the token and head dim maksed.
             bool const valid_head_dim_idx = head_dim_idx < params.size_per_head;
 
@@ -449,14 +488,14 @@ __global__ void applyBiasRopeUpdateKVCache(QKVPreprocessingParams<T, KVCacheBuff
                 {
                     apply_rotary_embedding_gptj<VecType, BaseType, ROTARY_COEF_VEC_SIZE, true>(q, k, rotary_coef_cache,
                         params.rotary_embedding_inv_freq + batch_idx * params.half_rotary_dim, gptj_rotary_dim_idx,
-                        params.half_rotary_dim, rotary_position);
+                        params.half_rotary_dim, rotary_position, rotary_mscale);
                     cached_rotary_position = rotary_position;
                 }
                 else
                 {
                     apply_rotary_embedding_gptj<VecType, BaseType, ROTARY_COEF_VEC_SIZE, false>(q, k, rotary_coef_cache,
                         params.rotary_embedding_inv_freq + batch_idx * params.half_rotary_dim, gptj_rotary_dim_idx,
-                        params.half_rotary_dim, rotary_position);
+                        params.half_rotary_dim, rotary_position, rotary_mscale);
                 }
                 break;
             }
@@ -470,7 +509,7 @@ __global__ void applyBiasRopeUpdateKVCache(QKVPreprocessingParams<T, KVCacheBuff
                     apply_rotary_embedding_gptneox<VecType, BaseType, ROTARY_COEF_VEC_SIZE, true>(q, q_pair, k, k_pair,
                         first_half, rotary_coef_cache,
                         params.rotary_embedding_inv_freq + batch_idx * params.half_rotary_dim, gptneox_rotary_dim_idx,
-                        params.half_rotary_dim, rotary_position, params.rotary_vision_start,
+                        params.half_rotary_dim, rotary_position, rotary_mscale, params.rotary_vision_start,
                         params.rotary_vision_length);
                     cached_rotary_position = rotary_position;
                 }
@@ -479,7 +518,7 @@ __global__ void applyBiasRopeUpdateKVCache(QKVPreprocessingParams<T, KVCacheBuff
                     apply_rotary_embedding_gptneox<VecType, BaseType, ROTARY_COEF_VEC_SIZE, false>(q, q_pair, k, k_pair,
                         first_half, rotary_coef_cache,
                         params.rotary_embedding_inv_freq + batch_idx * params.half_rotary_dim, gptneox_rotary_dim_idx,
-                        params.half_rotary_dim, rotary_position, params.rotary_vision_start,
+                        params.half_rotary_dim, rotary_position, rotary_mscale, params.rotary_vision_start,
                         params.rotary_vision_length);
                 }
                 break;
@@ -561,6 +600,11 @@ __global__ void applyBiasRopeUpdateKVCache(QKVPreprocessingParams<T, KVCacheBuff
                             // Store 8bits kv cache.
                             mmha::store_8bits_vec(kDst, k_to_cache, inBlockIdx, scaleOrigQuant);
                             mmha::store_8bits_vec(vDst, v, inBlockIdx, scaleOrigQuant);
+                            if (params.kv_cache_amax != nullptr)
+                            {
+                                kAmax = fmaxf(kAmax, vecAbsMax<T, VEC_SIZE>(k_to_cache));
+                                vAmax = fmaxf(vAmax, vecAbsMax<T, VEC_SIZE>(v));
+                            }
                         }
                         else
                         {
@@ -572,6 +616,14 @@ __global__ void applyBiasRopeUpdateKVCache(QKVPreprocessingParams<T, KVCacheBuff
             }
         }
     }
+
+    if constexpr (ENABLE_8BITS_CACHE)
+    {
+        if (params.kv_cache_amax != nullptr)
+        {
+            trackKvCacheAmax(params.kv_cache_amax, kv_head_idx, kAmax, vAmax);
+        }
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -689,6 +741,10 @@ __global__ void applyBiasRopeUpdateKVCacheV2(QKVPreprocessingParams<T, KVCacheBu
     int const seq_len_loop_end
         = int((params.max_input_seq_len + TOKENS_PER_BLOCK - 1) / TOKENS_PER_BLOCK) * TOKENS_PER_BLOCK;
 
+    // Amax of the K and V values the thread wrote to the 8-bit cache.
+    float kAmax = 0.f;
+    float vAmax = 0.f;
+
     // Mainloop.
     for (int local_token_idx = (threadIdx.x / VECS_PER_HEAD) + blockIdx.x * TOKENS_PER_BLOCK;
          local_token_idx < seq_len_loop_end; local_token_idx += TOKENS_PER_BLOCK * gridDim.x)
@@ -870,6 +926,11 @@ __global__ void applyBiasRopeUpdateKVCacheV2(QKVPreprocessingParams<T, KVCacheBu
                         // Store 8bits kv cache.
                         mmha::store_8bits_vec(kDst, k, inBlockIdx, scaleOrigQuant);
                         mmha::store_8bits_vec(vDst, v, inBlockIdx, scaleOrigQuant);
+                        if (params.kv_cache_amax != nullptr)
+                        {
+                            kAmax = fmaxf(kAmax, vecAbsMax<T, ELTS_PER_VEC>(k));
+                            vAmax = fmaxf(vAmax, vecAbsMax<T, ELTS_PER_VEC>(v));
+                        }
                     }
                     else
                     {
@@ -880,6 +941,14 @@ __global__ void applyBiasRopeUpdateKVCacheV2(QKVPreprocessingParams<T, KVCacheBu
             }
         }
     }
+
+    if constexpr (ENABLE_8BITS_CACHE)
+    {
+        if (params.kv_cache_amax != nullptr)
+        {
+            trackKvCacheAmax(params.kv_cache_amax, kv_head_idx, kAmax, vAmax);
+        }
+    }
 }
 
 // Use more blocks for the batch dimension in the generation phase.
@@ -937,8 +1006,10 @@ void kernelDispatchHeadSize(QKVPreprocessingParams<T, KVCacheBuffer> params, cud
 {
     bool const add_bias = params.qkv_bias != nullptr;
     bool const store_contiguous_qkv = !params.enable_paged_kv_fmha;
-    bool const dynamic_rotary_scaling = params.rotary_scale_type == RotaryScalingType::kDYNAMIC
-        && params.max_input_seq_len > params.rotary_embedding_max_positions;
+    // The rotary coefficients can't be reused across sequences with per-request frequencies.
+    bool const dynamic_rotary_scaling = (params.rotary_scale_type == RotaryScalingType::kDYNAMIC
+                                            && params.max_input_seq_len > params.rotary_embedding_max_positions)
+        || params.rotary_embedding_mscale != nullptr;
 
     constexpr int VEC_SIZE = Rotary_vec_t<T, Dh_MAX>::size;
     // Make sure we have multiple of paired vectors so that the access is aligned.
@@ -1071,7 +1142,7 @@ void invokeApplyBiasRopeUpdateKVCacheDispatch(QKVPreprocessingParams<T, KVCacheB
 
     // Long-sequence-length that exceeds the max_position_size needs to compute the cos/sin on-the-fly.
     bool const long_seq_rotary_support = params.rotary_scale_type == RotaryScalingType::kDYNAMIC
-        || params.max_kv_seq_len > params.rotary_embedding_max_positions;
+        || params.max_kv_seq_len > params.rotary_embedding_max_positions || params.rotary_embedding_mscale != nullptr;
     bool const has_rotary_cos_sin_cache = params.rotary_coef_cache_buffer != nullptr;
     bool const has_sink_tokens = params.sink_token_len > 0;
     // V2 implementation requires multiple of paired 16 bytes for gpt-neox rotation.
@@ -20,6 +20,9 @@
 #include <cstdint>
 #include <cuda_bf16.h>
 #include <cuda_fp16.h>
+#ifdef ENABLE_FP8
+#include <cuda_fp8.h>
+#endif
 #include <cuda_runtime.h>
 #include <cuda_runtime_api.h>
 #include <iostream>
@@ -37,7 +40,9 @@ enum class KernelType
     FP16Int8PerChannel,
     BF16Int8PerChannel,
     FP16Int4PerChannel,
-    BF16Int4PerChannel
+    BF16Int4PerChannel,
+    // W4A8: fp8 activations, int4 weights, fp16 scales, zeros, bias and output.
+    FP8Int4Groupwise
 };
 
 template <KernelType KT>
@@ -55,8 +60,13 @@ KERNEL_TYPE_TRAITS_REGISTRY(KernelType::FP16Int8PerChannel, false, false);
 KERNEL_TYPE_TRAITS_REGISTRY(KernelType::BF16Int8PerChannel, false, false);
 KERNEL_TYPE_TRAITS_REGISTRY(KernelType::FP16Int4PerChannel, false, true);
 KERNEL_TYPE_TRAITS_REGISTRY(KernelType::BF16Int4PerChannel, false, true);
+KERNEL_TYPE_TRAITS_REGISTRY(KernelType::FP8Int4Groupwise, true, true);
 #undef KERNEL_TYPE_TRAITS_REGISTRY
 
+// The largest m the plugins let the profiler consider the cuda kernels for. Up to 4 rows run in a single CTA row,
+// larger batches are split into CTA rows of 4 and are only picked when they beat the CUTLASS kernels.
+static constexpr int kMaxCudaKernelM = 32;
+
 struct Params
 {
     using Pointer = void*;
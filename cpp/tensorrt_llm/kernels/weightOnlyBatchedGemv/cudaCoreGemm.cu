@@ -34,6 +34,8 @@ __global__ void cudaCoreGemm(InputType const* __restrict__ act, InputType const*
     auto tileIdM = static_cast<SizeType32>(blockIdx.x * TILE_M);
     auto tileIdN = static_cast<SizeType32>(blockIdx.y * TILE_N);
     auto tid = static_cast<SizeType32>(threadIdx.x);
+    // The last CTA row of a medium batch may be partial.
+    auto const validM = min(TILE_M, m - tileIdM);
     float tile_a[kStepK], tile_w[TILE_N * kStepK];
     float acc[TILE_M * TILE_N];
 
@@ -67,6 +69,10 @@ __global__ void cudaCoreGemm(InputType const* __restrict__ act, InputType const*
 #pragma unroll
         for (SizeType32 i = 0; i < TILE_M; ++i)
         {
+            if (i >= validM)
+            {
+                break;
+            }
             auto tile_a_quantized = reinterpret_cast<VecType const*>(act + i * k + idxK)[0];
 #pragma unroll
             for (SizeType32 cvtIdx = 0; cvtIdx < kCvtCount; ++cvtIdx)
@@ -110,6 +116,10 @@ __global__ void cudaCoreGemm(InputType const* __restrict__ act, InputType const*
     for (SizeType32 ii = tid; ii < TILE_M * TILE_N; ii += BLOCK_SIZE)
     {
         SizeType32 mid = ii / TILE_N, nid = ii % TILE_N;
+        if (mid >= validM)
+        {
+            continue;
+        }
         float val = 0;
 #pragma unroll
         for (SizeType32 jj = 0; jj < kWarpNum; ++jj)
@@ -124,7 +134,7 @@ template <typename InputType, typename OutputType, SizeType32 TILE_M, SizeType32
 void cudaCoreGemmKernel(Params const& params, cudaStream_t stream)
 {
     dim3 block(BLOCK_SIZE);
-    dim3 grid(params.m / TILE_M, params.n / TILE_N);
+    dim3 grid((params.m + TILE_M - 1) / TILE_M, params.n / TILE_N);
     cudaCoreGemm<InputType, OutputType, TILE_M, TILE_N, BLOCK_SIZE><<<grid, block, 0, stream>>>(
         reinterpret_cast<InputType const*>(params.act), reinterpret_cast<InputType const*>(params.weight), params.alpha,
         reinterpret_cast<OutputType*>(params.output), params.m, params.n, params.k);
@@ -143,6 +153,12 @@ bool cudaCoreGemmTemplateCaller(Params const& params, cudaStream_t stream)
     {
         return cudaCoreGemmTemplateCaller<InputType, OutputType, TILE_M + 1, TILE_N, BLOCK_SIZE>(params, stream);
     }
+    if (params.m > cudaCoreGemmTemplateMaxM && params.m <= kCudaCoreGemmMaxM)
+    {
+        // Medium batches: CTA rows of cudaCoreGemmTemplateMaxM rows, every CTA row reads the weights from L2.
+        cudaCoreGemmKernel<InputType, OutputType, cudaCoreGemmTemplateMaxM, TILE_N, BLOCK_SIZE>(params, stream);
+        return true;
+    }
     return false;
 }
 
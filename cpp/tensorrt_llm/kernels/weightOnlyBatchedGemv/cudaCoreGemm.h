@@ -41,6 +41,9 @@ namespace cuda_core_gemm
 {
 using SizeType32 = tensorrt_llm::runtime::SizeType32;
 
+// Up to 16 rows run in a single CTA row, larger batches are split into CTA rows of 16.
+static constexpr SizeType32 kCudaCoreGemmMaxM = 32;
+
 struct Params
 {
     void const* act;
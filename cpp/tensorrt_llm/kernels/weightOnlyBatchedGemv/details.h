@@ -17,6 +17,8 @@
 #pragma once
 #include "tensorrt_llm/kernels/weightOnlyBatchedGemv/common.h"
 
+#include <type_traits>
+
 namespace tensorrt_llm
 {
 namespace kernels
@@ -37,6 +39,15 @@ struct BF16DetailsA
     static constexpr int kElemBits = 16;
 };
 
+#ifdef ENABLE_FP8
+// Only for the activations, the math is done in the type of the scales.
+struct FP8DetailsA
+{
+    using Type = __nv_fp8_e4m3;
+    static constexpr int kElemBits = 8;
+};
+#endif
+
 struct Int8DetailsW
 {
     static constexpr int kElemBits = 8;
@@ -96,11 +107,13 @@ struct ColumnMajorInterleaved
 };
 
 template <typename TypeDetailsA_, typename TypeDetailsW_, template <typename, typename, int> class LayoutDetails_,
-    bool UseInterleavedConverter, int TileSizeK>
+    bool UseInterleavedConverter, int TileSizeK, typename TypeDetailsAct_ = TypeDetailsA_>
 struct KernelDetails
 {
     using TypeDetailsA = TypeDetailsA_;
     using TypeDetailsW = TypeDetailsW_;
+    // The type of the activations in memory, converted to TypeDetailsA after loading.
+    using TypeDetailsAct = TypeDetailsAct_;
     using LayoutDetails = LayoutDetails_<TypeDetailsA, TypeDetailsW, TileSizeK>;
     using AccessTypeA = typename LayoutDetails::AccessTypeA;
     using AccessTypeW = typename LayoutDetails::AccessTypeW;
@@ -108,6 +121,8 @@ struct KernelDetails
     static constexpr int kStepK = LayoutDetails::kStepK;
     static constexpr int kAccessNumA = kStepK * TypeDetailsA::kElemBits / (sizeof(AccessTypeA) * 8);
     static constexpr int kAccessNumW = kStepK * TypeDetailsW::kElemBits / (sizeof(AccessTypeW) * 8);
+    using AccessTypeAct = std::conditional_t<(kStepK * TypeDetailsAct::kElemBits) % 128 == 0, AccessTypeA, uint2>;
+    static constexpr int kAccessNumAct = kStepK * TypeDetailsAct::kElemBits / (sizeof(AccessTypeAct) * 8);
     static constexpr int kInterleave = LayoutDetails::kInterleave;
     static constexpr int kThreadsPerInterleavedTile = LayoutDetails::kTileSize / kStepK;
     static constexpr int kElemsPerByteW = 8 / TypeDetailsW::kElemBits;
@@ -27,14 +27,15 @@ namespace kernels
 namespace weight_only
 {
 template <typename Details, int CtaM, int CtaN, int Threads, int GroupSize, bool EnableActScale, bool EnableZero,
-    bool EnableBias, bool ApplyAlphaInAdvance, typename TypeA = typename Details::TypeDetailsA::Type>
-__global__ void kernel(TypeA* act, TypeA* act_scale, uint8_t* weight, TypeA* scales, TypeA* zeros, TypeA* bias,
+    bool EnableBias, bool ApplyAlphaInAdvance, typename TypeA = typename Details::TypeDetailsA::Type,
+    typename TypeAct = typename Details::TypeDetailsAct::Type>
+__global__ void kernel(TypeAct* act, TypeA* act_scale, uint8_t* weight, TypeA* scales, TypeA* zeros, TypeA* bias,
     TypeA* out, float alpha, int m, int n, int k)
 {
     // clang-format off
     // ArgType          ArgName          DataType               Shape                           Layout
     //
-    // input            act              fp16/bf16              [m, k]                          RowMajor
+    // input            act              fp16/bf16/fp8          [m, k]                          RowMajor
     // input            act_scale        fp16/bf16              [1, k]                          RowMajor
     // input            weight           int4b/int8b            [k, n]                          ColumnMajor or ColumnMajorInterleaved
     // input            scales           fp16/bf16              [k / GroupSize, n] or [1, n]    RowMajor
@@ -64,7 +65,7 @@ __global__ void kernel(TypeA* act, TypeA* act_scale, uint8_t* weight, TypeA* sca
         = (tid * StepK / (Details::kInterleave * Details::LayoutDetails::kTileSize)) * Details::LayoutDetails::kTileSize
         + ((tid * StepK) % Details::LayoutDetails::kTileSize);
 
-    GMemIterator<Mandatory, AccessTypeA, CtaM, Details::kAccessNumA, TypeA> act_iterator(
+    GMemIterator<Mandatory, typename Details::AccessTypeAct, CtaM, Details::kAccessNumAct, TypeAct> act_iterator(
         act, offset_m * origin_k + real_offset_k, CtaK / Details::kInterleave, origin_k);
     GMemIterator<EnableActScale, AccessTypeA, 1, Details::kAccessNumA, TypeA> act_scale_iterator(
         act_scale, real_offset_k, CtaK / Details::kInterleave, 0);
@@ -111,7 +112,16 @@ __global__ void kernel(TypeA* act, TypeA* act_scale, uint8_t* weight, TypeA* sca
 #pragma unroll
         for (int i = 0; i < CtaM; ++i)
         {
-            act_iterator.load(tile_a, iter, i);
+            if constexpr (std::is_same_v<TypeAct, TypeA>)
+            {
+                act_iterator.load(tile_a, iter, i);
+            }
+            else
+            {
+                TypeAct tile_a_loaded[StepK];
+                act_iterator.load(tile_a_loaded, iter, i);
+                convert_act<Details, 1, StepK>(tile_a, tile_a_loaded);
+            }
             apply_scale<Details, 1, StepK, EnableActScale>(tile_a, vec_act_scale);
             mma<Details, 1, CtaN, StepK>(tile_acc + i * CtaN, tile_w_pack2, tile_a);
         }
@@ -124,6 +134,7 @@ template <typename Details, int CtaM, int CtaN, int Threads, int GroupSize, bool
 void exec_kernel(Params& params, cudaStream_t s)
 {
     using T = typename Details::TypeDetailsA::Type;
+    using TAct = typename Details::TypeDetailsAct::Type;
     if (params.m % CtaM || params.n % (CtaN * Details::kInterleave))
     {
         throw std::runtime_error("launch failed");
@@ -132,7 +143,7 @@ void exec_kernel(Params& params, cudaStream_t s)
     dim3 block(Threads);
     // clang-format off
     kernel<Details, CtaM, CtaN, Threads, GroupSize, EnableActScale, EnableZero, EnableBias, ApplyAlphaInAdvance><<<grid, block, 0, s>>>(
-        reinterpret_cast<T*>(params.act),
+        reinterpret_cast<TAct*>(params.act),
         reinterpret_cast<T*>(params.act_scale),
         reinterpret_cast<uint8_t*>(params.weight),
         reinterpret_cast<T*>(params.scales),
@@ -59,6 +59,27 @@ void dispatcher(Params& params, cudaStream_t s)
         DISPATCHER_FOR_M(4, 4, 8, 128);
         // clang-format on
     }
+    if (params.m > 4)
+    {
+        // Medium batches reuse the 4 rows per CTA kernel over a grid of row tiles, the remaining rows run with the
+        // kernel of their own size.
+        using T = typename Details::TypeDetailsA::Type;
+        using TAct = typename Details::TypeDetailsAct::Type;
+        int const tail_m = params.m % 4;
+        Params head = params;
+        head.m = params.m - tail_m;
+        exec_kernel<Details, 4, EnableZero ? 4 : 8, 128, GroupSize, EnableActScale, EnableZero, EnableBias,
+            ApplyAlphaInAdvance>(head, s);
+        if (tail_m != 0)
+        {
+            Params tail = params;
+            tail.m = tail_m;
+            tail.act = reinterpret_cast<TAct*>(params.act) + static_cast<size_t>(head.m) * params.k;
+            tail.out = reinterpret_cast<T*>(params.out) + static_cast<size_t>(head.m) * params.n;
+            dispatcher<Details, GroupSize, EnableActScale, EnableZero, EnableBias, ApplyAlphaInAdvance>(tail, s);
+        }
+        return;
+    }
     throw std::runtime_error("unsupported m");
 #undef DISPATCHER_FOR_M
 }
@@ -146,6 +167,10 @@ void select_gs(Params& params, cudaStream_t s)
 #define INSTANTIATE_WEIGHT_ONLY_CUDA_DISPATCHERS(KType, A, B, Layout, ConverterInterleave, KTile)                      \
     template void select_gs<kernel_type_traits<KType>::isGroupwise,                                                    \
         KernelDetails<A, B, Layout, ConverterInterleave, KTile>>(Params & params, cudaStream_t s);
+
+#define INSTANTIATE_WEIGHT_ONLY_CUDA_DISPATCHERS_ACT(KType, A, B, Layout, ConverterInterleave, KTile, Act)             \
+    template void select_gs<kernel_type_traits<KType>::isGroupwise,                                                    \
+        KernelDetails<A, B, Layout, ConverterInterleave, KTile, Act>>(Params & params, cudaStream_t s);
 } // namespace weight_only
 } // namespace kernels
 } // namespace tensorrt_llm
@@ -44,6 +44,13 @@ inline void kernel_launcher(int arch, Params& params, cudaStream_t s)
             params, s);                                                                                                \
         return;                                                                                                        \
     }
+#define EXEC_FP8_ACT(KType, A, B, Layout, ConverterInterleave, KTile)                                                  \
+    if (params.type == KType)                                                                                          \
+    {                                                                                                                  \
+        select_gs<kernel_type_traits<KType>::isGroupwise,                                                              \
+            KernelDetails<A, B, Layout, ConverterInterleave, KTile, FP8DetailsA>>(params, s);                          \
+        return;                                                                                                        \
+    }
     if (arch >= 70 && arch < 75)
     {
         EXEC(KernelType::FP16Int8PerChannel, FP16DetailsA, Int8DetailsW, ColumnMajor, true);
@@ -59,6 +66,10 @@ inline void kernel_launcher(int arch, Params& params, cudaStream_t s)
     {
         if (arch >= 89)
         {
+#ifdef ENABLE_FP8
+            // The weights are laid out for the fp8 CUTLASS kernels, hence the K tile of 128.
+            EXEC_FP8_ACT(KernelType::FP8Int4Groupwise, FP16DetailsA, Int4DetailsW, ColumnMajorInterleaved, true, 128);
+#endif
             EXEC_W4A8(KernelType::FP16Int4Groupwise, FP16DetailsA, Int4DetailsW, ColumnMajorInterleaved, true);
         }
         EXEC(KernelType::FP16Int4Groupwise, FP16DetailsA, Int4DetailsW, ColumnMajorInterleaved, true);
@@ -70,6 +81,9 @@ inline void kernel_launcher(int arch, Params& params, cudaStream_t s)
     }
     else if (arch >= 90)
     {
+#ifdef ENABLE_FP8
+        EXEC_FP8_ACT(KernelType::FP8Int4Groupwise, FP16DetailsA, Int4DetailsW, ColumnMajor, false, 64);
+#endif
         EXEC(KernelType::FP16Int4Groupwise, FP16DetailsA, Int4DetailsW, ColumnMajor, false);
         EXEC(KernelType::BF16Int4Groupwise, BF16DetailsA, Int4DetailsW, ColumnMajor, false);
         EXEC(KernelType::FP16Int8PerChannel, FP16DetailsA, Int8DetailsW, ColumnMajor, false);
@@ -78,6 +92,8 @@ inline void kernel_launcher(int arch, Params& params, cudaStream_t s)
         EXEC(KernelType::BF16Int4PerChannel, BF16DetailsA, Int4DetailsW, ColumnMajor, false);
     }
 #undef EXEC
+#undef EXEC_W4A8
+#undef EXEC_FP8_ACT
 }
 
 inline bool is_supported(int arch, KernelType kernel_type)
@@ -104,9 +120,18 @@ inline bool is_supported(int arch, KernelType kernel_type)
         SUPPORT(KernelType::BF16Int8PerChannel);
         SUPPORT(KernelType::FP16Int4PerChannel);
         SUPPORT(KernelType::BF16Int4PerChannel);
+#ifdef ENABLE_FP8
+        if (arch >= 89)
+        {
+            SUPPORT(KernelType::FP8Int4Groupwise);
+        }
+#endif
     }
     else if (arch >= 90)
     {
+#ifdef ENABLE_FP8
+        SUPPORT(KernelType::FP8Int4Groupwise);
+#endif
         SUPPORT(KernelType::FP16Int4Groupwise);
         SUPPORT(KernelType::BF16Int4Groupwise);
         SUPPORT(KernelType::FP16Int8PerChannel);
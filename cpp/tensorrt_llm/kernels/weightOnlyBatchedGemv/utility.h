@@ -119,6 +119,19 @@ __device__ __forceinline__ void apply_scale(void* act, void* act_scale)
     }
 }
 
+template <typename Details, int M, int K>
+__device__ __forceinline__ void convert_act(void* act, void* loaded_act)
+{
+    using Type = typename MathWrapper<typename Details::TypeDetailsA>::Type;
+    using TypeAct = typename Details::TypeDetailsAct::Type;
+#pragma unroll
+    for (int i = 0; i < M * K; ++i)
+    {
+        reinterpret_cast<Type*>(act)[i]
+            = static_cast<Type>(static_cast<float>(reinterpret_cast<TypeAct*>(loaded_act)[i]));
+    }
+}
+
 template <typename Details, int N, int K, bool EnableZero, bool ApplyAlphaInAdvance>
 __device__ __forceinline__ void dequantize(void* w, void* quantized_w, void* scales, void* zeros, float alpha)
 {
@@ -0,0 +1,518 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/wordsAutomaton.h"
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::runtime;
+
+namespace tensorrt_llm::kernels
+{
+
+namespace
+{
+// Per node fields of an automaton, each an array of capacity + 2 elements after the header. The extra element
+// lets the depth counters of buildLinks fit when a single word fills the whole capacity
+enum NodeField : SizeType32
+{
+    kPARENT = 0,
+    kTOKEN,
+    kFAIL,
+    kFLAGS,
+    kDEPTH,
+    kTERM_START, // First of the tokens completing a word from this node in the terminal tokens array
+    kNUM_TERM,   // Number of tokens completing a word from this node
+    kBAN_LINK,   // Closest node on the failure chain with kNUM_TERM > 0, -1 if none
+    kORDER,      // Scratch used while building
+    kNUM_FIELDS
+};
+
+// Header: max depth and number of nodes
+SizeType32 constexpr kHEADER_SIZE = 2;
+SizeType32 constexpr kROOT = 0;
+SizeType32 constexpr kWORD_END = 1;
+// A word ends at this node or at a node on its failure chain
+SizeType32 constexpr kMATCH = 2;
+
+SizeType32 constexpr kBUILD_BLOCK_SIZE = 256;
+SizeType32 constexpr kBAN_MIN_BLOCK_SIZE = 128;
+
+__host__ __device__ SizeType32 getHashSize(SizeType32 capacity)
+{
+    SizeType32 hashSize = 1;
+    while (hashSize < 2 * (capacity + 1))
+    {
+        hashSize *= 2;
+    }
+    return hashSize;
+}
+
+__host__ __device__ size_t getAutomatonSize(SizeType32 capacity)
+{
+    return kHEADER_SIZE + kNUM_FIELDS * (capacity + 2) + getHashSize(capacity) + capacity;
+}
+
+//! Automaton of one slot. Children are found by a hash of (parent, token) into an open addressing table of nodes
+struct WordsAutomaton
+{
+    SizeType32* data;
+    SizeType32 numFieldNodes;
+    SizeType32 hashMask;
+
+    __device__ WordsAutomaton(WordsAutomataParams const& params, SizeType32 batchSlot)
+        : data{params.automata + batchSlot * getAutomatonSize(params.capacity)}
+        , numFieldNodes{params.capacity + 2}
+        , hashMask{getHashSize(params.capacity) - 1}
+    {
+    }
+
+    __device__ SizeType32* header() const
+    {
+        return data;
+    }
+
+    __device__ SizeType32* field(NodeField f) const
+    {
+        return data + kHEADER_SIZE + f * numFieldNodes;
+    }
+
+    __device__ SizeType32* hashTable() const
+    {
+        return data + kHEADER_SIZE + kNUM_FIELDS * numFieldNodes;
+    }
+
+    __device__ SizeType32* termTokens() const
+    {
+        return hashTable() + hashMask + 1;
+    }
+
+    __device__ SizeType32 hash(SizeType32 node, TokenIdType token) const
+    {
+        auto const h = static_cast<uint32_t>(node) * 0x9E3779B1u ^ static_cast<uint32_t>(token) * 0x85EBCA77u;
+        return static_cast<SizeType32>((h ^ (h >> 15)) & static_cast<uint32_t>(hashMask));
+    }
+
+    __device__ SizeType32 findChild(SizeType32 node, TokenIdType token) const
+    {
+        auto const* table = hashTable();
+        auto const* parents = field(kPARENT);
+        auto const* tokens = field(kTOKEN);
+        for (auto h = hash(node, token);; h = (h + 1) & hashMask)
+        {
+            auto const child = table[h];
+            if (child < 0 || (parents[child] == node && tokens[child] == token))
+            {
+                return child;
+            }
+        }
+    }
+
+    __device__ void insertChild(SizeType32 child)
+    {
+        auto* table = hashTable();
+        auto h = hash(field(kPARENT)[child], field(kTOKEN)[child]);
+        while (table[h] >= 0)
+        {
+            h = (h + 1) & hashMask;
+        }
+        table[h] = child;
+    }
+
+    //! Follows failure links until a node with a child for token is found
+    __device__ SizeType32 next(SizeType32 node, TokenIdType token) const
+    {
+        auto const* fail = field(kFAIL);
+        while (true)
+        {
+            auto const child = findChild(node, token);
+            if (child >= 0)
+            {
+                return child;
+            }
+            if (node == kROOT)
+            {
+                return kROOT;
+            }
+            node = fail[node];
+        }
+    }
+};
+
+//! Inserts the words into the trie and fills the header
+__device__ void buildTrie(WordsAutomaton& automaton, TokenIdType const* words, SizeType32 wordsLen)
+{
+    auto* parents = automaton.field(kPARENT);
+    auto* tokens = automaton.field(kTOKEN);
+    auto* flags = automaton.field(kFLAGS);
+    auto* depths = automaton.field(kDEPTH);
+    auto const* offsets = words + wordsLen;
+
+    parents[kROOT] = -1;
+    tokens[kROOT] = -1;
+    flags[kROOT] = 0;
+    depths[kROOT] = 0;
+    SizeType32 numNodes = 1;
+    SizeType32 maxDepth = 0;
+    for (SizeType32 wi = 0; wi < wordsLen; ++wi)
+    {
+        auto const end = min(offsets[wi], wordsLen);
+        auto const start = wi > 0 ? offsets[wi - 1] : 0;
+        if (end <= 0 || start < 0 || start >= end)
+        {
+            continue;
+        }
+        auto node = kROOT;
+        for (auto ti = start; ti < end; ++ti)
+        {
+            auto child = automaton.findChild(node, words[ti]);
+            if (child < 0)
+            {
+                child = numNodes++;
+                parents[child] = node;
+                tokens[child] = words[ti];
+                flags[child] = 0;
+                depths[child] = depths[node] + 1;
+                automaton.insertChild(child);
+            }
+            node = child;
+        }
+        flags[node] |= kWORD_END;
+        maxDepth = max(maxDepth, depths[node]);
+    }
+    automaton.header()[0] = maxDepth;
+    automaton.header()[1] = numNodes;
+}
+
+//! Computes failure links, match flags and the tokens completing a word from each node
+__device__ void buildLinks(WordsAutomaton& automaton)
+{
+    auto const maxDepth = automaton.header()[0];
+    auto const numNodes = automaton.header()[1];
+    auto const* parents = automaton.field(kPARENT);
+    auto const* tokens = automaton.field(kTOKEN);
+    auto const* depths = automaton.field(kDEPTH);
+    auto* fail = automaton.field(kFAIL);
+    auto* flags = automaton.field(kFLAGS);
+    auto* termStarts = automaton.field(kTERM_START);
+    auto* numTerms = automaton.field(kNUM_TERM);
+    auto* banLinks = automaton.field(kBAN_LINK);
+    auto* order = automaton.field(kORDER);
+
+    // Sort the nodes by depth, parents before children. banLinks are used as counters here
+    auto* counts = banLinks;
+    for (SizeType32 di = 0; di <= maxDepth + 1; ++di)
+    {
+        counts[di] = 0;
+    }
+    for (SizeType32 ni = 0; ni < numNodes; ++ni)
+    {
+        ++counts[depths[ni] + 1];
+    }
+    for (SizeType32 di = 1; di <= maxDepth + 1; ++di)
+    {
+        counts[di] += counts[di - 1];
+    }
+    for (SizeType32 ni = 0; ni < numNodes; ++ni)
+    {
+        order[counts[depths[ni]]++] = ni;
+    }
+
+    for (SizeType32 ni = 0; ni < numNodes; ++ni)
+    {
+        numTerms[ni] = 0;
+    }
+    for (SizeType32 ni = 1; ni < numNodes; ++ni)
+    {
+        numTerms[parents[ni]] += (flags[ni] & kWORD_END) ? 1 : 0;
+    }
+    SizeType32 numTermTokens = 0;
+    for (SizeType32 ni = 0; ni < numNodes; ++ni)
+    {
+        termStarts[ni] = numTermTokens;
+        numTermTokens += numTerms[ni];
+    }
+
+    fail[kROOT] = kROOT;
+    banLinks[kROOT] = -1;
+    for (SizeType32 oi = 1; oi < numNodes; ++oi)
+    {
+        auto const node = order[oi];
+        auto const parent = parents[node];
+        auto const link = parent == kROOT ? kROOT : automaton.next(fail[parent], tokens[node]);
+        fail[node] = link;
+        flags[node] |= ((flags[node] & kWORD_END) || (flags[link] & kMATCH)) ? kMATCH : 0;
+        banLinks[node] = numTerms[link] > 0 ? link : banLinks[link];
+    }
+
+    // order is used as a cursor per node here
+    auto* cursors = order;
+    auto* termTokens = automaton.termTokens();
+    for (SizeType32 ni = 0; ni < numNodes; ++ni)
+    {
+        cursors[ni] = termStarts[ni];
+    }
+    for (SizeType32 ni = 1; ni < numNodes; ++ni)
+    {
+        if (flags[ni] & kWORD_END)
+        {
+            termTokens[cursors[parents[ni]]++] = tokens[ni];
+        }
+    }
+}
+
+__global__ void buildWordsAutomata(WordsAutomataParams params, TokenIdType const* const* words,
+    SizeType32 const* wordsLens, SizeType32 const* slots, TokenIdType const** outputIds, SizeType32 const** parentIds,
+    SizeType32 const* sequenceLengths, SizeType32 const* numNewTokens, SizeType32 defaultNumNewTokens,
+    SizeType32 beamWidth, SizeType32 maxSeqLen)
+{
+    auto const batchSlot = slots[blockIdx.x];
+    auto const wordsLen = wordsLens[batchSlot];
+    WordsAutomaton automaton{params, batchSlot};
+
+    auto* table = automaton.hashTable();
+    for (auto hi = static_cast<SizeType32>(threadIdx.x); hi <= automaton.hashMask;
+         hi += static_cast<SizeType32>(blockDim.x))
+    {
+        table[hi] = -1;
+    }
+    __syncthreads();
+
+    if (threadIdx.x == 0)
+    {
+        buildTrie(automaton, words[batchSlot], wordsLen);
+        buildLinks(automaton);
+    }
+    __syncthreads();
+
+    // The node of a beam depends only on its last maxDepth tokens
+    auto const maxDepth = automaton.header()[0];
+    auto const newTokens = numNewTokens ? numNewTokens[batchSlot] : defaultNumNewTokens;
+    for (auto beamIdx = static_cast<SizeType32>(threadIdx.x); beamIdx < beamWidth;
+         beamIdx += static_cast<SizeType32>(blockDim.x))
+    {
+        auto const batchBeamIdx = batchSlot * beamWidth + beamIdx;
+        auto const end = max(sequenceLengths[batchBeamIdx] - newTokens, 0);
+        auto node = kROOT;
+        for (auto pos = max(end - maxDepth, 0); pos < end; ++pos)
+        {
+            // Find the beam holding pos in the history of this beam
+            auto srcBeamIdx = beamIdx;
+            for (auto step = end - 1; step > pos && beamWidth > 1; --step)
+            {
+                srcBeamIdx = parentIds == nullptr ? SizeType32{0} : parentIds[batchSlot][srcBeamIdx * maxSeqLen + step];
+                if (srcBeamIdx < 0 || srcBeamIdx >= beamWidth)
+                {
+                    break;
+                }
+            }
+            if (srcBeamIdx < 0 || srcBeamIdx >= beamWidth)
+            {
+                node = kROOT;
+                continue;
+            }
+            node = automaton.next(node, outputIds[batchSlot][srcBeamIdx * maxSeqLen + pos]);
+        }
+        params.states[batchBeamIdx] = node;
+        params.positions[batchBeamIdx] = end;
+    }
+}
+
+//! Advances the node of each beam of the block's slot over its unconsumed tokens. Beams are advanced in lockstep, so
+//! that each beam continues from the node of its parent. Each thread with beamIdx < beamWidth returns its new node.
+//! stopAtMatch stops a beam right after the first token that completes a word.
+__device__ SizeType32 advanceBeams(WordsAutomaton const& automaton, WordsAutomataParams const& params,
+    SizeType32* sharedNodes, TokenIdType const** outputIds, SizeType32 const** parentIds, SizeType32 batchSlot,
+    SizeType32 beamIdx, SizeType32 beamWidth, SizeType32 seqLen, SizeType32 maxSeqLen, bool stopAtMatch,
+    bool& matched, SizeType32& pos)
+{
+    auto const isBeam = beamIdx < beamWidth;
+    auto const batchBeamIdx = batchSlot * beamWidth + beamIdx;
+    auto const* flags = automaton.field(kFLAGS);
+    auto node = isBeam ? params.states[batchBeamIdx] : kROOT;
+    pos = isBeam ? params.positions[batchBeamIdx] : 0;
+    matched = false;
+    if (isBeam)
+    {
+        sharedNodes[beamIdx] = node;
+    }
+    bool done = !isBeam || pos >= seqLen;
+    while (__syncthreads_or(!done))
+    {
+        auto prevNode = node;
+        if (!done && beamWidth > 1)
+        {
+            auto const parentIdx
+                = parentIds == nullptr ? SizeType32{0} : parentIds[batchSlot][beamIdx * maxSeqLen + pos];
+            prevNode = (parentIdx >= 0 && parentIdx < beamWidth) ? sharedNodes[parentIdx] : kROOT;
+        }
+        __syncthreads();
+        if (!done)
+        {
+            node = automaton.next(prevNode, outputIds[batchSlot][beamIdx * maxSeqLen + pos]);
+            sharedNodes[beamIdx] = node;
+            ++pos;
+            matched = (flags[node] & kMATCH) != 0;
+            done = pos >= seqLen || (stopAtMatch && matched);
+        }
+    }
+    if (isBeam)
+    {
+        params.states[batchBeamIdx] = node;
+        params.positions[batchBeamIdx] = pos;
+    }
+    return node;
+}
+
+__global__ void stopWordsAutomatonCriterion(WordsAutomataParams params, TokenIdType const** outputIds,
+    SizeType32 const** parentIds, FinishedState* finished, SizeType32* sequenceLengths, SizeType32 const* batchSlots,
+    SizeType32 const* stopWordsLens, SizeType32* numNewTokens, SizeType32 beamWidth, SizeType32 maxSeqLen)
+{
+    extern __shared__ SizeType32 sharedNodes[];
+
+    auto const batchSlot = batchSlots[blockIdx.x];
+    if (stopWordsLens[batchSlot] == 0)
+    {
+        return;
+    }
+    auto const beamIdx = static_cast<SizeType32>(threadIdx.x);
+    auto const batchBeamIdx = batchSlot * beamWidth + beamIdx;
+    auto const seqLen = beamIdx < beamWidth ? sequenceLengths[batchBeamIdx] : 0;
+    auto const newTokens = numNewTokens ? numNewTokens[batchSlot] : 1;
+
+    WordsAutomaton const automaton{params, batchSlot};
+    bool matched;
+    SizeType32 pos;
+    advanceBeams(automaton, params, sharedNodes, outputIds, parentIds, batchSlot, beamIdx, beamWidth, seqLen,
+        maxSeqLen, /* stopAtMatch */ true, matched, pos);
+
+    if (beamIdx < beamWidth && matched)
+    {
+        finished[batchBeamIdx].setFinishedStopWords();
+        // When more than 1 token is predicted per step, stop right after the first match with a stop word
+        if (newTokens > 1)
+        {
+            atomicMin(numNewTokens + batchSlot, pos - (seqLen - newTokens));
+            atomicMin(sequenceLengths + batchBeamIdx, pos);
+        }
+    }
+}
+
+template <typename T>
+__global__ void banBadWordsAutomaton(WordsAutomataParams params, T* logits, TokenIdType const** outputIds,
+    SizeType32 const** parentIds, SizeType32 const* batchSlots, SizeType32 beamWidth, SizeType32 const* badWordsLens,
+    SizeType32 vocabSizePadded, SizeType32 const* sequenceLengths, SizeType32 maxSeqLen)
+{
+    extern __shared__ SizeType32 sharedNodes[];
+
+    auto const batchIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const batchSlot = batchSlots != nullptr ? batchSlots[batchIdx] : batchIdx;
+    if (badWordsLens[batchSlot] == 0)
+    {
+        return;
+    }
+    auto const beamIdx = static_cast<SizeType32>(threadIdx.x);
+    auto const seqLen = beamIdx < beamWidth ? sequenceLengths[batchSlot * beamWidth + beamIdx] : 0;
+
+    WordsAutomaton const automaton{params, batchSlot};
+    bool matched;
+    SizeType32 pos;
+    advanceBeams(automaton, params, sharedNodes, outputIds, parentIds, batchSlot, beamIdx, beamWidth, seqLen,
+        maxSeqLen, /* stopAtMatch */ false, matched, pos);
+    __syncthreads();
+
+    // Ban every token that completes a word from the node of a beam or from a node on its failure chain
+    auto const* termStarts = automaton.field(kTERM_START);
+    auto const* numTerms = automaton.field(kNUM_TERM);
+    auto const* banLinks = automaton.field(kBAN_LINK);
+    auto const* termTokens = automaton.termTokens();
+    for (SizeType32 bi = 0; bi < beamWidth; ++bi)
+    {
+        auto* beamLogits = logits + (batchIdx * beamWidth + bi) * vocabSizePadded;
+        auto const node = sharedNodes[bi];
+        for (auto link = numTerms[node] > 0 ? node : banLinks[node]; link >= 0; link = banLinks[link])
+        {
+            for (auto ti = static_cast<SizeType32>(threadIdx.x); ti < numTerms[link];
+                 ti += static_cast<SizeType32>(blockDim.x))
+            {
+                auto const bannedToken = termTokens[termStarts[link] + ti];
+                if (0 <= bannedToken && bannedToken < vocabSizePadded)
+                {
+                    beamLogits[bannedToken] = static_cast<T>(-INFINITY);
+                }
+            }
+        }
+    }
+}
+} // namespace
+
+size_t getWordsAutomatonSize(SizeType32 capacity)
+{
+    return getAutomatonSize(capacity);
+}
+
+void invokeBuildWordsAutomata(WordsAutomataParams const& params, TokenIdType const* const* words,
+    SizeType32 const* wordsLens, SizeType32 const* slots, SizeType32 numSlots, TokenIdType const** outputIds,
+    SizeType32 const** parentIds, SizeType32 const* sequenceLengths, SizeType32 const* numNewTokens,
+    SizeType32 defaultNumNewTokens, SizeType32 beamWidth, SizeType32 maxSeqLen, cudaStream_t stream)
+{
+    if (numSlots == 0)
+    {
+        return;
+    }
+    buildWordsAutomata<<<numSlots, kBUILD_BLOCK_SIZE, 0, stream>>>(params, words, wordsLens, slots, outputIds,
+        parentIds, sequenceLengths, numNewTokens, defaultNumNewTokens, beamWidth, maxSeqLen);
+    sync_check_cuda_error();
+}
+
+void invokeStopWordsAutomatonCriterion(WordsAutomataParams const& params, TokenIdType const** outputIds,
+    SizeType32 const** parentIds, FinishedState* finished, SizeType32* sequenceLengths, SizeType32 const* batchSlots,
+    SizeType32 const* stopWordsLens, SizeType32* numNewTokens, SizeType32 batchSize, SizeType32 beamWidth,
+    SizeType32 maxSeqLen, cudaStream_t stream)
+{
+    auto const blockSize = static_cast<SizeType32>(roundUp(beamWidth, 32));
+    stopWordsAutomatonCriterion<<<batchSize, blockSize, beamWidth * sizeof(SizeType32), stream>>>(params, outputIds,
+        parentIds, finished, sequenceLengths, batchSlots, stopWordsLens, numNewTokens, beamWidth, maxSeqLen);
+    sync_check_cuda_error();
+}
+
+template <typename T>
+void invokeBanBadWordsAutomaton(WordsAutomataParams const& params, T* logits, TokenIdType const** outputIds,
+    SizeType32 const** parentIds, SizeType32 const* batchSlots, SizeType32 batchSize, SizeType32 beamWidth,
+    SizeType32 const* badWordsLens, SizeType32 vocabSizePadded, SizeType32 const* sequenceLengths,
+    SizeType32 maxSeqLen, cudaStream_t stream)
+{
+    auto const blockSize = std::max(static_cast<SizeType32>(roundUp(beamWidth, 32)), kBAN_MIN_BLOCK_SIZE);
+    banBadWordsAutomaton<<<batchSize, blockSize, beamWidth * sizeof(SizeType32), stream>>>(params, logits, outputIds,
+        parentIds, batchSlots, beamWidth, badWordsLens, vocabSizePadded, sequenceLengths, maxSeqLen);
+    sync_check_cuda_error();
+}
+
+#define INSTANTIATE_BAN_BAD_WORDS_AUTOMATON(T)                                                                         \
+    template void invokeBanBadWordsAutomaton(WordsAutomataParams const& params, T* logits,                            \
+        TokenIdType const** outputIds, SizeType32 const** parentIds, SizeType32 const* batchSlots,                     \
+        SizeType32 batchSize, SizeType32 beamWidth, SizeType32 const* badWordsLens, SizeType32 vocabSizePadded,        \
+        SizeType32 const* sequenceLengths, SizeType32 maxSeqLen, cudaStream_t stream)
+
+INSTANTIATE_BAN_BAD_WORDS_AUTOMATON(float);
+INSTANTIATE_BAN_BAD_WORDS_AUTOMATON(half);
+#ifdef ENABLE_BF16
+INSTANTIATE_BAN_BAD_WORDS_AUTOMATON(__nv_bfloat16);
+#endif
+
+#undef INSTANTIATE_BAN_BAD_WORDS_AUTOMATON
+
+} // namespace tensorrt_llm::kernels
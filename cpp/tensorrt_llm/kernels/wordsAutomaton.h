@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cuda_runtime.h>
+
+namespace tensorrt_llm::kernels
+{
+
+//! \brief Aho-Corasick automata built per batch slot from a words list, e.g. stop words or bad words, in the
+//! [2, wordsLen] format used by invokeStopWordsCriterion. The automaton of a slot is a trie of its words with failure
+//! links. Each beam keeps the trie node of the longest suffix of its sequence that is a prefix of a word, so matching
+//! consumes one token per step with an amortized constant number of transitions, whatever the number of words.
+struct WordsAutomataParams
+{
+    //! [maxBatchSize, getWordsAutomatonSize(capacity)], on gpu
+    runtime::SizeType32* automata{nullptr};
+    //! [maxBatchSize, beamWidth], on gpu. Current node of each beam
+    runtime::SizeType32* states{nullptr};
+    //! [maxBatchSize, beamWidth], on gpu. Number of tokens of each beam consumed by its current node
+    runtime::SizeType32* positions{nullptr};
+    //! Max number of tokens in the words list of a slot, i.e. max wordsLen
+    runtime::SizeType32 capacity{0};
+};
+
+//! @returns number of SizeType32 elements used by the automaton of one slot
+[[nodiscard]] size_t getWordsAutomatonSize(runtime::SizeType32 capacity);
+
+//! \brief Builds the automata of slots from their words lists and restores the node of each beam by replaying the
+//! last tokens of outputIds, following parentIds when beamWidth > 1.
+//!
+//! \param params automata to build. wordsLens must not exceed params.capacity
+//! \param words input buffer [maxBatchSize][2, wordsLen]. Words list of each slot
+//! \param wordsLens input buffer [maxBatchSize], on gpu. Length of the words list of each slot
+//! \param slots input buffer [numSlots], on gpu. Slots to build
+//! \param numSlots number of slots to build
+//! \param outputIds input buffer [maxBatchSize][beamWidth, maxSeqLen]
+//! \param parentIds input buffer [maxBatchSize][beamWidth, maxSeqLen]. Applicable when beamWidth > 1
+//! \param sequenceLengths input buffer [maxBatchSize, beamWidth]
+//! \param numNewTokens input buffer [maxBatchSize], optional. Tokens at the end of each sequence that are left for
+//! the next invokeStopWordsAutomatonCriterion or invokeBanBadWordsAutomaton. defaultNumNewTokens is used if nullptr
+//! \param defaultNumNewTokens number of tokens left to consume when numNewTokens is nullptr
+//! \param beamWidth beam width
+//! \param maxSeqLen maximum length of the sequence
+//! \param stream stream
+void invokeBuildWordsAutomata(WordsAutomataParams const& params, runtime::TokenIdType const* const* words,
+    runtime::SizeType32 const* wordsLens, runtime::SizeType32 const* slots, runtime::SizeType32 numSlots,
+    runtime::TokenIdType const** outputIds, runtime::SizeType32 const** parentIds,
+    runtime::SizeType32 const* sequenceLengths, runtime::SizeType32 const* numNewTokens,
+    runtime::SizeType32 defaultNumNewTokens, runtime::SizeType32 beamWidth, runtime::SizeType32 maxSeqLen,
+    cudaStream_t stream);
+
+//! \brief Same as invokeStopWordsCriterion, but matches the stop words with the automata in params. The automaton of
+//! each slot in batchSlots must have been built by invokeBuildWordsAutomata.
+void invokeStopWordsAutomatonCriterion(WordsAutomataParams const& params, runtime::TokenIdType const** outputIds,
+    runtime::SizeType32 const** parentIds, FinishedState* finished, runtime::SizeType32* sequenceLengths,
+    runtime::SizeType32 const* batchSlots, runtime::SizeType32 const* stopWordsLens, runtime::SizeType32* numNewTokens,
+    runtime::SizeType32 batchSize, runtime::SizeType32 beamWidth, runtime::SizeType32 maxSeqLen, cudaStream_t stream);
+
+//! \brief Same as invokeBanBadWords, but finds the banned tokens with the automata in params. The automaton of each
+//! slot in batchSlots must have been built by invokeBuildWordsAutomata.
+template <typename T>
+void invokeBanBadWordsAutomaton(WordsAutomataParams const& params, T* logits, runtime::TokenIdType const** outputIds,
+    runtime::SizeType32 const** parentIds, runtime::SizeType32 const* batchSlots, runtime::SizeType32 batchSize,
+    runtime::SizeType32 beamWidth, runtime::SizeType32 const* badWordsLens, runtime::SizeType32 vocabSizePadded,
+    runtime::SizeType32 const* sequenceLengths, runtime::SizeType32 maxSeqLen, cudaStream_t stream);
+
+} // namespace tensorrt_llm::kernels
@@ -16,8 +16,8 @@
  */
 
 #include "banWordsLayer.h"
-#include "tensorrt_llm/kernels/banBadWords.h"
 #include "tensorrt_llm/kernels/banRepeatNgram.h"
+#include "tensorrt_llm/kernels/wordsAutomaton.h"
 #include "tensorrt_llm/layers/defaultDecodingParams.h"
 #include "tensorrt_llm/layers/layerUtils.h"
 
@@ -51,6 +51,10 @@ void BanWordsLayer<T>::allocateBuffer()
 
     mNoRepeatNgramSize = mBufferManager->pinnedPool(
         ITensor::makeShape({mDecoderDomain.getBatchSize()}), TRTDataType<SizeType32>::value);
+    mNgramNeedsReset.assign(mDecoderDomain.getBatchSize(), true);
+
+    mBadWordsAutomata = std::make_unique<WordsAutomata>(
+        mDecoderDomain.getBatchSize(), mDecoderDomain.getBeamWidth(), *mBufferManager);
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -74,6 +78,12 @@ void BanWordsLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, TensorC
             mNoRepeatNgramSize, mNoRepeatNgramSizeDevice, batchSlots,
             std::make_pair(0.f, std::numeric_limits<float>::max()), "no_repeat_ngram_size");
     }
+    mBadWordsAutomata->reset(batchSlots, batchSize);
+    auto const* batchSlotsPtr = bufferCast<SizeType32>(*batchSlots);
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        mNgramNeedsReset[batchSlotsPtr[bi]] = true;
+    }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -97,12 +107,65 @@ void BanWordsLayer<T>::banRepeatNGrams(TensorPtr const& logits, std::shared_ptr<
         auto sequenceLengthPtr = bufferCast<SizeType32>(*outputs->sequenceLength.value());
         auto noRepeatNgramSizeDevicePtr = bufferCastOrNull<SizeType32>(noRepeatNgramSizeDevice);
 
-        // Call to invokeBanRepeatNgram with dereferenced inputs
-        invokeBanRepeatNgram(logitsPtr, outputIdsPtr, finishedPtr, parentIdsPtr, batchSlotsPtr, sequenceLengthPtr,
-            decoderDomain.getBatchSize(), decoderDomain.getBeamWidth(), maxSeqLen, noRepeatNgramSizeDevicePtr,
-            decoderDomain.getVocabSizePadded(), maxStep, getStream());
+        if (decoderDomain.getBeamWidth() == 1)
+        {
+            // Ban with the n-gram tables, which only index the tokens generated since the last step
+            auto const params = prepareNgramTables(inputs->batchSlots, decoderDomain.getBatchSize(), maxSeqLen);
+            invokeBanRepeatNgramIncremental(params, logitsPtr, outputIdsPtr, finishedPtr, batchSlotsPtr,
+                sequenceLengthPtr, decoderDomain.getBatchSize(), noRepeatNgramSizeDevicePtr,
+                decoderDomain.getVocabSizePadded(), getStream());
+        }
+        else
+        {
+            // Beams take their history from their parents, so the whole sequence is scanned
+            invokeBanRepeatNgram(logitsPtr, outputIdsPtr, finishedPtr, parentIdsPtr, batchSlotsPtr, sequenceLengthPtr,
+                decoderDomain.getBatchSize(), decoderDomain.getBeamWidth(), maxSeqLen, noRepeatNgramSizeDevicePtr,
+                decoderDomain.getVocabSizePadded(), maxStep, getStream());
+        }
+    }
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template <typename T>
+NgramTablesParams BanWordsLayer<T>::prepareNgramTables(
+    TensorConstPtr const& batchSlots, SizeType32 batchSize, SizeType32 maxSeqLen)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    auto const maxBatchSize = mDecoderDomain.getBatchSize();
+    auto const tableSize = getNgramTableSize(maxSeqLen);
+    if (!mNgramTables || mNgramTables->getDimension<1>() < tableSize)
+    {
+        mNgramTables = mBufferManager->gpu(ITensor::makeShape({maxBatchSize, tableSize}), nvinfer1::DataType::kINT64);
+        mNgramNumIndexed = mBufferManager->gpu(ITensor::makeShape({maxBatchSize}), TRTDataType<SizeType32>::value);
+        mNgramSlotsToReset = mBufferManager->gpu(ITensor::makeShape({maxBatchSize}), TRTDataType<SizeType32>::value);
+        std::fill(mNgramNeedsReset.begin(), mNgramNeedsReset.end(), true);
+    }
+
+    NgramTablesParams params;
+    params.tables = reinterpret_cast<unsigned long long*>(bufferCast<int64_t>(*mNgramTables));
+    params.numIndexed = bufferCast<SizeType32>(*mNgramNumIndexed);
+    params.tableSize = static_cast<SizeType32>(mNgramTables->getDimension<1>());
+
+    std::vector<SizeType32> slotsToReset;
+    auto const* batchSlotsPtr = bufferCast<SizeType32>(*batchSlots);
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const batchSlot = batchSlotsPtr[bi];
+        if (mNgramNeedsReset[batchSlot])
+        {
+            slotsToReset.push_back(batchSlot);
+            mNgramNeedsReset[batchSlot] = false;
+        }
+    }
+    if (!slotsToReset.empty())
+    {
+        auto const numSlots = static_cast<SizeType32>(slotsToReset.size());
+        auto const slotsToResetSlice = ITensor::slice(mNgramSlotsToReset, 0, numSlots);
+        mBufferManager->copy(slotsToReset.data(), *slotsToResetSlice, MemoryType::kCPU);
+        invokeResetNgramTables(params, bufferCast<SizeType32>(*slotsToResetSlice), numSlots, getStream());
     }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+    return params;
 }
 
 template <typename T>
@@ -124,9 +187,12 @@ void BanWordsLayer<T>::banBadWords(TensorPtr const& logits, std::shared_ptr<Base
         auto sequenceLengthPtr = bufferCast<SizeType32>(*outputs->sequenceLength.value());
         auto batchSlotsPtr = bufferCast<SizeType32>(*batchSlots);
 
-        // Call to invokeBanBadWords with dereferenced inputs
-        invokeBanBadWords(logitsPtr, outputIdsPtr, parentIdsPtr, batchSlotsPtr, decoderDomain.getBatchSize(),
-            decoderDomain.getBeamWidth(), badWordsPtr, badWordsLens, maxBadWordsLength,
+        // Rebuild the automata of new requests. Their nodes are restored up to the last generated token
+        mBadWordsAutomata->update(*mBufferManager, badWordsPtr, badWordsLens, maxBadWordsLength, inputs->batchSlots,
+            decoderDomain.getBatchSize(), outputIdsPtr, parentIdsPtr, sequenceLengthPtr, /* numNewTokens */ nullptr,
+            /* defaultNumNewTokens */ 0, decoderDomain.getBeamWidth(), maxSeqLen);
+        invokeBanBadWordsAutomaton(mBadWordsAutomata->getParams(), logitsPtr, outputIdsPtr, parentIdsPtr,
+            batchSlotsPtr, decoderDomain.getBatchSize(), decoderDomain.getBeamWidth(), badWordsLens,
             decoderDomain.getVocabSizePadded(), sequenceLengthPtr, maxSeqLen, getStream());
     }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
@@ -18,8 +18,10 @@
 #pragma once
 
 #include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/kernels/banRepeatNgram.h"
 #include "tensorrt_llm/layers/baseLayer.h"
 #include "tensorrt_llm/layers/decodingParams.h"
+#include "tensorrt_llm/layers/layerUtils.h"
 
 #include <curand_kernel.h>
 
@@ -28,7 +30,8 @@ namespace tensorrt_llm::layers
 
 //! \brief Layer to ban specific words from being sampled.
 //! Supports banning bad words and repeating N grams.
-//! Set badWordsPtr, maxBadWordsLen and badWordsLengths to ban bad words.
+//! Set badWordsPtr, maxBadWordsLen and badWordsLengths to ban bad words. Bad words are matched with per-slot
+//! Aho-Corasick automata.
 //! Set noRepeatNgramSize in input params to ban repeat Ngrams.
 //! Layer modifies logits in-place.
 template <typename T>
@@ -53,6 +56,9 @@ private:
     void banBadWords(TensorPtr const& logits, std::shared_ptr<BaseDecodingOutputs> const& outputs,
         std::shared_ptr<DecodingInputs> const& inputs, BufferConstPtr const& batchSlots,
         DecoderDomain const& decoderDomain, runtime::SizeType32 maxSeqLen);
+    //! \brief Allocates the n-gram tables for maxSeqLen and clears the tables of new requests in batchSlots
+    kernels::NgramTablesParams prepareNgramTables(
+        TensorConstPtr const& batchSlots, runtime::SizeType32 batchSize, runtime::SizeType32 maxSeqLen);
     void banRepeatNGrams(TensorPtr const& logits, std::shared_ptr<BaseDecodingOutputs> const& outputs,
         std::shared_ptr<DecodingInputs> const& inputs, BufferConstPtr const& batchSlots,
         BufferPtr noRepeatNgramSizeDevice, DecoderDomain const& decoderDomain, runtime::SizeType32 maxSeqLen,
@@ -64,6 +70,12 @@ private:
     TensorPtr mNoRepeatNgramSizeDevice;
     TensorPtr mNoRepeatNgramSize;
     bool mUseNoRepeatNgramSize{false};
+    // Tables of the n-grams of each sequence, used for beamWidth == 1
+    TensorPtr mNgramTables;
+    TensorPtr mNgramNumIndexed;
+    TensorPtr mNgramSlotsToReset;
+    std::vector<bool> mNgramNeedsReset;
+    std::unique_ptr<WordsAutomata> mBadWordsAutomata;
 };
 
 } // namespace tensorrt_llm::layers
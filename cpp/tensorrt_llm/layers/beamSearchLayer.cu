@@ -74,6 +74,22 @@ void BeamSearchLayer<T>::setup(SizeType32 const batchSize, SizeType32 const beam
     fillBuffers(setupParams->earlyStopping, DefaultDecodingParams::getEarlyStopping(), mEarlyStoppingHost,
         mEarlyStoppingDevice, batchSlots, std::make_pair(-fltEpsilon, std::numeric_limits<int>::max()),
         "early stopping");
+    // Requests set up with a smaller beam width than the others only compute their own beams
+    fillBuffers(std::optional<std::vector<SizeType32>>{}, beamWidth, mBeamWidthHost, mBeamWidthDevice, batchSlots,
+        std::make_pair(0.f, static_cast<float>(mDecoderDomain.getBeamWidth())), "beam width");
+    if (setupParams->numBeamGroups)
+    {
+        for (auto const groups : *setupParams->numBeamGroups)
+        {
+            TLLM_CHECK_WITH_INFO(groups > 0 && beamWidth % groups == 0,
+                "Beam width (%d) must be a multiple of the number of beam groups (%d)", beamWidth, groups);
+        }
+    }
+    fillBuffers(setupParams->numBeamGroups, DefaultDecodingParams::getNumBeamGroups(), mNumBeamGroupsHost,
+        mNumBeamGroupsDevice, batchSlots, std::make_pair(1.f, static_cast<float>(beamWidth)), "number of beam groups");
+    fillBuffers(setupParams->beamGroupDiversityPenalty, DefaultDecodingParams::getBeamGroupDiversityPenalty(),
+        mGroupDiversityPenaltyHost, mGroupDiversityPenaltyDevice, batchSlots, std::make_pair(-fltEpsilon, fltMax),
+        "beam group diversity penalty");
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -88,6 +104,10 @@ __global__ void updateCacheIndirectionKernel(
     int const indexBatch = blockIdx.y;
     int const batchSlot = bh.batchSlots[indexBatch];
     int const indexBeam = blockIdx.z;
+    if (indexBeam >= bh.beamWidths[batchSlot])
+    {
+        return;
+    }
     int const indexBatchBeam = batchSlot * nBM + indexBeam;
     int const lastStep{bh.sequenceLengths[indexBatchBeam] - 1}; // the sequenceLengths is updated, need to minus 1
 
@@ -151,6 +171,9 @@ void BeamSearchLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> const
     bh.diversityRates = bufferCast<float>(*mBeamSearchDiversityRateDevice);
     bh.lengthPenalties = bufferCast<float>(*mLengthPenaltyDevice);
     bh.earlyStoppings = bufferCast<int>(*mEarlyStoppingDevice);
+    bh.beamWidths = bufferCast<SizeType32>(*mBeamWidthDevice);
+    bh.numBeamGroups = bufferCast<SizeType32>(*mNumBeamGroupsDevice);
+    bh.groupDiversityPenalties = bufferCast<float>(*mGroupDiversityPenaltyDevice);
     bh.inputLengths = bufferCast<SizeType32>(*ip->inputLengths.value());
     bh.endIds = bufferCast<TokenIdType>(*ip->endIds);
     bh.logProbsTiled = bufferCastOrNull<float>(op->outputLogProbsTiled);
@@ -162,9 +185,11 @@ void BeamSearchLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> const
 
     T const* logits = bufferCast<T>(*workspace->getDeviceRuntimeLogits());
     T const* bias = static_cast<T const*>(nullptr);
-    TLLM_CHECK_WITH_INFO(getWorkspaceSize() >= 2 * bh.nBatchSize * bh.nBeamWidth * bh.nBeamWidth * 2,
+    auto const topKWorkspaceSize
+        = static_cast<uint64_t>(bh.nBatchSize) * bh.nBeamWidth * bh.nBeamWidth * 2 * (sizeof(int) + 2 * sizeof(T));
+    TLLM_CHECK_WITH_INFO(getWorkspaceSize() >= topKWorkspaceSize,
         common::fmtstr("Workspace size (%lu) is not enough for topk softmax required (%lu).",
-            (uint64_t) getWorkspaceSize(), (uint64_t) (2 * bh.nMaxBatchSize * bh.nBeamWidth * bh.nBeamWidth * 2)));
+            (uint64_t) getWorkspaceSize(), topKWorkspaceSize));
 
     invokeTopkSoftMax(logits, bias, workspace->getRawWorkspaceDevicePtr(), bh, getStream());
     sync_check_cuda_error();
@@ -194,13 +219,21 @@ void BeamSearchLayer<T>::allocateBuffer(runtime::SizeType32 const batchSize, run
     mBeamSearchDiversityRateHost = mBufferManager->pinnedPool(batchSizeShape, TRTDataType<float>::value);
     mLengthPenaltyHost = mBufferManager->pinnedPool(batchSizeShape, TRTDataType<float>::value);
     mEarlyStoppingHost = mBufferManager->pinnedPool(batchSizeShape, TRTDataType<int>::value);
+    mBeamWidthHost = mBufferManager->pinnedPool(batchSizeShape, TRTDataType<SizeType32>::value);
+    mNumBeamGroupsHost = mBufferManager->pinnedPool(batchSizeShape, TRTDataType<SizeType32>::value);
+    mGroupDiversityPenaltyHost = mBufferManager->pinnedPool(batchSizeShape, TRTDataType<float>::value);
 
-    // Unit of workspaceSize is number of elements (not Byte), align to 4 for further optimization
-    mWorkspaceSize = common::roundUp(nTopK, 4) * 2 + common::roundUp(nTempBuffer, 4);
+    // Ids, values and scratch values of the candidates, and the partial results of the vocabulary parts.
+    // Numbers of elements are aligned to 4 for further optimization
+    mWorkspaceSize = common::roundUp(nTopK, 4) * (sizeof(int) + 2 * sizeof(T))
+        + common::roundUp(nTempBuffer, 4) * sizeof(float);
 
     mBeamSearchDiversityRateDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<float>::value);
     mLengthPenaltyDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<float>::value);
     mEarlyStoppingDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<int>::value);
+    mBeamWidthDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<SizeType32>::value);
+    mNumBeamGroupsDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<SizeType32>::value);
+    mGroupDiversityPenaltyDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<float>::value);
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -51,9 +51,15 @@ private:
     TensorPtr mBeamSearchDiversityRateDevice; //<! [batchSize] shaped, in device memory.
     TensorPtr mLengthPenaltyDevice;           //<! [batchSize] shaped, in device memory.
     TensorPtr mEarlyStoppingDevice;           //<! [batchSize] shaped, in device memory.
+    TensorPtr mBeamWidthDevice;               //<! [batchSize] shaped, in device memory.
+    TensorPtr mNumBeamGroupsDevice;           //<! [batchSize] shaped, in device memory.
+    TensorPtr mGroupDiversityPenaltyDevice;   //<! [batchSize] shaped, in device memory.
     TensorPtr mBeamSearchDiversityRateHost;   //<! [batchSize] shaped, in pinned host memory.
     TensorPtr mLengthPenaltyHost;             //<! [batchSize] shaped, in pinned host memory.
     TensorPtr mEarlyStoppingHost;             //<! [batchSize] shaped, in pinned host memory.
+    TensorPtr mBeamWidthHost;                 //<! [batchSize] shaped, in pinned host memory.
+    TensorPtr mNumBeamGroupsHost;             //<! [batchSize] shaped, in pinned host memory.
+    TensorPtr mGroupDiversityPenaltyHost;     //<! [batchSize] shaped, in pinned host memory.
 };
 
 } // namespace tensorrt_llm::layers
@@ -141,6 +141,7 @@ public:
     virtual ~DecodingSetupParams() = default;
 
     std::optional<std::vector<uint64_t>> randomSeed; // [1] or [setupBatchSize] on cpu
+    std::optional<std::vector<uint64_t>> randomStep; // [1] or [setupBatchSize] on cpu, see RandomState::step
     std::optional<std::vector<bool>> outputLogProbs; // [setupBatchSize]
     std::optional<std::vector<bool>> cumLogProbs;    // [setupBatchSize]
 };
@@ -157,15 +158,20 @@ public:
     std::optional<std::vector<float>> topPMin;                     // [setupBatchSize], must between [0, 1]
     std::optional<std::vector<runtime::TokenIdType>> topPResetIds; // [setupBatchSize]
     std::optional<bool> normalizeLogProbs;
+
+    // rejectionSamplingLayer
+    std::optional<std::vector<float>> runtimeMinP; // [1] or [setupBatchSize] on cpu
 };
 
 class BeamSearchSetupParams : public DecodingSetupParams
 {
 public:
     // BeamSearchLayer
-    std::optional<std::vector<float>> beamSearchDiversityRate; // [setupBatchSize] on cpu
-    std::optional<std::vector<float>> lengthPenalty;           // [setupBatchSize] on cpu
-    std::optional<std::vector<int>> earlyStopping;             // [setupBatchSize] on cpu
+    std::optional<std::vector<float>> beamSearchDiversityRate;    // [setupBatchSize] on cpu
+    std::optional<std::vector<float>> lengthPenalty;              // [setupBatchSize] on cpu
+    std::optional<std::vector<int>> earlyStopping;                // [setupBatchSize] on cpu
+    std::optional<std::vector<int>> numBeamGroups;                // [setupBatchSize] on cpu
+    std::optional<std::vector<float>> beamGroupDiversityPenalty;  // [setupBatchSize] on cpu
     bool hasDiffRuntimeArgs{false};
 };
 
@@ -175,6 +181,11 @@ public:
     // Medusa params
     std::optional<std::vector<runtime::SizeType32>> runtimeTopK;                   // [setupBatchSize] on cpu
     std::optional<std::vector<std::vector<runtime::SizeType32>>> runtimeHeadsTopK; // [setupBatchSize, maxMedusaHeads]
+
+    // Verification of draft tokens. Draft tokens are accepted on exact match with the sampled target tokens by default
+    std::optional<std::vector<float>> typicalAcceptanceThreshold; // [1] or [setupBatchSize] on cpu, 0 disables it
+    std::optional<std::vector<float>> typicalAcceptanceAlpha;     // [1] or [setupBatchSize] on cpu
+    std::optional<std::vector<bool>> useRejectionSampling;        // [1] or [setupBatchSize] on cpu
 };
 
 class ExplicitDraftTokensSetupParams : public DecodingSetupParams
@@ -327,7 +338,7 @@ public:
 
     //! optional parameters
     //! [localBatchSize]
-    curandState_t* curandStates{};
+    kernels::RandomState* randomStates{};
 
     //! Flag to mark that logits tensor contains probabilities
     bool probsComputed{};
@@ -399,6 +410,20 @@ public:
     //! It is not the same as batchSlots because it maps the ordered engine outputs to the respective seqSlot,
     //! while batchSlots is just a a list of active seqSlots.
     TensorConstPtr seqSlots; // [forwardBatchSize], on gpu
+
+    //! Dynamic draft tree mode. When the candidates are set, the draft head only expands candidates and the tree for
+    //! the next iteration is built by the layer, replacing `nextDraftTokens`, `nextFlatTokens`, `nextDraftIndices`,
+    //! `nextDraftProbs`, `masks`, `packedPosIds`, `generationLengths` and `maxGenLengthDevice`.
+    //! Candidate 0 is the root of the tree, i.e. the last accepted token.
+    std::optional<TensorConstPtr> draftTreeCandidateTokens; // [forwardBatchSize, maxNumCandidates], on gpu
+    //! Cumulative log probs of the candidates from the root.
+    std::optional<TensorConstPtr> draftTreeCandidateScores; // [forwardBatchSize, maxNumCandidates], float, on gpu
+    //! Index of the parent candidate, parents precede their children.
+    std::optional<TensorConstPtr> draftTreeCandidateParents; // [forwardBatchSize, maxNumCandidates], on gpu
+    //! Number of valid candidates per request, optional.
+    std::optional<TensorConstPtr> draftTreeNumCandidates; // [forwardBatchSize], on gpu
+    //! Draft distributions the candidates were sampled from, optional.
+    std::optional<TensorConstPtr> draftTreeCandidateProbs; // [forwardBatchSize, maxNumCandidates, vocabSize], on gpu
 };
 
 class LookaheadDecodingInputs : public DecodingInputs
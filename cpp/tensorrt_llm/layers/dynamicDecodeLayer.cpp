@@ -21,6 +21,7 @@
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 #include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/workspaceArena.h"
 
 #include <optional>
 
@@ -34,12 +35,16 @@ namespace tensorrt_llm::layers
 template <typename T>
 size_t DynamicDecodeLayer<T>::getWorkspaceSize() const noexcept
 {
-    size_t maxWorkspaceSize = 0;
-    for (auto const& layer : mLayers)
+    // Layers run one after another, so each one's workspace only lives during its own phase and they all alias
+    runtime::WorkspaceArena arena;
+    for (SizeType32 phase = 0; phase < static_cast<SizeType32>(mLayers.size()); ++phase)
     {
-        maxWorkspaceSize = std::max(maxWorkspaceSize, layer->getWorkspaceSize());
+        arena.addBlock(mLayers[phase]->getWorkspaceSize(), phase);
     }
-    return maxWorkspaceSize;
+    auto const workspaceSize = arena.getTotalSize();
+    TLLM_LOG_DEBUG("Decoding layers share a workspace of %zu bytes instead of %zu", workspaceSize,
+        arena.getUnsharedSize());
+    return workspaceSize;
 }
 
 template <typename T>
@@ -60,8 +65,6 @@ void DynamicDecodeLayer<T>::initialize()
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
 
-    mOutputIdsPtrHost = mBufferManager->pinnedPool(ITensor::makeShape({}), TRTDataType<TokenIdType*>::value);
-    mParentIdsPtrHost = mBufferManager->pinnedPool(ITensor::makeShape({}), TRTDataType<TokenIdType*>::value);
     mOutputIdsPtrDevice = mBufferManager->gpu(
         ITensor::makeShape({static_cast<SizeType32>(mDecoderDomain.getBatchSize())}), TRTDataType<TokenIdType*>::value);
     mParentIdsPtrDevice = mBufferManager->gpu(
@@ -69,8 +72,6 @@ void DynamicDecodeLayer<T>::initialize()
 
     allocateBuffer();
 
-    mCyclicStep = 0;
-    mRuntimeMaxSeqLen = 0;
     mConfiguredBeamWidth = -1;
 
     if (!mDecodingMode.isAuto())
@@ -174,19 +175,9 @@ void DynamicDecodeLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> co
         "Decoder is configured with beam width %d, but %d was given", mConfiguredBeamWidth,
         localDecoderDomain.getBeamWidth());
 
-    if (mOutputIdsPtrHost->getSize() == 0)
-    {
-        mOutputIdsPtrHost->reshape(
-            ITensor::makeShape({static_cast<int32_t>(maxSeqLen), static_cast<int32_t>(mDecoderDomain.getBatchSize())}));
-        mParentIdsPtrHost->reshape(
-            ITensor::makeShape({static_cast<int32_t>(maxSeqLen), static_cast<int32_t>(mDecoderDomain.getBatchSize())}));
-        mRuntimeMaxSeqLen = maxSeqLen;
-    }
-
-    mCyclicStep = mCyclicStep % mRuntimeMaxSeqLen;
     workspace->setDeviceBatchSlots(
         params->batchSlots); // Copy the input batch slots to device for faster access in devie usage (kernels).
-    prepareIdsPtrs(baseOutputs, params->batchSlots, localDecoderDomain.getBatchSize(),
+    prepareIdsPtrs(baseOutputs, workspace->getDeviceBatchSlotsPtr(), localDecoderDomain.getBatchSize(),
         localDecoderDomain.getBeamWidth(), maxSeqLen);
 
     for (auto& layer : mLayers)
@@ -199,8 +190,6 @@ void DynamicDecodeLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> co
         mDecoderDomain.getBatchSize(), localDecoderDomain.getBeamWidth(), maxSeqLen,
         mDecoderDomain.getMaxDecodingTokens(), mOutputLogProbs, getStream());
 
-    mCyclicStep += 1;
-
     sync_check_cuda_error();
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -220,36 +209,24 @@ void DynamicDecodeLayer<T>::forwardSync(std::shared_ptr<BaseDecodingOutputs> con
 
 template <typename T>
 void DynamicDecodeLayer<T>::prepareIdsPtrs(std::shared_ptr<BaseDecodingOutputs> const& outputs,
-    BufferConstPtr batchSlots, SizeType32 batchSize, SizeType32 beamWidth, SizeType32 maxSeqLen)
+    SizeType32 const* batchSlotsDevice, SizeType32 batchSize, SizeType32 beamWidth, SizeType32 maxSeqLen)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
-    TensorPtr outputIdsPtrHostSlice = ITensor::slice(mOutputIdsPtrHost, mCyclicStep, 1);
-    TensorPtr parentIdsPtrHostSlice = ITensor::slice(mParentIdsPtrHost, mCyclicStep, 1);
-    auto outputIdsPtrHost = runtime::bufferCast<TokenIdType*>(*outputIdsPtrHostSlice);
-    auto parentIdsPtrHost = runtime::bufferCast<TokenIdType*>(*parentIdsPtrHostSlice);
-    auto const* batchSlotsPtr = bufferCast<SizeType32>(*batchSlots);
-    for (SizeType32 bi = 0; bi < batchSize; bi++)
+    auto const strideBytes = static_cast<std::size_t>(beamWidth) * maxSeqLen * sizeof(TokenIdType);
+    auto** outputIdsPtrDevice = reinterpret_cast<void**>(bufferCast<TokenIdType*>(*mOutputIdsPtrDevice));
+    auto** parentIdsPtrDevice = reinterpret_cast<void**>(bufferCast<TokenIdType*>(*mParentIdsPtrDevice));
+    invokeFillBatchPtrs(outputIdsPtrDevice, bufferCast<TokenIdType>(*outputs->outputIds), strideBytes,
+        batchSlotsDevice, batchSlotsDevice, batchSize, getStream());
+    if (beamWidth > 1)
     {
-        auto const batchSlot = batchSlotsPtr[bi];
-        outputIdsPtrHost[batchSlot] = bufferCast<TokenIdType>(*outputs->outputIds) + batchSlot * beamWidth * maxSeqLen;
+        invokeFillBatchPtrs(parentIdsPtrDevice, bufferCast<TokenIdType>(*outputs->parentIds.value()), strideBytes,
+            batchSlotsDevice, batchSlotsDevice, batchSize, getStream());
     }
-    for (SizeType32 bi = 0; bi < batchSize; bi++)
+    else
     {
-        auto const batchSlot = batchSlotsPtr[bi];
-        if (beamWidth > 1)
-        {
-            parentIdsPtrHost[batchSlot]
-                = bufferCast<TokenIdType>(*outputs->parentIds.value()) + batchSlot * beamWidth * maxSeqLen;
-        }
-        else
-        {
-            auto mZeroParentIdsDevicePtr = bufferCast<TokenIdType>(*mZeroParentIdsDevice);
-            parentIdsPtrHost[batchSlot] = mZeroParentIdsDevicePtr + bi * beamWidth * maxSeqLen;
-        }
+        invokeFillBatchPtrs(parentIdsPtrDevice, bufferCast<TokenIdType>(*mZeroParentIdsDevice), strideBytes,
+            batchSlotsDevice, nullptr, batchSize, getStream());
     }
-
-    mBufferManager->copy(*outputIdsPtrHostSlice, *mOutputIdsPtrDevice);
-    mBufferManager->copy(*parentIdsPtrHostSlice, *mParentIdsPtrDevice);
     outputs->outputIdsPtr = ITensor::slice(mOutputIdsPtrDevice, 0, batchSize);
     outputs->parentIdsPtr = ITensor::slice(mParentIdsPtrDevice, 0, batchSize);
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
@@ -53,8 +53,11 @@ private:
     void initialize();
     void initializeLayers();
 
-    void prepareIdsPtrs(std::shared_ptr<BaseDecodingOutputs> const& outputs, BufferConstPtr batchSlots,
-        runtime::SizeType32 batchSize, runtime::SizeType32 beamWidth, runtime::SizeType32 maxSeqLen);
+    //! \brief Point outputIdsPtr and parentIdsPtr of the requests at their rows. Written on the device from the batch
+    //! slots on the device, so that the step can be captured in a CUDA graph.
+    void prepareIdsPtrs(std::shared_ptr<BaseDecodingOutputs> const& outputs,
+        runtime::SizeType32 const* batchSlotsDevice, runtime::SizeType32 batchSize, runtime::SizeType32 beamWidth,
+        runtime::SizeType32 maxSeqLen);
     void prepareOutputData(std::shared_ptr<BaseDecodingOutputs> const& outputs, BufferConstPtr batchSlots,
         runtime::SizeType32 batchSize, runtime::SizeType32 maxBatchSize, runtime::SizeType32 beamWidth,
         runtime::SizeType32 maxSeqLen, runtime::SizeType32 maxTokensPerStep, bool outputLogProbs, cudaStream_t stream);
@@ -67,8 +70,6 @@ private:
     executor::DecodingMode mDecodingMode;
 
     TensorPtr mZeroParentIdsDevice;
-    TensorPtr mOutputIdsPtrHost;
-    TensorPtr mParentIdsPtrHost;
     TensorPtr mOutputIdsPtrDevice;
     TensorPtr mParentIdsPtrDevice;
 
@@ -76,8 +77,6 @@ private:
 
     bool mOutputLogProbs{false};
 
-    runtime::SizeType32 mCyclicStep{0};
-    runtime::SizeType32 mRuntimeMaxSeqLen{0};
     runtime::SizeType32 mConfiguredBeamWidth{-1};
 };
 
@@ -58,8 +58,8 @@ void ExplicitDraftTokensLayer<T>::allocateBuffer()
 
     mWorkspaceSize = std::max(mScanWorkspaceSizeInBytes, mReduceWorkspaceSizeInBytes);
 
-    mCurandStatesDevice = mBufferManager->gpu(
-        ITensor::makeShape({mDecoderDomain.getBatchSize(), sizeof(curandState_t)}), TRTDataType<int8_t>::value);
+    mRandomStatesDevice = mBufferManager->gpu(
+        ITensor::makeShape({mDecoderDomain.getBatchSize(), sizeof(kernels::RandomState)}), TRTDataType<int8_t>::value);
     auto const batchSizeShape = ITensor::makeShape({mDecoderDomain.getBatchSize()});
     mGenerationLengthInclusiveSum = mBufferManager->gpu(batchSizeShape, TRTDataType<SizeType32>::value);
     mMaxGenerationLength = mBufferManager->gpu(ITensor::makeShape({1}), TRTDataType<SizeType32>::value);
@@ -70,6 +70,25 @@ void ExplicitDraftTokensLayer<T>::allocateBuffer()
                                                      * mDecoderDomain.getSpeculativeDecodingModule()->getMaxPathLen()}),
         TRTDataType<SizeType32>::value);
 
+    auto const maxDecodingTokens = mDecoderDomain.getSpeculativeDecodingModule()->getMaxDecodingTokens();
+    auto const treeShape = ITensor::makeShape({mDecoderDomain.getBatchSize(), maxDecodingTokens});
+    auto const pathsShape = ITensor::makeShape({mDecoderDomain.getBatchSize(),
+        mDecoderDomain.getSpeculativeDecodingModule()->getMaxNumPaths(),
+        mDecoderDomain.getSpeculativeDecodingModule()->getMaxPathLen()});
+    mTreeCandidateIndices = mBufferManager->gpu(treeShape, TRTDataType<SizeType32>::value);
+    mTreeParents = mBufferManager->gpu(treeShape, TRTDataType<SizeType32>::value);
+    mTreeDepths = mBufferManager->gpu(treeShape, TRTDataType<SizeType32>::value);
+    mTreeGenerationLengths = mBufferManager->gpu(batchSizeShape, TRTDataType<SizeType32>::value);
+    mTreeNextDraftTokens = mBufferManager->gpu(pathsShape, TRTDataType<TokenIdType>::value);
+    mTreeNextDraftIndices = mBufferManager->gpu(pathsShape, TRTDataType<SizeType32>::value);
+    mTreeNextFlatTokens = mBufferManager->gpu(
+        ITensor::makeShape({mDecoderDomain.getBatchSize() * maxDecodingTokens}), TRTDataType<TokenIdType>::value);
+    mTreePackedPosIds = mBufferManager->gpu(
+        ITensor::makeShape({mDecoderDomain.getBatchSize() * maxDecodingTokens}), TRTDataType<SizeType32>::value);
+    mTreeMasks = mBufferManager->gpu(
+        ITensor::makeShape({mDecoderDomain.getBatchSize(), maxDecodingTokens, maxDecodingTokens}),
+        TRTDataType<bool>::value);
+
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -81,8 +100,8 @@ void ExplicitDraftTokensLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWid
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
 
     auto setupParams = std::dynamic_pointer_cast<ExplicitDraftTokensSetupParams>(baseSetupParams);
-    workspace->initializeDeviceCurandStates(
-        setupParams->randomSeed, batchSize, workspace->getDeviceBatchSlots(), mCurandStatesDevice);
+    workspace->initializeDeviceRandomStates(
+        setupParams->randomSeed, batchSize, workspace->getDeviceBatchSlots(), mRandomStatesDevice);
 
     // Setup penalties.
     FillBuffers const fillBuffers{batchSize, mDecoderDomain.getBatchSize(), mBufferManager};
@@ -125,6 +144,29 @@ void ExplicitDraftTokensLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutpu
 
     // DO NOT CHANGE THE ORDER.
 
+    if (inputs->draftTreeCandidateTokens)
+    {
+        // Build the next draft tree from the draft head candidates in place of the engine provided one.
+        auto treeInputs = std::make_shared<ExplicitDraftTokensInputs>(*inputs);
+        if (mDecoderDtype == nvinfer1::DataType::kFLOAT)
+        {
+            buildDynamicDraftTree<float>(*outputs, *treeInputs, workspace);
+        }
+        else if (mDecoderDtype == nvinfer1::DataType::kHALF)
+        {
+            buildDynamicDraftTree<half>(*outputs, *treeInputs, workspace);
+        }
+        else if (mDecoderDtype == nvinfer1::DataType::kBF16)
+        {
+            buildDynamicDraftTree<__nv_bfloat16>(*outputs, *treeInputs, workspace);
+        }
+        inputs = treeInputs;
+    }
+    else
+    {
+        scanGenerationLengths(inputs->generationLengths, inputs->localBatchSize, workspace);
+    }
+
     // Convert masks to packed masks per request.
     convertPackedMask(*outputs, *inputs, workspace);
 
@@ -166,7 +208,7 @@ void ExplicitDraftTokensLayer<T>::fillContextBuffers(SizeType32 batchSize, Buffe
     params.randDataSample = bufferCast<Dtype>(*setupParams.randomDataSample);
     params.outputTemperatures = bufferCast<Dtype>(*setupParams.temperatures);
     params.inputTemperatures = bufferCastOrNull<float>(mTemperatureDevice);
-    params.curandState = reinterpret_cast<curandState_t*>(bufferCastOrNull<int8_t>(mCurandStatesDevice));
+    params.randomState = reinterpret_cast<kernels::RandomState*>(bufferCastOrNull<int8_t>(mRandomStatesDevice));
     params.batchSlots = workspace->getDeviceBatchSlotsPtr();
     params.batchSize = batchSize;
 
@@ -216,12 +258,12 @@ void ExplicitDraftTokensLayer<T>::splitInputDataToBatchSlots(ExplicitDraftTokens
     params.inputPositionIdsBase = bufferCast<SizeType32>(*inputs.positionIdsBase);
     params.packedPositionIds = bufferCast<SizeType32>(*inputs.packedPosIds);
     params.nextFlatTokens = bufferCast<TokenIdType>(*inputs.nextFlatTokens);
-    params.nextDraftProbs = bufferCast<Dtype>(*inputs.nextDraftProbs);
+    params.nextDraftProbs = bufferCastOrNull<Dtype>(inputs.nextDraftProbs);
     params.lastGenerationLengths = bufferCastOrNull<SizeType32>(inputs.lastGenerationLengths);
     params.generationLengthInclusiveSum = bufferCast<SizeType32>(*mGenerationLengthInclusiveSum);
     params.lastDraftIndices = bufferCast<SizeType32>(*inputs.lastDraftIndices);
     params.inputTemperatures = bufferCast<float>(*mTemperatureDevice);
-    params.curandState = reinterpret_cast<curandState_t*>(bufferCastOrNull<int8_t>(mCurandStatesDevice));
+    params.randomState = reinterpret_cast<kernels::RandomState*>(bufferCastOrNull<int8_t>(mRandomStatesDevice));
     params.batchSize = batchSize;
     params.numPaths = mDecoderDomain.getSpeculativeDecodingModule()->getMaxNumPaths();
     params.maxPathLength = mDecoderDomain.getSpeculativeDecodingModule()->getMaxPathLen();
@@ -237,7 +279,11 @@ void ExplicitDraftTokensLayer<T>::splitInputDataToBatchSlots(ExplicitDraftTokens
 
     invokeExtractExplicitDraftTokens(params, getStream());
 
-    invokeCopyProbs(params, getStream());
+    // Probs of the dynamic draft tree are gathered to the batch slots when the tree is built.
+    if (!inputs.draftTreeCandidateTokens)
+    {
+        invokeCopyProbs(params, getStream());
+    }
 
     // Copy generation lengths
     mBufferManager->copy(*outputs.generationLengths, *outputs.generationLengthsHost);
@@ -245,6 +291,86 @@ void ExplicitDraftTokensLayer<T>::splitInputDataToBatchSlots(ExplicitDraftTokens
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+template <typename T>
+void ExplicitDraftTokensLayer<T>::scanGenerationLengths(TensorConstPtr const& generationLengths, SizeType32 batchSize,
+    std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    auto generationLengthInclusiveSumPtr = bufferCastOrNull<SizeType32>(mGenerationLengthInclusiveSum);
+    auto workSpaceDevicePtr = workspace->getRawWorkspaceDevicePtr();
+    auto maxGenerationLengthPtr = bufferCastOrNull<SizeType32>(mMaxGenerationLength);
+    invokeScanReduceGenerationLengths(batchSize, bufferCast<SizeType32>(*generationLengths), workSpaceDevicePtr,
+        mScanWorkspaceSizeInBytes, generationLengthInclusiveSumPtr, workSpaceDevicePtr, mReduceWorkspaceSizeInBytes,
+        maxGenerationLengthPtr, getStream());
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template <typename T>
+template <typename Dtype>
+void ExplicitDraftTokensLayer<T>::buildDynamicDraftTree(ExplicitDraftTokensOutputs const& outputs,
+    ExplicitDraftTokensInputs& inputs, std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    TLLM_CHECK_WITH_INFO(inputs.draftTreeCandidateScores && inputs.draftTreeCandidateParents,
+        "Scores and parents of the candidates must be provided for the dynamic draft tree");
+
+    auto const batchSize = inputs.localBatchSize;
+    auto const& candidateTokens = inputs.draftTreeCandidateTokens.value();
+
+    DynamicDraftTreeParams<Dtype> params;
+    params.candidateTokens = bufferCast<TokenIdType>(*candidateTokens);
+    params.candidateScores = bufferCast<float>(*inputs.draftTreeCandidateScores.value());
+    params.candidateParents = bufferCast<SizeType32>(*inputs.draftTreeCandidateParents.value());
+    params.numCandidates
+        = inputs.draftTreeNumCandidates ? bufferCast<SizeType32>(*inputs.draftTreeNumCandidates.value()) : nullptr;
+    params.candidateProbs
+        = inputs.draftTreeCandidateProbs ? bufferCast<Dtype>(*inputs.draftTreeCandidateProbs.value()) : nullptr;
+    params.positionIdsBase = bufferCast<SizeType32>(*inputs.positionIdsBase);
+    params.batchSlots = bufferCast<SizeType32>(*inputs.seqSlots);
+
+    params.treeCandidateIndices = bufferCast<SizeType32>(*mTreeCandidateIndices);
+    params.treeParents = bufferCast<SizeType32>(*mTreeParents);
+    params.treeDepths = bufferCast<SizeType32>(*mTreeDepths);
+    params.generationLengths = bufferCast<SizeType32>(*mTreeGenerationLengths);
+    params.nextDraftTokens = bufferCast<TokenIdType>(*mTreeNextDraftTokens);
+    params.nextDraftIndices = bufferCast<SizeType32>(*mTreeNextDraftIndices);
+
+    params.generationLengthInclusiveSum = bufferCast<SizeType32>(*mGenerationLengthInclusiveSum);
+    params.maxGenerationLength = bufferCast<SizeType32>(*mMaxGenerationLength);
+    params.nextFlatTokens = bufferCast<TokenIdType>(*mTreeNextFlatTokens);
+    params.packedPosIds = bufferCast<SizeType32>(*mTreePackedPosIds);
+    params.masks = bufferCast<bool>(*mTreeMasks);
+    params.outputDraftProbs = bufferCast<Dtype>(*outputs.nextDraftProbs);
+
+    params.batchSize = batchSize;
+    params.maxNumCandidates = static_cast<SizeType32>(candidateTokens->getDimension<1>());
+    params.numPaths = mDecoderDomain.getSpeculativeDecodingModule()->getMaxNumPaths();
+    params.maxPathLength = mDecoderDomain.getSpeculativeDecodingModule()->getMaxPathLen();
+    params.maxDecodingTokens = mDecoderDomain.getSpeculativeDecodingModule()->getMaxDecodingTokens();
+    params.vocabSize = mDecoderDomain.getVocabSizePadded();
+
+    params.checkParams();
+
+    invokeBuildDynamicDraftTree(params, getStream());
+
+    scanGenerationLengths(mTreeGenerationLengths, batchSize, workspace);
+
+    invokePackDynamicDraftTree(params, getStream());
+
+    inputs.nextDraftTokens = mTreeNextDraftTokens;
+    inputs.nextDraftIndices = mTreeNextDraftIndices;
+    inputs.nextFlatTokens = mTreeNextFlatTokens;
+    inputs.packedPosIds = mTreePackedPosIds;
+    inputs.masks = mTreeMasks;
+    inputs.generationLengths = mTreeGenerationLengths;
+    inputs.maxGenLengthDevice = mMaxGenerationLength;
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 template <typename T>
 void ExplicitDraftTokensLayer<T>::convertPackedMask(ExplicitDraftTokensOutputs const& outputs,
     ExplicitDraftTokensInputs const& inputs, std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace)
@@ -253,17 +379,12 @@ void ExplicitDraftTokensLayer<T>::convertPackedMask(ExplicitDraftTokensOutputs c
 
     auto batchSlots = bufferCast<SizeType32>(*inputs.seqSlots);
     auto masksDevice = bufferCast<bool>(*inputs.masks);
-    auto generationLengths = bufferCast<SizeType32>(*inputs.generationLengths);
     auto packedMasksDevice = bufferCast<SizeType32>(*outputs.packedMasks);
 
     auto const batchSize = inputs.localBatchSize;
 
     auto generationLengthInclusiveSumPtr = bufferCastOrNull<SizeType32>(mGenerationLengthInclusiveSum);
-    auto workSpaceDevicePtr = workspace->getRawWorkspaceDevicePtr();
     auto maxGenerationLengthPtr = bufferCastOrNull<SizeType32>(mMaxGenerationLength);
-    invokeScanReduceGenerationLengths(batchSize, generationLengths, workSpaceDevicePtr, mScanWorkspaceSizeInBytes,
-        generationLengthInclusiveSumPtr, workSpaceDevicePtr, mReduceWorkspaceSizeInBytes, maxGenerationLengthPtr,
-        getStream());
 
     invokeConvertMaskToPackedMask(batchSize, generationLengthInclusiveSumPtr, maxGenerationLengthPtr, masksDevice,
         batchSlots, mDecoderDomain.getSpeculativeDecodingModule()->getMaxDecodingDraftTokens(),
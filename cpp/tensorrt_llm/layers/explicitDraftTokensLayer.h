@@ -51,6 +51,9 @@ public:
 private:
     void allocateBuffer();
 
+    void scanGenerationLengths(TensorConstPtr const& generationLengths, runtime::SizeType32 batchSize,
+        std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace);
+
     void convertPackedMask(ExplicitDraftTokensOutputs const& outputs, ExplicitDraftTokensInputs const& inputs,
         std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace);
 
@@ -62,6 +65,11 @@ private:
         ExplicitDraftTokensSetupParams const& setupParams,
         std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace);
 
+    //! \brief Builds the draft tree from the draft head candidates and replaces the tree related fields of `inputs`.
+    template <typename Dtype>
+    void buildDynamicDraftTree(ExplicitDraftTokensOutputs const& outputs, ExplicitDraftTokensInputs& inputs,
+        std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace);
+
     template <typename Dtype>
     void splitInputDataToBatchSlots(ExplicitDraftTokensOutputs const& outputs, ExplicitDraftTokensInputs const& inputs,
         std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace);
@@ -76,13 +84,24 @@ private:
     size_t mReduceWorkspaceSizeInBytes{0};
     size_t mWorkspaceSize{0};
 
-    TensorPtr mCurandStatesDevice;
+    TensorPtr mRandomStatesDevice;
     TensorPtr mGenerationLengthInclusiveSum;
     TensorPtr mMaxGenerationLength;
     TensorPtr mTemperatureDevice;
     TensorPtr mBestPathIndicesSlots;
     TensorPtr mLastDraftIndicesSlots;
 
+    // Dynamic draft tree buffers.
+    TensorPtr mTreeCandidateIndices;
+    TensorPtr mTreeParents;
+    TensorPtr mTreeDepths;
+    TensorPtr mTreeGenerationLengths;
+    TensorPtr mTreeNextDraftTokens;
+    TensorPtr mTreeNextDraftIndices;
+    TensorPtr mTreeNextFlatTokens;
+    TensorPtr mTreePackedPosIds;
+    TensorPtr mTreeMasks;
+
     TensorPtr mTemperature;
 
     std::optional<nvinfer1::DataType> mDecoderDtype{std::nullopt};
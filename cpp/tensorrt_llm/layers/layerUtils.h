@@ -17,6 +17,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstring>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -24,15 +25,66 @@
 #include <cuda_runtime.h>
 
 #include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/wordsAutomaton.h"
 #include "tensorrt_llm/layers/decodingParams.h"
 #include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/decodingLayerWorkspace.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 
 namespace tensorrt_llm::layers
 {
 
+//! \brief Collects updates of per-slot parameters kept in device arrays indexed by batch slot.
+//! \details The updates of all arrays of a layer are packed into one buffer and applied with a single host-to-device
+//! copy and a single kernel, so the setup cost scales with the number of changed slots instead of the batch size.
+class SlotParamsDelta
+{
+public:
+    template <typename T>
+    void add(T* deviceArray, runtime::SizeType32 slot, T value)
+    {
+        static_assert(sizeof(T) == sizeof(uint32_t), "Only 4-byte parameters are supported");
+        kernels::SlotParamUpdate update{deviceArray + slot, 0};
+        std::memcpy(&update.value, &value, sizeof(T));
+        mUpdates.push_back(update);
+    }
+
+    [[nodiscard]] std::vector<kernels::SlotParamUpdate> const& getUpdates() const noexcept
+    {
+        return mUpdates;
+    }
+
+    //! \brief Copies the pending updates into the workspace, applies them on stream and clears them.
+    void flush(runtime::BufferManager const& bufferManager, runtime::DecodingLayerWorkspace const& workspace)
+    {
+        if (mUpdates.empty())
+        {
+            return;
+        }
+        auto const workspaceBuffer = workspace.getWorkspaceDeviceBuffer();
+        runtime::DecodingLayerWorkspace::copyToWorkspace(bufferManager, mUpdates, workspaceBuffer);
+        kernels::invokeScatterSlotParams(static_cast<kernels::SlotParamUpdate const*>(workspaceBuffer->data()),
+            static_cast<int>(mUpdates.size()), bufferManager.getStream().get());
+        mUpdates.clear();
+    }
+
+    //! @returns workspace needed to flush up to maxNumUpdates updates in bytes
+    [[nodiscard]] static size_t getWorkspaceSize(runtime::SizeType32 maxNumUpdates) noexcept
+    {
+        return static_cast<size_t>(maxNumUpdates) * sizeof(kernels::SlotParamUpdate);
+    }
+
+private:
+    std::vector<kernels::SlotParamUpdate> mUpdates;
+};
+
 // Using a local lambda in beam search layers to fill buffers causes an internal compiler error on nvcc windows.
 // As a workaround and to promote DRY, the fill logic is refactored into FillBuffers below.
+// When delta is set, the host buffer is treated as a mirror of the device buffer and only the slots whose value
+// changed are recorded in delta, which the caller flushes. Otherwise the host buffer is copied to the device.
 struct FillBuffers
 {
     using BufferPtr = runtime::IBuffer::SharedPtr;
@@ -64,9 +116,17 @@ struct FillBuffers
             TLLM_CHECK_WITH_INFO(limits.first < static_cast<float>(value) && static_cast<float>(value) <= limits.second,
                 "%s param (%f) is out of limits (%f, %f]", name.c_str(), static_cast<float>(value), limits.first,
                 limits.second);
+            if (delta != nullptr && hostBufferRange[batchSlot] != value)
+            {
+                delta->add(runtime::bufferCast<T>(*deviceBuffer), batchSlot, value);
+            }
             hostBufferRange[batchSlot] = value;
         }
 
+        if (delta != nullptr)
+        {
+            return;
+        }
         if (batchSlots)
         {
             auto const hostSlice = runtime::IBuffer::slice(hostBuffer, 0, maxBatchSize);
@@ -84,8 +144,25 @@ struct FillBuffers
     runtime::SizeType32 batchSize;
     runtime::SizeType32 maxBatchSize;
     std::shared_ptr<runtime::BufferManager> mBufferManager;
+    SlotParamsDelta* delta{nullptr};
 };
 
+//! \brief Returns the local batch indices whose slot is not skipped, i.e. the compacted batch a layer has to process.
+inline std::vector<runtime::SizeType32> getActiveBatchIndices(
+    runtime::SizeType32 const* batchSlotsHost, bool const* skipDecodeHost, runtime::SizeType32 batchSize)
+{
+    std::vector<runtime::SizeType32> activeIndices;
+    activeIndices.reserve(batchSize);
+    for (runtime::SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        if (!skipDecodeHost[batchSlotsHost[bi]])
+        {
+            activeIndices.push_back(bi);
+        }
+    }
+    return activeIndices;
+}
+
 template <typename T>
 inline bool allOfBatchSlots(
     runtime::SizeType32 const* batchSlotsHost, T const* data, runtime::SizeType32 batchSize, T value)
@@ -128,4 +205,96 @@ inline DecoderDomain getLocalDecoderDomain(
     return {batchSize, beamWidth, vocabSize};
 }
 
+//! \brief Per-slot Aho-Corasick automata of a words list, e.g. stop words or bad words, see wordsAutomaton.h.
+//! \details The words lists are only known at forward, so setup marks the slots of new requests and the next update
+//! rebuilds their automata. The automata buffers grow with the longest words list, which rebuilds all automata. The
+//! node of a beam is restored from its output ids on rebuild, so growing does not lose matches in progress.
+class WordsAutomata
+{
+public:
+    WordsAutomata(runtime::SizeType32 maxBatchSize, runtime::SizeType32 maxBeamWidth,
+        runtime::BufferManager const& bufferManager)
+        : mNeedsBuild(maxBatchSize, true)
+    {
+        auto const statesShape = runtime::ITensor::makeShape({maxBatchSize, maxBeamWidth});
+        mStates = bufferManager.gpu(statesShape, nvinfer1::DataType::kINT32);
+        mPositions = bufferManager.gpu(statesShape, nvinfer1::DataType::kINT32);
+        mSlotsToBuild = bufferManager.gpu(runtime::ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+    }
+
+    //! \brief Marks the automata of batchSlots[0:batchSize] to be rebuilt by the next update
+    void reset(runtime::ITensor::SharedConstPtr const& batchSlots, runtime::SizeType32 batchSize)
+    {
+        auto const* batchSlotsPtr = runtime::bufferCast<runtime::SizeType32>(*batchSlots);
+        for (runtime::SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            mNeedsBuild[batchSlotsPtr[bi]] = true;
+        }
+    }
+
+    //! \brief Builds the automata of the marked slots in batchSlots[0:batchSize], on host.
+    //! See invokeBuildWordsAutomata for the other arguments.
+    void update(runtime::BufferManager const& bufferManager, runtime::TokenIdType const* const* words,
+        runtime::SizeType32 const* wordsLens, runtime::SizeType32 maxWordsLen,
+        runtime::ITensor::SharedConstPtr const& batchSlots, runtime::SizeType32 batchSize,
+        runtime::TokenIdType const** outputIds, runtime::SizeType32 const** parentIds,
+        runtime::SizeType32 const* sequenceLengths, runtime::SizeType32 const* numNewTokens,
+        runtime::SizeType32 defaultNumNewTokens, runtime::SizeType32 beamWidth, runtime::SizeType32 maxSeqLen)
+    {
+        if (maxWordsLen > mCapacity)
+        {
+            // FIXME: monotonically growing like maxWordsLen
+            mCapacity = static_cast<runtime::SizeType32>(common::roundUp(maxWordsLen, kCAPACITY_GRANULARITY));
+            auto const automatonSize = kernels::getWordsAutomatonSize(mCapacity);
+            mAutomata = bufferManager.gpu(
+                runtime::ITensor::makeShape({static_cast<runtime::SizeType32>(mNeedsBuild.size()),
+                    static_cast<runtime::SizeType32>(automatonSize)}),
+                nvinfer1::DataType::kINT32);
+            std::fill(mNeedsBuild.begin(), mNeedsBuild.end(), true);
+        }
+
+        std::vector<runtime::SizeType32> slotsToBuild;
+        auto const* batchSlotsPtr = runtime::bufferCast<runtime::SizeType32>(*batchSlots);
+        for (runtime::SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            auto const batchSlot = batchSlotsPtr[bi];
+            if (mNeedsBuild[batchSlot])
+            {
+                slotsToBuild.push_back(batchSlot);
+                mNeedsBuild[batchSlot] = false;
+            }
+        }
+        if (slotsToBuild.empty())
+        {
+            return;
+        }
+        auto const numSlots = static_cast<runtime::SizeType32>(slotsToBuild.size());
+        auto const slotsToBuildSlice = runtime::ITensor::slice(mSlotsToBuild, 0, numSlots);
+        bufferManager.copy(slotsToBuild.data(), *slotsToBuildSlice, runtime::MemoryType::kCPU);
+        kernels::invokeBuildWordsAutomata(getParams(), words, wordsLens,
+            runtime::bufferCast<runtime::SizeType32>(*slotsToBuildSlice), numSlots, outputIds, parentIds,
+            sequenceLengths, numNewTokens, defaultNumNewTokens, beamWidth, maxSeqLen, bufferManager.getStream().get());
+    }
+
+    [[nodiscard]] kernels::WordsAutomataParams getParams() const
+    {
+        kernels::WordsAutomataParams params;
+        params.automata = runtime::bufferCastOrNull<runtime::SizeType32>(mAutomata);
+        params.states = runtime::bufferCast<runtime::SizeType32>(*mStates);
+        params.positions = runtime::bufferCast<runtime::SizeType32>(*mPositions);
+        params.capacity = mCapacity;
+        return params;
+    }
+
+private:
+    static runtime::SizeType32 constexpr kCAPACITY_GRANULARITY{64};
+
+    std::vector<bool> mNeedsBuild;
+    runtime::SizeType32 mCapacity{0};
+    runtime::ITensor::SharedPtr mAutomata;
+    runtime::ITensor::SharedPtr mStates;
+    runtime::ITensor::SharedPtr mPositions;
+    runtime::ITensor::SharedPtr mSlotsToBuild;
+};
+
 } // namespace tensorrt_llm::layers
@@ -41,6 +41,7 @@ void LookaheadAlgorithm::setup(TensorConstPtr const& prompt, SizeType32 w, SizeT
 
     mPoolManager.setup(mG);
     mPoolManager.accept(prompt, mN);
+    mGuessLen = AdaptiveDraftLength(std::min(mN - 1, 1), std::min(mW, mG) * (mN - 1));
     mGoldenTokens = ITensor::slice(mGoldenTokensMax, 0, mN * 2 - 1);
     mPrefills = ITensor::slice(mPrefillsMax, 0, mN <= 1 ? 0 : mN - 2);
     mKeyTokens = ITensor::slice(mKeyTokensMax, 0, mW);
@@ -76,7 +77,7 @@ void LookaheadAlgorithm::accept(TensorConstPtr const& generatedTokens)
     TLLM_CHECK(genLen <= mN);
     std::copy(generatedRange.begin(), generatedRange.end(), goldRange.begin() + mN - 1);
     TensorPtr newGold = ITensor::slice(mGoldenTokens, 0, mN - 1 + genLen);
-    mPoolManager.accept(newGold, mN);
+    mPoolManager.accept(newGold, mN, true);
     std::copy(goldRange.begin() + genLen, goldRange.begin() + genLen + mN - 1, goldRange.begin());
 }
 
@@ -152,7 +153,9 @@ runtime::SizeType32 LookaheadAlgorithm::lookahead(TensorPtr const& draftTokens,
 runtime::SizeType32 LookaheadAlgorithm::guess(TensorPtr const& guessTokens, TensorPtr const& guessIds,
     TensorPtr const& samplingMask, runtime::SizeType32 offset, runtime::TokenIdType lastToken)
 {
-    auto guesses = mPoolManager.guess(lastToken, mW);
+    // Propose fewer guesses to requests whose guesses are rarely accepted, but always at least one
+    auto const maxGuesses = mN > 1 ? std::max((mGuessLen.getDraftLen() + mN - 2) / (mN - 1), 1) : 0;
+    auto guesses = mPoolManager.guess(lastToken, std::min(mW, maxGuesses));
 
     SizeType32 len = 0;
     std::for_each(guesses.begin(), guesses.end(), [&len](auto& a) { len += ITensor::volume(a->getShape()); });
@@ -260,6 +263,10 @@ void LookaheadAlgorithm::verify(TensorPtr const& accepted, TensorPtr const& acce
             hitIdx = i;
         }
     }
+    if (guesses > 0)
+    {
+        mGuessLen.update(mN - 1, maxHit);
+    }
 
     BufferRange<TokenIdType> acceptedRange(*accepted);
     acceptedRange[0] = newLastToken;
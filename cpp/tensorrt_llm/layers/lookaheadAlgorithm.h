@@ -19,6 +19,7 @@
 #include "lookaheadPoolManager.h"
 #include "tensorrt_llm/layers/baseLayer.h"
 #include "tensorrt_llm/layers/decodingParams.h"
+#include "tensorrt_llm/runtime/adaptiveDraftLength.h"
 #include "tensorrt_llm/runtime/common.h"
 #include <curand_kernel.h>
 
@@ -41,6 +42,7 @@ public:
         , mMaxG(maxG)
         , mFilling(0)
         , mPoolManager(maxG)
+        , mGuessLen(0, std::min(maxW, maxG) * std::max(maxN - 1, 0))
         , mId(id)
         , mGoldenTokensMax(
               runtime::BufferManager::cpu(runtime::ITensor::makeShape({maxN * 2 - 1}), nvinfer1::DataType::kINT32))
@@ -57,7 +59,13 @@ public:
     //! @brief setup per request, fill internal states from @param prompt.
     void setup(TensorConstPtr const& prompt, runtime::SizeType32 w, runtime::SizeType32 n, runtime::SizeType32 g);
 
-    //! @brief accept the new generated tokens.
+    //! @brief set the n-gram pool shared with the other requests of the model, nullptr for none.
+    void setSharedPool(std::shared_ptr<LookaheadSharedPool> sharedPool)
+    {
+        mPoolManager.setSharedPool(std::move(sharedPool));
+    }
+
+    //! @brief accept the new generated tokens and publish their n-grams to the shared pool.
     //! LookaheadDecodingLayer need call once for the first token in generation phase.
     void accept(TensorConstPtr const& generatedTokens);
 
@@ -102,6 +110,8 @@ private:
 
 private:
     LookaheadPoolManager mPoolManager;
+    //! number of verification branch tokens to propose, adapted to the acceptance of the request
+    runtime::AdaptiveDraftLength mGuessLen;
     //! the random prefill tokens,
     TensorPtr mPrefillsMax; // shape [mMaxN-2]
     TensorPtr mPrefills;    // shape [mN-2]
@@ -17,6 +17,7 @@
 #include "lookaheadDecodingLayer.h"
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
 #include "tensorrt_llm/common/logger.h"
 #include "tensorrt_llm/executor/executor.h"
 #include "tensorrt_llm/kernels/samplingTopKKernels.h"
@@ -52,9 +53,20 @@ LookaheadDecodingLayer<T>::CpuAlgorithmResources::CpuAlgorithmResources(DecoderD
     TLLM_CHECK_WITH_INFO(beamWidth == 1, "Lookahead requires beam width = 1");
     TLLM_CHECK_WITH_INFO(maxTokensPerStep == decodingTokens, "%d != %d", maxTokensPerStep, decodingTokens);
 
+    std::shared_ptr<LookaheadSharedPool> sharedPool;
+    if (auto const sharedPoolKeys = getEnvLookaheadSharedPoolKeys())
+    {
+        sharedPool = std::make_shared<LookaheadSharedPool>(*sharedPoolKeys, maxG);
+    }
     for (SizeType32 id = 0; id < maxBatchSize; id++)
     {
         mAlgos.emplace_back(maxW, maxN, maxG, id);
+        mAlgos.back().setSharedPool(sharedPool);
+    }
+    auto const numWorkers = std::min(maxBatchSize, kMaxNumWorkers);
+    if (numWorkers > 1)
+    {
+        mWorkerPool = std::make_unique<WorkerPool>(numWorkers);
     }
 
     mPrompts.reserve(maxBatchSize);
@@ -114,14 +126,55 @@ LookaheadDecodingLayer<T>::LookaheadDecodingLayer(
     mWorkspaceSize = getTopKWorkspaceSize<T>(maxBatchSize, maxTokensPerStep, maxTopK, vocabSizePadded);
     mTargetTokensDevice = mBufferManager->gpu(maxBatchShape2D, nvinfer1::DataType::kINT32);
     mSamplingMaskDevice = mBufferManager->gpu(maxBatchShape2D, nvinfer1::DataType::kBOOL);
-    mCurandStatesDevice
-        = mBufferManager->gpu(ITensor::makeShape({maxBatchSize, sizeof(curandState_t)}), nvinfer1::DataType::kINT8);
+    mRandomStatesDevice = mBufferManager->gpu(
+        ITensor::makeShape({maxBatchSize, sizeof(kernels::RandomState)}), nvinfer1::DataType::kINT8);
 
     mSetupWorkspaceSize = DecodingLayerWorkspace::calculateRequiredWorkspaceSize(
         std::make_pair(maxBatchShape1D, nvinfer1::DataType::kINT64));
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+template <typename T>
+template <typename Func>
+void LookaheadDecodingLayer<T>::forEachRequest(SizeType32 batchSize, Func&& func)
+{
+    auto const& pool = mCpuAlgo->mWorkerPool;
+    auto const numChunks = pool ? std::min(batchSize, static_cast<SizeType32>(pool->getNumWorkers())) : 1;
+    if (numChunks <= 1)
+    {
+        for (SizeType32 bi = 0; bi < batchSize; bi++)
+        {
+            func(bi);
+        }
+        return;
+    }
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(numChunks);
+    for (SizeType32 ci = 0; ci < numChunks; ci++)
+    {
+        auto const begin = batchSize * ci / numChunks;
+        auto const end = batchSize * (ci + 1) / numChunks;
+        futures.emplace_back(pool->enqueue(
+            [&func, begin, end]()
+            {
+                for (SizeType32 bi = begin; bi < end; bi++)
+                {
+                    func(bi);
+                }
+            }));
+    }
+    // Wait for all chunks before rethrowing, the tasks reference func
+    for (auto& future : futures)
+    {
+        future.wait();
+    }
+    for (auto& future : futures)
+    {
+        future.get();
+    }
+}
+
 template <typename T>
 void LookaheadDecodingLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, TensorConstPtr batchSlots,
     std::shared_ptr<BaseSetupParams> const& baseSetupParams,
@@ -148,21 +201,23 @@ void LookaheadDecodingLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth
         mBufferManager->getStream().synchronize(); // sync prompt gpu to cpu
 
         auto const batchSlotsRange = BufferRange<SizeType32 const>(*batchSlots);
-        for (SizeType32 bi = 0; bi < batchSize; bi++)
-        {
-            auto const gbi = batchSlotsRange[bi];
-            SizeType32 bi1orN = (algoConfigs.size() == 1) ? 0 : bi;
-            TLLM_LOG_DEBUG("CPU ALGO [ %d ] setup prompt %s", gbi, D(mCpuAlgo->mPrompts[bi]).values().c_str());
-            auto [w, n, g] = algoConfigs[bi1orN].get();
-            SizeType32 runtimeTokensPerStep = 0;
-            std::tie(runtimeTokensPerStep, std::ignore, std::ignore, std::ignore)
-                = executor::LookaheadDecodingConfig(w, n, g).calculateSpeculativeResource();
-            TLLM_CHECK_WITH_INFO(runtimeTokensPerStep <= mDecoderDomain.getMaxDecodingTokens(),
-                "runtime w(%d) n(%d) g(%d) exceeds maxTokensPerStep(%d)", w, n, g,
-                mDecoderDomain.getMaxDecodingTokens());
-            PRINT_VALUES(mCpuAlgo->mPrompts[bi]);
-            mCpuAlgo->mAlgos[gbi].setup(mCpuAlgo->mPrompts[bi], w, n, g);
-        }
+        // Filling the n-gram pools from the prompts is independent per request
+        forEachRequest(batchSize,
+            [&](SizeType32 bi)
+            {
+                auto const gbi = batchSlotsRange[bi];
+                SizeType32 bi1orN = (algoConfigs.size() == 1) ? 0 : bi;
+                TLLM_LOG_DEBUG("CPU ALGO [ %d ] setup prompt %s", gbi, D(mCpuAlgo->mPrompts[bi]).values().c_str());
+                auto [w, n, g] = algoConfigs[bi1orN].get();
+                SizeType32 runtimeTokensPerStep = 0;
+                std::tie(runtimeTokensPerStep, std::ignore, std::ignore, std::ignore)
+                    = executor::LookaheadDecodingConfig(w, n, g).calculateSpeculativeResource();
+                TLLM_CHECK_WITH_INFO(runtimeTokensPerStep <= mDecoderDomain.getMaxDecodingTokens(),
+                    "runtime w(%d) n(%d) g(%d) exceeds maxTokensPerStep(%d)", w, n, g,
+                    mDecoderDomain.getMaxDecodingTokens());
+                PRINT_VALUES(mCpuAlgo->mPrompts[bi]);
+                mCpuAlgo->mAlgos[gbi].setup(mCpuAlgo->mPrompts[bi], w, n, g);
+            });
 
         for (runtime::SizeType32 bi = 0; bi < batchSize; bi++)
         {
@@ -198,8 +253,8 @@ void LookaheadDecodingLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth
         mBufferManager->getStream().synchronize(); // sync outputs cpu to gpu
     }
 
-    workspace->initializeDeviceCurandStates(
-        setupParams->randomSeed, batchSize, workspace->getDeviceBatchSlots(), mCurandStatesDevice);
+    workspace->initializeDeviceRandomStates(
+        setupParams->randomSeed, batchSize, workspace->getDeviceBatchSlots(), mRandomStatesDevice);
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -232,7 +287,7 @@ void LookaheadDecodingLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs
     params.logProbs = bufferCastOrNull<T>(inputs->logits);
     params.outputIds = bufferCast<TokenIdType>(*mTargetTokensDevice);
     params.workspace = workspace->getRawWorkspaceDevicePtr();
-    params.curandState = reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*mCurandStatesDevice));
+    params.randomState = reinterpret_cast<kernels::RandomState*>(bufferCast<int8_t>(*mRandomStatesDevice));
     params.tokensPerStep = bufferCast<SizeType32>(*inputs->curTokensPerStep.value());
 
     TLLM_LOG_DEBUG(
@@ -335,73 +390,85 @@ void LookaheadDecodingLayer<T>::forwardSyncCPU(
     mBufferManager->setZero(*mCpuAlgo->mNumNewTokens);
     mBufferManager->setZero(*mCpuAlgo->mNumNewTokensCumSum);
 
+    // Sequence lengths before this step, where the accepted tokens are written to
+    std::vector<SizeType32> prevSequenceLengths(batchSize);
     for (SizeType32 bi = 0; bi < batchSize; bi++)
     {
-        SizeType32 gbi = batchSlotsRange[bi];
-        LookaheadAlgorithm& theAlgo(mCpuAlgo->mAlgos[gbi]);
-
-        SizeType32 const tokensPerStep = generationLengthsRange[gbi];
-        TensorPtr sampledTokens = ITensor::slice(mCpuAlgo->mTargetTokens, {gbi, 0}, tokensPerStep);
-        PRINT_VALUES(sampledTokens);
+        prevSequenceLengths[bi] = sequenceLengthsRange[batchSlotsRange[bi]];
+    }
 
-        if (tokensPerStep == 1)
+    // The algorithms of different requests only touch their own rows of the host buffers and run in parallel
+    forEachRequest(batchSize,
+        [&](SizeType32 bi)
         {
-            // The first step in generation phase has no draft tokens.
-            theAlgo.accept(sampledTokens);
-            mBufferManager->copy(*sampledTokens, *ITensor::slice(mCpuAlgo->mOutputIds, {gbi, 0}, tokensPerStep));
-            numNewTokensRange[gbi] = tokensPerStep;
-            BufferLocation<SizeType32>(*mCpuAlgo->mNextDraftLengths).at(gbi) = 0;
-        }
-        else
-        {
-            theAlgo.update(                                  //
-                ITensor::at(mCpuAlgo->mOutputIds, {gbi}),    //
-                ITensor::at(mCpuAlgo->mPathsOffsets, {gbi}), //
-                ITensor::at(mCpuAlgo->mNumNewTokens, {gbi}), //
-                sampledTokens,                               //
-                ITensor::at(mCpuAlgo->mEndIds, {gbi}));
-        }
+            SizeType32 gbi = batchSlotsRange[bi];
+            LookaheadAlgorithm& theAlgo(mCpuAlgo->mAlgos[gbi]);
 
-        auto maxNumNewTokens = mCpuAlgo->mOutputIds->getShape().d[1];
+            SizeType32 const tokensPerStep = generationLengthsRange[gbi];
+            TensorPtr sampledTokens = ITensor::slice(mCpuAlgo->mTargetTokens, {gbi, 0}, tokensPerStep);
+            PRINT_VALUES(sampledTokens);
 
-        mBufferManager->copy(*ITensor::at(mCpuAlgo->mOutputIds, {gbi}),
-            *ITensor::slice(outputs->outputIds, {gbi, 0, sequenceLengthsRange[gbi]}, maxNumNewTokens));
+            if (tokensPerStep == 1)
+            {
+                // The first step in generation phase has no draft tokens.
+                theAlgo.accept(sampledTokens);
+                mBufferManager->copy(*sampledTokens, *ITensor::slice(mCpuAlgo->mOutputIds, {gbi, 0}, tokensPerStep));
+                numNewTokensRange[gbi] = tokensPerStep;
+                BufferLocation<SizeType32>(*mCpuAlgo->mNextDraftLengths).at(gbi) = 0;
+            }
+            else
+            {
+                theAlgo.update(                                  //
+                    ITensor::at(mCpuAlgo->mOutputIds, {gbi}),    //
+                    ITensor::at(mCpuAlgo->mPathsOffsets, {gbi}), //
+                    ITensor::at(mCpuAlgo->mNumNewTokens, {gbi}), //
+                    sampledTokens,                               //
+                    ITensor::at(mCpuAlgo->mEndIds, {gbi}));
+            }
 
-        sequenceLengthsRange[gbi] += numNewTokensRange[gbi];
+            sequenceLengthsRange[gbi] += numNewTokensRange[gbi];
 
-        theAlgo.prepare(                                     //
-            ITensor::at(mCpuAlgo->mNextDraftTokens, {gbi}),  //
-            ITensor::at(mCpuAlgo->mNextDraftPosIds, {gbi}),  //
-            ITensor::at(mCpuAlgo->mSamplingMask, {gbi}),     //
-            ITensor::at(mCpuAlgo->mNextDraftLengths, {gbi}), //
-            ITensor::at(mCpuAlgo->mSequenceLengths, {gbi}),  //
-            ITensor::at(mCpuAlgo->mOutputIds, {gbi, numNewTokensRange[gbi] - 1}));
+            theAlgo.prepare(                                     //
+                ITensor::at(mCpuAlgo->mNextDraftTokens, {gbi}),  //
+                ITensor::at(mCpuAlgo->mNextDraftPosIds, {gbi}),  //
+                ITensor::at(mCpuAlgo->mSamplingMask, {gbi}),     //
+                ITensor::at(mCpuAlgo->mNextDraftLengths, {gbi}), //
+                ITensor::at(mCpuAlgo->mSequenceLengths, {gbi}),  //
+                ITensor::at(mCpuAlgo->mOutputIds, {gbi, numNewTokensRange[gbi] - 1}));
 
-        BufferLocation<SizeType32> posIdsLocation(*ITensor::at(mCpuAlgo->mPositionIds, {gbi}));
-        for (auto& posid : posIdsLocation)
-        {
-            posid = sequenceLengthsRange[gbi] - 1;
-        }
-        mBufferManager->copy(*ITensor::slice(mCpuAlgo->mNextDraftPosIds, {gbi, 0}, nextDraftLengthsRange[gbi]),
-            *ITensor::slice(mCpuAlgo->mPositionIds, {gbi, 1}, nextDraftLengthsRange[gbi]));
+            BufferLocation<SizeType32> posIdsLocation(*ITensor::at(mCpuAlgo->mPositionIds, {gbi}));
+            for (auto& posid : posIdsLocation)
+            {
+                posid = sequenceLengthsRange[gbi] - 1;
+            }
+            mBufferManager->copy(*ITensor::slice(mCpuAlgo->mNextDraftPosIds, {gbi, 0}, nextDraftLengthsRange[gbi]),
+                *ITensor::slice(mCpuAlgo->mPositionIds, {gbi, 1}, nextDraftLengthsRange[gbi]));
 
-        posIdsToMask(                                  //
-            ITensor::at(mCpuAlgo->mPackedMask, {gbi}), //
-            ITensor::slice(mCpuAlgo->mNextDraftPosIds, {gbi, 0}, nextDraftLengthsRange[gbi]));
+            posIdsToMask(                                  //
+                ITensor::at(mCpuAlgo->mPackedMask, {gbi}), //
+                ITensor::slice(mCpuAlgo->mNextDraftPosIds, {gbi, 0}, nextDraftLengthsRange[gbi]));
 
-        BufferRange<SizeType32> offsetRange(*ITensor::at(mCpuAlgo->mPositionOffsets, {gbi}));
-        TLLM_CHECK_WITH_INFO(
-            posIdsLocation.size() == offsetRange.size(), "%ld, %ld", posIdsLocation.size(), offsetRange.size());
-        for (auto i = 0; i < posIdsLocation.size(); i++)
-        {
-            offsetRange[i] = posIdsLocation[i] - posIdsLocation[0];
-        }
-        TensorPtr accepted = ITensor::slice(mCpuAlgo->mOutputIds, {gbi, 0}, numNewTokensRange[gbi]);
-        TensorPtr draft = ITensor::slice(mCpuAlgo->mNextDraftTokens, {gbi, 0}, nextDraftLengthsRange[gbi]);
+            BufferRange<SizeType32> offsetRange(*ITensor::at(mCpuAlgo->mPositionOffsets, {gbi}));
+            TLLM_CHECK_WITH_INFO(
+                posIdsLocation.size() == offsetRange.size(), "%ld, %ld", posIdsLocation.size(), offsetRange.size());
+            for (auto i = 0; i < posIdsLocation.size(); i++)
+            {
+                offsetRange[i] = posIdsLocation[i] - posIdsLocation[0];
+            }
+            TensorPtr accepted = ITensor::slice(mCpuAlgo->mOutputIds, {gbi, 0}, numNewTokensRange[gbi]);
+            TensorPtr draft = ITensor::slice(mCpuAlgo->mNextDraftTokens, {gbi, 0}, nextDraftLengthsRange[gbi]);
+
+            TLLM_LOG_DEBUG("CPU ALGO [ %d ] forward, %s", gbi, D(sampledTokens).values().c_str());
+            TLLM_LOG_DEBUG("[%d][%d] CPU ALGO [ %d ] forward, %s, %s", mGlobalSteps, batchSize, gbi,
+                D(accepted).values().c_str(), D(draft).values().c_str());
+        });
 
-        TLLM_LOG_DEBUG("CPU ALGO [ %d ] forward, %s", gbi, D(sampledTokens).values().c_str());
-        TLLM_LOG_DEBUG("[%d][%d] CPU ALGO [ %d ] forward, %s, %s", mGlobalSteps, batchSize, gbi,
-            D(accepted).values().c_str(), D(draft).values().c_str());
+    auto const maxNumNewTokens = mCpuAlgo->mOutputIds->getShape().d[1];
+    for (SizeType32 bi = 0; bi < batchSize; bi++)
+    {
+        SizeType32 gbi = batchSlotsRange[bi];
+        mBufferManager->copy(*ITensor::at(mCpuAlgo->mOutputIds, {gbi}),
+            *ITensor::slice(outputs->outputIds, {gbi, 0, prevSequenceLengths[bi]}, maxNumNewTokens));
     }
 
     numNewTokensCumSumRange[0] = 0;
@@ -20,6 +20,11 @@
 #include "tensorrt_llm/layers/baseLayer.h"
 #include "tensorrt_llm/layers/decodingParams.h"
 #include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/workerPool.h"
+
+#include <future>
+#include <memory>
+#include <vector>
 
 namespace tensorrt_llm::layers
 {
@@ -50,12 +55,17 @@ private:
         std::shared_ptr<LookaheadDecodingInputs> const& inputs);
     void posIdsToMask(TensorPtr mask, TensorConstPtr posIds);
 
+    //! \brief Runs func(bi) for all requests of the batch. The requests are split into contiguous chunks processed in
+    //! parallel on the worker pool. func must only touch the state of its own request.
+    template <typename Func>
+    void forEachRequest(runtime::SizeType32 batchSize, Func&& func);
+
 private:
     using Base::mDecoderDomain;
 
     size_t mWorkspaceSize{};
     size_t mSetupWorkspaceSize{};
-    TensorPtr mCurandStatesDevice;
+    TensorPtr mRandomStatesDevice;
     TensorPtr mTargetTokensDevice;
     TensorPtr mSamplingMaskDevice;
 
@@ -63,7 +73,11 @@ private:
     {
         explicit CpuAlgorithmResources(DecoderDomain const& decoderDomain);
 
+        //! Maximum number of threads running the per-request algorithms
+        static runtime::SizeType32 constexpr kMaxNumWorkers{8};
+
         std::vector<LookaheadAlgorithm> mAlgos;
+        std::unique_ptr<runtime::WorkerPool> mWorkerPool;
         std::vector<TensorPtr> mPrompts;
         TensorPtr mBatchSlots;
         TensorPtr mTargetTokens;
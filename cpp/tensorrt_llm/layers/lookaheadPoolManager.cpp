@@ -18,6 +18,8 @@
 #include "tensorrt_llm/common/logger.h"
 #include "tensorrt_llm/layers/lookaheadDecodingUtils.h"
 
+#include <algorithm>
+
 namespace tensorrt_llm::layers
 {
 
@@ -28,89 +30,128 @@ void LookaheadPoolManager::setup(SizeType32 guessSetSize)
     TLLM_CHECK(guessSetSize >= 0 && guessSetSize <= mGuessSetSizeMax);
     mGuessSetSize = guessSetSize;
     mTokenMap.clear();
+    mNgramLen = 0;
 }
 
-void LookaheadPoolManager::insertOne(Key key, TensorConstPtr const& ngram)
+void LookaheadPoolManager::insertOne(Key key, TokenIdType const* ngram, SizeType32 ngramLen)
 {
-    if (TLLM_UNLIKELY(ITensor::volume(ngram->getShape()) == 0 || mGuessSetSize == 0))
+    if (TLLM_UNLIKELY(ngramLen == 0 || mGuessSetSize == 0))
     {
         return;
     }
+    if (mNgramLen == 0)
+    {
+        mNgramLen = ngramLen;
+    }
+    TLLM_CHECK_WITH_INFO(ngramLen == mNgramLen, "All n-grams of the pool must have length %d, got %d", mNgramLen,
+        ngramLen);
 
-    auto search = mTokenMap.find(key);
-    if (search != mTokenMap.end())
+    auto& ngrams = mTokenMap[key];
+    for (auto it = ngrams.begin(); it != ngrams.end(); it += ngramLen)
     {
-        search->second.remove_if(
-            [&ngram](TensorConstPtr const& item)
-            {
-                BufferRange<TokenIdType const> ngramRange(*ngram);
-                BufferRange<TokenIdType const> itemRange(*item);
-                return std::equal(ngramRange.begin(), ngramRange.end(), itemRange.begin());
-            });
-        if (mGuessSetSize > 0 && search->second.size() >= mGuessSetSize)
+        if (std::equal(ngram, ngram + ngramLen, it))
         {
-            search->second.pop_front();
+            ngrams.erase(it, it + ngramLen);
+            break;
         }
-        search->second.push_back(ngram);
     }
-    else
+    if (mGuessSetSize > 0 && static_cast<SizeType32>(ngrams.size()) >= mGuessSetSize * ngramLen)
     {
-        mTokenMap.insert({key, std::list<TensorConstPtr>({ngram})});
+        ngrams.erase(ngrams.begin(), ngrams.begin() + ngramLen);
     }
+    ngrams.insert(ngrams.end(), ngram, ngram + ngramLen);
 }
 
-void LookaheadPoolManager::accept(TensorConstPtr const& prompt, SizeType32 level)
+void LookaheadPoolManager::accept(TensorConstPtr const& prompt, SizeType32 level, bool publish)
 {
     SizeType32 length = prompt->getShape().d[0];
     BufferRange<Key const> promptRange(*prompt);
     for (SizeType32 ti = 0; ti + level - 1 < length; ti++)
     {
-        auto key = promptRange[ti];
-        TensorPtr ngram = BufferManager::cpu(ITensor::makeShape({level - 1}), nvinfer1::DataType::kINT32);
-        BufferRange<TokenIdType const> sourceRange(*ITensor::slice(prompt, ti + 1, level - 1));
-        BufferRange<TokenIdType> ngramRange(*ngram);
-        std::copy(sourceRange.begin(), sourceRange.end(), ngramRange.begin());
-
-        insertOne(key, ngram);
+        insertOne(promptRange[ti], promptRange.begin() + ti + 1, level - 1);
+        if (publish && mSharedPool)
+        {
+            mSharedPool->insert(promptRange[ti], promptRange.begin() + ti + 1, level - 1);
+        }
+    }
+    // Requests whose prompt is too short for an n-gram can still guess from the shared pool
+    if (mNgramLen == 0 && mSharedPool && mGuessSetSize != 0)
+    {
+        mNgramLen = std::max(level - 1, 0);
     }
 }
 
+LookaheadPoolManager::TensorConstPtr LookaheadPoolManager::makeNgram(
+    NgramList const& ngrams, SizeType32 ngramIdx) const
+{
+    TensorPtr ngram = BufferManager::cpu(ITensor::makeShape({mNgramLen}), nvinfer1::DataType::kINT32);
+    auto const begin = ngrams.begin() + ngramIdx * mNgramLen;
+    std::copy(begin, begin + mNgramLen, BufferRange<TokenIdType>(*ngram).begin());
+    return ngram;
+}
+
 std::list<LookaheadPoolManager::TensorConstPtr> LookaheadPoolManager::guess(Key lastToken, SizeType32 guessSize) const
 {
+    std::list<TensorConstPtr> result;
     auto search = mTokenMap.find(lastToken);
-    if (search != mTokenMap.end())
+    NgramList const* ownNgrams{nullptr};
+    if (search != mTokenMap.end() && mNgramLen > 0)
     {
-        auto ngrams = search->second;
-        if (ngrams.size() > guessSize)
+        ownNgrams = &search->second;
+        auto const numNgrams = static_cast<SizeType32>(ownNgrams->size()) / mNgramLen;
+        for (SizeType32 ni = std::max(0, numNgrams - guessSize); ni < numNgrams; ni++)
         {
-            auto it = std::prev(ngrams.end(), guessSize);
-            return std::list<TensorConstPtr>(it, ngrams.end());
+            result.push_back(makeNgram(*ownNgrams, ni));
         }
-        else
+    }
+    if (mSharedPool && mNgramLen > 0 && static_cast<SizeType32>(result.size()) < guessSize)
+    {
+        auto const shared = mSharedPool->find(lastToken, mNgramLen, guessSize);
+        auto const numShared = static_cast<SizeType32>(shared.size()) / mNgramLen;
+        // Newest first, skipping the n-grams of the request itself
+        for (SizeType32 ni = numShared - 1; ni >= 0 && static_cast<SizeType32>(result.size()) < guessSize; ni--)
         {
-            return ngrams;
+            auto const begin = shared.begin() + ni * mNgramLen;
+            auto isOwn = false;
+            for (std::size_t oi = 0; ownNgrams && !isOwn && oi < ownNgrams->size(); oi += mNgramLen)
+            {
+                isOwn = std::equal(begin, begin + mNgramLen, ownNgrams->begin() + oi);
+            }
+            if (!isOwn)
+            {
+                result.push_front(makeNgram(shared, ni));
+            }
         }
     }
-    else
+    return result;
+}
+
+std::unordered_map<LookaheadPoolManager::Key, std::list<LookaheadPoolManager::TensorConstPtr>>
+LookaheadPoolManager::getMap() const
+{
+    std::unordered_map<Key, std::list<TensorConstPtr>> map;
+    for (auto const& [key, ngrams] : mTokenMap)
     {
-        return std::list<TensorConstPtr>();
+        auto& list = map[key];
+        for (SizeType32 ni = 0; mNgramLen > 0 && ni < static_cast<SizeType32>(ngrams.size()) / mNgramLen; ni++)
+        {
+            list.push_back(makeNgram(ngrams, ni));
+        }
     }
+    return map;
 }
 
 void LookaheadPoolManager::update(TensorConstPtr const& keyTokens, TensorConstPtr const& ngramTokens)
 {
     TLLM_CHECK(keyTokens->getShape().d[0] == ngramTokens->getShape().d[0]);
     BufferRange<Key const> keyRange(*keyTokens);
-    auto window = ngramTokens->getShape().d[0];
+    BufferRange<TokenIdType const> ngramRange(*ngramTokens);
+    auto const window = static_cast<SizeType32>(ngramTokens->getShape().d[0]);
+    auto const ngramLen = window == 0 ? 0 : static_cast<SizeType32>(ngramRange.size()) / window;
 
     for (SizeType32 wi = 0; wi < window; wi++)
     {
-        TensorConstPtr source = ITensor::at(ngramTokens, {wi});
-        TensorPtr ngram = BufferManager::cpu(source->getShape(), nvinfer1::DataType::kINT32);
-        BufferRange<TokenIdType const> sourceRange(*source);
-        BufferRange<TokenIdType> ngramRange(*ngram);
-        std::copy(sourceRange.begin(), sourceRange.end(), ngramRange.begin());
-        insertOne(keyRange[wi], ngram);
+        insertOne(keyRange[wi], ngramRange.begin() + wi * ngramLen, ngramLen);
     }
 }
 
@@ -17,8 +17,11 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
+#include "tensorrt_llm/layers/lookaheadSharedPool.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/iTensor.h"
 
@@ -42,15 +45,23 @@ public:
     //! @param guessSetSize the runtime guessSetSize.
     void setup(runtime::SizeType32 guessSetSize);
 
+    //! @brief set the pool shared with the other requests of the model, nullptr for none. Kept across setup.
+    void setSharedPool(std::shared_ptr<LookaheadSharedPool> sharedPool)
+    {
+        mSharedPool = std::move(sharedPool);
+    }
+
     //! @brief fill token map from accepted tokens, including prompt.
     //! @param prompt the user input prompt, [length] on cpu
     //! @param level the n-gram length
-    void accept(TensorConstPtr const& prompt, runtime::SizeType32 level);
+    //! @param publish whether to add the n-grams to the shared pool as well
+    void accept(TensorConstPtr const& prompt, runtime::SizeType32 level, bool publish = false);
 
     //! @brief  get a list of guess tokens
     //! @param lastToken the newest golden token
     //! @param guessSize at most guessSize candidates returned
-    //! @return the list guess tokens, with list size <= guessSize
+    //! @return the list guess tokens, with list size <= guessSize. If the token map has fewer n-grams for lastToken,
+    //! the shared pool fills up the front of the list.
     std::list<TensorConstPtr> guess(Key lastToken, runtime::SizeType32 guessSize) const;
 
     //! @brief update token map with new generated tokens
@@ -58,17 +69,24 @@ public:
     //! @param ngramTokens the new shifted lookahead window, as the ngrams, [window, ngramLen] on cpu
     void update(TensorConstPtr const& keyTokens, TensorConstPtr const& ngramTokens);
 
-    std::unordered_map<Key, std::list<TensorConstPtr>> const& getMap() const
-    {
-        return mTokenMap;
-    }
+    //! @brief a copy of the token map with the n-grams of each key as tensors, oldest first. For inspection only.
+    std::unordered_map<Key, std::list<TensorConstPtr>> getMap() const;
 
 private:
-    void insertOne(Key key, TensorConstPtr const& ngram);
+    void insertOne(Key key, runtime::TokenIdType const* ngram, runtime::SizeType32 ngramLen);
+
+    //! @brief the n-grams of one key stored back to back, oldest first
+    using NgramList = std::vector<runtime::TokenIdType>;
+
+    [[nodiscard]] TensorConstPtr makeNgram(NgramList const& ngrams, runtime::SizeType32 ngramIdx) const;
 
 private:
-    //! @brief the token map with token as key and list of n-gram as value
-    std::unordered_map<Key, std::list<TensorConstPtr>> mTokenMap;
+    //! @brief the token map with token as key and flat list of n-grams as value
+    std::unordered_map<Key, NgramList> mTokenMap;
+    //! @brief length of all n-grams in the pool, set by the first insertion after setup
+    runtime::SizeType32 mNgramLen{0};
+    //! @brief pool shared with the other requests of the model, may be nullptr
+    std::shared_ptr<LookaheadSharedPool> mSharedPool;
     //! @brief guess set size, -1 for infinite size
     runtime::SizeType32 const mGuessSetSizeMax;
     runtime::SizeType32 mGuessSetSize;
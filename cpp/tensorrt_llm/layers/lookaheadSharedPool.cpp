@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/layers/lookaheadSharedPool.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace tensorrt_llm::layers
+{
+
+using namespace tensorrt_llm::runtime;
+
+LookaheadSharedPool::LookaheadSharedPool(SizeType32 maxKeys, SizeType32 ngramsPerKey, SizeType32 numShards)
+    : mKeysPerShard{(maxKeys + numShards - 1) / std::max(numShards, 1)}
+    , mNgramsPerKey{ngramsPerKey}
+{
+    TLLM_CHECK_WITH_INFO(maxKeys > 0 && ngramsPerKey > 0 && numShards > 0,
+        "Invalid shared lookahead pool of %d keys with %d n-grams in %d shards", maxKeys, ngramsPerKey, numShards);
+    mShards.reserve(numShards);
+    for (SizeType32 si = 0; si < numShards; ++si)
+    {
+        mShards.push_back(std::make_unique<Shard>());
+    }
+}
+
+LookaheadSharedPool::Shard& LookaheadSharedPool::getShard(PoolKey key) const
+{
+    return *mShards[std::hash<PoolKey>{}(key) % mShards.size()];
+}
+
+void LookaheadSharedPool::insert(Key key, TokenIdType const* ngram, SizeType32 ngramLen)
+{
+    if (ngramLen <= 0)
+    {
+        return;
+    }
+    auto const poolKey = makeKey(key, ngramLen);
+    auto& shard = getShard(poolKey);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.entries.find(poolKey);
+    if (it == shard.entries.end())
+    {
+        if (static_cast<SizeType32>(shard.entries.size()) >= mKeysPerShard)
+        {
+            shard.entries.erase(shard.lru.back());
+            shard.lru.pop_back();
+        }
+        shard.lru.push_front(poolKey);
+        it = shard.entries.emplace(poolKey, Entry{{}, shard.lru.begin()}).first;
+    }
+    else
+    {
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lruIt);
+    }
+
+    auto& ngrams = it->second.ngrams;
+    for (auto ni = ngrams.begin(); ni != ngrams.end(); ni += ngramLen)
+    {
+        if (std::equal(ngram, ngram + ngramLen, ni))
+        {
+            ngrams.erase(ni, ni + ngramLen);
+            break;
+        }
+    }
+    if (static_cast<SizeType32>(ngrams.size()) >= mNgramsPerKey * ngramLen)
+    {
+        ngrams.erase(ngrams.begin(), ngrams.begin() + ngramLen);
+    }
+    ngrams.insert(ngrams.end(), ngram, ngram + ngramLen);
+}
+
+std::vector<TokenIdType> LookaheadSharedPool::find(Key key, SizeType32 ngramLen, SizeType32 maxNgrams)
+{
+    if (ngramLen <= 0 || maxNgrams <= 0)
+    {
+        return {};
+    }
+    auto const poolKey = makeKey(key, ngramLen);
+    auto& shard = getShard(poolKey);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto const it = shard.entries.find(poolKey);
+    if (it == shard.entries.end())
+    {
+        return {};
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lruIt);
+    auto const& ngrams = it->second.ngrams;
+    auto const numTokens = std::min(ngrams.size(), static_cast<std::size_t>(maxNgrams) * ngramLen);
+    return std::vector<TokenIdType>(ngrams.end() - numTokens, ngrams.end());
+}
+
+SizeType32 LookaheadSharedPool::getNumKeys() const
+{
+    SizeType32 numKeys{0};
+    for (auto const& shard : mShards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        numKeys += static_cast<SizeType32>(shard->entries.size());
+    }
+    return numKeys;
+}
+
+} // namespace tensorrt_llm::layers
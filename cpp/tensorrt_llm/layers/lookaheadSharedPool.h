@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::layers
+{
+
+//! @brief A bounded n-gram pool shared by the lookahead requests of a model.
+//! @details Requests publish the n-grams of the tokens they accepted, and requests whose own pool has fewer n-grams
+//! for their last token than they may guess fill up from this pool, so requests with similar outputs, e.g. templated
+//! JSON, profit from each other. Every key keeps its most recent n-grams, and the least recently used keys are evicted
+//! once the pool is full. The keys are spread over shards with a lock each, so the lookahead workers of a batch rarely
+//! wait on each other.
+class LookaheadSharedPool
+{
+public:
+    using Key = runtime::TokenIdType;
+
+    //! @param maxKeys keys kept in the pool, n-grams of different lengths have different keys
+    //! @param ngramsPerKey n-grams kept per key
+    LookaheadSharedPool(
+        runtime::SizeType32 maxKeys, runtime::SizeType32 ngramsPerKey, runtime::SizeType32 numShards = 16);
+
+    //! @brief add an n-gram that followed key, moving it to the back if it is in the pool already.
+    void insert(Key key, runtime::TokenIdType const* ngram, runtime::SizeType32 ngramLen);
+
+    //! @brief the most recent n-grams of length ngramLen that followed key.
+    //! @return at most maxNgrams n-grams back to back, oldest first
+    [[nodiscard]] std::vector<runtime::TokenIdType> find(
+        Key key, runtime::SizeType32 ngramLen, runtime::SizeType32 maxNgrams);
+
+    [[nodiscard]] runtime::SizeType32 getNumKeys() const;
+
+private:
+    //! @brief the token and the n-gram length
+    using PoolKey = std::uint64_t;
+
+    struct Entry
+    {
+        //! @brief the n-grams back to back, oldest first
+        std::vector<runtime::TokenIdType> ngrams;
+        std::list<PoolKey>::iterator lruIt;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        //! @brief keys, most recently used first
+        std::list<PoolKey> lru;
+        std::unordered_map<PoolKey, Entry> entries;
+    };
+
+    [[nodiscard]] static PoolKey makeKey(Key key, runtime::SizeType32 ngramLen) noexcept
+    {
+        return (static_cast<PoolKey>(ngramLen) << 32) | static_cast<std::uint32_t>(key);
+    }
+
+    [[nodiscard]] Shard& getShard(PoolKey key) const;
+
+    runtime::SizeType32 mKeysPerShard;
+    runtime::SizeType32 mNgramsPerKey;
+    std::vector<std::unique_ptr<Shard>> mShards;
+};
+
+} // namespace tensorrt_llm::layers
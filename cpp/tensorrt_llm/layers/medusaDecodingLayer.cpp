@@ -18,11 +18,13 @@
 #include "tensorrt_llm/kernels/decodingCommon.h"
 #include "tensorrt_llm/kernels/samplingTopKKernels.h"
 #include "tensorrt_llm/kernels/speculativeDecoding/medusaDecodingKernels.h"
+#include "tensorrt_llm/layers/defaultDecodingParams.h"
 #include "tensorrt_llm/layers/layerUtils.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 
 #include <algorithm>
+#include <limits>
 
 using namespace tensorrt_llm::common;
 using namespace tensorrt_llm::kernels;
@@ -69,8 +71,9 @@ void MedusaDecodingLayer<T>::allocateBuffer()
 
     auto const batchSize = mDecoderDomain.getBatchSize();
     auto const batchSizeShape = ITensor::makeShape({mDecoderDomain.getBatchSize()});
-    mCurandStatesDevice = mBufferManager->gpu(
-        ITensor::makeShape({static_cast<int32_t>(batchSize * sizeof(curandState_t))}), TRTDataType<int8_t>::value);
+    mRandomStatesDevice
+        = mBufferManager->gpu(ITensor::makeShape({static_cast<int32_t>(batchSize * sizeof(kernels::RandomState))}),
+            TRTDataType<int8_t>::value);
     mRuntimeTopKDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<SizeType32>::value);
     mTargetTokensDevice = mBufferManager->gpu(
         ITensor::makeShape({batchSize, mDecoderDomain.getMaxDecodingTokens()}), TRTDataType<TokenIdType>::value);
@@ -78,13 +81,29 @@ void MedusaDecodingLayer<T>::allocateBuffer()
         = mBufferManager->gpu(ITensor::makeShape({batchSize * maxDraftPathLen}), TRTDataType<uint64_t>::value);
     mMedusaSelectedLogitsPtrsDevice
         = mBufferManager->gpu(ITensor::makeShape({batchSize, maxDraftPathLen}), TRTDataType<T*>::value);
-    mCurandStatesMedusaLogitsDevice = mBufferManager->gpu(
-        ITensor::makeShape({batchSize, maxDraftPathLen, sizeof(curandState_t)}), TRTDataType<int8_t>::value);
+    mRandomStatesMedusaLogitsDevice = mBufferManager->gpu(
+        ITensor::makeShape({batchSize, maxDraftPathLen, sizeof(kernels::RandomState)}), TRTDataType<int8_t>::value);
     mRuntimeTopKPerRequestPerMedusaHeadDevice
         = mBufferManager->gpu(ITensor::makeShape({batchSize, maxDraftPathLen}), TRTDataType<SizeType32>::value);
     mNewDraftTokensDevice = mBufferManager->gpu(
         ITensor::makeShape({batchSize, mDecoderDomain.getMaxDecodingTokens()}), TRTDataType<TokenIdType>::value);
     mBestPathIdsDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<SizeType32>::value);
+    mNodeAcceptCountsDevice = mBufferManager->gpu(
+        ITensor::makeShape({mDecoderDomain.getMaxDecodingTokens()}), TRTDataType<SizeType32>::value);
+    mBufferManager->setZero(*mNodeAcceptCountsDevice);
+
+    mAcceptanceModes = mBufferManager->pinnedPool(batchSizeShape, TRTDataType<SizeType32>::value);
+    mAcceptanceModesDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<SizeType32>::value);
+    mTypicalAcceptanceThreshold = mBufferManager->pinnedPool(batchSizeShape, TRTDataType<float>::value);
+    mTypicalAcceptanceThresholdDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<float>::value);
+    mTypicalAcceptanceAlpha = mBufferManager->pinnedPool(batchSizeShape, TRTDataType<float>::value);
+    mTypicalAcceptanceAlphaDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<float>::value);
+    auto const targetRowsShape = ITensor::makeShape({batchSize, mDecoderDomain.getMaxDecodingTokens()});
+    mTargetLogNormalizersDevice = mBufferManager->gpu(targetRowsShape, TRTDataType<float>::value);
+    mTargetAcceptanceThresholdsDevice = mBufferManager->gpu(targetRowsShape, TRTDataType<float>::value);
+    auto acceptanceModesRange = BufferRange<SizeType32>(*mAcceptanceModes);
+    std::fill(acceptanceModesRange.begin(), acceptanceModesRange.end(),
+        static_cast<SizeType32>(MedusaAcceptanceMode::kEXACT_MATCH));
 
     mTiledBatchSlotsSetup = BufferManager::pinnedPool(
         ITensor::makeShape({static_cast<SizeType32>(mDecoderDomain.getBatchSize() * maxDraftPathLen)}),
@@ -108,8 +127,8 @@ void MedusaDecodingLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, T
 
     auto setupParams = std::dynamic_pointer_cast<MedusaSetupParams>(baseSetupParams);
 
-    workspace->initializeDeviceCurandStates(
-        setupParams->randomSeed, batchSize, workspace->getDeviceBatchSlots(), mCurandStatesDevice);
+    workspace->initializeDeviceRandomStates(
+        setupParams->randomSeed, batchSize, workspace->getDeviceBatchSlots(), mRandomStatesDevice);
 
     auto const maxDraftPathLen = mDecoderDomain.getSpeculativeDecodingModule()->getMaxDraftPathLen();
     auto const batchSizeMaxNumHeads = batchSize * maxDraftPathLen;
@@ -135,8 +154,8 @@ void MedusaDecodingLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, T
         }
     }
     auto tiledRandomSeedOpt = std::make_optional(std::move(tiledRandomSeed));
-    workspace->initializeDeviceCurandStates(
-        tiledRandomSeedOpt, batchSizeMaxNumHeads, mTiledBatchSlotsSetup, mCurandStatesMedusaLogitsDevice);
+    workspace->initializeDeviceRandomStates(
+        tiledRandomSeedOpt, batchSizeMaxNumHeads, mTiledBatchSlotsSetup, mRandomStatesMedusaLogitsDevice);
 
     // Prepare runtime top K
     auto prepareRuntimeTopK = [this, workspace](std::vector<SizeType32> const& runtimeTopK, SizeType32 batchSize,
@@ -206,6 +225,41 @@ void MedusaDecodingLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, T
         mRuntimeMaxTopKPerRequestPerMedusaHead = std::max(mRuntimeMaxTopKPerRequestPerMedusaHead, curMaxTopK);
     }
 
+    // Prepare verification of draft tokens
+    {
+        auto const& typicalThreshold = setupParams->typicalAcceptanceThreshold;
+        auto const& useRejectionSampling = setupParams->useRejectionSampling;
+        auto const valueAt = [batchSize](auto const& values, SizeType32 bi)
+        {
+            TLLM_CHECK_WITH_INFO(values.size() == 1 || values.size() == static_cast<size_t>(batchSize),
+                "Argument vector size mismatch.");
+            return values.size() == 1 ? values.front() : values[bi];
+        };
+        std::vector<SizeType32> modes(batchSize, static_cast<SizeType32>(MedusaAcceptanceMode::kEXACT_MATCH));
+        for (SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            if (useRejectionSampling && valueAt(*useRejectionSampling, bi))
+            {
+                modes[bi] = static_cast<SizeType32>(MedusaAcceptanceMode::kREJECTION);
+            }
+            else if (typicalThreshold && valueAt(*typicalThreshold, bi) > 0.f)
+            {
+                modes[bi] = static_cast<SizeType32>(MedusaAcceptanceMode::kTYPICAL);
+            }
+        }
+
+        FillBuffers const fillBuffers{batchSize, mDecoderDomain.getBatchSize(), mBufferManager};
+        fillBuffers(std::make_optional(modes), static_cast<SizeType32>(MedusaAcceptanceMode::kEXACT_MATCH),
+            mAcceptanceModes, mAcceptanceModesDevice, batchSlots,
+            std::make_pair(-1.f, static_cast<float>(MedusaAcceptanceMode::kREJECTION)), "acceptance mode");
+        fillBuffers(typicalThreshold, DefaultDecodingParams::getTypicalAcceptanceThreshold(),
+            mTypicalAcceptanceThreshold, mTypicalAcceptanceThresholdDevice, batchSlots, std::make_pair(-1e-6f, 1.f),
+            "typical acceptance threshold");
+        fillBuffers(setupParams->typicalAcceptanceAlpha, DefaultDecodingParams::getTypicalAcceptanceAlpha(),
+            mTypicalAcceptanceAlpha, mTypicalAcceptanceAlphaDevice, batchSlots,
+            std::make_pair(-1e-6f, std::numeric_limits<float>::max()), "typical acceptance alpha");
+    }
+
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -223,6 +277,8 @@ void MedusaDecodingLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> c
 
     acceptDraftTokens(*outputs, *inputs, workspace);
 
+    countAcceptedTreeNodes(*outputs, *inputs, workspace);
+
     sampleNewDraftTokens(*outputs, *inputs, workspace);
 
     scatterNewDraftTokens(*outputs, *inputs);
@@ -261,7 +317,7 @@ void MedusaDecodingLayer<T>::samplePrimeHeadTokens(SpeculativeDecodingOutputs co
     params.maxTopK = mRuntimeMaxTopK;
     params.topKs = bufferCastOrNull<SizeType32>(mRuntimeTopKDevice);
     params.batchSlots = batchSlots;
-    params.curandState = reinterpret_cast<curandState_t*>(bufferCastOrNull<int8_t>(mCurandStatesDevice));
+    params.randomState = reinterpret_cast<kernels::RandomState*>(bufferCastOrNull<int8_t>(mRandomStatesDevice));
     params.batchSize = batchSize;
     params.maxBatchSize = mDecoderDomain.getBatchSize();
     params.tokensPerStep = tokensPerStepDevice;
@@ -329,11 +385,32 @@ void MedusaDecodingLayer<T>::acceptDraftTokens(SpeculativeDecodingOutputs const&
     auto medusaInputLogitsPtrsPtr = reinterpret_cast<T const**>(bufferCast<int64_t>(*mMedusaInputLogitsPtrs));
     auto medusaSelectedLogitsPtrsDevicePtr
         = const_cast<T const**>(bufferCastOrNull<T const*>(mMedusaSelectedLogitsPtrsDevice));
+
+    // Requests with typical acceptance or rejection sampling need statistics of their target rows first
+    MedusaAcceptanceParams<T> acceptanceParams;
+    auto const* acceptanceModes = bufferCast<SizeType32>(*mAcceptanceModes);
+    if (!allOfBatchSlots(
+            batchSlots, acceptanceModes, batchSize, static_cast<SizeType32>(MedusaAcceptanceMode::kEXACT_MATCH)))
+    {
+        acceptanceParams.logits = bufferCast<T>(*inputs.logits.value());
+        acceptanceParams.modes
+            = reinterpret_cast<MedusaAcceptanceMode const*>(bufferCast<SizeType32>(*mAcceptanceModesDevice));
+        acceptanceParams.logNormalizers = bufferCast<float>(*mTargetLogNormalizersDevice);
+        acceptanceParams.thresholds = bufferCast<float>(*mTargetAcceptanceThresholdsDevice);
+        acceptanceParams.vocabSizePadded = mDecoderDomain.getVocabSizePadded();
+        invokeComputeMedusaAcceptanceStats(targetTokensDevicePtr, bufferCast<float>(*mTargetLogNormalizersDevice),
+            bufferCast<float>(*mTargetAcceptanceThresholdsDevice), acceptanceParams.logits, acceptanceParams.modes,
+            bufferCast<float>(*mTypicalAcceptanceThresholdDevice), bufferCast<float>(*mTypicalAcceptanceAlphaDevice),
+            curTokensPerStepDevice, reinterpret_cast<kernels::RandomState*>(bufferCast<int8_t>(*mRandomStatesDevice)),
+            workspace->getDeviceBatchSlotsPtr(), batchSize, mDecoderDomain.getMaxDecodingTokens(),
+            mDecoderDomain.getVocabSize(), mDecoderDomain.getVocabSizePadded(), getStream());
+    }
+
     acceptDraftTokensByIdsWithPaths(outputIds, draftIds, targetTokensDevicePtr, sequenceLengths, numNewTokens,
         finishedStatesPtr, workspace->getDeviceBatchSlotsPtr(), paths, endIds, medusaInputLogitsPtrsPtr,
         medusaSelectedLogitsPtrsDevicePtr, curTokensPerStepDevice, targetTokensPerStepDevice, bestPathIdsDevicePtr,
         batchSize, mDecoderDomain.getVocabSize(), mDecoderDomain.getBatchSize(), maxSeqLen, maxDraftPathLen,
-        mDecoderDomain.getMaxDecodingTokens(), getStream());
+        mDecoderDomain.getMaxDecodingTokens(), acceptanceParams, getStream());
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -385,7 +462,8 @@ void MedusaDecodingLayer<T>::sampleNewDraftTokens(SpeculativeDecodingOutputs con
     params.maxTopK = mRuntimeMaxTopKPerRequestPerMedusaHead;
     params.topKs = bufferCastOrNull<SizeType32>(mRuntimeTopKPerRequestPerMedusaHeadDevice);
     params.batchSlots = tiledBatchSlots;
-    params.curandState = reinterpret_cast<curandState_t*>(bufferCastOrNull<int8_t>(mCurandStatesMedusaLogitsDevice));
+    params.randomState
+        = reinterpret_cast<kernels::RandomState*>(bufferCastOrNull<int8_t>(mRandomStatesMedusaLogitsDevice));
     params.batchSize = batchSizeHeadNums;
     params.maxBatchSize = maxBatchSizeHeadNums;
     params.maxTokensPerStep = 1;
@@ -447,6 +525,40 @@ void MedusaDecodingLayer<T>::packAcceptedPaths(SpeculativeDecodingOutputs const&
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+template <typename T>
+void MedusaDecodingLayer<T>::countAcceptedTreeNodes(SpeculativeDecodingOutputs const& outputs,
+    MedusaDecodingInputs const& inputs, std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    auto const batchSize = inputs.logits.value()->getDimension<0>();
+    auto const* paths = bufferCast<SizeType32>(*inputs.paths);
+    auto const* batchSlots = workspace->getDeviceBatchSlotsPtr();
+    auto const* numNewTokens = bufferCast<SizeType32>(*outputs.numNewTokens.value());
+    auto const* bestPathIdsDevicePtr = bufferCastOrNull<SizeType32>(mBestPathIdsDevice);
+
+    invokeCountAcceptedTreeNodes(bufferCast<SizeType32>(*mNodeAcceptCountsDevice), numNewTokens,
+        bestPathIdsDevicePtr, paths, batchSlots, batchSize, mDecoderDomain.getMaxDecodingTokens(),
+        mDecoderDomain.getSpeculativeDecodingModule()->getMaxPathLen(), getStream());
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template <typename T>
+void MedusaDecodingLayer<T>::takeNodeAcceptCounts(ITensor& nodeAcceptCountsHost)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    TLLM_CHECK_WITH_INFO(nodeAcceptCountsHost.getSize() == mNodeAcceptCountsDevice->getSize(),
+        "Node accept counts must have %ld elements, got %ld", mNodeAcceptCountsDevice->getSize(),
+        nodeAcceptCountsHost.getSize());
+    mBufferManager->copy(*mNodeAcceptCountsDevice, nodeAcceptCountsHost);
+    mBufferManager->setZero(*mNodeAcceptCountsDevice);
+    mBufferManager->getStream().synchronize();
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 template class MedusaDecodingLayer<float>;
 template class MedusaDecodingLayer<half>;
 
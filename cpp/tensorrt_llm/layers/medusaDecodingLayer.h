@@ -47,6 +47,11 @@ public:
     //! @returns workspace needed for this layer in bytes
     [[nodiscard]] size_t getWorkspaceSize() const noexcept override;
 
+    //! \brief Copies the acceptance counters of the tree nodes to nodeAcceptCountsHost and restarts them from zero.
+    //! nodeAcceptCountsHost[0] is the number of request steps, nodeAcceptCountsHost[i] the number of times the node
+    //! with linear idx i was accepted. Synchronizes the stream of the layer.
+    void takeNodeAcceptCounts(runtime::ITensor& nodeAcceptCountsHost);
+
 private:
     void allocateBuffer();
 
@@ -59,6 +64,8 @@ private:
     void scatterNewDraftTokens(SpeculativeDecodingOutputs const& outputs, MedusaDecodingInputs const& inputs);
     void packAcceptedPaths(SpeculativeDecodingOutputs const& outputs, MedusaDecodingInputs const& inputs,
         std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace);
+    void countAcceptedTreeNodes(SpeculativeDecodingOutputs const& outputs, MedusaDecodingInputs const& inputs,
+        std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace);
 
 private:
     using Base::mDecoderDomain;
@@ -68,15 +75,27 @@ private:
     runtime::SizeType32 mRuntimeMaxTopK{0};
     runtime::SizeType32 mRuntimeMaxTopKPerRequestPerMedusaHead{0};
 
-    TensorPtr mCurandStatesDevice;
+    TensorPtr mRandomStatesDevice;
     TensorPtr mRuntimeTopKDevice;
     TensorPtr mTargetTokensDevice;
     TensorPtr mRandomSeedsDevice;
     TensorPtr mMedusaSelectedLogitsPtrsDevice;
-    TensorPtr mCurandStatesMedusaLogitsDevice;
+    TensorPtr mRandomStatesMedusaLogitsDevice;
     TensorPtr mRuntimeTopKPerRequestPerMedusaHeadDevice;
     TensorPtr mNewDraftTokensDevice;
     TensorPtr mBestPathIdsDevice;
+    // Acceptance counters of the tree nodes, summed over requests and steps, [maxDecodingTokens]
+    TensorPtr mNodeAcceptCountsDevice;
+
+    // Verification of draft tokens per request, see kernels::speculative_decoding::MedusaAcceptanceMode
+    TensorPtr mAcceptanceModes;
+    TensorPtr mAcceptanceModesDevice;
+    TensorPtr mTypicalAcceptanceThreshold;
+    TensorPtr mTypicalAcceptanceThresholdDevice;
+    TensorPtr mTypicalAcceptanceAlpha;
+    TensorPtr mTypicalAcceptanceAlphaDevice;
+    TensorPtr mTargetLogNormalizersDevice;
+    TensorPtr mTargetAcceptanceThresholdsDevice;
 
     TensorPtr mTiledBatchSlotsSetup;
     TensorPtr mTiledBatchSlotsForward;
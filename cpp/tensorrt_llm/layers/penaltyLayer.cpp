@@ -17,6 +17,7 @@
 
 #include "penaltyLayer.h"
 #include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/decodingKernels.h"
 #include "tensorrt_llm/kernels/penaltyKernels.h"
 #include "tensorrt_llm/layers/defaultDecodingParams.h"
 #include "tensorrt_llm/layers/layerUtils.h"
@@ -80,7 +81,7 @@ void PenaltyLayer<T>::allocateWorkspace()
     {
 
         auto const workspaceSize = mDecoderDomain.getBatchSize() * mDecoderDomain.getMaxDecodingTokens()
-            * mConfiguredBeamWidth * mDecoderDomain.getVocabSize();
+            * mConfiguredBeamWidth * getPenaltyWorkspaceRowSize(mPenaltyTableSize, mDecoderDomain.getVocabSize());
         mPenaltyWorkspaceDevice = mBufferManager->gpu(workspaceSize, nvinfer1::DataType::kINT32);
 
         if (mDecodingMode.isBeamSearch())
@@ -126,8 +127,26 @@ void PenaltyLayer<T>::allocateBuffer()
         mMinLengthDevice = mBufferManager->gpu(batchSizeShape, nvinfer1::DataType::kINT32);
     }
 
+    // Setup only sends the slots that differ from the host buffers, so the device buffers start as their copies
+    auto initPenalty = [this](auto defaultValue, TensorPtr const& hostBuffer, TensorPtr const& deviceBuffer)
+    {
+        using ValueType = decltype(defaultValue);
+        auto hostRange = BufferRange<ValueType>(*hostBuffer);
+        std::fill(hostRange.begin(), hostRange.end(), defaultValue);
+        if (deviceBuffer)
+        {
+            mBufferManager->copy(*hostBuffer, *deviceBuffer);
+        }
+    };
+    initPenalty(DefaultDecodingParams::getTemperature(), mTemperature, mTemperatureDevice);
+    initPenalty(DefaultDecodingParams::getRepetitionPenalty(), mRepetitionPenalty, mRepetitionPenaltyDevice);
+    initPenalty(DefaultDecodingParams::getPresencePenalty(), mPresencePenalty, mPresencePenaltyDevice);
+    initPenalty(DefaultDecodingParams::getFrequencyPenalty(), mFrequencyPenalty, mFrequencyPenaltyDevice);
+    initPenalty(DefaultDecodingParams::getMinLength(), mMinLength, mMinLengthDevice);
+
     auto const logitsPtrDeviceDesc = std::make_pair(batchSizeShape, TRTDataType<T*>::value);
-    mWorkspaceSize = DecodingLayerWorkspace::calculateRequiredWorkspaceSize(logitsPtrDeviceDesc);
+    mWorkspaceSize = std::max(DecodingLayerWorkspace::calculateRequiredWorkspaceSize(logitsPtrDeviceDesc),
+        SlotParamsDelta::getWorkspaceSize(kNumPenalties * mDecoderDomain.getBatchSize()));
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -153,7 +172,7 @@ void PenaltyLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, TensorCo
     }
 
     // Setup penalties.
-    FillBuffers const fillBuffers{batchSize, mDecoderDomain.getBatchSize(), mBufferManager};
+    FillBuffers const fillBuffers{batchSize, mDecoderDomain.getBatchSize(), mBufferManager, &mParamsDelta};
 
     auto const& penaltyParams = setupParams->penaltyParams;
     TLLM_CHECK_WITH_INFO(penaltyParams, "penaltyParams for setup is not set");
@@ -199,6 +218,7 @@ void PenaltyLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, TensorCo
         fillBuffers(penaltyParams->minLength, DefaultDecodingParams::getMinLength(), mMinLength, mMinLengthDevice,
             batchSlots, getLimitsPenalty(DecodingPenaltyType::MinLength), "min length");
     }
+    mParamsDelta.flush(*mBufferManager, *workspace);
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -216,33 +236,52 @@ void PenaltyLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> const& b
     auto const localDecoderDomain = getLocalDecoderDomain(params, mDecoderDomain);
     auto const maxSeqLen = outputs->outputIds->getDimension<-1>();
 
-    if (mLogitsPtrsHost->data() == nullptr)
+    if (mRuntimeMaxSeqLen == 0)
     {
         mLogitsPtrsHost->reshape(
             ITensor::makeShape({static_cast<int32_t>(maxSeqLen), static_cast<int32_t>(mDecoderDomain.getBatchSize())}));
         mRuntimeMaxSeqLen = maxSeqLen;
-    }
 
-    mCyclicStep = mCyclicStep % mRuntimeMaxSeqLen;
+        // Switch to sparse occurrence tables when sequences are short compared to the vocabulary
+        auto const penaltyTableSize = getPenaltyTableSize(maxSeqLen, mDecoderDomain.getVocabSize());
+        if (penaltyTableSize != mPenaltyTableSize)
+        {
+            mPenaltyTableSize = penaltyTableSize;
+            if (mPenaltyWorkspaceDevice)
+            {
+                allocateWorkspace();
+            }
+        }
+    }
 
-    TensorPtr logitsPtrsHost = ITensor::slice(mLogitsPtrsHost, mCyclicStep, 1);
-    logitsPtrsHost->squeeze(0);
-    auto logitsPtrsHostData = bufferCast<T const*>(*logitsPtrsHost);
-    for (SizeType32 bi = 0; bi < localDecoderDomain.getBatchSize(); bi++)
+    // Pointers to the logits of each request, at the start of the workspace of the layer
+    T const** logitsPtrsDevice{nullptr};
+    if (params->logitsVec)
     {
-        if (params->logitsVec)
+        TLLM_CHECK_WITH_INFO(params->logitsVec->size() == localDecoderDomain.getBatchSize(),
+            "Logits vector size (%lu) is not equal to the batchSize (%d)", params->logitsVec->size(),
+            localDecoderDomain.getBatchSize());
+        mCyclicStep = mCyclicStep % mRuntimeMaxSeqLen;
+        TensorPtr logitsPtrsHost = ITensor::slice(mLogitsPtrsHost, mCyclicStep, 1);
+        logitsPtrsHost->squeeze(0);
+        auto logitsPtrsHostData = bufferCast<T const*>(*logitsPtrsHost);
+        for (SizeType32 bi = 0; bi < localDecoderDomain.getBatchSize(); bi++)
         {
-            TLLM_CHECK_WITH_INFO(params->logitsVec->size() == localDecoderDomain.getBatchSize(),
-                "Logits vector size (%lu) is not equal to the batchSize (%d)", params->logitsVec->size(),
-                localDecoderDomain.getBatchSize());
             logitsPtrsHostData[bi] = bufferCastOrNull<T>(params->logitsVec.value()[bi]);
         }
-        else
-        {
-            TensorConstPtr logitsForBatchIndex = ITensor::slice(params->logits.value(), ITensor::makeShape({bi}));
-            auto const ptrToLogitsForBatchIndex = bufferCastOrNull<T>(logitsForBatchIndex);
-            logitsPtrsHostData[bi] = ptrToLogitsForBatchIndex;
-        }
+        TensorPtr logitsPtrsHostSlice = ITensor::slice(logitsPtrsHost, 0, localDecoderDomain.getBatchSize());
+        auto [logitsPtrsDeviceSlice] = workspace->mirrorInWorkspace(logitsPtrsHostSlice);
+        logitsPtrsDevice = bufferCast<T const*>(*logitsPtrsDeviceSlice);
+        mCyclicStep += 1;
+    }
+    else
+    {
+        // Rows of a single logits tensor, the table is filled on the device so that the step can be graph-captured
+        auto const& logits = params->logits.value();
+        auto const strideBytes = logits->getSizeInBytes() / logits->getDimension<0>();
+        logitsPtrsDevice = static_cast<T const**>(workspace->getRawWorkspaceDevicePtr());
+        invokeFillBatchPtrs(reinterpret_cast<void**>(logitsPtrsDevice), logits->data(), strideBytes, nullptr, nullptr,
+            localDecoderDomain.getBatchSize(), getStream());
     }
 
     auto const* inputLengths = bufferCastOrNull<SizeType32>(params->inputLengths);
@@ -267,14 +306,13 @@ void PenaltyLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> const& b
 
     InvokeBatchApplyPenaltyParams<T> penaltyParams{};
 
-    TensorPtr logitsPtrsHostSlice = ITensor::slice(logitsPtrsHost, 0, localDecoderDomain.getBatchSize());
-    auto [logitsPtrsDeviceSlice] = workspace->mirrorInWorkspace(logitsPtrsHostSlice);
     auto runtimeLogits = workspace->getDeviceRuntimeLogits();
-    penaltyParams.inputLogits = reinterpret_cast<T const* const*>(bufferCast<T const*>(*logitsPtrsDeviceSlice));
+    penaltyParams.inputLogits = logitsPtrsDevice;
     penaltyParams.outputLogits = bufferCast<T>(*runtimeLogits);
     penaltyParams.biases = embeddingBias;
     penaltyParams.penaltyWorkspace = bufferCastOrNull<TokenIdType>(mPenaltyWorkspaceDevice);
     penaltyParams.penaltyWorkspacePrev = bufferCastOrNull<TokenIdType>(mPenaltyWorkspacePrevDevice);
+    penaltyParams.penaltyTableSize = mPenaltyTableSize;
     penaltyParams.temperatures = bufferCastOrNull<float>(temperatures);
     penaltyParams.repetitionPenalties = bufferCastOrNull<float>(repetitionPenalties);
     penaltyParams.presencePenalties = bufferCastOrNull<float>(presencePenalties);
@@ -308,8 +346,6 @@ void PenaltyLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> const& b
     invokeBatchApplyPenalty(penaltyParams);
     sync_check_cuda_error();
 
-    mCyclicStep += 1;
-
     auto const logitsShape = ITensor::makeShape({localDecoderDomain.getBatchSize(),
         mDecoderDomain.getMaxDecodingTokens(), localDecoderDomain.getBeamWidth(), mDecoderDomain.getVocabSizePadded()});
     params->logits = ITensor::view(runtimeLogits, logitsShape);
@@ -22,6 +22,7 @@
 #include "tensorrt_llm/executor/types.h"
 #include "tensorrt_llm/layers/baseLayer.h"
 #include "tensorrt_llm/layers/decodingParams.h"
+#include "tensorrt_llm/layers/layerUtils.h"
 
 namespace tensorrt_llm::layers
 {
@@ -59,6 +60,8 @@ private:
 private:
     using BaseLayer::mDecoderDomain;
 
+    static runtime::SizeType32 constexpr kNumPenalties{5};
+
     executor::DecodingMode mDecodingMode;
 
     size_t mWorkspaceSize{};
@@ -83,10 +86,14 @@ private:
     runtime::SizeType32 mCyclicStep{0};
     runtime::SizeType32 mRuntimeMaxSeqLen{0};
     runtime::SizeType32 mConfiguredBeamWidth{-1};
+    //! size of the per-request occurrence hash tables, 0 for dense [vocabSize] counts
+    runtime::SizeType32 mPenaltyTableSize{0};
 
     BufferPtr mPenaltyWorkspaceDevice;
     BufferPtr mPenaltyWorkspacePrevDevice;
     TensorPtr mLogitsPtrsHost;
+
+    SlotParamsDelta mParamsDelta;
 };
 
 } // namespace tensorrt_llm::layers
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rejectionSamplingLayer.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/memoryUtils.h"
+#include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/samplingRejectionKernels.h"
+#include "tensorrt_llm/kernels/samplingTopPKernels.h"
+#include "tensorrt_llm/layers/defaultDecodingParams.h"
+#include "tensorrt_llm/layers/layerUtils.h"
+
+#include <algorithm>
+
+using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::kernels;
+using namespace tensorrt_llm::runtime;
+
+namespace tensorrt_llm::layers
+{
+
+namespace
+{
+//! @returns values for each of batchSize requests, broadcasting a single value or defaultValue if none is given
+template <typename V>
+std::vector<V> expandToBatch(
+    std::string const& name, std::optional<std::vector<V>> const& values, V defaultValue, SizeType32 batchSize)
+{
+    if (!values || values->empty())
+    {
+        return std::vector<V>(batchSize, defaultValue);
+    }
+    if (values->size() == 1)
+    {
+        return std::vector<V>(batchSize, values->front());
+    }
+    TLLM_CHECK_WITH_INFO(static_cast<SizeType32>(values->size()) == batchSize,
+        fmtstr("%s.size() (%lu) == batchSize (%d) is not satisfied!", name.c_str(), values->size(), batchSize));
+    return values.value();
+}
+} // namespace
+
+template <typename T>
+RejectionSamplingLayer<T>::RejectionSamplingLayer(
+    DecoderDomain const& decoderDomain, std::shared_ptr<BufferManager> bufferManager)
+    : BaseLayer(decoderDomain, bufferManager)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    allocateBuffer(mDecoderDomain.getBatchSize());
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template <typename T>
+void RejectionSamplingLayer<T>::allocateBuffer(SizeType32 batchSize)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    auto const batchSizeShape = ITensor::makeShape({batchSize});
+    mRuntimeTopKDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<SizeType32>::value);
+    mRuntimeTopPDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<float>::value);
+    mRuntimeMinPDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<float>::value);
+    mInitialTopPDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<float>::value);
+    mTopPDecayDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<float>::value);
+    mTopPMinDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<float>::value);
+    mTopPResetIdsDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<TokenIdType>::value);
+
+    // All params are 4 bytes per request
+    mSetupWorkspaceSize = mRuntimeTopKDevice->getSizeInBytes();
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template <typename T>
+void RejectionSamplingLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, TensorConstPtr batchSlots,
+    std::shared_ptr<BaseSetupParams> const& baseSetupParams,
+    std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    auto setupParams = std::dynamic_pointer_cast<SamplingSetupParams>(baseSetupParams);
+
+    auto topKs = expandToBatch("runtimeTopK", setupParams->runtimeTopK, DefaultDecodingParams::getTopK(), batchSize);
+    auto topPs = expandToBatch("runtimeTopP", setupParams->runtimeTopP, DefaultDecodingParams::getTopP(), batchSize);
+    auto minPs = expandToBatch("runtimeMinP", setupParams->runtimeMinP, DefaultDecodingParams::getMinP(), batchSize);
+    auto decays
+        = expandToBatch("topPDecay", setupParams->topPDecay, DefaultDecodingParams::getTopPDecay(), batchSize);
+    auto topPMins = expandToBatch("topPMin", setupParams->topPMin, DefaultDecodingParams::getTopPMin(), batchSize);
+    auto const topPResetIds = expandToBatch(
+        "topPResetIds", setupParams->topPResetIds, DefaultDecodingParams::getTopPResetId(), batchSize);
+
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto& topK = topKs[bi];
+        auto& topP = topPs[bi];
+        if (topK < 0)
+        {
+            TLLM_LOG_WARNING("TopK (%d) is negative. Change to 0.", topK);
+            topK = 0;
+        }
+        if (topP < 0.f || topP > 1.0f)
+        {
+            TLLM_LOG_WARNING("TopP (%f) is out of range ([0.0, 1.0f]). Clip to closest number.", topP);
+            topP = std::clamp(topP, 0.f, 1.f);
+        }
+        // Same semantics as the top-k and top-p layers: without K, P and min-P the request is sampled greedily,
+        // without P only top-K applies
+        if (topK == 0 && topP == 0.f && minPs[bi] == 0.f)
+        {
+            topK = 1;
+        }
+        if (topP == 0.f)
+        {
+            topP = 1.f;
+        }
+        if (minPs[bi] < 0.f || minPs[bi] > 1.0f)
+        {
+            TLLM_LOG_WARNING("MinP (%f) is out of range ([0.0, 1.0f]). Clip to closest number.", minPs[bi]);
+            minPs[bi] = std::clamp(minPs[bi], 0.f, 1.f);
+        }
+        if (decays[bi] <= 0.f || decays[bi] > 1.0f)
+        {
+            TLLM_LOG_WARNING("Decay (%f) is out of range ((0.0, 1.0f]). Change to default (%f).", decays[bi],
+                DefaultDecodingParams::getTopPDecay());
+            decays[bi] = DefaultDecodingParams::getTopPDecay();
+        }
+        if (topPMins[bi] <= 0.f || topPMins[bi] > 1.0f)
+        {
+            TLLM_LOG_WARNING("TopP min (%f) is out of range ([0.0, 1.0f]). Change to default (%f).", topPMins[bi],
+                DefaultDecodingParams::getTopPMin());
+            topPMins[bi] = DefaultDecodingParams::getTopPMin();
+        }
+    }
+
+    auto* setupWorkspaceDevicePtr = workspace->getWorkspaceDevicePtrAs<SizeType32>();
+    auto* setupWorkspaceDeviceAsFloatPtr = reinterpret_cast<float*>(setupWorkspaceDevicePtr);
+    auto const* batchSlotsDevicePtr = workspace->getDeviceBatchSlotsPtr();
+    auto fillBuffers
+        = [this, batchSize, batchSlotsDevicePtr](auto const& vector, auto deviceTmpBuffer, auto deviceBuffer)
+    {
+        cudaAutoCpy(deviceTmpBuffer, vector.data(), batchSize, getStream());
+        invokeScatterDecodingParams(deviceTmpBuffer, deviceBuffer, batchSlotsDevicePtr, batchSize, getStream());
+    };
+
+    fillBuffers(topKs, setupWorkspaceDevicePtr, bufferCast<SizeType32>(*mRuntimeTopKDevice));
+    fillBuffers(topPs, setupWorkspaceDeviceAsFloatPtr, bufferCast<float>(*mRuntimeTopPDevice));
+    fillBuffers(topPs, setupWorkspaceDeviceAsFloatPtr, bufferCast<float>(*mInitialTopPDevice));
+    fillBuffers(minPs, setupWorkspaceDeviceAsFloatPtr, bufferCast<float>(*mRuntimeMinPDevice));
+    fillBuffers(decays, setupWorkspaceDeviceAsFloatPtr, bufferCast<float>(*mTopPDecayDevice));
+    fillBuffers(topPMins, setupWorkspaceDeviceAsFloatPtr, bufferCast<float>(*mTopPMinDevice));
+    fillBuffers(topPResetIds, setupWorkspaceDevicePtr, bufferCast<TokenIdType>(*mTopPResetIdsDevice));
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template <typename T>
+void RejectionSamplingLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> const& outputs,
+    std::shared_ptr<BaseDecodingInputs> const& baseInputs,
+    std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    auto inputs = std::dynamic_pointer_cast<SamplingInputs>(baseInputs);
+
+    auto const batchSize = inputs->logits.value()->getDimension<0>();
+
+    auto const* finishedInput = (inputs->finished) ? reinterpret_cast<FinishedState const*>(
+                                    bufferCastOrNull<FinishedState::UnderlyingType>(inputs->finished.value()))
+                                                   : nullptr;
+    auto* finishedOutput = (outputs->finished)
+        ? reinterpret_cast<FinishedState*>(bufferCastOrNull<FinishedState::UnderlyingType>(outputs->finished.value()))
+        : nullptr;
+    auto* sequenceLength = bufferCastOrNull<SizeType32>(outputs->sequenceLength);
+
+    // Probabilities must be already computed instead of logits
+    RejectionSamplingKernelParams<T> params{};
+    params.probs = bufferCastOrNull<T>(inputs->logits);
+    params.outputIds = bufferCastOrNull<TokenIdType*>(outputs->outputIdsPtr);
+    params.topKs = bufferCastOrNull<SizeType32>(mRuntimeTopKDevice);
+    params.topPs = bufferCastOrNull<float>(mRuntimeTopPDevice);
+    params.minPs = bufferCastOrNull<float>(mRuntimeMinPDevice);
+    params.sequenceLength = sequenceLength;
+    params.endIds = bufferCastOrNull<TokenIdType>(inputs->endIds);
+    params.batchSlots = workspace->getDeviceBatchSlotsPtr();
+    params.finishedInput = finishedInput;
+    params.finishedOutput = finishedOutput;
+    params.cumLogProbs = bufferCastOrNull<float>(outputs->cumLogProbs);
+    params.outputLogProbs = bufferCastOrNull<float>(outputs->outputLogProbsTiled);
+    params.randomState = inputs->randomStates;
+    params.batchSize = batchSize;
+    params.maxBatchSize = mDecoderDomain.getBatchSize();
+    params.vocabSizePadded = mDecoderDomain.getVocabSizePadded();
+    invokeBatchRejectionSampling<T>(params, getStream());
+    sync_check_cuda_error();
+
+    invokeComputeToppDecay(bufferCastOrNull<float>(mRuntimeTopPDevice), bufferCastOrNull<float>(mInitialTopPDevice),
+        bufferCastOrNull<TokenIdType const*>(outputs->outputIdsPtr), bufferCastOrNull<float>(mTopPDecayDevice),
+        bufferCastOrNull<float>(mTopPMinDevice), bufferCastOrNull<TokenIdType>(mTopPResetIdsDevice), sequenceLength,
+        workspace->getDeviceBatchSlotsPtr(), batchSize, getStream());
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+template <typename T>
+size_t RejectionSamplingLayer<T>::getWorkspaceSize() const noexcept
+{
+    // The kernel runs without workspace
+    return mSetupWorkspaceSize;
+}
+
+template class RejectionSamplingLayer<float>;
+template class RejectionSamplingLayer<half>;
+
+} // namespace tensorrt_llm::layers
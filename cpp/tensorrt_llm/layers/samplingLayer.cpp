@@ -17,6 +17,7 @@
 
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/layers/rejectionSamplingLayer.h"
 #include "tensorrt_llm/layers/topKSamplingLayer.h"
 #include "tensorrt_llm/layers/topPSamplingLayer.h"
 
@@ -40,15 +41,30 @@ SamplingLayer<T>::SamplingLayer(executor::DecodingMode const& mode, DecoderDomai
 
     TLLM_CHECK_WITH_INFO(!mDecodingMode.isBeamSearch(), "SamplingLayer does not support Beam search mode");
     TLLM_CHECK_WITH_INFO(mDecodingMode.isTopKorTopP(), "SamplingLayer requires TopK or TopP mode");
-    if (mDecodingMode.isTopK())
+    TLLM_CHECK_WITH_INFO(!mDecodingMode.isMinP() || mDecodingMode.isUseRejectionSampling(),
+        "MinP sampling requires rejection sampling");
+    TLLM_CHECK_WITH_INFO(!mDecodingMode.isUseFusedSampling()
+            || (mDecodingMode.isTopK() && !mDecodingMode.isUseRejectionSampling()),
+        "Fused sampling requires TopK mode without rejection sampling");
+    if (mDecodingMode.isUseRejectionSampling())
     {
-        mSamplingLayers.emplace_back(std::make_unique<TopKSamplingLayer<T>>(decoderDomain, mBufferManager));
+        // Serves top-k, top-p and min-p requests alike
+        mSamplingLayers.emplace_back(std::make_unique<RejectionSamplingLayer<T>>(decoderDomain, mBufferManager));
+    }
+    else if (mDecodingMode.isTopK())
+    {
+        auto topKLayer = std::make_unique<TopKSamplingLayer<T>>(
+            decoderDomain, mBufferManager, mDecodingMode.isUseFusedSampling());
+        mTopKLayer = topKLayer.get();
+        mSamplingLayers.emplace_back(std::move(topKLayer));
     }
 
-    if (mDecodingMode.isTopP())
+    if (mDecodingMode.isTopP() && !mDecodingMode.isUseRejectionSampling())
     {
-        mSamplingLayers.emplace_back(
-            std::make_unique<TopPSamplingLayer<T>>(decoderDomain, mBufferManager, /* deterministic */ true));
+        auto topPLayer
+            = std::make_unique<TopPSamplingLayer<T>>(decoderDomain, mBufferManager, /* deterministic */ true);
+        mTopPLayer = topPLayer.get();
+        mSamplingLayers.emplace_back(std::move(topPLayer));
     }
 
     allocateBuffer(decoderDomain.getBatchSize());
@@ -72,8 +88,8 @@ void SamplingLayer<T>::allocateBuffer(SizeType32 batchSize)
     mSetupWorkspaceSize = DecodingLayerWorkspace::calculateRequiredWorkspaceSize(
         std::make_pair(batchSizeShape, TRTDataType<uint64_t>::value));
     mSkipDecodeDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<bool>::value);
-    mCurandStatesDevice
-        = mBufferManager->gpu(ITensor::makeShape({batchSize, sizeof(curandState_t)}), TRTDataType<int8_t>::value);
+    mRandomStatesDevice = mBufferManager->gpu(
+        ITensor::makeShape({batchSize, sizeof(kernels::RandomState)}), TRTDataType<int8_t>::value);
 
     // host buffers.
     mSkipDecodeHost = mBufferManager->pinnedPool(batchSizeShape, TRTDataType<bool>::value);
@@ -91,8 +107,8 @@ void SamplingLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, TensorC
 
     auto setupParams = std::dynamic_pointer_cast<SamplingSetupParams>(baseSetupParams);
 
-    workspace->initializeDeviceCurandStates(
-        setupParams->randomSeed, batchSize, workspace->getDeviceBatchSlots(), mCurandStatesDevice);
+    workspace->initializeDeviceRandomStates(setupParams->randomSeed, batchSize, workspace->getDeviceBatchSlots(),
+        mRandomStatesDevice, setupParams->randomStep);
 
     if (setupParams->outputLogProbs)
     {
@@ -133,12 +149,25 @@ void SamplingLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> const&
         ? reinterpret_cast<FinishedState const*>(bufferCast<FinishedState::UnderlyingType>(*inputs->finished.value()))
         : nullptr;
 
-    auto const skipTopP = !mDecodingMode.isTopP();
+    // Requests are partitioned between top-k and top-p by their skip flags. Skip the softmax when no request of the
+    // step is sampled by top-p, e.g. in greedy-heavy batches. Rejection sampling always samples from probabilities
+    auto const skipTopP = !mDecodingMode.isUseRejectionSampling()
+        && (mTopPLayer == nullptr
+            || !mTopPLayer->hasActiveSlots(bufferCast<SizeType32>(*inputs->batchSlots), batchSize));
+
+    // The fused top-k sampling computes its log probs from the raw logits. It runs first, before the softmax for
+    // top-p overwrites them in place
+    auto const fusedTopK = mTopKLayer != nullptr && mTopKLayer->isFusedSampling();
 
     // Compute probabilities either for TopP or if cumLogProbs or outputLogProbs are specified
-    bool const skipSoftMax = skipTopP && !mOutputLogProbs && !mCumLogProbs;
+    bool const skipSoftMax = skipTopP && (fusedTopK || (!mOutputLogProbs && !mCumLogProbs));
 
-    inputs->curandStates = reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*mCurandStatesDevice));
+    inputs->randomStates = reinterpret_cast<kernels::RandomState*>(bufferCast<int8_t>(*mRandomStatesDevice));
+    if (fusedTopK)
+    {
+        inputs->probsComputed = false;
+        mTopKLayer->forwardAsync(outputs, baseInputs, workspace);
+    }
     inputs->probsComputed = !skipSoftMax;
     if (!skipSoftMax)
     {
@@ -154,6 +183,10 @@ void SamplingLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> const&
 
     for (auto&& layer : mSamplingLayers)
     {
+        if (fusedTopK && layer.get() == mTopKLayer)
+        {
+            continue;
+        }
         layer->forwardAsync(outputs, baseInputs, workspace);
     }
 
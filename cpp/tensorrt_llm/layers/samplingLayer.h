@@ -27,8 +27,14 @@
 namespace tensorrt_llm::layers
 {
 
+template <typename T>
+class TopKSamplingLayer;
+template <typename T>
+class TopPSamplingLayer;
+
 //! \brief Top class for sampling layers.
-//! It sets up and executes TopKSamplingLayer and TopPSamplingLayer samplings
+//! It sets up and executes TopKSamplingLayer and TopPSamplingLayer samplings, or RejectionSamplingLayer if the
+//! decoding mode uses rejection sampling
 template <typename T>
 class SamplingLayer : public BaseLayer
 {
@@ -57,7 +63,7 @@ private:
     size_t mWorkspaceSize{0};
     size_t mSetupWorkspaceSize{0};
 
-    TensorPtr mCurandStatesDevice;
+    TensorPtr mRandomStatesDevice;
     TensorPtr mSkipDecodeDevice;
 
     TensorPtr mSkipDecodeHost;
@@ -67,6 +73,10 @@ private:
     bool mCumLogProbs{false};
 
     std::vector<std::unique_ptr<BaseLayer>> mSamplingLayers;
+    //! Non-owning, set when top-k is enabled. Asked whether it samples from the raw logits in the current step
+    TopKSamplingLayer<T>* mTopKLayer{nullptr};
+    //! Non-owning, set when top-p is enabled. Asked whether the softmax is needed in the current step
+    TopPSamplingLayer<T>* mTopPLayer{nullptr};
 
 private:
     void allocateBuffer(runtime::SizeType32 batchSize);
@@ -17,6 +17,7 @@
 
 #include "stopCriteriaLayer.h"
 #include "tensorrt_llm/kernels/stopCriteriaKernels.h"
+#include "tensorrt_llm/kernels/wordsAutomaton.h"
 #include "tensorrt_llm/layers/layerUtils.h"
 
 using namespace tensorrt_llm::common;
@@ -49,6 +50,11 @@ StopCriteriaLayer<T>::StopCriteriaLayer(executor::DecodingMode const& mode, Deco
         std::make_pair(ITensor::makeShape({decoderDomain.getBatchSize(), decoderDomain.getBeamWidth()}),
             TRTDataType<FinishedState::UnderlyingType>::value));
     mWorkspaceSize = std::max(stopWordsWorkspaceSize, lengthCriterionWorkspaceSize);
+    if (mDecodingMode.isUseStopWords())
+    {
+        mStopWordsAutomata = std::make_unique<WordsAutomata>(
+            decoderDomain.getBatchSize(), decoderDomain.getBeamWidth(), *mBufferManager);
+    }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -58,6 +64,10 @@ void StopCriteriaLayer<T>::setup(SizeType32 batchSize, SizeType32 beamWidth, Ten
     std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    if (mStopWordsAutomata)
+    {
+        mStopWordsAutomata->reset(batchSlots, batchSize);
+    }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -114,8 +124,12 @@ void StopCriteriaLayer<T>::checkStopWordsStopCriteria(std::shared_ptr<BaseDecodi
     auto* finishedPtr = finishedDevice == nullptr
         ? nullptr
         : reinterpret_cast<FinishedState*>(bufferCast<FinishedState::UnderlyingType>(*finishedDevice));
-    invokeStopWordsCriterion(outputIdsPtr, parentIdsPtr, stopWordsPtrPtr, finishedPtr, sequenceLengthPtr,
-        workspace->getDeviceBatchSlotsPtr(), stopWordsLengthsPtr, numNewTokens, maxStopWordsLength,
+    // Rebuild the automata of new requests. Their nodes are restored up to the tokens of this step
+    mStopWordsAutomata->update(bufferManager, stopWordsPtrPtr, stopWordsLengthsPtr, maxStopWordsLength,
+        inputs->batchSlots, decoderDomain.getBatchSize(), outputIdsPtr, parentIdsPtr, sequenceLengthPtr, numNewTokens,
+        /* defaultNumNewTokens */ 1, decoderDomain.getBeamWidth(), maxSeqLen);
+    invokeStopWordsAutomatonCriterion(mStopWordsAutomata->getParams(), outputIdsPtr, parentIdsPtr, finishedPtr,
+        sequenceLengthPtr, workspace->getDeviceBatchSlotsPtr(), stopWordsLengthsPtr, numNewTokens,
         decoderDomain.getBatchSize(), decoderDomain.getBeamWidth(), maxSeqLen, bufferManager.getStream().get());
     if (finishedPtr != nullptr)
     {
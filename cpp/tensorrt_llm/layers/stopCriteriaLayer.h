@@ -20,6 +20,7 @@
 #include "tensorrt_llm/executor/types.h"
 #include "tensorrt_llm/layers/baseLayer.h"
 #include "tensorrt_llm/layers/decodingParams.h"
+#include "tensorrt_llm/layers/layerUtils.h"
 
 #include <curand_kernel.h>
 
@@ -27,7 +28,7 @@ namespace tensorrt_llm::layers
 {
 
 //! \brief Layer to process stop criteria. Supports:
-//! 1. Stop words criteria
+//! 1. Stop words criteria, matched with per-slot Aho-Corasick automata
 //! 2. Maximum length criteria
 template <typename T>
 class StopCriteriaLayer : public BaseLayer
@@ -51,7 +52,7 @@ private:
     static void checkMaxLengthStopCriteria(std::shared_ptr<BaseDecodingOutputs>& outputs,
         std::shared_ptr<DecodingInputs> const& inputs, DecoderDomain const& decoderDomain,
         runtime::BufferManager const& bufferManager, std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace);
-    static void checkStopWordsStopCriteria(std::shared_ptr<BaseDecodingOutputs>& outputs,
+    void checkStopWordsStopCriteria(std::shared_ptr<BaseDecodingOutputs>& outputs,
         std::shared_ptr<DecodingInputs> const& inputs, DecoderDomain const& decoderDomain,
         runtime::SizeType32 maxSeqLen, runtime::BufferManager const& bufferManager,
         std::shared_ptr<runtime::DecodingLayerWorkspace> const& workspace);
@@ -64,6 +65,7 @@ private:
 
     executor::DecodingMode mDecodingMode;
     size_t mWorkspaceSize{0};
+    std::unique_ptr<WordsAutomata> mStopWordsAutomata;
 };
 
 } // namespace tensorrt_llm::layers
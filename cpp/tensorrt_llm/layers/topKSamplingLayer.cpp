@@ -18,6 +18,7 @@
 #include "topKSamplingLayer.h"
 #include "tensorrt_llm/common/logger.h"
 #include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/kernels/samplingFusedKernels.h"
 #include "tensorrt_llm/kernels/samplingTopKKernels.h"
 #include "tensorrt_llm/layers/defaultDecodingParams.h"
 #include "tensorrt_llm/layers/layerUtils.h"
@@ -34,8 +35,9 @@ namespace tensorrt_llm::layers
 
 template <typename T>
 TopKSamplingLayer<T>::TopKSamplingLayer(
-    DecoderDomain const& decoderDomain, std::shared_ptr<BufferManager> bufferManager)
+    DecoderDomain const& decoderDomain, std::shared_ptr<BufferManager> bufferManager, bool useFusedSampling)
     : BaseLayer(decoderDomain, bufferManager)
+    , mUseFusedSampling(useFusedSampling)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
 
@@ -50,12 +52,25 @@ void TopKSamplingLayer<T>::allocateBuffer(SizeType32 const batchSize)
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
 
     mWorkspaceSize = getTopKWorkspaceSize<T>(batchSize, 1, TOP_K_MAX, mDecoderDomain.getVocabSizePadded());
+    if (mUseFusedSampling)
+    {
+        mWorkspaceSize
+            = std::max(mWorkspaceSize, getFusedSamplingWorkspaceSize(batchSize, mDecoderDomain.getVocabSize()));
+    }
     auto const batchSizeShape = ITensor::makeShape({batchSize});
     mRuntimeTopKDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<SizeType32>::value);
     mRuntimeTopPDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<float>::value);
     mSkipDecodeDevice = mBufferManager->gpu(batchSizeShape, TRTDataType<bool>::value);
     mSetupWorkspaceSize = batchSize * sizeof(SizeType32);
 
+    SizeType32 constexpr setupPhase{0};
+    SizeType32 constexpr samplingPhase{1};
+    // Setup copies to the start of the workspace. Its block conflicts with no other block and is placed at offset 0
+    mWorkspaceArena.addBlock(mSetupWorkspaceSize, setupPhase);
+    mSamplingWorkspaceBlock = mWorkspaceArena.addBlock(mWorkspaceSize, samplingPhase);
+    mActiveBatchSlotsBlock = mWorkspaceArena.addBlock(batchSize * sizeof(SizeType32), samplingPhase);
+    mActiveLogitsPtrsBlock = mWorkspaceArena.addBlock(batchSize * sizeof(T*), samplingPhase);
+
     mSkipDecodeHost = mBufferManager->pinnedPool(batchSizeShape, TRTDataType<bool>::value);
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
@@ -165,9 +180,14 @@ void TopKSamplingLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> con
 
     auto const* batchSlotsHost = bufferCast<SizeType32>(*inputs->batchSlots);
     auto* skipDecodeHostPtr = bufferCastOrNull<bool>(mSkipDecodeHost);
-    auto const skip = allOfBatchSlots(batchSlotsHost, skipDecodeHostPtr, batchSize, true);
-    if (skip)
+    auto const activeIndices = getActiveBatchIndices(batchSlotsHost, skipDecodeHostPtr, batchSize);
+    if (activeIndices.empty())
+    {
+        return;
+    }
+    if (isFusedSampling())
     {
+        forwardFusedAsync(*outputs, *inputs, activeIndices, *workspace);
         return;
     }
 
@@ -181,7 +201,8 @@ void TopKSamplingLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> con
     TopKSamplingKernelParams<T> params;
     params.logProbs = logits;
     params.outputIdsPtrs = bufferCastOrNull<TokenIdType*>(outputs->outputIdsPtr);
-    params.workspace = workspace->getRawWorkspaceDevicePtr();
+    auto* workspacePtr = workspace->getRawWorkspaceDevicePtr();
+    params.workspace = mWorkspaceArena.getPointer<void>(workspacePtr, mSamplingWorkspaceBlock);
     params.maxTopP = 1.0f;
     params.topPs = bufferCastOrNull<float>(mRuntimeTopPDevice);
     params.maxTopK = mRuntimeMaxTopK;
@@ -194,7 +215,7 @@ void TopKSamplingLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> con
     params.skipDecode = bufferCastOrNull<bool>(mSkipDecodeDevice);
     params.cumLogProbs = bufferCastOrNull<float>(outputs->cumLogProbs);
     params.outputLogProbs = bufferCastOrNull<float>(outputs->outputLogProbsTiled);
-    params.curandState = inputs->curandStates;
+    params.randomState = inputs->randomStates;
     params.batchSize = batchSize;
     params.maxBatchSize = mDecoderDomain.getBatchSize();
     params.maxTokensPerStep = 1;
@@ -202,15 +223,98 @@ void TopKSamplingLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> con
     params.normalizeLogProbs = mNormalizeLogProbs;
     params.logitsHasProbs = probsComputed;
 
+    auto const numActive = static_cast<SizeType32>(activeIndices.size());
+    if (numActive < batchSize)
+    {
+        // Launch only over the requests sampled by top-k, addressing their logits rows through pointers
+        setActiveRows(logits, batchSlotsHost, activeIndices, *workspace);
+        params.logProbs = nullptr;
+        params.logProbsPtrs = mWorkspaceArena.getPointer<T const* const>(workspacePtr, mActiveLogitsPtrsBlock);
+        params.batchSlots = mWorkspaceArena.getPointer<SizeType32 const>(workspacePtr, mActiveBatchSlotsBlock);
+        params.batchSize = numActive;
+    }
+
     invokeBatchTopKSampling(params, getStream());
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+template <typename T>
+void TopKSamplingLayer<T>::setActiveRows(T const* logits, SizeType32 const* batchSlotsHost,
+    std::vector<SizeType32> const& activeIndices, DecodingLayerWorkspace const& workspace)
+{
+    auto const numActive = static_cast<SizeType32>(activeIndices.size());
+    std::vector<SizeType32> activeBatchSlots(numActive);
+    std::vector<T const*> activeLogitsPtrs(numActive);
+    for (SizeType32 ai = 0; ai < numActive; ++ai)
+    {
+        auto const bi = activeIndices[ai];
+        activeBatchSlots[ai] = batchSlotsHost[bi];
+        activeLogitsPtrs[ai] = logits + bi * mDecoderDomain.getVocabSizePadded();
+    }
+    auto const workspaceBuffer = workspace.getWorkspaceDeviceBuffer();
+    auto activeBatchSlotsSlice = IBuffer::slice(
+        workspaceBuffer, mWorkspaceArena.getOffset(mActiveBatchSlotsBlock), numActive * sizeof(SizeType32));
+    auto activeLogitsPtrsSlice = IBuffer::slice(
+        workspaceBuffer, mWorkspaceArena.getOffset(mActiveLogitsPtrsBlock), numActive * sizeof(T const*));
+    mBufferManager->copy(activeBatchSlots.data(), *activeBatchSlotsSlice, runtime::MemoryType::kCPU);
+    mBufferManager->copy(activeLogitsPtrs.data(), *activeLogitsPtrsSlice, runtime::MemoryType::kCPU);
+}
+
+template <typename T>
+void TopKSamplingLayer<T>::forwardFusedAsync(BaseDecodingOutputs const& outputs, SamplingInputs const& inputs,
+    std::vector<SizeType32> const& activeIndices, DecodingLayerWorkspace const& workspace)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+
+    TLLM_CHECK_WITH_INFO(!inputs.probsComputed, "Fused sampling needs the logits, not the probabilities");
+
+    // The fused kernel addresses the logits rows through pointers, so it always launches over the active requests
+    auto const* logits = bufferCast<T>(*inputs.logits.value());
+    setActiveRows(logits, bufferCast<SizeType32>(*inputs.batchSlots), activeIndices, workspace);
+
+    auto* workspacePtr = workspace.getRawWorkspaceDevicePtr();
+    FusedSamplingKernelParams<T> params;
+    params.logitsPtrs = mWorkspaceArena.getPointer<T const* const>(workspacePtr, mActiveLogitsPtrsBlock);
+    params.topKs = bufferCastOrNull<SizeType32>(mRuntimeTopKDevice);
+    params.topPs = bufferCastOrNull<float>(mRuntimeTopPDevice);
+    params.maxTopK = mRuntimeMaxTopK;
+    params.maxTopP = 1.0f;
+    params.randomState = inputs.randomStates;
+    params.outputIdsPtrs = bufferCastOrNull<TokenIdType*>(outputs.outputIdsPtr);
+    params.sequenceLengths = bufferCastOrNull<SizeType32>(outputs.sequenceLength);
+    params.endIds = bufferCastOrNull<TokenIdType>(inputs.endIds);
+    params.finishedInput = (inputs.finished)
+        ? reinterpret_cast<FinishedState const*>(bufferCastOrNull<FinishedState::UnderlyingType>(inputs.finished))
+        : nullptr;
+    params.finishedOutput = (outputs.finished)
+        ? reinterpret_cast<FinishedState*>(bufferCastOrNull<FinishedState::UnderlyingType>(outputs.finished))
+        : nullptr;
+    params.skipDecode = bufferCastOrNull<bool>(mSkipDecodeDevice);
+    params.cumLogProbs = bufferCastOrNull<float>(outputs.cumLogProbs);
+    params.outputLogProbs = bufferCastOrNull<float>(outputs.outputLogProbsTiled);
+    params.batchSlots = mWorkspaceArena.getPointer<SizeType32 const>(workspacePtr, mActiveBatchSlotsBlock);
+    params.workspace = mWorkspaceArena.getPointer<void>(workspacePtr, mSamplingWorkspaceBlock);
+    params.batchSize = static_cast<SizeType32>(activeIndices.size());
+    params.maxBatchSize = mDecoderDomain.getBatchSize();
+    params.vocabSize = mDecoderDomain.getVocabSize();
+    params.vocabSizePadded = mDecoderDomain.getVocabSizePadded();
+
+    invokeFusedSampling(params, getStream());
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 template <typename T>
 size_t TopKSamplingLayer<T>::getWorkspaceSize() const noexcept
 {
-    return std::max(mWorkspaceSize, mSetupWorkspaceSize);
+    return mWorkspaceArena.getTotalSize();
+}
+
+template <typename T>
+bool TopKSamplingLayer<T>::isFusedSampling() const noexcept
+{
+    return mUseFusedSampling && mRuntimeMaxTopK <= FUSED_SAMPLING_TOP_K_MAX;
 }
 
 template class TopKSamplingLayer<float>;
@@ -19,6 +19,7 @@
 
 #include "tensorrt_llm/layers/baseLayer.h"
 #include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/workspaceArena.h"
 
 namespace tensorrt_llm::layers
 {
@@ -26,13 +27,16 @@ namespace tensorrt_llm::layers
 //! \brief Layer to randomly sample tokens from TopK logits.
 //! When both TopK and TopP are specified, layer jointly samples using TopK and TopP.
 //! When no TopK param is specified, sampling is skipped for particular request.
+//! With useFusedSampling, steps whose largest K is at most FUSED_SAMPLING_TOP_K_MAX sample with invokeFusedSampling,
+//! which reads the raw logits.
 template <typename T>
 class TopKSamplingLayer : public BaseLayer
 {
     using Base = BaseLayer;
 
 public:
-    TopKSamplingLayer(DecoderDomain const& decoderDomain, std::shared_ptr<runtime::BufferManager> bufferManager);
+    TopKSamplingLayer(DecoderDomain const& decoderDomain, std::shared_ptr<runtime::BufferManager> bufferManager,
+        bool useFusedSampling = false);
 
     void setup(runtime::SizeType32 batchSize, runtime::SizeType32 beamWidth, TensorConstPtr batchSlots,
         std::shared_ptr<BaseSetupParams> const& setupParams,
@@ -44,7 +48,11 @@ public:
     //! @returns workspace needed for this layer in bytes
     [[nodiscard]] size_t getWorkspaceSize() const noexcept override;
 
+    //! @returns whether the next step samples with the fused kernel, which needs the raw logits
+    [[nodiscard]] bool isFusedSampling() const noexcept;
+
 protected:
+    bool mUseFusedSampling{false};
     bool mNormalizeLogProbs{true};
     size_t mWorkspaceSize{0};
     size_t mSetupWorkspaceSize{0};
@@ -54,10 +62,24 @@ protected:
     TensorPtr mSkipDecodeDevice;
     TensorPtr mSkipDecodeHost;
 
+    //! Layout of the shared workspace. Setup and sampling never run at the same time and alias each other
+    runtime::WorkspaceArena mWorkspaceArena;
+    runtime::WorkspaceArena::BlockId mSamplingWorkspaceBlock{0};
+    //! Batch slots and logits rows of the requests sampled in the current step when some requests skip top-k
+    runtime::WorkspaceArena::BlockId mActiveBatchSlotsBlock{0};
+    runtime::WorkspaceArena::BlockId mActiveLogitsPtrsBlock{0};
+
     using Base::mDecoderDomain;
 
 private:
     void allocateBuffer(runtime::SizeType32 batchSize);
+
+    //! \brief Copy the batch slots and logits rows of the active requests to the workspace
+    void setActiveRows(T const* logits, runtime::SizeType32 const* batchSlotsHost,
+        std::vector<runtime::SizeType32> const& activeIndices, runtime::DecodingLayerWorkspace const& workspace);
+
+    void forwardFusedAsync(BaseDecodingOutputs const& outputs, SamplingInputs const& inputs,
+        std::vector<runtime::SizeType32> const& activeIndices, runtime::DecodingLayerWorkspace const& workspace);
 };
 
 } // namespace tensorrt_llm::layers
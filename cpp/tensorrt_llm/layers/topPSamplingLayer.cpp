@@ -243,9 +243,7 @@ void TopPSamplingLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> con
 
     auto const batchSize = inputs->logits.value()->getDimension<0>();
 
-    auto* skipDecodeHostPtr = bufferCastOrNull<bool>(mSkipDecodeHost);
-    auto const skip = allOfBatchSlots(bufferCast<SizeType32>(*inputs->batchSlots), skipDecodeHostPtr, batchSize, true);
-    if (skip)
+    if (!hasActiveSlots(bufferCast<SizeType32>(*inputs->batchSlots), batchSize))
     {
         return;
     }
@@ -278,7 +276,7 @@ void TopPSamplingLayer<T>::forwardAsync(std::shared_ptr<BaseDecodingOutputs> con
     params.skipDecode = bufferCastOrNull<bool>(mSkipDecodeDevice);
     params.cumLogProbs = cumLogProbs;
     params.outputLogProbs = outputLogProbs;
-    params.curandState = inputs->curandStates;
+    params.randomState = inputs->randomStates;
     params.batchSize = batchSize;
     params.maxBatchSize = mDecoderDomain.getBatchSize();
     params.vocabSizePadded = mDecoderDomain.getVocabSizePadded();
@@ -313,6 +311,13 @@ size_t TopPSamplingLayer<T>::getWorkspaceSize() const noexcept
     return std::max(mSetupWorkspaceSize, mWorkspaceSize);
 }
 
+template <typename T>
+bool TopPSamplingLayer<T>::hasActiveSlots(SizeType32 const* batchSlotsHost, SizeType32 batchSize) const
+{
+    auto const* skipDecodeHostPtr = bufferCastOrNull<bool>(mSkipDecodeHost);
+    return !allOfBatchSlots(batchSlotsHost, skipDecodeHostPtr, batchSize, true);
+}
+
 template class TopPSamplingLayer<float>;
 template class TopPSamplingLayer<half>;
 
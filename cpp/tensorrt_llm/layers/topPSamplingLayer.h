@@ -44,6 +44,9 @@ public:
     //! @returns workspace needed for this layer in bytes
     [[nodiscard]] size_t getWorkspaceSize() const noexcept override;
 
+    //! @returns true if any request of the local batch is sampled by top-p
+    [[nodiscard]] bool hasActiveSlots(runtime::SizeType32 const* batchSlotsHost, runtime::SizeType32 batchSize) const;
+
 protected:
     TensorPtr mRuntimeTopKDevice;
     TensorPtr mRuntimeTopPDevice;
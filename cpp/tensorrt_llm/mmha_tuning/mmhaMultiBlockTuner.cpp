@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Fills the MMHA multi-block tuning table by timing every number of KV splits for the given head configuration, batch
+// sizes and KV lengths on the current GPU. Serving processes load the table from TRTLLM_MMHA_MULTI_BLOCK_TUNING_FILE:
+//
+//   mmhaMultiBlockTuner --output=/path/to/mmha_tuning.txt --num_heads=32 --num_kv_heads=8 --head_size=128
+//       --batch_sizes=1,2,4,8,16 --kv_lengths=1024,4096,16384
+//
+// Entries of an existing output file are kept unless they are tuned again.
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention.h"
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/multiBlockTuningTable.h"
+#include "tensorrt_llm/kernels/kvCacheUtils.h"
+
+#include <cmath>
+#include <cuda_fp16.h>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tc = tensorrt_llm::common;
+namespace tk = tensorrt_llm::kernels;
+
+namespace
+{
+
+void printUsage(char const* program)
+{
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --output=FILE           tuning file to write, existing entries are kept\n"
+              << "  --num_heads=N           number of query heads per rank (default 32)\n"
+              << "  --num_kv_heads=N        number of KV heads per rank (default 8)\n"
+              << "  --head_size=N           head size (default 128)\n"
+              << "  --batch_sizes=LIST      batch sizes, one per batch bucket (default 1,2,4,8,16,32,64)\n"
+              << "  --kv_lengths=LIST       KV lengths, one per KV length bucket (default 1024,2048,4096,8192,16384)\n"
+              << "  --max_splits=N          largest number of KV splits to try (default 64)\n"
+              << "  --iterations=N          timed launches per candidate (default 20)\n";
+}
+
+std::vector<int> splitIntList(std::string const& list)
+{
+    std::vector<int> values;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        if (!item.empty())
+        {
+            values.push_back(std::stoi(item));
+        }
+    }
+    return values;
+}
+
+template <typename T>
+T* deviceAlloc(size_t count)
+{
+    T* ptr = nullptr;
+    TLLM_CUDA_CHECK(cudaMalloc(&ptr, count * sizeof(T)));
+    TLLM_CUDA_CHECK(cudaMemset(ptr, 0, count * sizeof(T)));
+    return ptr;
+}
+
+// Device buffers of one fp16 MMHA problem with a linear KV cache.
+struct Problem
+{
+    Problem(int batchSize, int kvLength, int numHeads, int numKvHeads, int headSize, int maxSplits)
+    {
+        auto const hiddenSize = (numHeads + 2 * numKvHeads) * headSize;
+        qkv = deviceAlloc<uint16_t>(static_cast<size_t>(batchSize) * hiddenSize);
+        out = deviceAlloc<uint16_t>(static_cast<size_t>(batchSize) * numHeads * headSize);
+        kvCache = deviceAlloc<int8_t>(
+            static_cast<size_t>(batchSize) * 2 * kvLength * numKvHeads * headSize * sizeof(uint16_t));
+        partialOut = deviceAlloc<uint16_t>(static_cast<size_t>(batchSize) * numHeads * headSize * maxSplits);
+        partialSum = deviceAlloc<float>(static_cast<size_t>(batchSize) * numHeads * maxSplits);
+        partialMax = deviceAlloc<float>(static_cast<size_t>(batchSize) * numHeads * maxSplits);
+        blockCounter = deviceAlloc<int>(static_cast<size_t>(batchSize) * numHeads);
+        std::vector<int> const lengths(batchSize, kvLength);
+        sequenceLengths = deviceAlloc<int>(batchSize);
+        TLLM_CUDA_CHECK(
+            cudaMemcpy(sequenceLengths, lengths.data(), batchSize * sizeof(int), cudaMemcpyHostToDevice));
+
+        params.out = out;
+        params.q = qkv;
+        params.k = qkv + numHeads * headSize;
+        params.v = qkv + (numHeads + numKvHeads) * headSize;
+        params.stride = hiddenSize;
+        params.batch_size = batchSize;
+        params.beam_width = 1;
+        params.max_attention_window_size = kvLength;
+        params.cyclic_attention_window_size = kvLength;
+        params.length_per_sample = sequenceLengths;
+        params.input_lengths = sequenceLengths;
+        params.timestep = kvLength - 1;
+        params.num_heads = numHeads;
+        params.num_kv_heads = numKvHeads;
+        params.hidden_size_per_head = headSize;
+        params.inv_sqrt_dh = 1.f / std::sqrt(static_cast<float>(headSize));
+        params.qk_tanh_inverse_scale = 1.f;
+        params.multi_block_mode = true;
+        params.min_seq_len_tile = 1;
+        params.max_seq_len_tile = maxSplits;
+        params.partial_out = partialOut;
+        params.partial_sum = partialSum;
+        params.partial_max = partialMax;
+        params.block_counter = blockCounter;
+        params.multi_processor_count = tc::getMultiProcessorCount();
+
+        kvCacheBuffer = tk::KVLinearBuffer(batchSize, kvLength, numKvHeads * headSize * sizeof(uint16_t), kvLength, 0,
+            false, kvCache);
+    }
+
+    ~Problem()
+    {
+        for (void* ptr : std::initializer_list<void*>{
+                 qkv, out, kvCache, partialOut, partialSum, partialMax, blockCounter, sequenceLengths})
+        {
+            cudaFree(ptr);
+        }
+    }
+
+    void run(cudaStream_t stream) const
+    {
+        // The kernels update the multi-block state of params.
+        auto launchParams = params;
+        tk::masked_multihead_attention(launchParams, kvCacheBuffer, tk::KVLinearBuffer{}, stream);
+    }
+
+    uint16_t* qkv;
+    uint16_t* out;
+    int8_t* kvCache;
+    uint16_t* partialOut;
+    float* partialSum;
+    float* partialMax;
+    int* blockCounter;
+    int* sequenceLengths;
+    tk::Masked_multihead_attention_params<uint16_t> params{};
+    tk::KVLinearBuffer kvCacheBuffer;
+};
+
+float timeProblem(Problem const& problem, int iterations, cudaStream_t stream, cudaEvent_t start, cudaEvent_t stop)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        problem.run(stream);
+    }
+    TLLM_CUDA_CHECK(cudaEventRecord(start, stream));
+    for (int i = 0; i < iterations; ++i)
+    {
+        problem.run(stream);
+    }
+    TLLM_CUDA_CHECK(cudaEventRecord(stop, stream));
+    TLLM_CUDA_CHECK(cudaEventSynchronize(stop));
+    float milliseconds = 0.f;
+    TLLM_CUDA_CHECK(cudaEventElapsedTime(&milliseconds, start, stop));
+    return milliseconds / iterations;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::map<std::string, std::string> options{{"output", ""}, {"num_heads", "32"}, {"num_kv_heads", "8"},
+        {"head_size", "128"}, {"batch_sizes", "1,2,4,8,16,32,64"}, {"kv_lengths", "1024,2048,4096,8192,16384"},
+        {"max_splits", "64"}, {"iterations", "20"}};
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg{argv[i]};
+        auto const eq = arg.find('=');
+        if (arg == "--help" || arg.rfind("--", 0) != 0 || eq == std::string::npos
+            || options.count(arg.substr(2, eq - 2)) == 0)
+        {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+        options[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+    }
+    if (options["output"].empty())
+    {
+        TLLM_LOG_ERROR("No output file, set --output");
+        return 1;
+    }
+
+    auto const numHeads = std::stoi(options["num_heads"]);
+    auto const numKvHeads = std::stoi(options["num_kv_heads"]);
+    auto const headSize = std::stoi(options["head_size"]);
+    auto const maxSplits = std::stoi(options["max_splits"]);
+    auto const iterations = std::stoi(options["iterations"]);
+    if (!tk::mmha_supported(headSize))
+    {
+        TLLM_LOG_ERROR("MMHA does not support head size %d", headSize);
+        return 1;
+    }
+
+    // The tuned entries are written to a separate table, candidates are forced through the global one.
+    tk::MultiBlockTuningTable tuned;
+    if (std::filesystem::exists(options["output"]) && !tuned.loadFile(options["output"]))
+    {
+        return 1;
+    }
+    auto& global = tk::MultiBlockTuningTable::getGlobal();
+    auto const sm = tc::getSMVersion();
+
+    cudaStream_t stream;
+    cudaEvent_t start;
+    cudaEvent_t stop;
+    TLLM_CUDA_CHECK(cudaStreamCreate(&stream));
+    TLLM_CUDA_CHECK(cudaEventCreate(&start));
+    TLLM_CUDA_CHECK(cudaEventCreate(&stop));
+    for (auto const batchSize : splitIntList(options["batch_sizes"]))
+    {
+        for (auto const kvLength : splitIntList(options["kv_lengths"]))
+        {
+            Problem const problem(batchSize, kvLength, numHeads, numKvHeads, headSize, maxSplits);
+            auto const key
+                = tk::MultiBlockTuningTable::makeKey(sm, numHeads, numKvHeads, headSize, batchSize, kvLength);
+            int bestSplits = 1;
+            float bestTime = 0.f;
+            for (int splits = 1; splits <= maxSplits; ++splits)
+            {
+                global.set(key, splits);
+                auto const time = timeProblem(problem, iterations, stream, start, stop);
+                if (splits == 1 || time < bestTime)
+                {
+                    bestSplits = splits;
+                    bestTime = time;
+                }
+            }
+            tuned.set(key, bestSplits);
+            TLLM_LOG_INFO("batch_size=%d kv_length=%d: %d splits, %.3f us", batchSize, kvLength, bestSplits,
+                bestTime * 1000.f);
+        }
+    }
+    TLLM_CUDA_CHECK(cudaEventDestroy(start));
+    TLLM_CUDA_CHECK(cudaEventDestroy(stop));
+    TLLM_CUDA_CHECK(cudaStreamDestroy(stream));
+
+    if (!tuned.saveFile(options["output"]))
+    {
+        return 1;
+    }
+    TLLM_LOG_INFO("Wrote %zu multi-block tuning entries to %s", tuned.size(), options["output"].c_str());
+    return 0;
+}
@@ -299,7 +299,9 @@ int BertAttentionPlugin::enqueueImpl(nvinfer1::PluginTensorDesc const* inputDesc
         fmhaParams.b = request_batch_size;
         fmhaParams.qSeqLen = request_seq_len;
         fmhaParams.kvSeqLen = request_seq_len;
-        fmhaParams.totalQSeqLen = request_batch_size * request_seq_len;
+        // Packed inputs only hold the valid tokens.
+        fmhaParams.totalQSeqLen = num_tokens;
+        fmhaParams.totalKvSeqLen = num_tokens;
         // Device buffer pointers.
         fmhaParams.qkvPtr = attention_input;
         fmhaParams.outputPtr = context_buf_;
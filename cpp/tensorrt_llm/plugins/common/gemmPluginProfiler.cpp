@@ -16,6 +16,7 @@
  */
 
 #include "tensorrt_llm/plugins/common/gemmPluginProfiler.h"
+#include "tensorrt_llm/plugins/common/gemmTacticCache.h"
 #include "tensorrt_llm/common/cublasMMWrapper.h"
 #include "tensorrt_llm/kernels/cutlass_kernels/fp8_rowwise_gemm/fp8_rowwise_gemm.h"
 #include "tensorrt_llm/kernels/cutlass_kernels/fpA_intB_gemm/fpA_intB_gemm.h"
@@ -24,6 +25,9 @@
 #include "tensorrt_llm/plugins/lowLatencyGemmPlugin/lowLatencyGemmPlugin.h"
 #include "tensorrt_llm/plugins/mixtureOfExperts/mixtureOfExpertsPlugin.h"
 
+#include <cstring>
+#include <typeinfo>
+
 namespace tensorrt_llm::plugins
 {
 
@@ -139,11 +143,28 @@ void GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::profileT
 
     auto mProfileMap = mMNKProfileMap->getMProfileMap(gemmId);
     bool isAllocated{false};
+    auto* tacticCache = GemmTacticCache::getGlobal();
+    bool isTacticCacheUpdated{false};
 
-    auto profileTactics = [&mProfileMap, &isAllocated, this](int m, int n, int k)
+    auto profileTactics = [&mProfileMap, &isAllocated, &gemmId, tacticCache, &isTacticCacheUpdated, this](
+                              int m, int n, int k)
     {
         if (mProfileMap->count(m) == 0)
         {
+            using ProfileEntry = std::optional<Config>;
+            auto const key = tacticCache ? getTacticCacheKey(m, gemmId) : std::string{};
+            if (tacticCache)
+            {
+                auto const cached = tacticCache->lookup(key);
+                if (cached && cached->size() == sizeof(ProfileEntry))
+                {
+                    ProfileEntry config;
+                    std::memcpy(&config, cached->data(), sizeof(ProfileEntry));
+                    mProfileMap->insert({m, config});
+                    this->onBestConfig(m, n, k, config);
+                    return;
+                }
+            }
             if (!isAllocated)
             {
                 // Allocate tmp data to run GEMMs
@@ -153,7 +174,15 @@ void GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::profileT
             initTmpData(m, n, k, mWorkspaceTmp, mTmpWorkspaceSizeInBytes, mStream);
             auto const tactics = this->getTactics(m, n, k);
             // Profile different tactics for particular m and insert best config to the map
-            mProfileMap->insert({m, this->profileTacticsForProblem(m, n, k, tactics)});
+            auto const config = this->profileTacticsForProblem(m, n, k, tactics);
+            mProfileMap->insert({m, config});
+            this->onBestConfig(m, n, k, config);
+            if (tacticCache)
+            {
+                tacticCache->store(
+                    key, std::string(reinterpret_cast<char const*>(&config), sizeof(ProfileEntry)));
+                isTacticCacheUpdated = true;
+            }
         }
     };
 
@@ -173,6 +202,21 @@ void GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::profileT
         freeTmpData();
     }
     common::check_cuda_error(cudaStreamDestroy(mStream));
+
+    if (isTacticCacheUpdated)
+    {
+        tacticCache->flush();
+    }
+}
+
+template <typename Config, typename RunnerPtr, typename GemmIdType, typename GemmIdHashType>
+std::string GemmPluginProfiler<Config, RunnerPtr, GemmIdType, GemmIdHashType>::getTacticCacheKey(
+    int m, GemmIdType const& gemmId) const
+{
+    std::ostringstream os;
+    os << GemmTacticCache::getEnvironmentKey() << ' ' << typeid(*this).name() << " [" << getTacticCacheTag() << "] "
+       << gemmId << " m=" << m;
+    return os.str();
 }
 
 template <typename Config, typename RunnerPtr, typename GemmIdType, typename GemmIdHashType>
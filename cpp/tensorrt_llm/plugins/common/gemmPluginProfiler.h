@@ -28,6 +28,7 @@
 #include <optional>
 #include <shared_mutex>
 #include <sstream>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -258,9 +259,21 @@ protected:
 
     virtual void initTmpData(int m, int n, int k, char* workspace, size_t size, cudaStream_t stream);
 
+    // The state of the profiler, besides the GEMM id, that the best tactic depends on. Part of the key of the
+    // tactics in the persistent GemmTacticCache.
+    virtual std::string getTacticCacheTag() const
+    {
+        return {};
+    }
+
+    // Called with the best config of every m bucket, whether it was profiled or came from the GemmTacticCache.
+    virtual void onBestConfig(int m, int n, int k, std::optional<Config> const& config) {}
+
 private:
     void allocateTmpData();
 
+    std::string getTacticCacheKey(int m, GemmIdType const& gemmId) const;
+
     void freeTmpData();
 
     std::optional<Config> profileTacticsForProblem(int m, int n, int k, std::vector<Config> const& tactics);
@@ -0,0 +1,191 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "tensorrt_llm/plugins/common/gemmTacticCache.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/stringUtils.h"
+
+#include "cutlass/version.h"
+
+#include <filesystem>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace tensorrt_llm::plugins
+{
+
+namespace
+{
+
+std::string getTemporarySuffix()
+{
+#if defined(_WIN32)
+    auto const pid = _getpid();
+#else
+    auto const pid = getpid();
+#endif
+    return ".tmp." + std::to_string(pid);
+}
+
+} // namespace
+
+GemmTacticCache::GemmTacticCache(std::string path)
+    : mPath(std::move(path))
+{
+}
+
+std::string const& GemmTacticCache::getEnvironmentKey()
+{
+    static std::string const key = []()
+    {
+        std::ostringstream os;
+        os << "sm" << common::getSMVersion() << " cutlass" << CUTLASS_MAJOR << '.' << CUTLASS_MINOR << '.'
+           << CUTLASS_PATCH << " cuda" << CUDART_VERSION;
+        return os.str();
+    }();
+    return key;
+}
+
+std::optional<std::string> GemmTacticCache::lookup(std::string const& key) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto const it = mEntries.find(key);
+    if (it == mEntries.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void GemmTacticCache::store(std::string const& key, std::string const& tactic)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries[key] = tactic;
+}
+
+size_t GemmTacticCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+bool GemmTacticCache::load(std::istream& is)
+{
+    std::vector<std::pair<std::string, std::string>> entries;
+    std::string line;
+    while (std::getline(is, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        auto const separator = line.find(' ');
+        auto tactic = separator == std::string::npos ? std::nullopt : common::fromHex(line.substr(0, separator));
+        if (!tactic || separator + 1 >= line.size())
+        {
+            TLLM_LOG_WARNING("Malformed GEMM tactic cache entry '%s'.", line.c_str());
+            return false;
+        }
+        entries.emplace_back(line.substr(separator + 1), std::move(*tactic));
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto& [key, tactic] : entries)
+    {
+        // Entries of this process are newer than the ones on disk.
+        mEntries.emplace(std::move(key), std::move(tactic));
+    }
+    return true;
+}
+
+void GemmTacticCache::save(std::ostream& os) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    os << "# <hex tactic> <environment> <profiler> <tag> <gemm id> m=<m bucket>\n";
+    for (auto const& [key, tactic] : mEntries)
+    {
+        os << common::toHex(tactic) << ' ' << key << '\n';
+    }
+}
+
+bool GemmTacticCache::flush()
+{
+    {
+        std::ifstream file(mPath);
+        if (file)
+        {
+            load(file);
+        }
+    }
+
+    std::error_code ec;
+    auto const tmpPath = mPath + getTemporarySuffix();
+    {
+        std::ofstream file(tmpPath, std::ios::trunc);
+        if (file)
+        {
+            save(file);
+        }
+        if (!file)
+        {
+            TLLM_LOG_WARNING("Cannot write the GEMM tactic cache %s.", tmpPath.c_str());
+            file.close();
+            fs::remove(tmpPath, ec);
+            return false;
+        }
+    }
+    fs::rename(tmpPath, mPath, ec);
+    if (ec)
+    {
+        TLLM_LOG_WARNING("Cannot publish the GEMM tactic cache %s: %s", mPath.c_str(), ec.message().c_str());
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+GemmTacticCache* GemmTacticCache::getGlobal()
+{
+    static std::unique_ptr<GemmTacticCache> const cache = []() -> std::unique_ptr<GemmTacticCache>
+    {
+        auto const path = common::getEnvGemmTacticCacheFile();
+        if (!path)
+        {
+            return nullptr;
+        }
+        auto instance = std::make_unique<GemmTacticCache>(*path);
+        std::ifstream file(*path);
+        if (file && instance->load(file))
+        {
+            TLLM_LOG_INFO("Loaded %zu GEMM tactics from %s.", instance->size(), path->c_str());
+        }
+        return instance;
+    }();
+    return cache.get();
+}
+
+} // namespace tensorrt_llm::plugins
@@ -0,0 +1,66 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <iosfwd>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace tensorrt_llm::plugins
+{
+
+// Persistent database of profiled GEMM tactics, shared by engine builds.
+//
+// GemmPluginProfiler looks up every (profiler, GEMM id, m bucket) here before timing its tactics and stores the
+// winners afterwards, so engine variants with the same GEMM shapes (other TP sizes, batch sizes, LoRA on/off) don't
+// profile them again. Keys are prefixed with the GPU arch and the CUTLASS and CUDA versions, so one file can serve
+// several GPUs and toolkits. The file holds one "<hex tactic> <key>" entry per line and is merged and atomically
+// replaced on every flush, so concurrent builds only lose each other's most recent entries.
+class GemmTacticCache
+{
+public:
+    explicit GemmTacticCache(std::string path);
+
+    // Environment part of the keys, e.g. "sm90 cutlass3.5.0 cuda12040".
+    static std::string const& getEnvironmentKey();
+
+    [[nodiscard]] std::optional<std::string> lookup(std::string const& key) const;
+
+    void store(std::string const& key, std::string const& tactic);
+
+    // Returns false and leaves the cache unchanged if the stream holds a malformed entry.
+    bool load(std::istream& is);
+
+    void save(std::ostream& os) const;
+
+    // Merge the entries on disk and write them back with the new ones. Failures are logged and return false.
+    bool flush();
+
+    [[nodiscard]] size_t size() const;
+
+    // The cache of TRTLLM_GEMM_TACTIC_CACHE_FILE, nullptr if it isn't set.
+    static GemmTacticCache* getGlobal();
+
+private:
+    std::string mPath;
+    mutable std::mutex mMutex;
+    std::unordered_map<std::string, std::string> mEntries;
+};
+
+} // namespace tensorrt_llm::plugins
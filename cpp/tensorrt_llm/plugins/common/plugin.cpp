@@ -16,6 +16,7 @@
  */
 #include "tensorrt_llm/plugins/common/plugin.h"
 
+#include "tensorrt_llm/common/commLane.h"
 #include "tensorrt_llm/common/mpiUtils.h"
 
 #include "checkMacrosPlugin.h"
@@ -72,7 +73,9 @@ std::shared_ptr<ncclComm_t> getComm(std::set<int> const& group)
 {
     auto const rank = COMM_SESSION.getRank();
     TLLM_LOG_TRACE("%s start for rank %d", __PRETTY_FUNCTION__, rank);
-    static std::map<std::set<int>, std::weak_ptr<ncclComm_t>> commMap;
+    // Every communication lane has communicators of its own
+    static std::map<std::pair<std::set<int>, int>, std::weak_ptr<ncclComm_t>> commMap;
+    auto const key = std::make_pair(group, tensorrt_llm::common::getCommLane());
     static std::mutex mutex;
     std::lock_guard<std::mutex> lock(mutex);
     std::ostringstream oss;
@@ -87,19 +90,19 @@ std::shared_ptr<ncclComm_t> getComm(std::set<int> const& group)
         index++;
     }
     auto groupStr = oss.str();
-    auto it = commMap.find(group);
+    auto it = commMap.find(key);
     if (it != commMap.end())
     {
         // If the weak_ptr can be locked, return the shared_ptr
         auto ncclComm = it->second.lock();
         if (ncclComm)
         {
-            TLLM_LOG_TRACE("NCCL comm for group(%s) is cached for rank %d", groupStr.c_str(), rank);
+            TLLM_LOG_TRACE("NCCL comm for group(%s) lane %d is cached for rank %d", groupStr.c_str(), key.second, rank);
             return ncclComm;
         }
     }
 
-    TLLM_LOG_TRACE("Init NCCL comm for group(%s) for rank %d", groupStr.c_str(), rank);
+    TLLM_LOG_TRACE("Init NCCL comm for group(%s) lane %d for rank %d", groupStr.c_str(), key.second, rank);
     ncclUniqueId id = getUniqueId(group);
     int groupRank = 0;
     for (auto const& currentRank : group)
@@ -116,10 +119,25 @@ std::shared_ptr<ncclComm_t> getComm(std::set<int> const& group)
             delete comm;
         });
     NCCLCHECK(ncclCommInitRank(ncclComm.get(), group.size(), id, groupRank));
-    commMap[group] = ncclComm;
+    commMap[key] = ncclComm;
     TLLM_LOG_TRACE("%s stop for rank %d", __PRETTY_FUNCTION__, rank);
     return ncclComm;
 }
+
+ncclComm_t getLaneComm(
+    std::set<int> const& group, std::shared_ptr<ncclComm_t> const& comm, std::shared_ptr<ncclComm_t>& laneComm)
+{
+    if (tensorrt_llm::common::getCommLane() == 0)
+    {
+        return *comm;
+    }
+    if (!laneComm)
+    {
+        // All ranks of the group enqueue the same layers on the lane, so they create the communicator together
+        laneComm = getComm(group);
+    }
+    return *laneComm;
+}
 #endif // ENABLE_MULTI_DEVICE
 
 void const* tensorrt_llm::plugins::getCommSessionHandle()
@@ -172,8 +172,14 @@ inline bool isBuilding()
 
 std::unordered_map<nvinfer1::DataType, ncclDataType_t>* getDtypeMap();
 
+//! The communicator of a group for the communication lane of the calling thread, see common::getCommLane.
 std::shared_ptr<ncclComm_t> getComm(std::set<int> const& group);
 
+//! The communicator to enqueue on: comm, which the plugin gets in initialize(), on lane 0 and laneComm, which is set on
+//! first use, on the other lanes.
+ncclComm_t getLaneComm(
+    std::set<int> const& group, std::shared_ptr<ncclComm_t> const& comm, std::shared_ptr<ncclComm_t>& laneComm);
+
 #endif // ENABLE_MULTI_DEVICE
 
 //! To save GPU memory, all the plugins share the same cublas and cublasLt handle globally.
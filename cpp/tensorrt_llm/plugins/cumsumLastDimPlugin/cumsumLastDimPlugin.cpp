@@ -55,6 +55,8 @@ CumsumLastDimPlugin::CumsumLastDimPlugin(void const* data, size_t length)
     read(d, mTempStorageBytes);
     read(d, mType);
     TLLM_CHECK(d == a + length);
+    // Engines built before the look-back scan stored the DeviceScan size
+    mTempStorageBytes = getWorkspaceSizeNeeded(mInputLength, mType);
     TLLM_CHECK_WITH_INFO((getSMVersion() >= 80) || (mType != DataType::kBF16), "Unsupported data type");
     TLLM_CHECK_WITH_INFO((mType == DataType::kBF16) || (mType == DataType::kFLOAT) || (mType == DataType::kHALF)
             || (mType == DataType::kINT32),
@@ -134,12 +136,9 @@ int CumsumLastDimPlugin::enqueueImpl(nvinfer1::PluginTensorDesc const* inputDesc
     //     0.  output_tensor [batch_size, inputLength]
     auto const batchSize = inputDesc[getInputTensorIdx()].dims.d[0];
     auto const inputLength = inputDesc[getInputTensorIdx()].dims.d[1];
-    /*
-        Two cases where we should use BlockScan:
-            1. inputLength is small
-            2. batchSize is large (since DeviceScan causes kernel launch per row)
-    */
-    void* wp = inputLength < LENGTH_LIMIT_FOR_BLOCKSCAN || batchSize > 2 ? nullptr : workspace;
+    // Long rows get a workspace for the multi-block look-back scan, which the kernel only uses when there are too few
+    // rows to fill the GPU with one block per row.
+    void* wp = inputLength < LENGTH_LIMIT_FOR_BLOCKSCAN || mTempStorageBytes == 0 ? nullptr : workspace;
     invokeCumsumLastDim<T>(
         batchSize, inputLength, inputs[getInputTensorIdx()], outputs[0], wp, mTempStorageBytes, stream);
 
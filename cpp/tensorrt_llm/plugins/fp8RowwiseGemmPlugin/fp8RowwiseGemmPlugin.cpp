@@ -17,12 +17,14 @@
 
 #include "fp8RowwiseGemmPlugin.h"
 #include "cutlass_extensions/gemm_configs.h"
+#include "tensorrt_llm/kernels/fp8BlockScaleGemm.h"
 
 #include <NvInferRuntimeBase.h>
 #include <numeric>
 
 using namespace nvinfer1;
 using namespace tensorrt_llm::common;
+using namespace tensorrt_llm::kernels;
 using namespace tensorrt_llm::kernels::cutlass_kernels;
 using tensorrt_llm::plugins::Fp8RowwiseGemmPluginCreator;
 using tensorrt_llm::plugins::Fp8RowwiseGemmPlugin;
@@ -113,9 +115,10 @@ std::vector<Fp8RowwiseGemmPluginProfiler::Config> Fp8RowwiseGemmPluginProfiler::
     return mRunner->getConfigs();
 }
 
-Fp8RowwiseGemmPlugin::Fp8RowwiseGemmPlugin(
-    QuantMode quantMode, nvinfer1::DataType type, Fp8RowwiseGemmPlugin::PluginProfilerPtr const& pluginProfiler)
+Fp8RowwiseGemmPlugin::Fp8RowwiseGemmPlugin(QuantMode quantMode, nvinfer1::DataType type, bool blockScaling,
+    Fp8RowwiseGemmPlugin::PluginProfilerPtr const& pluginProfiler)
     : mQuantMode(quantMode)
+    , mBlockScaling(blockScaling)
     , mPluginProfiler(pluginProfiler)
 {
     init(type);
@@ -132,6 +135,7 @@ Fp8RowwiseGemmPlugin::Fp8RowwiseGemmPlugin(
     read(d, quantMode);
     read(d, type);
     read(d, mDims);
+    read(d, mBlockScaling);
 
     mQuantMode = QuantMode(quantMode);
 
@@ -245,7 +249,12 @@ void Fp8RowwiseGemmPlugin::configurePlugin(nvinfer1::DynamicPluginTensorDesc con
     }
     mGemmId = {maxN, maxK, mType};
 
-    mWorkspaceMaxSize = mGemmRunner->getWorkspaceSize(maxM, maxN, maxK);
+    if (mBlockScaling)
+    {
+        TLLM_CHECK_WITH_INFO(maxK % kFp8BlockScaleGroupSize == 0,
+            "Block scaling needs the in channels (%d) to be a multiple of %d.", maxK, kFp8BlockScaleGroupSize);
+    }
+    mWorkspaceMaxSize = mBlockScaling ? 0 : mGemmRunner->getWorkspaceSize(maxM, maxN, maxK);
 }
 
 size_t Fp8RowwiseGemmPlugin::getWorkspaceSize(nvinfer1::PluginTensorDesc const* inputs, int nbInputs,
@@ -263,6 +272,9 @@ int Fp8RowwiseGemmPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
     //     mat2           [N, K]
     //     scale_tokens   [M, 1] if has_per_token_scaling else [1, 1]
     //     scale_channels [1, N] if has_per_channel_scaling else [1, 1]
+    // with block scaling
+    //     scale_tokens   [M(*), K / 128]
+    //     scale_channels [ceil(N / 128), K / 128]
     // outputs
     //     mat [M(*), N]
     int m = 1;
@@ -272,6 +284,27 @@ int Fp8RowwiseGemmPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
     }
     int const n = inputDesc[1].dims.d[0];
     int const k = inputDesc[0].dims.d[inputDesc[0].dims.nbDims - 1];
+
+    if (mBlockScaling)
+    {
+        auto const* a = reinterpret_cast<__nv_fp8_e4m3 const*>(inputs[0]);
+        auto const* b = reinterpret_cast<__nv_fp8_e4m3 const*>(inputs[1]);
+        auto const* aScales = reinterpret_cast<float const*>(inputs[2]);
+        auto const* bScales = reinterpret_cast<float const*>(inputs[3]);
+        if (mType == nvinfer1::DataType::kHALF)
+        {
+            invokeFp8BlockScaleGemm(reinterpret_cast<half*>(outputs[0]), a, aScales, b, bScales, m, n, k, stream);
+        }
+#ifdef ENABLE_BF16
+        else if (mType == nvinfer1::DataType::kBF16)
+        {
+            invokeFp8BlockScaleGemm(
+                reinterpret_cast<__nv_bfloat16*>(outputs[0]), a, aScales, b, bScales, m, n, k, stream);
+        }
+#endif
+        return 0;
+    }
+
     size_t const wsSize = mGemmRunner->getWorkspaceSize(m, n, k);
 
     auto const bestTactic = mPluginProfiler->getBestConfig(m, mGemmId);
@@ -322,6 +355,7 @@ size_t Fp8RowwiseGemmPlugin::getSerializationSize() const noexcept
     return sizeof(unsigned int) +                       // QuantMode
         sizeof(nvinfer1::DataType) +                    // dtype
         sizeof(mDims) +                                 // Dimensions
+        sizeof(mBlockScaling) +                         // Block scaling
         mPluginProfiler->getSerializationSize(mGemmId); // selected tactics container size
 }
 
@@ -331,6 +365,7 @@ void Fp8RowwiseGemmPlugin::serialize(void* buffer) const noexcept
     write(d, mQuantMode.value());
     write(d, mType);
     write(d, mDims);
+    write(d, mBlockScaling);
 
     mPluginProfiler->serialize(d, mGemmId);
     TLLM_CHECK(d == a + getSerializationSize());
@@ -344,6 +379,11 @@ void Fp8RowwiseGemmPlugin::destroy() noexcept
 
 void Fp8RowwiseGemmPlugin::configGemm()
 {
+    if (mBlockScaling)
+    {
+        // The block-scaled GEMM has a single tactic.
+        return;
+    }
     mPluginProfiler->profileTactics(mGemmRunner, mType, mDims, mGemmId);
 }
 
@@ -354,6 +394,7 @@ Fp8RowwiseGemmPluginCreator::Fp8RowwiseGemmPluginCreator()
     mPluginAttributes.emplace_back(PluginField("has_per_channel_scaling", nullptr, PluginFieldType::kINT32, 1));
     mPluginAttributes.emplace_back(PluginField("has_per_token_scaling", nullptr, PluginFieldType::kINT32, 1));
     mPluginAttributes.emplace_back(PluginField("type_id", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("has_block_scaling", nullptr, PluginFieldType::kINT32, 1));
     mFC.nbFields = mPluginAttributes.size();
     mFC.fields = mPluginAttributes.data();
 }
@@ -376,8 +417,9 @@ PluginFieldCollection const* Fp8RowwiseGemmPluginCreator::getFieldNames() noexce
 IPluginV2* Fp8RowwiseGemmPluginCreator::createPlugin(char const* name, PluginFieldCollection const* fc) noexcept
 {
     PluginField const* fields = fc->fields;
-    TLLM_CHECK(fc->nbFields == 3);
+    TLLM_CHECK(fc->nbFields == 3 || fc->nbFields == 4);
     bool perTokenScaling, perChannelScaling;
+    bool blockScaling{false};
     nvinfer1::DataType type;
     // Read configurations from each fields
     for (int i = 0; i < fc->nbFields; ++i)
@@ -398,6 +440,11 @@ IPluginV2* Fp8RowwiseGemmPluginCreator::createPlugin(char const* name, PluginFie
             TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
             type = static_cast<nvinfer1::DataType>(*(static_cast<nvinfer1::DataType const*>(fields[i].data)));
         }
+        else if (!strcmp(attrName, "has_block_scaling"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            blockScaling = static_cast<bool>(*(static_cast<int const*>(fields[i].data)));
+        }
     }
     try
     {
@@ -405,7 +452,7 @@ IPluginV2* Fp8RowwiseGemmPluginCreator::createPlugin(char const* name, PluginFie
         // Create plugin profiler with shared tactics map
         auto pluginProfiler = mGemmPluginProfileManager.createGemmPluginProfiler(/* inference */ false);
         QuantMode quantMode = QuantMode::fromDescription();
-        auto* obj = new Fp8RowwiseGemmPlugin(quantMode, type, pluginProfiler);
+        auto* obj = new Fp8RowwiseGemmPlugin(quantMode, type, blockScaling, pluginProfiler);
         obj->setPluginNamespace(mNamespace.c_str());
         return obj;
     }
@@ -48,6 +48,11 @@ protected:
 
     std::vector<Config> getTactics(int m, int n, int k) const override;
 
+    std::string getTacticCacheTag() const override
+    {
+        return "quantMode=" + std::to_string(mQuantMode.value());
+    }
+
 private:
     size_t getBytePerElement(nvinfer1::DataType type);
 
@@ -61,8 +66,8 @@ public:
 
     Fp8RowwiseGemmPlugin() = delete;
 
-    Fp8RowwiseGemmPlugin(
-        tensorrt_llm::common::QuantMode quantMode, nvinfer1::DataType type, PluginProfilerPtr const& pluginProfiler);
+    Fp8RowwiseGemmPlugin(tensorrt_llm::common::QuantMode quantMode, nvinfer1::DataType type, bool blockScaling,
+        PluginProfilerPtr const& pluginProfiler);
 
     Fp8RowwiseGemmPlugin(void const* data, size_t length, PluginProfilerPtr const& profiler);
 
@@ -105,6 +110,8 @@ private:
 
     Fp8RowwiseGemmRunnerPtr mGemmRunner;
     tensorrt_llm::common::QuantMode mQuantMode; // not configurable yet
+    // Scale every 128 activation columns of a token and every 128x128 weight block instead of rows and columns.
+    bool mBlockScaling{false};
     size_t mWorkspaceMaxSize;
 
     GemmDims mDims{};
@@ -92,12 +92,27 @@ void CublasLtGemmPluginProfiler::runTactic(
         nextWorkspacePtrWithAlignment(reinterpret_cast<int8_t*>(weightPtr), n * k * dataSize, ALIGNMENT));
     char* workspacePtr = reinterpret_cast<char*>(
         nextWorkspacePtrWithAlignment(reinterpret_cast<int8_t*>(outputPtr), m * n * dataSize, ALIGNMENT));
+    if (isCudaCoreGemmTactic(tactic))
+    {
+        auto const quantMode
+            = mUseFp8 ? tensorrt_llm::common::QuantMode::fromQuantAlgo("FP8") : tensorrt_llm::common::QuantMode{};
+        tensorrt_llm::kernels::cuda_core_gemm::Params params(actPtr, weightPtr, 1.0f, outputPtr, m, n, k, quantMode,
+            mUseFp8 ? nvinfer1::DataType::kFP8 : mType, mOutputType);
+        TLLM_CHECK_WITH_INFO(tensorrt_llm::kernels::cuda_core_gemm::cudaCoreGemmDispatcher(params, stream),
+            "The CUDA core GEMM does not support this problem");
+        return;
+    }
     runGemm(m, n, k, mTransA, mTransB, mPadLda, mPadLdb, mType, mRunner, actPtr, weightPtr, 1.0f, outputPtr, {tactic},
         workspacePtr, stream);
 }
 
 bool CublasLtGemmPluginProfiler::checkTactic(int m, int n, int k, Config const& tactic) const
 {
+    if (isCudaCoreGemmTactic(tactic))
+    {
+        return true;
+    }
+
     cublasOperation_t transa, transb;
     int M = m, N = n, K = k;
     int lda, ldb, ldc;
@@ -112,6 +127,21 @@ bool CublasLtGemmPluginProfiler::checkTactic(int m, int n, int k, Config const&
     return checkResult;
 }
 
+void CublasLtGemmPluginProfiler::onBestConfig(int M, int N, int K, std::optional<Config> const& config)
+{
+    if (!config || isCudaCoreGemmTactic(*config))
+    {
+        return;
+    }
+
+    cublasOperation_t transa, transb;
+    int m, n, k;
+    int lda, ldb, ldc;
+    getProblemParams(transa, transb, m, n, k, lda, ldb, ldc, mTransA, mTransB, M, N, K, mPadLda, mPadLdb);
+
+    mRunner->storeCachedAlgo(transa, transb, m, n, k, lda, ldb, ldc, config->algo);
+}
+
 void CublasLtGemmPluginProfiler::computeTmpSize(size_t maxM, size_t n, size_t k)
 {
     size_t dataSize = typeSize(mType);
@@ -135,9 +165,18 @@ std::vector<CublasLtGemmPluginProfiler::Config> CublasLtGemmPluginProfiler::getT
     getProblemParams(transa, transb, m, n, k, lda, ldb, ldc, mTransA, mTransB, M, N, K, mPadLda, mPadLdb);
 
     mRunner->createDescriptors(transa, transb, m, n, k, lda, ldb, ldc);
-    auto const heruistics = mRunner->getTactics(transa, transb, m, n, k, lda, ldb, ldc);
+    auto heruistics = mRunner->getTactics(transa, transb, m, n, k, lda, ldb, ldc);
     mRunner->destroyDescriptors();
 
+    // The CUDA core GEMM reads A [M, K] and B [N, K] without padding.
+    bool const cudaCoreGemmSupportType = mType == nvinfer1::DataType::kHALF || mType == nvinfer1::DataType::kFLOAT
+        || mType == nvinfer1::DataType::kBF16;
+    if (M <= tensorrt_llm::kernels::cuda_core_gemm::kCudaCoreGemmMaxM && !mTransA && mTransB && mPadLda == 0
+        && mPadLdb == 0 && cudaCoreGemmSupportType)
+    {
+        heruistics.push_back(getCudaCoreGemmTactic());
+    }
+
     return heruistics;
 }
 
@@ -190,6 +229,7 @@ void GemmPlugin::init()
 
     mPluginProfiler->setTranspose(mTransA, mTransB);
     mPluginProfiler->setOutputType(mOutputType);
+    mPluginProfiler->setUseFp8(mUseFp8);
     mPluginProfiler->setPadLd(mPadLda, mPadLdb);
 
     mGemmId = GemmIdCublas(mDims.n, mDims.k, mType, mTransA, mTransB, mOutputType);
@@ -379,9 +419,22 @@ int GemmPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::P
             "Found NaN in " + activationStr);
     }
 
+    // With a profile the profiler picks between the CUDA core GEMM and cuBLASLt per bucket of M, without one the CUDA
+    // core GEMM runs for the smallest batches.
+    auto bestTactic = mPluginProfiler->getBestConfig(M, mGemmId);
+    bool useCudaCoreGemm = M <= (mUseFp8 ? 4 : 6) && N <= 128000;
+    if (bestTactic)
+    {
+        useCudaCoreGemm = CublasLtGemmPluginProfiler::isCudaCoreGemmTactic(*bestTactic);
+        if (useCudaCoreGemm)
+        {
+            bestTactic = std::nullopt;
+        }
+    }
+
     bool cudaKernelFinished = false;
     // TODO: sub tensor matmul is not supported in fp8 gemm cuda kernel
-    if (M <= 4 && N <= 128000 && mUseFp8 && noPadDim && cudaKernelSupportType)
+    if (useCudaCoreGemm && mUseFp8 && noPadDim && cudaKernelSupportType)
     {
         tensorrt_llm::common::QuantMode quantMode = tensorrt_llm::common::QuantMode::fromQuantAlgo("FP8");
         tensorrt_llm::kernels::cuda_core_gemm::Params params(reinterpret_cast<void const*>(inputs[0]),
@@ -389,7 +442,7 @@ int GemmPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::P
             nvinfer1::DataType::kFP8, mOutputType);
         cudaKernelFinished = tensorrt_llm::kernels::cuda_core_gemm::cudaCoreGemmDispatcher(params, stream);
     }
-    else if (M <= 6 && N <= 128000 && !mUseFp8 && noPadDim && cudaKernelSupportType)
+    else if (useCudaCoreGemm && !mUseFp8 && noPadDim && cudaKernelSupportType)
     {
         tensorrt_llm::common::QuantMode quantMode;
         tensorrt_llm::kernels::cuda_core_gemm::Params params(reinterpret_cast<void const*>(inputs[0]),
@@ -400,7 +453,6 @@ int GemmPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::P
 
     if (!cudaKernelFinished)
     {
-        auto bestTactic = mPluginProfiler->getBestConfig(M, mGemmId);
         runGemm(M, N, K, mTransA, mTransB, mPadLda, mPadLdb, mType, mCublasWrapper, inputs[0], inputs[1], mAlpha,
             outputs[0], bestTactic, workspace, stream);
     }
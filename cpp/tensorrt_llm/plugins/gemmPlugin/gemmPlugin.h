@@ -53,6 +53,25 @@ public:
         mOutputType = type;
     }
 
+    void setUseFp8(bool useFp8)
+    {
+        mUseFp8 = useFp8;
+    }
+
+    // The CUDA core GEMM competes with the cuBLASLt algos for m up to kCudaCoreGemmMaxM. cuBLASLt never reports a
+    // negative number of waves, so a heuristic result with one stands for the CUDA core GEMM.
+    static Config getCudaCoreGemmTactic()
+    {
+        Config tactic{};
+        tactic.wavesCount = -1.f;
+        return tactic;
+    }
+
+    static bool isCudaCoreGemmTactic(Config const& tactic)
+    {
+        return tactic.wavesCount < 0.f;
+    }
+
 protected:
     void runTactic(int m, int n, int k, Config const& tactic, char* workspace, cudaStream_t const& stream) override;
 
@@ -62,12 +81,23 @@ protected:
 
     std::vector<Config> getTactics(int m, int n, int k) const override;
 
+    // Shares the winning cuBLASLt algo with the GEMMs that run without a profiled tactic, through CublasAlgoCache.
+    void onBestConfig(int m, int n, int k, std::optional<Config> const& config) override;
+
+    std::string getTacticCacheTag() const override
+    {
+        // The heuristic results hold cuBLASLt algos, which are only valid for the library version they came from.
+        return "padLda=" + std::to_string(mPadLda) + " padLdb=" + std::to_string(mPadLdb)
+            + " cublasLt=" + std::to_string(cublasLtGetVersion()) + " fp8=" + std::to_string(mUseFp8);
+    }
+
 private:
     bool mTransA;
     bool mTransB;
     int mPadLda;
     int mPadLdb;
     nvinfer1::DataType mOutputType;
+    bool mUseFp8{false};
 
     static constexpr size_t ALIGNMENT = 256;
 };
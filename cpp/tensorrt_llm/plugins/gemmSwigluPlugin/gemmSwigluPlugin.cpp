@@ -24,6 +24,7 @@
 using namespace nvinfer1;
 using namespace tensorrt_llm::common;
 using namespace tensorrt_llm::kernels::cutlass_kernels;
+using tensorrt_llm::kernels::GatedActivationType;
 using tensorrt_llm::plugins::GemmSwigluPluginCreator;
 using tensorrt_llm::plugins::GemmSwigluPlugin;
 using tensorrt_llm::plugins::GemmSwigluPluginProfiler;
@@ -106,13 +107,15 @@ std::vector<GemmSwigluPluginProfiler::Config> GemmSwigluPluginProfiler::getTacti
 }
 
 GemmSwigluPlugin::GemmSwigluPlugin(QuantMode quantMode, nvinfer1::DataType type, bool hasBias, float scale_d0,
-    float scale_d1, float scale_output, GemmSwigluPlugin::PluginProfilerPtr const& pluginProfiler)
+    float scale_d1, float scale_output, GatedActivationType activation,
+    GemmSwigluPlugin::PluginProfilerPtr const& pluginProfiler)
     : mQuantMode(quantMode)
+    , mPluginProfiler(pluginProfiler)
     , mHasBias(hasBias)
     , mScaleD0(scale_d0)
     , mScaleD1(scale_d1)
     , mScaleOutput(scale_output)
-    , mPluginProfiler(pluginProfiler)
+    , mActivation(activation)
 {
     init(type);
 }
@@ -132,6 +135,7 @@ GemmSwigluPlugin::GemmSwigluPlugin(
     read(d, mScaleD1);
     read(d, mScaleOutput);
     read(d, mDims);
+    read(d, mActivation);
 
     mQuantMode = QuantMode(quantMode);
 
@@ -145,13 +149,29 @@ GemmSwigluPlugin::GemmSwigluPlugin(
 void GemmSwigluPlugin::init(nvinfer1::DataType type)
 {
     mType = type;
-    if (mType == nvinfer1::DataType::kFP8)
+    // The fp8 CUTLASS kernel is built for SM90 and SwiGLU only.
+    mUseGatedGemmKernel = mQuantMode.hasInt8Weights() || mType != nvinfer1::DataType::kFP8
+        || getSMVersion() != 90 || mActivation != GatedActivationType::kSWIGLU;
+    if (!mUseGatedGemmKernel)
     {
         mGemmRunner = std::make_shared<CutlassFusedGatedGemmRunner<__nv_fp8_e4m3>>();
     }
+    else if (mType == nvinfer1::DataType::kFP8)
+    {
+#ifndef ENABLE_FP8
+        TLLM_THROW("Gemm Swiglu plugin needs ENABLE_FP8 for fp8 on this GPU or with GeGLU");
+#endif
+        TLLM_CHECK_WITH_INFO(!mQuantMode.hasInt8Weights(), "SmoothQuant writes fp16 or bf16 outputs");
+    }
     else
     {
-        TLLM_THROW("Gemm Swiglu plugin only supports fp8 now");
+#ifdef ENABLE_BF16
+        TLLM_CHECK_WITH_INFO(mType == nvinfer1::DataType::kHALF || mType == nvinfer1::DataType::kBF16,
+            "Gemm Swiglu plugin supports fp8, fp16, bf16 and int8 SmoothQuant");
+#else
+        TLLM_CHECK_WITH_INFO(
+            mType == nvinfer1::DataType::kHALF, "Gemm Swiglu plugin supports fp8, fp16 and int8 SmoothQuant");
+#endif
     }
 
     mPluginProfiler->setQuantMode(mQuantMode);
@@ -171,7 +191,7 @@ nvinfer1::DimsExprs GemmSwigluPlugin::getOutputDimensions(
 {
     try
     {
-        TLLM_CHECK(nbInputs == 3);
+        TLLM_CHECK(nbInputs == (mQuantMode.hasInt8Weights() ? 5 : 3));
         TLLM_CHECK(outputIndex == 0);
         int const nbDimsA = inputs[0].nbDims;
         TLLM_CHECK(nbDimsA >= 2);
@@ -194,20 +214,27 @@ nvinfer1::DimsExprs GemmSwigluPlugin::getOutputDimensions(
 bool GemmSwigluPlugin::supportsFormatCombination(
     int pos, nvinfer1::PluginTensorDesc const* inOut, int nbInputs, int nbOutputs) noexcept
 {
+    auto const inputType = mQuantMode.hasInt8Weights() ? nvinfer1::DataType::kINT8 : mType;
+    if (pos == nbInputs)
+    {
+        // out
+        return inOut[pos].type == mType && inOut[pos].format == TensorFormat::kLINEAR;
+    }
     switch (pos)
     {
     case 0:
         // activation
-        return inOut[pos].type == mType && inOut[pos].format == TensorFormat::kLINEAR;
+        return inOut[pos].type == inputType && inOut[pos].format == TensorFormat::kLINEAR;
     case 1:
         // weights
-        return inOut[pos].type == mType && inOut[pos].format == TensorFormat::kLINEAR;
+        return inOut[pos].type == inputType && inOut[pos].format == TensorFormat::kLINEAR;
     case 2:
         // bias
         return inOut[pos].type == mType && inOut[pos].format == TensorFormat::kLINEAR;
     case 3:
-        // out
-        return inOut[pos].type == mType && inOut[pos].format == TensorFormat::kLINEAR;
+    case 4:
+        // per-token and per-channel scales of SmoothQuant
+        return inOut[pos].type == nvinfer1::DataType::kFLOAT && inOut[pos].format == TensorFormat::kLINEAR;
     default:
         // Never should be here
         TLLM_CHECK(false);
@@ -235,6 +262,14 @@ void GemmSwigluPlugin::configurePlugin(nvinfer1::DynamicPluginTensorDesc const*
     }
     mGemmId = {maxN, maxK, mType};
 
+    if (mUseGatedGemmKernel)
+    {
+        auto const inputBytes = mQuantMode.hasInt8Weights() || mType == nvinfer1::DataType::kFP8 ? 1 : 2;
+        TLLM_CHECK_WITH_INFO((maxK * inputBytes) % 16 == 0, "The in channels (%d) must take a multiple of 16 bytes",
+            maxK);
+        mWorkspaceMaxSize = 0;
+        return;
+    }
     mWorkspaceMaxSize = mGemmRunner->getWorkspaceSize(maxM, maxN, maxK);
 }
 
@@ -251,6 +286,9 @@ int GemmSwigluPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinf
     //     mat1           [M(*), K]
     //     mat2           [K, N]
     //     bias           [1, N]
+    // with SmoothQuant
+    //     scale_tokens   [M(*), 1]
+    //     scale_channels [1, N]
     // outputs
     //     mat [M(*), N / 2]
     int m = 1;
@@ -260,6 +298,11 @@ int GemmSwigluPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinf
     }
     int const n = inputDesc[1].dims.d[1];
     int const k = inputDesc[0].dims.d[inputDesc[0].dims.nbDims - 1];
+    if (mUseGatedGemmKernel)
+    {
+        enqueueGatedGemm(inputDesc, inputs, outputs, m, n, k, stream);
+        return 0;
+    }
     size_t const wsSize = mGemmRunner->getWorkspaceSize(m, n, k);
 
     auto const bestTactic = mPluginProfiler->getBestConfig(m, mGemmId);
@@ -270,6 +313,54 @@ int GemmSwigluPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinf
     return 0;
 }
 
+void GemmSwigluPlugin::enqueueGatedGemm(nvinfer1::PluginTensorDesc const* inputDesc, void const* const* inputs,
+    void* const* outputs, int m, int n, int k, cudaStream_t stream)
+{
+    using tensorrt_llm::kernels::invokeGatedGemm;
+    auto const* tokenScales = mQuantMode.hasInt8Weights() ? reinterpret_cast<float const*>(inputs[3]) : nullptr;
+    auto const* channelScales = mQuantMode.hasInt8Weights() ? reinterpret_cast<float const*>(inputs[4]) : nullptr;
+    auto const run = [&](auto* out, auto const* a)
+    {
+        using OutT = std::remove_pointer_t<decltype(out)>;
+        auto const* b = reinterpret_cast<decltype(a)>(inputs[1]);
+        auto const* bias = mHasBias ? reinterpret_cast<OutT const*>(inputs[2]) : nullptr;
+        invokeGatedGemm(out, a, b, bias, tokenScales, channelScales, m, n, k, mScaleD0, mScaleD1, mScaleOutput,
+            mActivation, stream);
+    };
+    if (mType == nvinfer1::DataType::kHALF)
+    {
+        auto* out = reinterpret_cast<half*>(outputs[0]);
+        if (mQuantMode.hasInt8Weights())
+        {
+            run(out, reinterpret_cast<int8_t const*>(inputs[0]));
+        }
+        else
+        {
+            run(out, reinterpret_cast<half const*>(inputs[0]));
+        }
+    }
+#ifdef ENABLE_BF16
+    else if (mType == nvinfer1::DataType::kBF16)
+    {
+        auto* out = reinterpret_cast<__nv_bfloat16*>(outputs[0]);
+        if (mQuantMode.hasInt8Weights())
+        {
+            run(out, reinterpret_cast<int8_t const*>(inputs[0]));
+        }
+        else
+        {
+            run(out, reinterpret_cast<__nv_bfloat16 const*>(inputs[0]));
+        }
+    }
+#endif
+#ifdef ENABLE_FP8
+    else if (mType == nvinfer1::DataType::kFP8)
+    {
+        run(reinterpret_cast<__nv_fp8_e4m3*>(outputs[0]), reinterpret_cast<__nv_fp8_e4m3 const*>(inputs[0]));
+    }
+#endif
+}
+
 // IPluginV2Ext Methods
 nvinfer1::DataType GemmSwigluPlugin::getOutputDataType(
     int index, nvinfer1::DataType const* inputTypes, int nbInputs) const noexcept
@@ -310,6 +401,7 @@ size_t GemmSwigluPlugin::getSerializationSize() const noexcept
         sizeof(bool) +                                  // hasBias
         sizeof(float) * 3 +                             // scales
         sizeof(mDims) +                                 // Dimensions
+        sizeof(mActivation) +                           // Activation
         mPluginProfiler->getSerializationSize(mGemmId); // selected tactics container size
 }
 
@@ -323,6 +415,7 @@ void GemmSwigluPlugin::serialize(void* buffer) const noexcept
     write(d, mScaleD1);
     write(d, mScaleOutput);
     write(d, mDims);
+    write(d, mActivation);
 
     mPluginProfiler->serialize(d, mGemmId);
     TLLM_CHECK(d == a + getSerializationSize());
@@ -336,6 +429,11 @@ void GemmSwigluPlugin::destroy() noexcept
 
 void GemmSwigluPlugin::configGemm()
 {
+    if (mUseGatedGemmKernel)
+    {
+        // invokeGatedGemm has a single tactic.
+        return;
+    }
     mPluginProfiler->profileTactics(mGemmRunner, mType, mDims, mGemmId);
 }
 
@@ -350,6 +448,8 @@ GemmSwigluPluginCreator::GemmSwigluPluginCreator()
     mPluginAttributes.emplace_back(PluginField("scale_d0", nullptr, PluginFieldType::kFLOAT32, 1.0));
     mPluginAttributes.emplace_back(PluginField("scale_d1", nullptr, PluginFieldType::kFLOAT32, 1.0));
     mPluginAttributes.emplace_back(PluginField("scale_output", nullptr, PluginFieldType::kFLOAT32, 1.0));
+    mPluginAttributes.emplace_back(PluginField("activation", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("smooth_quant", nullptr, PluginFieldType::kINT8, 1));
     mFC.nbFields = mPluginAttributes.size();
     mFC.fields = mPluginAttributes.data();
 }
@@ -372,12 +472,15 @@ PluginFieldCollection const* GemmSwigluPluginCreator::getFieldNames() noexcept
 IPluginV2* GemmSwigluPluginCreator::createPlugin(char const* name, PluginFieldCollection const* fc) noexcept
 {
     PluginField const* fields = fc->fields;
-    TLLM_CHECK(fc->nbFields == 5);
+    // activation and smooth_quant are optional
+    TLLM_CHECK(fc->nbFields >= 5 && fc->nbFields <= 7);
     nvinfer1::DataType type;
     bool hasBias;
     float scale_d0;
     float scale_d1;
     float scale_output;
+    auto activation = GatedActivationType::kSWIGLU;
+    bool smoothQuant = false;
     // Read configurations from each fields
     for (int i = 0; i < fc->nbFields; ++i)
     {
@@ -407,14 +510,26 @@ IPluginV2* GemmSwigluPluginCreator::createPlugin(char const* name, PluginFieldCo
             TLLM_CHECK(fields[i].type == PluginFieldType::kFLOAT32);
             scale_output = static_cast<float>(*(static_cast<float const*>(fields[i].data)));
         }
+        else if (!strcmp(attrName, "activation"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            activation = static_cast<GatedActivationType>(*(static_cast<int const*>(fields[i].data)));
+        }
+        else if (!strcmp(attrName, "smooth_quant"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT8);
+            smoothQuant = static_cast<bool>(*(static_cast<int8_t const*>(fields[i].data)));
+        }
     }
     try
     {
         // GemmSwigluPluginCreator is unique and shared for an engine generation
         // Create plugin profiler with shared tactics map
         auto pluginProfiler = mGemmPluginProfileManager.createGemmPluginProfiler(/* inference */ false);
-        QuantMode quantMode = QuantMode::fromDescription();
-        auto* obj = new GemmSwigluPlugin(quantMode, type, hasBias, scale_d0, scale_d1, scale_output, pluginProfiler);
+        QuantMode quantMode
+            = smoothQuant ? QuantMode::fromDescription(true, true, true, true) : QuantMode::fromDescription();
+        auto* obj = new GemmSwigluPlugin(
+            quantMode, type, hasBias, scale_d0, scale_d1, scale_output, activation, pluginProfiler);
         obj->setPluginNamespace(mNamespace.c_str());
         return obj;
     }
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "tensorrt_llm/kernels/cutlass_kernels/fused_gated_gemm/fused_gated_gemm.h"
+#include "tensorrt_llm/kernels/gatedGemm.h"
 #include "tensorrt_llm/plugins/common/gemmPluginProfiler.h"
 #include "tensorrt_llm/plugins/common/plugin.h"
 #include <cassert>
@@ -53,6 +54,11 @@ protected:
 
     void initTmpData(int m, int n, int k, char* workspace, size_t size, cudaStream_t stream) override;
 
+    std::string getTacticCacheTag() const override
+    {
+        return "quantMode=" + std::to_string(mQuantMode.value());
+    }
+
 private:
     size_t getBytePerElement(nvinfer1::DataType type);
 
@@ -66,8 +72,13 @@ public:
 
     GemmSwigluPlugin() = delete;
 
+    //! \param quantMode Int8 weights select SmoothQuant: int8 activations and weights with per-token and per-channel
+    //! scales as two more inputs, type is then the type of the bias and of the output.
+    //! \param activation Only SwiGLU runs on the fp8 CUTLASS kernel of SM90, GeGLU and the other types and GPUs run
+    //! invokeGatedGemm.
     GemmSwigluPlugin(tensorrt_llm::common::QuantMode quantMode, nvinfer1::DataType type, bool hasBias, float scale_d0,
-        float scale_d1, float scale_output, PluginProfilerPtr const& pluginProfiler);
+        float scale_d1, float scale_output, tensorrt_llm::kernels::GatedActivationType activation,
+        PluginProfilerPtr const& pluginProfiler);
 
     GemmSwigluPlugin(void const* data, size_t length, PluginProfilerPtr const& profiler);
 
@@ -106,6 +117,9 @@ private:
     void configGemm();
     // void setGemmConfig();
 
+    void enqueueGatedGemm(nvinfer1::PluginTensorDesc const* inputDesc, void const* const* inputs,
+        void* const* outputs, int m, int n, int k, cudaStream_t stream);
+
 private:
     const std::string mLayerName;
 
@@ -123,6 +137,9 @@ private:
     float mScaleD0;
     float mScaleD1;
     float mScaleOutput;
+    tensorrt_llm::kernels::GatedActivationType mActivation{tensorrt_llm::kernels::GatedActivationType::kSWIGLU};
+    // Run invokeGatedGemm instead of the CUTLASS runner, which has no profiled tactics then
+    bool mUseGatedGemmKernel{false};
 };
 
 class GemmSwigluPluginCreator : public BaseCreator
@@ -17,10 +17,16 @@
 #include "gptAttentionCommon.h"
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/dataType.h"
 #include "tensorrt_llm/common/memoryUtils.h"
+#include "tensorrt_llm/kernels/buildRelativeAttentionBiasKernel.h"
+#include "tensorrt_llm/kernels/cascadeAttentionKernels.h"
+#include "tensorrt_llm/kernels/gqaGenerationAttention.h"
+#include "tensorrt_llm/kernels/contextFusedMultiHeadAttention/pagedKvFmha.h"
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention.h"
 #include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/decoderXQARunner.h"
 #include "tensorrt_llm/kernels/gptKernels.h"
+#include "tensorrt_llm/kernels/int4KvCacheUtils.h"
 #include "tensorrt_llm/kernels/kvCacheUtils.h"
 #include "tensorrt_llm/kernels/unfusedAttentionKernels.h"
 #include "tensorrt_llm/plugins/common/checkMacrosPlugin.h"
@@ -37,6 +43,9 @@ namespace tc = tensorrt_llm::common;
 using tensorrt_llm::plugins::GPTAttentionPluginCreatorCommon;
 using tensorrt_llm::plugins::GPTAttentionPluginCommon;
 
+// Upper bound of the number of CTAs that split the KV range of a prefix or a suffix in cascade attention.
+static constexpr int32_t kCascadeAttentionMaxSplits = 8;
+
 template <typename T>
 struct SATypeConverter
 {
@@ -72,6 +81,8 @@ struct FusedQKVMaskedAttentionDispatchParams
     float const* rotary_embedding_inv_freq_cache;
     float rotary_embedding_short_m_scale;
     float rotary_embedding_long_m_scale;
+    float const* rotary_embedding_inv_freq;
+    float const* rotary_embedding_mscale;
     int rotary_embedding_max_positions;
     int rotary_embedding_original_max_positions;
     int rotary_cogvlm_vision_start;
@@ -111,6 +122,7 @@ struct FusedQKVMaskedAttentionDispatchParams
     bool cross_attention = false;
     int const* memory_length_per_sample = nullptr;
     int max_distance = 0;
+    bool relative_attention_bias_per_distance = false;
     bool block_sparse_attention = false;
     BlockSparseParams block_sparse_params;
 };
@@ -161,6 +173,11 @@ bool GPTAttentionPluginCommon::convertMMHAParamsToXQAParams(tensorrt_llm::kernel
     {
         return false;
     }
+    // MMHA reads the per-request rotary frequencies, XQA only supports the ones shared by the batch.
+    if (usePerRequestRotaryScaling(generationsParams.rotary_long_inv_freq))
+    {
+        return false;
+    }
     memset(&xqaParams, 0, sizeof(XQAParams));
     xqaParams.data_type = ConvertMMHAToXQAParamsHelper<T, KVCacheBuffer>::data_type;
 
@@ -315,6 +332,8 @@ void fusedQKV_masked_attention_dispatch(Multihead_attention_params<T_MMHA, CROSS
     params.rotary_embedding_inv_freq_cache = input_params.rotary_embedding_inv_freq_cache;
     params.rotary_embedding_short_m_scale = input_params.rotary_embedding_short_m_scale;
     params.rotary_embedding_long_m_scale = input_params.rotary_embedding_long_m_scale;
+    params.rotary_embedding_inv_freq = input_params.rotary_embedding_inv_freq;
+    params.rotary_embedding_mscale = input_params.rotary_embedding_mscale;
     params.rotary_embedding_max_positions = input_params.rotary_embedding_max_positions;
     params.rotary_embedding_original_max_positions = input_params.rotary_embedding_original_max_positions;
     params.rotary_cogvlm_vision_start = input_params.rotary_cogvlm_vision_start;
@@ -329,6 +348,7 @@ void fusedQKV_masked_attention_dispatch(Multihead_attention_params<T_MMHA, CROSS
     params.relative_attention_bias = reinterpret_cast<DataType const*>(input_params.relative_attention_bias);
     params.relative_attention_bias_stride = input_params.relative_attention_bias_stride;
     params.max_distance = input_params.max_distance;
+    params.relative_attention_bias_per_distance = input_params.relative_attention_bias_per_distance;
     params.block_sparse_attention = input_params.block_sparse_attention;
     params.block_sparse_params = input_params.block_sparse_params;
 
@@ -484,6 +504,10 @@ GPTAttentionPluginCommon::GPTAttentionPluginCommon(int layer_idx, int num_heads,
     {
         TLLM_CHECK_WITH_INFO(mEnableContextFMHA, "FP8 FMHA cannot be enabled because Context FMHA is not supported.");
         TLLM_CHECK_WITH_INFO(mSM == 89 || mSM == 90, "FP8 FMHA cannot be enabled except on Ada or Hopper Arch.");
+        // The output is the FP8 input of the output projection, quantized with its scale in the epilogue of bmm2, so
+        // the attention output quantization scale must be a plugin input.
+        TLLM_CHECK_WITH_INFO(mKVCacheQuantMode.hasFp8Qdq(),
+            "FP8 FMHA requires the FP8 output projection (FP8 QDQ quantization) to provide the output scale.");
     }
 
     TLLM_CHECK(isRoPE() == (rotary_embedding_dim != 0));
@@ -622,8 +646,9 @@ size_t GPTAttentionPluginCommon::getWorkspaceSizeForContext(nvinfer1::DataType t
     size_t const fmha_scheduler_counter = mEnableContextFMHA ? sizeof(uint32_t) : 0;
     size_t const fmha_bmm1_scale_size = mFP8ContextFMHA ? sizeof(float) * 2 : 0;
     size_t const fmha_bmm2_scale_size = mFP8ContextFMHA ? sizeof(float) : 0;
+    size_t const rotary_mscale_size = isRoPE() ? sizeof(float) * batch_size : 0;
 
-    int const NUM_BUFFERS = 18;
+    int const NUM_BUFFERS = 19;
     size_t workspaces[NUM_BUFFERS];
     workspaces[0] = CUBLAS_WORKSPACE_SIZE;
     workspaces[1] = attention_mask_size;
@@ -643,6 +668,7 @@ size_t GPTAttentionPluginCommon::getWorkspaceSizeForContext(nvinfer1::DataType t
     workspaces[15] = fmha_scheduler_counter;
     workspaces[16] = fmha_bmm1_scale_size;
     workspaces[17] = fmha_bmm2_scale_size;
+    workspaces[18] = rotary_mscale_size;
     context_workspace_size = tc::calculateTotalWorkspaceSize(workspaces, NUM_BUFFERS);
 
     return context_workspace_size;
@@ -669,13 +695,22 @@ size_t GPTAttentionPluginCommon::getWorkspaceSizeForGeneration(
     size_t const shift_k_cache_size = (!mPosShiftEnabled || isCrossAttention())
         ? 0
         : size * batch_beam * mNumHeads * mHeadSize * max_attention_window;
-
-    int const NUM_BUFFERS = 4;
+    // Per-request rotary scaling, the long factors of LongRoPE are only known at runtime.
+    bool const per_request_rotary_scaling = isRoPE();
+    size_t const rotary_cu_seqlens_size = per_request_rotary_scaling ? sizeof(int) * (batch_beam + 1) : 0;
+    size_t const rotary_inv_freq_size
+        = per_request_rotary_scaling ? sizeof(float) * batch_beam * mRotaryEmbeddingDim / 2 : 0;
+    size_t const rotary_mscale_size = per_request_rotary_scaling ? sizeof(float) * batch_beam : 0;
+
+    int const NUM_BUFFERS = 7;
     size_t workspaces[NUM_BUFFERS];
     workspaces[0] = partial_out_size;
     workspaces[1] = partial_sum_size;
     workspaces[2] = partial_max_size;
     workspaces[3] = shift_k_cache_size;
+    workspaces[4] = rotary_cu_seqlens_size;
+    workspaces[5] = rotary_inv_freq_size;
+    workspaces[6] = rotary_mscale_size;
     generation_workspace_size = tc::calculateTotalWorkspaceSize(workspaces, NUM_BUFFERS);
 
     size_t mqa_workspace_size = 0;
@@ -691,7 +726,59 @@ size_t GPTAttentionPluginCommon::getWorkspaceSizeForGeneration(
         mqa_workspace_size = tc::calculateTotalWorkspaceSize(mqa_workspaces, XQA_NUM_BUFFERS);
     }
 
-    return std::max(generation_workspace_size, mqa_workspace_size);
+    size_t cascade_workspace_size = 0;
+    if (mPagedKVCache && tc::getEnvCascadeAttentionMinPrefixBlocks())
+    {
+        int const CASCADE_NUM_BUFFERS = 5;
+        size_t cascade_workspaces[CASCADE_NUM_BUFFERS];
+        cascade_workspaces[0] = size * batch_beam * local_hidden_units_qo;
+        cascade_workspaces[1] = sizeof(int) * (batch_beam + 1);
+        cascade_workspaces[2] = sizeof(float) * batch_beam * mRotaryEmbeddingDim / 2;
+        cascade_workspaces[3] = sizeof(int32_t) * (4 * batch_beam + 1);
+        cascade_workspaces[4]
+            = getCascadeAttentionWorkspaceSize(batch_beam, mNumHeads, getHeadSize(), kCascadeAttentionMaxSplits);
+        cascade_workspace_size = tc::calculateTotalWorkspaceSize(cascade_workspaces, CASCADE_NUM_BUFFERS);
+    }
+
+    size_t gqa_workspace_size = 0;
+    if (mNumHeads > mNumKVHeads && !tc::getEnvDisableGqaGenerationAttention())
+    {
+        int const GQA_NUM_BUFFERS = 4;
+        size_t gqa_workspaces[GQA_NUM_BUFFERS];
+        gqa_workspaces[0] = size * batch_beam * local_hidden_units_qo;
+        gqa_workspaces[1] = sizeof(int) * (batch_beam + 1);
+        gqa_workspaces[2] = sizeof(float) * batch_beam * mRotaryEmbeddingDim / 2;
+        gqa_workspaces[3] = getGqaGenerationAttentionWorkspaceSize(
+            batch_beam, mNumHeads, getHeadSize(), kGqaGenerationAttentionMaxSplits);
+        gqa_workspace_size = tc::calculateTotalWorkspaceSize(gqa_workspaces, GQA_NUM_BUFFERS);
+    }
+
+    size_t int4_kv_cache_workspace_size = 0;
+    if (mKVCacheQuantMode.hasInt4KvCache())
+    {
+        int const INT4_KV_CACHE_NUM_BUFFERS = 4;
+        size_t int4_kv_cache_workspaces[INT4_KV_CACHE_NUM_BUFFERS];
+        int4_kv_cache_workspaces[0] = size * batch_beam * local_hidden_units_qo;
+        int4_kv_cache_workspaces[1] = sizeof(int) * (batch_beam + 1);
+        int4_kv_cache_workspaces[2] = sizeof(int) * (batch_beam + 1);
+        int4_kv_cache_workspaces[3] = sizeof(float) * batch_beam * mRotaryEmbeddingDim / 2;
+        int4_kv_cache_workspace_size
+            = tc::calculateTotalWorkspaceSize(int4_kv_cache_workspaces, INT4_KV_CACHE_NUM_BUFFERS);
+    }
+
+    return std::max({generation_workspace_size, mqa_workspace_size, cascade_workspace_size, gqa_workspace_size,
+        int4_kv_cache_workspace_size});
+}
+
+size_t GPTAttentionPluginCommon::getKvCacheSizePerToken(size_t elemSize) const
+{
+    int const head_size = getHeadSize();
+    if (mKVCacheQuantMode.hasInt4KvCache())
+    {
+        // The group scales are stored next to the packed values of each head.
+        return static_cast<size_t>(mNumKVHeads) * getInt4KvCacheRowBytes(head_size);
+    }
+    return static_cast<size_t>(mNumKVHeads) * head_size * elemSize;
 }
 
 int GPTAttentionPluginCommon::getMaxNumSeqLenTile(int batch_beam_size) const
@@ -720,8 +807,7 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
     bool const has_ia3 = false;
 
     KVCacheBuffer kv_cache_buffer;
-    auto const elemSize = mKVCacheQuantMode.hasKvCacheQuant() ? sizeof(int8_t) : sizeof(T);
-    auto const sizePerToken = num_kv_heads * head_size * elemSize;
+    auto const sizePerToken = getKvCacheSizePerToken(mKVCacheQuantMode.hasKvCacheQuant() ? sizeof(int8_t) : sizeof(T));
     KVBlockArray::DataType* hostKvCacheBlockOffsets = nullptr;
     if (useKVCache())
     {
@@ -808,6 +894,8 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
     size_t const fmha_scheduler_counter = mEnableContextFMHA ? sizeof(uint32_t) : 0;
     size_t const fmha_bmm1_scale_size = mFP8ContextFMHA ? sizeof(float) * 2 : 0;
     size_t const fmha_bmm2_scale_size = mFP8ContextFMHA ? sizeof(float) : 0;
+    bool const per_request_rotary_scaling = usePerRequestRotaryScaling(params.rotary_long_inv_freq);
+    size_t const rotary_mscale_size = per_request_rotary_scaling ? sizeof(float) * params.batch_size : 0;
 
     bool const is_qk_buf_float_ = true;
 
@@ -841,6 +929,9 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
         = reinterpret_cast<float*>(nextWorkspacePtr(workspace_byte_ptr, offset, fmha_bmm1_scale_size));
     float* fmha_bmm2_scale_ptr
         = reinterpret_cast<float*>(nextWorkspacePtr(workspace_byte_ptr, offset, fmha_bmm2_scale_size));
+    float* rotary_mscale_buf = per_request_rotary_scaling
+        ? reinterpret_cast<float*>(nextWorkspacePtr(workspace_byte_ptr, offset, rotary_mscale_size))
+        : nullptr;
 
     // build attention_mask, cu_seqlens, and padding_offset tensors
     // Note: self attn and cross attn should use different params
@@ -883,6 +974,12 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
     // This is pre-computed when building the engines.
     decoder_params.rotaryEmbeddingInvFreqCache = params.rotary_inv_freq;
     decoder_params.rotaryEmbeddingMaxPositions = mRotaryEmbeddingMaxPositions;
+    // Per-request scaling picks the frequencies and magnitude scale of each sequence from its length.
+    decoder_params.rotaryEmbeddingLongInvFreqCache = params.rotary_long_inv_freq;
+    decoder_params.rotaryEmbeddingShortMscale = mRotaryEmbeddingShortMscale;
+    decoder_params.rotaryEmbeddingLongMscale = mRotaryEmbeddingLongMscale;
+    decoder_params.rotaryEmbeddingOriginalMaxPositions = mRotaryEmbeddingOriginalMaxPositions;
+    decoder_params.rotaryEmbeddingMscale = rotary_mscale_buf;
     invokeBuildDecoderInfo(decoder_params, stream);
     sync_check_cuda_error();
 
@@ -920,9 +1017,10 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
         cudaMemsetAsync(params.context_buf, 0, params.num_tokens * local_hidden_units_qo * sizeof(T), stream);
     }
 
-    KvCacheDataType const cache_type = mKVCacheQuantMode.hasInt8KvCache()
-        ? KvCacheDataType::INT8
-        : (mKVCacheQuantMode.hasFp8KvCache() ? KvCacheDataType::FP8 : KvCacheDataType::BASE);
+    KvCacheDataType const cache_type = mKVCacheQuantMode.hasInt8KvCache() ? KvCacheDataType::INT8
+        : mKVCacheQuantMode.hasFp8KvCache()                                 ? KvCacheDataType::FP8
+        : mKVCacheQuantMode.hasInt4KvCache()                                ? KvCacheDataType::INT4
+                                                                            : KvCacheDataType::BASE;
 
     cudaDataType_t const gemm_data_type = tc::CudaDataType<T>::value;
     int const attention_seq_len_1 = params.input_seq_length;                                                // q length
@@ -943,10 +1041,13 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
     if (mEnableContextFMHA)
     {
         bool const enablePagedKVContextFMHA = mPagedKVCache && mPagedContextFMHA;
-        TLLM_CHECK_WITH_INFO(!(mKVCacheQuantMode.hasInt8KvCache() && enablePagedKVContextFMHA),
-            "Paged Context FMHA doesn't work with int8 kv cache currently.");
+        // The generic paged kv fmha kernels dequantize int8/fp8 kv caches on the fly.
+        bool const genericPagedKVContextFMHA = enablePagedKVContextFMHA && mFMHARunner->isGenericPagedKvFmha();
         TLLM_CHECK_WITH_INFO(
-            !(mKVCacheQuantMode.hasFp8KvCache() && !mKVCacheQuantMode.hasFp8Qdq() && enablePagedKVContextFMHA),
+            !(mKVCacheQuantMode.hasInt8KvCache() && enablePagedKVContextFMHA && !genericPagedKVContextFMHA),
+            "Paged Context FMHA doesn't work with int8 kv cache currently.");
+        TLLM_CHECK_WITH_INFO(!(mKVCacheQuantMode.hasFp8KvCache() && !mKVCacheQuantMode.hasFp8Qdq()
+                                 && enablePagedKVContextFMHA && !genericPagedKVContextFMHA),
             "FP8 Paged Context FMHA only works with fp8 quantization workflow currently.");
         TLLM_CHECK_WITH_INFO(!(params.sink_token_length > 0 && enablePagedKVContextFMHA),
             "Cannot support StreamingLLM now when enabling paged KV context FMHA.");
@@ -964,6 +1065,7 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
         preprocessingParams.rotary_embedding_inv_freq = rotary_inv_freq_buf;
         preprocessingParams.rotary_coef_cache_buffer = params.rotary_cos_sin;
         preprocessingParams.kvScaleOrigQuant = params.kv_scale_orig_quant;
+        preprocessingParams.kv_cache_amax = params.kv_cache_amax;
         preprocessingParams.spec_decoding_position_offsets = nullptr;
 
         // Scalars
@@ -992,6 +1094,7 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
 
         preprocessingParams.rotary_vision_start = mVisionStart;
         preprocessingParams.rotary_vision_length = mVisionLength;
+        preprocessingParams.rotary_embedding_mscale = rotary_mscale_buf;
 
         {
             std::string const beforeRopeStr = "ctx attention before RoPE at layer " + std::to_string(mLayerIdx);
@@ -1046,6 +1149,8 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
         fmhaParams.qPtr = reinterpret_cast<void const*>(q_buf_2_);
         // TODO: add contiguous kv buffer (cross-attention).
         fmhaParams.kvPtr = nullptr;
+        // FP8 FMHA writes the FP8 input of the output projection directly: the attention output quantization scale
+        // is folded into scaleBmm2 by invokeBuildDecoderInfo, so no requantization pass follows.
         fmhaParams.outputPtr = params.context_buf;
         fmhaParams.packedMaskPtr = params.fmha_custom_mask;
         fmhaParams.pagedKvCache = reinterpret_cast<KVBlockArray&>(kv_cache_buffer);
@@ -1055,6 +1160,7 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
         fmhaParams.tileCounterPtr = fmha_tile_counter_ptr;
         fmhaParams.scaleBmm1Ptr = fmha_bmm1_scale_ptr;
         fmhaParams.scaleBmm2Ptr = fmha_bmm2_scale_ptr;
+        fmhaParams.kvScaleQuantOrigPtr = params.kv_scale_quant_orig;
         fmhaParams.stream = stream;
         fmhaParams.forceFp32Acc = mFMHAForceFP32Acc;
 
@@ -1064,6 +1170,8 @@ int GPTAttentionPluginCommon::enqueueContext(EnqueueContextParams<T, KVCacheBuff
     }
     else
     {
+        TLLM_CHECK_WITH_INFO(
+            !per_request_rotary_scaling, "Per-request rotary scaling (YaRN, LongRoPE) requires context FMHA.");
         // FIXME: a temporary solution to make sure the padding part of key/value buffer is 0
         // NOTE: pointer subtraction is used below since there could be some extra gap due to alignment.
         //  Otherwise, we could do cudaMemsetAsync(k_buf_2_, 0, k_buf_2_size + v_buf_2_size, stream);
@@ -1354,6 +1462,349 @@ template int GPTAttentionPluginCommon::enqueueContext<__nv_bfloat16, KVBlockArra
 
 bool GPTAttentionPluginCommon::mForceMultiBlockWarned = false;
 
+template <typename T>
+bool GPTAttentionPluginCommon::enqueueCascadeGeneration(
+    EnqueueGenerationParams<T, KVBlockArray> const& params, KVBlockArray const& kv_cache_buffer, cudaStream_t stream)
+{
+    auto const min_prefix_blocks = tc::getEnvCascadeAttentionMinPrefixBlocks();
+    int const head_size = getHeadSize();
+    bool const supported = min_prefix_blocks && params.host_block_offsets != nullptr && params.beam_width == 1
+        && params.input_seq_length == 1 && params.sink_token_length == 0 && !mCrossAttention
+        && !mKVCacheQuantMode.hasKvCacheQuant() && !mFP8ContextFMHA && !mPosShiftEnabled && !mUnfuseQkvGemm
+        && !isALiBi() && !isRelativePosition() && mQKTanhScale == 0.f && mMaskType != AttentionMaskType::BLOCKSPARSE
+        && head_size % 32 == 0 && head_size <= 256 && !usePerRequestRotaryScaling(params.rotary_long_inv_freq);
+    if (!supported)
+    {
+        return false;
+    }
+
+    int32_t const batch_beam = params.num_requests;
+    // host_past_key_value_lengths does not count the current token.
+    std::vector<int32_t> host_sequence_lengths(
+        params.host_past_key_value_lengths, params.host_past_key_value_lengths + batch_beam);
+    for (auto& length : host_sequence_lengths)
+    {
+        ++length;
+        if (length > params.cyclic_attention_window_size)
+        {
+            // The cascade kernels do not wrap around the cyclic KV cache.
+            return false;
+        }
+    }
+    auto const groups = buildCascadePrefixGroups(params.host_block_offsets, host_sequence_lengths.data(), batch_beam,
+        params.max_blocks_per_sequence, mTokensPerBlock, params.cyclic_attention_window_size, *min_prefix_blocks);
+    if (groups.getNumGroups() == 0)
+    {
+        return false;
+    }
+    TLLM_LOG_DEBUG("Cascade attention is selected for %d prefix groups.", groups.getNumGroups());
+
+    int8_t* workspace_byte_ptr = reinterpret_cast<int8_t*>(params.workspace);
+    size_t offset = 0;
+    T* q_buf = reinterpret_cast<T*>(
+        nextWorkspacePtr(workspace_byte_ptr, offset, sizeof(T) * batch_beam * mNumHeads * head_size));
+    int* cu_seqlens
+        = reinterpret_cast<int*>(nextWorkspacePtr(workspace_byte_ptr, offset, sizeof(int) * (batch_beam + 1)));
+    float* rotary_inv_freq_buf = reinterpret_cast<float*>(
+        nextWorkspacePtr(workspace_byte_ptr, offset, sizeof(float) * batch_beam * mRotaryEmbeddingDim / 2));
+    int32_t* packed_groups = reinterpret_cast<int32_t*>(
+        nextWorkspacePtr(workspace_byte_ptr, offset, sizeof(int32_t) * (4 * batch_beam + 1)));
+    void* states = nextWorkspacePtr(workspace_byte_ptr, offset,
+        getCascadeAttentionWorkspaceSize(batch_beam, mNumHeads, head_size, kCascadeAttentionMaxSplits));
+
+    auto const host_packed_groups = groups.pack();
+    TLLM_CUDA_CHECK(cudaMemcpyAsync(packed_groups, host_packed_groups.data(),
+        host_packed_groups.size() * sizeof(int32_t), cudaMemcpyHostToDevice, stream));
+
+    // Rotary embedding inv_freq buffer, as in the XQA path.
+    BuildDecoderInfoParams<T> decoder_params;
+    memset(&decoder_params, 0, sizeof(decoder_params));
+    decoder_params.seqQOffsets = cu_seqlens;
+    decoder_params.seqKVLengths = params.sequence_lengths;
+    decoder_params.batchSize = batch_beam;
+    decoder_params.maxQSeqLength = 1;
+    decoder_params.rotaryEmbeddingScale = mRotaryEmbeddingScale;
+    decoder_params.rotaryEmbeddingBase = mRotaryEmbeddingBase;
+    decoder_params.rotaryEmbeddingDim = mRotaryEmbeddingDim;
+    decoder_params.rotaryScalingType = mRotaryEmbeddingScaleType;
+    decoder_params.rotaryEmbeddingInvFreq = rotary_inv_freq_buf;
+    decoder_params.rotaryEmbeddingInvFreqCache = params.rotary_inv_freq;
+    decoder_params.rotaryEmbeddingMaxPositions = mRotaryEmbeddingMaxPositions;
+    invokeBuildDecoderInfo(decoder_params, stream);
+    sync_check_cuda_error();
+
+    // Append K/V of the current token to the cache and apply the position embedding to Q.
+    QKVPreprocessingParams<T, KVBlockArray> preprocessing_params;
+    preprocessing_params.QKV = const_cast<T*>(params.attention_input);
+    preprocessing_params.Q = q_buf;
+    preprocessing_params.kv_cache_buffer = kv_cache_buffer;
+    preprocessing_params.qkv_bias = params.qkv_bias;
+    preprocessing_params.cache_seq_lens = params.sequence_lengths;
+    preprocessing_params.rotary_embedding_inv_freq = rotary_inv_freq_buf;
+    preprocessing_params.kvScaleOrigQuant = params.kv_scale_orig_quant;
+    preprocessing_params.batch_size = batch_beam;
+    preprocessing_params.max_input_seq_len = 1;
+    preprocessing_params.max_kv_seq_len = params.max_past_kv_length;
+    preprocessing_params.cyclic_kv_cache_len = params.cyclic_attention_window_size;
+    preprocessing_params.sink_token_len = params.sink_token_length;
+    preprocessing_params.token_num = batch_beam;
+    preprocessing_params.remove_padding = true;
+    preprocessing_params.head_num = mNumHeads;
+    preprocessing_params.kv_head_num = mNumKVHeads;
+    preprocessing_params.qheads_per_kv_head = mNumHeads / mNumKVHeads;
+    preprocessing_params.size_per_head = head_size;
+    preprocessing_params.rotary_embedding_dim = mRotaryEmbeddingDim;
+    preprocessing_params.rotary_embedding_base = mRotaryEmbeddingBase;
+    preprocessing_params.rotary_scale_type = mRotaryEmbeddingScaleType;
+    preprocessing_params.rotary_embedding_scale = mRotaryEmbeddingScale;
+    preprocessing_params.rotary_embedding_max_positions = mRotaryEmbeddingMaxPositions;
+    preprocessing_params.position_embedding_type = mPositionEmbeddingType;
+    preprocessing_params.position_shift_enabled = mPosShiftEnabled;
+    preprocessing_params.cache_type = KvCacheDataType::BASE;
+    preprocessing_params.enable_paged_kv_fmha = true;
+    preprocessing_params.multi_processor_count = mMultiProcessorCount;
+    preprocessing_params.rotary_vision_start = mVisionStart;
+    preprocessing_params.rotary_vision_length = mVisionLength;
+    preprocessing_params.setCommonParameters();
+    invokeQKVPreprocessing<T, KVBlockArray>(preprocessing_params, stream);
+    sync_check_cuda_error();
+
+    CascadeAttentionParams<T> cascade_params;
+    cascade_params.q = q_buf;
+    cascade_params.out = static_cast<T*>(params.context_buf);
+    cascade_params.kvCache = kv_cache_buffer;
+    cascade_params.sequenceLengths = params.sequence_lengths;
+    cascade_params.setPrefixGroups(groups, packed_groups);
+    cascade_params.workspace = states;
+    cascade_params.batchSize = batch_beam;
+    cascade_params.numHeads = mNumHeads;
+    cascade_params.numKvHeads = mNumKVHeads;
+    cascade_params.headSize = head_size;
+    // Enough splits for one wave of prefix CTAs.
+    auto const num_splits = tc::divUp(mMultiProcessorCount, groups.getNumGroups() * mNumKVHeads);
+    cascade_params.numSplits = std::clamp(static_cast<int32_t>(num_splits), 1, kCascadeAttentionMaxSplits);
+    cascade_params.qkScale = 1.f / (std::sqrt(static_cast<float>(head_size)) * mQScaling);
+    invokeCascadeAttention(cascade_params, stream);
+    return true;
+}
+
+template <typename T, typename KVCacheBuffer>
+bool GPTAttentionPluginCommon::enqueueGqaGeneration(
+    EnqueueGenerationParams<T, KVCacheBuffer> const& params, KVCacheBuffer const& kv_cache_buffer, cudaStream_t stream)
+{
+    if constexpr (std::is_same_v<T, float>)
+    {
+        return false;
+    }
+    else
+    {
+        int const head_size = getHeadSize();
+        bool const supported = mNumHeads > mNumKVHeads && !tc::getEnvDisableGqaGenerationAttention()
+            && isGqaGenerationAttentionSupported(mSM, head_size) && params.beam_width == 1
+            && params.input_seq_length == 1 && params.sink_token_length == 0 && !mCrossAttention
+            && !mKVCacheQuantMode.hasKvCacheQuant() && !mFP8ContextFMHA && !mPosShiftEnabled && !mUnfuseQkvGemm
+            && !isALiBi() && !isRelativePosition() && mQKTanhScale == 0.f
+            && mMaskType != AttentionMaskType::BLOCKSPARSE && !usePerRequestRotaryScaling(params.rotary_long_inv_freq);
+        if (!supported)
+        {
+            return false;
+        }
+        TLLM_LOG_DEBUG("GQA generation attention kernels are selected in the generation phase.");
+
+        int32_t const batch_beam = params.num_requests;
+        int8_t* workspace_byte_ptr = reinterpret_cast<int8_t*>(params.workspace);
+        size_t offset = 0;
+        T* q_buf = reinterpret_cast<T*>(
+            nextWorkspacePtr(workspace_byte_ptr, offset, sizeof(T) * batch_beam * mNumHeads * head_size));
+        int* cu_seqlens
+            = reinterpret_cast<int*>(nextWorkspacePtr(workspace_byte_ptr, offset, sizeof(int) * (batch_beam + 1)));
+        float* rotary_inv_freq_buf = reinterpret_cast<float*>(
+            nextWorkspacePtr(workspace_byte_ptr, offset, sizeof(float) * batch_beam * mRotaryEmbeddingDim / 2));
+        void* states = nextWorkspacePtr(workspace_byte_ptr, offset,
+            getGqaGenerationAttentionWorkspaceSize(batch_beam, mNumHeads, head_size, kGqaGenerationAttentionMaxSplits));
+
+        // Rotary embedding inv_freq buffer, as in the XQA path.
+        BuildDecoderInfoParams<T> decoder_params;
+        memset(&decoder_params, 0, sizeof(decoder_params));
+        decoder_params.seqQOffsets = cu_seqlens;
+        decoder_params.seqKVLengths = params.sequence_lengths;
+        decoder_params.batchSize = batch_beam;
+        decoder_params.maxQSeqLength = 1;
+        decoder_params.rotaryEmbeddingScale = mRotaryEmbeddingScale;
+        decoder_params.rotaryEmbeddingBase = mRotaryEmbeddingBase;
+        decoder_params.rotaryEmbeddingDim = mRotaryEmbeddingDim;
+        decoder_params.rotaryScalingType = mRotaryEmbeddingScaleType;
+        decoder_params.rotaryEmbeddingInvFreq = rotary_inv_freq_buf;
+        decoder_params.rotaryEmbeddingInvFreqCache = params.rotary_inv_freq;
+        decoder_params.rotaryEmbeddingMaxPositions = mRotaryEmbeddingMaxPositions;
+        invokeBuildDecoderInfo(decoder_params, stream);
+        sync_check_cuda_error();
+
+        // Append K/V of the current token to the cache and apply the position embedding to Q.
+        QKVPreprocessingParams<T, KVCacheBuffer> preprocessing_params;
+        preprocessing_params.QKV = const_cast<T*>(params.attention_input);
+        preprocessing_params.Q = q_buf;
+        preprocessing_params.kv_cache_buffer = kv_cache_buffer;
+        preprocessing_params.qkv_bias = params.qkv_bias;
+        preprocessing_params.cache_seq_lens = params.sequence_lengths;
+        preprocessing_params.rotary_embedding_inv_freq = rotary_inv_freq_buf;
+        preprocessing_params.kvScaleOrigQuant = params.kv_scale_orig_quant;
+        preprocessing_params.batch_size = batch_beam;
+        preprocessing_params.max_input_seq_len = 1;
+        preprocessing_params.max_kv_seq_len = params.max_past_kv_length;
+        preprocessing_params.cyclic_kv_cache_len = params.cyclic_attention_window_size;
+        preprocessing_params.sink_token_len = params.sink_token_length;
+        preprocessing_params.token_num = batch_beam;
+        preprocessing_params.remove_padding = true;
+        preprocessing_params.head_num = mNumHeads;
+        preprocessing_params.kv_head_num = mNumKVHeads;
+        preprocessing_params.qheads_per_kv_head = mNumHeads / mNumKVHeads;
+        preprocessing_params.size_per_head = head_size;
+        preprocessing_params.rotary_embedding_dim = mRotaryEmbeddingDim;
+        preprocessing_params.rotary_embedding_base = mRotaryEmbeddingBase;
+        preprocessing_params.rotary_scale_type = mRotaryEmbeddingScaleType;
+        preprocessing_params.rotary_embedding_scale = mRotaryEmbeddingScale;
+        preprocessing_params.rotary_embedding_max_positions = mRotaryEmbeddingMaxPositions;
+        preprocessing_params.position_embedding_type = mPositionEmbeddingType;
+        preprocessing_params.position_shift_enabled = mPosShiftEnabled;
+        preprocessing_params.cache_type = KvCacheDataType::BASE;
+        preprocessing_params.enable_paged_kv_fmha = true;
+        preprocessing_params.multi_processor_count = mMultiProcessorCount;
+        preprocessing_params.rotary_vision_start = mVisionStart;
+        preprocessing_params.rotary_vision_length = mVisionLength;
+        preprocessing_params.setCommonParameters();
+        invokeQKVPreprocessing<T, KVCacheBuffer>(preprocessing_params, stream);
+        sync_check_cuda_error();
+
+        GqaGenerationAttentionParams<T, KVCacheBuffer> gqa_params;
+        gqa_params.q = q_buf;
+        gqa_params.out = static_cast<T*>(params.context_buf);
+        gqa_params.kvCache = kv_cache_buffer;
+        gqa_params.sequenceLengths = params.sequence_lengths;
+        gqa_params.workspace = states;
+        gqa_params.batchSize = batch_beam;
+        gqa_params.numHeads = mNumHeads;
+        gqa_params.numKvHeads = mNumKVHeads;
+        gqa_params.headSize = head_size;
+        gqa_params.attentionWindowSize = params.cyclic_attention_window_size;
+        // Enough splits for one wave of CTAs, with at least one tile of 16 tokens per warp in each split.
+        int32_t const max_kv_length = std::min(params.max_past_kv_length + 1, params.cyclic_attention_window_size);
+        auto const ctas_per_seq = mNumKVHeads * tc::divUp(mNumHeads / mNumKVHeads, 16);
+        auto const num_splits
+            = std::min(tc::divUp(mMultiProcessorCount, batch_beam * ctas_per_seq), tc::divUp(max_kv_length, 64));
+        gqa_params.numSplits = std::clamp(static_cast<int32_t>(num_splits), 1, kGqaGenerationAttentionMaxSplits);
+        gqa_params.qkScale = 1.f / (std::sqrt(static_cast<float>(head_size)) * mQScaling);
+        invokeGqaGenerationAttention(gqa_params, stream);
+        return true;
+    }
+}
+
+template <typename T>
+void GPTAttentionPluginCommon::enqueueInt4KvCacheGeneration(
+    EnqueueGenerationParams<T, KVBlockArray> const& params, KVBlockArray const& kv_cache_buffer, cudaStream_t stream)
+{
+    int const head_size = getHeadSize();
+    int32_t const batch_beam = params.num_requests;
+
+    int8_t* workspace_byte_ptr = reinterpret_cast<int8_t*>(params.workspace);
+    size_t offset = 0;
+    T* q_buf = reinterpret_cast<T*>(
+        nextWorkspacePtr(workspace_byte_ptr, offset, sizeof(T) * batch_beam * mNumHeads * head_size));
+    int* cu_q_seqlens
+        = reinterpret_cast<int*>(nextWorkspacePtr(workspace_byte_ptr, offset, sizeof(int) * (batch_beam + 1)));
+    int* cu_kv_seqlens
+        = reinterpret_cast<int*>(nextWorkspacePtr(workspace_byte_ptr, offset, sizeof(int) * (batch_beam + 1)));
+    float* rotary_inv_freq_buf = reinterpret_cast<float*>(
+        nextWorkspacePtr(workspace_byte_ptr, offset, sizeof(float) * batch_beam * mRotaryEmbeddingDim / 2));
+
+    BuildDecoderInfoParams<T> decoder_params;
+    memset(&decoder_params, 0, sizeof(decoder_params));
+    decoder_params.seqQOffsets = cu_q_seqlens;
+    decoder_params.seqKVOffsets = cu_kv_seqlens;
+    decoder_params.seqKVLengths = params.sequence_lengths;
+    decoder_params.batchSize = batch_beam;
+    decoder_params.maxQSeqLength = 1;
+    decoder_params.rotaryEmbeddingScale = mRotaryEmbeddingScale;
+    decoder_params.rotaryEmbeddingBase = mRotaryEmbeddingBase;
+    decoder_params.rotaryEmbeddingDim = mRotaryEmbeddingDim;
+    decoder_params.rotaryScalingType = mRotaryEmbeddingScaleType;
+    decoder_params.rotaryEmbeddingInvFreq = rotary_inv_freq_buf;
+    decoder_params.rotaryEmbeddingInvFreqCache = params.rotary_inv_freq;
+    decoder_params.rotaryEmbeddingMaxPositions = mRotaryEmbeddingMaxPositions;
+    invokeBuildDecoderInfo(decoder_params, stream);
+    sync_check_cuda_error();
+
+    // Quantize K/V of the current token into the cache and apply the position embedding to Q.
+    QKVPreprocessingParams<T, KVBlockArray> preprocessing_params;
+    preprocessing_params.QKV = const_cast<T*>(params.attention_input);
+    preprocessing_params.Q = q_buf;
+    preprocessing_params.kv_cache_buffer = kv_cache_buffer;
+    preprocessing_params.qkv_bias = params.qkv_bias;
+    preprocessing_params.cache_seq_lens = params.sequence_lengths;
+    preprocessing_params.rotary_embedding_inv_freq = rotary_inv_freq_buf;
+    preprocessing_params.batch_size = batch_beam;
+    preprocessing_params.max_input_seq_len = 1;
+    preprocessing_params.max_kv_seq_len = params.max_past_kv_length;
+    preprocessing_params.cyclic_kv_cache_len = params.cyclic_attention_window_size;
+    preprocessing_params.sink_token_len = params.sink_token_length;
+    preprocessing_params.token_num = batch_beam;
+    preprocessing_params.remove_padding = true;
+    preprocessing_params.head_num = mNumHeads;
+    preprocessing_params.kv_head_num = mNumKVHeads;
+    preprocessing_params.qheads_per_kv_head = mNumHeads / mNumKVHeads;
+    preprocessing_params.size_per_head = head_size;
+    preprocessing_params.rotary_embedding_dim = mRotaryEmbeddingDim;
+    preprocessing_params.rotary_embedding_base = mRotaryEmbeddingBase;
+    preprocessing_params.rotary_scale_type = mRotaryEmbeddingScaleType;
+    preprocessing_params.rotary_embedding_scale = mRotaryEmbeddingScale;
+    preprocessing_params.rotary_embedding_max_positions = mRotaryEmbeddingMaxPositions;
+    preprocessing_params.position_embedding_type = mPositionEmbeddingType;
+    preprocessing_params.position_shift_enabled = mPosShiftEnabled;
+    preprocessing_params.cache_type = KvCacheDataType::INT4;
+    preprocessing_params.enable_paged_kv_fmha = true;
+    preprocessing_params.multi_processor_count = mMultiProcessorCount;
+    preprocessing_params.rotary_vision_start = mVisionStart;
+    preprocessing_params.rotary_vision_length = mVisionLength;
+    preprocessing_params.setCommonParameters();
+    invokeQKVPreprocessing<T, KVBlockArray>(preprocessing_params, stream);
+    sync_check_cuda_error();
+
+    // Same order of scales and bias as the context phase.
+    float const inv_sqrt_scale = 1.f / (std::sqrt(static_cast<float>(head_size)) * mQScaling);
+    bool const scale_after_alibi = isALiBi() && isAliBiWithScale();
+    PagedKvFmhaParams fmha_params;
+    fmha_params.qPtr = q_buf;
+    fmha_params.outputPtr = params.context_buf;
+    fmha_params.pagedKvCache = kv_cache_buffer;
+    fmha_params.cuQSeqLens = cu_q_seqlens;
+    fmha_params.cuKvSeqLens = cu_kv_seqlens;
+    fmha_params.dataType = std::is_same_v<T, half> ? DATA_TYPE_FP16
+        : std::is_same_v<T, float>                 ? DATA_TYPE_FP32
+                                                   : DATA_TYPE_BF16;
+    fmha_params.kvCacheDataType = DATA_TYPE_INT4;
+    fmha_params.attentionMaskType = ContextAttentionMaskType::CAUSAL;
+    fmha_params.isSPadded = false;
+    fmha_params.b = batch_beam;
+    fmha_params.maxQSeqLen = 1;
+    fmha_params.numQHeads = mNumHeads;
+    fmha_params.numKvHeads = mNumKVHeads;
+    fmha_params.headSize = head_size;
+    fmha_params.slidingWindowSize = params.cyclic_attention_window_size;
+    fmha_params.scaleBmm1 = scale_after_alibi ? 1.f : inv_sqrt_scale;
+    fmha_params.qkTanhScale = mQKTanhScale;
+    if (mQKTanhScale != 0.f)
+    {
+        fmha_params.scaleBmm1 /= mQKTanhScale;
+    }
+    fmha_params.hasAlibi = isALiBi();
+    if (fmha_params.hasAlibi)
+    {
+        fmha_params.alibiParams = AlibiParams(
+            mNumHeads, params.max_past_kv_length + 1, mTpSize, mTpRank, scale_after_alibi ? inv_sqrt_scale : 1.f);
+    }
+    invokePagedKvFmha(fmha_params, stream);
+}
+
 template <typename T, typename KVCacheBuffer>
 int GPTAttentionPluginCommon::enqueueGeneration(
     EnqueueGenerationParams<T, KVCacheBuffer> const& params, cudaStream_t stream)
@@ -1383,8 +1834,7 @@ int GPTAttentionPluginCommon::enqueueGeneration(
     int32_t const batch_beam = params.beam_width * params.num_requests;
 
     KVCacheBuffer kv_cache_buffer;
-    auto const elemSize = mKVCacheQuantMode.hasKvCacheQuant() ? sizeof(int8_t) : sizeof(T);
-    auto const sizePerToken = num_kv_heads * head_size * elemSize;
+    auto const sizePerToken = getKvCacheSizePerToken(mKVCacheQuantMode.hasKvCacheQuant() ? sizeof(int8_t) : sizeof(T));
     if (useKVCache())
     {
         if constexpr (std::is_same_v<KVCacheBuffer, KVBlockArray>)
@@ -1424,6 +1874,23 @@ int GPTAttentionPluginCommon::enqueueGeneration(
         }
     }
 
+    if constexpr (std::is_same_v<KVCacheBuffer, KVBlockArray>)
+    {
+        if (mKVCacheQuantMode.hasInt4KvCache())
+        {
+            TLLM_CHECK_WITH_INFO(params.beam_width == 1 && params.input_seq_length == 1,
+                "INT4 kv cache does not support beam search or multiple query tokens in the generation phase.");
+            TLLM_CHECK_WITH_INFO(!usePerRequestRotaryScaling(params.rotary_long_inv_freq),
+                "INT4 kv cache does not support per-request rotary scaling (YaRN, LongRoPE).");
+            enqueueInt4KvCacheGeneration<T>(params, kv_cache_buffer, stream);
+            return 0;
+        }
+        if (enqueueCascadeGeneration<T>(params, kv_cache_buffer, stream))
+        {
+            return 0;
+        }
+    }
+
     // Try XQA optimization first.
     {
         // NOTE: input_seq_length = num_medusa_tokens + 1 (new generated one from the original LM head)
@@ -1444,6 +1911,11 @@ int GPTAttentionPluginCommon::enqueueGeneration(
         }
     }
 
+    if (enqueueGqaGeneration<T, KVCacheBuffer>(params, kv_cache_buffer, stream))
+    {
+        return 0;
+    }
+
     int timestep = params.max_past_kv_length;
     int const max_timesteps = mCrossAttention ? params.cyclic_attention_window_size
                                               : std::min(timestep, params.cyclic_attention_window_size);
@@ -1475,12 +1947,50 @@ int GPTAttentionPluginCommon::enqueueGeneration(
     size_t const shift_k_cache_size = (!mPosShiftEnabled || isCrossAttention())
         ? 0
         : sizeof(T) * batch_beam * mNumHeads * mHeadSize * params.max_attention_window;
+    bool const per_request_rotary_scaling = usePerRequestRotaryScaling(params.rotary_long_inv_freq);
+    TLLM_CHECK_WITH_INFO(!per_request_rotary_scaling || mPositionEmbeddingType != PositionEmbeddingType::kROPE_GPTJ,
+        "Per-request rotary scaling (YaRN, LongRoPE) requires GPT-NeoX style RoPE in the generation phase.");
+    size_t const rotary_cu_seqlens_size = per_request_rotary_scaling ? sizeof(int) * (batch_beam + 1) : 0;
+    size_t const rotary_inv_freq_size
+        = per_request_rotary_scaling ? sizeof(float) * batch_beam * mRotaryEmbeddingDim / 2 : 0;
+    size_t const rotary_mscale_size = per_request_rotary_scaling ? sizeof(float) * batch_beam : 0;
 
     // Workspace pointer shift
     T* partial_out = reinterpret_cast<T*>(nextWorkspacePtr(workspace_byte_ptr, offset, partial_out_size));
     float* partial_sum = reinterpret_cast<float*>(nextWorkspacePtr(workspace_byte_ptr, offset, partial_sum_size));
     float* partial_max = reinterpret_cast<float*>(nextWorkspacePtr(workspace_byte_ptr, offset, partial_max_size));
     T* shift_k_cache = reinterpret_cast<T*>(nextWorkspacePtr(workspace_byte_ptr, offset, shift_k_cache_size));
+    int* rotary_cu_seqlens
+        = reinterpret_cast<int*>(nextWorkspacePtr(workspace_byte_ptr, offset, rotary_cu_seqlens_size));
+    float* rotary_inv_freq_buf
+        = reinterpret_cast<float*>(nextWorkspacePtr(workspace_byte_ptr, offset, rotary_inv_freq_size));
+    float* rotary_mscale_buf
+        = reinterpret_cast<float*>(nextWorkspacePtr(workspace_byte_ptr, offset, rotary_mscale_size));
+
+    if (per_request_rotary_scaling)
+    {
+        // Pick the rotary frequencies and magnitude scale of each sequence from its current length.
+        BuildDecoderInfoParams<T> decoder_params;
+        memset(&decoder_params, 0, sizeof(decoder_params));
+        decoder_params.seqQOffsets = rotary_cu_seqlens;
+        decoder_params.seqKVLengths = params.sequence_lengths;
+        decoder_params.batchSize = batch_beam;
+        decoder_params.maxQSeqLength = params.input_seq_length;
+        decoder_params.rotaryEmbeddingScale = mRotaryEmbeddingScale;
+        decoder_params.rotaryEmbeddingBase = mRotaryEmbeddingBase;
+        decoder_params.rotaryEmbeddingDim = mRotaryEmbeddingDim;
+        decoder_params.rotaryScalingType = mRotaryEmbeddingScaleType;
+        decoder_params.rotaryEmbeddingInvFreq = rotary_inv_freq_buf;
+        decoder_params.rotaryEmbeddingInvFreqCache = params.rotary_inv_freq;
+        decoder_params.rotaryEmbeddingMaxPositions = mRotaryEmbeddingMaxPositions;
+        decoder_params.rotaryEmbeddingLongInvFreqCache = params.rotary_long_inv_freq;
+        decoder_params.rotaryEmbeddingShortMscale = mRotaryEmbeddingShortMscale;
+        decoder_params.rotaryEmbeddingLongMscale = mRotaryEmbeddingLongMscale;
+        decoder_params.rotaryEmbeddingOriginalMaxPositions = mRotaryEmbeddingOriginalMaxPositions;
+        decoder_params.rotaryEmbeddingMscale = rotary_mscale_buf;
+        invokeBuildDecoderInfo(decoder_params, stream);
+        sync_check_cuda_error();
+    }
 
     // Apply position embedding to the keys in the K cache
     KVLinearBuffer shift_k_cache_buffer;
@@ -1508,6 +2018,23 @@ int GPTAttentionPluginCommon::enqueueGeneration(
     dispatch_params.relative_attention_bias = relative_attention_bias;
     dispatch_params.relative_attention_bias_stride = relative_attention_bias_stride;
     dispatch_params.max_distance = max_distance;
+    if (useRelativeAttentionBiasPerDistance(relative_attention_bias, relative_attention_bias_stride))
+    {
+        // The per distance bias only depends on the bucketed table, so it is gathered once and reused by all the
+        // following steps instead of bucketing every key of every sequence in every step.
+        auto* bias_per_distance = reinterpret_cast<T*>(mRelAttnBiasPerDistance.get());
+        if (mRelAttnBiasPerDistanceTable != relative_attention_bias)
+        {
+            invokeBuildRelativeAttentionBiasPerDistance(
+                bias_per_distance, relative_attention_bias, mNumHeads, relative_attention_bias_stride, max_distance,
+                stream);
+            sync_check_cuda_error();
+            mRelAttnBiasPerDistanceTable = relative_attention_bias;
+        }
+        dispatch_params.relative_attention_bias = bias_per_distance;
+        dispatch_params.relative_attention_bias_stride = max_distance;
+        dispatch_params.relative_attention_bias_per_distance = true;
+    }
     dispatch_params.cache_indir = params.cache_indir;
     dispatch_params.context_buf = params.context_buf;
     dispatch_params.finished = finished;
@@ -1555,6 +2082,8 @@ int GPTAttentionPluginCommon::enqueueGeneration(
     dispatch_params.rotary_embedding_inv_freq_cache = params.rotary_inv_freq;
     dispatch_params.rotary_embedding_short_m_scale = mRotaryEmbeddingShortMscale;
     dispatch_params.rotary_embedding_long_m_scale = mRotaryEmbeddingLongMscale;
+    dispatch_params.rotary_embedding_inv_freq = per_request_rotary_scaling ? rotary_inv_freq_buf : nullptr;
+    dispatch_params.rotary_embedding_mscale = per_request_rotary_scaling ? rotary_mscale_buf : nullptr;
     dispatch_params.rotary_embedding_max_positions = mRotaryEmbeddingMaxPositions;
     dispatch_params.rotary_embedding_original_max_positions = mRotaryEmbeddingOriginalMaxPositions;
     dispatch_params.position_shift_enabled = mPosShiftEnabled;
@@ -1694,6 +2223,10 @@ int GPTAttentionPluginCommon::initialize() noexcept
         fmhaParams.scaleAlibi = isAliBiWithScale();
         fmhaParams.tpSize = mTpSize;
         fmhaParams.tpRank = mTpRank;
+        fmhaParams.kvCacheDataType = mKVCacheQuantMode.hasInt8KvCache() ? DATA_TYPE_INT8
+            : mKVCacheQuantMode.hasFp8KvCache()                          ? DATA_TYPE_E4M3
+            : mKVCacheQuantMode.hasInt4KvCache()                         ? DATA_TYPE_INT4
+                                                                         : data_type;
 
         // Load kernels from the pre-compiled cubins.
         mFMHARunner.reset(new FusedMHARunnerV2(fmhaParams));
@@ -1706,6 +2239,11 @@ int GPTAttentionPluginCommon::initialize() noexcept
             !useCustomMask() || mEnableContextFMHA, "Only Context FMHA supports custom mask input currently.");
     }
 
+    // Only the generic paged kv fmha kernels read INT4 kv caches.
+    TLLM_CHECK_WITH_INFO(!mKVCacheQuantMode.hasInt4KvCache()
+            || (mEnableContextFMHA && mPagedKVCache && mPagedContextFMHA && mFMHARunner->isGenericPagedKvFmha()),
+        "INT4 kv cache requires paged kv cache and paged context FMHA.");
+
     bool useXQAKernels = (mEnableXQA || mIsSpecDecodingEnabled) && !mCrossAttention
         && (mType == nvinfer1::DataType::kHALF || mType == nvinfer1::DataType::kBF16);
 
@@ -1740,6 +2278,15 @@ int GPTAttentionPluginCommon::initialize() noexcept
         reserveSemaphoreArray(mNbMultiBlockSemaphores);
     }
 
+    if (isRelativePosition() && mMaxDistance > 0 && !mCrossAttention)
+    {
+        // Self attention with implicit relative attention bias: [mNumHeads, mMaxDistance].
+        char* ptr;
+        deviceMalloc(&ptr, mNumHeads * mMaxDistance * tc::getDTypeSize(mType), false);
+        mRelAttnBiasPerDistance.reset(ptr);
+        mRelAttnBiasPerDistanceTable = nullptr;
+    }
+
     return 0;
 }
 
@@ -1844,6 +2391,43 @@ void GPTAttentionPluginCommon::reserveSemaphoreArray(int32_t size)
     mNbMultiBlockSemaphores = size;
 }
 
+float* GPTAttentionPluginCommon::applyKvCacheScaleCalibration(
+    bool isContext, float const*& kvScaleOrigQuant, float const*& kvScaleQuantOrig, cudaStream_t stream)
+{
+    auto const calibrationSteps = tc::getEnvKvCacheScaleCalibrationSteps();
+    bool const hasScaledKvCache = mKVCacheQuantMode.hasInt8KvCache() || mKVCacheQuantMode.hasFp8KvCache();
+    if (!calibrationSteps || !hasScaledKvCache || kvScaleOrigQuant == nullptr)
+    {
+        return nullptr;
+    }
+
+    if (mKvCacheCalibration == nullptr)
+    {
+        float* ptr;
+        TLLM_CUDA_CHECK(cudaMalloc(&ptr, (2 + 2 * mNumKVHeads) * sizeof(float)));
+        mKvCacheCalibration.reset(ptr);
+        TLLM_CUDA_CHECK(cudaMemcpyAsync(ptr, kvScaleOrigQuant, sizeof(float), cudaMemcpyDeviceToDevice, stream));
+        TLLM_CUDA_CHECK(cudaMemcpyAsync(ptr + 1, kvScaleQuantOrig, sizeof(float), cudaMemcpyDeviceToDevice, stream));
+        TLLM_CUDA_CHECK(cudaMemsetAsync(ptr + 2, 0, 2 * mNumKVHeads * sizeof(float), stream));
+    }
+    kvScaleOrigQuant = mKvCacheCalibration.get();
+    kvScaleQuantOrig = mKvCacheCalibration.get() + 1;
+    bool const calibrates = isContext && mKvCacheCalibrationSteps < *calibrationSteps;
+    return calibrates ? mKvCacheCalibration.get() + 2 : nullptr;
+}
+
+void GPTAttentionPluginCommon::updateKvCacheScaleCalibration(cudaStream_t stream)
+{
+    float const quantMax = mKVCacheQuantMode.hasFp8KvCache() ? 448.f : 127.f;
+    invokeUpdateKvCacheScales(
+        mKvCacheCalibration.get() + 2, mNumKVHeads, quantMax, mKvCacheCalibration.get(), stream);
+    if (++mKvCacheCalibrationSteps == tc::getEnvKvCacheScaleCalibrationSteps().value_or(0))
+    {
+        TLLM_LOG_INFO("Layer %d calibrated its kv cache scales over %d context steps.", mLayerIdx,
+            mKvCacheCalibrationSteps);
+    }
+}
+
 void GPTAttentionPluginCommon::debugCheckSemaphores(cudaStream_t stream)
 {
 #ifdef NDEBUG
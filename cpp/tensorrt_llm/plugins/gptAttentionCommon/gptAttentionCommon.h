@@ -135,6 +135,10 @@ protected:
         int32_t const* encoder_input_lengths = nullptr;
         int32_t num_encoder_tokens = 0;
         int64_t const* runtime_perf_knobs = nullptr;
+        // optional for LongRoPE, the inv_freq of the long factors (rotary_inv_freq holds the short ones).
+        float const* rotary_long_inv_freq = nullptr;
+        // optional for online kv cache scale calibration, the K/V amax per kv head the QKV preprocessing tracks.
+        float* kv_cache_amax = nullptr;
 
         std::string enqueueContextParamsToString() const
         {
@@ -180,6 +184,8 @@ protected:
             ss << "cross_qkv_length: " << cross_qkv_length << std::endl;
             ss << "encoder_input_lengths: " << encoder_input_lengths << std::endl;
             ss << "num_encoder_tokens: " << num_encoder_tokens << std::endl;
+            ss << "rotary_long_inv_freq: " << rotary_long_inv_freq << std::endl;
+            ss << "kv_cache_amax: " << kv_cache_amax << std::endl;
             return ss.str();
         }
     };
@@ -228,6 +234,10 @@ protected:
         // optional when cross attention
         int32_t const* encoder_input_lengths = nullptr;
         int32_t const* host_context_lengths = nullptr;
+        // optional when cascade attention is enabled, host copy of block_offsets.
+        kernels::KVBlockArray::DataType const* host_block_offsets = nullptr;
+        // optional for LongRoPE, the inv_freq of the long factors (rotary_inv_freq holds the short ones).
+        float const* rotary_long_inv_freq = nullptr;
         // optional when speculative decoding is used.
         bool const* spec_decoding_mask = nullptr;
         int32_t const* spec_decoding_packed_mask = nullptr;
@@ -242,6 +252,24 @@ protected:
     template <typename T, typename KVCacheBuffer>
     int enqueueGeneration(EnqueueGenerationParams<T, KVCacheBuffer> const& params, cudaStream_t stream);
 
+    // Runs cascade attention when sequences share KV cache prefix blocks. Returns false if it is not applicable.
+    template <typename T>
+    bool enqueueCascadeGeneration(EnqueueGenerationParams<T, kernels::KVBlockArray> const& params,
+        kernels::KVBlockArray const& kv_cache_buffer, cudaStream_t stream);
+
+    // Runs the tensor-core GQA kernels in place of the masked MHA kernels. Returns false if they are not applicable.
+    template <typename T, typename KVCacheBuffer>
+    bool enqueueGqaGeneration(EnqueueGenerationParams<T, KVCacheBuffer> const& params,
+        KVCacheBuffer const& kv_cache_buffer, cudaStream_t stream);
+
+    // Runs the generation phase of INT4 kv caches with the generic paged kv fmha kernels.
+    template <typename T>
+    void enqueueInt4KvCacheGeneration(EnqueueGenerationParams<T, kernels::KVBlockArray> const& params,
+        kernels::KVBlockArray const& kv_cache_buffer, cudaStream_t stream);
+
+    // Bytes of one token of the kv cache of one layer (K or V).
+    [[nodiscard]] size_t getKvCacheSizePerToken(size_t elemSize) const;
+
     // Called in configurePlugin().
     template <typename T, typename KVCacheBuffer>
     void prepareEnqueueGeneration(EnqueueGenerationParams<T, KVCacheBuffer> const& params);
@@ -278,6 +306,15 @@ protected:
         return mPositionEmbeddingType == tensorrt_llm::kernels::PositionEmbeddingType::kLONG_ROPE;
     }
 
+    // Whether each request gets rotary frequencies and a magnitude scale chosen from its length (YaRN, LongRoPE with
+    // long factors), see kernels/rotaryScalingUtils.h.
+    bool usePerRequestRotaryScaling(float const* rotary_long_inv_freq) const
+    {
+        return isRoPE()
+            && (mRotaryEmbeddingScaleType == tensorrt_llm::kernels::RotaryScalingType::kYARN
+                || rotary_long_inv_freq != nullptr);
+    }
+
     bool isCrossAttention() const
     {
         return mCrossAttention;
@@ -295,8 +332,26 @@ protected:
 
     void reserveSemaphoreArray(int32_t size);
 
+    //! Whether generation reads the implicit relative attention bias from the per distance cache instead of bucketing
+    //! on the fly. The cache needs max_distance > num_buckets / 2 so that all the farther distances share the last
+    //! bucket.
+    bool useRelativeAttentionBiasPerDistance(void const* relative_attention_table, int num_buckets) const
+    {
+        return mRelAttnBiasPerDistance != nullptr && relative_attention_table != nullptr && mMaxDistance > 0
+            && num_buckets / 2 < mMaxDistance;
+    }
+
     void debugCheckSemaphores(cudaStream_t stream);
 
+    //! Online calibration of the 8-bit kv cache scales, see getEnvKvCacheScaleCalibrationSteps. While enabled, the
+    //! scales of the engine are replaced by the calibrated ones, which start as a copy of them. Returns the buffer the
+    //! QKV preprocessing of a context step tracks the K/V amax into, nullptr when the step doesn't calibrate.
+    float* applyKvCacheScaleCalibration(
+        bool isContext, float const*& kvScaleOrigQuant, float const*& kvScaleQuantOrig, cudaStream_t stream);
+
+    //! Update the calibrated scales after a context step that tracked the amax.
+    void updateKvCacheScaleCalibration(cudaStream_t stream);
+
 protected:
     static constexpr int kReservedMaxSeqLenTilePerSeq = 64;
 
@@ -382,6 +437,16 @@ protected:
 
     UniqPtrWNullCopy<int32_t[], Deleter> mMultiBlockSemaphores = {};
 
+    // The calibrated kv cache scales, orig->quant then quant->orig, followed by the K/V amax of every kv head, and the
+    // number of context steps calibrated so far.
+    UniqPtrWNullCopy<float[], Deleter> mKvCacheCalibration = {};
+    int32_t mKvCacheCalibrationSteps = 0;
+
+    // The implicit relative attention bias of the generation phase gathered per distance, and the table it was
+    // gathered from. Rebuilt whenever the table changes.
+    UniqPtrWNullCopy<char[], Deleter> mRelAttnBiasPerDistance = {};
+    void const* mRelAttnBiasPerDistanceTable = nullptr;
+
     std::string toString() const
     {
         // member variables
@@ -25,6 +25,7 @@
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 #include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/layerwiseKvStreamer.h"
 #include "tensorrt_llm/runtime/utils/debugUtils.h"
 #include <algorithm>
 #include <cstdint>
@@ -462,6 +463,12 @@ int GPTAttentionPlugin::enqueueImpl(nvinfer1::PluginTensorDesc const* inputDesc,
         auto localNbTokens = contextTokenIdxEnd;
         enqueueSome<T, AttentionOutT, KVCacheBuffer>(seqIdxBeg, nbContextRequests, tokenIdxBeg, localNbTokens,
             inputDesc, outputDesc, inputs, outputs, workspace, stream);
+        // The KV cache of this layer is written, it can be sent while the next layers run
+        auto* streamer = tensorrt_llm::runtime::LayerwiseKvStreamer::getActive();
+        if (streamer != nullptr && useKVCache() && mLayerIdx < streamer->getNumLayers())
+        {
+            streamer->enqueueLayerReady(mLayerIdx, stream);
+        }
     }
 
     if (auto nbGenerationSeq = nbSeq - nbContextRequests; nbGenerationSeq > 0)
@@ -506,10 +513,18 @@ int GPTAttentionPlugin::enqueueSome(int32_t seqIdxBeg, int32_t localNbSeq, int32
     // Rotary inv_freq, cos_sin cache to avoid re-computing.
     float const* rotary_inv_freq = nullptr;
     float2 const* rotary_cos_sin = nullptr;
+    // LongRoPE engines may pass the short and long factors as rotary_inv_freq with shape [2, rotary_dim / 2].
+    float const* rotary_long_inv_freq = nullptr;
     if (isRoPE())
     {
         rotary_inv_freq = reinterpret_cast<float const*>(inputs[getIdx(IdxEntry::ROTARY_INV_FREQ)]);
         rotary_cos_sin = reinterpret_cast<float2 const*>(inputs[getIdx(IdxEntry::ROTARY_COS_SIN)]);
+        if (isLongRoPE()
+            && tensorrt_llm::runtime::ITensor::volume(inputDesc[getIdx(IdxEntry::ROTARY_INV_FREQ)].dims)
+                == mRotaryEmbeddingDim)
+        {
+            rotary_long_inv_freq = rotary_inv_freq + mRotaryEmbeddingDim / 2;
+        }
     }
 
     auto const reqTypeInBatchPtr = static_cast<RequestType const*>(inputs[getIdx(IdxEntry::REQUEST_TYPES)]) + seqIdxBeg;
@@ -597,6 +612,8 @@ int GPTAttentionPlugin::enqueueSome(int32_t seqIdxBeg, int32_t localNbSeq, int32
         kv_scale_orig_quant = reinterpret_cast<float const*>(inputs[getIdx(IdxEntry::KV_CACHE_QUANTIZATION_SCALE)]);
         kv_scale_quant_orig = reinterpret_cast<float const*>(inputs[getIdx(IdxEntry::KV_CACHE_DEQUANTIZATION_SCALE)]);
     }
+    float* const kv_cache_amax
+        = applyKvCacheScaleCalibration(is_context, kv_scale_orig_quant, kv_scale_quant_orig, stream);
 
     float const* attention_output_orig_quant = nullptr;
     if (mFP8ContextFMHA)
@@ -639,8 +656,7 @@ int GPTAttentionPlugin::enqueueSome(int32_t seqIdxBeg, int32_t localNbSeq, int32
             = static_cast<char* const*>(inputs[getIdx(IdxEntry::HOST_KV_CACHE_POOL_POINTERS)]);
 
         auto const cacheElemSize = (mKVCacheQuantMode.hasKvCacheQuant() ? 1 : sizeof(T));
-        auto const blockSize = mTokensPerBlock * mNumKVHeads * mHeadSize;
-        auto const bytesPerBlock = blockSize * cacheElemSize;
+        auto const bytesPerBlock = mTokensPerBlock * getKvCacheSizePerToken(cacheElemSize);
         auto const layerOffset = mLayerIdx * 2 * bytesPerBlock;
 
         host_primary_pool_pointer = reinterpret_cast<void*>(typed_host_pool_pointers[0] + layerOffset);
@@ -731,6 +747,8 @@ int GPTAttentionPlugin::enqueueSome(int32_t seqIdxBeg, int32_t localNbSeq, int32
             block_offsets, host_block_offsets, host_primary_pool_pointer, host_secondary_pool_pointer, batch_size,
             localNbTokens, max_blocks_per_sequence, workspace};
         enqueue_params.runtime_perf_knobs = runtime_perf_knobs;
+        enqueue_params.rotary_long_inv_freq = rotary_long_inv_freq;
+        enqueue_params.kv_cache_amax = kv_cache_amax;
         if (isRelativePosition())
         {
             enqueue_params.relative_attention_bias
@@ -748,6 +766,10 @@ int GPTAttentionPlugin::enqueueSome(int32_t seqIdxBeg, int32_t localNbSeq, int32
         }
 
         enqueueContext<T, KVCacheBuffer>(enqueue_params, stream);
+        if (kv_cache_amax != nullptr)
+        {
+            updateKvCacheScaleCalibration(stream);
+        }
 
         {
             std::string const afterContexStr = "ctx attention at layer " + std::to_string(mLayerIdx);
@@ -788,7 +810,9 @@ int GPTAttentionPlugin::enqueueSome(int32_t seqIdxBeg, int32_t localNbSeq, int32
             cyclic_attention_window_size, sink_token_length, num_requests, max_blocks_per_sequence, cache_indir,
             mMultiBlockSemaphores.get(), workspace, max_context_kv_len_list};
         enqueue_params.host_context_lengths = host_context_lengths;
+        enqueue_params.host_block_offsets = host_block_offsets;
         enqueue_params.runtime_perf_knobs = runtime_perf_knobs;
+        enqueue_params.rotary_long_inv_freq = rotary_long_inv_freq;
         if (isRelativePosition())
         {
             enqueue_params.relative_attention_bias
@@ -29,13 +29,19 @@ static char const* LAYERNORM_QUANTIZATION_PLUGIN_NAME{"LayernormQuantization"};
 PluginFieldCollection LayernormQuantizationPluginCreator::mFC{};
 std::vector<nvinfer1::PluginField> LayernormQuantizationPluginCreator::mPluginAttributes;
 
-LayernormQuantizationPlugin::LayernormQuantizationPlugin(
-    float eps, bool useDiffOfSquares, bool dynamicActivationScaling, nvinfer1::DataType type)
+LayernormQuantizationPlugin::LayernormQuantizationPlugin(float eps, bool useDiffOfSquares,
+    bool dynamicActivationScaling, nvinfer1::DataType type, nvinfer1::DataType outputType, bool residualEnabled,
+    bool preQuantScaleEnabled)
     : mEps(eps)
     , mUseDiffOfSquares(useDiffOfSquares)
     , mDynActScaling(dynamicActivationScaling)
     , mType(type)
+    , mOutputType(outputType)
+    , mResidualEnabled(residualEnabled)
+    , mPreQuantScaleEnabled(preQuantScaleEnabled)
 {
+    TLLM_CHECK_WITH_INFO(mOutputType == nvinfer1::DataType::kINT8 || mOutputType == nvinfer1::DataType::kFP8,
+        "Only int8 or fp8 output type is allowed.");
 }
 
 // Parameterized constructor
@@ -46,6 +52,13 @@ LayernormQuantizationPlugin::LayernormQuantizationPlugin(void const* data, size_
     read(d, mUseDiffOfSquares);
     read(d, mDynActScaling);
     read(d, mType);
+    // Engines built before the fp8 output and the fused residual do not serialize them
+    if (d != a + length)
+    {
+        read(d, mOutputType);
+        read(d, mResidualEnabled);
+        read(d, mPreQuantScaleEnabled);
+    }
     TLLM_CHECK_WITH_INFO(d == a + length,
         "Expected length (%d) != real length (%d). This is often "
         "caused by using different TensorRT-LLM version to build "
@@ -56,7 +69,8 @@ LayernormQuantizationPlugin::LayernormQuantizationPlugin(void const* data, size_
 // IPluginV2DynamicExt Methods
 nvinfer1::IPluginV2DynamicExt* LayernormQuantizationPlugin::clone() const noexcept
 {
-    auto* plugin = new LayernormQuantizationPlugin(mEps, mUseDiffOfSquares, mDynActScaling, mType);
+    auto* plugin = new LayernormQuantizationPlugin(
+        mEps, mUseDiffOfSquares, mDynActScaling, mType, mOutputType, mResidualEnabled, mPreQuantScaleEnabled);
     plugin->setPluginNamespace(mNamespace.c_str());
     return plugin;
 }
@@ -64,16 +78,16 @@ nvinfer1::IPluginV2DynamicExt* LayernormQuantizationPlugin::clone() const noexce
 nvinfer1::DimsExprs LayernormQuantizationPlugin::getOutputDimensions(
     int outputIndex, nvinfer1::DimsExprs const* inputs, int nbInputs, nvinfer1::IExprBuilder& exprBuilder) noexcept
 {
-    if (outputIndex == 0)
+    if (outputIndex == 0 || outputIndex == 1 + static_cast<int>(mDynActScaling))
     {
-        // Quantized output
-        return inputs[outputIndex];
+        // Quantized output, or the sum of input and residual
+        return inputs[0];
     }
 
     // Dynamic scaling output if enabled
     try
     {
-        TLLM_CHECK(outputIndex == 1);
+        TLLM_CHECK(outputIndex == 1 && mDynActScaling);
         DimsExprs ret;
         ret.nbDims = inputs[0].nbDims;
         for (int di = 0; di < ret.nbDims - 1; ++di)
@@ -93,26 +107,30 @@ nvinfer1::DimsExprs LayernormQuantizationPlugin::getOutputDimensions(
 bool LayernormQuantizationPlugin::supportsFormatCombination(
     int pos, nvinfer1::PluginTensorDesc const* inOut, int nbInputs, int nbOutputs) noexcept
 {
-    int const totalPoses = 6 + static_cast<int>(mDynActScaling);
-    TLLM_CHECK(0 <= pos && pos < totalPoses);
-    TLLM_CHECK(nbInputs == 4);
+    int const expectedNbInputs = 4 + static_cast<int>(mResidualEnabled) + static_cast<int>(mPreQuantScaleEnabled);
+    TLLM_CHECK(0 <= pos && pos < expectedNbInputs + getNbOutputs());
+    TLLM_CHECK(nbInputs == expectedNbInputs);
     if (pos < nbInputs)
     {
         switch (pos)
         {
-        case 0:
-        case 1:
-        case 2: return (inOut[pos].type == mType) && (inOut[pos].format == TensorFormat::kLINEAR);
         case 3: return (inOut[pos].type == nvinfer1::DataType::kFLOAT) && (inOut[pos].format == TensorFormat::kLINEAR);
+        // input, weight, bias, residual, pre_quant_scale
+        default: return (inOut[pos].type == mType) && (inOut[pos].format == TensorFormat::kLINEAR);
         }
     }
-    if (pos == 4)
+    if (pos == nbInputs)
     {
         // Quantized output
-        return (inOut[pos].type == nvinfer1::DataType::kINT8) && (inOut[pos].format == TensorFormat::kLINEAR);
+        return (inOut[pos].type == mOutputType) && (inOut[pos].format == TensorFormat::kLINEAR);
     }
-    // Dynamic scaling if enabled
-    return (inOut[pos].type == nvinfer1::DataType::kFLOAT) && (inOut[pos].format == TensorFormat::kLINEAR);
+    if (pos == nbInputs + 1 && mDynActScaling)
+    {
+        // Dynamic scaling if enabled
+        return (inOut[pos].type == nvinfer1::DataType::kFLOAT) && (inOut[pos].format == TensorFormat::kLINEAR);
+    }
+    // Sum of input and residual
+    return (inOut[pos].type == mType) && (inOut[pos].format == TensorFormat::kLINEAR);
 }
 
 void LayernormQuantizationPlugin::configurePlugin(nvinfer1::DynamicPluginTensorDesc const* in, int nbInputs,
@@ -126,6 +144,18 @@ size_t LayernormQuantizationPlugin::getWorkspaceSize(nvinfer1::PluginTensorDesc
     return 0;
 }
 
+template <typename T, typename QuantT>
+void LayernormQuantizationPlugin::dispatchDataType(void const* input, void const* gamma, void const* beta,
+    int const tokens, int const hidden_dim, cudaStream_t stream, void const* scale, void* dynamic_scale,
+    void* normed_output_quant, void const* residual, void* residual_out, void const* pre_quant_scale) noexcept
+{
+    invokeGeneralLayerNorm(static_cast<T*>(nullptr), reinterpret_cast<T const*>(input),
+        reinterpret_cast<T const*>(gamma), reinterpret_cast<T const*>(beta), mEps, tokens, hidden_dim, stream,
+        mUseDiffOfSquares, reinterpret_cast<float const*>(scale), reinterpret_cast<float*>(dynamic_scale),
+        reinterpret_cast<QuantT*>(normed_output_quant), reinterpret_cast<T const*>(residual),
+        reinterpret_cast<T*>(residual_out), reinterpret_cast<T const*>(pre_quant_scale));
+}
+
 int LayernormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
     nvinfer1::PluginTensorDesc const* outputDesc, void const* const* inputs, void* const* outputs, void* workspace,
     cudaStream_t stream) noexcept
@@ -135,9 +165,12 @@ int LayernormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* input
     //     weight [N, ]
     //     bias [N, ]
     //     scale_to_int [1]
+    //     residual [M(*), N] (optional)
+    //     pre_quant_scale [N, ] (optional)
     // outputs
     //     output [M(*), N]
     //     dynamic_scaling [M(*), 1] (optional output)
+    //     residual_out [M(*), N], input + residual (optional output)
 
     int64_t m64 = 1;
     for (int i = 0; i < inputDesc[0].dims.nbDims - 1; ++i)
@@ -147,36 +180,52 @@ int LayernormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* input
     int const m = TLLM_INT32_CAST(m64);
     int const n = TLLM_INT32_CAST(inputDesc[1].dims.d[0]);
 
-    float const* scale = reinterpret_cast<float const*>(inputs[3]);
-    int8_t* output = reinterpret_cast<int8_t*>(outputs[0]);
-    float* dynamic_scale = mDynActScaling ? reinterpret_cast<float*>(outputs[1]) : nullptr;
-
-    if (mType == DataType::kHALF)
+    void const* input = inputs[0];
+    void const* weight = inputs[1];
+    void const* bias = inputs[2];
+    void const* scale = inputs[3];
+    void const* residual = mResidualEnabled ? inputs[4] : nullptr;
+    void const* preQuantScale = mPreQuantScaleEnabled ? inputs[4 + static_cast<int>(mResidualEnabled)] : nullptr;
+    void* output = outputs[0];
+    void* dynamic_scale = mDynActScaling ? outputs[1] : nullptr;
+    void* residualOut = mResidualEnabled ? outputs[1 + static_cast<int>(mDynActScaling)] : nullptr;
+
+    if (mType == DataType::kHALF && mOutputType == DataType::kINT8)
+    {
+        dispatchDataType<half, int8_t>(input, weight, bias, m, n, stream, scale, dynamic_scale, output, residual,
+            residualOut, preQuantScale);
+    }
+    else if (mType == DataType::kFLOAT && mOutputType == DataType::kINT8)
+    {
+        dispatchDataType<float, int8_t>(input, weight, bias, m, n, stream, scale, dynamic_scale, output, residual,
+            residualOut, preQuantScale);
+    }
+#ifdef ENABLE_FP8
+    else if (mType == DataType::kHALF && mOutputType == DataType::kFP8)
     {
-        half const* input = reinterpret_cast<half const*>(inputs[0]);
-        half const* weight = reinterpret_cast<half const*>(inputs[1]);
-        half const* bias = reinterpret_cast<half const*>(inputs[2]);
-        invokeGeneralLayerNorm(
-            (half*) nullptr, input, weight, bias, mEps, m, n, stream, mUseDiffOfSquares, scale, dynamic_scale, output);
+        dispatchDataType<half, __nv_fp8_e4m3>(input, weight, bias, m, n, stream, scale, dynamic_scale, output,
+            residual, residualOut, preQuantScale);
     }
-    else if (mType == DataType::kFLOAT)
+    else if (mType == DataType::kFLOAT && mOutputType == DataType::kFP8)
     {
-        float const* input = reinterpret_cast<float const*>(inputs[0]);
-        float const* weight = reinterpret_cast<float const*>(inputs[1]);
-        float const* bias = reinterpret_cast<float const*>(inputs[2]);
-        invokeGeneralLayerNorm(
-            (float*) nullptr, input, weight, bias, mEps, m, n, stream, mUseDiffOfSquares, scale, dynamic_scale, output);
+        dispatchDataType<float, __nv_fp8_e4m3>(input, weight, bias, m, n, stream, scale, dynamic_scale, output,
+            residual, residualOut, preQuantScale);
     }
+#endif // ENABLE_FP8
 #ifdef ENABLE_BF16
-    else if (mType == DataType::kBF16)
+    else if (mType == DataType::kBF16 && mOutputType == DataType::kINT8)
     {
-        __nv_bfloat16 const* input = reinterpret_cast<__nv_bfloat16 const*>(inputs[0]);
-        __nv_bfloat16 const* weight = reinterpret_cast<__nv_bfloat16 const*>(inputs[1]);
-        __nv_bfloat16 const* bias = reinterpret_cast<__nv_bfloat16 const*>(inputs[2]);
-        invokeGeneralLayerNorm((__nv_bfloat16*) nullptr, input, weight, bias, mEps, m, n, stream, mUseDiffOfSquares,
-            scale, dynamic_scale, output);
+        dispatchDataType<__nv_bfloat16, int8_t>(input, weight, bias, m, n, stream, scale, dynamic_scale, output,
+            residual, residualOut, preQuantScale);
     }
-#endif
+#ifdef ENABLE_FP8
+    else if (mType == DataType::kBF16 && mOutputType == DataType::kFP8)
+    {
+        dispatchDataType<__nv_bfloat16, __nv_fp8_e4m3>(input, weight, bias, m, n, stream, scale, dynamic_scale,
+            output, residual, residualOut, preQuantScale);
+    }
+#endif // ENABLE_FP8
+#endif // ENABLE_BF16
 
     return 0;
 }
@@ -185,14 +234,19 @@ int LayernormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* input
 nvinfer1::DataType LayernormQuantizationPlugin::getOutputDataType(
     int index, nvinfer1::DataType const* inputTypes, int nbInputs) const noexcept
 {
-    assert((mDynActScaling && index < 2) || (!mDynActScaling && index == 0));
+    assert(index < getNbOutputs());
     if (index == 0)
     {
         // Output 0 quantized output of layer norm
-        return nvinfer1::DataType::kINT8;
+        return mOutputType;
+    }
+    if (index == 1 && mDynActScaling)
+    {
+        // Output 1 dynamic act scaling
+        return nvinfer1::DataType::kFLOAT;
     }
-    // Output 1 dynamic act scaling
-    return nvinfer1::DataType::kFLOAT;
+    // Last output, sum of input and residual
+    return mType;
 }
 
 // IPluginV2 Methods
@@ -209,7 +263,7 @@ char const* LayernormQuantizationPlugin::getPluginVersion() const noexcept
 
 int LayernormQuantizationPlugin::getNbOutputs() const noexcept
 {
-    return 1 + static_cast<int>(mDynActScaling);
+    return 1 + static_cast<int>(mDynActScaling) + static_cast<int>(mResidualEnabled);
 }
 
 int LayernormQuantizationPlugin::initialize() noexcept
@@ -221,7 +275,8 @@ void LayernormQuantizationPlugin::terminate() noexcept {}
 
 size_t LayernormQuantizationPlugin::getSerializationSize() const noexcept
 {
-    return sizeof(mEps) + sizeof(mUseDiffOfSquares) + sizeof(mDynActScaling) + sizeof(mType);
+    return sizeof(mEps) + sizeof(mUseDiffOfSquares) + sizeof(mDynActScaling) + sizeof(mType) + sizeof(mOutputType)
+        + sizeof(mResidualEnabled) + sizeof(mPreQuantScaleEnabled);
 }
 
 void LayernormQuantizationPlugin::serialize(void* buffer) const noexcept
@@ -231,6 +286,9 @@ void LayernormQuantizationPlugin::serialize(void* buffer) const noexcept
     write(d, mUseDiffOfSquares);
     write(d, mDynActScaling);
     write(d, mType);
+    write(d, mOutputType);
+    write(d, mResidualEnabled);
+    write(d, mPreQuantScaleEnabled);
     assert(d == a + getSerializationSize());
 }
 
@@ -250,6 +308,9 @@ LayernormQuantizationPluginCreator::LayernormQuantizationPluginCreator()
     mPluginAttributes.emplace_back(PluginField("use_diff_of_squares", nullptr, PluginFieldType::kINT32, 1));
     mPluginAttributes.emplace_back(PluginField("dyn_act_scaling", nullptr, PluginFieldType::kINT32, 1));
     mPluginAttributes.emplace_back(PluginField("type_id", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("out_type_id", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("residual_enabled", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("pre_quant_scale_enabled", nullptr, PluginFieldType::kINT32, 1));
     mFC.nbFields = mPluginAttributes.size();
     mFC.fields = mPluginAttributes.data();
 }
@@ -276,6 +337,9 @@ IPluginV2* LayernormQuantizationPluginCreator::createPlugin(char const* name, Pl
     nvinfer1::DataType type;
     bool useDiffOfSquares;
     bool dynamicActivationScaling;
+    nvinfer1::DataType outputType = nvinfer1::DataType::kINT8;
+    bool residualEnabled = false;
+    bool preQuantScaleEnabled = false;
     // Read configurations from each fields
     for (int i = 0; i < fc->nbFields; ++i)
     {
@@ -300,10 +364,26 @@ IPluginV2* LayernormQuantizationPluginCreator::createPlugin(char const* name, Pl
             TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
             useDiffOfSquares = static_cast<bool>(*(static_cast<bool const*>(fields[i].data)));
         }
+        else if (!strcmp(attrName, "out_type_id"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            outputType = static_cast<nvinfer1::DataType>(*(static_cast<nvinfer1::DataType const*>(fields[i].data)));
+        }
+        else if (!strcmp(attrName, "residual_enabled"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            residualEnabled = static_cast<bool>(*(static_cast<bool const*>(fields[i].data)));
+        }
+        else if (!strcmp(attrName, "pre_quant_scale_enabled"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            preQuantScaleEnabled = static_cast<bool>(*(static_cast<bool const*>(fields[i].data)));
+        }
     }
     try
     {
-        auto* obj = new LayernormQuantizationPlugin(eps, useDiffOfSquares, dynamicActivationScaling, type);
+        auto* obj = new LayernormQuantizationPlugin(eps, useDiffOfSquares, dynamicActivationScaling, type, outputType,
+            residualEnabled, preQuantScaleEnabled);
         obj->setPluginNamespace(mNamespace.c_str());
         return obj;
     }
@@ -28,8 +28,9 @@ namespace tensorrt_llm::plugins
 class LayernormQuantizationPlugin : public BasePlugin
 {
 public:
-    LayernormQuantizationPlugin(
-        float eps, bool useDiffOfSquares, bool dynamicActivationScaling, nvinfer1::DataType type);
+    LayernormQuantizationPlugin(float eps, bool useDiffOfSquares, bool dynamicActivationScaling,
+        nvinfer1::DataType type, nvinfer1::DataType outputType = nvinfer1::DataType::kINT8,
+        bool residualEnabled = false, bool preQuantScaleEnabled = false);
 
     LayernormQuantizationPlugin(void const* data, size_t length);
 
@@ -48,6 +49,11 @@ public:
     int enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::PluginTensorDesc const* outputDesc,
         void const* const* inputs, void* const* outputs, void* workspace, cudaStream_t stream) noexcept override;
 
+    template <typename T, typename QuantT>
+    void dispatchDataType(void const* input, void const* gamma, void const* beta, int const tokens,
+        int const hidden_dim, cudaStream_t stream, void const* scale, void* dynamic_scale, void* normed_output_quant,
+        void const* residual, void* residual_out, void const* pre_quant_scale) noexcept;
+
     // IPluginV2Ext Methods
     nvinfer1::DataType getOutputDataType(
         int index, nvinfer1::DataType const* inputTypes, int nbInputs) const noexcept override;
@@ -67,6 +73,12 @@ private:
     bool mUseDiffOfSquares;
     bool mDynActScaling;
     nvinfer1::DataType mType;
+    // The quantized output data type, int8 or fp8.
+    nvinfer1::DataType mOutputType{nvinfer1::DataType::kINT8};
+    // Do we add a residual input before the norm ? The sum is an extra output, the residual of the next layer.
+    bool mResidualEnabled{false};
+    // Do we scale the normed output per channel before quantization ?
+    bool mPreQuantScaleEnabled{false};
 
     const std::string mLayerName;
 };
@@ -106,12 +106,12 @@ bool LookupPlugin::supportsFormatCombination(
     }
     else
     {
-        TLLM_CHECK_WITH_INFO(mArch == 90, "int8 weight only lookupPlugin is only supported in SM 90 now.");
+        TLLM_CHECK_WITH_INFO(mArch >= 89, "Quantized weight lookupPlugin is only supported in SM 89 and later now.");
         switch (pos)
         {
         case 0: res = ((inOut[0].type == DataType::kINT32) && (inOut[0].format == TensorFormat::kLINEAR)); break;
         case 1:
-            res = ((inOut[1].type == DataType::kINT8 || inOut[1].type == mType)
+            res = ((inOut[1].type == DataType::kINT8 || inOut[1].type == DataType::kFP8 || inOut[1].type == mType)
                 && (inOut[1].format == TensorFormat::kLINEAR));
             break;
         case 2: res = ((inOut[2].type == mType) && (inOut[2].format == TensorFormat::kLINEAR)); break;
@@ -135,6 +135,37 @@ size_t LookupPlugin::getWorkspaceSize(nvinfer1::PluginTensorDesc const* inputs,
     return 0;
 }
 
+template <typename Tin>
+void LookupPlugin::dispatchQuantizedLookUp(nvinfer1::PluginTensorDesc const* inputDesc, void const* const* inputs,
+    void* const* outputs, int64_t tokenNum, int offset, cudaStream_t stream) const
+{
+    int const localVocabSize = inputDesc[1].dims.d[0];
+    int const hidden = inputDesc[1].dims.d[inputDesc[1].dims.nbDims - 1];
+    int const* input = reinterpret_cast<int const*>(inputs[0]);
+    Tin const* weight = reinterpret_cast<Tin const*>(inputs[1]);
+    if (mType == DataType::kHALF)
+    {
+        half const* per_token_scales = reinterpret_cast<half const*>(inputs[2]);
+        half* output = reinterpret_cast<half*>(outputs[0]);
+        invokeLookUp<half, Tin, int>(
+            output, input, weight, tokenNum, offset, localVocabSize, hidden, per_token_scales, stream);
+    }
+    else if (mType == DataType::kFLOAT)
+    {
+        float const* per_token_scales = reinterpret_cast<float const*>(inputs[2]);
+        float* output = reinterpret_cast<float*>(outputs[0]);
+        invokeLookUp<float, Tin, int>(
+            output, input, weight, tokenNum, offset, localVocabSize, hidden, per_token_scales, stream);
+    }
+    else if (mType == DataType::kBF16)
+    {
+        __nv_bfloat16 const* per_token_scales = reinterpret_cast<__nv_bfloat16 const*>(inputs[2]);
+        __nv_bfloat16* output = reinterpret_cast<__nv_bfloat16*>(outputs[0]);
+        invokeLookUp<__nv_bfloat16, Tin, int>(
+            output, input, weight, tokenNum, offset, localVocabSize, hidden, per_token_scales, stream);
+    }
+}
+
 int LookupPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::PluginTensorDesc const* outputDesc,
     void const* const* inputs, void* const* outputs, void* workspace, cudaStream_t stream) noexcept
 {
@@ -159,28 +190,17 @@ int LookupPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1:
 
     if (mNbInputs == 3)
     {
-        int8_t const* weight = reinterpret_cast<int8_t const*>(inputs[1]);
-        if (mType == DataType::kHALF)
-        {
-            half const* per_token_scales = reinterpret_cast<half const*>(inputs[2]);
-            half* output = reinterpret_cast<half*>(outputs[0]);
-            invokeLookUp<half, int8_t, int>(
-                output, input, weight, tokenNum, offset, localVocabSize, hidden, per_token_scales, stream);
-        }
-        else if (mType == DataType::kFLOAT)
+        // Quantized table, INT8 or FP8, dequantized by the per-row scales in the gather
+        if (inputDesc[1].type == DataType::kINT8)
         {
-            float const* per_token_scales = reinterpret_cast<float const*>(inputs[2]);
-            float* output = reinterpret_cast<float*>(outputs[0]);
-            invokeLookUp<float, int8_t, int>(
-                output, input, weight, tokenNum, offset, localVocabSize, hidden, per_token_scales, stream);
+            dispatchQuantizedLookUp<int8_t>(inputDesc, inputs, outputs, tokenNum, offset, stream);
         }
-        else if (mType == DataType::kBF16)
+#ifdef ENABLE_FP8
+        else if (inputDesc[1].type == DataType::kFP8)
         {
-            __nv_bfloat16 const* per_token_scales = reinterpret_cast<__nv_bfloat16 const*>(inputs[2]);
-            __nv_bfloat16* output = reinterpret_cast<__nv_bfloat16*>(outputs[0]);
-            invokeLookUp<__nv_bfloat16, int8_t, int>(
-                output, input, weight, tokenNum, offset, localVocabSize, hidden, per_token_scales, stream);
+            dispatchQuantizedLookUp<__nv_fp8_e4m3>(inputDesc, inputs, outputs, tokenNum, offset, stream);
         }
+#endif
     }
     else
     {
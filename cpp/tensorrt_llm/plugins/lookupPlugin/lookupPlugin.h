@@ -64,6 +64,11 @@ public:
     void destroy() noexcept override;
 
 private:
+    //! \brief Gather from a quantized table of type Tin, dequantizing by the per-row scales.
+    template <typename Tin>
+    void dispatchQuantizedLookUp(nvinfer1::PluginTensorDesc const* inputDesc, void const* const* inputs,
+        void* const* outputs, int64_t tokenNum, int offset, cudaStream_t stream) const;
+
     const std::string mLayerName;
 
     nvinfer1::DataType mType;
@@ -17,7 +17,12 @@
 #include "tensorrt_llm/plugins/mixtureOfExperts/mixtureOfExpertsPlugin.h"
 #include "tensorrt_llm/common/cudaBf16Wrapper.h"
 #include "tensorrt_llm/common/dataType.h"
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/mpiUtils.h"
 #include "tensorrt_llm/common/quantization.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/moeLoadCounters.h"
+#include <algorithm>
 #include <numeric>
 
 using namespace nvinfer1;
@@ -32,6 +37,53 @@ using tensorrt_llm::plugins::MixtureOfExpertsPlugin;
 using tensorrt_llm::plugins::read;
 using tensorrt_llm::plugins::write;
 
+#if ENABLE_MULTI_DEVICE
+namespace
+{
+
+// The all-to-all of the expert parallel group on NCCL. The moe ep ranks of a tp group are its consecutive ranks.
+class NcclMoeAllToAllCommunicator : public MoeAllToAllCommunicator
+{
+public:
+    explicit NcclMoeAllToAllCommunicator(MOEParallelismConfig const& config)
+    {
+        auto const rank = COMM_SESSION.getRank();
+        std::set<int> group;
+        for (int epRank = 0; epRank < config.ep_size; ++epRank)
+        {
+            group.insert(rank - config.ep_rank + epRank);
+        }
+        mNcclComm = getComm(group);
+    }
+
+    void allToAll(void const* send, std::vector<size_t> const& sendOffsets, std::vector<size_t> const& sendSizes,
+        void* recv, std::vector<size_t> const& recvOffsets, std::vector<size_t> const& recvSizes,
+        cudaStream_t stream) override
+    {
+        NCCLCHECK(ncclGroupStart());
+        for (size_t peer = 0; peer < sendSizes.size(); ++peer)
+        {
+            if (sendSizes[peer] > 0)
+            {
+                NCCLCHECK(ncclSend(static_cast<char const*>(send) + sendOffsets[peer], sendSizes[peer], ncclInt8,
+                    peer, *mNcclComm, stream));
+            }
+            if (recvSizes[peer] > 0)
+            {
+                NCCLCHECK(ncclRecv(static_cast<char*>(recv) + recvOffsets[peer], recvSizes[peer], ncclInt8, peer,
+                    *mNcclComm, stream));
+            }
+        }
+        NCCLCHECK(ncclGroupEnd());
+    }
+
+private:
+    std::shared_ptr<ncclComm_t> mNcclComm;
+};
+
+} // namespace
+#endif // ENABLE_MULTI_DEVICE
+
 static char const* MIXTURE_OF_EXPERTS_PLUGIN_VERSION{"1"};
 static char const* MIXTURE_OF_EXPERTS_PLUGIN_NAME{"MixtureOfExperts"};
 nvinfer1::PluginFieldCollection MixtureOfExpertsPluginCreator::mFC{};
@@ -43,7 +95,8 @@ MixtureOfExpertsPlugin::MixtureOfExpertsPlugin(bool remove_input_padding, int nu
     bool use_finished, bool use_bias, int tp_size, int tp_rank, int ep_size, int ep_rank,
     MOEExpertScaleNormalizationMode normalization_mode, float sparse_mixer_epsilon, bool force_determinism,
     MixtureOfExpertsPluginProfilerPtr gemm_profiler_ptr, bool use_lora, nvinfer1::DataType lora_type,
-    LoraPluginProfilerPtr lora_profiler, int max_low_rank)
+    LoraPluginProfilerPtr lora_profiler, int max_low_rank, bool use_all_to_all, std::vector<int> expert_placement,
+    int expert_offload_slots)
     : mRemoveInputPadding(remove_input_padding)
     , mNumExperts(number_of_experts)
     , mK(top_k)
@@ -56,7 +109,7 @@ MixtureOfExpertsPlugin::MixtureOfExpertsPlugin(bool remove_input_padding, int nu
     , mQuantMode(quant_mode)
     , mUseFinished(use_finished)
     , mUseBias(use_bias)
-    , mParallelismConfig(MOEParallelismConfig{tp_size, tp_rank, ep_size, ep_rank})
+    , mParallelismConfig(MOEParallelismConfig{tp_size, tp_rank, ep_size, ep_rank, use_all_to_all})
     , mNormalizationMode(normalization_mode)
     , mSparseMixerEpsilon(sparse_mixer_epsilon)
     , mUseDeterministicKernels(force_determinism)
@@ -65,6 +118,8 @@ MixtureOfExpertsPlugin::MixtureOfExpertsPlugin(bool remove_input_padding, int nu
     , mLoraType(lora_type)
     , mLoraProfiler(std::move(lora_profiler))
     , mMaxLowRank(max_low_rank)
+    , mExpertPlacement(std::move(expert_placement))
+    , mNumOffloadSlots(expert_offload_slots)
 {
     init();
 }
@@ -99,6 +154,8 @@ tensorrt_llm::plugins::MixtureOfExpertsPlugin::MixtureOfExpertsPlugin(MixtureOfE
     , mLoraProfiler(other.mLoraProfiler)
     , mLoraImpl1(other.mLoraImpl1)
     , mLoraImpl2(other.mLoraImpl2)
+    , mExpertPlacement(other.mExpertPlacement)
+    , mNumOffloadSlots(other.mNumOffloadSlots)
     , mLayerName(other.mLayerName)
     , mNamespace(other.mNamespace)
 {
@@ -112,7 +169,8 @@ size_t MixtureOfExpertsPlugin::getSerializationSize() const noexcept
         + sizeof(QuantMode::BaseType) + sizeof(mUseFinished) + sizeof(mUseBias) + sizeof(mParallelismConfig)
         + sizeof(mNormalizationMode) + sizeof(mSparseMixerEpsilon) + sizeof(mDims) + sizeof(mUseDeterministicKernels)
         + mGemmProfiler->getSerializationSize(mGemmId1) + mGemmProfiler->getSerializationSize(mGemmId2)
-        + sizeof(mUseLora) + sizeof(mLoraType) + sizeof(mMaxLowRank);
+        + sizeof(mUseLora) + sizeof(mLoraType) + sizeof(mMaxLowRank) + sizeof(int)
+        + mExpertPlacement.size() * sizeof(int) + sizeof(mNumOffloadSlots);
 
     if (hasLora())
     {
@@ -152,6 +210,14 @@ MixtureOfExpertsPlugin::MixtureOfExpertsPlugin(void const* data, size_t length,
     read(d, mUseLora);
     read(d, mLoraType);
     read(d, mMaxLowRank);
+    int num_physical_experts{};
+    read(d, num_physical_experts);
+    mExpertPlacement.resize(num_physical_experts);
+    for (auto& expert : mExpertPlacement)
+    {
+        read(d, expert);
+    }
+    read(d, mNumOffloadSlots);
 
     // Call init before deserialising the profiler to initialize mGemmId
     init();
@@ -196,6 +262,12 @@ void MixtureOfExpertsPlugin::serialize(void* buffer) const noexcept
     write(d, mUseLora);
     write(d, mLoraType);
     write(d, mMaxLowRank);
+    write(d, static_cast<int>(mExpertPlacement.size()));
+    for (auto const expert : mExpertPlacement)
+    {
+        write(d, expert);
+    }
+    write(d, mNumOffloadSlots);
 
     mGemmProfiler->serialize(d, mGemmId1);
     mGemmProfiler->serialize(d, mGemmId2);
@@ -218,6 +290,30 @@ void MixtureOfExpertsPlugin::init()
 
     TLLM_CHECK_WITH_INFO(!hasLora() || mLoraType == mOutputType, "The LoraType need to keep same with moe OutputType.");
 
+    if (!mExpertPlacement.empty())
+    {
+        TLLM_CHECK_WITH_INFO(static_cast<int>(mExpertPlacement.size()) >= mNumExperts,
+            "The expert placement has fewer physical experts than the %d logical ones", mNumExperts);
+        std::vector<bool> placed(mNumExperts, false);
+        for (auto const expert : mExpertPlacement)
+        {
+            TLLM_CHECK_WITH_INFO(
+                0 <= expert && expert < mNumExperts, "Invalid expert %d in the expert placement", expert);
+            placed[expert] = true;
+        }
+        TLLM_CHECK_WITH_INFO(std::all_of(placed.begin(), placed.end(), [](bool p) { return p; }),
+            "Every expert must have a physical expert in the expert placement");
+    }
+
+    if (mNumOffloadSlots > 0)
+    {
+        TLLM_CHECK_WITH_INFO(mK <= mNumOffloadSlots && mNumOffloadSlots <= mNumExperts,
+            "Expert offloading needs between top k %d and %d expert slots, got %d", mK, mNumExperts, mNumOffloadSlots);
+        TLLM_CHECK_WITH_INFO(mExpertPlacement.empty() && mParallelismConfig.ep_size == 1
+                && !mParallelismConfig.use_all_to_all && !hasLora(),
+            "Expert offloading does not support redundant experts, expert parallelism or lora");
+    }
+
     if (mWeightType == nvinfer1::DataType::kINT8 && mQuantMode.hasInt4Weights())
     {
         mWeightType = DataType::kINT4;
@@ -285,12 +381,19 @@ void MixtureOfExpertsPlugin::init()
     }
 
     mMOERunner->use_deterministic_hopper_reduce_ = mK > 2 && mUseDeterministicKernels;
+    mMOERunner->gemv_max_rows_ = kGemvMaxTokens;
+    if (!mExpertPlacement.empty() || mNumOffloadSlots > 0)
+    {
+        // The replica arrays are uploaded by initialize(), with expert offloading every expert has one replica, its
+        // slot
+        mMOERunner->expert_replicas_.num_logical_experts = mNumExperts;
+    }
 
-    mGemmId1 = GemmIDMoe{1, mNumExperts, mK, mParallelismConfig, mExpertHiddenSize, mExpertInterSize, mActivationType,
-        mType, mWeightType, mQuantMode, mMOERunner->use_deterministic_hopper_reduce_};
-    mGemmId2 = GemmIDMoe{2, mNumExperts, mK, mParallelismConfig, mExpertHiddenSize, mExpertInterSize, mActivationType,
-        mType, mWeightType, mQuantMode, mMOERunner->use_deterministic_hopper_reduce_};
-    mGemmProfiler->setMaxProfileM(16384 * mNumExperts / mK);
+    mGemmId1 = GemmIDMoe{1, getNumPhysicalExperts(), mK, mParallelismConfig, mExpertHiddenSize, mExpertInterSize,
+        mActivationType, mType, mWeightType, mQuantMode, mMOERunner->use_deterministic_hopper_reduce_};
+    mGemmId2 = GemmIDMoe{2, getNumPhysicalExperts(), mK, mParallelismConfig, mExpertHiddenSize, mExpertInterSize,
+        mActivationType, mType, mWeightType, mQuantMode, mMOERunner->use_deterministic_hopper_reduce_};
+    mGemmProfiler->setMaxProfileM(16384 * getNumPhysicalExperts() / mK);
 
     if (hasLora())
     {
@@ -435,10 +538,10 @@ void MixtureOfExpertsPlugin::configurePlugin(nvinfer1::DynamicPluginTensorDesc c
     {
         mDims = {minM, maxM, maxN, maxK};
     }
-    mGemmId1 = GemmIDMoe{1, mNumExperts, mK, mParallelismConfig, mExpertHiddenSize, mExpertInterSize, mActivationType,
-        mType, mWeightType, mQuantMode};
-    mGemmId2 = GemmIDMoe{2, mNumExperts, mK, mParallelismConfig, mExpertHiddenSize, mExpertInterSize, mActivationType,
-        mType, mWeightType, mQuantMode};
+    mGemmId1 = GemmIDMoe{1, getNumPhysicalExperts(), mK, mParallelismConfig, mExpertHiddenSize, mExpertInterSize,
+        mActivationType, mType, mWeightType, mQuantMode};
+    mGemmId2 = GemmIDMoe{2, getNumPhysicalExperts(), mK, mParallelismConfig, mExpertHiddenSize, mExpertInterSize,
+        mActivationType, mType, mWeightType, mQuantMode};
 
     if (hasLora())
     {
@@ -452,8 +555,9 @@ auto MixtureOfExpertsPlugin::setupWorkspace(void* base_ptr, int64_t num_tokens,
 {
     size_t dtype_size = tensorrt_llm::common::getDTypeSize(mType);
 
-    size_t moe_workspace_size = mMOERunner->getWorkspaceSize(num_tokens, mExpertHiddenSize, mExpertInterSize,
-        mNumExperts, mK, mActivationType, mNormalizationMode, mParallelismConfig, hasLora());
+    size_t moe_workspace_size = mMOERunner->getWorkspaceSize(getNumRowsPerRank(num_tokens), mExpertHiddenSize,
+        mExpertInterSize, getNumPhysicalExperts(), mK, mActivationType, mNormalizationMode, mParallelismConfig,
+        hasLora());
 
     // Output of post-softmax routing probabilities
     size_t scale_probabilities_size = num_tokens * mNumExperts * sizeof(float);
@@ -508,6 +612,44 @@ int64_t MixtureOfExpertsPlugin::getNumTokens(nvinfer1::PluginTensorDesc const* i
     return num_tokens;
 }
 
+int MixtureOfExpertsPlugin::getNumPhysicalExperts() const
+{
+    if (mNumOffloadSlots > 0)
+    {
+        return mNumOffloadSlots;
+    }
+    return mExpertPlacement.empty() ? mNumExperts : static_cast<int>(mExpertPlacement.size());
+}
+
+std::vector<int32_t> MixtureOfExpertsPlugin::getPerExpertInputIndices() const
+{
+    std::vector<int32_t> indices{getExpertWeights1Index(), getExpertWeights2Index()};
+    if (hasBias())
+    {
+        indices.push_back(getExpertBias1Index());
+        indices.push_back(getExpertBias2Index());
+    }
+    if (hasExpertIntQuantScales())
+    {
+        indices.push_back(getExpertIntQuantScale1Index());
+        indices.push_back(getExpertIntQuantScale2Index());
+    }
+    else if (hasExpertFp8QuantScales())
+    {
+        indices.push_back(getExpertFP8Dequant1Index());
+        indices.push_back(getExpertFP8Dequant2Index());
+    }
+    return indices;
+}
+
+int64_t MixtureOfExpertsPlugin::getNumRowsPerRank(int64_t num_tokens) const
+{
+    // Every rank of the group holds all the tokens, with the all-to-all each one routes its slice
+    return mParallelismConfig.use_all_to_all
+        ? static_cast<int64_t>(common::divUp(num_tokens, mParallelismConfig.ep_size))
+        : num_tokens;
+}
+
 size_t MixtureOfExpertsPlugin::getWorkspaceSize(nvinfer1::PluginTensorDesc const* inputs, int nbInputs,
     nvinfer1::PluginTensorDesc const* outputs, int nbOutputs) const noexcept
 {
@@ -666,7 +808,7 @@ int MixtureOfExpertsPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
     auto w1_desc = inputDesc[getExpertWeights1Index()];
     auto w2_desc = inputDesc[getExpertWeights2Index()];
     TLLM_CHECK(w1_desc.dims.nbDims == 3);
-    size_t experts_per_node = mNumExperts / mParallelismConfig.ep_size;
+    size_t experts_per_node = getNumPhysicalExperts() / mParallelismConfig.ep_size;
     TLLM_CHECK(w1_desc.dims.d[0] == experts_per_node);
     TLLM_CHECK(w2_desc.dims.nbDims == 3);
     TLLM_CHECK(w2_desc.dims.d[0] == experts_per_node);
@@ -717,10 +859,73 @@ int MixtureOfExpertsPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
     auto gemm1 = mGemmProfiler->getBestConfig(num_tokens, mGemmId1);
     auto gemm2 = mGemmProfiler->getBestConfig(num_tokens, mGemmId2);
     mMOERunner->setTactic(gemm1, gemm2);
+
+    if (mParallelismConfig.use_all_to_all)
+    {
+        // Each rank routes its slice of the tokens through the all-to-all, then the slices are gathered so the output
+        // holds all the tokens like after the allreduce of the other modes.
+        int64_t const rows_per_rank = getNumRowsPerRank(num_tokens);
+        auto const sliceStart = [&](int rank) { return std::min(rank * rows_per_rank, num_tokens); };
+        int64_t const start = sliceStart(mParallelismConfig.ep_rank);
+        int64_t const rows = sliceStart(mParallelismConfig.ep_rank + 1) - start;
+        size_t const input_row_bytes = mExpertHiddenSize * getDTypeSize(mType);
+        size_t const output_row_bytes = mExpertHiddenSize * getDTypeSize(mOutputType);
+        auto* output = static_cast<char*>(outputs[getOutputTensorIndex()]);
+
+        mMOERunner->runMoe(static_cast<char const*>(inputs[getInputTensorIndex()]) + start * input_row_bytes,
+            static_cast<float const*>(inputs[getRoutingTensorIndex()]) + start * mNumExperts,
+            inputs[getExpertWeights1Index()], nullptr, mActivationType, inputs[getExpertWeights2Index()], nullptr,
+            quant_params, rows_per_rank, mExpertHiddenSize, mExpertInterSize, getNumPhysicalExperts(), mK,
+            static_cast<char*>(workspace.workspace),
+            // Outputs
+            output + start * output_row_bytes, nullptr, rows, workspace.scale_probs,
+            static_cast<int*>(workspace.src_to_dest_map), static_cast<int*>(workspace.selected_experts),
+            mSparseMixerEpsilon, mParallelismConfig, mNormalizationMode, false, lora_params, stream);
+
+        std::vector<size_t> send_offsets(mParallelismConfig.ep_size, 0);
+        std::vector<size_t> send_sizes(mParallelismConfig.ep_size, rows * output_row_bytes);
+        std::vector<size_t> recv_offsets(mParallelismConfig.ep_size);
+        std::vector<size_t> recv_sizes(mParallelismConfig.ep_size);
+        for (int rank = 0; rank < mParallelismConfig.ep_size; ++rank)
+        {
+            recv_offsets[rank] = sliceStart(rank) * output_row_bytes;
+            recv_sizes[rank] = (sliceStart(rank + 1) - sliceStart(rank)) * output_row_bytes;
+        }
+        // The own slice is already in place
+        send_sizes[mParallelismConfig.ep_rank] = 0;
+        recv_sizes[mParallelismConfig.ep_rank] = 0;
+        mMOERunner->all_to_all_comm_->allToAll(output + start * output_row_bytes, send_offsets, send_sizes, output,
+            recv_offsets, recv_sizes, stream);
+        return 0;
+    }
+
+    if (mNumOffloadSlots > 0)
+    {
+        size_t const input_row_bytes = mExpertHiddenSize * getDTypeSize(mType);
+        size_t const output_row_bytes = mExpertHiddenSize * getDTypeSize(mOutputType);
+        auto const run_tokens = [&](int64_t begin, int64_t end)
+        {
+            mMOERunner->runMoe(static_cast<char const*>(inputs[getInputTensorIndex()]) + begin * input_row_bytes,
+                static_cast<float const*>(inputs[getRoutingTensorIndex()]) + begin * mNumExperts,
+                inputs[getExpertWeights1Index()], hasBias() ? inputs[getExpertBias1Index()] : nullptr,
+                mActivationType, inputs[getExpertWeights2Index()],
+                hasBias() ? inputs[getExpertBias2Index()] : nullptr, quant_params, end - begin, mExpertHiddenSize,
+                mExpertInterSize, getNumPhysicalExperts(), mK, static_cast<char*>(workspace.workspace),
+                // Outputs
+                static_cast<char*>(outputs[getOutputTensorIndex()]) + begin * output_row_bytes,
+                hasFinishedTensor() ? static_cast<bool const*>(inputs[getFinishedTensorIndex()]) + begin : nullptr,
+                end - begin, workspace.scale_probs, static_cast<int*>(workspace.src_to_dest_map),
+                static_cast<int*>(workspace.selected_experts), mSparseMixerEpsilon, mParallelismConfig,
+                mNormalizationMode, false, lora_params, stream);
+        };
+        runOffloadedExperts(inputDesc, inputs, num_tokens, run_tokens, stream);
+        return 0;
+    }
+
     mMOERunner->runMoe(inputs[getInputTensorIndex()], static_cast<float const*>(inputs[getRoutingTensorIndex()]),
         inputs[getExpertWeights1Index()], hasBias() ? inputs[getExpertBias1Index()] : nullptr, mActivationType,
         inputs[getExpertWeights2Index()], hasBias() ? inputs[getExpertBias2Index()] : nullptr, quant_params, num_tokens,
-        mExpertHiddenSize, mExpertInterSize, mNumExperts, mK, static_cast<char*>(workspace.workspace),
+        mExpertHiddenSize, mExpertInterSize, getNumPhysicalExperts(), mK, static_cast<char*>(workspace.workspace),
         // Outputs
         outputs[getOutputTensorIndex()],
         hasFinishedTensor() ? static_cast<bool const*>(inputs[getFinishedTensorIndex()]) : nullptr, num_not_finished,
@@ -731,6 +936,93 @@ int MixtureOfExpertsPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
     return 0;
 }
 
+void MixtureOfExpertsPlugin::runOffloadedExperts(nvinfer1::PluginTensorDesc const* inputDesc,
+    void const* const* inputs, int64_t num_tokens, std::function<void(int64_t, int64_t)> const& run_tokens,
+    cudaStream_t stream)
+{
+    using tensorrt_llm::runtime::BufferManager;
+    auto& layer = *mOffloadedExperts;
+    std::lock_guard<std::mutex> lock(layer.mutex);
+
+    // The per expert inputs hold the slots, the host tensors all the experts in the same order
+    auto const slot_inputs = getPerExpertInputIndices();
+    TLLM_CHECK_WITH_INFO(slot_inputs.size() == layer.hostExperts.size(),
+        "MoE layer %s registered %zu expert weights, the plugin takes %zu", mLayerName.c_str(),
+        layer.hostExperts.size(), slot_inputs.size());
+    std::vector<size_t> expert_bytes(slot_inputs.size());
+    for (size_t i = 0; i < slot_inputs.size(); ++i)
+    {
+        auto const& desc = inputDesc[slot_inputs[i]];
+        TLLM_CHECK_WITH_INFO(desc.dims.nbDims >= 1 && desc.dims.d[0] == mNumOffloadSlots,
+            "Input %d of MoE layer %s must hold %d expert slots", slot_inputs[i], mLayerName.c_str(), mNumOffloadSlots);
+        expert_bytes[i] = layer.hostExperts[i]->getSizeInBytes() / mNumExperts;
+        auto const slot_bytes = static_cast<size_t>(tensorrt_llm::runtime::ITensor::volume(desc.dims))
+            * getDTypeSize(desc.type) / mNumOffloadSlots;
+        TLLM_CHECK_WITH_INFO(slot_bytes == expert_bytes[i],
+            "Input %d of MoE layer %s has %zu bytes per expert, the registered experts %zu", slot_inputs[i],
+            mLayerName.c_str(), slot_bytes, expert_bytes[i]);
+    }
+
+    // The experts are chosen from the router logits, so the step waits for them
+    size_t const routing_size = num_tokens * mNumExperts;
+    if (!mHostRouting || mHostRouting->getSize() < routing_size)
+    {
+        mHostRouting = BufferManager::pinned(routing_size, nvinfer1::DataType::kFLOAT);
+    }
+    TLLM_CUDA_CHECK(cudaMemcpyAsync(mHostRouting->data(), inputs[getRoutingTensorIndex()],
+        routing_size * sizeof(float), cudaMemcpyDeviceToHost, stream));
+    TLLM_CUDA_CHECK(cudaStreamSynchronize(stream));
+    auto const chunks = layer.residency->plan(
+        static_cast<float const*>(mHostRouting->data()), static_cast<tensorrt_llm::runtime::SizeType32>(num_tokens));
+
+    // The slot tables stay in place until the next step, which waits for the stream
+    size_t const table_size = chunks.size() * mNumExperts;
+    if (!mHostExpertSlots || mHostExpertSlots->getSize() < table_size)
+    {
+        mHostExpertSlots = BufferManager::pinned(table_size, nvinfer1::DataType::kINT32);
+    }
+    auto* tables = static_cast<int*>(mHostExpertSlots->data());
+    auto const copy_stream = mOffloadStream->get();
+    for (size_t c = 0; c < chunks.size(); ++c)
+    {
+        auto const& chunk = chunks[c];
+        if (!chunk.loads.empty())
+        {
+            // The loads may replace the experts of the chunk before the previous one, and of the previous one if the
+            // plan says so, otherwise they overlap the previous chunk
+            if (c >= 2)
+            {
+                TLLM_CUDA_CHECK(cudaStreamWaitEvent(copy_stream, mOffloadChunkDoneEvents[c % 2]));
+            }
+            if (chunk.overwritesPrevious)
+            {
+                TLLM_CUDA_CHECK(cudaStreamWaitEvent(copy_stream, mOffloadChunkDoneEvents[(c - 1) % 2]));
+            }
+            for (auto const& load : chunk.loads)
+            {
+                for (size_t i = 0; i < slot_inputs.size(); ++i)
+                {
+                    // The per expert inputs are the writable slot storage of the layer
+                    auto* slots = static_cast<char*>(const_cast<void*>(inputs[slot_inputs[i]]));
+                    auto const* experts = static_cast<char const*>(layer.hostExperts[i]->data());
+                    TLLM_CUDA_CHECK(cudaMemcpyAsync(slots + load.slot * expert_bytes[i],
+                        experts + load.expert * expert_bytes[i], expert_bytes[i], cudaMemcpyHostToDevice,
+                        copy_stream));
+                }
+            }
+            TLLM_CUDA_CHECK(cudaEventRecord(mOffloadCopiedEvent, copy_stream));
+            TLLM_CUDA_CHECK(cudaStreamWaitEvent(stream, mOffloadCopiedEvent));
+        }
+
+        auto* table = tables + c * mNumExperts;
+        std::copy(chunk.expertSlots.begin(), chunk.expertSlots.end(), table);
+        TLLM_CUDA_CHECK(
+            cudaMemcpyAsync(mReplicaSlots, table, mNumExperts * sizeof(int), cudaMemcpyHostToDevice, stream));
+        run_tokens(chunk.beginToken, chunk.endToken);
+        TLLM_CUDA_CHECK(cudaEventRecord(mOffloadChunkDoneEvents[c % 2], stream));
+    }
+}
+
 // IPluginV2Ext Methods
 nvinfer1::DataType MixtureOfExpertsPlugin::getOutputDataType(
     int index, nvinfer1::DataType const* inputTypes, int nbInputs) const noexcept
@@ -766,10 +1058,107 @@ int MixtureOfExpertsPlugin::initialize() noexcept
         mLoraProfiler->profileTactics(mLoraImpl1->mCublasWrapper, mType, mDims, mLoraGemmId1);
         mLoraProfiler->profileTactics(mLoraImpl2->mCublasWrapper, mType, mDims, mLoraGemmId2);
     }
+
+    if (mParallelismConfig.use_all_to_all && !isBuilding())
+    {
+#if ENABLE_MULTI_DEVICE
+        mMOERunner->all_to_all_comm_ = std::make_shared<NcclMoeAllToAllCommunicator>(mParallelismConfig);
+#else
+        TLLM_THROW("The MoE all-to-all needs a multi-device build");
+#endif // ENABLE_MULTI_DEVICE
+    }
+
+    if (!mExpertPlacement.empty() && !isBuilding() && mReplicaOffsets == nullptr)
+    {
+        // Group the physical experts by the logical expert they hold
+        std::vector<int> offsets(mNumExperts + 1, 0);
+        for (auto const expert : mExpertPlacement)
+        {
+            ++offsets[expert + 1];
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<int> slots(mExpertPlacement.size());
+        std::vector<int> next(offsets.begin(), offsets.end() - 1);
+        for (int slot = 0; slot < static_cast<int>(mExpertPlacement.size()); ++slot)
+        {
+            slots[next[mExpertPlacement[slot]]++] = slot;
+        }
+
+        TLLM_CUDA_CHECK(cudaMalloc(&mReplicaOffsets, offsets.size() * sizeof(int)));
+        TLLM_CUDA_CHECK(cudaMalloc(&mReplicaSlots, slots.size() * sizeof(int)));
+        TLLM_CUDA_CHECK(
+            cudaMemcpy(mReplicaOffsets, offsets.data(), offsets.size() * sizeof(int), cudaMemcpyHostToDevice));
+        TLLM_CUDA_CHECK(cudaMemcpy(mReplicaSlots, slots.data(), slots.size() * sizeof(int), cudaMemcpyHostToDevice));
+        mMOERunner->expert_replicas_.replica_offsets = mReplicaOffsets;
+        mMOERunner->expert_replicas_.replica_slots = mReplicaSlots;
+    }
+
+    if (mNumOffloadSlots > 0 && !isBuilding() && mOffloadedExperts == nullptr)
+    {
+        mOffloadedExperts = tensorrt_llm::runtime::MoeOffloadedExperts::getInstance().getLayer(
+            mLayerName, mNumOffloadSlots, mK);
+        TLLM_CHECK_WITH_INFO(mOffloadedExperts->residency->getNumExperts() == mNumExperts,
+            "MoE layer %s registered %d experts, the router has %d", mLayerName.c_str(),
+            mOffloadedExperts->residency->getNumExperts(), mNumExperts);
+
+        // One replica per expert, its slot is set for every chunk by runOffloadedExperts()
+        std::vector<int> offsets(mNumExperts + 1);
+        std::iota(offsets.begin(), offsets.end(), 0);
+        TLLM_CUDA_CHECK(cudaMalloc(&mReplicaOffsets, offsets.size() * sizeof(int)));
+        TLLM_CUDA_CHECK(cudaMalloc(&mReplicaSlots, mNumExperts * sizeof(int)));
+        TLLM_CUDA_CHECK(
+            cudaMemcpy(mReplicaOffsets, offsets.data(), offsets.size() * sizeof(int), cudaMemcpyHostToDevice));
+        TLLM_CUDA_CHECK(cudaMemset(mReplicaSlots, 0, mNumExperts * sizeof(int)));
+        mMOERunner->expert_replicas_.replica_offsets = mReplicaOffsets;
+        mMOERunner->expert_replicas_.replica_slots = mReplicaSlots;
+
+        mOffloadStream = std::make_unique<tensorrt_llm::runtime::CudaStream>();
+        TLLM_CUDA_CHECK(cudaEventCreateWithFlags(&mOffloadCopiedEvent, cudaEventDisableTiming));
+        for (auto& event : mOffloadChunkDoneEvents)
+        {
+            TLLM_CUDA_CHECK(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+        }
+    }
+
+    if (getEnvMoeLoadStats() && !isBuilding() && !mTracksExpertLoad)
+    {
+        mMOERunner->expert_load_histogram_
+            = tensorrt_llm::runtime::MoeLoadCounters::getInstance().acquire(mLayerName, mNumExperts);
+        mTracksExpertLoad = true;
+    }
     return 0;
 }
 
-void MixtureOfExpertsPlugin::terminate() noexcept {}
+void MixtureOfExpertsPlugin::terminate() noexcept
+{
+    if (mTracksExpertLoad)
+    {
+        tensorrt_llm::runtime::MoeLoadCounters::getInstance().release(mLayerName);
+        mMOERunner->expert_load_histogram_ = nullptr;
+        mTracksExpertLoad = false;
+    }
+    if (mReplicaOffsets != nullptr)
+    {
+        TLLM_CUDA_CHECK(cudaFree(mReplicaOffsets));
+        TLLM_CUDA_CHECK(cudaFree(mReplicaSlots));
+        mReplicaOffsets = nullptr;
+        mReplicaSlots = nullptr;
+        mMOERunner->expert_replicas_.replica_offsets = nullptr;
+        mMOERunner->expert_replicas_.replica_slots = nullptr;
+    }
+    if (mOffloadedExperts != nullptr)
+    {
+        TLLM_CUDA_CHECK(cudaEventDestroy(mOffloadCopiedEvent));
+        for (auto& event : mOffloadChunkDoneEvents)
+        {
+            TLLM_CUDA_CHECK(cudaEventDestroy(event));
+        }
+        mOffloadStream.reset();
+        mHostRouting.reset();
+        mHostExpertSlots.reset();
+        mOffloadedExperts.reset();
+    }
+}
 
 void MixtureOfExpertsPlugin::destroy() noexcept
 {
@@ -839,6 +1228,9 @@ MixtureOfExpertsPluginCreator::MixtureOfExpertsPluginCreator()
     mPluginAttributes.emplace_back(nvinfer1::PluginField("use_lora", nullptr, PluginFieldType::kINT32, 0));
     mPluginAttributes.emplace_back(nvinfer1::PluginField("lora_type_id", nullptr, PluginFieldType::kINT32, 0));
     mPluginAttributes.emplace_back(nvinfer1::PluginField("max_low_rank", nullptr, PluginFieldType::kINT32, 0));
+    mPluginAttributes.emplace_back(nvinfer1::PluginField("use_all_to_all", nullptr, PluginFieldType::kINT32, 0));
+    mPluginAttributes.emplace_back(nvinfer1::PluginField("expert_placement", nullptr, PluginFieldType::kINT32, 0));
+    mPluginAttributes.emplace_back(nvinfer1::PluginField("expert_offload_slots", nullptr, PluginFieldType::kINT32, 0));
     mFC.nbFields = mPluginAttributes.size();
     mFC.fields = mPluginAttributes.data();
 }
@@ -868,8 +1260,11 @@ IPluginV2* MixtureOfExpertsPluginCreator::createPlugin(
     int mUseLora{};
     int mLoraType{INT_MAX};
     int mMaxLowRank{0};
+    int mUseAllToAll{0};
+    int mExpertOffloadSlots{0};
 
     float mSparseMixerEpsilon = -INFINITY;
+    std::vector<int> mExpertPlacement;
 
     // Read configurations from each fields
     struct MapPair
@@ -904,6 +1299,8 @@ IPluginV2* MixtureOfExpertsPluginCreator::createPlugin(
         MapPair{"force_determinism", std::ref(mRequiresDeterminism), true},
         MapPair{"lora_type_id", std::ref(mLoraType), true},
         MapPair{"max_low_rank", std::ref(mMaxLowRank), true},
+        MapPair{"use_all_to_all", std::ref(mUseAllToAll), true},
+        MapPair{"expert_offload_slots", std::ref(mExpertOffloadSlots), true},
     };
     for (int i = 0; i < fc->nbFields; ++i)
     {
@@ -925,6 +1322,12 @@ IPluginV2* MixtureOfExpertsPluginCreator::createPlugin(
             TLLM_CHECK(fields[i].type == nvinfer1::PluginFieldType::kFLOAT32);
             mSparseMixerEpsilon = *static_cast<float const*>(fields[i].data);
         }
+        else if (!strcmp(attrName, "expert_placement"))
+        {
+            TLLM_CHECK(fields[i].type == nvinfer1::PluginFieldType::kINT32);
+            auto const* placement = static_cast<int const*>(fields[i].data);
+            mExpertPlacement.assign(placement, placement + fields[i].length);
+        }
     }
 
     for (auto& item : input_map)
@@ -944,6 +1347,12 @@ IPluginV2* MixtureOfExpertsPluginCreator::createPlugin(
             "MoE fuse lora, lora_type_id and max_low_rank are required but not set");
     }
 
+    if (mUseAllToAll)
+    {
+        TLLM_CHECK_WITH_INFO(!mUseBias && !mUseLora && !mUseFinished,
+            "MoE all-to-all does not support bias, lora or the finished tensor");
+    }
+
     if (static_cast<MOEExpertScaleNormalizationMode>(mNormalizationMode)
         == MOEExpertScaleNormalizationMode::SPARSE_MIXER)
     {
@@ -963,7 +1372,8 @@ IPluginV2* MixtureOfExpertsPluginCreator::createPlugin(
             QuantMode(mQuantMode), mUseFinished != 0, mUseBias != 0, mTPSize, mTPRank, mEPSize, mEPRank,
             static_cast<MOEExpertScaleNormalizationMode>(mNormalizationMode), mSparseMixerEpsilon,
             mRequiresDeterminism != 0, gemmProfiler, mUseLora != 0, static_cast<nvinfer1::DataType>(mLoraType),
-            loraProfiler, mMaxLowRank);
+            loraProfiler, mMaxLowRank, mUseAllToAll != 0, std::move(mExpertPlacement), mExpertOffloadSlots);
+        obj->mLayerName = name;
         obj->setPluginNamespace(mNamespace.c_str());
         return obj;
     }
@@ -987,6 +1397,7 @@ IPluginV2* MixtureOfExpertsPluginCreator::deserializePlugin(
         auto* obj = new MixtureOfExpertsPlugin(
             // Constructor parameters
             serialData, serialLength, gemmProfiler, loraProfiler);
+        obj->mLayerName = name;
         obj->setPluginNamespace(mNamespace.c_str());
         return obj;
     }
@@ -1044,6 +1455,6 @@ void MixtureOfExpertsGemmProfiler::checkInit()
     init_backend = true;
     auto& plugin = *mRunner;
     backend.init(*plugin.mMOERunner, backend.mGemmToProfile, plugin.mType, plugin.mWeightType, plugin.mOutputType,
-        plugin.mNumExperts, plugin.mK, plugin.mExpertHiddenSize, plugin.mExpertInterSize, plugin.mActivationType,
-        plugin.hasBias(), plugin.hasLora(), plugin.getParallelismConfig());
+        plugin.getNumPhysicalExperts(), plugin.mK, plugin.mExpertHiddenSize, plugin.mExpertInterSize,
+        plugin.mActivationType, plugin.hasBias(), plugin.hasLora(), plugin.getParallelismConfig());
 }
@@ -26,7 +26,10 @@
 #include "tensorrt_llm/plugins/common/plugin.h"
 #include "tensorrt_llm/plugins/gemmPlugin/gemmPlugin.h"
 #include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+#include "tensorrt_llm/runtime/moeExpertOffload.h"
 #include <cassert>
+#include <functional>
 #include <set>
 #include <string>
 #include <vector>
@@ -100,6 +103,9 @@ public:
     using LoraPluginProfilerPtr = std::shared_ptr<CublasLtGemmPluginProfiler>;
     using LoraImplPtr = std::shared_ptr<kernels::LoraImpl>;
 
+    //! Token counts up to which the unquantized experts run as GEMVs over only the selected experts
+    static constexpr int64_t kGemvMaxTokens = 8;
+
     MixtureOfExpertsPlugin() = delete;
     MixtureOfExpertsPlugin(bool remove_input_padding, int number_of_experts, int top_k, int expert_hidden_size,
         int expert_inter_size, tensorrt_llm::ActivationType activation_type, nvinfer1::DataType type,
@@ -107,7 +113,8 @@ public:
         bool use_finished, bool use_bias, int tp_size, int tp_rank, int ep_size, int ep_rank,
         MOEExpertScaleNormalizationMode normalization_mode, float sparse_mixer_epsilon, bool force_determinism,
         MixtureOfExpertsPluginProfilerPtr gemm_profiler_ptr, bool use_lora, nvinfer1::DataType lora_type,
-        LoraPluginProfilerPtr lora_profiler, int max_low_rank);
+        LoraPluginProfilerPtr lora_profiler, int max_low_rank, bool use_all_to_all = false,
+        std::vector<int> expert_placement = {}, int expert_offload_slots = 0);
     MixtureOfExpertsPlugin(void const* data, size_t length, MixtureOfExpertsPluginProfilerPtr gemm_profiler_ptr,
         LoraPluginProfilerPtr lora_profiler);
     MixtureOfExpertsPlugin(MixtureOfExpertsPlugin const&);
@@ -152,6 +159,7 @@ public:
 
 private:
     friend class MixtureOfExpertsGemmProfiler;
+    friend class MixtureOfExpertsPluginCreator;
     std::unique_ptr<kernels::CutlassMoeFCRunnerInterface> mMOERunner{};
     int mNumExperts{};
     int mK{};
@@ -198,9 +206,26 @@ private:
 
     cudaEvent_t mMemcpyEvent;
 
+    // Redundant experts: the logical expert held by every physical expert of the weights, empty without replicas
+    std::vector<int> mExpertPlacement{};
+    // Expert offloading: the number of expert slots of the weights, 0 when all experts are on the device
+    int mNumOffloadSlots{};
+
     // The below are not serialised
-    std::string const mLayerName{};
+    std::string mLayerName{};
     std::string mNamespace{};
+    // The replicas of every logical expert on the device, see kernels::MoeExpertReplicas
+    int* mReplicaOffsets{};
+    int* mReplicaSlots{};
+    bool mTracksExpertLoad{};
+    // The host experts and residency of the layer, shared with the other instances of the layer
+    std::shared_ptr<tensorrt_llm::runtime::MoeOffloadedExperts::Layer> mOffloadedExperts;
+    std::unique_ptr<tensorrt_llm::runtime::CudaStream> mOffloadStream;
+    cudaEvent_t mOffloadCopiedEvent{};
+    // Recorded after every chunk, alternating, so the loads of a chunk can wait for the chunk before the previous one
+    cudaEvent_t mOffloadChunkDoneEvents[2]{};
+    tensorrt_llm::runtime::IBuffer::SharedPtr mHostRouting;
+    tensorrt_llm::runtime::IBuffer::SharedPtr mHostExpertSlots;
 
     struct WorkspaceInfo
     {
@@ -214,6 +239,15 @@ private:
     };
 
     int64_t getNumTokens(nvinfer1::PluginTensorDesc const* input_tensor) const;
+    // The experts of the weights, more than the routed experts with redundant experts, fewer with expert offloading
+    int getNumPhysicalExperts() const;
+    // The inputs with a leading expert dimension, which hold the expert slots with expert offloading
+    std::vector<int32_t> getPerExpertInputIndices() const;
+    // Load the experts the tokens select into the expert slots and run the tokens in chunks whose experts fit
+    void runOffloadedExperts(nvinfer1::PluginTensorDesc const* inputDesc, void const* const* inputs,
+        int64_t num_tokens, std::function<void(int64_t, int64_t)> const& run_tokens, cudaStream_t stream);
+    // The rows the runner gets from the num_tokens of the plugin, a slice per rank with the all-to-all
+    int64_t getNumRowsPerRank(int64_t num_tokens) const;
     WorkspaceInfo setupWorkspace(void* base_ptr, int64_t num_tokens, int num_reqs = 0) const;
 
     kernels::MOEParallelismConfig getParallelismConfig() const;
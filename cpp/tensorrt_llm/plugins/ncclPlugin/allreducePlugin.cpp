@@ -16,10 +16,13 @@
  */
 #include "allreducePlugin.h"
 
+#include "tensorrt_llm/common/commLane.h"
 #include "tensorrt_llm/common/customAllReduceUtils.h"
 #include "tensorrt_llm/common/dataType.h"
 #include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/kernels/allReduceStrategyTable.h"
 #include "tensorrt_llm/kernels/customAllReduceKernels.h"
+#include <algorithm>
 #include <nccl.h>
 #include <unordered_set>
 
@@ -84,6 +87,13 @@ nvinfer1::IPluginV2DynamicExt* AllreducePlugin::clone() const noexcept
 nvinfer1::DimsExprs AllreducePlugin::getOutputDimensions(
     int outputIndex, nvinfer1::DimsExprs const* inputs, int nbInputs, nvinfer1::IExprBuilder& exprBuilder) noexcept
 {
+    if (outputIndex == 2)
+    {
+        // The per token scales of the quantized fusion ops.
+        nvinfer1::DimsExprs ret = inputs[0];
+        ret.d[ret.nbDims - 1] = exprBuilder.constant(1);
+        return ret;
+    }
     return inputs[0];
 }
 
@@ -91,7 +101,7 @@ bool AllreducePlugin::supportsFormatCombination(
     int pos, nvinfer1::PluginTensorDesc const* inOut, int nbInputs, int nbOutputs) noexcept
 {
     int fusion_op_extra_inputs = 0;
-    if (mOp == AllReduceFusionOp::RESIDUAL_RMS_NORM)
+    if (mOp != AllReduceFusionOp::NONE)
     {
         ++fusion_op_extra_inputs;
         if (mAffine)
@@ -117,6 +127,11 @@ bool AllreducePlugin::supportsFormatCombination(
     {
         return (inOut[pos].type == nvinfer1::DataType::kINT64) && (inOut[pos].format == TensorFormat::kLINEAR);
     }
+    else if (pos >= nbInputs)
+    {
+        return (inOut[pos].type == getOutputDataType(pos - nbInputs, &mType, nbInputs))
+            && (inOut[pos].format == TensorFormat::kLINEAR);
+    }
     else
     {
         return (inOut[pos].type == mType) && (inOut[pos].format == TensorFormat::kLINEAR);
@@ -134,10 +149,49 @@ size_t AllreducePlugin::getWorkspaceSize(nvinfer1::PluginTensorDesc const* input
     return 0;
 }
 
-AllReduceStrategyType AllreducePlugin::selectImplementation(
-    size_t messageSize, int worldSize, nvinfer1::DataType type) noexcept
+// Whether the all-reduce workspace carries a bound NVLS multicast buffer.
+static bool hasNvlsBuffer(nvinfer1::PluginTensorDesc const& workspaceDesc, void const* workspace, int worldSize)
+{
+    namespace allReduceUtils = tensorrt_llm::utils::customAllReduceUtils;
+    if (!allReduceUtils::hasNvlsPointers(workspaceDesc.dims.d[0], worldSize))
+    {
+        return false;
+    }
+    // The barrier flag, the unicast and then the multicast pointer follow the per rank pointers.
+    auto const* multicastPtr
+        = static_cast<int64_t const*>(workspace) + allReduceUtils::NUM_POINTERS_PER_RANK * worldSize + 2;
+    return *multicastPtr != 0;
+}
+
+// Whether the all-reduce workspace carries the IPC buffers of the ranks of this node for the HIERARCHICAL strategy.
+static bool hasNodeBuffers(void const* workspace, int nodeRank)
+{
+    return static_cast<int64_t const*>(workspace)[nodeRank] != 0;
+}
+
+AllReduceStrategyType AllreducePlugin::selectImplementation(size_t messageSize, int worldSize,
+    nvinfer1::DataType type, bool isNvlsAvailable, bool isHierarchicalAvailable,
+    AllReduceStrategyConfig& config) noexcept
 {
     bool const isAuto = (mStrategy == AllReduceStrategyType::AUTO);
+    config = mConfig;
+
+    if (mNodeGroupSize < worldSize)
+    {
+        // Only the hierarchical strategy runs custom kernels for groups spanning nodes. NCCL does the same kind of
+        // split internally, AUTO keeps using it.
+        if (mStrategy == AllReduceStrategyType::HIERARCHICAL)
+        {
+            auto const maxWorkspaceSize = utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(worldSize);
+            if (isHierarchicalAvailable && messageSize * common::getDTypeSize(type) <= maxWorkspaceSize
+                && kernels::configurationSupported(mStrategy, messageSize, mNodeGroupSize, type))
+            {
+                return AllReduceStrategyType::HIERARCHICAL;
+            }
+            TLLM_LOG_WARNING("Since the hierarchical all-reduce is unavailable, fallback to AllReduceStrategy: NCCL");
+        }
+        return AllReduceStrategyType::NCCL;
+    }
 
     if (!mIsP2PSupported)
     {
@@ -157,15 +211,33 @@ AllReduceStrategyType AllreducePlugin::selectImplementation(
 
     AllReduceStrategyType strat = AllReduceStrategyType::NCCL;
     auto const messageSizeBytes = messageSize * common::getDTypeSize(type);
+    // Past the one-shot sizes the in-switch reduction beats NCCL on NVSwitch systems. The norm fusions have no NVLS
+    // kernel and would run two-shot instead, which AUTO avoids.
+    bool const useNvls = isNvlsAvailable && mOp == AllReduceFusionOp::NONE;
 
     if (messageSizeBytes <= maxWorkspaceSize)
     {
         // In some instances, the two-shot strategy has exhibited significant performance issues.
         // As a temporary measure, we have disabled the two-shot strategy.
         // TODO: remove this WAR after https://nvbugspro.nvidia.com/bug/4718747 is fixed.
+        // Strategies measured on the node by allReduceStrategyTuner, two-shot included, win over the thresholds.
         if (!isAuto)
         {
-            strat = mStrategy;
+            // Within a node the hierarchical all-reduce is the two-shot one.
+            strat = mStrategy == AllReduceStrategyType::HIERARCHICAL ? AllReduceStrategyType::TWOSHOT : mStrategy;
+            if (strat == AllReduceStrategyType::NVLS && !isNvlsAvailable)
+            {
+                TLLM_LOG_WARNING("Since the workspace has no NVLS buffer, fallback to AllReduceStrategy: NCCL");
+                strat = AllReduceStrategyType::NCCL;
+            }
+        }
+        else if (auto const choice = kernels::AllReduceStrategyTable::lookupGlobal(worldSize, messageSizeBytes);
+                 choice && (choice->strategy != AllReduceStrategyType::NVLS || useNvls))
+        {
+            strat = choice->strategy;
+            // The FP8 compression is an accuracy choice of the engine, not a tuned one.
+            config = static_cast<AllReduceStrategyConfig>(static_cast<int8_t>(choice->config)
+                | static_cast<int8_t>(mConfig) & static_cast<int8_t>(AllReduceStrategyConfig::COMPRESS_FP8));
         }
         else if (worldSize <= 2)
         {
@@ -179,7 +251,7 @@ AllReduceStrategyType AllreducePlugin::selectImplementation(
             }
             else
             {
-                strat = AllReduceStrategyType::NCCL;
+                strat = useNvls ? AllReduceStrategyType::NVLS : AllReduceStrategyType::NCCL;
             }
         }
         else
@@ -190,7 +262,7 @@ AllReduceStrategyType AllreducePlugin::selectImplementation(
             }
             else
             {
-                strat = AllReduceStrategyType::NCCL;
+                strat = useNvls ? AllReduceStrategyType::NVLS : AllReduceStrategyType::NCCL;
             }
         }
 
@@ -215,6 +287,23 @@ AllReduceStrategyType AllreducePlugin::selectImplementation(
     return strat;
 }
 
+void AllreducePlugin::runHierarchicalAllReduce(
+    void const* input, void* output, size_t size, void const* workspace, int tpRank, cudaStream_t stream)
+{
+    auto params = tensorrt_llm::kernels::AllReduceParams::deserialize(
+        reinterpret_cast<int64_t*>(const_cast<void*>(workspace)), mGroup.size(), tpRank, false, mNodeGroupSize);
+    params.local_input_buffer_ptr = input;
+    params.local_output_buffer_ptr = output;
+    params.elts_total = size;
+    tensorrt_llm::kernels::hierarchicalReduceScatter(params, mType, stream);
+    // The node sum of this rank's slice sits in its IPC buffer, sum it over the nodes in place.
+    auto* slice = static_cast<int8_t*>(params.peer_comm_buffer_ptrs[params.local_rank])
+        + params.rank_offset * common::getDTypeSize(mType);
+    NCCLCHECK(ncclAllReduce(
+        slice, slice, params.elts_per_rank, (*getDtypeMap())[mType], ncclSum, *mInterNodeNcclComm, stream));
+    tensorrt_llm::kernels::hierarchicalAllGather(params, mType, stream);
+}
+
 int AllreducePlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::PluginTensorDesc const* outputDesc,
     void const* const* inputs, void* const* outputs, void* workspace, cudaStream_t stream) noexcept
 {
@@ -229,21 +318,37 @@ int AllreducePlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfe
     }
     auto const sizePerElem = common::getDTypeSize(mType);
 
+    auto const rank = COMM_SESSION.getRank();
+    int tpRank = 0;
+    for (auto const& currentRank : mGroup)
+    {
+        if (rank == currentRank)
+            break;
+        ++tpRank;
+    }
+
     kernels::AllReduceStrategyType runtimeStrategy;
+    kernels::AllReduceStrategyConfig runtimeConfig = mConfig;
+    bool isNvlsAvailable = false;
 
     static char* forceNcclAllReduceStrategyChar = std::getenv("FORCE_NCCL_ALL_REDUCE_STRATEGY");
     bool forceNcclAllReduceStrategy = (forceNcclAllReduceStrategyChar != nullptr);
-    if (forceNcclAllReduceStrategy || mStrategy == AllReduceStrategyType::NCCL)
+    // The other communication lanes cannot share the workspace of the custom kernels with lane 0
+    bool const onOtherLane = common::getCommLane() != 0;
+    if (forceNcclAllReduceStrategy || onOtherLane || mStrategy == AllReduceStrategyType::NCCL)
     {
         runtimeStrategy = AllReduceStrategyType::NCCL;
     }
     else
     {
-        runtimeStrategy = selectImplementation(size, mGroup.size(), mType);
+        isNvlsAvailable = hasNvlsBuffer(inputDesc[1], inputs[1], mGroup.size());
+        bool const isHierarchicalAvailable
+            = mInterNodeNcclComm != nullptr && hasNodeBuffers(inputs[1], tpRank % mNodeGroupSize);
+        runtimeStrategy = selectImplementation(
+            size, mGroup.size(), mType, isNvlsAvailable, isHierarchicalAvailable, runtimeConfig);
     }
 
     // Log runtime strategy
-    auto const rank = COMM_SESSION.getRank();
     switch (runtimeStrategy)
     {
     case AllReduceStrategyType::NCCL:
@@ -261,14 +366,34 @@ int AllreducePlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfe
         TLLM_LOG_DEBUG("AllReducePlugin strategy for rank %d: TWOSHOT", rank);
         break;
     }
+    case AllReduceStrategyType::NVLS:
+    {
+        TLLM_LOG_DEBUG("AllReducePlugin strategy for rank %d: NVLS", rank);
+        break;
+    }
+    case AllReduceStrategyType::HIERARCHICAL:
+    {
+        TLLM_LOG_DEBUG("AllReducePlugin strategy for rank %d: HIERARCHICAL", rank);
+        break;
+    }
     default: break;
     }
 
-    if (runtimeStrategy == AllReduceStrategyType::NCCL)
+    if (runtimeStrategy == AllReduceStrategyType::NCCL || runtimeStrategy == AllReduceStrategyType::HIERARCHICAL)
     {
-        if (mOp == AllReduceFusionOp::RESIDUAL_RMS_NORM)
+        // The fusions all-reduce into the intermediate output and run the norm on it afterwards.
+        void* allReduceOutput = mOp != AllReduceFusionOp::NONE ? outputs[1] : outputs[0];
+        if (runtimeStrategy == AllReduceStrategyType::NCCL)
+        {
+            NCCLCHECK(ncclAllReduce(inputs[0], allReduceOutput, size, (*getDtypeMap())[mType], ncclSum,
+                getLaneComm(mGroup, mNcclComm, mLaneNcclComm), stream));
+        }
+        else
+        {
+            runHierarchicalAllReduce(inputs[0], allReduceOutput, size, inputs[1], tpRank, stream);
+        }
+        if (mOp != AllReduceFusionOp::NONE)
         {
-            NCCLCHECK(ncclAllReduce(inputs[0], outputs[1], size, (*getDtypeMap())[mType], ncclSum, *mNcclComm, stream));
             tensorrt_llm::kernels::AllReduceParams params;
             int fusion_ptr_idx = 0;
             if (mStrategy == AllReduceStrategyType::NCCL)
@@ -287,31 +412,21 @@ int AllreducePlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfe
             params.fusion_params.hidden_size = inputDesc[0].dims.d[inputDesc[0].dims.nbDims - 1];
             params.fusion_params.eps = mEps;
             params.fusion_params.intermediate_buffer = outputs[1];
-            tensorrt_llm::kernels::residualRmsNorm(params, mType, stream);
-        }
-        else
-        {
-            NCCLCHECK(ncclAllReduce(inputs[0], outputs[0], size, (*getDtypeMap())[mType], ncclSum, *mNcclComm, stream));
+            params.fusion_params.scale_out_buffer
+                = kernels::isQuantFusionOp(mOp) ? reinterpret_cast<float*>(outputs[2]) : nullptr;
+            tensorrt_llm::kernels::residualRmsNorm(params, mType, mOp, stream);
         }
     }
     else
     {
         auto const tpSize = mGroup.size();
-        int tpRank = 0;
-        for (auto const& currentRank : mGroup)
-        {
-            if (rank == currentRank)
-                break;
-            ++tpRank;
-        }
-
         auto params = tensorrt_llm::kernels::AllReduceParams::deserialize(
-            reinterpret_cast<int64_t*>(const_cast<void*>(inputs[1])), tpSize, tpRank);
+            reinterpret_cast<int64_t*>(const_cast<void*>(inputs[1])), tpSize, tpRank, isNvlsAvailable);
 
         params.local_output_buffer_ptr = outputs[0];
         params.local_input_buffer_ptr = inputs[0];
         params.elts_total = size;
-        if (mOp == AllReduceFusionOp::RESIDUAL_RMS_NORM)
+        if (mOp != AllReduceFusionOp::NONE)
         {
             int fusion_ptr_idx = 2;
             params.fusion_params.bias_buffer = mBias ? inputs[fusion_ptr_idx++] : nullptr;
@@ -320,8 +435,10 @@ int AllreducePlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfe
             params.fusion_params.hidden_size = inputDesc[0].dims.d[inputDesc[0].dims.nbDims - 1];
             params.fusion_params.eps = mEps;
             params.fusion_params.intermediate_buffer = outputs[1];
+            params.fusion_params.scale_out_buffer
+                = kernels::isQuantFusionOp(mOp) ? reinterpret_cast<float*>(outputs[2]) : nullptr;
         }
-        tensorrt_llm::kernels::customAllReduce(params, mType, runtimeStrategy, mConfig, mOp, stream);
+        tensorrt_llm::kernels::customAllReduce(params, mType, runtimeStrategy, runtimeConfig, mOp, stream);
     }
 
     return 0;
@@ -331,8 +448,20 @@ int AllreducePlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfe
 nvinfer1::DataType AllreducePlugin::getOutputDataType(
     int index, nvinfer1::DataType const* inputTypes, int nbInputs) const noexcept
 {
-    int fusion_op_extra_output = (mOp == AllReduceFusionOp::RESIDUAL_RMS_NORM ? 1 : 0);
-    assert(index <= fusion_op_extra_output);
+    assert(index < getNbOutputs());
+    // The quantized fusion ops output the quantized normed activations, the new residual and the per token scales.
+    if (index == 0 && mOp == AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_FP8)
+    {
+        return nvinfer1::DataType::kFP8;
+    }
+    if (index == 0 && mOp == AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_INT8)
+    {
+        return nvinfer1::DataType::kINT8;
+    }
+    if (index == 2)
+    {
+        return nvinfer1::DataType::kFLOAT;
+    }
     return inputTypes[0];
 }
 
@@ -350,7 +479,11 @@ char const* AllreducePlugin::getPluginVersion() const noexcept
 
 int AllreducePlugin::getNbOutputs() const noexcept
 {
-    return (mOp == AllReduceFusionOp::RESIDUAL_RMS_NORM ? 2 : 1);
+    if (mOp == AllReduceFusionOp::NONE)
+    {
+        return 1;
+    }
+    return kernels::isQuantFusionOp(mOp) ? 3 : 2;
 }
 
 bool AllreducePlugin::isCustomAllReduceSupported(int ranks_per_node) const noexcept
@@ -447,16 +580,17 @@ std::set<int> getLocalGroup(std::set<int> const& group)
 
 void AllreducePlugin::initGroupTopology() noexcept
 {
-    static std::map<std::set<int>, std::tuple<bool, bool>> cache;
+    static std::map<std::set<int>, std::tuple<bool, bool, int>> cache;
     if (cache.find(mGroup) != cache.end())
     {
-        auto [isNVLINKSupported, isP2PSupported] = cache[mGroup];
+        auto [isNVLINKSupported, isP2PSupported, nodeGroupSize] = cache[mGroup];
         mIsNVLINKSupported = isNVLINKSupported;
         mIsP2PSupported = isP2PSupported;
+        mNodeGroupSize = nodeGroupSize;
         return;
     }
     setGroupTopology();
-    cache[mGroup] = {mIsNVLINKSupported, mIsP2PSupported};
+    cache[mGroup] = {mIsNVLINKSupported, mIsP2PSupported, mNodeGroupSize};
 }
 
 void AllreducePlugin::setGroupTopology() noexcept
@@ -464,6 +598,7 @@ void AllreducePlugin::setGroupTopology() noexcept
     auto const rank = COMM_SESSION.getRank();
     TLLM_LOG_INFO("Detecting local TP group for rank %d", rank);
     std::set<int> localGroup = getLocalGroup(mGroup);
+    mNodeGroupSize = static_cast<int>(localGroup.size());
     if (mGroup.size() != localGroup.size())
     {
         mIsP2PSupported = false;
@@ -581,6 +716,22 @@ int AllreducePlugin::initialize() noexcept
     {
         initGroupTopology();
     }
+    // The nodes must hold equally many ranks of the group, in the order of the group, as in AllReduceBuffers.
+    auto const groupSize = static_cast<int>(mGroup.size());
+    if (mStrategy == AllReduceStrategyType::HIERARCHICAL && mNodeGroupSize < groupSize
+        && groupSize % mNodeGroupSize == 0)
+    {
+        auto const rank = COMM_SESSION.getRank();
+        std::vector<int> const groupRanks(mGroup.begin(), mGroup.end());
+        auto const tpRank
+            = static_cast<int>(std::find(groupRanks.begin(), groupRanks.end(), rank) - groupRanks.begin());
+        std::set<int> interNodeGroup;
+        for (int i = tpRank % mNodeGroupSize; i < groupSize; i += mNodeGroupSize)
+        {
+            interNodeGroup.insert(groupRanks[i]);
+        }
+        mInterNodeNcclComm = getComm(interNodeGroup);
+    }
 
     TLLM_LOG_TRACE("%s stop for rank %d", __PRETTY_FUNCTION__, COMM_SESSION.getRank());
     return 0;
@@ -70,20 +70,29 @@ private:
     bool isCustomAllReduceSupported(int ranks_per_node) const noexcept;
     void initGroupTopology() noexcept;
     void setGroupTopology() noexcept;
-    kernels::AllReduceStrategyType selectImplementation(
-        size_t messageSize, int worldSize, nvinfer1::DataType type) noexcept;
+    //! Also sets config to the AllReduceStrategyConfig to run the returned strategy with.
+    kernels::AllReduceStrategyType selectImplementation(size_t messageSize, int worldSize, nvinfer1::DataType type,
+        bool isNvlsAvailable, bool isHierarchicalAvailable, kernels::AllReduceStrategyConfig& config) noexcept;
+    void runHierarchicalAllReduce(
+        void const* input, void* output, size_t size, void const* workspace, int tpRank, cudaStream_t stream);
 
 private:
     std::string const mLayerName;
     std::set<int> mGroup;
     bool mIsNVLINKSupported;
     bool mIsP2PSupported;
+    // The number of ranks of the group on this node, below the group size when it spans nodes.
+    int mNodeGroupSize{0};
     nvinfer1::DataType mType;
     kernels::AllReduceStrategyType mStrategy;
     kernels::AllReduceStrategyConfig mConfig;
     kernels::AllReduceFusionOp mOp;
     float mEps;
     std::shared_ptr<ncclComm_t> mNcclComm;
+    // Communicator of the second communication lane, see getLaneComm
+    std::shared_ptr<ncclComm_t> mLaneNcclComm;
+    // The ranks with the same rank within their node, one per node, for the HIERARCHICAL strategy.
+    std::shared_ptr<ncclComm_t> mInterNodeNcclComm;
     int8_t mAffine;
     int8_t mBias;
 };
@@ -0,0 +1,445 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "gemmAllReducePlugin.h"
+
+#include "tensorrt_llm/common/customAllReduceUtils.h"
+#include "tensorrt_llm/common/dataType.h"
+#include "tensorrt_llm/common/mpiUtils.h"
+
+#include <nccl.h>
+
+using namespace nvinfer1;
+using tensorrt_llm::plugins::GemmAllReducePluginCreator;
+using tensorrt_llm::plugins::GemmAllReducePlugin;
+using tensorrt_llm::kernels::AllReduceFusionOp;
+using tensorrt_llm::kernels::AllReduceStrategyType;
+using tensorrt_llm::kernels::AllReduceStrategyConfig;
+
+static char const* GEMM_ALLREDUCE_PLUGIN_VERSION{"1"};
+static char const* GEMM_ALLREDUCE_PLUGIN_NAME{"GemmAllReduce"};
+PluginFieldCollection GemmAllReducePluginCreator::mFC{};
+std::vector<nvinfer1::PluginField> GemmAllReducePluginCreator::mPluginAttributes;
+
+GemmAllReducePlugin::GemmAllReducePlugin(std::set<int> group, nvinfer1::DataType type,
+    AllReduceStrategyType strategy, AllReduceStrategyConfig config, int32_t numChunks)
+    : mGroup(std::move(group))
+    , mType(type)
+    , mStrategy(strategy)
+    , mConfig(config)
+    , mNumChunks(numChunks)
+{
+    TLLM_CHECK_WITH_INFO(mNumChunks >= 1 && mNumChunks <= kMaxNumChunks, "num_chunks must be in [1, %d], got %d",
+        kMaxNumChunks, mNumChunks);
+}
+
+// Parameterized constructor
+GemmAllReducePlugin::GemmAllReducePlugin(void const* data, size_t length)
+{
+    char const *d = reinterpret_cast<char const*>(data), *a = d;
+    read(d, mType);
+    read(d, mStrategy);
+    read(d, mConfig);
+    read(d, mNumChunks);
+    mGroup.clear();
+    int groupItem = 0;
+    while (d != a + length)
+    {
+        read(d, groupItem);
+        mGroup.insert(groupItem);
+    }
+    TLLM_CHECK_WITH_INFO(d == a + length,
+        "Expected length (%d) != real length (%d). This is often "
+        "caused by using different TensorRT-LLM version to build "
+        "engine and run engine.",
+        (int) length, (int) (d - a));
+}
+
+// IPluginV2DynamicExt Methods
+nvinfer1::IPluginV2DynamicExt* GemmAllReducePlugin::clone() const noexcept
+{
+    auto* plugin = new GemmAllReducePlugin(*this);
+    // The streams and events belong to this instance, the clone creates its own in initialize().
+    plugin->mCommStream = nullptr;
+    plugin->mChunkEvents.fill(nullptr);
+    plugin->mCommDoneEvent = nullptr;
+    plugin->setPluginNamespace(mNamespace.c_str());
+    return plugin;
+}
+
+nvinfer1::DimsExprs GemmAllReducePlugin::getOutputDimensions(
+    int outputIndex, nvinfer1::DimsExprs const* inputs, int nbInputs, nvinfer1::IExprBuilder& exprBuilder) noexcept
+{
+    try
+    {
+        TLLM_CHECK(outputIndex == 0);
+        DimsExprs ret = inputs[0];
+        ret.d[ret.nbDims - 1] = inputs[1].d[0];
+        return ret;
+    }
+    catch (std::exception const& e)
+    {
+        caughtError(e);
+    }
+    return DimsExprs{};
+}
+
+bool GemmAllReducePlugin::supportsFormatCombination(
+    int pos, nvinfer1::PluginTensorDesc const* inOut, int nbInputs, int nbOutputs) noexcept
+{
+    if (mStrategy == AllReduceStrategyType::NCCL)
+    {
+        TLLM_CHECK_WITH_INFO(nbInputs == 2, "NCCL strategy only accepts the activations and the weights.");
+    }
+    else
+    {
+        TLLM_CHECK_WITH_INFO(nbInputs == 3, "Non-NCCL strategies require a workspace tensor.");
+    }
+
+    if (mStrategy != AllReduceStrategyType::NCCL && pos == 2)
+    {
+        return (inOut[pos].type == nvinfer1::DataType::kINT64) && (inOut[pos].format == TensorFormat::kLINEAR);
+    }
+    return (inOut[pos].type == mType) && (inOut[pos].format == TensorFormat::kLINEAR);
+}
+
+void GemmAllReducePlugin::configurePlugin(nvinfer1::DynamicPluginTensorDesc const* in, int nbInputs,
+    nvinfer1::DynamicPluginTensorDesc const* out, int nbOutputs) noexcept
+{
+}
+
+size_t GemmAllReducePlugin::getWorkspaceSize(nvinfer1::PluginTensorDesc const* inputs, int nbInputs,
+    nvinfer1::PluginTensorDesc const* outputs, int nbOutputs) const noexcept
+{
+    // The GEMM writes to a staging buffer, the all-reduce reads from it and writes the output.
+    size_t m = 1;
+    for (int i = 0; i < inputs[0].dims.nbDims - 1; ++i)
+    {
+        m *= inputs[0].dims.d[i];
+    }
+    size_t const gemmOutputSize = common::getDTypeSize(mType) * m * inputs[1].dims.d[0];
+    std::vector<size_t> workspaces = {CUBLAS_WORKSPACE_SIZE, gemmOutputSize};
+    return common::calculateTotalWorkspaceSize(workspaces.data(), workspaces.size());
+}
+
+void GemmAllReducePlugin::setGemmConfig()
+{
+    if (mType == nvinfer1::DataType::kHALF)
+    {
+        mCublasWrapper->setFP16GemmConfig();
+    }
+    else if (mType == nvinfer1::DataType::kFLOAT)
+    {
+        mCublasWrapper->setFP32GemmConfig();
+    }
+#ifdef ENABLE_BF16
+    else if (mType == nvinfer1::DataType::kBF16)
+    {
+        mCublasWrapper->setBF16GemmConfig();
+    }
+#endif
+}
+
+void GemmAllReducePlugin::runGemm(
+    void const* act, void const* weight, void* out, int m, int n, int k, cudaStream_t stream)
+{
+    // out [m, n] = act [m, k] * weight [n, k]^T, computed column major as out^T = weight * act^T.
+    mCublasWrapper->setStream(stream);
+    mCublasWrapper->createDescriptors(CUBLAS_OP_T, CUBLAS_OP_N, n, m, k, k, k, n);
+    mCublasWrapper->Gemm(CUBLAS_OP_T, CUBLAS_OP_N, n, m, k, weight, k, act, k, out, n);
+    mCublasWrapper->destroyDescriptors();
+}
+
+void GemmAllReducePlugin::runAllReduce(
+    void const* input, void* output, size_t size, void const* allReduceWorkspace, cudaStream_t stream)
+{
+    auto const tpSize = mGroup.size();
+    bool useCustomAllReduce = mStrategy == AllReduceStrategyType::ONESHOT
+        || mStrategy == AllReduceStrategyType::TWOSHOT;
+    useCustomAllReduce = useCustomAllReduce && kernels::configurationSupported(mStrategy, size, tpSize, mType)
+        && size * common::getDTypeSize(mType)
+            <= tensorrt_llm::utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(static_cast<int>(tpSize));
+    if (!useCustomAllReduce)
+    {
+        NCCLCHECK(ncclAllReduce(input, output, size, (*getDtypeMap())[mType], ncclSum, *mNcclComm, stream));
+        return;
+    }
+
+    auto const rank = COMM_SESSION.getRank();
+    int tpRank = 0;
+    for (auto const& currentRank : mGroup)
+    {
+        if (rank == currentRank)
+            break;
+        ++tpRank;
+    }
+    // Every chunk takes the next barrier flag and thus alternates between the ping and the pong buffers.
+    auto params = tensorrt_llm::kernels::AllReduceParams::deserialize(
+        reinterpret_cast<int64_t*>(const_cast<void*>(allReduceWorkspace)), tpSize, tpRank);
+    params.local_output_buffer_ptr = output;
+    params.local_input_buffer_ptr = input;
+    params.elts_total = size;
+    tensorrt_llm::kernels::customAllReduce(params, mType, mStrategy, mConfig, AllReduceFusionOp::NONE, stream);
+}
+
+int GemmAllReducePlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
+    nvinfer1::PluginTensorDesc const* outputDesc, void const* const* inputs, void* const* outputs, void* workspace,
+    cudaStream_t stream) noexcept
+{
+    if (isBuilding())
+    {
+        return 0;
+    }
+    int m = 1;
+    for (int i = 0; i < inputDesc[0].dims.nbDims - 1; ++i)
+    {
+        m *= inputDesc[0].dims.d[i];
+    }
+    int const n = inputDesc[1].dims.d[0];
+    int const k = inputDesc[0].dims.d[inputDesc[0].dims.nbDims - 1];
+    if (m == 0)
+    {
+        return 0;
+    }
+
+    auto const elemSize = common::getDTypeSize(mType);
+    auto* gemmOutput = common::nextWorkspacePtr(reinterpret_cast<int8_t*>(workspace), CUBLAS_WORKSPACE_SIZE);
+    void const* allReduceWorkspace = mStrategy == AllReduceStrategyType::NCCL ? nullptr : inputs[2];
+    mCublasWrapper->setWorkspace(workspace);
+    setGemmConfig();
+
+    // The chunks split the rows evenly but keep at least kMinChunkRows rows each, decode sized GEMMs stay whole.
+    int const numChunks = std::max(1, std::min(mNumChunks, m / kMinChunkRows));
+    if (numChunks == 1)
+    {
+        runGemm(inputs[0], inputs[1], gemmOutput, m, n, k, stream);
+        runAllReduce(gemmOutput, outputs[0], static_cast<size_t>(m) * n, allReduceWorkspace, stream);
+        return 0;
+    }
+
+    int const chunkRows = common::divUp(m, numChunks);
+    for (int chunk = 0, rowOffset = 0; rowOffset < m; ++chunk, rowOffset += chunkRows)
+    {
+        int const rows = std::min(chunkRows, m - rowOffset);
+        auto const* chunkAct
+            = reinterpret_cast<int8_t const*>(inputs[0]) + static_cast<size_t>(rowOffset) * k * elemSize;
+        auto* chunkGemmOutput = gemmOutput + static_cast<size_t>(rowOffset) * n * elemSize;
+        auto* chunkOutput = reinterpret_cast<int8_t*>(outputs[0]) + static_cast<size_t>(rowOffset) * n * elemSize;
+
+        runGemm(chunkAct, inputs[1], chunkGemmOutput, rows, n, k, stream);
+        // The all-reduce of this chunk overlaps with the GEMM of the next one.
+        TLLM_CUDA_CHECK(cudaEventRecord(mChunkEvents[chunk], stream));
+        TLLM_CUDA_CHECK(cudaStreamWaitEvent(mCommStream, mChunkEvents[chunk]));
+        runAllReduce(chunkGemmOutput, chunkOutput, static_cast<size_t>(rows) * n, allReduceWorkspace, mCommStream);
+    }
+    TLLM_CUDA_CHECK(cudaEventRecord(mCommDoneEvent, mCommStream));
+    TLLM_CUDA_CHECK(cudaStreamWaitEvent(stream, mCommDoneEvent));
+    return 0;
+}
+
+// IPluginV2Ext Methods
+nvinfer1::DataType GemmAllReducePlugin::getOutputDataType(
+    int index, nvinfer1::DataType const* inputTypes, int nbInputs) const noexcept
+{
+    assert(index == 0);
+    return inputTypes[0];
+}
+
+// IPluginV2 Methods
+
+char const* GemmAllReducePlugin::getPluginType() const noexcept
+{
+    return GEMM_ALLREDUCE_PLUGIN_NAME;
+}
+
+char const* GemmAllReducePlugin::getPluginVersion() const noexcept
+{
+    return GEMM_ALLREDUCE_PLUGIN_VERSION;
+}
+
+int GemmAllReducePlugin::getNbOutputs() const noexcept
+{
+    return 1;
+}
+
+int GemmAllReducePlugin::initialize() noexcept
+{
+    if (isBuilding())
+    {
+        return 0;
+    }
+
+    TLLM_LOG_TRACE("%s start for rank %d", __PRETTY_FUNCTION__, COMM_SESSION.getRank());
+    mNcclComm = getComm(mGroup);
+    mCublasWrapper = getCublasMMWrapper(getCublasHandle(), getCublasLtHandle(), nullptr, nullptr);
+    if (mCommStream == nullptr)
+    {
+        TLLM_CUDA_CHECK(cudaStreamCreateWithFlags(&mCommStream, cudaStreamNonBlocking));
+        for (auto& event : mChunkEvents)
+        {
+            TLLM_CUDA_CHECK(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+        }
+        TLLM_CUDA_CHECK(cudaEventCreateWithFlags(&mCommDoneEvent, cudaEventDisableTiming));
+    }
+    TLLM_LOG_TRACE("%s stop for rank %d", __PRETTY_FUNCTION__, COMM_SESSION.getRank());
+    return 0;
+}
+
+void GemmAllReducePlugin::terminate() noexcept
+{
+    if (mCommStream != nullptr)
+    {
+        for (auto& event : mChunkEvents)
+        {
+            cudaEventDestroy(event);
+            event = nullptr;
+        }
+        cudaEventDestroy(mCommDoneEvent);
+        mCommDoneEvent = nullptr;
+        cudaStreamDestroy(mCommStream);
+        mCommStream = nullptr;
+    }
+}
+
+size_t GemmAllReducePlugin::getSerializationSize() const noexcept
+{
+    return sizeof(int) * mGroup.size() + sizeof(mType) + sizeof(mStrategy) + sizeof(mConfig) + sizeof(mNumChunks);
+}
+
+void GemmAllReducePlugin::serialize(void* buffer) const noexcept
+{
+    char *d = static_cast<char*>(buffer), *a = d;
+    write(d, mType);
+    write(d, mStrategy);
+    write(d, mConfig);
+    write(d, mNumChunks);
+    for (auto it = mGroup.begin(); it != mGroup.end(); ++it)
+    {
+        write(d, *it);
+    }
+    assert(d == a + getSerializationSize());
+}
+
+void GemmAllReducePlugin::destroy() noexcept
+{
+    // This gets called when the network containing plugin is destroyed
+    delete this;
+}
+
+///////////////
+
+GemmAllReducePluginCreator::GemmAllReducePluginCreator()
+{
+    // Fill PluginFieldCollection with PluginField arguments metadata
+    mPluginAttributes.clear();
+    mPluginAttributes.emplace_back(PluginField("group", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("type_id", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("strategy", nullptr, PluginFieldType::kINT8, 1));
+    mPluginAttributes.emplace_back(PluginField("config", nullptr, PluginFieldType::kINT8, 1));
+    mPluginAttributes.emplace_back(PluginField("num_chunks", nullptr, PluginFieldType::kINT32, 1));
+    mFC.nbFields = mPluginAttributes.size();
+    mFC.fields = mPluginAttributes.data();
+}
+
+char const* GemmAllReducePluginCreator::getPluginName() const noexcept
+{
+    return GEMM_ALLREDUCE_PLUGIN_NAME;
+}
+
+char const* GemmAllReducePluginCreator::getPluginVersion() const noexcept
+{
+    return GEMM_ALLREDUCE_PLUGIN_VERSION;
+}
+
+PluginFieldCollection const* GemmAllReducePluginCreator::getFieldNames() noexcept
+{
+    return &mFC;
+}
+
+IPluginV2* GemmAllReducePluginCreator::createPlugin(char const* name, PluginFieldCollection const* fc) noexcept
+{
+    PluginField const* fields = fc->fields;
+    std::set<int> group;
+    nvinfer1::DataType type;
+    AllReduceStrategyType strategy{AllReduceStrategyType::NCCL};
+    AllReduceStrategyConfig config{};
+    int32_t numChunks{4};
+    // Read configurations from each fields
+    for (int i = 0; i < fc->nbFields; ++i)
+    {
+        char const* attrName = fields[i].name;
+        if (!strcmp(attrName, "group"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            auto const* r = static_cast<int const*>(fields[i].data);
+            for (int j = 0; j < fields[i].length; ++j)
+            {
+                group.insert(*r);
+                ++r;
+            }
+        }
+        else if (!strcmp(attrName, "type_id"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            type = static_cast<nvinfer1::DataType>(*(static_cast<nvinfer1::DataType const*>(fields[i].data)));
+        }
+        else if (!strcmp(attrName, "strategy"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT8);
+            strategy = static_cast<AllReduceStrategyType>(*static_cast<int8_t const*>(fields[i].data));
+        }
+        else if (!strcmp(attrName, "config"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT8);
+            config = static_cast<AllReduceStrategyConfig>(*static_cast<int8_t const*>(fields[i].data));
+        }
+        else if (!strcmp(attrName, "num_chunks"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            numChunks = *static_cast<int32_t const*>(fields[i].data);
+        }
+    }
+
+    try
+    {
+        auto* obj = new GemmAllReducePlugin(group, type, strategy, config, numChunks);
+        obj->setPluginNamespace(mNamespace.c_str());
+        return obj;
+    }
+    catch (std::exception const& e)
+    {
+        caughtError(e);
+    }
+    return nullptr;
+}
+
+IPluginV2* GemmAllReducePluginCreator::deserializePlugin(
+    char const* name, void const* serialData, size_t serialLength) noexcept
+{
+    // This object will be deleted when the network is destroyed, which will
+    // call GemmAllReducePlugin::destroy()
+    try
+    {
+        auto* obj = new GemmAllReducePlugin(serialData, serialLength);
+        obj->setPluginNamespace(mNamespace.c_str());
+        return obj;
+    }
+    catch (std::exception const& e)
+    {
+        caughtError(e);
+    }
+    return nullptr;
+}
@@ -0,0 +1,128 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 1993-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "tensorrt_llm/common/cublasMMWrapper.h"
+#include "tensorrt_llm/kernels/customAllReduceKernels.h"
+#include "tensorrt_llm/plugins/common/plugin.h"
+
+#include <array>
+#include <cassert>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace tensorrt_llm::plugins
+{
+
+//! Row-parallel GEMM followed by an all-reduce of its output, with the two overlapped: the GEMM runs in chunks of
+//! rows and every finished chunk is all-reduced on a side stream while the next one is computed.
+//!
+//! inputs
+//!     act [M(*), K]
+//!     weight [N, K]
+//!     workspace: the AllReduceBuffers pointers, only for the custom all-reduce strategies
+//! outputs
+//!     out [M(*), N]
+class GemmAllReducePlugin : public BasePlugin
+{
+public:
+    //! The most chunks a GEMM is split into.
+    static constexpr int32_t kMaxNumChunks = 8;
+    //! Chunks get at least this many rows, smaller GEMMs run unchunked.
+    static constexpr int32_t kMinChunkRows = 64;
+
+    GemmAllReducePlugin(std::set<int> group, nvinfer1::DataType type, kernels::AllReduceStrategyType strategy,
+        kernels::AllReduceStrategyConfig config, int32_t numChunks);
+
+    GemmAllReducePlugin(void const* data, size_t length);
+
+    ~GemmAllReducePlugin() override = default;
+
+    // IPluginV2DynamicExt Methods
+    nvinfer1::IPluginV2DynamicExt* clone() const noexcept override;
+    nvinfer1::DimsExprs getOutputDimensions(int outputIndex, nvinfer1::DimsExprs const* inputs, int nbInputs,
+        nvinfer1::IExprBuilder& exprBuilder) noexcept override;
+    bool supportsFormatCombination(
+        int pos, nvinfer1::PluginTensorDesc const* inOut, int nbInputs, int nbOutputs) noexcept override;
+    void configurePlugin(nvinfer1::DynamicPluginTensorDesc const* in, int nbInputs,
+        nvinfer1::DynamicPluginTensorDesc const* out, int nbOutputs) noexcept override;
+    size_t getWorkspaceSize(nvinfer1::PluginTensorDesc const* inputs, int nbInputs,
+        nvinfer1::PluginTensorDesc const* outputs, int nbOutputs) const noexcept override;
+    int enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::PluginTensorDesc const* outputDesc,
+        void const* const* inputs, void* const* outputs, void* workspace, cudaStream_t stream) noexcept override;
+
+    // IPluginV2Ext Methods
+    nvinfer1::DataType getOutputDataType(
+        int index, nvinfer1::DataType const* inputTypes, int nbInputs) const noexcept override;
+
+    // IPluginV2 Methods
+    char const* getPluginType() const noexcept override;
+    char const* getPluginVersion() const noexcept override;
+    int getNbOutputs() const noexcept override;
+    int initialize() noexcept override;
+    void terminate() noexcept override;
+    size_t getSerializationSize() const noexcept override;
+    void serialize(void* buffer) const noexcept override;
+    void destroy() noexcept override;
+
+private:
+    void setGemmConfig();
+
+    void runGemm(void const* act, void const* weight, void* out, int m, int n, int k, cudaStream_t stream);
+
+    void runAllReduce(void const* input, void* output, size_t size, void const* allReduceWorkspace,
+        cudaStream_t stream);
+
+private:
+    std::string const mLayerName;
+    std::set<int> mGroup;
+    nvinfer1::DataType mType;
+    kernels::AllReduceStrategyType mStrategy;
+    kernels::AllReduceStrategyConfig mConfig;
+    int32_t mNumChunks;
+
+    std::shared_ptr<ncclComm_t> mNcclComm;
+    std::shared_ptr<tensorrt_llm::common::CublasMMWrapper> mCublasWrapper;
+    cudaStream_t mCommStream{nullptr};
+    std::array<cudaEvent_t, kMaxNumChunks> mChunkEvents{};
+    cudaEvent_t mCommDoneEvent{nullptr};
+};
+
+class GemmAllReducePluginCreator : public BaseCreator
+{
+public:
+    GemmAllReducePluginCreator();
+
+    char const* getPluginName() const noexcept override;
+
+    char const* getPluginVersion() const noexcept override;
+
+    nvinfer1::PluginFieldCollection const* getFieldNames() noexcept override;
+
+    nvinfer1::IPluginV2* createPlugin(char const* name, nvinfer1::PluginFieldCollection const* fc) noexcept override;
+
+    nvinfer1::IPluginV2* deserializePlugin(
+        char const* name, void const* serialData, size_t serialLength) noexcept override;
+
+private:
+    static nvinfer1::PluginFieldCollection mFC;
+    static std::vector<nvinfer1::PluginField> mPluginAttributes;
+};
+
+} // namespace tensorrt_llm::plugins
@@ -102,8 +102,8 @@ int ReduceScatterPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
     }
 
     TLLM_CHECK_WITH_INFO(mNcclComm.get() != nullptr, "mNcclComm should be initialized before used");
-    NCCLCHECK(ncclReduceScatter(
-        inputs[0], outputs[0], size, (*getDtypeMap())[inputDesc[0].type], ncclSum, *mNcclComm, stream));
+    NCCLCHECK(ncclReduceScatter(inputs[0], outputs[0], size, (*getDtypeMap())[inputDesc[0].type], ncclSum,
+        getLaneComm(mGroup, mNcclComm, mLaneNcclComm), stream));
 
     return 0;
 }
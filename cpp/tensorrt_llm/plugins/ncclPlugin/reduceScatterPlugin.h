@@ -65,6 +65,8 @@ private:
     std::set<int> mGroup;
     nvinfer1::DataType mType;
     std::shared_ptr<ncclComm_t> mNcclComm;
+    // Communicator of the second communication lane, see getLaneComm
+    std::shared_ptr<ncclComm_t> mLaneNcclComm;
 };
 
 class ReduceScatterPluginCreator : public BaseCreator
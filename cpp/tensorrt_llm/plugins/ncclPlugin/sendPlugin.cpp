@@ -16,6 +16,9 @@
  */
 #include "sendPlugin.h"
 
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/dataType.h"
+#include "tensorrt_llm/common/envUtils.h"
 #include "tensorrt_llm/common/logger.h"
 #include "tensorrt_llm/common/mpiUtils.h"
 
@@ -54,6 +57,10 @@ SendPlugin::SendPlugin(void const* data, size_t length)
 nvinfer1::IPluginV2DynamicExt* SendPlugin::clone() const noexcept
 {
     auto* plugin = new SendPlugin(*this);
+    // The clone creates its own stream and buffers in initialize
+    plugin->mSendStream = nullptr;
+    plugin->mSlots = {};
+    plugin->mNextSlot = 0;
     plugin->setPluginNamespace(mNamespace.c_str());
     return plugin;
 }
@@ -94,9 +101,44 @@ int SendPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc, nvinfer1::P
         size *= inputDesc[0].dims.d[i];
     }
 
-    TLLM_LOG_DEBUG("start ncclSend with size %d", size);
-    NCCLCHECK(ncclSend(inputs[0], size, (*getDtypeMap())[inputDesc[0].type], 1, mComm, stream));
-    TLLM_LOG_DEBUG("end ncclSend with size %d", size);
+    // A stream being captured into a CUDA graph would have to join the send stream before the capture ends
+    cudaStreamCaptureStatus captureStatus{cudaStreamCaptureStatusNone};
+    TLLM_CUDA_CHECK(cudaStreamIsCapturing(stream, &captureStatus));
+    if (mSendStream == nullptr || captureStatus != cudaStreamCaptureStatusNone)
+    {
+        if (mSendStream != nullptr)
+        {
+            // Keep the sends of the communicator in order, a captured stream can't wait for events recorded outside
+            for (auto const& slot : mSlots)
+            {
+                TLLM_CUDA_CHECK(cudaEventSynchronize(slot.sent));
+            }
+        }
+        TLLM_LOG_DEBUG("start ncclSend with size %d", size);
+        NCCLCHECK(ncclSend(inputs[0], size, (*getDtypeMap())[inputDesc[0].type], 1, mComm, stream));
+        TLLM_LOG_DEBUG("end ncclSend with size %d", size);
+        return 0;
+    }
+
+    auto& slot = mSlots[mNextSlot];
+    mNextSlot = (mNextSlot + 1) % static_cast<int>(mSlots.size());
+    auto const bytes = size * tensorrt_llm::common::getDTypeSize(inputDesc[0].type);
+    if (slot.capacity < bytes)
+    {
+        // Grows during warmup only, the largest micro batch comes first
+        TLLM_CUDA_CHECK(cudaEventSynchronize(slot.sent));
+        TLLM_CUDA_CHECK(cudaFree(slot.buffer));
+        TLLM_CUDA_CHECK(cudaMalloc(&slot.buffer, bytes));
+        slot.capacity = bytes;
+    }
+    // The send of the micro batch before the previous one must be done with the slot
+    TLLM_CUDA_CHECK(cudaStreamWaitEvent(stream, slot.sent));
+    TLLM_CUDA_CHECK(cudaMemcpyAsync(slot.buffer, inputs[0], bytes, cudaMemcpyDeviceToDevice, stream));
+    TLLM_CUDA_CHECK(cudaEventRecord(slot.copied, stream));
+    TLLM_CUDA_CHECK(cudaStreamWaitEvent(mSendStream, slot.copied));
+    TLLM_LOG_DEBUG("start async ncclSend with size %d", size);
+    NCCLCHECK(ncclSend(slot.buffer, size, (*getDtypeMap())[inputDesc[0].type], 1, mComm, mSendStream));
+    TLLM_CUDA_CHECK(cudaEventRecord(slot.sent, mSendStream));
     return 0;
 }
 
@@ -136,6 +178,15 @@ int SendPlugin::initialize() noexcept
     ncclGetUniqueId(&id);
     COMM_SESSION.sendValue(id, mTgtRank, 0);
     NCCLCHECK(ncclCommInitRank(&mComm, 2, id, 0));
+    if (tensorrt_llm::common::getEnvPipelineAsyncSend())
+    {
+        TLLM_CUDA_CHECK(cudaStreamCreateWithFlags(&mSendStream, cudaStreamNonBlocking));
+        for (auto& slot : mSlots)
+        {
+            TLLM_CUDA_CHECK(cudaEventCreateWithFlags(&slot.copied, cudaEventDisableTiming));
+            TLLM_CUDA_CHECK(cudaEventCreateWithFlags(&slot.sent, cudaEventDisableTiming));
+        }
+    }
     return 0;
 }
 
@@ -145,9 +196,28 @@ void SendPlugin::terminate() noexcept
     {
         return;
     }
+    releaseAsyncSend();
     NCCLCHECK(ncclCommDestroy(mComm));
 }
 
+void SendPlugin::releaseAsyncSend() noexcept
+{
+    if (mSendStream == nullptr)
+    {
+        return;
+    }
+    TLLM_CUDA_CHECK(cudaStreamSynchronize(mSendStream));
+    for (auto& slot : mSlots)
+    {
+        TLLM_CUDA_CHECK(cudaFree(slot.buffer));
+        TLLM_CUDA_CHECK(cudaEventDestroy(slot.copied));
+        TLLM_CUDA_CHECK(cudaEventDestroy(slot.sent));
+        slot = AsyncSendSlot{};
+    }
+    TLLM_CUDA_CHECK(cudaStreamDestroy(mSendStream));
+    mSendStream = nullptr;
+}
+
 size_t SendPlugin::getSerializationSize() const noexcept
 {
     return sizeof(mTgtRank) + sizeof(mType);
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "tensorrt_llm/plugins/common/plugin.h"
+#include <array>
 #include <string>
 #include <vector>
 
@@ -60,9 +61,26 @@ public:
     void destroy() noexcept override;
 
 private:
+    //! \brief A copy of the activations being sent on mSendStream, TensorRT may reuse the input once enqueue returns.
+    struct AsyncSendSlot
+    {
+        void* buffer{nullptr};
+        size_t capacity{0};
+        cudaEvent_t copied{nullptr};
+        cudaEvent_t sent{nullptr};
+    };
+
+    void releaseAsyncSend() noexcept;
+
     ncclComm_t mComm; // TODO: Remove this
     int mTgtRank;
     nvinfer1::DataType mType;
+
+    // With TRTLLM_PP_ASYNC_SEND, the send of a micro batch overlaps the compute of the next one. Two slots, so that
+    // the copy of a micro batch does not wait for the send of the previous one.
+    cudaStream_t mSendStream{nullptr};
+    std::array<AsyncSendSlot, 2> mSlots{};
+    int mNextSlot{0};
 };
 
 class SendPluginCreator : public BaseCreator
@@ -28,15 +28,19 @@ static char const* QUANTIZE_PER_TOKEN_PLUGIN_NAME{"QuantizePerToken"};
 PluginFieldCollection QuantizePerTokenPluginCreator::mFC{};
 std::vector<nvinfer1::PluginField> QuantizePerTokenPluginCreator::mPluginAttributes;
 
-QuantizePerTokenPlugin::QuantizePerTokenPlugin(nvinfer1::DataType outputType, QuantMode quantMode, bool clampValEnabled)
+QuantizePerTokenPlugin::QuantizePerTokenPlugin(
+    nvinfer1::DataType outputType, QuantMode quantMode, bool clampValEnabled, int32_t groupSize)
     : mOutputType{outputType}
     , mQuantMode{quantMode}
     , mClampValEnabled{clampValEnabled}
+    , mGroupSize{groupSize}
 {
     TLLM_CHECK_WITH_INFO(mOutputType == nvinfer1::DataType::kINT8 || mOutputType == nvinfer1::DataType::kFP8,
         "Only int8 or fp8 output type is allowed.");
     // Check if the quant mode is valid.
     TLLM_CHECK_WITH_INFO(mQuantMode.hasPerTokenScaling(), "The quant mode is not valid.");
+    TLLM_CHECK_WITH_INFO(mGroupSize == 0 || (mGroupSize % 32 == 0 && !mClampValEnabled),
+        "Group quantization needs a multiple of 32 as group size and no clamping.");
 }
 
 // Parameterized constructor
@@ -46,6 +50,7 @@ QuantizePerTokenPlugin::QuantizePerTokenPlugin(void const* data, size_t length)
     read(d, mOutputType);
     read(d, mQuantMode);
     read(d, mClampValEnabled);
+    read(d, mGroupSize);
     TLLM_CHECK_WITH_INFO(d == a + length,
         "Expected length (%d) != real length (%d). This is often "
         "caused by using different TensorRT-LLM version to build "
@@ -56,7 +61,7 @@ QuantizePerTokenPlugin::QuantizePerTokenPlugin(void const* data, size_t length)
 // IPluginV2DynamicExt Methods
 nvinfer1::IPluginV2DynamicExt* QuantizePerTokenPlugin::clone() const noexcept
 {
-    auto* plugin = new QuantizePerTokenPlugin(mOutputType, mQuantMode, mClampValEnabled);
+    auto* plugin = new QuantizePerTokenPlugin(mOutputType, mQuantMode, mClampValEnabled, mGroupSize);
     plugin->setPluginNamespace(mNamespace.c_str());
     return plugin;
 }
@@ -80,6 +85,13 @@ nvinfer1::DimsExprs QuantizePerTokenPlugin::getOutputDimensions(
         {
             ret.d[ii] = inputs[0].d[ii];
         }
+        if (mGroupSize > 0)
+        {
+            // [M(*), K / groupSize] dynamic per token group scales
+            ret.d[ret.nbDims - 1] = exprBuilder.operation(DimensionOperation::kFLOOR_DIV,
+                *inputs[0].d[inputs[0].nbDims - 1], *exprBuilder.constant(mGroupSize));
+            return ret;
+        }
         ret.d[ret.nbDims - 1] = exprBuilder.constant(1);
         // [M(*), 1] dynamic per token scales
         return ret;
@@ -145,8 +157,14 @@ void QuantizePerTokenPlugin::dispatchDataType(void* output, void const* input, v
     //     clamp_value    [2], contains min val, and max val (optional)
     // outputs
     //     quant          [dim0(*), dim1]
-    //     scale_tokens   [dim0(*), 1]
+    //     scale_tokens   [dim0(*), 1], [dim0(*), dim1 / groupSize] with groups
 
+    if (mGroupSize > 0)
+    {
+        invokePerTokenGroupQuantization(reinterpret_cast<QuantT*>(output), reinterpret_cast<T const*>(input), dim0,
+            dim1, mGroupSize, reinterpret_cast<float*>(scalePtr), stream);
+        return;
+    }
     invokePerTokenQuantization(reinterpret_cast<QuantT*>(output), reinterpret_cast<T const*>(input), dim0, dim1,
         reinterpret_cast<float const*>(clampValPtr), reinterpret_cast<float*>(scalePtr), mQuantMode, stream);
 }
@@ -242,7 +260,7 @@ void QuantizePerTokenPlugin::terminate() noexcept {}
 
 size_t QuantizePerTokenPlugin::getSerializationSize() const noexcept
 {
-    return sizeof(mOutputType) + sizeof(mQuantMode) + sizeof(mClampValEnabled);
+    return sizeof(mOutputType) + sizeof(mQuantMode) + sizeof(mClampValEnabled) + sizeof(mGroupSize);
 }
 
 void QuantizePerTokenPlugin::serialize(void* buffer) const noexcept
@@ -251,6 +269,7 @@ void QuantizePerTokenPlugin::serialize(void* buffer) const noexcept
     write(d, mOutputType);
     write(d, mQuantMode);
     write(d, mClampValEnabled);
+    write(d, mGroupSize);
     assert(d == a + getSerializationSize());
 }
 
@@ -269,6 +288,7 @@ QuantizePerTokenPluginCreator::QuantizePerTokenPluginCreator()
     mPluginAttributes.emplace_back(PluginField("type_id", nullptr, PluginFieldType::kINT32, 3));
     mPluginAttributes.emplace_back(PluginField("quant_mode", nullptr, PluginFieldType::kINT32, 0));
     mPluginAttributes.emplace_back(PluginField("clamp_enabled", nullptr, PluginFieldType::kINT8, 0));
+    mPluginAttributes.emplace_back(PluginField("group_size", nullptr, PluginFieldType::kINT32, 0));
     mFC.nbFields = mPluginAttributes.size();
     mFC.fields = mPluginAttributes.data();
 }
@@ -295,7 +315,8 @@ IPluginV2* QuantizePerTokenPluginCreator::createPlugin(char const* name, PluginF
     {
         auto* obj = new QuantizePerTokenPlugin(static_cast<nvinfer1::DataType>(p.getScalar<int32_t>("type_id").value()),
             QuantMode(p.getScalar<int32_t>("quant_mode").value()),
-            static_cast<bool>(p.getScalar<int8_t>("clamp_enabled").value()));
+            static_cast<bool>(p.getScalar<int8_t>("clamp_enabled").value()),
+            p.getScalar<int32_t>("group_size").value_or(0));
         obj->setPluginNamespace(mNamespace.c_str());
         return obj;
     }
@@ -30,8 +30,8 @@ namespace tensorrt_llm::plugins
 class QuantizePerTokenPlugin : public BasePlugin
 {
 public:
-    QuantizePerTokenPlugin(
-        nvinfer1::DataType outputType, tensorrt_llm::common::QuantMode quantMode, bool clampValEnabled);
+    QuantizePerTokenPlugin(nvinfer1::DataType outputType, tensorrt_llm::common::QuantMode quantMode,
+        bool clampValEnabled, int32_t groupSize = 0);
 
     QuantizePerTokenPlugin(void const* data, size_t length);
 
@@ -76,6 +76,8 @@ private:
     tensorrt_llm::common::QuantMode mQuantMode;
     // Do we clamp the input tensor ?
     bool mClampValEnabled;
+    // Quantize groups of that many columns of a token with their own scales, 0 for a single scale per token.
+    int32_t mGroupSize;
 };
 
 class QuantizePerTokenPluginCreator : public BaseCreator
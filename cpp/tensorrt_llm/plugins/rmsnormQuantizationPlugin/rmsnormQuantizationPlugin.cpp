@@ -30,13 +30,16 @@ PluginFieldCollection RmsnormQuantizationPluginCreator::mFC{};
 std::vector<nvinfer1::PluginField> RmsnormQuantizationPluginCreator::mPluginAttributes;
 
 RmsnormQuantizationPlugin::RmsnormQuantizationPlugin(float eps, bool dynamicActivationScaling, bool clampValEnabled,
-    QuantMode quantMode, nvinfer1::DataType type, nvinfer1::DataType outputType)
+    QuantMode quantMode, nvinfer1::DataType type, nvinfer1::DataType outputType, bool residualEnabled,
+    bool preQuantScaleEnabled)
     : mEps(eps)
     , mDynActScaling(dynamicActivationScaling)
     , mClampValEnabled{clampValEnabled}
     , mQuantMode{quantMode}
     , mType(type)
     , mOutputType{outputType}
+    , mResidualEnabled{residualEnabled}
+    , mPreQuantScaleEnabled{preQuantScaleEnabled}
 {
     TLLM_CHECK_WITH_INFO(mOutputType == nvinfer1::DataType::kINT8 || mOutputType == nvinfer1::DataType::kFP8,
         "Only int8 or fp8 output type is allowed.");
@@ -54,6 +57,12 @@ RmsnormQuantizationPlugin::RmsnormQuantizationPlugin(void const* data, size_t le
     read(d, mQuantMode);
     read(d, mType);
     read(d, mOutputType);
+    // Engines built before the fused residual and pre-quant scale do not serialize them
+    if (d != a + length)
+    {
+        read(d, mResidualEnabled);
+        read(d, mPreQuantScaleEnabled);
+    }
     TLLM_CHECK_WITH_INFO(d == a + length,
         "Expected length (%d) != real length (%d). This is often "
         "caused by using different TensorRT-LLM version to build "
@@ -64,8 +73,8 @@ RmsnormQuantizationPlugin::RmsnormQuantizationPlugin(void const* data, size_t le
 // IPluginV2DynamicExt Methods
 nvinfer1::IPluginV2DynamicExt* RmsnormQuantizationPlugin::clone() const noexcept
 {
-    auto* plugin
-        = new RmsnormQuantizationPlugin(mEps, mDynActScaling, mClampValEnabled, mQuantMode, mType, mOutputType);
+    auto* plugin = new RmsnormQuantizationPlugin(mEps, mDynActScaling, mClampValEnabled, mQuantMode, mType,
+        mOutputType, mResidualEnabled, mPreQuantScaleEnabled);
     plugin->setPluginNamespace(mNamespace.c_str());
     return plugin;
 }
@@ -73,16 +82,16 @@ nvinfer1::IPluginV2DynamicExt* RmsnormQuantizationPlugin::clone() const noexcept
 nvinfer1::DimsExprs RmsnormQuantizationPlugin::getOutputDimensions(
     int outputIndex, nvinfer1::DimsExprs const* inputs, int nbInputs, nvinfer1::IExprBuilder& exprBuilder) noexcept
 {
-    if (outputIndex == 0)
+    if (outputIndex == 0 || outputIndex == 1 + static_cast<int>(mDynActScaling))
     {
-        // Quantized output
-        return inputs[outputIndex];
+        // Quantized output, or the sum of input and residual
+        return inputs[0];
     }
 
     // Dynamic scaling output if enabled
     try
     {
-        TLLM_CHECK(outputIndex == 1);
+        TLLM_CHECK(outputIndex == 1 && mDynActScaling);
         DimsExprs ret;
         ret.nbDims = inputs[0].nbDims;
         for (int di = 0; di < ret.nbDims - 1; ++di)
@@ -102,9 +111,10 @@ nvinfer1::DimsExprs RmsnormQuantizationPlugin::getOutputDimensions(
 bool RmsnormQuantizationPlugin::supportsFormatCombination(
     int pos, nvinfer1::PluginTensorDesc const* inOut, int nbInputs, int nbOutputs) noexcept
 {
-    int const totalPoses = 6 + static_cast<int>(mClampValEnabled) + static_cast<int>(mDynActScaling);
-    TLLM_CHECK(0 <= pos && pos < totalPoses);
-    TLLM_CHECK(nbInputs == 4 + static_cast<int>(mClampValEnabled));
+    int const expectedNbInputs = 4 + static_cast<int>(mClampValEnabled) + static_cast<int>(mResidualEnabled)
+        + static_cast<int>(mPreQuantScaleEnabled);
+    TLLM_CHECK(0 <= pos && pos < expectedNbInputs + getNbOutputs());
+    TLLM_CHECK(nbInputs == expectedNbInputs);
     if (pos < nbInputs)
     {
         if (pos < 3)
@@ -122,17 +132,24 @@ bool RmsnormQuantizationPlugin::supportsFormatCombination(
             // clamp_max_v
             return inOut[pos].type == nvinfer1::DataType::kFLOAT && inOut[pos].format == TensorFormat::kLINEAR;
         }
+        // residual, pre_quant_scale
+        return (inOut[pos].type == mType) && (inOut[pos].format == TensorFormat::kLINEAR);
     }
-    else if (pos == 4 + int(mClampValEnabled))
+    else if (pos == nbInputs)
     {
         // Quantized output
         return (inOut[pos].type == mOutputType) && (inOut[pos].format == TensorFormat::kLINEAR);
     }
-    else if (pos == 5 + int(mClampValEnabled))
+    else if (pos == nbInputs + 1 && mDynActScaling)
     {
         // Dynamic scaling if enabled
         return (inOut[pos].type == nvinfer1::DataType::kFLOAT) && (inOut[pos].format == TensorFormat::kLINEAR);
     }
+    else if (mResidualEnabled)
+    {
+        // Sum of input and residual
+        return (inOut[pos].type == mType) && (inOut[pos].format == TensorFormat::kLINEAR);
+    }
 
     // Never should be here
     TLLM_CHECK_WITH_INFO(false, "The input/output is not supported.");
@@ -153,19 +170,25 @@ size_t RmsnormQuantizationPlugin::getWorkspaceSize(nvinfer1::PluginTensorDesc co
 template <typename T, typename QuantT>
 void RmsnormQuantizationPlugin::dispatchDataType(void* out, void const* input, void const* gamma, void const* beta,
     float const eps, int const tokens, int const hidden_dim, cudaStream_t stream, void const* clampValPtr,
-    void const* scale, void* dynamic_scale, void* normed_output_quant) noexcept
+    void const* scale, void* dynamic_scale, void* normed_output_quant, void const* residual, void* residual_out,
+    void const* pre_quant_scale) noexcept
 {
     // inputs
-    //     activation     [dim0(*), dim1]
-    //     clamp_value    [2], contains min val, and max val (optional)
+    //     activation       [dim0(*), dim1]
+    //     clamp_value      [2], contains min val, and max val (optional)
+    //     residual         [dim0(*), dim1] (optional)
+    //     pre_quant_scale  [dim1] (optional)
     // outputs
-    //     quant          [dim0(*), dim1]
-    //     scale_tokens   [dim0(*), 1]
+    //     quant            [dim0(*), dim1]
+    //     scale_tokens     [dim0(*), 1]
+    //     residual_out     [dim0(*), dim1] (optional)
 
     invokeGeneralRmsNorm(reinterpret_cast<T*>(out), reinterpret_cast<T const*>(input),
         reinterpret_cast<T const*>(gamma), reinterpret_cast<T const*>(beta), eps, tokens, hidden_dim, mQuantMode,
         stream, reinterpret_cast<float const*>(clampValPtr), reinterpret_cast<float const*>(scale),
-        reinterpret_cast<float*>(dynamic_scale), reinterpret_cast<QuantT*>(normed_output_quant));
+        reinterpret_cast<float*>(dynamic_scale), reinterpret_cast<QuantT*>(normed_output_quant),
+        reinterpret_cast<T const*>(residual), reinterpret_cast<T*>(residual_out),
+        reinterpret_cast<T const*>(pre_quant_scale));
 }
 
 int RmsnormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDesc,
@@ -178,9 +201,12 @@ int RmsnormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDe
     //     bias [N, ]
     //     scale_to_int [1]
     //     clamp_value [2], contains min val, and max val (optional)
+    //     residual [M(*), N] (optional)
+    //     pre_quant_scale [N, ] (optional)
     // outputs
     //     output [M(*), N]
     //     dynamic_scaling [M(*), 1] (optional output)
+    //     residual_out [M(*), N], input + residual (optional output)
 
     int64_t m64 = 1;
     for (int i = 0; i < inputDesc[0].dims.nbDims - 1; ++i)
@@ -194,45 +220,56 @@ int RmsnormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDe
     void const* weight = inputs[1];
     void const* bias = inputs[2];
     void const* scale = inputs[3];
+    int const residualIdx = 4 + static_cast<int>(mClampValEnabled);
+    int const preQuantScaleIdx = residualIdx + static_cast<int>(mResidualEnabled);
     void const* clampValPtr = mClampValEnabled ? inputs[4] : nullptr;
+    void const* residual = mResidualEnabled ? inputs[residualIdx] : nullptr;
+    void const* preQuantScale = mPreQuantScaleEnabled ? inputs[preQuantScaleIdx] : nullptr;
     void* output = outputs[0];
     void* dynamic_scale = mDynActScaling ? outputs[1] : nullptr;
+    void* residualOut = mResidualEnabled ? outputs[1 + static_cast<int>(mDynActScaling)] : nullptr;
 
     if (inputDesc[0].type == DataType::kFLOAT && mOutputType == DataType::kINT8)
     {
         dispatchDataType<float, int8_t>(
-            nullptr, input, weight, bias, mEps, m, n, stream, clampValPtr, scale, dynamic_scale, output);
+            nullptr, input, weight, bias, mEps, m, n, stream, clampValPtr, scale, dynamic_scale, output,
+            residual, residualOut, preQuantScale);
     }
 #ifdef ENABLE_FP8
     else if (inputDesc[0].type == DataType::kFLOAT && mOutputType == DataType::kFP8)
     {
         dispatchDataType<float, __nv_fp8_e4m3>(
-            nullptr, input, weight, bias, mEps, m, n, stream, clampValPtr, scale, dynamic_scale, output);
+            nullptr, input, weight, bias, mEps, m, n, stream, clampValPtr, scale, dynamic_scale, output,
+            residual, residualOut, preQuantScale);
     }
 #endif // ENABLE_FP8
     else if (inputDesc[0].type == DataType::kHALF && mOutputType == DataType::kINT8)
     {
         dispatchDataType<half, int8_t>(
-            nullptr, input, weight, bias, mEps, m, n, stream, clampValPtr, scale, dynamic_scale, output);
+            nullptr, input, weight, bias, mEps, m, n, stream, clampValPtr, scale, dynamic_scale, output,
+            residual, residualOut, preQuantScale);
     }
 #ifdef ENABLE_FP8
     else if (inputDesc[0].type == DataType::kHALF && mOutputType == DataType::kFP8)
     {
         dispatchDataType<half, __nv_fp8_e4m3>(
-            nullptr, input, weight, bias, mEps, m, n, stream, clampValPtr, scale, dynamic_scale, output);
+            nullptr, input, weight, bias, mEps, m, n, stream, clampValPtr, scale, dynamic_scale, output,
+            residual, residualOut, preQuantScale);
     }
 #endif // ENABLE_FP8
 #ifdef ENABLE_BF16
     else if (inputDesc[0].type == DataType::kBF16 && mOutputType == DataType::kINT8)
     {
         dispatchDataType<__nv_bfloat16, int8_t>(
-            nullptr, input, weight, bias, mEps, m, n, stream, clampValPtr, scale, dynamic_scale, output);
+            nullptr, input, weight, bias, mEps, m, n, stream, clampValPtr, scale, dynamic_scale, output,
+            residual, residualOut, preQuantScale);
     }
 #ifdef ENABLE_FP8
     else if (inputDesc[0].type == DataType::kBF16 && mOutputType == DataType::kFP8)
     {
         dispatchDataType<__nv_bfloat16, __nv_fp8_e4m3>(
-            nullptr, input, weight, bias, mEps, m, n, stream, clampValPtr, scale, dynamic_scale, output);
+            nullptr, input, weight, bias, mEps, m, n, stream, clampValPtr, scale, dynamic_scale, output,
+            residual, residualOut, preQuantScale);
     }
 #endif // ENABLE_FP8
 #endif // ENABLE_BF16
@@ -244,14 +281,19 @@ int RmsnormQuantizationPlugin::enqueue(nvinfer1::PluginTensorDesc const* inputDe
 nvinfer1::DataType RmsnormQuantizationPlugin::getOutputDataType(
     int index, nvinfer1::DataType const* inputTypes, int nbInputs) const noexcept
 {
-    assert((mDynActScaling && index < 2) || (!mDynActScaling && index == 0));
+    assert(index < getNbOutputs());
     if (index == 0)
     {
         // Output 0 quantized output of layer norm
         return mOutputType;
     }
-    // Output 1 dynamic act scaling
-    return nvinfer1::DataType::kFLOAT;
+    if (index == 1 && mDynActScaling)
+    {
+        // Output 1 dynamic act scaling
+        return nvinfer1::DataType::kFLOAT;
+    }
+    // Last output, sum of input and residual
+    return mType;
 }
 
 // IPluginV2 Methods
@@ -268,7 +310,7 @@ char const* RmsnormQuantizationPlugin::getPluginVersion() const noexcept
 
 int RmsnormQuantizationPlugin::getNbOutputs() const noexcept
 {
-    return 1 + static_cast<int>(mDynActScaling);
+    return 1 + static_cast<int>(mDynActScaling) + static_cast<int>(mResidualEnabled);
 }
 
 int RmsnormQuantizationPlugin::initialize() noexcept
@@ -281,7 +323,7 @@ void RmsnormQuantizationPlugin::terminate() noexcept {}
 size_t RmsnormQuantizationPlugin::getSerializationSize() const noexcept
 {
     return sizeof(mOutputType) + sizeof(mClampValEnabled) + sizeof(mEps) + sizeof(mDynActScaling) + sizeof(mType)
-        + sizeof(mQuantMode);
+        + sizeof(mQuantMode) + sizeof(mResidualEnabled) + sizeof(mPreQuantScaleEnabled);
 }
 
 void RmsnormQuantizationPlugin::serialize(void* buffer) const noexcept
@@ -293,6 +335,8 @@ void RmsnormQuantizationPlugin::serialize(void* buffer) const noexcept
     write(d, mQuantMode);
     write(d, mType);
     write(d, mOutputType);
+    write(d, mResidualEnabled);
+    write(d, mPreQuantScaleEnabled);
     assert(d == a + getSerializationSize());
 }
 
@@ -314,6 +358,8 @@ RmsnormQuantizationPluginCreator::RmsnormQuantizationPluginCreator()
     mPluginAttributes.emplace_back(PluginField("quant_mode", nullptr, PluginFieldType::kINT32, 1));
     mPluginAttributes.emplace_back(PluginField("type_id", nullptr, PluginFieldType::kINT32, 1));
     mPluginAttributes.emplace_back(PluginField("out_type_id", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("residual_enabled", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("pre_quant_scale_enabled", nullptr, PluginFieldType::kINT32, 1));
     mFC.nbFields = mPluginAttributes.size();
     mFC.fields = mPluginAttributes.data();
 }
@@ -342,6 +388,8 @@ IPluginV2* RmsnormQuantizationPluginCreator::createPlugin(char const* name, Plug
     float eps;
     nvinfer1::DataType type;
     bool dynamicActivationScaling;
+    bool residualEnabled = false;
+    bool preQuantScaleEnabled = false;
     // Read configurations from each fields
     for (int i = 0; i < fc->nbFields; ++i)
     {
@@ -376,11 +424,21 @@ IPluginV2* RmsnormQuantizationPluginCreator::createPlugin(char const* name, Plug
             TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
             dynamicActivationScaling = static_cast<bool>(*(static_cast<bool const*>(fields[i].data)));
         }
+        else if (!strcmp(attrName, "residual_enabled"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            residualEnabled = static_cast<bool>(*(static_cast<bool const*>(fields[i].data)));
+        }
+        else if (!strcmp(attrName, "pre_quant_scale_enabled"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            preQuantScaleEnabled = static_cast<bool>(*(static_cast<bool const*>(fields[i].data)));
+        }
     }
     try
     {
-        auto* obj = new RmsnormQuantizationPlugin(
-            eps, dynamicActivationScaling, clampValEnabled, quantMode, type, outputType);
+        auto* obj = new RmsnormQuantizationPlugin(eps, dynamicActivationScaling, clampValEnabled, quantMode, type,
+            outputType, residualEnabled, preQuantScaleEnabled);
         obj->setPluginNamespace(mNamespace.c_str());
         return obj;
     }
@@ -30,7 +30,8 @@ class RmsnormQuantizationPlugin : public BasePlugin
 {
 public:
     RmsnormQuantizationPlugin(float eps, bool dynamicActivationScaling, bool clampValEnabled,
-        tensorrt_llm::common::QuantMode quantMode, nvinfer1::DataType type, nvinfer1::DataType outputType);
+        tensorrt_llm::common::QuantMode quantMode, nvinfer1::DataType type, nvinfer1::DataType outputType,
+        bool residualEnabled = false, bool preQuantScaleEnabled = false);
 
     RmsnormQuantizationPlugin(void const* data, size_t length);
 
@@ -52,7 +53,8 @@ public:
     template <typename T, typename QuantT>
     void dispatchDataType(void* out, void const* input, void const* gamma, void const* beta, float const eps,
         int const tokens, int const hidden_dim, cudaStream_t stream, void const* clampValPtr, void const* scale,
-        void* dynamic_scale, void* normed_output_quant) noexcept;
+        void* dynamic_scale, void* normed_output_quant, void const* residual, void* residual_out,
+        void const* pre_quant_scale) noexcept;
 
     // IPluginV2Ext Methods
     nvinfer1::DataType getOutputDataType(
@@ -80,6 +82,10 @@ private:
     bool mClampValEnabled;
     // The quantization mode.
     tensorrt_llm::common::QuantMode mQuantMode;
+    // Do we add a residual input before the norm ? The sum is an extra output, the residual of the next layer.
+    bool mResidualEnabled{false};
+    // Do we scale the normed output per channel before quantization ?
+    bool mPreQuantScaleEnabled{false};
 };
 
 class RmsnormQuantizationPluginCreator : public BaseCreator
@@ -50,6 +50,11 @@ protected:
 
     std::vector<Config> getTactics(int m, int n, int k) const override;
 
+    std::string getTacticCacheTag() const override
+    {
+        return "quantMode=" + std::to_string(mQuantMode.value());
+    }
+
 private:
     tensorrt_llm::common::QuantMode mQuantMode;
 };
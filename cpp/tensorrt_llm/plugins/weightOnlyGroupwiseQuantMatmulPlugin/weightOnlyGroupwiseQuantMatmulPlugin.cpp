@@ -68,6 +68,18 @@ void WeightOnlyGroupwiseQuantGemmPluginProfiler::runTactic(int m, int n, int k,
         biasesPtr = nullptr;
     }
 
+    if (tactic.enableCudaKernel)
+    {
+        // Only the timing matters here, the activations double as the pre-quant scales.
+        bool const useActScale = (mQuantAlgo & PRE_QUANT_SCALE)
+            && mCudaKernelType != tensorrt_llm::kernels::weight_only::KernelType::FP8Int4Groupwise;
+        tensorrt_llm::kernels::weight_only::Params params{actPtr, useActScale ? actPtr : nullptr, weightPtr,
+            inputScalesPtr, zerosPtr, biasesPtr, outputPtr, 1.f, m, originalN, k, mGroupSize, mCudaKernelType,
+            static_cast<bool>(mQuantAlgo & FP8_ALPHA)};
+        tensorrt_llm::kernels::weight_only::kernel_launcher(mArch, params, stream);
+        return;
+    }
+
     int const wsSize = mRunner->getWorkspaceSize(m, originalN, k);
 
     mRunner->gemm(actPtr, weightPtr, inputScalesPtr, zerosPtr, biasesPtr, outputPtr, m, originalN, k, mGroupSize,
@@ -94,7 +106,14 @@ void WeightOnlyGroupwiseQuantGemmPluginProfiler::computeTmpSize(size_t maxM, siz
 std::vector<WeightOnlyGroupwiseQuantGemmPluginProfiler::Config> WeightOnlyGroupwiseQuantGemmPluginProfiler::getTactics(
     int m, int n, int k) const
 {
-    return mRunner->getConfigs();
+    auto tactics = mRunner->getConfigs();
+    if (mCudaKernelEnabled && m <= tensorrt_llm::kernels::weight_only::kMaxCudaKernelM)
+    {
+        Config cudaKernelTactic;
+        cudaKernelTactic.enableCudaKernel = true;
+        tactics.push_back(cudaKernelTactic);
+    }
+    return tactics;
 }
 
 WeightOnlyGroupwiseQuantMatmulPlugin::WeightOnlyGroupwiseQuantMatmulPlugin(nvinfer1::DataType type, int quant_algo,
@@ -188,6 +207,16 @@ void WeightOnlyGroupwiseQuantMatmulPlugin::init(nvinfer1::DataType type, int qua
         mCudaKernelEnabled = tensorrt_llm::kernels::weight_only::is_supported(
             mArch, tensorrt_llm::kernels::weight_only::KernelType::FP16Int4Groupwise);
         mCudaKernelType = tensorrt_llm::kernels::weight_only::KernelType::FP16Int4Groupwise;
+#ifdef ENABLE_FP8
+        if ((quant_algo & FP8_ALPHA) && (quant_algo & PRE_QUANT_SCALE)
+            && tensorrt_llm::kernels::weight_only::is_supported(
+                mArch, tensorrt_llm::kernels::weight_only::KernelType::FP8Int4Groupwise))
+        {
+            // Feed the small M kernel the same fp8 activations as the CUTLASS one, so that the results don't depend
+            // on the batch size.
+            mCudaKernelType = tensorrt_llm::kernels::weight_only::KernelType::FP8Int4Groupwise;
+        }
+#endif
     }
 #if defined(ENABLE_BF16)
     else if (mType == nvinfer1::DataType::kBF16)
@@ -229,6 +258,10 @@ void WeightOnlyGroupwiseQuantMatmulPlugin::init(nvinfer1::DataType type, int qua
     }
     mPluginProfiler->setQuantAlgo(mQuantAlgo);
     mPluginProfiler->setGroupSize(mGroupSize);
+    if (mCudaKernelEnabled)
+    {
+        mPluginProfiler->setCudaKernelType(mCudaKernelType, mArch);
+    }
 
     mGemmId = GemmIdCore(mDims.n, mDims.k, mType);
 }
@@ -367,8 +400,15 @@ int WeightOnlyGroupwiseQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc con
     int const n = TLLM_INT32_CAST(inputDesc[mWeightInputIdx].dims.d[1]);
     int const k = TLLM_INT32_CAST(inputDesc[0].dims.d[inputDesc[0].dims.nbDims - 1]);
 
-    bool use_cuda_kernel = m < SMALL_M_FAST_PATH && mCudaKernelEnabled;
+    auto const& bestTactic = mPluginProfiler->getBestConfig(m, mGemmId);
+    // The profiler picks between the GEMV and CUTLASS per bucket of m.
+    bool use_cuda_kernel = mCudaKernelEnabled
+        && (bestTactic ? bestTactic->enableCudaKernel && m <= tensorrt_llm::kernels::weight_only::kMaxCudaKernelM
+                       : m < SMALL_M_FAST_PATH);
     bool use_pre_quant_scale = mQuantAlgo & PRE_QUANT_SCALE;
+    // Apart from the W4A8 one, the cuda kernels apply the pre-quant scales themselves.
+    bool use_fp8_act_cuda_kernel
+        = use_cuda_kernel && mCudaKernelType == tensorrt_llm::kernels::weight_only::KernelType::FP8Int4Groupwise;
 
     half const* zeros_ptr = (mQuantAlgo & ZERO) ? reinterpret_cast<half const*>(inputs[mZerosInputIdx]) : nullptr;
     half const* biases_ptr = (mQuantAlgo & BIAS) ? reinterpret_cast<half const*>(inputs[mBiasesInputIdx]) : nullptr;
@@ -379,7 +419,7 @@ int WeightOnlyGroupwiseQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc con
         cudaMemcpy(&alpha, const_cast<void*>(inputs[mAlphaInputIdx]), sizeof(float), cudaMemcpyDeviceToHost);
     }
 
-    if (use_pre_quant_scale && !use_cuda_kernel)
+    if (use_pre_quant_scale && (!use_cuda_kernel || use_fp8_act_cuda_kernel))
     {
         // Apply pre-quant per channel scale on activations
         act_ptr = reinterpret_cast<half const*>(workspace);
@@ -431,8 +471,8 @@ int WeightOnlyGroupwiseQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc con
         void const* pre_quant_scale_ptr = nullptr;
         if (use_pre_quant_scale)
             pre_quant_scale_ptr = inputs[mPreQuantScaleInputIdx];
-        void const* cuda_kernel_act_ptr = inputs[0];
-        void const* cuda_kernel_act_scale_ptr = pre_quant_scale_ptr;
+        void const* cuda_kernel_act_ptr = use_fp8_act_cuda_kernel ? workspace : inputs[0];
+        void const* cuda_kernel_act_scale_ptr = use_fp8_act_cuda_kernel ? nullptr : pre_quant_scale_ptr;
         void const* cuda_kernel_weight_ptr = inputs[mWeightInputIdx];
         void const* cuda_kernel_scales_ptr = inputs[mScalesInputIdx];
         void const* cuda_kernel_zeros_ptr = zeros_ptr;
@@ -450,8 +490,7 @@ int WeightOnlyGroupwiseQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc con
 
         int32_t* weight_ptr = const_cast<int32_t*>(reinterpret_cast<int32_t const*>(inputs[mWeightInputIdx]));
 
-        auto const& bestTactic = mPluginProfiler->getBestConfig(m, mGemmId);
-        TLLM_CHECK_WITH_INFO(bestTactic,
+        TLLM_CHECK_WITH_INFO(bestTactic && !bestTactic->enableCudaKernel,
             "No valid weight only groupwise GEMM tactic(It is usually caused by the failure to execute all "
             "candidate "
             "configurations of the CUTLASS kernel, please pay attention to the warning information when building "
@@ -60,6 +60,14 @@ public:
         mGroupSize = groupSize;
     }
 
+    // Offer the batched GEMV kernel as a tactic for m up to kMaxCudaKernelM.
+    void setCudaKernelType(tensorrt_llm::kernels::weight_only::KernelType cudaKernelType, int arch)
+    {
+        mCudaKernelEnabled = true;
+        mCudaKernelType = cudaKernelType;
+        mArch = arch;
+    }
+
 protected:
     void runTactic(int m, int n, int k, Config const& tactic, char* workspace, cudaStream_t const& stream) override;
 
@@ -67,9 +75,17 @@ protected:
 
     std::vector<Config> getTactics(int m, int n, int k) const override;
 
+    std::string getTacticCacheTag() const override
+    {
+        return "quantAlgo=" + std::to_string(mQuantAlgo) + " groupSize=" + std::to_string(mGroupSize);
+    }
+
 private:
     int mQuantAlgo;
     int mGroupSize;
+    bool mCudaKernelEnabled{false};
+    tensorrt_llm::kernels::weight_only::KernelType mCudaKernelType;
+    int mArch;
 };
 
 class WeightOnlyGroupwiseQuantMatmulPlugin : public BasePlugin
@@ -129,7 +145,7 @@ private:
     tensorrt_llm::kernels::weight_only::KernelType mCudaKernelType;
     int mArch;
 
-    // When M is smaller than this value, we trigger a fast path
+    // When M is smaller than this value and there is no profiled tactic, we trigger a fast path
     // I.e. a tailored kernel instead of cutlass.
     static constexpr int SMALL_M_FAST_PATH = 5;
 
@@ -15,6 +15,7 @@
  * limitations under the License.
  */
 #include "weightOnlyQuantMatmulPlugin.h"
+#include "tensorrt_llm/kernels/lmHeadGemv.h"
 
 #include <numeric>
 
@@ -46,6 +47,14 @@ void WeightOnlyQuantGemmPluginProfiler::runTactic(int m, int n, int k,
     char* workspacePtr
         = reinterpret_cast<char*>(nextWorkspacePtr(reinterpret_cast<int8_t*>(outputPtr), m * originalN * sizeof(half)));
 
+    if (tactic.enableCudaKernel)
+    {
+        tensorrt_llm::kernels::weight_only::Params params(actPtr, nullptr, weightPtr, scalesPtr, nullptr, nullptr,
+            outputPtr, 1.f, m, originalN, k, 0, mCudaKernelType);
+        tensorrt_llm::kernels::weight_only::kernel_launcher(mArch, params, stream);
+        return;
+    }
+
     int const wsSize = mRunner->getWorkspaceSize(m, originalN, k);
 
     if (mWeightTypeId == WeightTypeId::INT8)
@@ -76,12 +85,21 @@ void WeightOnlyQuantGemmPluginProfiler::computeTmpSize(size_t maxM, size_t n, si
 std::vector<WeightOnlyQuantGemmPluginProfiler::Config> WeightOnlyQuantGemmPluginProfiler::getTactics(
     int m, int n, int k) const
 {
-    return mRunner->getConfigs();
+    auto tactics = mRunner->getConfigs();
+    if (mCudaKernelEnabled && m <= tensorrt_llm::kernels::weight_only::kMaxCudaKernelM)
+    {
+        Config cudaKernelTactic;
+        cudaKernelTactic.enableCudaKernel = true;
+        tactics.push_back(cudaKernelTactic);
+    }
+    return tactics;
 }
 
 WeightOnlyQuantMatmulPlugin::WeightOnlyQuantMatmulPlugin(nvinfer1::DataType type, WeightTypeId weightTypeId,
-    WeightOnlyQuantMatmulPlugin::PluginProfilerPtr const& pluginProfiler)
-    : mPluginProfiler(pluginProfiler)
+    bool lmHead, bool gatherLastToken, WeightOnlyQuantMatmulPlugin::PluginProfilerPtr const& pluginProfiler)
+    : mLmHead(lmHead)
+    , mGatherLastToken(gatherLastToken)
+    , mPluginProfiler(pluginProfiler)
 {
     init(type, weightTypeId);
 }
@@ -97,6 +115,8 @@ WeightOnlyQuantMatmulPlugin::WeightOnlyQuantMatmulPlugin(
     read(d, type);
     read(d, weightTypeId);
     read(d, mDims);
+    read(d, mLmHead);
+    read(d, mGatherLastToken);
 
     init(type, weightTypeId);
 
@@ -115,6 +135,27 @@ void WeightOnlyQuantMatmulPlugin::init(nvinfer1::DataType type, WeightTypeId wei
     mType = type;
     mWeightTypeId = weightTypeId;
 
+    if (mLmHead)
+    {
+        // The LM head runs its own GEMV on unpreprocessed weights, there are no tactics to profile.
+#if defined(ENABLE_BF16)
+        TLLM_CHECK_WITH_INFO(mType == nvinfer1::DataType::kHALF || mType == nvinfer1::DataType::kBF16,
+            "The LM head needs fp16 or bf16 activations.");
+#else
+        TLLM_CHECK_WITH_INFO(mType == nvinfer1::DataType::kHALF, "The LM head needs fp16 activations.");
+#endif
+#if defined(ENABLE_FP8)
+        TLLM_CHECK_WITH_INFO(mWeightTypeId == WeightTypeId::INT8 || mWeightTypeId == WeightTypeId::FP8,
+            "The LM head needs int8 or fp8 weights.");
+#else
+        TLLM_CHECK_WITH_INFO(mWeightTypeId == WeightTypeId::INT8, "The LM head needs int8 weights.");
+#endif
+        mCudaKernelEnabled = false;
+        mGemmId = GemmIdCore(mDims.n, mDims.k, mType);
+        return;
+    }
+    TLLM_CHECK_WITH_INFO(!mGatherLastToken, "Gathering the last tokens needs the LM head mode.");
+
     if (mWeightTypeId == WeightTypeId::INT8)
     {
         if (mType == nvinfer1::DataType::kHALF)
@@ -171,6 +212,10 @@ void WeightOnlyQuantMatmulPlugin::init(nvinfer1::DataType type, WeightTypeId wei
     }
 
     mPluginProfiler->setWeightTypeId(mWeightTypeId);
+    if (mCudaKernelEnabled)
+    {
+        mPluginProfiler->setCudaKernelType(mCudaKernelType, mArch);
+    }
 
     mGemmId = GemmIdCore(mDims.n, mDims.k, mType);
 }
@@ -184,6 +229,10 @@ nvinfer1::IPluginV2DynamicExt* WeightOnlyQuantMatmulPlugin::clone() const noexce
 
 void WeightOnlyQuantMatmulPlugin::configGemm()
 {
+    if (mLmHead)
+    {
+        return;
+    }
     mPluginProfiler->profileTactics(m_weightOnlyGemmRunner, mType, mDims, mGemmId);
 }
 
@@ -191,17 +240,36 @@ nvinfer1::DimsExprs WeightOnlyQuantMatmulPlugin::getOutputDimensions(
     int outputIndex, nvinfer1::DimsExprs const* inputs, int nbInputs, nvinfer1::IExprBuilder& exprBuilder) noexcept
 {
     // input [m1, m2, m3, ... , k]
-    // weight [k, n] for int8, [k, n/2] for int4
+    // weight [k, n] for int8, [k, n/2] for int4, [n, k] for the LM head
+    // last_token_ids [b] when gathering the last tokens
 
     try
     {
-        TLLM_CHECK(nbInputs == 3);
+        TLLM_CHECK(nbInputs == (mGatherLastToken ? 4 : 3));
         TLLM_CHECK(outputIndex == 0);
         int const nbDimsA = inputs[0].nbDims;
         int const nbDimsB = inputs[1].nbDims;
         TLLM_CHECK(nbDimsA >= 2);
         TLLM_CHECK(nbDimsB == 2);
         DimsExprs ret;
+        if (mLmHead)
+        {
+            if (mGatherLastToken)
+            {
+                ret.nbDims = 2;
+                ret.d[0] = inputs[3].d[0];
+            }
+            else
+            {
+                ret.nbDims = nbDimsA;
+                for (int ii = 0; ii < nbDimsA - 1; ++ii)
+                {
+                    ret.d[ii] = inputs[0].d[ii];
+                }
+            }
+            ret.d[ret.nbDims - 1] = inputs[1].d[0];
+            return ret;
+        }
         ret.nbDims = nbDimsA;
         for (int ii = 0; ii < nbDimsA - 1; ++ii)
         {
@@ -229,6 +297,28 @@ nvinfer1::DimsExprs WeightOnlyQuantMatmulPlugin::getOutputDimensions(
 bool WeightOnlyQuantMatmulPlugin::supportsFormatCombination(
     int pos, nvinfer1::PluginTensorDesc const* inOut, int nbInputs, int nbOutputs) noexcept
 {
+    if (mLmHead)
+    {
+        if (inOut[pos].format != TensorFormat::kLINEAR)
+        {
+            return false;
+        }
+        if (pos == nbInputs)
+        {
+            // fp32 logits
+            return inOut[pos].type == nvinfer1::DataType::kFLOAT;
+        }
+        switch (pos)
+        {
+        case 0: return inOut[0].type == mType;
+        case 1:
+            return inOut[1].type
+                == (mWeightTypeId == WeightTypeId::FP8 ? nvinfer1::DataType::kFP8 : nvinfer1::DataType::kINT8);
+        case 2: return inOut[2].type == nvinfer1::DataType::kFLOAT;
+        case 3: return inOut[3].type == nvinfer1::DataType::kINT32;
+        default: return false;
+        }
+    }
     switch (pos)
     {
     case 0:
@@ -258,6 +348,21 @@ void WeightOnlyQuantMatmulPlugin::configurePlugin(nvinfer1::DynamicPluginTensorD
     auto const minM = std::accumulate(in[0].min.d, in[0].min.d + in[0].min.nbDims - 1, 1, std::multiplies<int>());
     auto const maxM = std::accumulate(in[0].max.d, in[0].max.d + in[0].max.nbDims - 1, 1, std::multiplies<int>());
 
+    if (mLmHead)
+    {
+        int const maxK = in[0].max.d[in[0].max.nbDims - 1];
+        TLLM_CHECK_WITH_INFO(maxK % tensorrt_llm::kernels::kLmHeadGemvKAlignment == 0,
+            "The LM head needs the hidden size (%d) to be a multiple of %d.", maxK,
+            tensorrt_llm::kernels::kLmHeadGemvKAlignment);
+        if (!mDims.isInitialized())
+        {
+            mDims = {minM, maxM, in[1].max.d[0], maxK};
+        }
+        mGemmId = {mDims.n, mDims.k, mType};
+        m_workspaceMaxSize = 0;
+        return;
+    }
+
     int const maxK = in[0].max.d[in[0].max.nbDims - 1];
     int const maxN = in[1].max.d[1] * getWeightTypeMultiplier(mWeightTypeId);
 
@@ -291,6 +396,11 @@ int WeightOnlyQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc const* input
     // outputs
     //     mat [M, N]
 
+    if (mLmHead)
+    {
+        return enqueueLmHead(inputDesc, inputs, outputs, stream);
+    }
+
     int64_t m64 = 1;
     for (int ii = 0; ii < inputDesc[0].dims.nbDims - 1; ++ii)
     {
@@ -303,7 +413,11 @@ int WeightOnlyQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc const* input
     if (m == 0)
         return 0;
 
-    bool const use_cuda_kernel = m < SMALL_M_FAST_PATH && mCudaKernelEnabled;
+    auto const& bestTactic = mPluginProfiler->getBestConfig(m, mGemmId);
+    // The profiler picks between the GEMV and CUTLASS per bucket of m.
+    bool const use_cuda_kernel = mCudaKernelEnabled
+        && (bestTactic ? bestTactic->enableCudaKernel && m <= tensorrt_llm::kernels::weight_only::kMaxCudaKernelM
+                       : m < SMALL_M_FAST_PATH);
 #if defined(ENABLE_BF16)
     TLLM_CHECK_WITH_INFO(mType == nvinfer1::DataType::kHALF || mType == nvinfer1::DataType::kBF16,
         "No valid weightOnlyQuantMatmul configuration");
@@ -325,8 +439,7 @@ int WeightOnlyQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc const* input
     {
         int const ws_size = m_weightOnlyGemmRunner->getWorkspaceSize(m, real_n, k);
 
-        auto const& bestTactic = mPluginProfiler->getBestConfig(m, mGemmId);
-        TLLM_CHECK_WITH_INFO(bestTactic,
+        TLLM_CHECK_WITH_INFO(bestTactic && !bestTactic->enableCudaKernel,
             "No valid weight only per-channel GEMM tactic(It is usually caused by the failure to execute all candidate "
             "configurations of the CUTLASS kernel, please pay attention to the warning information when building the "
             "engine.)");
@@ -338,12 +451,74 @@ int WeightOnlyQuantMatmulPlugin::enqueue(nvinfer1::PluginTensorDesc const* input
     return 0;
 }
 
+int WeightOnlyQuantMatmulPlugin::enqueueLmHead(nvinfer1::PluginTensorDesc const* inputDesc, void const* const* inputs,
+    void* const* outputs, cudaStream_t stream)
+{
+    // inputs
+    //     hidden_states  [M1, M2,..., K], [B, S, K] or [num_tokens, K] when gathering
+    //     mat2           [N, K]
+    //     scale_channels [N] fp32
+    //     last_token_ids [B] when gathering
+    // outputs
+    //     logits [M1, M2,..., N] or [B, N] fp32
+    auto const& actDims = inputDesc[0].dims;
+    int const n = TLLM_INT32_CAST(inputDesc[1].dims.d[0]);
+    int const k = TLLM_INT32_CAST(actDims.d[actDims.nbDims - 1]);
+    int m = 1;
+    int seqStride = 0;
+    int const* lastTokenIds = nullptr;
+    if (mGatherLastToken)
+    {
+        m = TLLM_INT32_CAST(inputDesc[3].dims.d[0]);
+        lastTokenIds = reinterpret_cast<int const*>(inputs[3]);
+        // The ids of padded inputs [B, S, K] count from the first row of every sequence, those of packed inputs from
+        // the first row of the batch.
+        seqStride = actDims.nbDims == 3 ? TLLM_INT32_CAST(actDims.d[1]) : 0;
+    }
+    else
+    {
+        for (int ii = 0; ii < actDims.nbDims - 1; ++ii)
+        {
+            m *= TLLM_INT32_CAST(actDims.d[ii]);
+        }
+    }
+
+    auto* logits = reinterpret_cast<float*>(outputs[0]);
+    auto const* scales = reinterpret_cast<float const*>(inputs[2]);
+    auto const run = [&](auto const* act)
+    {
+        if (mWeightTypeId == WeightTypeId::INT8)
+        {
+            tensorrt_llm::kernels::invokeLmHeadGemv(logits, act, reinterpret_cast<int8_t const*>(inputs[1]), scales,
+                lastTokenIds, seqStride, m, n, k, stream);
+        }
+#if defined(ENABLE_FP8)
+        else
+        {
+            tensorrt_llm::kernels::invokeLmHeadGemv(logits, act,
+                reinterpret_cast<__nv_fp8_e4m3 const*>(inputs[1]), scales, lastTokenIds, seqStride, m, n, k, stream);
+        }
+#endif
+    };
+    if (mType == nvinfer1::DataType::kHALF)
+    {
+        run(reinterpret_cast<half const*>(inputs[0]));
+    }
+#if defined(ENABLE_BF16)
+    else
+    {
+        run(reinterpret_cast<__nv_bfloat16 const*>(inputs[0]));
+    }
+#endif
+    return 0;
+}
+
 // IPluginV2Ext Methods
 nvinfer1::DataType WeightOnlyQuantMatmulPlugin::getOutputDataType(
     int index, nvinfer1::DataType const* inputTypes, int nbInputs) const noexcept
 {
     TLLM_CHECK(index == 0);
-    return mType;
+    return mLmHead ? nvinfer1::DataType::kFLOAT : mType;
 }
 
 // IPluginV2 Methods
@@ -376,6 +551,8 @@ size_t WeightOnlyQuantMatmulPlugin::getSerializationSize() const noexcept
     return sizeof(mWeightTypeId) +                      // mWeightTypeId
         sizeof(nvinfer1::DataType) +                    // mType
         sizeof(mDims) +                                 // Dimensions
+        sizeof(mLmHead) +                               // LM head
+        sizeof(mGatherLastToken) +                      // Gather last token
         mPluginProfiler->getSerializationSize(mGemmId); // selected tactics container size
 }
 
@@ -385,6 +562,8 @@ void WeightOnlyQuantMatmulPlugin::serialize(void* buffer) const noexcept
     write(d, mType);
     write(d, mWeightTypeId);
     write(d, mDims);
+    write(d, mLmHead);
+    write(d, mGatherLastToken);
 
     mPluginProfiler->serialize(d, mGemmId);
     assert(d == a + getSerializationSize());
@@ -404,6 +583,8 @@ WeightOnlyQuantMatmulPluginCreator::WeightOnlyQuantMatmulPluginCreator()
     mPluginAttributes.clear();
     mPluginAttributes.emplace_back(PluginField("type_id", nullptr, PluginFieldType::kINT32, 1));
     mPluginAttributes.emplace_back(PluginField("weight_type_id", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("lm_head", nullptr, PluginFieldType::kINT32, 1));
+    mPluginAttributes.emplace_back(PluginField("gather_last_token", nullptr, PluginFieldType::kINT32, 1));
     mFC.nbFields = mPluginAttributes.size();
     mFC.fields = mPluginAttributes.data();
 }
@@ -428,6 +609,8 @@ IPluginV2* WeightOnlyQuantMatmulPluginCreator::createPlugin(char const* name, Pl
     PluginField const* fields = fc->fields;
     nvinfer1::DataType type;
     WeightTypeId weightTypeId;
+    bool lmHead = false;
+    bool gatherLastToken = false;
     // Read configurations from each fields
     for (int i = 0; i < fc->nbFields; ++i)
     {
@@ -442,13 +625,23 @@ IPluginV2* WeightOnlyQuantMatmulPluginCreator::createPlugin(char const* name, Pl
             TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
             type = static_cast<nvinfer1::DataType>(*(static_cast<nvinfer1::DataType const*>(fields[i].data)));
         }
+        else if (!strcmp(attrName, "lm_head"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            lmHead = static_cast<bool>(*(static_cast<int const*>(fields[i].data)));
+        }
+        else if (!strcmp(attrName, "gather_last_token"))
+        {
+            TLLM_CHECK(fields[i].type == PluginFieldType::kINT32);
+            gatherLastToken = static_cast<bool>(*(static_cast<int const*>(fields[i].data)));
+        }
     }
     try
     {
         // WeightOnlyGroupwiseQuantMatmulPluginCreator is unique and shared for an engine generation
         // Create plugin profiler with shared tactics map
         auto pluginProfiler = gemmPluginProfileManager.createGemmPluginProfiler(/* inference */ false);
-        auto* obj = new WeightOnlyQuantMatmulPlugin(type, weightTypeId, pluginProfiler);
+        auto* obj = new WeightOnlyQuantMatmulPlugin(type, weightTypeId, lmHead, gatherLastToken, pluginProfiler);
         obj->setPluginNamespace(mNamespace.c_str());
         return obj;
     }
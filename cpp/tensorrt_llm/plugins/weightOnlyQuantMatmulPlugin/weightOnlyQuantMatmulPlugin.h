@@ -39,6 +39,8 @@ enum class WeightTypeId
 {
     INT8 = 1,
     INT4 = 2,
+    // e4m3 weights, only for the LM head
+    FP8 = 3,
 };
 
 constexpr int32_t FP16_BITS = 16;
@@ -49,7 +51,7 @@ constexpr int32_t FP16_INT4_RATIO = FP16_BITS / INT4_BITS;
 
 inline int32_t getWeightTypeMultiplier(WeightTypeId weightTypeId)
 {
-    return weightTypeId == WeightTypeId::INT8 ? 1 : INT8_INT4_RATIO;
+    return weightTypeId == WeightTypeId::INT4 ? INT8_INT4_RATIO : 1;
 }
 
 using WeightOnlyGemmRunner = tensorrt_llm::kernels::cutlass_kernels::CutlassFpAIntBGemmRunnerInterface;
@@ -66,6 +68,14 @@ public:
         mWeightTypeId = weightId;
     }
 
+    // Offer the batched GEMV kernel as a tactic for m up to kMaxCudaKernelM.
+    void setCudaKernelType(tensorrt_llm::kernels::weight_only::KernelType cudaKernelType, int arch)
+    {
+        mCudaKernelEnabled = true;
+        mCudaKernelType = cudaKernelType;
+        mArch = arch;
+    }
+
 protected:
     void runTactic(int m, int n, int k, Config const& tactic, char* workspace, cudaStream_t const& stream) override;
 
@@ -73,8 +83,16 @@ protected:
 
     std::vector<Config> getTactics(int m, int n, int k) const override;
 
+    std::string getTacticCacheTag() const override
+    {
+        return "weightType=" + std::to_string(static_cast<int>(mWeightTypeId));
+    }
+
 private:
     WeightTypeId mWeightTypeId;
+    bool mCudaKernelEnabled{false};
+    tensorrt_llm::kernels::weight_only::KernelType mCudaKernelType;
+    int mArch;
 };
 
 class WeightOnlyQuantMatmulPlugin : public BasePlugin
@@ -83,7 +101,12 @@ public:
     using PluginProfilerPtr = std::shared_ptr<WeightOnlyQuantGemmPluginProfiler>;
     WeightOnlyQuantMatmulPlugin() = delete;
 
-    WeightOnlyQuantMatmulPlugin(nvinfer1::DataType type, WeightTypeId weightTypeId, PluginProfilerPtr const& profiler);
+    //! \param lmHead Run as the LM head: int8 or fp8 weights [N, K] with fp32 per-channel scales [N], as quantized from
+    //! the checkpoint without preprocessing, and fp32 logits, see invokeLmHeadGemv.
+    //! \param gatherLastToken With lmHead, take the last token ids [B] as a fourth input and compute the logits of the
+    //! last token of every sequence only, [B, N].
+    WeightOnlyQuantMatmulPlugin(nvinfer1::DataType type, WeightTypeId weightTypeId, bool lmHead, bool gatherLastToken,
+        PluginProfilerPtr const& profiler);
 
     WeightOnlyQuantMatmulPlugin(void const* data, size_t length, PluginProfilerPtr const& profiler);
 
@@ -121,6 +144,9 @@ private:
 
     void configGemm();
 
+    int enqueueLmHead(nvinfer1::PluginTensorDesc const* inputDesc, void const* const* inputs, void* const* outputs,
+        cudaStream_t stream);
+
 private:
     const std::string mLayerName;
 
@@ -128,11 +154,13 @@ private:
     size_t m_workspaceMaxSize;
     nvinfer1::DataType mType;
     WeightTypeId mWeightTypeId;
+    bool mLmHead{false};
+    bool mGatherLastToken{false};
     bool mCudaKernelEnabled;
     tensorrt_llm::kernels::weight_only::KernelType mCudaKernelType;
     int mArch;
 
-    // When M is smaller than this value, we trigger a fast path
+    // When M is smaller than this value and there is no profiled tactic, we trigger a fast path
     // I.e. a tailored kernel instead of cutlass.
     static constexpr int SMALL_M_FAST_PATH = 5;
 
@@ -35,10 +35,14 @@
 #include "tensorrt_llm/batch_manager/trtGptModelOptionalParams.h"
 #include "tensorrt_llm/common/mpiUtils.h"
 #include "tensorrt_llm/common/quantization.h"
+#include "tensorrt_llm/runtime/admissionController.h"
 #include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cpuAffinity.h"
 #include "tensorrt_llm/runtime/gptJsonConfig.h"
 #include "tensorrt_llm/runtime/memoryCounters.h"
+#include "tensorrt_llm/runtime/moeLoadCounters.h"
 #include "tensorrt_llm/runtime/samplingConfig.h"
+#include "tensorrt_llm/runtime/traceRecorder.h"
 
 namespace py = pybind11;
 namespace tb = tensorrt_llm::batch_manager;
@@ -147,6 +151,7 @@ PYBIND11_MODULE(TRTLLM_PYBIND_MODULE, m)
         .def_static("int8_kv_cache", &tc::QuantMode::int8KvCache)
         .def_static("fp8_kv_cache", &tc::QuantMode::fp8KvCache)
         .def_static("fp8_qdq", &tc::QuantMode::fp8Qdq)
+        .def_static("int4_kv_cache", &tc::QuantMode::int4KvCache)
         .def_property_readonly("value", &tc::QuantMode::value)
         .def("is_set", &tc::QuantMode::isSet, py::arg("mode"))
         .def_property_readonly("has_int4_weights", &tc::QuantMode::hasInt4Weights)
@@ -159,11 +164,13 @@ PYBIND11_MODULE(TRTLLM_PYBIND_MODULE, m)
         .def_property_readonly("has_int8_kv_cache", &tc::QuantMode::hasInt8KvCache)
         .def_property_readonly("has_fp8_kv_cache", &tc::QuantMode::hasFp8KvCache)
         .def_property_readonly("has_fp8_qdq", &tc::QuantMode::hasFp8Qdq)
+        .def_property_readonly("has_int4_kv_cache", &tc::QuantMode::hasInt4KvCache)
         .def_property_readonly("has_kv_cache_quant", &tc::QuantMode::hasKvCacheQuant)
         .def_static("from_description", &tc::QuantMode::fromDescription, py::arg("quantize_weights") = false,
             py::arg("quantize_activations") = false, py::arg("per_token") = false, py::arg("per_channel") = false,
             py::arg("per_group") = false, py::arg("use_int4_weights") = false, py::arg("use_int8_kv_cache") = false,
-            py::arg("use_fp8_kv_kache") = false, py::arg("use_fp8_qdq") = false, py::arg("use_fp8_rowwise") = false)
+            py::arg("use_fp8_kv_kache") = false, py::arg("use_fp8_qdq") = false, py::arg("use_fp8_rowwise") = false,
+            py::arg("use_int4_kv_cache") = false)
         .def_static("use_smooth_quant", &tc::QuantMode::useSmoothQuant, py::arg("per_token") = false,
             py::arg("per_channel") = false)
         .def_static("use_weight_only", &tc::QuantMode::useWeightOnly, py::arg("use_int4_weights") = false,
@@ -246,11 +253,13 @@ PYBIND11_MODULE(TRTLLM_PYBIND_MODULE, m)
         return py::make_tuple(config.beamWidth, config.temperature, config.minLength, config.repetitionPenalty,
             config.presencePenalty, config.frequencyPenalty, config.topK, config.topP, config.randomSeed,
             config.topPDecay, config.topPMin, config.topPResetIds, config.beamSearchDiversityRate, config.lengthPenalty,
-            config.earlyStopping, config.noRepeatNgramSize);
+            config.earlyStopping, config.noRepeatNgramSize, config.minP, config.typicalAcceptanceThreshold,
+            config.typicalAcceptanceAlpha, config.useDraftRejectionSampling, config.numBeamGroups,
+            config.beamGroupDiversityPenalty);
     };
     auto SamplingConfigSetState = [](py::tuple t) -> tr::SamplingConfig
     {
-        assert(t.size() == 16);
+        assert(t.size() == 22);
 
         tr::SamplingConfig config;
         config.beamWidth = t[0].cast<SizeType32>();
@@ -269,6 +278,12 @@ PYBIND11_MODULE(TRTLLM_PYBIND_MODULE, m)
         config.lengthPenalty = t[13].cast<OptVec<float>>();
         config.earlyStopping = t[14].cast<OptVec<SizeType32>>();
         config.noRepeatNgramSize = t[15].cast<OptVec<SizeType32>>();
+        config.minP = t[16].cast<OptVec<float>>();
+        config.typicalAcceptanceThreshold = t[17].cast<OptVec<float>>();
+        config.typicalAcceptanceAlpha = t[18].cast<OptVec<float>>();
+        config.useDraftRejectionSampling = t[19].cast<OptVec<bool>>();
+        config.numBeamGroups = t[20].cast<OptVec<SizeType32>>();
+        config.beamGroupDiversityPenalty = t[21].cast<OptVec<float>>();
 
         return std::move(config);
     };
@@ -290,7 +305,13 @@ PYBIND11_MODULE(TRTLLM_PYBIND_MODULE, m)
         .def_readwrite("beam_search_diversity_rate", &tr::SamplingConfig::beamSearchDiversityRate)
         .def_readwrite("length_penalty", &tr::SamplingConfig::lengthPenalty)
         .def_readwrite("early_stopping", &tr::SamplingConfig::earlyStopping)
+        .def_readwrite("num_beam_groups", &tr::SamplingConfig::numBeamGroups)
+        .def_readwrite("beam_group_diversity_penalty", &tr::SamplingConfig::beamGroupDiversityPenalty)
         .def_readwrite("no_repeat_ngram_size", &tr::SamplingConfig::noRepeatNgramSize)
+        .def_readwrite("min_p", &tr::SamplingConfig::minP)
+        .def_readwrite("typical_acceptance_threshold", &tr::SamplingConfig::typicalAcceptanceThreshold)
+        .def_readwrite("typical_acceptance_alpha", &tr::SamplingConfig::typicalAcceptanceAlpha)
+        .def_readwrite("use_draft_rejection_sampling", &tr::SamplingConfig::useDraftRejectionSampling)
         .def(py::pickle(SamplingConfigGetState, SamplingConfigSetState))
         .def("__eq__", &tr::SamplingConfig::operator==);
 
@@ -413,7 +434,41 @@ PYBIND11_MODULE(TRTLLM_PYBIND_MODULE, m)
         .def_property_readonly("gpu", &tr::MemoryCounters::getGpu)
         .def_property_readonly("cpu", &tr::MemoryCounters::getCpu)
         .def_property_readonly("pinned", &tr::MemoryCounters::getPinned)
-        .def_property_readonly("uvm", &tr::MemoryCounters::getUVM);
+        .def_property_readonly("uvm", &tr::MemoryCounters::getUVM)
+        .def_property_readonly("tag_stats", &tr::MemoryCounters::getTagStats)
+        .def("reset_tagged_peaks", &tr::MemoryCounters::resetTaggedPeaks);
+
+    py::class_<tr::MoeLoadCounters>(m, "MoeLoadCounters")
+        .def_static("instance", &tr::MoeLoadCounters::getInstance, py::return_value_policy::reference)
+        .def("get_stats", &tr::MoeLoadCounters::getStats);
+
+    py::class_<tr::TraceRecorder>(m, "TraceRecorder")
+        .def_static("instance", &tr::TraceRecorder::getInstance, py::return_value_policy::reference)
+        .def("start", &tr::TraceRecorder::start, py::arg("max_events") = 1 << 16)
+        .def("stop", &tr::TraceRecorder::stop)
+        .def("set_process_id", &tr::TraceRecorder::setProcessId, py::arg("process_id"))
+        .def_property_readonly("enabled", &tr::TraceRecorder::isEnabled)
+        .def_property_readonly("num_dropped", &tr::TraceRecorder::getNumDropped)
+        .def("to_chrome_trace", &tr::TraceRecorder::toChromeTrace)
+        .def("write_chrome_trace", &tr::TraceRecorder::writeChromeTrace, py::arg("path"));
+
+    py::class_<tr::AdmissionController>(m, "AdmissionController")
+        .def(py::init<std::optional<tensorrt_llm::executor::AdmissionControlConfig>, double>(),
+            py::arg("config") = py::none(), py::arg("rate_smoothing") = 0.2)
+        .def("on_iteration", &tr::AdmissionController::onIteration, py::arg("num_released_blocks"),
+            py::arg("iteration_ms"))
+        .def("evaluate", &tr::AdmissionController::evaluate, py::arg("max_num_blocks"), py::arg("free_num_blocks"),
+            py::arg("queued_num_blocks"))
+        .def_property_readonly("release_rate", &tr::AdmissionController::getReleaseRate)
+        .def_static("get_num_prompt_blocks", &tr::AdmissionController::getNumPromptBlocks, py::arg("prompt_len"),
+            py::arg("tokens_per_block"));
+
+    // Call apply before creating the Executor, its threads inherit the affinity of the calling thread
+    py::class_<tr::CpuAffinity>(m, "CpuAffinity")
+        .def_static("resolve", &tr::CpuAffinity::resolve, py::arg("config"), py::arg("device_id"))
+        .def_static("apply", &tr::CpuAffinity::apply, py::arg("config"), py::arg("device_id"))
+        .def_static("get_current_thread_cpus", &tr::CpuAffinity::getCurrentThreadCpus)
+        .def_static("get_device_numa_node", &tr::CpuAffinity::getDeviceNumaNode, py::arg("device_id"));
 
     py::class_<tensorrt_llm::mpi::MpiComm>(m, "MpiComm")
         .def_static("rank",
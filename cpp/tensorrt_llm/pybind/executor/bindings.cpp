@@ -16,6 +16,7 @@
  */
 
 #include <pybind11/cast.h>
+#include <pybind11/chrono.h>
 #include <pybind11/functional.h>
 #include <pybind11/operators.h>
 #include <pybind11/pybind11.h>
@@ -28,10 +29,18 @@
 
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/startupProfiler.h"
 #include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/executor/serialization.h"
 #include "tensorrt_llm/executor/tensor.h"
 #include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/pybind/utils/pathCaster.h"
+#include "tensorrt_llm/runtime/loraCacheCounters.h"
+#include "tensorrt_llm/runtime/orchestratorWorkerPool.h"
+#include "tensorrt_llm/runtime/pinnedStagingPool.h"
+#include "tensorrt_llm/runtime/requestTimingCollector.h"
 
+#include <filesystem>
 #include <optional>
 #include <vector>
 
@@ -73,6 +82,7 @@ void InitBindings(pybind11::module_& m)
         .def("TopK", &tle::DecodingMode::TopK)
         .def("TopP", &tle::DecodingMode::TopP)
         .def("TopKTopP", &tle::DecodingMode::TopKTopP)
+        .def("MinP", &tle::DecodingMode::MinP)
         .def("BeamSearch", &tle::DecodingMode::BeamSearch)
         .def("Medusa", &tle::DecodingMode::Medusa)
         .def("Lookahead", &tle::DecodingMode::Lookahead)
@@ -81,6 +91,11 @@ void InitBindings(pybind11::module_& m)
         .def("isTopP", &tle::DecodingMode::isTopP)
         .def("isTopKorTopP", &tle::DecodingMode::isTopKorTopP)
         .def("isTopKandTopP", &tle::DecodingMode::isTopKandTopP)
+        .def("isMinP", &tle::DecodingMode::isMinP)
+        .def("useRejectionSampling", &tle::DecodingMode::useRejectionSampling)
+        .def("isUseRejectionSampling", &tle::DecodingMode::isUseRejectionSampling)
+        .def("useFusedSampling", &tle::DecodingMode::useFusedSampling)
+        .def("isUseFusedSampling", &tle::DecodingMode::isUseFusedSampling)
         .def("isBeamSearch", &tle::DecodingMode::isBeamSearch)
         .def("isMedusa", &tle::DecodingMode::isMedusa)
         .def("isLookahead", &tle::DecodingMode::isLookahead)
@@ -93,11 +108,30 @@ void InitBindings(pybind11::module_& m)
 
     py::enum_<tle::CapacitySchedulerPolicy>(m, "CapacitySchedulerPolicy")
         .value("MAX_UTILIZATION", tle::CapacitySchedulerPolicy::kMAX_UTILIZATION)
-        .value("GUARANTEED_NO_EVICT", tle::CapacitySchedulerPolicy::kGUARANTEED_NO_EVICT);
+        .value("GUARANTEED_NO_EVICT", tle::CapacitySchedulerPolicy::kGUARANTEED_NO_EVICT)
+        .value("PRIORITY_PREEMPTIVE", tle::CapacitySchedulerPolicy::kPRIORITY_PREEMPTIVE);
 
     py::enum_<tle::ContextChunkingPolicy>(m, "ContextChunkingPolicy")
         .value("EQUAL_PROGRESS", tle::ContextChunkingPolicy::kEQUAL_PROGRESS)
-        .value("FIRST_COME_FIRST_SERVED", tle::ContextChunkingPolicy::kFIRST_COME_FIRST_SERVED);
+        .value("FIRST_COME_FIRST_SERVED", tle::ContextChunkingPolicy::kFIRST_COME_FIRST_SERVED)
+        .value("LEAST_SLACK_FIRST", tle::ContextChunkingPolicy::kLEAST_SLACK_FIRST)
+        .value("LATENCY_TARGET", tle::ContextChunkingPolicy::kLATENCY_TARGET);
+
+    py::enum_<tle::AdmissionDecision>(m, "AdmissionDecision")
+        .value("ADMIT", tle::AdmissionDecision::kADMIT)
+        .value("DEFER", tle::AdmissionDecision::kDEFER)
+        .value("REJECT", tle::AdmissionDecision::kREJECT);
+
+    py::enum_<tle::BatchLimitTuningObjective>(m, "BatchLimitTuningObjective")
+        .value("MAX_THROUGHPUT", tle::BatchLimitTuningObjective::kMAX_THROUGHPUT)
+        .value("LATENCY_BOUND", tle::BatchLimitTuningObjective::kLATENCY_BOUND);
+
+    py::enum_<tle::BatchLimitDecision>(m, "BatchLimitDecision")
+        .value("KEEP", tle::BatchLimitDecision::kKEEP)
+        .value("RAISE", tle::BatchLimitDecision::kRAISE)
+        .value("LOWER_THROUGHPUT", tle::BatchLimitDecision::kLOWER_THROUGHPUT)
+        .value("LOWER_LATENCY", tle::BatchLimitDecision::kLOWER_LATENCY)
+        .value("LOWER_KV_PRESSURE", tle::BatchLimitDecision::kLOWER_KV_PRESSURE);
 
     py::enum_<tle::CommunicationType>(m, "CommunicationType").value("MPI", tle::CommunicationType::kMPI);
 
@@ -133,6 +167,57 @@ void InitBindings(pybind11::module_& m)
         .def_readwrite("micro_batch_id", &tle::InflightBatchingStats::microBatchId)
         .def_readwrite("avg_num_decoded_tokens_per_iter", &tle::InflightBatchingStats::avgNumDecodedTokensPerIter);
 
+    py::class_<tle::MemoryTagStats>(m, "MemoryTagStats")
+        .def(py::init<>())
+        .def_readwrite("tag", &tle::MemoryTagStats::tag)
+        .def_readwrite("gpu_mem_usage", &tle::MemoryTagStats::gpuMemUsage)
+        .def_readwrite("cpu_mem_usage", &tle::MemoryTagStats::cpuMemUsage)
+        .def_readwrite("pinned_mem_usage", &tle::MemoryTagStats::pinnedMemUsage)
+        .def_readwrite("peak_gpu_mem_usage", &tle::MemoryTagStats::peakGpuMemUsage)
+        .def_readwrite("peak_cpu_mem_usage", &tle::MemoryTagStats::peakCpuMemUsage)
+        .def_readwrite("peak_pinned_mem_usage", &tle::MemoryTagStats::peakPinnedMemUsage);
+
+    py::class_<tle::PinnedStagingStats>(m, "PinnedStagingStats")
+        .def(py::init<>())
+        .def_readwrite("reserved_bytes", &tle::PinnedStagingStats::reservedBytes)
+        .def_readwrite("used_bytes", &tle::PinnedStagingStats::usedBytes)
+        .def_readwrite("num_allocations", &tle::PinnedStagingStats::numAllocations)
+        .def_readwrite("num_misses", &tle::PinnedStagingStats::numMisses)
+        .def_readwrite("trimmed_bytes", &tle::PinnedStagingStats::trimmedBytes);
+
+    m.def(
+        "get_pinned_staging_stats", []() { return tensorrt_llm::runtime::PinnedStagingPool::getInstance().getStats(); },
+        "Stats of the pinned staging pool of this process since the previous call.");
+
+    py::class_<tle::WeightStreamingStats>(m, "WeightStreamingStats")
+        .def(py::init<>())
+        .def_readwrite("streamable_bytes", &tle::WeightStreamingStats::streamableBytes)
+        .def_readwrite("budget_bytes", &tle::WeightStreamingStats::budgetBytes)
+        .def_readwrite("streamed_bytes", &tle::WeightStreamingStats::streamedBytes)
+        .def_readwrite("num_forwards", &tle::WeightStreamingStats::numForwards)
+        .def_readwrite("num_budget_changes", &tle::WeightStreamingStats::numBudgetChanges);
+
+    py::class_<tle::LoraCacheStats>(m, "LoraCacheStats")
+        .def(py::init<>())
+        .def_readwrite("num_host_hits", &tle::LoraCacheStats::numHostHits)
+        .def_readwrite("num_host_misses", &tle::LoraCacheStats::numHostMisses)
+        .def_readwrite("num_host_evictions", &tle::LoraCacheStats::numHostEvictions)
+        .def_readwrite("num_device_hits", &tle::LoraCacheStats::numDeviceHits)
+        .def_readwrite("num_device_misses", &tle::LoraCacheStats::numDeviceMisses)
+        .def_readwrite("num_device_evictions", &tle::LoraCacheStats::numDeviceEvictions)
+        .def_readwrite("host_load_ms", &tle::LoraCacheStats::hostLoadMS)
+        .def_readwrite("device_load_ms", &tle::LoraCacheStats::deviceLoadMS);
+
+    m.def(
+        "get_lora_cache_stats", []() { return tensorrt_llm::runtime::LoraCacheCounters::getInstance().getStats(); },
+        "Stats of the LoRA adapter caches of this process since the previous call.");
+
+    py::class_<tle::MoeLayerLoadStats>(m, "MoeLayerLoadStats")
+        .def(py::init<>())
+        .def_readwrite("layer", &tle::MoeLayerLoadStats::layer)
+        .def_readwrite("num_tokens_per_expert", &tle::MoeLayerLoadStats::numTokensPerExpert)
+        .def_readwrite("max_to_mean_ratio", &tle::MoeLayerLoadStats::maxToMeanRatio);
+
     py::class_<tle::IterationStats>(m, "IterationStats")
         .def(py::init<>())
         .def_readwrite("timestamp", &tle::IterationStats::timestamp)
@@ -153,6 +238,68 @@ void InitBindings(pybind11::module_& m)
             [](tle::IterationStats const& iterationStats)
             { return tle::JsonSerialization::toJsonStr(iterationStats); });
 
+    py::class_<tle::WarmupPhaseStats>(m, "WarmupPhaseStats")
+        .def(py::init<>())
+        .def_readwrite("name", &tle::WarmupPhaseStats::name)
+        .def_readwrite("num_batches", &tle::WarmupPhaseStats::numBatches)
+        .def_readwrite("duration_ms", &tle::WarmupPhaseStats::durationMS);
+
+    py::class_<tle::WarmupStats>(m, "WarmupStats")
+        .def(py::init<>())
+        .def_readwrite("phases", &tle::WarmupStats::phases)
+        .def_readwrite("total_duration_ms", &tle::WarmupStats::totalDurationMS);
+
+    py::class_<tle::StartupPhaseStats>(m, "StartupPhaseStats")
+        .def(py::init<>())
+        .def_readwrite("name", &tle::StartupPhaseStats::name)
+        .def_readwrite("count", &tle::StartupPhaseStats::count)
+        .def_readwrite("duration_ms", &tle::StartupPhaseStats::durationMS);
+
+    py::class_<tle::StartupStats>(m, "StartupStats")
+        .def(py::init<>())
+        .def_readwrite("phases", &tle::StartupStats::phases)
+        .def_readwrite("total_duration_ms", &tle::StartupStats::totalDurationMS);
+
+    m.def("get_startup_stats", &tensorrt_llm::common::getStartupStats,
+        "Time spent in each phase of bringing up the executors of this process.");
+
+    py::class_<tle::AdmissionHeadroom>(m, "AdmissionHeadroom")
+        .def(py::init<>())
+        .def_readwrite("free_num_blocks", &tle::AdmissionHeadroom::freeNumBlocks)
+        .def_readwrite("queued_num_blocks", &tle::AdmissionHeadroom::queuedNumBlocks)
+        .def_readwrite("headroom_num_blocks", &tle::AdmissionHeadroom::headroomNumBlocks)
+        .def_readwrite("commitment", &tle::AdmissionHeadroom::commitment)
+        .def_readwrite("estimated_queue_delay_ms", &tle::AdmissionHeadroom::estimatedQueueDelayMS)
+        .def_readwrite("decision", &tle::AdmissionHeadroom::decision);
+
+    py::register_exception<tle::AdmissionRejectedError>(m, "AdmissionRejectedError", PyExc_RuntimeError);
+
+    auto admissionControlConfigGetstate = [](tle::AdmissionControlConfig const& self)
+    { return py::make_tuple(self.getDeferWatermark(), self.getRejectWatermark()); };
+    auto admissionControlConfigSetstate = [](py::tuple state)
+    {
+        if (state.size() != 2)
+        {
+            throw std::runtime_error("Invalid state!");
+        }
+        return tle::AdmissionControlConfig(
+            state[0].cast<std::optional<float>>(), state[1].cast<std::optional<float>>());
+    };
+    py::class_<tle::AdmissionControlConfig>(m, "AdmissionControlConfig")
+        .def(py::init<std::optional<float>, std::optional<float>>(), py::arg("defer_watermark") = py::none(),
+            py::arg("reject_watermark") = py::none())
+        .def_property_readonly("defer_watermark", &tle::AdmissionControlConfig::getDeferWatermark)
+        .def_property_readonly("reject_watermark", &tle::AdmissionControlConfig::getRejectWatermark)
+        .def(py::pickle(admissionControlConfigGetstate, admissionControlConfigSetstate));
+
+    py::class_<tle::WarmupConfig>(m, "WarmupConfig")
+        .def(py::init<std::vector<SizeType32>, std::vector<SizeType32>, SizeType32>(),
+            py::arg("batch_sizes") = std::vector<SizeType32>{1},
+            py::arg("input_lengths") = std::vector<SizeType32>{128}, py::arg("output_length") = 8)
+        .def_property_readonly("batch_sizes", &tle::WarmupConfig::getBatchSizes)
+        .def_property_readonly("input_lengths", &tle::WarmupConfig::getInputLengths)
+        .def_property_readonly("output_length", &tle::WarmupConfig::getOutputLength);
+
     py::class_<tle::DebugTensorsPerIteration>(m, "DebugTensorsPerIteration")
         .def(py::init<>())
         .def_readwrite("iter", &tle::DebugTensorsPerIteration::iter)
@@ -169,6 +316,36 @@ void InitBindings(pybind11::module_& m)
         .def(py::init<>())
         .def_readwrite("kv_cache_transfer_ms", &tle::DisServingRequestStats::kvCacheTransferMS);
 
+    py::class_<tle::RequestTimingStats>(m, "RequestTimingStats")
+        .def(py::init<>())
+        .def_readwrite("arrival_time_us", &tle::RequestTimingStats::arrivalTimeUs)
+        .def_readwrite("first_scheduled_ms", &tle::RequestTimingStats::firstScheduledMS)
+        .def_readwrite("context_chunk_end_ms", &tle::RequestTimingStats::contextChunkEndMS)
+        .def_readwrite("first_token_ms", &tle::RequestTimingStats::firstTokenMS)
+        .def_readwrite("last_token_ms", &tle::RequestTimingStats::lastTokenMS)
+        .def_readwrite("paused_ms", &tle::RequestTimingStats::pausedMS)
+        .def_readwrite("num_pauses", &tle::RequestTimingStats::numPauses);
+
+    // Observations are timestamped when they are recorded
+    using RequestTimingCollector = tensorrt_llm::runtime::RequestTimingCollector;
+    py::class_<RequestTimingCollector>(m, "RequestTimingCollector")
+        .def(py::init<>())
+        .def(
+            "record_arrival", [](RequestTimingCollector& self, IdType requestId)
+            { self.recordArrival(requestId, RequestTimingCollector::Clock::now()); },
+            py::arg("request_id"))
+        .def(
+            "record_request_stats", [](RequestTimingCollector& self, tle::RequestStatsPerIteration const& stats)
+            { self.recordRequestStats(stats, RequestTimingCollector::Clock::now()); },
+            py::arg("stats"))
+        .def(
+            "record_responses", [](RequestTimingCollector& self, std::vector<tle::Response> const& responses)
+            { self.recordResponses(responses, RequestTimingCollector::Clock::now()); },
+            py::arg("responses"))
+        .def("get_timing_stats", &RequestTimingCollector::getTimingStats, py::arg("request_id"))
+        .def("take", &RequestTimingCollector::take, py::arg("request_id"))
+        .def_property_readonly("num_requests", &RequestTimingCollector::getNumRequests);
+
     py::class_<tle::RequestStats>(m, "RequestStats")
         .def(py::init<>())
         .def_readwrite("id", &tle::RequestStats::id)
@@ -261,6 +438,26 @@ void InitBindings(pybind11::module_& m)
         .def_property("no_repeat_ngram_size", &tle::SamplingConfig::getNoRepeatNgramSize,
             &tle::SamplingConfig::setNoRepeatNgramSize);
 
+    auto responseCoalescingConfigGetstate = [](tle::ResponseCoalescingConfig const& self)
+    { return py::make_tuple(self.getMaxTokens(), self.getMaxDelay(), self.getFlushTokens()); };
+    auto responseCoalescingConfigSetstate = [](py::tuple state)
+    {
+        if (state.size() != 3)
+        {
+            throw std::runtime_error("Invalid state!");
+        }
+        return tle::ResponseCoalescingConfig(state[0].cast<std::optional<SizeType32>>(),
+            state[1].cast<std::optional<std::chrono::milliseconds>>(), state[2].cast<VecTokens>());
+    };
+    py::class_<tle::ResponseCoalescingConfig>(m, "ResponseCoalescingConfig")
+        .def(py::init<std::optional<SizeType32>, std::optional<std::chrono::milliseconds>, VecTokens>(),
+            py::arg("max_tokens") = py::none(), py::arg("max_delay") = py::none(),
+            py::arg("flush_tokens") = VecTokens{})
+        .def_property_readonly("max_tokens", &tle::ResponseCoalescingConfig::getMaxTokens)
+        .def_property_readonly("max_delay", &tle::ResponseCoalescingConfig::getMaxDelay)
+        .def_property_readonly("flush_tokens", &tle::ResponseCoalescingConfig::getFlushTokens)
+        .def(py::pickle(responseCoalescingConfigGetstate, responseCoalescingConfigSetstate));
+
     py::class_<tle::OutputConfig>(m, "OutputConfig")
         .def(py::init<bool, bool, bool, bool, bool>(), py::arg("return_log_probs") = false,
             py::arg("return_context_logits") = false, py::arg("return_generation_logits") = false,
@@ -301,6 +498,12 @@ void InitBindings(pybind11::module_& m)
     py::class_<tle::ContextPhaseParams>(m, "ContextPhaseParams")
         .def(py::init<VecTokens>(), py::arg("first_gen_tokens"));
 
+    py::class_<tle::LatencySloConfig>(m, "LatencySloConfig")
+        .def(py::init<std::optional<std::chrono::milliseconds>, std::optional<std::chrono::milliseconds>>(),
+            py::arg("time_to_first_token") = py::none(), py::arg("inter_token_latency") = py::none())
+        .def_property_readonly("time_to_first_token", &tle::LatencySloConfig::getTimeToFirstToken)
+        .def_property_readonly("inter_token_latency", &tle::LatencySloConfig::getInterTokenLatency);
+
     py::class_<tle::Request> request(m, "Request");
     request
         // A modified version of constructor to accpect deprecated args maxNewTokens
@@ -413,6 +616,23 @@ void InitBindings(pybind11::module_& m)
         .def_property_readonly("error_msg", &tle::Response::getErrorMsg)
         .def_property_readonly("result", &tle::Response::getResult);
 
+    py::class_<tle::MigratedRequest>(m, "MigratedRequest")
+        .def(py::init(
+                 [](tle::Request request, tle::VecTokens generatedTokens, std::uint64_t randomStep,
+                     tle::ContextPhaseParams contextPhaseParams, std::optional<tle::VecLogProbs> logProbs,
+                     std::optional<tle::FloatType> cumLogProb)
+                 {
+                     return tle::MigratedRequest{std::move(request), std::move(generatedTokens), std::move(logProbs),
+                         cumLogProb, randomStep, std::move(contextPhaseParams)};
+                 }),
+            py::arg("request"), py::arg("generated_tokens"), py::arg("random_step"), py::arg("context_phase_params"),
+            py::arg("log_probs") = py::none(), py::arg("cum_log_prob") = py::none())
+        .def_readonly("request", &tle::MigratedRequest::request)
+        .def_readonly("generated_tokens", &tle::MigratedRequest::generatedTokens)
+        .def_readonly("log_probs", &tle::MigratedRequest::logProbs)
+        .def_readonly("cum_log_prob", &tle::MigratedRequest::cumLogProb)
+        .def_readonly("random_step", &tle::MigratedRequest::randomStep);
+
     auto schedulerConfigSetstate = [](py::tuple state)
     {
         if (state.size() != 2)
@@ -479,6 +699,12 @@ void InitBindings(pybind11::module_& m)
         .def_property("worker_executable_path", &tle::OrchestratorConfig::getWorkerExecutablePath,
             &tle::OrchestratorConfig::setWorkerExecutablePath);
 
+    py::class_<tensorrt_llm::runtime::OrchestratorWorkerPool>(m, "OrchestratorWorkerPool")
+        .def(py::init<std::string, SizeType32>(), py::arg("worker_executable_path"), py::arg("num_workers"))
+        .def_property_readonly("num_workers", &tensorrt_llm::runtime::OrchestratorWorkerPool::getNumWorkers)
+        .def("attach", &tensorrt_llm::runtime::OrchestratorWorkerPool::attach, py::arg("model_path"),
+            py::arg("executor_config"));
+
     auto parallelConfigGetstate = [](tle::ParallelConfig const& self)
     {
         return py::make_tuple(self.getCommunicationType(), self.getCommunicationMode(), self.getDeviceIds(),
@@ -576,6 +802,93 @@ void InitBindings(pybind11::module_& m)
         .def_property("medusa_choices", &tle::DecodingConfig::getMedusaChoices, &tle::DecodingConfig::setMedusaChoices)
         .def(py::pickle(decodingConfigGetstate, decodingConfigSetstate));
 
+    auto draftTargetConfigGetstate = [](tle::DraftTargetConfig const& self)
+    { return py::make_tuple(self.getDraftModelPath(), self.getMaxDraftLen(), self.getDraftKvCacheFraction()); };
+    auto draftTargetConfigSetstate = [](py::tuple state)
+    {
+        if (state.size() != 3)
+        {
+            throw std::runtime_error("Invalid state!");
+        }
+        return tle::DraftTargetConfig(state[0].cast<std::filesystem::path>(), state[1].cast<SizeType32>(),
+            state[2].cast<std::optional<tle::FloatType>>());
+    };
+    py::class_<tle::DraftTargetConfig>(m, "DraftTargetConfig")
+        .def(py::init<std::filesystem::path, SizeType32, std::optional<tle::FloatType>>(), py::arg("draft_model_path"),
+            py::arg("max_draft_len"), py::arg("draft_kv_cache_fraction") = py::none())
+        .def_property_readonly("draft_model_path", &tle::DraftTargetConfig::getDraftModelPath)
+        .def_property_readonly("max_draft_len", &tle::DraftTargetConfig::getMaxDraftLen)
+        .def_property_readonly("draft_kv_cache_fraction", &tle::DraftTargetConfig::getDraftKvCacheFraction)
+        .def(py::pickle(draftTargetConfigGetstate, draftTargetConfigSetstate));
+
+    auto medusaTreeTuningConfigGetstate = [](tle::MedusaTreeTuningConfig const& self)
+    { return py::make_tuple(self.getUpdateInterval(), self.getPinned(), self.getMaxChildRank(), self.getSmoothing()); };
+    auto medusaTreeTuningConfigSetstate = [](py::tuple state)
+    {
+        if (state.size() != 4)
+        {
+            throw std::runtime_error("Invalid state!");
+        }
+        return tle::MedusaTreeTuningConfig(state[0].cast<SizeType32>(), state[1].cast<bool>(),
+            state[2].cast<SizeType32>(), state[3].cast<tle::FloatType>());
+    };
+    py::class_<tle::MedusaTreeTuningConfig>(m, "MedusaTreeTuningConfig")
+        .def(py::init<SizeType32, bool, SizeType32, tle::FloatType>(), py::arg("update_interval") = 256,
+            py::arg("pinned") = false, py::arg("max_child_rank") = 10, py::arg("smoothing") = 0.5F)
+        .def_property_readonly("update_interval", &tle::MedusaTreeTuningConfig::getUpdateInterval)
+        .def_property_readonly("pinned", &tle::MedusaTreeTuningConfig::getPinned)
+        .def_property_readonly("max_child_rank", &tle::MedusaTreeTuningConfig::getMaxChildRank)
+        .def_property_readonly("smoothing", &tle::MedusaTreeTuningConfig::getSmoothing)
+        .def(py::pickle(medusaTreeTuningConfigGetstate, medusaTreeTuningConfigSetstate));
+
+    auto batchLimitTuningConfigGetstate = [](tle::BatchLimitTuningConfig const& self)
+    {
+        return py::make_tuple(self.getObjective(), self.getTargetIterLatencyMS(), self.getUpdateInterval(),
+            self.getKvCacheWatermark(), self.getMinBatchSize(), self.getMinNumTokens());
+    };
+    auto batchLimitTuningConfigSetstate = [](py::tuple state)
+    {
+        if (state.size() != 6)
+        {
+            throw std::runtime_error("Invalid state!");
+        }
+        return tle::BatchLimitTuningConfig(state[0].cast<tle::BatchLimitTuningObjective>(),
+            state[1].cast<std::optional<tle::FloatType>>(), state[2].cast<SizeType32>(),
+            state[3].cast<tle::FloatType>(), state[4].cast<SizeType32>(), state[5].cast<SizeType32>());
+    };
+    py::class_<tle::BatchLimitTuningConfig>(m, "BatchLimitTuningConfig")
+        .def(py::init<tle::BatchLimitTuningObjective, std::optional<tle::FloatType>, SizeType32, tle::FloatType,
+                 SizeType32, SizeType32>(),
+            py::arg("objective") = tle::BatchLimitTuningObjective::kMAX_THROUGHPUT,
+            py::arg("target_iter_latency_ms") = py::none(), py::arg("update_interval") = 16,
+            py::arg("kv_cache_watermark") = 0.95F, py::arg("min_batch_size") = 1, py::arg("min_num_tokens") = 64)
+        .def_property_readonly("objective", &tle::BatchLimitTuningConfig::getObjective)
+        .def_property_readonly("target_iter_latency_ms", &tle::BatchLimitTuningConfig::getTargetIterLatencyMS)
+        .def_property_readonly("update_interval", &tle::BatchLimitTuningConfig::getUpdateInterval)
+        .def_property_readonly("kv_cache_watermark", &tle::BatchLimitTuningConfig::getKvCacheWatermark)
+        .def_property_readonly("min_batch_size", &tle::BatchLimitTuningConfig::getMinBatchSize)
+        .def_property_readonly("min_num_tokens", &tle::BatchLimitTuningConfig::getMinNumTokens)
+        .def(py::pickle(batchLimitTuningConfigGetstate, batchLimitTuningConfigSetstate));
+
+    auto cpuAffinityConfigGetstate = [](tle::CpuAffinityConfig const& self)
+    { return py::make_tuple(self.getDeviceCpus(), self.getNumaLocalHostMemory()); };
+    auto cpuAffinityConfigSetstate = [](py::tuple state)
+    {
+        if (state.size() != 2)
+        {
+            throw std::runtime_error("Invalid state!");
+        }
+        return tle::CpuAffinityConfig(
+            state[0].cast<std::map<SizeType32, std::vector<SizeType32>>>(), state[1].cast<bool>());
+    };
+    py::class_<tle::CpuAffinityConfig>(m, "CpuAffinityConfig")
+        .def(py::init<std::map<SizeType32, std::vector<SizeType32>>, bool>(),
+            py::arg("device_cpus") = std::map<SizeType32, std::vector<SizeType32>>{},
+            py::arg("numa_local_host_memory") = true)
+        .def_property_readonly("device_cpus", &tle::CpuAffinityConfig::getDeviceCpus)
+        .def_property_readonly("numa_local_host_memory", &tle::CpuAffinityConfig::getNumaLocalHostMemory)
+        .def(py::pickle(cpuAffinityConfigGetstate, cpuAffinityConfigSetstate));
+
     auto debugConfigGetstate = [](tle::DebugConfig const& self)
     {
         return py::make_tuple(self.getDebugInputTensors(), self.getDebugOutputTensors(), self.getDebugTensorNames(),
@@ -664,7 +977,7 @@ void InitBindings(pybind11::module_& m)
         {
             throw std::runtime_error("Invalid state!");
         }
-        return tle::ExecutorConfig(state[0].cast<SizeType32>(), state[1].cast<tle::SchedulerConfig>(),
+        auto config = tle::ExecutorConfig(state[0].cast<SizeType32>(), state[1].cast<tle::SchedulerConfig>(),
             state[2].cast<tle::KvCacheConfig>(), state[3].cast<bool>(), state[4].cast<bool>(),
             state[5].cast<SizeType32>(), state[6].cast<SizeType32>(), state[7].cast<tle::BatchingType>(),
             state[8].cast<std::optional<SizeType32>>(), state[9].cast<std::optional<SizeType32>>(),
@@ -674,6 +987,7 @@ void InitBindings(pybind11::module_& m)
             state[15].cast<std::optional<SizeType32>>(), state[16].cast<tle::ExtendedRuntimePerfKnobConfig>(),
             state[17].cast<std::optional<tle::DebugConfig>>(), state[18].cast<SizeType32>(),
             state[19].cast<uint64_t>());
+        return config;
     };
     py::class_<tle::ExecutorConfig>(m, "ExecutorConfig")
         .def(py::init<SizeType32, tle::SchedulerConfig const&, tle::KvCacheConfig const&, bool, bool, SizeType32,
@@ -732,6 +1046,8 @@ void InitBindings(pybind11::module_& m)
             &tle::ExecutorConfig::setMaxSeqIdleMicroseconds)
         .def(py::pickle(executorConfigGetState, executorConfigSetState));
 
+    tensorrt_llm::pybind::executor::ResponseColumns::initBindings(m);
+    tensorrt_llm::pybind::executor::ResponseStream::initBindings(m);
     tensorrt_llm::pybind::executor::Executor::initBindings(m);
 }
 
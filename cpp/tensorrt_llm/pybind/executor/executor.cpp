@@ -21,6 +21,8 @@
 #include "tensorrt_llm/executor/tensor.h"
 #include "tensorrt_llm/pybind/utils/pathCaster.h"
 
+#include <algorithm>
+
 #include <pybind11/chrono.h>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
@@ -79,20 +81,29 @@ tle::Tensor numpyToTensor(py::array const& array)
 namespace tensorrt_llm::pybind::executor
 {
 
-Executor::Executor(
-    std::filesystem::path const& modelPath, tle::ModelType modelType, tle::ExecutorConfig const& executorConfig)
+Executor::Executor(std::filesystem::path const& modelPath, tle::ModelType modelType,
+    tle::ExecutorConfig const& executorConfig, std::optional<tle::ResponseCoalescingConfig> responseCoalescingConfig)
+    : mCoalescer{std::make_shared<runtime::ResponseCoalescer>(std::move(responseCoalescingConfig))}
 {
     mExecutor = std::make_unique<tle::Executor>(modelPath, modelType, executorConfig);
+    mParseJsonConfig = [modelPath]() { return runtime::GptJsonConfig::parse(modelPath / "config.json"); };
+    mEnableChunkedContext = executorConfig.getEnableChunkedContext();
 }
 
 Executor::Executor(std::filesystem::path const& encoderModelPath, std::filesystem::path const& decoderModelPath,
-    tle::ModelType modelType, tle::ExecutorConfig const& executorConfig)
+    tle::ModelType modelType, tle::ExecutorConfig const& executorConfig,
+    std::optional<tle::ResponseCoalescingConfig> responseCoalescingConfig)
+    : mCoalescer{std::make_shared<runtime::ResponseCoalescer>(std::move(responseCoalescingConfig))}
 {
     mExecutor = std::make_unique<tle::Executor>(encoderModelPath, decoderModelPath, modelType, executorConfig);
+    mParseJsonConfig = [decoderModelPath]() { return runtime::GptJsonConfig::parse(decoderModelPath / "config.json"); };
+    mEnableChunkedContext = executorConfig.getEnableChunkedContext();
 }
 
 Executor::Executor(pybind11::buffer engineBuffer, std::string const& jsonConfigStr, tle::ModelType modelType,
-    tle::ExecutorConfig const& executorConfig, std::optional<pybind11::dict> managedWeights)
+    tle::ExecutorConfig const& executorConfig, std::optional<pybind11::dict> managedWeights,
+    std::optional<tle::ResponseCoalescingConfig> responseCoalescingConfig)
+    : mCoalescer{std::make_shared<runtime::ResponseCoalescer>(std::move(responseCoalescingConfig))}
 {
     py::buffer_info info = engineBuffer.request();
     uint8_t const* data = reinterpret_cast<uint8_t const*>(info.ptr);
@@ -110,11 +121,14 @@ Executor::Executor(pybind11::buffer engineBuffer, std::string const& jsonConfigS
     }
     mExecutor = std::make_unique<tle::Executor>(
         tle::BufferView(data, size), jsonConfigStr, modelType, executorConfig, managedWeightsMap);
+    mParseJsonConfig = [jsonConfigStr]() { return runtime::GptJsonConfig::parse(jsonConfigStr); };
+    mEnableChunkedContext = executorConfig.getEnableChunkedContext();
 }
 
 Executor::Executor(std::string const& encoderEngineBuffer, std::string const& encoderJsonConfigStr,
     std::string const& decoderEngineBuffer, std::string const& decoderJsonConfigStr, tle::ModelType modelType,
-    tle::ExecutorConfig const& executorConfig)
+    tle::ExecutorConfig const& executorConfig, std::optional<tle::ResponseCoalescingConfig> responseCoalescingConfig)
+    : mCoalescer{std::make_shared<runtime::ResponseCoalescer>(std::move(responseCoalescingConfig))}
 {
     uint8_t const* encoderData = reinterpret_cast<uint8_t const*>(encoderEngineBuffer.data());
     size_t encoderSize = encoderEngineBuffer.size();
@@ -122,6 +136,83 @@ Executor::Executor(std::string const& encoderEngineBuffer, std::string const& en
     size_t decoderSize = decoderEngineBuffer.size();
     mExecutor = std::make_unique<tle::Executor>(tle::BufferView(encoderData, encoderSize), encoderJsonConfigStr,
         tle::BufferView(decoderData, decoderSize), decoderJsonConfigStr, modelType, executorConfig);
+    mParseJsonConfig = [decoderJsonConfigStr]() { return runtime::GptJsonConfig::parse(decoderJsonConfigStr); };
+    mEnableChunkedContext = executorConfig.getEnableChunkedContext();
+}
+
+tle::IdType Executor::enqueueRequest(
+    tle::Request request, std::optional<tle::ResponseCoalescingConfig> responseCoalescingConfig)
+{
+    auto const requestId = mExecutor->enqueueRequest(std::move(request));
+    if (responseCoalescingConfig)
+    {
+        // Responses that beat the registration are coalesced with the default config
+        mCoalescer->setRequestConfig(requestId, std::move(*responseCoalescingConfig));
+    }
+    return requestId;
+}
+
+std::vector<tle::IdType> Executor::enqueueRequests(std::vector<tle::Request> requests,
+    std::vector<std::optional<tle::ResponseCoalescingConfig>> responseCoalescingConfigs)
+{
+    TLLM_CHECK_WITH_INFO(responseCoalescingConfigs.empty() || responseCoalescingConfigs.size() == requests.size(),
+        "Expected one response coalescing config per request, got %zu for %zu requests",
+        responseCoalescingConfigs.size(), requests.size());
+    auto requestIds = mExecutor->enqueueRequests(std::move(requests));
+    for (std::size_t i = 0; i < responseCoalescingConfigs.size(); ++i)
+    {
+        if (responseCoalescingConfigs[i])
+        {
+            mCoalescer->setRequestConfig(requestIds[i], std::move(*responseCoalescingConfigs[i]));
+        }
+    }
+    return requestIds;
+}
+
+std::vector<tle::Response> Executor::awaitCoalescedResponses(std::optional<std::chrono::milliseconds> const& timeout)
+{
+    using Clock = runtime::ResponseCoalescer::Clock;
+    if (!mCoalescer->isEnabled())
+    {
+        return mExecutor->awaitResponses(timeout);
+    }
+    std::optional<Clock::time_point> deadline;
+    if (timeout)
+    {
+        deadline = Clock::now() + *timeout;
+    }
+    while (true)
+    {
+        auto responses = mCoalescer->flushExpired();
+        if (!responses.empty())
+        {
+            return responses;
+        }
+        // Wake up for the held responses that expire before the timeout
+        auto wakeUp = deadline;
+        auto const heldDeadline = mCoalescer->getNextDeadline();
+        bool const heldFirst = heldDeadline && (!wakeUp || *heldDeadline < *wakeUp);
+        if (heldFirst)
+        {
+            wakeUp = heldDeadline;
+        }
+        std::optional<std::chrono::milliseconds> wait;
+        if (wakeUp)
+        {
+            wait = std::max(
+                std::chrono::ceil<std::chrono::milliseconds>(*wakeUp - Clock::now()), std::chrono::milliseconds{0});
+        }
+        responses = mCoalescer->push(mExecutor->awaitResponses(wait));
+        if (!responses.empty())
+        {
+            return responses;
+        }
+        if (!heldFirst && (!deadline || Clock::now() >= *deadline))
+        {
+            // Timed out, or woken up without responses, e.g. by a shutdown
+            return mCoalescer->flushExpired();
+        }
+    }
 }
 
 py::object Executor::enter()
@@ -151,24 +242,30 @@ void Executor::shutdown()
 void Executor::initBindings(py::module_& m)
 {
     py::class_<Executor>(m, "Executor")
-        .def(py::init<std::filesystem::path const&, tle::ModelType, tle::ExecutorConfig const&>(),
-            py::arg("model_path"), py::arg("model_type"), py::arg("executor_config"))
+        .def(py::init<std::filesystem::path const&, tle::ModelType, tle::ExecutorConfig const&,
+                 std::optional<tle::ResponseCoalescingConfig>>(),
+            py::arg("model_path"), py::arg("model_type"), py::arg("executor_config"),
+            py::arg("response_coalescing_config") = py::none())
         .def(py::init<std::filesystem::path const&, std::filesystem::path const&, tle::ModelType,
-                 tle::ExecutorConfig const&>(),
+                 tle::ExecutorConfig const&, std::optional<tle::ResponseCoalescingConfig>>(),
             py::arg("encoder_model_path"), py::arg("decoder_model_path"), py::arg("model_type"),
-            py::arg("executor_config"))
-        .def(py::init<py::buffer, std::string const&, tle::ModelType, tle::ExecutorConfig const&, py::dict>(),
+            py::arg("executor_config"), py::arg("response_coalescing_config") = py::none())
+        .def(py::init<py::buffer, std::string const&, tle::ModelType, tle::ExecutorConfig const&, py::dict,
+                 std::optional<tle::ResponseCoalescingConfig>>(),
             py::arg("engine_buffer"), py::arg("json_config_str"), py::arg("model_type"), py::arg("executor_config"),
-            py::arg("managed_weights") = py::dict())
+            py::arg("managed_weights") = py::dict(), py::arg("response_coalescing_config") = py::none())
         .def(py::init<std::string const&, std::string const&, std::string const&, std::string const&, tle::ModelType,
-                 tle::ExecutorConfig const&>(),
+                 tle::ExecutorConfig const&, std::optional<tle::ResponseCoalescingConfig>>(),
             py::arg("encoder_engine_buffer"), py::arg("encoder_json_config_str"), py::arg("decoder_engine_buffer"),
-            py::arg("decoder_json_config_str"), py::arg("model_type"), py::arg("executor_config"))
+            py::arg("decoder_json_config_str"), py::arg("model_type"), py::arg("executor_config"),
+            py::arg("response_coalescing_config") = py::none())
         .def("shutdown", &Executor::shutdown)
         .def("__enter__", &Executor::enter)
         .def("__exit__", &Executor::exit)
-        .def("enqueue_request", &Executor::enqueueRequest, py::arg("request"))
-        .def("enqueue_requests", &Executor::enqueueRequests, py::arg("requests"))
+        .def("enqueue_request", &Executor::enqueueRequest, py::arg("request"),
+            py::arg("response_coalescing_config") = py::none())
+        .def("enqueue_requests", &Executor::enqueueRequests, py::arg("requests"),
+            py::arg("response_coalescing_configs") = std::vector<std::optional<tle::ResponseCoalescingConfig>>{})
         .def("await_responses",
             py::overload_cast<std::optional<std::chrono::milliseconds> const&>(&Executor::awaitResponses),
             py::arg("timeout") = py::none())
@@ -180,11 +277,15 @@ void Executor::initBindings(py::module_& m)
             py::overload_cast<std::vector<tle::IdType> const&, std::optional<std::chrono::milliseconds> const&>(
                 &Executor::awaitResponses),
             py::arg("ids"), py::arg("timeout") = py::none())
+        .def("await_responses_columnar", &Executor::awaitResponsesColumnar, py::arg("timeout") = py::none())
+        // The stream keeps the executor alive, its thread waits for responses on it
+        .def("response_stream", &Executor::responseStream, py::keep_alive<0, 1>())
         .def("get_num_responses_ready", &Executor::getNumResponsesReady, py::arg("id") = py::none())
         .def("cancel_request", &Executor::cancelRequest, py::arg("id") = py::none())
         .def("get_latest_iteration_stats", &Executor::getLatestIterationStats)
         .def("get_latest_request_stats", &Executor::getLatestRequestStats)
         .def("get_latest_debug_tensors", &Executor::getLatestDebugTensors)
+        .def("warmup", &Executor::warmup, py::arg_v("warmup_config", tle::WarmupConfig(), "WarmupConfig()"))
         .def("can_enqueue_requests", &Executor::canEnqueueRequests);
 }
 
@@ -16,10 +16,18 @@
  */
 
 #pragma once
+#include "responseColumns.h"
+#include "responseStream.h"
 #include "tensorrt_llm/executor/executor.h"
 #include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/gptJsonConfig.h"
+#include "tensorrt_llm/runtime/responseCoalescer.h"
+#include "tensorrt_llm/runtime/warmupPlanner.h"
 #include <pybind11/pybind11.h>
 
+#include <functional>
+#include <memory>
+
 namespace tle = tensorrt_llm::executor;
 
 namespace tensorrt_llm::pybind::executor
@@ -28,33 +36,37 @@ namespace tensorrt_llm::pybind::executor
 class Executor
 {
 public:
-    Executor(
-        std::filesystem::path const& modelPath, tle::ModelType modelType, tle::ExecutorConfig const& executorConfig);
+    //! The responseCoalescingConfig is the default coalescing of the streamed responses returned by awaitResponses
+    //! and the response stream, see runtime::ResponseCoalescer. Not set to deliver every response on its own.
+    Executor(std::filesystem::path const& modelPath, tle::ModelType modelType,
+        tle::ExecutorConfig const& executorConfig,
+        std::optional<tle::ResponseCoalescingConfig> responseCoalescingConfig = std::nullopt);
 
     Executor(std::filesystem::path const& encoderModelPath, std::filesystem::path const& decoderModelPath,
-        tle::ModelType modelType, tle::ExecutorConfig const& executorConfig);
+        tle::ModelType modelType, tle::ExecutorConfig const& executorConfig,
+        std::optional<tle::ResponseCoalescingConfig> responseCoalescingConfig = std::nullopt);
 
     Executor(pybind11::buffer engineBuffer, std::string const& jsonConfigStr, tle::ModelType modelType,
-        tle::ExecutorConfig const& executorConfig, std::optional<pybind11::dict> managedWeights);
+        tle::ExecutorConfig const& executorConfig, std::optional<pybind11::dict> managedWeights,
+        std::optional<tle::ResponseCoalescingConfig> responseCoalescingConfig = std::nullopt);
 
     Executor(std::string const& encoderEngineBuffer, std::string const& encoderJsonConfigStr,
         std::string const& decoderEngineBuffer, std::string const& decoderJsonConfigStr, tle::ModelType modelType,
-        tle::ExecutorConfig const& executorConfig);
+        tle::ExecutorConfig const& executorConfig,
+        std::optional<tle::ResponseCoalescingConfig> responseCoalescingConfig = std::nullopt);
 
     pybind11::object enter();
     void exit([[maybe_unused]] pybind11::handle type, [[maybe_unused]] pybind11::handle value,
         [[maybe_unused]] pybind11::handle traceback);
     void shutdown();
 
-    [[nodiscard]] tle::IdType enqueueRequest(tle::Request request)
-    {
-        return mExecutor->enqueueRequest(std::move(request));
-    }
+    //! The responseCoalescingConfig overrides the default coalescing for the responses of this request
+    [[nodiscard]] tle::IdType enqueueRequest(
+        tle::Request request, std::optional<tle::ResponseCoalescingConfig> responseCoalescingConfig = std::nullopt);
 
-    [[nodiscard]] std::vector<tle::IdType> enqueueRequests(std::vector<tle::Request> requests)
-    {
-        return mExecutor->enqueueRequests(std::move(requests));
-    }
+    //! If not empty, responseCoalescingConfigs holds the override of each request
+    [[nodiscard]] std::vector<tle::IdType> enqueueRequests(std::vector<tle::Request> requests,
+        std::vector<std::optional<tle::ResponseCoalescingConfig>> responseCoalescingConfigs = {});
 
     [[nodiscard]] std::vector<tle::Response> awaitResponses(
         std::optional<std::chrono::milliseconds> const& timeout = std::nullopt)
@@ -62,9 +74,10 @@ public:
         // Await responses blocks until a response is received. Release GIL so that it can be ran in a background
         // thread.
         pybind11::gil_scoped_release release;
-        return mExecutor->awaitResponses(timeout);
+        return awaitCoalescedResponses(timeout);
     }
 
+    // The per-id variants return the responses as the executor produced them, without coalescing
     [[nodiscard]] std::vector<tle::Response> awaitResponses(
         tle::IdType const& requestId, std::optional<std::chrono::milliseconds> const& timeout = std::nullopt)
     {
@@ -83,11 +96,24 @@ public:
         return mExecutor->awaitResponses(requestIds, timeout);
     }
 
+    [[nodiscard]] std::unique_ptr<ResponseColumns> awaitResponsesColumnar(
+        std::optional<std::chrono::milliseconds> const& timeout = std::nullopt)
+    {
+        // The columns are built without the GIL too, only the final object crosses into Python
+        pybind11::gil_scoped_release release;
+        return std::make_unique<ResponseColumns>(awaitCoalescedResponses(timeout));
+    }
+
     [[nodiscard]] tle::SizeType32 getNumResponsesReady(std::optional<tle::IdType> const& requestId = std::nullopt) const
     {
         return mExecutor->getNumResponsesReady(requestId);
     }
 
+    [[nodiscard]] std::unique_ptr<ResponseStream> responseStream()
+    {
+        return std::make_unique<ResponseStream>(*mExecutor, mCoalescer);
+    }
+
     void cancelRequest(tle::IdType requestId)
     {
         mExecutor->cancelRequest(requestId);
@@ -108,6 +134,15 @@ public:
         return mExecutor->getLatestDebugTensors();
     }
 
+    tle::WarmupStats warmup(tle::WarmupConfig const& warmupConfig)
+    {
+        auto const limits
+            = runtime::WarmupPlanner::getLimits(mParseJsonConfig().getModelConfig(), mEnableChunkedContext);
+        // Warmup runs the execution loop, which takes the GIL during its callbacks
+        pybind11::gil_scoped_release release;
+        return runtime::WarmupPlanner::run(*mExecutor, warmupConfig, limits);
+    }
+
     [[nodiscard]] bool canEnqueueRequests() const
     {
         return mExecutor->canEnqueueRequests();
@@ -116,7 +151,17 @@ public:
     static void initBindings(pybind11::module_& m);
 
 private:
+    //! \brief Await the responses of all requests and coalesce them, waiting past a delivery until the timeout
+    //! if all were held back. Must be called without the GIL.
+    [[nodiscard]] std::vector<tle::Response> awaitCoalescedResponses(
+        std::optional<std::chrono::milliseconds> const& timeout);
+
     std::unique_ptr<tle::Executor> mExecutor;
+    //! \brief Parses the engine config of the decoder, for the limits of the warmup
+    std::function<runtime::GptJsonConfig()> mParseJsonConfig;
+    bool mEnableChunkedContext{false};
+    //! \brief Shared with the thread of the response stream
+    std::shared_ptr<runtime::ResponseCoalescer> mCoalescer;
 };
 
 } // namespace tensorrt_llm::pybind::executor
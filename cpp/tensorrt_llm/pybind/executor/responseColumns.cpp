@@ -0,0 +1,207 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "responseColumns.h"
+
+#include <pybind11/stl.h>
+
+#include <algorithm>
+
+namespace py = pybind11;
+
+namespace tensorrt_llm::pybind::executor
+{
+
+ResponseColumns::ResponseColumns(std::vector<tle::Response> const& responses)
+{
+    std::size_t numTokens{0};
+    std::size_t numLogProbs{0};
+    for (auto const& response : responses)
+    {
+        if (response.hasError())
+        {
+            mErrors.emplace_back(response.getRequestId(), response.getErrorMsg());
+            continue;
+        }
+        auto const& result = response.getResult();
+        mNumRows += result.outputTokenIds.size();
+        for (auto const& beamTokens : result.outputTokenIds)
+        {
+            numTokens += beamTokens.size();
+        }
+        if (result.logProbs)
+        {
+            mHasLogProbs = true;
+            for (auto const& beamLogProbs : *result.logProbs)
+            {
+                numLogProbs += beamLogProbs.size();
+            }
+        }
+        mHasCumLogProbs |= result.cumLogProbs.has_value();
+    }
+
+    // Lay out the columns back to back, each starting on an 8-byte boundary
+    std::size_t numBytes{0};
+    auto const place = [&numBytes](Column& column, std::size_t size, std::size_t elementSize)
+    {
+        column.byteOffset = numBytes;
+        column.size = size;
+        numBytes += (size * elementSize + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t) * sizeof(std::uint64_t);
+    };
+    place(mRequestIds, mNumRows, sizeof(tle::IdType));
+    place(mBeamIndices, mNumRows, sizeof(tle::SizeType32));
+    place(mIsFinal, mNumRows, sizeof(bool));
+    place(mTokenOffsets, mNumRows + 1, sizeof(std::int64_t));
+    place(mTokenIds, numTokens, sizeof(tle::TokenIdType));
+    place(mLogProbOffsets, mHasLogProbs ? mNumRows + 1 : 0, sizeof(std::int64_t));
+    place(mLogProbs, numLogProbs, sizeof(tle::FloatType));
+    place(mCumLogProbs, mHasCumLogProbs ? mNumRows : 0, sizeof(tle::FloatType));
+    mBuffer = std::make_unique<std::uint64_t[]>(numBytes / sizeof(std::uint64_t));
+
+    auto* requestIds = data<tle::IdType>(mRequestIds);
+    auto* beamIndices = data<tle::SizeType32>(mBeamIndices);
+    auto* isFinal = data<bool>(mIsFinal);
+    auto* tokenOffsets = data<std::int64_t>(mTokenOffsets);
+    auto* tokenIds = data<tle::TokenIdType>(mTokenIds);
+    auto* logProbOffsets = data<std::int64_t>(mLogProbOffsets);
+    auto* logProbs = data<tle::FloatType>(mLogProbs);
+    auto* cumLogProbs = data<tle::FloatType>(mCumLogProbs);
+
+    std::size_t row{0};
+    std::int64_t tokenOffset{0};
+    std::int64_t logProbOffset{0};
+    for (auto const& response : responses)
+    {
+        if (response.hasError())
+        {
+            continue;
+        }
+        auto const& result = response.getResult();
+        for (std::size_t beam = 0; beam < result.outputTokenIds.size(); ++beam, ++row)
+        {
+            requestIds[row] = response.getRequestId();
+            beamIndices[row] = static_cast<tle::SizeType32>(beam);
+            isFinal[row] = result.isFinal;
+
+            auto const& beamTokens = result.outputTokenIds[beam];
+            tokenOffsets[row] = tokenOffset;
+            std::copy(beamTokens.begin(), beamTokens.end(), tokenIds + tokenOffset);
+            tokenOffset += static_cast<std::int64_t>(beamTokens.size());
+
+            if (mHasLogProbs)
+            {
+                logProbOffsets[row] = logProbOffset;
+                if (result.logProbs && beam < result.logProbs->size())
+                {
+                    auto const& beamLogProbs = (*result.logProbs)[beam];
+                    std::copy(beamLogProbs.begin(), beamLogProbs.end(), logProbs + logProbOffset);
+                    logProbOffset += static_cast<std::int64_t>(beamLogProbs.size());
+                }
+            }
+            if (mHasCumLogProbs)
+            {
+                cumLogProbs[row] = result.cumLogProbs && beam < result.cumLogProbs->size()
+                    ? (*result.cumLogProbs)[beam]
+                    : 0.F;
+            }
+        }
+    }
+    tokenOffsets[mNumRows] = tokenOffset;
+    if (mHasLogProbs)
+    {
+        logProbOffsets[mNumRows] = logProbOffset;
+    }
+}
+
+template <typename T>
+py::array ResponseColumns::view(Column const& column, py::handle owner) const
+{
+    // The array does not copy, it keeps the owning Python object, and with it the buffer, alive
+    return py::array(py::dtype::of<T>(), {static_cast<py::ssize_t>(column.size)}, {sizeof(T)}, data<T>(column), owner);
+}
+
+void ResponseColumns::initBindings(py::module_& m)
+{
+    py::class_<ResponseColumns>(m, "ResponseColumns",
+        "Responses as flat numpy columns over one host buffer. Row i is one beam of a response, its tokens are "
+        "token_ids[token_offsets[i]:token_offsets[i + 1]]. Failed responses are listed in errors.")
+        .def_property_readonly("num_rows", &ResponseColumns::getNumRows)
+        .def("__len__", &ResponseColumns::getNumRows)
+        .def_property_readonly("errors", &ResponseColumns::getErrors)
+        .def_property_readonly("request_ids",
+            [](py::object self)
+            {
+                auto const& columns = self.cast<ResponseColumns const&>();
+                return columns.view<tle::IdType>(columns.mRequestIds, self);
+            })
+        .def_property_readonly("beam_indices",
+            [](py::object self)
+            {
+                auto const& columns = self.cast<ResponseColumns const&>();
+                return columns.view<tle::SizeType32>(columns.mBeamIndices, self);
+            })
+        .def_property_readonly("is_final",
+            [](py::object self)
+            {
+                auto const& columns = self.cast<ResponseColumns const&>();
+                return columns.view<bool>(columns.mIsFinal, self);
+            })
+        .def_property_readonly("token_offsets",
+            [](py::object self)
+            {
+                auto const& columns = self.cast<ResponseColumns const&>();
+                return columns.view<std::int64_t>(columns.mTokenOffsets, self);
+            })
+        .def_property_readonly("token_ids",
+            [](py::object self)
+            {
+                auto const& columns = self.cast<ResponseColumns const&>();
+                return columns.view<tle::TokenIdType>(columns.mTokenIds, self);
+            })
+        .def_property_readonly("log_prob_offsets",
+            [](py::object self) -> std::optional<py::array>
+            {
+                auto const& columns = self.cast<ResponseColumns const&>();
+                if (!columns.mHasLogProbs)
+                {
+                    return std::nullopt;
+                }
+                return columns.view<std::int64_t>(columns.mLogProbOffsets, self);
+            })
+        .def_property_readonly("log_probs",
+            [](py::object self) -> std::optional<py::array>
+            {
+                auto const& columns = self.cast<ResponseColumns const&>();
+                if (!columns.mHasLogProbs)
+                {
+                    return std::nullopt;
+                }
+                return columns.view<tle::FloatType>(columns.mLogProbs, self);
+            })
+        .def_property_readonly("cum_log_probs",
+            [](py::object self) -> std::optional<py::array>
+            {
+                auto const& columns = self.cast<ResponseColumns const&>();
+                if (!columns.mHasCumLogProbs)
+                {
+                    return std::nullopt;
+                }
+                return columns.view<tle::FloatType>(columns.mCumLogProbs, self);
+            });
+}
+
+} // namespace tensorrt_llm::pybind::executor
@@ -0,0 +1,90 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/executor/types.h"
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tle = tensorrt_llm::executor;
+
+namespace tensorrt_llm::pybind::executor
+{
+
+//! \brief A batch of responses as flat columns in one host buffer, exposed to Python as numpy arrays viewing it.
+//! \details A row is one beam of a successful response. The tokens of row i are
+//! token_ids[token_offsets[i]:token_offsets[i + 1]], its log probs, if requested, are
+//! log_probs[log_prob_offsets[i]:log_prob_offsets[i + 1]]. Failed responses are not rows, they are listed in errors.
+//! The columns are built without the GIL and reach Python without creating an object per token.
+class ResponseColumns
+{
+public:
+    explicit ResponseColumns(std::vector<tle::Response> const& responses);
+
+    [[nodiscard]] std::size_t getNumRows() const noexcept
+    {
+        return mNumRows;
+    }
+
+    [[nodiscard]] std::vector<std::pair<tle::IdType, std::string>> const& getErrors() const noexcept
+    {
+        return mErrors;
+    }
+
+    static void initBindings(pybind11::module_& m);
+
+private:
+    //! \brief Where a column lives in the buffer.
+    struct Column
+    {
+        std::size_t byteOffset{0};
+        std::size_t size{0};
+    };
+
+    template <typename T>
+    [[nodiscard]] T* data(Column const& column) const
+    {
+        return reinterpret_cast<T*>(reinterpret_cast<std::byte*>(mBuffer.get()) + column.byteOffset);
+    }
+
+    template <typename T>
+    [[nodiscard]] pybind11::array view(Column const& column, pybind11::handle owner) const;
+
+    std::size_t mNumRows{0};
+    bool mHasLogProbs{false};
+    bool mHasCumLogProbs{false};
+    Column mRequestIds;
+    Column mBeamIndices;
+    Column mIsFinal;
+    Column mTokenOffsets;
+    Column mTokenIds;
+    Column mLogProbOffsets;
+    Column mLogProbs;
+    Column mCumLogProbs;
+    // 8-byte words, so that every column is aligned
+    std::unique_ptr<std::uint64_t[]> mBuffer;
+    std::vector<std::pair<tle::IdType, std::string>> mErrors;
+};
+
+} // namespace tensorrt_llm::pybind::executor
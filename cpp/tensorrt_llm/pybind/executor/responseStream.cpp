@@ -0,0 +1,240 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "responseStream.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <pybind11/stl.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace py = pybind11;
+
+namespace tensorrt_llm::pybind::executor
+{
+
+void ResponseStream::Queue::push(std::vector<tle::Response> const& batch)
+{
+    {
+        std::lock_guard<std::mutex> const lock(mutex);
+        batches.push_back(batch);
+    }
+    signal();
+}
+
+std::optional<std::vector<tle::Response>> ResponseStream::Queue::pop()
+{
+    std::lock_guard<std::mutex> const lock(mutex);
+    if (batches.empty())
+    {
+        return std::nullopt;
+    }
+    auto batch = std::move(batches.front());
+    batches.pop_front();
+    return batch;
+}
+
+void ResponseStream::Queue::signal() const
+{
+#if defined(__linux__)
+    std::uint64_t const one{1};
+    // Only fails when the counter would overflow, the fd is readable then anyway
+    [[maybe_unused]] auto const written = ::write(eventFd, &one, sizeof(one));
+#endif
+}
+
+void ResponseStream::Queue::clearSignal() const
+{
+#if defined(__linux__)
+    std::uint64_t count{0};
+    // Non-blocking, fails with EAGAIN when nothing was signaled
+    [[maybe_unused]] auto const read = ::read(eventFd, &count, sizeof(count));
+#endif
+}
+
+ResponseStream::ResponseStream(tle::Executor& executor, std::shared_ptr<runtime::ResponseCoalescer> coalescer)
+    : mExecutor{executor}
+    , mCoalescer{std::move(coalescer)}
+    , mQueue{new Queue,
+          [](Queue* queue)
+          {
+#if defined(__linux__)
+              if (queue->eventFd >= 0)
+              {
+                  ::close(queue->eventFd);
+              }
+#endif
+              delete queue;
+          }}
+{
+#if defined(__linux__)
+    mQueue->eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    TLLM_CHECK_WITH_INFO(mQueue->eventFd >= 0, "Failed to create an eventfd: %s", std::strerror(errno));
+#else
+    TLLM_THROW("ResponseStream needs an eventfd, which is only available on Linux");
+#endif
+    mThread = std::thread(&ResponseStream::run, this);
+}
+
+ResponseStream::~ResponseStream()
+{
+    close();
+    removeReader();
+}
+
+void ResponseStream::run()
+{
+    using Clock = runtime::ResponseCoalescer::Clock;
+    // The thread must not touch Python objects
+    try
+    {
+        while (!mStopRequested.load())
+        {
+            bool const coalesce = mCoalescer && mCoalescer->isEnabled();
+            auto wait = kPollInterval;
+            if (auto const heldDeadline = coalesce ? mCoalescer->getNextDeadline() : std::nullopt)
+            {
+                wait = std::clamp(std::chrono::ceil<std::chrono::milliseconds>(*heldDeadline - Clock::now()),
+                    std::chrono::milliseconds{0}, kPollInterval);
+            }
+            auto responses = mExecutor.awaitResponses(wait);
+            if (coalesce)
+            {
+                responses = mCoalescer->push(responses);
+                auto expired = mCoalescer->flushExpired();
+                responses.insert(
+                    responses.end(), std::make_move_iterator(expired.begin()), std::make_move_iterator(expired.end()));
+            }
+            if (!responses.empty())
+            {
+                mQueue->push(responses);
+            }
+        }
+    }
+    catch (std::exception const& e)
+    {
+        TLLM_LOG_ERROR("Response stream stopped: %s", e.what());
+    }
+    mRunning.store(false);
+    // Wake up a pending __anext__ so that it stops
+    mQueue->signal();
+}
+
+int ResponseStream::fileno() const
+{
+    return mQueue->eventFd;
+}
+
+std::optional<std::vector<tle::Response>> ResponseStream::getNowait()
+{
+    return mQueue->pop();
+}
+
+py::object ResponseStream::next()
+{
+    auto loop = py::module_::import("asyncio").attr("get_running_loop")();
+    auto future = loop.attr("create_future")();
+    // Read before popping, the thread queues its last batch before it stops running
+    bool const running = mRunning.load();
+    if (auto batch = mQueue->pop())
+    {
+        future.attr("set_result")(py::cast(std::move(*batch)));
+        return future;
+    }
+    if (!running)
+    {
+        future.attr("set_exception")(py::module_::import("builtins").attr("StopAsyncIteration")());
+        return future;
+    }
+    TLLM_CHECK_WITH_INFO(!mPending || mPending.attr("done")().cast<bool>(), "Only one __anext__ can be pending");
+    if (!mLoop)
+    {
+        loop.attr("add_reader")(fileno(), py::cpp_function([this]() { onReadable(); }));
+        mLoop = loop;
+    }
+    TLLM_CHECK_WITH_INFO(mLoop.is(loop), "The stream is bound to the event loop of its first __anext__");
+    mPending = future;
+    return future;
+}
+
+void ResponseStream::onReadable()
+{
+    mQueue->clearSignal();
+    // The pending future may have been cancelled by a timeout of the awaiting task
+    if (!mPending || mPending.attr("done")().cast<bool>())
+    {
+        return;
+    }
+    bool const running = mRunning.load();
+    if (auto batch = mQueue->pop())
+    {
+        mPending.attr("set_result")(py::cast(std::move(*batch)));
+    }
+    else if (!running)
+    {
+        mPending.attr("set_exception")(py::module_::import("builtins").attr("StopAsyncIteration")());
+    }
+    else
+    {
+        return;
+    }
+    mPending = py::object{};
+}
+
+void ResponseStream::close()
+{
+    mStopRequested.store(true);
+    if (mThread.joinable())
+    {
+        // The thread does not take the GIL, release it so that other Python threads progress meanwhile
+        py::gil_scoped_release release;
+        mThread.join();
+    }
+}
+
+void ResponseStream::removeReader()
+{
+    if (mLoop && !mLoop.attr("is_closed")().cast<bool>())
+    {
+        mLoop.attr("remove_reader")(fileno());
+    }
+    mLoop = py::object{};
+}
+
+void ResponseStream::initBindings(py::module_& m)
+{
+    py::class_<ResponseStream>(m, "ResponseStream",
+        "Async iterator over the response batches of an executor, one list of responses per iteration. While the "
+        "stream is open, it consumes all responses of the executor and await_responses must not be called.")
+        .def("fileno", &ResponseStream::fileno)
+        .def("get_nowait", &ResponseStream::getNowait)
+        .def("close", &ResponseStream::close)
+        .def("__aiter__", [](py::object self) { return self; })
+        .def("__anext__", &ResponseStream::next);
+}
+
+} // namespace tensorrt_llm::pybind::executor
@@ -0,0 +1,105 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/responseCoalescer.h"
+#include <pybind11/pybind11.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace tle = tensorrt_llm::executor;
+
+namespace tensorrt_llm::pybind::executor
+{
+
+//! \brief Async iterator over the response batches of an executor, for asyncio servers.
+//! \details The stream owns a thread that waits in awaitResponses and, without taking the GIL, queues each batch it
+//! returns and writes to an eventfd. The event loop watches the eventfd with add_reader and resolves the pending
+//! __anext__ future with the oldest batch, so no Python thread has to block in await_responses. The stream consumes
+//! all responses of the executor while it is open, await_responses must not be called meanwhile.
+//! Only Linux event loops with add_reader are supported.
+//!
+//! With a coalescer, each batch passes through it and only the responses it delivers are queued. The thread wakes up
+//! for the maxDelay of held responses.
+class ResponseStream
+{
+public:
+    explicit ResponseStream(
+        tle::Executor& executor, std::shared_ptr<runtime::ResponseCoalescer> coalescer = nullptr);
+
+    ~ResponseStream();
+
+    ResponseStream(ResponseStream const&) = delete;
+    ResponseStream& operator=(ResponseStream const&) = delete;
+
+    //! \brief The eventfd, readable while batches are queued.
+    [[nodiscard]] int fileno() const;
+
+    //! \brief The oldest queued batch, or none.
+    [[nodiscard]] std::optional<std::vector<tle::Response>> getNowait();
+
+    //! \brief An asyncio future resolved with the next batch, or raising StopAsyncIteration once the stream is closed
+    //! and drained. Must be called from the running event loop.
+    [[nodiscard]] pybind11::object next();
+
+    //! \brief Stop waiting for responses. Queued batches can still be consumed.
+    void close();
+
+    static void initBindings(pybind11::module_& m);
+
+private:
+    //! \brief Batches handed from the stream thread to the event loop.
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::vector<tle::Response>> batches;
+        int eventFd{-1};
+
+        void push(std::vector<tle::Response> const& batch);
+        std::optional<std::vector<tle::Response>> pop();
+        void signal() const;
+        void clearSignal() const;
+    };
+
+    //! \brief Upper bound of a single wait in awaitResponses, so that close does not wait for the next response.
+    static constexpr std::chrono::milliseconds kPollInterval{50};
+
+    void run();
+    void onReadable();
+    void removeReader();
+
+    tle::Executor& mExecutor;
+    std::shared_ptr<runtime::ResponseCoalescer> mCoalescer;
+    std::shared_ptr<Queue> mQueue;
+    std::atomic<bool> mStopRequested{false};
+    //! \brief Cleared by the thread after it queued its last batch.
+    std::atomic<bool> mRunning{true};
+    std::thread mThread;
+    pybind11::object mLoop;
+    pybind11::object mPending;
+};
+
+} // namespace tensorrt_llm::pybind::executor
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/adaptiveDraftLength.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tensorrt_llm::runtime
+{
+
+AdaptiveDraftLength::AdaptiveDraftLength(
+    SizeType32 minDraftLen, SizeType32 maxDraftLen, float smoothing, float minTokenGain)
+    : mMinDraftLen{minDraftLen}
+    , mMaxDraftLen{maxDraftLen}
+    , mSmoothing{smoothing}
+    , mMinTokenGain{minTokenGain}
+    , mDraftLen{maxDraftLen}
+{
+    TLLM_CHECK_WITH_INFO(0 <= minDraftLen && minDraftLen <= maxDraftLen,
+        "Invalid draft lengths: min (%d) must be non-negative and not larger than max (%d)", minDraftLen, maxDraftLen);
+    TLLM_CHECK_WITH_INFO(0.F < smoothing && smoothing <= 1.F, "smoothing (%f) must be in (0, 1]", smoothing);
+    TLLM_CHECK_WITH_INFO(0.F < minTokenGain && minTokenGain < 1.F, "minTokenGain (%f) must be in (0, 1)", minTokenGain);
+}
+
+void AdaptiveDraftLength::reset()
+{
+    mAccepted = 0.F;
+    mRejected = 0.F;
+    mDraftLen = mMaxDraftLen;
+}
+
+float AdaptiveDraftLength::getAcceptanceProbability() const noexcept
+{
+    auto const total = mAccepted + mRejected;
+    return total > 0.F ? mAccepted / total : 1.F;
+}
+
+void AdaptiveDraftLength::update(SizeType32 numDraftTokens, SizeType32 numAcceptedTokens)
+{
+    if (numDraftTokens <= 0)
+    {
+        // Nothing was verified, keep the estimate
+        return;
+    }
+    TLLM_CHECK_WITH_INFO(numAcceptedTokens <= numDraftTokens, "Accepted %d of %d draft tokens", numAcceptedTokens,
+        numDraftTokens);
+    auto const rejected = numAcceptedTokens < numDraftTokens ? 1.F : 0.F;
+    mAccepted += mSmoothing * (static_cast<float>(numAcceptedTokens) - mAccepted);
+    mRejected += mSmoothing * (rejected - mRejected);
+
+    auto const p = getAcceptanceProbability();
+    SizeType32 draftLen = mMaxDraftLen;
+    if (p <= 0.F)
+    {
+        draftLen = mMinDraftLen;
+    }
+    else if (p < 1.F)
+    {
+        // Largest k with p^k >= minTokenGain
+        auto const k = std::floor(std::log(mMinTokenGain) / std::log(p));
+        draftLen = static_cast<SizeType32>(std::min(k, static_cast<float>(mMaxDraftLen)));
+    }
+    mDraftLen = std::clamp(draftLen, mMinDraftLen, mMaxDraftLen);
+}
+
+} // namespace tensorrt_llm::runtime
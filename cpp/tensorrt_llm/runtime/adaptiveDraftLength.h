@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Chooses the draft length of one request from its recent acceptance.
+//! \details Draft tokens are modelled as accepted one after the other with probability p until the first rejection,
+//! so the i-th draft token is accepted with probability p^i. p is estimated from exponential moving averages of the
+//! accepted tokens and rejections per step. The draft length is the largest one whose last token is still accepted
+//! with probability of at least minTokenGain, i.e. draft tokens which are likely to be wasted are not proposed and
+//! their batch tokens can serve other requests.
+class AdaptiveDraftLength
+{
+public:
+    //! \param smoothing Weight of the latest step in the moving averages, in (0, 1].
+    //! \param minTokenGain Minimum acceptance probability of the last draft token, in (0, 1).
+    AdaptiveDraftLength(
+        SizeType32 minDraftLen, SizeType32 maxDraftLen, float smoothing = 0.25F, float minTokenGain = 0.3F);
+
+    //! \brief Forget the statistics, e.g. for a new request. The draft length starts at its maximum.
+    void reset();
+
+    //! \brief Record the outcome of a step in which numDraftTokens were verified and numAcceptedTokens accepted.
+    void update(SizeType32 numDraftTokens, SizeType32 numAcceptedTokens);
+
+    //! @returns draft length to propose in the next step
+    [[nodiscard]] SizeType32 getDraftLen() const noexcept
+    {
+        return mDraftLen;
+    }
+
+    //! @returns estimated probability that a draft token following an accepted one is accepted
+    [[nodiscard]] float getAcceptanceProbability() const noexcept;
+
+private:
+    SizeType32 mMinDraftLen;
+    SizeType32 mMaxDraftLen;
+    float mSmoothing;
+    float mMinTokenGain;
+    float mAccepted{0.F};
+    float mRejected{0.F};
+    SizeType32 mDraftLen;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/admissionController.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+AdmissionController::AdmissionController(
+    std::optional<executor::AdmissionControlConfig> config, double rateSmoothing)
+    : mConfig{std::move(config)}
+    , mRateSmoothing{rateSmoothing}
+{
+    TLLM_CHECK_WITH_INFO(rateSmoothing > 0. && rateSmoothing <= 1., "Rate smoothing must be in (0, 1]");
+}
+
+void AdmissionController::onIteration(SizeType32 numReleasedBlocks, double iterationMs)
+{
+    if (iterationMs <= 0.)
+    {
+        return;
+    }
+    auto const rate = static_cast<double>(numReleasedBlocks) / iterationMs;
+    mReleaseRate = mReleaseRate ? mRateSmoothing * rate + (1. - mRateSmoothing) * *mReleaseRate : rate;
+}
+
+executor::AdmissionHeadroom AdmissionController::evaluate(
+    SizeType32 maxNumBlocks, SizeType32 freeNumBlocks, SizeType32 queuedNumBlocks) const
+{
+    executor::AdmissionHeadroom headroom{};
+    headroom.freeNumBlocks = freeNumBlocks;
+    headroom.queuedNumBlocks = queuedNumBlocks;
+    headroom.headroomNumBlocks = freeNumBlocks - queuedNumBlocks;
+    headroom.commitment = maxNumBlocks > 0
+        ? static_cast<double>(maxNumBlocks - freeNumBlocks + queuedNumBlocks) / static_cast<double>(maxNumBlocks)
+        : 0.;
+
+    if (headroom.headroomNumBlocks >= 0)
+    {
+        headroom.estimatedQueueDelayMS = 0.;
+    }
+    else if (mReleaseRate && *mReleaseRate > 0.)
+    {
+        headroom.estimatedQueueDelayMS = static_cast<double>(-headroom.headroomNumBlocks) / *mReleaseRate;
+    }
+
+    headroom.decision = executor::AdmissionDecision::kADMIT;
+    if (mConfig)
+    {
+        auto const reached = [&headroom](std::optional<float> watermark)
+        { return watermark && static_cast<float>(headroom.commitment) >= *watermark; };
+        if (reached(mConfig->getRejectWatermark()))
+        {
+            headroom.decision = executor::AdmissionDecision::kREJECT;
+        }
+        else if (reached(mConfig->getDeferWatermark()))
+        {
+            headroom.decision = executor::AdmissionDecision::kDEFER;
+        }
+    }
+    return headroom;
+}
+
+SizeType32 AdmissionController::getNumPromptBlocks(SizeType32 promptLen, SizeType32 tokensPerBlock)
+{
+    TLLM_CHECK_WITH_INFO(tokensPerBlock > 0, "Tokens per block must be positive");
+    return (promptLen + tokensPerBlock - 1) / tokensPerBlock;
+}
+
+} // namespace tensorrt_llm::runtime
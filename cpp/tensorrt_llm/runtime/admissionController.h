@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <optional>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Computes the KV cache headroom of the executor and applies the watermarks of AdmissionControlConfig.
+//! \details The capacity scheduler pauses in-flight requests when the blocks run out, so a replica that accepts
+//! more than it can hold thrashes its cache instead of turning work away. The controller sits in front of the executor
+//! and is evaluated with its latest KvCacheStats before enqueueing: above the reject watermark new requests fail with
+//! AdmissionRejectedError, above the defer watermark they are held back until the commitment drops.
+//!
+//! The queueing delay is estimated from the rate at which finished and cancelled requests released blocks, smoothed
+//! over recent iterations.
+class AdmissionController
+{
+public:
+    //! \param config The watermarks, std::nullopt to admit every request and only report the headroom.
+    //! \param rateSmoothing Weight of the latest iteration in the smoothed release rate, in (0, 1].
+    explicit AdmissionController(
+        std::optional<executor::AdmissionControlConfig> config = std::nullopt, double rateSmoothing = 0.2);
+
+    //! \brief Account an iteration that ran for iterationMs and in which requests released numReleasedBlocks blocks.
+    void onIteration(SizeType32 numReleasedBlocks, double iterationMs);
+
+    //! \param maxNumBlocks Size of the primary pool, see KvCacheStats.
+    //! \param freeNumBlocks Free blocks in the primary pool.
+    //! \param queuedNumBlocks Blocks the prompts of the queued requests need, see getNumPromptBlocks.
+    [[nodiscard]] executor::AdmissionHeadroom evaluate(
+        SizeType32 maxNumBlocks, SizeType32 freeNumBlocks, SizeType32 queuedNumBlocks) const;
+
+    //! \brief Blocks released per millisecond, smoothed, or std::nullopt before the first iteration.
+    [[nodiscard]] std::optional<double> getReleaseRate() const noexcept
+    {
+        return mReleaseRate;
+    }
+
+    //! \brief Blocks a prompt of promptLen tokens needs, before any reuse.
+    [[nodiscard]] static SizeType32 getNumPromptBlocks(SizeType32 promptLen, SizeType32 tokensPerBlock);
+
+private:
+    std::optional<executor::AdmissionControlConfig> mConfig;
+    double mRateSmoothing;
+    std::optional<double> mReleaseRate;
+};
+
+} // namespace tensorrt_llm::runtime
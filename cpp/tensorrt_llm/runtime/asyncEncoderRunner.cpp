@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/asyncEncoderRunner.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+bool isDone(CudaEvent const& event)
+{
+    auto const status = ::cudaEventQuery(event.get());
+    if (status == cudaErrorNotReady)
+    {
+        return false;
+    }
+    TLLM_CUDA_CHECK(status);
+    return true;
+}
+} // namespace
+
+AsyncEncoderRunner::AsyncEncoderRunner(
+    Config const& config, std::shared_ptr<CudaStream> stream, EnqueueFn enqueueFn)
+    : mScheduler{config.scheduler}
+    , mMaxBatchesInFlight{config.maxBatchesInFlight}
+    , mStream{std::move(stream)}
+    , mEnqueueFn{std::move(enqueueFn)}
+{
+    TLLM_CHECK_WITH_INFO(mMaxBatchesInFlight > 0, "At least one encoder batch must be in flight");
+    TLLM_CHECK(mStream && mEnqueueFn);
+}
+
+void AsyncEncoderRunner::enqueue(RequestIdType requestId, SizeType32 inputLength)
+{
+    mScheduler.enqueue(requestId, inputLength);
+}
+
+SizeType32 AsyncEncoderRunner::launch()
+{
+    SizeType32 numLaunched{0};
+    while (getNumBatchesInFlight() < mMaxBatchesInFlight && mScheduler.getNumQueuedRequests() > 0)
+    {
+        auto const batch = mScheduler.scheduleBatch();
+        auto encoderOutputs = mEnqueueFn(batch, *mStream);
+        TLLM_CHECK_WITH_INFO(encoderOutputs.size() == batch.requestIds.size(),
+            "Got %zu encoder outputs for a batch of %d requests", encoderOutputs.size(), batch.getBatchSize());
+        InFlightBatch& inFlight
+            = mInFlight.emplace_back(InFlightBatch{batch.requestIds, std::move(encoderOutputs), CudaEvent{}});
+        mStream->record(inFlight.done);
+        TLLM_LOG_DEBUG("Encoder batch of %d requests and %d tokens enqueued", batch.getBatchSize(), batch.numTokens);
+        ++numLaunched;
+    }
+    return numLaunched;
+}
+
+std::vector<AsyncEncoderRunner::FinishedRequest> AsyncEncoderRunner::takeFinished(
+    CudaStream const& decoderStream, bool blocking)
+{
+    std::vector<FinishedRequest> finished;
+    if (blocking && !mInFlight.empty())
+    {
+        mInFlight.front().done.synchronize();
+    }
+    // The batches run in order on the encoder stream, so they finish in order
+    while (!mInFlight.empty() && isDone(mInFlight.front().done))
+    {
+        auto& batch = mInFlight.front();
+        decoderStream.wait(batch.done);
+        for (std::size_t i = 0; i < batch.requestIds.size(); ++i)
+        {
+            finished.push_back(FinishedRequest{batch.requestIds[i], std::move(batch.encoderOutputs[i])});
+        }
+        mInFlight.pop_front();
+    }
+    return finished;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/encoderBatchScheduler.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Runs the encoder of an encoder-decoder model next to the decoder iterations instead of in line with them.
+//! \details New requests in kENCODER_INIT are batched by tokens with an EncoderBatchScheduler of their own and
+//! enqueued on the stream of the encoder runtime, which has its own execution context, so the decode steps of the
+//! running requests do not wait for encoder passes. Every batch records an event on the encoder stream. Requests are
+//! handed to the decoder once their batch finished: their encoder outputs stay in the device buffers the encoder
+//! wrote, and the decoder stream waits for the event, so no host synchronization is needed. At most
+//! maxBatchesInFlight batches are enqueued at a time, which bounds the memory of the outputs not yet handed over.
+class AsyncEncoderRunner
+{
+public:
+    using RequestIdType = EncoderBatchScheduler::RequestIdType;
+    using Batch = EncoderBatchScheduler::Batch;
+    //! Enqueues the encoder engine for a batch on the stream and returns the encoder output of every request of the
+    //! batch, in batch order. The outputs are device buffers the decoder reads once the stream got there.
+    using EnqueueFn = std::function<std::vector<ITensor::SharedPtr>(Batch const& batch, CudaStream const& stream)>;
+
+    struct Config
+    {
+        EncoderBatchScheduler::Config scheduler;
+        SizeType32 maxBatchesInFlight{2};
+    };
+
+    struct FinishedRequest
+    {
+        RequestIdType requestId;
+        ITensor::SharedPtr encoderOutput;
+    };
+
+    //! \param stream The stream of the encoder runtime, not the one of the decoder.
+    AsyncEncoderRunner(Config const& config, std::shared_ptr<CudaStream> stream, EnqueueFn enqueueFn);
+
+    //! \brief Queue a new request for the encoder.
+    void enqueue(RequestIdType requestId, SizeType32 inputLength);
+
+    //! \brief Enqueue batches until maxBatchesInFlight are in flight or no request is queued. Does not block.
+    //! \return The number of batches enqueued
+    SizeType32 launch();
+
+    //! \brief Hand over the requests of the batches whose encoder finished, in the order they were launched.
+    //! \param decoderStream The stream of the decoder, made to wait for the handed over outputs.
+    //! \param blocking Wait for the oldest batch in flight if none finished, e.g. when the decoder has nothing else
+    //! to run.
+    [[nodiscard]] std::vector<FinishedRequest> takeFinished(CudaStream const& decoderStream, bool blocking = false);
+
+    [[nodiscard]] SizeType32 getNumQueuedRequests() const noexcept
+    {
+        return mScheduler.getNumQueuedRequests();
+    }
+
+    [[nodiscard]] SizeType32 getNumBatchesInFlight() const noexcept
+    {
+        return static_cast<SizeType32>(mInFlight.size());
+    }
+
+    [[nodiscard]] CudaStream const& getStream() const noexcept
+    {
+        return *mStream;
+    }
+
+private:
+    struct InFlightBatch
+    {
+        std::vector<RequestIdType> requestIds;
+        std::vector<ITensor::SharedPtr> encoderOutputs;
+        CudaEvent done;
+    };
+
+    EncoderBatchScheduler mScheduler;
+    SizeType32 mMaxBatchesInFlight;
+    std::shared_ptr<CudaStream> mStream;
+    EnqueueFn mEnqueueFn;
+    std::deque<InFlightBatch> mInFlight;
+};
+
+} // namespace tensorrt_llm::runtime
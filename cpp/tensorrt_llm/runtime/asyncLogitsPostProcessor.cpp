@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/asyncLogitsPostProcessor.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+
+#include <atomic>
+#include <tuple>
+
+namespace tensorrt_llm::runtime
+{
+
+struct AsyncLogitsPostProcessor::Batch
+{
+    std::vector<IdType> reqIds;
+    std::vector<executor::Tensor> logits;
+    std::vector<std::reference_wrapper<BeamTokens const>> beamTokens;
+    std::vector<std::optional<IdType>> clientIds;
+    std::promise<void> done;
+    std::atomic<bool> signaled{false};
+};
+
+AsyncLogitsPostProcessor::AsyncLogitsPostProcessor(Callback callback)
+    : mCallback{std::move(callback)}
+    , mStream{std::make_shared<CudaStream>()}
+    , mWorker{1, mStream->getDevice()}
+{
+    TLLM_CHECK_WITH_INFO(mCallback, "Logits post processor callback must not be empty");
+}
+
+void AsyncLogitsPostProcessor::launch(std::vector<IdType> reqIds, std::vector<executor::Tensor> logits,
+    std::vector<std::reference_wrapper<BeamTokens const>> beamTokens, std::vector<std::optional<IdType>> clientIds,
+    CudaStream const& runtimeStream)
+{
+    TLLM_NVTX_SCOPED_RANGE(kRESPONSE, launch);
+    TLLM_CHECK_WITH_INFO(!isPending(), "wait() must be called before launching the next batch");
+    TLLM_CHECK(reqIds.size() == logits.size() && reqIds.size() == beamTokens.size()
+        && reqIds.size() == clientIds.size());
+
+    runtimeStream.record(mLogitsReadyEvent);
+    mStream->wait(mLogitsReadyEvent);
+
+    mBatch = std::make_shared<Batch>();
+    mBatch->reqIds = std::move(reqIds);
+    mBatch->logits = std::move(logits);
+    mBatch->beamTokens = std::move(beamTokens);
+    mBatch->clientIds = std::move(clientIds);
+    mPending = mBatch->done.get_future();
+
+    auto done = [this, batch = mBatch]()
+    {
+        if (!batch->signaled.exchange(true))
+        {
+            mStream->record(mDoneEvent);
+            batch->done.set_value();
+        }
+    };
+    // The future of the task itself is not needed, completion is signaled through the batch.
+    std::ignore = mWorker.enqueue(
+        [this, batch = mBatch, done = std::move(done)]()
+        {
+            try
+            {
+                mCallback(batch->reqIds, batch->logits, batch->beamTokens, mStream, batch->clientIds, done);
+            }
+            catch (...)
+            {
+                if (!batch->signaled.exchange(true))
+                {
+                    batch->done.set_exception(std::current_exception());
+                }
+            }
+        });
+}
+
+void AsyncLogitsPostProcessor::wait(CudaStream const& runtimeStream)
+{
+    TLLM_NVTX_SCOPED_RANGE(kRESPONSE, wait);
+    TLLM_CHECK_WITH_INFO(isPending(), "No logits post processing launched");
+    auto pending = std::move(*mPending);
+    mPending.reset();
+    mBatch.reset();
+    pending.get();
+    runtimeStream.wait(mDoneEvent);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/tensor.h"
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/workerPool.h"
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Runs an executor::LogitsPostProcessorBatchedAsync without blocking the generation loop.
+//! \details launch() hands the logits views to the callback on a worker thread, together with a dedicated stream which
+//! first waits for the logits to be produced. The callback enqueues its GPU work and signals completion. wait() blocks
+//! the host only until that signal and then makes the runtime stream wait on an event recorded behind the callback's
+//! work, so that host-side processing overlaps with whatever the generation loop does in between.
+class AsyncLogitsPostProcessor
+{
+public:
+    using Callback = executor::LogitsPostProcessorBatchedAsync;
+    using IdType = executor::IdType;
+    using BeamTokens = executor::BeamTokens;
+
+    //! \brief Create the stream and worker thread of the post processor on the current device.
+    explicit AsyncLogitsPostProcessor(Callback callback);
+
+    //! \brief Start post processing once the work enqueued on runtimeStream so far is done.
+    //! \details The logits must stay valid and beamTokens must not change until wait() returns.
+    void launch(std::vector<IdType> reqIds, std::vector<executor::Tensor> logits,
+        std::vector<std::reference_wrapper<BeamTokens const>> beamTokens,
+        std::vector<std::optional<IdType>> clientIds, CudaStream const& runtimeStream);
+
+    //! \brief Make runtimeStream wait for the work of the pending launch, e.g. before sampling.
+    //! \details Rethrows an exception thrown by the callback.
+    void wait(CudaStream const& runtimeStream);
+
+    [[nodiscard]] bool isPending() const noexcept
+    {
+        return mPending.has_value();
+    }
+
+    [[nodiscard]] std::shared_ptr<CudaStream> const& getStream() const noexcept
+    {
+        return mStream;
+    }
+
+private:
+    struct Batch;
+
+    Callback mCallback;
+    std::shared_ptr<CudaStream> mStream;
+    CudaEvent mLogitsReadyEvent;
+    CudaEvent mDoneEvent;
+    std::shared_ptr<Batch> mBatch;
+    std::optional<std::future<void>> mPending;
+    // Declared last so the worker is joined before the members its task uses are destroyed
+    WorkerPool mWorker;
+};
+
+} // namespace tensorrt_llm::runtime
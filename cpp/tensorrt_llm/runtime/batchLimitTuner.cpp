@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/batchLimitTuner.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+namespace tle = tensorrt_llm::executor;
+
+// Factor of the scale per raise or throughput lowering
+double constexpr kStep = 1.125;
+// Factor of the scale when the KV cache runs full
+double constexpr kKvCacheBackoff = 0.75;
+// Lowest factor of the scale when the latency exceeds the target
+double constexpr kMaxLatencyBackoff = 0.5;
+// The latency bound only raises the scale below this share of the target
+double constexpr kLatencyHeadroom = 0.9;
+// Relative throughput change taken as noise by the hill climbing
+double constexpr kThroughputTolerance = 0.02;
+// Share of the token limit from which a batch counts as full
+double constexpr kFullTokenShare = 0.9;
+
+SizeType32 scaleLimit(double scale, SizeType32 engineLimit, SizeType32 minLimit)
+{
+    auto const limit = static_cast<SizeType32>(std::lround(scale * engineLimit));
+    return std::min(std::max(limit, minLimit), engineLimit);
+}
+} // namespace
+
+BatchLimitTuner::BatchLimitTuner(
+    tle::BatchLimitTuningConfig config, SizeType32 engineMaxBatchSize, std::optional<SizeType32> engineMaxNumTokens)
+    : mConfig{std::move(config)}
+    , mEngineMaxBatchSize{engineMaxBatchSize}
+    , mEngineMaxNumTokens{engineMaxNumTokens}
+    , mLimits{engineMaxBatchSize, engineMaxNumTokens}
+    , mAppliedLimits{mLimits}
+{
+    TLLM_CHECK_WITH_INFO(engineMaxBatchSize > 0, "Invalid engine max batch size %d", engineMaxBatchSize);
+    TLLM_CHECK_WITH_INFO(!engineMaxNumTokens || *engineMaxNumTokens > 0, "Invalid engine max number of tokens %d",
+        engineMaxNumTokens.value_or(0));
+}
+
+bool BatchLimitTuner::setScale(double scale)
+{
+    auto minScale = static_cast<double>(mConfig.getMinBatchSize()) / mEngineMaxBatchSize;
+    if (mEngineMaxNumTokens)
+    {
+        minScale = std::max(minScale, static_cast<double>(mConfig.getMinNumTokens()) / *mEngineMaxNumTokens);
+    }
+    mScale = std::clamp(scale, std::min(minScale, 1.0), 1.0);
+
+    Limits const limits{scaleLimit(mScale, mEngineMaxBatchSize, mConfig.getMinBatchSize()),
+        mEngineMaxNumTokens ? std::make_optional(scaleLimit(mScale, *mEngineMaxNumTokens, mConfig.getMinNumTokens()))
+                            : std::nullopt};
+    bool const changed = limits.maxBatchSize != mLimits.maxBatchSize || limits.maxNumTokens != mLimits.maxNumTokens;
+    mLimits = limits;
+    return changed;
+}
+
+tle::BatchLimitDecision BatchLimitTuner::onIteration(IterationSample const& sample)
+{
+    mAppliedLimits = mLimits;
+    ++mNumIterations;
+    mLatencySumMS += sample.iterLatencyMS;
+    mTokenSum += sample.numTokens;
+    mMaxKvCacheUtilization = std::max(mMaxKvCacheUtilization, sample.kvCacheUtilization);
+    mPaused = mPaused || sample.numPausedRequests > 0;
+    // Requests waited while the batch was at a limit, so larger limits would have scheduled more
+    bool const atLimit = sample.numScheduledRequests >= mLimits.maxBatchSize
+        || (mLimits.maxNumTokens && sample.numTokens >= kFullTokenShare * *mLimits.maxNumTokens);
+    mNumFullIterations += sample.numQueuedRequests > 0 && atLimit ? 1 : 0;
+
+    mLastDecision = tle::BatchLimitDecision::kKEEP;
+    if (mNumIterations >= mConfig.getUpdateInterval())
+    {
+        mLastDecision = decide();
+        if (mLastDecision != tle::BatchLimitDecision::kKEEP)
+        {
+            TLLM_LOG_DEBUG("Batch limits set to %d requests and %d tokens (decision %d)", mLimits.maxBatchSize,
+                mLimits.maxNumTokens.value_or(0), static_cast<int>(mLastDecision));
+        }
+        mNumIterations = 0;
+        mNumFullIterations = 0;
+        mLatencySumMS = 0.0;
+        mTokenSum = 0.0;
+        mMaxKvCacheUtilization = 0.F;
+        mPaused = false;
+    }
+    return mLastDecision;
+}
+
+tle::BatchLimitDecision BatchLimitTuner::decide()
+{
+    using Decision = tle::BatchLimitDecision;
+    auto const meanLatencyMS = mLatencySumMS / mNumIterations;
+    auto const target = mConfig.getTargetIterLatencyMS();
+
+    if (mPaused || mMaxKvCacheUtilization >= mConfig.getKvCacheWatermark())
+    {
+        mLastThroughput.reset();
+        mRaising = true;
+        return setScale(mScale * kKvCacheBackoff) ? Decision::kLOWER_KV_PRESSURE : Decision::kKEEP;
+    }
+    if (target && meanLatencyMS > *target)
+    {
+        mLastThroughput.reset();
+        auto const factor = std::max(kMaxLatencyBackoff, *target / meanLatencyMS);
+        return setScale(mScale * factor) ? Decision::kLOWER_LATENCY : Decision::kKEEP;
+    }
+    if (2 * mNumFullIterations < mNumIterations)
+    {
+        // The load, not the limits, bounded the batches
+        mLastThroughput.reset();
+        return Decision::kKEEP;
+    }
+    if (mConfig.getObjective() == tle::BatchLimitTuningObjective::kLATENCY_BOUND)
+    {
+        bool const raise = meanLatencyMS < kLatencyHeadroom * *target && setScale(mScale * kStep);
+        return raise ? Decision::kRAISE : Decision::kKEEP;
+    }
+
+    auto const throughput = mLatencySumMS > 0.0 ? mTokenSum / mLatencySumMS : 0.0;
+    if (mLastThroughput)
+    {
+        // Keep raising unless it cost throughput, keep lowering only while it gains throughput
+        if (mRaising && throughput < *mLastThroughput * (1.0 - kThroughputTolerance))
+        {
+            mRaising = false;
+        }
+        else if (!mRaising && throughput <= *mLastThroughput * (1.0 + kThroughputTolerance))
+        {
+            mRaising = true;
+        }
+    }
+    mLastThroughput = throughput;
+    if (setScale(mRaising ? mScale * kStep : mScale / kStep))
+    {
+        return mRaising ? Decision::kRAISE : Decision::kLOWER_THROUGHPUT;
+    }
+    mRaising = true;
+    return Decision::kKEEP;
+}
+
+} // namespace tensorrt_llm::runtime
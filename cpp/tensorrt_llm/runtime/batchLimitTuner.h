@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <optional>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Adjusts the max batch size and max number of tokens the scheduler applies, see BatchLimitTuningConfig.
+//! \details Both limits follow one scale in (0, 1] of the engine limits, so the batch and token budgets move together.
+//! The owner reports every iteration, e.g. from the IterationStats of the executor, and applies getLimits() to the
+//! next scheduling pass. Every updateInterval
+//! iterations the tuner decides on the measured window:
+//! - A KV cache above the watermark, or paused requests, lowers the scale, since pausing recomputes their context.
+//! - With a latency bound, a mean iteration latency above the target lowers the scale in proportion.
+//! - Windows in which the batches were not full carry no signal on larger limits and keep the scale.
+//! - Otherwise a latency bound raises the scale while the latency stays clear of the target, and the throughput
+//!   objective climbs the processed tokens per second: it keeps raising while throughput does not drop, and only
+//!   keeps lowering while that improves throughput, so it settles at the largest limits that pay off.
+class BatchLimitTuner
+{
+public:
+    struct Limits
+    {
+        SizeType32 maxBatchSize;
+        //! std::nullopt if the engine has no token limit
+        std::optional<SizeType32> maxNumTokens;
+    };
+
+    struct IterationSample
+    {
+        double iterLatencyMS{0.0};
+        SizeType32 numScheduledRequests{0};
+        //! Context and generation tokens of the iteration
+        SizeType32 numTokens{0};
+        SizeType32 numQueuedRequests{0};
+        SizeType32 numPausedRequests{0};
+        //! Share of the KV cache blocks in use, see KvCacheStats
+        float kvCacheUtilization{0.F};
+    };
+
+    //! \param engineMaxBatchSize The max batch size of the engine, or of the ExecutorConfig when set.
+    //! \param engineMaxNumTokens The max number of tokens of the engine, or of the ExecutorConfig when set.
+    BatchLimitTuner(executor::BatchLimitTuningConfig config, SizeType32 engineMaxBatchSize,
+        std::optional<SizeType32> engineMaxNumTokens);
+
+    //! \brief Account an iteration that ran with the current limits, and decide at the end of a window.
+    executor::BatchLimitDecision onIteration(IterationSample const& sample);
+
+    //! \brief The limits for the next scheduling pass.
+    [[nodiscard]] Limits getLimits() const noexcept
+    {
+        return mLimits;
+    }
+
+    //! \brief The limits applied in the last iteration, e.g. to report next to its IterationStats.
+    [[nodiscard]] Limits getAppliedLimits() const noexcept
+    {
+        return mAppliedLimits;
+    }
+
+    //! \brief The decision taken after the last iteration.
+    [[nodiscard]] executor::BatchLimitDecision getLastDecision() const noexcept
+    {
+        return mLastDecision;
+    }
+
+    [[nodiscard]] double getScale() const noexcept
+    {
+        return mScale;
+    }
+
+private:
+    [[nodiscard]] executor::BatchLimitDecision decide();
+
+    //! \brief Move the scale, returns false if the limits did not change.
+    bool setScale(double scale);
+
+    executor::BatchLimitTuningConfig mConfig;
+    SizeType32 mEngineMaxBatchSize;
+    std::optional<SizeType32> mEngineMaxNumTokens;
+    double mScale{1.0};
+    Limits mLimits;
+    // Limits of the last iteration and the decision after it
+    Limits mAppliedLimits;
+    executor::BatchLimitDecision mLastDecision{executor::BatchLimitDecision::kKEEP};
+
+    // Window of the current decision
+    SizeType32 mNumIterations{0};
+    SizeType32 mNumFullIterations{0};
+    double mLatencySumMS{0.0};
+    double mTokenSum{0.0};
+    float mMaxKvCacheUtilization{0.F};
+    bool mPaused{false};
+
+    // Hill climbing of the throughput objective
+    std::optional<double> mLastThroughput;
+    bool mRaising{true};
+};
+
+} // namespace tensorrt_llm::runtime
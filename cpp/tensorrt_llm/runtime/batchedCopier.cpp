@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/batchedCopier.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tensorrt_llm::runtime
+{
+
+void BatchedCopier::add(void* dst, void const* src, std::size_t numBytes)
+{
+    if (numBytes == 0)
+    {
+        return;
+    }
+    TLLM_CHECK(dst != nullptr && src != nullptr);
+    mCopies.push_back(kernels::BatchedCopy{dst, src, numBytes});
+}
+
+void BatchedCopier::add(IBuffer& dst, IBuffer const& src)
+{
+    TLLM_CHECK_WITH_INFO(src.getSizeInBytes() <= dst.getSizeInBytes(),
+        "Cannot copy %zu B into a buffer of %zu B", src.getSizeInBytes(), dst.getSizeInBytes());
+    TLLM_CHECK_WITH_INFO(src.getMemoryType() != MemoryType::kCPU && dst.getMemoryType() != MemoryType::kCPU,
+        "Batched copies need device accessible buffers, use pinned instead of cpu memory");
+    add(dst.data(), src.data(), src.getSizeInBytes());
+}
+
+void BatchedCopier::execute(BufferManager const& manager)
+{
+    auto const& stream = manager.getStream();
+    // Large copies go to the copy engines, they would hold up the other copies in the kernel
+    auto const firstLarge = std::partition(
+        mCopies.begin(), mCopies.end(), [](auto const& copy) { return copy.numBytes < kMinMemcpySize; });
+    for (auto it = firstLarge; it != mCopies.end(); ++it)
+    {
+        TLLM_CUDA_CHECK(cudaMemcpyAsync(it->dst, it->src, it->numBytes, cudaMemcpyDefault, stream.get()));
+    }
+    mCopies.erase(firstLarge, mCopies.end());
+
+    if (mCopies.size() == 1)
+    {
+        auto const& copy = mCopies.front();
+        TLLM_CUDA_CHECK(cudaMemcpyAsync(copy.dst, copy.src, copy.numBytes, cudaMemcpyDefault, stream.get()));
+    }
+    else if (mCopies.size() > 1)
+    {
+        auto const numCopyBytes = mCopies.size() * sizeof(kernels::BatchedCopy);
+        // The previous batch may still be copying from the staging buffer
+        mCopiesEvent.synchronize();
+        if (!mCopiesHost || mCopiesHost->getSize() < numCopyBytes)
+        {
+            mCopiesHost = BufferManager::pinned(numCopyBytes, nvinfer1::DataType::kUINT8);
+            mCopiesDevice = manager.gpu(numCopyBytes, nvinfer1::DataType::kUINT8);
+        }
+        std::memcpy(mCopiesHost->data(), mCopies.data(), numCopyBytes);
+        auto const maxNumBytes = std::max_element(mCopies.begin(), mCopies.end(),
+            [](auto const& lhs, auto const& rhs) { return lhs.numBytes < rhs.numBytes; })->numBytes;
+        TLLM_CUDA_CHECK(cudaMemcpyAsync(
+            mCopiesDevice->data(), mCopiesHost->data(), numCopyBytes, cudaMemcpyHostToDevice, stream.get()));
+        stream.record(mCopiesEvent);
+        kernels::invokeBatchedCopy(static_cast<kernels::BatchedCopy const*>(mCopiesDevice->data()), mCopies.size(),
+            maxNumBytes, stream);
+    }
+    mCopies.clear();
+}
+
+} // namespace tensorrt_llm::runtime
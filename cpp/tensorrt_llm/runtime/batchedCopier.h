@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+#include "tensorrt_llm/runtime/runtimeKernels.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Collects the many small copies of an iteration and issues them together.
+//! \details Copying per-slot state one cudaMemcpyAsync at a time costs an API call and a copy engine launch per
+//! copy, which adds up at large batch sizes. The copier gathers (dst, src, size) descriptors and executes the small
+//! ones with a single kernels::invokeBatchedCopy launch. Copies of kMinMemcpySize bytes or more still use
+//! cudaMemcpyAsync, the copy engines are faster for them.
+//!
+//! Sources and destinations must be device accessible, i.e. GPU, UVM or pinned memory, and no destination may
+//! overlap another copy. The descriptors are staged in pinned memory that is reused once the previous execute has
+//! uploaded them, so a copier is meant to be kept and reused across iterations.
+class BatchedCopier
+{
+public:
+    static std::size_t constexpr kMinMemcpySize{std::size_t{1} << 16}; // 64 KiB
+
+    //! \brief Add a copy of numBytes bytes from src to dst.
+    void add(void* dst, void const* src, std::size_t numBytes);
+
+    //! \brief Add a copy of the whole of src to the beginning of dst.
+    void add(IBuffer& dst, IBuffer const& src);
+
+    //! \brief Enqueue the collected copies on the stream of manager and start collecting a new batch.
+    void execute(BufferManager const& manager);
+
+    [[nodiscard]] std::size_t getNumCopies() const noexcept
+    {
+        return mCopies.size();
+    }
+
+private:
+    std::vector<kernels::BatchedCopy> mCopies;
+    IBuffer::SharedPtr mCopiesHost;   // kernels::BatchedCopy array, pinned
+    IBuffer::SharedPtr mCopiesDevice; // copy of mCopiesHost, on gpu
+    CudaEvent mCopiesEvent;           // recorded after mCopiesHost has been copied
+};
+
+} // namespace tensorrt_llm::runtime
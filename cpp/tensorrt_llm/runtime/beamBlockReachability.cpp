@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/beamBlockReachability.h"
+#include "tensorrt_llm/common/assert.h"
+
+namespace tensorrt_llm::runtime
+{
+
+std::vector<std::vector<bool>> BeamBlockReachability::compute(SizeType32 const* cacheIndirection,
+    SizeType32 beamWidth, SizeType32 maxAttentionWindow, SizeType32 numTokens, SizeType32 tokensPerBlock,
+    std::vector<bool> const& finishedBeams)
+{
+    TLLM_CHECK_WITH_INFO(tokensPerBlock > 0, "Invalid tokens per block %d", tokensPerBlock);
+    TLLM_CHECK_WITH_INFO(finishedBeams.empty() || static_cast<SizeType32>(finishedBeams.size()) == beamWidth,
+        "Got %lu finished flags for %d beams", finishedBeams.size(), beamWidth);
+    // Positions of a cyclic KV cache wrap around, its blocks are always read
+    if (beamWidth <= 1 || numTokens > maxAttentionWindow)
+    {
+        return {};
+    }
+
+    auto const numBlocks = numTokens > 0 ? (numTokens - 1) / tokensPerBlock : 0;
+    std::vector<std::vector<bool>> reachable(numBlocks, std::vector<bool>(beamWidth, false));
+    for (SizeType32 beam = 0; beam < beamWidth; ++beam)
+    {
+        if (!finishedBeams.empty() && finishedBeams[beam])
+        {
+            continue;
+        }
+        auto const* indirection = cacheIndirection + static_cast<std::size_t>(beam) * maxAttentionWindow;
+        for (SizeType32 token = 0; token < numBlocks * tokensPerBlock; ++token)
+        {
+            auto const srcBeam = indirection[token];
+            TLLM_CHECK_WITH_INFO(srcBeam >= 0 && srcBeam < beamWidth, "Invalid cache indirection %d of beam %d at %d",
+                srcBeam, beam, token);
+            reachable[token / tokensPerBlock][srcBeam] = true;
+        }
+    }
+    return reachable;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Finds the KV cache blocks of a beam search request that no live beam reads anymore.
+//! \details Every beam owns a block list, and beam b reads the token at position t from the blocks of beam
+//! cacheIndirection[b][t]. A new beam copies the indirection of its parent, so the beams read at a position only ever
+//! shrink: once no beam reads the blocks of a beam at some block index, none ever will. Those blocks can be released
+//! while the request still runs, see BlockManager::releaseUnreachableBlocks.
+class BeamBlockReachability
+{
+public:
+    //! \param cacheIndirection Host copy of the indirection of the request [beamWidth, maxAttentionWindow]
+    //! \param numTokens Tokens of the request in the KV cache. Only the blocks before the block of the last token are
+    //! considered, the beams still write into that one.
+    //! \param finishedBeams Beams that are done, their reads do not count, empty if none is
+    //! \return For every block index considered, which beams are read there. Empty if the KV cache is cyclic.
+    [[nodiscard]] static std::vector<std::vector<bool>> compute(SizeType32 const* cacheIndirection,
+        SizeType32 beamWidth, SizeType32 maxAttentionWindow, SizeType32 numTokens, SizeType32 tokensPerBlock,
+        std::vector<bool> const& finishedBeams = {});
+};
+
+} // namespace tensorrt_llm::runtime
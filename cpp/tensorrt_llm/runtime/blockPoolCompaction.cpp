@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/blockPoolCompaction.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+SizeType32 BlockPoolCompaction::getNumOccupiedSlots(std::vector<SlotState> const& slots)
+{
+    return static_cast<SizeType32>(
+        std::count_if(slots.begin(), slots.end(), [](SlotState state) { return state != SlotState::kFREE; }));
+}
+
+SizeType32 BlockPoolCompaction::getMinNumSlots(std::vector<SlotState> const& slots)
+{
+    auto const lastOccupied = std::find_if(
+        slots.rbegin(), slots.rend(), [](SlotState state) { return state != SlotState::kFREE; });
+    return static_cast<SizeType32>(std::distance(lastOccupied, slots.rend()));
+}
+
+std::vector<BlockPoolCompaction::Move> BlockPoolCompaction::plan(
+    std::vector<SlotState> const& slots, SizeType32 maxMoves, SizeType32 targetNumSlots)
+{
+    TLLM_NVTX_SCOPED_RANGE(kKV, plan);
+    auto const numSlots = static_cast<SizeType32>(slots.size());
+    if (targetNumSlots < 0)
+    {
+        targetNumSlots = getNumOccupiedSlots(slots);
+    }
+    TLLM_CHECK_WITH_INFO(targetNumSlots <= numSlots, "Target size %d exceeds pool size %d", targetNumSlots, numSlots);
+
+    std::vector<Move> moves;
+    SizeType32 dst = 0;
+    SizeType32 src = numSlots - 1;
+    while (static_cast<SizeType32>(moves.size()) < maxMoves)
+    {
+        while (dst < targetNumSlots && slots[dst] != SlotState::kFREE)
+        {
+            ++dst;
+        }
+        while (src >= targetNumSlots && slots[src] != SlotState::kMOVABLE)
+        {
+            --src;
+        }
+        if (dst >= targetNumSlots || src < targetNumSlots)
+        {
+            break;
+        }
+        moves.push_back(Move{src, dst});
+        ++dst;
+        --src;
+    }
+    return moves;
+}
+
+void BlockPoolCompaction::apply(std::vector<SlotState>& slots, std::vector<Move> const& moves)
+{
+    for (auto const& move : moves)
+    {
+        TLLM_CHECK_WITH_INFO(slots.at(move.srcSlot) == SlotState::kMOVABLE, "Slot %d does not hold a movable block",
+            move.srcSlot);
+        TLLM_CHECK_WITH_INFO(slots.at(move.dstSlot) == SlotState::kFREE, "Slot %d is not free", move.dstSlot);
+        slots[move.dstSlot] = SlotState::kMOVABLE;
+        slots[move.srcSlot] = SlotState::kFREE;
+    }
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Plans incremental compaction of a block pool.
+//! \details The pool is described by the state of each of its slots. A compaction pass moves live blocks from the end
+//! of the pool into free slots at its beginning, so that the tail of the pool becomes free and can be released. The
+//! caller executes a move by copying the block on a side stream and swapping the pool offsets of the two blocks
+//! (KVCacheBlock::swapMemoryPoolBlockOffset). Passes are bounded so they fit into idle iterations.
+class BlockPoolCompaction
+{
+public:
+    enum class SlotState : std::uint8_t
+    {
+        //! Slot holds no block and can receive one
+        kFREE,
+        //! Slot holds a block that can be moved, e.g. a cached block or one not used by the current iteration
+        kMOVABLE,
+        //! Slot holds a block that must not move right now
+        kPINNED,
+    };
+
+    struct Move
+    {
+        SizeType32 srcSlot;
+        SizeType32 dstSlot;
+
+        bool operator==(Move const& other) const noexcept
+        {
+            return srcSlot == other.srcSlot && dstSlot == other.dstSlot;
+        }
+    };
+
+    //! \brief Plan up to maxMoves moves that pack the pool towards its beginning.
+    //! \param targetNumSlots Only blocks at or beyond this slot are moved. Defaults to the number of occupied slots,
+    //! i.e. a full compaction.
+    [[nodiscard]] static std::vector<Move> plan(
+        std::vector<SlotState> const& slots, SizeType32 maxMoves, SizeType32 targetNumSlots = -1);
+
+    //! \brief Apply moves to slots, as the caller does after executing them.
+    static void apply(std::vector<SlotState>& slots, std::vector<Move> const& moves);
+
+    //! \brief Smallest pool size that keeps all occupied slots, i.e. the size the pool can be shrunk to right now.
+    [[nodiscard]] static SizeType32 getMinNumSlots(std::vector<SlotState> const& slots);
+
+    [[nodiscard]] static SizeType32 getNumOccupiedSlots(std::vector<SlotState> const& slots);
+};
+
+} // namespace tensorrt_llm::runtime
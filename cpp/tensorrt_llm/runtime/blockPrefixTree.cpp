@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/blockPrefixTree.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+SizeType32 commonPrefixLength(
+    VecUniqueTokens const& blockTokens, VecUniqueTokens const& tokens, std::size_t offset, std::size_t length)
+{
+    auto const maxLength = std::min(blockTokens.size(), length);
+    std::size_t i = 0;
+    while (i < maxLength && blockTokens[i] == tokens[offset + i])
+    {
+        ++i;
+    }
+    return static_cast<SizeType32>(i);
+}
+
+} // namespace
+
+BlockPrefixTree::BlockPrefixTree(SizeType32 tokensPerBlock)
+    : mTokensPerBlock{tokensPerBlock}
+{
+    TLLM_CHECK_WITH_INFO(mTokensPerBlock > 0, "tokensPerBlock must be positive");
+}
+
+BlockPrefixTree::ChildMap const* BlockPrefixTree::getChildren(
+    LoraTaskIdType loraTaskId, std::optional<BlockIdType> const& parent) const
+{
+    if (parent)
+    {
+        return &mNodes.at(*parent).children;
+    }
+    auto const it = mRoots.find(loraTaskId);
+    return it == mRoots.end() ? nullptr : &it->second;
+}
+
+BlockPrefixTree::ChildMap& BlockPrefixTree::getOrCreateChildren(
+    LoraTaskIdType loraTaskId, std::optional<BlockIdType> const& parent)
+{
+    if (parent)
+    {
+        return mNodes.at(*parent).children;
+    }
+    return mRoots[loraTaskId];
+}
+
+SizeType32 BlockPrefixTree::insert(
+    LoraTaskIdType loraTaskId, VecUniqueTokens const& tokens, std::vector<BlockIdType> const& blockIds)
+{
+    auto const numTokens = tokens.size();
+    auto const tokensPerBlock = static_cast<std::size_t>(mTokensPerBlock);
+    auto const numBlocks = (numTokens + tokensPerBlock - 1) / tokensPerBlock;
+    TLLM_CHECK_WITH_INFO(blockIds.size() >= numBlocks, "%zu blocks are required to hold %zu tokens, got %zu",
+        numBlocks, numTokens, blockIds.size());
+
+    SizeType32 numInserted{0};
+    std::optional<BlockIdType> parent;
+    for (std::size_t blockIdx = 0; blockIdx < numBlocks; ++blockIdx)
+    {
+        auto const offset = blockIdx * tokensPerBlock;
+        auto const length = std::min(tokensPerBlock, numTokens - offset);
+        auto& children = getOrCreateChildren(loraTaskId, parent);
+
+        std::optional<BlockIdType> existing;
+        auto const [first, last] = children.equal_range(tokens[offset]);
+        for (auto it = first; it != last; ++it)
+        {
+            auto const& childTokens = mNodes.at(it->second).tokens;
+            if (childTokens.size() == length
+                && std::equal(childTokens.begin(), childTokens.end(), tokens.begin() + offset))
+            {
+                existing = it->second;
+                break;
+            }
+        }
+
+        if (existing)
+        {
+            parent = existing;
+            continue;
+        }
+
+        auto const blockId = blockIds[blockIdx];
+        TLLM_CHECK_WITH_INFO(!contains(blockId), "Block %d is already indexed", blockId);
+        Node node{parent, loraTaskId, VecUniqueTokens(tokens.begin() + offset, tokens.begin() + offset + length), {}};
+        children.emplace(tokens[offset], blockId);
+        mNodes.emplace(blockId, std::move(node));
+        ++numInserted;
+
+        if (length < tokensPerBlock)
+        {
+            // A partially filled block cannot have descendants.
+            break;
+        }
+        parent = blockId;
+    }
+    return numInserted;
+}
+
+BlockPrefixTree::Match BlockPrefixTree::findLongestPrefix(
+    LoraTaskIdType loraTaskId, VecUniqueTokens const& tokens) const
+{
+    Match match;
+    auto const numTokens = tokens.size();
+    auto const tokensPerBlock = static_cast<std::size_t>(mTokensPerBlock);
+
+    std::optional<BlockIdType> parent;
+    std::size_t offset = 0;
+    while (offset < numTokens)
+    {
+        auto const* children = getChildren(loraTaskId, parent);
+        if (children == nullptr || children->empty())
+        {
+            break;
+        }
+
+        auto const length = std::min(tokensPerBlock, numTokens - offset);
+        std::optional<BlockIdType> best;
+        SizeType32 bestLength{0};
+        auto const [first, last] = children->equal_range(tokens[offset]);
+        for (auto it = first; it != last; ++it)
+        {
+            auto const& childTokens = mNodes.at(it->second).tokens;
+            auto const prefixLength = commonPrefixLength(childTokens, tokens, offset, length);
+            if (prefixLength > bestLength)
+            {
+                best = it->second;
+                bestLength = prefixLength;
+                if (static_cast<std::size_t>(prefixLength) == tokensPerBlock)
+                {
+                    break;
+                }
+            }
+        }
+
+        if (!best)
+        {
+            break;
+        }
+        if (static_cast<std::size_t>(bestLength) == tokensPerBlock)
+        {
+            match.blockIds.push_back(*best);
+            parent = best;
+            offset += tokensPerBlock;
+            continue;
+        }
+        match.partialBlockId = best;
+        match.numPartialTokens = bestLength;
+        break;
+    }
+    return match;
+}
+
+bool BlockPrefixTree::isLeaf(BlockIdType blockId) const
+{
+    auto const it = mNodes.find(blockId);
+    return it != mNodes.end() && it->second.children.empty();
+}
+
+bool BlockPrefixTree::removeLeaf(BlockIdType blockId)
+{
+    auto const it = mNodes.find(blockId);
+    if (it == mNodes.end() || !it->second.children.empty())
+    {
+        return false;
+    }
+    auto const& node = it->second;
+    auto& siblings = getOrCreateChildren(node.loraTaskId, node.parent);
+    auto const [first, last] = siblings.equal_range(node.tokens.front());
+    for (auto sibling = first; sibling != last; ++sibling)
+    {
+        if (sibling->second == blockId)
+        {
+            siblings.erase(sibling);
+            break;
+        }
+    }
+    if (!node.parent && siblings.empty())
+    {
+        mRoots.erase(node.loraTaskId);
+    }
+    mNodes.erase(it);
+    return true;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Radix tree over token sequences where every node is a cache block holding up to tokensPerBlock tokens.
+//! \details Unlike a map keyed by whole blocks, lookups match the longest common prefix down to token granularity:
+//! full blocks are matched exactly and the last, partially matching block is reported together with the number of
+//! tokens it shares with the query. The caller can then copy-on-write that block instead of recomputing its tokens.
+//! Children are indexed by their first token, so each step of a lookup only compares against blocks that can match.
+//! Sequences of different LoRA tasks live in separate subtrees.
+class BlockPrefixTree
+{
+public:
+    using BlockIdType = SizeType32;
+
+    struct Match
+    {
+        //! Blocks that match the query completely, in sequence order
+        std::vector<BlockIdType> blockIds;
+        //! Block sharing the longest prefix with the remaining query tokens, if any
+        std::optional<BlockIdType> partialBlockId;
+        //! Number of tokens shared with partialBlockId
+        SizeType32 numPartialTokens{0};
+
+        //! Total number of reusable tokens
+        [[nodiscard]] SizeType32 getNumMatchedTokens(SizeType32 tokensPerBlock) const noexcept
+        {
+            return static_cast<SizeType32>(blockIds.size()) * tokensPerBlock + numPartialTokens;
+        }
+    };
+
+    explicit BlockPrefixTree(SizeType32 tokensPerBlock);
+
+    //! \brief Insert the blocks holding tokens. blockIds[i] holds tokens [i * tokensPerBlock, (i + 1) *
+    //! tokensPerBlock), the last block may be partially filled.
+    //! \details Blocks whose content is already indexed are skipped, the existing block is kept.
+    //! \return Number of blocks that were added to the tree.
+    SizeType32 insert(LoraTaskIdType loraTaskId, VecUniqueTokens const& tokens, std::vector<BlockIdType> const& blockIds);
+
+    //! \brief Find the longest indexed prefix of tokens.
+    [[nodiscard]] Match findLongestPrefix(LoraTaskIdType loraTaskId, VecUniqueTokens const& tokens) const;
+
+    //! \brief Remove a block that has no descendants.
+    //! \return false if the block is not indexed or still has children.
+    bool removeLeaf(BlockIdType blockId);
+
+    [[nodiscard]] bool contains(BlockIdType blockId) const
+    {
+        return mNodes.find(blockId) != mNodes.end();
+    }
+
+    [[nodiscard]] bool isLeaf(BlockIdType blockId) const;
+
+    [[nodiscard]] SizeType32 getNumBlocks() const noexcept
+    {
+        return static_cast<SizeType32>(mNodes.size());
+    }
+
+    [[nodiscard]] SizeType32 getTokensPerBlock() const noexcept
+    {
+        return mTokensPerBlock;
+    }
+
+private:
+    struct UniqueTokenHasher
+    {
+        std::size_t operator()(UniqueToken const& token) const noexcept
+        {
+            auto const a = static_cast<std::uint64_t>(static_cast<std::uint32_t>(token.tokenId));
+            auto b = token.tokenExtraId;
+            b = (b ^ (b >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+            return static_cast<std::size_t>(a ^ (b + 0x9e3779b97f4a7c15 + (a << 6) + (a >> 2)));
+        }
+    };
+
+    // Children of a node, grouped by their first token
+    using ChildMap = std::unordered_multimap<UniqueToken, BlockIdType, UniqueTokenHasher>;
+
+    struct Node
+    {
+        std::optional<BlockIdType> parent;
+        LoraTaskIdType loraTaskId;
+        VecUniqueTokens tokens;
+        ChildMap children;
+    };
+
+    [[nodiscard]] ChildMap const* getChildren(
+        LoraTaskIdType loraTaskId, std::optional<BlockIdType> const& parent) const;
+
+    [[nodiscard]] ChildMap& getOrCreateChildren(LoraTaskIdType loraTaskId, std::optional<BlockIdType> const& parent);
+
+    SizeType32 mTokensPerBlock;
+    std::unordered_map<BlockIdType, Node> mNodes;
+    // First level blocks for every LoRA task
+    std::unordered_map<LoraTaskIdType, ChildMap> mRoots;
+};
+
+} // namespace tensorrt_llm::runtime
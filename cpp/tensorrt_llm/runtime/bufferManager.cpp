@@ -28,19 +28,24 @@ namespace tc = tensorrt_llm::common;
 namespace tensorrt_llm::runtime
 {
 
-BufferManager::BufferManager(CudaStreamPtr stream, bool trimPool)
+BufferManager::BufferManager(CudaStreamPtr stream, bool trimPool, MemoryPoolClass poolClass)
     : mStream{std::move(stream)}
     , mTrimPool{trimPool}
 {
     TLLM_CHECK_WITH_INFO(static_cast<bool>(mStream), "Undefined CUDA stream");
-    mPool = CudaMemPool::getPrimaryPoolForDevice(mStream->getDevice());
+    TLLM_CHECK_WITH_INFO(poolClass != MemoryPoolClass::kEMERGENCY, "The emergency pool is only a fallback");
+    mPool = CudaMemPool::getPoolForDevice(mStream->getDevice(), poolClass);
+    if (poolClass == MemoryPoolClass::kPRIMARY)
+    {
+        mEmergencyPool = CudaMemPool::getPoolForDevice(mStream->getDevice(), MemoryPoolClass::kEMERGENCY);
+    }
 }
 
 BufferManager::IBufferPtr BufferManager::gpu(std::size_t size, nvinfer1::DataType type) const
 {
     if (static_cast<bool>(mPool))
     {
-        return std::make_unique<DeviceBuffer>(size, type, CudaAllocatorAsync{mStream, mPool});
+        return std::make_unique<DeviceBuffer>(size, type, CudaAllocatorAsync{mStream, mPool, mEmergencyPool});
     }
     // When memory pools are not supported, fallback to synchronous memory allocations.
     return gpuSync(size, type);
@@ -50,7 +55,7 @@ BufferManager::ITensorPtr BufferManager::gpu(nvinfer1::Dims dims, nvinfer1::Data
 {
     if (static_cast<bool>(mPool))
     {
-        return std::make_unique<DeviceTensor>(dims, type, CudaAllocatorAsync{mStream, mPool});
+        return std::make_unique<DeviceTensor>(dims, type, CudaAllocatorAsync{mStream, mPool, mEmergencyPool});
     }
     // When memory pools are not supported, fallback to synchronous memory allocations.
     return gpuSync(dims, type);
@@ -96,6 +101,16 @@ BufferManager::ITensorPtr BufferManager::pinnedPool(nvinfer1::Dims dims, nvinfer
     return std::make_unique<PinnedPoolTensor>(dims, type);
 }
 
+BufferManager::IBufferPtr BufferManager::pinnedStaging(std::size_t size, nvinfer1::DataType type)
+{
+    return std::make_unique<PinnedStagingBuffer>(size, type);
+}
+
+BufferManager::ITensorPtr BufferManager::pinnedStaging(nvinfer1::Dims dims, nvinfer1::DataType type)
+{
+    return std::make_unique<PinnedStagingTensor>(dims, type);
+}
+
 BufferManager::IBufferPtr BufferManager::managed(std::size_t size, nvinfer1::DataType type)
 {
     return std::make_unique<UVMBuffer>(size, type);
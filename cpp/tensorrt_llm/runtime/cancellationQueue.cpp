@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/cancellationQueue.h"
+#include "tensorrt_llm/common/assert.h"
+
+namespace tensorrt_llm::runtime
+{
+
+CancellationQueue::CancellationQueue(SizeType32 maxUnmatchedPasses)
+    : mMaxUnmatchedPasses{maxUnmatchedPasses}
+{
+    TLLM_CHECK_WITH_INFO(maxUnmatchedPasses > 0, "Cancellations must be kept for at least one pass");
+}
+
+void CancellationQueue::cancel(RequestIdType requestId)
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    // Cancelling again restarts the count of unmatched passes
+    mPending[requestId] = 0;
+    mNumPending.store(mPending.size(), std::memory_order_release);
+}
+
+std::vector<CancellationQueue::RequestIdType> CancellationQueue::takeCancelled(
+    std::vector<RequestIdType> const& knownRequestIds)
+{
+    std::vector<RequestIdType> cancelled;
+    if (!hasPending())
+    {
+        return cancelled;
+    }
+
+    std::lock_guard<std::mutex> const lock(mMutex);
+    for (auto const requestId : knownRequestIds)
+    {
+        if (mPending.erase(requestId) > 0)
+        {
+            cancelled.push_back(requestId);
+        }
+    }
+    for (auto it = mPending.begin(); it != mPending.end();)
+    {
+        it = ++it->second >= mMaxUnmatchedPasses ? mPending.erase(it) : std::next(it);
+    }
+    mNumPending.store(mPending.size(), std::memory_order_release);
+    mNumTaken.fetch_add(cancelled.size(), std::memory_order_relaxed);
+    return cancelled;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Collects cancellations between scheduling passes, so that cancelled requests give back their resources
+//! before the next forward.
+//! \details Executor::cancelRequest can be called from any thread. Rather than waiting for the generation loop to
+//! notice the cancelled flag of the request when it reconciles finished requests, the scheduling pass takes the
+//! cancelled requests out of the queued and in-flight ones before building the batch. In-flight ones then release
+//! their KV cache blocks, storing the filled ones for reuse, and free their decoder slot, which the next request set
+//! up in that slot overwrites, so no synchronization is added.
+//!
+//! A cancellation for a request the pass does not know yet, e.g. one being moved from the queue while the pass runs,
+//! is kept for a few passes. After that the request is assumed to have finished, and the cancellation is dropped.
+class CancellationQueue
+{
+public:
+    using RequestIdType = std::uint64_t;
+
+    //! \param maxUnmatchedPasses Scheduling passes a cancellation of an unknown request is kept for.
+    explicit CancellationQueue(SizeType32 maxUnmatchedPasses = 2);
+
+    //! \brief Cancel a request. Can be called from any thread.
+    void cancel(RequestIdType requestId);
+
+    //! \brief Whether cancellations are waiting, a cheap check for the scheduling pass to skip takeCancelled.
+    [[nodiscard]] bool hasPending() const noexcept
+    {
+        return mNumPending.load(std::memory_order_acquire) > 0;
+    }
+
+    //! \brief Take the cancellations of the known requests.
+    //! \param knownRequestIds The queued and in-flight requests of the scheduling pass.
+    //! \return The cancelled ones among them, in the order of knownRequestIds.
+    [[nodiscard]] std::vector<RequestIdType> takeCancelled(std::vector<RequestIdType> const& knownRequestIds);
+
+    //! \brief Number of cancelled requests taken so far.
+    [[nodiscard]] std::uint64_t getNumTaken() const noexcept
+    {
+        return mNumTaken.load(std::memory_order_relaxed);
+    }
+
+private:
+    SizeType32 const mMaxUnmatchedPasses;
+
+    std::mutex mMutex;
+    //! Cancelled request id to the number of passes it went unmatched
+    std::unordered_map<RequestIdType, SizeType32> mPending;
+    std::atomic<std::size_t> mNumPending{0};
+    std::atomic<std::uint64_t> mNumTaken{0};
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/contextParallelPlan.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+ContextParallelPlan::ContextParallelPlan(SizeType32 cpSize, SizeType32 cpRank)
+    : mSize{cpSize}
+    , mRank{cpRank}
+{
+    TLLM_CHECK_WITH_INFO(cpSize > 0 && cpRank >= 0 && cpRank < cpSize, "Invalid context parallel rank %d of %d",
+        cpRank, cpSize);
+    auto const queryChunks = getChunks(mRank);
+    mSteps.reserve(mSize);
+    for (SizeType32 step = 0; step < mSize; ++step)
+    {
+        RingStep ringStep{};
+        ringStep.kvRank = (mRank + mSize - step) % mSize;
+        auto const kvChunks = getChunks(ringStep.kvRank);
+        for (std::size_t i = 0; i < queryChunks.size(); ++i)
+        {
+            for (std::size_t j = 0; j < kvChunks.size(); ++j)
+            {
+                ringStep.masks[i][j] = getChunkMask(queryChunks[i], kvChunks[j]);
+            }
+        }
+        mSteps.push_back(ringStep);
+    }
+}
+
+std::array<ContextParallelPlan::TokenRange, 2> ContextParallelPlan::getTokenRanges(
+    SizeType32 sequenceLength, SizeType32 rank) const
+{
+    TLLM_CHECK_WITH_INFO(rank >= 0 && rank < mSize, "Rank %d out of range [0, %d)", rank, mSize);
+    auto const numChunks = 2 * mSize;
+    auto const chunkBegin = [sequenceLength, numChunks](SizeType32 chunk)
+    {
+        auto const base = sequenceLength / numChunks;
+        auto const remainder = sequenceLength % numChunks;
+        return chunk * base + std::min(chunk, remainder);
+    };
+    std::array<TokenRange, 2> ranges{};
+    auto const chunks = getChunks(rank);
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+        ranges[i] = TokenRange{chunkBegin(chunks[i]), chunkBegin(chunks[i] + 1)};
+    }
+    return ranges;
+}
+
+SizeType32 ContextParallelPlan::getNumLocalTokens(SizeType32 sequenceLength) const
+{
+    auto const ranges = getLocalTokenRanges(sequenceLength);
+    return ranges[0].size() + ranges[1].size();
+}
+
+ContextParallelPlan::ChunkMask ContextParallelPlan::getChunkMask(SizeType32 queryChunk, SizeType32 kvChunk) noexcept
+{
+    if (kvChunk < queryChunk)
+    {
+        return ChunkMask::kFULL;
+    }
+    return kvChunk == queryChunk ? ChunkMask::kCAUSAL : ChunkMask::kNONE;
+}
+
+} // namespace tensorrt_llm::runtime
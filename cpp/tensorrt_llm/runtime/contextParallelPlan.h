@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Shards a long context over cpSize ranks and schedules its ring attention.
+//! \details The sequence is cut into 2 * cpSize chunks and rank r holds chunks r and 2 * cpSize - 1 - r, so that
+//! under the causal mask every rank has the same amount of attention work. Each rank computes Q, K and V of its own
+//! tokens and writes its K and V to its own KV cache, the cache stays sharded. Ring attention then runs cpSize steps:
+//! at step s a rank attends its queries to the K/V chunks of rank (r - s) mod cpSize, while it forwards them to rank
+//! r + 1 and receives those of the next step from rank r - 1. The partial results of the steps are merged with
+//! kernels::invokeMergeAttentionStates.
+class ContextParallelPlan
+{
+public:
+    //! \brief How the queries of one chunk attend to the keys of another.
+    enum class ChunkMask : std::int8_t
+    {
+        //! The keys come after the queries, skip the pair
+        kNONE = 0,
+        //! The keys come before the queries, no mask
+        kFULL = 1,
+        //! The same chunk, causal mask
+        kCAUSAL = 2,
+    };
+
+    struct TokenRange
+    {
+        SizeType32 begin;
+        SizeType32 end;
+
+        [[nodiscard]] SizeType32 size() const noexcept
+        {
+            return end - begin;
+        }
+    };
+
+    //! \brief The attention work of one ring step.
+    struct RingStep
+    {
+        //! The rank whose K/V chunks are attended in this step
+        SizeType32 kvRank;
+        //! masks[i][j]: the mask of local query chunk i against K/V chunk j of kvRank
+        std::array<std::array<ChunkMask, 2>, 2> masks;
+    };
+
+    ContextParallelPlan(SizeType32 cpSize, SizeType32 cpRank);
+
+    [[nodiscard]] SizeType32 getSize() const noexcept
+    {
+        return mSize;
+    }
+
+    [[nodiscard]] SizeType32 getRank() const noexcept
+    {
+        return mRank;
+    }
+
+    //! \brief The rank K/V chunks are sent to, and received from, in every step.
+    [[nodiscard]] SizeType32 getSendRank() const noexcept
+    {
+        return (mRank + 1) % mSize;
+    }
+
+    [[nodiscard]] SizeType32 getRecvRank() const noexcept
+    {
+        return (mRank + mSize - 1) % mSize;
+    }
+
+    //! \brief The two token ranges of a sequence held by rank. The first chunks get the remainder of the tokens.
+    [[nodiscard]] std::array<TokenRange, 2> getTokenRanges(SizeType32 sequenceLength, SizeType32 rank) const;
+
+    [[nodiscard]] std::array<TokenRange, 2> getLocalTokenRanges(SizeType32 sequenceLength) const
+    {
+        return getTokenRanges(sequenceLength, mRank);
+    }
+
+    [[nodiscard]] SizeType32 getNumLocalTokens(SizeType32 sequenceLength) const;
+
+    //! \brief The steps of the ring, step 0 attends the local K/V.
+    [[nodiscard]] std::vector<RingStep> const& getRingSteps() const noexcept
+    {
+        return mSteps;
+    }
+
+    [[nodiscard]] static ChunkMask getChunkMask(SizeType32 queryChunk, SizeType32 kvChunk) noexcept;
+
+private:
+    [[nodiscard]] std::array<SizeType32, 2> getChunks(SizeType32 rank) const noexcept
+    {
+        return {rank, 2 * mSize - 1 - rank};
+    }
+
+    SizeType32 mSize;
+    SizeType32 mRank;
+    std::vector<RingStep> mSteps;
+};
+
+} // namespace tensorrt_llm::runtime
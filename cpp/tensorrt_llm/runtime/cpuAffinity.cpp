@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/cpuAffinity.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/workerPool.h"
+
+#include <cuda_runtime_api.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <climits>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+// Memory policy modes of set_mempolicy(2), see <numaif.h>, which comes with libnuma
+int constexpr kMpolDefault = 0;
+int constexpr kMpolPreferred = 1;
+// Nodes covered by the node masks passed to the kernel
+std::size_t constexpr kMaxNumaNodes = 1024;
+std::size_t constexpr kBitsPerWord = sizeof(unsigned long) * CHAR_BIT;
+
+// -1 while the placement is left to the OS
+std::atomic<std::int32_t> pinnedMemoryNode{-1};
+
+std::string getPciBusId(std::int32_t deviceId)
+{
+    std::array<char, 32> busId{};
+    if (cudaDeviceGetPCIBusId(busId.data(), static_cast<int>(busId.size()), deviceId) != cudaSuccess)
+    {
+        return {};
+    }
+    std::string busIdStr{busId.data()};
+    std::transform(busIdStr.begin(), busIdStr.end(), busIdStr.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return busIdStr;
+}
+} // namespace
+
+std::vector<std::int32_t> CpuAffinity::resolve(executor::CpuAffinityConfig const& config, std::int32_t deviceId)
+{
+    auto const& deviceCpus = config.getDeviceCpus();
+    auto const it = deviceCpus.find(deviceId);
+    auto cpus = it != deviceCpus.end() ? it->second : WorkerPool::getDeviceCpuAffinity(deviceId);
+
+    auto const allowed = getCurrentThreadCpus();
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    std::vector<std::int32_t> usable;
+    std::set_intersection(cpus.begin(), cpus.end(), allowed.begin(), allowed.end(), std::back_inserter(usable));
+    if (usable.empty() && !cpus.empty())
+    {
+        TLLM_LOG_WARNING("None of the CPUs for device %d is available to the process, its threads are not pinned",
+            deviceId);
+    }
+    return usable;
+}
+
+std::vector<std::int32_t> CpuAffinity::apply(executor::CpuAffinityConfig const& config, std::int32_t deviceId)
+{
+    auto cpus = resolve(config, deviceId);
+    if (!cpus.empty() && !pinCurrentThread(cpus))
+    {
+        cpus.clear();
+    }
+    if (config.getNumaLocalHostMemory())
+    {
+        setPinnedMemoryNode(getDeviceNumaNode(deviceId));
+    }
+    TLLM_LOG_INFO("Rank on device %d pinned to %zu CPUs, pinned host memory on NUMA node %d", deviceId, cpus.size(),
+        getPinnedMemoryNode().value_or(-1));
+    return cpus;
+}
+
+bool CpuAffinity::pinCurrentThread(std::vector<std::int32_t> const& cpus)
+{
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (auto const cpu : cpus)
+    {
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+        {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+    if (CPU_COUNT(&cpuSet) == 0 || pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+    {
+        TLLM_LOG_WARNING("Could not set the CPU affinity of the calling thread");
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::int32_t> CpuAffinity::getCurrentThreadCpus()
+{
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    std::vector<std::int32_t> cpus;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+    {
+        return cpus;
+    }
+    for (std::int32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &cpuSet))
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+std::optional<std::int32_t> CpuAffinity::getDeviceNumaNode(std::int32_t deviceId)
+{
+    auto const busId = getPciBusId(deviceId);
+    if (busId.empty())
+    {
+        return std::nullopt;
+    }
+    std::ifstream file{"/sys/bus/pci/devices/" + busId + "/numa_node"};
+    std::int32_t node{-1};
+    if (!(file >> node) || node < 0)
+    {
+        return std::nullopt;
+    }
+    return node;
+}
+
+void CpuAffinity::setPinnedMemoryNode(std::optional<std::int32_t> node) noexcept
+{
+    pinnedMemoryNode.store(node.value_or(-1), std::memory_order_relaxed);
+}
+
+std::optional<std::int32_t> CpuAffinity::getPinnedMemoryNode() noexcept
+{
+    auto const node = pinnedMemoryNode.load(std::memory_order_relaxed);
+    return node >= 0 ? std::make_optional(node) : std::nullopt;
+}
+
+ScopedNumaPreference::ScopedNumaPreference(std::optional<std::int32_t> node)
+{
+    if (!node || static_cast<std::size_t>(*node) >= kMaxNumaNodes)
+    {
+        return;
+    }
+    auto const numWords = kMaxNumaNodes / kBitsPerWord;
+    mPreviousNodes.assign(numWords, 0);
+    if (syscall(SYS_get_mempolicy, &mPreviousMode, mPreviousNodes.data(), kMaxNumaNodes, nullptr, 0) != 0)
+    {
+        return;
+    }
+    std::vector<unsigned long> nodes(numWords, 0);
+    nodes[*node / kBitsPerWord] |= 1UL << (*node % kBitsPerWord);
+    mActive = syscall(SYS_set_mempolicy, kMpolPreferred, nodes.data(), kMaxNumaNodes) == 0;
+}
+
+ScopedNumaPreference::~ScopedNumaPreference()
+{
+    if (mActive)
+    {
+        auto const* previousNodes = mPreviousMode == kMpolDefault ? nullptr : mPreviousNodes.data();
+        syscall(SYS_set_mempolicy, mPreviousMode, previousNodes, previousNodes ? kMaxNumaNodes : 0);
+    }
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::executor
+{
+class CpuAffinityConfig;
+} // namespace tensorrt_llm::executor
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Applies a CpuAffinityConfig to a rank of the executor.
+//! \details Threads inherit the affinity of the thread that creates them, so pinning the thread that constructs the
+//! executor, before the executor creates its own threads, the worker pools and the MPI communicators, places all of
+//! them. Pinned host memory is placed by preferring the NUMA node of the device while the pages are allocated, see
+//! ScopedNumaPreference, which PinnedAllocator does for every allocation once setPinnedMemoryNode was called.
+class CpuAffinity
+{
+public:
+    //! \brief The CPUs for the threads of the rank using deviceId: those of the config for the device, otherwise
+    //! the CPUs local to the device. Restricted to the CPUs the calling thread may use, e.g. within a container.
+    //! \return Empty if neither is known, the threads are then left to the OS.
+    [[nodiscard]] static std::vector<std::int32_t> resolve(
+        executor::CpuAffinityConfig const& config, std::int32_t deviceId);
+
+    //! \brief Pin the threads of the rank using deviceId and place its pinned memory, see resolve().
+    //! \return The CPUs the calling thread was pinned to, empty if it was not pinned.
+    static std::vector<std::int32_t> apply(executor::CpuAffinityConfig const& config, std::int32_t deviceId);
+
+    //! \brief Restrict the calling thread to cpus. Returns false, with a warning, if the OS refused.
+    static bool pinCurrentThread(std::vector<std::int32_t> const& cpus);
+
+    //! \brief The CPUs the calling thread may run on.
+    [[nodiscard]] static std::vector<std::int32_t> getCurrentThreadCpus();
+
+    //! \brief The NUMA node of a device, std::nullopt if the host has a single node or it is unknown.
+    [[nodiscard]] static std::optional<std::int32_t> getDeviceNumaNode(std::int32_t deviceId);
+
+    //! \brief The NUMA node pinned host memory is allocated on, std::nullopt to leave the placement to the OS.
+    static void setPinnedMemoryNode(std::optional<std::int32_t> node) noexcept;
+
+    [[nodiscard]] static std::optional<std::int32_t> getPinnedMemoryNode() noexcept;
+};
+
+//! \brief Makes the calling thread prefer a NUMA node for the pages it allocates, until destroyed.
+//! \details The previous memory policy of the thread is restored. Does nothing for std::nullopt or if the kernel
+//! does not support memory policies.
+class ScopedNumaPreference
+{
+public:
+    explicit ScopedNumaPreference(std::optional<std::int32_t> node);
+
+    ScopedNumaPreference(ScopedNumaPreference const&) = delete;
+    ScopedNumaPreference& operator=(ScopedNumaPreference const&) = delete;
+
+    ~ScopedNumaPreference();
+
+    [[nodiscard]] bool isActive() const noexcept
+    {
+        return mActive;
+    }
+
+private:
+    bool mActive{false};
+    int mPreviousMode{0};
+    std::vector<unsigned long> mPreviousNodes;
+};
+
+} // namespace tensorrt_llm::runtime
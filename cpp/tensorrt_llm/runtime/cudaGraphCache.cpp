@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/cudaGraphCache.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+CudaGraphExecutor::~CudaGraphExecutor()
+{
+    try
+    {
+        clear();
+    }
+    catch (std::exception& e)
+    {
+        TLLM_LOG_EXCEPTION(e);
+    }
+}
+
+void CudaGraphExecutor::capture(cudaStream_t stream, std::function<void()> const& enqueue)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    cudaGraph_t graph;
+    TLLM_CUDA_CHECK(cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal));
+    enqueue();
+    TLLM_CUDA_CHECK(cudaStreamEndCapture(stream, &graph));
+
+    if (hasInstance() && cudaGraphExecUpdate(mInstance, graph, nullptr) != cudaSuccess)
+    {
+        // Clear the sticky error left by the failed update before re-instantiating
+        cudaGetLastError();
+        clear();
+    }
+    if (!hasInstance())
+    {
+        TLLM_CUDA_CHECK(cudaGraphInstantiate(&mInstance, graph, nullptr, nullptr, 0));
+    }
+    TLLM_CUDA_CHECK(cudaGraphDestroy(graph));
+    TLLM_CUDA_CHECK(cudaGraphUpload(mInstance, stream));
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+void CudaGraphExecutor::launch(cudaStream_t stream) const
+{
+    TLLM_CHECK_WITH_INFO(hasInstance(), "No CUDA graph captured");
+    TLLM_CUDA_CHECK(cudaGraphLaunch(mInstance, stream));
+}
+
+void CudaGraphExecutor::clear()
+{
+    if (mInstance != nullptr)
+    {
+        TLLM_CUDA_CHECK(cudaGraphExecDestroy(mInstance));
+        mInstance = nullptr;
+    }
+}
+
+CudaGraphCache::CudaGraphCache(std::vector<SizeType32> batchSizeBuckets, SizeType32 maxNumGraphs)
+    : mBatchSizeBuckets{std::move(batchSizeBuckets)}
+    , mMaxNumGraphs{maxNumGraphs}
+{
+    TLLM_CHECK_WITH_INFO(!mBatchSizeBuckets.empty(), "At least one batch size bucket is required");
+    TLLM_CHECK_WITH_INFO(maxNumGraphs > 0, "maxNumGraphs must be positive");
+    std::sort(mBatchSizeBuckets.begin(), mBatchSizeBuckets.end());
+    mBatchSizeBuckets.erase(std::unique(mBatchSizeBuckets.begin(), mBatchSizeBuckets.end()), mBatchSizeBuckets.end());
+    TLLM_CHECK_WITH_INFO(mBatchSizeBuckets.front() > 0, "Batch size buckets must be positive");
+}
+
+std::vector<SizeType32> CudaGraphCache::getDefaultBuckets(SizeType32 maxBatchSize)
+{
+    TLLM_CHECK_WITH_INFO(maxBatchSize > 0, "maxBatchSize must be positive");
+    std::vector<SizeType32> buckets;
+    for (SizeType32 batchSize = 1; batchSize < std::min(maxBatchSize, 8); batchSize *= 2)
+    {
+        buckets.push_back(batchSize);
+    }
+    for (SizeType32 batchSize = 8; batchSize < maxBatchSize; batchSize += 8)
+    {
+        buckets.push_back(batchSize);
+    }
+    buckets.push_back(maxBatchSize);
+    return buckets;
+}
+
+std::optional<SizeType32> CudaGraphCache::getPaddedBatchSize(SizeType32 batchSize) const
+{
+    auto const it = std::lower_bound(mBatchSizeBuckets.begin(), mBatchSizeBuckets.end(), batchSize);
+    if (it == mBatchSizeBuckets.end())
+    {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+CudaGraphCache::GraphPtr CudaGraphCache::get(CudaGraphKey const& key)
+{
+    auto const it = mGraphs.find(key);
+    if (it == mGraphs.end())
+    {
+        return nullptr;
+    }
+    mLruKeys.splice(mLruKeys.begin(), mLruKeys, it->second.lruIt);
+    return it->second.graph;
+}
+
+void CudaGraphCache::put(CudaGraphKey const& key, GraphPtr graph)
+{
+    if (auto const it = mGraphs.find(key); it != mGraphs.end())
+    {
+        it->second.graph = std::move(graph);
+        mLruKeys.splice(mLruKeys.begin(), mLruKeys, it->second.lruIt);
+        return;
+    }
+    if (size() >= mMaxNumGraphs)
+    {
+        auto const& lruKey = mLruKeys.back();
+        TLLM_LOG_DEBUG("Evicting CUDA graph for batch size %d", lruKey.batchSize);
+        mGraphs.erase(lruKey);
+        mLruKeys.pop_back();
+        ++mNumEvictions;
+    }
+    mLruKeys.push_front(key);
+    mGraphs.emplace(key, Entry{std::move(graph), mLruKeys.begin()});
+}
+
+void CudaGraphCache::clear()
+{
+    mGraphs.clear();
+    mLruKeys.clear();
+}
+
+} // namespace tensorrt_llm::runtime
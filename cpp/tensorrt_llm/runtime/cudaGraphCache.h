@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cuda_runtime_api.h>
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Owns an executable CUDA graph captured from the work enqueued by a function on a stream.
+class CudaGraphExecutor
+{
+public:
+    CudaGraphExecutor() = default;
+    ~CudaGraphExecutor();
+
+    CudaGraphExecutor(CudaGraphExecutor const&) = delete;
+    CudaGraphExecutor& operator=(CudaGraphExecutor const&) = delete;
+
+    [[nodiscard]] bool hasInstance() const noexcept
+    {
+        return mInstance != nullptr;
+    }
+
+    //! \brief Capture the work enqueued by enqueue on stream. An existing instance is updated in place if the topology
+    //! allows it, otherwise re-instantiated.
+    void capture(cudaStream_t stream, std::function<void()> const& enqueue);
+
+    void launch(cudaStream_t stream) const;
+
+    void clear();
+
+private:
+    cudaGraphExec_t mInstance{nullptr};
+};
+
+//! \brief Shape of a generation-only step that a graph is captured for.
+struct CudaGraphKey
+{
+    //! Padded batch size, see CudaGraphCache::getPaddedBatchSize
+    SizeType32 batchSize;
+    SizeType32 beamWidth;
+    //! Tokens per sequence, larger than one for speculative decoding
+    SizeType32 numTokensPerSeq;
+
+    bool operator==(CudaGraphKey const& other) const noexcept
+    {
+        return batchSize == other.batchSize && beamWidth == other.beamWidth && numTokensPerSeq == other.numTokensPerSeq;
+    }
+};
+
+struct CudaGraphKeyHasher
+{
+    std::size_t operator()(CudaGraphKey const& key) const noexcept
+    {
+        auto seed = static_cast<std::size_t>(key.batchSize);
+        seed ^= static_cast<std::size_t>(key.beamWidth) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= static_cast<std::size_t>(key.numTokensPerSeq) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+};
+
+//! \brief LRU cache of CUDA graphs for generation-only inflight batching steps.
+//! \details Batch sizes are padded up to a bucket, so a handful of graphs cover all batch sizes. The padded slots run
+//! on dummy inputs and their outputs are ignored.
+class CudaGraphCache
+{
+public:
+    using GraphPtr = std::shared_ptr<CudaGraphExecutor>;
+
+    //! \param batchSizeBuckets Batch sizes graphs are captured for, in any order.
+    //! \param maxNumGraphs Maximum number of graphs kept, least recently used ones are evicted beyond it.
+    CudaGraphCache(std::vector<SizeType32> batchSizeBuckets, SizeType32 maxNumGraphs);
+
+    //! \brief Buckets 1, 2, 4, 8 and then every multiple of 8 up to maxBatchSize, which is always included.
+    [[nodiscard]] static std::vector<SizeType32> getDefaultBuckets(SizeType32 maxBatchSize);
+
+    //! \brief Smallest bucket that holds batchSize. Not set if batchSize exceeds the largest bucket, in which case the
+    //! step runs without graph.
+    [[nodiscard]] std::optional<SizeType32> getPaddedBatchSize(SizeType32 batchSize) const;
+
+    //! \brief Look up a graph and mark it as most recently used. nullptr if not cached.
+    [[nodiscard]] GraphPtr get(CudaGraphKey const& key);
+
+    //! \brief Insert or replace a graph, evicting the least recently used one if the cache is full.
+    void put(CudaGraphKey const& key, GraphPtr graph);
+
+    void clear();
+
+    [[nodiscard]] SizeType32 size() const noexcept
+    {
+        return static_cast<SizeType32>(mLruKeys.size());
+    }
+
+    [[nodiscard]] std::vector<SizeType32> const& getBatchSizeBuckets() const noexcept
+    {
+        return mBatchSizeBuckets;
+    }
+
+    [[nodiscard]] SizeType32 getNumEvictions() const noexcept
+    {
+        return mNumEvictions;
+    }
+
+private:
+    struct Entry
+    {
+        GraphPtr graph;
+        std::list<CudaGraphKey>::iterator lruIt;
+    };
+
+    std::vector<SizeType32> mBatchSizeBuckets;
+    SizeType32 mMaxNumGraphs;
+    // Most recently used first
+    std::list<CudaGraphKey> mLruKeys;
+    std::unordered_map<CudaGraphKey, Entry, CudaGraphKeyHasher> mGraphs;
+    SizeType32 mNumEvictions{0};
+};
+
+} // namespace tensorrt_llm::runtime
@@ -17,11 +17,15 @@
 #include "tensorrt_llm/runtime/cudaMemPool.h"
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
 #include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include <algorithm>
 #include <array>
 #include <cuda_runtime_api.h>
 #include <memory>
 #include <mutex>
+#include <optional>
 
 namespace tensorrt_llm::runtime
 {
@@ -78,7 +82,7 @@ void CudaMemPool::Deleter::operator()(cudaMemPool_t pool) const
 namespace
 {
 
-std::shared_ptr<CudaMemPool> createPrimaryDevicePool(int deviceId)
+std::shared_ptr<CudaMemPool> createDevicePool(int deviceId, CudaMemPool::PoolConfig const& config)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
 
@@ -89,11 +93,24 @@ std::shared_ptr<CudaMemPool> createPrimaryDevicePool(int deviceId)
     poolProps.location.type = ::cudaMemLocationTypeDevice;
     poolProps.location.id = deviceId;
     TLLM_CUDA_CHECK(::cudaMemPoolCreate(&memPool, &poolProps));
-    // set memory pool threshold to avoid shrinking the pool
-    auto maxThreshold = std::numeric_limits<std::uint64_t>::max();
-    TLLM_CUDA_CHECK(cudaMemPoolSetAttribute(memPool, cudaMemPoolAttrReleaseThreshold, &maxThreshold));
+    auto pool = std::make_shared<CudaMemPool>(memPool, deviceId);
+    // set memory pool threshold to avoid shrinking the pool below the reservation
+    auto threshold = std::max<std::uint64_t>(config.releaseThreshold, config.reservedSize);
+    TLLM_CUDA_CHECK(cudaMemPoolSetAttribute(memPool, cudaMemPoolAttrReleaseThreshold, &threshold));
+    if (config.reservedSize > 0)
+    {
+        // Grow the pool once, the memory stays reserved after the free as it is below the threshold
+        int currentDevice{};
+        TLLM_CUDA_CHECK(cudaGetDevice(&currentDevice));
+        TLLM_CUDA_CHECK(cudaSetDevice(deviceId));
+        void* ptr{nullptr};
+        TLLM_CUDA_CHECK(::cudaMallocFromPoolAsync(&ptr, config.reservedSize, memPool, cudaStreamPerThread));
+        TLLM_CUDA_CHECK(::cudaFreeAsync(ptr, cudaStreamPerThread));
+        TLLM_CUDA_CHECK(::cudaStreamSynchronize(cudaStreamPerThread));
+        TLLM_CUDA_CHECK(cudaSetDevice(currentDevice));
+    }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
-    return std::make_shared<CudaMemPool>(memPool, deviceId);
+    return pool;
 }
 
 /// @brief The maximum number of devices per node this feature supports. Increase when/if this value becomes too small.
@@ -112,8 +129,106 @@ std::array<std::shared_ptr<CudaMemPool>, maxDevicePerNode> primaryDevicePools{};
 /// trying to initialize the memory pool for a device, if the first attempt failed.
 std::array<bool, maxDevicePerNode> primaryDevicePoolInitAttempted{};
 
+constexpr std::size_t numPoolClasses = 5;
+
+/// @brief Guards the pools of the other classes and the config overrides.
+std::mutex classPoolsMutex{};
+
+/// @brief The pools of the classes other than kPRIMARY, for each device.
+std::array<std::array<std::shared_ptr<CudaMemPool>, numPoolClasses>, maxDevicePerNode> classPools{};
+
+/// @brief Whether creating the pool of a class has been attempted for each device.
+std::array<std::array<bool, numPoolClasses>, maxDevicePerNode> classPoolInitAttempted{};
+
+/// @brief Settings set by setPoolConfig, replacing those from the environment.
+std::array<std::optional<CudaMemPool::PoolConfig>, numPoolClasses> poolConfigOverrides{};
+
+std::size_t toIndex(MemoryPoolClass poolClass)
+{
+    auto const index = static_cast<std::size_t>(poolClass);
+    TLLM_CHECK_WITH_INFO(index < numPoolClasses, "Invalid memory pool class %zu", index);
+    return index;
+}
+
 } // namespace
 
+CudaMemPool::PoolConfig CudaMemPool::getPoolConfig(MemoryPoolClass poolClass)
+{
+    auto constexpr kMiB = std::size_t{1} << 20;
+    {
+        std::lock_guard lockGuard{classPoolsMutex};
+        if (auto const& config = poolConfigOverrides.at(toIndex(poolClass)))
+        {
+            return *config;
+        }
+    }
+    PoolConfig config{};
+    switch (poolClass)
+    {
+    case MemoryPoolClass::kPRIMARY: break;
+    case MemoryPoolClass::kEMERGENCY:
+        config.reservedSize = common::getEnvEmergencyMemPoolSizeMB().value_or(0) * kMiB;
+        break;
+    default:
+        config.releaseThreshold = common::getEnvStreamMemPoolReleaseThresholdMB().value_or(64) * kMiB;
+        break;
+    }
+    return config;
+}
+
+void CudaMemPool::setPoolConfig(MemoryPoolClass poolClass, PoolConfig const& config)
+{
+    std::lock_guard lockGuard{classPoolsMutex};
+    auto const index = toIndex(poolClass);
+    for (std::size_t deviceId = 0; deviceId < maxDevicePerNode; ++deviceId)
+    {
+        auto const created = poolClass == MemoryPoolClass::kPRIMARY ? primaryDevicePoolInitAttempted.at(deviceId)
+                                                                    : classPoolInitAttempted.at(deviceId).at(index);
+        TLLM_CHECK_WITH_INFO(!created, "The config of pool class %zu must be set before its pools are created", index);
+    }
+    poolConfigOverrides.at(index) = config;
+}
+
+std::shared_ptr<CudaMemPool> CudaMemPool::getPoolForDevice(int deviceId, MemoryPoolClass poolClass)
+{
+    if (poolClass == MemoryPoolClass::kPRIMARY
+        || (poolClass != MemoryPoolClass::kEMERGENCY && !common::getEnvStreamMemPools()))
+    {
+        return getPrimaryPoolForDevice(deviceId);
+    }
+    auto const config = getPoolConfig(poolClass);
+    if (poolClass == MemoryPoolClass::kEMERGENCY && config.reservedSize == 0)
+    {
+        return {};
+    }
+
+    std::lock_guard lockGuard{classPoolsMutex};
+    auto const index = toIndex(poolClass);
+    auto& pool = classPools.at(deviceId).at(index);
+    auto& initAttempted = classPoolInitAttempted.at(deviceId).at(index);
+    if (initAttempted)
+    {
+        return pool;
+    }
+    initAttempted = true;
+    if (!CudaMemPool::supportsMemoryPool(deviceId))
+    {
+        return {};
+    }
+    try
+    {
+        pool = createDevicePool(deviceId, config);
+        TLLM_LOG_INFO("Created memory pool of class %zu for device %i, release threshold %lu B, %zu B reserved", index,
+            deviceId, config.releaseThreshold, config.reservedSize);
+    }
+    catch (std::exception const& exception)
+    {
+        TLLM_LOG_ERROR("Failed to initialize memory pool of class %zu for device %i.", index, deviceId);
+        TLLM_LOG_EXCEPTION(exception);
+    }
+    return pool;
+}
+
 std::shared_ptr<CudaMemPool> CudaMemPool::getPrimaryPoolForDevice(int deviceId)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
@@ -147,7 +262,8 @@ std::shared_ptr<CudaMemPool> CudaMemPool::getPrimaryPoolForDevice(int deviceId)
         // Creating the mem pool can throw, needs to be handled.
         try
         {
-            primaryDevicePools.at(deviceId) = createPrimaryDevicePool(deviceId);
+            primaryDevicePools.at(deviceId)
+                = createDevicePool(deviceId, CudaMemPool::getPoolConfig(MemoryPoolClass::kPRIMARY));
             primaryDevicePoolInitAttempted.at(deviceId) = true;
             TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
             return primaryDevicePools.at(deviceId);
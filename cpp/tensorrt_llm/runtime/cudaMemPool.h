@@ -16,6 +16,9 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
 
 /// @brief Forward declaration of cudaMemPool_t to avoid including "driver_types.h"
@@ -25,6 +28,9 @@ using cudaMemPool_t = CUmemPoolHandle_st*;
 namespace tensorrt_llm::runtime
 {
 
+/// @brief Declared in bufferManager.h.
+enum class MemoryPoolClass : std::int8_t;
+
 class CudaMemPool
 {
 public:
@@ -50,6 +56,28 @@ public:
     /// initialized, nullptr otherwise.
     static std::shared_ptr<tensorrt_llm::runtime::CudaMemPool> getPrimaryPoolForDevice(int deviceId);
 
+    /// @brief Settings a pool is created with.
+    struct PoolConfig
+    {
+        /// @brief Reserved memory above the threshold is returned to the device when the pool synchronizes.
+        std::uint64_t releaseThreshold{std::numeric_limits<std::uint64_t>::max()};
+        /// @brief Memory reserved when the pool is created, the release threshold is raised to keep it.
+        std::size_t reservedSize{0};
+    };
+
+    /// @brief The settings pools of the class are created with. kPRIMARY never releases memory. With
+    /// TRTLLM_STREAM_MEMPOOLS=1, the side classes release memory above TRTLLM_STREAM_MEMPOOL_RELEASE_THRESHOLD_MB,
+    /// 64 MiB by default. kEMERGENCY reserves TRTLLM_EMERGENCY_MEMPOOL_MB, none by default.
+    [[nodiscard]] static PoolConfig getPoolConfig(MemoryPoolClass poolClass);
+
+    /// @brief Override the settings of a pool class. Must be called before a pool of the class is created.
+    static void setPoolConfig(MemoryPoolClass poolClass, PoolConfig const& config);
+
+    /// @brief Gets or initializes and gets the pool of the class for the device. Side classes share the primary pool
+    /// unless TRTLLM_STREAM_MEMPOOLS=1. For kEMERGENCY, returns nullptr if no emergency memory is reserved. Also
+    /// returns nullptr if the device does not support memory pools or the pool could not be created.
+    static std::shared_ptr<CudaMemPool> getPoolForDevice(int deviceId, MemoryPoolClass poolClass);
+
     /// @brief Returns a value indicating whether memory pools are supported on the device.
     /// @details Memory pools depend on the presence of the UVM driver. On some systems, the UVM driver is explicitly
     /// disabled.
@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/dataParallelRouter.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <variant>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace kvc = tensorrt_llm::batch_manager::kv_cache_manager;
+
+namespace
+{
+// Block operations shared by exchange, zero pads the operations of a rank to the longest list.
+enum BlockOp : std::uint64_t
+{
+    kPadding = 0,
+    kStored = 1,
+    kRemoved = 2,
+};
+
+// numActiveRequests, numQueuedRequests, maxNumActiveRequests, freeNumBlocks, maxNumBlocks, number of block operations
+constexpr int kHeaderSize = 6;
+} // namespace
+
+DataParallelRouter::DataParallelRouter(
+    SizeType32 numRanks, SizeType32 tokensPerBlock, float loadWeight, float maxLoadImbalance)
+    : mTokensPerBlock{tokensPerBlock}
+    , mLoadWeight{loadWeight}
+    , mMaxLoadImbalance{maxLoadImbalance}
+    , mRanks(numRanks)
+{
+    TLLM_CHECK_WITH_INFO(numRanks > 0, "Data-parallel routing needs at least one rank");
+    TLLM_CHECK_WITH_INFO(tokensPerBlock > 0, "Data-parallel routing needs a positive block size");
+    TLLM_CHECK_WITH_INFO(loadWeight >= 0.F, "The load weight must not be negative");
+    TLLM_CHECK_WITH_INFO(maxLoadImbalance >= 0.F, "The maximum load imbalance must not be negative");
+}
+
+DataParallelRouter::RankLoad DataParallelRouter::getRankLoad(executor::IterationStats const& stats)
+{
+    RankLoad load{static_cast<SizeType32>(stats.numActiveRequests), static_cast<SizeType32>(stats.numQueuedRequests),
+        static_cast<SizeType32>(stats.maxNumActiveRequests)};
+    if (stats.kvCacheStats)
+    {
+        load.freeNumBlocks = stats.kvCacheStats->freeNumBlocks;
+        load.maxNumBlocks = stats.kvCacheStats->maxNumBlocks;
+    }
+    return load;
+}
+
+template <typename It>
+void DataParallelRouter::RankState::storeBlocks(It begin, It end)
+{
+    // Touch the last block first, so that the first blocks of the sequence end up the most recent.
+    for (auto it = std::make_reverse_iterator(end); it != std::make_reverse_iterator(begin); ++it)
+    {
+        auto const blockHash = *it;
+        if (auto const resident = residentBlocks.find(blockHash); resident != residentBlocks.end())
+        {
+            lruBlocks.splice(lruBlocks.begin(), lruBlocks, resident->second);
+        }
+        else
+        {
+            lruBlocks.push_front(blockHash);
+            residentBlocks.emplace(blockHash, lruBlocks.begin());
+        }
+    }
+    evictBlocks();
+}
+
+void DataParallelRouter::RankState::removeBlock(BlockHashType blockHash)
+{
+    if (auto const resident = residentBlocks.find(blockHash); resident != residentBlocks.end())
+    {
+        lruBlocks.erase(resident->second);
+        residentBlocks.erase(resident);
+    }
+}
+
+void DataParallelRouter::RankState::evictBlocks()
+{
+    // Without KV cache stats the capacity of the rank is unknown
+    if (load.maxNumBlocks <= 0)
+    {
+        return;
+    }
+    while (static_cast<SizeType32>(lruBlocks.size()) > load.maxNumBlocks)
+    {
+        residentBlocks.erase(lruBlocks.back());
+        lruBlocks.pop_back();
+    }
+}
+
+DataParallelRouter::RankState& DataParallelRouter::getRank(SizeType32 rank)
+{
+    TLLM_CHECK_WITH_INFO(
+        rank >= 0 && rank < getNumRanks(), "Data-parallel rank %d out of range [0, %d)", rank, getNumRanks());
+    return mRanks[rank];
+}
+
+DataParallelRouter::RankState const& DataParallelRouter::getRank(SizeType32 rank) const
+{
+    TLLM_CHECK_WITH_INFO(
+        rank >= 0 && rank < getNumRanks(), "Data-parallel rank %d out of range [0, %d)", rank, getNumRanks());
+    return mRanks[rank];
+}
+
+float DataParallelRouter::getLoad(SizeType32 rank) const
+{
+    auto const& state = getRank(rank);
+    auto const& load = state.load;
+    auto const numRequests = load.numActiveRequests + load.numQueuedRequests + state.numPending;
+    auto const slotUsage = load.maxNumActiveRequests > 0
+        ? static_cast<float>(numRequests) / static_cast<float>(load.maxNumActiveRequests)
+        : 0.F;
+    auto const blockUsage = load.maxNumBlocks > 0
+        ? static_cast<float>(load.maxNumBlocks - load.freeNumBlocks) / static_cast<float>(load.maxNumBlocks)
+        : 0.F;
+    // Queued requests can push the slot usage beyond one, they still make the rank worse than a full one.
+    return std::max(slotUsage, blockUsage);
+}
+
+SizeType32 DataParallelRouter::getNumMatchedBlocks(
+    SizeType32 rank, std::vector<BlockHashType> const& blockHashes) const
+{
+    auto const& residentBlocks = getRank(rank).residentBlocks;
+    // Hashes are chained, a block is only reusable if all blocks before it are.
+    auto const firstMissing = std::find_if(blockHashes.begin(), blockHashes.end(),
+        [&residentBlocks](BlockHashType blockHash) { return residentBlocks.count(blockHash) == 0; });
+    return static_cast<SizeType32>(std::distance(blockHashes.begin(), firstMissing));
+}
+
+DataParallelRouter::Dispatch DataParallelRouter::route(executor::Request const& request)
+{
+    auto const tokenIds = request.getInputTokenIds();
+    std::optional<VecTokenExtraIds> tokenExtraIds;
+    if (auto const promptTuningConfig = request.getPromptTuningConfig())
+    {
+        tokenExtraIds = promptTuningConfig->getInputTokenExtraIds();
+    }
+    TLLM_CHECK_WITH_INFO(!tokenExtraIds || tokenExtraIds->size() == tokenIds.size(),
+        "Input token extra ids size (%zu) must match the number of input tokens (%zu)",
+        tokenExtraIds ? tokenExtraIds->size() : 0, tokenIds.size());
+
+    VecUniqueTokens tokens;
+    tokens.reserve(tokenIds.size());
+    for (std::size_t i = 0; i < tokenIds.size(); ++i)
+    {
+        tokens.push_back({tokenIds[i], tokenExtraIds ? (*tokenExtraIds)[i] : 0});
+    }
+    auto const loraConfig = request.getLoraConfig();
+    return route(tokens, loraConfig ? loraConfig->getTaskId() : 0);
+}
+
+DataParallelRouter::Dispatch DataParallelRouter::route(VecUniqueTokens const& tokens, LoraTaskIdType loraTaskId)
+{
+    auto const blockHashes = kvc::computeBlockHashes(tokens, mTokensPerBlock, loraTaskId);
+    auto const numRanks = getNumRanks();
+
+    std::vector<float> loads(numRanks);
+    for (SizeType32 rank = 0; rank < numRanks; ++rank)
+    {
+        loads[rank] = getLoad(rank);
+    }
+    auto const maxLoad = *std::min_element(loads.begin(), loads.end()) + mMaxLoadImbalance;
+
+    Dispatch dispatch{-1, 0};
+    auto bestScore = std::numeric_limits<float>::lowest();
+    for (SizeType32 rank = 0; rank < numRanks; ++rank)
+    {
+        if (loads[rank] > maxLoad)
+        {
+            continue;
+        }
+        auto const numMatchedTokens = getNumMatchedBlocks(rank, blockHashes) * mTokensPerBlock;
+        auto const matchFraction
+            = tokens.empty() ? 0.F : static_cast<float>(numMatchedTokens) / static_cast<float>(tokens.size());
+        auto const score = matchFraction - mLoadWeight * loads[rank];
+        // Equal scores go to the less loaded rank, then to the lower rank.
+        if (score > bestScore || (score == bestScore && loads[rank] < loads[dispatch.rank]))
+        {
+            bestScore = score;
+            dispatch = Dispatch{rank, numMatchedTokens};
+        }
+    }
+
+    // The blocks of the prompt are stored on the rank once its context is done, route the next requests sharing the
+    // prompt there before its events arrive.
+    auto& state = mRanks[dispatch.rank];
+    state.storeBlocks(blockHashes.begin(), blockHashes.end());
+    ++state.numPending;
+    return dispatch;
+}
+
+void DataParallelRouter::applyEvents(SizeType32 rank, std::deque<executor::KVCacheEvent> const& events)
+{
+    auto& state = getRank(rank);
+    for (auto const& event : events)
+    {
+        if (auto const* stored = std::get_if<executor::KVCacheStoredData>(&event.data))
+        {
+            std::vector<BlockHashType> blockHashes;
+            blockHashes.reserve(stored->blocks.size());
+            for (auto const& block : stored->blocks)
+            {
+                blockHashes.push_back(block.blockHash);
+            }
+            state.storeBlocks(blockHashes.begin(), blockHashes.end());
+        }
+        else if (auto const* removed = std::get_if<executor::KVCacheRemovedData>(&event.data))
+        {
+            for (auto const blockHash : removed->blockHashes)
+            {
+                state.removeBlock(blockHash);
+            }
+        }
+    }
+}
+
+void DataParallelRouter::updateLoad(SizeType32 rank, RankLoad const& load)
+{
+    auto& state = getRank(rank);
+    state.load = load;
+    state.numPending = 0;
+    state.evictBlocks();
+}
+
+void DataParallelRouter::exchange(
+    mpi::MpiComm const& comm, RankLoad const& localLoad, std::deque<executor::KVCacheEvent> const& events)
+{
+    auto const numRanks = getNumRanks();
+    TLLM_CHECK_WITH_INFO(comm.getSize() == numRanks, "Data-parallel communicator has %d ranks, the router %d",
+        comm.getSize(), numRanks);
+
+    // Flatten the events into (operation, hash) pairs, keeping their order.
+    std::vector<std::uint64_t> localOps;
+    for (auto const& event : events)
+    {
+        if (auto const* stored = std::get_if<executor::KVCacheStoredData>(&event.data))
+        {
+            // Last block first, as storeBlocks touches them
+            for (auto it = stored->blocks.rbegin(); it != stored->blocks.rend(); ++it)
+            {
+                localOps.insert(localOps.end(), {kStored, it->blockHash});
+            }
+        }
+        else if (auto const* removed = std::get_if<executor::KVCacheRemovedData>(&event.data))
+        {
+            for (auto const blockHash : removed->blockHashes)
+            {
+                localOps.insert(localOps.end(), {kRemoved, blockHash});
+            }
+        }
+    }
+
+    std::int64_t const localHeader[kHeaderSize] = {localLoad.numActiveRequests, localLoad.numQueuedRequests,
+        localLoad.maxNumActiveRequests, localLoad.freeNumBlocks, localLoad.maxNumBlocks,
+        static_cast<std::int64_t>(localOps.size() / 2)};
+    std::vector<std::int64_t> headers(static_cast<std::size_t>(numRanks) * kHeaderSize);
+    comm.allgather(localHeader, headers.data(), kHeaderSize, mpi::MpiType::kINT64);
+
+    std::int64_t maxNumOps = 0;
+    for (SizeType32 rank = 0; rank < numRanks; ++rank)
+    {
+        auto const* header = headers.data() + rank * kHeaderSize;
+        updateLoad(rank,
+            RankLoad{static_cast<SizeType32>(header[0]), static_cast<SizeType32>(header[1]),
+                static_cast<SizeType32>(header[2]), static_cast<SizeType32>(header[3]),
+                static_cast<SizeType32>(header[4])});
+        maxNumOps = std::max(maxNumOps, header[5]);
+    }
+    if (maxNumOps == 0)
+    {
+        return;
+    }
+
+    auto const count = static_cast<std::size_t>(maxNumOps) * 2;
+    localOps.resize(count, kPadding);
+    std::vector<std::uint64_t> ops(count * numRanks);
+    comm.allgather(localOps.data(), ops.data(), static_cast<int>(count), mpi::MpiType::kUINT64);
+
+    for (SizeType32 rank = 0; rank < numRanks; ++rank)
+    {
+        auto& state = mRanks[rank];
+        auto const* rankOps = ops.data() + rank * count;
+        for (std::size_t i = 0; i < count; i += 2)
+        {
+            if (rankOps[i] == kStored)
+            {
+                // The blocks of a stored event were flattened last first
+                state.storeBlocks(&rankOps[i + 1], &rankOps[i + 2]);
+            }
+            else if (rankOps[i] == kRemoved)
+            {
+                state.removeBlock(rankOps[i + 1]);
+            }
+        }
+    }
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/batch_manager/blockHash.h"
+#include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Dispatches the requests of a global queue to data-parallel ranks.
+//! \details The leader rank owns the queue and sends every request to the rank with the best combination of resident
+//! prefix and load. The score of a rank is the fraction of prompt tokens in its resident blocks minus loadWeight times
+//! its load, the larger of its request slot usage and its KV cache usage. Ranks loaded more than maxLoadImbalance
+//! above the least loaded rank are not considered, so that a popular prefix does not pile all requests onto one rank.
+//!
+//! The resident blocks of every rank are tracked with the hashes of its KV cache events, the load with its iteration
+//! stats. Both are shared between the ranks with exchange, a collective over the data-parallel communicator, so that
+//! every rank has the same view and any of them can take over as leader. Between two exchanges, routed requests are
+//! counted as pending on their rank and their prompt blocks are assumed to be resident there. Blocks whose removal
+//! was never reported, e.g. those of routed requests that did not run yet, do not pile up: a rank keeps at most
+//! maxNumBlocks of its load resident and forgets the least recently stored or routed ones first.
+class DataParallelRouter
+{
+public:
+    using BlockHashType = batch_manager::kv_cache_manager::BlockHashType;
+
+    struct RankLoad
+    {
+        SizeType32 numActiveRequests{0};
+        SizeType32 numQueuedRequests{0};
+        SizeType32 maxNumActiveRequests{0};
+        SizeType32 freeNumBlocks{0};
+        SizeType32 maxNumBlocks{0};
+    };
+
+    struct Dispatch
+    {
+        SizeType32 rank;
+        //! Prompt tokens in blocks resident on the rank
+        SizeType32 numMatchedTokens;
+    };
+
+    DataParallelRouter(
+        SizeType32 numRanks, SizeType32 tokensPerBlock, float loadWeight = 1.F, float maxLoadImbalance = 0.25F);
+
+    //! \brief The load of a rank from the stats of its executor.
+    [[nodiscard]] static RankLoad getRankLoad(executor::IterationStats const& stats);
+
+    //! \brief Choose the rank to dispatch a request to and account for it on that rank.
+    [[nodiscard]] Dispatch route(executor::Request const& request);
+
+    [[nodiscard]] Dispatch route(VecUniqueTokens const& tokens, LoraTaskIdType loraTaskId);
+
+    //! \brief Update the resident blocks of a rank with its latest KV cache events.
+    void applyEvents(SizeType32 rank, std::deque<executor::KVCacheEvent> const& events);
+
+    //! \brief Update the load of a rank. The requests routed to it since the last update are assumed to be included.
+    void updateLoad(SizeType32 rank, RankLoad const& load);
+
+    //! \brief Share the local load and KV cache events of every rank and apply them.
+    //! \details Collective over comm, whose ranks are the data-parallel ranks.
+    void exchange(
+        mpi::MpiComm const& comm, RankLoad const& localLoad, std::deque<executor::KVCacheEvent> const& events);
+
+    //! \brief The load of a rank, 1 when full, including the requests routed to it since its last update.
+    [[nodiscard]] float getLoad(SizeType32 rank) const;
+
+    [[nodiscard]] SizeType32 getNumMatchedBlocks(SizeType32 rank, std::vector<BlockHashType> const& blockHashes) const;
+
+    [[nodiscard]] SizeType32 getNumRanks() const noexcept
+    {
+        return static_cast<SizeType32>(mRanks.size());
+    }
+
+private:
+    struct RankState
+    {
+        RankLoad load;
+        SizeType32 numPending{0};
+        //! Resident blocks, most recently stored or routed first
+        std::list<BlockHashType> lruBlocks;
+        std::unordered_map<BlockHashType, std::list<BlockHashType>::iterator,
+            batch_manager::kv_cache_manager::BlockHashIdentity>
+            residentBlocks;
+
+        //! \brief Mark the blocks of a sequence as resident. The first blocks are shared by more sequences and are
+        //! kept the longest.
+        template <typename It>
+        void storeBlocks(It begin, It end);
+        void removeBlock(BlockHashType blockHash);
+        void evictBlocks();
+    };
+
+    [[nodiscard]] RankState& getRank(SizeType32 rank);
+    [[nodiscard]] RankState const& getRank(SizeType32 rank) const;
+
+    SizeType32 mTokensPerBlock;
+    float mLoadWeight;
+    float mMaxLoadImbalance;
+    std::vector<RankState> mRanks;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/decoderStatusBlock.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/runtimeKernels.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+std::uint64_t loadEpoch(std::uint64_t const& epoch)
+{
+    return *reinterpret_cast<std::uint64_t const volatile*>(&epoch);
+}
+} // namespace
+
+DecoderStatusBlock::DecoderStatusBlock(SizeType32 maxBatchSize, SizeType32 maxBeamWidth, IBuffer::SharedPtr block)
+    : mMaxBatchSize{maxBatchSize}
+    , mMaxBeamWidth{maxBeamWidth}
+    , mBlock{std::move(block)}
+    , mFinishedSum(maxBatchSize, 0)
+    , mSequenceLengths(maxBatchSize, 0)
+    , mStartEpochs(maxBatchSize, 0)
+    , mReadFinishedSum(maxBatchSize, 0)
+    , mReadSequenceLengths(maxBatchSize, 0)
+{
+    TLLM_CHECK_WITH_INFO(maxBatchSize > 0 && maxBeamWidth > 0, "The status block needs a batch and a beam");
+    TLLM_CHECK_WITH_INFO(mBlock && mBlock->getSizeInBytes() >= getBlockSize(maxBatchSize),
+        "The status block needs %zu bytes", getBlockSize(maxBatchSize));
+    std::memset(mBlock->data(), 0, getBlockSize(maxBatchSize));
+}
+
+DecoderStatusBlock::DecoderStatusBlock(SizeType32 maxBatchSize, SizeType32 maxBeamWidth)
+    : DecoderStatusBlock(maxBatchSize, maxBeamWidth, BufferManager::pinned(getBlockSize(maxBatchSize)))
+{
+}
+
+std::size_t DecoderStatusBlock::getSlotSize(SizeType32 maxBatchSize)
+{
+    auto const dataSize = 2 * static_cast<std::size_t>(maxBatchSize) * sizeof(SizeType32);
+    // Keep the header of the second slot aligned
+    auto const alignment = alignof(kernels::DecoderStatusHeader);
+    return sizeof(kernels::DecoderStatusHeader) + (dataSize + alignment - 1) / alignment * alignment;
+}
+
+std::uint8_t* DecoderStatusBlock::getSlot(SizeType32 idx) const
+{
+    return static_cast<std::uint8_t*>(mBlock->data()) + idx * getSlotSize(mMaxBatchSize);
+}
+
+std::uint64_t DecoderStatusBlock::enqueueWrite(
+    ITensor const& finishedSum, ITensor const& sequenceLengths, CudaStream const& stream)
+{
+    TLLM_CHECK(finishedSum.getSize() >= static_cast<std::size_t>(mMaxBatchSize));
+    TLLM_CHECK(sequenceLengths.getSize() >= static_cast<std::size_t>(mMaxBatchSize) * mMaxBeamWidth);
+    auto const epoch = ++mIssuedEpoch;
+    auto* slot = reinterpret_cast<kernels::DecoderStatusHeader*>(getSlot(static_cast<SizeType32>(epoch % kNumSlots)));
+    kernels::invokeWriteDecoderStatus(slot, epoch, bufferCast<SizeType32>(finishedSum),
+        bufferCast<SizeType32>(sequenceLengths), mMaxBatchSize, mMaxBeamWidth, stream);
+    return epoch;
+}
+
+bool DecoderStatusBlock::poll()
+{
+    bool updated{false};
+    for (SizeType32 idx = 0; idx < kNumSlots; ++idx)
+    {
+        auto const* slot = getSlot(idx);
+        auto const& header = *reinterpret_cast<kernels::DecoderStatusHeader const*>(slot);
+        auto const endEpoch = loadEpoch(header.endEpoch);
+        if (endEpoch <= mPolledEpoch)
+        {
+            continue;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto const* finishedSum = reinterpret_cast<SizeType32 const*>(slot + sizeof(kernels::DecoderStatusHeader));
+        auto const numBytes = static_cast<std::size_t>(mMaxBatchSize) * sizeof(SizeType32);
+        std::memcpy(mReadFinishedSum.data(), finishedSum, numBytes);
+        std::memcpy(mReadSequenceLengths.data(), finishedSum + mMaxBatchSize, numBytes);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // A newer write started while reading, the next poll picks it up
+        if (loadEpoch(header.beginEpoch) != endEpoch)
+        {
+            continue;
+        }
+        mFinishedSum.swap(mReadFinishedSum);
+        mSequenceLengths.swap(mReadSequenceLengths);
+        mPolledEpoch = endEpoch;
+        updated = true;
+    }
+    return updated;
+}
+
+void DecoderStatusBlock::waitFor(std::uint64_t epoch)
+{
+    TLLM_CHECK_WITH_INFO(epoch <= mIssuedEpoch, "Epoch %lu has not been enqueued, the last one is %lu", epoch,
+        mIssuedEpoch);
+    while (mPolledEpoch < epoch)
+    {
+        if (!poll())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+} // namespace tensorrt_llm::runtime
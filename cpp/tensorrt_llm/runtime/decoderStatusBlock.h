@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Finished sums and sequence lengths of the decoder slots, written by the device into pinned host memory and
+//! read by the host without synchronizing the stream.
+//! \details Every decoding step enqueues a snapshot, numbered by an epoch, behind the stop criteria. The block holds
+//! two snapshot slots used in turn, each bracketed by a begin and an end epoch like a seqlock, so the host can poll the
+//! newest complete snapshot while the device writes the next one. A snapshot the host reads is usually the one of the
+//! previous step, completions are learned one step late instead of waiting for the current step.
+//!
+//! Layout of a slot: kernels::DecoderStatusHeader, then the finished sums and the sequence lengths of the first beam,
+//! maxBatchSize SizeType32 each.
+class DecoderStatusBlock
+{
+public:
+    //! \param block Memory of getBlockSize bytes the device can write and the host can read, e.g. pinned memory.
+    DecoderStatusBlock(SizeType32 maxBatchSize, SizeType32 maxBeamWidth, IBuffer::SharedPtr block);
+
+    //! \brief A block in pinned host memory.
+    DecoderStatusBlock(SizeType32 maxBatchSize, SizeType32 maxBeamWidth);
+
+    [[nodiscard]] static std::size_t getSlotSize(SizeType32 maxBatchSize);
+
+    [[nodiscard]] static std::size_t getBlockSize(SizeType32 maxBatchSize)
+    {
+        return kNumSlots * getSlotSize(maxBatchSize);
+    }
+
+    //! \brief Enqueue a snapshot on stream.
+    //! \param finishedSum [maxBatchSize], number of finished beams per slot, on gpu.
+    //! \param sequenceLengths [maxBatchSize, maxBeamWidth], on gpu.
+    //! \return The epoch of the snapshot.
+    std::uint64_t enqueueWrite(ITensor const& finishedSum, ITensor const& sequenceLengths, CudaStream const& stream);
+
+    //! \brief Read the newest complete snapshot if it is newer than the last one read. Never blocks.
+    //! \return Whether a newer snapshot was read.
+    bool poll();
+
+    //! \brief Poll until the snapshot of epoch, or a newer one, has been read.
+    void waitFor(std::uint64_t epoch);
+
+    //! \brief Epoch of the last enqueued snapshot, 0 before the first one.
+    [[nodiscard]] std::uint64_t getIssuedEpoch() const noexcept
+    {
+        return mIssuedEpoch;
+    }
+
+    //! \brief Epoch of the last snapshot read, 0 before the first one.
+    [[nodiscard]] std::uint64_t getPolledEpoch() const noexcept
+    {
+        return mPolledEpoch;
+    }
+
+    //! \brief Number of finished beams of slot in the last snapshot read.
+    [[nodiscard]] SizeType32 getFinishedSum(SizeType32 slot) const
+    {
+        return mFinishedSum.at(slot);
+    }
+
+    //! \brief Sequence length of the first beam of slot in the last snapshot read.
+    [[nodiscard]] SizeType32 getSequenceLength(SizeType32 slot) const
+    {
+        return mSequenceLengths.at(slot);
+    }
+
+    //! \brief Start a new request in slot. The snapshots enqueued so far belong to the previous request of the slot.
+    void startRequest(SizeType32 slot)
+    {
+        mStartEpochs.at(slot) = mIssuedEpoch;
+    }
+
+    //! \brief Whether the last snapshot read was enqueued after the request in slot was started.
+    [[nodiscard]] bool isCurrent(SizeType32 slot) const
+    {
+        return mPolledEpoch > mStartEpochs.at(slot);
+    }
+
+private:
+    static SizeType32 constexpr kNumSlots = 2;
+
+    [[nodiscard]] std::uint8_t* getSlot(SizeType32 idx) const;
+
+    SizeType32 const mMaxBatchSize;
+    SizeType32 const mMaxBeamWidth;
+    IBuffer::SharedPtr mBlock;
+
+    std::uint64_t mIssuedEpoch{0};
+    std::uint64_t mPolledEpoch{0};
+    std::vector<SizeType32> mFinishedSum;
+    std::vector<SizeType32> mSequenceLengths;
+    // [maxBatchSize], issued epoch when the request in the slot was started
+    std::vector<std::uint64_t> mStartEpochs;
+    // Staging for a slot being read, kept when the slot turns out to be overwritten meanwhile
+    std::vector<SizeType32> mReadFinishedSum;
+    std::vector<SizeType32> mReadSequenceLengths;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -28,8 +28,8 @@ tensorrt_llm::runtime::DecodingLayerWorkspace::DecodingLayerWorkspace(std::share
           mBufferManager->gpu(ITensor::makeShape({decoderDomain.getBatchSize(), decoderDomain.getMaxDecodingTokens(),
                                   decoderDomain.getBeamWidth(), decoderDomain.getVocabSizePadded()}),
               logitsType))
-    , mCurandStatesDevice(
-          mBufferManager->gpu(ITensor::makeShape({decoderDomain.getBatchSize(), sizeof(curandState_t)})))
+    , mRandomStatesDevice(mBufferManager->gpu(
+          ITensor::makeShape({decoderDomain.getBatchSize(), sizeof(tensorrt_llm::kernels::RandomState)})))
     , mWorkspaceDeviceBuffer(mBufferManager->gpu(workspaceBufferSizeInBytes))
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
@@ -89,10 +89,11 @@ tensorrt_llm::runtime::DecodingLayerWorkspace::getWorkspaceAsDeviceTensor(ITenso
         shape, type, BorrowingAllocator<MemoryType::kGPU>{mWorkspaceDeviceBuffer->data(), sizeInBytes});
 }
 
-void tensorrt_llm::runtime::DecodingLayerWorkspace::initializeDeviceCurandStates(
+void tensorrt_llm::runtime::DecodingLayerWorkspace::initializeDeviceRandomStates(
     std::optional<std::vector<uint64_t>> const& randomSeed, tensorrt_llm::runtime::SizeType32 batchSize,
     tensorrt_llm::runtime::DecodingLayerWorkspace::TensorConstPtr const& batchSlots,
-    tensorrt_llm::runtime::DecodingLayerWorkspace::TensorPtr& statesDevice)
+    tensorrt_llm::runtime::DecodingLayerWorkspace::TensorPtr& statesDevice,
+    std::optional<std::vector<uint64_t>> const& randomStep)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
     // If runtime argument has single random seed, using this random seed to
@@ -101,13 +102,36 @@ void tensorrt_llm::runtime::DecodingLayerWorkspace::initializeDeviceCurandStates
     // random seeds respectively. If no random seed, initialize the random table
     // of all sentences by 0 directly.
     auto const* batchSlotsPtr = tensorrt_llm::runtime::bufferCast<tensorrt_llm::runtime::SizeType32>(*batchSlots);
-    auto* curandStateDevicePtr = reinterpret_cast<curandState_t*>(statesDevice->data());
-    if (randomSeed)
+    auto* randomStateDevicePtr = reinterpret_cast<tensorrt_llm::kernels::RandomState*>(statesDevice->data());
+    if (randomStep)
+    {
+        // Resuming states need a seed and a step per request
+        auto const expand = [batchSize](std::optional<std::vector<uint64_t>> const& values, char const* name)
+        {
+            if (!values)
+            {
+                return std::vector<uint64_t>(batchSize, 0);
+            }
+            TLLM_CHECK_WITH_INFO(
+                values->size() == 1 || static_cast<tensorrt_llm::runtime::SizeType32>(values->size()) == batchSize,
+                "%s vector size mismatch.", name);
+            return values->size() == 1 ? std::vector<uint64_t>(batchSize, values->front()) : *values;
+        };
+        // Seeds, then steps, as copies to the workspace all start at its beginning
+        auto seedsAndSteps = expand(randomSeed, "Random seed");
+        auto const steps = expand(randomStep, "Random step");
+        seedsAndSteps.insert(seedsAndSteps.end(), steps.begin(), steps.end());
+        auto seedsAndStepsDevice = copyToWorkspace(seedsAndSteps);
+        auto const* randomSeedsDevicePtr = tensorrt_llm::runtime::bufferCast<uint64_t>(*seedsAndStepsDevice);
+        tensorrt_llm::kernels::invokeRandomStateBatchInitialize(randomStateDevicePtr, batchSlotsPtr, batchSize,
+            randomSeedsDevicePtr, getStream(), randomSeedsDevicePtr + batchSize);
+    }
+    else if (randomSeed)
     {
         if (randomSeed->size() == 1)
         {
-            tensorrt_llm::kernels::invokeCurandInitialize(
-                curandStateDevicePtr, batchSlotsPtr, batchSize, randomSeed->front(), getStream());
+            tensorrt_llm::kernels::invokeRandomStateInitialize(
+                randomStateDevicePtr, batchSlotsPtr, batchSize, randomSeed->front(), getStream());
         }
         else
         {
@@ -115,14 +139,15 @@ void tensorrt_llm::runtime::DecodingLayerWorkspace::initializeDeviceCurandStates
                 "Random seed vector size mismatch.");
             auto randomSeedsDevice = copyToWorkspace(randomSeed.value());
             auto const* randomSeedsDevicePtr = tensorrt_llm::runtime::bufferCast<uint64_t>(*randomSeedsDevice);
-            tensorrt_llm::kernels::invokeCurandBatchInitialize(
-                curandStateDevicePtr, batchSlotsPtr, batchSize, randomSeedsDevicePtr, getStream());
+            tensorrt_llm::kernels::invokeRandomStateBatchInitialize(
+                randomStateDevicePtr, batchSlotsPtr, batchSize, randomSeedsDevicePtr, getStream());
         }
     }
     else
     {
-        // Initialize curand states using the default seed 0.
-        tensorrt_llm::kernels::invokeCurandInitialize(curandStateDevicePtr, batchSlotsPtr, batchSize, 0, getStream());
+        // Initialize random states using the default seed 0.
+        tensorrt_llm::kernels::invokeRandomStateInitialize(
+            randomStateDevicePtr, batchSlotsPtr, batchSize, 0, getStream());
     }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -150,16 +150,18 @@ public:
         return res;
     }
 
-    /// @brief A convenience function to initialize curand states from a provided seed.
-    void initializeDeviceCurandStates(std::optional<std::vector<uint64_t>> const& randomSeed,
-        runtime::SizeType32 batchSize, TensorConstPtr const& batchSlots, TensorPtr& statesDevice);
+    /// @brief A convenience function to initialize random states from a provided seed.
+    /// @param randomStep The steps the states start at, 0 if not set. Set for requests that resume generating.
+    void initializeDeviceRandomStates(std::optional<std::vector<uint64_t>> const& randomSeed,
+        runtime::SizeType32 batchSize, TensorConstPtr const& batchSlots, TensorPtr& statesDevice,
+        std::optional<std::vector<uint64_t>> const& randomStep = std::nullopt);
 
 private:
     std::shared_ptr<BufferManager> mBufferManager;
     TensorPtr mBatchSlotsDevice;    // <! A copy of the batch slots on device ensure fast access when used in kernels.
     TensorPtr mRuntimeLogitsDevice; // <! The working state of the logits while decoding.
     TensorPtr
-        mCurandStatesDevice; // <! The state information of the random number generators for sampling based decoding.
+        mRandomStatesDevice; // <! The state information of the random number generators for sampling based decoding.
     BufferPtr mWorkspaceDeviceBuffer; // <! A buffer to be used as scratch space by the decoding layers.
 
     cudaStream_t getStream();
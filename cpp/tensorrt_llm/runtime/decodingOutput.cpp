@@ -34,6 +34,9 @@ void DecodingOutput::BeamHypotheses::empty(BufferManager& manager)
     numBeamsCBA = manager.emptyTensor(MemoryType::kGPU, nvSizeType);
     minNormedScoresCBA = manager.emptyTensor(MemoryType::kGPU, nvFloatType);
     batchDones = manager.emptyTensor(MemoryType::kGPU, nvBoolType);
+    pathIds = manager.emptyTensor(MemoryType::kGPU, nvTokenIdType);
+    pathBeams = manager.emptyTensor(MemoryType::kGPU, nvSizeType);
+    pathLengths = manager.emptyTensor(MemoryType::kGPU, nvSizeType);
 }
 
 void DecodingOutput::BeamHypotheses::reshape(SizeType32 batchSize, SizeType32 beamWidth, SizeType32 maxSequenceLength)
@@ -46,6 +49,9 @@ void DecodingOutput::BeamHypotheses::reshape(SizeType32 batchSize, SizeType32 be
     numBeamsCBA->reshape(ITensor::makeShape({batchSize}));
     minNormedScoresCBA->reshape(ITensor::makeShape({batchSize}));
     batchDones->reshape(ITensor::makeShape({batchSize}));
+    pathIds->reshape(ITensor::makeShape({batchSize, beamWidth, maxSequenceLength}));
+    pathBeams->reshape(ITensor::makeShape({batchSize, beamWidth, maxSequenceLength}));
+    pathLengths->reshape(ITensor::makeShape({batchSize, beamWidth}));
 }
 
 void DecodingOutput::BeamHypotheses::init(BufferManager& manager, TokenIdType endId)
@@ -58,6 +64,8 @@ void DecodingOutput::BeamHypotheses::init(BufferManager& manager, TokenIdType en
     manager.setZero(*numBeamsCBA);
     manager.setZero(*minNormedScoresCBA);
     manager.setZero(*batchDones);
+    // The paths are rebuilt from scratch at the next update
+    manager.setZero(*pathLengths);
 }
 
 DecodingOutput::BeamHypotheses DecodingOutput::BeamHypotheses::slice(SizeType32 batchIndex, SizeType32 size) const
@@ -71,5 +79,8 @@ DecodingOutput::BeamHypotheses DecodingOutput::BeamHypotheses::slice(SizeType32
     bh.numBeamsCBA = ITensor::slice(numBeamsCBA, batchIndex, size);
     bh.minNormedScoresCBA = ITensor::slice(minNormedScoresCBA, batchIndex, size);
     bh.batchDones = ITensor::slice(batchDones, batchIndex, size);
+    bh.pathIds = ITensor::slice(pathIds, batchIndex, size);
+    bh.pathBeams = ITensor::slice(pathBeams, batchIndex, size);
+    bh.pathLengths = ITensor::slice(pathLengths, batchIndex, size);
     return bh;
 }
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/draftTargetSequence.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+void DraftTargetSequence::onDrafted(SizeType32 numDraftTokens)
+{
+    TLLM_CHECK_WITH_INFO(numDraftTokens >= 0, "Negative number of draft tokens %d", numDraftTokens);
+    mNumDraftTokens = numDraftTokens;
+    if (numDraftTokens > 0)
+    {
+        // The first draft step consumed them
+        mNumPendingDraftInputs = 0;
+    }
+}
+
+DraftTargetRewind DraftTargetSequence::onVerified(SizeType32 numAcceptedTokens)
+{
+    TLLM_CHECK_WITH_INFO(numAcceptedTokens >= 0 && numAcceptedTokens <= mNumDraftTokens,
+        "%d accepted tokens out of %d draft tokens", numAcceptedTokens, mNumDraftTokens);
+    DraftTargetRewind rewind;
+    rewind.numTargetTokens = mNumDraftTokens - numAcceptedTokens;
+    rewind.numDraftTokens = std::max(mNumDraftTokens - 1 - numAcceptedTokens, 0);
+
+    if (mNumDraftTokens == 0)
+    {
+        mNumPendingDraftInputs += 1;
+    }
+    else
+    {
+        // The last draft never went through the draft model
+        mNumPendingDraftInputs = numAcceptedTokens == mNumDraftTokens ? 2 : 1;
+    }
+    mNumDraftTokens = 0;
+    return rewind;
+}
+
+std::vector<std::vector<SizeType32>> planDraftSteps(std::vector<SizeType32> const& draftLens)
+{
+    auto const maxDraftLen = draftLens.empty() ? 0 : *std::max_element(draftLens.begin(), draftLens.end());
+    std::vector<std::vector<SizeType32>> steps(std::max(maxDraftLen, 0));
+    for (SizeType32 step = 0; step < maxDraftLen; ++step)
+    {
+        for (SizeType32 idx = 0; idx < static_cast<SizeType32>(draftLens.size()); ++idx)
+        {
+            if (draftLens[idx] > step)
+            {
+                steps[step].push_back(idx);
+            }
+        }
+    }
+    return steps;
+}
+
+SizeType32 getDraftLen(SizeType32 maxDraftLen, SizeType32 numRemainingTokens) noexcept
+{
+    return std::max(std::min(maxDraftLen, numRemainingTokens - 1), 0);
+}
+
+} // namespace tensorrt_llm::runtime
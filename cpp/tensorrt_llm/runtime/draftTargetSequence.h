@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief How far to rewind the KV caches of both models after the target verified the drafts of a request.
+struct DraftTargetRewind
+{
+    //! Target KV cache tokens written for rejected draft tokens
+    SizeType32 numTargetTokens{0};
+    //! Draft KV cache tokens written for rejected draft tokens
+    SizeType32 numDraftTokens{0};
+};
+
+//! \brief Tracks where the draft model of one request stands relative to the target in draft-target speculation.
+//! \details A draft loop of n steps feeds the draft model its pending inputs in the first step and the drafts 1 to
+//! n - 1 in the following ones, so draft n never reaches the draft KV cache. The target verifies the last accepted
+//! token and the n drafts in one step, accepts a of the drafts and samples one more token.
+//! - The target rewinds the n - a rejected drafts.
+//! - The draft model rewinds the rejected drafts among the n - 1 it has seen.
+//! - The next draft loop starts from the target token, preceded by draft n when all drafts were accepted.
+//!
+//! Requests without drafts this step keep accumulating pending inputs for the draft model.
+class DraftTargetSequence
+{
+public:
+    //! \brief A request whose context the draft model has processed, with the first target token pending.
+    DraftTargetSequence() = default;
+
+    //! @returns number of tokens the first draft step of the request feeds to the draft model
+    [[nodiscard]] SizeType32 getNumPendingDraftInputs() const noexcept
+    {
+        return mNumPendingDraftInputs;
+    }
+
+    //! \brief Record that the draft loop proposed numDraftTokens tokens, possibly none.
+    void onDrafted(SizeType32 numDraftTokens);
+
+    //! \brief Record that the target accepted numAcceptedTokens of the drafts and sampled a token after them.
+    //! @returns the KV cache tokens to rewind in both models
+    [[nodiscard]] DraftTargetRewind onVerified(SizeType32 numAcceptedTokens);
+
+private:
+    SizeType32 mNumPendingDraftInputs{1};
+    SizeType32 mNumDraftTokens{0};
+};
+
+//! \brief Batches of the draft loop: step i runs the draft model over the requests with more than i draft tokens.
+//! @param draftLens draft length of every request of the generation batch
+//! @returns for every draft step, the indices into draftLens of the requests it runs, in increasing order
+[[nodiscard]] std::vector<std::vector<SizeType32>> planDraftSteps(std::vector<SizeType32> const& draftLens);
+
+//! \brief Draft length of a request given the configured maximum and the tokens it may still generate. The target
+//! samples one token after the drafts, so a request with r tokens left drafts at most r - 1.
+[[nodiscard]] SizeType32 getDraftLen(SizeType32 maxDraftLen, SizeType32 numRemainingTokens) noexcept;
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/dualMicroBatchSplitter.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace tensorrt_llm::runtime
+{
+
+DualMicroBatchSplitter::DualMicroBatchSplitter(Config const& config)
+    : mConfig{config}
+{
+    TLLM_CHECK_WITH_INFO(mConfig.minTokens > 0, "The micro batches need at least one token, got %d", mConfig.minTokens);
+    TLLM_CHECK_WITH_INFO(mConfig.minBalance >= 0.f && mConfig.minBalance <= 1.f, "Invalid balance %f",
+        mConfig.minBalance);
+}
+
+std::optional<DualMicroBatchSplitter::Split> DualMicroBatchSplitter::split(
+    std::vector<SizeType32> const& numTokens) const
+{
+    auto const totalTokens = std::accumulate(numTokens.begin(), numTokens.end(), SizeType32{0});
+    if (numTokens.size() < 2 || totalTokens < 2 * mConfig.minTokens)
+    {
+        return std::nullopt;
+    }
+
+    // Largest requests first, each into the micro batch with fewer tokens
+    std::vector<SizeType32> order(numTokens.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+        [&numTokens](SizeType32 lhs, SizeType32 rhs) { return numTokens[lhs] > numTokens[rhs]; });
+    Split split;
+    for (auto const request : order)
+    {
+        auto const microBatch = split.numTokens[0] <= split.numTokens[1] ? 0 : 1;
+        split.requests[microBatch].push_back(request);
+        split.numTokens[microBatch] += numTokens[request];
+    }
+
+    auto const [smaller, larger] = std::minmax(split.numTokens[0], split.numTokens[1]);
+    if (smaller < mConfig.minTokens || static_cast<float>(smaller) < mConfig.minBalance * static_cast<float>(larger))
+    {
+        return std::nullopt;
+    }
+    for (auto& requests : split.requests)
+    {
+        std::sort(requests.begin(), requests.end());
+    }
+    // The micro batch with the first request runs first
+    if (split.requests[0].front() > split.requests[1].front())
+    {
+        std::swap(split.requests[0], split.requests[1]);
+        std::swap(split.numTokens[0], split.numTokens[1]);
+    }
+    return split;
+}
+
+} // namespace tensorrt_llm::runtime
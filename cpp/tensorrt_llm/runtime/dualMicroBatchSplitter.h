@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Splits the scheduled batch of a tensor parallel step into two micro batches of about equal tokens.
+//! \details The micro batches run on two streams, see TllmRuntime::executeContexts, so the all-reduces of one overlap
+//! the GEMMs and attention of the other instead of leaving the GPU idle. Every micro batch reads all the weights, so
+//! small batches, whose steps are bound by the weight reads, run in one pass. So do batches that cannot be balanced,
+//! e.g. one long context, as the longer micro batch would leave nothing to overlap its tail with.
+class DualMicroBatchSplitter
+{
+public:
+    struct Config
+    {
+        //! Tokens each micro batch needs at least
+        SizeType32 minTokens{256};
+        //! Tokens of the smaller micro batch relative to the larger one below which the batch runs in one pass
+        float minBalance{0.5f};
+    };
+
+    struct Split
+    {
+        //! Indices of the requests of every micro batch, in the order of the batch, so context requests stay in front
+        //! of generation requests
+        std::vector<SizeType32> requests[2];
+        SizeType32 numTokens[2]{0, 0};
+    };
+
+    explicit DualMicroBatchSplitter(Config const& config);
+
+    DualMicroBatchSplitter()
+        : DualMicroBatchSplitter(Config{})
+    {
+    }
+
+    //! \param numTokens Tokens every scheduled request runs in the step: its context chunk, or its beams in generation
+    //! \return std::nullopt if the batch runs in one pass
+    [[nodiscard]] std::optional<Split> split(std::vector<SizeType32> const& numTokens) const;
+
+    [[nodiscard]] Config const& getConfig() const noexcept
+    {
+        return mConfig;
+    }
+
+private:
+    Config mConfig;
+};
+
+} // namespace tensorrt_llm::runtime
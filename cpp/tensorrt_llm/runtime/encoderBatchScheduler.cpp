@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/encoderBatchScheduler.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+EncoderBatchScheduler::EncoderBatchScheduler(Config const& config)
+    : mConfig{config}
+{
+    TLLM_CHECK_WITH_INFO(mConfig.maxBatchSize > 0 && mConfig.maxNumTokens > 0,
+        "The encoder batch scheduler needs a positive batch size and number of tokens");
+}
+
+void EncoderBatchScheduler::enqueue(RequestIdType requestId, SizeType32 inputLength)
+{
+    TLLM_CHECK_WITH_INFO(inputLength > 0 && inputLength <= mConfig.maxNumTokens,
+        "Request %lu has %d input tokens, expected between 1 and max_num_tokens (%d)", requestId, inputLength,
+        mConfig.maxNumTokens);
+    mQueue.push_back(QueuedRequest{requestId, inputLength});
+}
+
+EncoderBatchScheduler::Batch EncoderBatchScheduler::scheduleBatch()
+{
+    TLLM_NVTX_SCOPED_RANGE(kSCHEDULER, scheduleBatch);
+    Batch batch;
+    for (auto it = mQueue.begin(); it != mQueue.end() && batch.getBatchSize() < mConfig.maxBatchSize;)
+    {
+        if (batch.numTokens + it->inputLength > mConfig.maxNumTokens)
+        {
+            if (!mConfig.firstFit)
+            {
+                break;
+            }
+            ++it;
+            continue;
+        }
+        batch.requestIds.push_back(it->requestId);
+        batch.inputLengths.push_back(it->inputLength);
+        batch.numTokens += it->inputLength;
+        batch.maxInputLength = std::max(batch.maxInputLength, it->inputLength);
+        it = mQueue.erase(it);
+    }
+    return batch;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Forms batches of encoder-only requests (BERT style embedding or reranking) by total number of tokens.
+//! \details With packed inputs (remove_input_padding) the cost of a batch grows with its number of valid tokens
+//! rather than with batchSize * maxInputLength, so requests are admitted until maxNumTokens is reached instead of
+//! until a fixed number of requests. The oldest request always starts a batch; later requests that do not fit are
+//! skipped for smaller ones behind them when firstFit is set, so skewed lengths don't leave the token budget unused.
+class EncoderBatchScheduler
+{
+public:
+    using RequestIdType = std::uint64_t;
+
+    struct Config
+    {
+        SizeType32 maxBatchSize{256};
+        SizeType32 maxNumTokens{8192};
+        bool firstFit{true};
+    };
+
+    struct Batch
+    {
+        std::vector<RequestIdType> requestIds;
+        std::vector<SizeType32> inputLengths;
+        SizeType32 numTokens{0};
+        SizeType32 maxInputLength{0};
+
+        [[nodiscard]] SizeType32 getBatchSize() const noexcept
+        {
+            return static_cast<SizeType32>(requestIds.size());
+        }
+    };
+
+    explicit EncoderBatchScheduler(Config const& config);
+
+    //! \brief Queue a request. Its input must fit in maxNumTokens on its own.
+    void enqueue(RequestIdType requestId, SizeType32 inputLength);
+
+    //! \brief Take the next batch out of the queue, empty if nothing is queued.
+    [[nodiscard]] Batch scheduleBatch();
+
+    [[nodiscard]] SizeType32 getNumQueuedRequests() const noexcept
+    {
+        return static_cast<SizeType32>(mQueue.size());
+    }
+
+    [[nodiscard]] Config const& getConfig() const noexcept
+    {
+        return mConfig;
+    }
+
+private:
+    struct QueuedRequest
+    {
+        RequestIdType requestId;
+        SizeType32 inputLength;
+    };
+
+    Config mConfig;
+    std::deque<QueuedRequest> mQueue;
+};
+
+} // namespace tensorrt_llm::runtime
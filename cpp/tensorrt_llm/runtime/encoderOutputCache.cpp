@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/encoderOutputCache.h"
+#include "tensorrt_llm/common/assert.h"
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+void hashCombine(std::size_t& seed, std::uint64_t value) noexcept
+{
+    value = (value ^ (value >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    value = (value ^ (value >> 27)) * UINT64_C(0x94d049bb133111eb);
+    value ^= value >> 31;
+    seed ^= static_cast<std::size_t>(value) + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2);
+}
+
+} // namespace
+
+EncoderOutputCache::EncoderOutputCache(SizeType32 maxNumBlocks)
+    : mMaxNumBlocks{maxNumBlocks}
+{
+    TLLM_CHECK_WITH_INFO(mMaxNumBlocks >= 0, "The encoder output cache needs a non-negative number of blocks");
+}
+
+std::size_t EncoderOutputCache::hashInput(
+    VecUniqueTokens const& inputTokens, std::optional<LoraTaskIdType> loraTaskId) noexcept
+{
+    std::size_t seed = inputTokens.size();
+    hashCombine(seed, loraTaskId.has_value() ? loraTaskId.value() + 1 : 0);
+    for (auto const& token : inputTokens)
+    {
+        hashCombine(seed, static_cast<std::uint32_t>(token.tokenId));
+        hashCombine(seed, token.tokenExtraId);
+    }
+    return seed;
+}
+
+EncoderOutputCache::NodeList::iterator EncoderOutputCache::find(
+    std::size_t hash, VecUniqueTokens const& inputTokens, std::optional<LoraTaskIdType> loraTaskId)
+{
+    auto const [begin, end] = mIndex.equal_range(hash);
+    for (auto it = begin; it != end; ++it)
+    {
+        // Compare the contents, hash collisions must not share outputs.
+        auto const& node = *it->second;
+        if (node.loraTaskId == loraTaskId && node.inputTokens == inputTokens)
+        {
+            return it->second;
+        }
+    }
+    return mNodes.end();
+}
+
+void EncoderOutputCache::touch(NodeList::iterator it)
+{
+    mNodes.splice(mNodes.end(), mNodes, it);
+}
+
+std::optional<EncoderOutputCache::Entry> EncoderOutputCache::acquire(
+    VecUniqueTokens const& inputTokens, std::optional<LoraTaskIdType> loraTaskId)
+{
+    auto it = find(hashInput(inputTokens, loraTaskId), inputTokens, loraTaskId);
+    if (it == mNodes.end())
+    {
+        ++mStats.numMisses;
+        return std::nullopt;
+    }
+    ++mStats.numHits;
+    ++it->refCount;
+    touch(it);
+    return it->entry;
+}
+
+bool EncoderOutputCache::insert(VecUniqueTokens const& inputTokens, std::optional<LoraTaskIdType> loraTaskId,
+    TensorPtr encoderOutput, std::vector<BlockIdType> crossKvBlockIds)
+{
+    auto const hash = hashInput(inputTokens, loraTaskId);
+    if (find(hash, inputTokens, loraTaskId) != mNodes.end())
+    {
+        return false;
+    }
+    auto const numBlocks = static_cast<SizeType32>(crossKvBlockIds.size());
+    mNodes.push_back(Node{inputTokens, loraTaskId, Entry{std::move(encoderOutput), std::move(crossKvBlockIds)}, 1});
+    mIndex.emplace(hash, std::prev(mNodes.end()));
+    ++mStats.numEntries;
+    mStats.numBlocks += numBlocks;
+    return true;
+}
+
+void EncoderOutputCache::release(VecUniqueTokens const& inputTokens, std::optional<LoraTaskIdType> loraTaskId)
+{
+    auto it = find(hashInput(inputTokens, loraTaskId), inputTokens, loraTaskId);
+    TLLM_CHECK_WITH_INFO(it != mNodes.end(), "Releasing an encoder output that is not cached");
+    TLLM_CHECK_WITH_INFO(it->refCount > 0, "Releasing an encoder output that is not referenced");
+    --it->refCount;
+}
+
+std::vector<EncoderOutputCache::BlockIdType> EncoderOutputCache::evict(SizeType32 numBlocks)
+{
+    std::vector<BlockIdType> freedBlocks;
+    for (auto it = mNodes.begin(); it != mNodes.end() && static_cast<SizeType32>(freedBlocks.size()) < numBlocks;)
+    {
+        if (it->refCount > 0)
+        {
+            ++it;
+            continue;
+        }
+        auto const [begin, end] = mIndex.equal_range(hashInput(it->inputTokens, it->loraTaskId));
+        for (auto indexIt = begin; indexIt != end; ++indexIt)
+        {
+            if (indexIt->second == it)
+            {
+                mIndex.erase(indexIt);
+                break;
+            }
+        }
+        auto const& blockIds = it->entry.crossKvBlockIds;
+        freedBlocks.insert(freedBlocks.end(), blockIds.begin(), blockIds.end());
+        --mStats.numEntries;
+        mStats.numBlocks -= static_cast<SizeType32>(blockIds.size());
+        ++mStats.numEvictedEntries;
+        it = mNodes.erase(it);
+    }
+    return freedBlocks;
+}
+
+std::vector<EncoderOutputCache::BlockIdType> EncoderOutputCache::trim()
+{
+    return evict(mStats.numBlocks - mMaxNumBlocks);
+}
+
+} // namespace tensorrt_llm::runtime
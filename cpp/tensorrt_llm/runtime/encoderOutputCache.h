@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Content addressed cache of encoder outputs and the cross attention KV blocks computed from them.
+//! \details Entries are keyed by the encoder input tokens (including extra ids of prompt tuning tokens) and the LoRA
+//! task, the same way self attention blocks are reused. A request whose encoder input is cached skips the encoder
+//! and attaches the cached cross KV blocks read-only, since cross attention never appends to them. Every request
+//! using an entry holds a reference; unreferenced entries stay cached until they are evicted in LRU order and their
+//! blocks are handed back to the cross KV block pool.
+class EncoderOutputCache
+{
+public:
+    using BlockIdType = SizeType32;
+    using TensorPtr = ITensor::SharedPtr;
+
+    struct Entry
+    {
+        //! Encoder output, shared read-only by all the requests using the entry
+        TensorPtr encoderOutput;
+        //! Cross KV blocks computed from encoderOutput, in sequence order
+        std::vector<BlockIdType> crossKvBlockIds;
+    };
+
+    struct Stats
+    {
+        SizeType32 numEntries{0};
+        SizeType32 numBlocks{0};
+        std::int64_t numHits{0};
+        std::int64_t numMisses{0};
+        std::int64_t numEvictedEntries{0};
+    };
+
+    //! \param maxNumBlocks Number of cross KV blocks above which trim() evicts unreferenced entries.
+    explicit EncoderOutputCache(SizeType32 maxNumBlocks);
+
+    //! \brief Look up an encoder input and take a reference to its entry on a hit.
+    [[nodiscard]] std::optional<Entry> acquire(
+        VecUniqueTokens const& inputTokens, std::optional<LoraTaskIdType> loraTaskId);
+
+    //! \brief Cache the output of an encoder input. The caller keeps a reference to the new entry and must release()
+    //! it instead of freeing the blocks.
+    //! \return false if the input is already cached, the caller then keeps sole ownership of its blocks.
+    bool insert(VecUniqueTokens const& inputTokens, std::optional<LoraTaskIdType> loraTaskId, TensorPtr encoderOutput,
+        std::vector<BlockIdType> crossKvBlockIds);
+
+    //! \brief Drop a reference taken by acquire() or insert().
+    void release(VecUniqueTokens const& inputTokens, std::optional<LoraTaskIdType> loraTaskId);
+
+    //! \brief Evict unreferenced entries, least recently used first, until at least numBlocks blocks are freed or no
+    //! unreferenced entry is left.
+    //! \return The freed blocks, to be returned to the cross KV block pool.
+    [[nodiscard]] std::vector<BlockIdType> evict(SizeType32 numBlocks);
+
+    //! \brief Evict unreferenced entries until the cache holds at most maxNumBlocks blocks.
+    [[nodiscard]] std::vector<BlockIdType> trim();
+
+    [[nodiscard]] Stats const& getStats() const noexcept
+    {
+        return mStats;
+    }
+
+    [[nodiscard]] static std::size_t hashInput(
+        VecUniqueTokens const& inputTokens, std::optional<LoraTaskIdType> loraTaskId) noexcept;
+
+private:
+    struct Node
+    {
+        VecUniqueTokens inputTokens;
+        std::optional<LoraTaskIdType> loraTaskId;
+        Entry entry;
+        SizeType32 refCount{0};
+    };
+
+    // Least recently used first
+    using NodeList = std::list<Node>;
+
+    [[nodiscard]] NodeList::iterator find(
+        std::size_t hash, VecUniqueTokens const& inputTokens, std::optional<LoraTaskIdType> loraTaskId);
+
+    void touch(NodeList::iterator it);
+
+    SizeType32 mMaxNumBlocks;
+    NodeList mNodes;
+    std::unordered_multimap<std::size_t, NodeList::iterator> mIndex;
+    Stats mStats;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/engineLoadCoordinator.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <cstdio>
+
+namespace tensorrt_llm::runtime
+{
+
+EngineLoadCoordinator::EngineLoadCoordinator(
+    SizeType32 localRank, SizeType32 localSize, std::optional<SizeType32> maxConcurrentReads)
+{
+    TLLM_CHECK_WITH_INFO(localSize > 0 && localRank >= 0 && localRank < localSize,
+        "Local rank %d is out of range for %d local ranks", localRank, localSize);
+    auto const concurrency = maxConcurrentReads.value_or(localSize);
+    TLLM_CHECK_WITH_INFO(concurrency > 0, "maxConcurrentReads must be positive");
+    mWave = localRank / concurrency;
+    mNumWaves = (localSize + concurrency - 1) / concurrency;
+}
+
+void EngineLoadCoordinator::runStaggered(
+    std::function<void()> const& read, std::function<void()> const& barrier) const
+{
+    if (mNumWaves == 1)
+    {
+        read();
+        return;
+    }
+    for (SizeType32 wave = 0; wave < mNumWaves; ++wave)
+    {
+        if (wave == mWave)
+        {
+            read();
+        }
+        barrier();
+    }
+}
+
+void EngineLoadCoordinator::startPhase(std::string name)
+{
+    stopPhase();
+    mPhases.push_back(Phase{std::move(name), 0.0});
+    mPhaseStart = Clock::now();
+}
+
+void EngineLoadCoordinator::stopPhase()
+{
+    if (mPhaseStart)
+    {
+        mPhases.back().durationMS
+            = std::chrono::duration<double, std::milli>(Clock::now() - *mPhaseStart).count();
+        mPhaseStart.reset();
+    }
+}
+
+std::string EngineLoadCoordinator::getReport() const
+{
+    std::string report;
+    char buffer[64];
+    for (auto const& phase : mPhases)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.1f ms", phase.durationMS);
+        report += (report.empty() ? "" : ", ") + phase.name + " " + buffer;
+    }
+    return report;
+}
+
+} // namespace tensorrt_llm::runtime
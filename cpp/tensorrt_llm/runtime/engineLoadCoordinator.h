@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Coordinates the engine loads of the ranks of a node during startup and times their phases.
+//! \details Ranks read their engine files in waves of at most maxConcurrentReads ranks, so that they do not contend
+//! for the same filesystem. A rank deserializes its engine from the page cache while later waves are still reading,
+//! which pipelines reading and deserialization across the node.
+class EngineLoadCoordinator
+{
+public:
+    struct Phase
+    {
+        std::string name;
+        double durationMS;
+    };
+
+    //! \param maxConcurrentReads Maximum number of ranks reading at the same time, all ranks if not set.
+    EngineLoadCoordinator(SizeType32 localRank, SizeType32 localSize, std::optional<SizeType32> maxConcurrentReads);
+
+    [[nodiscard]] SizeType32 getWave() const noexcept
+    {
+        return mWave;
+    }
+
+    [[nodiscard]] SizeType32 getNumWaves() const noexcept
+    {
+        return mNumWaves;
+    }
+
+    //! \brief Call read in the wave of this rank.
+    //! \param barrier Synchronizes the local ranks. Every rank calls it once per wave, so all ranks must call
+    //! runStaggered together.
+    void runStaggered(std::function<void()> const& read, std::function<void()> const& barrier) const;
+
+    //! \brief Start timing a phase, stopping the running one.
+    void startPhase(std::string name);
+
+    //! \brief Stop the running phase.
+    void stopPhase();
+
+    [[nodiscard]] std::vector<Phase> const& getPhases() const noexcept
+    {
+        return mPhases;
+    }
+
+    //! \brief One line listing the duration of every phase, for the startup log.
+    [[nodiscard]] std::string getReport() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    SizeType32 mWave;
+    SizeType32 mNumWaves;
+    std::vector<Phase> mPhases;
+    std::optional<Clock::time_point> mPhaseStart;
+};
+
+} // namespace tensorrt_llm::runtime
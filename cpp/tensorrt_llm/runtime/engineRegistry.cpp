@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/engineRegistry.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+
+namespace tensorrt_llm::runtime
+{
+
+EngineRegistry& EngineRegistry::getInstance()
+{
+    static EngineRegistry registry;
+    return registry;
+}
+
+EngineRegistry::EnginePtr EngineRegistry::acquire(std::string const& key, Deserialize const& deserialize)
+{
+    auto const device = common::getDevice();
+    // Held while deserializing, a second executor of the same engine waits for the first one instead of loading
+    // another copy
+    std::lock_guard<std::mutex> const lock(mMutex);
+    auto& entry = mEngines[{device, key}];
+    if (auto engine = entry.lock())
+    {
+        TLLM_LOG_INFO("Sharing the engine %s with %ld other runtime(s)", key.c_str(), engine.use_count() - 1);
+        return engine;
+    }
+    auto engine = deserialize();
+    TLLM_CHECK_WITH_INFO(engine != nullptr, "Failed to deserialize engine %s", key.c_str());
+    entry = engine;
+
+    // Forget the engines that were destroyed meanwhile
+    for (auto it = mEngines.begin(); it != mEngines.end();)
+    {
+        it = it->second.expired() ? mEngines.erase(it) : std::next(it);
+    }
+    return engine;
+}
+
+std::size_t EngineRegistry::getNumEngines()
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    std::size_t numEngines{0};
+    for (auto const& [key, engine] : mEngines)
+    {
+        numEngines += engine.expired() ? 0 : 1;
+    }
+    return numEngines;
+}
+
+} // namespace tensorrt_llm::runtime
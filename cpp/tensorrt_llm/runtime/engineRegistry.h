@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <NvInferRuntime.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Process-wide registry of deserialized engines, so that runtimes of the same engine share it.
+//! \details Serving several LoRA-only variants of a base model, or comparing scheduler configs on it, takes one
+//! executor each. Without sharing, every executor deserializes the engine and holds its own copy of the weights on
+//! the GPU. Runtimes that acquire an engine under the same key on the same device get the same ICudaEngine, and with
+//! it one copy of the weights, while each keeps its own execution contexts, context memory and KV cache.
+//!
+//! The registry does not own the engines: an engine is destroyed with the last runtime using it, and the next
+//! runtime acquiring its key deserializes it again.
+class EngineRegistry
+{
+public:
+    using EnginePtr = std::shared_ptr<nvinfer1::ICudaEngine>;
+    using Deserialize = std::function<EnginePtr()>;
+
+    static EngineRegistry& getInstance();
+
+    //! \brief The live engine of the key on the current device, deserialized with deserialize if there is none.
+    //! Concurrent acquires of the same key deserialize it once.
+    [[nodiscard]] EnginePtr acquire(std::string const& key, Deserialize const& deserialize);
+
+    //! \brief Number of engines alive in the registry.
+    [[nodiscard]] std::size_t getNumEngines();
+
+private:
+    EngineRegistry() = default;
+
+    std::mutex mMutex;
+    //! Engines by device and key
+    std::map<std::pair<int, std::string>, std::weak_ptr<nvinfer1::ICudaEngine>> mEngines;
+};
+
+} // namespace tensorrt_llm::runtime
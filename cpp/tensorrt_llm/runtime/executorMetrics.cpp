@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/executorMetrics.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+double constexpr kSecondsPerMs = 1e-3;
+
+void addTo(std::atomic<double>& sum, double value) noexcept
+{
+    auto current = sum.load(std::memory_order_relaxed);
+    while (!sum.compare_exchange_weak(current, current + value, std::memory_order_relaxed))
+    {
+    }
+}
+
+std::string formatValue(double value)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+void appendHeader(std::string& out, char const* name, char const* type, char const* help)
+{
+    out += std::string{"# HELP "} + name + " " + help + "\n";
+    out += std::string{"# TYPE "} + name + " " + type + "\n";
+}
+
+template <typename T>
+void appendScalar(std::string& out, char const* name, char const* type, char const* help, T value)
+{
+    appendHeader(out, name, type, help);
+    out += std::string{name} + " " + formatValue(static_cast<double>(value)) + "\n";
+}
+
+void appendHistogram(std::string& out, char const* name, char const* help, ExecutorMetrics::Histogram const& histogram)
+{
+    appendHeader(out, name, "histogram", help);
+    auto const counts = histogram.getCumulativeCounts();
+    auto const& bounds = histogram.getUpperBounds();
+    for (std::size_t i = 0; i < counts.size(); ++i)
+    {
+        auto const le = i < bounds.size() ? formatValue(bounds[i]) : std::string{"+Inf"};
+        out += std::string{name} + "_bucket{le=\"" + le + "\"} " + std::to_string(counts[i]) + "\n";
+    }
+    // Counts are read bucket by bucket, use the last one so that count matches the +Inf bucket
+    out += std::string{name} + "_sum " + formatValue(histogram.getSum()) + "\n";
+    out += std::string{name} + "_count " + std::to_string(counts.back()) + "\n";
+}
+} // namespace
+
+ExecutorMetrics::Histogram::Histogram(std::vector<double> upperBounds)
+    : mUpperBounds{std::move(upperBounds)}
+    , mBucketCounts{std::make_unique<std::atomic<std::uint64_t>[]>(mUpperBounds.size() + 1)}
+{
+    TLLM_CHECK_WITH_INFO(std::is_sorted(mUpperBounds.begin(), mUpperBounds.end()), "Bucket bounds must be sorted");
+    for (std::size_t i = 0; i <= mUpperBounds.size(); ++i)
+    {
+        mBucketCounts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void ExecutorMetrics::Histogram::observe(double value) noexcept
+{
+    auto const bucket = std::lower_bound(mUpperBounds.begin(), mUpperBounds.end(), value) - mUpperBounds.begin();
+    mBucketCounts[bucket].fetch_add(1, std::memory_order_relaxed);
+    addTo(mSum, value);
+    mCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<std::uint64_t> ExecutorMetrics::Histogram::getCumulativeCounts() const
+{
+    std::vector<std::uint64_t> counts(mUpperBounds.size() + 1);
+    std::uint64_t total{0};
+    for (std::size_t i = 0; i < counts.size(); ++i)
+    {
+        total += mBucketCounts[i].load(std::memory_order_relaxed);
+        counts[i] = total;
+    }
+    return counts;
+}
+
+std::vector<double> ExecutorMetrics::getDefaultLatencyBuckets()
+{
+    return {0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0};
+}
+
+ExecutorMetrics::ExecutorMetrics()
+    : mIterationLatency{getDefaultLatencyBuckets()}
+    , mTimeToFirstToken{getDefaultLatencyBuckets()}
+    , mInterTokenLatency{getDefaultLatencyBuckets()}
+{
+}
+
+void ExecutorMetrics::update(executor::IterationStats const& stats) noexcept
+{
+    mIterationLatency.observe(stats.iterLatencyMS * kSecondsPerMs);
+    mNumIterations.fetch_add(1, std::memory_order_relaxed);
+    mNumCompletedRequests.fetch_add(stats.numCompletedRequests, std::memory_order_relaxed);
+    addTo(mQueueLatencySum, stats.newActiveRequestsQueueLatencyMS * kSecondsPerMs);
+
+    mNumActiveRequests.store(stats.numActiveRequests, std::memory_order_relaxed);
+    mNumQueuedRequests.store(stats.numQueuedRequests, std::memory_order_relaxed);
+    mGpuMemUsage.store(stats.gpuMemUsage, std::memory_order_relaxed);
+
+    if (stats.kvCacheStats)
+    {
+        auto const& kvStats = *stats.kvCacheStats;
+        mKvCacheMaxBlocks.store(kvStats.maxNumBlocks, std::memory_order_relaxed);
+        mKvCacheUsedBlocks.store(kvStats.usedNumBlocks, std::memory_order_relaxed);
+        mKvCacheAllocatedBlocks.store(kvStats.allocTotalBlocks, std::memory_order_relaxed);
+        mKvCacheReusedBlocks.store(kvStats.reusedBlocks, std::memory_order_relaxed);
+    }
+    if (stats.inflightBatchingStats)
+    {
+        auto const& ifbStats = *stats.inflightBatchingStats;
+        mNumPausedRequests.store(ifbStats.numPausedRequests, std::memory_order_relaxed);
+        mNumContextTokens.fetch_add(ifbStats.numCtxTokens, std::memory_order_relaxed);
+    }
+}
+
+void ExecutorMetrics::observeTimeToFirstToken(double latencyMS) noexcept
+{
+    mTimeToFirstToken.observe(latencyMS * kSecondsPerMs);
+}
+
+void ExecutorMetrics::observeInterTokenLatency(double latencyMS) noexcept
+{
+    mInterTokenLatency.observe(latencyMS * kSecondsPerMs);
+}
+
+void ExecutorMetrics::observeSloRequest(bool attained) noexcept
+{
+    mNumSloRequestsCompleted.fetch_add(1, std::memory_order_relaxed);
+    mNumSloRequestsAttained.fetch_add(attained ? 1 : 0, std::memory_order_relaxed);
+}
+
+void ExecutorMetrics::observeIterationTimes(double hostOverheadMS, double gpuTimeMS) noexcept
+{
+    addTo(mHostOverheadSum, hostOverheadMS * kSecondsPerMs);
+    addTo(mGpuTimeSum, gpuTimeMS * kSecondsPerMs);
+}
+
+std::string ExecutorMetrics::scrape() const
+{
+    auto constexpr relaxed = std::memory_order_relaxed;
+    std::string out;
+    out.reserve(4096);
+    appendHistogram(out, "trtllm_iteration_latency_seconds", "Latency of executor iterations.", mIterationLatency);
+    appendHistogram(
+        out, "trtllm_time_to_first_token_seconds", "Time from arrival to the first token.", mTimeToFirstToken);
+    appendHistogram(out, "trtllm_inter_token_latency_seconds", "Time between consecutive tokens of a request.",
+        mInterTokenLatency);
+
+    appendScalar(out, "trtllm_iterations_total", "counter", "Executor iterations.", mNumIterations.load(relaxed));
+    appendScalar(out, "trtllm_requests_completed_total", "counter", "Completed requests.",
+        mNumCompletedRequests.load(relaxed));
+    appendScalar(out, "trtllm_context_tokens_total", "counter", "Context tokens processed.",
+        mNumContextTokens.load(relaxed));
+    appendScalar(out, "trtllm_queue_latency_seconds_total", "counter",
+        "Total time requests spent queued before becoming active.", mQueueLatencySum.load(relaxed));
+    appendScalar(out, "trtllm_slo_requests_completed_total", "counter", "Completed requests with a latency SLO.",
+        mNumSloRequestsCompleted.load(relaxed));
+    appendScalar(out, "trtllm_slo_requests_attained_total", "counter",
+        "Completed requests that met their latency SLO.", mNumSloRequestsAttained.load(relaxed));
+    appendScalar(out, "trtllm_iteration_host_overhead_seconds_total", "counter",
+        "Total host time of iterations not spent waiting for the GPU.", mHostOverheadSum.load(relaxed));
+    appendScalar(out, "trtllm_iteration_gpu_seconds_total", "counter",
+        "Total GPU time of the forward and decoding of iterations.", mGpuTimeSum.load(relaxed));
+    appendScalar(out, "trtllm_kv_cache_allocated_blocks_total", "counter", "KV cache blocks allocated.",
+        mKvCacheAllocatedBlocks.load(relaxed));
+    appendScalar(out, "trtllm_kv_cache_reused_blocks_total", "counter", "KV cache blocks reused from the cache.",
+        mKvCacheReusedBlocks.load(relaxed));
+
+    appendScalar(out, "trtllm_active_requests", "gauge", "Active requests.", mNumActiveRequests.load(relaxed));
+    appendScalar(out, "trtllm_queued_requests", "gauge", "Queued requests.", mNumQueuedRequests.load(relaxed));
+    appendScalar(out, "trtllm_paused_requests", "gauge", "Paused requests.", mNumPausedRequests.load(relaxed));
+    appendScalar(out, "trtllm_gpu_memory_bytes", "gauge", "GPU memory used.", mGpuMemUsage.load(relaxed));
+    auto const maxBlocks = mKvCacheMaxBlocks.load(relaxed);
+    auto const usedBlocks = mKvCacheUsedBlocks.load(relaxed);
+    appendScalar(out, "trtllm_kv_cache_max_blocks", "gauge", "KV cache blocks in the pool.", maxBlocks);
+    appendScalar(out, "trtllm_kv_cache_used_blocks", "gauge", "KV cache blocks in use.", usedBlocks);
+    appendScalar(out, "trtllm_kv_cache_utilization", "gauge", "Fraction of KV cache blocks in use.",
+        maxBlocks > 0 ? static_cast<double>(usedBlocks) / static_cast<double>(maxBlocks) : 0.0);
+    return out;
+}
+
+} // namespace tensorrt_llm::runtime
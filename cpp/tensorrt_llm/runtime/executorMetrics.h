@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/types.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Pre-aggregated executor metrics in the Prometheus text exposition format.
+//! \details The executor loop updates the metrics once per iteration. All values are atomics, so a scrape runs
+//! concurrently with the updates and never takes the stats lock of the executor.
+class ExecutorMetrics
+{
+public:
+    //! \brief Cumulative histogram with fixed bucket upper bounds.
+    class Histogram
+    {
+    public:
+        explicit Histogram(std::vector<double> upperBounds);
+
+        void observe(double value) noexcept;
+
+        //! \brief Cumulative counts, one per upper bound and a last one for +Inf.
+        [[nodiscard]] std::vector<std::uint64_t> getCumulativeCounts() const;
+
+        [[nodiscard]] std::vector<double> const& getUpperBounds() const noexcept
+        {
+            return mUpperBounds;
+        }
+
+        [[nodiscard]] std::uint64_t getCount() const noexcept
+        {
+            return mCount.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] double getSum() const noexcept
+        {
+            return mSum.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::vector<double> mUpperBounds;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> mBucketCounts;
+        std::atomic<std::uint64_t> mCount{0};
+        std::atomic<double> mSum{0.0};
+    };
+
+    //! \brief Bucket upper bounds in seconds, from 1 ms to 10 s.
+    [[nodiscard]] static std::vector<double> getDefaultLatencyBuckets();
+
+    ExecutorMetrics();
+
+    //! \brief Account an iteration.
+    void update(executor::IterationStats const& stats) noexcept;
+
+    void observeTimeToFirstToken(double latencyMS) noexcept;
+
+    void observeInterTokenLatency(double latencyMS) noexcept;
+
+    //! \brief Account a completed request with latency targets, see LatencySloTracker::isAttained.
+    void observeSloRequest(bool attained) noexcept;
+
+    //! \brief Account the host overhead and GPU time of an iteration, see IterationProfiler::end.
+    void observeIterationTimes(double hostOverheadMS, double gpuTimeMS) noexcept;
+
+    //! \brief All metrics in the Prometheus text format, e.g. for the body of a /metrics endpoint.
+    [[nodiscard]] std::string scrape() const;
+
+private:
+    Histogram mIterationLatency;
+    Histogram mTimeToFirstToken;
+    Histogram mInterTokenLatency;
+
+    std::atomic<std::uint64_t> mNumIterations{0};
+    std::atomic<std::uint64_t> mNumCompletedRequests{0};
+    std::atomic<std::uint64_t> mNumContextTokens{0};
+    std::atomic<std::uint64_t> mNumSloRequestsCompleted{0};
+    std::atomic<std::uint64_t> mNumSloRequestsAttained{0};
+    std::atomic<double> mQueueLatencySum{0.0};
+    std::atomic<double> mHostOverheadSum{0.0};
+    std::atomic<double> mGpuTimeSum{0.0};
+
+    std::atomic<std::int64_t> mNumActiveRequests{0};
+    std::atomic<std::int64_t> mNumQueuedRequests{0};
+    std::atomic<std::int64_t> mNumPausedRequests{0};
+    std::atomic<std::uint64_t> mGpuMemUsage{0};
+    std::atomic<std::int64_t> mKvCacheMaxBlocks{0};
+    std::atomic<std::int64_t> mKvCacheUsedBlocks{0};
+    // Cumulative in the KV cache manager already
+    std::atomic<std::int64_t> mKvCacheAllocatedBlocks{0};
+    std::atomic<std::int64_t> mKvCacheReusedBlocks{0};
+};
+
+} // namespace tensorrt_llm::runtime
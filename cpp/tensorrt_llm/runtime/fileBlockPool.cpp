@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/fileBlockPool.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+
+#include <cerrno>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace tensorrt_llm::runtime
+{
+
+FileBlockPool::FileBlockPool(
+    std::filesystem::path path, std::size_t blockSizeInBytes, std::size_t maxNumBlocks, bool removeOnDestruction)
+    : mPath{std::move(path)}
+    , mBlockSizeInBytes{blockSizeInBytes}
+    , mMaxNumBlocks{maxNumBlocks}
+    , mRemoveOnDestruction{removeOnDestruction}
+{
+    TLLM_CHECK_WITH_INFO(mBlockSizeInBytes > 0, "Block size must be positive");
+    TLLM_CHECK_WITH_INFO(mMaxNumBlocks > 0, "Number of blocks must be positive");
+#if defined(_WIN32)
+    TLLM_THROW("FileBlockPool is not supported on Windows");
+#else
+    auto const totalSize = mBlockSizeInBytes * mMaxNumBlocks;
+    mFd = ::open(mPath.c_str(), O_RDWR | O_CREAT, 0600);
+    TLLM_CHECK_WITH_INFO(mFd >= 0, "Failed to open %s: %s", mPath.c_str(), std::strerror(errno));
+    if (::ftruncate(mFd, static_cast<off_t>(totalSize)) != 0)
+    {
+        auto const err = errno;
+        ::close(mFd);
+        TLLM_THROW("Failed to resize %s to %zu bytes: %s", mPath.c_str(), totalSize, std::strerror(err));
+    }
+    auto* data = ::mmap(nullptr, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+    if (data == MAP_FAILED)
+    {
+        auto const err = errno;
+        ::close(mFd);
+        TLLM_THROW("Failed to map %s: %s", mPath.c_str(), std::strerror(err));
+    }
+    mData = static_cast<std::byte*>(data);
+#endif
+
+    mFreeSlots.reserve(mMaxNumBlocks);
+    for (std::size_t slot = mMaxNumBlocks; slot > 0; --slot)
+    {
+        mFreeSlots.push_back(slot - 1);
+    }
+    mEntries.reserve(mMaxNumBlocks);
+    mStats.maxNumBlocks = mMaxNumBlocks;
+    TLLM_LOG_INFO("Allocated file block pool with %zu blocks of %zu bytes in %s", mMaxNumBlocks, mBlockSizeInBytes,
+        mPath.c_str());
+}
+
+FileBlockPool::~FileBlockPool()
+{
+#if !defined(_WIN32)
+    if (mData != nullptr)
+    {
+        ::munmap(mData, mBlockSizeInBytes * mMaxNumBlocks);
+    }
+    if (mFd >= 0)
+    {
+        ::close(mFd);
+    }
+#endif
+    if (mRemoveOnDestruction)
+    {
+        std::error_code ec;
+        std::filesystem::remove(mPath, ec);
+    }
+}
+
+void FileBlockPool::touch(Entry& entry)
+{
+    mLru.splice(mLru.begin(), mLru, entry.lruIt);
+}
+
+std::optional<FileBlockPool::KeyType> FileBlockPool::store(KeyType key, void const* src)
+{
+    TLLM_NVTX_SCOPED_RANGE(kKV, store);
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::optional<KeyType> evictedKey;
+
+    auto it = mEntries.find(key);
+    if (it == mEntries.end())
+    {
+        if (mFreeSlots.empty())
+        {
+            auto const victim = mLru.back();
+            mLru.pop_back();
+            auto victimIt = mEntries.find(victim);
+            mFreeSlots.push_back(victimIt->second.slot);
+            mEntries.erase(victimIt);
+            ++mStats.evictions;
+            evictedKey = victim;
+        }
+        auto const slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+        mLru.push_front(key);
+        it = mEntries.emplace(key, Entry{slot, mLru.begin()}).first;
+    }
+    else
+    {
+        touch(it->second);
+    }
+
+    std::memcpy(slotPtr(it->second.slot), src, mBlockSizeInBytes);
+    mStats.usedNumBlocks = mEntries.size();
+    return evictedKey;
+}
+
+bool FileBlockPool::load(KeyType key, void* dst)
+{
+    TLLM_NVTX_SCOPED_RANGE(kKV, load);
+    auto const* src = find(key);
+    if (src == nullptr)
+    {
+        return false;
+    }
+    std::memcpy(dst, src, mBlockSizeInBytes);
+    return true;
+}
+
+void const* FileBlockPool::find(KeyType key)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mEntries.find(key);
+    if (it == mEntries.end())
+    {
+        ++mStats.misses;
+        return nullptr;
+    }
+    ++mStats.hits;
+    touch(it->second);
+    return slotPtr(it->second.slot);
+}
+
+bool FileBlockPool::erase(KeyType key)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mEntries.find(key);
+    if (it == mEntries.end())
+    {
+        return false;
+    }
+    mLru.erase(it->second.lruIt);
+    mFreeSlots.push_back(it->second.slot);
+    mEntries.erase(it);
+    mStats.usedNumBlocks = mEntries.size();
+    return true;
+}
+
+bool FileBlockPool::contains(KeyType key) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.find(key) != mEntries.end();
+}
+
+FileBlockPool::Stats FileBlockPool::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+} // namespace tensorrt_llm::runtime
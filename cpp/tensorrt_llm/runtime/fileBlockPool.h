@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief A pool of fixed-size blocks backed by a memory-mapped file.
+//! \details Blocks are addressed by a 64-bit key (e.g. the hash of a KV cache block key chain). When the pool is full,
+//! storing a new block evicts the least recently used one. The pool is meant to sit below a host memory pool: blocks
+//! evicted from host memory are spilled here and promoted back on reuse hits.
+class FileBlockPool
+{
+public:
+    using KeyType = std::uint64_t;
+
+    struct Stats
+    {
+        //! Capacity of the pool in blocks
+        std::size_t maxNumBlocks{0};
+        //! Number of blocks currently stored
+        std::size_t usedNumBlocks{0};
+        //! Number of successful lookups
+        std::size_t hits{0};
+        //! Number of failed lookups
+        std::size_t misses{0};
+        //! Number of blocks evicted to make room for new ones
+        std::size_t evictions{0};
+    };
+
+    //! \param path File backing the pool. Created if it does not exist, truncated to the pool size otherwise.
+    //! \param blockSizeInBytes Size of a single block.
+    //! \param maxNumBlocks Capacity of the pool.
+    //! \param removeOnDestruction Whether the backing file is deleted when the pool is destroyed.
+    FileBlockPool(std::filesystem::path path, std::size_t blockSizeInBytes, std::size_t maxNumBlocks,
+        bool removeOnDestruction = true);
+
+    FileBlockPool(FileBlockPool const&) = delete;
+    FileBlockPool& operator=(FileBlockPool const&) = delete;
+
+    ~FileBlockPool();
+
+    //! \brief Copy a block into the pool. Replaces the content if key is already present.
+    //! \return The key of the block that was evicted to make room, if any.
+    std::optional<KeyType> store(KeyType key, void const* src);
+
+    //! \brief Copy the block stored under key to dst and mark it as recently used.
+    //! \return false if the key is not present.
+    [[nodiscard]] bool load(KeyType key, void* dst);
+
+    //! \brief Returns a pointer into the mapping for the block stored under key, or nullptr.
+    //! \details The pointer stays valid until the block is evicted or erased. Can be used as source of a H2D copy
+    //! without staging through host memory.
+    [[nodiscard]] void const* find(KeyType key);
+
+    //! \brief Remove the block stored under key.
+    //! \return false if the key is not present.
+    bool erase(KeyType key);
+
+    [[nodiscard]] bool contains(KeyType key) const;
+
+    [[nodiscard]] std::size_t getBlockSizeInBytes() const noexcept
+    {
+        return mBlockSizeInBytes;
+    }
+
+    [[nodiscard]] std::size_t getMaxNumBlocks() const noexcept
+    {
+        return mMaxNumBlocks;
+    }
+
+    [[nodiscard]] Stats getStats() const;
+
+private:
+    using LruList = std::list<KeyType>;
+
+    struct Entry
+    {
+        std::size_t slot;
+        LruList::iterator lruIt;
+    };
+
+    [[nodiscard]] std::byte* slotPtr(std::size_t slot) const noexcept
+    {
+        return mData + slot * mBlockSizeInBytes;
+    }
+
+    void touch(Entry& entry);
+
+    std::filesystem::path mPath;
+    std::size_t mBlockSizeInBytes;
+    std::size_t mMaxNumBlocks;
+    bool mRemoveOnDestruction;
+
+    int mFd{-1};
+    std::byte* mData{nullptr};
+
+    mutable std::mutex mMutex;
+    // Most recently used block at the front
+    LruList mLru;
+    std::unordered_map<KeyType, Entry> mEntries;
+    std::vector<std::size_t> mFreeSlots;
+    Stats mStats;
+};
+
+} // namespace tensorrt_llm::runtime
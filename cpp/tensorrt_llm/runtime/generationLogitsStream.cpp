@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/generationLogitsStream.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+#include "tensorrt_llm/executor/tensor.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <cstring>
+#include <tuple>
+
+namespace tensorrt_llm::runtime
+{
+
+GenerationLogitsStream::GenerationLogitsStream(SizeType32 beamWidth, SizeType32 vocabSizePadded,
+    nvinfer1::DataType dataType, SizeType32 maxStepsInFlight, SizeType32 stepsPerChunk)
+    : mBeamWidth{beamWidth}
+    , mVocabSizePadded{vocabSizePadded}
+    , mDataType{dataType}
+    , mMaxStepsInFlight{maxStepsInFlight}
+    , mStepsPerChunk{stepsPerChunk}
+{
+    TLLM_CHECK_WITH_INFO(beamWidth > 0 && vocabSizePadded > 0, "beamWidth and vocabSizePadded must be positive");
+    TLLM_CHECK_WITH_INFO(
+        maxStepsInFlight > 0 && stepsPerChunk > 0, "maxStepsInFlight and stepsPerChunk must be positive");
+}
+
+void GenerationLogitsStream::push(ITensor const& logits, CudaStream const& stream)
+{
+    TLLM_NVTX_SCOPED_RANGE(kRESPONSE, push);
+    TLLM_CHECK_WITH_INFO(logits.getDataType() == mDataType, "Logits data type does not match");
+    TLLM_CHECK_WITH_INFO(logits.getSize() == static_cast<std::size_t>(mBeamWidth) * mVocabSizePadded,
+        "Expected logits of %d beams and %d tokens, got %zu values", mBeamWidth, mVocabSizePadded, logits.getSize());
+
+    while (getNumStepsInFlight() >= mMaxStepsInFlight)
+    {
+        mPending[mNumCompleted].copied.synchronize();
+        ++mNumCompleted;
+    }
+
+    if (!mChunk || mChunkSize == mStepsPerChunk)
+    {
+        mChunk = BufferManager::pinnedStaging(
+            ITensor::makeShape({mStepsPerChunk, mBeamWidth, mVocabSizePadded}), mDataType);
+        mChunkSize = 0;
+    }
+    auto const dst = ITensor::slice(mChunk, mChunkSize, 1);
+    TLLM_CUDA_CHECK(cudaMemcpyAsync(
+        dst->data(), logits.data(), logits.getSizeInBytes(), cudaMemcpyDeviceToHost, stream.get()));
+    Step step{mChunk, mChunkSize, CudaEvent{}};
+    stream.record(step.copied);
+    mPending.push_back(std::move(step));
+    ++mChunkSize;
+}
+
+GenerationLogitsStream::TensorPtr GenerationLogitsStream::pop()
+{
+    TLLM_NVTX_SCOPED_RANGE(kRESPONSE, pop);
+    if (mPending.empty())
+    {
+        return nullptr;
+    }
+    for (auto i = mNumCompleted; i < getNumPendingSteps(); ++i)
+    {
+        mPending[i].copied.synchronize();
+    }
+
+    auto const numSteps = getNumPendingSteps();
+    auto const& front = mPending.front();
+    TensorPtr result;
+    if (front.chunk == mPending.back().chunk)
+    {
+        // All steps are adjacent in one chunk, hand out a view of it
+        result = ITensor::slice(front.chunk, front.idx, numSteps);
+    }
+    else
+    {
+        result = BufferManager::pinnedStaging(ITensor::makeShape({numSteps, mBeamWidth, mVocabSizePadded}), mDataType);
+        auto const stepBytes = result->getSizeInBytes() / numSteps;
+        auto* dst = static_cast<std::uint8_t*>(result->data());
+        for (auto const& step : mPending)
+        {
+            std::memcpy(dst, ITensor::slice(step.chunk, step.idx, 1)->data(), stepBytes);
+            dst += stepBytes;
+        }
+    }
+    mPending.clear();
+    mNumCompleted = 0;
+    return result;
+}
+
+GenerationLogitsStreamer::GenerationLogitsStreamer(std::optional<executor::LogitsPostProcessor> processor)
+    : mProcessor{std::move(processor)}
+{
+}
+
+executor::LogitsPostProcessor GenerationLogitsStreamer::getLogitsPostProcessor()
+{
+    return [this](IdType requestId, executor::Tensor& logits, executor::BeamTokens const& beamTokens,
+               executor::StreamPtr const& stream, std::optional<IdType> clientId)
+    { push(requestId, logits, beamTokens, stream, clientId); };
+}
+
+void GenerationLogitsStreamer::push(IdType requestId, executor::Tensor& logits,
+    executor::BeamTokens const& beamTokens, executor::StreamPtr const& stream, std::optional<IdType> clientId)
+{
+    if (mProcessor)
+    {
+        (*mProcessor)(requestId, logits, beamTokens, stream, clientId);
+    }
+
+    auto const& tensor = executor::detail::toITensor(logits);
+    auto const& shape = tensor->getShape();
+    TLLM_CHECK_WITH_INFO(shape.nbDims > 0, "Expected logits of at least one dimension");
+    auto const vocabSizePadded = static_cast<SizeType32>(shape.d[shape.nbDims - 1]);
+    auto const beamWidth = static_cast<SizeType32>(tensor->getSize() / vocabSizePadded);
+
+    std::lock_guard<std::mutex> lock{mMutex};
+    auto it = mStreams.find(requestId);
+    if (it == mStreams.end())
+    {
+        it = mStreams.try_emplace(requestId, beamWidth, vocabSizePadded, tensor->getDataType()).first;
+    }
+    it->second.push(*tensor, *stream);
+}
+
+GenerationLogitsStreamer::TensorPtr GenerationLogitsStreamer::pop(IdType requestId)
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    auto it = mStreams.find(requestId);
+    return it != mStreams.end() ? it->second.pop() : nullptr;
+}
+
+void GenerationLogitsStreamer::erase(IdType requestId)
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    auto it = mStreams.find(requestId);
+    if (it != mStreams.end())
+    {
+        // Wait for the copies still writing into the chunks of the stream
+        std::ignore = it->second.pop();
+        mStreams.erase(it);
+    }
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Streams the generation logits of a request to pinned host memory one step at a time.
+//! \details Each step is copied asynchronously into a chunk allocated from the pinned pool, so the device logits of a
+//! step can be reused as soon as the copy is done instead of being kept until the request finishes. At most
+//! maxStepsInFlight copies are outstanding, push() waits for the oldest one beyond that. pop() hands the logits of all
+//! steps pushed since the previous pop() to the response; the returned tensors keep their chunk alive.
+class GenerationLogitsStream
+{
+public:
+    using TensorPtr = ITensor::SharedPtr;
+
+    static SizeType32 constexpr kDefaultMaxStepsInFlight = 2;
+    static SizeType32 constexpr kDefaultStepsPerChunk = 8;
+
+    GenerationLogitsStream(SizeType32 beamWidth, SizeType32 vocabSizePadded, nvinfer1::DataType dataType,
+        SizeType32 maxStepsInFlight = kDefaultMaxStepsInFlight, SizeType32 stepsPerChunk = kDefaultStepsPerChunk);
+
+    //! \brief Enqueue the copy of the logits of one step on stream.
+    //! \param logits [beamWidth, vocabSizePadded] or any shape of the same size, on gpu
+    void push(ITensor const& logits, CudaStream const& stream);
+
+    //! \brief Take the logits of all steps pushed since the last call, waiting for their copies.
+    //! \returns [numSteps, beamWidth, vocabSizePadded] in pinned memory, nullptr if no step was pushed
+    [[nodiscard]] TensorPtr pop();
+
+    [[nodiscard]] SizeType32 getNumPendingSteps() const noexcept
+    {
+        return static_cast<SizeType32>(mPending.size());
+    }
+
+    [[nodiscard]] SizeType32 getNumStepsInFlight() const noexcept
+    {
+        return getNumPendingSteps() - mNumCompleted;
+    }
+
+private:
+    struct Step
+    {
+        TensorPtr chunk;
+        SizeType32 idx;
+        CudaEvent copied;
+    };
+
+    SizeType32 mBeamWidth;
+    SizeType32 mVocabSizePadded;
+    nvinfer1::DataType mDataType;
+    SizeType32 mMaxStepsInFlight;
+    SizeType32 mStepsPerChunk;
+
+    TensorPtr mChunk;
+    SizeType32 mChunkSize{0};
+    std::deque<Step> mPending;
+    //! Number of steps at the front of mPending whose copy is known to be done
+    SizeType32 mNumCompleted{0};
+};
+
+//! \brief Streams the generation logits of the requests that use its logits post processor.
+//! \details Register getLogitsPostProcessor() in the executor's LogitsPostProcessorConfig and set its name on the
+//! requests to stream. Each request gets a GenerationLogitsStream on its first step, sized by the logits of that step.
+//! pop() hands out the logits of a request pushed since its previous call, e.g. next to each streamed response.
+class GenerationLogitsStreamer
+{
+public:
+    using IdType = executor::IdType;
+    using TensorPtr = GenerationLogitsStream::TensorPtr;
+
+    //! \param processor Optional post processor applied to the logits first, so that the streamed logits reflect it.
+    explicit GenerationLogitsStreamer(std::optional<executor::LogitsPostProcessor> processor = std::nullopt);
+
+    //! \brief The post processor to register. It must not outlive the streamer.
+    [[nodiscard]] executor::LogitsPostProcessor getLogitsPostProcessor();
+
+    //! \returns [numSteps, beamWidth, vocabSizePadded] in pinned memory, nullptr if no step was pushed
+    [[nodiscard]] TensorPtr pop(IdType requestId);
+
+    //! \brief Drop the stream of a request, e.g. once its final response was delivered.
+    void erase(IdType requestId);
+
+private:
+    void push(IdType requestId, executor::Tensor& logits, executor::BeamTokens const& beamTokens,
+        executor::StreamPtr const& stream, std::optional<IdType> clientId);
+
+    std::optional<executor::LogitsPostProcessor> mProcessor;
+    std::mutex mMutex;
+    std::unordered_map<IdType, GenerationLogitsStream> mStreams;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -16,6 +16,7 @@
 
 #include "tensorrt_llm/runtime/gptDecoder.h"
 
+#include "tensorrt_llm/common/nvtxUtils.h"
 #include "tensorrt_llm/kernels/decodingKernels.h"
 #include "tensorrt_llm/kernels/speculativeDecoding/externalDraftTokensKernels.h"
 #include "tensorrt_llm/layers/decodingParams.h"
@@ -41,7 +42,7 @@ template <typename T>
 GptDecoder<T>::GptDecoder(executor::DecodingMode const& mode, size_t maxBatchSize, size_t maxBeamWidth,
     size_t vocabSize, size_t vocabSizePadded, size_t maxSequenceLength, CudaStreamPtr const& stream,
     std::shared_ptr<SpeculativeDecodingModule const> speculativeDecodingModule)
-    : mManager{std::make_shared<BufferManager>(stream)}
+    : mManager{std::make_shared<BufferManager>(stream, false, MemoryPoolClass::kDECODER)}
     , mMaxBatchSize(maxBatchSize)
     , mDecodingMode{mode}
 {
@@ -98,6 +99,7 @@ void GptDecoder<T>::setup(SamplingConfig const& samplingConfig, size_t batchSize
         samplingParams->topPDecay = mSamplingConfig.topPDecay;
         samplingParams->topPMin = mSamplingConfig.topPMin;
         samplingParams->topPResetIds = mSamplingConfig.topPResetIds;
+        samplingParams->runtimeMinP = mSamplingConfig.minP;
         samplingParams->outputLogProbs = mSamplingConfig.outputLogProbs;
         samplingParams->cumLogProbs = mSamplingConfig.cumLogProbs;
 
@@ -109,6 +111,8 @@ void GptDecoder<T>::setup(SamplingConfig const& samplingConfig, size_t batchSize
         beamSearchParams->beamSearchDiversityRate = mSamplingConfig.beamSearchDiversityRate;
         beamSearchParams->lengthPenalty = mSamplingConfig.lengthPenalty;
         beamSearchParams->earlyStopping = mSamplingConfig.earlyStopping;
+        beamSearchParams->numBeamGroups = mSamplingConfig.numBeamGroups;
+        beamSearchParams->beamGroupDiversityPenalty = mSamplingConfig.beamGroupDiversityPenalty;
 
         setupParams->decodingParams = std::move(beamSearchParams);
     }
@@ -122,6 +126,9 @@ void GptDecoder<T>::setup(SamplingConfig const& samplingConfig, size_t batchSize
             medusaParams->runtimeTopK = std::vector<SizeType32>(std::begin(topK), std::end(topK));
         }
         medusaParams->runtimeHeadsTopK = mSamplingConfig.topKMedusaHeads;
+        medusaParams->typicalAcceptanceThreshold = mSamplingConfig.typicalAcceptanceThreshold;
+        medusaParams->typicalAcceptanceAlpha = mSamplingConfig.typicalAcceptanceAlpha;
+        medusaParams->useRejectionSampling = mSamplingConfig.useDraftRejectionSampling;
 
         setupParams->decodingParams = std::move(medusaParams);
     }
@@ -162,6 +169,7 @@ void GptDecoder<T>::setup(SamplingConfig const& samplingConfig, size_t batchSize
         setupParams->decodingParams = std::move(lookaheadParams);
     }
     setupParams->decodingParams->randomSeed = mSamplingConfig.randomSeed;
+    setupParams->decodingParams->randomStep = mSamplingConfig.randomStep;
 
     mDecodingLayerWorkspace->setDeviceBatchSlots(batchSlots);
     mDynamicDecodeLayer->setup(batchSize, mSamplingConfig.beamWidth, batchSlots, setupParams, mDecodingLayerWorkspace);
@@ -568,6 +576,7 @@ template <typename T>
 void GptDecoder<T>::forwardAsync(DecodingOutput& output, DecodingInput const& input)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_NVTX_SCOPED_RANGE(kDECODER, forwardAsync);
     auto forwardParams = prepareInputs<T>(input, mMaxBatchSize, mDecodingMode);
     auto outputParams = prepareOutputs(output, mDecodingMode);
 
@@ -580,6 +589,7 @@ template <typename T>
 void GptDecoder<T>::forwardSync(DecodingOutput& output, DecodingInput const& input)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_NVTX_SCOPED_RANGE(kDECODER, forwardSync);
     auto forwardParams = prepareInputs<T>(input, mMaxBatchSize, mDecodingMode);
     auto outputParams = prepareOutputs(output, mDecodingMode);
 
@@ -650,7 +660,7 @@ void IGptDecoder::acceptDraftTokensByIds(ITensor const& targetTokenIds, ITensor
 void IGptDecoder::acceptDraftTokensByLogits(ITensor& draftLogits, ITensor const& targetLogits, ITensor& draftProbs,
     ITensor& targetProbs, ITensor const& numDraftTokens, ITensor& finished, ITensor const& batchSlots,
     SizeType32 vocabSize, SizeType32 vocabSizePadded, bool useRandomAcceptThreshold, float randomAcceptThreshold,
-    curandState_t* curandState, BufferManager::CudaStreamPtr const& stream)
+    tensorrt_llm::kernels::RandomState* randomState, BufferManager::CudaStreamPtr const& stream)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
 
@@ -673,7 +683,7 @@ void IGptDecoder::acceptDraftTokensByLogits(ITensor& draftLogits, ITensor const&
             bufferCast<float>(draftProbs), bufferCast<float>(targetProbs), bufferCast<SizeType32>(numDraftTokens),
             reinterpret_cast<tensorrt_llm::kernels::FinishedState*>(
                 bufferCast<tensorrt_llm::kernels::FinishedState::UnderlyingType>(finished)),
-            curandState, bufferCast<SizeType32>(batchSlots), batchSize, maxBatchSize, beamWidth, vocabSize,
+            randomState, bufferCast<SizeType32>(batchSlots), batchSize, maxBatchSize, beamWidth, vocabSize,
             vocabSizePadded, maxTokensPerStep, useRandomAcceptThreshold, randomAcceptThreshold, stream->get());
     }
     else if (draftLogits.getDataType() == nvinfer1::DataType::kHALF)
@@ -683,7 +693,7 @@ void IGptDecoder::acceptDraftTokensByLogits(ITensor& draftLogits, ITensor const&
             bufferCast<half>(draftProbs), bufferCast<half>(targetProbs), bufferCast<SizeType32>(numDraftTokens),
             reinterpret_cast<tensorrt_llm::kernels::FinishedState*>(
                 bufferCast<tensorrt_llm::kernels::FinishedState::UnderlyingType>(finished)),
-            curandState, bufferCast<SizeType32>(batchSlots), batchSize, maxBatchSize, beamWidth, vocabSize,
+            randomState, bufferCast<SizeType32>(batchSlots), batchSize, maxBatchSize, beamWidth, vocabSize,
             vocabSizePadded, maxTokensPerStep, useRandomAcceptThreshold, randomAcceptThreshold, stream->get());
     }
     else
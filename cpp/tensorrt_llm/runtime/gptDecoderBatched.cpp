@@ -16,10 +16,13 @@
 #include "tensorrt_llm/runtime/gptDecoderBatched.h"
 
 #include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
 #include "tensorrt_llm/kernels/decodingCommon.h"
 #include "tensorrt_llm/kernels/decodingKernels.h"
+#include "tensorrt_llm/kernels/tokenBitmask.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/iterationProfiler.h"
 #include "tensorrt_llm/runtime/memoryCounters.h"
 #include "tensorrt_llm/runtime/runtimeBuffers.h"
 #include "tensorrt_llm/runtime/runtimeKernels.h"
@@ -62,6 +65,7 @@ SamplingConfig extractSamplingConfig(SamplingConfig const& batchSamplingConfig,
     extractOptional(samplingConfig.topK, batchSamplingConfig.topK);
     extractOptional(samplingConfig.topP, batchSamplingConfig.topP);
     extractOptional(samplingConfig.randomSeed, batchSamplingConfig.randomSeed);
+    extractOptional(samplingConfig.randomStep, batchSamplingConfig.randomStep);
     extractOptional(samplingConfig.topPDecay, batchSamplingConfig.topPDecay);
     extractOptional(samplingConfig.topPMin, batchSamplingConfig.topPMin);
     extractOptional(samplingConfig.topPResetIds, batchSamplingConfig.topPResetIds);
@@ -70,12 +74,45 @@ SamplingConfig extractSamplingConfig(SamplingConfig const& batchSamplingConfig,
     extractOptional(samplingConfig.beamSearchDiversityRate, batchSamplingConfig.beamSearchDiversityRate);
     extractOptional(samplingConfig.lengthPenalty, batchSamplingConfig.lengthPenalty);
     extractOptional(samplingConfig.earlyStopping, batchSamplingConfig.earlyStopping);
+    extractOptional(samplingConfig.numBeamGroups, batchSamplingConfig.numBeamGroups);
+    extractOptional(samplingConfig.beamGroupDiversityPenalty, batchSamplingConfig.beamGroupDiversityPenalty);
     samplingConfig.normalizeLogProbs = batchSamplingConfig.normalizeLogProbs;
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
     return samplingConfig;
 }
 
+void setupWords(std::vector<ITensor::SharedPtr>& jointWordsLists, ITensor::SharedPtr const& requestWordsList,
+    ITensor::SharedConstPtr& jointWordsPtrs, ITensor::SharedConstPtr& jointWordsLens, SizeType32& jointMaxWordsLen,
+    SizeType32 batchSlot)
+{
+    if (requestWordsList)
+    {
+        auto const wordsLen = requestWordsList->getShape().d[1];
+        BufferRange<int32_t*>(*constPointerCast(jointWordsPtrs))[batchSlot]
+            = bufferCast<TokenIdType>(*requestWordsList);
+        bufferCast<SizeType32>(*constPointerCast(jointWordsLens))[batchSlot] = wordsLen;
+        // FIXME(nkorobov): this is monotonically growing size
+        jointMaxWordsLen = std::max(static_cast<SizeType32>(wordsLen), jointMaxWordsLen);
+
+        // NOTE(nkorobov): jointWordsList is not used in gptDecoder, but required to keep <name>WordsList's
+        // memory allocated
+        jointWordsLists[batchSlot] = requestWordsList;
+    }
+    else
+    {
+        bufferCast<SizeType32>(*constPointerCast(jointWordsLens))[batchSlot] = 0;
+    }
+}
+
+//! Fill of one slot of a tensor with a leading batch dimension
+template <typename T>
+kernels::BatchedFill fillSlot(ITensor::SharedConstPtr const& tensor, SizeType32 batchSlot, T value)
+{
+    auto const slice = ITensor::slice(constPointerCast(tensor), batchSlot, 1);
+    return kernels::BatchedFill::create(bufferCast<T>(*slice), slice->getSize(), value);
+}
+
 } // namespace
 
 GptDecoderBatched::GptDecoderBatched(std::size_t vocabSize, std::size_t vocabSizePadded,
@@ -88,6 +125,7 @@ GptDecoderBatched::GptDecoderBatched(std::size_t vocabSize, std::size_t vocabSiz
     , mSpeculativeDecodingMode{speculativeDecodingMode}
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    MemoryCounters::TagScope const tagScope{MemoryTag::kDECODER};
     auto constexpr nvTokenIdType = TRTDataType<TokenIdType>::value;
     auto constexpr nvSizeType = TRTDataType<SizeType32>::value;
     auto constexpr nvFloatType = TRTDataType<float>::value;
@@ -130,7 +168,7 @@ GptDecoderBatched::GptDecoderBatched(std::size_t vocabSize, std::size_t vocabSiz
     dOutput->logProbsTiled = mBufferManager.emptyTensor(MemoryType::kGPU, TRTDataType<float>::value);
 
     mNumDraftTokens = mBufferManager.emptyTensor(MemoryType::kGPU, nvSizeType);
-    mCurandStates = mBufferManager.emptyTensor(MemoryType::kGPU, nvinfer1::DataType::kINT8);
+    mRandomStates = mBufferManager.emptyTensor(MemoryType::kGPU, nvinfer1::DataType::kINT8);
     mDraftTokenIds = mBufferManager.emptyTensor(MemoryType::kGPU, nvinfer1::DataType::kINT32);
     mDraftLogits = mBufferManager.emptyTensor(MemoryType::kGPU, nvFloatType);
     mTargetLogitsPtrs = mBufferManager.emptyTensor(MemoryType::kPINNEDPOOL, TRTDataType<float*>::value);
@@ -230,6 +268,7 @@ void GptDecoderBatched::setup(executor::DecodingMode const& mode, SizeType32 max
     SizeType32 maxTokensPerEngineStep, nvinfer1::DataType dtype, ModelConfig const& modelConfig)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    MemoryCounters::TagScope const tagScope{MemoryTag::kDECODER};
     TLLM_CHECK(maxBatchSize > 0);
     TLLM_CHECK(maxBeamWidth > 0);
     TLLM_CHECK(maxTokensPerEngineStep > 0);
@@ -299,7 +338,7 @@ void GptDecoderBatched::setup(executor::DecodingMode const& mode, SizeType32 max
     mBatchSlotsAcceptTokens->reshape(ITensor::makeShape({maxTokensPerEngineStep, maxBatchSize}));
     mBatchSlotsAcceptLogits->reshape(ITensor::makeShape({maxTokensPerEngineStep, maxBatchSize}));
 
-    if (mSpeculativeDecodingMode.isDraftTokensExternal())
+    if (mSpeculativeDecodingMode.acceptsDraftTokensExternal())
     {
         mDraftProbs->reshape(ITensor::makeShape(
             {maxBatchSize, maxTokensPerEngineStep, maxBeamWidth, static_cast<SizeType32>(mVocabSizePadded)}));
@@ -334,7 +373,7 @@ void GptDecoderBatched::setup(executor::DecodingMode const& mode, SizeType32 max
         ITensor::makeShape({maxBatchSize, maxTokensPerEngineStep, static_cast<SizeType32>(mVocabSizePadded)}));
     mAcceptByLogits.resize(maxBatchSize);
     mNumDraftTokens->reshape(ITensor::makeShape({maxBatchSize, 1}));
-    mCurandStates->reshape(ITensor::makeShape({maxBatchSize, sizeof(curandState_t)}));
+    mRandomStates->reshape(ITensor::makeShape({maxBatchSize, sizeof(tk::RandomState)}));
     mTargetLogitsPtrs->reshape(ITensor::makeShape({maxTokensPerEngineStep, maxBatchSize}));
 
     const_cast<ITensor&>(*dInput.embeddingBias)
@@ -477,29 +516,6 @@ void GptDecoderBatched::newRequest(
         manager.setZero(*embeddingBiasSlice);
     }
 
-    auto setupWords = [](std::vector<runtime::ITensor::SharedPtr>& jointWordsLists, TensorPtr const& requestWordsList,
-                          SharedConstPtr& jointWordsPtrs, SharedConstPtr& jointWordsLens, SizeType32& jointMaxWordsLen,
-                          SizeType32 batchSlot)
-    {
-        if (requestWordsList)
-        {
-            auto const wordsLen = requestWordsList->getShape().d[1];
-            BufferRange<int32_t*>(*constPointerCast(jointWordsPtrs))[batchSlot]
-                = bufferCast<TokenIdType>(*requestWordsList);
-            bufferCast<SizeType32>(*constPointerCast(jointWordsLens))[batchSlot] = wordsLen;
-            // FIXME(nkorobov): this is monotonically growing size
-            jointMaxWordsLen = std::max(static_cast<SizeType32>(wordsLen), jointMaxWordsLen);
-
-            // NOTE(nkorobov): jointWordsList is not used in gptDecoder, but required to keep <name>WordsList's
-            // memory allocated
-            jointWordsLists[batchSlot] = requestWordsList;
-        }
-        else
-        {
-            bufferCast<SizeType32>(*constPointerCast(jointWordsLens))[batchSlot] = 0;
-        }
-    };
-
     setupWords(dJointInput.stopWordsLists, request.stopWordsList, dJointInput.stopWordsPtrs, dJointInput.stopWordsLens,
         dJointInput.maxStopWordsLen, batchSlot);
 
@@ -587,6 +603,117 @@ void GptDecoderBatched::newRequest(
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+bool GptDecoderBatched::canSetupBatched(decoder_batch::Request const& request, SamplingConfig const& samplingConfig)
+{
+    // The fill kernel reads the request tensors, so they must be device accessible.
+    auto const isDeviceAccessible = [](ITensor const& tensor) { return tensor.getMemoryType() != MemoryType::kCPU; };
+    return samplingConfig.beamWidth == 1 && request.generatedTokensPerEngineStep == 1
+        && isDeviceAccessible(*request.ids) && (!request.embeddingBias || isDeviceAccessible(*request.embeddingBias));
+}
+
+void GptDecoderBatched::newRequestsBatched(std::vector<SizeType32> const& seqSlots,
+    std::vector<decoder_batch::Request const*> const& requests,
+    std::vector<SamplingConfig const*> const& samplingConfigs)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    auto& dJointInput = *mJointDecodingInput;
+    auto& dJointOutput = *mJointDecodingOutput;
+    auto const batchSize = dJointOutput.ids->getShape().d[0];
+
+    std::vector<kernels::BatchedFill> fills;
+    fills.reserve(requests.size() * (2 * mMaxDecodingEngineTokens + 8));
+    for (std::size_t ri = 0; ri < requests.size(); ++ri)
+    {
+        auto const batchSlot = seqSlots[ri];
+        auto const& request = *requests[ri];
+        auto const& samplingConfig = *samplingConfigs[ri];
+        TLLM_CHECK(0 <= batchSlot && batchSlot < batchSize);
+        TLLM_CHECK(request.ids->getDataType() == TRTDataType<TokenIdType>::value);
+        auto const inputLength = request.inputLen;
+        auto const maxNewTokens = request.maxNewTokens.value_or(mMaxSequenceLength - inputLength);
+        TLLM_CHECK_WITH_INFO(inputLength + maxNewTokens <= mMaxSequenceLength,
+            tc::fmtstr("Input length (%d) + max new tokens (%d) must be less than max sequence length (%d).",
+                inputLength, maxNewTokens, mMaxSequenceLength));
+        auto const endId = request.endId.value_or(-1);
+
+        // input
+        fills.push_back(fillSlot<TokenIdType>(dJointInput.endIds, batchSlot, endId));
+        fills.push_back(fillSlot<SizeType32>(dJointInput.sequenceLimitLength, batchSlot, inputLength + maxNewTokens));
+        fills.push_back(fillSlot<SizeType32>(dJointInput.lengths, batchSlot, inputLength));
+
+        auto const embeddingBiasSlice = ITensor::slice(constPointerCast(dJointInput.embeddingBias), batchSlot, 1);
+        auto const biasElementSize
+            = static_cast<std::uint32_t>(BufferDataType(embeddingBiasSlice->getDataType()).getSize());
+        auto const vocabSize = static_cast<std::uint32_t>(embeddingBiasSlice->getSize());
+        if (request.embeddingBias)
+        {
+            TLLM_CHECK(request.embeddingBias->getShape().nbDims == 2);
+            TLLM_CHECK(request.embeddingBias->getShape().d[0] == 1);
+            TLLM_CHECK_WITH_INFO(request.embeddingBias->getShape().d[1] == static_cast<SizeType32>(mVocabSize),
+                "The embedding bias shape is not as expected. Expected last dimension to be same as vocab size: %lu.",
+                mVocabSize);
+            TLLM_CHECK(request.embeddingBias->getDataType() == embeddingBiasSlice->getDataType());
+            fills.push_back(kernels::BatchedFill{embeddingBiasSlice->data(), request.embeddingBias->data(), vocabSize,
+                static_cast<std::uint32_t>(request.embeddingBias->getSize()), 0, biasElementSize});
+        }
+        else
+        {
+            fills.push_back(
+                kernels::BatchedFill{embeddingBiasSlice->data(), nullptr, vocabSize, 0, 0, biasElementSize});
+        }
+
+        setupWords(dJointInput.stopWordsLists, request.stopWordsList, dJointInput.stopWordsPtrs,
+            dJointInput.stopWordsLens, dJointInput.maxStopWordsLen, batchSlot);
+        setupWords(dJointInput.badWordsLists, request.badWordsList, dJointInput.badWordsPtrs, dJointInput.badWordsLens,
+            dJointInput.maxBadWordsLen, batchSlot);
+
+        // output
+        fills.push_back(fillSlot<SizeType32>(dJointOutput.finishedSum, batchSlot, 0));
+        for (SizeType32 ti = 0; ti < mMaxDecodingEngineTokens; ++ti)
+        {
+            TensorPtr newTokensStepView = ITensor::slice(dJointOutput.newTokensSteps, ti, 1);
+            newTokensStepView->squeeze(0);
+            fills.push_back(fillSlot<TokenIdType>(newTokensStepView, batchSlot, 0));
+
+            TensorPtr finishedStepsView = ITensor::slice(mFinishedSteps, ti, 1);
+            finishedStepsView->squeeze(0);
+            fills.push_back(fillSlot<tk::FinishedState::UnderlyingType>(finishedStepsView, batchSlot, 0));
+        }
+        if (samplingConfig.cumLogProbs.has_value() && samplingConfig.cumLogProbs->at(0))
+        {
+            fills.push_back(fillSlot<float>(dJointOutput.cumLogProbs, batchSlot, 0.F));
+        }
+        if (samplingConfig.outputLogProbs.has_value() && samplingConfig.outputLogProbs->at(0))
+        {
+            fills.push_back(fillSlot<float>(dJointOutput.logProbs, batchSlot, 0.F));
+        }
+
+        // copy the request ids into outputIds and pad them with endId
+        TensorPtr outputIds = ITensor::slice(dJointOutput.ids, batchSlot, 1);
+        fills.push_back(kernels::BatchedFill::create(bufferCast<TokenIdType>(*outputIds),
+            static_cast<std::size_t>(mMaxSequenceLength), endId, bufferCast<TokenIdType>(*request.ids),
+            request.ids->getSize()));
+
+        // remaining
+        mBeamWidths[batchSlot] = 1;
+        mNbSteps[batchSlot] = 0;
+        mFinished[batchSlot] = false;
+        mMaxNewTokens[batchSlot] = maxNewTokens;
+        mNumDecodingEngineTokens[batchSlot] = 1;
+    }
+
+    auto const maxNumElements = std::max_element(fills.begin(), fills.end(),
+        [](auto const& lhs, auto const& rhs) { return lhs.numElements < rhs.numElements; })->numElements;
+    auto const& stream = mDecoderStream;
+    BufferManager manager{stream};
+    // Allocated and freed in stream order, the copy from pageable memory has read fills when it returns
+    auto fillsDevice = manager.gpu(fills.size() * sizeof(kernels::BatchedFill), nvinfer1::DataType::kUINT8);
+    manager.copy(fills.data(), *fillsDevice, MemoryType::kCPU);
+    kernels::invokeBatchedFill(static_cast<kernels::BatchedFill const*>(fillsDevice->data()), fills.size(),
+        maxNumElements, *stream);
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 void GptDecoderBatched::newRequestSpeculativeDecoding(
     SizeType32 batchIdx, decoder_batch::Request const& request, SamplingConfig const& samplingConfig)
 {
@@ -612,7 +739,7 @@ void GptDecoderBatched::newRequestSpeculativeDecoding(
         }
     }
 
-    if (mSpeculativeDecodingMode.isDraftTokensExternal())
+    if (mSpeculativeDecodingMode.acceptsDraftTokensExternal())
     {
         newRequestDraftTokensExternal(batchIdx, request, samplingConfig);
     }
@@ -658,17 +785,17 @@ void GptDecoderBatched::newRequestDraftTokensExternal(
     TensorPtr draftTokensView = ITensor::view(request.draftTokens, ITensor::makeShape({numDraftTokens}));
     manager.copy(*draftTokensView, *draftTokensReqTokensSlice);
 
-    auto const curandStatesView = ITensor::slice(mCurandStates, batchIdx, 1);
-    auto curandState = reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*curandStatesView));
+    auto const randomStatesView = ITensor::slice(mRandomStates, batchIdx, 1);
+    auto randomState = reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*randomStatesView));
     auto batchSlotsPtr = bufferCast<SizeType32>(*ITensor::slice(mBatchSlotsSetup, 0, localBatchSize));
     if (samplingConfig.randomSeed.has_value())
     {
-        tk::invokeCurandInitialize(
-            curandState, batchSlotsPtr, localBatchSize, samplingConfig.randomSeed.value()[0], stream->get());
+        tk::invokeRandomStateInitialize(
+            randomState, batchSlotsPtr, localBatchSize, samplingConfig.randomSeed.value()[0], stream->get());
     }
     else
     {
-        tk::invokeCurandInitialize(curandState, batchSlotsPtr, localBatchSize, 0, stream->get());
+        tk::invokeRandomStateInitialize(randomState, batchSlotsPtr, localBatchSize, 0, stream->get());
     }
     auto numDraftTokensView = ITensor::slice(mNumDraftTokens, batchIdx, 1);
     kernels::invokeFill(*numDraftTokensView, numDraftTokens, *stream);
@@ -770,14 +897,32 @@ void GptDecoderBatched::newRequests(std::vector<SizeType32> const& seqSlots,
     std::vector<decoder_batch::Request> const& requests, std::vector<SamplingConfig> const& samplingConfigs)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_NVTX_SCOPED_RANGE(kDECODER, newRequests);
+    IterationProfiler::ScopedPhase const decoderSetupPhase{IterationPhase::kDECODER_SETUP};
 
     auto batchSlotsPtr = bufferCast<SizeType32>(*mBatchSlotsSetup);
     SizeType32 const localBatchSize = seqSlots.size();
+    std::vector<SizeType32> batchedSlots;
+    std::vector<decoder_batch::Request const*> batchedRequests;
+    std::vector<SamplingConfig const*> batchedSamplingConfigs;
     for (SizeType32 bi = 0; bi < localBatchSize; ++bi)
     {
-        newRequest(seqSlots[bi], requests[bi], samplingConfigs[bi]);
+        if (canSetupBatched(requests[bi], samplingConfigs[bi]))
+        {
+            batchedSlots.push_back(seqSlots[bi]);
+            batchedRequests.push_back(&requests[bi]);
+            batchedSamplingConfigs.push_back(&samplingConfigs[bi]);
+        }
+        else
+        {
+            newRequest(seqSlots[bi], requests[bi], samplingConfigs[bi]);
+        }
         batchSlotsPtr[bi] = seqSlots[bi];
     }
+    if (!batchedRequests.empty())
+    {
+        newRequestsBatched(batchedSlots, batchedRequests, batchedSamplingConfigs);
+    }
 
     TensorPtr batchSlotsView = ITensor::slice(mBatchSlotsSetup, 0, localBatchSize);
     auto samplingConfig = SamplingConfig(samplingConfigs);
@@ -791,24 +936,54 @@ void GptDecoderBatched::newRequests(std::vector<SizeType32> const& seqSlots,
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
-void GptDecoderBatched::forwardDispatch(
-    decoder_batch::Output& output, decoder_batch::Input const& input, ForwardType forwardType)
+void GptDecoderBatched::forwardDispatch(decoder_batch::Output& output, decoder_batch::Input const& input,
+    ForwardType forwardType, ITensor const* tokenBitmask)
 {
     auto const maxDecodingEngineTokens
         = *std::max_element(std::begin(mNumDecodingEngineTokens), std::end(mNumDecodingEngineTokens));
 
     for (SizeType32 si = 0; si < maxDecodingEngineTokens; si += mMaxDecodingDecoderTokens)
     {
-        forwardDecoder(si, output, input, forwardType);
+        forwardDecoder(si, output, input, forwardType, tokenBitmask);
     }
 }
 
 GptDecoderBatched::TokenPtr GptDecoderBatched::forwardAsync(
     decoder_batch::Output& output, decoder_batch::Input const& input)
+{
+    return forwardAsync(output, input, nullptr);
+}
+
+GptDecoderBatched::TokenPtr GptDecoderBatched::forwardAsync(decoder_batch::Output& output,
+    decoder_batch::Input const& input, TensorPtr const& tokenBitmask, DecoderStatusBlock* statusBlock,
+    OutputTokenRing const* outputTokenRing, TensorPtr const& outputTokenRingSeqs)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_NVTX_SCOPED_RANGE(kDECODER, forwardAsync);
 
-    forwardDispatch(output, input, ForwardType::kASYNC);
+    forwardDispatch(output, input, ForwardType::kASYNC, tokenBitmask.get());
+
+    if (statusBlock != nullptr)
+    {
+        // Behind the stop criteria of the step, read by the host while later steps run
+        statusBlock->enqueueWrite(*mJointDecodingOutput->finishedSum, *output.sequenceLengths, *mRuntimeStream);
+    }
+    if (outputTokenRing != nullptr)
+    {
+        TLLM_CHECK_WITH_INFO(outputTokenRingSeqs, "The output token rings need the request sequence numbers");
+        auto const& dJointInput = *mJointDecodingInput;
+        auto const& dJointOutput = *mJointDecodingOutput;
+        // The log probs are zero for requests that do not output them
+        outputTokenRing->enqueueWrite(*outputTokenRingSeqs, *dJointOutput.ids, *dJointInput.lengths,
+            *output.sequenceLengths, dJointOutput.logProbs.get(), *dJointOutput.finishReasons, *mRuntimeStream);
+    }
+    if (statusBlock != nullptr || outputTokenRing != nullptr)
+    {
+        // Slots are set up on the decoder stream, not before the snapshots of their previous requests are taken
+        CudaEvent snapshotEvent{};
+        mRuntimeStream->record(snapshotEvent);
+        mDecoderStream->wait(snapshotEvent);
+    }
 
     CudaEvent eventStop{};
     mRuntimeStream->record(eventStop);
@@ -816,8 +991,8 @@ GptDecoderBatched::TokenPtr GptDecoderBatched::forwardAsync(
     return std::make_unique<decoder_batch::Token>(std::move(eventStop), input.active);
 }
 
-void GptDecoderBatched::forwardDecoder(
-    SizeType32 step, decoder_batch::Output& output, decoder_batch::Input const& input, ForwardType forwardType)
+void GptDecoderBatched::forwardDecoder(SizeType32 step, decoder_batch::Output& output,
+    decoder_batch::Input const& input, ForwardType forwardType, ITensor const* tokenBitmask)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
 
@@ -929,7 +1104,30 @@ void GptDecoderBatched::forwardDecoder(
             /* [maxDecodingTokens, maxBatchSize] */ *mFinishedSteps,
             /* [bs] */ *batchSlotsAcceptLogitsSlice, static_cast<SizeType32>(mVocabSize),
             static_cast<SizeType32>(mVocabSizePadded), useRandomAcceptanceThreshold, randomAcceptanceThreshold,
-            reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*mCurandStates)), stream);
+            reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*mRandomStates)), stream);
+    }
+
+    if (tokenBitmask != nullptr && targetLogitsIdx > 0)
+    {
+        // Mask disallowed tokens in place before sampling. Rows of the bitmask are indexed by decoder slot.
+        auto const* bitmaskPtr = bufferCast<std::int32_t>(*tokenBitmask);
+        auto const* batchSlotsPtr = batchSlotsDecoderPtr + step * mActualBatchSize;
+        auto* logitsPtrs = bufferCast<int64_t>(*targetLogitsPtrsSlice);
+        auto const beamWidth = static_cast<SizeType32>(logitsVec.front()->getSize() / mVocabSizePadded);
+        auto const vocabSize = static_cast<SizeType32>(mVocabSize);
+        auto const vocabSizePadded = static_cast<SizeType32>(mVocabSizePadded);
+        switch (logitsVec.front()->getDataType())
+        {
+        case nvinfer1::DataType::kFLOAT:
+            tk::invokeApplyTokenBitmask(reinterpret_cast<float* const*>(logitsPtrs), bitmaskPtr, batchSlotsPtr,
+                targetLogitsIdx, beamWidth, vocabSize, vocabSizePadded, stream->get());
+            break;
+        case nvinfer1::DataType::kHALF:
+            tk::invokeApplyTokenBitmask(reinterpret_cast<half* const*>(logitsPtrs), bitmaskPtr, batchSlotsPtr,
+                targetLogitsIdx, beamWidth, vocabSize, vocabSizePadded, stream->get());
+            break;
+        default: TLLM_THROW("Token bitmask supports only float and half logits");
+        }
     }
 
     TensorPtr finishedStepsInput = ITensor::slice(mFinishedSteps, step, 1);
@@ -1035,23 +1233,61 @@ void GptDecoderBatched::updateFinished(decoder_batch::Token const& token)
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+void GptDecoderBatched::updateFinishedFromStatus(decoder_batch::Token const& token, DecoderStatusBlock& statusBlock)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    auto const issuedEpoch = statusBlock.getIssuedEpoch();
+    {
+        IterationProfiler::ScopedPhase const syncWaitPhase{IterationPhase::kSYNC_WAIT};
+        // The step of the token may still run, the one before it has almost always completed
+        statusBlock.waitFor(issuedEpoch > 1 ? issuedEpoch - 1 : 0);
+        statusBlock.poll();
+    }
+    for (std::int32_t i = 0; i < mActualBatchSize; ++i)
+    {
+        if (token.active[i] && !mFinished[i] && statusBlock.isCurrent(i))
+        {
+            mFinished[i] = statusBlock.getFinishedSum(i) == static_cast<SizeType32>(mBeamWidths[i]);
+        }
+    }
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 void GptDecoderBatched::forwardSync(decoder_batch::Token const& token)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
-    token.event.synchronize();
+    TLLM_NVTX_SCOPED_RANGE(kDECODER, forwardSync);
+    {
+        IterationProfiler::ScopedPhase const syncWaitPhase{IterationPhase::kSYNC_WAIT};
+        token.event.synchronize();
+    }
 
     updateFinished(token);
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+void GptDecoderBatched::forwardSync(decoder_batch::Token const& token, DecoderStatusBlock& statusBlock)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_NVTX_SCOPED_RANGE(kDECODER, forwardSync);
+
+    updateFinishedFromStatus(token, statusBlock);
+
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 void GptDecoderBatched::forwardSync(
     decoder_batch::Token const& token, decoder_batch::Output& output, decoder_batch::Input const& input)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
-    token.event.synchronize();
+    TLLM_NVTX_SCOPED_RANGE(kDECODER, forwardSync);
+    {
+        IterationProfiler::ScopedPhase const syncWaitPhase{IterationPhase::kSYNC_WAIT};
+        token.event.synchronize();
+    }
 
-    forwardDispatch(output, input, ForwardType::kSYNC);
+    forwardDispatch(output, input, ForwardType::kSYNC, nullptr);
 
     updateFinished(token);
 
@@ -1105,7 +1341,12 @@ CudaEvent GptDecoderBatched::postProcessRequest(
         // Thus, we need to make a copy of the beamHypotheses
         tensorrt_llm::kernels::invokeCopyBeamHypotheses(
             dOutput.beamHypotheses, *mOutputBeamHypotheses, *dOutput.cumLogProbs, *mCumLogProbsTmp, *stream, mNumSMs);
+        // The paths of the beams are only read by gatherTree and must persist across steps, so they are not copied
+        auto const beamPaths = dOutput.beamHypotheses;
         dOutput.beamHypotheses = *mOutputBeamHypotheses;
+        dOutput.beamHypotheses.pathIds = beamPaths.pathIds;
+        dOutput.beamHypotheses.pathBeams = beamPaths.pathBeams;
+        dOutput.beamHypotheses.pathLengths = beamPaths.pathLengths;
         dOutput.cumLogProbs = mCumLogProbsTmp;
     }
 
@@ -1252,6 +1493,7 @@ void GptDecoderBatched::forwardSync()
 void GptDecoderBatched::finalize(SamplingConfig const& samplingConfig) const
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_NVTX_SCOPED_RANGE(kDECODER, finalize);
     auto batchSlots = bufferCast<SizeType32>(*mBatchSlotsSetup);
     for (SizeType32 batchIdx = 0; batchIdx < mActualBatchSize; ++batchIdx)
     {
@@ -1265,6 +1507,7 @@ void GptDecoderBatched::finalize(SamplingConfig const& samplingConfig) const
 CudaEvent GptDecoderBatched::finalize(SizeType32 batchSlot, SamplingConfig const& samplingConfig, bool streaming) const
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_NVTX_SCOPED_RANGE(kDECODER, finalize);
     auto event = postProcessRequest(batchSlot, samplingConfig, streaming);
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
     return event;
@@ -109,12 +109,22 @@ GptSession::GptSession(Config const& sessionConfig, ModelConfig const& modelConf
     }
 }
 
+#if defined(_WIN32)
 GptSession::GptSession(Config const& sessionConfig, ModelConfig const& modelConfig, WorldConfig const& worldConfig,
     std::string const& engineFile, LoggerPtr logger)
     : GptSession(
         setPath(sessionConfig, engineFile), modelConfig, worldConfig, utils::loadEngine(engineFile), std::move(logger))
 {
 }
+#else
+// Map the engine instead of reading it into a private buffer, ranks on the same node share the page cache.
+GptSession::GptSession(Config const& sessionConfig, ModelConfig const& modelConfig, WorldConfig const& worldConfig,
+    std::string const& engineFile, LoggerPtr logger)
+    : GptSession(setPath(sessionConfig, engineFile), modelConfig, worldConfig,
+        RawEngine(std::make_shared<MappedFile const>(engineFile)), std::move(logger))
+{
+}
+#endif
 
 nvinfer1::ILogger& GptSession::getLogger() const
 {
@@ -212,8 +222,22 @@ void GptSession::createKvCacheManager(SizeType32 maxBatchSize, SizeType32 maxBea
 
     auto const kvDtype = mModelConfig.getKvDataType();
 
-    auto const [blocksInPrimaryPool, blocksInSecondaryPool] = bmkv::KVCacheManager::calculateMaxNumBlocks(
+    auto [blocksInPrimaryPool, blocksInSecondaryPool] = bmkv::KVCacheManager::calculateMaxNumBlocks(
         kvCacheConfig, kvDtype, mModelConfig, mWorldConfig, getBufferManager());
+    // The pools hold kv cache rows of getKvCacheSizePerHead() elements, e.g. packed INT4 values and their scales.
+    auto const sizePerHead = mModelConfig.getKvCacheSizePerHead();
+    if (sizePerHead != mModelConfig.getSizePerHead())
+    {
+        auto const scaleNumBlocks = [&](SizeType32 numBlocks)
+        {
+            auto const numBytes = static_cast<int64_t>(numBlocks) * mModelConfig.getSizePerHead();
+            return static_cast<SizeType32>(numBytes / sizePerHead);
+        };
+        blocksInPrimaryPool = scaleNumBlocks(blocksInPrimaryPool);
+        blocksInSecondaryPool = scaleNumBlocks(blocksInSecondaryPool);
+        TLLM_LOG_INFO("Kv cache rows of %d elements per head: %d blocks in the primary pool.", sizePerHead,
+            blocksInPrimaryPool);
+    }
 
     // If maxBeamWidth > 1, use one more block for each sequence in the paged kv cache to avoid dropping the needed
     // tokens, when enabling cyclic kv cache.
@@ -221,7 +245,6 @@ void GptSession::createKvCacheManager(SizeType32 maxBatchSize, SizeType32 maxBea
 
     auto const localNbLayers = mModelConfig.getNbAttentionLayers(mWorldConfig.getPipelineParallelism());
     auto const nbKvHeads = mModelConfig.getNbKvHeads();
-    auto const sizePerHead = mModelConfig.getSizePerHead();
     bool constexpr enableBlockReuse{false};
     bool enableDiffMaxAttenWin = false;
     for (SizeType32 maxAttenWin : mDecoderMaxAttentionWindowVec)
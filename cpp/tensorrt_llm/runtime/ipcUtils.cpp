@@ -22,7 +22,13 @@
 #include "tensorrt_llm/common/workspace.h"
 
 #include <NvInferRuntimeBase.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
 #include <cstddef>
+#include <cstring>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 namespace tensorrt_llm::runtime
 {
@@ -55,13 +61,37 @@ bool canAccessPeer(WorldConfig const& worldConfig)
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
     return true;
 }
+
+void checkDriverCall(CUresult result, common::CUDADriverWrapper const& driver, char const* call)
+{
+    if (result != CUDA_SUCCESS)
+    {
+        char const* name = nullptr;
+        driver.cuGetErrorName(result, &name);
+        TLLM_THROW("%s failed: %s", call, name != nullptr ? name : "unknown error");
+    }
+}
 } // namespace
 
+SizeType32 IpcMemory::getNodeGroupSize(WorldConfig const& worldConfig)
+{
+    auto const tpSize = worldConfig.getTensorParallelism();
+    auto const gpusPerNode = worldConfig.getGpusPerNode();
+    if (tpSize <= gpusPerNode)
+    {
+        return tpSize;
+    }
+    // The ranks are laid out node by node, so a group spanning whole nodes has gpusPerNode consecutive TP ranks on
+    // every node.
+    return tpSize % gpusPerNode == 0 ? gpusPerNode : 0;
+}
+
 IpcMemory::IpcMemory(std::size_t bufferSize, BufferManager const& manager, WorldConfig const& worldConfig, bool openIpc)
-    : mTpRank(worldConfig.getTensorParallelRank())
-    , mCommPtrs(worldConfig.getTensorParallelism())
 {
-    mOpenIpc = openIpc && worldConfig.getTensorParallelism() <= worldConfig.getGpusPerNode();
+    auto const nodeGroupSize = getNodeGroupSize(worldConfig);
+    mOpenIpc = openIpc && nodeGroupSize > 0;
+    mCommPtrs.resize(nodeGroupSize > 0 ? nodeGroupSize : worldConfig.getTensorParallelism());
+    mNodeRank = worldConfig.getTensorParallelRank() % static_cast<SizeType32>(mCommPtrs.size());
     if (mOpenIpc)
     {
         allocateIpcMemory(bufferSize, manager, worldConfig);
@@ -88,12 +118,16 @@ void IpcMemory::allocateIpcMemory(std::size_t bufferSize, BufferManager const& m
     cudaIpcMemHandle_t localHandle;
     TLLM_CUDA_CHECK(cudaIpcGetMemHandle(&localHandle, bufferPtr));
 
-    auto const ppRank = worldConfig.getPipelineParallelRank();
-    auto const comm = COMM_SESSION.split(ppRank, mTpRank);
-    std::vector<char> serialHandles(CUDA_IPC_HANDLE_SIZE * worldConfig.getTensorParallelism(), 0);
+    // One communicator per node part of every tensor parallel group.
+    auto const nodeGroupSize = static_cast<SizeType32>(mCommPtrs.size());
+    auto const tpRank = worldConfig.getTensorParallelRank();
+    auto const color
+        = worldConfig.getPipelineParallelRank() * worldConfig.getTensorParallelism() + tpRank / nodeGroupSize;
+    auto const comm = COMM_SESSION.split(color, mNodeRank);
+    std::vector<char> serialHandles(CUDA_IPC_HANDLE_SIZE * nodeGroupSize, 0);
     comm.allgather(&localHandle.reserved, serialHandles.data(), CUDA_IPC_HANDLE_SIZE, mpi::MpiType::kBYTE);
 
-    std::vector<cudaIpcMemHandle_t> handles(worldConfig.getTensorParallelism());
+    std::vector<cudaIpcMemHandle_t> handles(nodeGroupSize);
     for (size_t i = 0; i < handles.size(); ++i)
     {
         memcpy(handles[i].reserved, &serialHandles[i * CUDA_IPC_HANDLE_SIZE], CUDA_IPC_HANDLE_SIZE);
@@ -101,7 +135,7 @@ void IpcMemory::allocateIpcMemory(std::size_t bufferSize, BufferManager const& m
 
     for (std::size_t nodeId = 0; nodeId < handles.size(); nodeId++)
     {
-        if (nodeId == static_cast<std::size_t>(mTpRank))
+        if (nodeId == static_cast<std::size_t>(mNodeRank))
         {
             mCommPtrs.at(nodeId) = bufferPtr;
         }
@@ -130,7 +164,7 @@ void IpcMemory::destroyIpcMemory()
 
     for (std::size_t nodeId = 0; nodeId < mCommPtrs.size(); ++nodeId)
     {
-        if (nodeId != static_cast<std::size_t>(mTpRank))
+        if (nodeId != static_cast<std::size_t>(mNodeRank))
         {
             TLLM_CUDA_CHECK(cudaIpcCloseMemHandle(mCommPtrs.at(nodeId)));
         }
@@ -138,6 +172,160 @@ void IpcMemory::destroyIpcMemory()
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
+bool IpcMulticastMemory::isSupported(WorldConfig const& worldConfig)
+{
+    auto const tpSize = worldConfig.getTensorParallelism();
+    if (tpSize <= 1 || tpSize > worldConfig.getGpusPerNode())
+    {
+        return false;
+    }
+
+    int localSupport = 0;
+#if defined(SYS_pidfd_open) && defined(SYS_pidfd_getfd)
+    // The multicast handle is shared as a file descriptor, which the other processes fetch with pidfd_getfd.
+    if (common::getSMVersion() >= 90)
+    {
+        auto const driver = common::CUDADriverWrapper::getInstance();
+        int multicastSupported = 0;
+        localSupport = driver->cuDeviceGetAttribute(
+                           &multicastSupported, CU_DEVICE_ATTRIBUTE_MULTICAST_SUPPORTED, worldConfig.getDevice())
+                == CUDA_SUCCESS
+            && multicastSupported != 0;
+    }
+#endif
+
+    auto const comm = COMM_SESSION.split(worldConfig.getPipelineParallelRank(), worldConfig.getTensorParallelRank());
+    int groupSupport = 0;
+    comm.allreduce(&localSupport, &groupSupport, 1, mpi::MpiType::kINT32, mpi::MpiOp::MIN);
+    return groupSupport != 0;
+}
+
+IpcMulticastMemory::IpcMulticastMemory(std::size_t bufferSize, WorldConfig const& worldConfig)
+    : mDriver(common::CUDADriverWrapper::getInstance())
+    , mDevice(worldConfig.getDevice())
+{
+    allocateMulticastMemory(bufferSize, worldConfig);
+}
+
+void IpcMulticastMemory::allocateMulticastMemory(std::size_t bufferSize, WorldConfig const& worldConfig)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+#if defined(SYS_pidfd_open) && defined(SYS_pidfd_getfd)
+    auto const tpSize = worldConfig.getTensorParallelism();
+    auto const tpRank = worldConfig.getTensorParallelRank();
+    auto const comm = COMM_SESSION.split(worldConfig.getPipelineParallelRank(), tpRank);
+
+    CUmulticastObjectProp mcProp{};
+    mcProp.numDevices = tpSize;
+    mcProp.handleTypes = CU_MEM_HANDLE_TYPE_POSIX_FILE_DESCRIPTOR;
+    CUmemAllocationProp ucProp{};
+    ucProp.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+    ucProp.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    ucProp.location.id = mDevice;
+    ucProp.requestedHandleTypes = CU_MEM_HANDLE_TYPE_POSIX_FILE_DESCRIPTOR;
+
+    // The recommended multicast granularity is hundreds of MB, the minimal one is enough for the message sizes here.
+    std::size_t mcGranularity{0};
+    std::size_t ucGranularity{0};
+    checkDriverCall(mDriver->cuMulticastGetGranularity(&mcGranularity, &mcProp, CU_MULTICAST_GRANULARITY_MINIMUM),
+        *mDriver, "cuMulticastGetGranularity");
+    checkDriverCall(
+        mDriver->cuMemGetAllocationGranularity(&ucGranularity, &ucProp, CU_MEM_ALLOC_GRANULARITY_MINIMUM), *mDriver,
+        "cuMemGetAllocationGranularity");
+    mSize = common::alignSize(bufferSize, std::max(mcGranularity, ucGranularity));
+    mcProp.size = mSize;
+
+    // Rank 0 creates the multicast object, the other ranks import it from the file descriptor of rank 0.
+    int fd{-1};
+    if (tpRank == 0)
+    {
+        checkDriverCall(mDriver->cuMulticastCreate(&mMcHandle, &mcProp), *mDriver, "cuMulticastCreate");
+        checkDriverCall(
+            mDriver->cuMemExportToShareableHandle(&fd, mMcHandle, CU_MEM_HANDLE_TYPE_POSIX_FILE_DESCRIPTOR, 0),
+            *mDriver, "cuMemExportToShareableHandle");
+    }
+    std::array<int64_t, 2> pidAndFd{static_cast<int64_t>(getpid()), fd};
+    comm.bcast(pidAndFd.data(), pidAndFd.size(), mpi::MpiType::kINT64, 0);
+    if (tpRank != 0)
+    {
+        auto const pidFd = static_cast<int>(syscall(SYS_pidfd_open, static_cast<pid_t>(pidAndFd[0]), 0));
+        TLLM_CHECK_WITH_INFO(pidFd >= 0, "pidfd_open failed: %s", std::strerror(errno));
+        auto const peerFd = static_cast<int>(syscall(SYS_pidfd_getfd, pidFd, static_cast<int>(pidAndFd[1]), 0));
+        TLLM_CHECK_WITH_INFO(peerFd >= 0, "pidfd_getfd failed: %s", std::strerror(errno));
+        checkDriverCall(mDriver->cuMemImportFromShareableHandle(&mMcHandle,
+                            reinterpret_cast<void*>(static_cast<uintptr_t>(peerFd)),
+                            CU_MEM_HANDLE_TYPE_POSIX_FILE_DESCRIPTOR),
+            *mDriver, "cuMemImportFromShareableHandle");
+        close(peerFd);
+        close(pidFd);
+    }
+    // Rank 0 keeps its descriptor open until every rank has fetched it.
+    comm.barrier();
+    if (tpRank == 0)
+    {
+        close(fd);
+    }
+
+    // Every device must be added to the multicast object before any memory is bound to it.
+    checkDriverCall(mDriver->cuMulticastAddDevice(mMcHandle, mDevice), *mDriver, "cuMulticastAddDevice");
+    comm.barrier();
+
+    CUmemAccessDesc accessDesc{};
+    accessDesc.location = ucProp.location;
+    accessDesc.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
+
+    checkDriverCall(mDriver->cuMemCreate(&mUcHandle, mSize, &ucProp, 0), *mDriver, "cuMemCreate");
+    checkDriverCall(
+        mDriver->cuMemAddressReserve(&mUcPtr, mSize, ucGranularity, 0, 0), *mDriver, "cuMemAddressReserve");
+    checkDriverCall(mDriver->cuMemMap(mUcPtr, mSize, 0, mUcHandle, 0), *mDriver, "cuMemMap");
+    checkDriverCall(mDriver->cuMemSetAccess(mUcPtr, mSize, &accessDesc, 1), *mDriver, "cuMemSetAccess");
+
+    checkDriverCall(
+        mDriver->cuMulticastBindMem(mMcHandle, 0, mUcHandle, 0, mSize, 0), *mDriver, "cuMulticastBindMem");
+    checkDriverCall(
+        mDriver->cuMemAddressReserve(&mMcPtr, mSize, mcGranularity, 0, 0), *mDriver, "cuMemAddressReserve");
+    checkDriverCall(mDriver->cuMemMap(mMcPtr, mSize, 0, mMcHandle, 0), *mDriver, "cuMemMap");
+    checkDriverCall(mDriver->cuMemSetAccess(mMcPtr, mSize, &accessDesc, 1), *mDriver, "cuMemSetAccess");
+    TLLM_CUDA_CHECK(cudaMemset(getUnicastPtr(), 0, mSize));
+
+    // The multicast object is usable once the memory of every device is bound.
+    comm.barrier();
+#else
+    TLLM_THROW("Multicast memory needs pidfd_getfd to share its handle");
+#endif
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+IpcMulticastMemory::~IpcMulticastMemory()
+{
+    destroyMulticastMemory();
+}
+
+void IpcMulticastMemory::destroyMulticastMemory()
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    if (mMcPtr != 0)
+    {
+        cuErrCheck(mDriver->cuMemUnmap(mMcPtr, mSize), mDriver);
+        cuErrCheck(mDriver->cuMemAddressFree(mMcPtr, mSize), mDriver);
+    }
+    if (mUcPtr != 0)
+    {
+        cuErrCheck(mDriver->cuMulticastUnbind(mMcHandle, mDevice, 0, mSize), mDriver);
+        cuErrCheck(mDriver->cuMemUnmap(mUcPtr, mSize), mDriver);
+        cuErrCheck(mDriver->cuMemAddressFree(mUcPtr, mSize), mDriver);
+    }
+    if (mUcHandle != 0)
+    {
+        cuErrCheck(mDriver->cuMemRelease(mUcHandle), mDriver);
+    }
+    if (mMcHandle != 0)
+    {
+        cuErrCheck(mDriver->cuMemRelease(mMcHandle), mDriver);
+    }
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
 AllReduceBuffers::AllReduceBuffers(SizeType32 maxBatchSize, SizeType32 maxBeamWidth, SizeType32 maxSequenceLength,
     SizeType32 hiddenSize, BufferManager const& manager, WorldConfig const& worldConfig)
 {
@@ -145,10 +333,12 @@ AllReduceBuffers::AllReduceBuffers(SizeType32 maxBatchSize, SizeType32 maxBeamWi
     auto const isP2pSupported = canAccessPeer(worldConfig);
 
     auto const tpSize = worldConfig.getTensorParallelism();
-    auto const bufferSize = tpSize
-        * std::min(
-            static_cast<std::size_t>(maxBatchSize) * maxBeamWidth * maxSequenceLength * hiddenSize * sizeof(float),
-            utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(tpSize));
+    auto const messageSize = std::min(
+        static_cast<std::size_t>(maxBatchSize) * maxBeamWidth * maxSequenceLength * hiddenSize * sizeof(float),
+        utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(tpSize));
+    // When the group spans nodes, only the ranks of a node share buffers, for the HIERARCHICAL strategy.
+    auto const nodeGroupSize = IpcMemory::getNodeGroupSize(worldConfig);
+    auto const bufferSize = std::max(nodeGroupSize, 1) * messageSize;
     auto const flagsSize = IpcMemory::FLAGS_SIZE * tpSize * 2;
 
     for (auto size : {bufferSize, bufferSize, flagsSize, flagsSize})
@@ -156,17 +346,29 @@ AllReduceBuffers::AllReduceBuffers(SizeType32 maxBatchSize, SizeType32 maxBeamWi
         mIpcMemoryHandles.emplace_back(size, manager, worldConfig, isP2pSupported);
     }
 
-    mAllReduceCommPtrs
-        = BufferManager::cpu(ITensor::makeShape({static_cast<SizeType32>(mIpcMemoryHandles.size()) * tpSize + 1}),
-            nvinfer1::DataType::kINT64);
+    // The NVLS kernel synchronizes through the flags above, so it needs peer access as well.
+    auto const isMulticastSupported = IpcMulticastMemory::isSupported(worldConfig);
+    if (isP2pSupported && isMulticastSupported)
+    {
+        mMulticastMemory = std::make_unique<IpcMulticastMemory>(messageSize, worldConfig);
+    }
+
+    auto const numNvlsPointers = utils::customAllReduceUtils::NUM_NVLS_POINTERS;
+    mAllReduceCommPtrs = BufferManager::cpu(
+        ITensor::makeShape(
+            {static_cast<SizeType32>(mIpcMemoryHandles.size() * tpSize + 1 + numNvlsPointers)}),
+        nvinfer1::DataType::kINT64);
     auto commPtrs = BufferRange<void*>(*mAllReduceCommPtrs);
-    auto const flagPtr = static_cast<int64_t*>(mAllReduceCommPtrs->data(mAllReduceCommPtrs->getSize() - 1));
+    std::fill(commPtrs.begin(), commPtrs.end(), nullptr);
+    auto const flagPtr = static_cast<int64_t*>(mAllReduceCommPtrs->data(mIpcMemoryHandles.size() * tpSize));
     *flagPtr = 0;
+    flagPtr[1] = reinterpret_cast<int64_t>(mMulticastMemory ? mMulticastMemory->getUnicastPtr() : nullptr);
+    flagPtr[2] = reinterpret_cast<int64_t>(mMulticastMemory ? mMulticastMemory->getMulticastPtr() : nullptr);
 
     for (std::size_t memIdx = 0; memIdx < mIpcMemoryHandles.size(); memIdx++)
     {
         auto const& memCommPtrs = mIpcMemoryHandles[memIdx].getCommPtrs();
-        TLLM_CHECK(memCommPtrs.size() == static_cast<std::size_t>(tpSize));
+        TLLM_CHECK(memCommPtrs.size() <= static_cast<std::size_t>(tpSize));
         std::copy(memCommPtrs.begin(), memCommPtrs.end(), commPtrs.begin() + memIdx * tpSize);
     }
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
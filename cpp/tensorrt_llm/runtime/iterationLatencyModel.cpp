@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/iterationLatencyModel.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+// Small ridge term that keeps the system solvable while a feature has not varied yet
+double constexpr kRegularization = 1e-6;
+} // namespace
+
+IterationLatencyModel::IterationLatencyModel(double decay, SizeType32 minNumSamples)
+    : mDecay{decay}
+    , mMinNumSamples{minNumSamples}
+{
+    TLLM_CHECK_WITH_INFO(decay > 0.0 && decay <= 1.0, "decay must be in (0, 1], got %f", decay);
+    TLLM_CHECK_WITH_INFO(minNumSamples >= kNumFeatures, "minNumSamples must be at least %d", kNumFeatures);
+}
+
+void IterationLatencyModel::update(SizeType32 numCtxTokens, SizeType32 numGenTokens, double latencyMs)
+{
+    std::array<double, kNumFeatures> const x{1.0, static_cast<double>(numCtxTokens), static_cast<double>(numGenTokens)};
+    for (int i = 0; i < kNumFeatures; ++i)
+    {
+        for (int j = 0; j < kNumFeatures; ++j)
+        {
+            mXtX[i][j] = mDecay * mXtX[i][j] + x[i] * x[j];
+        }
+        mXtY[i] = mDecay * mXtY[i] + x[i] * latencyMs;
+    }
+    ++mNumSamples;
+}
+
+std::optional<IterationLatencyModel::Coefficients> IterationLatencyModel::getCoefficients() const
+{
+    if (mNumSamples < mMinNumSamples)
+    {
+        return std::nullopt;
+    }
+
+    // Gaussian elimination with partial pivoting on the normal equations
+    auto a = mXtX;
+    auto b = mXtY;
+    for (int i = 0; i < kNumFeatures; ++i)
+    {
+        a[i][i] += kRegularization * std::max(1.0, a[i][i]);
+    }
+    for (int col = 0; col < kNumFeatures; ++col)
+    {
+        int pivot = col;
+        for (int row = col + 1; row < kNumFeatures; ++row)
+        {
+            if (std::abs(a[row][col]) > std::abs(a[pivot][col]))
+            {
+                pivot = row;
+            }
+        }
+        if (std::abs(a[pivot][col]) < 1e-12)
+        {
+            return std::nullopt;
+        }
+        std::swap(a[col], a[pivot]);
+        std::swap(b[col], b[pivot]);
+        for (int row = col + 1; row < kNumFeatures; ++row)
+        {
+            auto const factor = a[row][col] / a[col][col];
+            for (int k = col; k < kNumFeatures; ++k)
+            {
+                a[row][k] -= factor * a[col][k];
+            }
+            b[row] -= factor * b[col];
+        }
+    }
+    std::array<double, kNumFeatures> coef{};
+    for (int row = kNumFeatures - 1; row >= 0; --row)
+    {
+        auto sum = b[row];
+        for (int k = row + 1; k < kNumFeatures; ++k)
+        {
+            sum -= a[row][k] * coef[k];
+        }
+        coef[row] = sum / a[row][row];
+    }
+    return Coefficients{coef[0], coef[1], coef[2]};
+}
+
+std::optional<double> IterationLatencyModel::predictMs(SizeType32 numCtxTokens, SizeType32 numGenTokens) const
+{
+    auto const coef = getCoefficients();
+    if (!coef)
+    {
+        return std::nullopt;
+    }
+    return coef->baseMs + coef->perCtxTokenMs * numCtxTokens + coef->perGenTokenMs * numGenTokens;
+}
+
+SizeType32 IterationLatencyModel::getContextTokenBudget(
+    double targetLatencyMs, SizeType32 numGenTokens, SizeType32 minBudget, SizeType32 maxBudget) const
+{
+    TLLM_CHECK_WITH_INFO(minBudget <= maxBudget, "minBudget %d exceeds maxBudget %d", minBudget, maxBudget);
+    auto const coef = getCoefficients();
+    if (!coef || coef->perCtxTokenMs <= 0.0)
+    {
+        return maxBudget;
+    }
+    auto const remainingMs = targetLatencyMs - coef->baseMs - coef->perGenTokenMs * numGenTokens;
+    auto const budget = std::floor(remainingMs / coef->perCtxTokenMs);
+    return static_cast<SizeType32>(
+        std::clamp(budget, static_cast<double>(minBudget), static_cast<double>(maxBudget)));
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <array>
+#include <optional>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Online linear model of the iteration latency as a function of the scheduled tokens.
+//! \details Fits latency = base + perCtxToken * numCtxTokens + perGenToken * numGenTokens by exponentially weighted
+//! least squares, so the model follows changes of the workload. It is used to pick the context token budget of an
+//! iteration from a target iteration latency.
+class IterationLatencyModel
+{
+public:
+    struct Coefficients
+    {
+        double baseMs;
+        double perCtxTokenMs;
+        double perGenTokenMs;
+    };
+
+    //! \param decay Weight of the past observations at each update, in (0, 1].
+    //! \param minNumSamples Number of observations before the model is used.
+    explicit IterationLatencyModel(double decay = 0.98, SizeType32 minNumSamples = 8);
+
+    //! \brief Record the measured latency of an iteration, e.g. IterationStats::iterLatencyMS.
+    void update(SizeType32 numCtxTokens, SizeType32 numGenTokens, double latencyMs);
+
+    //! \brief The fitted coefficients. Not set before minNumSamples observations or if the fit is degenerate.
+    [[nodiscard]] std::optional<Coefficients> getCoefficients() const;
+
+    [[nodiscard]] std::optional<double> predictMs(SizeType32 numCtxTokens, SizeType32 numGenTokens) const;
+
+    //! \brief Number of context tokens that keeps the iteration within targetLatencyMs, clamped to
+    //! [minBudget, maxBudget]. Returns maxBudget, i.e. the static budget, until the model is usable.
+    [[nodiscard]] SizeType32 getContextTokenBudget(
+        double targetLatencyMs, SizeType32 numGenTokens, SizeType32 minBudget, SizeType32 maxBudget) const;
+
+    [[nodiscard]] SizeType32 getNumSamples() const noexcept
+    {
+        return mNumSamples;
+    }
+
+private:
+    static auto constexpr kNumFeatures = 3;
+
+    double mDecay;
+    SizeType32 mMinNumSamples;
+    SizeType32 mNumSamples{0};
+    // Weighted sums of x * x^T and x * y over the observations
+    std::array<std::array<double, kNumFeatures>, kNumFeatures> mXtX{};
+    std::array<double, kNumFeatures> mXtY{};
+};
+
+} // namespace tensorrt_llm::runtime
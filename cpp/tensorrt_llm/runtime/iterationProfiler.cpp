@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/iterationProfiler.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+double toMilliseconds(IterationProfiler::Clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+} // namespace
+
+IterationProfiler& IterationProfiler::getInstance()
+{
+    static IterationProfiler profiler;
+    return profiler;
+}
+
+char const* IterationProfiler::getPhaseName(IterationPhase phase)
+{
+    switch (phase)
+    {
+    case IterationPhase::kREQUEST_FETCH: return "request_fetch";
+    case IterationPhase::kSCHEDULING: return "scheduling";
+    case IterationPhase::kKV_ALLOCATION: return "kv_allocation";
+    case IterationPhase::kINPUT_PREPARATION: return "input_preparation";
+    case IterationPhase::kDECODER_SETUP: return "decoder_setup";
+    case IterationPhase::kSYNC_WAIT: return "sync_wait";
+    case IterationPhase::kRESPONSE: return "response";
+    }
+    TLLM_THROW("Unknown iteration phase %d", static_cast<int>(phase));
+}
+
+void IterationProfiler::begin(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    mPhaseTimesMs.fill(0.0);
+    mBegin = now;
+    mGpuRecorded = false;
+    mDraftRecorded = false;
+}
+
+void IterationProfiler::record(IterationPhase phase, Clock::time_point start, Clock::time_point end)
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    mPhaseTimesMs[static_cast<std::size_t>(phase)] += toMilliseconds(end - start);
+}
+
+void IterationProfiler::recordGpuStart(CudaStream const& stream)
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    if (!mGpuStart)
+    {
+        mGpuStart.emplace(cudaEventDefault);
+        mGpuStop.emplace(cudaEventDefault);
+    }
+    stream.record(*mGpuStart);
+    mGpuRecorded = false;
+}
+
+void IterationProfiler::recordGpuStop(CudaStream const& stream)
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    TLLM_CHECK_WITH_INFO(mGpuStop.has_value(), "recordGpuStart must be called before recordGpuStop");
+    stream.record(*mGpuStop);
+    mGpuRecorded = true;
+}
+
+void IterationProfiler::recordDraftStart(CudaStream const& stream)
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    if (!mDraftStart)
+    {
+        mDraftStart.emplace(cudaEventDefault);
+        mDraftStop.emplace(cudaEventDefault);
+    }
+    stream.record(*mDraftStart);
+    mDraftRecorded = false;
+}
+
+void IterationProfiler::recordDraftStop(CudaStream const& stream)
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    TLLM_CHECK_WITH_INFO(mDraftStop.has_value(), "recordDraftStart must be called before recordDraftStop");
+    stream.record(*mDraftStop);
+    mDraftRecorded = true;
+}
+
+std::optional<float> IterationProfiler::queryElapsedMs(CudaEvent const& start, CudaEvent const& stop)
+{
+    auto const status = cudaEventQuery(stop.get());
+    if (status == cudaErrorNotReady)
+    {
+        return std::nullopt;
+    }
+    TLLM_CUDA_CHECK(status);
+    float milliseconds{0.F};
+    TLLM_CUDA_CHECK(cudaEventElapsedTime(&milliseconds, start.get(), stop.get()));
+    return milliseconds;
+}
+
+IterationBreakdown IterationProfiler::end(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    TLLM_CHECK_WITH_INFO(mBegin.has_value(), "begin must be called before end");
+    IterationBreakdown breakdown;
+    breakdown.phaseTimesMs = mPhaseTimesMs;
+    auto const busyMs = toMilliseconds(now - *mBegin) - breakdown.getPhaseTimeMs(IterationPhase::kSYNC_WAIT);
+    breakdown.hostOverheadMs = std::max(busyMs, 0.0);
+    if (mGpuRecorded)
+    {
+        breakdown.gpuTimeMs = queryElapsedMs(*mGpuStart, *mGpuStop);
+    }
+    mBegin.reset();
+    return breakdown;
+}
+
+std::optional<float> IterationProfiler::getDraftGpuTimeMs() const
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    return mDraftRecorded ? queryElapsedMs(*mDraftStart, *mDraftStop) : std::nullopt;
+}
+
+double IterationProfiler::getPhaseTimeMs(IterationPhase phase) const
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    return mPhaseTimesMs[static_cast<std::size_t>(phase)];
+}
+
+} // namespace tensorrt_llm::runtime
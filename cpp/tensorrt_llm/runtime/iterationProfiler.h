@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Host phases of an executor iteration.
+enum class IterationPhase : std::int8_t
+{
+    //! Fetching new requests from the queue and broadcasting them to the other ranks
+    kREQUEST_FETCH,
+    //! Capacity and micro batch scheduling
+    kSCHEDULING,
+    //! Allocating KV cache blocks for the scheduled requests
+    kKV_ALLOCATION,
+    //! Filling the input buffers of the engine
+    kINPUT_PREPARATION,
+    //! Setting up the decoder for new requests
+    kDECODER_SETUP,
+    //! Waiting for the GPU, e.g. on the event of the decoder
+    kSYNC_WAIT,
+    //! Building and enqueueing the responses
+    kRESPONSE,
+};
+
+std::size_t constexpr kNUM_ITERATION_PHASES = static_cast<std::size_t>(IterationPhase::kRESPONSE) + 1;
+
+//! \brief Host phases and GPU time of an executor iteration, see IterationProfiler::end.
+struct IterationBreakdown
+{
+    //! Host time of every phase in milliseconds, indexed by IterationPhase
+    std::array<double, kNUM_ITERATION_PHASES> phaseTimesMs{};
+    //! Wall time in milliseconds not spent in kSYNC_WAIT
+    double hostOverheadMs{0.0};
+    //! GPU time in milliseconds of the forward and decoding. Not set if no GPU work was recorded or its stop event
+    //! had not completed.
+    std::optional<float> gpuTimeMs;
+
+    [[nodiscard]] double getPhaseTimeMs(IterationPhase phase) const
+    {
+        return phaseTimesMs[static_cast<std::size_t>(phase)];
+    }
+};
+
+//! \brief Breaks the wall time of an executor iteration into host phases and the GPU time of its forward.
+//! \details The iteration is bracketed by begin and end. In between, the executor loop and the components it calls
+//! time their phases with ScopedPhase and the forward with recordGpuStart and recordGpuStop. The host overhead is the
+//! wall time not spent in kSYNC_WAIT: when it approaches the GPU time, the iteration is CPU bound. The profiler of
+//! the process is a singleton, as the decoder that waits for the GPU is created apart from the executor loop.
+class IterationProfiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t kNUM_PHASES = kNUM_ITERATION_PHASES;
+
+    //! \brief Times a phase from construction to destruction.
+    class ScopedPhase
+    {
+    public:
+        explicit ScopedPhase(IterationPhase phase, IterationProfiler& profiler = getInstance())
+            : mProfiler{profiler}
+            , mPhase{phase}
+            , mStart{Clock::now()}
+        {
+        }
+
+        ~ScopedPhase()
+        {
+            mProfiler.record(mPhase, mStart, Clock::now());
+        }
+
+        ScopedPhase(ScopedPhase const&) = delete;
+        ScopedPhase& operator=(ScopedPhase const&) = delete;
+
+    private:
+        IterationProfiler& mProfiler;
+        IterationPhase mPhase;
+        Clock::time_point mStart;
+    };
+
+    static IterationProfiler& getInstance();
+
+    //! \brief Name of a phase, e.g. "kv_allocation".
+    [[nodiscard]] static char const* getPhaseName(IterationPhase phase);
+
+    //! \brief Start an iteration, clearing the phases of the previous one.
+    void begin(Clock::time_point now = Clock::now());
+
+    void record(IterationPhase phase, Clock::time_point start, Clock::time_point end);
+
+    //! \brief Bracket the GPU work of the iteration on stream. The events are created on first use.
+    void recordGpuStart(CudaStream const& stream);
+    void recordGpuStop(CudaStream const& stream);
+
+    //! \brief Bracket the draft token generation of the iteration that runs apart from the target forward, e.g. the
+    //! draft model steps, within the GPU work.
+    void recordDraftStart(CudaStream const& stream);
+    void recordDraftStop(CudaStream const& stream);
+
+    //! \brief GPU time of the draft bracket of the current iteration, without blocking. Not set if the iteration
+    //! recorded no draft work or its stop event has not completed yet.
+    [[nodiscard]] std::optional<float> getDraftGpuTimeMs() const;
+
+    //! \brief End the iteration and return its breakdown.
+    //! \details The GPU time is read without blocking: it is not set if the stop event has not completed yet, which
+    //! only happens when the iteration did not wait for its forward.
+    [[nodiscard]] IterationBreakdown end(Clock::time_point now = Clock::now());
+
+    [[nodiscard]] double getPhaseTimeMs(IterationPhase phase) const;
+
+private:
+    [[nodiscard]] static std::optional<float> queryElapsedMs(CudaEvent const& start, CudaEvent const& stop);
+
+    mutable std::mutex mMutex;
+    std::array<double, kNUM_PHASES> mPhaseTimesMs{};
+    std::optional<Clock::time_point> mBegin;
+    std::optional<CudaEvent> mGpuStart;
+    std::optional<CudaEvent> mGpuStop;
+    bool mGpuRecorded{false};
+    std::optional<CudaEvent> mDraftStart;
+    std::optional<CudaEvent> mDraftStop;
+    bool mDraftRecorded{false};
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvBlockCopyBatch.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+
+#include <cstdint>
+
+namespace tensorrt_llm::runtime
+{
+
+KvBlockCopyBatch::KvBlockCopyBatch(SizeType32 numLayers, SizeType32 numKvHeads, SizeType32 tokensPerBlock,
+    SizeType32 sizePerHead, nvinfer1::DataType dataType)
+    : mNumRuns{numLayers * 2 * numKvHeads}
+    , mTokensPerBlock{tokensPerBlock}
+    , mTokenBytes{static_cast<std::size_t>(sizePerHead) * BufferDataType(dataType).getSize()}
+{
+    TLLM_CHECK_WITH_INFO(mNumRuns > 0 && mTokensPerBlock > 0 && mTokenBytes > 0, "Invalid KV cache block geometry");
+}
+
+void KvBlockCopyBatch::add(void* dstBlock, void const* srcBlock, SizeType32 numTokens, OnEnqueued onEnqueued)
+{
+    TLLM_CHECK_WITH_INFO(numTokens >= 0 && numTokens <= mTokensPerBlock, "Cannot copy %d tokens of a block of %d",
+        numTokens, mTokensPerBlock);
+    auto const runBytes = mTokensPerBlock * mTokenBytes;
+    if (numTokens == mTokensPerBlock)
+    {
+        mCopier.add(dstBlock, srcBlock, mNumRuns * runBytes);
+    }
+    else
+    {
+        auto* dst = static_cast<std::uint8_t*>(dstBlock);
+        auto const* src = static_cast<std::uint8_t const*>(srcBlock);
+        for (SizeType32 run = 0; run < mNumRuns; ++run)
+        {
+            mCopier.add(dst + run * runBytes, src + run * runBytes, numTokens * mTokenBytes);
+        }
+    }
+    ++mNumBlocks;
+    if (onEnqueued)
+    {
+        mOnEnqueued.push_back(std::move(onEnqueued));
+    }
+}
+
+void KvBlockCopyBatch::execute(BufferManager const& manager)
+{
+    mCopier.execute(manager);
+    // Later work on the stream is ordered after the copies, so the sources may be reused from here on
+    for (auto const& onEnqueued : mOnEnqueued)
+    {
+        onEnqueued();
+    }
+    mOnEnqueued.clear();
+    mNumBlocks = 0;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/batchedCopier.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <NvInferRuntime.h>
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Collects the copy-on-write copies of shared KV cache blocks of an iteration to enqueue them in one launch.
+//! \details A raw block (K & V, all layers) holds [numLayers, 2, numKvHeads, tokensPerBlock, sizePerHead] elements.
+//! Only the tokens of a block that were written are copied, the slots after them are written by the next steps, so a
+//! partial block is copied as numLayers * 2 * numKvHeads runs, all of them issued through a BatchedCopier. Sources
+//! must stay valid until execute, see BlockManager::replaceSharedBlockDeferred.
+class KvBlockCopyBatch
+{
+public:
+    //! Called once the copy from a source block is enqueued, e.g. to release the block
+    using OnEnqueued = std::function<void()>;
+
+    KvBlockCopyBatch(SizeType32 numLayers, SizeType32 numKvHeads, SizeType32 tokensPerBlock, SizeType32 sizePerHead,
+        nvinfer1::DataType dataType);
+
+    //! \brief Add a copy of the first numTokens tokens of a raw block.
+    void add(void* dstBlock, void const* srcBlock, SizeType32 numTokens, OnEnqueued onEnqueued = {});
+
+    //! \brief Enqueue the collected copies on the stream of manager and start collecting a new batch.
+    void execute(BufferManager const& manager);
+
+    [[nodiscard]] SizeType32 getNumBlocks() const noexcept
+    {
+        return mNumBlocks;
+    }
+
+    [[nodiscard]] std::size_t getNumCopies() const noexcept
+    {
+        return mCopier.getNumCopies();
+    }
+
+private:
+    SizeType32 mNumRuns;
+    SizeType32 mTokensPerBlock;
+    std::size_t mTokenBytes;
+    SizeType32 mNumBlocks{0};
+    BatchedCopier mCopier;
+    std::vector<OnEnqueued> mOnEnqueued;
+};
+
+} // namespace tensorrt_llm::runtime
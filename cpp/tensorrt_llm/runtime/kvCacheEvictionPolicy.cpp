@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheEvictionPolicy.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace tensorrt_llm::runtime
+{
+
+KvCacheEvictionPolicy::KvCacheEvictionPolicy(Config const& config)
+    : mConfig{config}
+{
+    TLLM_CHECK_WITH_INFO(mConfig.sinkTokenLength >= 0 && mConfig.recentTokenLength > 0,
+        "The eviction policy needs a non-negative number of sink tokens and at least one recent token");
+    TLLM_CHECK_WITH_INFO(mConfig.heavyHitterTokenLength >= 0 && mConfig.evictionInterval >= 0,
+        "The number of heavy hitters and the eviction interval may not be negative");
+    if (mConfig.policy == Policy::kRECENCY)
+    {
+        mConfig.heavyHitterTokenLength = 0;
+    }
+}
+
+SizeType32 KvCacheEvictionPolicy::getTokenBudget() const noexcept
+{
+    return mConfig.sinkTokenLength + mConfig.heavyHitterTokenLength + mConfig.recentTokenLength;
+}
+
+bool KvCacheEvictionPolicy::needsEviction(SizeType32 numTokens) const noexcept
+{
+    return numTokens > getTokenBudget() + mConfig.evictionInterval;
+}
+
+std::vector<SizeType32> KvCacheEvictionPolicy::selectTokens(float const* scores, SizeType32 numTokens) const
+{
+    std::vector<SizeType32> kept(numTokens);
+    std::iota(kept.begin(), kept.end(), 0);
+    if (numTokens <= getTokenBudget())
+    {
+        return kept;
+    }
+
+    auto const recentBegin = numTokens - mConfig.recentTokenLength;
+    std::vector<SizeType32> candidates(kept.begin() + mConfig.sinkTokenLength, kept.begin() + recentBegin);
+    auto const numHeavyHitters = std::min(mConfig.heavyHitterTokenLength, static_cast<SizeType32>(candidates.size()));
+    if (numHeavyHitters > 0)
+    {
+        TLLM_CHECK_WITH_INFO(scores != nullptr, "The heavy hitter policy needs attention scores");
+        // Ties go to the more recent token.
+        auto const isHeavier = [scores](SizeType32 a, SizeType32 b)
+        { return scores[a] > scores[b] || (scores[a] == scores[b] && a > b); };
+        std::partial_sort(candidates.begin(), candidates.begin() + numHeavyHitters, candidates.end(), isHeavier);
+    }
+    candidates.resize(numHeavyHitters);
+    std::sort(candidates.begin(), candidates.end());
+
+    kept.resize(mConfig.sinkTokenLength);
+    kept.insert(kept.end(), candidates.begin(), candidates.end());
+    for (auto token = recentBegin; token < numTokens; ++token)
+    {
+        kept.push_back(token);
+    }
+    return kept;
+}
+
+SizeType32 KvCacheEvictionPolicy::getNumFreedBlocks(
+    SizeType32 numTokens, SizeType32 newNumTokens, SizeType32 tokensPerBlock)
+{
+    TLLM_CHECK(newNumTokens <= numTokens && tokensPerBlock > 0);
+    auto const numBlocks = (numTokens + tokensPerBlock - 1) / tokensPerBlock;
+    auto const newNumBlocks = (newNumTokens + tokensPerBlock - 1) / tokensPerBlock;
+    return numBlocks - newNumBlocks;
+}
+
+} // namespace tensorrt_llm::runtime
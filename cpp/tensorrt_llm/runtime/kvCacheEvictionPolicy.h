@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Chooses the KV cache tokens a request keeps when its cache is compressed.
+//! \details A compressed cache keeps the first sinkTokenLength tokens (attention sinks), the last recentTokenLength
+//! tokens and, with the heavy hitter policy (H2O), the heavyHitterTokenLength other tokens with the largest
+//! accumulated attention scores (see kernels::invokeAccumulateKvTokenScores). The recency policy (StreamingLLM) keeps
+//! sinks and recent tokens only. Eviction runs once the cache exceeds the budget by evictionInterval tokens, so that
+//! compaction (kernels::invokeCompactKvCache) is amortized over several steps. The blocks past the compacted length
+//! can then be released to the block manager.
+class KvCacheEvictionPolicy
+{
+public:
+    enum class Policy : std::uint8_t
+    {
+        //! Sinks plus the most recent tokens (StreamingLLM)
+        kRECENCY,
+        //! Sinks, recent tokens and heavy hitters by accumulated attention score (H2O)
+        kHEAVY_HITTER,
+    };
+
+    struct Config
+    {
+        Policy policy{Policy::kHEAVY_HITTER};
+        SizeType32 sinkTokenLength{4};
+        SizeType32 recentTokenLength{256};
+        SizeType32 heavyHitterTokenLength{256};
+        SizeType32 evictionInterval{64};
+    };
+
+    explicit KvCacheEvictionPolicy(Config const& config);
+
+    //! \brief Number of tokens kept after an eviction.
+    [[nodiscard]] SizeType32 getTokenBudget() const noexcept;
+
+    [[nodiscard]] bool needsEviction(SizeType32 numTokens) const noexcept;
+
+    //! \brief Ascending indices of the tokens to keep out of numTokens.
+    //! \param scores Accumulated attention score of each token, only read by the heavy hitter policy.
+    [[nodiscard]] std::vector<SizeType32> selectTokens(float const* scores, SizeType32 numTokens) const;
+
+    //! \brief Number of trailing blocks of a sequence that become free when it shrinks to newNumTokens.
+    [[nodiscard]] static SizeType32 getNumFreedBlocks(
+        SizeType32 numTokens, SizeType32 newNumTokens, SizeType32 tokensPerBlock);
+
+    [[nodiscard]] Config const& getConfig() const noexcept
+    {
+        return mConfig;
+    }
+
+private:
+    Config mConfig;
+};
+
+} // namespace tensorrt_llm::runtime
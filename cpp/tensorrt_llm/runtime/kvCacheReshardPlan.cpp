@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheReshardPlan.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+void checkLayout(SizeType32 numLayers, SizeType32 numKvHeads, WorldConfig const& world)
+{
+    auto const tp = world.getTensorParallelism();
+    auto const pp = world.getPipelineParallelism();
+    TLLM_CHECK_WITH_INFO(numLayers % pp == 0, "%d layers can not be split over %d pipeline ranks", numLayers, pp);
+    TLLM_CHECK_WITH_INFO(numKvHeads % tp == 0 || tp % numKvHeads == 0,
+        "%d KV heads can not be split over %d tensor ranks", numKvHeads, tp);
+}
+
+//! \brief The tensor rank of the context side that provides a head to a generation tensor rank.
+SizeType32 getSrcTpRank(SizeType32 head, SizeType32 numKvHeads, SizeType32 srcTp, SizeType32 dstTpRank)
+{
+    if (srcTp <= numKvHeads)
+    {
+        return head / (numKvHeads / srcTp);
+    }
+    // The head is replicated on consecutive ranks, spread the receivers over them
+    auto const numReplicas = srcTp / numKvHeads;
+    return head * numReplicas + dstTpRank % numReplicas;
+}
+
+} // namespace
+
+std::pair<SizeType32, SizeType32> KvCacheReshardPlan::getLocalLayers(
+    SizeType32 numLayers, SizeType32 ppSize, SizeType32 ppRank)
+{
+    auto const layersPerRank = numLayers / ppSize;
+    return {ppRank * layersPerRank, layersPerRank};
+}
+
+std::pair<SizeType32, SizeType32> KvCacheReshardPlan::getLocalHeads(
+    SizeType32 numKvHeads, SizeType32 tpSize, SizeType32 tpRank)
+{
+    if (tpSize <= numKvHeads)
+    {
+        auto const headsPerRank = numKvHeads / tpSize;
+        return {tpRank * headsPerRank, headsPerRank};
+    }
+    return {tpRank / (tpSize / numKvHeads), 1};
+}
+
+KvCacheReshardPlan::KvCacheReshardPlan(
+    SizeType32 numLayers, SizeType32 numKvHeads, WorldConfig const& srcWorld, WorldConfig const& dstWorld)
+    : mIsIdentity{srcWorld.getTensorParallelism() == dstWorld.getTensorParallelism()
+        && srcWorld.getPipelineParallelism() == dstWorld.getPipelineParallelism()}
+{
+    TLLM_CHECK_WITH_INFO(numLayers > 0 && numKvHeads > 0, "The model needs layers and KV heads");
+    checkLayout(numLayers, numKvHeads, srcWorld);
+    checkLayout(numLayers, numKvHeads, dstWorld);
+
+    auto const srcTp = srcWorld.getTensorParallelism();
+    auto const srcPp = srcWorld.getPipelineParallelism();
+    auto const dstTp = dstWorld.getTensorParallelism();
+    auto const dstPp = dstWorld.getPipelineParallelism();
+    for (SizeType32 dstRank = 0; dstRank < dstTp * dstPp; ++dstRank)
+    {
+        auto const dstTpRank = dstRank % dstTp;
+        auto const [dstLayerBegin, dstNumLayers] = getLocalLayers(numLayers, dstPp, dstRank / dstTp);
+        auto const [dstHeadBegin, dstNumHeads] = getLocalHeads(numKvHeads, dstTp, dstTpRank);
+        for (SizeType32 srcPpRank = 0; srcPpRank < srcPp; ++srcPpRank)
+        {
+            auto const [srcLayerBegin, srcNumLayers] = getLocalLayers(numLayers, srcPp, srcPpRank);
+            auto const layerBegin = std::max(srcLayerBegin, dstLayerBegin);
+            auto const layerEnd = std::min(srcLayerBegin + srcNumLayers, dstLayerBegin + dstNumLayers);
+            if (layerBegin >= layerEnd)
+            {
+                continue;
+            }
+            // Group the heads of the generation rank into runs held by the same context rank
+            auto headBegin = dstHeadBegin;
+            while (headBegin < dstHeadBegin + dstNumHeads)
+            {
+                auto const srcTpRank = getSrcTpRank(headBegin, numKvHeads, srcTp, dstTpRank);
+                auto const [srcHeadBegin, srcNumHeads] = getLocalHeads(numKvHeads, srcTp, srcTpRank);
+                auto const headEnd = std::min(srcHeadBegin + srcNumHeads, dstHeadBegin + dstNumHeads);
+                mSlices.push_back(KvCacheSlice{srcPpRank * srcTp + srcTpRank, dstRank, layerBegin,
+                    layerEnd - layerBegin, headBegin, headEnd - headBegin, layerBegin - srcLayerBegin,
+                    headBegin - srcHeadBegin, layerBegin - dstLayerBegin, headBegin - dstHeadBegin});
+                headBegin = headEnd;
+            }
+        }
+    }
+}
+
+std::vector<KvCacheSlice> KvCacheReshardPlan::getSlicesForDst(SizeType32 dstRank) const
+{
+    std::vector<KvCacheSlice> slices;
+    std::copy_if(mSlices.begin(), mSlices.end(), std::back_inserter(slices),
+        [dstRank](auto const& slice) { return slice.dstRank == dstRank; });
+    std::stable_sort(slices.begin(), slices.end(), [](auto const& a, auto const& b) { return a.srcRank < b.srcRank; });
+    return slices;
+}
+
+std::vector<KvCacheSlice> KvCacheReshardPlan::getSlicesForSrc(SizeType32 srcRank) const
+{
+    std::vector<KvCacheSlice> slices;
+    std::copy_if(mSlices.begin(), mSlices.end(), std::back_inserter(slices),
+        [srcRank](auto const& slice) { return slice.srcRank == srcRank; });
+    return slices;
+}
+
+} // namespace tensorrt_llm::runtime
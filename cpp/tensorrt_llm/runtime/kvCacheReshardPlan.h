@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <utility>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief A range of layers and KV heads that one context rank sends to one generation rank.
+//! \details Layers and heads are given globally and relative to the local cache of either side. The ranges map to
+//! kernels::KvCacheBlockSlice, which gathers them out of the context blocks and scatters them into the generation
+//! blocks.
+struct KvCacheSlice
+{
+    SizeType32 srcRank;
+    SizeType32 dstRank;
+    SizeType32 layerBegin;
+    SizeType32 numLayers;
+    SizeType32 headBegin;
+    SizeType32 numHeads;
+    SizeType32 srcLayerOffset;
+    SizeType32 srcHeadOffset;
+    SizeType32 dstLayerOffset;
+    SizeType32 dstHeadOffset;
+
+    bool operator==(KvCacheSlice const& other) const noexcept
+    {
+        return srcRank == other.srcRank && dstRank == other.dstRank && layerBegin == other.layerBegin
+            && numLayers == other.numLayers && headBegin == other.headBegin && numHeads == other.numHeads
+            && srcLayerOffset == other.srcLayerOffset && srcHeadOffset == other.srcHeadOffset
+            && dstLayerOffset == other.dstLayerOffset && dstHeadOffset == other.dstHeadOffset;
+    }
+};
+
+//! \brief Maps the KV cache of a context instance onto a generation instance with another TP/PP layout.
+//! \details Pipeline ranks hold contiguous ranges of layers, tensor ranks contiguous ranges of KV heads. When there are
+//! more tensor ranks than KV heads, every head is replicated on tpSize / numKvHeads ranks; the plan then spreads the
+//! generation ranks over the replicas. Every generation rank receives each of its layers and heads exactly once.
+class KvCacheReshardPlan
+{
+public:
+    KvCacheReshardPlan(
+        SizeType32 numLayers, SizeType32 numKvHeads, WorldConfig const& srcWorld, WorldConfig const& dstWorld);
+
+    //! \brief The slices a generation rank receives, ordered by source rank.
+    [[nodiscard]] std::vector<KvCacheSlice> getSlicesForDst(SizeType32 dstRank) const;
+
+    //! \brief The slices a context rank sends, ordered by destination rank.
+    [[nodiscard]] std::vector<KvCacheSlice> getSlicesForSrc(SizeType32 srcRank) const;
+
+    //! \brief If both sides have the same layout, every rank sends its whole cache to the same rank.
+    [[nodiscard]] bool isIdentity() const noexcept
+    {
+        return mIsIdentity;
+    }
+
+    [[nodiscard]] std::vector<KvCacheSlice> const& getSlices() const noexcept
+    {
+        return mSlices;
+    }
+
+    //! \brief The [begin, begin + count) global layers of a pipeline rank.
+    [[nodiscard]] static std::pair<SizeType32, SizeType32> getLocalLayers(
+        SizeType32 numLayers, SizeType32 ppSize, SizeType32 ppRank);
+
+    //! \brief The [begin, begin + count) global KV heads of a tensor rank.
+    [[nodiscard]] static std::pair<SizeType32, SizeType32> getLocalHeads(
+        SizeType32 numKvHeads, SizeType32 tpSize, SizeType32 tpRank);
+
+private:
+    std::vector<KvCacheSlice> mSlices;
+    bool mIsIdentity;
+};
+
+} // namespace tensorrt_llm::runtime
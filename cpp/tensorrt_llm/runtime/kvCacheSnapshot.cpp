@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheSnapshot.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+constexpr std::array<char, 8> kMagic{'T', 'L', 'L', 'M', 'K', 'V', 'S', '\0'};
+
+// On-disk layout of the file header
+struct SnapshotHeader
+{
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::int32_t numLayers;
+    std::int32_t numKvHeads;
+    std::int32_t sizePerHead;
+    std::int32_t tokensPerBlock;
+    std::int32_t dataType;
+    std::uint64_t blockSizeInBytes;
+    std::uint64_t numBlocks;
+};
+
+// On-disk layout of the fixed part of a block record, followed by numTokens token ids, numTokens extra ids and the
+// payload
+struct BlockRecord
+{
+    std::uint64_t blockHash;
+    std::uint64_t parentHash;
+    std::uint64_t loraTaskId;
+    std::uint32_t numTokens;
+    std::uint32_t hasParent;
+};
+
+std::string describe(KVCacheSnapshotConfig const& config)
+{
+    return "numLayers=" + std::to_string(config.numLayers) + ", numKvHeads=" + std::to_string(config.numKvHeads)
+        + ", sizePerHead=" + std::to_string(config.sizePerHead) + ", tokensPerBlock="
+        + std::to_string(config.tokensPerBlock) + ", dataType=" + std::to_string(config.dataType)
+        + ", blockSizeInBytes=" + std::to_string(config.blockSizeInBytes);
+}
+
+} // namespace
+
+KVCacheSnapshotWriter::KVCacheSnapshotWriter(std::filesystem::path const& path, KVCacheSnapshotConfig const& config)
+    : mStream{path, std::ios::binary | std::ios::trunc}
+    , mConfig{config}
+{
+    TLLM_CHECK_WITH_INFO(mStream.good(), "Failed to open %s for writing", path.c_str());
+    TLLM_CHECK_WITH_INFO(mConfig.blockSizeInBytes > 0, "Block size must be positive");
+    SnapshotHeader header{kMagic, KVCacheSnapshotReader::kVersion, mConfig.numLayers, mConfig.numKvHeads,
+        mConfig.sizePerHead, mConfig.tokensPerBlock, mConfig.dataType, mConfig.blockSizeInBytes, 0};
+    mStream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+}
+
+KVCacheSnapshotWriter::~KVCacheSnapshotWriter()
+{
+    if (!mFinished)
+    {
+        try
+        {
+            finish();
+        }
+        catch (std::exception const& e)
+        {
+            TLLM_LOG_ERROR("Failed to finish KV cache snapshot: %s", e.what());
+        }
+    }
+}
+
+void KVCacheSnapshotWriter::pad()
+{
+    static constexpr std::array<char, KVCacheSnapshotReader::kPayloadAlignment> kZeros{};
+    auto const offset = static_cast<std::size_t>(mStream.tellp());
+    auto const padding = (KVCacheSnapshotReader::kPayloadAlignment - offset % KVCacheSnapshotReader::kPayloadAlignment)
+        % KVCacheSnapshotReader::kPayloadAlignment;
+    mStream.write(kZeros.data(), static_cast<std::streamsize>(padding));
+}
+
+void KVCacheSnapshotWriter::addBlock(KVCacheSnapshotBlock const& block, void const* data)
+{
+    TLLM_NVTX_SCOPED_RANGE(kKV, addBlock);
+    TLLM_CHECK_WITH_INFO(!mFinished, "Snapshot is already finished");
+    TLLM_CHECK_WITH_INFO(block.tokens.size() <= static_cast<std::size_t>(mConfig.tokensPerBlock),
+        "Block holds %zu tokens, more than tokensPerBlock (%d)", block.tokens.size(), mConfig.tokensPerBlock);
+    BlockRecord record{block.blockHash, block.parentHash.value_or(0), block.loraTaskId,
+        static_cast<std::uint32_t>(block.tokens.size()), block.parentHash.has_value() ? 1U : 0U};
+    mStream.write(reinterpret_cast<char const*>(&record), sizeof(record));
+    for (auto const& token : block.tokens)
+    {
+        mStream.write(reinterpret_cast<char const*>(&token.tokenId), sizeof(token.tokenId));
+    }
+    for (auto const& token : block.tokens)
+    {
+        mStream.write(reinterpret_cast<char const*>(&token.tokenExtraId), sizeof(token.tokenExtraId));
+    }
+    pad();
+    mStream.write(static_cast<char const*>(data), static_cast<std::streamsize>(mConfig.blockSizeInBytes));
+    TLLM_CHECK_WITH_INFO(mStream.good(), "Failed to write KV cache snapshot");
+    ++mNumBlocks;
+}
+
+void KVCacheSnapshotWriter::finish()
+{
+    TLLM_CHECK_WITH_INFO(!mFinished, "Snapshot is already finished");
+    mFinished = true;
+    mStream.seekp(offsetof(SnapshotHeader, numBlocks));
+    mStream.write(reinterpret_cast<char const*>(&mNumBlocks), sizeof(mNumBlocks));
+    mStream.close();
+    TLLM_CHECK_WITH_INFO(!mStream.fail(), "Failed to write KV cache snapshot");
+    TLLM_LOG_INFO("Wrote KV cache snapshot with %lu blocks", mNumBlocks);
+}
+
+KVCacheSnapshotReader::KVCacheSnapshotReader(
+    std::filesystem::path const& path, KVCacheSnapshotConfig const& expectedConfig)
+{
+#if defined(_WIN32)
+    TLLM_THROW("KV cache snapshots are not supported on Windows");
+#else
+    mFd = ::open(path.c_str(), O_RDONLY);
+    TLLM_CHECK_WITH_INFO(mFd >= 0, "Failed to open %s: %s", path.c_str(), std::strerror(errno));
+    struct stat st = {};
+    if (::fstat(mFd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(SnapshotHeader))
+    {
+        ::close(mFd);
+        TLLM_THROW("%s is not a KV cache snapshot", path.c_str());
+    }
+    mSize = static_cast<std::size_t>(st.st_size);
+    auto* data = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFd, 0);
+    if (data == MAP_FAILED)
+    {
+        auto const err = errno;
+        ::close(mFd);
+        TLLM_THROW("Failed to map %s: %s", path.c_str(), std::strerror(err));
+    }
+    mData = static_cast<std::byte const*>(data);
+    // Blocks are consumed front to back
+    ::madvise(data, mSize, MADV_SEQUENTIAL);
+#endif
+
+    try
+    {
+        SnapshotHeader header{};
+        std::memcpy(&header, read(sizeof(header)), sizeof(header));
+        TLLM_CHECK_WITH_INFO(header.magic == kMagic, "%s is not a KV cache snapshot", path.c_str());
+        TLLM_CHECK_WITH_INFO(header.version == kVersion, "Unsupported KV cache snapshot version %u, expected %u",
+            header.version, kVersion);
+        mConfig = KVCacheSnapshotConfig{header.numLayers, header.numKvHeads, header.sizePerHead,
+            header.tokensPerBlock, header.dataType, header.blockSizeInBytes};
+        mNumBlocks = header.numBlocks;
+        TLLM_CHECK_WITH_INFO(mConfig == expectedConfig,
+            "KV cache snapshot %s does not match the cache configuration. Snapshot: %s, cache: %s", path.c_str(),
+            describe(mConfig).c_str(), describe(expectedConfig).c_str());
+    }
+    catch (...)
+    {
+        unmap();
+        throw;
+    }
+}
+
+KVCacheSnapshotReader::~KVCacheSnapshotReader()
+{
+    unmap();
+}
+
+void KVCacheSnapshotReader::unmap() noexcept
+{
+#if !defined(_WIN32)
+    if (mData != nullptr)
+    {
+        ::munmap(const_cast<std::byte*>(mData), mSize);
+        mData = nullptr;
+    }
+    if (mFd >= 0)
+    {
+        ::close(mFd);
+        mFd = -1;
+    }
+#endif
+}
+
+std::byte const* KVCacheSnapshotReader::read(std::size_t size)
+{
+    TLLM_CHECK_WITH_INFO(mOffset + size <= mSize, "KV cache snapshot is truncated");
+    auto const* ptr = mData + mOffset;
+    mOffset += size;
+    return ptr;
+}
+
+void const* KVCacheSnapshotReader::next(KVCacheSnapshotBlock& block)
+{
+    TLLM_NVTX_SCOPED_RANGE(kKV, next);
+    if (mNumRead == mNumBlocks)
+    {
+        return nullptr;
+    }
+
+    BlockRecord record{};
+    std::memcpy(&record, read(sizeof(record)), sizeof(record));
+    TLLM_CHECK_WITH_INFO(record.numTokens <= static_cast<std::uint32_t>(mConfig.tokensPerBlock),
+        "Corrupted KV cache snapshot: block holds %u tokens", record.numTokens);
+    block.blockHash = record.blockHash;
+    block.parentHash = record.hasParent != 0 ? std::make_optional(record.parentHash) : std::nullopt;
+    block.loraTaskId = record.loraTaskId;
+    block.tokens.resize(record.numTokens);
+
+    auto const* tokenIds = read(record.numTokens * sizeof(TokenIdType));
+    auto const* extraIds = read(record.numTokens * sizeof(TokenExtraIdType));
+    for (std::uint32_t i = 0; i < record.numTokens; ++i)
+    {
+        std::memcpy(&block.tokens[i].tokenId, tokenIds + i * sizeof(TokenIdType), sizeof(TokenIdType));
+        std::memcpy(&block.tokens[i].tokenExtraId, extraIds + i * sizeof(TokenExtraIdType), sizeof(TokenExtraIdType));
+    }
+
+    mOffset = (mOffset + kPayloadAlignment - 1) / kPayloadAlignment * kPayloadAlignment;
+    auto const* payload = read(mConfig.blockSizeInBytes);
+    ++mNumRead;
+    return payload;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Configuration a KV cache snapshot was taken with. A snapshot can only be loaded into a cache with an
+//! identical configuration.
+struct KVCacheSnapshotConfig
+{
+    SizeType32 numLayers{0};
+    SizeType32 numKvHeads{0};
+    SizeType32 sizePerHead{0};
+    SizeType32 tokensPerBlock{0};
+    //! nvinfer1::DataType of the cache, stored as integer to keep this header free of TensorRT
+    std::int32_t dataType{0};
+    //! Size of the payload of a single block (K & V, all layers)
+    std::uint64_t blockSizeInBytes{0};
+
+    bool operator==(KVCacheSnapshotConfig const& other) const noexcept
+    {
+        return numLayers == other.numLayers && numKvHeads == other.numKvHeads && sizePerHead == other.sizePerHead
+            && tokensPerBlock == other.tokensPerBlock && dataType == other.dataType
+            && blockSizeInBytes == other.blockSizeInBytes;
+    }
+};
+
+//! \brief Metadata of a block stored in a snapshot.
+struct KVCacheSnapshotBlock
+{
+    //! Chained hash identifying the block and its prefix
+    std::uint64_t blockHash{0};
+    //! Hash of the previous block of the sequence, if any. Parents are always stored before their children.
+    std::optional<std::uint64_t> parentHash;
+    LoraTaskIdType loraTaskId{0};
+    VecUniqueTokens tokens;
+};
+
+//! \brief Writes the reusable blocks of a KV cache to a file.
+//! \details The file is a header followed by one record per block: the block metadata and its payload, aligned to
+//! kPayloadAlignment. Blocks must be added in tree order (parents before children), so that a reader can rebuild the
+//! reuse tree while streaming through the file.
+class KVCacheSnapshotWriter
+{
+public:
+    KVCacheSnapshotWriter(std::filesystem::path const& path, KVCacheSnapshotConfig const& config);
+
+    KVCacheSnapshotWriter(KVCacheSnapshotWriter const&) = delete;
+    KVCacheSnapshotWriter& operator=(KVCacheSnapshotWriter const&) = delete;
+
+    //! \brief Finishes the snapshot if finish has not been called yet.
+    ~KVCacheSnapshotWriter();
+
+    //! \param data Host copy of the block, blockSizeInBytes bytes.
+    void addBlock(KVCacheSnapshotBlock const& block, void const* data);
+
+    //! \brief Write the number of blocks to the header and close the file.
+    void finish();
+
+    [[nodiscard]] std::uint64_t getNumBlocks() const noexcept
+    {
+        return mNumBlocks;
+    }
+
+private:
+    void pad();
+
+    std::ofstream mStream;
+    KVCacheSnapshotConfig mConfig;
+    std::uint64_t mNumBlocks{0};
+    bool mFinished{false};
+};
+
+//! \brief Reads a snapshot written by KVCacheSnapshotWriter.
+//! \details The file is memory mapped and blocks are decoded lazily one at a time, so block payloads can be copied to
+//! the cache pools while the rest of the file is still being paged in.
+class KVCacheSnapshotReader
+{
+public:
+    //! \brief Opens the snapshot and validates it against expectedConfig. Throws if the file is not a valid snapshot
+    //! or was taken with a different configuration.
+    KVCacheSnapshotReader(std::filesystem::path const& path, KVCacheSnapshotConfig const& expectedConfig);
+
+    KVCacheSnapshotReader(KVCacheSnapshotReader const&) = delete;
+    KVCacheSnapshotReader& operator=(KVCacheSnapshotReader const&) = delete;
+
+    ~KVCacheSnapshotReader();
+
+    //! \brief Decode the next block.
+    //! \param block Receives the metadata of the block.
+    //! \return Pointer to the payload of the block inside the mapping, or nullptr if all blocks have been read.
+    [[nodiscard]] void const* next(KVCacheSnapshotBlock& block);
+
+    [[nodiscard]] std::uint64_t getNumBlocks() const noexcept
+    {
+        return mNumBlocks;
+    }
+
+    [[nodiscard]] KVCacheSnapshotConfig const& getConfig() const noexcept
+    {
+        return mConfig;
+    }
+
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::size_t kPayloadAlignment = 256;
+
+private:
+    std::byte const* read(std::size_t size);
+
+    void unmap() noexcept;
+
+    KVCacheSnapshotConfig mConfig;
+    std::uint64_t mNumBlocks{0};
+    std::uint64_t mNumRead{0};
+
+    int mFd{-1};
+    std::byte const* mData{nullptr};
+    std::size_t mSize{0};
+    std::size_t mOffset{0};
+};
+
+} // namespace tensorrt_llm::runtime
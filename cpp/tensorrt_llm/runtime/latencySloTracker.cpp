@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/latencySloTracker.h"
+#include "tensorrt_llm/common/assert.h"
+
+namespace tensorrt_llm::runtime
+{
+
+LatencySloTracker::LatencySloTracker(
+    std::optional<Milliseconds> timeToFirstToken, std::optional<Milliseconds> interTokenLatency, TimePoint arrival)
+    : mTimeToFirstToken{timeToFirstToken}
+    , mInterTokenLatency{interTokenLatency}
+    , mArrival{arrival}
+    , mLastToken{arrival}
+{
+}
+
+void LatencySloTracker::recordTokens(SizeType32 numTokens, TimePoint now)
+{
+    TLLM_CHECK_WITH_INFO(numTokens >= 0, "Number of tokens must not be negative");
+    if (numTokens == 0)
+    {
+        return;
+    }
+    if (!mFirstToken)
+    {
+        mFirstToken = now;
+    }
+    mLastToken = now;
+    mNumGeneratedTokens += numTokens;
+}
+
+std::optional<bool> LatencySloTracker::isTimeToFirstTokenMet() const
+{
+    if (!mTimeToFirstToken || !mFirstToken)
+    {
+        return std::nullopt;
+    }
+    return *mFirstToken - mArrival <= *mTimeToFirstToken;
+}
+
+std::optional<bool> LatencySloTracker::isInterTokenLatencyMet() const
+{
+    if (!mInterTokenLatency || mNumGeneratedTokens < 2)
+    {
+        return std::nullopt;
+    }
+    return mLastToken - *mFirstToken <= *mInterTokenLatency * (mNumGeneratedTokens - 1);
+}
+
+bool LatencySloTracker::isAttained() const
+{
+    return isTimeToFirstTokenMet().value_or(!mTimeToFirstToken.has_value())
+        && isInterTokenLatencyMet().value_or(true);
+}
+
+std::optional<double> LatencySloTracker::getSlackMs(TimePoint now, double remainingWorkMs) const
+{
+    std::optional<TimePoint> deadline;
+    if (!mFirstToken)
+    {
+        if (mTimeToFirstToken)
+        {
+            deadline = mArrival + *mTimeToFirstToken;
+        }
+    }
+    else if (mInterTokenLatency)
+    {
+        deadline = *mFirstToken + *mInterTokenLatency * mNumGeneratedTokens;
+    }
+    if (!deadline)
+    {
+        return std::nullopt;
+    }
+    return DurationMs(*deadline - now).count() - remainingWorkMs;
+}
+
+} // namespace tensorrt_llm::runtime
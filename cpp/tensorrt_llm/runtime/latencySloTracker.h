@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Tracks the time to first token and inter-token latency of a request against its targets.
+//! \details The inter-token target is treated as a cumulative budget: after the first token, the n-th following token
+//! is due at firstToken + n * interTokenLatency. A request that ran ahead can therefore absorb a slow iteration.
+class LatencySloTracker
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using Milliseconds = std::chrono::milliseconds;
+    using DurationMs = std::chrono::duration<double, std::milli>;
+
+    LatencySloTracker(
+        std::optional<Milliseconds> timeToFirstToken, std::optional<Milliseconds> interTokenLatency, TimePoint arrival);
+
+    LatencySloTracker(executor::LatencySloConfig const& config, TimePoint arrival)
+        : LatencySloTracker(config.getTimeToFirstToken(), config.getInterTokenLatency(), arrival)
+    {
+    }
+
+    //! \brief Record numTokens tokens generated at time now. The first token recorded is the first token of the request.
+    void recordTokens(SizeType32 numTokens, TimePoint now);
+
+    [[nodiscard]] bool hasTargets() const noexcept
+    {
+        return mTimeToFirstToken.has_value() || mInterTokenLatency.has_value();
+    }
+
+    [[nodiscard]] SizeType32 getNumGeneratedTokens() const noexcept
+    {
+        return mNumGeneratedTokens;
+    }
+
+    //! \brief Whether the first token met its target. Not set without a target or before the first token.
+    [[nodiscard]] std::optional<bool> isTimeToFirstTokenMet() const;
+
+    //! \brief Whether the average inter-token latency is within its target. Not set without a target or before the
+    //! second token.
+    [[nodiscard]] std::optional<bool> isInterTokenLatencyMet() const;
+
+    //! \brief Whether all targets that are set were met.
+    [[nodiscard]] bool isAttained() const;
+
+    //! \brief Time in ms left until the next deadline is missed, after spending remainingWorkMs on the request. Not set
+    //! if no target applies to the next token.
+    [[nodiscard]] std::optional<double> getSlackMs(TimePoint now, double remainingWorkMs = 0.0) const;
+
+    //! \brief Stable sort of items by ascending slack. Items without slack go last in their original order.
+    template <typename T, typename SlackFn>
+    static void sortBySlack(std::vector<T>& items, SlackFn&& slackFn)
+    {
+        std::stable_sort(items.begin(), items.end(),
+            [&slackFn](T const& lhs, T const& rhs)
+            {
+                std::optional<double> const lhsSlack = slackFn(lhs);
+                std::optional<double> const rhsSlack = slackFn(rhs);
+                if (!rhsSlack)
+                {
+                    return lhsSlack.has_value();
+                }
+                return lhsSlack && *lhsSlack < *rhsSlack;
+            });
+    }
+
+private:
+    std::optional<Milliseconds> mTimeToFirstToken;
+    std::optional<Milliseconds> mInterTokenLatency;
+    TimePoint mArrival;
+    std::optional<TimePoint> mFirstToken;
+    TimePoint mLastToken;
+    SizeType32 mNumGeneratedTokens{0};
+};
+
+} // namespace tensorrt_llm::runtime
@@ -15,10 +15,12 @@
  */
 
 #include "tensorrt_llm/runtime/layerProfiler.h"
+#include "tensorrt_llm/runtime/traceRecorder.h"
 #include <iomanip>
 #include <iostream>
 #include <numeric>
 #include <sstream>
+#include <utility>
 
 using namespace tensorrt_llm::runtime;
 
@@ -42,6 +44,16 @@ void LayerProfiler::reportLayerTime(char const* layerName, float timeMs) noexcep
 
     mIterator->timeMs.push_back(timeMs);
     ++mIterator;
+
+    if (TraceRecorder::getInstance().isEnabled())
+    {
+        mReportedLayers.emplace_back(layerName, timeMs);
+    }
+}
+
+std::vector<std::pair<std::string, float>> LayerProfiler::takeReportedLayers() noexcept
+{
+    return std::exchange(mReportedLayers, {});
 }
 
 float LayerProfiler::getTotalTime() const noexcept
@@ -17,6 +17,8 @@
 #pragma once
 
 #include "tensorrt_llm/runtime/common.h"
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <NvInfer.h>
@@ -37,11 +39,16 @@ public:
 
     std::string getLayerProfile() noexcept;
 
+    //! \brief The layers reported since the last call, in execution order. Only collected while the TraceRecorder is
+    //! enabled.
+    std::vector<std::pair<std::string, float>> takeReportedLayers() noexcept;
+
 private:
     [[nodiscard]] float getTotalTime() const noexcept;
 
     std::vector<LayerProfile> mLayers;
     std::vector<LayerProfile>::iterator mIterator{mLayers.begin()};
     int32_t mUpdatesCount{0};
+    std::vector<std::pair<std::string, float>> mReportedLayers;
 };
 } // namespace tensorrt_llm::runtime
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/layerwiseKvStreamer.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+std::atomic<LayerwiseKvStreamer*> LayerwiseKvStreamer::sActive{nullptr};
+
+LayerwiseKvStreamer::LayerwiseKvStreamer(SizeType32 numLayers, SendLayer sendLayer)
+    : mSendLayer{std::move(sendLayer)}
+    , mReady(numLayers, false)
+{
+    TLLM_CHECK_WITH_INFO(numLayers > 0, "The streamer needs at least one layer");
+    TLLM_CHECK_WITH_INFO(static_cast<bool>(mSendLayer), "The streamer needs a send function");
+    mCallbackArgs.reserve(numLayers);
+    for (SizeType32 layerIdx = 0; layerIdx < numLayers; ++layerIdx)
+    {
+        mCallbackArgs.push_back(HostCallbackArgs{this, layerIdx});
+    }
+    mSender = std::thread(&LayerwiseKvStreamer::sendLoop, this);
+}
+
+LayerwiseKvStreamer::~LayerwiseKvStreamer()
+{
+    LayerwiseKvStreamer* self = this;
+    sActive.compare_exchange_strong(self, nullptr);
+    {
+        std::lock_guard<std::mutex> const lock(mMutex);
+        mShutdown = true;
+    }
+    mCondition.notify_all();
+    mSender.join();
+}
+
+void LayerwiseKvStreamer::begin()
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    TLLM_CHECK_WITH_INFO(!mInStep, "waitUntilSent must end the previous step before the next one begins");
+    std::fill(mReady.begin(), mReady.end(), false);
+    mNextToSend = 0;
+    mError = nullptr;
+    mInStep = true;
+}
+
+void LayerwiseKvStreamer::markLayerReady(SizeType32 layerIdx)
+{
+    {
+        std::lock_guard<std::mutex> const lock(mMutex);
+        if (!mInStep || layerIdx < 0 || layerIdx >= getNumLayers())
+        {
+            return;
+        }
+        mReady[layerIdx] = true;
+        mLastReady = Clock::now();
+    }
+    mCondition.notify_all();
+}
+
+void LayerwiseKvStreamer::hostCallback(void* userData)
+{
+    // Runs on a CUDA thread, it must not call into CUDA
+    auto const* args = static_cast<HostCallbackArgs const*>(userData);
+    args->streamer->markLayerReady(args->layerIdx);
+}
+
+void LayerwiseKvStreamer::enqueueLayerReady(SizeType32 layerIdx, cudaStream_t stream)
+{
+    TLLM_CHECK_WITH_INFO(layerIdx >= 0 && layerIdx < getNumLayers(), "Layer %d out of range [0, %d)", layerIdx,
+        getNumLayers());
+    TLLM_CUDA_CHECK(cudaLaunchHostFunc(stream, &LayerwiseKvStreamer::hostCallback, &mCallbackArgs[layerIdx]));
+}
+
+double LayerwiseKvStreamer::waitUntilSent()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    TLLM_CHECK_WITH_INFO(mInStep, "No step to wait for, begin must be called first");
+    mCondition.wait(lock, [this] { return mNextToSend == getNumLayers(); });
+    mInStep = false;
+    if (mError)
+    {
+        std::rethrow_exception(std::exchange(mError, nullptr));
+    }
+    return std::max(std::chrono::duration<double, std::milli>(mLastSent - mLastReady).count(), 0.0);
+}
+
+void LayerwiseKvStreamer::sendLoop()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true)
+    {
+        mCondition.wait(lock,
+            [this] { return mShutdown || (mInStep && mNextToSend < getNumLayers() && mReady[mNextToSend]); });
+        if (mShutdown)
+        {
+            return;
+        }
+        auto const layerIdx = mNextToSend;
+        lock.unlock();
+        std::exception_ptr error;
+        try
+        {
+            mSendLayer(layerIdx);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        lock.lock();
+        if (error)
+        {
+            // Give up on the step, waitUntilSent rethrows
+            mError = error;
+            mNextToSend = getNumLayers();
+        }
+        else
+        {
+            ++mNextToSend;
+        }
+        if (mNextToSend == getNumLayers())
+        {
+            mLastSent = Clock::now();
+            mCondition.notify_all();
+        }
+    }
+}
+
+LayerwiseKvStreamer* LayerwiseKvStreamer::getActive() noexcept
+{
+    return sActive.load(std::memory_order_acquire);
+}
+
+void LayerwiseKvStreamer::setActive(LayerwiseKvStreamer* streamer) noexcept
+{
+    sActive.store(streamer, std::memory_order_release);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cuda_runtime_api.h>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Sends the KV cache of a context step layer by layer, as soon as the forward has written each layer.
+//! \details In disaggregated serving, the context instance sends the KV cache of its requests to the generation
+//! instance. Sending it once the whole context phase is done adds the transfer to the time to first token. With the
+//! streamer, the attention plugin enqueues a host callback behind the KV cache write of every layer, and a sender
+//! thread hands each ready layer, in layer order, to the transceiver while the GPU computes the remaining layers.
+//! Only the transfer of the last layers is left exposed.
+//!
+//! The owner brackets a context step with begin and waitUntilSent and makes the streamer the active one in between,
+//! so that the plugins, which TensorRT creates, can find it.
+class LayerwiseKvStreamer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    //! \brief Sends the blocks of a layer for the requests of the step, runs on the sender thread.
+    using SendLayer = std::function<void(SizeType32 layerIdx)>;
+
+    LayerwiseKvStreamer(SizeType32 numLayers, SendLayer sendLayer);
+
+    ~LayerwiseKvStreamer();
+
+    LayerwiseKvStreamer(LayerwiseKvStreamer const&) = delete;
+    LayerwiseKvStreamer& operator=(LayerwiseKvStreamer const&) = delete;
+
+    //! \brief Start a context step. The layers of the previous step must have been waited for.
+    void begin();
+
+    //! \brief Mark the KV cache of a layer as written. Can be called from any thread, including a CUDA host callback.
+    //! Layers marked outside of a step are ignored, e.g. those of generation-only steps.
+    void markLayerReady(SizeType32 layerIdx);
+
+    //! \brief Mark the layer ready once the work already enqueued on stream has run.
+    void enqueueLayerReady(SizeType32 layerIdx, cudaStream_t stream);
+
+    //! \brief Block until every layer of the step has been sent and end the step.
+    //! \return The time in milliseconds the transfer ran past the last layer becoming ready, i.e. the part of the
+    //! transfer not hidden behind the forward.
+    double waitUntilSent();
+
+    [[nodiscard]] SizeType32 getNumLayers() const noexcept
+    {
+        return static_cast<SizeType32>(mReady.size());
+    }
+
+    //! \brief The streamer the attention plugins report to, or nullptr.
+    [[nodiscard]] static LayerwiseKvStreamer* getActive() noexcept;
+    static void setActive(LayerwiseKvStreamer* streamer) noexcept;
+
+private:
+    struct HostCallbackArgs
+    {
+        LayerwiseKvStreamer* streamer;
+        SizeType32 layerIdx;
+    };
+
+    static void hostCallback(void* userData);
+
+    void sendLoop();
+
+    SendLayer mSendLayer;
+    std::vector<HostCallbackArgs> mCallbackArgs;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::vector<bool> mReady;
+    SizeType32 mNextToSend{0};
+    bool mInStep{false};
+    bool mShutdown{false};
+    Clock::time_point mLastReady;
+    Clock::time_point mLastSent;
+    std::exception_ptr mError;
+
+    std::thread mSender;
+
+    static std::atomic<LayerwiseKvStreamer*> sActive;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -11,8 +11,14 @@
  */
 
 #include "tensorrt_llm/runtime/lookaheadBuffers.h"
+#include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/logger.h"
 #include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/runtimeKernels.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
 namespace tensorrt_llm::runtime
 {
@@ -76,34 +82,43 @@ void LookaheadRuntimeBuffers::setFromInputs(SizeType32 numCtxSequences, SizeType
 
     auto const tokensPerStep = modelConfig.getMaxDecodingTokens();
 
-    manager.copy(*decoderLookaheadBuffers.positionOffsets, *positionOffsetsHostCopy);
-    manager.copy(*decoderLookaheadBuffers.packedMasks, *packedMaskHostCopy);
-    manager.copy(*decoderLookaheadBuffers.positionIds, *positionIdsHostCopy);
     manager.copy(seqSlots, *batchSlotsHostCopy);
-    manager.copy(*decoderLookaheadBuffers.generationLengths, *generationLengthsHostCopy);
-
     manager.getStream().synchronize();
 
+    // Gather the rows of the generation requests from the decoder buffers, all in one launch
+    std::vector<kernels::BatchedCopy> copies;
+    auto const gatherRow = [&copies](ITensor const& src, ITensor& dst, SizeType32 srcRow, SizeType32 dstRow,
+                               std::size_t rowSize)
+    {
+        auto const rowBytes = rowSize * BufferDataType(src.getDataType()).getSize();
+        TLLM_CHECK((srcRow + 1) * rowBytes <= src.getSizeInBytes() && (dstRow + 1) * rowBytes <= dst.getSizeInBytes());
+        copies.push_back(kernels::BatchedCopy{static_cast<std::uint8_t*>(dst.data()) + dstRow * rowBytes,
+            static_cast<std::uint8_t const*>(src.data()) + srcRow * rowBytes, rowBytes});
+    };
+    auto const positionsPerRow = static_cast<std::size_t>(tokensPerStep);
+    auto const masksPerRow = positionsPerRow * packedMasksDevice->getShape().d[1];
+
     BufferRange<SizeType32 const> batchSlotsRange(*batchSlotsHostCopy);
     for (SizeType32 bi = 0; bi < numGenSequences; bi++)
     {
         SizeType32 gbi = batchSlotsRange[bi + numCtxSequences];
-        manager.copy(*ITensor::at(generationLengthsHostCopy, {gbi}), *ITensor::at(generationLengthsHost, {bi}));
-        manager.copy(*ITensor::at(positionOffsetsHostCopy, {gbi}), *ITensor::at(positionOffsetsHost, {bi}));
-        manager.copy(*ITensor::slice(packedMaskHostCopy, gbi * tokensPerStep, tokensPerStep),
-            *ITensor::slice(packedMaskHost, bi * tokensPerStep, tokensPerStep));
-        manager.copy(*ITensor::at(positionIdsHostCopy, {gbi}), *ITensor::at(positionIdsHost, {bi}));
+        gatherRow(*decoderLookaheadBuffers.generationLengths, *generationLengthsDevice, gbi, bi, 1);
+        gatherRow(*decoderLookaheadBuffers.positionOffsets, *positionOffsetsDevice, gbi, bi, positionsPerRow);
+        gatherRow(*decoderLookaheadBuffers.packedMasks, *packedMasksDevice, gbi, bi, masksPerRow);
+        gatherRow(*decoderLookaheadBuffers.positionIds, *positionIdsDevice, gbi, bi, positionsPerRow);
+    }
+    if (!copies.empty())
+    {
+        // The kernel reads the descriptors from pinned memory, which is released after the synchronize below
+        auto const numCopyBytes = copies.size() * sizeof(kernels::BatchedCopy);
+        auto copiesHost = BufferManager::pinnedPool(numCopyBytes, nvinfer1::DataType::kUINT8);
+        std::memcpy(copiesHost->data(), copies.data(), numCopyBytes);
+        auto const maxNumBytes = std::max_element(copies.begin(), copies.end(),
+            [](auto const& lhs, auto const& rhs) { return lhs.numBytes < rhs.numBytes; })->numBytes;
+        kernels::invokeBatchedCopy(static_cast<kernels::BatchedCopy const*>(copiesHost->data()), copies.size(),
+            maxNumBytes, manager.getStream());
+        manager.getStream().synchronize();
     }
-    manager.copy(*ITensor::slice(generationLengthsHost, 0, numGenSequences),
-        *ITensor::slice(generationLengthsDevice, 0, numGenSequences));
-    manager.copy(*ITensor::slice(positionOffsetsHost, 0, numGenSequences),
-        *ITensor::slice(positionOffsetsDevice, 0, numGenSequences));
-    manager.copy(*ITensor::slice(packedMaskHost, 0, numGenSequences * tokensPerStep),
-        *ITensor::slice(packedMasksDevice, 0, numGenSequences * tokensPerStep));
-    manager.copy(
-        *ITensor::slice(positionIdsHost, 0, numGenSequences), *ITensor::slice(positionIdsDevice, 0, numGenSequences));
-
-    manager.getStream().synchronize();
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -23,7 +23,13 @@
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/logger.h"
 #include "tensorrt_llm/common/memoryUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+#include "tensorrt_llm/kernels/lora/loraSgmv.h"
+#include "tensorrt_llm/runtime/loraCacheCounters.h"
 #include "tensorrt_llm/runtime/loraUtils.h"
+#include "tensorrt_llm/runtime/memoryCounters.h"
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -60,6 +66,7 @@ void LoraCachePageManager::initialize(BufferManager const& bufferManager)
     TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
 
     TLLM_LOG_DEBUG("pageConfig: " + to_string(mConfig));
+    MemoryCounters::TagScope const tagScope{MemoryTag::kLORA};
 
     std::size_t pageIdx = 0;
     while (pageIdx < static_cast<size_t>(mConfig.getTotalNumPages()))
@@ -149,15 +156,61 @@ ITensor::SharedPtr LoraCachePageManager::mutablePagePtr(std::size_t pageIdx)
 void LoraCache::put(TaskIdType taskId, TensorPtr sourceWeights, TensorPtr sourceConfig, bool load)
 {
     TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
+    TLLM_NVTX_SCOPED_RANGE(kLORA, put);
+    TLLM_CHECK_WITH_INFO(!mQuantized, "Quantized LoRA caches can only be filled by copyTask");
 
+    TensorPtr config = sourceConfig->getShape().nbDims == 2
+        ? sourceConfig
+        : ITensor::view(
+            sourceConfig, ITensor::makeShape({sourceConfig->getShape().d[1], sourceConfig->getShape().d[2]}));
+
+    TensorPtr weights = sourceWeights->getShape().nbDims == 2
+        ? sourceWeights
+        : ITensor::view(
+            sourceWeights, ITensor::makeShape({sourceWeights->getShape().d[1], sourceWeights->getShape().d[2]}));
+
+    auto taskValuePtr = addTask(taskId, config);
+    if (!taskValuePtr)
+    {
+        return;
+    }
+    auto taskValue = taskValuePtr.value();
+    {
+        std::lock_guard<std::mutex> lk(mCacheMutex);
+        taskValue->loadInProgress = false;
+    }
+
+    if (load)
+    {
+        loadWeights(*taskValue, weights, config);
+    }
+
+    bool isDone;
+    {
+        std::lock_guard<std::mutex> lk(mCacheMutex);
+        isDone = taskValue->done;
+    }
+    if (isDone)
+    {
+        markTaskDone(taskId);
+    }
+    TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
+}
+
+std::optional<LoraCache::TaskValuePtr> LoraCache::addTask(TaskIdType taskId, TensorPtr const& config)
+{
+    // The task is added with loadInProgress set, so that loadWeights does not run before the pages are claimed
     auto taskValuePtr = [&]() -> std::optional<TaskValuePtr>
     {
         std::lock_guard<std::mutex> cacheLock(mCacheMutex);
+        auto const tier = LoraCacheCounters::getTier(mPageManagerConfig.getMemoryType());
         if (kVALUE_STATUS_MISSING != getStatus(taskId))
         {
             bumpTaskInProgress(taskId);
+            LoraCacheCounters::getInstance().recordHit(tier);
             return std::nullopt;
         }
+        LoraCacheCounters::getInstance().recordMiss(tier);
 
         mInProgressTasks.push_front(taskId);
         TaskValuePtr cacheV = std::make_shared<TaskValue>(std::vector<std::size_t>{}, TaskLayerModuleConfigListPtr(),
@@ -167,20 +220,10 @@ void LoraCache::put(TaskIdType taskId, TensorPtr sourceWeights, TensorPtr source
     }();
     if (!taskValuePtr)
     {
-        return;
+        return std::nullopt;
     }
     auto taskValue = taskValuePtr.value();
 
-    TensorPtr config = sourceConfig->getShape().nbDims == 2
-        ? sourceConfig
-        : ITensor::view(
-            sourceConfig, ITensor::makeShape({sourceConfig->getShape().d[1], sourceConfig->getShape().d[2]}));
-
-    TensorPtr weights = sourceWeights->getShape().nbDims == 2
-        ? sourceWeights
-        : ITensor::view(
-            sourceWeights, ITensor::makeShape({sourceWeights->getShape().d[1], sourceWeights->getShape().d[2]}));
-
     auto neededPages = determineNumPages(config);
     std::vector<size_t> pageIds{};
     try
@@ -196,19 +239,70 @@ void LoraCache::put(TaskIdType taskId, TensorPtr sourceWeights, TensorPtr source
     }
 
     taskValue->pageIds = std::move(pageIds);
+    return taskValue;
+}
+
+bool LoraCache::putPages(TaskIdType taskId, TensorPtr sourceConfig, PageFillFn const& fillPages)
+{
+    TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
+    TLLM_NVTX_SCOPED_RANGE(kLORA, putPages);
+    TLLM_CHECK_WITH_INFO(!mQuantized, "Quantized LoRA caches can only be filled by copyTask");
+
+    TensorPtr config = sourceConfig->getShape().nbDims == 2
+        ? sourceConfig
+        : ITensor::view(
+            sourceConfig, ITensor::makeShape({sourceConfig->getShape().d[1], sourceConfig->getShape().d[2]}));
+
+    auto taskValuePtr = addTask(taskId, config);
+    if (!taskValuePtr)
     {
-        std::lock_guard<std::mutex> lk(mCacheMutex);
-        taskValue->loadInProgress = false;
+        return false;
     }
+    auto taskValue = taskValuePtr.value();
 
-    if (load)
+    std::vector<TensorPtr> pages{};
+    pages.reserve(taskValue->pageIds.size());
+    for (auto id : taskValue->pageIds)
     {
-        loadWeights(*taskValue, weights, config);
+        pages.push_back(mCachePageManager->mutablePagePtr(id));
+    }
+
+    auto const tpSize = mWorldConfig.getTensorParallelism();
+    auto const pageWidth = mPageManagerConfig.getPageWidth();
+    auto const locations = locateRows(config, mModelConfig, mWorldConfig, mModuleIdToModule,
+        mPageManagerConfig.getSlotsPerPage(), pageWidth);
+    std::vector<SizeType32> usedSlots(pages.size(), 0);
+    auto configs = std::make_shared<std::vector<TaskLayerModuleConfig>>();
+    configs->reserve(locations.size());
+    for (auto const& location : locations)
+    {
+        auto const configPtr = bufferCast<int32_t>(*ITensor::slice(config, location.row, 1));
+        auto const modId = configPtr[lora::kLORA_CONFIG_MODULE_OFF];
+        auto const adapterSize = configPtr[lora::kLORA_CONFIG_ADAPTER_SIZE_OFF];
+        auto const& module = mModuleIdToModule.at(modId);
+        auto const localInSize = module.localInSize(adapterSize, tpSize);
+        auto const localOutSize = module.localOutSize(adapterSize, tpSize);
+
+        TensorPtr slot = ITensor::view(ITensor::slice(pages.at(location.pageIdx), location.slotIdx, location.numSlots),
+            ITensor::makeShape({location.numSlots * pageWidth}));
+        configs->push_back(TaskLayerModuleConfig{taskValue->pageIds.at(location.pageIdx), location.slotIdx,
+            localInSize, localOutSize, modId, configPtr[lora::kLORA_CONFIG_LAYER_OFF], adapterSize, location.numSlots,
+            reinterpret_cast<std::int64_t>(ITensor::slice(slot, 0, localInSize)->data()),
+            reinterpret_cast<std::int64_t>(ITensor::slice(slot, localInSize, localOutSize)->data())});
+        usedSlots[location.pageIdx] = location.slotIdx + location.numSlots;
     }
 
+    auto const fillStart = std::chrono::steady_clock::now();
+    fillPages(pages, usedSlots);
+    LoraCacheCounters::getInstance().recordLoadTime(LoraCacheCounters::getTier(mPageManagerConfig.getMemoryType()),
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - fillStart).count());
+
+    taskValue->configs = std::move(configs);
     bool isDone;
     {
         std::lock_guard<std::mutex> lk(mCacheMutex);
+        taskValue->loadInProgress = false;
+        taskValue->loaded = true;
         isDone = taskValue->done;
     }
     if (isDone)
@@ -216,11 +310,14 @@ void LoraCache::put(TaskIdType taskId, TensorPtr sourceWeights, TensorPtr source
         markTaskDone(taskId);
     }
     TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
+    return true;
 }
 
 void LoraCache::loadWeights(TaskIdType taskId, TensorPtr sourceWeights, TensorPtr sourceConfig)
 {
     TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
+    TLLM_NVTX_SCOPED_RANGE(kLORA, loadWeights);
+    TLLM_CHECK_WITH_INFO(!mQuantized, "Quantized LoRA caches can only be filled by copyTask");
     auto taskValuePtr = [&]() -> std::optional<TaskValuePtr>
     {
         std::lock_guard<std::mutex> cacheLock(mCacheMutex);
@@ -275,6 +372,7 @@ void LoraCache::loadWeights(TaskIdType taskId, TensorPtr sourceWeights, TensorPt
 void LoraCache::loadWeights(TaskValue& taskValue, TensorPtr weights, TensorPtr config)
 {
     TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
+    auto const loadStart = std::chrono::steady_clock::now();
     std::vector<TensorPtr> pagePtrs{};
     pagePtrs.reserve(taskValue.pageIds.size());
     for (auto id : taskValue.pageIds)
@@ -289,6 +387,8 @@ void LoraCache::loadWeights(TaskValue& taskValue, TensorPtr weights, TensorPtr c
         taskValue.loadInProgress = false;
         taskValue.loaded = true;
     }
+    LoraCacheCounters::getInstance().recordLoadTime(LoraCacheCounters::getTier(mPageManagerConfig.getMemoryType()),
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count());
     TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -331,6 +431,8 @@ std::vector<std::size_t> LoraCache::claimPagesWithEvict(SizeType32 numPages)
         mDoneTasks.pop_back();
         mCacheMap.erase(taskIdsToEvict.at(i));
     }
+    LoraCacheCounters::getInstance().recordEvictions(
+        LoraCacheCounters::getTier(mPageManagerConfig.getMemoryType()), taskIdsToEvict.size());
     mCachePageManager->releasePages(pageIdsToEvict);
     auto pageIds = mCachePageManager->claimPages(numPages);
     TLLM_CHECK(pageIds.has_value());
@@ -457,7 +559,6 @@ SizeType32 LoraCache::determineNumPages(TensorPtr loraConfig) const
     SizeType32 currPage = 0;
     SizeType32 currSlot = 0;
     SizeType32 const slotsPerPage = mPageManagerConfig.getSlotsPerPage();
-    SizeType32 const pageWidth = mPageManagerConfig.getPageWidth();
     for (SizeType32 row = 0; row < loraConfig->getShape().d[0]; ++row)
     {
         auto const rowPtr = bufferCast<int32_t>(*ITensor::slice(loraConfig, row, 1));
@@ -466,8 +567,7 @@ SizeType32 LoraCache::determineNumPages(TensorPtr loraConfig) const
         {
             auto const adapterSize = rowPtr[lora::kLORA_CONFIG_ADAPTER_SIZE_OFF];
             auto const& module = mModuleIdToModule.at(rowPtr[lora::kLORA_CONFIG_MODULE_OFF]);
-            auto const localSize = module.localInOutSize(adapterSize, mWorldConfig.getTensorParallelism());
-            auto const numSlots = common::ceilDiv(localSize, pageWidth);
+            auto const numSlots = determineNumSlots(module, adapterSize);
             if (numSlots + currSlot > slotsPerPage)
             {
                 currSlot = 0;
@@ -481,25 +581,75 @@ SizeType32 LoraCache::determineNumPages(TensorPtr loraConfig) const
     return currPage + 1;
 }
 
+SizeType32 LoraCache::determineNumPages(std::vector<TaskLayerModuleConfig> const& configs) const
+{
+    SizeType32 currPage = 0;
+    SizeType32 currSlot = 0;
+    SizeType32 const slotsPerPage = mPageManagerConfig.getSlotsPerPage();
+    for (auto const& config : configs)
+    {
+        auto const numSlots = determineNumSlots(mModuleIdToModule.at(config.moduleId), config.adapterSize);
+        if (numSlots + currSlot > slotsPerPage)
+        {
+            currSlot = 0;
+            ++currPage;
+        }
+        currSlot += numSlots;
+    }
+    return currPage + 1;
+}
+
+SizeType32 LoraCache::determineNumSlots(LoraModule const& module, SizeType32 adapterSize) const
+{
+    auto const tpSize = mWorldConfig.getTensorParallelism();
+    auto const localSize = mQuantized ? lora::getQuantizedLocalInOutSize(module, adapterSize, tpSize)
+                                      : module.localInOutSize(adapterSize, tpSize);
+    return common::ceilDiv(localSize, mPageManagerConfig.getPageWidth());
+}
+
 LoraCache::LoraCache(LoraCachePageManagerConfig const& pageManagerConfig, ModelConfig const& modelConfig,
     WorldConfig const& worldConfig, BufferManager const& bufferManager)
     : mPageManagerConfig(pageManagerConfig)
     , mModelConfig(modelConfig)
     , mWorldConfig(worldConfig)
 {
-    mCachePageManager = std::make_unique<LoraCachePageManager>(mPageManagerConfig, bufferManager);
-
     auto modules = modelConfig.getLoraModules();
     for (auto const& m : modules)
     {
         mModuleIdToModule[m.value()] = m;
     }
 
-    mBufferManager = std::make_unique<BufferManager>(std::make_shared<CudaStream>());
+    // Quantized pages take 1 byte per value, the same memory holds typeSize times as many pages
+    auto const quantizedType = kernels::getLoraQuantizedCacheType();
+    if (quantizedType && mPageManagerConfig.getMemoryType() == runtime::MemoryType::kGPU)
+    {
+        TLLM_CHECK_WITH_INFO(mPageManagerConfig.getPageWidth() % 16 == 0,
+            "Quantized LoRA caches need a page width multiple of 16, got %d", mPageManagerConfig.getPageWidth());
+        for (auto const& m : modules)
+        {
+            auto const moduleType = static_cast<LoraModule::ModuleType>(m.value());
+            TLLM_CHECK_WITH_INFO(moduleType != LoraModule::ModuleType::kMOE_H_TO_4H
+                    && moduleType != LoraModule::ModuleType::kMOE_4H_TO_H
+                    && moduleType != LoraModule::ModuleType::kMOE_GATE,
+                "Quantized LoRA caches do not support the MoE LoRA module %s", std::string(m.name()).c_str());
+        }
+        auto const typeSize = static_cast<SizeType32>(BufferDataType(mPageManagerConfig.getDataType()).getSize());
+        mPageManagerConfig.setDataType(*quantizedType);
+        mPageManagerConfig.setTotalNumPage(mPageManagerConfig.getTotalNumPages() * typeSize);
+        mPageManagerConfig.setMaxPagesPerBlock(mPageManagerConfig.getMaxPagesPerBlock() * typeSize);
+        mQuantized = true;
+        TLLM_LOG_INFO("LoRA device cache stores the adapters quantized to %s in %d pages",
+            common::getEnvLoraDeviceCacheDataType()->c_str(), mPageManagerConfig.getTotalNumPages());
+    }
+
+    mCachePageManager = std::make_unique<LoraCachePageManager>(mPageManagerConfig, bufferManager);
+
+    mBufferManager = std::make_unique<BufferManager>(std::make_shared<CudaStream>(), false, MemoryPoolClass::kLORA);
 
     for (size_t i = 0; i < static_cast<size_t>(mPageManagerConfig.getNumCopyStreams()); ++i)
     {
-        mDeviceBufferManagers.push_back(std::make_unique<BufferManager>(std::make_shared<CudaStream>()));
+        mDeviceBufferManagers.push_back(
+            std::make_unique<BufferManager>(std::make_shared<CudaStream>(), false, MemoryPoolClass::kLORA));
     }
 }
 
@@ -546,43 +696,18 @@ void LoraCache::splitTransposeCpu(ITensor& output, ITensor const& input, SizeTyp
     TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
 }
 
-std::vector<LoraCache::TaskLayerModuleConfig> LoraCache::copyToPages(TensorPtr sourceWeights, TensorPtr sourceConfig,
-    ModelConfig const& modelConfig, WorldConfig const& worldConfig,
-    std::unordered_map<SizeType32, LoraModule> moduleIdToModule, BufferManager const& manager,
-    std::vector<TensorPtr> const& pages, std::vector<std::size_t> const& pageIds)
+std::vector<LoraCache::RowLocation> LoraCache::locateRows(TensorPtr const& config, ModelConfig const& modelConfig,
+    WorldConfig const& worldConfig, std::unordered_map<SizeType32, LoraModule> const& moduleIdToModule,
+    SizeType32 slotsPerPage, SizeType32 pageWidth)
 {
-    TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
-
-    TLLM_CHECK_WITH_INFO(!pages.empty(), "empty pages");
-
-    TensorPtr weights = sourceWeights->getShape().nbDims == 2
-        ? sourceWeights
-        : ITensor::view(
-            sourceWeights, ITensor::makeShape({sourceWeights->getShape().d[1], sourceWeights->getShape().d[2]}));
-
-    TensorPtr config = sourceConfig->getShape().nbDims == 2
-        ? sourceConfig
-        : ITensor::view(
-            sourceConfig, ITensor::makeShape({sourceConfig->getShape().d[1], sourceConfig->getShape().d[2]}));
-
-    TLLM_CHECK(pages[0]->getShape().nbDims == 2);
-    auto const slotsPerPage = pages[0]->getShape().d[0];
-    auto const pageWidth = pages[0]->getShape().d[1];
-
     auto const tpSize = worldConfig.getTensorParallelism();
-    auto const tpRank = worldConfig.getTensorParallelRank();
-    auto const ppSize = worldConfig.getPipelineParallelism();
-    auto const ppRank = worldConfig.getPipelineParallelRank();
-    auto const localNumLayers = modelConfig.getNbAttentionLayers(ppSize);
-    auto const firstLayerId = ppRank * localNumLayers;
+    auto const localNumLayers = modelConfig.getNbAttentionLayers(worldConfig.getPipelineParallelism());
+    auto const firstLayerId = worldConfig.getPipelineParallelRank() * localNumLayers;
     auto const lastLayerId = firstLayerId + localNumLayers;
 
     SizeType32 currPage = 0;
     SizeType32 currSlot = 0;
-
-    std::vector<SizeType32> rowPage;
-    std::vector<SizeType32> rowSlot;
-    std::vector<SizeType32> rowIndices;
+    std::vector<RowLocation> locations;
 
     auto const numRows = config->getShape().d[0];
     for (SizeType32 row = 0; row < numRows; ++row)
@@ -596,29 +721,57 @@ std::vector<LoraCache::TaskLayerModuleConfig> LoraCache::copyToPages(TensorPtr s
             auto const modId = configPtr[lora::kLORA_CONFIG_MODULE_OFF];
             auto const& module = moduleIdToModule.at(modId);
             auto const localInOutSize = module.localInOutSize(adapterSize, tpSize);
-            auto const rowSlots = common::ceilDiv(localInOutSize, pageWidth);
+            auto const rowSlots = static_cast<SizeType32>(common::ceilDiv(localInOutSize, pageWidth));
             if (currSlot + rowSlots > slotsPerPage)
             {
                 currSlot = 0;
                 ++currPage;
             }
 
-            rowIndices.push_back(row);
-            rowSlot.push_back(currSlot);
-            rowPage.push_back(currPage);
+            locations.push_back(RowLocation{row, currPage, currSlot, rowSlots});
             currSlot += rowSlots;
         }
     }
+    return locations;
+}
+
+std::vector<LoraCache::TaskLayerModuleConfig> LoraCache::copyToPages(TensorPtr sourceWeights, TensorPtr sourceConfig,
+    ModelConfig const& modelConfig, WorldConfig const& worldConfig,
+    std::unordered_map<SizeType32, LoraModule> moduleIdToModule, BufferManager const& manager,
+    std::vector<TensorPtr> const& pages, std::vector<std::size_t> const& pageIds)
+{
+    TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
 
-    std::vector<LoraCache::TaskLayerModuleConfig> pageLocations(rowIndices.size());
-    for (SizeType32 i = 0; i < static_cast<SizeType32>(rowIndices.size()); ++i)
+    TLLM_CHECK_WITH_INFO(!pages.empty(), "empty pages");
+
+    TensorPtr weights = sourceWeights->getShape().nbDims == 2
+        ? sourceWeights
+        : ITensor::view(
+            sourceWeights, ITensor::makeShape({sourceWeights->getShape().d[1], sourceWeights->getShape().d[2]}));
+
+    TensorPtr config = sourceConfig->getShape().nbDims == 2
+        ? sourceConfig
+        : ITensor::view(
+            sourceConfig, ITensor::makeShape({sourceConfig->getShape().d[1], sourceConfig->getShape().d[2]}));
+
+    TLLM_CHECK(pages[0]->getShape().nbDims == 2);
+    auto const slotsPerPage = pages[0]->getShape().d[0];
+    auto const pageWidth = pages[0]->getShape().d[1];
+
+    auto const tpSize = worldConfig.getTensorParallelism();
+    auto const tpRank = worldConfig.getTensorParallelRank();
+
+    auto const locations = locateRows(config, modelConfig, worldConfig, moduleIdToModule, slotsPerPage, pageWidth);
+
+    std::vector<LoraCache::TaskLayerModuleConfig> pageLocations(locations.size());
+    for (SizeType32 i = 0; i < static_cast<SizeType32>(locations.size()); ++i)
     {
-        auto copyFn = [i = i, &rowIndices, &rowPage, &rowSlot, &pageLocations, weights, config, &pages,
-                          &moduleIdToModule, &manager, pageWidth, tpSize, tpRank, pageIds]()
+        auto copyFn = [i = i, &locations, &pageLocations, weights, config, &pages, &moduleIdToModule, &manager,
+                          pageWidth, tpSize, tpRank, pageIds]()
         {
-            auto const row = rowIndices[i];
-            auto const currPage = rowPage[i];
-            auto const currSlot = rowSlot[i];
+            auto const row = locations[i].row;
+            auto const currPage = locations[i].pageIdx;
+            auto const currSlot = locations[i].slotIdx;
             auto const configPtr = bufferCast<int32_t>(*ITensor::slice(config, row, 1));
             auto const layerId = configPtr[lora::kLORA_CONFIG_LAYER_OFF];
 
@@ -729,9 +882,93 @@ std::map<size_t, std::pair<size_t, SizeType32>> LoraCache::copyTaskMapPages(Task
     return oldToNewPageIds;
 }
 
+void LoraCache::copyTaskQuantizePages(TaskValue& targetTaskValue, TaskValue const& sourceTaskValue,
+    std::vector<size_t> const& targetPageIds, LoraCache& targetCache, size_t bufferManagerOffset) const
+{
+    auto const quantizedType = targetCache.mPageManagerConfig.getDataType();
+    auto const pageWidth = static_cast<std::size_t>(targetCache.mPageManagerConfig.getPageWidth());
+    auto const slotsPerPage = targetCache.mPageManagerConfig.getSlotsPerPage();
+    auto const pageSize = pageWidth * slotsPerPage;
+    auto const tpSize = mWorldConfig.getTensorParallelism();
+    auto const alignedSize = [](std::size_t size) { return common::ceilDiv(size, 16) * 16; };
+
+    // Quantize all pages of the task on the host, then copy them to the target pages.
+    TensorPtr staging = BufferManager::pinnedPool(
+        ITensor::makeShape({static_cast<SizeType32>(targetPageIds.size() * pageSize)}), quantizedType);
+    auto* stagingData = static_cast<std::uint8_t*>(staging->data());
+    std::vector<SizeType32> usedSlots(targetPageIds.size(), 0);
+
+    auto const& sourceConfigs = *sourceTaskValue.configs;
+    targetTaskValue.configs = std::make_shared<std::vector<TaskLayerModuleConfig>>(sourceConfigs);
+    targetTaskValue.pageIds = targetPageIds;
+    auto& targetConfigs = *targetTaskValue.configs;
+    std::size_t currPage = 0;
+    SizeType32 currSlot = 0;
+    for (size_t i = 0; i < sourceConfigs.size(); ++i)
+    {
+        auto const& source = sourceConfigs[i];
+        auto const& module = mModuleIdToModule.at(source.moduleId);
+        auto const numSlots = targetCache.determineNumSlots(module, source.adapterSize);
+        TLLM_CHECK_WITH_INFO(numSlots <= slotsPerPage, "A quantized LoRA module does not fit in a page");
+        if (currSlot + numSlots > slotsPerPage)
+        {
+            currSlot = 0;
+            ++currPage;
+        }
+        TLLM_CHECK(currPage < targetPageIds.size());
+
+        auto const inRows = module.localInAdapterSize(source.adapterSize, tpSize);
+        auto const outRows = module.localOutDim(tpSize);
+        auto const inOffset = kernels::getLoraQuantScalesSize(inRows);
+        auto const outOffset = inOffset + alignedSize(source.inSize) + kernels::getLoraQuantScalesSize(outRows);
+        auto* slot = stagingData + currPage * pageSize + currSlot * pageWidth;
+        // Scales first, see kernels::getLoraQuantScalesSize
+        lora::quantizeWeightRows(slot + inOffset, reinterpret_cast<float*>(slot),
+            reinterpret_cast<void const*>(source.weightsInPointer), inRows, source.inSize / inRows,
+            mPageManagerConfig.getDataType(), quantizedType);
+        lora::quantizeWeightRows(slot + outOffset,
+            reinterpret_cast<float*>(slot + outOffset - kernels::getLoraQuantScalesSize(outRows)),
+            reinterpret_cast<void const*>(source.weightsOutPointer), outRows, source.outSize / outRows,
+            mPageManagerConfig.getDataType(), quantizedType);
+
+        auto* pageData = static_cast<std::uint8_t*>(
+            targetCache.mCachePageManager->mutablePagePtr(targetPageIds[currPage])->data());
+        auto* targetSlot = pageData + currSlot * pageWidth;
+        auto& target = targetConfigs[i];
+        target.pageId = targetPageIds[currPage];
+        target.slotIdx = currSlot;
+        target.numSlots = numSlots;
+        target.weightsInPointer = reinterpret_cast<std::int64_t>(targetSlot + inOffset);
+        target.weightsOutPointer = reinterpret_cast<std::int64_t>(targetSlot + outOffset);
+
+        currSlot += numSlots;
+        usedSlots[currPage] = currSlot;
+    }
+
+    std::vector<CudaEvent> copyEvents(targetPageIds.size());
+    for (size_t pageIdx = 0; pageIdx < targetPageIds.size(); ++pageIdx)
+    {
+        auto const copySize = usedSlots[pageIdx] * pageWidth;
+        TensorPtr source = ITensor::slice(staging, pageIdx * pageSize, copySize);
+        auto const page = targetCache.mCachePageManager->mutablePagePtr(targetPageIds[pageIdx]);
+        TensorPtr dest
+            = ITensor::slice(ITensor::view(page, ITensor::makeShape({static_cast<SizeType32>(pageSize)})), 0, copySize);
+        auto& manager = *targetCache.mDeviceBufferManagers[bufferManagerOffset];
+        manager.copy(*source, *dest);
+        manager.getStream().record(copyEvents[pageIdx]);
+        bufferManagerOffset = (bufferManagerOffset + 1) % targetCache.mDeviceBufferManagers.size();
+    }
+    // The staging buffer is released on return
+    for (auto const& event : copyEvents)
+    {
+        event.synchronize();
+    }
+}
+
 void LoraCache::copyTask(TaskIdType taskId, LoraCache& deviceCache, bool markDone)
 {
     TLLM_LOG_DEBUG("%s start", __PRETTY_FUNCTION__);
+    TLLM_NVTX_SCOPED_RANGE(kLORA, copyTask);
     TLLM_LOG_DEBUG("copyTask " + std::to_string(taskId));
 
     TLLM_CHECK_WITH_INFO(deviceCache.mPageManagerConfig.getMemoryType() == runtime::MemoryType::kGPU
@@ -760,7 +997,8 @@ void LoraCache::copyTask(TaskIdType taskId, LoraCache& deviceCache, bool markDon
     }();
 
     auto& pageIds = taskValue->pageIds;
-    auto neededPages = pageIds.size();
+    auto neededPages
+        = deviceCache.mQuantized ? deviceCache.determineNumPages(*taskValue->configs) : pageIds.size();
 
     // Now create put the task in the target cache
     // TaskValue* otherTaskValuePtr = copyTaskGetOtherTaskValue(taskId, taskValue, deviceCache, markDone);
@@ -772,8 +1010,10 @@ void LoraCache::copyTask(TaskIdType taskId, LoraCache& deviceCache, bool markDon
         {
             deviceCache.bumpTaskInProgress(taskId);
             taskValue->loaded = true;
+            LoraCacheCounters::getInstance().recordHit(LoraCacheCounters::Tier::kDEVICE);
             return std::nullopt;
         }
+        LoraCacheCounters::getInstance().recordMiss(LoraCacheCounters::Tier::kDEVICE);
 
         deviceCache.mInProgressTasks.push_front(taskId);
         auto cacheV = std::make_shared<TaskValue>(std::vector<std::size_t>{}, TaskLayerModuleConfigListPtr(),
@@ -788,6 +1028,7 @@ void LoraCache::copyTask(TaskIdType taskId, LoraCache& deviceCache, bool markDon
         return;
     }
     TaskValuePtr otherTaskValue = optOtherTaskValuePtr.value();
+    auto const copyStart = std::chrono::steady_clock::now();
 
     std::vector<size_t> newPageIds{};
     try
@@ -805,35 +1046,45 @@ void LoraCache::copyTask(TaskIdType taskId, LoraCache& deviceCache, bool markDon
         }
     }
 
-    auto oldToNewPageIds = copyTaskMapPages(*otherTaskValue, *taskValue, newPageIds, deviceCache);
-
-    auto const flatPageShape
-        = ITensor::makeShape({mPageManagerConfig.getPageWidth() * mPageManagerConfig.getSlotsPerPage()});
     size_t bufferManagerOffset = taskId % deviceCache.mDeviceBufferManagers.size();
-    std::vector<CudaEvent> copyEvents(otherTaskValue->pageIds.size());
-    size_t eventIdx = 0;
-    for (auto const& [oldPageId, newPagePair] : oldToNewPageIds)
-    {
-        auto const newPageId = newPagePair.first;
-        auto const copySize = newPagePair.second * mPageManagerConfig.getPageWidth();
-        auto const copyShape = ITensor::makeShape({copySize});
-        TLLM_LOG_DEBUG("copy page (task " + std::to_string(taskId) + ") " + std::to_string(oldPageId) + " -> "
-            + std::to_string(newPageId) + " size: " + std::to_string(copySize));
-        TensorPtr oldPagePtr = mCachePageManager->mutablePagePtr(oldPageId);
-        TensorPtr newPagePtr = deviceCache.mCachePageManager->mutablePagePtr(newPageId);
-        TensorPtr source
-            = ITensor::view(ITensor::slice(ITensor::view(oldPagePtr, flatPageShape), 0, copySize), copyShape);
-        TensorPtr dest
-            = ITensor::view(ITensor::slice(ITensor::view(newPagePtr, flatPageShape), 0, copySize), copyShape);
-        deviceCache.mDeviceBufferManagers[bufferManagerOffset]->copy(*source, *dest);
-        deviceCache.mDeviceBufferManagers[bufferManagerOffset]->getStream().record(copyEvents[eventIdx++]);
-        bufferManagerOffset = (bufferManagerOffset + 1) % deviceCache.mDeviceBufferManagers.size();
+    if (deviceCache.mQuantized)
+    {
+        copyTaskQuantizePages(*otherTaskValue, *taskValue, newPageIds, deviceCache, bufferManagerOffset);
     }
-    for (auto const& event : copyEvents)
+    else
     {
-        event.synchronize();
+        auto oldToNewPageIds = copyTaskMapPages(*otherTaskValue, *taskValue, newPageIds, deviceCache);
+
+        auto const flatPageShape
+            = ITensor::makeShape({mPageManagerConfig.getPageWidth() * mPageManagerConfig.getSlotsPerPage()});
+        std::vector<CudaEvent> copyEvents(otherTaskValue->pageIds.size());
+        size_t eventIdx = 0;
+        for (auto const& [oldPageId, newPagePair] : oldToNewPageIds)
+        {
+            auto const newPageId = newPagePair.first;
+            auto const copySize = newPagePair.second * mPageManagerConfig.getPageWidth();
+            auto const copyShape = ITensor::makeShape({copySize});
+            TLLM_LOG_DEBUG("copy page (task " + std::to_string(taskId) + ") " + std::to_string(oldPageId) + " -> "
+                + std::to_string(newPageId) + " size: " + std::to_string(copySize));
+            TensorPtr oldPagePtr = mCachePageManager->mutablePagePtr(oldPageId);
+            TensorPtr newPagePtr = deviceCache.mCachePageManager->mutablePagePtr(newPageId);
+            TensorPtr source
+                = ITensor::view(ITensor::slice(ITensor::view(oldPagePtr, flatPageShape), 0, copySize), copyShape);
+            TensorPtr dest
+                = ITensor::view(ITensor::slice(ITensor::view(newPagePtr, flatPageShape), 0, copySize), copyShape);
+            deviceCache.mDeviceBufferManagers[bufferManagerOffset]->copy(*source, *dest);
+            deviceCache.mDeviceBufferManagers[bufferManagerOffset]->getStream().record(copyEvents[eventIdx++]);
+            bufferManagerOffset = (bufferManagerOffset + 1) % deviceCache.mDeviceBufferManagers.size();
+        }
+        for (auto const& event : copyEvents)
+        {
+            event.synchronize();
+        }
     }
 
+    LoraCacheCounters::getInstance().recordLoadTime(LoraCacheCounters::Tier::kDEVICE,
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - copyStart).count());
+
     bool otherIsDone;
     {
         std::lock_guard<std::mutex> lk(mCacheMutex);
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/loraCacheCounters.h"
+
+namespace tensorrt_llm::runtime
+{
+
+void LoraCacheCounters::recordHit(Tier tier)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    ++(tier == Tier::kDEVICE ? mStats.numDeviceHits : mStats.numHostHits);
+}
+
+void LoraCacheCounters::recordMiss(Tier tier)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    ++(tier == Tier::kDEVICE ? mStats.numDeviceMisses : mStats.numHostMisses);
+}
+
+void LoraCacheCounters::recordEvictions(Tier tier, std::size_t numEvictions)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    (tier == Tier::kDEVICE ? mStats.numDeviceEvictions : mStats.numHostEvictions) += numEvictions;
+}
+
+void LoraCacheCounters::recordLoadTime(Tier tier, double loadMS)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    (tier == Tier::kDEVICE ? mStats.deviceLoadMS : mStats.hostLoadMS) += loadMS;
+}
+
+executor::LoraCacheStats LoraCacheCounters::getStats()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto const stats = mStats;
+    mStats = executor::LoraCacheStats{};
+    return stats;
+}
+
+LoraCacheCounters& LoraCacheCounters::getInstance()
+{
+    static LoraCacheCounters mInstance;
+    return mInstance;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/loraMerger.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/kernels/lora/loraMerge.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+// Renormalize the weights of LoraMergePolicy before the increment gets close to overflowing.
+double constexpr kMaxIncrement = 1e100;
+// Tasks with a smaller share are dropped on renormalization.
+double constexpr kMinShare = 1e-6;
+} // namespace
+
+LoraMergePolicy::LoraMergePolicy(Config config)
+    : mConfig{config}
+{
+    TLLM_CHECK_WITH_INFO(mConfig.unmergeShare <= mConfig.mergeShare,
+        "The unmerge share %f must not exceed the merge share %f", mConfig.unmergeShare, mConfig.mergeShare);
+    TLLM_CHECK_WITH_INFO(mConfig.mergeShare > 0.5f, "The merge share must exceed 0.5, got %f", mConfig.mergeShare);
+    TLLM_CHECK_WITH_INFO(mConfig.decay > 0.f && mConfig.decay <= 1.f, "Invalid decay %f", mConfig.decay);
+}
+
+void LoraMergePolicy::record(std::optional<TaskIdType> taskId)
+{
+    ++mNumRequests;
+    mIncrement /= mConfig.decay;
+    if (mIncrement > kMaxIncrement)
+    {
+        mTotalWeight /= mIncrement;
+        for (auto it = mTaskWeights.begin(); it != mTaskWeights.end();)
+        {
+            it->second /= mIncrement;
+            it = it->second < kMinShare * mTotalWeight ? mTaskWeights.erase(it) : std::next(it);
+        }
+        mIncrement = 1.0;
+    }
+    mTotalWeight += mIncrement;
+    if (taskId)
+    {
+        mTaskWeights[*taskId] += mIncrement;
+    }
+}
+
+float LoraMergePolicy::getShare(TaskIdType taskId) const
+{
+    auto const it = mTaskWeights.find(taskId);
+    if (it == mTaskWeights.end() || mTotalWeight == 0.0)
+    {
+        return 0.f;
+    }
+    return static_cast<float>(it->second / mTotalWeight);
+}
+
+LoraMergePolicy::Decision LoraMergePolicy::update()
+{
+    if (mMergedTask)
+    {
+        auto const share = getShare(*mMergedTask);
+        if (share < mConfig.unmergeShare)
+        {
+            TLLM_LOG_INFO("Unmerging LoRA task %lu, its share dropped to %.2f", *mMergedTask, share);
+            auto const taskId = *mMergedTask;
+            mMergedTask.reset();
+            return Decision{Action::kUNMERGE, taskId};
+        }
+        return Decision{};
+    }
+    if (mNumRequests < mConfig.minRequests || mTaskWeights.empty())
+    {
+        return Decision{};
+    }
+    auto const top = std::max_element(mTaskWeights.begin(), mTaskWeights.end(),
+        [](auto const& lhs, auto const& rhs) { return lhs.second < rhs.second; });
+    auto const share = getShare(top->first);
+    if (share < mConfig.mergeShare)
+    {
+        return Decision{};
+    }
+    TLLM_LOG_INFO("Merging LoRA task %lu into the base weights, its share is %.2f", top->first, share);
+    mMergedTask = top->first;
+    return Decision{Action::kMERGE, top->first};
+}
+
+LoraWeightMerger::LoraWeightMerger(ModelConfig const& modelConfig, WorldConfig const& worldConfig,
+    WeightNameFn weightName)
+    : mDataType{modelConfig.getDataType()}
+    , mTpSize{worldConfig.getTensorParallelism()}
+    , mQRows{modelConfig.getNbHeads() * modelConfig.getSizePerHead()}
+    , mKvRows{modelConfig.getNbKvHeads() * modelConfig.getSizePerHead()}
+    , mWeightName{std::move(weightName)}
+{
+    for (auto const& module : modelConfig.getLoraModules())
+    {
+        mModules.emplace(module.value(), module);
+    }
+}
+
+std::string LoraWeightMerger::getDefaultWeightName(LoraModule::ModuleType moduleType, SizeType32 layerId)
+{
+    using ModuleType = LoraModule::ModuleType;
+    auto const prefix = "transformer.layers." + std::to_string(layerId) + ".";
+    switch (moduleType)
+    {
+    case ModuleType::kATTN_QKV:
+    case ModuleType::kATTN_Q:
+    case ModuleType::kATTN_K:
+    case ModuleType::kATTN_V: return prefix + "attention.qkv.weight";
+    case ModuleType::kATTN_DENSE: return prefix + "attention.dense.weight";
+    case ModuleType::kMLP_H_TO_4H: return prefix + "mlp.fc.weight";
+    case ModuleType::kMLP_4H_TO_H: return prefix + "mlp.proj.weight";
+    case ModuleType::kMLP_GATE: return prefix + "mlp.gate.weight";
+    case ModuleType::kCROSS_ATTN_QKV:
+    case ModuleType::kCROSS_ATTN_Q:
+    case ModuleType::kCROSS_ATTN_K:
+    case ModuleType::kCROSS_ATTN_V: return prefix + "cross_attention.qkv.weight";
+    case ModuleType::kCROSS_ATTN_DENSE: return prefix + "cross_attention.dense.weight";
+    default: TLLM_THROW("LoRA module %s cannot be merged", std::string(LoraModule::toModuleName(moduleType)).c_str());
+    }
+}
+
+LoraWeightMerger::Target LoraWeightMerger::getTarget(LoraModule const& module, SizeType32 layerId) const
+{
+    using ModuleType = LoraModule::ModuleType;
+    SizeType32 rowOffset = 0;
+    switch (static_cast<ModuleType>(module.value()))
+    {
+    case ModuleType::kATTN_K:
+    case ModuleType::kCROSS_ATTN_K: rowOffset = mQRows; break;
+    case ModuleType::kATTN_V:
+    case ModuleType::kCROSS_ATTN_V: rowOffset = mQRows + mKvRows; break;
+    default: break;
+    }
+    return Target{mWeightName(static_cast<ModuleType>(module.value()), layerId), rowOffset};
+}
+
+std::map<std::string, executor::Tensor> LoraWeightMerger::merge(
+    std::vector<TaskLayerModuleConfig> const& task, TensorMap const& baseWeights, BufferManager const& manager) const
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    std::map<std::string, ITensor::SharedPtr> merged;
+    for (auto const& config : task)
+    {
+        auto const& module = mModules.at(config.moduleId);
+        auto const target = getTarget(module, config.layerId);
+        auto const base = baseWeights.find(target.name);
+        TLLM_CHECK_WITH_INFO(base != baseWeights.end(), "%s is not a managed weight", target.name.c_str());
+        auto const& shape = base->second->getShape();
+        auto const localInDim = module.localInDim(mTpSize);
+        auto const localOutDim = module.localOutDim(mTpSize);
+        TLLM_CHECK_WITH_INFO(base->second->getDataType() == mDataType,
+            "%s is quantized, only weights of the model data type can be merged", target.name.c_str());
+        TLLM_CHECK_WITH_INFO(
+            shape.nbDims == 2 && shape.d[1] == localInDim && target.rowOffset + localOutDim <= shape.d[0],
+            "%s of shape %s does not fit the %d x %d LoRA module %s", target.name.c_str(),
+            ITensor::toString(shape).c_str(), localOutDim, localInDim, std::string(module.name()).c_str());
+
+        auto it = merged.find(target.name);
+        if (it == merged.end())
+        {
+            it = merged.emplace(target.name, manager.copyFrom(*base->second, MemoryType::kGPU)).first;
+        }
+        auto* rows = static_cast<std::uint8_t*>(it->second->data())
+            + static_cast<std::size_t>(target.rowOffset) * localInDim * BufferDataType(mDataType).getSize();
+        kernels::invokeLoraMerge(rows, reinterpret_cast<void const*>(config.weightsInPointer),
+            reinterpret_cast<void const*>(config.weightsOutPointer), localInDim, localOutDim, config.adapterSize, 1.f,
+            mDataType, manager.getStream().get());
+    }
+
+    std::map<std::string, executor::Tensor> weights;
+    for (auto& [name, tensor] : merged)
+    {
+        weights.emplace(name, executor::detail::ofITensor(std::move(tensor)));
+    }
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+    return weights;
+}
+
+std::map<std::string, executor::Tensor> LoraWeightMerger::restore(
+    std::vector<TaskLayerModuleConfig> const& task, TensorMap const& baseWeights) const
+{
+    std::map<std::string, executor::Tensor> weights;
+    for (auto const& config : task)
+    {
+        auto const target = getTarget(mModules.at(config.moduleId), config.layerId);
+        if (weights.count(target.name) == 0)
+        {
+            auto const base = baseWeights.find(target.name);
+            TLLM_CHECK_WITH_INFO(base != baseWeights.end(), "%s is not a managed weight", target.name.c_str());
+            weights.emplace(target.name, executor::detail::ofITensor(base->second));
+        }
+    }
+    return weights;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/tensor.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/loraCache.h"
+#include "tensorrt_llm/runtime/loraModule.h"
+#include "tensorrt_llm/runtime/modelConfig.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Detects a LoRA adapter that dominates the traffic, so that it can be merged into the base weights.
+//! \details Requests of the merged adapter run on a merged-weight lane, a runtime of the same engine whose managed
+//! weights have the adapter folded in, and skip the LoRA GEMMs. Shares are taken over an exponentially decaying window
+//! of the recent requests. The adapter is taken out again once its share drops below a lower threshold than the one
+//! that merged it, so that a share around the threshold does not merge and unmerge the adapter on every update.
+class LoraMergePolicy
+{
+public:
+    using TaskIdType = LoraCache::TaskIdType;
+
+    struct Config
+    {
+        //! Share of the recent requests above which an adapter is merged
+        float mergeShare{0.6f};
+        //! Share below which the merged adapter is taken out again
+        float unmergeShare{0.4f};
+        //! Weight of the past kept on every request, the window spans about 1 / (1 - decay) requests
+        float decay{0.999f};
+        //! Number of requests to record before the first merge
+        SizeType32 minRequests{256};
+    };
+
+    enum class Action
+    {
+        kNONE,
+        kMERGE,
+        kUNMERGE,
+    };
+
+    struct Decision
+    {
+        Action action{Action::kNONE};
+        TaskIdType taskId{0};
+    };
+
+    explicit LoraMergePolicy(Config config);
+
+    LoraMergePolicy()
+        : LoraMergePolicy(Config{})
+    {
+    }
+
+    //! \brief Record a new request, std::nullopt for requests without LoRA.
+    void record(std::optional<TaskIdType> taskId);
+
+    //! \brief Share of a task in the recent requests.
+    [[nodiscard]] float getShare(TaskIdType taskId) const;
+
+    //! \brief Decide whether the merged task changes. The decision takes effect immediately, the caller stages the
+    //! weights of the lane accordingly. At most one task is merged, a different task is merged on a later update.
+    Decision update();
+
+    [[nodiscard]] std::optional<TaskIdType> getMergedTask() const noexcept
+    {
+        return mMergedTask;
+    }
+
+    //! \brief Whether a request runs on the merged-weight lane, without its LoRA weights.
+    [[nodiscard]] bool isMerged(std::optional<TaskIdType> taskId) const noexcept
+    {
+        return taskId.has_value() && taskId == mMergedTask;
+    }
+
+private:
+    Config mConfig;
+    // Weights of the tasks and of all requests, in units that grow by 1 / decay per request instead of decaying the
+    // past, renormalized before they overflow
+    std::unordered_map<TaskIdType, double> mTaskWeights;
+    double mTotalWeight{0.0};
+    double mIncrement{1.0};
+    std::int64_t mNumRequests{0};
+    std::optional<TaskIdType> mMergedTask;
+};
+
+//! \brief Builds the managed weights of a merged-weight lane: copies of the base weights a task adapts with the LoRA
+//! modules of the task folded in, W + B * A for in weights A [rank, in] and out weights B [out, rank].
+//! \details attn_q, attn_k and attn_v modules update their rows of the fused QKV weight. Only base weights of the model
+//! data type can be merged, quantized weights are rejected.
+class LoraWeightMerger
+{
+public:
+    using TensorMap = StringPtrMap<ITensor>;
+    using TaskLayerModuleConfig = LoraCache::TaskLayerModuleConfig;
+    //! Name of the managed weight a module of a layer adapts
+    using WeightNameFn = std::function<std::string(LoraModule::ModuleType moduleType, SizeType32 layerId)>;
+
+    LoraWeightMerger(ModelConfig const& modelConfig, WorldConfig const& worldConfig,
+        WeightNameFn weightName = getDefaultWeightName);
+
+    //! \brief Weight names of TensorRT-LLM checkpoints, e.g. transformer.layers.3.attention.qkv.weight.
+    static std::string getDefaultWeightName(LoraModule::ModuleType moduleType, SizeType32 layerId);
+
+    //! \brief Merged copies of the base weights a task adapts, to stage on the runtime of the lane.
+    //! \param task Layer module configs of the task in the device LoRA cache, which must not be quantized. The task
+    //! must stay in the cache until the copies, enqueued on the stream of manager, are done.
+    //! \param baseWeights Managed weights of a runtime without merged tasks, see TllmRuntime::getManagedWeights.
+    [[nodiscard]] std::map<std::string, executor::Tensor> merge(std::vector<TaskLayerModuleConfig> const& task,
+        TensorMap const& baseWeights, BufferManager const& manager) const;
+
+    //! \brief The base weights a task adapts, to stage on the runtime of the lane when the task is taken out.
+    [[nodiscard]] std::map<std::string, executor::Tensor> restore(
+        std::vector<TaskLayerModuleConfig> const& task, TensorMap const& baseWeights) const;
+
+private:
+    struct Target
+    {
+        std::string name;
+        //! First row of the base weight the module updates
+        SizeType32 rowOffset;
+    };
+
+    [[nodiscard]] Target getTarget(LoraModule const& module, SizeType32 layerId) const;
+
+    std::unordered_map<SizeType32, LoraModule> mModules;
+    nvinfer1::DataType mDataType;
+    SizeType32 mTpSize;
+    SizeType32 mQRows;
+    SizeType32 mKvRows;
+    WeightNameFn mWeightName;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/loraPrefetcher.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+#include "tensorrt_llm/common/safetensors.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+ITensor::SharedPtr copyToHost(common::safetensors::INdArray const& array)
+{
+    auto tensor = BufferManager::cpu(array.trtDims(), array.dtype());
+    std::memcpy(tensor->data(), array.data(), tensor->getSizeInBytes());
+    return tensor;
+}
+} // namespace
+
+LoraDirectoryStore::LoraDirectoryStore(std::filesystem::path directory)
+    : mDirectory{std::move(directory)}
+{
+    TLLM_CHECK_WITH_INFO(std::filesystem::is_directory(mDirectory), "LoRA adapter directory %s does not exist",
+        mDirectory.string().c_str());
+}
+
+std::filesystem::path LoraDirectoryStore::getPath(TaskIdType taskId) const
+{
+    return mDirectory / (std::to_string(taskId) + ".safetensors");
+}
+
+bool LoraDirectoryStore::contains(TaskIdType taskId) const
+{
+    return std::filesystem::is_regular_file(getPath(taskId));
+}
+
+LoraAdapterStore::Adapter LoraDirectoryStore::load(TaskIdType taskId) const
+{
+    auto const path = getPath(taskId);
+    auto file = common::safetensors::ISafeTensor::open(path.string().c_str());
+    auto const weights = file->getTensor("weights");
+    auto const config = file->getTensor("config");
+    return Adapter{copyToHost(*weights), copyToHost(*config)};
+}
+
+LoraPrefetcher::LoraPrefetcher(
+    std::shared_ptr<LoraAdapterStore> store, LoraCache& hostCache, std::shared_ptr<WorkerPool> workerPool)
+    : mStore{std::move(store)}
+    , mHostCache{hostCache}
+    , mWorkerPool{std::move(workerPool)}
+{
+    TLLM_CHECK(mStore && mWorkerPool);
+}
+
+std::shared_future<void> LoraPrefetcher::prefetch(TaskIdType taskId, WorkerPool::Priority priority)
+{
+    std::lock_guard<std::mutex> lk(mMutex);
+    ++mUseCounts[taskId];
+    if (auto const it = mLoads.find(taskId); it != mLoads.end())
+    {
+        if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            return it->second;
+        }
+        // The task may have been evicted since, check again.
+        mLoads.erase(it);
+    }
+    if (mHostCache.has(taskId))
+    {
+        std::promise<void> cached;
+        cached.set_value();
+        return cached.get_future().share();
+    }
+    if (!mStore->contains(taskId))
+    {
+        throw LoraExpectedException("LoRA task " + std::to_string(taskId) + " is neither cached nor in the store");
+    }
+
+    ++mNumLoads;
+    auto future = mWorkerPool->enqueue([this, taskId]() { load(taskId); }, priority).share();
+    mLoads.emplace(taskId, future);
+    return future;
+}
+
+bool LoraPrefetcher::isReady(TaskIdType taskId)
+{
+    std::shared_future<void> future;
+    {
+        std::lock_guard<std::mutex> lk(mMutex);
+        auto const it = mLoads.find(taskId);
+        if (it == mLoads.end())
+        {
+            return mHostCache.has(taskId);
+        }
+        if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            return false;
+        }
+        future = std::move(it->second);
+        mLoads.erase(it);
+    }
+    future.get();
+    return true;
+}
+
+void LoraPrefetcher::load(TaskIdType taskId)
+{
+    TLLM_NVTX_SCOPED_RANGE(kLORA, load);
+    TLLM_LOG_DEBUG("Loading LoRA task " + std::to_string(taskId) + " from the adapter store");
+    auto const adapter = mStore->load(taskId);
+    mHostCache.put(taskId, adapter.weights, adapter.config);
+}
+
+std::vector<LoraPrefetcher::TaskIdType> LoraPrefetcher::getHotTasks(SizeType32 maxNumTasks) const
+{
+    std::vector<std::pair<std::uint64_t, TaskIdType>> counts;
+    {
+        std::lock_guard<std::mutex> lk(mMutex);
+        counts.reserve(mUseCounts.size());
+        for (auto const& [taskId, count] : mUseCounts)
+        {
+            counts.emplace_back(count, taskId);
+        }
+    }
+    auto const numTasks = std::min(counts.size(), static_cast<std::size_t>(std::max(maxNumTasks, 0)));
+    std::partial_sort(counts.begin(), counts.begin() + numTasks, counts.end(), std::greater<>{});
+
+    std::vector<TaskIdType> hotTasks;
+    hotTasks.reserve(numTasks);
+    std::transform(counts.begin(), counts.begin() + numTasks, std::back_inserter(hotTasks),
+        [](auto const& countAndTask) { return countAndTask.second; });
+    return hotTasks;
+}
+
+SizeType32 LoraPrefetcher::promoteHotTasks(LoraCache& deviceCache, SizeType32 maxNumTasks)
+{
+    TLLM_NVTX_SCOPED_RANGE(kLORA, promoteHotTasks);
+    SizeType32 numPromoted = 0;
+    for (auto const taskId : getHotTasks(maxNumTasks))
+    {
+        // Tasks of active requests are brought to the device by ensureBatch.
+        if (deviceCache.has(taskId) || !mHostCache.isLoaded(taskId) || !mHostCache.isDone(taskId))
+        {
+            continue;
+        }
+        try
+        {
+            mHostCache.copyTask(taskId, deviceCache, true);
+        }
+        catch (std::runtime_error const& e)
+        {
+            // The device cache has no room left for idle tasks.
+            TLLM_LOG_DEBUG("Stopped promoting hot LoRA tasks: %s", e.what());
+            mHostCache.markTaskDone(taskId);
+            break;
+        }
+        // Copying marks the source in progress.
+        mHostCache.markTaskDone(taskId);
+        ++numPromoted;
+    }
+
+    std::lock_guard<std::mutex> lk(mMutex);
+    for (auto it = mUseCounts.begin(); it != mUseCounts.end();)
+    {
+        it->second /= 2;
+        it = it->second == 0 ? mUseCounts.erase(it) : std::next(it);
+    }
+    return numPromoted;
+}
+
+} // namespace tensorrt_llm::runtime
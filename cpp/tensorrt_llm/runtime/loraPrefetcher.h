@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/loraCache.h"
+#include "tensorrt_llm/runtime/workerPool.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Source of LoRA adapters that requests reference by task id only.
+class LoraAdapterStore
+{
+public:
+    using TensorPtr = ITensor::SharedPtr;
+    using TaskIdType = LoraCache::TaskIdType;
+
+    struct Adapter
+    {
+        //! Weights in host memory, in the layout of the lora_weights request tensor
+        TensorPtr weights;
+        //! Config in host memory, in the layout of the lora_config request tensor
+        TensorPtr config;
+    };
+
+    virtual ~LoraAdapterStore() = default;
+
+    [[nodiscard]] virtual bool contains(TaskIdType taskId) const = 0;
+
+    //! \brief Read an adapter into host memory. Called from worker threads, implementations must be thread safe.
+    [[nodiscard]] virtual Adapter load(TaskIdType taskId) const = 0;
+};
+
+//! \brief Adapters stored as <directory>/<taskId>.safetensors with a "weights" and a "config" tensor.
+class LoraDirectoryStore : public LoraAdapterStore
+{
+public:
+    explicit LoraDirectoryStore(std::filesystem::path directory);
+
+    [[nodiscard]] bool contains(TaskIdType taskId) const override;
+
+    [[nodiscard]] Adapter load(TaskIdType taskId) const override;
+
+    [[nodiscard]] std::filesystem::path getPath(TaskIdType taskId) const;
+
+private:
+    std::filesystem::path mDirectory;
+};
+
+//! \brief Loads adapters missing from the host LoRA cache from a store in the background.
+//! \details A request naming a cold adapter only waits for its own load, the scheduler keeps it out of the batch until
+//! isReady returns true. A prefetched task is put into the host cache like the weights of a request, so it stays in
+//! progress until the requests using it are marked done.
+//!
+//! The prefetcher also counts how often every task is requested. promoteHotTasks copies the most frequently used
+//! tasks to the device cache ahead of time, the counts decay on every promotion so that past popularity fades.
+class LoraPrefetcher
+{
+public:
+    using TaskIdType = LoraCache::TaskIdType;
+
+    //! \param workerPool Pool running the loads, e.g. the put workers of the PEFT cache manager.
+    LoraPrefetcher(
+        std::shared_ptr<LoraAdapterStore> store, LoraCache& hostCache, std::shared_ptr<WorkerPool> workerPool);
+
+    //! \brief Start loading a task into the host cache unless it is there or loading already.
+    //! \details Throws LoraExpectedException if the task is neither cached nor in the store.
+    //! \return a future that is ready once the task is in the host cache and holds the error of a failed load.
+    std::shared_future<void> prefetch(TaskIdType taskId, WorkerPool::Priority priority = WorkerPool::Priority::kNORMAL);
+
+    //! \brief Check without blocking whether the load of a task has finished, rethrowing its error if it failed.
+    [[nodiscard]] bool isReady(TaskIdType taskId);
+
+    //! \brief Most frequently requested tasks, the most frequent first.
+    [[nodiscard]] std::vector<TaskIdType> getHotTasks(SizeType32 maxNumTasks) const;
+
+    //! \brief Copy up to maxNumTasks of the hottest tasks that are idle in the host cache to the device cache.
+    //! \details Must be called from the thread that adds requests and marks them done, like ensureBatch, since idle
+    //! tasks are marked done again after the copy.
+    //! \return the number of tasks copied.
+    SizeType32 promoteHotTasks(LoraCache& deviceCache, SizeType32 maxNumTasks);
+
+    [[nodiscard]] std::int64_t getNumLoads() const noexcept
+    {
+        std::lock_guard<std::mutex> lk(mMutex);
+        return mNumLoads;
+    }
+
+private:
+    void load(TaskIdType taskId);
+
+    std::shared_ptr<LoraAdapterStore> mStore;
+    LoraCache& mHostCache;
+    std::shared_ptr<WorkerPool> mWorkerPool;
+
+    mutable std::mutex mMutex;
+    std::unordered_map<TaskIdType, std::shared_future<void>> mLoads;
+    std::unordered_map<TaskIdType, std::uint64_t> mUseCounts;
+    std::int64_t mNumLoads{0};
+};
+
+} // namespace tensorrt_llm::runtime
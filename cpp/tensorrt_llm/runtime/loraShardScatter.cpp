@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/loraShardScatter.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+// Status of the task in the device cache of a rank, exchanged before the shards are sent
+std::int32_t constexpr kSTATUS_PRESENT = 0;
+std::int32_t constexpr kSTATUS_CLAIMED = 1;
+std::int32_t constexpr kSTATUS_FAILED = 2;
+
+// Leading slots of a page, as a flat tensor
+ITensor::SharedPtr usedSlice(ITensor::SharedPtr const& page, SizeType32 usedSlots, SizeType32 pageWidth)
+{
+    auto const pageSize = ITensor::volume(page->getShape());
+    return ITensor::slice(ITensor::view(page, ITensor::makeShape({pageSize})), 0, usedSlots * pageWidth);
+}
+} // namespace
+
+LoraShardScatter::LoraShardScatter(ModelConfig const& modelConfig, WorldConfig const& worldConfig)
+    : mModelConfig{modelConfig}
+    , mWorldConfig{worldConfig}
+    , mTpComm{COMM_SESSION.split(worldConfig.getPipelineParallelRank(), worldConfig.getTensorParallelRank())}
+    , mNcclComm{std::make_unique<NcclCommunicator>(
+          worldConfig.getTensorParallelism(), worldConfig.getTensorParallelRank(), mTpComm)}
+    , mManager{std::make_shared<CudaStream>()}
+{
+    for (auto const& module : modelConfig.getLoraModules())
+    {
+        mModuleIdToModule.emplace(module.value(), module);
+    }
+}
+
+LoraShardScatter::TensorPtr LoraShardScatter::broadcastConfig(TensorPtr const& config) const
+{
+    std::vector<std::int32_t> values;
+    std::int64_t rowSize = 0;
+    if (isLeader())
+    {
+        TLLM_CHECK_WITH_INFO(config != nullptr, "The leader needs the lora_config of the task");
+        auto const& shape = config->getShape();
+        rowSize = shape.d[shape.nbDims - 1];
+        auto const* data = bufferCast<std::int32_t>(*config);
+        values.assign(data, data + config->getSize());
+    }
+    mTpComm.bcastValue(rowSize, 0);
+    mTpComm.bcast(values, 0);
+
+    auto const numRows = static_cast<SizeType32>(values.size() / rowSize);
+    TensorPtr result = BufferManager::cpu(
+        ITensor::makeShape({numRows, static_cast<SizeType32>(rowSize)}), nvinfer1::DataType::kINT32);
+    std::copy(values.begin(), values.end(), bufferCast<std::int32_t>(*result));
+    return result;
+}
+
+LoraShardScatter::Shard LoraShardScatter::buildShard(
+    TensorPtr const& weights, TensorPtr const& config, LoraCache const& deviceCache, SizeType32 tpRank) const
+{
+    auto const& pageConfig = deviceCache.getPageManagerConfig();
+    auto const numPages = deviceCache.determineNumPages(config);
+    Shard shard;
+    shard.pages = BufferManager::pinnedPool(
+        ITensor::makeShape({numPages, pageConfig.getSlotsPerPage(), pageConfig.getPageWidth()}),
+        pageConfig.getDataType());
+    std::vector<TensorPtr> pages;
+    std::vector<std::size_t> pageIds(numPages);
+    std::iota(pageIds.begin(), pageIds.end(), 0);
+    for (SizeType32 i = 0; i < numPages; ++i)
+    {
+        pages.push_back(ITensor::view(ITensor::slice(shard.pages, i, 1),
+            ITensor::makeShape({pageConfig.getSlotsPerPage(), pageConfig.getPageWidth()})));
+    }
+
+    WorldConfig const rankWorldConfig{mWorldConfig.getTensorParallelism(), mWorldConfig.getPipelineParallelism(),
+        mWorldConfig.getPipelineParallelRank() * mWorldConfig.getTensorParallelism() + tpRank,
+        mWorldConfig.getGpusPerNode()};
+    auto const configs = LoraCache::copyToPages(
+        weights, config, mModelConfig, rankWorldConfig, mModuleIdToModule, mManager, pages, pageIds);
+
+    shard.usedSlots.assign(numPages, 0);
+    for (auto const& moduleConfig : configs)
+    {
+        auto& used = shard.usedSlots.at(moduleConfig.pageId);
+        used = std::max(used, moduleConfig.slotIdx + moduleConfig.numSlots);
+    }
+    return shard;
+}
+
+void LoraShardScatter::sendShards(TensorPtr const& weights, TensorPtr const& config, LoraCache const& deviceCache,
+    std::vector<std::int32_t> const& statuses) const
+{
+    auto const pageWidth = deviceCache.getPageManagerConfig().getPageWidth();
+    for (SizeType32 rank = 1; rank < mWorldConfig.getTensorParallelism(); ++rank)
+    {
+        if (statuses[rank] != kSTATUS_CLAIMED)
+        {
+            continue;
+        }
+        auto const shard = buildShard(weights, config, deviceCache, rank);
+        TensorPtr staging = mManager.copyFrom(*shard.pages, MemoryType::kGPU);
+        for (SizeType32 i = 0; i < static_cast<SizeType32>(shard.usedSlots.size()); ++i)
+        {
+            TensorPtr page = ITensor::slice(staging, i, 1);
+            mNcclComm->send(*usedSlice(page, shard.usedSlots[i], pageWidth), rank, mManager.getStream());
+        }
+        // The host pages and the staging buffer are released on return
+        mManager.getStream().synchronize();
+    }
+}
+
+void LoraShardScatter::scatter(
+    TaskIdType taskId, TensorPtr const& weights, TensorPtr const& sourceConfig, LoraCache& deviceCache)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_NVTX_SCOPED_RANGE(kLORA, scatter);
+    TLLM_CHECK_WITH_INFO(!deviceCache.isQuantized(), "LoRA shards cannot be scattered into a quantized cache");
+    TLLM_CHECK_WITH_INFO(!isLeader() || weights != nullptr, "The leader needs the lora_weights of the task");
+
+    auto const config = broadcastConfig(sourceConfig);
+    auto const pageWidth = deviceCache.getPageManagerConfig().getPageWidth();
+
+    // Every rank reports whether it claimed pages before the leader sends, so that a rank that already holds the task
+    // or has no room for it does not leave the leader waiting.
+    std::vector<std::int32_t> statuses(mWorldConfig.getTensorParallelism());
+    bool exchanged = false;
+    auto const exchange = [&](std::int32_t status)
+    {
+        mTpComm.allgather(&status, statuses.data(), 1, mpi::MpiType::kINT32);
+        exchanged = true;
+        if (isLeader())
+        {
+            sendShards(weights, config, deviceCache, statuses);
+        }
+    };
+
+    auto const fillPages = [&](std::vector<TensorPtr> const& pages, std::vector<SizeType32> const& usedSlots)
+    {
+        exchange(kSTATUS_CLAIMED);
+        if (isLeader())
+        {
+            auto const shard = buildShard(weights, config, deviceCache, 0);
+            for (std::size_t i = 0; i < pages.size(); ++i)
+            {
+                TensorPtr source = ITensor::slice(shard.pages, i, 1);
+                auto target = usedSlice(pages[i], usedSlots[i], pageWidth);
+                mManager.copy(*usedSlice(source, usedSlots[i], pageWidth), *target);
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; i < pages.size(); ++i)
+            {
+                mNcclComm->receive(*usedSlice(pages[i], usedSlots[i], pageWidth), 0, mManager.getStream());
+            }
+        }
+        mManager.getStream().synchronize();
+    };
+
+    try
+    {
+        if (!deviceCache.putPages(taskId, config, fillPages))
+        {
+            exchange(kSTATUS_PRESENT);
+        }
+    }
+    catch (std::runtime_error const&)
+    {
+        if (!exchanged)
+        {
+            exchange(kSTATUS_FAILED);
+        }
+        throw;
+    }
+    TLLM_LOG_DEBUG("LoRA task %lu scattered to %d ranks", taskId,
+        static_cast<int>(std::count(statuses.begin(), statuses.end(), kSTATUS_CLAIMED)));
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/loraCache.h"
+#include "tensorrt_llm/runtime/loraModule.h"
+#include "tensorrt_llm/runtime/modelConfig.h"
+#include "tensorrt_llm/runtime/ncclCommunicator.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Loads a LoRA adapter into the device caches of a tensor parallel group from a single copy of its weights.
+//! \details Only the leader of the group, tensor parallel rank 0, needs the weights of the adapter. It splits them
+//! once and sends every rank just its shard over NCCL, straight into the device cache pages that rank claimed. Only the
+//! config of the adapter, a few integers per module, is broadcast to all ranks. Every rank lays the shard out in its
+//! pages the same way, so the leader builds the pages of a rank without further exchange. Without it every rank
+//! receives and splits the full adapter.
+class LoraShardScatter
+{
+public:
+    using TensorPtr = ITensor::SharedPtr;
+    using TaskIdType = LoraCache::TaskIdType;
+
+    //! \brief Creates the communicators of the tensor parallel group of this rank, collective over COMM_SESSION.
+    LoraShardScatter(ModelConfig const& modelConfig, WorldConfig const& worldConfig);
+
+    [[nodiscard]] bool isLeader() const noexcept
+    {
+        return mWorldConfig.getTensorParallelRank() == 0;
+    }
+
+    //! \brief Put a task into the device caches of all ranks of the group, collective over the group. Ranks that
+    //! already hold the task only take part in the exchange.
+    //! \param weights The lora_weights of the task, only read on the leader
+    //! \param config The lora_config of the task, only read on the leader
+    //! \param deviceCache The device cache of this rank, not quantized
+    //! \throws std::runtime_error if this rank cannot claim pages for the task, after the other ranks received theirs
+    void scatter(TaskIdType taskId, TensorPtr const& weights, TensorPtr const& config, LoraCache& deviceCache);
+
+private:
+    //! \brief Broadcast the config of the leader to the group, as a host tensor [numRows, rowSize].
+    [[nodiscard]] TensorPtr broadcastConfig(TensorPtr const& config) const;
+
+    struct Shard
+    {
+        //! Host pages [numPages, slotsPerPage, pageWidth]
+        TensorPtr pages;
+        //! Slots of every page the shard uses
+        std::vector<SizeType32> usedSlots;
+    };
+
+    //! \brief Shard of a rank laid out in host pages like LoraCache::copyToPages lays it out in the pages of the rank.
+    [[nodiscard]] Shard buildShard(
+        TensorPtr const& weights, TensorPtr const& config, LoraCache const& deviceCache, SizeType32 tpRank) const;
+
+    //! \brief Split the task on the leader and send the ranks that claimed pages their shard.
+    void sendShards(TensorPtr const& weights, TensorPtr const& config, LoraCache const& deviceCache,
+        std::vector<std::int32_t> const& statuses) const;
+
+    ModelConfig mModelConfig;
+    WorldConfig mWorldConfig;
+    std::unordered_map<SizeType32, LoraModule> mModuleIdToModule;
+    mpi::MpiComm mTpComm;
+    std::unique_ptr<NcclCommunicator> mNcclComm;
+    BufferManager mManager;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -12,14 +12,74 @@
 
 #include "tensorrt_llm/runtime/loraUtils.h"
 #include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/lora/loraSgmv.h"
 #include "tensorrt_llm/runtime/common.h"
 #include "tensorrt_llm/runtime/iTensor.h"
 #include "tensorrt_llm/runtime/modelConfig.h"
 #include "tensorrt_llm/runtime/worldConfig.h"
+#include <algorithm>
+#include <cmath>
 #include <string>
+#include <vector>
 
 namespace tensorrt_llm::runtime::lora
 {
+namespace
+{
+SizeType32 constexpr kQUANTIZED_ALIGNMENT = 16;
+
+float toFloat(float value)
+{
+    return value;
+}
+
+float toFloat(half value)
+{
+    return __half2float(value);
+}
+
+#ifdef ENABLE_BF16
+float toFloat(__nv_bfloat16 value)
+{
+    return __bfloat162float(value);
+}
+#endif // ENABLE_BF16
+
+template <typename T>
+void quantizeWeightRowsInner(void* quantized, float* scales, T const* weights, SizeType32 numRows, SizeType32 numCols,
+    nvinfer1::DataType quantizedType)
+{
+    float const maxValue = quantizedType == nvinfer1::DataType::kINT8 ? 127.f : 448.f;
+    std::vector<float> row(numCols);
+    for (SizeType32 r = 0; r < numRows; ++r)
+    {
+        float absMax = 0.f;
+        for (SizeType32 c = 0; c < numCols; ++c)
+        {
+            row[c] = toFloat(weights[static_cast<std::size_t>(r) * numCols + c]);
+            absMax = std::max(absMax, std::abs(row[c]));
+        }
+        auto const scale = absMax > 0.f ? absMax / maxValue : 1.f;
+        scales[r] = scale;
+        for (SizeType32 c = 0; c < numCols; ++c)
+        {
+            auto const value = std::clamp(row[c] / scale, -maxValue, maxValue);
+            auto const idx = static_cast<std::size_t>(r) * numCols + c;
+            if (quantizedType == nvinfer1::DataType::kINT8)
+            {
+                static_cast<std::int8_t*>(quantized)[idx] = static_cast<std::int8_t>(std::lround(value));
+            }
+#ifdef ENABLE_FP8
+            else
+            {
+                static_cast<__nv_fp8_e4m3*>(quantized)[idx] = __nv_fp8_e4m3(value);
+            }
+#endif // ENABLE_FP8
+        }
+    }
+}
+} // namespace
 
 void loraValidateRequestTensorDims(std::optional<ITensor::SharedPtr> const& optReqLoraWeights,
     std::optional<ITensor::SharedPtr> const& optReqLoraConfig)
@@ -90,4 +150,43 @@ void loraValidateRequestTensors(std::optional<std::uint64_t> const& optTaskId,
         }
     }
 }
+
+SizeType32 getQuantizedLocalInOutSize(LoraModule const& module, SizeType32 adapterSize, SizeType32 tpSize)
+{
+    auto const alignedSize
+        = [](SizeType32 size) { return common::ceilDiv(size, kQUANTIZED_ALIGNMENT) * kQUANTIZED_ALIGNMENT; };
+    auto const inRows = module.localInAdapterSize(adapterSize, tpSize);
+    auto const outRows = module.localOutDim(tpSize);
+    return static_cast<SizeType32>(kernels::getLoraQuantScalesSize(inRows))
+        + alignedSize(module.localInSize(adapterSize, tpSize))
+        + static_cast<SizeType32>(kernels::getLoraQuantScalesSize(outRows))
+        + alignedSize(module.localOutSize(adapterSize, tpSize));
+}
+
+void quantizeWeightRows(void* quantized, float* scales, void const* weights, SizeType32 numRows, SizeType32 numCols,
+    nvinfer1::DataType weightsType, nvinfer1::DataType quantizedType)
+{
+#ifdef ENABLE_FP8
+    TLLM_CHECK_WITH_INFO(quantizedType == nvinfer1::DataType::kINT8 || quantizedType == nvinfer1::DataType::kFP8,
+        "LoRA weights can only be quantized to int8 or fp8");
+#else
+    TLLM_CHECK_WITH_INFO(quantizedType == nvinfer1::DataType::kINT8, "LoRA weights can only be quantized to int8");
+#endif // ENABLE_FP8
+    switch (weightsType)
+    {
+    case nvinfer1::DataType::kFLOAT:
+        quantizeWeightRowsInner(quantized, scales, static_cast<float const*>(weights), numRows, numCols, quantizedType);
+        break;
+    case nvinfer1::DataType::kHALF:
+        quantizeWeightRowsInner(quantized, scales, static_cast<half const*>(weights), numRows, numCols, quantizedType);
+        break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16:
+        quantizeWeightRowsInner(
+            quantized, scales, static_cast<__nv_bfloat16 const*>(weights), numRows, numCols, quantizedType);
+        break;
+#endif // ENABLE_BF16
+    default: TLLM_CHECK_WITH_INFO(false, "data type not supported");
+    }
+}
 } // namespace tensorrt_llm::runtime::lora
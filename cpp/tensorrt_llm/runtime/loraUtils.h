@@ -14,6 +14,7 @@
 
 #include "tensorrt_llm/runtime/common.h"
 #include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/loraModule.h"
 #include "tensorrt_llm/runtime/modelConfig.h"
 #include "tensorrt_llm/runtime/worldConfig.h"
 
@@ -34,4 +35,16 @@ void loraValidateRequestTensors(std::optional<std::uint64_t> const& optTaskId,
     std::optional<ITensor::SharedPtr> const& optReqLoraWeights,
     std::optional<ITensor::SharedPtr> const& optReqLoraConfig, runtime::ModelConfig const& modelConfig,
     runtime::WorldConfig const& worldConfig);
+
+//! \brief Bytes of the local weights of one module in a quantized LoRA cache: the per-row scales and the quantized in
+//! weights [adapterSize, localInDim], then the per-row scales and the quantized out weights [localOutDim, adapterSize],
+//! every part 16 byte aligned. See kernels::getLoraQuantScalesSize.
+SizeType32 getQuantizedLocalInOutSize(LoraModule const& module, SizeType32 adapterSize, SizeType32 tpSize);
+
+//! \brief Quantize a [numRows, numCols] matrix of LoRA weights on the host with one scale per row, so that weights
+//! are approximately quantized * scale.
+//! \param[out] quantized numRows * numCols values of quantizedType, kINT8 or kFP8
+//! \param[out] scales numRows scales
+void quantizeWeightRows(void* quantized, float* scales, void const* weights, SizeType32 numRows, SizeType32 numCols,
+    nvinfer1::DataType weightsType, nvinfer1::DataType quantizedType);
 } // namespace tensorrt_llm::runtime::lora
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/mappedFile.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tensorrt_llm::runtime
+{
+
+MappedFile::MappedFile(std::filesystem::path path, bool prefetch)
+    : mPath{std::move(path)}
+{
+#if defined(_WIN32)
+    TLLM_THROW("Memory mapped files are not supported on Windows");
+#else
+    auto const fd = ::open(mPath.c_str(), O_RDONLY);
+    TLLM_CHECK_WITH_INFO(fd >= 0, "Failed to open %s: %s", mPath.c_str(), std::strerror(errno));
+    struct stat st = {};
+    if (::fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        TLLM_THROW("Failed to map %s: file is empty or cannot be inspected", mPath.c_str());
+    }
+    mSize = static_cast<std::size_t>(st.st_size);
+    auto* data = ::mmap(nullptr, mSize, PROT_READ, MAP_SHARED, fd, 0);
+    auto const err = errno;
+    // The mapping keeps the file referenced
+    ::close(fd);
+    TLLM_CHECK_WITH_INFO(data != MAP_FAILED, "Failed to map %s: %s", mPath.c_str(), std::strerror(err));
+    mData = data;
+    if (prefetch)
+    {
+        ::madvise(mData, mSize, MADV_SEQUENTIAL);
+        ::madvise(mData, mSize, MADV_WILLNEED);
+    }
+    TLLM_LOG_DEBUG("Mapped %s (%zu bytes)", mPath.c_str(), mSize);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#if !defined(_WIN32)
+    if (mData != nullptr)
+    {
+        ::munmap(mData, mSize);
+    }
+#endif
+}
+
+void MappedFile::release() const noexcept
+{
+#if !defined(_WIN32)
+    if (mData != nullptr)
+    {
+        ::madvise(mData, mSize, MADV_DONTNEED);
+    }
+#endif
+}
+
+void MappedFile::populate() const noexcept
+{
+#if !defined(_WIN32)
+    auto const pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    auto const* bytes = static_cast<std::uint8_t const volatile*>(mData);
+    for (std::size_t offset = 0; offset < mSize; offset += pageSize)
+    {
+        static_cast<void>(bytes[offset]);
+    }
+#endif
+}
+
+} // namespace tensorrt_llm::runtime
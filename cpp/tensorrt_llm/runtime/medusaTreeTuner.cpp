@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/medusaTreeTuner.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <queue>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+// Ratio of a first-level node to the root and of a rank to the next lower one, when the tree has no such node
+float constexpr kDEFAULT_CHILD_RATIO = 0.5F;
+float constexpr kRANK_DECAY = 0.5F;
+// Expected tokens per step a new tree must gain to replace the current one
+float constexpr kMIN_GAIN = 0.01F;
+
+bool isLeftOf(std::vector<SizeType32> const& a, std::vector<SizeType32> const& b)
+{
+    return a.size() < b.size() || (a.size() == b.size() && a < b);
+}
+} // namespace
+
+void sortMedusaChoices(std::vector<std::vector<SizeType32>>& choices)
+{
+    std::sort(choices.begin(), choices.end(), isLeftOf);
+}
+
+MedusaTreeTuner::MedusaTreeTuner(MedusaChoices choices, SizeType32 maxDecodingDraftTokens, SizeType32 maxDraftPathLen,
+    SizeType32 updateInterval, bool pinned, SizeType32 maxChildRank, float smoothing)
+    : mMaxDecodingDraftTokens{maxDecodingDraftTokens}
+    , mMaxDraftPathLen{maxDraftPathLen}
+    , mUpdateInterval{updateInterval}
+    , mMaxChildRank{maxChildRank}
+    , mSmoothing{smoothing}
+    , mPinned{pinned}
+    , mChoices{std::move(choices)}
+{
+    TLLM_CHECK_WITH_INFO(!mChoices.empty(), "The Medusa tree needs at least one node");
+    TLLM_CHECK_WITH_INFO(static_cast<SizeType32>(mChoices.size()) <= maxDecodingDraftTokens,
+        "The Medusa tree has %ld nodes, the engine has %d draft tokens", mChoices.size(), maxDecodingDraftTokens);
+    TLLM_CHECK_WITH_INFO(maxDraftPathLen > 0, "The Medusa tree needs at least one head");
+    TLLM_CHECK_WITH_INFO(updateInterval > 0, "The update interval must be positive");
+    TLLM_CHECK_WITH_INFO(maxChildRank > 0, "The max child rank must be positive");
+    TLLM_CHECK_WITH_INFO(smoothing >= 0.F && smoothing < 1.F, "The smoothing must be in [0, 1)");
+    for (auto const& choice : mChoices)
+    {
+        TLLM_CHECK_WITH_INFO(!choice.empty() && static_cast<SizeType32>(choice.size()) <= maxDraftPathLen,
+            "Medusa choices must have a depth in [1, %d]", maxDraftPathLen);
+    }
+    sortMedusaChoices(mChoices);
+}
+
+bool MedusaTreeTuner::onIteration() noexcept
+{
+    return ++mNumIterations >= mUpdateInterval;
+}
+
+std::optional<MedusaTreeTuner::MedusaChoices> MedusaTreeTuner::update(std::vector<SizeType32> const& nodeAcceptCounts)
+{
+    auto const numNodes = mChoices.size();
+    TLLM_CHECK_WITH_INFO(nodeAcceptCounts.size() > numNodes, "Expected counts for %ld nodes and the root, got %ld",
+        numNodes, nodeAcceptCounts.size());
+    mNumIterations = 0;
+
+    auto const numSteps = nodeAcceptCounts[0];
+    if (numSteps <= 0)
+    {
+        return std::nullopt;
+    }
+    auto const firstCounts = mRates.empty();
+    mRates.resize(numNodes, 0.F);
+    for (std::size_t ni = 0; ni < numNodes; ++ni)
+    {
+        auto const observed = std::min(static_cast<float>(nodeAcceptCounts[ni + 1]) / numSteps, 1.F);
+        mRates[ni] = firstCounts ? observed : mSmoothing * mRates[ni] + (1.F - mSmoothing) * observed;
+    }
+    if (mPinned)
+    {
+        return std::nullopt;
+    }
+
+    auto [choices, rates] = buildTree();
+    auto const expectedAcceptedLen = std::accumulate(rates.begin(), rates.end(), 1.F);
+    if (choices == mChoices || expectedAcceptedLen <= getExpectedAcceptedLen() + kMIN_GAIN)
+    {
+        return std::nullopt;
+    }
+    mChoices = std::move(choices);
+    // The new nodes start from their estimated rates
+    mRates = std::move(rates);
+    return mChoices;
+}
+
+float MedusaTreeTuner::getExpectedAcceptedLen() const noexcept
+{
+    return std::accumulate(mRates.begin(), mRates.end(), 1.F);
+}
+
+std::vector<std::vector<float>> MedusaTreeTuner::computeChildRatios() const
+{
+    std::map<std::vector<SizeType32>, float> rates{{{}, 1.F}};
+    for (std::size_t ni = 0; ni < mRates.size(); ++ni)
+    {
+        rates.emplace(mChoices[ni], mRates[ni]);
+    }
+
+    std::vector<std::vector<float>> childSums(mMaxDraftPathLen, std::vector<float>(mMaxChildRank, 0.F));
+    std::vector<std::vector<float>> parentSums(mMaxDraftPathLen, std::vector<float>(mMaxChildRank, 0.F));
+    for (std::size_t ni = 0; ni < mRates.size(); ++ni)
+    {
+        auto const& choice = mChoices[ni];
+        auto const rank = choice.back();
+        auto const parent = rates.find(std::vector<SizeType32>(choice.begin(), choice.end() - 1));
+        if (rank >= mMaxChildRank || parent == rates.end())
+        {
+            continue;
+        }
+        childSums[choice.size() - 1][rank] += mRates[ni];
+        parentSums[choice.size() - 1][rank] += parent->second;
+    }
+
+    // Without a node of the depth and rank, take the same rank one level up, or the next lower rank, decayed
+    std::vector<std::vector<float>> ratios(mMaxDraftPathLen, std::vector<float>(mMaxChildRank, kDEFAULT_CHILD_RATIO));
+    for (SizeType32 di = 0; di < mMaxDraftPathLen; ++di)
+    {
+        for (SizeType32 ri = 0; ri < mMaxChildRank; ++ri)
+        {
+            if (parentSums[di][ri] > 0.F)
+            {
+                ratios[di][ri] = std::min(childSums[di][ri] / parentSums[di][ri], 1.F);
+            }
+            else if (di > 0)
+            {
+                ratios[di][ri] = ratios[di - 1][ri];
+            }
+            else if (ri > 0)
+            {
+                ratios[di][ri] = ratios[di][ri - 1] * kRANK_DECAY;
+            }
+        }
+    }
+    return ratios;
+}
+
+std::pair<MedusaTreeTuner::MedusaChoices, std::vector<float>> MedusaTreeTuner::buildTree() const
+{
+    std::map<std::vector<SizeType32>, float> knownRates;
+    for (std::size_t ni = 0; ni < mRates.size(); ++ni)
+    {
+        knownRates.emplace(mChoices[ni], mRates[ni]);
+    }
+    auto const ratios = computeChildRatios();
+
+    struct Candidate
+    {
+        float rate;
+        std::vector<SizeType32> choice;
+    };
+
+    // Highest rate first, ties go to the shallower and then the left node
+    auto const comp = [](Candidate const& a, Candidate const& b)
+    { return a.rate < b.rate || (a.rate == b.rate && isLeftOf(b.choice, a.choice)); };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(comp)> candidates(comp);
+    auto const pushChildren = [&](std::vector<SizeType32> const& parent, float parentRate)
+    {
+        auto const depth = static_cast<SizeType32>(parent.size());
+        if (depth >= mMaxDraftPathLen)
+        {
+            return;
+        }
+        for (SizeType32 ri = 0; ri < mMaxChildRank; ++ri)
+        {
+            auto child = parent;
+            child.push_back(ri);
+            auto const known = knownRates.find(child);
+            // A child is never accepted more often than its parent
+            auto const rate
+                = std::min(known != knownRates.end() ? known->second : parentRate * ratios[depth][ri], parentRate);
+            candidates.push(Candidate{rate, std::move(child)});
+        }
+    };
+
+    MedusaChoices choices;
+    std::vector<float> rates;
+    // The heads sample max rank + 1 tokens at every depth, all of them must fit into the draft tokens
+    std::vector<SizeType32> topKs(mMaxDraftPathLen, 0);
+    SizeType32 numSampledTokens{0};
+    pushChildren({}, 1.F);
+    while (!candidates.empty() && static_cast<SizeType32>(choices.size()) < mMaxDecodingDraftTokens)
+    {
+        auto candidate = candidates.top();
+        candidates.pop();
+        auto const di = candidate.choice.size() - 1;
+        auto const topK = std::max(topKs[di], candidate.choice.back() + 1);
+        if (numSampledTokens - topKs[di] + topK > mMaxDecodingDraftTokens)
+        {
+            continue;
+        }
+        numSampledTokens += topK - topKs[di];
+        topKs[di] = topK;
+        pushChildren(candidate.choice, candidate.rate);
+        choices.push_back(std::move(candidate.choice));
+        rates.push_back(candidate.rate);
+    }
+
+    std::vector<std::size_t> order(choices.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&choices](auto a, auto b) { return isLeftOf(choices[a], choices[b]); });
+    MedusaChoices sortedChoices;
+    std::vector<float> sortedRates;
+    sortedChoices.reserve(order.size());
+    sortedRates.reserve(order.size());
+    for (auto const idx : order)
+    {
+        sortedChoices.push_back(std::move(choices[idx]));
+        sortedRates.push_back(rates[idx]);
+    }
+    return {std::move(sortedChoices), std::move(sortedRates)};
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Reshapes the Medusa tree to the paths the target model accepts.
+//! \details The decoding layer counts how often every node of the tree is accepted. At the end of every update
+//! interval, the owner takes the counts and hands them to the tuner, which folds them into per node acceptance rates
+//! and grows a new tree from the root, greedily adding the node with the highest rate until the engine's draft
+//! tokens are used up. A node outside of the tree has no rate of its own, its rate is estimated from its parent and
+//! the rates of the nodes of the same depth and top-K rank in the tree. Trees of workloads with confident heads, e.g.
+//! code, grow deep, those of less predictable ones grow wide.
+//!
+//! The choices are kept sorted like MedusaModule::initMedusaTensorsFromChoices sorts them, so that the node with
+//! linear idx i is getChoices()[i - 1]. The owner applies a new tree between two iterations, after taking the counts
+//! of the old one.
+class MedusaTreeTuner
+{
+public:
+    using MedusaChoices = std::vector<std::vector<SizeType32>>;
+
+    //! \param choices Tree to start from.
+    //! \param maxDecodingDraftTokens Number of draft tokens of the engine, the tree has at most as many nodes and its
+    //! Medusa heads sample at most as many tokens.
+    //! \param maxDraftPathLen Number of Medusa heads, the depth of the tree.
+    //! \param updateInterval Number of iterations between two updates.
+    //! \param pinned Keep the starting tree, the rates are still tracked.
+    //! \param maxChildRank Highest top-K rank of a node.
+    //! \param smoothing Weight of the previous rates when folding in the counts of an interval.
+    MedusaTreeTuner(MedusaChoices choices, SizeType32 maxDecodingDraftTokens, SizeType32 maxDraftPathLen,
+        SizeType32 updateInterval, bool pinned = false, SizeType32 maxChildRank = 10, float smoothing = 0.5F);
+
+    MedusaTreeTuner(MedusaChoices choices, SizeType32 maxDecodingDraftTokens, SizeType32 maxDraftPathLen,
+        executor::MedusaTreeTuningConfig const& config)
+        : MedusaTreeTuner(std::move(choices), maxDecodingDraftTokens, maxDraftPathLen, config.getUpdateInterval(),
+            config.getPinned(), config.getMaxChildRank(), config.getSmoothing())
+    {
+    }
+
+    //! \brief Count an iteration.
+    //! @returns whether the interval is over, i.e. the owner takes the counts and calls update
+    [[nodiscard]] bool onIteration() noexcept;
+
+    //! \brief Fold in the counts of the interval and rebuild the tree.
+    //! \param nodeAcceptCounts Counts by linear idx, entry 0 is the number of request steps, at least
+    //! getChoices().size() + 1 entries.
+    //! @returns the new tree when it is expected to accept more tokens than the current one, std::nullopt otherwise
+    [[nodiscard]] std::optional<MedusaChoices> update(std::vector<SizeType32> const& nodeAcceptCounts);
+
+    [[nodiscard]] MedusaChoices const& getChoices() const noexcept
+    {
+        return mChoices;
+    }
+
+    //! @returns acceptance rate of every node of the tree, in the order of getChoices()
+    [[nodiscard]] std::vector<float> const& getAcceptRates() const noexcept
+    {
+        return mRates;
+    }
+
+    //! @returns expected number of tokens per request step with the current tree, the accepted draft tokens and the
+    //! token sampled after them
+    [[nodiscard]] float getExpectedAcceptedLen() const noexcept;
+
+    [[nodiscard]] bool isPinned() const noexcept
+    {
+        return mPinned;
+    }
+
+    void setPinned(bool pinned) noexcept
+    {
+        mPinned = pinned;
+    }
+
+private:
+    //! \brief Rate of an accepted child relative to its parent, by depth and top-K rank, estimated from the tree.
+    [[nodiscard]] std::vector<std::vector<float>> computeChildRatios() const;
+
+    //! \brief Greedily grown tree and the rates of its nodes, both sorted.
+    [[nodiscard]] std::pair<MedusaChoices, std::vector<float>> buildTree() const;
+
+    SizeType32 const mMaxDecodingDraftTokens;
+    SizeType32 const mMaxDraftPathLen;
+    SizeType32 const mUpdateInterval;
+    SizeType32 const mMaxChildRank;
+    float const mSmoothing;
+    bool mPinned;
+
+    MedusaChoices mChoices;
+    // Empty until the first counts arrive
+    std::vector<float> mRates;
+    SizeType32 mNumIterations{0};
+};
+
+//! \brief Sorts Medusa choices by depth and, within a depth, from left to right, the order of their linear idx.
+void sortMedusaChoices(std::vector<std::vector<SizeType32>>& choices);
+
+} // namespace tensorrt_llm::runtime
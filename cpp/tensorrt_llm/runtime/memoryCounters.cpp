@@ -28,6 +28,8 @@ namespace
 
 auto constexpr kByteUnits = std::array{"B", "KB", "MB", "GB", "TB", "PB", "EB"};
 
+thread_local tensorrt_llm::runtime::MemoryTag currentTag{tensorrt_llm::runtime::MemoryTag::kUNTAGGED};
+
 std::string doubleBytesToString(double bytes, int precision)
 {
     std::uint32_t unitIdx{0};
@@ -85,6 +87,95 @@ void MemoryCounters::deallocate(MemoryType memoryType, MemoryCounters::SizeType3
     }
 }
 
+void MemoryCounters::allocate(MemoryTag tag, MemoryType memoryType, MemoryCounters::SizeType32 size)
+{
+    auto const tagIdx = static_cast<std::size_t>(tag);
+    auto const typeIdx = static_cast<std::size_t>(memoryType);
+    TLLM_CHECK(tagIdx < kNumTags && typeIdx < kNumMemoryTypes);
+    auto const usage = mTagged[tagIdx][typeIdx].fetch_add(size, std::memory_order_relaxed) + size;
+    auto& peak = mTaggedPeak[tagIdx][typeIdx];
+    auto prevPeak = peak.load(std::memory_order_relaxed);
+    while (prevPeak < usage && !peak.compare_exchange_weak(prevPeak, usage, std::memory_order_relaxed))
+    {
+    }
+}
+
+void MemoryCounters::deallocate(MemoryTag tag, MemoryType memoryType, MemoryCounters::SizeType32 size)
+{
+    auto const tagIdx = static_cast<std::size_t>(tag);
+    auto const typeIdx = static_cast<std::size_t>(memoryType);
+    TLLM_CHECK(tagIdx < kNumTags && typeIdx < kNumMemoryTypes);
+    mTagged[tagIdx][typeIdx].fetch_sub(size, std::memory_order_relaxed);
+}
+
+MemoryCounters::SizeType32 MemoryCounters::getTagged(MemoryTag tag, MemoryType memoryType) const
+{
+    return mTagged.at(static_cast<std::size_t>(tag)).at(static_cast<std::size_t>(memoryType)).load();
+}
+
+MemoryCounters::SizeType32 MemoryCounters::getTaggedPeak(MemoryTag tag, MemoryType memoryType) const
+{
+    return mTaggedPeak.at(static_cast<std::size_t>(tag)).at(static_cast<std::size_t>(memoryType)).load();
+}
+
+void MemoryCounters::resetTaggedPeaks()
+{
+    for (std::size_t tagIdx = 0; tagIdx < kNumTags; ++tagIdx)
+    {
+        for (std::size_t typeIdx = 0; typeIdx < kNumMemoryTypes; ++typeIdx)
+        {
+            mTaggedPeak[tagIdx][typeIdx] = mTagged[tagIdx][typeIdx].load();
+        }
+    }
+}
+
+std::vector<executor::MemoryTagStats> MemoryCounters::getTagStats() const
+{
+    std::vector<executor::MemoryTagStats> stats;
+    for (std::size_t tagIdx = 0; tagIdx < kNumTags; ++tagIdx)
+    {
+        auto const tag = static_cast<MemoryTag>(tagIdx);
+        executor::MemoryTagStats tagStats{};
+        tagStats.tag = getTagName(tag);
+        tagStats.gpuMemUsage = getTagged(tag, MemoryType::kGPU);
+        tagStats.cpuMemUsage = getTagged(tag, MemoryType::kCPU);
+        tagStats.pinnedMemUsage = getTagged(tag, MemoryType::kPINNED);
+        tagStats.peakGpuMemUsage = getTaggedPeak(tag, MemoryType::kGPU);
+        tagStats.peakCpuMemUsage = getTaggedPeak(tag, MemoryType::kCPU);
+        tagStats.peakPinnedMemUsage = getTaggedPeak(tag, MemoryType::kPINNED);
+        if (tagStats.peakGpuMemUsage > 0 || tagStats.peakCpuMemUsage > 0 || tagStats.peakPinnedMemUsage > 0)
+        {
+            stats.push_back(std::move(tagStats));
+        }
+    }
+    return stats;
+}
+
+MemoryTag MemoryCounters::getCurrentTag() noexcept
+{
+    return currentTag;
+}
+
+void MemoryCounters::setCurrentTag(MemoryTag tag) noexcept
+{
+    currentTag = tag;
+}
+
+char const* MemoryCounters::getTagName(MemoryTag tag)
+{
+    switch (tag)
+    {
+    case MemoryTag::kUNTAGGED: return "untagged";
+    case MemoryTag::kWEIGHTS: return "weights";
+    case MemoryTag::kACTIVATIONS: return "activations";
+    case MemoryTag::kKV_CACHE: return "kv_cache";
+    case MemoryTag::kDECODER: return "decoder";
+    case MemoryTag::kLORA: return "lora";
+    case MemoryTag::kIO_BUFFERS: return "io_buffers";
+    }
+    TLLM_THROW("Unknown memory tag");
+}
+
 MemoryCounters& MemoryCounters::getInstance()
 {
     static MemoryCounters mInstance;
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/memoryPlanner.h"
+#include "tensorrt_llm/batch_manager/kvCacheConfig.h"
+#include "tensorrt_llm/batch_manager/kvCacheManager.h"
+#include "tensorrt_llm/batch_manager/peftCacheManagerConfig.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/stringUtils.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+using KVCacheManager = batch_manager::kv_cache_manager::KVCacheManager;
+
+std::size_t getTypeSize(nvinfer1::DataType dataType)
+{
+    return BufferDataType(dataType).getSize();
+}
+
+std::string toMiB(std::size_t bytes)
+{
+    return common::fmtstr("%.2f MiB", static_cast<double>(bytes) / (1 << 20));
+}
+} // namespace
+
+MemoryPlanner::Options MemoryPlanner::Options::fromExecutorConfig(
+    executor::ExecutorConfig const& executorConfig, ModelConfig const& modelConfig)
+{
+    auto const kvCacheConfig = executorConfig.getKvCacheConfig();
+    auto const peftCacheConfig = executorConfig.getPeftCacheConfig().value_or(executor::PeftCacheConfig{});
+    Options options{};
+    options.maxBatchSize = executorConfig.getMaxBatchSize().value_or(modelConfig.getMaxBatchSize());
+    options.maxBeamWidth = executorConfig.getMaxBeamWidth();
+    options.maxSequenceLen = modelConfig.getMaxSequenceLen();
+    options.maxNumTokens = executorConfig.getMaxNumTokens().has_value() ? executorConfig.getMaxNumTokens()
+                                                                         : modelConfig.getMaxNumTokens();
+    options.maxKvCacheTokens = kvCacheConfig.getMaxTokens();
+    options.freeGpuMemoryFraction = kvCacheConfig.getFreeGpuMemoryFraction().value_or(
+        batch_manager::kv_cache_manager::KvCacheConfig::kDefaultGpuMemFraction);
+    options.kvCacheHostSize = kvCacheConfig.getHostCacheSize().value_or(0);
+    options.loraDeviceCachePercent = peftCacheConfig.getDeviceCachePercent().value_or(
+        batch_manager::PeftCacheManagerConfig::kDefaultDeviceCachePercent);
+    options.loraHostCacheSize = peftCacheConfig.getHostCacheSize().value_or(0);
+    return options;
+}
+
+MemoryPlanner::EngineMemory MemoryPlanner::EngineMemory::fromEngine(
+    nvinfer1::ICudaEngine const& engine, std::size_t engineSize)
+{
+    return EngineMemory{engineSize, static_cast<std::size_t>(engine.getDeviceMemorySizeV2())};
+}
+
+MemoryPlanner::MemoryPlanner(ModelConfig const& modelConfig, WorldConfig const& worldConfig, Options const& options)
+    : mModelConfig{modelConfig}
+    , mWorldConfig{worldConfig}
+    , mOptions{options}
+{
+    TLLM_CHECK_WITH_INFO(options.maxBatchSize > 0 && options.maxBeamWidth > 0 && options.maxSequenceLen > 0,
+        "maxBatchSize, maxBeamWidth and maxSequenceLen must be positive");
+    TLLM_CHECK_WITH_INFO(options.freeGpuMemoryFraction > 0.F && options.freeGpuMemoryFraction <= 1.F,
+        "freeGpuMemoryFraction must be in (0, 1]");
+}
+
+std::size_t MemoryPlanner::getKvBlockSize() const
+{
+    if (!mModelConfig.isKVCacheEnabled())
+    {
+        return 0;
+    }
+    auto const numLocalLayers = mModelConfig.getNbAttentionLayers(mWorldConfig.getPipelineParallelism());
+    // Rescale to the kv cache rows, e.g. packed INT4 values and their scales.
+    auto const pageSize = static_cast<std::size_t>(KVCacheManager::calculatePageSize(mModelConfig))
+        * mModelConfig.getKvCacheSizePerHead() / mModelConfig.getSizePerHead();
+    return pageSize * numLocalLayers * getTypeSize(mModelConfig.getKvDataType());
+}
+
+std::size_t MemoryPlanner::getDecoderBufferSize() const
+{
+    auto const batchBeams = static_cast<std::size_t>(mOptions.maxBatchSize) * mOptions.maxBeamWidth;
+    auto const vocabSizePadded = static_cast<std::size_t>(mModelConfig.getVocabSizePadded(mWorldConfig.getSize()));
+    auto const logitsSize = getTypeSize(mModelConfig.getLogitsDtype());
+    auto const tokenSlots = batchBeams * mOptions.maxSequenceLen;
+
+    // Logits of the last token of every sequence
+    std::size_t bytes = batchBeams * vocabSizePadded * logitsSize;
+    if (mModelConfig.computeContextLogits())
+    {
+        bytes += static_cast<std::size_t>(mOptions.maxNumTokens.value_or(mOptions.maxBatchSize)) * vocabSizePadded
+            * logitsSize;
+    }
+    // Output ids and parent ids in int32, log probs in float
+    bytes += tokenSlots * (2 * sizeof(TokenIdType) + sizeof(float));
+    if (mOptions.maxBeamWidth > 1)
+    {
+        // Double-buffered cache indirection
+        bytes += 2 * tokenSlots * sizeof(SizeType32);
+    }
+    return bytes;
+}
+
+std::size_t MemoryPlanner::getPinnedBufferSize() const
+{
+    auto const batchBeams = static_cast<std::size_t>(mOptions.maxBatchSize) * mOptions.maxBeamWidth;
+    // Host copies of the output ids, the new tokens and the sequence lengths
+    return batchBeams * mOptions.maxSequenceLen * sizeof(TokenIdType) + 2 * batchBeams * sizeof(SizeType32);
+}
+
+MemoryPlanner::Breakdown MemoryPlanner::plan(std::size_t freeGpuMemory, EngineMemory const& engineMemory) const
+{
+    Breakdown breakdown;
+    breakdown.engineWeights = engineMemory.weights;
+    breakdown.activations = engineMemory.activations;
+    breakdown.decoderBuffers = getDecoderBufferSize();
+    breakdown.pinnedBuffers = getPinnedBufferSize();
+
+    auto const used = breakdown.engineWeights + breakdown.activations + breakdown.decoderBuffers;
+    auto freeAfterRuntime = freeGpuMemory > used ? freeGpuMemory - used : 0;
+
+    // The PEFT cache takes its share of the memory left after the engine is loaded, before the KV cache
+    if (mModelConfig.useLoraPlugin())
+    {
+        breakdown.loraCache
+            = static_cast<std::size_t>(static_cast<double>(freeAfterRuntime) * mOptions.loraDeviceCachePercent);
+        breakdown.hostLoraCache = mOptions.loraHostCacheSize;
+        freeAfterRuntime -= breakdown.loraCache;
+    }
+
+    auto const blockSize = getKvBlockSize();
+    if (blockSize > 0)
+    {
+        auto const tokensPerBlock = mModelConfig.getTokensPerBlock();
+        auto numBlocks = static_cast<SizeType32>(
+            static_cast<double>(freeAfterRuntime) * mOptions.freeGpuMemoryFraction / static_cast<double>(blockSize));
+        if (mOptions.maxKvCacheTokens)
+        {
+            numBlocks = std::min(numBlocks, common::ceilDiv(*mOptions.maxKvCacheTokens, tokensPerBlock));
+        }
+        breakdown.numKvBlocks = numBlocks;
+        breakdown.kvCache = numBlocks * blockSize;
+        breakdown.numHostKvBlocks = static_cast<SizeType32>(mOptions.kvCacheHostSize / blockSize);
+        breakdown.hostKvCache = breakdown.numHostKvBlocks * blockSize;
+        breakdown.numKvBlocksPerSequence
+            = common::ceilDiv(mOptions.maxSequenceLen, tokensPerBlock) * mOptions.maxBeamWidth;
+    }
+    return breakdown;
+}
+
+std::string MemoryPlanner::Breakdown::toString() const
+{
+    std::stringstream ss;
+    ss << "GPU " << toMiB(getGpuTotal()) << ": engine weights " << toMiB(engineWeights) << ", activations "
+       << toMiB(activations) << ", decoder buffers " << toMiB(decoderBuffers) << ", LoRA cache " << toMiB(loraCache)
+       << ", KV cache " << toMiB(kvCache) << " (" << numKvBlocks << " blocks); host " << toMiB(getHostTotal())
+       << ": pinned buffers " << toMiB(pinnedBuffers) << ", KV cache " << toMiB(hostKvCache) << " ("
+       << numHostKvBlocks << " blocks), LoRA cache " << toMiB(hostLoraCache);
+    return ss.str();
+}
+
+} // namespace tensorrt_llm::runtime
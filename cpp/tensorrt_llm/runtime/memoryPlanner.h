@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/modelConfig.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <NvInferRuntime.h>
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Estimates the memory of every consumer of an executor before it is created.
+//! \details The KV cache and LoRA cache are sized from the memory left after the engine and the decoder buffers
+//! with the formulas the runtime uses, e.g. KVCacheManager::calculatePageSize, so that maxBatchSize, maxNumTokens,
+//! freeGpuMemoryFraction and hostCacheSize can be chosen without trial runs.
+class MemoryPlanner
+{
+public:
+    struct Options
+    {
+        SizeType32 maxBatchSize;
+        SizeType32 maxBeamWidth;
+        SizeType32 maxSequenceLen;
+        std::optional<SizeType32> maxNumTokens;
+        //! KvCacheConfig::maxTokens
+        std::optional<SizeType32> maxKvCacheTokens;
+        //! KvCacheConfig::freeGpuMemoryFraction
+        float freeGpuMemoryFraction;
+        //! KvCacheConfig::hostCacheSize
+        std::size_t kvCacheHostSize{0};
+        //! PeftCacheConfig::deviceCachePercent, only used if the engine has the LoRA plugin
+        float loraDeviceCachePercent;
+        //! PeftCacheConfig::hostCacheSize
+        std::size_t loraHostCacheSize{0};
+
+        //! \brief Options of an executor, limits it does not set are taken from the engine.
+        [[nodiscard]] static Options fromExecutorConfig(
+            executor::ExecutorConfig const& executorConfig, ModelConfig const& modelConfig);
+    };
+
+    struct EngineMemory
+    {
+        //! Device memory of the deserialized engine, about the size of the engine file
+        std::size_t weights{0};
+        //! Execution context memory shared by all profiles, see TllmRuntime
+        std::size_t activations{0};
+
+        [[nodiscard]] static EngineMemory fromEngine(nvinfer1::ICudaEngine const& engine, std::size_t engineSize);
+    };
+
+    //! All sizes in bytes
+    struct Breakdown
+    {
+        std::size_t engineWeights{0};
+        std::size_t activations{0};
+        std::size_t decoderBuffers{0};
+        std::size_t loraCache{0};
+        std::size_t kvCache{0};
+        std::size_t pinnedBuffers{0};
+        std::size_t hostKvCache{0};
+        std::size_t hostLoraCache{0};
+
+        SizeType32 numKvBlocks{0};
+        SizeType32 numHostKvBlocks{0};
+        //! Blocks needed by one sequence of maximum length and beam width
+        SizeType32 numKvBlocksPerSequence{0};
+
+        [[nodiscard]] std::size_t getGpuTotal() const noexcept
+        {
+            return engineWeights + activations + decoderBuffers + loraCache + kvCache;
+        }
+
+        [[nodiscard]] std::size_t getHostTotal() const noexcept
+        {
+            return pinnedBuffers + hostKvCache + hostLoraCache;
+        }
+
+        //! \brief Whether the KV cache holds at least one sequence of maximum length.
+        [[nodiscard]] bool fits() const noexcept
+        {
+            return numKvBlocks > 0 && numKvBlocks >= numKvBlocksPerSequence;
+        }
+
+        [[nodiscard]] std::string toString() const;
+    };
+
+    MemoryPlanner(ModelConfig const& modelConfig, WorldConfig const& worldConfig, Options const& options);
+
+    //! \brief Plan the memory of a rank.
+    //! \param freeGpuMemory Free device memory before the engine is loaded
+    [[nodiscard]] Breakdown plan(std::size_t freeGpuMemory, EngineMemory const& engineMemory) const;
+
+    //! \brief Bytes of one KV cache block across the local layers.
+    [[nodiscard]] std::size_t getKvBlockSize() const;
+
+    //! \brief Device buffers of the decoder and runtime that scale with the limits.
+    [[nodiscard]] std::size_t getDecoderBufferSize() const;
+
+    //! \brief Pinned host buffers of the decoder outputs.
+    [[nodiscard]] std::size_t getPinnedBufferSize() const;
+
+private:
+    ModelConfig mModelConfig;
+    WorldConfig mWorldConfig;
+    Options mOptions;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/microBatchScheduler.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+MicroBatchScheduler::MicroBatchScheduler(Config const& config)
+    : mConfig{config}
+    , mGenerationRequests(config.numMicroBatches)
+    , mInFlightTokens(config.numMicroBatches, 0)
+{
+    TLLM_CHECK_WITH_INFO(mConfig.numMicroBatches > 0 && mConfig.maxBatchSize > 0 && mConfig.maxNumTokens > 0,
+        "The micro batch scheduler needs a positive number of micro batches, batch size and number of tokens");
+}
+
+void MicroBatchScheduler::enqueue(RequestIdType requestId, SizeType32 contextLength)
+{
+    TLLM_CHECK_WITH_INFO(contextLength > 0 && contextLength <= mConfig.maxNumTokens,
+        "Request %lu has %d context tokens, expected between 1 and max_num_tokens (%d)", requestId, contextLength,
+        mConfig.maxNumTokens);
+    mQueue.push_back(QueuedRequest{requestId, contextLength});
+    mNumQueuedTokens += contextLength;
+}
+
+MicroBatchScheduler::MicroBatch MicroBatchScheduler::scheduleMicroBatch(SizeType32 microBatchIdx)
+{
+    TLLM_NVTX_SCOPED_RANGE(kSCHEDULER, scheduleMicroBatch);
+    TLLM_CHECK_WITH_INFO(microBatchIdx >= 0 && microBatchIdx < mConfig.numMicroBatches,
+        "Micro batch %d out of range [0, %d)", microBatchIdx, mConfig.numMicroBatches);
+    auto& generationRequests = mGenerationRequests[microBatchIdx];
+    MicroBatch batch;
+    batch.generationRequestIds = generationRequests;
+
+    // Share the tokens of the other micro batches in flight, the queued ones and our own evenly over all micro batches
+    SizeType32 numTokens = mNumQueuedTokens + batch.getNumTokens();
+    for (SizeType32 mb = 0; mb < mConfig.numMicroBatches; ++mb)
+    {
+        numTokens += mb == microBatchIdx ? 0 : mInFlightTokens[mb];
+    }
+    auto const share = (numTokens + mConfig.numMicroBatches - 1) / mConfig.numMicroBatches;
+    auto const budget = std::min(share, mConfig.maxNumTokens) - batch.getNumTokens();
+
+    while (!mQueue.empty() && batch.getBatchSize() < mConfig.maxBatchSize)
+    {
+        auto const& request = mQueue.front();
+        auto const fitsShare = batch.numContextTokens + request.contextLength <= budget;
+        // A request longer than the share still goes to a micro batch without context, it would never fit otherwise
+        auto const fitsAlone = batch.contextRequestIds.empty()
+            && batch.getNumTokens() + request.contextLength <= mConfig.maxNumTokens;
+        if (!fitsShare && !fitsAlone)
+        {
+            break;
+        }
+        batch.contextRequestIds.push_back(request.requestId);
+        batch.contextLengths.push_back(request.contextLength);
+        batch.numContextTokens += request.contextLength;
+        mNumQueuedTokens -= request.contextLength;
+        generationRequests.push_back(request.requestId);
+        mMicroBatchOf[request.requestId] = microBatchIdx;
+        mQueue.pop_front();
+    }
+    mInFlightTokens[microBatchIdx] = batch.getNumTokens();
+    return batch;
+}
+
+void MicroBatchScheduler::remove(RequestIdType requestId)
+{
+    if (auto const it = mMicroBatchOf.find(requestId); it != mMicroBatchOf.end())
+    {
+        auto& requests = mGenerationRequests[it->second];
+        requests.erase(std::remove(requests.begin(), requests.end(), requestId), requests.end());
+        mMicroBatchOf.erase(it);
+        return;
+    }
+    auto const it = std::find_if(
+        mQueue.begin(), mQueue.end(), [requestId](auto const& request) { return request.requestId == requestId; });
+    if (it != mQueue.end())
+    {
+        mNumQueuedTokens -= it->contextLength;
+        mQueue.erase(it);
+    }
+}
+
+SizeType32 MicroBatchScheduler::getNumGenerationRequests(SizeType32 microBatchIdx) const
+{
+    TLLM_CHECK_WITH_INFO(microBatchIdx >= 0 && microBatchIdx < mConfig.numMicroBatches,
+        "Micro batch %d out of range [0, %d)", microBatchIdx, mConfig.numMicroBatches);
+    return static_cast<SizeType32>(mGenerationRequests[microBatchIdx].size());
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Splits inflight batching over the micro batches of a pipeline, so that every stage has work.
+//! \details With pipeline parallelism, numMicroBatches (usually ppSize) micro batches are in flight, each in its own
+//! pipeline stage. A micro batch is rescheduled when it leaves the last stage. Generation requests stay in the micro
+//! batch that ran their context, their state lives in its buffers. New context requests go to the micro batch being
+//! scheduled up to an even share of the queued tokens and the tokens of all micro batches in flight. Without the
+//! share, the first micro batch to come back takes the whole queue and the others run only generation tokens, so the
+//! stages that wait behind the long micro batch idle.
+class MicroBatchScheduler
+{
+public:
+    using RequestIdType = std::uint64_t;
+
+    struct Config
+    {
+        SizeType32 numMicroBatches{1};
+        SizeType32 maxBatchSize{256};
+        SizeType32 maxNumTokens{8192};
+    };
+
+    struct MicroBatch
+    {
+        std::vector<RequestIdType> contextRequestIds;
+        std::vector<SizeType32> contextLengths;
+        std::vector<RequestIdType> generationRequestIds;
+        SizeType32 numContextTokens{0};
+
+        [[nodiscard]] SizeType32 getNumTokens() const noexcept
+        {
+            return numContextTokens + static_cast<SizeType32>(generationRequestIds.size());
+        }
+
+        [[nodiscard]] SizeType32 getBatchSize() const noexcept
+        {
+            return static_cast<SizeType32>(contextRequestIds.size() + generationRequestIds.size());
+        }
+    };
+
+    explicit MicroBatchScheduler(Config const& config);
+
+    //! \brief Queue a new request. Its context must fit in maxNumTokens on its own.
+    void enqueue(RequestIdType requestId, SizeType32 contextLength);
+
+    //! \brief Form the next batch of micro batch microBatchIdx, after its previous batch left the pipeline. The
+    //! context requests of the batch run their generation in this micro batch from then on.
+    [[nodiscard]] MicroBatch scheduleMicroBatch(SizeType32 microBatchIdx);
+
+    //! \brief Remove a finished or cancelled request, wherever it is.
+    void remove(RequestIdType requestId);
+
+    [[nodiscard]] SizeType32 getNumQueuedRequests() const noexcept
+    {
+        return static_cast<SizeType32>(mQueue.size());
+    }
+
+    [[nodiscard]] SizeType32 getNumGenerationRequests(SizeType32 microBatchIdx) const;
+
+    [[nodiscard]] Config const& getConfig() const noexcept
+    {
+        return mConfig;
+    }
+
+private:
+    struct QueuedRequest
+    {
+        RequestIdType requestId;
+        SizeType32 contextLength;
+    };
+
+    Config mConfig;
+    std::deque<QueuedRequest> mQueue;
+    SizeType32 mNumQueuedTokens{0};
+    //! \brief The generation requests of every micro batch.
+    std::vector<std::vector<RequestIdType>> mGenerationRequests;
+    std::unordered_map<RequestIdType, SizeType32> mMicroBatchOf;
+    //! \brief The number of tokens of the batch every micro batch runs now.
+    std::vector<SizeType32> mInFlightTokens;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/moeExpertOffload.h"
+
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+namespace tensorrt_llm::runtime
+{
+
+MoeExpertResidency::MoeExpertResidency(SizeType32 numExperts, SizeType32 numSlots, SizeType32 topK, float decay)
+    : mNumExperts{numExperts}
+    , mTopK{topK}
+    , mDecay{decay}
+    , mSlotExperts(numSlots, -1)
+    , mExpertSlots(numExperts, -1)
+    , mFrequencies(numExperts, 0.f)
+{
+    TLLM_CHECK_WITH_INFO(0 < topK && topK <= numSlots && numSlots <= numExperts,
+        "Expert offloading needs top k %d <= slots %d <= experts %d", topK, numSlots, numExperts);
+    TLLM_CHECK_WITH_INFO(decay > 0.f && decay <= 1.f, "Invalid decay %f", decay);
+}
+
+std::vector<MoeExpertResidency::Chunk> MoeExpertResidency::plan(float const* routing, SizeType32 numTokens)
+{
+    for (auto& frequency : mFrequencies)
+    {
+        frequency *= mDecay;
+    }
+
+    // Split the tokens greedily into chunks whose experts fit into the slots
+    std::vector<Chunk> chunks;
+    std::vector<std::vector<SizeType32>> chunkExperts;
+    std::vector<bool> inChunk(mNumExperts, false);
+    std::vector<SizeType32> experts;
+    std::vector<SizeType32> tokenExperts;
+    SizeType32 beginToken = 0;
+    auto const closeChunk = [&](SizeType32 endToken)
+    {
+        chunks.push_back(Chunk{beginToken, endToken});
+        for (auto const expert : experts)
+        {
+            inChunk[expert] = false;
+        }
+        chunkExperts.push_back(std::move(experts));
+        experts.clear();
+        beginToken = endToken;
+    };
+
+    auto const numSlots = getNumSlots();
+    for (SizeType32 token = 0; token < numTokens; ++token)
+    {
+        auto const* logits = routing + static_cast<std::size_t>(token) * mNumExperts;
+        mScratch.assign(logits, logits + mNumExperts);
+        std::nth_element(mScratch.begin(), mScratch.begin() + (mTopK - 1), mScratch.end(), std::greater<float>());
+        auto const threshold = mScratch[mTopK - 1];
+        tokenExperts.clear();
+        SizeType32 numNew = 0;
+        for (SizeType32 expert = 0; expert < mNumExperts; ++expert)
+        {
+            if (logits[expert] >= threshold)
+            {
+                tokenExperts.push_back(expert);
+                numNew += inChunk[expert] ? 0 : 1;
+            }
+        }
+        TLLM_CHECK_WITH_INFO(static_cast<SizeType32>(tokenExperts.size()) <= numSlots,
+            "Token %d selects %zu tied experts, more than the %d expert slots", token, tokenExperts.size(), numSlots);
+        if (static_cast<SizeType32>(experts.size()) + numNew > numSlots)
+        {
+            closeChunk(token);
+        }
+        for (auto const expert : tokenExperts)
+        {
+            mFrequencies[expert] += 1.f;
+            if (!inChunk[expert])
+            {
+                inChunk[expert] = true;
+                experts.push_back(expert);
+            }
+        }
+    }
+    if (numTokens > beginToken)
+    {
+        closeChunk(numTokens);
+    }
+
+    // The stream is idle when a step is planned, so the first chunk may replace any expert
+    std::vector<bool> usedByPrevious(numSlots, false);
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+        usedByPrevious = assignSlots(chunks[i], chunkExperts[i], usedByPrevious);
+    }
+    return chunks;
+}
+
+std::vector<bool> MoeExpertResidency::assignSlots(
+    Chunk& chunk, std::vector<SizeType32> const& experts, std::vector<bool> const& usedByPrevious)
+{
+    auto const numSlots = getNumSlots();
+    std::vector<bool> used(numSlots, false);
+    for (auto const expert : experts)
+    {
+        if (mExpertSlots[expert] >= 0)
+        {
+            used[mExpertSlots[expert]] = true;
+        }
+    }
+
+    for (auto const expert : experts)
+    {
+        if (mExpertSlots[expert] >= 0)
+        {
+            continue;
+        }
+        // Prefer empty slots, then slots the previous chunk does not read so the load overlaps it, then the least
+        // frequently selected expert
+        SizeType32 victim = -1;
+        auto const evictionOrder = [&](SizeType32 slot)
+        {
+            auto const resident = mSlotExperts[slot];
+            return std::make_tuple(resident >= 0, static_cast<bool>(usedByPrevious[slot]),
+                resident >= 0 ? mFrequencies[resident] : 0.f);
+        };
+        for (SizeType32 slot = 0; slot < numSlots; ++slot)
+        {
+            if (!used[slot] && (victim < 0 || evictionOrder(slot) < evictionOrder(victim)))
+            {
+                victim = slot;
+            }
+        }
+        TLLM_CHECK_WITH_INFO(victim >= 0, "No free expert slot for expert %d", expert);
+
+        if (mSlotExperts[victim] >= 0)
+        {
+            mExpertSlots[mSlotExperts[victim]] = -1;
+        }
+        mSlotExperts[victim] = expert;
+        mExpertSlots[expert] = victim;
+        used[victim] = true;
+        chunk.loads.push_back(Load{expert, victim});
+        chunk.overwritesPrevious = chunk.overwritesPrevious || usedByPrevious[victim];
+    }
+
+    chunk.expertSlots.resize(mNumExperts);
+    std::transform(mExpertSlots.begin(), mExpertSlots.end(), chunk.expertSlots.begin(),
+        [](SizeType32 slot) { return std::max(slot, 0); });
+    return used;
+}
+
+void MoeOffloadedExperts::registerLayer(std::string const& layer, std::vector<ITensor::SharedPtr> hostExperts)
+{
+    TLLM_CHECK_WITH_INFO(!hostExperts.empty(), "MoE layer %s has no expert weights", layer.c_str());
+    auto const numExperts = hostExperts.front()->getShape().d[0];
+    for (auto const& tensor : hostExperts)
+    {
+        TLLM_CHECK_WITH_INFO(tensor->getShape().nbDims >= 1 && tensor->getShape().d[0] == numExperts,
+            "The expert weights of MoE layer %s must all have %ld experts", layer.c_str(),
+            static_cast<long>(numExperts));
+        TLLM_CHECK_WITH_INFO(
+            tensor->getMemoryType() == MemoryType::kPINNED || tensor->getMemoryType() == MemoryType::kPINNEDPOOL,
+            "The expert weights of MoE layer %s must be in pinned host memory", layer.c_str());
+    }
+
+    auto entry = std::make_shared<Layer>();
+    entry->hostExperts = std::move(hostExperts);
+    std::lock_guard<std::mutex> lock(mMutex);
+    mLayers[layer] = std::move(entry);
+}
+
+std::shared_ptr<MoeOffloadedExperts::Layer> MoeOffloadedExperts::getLayer(
+    std::string const& layer, SizeType32 numSlots, SizeType32 topK)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto const it = mLayers.find(layer);
+    TLLM_CHECK_WITH_INFO(
+        it != mLayers.end(), "MoE layer %s offloads its experts, but they were not registered", layer.c_str());
+    auto& entry = *it->second;
+    if (!entry.residency)
+    {
+        auto const numExperts = static_cast<SizeType32>(entry.hostExperts.front()->getShape().d[0]);
+        entry.residency = std::make_unique<MoeExpertResidency>(numExperts, numSlots, topK);
+    }
+    TLLM_CHECK_WITH_INFO(entry.residency->getNumSlots() == numSlots,
+        "MoE layer %s was used with %d expert slots, not %d", layer.c_str(), entry.residency->getNumSlots(), numSlots);
+    return it->second;
+}
+
+void MoeOffloadedExperts::unregisterLayer(std::string const& layer)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mLayers.erase(layer);
+}
+
+MoeOffloadedExperts& MoeOffloadedExperts::getInstance()
+{
+    static MoeOffloadedExperts mInstance;
+    return mInstance;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/moeLoadCounters.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace tensorrt_llm::runtime
+{
+
+std::int32_t* MoeLoadCounters::acquire(std::string const& layer, std::int32_t numExperts)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& entry = mLayers[layer];
+    if (!entry.counts)
+    {
+        entry.counts = BufferManager::gpuSync(numExperts, nvinfer1::DataType::kINT32);
+        TLLM_CUDA_CHECK(cudaMemset(entry.counts->data(), 0, entry.counts->getSizeInBytes()));
+    }
+    TLLM_CHECK_WITH_INFO(static_cast<std::int32_t>(entry.counts->getSize()) == numExperts,
+        "MoE layer %s was registered with %zu experts, not %d", layer.c_str(), entry.counts->getSize(), numExperts);
+    ++entry.numUsers;
+    return bufferCast<std::int32_t>(*entry.counts);
+}
+
+void MoeLoadCounters::release(std::string const& layer)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mLayers.find(layer);
+    TLLM_CHECK_WITH_INFO(it != mLayers.end(), "MoE layer %s has no load counters", layer.c_str());
+    if (--it->second.numUsers == 0)
+    {
+        mLayers.erase(it);
+    }
+}
+
+std::vector<executor::MoeLayerLoadStats> MoeLoadCounters::getStats()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::vector<executor::MoeLayerLoadStats> stats;
+    stats.reserve(mLayers.size());
+    std::vector<std::int32_t> hostCounts;
+    for (auto const& [name, entry] : mLayers)
+    {
+        hostCounts.resize(entry.counts->getSize());
+        TLLM_CUDA_CHECK(cudaMemcpy(
+            hostCounts.data(), entry.counts->data(), entry.counts->getSizeInBytes(), cudaMemcpyDeviceToHost));
+        TLLM_CUDA_CHECK(cudaMemset(entry.counts->data(), 0, entry.counts->getSizeInBytes()));
+
+        executor::MoeLayerLoadStats layerStats{};
+        layerStats.layer = name;
+        layerStats.numTokensPerExpert.assign(hostCounts.begin(), hostCounts.end());
+        auto const total = std::accumulate(
+            layerStats.numTokensPerExpert.begin(), layerStats.numTokensPerExpert.end(), std::uint64_t{0});
+        auto const maxCount
+            = *std::max_element(layerStats.numTokensPerExpert.begin(), layerStats.numTokensPerExpert.end());
+        layerStats.maxToMeanRatio
+            = total == 0 ? 1.0 : static_cast<double>(maxCount) * hostCounts.size() / static_cast<double>(total);
+        stats.push_back(std::move(layerStats));
+    }
+    return stats;
+}
+
+MoeLoadCounters& MoeLoadCounters::getInstance()
+{
+    static MoeLoadCounters mInstance;
+    return mInstance;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/multiModelBlockBudget.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+MultiModelBlockBudget::MultiModelBlockBudget(std::size_t memoryBudget)
+    : mMemoryBudget{memoryBudget}
+{
+}
+
+SizeType32 MultiModelBlockBudget::addModel(std::string name, std::size_t bytesPerBlock, SizeType32 minNumBlocks)
+{
+    TLLM_CHECK_WITH_INFO(bytesPerBlock > 0, "Block size of model %s must be positive", name.c_str());
+    TLLM_CHECK_WITH_INFO(minNumBlocks >= 0, "Minimum number of blocks of model %s must not be negative", name.c_str());
+    TLLM_CHECK_WITH_INFO(getAllocatedBytes() + minNumBlocks * bytesPerBlock <= mMemoryBudget,
+        "Minimum pool of model %s exceeds the memory budget", name.c_str());
+    mModels.push_back(Model{std::move(name), bytesPerBlock, minNumBlocks, minNumBlocks});
+    return static_cast<SizeType32>(mModels.size()) - 1;
+}
+
+void MultiModelBlockBudget::updateUsage(SizeType32 modelIdx, Usage const& usage)
+{
+    auto& model = mModels.at(modelIdx);
+    TLLM_CHECK_WITH_INFO(usage.numUsedBlocks <= model.numBlocks, "Model %s uses %d blocks of a pool of %d",
+        model.name.c_str(), usage.numUsedBlocks, model.numBlocks);
+    model.usage = usage;
+}
+
+bool MultiModelBlockBudget::rebalance()
+{
+    auto const numModels = mModels.size();
+    std::vector<std::size_t> floorBytes(numModels);
+    std::vector<std::size_t> missingBytes(numModels);
+    std::size_t totalFloorBytes{0};
+    std::size_t totalMissingBytes{0};
+    std::size_t totalNeededBytes{0};
+    for (std::size_t i = 0; i < numModels; ++i)
+    {
+        auto const& model = mModels[i];
+        auto const floorBlocks = std::max(model.minNumBlocks, model.usage.numUsedBlocks);
+        auto const neededBlocks = std::max(floorBlocks, model.usage.numNeededBlocks);
+        floorBytes[i] = floorBlocks * model.bytesPerBlock;
+        missingBytes[i] = (neededBlocks - floorBlocks) * model.bytesPerBlock;
+        totalFloorBytes += floorBytes[i];
+        totalMissingBytes += missingBytes[i];
+        totalNeededBytes += neededBlocks * model.bytesPerBlock;
+    }
+    TLLM_CHECK_WITH_INFO(totalFloorBytes <= mMemoryBudget, "Blocks in use exceed the memory budget");
+
+    auto const freeBytes = static_cast<double>(mMemoryBudget - totalFloorBytes);
+    auto const missingShare = totalMissingBytes > 0 ? std::min(1.0, freeBytes / totalMissingBytes) : 0.0;
+    auto const headroomBytes = std::max(0.0, freeBytes - static_cast<double>(totalMissingBytes));
+
+    bool changed{false};
+    for (std::size_t i = 0; i < numModels; ++i)
+    {
+        auto& model = mModels[i];
+        auto bytes = floorBytes[i] + missingShare * missingBytes[i];
+        if (totalNeededBytes > 0)
+        {
+            bytes += headroomBytes * static_cast<double>(floorBytes[i] + missingBytes[i]) / totalNeededBytes;
+        }
+        auto const numBlocks = static_cast<SizeType32>(bytes / model.bytesPerBlock);
+        if (numBlocks != model.numBlocks)
+        {
+            TLLM_LOG_DEBUG("Resizing KV cache pool of model %s from %d to %d blocks", model.name.c_str(),
+                model.numBlocks, numBlocks);
+            model.numBlocks = numBlocks;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+std::optional<SizeType32> MultiModelBlockBudget::getNextModel()
+{
+    auto const numModels = static_cast<SizeType32>(mModels.size());
+    for (SizeType32 offset = 1; offset <= numModels; ++offset)
+    {
+        auto const modelIdx = (mLastScheduled + offset + numModels) % numModels;
+        if (mModels[modelIdx].usage.numRequests > 0)
+        {
+            mLastScheduled = modelIdx;
+            return modelIdx;
+        }
+    }
+    return std::nullopt;
+}
+
+std::size_t MultiModelBlockBudget::getAllocatedBytes() const
+{
+    std::size_t bytes{0};
+    for (auto const& model : mModels)
+    {
+        bytes += model.numBlocks * model.bytesPerBlock;
+    }
+    return bytes;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Shares one KV cache memory budget between the engines of several models served by one process.
+//! \details Every model owns a block pool. Pools never shrink below the blocks in use, the remaining memory follows
+//! the demand the models report, so idle models hand their memory to busy ones. The budget also acts as the common
+//! scheduler of the models: getNextModel() picks the model that runs the next iteration round-robin among the models
+//! with work.
+class MultiModelBlockBudget
+{
+public:
+    struct Usage
+    {
+        //! Blocks held by in-flight requests
+        SizeType32 numUsedBlocks{0};
+        //! Blocks the model would need to also admit its waiting requests
+        SizeType32 numNeededBlocks{0};
+        //! Requests in flight or waiting
+        SizeType32 numRequests{0};
+    };
+
+    struct Model
+    {
+        std::string name;
+        std::size_t bytesPerBlock;
+        //! The pool never shrinks below this size
+        SizeType32 minNumBlocks;
+        SizeType32 numBlocks{0};
+        Usage usage{};
+    };
+
+    explicit MultiModelBlockBudget(std::size_t memoryBudget);
+
+    //! \brief Register a model, its pool starts at minNumBlocks.
+    //! \returns The index of the model
+    SizeType32 addModel(std::string name, std::size_t bytesPerBlock, SizeType32 minNumBlocks = 0);
+
+    void updateUsage(SizeType32 modelIdx, Usage const& usage);
+
+    //! \brief Recompute the pool sizes from the reported usage.
+    //! \details Each pool first gets the blocks it uses, then the memory left is spent on the missing blocks of the
+    //! models, shared in proportion to the missing bytes if it does not cover all of them. Memory left after that is
+    //! spread in proportion to the needed bytes, so that busy models have headroom while idle ones shrink.
+    //! \returns True if any pool size changed
+    bool rebalance();
+
+    //! \brief The model to run the next iteration, round-robin among models with requests.
+    [[nodiscard]] std::optional<SizeType32> getNextModel();
+
+    [[nodiscard]] SizeType32 getNumBlocks(SizeType32 modelIdx) const
+    {
+        return mModels.at(modelIdx).numBlocks;
+    }
+
+    [[nodiscard]] std::vector<Model> const& getModels() const noexcept
+    {
+        return mModels;
+    }
+
+    [[nodiscard]] std::size_t getAllocatedBytes() const;
+
+    [[nodiscard]] std::size_t getMemoryBudget() const noexcept
+    {
+        return mMemoryBudget;
+    }
+
+private:
+    std::size_t mMemoryBudget;
+    std::vector<Model> mModels;
+    //! Model that ran the last iteration
+    SizeType32 mLastScheduled{-1};
+};
+
+} // namespace tensorrt_llm::runtime
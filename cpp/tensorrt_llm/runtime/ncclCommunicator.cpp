@@ -16,7 +16,9 @@
 
 #include "tensorrt_llm/runtime/ncclCommunicator.h"
 
+#include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
 #include "tensorrt_llm/runtime/utils/multiDeviceUtils.h"
 
 #if ENABLE_MULTI_DEVICE
@@ -52,6 +54,7 @@ ncclDataType_t toNcclType(nvinfer1::DataType dataType)
 void NcclCommunicator::send(
     void const* sendbuff, size_t count, nvinfer1::DataType dataType, int peer, CudaStream const& stream) const
 {
+    TLLM_NVTX_SCOPED_RANGE(kCOMM, send);
 #if ENABLE_MULTI_DEVICE
     TLLM_NCCL_CHECK(ncclSend(sendbuff, count, toNcclType(dataType), peer, mComm, stream.get()));
 #else
@@ -62,6 +65,7 @@ void NcclCommunicator::send(
 void NcclCommunicator::receive(
     void* sendbuff, size_t count, nvinfer1::DataType dataType, int peer, CudaStream const& stream) const
 {
+    TLLM_NVTX_SCOPED_RANGE(kCOMM, receive);
 #if ENABLE_MULTI_DEVICE
     TLLM_NCCL_CHECK(ncclRecv(sendbuff, count, toNcclType(dataType), peer, mComm, stream.get()));
 #else
@@ -69,6 +73,54 @@ void NcclCommunicator::receive(
 #endif // ENABLE_MULTI_DEVICE
 }
 
+void NcclCommunicator::allGather(IBuffer const& sendBuf, IBuffer& recvBuf, CudaStream const& stream) const
+{
+    TLLM_NVTX_SCOPED_RANGE(kCOMM, allGather);
+#if ENABLE_MULTI_DEVICE
+    TLLM_CHECK(sendBuf.getDataType() == recvBuf.getDataType());
+    int worldSize{0};
+    TLLM_NCCL_CHECK(ncclCommCount(mComm, &worldSize));
+    TLLM_CHECK_WITH_INFO(recvBuf.getSize() == sendBuf.getSize() * worldSize,
+        "Receive buffer of size %zu cannot hold %d times %zu elements", recvBuf.getSize(), worldSize,
+        sendBuf.getSize());
+    TLLM_NCCL_CHECK(ncclAllGather(sendBuf.data(), recvBuf.data(), sendBuf.getSize(),
+        toNcclType(sendBuf.getDataType()), mComm, stream.get()));
+#else
+    TLLM_THROW("Multi device support is disabled.");
+#endif // ENABLE_MULTI_DEVICE
+}
+
+void NcclCommunicator::allReduce(IBuffer const& sendBuf, IBuffer& recvBuf, CudaStream const& stream) const
+{
+    TLLM_NVTX_SCOPED_RANGE(kCOMM, allReduce);
+#if ENABLE_MULTI_DEVICE
+    TLLM_CHECK(sendBuf.getDataType() == recvBuf.getDataType());
+    TLLM_CHECK_WITH_INFO(recvBuf.getSize() == sendBuf.getSize(), "Receive buffer of size %zu cannot hold %zu elements",
+        recvBuf.getSize(), sendBuf.getSize());
+    TLLM_NCCL_CHECK(ncclAllReduce(sendBuf.data(), recvBuf.data(), sendBuf.getSize(),
+        toNcclType(sendBuf.getDataType()), ncclSum, mComm, stream.get()));
+#else
+    TLLM_THROW("Multi device support is disabled.");
+#endif // ENABLE_MULTI_DEVICE
+}
+
+void NcclCommunicator::reduceScatter(IBuffer const& sendBuf, IBuffer& recvBuf, CudaStream const& stream) const
+{
+    TLLM_NVTX_SCOPED_RANGE(kCOMM, reduceScatter);
+#if ENABLE_MULTI_DEVICE
+    TLLM_CHECK(sendBuf.getDataType() == recvBuf.getDataType());
+    int worldSize{0};
+    TLLM_NCCL_CHECK(ncclCommCount(mComm, &worldSize));
+    TLLM_CHECK_WITH_INFO(sendBuf.getSize() == recvBuf.getSize() * worldSize,
+        "Send buffer of size %zu is not %d times the receive buffer of size %zu", sendBuf.getSize(), worldSize,
+        recvBuf.getSize());
+    TLLM_NCCL_CHECK(ncclReduceScatter(sendBuf.data(), recvBuf.data(), recvBuf.getSize(),
+        toNcclType(sendBuf.getDataType()), ncclSum, mComm, stream.get()));
+#else
+    TLLM_THROW("Multi device support is disabled.");
+#endif // ENABLE_MULTI_DEVICE
+}
+
 ncclComm_t NcclCommunicator::createComm(int worldSize, int rank, mpi::MpiComm const& mpiComm)
 {
 #if ENABLE_MULTI_DEVICE
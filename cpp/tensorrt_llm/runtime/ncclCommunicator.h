@@ -55,6 +55,17 @@ public:
         receive(buf.data(), buf.getSize(), buf.getDataType(), peer, stream);
     }
 
+    //! \brief Gathers sendBuf of all ranks into recvBuf, ordered by rank. recvBuf holds worldSize times the elements
+    //! of sendBuf.
+    void allGather(IBuffer const& sendBuf, IBuffer& recvBuf, CudaStream const& stream) const;
+
+    //! \brief Sums sendBuf over all ranks into recvBuf, which may be sendBuf itself.
+    void allReduce(IBuffer const& sendBuf, IBuffer& recvBuf, CudaStream const& stream) const;
+
+    //! \brief Sums sendBuf over all ranks and scatters the sum: rank r receives the r-th of worldSize equal slices.
+    //! sendBuf holds worldSize times the elements of recvBuf.
+    void reduceScatter(IBuffer const& sendBuf, IBuffer& recvBuf, CudaStream const& stream) const;
+
 private:
     void send(
         void const* sendbuff, size_t count, nvinfer1::DataType dataType, int peer, CudaStream const& stream) const;
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/optProfileSelector.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+OptProfileSelector::OptProfileSelector(std::vector<ProfileRange> profiles)
+    : mProfiles{std::move(profiles)}
+{
+    TLLM_CHECK_WITH_INFO(!mProfiles.empty(), "The engine has no optimization profile");
+    for (auto const& profile : mProfiles)
+    {
+        TLLM_CHECK_WITH_INFO(profile.minTokens <= profile.optTokens && profile.optTokens <= profile.maxTokens,
+            "Invalid token range [%d, %d, %d]", profile.minTokens, profile.optTokens, profile.maxTokens);
+        TLLM_CHECK_WITH_INFO(profile.minSequences <= profile.maxSequences, "Invalid sequence range [%d, %d]",
+            profile.minSequences, profile.maxSequences);
+    }
+}
+
+std::optional<SizeType32> OptProfileSelector::select(
+    SizeType32 numTokens, SizeType32 numSequences, SizeType32 numContextRequests) const
+{
+    // Orders two accepting profiles, true if a is the better one for the batch
+    auto const isBetter = [&](ProfileRange const& a, ProfileRange const& b)
+    {
+        if (numContextRequests == 0)
+        {
+            return a.maxTokens < b.maxTokens;
+        }
+        bool const aCovers = a.optTokens >= numTokens;
+        bool const bCovers = b.optTokens >= numTokens;
+        if (aCovers != bCovers)
+        {
+            return aCovers;
+        }
+        return aCovers ? a.optTokens < b.optTokens : a.optTokens > b.optTokens;
+    };
+
+    std::optional<SizeType32> best;
+    for (SizeType32 profileIndex = 0; profileIndex < getNbProfiles(); ++profileIndex)
+    {
+        auto const& profile = mProfiles[profileIndex];
+        bool const accepts = profile.minTokens <= numTokens && numTokens <= profile.maxTokens
+            && profile.minSequences <= numSequences && numSequences <= profile.maxSequences;
+        if (accepts && (!best || isBetter(profile, mProfiles[*best])))
+        {
+            best = profileIndex;
+        }
+    }
+    return best;
+}
+
+} // namespace tensorrt_llm::runtime
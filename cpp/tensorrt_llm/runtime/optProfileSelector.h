@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <optional>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Picks the optimization profile of an engine for the shape of a batch.
+//! \details Engines built with several profiles have kernels tuned for different token counts, e.g. small M for
+//! decode-only batches and large M for long prefills. TllmRuntime::getOptProfileId only looks at the token count
+//! against split points the caller has to know. The selector reads the ranges of every profile from the engine and
+//! considers the mix of the batch too:
+//! - a profile must accept both the number of tokens and the number of sequences of the batch;
+//! - generation-only batches prefer the profile with the smallest token range, the one built for decode;
+//! - batches with context requests prefer the profile tuned, at its opt shape, for the closest token count at or
+//!   above theirs, falling back to the largest opt shape below.
+class OptProfileSelector
+{
+public:
+    //! \brief Shapes a profile accepts, from dimension 0 of the packed input ids and of the request types.
+    struct ProfileRange
+    {
+        SizeType32 minTokens{0};
+        SizeType32 optTokens{0};
+        SizeType32 maxTokens{0};
+        SizeType32 minSequences{0};
+        SizeType32 maxSequences{0};
+    };
+
+    explicit OptProfileSelector(std::vector<ProfileRange> profiles);
+
+    //! \param numTokens Tokens of the batch, context and generation.
+    //! \param numSequences Sequences of the batch, one per generation beam.
+    //! \param numContextRequests Requests of the batch in the context phase.
+    //! \return The profile index, std::nullopt if no profile accepts the batch.
+    [[nodiscard]] std::optional<SizeType32> select(
+        SizeType32 numTokens, SizeType32 numSequences, SizeType32 numContextRequests) const;
+
+    [[nodiscard]] SizeType32 getNbProfiles() const noexcept
+    {
+        return static_cast<SizeType32>(mProfiles.size());
+    }
+
+    [[nodiscard]] ProfileRange const& getProfile(SizeType32 profileIndex) const
+    {
+        return mProfiles.at(profileIndex);
+    }
+
+private:
+    std::vector<ProfileRange> mProfiles;
+};
+
+} // namespace tensorrt_llm::runtime
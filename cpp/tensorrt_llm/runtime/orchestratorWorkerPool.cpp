@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/orchestratorWorkerPool.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/gptJsonConfig.h"
+
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+OrchestratorWorkerPool::OrchestratorWorkerPool(std::string workerExecutablePath, SizeType32 numWorkers)
+    : mWorkerExecutablePath{std::move(workerExecutablePath)}
+    , mNumWorkers{numWorkers}
+{
+#if ENABLE_MULTI_DEVICE
+    TLLM_CHECK_WITH_INFO(mNumWorkers > 0, "A worker pool needs at least one worker, got %d", mNumWorkers);
+    TLLM_CHECK_WITH_INFO(std::filesystem::exists(mWorkerExecutablePath), "Worker executable %s does not exist",
+        mWorkerExecutablePath.c_str());
+    mpi::initialize(mpi::MpiThreadSupport::THREAD_MULTIPLE);
+
+    char* workerArgs[] = {const_cast<char*>(kPersistentFlag), nullptr};
+    MPI_Comm intercomm;
+    MPICHECK(MPI_Comm_spawn(mWorkerExecutablePath.c_str(), workerArgs, mNumWorkers, MPI_INFO_NULL, 0, MPI_COMM_SELF,
+        &intercomm, MPI_ERRCODES_IGNORE));
+    mComm = std::make_shared<mpi::MpiComm>(intercomm, true);
+    TLLM_LOG_INFO("Spawned a pool of %d persistent workers", mNumWorkers);
+#else
+    TLLM_THROW("Multi device support is disabled.");
+#endif
+}
+
+OrchestratorWorkerPool::~OrchestratorWorkerPool()
+{
+#if ENABLE_MULTI_DEVICE
+    try
+    {
+        // The workers wait for the next configuration, the intercommunicator root is the orchestrator.
+        auto release = kReleaseWorkers;
+        MPICHECK(MPI_Bcast(&release, 1, MPI_INT64_T, MPI_ROOT, *mComm));
+    }
+    catch (std::exception const& e)
+    {
+        TLLM_LOG_EXCEPTION(e);
+    }
+#endif
+}
+
+executor::ExecutorConfig OrchestratorWorkerPool::attach(
+    std::filesystem::path const& modelPath, executor::ExecutorConfig config) const
+{
+    auto const worldSize = GptJsonConfig::parse(modelPath / "config.json").getWorldSize();
+    TLLM_CHECK_WITH_INFO(worldSize == mNumWorkers, "The engine in %s has %d ranks, the worker pool has %d workers",
+        modelPath.c_str(), worldSize, mNumWorkers);
+
+    auto parallelConfig = config.getParallelConfig().value_or(executor::ParallelConfig{});
+    parallelConfig.setCommunicationMode(executor::CommunicationMode::kORCHESTRATOR);
+    parallelConfig.setOrchestratorConfig(
+        executor::OrchestratorConfig{true, mWorkerExecutablePath, mComm, /*spawnProcesses=*/false});
+    config.setParallelConfig(parallelConfig);
+    return config;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/outputTokenRing.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+std::uint64_t loadHeader(std::uint64_t const& header)
+{
+    return *reinterpret_cast<std::uint64_t const volatile*>(&header);
+}
+} // namespace
+
+OutputTokenRing::OutputTokenRing(SizeType32 maxBatchSize, SizeType32 capacity, IBuffer::SharedPtr block)
+    : mMaxBatchSize{maxBatchSize}
+    , mCapacity{capacity}
+    , mBlock{std::move(block)}
+    , mRequestSeqs(maxBatchSize, 0)
+    , mLastRequestSeqs(maxBatchSize, 0)
+{
+    TLLM_CHECK_WITH_INFO(maxBatchSize > 0 && capacity > 0, "The rings need a batch and a capacity");
+    TLLM_CHECK_WITH_INFO(mBlock && mBlock->getSizeInBytes() >= getBlockSize(maxBatchSize, capacity),
+        "The rings need %zu bytes", getBlockSize(maxBatchSize, capacity));
+    std::memset(mBlock->data(), 0, getBlockSize(maxBatchSize, capacity));
+}
+
+OutputTokenRing::OutputTokenRing(SizeType32 maxBatchSize, SizeType32 capacity)
+    : OutputTokenRing(maxBatchSize, capacity, BufferManager::pinned(getBlockSize(maxBatchSize, capacity)))
+{
+}
+
+std::size_t OutputTokenRing::getBlockSize(SizeType32 maxBatchSize, SizeType32 capacity)
+{
+    return static_cast<std::size_t>(maxBatchSize) * (sizeof(std::uint64_t) + capacity * sizeof(Entry));
+}
+
+std::uint64_t const* OutputTokenRing::getHeaders() const
+{
+    return static_cast<std::uint64_t const*>(mBlock->data());
+}
+
+OutputTokenRing::Entry const* OutputTokenRing::getEntries(SizeType32 slot) const
+{
+    auto const* entries = reinterpret_cast<Entry const*>(getHeaders() + mMaxBatchSize);
+    return entries + static_cast<std::size_t>(slot) * mCapacity;
+}
+
+std::uint32_t OutputTokenRing::startRequest(SizeType32 slot, bool publish)
+{
+    auto& lastRequestSeq = mLastRequestSeqs.at(slot);
+    // 0 marks slots not to publish
+    lastRequestSeq = lastRequestSeq == std::numeric_limits<std::uint32_t>::max() ? 1 : lastRequestSeq + 1;
+    mRequestSeqs.at(slot) = publish ? lastRequestSeq : 0;
+    return mRequestSeqs[slot];
+}
+
+void OutputTokenRing::enqueueWrite(ITensor const& requestSeqs, ITensor const& ids, ITensor const& inputLengths,
+    ITensor const& sequenceLengths, ITensor const* logProbs, ITensor const& finishReasons,
+    CudaStream const& stream) const
+{
+    auto const& idsShape = ids.getShape();
+    TLLM_CHECK(idsShape.nbDims == 3 && idsShape.d[0] == mMaxBatchSize);
+    auto const maxBeamWidth = static_cast<SizeType32>(idsShape.d[1]);
+    auto const maxSeqLen = static_cast<SizeType32>(idsShape.d[2]);
+    TLLM_CHECK(requestSeqs.getSize() == static_cast<std::size_t>(mMaxBatchSize));
+    TLLM_CHECK(sequenceLengths.getSize() == static_cast<std::size_t>(mMaxBatchSize) * maxBeamWidth);
+    TLLM_CHECK(logProbs == nullptr || logProbs->getSize() == ids.getSize());
+
+    auto* headers = static_cast<std::uint64_t*>(mBlock->data());
+    auto* entries = reinterpret_cast<Entry*>(headers + mMaxBatchSize);
+    auto const* requestSeqsPtr = static_cast<std::uint32_t const*>(requestSeqs.data());
+    kernels::invokeWriteOutputTokenRing(headers, entries, mCapacity, requestSeqsPtr, bufferCast<TokenIdType>(ids),
+        bufferCast<SizeType32>(inputLengths), bufferCast<SizeType32>(sequenceLengths),
+        logProbs == nullptr ? nullptr : bufferCast<float>(*logProbs),
+        static_cast<std::uint8_t const*>(finishReasons.data()), mMaxBatchSize, maxBeamWidth, maxSeqLen, stream);
+}
+
+OutputTokenRing::ReadResult OutputTokenRing::read(
+    SizeType32 slot, std::uint32_t requestSeq, SizeType32 from, std::vector<Entry>& entries) const
+{
+    TLLM_CHECK(0 <= slot && slot < mMaxBatchSize);
+    auto const& header = getHeaders()[slot];
+    auto const published = loadHeader(header);
+    if (static_cast<std::uint32_t>(published >> 32) != requestSeq)
+    {
+        return ReadResult{};
+    }
+    auto const numTokens = static_cast<SizeType32>(static_cast<std::uint32_t>(published));
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    auto const* ring = getEntries(slot);
+    auto const first = std::max(from, numTokens - mCapacity);
+    auto const numAppended = entries.size();
+    for (auto ti = first; ti < numTokens; ++ti)
+    {
+        entries.push_back(ring[ti % mCapacity]);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // The device may have lapped the entries read meanwhile, drop those it overwrote. A new request in the slot
+    // writes from the start of the ring, none of the entries can be trusted then.
+    auto const republished = loadHeader(header);
+    auto const republishedTokens = static_cast<std::uint32_t>(republished >> 32) == requestSeq
+        ? static_cast<SizeType32>(static_cast<std::uint32_t>(republished))
+        : numTokens + mCapacity;
+    auto const firstIntact = std::min(std::max(first, republishedTokens - mCapacity), numTokens);
+    if (firstIntact > first)
+    {
+        auto const begin = entries.begin() + static_cast<std::ptrdiff_t>(numAppended);
+        entries.erase(begin, begin + (firstIntact - first));
+    }
+    return ReadResult{numTokens, firstIntact > from};
+}
+
+} // namespace tensorrt_llm::runtime
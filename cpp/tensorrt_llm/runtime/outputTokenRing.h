@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/runtimeKernels.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Per-slot rings of generated tokens in pinned host memory, written by the device after every decoding step
+//! and read by the response thread without a copy or a synchronization.
+//! \details Streaming otherwise copies the output ids of the batch to the host every iteration and slices the new
+//! tokens of each request out of them. Here a kernel appends the new tokens of each slot, with their log probs and
+//! the finish reason of the last one, to the ring of the slot and then publishes the number of tokens of the request,
+//! tagged with the request sequence number of the slot. A reader that keeps up with the ring gets every token exactly
+//! once; one that falls more than a ring behind is told so instead of reading overwritten entries.
+//!
+//! Only requests without beam search are published, beams are reordered after the fact.
+class OutputTokenRing
+{
+public:
+    using Entry = kernels::OutputTokenRingEntry;
+
+    struct ReadResult
+    {
+        //! Number of tokens the request has published, the entries up to it were appended
+        SizeType32 numTokens{0};
+        //! The entries from the requested one to numTokens - capacity were overwritten before they were read
+        bool overrun{false};
+    };
+
+    //! \param block Memory of getBlockSize bytes the device can write and the host can read, e.g. pinned memory.
+    OutputTokenRing(SizeType32 maxBatchSize, SizeType32 capacity, IBuffer::SharedPtr block);
+
+    //! \brief Rings in pinned host memory.
+    OutputTokenRing(SizeType32 maxBatchSize, SizeType32 capacity);
+
+    [[nodiscard]] static std::size_t getBlockSize(SizeType32 maxBatchSize, SizeType32 capacity);
+
+    //! \brief Start a new request in slot.
+    //! \param publish Whether the tokens of the request go to the ring, e.g. not with beam search.
+    //! \return The sequence number the device must tag the tokens of the request with, 0 if they are not published.
+    //! The caller makes it the value of the slot in the request sequence tensor passed to enqueueWrite, ordered
+    //! before the next write.
+    std::uint32_t startRequest(SizeType32 slot, bool publish = true);
+
+    //! \brief Sequence number of the request last started in slot, 0 if none.
+    [[nodiscard]] std::uint32_t getRequestSeq(SizeType32 slot) const
+    {
+        return mRequestSeqs.at(slot);
+    }
+
+    //! \brief Enqueue on stream the append of the tokens generated since the previous write.
+    //! \param requestSeqs [maxBatchSize], request sequence number of each slot as int32 bits, 0 for slots not to
+    //! publish, on gpu.
+    //! \param ids [maxBatchSize, maxBeamWidth, maxSeqLen], on gpu.
+    //! \param inputLengths [maxBatchSize], on gpu.
+    //! \param sequenceLengths [maxBatchSize, maxBeamWidth], on gpu.
+    //! \param logProbs [maxBatchSize, maxBeamWidth, maxSeqLen] indexed from the first generated token, or nullptr.
+    //! \param finishReasons [maxBatchSize, maxBeamWidth], FinishedState, on gpu.
+    void enqueueWrite(ITensor const& requestSeqs, ITensor const& ids, ITensor const& inputLengths,
+        ITensor const& sequenceLengths, ITensor const* logProbs, ITensor const& finishReasons,
+        CudaStream const& stream) const;
+
+    //! \brief Append to entries the tokens of request requestSeq in slot from index from on. Thread safe with respect
+    //! to the device and to other readers.
+    //! \return Nothing appended while the device has not published a token of the request yet.
+    ReadResult read(SizeType32 slot, std::uint32_t requestSeq, SizeType32 from, std::vector<Entry>& entries) const;
+
+    [[nodiscard]] SizeType32 getCapacity() const noexcept
+    {
+        return mCapacity;
+    }
+
+private:
+    [[nodiscard]] std::uint64_t const* getHeaders() const;
+    [[nodiscard]] Entry const* getEntries(SizeType32 slot) const;
+
+    SizeType32 const mMaxBatchSize;
+    SizeType32 const mCapacity;
+    IBuffer::SharedPtr mBlock;
+    std::vector<std::uint32_t> mRequestSeqs;
+    // Sequence numbers keep counting over unpublished requests, a stale header never matches a new request
+    std::vector<std::uint32_t> mLastRequestSeqs;
+};
+
+} // namespace tensorrt_llm::runtime
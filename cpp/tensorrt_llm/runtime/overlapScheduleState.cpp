@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/overlapScheduleState.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <unordered_set>
+
+namespace tensorrt_llm::runtime
+{
+
+void OverlapScheduleState::scheduleNext(std::vector<ScheduledRequest> step)
+{
+    TLLM_CHECK_WITH_INFO(!mHasPendingStep, "The previous step must be resolved before scheduling the next one");
+    mPendingStep = std::move(step);
+    mHasPendingStep = true;
+}
+
+OverlapScheduleState::Fixup OverlapScheduleState::resolve(std::vector<RequestIdType> const& finishedRequestIds)
+{
+    TLLM_CHECK_WITH_INFO(mHasPendingStep, "No step to resolve");
+    std::unordered_set<RequestIdType> const finished(finishedRequestIds.begin(), finishedRequestIds.end());
+
+    Fixup fixup;
+    fixup.active.reserve(mPendingStep.size());
+    mCurrentStep.clear();
+    for (auto const& request : mPendingStep)
+    {
+        auto const isFinished = finished.count(request.requestId) > 0;
+        fixup.active.push_back(!isFinished);
+        if (isFinished)
+        {
+            fixup.numReleasedTokens += request.numReservedTokens;
+            fixup.dropped.push_back(request);
+        }
+        else
+        {
+            mCurrentStep.push_back(request);
+        }
+    }
+    if (!fixup.dropped.empty())
+    {
+        ++mNumMispredictedSteps;
+    }
+    mPendingStep.clear();
+    mHasPendingStep = false;
+    return fixup;
+}
+
+} // namespace tensorrt_llm::runtime
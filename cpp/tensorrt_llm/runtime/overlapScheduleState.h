@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Bookkeeping for scheduling iteration N+1 while iteration N runs on the GPU.
+//! \details The step N+1 is scheduled speculatively, assuming that no request of step N finishes. Once the outputs of
+//! step N are synchronized (IGptDecoderBatched::forwardSync on the token returned by forwardAsync one step later),
+//! resolve() removes the requests that finished in step N from step N+1 and reports what to undo: the decoder slots to
+//! deactivate and the KV cache tokens that were reserved for them.
+class OverlapScheduleState
+{
+public:
+    using RequestIdType = std::uint64_t;
+
+    struct ScheduledRequest
+    {
+        RequestIdType requestId;
+        SizeType32 seqSlot;
+        //! Number of KV cache tokens reserved for the request in this step
+        SizeType32 numReservedTokens;
+    };
+
+    struct Fixup
+    {
+        //! Requests removed from the step because they finished in the previous one
+        std::vector<ScheduledRequest> dropped;
+        //! Per request of the step as scheduled, whether it stays in the step
+        std::vector<bool> active;
+        SizeType32 numReleasedTokens{0};
+    };
+
+    //! \brief Record the speculatively scheduled step. At most one step can wait for resolution.
+    void scheduleNext(std::vector<ScheduledRequest> step);
+
+    [[nodiscard]] bool hasPendingStep() const noexcept
+    {
+        return mHasPendingStep;
+    }
+
+    [[nodiscard]] std::vector<ScheduledRequest> const& getPendingStep() const noexcept
+    {
+        return mPendingStep;
+    }
+
+    //! \brief Resolve the pending step with the requests that finished in the step before it.
+    //! \details The pending step, without the dropped requests, becomes the current step.
+    Fixup resolve(std::vector<RequestIdType> const& finishedRequestIds);
+
+    //! \brief Requests of the last resolved step.
+    [[nodiscard]] std::vector<ScheduledRequest> const& getCurrentStep() const noexcept
+    {
+        return mCurrentStep;
+    }
+
+    //! \brief Number of steps in which speculation scheduled a request that had already finished.
+    [[nodiscard]] SizeType32 getNumMispredictedSteps() const noexcept
+    {
+        return mNumMispredictedSteps;
+    }
+
+private:
+    std::vector<ScheduledRequest> mCurrentStep;
+    std::vector<ScheduledRequest> mPendingStep;
+    bool mHasPendingStep{false};
+    SizeType32 mNumMispredictedSteps{0};
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/pinnedStagingPool.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/tllmBuffers.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+static_assert(PinnedStagingPool::kMinClassSize << (PinnedStagingPool::kNumClasses - 1)
+    == PinnedStagingPool::kMaxClassSize);
+
+PinnedStagingPool::~PinnedStagingPool()
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    PinnedAllocator allocator;
+    for (auto const& [base, slab] : mSlabs)
+    {
+        try
+        {
+            allocator.deallocate(reinterpret_cast<void*>(base), kSlabSize);
+        }
+        catch (std::exception const& e)
+        {
+            TLLM_LOG_EXCEPTION(e);
+        }
+    }
+}
+
+std::size_t PinnedStagingPool::getSizeClass(std::size_t size) noexcept
+{
+    if (size > kMaxClassSize)
+    {
+        return kNumClasses;
+    }
+    std::size_t sizeClass{0};
+    while ((kMinClassSize << sizeClass) < size)
+    {
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+void PinnedStagingPool::allocateSlab(std::size_t sizeClass)
+{
+    auto* base = PinnedAllocator{}.allocate(kSlabSize);
+    auto const blockSize = kMinClassSize << sizeClass;
+    auto const numBlocks = static_cast<std::uint32_t>(kSlabSize / blockSize);
+    mSlabs.emplace(reinterpret_cast<std::uintptr_t>(base), Slab{sizeClass, numBlocks, numBlocks});
+    auto& freeList = mFreeLists[sizeClass];
+    // Hand out the blocks in address order
+    for (auto block = numBlocks; block > 0; --block)
+    {
+        freeList.push_back(static_cast<std::uint8_t*>(base) + (block - 1) * blockSize);
+    }
+}
+
+void* PinnedStagingPool::allocate(std::size_t size)
+{
+    auto const sizeClass = getSizeClass(size);
+    std::lock_guard<std::mutex> const lock(mMutex);
+    ++mNumAllocations;
+    if (sizeClass == kNumClasses)
+    {
+        ++mNumMisses;
+        auto* ptr = PinnedPoolAllocator{}.allocate(size);
+        mLargeAllocations.emplace(ptr, size);
+        mUsedSize += size;
+        return ptr;
+    }
+    auto& freeList = mFreeLists[sizeClass];
+    if (freeList.empty())
+    {
+        ++mNumMisses;
+        allocateSlab(sizeClass);
+    }
+    auto* ptr = freeList.back();
+    freeList.pop_back();
+    auto it = std::prev(mSlabs.upper_bound(reinterpret_cast<std::uintptr_t>(ptr)));
+    --it->second.numFree;
+    mUsedSize += kMinClassSize << sizeClass;
+    return ptr;
+}
+
+void PinnedStagingPool::deallocate(void* ptr, std::size_t size)
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+    auto const sizeClass = getSizeClass(size);
+    std::lock_guard<std::mutex> const lock(mMutex);
+    if (sizeClass == kNumClasses)
+    {
+        auto const it = mLargeAllocations.find(ptr);
+        TLLM_CHECK_WITH_INFO(it != mLargeAllocations.end(), "Pointer %p was not allocated by the staging pool", ptr);
+        PinnedPoolAllocator{}.deallocate(ptr, it->second);
+        mUsedSize -= it->second;
+        mLargeAllocations.erase(it);
+        return;
+    }
+    auto const address = reinterpret_cast<std::uintptr_t>(ptr);
+    auto it = mSlabs.upper_bound(address);
+    TLLM_CHECK_WITH_INFO(it != mSlabs.begin(), "Pointer %p was not allocated by the staging pool", ptr);
+    --it;
+    TLLM_CHECK_WITH_INFO(address < it->first + kSlabSize && it->second.sizeClass == sizeClass,
+        "Pointer %p of %zu B was not allocated by the staging pool with this size", ptr, size);
+    ++it->second.numFree;
+    mFreeLists[sizeClass].push_back(ptr);
+    mUsedSize -= kMinClassSize << sizeClass;
+}
+
+std::size_t PinnedStagingPool::trimTo(std::size_t bytesToKeep)
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    auto reserved = mSlabs.size() * kSlabSize;
+    std::size_t trimmed{0};
+    PinnedAllocator allocator;
+    for (auto it = mSlabs.begin(); it != mSlabs.end() && reserved > bytesToKeep;)
+    {
+        auto const& [base, slab] = *it;
+        if (slab.numFree != slab.numBlocks)
+        {
+            ++it;
+            continue;
+        }
+        auto& freeList = mFreeLists[slab.sizeClass];
+        freeList.erase(std::remove_if(freeList.begin(), freeList.end(),
+                           [base = base](void* block)
+                           {
+                               auto const address = reinterpret_cast<std::uintptr_t>(block);
+                               return address >= base && address < base + kSlabSize;
+                           }),
+            freeList.end());
+        allocator.deallocate(reinterpret_cast<void*>(base), kSlabSize);
+        reserved -= kSlabSize;
+        trimmed += kSlabSize;
+        it = mSlabs.erase(it);
+    }
+    mTrimmedSize += trimmed;
+    TLLM_LOG_DEBUG("PinnedStagingPool: trimmed %zu B, %zu B reserved", trimmed, reserved);
+    return trimmed;
+}
+
+std::size_t PinnedStagingPool::getReservedSize() const
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    return mSlabs.size() * kSlabSize;
+}
+
+std::size_t PinnedStagingPool::getUsedSize() const
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    return mUsedSize;
+}
+
+executor::PinnedStagingStats PinnedStagingPool::getStats()
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    executor::PinnedStagingStats stats{};
+    stats.reservedBytes = mSlabs.size() * kSlabSize;
+    stats.usedBytes = mUsedSize;
+    stats.numAllocations = std::exchange(mNumAllocations, 0);
+    stats.numMisses = std::exchange(mNumMisses, 0);
+    stats.trimmedBytes = std::exchange(mTrimmedSize, 0);
+    return stats;
+}
+
+PinnedStagingPool& PinnedStagingPool::getInstance()
+{
+    static PinnedStagingPool instance;
+    return instance;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/preemptionPlanner.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+std::vector<PreemptionPlanner::RequestIdType> PreemptionPlanner::selectVictims(std::vector<Candidate> candidates,
+    PriorityType waitingPriority, SizeType32 numBlocksNeeded, SizeType32 numFreeBlocks)
+{
+    TLLM_NVTX_SCOPED_RANGE(kSCHEDULER, selectVictims);
+    TLLM_CHECK_WITH_INFO(numBlocksNeeded >= 0 && numFreeBlocks >= 0, "Block counts must not be negative");
+    std::vector<RequestIdType> victims;
+    if (numFreeBlocks >= numBlocksNeeded)
+    {
+        return victims;
+    }
+
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                         [waitingPriority](Candidate const& c) { return c.priority >= waitingPriority; }),
+        candidates.end());
+    std::sort(candidates.begin(), candidates.end(),
+        [](Candidate const& lhs, Candidate const& rhs)
+        {
+            if (lhs.priority != rhs.priority)
+            {
+                return lhs.priority < rhs.priority;
+            }
+            return lhs.scheduleOrder > rhs.scheduleOrder;
+        });
+
+    auto freeBlocks = numFreeBlocks;
+    for (auto const& candidate : candidates)
+    {
+        if (freeBlocks >= numBlocksNeeded)
+        {
+            break;
+        }
+        victims.push_back(candidate.requestId);
+        freeBlocks += candidate.numBlocks;
+    }
+    if (freeBlocks < numBlocksNeeded)
+    {
+        // Pausing would not admit the waiting request, so leave the in-flight requests running.
+        victims.clear();
+    }
+    return victims;
+}
+
+void PreemptionPlanner::sortForResume(std::vector<Candidate>& paused)
+{
+    std::sort(paused.begin(), paused.end(),
+        [](Candidate const& lhs, Candidate const& rhs)
+        {
+            if (lhs.priority != rhs.priority)
+            {
+                return lhs.priority > rhs.priority;
+            }
+            return lhs.scheduleOrder < rhs.scheduleOrder;
+        });
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Selects in-flight requests to pause for the priority preemptive capacity scheduler.
+//! \details When a waiting request cannot be admitted because the primary KV cache pool is exhausted, in-flight requests
+//! of strictly lower priority are paused and their blocks are offloaded to the secondary pool. A paused request keeps
+//! its blocks reusable, so that on resume it onboards them instead of running the context phase again.
+class PreemptionPlanner
+{
+public:
+    using RequestIdType = std::uint64_t;
+    using PriorityType = executor::PriorityType;
+
+    struct Candidate
+    {
+        RequestIdType requestId;
+        PriorityType priority;
+        //! Number of primary pool blocks released when the request is paused
+        SizeType32 numBlocks;
+        //! Position in the scheduling order, larger values were scheduled later
+        SizeType32 scheduleOrder;
+    };
+
+    //! \brief Pick the requests to pause so that numBlocksNeeded blocks become free.
+    //! \details Victims are taken by ascending priority and, within a priority, latest scheduled first, since those have
+    //! made the least progress. Requests with a priority at or above waitingPriority are never paused.
+    //! \return The ids of the requests to pause, or an empty vector if pausing cannot free enough blocks.
+    [[nodiscard]] static std::vector<RequestIdType> selectVictims(std::vector<Candidate> candidates,
+        PriorityType waitingPriority, SizeType32 numBlocksNeeded, SizeType32 numFreeBlocks);
+
+    //! \brief Order paused requests for resumption: highest priority first, earliest scheduled first within a
+    //! priority.
+    static void sortForResume(std::vector<Candidate>& paused);
+};
+
+} // namespace tensorrt_llm::runtime
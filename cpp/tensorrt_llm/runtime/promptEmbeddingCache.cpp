@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/promptEmbeddingCache.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+PromptEmbeddingCache::PromptEmbeddingCache(std::size_t maxDeviceBytes, std::size_t maxHostBytes, BufferManager manager)
+    : mMaxDeviceBytes{maxDeviceBytes}
+    , mMaxHostBytes{maxHostBytes}
+    , mManager{std::move(manager)}
+{
+}
+
+std::size_t PromptEmbeddingCache::hashContent(ITensor const& table)
+{
+    TLLM_CHECK_WITH_INFO(table.getMemoryType() != MemoryType::kGPU, "The embedding table must be in host memory");
+    auto const bytes = std::string_view(static_cast<char const*>(table.data()), table.getSizeInBytes());
+    return std::hash<std::string_view>{}(bytes);
+}
+
+PromptEmbeddingCache::TensorPtr PromptEmbeddingCache::put(IdType id, ITensor const& table)
+{
+    auto const contentHash = hashContent(table);
+    auto const sizeInBytes = table.getSizeInBytes();
+    if (auto const idIt = mIdToEntry.find(id); idIt != mIdToEntry.end())
+    {
+        auto const it = idIt->second;
+        if (it->contentHash == contentHash && it->sizeInBytes == sizeInBytes)
+        {
+            ++mStats.numHits;
+            return makeResident(it);
+        }
+        TLLM_LOG_DEBUG("Embedding table id %lu is rebound to new content", id);
+        unbind(id);
+    }
+    ++mStats.numMisses;
+
+    auto const [begin, end] = mContentIndex.equal_range(contentHash);
+    for (auto indexIt = begin; indexIt != end; ++indexIt)
+    {
+        auto const it = indexIt->second;
+        if (it->sizeInBytes == sizeInBytes)
+        {
+            ++mStats.numDedups;
+            bind(id, it);
+            return makeResident(it);
+        }
+    }
+
+    reserveDevice(sizeInBytes, mEntries.cend());
+    TensorPtr device = mManager.copyFrom(table, MemoryType::kGPU);
+    mStats.deviceBytes += sizeInBytes;
+    mEntries.push_back(Entry{contentHash, sizeInBytes, std::move(device), nullptr, 0});
+    auto const it = std::prev(mEntries.end());
+    mContentIndex.emplace(contentHash, it);
+    bind(id, it);
+    return it->device;
+}
+
+std::optional<PromptEmbeddingCache::TensorPtr> PromptEmbeddingCache::get(IdType id)
+{
+    auto const idIt = mIdToEntry.find(id);
+    if (idIt == mIdToEntry.end())
+    {
+        ++mStats.numMisses;
+        return std::nullopt;
+    }
+    ++mStats.numHits;
+    return makeResident(idIt->second);
+}
+
+void PromptEmbeddingCache::erase(IdType id)
+{
+    if (mIdToEntry.count(id) > 0)
+    {
+        unbind(id);
+    }
+}
+
+PromptEmbeddingCache::TensorPtr const& PromptEmbeddingCache::makeResident(EntryList::iterator it)
+{
+    // Most recently used last
+    mEntries.splice(mEntries.end(), mEntries, it);
+    if (!it->device)
+    {
+        reserveDevice(it->sizeInBytes, it);
+        it->device = mManager.copyFrom(*it->host, MemoryType::kGPU);
+        mStats.deviceBytes += it->sizeInBytes;
+        ++mStats.numReloads;
+    }
+    return it->device;
+}
+
+void PromptEmbeddingCache::bind(IdType id, EntryList::iterator it)
+{
+    mIdToEntry.emplace(id, it);
+    ++it->numIds;
+}
+
+void PromptEmbeddingCache::unbind(IdType id)
+{
+    auto const idIt = mIdToEntry.find(id);
+    auto const it = idIt->second;
+    mIdToEntry.erase(idIt);
+    if (--it->numIds == 0)
+    {
+        dropEntry(it);
+    }
+}
+
+void PromptEmbeddingCache::reserveDevice(std::size_t sizeInBytes, EntryList::const_iterator keep)
+{
+    while (mStats.deviceBytes + sizeInBytes > mMaxDeviceBytes)
+    {
+        // Spilling can drop other entries, look for the least recently used one from the start each time
+        auto it = mEntries.begin();
+        while (it != mEntries.end() && (it == keep || !it->device))
+        {
+            ++it;
+        }
+        if (it == mEntries.end())
+        {
+            return;
+        }
+        spill(it, keep);
+    }
+}
+
+void PromptEmbeddingCache::reserveHost(std::size_t sizeInBytes, EntryList::const_iterator keep)
+{
+    for (auto it = mEntries.begin(); it != mEntries.end() && mStats.hostBytes + sizeInBytes > mMaxHostBytes;)
+    {
+        auto const next = std::next(it);
+        if (it != keep && it->host)
+        {
+            if (it->device)
+            {
+                dropHostCopy(it);
+            }
+            else
+            {
+                dropEntry(it);
+            }
+        }
+        it = next;
+    }
+}
+
+void PromptEmbeddingCache::spill(EntryList::iterator it, EntryList::const_iterator keep)
+{
+    if (!it->host)
+    {
+        reserveHost(it->sizeInBytes, keep);
+        if (mStats.hostBytes + it->sizeInBytes > mMaxHostBytes)
+        {
+            // No room on the host either
+            dropEntry(it);
+            return;
+        }
+        it->host = BufferManager::pinned(it->device->getShape(), it->device->getDataType());
+        mManager.copy(*it->device, *it->host);
+        mStats.hostBytes += it->sizeInBytes;
+    }
+    // Freed in stream order, after the copy
+    it->device.reset();
+    mStats.deviceBytes -= it->sizeInBytes;
+    ++mStats.numSpills;
+}
+
+void PromptEmbeddingCache::dropHostCopy(EntryList::iterator it)
+{
+    it->host.reset();
+    mStats.hostBytes -= it->sizeInBytes;
+}
+
+void PromptEmbeddingCache::dropEntry(EntryList::iterator it)
+{
+    for (auto idIt = mIdToEntry.begin(); idIt != mIdToEntry.end();)
+    {
+        idIt = idIt->second == it ? mIdToEntry.erase(idIt) : std::next(idIt);
+    }
+    auto const [begin, end] = mContentIndex.equal_range(it->contentHash);
+    for (auto indexIt = begin; indexIt != end; ++indexIt)
+    {
+        if (indexIt->second == it)
+        {
+            mContentIndex.erase(indexIt);
+            break;
+        }
+    }
+    if (it->device)
+    {
+        mStats.deviceBytes -= it->sizeInBytes;
+    }
+    if (it->host)
+    {
+        mStats.hostBytes -= it->sizeInBytes;
+    }
+    mEntries.erase(it);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief LRU cache of prompt tuning / multimodal embedding tables in device memory, spilling to pinned host memory.
+//! \details Vision-language traffic sends the same image embeddings again and again. The owner of the cache keys each
+//! table with an id, e.g. that of the multimodal item it was computed from or its hashContent; the first put of the id
+//! uploads it, later lookups by id alone skip the host to device copy. Tables are also deduplicated by content, so two
+//! ids with the same table share one device copy.
+//!
+//! Tables evicted from device memory are moved to pinned host memory while it has room, and copied back on their
+//! next use. The cache only drops its own reference on eviction: a table still used by a request stays allocated
+//! until the request releases it. All copies are enqueued on the stream of the buffer manager.
+class PromptEmbeddingCache
+{
+public:
+    using TensorPtr = ITensor::SharedPtr;
+    using IdType = std::uint64_t;
+
+    struct Stats
+    {
+        std::size_t deviceBytes{0};
+        std::size_t hostBytes{0};
+        std::int64_t numHits{0};
+        std::int64_t numMisses{0};
+        std::int64_t numSpills{0};
+        std::int64_t numReloads{0};
+        std::int64_t numDedups{0};
+    };
+
+    //! \param maxDeviceBytes Device memory above which tables are evicted to the host.
+    //! \param maxHostBytes Pinned host memory above which spilled tables are dropped.
+    PromptEmbeddingCache(std::size_t maxDeviceBytes, std::size_t maxHostBytes, BufferManager manager);
+
+    //! \brief Cache the table of a request and return its device copy. If the id already holds the same content,
+    //! nothing is copied. If it holds another table, the id is rebound to the new one.
+    [[nodiscard]] TensorPtr put(IdType id, ITensor const& table);
+
+    //! \brief The device copy of a cached table, reloaded from the host if it was spilled.
+    //! \return std::nullopt if the id is not cached, the client then has to send the table again.
+    [[nodiscard]] std::optional<TensorPtr> get(IdType id);
+
+    //! \brief Drop the table of the id.
+    void erase(IdType id);
+
+    [[nodiscard]] bool contains(IdType id) const
+    {
+        return mIdToEntry.count(id) > 0;
+    }
+
+    [[nodiscard]] Stats const& getStats() const noexcept
+    {
+        return mStats;
+    }
+
+    //! \brief Hash of the bytes of a host accessible table.
+    [[nodiscard]] static std::size_t hashContent(ITensor const& table);
+
+private:
+    struct Entry
+    {
+        std::size_t contentHash;
+        std::size_t sizeInBytes;
+        //! Set while resident in device memory
+        TensorPtr device;
+        //! Set once the table was spilled to pinned host memory, kept when it is reloaded so that it can be spilled
+        //! again without a copy
+        TensorPtr host;
+        //! Number of ids bound to the entry
+        SizeType32 numIds{0};
+    };
+
+    // Least recently used first
+    using EntryList = std::list<Entry>;
+
+    [[nodiscard]] TensorPtr const& makeResident(EntryList::iterator it);
+    void bind(IdType id, EntryList::iterator it);
+    void unbind(IdType id);
+    //! Spill least recently used tables, except keep, until sizeInBytes more fit in device memory
+    void reserveDevice(std::size_t sizeInBytes, EntryList::const_iterator keep);
+    //! Drop least recently used host copies, except that of keep, until sizeInBytes more fit in host memory
+    void reserveHost(std::size_t sizeInBytes, EntryList::const_iterator keep);
+    void spill(EntryList::iterator it, EntryList::const_iterator keep);
+    void dropHostCopy(EntryList::iterator it);
+    void dropEntry(EntryList::iterator it);
+
+    std::size_t mMaxDeviceBytes;
+    std::size_t mMaxHostBytes;
+    BufferManager mManager;
+    EntryList mEntries;
+    std::unordered_map<IdType, EntryList::iterator> mIdToEntry;
+    std::unordered_multimap<std::size_t, EntryList::iterator> mContentIndex;
+    Stats mStats;
+};
+
+} // namespace tensorrt_llm::runtime
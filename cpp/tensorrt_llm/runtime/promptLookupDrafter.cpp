@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/promptLookupDrafter.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+PromptLookupDrafter::PromptLookupDrafter(SizeType32 maxNgramSize, SizeType32 maxDraftLen, SizeType32 minNgramSize)
+    : mMaxNgramSize{maxNgramSize}
+    , mMinNgramSize{minNgramSize}
+    , mMaxDraftLen{maxDraftLen}
+    , mIndex(std::max(maxNgramSize - minNgramSize + 1, 0))
+{
+    TLLM_CHECK_WITH_INFO(0 < minNgramSize && minNgramSize <= maxNgramSize,
+        "Invalid n-gram sizes: min (%d) must be positive and not larger than max (%d)", minNgramSize, maxNgramSize);
+    TLLM_CHECK_WITH_INFO(maxDraftLen > 0, "maxDraftLen (%d) must be positive", maxDraftLen);
+}
+
+void PromptLookupDrafter::setup(std::vector<TokenIdType> const& prompt)
+{
+    mSequence.clear();
+    for (auto& index : mIndex)
+    {
+        index.clear();
+        index.reserve(prompt.size());
+    }
+    append(prompt.data(), static_cast<SizeType32>(prompt.size()));
+}
+
+void PromptLookupDrafter::append(TokenIdType const* tokens, SizeType32 numTokens)
+{
+    mSequence.reserve(mSequence.size() + numTokens);
+    for (SizeType32 ti = 0; ti < numTokens; ++ti)
+    {
+        mSequence.push_back(tokens[ti]);
+        indexPosition(static_cast<SizeType32>(mSequence.size()) - 1);
+    }
+}
+
+PromptLookupDrafter::NgramKey PromptLookupDrafter::getKey(SizeType32 begin, SizeType32 ngramSize) const
+{
+    // FNV-1a over the token ids, collisions are resolved by comparing the tokens
+    NgramKey key{14695981039346656037ULL};
+    for (SizeType32 ti = begin; ti < begin + ngramSize; ++ti)
+    {
+        key = (key ^ static_cast<std::uint32_t>(mSequence[ti])) * 1099511628211ULL;
+    }
+    return key;
+}
+
+bool PromptLookupDrafter::matches(SizeType32 lhsBegin, SizeType32 rhsBegin, SizeType32 ngramSize) const
+{
+    auto const lhs = mSequence.begin() + lhsBegin;
+    return std::equal(lhs, lhs + ngramSize, mSequence.begin() + rhsBegin);
+}
+
+void PromptLookupDrafter::indexPosition(SizeType32 pos)
+{
+    for (SizeType32 ngramSize = mMinNgramSize; ngramSize <= mMaxNgramSize && ngramSize <= pos; ++ngramSize)
+    {
+        auto const begin = pos - ngramSize;
+        mIndex[ngramSize - mMinNgramSize][getKey(begin, ngramSize)] = begin;
+    }
+}
+
+std::vector<TokenIdType> PromptLookupDrafter::draft() const
+{
+    auto const seqLen = static_cast<SizeType32>(mSequence.size());
+    for (auto ngramSize = std::min(mMaxNgramSize, seqLen - 1); ngramSize >= mMinNgramSize; --ngramSize)
+    {
+        auto const suffixBegin = seqLen - ngramSize;
+        auto const& index = mIndex[ngramSize - mMinNgramSize];
+        auto const it = index.find(getKey(suffixBegin, ngramSize));
+        if (it == index.end() || !matches(it->second, suffixBegin, ngramSize))
+        {
+            continue;
+        }
+        auto const draftBegin = mSequence.begin() + it->second + ngramSize;
+        auto const draftLen = std::min(mMaxDraftLen, static_cast<SizeType32>(mSequence.end() - draftBegin));
+        return {draftBegin, draftBegin + draftLen};
+    }
+    return {};
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Proposes draft tokens for SpeculativeDecodingMode::PromptLookup.
+//! \details The drafter keeps the tokens of one request, prompt followed by the accepted output, and an index from
+//! each n-gram to its most recent earlier occurrence. A draft is the continuation of the latest occurrence of the
+//! longest suffix of the sequence that was seen before. The index is built once from the prompt at context time and
+//! updated incrementally with the accepted tokens of each step, so drafting costs a few hash lookups per step. The
+//! draft is verified like external draft tokens, by the acceptance kernels in the batched decoder.
+class PromptLookupDrafter
+{
+public:
+    //! \param maxNgramSize Longest suffix which is matched, tried first.
+    //! \param maxDraftLen Maximum number of draft tokens per step.
+    //! \param minNgramSize Shortest suffix which is matched.
+    PromptLookupDrafter(SizeType32 maxNgramSize, SizeType32 maxDraftLen, SizeType32 minNgramSize = 1);
+
+    //! \brief Reset the drafter and index the prompt of a new request.
+    void setup(std::vector<TokenIdType> const& prompt);
+
+    //! \brief Append tokens accepted in a generation step.
+    void append(TokenIdType const* tokens, SizeType32 numTokens);
+
+    void append(std::vector<TokenIdType> const& tokens)
+    {
+        append(tokens.data(), static_cast<SizeType32>(tokens.size()));
+    }
+
+    //! @returns draft tokens for the next step, empty if no suffix of the sequence occurred before
+    [[nodiscard]] std::vector<TokenIdType> draft() const;
+
+    [[nodiscard]] std::vector<TokenIdType> const& getSequence() const noexcept
+    {
+        return mSequence;
+    }
+
+    [[nodiscard]] SizeType32 getMaxDraftLen() const noexcept
+    {
+        return mMaxDraftLen;
+    }
+
+private:
+    using NgramKey = std::uint64_t;
+
+    [[nodiscard]] NgramKey getKey(SizeType32 begin, SizeType32 ngramSize) const;
+
+    [[nodiscard]] bool matches(SizeType32 lhsBegin, SizeType32 rhsBegin, SizeType32 ngramSize) const;
+
+    //! \brief Index the n-grams ending right before position pos, i.e. the ones that now have a continuation.
+    void indexPosition(SizeType32 pos);
+
+    SizeType32 mMaxNgramSize;
+    SizeType32 mMinNgramSize;
+    SizeType32 mMaxDraftLen;
+    std::vector<TokenIdType> mSequence;
+    //! Per n-gram size, start position of the most recent occurrence that has a continuation
+    std::vector<std::unordered_map<NgramKey, SizeType32>> mIndex;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/rdmaKvTransport.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+
+#include <algorithm>
+#include <numeric>
+#include <optional>
+
+#if ENABLE_UCX
+#include <ucxx/api.h>
+#endif // ENABLE_UCX
+
+namespace tensorrt_llm::runtime
+{
+
+KvTransferPlanner::KvTransferPlanner(Config const& config)
+    : mConfig{config}
+{
+    TLLM_CHECK_WITH_INFO(mConfig.maxSegmentBytes > 0, "The segments must hold at least one byte");
+    TLLM_CHECK_WITH_INFO(
+        mConfig.maxSegmentsPerBatch > 0, "Invalid number of segments per batch %d", mConfig.maxSegmentsPerBatch);
+}
+
+std::vector<KvTransferPlanner::Batch> KvTransferPlanner::plan(
+    std::vector<SizeType32> const& srcBlocks, std::vector<SizeType32> const& dstBlocks, std::size_t blockBytes) const
+{
+    TLLM_CHECK_WITH_INFO(srcBlocks.size() == dstBlocks.size(), "Got %lu source blocks for %lu destination blocks",
+        srcBlocks.size(), dstBlocks.size());
+    TLLM_CHECK_WITH_INFO(blockBytes <= mConfig.maxSegmentBytes, "Blocks of %lu bytes exceed the segments of %lu bytes",
+        blockBytes, mConfig.maxSegmentBytes);
+
+    // Transfer in the order of the source blocks, so that runs of blocks allocated together coalesce
+    std::vector<std::size_t> order(srcBlocks.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&srcBlocks](auto lhs, auto rhs) { return srcBlocks[lhs] < srcBlocks[rhs]; });
+
+    std::vector<Batch> batches;
+    std::optional<std::size_t> prev;
+    for (auto const i : order)
+    {
+        auto const src = static_cast<std::size_t>(srcBlocks[i]);
+        auto const dst = static_cast<std::size_t>(dstBlocks[i]);
+        auto* segment = batches.empty() ? nullptr : &batches.back().back();
+        auto const extends = prev && srcBlocks[*prev] + 1 == srcBlocks[i] && dstBlocks[*prev] + 1 == dstBlocks[i]
+            && segment->size + blockBytes <= mConfig.maxSegmentBytes;
+        prev = i;
+        if (extends)
+        {
+            segment->size += blockBytes;
+            continue;
+        }
+        if (batches.empty() || static_cast<SizeType32>(batches.back().size()) == mConfig.maxSegmentsPerBatch)
+        {
+            batches.emplace_back();
+        }
+        batches.back().push_back(KvTransferSegment{src * blockBytes, dst * blockBytes, blockBytes});
+    }
+    return batches;
+}
+
+class UcxKvTransport::Impl
+{
+public:
+#if ENABLE_UCX
+    struct RemotePool
+    {
+        SizeType32 peer;
+        std::shared_ptr<ucxx::RemoteKey> key;
+    };
+
+    Impl()
+        : context{ucxx::createContext({}, UCP_FEATURE_RMA)}
+        , worker{context->createWorker()}
+    {
+    }
+
+    void waitAll(std::vector<std::shared_ptr<ucxx::Request>> const& requests) const
+    {
+        auto const isCompleted = [](auto const& request) { return request->isCompleted(); };
+        while (!std::all_of(requests.begin(), requests.end(), isCompleted))
+        {
+            worker->progress();
+        }
+        for (auto const& request : requests)
+        {
+            request->checkError();
+        }
+    }
+
+    std::shared_ptr<ucxx::Context> context;
+    std::shared_ptr<ucxx::Worker> worker;
+    std::vector<std::shared_ptr<ucxx::Endpoint>> endpoints;
+    // Registrations of the local pools, by address
+    std::vector<std::pair<void const*, std::shared_ptr<ucxx::MemoryHandle>>> memoryHandles;
+    std::vector<RemotePool> remotePools;
+#endif // ENABLE_UCX
+};
+
+UcxKvTransport::UcxKvTransport(KvTransferPlanner::Config const& config)
+    : mPlanner{config}
+{
+#if ENABLE_UCX
+    mImpl = std::make_unique<Impl>();
+#else
+    TLLM_THROW("UCX support is disabled.");
+#endif // ENABLE_UCX
+}
+
+UcxKvTransport::~UcxKvTransport() = default;
+
+std::string UcxKvTransport::getWorkerAddress() const
+{
+#if ENABLE_UCX
+    return mImpl->worker->getAddress()->getString();
+#else
+    TLLM_THROW("UCX support is disabled.");
+#endif // ENABLE_UCX
+}
+
+SizeType32 UcxKvTransport::connect(std::string const& workerAddress)
+{
+#if ENABLE_UCX
+    auto address = ucxx::createAddressFromString(workerAddress);
+    mImpl->endpoints.push_back(mImpl->worker->createEndpointFromWorkerAddress(address));
+    return static_cast<SizeType32>(mImpl->endpoints.size()) - 1;
+#else
+    TLLM_THROW("UCX support is disabled.");
+#endif // ENABLE_UCX
+}
+
+std::string UcxKvTransport::registerPool(ITensor& pool)
+{
+#if ENABLE_UCX
+    auto const memoryType = pool.getMemoryType() == MemoryType::kGPU ? UCS_MEMORY_TYPE_CUDA : UCS_MEMORY_TYPE_HOST;
+    auto handle = mImpl->context->createMemoryHandle(pool.getSizeInBytes(), pool.data(), memoryType);
+    auto descriptor = handle->createRemoteKey()->serialize();
+    mImpl->memoryHandles.emplace_back(pool.data(), std::move(handle));
+    TLLM_LOG_DEBUG("Registered a KV pool of %lu bytes for RDMA", pool.getSizeInBytes());
+    return descriptor;
+#else
+    TLLM_THROW("UCX support is disabled.");
+#endif // ENABLE_UCX
+}
+
+SizeType32 UcxKvTransport::importPool(SizeType32 peer, std::string const& descriptor)
+{
+#if ENABLE_UCX
+    auto const& endpoint = mImpl->endpoints.at(peer);
+    mImpl->remotePools.push_back(Impl::RemotePool{peer, ucxx::createRemoteKeyFromSerialized(endpoint, descriptor)});
+    return static_cast<SizeType32>(mImpl->remotePools.size()) - 1;
+#else
+    TLLM_THROW("UCX support is disabled.");
+#endif // ENABLE_UCX
+}
+
+void UcxKvTransport::write(ITensor const& localPool, std::vector<SizeType32> const& localBlocks,
+    SizeType32 remotePool, std::vector<SizeType32> const& remoteBlocks)
+{
+    transfer(localPool, localBlocks, remotePool, remoteBlocks, true);
+}
+
+void UcxKvTransport::read(ITensor& localPool, std::vector<SizeType32> const& localBlocks, SizeType32 remotePool,
+    std::vector<SizeType32> const& remoteBlocks)
+{
+    transfer(localPool, localBlocks, remotePool, remoteBlocks, false);
+}
+
+void UcxKvTransport::transfer(ITensor const& localPool, std::vector<SizeType32> const& localBlocks,
+    SizeType32 remotePool, std::vector<SizeType32> const& remoteBlocks, bool isWrite)
+{
+    TLLM_NVTX_SCOPED_RANGE(kCOMM, transfer);
+#if ENABLE_UCX
+    auto const registered = std::any_of(mImpl->memoryHandles.begin(), mImpl->memoryHandles.end(),
+        [&localPool](auto const& handle) { return handle.first == localPool.data(); });
+    TLLM_CHECK_WITH_INFO(registered, "The local KV pool is not registered for RDMA");
+    auto const& remote = mImpl->remotePools.at(remotePool);
+    auto const& endpoint = mImpl->endpoints.at(remote.peer);
+    auto const blockBytes = localPool.getSizeInBytes() / localPool.getShape().d[0];
+    auto* localBase = static_cast<std::uint8_t*>(const_cast<void*>(localPool.data()));
+
+    auto const batches = isWrite ? mPlanner.plan(localBlocks, remoteBlocks, blockBytes)
+                                 : mPlanner.plan(remoteBlocks, localBlocks, blockBytes);
+    std::vector<std::shared_ptr<ucxx::Request>> requests;
+    for (auto const& batch : batches)
+    {
+        requests.clear();
+        for (auto const& segment : batch)
+        {
+            auto const localOffset = isWrite ? segment.srcOffset : segment.dstOffset;
+            auto const remoteOffset = isWrite ? segment.dstOffset : segment.srcOffset;
+            TLLM_CHECK_WITH_INFO(localOffset + segment.size <= localPool.getSizeInBytes()
+                    && remoteOffset + segment.size <= remote.key->getSize(),
+                "Blocks out of the bounds of the KV pools");
+            auto* local = localBase + localOffset;
+            requests.push_back(isWrite ? endpoint->memPut(local, segment.size, remote.key, remoteOffset)
+                                       : endpoint->memGet(local, segment.size, remote.key, remoteOffset));
+        }
+        mImpl->waitAll(requests);
+    }
+#else
+    TLLM_THROW("UCX support is disabled.");
+#endif // ENABLE_UCX
+}
+
+} // namespace tensorrt_llm::runtime
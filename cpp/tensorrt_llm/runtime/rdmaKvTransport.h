@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief A contiguous range of a KV cache transfer, in bytes from the start of the source and destination pools.
+struct KvTransferSegment
+{
+    std::size_t srcOffset;
+    std::size_t dstOffset;
+    std::size_t size;
+};
+
+//! \brief Turns the block lists of a KV cache transfer into few large RDMA work requests.
+//! \details Blocks are contiguous in the primary pools, so runs of blocks that are consecutive in both pools are
+//! transferred as one segment. The segments are posted in batches, and every batch is waited for before the next one
+//! is posted, which bounds the work requests in flight on the connection.
+class KvTransferPlanner
+{
+public:
+    struct Config
+    {
+        //! Bytes of a segment at most, runs of blocks are split above
+        std::size_t maxSegmentBytes{std::size_t{1} << 30};
+        //! Segments posted before waiting for their completion
+        SizeType32 maxSegmentsPerBatch{64};
+    };
+
+    using Batch = std::vector<KvTransferSegment>;
+
+    explicit KvTransferPlanner(Config const& config);
+
+    KvTransferPlanner()
+        : KvTransferPlanner(Config{})
+    {
+    }
+
+    //! \param srcBlocks Blocks of the source pool, the i-th one is transferred to the i-th of dstBlocks
+    //! \param blockBytes Bytes of a block in both pools, all layers with K and V
+    [[nodiscard]] std::vector<Batch> plan(std::vector<SizeType32> const& srcBlocks,
+        std::vector<SizeType32> const& dstBlocks, std::size_t blockBytes) const;
+
+private:
+    Config mConfig;
+};
+
+//! \brief GPUDirect RDMA transport of KV cache blocks between the primary pools of two executors over UCX.
+//! \details Every pool is registered once, and the descriptor of the registration is handed to the peer with the
+//! connection state, so blocks are read or written between the GPU memories without staging them through host memory
+//! or sockets. Requires a build with ENABLE_UCX and a UCX with CUDA support, not thread safe.
+class UcxKvTransport
+{
+public:
+    //! \param config The batching of the transfers
+    explicit UcxKvTransport(KvTransferPlanner::Config const& config = KvTransferPlanner::Config{});
+
+    ~UcxKvTransport();
+
+    UcxKvTransport(UcxKvTransport const&) = delete;
+    UcxKvTransport& operator=(UcxKvTransport const&) = delete;
+
+    //! \brief The address of the worker, for the peer to connect with.
+    [[nodiscard]] std::string getWorkerAddress() const;
+
+    //! \brief Connect to the worker of a peer.
+    //! \return The id of the peer
+    SizeType32 connect(std::string const& workerAddress);
+
+    //! \brief Register a primary pool for RDMA, the pool must outlive the transport.
+    //! \return The descriptor of the registration, to send to the peers that read or write the pool
+    std::string registerPool(ITensor& pool);
+
+    //! \brief Make a pool the peer registered accessible.
+    //! \param descriptor What registerPool returned on the peer
+    //! \return The id of the remote pool
+    SizeType32 importPool(SizeType32 peer, std::string const& descriptor);
+
+    //! \brief Write blocks of a registered local pool into a remote pool and wait until they arrived.
+    //! \param remoteBlocks Blocks of the remote pool, the i-th of localBlocks is written to the i-th one
+    void write(ITensor const& localPool, std::vector<SizeType32> const& localBlocks, SizeType32 remotePool,
+        std::vector<SizeType32> const& remoteBlocks);
+
+    //! \brief Read blocks of a remote pool into a registered local pool and wait until they arrived.
+    //! \param remoteBlocks Blocks of the remote pool, the i-th one is read into the i-th of localBlocks
+    void read(ITensor& localPool, std::vector<SizeType32> const& localBlocks, SizeType32 remotePool,
+        std::vector<SizeType32> const& remoteBlocks);
+
+private:
+    class Impl;
+
+    void transfer(ITensor const& localPool, std::vector<SizeType32> const& localBlocks, SizeType32 remotePool,
+        std::vector<SizeType32> const& remoteBlocks, bool isWrite);
+
+    KvTransferPlanner mPlanner;
+    std::unique_ptr<Impl> mImpl;
+};
+
+} // namespace tensorrt_llm::runtime
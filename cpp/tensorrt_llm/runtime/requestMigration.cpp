@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/requestMigration.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <utility>
+
+namespace tensorrt_llm::runtime
+{
+
+RequestMigration::RequestMigration(executor::MigratedRequest migrated)
+    : mMigrated{std::move(migrated)}
+    , mPromptLen{static_cast<SizeType32>(mMigrated.request.getInputTokenIds().size())}
+{
+    auto const& request = mMigrated.request;
+    auto const numGenerated = static_cast<SizeType32>(mMigrated.generatedTokens.size());
+    TLLM_CHECK_WITH_INFO(request.getSamplingConfig().getBeamWidth() == 1,
+        "Only requests with one beam can be migrated, got %d beams", request.getSamplingConfig().getBeamWidth());
+    TLLM_CHECK_WITH_INFO(numGenerated > 0, "A migrated request must have generated tokens");
+    TLLM_CHECK_WITH_INFO(numGenerated < request.getMaxTokens(),
+        "The migrated request generated %d of %d tokens, there is nothing left to generate", numGenerated,
+        request.getMaxTokens());
+    TLLM_CHECK_WITH_INFO(!mMigrated.logProbs || static_cast<SizeType32>(mMigrated.logProbs->size()) == numGenerated,
+        "Got %lu log probabilities for %d generated tokens", mMigrated.logProbs->size(), numGenerated);
+}
+
+executor::VecTokens RequestMigration::getInputTokenIds() const
+{
+    auto tokens = mMigrated.request.getInputTokenIds();
+    tokens.insert(tokens.end(), mMigrated.generatedTokens.begin(), mMigrated.generatedTokens.end());
+    return tokens;
+}
+
+void RequestMigration::stitch(executor::Result& result) const
+{
+    auto const& request = mMigrated.request;
+    if (result.cumLogProbs && mMigrated.cumLogProb)
+    {
+        for (auto& cumLogProb : *result.cumLogProbs)
+        {
+            cumLogProb += *mMigrated.cumLogProb;
+        }
+    }
+    if (request.getStreaming() && !request.getReturnAllGeneratedTokens())
+    {
+        return;
+    }
+
+    // Streamed results never hold the prompt
+    auto const withPrompt = !request.getStreaming() && !request.getOutputConfig().excludeInputFromOutput;
+    executor::VecTokens prefix;
+    if (withPrompt)
+    {
+        prefix = request.getInputTokenIds();
+    }
+    prefix.insert(prefix.end(), mMigrated.generatedTokens.begin(), mMigrated.generatedTokens.end());
+    for (auto& tokens : result.outputTokenIds)
+    {
+        tokens.insert(tokens.begin(), prefix.begin(), prefix.end());
+    }
+    if (result.logProbs && mMigrated.logProbs)
+    {
+        for (auto& logProbs : *result.logProbs)
+        {
+            logProbs.insert(logProbs.begin(), mMigrated.logProbs->begin(), mMigrated.logProbs->end());
+        }
+    }
+}
+
+} // namespace tensorrt_llm::runtime
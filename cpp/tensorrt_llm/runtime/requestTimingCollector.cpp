@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/requestTimingCollector.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+void RequestTimingCollector::recordArrival(IdType requestId, TimePoint now)
+{
+    Timeline timeline{now, {}};
+    timeline.stats.arrivalTimeUs
+        = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+    std::lock_guard<std::mutex> lock{mMutex};
+    mTimelines.insert_or_assign(requestId, std::move(timeline));
+}
+
+void RequestTimingCollector::recordRequestStats(executor::RequestStatsPerIteration const& stats, TimePoint now)
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    for (auto const& requestStats : stats.requestStats)
+    {
+        auto it = mTimelines.find(requestStats.id);
+        if (it == mTimelines.end())
+        {
+            continue;
+        }
+        auto& timeline = it->second;
+        auto& timing = timeline.stats;
+        auto const nowMS = getMS(timeline, now);
+
+        if (requestStats.scheduled && !timing.firstScheduledMS)
+        {
+            timing.firstScheduledMS = nowMS;
+        }
+        if (requestStats.paused)
+        {
+            if (!timeline.pauseStart)
+            {
+                timeline.pauseStart = now;
+                ++timing.numPauses;
+            }
+        }
+        else if (timeline.pauseStart && requestStats.scheduled)
+        {
+            timing.pausedMS += std::chrono::duration<double, std::milli>(now - *timeline.pauseStart).count();
+            timeline.pauseStart.reset();
+        }
+
+        bool const contextDone = requestStats.stage == executor::RequestStage::kGENERATION_IN_PROGRESS
+            || requestStats.stage == executor::RequestStage::kGENERATION_COMPLETE;
+        if (requestStats.contextPrefillPosition > timeline.contextPrefillPosition)
+        {
+            timing.contextChunkEndMS.push_back(nowMS);
+            timeline.contextPrefillPosition = requestStats.contextPrefillPosition;
+        }
+        else if (contextDone && timing.contextChunkEndMS.empty())
+        {
+            // Without chunked context, the prefill position need not be reported
+            timing.contextChunkEndMS.push_back(nowMS);
+        }
+    }
+}
+
+void RequestTimingCollector::recordResponses(std::vector<executor::Response> const& responses, TimePoint now)
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    for (auto const& response : responses)
+    {
+        auto it = mTimelines.find(response.getRequestId());
+        if (it == mTimelines.end() || response.hasError())
+        {
+            continue;
+        }
+        auto const& beams = response.getResult().outputTokenIds;
+        if (std::all_of(beams.begin(), beams.end(), [](auto const& beam) { return beam.empty(); }))
+        {
+            continue;
+        }
+        auto& timing = it->second.stats;
+        auto const nowMS = getMS(it->second, now);
+        if (!timing.firstTokenMS)
+        {
+            timing.firstTokenMS = nowMS;
+        }
+        timing.lastTokenMS = nowMS;
+    }
+}
+
+std::optional<executor::RequestTimingStats> RequestTimingCollector::getTimingStats(IdType requestId) const
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    auto it = mTimelines.find(requestId);
+    if (it == mTimelines.end())
+    {
+        return std::nullopt;
+    }
+    return it->second.stats;
+}
+
+std::optional<executor::RequestTimingStats> RequestTimingCollector::take(IdType requestId)
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    auto it = mTimelines.find(requestId);
+    if (it == mTimelines.end())
+    {
+        return std::nullopt;
+    }
+    auto stats = std::move(it->second.stats);
+    mTimelines.erase(it);
+    return stats;
+}
+
+std::size_t RequestTimingCollector::getNumRequests() const
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    return mTimelines.size();
+}
+
+} // namespace tensorrt_llm::runtime
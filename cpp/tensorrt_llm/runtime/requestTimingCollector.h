@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/executor/types.h"
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Records the timeline of requests, see executor::RequestTimingStats, from what the executor reports.
+//! \details Feed it the enqueue time of each request, the request stats of Executor::getLatestRequestStats and the
+//! responses of Executor::awaitResponses, each with the time they were observed. The request stats give the first
+//! schedule, the end of each context chunk and the pauses, so their resolution is the interval at which they are
+//! polled. The responses give the first and last token.
+class RequestTimingCollector
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using IdType = executor::IdType;
+
+    //! \brief Start the timeline of a request, e.g. right after Executor::enqueueRequest.
+    void recordArrival(IdType requestId, TimePoint now);
+
+    //! \brief Update the timelines of the requests in stats. Requests without an arrival are ignored.
+    void recordRequestStats(executor::RequestStatsPerIteration const& stats, TimePoint now);
+
+    //! \brief Record the tokens of responses. Responses of requests without an arrival are ignored.
+    void recordResponses(std::vector<executor::Response> const& responses, TimePoint now);
+
+    //! \brief The timeline of a request so far. Not set if its arrival was not recorded.
+    [[nodiscard]] std::optional<executor::RequestTimingStats> getTimingStats(IdType requestId) const;
+
+    //! \brief Take the timeline of a request and stop tracking it, e.g. after its final response.
+    [[nodiscard]] std::optional<executor::RequestTimingStats> take(IdType requestId);
+
+    [[nodiscard]] std::size_t getNumRequests() const;
+
+private:
+    struct Timeline
+    {
+        TimePoint arrival;
+        executor::RequestTimingStats stats;
+        executor::SizeType32 contextPrefillPosition{0};
+        std::optional<TimePoint> pauseStart;
+    };
+
+    [[nodiscard]] static double getMS(Timeline const& timeline, TimePoint now)
+    {
+        return std::chrono::duration<double, std::milli>(now - timeline.arrival).count();
+    }
+
+    mutable std::mutex mMutex;
+    std::unordered_map<IdType, Timeline> mTimelines;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/responseCoalescer.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace tle = tensorrt_llm::executor;
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+template <typename T>
+using PerBeam = std::optional<std::vector<std::vector<T>>>;
+
+template <typename T>
+void appendBeam(PerBeam<T>& held, PerBeam<T> const& next)
+{
+    if (held && next && held->size() == 1 && next->size() == 1)
+    {
+        held->front().insert(held->front().end(), next->front().begin(), next->front().end());
+    }
+    else
+    {
+        held = next;
+    }
+}
+
+} // namespace
+
+ResponseCoalescer::ResponseCoalescer(std::optional<Config> defaultConfig)
+    : mDefaultConfig{std::move(defaultConfig)}
+{
+}
+
+void ResponseCoalescer::setRequestConfig(tle::IdType requestId, Config config)
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    mRequestConfigs.insert_or_assign(requestId, std::move(config));
+}
+
+ResponseCoalescer::Config const* ResponseCoalescer::getConfig(tle::IdType requestId) const
+{
+    auto const it = mRequestConfigs.find(requestId);
+    if (it != mRequestConfigs.end())
+    {
+        return &it->second;
+    }
+    return mDefaultConfig ? &*mDefaultConfig : nullptr;
+}
+
+std::vector<tle::Response> ResponseCoalescer::push(std::vector<tle::Response> const& responses, Clock::time_point now)
+{
+    std::vector<tle::Response> out;
+    out.reserve(responses.size());
+    std::lock_guard<std::mutex> const lock(mMutex);
+    for (auto const& response : responses)
+    {
+        auto const requestId = response.getRequestId();
+        if (response.hasError())
+        {
+            // The request is over, what was held goes out ahead of the error
+            flushRequest(requestId, out);
+            out.push_back(response);
+            mRequestConfigs.erase(requestId);
+            continue;
+        }
+
+        auto const& result = response.getResult();
+        auto const* config = getConfig(requestId);
+        SequenceKey const key{requestId, result.sequenceIndex};
+        auto it = mHeld.find(key);
+        if (config == nullptr && it == mHeld.end())
+        {
+            out.push_back(response);
+            continue;
+        }
+
+        if (it == mHeld.end())
+        {
+            std::optional<Clock::time_point> deadline;
+            if (config->getMaxDelay())
+            {
+                deadline = now + *config->getMaxDelay();
+            }
+            it = mHeld.emplace(key, Held{result, 1, now, deadline}).first;
+        }
+        else
+        {
+            merge(it->second.result, result);
+            ++it->second.numResponses;
+        }
+
+        auto const& held = it->second;
+        bool const carriesPayload = result.contextLogits || result.generationLogits || result.encoderOutput
+            || result.contextPhaseParams;
+        if (!result.isFinal && !result.isSequenceFinal && !carriesPayload
+            && (config != nullptr && !mustFlush(*config, held, now)))
+        {
+            continue;
+        }
+
+        auto merged = std::move(it->second.result);
+        mHeld.erase(it);
+        if (result.isFinal)
+        {
+            // Sequences of the request that are still held end with it
+            flushRequest(requestId, out);
+            mRequestConfigs.erase(requestId);
+        }
+        out.emplace_back(requestId, std::move(merged));
+    }
+    return out;
+}
+
+std::vector<tle::Response> ResponseCoalescer::flushExpired(Clock::time_point now)
+{
+    std::vector<tle::Response> out;
+    std::lock_guard<std::mutex> const lock(mMutex);
+    for (auto it = mHeld.begin(); it != mHeld.end();)
+    {
+        if (it->second.deadline && *it->second.deadline <= now)
+        {
+            out.emplace_back(it->first.first, std::move(it->second.result));
+            it = mHeld.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    return out;
+}
+
+std::optional<ResponseCoalescer::Clock::time_point> ResponseCoalescer::getNextDeadline() const
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    std::optional<Clock::time_point> next;
+    for (auto const& [key, held] : mHeld)
+    {
+        if (held.deadline && (!next || *held.deadline < *next))
+        {
+            next = held.deadline;
+        }
+    }
+    return next;
+}
+
+bool ResponseCoalescer::isEnabled() const
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    return mDefaultConfig || !mRequestConfigs.empty() || !mHeld.empty();
+}
+
+SizeType32 ResponseCoalescer::getNumHeld() const
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    return static_cast<SizeType32>(mHeld.size());
+}
+
+void ResponseCoalescer::flushRequest(tle::IdType requestId, std::vector<tle::Response>& out)
+{
+    auto it = mHeld.lower_bound(SequenceKey{requestId, std::numeric_limits<SizeType32>::min()});
+    while (it != mHeld.end() && it->first.first == requestId)
+    {
+        out.emplace_back(requestId, std::move(it->second.result));
+        it = mHeld.erase(it);
+    }
+}
+
+void ResponseCoalescer::merge(tle::Result& held, tle::Result const& next)
+{
+    auto merged = next;
+    if (held.outputTokenIds.size() == 1 && next.outputTokenIds.size() == 1)
+    {
+        auto const& nextTokens = next.outputTokenIds.front();
+        merged.outputTokenIds = std::move(held.outputTokenIds);
+        merged.outputTokenIds.front().insert(merged.outputTokenIds.front().end(), nextTokens.begin(), nextTokens.end());
+        merged.logProbs = std::move(held.logProbs);
+        appendBeam(merged.logProbs, next.logProbs);
+    }
+    held = std::move(merged);
+}
+
+bool ResponseCoalescer::mustFlush(Config const& config, Held const& held, Clock::time_point now)
+{
+    auto const& beams = held.result.outputTokenIds;
+    if (auto const maxTokens = config.getMaxTokens())
+    {
+        auto const numHeld
+            = beams.size() == 1 ? static_cast<SizeType32>(beams.front().size()) : held.numResponses;
+        if (numHeld >= *maxTokens)
+        {
+            return true;
+        }
+    }
+    if (held.deadline && *held.deadline <= now)
+    {
+        return true;
+    }
+    auto const& flushTokens = config.getFlushTokens();
+    return std::any_of(beams.begin(), beams.end(),
+        [&flushTokens](auto const& beam)
+        {
+            return !beam.empty()
+                && std::find(flushTokens.begin(), flushTokens.end(), beam.back()) != flushTokens.end();
+        });
+}
+
+} // namespace tensorrt_llm::runtime
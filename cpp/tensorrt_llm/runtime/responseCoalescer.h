@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Merges the streamed responses of a request according to its ResponseCoalescingConfig.
+//! \details With streaming, the executor delivers one response per request and iteration, so a consumer serving
+//! many streams wakes up, takes the GIL and serializes once per token and stream. The coalescer holds the result of
+//! each sequence and appends the tokens of the following responses to it until the config asks for a delivery: enough
+//! tokens held, the oldest one waited long enough, or a flush token was generated. The last response of a sequence,
+//! errors and results carrying logits, the encoder output or context phase params are never held back.
+//!
+//! Beam search streams the full beams in every response, so their results are replaced instead of appended to and
+//! maxTokens counts responses. All other fields are taken from the latest response.
+class ResponseCoalescer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Config = executor::ResponseCoalescingConfig;
+
+    //! \param defaultConfig The config of the requests without one of their own, std::nullopt to not coalesce them.
+    explicit ResponseCoalescer(std::optional<Config> defaultConfig = std::nullopt);
+
+    //! \brief Use config for the responses of requestId, until its final response has been delivered.
+    void setRequestConfig(executor::IdType requestId, Config config);
+
+    //! \brief Take a batch of responses from the executor.
+    //! \returns The responses to deliver now, in order.
+    [[nodiscard]] std::vector<executor::Response> push(
+        std::vector<executor::Response> const& responses, Clock::time_point now = Clock::now());
+
+    //! \brief The held responses whose maxDelay has elapsed at now.
+    [[nodiscard]] std::vector<executor::Response> flushExpired(Clock::time_point now = Clock::now());
+
+    //! \brief The earliest time flushExpired has something to deliver, std::nullopt if no held response has a delay.
+    [[nodiscard]] std::optional<Clock::time_point> getNextDeadline() const;
+
+    //! \brief Whether any response may be held, false when there is nothing to coalesce.
+    [[nodiscard]] bool isEnabled() const;
+
+    [[nodiscard]] SizeType32 getNumHeld() const;
+
+private:
+    //! \brief A request id and a sequence index.
+    using SequenceKey = std::pair<executor::IdType, SizeType32>;
+
+    struct Held
+    {
+        executor::Result result;
+        //! Responses merged into result
+        SizeType32 numResponses;
+        Clock::time_point since;
+        std::optional<Clock::time_point> deadline;
+    };
+
+    [[nodiscard]] Config const* getConfig(executor::IdType requestId) const;
+
+    //! \brief Move the held responses of requestId to out.
+    void flushRequest(executor::IdType requestId, std::vector<executor::Response>& out);
+
+    static void merge(executor::Result& held, executor::Result const& next);
+
+    [[nodiscard]] static bool mustFlush(Config const& config, Held const& held, Clock::time_point now);
+
+    std::optional<Config> mDefaultConfig;
+
+    mutable std::mutex mMutex;
+    std::unordered_map<executor::IdType, Config> mRequestConfigs;
+    std::map<SequenceKey, Held> mHeld;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/reuseAwareAdmission.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+
+namespace tensorrt_llm::runtime
+{
+
+ReuseAwareAdmission::ReuseAwareAdmission(SizeType32 maxBypasses)
+    : mMaxBypasses{maxBypasses}
+{
+    TLLM_CHECK_WITH_INFO(maxBypasses > 0, "The maximum number of bypasses must be positive");
+}
+
+std::vector<ReuseAwareAdmission::RequestIdType> ReuseAwareAdmission::order(std::vector<Candidate> const& queued) const
+{
+    std::vector<std::size_t> indices(queued.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    // Starving requests first in arrival order, then the others by reuse, arrival order breaking ties
+    std::stable_sort(indices.begin(), indices.end(),
+        [this, &queued](std::size_t lhs, std::size_t rhs)
+        {
+            bool const lhsStarving = getNumBypasses(queued[lhs].requestId) >= mMaxBypasses;
+            bool const rhsStarving = getNumBypasses(queued[rhs].requestId) >= mMaxBypasses;
+            if (lhsStarving || rhsStarving)
+            {
+                return lhsStarving && !rhsStarving;
+            }
+            return queued[lhs].numReusableTokens > queued[rhs].numReusableTokens;
+        });
+
+    std::vector<RequestIdType> order;
+    order.reserve(queued.size());
+    for (auto const index : indices)
+    {
+        order.push_back(queued[index].requestId);
+    }
+    return order;
+}
+
+void ReuseAwareAdmission::update(std::vector<Candidate> const& queued, std::vector<RequestIdType> const& admitted)
+{
+    std::unordered_set<RequestIdType> const admittedIds(admitted.begin(), admitted.end());
+    // Requests before the last admitted one in arrival order were passed over if they are still waiting
+    auto const lastAdmitted = std::find_if(queued.rbegin(), queued.rend(),
+        [&admittedIds](Candidate const& candidate) { return admittedIds.count(candidate.requestId) > 0; });
+    auto const numPassedOver = static_cast<std::size_t>(std::distance(lastAdmitted, queued.rend()));
+
+    std::unordered_map<RequestIdType, SizeType32> numBypasses;
+    for (std::size_t i = 0; i < queued.size(); ++i)
+    {
+        auto const requestId = queued[i].requestId;
+        if (admittedIds.count(requestId) > 0)
+        {
+            continue;
+        }
+        numBypasses[requestId] = getNumBypasses(requestId) + (i < numPassedOver ? 1 : 0);
+    }
+    mNumBypasses = std::move(numBypasses);
+}
+
+SizeType32 ReuseAwareAdmission::getNumBypasses(RequestIdType requestId) const
+{
+    auto const it = mNumBypasses.find(requestId);
+    return it == mNumBypasses.end() ? 0 : it->second;
+}
+
+} // namespace tensorrt_llm::runtime
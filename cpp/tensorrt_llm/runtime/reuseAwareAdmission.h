@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Orders queued requests to admit those with the most KV cache reuse first.
+//! \details With block reuse, a queued request whose prompt prefix is resident in the KV cache only needs the prefill
+//! of the rest. Admitting it while its blocks are resident saves that prefill, waiting lets the blocks of its prefix
+//! be evicted by the requests admitted before it. Queued requests are therefore admitted by descending number of
+//! reusable tokens, which the caller looks up in the block index, e.g. with BlockPrefixTree::findLongestPrefix.
+//!
+//! Every time a request is passed over, i.e. a request that arrived after it is admitted while it keeps waiting, its
+//! bypass count grows. Requests passed over maxBypasses times are admitted first, in arrival order, so that requests
+//! without reuse are delayed by a bounded number of iterations.
+class ReuseAwareAdmission
+{
+public:
+    using RequestIdType = std::uint64_t;
+
+    struct Candidate
+    {
+        RequestIdType requestId;
+        //! Prompt tokens in resident blocks
+        SizeType32 numReusableTokens;
+    };
+
+    explicit ReuseAwareAdmission(SizeType32 maxBypasses = 8);
+
+    //! \brief The order to admit the queued requests in.
+    //! \param queued The queued requests in arrival order.
+    [[nodiscard]] std::vector<RequestIdType> order(std::vector<Candidate> const& queued) const;
+
+    //! \brief Count the bypasses of the iteration and forget the requests that left the queue.
+    //! \param queued The requests queued at the start of the iteration in arrival order, as passed to order.
+    //! \param admitted The requests admitted in the iteration.
+    void update(std::vector<Candidate> const& queued, std::vector<RequestIdType> const& admitted);
+
+    [[nodiscard]] SizeType32 getNumBypasses(RequestIdType requestId) const;
+
+    [[nodiscard]] SizeType32 getMaxBypasses() const noexcept
+    {
+        return mMaxBypasses;
+    }
+
+private:
+    SizeType32 mMaxBypasses;
+    std::unordered_map<RequestIdType, SizeType32> mNumBypasses;
+};
+
+} // namespace tensorrt_llm::runtime
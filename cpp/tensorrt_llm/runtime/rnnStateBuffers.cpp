@@ -369,3 +369,17 @@ void RnnStateBuffers::getRuntimeBuffers(RuntimeBuffers const* runtimeBuffers, Te
     inputBuffers.insert_or_assign("host_context_lengths", runtimeBuffers->contextLengthsHost);
     TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
 }
+
+std::vector<RnnStateBuffers::TensorPtr> RnnStateBuffers::getSequenceStates(SizeType32 batchIdx, SizeType32 step) const
+{
+    // Without paged state the conv states ping-pong between the two buffers, see getRuntimeBuffers.
+    auto const& presentConvState = (slotMappingDevice == nullptr && step % 2) ? convStateAlt : convState;
+    std::vector<TensorPtr> states;
+    states.reserve(2 * rnnState.size());
+    for (std::size_t layer = 0; layer < rnnState.size(); ++layer)
+    {
+        states.push_back(ITensor::slice(rnnState[layer], batchIdx, 1));
+        states.push_back(ITensor::slice(presentConvState[layer], batchIdx, 1));
+    }
+    return states;
+}
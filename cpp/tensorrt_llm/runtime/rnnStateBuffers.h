@@ -74,6 +74,10 @@ public:
         SizeType32 const step, TensorPtr const& inputIds, ModelConfig const& modelConfig,
         WorldConfig const& worldConfig) const;
 
+    //! \brief Views of the SSM and conv states of one sequence in all local layers as written by the given step.
+    //! \details This is the layout of the snapshots of RnnStateCache.
+    [[nodiscard]] std::vector<TensorPtr> getSequenceStates(SizeType32 batchIdx, SizeType32 step) const;
+
 protected:
     void tile(RuntimeBuffers* runtimeBuffers, BufferManager& manager, ModelConfig const& modelConfig,
         WorldConfig const& worldConfig);
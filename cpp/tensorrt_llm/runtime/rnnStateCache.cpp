@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/rnnStateCache.h"
+#include "tensorrt_llm/batch_manager/blockHash.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace kvc = tensorrt_llm::batch_manager::kv_cache_manager;
+
+RnnStateCache::RnnStateCache(SizeType32 tokensPerBlock, std::size_t snapshotSizeInBytes,
+    SizeType32 maxNumDeviceSnapshots, SizeType32 maxNumHostSnapshots, BufferManager const& manager)
+    : mTokensPerBlock{tokensPerBlock}
+    , mSnapshotSize{snapshotSizeInBytes}
+    , mManager{manager}
+{
+    TLLM_CHECK_WITH_INFO(mTokensPerBlock > 0, "The recurrent state cache needs a positive block size");
+    TLLM_CHECK_WITH_INFO(mSnapshotSize > 0, "The recurrent state snapshots must not be empty");
+    TLLM_CHECK_WITH_INFO(maxNumDeviceSnapshots >= 0 && maxNumHostSnapshots >= 0,
+        "The recurrent state cache needs a non-negative number of snapshots");
+
+    auto const makePool = [this](MemoryType memoryType, SizeType32 numSlots, std::vector<SizeType32>& freeSlots)
+    {
+        // Hand out low slots first.
+        for (SizeType32 slot = numSlots - 1; slot >= 0; --slot)
+        {
+            freeSlots.push_back(slot);
+        }
+        IBuffer::SharedPtr pool;
+        if (numSlots > 0)
+        {
+            pool = mManager.allocate(memoryType, numSlots * mSnapshotSize, nvinfer1::DataType::kINT8);
+        }
+        return pool;
+    };
+    mDevicePool = makePool(MemoryType::kGPU, maxNumDeviceSnapshots, mFreeDeviceSlots);
+    mHostPool = makePool(MemoryType::kPINNED, maxNumHostSnapshots, mFreeHostSlots);
+}
+
+std::uint8_t* RnnStateCache::getSlotData(Location location, SizeType32 slot) const
+{
+    auto& pool = location == Location::kDevice ? mDevicePool : mHostPool;
+    return static_cast<std::uint8_t*>(pool->data()) + static_cast<std::size_t>(slot) * mSnapshotSize;
+}
+
+MemoryType RnnStateCache::getMemoryType(Location location) const
+{
+    return location == Location::kDevice ? MemoryType::kGPU : MemoryType::kPINNED;
+}
+
+std::optional<RnnStateCache::Match> RnnStateCache::findLongestPrefix(
+    VecUniqueTokens const& tokens, LoraTaskIdType loraTaskId)
+{
+    auto const numTokens = static_cast<SizeType32>(tokens.size());
+    if (numTokens > 1)
+    {
+        auto const blockHashes = kvc::computeBlockHashes(tokens, mTokensPerBlock, loraTaskId);
+        // Leave the last token to be computed.
+        auto const numUsableBlocks
+            = std::min(static_cast<SizeType32>(blockHashes.size()), (numTokens - 1) / mTokensPerBlock);
+        for (auto blockIdx = numUsableBlocks - 1; blockIdx >= 0; --blockIdx)
+        {
+            auto const it = mIndex.find(blockHashes[blockIdx]);
+            if (it != mIndex.end() && it->second->numTokens == (blockIdx + 1) * mTokensPerBlock)
+            {
+                ++mStats.numHits;
+                return Match{it->second->numTokens, it->second->hash};
+            }
+        }
+    }
+    ++mStats.numMisses;
+    return std::nullopt;
+}
+
+bool RnnStateCache::restore(Match const& match, std::vector<TensorPtr> const& sequenceStates)
+{
+    auto const indexIt = mIndex.find(match.hash);
+    if (indexIt == mIndex.end())
+    {
+        return false;
+    }
+    auto it = indexIt->second;
+    auto const* src = getSlotData(it->location, it->slot);
+    auto const srcType = getMemoryType(it->location);
+    std::size_t offset = 0;
+    for (auto const& state : sequenceStates)
+    {
+        TLLM_CHECK_WITH_INFO(offset + state->getSizeInBytes() <= mSnapshotSize,
+            "Sequence states exceed the recurrent state snapshot size");
+        mManager.copy(src + offset, *state, srcType);
+        offset += state->getSizeInBytes();
+    }
+    TLLM_CHECK_WITH_INFO(offset == mSnapshotSize, "Sequence states don't match the recurrent state snapshot size");
+
+    // Host snapshots are restored in place, only their recency is updated.
+    auto& list = it->location == Location::kDevice ? mDeviceSnapshots : mHostSnapshots;
+    list.splice(list.end(), list, it);
+    mStats.numReusedTokens += it->numTokens;
+    return true;
+}
+
+bool RnnStateCache::store(VecUniqueTokens const& tokens, LoraTaskIdType loraTaskId, SizeType32 numTokens,
+    std::vector<TensorPtr> const& sequenceStates)
+{
+    TLLM_CHECK_WITH_INFO(numTokens <= static_cast<SizeType32>(tokens.size()),
+        "Snapshot after %d tokens of a sequence with %zu tokens", numTokens, tokens.size());
+    if (numTokens == 0 || numTokens % mTokensPerBlock != 0)
+    {
+        return false;
+    }
+    auto const blockHashes = kvc::computeBlockHashes(
+        VecUniqueTokens(tokens.begin(), tokens.begin() + numTokens), mTokensPerBlock, loraTaskId);
+    auto const hash = blockHashes.back();
+    if (auto const indexIt = mIndex.find(hash); indexIt != mIndex.end())
+    {
+        auto it = indexIt->second;
+        auto& list = it->location == Location::kDevice ? mDeviceSnapshots : mHostSnapshots;
+        list.splice(list.end(), list, it);
+        return false;
+    }
+
+    auto const slot = acquireDeviceSlot();
+    if (!slot)
+    {
+        return false;
+    }
+    auto* dst = getSlotData(Location::kDevice, *slot);
+    std::size_t offset = 0;
+    for (auto const& state : sequenceStates)
+    {
+        TLLM_CHECK_WITH_INFO(offset + state->getSizeInBytes() <= mSnapshotSize,
+            "Sequence states exceed the recurrent state snapshot size");
+        mManager.copy(*state, dst + offset, MemoryType::kGPU);
+        offset += state->getSizeInBytes();
+    }
+    TLLM_CHECK_WITH_INFO(offset == mSnapshotSize, "Sequence states don't match the recurrent state snapshot size");
+
+    mDeviceSnapshots.push_back(Snapshot{hash, numTokens, Location::kDevice, *slot});
+    mIndex.emplace(hash, std::prev(mDeviceSnapshots.end()));
+    ++mStats.numDeviceSnapshots;
+    return true;
+}
+
+std::optional<SizeType32> RnnStateCache::acquireDeviceSlot()
+{
+    if (!mFreeDeviceSlots.empty())
+    {
+        auto const slot = mFreeDeviceSlots.back();
+        mFreeDeviceSlots.pop_back();
+        return slot;
+    }
+    if (mDeviceSnapshots.empty())
+    {
+        return std::nullopt;
+    }
+
+    auto victim = mDeviceSnapshots.begin();
+    auto const deviceSlot = victim->slot;
+    if (auto const hostSlot = acquireHostSlot())
+    {
+        // The copy is ordered before any later write to the device slot on the same stream.
+        auto src = IBuffer::slice(mDevicePool, static_cast<std::size_t>(deviceSlot) * mSnapshotSize, mSnapshotSize);
+        auto dst = IBuffer::slice(mHostPool, static_cast<std::size_t>(*hostSlot) * mSnapshotSize, mSnapshotSize);
+        mManager.copy(*src, *dst);
+        victim->location = Location::kHost;
+        victim->slot = *hostSlot;
+        mHostSnapshots.splice(mHostSnapshots.end(), mDeviceSnapshots, victim);
+        --mStats.numDeviceSnapshots;
+        ++mStats.numHostSnapshots;
+        ++mStats.numOffloadedSnapshots;
+    }
+    else
+    {
+        erase(victim);
+    }
+    return deviceSlot;
+}
+
+std::optional<SizeType32> RnnStateCache::acquireHostSlot()
+{
+    if (!mFreeHostSlots.empty())
+    {
+        auto const slot = mFreeHostSlots.back();
+        mFreeHostSlots.pop_back();
+        return slot;
+    }
+    if (mHostSnapshots.empty())
+    {
+        return std::nullopt;
+    }
+    auto const slot = mHostSnapshots.front().slot;
+    erase(mHostSnapshots.begin());
+    return slot;
+}
+
+void RnnStateCache::erase(SnapshotList::iterator it)
+{
+    mIndex.erase(it->hash);
+    if (it->location == Location::kDevice)
+    {
+        --mStats.numDeviceSnapshots;
+        mDeviceSnapshots.erase(it);
+    }
+    else
+    {
+        --mStats.numHostSnapshots;
+        mHostSnapshots.erase(it);
+    }
+    ++mStats.numEvictedSnapshots;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Prefix cache of recurrent (conv and SSM) states for Mamba and hybrid models.
+//! \details Recurrent layers have no per-token KV that could be shared block by block, their whole history is folded
+//! into a fixed size state. Instead, the cache keeps snapshots of the state of a sequence taken after a block aligned
+//! number of tokens, keyed by the chained hash of those blocks, see kv_cache_manager::computeBlockHashes. A request
+//! whose prompt starts with a snapshotted prefix restores the state and only computes the remaining tokens.
+//!
+//! A snapshot is the concatenation of the per sequence state tensors of all local layers, see
+//! RnnStateBuffers::getSequenceStates. Snapshots live in a device pool, least recently used ones are offloaded to a
+//! pinned host pool when the device pool is full and dropped when the host pool is full as well.
+class RnnStateCache
+{
+public:
+    using TensorPtr = ITensor::SharedPtr;
+    using HashType = std::uint64_t;
+
+    struct Match
+    {
+        //! Number of prompt tokens covered by the snapshot
+        SizeType32 numTokens{0};
+        //! Chained hash of the blocks holding these tokens
+        HashType hash{0};
+    };
+
+    struct Stats
+    {
+        SizeType32 numDeviceSnapshots{0};
+        SizeType32 numHostSnapshots{0};
+        std::int64_t numHits{0};
+        std::int64_t numMisses{0};
+        std::int64_t numReusedTokens{0};
+        std::int64_t numOffloadedSnapshots{0};
+        std::int64_t numEvictedSnapshots{0};
+    };
+
+    //! \param tokensPerBlock Granularity of the snapshots, only states after a multiple of it are cached.
+    //! \param snapshotSizeInBytes Size of the states of one sequence over all local layers.
+    //! \param maxNumDeviceSnapshots Number of snapshots kept in device memory.
+    //! \param maxNumHostSnapshots Number of snapshots kept in pinned host memory, 0 disables offloading.
+    RnnStateCache(SizeType32 tokensPerBlock, std::size_t snapshotSizeInBytes, SizeType32 maxNumDeviceSnapshots,
+        SizeType32 maxNumHostSnapshots, BufferManager const& manager);
+
+    //! \brief Find the longest cached prefix of a prompt.
+    //! \details The match always leaves at least one token of the prompt to compute, the request needs the logits of
+    //! its last token.
+    [[nodiscard]] std::optional<Match> findLongestPrefix(VecUniqueTokens const& tokens, LoraTaskIdType loraTaskId);
+
+    //! \brief Copy the snapshot of a match into the states of a sequence.
+    //! \return false if the snapshot was evicted since the lookup.
+    bool restore(Match const& match, std::vector<TensorPtr> const& sequenceStates);
+
+    //! \brief Snapshot the states of a sequence after its first numTokens tokens.
+    //! \details Nothing is stored unless numTokens is a multiple of tokensPerBlock, so context chunks should be block
+    //! aligned to make the state of every chunk boundary reusable.
+    //! \return true if a new snapshot was stored.
+    bool store(VecUniqueTokens const& tokens, LoraTaskIdType loraTaskId, SizeType32 numTokens,
+        std::vector<TensorPtr> const& sequenceStates);
+
+    [[nodiscard]] Stats const& getStats() const noexcept
+    {
+        return mStats;
+    }
+
+    [[nodiscard]] SizeType32 getTokensPerBlock() const noexcept
+    {
+        return mTokensPerBlock;
+    }
+
+    [[nodiscard]] std::size_t getSnapshotSizeInBytes() const noexcept
+    {
+        return mSnapshotSize;
+    }
+
+private:
+    enum class Location
+    {
+        kDevice,
+        kHost
+    };
+
+    struct Snapshot
+    {
+        HashType hash;
+        SizeType32 numTokens;
+        Location location;
+        SizeType32 slot;
+    };
+
+    // Least recently used first
+    using SnapshotList = std::list<Snapshot>;
+
+    [[nodiscard]] std::uint8_t* getSlotData(Location location, SizeType32 slot) const;
+
+    [[nodiscard]] MemoryType getMemoryType(Location location) const;
+
+    //! \brief Get a free device slot, offloading or dropping the least recently used device snapshot if needed.
+    [[nodiscard]] std::optional<SizeType32> acquireDeviceSlot();
+
+    //! \brief Get a free host slot, dropping the least recently used host snapshot if needed.
+    [[nodiscard]] std::optional<SizeType32> acquireHostSlot();
+
+    void erase(SnapshotList::iterator it);
+
+    SizeType32 mTokensPerBlock;
+    std::size_t mSnapshotSize;
+    BufferManager const& mManager;
+
+    IBuffer::SharedPtr mDevicePool;
+    IBuffer::SharedPtr mHostPool;
+    std::vector<SizeType32> mFreeDeviceSlots;
+    std::vector<SizeType32> mFreeHostSlots;
+
+    SnapshotList mDeviceSnapshots;
+    SnapshotList mHostSnapshots;
+    std::unordered_map<HashType, SnapshotList::iterator> mIndex;
+    Stats mStats;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -18,6 +18,7 @@
 
 #include "tensorrt_llm/batch_manager/kvCacheManager.h"
 #include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/memoryCounters.h"
 #include "tensorrt_llm/runtime/runtimeKernels.h"
 #include "tensorrt_llm/runtime/tllmRuntime.h"
 #include "tensorrt_llm/runtime/utils/sessionUtils.h"
@@ -65,6 +66,7 @@ void RuntimeBuffers::create(TllmRuntime const& runtime, ModelConfig const& model
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
     auto const& manager = runtime.getBufferManager();
     auto const& engine = runtime.getEngine();
+    MemoryCounters::TagScope const tagScope{MemoryTag::kIO_BUFFERS};
 
     if (worldConfig.isLastPipelineParallelRank())
     {
@@ -21,6 +21,7 @@
 #include "tensorrt_llm/kernels/speculativeDecoding/kvCacheUpdateKernels.h"
 #include "tensorrt_llm/runtime/runtimeKernels.h"
 
+#include <cfloat>
 #include <cub/cub.cuh>
 #include <cuda_fp16.h>
 #include <cuda_runtime.h>
@@ -181,6 +182,191 @@ void invokeCopyBatch(IBuffer const& srcBuffer, IBuffer& dstBuffer, IBuffer const
         srcDataPtr, dstDataPtr, srcOffsetsPtr, dstOffsetsPtr, sizesPtr, static_cast<int32_t>(dataTypeSize));
 }
 
+namespace
+{
+template <typename T>
+__device__ void batchedFillElements(BatchedFill const& fill, std::size_t tidx, std::size_t stride)
+{
+    auto* dst = static_cast<T*>(fill.dst);
+    auto const* src = static_cast<T const*>(fill.src);
+    auto const value = static_cast<T>(fill.value);
+    for (auto idx = tidx; idx < fill.numElements; idx += stride)
+    {
+        dst[idx] = idx < fill.numSrcElements ? src[idx] : value;
+    }
+}
+
+__global__ void batchedFill(BatchedFill const* fills)
+{
+    auto const fill = fills[blockIdx.y];
+    auto const tidx = static_cast<std::size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    auto const stride = static_cast<std::size_t>(blockDim.x) * gridDim.x;
+    switch (fill.elementSize)
+    {
+    case 1: batchedFillElements<std::uint8_t>(fill, tidx, stride); break;
+    case 2: batchedFillElements<std::uint16_t>(fill, tidx, stride); break;
+    case 4: batchedFillElements<std::uint32_t>(fill, tidx, stride); break;
+    default: break;
+    }
+}
+} // namespace
+
+void invokeBatchedFill(
+    BatchedFill const* fills, std::size_t numFills, std::size_t maxNumElements, CudaStream const& stream)
+{
+    if (numFills == 0)
+    {
+        return;
+    }
+    TLLM_CHECK_WITH_INFO(numFills <= std::numeric_limits<std::uint16_t>::max(), "Too many fills: %zu", numFills);
+    dim3 const blockSize{256};
+    // Most fills are a few elements, a handful of blocks per fill keeps the grid small for them
+    std::size_t const gridx{std::min(tc::ceilDiv(maxNumElements, blockSize.x), std::size_t{32})};
+    dim3 const gridSize{
+        static_cast<std::uint32_t>(std::max(gridx, std::size_t{1})), static_cast<std::uint32_t>(numFills)};
+
+    batchedFill<<<gridSize, blockSize, 0, stream.get()>>>(fills);
+}
+
+namespace
+{
+template <typename VecT>
+__device__ void batchedCopyVectors(BatchedCopy const& copy, std::size_t tidx, std::size_t stride)
+{
+    auto* dst = static_cast<VecT*>(copy.dst);
+    auto const* src = static_cast<VecT const*>(copy.src);
+    auto const numVectors = copy.numBytes / sizeof(VecT);
+    for (auto idx = tidx; idx < numVectors; idx += stride)
+    {
+        dst[idx] = src[idx];
+    }
+}
+
+__global__ void batchedCopy(BatchedCopy const* copies)
+{
+    auto const copy = copies[blockIdx.y];
+    auto const tidx = static_cast<std::size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    auto const stride = static_cast<std::size_t>(blockDim.x) * gridDim.x;
+    // The widest access both pointers and the size are aligned to
+    auto const alignment = reinterpret_cast<std::uintptr_t>(copy.dst) | reinterpret_cast<std::uintptr_t>(copy.src)
+        | static_cast<std::uintptr_t>(copy.numBytes);
+    if (alignment % sizeof(uint4) == 0)
+    {
+        batchedCopyVectors<uint4>(copy, tidx, stride);
+    }
+    else if (alignment % sizeof(std::uint32_t) == 0)
+    {
+        batchedCopyVectors<std::uint32_t>(copy, tidx, stride);
+    }
+    else
+    {
+        batchedCopyVectors<std::uint8_t>(copy, tidx, stride);
+    }
+}
+} // namespace
+
+void invokeBatchedCopy(
+    BatchedCopy const* copies, std::size_t numCopies, std::size_t maxNumBytes, CudaStream const& stream)
+{
+    dim3 const blockSize{256};
+    // Sized for 16-byte accesses, the copies are small and a handful of blocks each is enough
+    std::size_t const gridx{std::min(tc::ceilDiv(maxNumBytes, blockSize.x * sizeof(uint4)), std::size_t{32})};
+    std::size_t const maxCopiesPerLaunch{std::numeric_limits<std::uint16_t>::max()};
+    for (std::size_t first = 0; first < numCopies; first += maxCopiesPerLaunch)
+    {
+        auto const numLaunchCopies = std::min(numCopies - first, maxCopiesPerLaunch);
+        dim3 const gridSize{
+            static_cast<std::uint32_t>(std::max(gridx, std::size_t{1})), static_cast<std::uint32_t>(numLaunchCopies)};
+        batchedCopy<<<gridSize, blockSize, 0, stream.get()>>>(copies + first);
+    }
+}
+
+namespace
+{
+__global__ void writeDecoderStatus(DecoderStatusHeader* slot, std::uint64_t epoch, SizeType32 const* finishedSum,
+    SizeType32 const* sequenceLengths, SizeType32 maxBatchSize, SizeType32 maxBeamWidth)
+{
+    auto* finishedSumOut = reinterpret_cast<SizeType32*>(slot + 1);
+    auto* sequenceLengthsOut = finishedSumOut + maxBatchSize;
+    if (threadIdx.x == 0)
+    {
+        *reinterpret_cast<std::uint64_t volatile*>(&slot->beginEpoch) = epoch;
+    }
+    // A host reading the slot concurrently must see the begin epoch change before any of the data
+    __threadfence_system();
+    __syncthreads();
+    for (auto bi = static_cast<SizeType32>(threadIdx.x); bi < maxBatchSize; bi += static_cast<SizeType32>(blockDim.x))
+    {
+        finishedSumOut[bi] = finishedSum[bi];
+        sequenceLengthsOut[bi] = sequenceLengths[bi * maxBeamWidth];
+    }
+    __threadfence_system();
+    __syncthreads();
+    if (threadIdx.x == 0)
+    {
+        *reinterpret_cast<std::uint64_t volatile*>(&slot->endEpoch) = epoch;
+    }
+}
+} // namespace
+
+void invokeWriteDecoderStatus(DecoderStatusHeader* slot, std::uint64_t epoch, SizeType32 const* finishedSum,
+    SizeType32 const* sequenceLengths, SizeType32 maxBatchSize, SizeType32 maxBeamWidth, CudaStream const& stream)
+{
+    // One block, the epochs bracket the data of all threads
+    writeDecoderStatus<<<1, 256, 0, stream.get()>>>(
+        slot, epoch, finishedSum, sequenceLengths, maxBatchSize, maxBeamWidth);
+}
+
+namespace
+{
+__global__ void writeOutputTokenRing(std::uint64_t* headers, OutputTokenRingEntry* entries, SizeType32 capacity,
+    std::uint32_t const* requestSeqs, TokenIdType const* ids, SizeType32 const* inputLengths,
+    SizeType32 const* sequenceLengths, float const* logProbs, std::uint8_t const* finishReasons,
+    SizeType32 maxBatchSize, SizeType32 maxBeamWidth, SizeType32 maxSeqLen)
+{
+    auto const slot = static_cast<SizeType32>(blockIdx.x * blockDim.x + threadIdx.x);
+    if (slot >= maxBatchSize || requestSeqs[slot] == 0)
+    {
+        return;
+    }
+    auto const requestSeq = requestSeqs[slot];
+    auto const published = *reinterpret_cast<std::uint64_t volatile*>(&headers[slot]);
+    // The header still holds the count of the previous request of the slot until its first token
+    auto const numPublished
+        = static_cast<std::uint32_t>(published >> 32) == requestSeq ? static_cast<SizeType32>(published) : 0;
+    auto const beamOffset = static_cast<std::size_t>(slot) * maxBeamWidth;
+    auto const inputLength = inputLengths[slot];
+    auto const numTokens = sequenceLengths[beamOffset] - inputLength;
+    if (numTokens <= numPublished)
+    {
+        return;
+    }
+    auto* ring = entries + static_cast<std::size_t>(slot) * capacity;
+    for (auto ti = max(numPublished, numTokens - capacity); ti < numTokens; ++ti)
+    {
+        auto& entry = ring[ti % capacity];
+        entry.token = ids[beamOffset * maxSeqLen + inputLength + ti];
+        entry.logProb = logProbs == nullptr ? 0.F : logProbs[beamOffset * maxSeqLen + ti];
+        entry.finishReason = ti == numTokens - 1 ? finishReasons[beamOffset] : 0;
+    }
+    // The entries must be visible to the host before the count that covers them
+    __threadfence_system();
+    *reinterpret_cast<std::uint64_t volatile*>(&headers[slot])
+        = (static_cast<std::uint64_t>(requestSeq) << 32) | static_cast<std::uint32_t>(numTokens);
+}
+} // namespace
+
+void invokeWriteOutputTokenRing(std::uint64_t* headers, OutputTokenRingEntry* entries, SizeType32 capacity,
+    std::uint32_t const* requestSeqs, TokenIdType const* ids, SizeType32 const* inputLengths,
+    SizeType32 const* sequenceLengths, float const* logProbs, std::uint8_t const* finishReasons,
+    SizeType32 maxBatchSize, SizeType32 maxBeamWidth, SizeType32 maxSeqLen, CudaStream const& stream)
+{
+    dim3 const blockSize{128};
+    dim3 const gridSize{static_cast<std::uint32_t>(tc::ceilDiv(maxBatchSize, static_cast<SizeType32>(blockSize.x)))};
+    writeOutputTokenRing<<<gridSize, blockSize, 0, stream.get()>>>(headers, entries, capacity, requestSeqs, ids,
+        inputLengths, sequenceLengths, logProbs, finishReasons, maxBatchSize, maxBeamWidth, maxSeqLen);
+}
+
 namespace
 {
 template <typename T>
@@ -1121,6 +1307,210 @@ void gatherLastTokenLogits(ITensor& output, ITensor const& input, ITensor const&
     }
 }
 
+// The fused LM head splits the vocabulary into tiles of kLmHeadTileSize rows. A block per (sequence, tile) projects
+// the last hidden state of the sequence onto the rows of the tile, one warp per row, and keeps the top-k of the tile.
+// A second kernel merges the top-k of the tiles of each sequence. The [batchSize, vocabSize] logits are only written,
+// and thus read back by the sampling, when the caller asks for them.
+
+namespace
+{
+constexpr SizeType32 kLmHeadTileSize = 256;
+constexpr SizeType32 kLmHeadMergeBlockSize = 256;
+
+SizeType32 getLmHeadNumTiles(SizeType32 vocabSize)
+{
+    return tc::ceilDiv(vocabSize, kLmHeadTileSize);
+}
+
+template <typename T>
+__global__ void lmHeadPartialTopKKernel(SizeType32* partialIds, float* partialLogits, T* fullLogits,
+    T const* hiddenStates, T const* lmHeadWeight, SizeType32 const* lastTokenIds, SizeType32 hiddenSize,
+    SizeType32 vocabSize, SizeType32 topK)
+{
+    using BlockReduce = cub::BlockReduce<cub::KeyValuePair<SizeType32, float>, kLmHeadTileSize>;
+    __shared__ typename BlockReduce::TempStorage tempStorage;
+    __shared__ float smemLogits[kLmHeadTileSize];
+    __shared__ SizeType32 smemBest;
+    extern __shared__ float smemHidden[];
+
+    auto const seqIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const tileIdx = static_cast<SizeType32>(blockIdx.y);
+    auto const numTiles = static_cast<SizeType32>(gridDim.y);
+    auto const tileStart = tileIdx * kLmHeadTileSize;
+    // lastTokenIds holds the accumulated lengths, the last token of the sequence is one before.
+    auto const lastTokenIdx = lastTokenIds[seqIdx] - 1;
+
+    T const* hiddenPtr = hiddenStates + static_cast<std::size_t>(lastTokenIdx) * hiddenSize;
+    for (SizeType32 idx = threadIdx.x; idx < hiddenSize; idx += blockDim.x)
+    {
+        smemHidden[idx] = static_cast<float>(hiddenPtr[idx]);
+    }
+    __syncthreads();
+
+    // One warp per row, the lanes read consecutive elements of the row.
+    auto const warpIdx = static_cast<SizeType32>(threadIdx.x / 32);
+    auto const laneIdx = static_cast<SizeType32>(threadIdx.x % 32);
+    auto const numWarps = static_cast<SizeType32>(blockDim.x / 32);
+    for (SizeType32 row = warpIdx; row < kLmHeadTileSize; row += numWarps)
+    {
+        auto const vocabIdx = tileStart + row;
+        float logit = -FLT_MAX;
+        if (vocabIdx < vocabSize)
+        {
+            T const* weightPtr = lmHeadWeight + static_cast<std::size_t>(vocabIdx) * hiddenSize;
+            float sum = 0.f;
+            for (SizeType32 idx = laneIdx; idx < hiddenSize; idx += 32)
+            {
+                sum += smemHidden[idx] * static_cast<float>(weightPtr[idx]);
+            }
+            logit = tc::warpReduceSum(sum);
+            if (fullLogits != nullptr && laneIdx == 0)
+            {
+                fullLogits[static_cast<std::size_t>(seqIdx) * vocabSize + vocabIdx] = static_cast<T>(logit);
+            }
+        }
+        if (laneIdx == 0)
+        {
+            smemLogits[row] = logit;
+        }
+    }
+    __syncthreads();
+
+    // Each thread owns one row of the tile, the top-k are found by repeated arg max.
+    float value = smemLogits[threadIdx.x];
+    auto const outOffset = (seqIdx * numTiles + tileIdx) * topK;
+    for (SizeType32 k = 0; k < topK; ++k)
+    {
+        cub::KeyValuePair<SizeType32, float> const candidate{static_cast<SizeType32>(threadIdx.x), value};
+        auto const best = BlockReduce(tempStorage).Reduce(candidate, cub::ArgMax());
+        if (threadIdx.x == 0)
+        {
+            smemBest = best.key;
+            partialIds[outOffset + k] = tileStart + best.key < vocabSize ? tileStart + best.key : -1;
+            partialLogits[outOffset + k] = best.value;
+        }
+        __syncthreads();
+        if (threadIdx.x == smemBest)
+        {
+            value = -FLT_MAX;
+        }
+        __syncthreads();
+    }
+}
+
+__global__ void lmHeadMergeTopKKernel(SizeType32* topKIds, float* topKLogits, SizeType32 const* partialIds,
+    float const* partialLogits, SizeType32 numCandidates, SizeType32 topK)
+{
+    using BlockReduce = cub::BlockReduce<cub::KeyValuePair<SizeType32, float>, kLmHeadMergeBlockSize>;
+    __shared__ typename BlockReduce::TempStorage tempStorage;
+    __shared__ SizeType32 smemSelected[kMaxLmHeadTopK];
+
+    auto const seqIdx = static_cast<SizeType32>(blockIdx.x);
+    auto const* ids = partialIds + seqIdx * numCandidates;
+    auto const* logits = partialLogits + seqIdx * numCandidates;
+
+    // Candidates are visited in vocabulary order, so ties resolve to the smallest token id like a plain arg max.
+    for (SizeType32 k = 0; k < topK; ++k)
+    {
+        cub::KeyValuePair<SizeType32, float> candidate{-1, -FLT_MAX};
+        for (SizeType32 idx = threadIdx.x; idx < numCandidates; idx += kLmHeadMergeBlockSize)
+        {
+            bool selected = false;
+            for (SizeType32 prev = 0; prev < k; ++prev)
+            {
+                selected |= smemSelected[prev] == idx;
+            }
+            if (!selected && ids[idx] >= 0 && (candidate.key < 0 || logits[idx] > candidate.value))
+            {
+                candidate = {idx, logits[idx]};
+            }
+        }
+        auto const best = BlockReduce(tempStorage).Reduce(candidate, cub::ArgMax());
+        if (threadIdx.x == 0)
+        {
+            smemSelected[k] = best.key;
+            topKIds[seqIdx * topK + k] = best.key >= 0 ? ids[best.key] : -1;
+            topKLogits[seqIdx * topK + k] = best.value;
+        }
+        __syncthreads();
+    }
+}
+
+template <typename T>
+void invokeGatherLastTokenLmHeadTopK(ITensor& topKIds, ITensor& topKLogits, ITensor* fullLogits, IBuffer& workspace,
+    ITensor const& hiddenStates, ITensor const& lmHeadWeight, ITensor const& lastTokenIds, CudaStream const& stream)
+{
+    auto const batchSize = static_cast<SizeType32>(topKIds.getShape().d[0]);
+    auto const topK = static_cast<SizeType32>(topKIds.getShape().d[1]);
+    auto const vocabSize = static_cast<SizeType32>(lmHeadWeight.getShape().d[0]);
+    auto const hiddenSize = static_cast<SizeType32>(lmHeadWeight.getShape().d[1]);
+    auto const& hiddenShape = hiddenStates.getShape();
+
+    TLLM_CHECK_WITH_INFO(0 < topK && topK <= kMaxLmHeadTopK && topK <= vocabSize,
+        common::fmtstr("Top-k (%d) has to be in [1, min(%d, vocabSize)]", topK, kMaxLmHeadTopK));
+    TLLM_CHECK_WITH_INFO(topKLogits.getShape().d[0] == batchSize && topKLogits.getShape().d[1] == topK,
+        "Invalid top-k logits shape");
+    TLLM_CHECK_WITH_INFO(hiddenShape.d[hiddenShape.nbDims - 1] == hiddenSize, "Invalid hidden states shape");
+    TLLM_CHECK_WITH_INFO(static_cast<SizeType32>(lastTokenIds.getSize()) == batchSize, "Invalid last token ids size");
+    TLLM_CHECK_WITH_INFO(workspace.getSizeInBytes() >= getLmHeadTopKWorkspaceSize(batchSize, vocabSize, topK),
+        "Workspace too small");
+    if (fullLogits != nullptr)
+    {
+        TLLM_CHECK_WITH_INFO(fullLogits->getDataType() == hiddenStates.getDataType(), "Invalid full logits type");
+        TLLM_CHECK_WITH_INFO(fullLogits->getSize() == static_cast<std::size_t>(batchSize) * vocabSize,
+            "Invalid full logits size");
+    }
+
+    auto const numTiles = getLmHeadNumTiles(vocabSize);
+    auto* partialIds = static_cast<SizeType32*>(workspace.data());
+    auto* partialLogits = reinterpret_cast<float*>(partialIds + static_cast<std::size_t>(batchSize) * numTiles * topK);
+
+    auto const smemSize = hiddenSize * sizeof(float);
+    if (smemSize >= (48 << 10))
+    {
+        TLLM_CUDA_CHECK(cudaFuncSetAttribute(
+            lmHeadPartialTopKKernel<T>, cudaFuncAttributeMaxDynamicSharedMemorySize, static_cast<int>(smemSize)));
+    }
+    dim3 const gridSize{static_cast<std::uint32_t>(batchSize), static_cast<std::uint32_t>(numTiles)};
+    lmHeadPartialTopKKernel<T><<<gridSize, kLmHeadTileSize, smemSize, stream.get()>>>(partialIds, partialLogits,
+        fullLogits != nullptr ? bufferCast<T>(*fullLogits) : nullptr, bufferCast<T>(hiddenStates),
+        bufferCast<T>(lmHeadWeight), bufferCast<SizeType32>(lastTokenIds), hiddenSize, vocabSize, topK);
+    lmHeadMergeTopKKernel<<<batchSize, kLmHeadMergeBlockSize, 0, stream.get()>>>(bufferCast<SizeType32>(topKIds),
+        bufferCast<float>(topKLogits), partialIds, partialLogits, numTiles * topK, topK);
+}
+} // namespace
+
+std::size_t getLmHeadTopKWorkspaceSize(SizeType32 batchSize, SizeType32 vocabSize, SizeType32 topK)
+{
+    auto const numCandidates = static_cast<std::size_t>(batchSize) * getLmHeadNumTiles(vocabSize) * topK;
+    return numCandidates * (sizeof(SizeType32) + sizeof(float));
+}
+
+void gatherLastTokenLmHeadTopK(ITensor& topKIds, ITensor& topKLogits, ITensor* fullLogits, IBuffer& workspace,
+    ITensor const& hiddenStates, ITensor const& lmHeadWeight, ITensor const& lastTokenIds, CudaStream const& stream)
+{
+    TLLM_CHECK_WITH_INFO(hiddenStates.getDataType() == lmHeadWeight.getDataType(),
+        "Hidden states and LM head weight must have the same type");
+    switch (hiddenStates.getDataType())
+    {
+    case nvinfer1::DataType::kFLOAT:
+        invokeGatherLastTokenLmHeadTopK<float>(
+            topKIds, topKLogits, fullLogits, workspace, hiddenStates, lmHeadWeight, lastTokenIds, stream);
+        break;
+    case nvinfer1::DataType::kHALF:
+        invokeGatherLastTokenLmHeadTopK<half>(
+            topKIds, topKLogits, fullLogits, workspace, hiddenStates, lmHeadWeight, lastTokenIds, stream);
+        break;
+#ifdef ENABLE_BF16
+    case nvinfer1::DataType::kBF16:
+        invokeGatherLastTokenLmHeadTopK<__nv_bfloat16>(
+            topKIds, topKLogits, fullLogits, workspace, hiddenStates, lmHeadWeight, lastTokenIds, stream);
+        break;
+#endif // ENABLE_BF16
+    default: TLLM_CHECK_WITH_INFO(false, "data type not supported");
+    }
+}
+
 // In the following kernel, we launch a grid with (microBatchSize * beamWidth, outputLen) blocks of threads. Each thread
 // block copies a `vocabSizePadded` length logits tensor from the "inputLogits (microBatchSize, beamWidth,
 // vocabSizePadded)" to the "outputGenerationLogits (batchSize, beamWidth, outputLen, vocabSizePadded)"
@@ -22,6 +22,9 @@
 #include "tensorrt_llm/runtime/cudaStream.h"
 #include "tensorrt_llm/runtime/iTensor.h"
 
+#include <cstdint>
+#include <cstring>
+
 namespace tensorrt_llm::runtime::kernels
 {
 
@@ -37,6 +40,78 @@ void invokeFillBatch(
 void invokeCopyBatch(IBuffer const& srcBuffer, IBuffer& dstBuffer, IBuffer const& srcOffsets, IBuffer const& dstOffsets,
     IBuffer const& sizes, std::size_t maxStride, CudaStream const& stream);
 
+//! \brief A fill of numElements elements of elementSize (1, 2 or 4) bytes at dst. The first numSrcElements elements
+//! are copied from src, the remaining ones are set to the low elementSize bytes of value.
+struct BatchedFill
+{
+    void* dst;
+    void const* src;
+    std::uint32_t numElements;
+    std::uint32_t numSrcElements;
+    std::uint32_t value;
+    std::uint32_t elementSize;
+
+    template <typename T>
+    static BatchedFill create(T* dst, std::size_t numElements, T value, T const* src = nullptr,
+        std::size_t numSrcElements = 0)
+    {
+        static_assert(sizeof(T) <= sizeof(std::uint32_t));
+        std::uint32_t bits{0};
+        std::memcpy(&bits, &value, sizeof(T));
+        return BatchedFill{dst, src, static_cast<std::uint32_t>(numElements),
+            static_cast<std::uint32_t>(numSrcElements), bits, static_cast<std::uint32_t>(sizeof(T))};
+    }
+};
+
+//! \brief Apply numFills fills with a single launch, e.g. to set up the slots of many new requests at once.
+//! \param fills Device accessible array of fills. The fills must not overlap.
+//! \param maxNumElements Largest numElements of all fills, determines the grid size.
+void invokeBatchedFill(
+    BatchedFill const* fills, std::size_t numFills, std::size_t maxNumElements, CudaStream const& stream);
+
+//! \brief A copy of numBytes bytes from src to dst, both device accessible.
+struct BatchedCopy
+{
+    void* dst;
+    void const* src;
+    std::uint64_t numBytes;
+};
+
+//! \brief Apply numCopies copies with a single launch instead of one cudaMemcpyAsync each.
+//! \param copies Device accessible array of copies. The destinations must not overlap each other or any source.
+//! \param maxNumBytes Largest numBytes of all copies, determines the grid size.
+void invokeBatchedCopy(
+    BatchedCopy const* copies, std::size_t numCopies, std::size_t maxNumBytes, CudaStream const& stream);
+
+//! \brief Header of a snapshot slot of DecoderStatusBlock. The data of the slot is valid when both epochs are equal.
+struct DecoderStatusHeader
+{
+    std::uint64_t beginEpoch;
+    std::uint64_t endEpoch;
+};
+
+//! \brief Write a snapshot of the finished sums and of the sequence lengths of the first beam of maxBatchSize slots
+//! into a slot of a DecoderStatusBlock, which is in host memory. The begin epoch is visible to the host before the data
+//! and the end epoch after it.
+void invokeWriteDecoderStatus(DecoderStatusHeader* slot, std::uint64_t epoch, SizeType32 const* finishedSum,
+    SizeType32 const* sequenceLengths, SizeType32 maxBatchSize, SizeType32 maxBeamWidth, CudaStream const& stream);
+
+//! \brief A token in the ring of a slot of OutputTokenRing.
+struct OutputTokenRingEntry
+{
+    TokenIdType token;
+    float logProb;
+    //! FinishedState of the slot after the step, on the last token of the step only
+    std::uint8_t finishReason;
+};
+
+//! \brief Append the tokens each slot generated since the previous call to the ring of the slot and publish the new
+//! count in the header of the slot, (requestSeq << 32) | numTokens. Slots with requestSeq 0 are skipped.
+void invokeWriteOutputTokenRing(std::uint64_t* headers, OutputTokenRingEntry* entries, SizeType32 capacity,
+    std::uint32_t const* requestSeqs, TokenIdType const* ids, SizeType32 const* inputLengths,
+    SizeType32 const* sequenceLengths, float const* logProbs, std::uint8_t const* finishReasons,
+    SizeType32 maxBatchSize, SizeType32 maxBeamWidth, SizeType32 maxSeqLen, CudaStream const& stream);
+
 template <typename T>
 void invokeAdd(IBuffer& buffer, T value, CudaStream const& stream);
 
@@ -88,6 +163,24 @@ void tileTensorInplace(ITensor& tensor, SizeType32 beamWidth, CudaStream const&
 void gatherLastTokenLogits(
     ITensor& output, ITensor const& input, ITensor const& lastTokenIds, CudaStream const& stream);
 
+//! \brief Largest k supported by gatherLastTokenLmHeadTopK.
+constexpr SizeType32 kMaxLmHeadTopK = 16;
+
+//! \brief Size in bytes of the workspace of gatherLastTokenLmHeadTopK.
+std::size_t getLmHeadTopKWorkspaceSize(SizeType32 batchSize, SizeType32 vocabSize, SizeType32 topK);
+
+//! \brief Projects the hidden state of the last token of each sequence onto the vocabulary and keeps only the top-k
+//! tokens, for greedy and low-k requests that do not need the full logits.
+//! \param topKIds [batchSize, topK] int32, the top-k tokens of each sequence, in descending order of logit.
+//! \param topKLogits [batchSize, topK] float, their logits.
+//! \param fullLogits [batchSize, vocabSize] of the hidden states type, written only if not nullptr.
+//! \param workspace Device buffer of at least getLmHeadTopKWorkspaceSize bytes.
+//! \param hiddenStates [numTokens, hiddenSize], the tokens of all sequences, packed.
+//! \param lmHeadWeight [vocabSize, hiddenSize], same type as hiddenStates.
+//! \param lastTokenIds [batchSize], the inclusive prefix sum of the sequence lengths.
+void gatherLastTokenLmHeadTopK(ITensor& topKIds, ITensor& topKLogits, ITensor* fullLogits, IBuffer& workspace,
+    ITensor const& hiddenStates, ITensor const& lmHeadWeight, ITensor const& lastTokenIds, CudaStream const& stream);
+
 void copyLatestTokenLogitsInGeneration(ITensor& output, ITensor const& input, SizeType32 step,
     SizeType32 firstBatchSlotIdx, SizeType32 microBatchSize, SizeType32 beamWidth, CudaStream const& stream);
 
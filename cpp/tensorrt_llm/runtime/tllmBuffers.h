@@ -19,11 +19,13 @@
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/cpuAffinity.h"
 #include "tensorrt_llm/runtime/cudaMemPool.h"
 #include "tensorrt_llm/runtime/cudaStream.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 #include "tensorrt_llm/runtime/iTensor.h"
 #include "tensorrt_llm/runtime/memoryCounters.h"
+#include "tensorrt_llm/runtime/pinnedStagingPool.h"
 
 #include <NvInferRuntime.h>
 #include <cuda_runtime_api.h>
@@ -55,7 +57,9 @@ public:
         static_cast<TDerived*>(this)->allocateImpl(&ptr, n);
         if constexpr (count)
         {
-            MemoryCounters::getInstance().allocate<memoryType>(n);
+            auto& counters = MemoryCounters::getInstance();
+            counters.allocate<memoryType>(n);
+            counters.allocate(mTag, memoryType, n);
         }
         return ptr;
     }
@@ -67,7 +71,9 @@ public:
             static_cast<TDerived*>(this)->deallocateImpl(ptr, n);
             if constexpr (count)
             {
-                MemoryCounters::getInstance().deallocate<memoryType>(n);
+                auto& counters = MemoryCounters::getInstance();
+                counters.deallocate<memoryType>(n);
+                counters.deallocate(mTag, memoryType, n);
             }
         }
     }
@@ -76,6 +82,15 @@ public:
     {
         return memoryType;
     }
+
+    [[nodiscard]] MemoryTag getMemoryTag() const noexcept
+    {
+        return mTag;
+    }
+
+private:
+    // Captured when the allocator is created, i.e. with the buffer that owns it.
+    MemoryTag mTag{MemoryCounters::getCurrentTag()};
 };
 
 class CudaAllocator : public BaseAllocator<CudaAllocator, MemoryType::kGPU>
@@ -106,9 +121,11 @@ public:
     using CudaStreamPtr = std::shared_ptr<CudaStream>;
     using CudaPoolPtr = std::shared_ptr<CudaMemPool>;
 
-    explicit CudaAllocatorAsync(CudaStreamPtr stream, CudaPoolPtr memPool)
+    //! \param fallbackPool Pool to allocate from when memPool cannot grow because the device is out of memory.
+    explicit CudaAllocatorAsync(CudaStreamPtr stream, CudaPoolPtr memPool, CudaPoolPtr fallbackPool = nullptr)
         : mCudaStream(std::move(stream))
         , mMemPool(std::move(memPool))
+        , mFallbackPool(std::move(fallbackPool))
     {
         TLLM_CHECK_WITH_INFO(static_cast<bool>(mCudaStream), "Undefined CUDA stream");
         TLLM_CHECK_WITH_INFO(static_cast<bool>(mMemPool), "Undefined CUDA mem pool");
@@ -122,17 +139,28 @@ public:
 protected:
     void allocateImpl(PointerType* ptr, std::size_t n)
     {
-        TLLM_CUDA_CHECK(::cudaMallocAsync(ptr, n, mMemPool->getPool(), mCudaStream->get()));
+        auto const status = ::cudaMallocAsync(ptr, n, mMemPool->getPool(), mCudaStream->get());
+        if (status == cudaErrorMemoryAllocation && mFallbackPool)
+        {
+            // Clear the error, the allocation is retried
+            static_cast<void>(::cudaGetLastError());
+            TLLM_LOG_WARNING("Out of device memory allocating %zu B, using the emergency pool", n);
+            TLLM_CUDA_CHECK(::cudaMallocAsync(ptr, n, mFallbackPool->getPool(), mCudaStream->get()));
+            return;
+        }
+        TLLM_CUDA_CHECK(status);
     }
 
     void deallocateImpl(PointerType ptr, [[maybe_unused]] std::size_t n)
     {
+        // Returns the memory to the pool it was allocated from
         TLLM_CUDA_CHECK_FREE_RESOURCE(::cudaFreeAsync(ptr, mCudaStream->get()));
     }
 
 private:
     CudaStreamPtr mCudaStream;
     CudaPoolPtr mMemPool;
+    CudaPoolPtr mFallbackPool;
 };
 
 class UVMAllocator : public BaseAllocator<UVMAllocator, MemoryType::kUVM>
@@ -168,6 +196,8 @@ public:
 protected:
     void allocateImpl(PointerType* ptr, std::size_t n) // NOLINT(readability-convert-member-functions-to-static)
     {
+        // The pages are faulted in while they are pinned, so they land on the NUMA node of the device, if set
+        ScopedNumaPreference const numaPreference{CpuAffinity::getPinnedMemoryNode()};
         TLLM_CUDA_CHECK(::cudaHostAlloc(ptr, n, cudaHostAllocDefault));
     }
 
@@ -500,6 +530,27 @@ protected:
 
 using PinnedPoolAllocator = PoolAllocator<PinnedAllocator>;
 
+//! \brief Allocates from the process-wide PinnedStagingPool, for per-request host staging buffers.
+class PinnedStagingAllocator : public BaseAllocator<PinnedStagingAllocator, MemoryType::kPINNEDPOOL, false>
+{
+    friend class BaseAllocator<PinnedStagingAllocator, MemoryType::kPINNEDPOOL, false>;
+
+public:
+    PinnedStagingAllocator() noexcept = default;
+
+protected:
+    void allocateImpl(PointerType* ptr, std::size_t n) // NOLINT(readability-convert-member-functions-to-static)
+    {
+        *ptr = PinnedStagingPool::getInstance().allocate(n);
+    }
+
+    void deallocateImpl( // NOLINT(readability-convert-member-functions-to-static)
+        PointerType ptr, std::size_t n)
+    {
+        PinnedStagingPool::getInstance().deallocate(ptr, n);
+    }
+};
+
 // Adopted from https://github.com/NVIDIA/TensorRT/blob/release/8.6/samples/common/buffers.h
 
 //!
@@ -675,6 +726,7 @@ using StaticDeviceBuffer = GenericBuffer<CudaAllocator>;
 using HostBuffer = GenericBuffer<HostAllocator>;
 using PinnedBuffer = GenericBuffer<PinnedAllocator>;
 using PinnedPoolBuffer = GenericBuffer<PinnedPoolAllocator>;
+using PinnedStagingBuffer = GenericBuffer<PinnedStagingAllocator>;
 using UVMBuffer = GenericBuffer<UVMAllocator>;
 
 template <typename T>
@@ -765,6 +817,7 @@ using StaticDeviceTensor = GenericTensor<CudaAllocator>;
 using HostTensor = GenericTensor<HostAllocator>;
 using PinnedTensor = GenericTensor<PinnedAllocator>;
 using PinnedPoolTensor = GenericTensor<PinnedPoolAllocator>;
+using PinnedStagingTensor = GenericTensor<PinnedStagingAllocator>;
 using UVMTensor = GenericTensor<UVMAllocator>;
 
 } // namespace tensorrt_llm::runtime
@@ -15,15 +15,28 @@
  */
 #include "tllmRuntime.h"
 #include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/commLane.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
 #include "tensorrt_llm/common/logger.h"
 #include "tensorrt_llm/common/mpiUtils.h"
 #include "tensorrt_llm/common/nvtxUtils.h"
 #include "tensorrt_llm/common/safetensors.h"
+#include "tensorrt_llm/common/startupProfiler.h"
 #include "tensorrt_llm/executor/tensor.h"
+#include "tensorrt_llm/runtime/engineRegistry.h"
+#include "tensorrt_llm/runtime/memoryCounters.h"
+#include "tensorrt_llm/runtime/traceRecorder.h"
 #include "tllmLogger.h"
 
+#include <algorithm>
+#include <filesystem>
 #include <limits>
+#include <optional>
+#include <sstream>
+#include <thread>
 #include <type_traits>
+#include <utility>
 
 using namespace tensorrt_llm::runtime;
 using TensorMap = StringPtrMap<ITensor>;
@@ -91,7 +104,9 @@ public:
     std::ifstream mFile;
 };
 
-void setWeightStreaming(nvinfer1::ICudaEngine& engine, float const gpuWeightsPercent)
+//! \brief Set the budget from the percentage of streamable weights to keep on the GPU.
+//! \return The budget tracker, nullptr if the engine does not stream weights
+std::unique_ptr<WeightStreamingBudget> setWeightStreaming(nvinfer1::ICudaEngine& engine, float const gpuWeightsPercent)
 {
     if (gpuWeightsPercent < 1)
     {
@@ -100,51 +115,162 @@ void setWeightStreaming(nvinfer1::ICudaEngine& engine, float const gpuWeightsPer
         TLLM_LOG_INFO("Set gpu weights percent to %f, which is %lld bytes. Valid range: %lld bytes - %lld bytes.",
             gpuWeightsPercent, budget, 0, streamableSize);
         engine.setWeightStreamingBudgetV2(budget);
+        if (streamableSize > 0)
+        {
+            auto const headroomMB = tensorrt_llm::common::getEnvWeightStreamingHeadroomMB();
+            std::optional<std::int64_t> const headroom
+                = headroomMB ? std::make_optional(std::int64_t{*headroomMB} << 20) : std::nullopt;
+            // Recreating the contexts for less than 1% of the weights is not worth it
+            auto const minStep = std::max(streamableSize / 100, std::int64_t{1});
+            return std::make_unique<WeightStreamingBudget>(streamableSize, budget, headroom, minStep);
+        }
     }
+    return nullptr;
 }
-} // namespace
-
-TllmRuntime::TllmRuntime(
-    RawEngine const& rawEngine, nvinfer1::ILogger* logger, float gpuWeightsPercent, bool useShapeInference)
-    : mStream(std::make_shared<CudaStream>())
-    , mBufferManager{mStream, true} // Ensure to trim the memory pool on destruction.
-    , mRuntime{nvinfer1::createInferRuntime(logger ? *logger : defaultLogger)}
-    , mUseShapeInference{useShapeInference}
+std::shared_ptr<nvinfer1::ICudaEngine> deserializeEngine(RawEngine const& rawEngine, nvinfer1::ILogger& logger)
 {
+    // The engine must not outlive the runtime that deserialized it
+    std::shared_ptr<nvinfer1::IRuntime> runtime{nvinfer1::createInferRuntime(logger)};
+    nvinfer1::ICudaEngine* engine{nullptr};
     switch (rawEngine.getType())
     {
     case RawEngine::Type::FilePath:
     {
         auto reader = StreamReader(rawEngine.getPath());
-        mEngine.reset(mRuntime->deserializeCudaEngine(reader));
+        engine = runtime->deserializeCudaEngine(reader);
         break;
     }
     case RawEngine::Type::AddressWithSize:
-        mEngine.reset(mRuntime->deserializeCudaEngine(rawEngine.getAddress(), rawEngine.getSize()));
+        engine = runtime->deserializeCudaEngine(rawEngine.getAddress(), rawEngine.getSize());
         break;
     case RawEngine::Type::HostMemory:
-        mEngine.reset(
-            mRuntime->deserializeCudaEngine(rawEngine.getHostMemory()->data(), rawEngine.getHostMemory()->size()));
+        engine = runtime->deserializeCudaEngine(rawEngine.getHostMemory()->data(), rawEngine.getHostMemory()->size());
         break;
+    case RawEngine::Type::MemoryMapped:
+    {
+        auto const& mappedFile = rawEngine.getMappedFile();
+        engine = runtime->deserializeCudaEngine(mappedFile.data(), mappedFile.size());
+        // The engine owns its copy of the weights now, the pages can go back to the page cache
+        mappedFile.release();
+        break;
+    }
     default: TLLM_THROW("Unsupported raw engine type.");
     }
 
-    TLLM_CHECK_WITH_INFO(mEngine != nullptr, "Failed to deserialize cuda engine.");
+    TLLM_CHECK_WITH_INFO(engine != nullptr, "Failed to deserialize cuda engine.");
+    return std::shared_ptr<nvinfer1::ICudaEngine>(
+        engine, [runtime = std::move(runtime)](nvinfer1::ICudaEngine* engine) { delete engine; });
+}
+
+//! \brief The key to share the engine under, see EngineRegistry.
+//! \return std::nullopt if the engine is not shared
+std::optional<std::string> getShareKey(RawEngine const& rawEngine)
+{
+    if (rawEngine.getShareKeyOpt())
+    {
+        return rawEngine.getShareKeyOpt();
+    }
+    if (!tensorrt_llm::common::getEnvShareEngines())
+    {
+        return std::nullopt;
+    }
+    switch (rawEngine.getType())
+    {
+    case RawEngine::Type::FilePath:
+    case RawEngine::Type::MemoryMapped: return std::filesystem::weakly_canonical(rawEngine.getPath()).string();
+    case RawEngine::Type::AddressWithSize:
+    {
+        std::ostringstream key;
+        key << rawEngine.getAddress();
+        return key.str();
+    }
+    case RawEngine::Type::HostMemory:
+    {
+        std::ostringstream key;
+        key << rawEngine.getHostMemory()->data();
+        return key.str();
+    }
+    default: return std::nullopt;
+    }
+}
+
+//! \brief The ranges of every profile of an engine with packed inputs.
+//! \return std::nullopt if the input ids of the engine are not packed, their dimension 0 is not the number of tokens
+std::optional<OptProfileSelector> makeProfileSelector(nvinfer1::ICudaEngine const& engine)
+{
+    auto constexpr kInputIds = "input_ids";
+    auto constexpr kRequestTypes = "host_request_types";
+    if (engine.getTensorShape(kInputIds).nbDims != 1)
+    {
+        return std::nullopt;
+    }
+    bool const hasRequestTypes = engine.getTensorShape(kRequestTypes).nbDims == 1;
+    std::vector<OptProfileSelector::ProfileRange> profiles;
+    for (std::int32_t profileIndex = 0; profileIndex < engine.getNbOptimizationProfiles(); ++profileIndex)
+    {
+        auto const dim0 = [&](char const* name, nvinfer1::OptProfileSelector selector)
+        { return static_cast<SizeType32>(engine.getProfileShape(name, profileIndex, selector).d[0]); };
+        OptProfileSelector::ProfileRange range;
+        range.minTokens = dim0(kInputIds, nvinfer1::OptProfileSelector::kMIN);
+        range.optTokens = dim0(kInputIds, nvinfer1::OptProfileSelector::kOPT);
+        range.maxTokens = dim0(kInputIds, nvinfer1::OptProfileSelector::kMAX);
+        range.minSequences = hasRequestTypes ? dim0(kRequestTypes, nvinfer1::OptProfileSelector::kMIN) : 0;
+        range.maxSequences = hasRequestTypes ? dim0(kRequestTypes, nvinfer1::OptProfileSelector::kMAX)
+                                             : std::numeric_limits<SizeType32>::max();
+        profiles.push_back(range);
+    }
+    return OptProfileSelector{std::move(profiles)};
+}
+} // namespace
+
+TllmRuntime::TllmRuntime(
+    RawEngine const& rawEngine, nvinfer1::ILogger* logger, float gpuWeightsPercent, bool useShapeInference)
+    : mStream(std::make_shared<CudaStream>())
+    , mBufferManager{mStream, true} // Ensure to trim the memory pool on destruction.
+    , mUseShapeInference{useShapeInference}
+{
+    std::optional<common::StartupProfiler::ScopedPhase> deserializePhase{
+        std::in_place, common::StartupPhase::kTRT_DESERIALIZE};
+    bool deserialized{false};
+    auto const deserialize = [&]()
+    {
+        deserialized = true;
+        return deserializeEngine(rawEngine, logger ? *logger : defaultLogger);
+    };
+    auto const shareKey = getShareKey(rawEngine);
+    mEngine = shareKey ? EngineRegistry::getInstance().acquire(*shareKey, deserialize) : deserialize();
     mEngineInspector.reset(mEngine->createEngineInspector());
+    deserializePhase.reset();
 
-    setWeightStreaming(getEngine(), gpuWeightsPercent);
+    if (deserialized)
+    {
+        mWeightStreamingBudget = setWeightStreaming(getEngine(), gpuWeightsPercent);
+    }
+    else if (mEngine->getWeightStreamingBudgetV2() < mEngine->getStreamableWeightsSize())
+    {
+        // The runtime that deserialized the engine set the budget, which cannot change while the engine is shared
+        mWeightStreamingBudget = std::make_unique<WeightStreamingBudget>(mEngine->getStreamableWeightsSize(),
+            mEngine->getWeightStreamingBudgetV2(), std::nullopt, std::int64_t{1});
+    }
 
+    common::StartupProfiler::ScopedPhase const contextPhase{common::StartupPhase::kCONTEXT_CREATION};
     auto const devMemorySize = mEngine->getDeviceMemorySizeV2();
-    mEngineBuffer = mBufferManager.gpu(devMemorySize);
+    {
+        MemoryCounters::TagScope const tagScope{MemoryTag::kACTIVATIONS};
+        mEngineBuffer = mBufferManager.gpu(devMemorySize);
+    }
 
     // Print context memory size for CI/CD to track.
     TLLM_LOG_INFO("[MemUsageChange] Allocated %.2f MiB for execution context memory.",
         static_cast<double>(devMemorySize) / 1048576.0);
 }
 
-nvinfer1::IExecutionContext& TllmRuntime::addContext(std::int32_t profileIndex)
+nvinfer1::IExecutionContext& TllmRuntime::addContext(std::int32_t profileIndex, SizeType32 lane)
 {
     TLLM_CHECK(0 <= profileIndex && profileIndex < mEngine->getNbOptimizationProfiles());
+    TLLM_CHECK_WITH_INFO(
+        0 <= lane && lane < common::kNbCommLanes, "Lane %d out of range [0, %d)", lane, common::kNbCommLanes);
+    common::StartupProfiler::ScopedPhase const startupPhase{common::StartupPhase::kCONTEXT_CREATION};
     mContexts.emplace_back(mEngine->createExecutionContextWithoutDeviceMemory());
     if (!mContexts.back())
     {
@@ -157,8 +283,20 @@ nvinfer1::IExecutionContext& TllmRuntime::addContext(std::int32_t profileIndex)
             TLLM_THROW("Internal Error: Failed to create an execution context.");
         }
     }
+    mBoundInputs.emplace_back(mEngine->getNbIOTensors());
+    mContextLanes.push_back(lane);
+    if (lane != 0 && !mOverlapEngineBuffer)
+    {
+        // The contexts of the two lanes run at the same time, so their activations must not alias
+        MemoryCounters::TagScope const tagScope{MemoryTag::kACTIVATIONS};
+        mOverlapEngineBuffer = mBufferManager.gpu(mEngineBuffer->getCapacity());
+        mOverlapStream = std::make_shared<CudaStream>();
+        TLLM_LOG_INFO("[MemUsageChange] Allocated %.2f MiB for the execution context memory of the overlap lane.",
+            static_cast<double>(mOverlapEngineBuffer->getCapacity()) / 1048576.0);
+    }
+    auto const& engineBuffer = lane == 0 ? mEngineBuffer : mOverlapEngineBuffer;
     auto& context = *mContexts.back();
-    context.setDeviceMemoryV2(mEngineBuffer->data(), static_cast<int64_t>(mEngineBuffer->getCapacity()));
+    context.setDeviceMemoryV2(engineBuffer->data(), static_cast<int64_t>(engineBuffer->getCapacity()));
     context.setOptimizationProfileAsync(profileIndex, mStream->get());
     // If nvtx verbosity is DETAILED, print an info about potential perf overhead.
     if (context.getNvtxVerbosity() == nvinfer1::ProfilingVerbosity::kDETAILED)
@@ -176,15 +314,94 @@ void TllmRuntime::clearContexts()
         context.reset();
     }
     mContexts.clear();
+    mContextLanes.clear();
+    mBoundInputs.clear();
+    mProfileContexts.clear();
+    mSetWeights.clear();
+}
+
+SizeType32 TllmRuntime::getProfileContext(SizeType32 profileIndex, SizeType32 lane)
+{
+    TLLM_CHECK_WITH_INFO(0 <= profileIndex && profileIndex < getNbProfiles(), "Profile %d out of range [0, %d)",
+        profileIndex, getNbProfiles());
+    TLLM_CHECK_WITH_INFO(
+        0 <= lane && lane < common::kNbCommLanes, "Lane %d out of range [0, %d)", lane, common::kNbCommLanes);
+    if (mProfileContexts.empty())
+    {
+        mProfileContexts.resize(getNbProfiles() * common::kNbCommLanes, -1);
+    }
+    auto& contextIndex = mProfileContexts[lane * getNbProfiles() + profileIndex];
+    if (contextIndex < 0)
+    {
+        addContext(profileIndex, lane);
+        contextIndex = getNbContexts() - 1;
+        if (mLayerProfiler)
+        {
+            mContexts.back()->setProfiler(mLayerProfiler.get());
+            mContexts.back()->setEnqueueEmitsProfile(false);
+        }
+    }
+    return contextIndex;
+}
+
+SizeType32 TllmRuntime::selectContext(
+    SizeType32 numTokens, SizeType32 numSequences, SizeType32 numContextRequests, SizeType32 lane)
+{
+    if (getNbProfiles() == 1)
+    {
+        return getProfileContext(0, lane);
+    }
+    if (!mProfileSelector)
+    {
+        mProfileSelector = makeProfileSelector(getEngine());
+        TLLM_CHECK_WITH_INFO(mProfileSelector.has_value(), "Selecting among profiles needs packed input ids");
+    }
+    auto const profileIndex = mProfileSelector->select(numTokens, numSequences, numContextRequests);
+    TLLM_CHECK_WITH_INFO(profileIndex.has_value(), "No optimization profile accepts %d tokens in %d sequences",
+        numTokens, numSequences);
+    return getProfileContext(*profileIndex, lane);
 }
 
 bool TllmRuntime::executeContext(SizeType32 contextIndex) const
 {
     NVTX3_FUNC_RANGE();
+    TraceRecorder::ScopedSpan const traceSpan{"engine_enqueue"};
     auto& context = getContext(contextIndex);
+    if (mWeightStreamingBudget)
+    {
+        mWeightStreamingBudget->onForward();
+    }
     return context.enqueueV3(mStream->get());
 }
 
+bool TllmRuntime::executeContexts(SizeType32 contextIndex, SizeType32 overlapContextIndex) const
+{
+    NVTX3_FUNC_RANGE();
+    TraceRecorder::ScopedSpan const traceSpan{"engine_enqueue"};
+    TLLM_CHECK_WITH_INFO(mContextLanes.at(contextIndex) == 0 && mContextLanes.at(overlapContextIndex) == 1,
+        "Contexts %d and %d are not of lanes 0 and 1", contextIndex, overlapContextIndex);
+    if (mWeightStreamingBudget)
+    {
+        mWeightStreamingBudget->onForward();
+        mWeightStreamingBudget->onForward();
+    }
+    mStream->record(mOverlapStartEvent);
+    mOverlapStream->wait(mOverlapStartEvent);
+    // The plugins pick the communicators of the lane while the contexts are enqueued
+    bool success{false};
+    {
+        common::CommLaneScope const laneScope{0};
+        success = getContext(contextIndex).enqueueV3(mStream->get());
+    }
+    {
+        common::CommLaneScope const laneScope{1};
+        success = getContext(overlapContextIndex).enqueueV3(mOverlapStream->get()) && success;
+    }
+    mOverlapStream->record(mOverlapDoneEvent);
+    mStream->wait(mOverlapDoneEvent);
+    return success;
+}
+
 void TllmRuntime::setInputTensors(SizeType32 contextIndex, TensorMap const& tensorMap)
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
@@ -218,20 +435,27 @@ void TllmRuntime::setInputTensors(SizeType32 contextIndex, TensorMap const& tens
                 static_cast<std::int32_t>(tensorDtype));
 
             auto const tensorShape = tensor->getShape();
+            auto* const data = tensor->data();
+            auto& bound = mBoundInputs.at(contextIndex).at(i);
+            if (data && bound.data == data && ITensor::shapeEquals(bound.shape, tensorShape))
+            {
+                continue; // Still bound from a previous iteration
+            }
             auto const setInputShapeSuccess = context.setInputShape(name, tensorShape);
             if (!setInputShapeSuccess)
             {
-                auto const minShape = mEngine->getProfileShape(name, contextIndex, nvinfer1::OptProfileSelector::kMIN);
-                auto const maxShape = mEngine->getProfileShape(name, contextIndex, nvinfer1::OptProfileSelector::kMAX);
+                auto const profileIndex = context.getOptimizationProfile();
+                auto const minShape = mEngine->getProfileShape(name, profileIndex, nvinfer1::OptProfileSelector::kMIN);
+                auto const maxShape = mEngine->getProfileShape(name, profileIndex, nvinfer1::OptProfileSelector::kMAX);
 
                 TLLM_THROW("Tensor '%s' has invalid shape %s, expected in range min %s, max %s", name,
                     ITensor::toString(tensorShape).c_str(), ITensor::toString(minShape).c_str(),
                     ITensor::toString(maxShape).c_str());
             }
-            auto* const data = tensor->data();
             if (data)
             {
                 context.setInputTensorAddress(name, data);
+                bound = BoundInput{data, tensorShape};
             }
             else
             {
@@ -302,6 +526,7 @@ void TllmRuntime::setOutputTensors(SizeType32 contextIndex, TensorMap& tensorMap
             else if (mUseShapeInference)
             {
                 auto const dims = context.getTensorShape(name);
+                MemoryCounters::TagScope const tagScope{MemoryTag::kIO_BUFFERS};
                 auto tensor = ITensor::SharedPtr(mBufferManager.gpu(dims, engineDtype));
                 tensorMap.insert(pos, std::make_pair(name, tensor));
                 context.setTensorAddress(name, tensor->data());
@@ -344,12 +569,20 @@ std::string TllmRuntime::getLayerProfileInfo() const
 void TllmRuntime::reportToProfiler(SizeType32 contextId)
 {
     mContexts[contextId]->reportToProfiler();
+    auto& traceRecorder = TraceRecorder::getInstance();
+    if (traceRecorder.isEnabled() && mLayerProfiler)
+    {
+        // Reported after the execution is synchronized, the layers end about now
+        traceRecorder.recordLayerTimes(mLayerProfiler->takeReportedLayers(), TraceRecorder::Clock::now());
+    }
 }
 
 void TllmRuntime::loadManagedWeights(RawEngine const& rawEngine, int localRank)
 {
+    common::StartupProfiler::ScopedPhase const startupPhase{common::StartupPhase::kMANAGED_WEIGHTS_LOAD};
     auto& engine = getEngine();
     auto& manager = getBufferManager();
+    MemoryCounters::TagScope const tagScope{MemoryTag::kWEIGHTS};
     if (rawEngine.getManagedWeightsMapOpt().has_value())
     {
         TLLM_LOG_DEBUG("Loading managed weights from raw engine");
@@ -372,6 +605,9 @@ void TllmRuntime::loadManagedWeights(RawEngine const& rawEngine, int localRank)
         auto weightPath
             = enginePath->parent_path() / ("rank" + std::to_string(localRank) + "_managed_weights.safetensors");
         auto managed_weights = common::safetensors::ISafeTensor::open(weightPath.string().c_str());
+        // Fault the mapped file in from several threads, the copies below then read from the page cache
+        auto const numPrefetchThreads = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, 8);
+        managed_weights->prefetch(managed_weights->keys(), numPrefetchThreads);
         for (auto const& name : managed_weights->keys())
         {
             TLLM_LOG_DEBUG("Loading managed weight: %s", name.c_str());
@@ -384,3 +620,153 @@ void TllmRuntime::loadManagedWeights(RawEngine const& rawEngine, int localRank)
         }
     }
 }
+
+void TllmRuntime::stageManagedWeights(std::map<std::string, executor::Tensor> const& weights)
+{
+    TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
+    TLLM_CHECK_WITH_INFO(!hasStagedManagedWeights(), "Commit the staged managed weights before staging new ones");
+    if (!mWeightsStream)
+    {
+        mWeightsStream = std::make_shared<CudaStream>();
+    }
+    // Standby buffers may still be read by iterations enqueued before the last commit
+    mWeightsStream->wait(mWeightsReleasedEvent);
+    BufferManager manager{mWeightsStream};
+    MemoryCounters::TagScope const tagScope{MemoryTag::kWEIGHTS};
+    for (auto const& [name, weight] : weights)
+    {
+        auto const current = mManagedWeightsMap.find(name);
+        TLLM_CHECK_WITH_INFO(current != mManagedWeightsMap.end(), "%s is not a managed weight", name.c_str());
+        auto const source = executor::detail::toITensor(weight);
+        TLLM_CHECK_WITH_INFO(source->getDataType() == current->second->getDataType()
+                && source->getSize() == current->second->getSize(),
+            "%s: expected %s of type %d, provided %s of type %d", name.c_str(),
+            ITensor::toString(current->second->getShape()).c_str(),
+            static_cast<std::int32_t>(current->second->getDataType()), ITensor::toString(source->getShape()).c_str(),
+            static_cast<std::int32_t>(source->getDataType()));
+
+        ITensor::SharedPtr staged;
+        if (auto standby = mStandbyWeightsMap.find(name); standby != mStandbyWeightsMap.end())
+        {
+            staged = standby->second;
+            mStandbyWeightsMap.erase(standby);
+        }
+        else
+        {
+            staged = manager.gpu(current->second->getShape(), current->second->getDataType());
+        }
+        manager.copy(*source, *staged);
+        mStagedWeightsMap.insert(std::make_pair(name, staged));
+        mStagedWeightsSources.push_back(weight);
+    }
+    mWeightsStream->record(mWeightsStagedEvent);
+    TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
+}
+
+bool TllmRuntime::commitManagedWeights(bool blocking)
+{
+    if (!hasStagedManagedWeights())
+    {
+        return false;
+    }
+    if (blocking)
+    {
+        mWeightsStagedEvent.synchronize();
+    }
+    else
+    {
+        auto const status = cudaEventQuery(mWeightsStagedEvent.get());
+        if (status == cudaErrorNotReady)
+        {
+            return false;
+        }
+        TLLM_CUDA_CHECK(status);
+    }
+
+    // Iterations enqueued so far read the current buffers, which become standby once they are done
+    mStream->record(mWeightsReleasedEvent);
+    for (auto& [name, staged] : mStagedWeightsMap)
+    {
+        auto& current = mManagedWeightsMap.at(name);
+        std::swap(current, staged);
+        mStandbyWeightsMap.insert(std::make_pair(name, std::move(staged)));
+    }
+    mStagedWeightsMap.clear();
+    mStagedWeightsSources.clear();
+    // Bind the new addresses in all contexts with the next setInputTensors
+    mSetWeights.clear();
+    TLLM_LOG_INFO("Switched to updated managed weights");
+    return true;
+}
+
+bool TllmRuntime::adaptWeightStreamingBudget()
+{
+    // The contexts of the other runtimes sharing the engine would keep it from changing the budget
+    if (!mWeightStreamingBudget || !mWeightStreamingBudget->isAdaptive() || mEngine.use_count() > 1)
+    {
+        return false;
+    }
+    auto const [freeMem, totalMem] = common::getDeviceMemoryInfo(false);
+    auto const budget = mWeightStreamingBudget->adapt(static_cast<std::int64_t>(freeMem));
+    if (!budget)
+    {
+        return false;
+    }
+    TLLM_LOG_INFO("Adapting the weight streaming budget to %ld of %ld bytes, %zu bytes free", *budget,
+        mWeightStreamingBudget->getStreamableBytes(), freeMem);
+
+    // The contexts may still be running, and TensorRT does not change the budget while they exist
+    mStream->synchronize();
+    if (mOverlapStream)
+    {
+        mOverlapStream->synchronize();
+    }
+    std::vector<std::int32_t> profiles;
+    profiles.reserve(mContexts.size());
+    for (auto const& context : mContexts)
+    {
+        profiles.push_back(context->getOptimizationProfile());
+    }
+    auto const lanes = mContextLanes;
+    auto profileContexts = std::move(mProfileContexts);
+    clearContexts();
+    TLLM_CHECK_WITH_INFO(
+        mEngine->setWeightStreamingBudgetV2(*budget), "Failed to set the weight streaming budget to %ld", *budget);
+
+    // The scratch memory of the streamed weights is part of the context memory
+    auto const devMemorySize = mEngine->getDeviceMemorySizeV2();
+    if (static_cast<std::size_t>(devMemorySize) > mEngineBuffer->getCapacity())
+    {
+        mEngineBuffer.reset();
+        MemoryCounters::TagScope const tagScope{MemoryTag::kACTIVATIONS};
+        mEngineBuffer = mBufferManager.gpu(devMemorySize);
+        if (mOverlapEngineBuffer)
+        {
+            mOverlapEngineBuffer.reset();
+            mOverlapEngineBuffer = mBufferManager.gpu(devMemorySize);
+        }
+    }
+    for (std::size_t i = 0; i < profiles.size(); ++i)
+    {
+        addContext(profiles[i], lanes[i]);
+    }
+    mProfileContexts = std::move(profileContexts);
+    if (mLayerProfiler)
+    {
+        for (auto& context : mContexts)
+        {
+            context->setProfiler(mLayerProfiler.get());
+            context->setEnqueueEmitsProfile(false);
+        }
+    }
+    return true;
+}
+
+std::optional<executor::WeightStreamingStats> TllmRuntime::takeWeightStreamingStats()
+{
+    if (!mWeightStreamingBudget)
+    {
+        return std::nullopt;
+    }
+    return mWeightStreamingBudget->takeStats();
+}
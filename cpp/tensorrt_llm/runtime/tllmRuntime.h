@@ -17,13 +17,18 @@
 
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
 #include "tensorrt_llm/runtime/iTensor.h"
 #include "tensorrt_llm/runtime/layerProfiler.h"
+#include "tensorrt_llm/runtime/optProfileSelector.h"
 #include "tensorrt_llm/runtime/rawEngine.h"
+#include "tensorrt_llm/runtime/weightStreamingBudget.h"
 #include <NvInferRuntime.h>
 
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
@@ -69,16 +74,40 @@ public:
         return optProfileId;
     }
 
-    nvinfer1::IExecutionContext& addContext(std::int32_t profileIndex);
+    /// @param lane The communication lane the context runs on, see executeContexts. Contexts of different lanes have
+    /// separate device memory.
+    nvinfer1::IExecutionContext& addContext(std::int32_t profileIndex, SizeType32 lane = 0);
 
     void clearContexts();
 
+    /// @brief The context of a profile, created on first use. Every profile keeps its context and the tensors bound
+    /// to it, so switching between profiles from one iteration to the next costs nothing.
+    /// @param lane Every communication lane has contexts of its own, see executeContexts
+    /// @return The context index
+    SizeType32 getProfileContext(SizeType32 profileIndex, SizeType32 lane = 0);
+
+    /// @brief Select the profile for the shape of a batch, see OptProfileSelector, and return its context.
+    /// @param numTokens Tokens of the batch, context and generation
+    /// @param numSequences Sequences of the batch, one per generation beam
+    /// @param numContextRequests Requests of the batch in the context phase
+    /// @param lane The communication lane of the context
+    /// @return The context index
+    SizeType32 selectContext(
+        SizeType32 numTokens, SizeType32 numSequences, SizeType32 numContextRequests, SizeType32 lane = 0);
+
     void setInputTensors(SizeType32 contextIndex, TensorMap const& tensorMap);
 
     void setOutputTensors(SizeType32 contextIndex, TensorMap& tensorMap);
 
     bool executeContext(SizeType32 contextIndex) const;
 
+    /// @brief Run the two micro batches of a step concurrently, see DualMicroBatchSplitter. The first runs on the
+    /// stream of the runtime, the second on an overlap stream, so the collectives of one overlap the compute of the
+    /// other. Both wait for the work enqueued on the stream before, and the work enqueued after waits for both.
+    /// @param contextIndex A context of lane 0
+    /// @param overlapContextIndex A context of lane 1, with tensors of its own set on it
+    bool executeContexts(SizeType32 contextIndex, SizeType32 overlapContextIndex) const;
+
     CudaStream const& getStream() const;
 
     BufferManager::CudaStreamPtr getStreamPtr()
@@ -122,18 +151,78 @@ public:
     void reportToProfiler(SizeType32 contextId);
     void loadManagedWeights(RawEngine const& rawEngine, int localRank);
 
+    /// @brief The device buffers of the managed weights the next iterations read, by name.
+    [[nodiscard]] TensorMap const& getManagedWeights() const noexcept
+    {
+        return mManagedWeightsMap;
+    }
+
+    /// @brief Copy new values of managed weights into standby device buffers on a dedicated stream, so that running
+    /// iterations are not disturbed. Weights not in the map keep their current values.
+    /// @details Buffers replaced by the previous commit are reused once the iterations reading them are done, so at
+    /// most two copies of every updated weight exist. The weights must stay valid until commitManagedWeights().
+    void stageManagedWeights(std::map<std::string, executor::Tensor> const& weights);
+
+    /// @brief Switch to the staged weights between iterations. Iterations enqueued after this read the new weights.
+    /// @param blocking Wait for the staging copies if they are not done yet
+    /// @return True if weights were switched, false if nothing was staged or the copies are still running
+    bool commitManagedWeights(bool blocking = true);
+
+    [[nodiscard]] bool hasStagedManagedWeights() const noexcept
+    {
+        return !mStagedWeightsMap.empty();
+    }
+
+    /// @brief Adapt the weight streaming budget to the free device memory, see WeightStreamingBudget. Call between
+    /// iterations, with nothing enqueued that is still needed: TensorRT only changes the budget of an engine without
+    /// execution contexts, so they are recreated for the same profiles, and tensors must be set on them again. The
+    /// budget of an engine shared with other runtimes stays fixed.
+    /// @return True if the budget changed
+    bool adaptWeightStreamingBudget();
+
+    /// @brief The weight streaming stats since the previous call, std::nullopt if the engine does not stream weights.
+    [[nodiscard]] std::optional<executor::WeightStreamingStats> takeWeightStreamingStats();
+
 private:
+    struct BoundInput
+    {
+        void const* data{nullptr};
+        nvinfer1::Dims shape{-1, {}};
+    };
+
     BufferManager::CudaStreamPtr mStream;
     BufferManager mBufferManager;
-    std::unique_ptr<nvinfer1::IRuntime> mRuntime;
-    std::unique_ptr<nvinfer1::ICudaEngine> mEngine;
+    // Shared with the other runtimes of the engine, see EngineRegistry
+    std::shared_ptr<nvinfer1::ICudaEngine> mEngine;
     BufferManager::IBufferPtr mEngineBuffer;
     std::vector<std::unique_ptr<nvinfer1::IExecutionContext>> mContexts;
+    // Communication lane of every context
+    std::vector<SizeType32> mContextLanes;
+    // Device memory and stream of the contexts of lane 1, created with the first of them
+    BufferManager::IBufferPtr mOverlapEngineBuffer;
+    BufferManager::CudaStreamPtr mOverlapStream;
+    CudaEvent mOverlapStartEvent;
+    CudaEvent mOverlapDoneEvent;
     std::unique_ptr<ITensor> mDummyTensor;
     std::unique_ptr<nvinfer1::IEngineInspector> mEngineInspector;
     std::unique_ptr<LayerProfiler> mLayerProfiler;
     bool mUseShapeInference;
     TensorMap mManagedWeightsMap{};
     std::set<SizeType32> mSetWeights;
+    // Double buffering of managed weight updates
+    BufferManager::CudaStreamPtr mWeightsStream;
+    TensorMap mStagedWeightsMap{};
+    TensorMap mStandbyWeightsMap{};
+    std::vector<executor::Tensor> mStagedWeightsSources;
+    CudaEvent mWeightsStagedEvent;
+    CudaEvent mWeightsReleasedEvent;
+    // Set when the engine streams weights
+    std::unique_ptr<WeightStreamingBudget> mWeightStreamingBudget;
+    // Per profile selection, created on first use
+    std::optional<OptProfileSelector> mProfileSelector;
+    // Context of every profile by lane, lane * nbProfiles + profileIndex, -1 until created by getProfileContext
+    std::vector<SizeType32> mProfileContexts;
+    // Inputs last set on every context, by IO tensor index, to skip rebinding them
+    std::vector<std::vector<BoundInput>> mBoundInputs;
 };
 } // namespace tensorrt_llm::runtime
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/tokenBitmaskBuilder.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tensorrt_llm::runtime
+{
+
+ByteDfa::ByteDfa(SizeType32 numStates, StateType initialState)
+    : mInitialState{initialState}
+    , mAccepting(numStates, false)
+{
+    TLLM_CHECK_WITH_INFO(numStates > 0, "Automaton must have at least one state");
+    TLLM_CHECK_WITH_INFO(0 <= initialState && initialState < numStates, "Initial state %d out of range [0, %d)",
+        initialState, numStates);
+    std::array<StateType, 256> dead;
+    dead.fill(kDeadState);
+    mTransitions.assign(numStates, dead);
+}
+
+void ByteDfa::addTransition(StateType from, std::uint8_t byte, StateType to)
+{
+    TLLM_CHECK_WITH_INFO(0 <= from && from < getNumStates(), "State %d out of range", from);
+    TLLM_CHECK_WITH_INFO(to == kDeadState || (0 <= to && to < getNumStates()), "State %d out of range", to);
+    mTransitions[from][byte] = to;
+}
+
+void ByteDfa::setAccepting(StateType state, bool accepting)
+{
+    TLLM_CHECK_WITH_INFO(0 <= state && state < getNumStates(), "State %d out of range", state);
+    mAccepting[state] = accepting;
+}
+
+ByteDfa::StateType ByteDfa::step(StateType state, std::string_view bytes) const
+{
+    for (auto const byte : bytes)
+    {
+        if (state == kDeadState)
+        {
+            break;
+        }
+        state = mTransitions[state][static_cast<std::uint8_t>(byte)];
+    }
+    return state;
+}
+
+bool ByteDfa::isAccepting(StateType state) const
+{
+    return state != kDeadState && mAccepting.at(state);
+}
+
+TokenBitmaskBuilder::TokenBitmaskBuilder(
+    std::shared_ptr<ByteDfa const> dfa, std::vector<std::string> tokenBytes, TokenIdType endId)
+    : mDfa{std::move(dfa)}
+    , mTokenBytes{std::move(tokenBytes)}
+    , mEndId{endId}
+{
+    TLLM_CHECK_WITH_INFO(mDfa, "Automaton must not be null");
+    TLLM_CHECK_WITH_INFO(0 <= endId && endId < getVocabSize(), "End id %d out of vocabulary", endId);
+}
+
+TokenBitmaskBuilder::StateType TokenBitmaskBuilder::advance(StateType state, TokenIdType token) const
+{
+    if (token == mEndId)
+    {
+        return mDfa->isAccepting(state) ? state : ByteDfa::kDeadState;
+    }
+    auto const& bytes = mTokenBytes.at(token);
+    return bytes.empty() ? ByteDfa::kDeadState : mDfa->step(state, bytes);
+}
+
+void TokenBitmaskBuilder::fillBitmask(StateType state, std::int32_t* bitmask) const
+{
+    auto const bitmaskSize = getBitmaskSize();
+    std::shared_ptr<std::vector<std::int32_t> const> cached;
+    {
+        std::lock_guard<std::mutex> lock(mCacheMutex);
+        auto const it = mCache.find(state);
+        if (it != mCache.end())
+        {
+            cached = it->second;
+        }
+    }
+    if (!cached)
+    {
+        // Computed outside the lock, two workers may race on a new state but produce the same mask.
+        std::vector<std::uint32_t> words(bitmaskSize, 0);
+        if (state != ByteDfa::kDeadState)
+        {
+            for (TokenIdType token = 0; token < getVocabSize(); ++token)
+            {
+                if (advance(state, token) != ByteDfa::kDeadState)
+                {
+                    words[token / 32] |= 1u << (token % 32);
+                }
+            }
+        }
+        auto mask = std::make_shared<std::vector<std::int32_t>>(bitmaskSize);
+        std::memcpy(mask->data(), words.data(), bitmaskSize * sizeof(std::uint32_t));
+        std::lock_guard<std::mutex> lock(mCacheMutex);
+        cached = mCache.emplace(state, std::move(mask)).first->second;
+    }
+    std::copy(cached->begin(), cached->end(), bitmask);
+}
+
+std::vector<std::future<void>> TokenBitmaskBuilder::fillBitmasksAsync(
+    WorkerPool& pool, std::vector<StateType> const& states, std::int32_t* bitmask) const
+{
+    std::vector<std::future<void>> futures;
+    futures.reserve(states.size());
+    auto const bitmaskSize = getBitmaskSize();
+    for (std::size_t i = 0; i < states.size(); ++i)
+    {
+        futures.emplace_back(pool.enqueue([this, state = states[i], row = bitmask + i * bitmaskSize]()
+            { fillBitmask(state, row); }));
+    }
+    return futures;
+}
+
+} // namespace tensorrt_llm::runtime
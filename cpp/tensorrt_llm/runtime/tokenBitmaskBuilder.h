@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/workerPool.h"
+
+#include <array>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Deterministic automaton over bytes, the compiled form of a grammar or regex used for constrained decoding.
+class ByteDfa
+{
+public:
+    using StateType = SizeType32;
+
+    static StateType constexpr kDeadState = -1;
+
+    explicit ByteDfa(SizeType32 numStates, StateType initialState = 0);
+
+    void addTransition(StateType from, std::uint8_t byte, StateType to);
+
+    void setAccepting(StateType state, bool accepting = true);
+
+    //! \brief The state after consuming bytes from state, kDeadState if any byte is rejected.
+    [[nodiscard]] StateType step(StateType state, std::string_view bytes) const;
+
+    [[nodiscard]] bool isAccepting(StateType state) const;
+
+    [[nodiscard]] StateType getInitialState() const noexcept
+    {
+        return mInitialState;
+    }
+
+    [[nodiscard]] SizeType32 getNumStates() const noexcept
+    {
+        return static_cast<SizeType32>(mAccepting.size());
+    }
+
+private:
+    StateType mInitialState;
+    //! [numStates][256]
+    std::vector<std::array<StateType, 256>> mTransitions;
+    std::vector<bool> mAccepting;
+};
+
+//! \brief Computes the packed vocabulary bitmask of a constrained request from the state of its automaton.
+//! \details Bit v % 32 of word v / 32 is set if token v keeps the automaton alive. The end token is only allowed in
+//! accepting states. Masks are cached per state, so a builder is shared by all requests using the same automaton and
+//! tokenizer. The layout matches kernels::invokeApplyTokenBitmask.
+class TokenBitmaskBuilder
+{
+public:
+    using StateType = ByteDfa::StateType;
+
+    //! \param tokenBytes [vocabSize] byte sequence of each token, empty for special tokens that are never allowed
+    TokenBitmaskBuilder(std::shared_ptr<ByteDfa const> dfa, std::vector<std::string> tokenBytes, TokenIdType endId);
+
+    //! \brief The state after accepting token in state.
+    [[nodiscard]] StateType advance(StateType state, TokenIdType token) const;
+
+    //! \brief Write the bitmask of state to bitmask, which holds getBitmaskSize() words.
+    void fillBitmask(StateType state, std::int32_t* bitmask) const;
+
+    //! \brief Fill one bitmask row per state on the pool, e.g. while the forward pass of the iteration runs.
+    //! \param bitmask [states.size(), getBitmaskSize()], must outlive the returned futures
+    [[nodiscard]] std::vector<std::future<void>> fillBitmasksAsync(
+        WorkerPool& pool, std::vector<StateType> const& states, std::int32_t* bitmask) const;
+
+    [[nodiscard]] SizeType32 getVocabSize() const noexcept
+    {
+        return static_cast<SizeType32>(mTokenBytes.size());
+    }
+
+    [[nodiscard]] SizeType32 getBitmaskSize() const noexcept
+    {
+        return getBitmaskSize(getVocabSize());
+    }
+
+    [[nodiscard]] static SizeType32 getBitmaskSize(SizeType32 vocabSize) noexcept
+    {
+        return (vocabSize + 31) / 32;
+    }
+
+private:
+    std::shared_ptr<ByteDfa const> mDfa;
+    std::vector<std::string> mTokenBytes;
+    TokenIdType mEndId;
+
+    mutable std::mutex mCacheMutex;
+    mutable std::unordered_map<StateType, std::shared_ptr<std::vector<std::int32_t> const>> mCache;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/topLogProbsCollector.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/nvtxUtils.h"
+#include "tensorrt_llm/kernels/topLogProbsKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <cuda_fp16.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+template <typename T>
+void launchTopLogProbs(ITensor const& logits, SizeType32 numRows, SizeType32 vocabSize, SizeType32 numTopLogProbs,
+    ITensor& ids, ITensor& logProbs, CudaStream const& stream)
+{
+    kernels::TopLogProbsKernelParams<T> params;
+    params.logits = bufferCast<T>(logits);
+    params.outputIds = bufferCast<TokenIdType>(ids);
+    params.outputLogProbs = bufferCast<float>(logProbs);
+    params.batchSize = numRows;
+    params.maxBatchSize = numRows;
+    params.vocabSize = vocabSize;
+    params.vocabSizePadded = static_cast<SizeType32>(logits.getSize() / numRows);
+    params.maxNumTopLogProbs = numTopLogProbs;
+    kernels::invokeTopLogProbs(params, stream.get());
+}
+
+} // namespace
+
+TopLogProbsCollector::TopLogProbsCollector(
+    SizeType32 vocabSize, SizeType32 numTopLogProbs, std::optional<executor::LogitsPostProcessor> processor)
+    : mVocabSize{vocabSize}
+    , mNumTopLogProbs{numTopLogProbs}
+    , mProcessor{std::move(processor)}
+{
+    TLLM_CHECK_WITH_INFO(vocabSize > 0, "vocabSize must be positive");
+    TLLM_CHECK_WITH_INFO(numTopLogProbs > 0 && numTopLogProbs <= kernels::TOP_LOG_PROBS_MAX,
+        "numTopLogProbs must be in [1, %d], got %d", kernels::TOP_LOG_PROBS_MAX, numTopLogProbs);
+    TLLM_CHECK_WITH_INFO(numTopLogProbs <= vocabSize, "numTopLogProbs must not exceed vocabSize");
+}
+
+executor::LogitsPostProcessor TopLogProbsCollector::getLogitsPostProcessor()
+{
+    return [this](IdType requestId, executor::Tensor& logits, executor::BeamTokens const& beamTokens,
+               executor::StreamPtr const& stream, std::optional<IdType> clientId)
+    { process(requestId, logits, beamTokens, stream, clientId); };
+}
+
+void TopLogProbsCollector::process(IdType requestId, executor::Tensor& logits, executor::BeamTokens const& beamTokens,
+    executor::StreamPtr const& stream, std::optional<IdType> clientId)
+{
+    TLLM_NVTX_SCOPED_RANGE(kRESPONSE, collectTopLogProbs);
+    if (mProcessor)
+    {
+        (*mProcessor)(requestId, logits, beamTokens, stream, clientId);
+    }
+
+    auto const& tensor = executor::detail::toITensor(logits);
+    auto const& shape = tensor->getShape();
+    TLLM_CHECK_WITH_INFO(shape.nbDims > 0 && shape.d[shape.nbDims - 1] >= mVocabSize,
+        "Expected logits of at least %d tokens in the last dimension", mVocabSize);
+    // One row per beam, [beamWidth, vocabSizePadded] or any leading shape of the same size
+    auto const numRows = static_cast<SizeType32>(tensor->getSize() / shape.d[shape.nbDims - 1]);
+
+    BufferManager manager{stream};
+    auto const outputShape = ITensor::makeShape({numRows, mNumTopLogProbs});
+    auto ids = manager.gpu(outputShape, nvinfer1::DataType::kINT32);
+    auto logProbs = manager.gpu(outputShape, nvinfer1::DataType::kFLOAT);
+    switch (tensor->getDataType())
+    {
+    case nvinfer1::DataType::kFLOAT:
+        launchTopLogProbs<float>(*tensor, numRows, mVocabSize, mNumTopLogProbs, *ids, *logProbs, *stream);
+        break;
+    case nvinfer1::DataType::kHALF:
+        launchTopLogProbs<half>(*tensor, numRows, mVocabSize, mNumTopLogProbs, *ids, *logProbs, *stream);
+        break;
+    default: TLLM_THROW("Top log probabilities are only supported for float and half logits");
+    }
+
+    Step step{BufferManager::pinnedPool(outputShape, nvinfer1::DataType::kINT32),
+        BufferManager::pinnedPool(outputShape, nvinfer1::DataType::kFLOAT), CudaEvent{}};
+    manager.copy(*ids, *step.ids);
+    manager.copy(*logProbs, *step.logProbs);
+    stream->record(step.copied);
+
+    std::lock_guard<std::mutex> lock{mMutex};
+    mPending[requestId].push_back(std::move(step));
+}
+
+TopLogProbsCollector::BeamTopLogProbs TopLogProbsCollector::take(IdType requestId)
+{
+    std::deque<Step> steps;
+    {
+        std::lock_guard<std::mutex> lock{mMutex};
+        auto it = mPending.find(requestId);
+        if (it == mPending.end())
+        {
+            return {};
+        }
+        steps = std::move(it->second);
+        mPending.erase(it);
+    }
+
+    BeamTopLogProbs result;
+    for (auto const& step : steps)
+    {
+        step.copied.synchronize();
+        auto const numRows = static_cast<SizeType32>(step.ids->getShape().d[0]);
+        // The context step may be post processed with fewer beams than the generation steps
+        if (static_cast<SizeType32>(result.size()) < numRows)
+        {
+            result.resize(numRows);
+        }
+        auto const* ids = bufferCast<TokenIdType>(*step.ids);
+        auto const* logProbs = bufferCast<float>(*step.logProbs);
+        for (SizeType32 row = 0; row < numRows; ++row)
+        {
+            auto const offset = row * mNumTopLogProbs;
+            executor::TopLogProbs top;
+            top.tokens.assign(ids + offset, ids + offset + mNumTopLogProbs);
+            top.logProbs.assign(logProbs + offset, logProbs + offset + mNumTopLogProbs);
+            result[row].push_back(std::move(top));
+        }
+    }
+    return result;
+}
+
+void TopLogProbsCollector::erase(IdType requestId)
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    mPending.erase(requestId);
+}
+
+} // namespace tensorrt_llm::runtime
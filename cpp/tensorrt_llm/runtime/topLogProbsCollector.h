@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/tensor.h"
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Collects the top-N log probabilities of every generated token through a logits post processor.
+//! \details Register getLogitsPostProcessor() in the executor's LogitsPostProcessorConfig and set its name on the
+//! requests that want alternatives. Every step, invokeTopLogProbs selects the N most likely tokens of each beam on the
+//! stream of the step and only these pairs are copied to pinned memory, so no generation logits reach the host.
+//! take() returns the alternatives of the steps run since its last call, e.g. next to each response of the request.
+class TopLogProbsCollector
+{
+public:
+    using IdType = executor::IdType;
+    //! [beamWidth, numSteps]
+    using BeamTopLogProbs = std::vector<std::vector<executor::TopLogProbs>>;
+
+    //! \param vocabSize Number of valid logits per row, padding columns are ignored.
+    //! \param numTopLogProbs Number of alternatives per token, at most kernels::TOP_LOG_PROBS_MAX.
+    //! \param processor Optional post processor applied to the logits first, so that the alternatives reflect it.
+    TopLogProbsCollector(SizeType32 vocabSize, SizeType32 numTopLogProbs,
+        std::optional<executor::LogitsPostProcessor> processor = std::nullopt);
+
+    //! \brief The post processor to register. It must not outlive the collector.
+    [[nodiscard]] executor::LogitsPostProcessor getLogitsPostProcessor();
+
+    //! \brief Take the alternatives of the steps of a request collected since the last call, waiting for their copies.
+    [[nodiscard]] BeamTopLogProbs take(IdType requestId);
+
+    //! \brief Drop the pending steps of a request, e.g. once it finished or was cancelled.
+    void erase(IdType requestId);
+
+private:
+    struct Step
+    {
+        ITensor::SharedPtr ids;
+        ITensor::SharedPtr logProbs;
+        CudaEvent copied;
+    };
+
+    void process(IdType requestId, executor::Tensor& logits, executor::BeamTokens const& beamTokens,
+        executor::StreamPtr const& stream, std::optional<IdType> clientId);
+
+    SizeType32 mVocabSize;
+    SizeType32 mNumTopLogProbs;
+    std::optional<executor::LogitsPostProcessor> mProcessor;
+
+    std::mutex mMutex;
+    std::unordered_map<IdType, std::deque<Step>> mPending;
+};
+
+} // namespace tensorrt_llm::runtime
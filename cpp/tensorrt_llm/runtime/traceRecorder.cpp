@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/traceRecorder.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+double toMicroseconds(TraceRecorder::Clock::duration duration)
+{
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+common::nvtx::Category getSpanCategory(std::string const& name)
+{
+    using common::nvtx::Category;
+    if (name == TraceRecorder::kSCHEDULING)
+    {
+        return Category::kSCHEDULER;
+    }
+    if (name == TraceRecorder::kDECODE)
+    {
+        return Category::kDECODER;
+    }
+    if (name == TraceRecorder::kRESPONSE)
+    {
+        return Category::kRESPONSE;
+    }
+    return Category::kEXECUTOR;
+}
+} // namespace
+
+TraceRecorder::ScopedSpan::ScopedSpan(std::string name, Lane lane, std::optional<executor::IterationType> iteration,
+    std::optional<common::nvtx::BatchComposition> const& batch, TraceRecorder& recorder)
+    : mRecorder{recorder}
+    , mLane{lane}
+    , mIteration{iteration}
+    , mNvtxRange{common::nvtx::isProfilerAttached() ? getSpanCategory(name) : common::nvtx::Category::kEXECUTOR,
+          name.c_str(), iteration, batch}
+{
+    if (recorder.isEnabled())
+    {
+        mName = std::move(name);
+        mStart = Clock::now();
+    }
+}
+
+TraceRecorder::ScopedSpan::~ScopedSpan()
+{
+    if (mName)
+    {
+        mRecorder.recordSpan(std::move(*mName), mLane, mStart, Clock::now(), mIteration);
+    }
+}
+
+TraceRecorder& TraceRecorder::getInstance()
+{
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+void TraceRecorder::start(std::size_t maxEvents)
+{
+    TLLM_CHECK_WITH_INFO(maxEvents > 0, "The trace buffer must hold at least one event");
+    std::lock_guard<std::mutex> const lock(mMutex);
+    mEvents.clear();
+    mEvents.reserve(maxEvents);
+    mCapacity = maxEvents;
+    mNext = 0;
+    mNumDropped = 0;
+    mEnabled.store(true, std::memory_order_relaxed);
+}
+
+void TraceRecorder::stop()
+{
+    mEnabled.store(false, std::memory_order_relaxed);
+}
+
+void TraceRecorder::setProcessId(std::int32_t processId)
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    mProcessId = processId;
+}
+
+void TraceRecorder::push(Event event)
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    if (mCapacity == 0)
+    {
+        return;
+    }
+    if (mEvents.size() < mCapacity)
+    {
+        mEvents.push_back(std::move(event));
+    }
+    else
+    {
+        mEvents[mNext] = std::move(event);
+        ++mNumDropped;
+    }
+    mNext = (mNext + 1) % mCapacity;
+}
+
+void TraceRecorder::recordSpan(std::string name, Lane lane, Clock::time_point start, Clock::time_point end,
+    std::optional<executor::IterationType> iteration)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    push(Event{Type::kSPAN, lane, std::move(name), start, toMicroseconds(end - start), iteration});
+}
+
+void TraceRecorder::recordLayerTimes(
+    std::vector<std::pair<std::string, float>> const& layerTimesMs, Clock::time_point end)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    auto const toDuration = [](float timeMs)
+    { return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(timeMs)); };
+    auto start = end;
+    for (auto const& layer : layerTimesMs)
+    {
+        start -= toDuration(layer.second);
+    }
+    for (auto const& [name, timeMs] : layerTimesMs)
+    {
+        push(Event{Type::kSPAN, Lane::kLAYERS, name, start, timeMs * 1000.0, std::nullopt});
+        start += toDuration(timeMs);
+    }
+}
+
+void TraceRecorder::recordRequestFlow(executor::IdType requestId, FlowPoint point, Clock::time_point time)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    auto const type = point == FlowPoint::kBEGIN ? Type::kFLOW_BEGIN
+        : point == FlowPoint::kSTEP              ? Type::kFLOW_STEP
+                                                 : Type::kFLOW_END;
+    push(Event{type, Lane::kITERATION, "request", time, 0.0, requestId});
+}
+
+std::uint64_t TraceRecorder::getNumDropped() const
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    return mNumDropped;
+}
+
+std::string TraceRecorder::toChromeTrace() const
+{
+    std::lock_guard<std::mutex> const lock(mMutex);
+    auto events = nlohmann::json::array();
+    for (auto const& [lane, laneName] : {std::pair{Lane::kITERATION, "executor"}, std::pair{Lane::kLAYERS, "layers"}})
+    {
+        events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", mProcessId},
+            {"tid", static_cast<std::int32_t>(lane)}, {"args", {{"name", laneName}}}});
+    }
+
+    // Oldest first: once the buffer wrapped, the oldest event is the next one to be overwritten
+    auto const first = mEvents.size() < mCapacity ? 0 : mNext;
+    for (std::size_t i = 0; i < mEvents.size(); ++i)
+    {
+        auto const& event = mEvents[(first + i) % mEvents.size()];
+        nlohmann::json json{{"name", event.name}, {"pid", mProcessId}, {"tid", static_cast<std::int32_t>(event.lane)},
+            {"ts", toMicroseconds(event.start.time_since_epoch())}};
+        switch (event.type)
+        {
+        case Type::kSPAN:
+            json["ph"] = "X";
+            json["cat"] = event.lane == Lane::kLAYERS ? "layer" : "executor";
+            json["dur"] = event.durationUs;
+            if (event.id)
+            {
+                json["args"] = {{"iteration", *event.id}};
+            }
+            break;
+        case Type::kFLOW_BEGIN:
+        case Type::kFLOW_STEP:
+        case Type::kFLOW_END:
+            json["ph"] = event.type == Type::kFLOW_BEGIN ? "s" : event.type == Type::kFLOW_STEP ? "t" : "f";
+            json["cat"] = "request";
+            json["id"] = *event.id;
+            // Bind to the enclosing iteration span rather than the next one
+            json["bp"] = "e";
+            break;
+        }
+        events.push_back(std::move(json));
+    }
+
+    nlohmann::json trace{{"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"}};
+    trace["otherData"] = {{"dropped_events", mNumDropped}};
+    return trace.dump();
+}
+
+void TraceRecorder::writeChromeTrace(std::filesystem::path const& path) const
+{
+    std::ofstream file(path);
+    TLLM_CHECK_WITH_INFO(file.is_open(), "Error opening file '%s' for writing.", path.string().c_str());
+    file << toChromeTrace() << "\n";
+}
+
+} // namespace tensorrt_llm::runtime
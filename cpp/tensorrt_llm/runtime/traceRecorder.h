@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/nvtxUtils.h"
+#include "tensorrt_llm/executor/types.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Records a timeline of executor iterations, engine layers and requests into a ring buffer, and exports it
+//! as Chrome trace JSON for Perfetto or chrome://tracing.
+//! \details Recording is off by default and every record call returns after one relaxed load then. Once started, the
+//! buffer keeps the last maxEvents events, so tracing can stay on for a while in production and be dumped right after
+//! a latency outlier. The recorder of the process is a singleton, as the executor loop, the engine runtime and the
+//! layer profiler that feed it are created apart.
+class TraceRecorder
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    //! \brief The rows of the timeline.
+    enum class Lane : std::int32_t
+    {
+        //! Iteration spans and their phases: scheduling, forward, decode, response
+        kITERATION = 0,
+        //! Per layer times reported by the TensorRT profiler
+        kLAYERS = 1,
+    };
+
+    //! \brief Where a request is in its lifetime, the points of a request are linked by flow arrows.
+    enum class FlowPoint : std::int8_t
+    {
+        kBEGIN,
+        kSTEP,
+        kEND,
+    };
+
+    // Names of the spans of an executor iteration
+    static constexpr char const* kITERATION = "iteration";
+    static constexpr char const* kSCHEDULING = "scheduling";
+    static constexpr char const* kFORWARD = "forward";
+    static constexpr char const* kDECODE = "decode";
+    static constexpr char const* kRESPONSE = "response";
+
+    //! \brief Times a span from construction to destruction, if the recorder is enabled at construction.
+    //! \details Under an NVTX profiler, the span is also an NVTX range of the TensorRT-LLM domain, carrying the
+    //! iteration as payload and the batch composition in its message.
+    class ScopedSpan
+    {
+    public:
+        explicit ScopedSpan(std::string name, Lane lane = Lane::kITERATION,
+            std::optional<executor::IterationType> iteration = std::nullopt,
+            std::optional<common::nvtx::BatchComposition> const& batch = std::nullopt,
+            TraceRecorder& recorder = getInstance());
+
+        ~ScopedSpan();
+
+        ScopedSpan(ScopedSpan const&) = delete;
+        ScopedSpan& operator=(ScopedSpan const&) = delete;
+
+    private:
+        TraceRecorder& mRecorder;
+        std::optional<std::string> mName;
+        Lane mLane;
+        std::optional<executor::IterationType> mIteration;
+        Clock::time_point mStart;
+        common::nvtx::ScopedRange mNvtxRange;
+    };
+
+    static TraceRecorder& getInstance();
+
+    //! \brief Clear the buffer and start recording, keeping the last maxEvents events.
+    void start(std::size_t maxEvents);
+
+    //! \brief Stop recording. The buffer is kept for toChromeTrace.
+    void stop();
+
+    [[nodiscard]] bool isEnabled() const noexcept
+    {
+        return mEnabled.load(std::memory_order_relaxed);
+    }
+
+    //! \brief The pid of the events, e.g. the rank, so that the traces of several ranks can be merged.
+    void setProcessId(std::int32_t processId);
+
+    void recordSpan(std::string name, Lane lane, Clock::time_point start, Clock::time_point end,
+        std::optional<executor::IterationType> iteration = std::nullopt);
+
+    //! \brief Record the layer times of one engine execution, ending at end.
+    //! \details The TensorRT profiler reports durations only, the layers are laid out back to back, so their
+    //! positions are exact only when the GPU ran them without gaps.
+    void recordLayerTimes(std::vector<std::pair<std::string, float>> const& layerTimesMs, Clock::time_point end);
+
+    //! \brief Mark a point of a request. It binds to the iteration span enclosing time.
+    void recordRequestFlow(executor::IdType requestId, FlowPoint point, Clock::time_point time);
+
+    //! \brief Events overwritten since start because the buffer was full.
+    [[nodiscard]] std::uint64_t getNumDropped() const;
+
+    //! \brief The buffered events, oldest first, as a Chrome trace JSON object.
+    [[nodiscard]] std::string toChromeTrace() const;
+
+    void writeChromeTrace(std::filesystem::path const& path) const;
+
+private:
+    enum class Type : std::int8_t
+    {
+        kSPAN,
+        kFLOW_BEGIN,
+        kFLOW_STEP,
+        kFLOW_END,
+    };
+
+    struct Event
+    {
+        Type type;
+        Lane lane;
+        std::string name;
+        Clock::time_point start;
+        double durationUs;
+        // Iteration of a span, request id of a flow
+        std::optional<std::uint64_t> id;
+    };
+
+    void push(Event event);
+
+    std::atomic<bool> mEnabled{false};
+    mutable std::mutex mMutex;
+    std::vector<Event> mEvents;
+    std::size_t mCapacity{0};
+    std::size_t mNext{0};
+    std::uint64_t mNumDropped{0};
+    std::int32_t mProcessId{0};
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/uvmPrefetcher.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+void addRange(std::vector<UvmPrefetcher::Range>& ranges, void const* ptr, std::size_t size)
+{
+    if (size > 0)
+    {
+        auto const begin = reinterpret_cast<std::uintptr_t>(ptr);
+        ranges.push_back(UvmPrefetcher::Range{begin, begin + size});
+    }
+}
+
+} // namespace
+
+UvmPrefetcher::UvmPrefetcher(int device, std::size_t pageSize)
+    : mDevice{device}
+    , mPageSize{pageSize}
+{
+    TLLM_CHECK_WITH_INFO(mPageSize > 0 && (mPageSize & (mPageSize - 1)) == 0, "The page size must be a power of 2");
+    int concurrentManagedAccess{0};
+    TLLM_CUDA_CHECK(cudaDeviceGetAttribute(&concurrentManagedAccess, cudaDevAttrConcurrentManagedAccess, mDevice));
+    mIsSupported = concurrentManagedAccess != 0;
+    if (!mIsSupported)
+    {
+        TLLM_LOG_WARNING("Device %d has no concurrent managed access, UVM KV cache blocks are not prefetched", mDevice);
+    }
+}
+
+void UvmPrefetcher::toDevice(void const* ptr, std::size_t size)
+{
+    addRange(mToDevice, ptr, size);
+}
+
+void UvmPrefetcher::toHost(void const* ptr, std::size_t size)
+{
+    addRange(mToHost, ptr, size);
+}
+
+UvmPrefetcher::Plan UvmPrefetcher::takePlan()
+{
+    Plan plan;
+    plan.toDevice = coalesce(std::move(mToDevice));
+    plan.toHost = alignInward(subtract(coalesce(std::move(mToHost)), plan.toDevice), mPageSize);
+    mToDevice.clear();
+    mToHost.clear();
+    return plan;
+}
+
+void UvmPrefetcher::execute(CudaStream const& stream)
+{
+    auto const plan = takePlan();
+    if (!mIsSupported)
+    {
+        return;
+    }
+    // The paused blocks first, to make room for the scheduled ones
+    for (auto const& range : plan.toHost)
+    {
+        auto* ptr = reinterpret_cast<void*>(range.begin);
+        auto const size = range.end - range.begin;
+        TLLM_CUDA_CHECK(cudaMemAdvise(ptr, size, cudaMemAdviseSetPreferredLocation, cudaCpuDeviceId));
+        TLLM_CUDA_CHECK(cudaMemPrefetchAsync(ptr, size, cudaCpuDeviceId, stream.get()));
+        mNumBytesToHost += size;
+    }
+    for (auto const& range : plan.toDevice)
+    {
+        auto* ptr = reinterpret_cast<void*>(range.begin);
+        auto const size = range.end - range.begin;
+        // Replaces the host preference of blocks of requests that were paused before
+        TLLM_CUDA_CHECK(cudaMemAdvise(ptr, size, cudaMemAdviseSetPreferredLocation, mDevice));
+        TLLM_CUDA_CHECK(cudaMemPrefetchAsync(ptr, size, mDevice, stream.get()));
+        mNumBytesToDevice += size;
+    }
+}
+
+std::vector<UvmPrefetcher::Range> UvmPrefetcher::coalesce(std::vector<Range> ranges)
+{
+    std::sort(ranges.begin(), ranges.end(), [](Range const& lhs, Range const& rhs) { return lhs.begin < rhs.begin; });
+    std::vector<Range> coalesced;
+    for (auto const& range : ranges)
+    {
+        if (!coalesced.empty() && range.begin <= coalesced.back().end)
+        {
+            coalesced.back().end = std::max(coalesced.back().end, range.end);
+        }
+        else
+        {
+            coalesced.push_back(range);
+        }
+    }
+    return coalesced;
+}
+
+std::vector<UvmPrefetcher::Range> UvmPrefetcher::subtract(
+    std::vector<Range> const& ranges, std::vector<Range> const& removed)
+{
+    std::vector<Range> remaining;
+    auto removedIt = removed.begin();
+    for (auto range : ranges)
+    {
+        // Removed ranges are sorted, the ones ending before this range end before the next ranges as well
+        while (removedIt != removed.end() && removedIt->end <= range.begin)
+        {
+            ++removedIt;
+        }
+        for (auto it = removedIt; it != removed.end() && it->begin < range.end; ++it)
+        {
+            if (it->begin > range.begin)
+            {
+                remaining.push_back(Range{range.begin, it->begin});
+            }
+            range.begin = std::max(range.begin, it->end);
+        }
+        if (range.begin < range.end)
+        {
+            remaining.push_back(range);
+        }
+    }
+    return remaining;
+}
+
+std::vector<UvmPrefetcher::Range> UvmPrefetcher::alignInward(std::vector<Range> const& ranges, std::size_t pageSize)
+{
+    std::vector<Range> aligned;
+    for (auto const& range : ranges)
+    {
+        auto const begin = (range.begin + pageSize - 1) & ~(pageSize - 1);
+        auto const end = range.end & ~(pageSize - 1);
+        if (begin < end)
+        {
+            aligned.push_back(Range{begin, end});
+        }
+    }
+    return aligned;
+}
+
+} // namespace tensorrt_llm::runtime
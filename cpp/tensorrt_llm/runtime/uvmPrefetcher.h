@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/cudaStream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Moves the pages of managed (UVM) memory ahead of their use, so that an oversubscribed UVM KV cache pool does
+//! not page-fault on the critical path.
+//! \details The caller knows what runs next: the blocks of the sequences scheduled for the next iteration are
+//! prefetched to the device while the current one runs, the blocks of paused sequences are advised towards the host,
+//! which makes them the first pages the driver evicts. Collected ranges are coalesced, and memory that is both wanted
+//! on the device and advised to the host stays on the device, e.g. a reused block shared by a paused and a scheduled
+//! sequence. Host ranges are shrunk to whole pages, so the advice never covers a page of a device range.
+class UvmPrefetcher
+{
+public:
+    //! Bytes [begin, end)
+    struct Range
+    {
+        std::uintptr_t begin;
+        std::uintptr_t end;
+    };
+
+    struct Plan
+    {
+        std::vector<Range> toDevice;
+        std::vector<Range> toHost;
+    };
+
+    //! \param pageSize Granularity of the host advice, the largest page size the driver migrates
+    explicit UvmPrefetcher(int device, std::size_t pageSize = std::size_t{64} << 10);
+
+    //! \brief Memory that is read on the device soon.
+    void toDevice(void const* ptr, std::size_t size);
+
+    //! \brief Memory that is not read for a while.
+    void toHost(void const* ptr, std::size_t size);
+
+    //! \brief The coalesced ranges collected since the last plan, and start collecting anew.
+    [[nodiscard]] Plan takePlan();
+
+    //! \brief Enqueue the prefetches and advice of the collected ranges on stream. A no-op on devices without
+    //! concurrent managed access, where managed memory cannot be prefetched.
+    void execute(CudaStream const& stream);
+
+    //! \brief Bytes prefetched to the device and to the host over all executions.
+    [[nodiscard]] std::size_t getNumBytesToDevice() const noexcept
+    {
+        return mNumBytesToDevice;
+    }
+
+    [[nodiscard]] std::size_t getNumBytesToHost() const noexcept
+    {
+        return mNumBytesToHost;
+    }
+
+    //! \brief Sorted ranges with overlapping and adjacent ones merged.
+    [[nodiscard]] static std::vector<Range> coalesce(std::vector<Range> ranges);
+
+    //! \brief The parts of ranges outside of removed, both coalesced.
+    [[nodiscard]] static std::vector<Range> subtract(
+        std::vector<Range> const& ranges, std::vector<Range> const& removed);
+
+    //! \brief The whole pages of every range, ranges without a whole page are dropped.
+    [[nodiscard]] static std::vector<Range> alignInward(std::vector<Range> const& ranges, std::size_t pageSize);
+
+private:
+    int mDevice;
+    std::size_t mPageSize;
+    bool mIsSupported;
+    std::vector<Range> mToDevice;
+    std::vector<Range> mToHost;
+    std::size_t mNumBytesToDevice{0};
+    std::size_t mNumBytesToHost{0};
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/warmupPlanner.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/startupProfiler.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+//! \brief Enqueue the requests of batch and wait for all of them to complete.
+void runBatch(executor::Executor& executor, WarmupPlanner::Batch const& batch, SizeType32 outputLength,
+    SizeType32& requestCounter)
+{
+    std::vector<executor::Request> requests;
+    requests.reserve(batch.batchSize);
+    for (SizeType32 i = 0; i < batch.batchSize; ++i)
+    {
+        auto const offset = requestCounter++ * 7;
+        executor::VecTokens tokens(batch.inputLength);
+        for (SizeType32 t = 0; t < batch.inputLength; ++t)
+        {
+            tokens[t] = 1 + (offset + t * 13) % (WarmupPlanner::kMaxTokenId - 1);
+        }
+        requests.emplace_back(std::move(tokens), outputLength);
+    }
+    auto const requestIds = executor.enqueueRequests(requests);
+    std::unordered_set<executor::IdType> pending(requestIds.begin(), requestIds.end());
+    while (!pending.empty())
+    {
+        for (auto const& response : executor.awaitResponses())
+        {
+            TLLM_CHECK_WITH_INFO(!response.hasError(), "Warmup request failed: %s", response.getErrorMsg().c_str());
+            if (response.getResult().isFinal)
+            {
+                pending.erase(response.getRequestId());
+            }
+        }
+    }
+}
+
+} // namespace
+
+std::vector<WarmupPlanner::Batch> WarmupPlanner::plan(std::vector<SizeType32> const& batchSizes,
+    std::vector<SizeType32> const& inputLengths, SizeType32 outputLength, Limits const& limits)
+{
+    TLLM_CHECK_WITH_INFO(outputLength > 0, "Warmup output length must be positive");
+    std::vector<Batch> batches;
+    for (auto const batchSize : batchSizes)
+    {
+        for (auto const inputLength : inputLengths)
+        {
+            auto const fits = batchSize > 0 && batchSize <= limits.maxBatchSize && inputLength > 0
+                && inputLength <= limits.maxInputLength && inputLength < limits.maxSequenceLength
+                && (limits.enableChunkedContext || !limits.maxNumTokens || inputLength <= *limits.maxNumTokens);
+            if (!fits)
+            {
+                TLLM_LOG_WARNING("Skipping warmup of batch size %d with input length %d, it exceeds the engine limits",
+                    batchSize, inputLength);
+                continue;
+            }
+            Batch batch{batchSize, inputLength, std::min(outputLength, limits.maxSequenceLength - inputLength)};
+            if (std::find(batches.begin(), batches.end(), batch) == batches.end())
+            {
+                batches.push_back(batch);
+            }
+        }
+    }
+    std::stable_sort(batches.begin(), batches.end(),
+        [](Batch const& lhs, Batch const& rhs) { return lhs.getNumContextTokens() > rhs.getNumContextTokens(); });
+    return batches;
+}
+
+executor::WarmupStats WarmupPlanner::run(
+    executor::Executor& executor, executor::WarmupConfig const& warmupConfig, Limits const& limits)
+{
+    if (!executor.canEnqueueRequests())
+    {
+        return executor::WarmupStats{};
+    }
+    auto const batches
+        = plan(warmupConfig.getBatchSizes(), warmupConfig.getInputLengths(), warmupConfig.getOutputLength(), limits);
+    WarmupPlanner planner;
+    SizeType32 requestCounter{0};
+    planner.startPhase("context");
+    for (auto const& batch : batches)
+    {
+        runBatch(executor, batch, 1, requestCounter);
+    }
+    planner.stopPhase(static_cast<SizeType32>(batches.size()));
+    planner.startPhase("generation");
+    for (auto const& batch : batches)
+    {
+        runBatch(executor, batch, batch.outputLength, requestCounter);
+    }
+    planner.stopPhase(static_cast<SizeType32>(batches.size()));
+    return planner.finish();
+}
+
+void WarmupPlanner::startPhase(std::string name)
+{
+    if (mPhaseName)
+    {
+        stopPhase(mPhaseNumBatches);
+    }
+    mPhaseName = std::move(name);
+    mPhaseNumBatches = 0;
+    mPhaseStart = Clock::now();
+    if (!mWarmupStart)
+    {
+        mWarmupStart = mPhaseStart;
+    }
+}
+
+void WarmupPlanner::stopPhase(SizeType32 numBatches)
+{
+    TLLM_CHECK_WITH_INFO(mPhaseName.has_value(), "No warmup phase running");
+    auto const durationMs = std::chrono::duration<double, std::milli>(Clock::now() - mPhaseStart).count();
+    TLLM_LOG_INFO("Warmup phase %s: %d batches in %.1f ms", mPhaseName->c_str(), numBatches, durationMs);
+    mStats.phases.push_back(executor::WarmupPhaseStats{std::move(*mPhaseName), numBatches, durationMs});
+    mStats.totalDurationMS += durationMs;
+    mPhaseName.reset();
+}
+
+executor::WarmupStats WarmupPlanner::finish()
+{
+    if (mPhaseName)
+    {
+        stopPhase(mPhaseNumBatches);
+    }
+    if (mWarmupStart)
+    {
+        common::StartupProfiler::getInstance().record(common::StartupPhase::kWARMUP, *mWarmupStart, Clock::now());
+    }
+    return std::move(mStats);
+}
+
+} // namespace tensorrt_llm::runtime
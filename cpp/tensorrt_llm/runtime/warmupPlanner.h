@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/executor/types.h"
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/modelConfig.h"
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Plans the synthetic batches of an engine warmup and times its phases.
+class WarmupPlanner
+{
+public:
+    struct Batch
+    {
+        SizeType32 batchSize;
+        SizeType32 inputLength;
+        SizeType32 outputLength;
+
+        [[nodiscard]] SizeType32 getNumContextTokens() const noexcept
+        {
+            return batchSize * inputLength;
+        }
+
+        bool operator==(Batch const& other) const noexcept
+        {
+            return batchSize == other.batchSize && inputLength == other.inputLength
+                && outputLength == other.outputLength;
+        }
+    };
+
+    struct Limits
+    {
+        SizeType32 maxBatchSize;
+        SizeType32 maxInputLength;
+        SizeType32 maxSequenceLength;
+        //! Maximum number of tokens per iteration. A request longer than that only fits with chunked context.
+        std::optional<SizeType32> maxNumTokens;
+        bool enableChunkedContext{false};
+    };
+
+    [[nodiscard]] static Limits getLimits(ModelConfig const& modelConfig, bool enableChunkedContext)
+    {
+        return Limits{modelConfig.getMaxBatchSize(), modelConfig.getMaxInputLen(), modelConfig.getMaxSequenceLen(),
+            modelConfig.getMaxNumTokens(), enableChunkedContext};
+    }
+
+    //! \brief Batches for every combination of batchSizes and inputLengths that fits limits.
+    //! \details The output length is shortened where it would exceed maxSequenceLength. Batches are ordered by
+    //! decreasing number of context tokens, so that the memory pools grow to their peak with the first batch.
+    [[nodiscard]] static std::vector<Batch> plan(std::vector<SizeType32> const& batchSizes,
+        std::vector<SizeType32> const& inputLengths, SizeType32 outputLength, Limits const& limits);
+
+    //! \brief Run the planned batches through executor, before any real request is enqueued.
+    //! \details Triggers the lazy work otherwise paid by the first requests: XQA JIT compilation, GEMM tactic
+    //! selection, CUDA graph capture and memory pool growth. The "context" phase runs every batch with a single output
+    //! token, the "generation" phase runs it again with its full output length. Each batch is enqueued at once and all
+    //! its responses are consumed, so no other thread may await responses meanwhile. The synthetic requests count in
+    //! the stats of the executor. Their prompts use token ids below kMaxTokenId and differ per request, so that they
+    //! do not hit blocks reused from one another. Returns empty stats on ranks that cannot enqueue requests.
+    [[nodiscard]] static executor::WarmupStats run(
+        executor::Executor& executor, executor::WarmupConfig const& warmupConfig, Limits const& limits);
+
+    static constexpr TokenIdType kMaxTokenId{1000};
+
+    //! \brief Start timing a phase, stopping the running one.
+    void startPhase(std::string name);
+
+    //! \brief Stop the running phase, recording numBatches batches for it.
+    void stopPhase(SizeType32 numBatches);
+
+    //! \brief Stats of the phases timed so far. Stops the running phase and accounts the warmup as a startup phase,
+    //! see common::StartupProfiler.
+    [[nodiscard]] executor::WarmupStats finish();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    executor::WarmupStats mStats{};
+    std::optional<std::string> mPhaseName;
+    Clock::time_point mPhaseStart;
+    std::optional<Clock::time_point> mWarmupStart;
+    SizeType32 mPhaseNumBatches{0};
+};
+
+} // namespace tensorrt_llm::runtime
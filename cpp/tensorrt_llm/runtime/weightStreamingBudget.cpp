@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/weightStreamingBudget.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace tensorrt_llm::runtime
+{
+
+WeightStreamingBudget::WeightStreamingBudget(std::int64_t streamableBytes, std::int64_t budgetBytes,
+    std::optional<std::int64_t> headroomBytes, std::int64_t minStepBytes)
+    : mStreamableBytes{streamableBytes}
+    , mHeadroomBytes{headroomBytes}
+    , mMinStepBytes{minStepBytes}
+    , mBudget{budgetBytes}
+{
+    TLLM_CHECK_WITH_INFO(streamableBytes > 0, "The engine has no streamable weights");
+    TLLM_CHECK_WITH_INFO(0 <= budgetBytes && budgetBytes <= streamableBytes,
+        "Weight streaming budget %ld out of range [0, %ld]", budgetBytes, streamableBytes);
+    TLLM_CHECK_WITH_INFO(!headroomBytes || *headroomBytes >= 0, "The headroom must not be negative");
+    TLLM_CHECK_WITH_INFO(minStepBytes > 0, "The minimum step must be positive");
+}
+
+std::optional<std::int64_t> WeightStreamingBudget::adapt(std::int64_t freeBytes)
+{
+    if (!mHeadroomBytes)
+    {
+        return std::nullopt;
+    }
+    // Grows by the free memory over the headroom, shrinks by the missing headroom
+    auto const budget = std::clamp(mBudget + freeBytes - *mHeadroomBytes, std::int64_t{0}, mStreamableBytes);
+    // Always take the last step to streaming nothing, it removes the copies from the forward altogether
+    auto const delta = budget - mBudget;
+    if (delta == 0 || (std::abs(delta) < mMinStepBytes && budget != mStreamableBytes))
+    {
+        return std::nullopt;
+    }
+    foldForwards();
+    mBudget = budget;
+    ++mNumBudgetChanges;
+    return budget;
+}
+
+void WeightStreamingBudget::foldForwards()
+{
+    auto const numForwards = mNumForwards.exchange(0, std::memory_order_relaxed);
+    mFoldedForwards += numForwards;
+    mFoldedStreamedBytes += static_cast<std::int64_t>(numForwards) * (mStreamableBytes - mBudget);
+}
+
+executor::WeightStreamingStats WeightStreamingBudget::takeStats()
+{
+    foldForwards();
+    executor::WeightStreamingStats stats{};
+    stats.streamableBytes = mStreamableBytes;
+    stats.budgetBytes = mBudget;
+    stats.streamedBytes = mFoldedStreamedBytes;
+    stats.numForwards = mFoldedForwards;
+    stats.numBudgetChanges = mNumBudgetChanges;
+    mFoldedForwards = 0;
+    mFoldedStreamedBytes = 0;
+    mNumBudgetChanges = 0;
+    return stats;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/executor/types.h"
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Tracks the GPU-resident budget of a weight streaming engine and adapts it to the free device memory.
+//! \details TensorRT keeps the streamable weights over the budget in host memory and copies them in, ahead of the
+//! layers reading them, during every forward pass. The fewer weights stream, the faster the forward, so a budget
+//! picked once from gpu_weights_percent leaves throughput on the table when memory frees up later, e.g. after the
+//! KV cache was sized, and risks failed allocations when memory gets tight.
+//!
+//! Between iterations, the owner reports the free device memory. With a headroom, the budget grows into the memory
+//! over the headroom and shrinks when less than the headroom is free. Changes smaller than the minimum step are
+//! ignored, since applying a budget means recreating the execution contexts.
+class WeightStreamingBudget
+{
+public:
+    //! \param streamableBytes Size of the streamable weights of the engine.
+    //! \param budgetBytes The budget the engine starts with.
+    //! \param headroomBytes Free memory to keep when adapting, std::nullopt to keep the budget fixed.
+    //! \param minStepBytes Smallest change of the budget worth applying.
+    WeightStreamingBudget(std::int64_t streamableBytes, std::int64_t budgetBytes,
+        std::optional<std::int64_t> headroomBytes, std::int64_t minStepBytes);
+
+    //! \brief The budget to switch to given the free device memory, or std::nullopt to keep the current one.
+    //! The new budget is the current one when it is returned.
+    [[nodiscard]] std::optional<std::int64_t> adapt(std::int64_t freeBytes);
+
+    //! \brief Count a forward pass, which streams the weights over the budget. Can be called from any thread.
+    void onForward() noexcept
+    {
+        mNumForwards.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //! \brief The stats since the previous call.
+    [[nodiscard]] executor::WeightStreamingStats takeStats();
+
+    [[nodiscard]] std::int64_t getBudget() const noexcept
+    {
+        return mBudget;
+    }
+
+    [[nodiscard]] std::int64_t getStreamableBytes() const noexcept
+    {
+        return mStreamableBytes;
+    }
+
+    [[nodiscard]] bool isAdaptive() const noexcept
+    {
+        return mHeadroomBytes.has_value();
+    }
+
+private:
+    //! \brief Account the forwards counted so far at the current budget.
+    void foldForwards();
+
+    std::int64_t const mStreamableBytes;
+    std::optional<std::int64_t> const mHeadroomBytes;
+    std::int64_t const mMinStepBytes;
+    std::int64_t mBudget;
+
+    std::atomic<std::uint64_t> mNumForwards{0};
+    // Forwards, and the bytes they streamed, counted before the last budget change
+    std::uint64_t mFoldedForwards{0};
+    std::int64_t mFoldedStreamedBytes{0};
+    std::uint64_t mNumBudgetChanges{0};
+};
+
+} // namespace tensorrt_llm::runtime
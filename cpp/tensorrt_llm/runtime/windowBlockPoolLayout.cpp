@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/windowBlockPoolLayout.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+
+namespace tensorrt_llm::runtime
+{
+
+WindowBlockPoolLayout::WindowBlockPoolLayout(std::vector<SizeType32> const& maxAttentionWindowVec,
+    SizeType32 numLayers, SizeType32 tokensPerBlock, SizeType32 maxSequenceLength)
+    : mTokensPerBlock{tokensPerBlock}
+    , mPoolIdxPerLayer(numLayers)
+{
+    TLLM_CHECK_WITH_INFO(!maxAttentionWindowVec.empty(), "maxAttentionWindowVec must not be empty");
+    TLLM_CHECK_WITH_INFO(numLayers > 0 && tokensPerBlock > 0 && maxSequenceLength > 0,
+        "numLayers, tokensPerBlock and maxSequenceLength must be positive");
+
+    std::map<SizeType32, std::vector<SizeType32>> layersPerWindow;
+    for (SizeType32 layerIdx = 0; layerIdx < numLayers; ++layerIdx)
+    {
+        auto const window = maxAttentionWindowVec[layerIdx % maxAttentionWindowVec.size()];
+        TLLM_CHECK_WITH_INFO(window > 0, "Attention window of layer %d must be positive", layerIdx);
+        layersPerWindow[std::min(window, maxSequenceLength)].push_back(layerIdx);
+    }
+
+    auto const fullBlocks = (maxSequenceLength + tokensPerBlock - 1) / tokensPerBlock;
+    for (auto& [window, layers] : layersPerWindow)
+    {
+        auto const isCyclic = window < maxSequenceLength;
+        // The window of a cyclic pool can start in the middle of a block, which then needs one block more.
+        auto const blocksPerSequence
+            = isCyclic ? std::min((window + tokensPerBlock - 1) / tokensPerBlock + 1, fullBlocks) : fullBlocks;
+        auto const poolIdx = static_cast<SizeType32>(mPools.size());
+        for (auto const layerIdx : layers)
+        {
+            mPoolIdxPerLayer[layerIdx] = poolIdx;
+        }
+        mPools.push_back(Pool{window, std::move(layers), blocksPerSequence, isCyclic});
+    }
+}
+
+std::size_t WindowBlockPoolLayout::getBytesPerSequence(std::size_t bytesPerLayerBlock) const
+{
+    std::size_t bytes{0};
+    for (auto const& pool : mPools)
+    {
+        bytes += pool.layers.size() * static_cast<std::size_t>(pool.blocksPerSequence) * bytesPerLayerBlock;
+    }
+    return bytes;
+}
+
+void WindowBlockPoolLayout::allocateBlocks(std::size_t memoryBudget, std::size_t bytesPerLayerBlock)
+{
+    TLLM_CHECK_WITH_INFO(bytesPerLayerBlock > 0, "Block size must be positive");
+    // A block of a pool spans all layers of the pool. Giving every pool blocksPerSequence blocks per sequence
+    // equalizes the number of sequences they can hold.
+    auto const bytesPerSequence = getBytesPerSequence(bytesPerLayerBlock);
+    auto const numSequences = static_cast<double>(memoryBudget) / static_cast<double>(bytesPerSequence);
+    for (auto& pool : mPools)
+    {
+        pool.numBlocks = static_cast<SizeType32>(numSequences * pool.blocksPerSequence);
+        TLLM_LOG_INFO("KV cache pool for window size %d (%zu layers): %d blocks, %d per sequence", pool.windowSize,
+            pool.layers.size(), pool.numBlocks, pool.blocksPerSequence);
+    }
+}
+
+SizeType32 WindowBlockPoolLayout::getMaxNumSequences() const
+{
+    auto numSequences = std::numeric_limits<SizeType32>::max();
+    for (auto const& pool : mPools)
+    {
+        numSequences = std::min(numSequences, pool.numBlocks / pool.blocksPerSequence);
+    }
+    return numSequences;
+}
+
+} // namespace tensorrt_llm::runtime
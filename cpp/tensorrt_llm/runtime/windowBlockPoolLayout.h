@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Splits the KV cache into one block pool per attention window size.
+//! \details With a single pool every layer holds blocks for the full sequence, although sliding window layers only
+//! ever attend to the last windowSize tokens. Grouping layers by window size lets each pool be sized for what its
+//! layers need: a sliding window pool holds ceil(windowSize / tokensPerBlock) + 1 blocks per sequence and its blocks
+//! are recycled cyclically, see getCyclicBlockIdx.
+class WindowBlockPoolLayout
+{
+public:
+    struct Pool
+    {
+        //! Attention window of all layers in the pool, clamped to the max sequence length
+        SizeType32 windowSize;
+        //! Layers stored in the pool, in increasing order
+        std::vector<SizeType32> layers;
+        //! Number of blocks a single beam of a sequence needs in this pool
+        SizeType32 blocksPerSequence;
+        //! Whether blocks are recycled once the window has moved past them
+        bool isCyclic;
+        //! Number of blocks allocated for the pool, see allocateBlocks
+        SizeType32 numBlocks{0};
+    };
+
+    //! \param maxAttentionWindowVec Window size per layer, repeated if shorter than numLayers.
+    WindowBlockPoolLayout(std::vector<SizeType32> const& maxAttentionWindowVec, SizeType32 numLayers,
+        SizeType32 tokensPerBlock, SizeType32 maxSequenceLength);
+
+    //! \brief Distribute memoryBudget bytes over the pools so that all of them can hold the same number of sequences.
+    //! \param bytesPerLayerBlock Size of K and V of one block in one layer.
+    void allocateBlocks(std::size_t memoryBudget, std::size_t bytesPerLayerBlock);
+
+    [[nodiscard]] std::vector<Pool> const& getPools() const noexcept
+    {
+        return mPools;
+    }
+
+    [[nodiscard]] SizeType32 getNumPools() const noexcept
+    {
+        return static_cast<SizeType32>(mPools.size());
+    }
+
+    [[nodiscard]] SizeType32 getPoolIdx(SizeType32 layerIdx) const
+    {
+        return mPoolIdxPerLayer.at(layerIdx);
+    }
+
+    //! \brief Number of sequences (beams) the allocated pools can hold at full length.
+    [[nodiscard]] SizeType32 getMaxNumSequences() const;
+
+    //! \brief Bytes a single beam of a full length sequence occupies across all pools.
+    [[nodiscard]] std::size_t getBytesPerSequence(std::size_t bytesPerLayerBlock) const;
+
+    //! \brief Index, within the block list of a sequence, of the block holding tokenIdx in the given pool.
+    [[nodiscard]] static SizeType32 getCyclicBlockIdx(
+        SizeType32 tokenIdx, SizeType32 tokensPerBlock, Pool const& pool) noexcept
+    {
+        auto const blockIdx = tokenIdx / tokensPerBlock;
+        return pool.isCyclic ? blockIdx % pool.blocksPerSequence : blockIdx;
+    }
+
+private:
+    SizeType32 mTokensPerBlock;
+    std::vector<Pool> mPools;
+    std::vector<SizeType32> mPoolIdxPerLayer;
+};
+
+} // namespace tensorrt_llm::runtime
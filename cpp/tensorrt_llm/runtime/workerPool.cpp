@@ -15,57 +15,188 @@
  */
 
 #include "workerPool.h"
+#include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/cudaUtils.h"
 
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+
 namespace tensorrt_llm::runtime
 {
-WorkerPool::WorkerPool(std::size_t numWorkers, std::int32_t deviceId)
+namespace
+{
+// Lets tasks submitted by a worker go to the queue of that worker.
+thread_local WorkerPool const* currentPool{nullptr};
+thread_local std::size_t currentWorkerIdx{0};
+} // namespace
+
+WorkerPool::WorkerPool(std::size_t numWorkers, std::int32_t deviceId, std::vector<std::int32_t> cpuAffinity)
 {
     for (std::size_t i = 0; i < numWorkers; ++i)
     {
-        mWorkers.emplace_back(
-            [this, deviceId]
+        mQueues.emplace_back(std::make_unique<WorkerQueue>());
+    }
+    for (std::size_t i = 0; i < numWorkers; ++i)
+    {
+        mWorkers.emplace_back([this, i, deviceId, cpuAffinity] { run(i, deviceId, cpuAffinity); });
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mStop = true;
+    }
+    mWakeUp.notify_all();
+    for (std::thread& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+void WorkerPool::push(Task task, Priority priority)
+{
+    TLLM_CHECK_WITH_INFO(!mQueues.empty(), "WorkerPool has no workers");
+    auto const queueIdx = currentPool == this ? currentWorkerIdx
+                                              : mNextQueue.fetch_add(1, std::memory_order_relaxed) % mQueues.size();
+    auto& queue = *mQueues[queueIdx];
+    mNumPending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks[static_cast<std::size_t>(priority)].push_back(std::move(task));
+    }
+    {
+        // Taking the lock orders the notification after a worker checked the predicate, so no wake-up is lost.
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+    }
+    mWakeUp.notify_one();
+}
+
+bool WorkerPool::tryPop(std::size_t workerIdx, Task& task)
+{
+    auto const numQueues = mQueues.size();
+    for (std::size_t priority = 0; priority < kNumPriorities; ++priority)
+    {
+        for (std::size_t offset = 0; offset < numQueues; ++offset)
+        {
+            auto& queue = *mQueues[(workerIdx + offset) % numQueues];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            auto& tasks = queue.tasks[priority];
+            if (tasks.empty())
+            {
+                continue;
+            }
+            // Own tasks in order, stolen ones from the other end to interfere less with the owner
+            if (offset == 0)
+            {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            else
             {
-                if (deviceId >= 0)
-                {
-                    TLLM_CUDA_CHECK(cudaSetDevice(deviceId));
-                }
-                else
-                {
-                    TLLM_LOG_WARNING("WorkerPool did not set cuda device");
-                }
+                task = std::move(tasks.back());
+                tasks.pop_back();
+            }
+            mNumPending.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
 
-                while (true)
-                {
-                    std::function<void()> task;
+void WorkerPool::run(std::size_t workerIdx, std::int32_t deviceId, std::vector<std::int32_t> const& cpuAffinity)
+{
+    if (deviceId >= 0)
+    {
+        TLLM_CUDA_CHECK(cudaSetDevice(deviceId));
+    }
+    else
+    {
+        TLLM_LOG_WARNING("WorkerPool did not set cuda device");
+    }
 
-                    {
-                        std::unique_lock<std::mutex> lock(this->mQueueMutex);
-                        this->condition.wait(lock, [this] { return this->stop || !this->mTasks.empty(); });
-                        if (this->stop && this->mTasks.empty())
-                        {
-                            return;
-                        }
-                        task = std::move(this->mTasks.front());
-                        this->mTasks.pop();
-                    }
+    if (!cpuAffinity.empty())
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        for (auto const cpu : cpuAffinity)
+        {
+            if (cpu >= 0 && cpu < CPU_SETSIZE)
+            {
+                CPU_SET(cpu, &cpuSet);
+            }
+        }
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+        {
+            TLLM_LOG_WARNING("WorkerPool could not set the CPU affinity of worker %zu", workerIdx);
+        }
+    }
+
+    currentPool = this;
+    currentWorkerIdx = workerIdx;
+    while (true)
+    {
+        Task task;
+        if (tryPop(workerIdx, task))
+        {
+            task();
+            continue;
+        }
 
-                    task();
-                }
-            });
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mWakeUp.wait(lock, [this] { return mStop || mNumPending.load() > 0; });
+        if (mStop && mNumPending.load() == 0)
+        {
+            return;
+        }
     }
 }
 
-WorkerPool::~WorkerPool()
+std::vector<std::int32_t> WorkerPool::getDeviceCpuAffinity(std::int32_t deviceId)
 {
+    std::array<char, 32> busId{};
+    if (cudaDeviceGetPCIBusId(busId.data(), static_cast<int>(busId.size()), deviceId) != cudaSuccess)
     {
-        std::unique_lock<std::mutex> lock(mQueueMutex);
-        stop = true;
+        return {};
     }
-    condition.notify_all();
-    for (std::thread& worker : mWorkers)
+    std::string busIdStr{busId.data()};
+    std::transform(busIdStr.begin(), busIdStr.end(), busIdStr.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    std::ifstream file{"/sys/bus/pci/devices/" + busIdStr + "/local_cpulist"};
+    std::string cpuList;
+    if (!std::getline(file, cpuList))
     {
-        worker.join();
+        return {};
     }
+    return parseCpuList(cpuList);
 }
+
+std::vector<std::int32_t> WorkerPool::parseCpuList(std::string const& cpuList)
+{
+    std::vector<std::int32_t> cpus;
+    std::istringstream stream{cpuList};
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        if (range.empty() || !std::isdigit(static_cast<unsigned char>(range.front())))
+        {
+            continue;
+        }
+        auto const dash = range.find('-');
+        auto const first = std::stoi(range.substr(0, dash));
+        auto const last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        TLLM_CHECK_WITH_INFO(first <= last, "Invalid CPU range %s", range.c_str());
+        for (auto cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
 } // namespace tensorrt_llm::runtime
@@ -16,24 +16,180 @@
 
 #pragma once
 
-#include <cassert>
+#include "tensorrt_llm/common/logger.h"
+
+#include <array>
+#include <atomic>
 #include <condition_variable>
-#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <future>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <new>
+#include <string>
 #include <thread>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace tensorrt_llm::runtime
 {
 
+//! \brief Thread pool with a task queue per worker.
+//! \details Tasks submitted by a worker go to its own queue, tasks submitted from other threads are distributed round
+//! robin. An idle worker takes the oldest task of the highest priority, from its own queue first and otherwise steals
+//! the newest one from another worker. Within a queue and priority, tasks run in submission order, so a pool with a
+//! single worker runs tasks of equal priority in order.
 class WorkerPool
 {
 public:
-    explicit WorkerPool(std::size_t numWorkers = 1, std::int32_t deviceId = -1);
+    enum class Priority : std::uint8_t
+    {
+        kHIGH = 0,
+        kNORMAL = 1,
+        kLOW = 2,
+    };
+
+    static auto constexpr kNumPriorities = static_cast<std::size_t>(Priority::kLOW) + 1;
+
+    //! \brief Move-only type-erased callable. Callables up to kInlineSize bytes are stored without allocation.
+    class Task
+    {
+    public:
+        static auto constexpr kInlineSize = std::size_t{48};
+
+        Task() noexcept = default;
+
+        template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+        explicit Task(F&& f)
+        {
+            using Fn = std::decay_t<F>;
+            if constexpr (sizeof(Fn) <= kInlineSize && alignof(Fn) <= alignof(std::max_align_t)
+                && std::is_nothrow_move_constructible_v<Fn>)
+            {
+                new (&mStorage) Fn(std::forward<F>(f));
+                mOps = &InlineOps<Fn>::kOps;
+            }
+            else
+            {
+                new (&mStorage) Fn*(new Fn(std::forward<F>(f)));
+                mOps = &HeapOps<Fn>::kOps;
+            }
+        }
+
+        Task(Task&& other) noexcept
+        {
+            moveFrom(other);
+        }
+
+        Task& operator=(Task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                moveFrom(other);
+            }
+            return *this;
+        }
+
+        Task(Task const&) = delete;
+        Task& operator=(Task const&) = delete;
+
+        ~Task()
+        {
+            reset();
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return mOps != nullptr;
+        }
+
+        void operator()()
+        {
+            mOps->invoke(&mStorage);
+        }
+
+    private:
+        struct Ops
+        {
+            void (*invoke)(void*);
+            void (*move)(void* dst, void* src) noexcept;
+            void (*destroy)(void*) noexcept;
+        };
+
+        template <typename Fn>
+        struct InlineOps
+        {
+            static void invoke(void* storage)
+            {
+                (*static_cast<Fn*>(storage))();
+            }
+
+            static void move(void* dst, void* src) noexcept
+            {
+                new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+                static_cast<Fn*>(src)->~Fn();
+            }
+
+            static void destroy(void* storage) noexcept
+            {
+                static_cast<Fn*>(storage)->~Fn();
+            }
+
+            static constexpr Ops kOps{&invoke, &move, &destroy};
+        };
+
+        template <typename Fn>
+        struct HeapOps
+        {
+            static void invoke(void* storage)
+            {
+                (**static_cast<Fn**>(storage))();
+            }
+
+            static void move(void* dst, void* src) noexcept
+            {
+                new (dst) Fn*(*static_cast<Fn**>(src));
+            }
+
+            static void destroy(void* storage) noexcept
+            {
+                delete *static_cast<Fn**>(storage);
+            }
+
+            static constexpr Ops kOps{&invoke, &move, &destroy};
+        };
+
+        void moveFrom(Task& other) noexcept
+        {
+            if (other.mOps != nullptr)
+            {
+                other.mOps->move(&mStorage, &other.mStorage);
+                mOps = std::exchange(other.mOps, nullptr);
+            }
+        }
+
+        void reset() noexcept
+        {
+            if (mOps != nullptr)
+            {
+                mOps->destroy(&mStorage);
+                mOps = nullptr;
+            }
+        }
+
+        alignas(std::max_align_t) std::byte mStorage[kInlineSize];
+        Ops const* mOps{nullptr};
+    };
+
+    //! \param deviceId CUDA device the workers use, -1 to leave it unset.
+    //! \param cpuAffinity CPUs the workers may run on, e.g. getDeviceCpuAffinity(deviceId). Empty to not pin them.
+    explicit WorkerPool(
+        std::size_t numWorkers = 1, std::int32_t deviceId = -1, std::vector<std::int32_t> cpuAffinity = {});
 
     WorkerPool(WorkerPool const&) = delete;
     WorkerPool(WorkerPool&&) = delete;
@@ -42,44 +198,93 @@ public:
     ~WorkerPool();
 
     template <class F>
-    auto enqueue(F&& task) -> std::future<typename std::invoke_result<F>::type>
+    auto enqueue(F&& task, Priority priority = Priority::kNORMAL)
+        -> std::future<typename std::invoke_result<F>::type>
     {
         using returnType = typename std::invoke_result<F>::type;
-        auto const taskPromise = std::make_shared<std::promise<returnType>>();
-        {
-            std::lock_guard<std::mutex> lock(mQueueMutex);
-            mTasks.push(
-                [task = std::forward<F>(task), taskPromise]()
+        std::promise<returnType> taskPromise;
+        auto future = taskPromise.get_future();
+        push(Task{[task = std::forward<F>(task), taskPromise = std::move(taskPromise)]() mutable
+            {
+                try
                 {
-                    try
+                    if constexpr (std::is_void_v<returnType>)
                     {
-                        if constexpr (std::is_void_v<returnType>)
-                        {
-                            task();
-                            taskPromise->set_value();
-                        }
-                        else
-                        {
-                            taskPromise->set_value(task());
-                        }
+                        task();
+                        taskPromise.set_value();
                     }
-                    catch (...)
+                    else
                     {
-                        taskPromise->set_exception(std::current_exception());
+                        taskPromise.set_value(task());
                     }
-                });
-        }
-        condition.notify_one();
-        return taskPromise->get_future();
+                }
+                catch (...)
+                {
+                    taskPromise.set_exception(std::current_exception());
+                }
+            }},
+            priority);
+        return future;
     }
 
+    //! \brief Run a task without a future to wait on. Exceptions thrown by the task are logged. Small tasks are
+    //! submitted without any allocation.
+    template <class F>
+    void enqueueDetached(F&& task, Priority priority = Priority::kNORMAL)
+    {
+        push(Task{[task = std::forward<F>(task)]() mutable
+            {
+                try
+                {
+                    task();
+                }
+                catch (std::exception const& e)
+                {
+                    TLLM_LOG_EXCEPTION(e);
+                }
+            }},
+            priority);
+    }
+
+    [[nodiscard]] std::size_t getNumWorkers() const noexcept
+    {
+        return mWorkers.size();
+    }
+
+    //! \brief Number of submitted tasks that no worker has started yet.
+    [[nodiscard]] std::size_t getNumPendingTasks() const noexcept
+    {
+        return mNumPending.load(std::memory_order_relaxed);
+    }
+
+    //! \brief CPUs close to a device, i.e. on its NUMA node. Empty if unknown.
+    [[nodiscard]] static std::vector<std::int32_t> getDeviceCpuAffinity(std::int32_t deviceId);
+
+    //! \brief Parse a Linux CPU list such as "0-3,8,10-11".
+    [[nodiscard]] static std::vector<std::int32_t> parseCpuList(std::string const& cpuList);
+
 private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::array<std::deque<Task>, kNumPriorities> tasks;
+    };
+
+    void push(Task task, Priority priority);
+
+    bool tryPop(std::size_t workerIdx, Task& task);
+
+    void run(std::size_t workerIdx, std::int32_t deviceId, std::vector<std::int32_t> const& cpuAffinity);
+
+    std::vector<std::unique_ptr<WorkerQueue>> mQueues;
     std::vector<std::thread> mWorkers;
-    std::queue<std::function<void()>> mTasks;
+    std::atomic<std::size_t> mNextQueue{0};
+    // Counts a task from before it is queued until a worker takes it, so it never underflows.
+    std::atomic<std::size_t> mNumPending{0};
 
-    std::mutex mQueueMutex;
-    std::condition_variable condition;
-    bool stop{};
+    std::mutex mSleepMutex;
+    std::condition_variable mWakeUp;
+    bool mStop{false};
 };
 
 } // namespace tensorrt_llm::runtime
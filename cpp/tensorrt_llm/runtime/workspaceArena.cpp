@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/workspaceArena.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace tensorrt_llm::runtime
+{
+
+WorkspaceArena::WorkspaceArena(std::size_t alignment)
+    : mAlignment{alignment}
+{
+    TLLM_CHECK_WITH_INFO(alignment > 0, "Alignment must be positive");
+}
+
+WorkspaceArena::BlockId WorkspaceArena::addBlock(std::size_t sizeInBytes, SizeType32 firstPhase, SizeType32 lastPhase)
+{
+    TLLM_CHECK_WITH_INFO(firstPhase <= lastPhase, "Block lifetime [%d, %d] is empty", firstPhase, lastPhase);
+    auto const alignedSize = (sizeInBytes + mAlignment - 1) / mAlignment * mAlignment;
+    mBlocks.push_back(Block{alignedSize, firstPhase, lastPhase, 0});
+    mPlanned = false;
+    return static_cast<BlockId>(mBlocks.size() - 1);
+}
+
+std::size_t WorkspaceArena::getOffset(BlockId id) const
+{
+    TLLM_CHECK_WITH_INFO(0 <= id && id < getNumBlocks(), "Invalid block id %d", id);
+    plan();
+    return mBlocks[id].offset;
+}
+
+std::size_t WorkspaceArena::getTotalSize() const
+{
+    plan();
+    return mTotalSize;
+}
+
+std::size_t WorkspaceArena::getUnsharedSize() const noexcept
+{
+    return std::accumulate(
+        mBlocks.begin(), mBlocks.end(), std::size_t{0}, [](std::size_t sum, Block const& b) { return sum + b.size; });
+}
+
+void WorkspaceArena::plan() const
+{
+    if (mPlanned)
+    {
+        return;
+    }
+
+    // Place the largest blocks first, each at the lowest offset that does not overlap a placed block alive at the
+    // same time.
+    std::vector<BlockId> order(mBlocks.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+        order.begin(), order.end(), [this](BlockId a, BlockId b) { return mBlocks[a].size > mBlocks[b].size; });
+
+    std::vector<Block const*> placed;
+    placed.reserve(mBlocks.size());
+    mTotalSize = 0;
+    for (auto const id : order)
+    {
+        auto& block = mBlocks[id];
+        std::vector<Block const*> conflicts;
+        for (auto const* other : placed)
+        {
+            if (other->firstPhase <= block.lastPhase && block.firstPhase <= other->lastPhase)
+            {
+                conflicts.push_back(other);
+            }
+        }
+        std::sort(conflicts.begin(), conflicts.end(),
+            [](Block const* a, Block const* b) { return a->offset < b->offset; });
+
+        std::size_t offset = 0;
+        for (auto const* other : conflicts)
+        {
+            if (offset + block.size <= other->offset)
+            {
+                break;
+            }
+            offset = std::max(offset, other->offset + other->size);
+        }
+        block.offset = offset;
+        placed.push_back(&block);
+        mTotalSize = std::max(mTotalSize, offset + block.size);
+    }
+    mPlanned = true;
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/workspace.h"
+#include "tensorrt_llm/runtime/common.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Plans the layout of a workspace shared by several users with known lifetimes.
+//! \details Each block lives from its first to its last phase, e.g. the position of a decoding layer in the layer
+//! sequence. Blocks whose lifetimes overlap get disjoint memory, blocks that are never alive at the same time may
+//! alias each other. The arena only computes offsets, the memory is owned by the caller (DecodingLayerWorkspace).
+class WorkspaceArena
+{
+public:
+    using BlockId = SizeType32;
+
+    explicit WorkspaceArena(std::size_t alignment = common::kCudaMemAlign);
+
+    //! \brief Add a block alive during the phases [firstPhase, lastPhase].
+    //! @returns id of the block, to be used with getOffset
+    BlockId addBlock(std::size_t sizeInBytes, SizeType32 firstPhase, SizeType32 lastPhase);
+
+    //! \brief Add a block alive during a single phase.
+    BlockId addBlock(std::size_t sizeInBytes, SizeType32 phase)
+    {
+        return addBlock(sizeInBytes, phase, phase);
+    }
+
+    //! @returns offset of the block in bytes from the start of the workspace
+    [[nodiscard]] std::size_t getOffset(BlockId id) const;
+
+    //! @returns pointer to the block inside the workspace starting at base
+    template <typename T>
+    [[nodiscard]] T* getPointer(void* base, BlockId id) const
+    {
+        return reinterpret_cast<T*>(static_cast<std::int8_t*>(base) + getOffset(id));
+    }
+
+    //! @returns size of the workspace in bytes required by all blocks
+    [[nodiscard]] std::size_t getTotalSize() const;
+
+    //! @returns size in bytes if no blocks aliased each other
+    [[nodiscard]] std::size_t getUnsharedSize() const noexcept;
+
+    [[nodiscard]] SizeType32 getNumBlocks() const noexcept
+    {
+        return static_cast<SizeType32>(mBlocks.size());
+    }
+
+private:
+    struct Block
+    {
+        std::size_t size;
+        SizeType32 firstPhase;
+        SizeType32 lastPhase;
+        std::size_t offset;
+    };
+
+    //! \brief Assign offsets to all blocks. Called lazily after blocks were added.
+    void plan() const;
+
+    std::size_t mAlignment;
+    mutable std::vector<Block> mBlocks;
+    mutable std::size_t mTotalSize{0};
+    mutable bool mPlanned{true};
+};
+
+} // namespace tensorrt_llm::runtime
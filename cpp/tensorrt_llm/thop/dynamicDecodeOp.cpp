@@ -50,8 +50,8 @@ FtDynamicDecode<T>::FtDynamicDecode(size_t const maxBatchSize, size_t const maxB
     auto cudaStreamPtr = std::make_shared<tensorrt_llm::runtime::CudaStream>(stream, currentDeviceId);
     auto bufferManager = std::make_shared<tensorrt_llm::runtime::BufferManager>(cudaStreamPtr);
 
-    mFinishedSum = bufferManager->pinnedPool(
-        tr::ITensor::makeShape({static_cast<int32_t>(maxBatchSize)}), nvinfer1::DataType::kINT32);
+    mFinishedSum = torch::zeros({static_cast<int64_t>(maxBatchSize)},
+        torch::dtype(torch::kInt32).device(torch::kCUDA, currentDeviceId).requires_grad(false));
     mDynamicDecodeLayer
         = std::make_shared<tl::DynamicDecodeLayer<T>>(tle::DecodingMode::Auto(), decodingDomain, bufferManager);
     mBatchSlots = tr::getDefaultBatchSlots(maxBatchSize, *bufferManager);
@@ -245,16 +245,14 @@ void FtDynamicDecode<T>::forward(th::Tensor const& logits, int const step, int c
     safeUpdate<float>(outputLogProbsTiledOpt, outputParams->outputLogProbsTiled);
     safeUpdate<tr::TokenIdType>(parentIdsOpt, outputParams->parentIds);
 
-    tr::SizeType32* finishedSumHost = nullptr;
-    if (forwardParams->stopCriteriaInputs->sequenceLimitLength && outputParams->finished.has_value())
+    auto const checkShouldStop
+        = forwardParams->stopCriteriaInputs->sequenceLimitLength && outputParams->finished.has_value();
+    if (checkShouldStop)
     {
         // Skip the initialization and later calculation if there is no limit of sequence length or no finished beam
-        outputParams->finishedSum = mFinishedSum;
-        finishedSumHost = tr::bufferCast<tr::SizeType32>(*mFinishedSum);
-        for (int32_t bi = 0; bi < localBatchSize; ++bi)
-        {
-            finishedSumHost[bi] = 0;
-        }
+        auto finishedSum = mFinishedSum.slice(0, 0, localBatchSize);
+        finishedSum.zero_();
+        outputParams->finishedSum = convert_tensor<tr::SizeType32>(finishedSum);
     }
 
     if (isBeamSearch)
@@ -279,17 +277,12 @@ void FtDynamicDecode<T>::forward(th::Tensor const& logits, int const step, int c
 
     mDynamicDecodeLayer->forwardAsync(outputParams, forwardParams, mDecodingWorkspace);
 
-    if (finishedSumHost)
+    if (checkShouldStop)
     {
-        TLLM_CUDA_CHECK(::cudaStreamSynchronize(mDynamicDecodeLayer->getStream()));
-        tr::SizeType32 numRealFinished = 0;
-        for (int32_t bi = 0; bi < localBatchSize; ++bi)
-        {
-            numRealFinished += finishedSumHost[bi];
-        }
-        auto const numToFinish = outputParams->finished.value()->getSize();
-        auto shouldStopAccessor = shouldStop.accessor<bool, 1>();
-        shouldStopAccessor[0] = numToFinish == numRealFinished;
+        // Reduced on the device. With should_stop on the device, the step does not synchronize and can be captured
+        // in a CUDA graph, a host should_stop waits for the copy.
+        auto const numToFinish = static_cast<int64_t>(outputParams->finished.value()->getSize());
+        shouldStop.copy_(mFinishedSum.slice(0, 0, localBatchSize).sum().eq(numToFinish).reshape({1}));
     }
 }
 
@@ -94,7 +94,8 @@ public:
         th::optional<th::Tensor> beam_hyps_is_done_opt, bool const use_beam_hyps) override;
 
 private:
-    tensorrt_llm::runtime::ITensor::SharedPtr mFinishedSum; // [batch_size] pinned
+    // Finished beams per request, on the device so that the step needs no synchronization
+    th::Tensor mFinishedSum; // [batch_size]
     std::shared_ptr<tensorrt_llm::layers::DynamicDecodeLayer<T>> mDynamicDecodeLayer;
     std::shared_ptr<tensorrt_llm::runtime::DecodingLayerWorkspace> mDecodingWorkspace;
     std::optional<size_t> mBeamWidth;
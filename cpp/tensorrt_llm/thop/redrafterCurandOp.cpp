@@ -41,10 +41,10 @@ namespace torch_ext
 namespace
 {
 // Must be similar to [cpp/tensorrt_llm/runtime/gptSession.cpp] ExplicitDraftTokensLayer<T>::setup
-void initializeDeviceCurandStates(
-    uint64_t batchSize, th::Tensor& curandState, th::optional<th::Tensor>& randomSeeds, cudaStream_t stream)
+void initializeDeviceRandomStates(
+    uint64_t batchSize, th::Tensor& randomState, th::optional<th::Tensor>& randomSeeds, cudaStream_t stream)
 {
-    auto* curandStatePtr = get_ptr<curandState_t>(curandState);
+    auto* randomStatePtr = get_ptr<tk::RandomState>(randomState);
     tr::SizeType32* batchSlotsPtr = nullptr;
 
     if (randomSeeds.has_value())
@@ -53,7 +53,7 @@ void initializeDeviceCurandStates(
         {
             TLLM_CHECK_WITH_INFO(randomSeeds->device().is_cpu(), "Random seed tensor expected on host.");
             auto const randomSeed = get_val<uint64_t>(randomSeeds.value(), 0);
-            tk::invokeCurandInitialize(curandStatePtr, batchSlotsPtr, batchSize, randomSeed, stream);
+            tk::invokeRandomStateInitialize(randomStatePtr, batchSlotsPtr, batchSize, randomSeed, stream);
         }
         else
         {
@@ -62,20 +62,20 @@ void initializeDeviceCurandStates(
             TLLM_CHECK_WITH_INFO(randomSeeds->device().is_cuda(), "Random seed tensor expected on device.");
 
             auto* randomSeedsPtr = get_ptr<uint64_t>(randomSeeds.value());
-            tk::invokeCurandBatchInitialize(curandStatePtr, batchSlotsPtr, batchSize, randomSeedsPtr, stream);
+            tk::invokeRandomStateBatchInitialize(randomStatePtr, batchSlotsPtr, batchSize, randomSeedsPtr, stream);
         }
     }
     else
     {
-        // Initialize curand states using the default seed 0.
-        tk::invokeCurandInitialize(
-            curandStatePtr, batchSlotsPtr, batchSize, tensorrt_llm::layers::DefaultDecodingParams::getSeed(), stream);
+        // Initialize random states using the default seed 0.
+        tk::invokeRandomStateInitialize(
+            randomStatePtr, batchSlotsPtr, batchSize, tensorrt_llm::layers::DefaultDecodingParams::getSeed(), stream);
     }
     sync_check_cuda_error();
 }
 } // namespace
 
-void prepareRandomTensors(th::Tensor& curandState, // [maxBatchSize, 48], uint8_t
+void prepareRandomTensors(th::Tensor& randomState, // [maxBatchSize, >= 16], uint8_t
     th::Tensor& randDataSample,                    // [maxBatchSize], dtype (float or half)
     th::Tensor& randDataValidation,       // [maxBatchSize, maxNumPaths, maxPathDraftLength], dtype (float or half)
     th::optional<th::Tensor> randomSeeds, // [1] or [maxBatchSize], uint64_t
@@ -96,15 +96,16 @@ void prepareRandomTensors(th::Tensor& curandState, // [maxBatchSize, 48], uint8_
             && randDataValidation.size(1) == numPaths && randDataValidation.size(2) == draftLength,
         "Random validation tensor size mismatch.");
 
-    TLLM_CHECK_WITH_INFO(
-        curandState.dim() == 2 && curandState.size(0) == batchSize && curandState.size(1) == sizeof(curandState_t),
-        "Curand state tensor shpe mismatch."
-        "(got (%lu, %lu), need (%lu, %lu)).",
-        curandState.size(0), curandState.size(1), batchSize, sizeof(curandState_t));
+    // Rows sized for the former 48 byte curand states are still accepted, the states are packed at the front
+    TLLM_CHECK_WITH_INFO(randomState.dim() == 2 && randomState.size(0) == batchSize
+            && randomState.size(1) >= static_cast<int64_t>(sizeof(tk::RandomState)),
+        "Random state tensor shape mismatch."
+        "(got (%lu, %lu), need (%lu, >= %lu)).",
+        randomState.size(0), randomState.size(1), batchSize, sizeof(tk::RandomState));
 
     if (initialize)
     {
-        initializeDeviceCurandStates(batchSize, curandState, randomSeeds, stream);
+        initializeDeviceRandomStates(batchSize, randomState, randomSeeds, stream);
     }
 
     switch (scalarType)
@@ -117,7 +118,7 @@ void prepareRandomTensors(th::Tensor& curandState, // [maxBatchSize, 48], uint8_
         params.draftLength = static_cast<tr::SizeType32>(draftLength);
         params.randDataSample = get_ptr<float>(randDataSample);
         params.randDataVerification = get_ptr<float>(randDataValidation);
-        params.curandState = get_ptr<curandState_t>(curandState);
+        params.randomState = get_ptr<tk::RandomState>(randomState);
         params.batchSlots = nullptr;
         params.skipVerification = initialize;
 
@@ -132,7 +133,7 @@ void prepareRandomTensors(th::Tensor& curandState, // [maxBatchSize, 48], uint8_
         params.draftLength = static_cast<tr::SizeType32>(draftLength);
         params.randDataSample = get_ptr<half>(randDataSample);
         params.randDataVerification = get_ptr<half>(randDataValidation);
-        params.curandState = get_ptr<curandState_t>(curandState);
+        params.randomState = get_ptr<tk::RandomState>(randomState);
         params.batchSlots = nullptr;
         params.skipVerification = initialize;
 
@@ -148,7 +149,7 @@ void prepareRandomTensors(th::Tensor& curandState, // [maxBatchSize, 48], uint8_
         params.draftLength = static_cast<tr::SizeType32>(draftLength);
         params.randDataSample = get_ptr<__nv_bfloat16>(randDataSample);
         params.randDataVerification = get_ptr<__nv_bfloat16>(randDataValidation);
-        params.curandState = get_ptr<curandState_t>(curandState);
+        params.randomState = get_ptr<tk::RandomState>(randomState);
         params.batchSlots = nullptr;
         params.skipVerification = initialize;
 
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Pre-populates the persistent XQA JIT cubin cache, so that serving processes start without compiling XQA kernels.
+// Run it once per GPU arch on a machine with such a GPU, with the same cache directory the serving processes use:
+//
+//   xqaJitCachePopulate --cache_dir=/path/to/cache --dtype=fp16,bf16 --kv_cache_dtype=fp16,fp8 --head_size=128
+//       --num_q_heads=32 --num_kv_heads=8 --tokens_per_block=64 --max_beam_width=1
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/decoderXQAImplJIT/cubinDiskCache.h"
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/decoderXQARunner.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tc = tensorrt_llm::common;
+namespace tk = tensorrt_llm::kernels;
+
+namespace
+{
+
+void printUsage(char const* program)
+{
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --cache_dir=DIR            cache directory, defaults to TRTLLM_XQA_JIT_CACHE_DIR\n"
+              << "  --dtype=LIST               activation types of fp16, bf16 (default fp16)\n"
+              << "  --kv_cache_dtype=LIST      KV cache types of fp16, bf16, int8, fp8 (default same as dtype)\n"
+              << "  --head_size=LIST           head sizes (default 128)\n"
+              << "  --num_q_heads=LIST         number of query heads per rank (default 32)\n"
+              << "  --num_kv_heads=LIST        number of KV heads per rank (default 8)\n"
+              << "  --tokens_per_block=LIST    tokens per KV cache block, 0 for a linear KV cache (default 64)\n"
+              << "  --max_beam_width=N         kernels for beam widths up to N are compiled (default 1)\n";
+}
+
+std::vector<std::string> splitList(std::string const& list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+std::vector<int> splitIntList(std::string const& list)
+{
+    std::vector<int> values;
+    for (auto const& item : splitList(list))
+    {
+        values.push_back(std::stoi(item));
+    }
+    return values;
+}
+
+tk::XQADataType parseDataType(std::string const& name)
+{
+    static std::map<std::string, tk::XQADataType> const dataTypes{{"fp16", tk::DATA_TYPE_FP16},
+        {"bf16", tk::DATA_TYPE_BF16}, {"int8", tk::DATA_TYPE_INT8}, {"fp8", tk::DATA_TYPE_E4M3}};
+    auto const it = dataTypes.find(name);
+    TLLM_CHECK_WITH_INFO(it != dataTypes.end(), "Unknown data type %s", name.c_str());
+    return it->second;
+}
+
+tk::XQAParams makeXQAParams(tk::XQADataType dataType, tk::XQADataType kvCacheDataType, int headSize, int numQHeads,
+    int numKvHeads, int tokensPerBlock, int maxBeamWidth)
+{
+    tk::XQAParams params{};
+    params.data_type = dataType;
+    params.kv_cache_data_type = kvCacheDataType;
+    if (kvCacheDataType == tk::DATA_TYPE_INT8)
+    {
+        params.kv_cache_quant_mode = tc::QuantMode::int8KvCache();
+    }
+    else if (kvCacheDataType == tk::DATA_TYPE_E4M3)
+    {
+        params.kv_cache_quant_mode = tc::QuantMode::fp8KvCache();
+    }
+    params.head_size = headSize;
+    params.num_q_heads = numQHeads;
+    params.num_kv_heads = numKvHeads;
+    params.beam_width = maxBeamWidth;
+    params.paged_kv_cache = tokensPerBlock > 0;
+    params.tokens_per_block = tokensPerBlock;
+    params.generation_input_length = 1;
+    params.max_attention_window_size = 4096;
+    params.cyclic_attention_window_size = 4096;
+    params.multi_query_tokens = false;
+    // Values below only need to pass the configuration checks, they do not affect the compiled kernels.
+    params.unidirectional = 1;
+    params.q_scaling = 1.0f;
+    params.mask_type = tk::AttentionMaskType::CAUSAL;
+    params.cross_attention = false;
+    params.position_embedding_type = tk::PositionEmbeddingType::kROPE_GPT_NEOX;
+    params.multi_block_mode = true;
+    return params;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::map<std::string, std::string> options{{"dtype", "fp16"}, {"kv_cache_dtype", ""}, {"head_size", "128"},
+        {"num_q_heads", "32"}, {"num_kv_heads", "8"}, {"tokens_per_block", "64"}, {"max_beam_width", "1"},
+        {"cache_dir", tc::getEnvXQAJITCacheDir().value_or("")}};
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg{argv[i]};
+        auto const eq = arg.find('=');
+        if (arg == "--help" || arg.rfind("--", 0) != 0 || eq == std::string::npos
+            || options.count(arg.substr(2, eq - 2)) == 0)
+        {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+        options[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+    }
+
+    if (options["cache_dir"].empty())
+    {
+        TLLM_LOG_ERROR("No cache directory, set --cache_dir or TRTLLM_XQA_JIT_CACHE_DIR");
+        return 1;
+    }
+    if (tc::getEnvEnableXQAJIT().value_or(true) == false)
+    {
+        TLLM_LOG_ERROR("XQA JIT is disabled by TRTLLM_ENABLE_XQA_JIT");
+        return 1;
+    }
+
+    auto const sm = tc::getSMVersion();
+    auto diskCache = std::make_shared<tk::jit::CubinDiskCache>(options["cache_dir"], sm);
+    tk::DecoderXQARunner::getResourceGlobal()->getCubinObjRegistry()->setDiskCache(diskCache);
+
+    auto const maxBeamWidth = std::stoi(options["max_beam_width"]);
+    auto const kvCacheDataTypes = options["kv_cache_dtype"].empty() ? std::vector<std::string>{}
+                                                                    : splitList(options["kv_cache_dtype"]);
+    int numConfigs = 0;
+    for (auto const& dtype : splitList(options["dtype"]))
+    {
+        auto const dataType = parseDataType(dtype);
+        auto const kvCacheTypes = kvCacheDataTypes.empty() ? std::vector<std::string>{dtype} : kvCacheDataTypes;
+        for (auto const& kvCacheDtype : kvCacheTypes)
+        {
+            for (auto const headSize : splitIntList(options["head_size"]))
+            {
+                for (auto const numQHeads : splitIntList(options["num_q_heads"]))
+                {
+                    for (auto const numKvHeads : splitIntList(options["num_kv_heads"]))
+                    {
+                        for (auto const tokensPerBlock : splitIntList(options["tokens_per_block"]))
+                        {
+                            auto const params = makeXQAParams(dataType, parseDataType(kvCacheDtype), headSize,
+                                numQHeads, numKvHeads, tokensPerBlock, maxBeamWidth);
+                            tk::DecoderXQARunner runner(dataType, numQHeads, numKvHeads, headSize, true);
+                            if (!runner.shouldUse(params, /*forConfigurePlugin=*/true))
+                            {
+                                TLLM_LOG_WARNING("XQA does not support dtype=%s kv_cache_dtype=%s head_size=%d "
+                                                 "num_q_heads=%d num_kv_heads=%d tokens_per_block=%d, skipping",
+                                    dtype.c_str(), kvCacheDtype.c_str(), headSize, numQHeads, numKvHeads,
+                                    tokensPerBlock);
+                                continue;
+                            }
+                            // Compiles missing cubins into the global registry, which writes them through to disk.
+                            runner.prepare(params);
+                            ++numConfigs;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    TLLM_LOG_INFO("Populated %d XQA configurations in %s", numConfigs, diskCache->getDirectory().c_str());
+    return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/batchDispatcher.h"
+
+#include <thread>
+#include <vector>
+
+using tensorrt_llm::common::BatchDispatcher;
+
+TEST(BatchDispatcherTest, CallbacksGetWholeBatches)
+{
+    BatchDispatcher<int> dispatcher;
+    EXPECT_FALSE(dispatcher.hasConsumers());
+
+    std::vector<std::vector<int>> received;
+    auto const id = dispatcher.registerCallback([&received](auto const& batch) { received.push_back(batch); });
+    EXPECT_TRUE(dispatcher.hasConsumers());
+
+    dispatcher.dispatch({1, 2, 3});
+    dispatcher.dispatch({});
+    dispatcher.dispatch({4});
+    ASSERT_EQ(received.size(), 2);
+    EXPECT_EQ(received[0], (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(received[1], (std::vector<int>{4}));
+
+    EXPECT_TRUE(dispatcher.unregister(id));
+    EXPECT_FALSE(dispatcher.unregister(id));
+    dispatcher.dispatch({5});
+    EXPECT_EQ(received.size(), 2);
+}
+
+TEST(BatchDispatcherTest, QueueDropsWhenFull)
+{
+    BatchDispatcher<int> dispatcher;
+    auto queue = std::make_shared<BatchDispatcher<int>::Queue>(2);
+    dispatcher.registerQueue(queue);
+    for (int i = 0; i < 3; ++i)
+    {
+        dispatcher.dispatch({i});
+    }
+    EXPECT_EQ(dispatcher.getNumDroppedBatches(), 1);
+    EXPECT_EQ(queue->tryPop().value(), (std::vector<int>{0}));
+    EXPECT_EQ(queue->tryPop().value(), (std::vector<int>{1}));
+    EXPECT_FALSE(queue->tryPop().has_value());
+}
+
+TEST(BatchDispatcherTest, ConsumerThread)
+{
+    int constexpr numBatches = 1000;
+    BatchDispatcher<int> dispatcher;
+    auto queue = std::make_shared<BatchDispatcher<int>::Queue>(numBatches);
+    dispatcher.registerQueue(queue);
+
+    std::thread consumer(
+        [&queue]()
+        {
+            int expected = 0;
+            while (expected < numBatches)
+            {
+                if (auto batch = queue->tryPop())
+                {
+                    EXPECT_EQ(batch->front(), expected);
+                    ++expected;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    for (int i = 0; i < numBatches; ++i)
+    {
+        dispatcher.dispatch({i});
+    }
+    consumer.join();
+    EXPECT_EQ(dispatcher.getNumDroppedBatches(), 0);
+}
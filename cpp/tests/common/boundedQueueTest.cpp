@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/boundedQueue.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using tensorrt_llm::common::BoundedQueue;
+
+TEST(BoundedQueue, PushPop)
+{
+    BoundedQueue<int> queue{3};
+    EXPECT_EQ(queue.capacity(), 4);
+    EXPECT_FALSE(queue.tryPop().has_value());
+
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(queue.tryPush(i));
+    }
+    EXPECT_FALSE(queue.tryPush(4));
+    EXPECT_EQ(queue.sizeApprox(), 4);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        auto value = queue.tryPop();
+        ASSERT_TRUE(value.has_value());
+        EXPECT_EQ(*value, i);
+    }
+    EXPECT_FALSE(queue.tryPop().has_value());
+    EXPECT_TRUE(queue.tryPush(5));
+    EXPECT_EQ(queue.tryPop(), 5);
+}
+
+TEST(BoundedQueue, ConcurrentProducers)
+{
+    constexpr int kNumProducers = 4;
+    constexpr int kNumValues = 10000;
+    BoundedQueue<int> queue{1024};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kNumProducers; ++p)
+    {
+        producers.emplace_back(
+            [&queue, p]()
+            {
+                for (int i = 0; i < kNumValues; ++i)
+                {
+                    while (!queue.tryPush(p * kNumValues + i))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+    }
+
+    std::vector<int> lastValue(kNumProducers, -1);
+    int numPopped = 0;
+    while (numPopped < kNumProducers * kNumValues)
+    {
+        auto value = queue.tryPop();
+        if (!value)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        auto const producer = *value / kNumValues;
+        auto const idx = *value % kNumValues;
+        // Values of a single producer arrive in order
+        EXPECT_GT(idx, lastValue[producer]);
+        lastValue[producer] = idx;
+        ++numPopped;
+    }
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    EXPECT_FALSE(queue.tryPop().has_value());
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cublasAlgoCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace tensorrt_llm::common;
+
+namespace
+{
+
+cublasLtMatmulAlgo_t makeAlgo(unsigned char seed)
+{
+    cublasLtMatmulAlgo_t algo;
+    auto* bytes = reinterpret_cast<unsigned char*>(&algo);
+    for (size_t i = 0; i < sizeof(algo); ++i)
+    {
+        bytes[i] = static_cast<unsigned char>(seed + i);
+    }
+    return algo;
+}
+
+bool isSameAlgo(cublasLtMatmulAlgo_t const& lhs, cublasLtMatmulAlgo_t const& rhs)
+{
+    return std::memcmp(&lhs, &rhs, sizeof(cublasLtMatmulAlgo_t)) == 0;
+}
+
+std::string getKey(int m, int n, int k, int lda, int ldb, int ldc, std::string const& environment = "sm90 cublasLt1")
+{
+    return CublasAlgoCache::getKey(environment, CUBLAS_OP_T, CUBLAS_OP_N, m, n, k, lda, ldb, ldc, CUDA_R_16F,
+        CUDA_R_16F, CUDA_R_16F, CUBLAS_COMPUTE_32F, CUDA_R_32F);
+}
+
+} // namespace
+
+TEST(CublasAlgoCache, KeyBucketsN)
+{
+    // A transposed [4096, 1024] weight times [1024, n] activations
+    EXPECT_EQ(getKey(4096, 17, 1024, 1024, 1024, 4096), getKey(4096, 32, 1024, 1024, 1024, 4096));
+    EXPECT_NE(getKey(4096, 32, 1024, 1024, 1024, 4096), getKey(4096, 33, 1024, 1024, 1024, 4096));
+    EXPECT_NE(getKey(4096, 32, 1024, 1024, 1024, 4096), getKey(4096, 32, 2048, 2048, 2048, 4096));
+    // Padding is part of the key
+    EXPECT_NE(getKey(4096, 32, 1024, 1024, 1024, 4096), getKey(4096, 32, 1024, 1088, 1024, 4096));
+    EXPECT_NE(
+        getKey(4096, 32, 1024, 1024, 1024, 4096), getKey(4096, 32, 1024, 1024, 1024, 4096, "sm80 cublasLt1"));
+}
+
+TEST(CublasAlgoCache, SaveAndLoad)
+{
+    CublasAlgoCache cache("unused");
+    EXPECT_FALSE(cache.lookup("a").has_value());
+    cache.store("a", makeAlgo(1));
+    cache.store("b", makeAlgo(2));
+
+    std::stringstream ss;
+    cache.save(ss);
+
+    CublasAlgoCache loaded("unused");
+    ASSERT_TRUE(loaded.load(ss));
+    EXPECT_EQ(loaded.size(), 2);
+    ASSERT_TRUE(loaded.lookup("a").has_value());
+    EXPECT_TRUE(isSameAlgo(*loaded.lookup("a"), makeAlgo(1)));
+    EXPECT_TRUE(isSameAlgo(*loaded.lookup("b"), makeAlgo(2)));
+}
+
+TEST(CublasAlgoCache, LoadKeepsNewerEntries)
+{
+    CublasAlgoCache disk("unused");
+    disk.store("a", makeAlgo(1));
+    disk.store("b", makeAlgo(2));
+    std::stringstream ss;
+    disk.save(ss);
+
+    CublasAlgoCache cache("unused");
+    cache.store("a", makeAlgo(3));
+    ASSERT_TRUE(cache.load(ss));
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_TRUE(isSameAlgo(*cache.lookup("a"), makeAlgo(3)));
+    EXPECT_TRUE(isSameAlgo(*cache.lookup("b"), makeAlgo(2)));
+}
+
+TEST(CublasAlgoCache, RejectsMalformedEntries)
+{
+    CublasAlgoCache cache("unused");
+    // Too short for an algo
+    std::stringstream shortAlgo("00ff key\n");
+    EXPECT_FALSE(cache.load(shortAlgo));
+    std::stringstream noKey(std::string(2 * sizeof(cublasLtMatmulAlgo_t), '0') + "\n");
+    EXPECT_FALSE(cache.load(noKey));
+    EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(CublasAlgoCache, FlushMergesFile)
+{
+    auto const path = (std::filesystem::temp_directory_path() / "cublasAlgoCacheTest.txt").string();
+    std::filesystem::remove(path);
+
+    CublasAlgoCache first(path);
+    first.store("a", makeAlgo(1));
+    ASSERT_TRUE(first.flush());
+
+    CublasAlgoCache second(path);
+    second.store("b", makeAlgo(2));
+    ASSERT_TRUE(second.flush());
+    EXPECT_EQ(second.size(), 2);
+
+    CublasAlgoCache reloaded(path);
+    std::ifstream file(path);
+    ASSERT_TRUE(reloaded.load(file));
+    EXPECT_EQ(reloaded.size(), 2);
+    EXPECT_TRUE(isSameAlgo(*reloaded.lookup("a"), makeAlgo(1)));
+    EXPECT_TRUE(isSameAlgo(*reloaded.lookup("b"), makeAlgo(2)));
+
+    std::filesystem::remove(path);
+}
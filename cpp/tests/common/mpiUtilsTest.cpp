@@ -248,6 +248,41 @@ TEST(MPIUtils, VectorBcastEmpty)
     ASSERT_EQ(vec.size(), vecSize);
 }
 
+TEST(MPIUtils, RecvPollSpinsThenSleeps)
+{
+    auto& comm = mpi::MpiComm::world();
+    auto const rank = comm.getRank();
+    auto constexpr tag = 1023;
+    std::int32_t const expectedValue = 42;
+    mpi::PollConfig config;
+    config.spinDuration = std::chrono::microseconds{10};
+    config.maxSleep = std::chrono::microseconds{100};
+
+    auto request = comm.sendAsync(&expectedValue, 1, mpi::MpiType::kINT32, rank, tag);
+    comm.recvPoll(rank, tag, config);
+    std::int32_t value{0};
+    comm.recv(&value, 1, mpi::MpiType::kINT32, rank, tag);
+    request->wait();
+    EXPECT_EQ(value, expectedValue);
+}
+
+TEST(MPIUtils, BcastWithHeader)
+{
+    auto& session = mpi::MpiComm::session();
+    auto constexpr root = 0;
+    auto constexpr tag = 1024;
+    for (std::size_t const size : {0, 1, 100000})
+    {
+        std::vector<char> payload;
+        if (session.getRank() == root)
+        {
+            payload.assign(size, 'x');
+        }
+        session.bcastWithHeader(payload, root, tag);
+        EXPECT_EQ(payload, std::vector<char>(size, 'x'));
+    }
+}
+
 // Not fundamental
 struct NotFundamental
 {
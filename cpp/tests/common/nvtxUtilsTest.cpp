@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/nvtxUtils.h"
+
+#include <set>
+#include <string>
+
+using namespace tensorrt_llm::common::nvtx;
+
+TEST(NvtxUtilsTest, CategoriesHaveDistinctNames)
+{
+    std::set<std::string> names;
+    for (auto const category : {Category::kSCHEDULER, Category::kKV, Category::kDECODER, Category::kCOMM,
+             Category::kLORA, Category::kRESPONSE, Category::kEXECUTOR})
+    {
+        names.insert(getCategoryName(category));
+    }
+    EXPECT_EQ(names.size(), 7U);
+    EXPECT_EQ(names.count("unknown"), 0U);
+}
+
+TEST(NvtxUtilsTest, RangesNestWithAndWithoutPayload)
+{
+    // Without a profiler attached the ranges are no-ops, under nsys they show up nested in the TensorRT-LLM domain.
+    TLLM_NVTX_SCOPED_RANGE(kSCHEDULER, outer);
+    {
+        ScopedRange const range{Category::kDECODER, "iteration", 42, BatchComposition{2, 14, 2062}};
+        TLLM_NVTX_SCOPED_RANGE(kKV, inner);
+    }
+    SUCCEED();
+}
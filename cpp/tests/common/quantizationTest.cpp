@@ -35,6 +35,9 @@ TEST(Quantization, Constructor)
     static_assert(QuantMode::int8KvCache().hasInt8KvCache());
     static_assert(QuantMode::fp8KvCache().hasFp8KvCache());
     static_assert(QuantMode::fp8Qdq().hasFp8Qdq());
+    static_assert(QuantMode::int4KvCache().hasInt4KvCache());
+    static_assert(QuantMode::int4KvCache().hasKvCacheQuant());
+    static_assert(!QuantMode::fp8RowWise().hasInt4KvCache());
 }
 
 TEST(Quantization, PlusMinus)
@@ -51,3 +54,12 @@ TEST(Quantization, PlusMinus)
     EXPECT_FALSE(quantMode.hasPerChannelScaling());
     EXPECT_EQ(quantMode, QuantMode::none());
 }
+
+TEST(Quantization, FromQuantAlgo)
+{
+    auto const quantMode = QuantMode::fromQuantAlgo("W4A16", "INT4");
+    EXPECT_TRUE(quantMode.hasInt4Weights());
+    EXPECT_TRUE(quantMode.hasInt4KvCache());
+    EXPECT_FALSE(quantMode.hasInt8KvCache());
+    EXPECT_FALSE(quantMode.hasFp8KvCache());
+}
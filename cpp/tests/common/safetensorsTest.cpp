@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/safetensors.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace tensorrt_llm::common::safetensors;
+
+namespace
+{
+// Writes tensors "a" (F32 [2, 3]) and "b" (I32 [4096]) in the safetensors format
+std::filesystem::path writeSafeTensors(std::vector<float> const& a, std::vector<int32_t> const& b)
+{
+    auto const aBytes = a.size() * sizeof(float);
+    auto const bBytes = b.size() * sizeof(int32_t);
+    std::string header = R"({"__metadata__":{"format":"pt"},"a":{"dtype":"F32","shape":[2,3],"data_offsets":[0,)"
+        + std::to_string(aBytes) + R"(]},"b":{"dtype":"I32","shape":[4096],"data_offsets":[)" + std::to_string(aBytes)
+        + "," + std::to_string(aBytes + bBytes) + "]}}";
+    auto const path = std::filesystem::temp_directory_path() / "safetensorsTest.safetensors";
+    std::ofstream file(path, std::ios::binary);
+    auto const headerSize = static_cast<int64_t>(header.size());
+    file.write(reinterpret_cast<char const*>(&headerSize), sizeof(headerSize));
+    file.write(header.data(), headerSize);
+    file.write(reinterpret_cast<char const*>(a.data()), aBytes);
+    file.write(reinterpret_cast<char const*>(b.data()), bBytes);
+    return path;
+}
+} // namespace
+
+TEST(SafeTensorsTest, ReadTensors)
+{
+    std::vector<float> const a{0.F, 1.F, 2.F, 3.F, 4.F, 5.F};
+    std::vector<int32_t> b(4096);
+    std::iota(b.begin(), b.end(), 0);
+    auto const path = writeSafeTensors(a, b);
+
+    std::shared_ptr<INdArray> tensorB;
+    {
+        auto const file = ISafeTensor::open(path.c_str());
+        EXPECT_EQ(file->keys(), (std::vector<std::string>{"a", "b"}));
+        file->prefetch(file->keys(), 2);
+
+        auto const tensorA = file->getTensor("a");
+        EXPECT_EQ(tensorA->dtype(), nvinfer1::DataType::kFLOAT);
+        EXPECT_EQ(tensorA->dims(), (std::vector<int64_t>{2, 3}));
+        EXPECT_EQ(std::vector<float>(static_cast<float const*>(tensorA->data()),
+                      static_cast<float const*>(tensorA->data()) + a.size()),
+            a);
+        tensorB = file->getTensor("b");
+        EXPECT_ANY_THROW(file->getTensor("c"));
+    }
+    // The tensor keeps its data alive after the file is closed
+    EXPECT_EQ(static_cast<int32_t const*>(tensorB->data())[4095], 4095);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/shmRingBuffer.h"
+
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using tensorrt_llm::common::ShmRingBuffer;
+namespace shm = tensorrt_llm::common::shm;
+namespace tle = tensorrt_llm::executor;
+
+namespace
+{
+std::string getUniqueName(std::string const& test)
+{
+    return "/trtllm_" + test + "_" + std::to_string(::getpid());
+}
+} // namespace
+
+TEST(ShmRingBufferTest, RequestsAreReadInPlace)
+{
+    auto producer = ShmRingBuffer::create(getUniqueName("requests"), 1024);
+    auto consumer = ShmRingBuffer::open(getUniqueName("requests"));
+    EXPECT_EQ(consumer.getCapacity(), 1024);
+    EXPECT_FALSE(consumer.tryRead().has_value());
+
+    tle::VecTokens const inputTokens{1, 2, 3, 4, 5};
+    ASSERT_TRUE(shm::tryWriteRequest(producer, 42, inputTokens, 16, true));
+
+    auto const message = consumer.tryRead();
+    ASSERT_TRUE(message.has_value());
+    auto const& request = shm::asRequest(*message);
+    EXPECT_EQ(request.requestId, 42);
+    EXPECT_EQ(request.maxTokens, 16);
+    EXPECT_TRUE(request.streaming);
+    EXPECT_EQ(tle::VecTokens(request.getInputTokens(), request.getInputTokens() + request.numInputTokens), inputTokens);
+    EXPECT_THROW(static_cast<void>(shm::asResponse(*message)), std::exception);
+    consumer.release();
+    EXPECT_FALSE(consumer.tryRead().has_value());
+}
+
+TEST(ShmRingBufferTest, WrapAround)
+{
+    auto ring = ShmRingBuffer::create(getUniqueName("wrap"), 64);
+    tle::VecTokens const tokens{7, 8, 9};
+    auto const recordSize = ShmRingBuffer::getRecordSize(sizeof(shm::FlatResponse) + 3 * sizeof(tle::TokenIdType));
+    ASSERT_EQ(recordSize, 40);
+
+    ASSERT_TRUE(shm::tryWriteResponse(ring, 1, tokens, false));
+    // Does not fit until the first response is released
+    EXPECT_FALSE(shm::tryWriteResponse(ring, 2, tokens, true));
+    auto message = ring.tryRead();
+    ASSERT_TRUE(message.has_value());
+    EXPECT_EQ(shm::asResponse(*message).requestId, 1);
+    ring.release();
+
+    // Only 24 bytes are left before the end, the response is written at the beginning
+    ASSERT_TRUE(shm::tryWriteResponse(ring, 2, tokens, true));
+    message = ring.tryRead();
+    ASSERT_TRUE(message.has_value());
+    auto const& response = shm::asResponse(*message);
+    EXPECT_EQ(response.requestId, 2);
+    EXPECT_TRUE(response.isFinal);
+    EXPECT_EQ(response.getTokens()[2], 9);
+    ring.release();
+
+    EXPECT_THROW(static_cast<void>(ring.tryReserve(1, 128)), std::exception);
+}
+
+TEST(ShmRingBufferTest, ConcurrentProducerConsumer)
+{
+    auto producer = ShmRingBuffer::create(getUniqueName("concurrent"), 256);
+    auto consumer = ShmRingBuffer::open(getUniqueName("concurrent"));
+    tle::IdType constexpr numResponses = 10000;
+
+    std::thread producerThread(
+        [&producer]()
+        {
+            for (tle::IdType id = 0; id < numResponses; ++id)
+            {
+                tle::VecTokens const tokens(id % 7, static_cast<tle::TokenIdType>(id));
+                while (!shm::tryWriteResponse(producer, id, tokens, id + 1 == numResponses))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+    tle::IdType expectedId = 0;
+    bool done = false;
+    while (!done)
+    {
+        auto const message = consumer.tryRead();
+        if (!message)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        auto const& response = shm::asResponse(*message);
+        ASSERT_EQ(response.requestId, expectedId);
+        ASSERT_EQ(response.numTokens, static_cast<tle::SizeType32>(expectedId % 7));
+        for (tle::SizeType32 i = 0; i < response.numTokens; ++i)
+        {
+            ASSERT_EQ(response.getTokens()[i], static_cast<tle::TokenIdType>(expectedId));
+        }
+        done = response.isFinal;
+        consumer.release();
+        ++expectedId;
+    }
+    producerThread.join();
+    EXPECT_EQ(expectedId, numResponses);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/startupProfiler.h"
+
+#include <chrono>
+
+using namespace tensorrt_llm::common;
+using namespace std::chrono_literals;
+
+TEST(StartupProfilerTest, AccumulatesPhasesInPhaseOrder)
+{
+    StartupProfiler profiler;
+    auto const t0 = StartupProfiler::Clock::time_point{};
+    profiler.record(StartupPhase::kCONTEXT_CREATION, t0 + 100ms, t0 + 110ms);
+    profiler.record(StartupPhase::kTRT_DESERIALIZE, t0 + 20ms, t0 + 100ms);
+    profiler.record(StartupPhase::kCONTEXT_CREATION, t0 + 110ms, t0 + 115ms);
+    profiler.record(StartupPhase::kENGINE_READ, t0, t0 + 20ms);
+
+    auto const stats = profiler.getStats();
+    ASSERT_EQ(stats.phases.size(), 3);
+    EXPECT_EQ(stats.phases[0].name, "engine_read");
+    EXPECT_EQ(stats.phases[1].name, "trt_deserialize");
+    EXPECT_EQ(stats.phases[2].name, "context_creation");
+    EXPECT_EQ(stats.phases[2].count, 2);
+    EXPECT_DOUBLE_EQ(stats.phases[2].durationMS, 15.0);
+    EXPECT_DOUBLE_EQ(stats.totalDurationMS, 115.0);
+}
+
+TEST(StartupProfilerTest, TotalIsWallTimeOfNestedPhases)
+{
+    StartupProfiler profiler;
+    auto const t0 = StartupProfiler::Clock::time_point{};
+    profiler.record(StartupPhase::kXQA_JIT, t0 + 10ms, t0 + 30ms);
+    profiler.record(StartupPhase::kWARMUP, t0, t0 + 50ms);
+
+    auto const stats = profiler.getStats();
+    ASSERT_EQ(stats.phases.size(), 2);
+    EXPECT_EQ(stats.phases[0].name, "xqa_jit");
+    EXPECT_EQ(stats.phases[1].name, "warmup");
+    EXPECT_DOUBLE_EQ(stats.totalDurationMS, 50.0);
+}
+
+TEST(StartupProfilerTest, ScopedPhaseAndReset)
+{
+    StartupProfiler profiler;
+    {
+        StartupProfiler::ScopedPhase const phase{StartupPhase::kMPI_INIT, profiler};
+    }
+    auto stats = profiler.getStats();
+    ASSERT_EQ(stats.phases.size(), 1);
+    EXPECT_EQ(stats.phases[0].name, "mpi_init");
+    EXPECT_EQ(stats.phases[0].count, 1);
+    EXPECT_GE(stats.phases[0].durationMS, 0.0);
+
+    profiler.reset();
+    stats = profiler.getStats();
+    EXPECT_TRUE(stats.phases.empty());
+    EXPECT_EQ(stats.totalDurationMS, 0.0);
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/statsSerialization.h"
+
+#include <string>
+#include <unistd.h>
+
+using namespace tensorrt_llm::common;
+namespace tle = tensorrt_llm::executor;
+
+namespace
+{
+tle::IterationStats makeIterationStats(tle::IterationType iter)
+{
+    tle::IterationStats stats{};
+    stats.timestamp = "10-15-2026 04:38:35.123456";
+    stats.iter = iter;
+    stats.iterLatencyMS = 12.5;
+    stats.numActiveRequests = 7;
+    stats.maxNumActiveRequests = 64;
+    stats.gpuMemUsage = 1ULL << 35;
+    tle::KvCacheStats kvCacheStats{};
+    kvCacheStats.maxNumBlocks = 1000;
+    kvCacheStats.usedNumBlocks = 250;
+    kvCacheStats.reusedBlocks = 3;
+    stats.kvCacheStats = kvCacheStats;
+    tle::InflightBatchingStats batching{};
+    batching.numGenRequests = 6;
+    batching.avgNumDecodedTokensPerIter = 1.5F;
+    stats.inflightBatchingStats = batching;
+    return stats;
+}
+
+tle::RequestStatsPerIteration makeRequestStats(tle::IterationType iter)
+{
+    tle::RequestStats first{};
+    first.id = 42;
+    first.stage = tle::RequestStage::kGENERATION_IN_PROGRESS;
+    first.numGeneratedTokens = 17;
+    first.scheduled = true;
+    first.paused = true;
+
+    tle::RequestStats second{};
+    second.id = 43;
+    second.stage = tle::RequestStage::kQUEUED;
+    second.disServingStats = tle::DisServingRequestStats{5.0};
+    return tle::RequestStatsPerIteration{iter, {first, second}};
+}
+
+void expectEqual(tle::RequestStatsPerIteration const& actual, tle::RequestStatsPerIteration const& expected)
+{
+    EXPECT_EQ(actual.iter, expected.iter);
+    ASSERT_EQ(actual.requestStats.size(), expected.requestStats.size());
+    for (std::size_t i = 0; i < actual.requestStats.size(); ++i)
+    {
+        auto const& a = actual.requestStats[i];
+        auto const& e = expected.requestStats[i];
+        EXPECT_EQ(a.id, e.id);
+        EXPECT_EQ(a.stage, e.stage);
+        EXPECT_EQ(a.numGeneratedTokens, e.numGeneratedTokens);
+        EXPECT_EQ(a.scheduled, e.scheduled);
+        EXPECT_EQ(a.paused, e.paused);
+        ASSERT_EQ(a.disServingStats.has_value(), e.disServingStats.has_value());
+        if (e.disServingStats)
+        {
+            EXPECT_EQ(a.disServingStats->kvCacheTransferMS, e.disServingStats->kvCacheTransferMS);
+        }
+    }
+}
+} // namespace
+
+TEST(StatsSerializationTest, IterationStatsRoundTrip)
+{
+    auto const stats = makeIterationStats(3);
+    std::vector<std::byte> buffer(StatsSerialization::serializedSize(stats));
+    StatsSerialization::serialize(stats, buffer.data());
+    auto const decoded = StatsSerialization::deserializeIterationStats(buffer.data(), buffer.size());
+
+    // The formatted timestamp is turned into a number on the writing side and formatted again when read
+    EXPECT_EQ(decoded.timestamp, stats.timestamp);
+    EXPECT_EQ(decoded.iter, stats.iter);
+    EXPECT_EQ(decoded.iterLatencyMS, stats.iterLatencyMS);
+    EXPECT_EQ(decoded.numActiveRequests, stats.numActiveRequests);
+    EXPECT_EQ(decoded.maxNumActiveRequests, stats.maxNumActiveRequests);
+    EXPECT_EQ(decoded.gpuMemUsage, stats.gpuMemUsage);
+    ASSERT_TRUE(decoded.kvCacheStats.has_value());
+    EXPECT_EQ(decoded.kvCacheStats->maxNumBlocks, 1000);
+    EXPECT_EQ(decoded.kvCacheStats->usedNumBlocks, 250);
+    EXPECT_EQ(decoded.kvCacheStats->reusedBlocks, 3);
+    EXPECT_FALSE(decoded.crossKvCacheStats.has_value());
+    EXPECT_FALSE(decoded.staticBatchingStats.has_value());
+    ASSERT_TRUE(decoded.inflightBatchingStats.has_value());
+    EXPECT_EQ(decoded.inflightBatchingStats->numGenRequests, 6);
+    EXPECT_EQ(decoded.inflightBatchingStats->avgNumDecodedTokensPerIter, 1.5F);
+
+    // Readers ignore fields appended by newer schema versions, but not missing ones
+    buffer.resize(buffer.size() + 16);
+    EXPECT_EQ(StatsSerialization::deserializeIterationStats(buffer.data(), buffer.size()).iter, stats.iter);
+    EXPECT_THROW(
+        static_cast<void>(StatsSerialization::deserializeIterationStats(buffer.data(), 20)), std::exception);
+}
+
+TEST(StatsSerializationTest, RequestStatsRoundTrip)
+{
+    auto const stats = makeRequestStats(5);
+    std::vector<std::byte> buffer(StatsSerialization::serializedSize(stats));
+    StatsSerialization::serialize(stats, buffer.data());
+    expectEqual(StatsSerialization::deserializeRequestStatsPerIteration(buffer.data(), buffer.size()), stats);
+}
+
+TEST(StatsSerializationTest, BulkBuffer)
+{
+    std::deque<tle::IterationStats> const iterationStats{makeIterationStats(1), makeIterationStats(2)};
+    std::deque<tle::RequestStatsPerIteration> const requestStats{makeRequestStats(1)};
+    std::vector<char> buffer;
+    StatsSerialization::append(iterationStats, buffer);
+    StatsSerialization::append(requestStats, buffer);
+
+    auto const decoded = StatsSerialization::deserializeStats(buffer);
+    ASSERT_EQ(decoded.iterationStats.size(), 2);
+    EXPECT_EQ(decoded.iterationStats[0].iter, 1);
+    EXPECT_EQ(decoded.iterationStats[1].iter, 2);
+    ASSERT_EQ(decoded.requestStats.size(), 1);
+    expectEqual(decoded.requestStats[0], requestStats[0]);
+}
+
+TEST(StatsSerializationTest, ShmRing)
+{
+    auto const name = "/trtllm_stats_" + std::to_string(::getpid());
+    auto producer = ShmRingBuffer::create(name, 4096);
+    auto consumer = ShmRingBuffer::open(name);
+
+    ASSERT_TRUE(shm::tryWriteIterationStats(producer, makeIterationStats(8)));
+    ASSERT_TRUE(shm::tryWriteRequestStats(producer, makeRequestStats(8)));
+
+    auto message = consumer.tryRead();
+    ASSERT_TRUE(message.has_value());
+    EXPECT_EQ(shm::asIterationStats(*message).iter, 8);
+    EXPECT_THROW(static_cast<void>(shm::asRequestStats(*message)), std::exception);
+    consumer.release();
+
+    message = consumer.tryRead();
+    ASSERT_TRUE(message.has_value());
+    expectEqual(shm::asRequestStats(*message), makeRequestStats(8));
+    consumer.release();
+    EXPECT_FALSE(consumer.tryRead().has_value());
+}
@@ -99,3 +99,14 @@ TEST(StringUtil, str2set)
         }
     }
 }
+
+TEST(StringUtil, hex)
+{
+    std::string const bytes{"\x00\x7f\x80\xff", 4};
+    EXPECT_EQ(toHex(bytes), "007f80ff");
+    EXPECT_EQ(fromHex("007f80ff"), bytes);
+    EXPECT_EQ(fromHex(""), std::string{});
+    EXPECT_FALSE(fromHex("0").has_value());
+    EXPECT_FALSE(fromHex("0g").has_value());
+    EXPECT_FALSE(fromHex("FF").has_value());
+}
@@ -44,3 +44,11 @@ TEST(TimestampUtils, getCurrentTimestamp)
     }
     EXPECT_NEAR(delta, sleepUs, tolUs) << "delta: " << delta << " expected " << sleepUs << std::endl;
 }
+
+TEST(TimestampUtils, formatAndParseRoundTrip)
+{
+    auto const timestampUs = getCurrentTimestampUs();
+    auto const timestamp = formatTimestamp(timestampUs);
+    EXPECT_EQ(parseTimestamp(timestamp), timestampUs) << timestamp;
+    EXPECT_EQ(parseTimestamp("not a timestamp"), 0);
+}
@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/kernels/customAllReduceKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/ipcUtils.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace tk = tensorrt_llm::kernels;
+namespace tc = tensorrt_llm::common;
+
+using namespace tensorrt_llm::runtime;
+
+// Run with mpirun on 2, 4, 6 or 8 GPUs of one node, e.g. mpirun -n 4 ./allReduceKernelTest. The single-rank tests run
+// without MPI as well.
+
+namespace
+{
+
+SizeType32 constexpr kTokens = 8;
+SizeType32 constexpr kHiddenSize = 1024;
+std::size_t constexpr kNumElts = kTokens * kHiddenSize;
+float constexpr kEps = 1e-5F;
+
+std::vector<half> makeValues(int seed, std::size_t size, float lo, float hi)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> distr(lo, hi);
+    std::vector<half> values(size);
+    std::generate(values.begin(), values.end(), [&]() { return static_cast<half>(distr(generator)); });
+    return values;
+}
+
+//! The input of a rank. Every rank can generate the inputs of all others, for the reference sums.
+std::vector<half> makeRankInput(int rank)
+{
+    return makeValues(1234 + rank, kNumElts, -1.F, 1.F);
+}
+
+//! The sum of the inputs of numRanks ranks rounded to half after each add, from rank 0 on like the kernels.
+std::vector<float> referenceSum(int numRanks)
+{
+    std::vector<half> sums(kNumElts, static_cast<half>(0.F));
+    for (int rank = 0; rank < numRanks; ++rank)
+    {
+        auto const input = makeRankInput(rank);
+        for (std::size_t i = 0; i < kNumElts; ++i)
+        {
+            sums[i] = static_cast<half>(static_cast<float>(sums[i]) + static_cast<float>(input[i]));
+        }
+    }
+    return {sums.begin(), sums.end()};
+}
+
+#ifdef ENABLE_FP8
+//! The sum of the COMPRESS_FP8 one-shot kernel before its rounding to half: every chunk of 32 packed vectors of every
+//! rank is quantized to FP8 with its own scale, the dequantized values are summed in FP32 from rank 0 on.
+std::vector<float> compressedReferenceSum(int numRanks)
+{
+    std::size_t constexpr kChunkElts = 32 * 16 / sizeof(half);
+    float constexpr kMaxVal = 448.F;
+    float constexpr kMinScalingFactorRcp = 448.F * 512.F;
+    std::vector<float> sums(kNumElts, 0.F);
+    for (int rank = 0; rank < numRanks; ++rank)
+    {
+        auto const input = makeRankInput(rank);
+        for (std::size_t chunkStart = 0; chunkStart < kNumElts; chunkStart += kChunkElts)
+        {
+            auto const chunkEnd = std::min(chunkStart + kChunkElts, kNumElts);
+            float amax = 0.F;
+            for (auto i = chunkStart; i < chunkEnd; ++i)
+            {
+                amax = std::max(amax, std::abs(static_cast<float>(input[i])));
+            }
+            amax = std::max(amax, 1e-6F);
+            auto const quantScale = std::min(kMaxVal / amax, kMinScalingFactorRcp);
+            auto const scale = std::max(amax / kMaxVal, 1.F / kMinScalingFactorRcp);
+            for (auto i = chunkStart; i < chunkEnd; ++i)
+            {
+                auto const quantized = __nv_fp8_e4m3(static_cast<float>(input[i]) * quantScale);
+                sums[i] += static_cast<float>(quantized) * scale;
+            }
+        }
+    }
+    return sums;
+}
+#endif
+
+ITensor::SharedPtr toDevice(BufferManager const& manager, std::vector<half> const& values)
+{
+    auto tensor = manager.gpu(ITensor::makeShape({static_cast<SizeType32>(values.size())}), nvinfer1::DataType::kHALF);
+    manager.copy(values.data(), *tensor, MemoryType::kCPU);
+    return tensor;
+}
+
+template <typename T>
+std::vector<T> toHost(BufferManager const& manager, ITensor const& tensor)
+{
+    std::vector<T> values(tensor.getSizeInBytes() / sizeof(T));
+    manager.copy(tensor, values.data(), MemoryType::kCPU);
+    manager.getStream().synchronize();
+    return values;
+}
+
+//! Checks the outputs of the residual + RMSNorm + per-token quantization fusion against expectedIntermediate, the
+//! all-reduced sum plus the residual. The norm reference starts from the intermediate output of the kernels, so that
+//! the check of the quantization does not depend on the order of the sum.
+template <typename QuantT>
+void checkNormQuant(std::vector<float> const& expectedIntermediate, std::vector<half> const& gamma,
+    std::vector<half> const& intermediate, std::vector<QuantT> const& quantized, std::vector<float> const& scales,
+    float maxQuantVal, float relTolerance)
+{
+    for (SizeType32 t = 0; t < kTokens; ++t)
+    {
+        std::vector<float> normed(kHiddenSize);
+        double sumSquares = 0.;
+        for (SizeType32 i = 0; i < kHiddenSize; ++i)
+        {
+            auto const idx = t * kHiddenSize + i;
+            auto const val = static_cast<float>(intermediate[idx]);
+            EXPECT_NEAR(val, expectedIntermediate[idx], 4e-3F * std::abs(expectedIntermediate[idx]) + 4e-3F)
+                << "token " << t << " channel " << i;
+            sumSquares += val * val;
+        }
+        auto const rsigma = 1. / std::sqrt(sumSquares / kHiddenSize + kEps);
+        for (SizeType32 i = 0; i < kHiddenSize; ++i)
+        {
+            normed[i] = static_cast<float>(
+                static_cast<float>(intermediate[t * kHiddenSize + i]) * rsigma * static_cast<float>(gamma[i]));
+        }
+        auto const amax = std::abs(*std::max_element(
+            normed.begin(), normed.end(), [](float a, float b) { return std::abs(a) < std::abs(b); }));
+        auto const scale = scales[t];
+        EXPECT_NEAR(scale, amax / maxQuantVal, 1e-2F * amax / maxQuantVal) << "token " << t;
+        for (SizeType32 i = 0; i < kHiddenSize; ++i)
+        {
+            auto const dequantized = static_cast<float>(quantized[t * kHiddenSize + i]) * scale;
+            EXPECT_NEAR(dequantized, normed[i], relTolerance * std::abs(normed[i]) + 2.F * scale)
+                << "token " << t << " channel " << i;
+        }
+    }
+}
+
+//! The inputs and outputs of the residual + RMSNorm + quantization fusion of one rank.
+template <typename QuantT>
+struct NormQuantBuffers
+{
+    explicit NormQuantBuffers(BufferManager const& manager)
+        : residualHost(makeValues(42, kNumElts, -1.F, 1.F))
+        , gammaHost(makeValues(43, kHiddenSize, 0.5F, 1.5F))
+        , residual(toDevice(manager, residualHost))
+        , gamma(toDevice(manager, gammaHost))
+        , intermediate(manager.gpu(ITensor::makeShape({kTokens, kHiddenSize}), nvinfer1::DataType::kHALF))
+        , quantized(manager.gpu(ITensor::makeShape({kTokens, kHiddenSize}),
+              std::is_same_v<QuantT, int8_t> ? nvinfer1::DataType::kINT8 : nvinfer1::DataType::kFP8))
+        , scales(manager.gpu(ITensor::makeShape({kTokens}), nvinfer1::DataType::kFLOAT))
+    {
+    }
+
+    void setFusionParams(tk::AllReduceParams& params) const
+    {
+        params.local_output_buffer_ptr = quantized->data();
+        params.elts_total = kNumElts;
+        params.fusion_params.residual_buffer = residual->data();
+        params.fusion_params.weight_buffer = gamma->data();
+        params.fusion_params.hidden_size = kHiddenSize;
+        params.fusion_params.eps = kEps;
+        params.fusion_params.intermediate_buffer = intermediate->data();
+        params.fusion_params.scale_out_buffer = bufferCast<float>(*scales);
+    }
+
+    void check(BufferManager const& manager, std::vector<float> const& sum, float maxQuantVal, float relTolerance)
+    {
+        auto expectedIntermediate = sum;
+        for (std::size_t i = 0; i < kNumElts; ++i)
+        {
+            expectedIntermediate[i] += static_cast<float>(residualHost[i]);
+        }
+        checkNormQuant<QuantT>(expectedIntermediate, gammaHost, toHost<half>(manager, *intermediate),
+            toHost<QuantT>(manager, *quantized), toHost<float>(manager, *scales), maxQuantVal, relTolerance);
+    }
+
+    std::vector<half> residualHost;
+    std::vector<half> gammaHost;
+    ITensor::SharedPtr residual;
+    ITensor::SharedPtr gamma;
+    ITensor::SharedPtr intermediate;
+    ITensor::SharedPtr quantized;
+    ITensor::SharedPtr scales;
+};
+
+//! The fusion without an all-reduce, as run after an NCCL all-reduce: the intermediate buffer holds the sum.
+template <typename QuantT>
+void testResidualRmsNormQuant(tk::AllReduceFusionOp fusionOp, float maxQuantVal, float relTolerance)
+{
+    if (tc::getDeviceCount() == 0)
+    {
+        GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+    }
+    BufferManager manager{std::make_shared<CudaStream>()};
+    NormQuantBuffers<QuantT> buffers{manager};
+    auto const input = makeRankInput(0);
+    manager.copy(input.data(), *buffers.intermediate, MemoryType::kCPU);
+
+    tk::AllReduceParams params;
+    buffers.setFusionParams(params);
+    tk::residualRmsNorm(params, nvinfer1::DataType::kHALF, fusionOp, manager.getStream().get());
+    buffers.check(manager, referenceSum(1), maxQuantVal, relTolerance);
+}
+
+TEST(ResidualRmsNormQuantTest, Int8)
+{
+    testResidualRmsNormQuant<int8_t>(tk::AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_INT8, 127.F, 0.F);
+}
+
+#ifdef ENABLE_FP8
+TEST(ResidualRmsNormQuantTest, Fp8)
+{
+    testResidualRmsNormQuant<__nv_fp8_e4m3>(tk::AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_FP8, 448.F, 1.F / 8);
+}
+#endif
+
+class AllReduceKernelTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        auto& session = COMM_SESSION;
+        mWorldSize = session.getSize();
+        mRank = session.getRank();
+        if (mWorldSize < 2)
+        {
+            GTEST_SKIP() << "Run with mpirun on 2, 4, 6 or 8 GPUs of one node.";
+        }
+        if (tc::getDeviceCount() < mWorldSize)
+        {
+            GTEST_SKIP() << "The custom all-reduce needs a GPU of the node per rank.";
+        }
+        mWorldConfig = std::make_unique<WorldConfig>(WorldConfig::mpi());
+        TLLM_CUDA_CHECK(cudaSetDevice(mWorldConfig->getDevice()));
+        mManager = std::make_unique<BufferManager>(std::make_shared<CudaStream>());
+        mBuffers = std::make_unique<AllReduceBuffers>(kTokens, 1, 1, kHiddenSize, *mManager, *mWorldConfig);
+        if (bufferCast<int64_t>(*mBuffers->mAllReduceCommPtrs)[0] == 0)
+        {
+            GTEST_SKIP() << "The GPUs of the node have no peer access.";
+        }
+        mInput = toDevice(*mManager, makeRankInput(mRank));
+    }
+
+    //! The params of the next all-reduce. Every rank must make the same calls, they all advance the barrier flag.
+    tk::AllReduceParams makeParams(void* output, bool hasNvls = false, std::size_t nodeSize = 0)
+    {
+        auto params = tk::AllReduceParams::deserialize(
+            bufferCast<int64_t>(*mBuffers->mAllReduceCommPtrs), mWorldSize, mRank, hasNvls, nodeSize);
+        params.local_input_buffer_ptr = mInput->data();
+        params.local_output_buffer_ptr = output;
+        params.elts_total = kNumElts;
+        return params;
+    }
+
+    //! Checks an all-reduce without fusion against the sum of the inputs of all ranks, in any order.
+    void checkSum(ITensor const& output, float relTolerance) const
+    {
+        auto const expected = referenceSum(mWorldSize);
+        auto const outputHost = toHost<half>(*mManager, output);
+        for (std::size_t i = 0; i < kNumElts; ++i)
+        {
+            EXPECT_NEAR(static_cast<float>(outputHost[i]), expected[i], relTolerance * std::abs(expected[i]) + 4e-3F)
+                << "element " << i;
+        }
+    }
+
+    ITensor::SharedPtr makeOutput() const
+    {
+        auto output = mManager->gpu(ITensor::makeShape({kTokens, kHiddenSize}), nvinfer1::DataType::kHALF);
+        mManager->setZero(*output);
+        return output;
+    }
+
+    template <typename QuantT>
+    void testNormQuant(tk::AllReduceStrategyType strategy, tk::AllReduceFusionOp fusionOp, float maxQuantVal,
+        float relTolerance, tk::AllReduceStrategyConfig config = tk::AllReduceStrategyConfig(0))
+    {
+        ASSERT_TRUE(tk::configurationSupported(strategy, kNumElts, mWorldSize, nvinfer1::DataType::kHALF));
+        NormQuantBuffers<QuantT> buffers{*mManager};
+        auto params = makeParams(nullptr);
+        buffers.setFusionParams(params);
+        tk::customAllReduce(
+            params, nvinfer1::DataType::kHALF, strategy, config, fusionOp, mManager->getStream().get());
+        auto sum = referenceSum(mWorldSize);
+#ifdef ENABLE_FP8
+        if (tk::hasConfigFlag(config, tk::AllReduceStrategyConfig::COMPRESS_FP8))
+        {
+            sum = compressedReferenceSum(mWorldSize);
+        }
+#endif
+        buffers.check(*mManager, sum, maxQuantVal, relTolerance);
+    }
+
+    int mWorldSize{0};
+    int mRank{0};
+    std::unique_ptr<WorldConfig> mWorldConfig;
+    std::unique_ptr<BufferManager> mManager;
+    std::unique_ptr<AllReduceBuffers> mBuffers;
+    ITensor::SharedPtr mInput;
+};
+
+TEST_F(AllReduceKernelTest, OneShotResidualRmsNormQuantInt8)
+{
+    testNormQuant<int8_t>(
+        tk::AllReduceStrategyType::ONESHOT, tk::AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_INT8, 127.F, 0.F);
+}
+
+TEST_F(AllReduceKernelTest, TwoShotResidualRmsNormQuantInt8)
+{
+    testNormQuant<int8_t>(
+        tk::AllReduceStrategyType::TWOSHOT, tk::AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_INT8, 127.F, 0.F);
+}
+
+#ifdef ENABLE_FP8
+TEST_F(AllReduceKernelTest, OneShotResidualRmsNormQuantFp8)
+{
+    testNormQuant<__nv_fp8_e4m3>(
+        tk::AllReduceStrategyType::ONESHOT, tk::AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_FP8, 448.F, 1.F / 8);
+}
+
+TEST_F(AllReduceKernelTest, TwoShotResidualRmsNormQuantFp8)
+{
+    testNormQuant<__nv_fp8_e4m3>(
+        tk::AllReduceStrategyType::TWOSHOT, tk::AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_FP8, 448.F, 1.F / 8);
+}
+#endif
+
+TEST_F(AllReduceKernelTest, Nvls)
+{
+    // The NVLS buffer is not ping-ponged, the second call checks that the barriers guard its reuse.
+    for (int iter = 0; iter < 2; ++iter)
+    {
+        auto output = makeOutput();
+        auto params = makeParams(output->data(), true);
+        if (params.nvls_mc_ptr == nullptr)
+        {
+            // Multicast support is agreed on by all ranks, they all skip.
+            GTEST_SKIP() << "The GPUs of the node do not support NVLink SHARP multicast.";
+        }
+        ASSERT_TRUE(tk::configurationSupported(
+            tk::AllReduceStrategyType::NVLS, kNumElts, mWorldSize, nvinfer1::DataType::kHALF));
+        tk::customAllReduce(params, nvinfer1::DataType::kHALF, tk::AllReduceStrategyType::NVLS,
+            tk::AllReduceStrategyConfig(0), tk::AllReduceFusionOp::NONE, mManager->getStream().get());
+        checkSum(*output, 4e-3F);
+    }
+}
+
+TEST_F(AllReduceKernelTest, Hierarchical)
+{
+    ASSERT_TRUE(tk::configurationSupported(
+        tk::AllReduceStrategyType::HIERARCHICAL, kNumElts, mWorldSize, nvinfer1::DataType::kHALF));
+    auto output = makeOutput();
+    // The ranks of this node form one node group, the nodes of the group are emulated by the step in between.
+    auto params = makeParams(output->data(), false, mWorldSize);
+    auto const stream = mManager->getStream().get();
+    tk::hierarchicalReduceScatter(params, nvinfer1::DataType::kHALF, stream);
+    ASSERT_EQ(params.elts_per_rank, kNumElts / mWorldSize);
+    ASSERT_EQ(params.rank_offset, mRank * params.elts_per_rank);
+    mManager->getStream().synchronize();
+
+    // The node sum of the slice of this rank is in its IPC buffer. Doubling it in place stands for the inter-node
+    // all-reduce with a second node of the same inputs, exact in half.
+    auto const expected = referenceSum(mWorldSize);
+    auto* slice = static_cast<half*>(params.peer_comm_buffer_ptrs[params.local_rank]) + params.rank_offset;
+    std::vector<half> sliceHost(params.elts_per_rank);
+    TLLM_CUDA_CHECK(cudaMemcpy(sliceHost.data(), slice, sliceHost.size() * sizeof(half), cudaMemcpyDeviceToHost));
+    for (std::size_t i = 0; i < sliceHost.size(); ++i)
+    {
+        auto const val = static_cast<float>(sliceHost[i]);
+        EXPECT_NEAR(val, expected[params.rank_offset + i], 4e-3F * std::abs(val) + 4e-3F) << "element " << i;
+        sliceHost[i] = static_cast<half>(2.F * val);
+    }
+    TLLM_CUDA_CHECK(cudaMemcpy(slice, sliceHost.data(), sliceHost.size() * sizeof(half), cudaMemcpyHostToDevice));
+
+    tk::hierarchicalAllGather(params, nvinfer1::DataType::kHALF, stream);
+    auto const outputHost = toHost<half>(*mManager, *output);
+    for (std::size_t i = 0; i < kNumElts; ++i)
+    {
+        EXPECT_NEAR(static_cast<float>(outputHost[i]), 2.F * expected[i], 8e-3F * std::abs(expected[i]) + 8e-3F)
+            << "element " << i;
+    }
+}
+
+#ifdef ENABLE_FP8
+TEST_F(AllReduceKernelTest, OneShotCompressFp8)
+{
+    auto output = makeOutput();
+    auto params = makeParams(output->data());
+    tk::customAllReduce(params, nvinfer1::DataType::kHALF, tk::AllReduceStrategyType::ONESHOT,
+        tk::AllReduceStrategyConfig::COMPRESS_FP8, tk::AllReduceFusionOp::NONE, mManager->getStream().get());
+    auto const expected = compressedReferenceSum(mWorldSize);
+    auto const exact = referenceSum(mWorldSize);
+    auto const outputHost = toHost<half>(*mManager, *output);
+    for (std::size_t i = 0; i < kNumElts; ++i)
+    {
+        auto const val = static_cast<float>(outputHost[i]);
+        // The emulated kernel matches up to the rounding to half, the exact sum up to an FP8 step of every rank.
+        EXPECT_NEAR(val, expected[i], 1e-3F * std::abs(expected[i]) + 1e-6F) << "element " << i;
+        EXPECT_NEAR(val, exact[i], mWorldSize / 16.F) << "element " << i;
+    }
+}
+
+TEST_F(AllReduceKernelTest, OneShotCompressFp8ResidualRmsNormQuantInt8)
+{
+    testNormQuant<int8_t>(tk::AllReduceStrategyType::ONESHOT, tk::AllReduceFusionOp::RESIDUAL_RMS_NORM_QUANT_INT8,
+        127.F, 0.F, tk::AllReduceStrategyConfig::COMPRESS_FP8);
+}
+#endif
+
+} // namespace
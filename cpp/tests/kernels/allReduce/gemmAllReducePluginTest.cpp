@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/mpiUtils.h"
+#include "tensorrt_llm/kernels/customAllReduceKernels.h"
+#include "tensorrt_llm/plugins/api/tllmPlugin.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/ipcUtils.h"
+#include "tensorrt_llm/runtime/worldConfig.h"
+
+#include <NvInferRuntime.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace tk = tensorrt_llm::kernels;
+namespace tc = tensorrt_llm::common;
+
+using namespace tensorrt_llm::runtime;
+
+// The NCCL tests run on a single GPU as well, where the all-reduce is a copy and the chunked GEMM is what is checked.
+// Run with mpirun on 2, 4, 6 or 8 GPUs of one node for the sums, e.g. mpirun -n 2 ./gemmAllReducePluginTest.
+
+namespace
+{
+
+SizeType32 constexpr kK = 256;
+SizeType32 constexpr kN = 128;
+
+std::vector<half> makeValues(int seed, std::size_t size)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> distr(-1.F, 1.F);
+    std::vector<half> values(size);
+    for (auto& value : values)
+    {
+        value = static_cast<half>(distr(generator));
+    }
+    return values;
+}
+
+//! The activations of a rank, every rank can generate those of all others for the reference.
+std::vector<half> makeAct(int rank, SizeType32 m)
+{
+    return makeValues(100 + rank, static_cast<std::size_t>(m) * kK);
+}
+
+std::vector<half> makeWeight(int rank)
+{
+    return makeValues(200 + rank, static_cast<std::size_t>(kN) * kK);
+}
+
+nvinfer1::PluginTensorDesc makeDesc(std::vector<int64_t> const& shape, nvinfer1::DataType type)
+{
+    nvinfer1::PluginTensorDesc desc{};
+    desc.dims.nbDims = static_cast<int32_t>(shape.size());
+    for (std::size_t i = 0; i < shape.size(); ++i)
+    {
+        desc.dims.d[i] = shape[i];
+    }
+    desc.type = type;
+    desc.format = nvinfer1::TensorFormat::kLINEAR;
+    desc.scale = 1.F;
+    return desc;
+}
+
+class GemmAllReducePluginTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        auto& session = COMM_SESSION;
+        mWorldSize = session.getSize();
+        mRank = session.getRank();
+        if (tc::getDeviceCount() < mWorldSize)
+        {
+            GTEST_SKIP() << "The test needs a GPU of the node per rank.";
+        }
+        mWorldConfig = std::make_unique<WorldConfig>(WorldConfig::mpi());
+        TLLM_CUDA_CHECK(cudaSetDevice(mWorldConfig->getDevice()));
+        mManager = std::make_unique<BufferManager>(std::make_shared<CudaStream>());
+
+        int32_t nbCreators{0};
+        auto* const* creators = getPluginCreators(nbCreators);
+        for (int32_t i = 0; i < nbCreators; ++i)
+        {
+            if (std::string(creators[i]->getPluginName()) == "GemmAllReduce")
+            {
+                mCreator = creators[i];
+            }
+        }
+        ASSERT_NE(mCreator, nullptr);
+    }
+
+    //! Runs the plugin of all ranks on [m, kK] x [kN, kK]^T and checks the output against the sum of the GEMMs of all
+    //! ranks. commPtrs is the workspace of the custom all-reduce strategies.
+    void runAndCheck(tk::AllReduceStrategyType strategy, int32_t numChunks, SizeType32 m, ITensor* commPtrs = nullptr)
+    {
+        std::vector<int32_t> group(mWorldSize);
+        for (int rank = 0; rank < mWorldSize; ++rank)
+        {
+            group[rank] = rank;
+        }
+        auto const typeId = static_cast<int32_t>(nvinfer1::DataType::kHALF);
+        auto const strategyId = static_cast<int8_t>(strategy);
+        int8_t const config = 0;
+        std::vector<nvinfer1::PluginField> fields{
+            {"group", group.data(), nvinfer1::PluginFieldType::kINT32, static_cast<int32_t>(group.size())},
+            {"type_id", &typeId, nvinfer1::PluginFieldType::kINT32, 1},
+            {"strategy", &strategyId, nvinfer1::PluginFieldType::kINT8, 1},
+            {"config", &config, nvinfer1::PluginFieldType::kINT8, 1},
+            {"num_chunks", &numChunks, nvinfer1::PluginFieldType::kINT32, 1},
+        };
+        nvinfer1::PluginFieldCollection const fc{static_cast<int32_t>(fields.size()), fields.data()};
+        auto* plugin = static_cast<nvinfer1::IPluginV2DynamicExt*>(mCreator->createPlugin("gemmAllReduce", &fc));
+        ASSERT_NE(plugin, nullptr);
+        ASSERT_EQ(plugin->initialize(), 0);
+
+        auto const actHost = makeAct(mRank, m);
+        auto const weightHost = makeWeight(mRank);
+        auto act = mManager->gpu(ITensor::makeShape({m, kK}), nvinfer1::DataType::kHALF);
+        auto weight = mManager->gpu(ITensor::makeShape({kN, kK}), nvinfer1::DataType::kHALF);
+        auto out = mManager->gpu(ITensor::makeShape({m, kN}), nvinfer1::DataType::kHALF);
+        mManager->copy(actHost.data(), *act, MemoryType::kCPU);
+        mManager->copy(weightHost.data(), *weight, MemoryType::kCPU);
+
+        std::vector<nvinfer1::PluginTensorDesc> inputDesc{
+            makeDesc({m, kK}, nvinfer1::DataType::kHALF), makeDesc({kN, kK}, nvinfer1::DataType::kHALF)};
+        std::vector<void const*> inputs{act->data(), weight->data()};
+        if (commPtrs != nullptr)
+        {
+            inputDesc.push_back(makeDesc({static_cast<int64_t>(commPtrs->getSize())}, nvinfer1::DataType::kINT64));
+            inputs.push_back(commPtrs->data());
+        }
+        auto const outputDesc = makeDesc({m, kN}, nvinfer1::DataType::kHALF);
+        void* outputs[] = {out->data()};
+        auto const workspaceSize
+            = plugin->getWorkspaceSize(inputDesc.data(), static_cast<int>(inputDesc.size()), &outputDesc, 1);
+        auto workspace = mManager->gpu(workspaceSize, nvinfer1::DataType::kUINT8);
+
+        EXPECT_EQ(plugin->enqueue(inputDesc.data(), &outputDesc, inputs.data(), outputs, workspace->data(),
+                      mManager->getStream().get()),
+            0);
+        std::vector<half> outHost(static_cast<std::size_t>(m) * kN);
+        mManager->copy(*out, outHost.data(), MemoryType::kCPU);
+        mManager->getStream().synchronize();
+        plugin->terminate();
+        plugin->destroy();
+
+        std::vector<float> expected(outHost.size(), 0.F);
+        for (int rank = 0; rank < mWorldSize; ++rank)
+        {
+            auto const rankAct = makeAct(rank, m);
+            auto const rankWeight = makeWeight(rank);
+            for (SizeType32 mi = 0; mi < m; ++mi)
+            {
+                for (SizeType32 ni = 0; ni < kN; ++ni)
+                {
+                    float dot = 0.F;
+                    for (SizeType32 ki = 0; ki < kK; ++ki)
+                    {
+                        dot += static_cast<float>(rankAct[mi * kK + ki]) * static_cast<float>(rankWeight[ni * kK + ki]);
+                    }
+                    // Every rank's GEMM output is rounded to half before the all-reduce.
+                    expected[mi * kN + ni] += static_cast<float>(static_cast<half>(dot));
+                }
+            }
+        }
+        for (std::size_t i = 0; i < outHost.size(); ++i)
+        {
+            EXPECT_NEAR(static_cast<float>(outHost[i]), expected[i], 1e-2F * std::abs(expected[i]) + 1e-2F * mWorldSize)
+                << "row " << i / kN << " column " << i % kN;
+        }
+    }
+
+    int mWorldSize{1};
+    int mRank{0};
+    std::unique_ptr<WorldConfig> mWorldConfig;
+    std::unique_ptr<BufferManager> mManager;
+    nvinfer1::IPluginCreator* mCreator{nullptr};
+};
+
+TEST_F(GemmAllReducePluginTest, NcclUnchunked)
+{
+    // Fewer rows than two chunks of kMinChunkRows run as a single GEMM.
+    runAndCheck(tk::AllReduceStrategyType::NCCL, 4, 100);
+}
+
+TEST_F(GemmAllReducePluginTest, NcclChunked)
+{
+    runAndCheck(tk::AllReduceStrategyType::NCCL, 4, 256);
+}
+
+TEST_F(GemmAllReducePluginTest, NcclUnevenChunks)
+{
+    // Three chunks of 67, 67 and 66 rows.
+    runAndCheck(tk::AllReduceStrategyType::NCCL, 4, 200);
+}
+
+TEST_F(GemmAllReducePluginTest, OneShotChunked)
+{
+    if (mWorldSize < 2)
+    {
+        GTEST_SKIP() << "Run with mpirun on 2, 4, 6 or 8 GPUs of one node.";
+    }
+    SizeType32 constexpr m = 256;
+    AllReduceBuffers buffers{m, 1, 1, kN, *mManager, *mWorldConfig};
+    if (bufferCast<int64_t>(*buffers.mAllReduceCommPtrs)[0] == 0)
+    {
+        GTEST_SKIP() << "The GPUs of the node have no peer access.";
+    }
+    runAndCheck(tk::AllReduceStrategyType::ONESHOT, 4, m, buffers.mAllReduceCommPtrs.get());
+}
+
+} // namespace
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/allReduceStrategyTable.h"
+
+#include <sstream>
+
+namespace tk = tensorrt_llm::kernels;
+
+namespace
+{
+
+using Table = tk::AllReduceStrategyTable;
+
+TEST(AllReduceStrategyTableTest, Buckets)
+{
+    EXPECT_EQ(Table::getBucket(1), 0);
+    EXPECT_EQ(Table::getBucket(1024), 10);
+    EXPECT_EQ(Table::getBucket(1025), 11);
+
+    // Messages of 513 to 1024 bytes share an entry.
+    EXPECT_TRUE(Table::makeKey(90, 8, 513) == Table::makeKey(90, 8, 1024));
+    EXPECT_FALSE(Table::makeKey(90, 8, 1024) == Table::makeKey(90, 8, 1025));
+    EXPECT_FALSE(Table::makeKey(90, 8, 1024) == Table::makeKey(90, 4, 1024));
+    EXPECT_FALSE(Table::makeKey(90, 8, 1024) == Table::makeKey(80, 8, 1024));
+}
+
+TEST(AllReduceStrategyTableTest, SetAndLookup)
+{
+    Table table;
+    auto const key = Table::makeKey(90, 8, 1 << 20);
+    EXPECT_FALSE(table.lookup(key).has_value());
+
+    table.set(key, {tk::AllReduceStrategyType::TWOSHOT, tk::AllReduceStrategyConfig::PUSH_MODE});
+    auto const choice = table.lookup(Table::makeKey(90, 8, 600 * 1000));
+    ASSERT_TRUE(choice.has_value());
+    EXPECT_EQ(choice->strategy, tk::AllReduceStrategyType::TWOSHOT);
+    EXPECT_EQ(choice->config, tk::AllReduceStrategyConfig::PUSH_MODE);
+    EXPECT_FALSE(table.lookup(Table::makeKey(90, 4, 1 << 20)).has_value());
+
+    table.set(key, {tk::AllReduceStrategyType::NVLS, tk::AllReduceStrategyConfig(0)});
+    EXPECT_EQ(table.lookup(key)->strategy, tk::AllReduceStrategyType::NVLS);
+    EXPECT_EQ(table.size(), 1);
+}
+
+TEST(AllReduceStrategyTableTest, SaveAndLoad)
+{
+    Table table;
+    table.set(Table::makeKey(90, 8, 4096), {tk::AllReduceStrategyType::ONESHOT, tk::AllReduceStrategyConfig(0)});
+    table.set(Table::makeKey(80, 2, 1 << 22), {tk::AllReduceStrategyType::NCCL, tk::AllReduceStrategyConfig(0)});
+    table.set(
+        Table::makeKey(90, 8, 1 << 16), {tk::AllReduceStrategyType::ONESHOT, tk::AllReduceStrategyConfig::USE_MEMCPY});
+
+    std::stringstream stream;
+    table.save(stream);
+    Table loaded;
+    ASSERT_TRUE(loaded.load(stream));
+    EXPECT_EQ(loaded.size(), 3);
+    EXPECT_EQ(loaded.lookup(Table::makeKey(90, 8, 4096))->strategy, tk::AllReduceStrategyType::ONESHOT);
+    EXPECT_EQ(loaded.lookup(Table::makeKey(80, 2, 1 << 22))->strategy, tk::AllReduceStrategyType::NCCL);
+    EXPECT_EQ(loaded.lookup(Table::makeKey(90, 8, 1 << 16))->config, tk::AllReduceStrategyConfig::USE_MEMCPY);
+}
+
+TEST(AllReduceStrategyTableTest, MalformedEntry)
+{
+    Table table;
+    std::stringstream stream("# comment\n90 8 10 1 0\n90 8 11 1\n");
+    EXPECT_FALSE(table.load(stream));
+    EXPECT_EQ(table.size(), 0);
+
+    // AUTO is not a measured strategy and 4 is not a config flag.
+    std::stringstream autoStrategy("90 8 10 3 0\n");
+    EXPECT_FALSE(table.load(autoStrategy));
+    std::stringstream unknownConfig("90 8 10 1 4\n");
+    EXPECT_FALSE(table.load(unknownConfig));
+}
+
+} // namespace
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/attentionStateMerge.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+SizeType32 constexpr kNumRows = 6;
+SizeType32 constexpr kHeadSize = 72;
+SizeType32 constexpr kNumKeys = 10;
+
+//! \brief Softmax attention of every row over keys [begin, end), given the scores and values of all keys.
+void attend(std::vector<float> const& scores, std::vector<float> const& values, SizeType32 begin, SizeType32 end,
+    float* out, float* lse)
+{
+    for (SizeType32 row = 0; row < kNumRows; ++row)
+    {
+        if (begin == end)
+        {
+            lse[row] = -std::numeric_limits<float>::infinity();
+            std::fill(out + row * kHeadSize, out + (row + 1) * kHeadSize, 0.f);
+            continue;
+        }
+        float maxScore = -std::numeric_limits<float>::infinity();
+        for (SizeType32 key = begin; key < end; ++key)
+        {
+            maxScore = std::max(maxScore, scores[row * kNumKeys + key]);
+        }
+        float sum = 0.f;
+        for (SizeType32 dim = 0; dim < kHeadSize; ++dim)
+        {
+            out[row * kHeadSize + dim] = 0.f;
+        }
+        for (SizeType32 key = begin; key < end; ++key)
+        {
+            auto const p = std::exp(scores[row * kNumKeys + key] - maxScore);
+            sum += p;
+            for (SizeType32 dim = 0; dim < kHeadSize; ++dim)
+            {
+                out[row * kHeadSize + dim] += p * values[key * kHeadSize + dim];
+            }
+        }
+        for (SizeType32 dim = 0; dim < kHeadSize; ++dim)
+        {
+            out[row * kHeadSize + dim] /= sum;
+        }
+        lse[row] = maxScore + std::log(sum);
+    }
+}
+
+class AttentionStateMergeTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    void testMerge(SizeType32 split)
+    {
+        std::mt19937 generator(7);
+        std::uniform_real_distribution<float> distr(-4.f, 4.f);
+        std::vector<float> scores(kNumRows * kNumKeys);
+        std::vector<float> values(kNumKeys * kHeadSize);
+        for (auto& score : scores)
+        {
+            score = distr(generator);
+        }
+        for (auto& value : values)
+        {
+            value = distr(generator);
+        }
+
+        auto const outShape = ITensor::makeShape({kNumRows, kHeadSize});
+        auto const lseShape = ITensor::makeShape({kNumRows});
+        auto out = BufferManager::pinned(outShape, nvinfer1::DataType::kFLOAT);
+        auto lse = BufferManager::pinned(lseShape, nvinfer1::DataType::kFLOAT);
+        auto partOut = BufferManager::pinned(outShape, nvinfer1::DataType::kFLOAT);
+        auto partLse = BufferManager::pinned(lseShape, nvinfer1::DataType::kFLOAT);
+        attend(scores, values, 0, split, bufferCast<float>(*out), bufferCast<float>(*lse));
+        attend(scores, values, split, kNumKeys, bufferCast<float>(*partOut), bufferCast<float>(*partLse));
+        std::vector<float> refOut(kNumRows * kHeadSize);
+        std::vector<float> refLse(kNumRows);
+        attend(scores, values, 0, kNumKeys, refOut.data(), refLse.data());
+
+        auto outDevice = mBufferManager->copyFrom(*out, MemoryType::kGPU);
+        auto lseDevice = mBufferManager->copyFrom(*lse, MemoryType::kGPU);
+        auto partOutDevice = mBufferManager->copyFrom(*partOut, MemoryType::kGPU);
+        auto partLseDevice = mBufferManager->copyFrom(*partLse, MemoryType::kGPU);
+        // Two heads of three tokens
+        tk::invokeMergeAttentionStates<float>(bufferCast<float>(*outDevice), bufferCast<float>(*lseDevice),
+            bufferCast<float>(*partOutDevice), bufferCast<float>(*partLseDevice), 3, 2, kHeadSize, mStream->get());
+        mBufferManager->copy(*outDevice, *out);
+        mBufferManager->copy(*lseDevice, *lse);
+        mStream->synchronize();
+
+        for (SizeType32 row = 0; row < kNumRows; ++row)
+        {
+            EXPECT_NEAR(bufferCast<float>(*lse)[row], refLse[row], 1e-4f) << "row " << row;
+            for (SizeType32 dim = 0; dim < kHeadSize; ++dim)
+            {
+                EXPECT_NEAR(bufferCast<float>(*out)[row * kHeadSize + dim], refOut[row * kHeadSize + dim], 1e-4f)
+                    << "row " << row << " dim " << dim;
+            }
+        }
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(AttentionStateMergeTest, MatchesAttentionOverAllKeys)
+{
+    testMerge(4);
+}
+
+TEST_F(AttentionStateMergeTest, EmptyRangesDoNotContribute)
+{
+    // A chunk masked out entirely on either side
+    testMerge(0);
+    testMerge(kNumKeys);
+}
+
+} // namespace
@@ -170,17 +170,80 @@ public:
         {
             maxStep = std::max(maxStep, static_cast<int32_t>(ids.size() - 1));
         }
-        initData(outputIds, nGramSizes);
+        for (bool const useTables : {false, true})
+        {
+            initData(outputIds, nGramSizes);
+
+            if (useTables)
+            {
+                auto const params = initNgramTables(batchSize);
+                invokeBanRepeatNgramIncremental(params, batchSize);
+            }
+            else
+            {
+                tk::invokeBanRepeatNgram(bufferCast<float>(*mLogits),
+                    reinterpret_cast<int32_t const**>(bufferCast<int64_t>(*mOutputIdsPtr)),
+                    reinterpret_cast<tk::FinishedState*>(bufferCast<tk::FinishedState::UnderlyingType>(*mFinished)),
+                    reinterpret_cast<int32_t const**>(bufferCast<int64_t>(*mParentIdsPtr)),
+                    bufferCast<int32_t>(*mBatchSlots), bufferCast<int32_t>(*mSequenceLengths), batchSize, mBeamWidth,
+                    mMaxSeqLen, bufferCast<int32_t>(*mNGramSizes), mVocabSizePadded, maxStep, mStream->get());
+            }
+
+            mStream->synchronize();
+
+            verifyBanRepeatNGramResults(nGramSizes, expectedLastId);
+        }
+    }
+
+    //! Allocates and clears the n-gram tables of the slots in the batch
+    tk::NgramTablesParams initNgramTables(SizeType32 batchSize)
+    {
+        auto const maxBatchSize = 2 * batchSize;
+        auto const tableSize = tk::getNgramTableSize(mMaxSeqLen);
+        mNgramTables = mBufferManager->gpu(ITensor::makeShape({maxBatchSize, tableSize}), nvinfer1::DataType::kINT64);
+        mNgramNumIndexed = mBufferManager->gpu(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+
+        tk::NgramTablesParams params;
+        params.tables = reinterpret_cast<unsigned long long*>(bufferCast<int64_t>(*mNgramTables));
+        params.numIndexed = bufferCast<int32_t>(*mNgramNumIndexed);
+        params.tableSize = tableSize;
+        tk::invokeResetNgramTables(params, bufferCast<int32_t>(*mBatchSlots), batchSize, mStream->get());
+        return params;
+    }
 
-        tk::invokeBanRepeatNgram(bufferCast<float>(*mLogits),
+    void invokeBanRepeatNgramIncremental(tk::NgramTablesParams const& params, SizeType32 batchSize)
+    {
+        tk::invokeBanRepeatNgramIncremental(params, bufferCast<float>(*mLogits),
             reinterpret_cast<int32_t const**>(bufferCast<int64_t>(*mOutputIdsPtr)),
             reinterpret_cast<tk::FinishedState*>(bufferCast<tk::FinishedState::UnderlyingType>(*mFinished)),
-            reinterpret_cast<int32_t const**>(bufferCast<int64_t>(*mParentIdsPtr)), bufferCast<int32_t>(*mBatchSlots),
-            bufferCast<int32_t>(*mSequenceLengths), batchSize, mBeamWidth, mMaxSeqLen,
-            bufferCast<int32_t>(*mNGramSizes), mVocabSizePadded, maxStep, mStream->get());
+            bufferCast<int32_t>(*mBatchSlots), bufferCast<int32_t>(*mSequenceLengths), batchSize,
+            bufferCast<int32_t>(*mNGramSizes), mVocabSizePadded, mStream->get());
+    }
 
+    //! Bans with the n-gram tables step by step, with stepLens[si] tokens in the sequences at step si. Only the last
+    //! step is verified, the earlier ones index the tokens incrementally
+    void runIncrementalBanRepeatNGramTest(std::vector<std::vector<SizeType32>> const& outputIds,
+        std::vector<SizeType32> const& nGramSizes, std::vector<SizeType32> const& stepLens,
+        std::vector<SizeType32> const& expectedLastId)
+    {
+        auto const batchSize = static_cast<SizeType32>(expectedLastId.size());
+        initData(outputIds, nGramSizes);
+        auto const params = initNgramTables(batchSize);
+
+        auto batchSlotsPtr = bufferCast<int32_t>(*mBatchSlots);
+        auto sequenceLengthsPtr = bufferCast<SizeType32>(*mSequenceLengths);
+        for (auto const stepLen : stepLens)
+        {
+            mStream->synchronize();
+            for (SizeType32 bi = 0; bi < batchSize; ++bi)
+            {
+                sequenceLengthsPtr[batchSlotsPtr[bi] * mBeamWidth] = stepLen;
+            }
+            invokeBanRepeatNgramIncremental(params, batchSize);
+        }
         mStream->synchronize();
 
+        // Earlier steps may ban other tokens, only the last token of the sequence is checked
         verifyBanRepeatNGramResults(nGramSizes, expectedLastId);
     }
 
@@ -199,6 +262,8 @@ protected:
     TensorPtr mParentIdsPtr;
     TensorPtr mNGramSizes;
     TensorPtr mBatchSlots;
+    TensorPtr mNgramTables;
+    TensorPtr mNgramNumIndexed;
 
     static constexpr SizeType32 mMaxSeqLen{16};
     static constexpr SizeType32 mVocabSizePadded{32};
@@ -232,4 +297,14 @@ TEST_F(BanRepeatNgramKernelsTest, noRepeatNGramsBS2BW1Test)
     }
 }
 
+TEST_F(BanRepeatNgramKernelsTest, noRepeatNGramsIncrementalBS1BW1Test)
+{
+    // The last tokens {3, 2} were followed by 4 before, the 3-gram {3, 2, 4} is indexed at the first step
+    this->runIncrementalBanRepeatNGramTest({{5, 3, 2, 4, 6, 3, 2, 4}}, {3}, {5, 7}, {-4});
+    // The 3-gram {7, 3, 6} is indexed at the second step, which accepts 4 tokens at once
+    this->runIncrementalBanRepeatNGramTest({{1, 7, 3, 6, 2, 7, 3, 6}}, {3}, {3, 7}, {-6});
+    // The sequence is rolled back, so the 3-gram {6, 3, 6} indexed at the first step must not ban 6
+    this->runIncrementalBanRepeatNGramTest({{1, 3, 6, 3, 6, 6}}, {3}, {5, 2, 4}, {6});
+}
+
 } // end of namespace
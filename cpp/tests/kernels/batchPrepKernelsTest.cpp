@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/batchPrepKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace tk = tensorrt_llm::kernels;
+namespace tc = tensorrt_llm::common;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+struct HostRequest
+{
+    std::vector<int32_t> prompt;
+    int32_t maxNewTokens{0};
+    int32_t pastLength{0};
+    int32_t numGenerated{0};
+};
+
+//! The inputs of a step as the host would prepare them.
+struct HostInputs
+{
+    std::vector<int32_t> inputIds;
+    std::vector<int32_t> positionIds;
+    std::vector<int32_t> contextLengths;
+    std::vector<int32_t> sequenceLengths;
+    std::vector<int32_t> inputOffsets{0};
+
+    void addRow(std::vector<int32_t> const& tokens, int32_t pastLength, int32_t promptLength)
+    {
+        for (std::size_t i = 0; i < tokens.size(); ++i)
+        {
+            inputIds.push_back(tokens[i]);
+            positionIds.push_back(pastLength + static_cast<int32_t>(i));
+        }
+        contextLengths.push_back(promptLength);
+        sequenceLengths.push_back(pastLength + static_cast<int32_t>(tokens.size()));
+        inputOffsets.push_back(static_cast<int32_t>(inputIds.size()));
+    }
+};
+
+class BatchPrepKernelsTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    //! Uploads values, with at least one element so that empty inputs have a buffer too.
+    IBuffer::SharedPtr toDevice(std::vector<int32_t> values)
+    {
+        values.resize(std::max<std::size_t>(values.size(), 1));
+        return mBufferManager->copyFrom(values, MemoryType::kGPU);
+    }
+
+    std::vector<int32_t> toHost(IBuffer const& buffer, std::size_t size)
+    {
+        auto host = mBufferManager->copyFrom(buffer, MemoryType::kCPU);
+        mStream->synchronize();
+        auto const* ptr = bufferCast<int32_t>(*host);
+        return {ptr, ptr + size};
+    }
+
+    //! Runs numSteps steps of continuous batching. Requests are added to free slots, freed slots may be reused in the
+    //! same step, run their prompt in chunks, generate with beamWidth beams and finish. The inputs built by
+    //! invokeBatchPrep and the lengths it keeps per slot are checked against the host at every step.
+    void runSteps(SizeType32 maxBatchSize, SizeType32 beamWidth, SizeType32 numSteps, SizeType32 maxNewPerStep,
+        SizeType32 maxChunkLength)
+    {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int32_t> tokenDistr(0, 32000);
+        std::uniform_int_distribution<int32_t> promptLengthDistr(1, 3 * maxChunkLength);
+        std::uniform_int_distribution<int32_t> chunkLengthDistr(1, maxChunkLength);
+        std::uniform_int_distribution<int32_t> maxNewTokensDistr(1, 4);
+
+        auto slotPastLengths = toDevice(std::vector<int32_t>(maxBatchSize, 0));
+        auto slotPromptLengths = toDevice(std::vector<int32_t>(maxBatchSize, 0));
+        std::vector<std::optional<HostRequest>> slots(maxBatchSize);
+
+        for (SizeType32 step = 0; step < numSteps; ++step)
+        {
+            std::vector<int32_t> finishedSlots;
+            std::vector<int32_t> newSlots;
+            std::vector<int32_t> newPromptLengths;
+            for (SizeType32 slot = 0; slot < maxBatchSize; ++slot)
+            {
+                if (slots[slot] && slots[slot]->numGenerated >= slots[slot]->maxNewTokens)
+                {
+                    finishedSlots.push_back(slot);
+                    slots[slot].reset();
+                }
+            }
+            for (SizeType32 slot = 0; slot < maxBatchSize; ++slot)
+            {
+                if (!slots[slot] && static_cast<SizeType32>(newSlots.size()) < maxNewPerStep)
+                {
+                    HostRequest request;
+                    request.prompt.resize(promptLengthDistr(generator));
+                    std::generate(request.prompt.begin(), request.prompt.end(), [&] { return tokenDistr(generator); });
+                    request.maxNewTokens = maxNewTokensDistr(generator);
+                    newSlots.push_back(slot);
+                    newPromptLengths.push_back(static_cast<int32_t>(request.prompt.size()));
+                    slots[slot] = std::move(request);
+                }
+            }
+
+            // Tokens the decoder produced at the previous step
+            std::vector<int32_t> newTokens(maxBatchSize * beamWidth);
+            std::generate(newTokens.begin(), newTokens.end(), [&] { return tokenDistr(generator); });
+
+            // Context requests first, then generation requests
+            std::vector<int32_t> batchSlots;
+            std::vector<int32_t> contextTokens;
+            std::vector<int32_t> contextChunkLengths;
+            std::vector<int32_t> genSlots;
+            HostInputs expected;
+            for (SizeType32 slot = 0; slot < maxBatchSize; ++slot)
+            {
+                auto& request = slots[slot];
+                if (!request)
+                {
+                    continue;
+                }
+                auto const promptLength = static_cast<int32_t>(request->prompt.size());
+                if (request->pastLength < promptLength)
+                {
+                    auto const chunkLength = std::min(chunkLengthDistr(generator), promptLength - request->pastLength);
+                    auto const begin = request->prompt.begin() + request->pastLength;
+                    std::vector<int32_t> const chunk(begin, begin + chunkLength);
+                    batchSlots.push_back(slot);
+                    contextTokens.insert(contextTokens.end(), chunk.begin(), chunk.end());
+                    contextChunkLengths.push_back(chunkLength);
+                    expected.addRow(chunk, request->pastLength, promptLength);
+                    request->pastLength += chunkLength;
+                }
+                else
+                {
+                    genSlots.push_back(slot);
+                }
+            }
+            auto const numContextRequests = static_cast<int32_t>(batchSlots.size());
+            for (auto const slot : genSlots)
+            {
+                auto& request = slots[slot];
+                for (SizeType32 beam = 0; beam < beamWidth; ++beam)
+                {
+                    expected.addRow({newTokens[slot * beamWidth + beam]}, request->pastLength,
+                        static_cast<int32_t>(request->prompt.size()));
+                }
+                batchSlots.push_back(slot);
+                request->pastLength += 1;
+                request->numGenerated += 1;
+            }
+
+            auto finishedSlotsDevice = toDevice(finishedSlots);
+            auto newSlotsDevice = toDevice(newSlots);
+            auto newPromptLengthsDevice = toDevice(newPromptLengths);
+            auto batchSlotsDevice = toDevice(batchSlots);
+            auto contextTokensDevice = toDevice(contextTokens);
+            auto contextChunkLengthsDevice = toDevice(contextChunkLengths);
+            auto newTokensDevice = toDevice(newTokens);
+            auto const numTokens = expected.inputIds.size();
+            auto const numRows = expected.contextLengths.size();
+            auto inputIds = toDevice(std::vector<int32_t>(numTokens, -1));
+            auto positionIds = toDevice(std::vector<int32_t>(numTokens, -1));
+            auto contextLengths = toDevice(std::vector<int32_t>(numRows, -1));
+            auto sequenceLengths = toDevice(std::vector<int32_t>(numRows, -1));
+            auto inputOffsets = toDevice(std::vector<int32_t>(numRows + 1, -1));
+
+            tk::BatchPrepParams params;
+            params.slotPastLengths = bufferCast<int32_t>(*slotPastLengths);
+            params.slotPromptLengths = bufferCast<int32_t>(*slotPromptLengths);
+            params.finishedSlots = bufferCast<int32_t>(*finishedSlotsDevice);
+            params.numFinishedSlots = static_cast<int32_t>(finishedSlots.size());
+            params.newSlots = bufferCast<int32_t>(*newSlotsDevice);
+            params.newPromptLengths = bufferCast<int32_t>(*newPromptLengthsDevice);
+            params.numNewSlots = static_cast<int32_t>(newSlots.size());
+            params.batchSlots = bufferCast<int32_t>(*batchSlotsDevice);
+            params.numContextRequests = numContextRequests;
+            params.numGenRequests = static_cast<int32_t>(genSlots.size());
+            params.beamWidth = beamWidth;
+            params.contextTokens = bufferCast<int32_t>(*contextTokensDevice);
+            params.contextChunkLengths = bufferCast<int32_t>(*contextChunkLengthsDevice);
+            params.newTokens = bufferCast<int32_t>(*newTokensDevice);
+            params.inputIds = bufferCast<int32_t>(*inputIds);
+            params.positionIds = bufferCast<int32_t>(*positionIds);
+            params.contextLengths = bufferCast<int32_t>(*contextLengths);
+            params.sequenceLengths = bufferCast<int32_t>(*sequenceLengths);
+            params.inputOffsets = bufferCast<int32_t>(*inputOffsets);
+            tk::invokeBatchPrep(params, mStream->get());
+
+            EXPECT_EQ(toHost(*inputIds, numTokens), expected.inputIds) << "step " << step;
+            EXPECT_EQ(toHost(*positionIds, numTokens), expected.positionIds) << "step " << step;
+            EXPECT_EQ(toHost(*contextLengths, numRows), expected.contextLengths) << "step " << step;
+            EXPECT_EQ(toHost(*sequenceLengths, numRows), expected.sequenceLengths) << "step " << step;
+            EXPECT_EQ(toHost(*inputOffsets, numRows + 1), expected.inputOffsets) << "step " << step;
+
+            std::vector<int32_t> expectedPastLengths(maxBatchSize, 0);
+            std::vector<int32_t> expectedPromptLengths(maxBatchSize, 0);
+            for (SizeType32 slot = 0; slot < maxBatchSize; ++slot)
+            {
+                if (slots[slot])
+                {
+                    expectedPastLengths[slot] = slots[slot]->pastLength;
+                    expectedPromptLengths[slot] = static_cast<int32_t>(slots[slot]->prompt.size());
+                }
+            }
+            // Freed slots that were not reused keep their lengths cleared
+            EXPECT_EQ(toHost(*slotPastLengths, maxBatchSize), expectedPastLengths) << "step " << step;
+            EXPECT_EQ(toHost(*slotPromptLengths, maxBatchSize), expectedPromptLengths) << "step " << step;
+        }
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(BatchPrepKernelsTest, MixedSteps)
+{
+    runSteps(8, 1, 20, 2, 16);
+}
+
+TEST_F(BatchPrepKernelsTest, MixedStepsWithBeams)
+{
+    runSteps(8, 3, 20, 3, 16);
+}
+
+TEST_F(BatchPrepKernelsTest, RowsBeyondOneScan)
+{
+    // More rows and context tokens than the threads of the block
+    runSteps(1024, 2, 6, 512, 8);
+}
+
+} // namespace
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/beamSearchKernels.h"
+#include "tensorrt_llm/kernels/decodingCommon.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace tk = tensorrt_llm::kernels;
+namespace tc = tensorrt_llm::common;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+SizeType32 constexpr kVocabSize{2048};
+SizeType32 constexpr kEndId{kVocabSize - 1};
+SizeType32 constexpr kInputLength{4};
+SizeType32 constexpr kMaxSeqLen{8};
+
+struct Candidate
+{
+    float cumLogProb;
+    SizeType32 beam;
+    SizeType32 token;
+};
+
+//! The beams of one request after a step of beam search, as picked by the groups of diverse beam search one after the
+//! other. The candidates of a group are penalized by groupDiversityPenalty for every time a previous group picked their
+//! token, a single group is plain beam search. logProbs are [maxBeamWidth, kVocabSize] and cumLogProbs [maxBeamWidth].
+std::vector<Candidate> referenceBeams(float const* logProbs, float const* cumLogProbs, SizeType32 beamWidth,
+    SizeType32 numGroups, float groupDiversityPenalty)
+{
+    std::vector<Candidate> beams;
+    std::vector<SizeType32> chosenTokens;
+    auto const groupWidth = beamWidth / numGroups;
+    for (SizeType32 group = 0; group < numGroups; ++group)
+    {
+        std::vector<std::pair<float, Candidate>> candidates;
+        for (SizeType32 beam = group * groupWidth; beam < (group + 1) * groupWidth; ++beam)
+        {
+            for (SizeType32 token = 0; token < kVocabSize; ++token)
+            {
+                auto const numPicked = std::count(chosenTokens.begin(), chosenTokens.end(), token);
+                auto const cumLogProb = logProbs[beam * kVocabSize + token] + cumLogProbs[beam];
+                auto const penalized = cumLogProb + (0.f - groupDiversityPenalty * numPicked);
+                candidates.push_back({penalized, {cumLogProb, beam, token}});
+            }
+        }
+        std::partial_sort(candidates.begin(), candidates.begin() + groupWidth, candidates.end(),
+            [](auto const& lhs, auto const& rhs) { return lhs.first > rhs.first; });
+        for (SizeType32 i = 0; i < groupWidth; ++i)
+        {
+            beams.push_back(candidates[i].second);
+            chosenTokens.push_back(candidates[i].second.token);
+        }
+    }
+    return beams;
+}
+
+class BeamSearchKernelsTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    template <typename T>
+    IBuffer::SharedPtr toDevice(std::vector<T> const& values)
+    {
+        return mBufferManager->copyFrom(values, MemoryType::kGPU);
+    }
+
+    template <typename T>
+    std::vector<T> toHost(IBuffer const& buffer)
+    {
+        auto host = mBufferManager->copyFrom(buffer, MemoryType::kCPU);
+        mStream->synchronize();
+        auto const* ptr = bufferCast<T>(*host);
+        return {ptr, ptr + host->getSize()};
+    }
+
+    //! Runs one step of beam search for requests in the slots of beamWidths, the batch holds them in reverse order,
+    //! and checks the beams of every request against referenceBeams. Requests may use fewer beams than maxBeamWidth,
+    //! their other beams must be left untouched.
+    void runStepAndCheck(SizeType32 maxBeamWidth, std::vector<SizeType32> const& beamWidths,
+        std::vector<SizeType32> const& numBeamGroups = {}, float groupDiversityPenalty = 0.f)
+    {
+        auto const batchSize = static_cast<SizeType32>(beamWidths.size());
+        auto const numBeams = batchSize * maxBeamWidth;
+        std::vector<SizeType32> batchSlots(batchSize);
+        for (SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            batchSlots[bi] = batchSize - 1 - bi;
+        }
+        auto const groups = numBeamGroups.empty() ? std::vector<SizeType32>(batchSize, 1) : numBeamGroups;
+
+        // Log probs [batchSize, maxBeamWidth, kVocabSize] share most of their value across the beams, so that the
+        // beams of a request compete for the same tokens. The end token is never picked.
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> tokenDistr(-10.f, -0.1f);
+        std::uniform_real_distribution<float> beamDistr(-0.5f, 0.f);
+        std::vector<float> tokenLogProbs(kVocabSize);
+        for (auto& logProb : tokenLogProbs)
+        {
+            logProb = tokenDistr(generator);
+        }
+        std::vector<float> logProbs(numBeams * kVocabSize);
+        for (SizeType32 i = 0; i < numBeams; ++i)
+        {
+            for (SizeType32 token = 0; token < kVocabSize; ++token)
+            {
+                logProbs[i * kVocabSize + token]
+                    = token == kEndId ? -1000.f : tokenLogProbs[token] + beamDistr(generator);
+            }
+        }
+        std::vector<float> cumLogProbs(numBeams);
+        for (auto& cumLogProb : cumLogProbs)
+        {
+            cumLogProb = beamDistr(generator);
+        }
+
+        auto logProbsDevice = toDevice(logProbs);
+        auto cumLogProbsDevice = toDevice(cumLogProbs);
+        auto batchSlotsDevice = toDevice(batchSlots);
+        auto beamWidthsDevice = toDevice(beamWidths);
+        auto numBeamGroupsDevice = toDevice(groups);
+        auto groupDiversityPenalties = toDevice(std::vector<float>(batchSize, groupDiversityPenalty));
+        auto diversityRates = toDevice(std::vector<float>(batchSize, 0.f));
+        auto lengthPenalties = toDevice(std::vector<float>(batchSize, 1.f));
+        auto earlyStoppings = toDevice(std::vector<SizeType32>(batchSize, 1));
+        auto inputLengths = toDevice(std::vector<SizeType32>(numBeams, kInputLength));
+        auto endIds = toDevice(std::vector<SizeType32>(batchSize, kEndId));
+        auto sequenceLengths = toDevice(std::vector<SizeType32>(numBeams, kInputLength));
+        auto outputIds = toDevice(std::vector<SizeType32>(numBeams * kMaxSeqLen, 0));
+        auto parentIds = toDevice(std::vector<SizeType32>(numBeams * kMaxSeqLen, 0));
+        std::vector<int64_t> outputIdsPtrs(batchSize);
+        std::vector<int64_t> parentIdsPtrs(batchSize);
+        for (SizeType32 slot = 0; slot < batchSize; ++slot)
+        {
+            auto const offset = slot * maxBeamWidth * kMaxSeqLen;
+            outputIdsPtrs[slot] = reinterpret_cast<int64_t>(bufferCast<SizeType32>(*outputIds) + offset);
+            parentIdsPtrs[slot] = reinterpret_cast<int64_t>(bufferCast<SizeType32>(*parentIds) + offset);
+        }
+        auto outputIdsPtrsDevice = toDevice(outputIdsPtrs);
+        auto parentIdsPtrsDevice = toDevice(parentIdsPtrs);
+        auto finished = toDevice(std::vector<tk::FinishedState::UnderlyingType>(numBeams, 0));
+        auto outputIdsCBA = toDevice(std::vector<SizeType32>(2 * numBeams * kMaxSeqLen, 0));
+        auto sequenceLengthsCBA = toDevice(std::vector<SizeType32>(2 * numBeams, 0));
+        auto cumLogProbsCBA = toDevice(std::vector<float>(2 * numBeams, 0.f));
+        auto normedScoresCBA = toDevice(std::vector<float>(2 * numBeams, 0.f));
+        auto numBeamsCBA = toDevice(std::vector<SizeType32>(batchSize, 0));
+        auto minNormedScoresCBA = toDevice(std::vector<float>(batchSize, 0.f));
+        auto batchDones = mBufferManager->gpu(batchSize, nvinfer1::DataType::kBOOL);
+        mBufferManager->setZero(*batchDones);
+
+        tk::BeamHypotheses bh;
+        bh.nMaxBatchSize = batchSize;
+        bh.nBatchSize = batchSize;
+        bh.nBeamWidth = maxBeamWidth;
+        bh.nMaxSeqLen = kMaxSeqLen;
+        bh.nVocabSize = kVocabSize;
+        bh.diversityRates = bufferCast<float>(*diversityRates);
+        bh.lengthPenalties = bufferCast<float>(*lengthPenalties);
+        bh.earlyStoppings = bufferCast<SizeType32>(*earlyStoppings);
+        bh.beamWidths = bufferCast<SizeType32>(*beamWidthsDevice);
+        bh.numBeamGroups = bufferCast<SizeType32>(*numBeamGroupsDevice);
+        bh.groupDiversityPenalties = bufferCast<float>(*groupDiversityPenalties);
+        bh.inputLengths = bufferCast<SizeType32>(*inputLengths);
+        bh.endIds = bufferCast<SizeType32>(*endIds);
+        bh.batchSlots = bufferCast<SizeType32>(*batchSlotsDevice);
+        bh.sequenceLengths = bufferCast<SizeType32>(*sequenceLengths);
+        bh.cumLogProbs = bufferCast<float>(*cumLogProbsDevice);
+        bh.outputIdsCBA = bufferCast<SizeType32>(*outputIdsCBA);
+        bh.sequenceLengthsCBA = bufferCast<SizeType32>(*sequenceLengthsCBA);
+        bh.cumLogProbsCBA = bufferCast<float>(*cumLogProbsCBA);
+        bh.normedScoresCBA = bufferCast<float>(*normedScoresCBA);
+        bh.numBeamsCBA = bufferCast<SizeType32>(*numBeamsCBA);
+        bh.minNormedScoresCBA = bufferCast<float>(*minNormedScoresCBA);
+        bh.batchDones = bufferCast<bool>(*batchDones);
+        bh.finished = reinterpret_cast<tk::FinishedState*>(bufferCast<tk::FinishedState::UnderlyingType>(*finished));
+        bh.outputIdsPtr = reinterpret_cast<SizeType32**>(bufferCast<int64_t>(*outputIdsPtrsDevice));
+        bh.parentIdsPtr = reinterpret_cast<SizeType32**>(bufferCast<int64_t>(*parentIdsPtrsDevice));
+
+        // Sized like BeamSearchLayer does
+        auto const padBeamWidth = tk::padToNextPowerOfTwo(maxBeamWidth);
+        auto const numTopK = batchSize * padBeamWidth * padBeamWidth * 2;
+        auto const numTemp = batchSize * padBeamWidth * tk::nMaxVocabPartForStage1FastKernel * (4 * padBeamWidth + 2);
+        auto const workspaceSize
+            = tc::roundUp(numTopK, 4) * (sizeof(int) + 2 * sizeof(float)) + tc::roundUp(numTemp, 4) * sizeof(float);
+        auto workspace = mBufferManager->gpu(workspaceSize, nvinfer1::DataType::kUINT8);
+
+        tk::invokeTopkSoftMax<float>(
+            bufferCast<float>(*logProbsDevice), nullptr, workspace->data(), bh, mStream->get());
+
+        auto const outCumLogProbs = toHost<float>(*cumLogProbsDevice);
+        auto const outSequenceLengths = toHost<SizeType32>(*sequenceLengths);
+        auto const outOutputIds = toHost<SizeType32>(*outputIds);
+        auto const outParentIds = toHost<SizeType32>(*parentIds);
+        auto const outNumBeamsCBA = toHost<SizeType32>(*numBeamsCBA);
+        for (SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            auto const slot = batchSlots[bi];
+            auto const beamWidth = beamWidths[slot];
+            auto const* requestLogProbs = logProbs.data() + bi * maxBeamWidth * kVocabSize;
+            auto const* requestCumLogProbs = cumLogProbs.data() + slot * maxBeamWidth;
+            auto const expected = referenceBeams(
+                requestLogProbs, requestCumLogProbs, beamWidth, groups[slot], groupDiversityPenalty);
+            auto const groupWidth = beamWidth / groups[slot];
+            EXPECT_EQ(outNumBeamsCBA[slot], 0) << "slot " << slot;
+            std::set<std::pair<SizeType32, SizeType32>> picked;
+            for (SizeType32 beam = 0; beam < maxBeamWidth; ++beam)
+            {
+                auto const index = slot * maxBeamWidth + beam;
+                auto const step = index * kMaxSeqLen + kInputLength;
+                if (beam < beamWidth)
+                {
+                    // Candidates of equal value may be picked in any order, so the beams are checked to hold the
+                    // expected values and to be candidates of those values rather than the reference candidates.
+                    auto const parent = outParentIds[step];
+                    auto const token = outOutputIds[step];
+                    EXPECT_EQ(outCumLogProbs[index], expected[beam].cumLogProb) << "slot " << slot << " beam " << beam;
+                    ASSERT_EQ(parent / groupWidth, beam / groupWidth) << "slot " << slot << " beam " << beam;
+                    ASSERT_TRUE(token >= 0 && token < kVocabSize) << "slot " << slot << " beam " << beam;
+                    EXPECT_EQ(requestLogProbs[parent * kVocabSize + token] + requestCumLogProbs[parent],
+                        outCumLogProbs[index])
+                        << "slot " << slot << " beam " << beam;
+                    EXPECT_TRUE(picked.emplace(parent, token).second) << "slot " << slot << " beam " << beam;
+                    EXPECT_EQ(outSequenceLengths[index], kInputLength + 1) << "slot " << slot << " beam " << beam;
+                }
+                else
+                {
+                    EXPECT_EQ(outCumLogProbs[index], cumLogProbs[index]) << "slot " << slot << " beam " << beam;
+                    EXPECT_EQ(outOutputIds[step], 0) << "slot " << slot << " beam " << beam;
+                    EXPECT_EQ(outSequenceLengths[index], kInputLength) << "slot " << slot << " beam " << beam;
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(BeamSearchKernelsTest, BeamWidth4)
+{
+    runStepAndCheck(4, {4, 4, 4});
+}
+
+TEST_F(BeamSearchKernelsTest, BeamWidth256)
+{
+    // The stage 3 candidates do not fit in shared memory and are kept in the workspace
+    runStepAndCheck(256, {256, 256});
+}
+
+TEST_F(BeamSearchKernelsTest, PerRequestBeamWidths)
+{
+    runStepAndCheck(256, {3, 256, 130});
+}
+
+TEST_F(BeamSearchKernelsTest, DiverseBeamSearch)
+{
+    // The groups would all pick the same tokens without the penalty, a single group is plain beam search
+    runStepAndCheck(8, {8, 8, 6}, {4, 1, 3}, 2.f);
+}
+
+TEST_F(BeamSearchKernelsTest, DiverseBeamSearchSmallPenalty)
+{
+    // The penalty only reorders close candidates
+    runStepAndCheck(64, {64, 32}, {8, 4}, 0.05f);
+}
+} // namespace
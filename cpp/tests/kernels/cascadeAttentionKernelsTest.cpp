@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/cascadeAttentionKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <cmath>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+// Block table with K block b and V block b + 1 for every block b of a sequence.
+std::vector<tk::KVCacheIndex> makeBlockOffsets(
+    std::vector<std::vector<SizeType32>> const& seqBlocks, SizeType32 maxBlocksPerSeq)
+{
+    std::vector<tk::KVCacheIndex> offsets(seqBlocks.size() * 2 * maxBlocksPerSeq, tk::KVCacheIndex{0});
+    for (std::size_t seq = 0; seq < seqBlocks.size(); ++seq)
+    {
+        for (std::size_t bi = 0; bi < seqBlocks[seq].size(); ++bi)
+        {
+            offsets[(seq * 2) * maxBlocksPerSeq + bi] = tk::KVCacheIndex{seqBlocks[seq][bi]};
+            offsets[(seq * 2 + 1) * maxBlocksPerSeq + bi] = tk::KVCacheIndex{seqBlocks[seq][bi] + 1};
+        }
+    }
+    return offsets;
+}
+
+TEST(CascadePrefixGroupsTest, GroupsSequencesSharingLeadingBlocks)
+{
+    SizeType32 constexpr maxBlocksPerSeq = 4;
+    SizeType32 constexpr tokensPerBlock = 16;
+    // Sequences 0, 1 and 3 share blocks 0 and 2, sequence 3 shares one more with sequence 0.
+    auto const offsets = makeBlockOffsets({{0, 2, 4, 6}, {0, 2, 8}, {10, 12}, {0, 2, 4, 14}}, maxBlocksPerSeq);
+    std::vector<SizeType32> const sequenceLengths{60, 40, 30, 55};
+
+    auto groups = tk::buildCascadePrefixGroups(
+        offsets.data(), sequenceLengths.data(), 4, maxBlocksPerSeq, tokensPerBlock, 1024, /*minPrefixBlocks=*/2);
+    ASSERT_EQ(groups.getNumGroups(), 1);
+    EXPECT_EQ(groups.groupOffsets, (std::vector<SizeType32>{0, 3}));
+    EXPECT_EQ(groups.seqIdx, (std::vector<SizeType32>{0, 1, 3}));
+    EXPECT_EQ(groups.prefixLengths, (std::vector<SizeType32>{2 * tokensPerBlock}));
+    EXPECT_EQ(groups.seqPrefixLengths, (std::vector<SizeType32>{32, 32, 0, 32}));
+    EXPECT_EQ(groups.maxGroupSize, 3);
+    EXPECT_EQ(groups.pack(), (std::vector<SizeType32>{0, 3, 0, 1, 3, 32, 32, 32, 0, 32}));
+
+    // Sequence 1 shares too few blocks for a larger minimum, sequences 0 and 3 still group.
+    groups = tk::buildCascadePrefixGroups(
+        offsets.data(), sequenceLengths.data(), 4, maxBlocksPerSeq, tokensPerBlock, 1024, /*minPrefixBlocks=*/3);
+    EXPECT_EQ(groups.getNumGroups(), 1);
+    EXPECT_EQ(groups.seqIdx, (std::vector<SizeType32>{0, 3}));
+    EXPECT_EQ(groups.prefixLengths, (std::vector<SizeType32>{3 * tokensPerBlock}));
+
+    // Sequences beyond the attention window are not grouped.
+    groups = tk::buildCascadePrefixGroups(
+        offsets.data(), sequenceLengths.data(), 4, maxBlocksPerSeq, tokensPerBlock, 58, /*minPrefixBlocks=*/2);
+    EXPECT_EQ(groups.seqIdx, (std::vector<SizeType32>{1, 3}));
+}
+
+class CascadeAttentionTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(CascadeAttentionTest, MatchesReference)
+{
+    SizeType32 constexpr numHeads = 4;
+    SizeType32 constexpr numKvHeads = 2;
+    SizeType32 constexpr headSize = 64;
+    SizeType32 constexpr tokensPerBlock = 16;
+    SizeType32 constexpr maxBlocksPerSeq = 6;
+    SizeType32 constexpr numPoolBlocks = 32;
+    SizeType32 constexpr blockSize = numKvHeads * tokensPerBlock * headSize;
+
+    // Sequences 0, 1 and 3 share a 3 block prefix, sequence 2 has its own blocks.
+    std::vector<std::vector<SizeType32>> const seqBlocks{
+        {0, 2, 4, 6, 8}, {0, 2, 4, 10}, {12, 14, 16}, {0, 2, 4, 18, 20, 22}};
+    std::vector<SizeType32> const sequenceLengths{70, 53, 40, 90};
+    auto const batchSize = static_cast<SizeType32>(seqBlocks.size());
+    auto const hostOffsets = makeBlockOffsets(seqBlocks, maxBlocksPerSeq);
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distr(-1.f, 1.f);
+    std::vector<float> pool(numPoolBlocks * blockSize);
+    std::vector<float> q(batchSize * numHeads * headSize);
+    for (auto& val : pool)
+    {
+        val = distr(generator);
+    }
+    for (auto& val : q)
+    {
+        val = distr(generator);
+    }
+
+    auto const groups = tk::buildCascadePrefixGroups(hostOffsets.data(), sequenceLengths.data(), batchSize,
+        maxBlocksPerSeq, tokensPerBlock, 1024, /*minPrefixBlocks=*/2);
+    ASSERT_EQ(groups.getNumGroups(), 1);
+    ASSERT_EQ(groups.prefixLengths[0], 3 * tokensPerBlock);
+
+    auto devicePool = mBufferManager->copyFrom(pool, ITensor::makeShape({numPoolBlocks * blockSize}), MemoryType::kGPU);
+    auto deviceQ = mBufferManager->copyFrom(q, ITensor::makeShape({batchSize * numHeads * headSize}), MemoryType::kGPU);
+    auto deviceOut
+        = mBufferManager->gpu(ITensor::makeShape({batchSize * numHeads * headSize}), nvinfer1::DataType::kFLOAT);
+    auto deviceOffsets = mBufferManager->gpu(
+        ITensor::makeShape({static_cast<SizeType32>(hostOffsets.size())}), nvinfer1::DataType::kINT32);
+    mBufferManager->copy(hostOffsets.data(), *deviceOffsets, MemoryType::kCPU);
+    auto deviceLengths = mBufferManager->copyFrom(sequenceLengths, ITensor::makeShape({batchSize}), MemoryType::kGPU);
+    auto const packedGroups = groups.pack();
+    auto deviceGroups = mBufferManager->copyFrom(
+        packedGroups, ITensor::makeShape({static_cast<SizeType32>(packedGroups.size())}), MemoryType::kGPU);
+
+    for (SizeType32 numSplits : {1, 3})
+    {
+        auto workspace = mBufferManager->gpu(
+            tk::getCascadeAttentionWorkspaceSize(batchSize, numHeads, headSize, numSplits), nvinfer1::DataType::kINT8);
+
+        tk::CascadeAttentionParams<float> params;
+        params.q = bufferCast<float>(*deviceQ);
+        params.out = bufferCast<float>(*deviceOut);
+        params.kvCache = tk::KVBlockArray(batchSize, maxBlocksPerSeq, tokensPerBlock,
+            numKvHeads * headSize * sizeof(float), 1024, 0, devicePool->data(), nullptr,
+            reinterpret_cast<tk::KVCacheIndex*>(deviceOffsets->data()));
+        params.sequenceLengths = bufferCast<SizeType32>(*deviceLengths);
+        params.setPrefixGroups(groups, bufferCast<SizeType32>(*deviceGroups));
+        params.workspace = workspace->data();
+        params.batchSize = batchSize;
+        params.numHeads = numHeads;
+        params.numKvHeads = numKvHeads;
+        params.headSize = headSize;
+        params.numSplits = numSplits;
+        params.qkScale = 1.f / std::sqrt(static_cast<float>(headSize));
+        tk::invokeCascadeAttention(params, mStream->get());
+
+        auto out = mBufferManager->copyFrom(*deviceOut, MemoryType::kCPU);
+        mStream->synchronize();
+        auto const* outData = bufferCast<float>(*out);
+
+        for (SizeType32 seq = 0; seq < batchSize; ++seq)
+        {
+            for (SizeType32 head = 0; head < numHeads; ++head)
+            {
+                auto const kvHead = head / (numHeads / numKvHeads);
+                auto const getRow = [&](SizeType32 token, bool isV)
+                {
+                    auto const block = seqBlocks[seq][token / tokensPerBlock] + (isV ? 1 : 0);
+                    return pool.data() + block * blockSize
+                        + (kvHead * tokensPerBlock + token % tokensPerBlock) * headSize;
+                };
+                auto const* qRow = q.data() + (seq * numHeads + head) * headSize;
+                std::vector<float> scores(sequenceLengths[seq]);
+                float maxScore = -INFINITY;
+                for (SizeType32 token = 0; token < sequenceLengths[seq]; ++token)
+                {
+                    float dot = 0.f;
+                    for (SizeType32 d = 0; d < headSize; ++d)
+                    {
+                        dot += qRow[d] * getRow(token, false)[d];
+                    }
+                    scores[token] = dot * params.qkScale;
+                    maxScore = std::max(maxScore, scores[token]);
+                }
+                std::vector<float> ref(headSize, 0.f);
+                float sum = 0.f;
+                for (SizeType32 token = 0; token < sequenceLengths[seq]; ++token)
+                {
+                    auto const p = std::exp(scores[token] - maxScore);
+                    sum += p;
+                    for (SizeType32 d = 0; d < headSize; ++d)
+                    {
+                        ref[d] += p * getRow(token, true)[d];
+                    }
+                }
+                for (SizeType32 d = 0; d < headSize; ++d)
+                {
+                    EXPECT_NEAR(outData[(seq * numHeads + head) * headSize + d], ref[d] / sum, 1e-4f)
+                        << "seq " << seq << " head " << head << " dim " << d << " splits " << numSplits;
+                }
+            }
+        }
+    }
+}
+
+} // namespace
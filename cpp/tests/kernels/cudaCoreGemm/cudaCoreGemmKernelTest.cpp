@@ -394,7 +394,7 @@ TEST(Kernel, Fp8Gemv)
     int const arch = tensorrt_llm::common::getSMVersion();
     bool pass;
     int warmup = 10, iter = 30;
-    std::vector<int> ms{1, 2, 3, 4};
+    std::vector<int> ms{1, 2, 3, 4, 16, 24, 32};
     std::vector<int> ns{2048, 4096};
     std::vector<int> ks{2048, 4096};
     tensorrt_llm::common::QuantMode quant_mode = tensorrt_llm::common::QuantMode::fromQuantAlgo("FP8");
@@ -423,7 +423,7 @@ TEST(Kernel, Fp16Gemv)
     int const arch = tensorrt_llm::common::getSMVersion();
     bool pass;
     int warmup = 10, iter = 30;
-    std::vector<int> ms{1, 2, 3, 4};
+    std::vector<int> ms{1, 2, 3, 4, 16, 24, 32};
     std::vector<int> ns{2048, 4096};
     std::vector<int> ks{2048, 4096};
     tensorrt_llm::common::QuantMode quant_mode = tensorrt_llm::common::QuantMode::fromQuantAlgo("FP8");
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/cumsumLastDim.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <random>
+#include <vector>
+
+namespace tk = tensorrt_llm::kernels;
+namespace tc = tensorrt_llm::common;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class CumsumLastDimTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    //! Scan the rows with or without the look-back workspace and compare with a host scan.
+    void checkInt(SizeType32 batchSize, SizeType32 inputLength, bool withWorkspace)
+    {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> valueDistr(-100, 100);
+        std::vector<int> inputHost(batchSize * inputLength);
+        for (auto& value : inputHost)
+        {
+            value = valueDistr(generator);
+        }
+        auto input = mBufferManager->copyFrom(inputHost, MemoryType::kGPU);
+        auto output = mBufferManager->gpu(inputHost.size(), nvinfer1::DataType::kINT32);
+
+        auto const workspaceSize = tk::invokeComputeCumsumLastDimWorkspaceSize<int>(inputLength);
+        auto workspace = mBufferManager->gpu(workspaceSize, nvinfer1::DataType::kUINT8);
+        tk::invokeCumsumLastDim<int>(batchSize, inputLength, input->data(), output->data(),
+            withWorkspace ? workspace->data() : nullptr, workspaceSize, mStream->get());
+
+        auto outputHost = mBufferManager->copyFrom(*output, MemoryType::kCPU);
+        auto const* outputPtr = bufferCast<int>(*outputHost);
+        for (SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            int sum = 0;
+            for (SizeType32 i = 0; i < inputLength; ++i)
+            {
+                sum += inputHost[bi * inputLength + i];
+                ASSERT_EQ(outputPtr[bi * inputLength + i], sum) << "Error at " << bi << ", " << i;
+            }
+        }
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(CumsumLastDimTest, BlockScan)
+{
+    checkInt(3, 1000, false);
+}
+
+TEST_F(CumsumLastDimTest, LookBackScan)
+{
+    // Several tiles per row, the last one partial
+    checkInt(2, 5 * 4096 + 123, true);
+}
+
+TEST_F(CumsumLastDimTest, LookBackScanManyLaunches)
+{
+    // More rows than one launch scans
+    checkInt(20, 2 * 4096 + 1, true);
+}
+
+TEST_F(CumsumLastDimTest, HalfAccumulatesInFloat)
+{
+    // A half running sum of quarters stops growing at 512, a float one does not
+    SizeType32 constexpr inputLength{3 * 4096};
+    std::vector<half> inputHost(inputLength, static_cast<half>(0.25f));
+    auto input = mBufferManager->copyFrom(inputHost, MemoryType::kGPU);
+    auto output = mBufferManager->gpu(inputHost.size(), nvinfer1::DataType::kHALF);
+    auto const workspaceSize = tk::invokeComputeCumsumLastDimWorkspaceSize<half>(inputLength);
+    auto workspace = mBufferManager->gpu(workspaceSize, nvinfer1::DataType::kUINT8);
+    tk::invokeCumsumLastDim<half>(
+        1, inputLength, input->data(), output->data(), workspace->data(), workspaceSize, mStream->get());
+
+    auto outputHost = mBufferManager->copyFrom(*output, MemoryType::kCPU);
+    auto const* outputPtr = bufferCast<half>(*outputHost);
+    for (SizeType32 i = 0; i < inputLength; ++i)
+    {
+        auto const expected = 0.25f * static_cast<float>(i + 1);
+        ASSERT_NEAR(static_cast<float>(outputPtr[i]), expected, expected * 1e-3f) << "Error at " << i;
+    }
+}
+
+} // namespace
@@ -286,6 +286,282 @@ TEST_F(TestBeamHypothesesCopy, SingleBatchTest)
     checkAllEqual();
 }
 
+class TestBeamPaths : public ::testing::Test
+{
+public:
+    static SizeType32 constexpr kBatchSize{3};
+    static SizeType32 constexpr kBeamWidth{4};
+    static SizeType32 constexpr kMaxSeqLen{24};
+    static SizeType32 constexpr kInputLength{5};
+    static SizeType32 constexpr kNumBeams{kBatchSize * kBeamWidth};
+
+    std::shared_ptr<tensorrt_llm::runtime::CudaStream> mStream;
+    std::shared_ptr<tensorrt_llm::runtime::BufferManager> mBufferManager;
+
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mStream = std::make_shared<tensorrt_llm::runtime::CudaStream>();
+        mBufferManager = std::make_shared<tensorrt_llm::runtime::BufferManager>(mStream);
+    }
+
+    template <typename T>
+    std::vector<T> toHost(IBuffer const& buffer)
+    {
+        auto host = mBufferManager->copyFrom(buffer, MemoryType::kCPU);
+        mStream->synchronize();
+        auto const* ptr = bufferCast<T>(*host);
+        return {ptr, ptr + host->getSize()};
+    }
+};
+
+// Test for invokeUpdateBeamPaths and invokeInsertUnfinishedPath with paths
+TEST_F(TestBeamPaths, IncrementalPathsMatchBacktracking)
+{
+    std::mt19937 gen(42U);
+    std::uniform_int_distribution<SizeType32> beamDistr(0, kBeamWidth - 1);
+    std::uniform_int_distribution<SizeType32> tokenDistr(0, 1000);
+
+    // Output and parent ids [kBatchSize, kBeamWidth, kMaxSeqLen], the beams share the prompt
+    std::vector<SizeType32> outputIds(kNumBeams * kMaxSeqLen, 0);
+    std::vector<SizeType32> parentIds(kNumBeams * kMaxSeqLen, 0);
+    for (SizeType32 bi = 0; bi < kBatchSize; ++bi)
+    {
+        for (SizeType32 j = 0; j < kInputLength; ++j)
+        {
+            auto const token = tokenDistr(gen);
+            for (SizeType32 beam = 0; beam < kBeamWidth; ++beam)
+            {
+                outputIds[(bi * kBeamWidth + beam) * kMaxSeqLen + j] = token;
+                parentIds[(bi * kBeamWidth + beam) * kMaxSeqLen + j] = beam;
+            }
+        }
+    }
+    std::vector<float> logProbsTiled(kMaxSeqLen * kNumBeams);
+    std::uniform_real_distribution<float> logProbDistr(-5.f, 0.f);
+    for (auto& logProb : logProbsTiled)
+    {
+        logProb = logProbDistr(gen);
+    }
+    std::vector<float> cumLogProbs(kNumBeams);
+    for (auto& cumLogProb : cumLogProbs)
+    {
+        cumLogProb = logProbDistr(gen);
+    }
+
+    auto outputIdsDevice = mBufferManager->copyFrom(outputIds, MemoryType::kGPU);
+    auto parentIdsDevice = mBufferManager->copyFrom(parentIds, MemoryType::kGPU);
+    auto logProbsTiledDevice = mBufferManager->copyFrom(logProbsTiled, MemoryType::kGPU);
+    auto cumLogProbsDevice = mBufferManager->copyFrom(cumLogProbs, MemoryType::kGPU);
+    auto inputLengths = mBufferManager->copyFrom(std::vector<SizeType32>(kNumBeams, kInputLength), MemoryType::kGPU);
+    auto sequenceLengths = mBufferManager->gpu(kNumBeams, nvinfer1::DataType::kINT32);
+    auto lengthPenalties = mBufferManager->copyFrom(std::vector<float>(kBatchSize, 1.f), MemoryType::kGPU);
+    auto pathIds = mBufferManager->gpu(kNumBeams * kMaxSeqLen, nvinfer1::DataType::kINT32);
+    auto pathBeams = mBufferManager->gpu(kNumBeams * kMaxSeqLen, nvinfer1::DataType::kINT32);
+    auto pathLengths = mBufferManager->gpu(kNumBeams, nvinfer1::DataType::kINT32);
+    mBufferManager->setZero(*pathLengths);
+
+    tk::BeamHypotheses bh;
+    bh.nMaxBatchSize = kBatchSize;
+    bh.nBatchSize = kBatchSize;
+    bh.nBeamWidth = kBeamWidth;
+    bh.nMaxSeqLen = kMaxSeqLen;
+    bh.lengthPenalties = bufferCast<float>(*lengthPenalties);
+    bh.inputLengths = bufferCast<SizeType32>(*inputLengths);
+    bh.sequenceLengths = bufferCast<SizeType32>(*sequenceLengths);
+    bh.cumLogProbs = bufferCast<float>(*cumLogProbsDevice);
+    bh.logProbsTiled = bufferCast<float>(*logProbsTiledDevice);
+    bh.outputIdsUnfinish = bufferCast<SizeType32>(*outputIdsDevice);
+    bh.parentIdsUnfinish = bufferCast<SizeType32>(*parentIdsDevice);
+    bh.pathIds = bufferCast<SizeType32>(*pathIds);
+    bh.pathBeams = bufferCast<SizeType32>(*pathBeams);
+    bh.pathLengths = bufferCast<SizeType32>(*pathLengths);
+
+    // Steps of beam search only write their own column of the ids, the beams branch off random parents
+    for (SizeType32 step = kInputLength; step < kMaxSeqLen; ++step)
+    {
+        for (SizeType32 i = 0; i < kNumBeams; ++i)
+        {
+            outputIds[i * kMaxSeqLen + step] = tokenDistr(gen);
+            parentIds[i * kMaxSeqLen + step] = beamDistr(gen);
+        }
+        mBufferManager->copy(outputIds.data(), *outputIdsDevice, MemoryType::kCPU);
+        mBufferManager->copy(parentIds.data(), *parentIdsDevice, MemoryType::kCPU);
+        std::vector<SizeType32> const stepLengths(kNumBeams, step + 1);
+        mBufferManager->copy(stepLengths.data(), *sequenceLengths, MemoryType::kCPU);
+        // Not every step is followed by an update
+        if (step % 3 != 0 && step != kMaxSeqLen - 1)
+        {
+            continue;
+        }
+        tk::invokeUpdateBeamPaths(bh, mStream->get());
+
+        auto const outPathIds = toHost<SizeType32>(*pathIds);
+        auto const outPathBeams = toHost<SizeType32>(*pathBeams);
+        auto const outPathLengths = toHost<SizeType32>(*pathLengths);
+        for (SizeType32 bi = 0; bi < kBatchSize; ++bi)
+        {
+            for (SizeType32 beam = 0; beam < kBeamWidth; ++beam)
+            {
+                auto const indexBatchBeam = bi * kBeamWidth + beam;
+                EXPECT_EQ(outPathLengths[indexBatchBeam], step + 1);
+                auto prevId = beam;
+                for (SizeType32 j = step; j >= 0; --j)
+                {
+                    auto const index = (bi * kBeamWidth + prevId) * kMaxSeqLen + j;
+                    ASSERT_EQ(outPathIds[indexBatchBeam * kMaxSeqLen + j], outputIds[index])
+                        << "step " << step << " batch " << bi << " beam " << beam << " position " << j;
+                    ASSERT_EQ(outPathBeams[indexBatchBeam * kMaxSeqLen + j], prevId)
+                        << "step " << step << " batch " << bi << " beam " << beam << " position " << j;
+                    prevId = parentIds[index];
+                }
+            }
+        }
+    }
+
+    // Inserting the unfinished beams from the paths matches backtracking them
+    auto const insertUnfinished = [&](bool withPaths)
+    {
+        DecodingOutput::BeamHypotheses beams;
+        beams.empty(*mBufferManager);
+        beams.reshape(kBatchSize, kBeamWidth, kMaxSeqLen);
+        beams.init(*mBufferManager, 0);
+        tk::BeamHypotheses insertBh = bh;
+        insertBh.outputIdsCBA = bufferCast<SizeType32>(*beams.outputIdsCBA);
+        insertBh.logProbsCBA = bufferCast<float>(*beams.logProbsCBA);
+        insertBh.sequenceLengthsCBA = bufferCast<SizeType32>(*beams.sequenceLengthsCBA);
+        insertBh.cumLogProbsCBA = bufferCast<float>(*beams.cumLogProbsCBA);
+        insertBh.normedScoresCBA = bufferCast<float>(*beams.normedScoresCBA);
+        insertBh.numBeamsCBA = bufferCast<SizeType32>(*beams.numBeamsCBA);
+        insertBh.batchDones = bufferCast<bool>(*beams.batchDones);
+        if (!withPaths)
+        {
+            insertBh.pathIds = nullptr;
+            insertBh.pathBeams = nullptr;
+            insertBh.pathLengths = nullptr;
+        }
+        tk::invokeInsertUnfinishedPath(insertBh, mStream->get());
+        return beams;
+    };
+    auto const fromPaths = insertUnfinished(true);
+    auto const backtracked = insertUnfinished(false);
+    checkEquality<SizeType32>(fromPaths.outputIdsCBA, backtracked.outputIdsCBA, "outputIdsCBA", *mBufferManager);
+    checkEquality<float>(fromPaths.logProbsCBA, backtracked.logProbsCBA, "logProbsCBA", *mBufferManager);
+    checkEquality<SizeType32>(
+        fromPaths.sequenceLengthsCBA, backtracked.sequenceLengthsCBA, "sequenceLengthsCBA", *mBufferManager);
+    checkEquality<float>(fromPaths.cumLogProbsCBA, backtracked.cumLogProbsCBA, "cumLogProbsCBA", *mBufferManager);
+    checkEquality<float>(fromPaths.normedScoresCBA, backtracked.normedScoresCBA, "normedScoresCBA", *mBufferManager);
+    checkEquality<SizeType32>(fromPaths.numBeamsCBA, backtracked.numBeamsCBA, "numBeamsCBA", *mBufferManager);
+}
+
+class TestFillBatchPtrs : public ::testing::Test
+{
+public:
+    static SizeType32 constexpr kMaxBatchSize{8};
+    static std::size_t constexpr kStrideBytes{3 * 24 * sizeof(TokenIdType)};
+
+    std::shared_ptr<tensorrt_llm::runtime::CudaStream> mStream;
+    std::shared_ptr<tensorrt_llm::runtime::BufferManager> mBufferManager;
+    IBuffer::SharedPtr mBase;
+    IBuffer::SharedPtr mPtrs;
+
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mStream = std::make_shared<tensorrt_llm::runtime::CudaStream>();
+        mBufferManager = std::make_shared<tensorrt_llm::runtime::BufferManager>(mStream);
+        mBase = mBufferManager->gpu(kMaxBatchSize * kStrideBytes, nvinfer1::DataType::kUINT8);
+        mPtrs = mBufferManager->gpu(kMaxBatchSize, nvinfer1::DataType::kINT64);
+    }
+
+    void** ptrs()
+    {
+        return reinterpret_cast<void**>(bufferCast<int64_t>(*mPtrs));
+    }
+
+    //! Checks ptrs[dstSlots[bi]] == base + srcSlots[bi] * kStrideBytes, with bi for empty slots, and that the other
+    //! entries of the table are untouched.
+    void checkPtrs(std::vector<SizeType32> const& dstSlots, std::vector<SizeType32> const& srcSlots,
+        SizeType32 batchSize)
+    {
+        auto host = mBufferManager->copyFrom(*mPtrs, MemoryType::kCPU);
+        mStream->synchronize();
+        auto const* hostPtrs = bufferCast<int64_t>(*host);
+        auto const base = reinterpret_cast<int64_t>(mBase->data());
+        std::vector<int64_t> expected(kMaxBatchSize, 0);
+        for (SizeType32 bi = 0; bi < batchSize; ++bi)
+        {
+            auto const dst = dstSlots.empty() ? bi : dstSlots[bi];
+            auto const src = srcSlots.empty() ? bi : srcSlots[bi];
+            expected[dst] = base + static_cast<int64_t>(src * kStrideBytes);
+        }
+        for (SizeType32 slot = 0; slot < kMaxBatchSize; ++slot)
+        {
+            EXPECT_EQ(hostPtrs[slot], expected[slot]) << "slot " << slot;
+        }
+    }
+};
+
+// Test for invokeFillBatchPtrs, which replaces the pointer tables written on the host
+TEST_F(TestFillBatchPtrs, SlotMappings)
+{
+    std::vector<SizeType32> const slots{6, 1, 3, 0, 5};
+    auto const batchSize = static_cast<SizeType32>(slots.size());
+    auto slotsDevice = mBufferManager->copyFrom(slots, MemoryType::kGPU);
+    auto const* slotsPtr = bufferCast<SizeType32>(*slotsDevice);
+
+    // Output ids of the slots
+    mBufferManager->setZero(*mPtrs);
+    tk::invokeFillBatchPtrs(ptrs(), mBase->data(), kStrideBytes, slotsPtr, slotsPtr, batchSize, mStream->get());
+    checkPtrs(slots, slots, batchSize);
+
+    // Zero parent ids, indexed by the position in the batch
+    mBufferManager->setZero(*mPtrs);
+    tk::invokeFillBatchPtrs(ptrs(), mBase->data(), kStrideBytes, slotsPtr, nullptr, batchSize, mStream->get());
+    checkPtrs(slots, {}, batchSize);
+
+    mBufferManager->setZero(*mPtrs);
+    tk::invokeFillBatchPtrs(ptrs(), mBase->data(), kStrideBytes, nullptr, nullptr, batchSize, mStream->get());
+    checkPtrs({}, {}, batchSize);
+}
+
+// The table follows the batch slots on the device when the fill is replayed from a CUDA graph
+TEST_F(TestFillBatchPtrs, GraphReplayFollowsBatchSlots)
+{
+    SizeType32 constexpr batchSize{4};
+    std::vector<SizeType32> const firstSlots{2, 7, 0, 4};
+    std::vector<SizeType32> const secondSlots{5, 1, 6, 3};
+    auto slotsDevice = mBufferManager->copyFrom(firstSlots, MemoryType::kGPU);
+    auto const* slotsPtr = bufferCast<SizeType32>(*slotsDevice);
+    mStream->synchronize();
+
+    cudaGraph_t graph;
+    cudaGraphExec_t instance;
+    TLLM_CUDA_CHECK(cudaStreamBeginCapture(mStream->get(), cudaStreamCaptureModeThreadLocal));
+    tk::invokeFillBatchPtrs(ptrs(), mBase->data(), kStrideBytes, slotsPtr, slotsPtr, batchSize, mStream->get());
+    TLLM_CUDA_CHECK(cudaStreamEndCapture(mStream->get(), &graph));
+    TLLM_CUDA_CHECK(cudaGraphInstantiate(&instance, graph, nullptr, nullptr, 0));
+
+    mBufferManager->setZero(*mPtrs);
+    TLLM_CUDA_CHECK(cudaGraphLaunch(instance, mStream->get()));
+    checkPtrs(firstSlots, firstSlots, batchSize);
+
+    // Only the device batch slots change between the replays
+    mBufferManager->copy(secondSlots.data(), *slotsDevice, MemoryType::kCPU);
+    mBufferManager->setZero(*mPtrs);
+    TLLM_CUDA_CHECK(cudaGraphLaunch(instance, mStream->get()));
+    checkPtrs(secondSlots, secondSlots, batchSize);
+
+    TLLM_CUDA_CHECK(cudaGraphExecDestroy(instance));
+    TLLM_CUDA_CHECK(cudaGraphDestroy(graph));
+}
+
 enum AcceptKernelMode
 {
     BY_IDS,
@@ -393,8 +669,8 @@ public:
         auto batchSlotsRange = BufferRange<SizeType32>(*mBatchSlots);
         std::iota(batchSlotsRange.begin(), batchSlotsRange.end(), 0);
 
-        mCurandStates = mBufferManager->gpu(
-            ITensor::makeShape({mMaxBatchSize, sizeof(curandState_t)}), nvinfer1::DataType::kINT8);
+        mRandomStates = mBufferManager->gpu(
+            ITensor::makeShape({mMaxBatchSize, sizeof(tk::RandomState)}), nvinfer1::DataType::kINT8);
 
         mAcceptedLen.resize(mMaxBatchSize);
         mOutputLen.resize(mMaxBatchSize);
@@ -453,8 +729,8 @@ public:
 
         auto batchSlotsPtr = bufferCast<SizeType32>(*mBatchSlots);
 
-        tk::invokeCurandInitialize(reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*mCurandStates)), batchSlotsPtr,
-            mMaxBatchSize, seed, this->mStream->get());
+        tk::invokeRandomStateInitialize(reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*mRandomStates)),
+            batchSlotsPtr, mMaxBatchSize, seed, this->mStream->get());
 
         auto generateAvoidingValues = [&vocabDistr, &generator](std::uniform_int_distribution<SizeType32>& distr,
                                           std::unordered_set<SizeType32> const& tokensToAvoid, SizeType32 maxTries = -1,
@@ -887,9 +1163,9 @@ public:
             reinterpret_cast<T**>(bufferCast<int64_t>(*mTargetLogitsPtrs)), bufferCast<T>(*mDraftProbs),
             bufferCast<T>(*mTargetProbs), bufferCast<SizeType32>(*mNumsDraftTokens),
             reinterpret_cast<tk::FinishedState*>(bufferCast<tk::FinishedState::UnderlyingType>(*mFinishedSteps)),
-            reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*mCurandStates)), bufferCast<SizeType32>(*mBatchSlots),
-            mBatchSize, mMaxBatchSize, mBeamWidth, mVocabSize, mVocabSize, mMaxDraftTokens, false, 0.9f,
-            mStream->get());
+            reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*mRandomStates)),
+            bufferCast<SizeType32>(*mBatchSlots), mBatchSize, mMaxBatchSize, mBeamWidth, mVocabSize, mVocabSize,
+            mMaxDraftTokens, false, 0.9f, mStream->get());
     }
 
     void callAcceptByIdsWithPaths()
@@ -903,7 +1179,7 @@ public:
             reinterpret_cast<T const**>(bufferCast<int64_t>(*mMedusaLogitsPtrs)),
             bufferCast<SizeType32>(*mTokensPerStep), bufferCast<SizeType32>(*mTokensPerStep),
             bufferCast<SizeType32>(*mBestPaths), mBatchSize, mMaxBatchSize, mVocabSize, mMaxSeqLen, mMaxNumHeads,
-            mMaxDraftSeqPerStep, mStream->get());
+            mMaxDraftSeqPerStep, tksp::MedusaAcceptanceParams<T>{}, mStream->get());
     }
 
     void callTestedKernel()
@@ -1132,7 +1408,7 @@ protected:
     TensorPtr mTokensPerStep;
     TensorPtr mBestPaths;
 
-    TensorPtr mCurandStates;
+    TensorPtr mRandomStates;
 
     std::vector<SizeType32> mAcceptedLen;
     std::vector<SizeType32> mOutputLen;
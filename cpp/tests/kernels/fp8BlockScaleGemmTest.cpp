@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/fp8BlockScaleGemm.h"
+#include "tensorrt_llm/kernels/quantization.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <cmath>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class Fp8BlockScaleGemmTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(Fp8BlockScaleGemmTest, MatchesDequantizedReference)
+{
+    // Neither m nor n is a multiple of the tile size.
+    SizeType32 constexpr m = 70;
+    SizeType32 constexpr n = 200;
+    SizeType32 constexpr k = 384;
+    SizeType32 constexpr groupSize = tk::kFp8BlockScaleGroupSize;
+    SizeType32 constexpr numGroups = k / groupSize;
+    SizeType32 constexpr numWeightBlocks = (n + groupSize - 1) / groupSize;
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distr(-1.f, 1.f);
+
+    // Activations with an outlier group per token, which per-token scaling would flatten.
+    auto aHost = BufferManager::pinned(ITensor::makeShape({m, k}), nvinfer1::DataType::kHALF);
+    auto* aData = bufferCast<half>(*aHost);
+    for (SizeType32 i = 0; i < m * k; ++i)
+    {
+        auto const outlier = (i % k) / groupSize == (i / k) % numGroups ? 50.f : 1.f;
+        aData[i] = static_cast<half>(distr(generator) * outlier);
+    }
+
+    // Weights quantized on the host, with a different range per 128x128 block.
+    auto bHost = BufferManager::pinned(ITensor::makeShape({n, k}), nvinfer1::DataType::kFP8);
+    auto bScalesHost
+        = BufferManager::pinned(ITensor::makeShape({numWeightBlocks, numGroups}), nvinfer1::DataType::kFLOAT);
+    auto* bData = bufferCast<__nv_fp8_e4m3>(*bHost);
+    auto* bScales = bufferCast<float>(*bScalesHost);
+    for (SizeType32 bi = 0; bi < numWeightBlocks * numGroups; ++bi)
+    {
+        bScales[bi] = 0.01f * static_cast<float>(bi + 1);
+    }
+    for (SizeType32 i = 0; i < n * k; ++i)
+    {
+        bData[i] = static_cast<__nv_fp8_e4m3>(distr(generator) * 448.f);
+    }
+
+    auto a = mBufferManager->copyFrom(*aHost, MemoryType::kGPU);
+    auto b = mBufferManager->copyFrom(*bHost, MemoryType::kGPU);
+    auto bScalesDevice = mBufferManager->copyFrom(*bScalesHost, MemoryType::kGPU);
+    auto aQuant = mBufferManager->gpu(ITensor::makeShape({m, k}), nvinfer1::DataType::kFP8);
+    auto aScales = mBufferManager->gpu(ITensor::makeShape({m, numGroups}), nvinfer1::DataType::kFLOAT);
+    auto d = mBufferManager->gpu(ITensor::makeShape({m, n}), nvinfer1::DataType::kFLOAT);
+
+    tk::invokePerTokenGroupQuantization(bufferCast<__nv_fp8_e4m3>(*aQuant), bufferCast<half>(*a), m, k, groupSize,
+        bufferCast<float>(*aScales), mStream->get());
+    tk::invokeFp8BlockScaleGemm(bufferCast<float>(*d), bufferCast<__nv_fp8_e4m3>(*aQuant),
+        bufferCast<float>(*aScales), bufferCast<__nv_fp8_e4m3>(*b), bufferCast<float>(*bScalesDevice), m, n, k,
+        mStream->get());
+
+    auto aQuantHost = mBufferManager->copyFrom(*aQuant, MemoryType::kCPU);
+    auto aScalesHost = mBufferManager->copyFrom(*aScales, MemoryType::kCPU);
+    auto dHost = mBufferManager->copyFrom(*d, MemoryType::kCPU);
+    mStream->synchronize();
+    auto const* aQuantData = bufferCast<__nv_fp8_e4m3>(*aQuantHost);
+    auto const* aScalesData = bufferCast<float>(*aScalesHost);
+    auto const* dData = bufferCast<float>(*dHost);
+
+    for (SizeType32 row = 0; row < m; ++row)
+    {
+        for (SizeType32 g = 0; g < numGroups; ++g)
+        {
+            // The group scales keep every value within the fp8 quantization error of its group.
+            auto const scale = aScalesData[row * numGroups + g];
+            for (SizeType32 c = g * groupSize; c < (g + 1) * groupSize; ++c)
+            {
+                auto const dequantized = static_cast<float>(aQuantData[row * k + c]) * scale;
+                EXPECT_NEAR(dequantized, static_cast<float>(aData[row * k + c]), 448.f * scale / 16.f);
+            }
+        }
+        for (SizeType32 col = 0; col < n; ++col)
+        {
+            double ref = 0.;
+            for (SizeType32 c = 0; c < k; ++c)
+            {
+                auto const g = c / groupSize;
+                ref += static_cast<double>(aQuantData[row * k + c]) * aScalesData[row * numGroups + g]
+                    * static_cast<float>(bData[col * k + c]) * bScales[(col / groupSize) * numGroups + g];
+            }
+            EXPECT_NEAR(dData[row * n + col], ref, 1e-3 * std::abs(ref) + 1e-2) << "row " << row << " col " << col;
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/quantization.h"
+#include "tensorrt_llm/kernels/layernormKernels.h"
+#include "tensorrt_llm/kernels/rmsnormKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <type_traits>
+
+namespace tk = tensorrt_llm::kernels;
+namespace tc = tensorrt_llm::common;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+SizeType32 constexpr kTokens = 5;
+SizeType32 constexpr kHiddenDim = 1024;
+float constexpr kEps = 1e-5F;
+
+class FusedResidualNormQuantTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> distr(-2.F, 2.F);
+        std::uniform_real_distribution<float> scaleDistr(0.5F, 1.5F);
+        auto const fill = [](ITensor& tensor, auto& dist, auto& gen)
+        {
+            auto* data = bufferCast<half>(tensor);
+            for (std::size_t i = 0; i < tensor.getSize(); ++i)
+            {
+                data[i] = static_cast<half>(dist(gen));
+            }
+        };
+        auto const rowShape = ITensor::makeShape({kTokens, kHiddenDim});
+        auto const channelShape = ITensor::makeShape({kHiddenDim});
+        mInput = BufferManager::pinned(rowShape, nvinfer1::DataType::kHALF);
+        mResidual = BufferManager::pinned(rowShape, nvinfer1::DataType::kHALF);
+        mGamma = BufferManager::pinned(channelShape, nvinfer1::DataType::kHALF);
+        mBeta = BufferManager::pinned(channelShape, nvinfer1::DataType::kHALF);
+        mPreQuantScale = BufferManager::pinned(channelShape, nvinfer1::DataType::kHALF);
+        fill(*mInput, distr, generator);
+        fill(*mResidual, distr, generator);
+        fill(*mGamma, scaleDistr, generator);
+        fill(*mBeta, distr, generator);
+        fill(*mPreQuantScale, scaleDistr, generator);
+    }
+
+    //! The unfused reference: residual add rounded to half, norm, then per channel scaling.
+    [[nodiscard]] std::vector<float> reference(bool layerNorm) const
+    {
+        auto const* input = bufferCast<half>(*mInput);
+        auto const* residual = bufferCast<half>(*mResidual);
+        auto const* gamma = bufferCast<half>(*mGamma);
+        auto const* beta = bufferCast<half>(*mBeta);
+        auto const* preQuantScale = bufferCast<half>(*mPreQuantScale);
+        std::vector<float> normed(kTokens * kHiddenDim);
+        for (SizeType32 t = 0; t < kTokens; ++t)
+        {
+            std::vector<float> sum(kHiddenDim);
+            double mean = 0.;
+            for (SizeType32 i = 0; i < kHiddenDim; ++i)
+            {
+                auto const idx = t * kHiddenDim + i;
+                sum[i] = static_cast<float>(
+                    static_cast<half>(static_cast<float>(input[idx]) + static_cast<float>(residual[idx])));
+                mean += sum[i];
+            }
+            mean = layerNorm ? mean / kHiddenDim : 0.;
+            double variance = 0.;
+            for (auto const val : sum)
+            {
+                variance += (val - mean) * (val - mean);
+            }
+            auto const rsigma = 1. / std::sqrt(variance / kHiddenDim + kEps);
+            for (SizeType32 i = 0; i < kHiddenDim; ++i)
+            {
+                auto val = (sum[i] - mean) * rsigma * static_cast<float>(gamma[i]);
+                if (layerNorm)
+                {
+                    val += static_cast<float>(beta[i]);
+                }
+                normed[t * kHiddenDim + i] = static_cast<float>(val * static_cast<float>(preQuantScale[i]));
+            }
+        }
+        return normed;
+    }
+
+    template <typename QuantT>
+    void check(bool layerNorm, float maxQuantVal, float relTolerance)
+    {
+        auto input = mBufferManager->copyFrom(*mInput, MemoryType::kGPU);
+        auto residual = mBufferManager->copyFrom(*mResidual, MemoryType::kGPU);
+        auto gamma = mBufferManager->copyFrom(*mGamma, MemoryType::kGPU);
+        auto beta = mBufferManager->copyFrom(*mBeta, MemoryType::kGPU);
+        auto preQuantScale = mBufferManager->copyFrom(*mPreQuantScale, MemoryType::kGPU);
+        auto residualOut = mBufferManager->gpu(mInput->getShape(), nvinfer1::DataType::kHALF);
+        auto quantized = mBufferManager->gpu(
+            mInput->getShape(), std::is_same_v<QuantT, int8_t> ? nvinfer1::DataType::kINT8 : nvinfer1::DataType::kFP8);
+        auto scales = mBufferManager->gpu(ITensor::makeShape({kTokens}), nvinfer1::DataType::kFLOAT);
+
+        auto* quantOut = reinterpret_cast<QuantT*>(quantized->data());
+        if (layerNorm)
+        {
+            tk::invokeGeneralLayerNorm<half, QuantT>(nullptr, bufferCast<half>(*input), bufferCast<half>(*gamma),
+                bufferCast<half>(*beta), kEps, kTokens, kHiddenDim, mStream->get(), false, nullptr,
+                bufferCast<float>(*scales), quantOut, bufferCast<half>(*residual), bufferCast<half>(*residualOut),
+                bufferCast<half>(*preQuantScale));
+        }
+        else
+        {
+            auto const quantMode
+                = std::is_same_v<QuantT, int8_t> ? tc::QuantMode::perTokenScaling() : tc::QuantMode::fp8RowWise();
+            tk::invokeGeneralRmsNorm<half, QuantT>(nullptr, bufferCast<half>(*input), bufferCast<half>(*gamma),
+                nullptr, kEps, kTokens, kHiddenDim, quantMode, mStream->get(), nullptr, nullptr,
+                bufferCast<float>(*scales), quantOut, bufferCast<half>(*residual), bufferCast<half>(*residualOut),
+                bufferCast<half>(*preQuantScale));
+        }
+
+        auto quantizedHost = mBufferManager->copyFrom(*quantized, MemoryType::kCPU);
+        auto scalesHost = mBufferManager->copyFrom(*scales, MemoryType::kCPU);
+        auto residualOutHost = mBufferManager->copyFrom(*residualOut, MemoryType::kCPU);
+        mStream->synchronize();
+
+        auto const normed = reference(layerNorm);
+        auto const* quant = reinterpret_cast<QuantT const*>(quantizedHost->data());
+        auto const* input = bufferCast<half>(*mInput);
+        auto const* residualIn = bufferCast<half>(*mResidual);
+        for (SizeType32 t = 0; t < kTokens; ++t)
+        {
+            auto const rowBegin = normed.begin() + t * kHiddenDim;
+            auto const amax = std::abs(*std::max_element(rowBegin, rowBegin + kHiddenDim,
+                [](float a, float b) { return std::abs(a) < std::abs(b); }));
+            auto const scale = bufferCast<float>(*scalesHost)[t];
+            EXPECT_NEAR(scale, amax / maxQuantVal, 1e-2F * amax / maxQuantVal) << "token " << t;
+            for (SizeType32 i = 0; i < kHiddenDim; ++i)
+            {
+                auto const idx = t * kHiddenDim + i;
+                auto const sum
+                    = static_cast<half>(static_cast<float>(input[idx]) + static_cast<float>(residualIn[idx]));
+                EXPECT_EQ(static_cast<float>(bufferCast<half>(*residualOutHost)[idx]), static_cast<float>(sum));
+                auto const dequantized = static_cast<float>(quant[idx]) * scale;
+                EXPECT_NEAR(dequantized, normed[idx], relTolerance * std::abs(normed[idx]) + 2.F * scale)
+                    << "token " << t << " channel " << i;
+            }
+        }
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+    ITensor::SharedPtr mInput;
+    ITensor::SharedPtr mResidual;
+    ITensor::SharedPtr mGamma;
+    ITensor::SharedPtr mBeta;
+    ITensor::SharedPtr mPreQuantScale;
+};
+
+TEST_F(FusedResidualNormQuantTest, RmsNormInt8)
+{
+    check<int8_t>(false, 127.F, 0.F);
+}
+
+TEST_F(FusedResidualNormQuantTest, LayerNormInt8)
+{
+    check<int8_t>(true, 127.F, 0.F);
+}
+
+#ifdef ENABLE_FP8
+TEST_F(FusedResidualNormQuantTest, RmsNormFp8)
+{
+    check<__nv_fp8_e4m3>(false, 448.F, 1.F / 8);
+}
+
+TEST_F(FusedResidualNormQuantTest, LayerNormFp8)
+{
+    check<__nv_fp8_e4m3>(true, 448.F, 1.F / 8);
+}
+#endif
+
+} // namespace
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/gatedGemm.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <cmath>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class GatedGemmTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    //! \brief Run the gated GEMM on random inputs and check it against the unfused reference.
+    //! \param smoothQuant int8 inputs with per-token and per-channel scales instead of fp16 inputs
+    void runTest(SizeType32 m, SizeType32 n, SizeType32 k, tk::GatedActivationType activation, bool smoothQuant)
+    {
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> distr(-1.f, 1.f);
+        std::uniform_int_distribution<int> intDistr(-127, 127);
+        auto const inputType = smoothQuant ? nvinfer1::DataType::kINT8 : nvinfer1::DataType::kHALF;
+
+        auto aHost = BufferManager::pinned(ITensor::makeShape({m, k}), inputType);
+        auto bHost = BufferManager::pinned(ITensor::makeShape({n, k}), inputType);
+        auto biasHost = BufferManager::pinned(ITensor::makeShape({n}), nvinfer1::DataType::kHALF);
+        auto tokenScalesHost = BufferManager::pinned(ITensor::makeShape({m}), nvinfer1::DataType::kFLOAT);
+        auto channelScalesHost = BufferManager::pinned(ITensor::makeShape({n}), nvinfer1::DataType::kFLOAT);
+        std::vector<float> a(m * k);
+        std::vector<float> b(n * k);
+        for (SizeType32 i = 0; i < m * k; ++i)
+        {
+            if (smoothQuant)
+            {
+                bufferCast<int8_t>(*aHost)[i] = static_cast<int8_t>(intDistr(generator));
+                a[i] = bufferCast<int8_t>(*aHost)[i];
+            }
+            else
+            {
+                bufferCast<half>(*aHost)[i] = static_cast<half>(distr(generator));
+                a[i] = static_cast<float>(bufferCast<half>(*aHost)[i]);
+            }
+        }
+        for (SizeType32 i = 0; i < n * k; ++i)
+        {
+            if (smoothQuant)
+            {
+                bufferCast<int8_t>(*bHost)[i] = static_cast<int8_t>(intDistr(generator));
+                b[i] = bufferCast<int8_t>(*bHost)[i];
+            }
+            else
+            {
+                bufferCast<half>(*bHost)[i] = static_cast<half>(distr(generator));
+                b[i] = static_cast<float>(bufferCast<half>(*bHost)[i]);
+            }
+        }
+        auto* bias = bufferCast<half>(*biasHost);
+        auto* tokenScales = bufferCast<float>(*tokenScalesHost);
+        auto* channelScales = bufferCast<float>(*channelScalesHost);
+        for (SizeType32 col = 0; col < n; ++col)
+        {
+            bias[col] = static_cast<half>(distr(generator));
+            channelScales[col] = 1e-3f * static_cast<float>(col % 5 + 1);
+        }
+        for (SizeType32 row = 0; row < m; ++row)
+        {
+            tokenScales[row] = 1e-2f * static_cast<float>(row % 3 + 1);
+        }
+
+        auto aDevice = mBufferManager->copyFrom(*aHost, MemoryType::kGPU);
+        auto bDevice = mBufferManager->copyFrom(*bHost, MemoryType::kGPU);
+        auto biasDevice = mBufferManager->copyFrom(*biasHost, MemoryType::kGPU);
+        auto tokenScalesDevice = mBufferManager->copyFrom(*tokenScalesHost, MemoryType::kGPU);
+        auto channelScalesDevice = mBufferManager->copyFrom(*channelScalesHost, MemoryType::kGPU);
+        auto d = mBufferManager->gpu(ITensor::makeShape({m, n / 2}), nvinfer1::DataType::kHALF);
+
+        float constexpr scaleOutput = 0.5f;
+        if (smoothQuant)
+        {
+            tk::invokeGatedGemm(bufferCast<half>(*d), bufferCast<int8_t>(*aDevice), bufferCast<int8_t>(*bDevice),
+                bufferCast<half>(*biasDevice), bufferCast<float>(*tokenScalesDevice),
+                bufferCast<float>(*channelScalesDevice), m, n, k, 1.f, 1.f, scaleOutput, activation, mStream->get());
+        }
+        else
+        {
+            tk::invokeGatedGemm(bufferCast<half>(*d), bufferCast<half>(*aDevice), bufferCast<half>(*bDevice),
+                bufferCast<half>(*biasDevice), nullptr, nullptr, m, n, k, 1.f, 1.f, scaleOutput, activation,
+                mStream->get());
+        }
+
+        auto dHost = mBufferManager->copyFrom(*d, MemoryType::kCPU);
+        mStream->synchronize();
+        auto const* dData = bufferCast<half>(*dHost);
+
+        SizeType32 const halfN = n / 2;
+        for (SizeType32 row = 0; row < m; ++row)
+        {
+            for (SizeType32 col = 0; col < halfN; ++col)
+            {
+                double up = 0.;
+                double gate = 0.;
+                for (SizeType32 c = 0; c < k; ++c)
+                {
+                    up += static_cast<double>(a[row * k + c]) * b[col * k + c];
+                    gate += static_cast<double>(a[row * k + c]) * b[(halfN + col) * k + c];
+                }
+                if (smoothQuant)
+                {
+                    up *= tokenScales[row] * channelScales[col];
+                    gate *= tokenScales[row] * channelScales[halfN + col];
+                }
+                up += static_cast<float>(bias[col]);
+                gate += static_cast<float>(bias[halfN + col]);
+                double const activated = activation == tk::GatedActivationType::kSWIGLU
+                    ? gate / (1. + std::exp(-gate))
+                    : 0.5 * gate * (1. + std::erf(gate / std::sqrt(2.)));
+                double const ref = scaleOutput * up * activated;
+                EXPECT_NEAR(static_cast<float>(dData[row * halfN + col]), ref, 1e-2 * std::abs(ref) + 1e-2)
+                    << "row " << row << " col " << col;
+            }
+        }
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(GatedGemmTest, SwigluMatchesUnfusedReference)
+{
+    // Neither m nor n / 2 is a multiple of the tile size and k is not a multiple of the 64 bytes of a k tile.
+    runTest(70, 2 * 100, 264, tk::GatedActivationType::kSWIGLU, false);
+}
+
+TEST_F(GatedGemmTest, GegluMatchesUnfusedReference)
+{
+    runTest(33, 2 * 64, 128, tk::GatedActivationType::kGEGLU, false);
+}
+
+TEST_F(GatedGemmTest, SmoothQuantMatchesUnfusedReference)
+{
+    runTest(70, 2 * 100, 272, tk::GatedActivationType::kSWIGLU, true);
+}
+
+} // namespace
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/gqaGenerationAttention.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <cmath>
+#include <functional>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class GqaGenerationAttentionTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (!tk::isGqaGenerationAttentionSupported(tensorrt_llm::common::getSMVersion(), 64))
+        {
+            GTEST_SKIP() << "GQA generation attention requires SM80 or newer";
+        }
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    //! \brief Random fp16 values, returned as the floats they round to.
+    static std::vector<float> makeRandom(std::size_t size, std::mt19937& generator)
+    {
+        std::uniform_real_distribution<float> distr(-1.f, 1.f);
+        std::vector<float> values(size);
+        for (auto& val : values)
+        {
+            val = static_cast<float>(static_cast<half>(distr(generator)));
+        }
+        return values;
+    }
+
+    ITensor::SharedPtr toDevice(std::vector<float> const& values)
+    {
+        auto host = BufferManager::pinned(
+            ITensor::makeShape({static_cast<SizeType32>(values.size())}), nvinfer1::DataType::kHALF);
+        auto* data = bufferCast<half>(*host);
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            data[i] = static_cast<half>(values[i]);
+        }
+        return mBufferManager->copyFrom(*host, MemoryType::kGPU);
+    }
+
+    //! \brief Run the kernels and check them against attention over the last attentionWindowSize tokens.
+    //! \param getKvRow Host row of K or V of (sequence, logical token, KV head)
+    template <typename KVCacheBuffer>
+    void runTest(tk::GqaGenerationAttentionParams<half, KVCacheBuffer> params, std::vector<float> const& q,
+        std::vector<SizeType32> const& sequenceLengths,
+        std::function<float const*(SizeType32, SizeType32, SizeType32, bool)> const& getKvRow)
+    {
+        auto const batchSize = params.batchSize;
+        auto const numHeads = params.numHeads;
+        auto const headSize = params.headSize;
+        auto deviceQ = toDevice(q);
+        auto deviceOut
+            = mBufferManager->gpu(ITensor::makeShape({batchSize * numHeads * headSize}), nvinfer1::DataType::kHALF);
+        auto deviceLengths
+            = mBufferManager->copyFrom(sequenceLengths, ITensor::makeShape({batchSize}), MemoryType::kGPU);
+        params.q = bufferCast<half>(*deviceQ);
+        params.out = bufferCast<half>(*deviceOut);
+        params.sequenceLengths = bufferCast<SizeType32>(*deviceLengths);
+        params.qkScale = 1.f / std::sqrt(static_cast<float>(headSize));
+
+        for (SizeType32 numSplits : {1, 3})
+        {
+            auto workspace = mBufferManager->gpu(
+                std::max<std::size_t>(
+                    tk::getGqaGenerationAttentionWorkspaceSize(batchSize, numHeads, headSize, numSplits), 1),
+                nvinfer1::DataType::kINT8);
+            params.workspace = workspace->data();
+            params.numSplits = numSplits;
+            tk::invokeGqaGenerationAttention(params, mStream->get());
+
+            auto out = mBufferManager->copyFrom(*deviceOut, MemoryType::kCPU);
+            mStream->synchronize();
+            auto const* outData = bufferCast<half>(*out);
+
+            for (SizeType32 seq = 0; seq < batchSize; ++seq)
+            {
+                auto const seqLength = sequenceLengths[seq];
+                auto const tokenBegin = std::max(0, seqLength - params.attentionWindowSize);
+                for (SizeType32 head = 0; head < numHeads; ++head)
+                {
+                    auto const kvHead = head / (numHeads / params.numKvHeads);
+                    auto const* qRow = q.data() + (seq * numHeads + head) * headSize;
+                    std::vector<float> scores(seqLength - tokenBegin);
+                    float maxScore = -INFINITY;
+                    for (SizeType32 token = tokenBegin; token < seqLength; ++token)
+                    {
+                        auto const* kRow = getKvRow(seq, token, kvHead, false);
+                        float dot = 0.f;
+                        for (SizeType32 d = 0; d < headSize; ++d)
+                        {
+                            dot += qRow[d] * kRow[d];
+                        }
+                        scores[token - tokenBegin] = dot * params.qkScale;
+                        maxScore = std::max(maxScore, scores[token - tokenBegin]);
+                    }
+                    std::vector<float> ref(headSize, 0.f);
+                    float sum = 0.f;
+                    for (SizeType32 token = tokenBegin; token < seqLength; ++token)
+                    {
+                        auto const* vRow = getKvRow(seq, token, kvHead, true);
+                        auto const p = std::exp(scores[token - tokenBegin] - maxScore);
+                        sum += p;
+                        for (SizeType32 d = 0; d < headSize; ++d)
+                        {
+                            ref[d] += p * vRow[d];
+                        }
+                    }
+                    for (SizeType32 d = 0; d < headSize; ++d)
+                    {
+                        // P is rounded to fp16 for the P.V MMA.
+                        EXPECT_NEAR(static_cast<float>(outData[(seq * numHeads + head) * headSize + d]), ref[d] / sum,
+                            5e-3f)
+                            << "seq " << seq << " head " << head << " dim " << d << " splits " << numSplits;
+                    }
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(GqaGenerationAttentionTest, PagedKvCacheMatchesReference)
+{
+    SizeType32 constexpr numHeads = 20;
+    SizeType32 constexpr numKvHeads = 2;
+    SizeType32 constexpr headSize = 128;
+    SizeType32 constexpr tokensPerBlock = 16;
+    SizeType32 constexpr maxBlocksPerSeq = 13;
+    SizeType32 constexpr blockSize = numKvHeads * tokensPerBlock * headSize;
+    // Neither the lengths nor the heads per KV head are multiples of the tiles, sequence 1 only has its current token.
+    std::vector<SizeType32> const sequenceLengths{70, 1, 33, 200};
+    auto const batchSize = static_cast<SizeType32>(sequenceLengths.size());
+
+    // Blocks of the sequences are interleaved in the pool, K block 2 * b and V block 2 * b + 1 for the b-th block.
+    std::vector<tk::KVCacheIndex> hostOffsets(batchSize * 2 * maxBlocksPerSeq, tk::KVCacheIndex{0});
+    for (SizeType32 seq = 0; seq < batchSize; ++seq)
+    {
+        for (SizeType32 bi = 0; bi < maxBlocksPerSeq; ++bi)
+        {
+            auto const block = 2 * (bi * batchSize + seq);
+            hostOffsets[(seq * 2) * maxBlocksPerSeq + bi] = tk::KVCacheIndex{block};
+            hostOffsets[(seq * 2 + 1) * maxBlocksPerSeq + bi] = tk::KVCacheIndex{block + 1};
+        }
+    }
+    SizeType32 constexpr numPoolBlocks = 2 * maxBlocksPerSeq * 4;
+
+    std::mt19937 generator(42);
+    auto const pool = makeRandom(numPoolBlocks * blockSize, generator);
+    auto const q = makeRandom(batchSize * numHeads * headSize, generator);
+    auto devicePool = toDevice(pool);
+    auto deviceOffsets = mBufferManager->gpu(
+        ITensor::makeShape({static_cast<SizeType32>(hostOffsets.size())}), nvinfer1::DataType::kINT32);
+    mBufferManager->copy(hostOffsets.data(), *deviceOffsets, MemoryType::kCPU);
+
+    tk::GqaGenerationAttentionParams<half, tk::KVBlockArray> params;
+    params.kvCache = tk::KVBlockArray(batchSize, maxBlocksPerSeq, tokensPerBlock,
+        numKvHeads * headSize * sizeof(half), 1024, 0, devicePool->data(), nullptr,
+        reinterpret_cast<tk::KVCacheIndex*>(deviceOffsets->data()));
+    params.batchSize = batchSize;
+    params.numHeads = numHeads;
+    params.numKvHeads = numKvHeads;
+    params.headSize = headSize;
+    params.attentionWindowSize = 1024;
+    runTest(params, q, sequenceLengths,
+        [&](SizeType32 seq, SizeType32 token, SizeType32 kvHead, bool isV)
+        {
+            auto const block = hostOffsets[(seq * 2 + (isV ? 1 : 0)) * maxBlocksPerSeq + token / tokensPerBlock].get();
+            return pool.data() + block * blockSize + (kvHead * tokensPerBlock + token % tokensPerBlock) * headSize;
+        });
+}
+
+TEST_F(GqaGenerationAttentionTest, CyclicLinearKvCacheMatchesReference)
+{
+    // 24 query heads per KV head take two CTAs, the second one half empty.
+    SizeType32 constexpr numHeads = 24;
+    SizeType32 constexpr numKvHeads = 1;
+    SizeType32 constexpr headSize = 80;
+    SizeType32 constexpr attentionWindow = 48;
+    // Sequence 0 wrapped around the cyclic KV cache.
+    std::vector<SizeType32> const sequenceLengths{100, 30};
+    auto const batchSize = static_cast<SizeType32>(sequenceLengths.size());
+    SizeType32 constexpr seqSize = 2 * numKvHeads * attentionWindow * headSize;
+
+    std::mt19937 generator(7);
+    auto const cache = makeRandom(batchSize * seqSize, generator);
+    auto const q = makeRandom(batchSize * numHeads * headSize, generator);
+    auto deviceCache = toDevice(cache);
+
+    tk::GqaGenerationAttentionParams<half, tk::KVLinearBuffer> params;
+    params.kvCache = tk::KVLinearBuffer(batchSize, attentionWindow, numKvHeads * headSize * sizeof(half),
+        attentionWindow, 0, false, reinterpret_cast<int8_t*>(deviceCache->data()));
+    params.batchSize = batchSize;
+    params.numHeads = numHeads;
+    params.numKvHeads = numKvHeads;
+    params.headSize = headSize;
+    params.attentionWindowSize = attentionWindow;
+    runTest(params, q, sequenceLengths,
+        [&](SizeType32 seq, SizeType32 token, SizeType32 kvHead, bool isV)
+        {
+            return cache.data() + seq * seqSize + (isV ? seqSize / 2 : 0)
+                + (kvHead * attentionWindow + token % attentionWindow) * headSize;
+        });
+}
+
+} // namespace
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/int4KvCacheUtils.h"
+#include "tensorrt_llm/kernels/unfusedAttentionKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+float dequantizeHost(std::uint8_t const* row, SizeType32 sizePerHead, SizeType32 channel)
+{
+    auto const packed = row[channel / 2];
+    auto const nibble = static_cast<int>(channel % 2 == 0 ? (packed & 0xF) : (packed >> 4));
+    auto const* scales = reinterpret_cast<half const*>(row + sizePerHead / 2);
+    return static_cast<float>((nibble ^ 8) - 8) * __half2float(scales[channel / tk::kInt4KvCacheGroupSize]);
+}
+
+class Int4KvCacheTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(Int4KvCacheTest, RowBytes)
+{
+    EXPECT_EQ(tk::getInt4KvCacheRowBytes(64), 36);
+    EXPECT_EQ(tk::getInt4KvCacheRowBytes(128), 72);
+}
+
+// Quantize the K/V of two context sequences into a paged INT4 kv cache and check the dequantized values.
+TEST_F(Int4KvCacheTest, QuantizeOnWrite)
+{
+    SizeType32 constexpr numHeads = 4;
+    SizeType32 constexpr numKvHeads = 2;
+    SizeType32 constexpr headSize = 64;
+    SizeType32 constexpr tokensPerBlock = 8;
+    SizeType32 constexpr maxBlocksPerSeq = 2;
+    SizeType32 constexpr rowBytes = tk::getInt4KvCacheRowBytes(headSize);
+    SizeType32 constexpr blockBytes = numKvHeads * tokensPerBlock * rowBytes;
+    SizeType32 constexpr hiddenSize = (numHeads + 2 * numKvHeads) * headSize;
+
+    std::vector<SizeType32> const seqLens{5, 9};
+    auto const batchSize = static_cast<SizeType32>(seqLens.size());
+    std::vector<SizeType32> cuSeqLens{0};
+    for (auto const len : seqLens)
+    {
+        cuSeqLens.push_back(cuSeqLens.back() + len);
+    }
+    auto const numTokens = cuSeqLens.back();
+
+    // K block 2 * (seq * maxBlocksPerSeq + b) and V block 2 * (seq * maxBlocksPerSeq + b) + 1.
+    auto const numPoolBlocks = 2 * batchSize * maxBlocksPerSeq;
+    std::vector<tk::KVCacheIndex> hostOffsets(batchSize * 2 * maxBlocksPerSeq, tk::KVCacheIndex{0});
+    for (SizeType32 seq = 0; seq < batchSize; ++seq)
+    {
+        for (SizeType32 bi = 0; bi < maxBlocksPerSeq; ++bi)
+        {
+            auto const block = 2 * (seq * maxBlocksPerSeq + bi);
+            hostOffsets[(seq * 2) * maxBlocksPerSeq + bi] = tk::KVCacheIndex{block};
+            hostOffsets[(seq * 2 + 1) * maxBlocksPerSeq + bi] = tk::KVCacheIndex{block + 1};
+        }
+    }
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distr(-2.f, 2.f);
+    std::vector<float> qkv(numTokens * hiddenSize);
+    for (auto& val : qkv)
+    {
+        val = distr(generator);
+    }
+
+    auto deviceQkv = mBufferManager->copyFrom(qkv, ITensor::makeShape({numTokens * hiddenSize}), MemoryType::kGPU);
+    auto deviceQ
+        = mBufferManager->gpu(ITensor::makeShape({numTokens * numHeads * headSize}), nvinfer1::DataType::kFLOAT);
+    auto devicePool = mBufferManager->gpu(ITensor::makeShape({numPoolBlocks * blockBytes}), nvinfer1::DataType::kINT8);
+    mBufferManager->setZero(*devicePool);
+    auto deviceOffsets = mBufferManager->gpu(
+        ITensor::makeShape({static_cast<SizeType32>(hostOffsets.size())}), nvinfer1::DataType::kINT32);
+    mBufferManager->copy(hostOffsets.data(), *deviceOffsets, MemoryType::kCPU);
+    auto deviceSeqLens = mBufferManager->copyFrom(seqLens, ITensor::makeShape({batchSize}), MemoryType::kGPU);
+    auto deviceCuSeqLens = mBufferManager->copyFrom(cuSeqLens, ITensor::makeShape({batchSize + 1}), MemoryType::kGPU);
+
+    tk::QKVPreprocessingParams<float, tk::KVBlockArray> params;
+    params.QKV = bufferCast<float>(*deviceQkv);
+    params.Q = bufferCast<float>(*deviceQ);
+    params.kv_cache_buffer = tk::KVBlockArray(batchSize, maxBlocksPerSeq, tokensPerBlock, numKvHeads * rowBytes,
+        maxBlocksPerSeq * tokensPerBlock, 0, devicePool->data(), nullptr,
+        reinterpret_cast<tk::KVCacheIndex*>(deviceOffsets->data()));
+    params.seq_lens = bufferCast<SizeType32>(*deviceSeqLens);
+    params.cache_seq_lens = bufferCast<SizeType32>(*deviceSeqLens);
+    params.cu_seq_lens = bufferCast<SizeType32>(*deviceCuSeqLens);
+    params.batch_size = batchSize;
+    params.max_input_seq_len = *std::max_element(seqLens.begin(), seqLens.end());
+    params.max_kv_seq_len = params.max_input_seq_len;
+    params.cyclic_kv_cache_len = maxBlocksPerSeq * tokensPerBlock;
+    params.token_num = numTokens;
+    params.remove_padding = true;
+    params.head_num = numHeads;
+    params.kv_head_num = numKvHeads;
+    params.qheads_per_kv_head = numHeads / numKvHeads;
+    params.size_per_head = headSize;
+    params.position_embedding_type = tk::PositionEmbeddingType::kLEARNED_ABSOLUTE;
+    params.cache_type = tk::KvCacheDataType::INT4;
+    params.enable_paged_kv_fmha = true;
+    tk::invokeQKVPreprocessing(params, mStream->get());
+
+    auto pool = mBufferManager->copyFrom(*devicePool, MemoryType::kCPU);
+    auto q = mBufferManager->copyFrom(*deviceQ, MemoryType::kCPU);
+    mStream->synchronize();
+    auto const* poolData = reinterpret_cast<std::uint8_t const*>(pool->data());
+    auto const* qData = bufferCast<float>(*q);
+
+    for (SizeType32 seq = 0; seq < batchSize; ++seq)
+    {
+        for (SizeType32 ti = 0; ti < seqLens[seq]; ++ti)
+        {
+            auto const* src = qkv.data() + (cuSeqLens[seq] + ti) * hiddenSize;
+            for (SizeType32 idx = 0; idx < numHeads * headSize; ++idx)
+            {
+                ASSERT_EQ(qData[(cuSeqLens[seq] + ti) * numHeads * headSize + idx], src[idx]);
+            }
+            for (SizeType32 kvHead = 0; kvHead < numKvHeads; ++kvHead)
+            {
+                for (SizeType32 isV = 0; isV < 2; ++isV)
+                {
+                    auto const block = 2 * (seq * maxBlocksPerSeq + ti / tokensPerBlock) + isV;
+                    auto const* row = poolData + block * blockBytes
+                        + (kvHead * tokensPerBlock + ti % tokensPerBlock) * rowBytes;
+                    auto const* ref = src + (numHeads + isV * numKvHeads + kvHead) * headSize;
+                    for (SizeType32 group = 0; group < headSize; group += tk::kInt4KvCacheGroupSize)
+                    {
+                        auto const amax = std::abs(*std::max_element(ref + group,
+                            ref + group + tk::kInt4KvCacheGroupSize,
+                            [](float a, float b) { return std::abs(a) < std::abs(b); }));
+                        // Half a quantization step plus the fp16 rounding of the scale.
+                        auto const tolerance = amax / 7.f * 0.51f + 1e-3f;
+                        for (SizeType32 d = group; d < group + tk::kInt4KvCacheGroupSize; ++d)
+                        {
+                            ASSERT_NEAR(dequantizeHost(row, headSize, d), ref[d], tolerance)
+                                << "seq " << seq << " token " << ti << " kv head " << kvHead << " v " << isV
+                                << " dim " << d;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/kvCacheBlockQuantization.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <cmath>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class KvCacheBlockQuantizationTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(KvCacheBlockQuantizationTest, Int8RoundTrip)
+{
+    SizeType32 constexpr numBlocks = 3;
+    SizeType32 constexpr numHeadSlices = 2 * 2 * 4;
+    SizeType32 constexpr headSliceSize = 16 * 64;
+    auto const blockShape = ITensor::makeShape({numHeadSlices, headSliceSize});
+
+    std::mt19937 generator(42);
+    std::vector<ITensor::SharedPtr> blocks;
+    std::vector<ITensor::SharedPtr> hostBlocks;
+    auto blockPtrs = BufferManager::pinned(ITensor::makeShape({numBlocks}), nvinfer1::DataType::kINT64);
+    for (SizeType32 bi = 0; bi < numBlocks; ++bi)
+    {
+        auto hostBlock = BufferManager::pinned(blockShape, nvinfer1::DataType::kHALF);
+        auto* hostData = bufferCast<half>(*hostBlock);
+        for (SizeType32 si = 0; si < numHeadSlices; ++si)
+        {
+            // Vary the range per slice to exercise the per-head scales
+            std::uniform_real_distribution<float> distr(-1.f - si, 1.f + si);
+            for (SizeType32 i = 0; i < headSliceSize; ++i)
+            {
+                hostData[si * headSliceSize + i] = static_cast<half>(distr(generator));
+            }
+        }
+        auto block = mBufferManager->copyFrom(*hostBlock, MemoryType::kGPU);
+        bufferCast<int64_t>(*blockPtrs)[bi] = reinterpret_cast<int64_t>(block->data());
+        blocks.push_back(std::move(block));
+        hostBlocks.push_back(std::move(hostBlock));
+    }
+
+    auto quantized = mBufferManager->gpu(
+        ITensor::makeShape({numBlocks, numHeadSlices, headSliceSize}), nvinfer1::DataType::kINT8);
+    auto scales = mBufferManager->gpu(ITensor::makeShape({numBlocks, numHeadSlices}), nvinfer1::DataType::kFLOAT);
+
+    tk::invokeQuantizeKvCacheBlocks<half, int8_t>(bufferCast<int8_t>(*quantized), bufferCast<float>(*scales),
+        reinterpret_cast<half const* const*>(bufferCast<int64_t>(*blockPtrs)), numBlocks, numHeadSlices,
+        headSliceSize, mStream->get());
+
+    for (auto& block : blocks)
+    {
+        mBufferManager->setZero(*block);
+    }
+    tk::invokeDequantizeKvCacheBlocks<half, int8_t>(reinterpret_cast<half* const*>(bufferCast<int64_t>(*blockPtrs)),
+        bufferCast<int8_t>(*quantized), bufferCast<float>(*scales), numBlocks, numHeadSlices, headSliceSize,
+        mStream->get());
+
+    auto scalesHost = mBufferManager->copyFrom(*scales, MemoryType::kCPU);
+    for (SizeType32 bi = 0; bi < numBlocks; ++bi)
+    {
+        auto result = mBufferManager->copyFrom(*blocks[bi], MemoryType::kCPU);
+        mStream->synchronize();
+        auto const* ref = bufferCast<half>(*hostBlocks[bi]);
+        auto const* out = bufferCast<half>(*result);
+        for (SizeType32 si = 0; si < numHeadSlices; ++si)
+        {
+            auto const scale = bufferCast<float>(*scalesHost)[bi * numHeadSlices + si];
+            for (SizeType32 i = 0; i < headSliceSize; ++i)
+            {
+                auto const idx = si * headSliceSize + i;
+                EXPECT_NEAR(static_cast<float>(out[idx]), static_cast<float>(ref[idx]), scale)
+                    << "block " << bi << " slice " << si << " element " << i;
+            }
+        }
+    }
+}
+
+} // namespace
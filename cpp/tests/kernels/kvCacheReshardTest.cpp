@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/kvCacheReshard.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class KvCacheReshardTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    //! \brief Move layers [1, 2) and heads [1, 3) of a 2-layer, 4-head context block into a 1-layer, 2-head
+    //! generation block, i.e. a TP1/PP1 context rank feeding a TP2/PP2 generation rank.
+    void testReshard(SizeType32 headSliceBytes)
+    {
+        SizeType32 constexpr numBlocks = 3;
+        SizeType32 constexpr srcLayers = 2;
+        SizeType32 constexpr srcHeads = 4;
+        SizeType32 constexpr dstLayers = 1;
+        SizeType32 constexpr dstHeads = 2;
+        auto const srcBlockBytes = srcLayers * 2 * srcHeads * headSliceBytes;
+        auto const dstBlockBytes = dstLayers * 2 * dstHeads * headSliceBytes;
+
+        auto srcPtrs = BufferManager::pinned(ITensor::makeShape({numBlocks}), nvinfer1::DataType::kINT64);
+        auto dstPtrs = BufferManager::pinned(ITensor::makeShape({numBlocks}), nvinfer1::DataType::kINT64);
+        std::vector<ITensor::SharedPtr> srcBlocks;
+        std::vector<ITensor::SharedPtr> dstBlocks;
+        for (SizeType32 bi = 0; bi < numBlocks; ++bi)
+        {
+            auto hostBlock = BufferManager::pinned(ITensor::makeShape({srcBlockBytes}), nvinfer1::DataType::kUINT8);
+            auto* hostData = bufferCast<uint8_t>(*hostBlock);
+            for (SizeType32 i = 0; i < srcBlockBytes; ++i)
+            {
+                hostData[i] = static_cast<uint8_t>(bi * 31 + i * 7);
+            }
+            auto srcBlock = mBufferManager->copyFrom(*hostBlock, MemoryType::kGPU);
+            auto dstBlock = mBufferManager->gpu(ITensor::makeShape({dstBlockBytes}), nvinfer1::DataType::kUINT8);
+            mBufferManager->setZero(*dstBlock);
+            bufferCast<int64_t>(*srcPtrs)[bi] = reinterpret_cast<int64_t>(srcBlock->data());
+            bufferCast<int64_t>(*dstPtrs)[bi] = reinterpret_cast<int64_t>(dstBlock->data());
+            srcBlocks.push_back(std::move(srcBlock));
+            dstBlocks.push_back(std::move(dstBlock));
+        }
+
+        tk::KvCacheBlockSlice const srcSlice{srcLayers, srcHeads, headSliceBytes, 1, 1, 1, 2};
+        tk::KvCacheBlockSlice const dstSlice{dstLayers, dstHeads, headSliceBytes, 0, 1, 0, 2};
+        auto buffer = mBufferManager->gpu(ITensor::makeShape({numBlocks * dstBlockBytes}), nvinfer1::DataType::kUINT8);
+        tk::invokeGatherKvCacheSlice(buffer->data(),
+            reinterpret_cast<void const* const*>(bufferCast<int64_t>(*srcPtrs)), numBlocks, srcSlice, mStream->get());
+        tk::invokeScatterKvCacheSlice(reinterpret_cast<void* const*>(bufferCast<int64_t>(*dstPtrs)), buffer->data(),
+            numBlocks, dstSlice, mStream->get());
+
+        for (SizeType32 bi = 0; bi < numBlocks; ++bi)
+        {
+            auto src = mBufferManager->copyFrom(*srcBlocks[bi], MemoryType::kCPU);
+            auto dst = mBufferManager->copyFrom(*dstBlocks[bi], MemoryType::kCPU);
+            mStream->synchronize();
+            auto const* srcData = bufferCast<uint8_t>(*src);
+            auto const* dstData = bufferCast<uint8_t>(*dst);
+            for (SizeType32 kv = 0; kv < 2; ++kv)
+            {
+                for (SizeType32 head = 0; head < dstHeads; ++head)
+                {
+                    auto const srcOffset = ((1 * 2 + kv) * srcHeads + 1 + head) * headSliceBytes;
+                    auto const dstOffset = (kv * dstHeads + head) * headSliceBytes;
+                    for (SizeType32 i = 0; i < headSliceBytes; ++i)
+                    {
+                        ASSERT_EQ(dstData[dstOffset + i], srcData[srcOffset + i])
+                            << "block " << bi << " kv " << kv << " head " << head << " byte " << i;
+                    }
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(KvCacheReshardTest, VectorizedCopy)
+{
+    // 16 tokens of 64 half elements
+    testReshard(16 * 64 * 2);
+}
+
+TEST_F(KvCacheReshardTest, ByteCopy)
+{
+    testReshard(2 * 3 * 1);
+}
+
+TEST_F(KvCacheReshardTest, RejectsOutOfRangeSlices)
+{
+    tk::KvCacheBlockSlice const slice{2, 4, 64, 1, 2, 0, 4};
+    EXPECT_ANY_THROW(tk::invokeGatherKvCacheSlice(nullptr, nullptr, 1, slice, mStream->get()));
+}
+
+} // namespace
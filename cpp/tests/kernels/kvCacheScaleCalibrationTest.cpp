@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/unfusedAttentionKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class KvCacheScaleCalibrationTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(KvCacheScaleCalibrationTest, UpdateScalesFromAmax)
+{
+    std::vector<float> const amax{0.5f, 1.f, 3.f, 2.f};
+    auto deviceAmax = mBufferManager->copyFrom(amax, ITensor::makeShape({4}), MemoryType::kGPU);
+    std::vector<float> const initialScales{1.f, 1.f};
+    auto deviceScales = mBufferManager->copyFrom(initialScales, ITensor::makeShape({2}), MemoryType::kGPU);
+
+    tk::invokeUpdateKvCacheScales(bufferCast<float>(*deviceAmax), 2, 448.f, bufferCast<float>(*deviceScales),
+        mStream->get());
+    auto scales = mBufferManager->copyFrom(*deviceScales, MemoryType::kCPU);
+    mStream->synchronize();
+    EXPECT_FLOAT_EQ(bufferCast<float>(*scales)[0], 448.f / 3.f);
+    EXPECT_FLOAT_EQ(bufferCast<float>(*scales)[1], 3.f / 448.f);
+
+    // Nothing tracked yet, the scales stay.
+    mBufferManager->setZero(*deviceAmax);
+    mBufferManager->copy(initialScales.data(), *deviceScales, MemoryType::kCPU);
+    tk::invokeUpdateKvCacheScales(bufferCast<float>(*deviceAmax), 2, 448.f, bufferCast<float>(*deviceScales),
+        mStream->get());
+    scales = mBufferManager->copyFrom(*deviceScales, MemoryType::kCPU);
+    mStream->synchronize();
+    EXPECT_FLOAT_EQ(bufferCast<float>(*scales)[0], 1.f);
+    EXPECT_FLOAT_EQ(bufferCast<float>(*scales)[1], 1.f);
+}
+
+// Write the K/V of two context sequences into a paged INT8 kv cache and check the amax tracked per kv head.
+TEST_F(KvCacheScaleCalibrationTest, TrackAmaxOnWrite)
+{
+    SizeType32 constexpr numHeads = 4;
+    SizeType32 constexpr numKvHeads = 2;
+    SizeType32 constexpr headSize = 64;
+    SizeType32 constexpr tokensPerBlock = 8;
+    SizeType32 constexpr maxBlocksPerSeq = 2;
+    SizeType32 constexpr blockBytes = numKvHeads * tokensPerBlock * headSize;
+    SizeType32 constexpr hiddenSize = (numHeads + 2 * numKvHeads) * headSize;
+
+    std::vector<SizeType32> const seqLens{5, 9};
+    auto const batchSize = static_cast<SizeType32>(seqLens.size());
+    std::vector<SizeType32> cuSeqLens{0};
+    for (auto const len : seqLens)
+    {
+        cuSeqLens.push_back(cuSeqLens.back() + len);
+    }
+    auto const numTokens = cuSeqLens.back();
+
+    // K block 2 * (seq * maxBlocksPerSeq + b) and V block 2 * (seq * maxBlocksPerSeq + b) + 1.
+    auto const numPoolBlocks = 2 * batchSize * maxBlocksPerSeq;
+    std::vector<tk::KVCacheIndex> hostOffsets(batchSize * 2 * maxBlocksPerSeq, tk::KVCacheIndex{0});
+    for (SizeType32 seq = 0; seq < batchSize; ++seq)
+    {
+        for (SizeType32 bi = 0; bi < maxBlocksPerSeq; ++bi)
+        {
+            auto const block = 2 * (seq * maxBlocksPerSeq + bi);
+            hostOffsets[(seq * 2) * maxBlocksPerSeq + bi] = tk::KVCacheIndex{block};
+            hostOffsets[(seq * 2 + 1) * maxBlocksPerSeq + bi] = tk::KVCacheIndex{block + 1};
+        }
+    }
+
+    // Give every kv head a different range.
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distr(-1.f, 1.f);
+    std::vector<float> qkv(numTokens * hiddenSize);
+    for (size_t idx = 0; idx < qkv.size(); ++idx)
+    {
+        auto const head = static_cast<SizeType32>(idx % hiddenSize) / headSize;
+        qkv[idx] = distr(generator) * static_cast<float>(head + 1);
+    }
+    std::vector<float> expectedAmax(2 * numKvHeads, 0.f);
+    for (SizeType32 token = 0; token < numTokens; ++token)
+    {
+        for (SizeType32 kvHead = 0; kvHead < numKvHeads; ++kvHead)
+        {
+            for (SizeType32 isV = 0; isV < 2; ++isV)
+            {
+                auto const* src = qkv.data() + token * hiddenSize + (numHeads + isV * numKvHeads + kvHead) * headSize;
+                for (SizeType32 d = 0; d < headSize; ++d)
+                {
+                    expectedAmax[2 * kvHead + isV] = std::max(expectedAmax[2 * kvHead + isV], std::abs(src[d]));
+                }
+            }
+        }
+    }
+
+    auto deviceQkv = mBufferManager->copyFrom(qkv, ITensor::makeShape({numTokens * hiddenSize}), MemoryType::kGPU);
+    auto deviceQ
+        = mBufferManager->gpu(ITensor::makeShape({numTokens * numHeads * headSize}), nvinfer1::DataType::kFLOAT);
+    auto devicePool = mBufferManager->gpu(ITensor::makeShape({numPoolBlocks * blockBytes}), nvinfer1::DataType::kINT8);
+    mBufferManager->setZero(*devicePool);
+    auto deviceOffsets = mBufferManager->gpu(
+        ITensor::makeShape({static_cast<SizeType32>(hostOffsets.size())}), nvinfer1::DataType::kINT32);
+    mBufferManager->copy(hostOffsets.data(), *deviceOffsets, MemoryType::kCPU);
+    auto deviceSeqLens = mBufferManager->copyFrom(seqLens, ITensor::makeShape({batchSize}), MemoryType::kGPU);
+    auto deviceCuSeqLens = mBufferManager->copyFrom(cuSeqLens, ITensor::makeShape({batchSize + 1}), MemoryType::kGPU);
+    std::vector<float> const scaleOrigQuant{1.f};
+    auto deviceScale = mBufferManager->copyFrom(scaleOrigQuant, ITensor::makeShape({1}), MemoryType::kGPU);
+    auto deviceAmax = mBufferManager->gpu(ITensor::makeShape({2 * numKvHeads}), nvinfer1::DataType::kFLOAT);
+    mBufferManager->setZero(*deviceAmax);
+
+    tk::QKVPreprocessingParams<float, tk::KVBlockArray> params;
+    params.QKV = bufferCast<float>(*deviceQkv);
+    params.Q = bufferCast<float>(*deviceQ);
+    params.kv_cache_buffer = tk::KVBlockArray(batchSize, maxBlocksPerSeq, tokensPerBlock, numKvHeads * headSize,
+        maxBlocksPerSeq * tokensPerBlock, 0, devicePool->data(), nullptr,
+        reinterpret_cast<tk::KVCacheIndex*>(deviceOffsets->data()));
+    params.seq_lens = bufferCast<SizeType32>(*deviceSeqLens);
+    params.cache_seq_lens = bufferCast<SizeType32>(*deviceSeqLens);
+    params.cu_seq_lens = bufferCast<SizeType32>(*deviceCuSeqLens);
+    params.kvScaleOrigQuant = bufferCast<float>(*deviceScale);
+    params.kv_cache_amax = bufferCast<float>(*deviceAmax);
+    params.batch_size = batchSize;
+    params.max_input_seq_len = *std::max_element(seqLens.begin(), seqLens.end());
+    params.max_kv_seq_len = params.max_input_seq_len;
+    params.cyclic_kv_cache_len = maxBlocksPerSeq * tokensPerBlock;
+    params.token_num = numTokens;
+    params.remove_padding = true;
+    params.head_num = numHeads;
+    params.kv_head_num = numKvHeads;
+    params.qheads_per_kv_head = numHeads / numKvHeads;
+    params.size_per_head = headSize;
+    params.position_embedding_type = tk::PositionEmbeddingType::kLEARNED_ABSOLUTE;
+    params.cache_type = tk::KvCacheDataType::INT8;
+    params.enable_paged_kv_fmha = true;
+    tk::invokeQKVPreprocessing(params, mStream->get());
+
+    auto amax = mBufferManager->copyFrom(*deviceAmax, MemoryType::kCPU);
+    mStream->synchronize();
+    for (SizeType32 idx = 0; idx < 2 * numKvHeads; ++idx)
+    {
+        EXPECT_FLOAT_EQ(bufferCast<float>(*amax)[idx], expectedAmax[idx]) << "kv head " << idx / 2 << " v " << idx % 2;
+    }
+}
+
+} // namespace
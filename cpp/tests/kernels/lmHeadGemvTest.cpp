@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/lmHeadGemv.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <cmath>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class LmHeadGemvTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    //! \brief Run the GEMV on random int8 weights and check the logits against a dequantized reference.
+    //! \param numRows Rows of the activations
+    //! \param m Rows of the logits
+    void runTest(SizeType32 numRows, SizeType32 m, SizeType32 n, SizeType32 k, std::vector<int> const& lastTokenIds,
+        SizeType32 seqStride)
+    {
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> distr(-1.f, 1.f);
+        std::uniform_int_distribution<int> weightDistr(-127, 127);
+
+        auto actHost = BufferManager::pinned(ITensor::makeShape({numRows, k}), nvinfer1::DataType::kHALF);
+        auto* actData = bufferCast<half>(*actHost);
+        for (SizeType32 i = 0; i < numRows * k; ++i)
+        {
+            actData[i] = static_cast<half>(distr(generator));
+        }
+        auto weightHost = BufferManager::pinned(ITensor::makeShape({n, k}), nvinfer1::DataType::kINT8);
+        auto scalesHost = BufferManager::pinned(ITensor::makeShape({n}), nvinfer1::DataType::kFLOAT);
+        auto* weightData = bufferCast<int8_t>(*weightHost);
+        auto* scalesData = bufferCast<float>(*scalesHost);
+        for (SizeType32 i = 0; i < n * k; ++i)
+        {
+            weightData[i] = static_cast<int8_t>(weightDistr(generator));
+        }
+        for (SizeType32 col = 0; col < n; ++col)
+        {
+            scalesData[col] = 1e-3f * static_cast<float>(col % 7 + 1);
+        }
+
+        auto act = mBufferManager->copyFrom(*actHost, MemoryType::kGPU);
+        auto weight = mBufferManager->copyFrom(*weightHost, MemoryType::kGPU);
+        auto scales = mBufferManager->copyFrom(*scalesHost, MemoryType::kGPU);
+        auto logits = mBufferManager->gpu(ITensor::makeShape({m, n}), nvinfer1::DataType::kFLOAT);
+        ITensor::SharedPtr ids;
+        if (!lastTokenIds.empty())
+        {
+            ids = mBufferManager->copyFrom(lastTokenIds, ITensor::makeShape({m}), MemoryType::kGPU);
+        }
+
+        tk::invokeLmHeadGemv(bufferCast<float>(*logits), bufferCast<half>(*act), bufferCast<int8_t>(*weight),
+            bufferCast<float>(*scales), ids ? bufferCast<int>(*ids) : nullptr, seqStride, m, n, k, mStream->get());
+
+        auto logitsHost = mBufferManager->copyFrom(*logits, MemoryType::kCPU);
+        mStream->synchronize();
+        auto const* logitsData = bufferCast<float>(*logitsHost);
+
+        for (SizeType32 row = 0; row < m; ++row)
+        {
+            auto const actRow = lastTokenIds.empty() ? row : row * seqStride + lastTokenIds[row] - 1;
+            for (SizeType32 col = 0; col < n; ++col)
+            {
+                double ref = 0.;
+                for (SizeType32 c = 0; c < k; ++c)
+                {
+                    ref += static_cast<double>(static_cast<float>(actData[actRow * k + c])) * weightData[col * k + c];
+                }
+                ref *= scalesData[col];
+                EXPECT_NEAR(logitsData[row * n + col], ref, 1e-4 * std::abs(ref) + 1e-4)
+                    << "row " << row << " col " << col;
+            }
+        }
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(LmHeadGemvTest, MatchesDequantizedReference)
+{
+    // Neither m nor n is a multiple of the tiles and k is not a multiple of the 512 columns a warp takes at once.
+    runTest(7, 7, 301, 1040, {}, 0);
+}
+
+TEST_F(LmHeadGemvTest, GathersLastTokensOfPackedInput)
+{
+    // Three sequences of 5, 1 and 4 tokens packed into 10 rows.
+    runTest(10, 3, 130, 256, {5, 6, 10}, 0);
+}
+
+TEST_F(LmHeadGemvTest, GathersLastTokensOfPaddedInput)
+{
+    // Two sequences of 3 and 6 tokens padded to 6 rows each.
+    runTest(12, 2, 130, 256, {3, 6}, 6);
+}
+
+} // namespace
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/lookupKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace tk = tensorrt_llm::kernels;
+namespace tc = tensorrt_llm::common;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+SizeType32 constexpr kLocalVocabSize = 64;
+SizeType32 constexpr kTokens = 37;
+
+class LookupKernelsTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    //! Gather from the rank-th shard of a quantized table. Ids outside of the shard must give zero rows.
+    template <typename Tin>
+    void check(SizeType32 hidden, SizeType32 rank)
+    {
+        auto const weightType = std::is_same_v<Tin, int8_t> ? nvinfer1::DataType::kINT8 : nvinfer1::DataType::kFP8;
+        auto weightHost = BufferManager::pinned(ITensor::makeShape({kLocalVocabSize, hidden}), weightType);
+        auto scalesHost = BufferManager::pinned(ITensor::makeShape({kLocalVocabSize}), nvinfer1::DataType::kHALF);
+        auto idsHost = BufferManager::pinned(ITensor::makeShape({kTokens}), nvinfer1::DataType::kINT32);
+
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> valueDistr(-100, 100);
+        std::uniform_real_distribution<float> scaleDistr(0.01F, 0.1F);
+        // Ids span three shards, so that some of them belong to other ranks
+        std::uniform_int_distribution<int> idDistr(0, 3 * kLocalVocabSize - 1);
+        auto* weight = reinterpret_cast<Tin*>(weightHost->data());
+        for (std::size_t i = 0; i < weightHost->getSize(); ++i)
+        {
+            weight[i] = static_cast<Tin>(valueDistr(generator));
+        }
+        auto* scales = bufferCast<half>(*scalesHost);
+        for (SizeType32 i = 0; i < kLocalVocabSize; ++i)
+        {
+            scales[i] = static_cast<half>(scaleDistr(generator));
+        }
+        auto* ids = bufferCast<int>(*idsHost);
+        for (SizeType32 i = 0; i < kTokens; ++i)
+        {
+            ids[i] = idDistr(generator);
+        }
+
+        auto weightDevice = mBufferManager->copyFrom(*weightHost, MemoryType::kGPU);
+        auto scalesDevice = mBufferManager->copyFrom(*scalesHost, MemoryType::kGPU);
+        auto idsDevice = mBufferManager->copyFrom(*idsHost, MemoryType::kGPU);
+        auto output = mBufferManager->gpu(ITensor::makeShape({kTokens, hidden}), nvinfer1::DataType::kHALF);
+        auto const offset = rank * kLocalVocabSize;
+        tk::invokeLookUp<half, Tin, int>(bufferCast<half>(*output), bufferCast<int>(*idsDevice),
+            reinterpret_cast<Tin const*>(weightDevice->data()), kTokens, offset, kLocalVocabSize, hidden,
+            bufferCast<half>(*scalesDevice), mStream->get());
+        auto outputHost = mBufferManager->copyFrom(*output, MemoryType::kCPU);
+        mStream->synchronize();
+
+        auto const* out = bufferCast<half>(*outputHost);
+        for (SizeType32 t = 0; t < kTokens; ++t)
+        {
+            auto const row = ids[t] - offset;
+            bool const local = row >= 0 && row < kLocalVocabSize;
+            for (SizeType32 i = 0; i < hidden; ++i)
+            {
+                auto const expected = local
+                    ? static_cast<float>(static_cast<half>(
+                        static_cast<float>(weight[row * hidden + i]) * static_cast<float>(scales[row])))
+                    : 0.F;
+                EXPECT_EQ(static_cast<float>(out[t * hidden + i]), expected) << "token " << t << " channel " << i;
+            }
+        }
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(LookupKernelsTest, Int8Vectorized)
+{
+    check<int8_t>(1024, 1);
+}
+
+TEST_F(LookupKernelsTest, Int8SeveralTokensPerWarp)
+{
+    check<int8_t>(16, 0);
+}
+
+TEST_F(LookupKernelsTest, Int8Unaligned)
+{
+    check<int8_t>(250, 2);
+}
+
+#ifdef ENABLE_FP8
+TEST_F(LookupKernelsTest, Fp8Vectorized)
+{
+    check<__nv_fp8_e4m3>(1024, 1);
+}
+
+TEST_F(LookupKernelsTest, Fp8Unaligned)
+{
+    check<__nv_fp8_e4m3>(250, 0);
+}
+#endif
+
+} // namespace
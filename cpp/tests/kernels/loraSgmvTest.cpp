@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/kernels/lora/loraSgmv.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class LoraSgmvTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (tensorrt_llm::common::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(LoraSgmvTest, MixedRanksMatchReference)
+{
+    SizeType32 constexpr numTokens = 21;
+    SizeType32 constexpr numReqs = 4;
+    SizeType32 constexpr inHiddenSize = 64;
+    SizeType32 constexpr outHiddenSize = 48;
+    SizeType32 constexpr maxLowRank = 16;
+    // Adapter of every request, the third request runs without LoRA.
+    std::vector<SizeType32> const reqTokens{1, 11, 3, 6};
+    std::vector<SizeType32> const reqAdapters{0, 1, -1, 0};
+    std::vector<SizeType32> const adapterRanks{8, 16};
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distr(-1.f, 1.f);
+    auto const randomVector = [&](std::size_t size)
+    {
+        std::vector<float> values(size);
+        for (auto& value : values)
+        {
+            value = distr(generator);
+        }
+        return values;
+    };
+
+    auto const input = randomVector(numTokens * inHiddenSize);
+    std::vector<std::vector<float>> inWeights;
+    std::vector<std::vector<float>> outWeights;
+    std::vector<ITensor::SharedPtr> weightBuffers;
+    for (auto const rank : adapterRanks)
+    {
+        inWeights.push_back(randomVector(rank * inHiddenSize));
+        outWeights.push_back(randomVector(outHiddenSize * rank));
+        weightBuffers.push_back(mBufferManager->copyFrom(inWeights.back(), ITensor::makeShape({rank, inHiddenSize}),
+            MemoryType::kGPU));
+        weightBuffers.push_back(mBufferManager->copyFrom(outWeights.back(), ITensor::makeShape({outHiddenSize, rank}),
+            MemoryType::kGPU));
+    }
+
+    std::vector<int32_t> ranks;
+    std::vector<int64_t> weightPtrs;
+    std::vector<SizeType32> tokenAdapters;
+    for (SizeType32 req = 0; req < numReqs; ++req)
+    {
+        auto const adapter = reqAdapters[req];
+        for (SizeType32 i = 0; i < reqTokens[req]; ++i)
+        {
+            tokenAdapters.push_back(adapter);
+            ranks.push_back(adapter < 0 ? 0 : adapterRanks[adapter]);
+            weightPtrs.push_back(adapter < 0 ? 0 : reinterpret_cast<int64_t>(weightBuffers[2 * adapter]->data()));
+            weightPtrs.push_back(adapter < 0 ? 0 : reinterpret_cast<int64_t>(weightBuffers[2 * adapter + 1]->data()));
+        }
+    }
+
+    auto inputDevice = mBufferManager->copyFrom(input, ITensor::makeShape({numTokens, inHiddenSize}), MemoryType::kGPU);
+    auto lowRank = mBufferManager->gpu(ITensor::makeShape({numTokens, maxLowRank}), nvinfer1::DataType::kFLOAT);
+    auto output = mBufferManager->gpu(ITensor::makeShape({numTokens, outHiddenSize}), nvinfer1::DataType::kFLOAT);
+    mBufferManager->setZero(*output);
+
+    std::vector<tk::LoraSgmvTile> tiles;
+    tk::appendLoraSgmvTiles(tiles, numTokens, ranks.data(), weightPtrs.data(), inHiddenSize, outHiddenSize, 0,
+        sizeof(float), lowRank->data(), output->data());
+    // The second request is split into two tiles.
+    EXPECT_EQ(tiles.size(), 4u);
+
+    auto const workspaceSize = tk::getLoraSgmvTilesWorkSpaceSize(tk::getLoraSgmvMaxTiles(numTokens, numReqs));
+    auto workspace = mBufferManager->gpu(workspaceSize);
+    tk::loraSgmv(tiles, inputDevice->data(), inHiddenSize, maxLowRank, outHiddenSize, workspace->data(),
+        workspaceSize, nvinfer1::DataType::kFLOAT, nvinfer1::DataType::kFLOAT, mStream->get());
+
+    std::vector<float> result(numTokens * outHiddenSize);
+    mBufferManager->copy(*output, result.data(), MemoryType::kCPU);
+    mStream->synchronize();
+
+    for (SizeType32 token = 0; token < numTokens; ++token)
+    {
+        auto const adapter = tokenAdapters[token];
+        auto const rank = adapter < 0 ? 0 : adapterRanks[adapter];
+        std::vector<float> hidden(rank, 0.f);
+        for (SizeType32 r = 0; r < rank; ++r)
+        {
+            for (SizeType32 k = 0; k < inHiddenSize; ++k)
+            {
+                hidden[r] += inWeights[adapter][r * inHiddenSize + k] * input[token * inHiddenSize + k];
+            }
+        }
+        for (SizeType32 n = 0; n < outHiddenSize; ++n)
+        {
+            float expected = 0.f;
+            for (SizeType32 r = 0; r < rank; ++r)
+            {
+                expected += outWeights[adapter][n * rank + r] * hidden[r];
+            }
+            EXPECT_NEAR(result[token * outHiddenSize + n], expected, 1e-3f) << "token " << token << " column " << n;
+        }
+    }
+}
+
+TEST_F(LoraSgmvTest, Int8WeightsAreDequantized)
+{
+    SizeType32 constexpr numTokens = 5;
+    SizeType32 constexpr inHiddenSize = 32;
+    SizeType32 constexpr outHiddenSize = 24;
+    SizeType32 constexpr rank = 4;
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distr(-1.f, 1.f);
+    std::vector<float> input(numTokens * inHiddenSize);
+    for (auto& value : input)
+    {
+        value = distr(generator);
+    }
+
+    // Quantized weights with their per-row scales in front, as stored by a quantized LoRA cache. Returns the weights
+    // the kernels see after dequantization.
+    std::vector<ITensor::SharedPtr> weightBuffers;
+    auto const quantize = [&](SizeType32 numRows, SizeType32 numCols)
+    {
+        auto const scalesSize = tk::getLoraQuantScalesSize(numRows);
+        std::vector<std::int8_t> bytes(scalesSize + numRows * numCols);
+        std::vector<float> dequantized(numRows * numCols);
+        for (SizeType32 row = 0; row < numRows; ++row)
+        {
+            float const scale = 0.01f * static_cast<float>(row + 1);
+            std::memcpy(bytes.data() + row * sizeof(float), &scale, sizeof(float));
+            for (SizeType32 col = 0; col < numCols; ++col)
+            {
+                auto const q = static_cast<std::int8_t>(std::lround(distr(generator) * 127.f));
+                bytes[scalesSize + row * numCols + col] = q;
+                dequantized[row * numCols + col] = q * scale;
+            }
+        }
+        weightBuffers.push_back(mBufferManager->copyFrom(
+            bytes, ITensor::makeShape({static_cast<SizeType32>(bytes.size())}), MemoryType::kGPU));
+        return std::make_pair(
+            reinterpret_cast<int64_t>(static_cast<std::int8_t*>(weightBuffers.back()->data()) + scalesSize),
+            dequantized);
+    };
+    auto const [inPtr, inWeights] = quantize(rank, inHiddenSize);
+    auto const [outPtr, outWeights] = quantize(outHiddenSize, rank);
+
+    std::vector<int32_t> const ranks(numTokens, rank);
+    std::vector<int64_t> weightPtrs;
+    for (SizeType32 token = 0; token < numTokens; ++token)
+    {
+        weightPtrs.push_back(inPtr);
+        weightPtrs.push_back(outPtr);
+    }
+
+    auto inputDevice = mBufferManager->copyFrom(input, ITensor::makeShape({numTokens, inHiddenSize}), MemoryType::kGPU);
+    auto lowRank = mBufferManager->gpu(ITensor::makeShape({numTokens, rank}), nvinfer1::DataType::kFLOAT);
+    auto output = mBufferManager->gpu(ITensor::makeShape({numTokens, outHiddenSize}), nvinfer1::DataType::kFLOAT);
+
+    std::vector<tk::LoraSgmvTile> tiles;
+    tk::appendLoraSgmvTiles(tiles, numTokens, ranks.data(), weightPtrs.data(), inHiddenSize, outHiddenSize, 0,
+        sizeof(std::int8_t), lowRank->data(), output->data());
+    auto const workspaceSize = tk::getLoraSgmvTilesWorkSpaceSize(tk::getLoraSgmvMaxTiles(numTokens, 1));
+    auto workspace = mBufferManager->gpu(workspaceSize);
+    tk::loraSgmv(tiles, inputDevice->data(), inHiddenSize, rank, outHiddenSize, workspace->data(), workspaceSize,
+        nvinfer1::DataType::kFLOAT, nvinfer1::DataType::kINT8, mStream->get());
+
+    std::vector<float> result(numTokens * outHiddenSize);
+    mBufferManager->copy(*output, result.data(), MemoryType::kCPU);
+    mStream->synchronize();
+
+    for (SizeType32 token = 0; token < numTokens; ++token)
+    {
+        std::vector<float> hidden(rank, 0.f);
+        for (SizeType32 r = 0; r < rank; ++r)
+        {
+            for (SizeType32 k = 0; k < inHiddenSize; ++k)
+            {
+                hidden[r] += inWeights[r * inHiddenSize + k] * input[token * inHiddenSize + k];
+            }
+        }
+        for (SizeType32 n = 0; n < outHiddenSize; ++n)
+        {
+            float expected = 0.f;
+            for (SizeType32 r = 0; r < rank; ++r)
+            {
+                expected += outWeights[n * rank + r] * hidden[r];
+            }
+            EXPECT_NEAR(result[token * outHiddenSize + n], expected, 1e-3f) << "token " << token << " column " << n;
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,419 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/lruKernel.h"
+#include "tensorrt_llm/kernels/mambaConv1dKernels.h"
+#include "tensorrt_llm/kernels/selectiveScan.h"
+#include "tensorrt_llm/kernels/speculativeDecoding/recurrentStateUpdateKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace tk = tensorrt_llm::kernels;
+namespace tc = tensorrt_llm::common;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+// A small Mamba2 mixer, the kernels only support dstate 128 and dconv 4.
+SizeType32 constexpr kBatch{3};
+SizeType32 constexpr kNumHeads{8};
+SizeType32 constexpr kNumGroups{2};
+SizeType32 constexpr kHeadDim{64};
+SizeType32 constexpr kDState{128};
+SizeType32 constexpr kDConv{4};
+SizeType32 constexpr kDim{kNumHeads * kHeadDim};
+SizeType32 constexpr kConvDim{kDim + 2 * kNumGroups * kDState};
+// The in_proj output is laid out as z, xBC, dt
+SizeType32 constexpr kInDim{kDim + kConvDim + kNumHeads};
+SizeType32 constexpr kNumSlots{5};
+std::vector<int32_t> const kSlots{4, 0, 2};
+// Tokens per sequence of the multi-token steps and the number of them each sequence accepts
+SizeType32 constexpr kStepTokens{3};
+std::vector<int32_t> const kAcceptedLengths{1, 3, 2};
+
+std::vector<float> makeValues(std::mt19937& generator, std::size_t size, float low, float high)
+{
+    std::uniform_real_distribution<float> distr(low, high);
+    std::vector<float> values(size);
+    for (auto& value : values)
+    {
+        value = distr(generator);
+    }
+    return values;
+}
+
+//! The rows of token t of every sequence, out of rows laid out as [kBatch, kStepTokens, rowSize].
+std::vector<float> tokenRows(std::vector<float> const& rows, SizeType32 rowSize, SizeType32 t)
+{
+    std::vector<float> tokenRows;
+    for (SizeType32 bi = 0; bi < kBatch; ++bi)
+    {
+        auto const begin = rows.begin() + (bi * kStepTokens + t) * rowSize;
+        tokenRows.insert(tokenRows.end(), begin, begin + rowSize);
+    }
+    return tokenRows;
+}
+
+//! Places the [kBatch, rowSize] rows of token t into rows laid out as [kBatch, kStepTokens, rowSize].
+void setTokenRows(std::vector<float>& rows, std::vector<float> const& tokenRows, SizeType32 rowSize, SizeType32 t)
+{
+    for (SizeType32 bi = 0; bi < kBatch; ++bi)
+    {
+        std::copy_n(tokenRows.begin() + bi * rowSize, rowSize, rows.begin() + (bi * kStepTokens + t) * rowSize);
+    }
+}
+
+//! The slot states once every sequence kept kAcceptedLengths of its tokens, given the states after each token.
+std::vector<float> acceptedStates(std::vector<std::vector<float>> const& stepStates, std::size_t stateSize)
+{
+    auto states = stepStates.front();
+    for (SizeType32 bi = 0; bi < kBatch; ++bi)
+    {
+        auto const& accepted = stepStates[kAcceptedLengths[bi]];
+        std::copy_n(accepted.begin() + kSlots[bi] * stateSize, stateSize, states.begin() + kSlots[bi] * stateSize);
+    }
+    return states;
+}
+
+class MambaKernelsTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+
+        std::mt19937 generator(42);
+        mConvWeight = mBufferManager->copyFrom(makeValues(generator, kDConv * kConvDim, -0.5f, 0.5f), MemoryType::kGPU);
+        mConvBias = mBufferManager->copyFrom(makeValues(generator, kConvDim, -0.1f, 0.1f), MemoryType::kGPU);
+        mA = mBufferManager->copyFrom(makeValues(generator, kNumHeads, -2.f, -0.5f), MemoryType::kGPU);
+        mD = mBufferManager->copyFrom(makeValues(generator, kNumHeads, 0.5f, 1.5f), MemoryType::kGPU);
+        mDtBias = mBufferManager->copyFrom(makeValues(generator, kNumHeads, -0.5f, 0.5f), MemoryType::kGPU);
+        mConvState = mBufferManager->copyFrom(
+            makeValues(generator, kNumSlots * (kDConv - 1) * kConvDim, -1.f, 1.f), MemoryType::kGPU);
+        mSsmState = mBufferManager->copyFrom(
+            makeValues(generator, kNumSlots * kDim * kDState, -1.f, 1.f), MemoryType::kGPU);
+        mSlotMapping = mBufferManager->copyFrom(kSlots, MemoryType::kGPU);
+    }
+
+    //! The in_proj output of numTokens decode tokens.
+    IBuffer::SharedPtr makeInput(int seed, SizeType32 numTokens)
+    {
+        std::mt19937 generator(seed);
+        return mBufferManager->copyFrom(makeValues(generator, numTokens * kInDim, -1.f, 1.f), MemoryType::kGPU);
+    }
+
+    //! Runs the causal conv1d of xBC with SiLU, writing xBC [batch * max(stepTokens, 1), kConvDim].
+    void runConv1d(IBuffer& input, IBuffer& convState, IBuffer& xBC, SizeType32 stepTokens = 0,
+        IBuffer* intermediateState = nullptr)
+    {
+        tk::MambaConv1dParamsBase params{};
+        params.batch = kBatch;
+        params.dim = kConvDim;
+        params.max_seqlen = 1;
+        params.dconv = kDConv;
+        params.pre_stride = kDim;
+        params.post_stride = kNumHeads;
+        params.apply_silu = true;
+        params.in_ptr = input.data();
+        params.state_in_ptr = convState.data();
+        params.state_out_ptr = convState.data();
+        params.weight_ptr = mConvWeight->data();
+        params.bias_ptr = mConvBias->data();
+        params.out_ptr = xBC.data();
+        params.state_slot_mapping_ptr = bufferCast<int32_t>(*mSlotMapping);
+        params.step_tokens = stepTokens;
+        params.intermediate_state_ptr = intermediateState ? intermediateState->data() : nullptr;
+        tk::invokeMambaConv1dGeneration<float>(params, mStream->get());
+    }
+
+    //! Runs the Mamba2 selective scan update on the conv output, gated with z and taking dt from the in_proj output.
+    void runSelectiveScan(IBuffer& input, IBuffer& xBC, IBuffer& ssmState, IBuffer& output, SizeType32 stepTokens = 0,
+        IBuffer* intermediateState = nullptr)
+    {
+        tk::SSMParamsBase params{};
+        params.batch = kBatch;
+        params.dim = kDim;
+        params.dstate = kDState;
+        params.nheads = kNumHeads;
+        params.ngroups = kNumGroups;
+        params.delta_softplus = true;
+        params.is_mamab2 = true;
+        params.A_ptr = mA->data();
+        params.BC_ptr = xBC.data();
+        params.D_ptr = mD->data();
+        params.u_ptr = xBC.data();
+        params.delta_ptr = input.data();
+        params.delta_bias_ptr = mDtBias->data();
+        params.out_ptr = output.data();
+        params.x_ptr = ssmState.data();
+        params.z_ptr = input.data();
+        params.slot_mapping_ptr = bufferCast<int32_t>(*mSlotMapping);
+        params.step_tokens = stepTokens;
+        params.intermediate_state_ptr = intermediateState ? intermediateState->data() : nullptr;
+        tk::invokeSelectiveScanUpdate<float, float>(params, mStream->get());
+    }
+
+    void runFused(IBuffer& input, IBuffer& convState, IBuffer& ssmState, IBuffer& output, IBuffer& semaphores)
+    {
+        tk::MambaConv1dSelectiveScanParams params{};
+        params.batch = kBatch;
+        params.dim = kDim;
+        params.dstate = kDState;
+        params.nheads = kNumHeads;
+        params.ngroups = kNumGroups;
+        params.dconv = kDConv;
+        params.delta_softplus = true;
+        params.in_ptr = input.data();
+        params.conv_weight_ptr = mConvWeight->data();
+        params.conv_bias_ptr = mConvBias->data();
+        params.conv_state_ptr = convState.data();
+        params.ssm_state_ptr = ssmState.data();
+        params.A_ptr = mA->data();
+        params.D_ptr = mD->data();
+        params.delta_bias_ptr = mDtBias->data();
+        params.z_enabled = true;
+        params.out_ptr = output.data();
+        params.slot_mapping_ptr = bufferCast<int32_t>(*mSlotMapping);
+        params.semaphore_ptr = bufferCast<int32_t>(semaphores);
+        tk::invokeMambaConv1dSelectiveScanUpdate<float, float>(params, mStream->get());
+    }
+
+    IBuffer::SharedPtr copyOf(IBuffer const& buffer)
+    {
+        return mBufferManager->copyFrom(buffer, MemoryType::kGPU);
+    }
+
+    std::vector<float> toHost(IBuffer const& buffer)
+    {
+        auto host = mBufferManager->copyFrom(buffer, MemoryType::kCPU);
+        mStream->synchronize();
+        auto const* ptr = bufferCast<float>(*host);
+        return {ptr, ptr + host->getSize()};
+    }
+
+    void expectNear(IBuffer const& actual, std::vector<float> const& expected, char const* name)
+    {
+        auto const actualHost = toHost(actual);
+        ASSERT_EQ(actualHost.size(), expected.size());
+        for (std::size_t i = 0; i < actualHost.size(); ++i)
+        {
+            ASSERT_NEAR(actualHost[i], expected[i], 1e-3f * (1.f + std::abs(expected[i])))
+                << name << " differs at " << i;
+        }
+    }
+
+    void expectNear(IBuffer const& actual, IBuffer const& expected, char const* name)
+    {
+        expectNear(actual, toHost(expected), name);
+    }
+
+    void commitStates(IBuffer& states, IBuffer const& intermediateStates, std::size_t stateSize)
+    {
+        auto acceptedLengths = mBufferManager->copyFrom(kAcceptedLengths, MemoryType::kGPU);
+        tk::speculative_decoding::invokeCommitRecurrentStates(states.data(), intermediateStates.data(),
+            bufferCast<int32_t>(*acceptedLengths), bufferCast<int32_t>(*mSlotMapping), kBatch, kStepTokens,
+            stateSize * sizeof(float), mStream->get());
+    }
+
+    //! Runs the kStepTokens tokens of every sequence one single token step after the other on copies of the states.
+    //! Returns the outputs as [kBatch, kStepTokens, kDim] and the conv and ssm states before and after every step.
+    std::vector<float> runSingleTokenSteps(std::vector<float> const& input,
+        std::vector<std::vector<float>>& convStates, std::vector<std::vector<float>>& ssmStates)
+    {
+        auto convState = copyOf(*mConvState);
+        auto ssmState = copyOf(*mSsmState);
+        auto xBC = mBufferManager->gpu(kBatch * kConvDim, nvinfer1::DataType::kFLOAT);
+        auto output = mBufferManager->gpu(kBatch * kDim, nvinfer1::DataType::kFLOAT);
+        std::vector<float> outputs(kBatch * kStepTokens * kDim);
+        convStates = {toHost(*convState)};
+        ssmStates = {toHost(*ssmState)};
+        for (SizeType32 t = 0; t < kStepTokens; ++t)
+        {
+            auto tokenInput = mBufferManager->copyFrom(tokenRows(input, kInDim, t), MemoryType::kGPU);
+            runConv1d(*tokenInput, *convState, *xBC);
+            runSelectiveScan(*tokenInput, *xBC, *ssmState, *output);
+            setTokenRows(outputs, toHost(*output), kDim, t);
+            convStates.push_back(toHost(*convState));
+            ssmStates.push_back(toHost(*ssmState));
+        }
+        return outputs;
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+
+    IBuffer::SharedPtr mConvWeight;
+    IBuffer::SharedPtr mConvBias;
+    IBuffer::SharedPtr mA;
+    IBuffer::SharedPtr mD;
+    IBuffer::SharedPtr mDtBias;
+    IBuffer::SharedPtr mConvState;
+    IBuffer::SharedPtr mSsmState;
+    IBuffer::SharedPtr mSlotMapping;
+};
+
+TEST_F(MambaKernelsTest, FusedConv1dSelectiveScanMatchesUnfused)
+{
+    auto fusedConvState = copyOf(*mConvState);
+    auto fusedSsmState = copyOf(*mSsmState);
+    auto fusedOutput = mBufferManager->gpu(kBatch * kDim, nvinfer1::DataType::kFLOAT);
+    auto const semaphoreSize = tk::getMambaConv1dSelectiveScanWorkspaceSize(kBatch, kNumGroups) / sizeof(int32_t);
+    auto semaphores = mBufferManager->gpu(semaphoreSize, nvinfer1::DataType::kINT32);
+    mBufferManager->setZero(*semaphores);
+
+    auto xBC = mBufferManager->gpu(kBatch * kConvDim, nvinfer1::DataType::kFLOAT);
+    auto output = mBufferManager->gpu(kBatch * kDim, nvinfer1::DataType::kFLOAT);
+
+    // Two steps, the second one starts from the states the first left and reuses the semaphores
+    for (int step = 0; step < 2; ++step)
+    {
+        auto input = makeInput(100 + step, kBatch);
+        runFused(*input, *fusedConvState, *fusedSsmState, *fusedOutput, *semaphores);
+        runConv1d(*input, *mConvState, *xBC);
+        runSelectiveScan(*input, *xBC, *mSsmState, *output);
+
+        expectNear(*fusedOutput, *output, "output");
+        expectNear(*fusedConvState, *mConvState, "conv state");
+        expectNear(*fusedSsmState, *mSsmState, "ssm state");
+    }
+
+    auto semaphoresHost = mBufferManager->copyFrom(*semaphores, MemoryType::kCPU);
+    mStream->synchronize();
+    auto const* semaphorePtr = bufferCast<int32_t>(*semaphoresHost);
+    for (std::size_t i = 0; i < semaphoreSize; ++i)
+    {
+        EXPECT_EQ(semaphorePtr[i], 0) << "semaphore " << i;
+    }
+}
+
+TEST_F(MambaKernelsTest, MultiTokenStepMatchesSingleTokenSteps)
+{
+    std::mt19937 generator(7);
+    auto const inputHost = makeValues(generator, kBatch * kStepTokens * kInDim, -1.f, 1.f);
+    std::vector<std::vector<float>> convStates;
+    std::vector<std::vector<float>> ssmStates;
+    auto const expectedOutput = runSingleTokenSteps(inputHost, convStates, ssmStates);
+
+    auto input = mBufferManager->copyFrom(inputHost, MemoryType::kGPU);
+    auto xBC = mBufferManager->gpu(kBatch * kStepTokens * kConvDim, nvinfer1::DataType::kFLOAT);
+    auto output = mBufferManager->gpu(kBatch * kStepTokens * kDim, nvinfer1::DataType::kFLOAT);
+    runConv1d(*input, *mConvState, *xBC, kStepTokens);
+    runSelectiveScan(*input, *xBC, *mSsmState, *output, kStepTokens);
+
+    expectNear(*output, expectedOutput, "output");
+    expectNear(*mConvState, convStates.back(), "conv state");
+    expectNear(*mSsmState, ssmStates.back(), "ssm state");
+}
+
+TEST_F(MambaKernelsTest, MultiTokenStepCommitsAcceptedStates)
+{
+    std::mt19937 generator(8);
+    auto const inputHost = makeValues(generator, kBatch * kStepTokens * kInDim, -1.f, 1.f);
+    std::vector<std::vector<float>> convStates;
+    std::vector<std::vector<float>> ssmStates;
+    auto const expectedOutput = runSingleTokenSteps(inputHost, convStates, ssmStates);
+
+    std::size_t const convStateSize = (kDConv - 1) * kConvDim;
+    std::size_t const ssmStateSize = kDim * kDState;
+    auto input = mBufferManager->copyFrom(inputHost, MemoryType::kGPU);
+    auto xBC = mBufferManager->gpu(kBatch * kStepTokens * kConvDim, nvinfer1::DataType::kFLOAT);
+    auto output = mBufferManager->gpu(kBatch * kStepTokens * kDim, nvinfer1::DataType::kFLOAT);
+    auto convIntermediate = mBufferManager->gpu(kBatch * kStepTokens * convStateSize, nvinfer1::DataType::kFLOAT);
+    auto ssmIntermediate = mBufferManager->gpu(kBatch * kStepTokens * ssmStateSize, nvinfer1::DataType::kFLOAT);
+    runConv1d(*input, *mConvState, *xBC, kStepTokens, convIntermediate.get());
+    runSelectiveScan(*input, *xBC, *mSsmState, *output, kStepTokens, ssmIntermediate.get());
+
+    expectNear(*output, expectedOutput, "output");
+    // The slots keep their states until the accepted tokens are committed
+    expectNear(*mConvState, convStates.front(), "conv state before commit");
+    expectNear(*mSsmState, ssmStates.front(), "ssm state before commit");
+
+    commitStates(*mConvState, *convIntermediate, convStateSize);
+    commitStates(*mSsmState, *ssmIntermediate, ssmStateSize);
+    expectNear(*mConvState, acceptedStates(convStates, convStateSize), "conv state");
+    expectNear(*mSsmState, acceptedStates(ssmStates, ssmStateSize), "ssm state");
+}
+
+TEST_F(MambaKernelsTest, LruMultiTokenStepCommitsAcceptedStates)
+{
+    SizeType32 constexpr width{256};
+    std::mt19937 generator(9);
+    auto const xHost = makeValues(generator, kBatch * kStepTokens * width, -1.f, 1.f);
+    auto const gateXHost = makeValues(generator, kBatch * kStepTokens * width, -2.f, 2.f);
+    auto const gateAHost = makeValues(generator, kBatch * kStepTokens * width, -2.f, 2.f);
+    auto A = mBufferManager->copyFrom(makeValues(generator, width, -1.f, 1.f), MemoryType::kGPU);
+    auto state = mBufferManager->copyFrom(makeValues(generator, kNumSlots * width, -1.f, 1.f), MemoryType::kGPU);
+
+    auto const runLru = [&](std::vector<float> const& x, std::vector<float> const& gateX,
+                            std::vector<float> const& gateA, IBuffer& lruState, IBuffer& output, SizeType32 stepTokens,
+                            IBuffer* intermediateState)
+    {
+        auto xDevice = mBufferManager->copyFrom(x, MemoryType::kGPU);
+        auto gateXDevice = mBufferManager->copyFrom(gateX, MemoryType::kGPU);
+        auto gateADevice = mBufferManager->copyFrom(gateA, MemoryType::kGPU);
+        tk::lruParams params{};
+        params.batch = kBatch;
+        params.width = width;
+        params.A_ptr = A->data();
+        params.x_ptr = xDevice->data();
+        params.gate_x_ptr = gateXDevice->data();
+        params.gate_a_ptr = gateADevice->data();
+        params.state_ptr = lruState.data();
+        params.out_ptr = output.data();
+        params.slot_mapping_ptr = bufferCast<int32_t>(*mSlotMapping);
+        params.step_tokens = stepTokens;
+        params.intermediate_state_ptr = intermediateState ? intermediateState->data() : nullptr;
+        tk::invokeRGLRUUpdate<float>(params, mStream->get());
+        // The inputs are freed when this returns
+        mStream->synchronize();
+    };
+
+    auto singleState = copyOf(*state);
+    auto singleOutput = mBufferManager->gpu(kBatch * width, nvinfer1::DataType::kFLOAT);
+    std::vector<float> expectedOutput(kBatch * kStepTokens * width);
+    std::vector<std::vector<float>> states{toHost(*state)};
+    for (SizeType32 t = 0; t < kStepTokens; ++t)
+    {
+        runLru(tokenRows(xHost, width, t), tokenRows(gateXHost, width, t), tokenRows(gateAHost, width, t),
+            *singleState, *singleOutput, 0, nullptr);
+        setTokenRows(expectedOutput, toHost(*singleOutput), width, t);
+        states.push_back(toHost(*singleState));
+    }
+
+    auto output = mBufferManager->gpu(kBatch * kStepTokens * width, nvinfer1::DataType::kFLOAT);
+    auto intermediate = mBufferManager->gpu(kBatch * kStepTokens * width, nvinfer1::DataType::kFLOAT);
+    runLru(xHost, gateXHost, gateAHost, *state, *output, kStepTokens, intermediate.get());
+    expectNear(*output, expectedOutput, "output");
+    expectNear(*state, states.front(), "state before commit");
+
+    commitStates(*state, *intermediate, width);
+    expectNear(*state, acceptedStates(states, width), "state");
+}
+
+} // namespace
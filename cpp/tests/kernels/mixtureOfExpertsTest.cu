@@ -78,6 +78,24 @@ __global__ void initBiasToExpertIdGatedKernel(T* data, int64_t w)
     }
 }
 
+// A single rank all-to-all, the rows sent to rank 0 are copied straight back to the receive buffer
+class LoopbackAllToAllCommunicator : public MoeAllToAllCommunicator
+{
+public:
+    void allToAll(void const* send, std::vector<size_t> const& send_offsets, std::vector<size_t> const& send_sizes,
+        void* recv, std::vector<size_t> const& recv_offsets, std::vector<size_t> const& recv_sizes,
+        cudaStream_t stream) override
+    {
+        ASSERT_EQ(send_sizes.size(), 1);
+        ASSERT_EQ(send_sizes[0], recv_sizes[0]);
+        if (send_sizes[0] > 0)
+        {
+            check_cuda_error(cudaMemcpyAsync(static_cast<char*>(recv) + recv_offsets[0],
+                static_cast<char const*>(send) + send_offsets[0], send_sizes[0], cudaMemcpyDeviceToDevice, stream));
+        }
+    }
+};
+
 #ifdef ENABLE_FP8
 using SafeFP8 = __nv_fp8_e4m3;
 #else
@@ -1477,6 +1495,119 @@ PARALLEL_TEST_SUITE(ExpertParallel)
 PARALLEL_TEST_SUITE(TensorParallel)
 PARALLEL_TEST_SUITE(MixedParallel)
 
+TYPED_TEST(MixtureOfExpertsTest, AllToAllLoopback)
+{
+    // A single expert parallel rank still runs the dispatch, the expert major regrouping and the combine
+    this->mUseBias = false;
+    this->mMoERunner.all_to_all_comm_ = std::make_shared<LoopbackAllToAllCommunicator>();
+    auto test_archs = this->getAllTileConfigsToTest();
+    for (auto [gemm1, gemm2] : test_archs)
+    {
+        this->mInternalSelectedConfig1 = gemm1;
+        this->mInternalSelectedConfig2 = gemm2;
+        for (int k = 1; k <= 3; k++)
+        {
+            int64_t const hidden_size = this->DEFAULT_HIDDEN_SIZE;
+            int64_t const num_experts = 4;
+            int64_t const num_tokens = 3;
+
+            std::vector<typename TestFixture::DataType> hidden_states(hidden_size * num_tokens);
+            auto raw_unquant_input = this->populateTokens(hidden_states);
+
+            std::vector<float> probs = {
+                0.5, 0.1, 0.25, 0.15,   //
+                0.03, 0.2, 0.07, 0.7,   //
+                0.25, 0.21, 0.35, 0.19, //
+            };
+
+            std::vector<std::vector<typename TestFixture::DataType>> hidden_input = {hidden_states};
+            std::vector<std::vector<float>> router_input = {probs};
+            this->runMoEPermute(hidden_input, router_input, hidden_size, num_experts, k, {},
+                MOEParallelismConfig{1, 0, 1, 0, true});
+
+            std::vector<int> expected_experts{0, 3, 2};
+            if (k == 2)
+                expected_experts = {0, 2, 3, 1, 2, 0};
+            else if (k == 3)
+                expected_experts = {0, 2, 3, 3, 1, 2, 2, 0, 1};
+            auto selected_expert = this->getDataFromDevice(this->mSelectedExpert, num_tokens * k);
+            EXPECT_EQ(selected_expert, expected_experts);
+            this->compareFinal(selected_expert, router_input[0], raw_unquant_input);
+        }
+    }
+    this->mMoERunner.all_to_all_comm_.reset();
+}
+
+TYPED_TEST(MixtureOfExpertsTest, ExpertLoadHistogram)
+{
+    int64_t const hidden_size = this->DEFAULT_HIDDEN_SIZE;
+    int64_t const num_experts = 4;
+    int64_t const num_tokens = 3;
+    int const k = 2;
+
+    std::vector<typename TestFixture::DataType> hidden_states(hidden_size * num_tokens);
+    this->populateTokens(hidden_states);
+    std::vector<float> probs = {
+        0.5, 0.1, 0.25, 0.15,   //
+        0.03, 0.2, 0.07, 0.7,   //
+        0.25, 0.21, 0.35, 0.19, //
+    };
+    this->initBuffersPermute({hidden_states}, {probs}, hidden_size, num_experts, k, {}, MOEParallelismConfig{});
+
+    auto* histogram = this->template allocBuffer<int>(num_experts);
+    check_cuda_error(cudaMemsetAsync(histogram, 0, num_experts * sizeof(int), this->mStream->get()));
+    this->mMoERunner.expert_load_histogram_ = histogram;
+    // The counts accumulate over the runs
+    this->runMoEPermute(MOEParallelismConfig{});
+    this->runMoEPermute(MOEParallelismConfig{});
+    this->mMoERunner.expert_load_histogram_ = nullptr;
+
+    // The selected experts are {0, 2}, {3, 1} and {2, 0}
+    std::vector<int> expected{4, 2, 4, 2};
+    EXPECT_EQ(this->getDataFromDevice(histogram, num_experts), expected);
+}
+
+TYPED_TEST(MixtureOfExpertsTest, GemvSmallBatch)
+{
+    if constexpr (TestFixture::FP8)
+    {
+        GTEST_SKIP() << "FP8 experts always run the grouped GEMMs";
+    }
+    // The three tokens run as GEMVs over the selected experts, which does not write the permute map
+    this->mMoERunner.gemv_max_rows_ = 3;
+    for (auto act : {tensorrt_llm::ActivationType::Relu, tensorrt_llm::ActivationType::Swiglu,
+             tensorrt_llm::ActivationType::Geglu})
+    {
+        for (auto norm : {MOEExpertScaleNormalizationMode::NONE, MOEExpertScaleNormalizationMode::RENORMALIZE})
+        {
+            for (int k = 1; k <= 3; k++)
+            {
+                this->mActType = act;
+                this->mNormMode = norm;
+                int64_t const hidden_size = this->DEFAULT_HIDDEN_SIZE;
+                int64_t const num_experts = 4;
+                int64_t const num_tokens = 3;
+
+                std::vector<typename TestFixture::DataType> hidden_states(hidden_size * num_tokens);
+                auto raw_unquant_input = this->populateTokens(hidden_states);
+
+                std::vector<float> probs = {
+                    0.5, 0.1, 0.25, 0.15,   //
+                    0.03, 0.2, 0.07, 0.7,   //
+                    0.25, 0.21, 0.35, 0.19, //
+                };
+
+                std::vector<std::vector<typename TestFixture::DataType>> hidden_input = {hidden_states};
+                std::vector<std::vector<float>> router_input = {probs};
+                this->runMoEPermute(hidden_input, router_input, hidden_size, num_experts, k);
+
+                auto selected_expert = this->getDataFromDevice(this->mSelectedExpert, num_tokens * k);
+                this->compareFinal(selected_expert, router_input[0], raw_unquant_input);
+            }
+        }
+    }
+}
+
 TYPED_TEST(MixtureOfExpertsTest, ConfigSweep)
 {
     auto genConfigName = [](auto conf) -> std::string
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/decoderMaskedMultiheadAttention/multiBlockTuningTable.h"
+
+#include <sstream>
+
+namespace tk = tensorrt_llm::kernels;
+
+namespace
+{
+
+using Table = tk::MultiBlockTuningTable;
+
+TEST(MultiBlockTuningTableTest, Buckets)
+{
+    EXPECT_EQ(Table::getBucket(1), 0);
+    EXPECT_EQ(Table::getBucket(2), 1);
+    EXPECT_EQ(Table::getBucket(3), 2);
+    EXPECT_EQ(Table::getBucket(4096), 12);
+    EXPECT_EQ(Table::getBucket(4097), 13);
+
+    // Batch sizes 5 to 8 and kv lengths 2049 to 4096 share an entry.
+    EXPECT_TRUE(Table::makeKey(90, 32, 8, 128, 5, 2049) == Table::makeKey(90, 32, 8, 128, 8, 4096));
+    EXPECT_FALSE(Table::makeKey(90, 32, 8, 128, 8, 4096) == Table::makeKey(90, 32, 8, 128, 9, 4096));
+    EXPECT_FALSE(Table::makeKey(90, 32, 8, 128, 8, 4096) == Table::makeKey(80, 32, 8, 128, 8, 4096));
+}
+
+TEST(MultiBlockTuningTableTest, SetAndLookup)
+{
+    Table table;
+    auto const key = Table::makeKey(90, 32, 8, 128, 4, 8192);
+    EXPECT_FALSE(table.lookup(key).has_value());
+
+    table.set(key, 6);
+    EXPECT_EQ(table.lookup(key), 6);
+    EXPECT_EQ(table.lookup(Table::makeKey(90, 32, 8, 128, 3, 5000)), 6);
+    EXPECT_FALSE(table.lookup(Table::makeKey(90, 32, 8, 64, 4, 8192)).has_value());
+
+    table.set(key, 3);
+    EXPECT_EQ(table.lookup(key), 3);
+    EXPECT_EQ(table.size(), 1);
+}
+
+TEST(MultiBlockTuningTableTest, SaveAndLoad)
+{
+    Table table;
+    table.set(Table::makeKey(90, 32, 8, 128, 1, 1024), 16);
+    table.set(Table::makeKey(80, 40, 40, 128, 16, 4096), 2);
+
+    std::stringstream stream;
+    table.save(stream);
+    Table loaded;
+    ASSERT_TRUE(loaded.load(stream));
+    EXPECT_EQ(loaded.size(), 2);
+    EXPECT_EQ(loaded.lookup(Table::makeKey(90, 32, 8, 128, 1, 1024)), 16);
+    EXPECT_EQ(loaded.lookup(Table::makeKey(80, 40, 40, 128, 16, 4096)), 2);
+}
+
+TEST(MultiBlockTuningTableTest, MalformedEntry)
+{
+    Table table;
+    std::stringstream stream("# comment\n90 32 8 128 0 10 4\n90 32 8 128 1\n");
+    EXPECT_FALSE(table.load(stream));
+    EXPECT_EQ(table.size(), 0);
+
+    std::stringstream zeroSplits("90 32 8 128 0 10 0\n");
+    EXPECT_FALSE(table.load(zeroSplits));
+}
+
+} // namespace
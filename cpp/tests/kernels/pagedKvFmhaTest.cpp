@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/contextFusedMultiHeadAttention/pagedKvFmha.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class PagedKvFmhaTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    // Run a batch with a continued context chunk (sequence 0) and a full context (sequence 1) against a CPU
+    // reference.
+    void runTest(tk::ContextAttentionMaskType maskType, SizeType32 slidingWindowSize, bool hasAlibi)
+    {
+        SizeType32 constexpr numQHeads = 4;
+        SizeType32 constexpr numKvHeads = 2;
+        SizeType32 constexpr headSize = 64;
+        SizeType32 constexpr tokensPerBlock = 16;
+        SizeType32 constexpr maxBlocksPerSeq = 5;
+        SizeType32 constexpr blockSize = numKvHeads * tokensPerBlock * headSize;
+        SizeType32 constexpr headsPerKv = numQHeads / numKvHeads;
+
+        std::vector<SizeType32> const qSeqLens{20, 33};
+        std::vector<SizeType32> const kvSeqLens{70, 33};
+        auto const batchSize = static_cast<SizeType32>(qSeqLens.size());
+        std::vector<SizeType32> cuQSeqLens{0};
+        std::vector<SizeType32> cuKvSeqLens{0};
+        for (SizeType32 seq = 0; seq < batchSize; ++seq)
+        {
+            cuQSeqLens.push_back(cuQSeqLens.back() + qSeqLens[seq]);
+            cuKvSeqLens.push_back(cuKvSeqLens.back() + kvSeqLens[seq]);
+        }
+        auto const numQTokens = cuQSeqLens.back();
+
+        // K block 2 * (seq * maxBlocksPerSeq + b) and V block 2 * (seq * maxBlocksPerSeq + b) + 1.
+        auto const numPoolBlocks = 2 * batchSize * maxBlocksPerSeq;
+        std::vector<tk::KVCacheIndex> hostOffsets(batchSize * 2 * maxBlocksPerSeq, tk::KVCacheIndex{0});
+        for (SizeType32 seq = 0; seq < batchSize; ++seq)
+        {
+            for (SizeType32 bi = 0; bi < maxBlocksPerSeq; ++bi)
+            {
+                auto const block = 2 * (seq * maxBlocksPerSeq + bi);
+                hostOffsets[(seq * 2) * maxBlocksPerSeq + bi] = tk::KVCacheIndex{block};
+                hostOffsets[(seq * 2 + 1) * maxBlocksPerSeq + bi] = tk::KVCacheIndex{block + 1};
+            }
+        }
+
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> distr(-1.f, 1.f);
+        std::vector<float> pool(numPoolBlocks * blockSize);
+        std::vector<float> q(numQTokens * numQHeads * headSize);
+        for (auto& val : pool)
+        {
+            val = distr(generator);
+        }
+        for (auto& val : q)
+        {
+            val = distr(generator);
+        }
+
+        auto devicePool
+            = mBufferManager->copyFrom(pool, ITensor::makeShape({numPoolBlocks * blockSize}), MemoryType::kGPU);
+        auto deviceQ = mBufferManager->copyFrom(q, ITensor::makeShape({numQTokens * numQHeads * headSize}),
+            MemoryType::kGPU);
+        auto deviceOut
+            = mBufferManager->gpu(ITensor::makeShape({numQTokens * numQHeads * headSize}), nvinfer1::DataType::kFLOAT);
+        auto deviceOffsets = mBufferManager->gpu(
+            ITensor::makeShape({static_cast<SizeType32>(hostOffsets.size())}), nvinfer1::DataType::kINT32);
+        mBufferManager->copy(hostOffsets.data(), *deviceOffsets, MemoryType::kCPU);
+        auto deviceCuQSeqLens
+            = mBufferManager->copyFrom(cuQSeqLens, ITensor::makeShape({batchSize + 1}), MemoryType::kGPU);
+        auto deviceCuKvSeqLens
+            = mBufferManager->copyFrom(cuKvSeqLens, ITensor::makeShape({batchSize + 1}), MemoryType::kGPU);
+
+        tk::PagedKvFmhaParams params;
+        params.qPtr = deviceQ->data();
+        params.outputPtr = deviceOut->data();
+        params.pagedKvCache = tk::KVBlockArray(batchSize, maxBlocksPerSeq, tokensPerBlock,
+            numKvHeads * headSize * sizeof(float), 1024, 0, devicePool->data(), nullptr,
+            reinterpret_cast<tk::KVCacheIndex*>(deviceOffsets->data()));
+        params.cuQSeqLens = bufferCast<SizeType32>(*deviceCuQSeqLens);
+        params.cuKvSeqLens = bufferCast<SizeType32>(*deviceCuKvSeqLens);
+        params.dataType = tk::DATA_TYPE_FP32;
+        params.kvCacheDataType = tk::DATA_TYPE_FP32;
+        params.attentionMaskType = maskType;
+        params.b = batchSize;
+        params.maxQSeqLen = *std::max_element(qSeqLens.begin(), qSeqLens.end());
+        params.numQHeads = numQHeads;
+        params.numKvHeads = numKvHeads;
+        params.headSize = headSize;
+        params.slidingWindowSize = slidingWindowSize;
+        params.scaleBmm1 = 1.f / std::sqrt(static_cast<float>(headSize));
+        params.hasAlibi = hasAlibi;
+        params.alibiParams = tk::AlibiParams(numQHeads, 1.f);
+        tk::invokePagedKvFmha(params, mStream->get());
+
+        auto out = mBufferManager->copyFrom(*deviceOut, MemoryType::kCPU);
+        mStream->synchronize();
+        auto const* outData = bufferCast<float>(*out);
+
+        bool const isCausal = maskType != tk::ContextAttentionMaskType::PADDING;
+        for (SizeType32 seq = 0; seq < batchSize; ++seq)
+        {
+            auto const pastKvLen = kvSeqLens[seq] - qSeqLens[seq];
+            for (SizeType32 ti = 0; ti < qSeqLens[seq]; ++ti)
+            {
+                auto const pos = pastKvLen + ti;
+                for (SizeType32 head = 0; head < numQHeads; ++head)
+                {
+                    auto const kvHead = head / headsPerKv;
+                    auto const getRow = [&](SizeType32 token, bool isV)
+                    {
+                        auto const block = 2 * (seq * maxBlocksPerSeq + token / tokensPerBlock) + (isV ? 1 : 0);
+                        return pool.data() + block * blockSize
+                            + (kvHead * tokensPerBlock + token % tokensPerBlock) * headSize;
+                    };
+                    auto const& alibi = params.alibiParams;
+                    auto const slope = head < alibi.h_pow_2
+                        ? std::exp2((head + 1) * 2 * alibi.alibi_neg4_div_h)
+                        : std::exp2((2 * (head - alibi.h_pow_2) + 1) * alibi.alibi_neg4_div_h);
+                    auto const qOffset = ((cuQSeqLens[seq] + ti) * numQHeads + head) * headSize;
+                    std::vector<float> scores(kvSeqLens[seq], -INFINITY);
+                    float maxScore = -INFINITY;
+                    for (SizeType32 token = 0; token < kvSeqLens[seq]; ++token)
+                    {
+                        if (isCausal && (token > pos || token <= pos - slidingWindowSize))
+                        {
+                            continue;
+                        }
+                        float dot = 0.f;
+                        for (SizeType32 d = 0; d < headSize; ++d)
+                        {
+                            dot += q[qOffset + d] * getRow(token, false)[d];
+                        }
+                        scores[token] = dot * params.scaleBmm1 + (hasAlibi ? slope * (token - pos) : 0.f);
+                        maxScore = std::max(maxScore, scores[token]);
+                    }
+                    std::vector<float> ref(headSize, 0.f);
+                    float sum = 0.f;
+                    for (SizeType32 token = 0; token < kvSeqLens[seq]; ++token)
+                    {
+                        auto const p = std::exp(scores[token] - maxScore);
+                        sum += p;
+                        for (SizeType32 d = 0; d < headSize; ++d)
+                        {
+                            ref[d] += p * getRow(token, true)[d];
+                        }
+                    }
+                    for (SizeType32 d = 0; d < headSize; ++d)
+                    {
+                        ASSERT_NEAR(outData[qOffset + d], ref[d] / sum, 1e-4f)
+                            << "seq " << seq << " token " << ti << " head " << head << " dim " << d;
+                    }
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(PagedKvFmhaTest, Causal)
+{
+    runTest(tk::ContextAttentionMaskType::CAUSAL, INT_MAX, false);
+}
+
+TEST_F(PagedKvFmhaTest, SlidingWindowCausal)
+{
+    runTest(tk::ContextAttentionMaskType::SLIDING_WINDOW_CAUSAL, 24, false);
+}
+
+TEST_F(PagedKvFmhaTest, Padding)
+{
+    runTest(tk::ContextAttentionMaskType::PADDING, INT_MAX, false);
+}
+
+TEST_F(PagedKvFmhaTest, CausalAlibi)
+{
+    runTest(tk::ContextAttentionMaskType::CAUSAL, INT_MAX, true);
+}
+
+} // namespace
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/buildRelativeAttentionBiasKernel.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class RelativeAttentionBiasTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(RelativeAttentionBiasTest, PerDistanceMatchesMaterializedBias)
+{
+    SizeType32 constexpr numHeads = 3;
+    SizeType32 constexpr numBuckets = 32;
+    SizeType32 constexpr maxDistance = 128;
+    SizeType32 constexpr seqLen = 300;
+
+    std::vector<float> table(numHeads * numBuckets);
+    for (std::size_t i = 0; i < table.size(); ++i)
+    {
+        table[i] = static_cast<float>(i);
+    }
+    auto deviceTable = mBufferManager->copyFrom(table, ITensor::makeShape({numHeads * numBuckets}), MemoryType::kGPU);
+    auto deviceBias
+        = mBufferManager->gpu(ITensor::makeShape({numHeads * seqLen * seqLen}), nvinfer1::DataType::kFLOAT);
+    auto devicePerDistance
+        = mBufferManager->gpu(ITensor::makeShape({numHeads * maxDistance}), nvinfer1::DataType::kFLOAT);
+
+    tk::invokeBuildRelativeAttentionBias(bufferCast<float>(*deviceBias), bufferCast<float>(*deviceTable), numHeads,
+        seqLen, numBuckets, /*is_bidirectional=*/false, maxDistance, mStream->get());
+    tk::invokeBuildRelativeAttentionBiasPerDistance(bufferCast<float>(*devicePerDistance),
+        bufferCast<float>(*deviceTable), numHeads, numBuckets, maxDistance, mStream->get());
+
+    std::vector<float> bias(numHeads * seqLen * seqLen);
+    std::vector<float> perDistance(numHeads * maxDistance);
+    mBufferManager->copy(*deviceBias, bias.data());
+    mBufferManager->copy(*devicePerDistance, perDistance.data());
+    mStream->synchronize();
+
+    // Every causal (query, key) pair reads the bias of its distance, clamped to the last gathered one.
+    for (SizeType32 h = 0; h < numHeads; ++h)
+    {
+        for (SizeType32 q = 0; q < seqLen; ++q)
+        {
+            for (SizeType32 k = 0; k <= q; ++k)
+            {
+                auto const distance = std::min(q - k, maxDistance - 1);
+                ASSERT_EQ(bias[(h * seqLen + q) * seqLen + k], perDistance[h * maxDistance + distance])
+                    << "head " << h << " query " << q << " key " << k;
+            }
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/rotaryScalingUtils.h"
+
+#include <cmath>
+
+namespace tk = tensorrt_llm::kernels;
+
+namespace
+{
+
+TEST(RotaryScalingUtilsTest, DynamicScale)
+{
+    EXPECT_FLOAT_EQ(tk::getDynamicRotaryScale(4096, 4096, 8.f), 1.f);
+    EXPECT_FLOAT_EQ(tk::getDynamicRotaryScale(8192, 4096, 8.f), 2.f);
+    EXPECT_FLOAT_EQ(tk::getDynamicRotaryScale(65536, 4096, 8.f), 8.f);
+    EXPECT_FLOAT_EQ(tk::getDynamicRotaryScale(65536, 0, 8.f), 1.f);
+}
+
+TEST(RotaryScalingUtilsTest, YarnInvFreq)
+{
+    int constexpr rotaryDim = 128;
+    float constexpr base = 10000.f;
+    int constexpr originalMaxPositions = 4096;
+    auto const unscaled = [&](int pairIdx) { return 1.f / std::pow(base, 2 * pairIdx / float(rotaryDim)); };
+
+    // No scaling within the original context.
+    EXPECT_FLOAT_EQ(tk::getYarnInvFreq(40, rotaryDim, base, 1.f, originalMaxPositions), unscaled(40));
+    // High frequency dims are extrapolated, low frequency dims are interpolated and the ones in between are blended.
+    EXPECT_FLOAT_EQ(tk::getYarnInvFreq(10, rotaryDim, base, 4.f, originalMaxPositions), unscaled(10));
+    EXPECT_FLOAT_EQ(tk::getYarnInvFreq(60, rotaryDim, base, 4.f, originalMaxPositions), unscaled(60) / 4.f);
+    auto const blended = tk::getYarnInvFreq(33, rotaryDim, base, 4.f, originalMaxPositions);
+    EXPECT_LT(blended, unscaled(33));
+    EXPECT_GT(blended, unscaled(33) / 4.f);
+}
+
+TEST(RotaryScalingUtilsTest, YarnMscale)
+{
+    EXPECT_FLOAT_EQ(tk::getYarnMscale(1.f), 1.f);
+    EXPECT_NEAR(tk::getYarnMscale(4.f), 1.f + 0.1f * std::log(4.f), 1e-6f);
+}
+
+} // namespace
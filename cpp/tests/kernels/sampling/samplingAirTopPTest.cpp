@@ -75,7 +75,7 @@ private:
         kernelParams.skipDecode = bufferCast<bool>(*this->mSkipDecodeDevice);
         kernelParams.cumLogProbs = bufferCast<float>(*this->mCumLogProbsDevice);
         kernelParams.outputLogProbs = bufferCast<float>(*this->mOutputLogProbsDevice);
-        kernelParams.curandState = reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*this->mCurandStatesDevice));
+        kernelParams.randomState = reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*this->mRandomStatesDevice));
         kernelParams.batchSize = params.batchSize;
         kernelParams.maxBatchSize = maxBatchSize;
         kernelParams.vocabSizePadded = params.vocabSize;
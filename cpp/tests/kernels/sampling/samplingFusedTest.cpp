@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/kernels/samplingFusedKernels.h"
+#include "tests/kernels/sampling/samplingTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+using namespace tensorrt_llm::tests::kernels::sampling;
+
+namespace
+{
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+using TensorPtr = ITensor::SharedPtr;
+
+template <typename T>
+class FusedSamplingKernelTest : public testing::Test
+{
+protected:
+    static SizeType32 constexpr kBatchSize = 6;
+    static SizeType32 constexpr kMaxBatchSize = 2 * kBatchSize;
+    static SizeType32 constexpr kVocabSize = 10000;
+    static SizeType32 constexpr kVocabSizePadded = 10008;
+    static SizeType32 constexpr kMaxSeqLen = 32;
+    static SizeType32 constexpr kInputLen = 16;
+    static TokenIdType constexpr kEndId = 0;
+
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    void setup()
+    {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<float> logitDist(-4.f, 4.f);
+        std::uniform_int_distribution<TokenIdType> tokenDist(1, kVocabSize - 1);
+        auto const dataType = TRTDataType<T>::value;
+
+        mLogitsHost = BufferManager::pinned(ITensor::makeShape({kBatchSize, kVocabSizePadded}), dataType);
+        mBatchSlots = BufferManager::pinned(ITensor::makeShape({kBatchSize}), nvinfer1::DataType::kINT32);
+        mOutputIds
+            = BufferManager::pinned(ITensor::makeShape({kMaxBatchSize, kMaxSeqLen}), nvinfer1::DataType::kINT32);
+        mSeqLengths = BufferManager::pinned(ITensor::makeShape({kMaxBatchSize}), nvinfer1::DataType::kINT32);
+        mInputLengths = BufferManager::pinned(ITensor::makeShape({kMaxBatchSize}), nvinfer1::DataType::kINT32);
+        mEndIds = BufferManager::pinned(ITensor::makeShape({kMaxBatchSize}), nvinfer1::DataType::kINT32);
+        mTemperatures = BufferManager::pinned(ITensor::makeShape({kMaxBatchSize}), nvinfer1::DataType::kFLOAT);
+        mRepetitionPenalties = BufferManager::pinned(ITensor::makeShape({kMaxBatchSize}), nvinfer1::DataType::kFLOAT);
+        mPresencePenalties = BufferManager::pinned(ITensor::makeShape({kMaxBatchSize}), nvinfer1::DataType::kFLOAT);
+        mFrequencyPenalties = BufferManager::pinned(ITensor::makeShape({kMaxBatchSize}), nvinfer1::DataType::kFLOAT);
+        mCumLogProbs = BufferManager::pinned(ITensor::makeShape({kMaxBatchSize}), nvinfer1::DataType::kFLOAT);
+        mOutputLogProbs
+            = BufferManager::pinned(ITensor::makeShape({kMaxSeqLen, kMaxBatchSize}), nvinfer1::DataType::kFLOAT);
+        mOutputIdsPtrs = BufferManager::pinned(ITensor::makeShape({kMaxBatchSize}), nvinfer1::DataType::kINT64);
+
+        auto* logits = bufferCast<T>(*mLogitsHost);
+        auto* batchSlots = bufferCast<SizeType32>(*mBatchSlots);
+        auto* outputIds = bufferCast<TokenIdType>(*mOutputIds);
+        auto* outputIdsPtrs = reinterpret_cast<TokenIdType**>(bufferCast<int64_t>(*mOutputIdsPtrs));
+        for (SizeType32 bi = 0; bi < kMaxBatchSize; ++bi)
+        {
+            outputIdsPtrs[bi] = outputIds + bi * kMaxSeqLen;
+            bufferCast<SizeType32>(*mSeqLengths)[bi] = kInputLen;
+            bufferCast<SizeType32>(*mInputLengths)[bi] = kInputLen;
+            bufferCast<TokenIdType>(*mEndIds)[bi] = kEndId;
+            bufferCast<float>(*mTemperatures)[bi] = 0.5f + 0.1f * bi;
+            bufferCast<float>(*mRepetitionPenalties)[bi] = 1.f + 0.2f * bi;
+            bufferCast<float>(*mPresencePenalties)[bi] = 0.1f * bi;
+            bufferCast<float>(*mFrequencyPenalties)[bi] = 0.05f * bi;
+            bufferCast<float>(*mCumLogProbs)[bi] = 0.f;
+        }
+        for (SizeType32 bi = 0; bi < kBatchSize; ++bi)
+        {
+            auto const batchSlot = 2 * bi;
+            batchSlots[bi] = batchSlot;
+            auto* rowLogits = logits + bi * kVocabSizePadded;
+            for (SizeType32 vi = 0; vi < kVocabSizePadded; ++vi)
+            {
+                rowLogits[vi] = static_cast<T>(vi < kVocabSize ? logitDist(gen) : 0.f);
+            }
+            // Repeat the most likely tokens in the prompt, so that the penalties change the result of sampling
+            std::vector<TokenIdType> order(kVocabSize);
+            std::iota(order.begin(), order.end(), 0);
+            std::partial_sort(order.begin(), order.begin() + 4, order.end(), [rowLogits](auto a, auto b)
+                { return static_cast<float>(rowLogits[a]) > static_cast<float>(rowLogits[b]); });
+            for (SizeType32 ti = 0; ti < kInputLen; ++ti)
+            {
+                outputIds[batchSlot * kMaxSeqLen + ti] = ti < 6 ? order[ti % 3] : tokenDist(gen);
+            }
+        }
+        mLogitsDevice = mBufferManager->copyFrom(*mLogitsHost, MemoryType::kGPU);
+        mLogitsPtrs = BufferManager::pinned(ITensor::makeShape({kBatchSize}), nvinfer1::DataType::kINT64);
+        auto* logitsPtrs = reinterpret_cast<T const**>(bufferCast<int64_t>(*mLogitsPtrs));
+        for (SizeType32 bi = 0; bi < kBatchSize; ++bi)
+        {
+            logitsPtrs[bi] = bufferCast<T>(*mLogitsDevice) + bi * kVocabSizePadded;
+        }
+
+        // Count the occurrences of the prompt tokens
+        mPenaltyTableSize = tk::getPenaltyTableSize(kMaxSeqLen, kVocabSize);
+        ASSERT_GT(mPenaltyTableSize, 0);
+        mPenaltyWorkspace = mBufferManager->gpu(
+            ITensor::makeShape({kBatchSize, tk::getPenaltyWorkspaceRowSize(mPenaltyTableSize, kVocabSize)}),
+            nvinfer1::DataType::kINT32);
+        tk::InvokeBatchApplyPenaltyParams<T> penaltyParams{logitsPtrs, nullptr, nullptr,
+            bufferCast<TokenIdType>(*mPenaltyWorkspace), nullptr, nullptr, bufferCast<float>(*mRepetitionPenalties),
+            bufferCast<float>(*mPresencePenalties), bufferCast<float>(*mFrequencyPenalties), kBatchSize, 1, kMaxSeqLen,
+            kVocabSize, kVocabSizePadded, const_cast<TokenIdType const**>(outputIdsPtrs), nullptr,
+            bufferCast<SizeType32>(*mInputLengths), bufferCast<SizeType32>(*mSeqLengths), nullptr, nullptr, batchSlots,
+            1, nullptr, mStream->get()};
+        penaltyParams.penaltyTableSize = mPenaltyTableSize;
+        tk::invokeBatchUpdatePenaltyOccurrences(penaltyParams);
+
+        mRandomStates = mBufferManager->gpu(
+            ITensor::makeShape({kMaxBatchSize, sizeof(tk::RandomState)}), nvinfer1::DataType::kINT8);
+        tk::invokeRandomStateInitialize(reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*mRandomStates)),
+            batchSlots, kBatchSize, 0, mStream->get());
+        auto const workspaceSize = tk::getFusedSamplingWorkspaceSize(kBatchSize, kVocabSize);
+        mWorkspace = mBufferManager->gpu(
+            ITensor::makeShape({static_cast<SizeType32>(workspaceSize)}), nvinfer1::DataType::kINT8);
+    }
+
+    //! @returns logits of request bi after temperature and penalties, computed on the host
+    std::vector<float> computeReference(SizeType32 bi)
+    {
+        auto const batchSlot = bufferCast<SizeType32>(*mBatchSlots)[bi];
+        auto const* rowLogits = bufferCast<T>(*mLogitsHost) + bi * kVocabSizePadded;
+        auto const* prompt = bufferCast<TokenIdType>(*mOutputIds) + batchSlot * kMaxSeqLen;
+        auto const invTemperature = 1.f / (bufferCast<float>(*mTemperatures)[batchSlot] + 1e-6f);
+        auto const repetitionPenalty = bufferCast<float>(*mRepetitionPenalties)[batchSlot];
+        auto const presencePenalty = bufferCast<float>(*mPresencePenalties)[batchSlot];
+        auto const frequencyPenalty = bufferCast<float>(*mFrequencyPenalties)[batchSlot];
+
+        std::vector<SizeType32> occurrences(kVocabSize, 0);
+        for (SizeType32 ti = 0; ti < kInputLen; ++ti)
+        {
+            occurrences[prompt[ti]]++;
+        }
+        std::vector<float> ref(kVocabSize);
+        for (SizeType32 vi = 0; vi < kVocabSize; ++vi)
+        {
+            auto logit = static_cast<float>(rowLogits[vi]) * invTemperature;
+            if (occurrences[vi] > 0)
+            {
+                logit = logit < 0.f ? logit * repetitionPenalty : logit / repetitionPenalty;
+                logit -= presencePenalty + frequencyPenalty * occurrences[vi];
+            }
+            ref[vi] = logit;
+        }
+        return ref;
+    }
+
+    void runTest(SizeType32 topK, float topP, bool expectGreedy)
+    {
+        setup();
+
+        tk::FusedSamplingKernelParams<T> params;
+        params.logitsPtrs = reinterpret_cast<T const* const*>(bufferCast<int64_t>(*mLogitsPtrs));
+        params.temperatures = bufferCast<float>(*mTemperatures);
+        params.repetitionPenalties = bufferCast<float>(*mRepetitionPenalties);
+        params.presencePenalties = bufferCast<float>(*mPresencePenalties);
+        params.frequencyPenalties = bufferCast<float>(*mFrequencyPenalties);
+        params.penaltyWorkspace = bufferCast<TokenIdType>(*mPenaltyWorkspace);
+        params.penaltyTableSize = mPenaltyTableSize;
+        params.maxTopK = topK;
+        params.maxTopP = topP;
+        params.randomState = reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*mRandomStates));
+        params.outputIdsPtrs = reinterpret_cast<TokenIdType**>(bufferCast<int64_t>(*mOutputIdsPtrs));
+        params.sequenceLengths = bufferCast<SizeType32>(*mSeqLengths);
+        params.endIds = bufferCast<TokenIdType>(*mEndIds);
+        params.cumLogProbs = bufferCast<float>(*mCumLogProbs);
+        params.outputLogProbs = bufferCast<float>(*mOutputLogProbs);
+        params.batchSlots = bufferCast<SizeType32>(*mBatchSlots);
+        params.workspace = bufferCast<int8_t>(*mWorkspace);
+        params.batchSize = kBatchSize;
+        params.maxBatchSize = kMaxBatchSize;
+        params.vocabSize = kVocabSize;
+        params.vocabSizePadded = kVocabSizePadded;
+        tk::invokeFusedSampling(params, mStream->get());
+        mStream->synchronize();
+
+        auto const eps = std::is_same_v<T, half> ? 2e-2f : 1e-4f;
+        for (SizeType32 bi = 0; bi < kBatchSize; ++bi)
+        {
+            auto const batchSlot = bufferCast<SizeType32>(*mBatchSlots)[bi];
+            auto const ref = computeReference(bi);
+            auto sorted = ref;
+            std::sort(sorted.begin(), sorted.end(), std::greater<float>());
+            auto const maxLogit = sorted.front();
+            auto sumExp = 0.0;
+            for (auto const logit : ref)
+            {
+                sumExp += std::exp(logit - maxLogit);
+            }
+
+            auto const outputId = bufferCast<TokenIdType>(*mOutputIds)[batchSlot * kMaxSeqLen + kInputLen];
+            ASSERT_GE(outputId, 0);
+            ASSERT_LT(outputId, kVocabSize);
+            if (expectGreedy)
+            {
+                EXPECT_NEAR(ref[outputId], maxLogit, eps) << "request " << bi;
+            }
+            else
+            {
+                EXPECT_GE(ref[outputId], sorted[topK - 1] - eps) << "request " << bi;
+            }
+            auto const refLogProb = static_cast<float>(ref[outputId] - maxLogit - std::log(sumExp));
+            EXPECT_NEAR(bufferCast<float>(*mOutputLogProbs)[kInputLen * kMaxBatchSize + batchSlot], refLogProb, eps);
+            EXPECT_NEAR(bufferCast<float>(*mCumLogProbs)[batchSlot], refLogProb, eps);
+            auto const expectedSeqLen = outputId == kEndId ? kInputLen : kInputLen + 1;
+            EXPECT_EQ(bufferCast<SizeType32>(*mSeqLengths)[batchSlot], expectedSeqLen);
+        }
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+
+    TensorPtr mLogitsHost;
+    TensorPtr mLogitsDevice;
+    TensorPtr mLogitsPtrs;
+    TensorPtr mBatchSlots;
+    TensorPtr mOutputIds;
+    TensorPtr mOutputIdsPtrs;
+    TensorPtr mSeqLengths;
+    TensorPtr mInputLengths;
+    TensorPtr mEndIds;
+    TensorPtr mTemperatures;
+    TensorPtr mRepetitionPenalties;
+    TensorPtr mPresencePenalties;
+    TensorPtr mFrequencyPenalties;
+    TensorPtr mCumLogProbs;
+    TensorPtr mOutputLogProbs;
+    TensorPtr mPenaltyWorkspace;
+    TensorPtr mRandomStates;
+    TensorPtr mWorkspace;
+    SizeType32 mPenaltyTableSize{0};
+};
+
+TYPED_TEST_SUITE(FusedSamplingKernelTest, FloatAndHalfTypes);
+
+TYPED_TEST(FusedSamplingKernelTest, Greedy)
+{
+    this->runTest(1, 1.f, true);
+}
+
+TYPED_TEST(FusedSamplingKernelTest, SmallTopP)
+{
+    // The probability mass of the first token already exceeds P
+    this->runTest(16, 1e-4f, true);
+}
+
+TYPED_TEST(FusedSamplingKernelTest, TopK)
+{
+    this->runTest(4, 1.f, false);
+}
+
+TYPED_TEST(FusedSamplingKernelTest, MaxTopK)
+{
+    this->runTest(tk::FUSED_SAMPLING_TOP_K_MAX, 0.9f, false);
+}
+
+} // namespace
@@ -386,6 +386,7 @@ struct RepetitionPenaltyTestCase
     int32_t presencePenaltiesSize;
     int32_t frequencyPenaltiesSize;
     int32_t maxTokensPerStep{1};
+    bool sparse{false};
 
     RepetitionPenaltyTestCase& setBatchSize(int32_t bs)
     {
@@ -447,12 +448,18 @@ struct RepetitionPenaltyTestCase
         return *this;
     }
 
+    RepetitionPenaltyTestCase& setSparse(bool s)
+    {
+        sparse = s;
+        return *this;
+    }
+
     std::string toString() const
     {
         return tc::fmtstr(
-            "RepetitionPenaltyTestCase[batch=%d, vocab=%d, maxInputLength=%d, "
+            "RepetitionPenaltyTestCase[batch=%d, vocab=%d, maxInputLength=%d, sparse=%d, "
             "repetitionPenalties=%s, presencePenalties=%s, frequencyPenalties=%s]",
-            batchSize, vocabSize, maxInputLength,
+            batchSize, vocabSize, maxInputLength, sparse,
             tc::arr2str(bufferCast<float>(*repetitionPenalties), repetitionPenaltiesSize).c_str(),
             tc::arr2str(bufferCast<float>(*presencePenalties), presencePenaltiesSize).c_str(),
             tc::arr2str(bufferCast<float>(*frequencyPenalties), frequencyPenaltiesSize).c_str());
@@ -471,6 +478,7 @@ protected:
     int32_t mMaxInputLength;
     int32_t mSequenceLength;
     int32_t mMaxTokensPerStep;
+    int32_t mPenaltyTableSize;
 
     using SamplingKernelTest<T>::mBufferManager;
     using SamplingKernelTest<T>::mStream;
@@ -513,6 +521,8 @@ protected:
         mMaxInputLength = param.maxInputLength;
         mSequenceLength = 2 * mMaxInputLength; // input + output
         mMaxTokensPerStep = param.maxTokensPerStep;
+        mPenaltyTableSize = param.sparse ? tk::getPenaltyTableSize(mSequenceLength, mVocabSize) : 0;
+        ASSERT_TRUE(!param.sparse || mPenaltyTableSize > 0) << "Invalid test configuration.";
 
         mLogitsHost
             = BufferManager::pinned(ITensor::makeShape({mBatchSize, mMaxTokensPerStep, mVocabSizePadded}), dataType);
@@ -525,7 +535,9 @@ protected:
         mLogitsPtrs = BufferManager::pinned(ITensor::makeShape({mBatchSize}), ptrType);
 
         mPenaltyWorkspaceDevice = mBufferManager->gpu(
-            ITensor::makeShape({mBatchSize, mMaxTokensPerStep, mVocabSize}), nvinfer1::DataType::kINT32);
+            ITensor::makeShape(
+                {mBatchSize, mMaxTokensPerStep, tk::getPenaltyWorkspaceRowSize(mPenaltyTableSize, mVocabSize)}),
+            nvinfer1::DataType::kINT32);
 
         mTokensPerStep = BufferManager::pinned(ITensor::makeShape({mMaxBatchSize}), nvinfer1::DataType::kINT32);
 
@@ -665,6 +677,7 @@ public:
             reinterpret_cast<int32_t const**>(bufferCast<int64_t>(*mIdsPtrDevice)), nullptr,
             bufferCast<int32_t>(*mContextLengthDevice), bufferCast<int32_t>(*mSeqLengthDevice), nullptr, nullptr,
             bufferCast<int32_t>(*mBatchSlots), mMaxTokensPerStep, bufferCast<int32_t>(*mTokensPerStep), mStream->get()};
+        penaltyParams.penaltyTableSize = mPenaltyTableSize;
         tk::invokeBatchApplyPenalty(penaltyParams);
 
         auto logitsOutHost = mBufferManager->copyFrom(*mOutLogitsDevice, MemoryType::kCPU);
@@ -1050,6 +1063,36 @@ TYPED_TEST(RepetitionPenaltyTest, PenaltyTypeFullTokensPerStep)
                       .setMaxTokensPerStep(4));
 }
 
+TYPED_TEST(RepetitionPenaltyTest, PenaltyTypeFullSparse)
+{
+    int32_t batchSize = 6;
+    int32_t maxBatchSize = 2 * batchSize;
+    TensorPtr repetitionPenaltyHost
+        = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kFLOAT);
+    TensorPtr presencePenaltyHost
+        = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kFLOAT);
+    TensorPtr frequencyPenaltyHost
+        = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kFLOAT);
+    for (int32_t i = 0; i < maxBatchSize; ++i)
+    {
+        bufferCast<float>(*repetitionPenaltyHost)[i] = 0.53 + i * 0.2f;
+        bufferCast<float>(*presencePenaltyHost)[i] = 0.53 + i * 0.2f;
+        bufferCast<float>(*frequencyPenaltyHost)[i] = 0.53 + i * 0.2f;
+    }
+    this->runTest(RepetitionPenaltyTestCase()
+                      .setBatchSize(batchSize)
+                      .setVocabSize(4000)
+                      .setMaxInputLength(20)
+                      .setRepetitionPenalties(repetitionPenaltyHost)
+                      .setPresencePenalties(presencePenaltyHost)
+                      .setFrequencyPenalties(frequencyPenaltyHost)
+                      .setRepetitionPenaltiesSize(maxBatchSize)
+                      .setPresencePenaltiesSize(maxBatchSize)
+                      .setFrequencyPenaltiesSize(maxBatchSize)
+                      .setMaxTokensPerStep(4)
+                      .setSparse(true));
+}
+
 struct MinLengthPenaltyTestParams
 {
     int32_t batchSize;
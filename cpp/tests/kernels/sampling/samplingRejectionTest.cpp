@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TOP_LEVEL_DIR
+#error "Define TOP_LEVEL_DIR"
+#endif
+
+#include "tests/kernels/sampling/samplingTest.h"
+#include "tensorrt_llm/kernels/samplingRejectionKernels.h"
+
+#include <algorithm>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+using namespace tensorrt_llm::tests::kernels::sampling;
+
+namespace
+{
+
+template <typename T>
+class RejectionSamplingKernelTest : public SamplingKernelTest<T>
+{
+protected:
+    using SamplingKernelTest<T>::mStream;
+    using SamplingKernelTest<T>::mBufferManager;
+    using SamplingKernelTest<T>::mMaxSeqLen;
+
+    //! Whether the request in batchSlot was sampled, i.e. neither skipped nor finished before
+    bool isSampled(SizeType32 batchSlot) const
+    {
+        auto const* finished = reinterpret_cast<tk::FinishedState const*>(
+            bufferCast<tk::FinishedState::UnderlyingType>(*this->mFinishedHost));
+        return !bufferCast<bool>(*this->mSkipDecodeHost)[batchSlot] && !finished[batchSlot].isFinished()
+            && !finished[batchSlot].isSkipDecoding();
+    }
+
+    SizeType32 mMaxRejectionRounds{tk::RejectionSamplingKernelParams<T>::kDefaultMaxRejectionRounds};
+
+private:
+    size_t getWorkspaceSize(SamplingKernelTestParam const&) override
+    {
+        return 0;
+    }
+
+    void callTestedFunction(SamplingKernelTestParam const& params, ITensor::SharedPtr& /* workspaceDevice */) override
+    {
+        auto const maxBatchSize = 2 * params.batchSize;
+
+        tk::RejectionSamplingKernelParams<T> kernelParams;
+        kernelParams.probs = bufferCast<T>(*this->mProbsDevice);
+        kernelParams.outputIds = bufferCast<int*>(*this->mIdsPtrHost);
+        kernelParams.topKs = bufferCast<int32_t>(*this->mTopKsDevice);
+        kernelParams.topPs = bufferCast<float>(*this->mTopPsDevice);
+        kernelParams.sequenceLength = bufferCast<int32_t>(*this->mSeqLengthsDevice);
+        kernelParams.endIds = bufferCast<int32_t>(*this->mEndIdsDevice);
+        kernelParams.batchSlots = bufferCast<int32_t>(*this->mBatchSlots);
+        kernelParams.finishedInput = reinterpret_cast<tk::FinishedState*>(
+            bufferCast<tk::FinishedState::UnderlyingType>(*this->mFinishedDevice));
+        kernelParams.finishedOutput = reinterpret_cast<tk::FinishedState*>(
+            bufferCast<tk::FinishedState::UnderlyingType>(*this->mFinishedDevice));
+        kernelParams.skipDecode = bufferCast<bool>(*this->mSkipDecodeDevice);
+        kernelParams.cumLogProbs = bufferCast<float>(*this->mCumLogProbsDevice);
+        kernelParams.outputLogProbs = bufferCast<float>(*this->mOutputLogProbsDevice);
+        kernelParams.randomState = reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*this->mRandomStatesDevice));
+        kernelParams.maxRejectionRounds = mMaxRejectionRounds;
+        kernelParams.batchSize = params.batchSize;
+        kernelParams.maxBatchSize = maxBatchSize;
+        kernelParams.vocabSizePadded = params.vocabSize;
+
+        tk::invokeBatchRejectionSampling<T>(kernelParams, this->mStream->get());
+    }
+};
+
+TYPED_TEST_SUITE(RejectionSamplingKernelTest, FloatAndHalfTypes);
+
+TYPED_TEST(RejectionSamplingKernelTest, CorrectnessSmallVocab)
+{
+    this->runTest(SamplingKernelTestParam().setBatchSize(6).setVocabSize(4).setTopK(4).setTopP(0.9f));
+};
+
+TYPED_TEST(RejectionSamplingKernelTest, CorrectnessLargeVocab)
+{
+    this->runTest(SamplingKernelTestParam().setBatchSize(32).setVocabSize(51200).setTopK(63).setTopP(0.6f));
+};
+
+TYPED_TEST(RejectionSamplingKernelTest, StepAdvancesOncePerToken)
+{
+    auto const param = SamplingKernelTestParam().setBatchSize(16).setVocabSize(51200).setTopK(1024).setTopP(1.0f);
+    this->runTest(param);
+
+    auto const statesHost = this->mBufferManager->copyFrom(*this->mRandomStatesDevice, MemoryType::kCPU);
+    this->mStream->synchronize();
+    auto const* states = reinterpret_cast<tk::RandomState const*>(bufferCast<int8_t>(*statesHost));
+    auto const* batchSlots = bufferCast<int32_t>(*this->mBatchSlots);
+    for (SizeType32 bi = 0; bi < param.batchSize; ++bi)
+    {
+        auto const batchSlot = batchSlots[bi];
+        // However many rejection rounds the token took
+        EXPECT_EQ(states[batchSlot].step, this->isSampled(batchSlot) ? 1U : 0U) << "batchSlot " << batchSlot;
+    }
+}
+
+TYPED_TEST(RejectionSamplingKernelTest, FallsBackToMostLikelyToken)
+{
+    // Without any rejection round no candidate is drawn
+    this->mMaxRejectionRounds = 0;
+    auto const param = SamplingKernelTestParam().setBatchSize(16).setVocabSize(4000).setTopK(64).setTopP(1.0f);
+    this->runTest(param);
+
+    auto const outputIdsHost = this->mBufferManager->copyFrom(*this->mOutputIdsDevice, MemoryType::kCPU);
+    this->mStream->synchronize();
+    auto const* outputIds = bufferCast<int32_t>(*outputIdsHost);
+    auto const* seqLengths = bufferCast<int32_t>(*this->mSeqLengthsHost);
+    auto const* batchSlots = bufferCast<int32_t>(*this->mBatchSlots);
+    for (SizeType32 bi = 0; bi < param.batchSize; ++bi)
+    {
+        auto const batchSlot = batchSlots[bi];
+        if (!this->isSampled(batchSlot))
+        {
+            continue;
+        }
+        auto const* probs = bufferCast<TypeParam>(*this->mProbsHost) + bi * param.vocabSize;
+        auto const maxProb = static_cast<float>(*std::max_element(probs, probs + param.vocabSize,
+            [](auto const& lhs, auto const& rhs) { return static_cast<float>(lhs) < static_cast<float>(rhs); }));
+        auto const outputId = outputIds[batchSlot * this->mMaxSeqLen + seqLengths[batchSlot]];
+        EXPECT_EQ(static_cast<float>(probs[outputId]), maxProb) << "batchSlot " << batchSlot;
+    }
+}
+} // end of namespace
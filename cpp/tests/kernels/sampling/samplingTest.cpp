@@ -96,8 +96,8 @@ void SamplingKernelTest<T>::allocateBuffers(SamplingKernelTestParam const& param
 
     mExpectedCumLogProbsHost = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kFLOAT);
 
-    mCurandStatesDevice
-        = mBufferManager->gpu(ITensor::makeShape({maxBatchSize, sizeof(curandState_t)}), nvinfer1::DataType::kINT8);
+    mRandomStatesDevice
+        = mBufferManager->gpu(ITensor::makeShape({maxBatchSize, sizeof(tk::RandomState)}), nvinfer1::DataType::kINT8);
 }
 
 template <typename T>
@@ -125,8 +125,8 @@ void SamplingKernelTest<T>::setupBuffers(SamplingKernelTestParam const& param)
         }
     }
 
-    // Allocate and init curand states
-    tk::invokeCurandInitialize(reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*mCurandStatesDevice)),
+    // Allocate and init random states
+    tk::invokeRandomStateInitialize(reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*mRandomStatesDevice)),
         batchSlotsPtr, batchSize, mSeed, mStream->get());
 
     std::uniform_int_distribution<> endIdsDistr(
@@ -332,7 +332,7 @@ protected:
 
     TensorPtr mExpectedCumLogProbsHost;
 
-    TensorPtr mCurandStatesDevice;
+    TensorPtr mRandomStatesDevice;
 
     int32_t mMaxTopK;
     static constexpr int32_t mMaxSeqLen = 2048;
@@ -19,6 +19,7 @@
 
 #include "tensorrt_llm/common/tllmException.h"
 #include "tests/kernels/sampling/samplingTest.h"
+#include <algorithm>
 #include <random>
 
 namespace tc = tensorrt_llm::common;
@@ -76,7 +77,7 @@ protected:
         kernelParams.outputLogProbs = params.returnAllTopK || params.maxTokensPerStep > 1
             ? nullptr
             : bufferCast<float>(*this->mOutputLogProbsDevice);
-        kernelParams.curandState = reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*this->mCurandStatesDevice));
+        kernelParams.randomState = reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*this->mRandomStatesDevice));
         kernelParams.batchSize = params.batchSize;
         kernelParams.maxBatchSize = maxBatchSize;
         kernelParams.maxTokensPerStep = params.maxTokensPerStep;
@@ -118,6 +119,27 @@ TYPED_TEST(TopKSamplingKernelTest, CorrectnessLargeK1024)
     this->runTest(SamplingKernelTestParam().setBatchSize(16).setVocabSize(51200).setTopK(1024).setTopP(1.0f));
 };
 
+TYPED_TEST(TopKSamplingKernelTest, CorrectnessSplitRowsGreedy)
+{
+    // Few rows with a large vocabulary are spread over more blocks per row
+    this->runTest(SamplingKernelTestParam().setBatchSize(2).setVocabSize(256000).setTopK(1).setTopP(1.0f));
+};
+
+TYPED_TEST(TopKSamplingKernelTest, CorrectnessSplitRowsK63)
+{
+    this->runTest(SamplingKernelTestParam().setBatchSize(4).setVocabSize(256000).setTopK(63).setTopP(1.0f));
+};
+
+TYPED_TEST(TopKSamplingKernelTest, CorrectnessSplitRowsMaxTokensPerStep)
+{
+    this->runTest(SamplingKernelTestParam()
+                      .setBatchSize(4)
+                      .setVocabSize(131072)
+                      .setTopK(16)
+                      .setTopP(0.5f)
+                      .setMaxTokensPerStep(4));
+};
+
 TYPED_TEST(TopKSamplingKernelTest, CorrectnessTopKTopP)
 {
     this->runTest(SamplingKernelTestParam().setBatchSize(16).setVocabSize(4000).setTopK(63).setTopP(0.3f));
@@ -157,4 +179,83 @@ TYPED_TEST(TopKSamplingKernelTest, CorrectnessLogitsPtrs)
                       .setMaxTokensPerStep(4)
                       .setUseLogitsPtrs());
 };
+
+TEST(TopKSamplingKernelRandomTest, DrawPerTokenOfStep)
+{
+    // Flat logits: the token drawn for every position only depends on its random number
+    SizeType32 constexpr batchSize{8};
+    SizeType32 constexpr maxBatchSize{2 * batchSize};
+    SizeType32 constexpr maxTokensPerStep{4};
+    SizeType32 constexpr vocabSize{64};
+    SizeType32 constexpr skippedSlot{1};
+
+    auto stream = std::make_shared<CudaStream>();
+    BufferManager manager(stream);
+
+    auto logits = manager.gpu(ITensor::makeShape({batchSize, maxTokensPerStep, vocabSize}), nvinfer1::DataType::kFLOAT);
+    manager.setZero(*logits);
+    auto outputIds = manager.gpu(ITensor::makeShape({maxBatchSize, maxTokensPerStep}), nvinfer1::DataType::kINT32);
+    manager.setZero(*outputIds);
+    auto batchSlots = BufferManager::pinned(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+    auto tokensPerStep = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+    auto skipDecode = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kBOOL);
+    auto* batchSlotsPtr = bufferCast<int32_t>(*batchSlots);
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        batchSlotsPtr[bi] = 2 * bi;
+    }
+    std::fill_n(bufferCast<int32_t>(*tokensPerStep), maxBatchSize, maxTokensPerStep);
+    std::fill_n(bufferCast<bool>(*skipDecode), maxBatchSize, false);
+    bufferCast<bool>(*skipDecode)[batchSlotsPtr[skippedSlot]] = true;
+
+    auto randomStates
+        = manager.gpu(ITensor::makeShape({maxBatchSize, sizeof(tk::RandomState)}), nvinfer1::DataType::kINT8);
+    auto* randomStatesPtr = reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*randomStates));
+    tk::invokeRandomStateInitialize(randomStatesPtr, batchSlotsPtr, batchSize, 42, stream->get());
+    auto workspace = manager.gpu(
+        tk::getTopKWorkspaceSize<float>(batchSize, maxTokensPerStep, vocabSize, vocabSize), nvinfer1::DataType::kINT8);
+
+    tk::TopKSamplingKernelParams<float> kernelParams;
+    kernelParams.logProbs = bufferCast<float>(*logits);
+    kernelParams.outputIds = bufferCast<int32_t>(*outputIds);
+    kernelParams.workspace = workspace->data();
+    kernelParams.maxTopP = 1.f;
+    kernelParams.maxTopK = vocabSize;
+    kernelParams.batchSlots = batchSlotsPtr;
+    kernelParams.skipDecode = bufferCast<bool>(*skipDecode);
+    kernelParams.randomState = randomStatesPtr;
+    kernelParams.batchSize = batchSize;
+    kernelParams.maxBatchSize = maxBatchSize;
+    kernelParams.maxTokensPerStep = maxTokensPerStep;
+    kernelParams.tokensPerStep = bufferCast<int32_t>(*tokensPerStep);
+    kernelParams.maxSeqLen = maxTokensPerStep;
+    kernelParams.vocabSizePadded = vocabSize;
+    tk::invokeBatchTopKSampling(kernelParams, stream->get());
+
+    auto const outputIdsHost = manager.copyFrom(*outputIds, MemoryType::kCPU);
+    auto const randomStatesHost = manager.copyFrom(*randomStates, MemoryType::kCPU);
+    stream->synchronize();
+    auto const* outputIdsPtr = bufferCast<int32_t>(*outputIdsHost);
+    auto const* randomStatesHostPtr = reinterpret_cast<tk::RandomState const*>(bufferCast<int8_t>(*randomStatesHost));
+
+    SizeType32 numRepeatedTokens{0};
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const batchSlot = batchSlotsPtr[bi];
+        // Advanced once per step, not once per token
+        EXPECT_EQ(randomStatesHostPtr[batchSlot].step, bi == skippedSlot ? 0U : 1U) << "slot " << batchSlot;
+        if (bi == skippedSlot)
+        {
+            continue;
+        }
+        auto const* ids = outputIdsPtr + batchSlot * maxTokensPerStep;
+        for (SizeType32 ti = 1; ti < maxTokensPerStep; ++ti)
+        {
+            EXPECT_LT(ids[ti], vocabSize);
+            numRepeatedTokens += ids[ti] == ids[0];
+        }
+    }
+    // Sharing a random number, all tokens of a step would be the same
+    EXPECT_LT(numRepeatedTokens, (batchSize - 1) * (maxTokensPerStep - 1));
+}
 } // end of namespace
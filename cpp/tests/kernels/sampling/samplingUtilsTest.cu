@@ -31,13 +31,13 @@ namespace
 {
 
 __global__ void generateRandomNumber(
-    SizeType32* vals, SizeType32 const* batchSlots, curandState_t* states, SizeType32 batchSize)
+    SizeType32* vals, SizeType32 const* batchSlots, tk::RandomState* states, SizeType32 batchSize)
 {
     auto const bid = static_cast<SizeType32>(threadIdx.x);
     if (bid < batchSize)
     {
         auto const batchSlot = batchSlots[bid];
-        vals[bid] = curand(states + batchSlot);
+        vals[bid] = tk::randomBits(states + batchSlot);
     }
 }
 
@@ -45,28 +45,28 @@ class SamplingUtilsKernelTest : public SamplingKernelTest<float>
 {
 };
 
-TEST_F(SamplingUtilsKernelTest, CurandInitialize)
+TEST_F(SamplingUtilsKernelTest, RandomStateInitialize)
 {
     int32_t batchSize = 127;
 
     auto initSeedAndGenerateNumbers = [batchSize, this](uint64_t seed) -> auto
     {
-        curandState_t* curandStates;
-        cudaMalloc(&curandStates, sizeof(curandState_t) * batchSize);
-        // Initialize curand states.
+        tk::RandomState* randomStates;
+        cudaMalloc(&randomStates, sizeof(tk::RandomState) * batchSize);
+        // Initialize random states.
         auto batchSlots = getDefaultBatchSlots(batchSize, *this->mBufferManager);
         auto batchSlotsPtr = bufferCast<SizeType32>(*batchSlots);
-        tk::invokeCurandInitialize(curandStates, batchSlotsPtr, batchSize, seed, this->mStream->get());
+        tk::invokeRandomStateInitialize(randomStates, batchSlotsPtr, batchSize, seed, this->mStream->get());
         sync_check_cuda_error();
 
-        // Generate random numbers using initialized curand states.MemoryType
+        // Generate random numbers using initialized random states.MemoryType
         auto randValsDevice = this->mBufferManager->gpu(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
         generateRandomNumber<<<1, batchSize, 0, this->mStream->get()>>>(
-            bufferCast<int32_t>(*randValsDevice), batchSlotsPtr, curandStates, batchSize);
+            bufferCast<int32_t>(*randValsDevice), batchSlotsPtr, randomStates, batchSize);
         auto randValsHost = this->mBufferManager->copyFrom(*randValsDevice, MemoryType::kCPU);
         this->mStream->synchronize();
 
-        cudaFree(curandStates);
+        cudaFree(randomStates);
         return std::move(randValsHost);
     };
 
@@ -93,12 +93,40 @@ TEST_F(SamplingUtilsKernelTest, CurandInitialize)
     }
 }
 
-TEST_F(SamplingUtilsKernelTest, CurandBatchInitialize)
+TEST_F(SamplingUtilsKernelTest, PhiloxKnownAnswers)
+{
+    // Known answer vectors of the Random123 reference implementation of Philox4x32-10
+    auto const expectBlock = [](uint4 counter, uint2 key, uint4 expected)
+    {
+        auto const block = tk::philox4x32(counter, key);
+        EXPECT_EQ(block.x, expected.x);
+        EXPECT_EQ(block.y, expected.y);
+        EXPECT_EQ(block.z, expected.z);
+        EXPECT_EQ(block.w, expected.w);
+    };
+    expectBlock(make_uint4(0, 0, 0, 0), make_uint2(0, 0), make_uint4(0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8));
+    expectBlock(make_uint4(0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344), make_uint2(0xa4093822, 0x299f31d0),
+        make_uint4(0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1));
+
+    // Drawing advances the step, the positions of a step are independent of each other
+    tk::RandomState state{42, 0};
+    auto const first = tk::randomBits(state, 0);
+    EXPECT_NE(first, tk::randomBits(state, 1));
+    EXPECT_EQ(first, tk::randomBits(&state));
+    EXPECT_EQ(state.step, 1);
+    EXPECT_NE(first, tk::randomBits(state, 0));
+
+    auto const uniform = tk::randomUniform(state, 3);
+    EXPECT_GT(uniform, 0.F);
+    EXPECT_LE(uniform, 1.F);
+}
+
+TEST_F(SamplingUtilsKernelTest, RandomStateBatchInitialize)
 {
     SizeType32 batchSize = 127;
 
-    curandState_t* curandStates;
-    cudaMalloc(&curandStates, sizeof(curandState_t) * 2 * batchSize);
+    tk::RandomState* randomStates;
+    cudaMalloc(&randomStates, sizeof(tk::RandomState) * 2 * batchSize);
 
     auto randomSeedsHost = mBufferManager->pinnedPool(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT64);
     auto randomSeedsHostPtr = bufferCast<int64_t>(*randomSeedsHost);
@@ -117,15 +145,15 @@ TEST_F(SamplingUtilsKernelTest, CurandBatchInitialize)
         batchSlotsPtr[bi] = 2 * bi;
     }
 
-    // Initialize curand states.
-    tk::invokeCurandBatchInitialize(curandStates, batchSlotsPtr, batchSize,
+    // Initialize random states.
+    tk::invokeRandomStateBatchInitialize(randomStates, batchSlotsPtr, batchSize,
         reinterpret_cast<uint64_t*>(bufferCast<int64_t>(*randomSeedsDevice)), mStream->get());
     sync_check_cuda_error();
 
-    // Generate random numbers using initialized curand states.
+    // Generate random numbers using initialized random states.
     auto randValsDevice = mBufferManager->gpu(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
     generateRandomNumber<<<1, batchSize, 0, this->mStream->get()>>>(
-        bufferCast<SizeType32>(*randValsDevice), batchSlotsPtr, curandStates, batchSize);
+        bufferCast<SizeType32>(*randValsDevice), batchSlotsPtr, randomStates, batchSize);
     auto const randValsHost = mBufferManager->copyFrom(*randValsDevice, MemoryType::kCPU);
     this->mStream->synchronize();
 
@@ -141,7 +169,7 @@ TEST_F(SamplingUtilsKernelTest, CurandBatchInitialize)
         }
     }
 
-    cudaFree(curandStates);
+    cudaFree(randomStates);
     sync_check_cuda_error();
 }
 
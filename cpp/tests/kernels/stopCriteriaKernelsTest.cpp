@@ -22,6 +22,7 @@
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/kernels/decodingCommon.h"
 #include "tensorrt_llm/kernels/stopCriteriaKernels.h"
+#include "tensorrt_llm/kernels/wordsAutomaton.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include <algorithm>
 #include <curand_kernel.h>
@@ -389,18 +390,53 @@ public:
             maxStopWordsLen = std::max(maxStopWordsLen, stopWordsLen);
         }
 
-        initData(0, stopWords, maxStopWordsLen, batchSize, beamWidth, tokensPerStep);
+        for (bool const useAutomaton : {false, true})
+        {
+            initData(0, stopWords, maxStopWordsLen, batchSize, beamWidth, tokensPerStep);
 
-        auto numNewTokens = tokensPerStep.size() ? bufferCast<SizeType32>(*mTokensPerStep) : nullptr;
+            auto numNewTokens = tokensPerStep.size() ? bufferCast<SizeType32>(*mTokensPerStep) : nullptr;
+            auto outputIdsPtr = bufferCast<TokenIdType const*>(*mOutputIdsPtr);
+            auto parentIdsPtr = bufferCast<TokenIdType const*>(*mParentIdsPtr);
+            auto finishedPtr
+                = reinterpret_cast<tk::FinishedState*>(bufferCast<tk::FinishedState::UnderlyingType>(*mFinished));
 
-        tk::invokeStopWordsCriterion(bufferCast<TokenIdType const*>(*mOutputIdsPtr),
-            bufferCast<TokenIdType const*>(*mParentIdsPtr), bufferCast<TokenIdType const*>(*mStopWordsPtr),
-            reinterpret_cast<tk::FinishedState*>(bufferCast<tk::FinishedState::UnderlyingType>(*mFinished)),
-            bufferCast<SizeType32>(*mSequenceLengths), bufferCast<SizeType32>(*mBatchSlots),
-            bufferCast<SizeType32>(*mStopWordsLen), numNewTokens, maxStopWordsLen, batchSize, beamWidth, mMaxSeqLen,
-            mStream->get());
+            if (useAutomaton)
+            {
+                auto const maxBatchSize = static_cast<SizeType32>(mStopWordsLen->getSize());
+                auto const automatonSize = static_cast<SizeType32>(tk::getWordsAutomatonSize(maxStopWordsLen));
+                auto const automata = mBufferManager->gpu(
+                    ITensor::makeShape({maxBatchSize, automatonSize}), nvinfer1::DataType::kINT32);
+                auto const states
+                    = mBufferManager->gpu(ITensor::makeShape({maxBatchSize, beamWidth}), nvinfer1::DataType::kINT32);
+                auto const positions
+                    = mBufferManager->gpu(ITensor::makeShape({maxBatchSize, beamWidth}), nvinfer1::DataType::kINT32);
+                tk::WordsAutomataParams params;
+                params.automata = bufferCast<SizeType32>(*automata);
+                params.states = bufferCast<SizeType32>(*states);
+                params.positions = bufferCast<SizeType32>(*positions);
+                params.capacity = maxStopWordsLen;
+
+                tk::invokeBuildWordsAutomata(params, bufferCast<TokenIdType const*>(*mStopWordsPtr),
+                    bufferCast<SizeType32>(*mStopWordsLen), bufferCast<SizeType32>(*mBatchSlots), batchSize,
+                    outputIdsPtr, parentIdsPtr, bufferCast<SizeType32>(*mSequenceLengths), numNewTokens,
+                    /* defaultNumNewTokens */ 1, beamWidth, mMaxSeqLen, mStream->get());
+                tk::invokeStopWordsAutomatonCriterion(params, outputIdsPtr, parentIdsPtr, finishedPtr,
+                    bufferCast<SizeType32>(*mSequenceLengths), bufferCast<SizeType32>(*mBatchSlots),
+                    bufferCast<SizeType32>(*mStopWordsLen), numNewTokens, batchSize, beamWidth, mMaxSeqLen,
+                    mStream->get());
+            }
+            else
+            {
+                tk::invokeStopWordsCriterion(outputIdsPtr, parentIdsPtr,
+                    bufferCast<TokenIdType const*>(*mStopWordsPtr), finishedPtr,
+                    bufferCast<SizeType32>(*mSequenceLengths), bufferCast<SizeType32>(*mBatchSlots),
+                    bufferCast<SizeType32>(*mStopWordsLen), numNewTokens, maxStopWordsLen, batchSize, beamWidth,
+                    mMaxSeqLen, mStream->get());
+            }
 
-        verifyStopWordsStopCriteriaResults(0, stopWords, maxStopWordsLen, batchSize, beamWidth, tokensPerStep.size());
+            verifyStopWordsStopCriteriaResults(
+                0, stopWords, maxStopWordsLen, batchSize, beamWidth, tokensPerStep.size());
+        }
     }
 
     void runMaxLengthCriteriaTest(SizeType32 seed, SizeType32 batchSize, SizeType32 beamWidth)
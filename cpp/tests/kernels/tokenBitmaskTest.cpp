@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/tokenBitmask.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <cmath>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class TokenBitmaskTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(TokenBitmaskTest, MasksDisallowedTokens)
+{
+    SizeType32 constexpr batchSize = 2;
+    SizeType32 constexpr maxBatchSize = 3;
+    SizeType32 constexpr beamWidth = 2;
+    SizeType32 constexpr vocabSize = 1000;
+    SizeType32 constexpr vocabSizePadded = 1024;
+    auto const bitmaskSize = tk::getTokenBitmaskSize(vocabSize);
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<std::uint32_t> wordDistr;
+    auto bitmaskHost
+        = BufferManager::pinned(ITensor::makeShape({maxBatchSize, bitmaskSize}), nvinfer1::DataType::kINT32);
+    auto* bitmaskData = reinterpret_cast<std::uint32_t*>(bufferCast<std::int32_t>(*bitmaskHost));
+    for (SizeType32 i = 0; i < maxBatchSize * bitmaskSize; ++i)
+    {
+        bitmaskData[i] = wordDistr(generator);
+    }
+    // Fully allowed words take the early exit
+    bitmaskData[2 * bitmaskSize] = 0xffffffffu;
+
+    auto logitsHost = BufferManager::pinned(
+        ITensor::makeShape({batchSize, beamWidth, vocabSizePadded}), nvinfer1::DataType::kFLOAT);
+    std::fill_n(bufferCast<float>(*logitsHost), logitsHost->getSize(), 1.f);
+    auto logits = mBufferManager->copyFrom(*logitsHost, MemoryType::kGPU);
+
+    std::vector<SizeType32> const batchSlots{2, 0};
+    auto batchSlotsHost = BufferManager::pinned(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+    std::copy(batchSlots.begin(), batchSlots.end(), bufferCast<SizeType32>(*batchSlotsHost));
+    auto logitsPtrsHost = BufferManager::pinned(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT64);
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        bufferCast<int64_t>(*logitsPtrsHost)[bi]
+            = reinterpret_cast<int64_t>(bufferCast<float>(*logits) + bi * beamWidth * vocabSizePadded);
+    }
+
+    auto bitmask = mBufferManager->copyFrom(*bitmaskHost, MemoryType::kGPU);
+    auto batchSlotsDevice = mBufferManager->copyFrom(*batchSlotsHost, MemoryType::kGPU);
+    auto logitsPtrs = mBufferManager->copyFrom(*logitsPtrsHost, MemoryType::kGPU);
+    tk::invokeApplyTokenBitmask(reinterpret_cast<float* const*>(bufferCast<int64_t>(*logitsPtrs)),
+        bufferCast<std::int32_t>(*bitmask), bufferCast<SizeType32>(*batchSlotsDevice), batchSize, beamWidth, vocabSize,
+        vocabSizePadded, mStream->get());
+
+    auto outputHost = mBufferManager->copyFrom(*logits, MemoryType::kCPU);
+    mStream->synchronize();
+
+    auto const* output = bufferCast<float>(*outputHost);
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const* mask = bitmaskData + batchSlots[bi] * bitmaskSize;
+        for (SizeType32 beam = 0; beam < beamWidth; ++beam)
+        {
+            auto const* row = output + (bi * beamWidth + beam) * vocabSizePadded;
+            for (SizeType32 vi = 0; vi < vocabSizePadded; ++vi)
+            {
+                bool const allowed = vi < vocabSize && ((mask[vi / 32] >> (vi % 32)) & 1u);
+                if (allowed)
+                {
+                    EXPECT_EQ(row[vi], 1.f) << "batch " << bi << " beam " << beam << " token " << vi;
+                }
+                else
+                {
+                    EXPECT_TRUE(std::isinf(row[vi]) && row[vi] < 0)
+                        << "batch " << bi << " beam " << beam << " token " << vi;
+                }
+            }
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/kernels/topLogProbsKernels.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+namespace tk = tensorrt_llm::kernels;
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class TopLogProbsKernelTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<CudaStream>();
+        mBufferManager = std::make_shared<BufferManager>(mStream);
+    }
+
+    std::shared_ptr<CudaStream> mStream;
+    std::shared_ptr<BufferManager> mBufferManager;
+};
+
+TEST_F(TopLogProbsKernelTest, MatchesHostReference)
+{
+    SizeType32 constexpr batchSize = 3;
+    SizeType32 constexpr maxBatchSize = 4;
+    SizeType32 constexpr vocabSize = 32000;
+    SizeType32 constexpr vocabSizePadded = 32064;
+    SizeType32 constexpr maxNumTopLogProbs = 5;
+
+    std::mt19937 generator(42);
+    std::normal_distribution<float> distr(0.f, 4.f);
+    auto logitsHost
+        = BufferManager::pinned(ITensor::makeShape({batchSize, vocabSizePadded}), nvinfer1::DataType::kFLOAT);
+    auto* logitsData = bufferCast<float>(*logitsHost);
+    for (SizeType32 i = 0; i < batchSize * vocabSizePadded; ++i)
+    {
+        // Padding must never be selected
+        logitsData[i] = i % vocabSizePadded < vocabSize ? distr(generator) : 1e4f;
+    }
+    // A tie, resolved by the smaller id
+    logitsData[10] = 100.f;
+    logitsData[20] = 100.f;
+
+    auto batchSlotsHost = BufferManager::pinned(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+    std::vector<SizeType32> const batchSlots{2, 0, 3};
+    std::copy(batchSlots.begin(), batchSlots.end(), bufferCast<SizeType32>(*batchSlotsHost));
+    auto numTopHost = BufferManager::pinned(ITensor::makeShape({maxBatchSize}), nvinfer1::DataType::kINT32);
+    std::vector<SizeType32> const numTop{3, 0, 5, 1};
+    std::copy(numTop.begin(), numTop.end(), bufferCast<SizeType32>(*numTopHost));
+
+    auto logits = mBufferManager->copyFrom(*logitsHost, MemoryType::kGPU);
+    auto batchSlotsDevice = mBufferManager->copyFrom(*batchSlotsHost, MemoryType::kGPU);
+    auto numTopDevice = mBufferManager->copyFrom(*numTopHost, MemoryType::kGPU);
+    auto outputIds
+        = mBufferManager->gpu(ITensor::makeShape({maxBatchSize, maxNumTopLogProbs}), nvinfer1::DataType::kINT32);
+    auto outputLogProbs
+        = mBufferManager->gpu(ITensor::makeShape({maxBatchSize, maxNumTopLogProbs}), nvinfer1::DataType::kFLOAT);
+
+    tk::TopLogProbsKernelParams<float> params;
+    params.logits = bufferCast<float>(*logits);
+    params.batchSlots = bufferCast<SizeType32>(*batchSlotsDevice);
+    params.numTopLogProbs = bufferCast<SizeType32>(*numTopDevice);
+    params.outputIds = bufferCast<TokenIdType>(*outputIds);
+    params.outputLogProbs = bufferCast<float>(*outputLogProbs);
+    params.batchSize = batchSize;
+    params.maxBatchSize = maxBatchSize;
+    params.vocabSize = vocabSize;
+    params.vocabSizePadded = vocabSizePadded;
+    params.maxNumTopLogProbs = maxNumTopLogProbs;
+    tk::invokeTopLogProbs(params, mStream->get());
+
+    auto idsHost = mBufferManager->copyFrom(*outputIds, MemoryType::kCPU);
+    auto logProbsHost = mBufferManager->copyFrom(*outputLogProbs, MemoryType::kCPU);
+    mStream->synchronize();
+
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const* row = logitsData + bi * vocabSizePadded;
+        auto const maxLogit = *std::max_element(row, row + vocabSize);
+        double sum{0.0};
+        for (SizeType32 vi = 0; vi < vocabSize; ++vi)
+        {
+            sum += std::exp(row[vi] - maxLogit);
+        }
+        auto const logSum = maxLogit + std::log(sum);
+
+        std::vector<SizeType32> order(vocabSize);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [row](SizeType32 a, SizeType32 b) { return row[a] > row[b]; });
+
+        auto const slot = batchSlots[bi];
+        auto const* ids = bufferCast<TokenIdType>(*idsHost) + slot * maxNumTopLogProbs;
+        auto const* logProbs = bufferCast<float>(*logProbsHost) + slot * maxNumTopLogProbs;
+        for (SizeType32 ki = 0; ki < maxNumTopLogProbs; ++ki)
+        {
+            if (ki < numTop[slot])
+            {
+                EXPECT_EQ(ids[ki], order[ki]) << "batch " << bi << " rank " << ki;
+                EXPECT_NEAR(logProbs[ki], row[order[ki]] - logSum, 1e-3f) << "batch " << bi << " rank " << ki;
+            }
+            else
+            {
+                EXPECT_EQ(ids[ki], -1) << "batch " << bi << " rank " << ki;
+            }
+        }
+    }
+    EXPECT_EQ(bufferCast<TokenIdType>(*idsHost)[2 * maxNumTopLogProbs], 10);
+    EXPECT_EQ(bufferCast<TokenIdType>(*idsHost)[2 * maxNumTopLogProbs + 1], 20);
+}
+
+} // namespace
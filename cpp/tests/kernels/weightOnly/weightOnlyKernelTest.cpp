@@ -147,11 +147,12 @@ struct cutlassTypeMapper
 };
 
 #define CUTLASS_TYPE_MAPPER_REGISTRY(                                                                                  \
-    CudaKernelType, KernelInfoStr, CutlassAType, CutlassWType, WElemBits, CutlassQuantOp)                              \
+    CudaKernelType, KernelInfoStr, CutlassAType, CutlassScaleType, CutlassWType, WElemBits, CutlassQuantOp)            \
     template <>                                                                                                        \
     struct cutlassTypeMapper<CudaKernelType>                                                                           \
     {                                                                                                                  \
         using AType = CutlassAType;                                                                                    \
+        using ScaleType = CutlassScaleType;                                                                            \
         using WType = CutlassWType;                                                                                    \
         static constexpr cutlass::WeightOnlyQuantOp QuantOp = CutlassQuantOp;                                          \
         static constexpr int WSizeInBits = WElemBits;                                                                  \
@@ -164,18 +165,23 @@ struct cutlassTypeMapper
             return ss.str();                                                                                           \
         }                                                                                                              \
     };
-CUTLASS_TYPE_MAPPER_REGISTRY(wo::KernelType::FP16Int4Groupwise, "FP16Int4Groupwise", half, cutlass::uint4b_t, 4,
+CUTLASS_TYPE_MAPPER_REGISTRY(wo::KernelType::FP16Int4Groupwise, "FP16Int4Groupwise", half, half, cutlass::uint4b_t, 4,
     cutlass::WeightOnlyQuantOp::FINEGRAINED_SCALE_AND_ZEROS);
-CUTLASS_TYPE_MAPPER_REGISTRY(wo::KernelType::BF16Int4Groupwise, "BF16Int4Groupwise", __nv_bfloat16, cutlass::uint4b_t,
-    4, cutlass::WeightOnlyQuantOp::FINEGRAINED_SCALE_AND_ZEROS);
-CUTLASS_TYPE_MAPPER_REGISTRY(wo::KernelType::FP16Int8PerChannel, "FP16Int8PerChannel", half, uint8_t, 8,
+CUTLASS_TYPE_MAPPER_REGISTRY(wo::KernelType::BF16Int4Groupwise, "BF16Int4Groupwise", __nv_bfloat16, __nv_bfloat16,
+    cutlass::uint4b_t, 4, cutlass::WeightOnlyQuantOp::FINEGRAINED_SCALE_AND_ZEROS);
+CUTLASS_TYPE_MAPPER_REGISTRY(wo::KernelType::FP16Int8PerChannel, "FP16Int8PerChannel", half, half, uint8_t, 8,
     cutlass::WeightOnlyQuantOp::PER_COLUMN_SCALE_ONLY);
-CUTLASS_TYPE_MAPPER_REGISTRY(wo::KernelType::BF16Int8PerChannel, "BF16Int8PerChannel", __nv_bfloat16, uint8_t, 8,
+CUTLASS_TYPE_MAPPER_REGISTRY(wo::KernelType::BF16Int8PerChannel, "BF16Int8PerChannel", __nv_bfloat16, __nv_bfloat16,
+    uint8_t, 8, cutlass::WeightOnlyQuantOp::PER_COLUMN_SCALE_ONLY);
+CUTLASS_TYPE_MAPPER_REGISTRY(wo::KernelType::FP16Int4PerChannel, "FP16Int4PerChannel", half, half, cutlass::uint4b_t, 4,
     cutlass::WeightOnlyQuantOp::PER_COLUMN_SCALE_ONLY);
-CUTLASS_TYPE_MAPPER_REGISTRY(wo::KernelType::FP16Int4PerChannel, "FP16Int4PerChannel", half, cutlass::uint4b_t, 4,
-    cutlass::WeightOnlyQuantOp::PER_COLUMN_SCALE_ONLY);
-CUTLASS_TYPE_MAPPER_REGISTRY(wo::KernelType::BF16Int4PerChannel, "BF16Int4PerChannel", __nv_bfloat16, cutlass::uint4b_t,
-    4, cutlass::WeightOnlyQuantOp::PER_COLUMN_SCALE_ONLY);
+CUTLASS_TYPE_MAPPER_REGISTRY(wo::KernelType::BF16Int4PerChannel, "BF16Int4PerChannel", __nv_bfloat16, __nv_bfloat16,
+    cutlass::uint4b_t, 4, cutlass::WeightOnlyQuantOp::PER_COLUMN_SCALE_ONLY);
+#ifdef ENABLE_FP8
+// W4A8: the activations are already quantized, the reference is the e4m3 x int4 CUTLASS GEMM.
+CUTLASS_TYPE_MAPPER_REGISTRY(wo::KernelType::FP8Int4Groupwise, "FP8Int4Groupwise", __nv_fp8_e4m3, half,
+    cutlass::uint4b_t, 4, cutlass::WeightOnlyQuantOp::FINEGRAINED_SCALE_AND_ZEROS);
+#endif
 
 float run_cuda_kernel(wo::Params& params, int warmup, int iter)
 {
@@ -212,12 +218,16 @@ void exec_cutlass_kernel(
     using AType = typename cutlassTypeMapper<KT>::AType;
     static constexpr cutlass::WeightOnlyQuantOp QuantOp = cutlassTypeMapper<KT>::QuantOp;
     void* act = params.act;
-    if (params.act_scale)
+    // The fp8 activations of W4A8 are scaled before they are quantized.
+    if constexpr (std::is_same_v<AType, typename cutlassTypeMapper<KT>::ScaleType>)
     {
-        tensorrt_llm::kernels::apply_per_channel_scale_kernel_launcher<AType, AType>(
-            reinterpret_cast<AType*>(scaled_act), reinterpret_cast<AType const*>(params.act),
-            reinterpret_cast<AType const*>(params.act_scale), params.m, params.k, stream);
-        act = scaled_act;
+        if (params.act_scale)
+        {
+            tensorrt_llm::kernels::apply_per_channel_scale_kernel_launcher<AType, AType>(
+                reinterpret_cast<AType*>(scaled_act), reinterpret_cast<AType const*>(params.act),
+                reinterpret_cast<AType const*>(params.act_scale), params.m, params.k, stream);
+            act = scaled_act;
+        }
     }
     if constexpr (QuantOp == cutlass::WeightOnlyQuantOp::PER_COLUMN_SCALE_ONLY)
     {
@@ -226,8 +236,8 @@ void exec_cutlass_kernel(
     }
     else if (QuantOp == cutlass::WeightOnlyQuantOp::FINEGRAINED_SCALE_AND_ZEROS)
     {
-        runner.gemm(act, params.weight, params.scales, params.zeros, params.bias, params.out, params.m, params.n,
-            params.k, params.groupsize, config, ws, ws_size, stream);
+        runner.gemm(act, params.weight, params.scales, params.zeros, params.bias, params.alpha, params.out, params.m,
+            params.n, params.k, params.groupsize, config, ws, ws_size, stream);
     }
 }
 
@@ -238,10 +248,11 @@ float run_cutlass_kernel(wo::Params& params, int warmup, int iter)
     simple_assert(KT == params.type);
     simple_assert(wo::is_supported(arch, params.type));
     using AType = typename cutlassTypeMapper<KT>::AType;
+    using ScaleType = typename cutlassTypeMapper<KT>::ScaleType;
     using WType = typename cutlassTypeMapper<KT>::WType;
     CudaBuffer scaled_act(params.m * params.k * sizeof(AType));
     auto runner = std::make_shared<tensorrt_llm::kernels::cutlass_kernels::CutlassFpAIntBGemmRunner<AType, WType,
-        cutlassTypeMapper<KT>::QuantOp>>();
+        cutlassTypeMapper<KT>::QuantOp, ScaleType, ScaleType, ScaleType>>();
     auto& gemm = *runner;
     cudaStream_t s;
     cudaStreamCreate(&s);
@@ -302,7 +313,7 @@ template <wo::KernelType KT>
 bool benchmark_and_verify(int m, int n, int k, int groupsize, int warmup, int iter)
 {
     std::srand(20240123);
-    simple_assert(m <= 4);
+    simple_assert(m <= wo::kMaxCudaKernelM);
     if constexpr (cutlassTypeMapper<KT>::QuantOp == cutlass::WeightOnlyQuantOp::PER_COLUMN_SCALE_ONLY)
     {
         simple_assert(groupsize == 0);
@@ -312,23 +323,28 @@ bool benchmark_and_verify(int m, int n, int k, int groupsize, int warmup, int it
         simple_assert(groupsize == 64 || groupsize == 128);
     }
     using AType = typename cutlassTypeMapper<KT>::AType;
+    using ScaleType = typename cutlassTypeMapper<KT>::ScaleType;
     using WType = typename cutlassTypeMapper<KT>::WType;
     static constexpr int ASizeInBits = sizeof(AType) * 8;
+    static constexpr int ScaleSizeInBits = sizeof(ScaleType) * 8;
     static constexpr int WSizeInBits = cutlassTypeMapper<KT>::WSizeInBits;
+    // The fp8 activations come pre-scaled, the kernels only apply alpha, in advance as the W4A8 plugin does.
+    static constexpr bool IsFp8Act = !std::is_same_v<AType, ScaleType>;
     int gs_factor = groupsize == 0 ? 1 : groupsize;
     printf("Kernel %s\n", cutlassTypeMapper<KT>::str(m, n, k, groupsize).c_str());
 
     CudaBuffer d_act(m * k * ASizeInBits / 8);
-    CudaBuffer d_act_scale(k * ASizeInBits / 8);
+    CudaBuffer d_act_scale(k * ScaleSizeInBits / 8);
     CudaBuffer d_weight(k * n * WSizeInBits / 8);
-    CudaBuffer d_scales(n * k / gs_factor * ASizeInBits / 8);
-    CudaBuffer d_zeros(n * k / gs_factor * ASizeInBits / 8);
-    CudaBuffer d_bias(n * ASizeInBits / 8);
-    CudaBuffer d_out(m * n * ASizeInBits / 8);
-    std::vector<AType> h_act(m * k), h_act_scale(k);
+    CudaBuffer d_scales(n * k / gs_factor * ScaleSizeInBits / 8);
+    CudaBuffer d_zeros(n * k / gs_factor * ScaleSizeInBits / 8);
+    CudaBuffer d_bias(n * ScaleSizeInBits / 8);
+    CudaBuffer d_out(m * n * ScaleSizeInBits / 8);
+    std::vector<AType> h_act(m * k);
+    std::vector<ScaleType> h_act_scale(k);
     std::vector<uint8_t> h_weight(k * n);
-    std::vector<AType> h_scales(n * k), h_zeros(n * k), h_bias(n);
-    std::vector<AType> h_out1(m * n), h_out2(m * n);
+    std::vector<ScaleType> h_scales(n * k), h_zeros(n * k), h_bias(n);
+    std::vector<ScaleType> h_out1(m * n), h_out2(m * n);
 
     random_fill(h_act, -1.f, 1.f);
     random_fill(h_act_scale, -1.f, 1.f);
@@ -356,17 +372,18 @@ bool benchmark_and_verify(int m, int n, int k, int groupsize, int warmup, int it
     {
         p_zeros = d_zeros.data();
         p_bias = d_bias.data();
-        p_act_scale = d_act_scale.data();
+        p_act_scale = IsFp8Act ? nullptr : d_act_scale.data();
     }
-    wo::Params params(d_act.data(), p_act_scale, d_weight.data(), d_scales.data(), p_zeros, p_bias, d_out.data(), 1.f,
-        m, n, k, groupsize, KT);
+    float const alpha = IsFp8Act ? 0.5f : 1.f;
+    wo::Params params(d_act.data(), p_act_scale, d_weight.data(), d_scales.data(), p_zeros, p_bias, d_out.data(), alpha,
+        m, n, k, groupsize, KT, IsFp8Act);
     float time1, time2;
     time1 = run_cuda_kernel(params, warmup, iter);
     d_out.copy_to(h_out1.data());
     time2 = run_cutlass_kernel<KT>(params, warmup, iter);
     d_out.copy_to(h_out2.data());
     float quant_scale = 1.f / (1 << (WSizeInBits - 1));
-    bool pass = compare<AType>(h_out1.data(), h_out2.data(), m * n, quant_scale);
+    bool pass = compare<ScaleType>(h_out1.data(), h_out2.data(), m * n, quant_scale);
     printf(
         "cuda kernel cost time %.6f, cutlass kernel cost time %.6f, cuda speedup %.3f\n", time1, time2, time2 / time1);
     return pass;
@@ -377,7 +394,7 @@ TEST(Kernel, WeightOnly)
     int const arch = tensorrt_llm::common::getSMVersion();
     bool pass;
     int warmup = 10, iter = 30;
-    std::vector<int> ms{1, 2, 3, 4};
+    std::vector<int> ms{1, 2, 3, 4, 8, 13, 32};
     std::vector<int> ns{2048, 4096};
     std::vector<int> ks{2048, 4096};
     for (auto m : ms)
@@ -408,6 +425,15 @@ TEST(Kernel, WeightOnly)
                         pass = benchmark_and_verify<wo::KernelType::BF16Int4PerChannel>(m, n, k, 0, warmup, iter);
                         EXPECT_TRUE(pass);
                     }
+#endif
+#if defined(ENABLE_FP8)
+                    if (arch >= 89)
+                    {
+                        pass = benchmark_and_verify<wo::KernelType::FP8Int4Groupwise>(m, n, k, 64, warmup, iter);
+                        EXPECT_TRUE(pass);
+                        pass = benchmark_and_verify<wo::KernelType::FP8Int4Groupwise>(m, n, k, 128, warmup, iter);
+                        EXPECT_TRUE(pass);
+                    }
 #endif
                 }
             }
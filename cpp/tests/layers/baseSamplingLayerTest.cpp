@@ -61,8 +61,8 @@ void BaseSamplingLayerTest<T>::setup(uint64_t seed, TestSamplingParams const& pa
         = mBufferManager->gpu(ITensor::makeShape({mMaxBatchSize, mMaxSeqLen}), nvinfer1::DataType::kFLOAT);
 
     mBatchSlots = mBufferManager->pinned(ITensor::makeShape({mBatchSize}), nvinfer1::DataType::kINT32);
-    mCurandStatesDevice
-        = mBufferManager->gpu(ITensor::makeShape({mMaxBatchSize, sizeof(curandState_t)}), nvinfer1::DataType::kINT8);
+    mRandomStatesDevice
+        = mBufferManager->gpu(ITensor::makeShape({mMaxBatchSize, sizeof(tk::RandomState)}), nvinfer1::DataType::kINT8);
 
     auto const workspaceSize = mSamplingLayer->getWorkspaceSize();
 
@@ -98,6 +98,8 @@ void BaseSamplingLayerTest<T>::setup(uint64_t seed, TestSamplingParams const& pa
         = params.minTopP.size() ? std::make_optional<std::vector<float>>(params.minTopP) : std::nullopt;
     setupParams->topPResetIds
         = params.topPResetIds.size() ? std::make_optional<std::vector<int32_t>>(params.topPResetIds) : std::nullopt;
+    setupParams->runtimeMinP
+        = params.minPs.size() ? std::make_optional<std::vector<float>>(params.minPs) : std::nullopt;
 
     mDecodingWorkspace->setDeviceBatchSlots(mBatchSlots);
     mDecodingWorkspace->getDeviceRuntimeLogits()->reshape(ITensor::makeShape({mBatchSize, mVocabSize}));
@@ -120,7 +122,7 @@ std::shared_ptr<SamplingInputs> BaseSamplingLayerTest<T>::createInputTensors(int
 
     decodeInputTensors->probsComputed = mComputeProbs;
 
-    decodeInputTensors->curandStates = reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*mCurandStatesDevice));
+    decodeInputTensors->randomStates = reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*mRandomStatesDevice));
 
     return decodeInputTensors;
 }
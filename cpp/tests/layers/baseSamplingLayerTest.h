@@ -85,6 +85,7 @@ struct TestSamplingParams
     std::vector<float> decay;
     std::vector<float> minTopP;
     std::vector<int32_t> topPResetIds;
+    std::vector<float> minPs;
     bool useBias = false;
 };
 
@@ -125,7 +126,7 @@ protected:
     TensorPtr mCumLogProbsDevice;
     TensorPtr mOutputLogProbsDevice;
 
-    TensorPtr mCurandStatesDevice;
+    TensorPtr mRandomStatesDevice;
     TensorPtr mPenaltyWorkspaceDevice;
 
     std::shared_ptr<tensorrt_llm::runtime::CudaStream> mStream;
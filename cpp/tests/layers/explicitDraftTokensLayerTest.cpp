@@ -1576,19 +1576,21 @@ protected:
     {
         SizeType32* batchSlotsPtr{nullptr};
 
-        auto curandState = mBufferManager->gpu(ITensor::makeShape({batchSize, 48}), nvinfer1::DataType::kUINT8);
-        auto* curandStatePtr = reinterpret_cast<curandState_t*>(bufferCast<uint8_t>(*curandState));
+        auto randomState = mBufferManager->gpu(
+            ITensor::makeShape({batchSize, sizeof(tk::RandomState)}), nvinfer1::DataType::kUINT8);
+        auto* randomStatePtr = reinterpret_cast<tk::RandomState*>(bufferCast<uint8_t>(*randomState));
 
         if (batchInit)
         {
             auto randomSeeds = mBufferManager->gpu(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT64);
             trk::invokeFill(*randomSeeds, static_cast<int64_t>(randomSeed), *mStream);
             auto* randomSeedsPtr = bufferCast<uint64_t>(*randomSeeds);
-            tk::invokeCurandBatchInitialize(curandStatePtr, batchSlotsPtr, batchSize, randomSeedsPtr, mStream->get());
+            tk::invokeRandomStateBatchInitialize(
+                randomStatePtr, batchSlotsPtr, batchSize, randomSeedsPtr, mStream->get());
         }
         else
         {
-            tk::invokeCurandInitialize(curandStatePtr, batchSlotsPtr, batchSize, randomSeed, mStream->get());
+            tk::invokeRandomStateInitialize(randomStatePtr, batchSlotsPtr, batchSize, randomSeed, mStream->get());
         }
         mStream->synchronize();
 
@@ -1604,7 +1606,7 @@ protected:
 
         params.randDataSample = bufferCast<T>(*randDataSample);
         params.randDataVerification = bufferCast<T>(*randDataValidation);
-        params.curandState = curandStatePtr;
+        params.randomState = randomStatePtr;
         params.batchSlots = batchSlotsPtr;
 
         tksd::invokeFillRandData(params, mStream->get());
@@ -1661,4 +1663,185 @@ TYPED_TEST(FillRandDataTest, BatchInit)
     this->runTest(batchSize, numPaths, draftLength, skipVerification, randomSeed, true);
 }
 
+template <typename T>
+class DynamicDraftTreeTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    void SetUp() override
+    {
+        mStream = std::make_shared<tensorrt_llm::runtime::CudaStream>();
+        mBufferManager = std::make_shared<tensorrt_llm::runtime::BufferManager>(mStream);
+    }
+
+    template <typename VecT>
+    ITensor::SharedPtr toGpu(std::vector<VecT> const& vec)
+    {
+        return mBufferManager->copyFrom(
+            vec, ITensor::makeShape({static_cast<SizeType32>(vec.size())}), runtime::MemoryType::kGPU);
+    }
+
+    template <typename VecT>
+    std::vector<VecT> toHost(ITensor const& tensor)
+    {
+        auto hostTensor = mBufferManager->copyFrom(tensor, MemoryType::kCPU);
+        mStream->synchronize();
+        auto range = BufferRange<VecT>(*hostTensor);
+        return std::vector<VecT>(range.begin(), range.end());
+    }
+
+    std::shared_ptr<tensorrt_llm::runtime::CudaStream> mStream;
+    std::shared_ptr<tensorrt_llm::runtime::BufferManager> mBufferManager;
+};
+
+#ifdef ENABLE_BF16
+TYPED_TEST_SUITE(DynamicDraftTreeTest, FloatHalfBfloatTypes);
+#else
+TYPED_TEST_SUITE(DynamicDraftTreeTest, FloatAndHalfTypes);
+#endif
+
+TYPED_TEST(DynamicDraftTreeTest, TopCandidatesTree)
+{
+    using T = TypeParam;
+    SizeType32 constexpr batchSize{2};
+    SizeType32 constexpr maxNumCandidates{7};
+    SizeType32 constexpr numPaths{2};
+    SizeType32 constexpr maxPathLength{3};
+    SizeType32 constexpr maxDecodingTokens{5};
+    SizeType32 constexpr vocabSize{4};
+
+    // Request 0: candidate 5 is too deep, candidate 2 would add a third path and candidate 6 is a child of 2.
+    // Request 1: only the root and one child are valid.
+    std::vector<TokenIdType> const candidateTokens{100, 101, 102, 103, 104, 105, 106, 200, 201, 0, 0, 0, 0, 0};
+    std::vector<float> const candidateScores{0.f, -0.1f, -0.5f, -0.3f, -0.2f, -0.4f, -0.6f, 0.f, -1.f, 0.f, 0.f, 0.f,
+        0.f, 0.f};
+    std::vector<SizeType32> const candidateParents{-1, 0, 0, 1, 1, 3, 2, -1, 0, 0, 0, 0, 0, 0};
+    std::vector<SizeType32> const numCandidates{7, 2};
+    std::vector<SizeType32> const positionIdsBase{10, 20};
+    std::vector<SizeType32> const batchSlots{1, 0};
+    std::vector<T> candidateProbs(batchSize * maxNumCandidates * vocabSize);
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        for (SizeType32 ci = 0; ci < maxNumCandidates; ++ci)
+        {
+            for (SizeType32 vi = 0; vi < vocabSize; ++vi)
+            {
+                candidateProbs[(bi * maxNumCandidates + ci) * vocabSize + vi]
+                    = static_cast<T>(static_cast<float>(bi * 100 + ci * 10 + vi));
+            }
+        }
+    }
+
+    auto candidateTokensDevice = this->toGpu(candidateTokens);
+    auto candidateScoresDevice = this->toGpu(candidateScores);
+    auto candidateParentsDevice = this->toGpu(candidateParents);
+    auto numCandidatesDevice = this->toGpu(numCandidates);
+    auto positionIdsBaseDevice = this->toGpu(positionIdsBase);
+    auto batchSlotsDevice = this->toGpu(batchSlots);
+    auto candidateProbsDevice = this->toGpu(candidateProbs);
+
+    auto& bufferManager = *this->mBufferManager;
+    auto treeShape = ITensor::makeShape({batchSize, maxDecodingTokens});
+    auto pathsShape = ITensor::makeShape({batchSize, numPaths, maxPathLength});
+    auto treeCandidates = bufferManager.gpu(treeShape, nvinfer1::DataType::kINT32);
+    auto treeParents = bufferManager.gpu(treeShape, nvinfer1::DataType::kINT32);
+    auto treeDepths = bufferManager.gpu(treeShape, nvinfer1::DataType::kINT32);
+    auto generationLengths = bufferManager.gpu(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+    auto generationLengthsSum = bufferManager.gpu(ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+    auto maxGenerationLength = bufferManager.gpu(ITensor::makeShape({1}), nvinfer1::DataType::kINT32);
+    auto nextDraftTokens = bufferManager.gpu(pathsShape, nvinfer1::DataType::kINT32);
+    auto nextDraftIndices = bufferManager.gpu(pathsShape, nvinfer1::DataType::kINT32);
+    auto nextFlatTokens = bufferManager.gpu(treeShape, nvinfer1::DataType::kINT32);
+    auto packedPosIds = bufferManager.gpu(treeShape, nvinfer1::DataType::kINT32);
+    auto masks = bufferManager.gpu(
+        ITensor::makeShape({batchSize, maxDecodingTokens, maxDecodingTokens}), nvinfer1::DataType::kBOOL);
+    auto draftProbs = bufferManager.gpu(
+        ITensor::makeShape({batchSize, numPaths, maxPathLength - 1, vocabSize}), TRTDataType<T>::value);
+    bufferManager.setZero(*nextFlatTokens);
+    bufferManager.setZero(*packedPosIds);
+
+    tksd::DynamicDraftTreeParams<T> params;
+    params.candidateTokens = bufferCast<TokenIdType>(*candidateTokensDevice);
+    params.candidateScores = bufferCast<float>(*candidateScoresDevice);
+    params.candidateParents = bufferCast<SizeType32>(*candidateParentsDevice);
+    params.numCandidates = bufferCast<SizeType32>(*numCandidatesDevice);
+    params.candidateProbs = bufferCast<T>(*candidateProbsDevice);
+    params.positionIdsBase = bufferCast<SizeType32>(*positionIdsBaseDevice);
+    params.batchSlots = bufferCast<SizeType32>(*batchSlotsDevice);
+    params.treeCandidateIndices = bufferCast<SizeType32>(*treeCandidates);
+    params.treeParents = bufferCast<SizeType32>(*treeParents);
+    params.treeDepths = bufferCast<SizeType32>(*treeDepths);
+    params.generationLengths = bufferCast<SizeType32>(*generationLengths);
+    params.nextDraftTokens = bufferCast<TokenIdType>(*nextDraftTokens);
+    params.nextDraftIndices = bufferCast<SizeType32>(*nextDraftIndices);
+    params.generationLengthInclusiveSum = bufferCast<SizeType32>(*generationLengthsSum);
+    params.maxGenerationLength = bufferCast<SizeType32>(*maxGenerationLength);
+    params.nextFlatTokens = bufferCast<TokenIdType>(*nextFlatTokens);
+    params.packedPosIds = bufferCast<SizeType32>(*packedPosIds);
+    params.masks = bufferCast<bool>(*masks);
+    params.outputDraftProbs = bufferCast<T>(*draftProbs);
+    params.batchSize = batchSize;
+    params.maxNumCandidates = maxNumCandidates;
+    params.numPaths = numPaths;
+    params.maxPathLength = maxPathLength;
+    params.maxDecodingTokens = maxDecodingTokens;
+    params.vocabSize = vocabSize;
+    params.checkParams();
+
+    tksd::invokeBuildDynamicDraftTree(params, this->mStream->get());
+
+    auto const scanTempStorageBytes
+        = tksd::invokeScanGenerationLengths(nullptr, 0, nullptr, nullptr, batchSize, this->mStream->get());
+    auto const reduceTempStorageBytes
+        = tksd::invokeReduceMaxGenerationLengths(nullptr, 0, nullptr, nullptr, batchSize, this->mStream->get());
+    auto tempStorage = bufferManager.gpu(std::max(scanTempStorageBytes, reduceTempStorageBytes));
+    tksd::invokeScanReduceGenerationLengths(batchSize, bufferCast<SizeType32>(*generationLengths),
+        tempStorage->data(), scanTempStorageBytes, bufferCast<SizeType32>(*generationLengthsSum), tempStorage->data(),
+        reduceTempStorageBytes, bufferCast<SizeType32>(*maxGenerationLength), this->mStream->get());
+
+    tksd::invokePackDynamicDraftTree(params, this->mStream->get());
+    this->mStream->synchronize();
+
+    EXPECT_EQ(this->template toHost<SizeType32>(*generationLengths), std::vector<SizeType32>({4, 2}));
+    EXPECT_EQ(this->template toHost<SizeType32>(*maxGenerationLength), std::vector<SizeType32>({4}));
+    EXPECT_EQ(this->template toHost<TokenIdType>(*nextDraftTokens),
+        std::vector<TokenIdType>({100, 101, 104, 100, 101, 103, 200, 201, 201, 200, 200, 200}));
+    EXPECT_EQ(this->template toHost<SizeType32>(*nextDraftIndices),
+        std::vector<SizeType32>({0, 1, 2, 0, 1, 3, 0, 1, 1, 0, 0, 0}));
+    EXPECT_EQ(this->template toHost<TokenIdType>(*nextFlatTokens),
+        std::vector<TokenIdType>({100, 101, 104, 103, 200, 201, 0, 0, 0, 0}));
+    EXPECT_EQ(this->template toHost<SizeType32>(*packedPosIds),
+        std::vector<SizeType32>({10, 11, 12, 12, 20, 21, 0, 0, 0, 0}));
+
+    auto const masksHost = this->template toHost<bool>(*masks);
+    // clang-format off
+    std::vector<bool> const expectedMasks{
+        true, false, false, false,
+        true, true, false, false,
+        true, true, true, false,
+        true, true, false, true,
+
+        true, false, false, false,
+        true, true, false, false,
+        false, false, false, false,
+        false, false, false, false};
+    // clang-format on
+    // Masks are strided by the max generation length of the batch.
+    EXPECT_EQ(std::vector<bool>(masksHost.begin(), masksHost.begin() + expectedMasks.size()), expectedMasks);
+
+    // Probs are gathered to the batch slots.
+    auto const probsHost = this->template toHost<T>(*draftProbs);
+    std::vector<SizeType32> const expectedCandidates{1, 1, 0, 0, 1, 4, 1, 3};
+    for (SizeType32 ri = 0; ri < static_cast<SizeType32>(expectedCandidates.size()); ++ri)
+    {
+        auto const slot = ri / (numPaths * (maxPathLength - 1));
+        auto const bi = slot == 1 ? 0 : 1;
+        for (SizeType32 vi = 0; vi < vocabSize; ++vi)
+        {
+            EXPECT_EQ(static_cast<float>(probsHost[ri * vocabSize + vi]),
+                static_cast<float>(bi * 100 + expectedCandidates[ri] * 10 + vi))
+                << "row " << ri << " vocab " << vi;
+        }
+    }
+}
+
 } // namespace tensorrt_llm::tests::layers
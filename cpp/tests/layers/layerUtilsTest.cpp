@@ -15,6 +15,7 @@
  */
 
 #include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/layers/layerUtils.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/decodingLayerWorkspace.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
@@ -129,4 +130,59 @@ TYPED_TEST(CopyToWorkspaceFixture, DataMuchSmallerThanWorkspace_Succeeds)
     }
 }
 
+TEST(LayerUtilsTest, GetActiveBatchIndices)
+{
+    using tensorrt_llm::layers::getActiveBatchIndices;
+
+    std::vector<SizeType32> const batchSlots{4, 0, 2, 3};
+    bool const skipDecode[] = {true, false, false, true, false};
+    EXPECT_EQ(getActiveBatchIndices(batchSlots.data(), skipDecode, 4), (std::vector<SizeType32>{0, 2}));
+
+    bool const skipAll[] = {true, true, true, true, true};
+    EXPECT_TRUE(getActiveBatchIndices(batchSlots.data(), skipAll, 4).empty());
+}
+
+TEST(SlotParamsDeltaTest, FillBuffersRecordsChangedSlots)
+{
+    using tensorrt_llm::layers::FillBuffers;
+    using tensorrt_llm::layers::SlotParamsDelta;
+
+    auto manager = std::make_shared<BufferManager>(std::make_shared<CudaStream>());
+    SizeType32 constexpr maxBatchSize{8};
+    float constexpr defaultValue{1.f};
+    auto const shape = ITensor::makeShape({maxBatchSize});
+    ITensor::SharedPtr host = manager->cpu(shape, nvinfer1::DataType::kFLOAT);
+    ITensor::SharedPtr device = manager->gpu(shape, nvinfer1::DataType::kFLOAT);
+    std::fill_n(bufferCast<float>(*host), maxBatchSize, defaultValue);
+    manager->copy(*host, *device);
+
+    ITensor::SharedPtr batchSlots = manager->cpu(ITensor::makeShape({3}), nvinfer1::DataType::kINT32);
+    auto* batchSlotsPtr = bufferCast<SizeType32>(*batchSlots);
+    batchSlotsPtr[0] = 5;
+    batchSlotsPtr[1] = 1;
+    batchSlotsPtr[2] = 6;
+
+    SlotParamsDelta delta;
+    FillBuffers const fillBuffers{3, maxBatchSize, manager, &delta};
+    std::optional<std::vector<float>> const values{{0.5f, defaultValue, 2.f}};
+    fillBuffers(values, defaultValue, host, device, batchSlots, {0.f, 10.f}, "test");
+
+    auto const& updates = delta.getUpdates();
+    ASSERT_EQ(updates.size(), 2);
+    EXPECT_EQ(updates[0].dst, bufferCast<float>(*device) + 5);
+    EXPECT_EQ(updates[1].dst, bufferCast<float>(*device) + 6);
+
+    tensorrt_llm::layers::DecoderDomain const decoderDomain{maxBatchSize, 1, 16, 16};
+    DecodingLayerWorkspace workspace{
+        manager, decoderDomain, nvinfer1::DataType::kFLOAT, SlotParamsDelta::getWorkspaceSize(maxBatchSize)};
+    delta.flush(*manager, workspace);
+    EXPECT_TRUE(delta.getUpdates().empty());
+
+    std::vector<float> deviceValues(maxBatchSize);
+    manager->copy(*device, deviceValues.data(), MemoryType::kCPU);
+    manager->getStream().synchronize();
+    std::vector<float> const expected{1.f, 1.f, 1.f, 1.f, 1.f, 0.5f, 2.f, 1.f};
+    EXPECT_EQ(deviceValues, expected);
+}
+
 } // namespace tensorrt_llm::tests::layers
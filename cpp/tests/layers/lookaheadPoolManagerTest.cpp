@@ -17,8 +17,11 @@
 
 #include "tensorrt_llm/layers/lookaheadDecodingUtils.h"
 #include "tensorrt_llm/layers/lookaheadPoolManager.h"
+#include "tensorrt_llm/layers/lookaheadSharedPool.h"
 #include "tests/layers/randomLlm.h"
 
+#include <thread>
+
 namespace tensorrt_llm::tests::layers
 {
 using namespace tensorrt_llm::runtime;
@@ -171,4 +174,106 @@ TEST(LookaheadPoolManagerTest, fillAndUpdate)
     EXPECT_TRUE(isTensorEqString(*it, "abc"));
 }
 
+void insertNgram(LookaheadSharedPool& pool, char key, std::string const& ngram)
+{
+    std::vector<TokenIdType> const tokens(ngram.begin(), ngram.end());
+    pool.insert(key, tokens.data(), static_cast<SizeType32>(tokens.size()));
+}
+
+TEST(LookaheadSharedPoolTest, evictsLeastRecentlyUsed)
+{
+    LookaheadSharedPool pool(2, 2, 1);
+    insertNgram(pool, 'x', "ab");
+    insertNgram(pool, 'x', "cd");
+    insertNgram(pool, 'x', "ef");
+    insertNgram(pool, 'y', "gh");
+    EXPECT_EQ(pool.getNumKeys(), 2);
+
+    // Only the newest n-grams of a key are kept, oldest first
+    EXPECT_EQ(pool.find('x', 2, 4), (std::vector<TokenIdType>{'c', 'd', 'e', 'f'}));
+    EXPECT_EQ(pool.find('x', 2, 1), (std::vector<TokenIdType>{'e', 'f'}));
+    // A length is a key of its own
+    EXPECT_TRUE(pool.find('x', 3, 4).empty());
+
+    // Inserting an n-gram again makes it the newest
+    insertNgram(pool, 'x', "cd");
+    EXPECT_EQ(pool.find('x', 2, 4), (std::vector<TokenIdType>{'e', 'f', 'c', 'd'}));
+
+    // 'y' was used least recently
+    insertNgram(pool, 'z', "ij");
+    EXPECT_TRUE(pool.find('y', 2, 4).empty());
+    EXPECT_EQ(pool.find('z', 2, 4), (std::vector<TokenIdType>{'i', 'j'}));
+    EXPECT_EQ(pool.getNumKeys(), 2);
+}
+
+TEST(LookaheadSharedPoolTest, guessFallsBackToSharedPool)
+{
+    SizeType32 constexpr N{4};
+    SizeType32 constexpr G{3};
+    auto sharedPool = std::make_shared<LookaheadSharedPool>(64, G);
+
+    LookaheadPoolManager publisher(G);
+    publisher.setSharedPool(sharedPool);
+    publisher.setup(G);
+    publisher.accept(initTensor("{\"name\": \"a\"}"), N, true);
+    publisher.accept(initTensor("{\"id\": 1}"), N, true);
+
+    // The prompt is not published
+    LookaheadPoolManager pm(G);
+    pm.setSharedPool(sharedPool);
+    pm.setup(G);
+    pm.accept(initTensor("{\"x"), N);
+    EXPECT_TRUE(sharedPool->find('x', N - 1, G).empty());
+
+    auto list = pm.guess('{', G);
+    ASSERT_EQ(list.size(), 2);
+    auto it = list.begin();
+    EXPECT_TRUE(isTensorEqString(*it, "\"na"));
+    it++;
+    EXPECT_TRUE(isTensorEqString(*it, "\"id"));
+
+    // The own n-grams of the request come last and are not repeated
+    pm.accept(initTensor("{\"na"), N);
+    list = pm.guess('{', G);
+    ASSERT_EQ(list.size(), 2);
+    it = list.begin();
+    EXPECT_TRUE(isTensorEqString(*it, "\"id"));
+    it++;
+    EXPECT_TRUE(isTensorEqString(*it, "\"na"));
+
+    // Requests without a shared pool only guess their own n-grams
+    LookaheadPoolManager alone(G);
+    alone.setup(G);
+    alone.accept(initTensor("{\"x"), N);
+    EXPECT_TRUE(alone.guess('{', G).empty());
+}
+
+TEST(LookaheadSharedPoolTest, concurrentInsertAndFind)
+{
+    SizeType32 constexpr numThreads{8};
+    SizeType32 constexpr numKeys{256};
+    LookaheadSharedPool pool(numKeys, 4);
+    std::vector<std::thread> threads;
+    for (SizeType32 ti = 0; ti < numThreads; ++ti)
+    {
+        threads.emplace_back(
+            [&pool, ti]()
+            {
+                for (TokenIdType key = 0; key < 2 * numKeys; ++key)
+                {
+                    std::vector<TokenIdType> const ngram{key, ti, key + ti};
+                    pool.insert(key, ngram.data(), 3);
+                    auto const found = pool.find(key, 3, 4);
+                    EXPECT_EQ(found.size() % 3, 0);
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_LE(pool.getNumKeys(), numKeys);
+    EXPECT_GT(pool.getNumKeys(), 0);
+}
+
 } // namespace tensorrt_llm::tests::layers
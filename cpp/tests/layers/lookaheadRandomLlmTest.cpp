@@ -138,8 +138,8 @@ TEST(LookaheadRandomllm, gpuSampling)
     TensorPtr mSkipDecode = BufferManager::pinned(maxBatchShape1D, nvinfer1::DataType::kBOOL);
     TensorPtr mTokensPerStep = BufferManager::pinned(maxBatchShape1D, nvinfer1::DataType::kINT32);
 
-    TensorPtr mCurandStates
-        = BufferManager::pinned(ITensor::makeShape({maxBatchSize, sizeof(curandState_t)}), nvinfer1::DataType::kINT8);
+    TensorPtr mRandomStates
+        = BufferManager::pinned(ITensor::makeShape({maxBatchSize, sizeof(tk::RandomState)}), nvinfer1::DataType::kINT8);
     TensorPtr mOutputIds
         = BufferManager::pinned(ITensor::makeShape({maxBatchSize, mMaxSeqLen}), nvinfer1::DataType::kINT32);
 
@@ -151,9 +151,9 @@ TEST(LookaheadRandomllm, gpuSampling)
     std::copy(batchSlotsVec.begin(), batchSlotsVec.end(), BufferRange<SizeType32>(*mBatchSlots).begin());
 
     auto batchSlotsPtr = bufferCast<int32_t>(*mBatchSlots);
-    // Allocate and init curand states
-    tk::invokeCurandInitialize(reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*mCurandStates)), batchSlotsPtr,
-        batchSize, mSeed, mStream->get());
+    // Allocate and init random states
+    tk::invokeRandomStateInitialize(reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*mRandomStates)),
+        batchSlotsPtr, batchSize, mSeed, mStream->get());
 
     // Init by zero.
     trk::invokeFill(*mFinished, uint8_t{0}, *mStream);
@@ -199,7 +199,7 @@ TEST(LookaheadRandomllm, gpuSampling)
     kernelParams.skipDecode = bufferCast<bool>(*mSkipDecode);
     kernelParams.cumLogProbs = nullptr;
     kernelParams.outputLogProbs = nullptr;
-    kernelParams.curandState = reinterpret_cast<curandState_t*>(bufferCast<int8_t>(*mCurandStates));
+    kernelParams.randomState = reinterpret_cast<tk::RandomState*>(bufferCast<int8_t>(*mRandomStates));
     kernelParams.batchSize = batchSize;
     kernelParams.maxBatchSize = maxBatchSize;
     kernelParams.maxTokensPerStep = maxTokensPerStep;
@@ -255,6 +255,15 @@ void MedusaDecodingLayerTest<T>::setup(SamplingParams& params)
     setupParams->runtimeTopK = std::make_optional<std::vector<SizeType32>>(params.runtimeTopK);
     setupParams->runtimeHeadsTopK = std::make_optional<std::vector<std::vector<SizeType32>>>(params.runtimeHeadsTopK);
     setupParams->randomSeed = {{0}};
+    if (params.typicalAcceptanceThreshold)
+    {
+        setupParams->typicalAcceptanceThreshold = {{params.typicalAcceptanceThreshold.value()}};
+    }
+    if (params.typicalAcceptanceAlpha)
+    {
+        setupParams->typicalAcceptanceAlpha = {{params.typicalAcceptanceAlpha.value()}};
+    }
+    setupParams->useRejectionSampling = {{params.useRejectionSampling}};
     mDecodingWorkspace->setDeviceBatchSlots(mBatchSlots);
     mMedusaDecodingLayer->setup(mBatchSize, 1, mBatchSlots, setupParams, mDecodingWorkspace);
 
@@ -517,4 +526,73 @@ TYPED_TEST(MedusaDecodingLayerTest, SimpleTestEndIdSelected)
     std::vector<bool> finished = {true};
     this->runTest(expectedOutTokens, expectedDraftTokens, finished, params);
 }
+
+TYPED_TEST(MedusaDecodingLayerTest, TypicalAcceptanceBS1)
+{
+    // Target Ids to be sampled
+    // [4, 0, 2, 1, 3, 4, 3, 0, 2, 3, 4, 1]
+    // Entropy of every target row is 1.28, the threshold is min(0.25, exp(-1.28)) = 0.25.
+    // Draft tokens with probability 0.3 are accepted although they are not the sampled target tokens.
+    SamplingParams params;
+    params.runtimeTopK = {1};
+    params.runtimeHeadsTopK = {{2, 3, 2, 1}};
+    params.draftIds = {{5, 1, 3, 1, 3, 4, 3, 0, 2, 3, 4}};
+    params.paths = {{0, 1, 2, 3, -1}};
+    params.treeIds = {{0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2}};
+    params.tokensPerStep = {12};
+    params.acceptedCumSum = {0, 3};
+    params.packedPaths = {0, 1, 2};
+    params.batchSize = 1;
+    params.typicalAcceptanceThreshold = 0.25f;
+    params.typicalAcceptanceAlpha = 1.f;
+
+    std::vector<std::vector<std::set<TokenIdType>>> expectedOutTokens = {{{5}, {1}, {3}, {1}}};
+    std::vector<std::vector<TokenIdType>> expectedDraftTokens = {{1, 2, 1, 2, 3, 2, 3, 0, 1, 2, 1}};
+    std::vector<bool> finished = {false};
+    this->runTest(expectedOutTokens, expectedDraftTokens, finished, params);
+}
+
+TYPED_TEST(MedusaDecodingLayerTest, TypicalAcceptanceRejectsUnlikelyDraftBS1)
+{
+    // The third draft token has probability 0.2 under its parent row and is rejected
+    SamplingParams params;
+    params.runtimeTopK = {1};
+    params.runtimeHeadsTopK = {{1, 1, 1, 1}};
+    params.draftIds = {{5, 1, 4, 1, 3, 4, 3, 0, 2, 3, 4}};
+    params.paths = {{0, 1, 2, 3, -1}};
+    params.treeIds = {{0, 1, 2, 3, 0, 1, 2, 3, 3, 2, 1}};
+    params.tokensPerStep = {12};
+    params.acceptedCumSum = {0, 2};
+    params.packedPaths = {0, 1};
+    params.batchSize = 1;
+    params.typicalAcceptanceThreshold = 0.25f;
+    params.typicalAcceptanceAlpha = 1.f;
+
+    std::vector<std::vector<std::set<TokenIdType>>> expectedOutTokens = {{{5}, {1}, {2}}};
+    std::vector<std::vector<TokenIdType>> expectedDraftTokens = {{2, 4, 1, 1, 2, 4, 1, 1, 1, 1, 4}};
+    std::vector<bool> finished = {false};
+    this->runTest(expectedOutTokens, expectedDraftTokens, finished, params);
+}
+
+TYPED_TEST(MedusaDecodingLayerTest, RejectionSamplingBS1)
+{
+    // The first draft token has zero target probability, so it is always rejected and the first new token is
+    // sampled from the full distribution of the root row
+    SamplingParams params;
+    params.runtimeTopK = {1};
+    params.runtimeHeadsTopK = {{2, 3, 2, 1}};
+    params.draftIds = {{8, 0, 2, 1, 3, 4, 3, 0, 2, 3, 4}};
+    params.paths = {{0, 1, 2, 3, -1}};
+    params.treeIds = {{0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2}};
+    params.tokensPerStep = {12};
+    params.acceptedCumSum = {0, 0};
+    params.packedPaths = {};
+    params.batchSize = 1;
+    params.useRejectionSampling = true;
+
+    std::vector<std::vector<std::set<TokenIdType>>> expectedOutTokens = {{{4, 5, 6, 7}}};
+    std::vector<std::vector<TokenIdType>> expectedDraftTokens = {{4, 5, 2, 3, 4, 0, 1, 4, 4, 5, 2}};
+    std::vector<bool> finished = {false};
+    this->runTest(expectedOutTokens, expectedDraftTokens, finished, params);
+}
 } // namespace tensorrt_llm::tests::layers
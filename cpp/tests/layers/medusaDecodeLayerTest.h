@@ -41,6 +41,9 @@ struct SamplingParams
     std::vector<tensorrt_llm::runtime::SizeType32> acceptedCumSum;
     std::vector<tensorrt_llm::runtime::SizeType32> packedPaths;
     std::optional<tensorrt_llm::runtime::TokenIdType> endId;
+    std::optional<float> typicalAcceptanceThreshold;
+    std::optional<float> typicalAcceptanceAlpha;
+    bool useRejectionSampling{false};
 };
 
 template <typename T>
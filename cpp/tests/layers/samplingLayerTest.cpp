@@ -373,4 +373,166 @@ TYPED_TEST(SamplingLayerTest, OnlyTopP)
     this->runTest(expectedOutputIds, params);
 }
 
+template <typename T>
+class RejectionSamplingLayerTest : public BaseSamplingLayerTest<T>
+{
+    void SetUp() override
+    {
+        this->mStream = std::make_shared<tensorrt_llm::runtime::CudaStream>();
+        this->mBufferManager = std::make_shared<tensorrt_llm::runtime::BufferManager>(this->mStream);
+    }
+
+    void initLayer(TestSamplingParams const& params) override
+    {
+        auto const decodingMode = params.minPs.size() ? tle::DecodingMode::MinP()
+                                                      : tle::DecodingMode::TopKTopP().useRejectionSampling(true);
+
+        auto const decodingDomain
+            = tensorrt_llm::layers::DecoderDomain(this->mMaxBatchSize, 1, this->mVocabSize, this->mVocabSizePadded);
+        this->mSamplingLayer = std::make_shared<tensorrt_llm::layers::SamplingLayer<T>>(
+            decodingMode, decodingDomain, this->mBufferManager);
+    }
+};
+
+TYPED_TEST_SUITE(RejectionSamplingLayerTest, FloatAndHalfTypes);
+
+TYPED_TEST(RejectionSamplingLayerTest, BatchTopKBatchTopP)
+{
+    std::vector<SizeType32> topKs = {2, 2, 0, 2, 2, 1};
+    std::vector<float> topPs = {0.0, 0.3, 0.5, 0.0, 0.3, 0.5};
+    TestSamplingParams params;
+    params.topKs = topKs;
+    params.topPs = topPs;
+    std::vector<std::set<int32_t>> expectedOutputIds{
+        // batch
+        {4, 5}, {4}, {4, 5}, {4, 5}, {4}, {4}, // step 0
+        {0, 1}, {0}, {0, 1}, {0, 1}, {0}, {0}, // step 1
+        {2, 3}, {2}, {2, 3}, {2, 3}, {2}, {2}, // step 2
+        {0, 1}, {0}, {0, 1}, {0, 1}, {0}, {0}  // step 3
+    };
+    this->runTest(expectedOutputIds, params);
+}
+
+TYPED_TEST(RejectionSamplingLayerTest, BatchTopP)
+{
+    std::vector<float> topPs = {0.3f, 0.3f, 0.5f, 0.8f, 0.5f, 0.8f};
+    TestSamplingParams params;
+    params.topPs = topPs;
+    std::vector<std::set<int32_t>> expectedOutputIds{
+        // batch
+        {4}, {4}, {4, 5}, {4, 5, 6}, {4, 5}, {4, 5, 6}, // step 0
+        {0}, {0}, {0, 1}, {0, 1, 2}, {0, 1}, {0, 1, 2}, // step 1
+        {2}, {2}, {2, 3}, {2, 3, 4}, {2, 3}, {2, 3, 4}, // step 2
+        {0}, {0}, {0, 1}, {0, 1, 2}, {0, 1}, {0, 1, 2}  // step 3
+    };
+    this->runTest(expectedOutputIds, params);
+}
+
+TYPED_TEST(RejectionSamplingLayerTest, InvalidArgsZeroBatchTopKTopP)
+{
+    std::vector<SizeType32> topKs = {0, 0, 0, 0, 0, 0};
+    float topP = 0;
+    TestSamplingParams params;
+    params.topPs = {topP};
+    params.topKs = topKs;
+    std::vector<std::set<int32_t>> expectedOutputIds{
+        // batch
+        {4}, {4}, {4}, {4}, {4}, {4}, // step 0
+        {0}, {0}, {0}, {0}, {0}, {0}, // step 1
+        {2}, {2}, {2}, {2}, {2}, {2}, // step 2
+        {0}, {0}, {0}, {0}, {0}, {0}  // step 3
+    };
+    this->runTest(expectedOutputIds, params);
+}
+
+TYPED_TEST(RejectionSamplingLayerTest, TopPDecay)
+{
+    TestSamplingParams params;
+    params.topPs = {0.8f, 0.5f, 0.3f, 0.2f, 0.5f, 1.0f};
+    params.decay = {0.3f, 0.3f, 0.3f, 0.9f, 0.3f, 0.8f};
+    params.topPResetIds = {2, -1, 2, -1, 2, -1};
+    params.minTopP = {0.5f, 0.1f, 0.3f, 0.1f, 0.1f, 0.1f};
+    std::vector<std::set<int32_t>> expectedOutputIds{
+        // batch
+        {4, 5, 6}, {4, 5}, {4}, {4}, {4, 5}, {4, 5, 6, 7}, // step 0
+        {0, 1}, {0}, {0}, {0}, {0}, {0, 1, 2},             // step 1
+        {2, 3}, {2}, {2}, {2}, {2}, {2, 3},                // step 2
+        {0, 1, 2}, {0}, {0}, {0}, {0, 1}, {0, 1}           // step 3
+    };
+    this->runTest(expectedOutputIds, params);
+}
+
+TYPED_TEST(RejectionSamplingLayerTest, BatchMinP)
+{
+    // Probabilities of the candidates are 0.4, 0.3, 0.2 and 0.1
+    TestSamplingParams params;
+    params.minPs = {0.6f, 0.3f, 1.0f, 0.6f, 0.3f, 0.0f};
+    params.topKs = {0, 0, 0, 0, 2, 1};
+    std::vector<std::set<int32_t>> expectedOutputIds{
+        // batch
+        {4, 5}, {4, 5, 6}, {4}, {4, 5}, {4, 5}, {4}, // step 0
+        {0, 1}, {0, 1, 2}, {0}, {0, 1}, {0, 1}, {0}, // step 1
+        {2, 3}, {2, 3, 4}, {2}, {2, 3}, {2, 3}, {2}, // step 2
+        {0, 1}, {0, 1, 2}, {0}, {0, 1}, {0, 1}, {0}  // step 3
+    };
+    this->runTest(expectedOutputIds, params);
+}
+
+template <typename T>
+class FusedSamplingLayerTest : public BaseSamplingLayerTest<T>
+{
+    void SetUp() override
+    {
+        this->mStream = std::make_shared<tensorrt_llm::runtime::CudaStream>();
+        this->mBufferManager = std::make_shared<tensorrt_llm::runtime::BufferManager>(this->mStream);
+    }
+
+    void initLayer(TestSamplingParams const& params) override
+    {
+        auto const decodingMode = tle::DecodingMode::TopKTopP().useFusedSampling(true);
+
+        auto const decodingDomain
+            = tensorrt_llm::layers::DecoderDomain(this->mMaxBatchSize, 1, this->mVocabSize, this->mVocabSizePadded);
+        this->mSamplingLayer = std::make_shared<tensorrt_llm::layers::SamplingLayer<T>>(
+            decodingMode, decodingDomain, this->mBufferManager);
+    }
+};
+
+TYPED_TEST_SUITE(FusedSamplingLayerTest, FloatAndHalfTypes);
+
+TYPED_TEST(FusedSamplingLayerTest, TopK)
+{
+    SizeType32 topK = 2;
+    float topP = 0.0f;
+    TestSamplingParams params;
+    params.topKs = {topK};
+    params.topPs = {topP};
+    std::vector<std::set<int32_t>> expectedOutputIds{
+        // batch
+        {4, 5}, {4, 5}, {4, 5}, {4, 5}, {4, 5}, {4, 5}, // step 0
+        {0, 1}, {0, 1}, {0, 1}, {0, 1}, {0, 1}, {0, 1}, // step 1
+        {2, 3}, {2, 3}, {2, 3}, {2, 3}, {2, 3}, {2, 3}, // step 2
+        {0, 1}, {0, 1}, {0, 1}, {0, 1}, {0, 1}, {0, 1}  // step 3
+    };
+    this->runTest(expectedOutputIds, params);
+}
+
+TYPED_TEST(FusedSamplingLayerTest, BatchTopKBatchTopP)
+{
+    // The request with topK 0 is sampled by top-p from the softmax computed after the fused top-k sampling
+    std::vector<SizeType32> topKs = {2, 2, 0, 2, 2, 1};
+    std::vector<float> topPs = {0.0, 0.3, 0.5, 0.0, 0.3, 0.5};
+    TestSamplingParams params;
+    params.topKs = topKs;
+    params.topPs = topPs;
+    std::vector<std::set<int32_t>> expectedOutputIds{
+        // batch
+        {4, 5}, {4}, {4, 5}, {4, 5}, {4}, {4}, // step 0
+        {0, 1}, {0}, {0, 1}, {0, 1}, {0}, {0}, // step 1
+        {2, 3}, {2}, {2, 3}, {2, 3}, {2}, {2}, // step 2
+        {0, 1}, {0}, {0, 1}, {0, 1}, {0}, {0}  // step 3
+    };
+    this->runTest(expectedOutputIds, params);
+}
+
 } // namespace
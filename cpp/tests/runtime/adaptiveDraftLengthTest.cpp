@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/adaptiveDraftLength.h"
+#include "tensorrt_llm/common/tllmException.h"
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+TEST(AdaptiveDraftLengthTest, StartsAtMaxAndKeepsItWhenAllAccepted)
+{
+    AdaptiveDraftLength draftLen{1, 8};
+    EXPECT_EQ(draftLen.getDraftLen(), 8);
+    for (int i = 0; i < 10; ++i)
+    {
+        draftLen.update(8, 8);
+    }
+    EXPECT_FLOAT_EQ(draftLen.getAcceptanceProbability(), 1.F);
+    EXPECT_EQ(draftLen.getDraftLen(), 8);
+}
+
+TEST(AdaptiveDraftLengthTest, ShrinksOnRejectionsAndRecovers)
+{
+    AdaptiveDraftLength draftLen{1, 8, 1.F, 0.3F};
+    // One accepted token per rejection, p = 0.5, 0.5^1 >= 0.3 > 0.5^2
+    draftLen.update(8, 1);
+    EXPECT_FLOAT_EQ(draftLen.getAcceptanceProbability(), 0.5F);
+    EXPECT_EQ(draftLen.getDraftLen(), 1);
+
+    // Nothing accepted, the minimum is kept so acceptance can still be measured
+    draftLen.update(1, 0);
+    EXPECT_EQ(draftLen.getDraftLen(), 1);
+
+    draftLen.update(1, 1);
+    EXPECT_EQ(draftLen.getDraftLen(), 8);
+
+    // Five accepted tokens per rejection, p = 5/6
+    draftLen.update(8, 5);
+    EXPECT_EQ(draftLen.getDraftLen(), 6);
+
+    // Steps without draft tokens carry no information
+    draftLen.update(0, 0);
+    EXPECT_EQ(draftLen.getDraftLen(), 6);
+
+    draftLen.reset();
+    EXPECT_EQ(draftLen.getDraftLen(), 8);
+}
+
+TEST(AdaptiveDraftLengthTest, InvalidArguments)
+{
+    EXPECT_THROW(AdaptiveDraftLength(4, 2), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(AdaptiveDraftLength(0, 2, 0.F), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(AdaptiveDraftLength(0, 2, 0.5F, 1.F), tensorrt_llm::common::TllmException);
+    AdaptiveDraftLength draftLen{0, 2};
+    EXPECT_THROW(draftLen.update(1, 2), tensorrt_llm::common::TllmException);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/admissionController.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace texec = tensorrt_llm::executor;
+
+TEST(AdmissionControllerTest, HeadroomWithoutWatermarks)
+{
+    AdmissionController const controller{};
+    auto const headroom = controller.evaluate(100, 40, 10);
+    EXPECT_EQ(headroom.freeNumBlocks, 40);
+    EXPECT_EQ(headroom.queuedNumBlocks, 10);
+    EXPECT_EQ(headroom.headroomNumBlocks, 30);
+    EXPECT_DOUBLE_EQ(headroom.commitment, 0.7);
+    EXPECT_EQ(headroom.estimatedQueueDelayMS, 0.);
+    EXPECT_EQ(headroom.decision, texec::AdmissionDecision::kADMIT);
+
+    // Short of blocks, but nothing was released yet
+    EXPECT_EQ(controller.evaluate(100, 5, 10).estimatedQueueDelayMS, std::nullopt);
+    // Never rejects without watermarks
+    EXPECT_EQ(controller.evaluate(100, 0, 50).decision, texec::AdmissionDecision::kADMIT);
+}
+
+TEST(AdmissionControllerTest, Watermarks)
+{
+    AdmissionController const controller{texec::AdmissionControlConfig{0.8F, 0.95F}};
+    EXPECT_EQ(controller.evaluate(100, 30, 0).decision, texec::AdmissionDecision::kADMIT);
+    EXPECT_EQ(controller.evaluate(100, 30, 10).decision, texec::AdmissionDecision::kDEFER);
+    EXPECT_EQ(controller.evaluate(100, 10, 5).decision, texec::AdmissionDecision::kREJECT);
+
+    AdmissionController const rejectOnly{texec::AdmissionControlConfig{std::nullopt, 0.9F}};
+    EXPECT_EQ(rejectOnly.evaluate(100, 15, 0).decision, texec::AdmissionDecision::kADMIT);
+    EXPECT_EQ(rejectOnly.evaluate(100, 5, 0).decision, texec::AdmissionDecision::kREJECT);
+
+    EXPECT_THROW(texec::AdmissionControlConfig(0.9F, 0.8F), std::exception);
+    EXPECT_THROW(texec::AdmissionControlConfig(1.5F), std::exception);
+}
+
+TEST(AdmissionControllerTest, QueueDelayFromReleaseRate)
+{
+    AdmissionController controller{std::nullopt, 0.5};
+    EXPECT_EQ(controller.getReleaseRate(), std::nullopt);
+    controller.onIteration(4, 10.);
+    ASSERT_TRUE(controller.getReleaseRate());
+    EXPECT_DOUBLE_EQ(*controller.getReleaseRate(), 0.4);
+    controller.onIteration(0, 10.);
+    EXPECT_DOUBLE_EQ(*controller.getReleaseRate(), 0.2);
+    // Ignored
+    controller.onIteration(10, 0.);
+    EXPECT_DOUBLE_EQ(*controller.getReleaseRate(), 0.2);
+
+    auto const headroom = controller.evaluate(100, 2, 12);
+    EXPECT_EQ(headroom.headroomNumBlocks, -10);
+    ASSERT_TRUE(headroom.estimatedQueueDelayMS);
+    EXPECT_DOUBLE_EQ(*headroom.estimatedQueueDelayMS, 50.);
+}
+
+TEST(AdmissionControllerTest, PromptBlocks)
+{
+    EXPECT_EQ(AdmissionController::getNumPromptBlocks(0, 64), 0);
+    EXPECT_EQ(AdmissionController::getNumPromptBlocks(64, 64), 1);
+    EXPECT_EQ(AdmissionController::getNumPromptBlocks(65, 64), 2);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/runtime/asyncEncoderRunner.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+using namespace tensorrt_llm::runtime;
+namespace tc = tensorrt_llm::common;
+
+class AsyncEncoderRunnerTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mEncoderStream = std::make_shared<CudaStream>();
+        mDecoderStream = std::make_shared<CudaStream>();
+    }
+
+    //! An encoder whose output of every request holds the request id, once per input token.
+    AsyncEncoderRunner::EnqueueFn makeEncoder()
+    {
+        return [this](AsyncEncoderRunner::Batch const& batch, CudaStream const& stream)
+        {
+            ++mNumBatches;
+            BufferManager manager{std::make_shared<CudaStream>(stream.get())};
+            std::vector<ITensor::SharedPtr> outputs;
+            for (SizeType32 i = 0; i < batch.getBatchSize(); ++i)
+            {
+                auto const length = batch.inputLengths[i];
+                std::vector<std::int32_t> values(length, static_cast<std::int32_t>(batch.requestIds[i]));
+                outputs.push_back(manager.copyFrom(values, ITensor::makeShape({length}), MemoryType::kGPU));
+            }
+            return outputs;
+        };
+    }
+
+    std::shared_ptr<CudaStream> mEncoderStream;
+    std::shared_ptr<CudaStream> mDecoderStream;
+    SizeType32 mNumBatches{0};
+};
+
+TEST_F(AsyncEncoderRunnerTest, HandsOverFinishedBatchesInOrder)
+{
+    AsyncEncoderRunner::Config config;
+    config.scheduler.maxNumTokens = 16;
+    config.maxBatchesInFlight = 2;
+    AsyncEncoderRunner runner{config, mEncoderStream, makeEncoder()};
+    runner.enqueue(1, 10);
+    runner.enqueue(2, 10);
+    runner.enqueue(3, 4);
+    runner.enqueue(4, 12);
+
+    // 1 and 3 fill the first batch, 2 the second, 4 waits for a batch to finish
+    EXPECT_EQ(runner.launch(), 2);
+    EXPECT_EQ(runner.getNumBatchesInFlight(), 2);
+    EXPECT_EQ(runner.getNumQueuedRequests(), 1);
+    EXPECT_EQ(runner.launch(), 0);
+
+    auto finished = runner.takeFinished(*mDecoderStream, true);
+    ASSERT_GE(finished.size(), 2);
+    EXPECT_EQ(finished[0].requestId, 1);
+    EXPECT_EQ(finished[1].requestId, 3);
+    EXPECT_EQ(runner.launch(), 1);
+    while (runner.getNumBatchesInFlight() > 0)
+    {
+        auto more = runner.takeFinished(*mDecoderStream, true);
+        finished.insert(finished.end(), more.begin(), more.end());
+    }
+    ASSERT_EQ(finished.size(), 4);
+    EXPECT_EQ(finished[2].requestId, 2);
+    EXPECT_EQ(finished[3].requestId, 4);
+    EXPECT_EQ(mNumBatches, 3);
+
+    // The decoder stream reads the outputs where the encoder wrote them
+    BufferManager decoderManager{mDecoderStream};
+    for (auto const& request : finished)
+    {
+        auto const host = decoderManager.copyFrom(*request.encoderOutput, MemoryType::kCPU);
+        mDecoderStream->synchronize();
+        for (auto const value : BufferRange<std::int32_t const>(*host))
+        {
+            EXPECT_EQ(value, static_cast<std::int32_t>(request.requestId));
+        }
+    }
+}
+
+TEST_F(AsyncEncoderRunnerTest, NonBlockingWithNothingInFlight)
+{
+    AsyncEncoderRunner runner{AsyncEncoderRunner::Config{}, mEncoderStream, makeEncoder()};
+    EXPECT_TRUE(runner.takeFinished(*mDecoderStream, true).empty());
+    EXPECT_EQ(runner.launch(), 0);
+    EXPECT_EQ(mNumBatches, 0);
+}
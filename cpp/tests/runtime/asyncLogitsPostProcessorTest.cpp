@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/asyncLogitsPostProcessor.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+namespace tensorrt_llm::runtime
+{
+
+TEST(AsyncLogitsPostProcessorTest, SamplingWaitsForCallbackWork)
+{
+    auto runtimeStream = std::make_shared<CudaStream>();
+    BufferManager manager{runtimeStream};
+    std::shared_ptr<ITensor> logits = manager.gpu(ITensor::makeShape({2, 8}), nvinfer1::DataType::kFLOAT);
+    manager.setZero(*logits);
+
+    std::vector<executor::IdType> seenIds;
+    std::thread signaler;
+    AsyncLogitsPostProcessor processor{
+        [&](std::vector<executor::IdType> const& reqIds, std::vector<executor::Tensor>& tensors,
+            std::vector<std::reference_wrapper<executor::BeamTokens const>> const&, executor::StreamPtr const& stream,
+            std::vector<std::optional<executor::IdType>> const&, executor::LogitsPostProcessorDone const& done)
+        {
+            seenIds = reqIds;
+            // Finish from another thread after some host-side processing
+            signaler = std::thread(
+                [&tensors, stream, done]()
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    auto& tensor = tensors.front();
+                    TLLM_CUDA_CHECK(cudaMemsetAsync(tensor.getData(), 0xff, tensor.getSizeInBytes(), stream->get()));
+                    done();
+                });
+        }};
+
+    executor::BeamTokens const beamTokens{{1, 2, 3}};
+    processor.launch({42}, {executor::detail::ofITensor(logits)}, {std::cref(beamTokens)}, {std::nullopt},
+        *runtimeStream);
+    EXPECT_TRUE(processor.isPending());
+    processor.wait(*runtimeStream);
+    EXPECT_FALSE(processor.isPending());
+    signaler.join();
+    EXPECT_EQ(seenIds, (std::vector<executor::IdType>{42}));
+
+    auto hostLogits = manager.copyFrom(*logits, MemoryType::kCPU);
+    runtimeStream->synchronize();
+    auto const* data = reinterpret_cast<std::uint32_t const*>(bufferCast<float>(*hostLogits));
+    for (std::size_t i = 0; i < hostLogits->getSize(); ++i)
+    {
+        EXPECT_EQ(data[i], 0xffffffffu);
+    }
+}
+
+TEST(AsyncLogitsPostProcessorTest, RethrowsCallbackError)
+{
+    CudaStream runtimeStream;
+    AsyncLogitsPostProcessor processor{[](auto const&, auto&, auto const&, auto const&, auto const&, auto const&)
+        { throw std::runtime_error("post processor failed"); }};
+    processor.launch({}, {}, {}, {}, runtimeStream);
+    EXPECT_THROW(processor.wait(runtimeStream), std::runtime_error);
+    EXPECT_FALSE(processor.isPending());
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/batchLimitTuner.h"
+
+#include <gtest/gtest.h>
+
+#include <functional>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+namespace tle = tensorrt_llm::executor;
+
+using Sample = BatchLimitTuner::IterationSample;
+
+//! Run a window of iterations with samples of the current limits, returns the decision at its end.
+tle::BatchLimitDecision runWindow(
+    BatchLimitTuner& tuner, SizeType32 interval, std::function<Sample(BatchLimitTuner::Limits const&)> const& sample)
+{
+    auto decision = tle::BatchLimitDecision::kKEEP;
+    for (SizeType32 i = 0; i < interval; ++i)
+    {
+        decision = tuner.onIteration(sample(tuner.getLimits()));
+    }
+    return decision;
+}
+
+//! A saturated batch whose iteration latency grows with the batch size.
+Sample fullBatch(BatchLimitTuner::Limits const& limits, double msPerRequest, double fixedMS = 0.0)
+{
+    Sample sample;
+    sample.numScheduledRequests = limits.maxBatchSize;
+    sample.numTokens = limits.maxBatchSize;
+    sample.numQueuedRequests = 10;
+    sample.iterLatencyMS = fixedMS + msPerRequest * limits.maxBatchSize;
+    sample.kvCacheUtilization = 0.5F;
+    return sample;
+}
+} // namespace
+
+TEST(BatchLimitTunerTest, StartsAtEngineLimits)
+{
+    BatchLimitTuner tuner{tle::BatchLimitTuningConfig{}, 64, 8192};
+    EXPECT_EQ(tuner.getLimits().maxBatchSize, 64);
+    EXPECT_EQ(tuner.getLimits().maxNumTokens, 8192);
+
+    // The throughput objective does not leave the engine limits while throughput holds
+    for (int window = 0; window < 4; ++window)
+    {
+        EXPECT_EQ(runWindow(tuner, 16, [](auto const& limits) { return fullBatch(limits, 0.1, 5.0); }),
+            tle::BatchLimitDecision::kKEEP);
+    }
+    EXPECT_EQ(tuner.getLimits().maxBatchSize, 64);
+
+    EXPECT_EQ(tuner.getAppliedLimits().maxBatchSize, 64);
+    EXPECT_EQ(tuner.getAppliedLimits().maxNumTokens, 8192);
+    EXPECT_EQ(tuner.getLastDecision(), tle::BatchLimitDecision::kKEEP);
+}
+
+TEST(BatchLimitTunerTest, LowersOnKvCachePressure)
+{
+    BatchLimitTuner tuner{tle::BatchLimitTuningConfig{}, 64, 8192};
+    auto const decision = runWindow(tuner, 16,
+        [](auto const& limits)
+        {
+            auto sample = fullBatch(limits, 0.1);
+            sample.numPausedRequests = 1;
+            return sample;
+        });
+    EXPECT_EQ(decision, tle::BatchLimitDecision::kLOWER_KV_PRESSURE);
+    EXPECT_EQ(tuner.getLimits().maxBatchSize, 48);
+    EXPECT_EQ(tuner.getLimits().maxNumTokens, 6144);
+
+    // The last iteration still ran with the previous limits
+    EXPECT_EQ(tuner.getAppliedLimits().maxBatchSize, 64);
+    EXPECT_EQ(tuner.getLastDecision(), tle::BatchLimitDecision::kLOWER_KV_PRESSURE);
+
+    // Once the pressure is gone, the throughput objective climbs back
+    EXPECT_EQ(runWindow(tuner, 16, [](auto const& limits) { return fullBatch(limits, 0.1, 5.0); }),
+        tle::BatchLimitDecision::kRAISE);
+    EXPECT_EQ(tuner.getLimits().maxBatchSize, 54);
+}
+
+TEST(BatchLimitTunerTest, LatencyBound)
+{
+    tle::BatchLimitTuningConfig const config{tle::BatchLimitTuningObjective::kLATENCY_BOUND, 20.F, 8};
+    BatchLimitTuner tuner{config, 128, std::nullopt};
+    // 0.25 ms per request, 80 requests meet the target
+    auto const sample = [](auto const& limits) { return fullBatch(limits, 0.25); };
+    EXPECT_EQ(runWindow(tuner, 8, sample), tle::BatchLimitDecision::kLOWER_LATENCY);
+    EXPECT_EQ(tuner.getLimits().maxBatchSize, 80);
+    EXPECT_FALSE(tuner.getLimits().maxNumTokens.has_value());
+
+    // Within 90% of the target the limits stay
+    EXPECT_EQ(runWindow(tuner, 8, sample), tle::BatchLimitDecision::kKEEP);
+
+    // A cheaper mix lets the limits grow up to the engine limit
+    auto const cheap = [](auto const& limits) { return fullBatch(limits, 0.1); };
+    EXPECT_EQ(runWindow(tuner, 8, cheap), tle::BatchLimitDecision::kRAISE);
+    EXPECT_EQ(tuner.getLimits().maxBatchSize, 90);
+    for (int window = 0; window < 8; ++window)
+    {
+        runWindow(tuner, 8, cheap);
+    }
+    EXPECT_EQ(tuner.getLimits().maxBatchSize, 128);
+}
+
+TEST(BatchLimitTunerTest, KeepsLimitsWithoutQueuedRequests)
+{
+    tle::BatchLimitTuningConfig const config{tle::BatchLimitTuningObjective::kLATENCY_BOUND, 50.F, 4};
+    BatchLimitTuner tuner{config, 64, 4096};
+    runWindow(tuner, 4,
+        [](auto const& limits)
+        {
+            auto sample = fullBatch(limits, 1.0);
+            sample.numQueuedRequests = 0;
+            return sample;
+        });
+    EXPECT_EQ(tuner.getLimits().maxBatchSize, 50);
+    // Not full, so the headroom below the target carries no signal
+    EXPECT_EQ(runWindow(tuner, 4,
+                  [](auto const& limits)
+                  {
+                      auto sample = fullBatch(limits, 0.1);
+                      sample.numQueuedRequests = 0;
+                      return sample;
+                  }),
+        tle::BatchLimitDecision::kKEEP);
+    EXPECT_EQ(tuner.getLimits().maxBatchSize, 50);
+}
+
+TEST(BatchLimitTunerTest, ThroughputHillClimbing)
+{
+    tle::BatchLimitTuningConfig const config{
+        tle::BatchLimitTuningObjective::kMAX_THROUGHPUT, std::nullopt, 4, 0.95F, 8, 64};
+    BatchLimitTuner tuner{config, 64, std::nullopt};
+    // Throughput peaks around 32 requests, beyond which e.g. the attention cost of long sequences dominates
+    auto const sample = [](auto const& limits)
+    {
+        auto result = fullBatch(limits, 0.0, 10.0);
+        auto const excess = std::max(0, limits.maxBatchSize - 32);
+        result.iterLatencyMS += 0.05 * excess * excess;
+        return result;
+    };
+    // First window at the engine limit only sets the baseline
+    EXPECT_EQ(runWindow(tuner, 4, sample), tle::BatchLimitDecision::kKEEP);
+    // A drop of the throughput at the engine limit, e.g. after the mix changed, starts lowering
+    tle::BatchLimitDecision decision{};
+    decision = runWindow(tuner, 4,
+        [&](auto const& limits)
+        {
+            auto result = sample(limits);
+            result.iterLatencyMS *= 1.5;
+            return result;
+        });
+    EXPECT_EQ(decision, tle::BatchLimitDecision::kLOWER_THROUGHPUT);
+    for (int window = 0; window < 32; ++window)
+    {
+        runWindow(tuner, 4, sample);
+    }
+    // Settles near the peak, never at the bounds
+    EXPECT_GE(tuner.getLimits().maxBatchSize, 24);
+    EXPECT_LE(tuner.getLimits().maxBatchSize, 48);
+}
+
+TEST(BatchLimitTunerTest, InvalidConfig)
+{
+    EXPECT_THROW(tle::BatchLimitTuningConfig(tle::BatchLimitTuningObjective::kLATENCY_BOUND), std::exception);
+    EXPECT_THROW(
+        tle::BatchLimitTuningConfig(tle::BatchLimitTuningObjective::kMAX_THROUGHPUT, std::nullopt, 0), std::exception);
+    EXPECT_THROW(tle::BatchLimitTuningConfig(tle::BatchLimitTuningObjective::kMAX_THROUGHPUT, std::nullopt, 16, 1.5F),
+        std::exception);
+}
+
+} // namespace tensorrt_llm::runtime
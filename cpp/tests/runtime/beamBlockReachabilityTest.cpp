@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/runtime/beamBlockReachability.h"
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+SizeType32 constexpr kBeamWidth = 3;
+SizeType32 constexpr kMaxAttentionWindow = 16;
+SizeType32 constexpr kTokensPerBlock = 4;
+
+//! Indirection of beams whose tokens before switchToken come from the beam at the same index in sources
+std::vector<SizeType32> makeIndirection(std::vector<SizeType32> const& sources, SizeType32 switchToken)
+{
+    std::vector<SizeType32> indirection(kBeamWidth * kMaxAttentionWindow);
+    for (SizeType32 beam = 0; beam < kBeamWidth; ++beam)
+    {
+        for (SizeType32 token = 0; token < kMaxAttentionWindow; ++token)
+        {
+            indirection[beam * kMaxAttentionWindow + token] = token < switchToken ? sources[beam] : beam;
+        }
+    }
+    return indirection;
+}
+
+} // namespace
+
+TEST(BeamBlockReachabilityTest, FindsBlocksOfPrunedBeams)
+{
+    // Beam 2 was pruned at token 8, beams 1 and 2 continue from beam 0
+    auto const indirection = makeIndirection({0, 0, 0}, 8);
+    auto const reachable
+        = BeamBlockReachability::compute(indirection.data(), kBeamWidth, kMaxAttentionWindow, 10, kTokensPerBlock);
+    // Only the blocks before the block of the last token are considered
+    ASSERT_EQ(reachable.size(), 2);
+    for (auto const& beams : reachable)
+    {
+        EXPECT_EQ(beams, (std::vector<bool>{true, false, false}));
+    }
+}
+
+TEST(BeamBlockReachabilityTest, KeepsBlocksOfLiveBeams)
+{
+    auto const indirection = makeIndirection({0, 1, 1}, 8);
+    auto const reachable
+        = BeamBlockReachability::compute(indirection.data(), kBeamWidth, kMaxAttentionWindow, 13, kTokensPerBlock);
+    ASSERT_EQ(reachable.size(), 3);
+    EXPECT_EQ(reachable[0], (std::vector<bool>{true, true, false}));
+    EXPECT_EQ(reachable[1], (std::vector<bool>{true, true, false}));
+    // Every beam reads its own blocks after the switch
+    EXPECT_EQ(reachable[2], (std::vector<bool>{true, true, true}));
+}
+
+TEST(BeamBlockReachabilityTest, IgnoresFinishedBeams)
+{
+    auto const indirection = makeIndirection({0, 1, 2}, 8);
+    auto const reachable = BeamBlockReachability::compute(
+        indirection.data(), kBeamWidth, kMaxAttentionWindow, 9, kTokensPerBlock, {false, true, false});
+    ASSERT_EQ(reachable.size(), 2);
+    EXPECT_EQ(reachable[0], (std::vector<bool>{true, false, true}));
+}
+
+TEST(BeamBlockReachabilityTest, SkipsCyclicCachesAndSingleBeams)
+{
+    auto const indirection = makeIndirection({0, 0, 0}, 8);
+    auto const cyclic = BeamBlockReachability::compute(
+        indirection.data(), kBeamWidth, kMaxAttentionWindow, kMaxAttentionWindow + 1, kTokensPerBlock);
+    EXPECT_TRUE(cyclic.empty());
+    auto const single
+        = BeamBlockReachability::compute(indirection.data(), 1, kMaxAttentionWindow, 10, kTokensPerBlock);
+    EXPECT_TRUE(single.empty());
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/blockPoolCompaction.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+using Slot = BlockPoolCompaction::SlotState;
+using Move = BlockPoolCompaction::Move;
+
+auto constexpr F = Slot::kFREE;
+auto constexpr M = Slot::kMOVABLE;
+auto constexpr P = Slot::kPINNED;
+} // namespace
+
+TEST(BlockPoolCompactionTest, FullCompaction)
+{
+    std::vector<Slot> slots{M, F, F, M, F, M, M};
+    EXPECT_EQ(BlockPoolCompaction::getNumOccupiedSlots(slots), 4);
+    EXPECT_EQ(BlockPoolCompaction::getMinNumSlots(slots), 7);
+
+    auto const moves = BlockPoolCompaction::plan(slots, 10);
+    EXPECT_EQ(moves, (std::vector<Move>{{6, 1}, {5, 2}}));
+
+    BlockPoolCompaction::apply(slots, moves);
+    EXPECT_EQ(slots, (std::vector<Slot>{M, M, M, M, F, F, F}));
+    EXPECT_EQ(BlockPoolCompaction::getMinNumSlots(slots), 4);
+    EXPECT_TRUE(BlockPoolCompaction::plan(slots, 10).empty());
+}
+
+TEST(BlockPoolCompactionTest, IncrementalPasses)
+{
+    std::vector<Slot> slots{F, F, F, M, M, M};
+    auto moves = BlockPoolCompaction::plan(slots, 1);
+    EXPECT_EQ(moves, (std::vector<Move>{{5, 0}}));
+    BlockPoolCompaction::apply(slots, moves);
+
+    moves = BlockPoolCompaction::plan(slots, 1);
+    EXPECT_EQ(moves, (std::vector<Move>{{4, 1}}));
+    BlockPoolCompaction::apply(slots, moves);
+    EXPECT_EQ(BlockPoolCompaction::getMinNumSlots(slots), 4);
+}
+
+TEST(BlockPoolCompactionTest, PinnedBlocksStay)
+{
+    std::vector<Slot> slots{F, M, F, P, M};
+    auto const moves = BlockPoolCompaction::plan(slots, 10);
+    EXPECT_EQ(moves, (std::vector<Move>{{4, 0}}));
+    BlockPoolCompaction::apply(slots, moves);
+    // The pinned block keeps the pool from shrinking below 4 slots
+    EXPECT_EQ(BlockPoolCompaction::getMinNumSlots(slots), 4);
+    EXPECT_TRUE(BlockPoolCompaction::plan(slots, 10).empty());
+}
+
+TEST(BlockPoolCompactionTest, ShrinkTarget)
+{
+    std::vector<Slot> slots{M, F, F, F, M, F, M, F};
+    auto const moves = BlockPoolCompaction::plan(slots, 10, 4);
+    EXPECT_EQ(moves, (std::vector<Move>{{6, 1}, {4, 2}}));
+    BlockPoolCompaction::apply(slots, moves);
+    EXPECT_EQ(BlockPoolCompaction::getMinNumSlots(slots), 3);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/blockPrefixTree.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+VecUniqueTokens makeTokens(std::vector<TokenIdType> const& ids)
+{
+    VecUniqueTokens tokens;
+    for (auto const id : ids)
+    {
+        tokens.push_back(UniqueToken{id, 0});
+    }
+    return tokens;
+}
+
+} // namespace
+
+TEST(BlockPrefixTreeTest, FullBlockMatch)
+{
+    BlockPrefixTree tree{4};
+    EXPECT_EQ(tree.insert(0, makeTokens({0, 1, 2, 3, 4, 5, 6, 7, 8}), {10, 11, 12}), 3);
+    EXPECT_EQ(tree.getNumBlocks(), 3);
+
+    auto const match = tree.findLongestPrefix(0, makeTokens({0, 1, 2, 3, 4, 5, 6, 7, 9, 9}));
+    EXPECT_EQ(match.blockIds, (std::vector<BlockPrefixTree::BlockIdType>{10, 11}));
+    EXPECT_FALSE(match.partialBlockId.has_value());
+    EXPECT_EQ(match.getNumMatchedTokens(tree.getTokensPerBlock()), 8);
+}
+
+TEST(BlockPrefixTreeTest, PartialBlockMatch)
+{
+    BlockPrefixTree tree{4};
+    tree.insert(0, makeTokens({0, 1, 2, 3, 4, 5, 6, 7}), {10, 11});
+    tree.insert(0, makeTokens({0, 1, 2, 3, 4, 8, 9, 9}), {20, 21});
+    // The first block is shared, only the second one was added
+    EXPECT_EQ(tree.getNumBlocks(), 3);
+
+    auto const match = tree.findLongestPrefix(0, makeTokens({0, 1, 2, 3, 4, 5, 6, 9}));
+    EXPECT_EQ(match.blockIds, (std::vector<BlockPrefixTree::BlockIdType>{10}));
+    ASSERT_TRUE(match.partialBlockId.has_value());
+    EXPECT_EQ(*match.partialBlockId, 11);
+    EXPECT_EQ(match.numPartialTokens, 3);
+    EXPECT_EQ(match.getNumMatchedTokens(tree.getTokensPerBlock()), 7);
+
+    // The query ends inside a block
+    auto const shortMatch = tree.findLongestPrefix(0, makeTokens({0, 1}));
+    EXPECT_TRUE(shortMatch.blockIds.empty());
+    EXPECT_EQ(shortMatch.partialBlockId, 10);
+    EXPECT_EQ(shortMatch.numPartialTokens, 2);
+}
+
+TEST(BlockPrefixTreeTest, LoraTasksAreSeparate)
+{
+    BlockPrefixTree tree{2};
+    tree.insert(1, makeTokens({0, 1}), {10});
+
+    EXPECT_EQ(tree.findLongestPrefix(1, makeTokens({0, 1})).blockIds.size(), 1);
+    auto const match = tree.findLongestPrefix(2, makeTokens({0, 1}));
+    EXPECT_TRUE(match.blockIds.empty());
+    EXPECT_FALSE(match.partialBlockId.has_value());
+}
+
+TEST(BlockPrefixTreeTest, RemoveLeaf)
+{
+    BlockPrefixTree tree{2};
+    tree.insert(0, makeTokens({0, 1, 2, 3}), {10, 11});
+
+    EXPECT_FALSE(tree.isLeaf(10));
+    EXPECT_FALSE(tree.removeLeaf(10));
+    EXPECT_TRUE(tree.removeLeaf(11));
+    EXPECT_TRUE(tree.isLeaf(10));
+    EXPECT_TRUE(tree.removeLeaf(10));
+    EXPECT_EQ(tree.getNumBlocks(), 0);
+    EXPECT_FALSE(tree.removeLeaf(10));
+
+    auto const match = tree.findLongestPrefix(0, makeTokens({0, 1, 2, 3}));
+    EXPECT_TRUE(match.blockIds.empty());
+}
+
+TEST(BlockPrefixTreeTest, ExtraIdsDistinguishTokens)
+{
+    BlockPrefixTree tree{2};
+    VecUniqueTokens tokens{UniqueToken{0, 0}, UniqueToken{1, 7}};
+    tree.insert(0, tokens, {10});
+
+    VecUniqueTokens other{UniqueToken{0, 0}, UniqueToken{1, 8}};
+    auto const match = tree.findLongestPrefix(0, other);
+    EXPECT_TRUE(match.blockIds.empty());
+    EXPECT_EQ(match.partialBlockId, 10);
+    EXPECT_EQ(match.numPartialTokens, 1);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/cancellationQueue.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+using RequestIds = std::vector<CancellationQueue::RequestIdType>;
+} // namespace
+
+TEST(CancellationQueueTest, TakesKnownRequests)
+{
+    CancellationQueue queue{};
+    EXPECT_FALSE(queue.hasPending());
+    EXPECT_TRUE(queue.takeCancelled({1, 2, 3}).empty());
+
+    queue.cancel(3);
+    queue.cancel(1);
+    EXPECT_TRUE(queue.hasPending());
+    EXPECT_EQ(queue.takeCancelled({1, 2, 3}), (RequestIds{1, 3}));
+    EXPECT_FALSE(queue.hasPending());
+    EXPECT_EQ(queue.getNumTaken(), 2U);
+
+    // Taken once
+    EXPECT_TRUE(queue.takeCancelled({1, 2, 3}).empty());
+}
+
+TEST(CancellationQueueTest, UnknownRequestsExpire)
+{
+    CancellationQueue queue{2};
+    queue.cancel(7);
+    EXPECT_TRUE(queue.takeCancelled({1}).empty());
+    EXPECT_TRUE(queue.hasPending());
+    // Request 7 shows up in the second pass
+    EXPECT_EQ(queue.takeCancelled({1, 7}), (RequestIds{7}));
+
+    queue.cancel(8);
+    EXPECT_TRUE(queue.takeCancelled({1}).empty());
+    EXPECT_TRUE(queue.takeCancelled({1}).empty());
+    EXPECT_FALSE(queue.hasPending());
+    EXPECT_TRUE(queue.takeCancelled({8}).empty());
+}
+
+TEST(CancellationQueueTest, CancelFromManyThreads)
+{
+    CancellationQueue queue{};
+    std::vector<std::thread> threads;
+    for (CancellationQueue::RequestIdType t = 0; t < 4; ++t)
+    {
+        threads.emplace_back(
+            [&queue, t]
+            {
+                for (CancellationQueue::RequestIdType i = 0; i < 100; ++i)
+                {
+                    queue.cancel(t * 100 + i);
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    RequestIds known(400);
+    for (CancellationQueue::RequestIdType i = 0; i < known.size(); ++i)
+    {
+        known[i] = i;
+    }
+    EXPECT_EQ(queue.takeCancelled(known), known);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/contextParallelPlan.h"
+
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+using ChunkMask = ContextParallelPlan::ChunkMask;
+
+TEST(ContextParallelPlanTest, ShardsTheSequenceInZigzag)
+{
+    ContextParallelPlan const plan(4, 1);
+    // 8 chunks of 100 tokens, rank 1 holds chunks 1 and 6
+    auto const ranges = plan.getLocalTokenRanges(800);
+    EXPECT_EQ(ranges[0].begin, 100);
+    EXPECT_EQ(ranges[0].end, 200);
+    EXPECT_EQ(ranges[1].begin, 600);
+    EXPECT_EQ(ranges[1].end, 700);
+    EXPECT_EQ(plan.getSendRank(), 2);
+    EXPECT_EQ(plan.getRecvRank(), 0);
+}
+
+TEST(ContextParallelPlanTest, CoversEveryTokenOnce)
+{
+    for (SizeType32 const sequenceLength : {1, 7, 8, 1001})
+    {
+        ContextParallelPlan const plan(4, 0);
+        std::vector<int> owners(sequenceLength, 0);
+        SizeType32 numTokens{0};
+        for (SizeType32 rank = 0; rank < 4; ++rank)
+        {
+            for (auto const& range : plan.getTokenRanges(sequenceLength, rank))
+            {
+                for (SizeType32 token = range.begin; token < range.end; ++token)
+                {
+                    ++owners[token];
+                }
+            }
+            numTokens += ContextParallelPlan(4, rank).getNumLocalTokens(sequenceLength);
+        }
+        EXPECT_EQ(numTokens, sequenceLength);
+        for (auto const owner : owners)
+        {
+            EXPECT_EQ(owner, 1) << "sequence length " << sequenceLength;
+        }
+    }
+}
+
+TEST(ContextParallelPlanTest, BalancesCausalWork)
+{
+    SizeType32 constexpr cpSize = 4;
+    std::vector<int> work(cpSize, 0);
+    for (SizeType32 rank = 0; rank < cpSize; ++rank)
+    {
+        ContextParallelPlan const plan(cpSize, rank);
+        auto const& steps = plan.getRingSteps();
+        ASSERT_EQ(steps.size(), cpSize);
+        EXPECT_EQ(steps[0].kvRank, rank);
+        std::vector<bool> seen(cpSize, false);
+        for (auto const& step : steps)
+        {
+            seen[step.kvRank] = true;
+            for (auto const& row : step.masks)
+            {
+                for (auto const mask : row)
+                {
+                    // A causal pair is half the work of a full one
+                    work[rank] += mask == ChunkMask::kFULL ? 2 : mask == ChunkMask::kCAUSAL ? 1 : 0;
+                }
+            }
+        }
+        EXPECT_EQ(seen, std::vector<bool>(cpSize, true));
+    }
+    for (SizeType32 rank = 1; rank < cpSize; ++rank)
+    {
+        EXPECT_EQ(work[rank], work[0]);
+    }
+}
+
+TEST(ContextParallelPlanTest, LocalStepIsCausal)
+{
+    ContextParallelPlan const plan(2, 0);
+    // Chunks 0 and 3 against themselves
+    auto const& local = plan.getRingSteps()[0];
+    EXPECT_EQ(local.masks[0][0], ChunkMask::kCAUSAL);
+    EXPECT_EQ(local.masks[0][1], ChunkMask::kNONE);
+    EXPECT_EQ(local.masks[1][0], ChunkMask::kFULL);
+    EXPECT_EQ(local.masks[1][1], ChunkMask::kCAUSAL);
+    // Chunks 0 and 3 against chunks 1 and 2 of rank 1
+    auto const& remote = plan.getRingSteps()[1];
+    EXPECT_EQ(remote.kvRank, 1);
+    EXPECT_EQ(remote.masks[0][0], ChunkMask::kNONE);
+    EXPECT_EQ(remote.masks[0][1], ChunkMask::kNONE);
+    EXPECT_EQ(remote.masks[1][0], ChunkMask::kFULL);
+    EXPECT_EQ(remote.masks[1][1], ChunkMask::kFULL);
+
+    EXPECT_THROW(ContextParallelPlan(2, 2), tensorrt_llm::common::TllmException);
+}
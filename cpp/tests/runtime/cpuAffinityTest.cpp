@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/executor/executor.h"
+#include "tensorrt_llm/runtime/cpuAffinity.h"
+
+#include <map>
+#include <thread>
+
+using namespace tensorrt_llm::runtime;
+namespace tle = tensorrt_llm::executor;
+
+TEST(CpuAffinityTest, ResolvesConfiguredCpusWithinAllowedSet)
+{
+    auto const allowed = CpuAffinity::getCurrentThreadCpus();
+    ASSERT_FALSE(allowed.empty());
+
+    // CPUs the process may not use are dropped, duplicates are merged
+    tle::CpuAffinityConfig const config{{{0, {allowed.front(), allowed.front(), 1 << 20}}}};
+    EXPECT_EQ(CpuAffinity::resolve(config, 0), std::vector<std::int32_t>{allowed.front()});
+
+    tle::CpuAffinityConfig const unavailable{{{0, {1 << 20}}}};
+    EXPECT_TRUE(CpuAffinity::resolve(unavailable, 0).empty());
+}
+
+TEST(CpuAffinityTest, PinsThreadAndItsChildren)
+{
+    auto const allowed = CpuAffinity::getCurrentThreadCpus();
+    ASSERT_FALSE(allowed.empty());
+    std::vector<std::int32_t> const target{allowed.back()};
+
+    std::vector<std::int32_t> pinned;
+    std::vector<std::int32_t> inherited;
+    std::thread thread(
+        [&]
+        {
+            ASSERT_TRUE(CpuAffinity::pinCurrentThread(target));
+            pinned = CpuAffinity::getCurrentThreadCpus();
+            std::thread child([&] { inherited = CpuAffinity::getCurrentThreadCpus(); });
+            child.join();
+        });
+    thread.join();
+    EXPECT_EQ(pinned, target);
+    EXPECT_EQ(inherited, target);
+    // The calling thread is not affected
+    EXPECT_EQ(CpuAffinity::getCurrentThreadCpus(), allowed);
+}
+
+TEST(CpuAffinityTest, RejectsEmptyCpuList)
+{
+    std::map<tle::SizeType32, std::vector<tle::SizeType32>> const deviceCpus{{0, {}}};
+    EXPECT_THROW(tle::CpuAffinityConfig{deviceCpus}, std::exception);
+    EXPECT_FALSE(CpuAffinity::pinCurrentThread({}));
+}
+
+TEST(CpuAffinityTest, PinnedMemoryNode)
+{
+    EXPECT_FALSE(CpuAffinity::getPinnedMemoryNode().has_value());
+    {
+        ScopedNumaPreference const preference{std::nullopt};
+        EXPECT_FALSE(preference.isActive());
+    }
+
+    CpuAffinity::setPinnedMemoryNode(0);
+    EXPECT_EQ(CpuAffinity::getPinnedMemoryNode(), 0);
+    {
+        // Node 0 exists on every host, the preference only fails without memory policy support
+        ScopedNumaPreference const preference{CpuAffinity::getPinnedMemoryNode()};
+        std::vector<char> pages(1 << 20, 1);
+        EXPECT_EQ(pages.back(), 1);
+    }
+    CpuAffinity::setPinnedMemoryNode(std::nullopt);
+    EXPECT_FALSE(CpuAffinity::getPinnedMemoryNode().has_value());
+}
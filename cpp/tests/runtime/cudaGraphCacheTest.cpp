@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/cudaGraphCache.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+TEST(CudaGraphCacheTest, Buckets)
+{
+    EXPECT_EQ(CudaGraphCache::getDefaultBuckets(1), (std::vector<SizeType32>{1}));
+    EXPECT_EQ(CudaGraphCache::getDefaultBuckets(6), (std::vector<SizeType32>{1, 2, 4, 6}));
+    EXPECT_EQ(CudaGraphCache::getDefaultBuckets(20), (std::vector<SizeType32>{1, 2, 4, 8, 16, 20}));
+
+    CudaGraphCache cache{{8, 1, 4, 4}, 4};
+    EXPECT_EQ(cache.getBatchSizeBuckets(), (std::vector<SizeType32>{1, 4, 8}));
+    EXPECT_EQ(cache.getPaddedBatchSize(1).value(), 1);
+    EXPECT_EQ(cache.getPaddedBatchSize(3).value(), 4);
+    EXPECT_EQ(cache.getPaddedBatchSize(8).value(), 8);
+    EXPECT_FALSE(cache.getPaddedBatchSize(9).has_value());
+}
+
+TEST(CudaGraphCacheTest, LeastRecentlyUsedEviction)
+{
+    CudaGraphCache cache{{1, 2, 4}, 2};
+    CudaGraphKey const key1{1, 1, 1};
+    CudaGraphKey const key2{2, 1, 1};
+    CudaGraphKey const key4{4, 1, 1};
+    auto const graph1 = std::make_shared<CudaGraphExecutor>();
+    cache.put(key1, graph1);
+    cache.put(key2, std::make_shared<CudaGraphExecutor>());
+    EXPECT_EQ(cache.get(key1), graph1);
+
+    // key2 is the least recently used
+    cache.put(key4, std::make_shared<CudaGraphExecutor>());
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.getNumEvictions(), 1);
+    EXPECT_EQ(cache.get(key2), nullptr);
+    EXPECT_NE(cache.get(key4), nullptr);
+    EXPECT_EQ(cache.get(CudaGraphKey{1, 2, 1}), nullptr);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(CudaGraphCacheTest, CaptureAndLaunch)
+{
+    cudaStream_t stream;
+    ASSERT_EQ(cudaStreamCreate(&stream), cudaSuccess);
+    int* buffer;
+    ASSERT_EQ(cudaMalloc(&buffer, sizeof(int)), cudaSuccess);
+
+    CudaGraphExecutor graph;
+    EXPECT_FALSE(graph.hasInstance());
+    graph.capture(stream, [&]() { cudaMemsetAsync(buffer, 1, sizeof(int), stream); });
+    EXPECT_TRUE(graph.hasInstance());
+    ASSERT_EQ(cudaMemset(buffer, 0, sizeof(int)), cudaSuccess);
+    graph.launch(stream);
+    ASSERT_EQ(cudaStreamSynchronize(stream), cudaSuccess);
+
+    int value{0};
+    ASSERT_EQ(cudaMemcpy(&value, buffer, sizeof(int), cudaMemcpyDeviceToHost), cudaSuccess);
+    EXPECT_EQ(value, 0x01010101);
+
+    // Same topology, the instance is updated in place
+    graph.capture(stream, [&]() { cudaMemsetAsync(buffer, 2, sizeof(int), stream); });
+    graph.launch(stream);
+    ASSERT_EQ(cudaMemcpy(&value, buffer, sizeof(int), cudaMemcpyDeviceToHost), cudaSuccess);
+    EXPECT_EQ(value, 0x02020202);
+
+    graph.clear();
+    cudaFree(buffer);
+    cudaStreamDestroy(stream);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -18,9 +18,14 @@
 #include <gtest/gtest.h>
 
 #include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/envUtils.h"
 #include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/cudaMemPool.h"
 
+#include <limits>
+
 TEST(CudaMemPool, TestPrimaryPoolState)
 {
     auto const deviceCount = tensorrt_llm::common::getDeviceCount();
@@ -52,3 +57,52 @@ TEST(CudaMemPool, TestPrimaryPoolState)
             << "Getting the primary pool for the same device twice should return the same pool.";
     }
 }
+
+TEST(CudaMemPool, TestPoolClasses)
+{
+    using tensorrt_llm::runtime::CudaMemPool;
+    using tensorrt_llm::runtime::MemoryPoolClass;
+
+    auto const primaryConfig = CudaMemPool::getPoolConfig(MemoryPoolClass::kPRIMARY);
+    EXPECT_EQ(primaryConfig.releaseThreshold, std::numeric_limits<std::uint64_t>::max());
+    EXPECT_EQ(primaryConfig.reservedSize, 0);
+
+    CudaMemPool::PoolConfig const copyConfig{std::uint64_t{1} << 20, std::size_t{1} << 21};
+    CudaMemPool::setPoolConfig(MemoryPoolClass::kCOPY, copyConfig);
+    EXPECT_EQ(CudaMemPool::getPoolConfig(MemoryPoolClass::kCOPY).releaseThreshold, copyConfig.releaseThreshold);
+    EXPECT_EQ(CudaMemPool::getPoolConfig(MemoryPoolClass::kCOPY).reservedSize, copyConfig.reservedSize);
+
+    auto const deviceCount = tensorrt_llm::common::getDeviceCount();
+    for (int32_t deviceId = 0; deviceId < deviceCount; deviceId++)
+    {
+        if (!CudaMemPool::supportsMemoryPool(deviceId))
+        {
+            continue;
+        }
+        auto const primaryPool = CudaMemPool::getPoolForDevice(deviceId, MemoryPoolClass::kPRIMARY);
+        ASSERT_NE(primaryPool, nullptr);
+        EXPECT_EQ(primaryPool, CudaMemPool::getPrimaryPoolForDevice(deviceId));
+        EXPECT_THROW(CudaMemPool::setPoolConfig(MemoryPoolClass::kPRIMARY, {}), tensorrt_llm::common::TllmException);
+
+        auto const decoderPool = CudaMemPool::getPoolForDevice(deviceId, MemoryPoolClass::kDECODER);
+        auto const copyPool = CudaMemPool::getPoolForDevice(deviceId, MemoryPoolClass::kCOPY);
+        ASSERT_NE(decoderPool, nullptr);
+        ASSERT_NE(copyPool, nullptr);
+        if (tensorrt_llm::common::getEnvStreamMemPools())
+        {
+            EXPECT_NE(decoderPool->getPool(), primaryPool->getPool());
+            EXPECT_NE(decoderPool->getPool(), copyPool->getPool());
+            // The reservation is kept after the pool synchronized
+            EXPECT_GE(copyPool->memoryPoolReserved(), copyConfig.reservedSize);
+            EXPECT_EQ(copyPool->memoryPoolUsed(), 0);
+        }
+        else
+        {
+            EXPECT_EQ(decoderPool, primaryPool);
+            EXPECT_EQ(copyPool, primaryPool);
+        }
+
+        auto const emergencyPool = CudaMemPool::getPoolForDevice(deviceId, MemoryPoolClass::kEMERGENCY);
+        EXPECT_EQ(emergencyPool != nullptr, tensorrt_llm::common::getEnvEmergencyMemPoolSizeMB().has_value());
+    }
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/dataParallelRouter.h"
+#include "tensorrt_llm/batch_manager/kvCacheEventManager.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+namespace kvc = tensorrt_llm::batch_manager::kv_cache_manager;
+
+constexpr SizeType32 kTokensPerBlock = 4;
+
+VecUniqueTokens makeTokens(TokenIdType first, SizeType32 numTokens)
+{
+    VecUniqueTokens tokens;
+    for (SizeType32 i = 0; i < numTokens; ++i)
+    {
+        tokens.push_back({first + i, 0});
+    }
+    return tokens;
+}
+
+std::deque<executor::KVCacheEvent> makeStoredEvent(VecUniqueTokens const& tokens)
+{
+    executor::KVCacheStoredData stored;
+    for (auto const blockHash : kvc::computeBlockHashes(tokens, kTokensPerBlock, 0))
+    {
+        stored.blocks.push_back(executor::KVCacheStoredBlockData{blockHash});
+    }
+    return {executor::KVCacheEvent{0, stored}};
+}
+
+using Load = DataParallelRouter::RankLoad;
+} // namespace
+
+TEST(DataParallelRouterTest, PrefixAffinity)
+{
+    DataParallelRouter router{2, kTokensPerBlock};
+    router.updateLoad(0, Load{1, 0, 8});
+    router.updateLoad(1, Load{1, 0, 8});
+    router.applyEvents(1, makeStoredEvent(makeTokens(0, 8)));
+
+    auto prompt = makeTokens(0, 10);
+    auto const dispatch = router.route(prompt, 0);
+    EXPECT_EQ(dispatch.rank, 1);
+    EXPECT_EQ(dispatch.numMatchedTokens, 8);
+
+    // Another LoRA task doesn't share the blocks
+    EXPECT_EQ(router.route(prompt, 3).rank, 0);
+}
+
+TEST(DataParallelRouterTest, LoadBalance)
+{
+    DataParallelRouter router{2, kTokensPerBlock};
+    router.updateLoad(0, Load{4, 0, 8});
+    router.updateLoad(1, Load{0, 0, 8, 10, 100});
+    EXPECT_FLOAT_EQ(router.getLoad(0), 0.5F);
+    EXPECT_FLOAT_EQ(router.getLoad(1), 0.9F);
+    EXPECT_EQ(router.route(makeTokens(100, 8), 0).rank, 0);
+
+    // Requests routed since the last update count as load
+    DataParallelRouter idle{2, kTokensPerBlock};
+    idle.updateLoad(0, Load{0, 0, 4});
+    idle.updateLoad(1, Load{0, 0, 4});
+    EXPECT_EQ(idle.route(makeTokens(0, 8), 0).rank, 0);
+    EXPECT_EQ(idle.route(makeTokens(100, 8), 0).rank, 1);
+    EXPECT_EQ(idle.route(makeTokens(200, 8), 0).rank, 0);
+    EXPECT_FLOAT_EQ(idle.getLoad(0), 0.5F);
+    idle.updateLoad(0, Load{0, 0, 4});
+    EXPECT_FLOAT_EQ(idle.getLoad(0), 0.F);
+}
+
+TEST(DataParallelRouterTest, LoadImbalanceOverridesPrefix)
+{
+    DataParallelRouter router{2, kTokensPerBlock};
+    router.updateLoad(0, Load{0, 0, 8});
+    router.updateLoad(1, Load{6, 0, 8});
+    router.applyEvents(1, makeStoredEvent(makeTokens(0, 16)));
+
+    auto const dispatch = router.route(makeTokens(0, 16), 0);
+    EXPECT_EQ(dispatch.rank, 0);
+    EXPECT_EQ(dispatch.numMatchedTokens, 0);
+}
+
+TEST(DataParallelRouterTest, RemovedBlocks)
+{
+    DataParallelRouter router{2, kTokensPerBlock};
+    router.updateLoad(0, Load{0, 0, 8});
+    router.updateLoad(1, Load{1, 0, 8});
+    auto const prompt = makeTokens(0, 12);
+    router.applyEvents(1, makeStoredEvent(prompt));
+    auto const blockHashes = kvc::computeBlockHashes(prompt, kTokensPerBlock, 0);
+    EXPECT_EQ(router.getNumMatchedBlocks(1, blockHashes), 3);
+
+    // Removing the second block leaves only the first one reusable
+    router.applyEvents(1, {executor::KVCacheEvent{1, executor::KVCacheRemovedData{{blockHashes[1]}}}});
+    EXPECT_EQ(router.getNumMatchedBlocks(1, blockHashes), 1);
+
+    router.applyEvents(1, {executor::KVCacheEvent{2, executor::KVCacheRemovedData{{blockHashes[0]}}}});
+    EXPECT_EQ(router.route(prompt, 0).rank, 0);
+}
+
+TEST(DataParallelRouterTest, PendingPrefix)
+{
+    DataParallelRouter router{2, kTokensPerBlock};
+    router.updateLoad(0, Load{0, 0, 64});
+    router.updateLoad(1, Load{0, 0, 64});
+
+    // The second request sharing the prompt follows the first before any event reports its blocks
+    auto const first = router.route(makeTokens(0, 16), 0);
+    EXPECT_EQ(first.numMatchedTokens, 0);
+    auto const second = router.route(makeTokens(0, 20), 0);
+    EXPECT_EQ(second.rank, first.rank);
+    EXPECT_EQ(second.numMatchedTokens, 16);
+}
+
+TEST(DataParallelRouterTest, KVCacheEventManagerEvents)
+{
+    DataParallelRouter router{2, kTokensPerBlock};
+    router.updateLoad(0, Load{1, 0, 8});
+    router.updateLoad(1, Load{1, 0, 8});
+
+    // The events of the KV cache of rank 1: the context blocks with a LoRA task, then a block of the generation
+    kvc::KVCacheEventManager manager{16};
+    LoraTaskIdType constexpr loraTaskId{5};
+    auto const prompt = makeTokens(0, 14);
+    manager.enqueueStoredEvent(makeTokens(0, 8), kTokensPerBlock, loraTaskId);
+    manager.enqueueStoredEvent(makeTokens(0, 12), kTokensPerBlock, loraTaskId, 2);
+    router.applyEvents(1, manager.getEvents());
+
+    auto const blockHashes = kvc::computeBlockHashes(prompt, kTokensPerBlock, loraTaskId);
+    EXPECT_EQ(router.getNumMatchedBlocks(1, blockHashes), 3);
+    EXPECT_EQ(router.getNumMatchedBlocks(0, blockHashes), 0);
+    auto const dispatch = router.route(prompt, loraTaskId);
+    EXPECT_EQ(dispatch.rank, 1);
+    EXPECT_EQ(dispatch.numMatchedTokens, 12);
+
+    manager.enqueueRemovedEvent({blockHashes[2]});
+    router.applyEvents(1, manager.getEvents());
+    EXPECT_EQ(router.getNumMatchedBlocks(1, blockHashes), 2);
+}
+
+TEST(DataParallelRouterTest, ResidentBlocksCapacity)
+{
+    DataParallelRouter router{1, kTokensPerBlock};
+    router.updateLoad(0, Load{0, 0, 8, 4, 4});
+    auto const first = makeTokens(0, 12);
+    auto const second = makeTokens(100, 8);
+    router.applyEvents(0, makeStoredEvent(first));
+    router.applyEvents(0, makeStoredEvent(second));
+
+    // The rank holds 4 blocks, the last block of the least recent sequence is forgotten first
+    auto const firstHashes = kvc::computeBlockHashes(first, kTokensPerBlock, 0);
+    auto const secondHashes = kvc::computeBlockHashes(second, kTokensPerBlock, 0);
+    EXPECT_EQ(router.getNumMatchedBlocks(0, firstHashes), 2);
+    EXPECT_EQ(router.getNumMatchedBlocks(0, secondHashes), 2);
+
+    // Routing a prompt refreshes its blocks
+    auto const dispatch = router.route(makeTokens(0, 8), 0);
+    EXPECT_EQ(dispatch.numMatchedTokens, 8);
+    router.applyEvents(0, makeStoredEvent(makeTokens(200, 4)));
+    EXPECT_EQ(router.getNumMatchedBlocks(0, firstHashes), 2);
+    EXPECT_EQ(router.getNumMatchedBlocks(0, secondHashes), 1);
+
+    // A smaller capacity applies on the next update
+    router.updateLoad(0, Load{0, 0, 8, 2, 2});
+    EXPECT_EQ(router.getNumMatchedBlocks(0, firstHashes), 1);
+    EXPECT_EQ(router.getNumMatchedBlocks(0, secondHashes), 0);
+}
+
+} // namespace tensorrt_llm::runtime
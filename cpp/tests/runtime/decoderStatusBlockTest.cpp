@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/decoderStatusBlock.h"
+#include "tensorrt_llm/runtime/runtimeKernels.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+SizeType32 constexpr kMaxBatchSize = 3;
+
+class DecoderStatusBlockTest : public ::testing::Test
+{
+protected:
+    DecoderStatusBlockTest()
+        : mMemory(DecoderStatusBlock::getBlockSize(kMaxBatchSize) / sizeof(std::uint64_t), 0)
+        , mBlock(kMaxBatchSize, 1, IBuffer::wrap(mMemory))
+    {
+    }
+
+    kernels::DecoderStatusHeader& header(std::uint64_t epoch)
+    {
+        auto* slot = reinterpret_cast<std::uint8_t*>(mMemory.data())
+            + (epoch % 2) * DecoderStatusBlock::getSlotSize(kMaxBatchSize);
+        return *reinterpret_cast<kernels::DecoderStatusHeader*>(slot);
+    }
+
+    //! Write a slot the way invokeWriteDecoderStatus does, optionally stopping before the end epoch
+    void write(std::uint64_t epoch, std::vector<SizeType32> const& finishedSum,
+        std::vector<SizeType32> const& sequenceLengths, bool complete = true)
+    {
+        auto& slot = header(epoch);
+        slot.beginEpoch = epoch;
+        auto* data = reinterpret_cast<SizeType32*>(&slot + 1);
+        std::memcpy(data, finishedSum.data(), kMaxBatchSize * sizeof(SizeType32));
+        std::memcpy(data + kMaxBatchSize, sequenceLengths.data(), kMaxBatchSize * sizeof(SizeType32));
+        if (complete)
+        {
+            slot.endEpoch = epoch;
+        }
+    }
+
+    std::vector<std::uint64_t> mMemory;
+    DecoderStatusBlock mBlock;
+};
+} // namespace
+
+TEST_F(DecoderStatusBlockTest, NothingWritten)
+{
+    EXPECT_FALSE(mBlock.poll());
+    EXPECT_EQ(mBlock.getPolledEpoch(), 0);
+    EXPECT_EQ(mBlock.getFinishedSum(0), 0);
+    EXPECT_ANY_THROW(mBlock.waitFor(1));
+}
+
+TEST_F(DecoderStatusBlockTest, ReadsNewestCompleteSnapshot)
+{
+    write(1, {0, 1, 0}, {5, 6, 7});
+    EXPECT_TRUE(mBlock.poll());
+    EXPECT_EQ(mBlock.getPolledEpoch(), 1);
+    EXPECT_EQ(mBlock.getFinishedSum(1), 1);
+    EXPECT_EQ(mBlock.getSequenceLength(2), 7);
+    EXPECT_FALSE(mBlock.poll());
+
+    // Both slots written since the last poll, the newer one wins
+    write(2, {1, 1, 0}, {6, 6, 8});
+    write(3, {1, 1, 1}, {6, 6, 9});
+    EXPECT_TRUE(mBlock.poll());
+    EXPECT_EQ(mBlock.getPolledEpoch(), 3);
+    EXPECT_EQ(mBlock.getFinishedSum(2), 1);
+    EXPECT_EQ(mBlock.getSequenceLength(2), 9);
+}
+
+TEST_F(DecoderStatusBlockTest, SkipsSnapshotBeingWritten)
+{
+    write(1, {0, 0, 0}, {5, 5, 5});
+    EXPECT_TRUE(mBlock.poll());
+
+    // The device started epoch 3 over the slot of epoch 1 and has not finished it
+    write(3, {1, 0, 0}, {6, 6, 6}, false);
+    EXPECT_FALSE(mBlock.poll());
+    EXPECT_EQ(mBlock.getPolledEpoch(), 1);
+    EXPECT_EQ(mBlock.getFinishedSum(0), 0);
+    EXPECT_EQ(mBlock.getSequenceLength(0), 5);
+
+    // The other slot is complete
+    write(2, {0, 1, 0}, {6, 6, 6});
+    EXPECT_TRUE(mBlock.poll());
+    EXPECT_EQ(mBlock.getPolledEpoch(), 2);
+    EXPECT_EQ(mBlock.getFinishedSum(1), 1);
+
+    // A write that started after the end epoch was read makes the data read in between stale
+    write(4, {1, 1, 1}, {7, 7, 7});
+    header(4).beginEpoch = 6;
+    EXPECT_FALSE(mBlock.poll());
+    EXPECT_EQ(mBlock.getPolledEpoch(), 2);
+}
+
+TEST_F(DecoderStatusBlockTest, BlockTooSmall)
+{
+    std::vector<std::uint64_t> memory(2);
+    EXPECT_ANY_THROW(DecoderStatusBlock(kMaxBatchSize, 1, IBuffer::wrap(memory)));
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/draftTargetSequence.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+TEST(DraftTargetSequenceTest, PartialAcceptance)
+{
+    DraftTargetSequence sequence;
+    EXPECT_EQ(sequence.getNumPendingDraftInputs(), 1);
+
+    sequence.onDrafted(4);
+    EXPECT_EQ(sequence.getNumPendingDraftInputs(), 0);
+    // Drafts 3 and 4 are rejected, the draft model has seen draft 3 but not draft 4
+    auto const rewind = sequence.onVerified(2);
+    EXPECT_EQ(rewind.numTargetTokens, 2);
+    EXPECT_EQ(rewind.numDraftTokens, 1);
+    EXPECT_EQ(sequence.getNumPendingDraftInputs(), 1);
+}
+
+TEST(DraftTargetSequenceTest, FullAcceptance)
+{
+    DraftTargetSequence sequence;
+    sequence.onDrafted(4);
+    auto const rewind = sequence.onVerified(4);
+    EXPECT_EQ(rewind.numTargetTokens, 0);
+    EXPECT_EQ(rewind.numDraftTokens, 0);
+    // Draft 4 and the target token
+    EXPECT_EQ(sequence.getNumPendingDraftInputs(), 2);
+}
+
+TEST(DraftTargetSequenceTest, NoneAccepted)
+{
+    DraftTargetSequence sequence;
+    sequence.onDrafted(3);
+    auto const rewind = sequence.onVerified(0);
+    EXPECT_EQ(rewind.numTargetTokens, 3);
+    EXPECT_EQ(rewind.numDraftTokens, 2);
+    EXPECT_EQ(sequence.getNumPendingDraftInputs(), 1);
+}
+
+TEST(DraftTargetSequenceTest, StepsWithoutDraftsAccumulateInputs)
+{
+    DraftTargetSequence sequence;
+    sequence.onDrafted(0);
+    auto const rewind = sequence.onVerified(0);
+    EXPECT_EQ(rewind.numTargetTokens, 0);
+    EXPECT_EQ(rewind.numDraftTokens, 0);
+    EXPECT_EQ(sequence.getNumPendingDraftInputs(), 2);
+
+    sequence.onDrafted(0);
+    (void) sequence.onVerified(0);
+    EXPECT_EQ(sequence.getNumPendingDraftInputs(), 3);
+
+    sequence.onDrafted(1);
+    EXPECT_EQ(sequence.getNumPendingDraftInputs(), 0);
+    EXPECT_THROW((void) sequence.onVerified(2), std::exception);
+}
+
+TEST(DraftTargetSequenceTest, PlanDraftSteps)
+{
+    auto const steps = planDraftSteps({3, 0, 1, 3});
+    ASSERT_EQ(steps.size(), 3);
+    EXPECT_EQ(steps[0], (std::vector<SizeType32>{0, 2, 3}));
+    EXPECT_EQ(steps[1], (std::vector<SizeType32>{0, 3}));
+    EXPECT_EQ(steps[2], (std::vector<SizeType32>{0, 3}));
+    EXPECT_TRUE(planDraftSteps({}).empty());
+    EXPECT_TRUE(planDraftSteps({0, 0}).empty());
+}
+
+TEST(DraftTargetSequenceTest, DraftLen)
+{
+    EXPECT_EQ(getDraftLen(4, 10), 4);
+    EXPECT_EQ(getDraftLen(4, 3), 2);
+    EXPECT_EQ(getDraftLen(4, 1), 0);
+    EXPECT_EQ(getDraftLen(4, 0), 0);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/dualMicroBatchSplitter.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+namespace tensorrt_llm::runtime
+{
+
+using Indices = std::vector<SizeType32>;
+
+TEST(DualMicroBatchSplitterTest, BalancesTokens)
+{
+    DualMicroBatchSplitter const splitter{{/*minTokens=*/256, /*minBalance=*/0.5f}};
+    auto const split = splitter.split({400, 100, 300, 200});
+    ASSERT_TRUE(split.has_value());
+    EXPECT_EQ(split->requests[0], (Indices{0, 1}));
+    EXPECT_EQ(split->requests[1], (Indices{2, 3}));
+    EXPECT_EQ(split->numTokens[0], 500);
+    EXPECT_EQ(split->numTokens[1], 500);
+}
+
+TEST(DualMicroBatchSplitterTest, KeepsBatchOrder)
+{
+    DualMicroBatchSplitter const splitter{{/*minTokens=*/256, /*minBalance=*/0.5f}};
+    // Two context chunks in front of 200 generation requests
+    std::vector<SizeType32> numTokens(202, 1);
+    numTokens[0] = 300;
+    numTokens[1] = 300;
+    auto const split = splitter.split(numTokens);
+    ASSERT_TRUE(split.has_value());
+    EXPECT_EQ(split->numTokens[0], 400);
+    EXPECT_EQ(split->numTokens[1], 400);
+    for (SizeType32 mb = 0; mb < 2; ++mb)
+    {
+        EXPECT_EQ(split->requests[mb].front(), mb);
+        EXPECT_TRUE(std::is_sorted(split->requests[mb].begin(), split->requests[mb].end()));
+    }
+}
+
+TEST(DualMicroBatchSplitterTest, RunsSmallBatchesInOnePass)
+{
+    DualMicroBatchSplitter const splitter{{/*minTokens=*/256, /*minBalance=*/0.5f}};
+    EXPECT_FALSE(splitter.split(std::vector<SizeType32>(64, 1)).has_value());
+    EXPECT_FALSE(splitter.split({4096}).has_value());
+    EXPECT_FALSE(splitter.split({}).has_value());
+    // Enough tokens in total, but one micro batch gets too few
+    EXPECT_FALSE(splitter.split({600, 200}).has_value());
+}
+
+TEST(DualMicroBatchSplitterTest, RunsUnbalancedBatchesInOnePass)
+{
+    DualMicroBatchSplitter const splitter{{/*minTokens=*/64, /*minBalance=*/0.5f}};
+    // One long context and 100 generation requests
+    std::vector<SizeType32> numTokens(101, 1);
+    numTokens[0] = 2000;
+    EXPECT_FALSE(splitter.split(numTokens).has_value());
+
+    numTokens[0] = 150;
+    auto const split = splitter.split(numTokens);
+    ASSERT_TRUE(split.has_value());
+    EXPECT_EQ(split->requests[0], (Indices{0}));
+    EXPECT_EQ(split->numTokens[1], 100);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/encoderBatchScheduler.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+using RequestIds = std::vector<EncoderBatchScheduler::RequestIdType>;
+
+TEST(EncoderBatchSchedulerTest, BatchesByTokenBudget)
+{
+    EncoderBatchScheduler scheduler{{/*maxBatchSize=*/8, /*maxNumTokens=*/512, /*firstFit=*/false}};
+    scheduler.enqueue(0, 16);
+    scheduler.enqueue(1, 480);
+    scheduler.enqueue(2, 20);
+    scheduler.enqueue(3, 300);
+
+    auto batch = scheduler.scheduleBatch();
+    EXPECT_EQ(batch.requestIds, (RequestIds{0, 1}));
+    EXPECT_EQ(batch.numTokens, 496);
+    EXPECT_EQ(batch.maxInputLength, 480);
+
+    batch = scheduler.scheduleBatch();
+    EXPECT_EQ(batch.requestIds, (RequestIds{2, 3}));
+    EXPECT_EQ(batch.inputLengths, (std::vector<SizeType32>{20, 300}));
+    EXPECT_EQ(scheduler.getNumQueuedRequests(), 0);
+    EXPECT_EQ(scheduler.scheduleBatch().getBatchSize(), 0);
+}
+
+TEST(EncoderBatchSchedulerTest, FirstFitFillsTheBudget)
+{
+    EncoderBatchScheduler scheduler{{/*maxBatchSize=*/3, /*maxNumTokens=*/512, /*firstFit=*/true}};
+    scheduler.enqueue(0, 400);
+    scheduler.enqueue(1, 200);
+    scheduler.enqueue(2, 50);
+    scheduler.enqueue(3, 50);
+    scheduler.enqueue(4, 10);
+
+    // Request 1 doesn't fit next to request 0, the short requests behind it do, up to the batch size.
+    EXPECT_EQ(scheduler.scheduleBatch().requestIds, (RequestIds{0, 2, 3}));
+    EXPECT_EQ(scheduler.scheduleBatch().requestIds, (RequestIds{1, 4}));
+}
+
+TEST(EncoderBatchSchedulerTest, RejectsOversizedRequests)
+{
+    EncoderBatchScheduler scheduler{{8, 128, true}};
+    EXPECT_THROW(scheduler.enqueue(0, 129), std::exception);
+    EXPECT_THROW(scheduler.enqueue(0, 0), std::exception);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/encoderOutputCache.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+VecUniqueTokens makeTokens(std::vector<TokenIdType> const& ids, TokenExtraIdType extraId = 0)
+{
+    VecUniqueTokens tokens;
+    for (auto const id : ids)
+    {
+        tokens.push_back(UniqueToken{id, extraId});
+    }
+    return tokens;
+}
+
+} // namespace
+
+TEST(EncoderOutputCacheTest, SharesIdenticalInputs)
+{
+    EncoderOutputCache cache{8};
+    auto const input = makeTokens({1, 2, 3});
+    EXPECT_FALSE(cache.acquire(input, std::nullopt).has_value());
+    EXPECT_TRUE(cache.insert(input, std::nullopt, nullptr, {4, 5}));
+    EXPECT_FALSE(cache.insert(input, std::nullopt, nullptr, {6, 7}));
+
+    auto const entry = cache.acquire(input, std::nullopt);
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->crossKvBlockIds, (std::vector<SizeType32>{4, 5}));
+
+    // Different LoRA tasks, prompt tuning ids and lengths don't match.
+    EXPECT_FALSE(cache.acquire(input, 1).has_value());
+    EXPECT_FALSE(cache.acquire(makeTokens({1, 2, 3}, 1), std::nullopt).has_value());
+    EXPECT_FALSE(cache.acquire(makeTokens({1, 2}), std::nullopt).has_value());
+
+    auto const& stats = cache.getStats();
+    EXPECT_EQ(stats.numEntries, 1);
+    EXPECT_EQ(stats.numBlocks, 2);
+    EXPECT_EQ(stats.numHits, 1);
+    EXPECT_EQ(stats.numMisses, 4);
+}
+
+TEST(EncoderOutputCacheTest, EvictsUnreferencedLeastRecentlyUsed)
+{
+    EncoderOutputCache cache{2};
+    auto const a = makeTokens({1});
+    auto const b = makeTokens({2});
+    auto const c = makeTokens({3});
+    EXPECT_TRUE(cache.insert(a, std::nullopt, nullptr, {0}));
+    EXPECT_TRUE(cache.insert(b, std::nullopt, nullptr, {1, 2}));
+    EXPECT_TRUE(cache.insert(c, std::nullopt, nullptr, {3}));
+
+    // Everything is referenced by the producing requests.
+    EXPECT_TRUE(cache.trim().empty());
+
+    cache.release(a, std::nullopt);
+    cache.release(b, std::nullopt);
+    // b is used again, so a is the least recently used.
+    EXPECT_TRUE(cache.acquire(b, std::nullopt).has_value());
+    cache.release(b, std::nullopt);
+    EXPECT_EQ(cache.trim(), (std::vector<SizeType32>{0, 1, 2}));
+    EXPECT_EQ(cache.getStats().numBlocks, 1);
+    EXPECT_EQ(cache.getStats().numEvictedEntries, 2);
+
+    cache.release(c, std::nullopt);
+    EXPECT_TRUE(cache.trim().empty());
+    EXPECT_EQ(cache.evict(1), (std::vector<SizeType32>{3}));
+    EXPECT_EQ(cache.getStats().numEntries, 0);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/engineLoadCoordinator.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+TEST(EngineLoadCoordinatorTest, Waves)
+{
+    EXPECT_EQ(EngineLoadCoordinator(5, 8, std::nullopt).getNumWaves(), 1);
+    EXPECT_EQ(EngineLoadCoordinator(5, 8, std::nullopt).getWave(), 0);
+
+    EngineLoadCoordinator coordinator{5, 8, 3};
+    EXPECT_EQ(coordinator.getNumWaves(), 3);
+    EXPECT_EQ(coordinator.getWave(), 1);
+    EXPECT_EQ(EngineLoadCoordinator(7, 8, 3).getWave(), 2);
+
+    EXPECT_THROW(EngineLoadCoordinator(8, 8, 2), std::exception);
+    EXPECT_THROW(EngineLoadCoordinator(0, 8, 0), std::exception);
+}
+
+TEST(EngineLoadCoordinatorTest, RunStaggered)
+{
+    EngineLoadCoordinator coordinator{5, 8, 2};
+    SizeType32 numBarriers{0};
+    std::optional<SizeType32> readWave;
+    coordinator.runStaggered([&]() { readWave = numBarriers; }, [&]() { ++numBarriers; });
+    EXPECT_EQ(readWave, 2);
+    // Every rank takes part in all the barriers
+    EXPECT_EQ(numBarriers, 4);
+
+    EngineLoadCoordinator unlimited{5, 8, std::nullopt};
+    numBarriers = 0;
+    readWave.reset();
+    unlimited.runStaggered([&]() { readWave = numBarriers; }, [&]() { ++numBarriers; });
+    EXPECT_EQ(readWave, 0);
+    EXPECT_EQ(numBarriers, 0);
+}
+
+TEST(EngineLoadCoordinatorTest, Phases)
+{
+    EngineLoadCoordinator coordinator{0, 1, std::nullopt};
+    coordinator.startPhase("read");
+    coordinator.startPhase("deserialize");
+    coordinator.stopPhase();
+    coordinator.stopPhase();
+
+    auto const& phases = coordinator.getPhases();
+    ASSERT_EQ(phases.size(), 2);
+    EXPECT_EQ(phases[0].name, "read");
+    EXPECT_EQ(phases[1].name, "deserialize");
+    EXPECT_GE(phases[0].durationMS, 0.0);
+    EXPECT_NE(coordinator.getReport().find("read "), std::string::npos);
+    EXPECT_NE(coordinator.getReport().find(", deserialize "), std::string::npos);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/executorMetrics.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+executor::IterationStats createIterationStats(double iterLatencyMS)
+{
+    executor::IterationStats stats{};
+    stats.iterLatencyMS = iterLatencyMS;
+    stats.numActiveRequests = 3;
+    stats.numQueuedRequests = 1;
+    stats.numCompletedRequests = 2;
+    executor::KvCacheStats kvStats{};
+    kvStats.maxNumBlocks = 100;
+    kvStats.usedNumBlocks = 25;
+    kvStats.reusedBlocks = 7;
+    stats.kvCacheStats = kvStats;
+    return stats;
+}
+
+bool contains(std::string const& text, std::string const& line)
+{
+    return text.find(line + "\n") != std::string::npos;
+}
+} // namespace
+
+TEST(ExecutorMetricsTest, Histogram)
+{
+    ExecutorMetrics::Histogram histogram{{1.0, 2.0}};
+    histogram.observe(0.5);
+    histogram.observe(1.0);
+    histogram.observe(1.5);
+    histogram.observe(3.0);
+    EXPECT_EQ(histogram.getCumulativeCounts(), (std::vector<std::uint64_t>{2, 3, 4}));
+    EXPECT_EQ(histogram.getCount(), 4);
+    EXPECT_DOUBLE_EQ(histogram.getSum(), 6.0);
+}
+
+TEST(ExecutorMetricsTest, Scrape)
+{
+    ExecutorMetrics metrics;
+    metrics.update(createIterationStats(20.0));
+    metrics.update(createIterationStats(40.0));
+    metrics.observeTimeToFirstToken(200.0);
+    metrics.observeIterationTimes(2.0, 8.0);
+    metrics.observeSloRequest(true);
+    metrics.observeSloRequest(false);
+
+    auto const text = metrics.scrape();
+    EXPECT_TRUE(contains(text, "# TYPE trtllm_iteration_latency_seconds histogram"));
+    EXPECT_TRUE(contains(text, "trtllm_iteration_latency_seconds_bucket{le=\"0.025\"} 1"));
+    EXPECT_TRUE(contains(text, "trtllm_iteration_latency_seconds_bucket{le=\"+Inf\"} 2"));
+    EXPECT_TRUE(contains(text, "trtllm_iteration_latency_seconds_sum 0.06"));
+    EXPECT_TRUE(contains(text, "trtllm_iteration_latency_seconds_count 2"));
+    EXPECT_TRUE(contains(text, "trtllm_time_to_first_token_seconds_bucket{le=\"0.25\"} 1"));
+    EXPECT_TRUE(contains(text, "trtllm_iterations_total 2"));
+    EXPECT_TRUE(contains(text, "trtllm_requests_completed_total 4"));
+    EXPECT_TRUE(contains(text, "trtllm_active_requests 3"));
+    EXPECT_TRUE(contains(text, "trtllm_kv_cache_reused_blocks_total 7"));
+    EXPECT_TRUE(contains(text, "trtllm_kv_cache_utilization 0.25"));
+    EXPECT_TRUE(contains(text, "trtllm_iteration_host_overhead_seconds_total 0.002"));
+    EXPECT_TRUE(contains(text, "trtllm_iteration_gpu_seconds_total 0.008"));
+    EXPECT_TRUE(contains(text, "trtllm_slo_requests_completed_total 2"));
+    EXPECT_TRUE(contains(text, "trtllm_slo_requests_attained_total 1"));
+}
+
+TEST(ExecutorMetricsTest, ConcurrentScrape)
+{
+    ExecutorMetrics metrics;
+    auto constexpr numIterations = 10000;
+    std::thread updater(
+        [&metrics]()
+        {
+            for (int i = 0; i < numIterations; ++i)
+            {
+                metrics.update(createIterationStats(1.0));
+            }
+        });
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_FALSE(metrics.scrape().empty());
+    }
+    updater.join();
+    EXPECT_TRUE(contains(metrics.scrape(), "trtllm_iterations_total 10000"));
+}
+
+} // namespace tensorrt_llm::runtime
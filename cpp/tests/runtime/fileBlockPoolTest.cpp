@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/fileBlockPool.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+std::filesystem::path tempPoolPath(char const* name)
+{
+    return std::filesystem::temp_directory_path() / name;
+}
+
+std::vector<std::uint8_t> makeBlock(std::size_t size, std::uint8_t value)
+{
+    return std::vector<std::uint8_t>(size, value);
+}
+
+} // namespace
+
+TEST(FileBlockPoolTest, StoreAndLoad)
+{
+    auto constexpr blockSize = 4096;
+    FileBlockPool pool(tempPoolPath("fileBlockPoolTestStoreAndLoad.bin"), blockSize, 4);
+
+    auto const block = makeBlock(blockSize, 7);
+    EXPECT_FALSE(pool.store(42, block.data()).has_value());
+    EXPECT_TRUE(pool.contains(42));
+
+    std::vector<std::uint8_t> out(blockSize, 0);
+    EXPECT_TRUE(pool.load(42, out.data()));
+    EXPECT_EQ(out, block);
+    EXPECT_FALSE(pool.load(43, out.data()));
+
+    auto const stats = pool.getStats();
+    EXPECT_EQ(stats.maxNumBlocks, 4);
+    EXPECT_EQ(stats.usedNumBlocks, 1);
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.evictions, 0);
+}
+
+TEST(FileBlockPoolTest, EvictsLeastRecentlyUsed)
+{
+    auto constexpr blockSize = 256;
+    FileBlockPool pool(tempPoolPath("fileBlockPoolTestEvicts.bin"), blockSize, 2);
+
+    auto const a = makeBlock(blockSize, 1);
+    auto const b = makeBlock(blockSize, 2);
+    auto const c = makeBlock(blockSize, 3);
+    pool.store(1, a.data());
+    pool.store(2, b.data());
+    // Touch 1 so that 2 becomes the least recently used block.
+    EXPECT_NE(pool.find(1), nullptr);
+
+    auto const evicted = pool.store(3, c.data());
+    ASSERT_TRUE(evicted.has_value());
+    EXPECT_EQ(*evicted, 2);
+    EXPECT_TRUE(pool.contains(1));
+    EXPECT_FALSE(pool.contains(2));
+    EXPECT_TRUE(pool.contains(3));
+
+    std::vector<std::uint8_t> out(blockSize, 0);
+    EXPECT_TRUE(pool.load(3, out.data()));
+    EXPECT_EQ(out, c);
+    EXPECT_EQ(pool.getStats().evictions, 1);
+}
+
+TEST(FileBlockPoolTest, EraseFreesSlot)
+{
+    auto constexpr blockSize = 128;
+    FileBlockPool pool(tempPoolPath("fileBlockPoolTestErase.bin"), blockSize, 1);
+
+    auto const a = makeBlock(blockSize, 1);
+    auto const b = makeBlock(blockSize, 2);
+    pool.store(1, a.data());
+    EXPECT_TRUE(pool.erase(1));
+    EXPECT_FALSE(pool.erase(1));
+    EXPECT_FALSE(pool.store(2, b.data()).has_value());
+    EXPECT_EQ(pool.getStats().usedNumBlocks, 1);
+}
+
+TEST(FileBlockPoolTest, RemovesBackingFile)
+{
+    auto const path = tempPoolPath("fileBlockPoolTestRemove.bin");
+    {
+        FileBlockPool pool(path, 64, 1);
+        EXPECT_TRUE(std::filesystem::exists(path));
+    }
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+} // namespace tensorrt_llm::runtime
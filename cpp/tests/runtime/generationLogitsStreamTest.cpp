@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/generationLogitsStream.h"
+#include "tensorrt_llm/executor/tensor.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+//! Push numSteps steps whose logits all equal the index of the step, counted from firstStep
+void pushSteps(GenerationLogitsStream& logitsStream, BufferManager const& manager, SizeType32 firstStep,
+    SizeType32 numSteps, SizeType32 beamWidth, SizeType32 vocabSizePadded)
+{
+    for (SizeType32 step = firstStep; step < firstStep + numSteps; ++step)
+    {
+        auto hostLogits
+            = BufferManager::pinned(ITensor::makeShape({beamWidth, vocabSizePadded}), nvinfer1::DataType::kFLOAT);
+        std::fill_n(bufferCast<float>(*hostLogits), hostLogits->getSize(), static_cast<float>(step));
+        auto deviceLogits = manager.copyFrom(*hostLogits, MemoryType::kGPU);
+        logitsStream.push(*deviceLogits, manager.getStream());
+        EXPECT_LE(logitsStream.getNumStepsInFlight(), GenerationLogitsStream::kDefaultMaxStepsInFlight);
+    }
+}
+
+void checkSteps(ITensor const& logits, SizeType32 firstStep, SizeType32 numSteps)
+{
+    ASSERT_EQ(logits.getShape().d[0], numSteps);
+    auto const stepSize = logits.getSize() / numSteps;
+    auto const* data = bufferCast<float>(logits);
+    for (std::size_t i = 0; i < logits.getSize(); ++i)
+    {
+        ASSERT_EQ(data[i], static_cast<float>(firstStep + i / stepSize)) << i;
+    }
+}
+} // namespace
+
+TEST(GenerationLogitsStreamTest, PopReturnsStepsSinceLastPop)
+{
+    SizeType32 constexpr beamWidth = 2;
+    SizeType32 constexpr vocabSizePadded = 128;
+    SizeType32 constexpr stepsPerChunk = 4;
+    BufferManager manager{std::make_shared<CudaStream>()};
+    GenerationLogitsStream logitsStream{beamWidth, vocabSizePadded, nvinfer1::DataType::kFLOAT,
+        GenerationLogitsStream::kDefaultMaxStepsInFlight, stepsPerChunk};
+    EXPECT_EQ(logitsStream.pop(), nullptr);
+
+    // Within one chunk
+    pushSteps(logitsStream, manager, 0, 3, beamWidth, vocabSizePadded);
+    auto logits = logitsStream.pop();
+    ASSERT_NE(logits, nullptr);
+    EXPECT_EQ(logits->getShape().nbDims, 3);
+    EXPECT_EQ(logits->getShape().d[1], beamWidth);
+    EXPECT_EQ(logits->getShape().d[2], vocabSizePadded);
+    checkSteps(*logits, 0, 3);
+    EXPECT_EQ(logitsStream.getNumPendingSteps(), 0);
+
+    // Spanning two chunks, the first popped view stays valid
+    pushSteps(logitsStream, manager, 3, 3, beamWidth, vocabSizePadded);
+    auto moreLogits = logitsStream.pop();
+    ASSERT_NE(moreLogits, nullptr);
+    checkSteps(*moreLogits, 3, 3);
+    checkSteps(*logits, 0, 3);
+}
+
+TEST(GenerationLogitsStreamTest, StreamerKeepsOneStreamPerRequest)
+{
+    SizeType32 constexpr beamWidth = 2;
+    SizeType32 constexpr vocabSizePadded = 64;
+    auto stream = std::make_shared<CudaStream>();
+    BufferManager manager{stream};
+    GenerationLogitsStreamer streamer;
+    auto processor = streamer.getLogitsPostProcessor();
+    EXPECT_EQ(streamer.pop(1), nullptr);
+
+    // Steps of two requests interleave, the logits of each step equal its index
+    for (SizeType32 step = 0; step < 3; ++step)
+    {
+        for (executor::IdType requestId : {1, 2})
+        {
+            auto hostLogits = BufferManager::pinned(
+                ITensor::makeShape({beamWidth, vocabSizePadded}), nvinfer1::DataType::kFLOAT);
+            std::fill_n(bufferCast<float>(*hostLogits), hostLogits->getSize(), static_cast<float>(step));
+            auto logits = executor::detail::ofITensor(manager.copyFrom(*hostLogits, MemoryType::kGPU));
+            processor(requestId, logits, executor::BeamTokens(beamWidth), stream, std::nullopt);
+        }
+    }
+
+    for (executor::IdType requestId : {1, 2})
+    {
+        auto logits = streamer.pop(requestId);
+        ASSERT_NE(logits, nullptr);
+        EXPECT_EQ(logits->getShape().d[1], beamWidth);
+        EXPECT_EQ(logits->getShape().d[2], vocabSizePadded);
+        checkSteps(*logits, 0, 3);
+        EXPECT_EQ(streamer.pop(requestId), nullptr);
+    }
+    streamer.erase(1);
+    EXPECT_EQ(streamer.pop(1), nullptr);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/iterationLatencyModel.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+double latency(SizeType32 numCtxTokens, SizeType32 numGenTokens)
+{
+    return 5.0 + 0.01 * numCtxTokens + 0.05 * numGenTokens;
+}
+} // namespace
+
+TEST(IterationLatencyModelTest, FitsLinearLatency)
+{
+    IterationLatencyModel model;
+    EXPECT_EQ(model.getContextTokenBudget(30.0, 64, 128, 8192), 8192);
+
+    for (SizeType32 i = 0; i < 16; ++i)
+    {
+        auto const numCtxTokens = (i * 509) % 4096;
+        auto const numGenTokens = (i * 37) % 128;
+        model.update(numCtxTokens, numGenTokens, latency(numCtxTokens, numGenTokens));
+    }
+    auto const coef = model.getCoefficients();
+    ASSERT_TRUE(coef.has_value());
+    EXPECT_NEAR(coef->baseMs, 5.0, 1e-3);
+    EXPECT_NEAR(coef->perCtxTokenMs, 0.01, 1e-6);
+    EXPECT_NEAR(coef->perGenTokenMs, 0.05, 1e-5);
+
+    // (30 - 5 - 0.05 * 100) / 0.01 = 2000
+    EXPECT_NEAR(model.getContextTokenBudget(30.0, 100, 128, 8192), 2000, 1);
+    EXPECT_EQ(model.getContextTokenBudget(30.0, 100, 128, 1024), 1024);
+    EXPECT_EQ(model.getContextTokenBudget(5.0, 100, 128, 8192), 128);
+}
+
+TEST(IterationLatencyModelTest, TracksWorkloadChanges)
+{
+    IterationLatencyModel model{0.8};
+    for (SizeType32 i = 0; i < 32; ++i)
+    {
+        model.update(i * 100, 10 + i % 7, latency(i * 100, 10 + i % 7));
+    }
+    for (SizeType32 i = 0; i < 64; ++i)
+    {
+        model.update(i * 100, 10 + i % 7, 2.0 * latency(i * 100, 10 + i % 7));
+    }
+    EXPECT_NEAR(model.predictMs(1000, 10).value(), 2.0 * latency(1000, 10), 0.1);
+}
+
+TEST(IterationLatencyModelTest, InvalidArguments)
+{
+    EXPECT_ANY_THROW(IterationLatencyModel(0.0));
+    EXPECT_ANY_THROW(IterationLatencyModel(0.9, 1));
+}
+
+} // namespace tensorrt_llm::runtime
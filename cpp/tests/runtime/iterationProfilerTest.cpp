@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/iterationProfiler.h"
+
+#include <chrono>
+
+using namespace tensorrt_llm::runtime;
+using namespace std::chrono_literals;
+
+TEST(IterationProfilerTest, BreaksDownHostTime)
+{
+    IterationProfiler profiler;
+    auto const t0 = IterationProfiler::Clock::time_point{};
+    profiler.begin(t0);
+    profiler.record(IterationPhase::kREQUEST_FETCH, t0, t0 + 1ms);
+    profiler.record(IterationPhase::kSCHEDULING, t0 + 1ms, t0 + 3ms);
+    profiler.record(IterationPhase::kKV_ALLOCATION, t0 + 3ms, t0 + 4ms);
+    profiler.record(IterationPhase::kSYNC_WAIT, t0 + 4ms, t0 + 10ms);
+    // A phase entered twice sums its durations
+    profiler.record(IterationPhase::kRESPONSE, t0 + 10ms, t0 + 11ms);
+    profiler.record(IterationPhase::kRESPONSE, t0 + 11ms, t0 + 12ms);
+
+    auto const breakdown = profiler.end(t0 + 12ms);
+    EXPECT_DOUBLE_EQ(breakdown.getPhaseTimeMs(IterationPhase::kREQUEST_FETCH), 1.0);
+    EXPECT_DOUBLE_EQ(breakdown.getPhaseTimeMs(IterationPhase::kSCHEDULING), 2.0);
+    EXPECT_DOUBLE_EQ(breakdown.getPhaseTimeMs(IterationPhase::kKV_ALLOCATION), 1.0);
+    EXPECT_DOUBLE_EQ(breakdown.getPhaseTimeMs(IterationPhase::kINPUT_PREPARATION), 0.0);
+    EXPECT_DOUBLE_EQ(breakdown.getPhaseTimeMs(IterationPhase::kSYNC_WAIT), 6.0);
+    EXPECT_DOUBLE_EQ(breakdown.getPhaseTimeMs(IterationPhase::kRESPONSE), 2.0);
+    EXPECT_DOUBLE_EQ(breakdown.hostOverheadMs, 6.0);
+    // No GPU work was recorded
+    EXPECT_FALSE(breakdown.gpuTimeMs.has_value());
+    EXPECT_FALSE(profiler.getDraftGpuTimeMs().has_value());
+}
+
+TEST(IterationProfilerTest, BeginClearsThePreviousIteration)
+{
+    IterationProfiler profiler;
+    auto const t0 = IterationProfiler::Clock::time_point{};
+    profiler.begin(t0);
+    profiler.record(IterationPhase::kDECODER_SETUP, t0, t0 + 5ms);
+    EXPECT_DOUBLE_EQ(profiler.getPhaseTimeMs(IterationPhase::kDECODER_SETUP), 5.0);
+    static_cast<void>(profiler.end(t0 + 5ms));
+
+    profiler.begin(t0 + 5ms);
+    EXPECT_DOUBLE_EQ(profiler.getPhaseTimeMs(IterationPhase::kDECODER_SETUP), 0.0);
+    auto const breakdown = profiler.end(t0 + 7ms);
+    EXPECT_DOUBLE_EQ(breakdown.getPhaseTimeMs(IterationPhase::kDECODER_SETUP), 0.0);
+    EXPECT_DOUBLE_EQ(breakdown.hostOverheadMs, 2.0);
+}
+
+TEST(IterationProfilerTest, EndNeedsBegin)
+{
+    IterationProfiler profiler;
+    EXPECT_THROW(static_cast<void>(profiler.end()), tensorrt_llm::common::TllmException);
+}
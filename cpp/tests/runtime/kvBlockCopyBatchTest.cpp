@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/runtime/kvBlockCopyBatch.h"
+
+#include <numeric>
+
+using namespace tensorrt_llm::runtime;
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+
+SizeType32 constexpr kNumLayers = 2;
+SizeType32 constexpr kNumKvHeads = 3;
+SizeType32 constexpr kTokensPerBlock = 8;
+SizeType32 constexpr kSizePerHead = 4;
+SizeType32 constexpr kBlockSize = kNumLayers * 2 * kNumKvHeads * kTokensPerBlock * kSizePerHead;
+
+} // namespace
+
+TEST(KvBlockCopyBatchTest, CopiesWrittenTokensOnly)
+{
+    KvBlockCopyBatch batch(kNumLayers, kNumKvHeads, kTokensPerBlock, kSizePerHead, nvinfer1::DataType::kFLOAT);
+    std::vector<float> src(kBlockSize);
+    std::vector<float> dst(2 * kBlockSize);
+    batch.add(dst.data(), src.data(), 5);
+    EXPECT_EQ(batch.getNumCopies(), kNumLayers * 2 * kNumKvHeads);
+    // A full block is contiguous
+    batch.add(dst.data() + kBlockSize, src.data(), kTokensPerBlock);
+    EXPECT_EQ(batch.getNumCopies(), kNumLayers * 2 * kNumKvHeads + 1);
+    EXPECT_EQ(batch.getNumBlocks(), 2);
+    EXPECT_THROW(batch.add(dst.data(), src.data(), kTokensPerBlock + 1), std::runtime_error);
+}
+
+TEST(KvBlockCopyBatchTest, ExecutesCopies)
+{
+    if (tc::getDeviceCount() == 0)
+    {
+        GTEST_SKIP() << "This test cannot run on systems with no devices.";
+    }
+    BufferManager manager(std::make_shared<CudaStream>());
+    std::vector<float> values(kBlockSize);
+    std::iota(values.begin(), values.end(), 1.f);
+    auto const src = manager.copyFrom(values, ITensor::makeShape({kBlockSize}), MemoryType::kGPU);
+    auto dst = manager.gpu(ITensor::makeShape({kBlockSize}), nvinfer1::DataType::kFLOAT);
+    manager.setZero(*dst);
+
+    SizeType32 constexpr numTokens = 3;
+    KvBlockCopyBatch batch(kNumLayers, kNumKvHeads, kTokensPerBlock, kSizePerHead, nvinfer1::DataType::kFLOAT);
+    bool enqueued{false};
+    batch.add(dst->data(), src->data(), numTokens, [&enqueued]() { enqueued = true; });
+    batch.execute(manager);
+    EXPECT_TRUE(enqueued);
+    EXPECT_EQ(batch.getNumBlocks(), 0);
+
+    auto const host = manager.copyFrom(*dst, MemoryType::kCPU);
+    manager.getStream().synchronize();
+    auto const* copied = bufferCast<float>(*host);
+    for (SizeType32 i = 0; i < kBlockSize; ++i)
+    {
+        auto const token = i / kSizePerHead % kTokensPerBlock;
+        EXPECT_EQ(copied[i], token < numTokens ? values[i] : 0.f) << i;
+    }
+}
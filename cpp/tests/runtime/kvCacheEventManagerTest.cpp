@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/batch_manager/kvCacheEventManager.h"
+
+#include <gtest/gtest.h>
+
+using namespace tensorrt_llm::runtime;
+namespace kvc = tensorrt_llm::batch_manager::kv_cache_manager;
+namespace tle = tensorrt_llm::executor;
+
+namespace
+{
+
+constexpr SizeType32 kTokensPerBlock = 4;
+
+VecUniqueTokens makeTokens(SizeType32 numTokens, TokenExtraIdType tokenExtraId = 0)
+{
+    VecUniqueTokens tokens;
+    for (SizeType32 i = 0; i < numTokens; ++i)
+    {
+        tokens.push_back({i, tokenExtraId});
+    }
+    return tokens;
+}
+
+} // namespace
+
+TEST(KVCacheEventManagerTest, StoredBlocks)
+{
+    kvc::KVCacheEventManager manager{16};
+    auto const tokens = makeTokens(10);
+    auto const blockHashes = kvc::computeBlockHashes(tokens, kTokensPerBlock, 7);
+    ASSERT_EQ(blockHashes.size(), 2);
+
+    manager.enqueueStoredEvent(tokens, kTokensPerBlock, 7);
+    // Only the second block, attached to the first one
+    manager.enqueueStoredEvent(tokens, kTokensPerBlock, 7, 1, tle::KVCacheLevel::kHOST);
+    // No full block left to store
+    manager.enqueueStoredEvent(tokens, kTokensPerBlock, 7, 2);
+
+    auto const events = manager.getEvents();
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[0].eventId + 1, events[1].eventId);
+
+    auto const& first = std::get<tle::KVCacheStoredData>(events[0].data);
+    EXPECT_FALSE(first.parentHash.has_value());
+    ASSERT_EQ(first.blocks.size(), 2);
+    EXPECT_EQ(first.blocks[0].blockHash, blockHashes[0]);
+    EXPECT_EQ(first.blocks[1].blockHash, blockHashes[1]);
+    EXPECT_EQ(first.blocks[1].tokens, (tle::VecTokens{4, 5, 6, 7}));
+    EXPECT_TRUE(first.blocks[1].tokenExtraIds.empty());
+    EXPECT_EQ(first.blocks[1].loraId.value_or(0), 7);
+    EXPECT_EQ(first.blocks[1].cacheLevel, tle::KVCacheLevel::kGPU);
+
+    auto const& second = std::get<tle::KVCacheStoredData>(events[1].data);
+    EXPECT_EQ(second.parentHash.value_or(0), blockHashes[0]);
+    ASSERT_EQ(second.blocks.size(), 1);
+    EXPECT_EQ(second.blocks[0].blockHash, blockHashes[1]);
+    EXPECT_EQ(second.blocks[0].cacheLevel, tle::KVCacheLevel::kHOST);
+    EXPECT_TRUE(manager.getEvents().empty());
+}
+
+TEST(KVCacheEventManagerTest, TokenExtraIds)
+{
+    kvc::KVCacheEventManager manager{16};
+    auto const tokens = makeTokens(4, 3);
+    manager.enqueueStoredEvent(tokens, kTokensPerBlock, std::nullopt);
+
+    auto const events = manager.getEvents();
+    ASSERT_EQ(events.size(), 1);
+    auto const& stored = std::get<tle::KVCacheStoredData>(events[0].data);
+    ASSERT_EQ(stored.blocks.size(), 1);
+    EXPECT_EQ(stored.blocks[0].tokenExtraIds, (tle::VecTokenExtraIds{3, 3, 3, 3}));
+    EXPECT_FALSE(stored.blocks[0].loraId.has_value());
+    // Extra ids are part of the hash
+    EXPECT_NE(stored.blocks[0].blockHash, kvc::computeBlockHashes(makeTokens(4), kTokensPerBlock, 0)[0]);
+    EXPECT_EQ(stored.blocks[0].blockHash, kvc::computeBlockHashes(tokens, kTokensPerBlock, 0)[0]);
+}
+
+TEST(KVCacheEventManagerTest, DroppedEvents)
+{
+    kvc::KVCacheEventManager manager{2};
+    manager.enqueueRemovedEvent({});
+    manager.enqueueRemovedEvent({1});
+    manager.enqueueRemovedEvent({2});
+    manager.enqueueRemovedEvent({3});
+    EXPECT_EQ(manager.getNumDroppedEvents(), 1);
+
+    auto const events = manager.getEvents();
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(std::get<tle::KVCacheRemovedData>(events[1].data).blockHashes, (std::vector<tle::IdType>{2}));
+}
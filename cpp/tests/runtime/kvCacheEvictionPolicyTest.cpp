@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheEvictionPolicy.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+using Policy = KvCacheEvictionPolicy::Policy;
+
+TEST(KvCacheEvictionPolicyTest, EvictsPastBudgetPlusInterval)
+{
+    KvCacheEvictionPolicy policy{{Policy::kHEAVY_HITTER, 4, 8, 4, 16}};
+    EXPECT_EQ(policy.getTokenBudget(), 16);
+    EXPECT_FALSE(policy.needsEviction(32));
+    EXPECT_TRUE(policy.needsEviction(33));
+}
+
+TEST(KvCacheEvictionPolicyTest, RecencyKeepsSinksAndRecentTokens)
+{
+    KvCacheEvictionPolicy policy{{Policy::kRECENCY, 2, 3, 5, 0}};
+    EXPECT_EQ(policy.getTokenBudget(), 5);
+    EXPECT_EQ(policy.selectTokens(nullptr, 10), (std::vector<SizeType32>{0, 1, 7, 8, 9}));
+    EXPECT_EQ(policy.selectTokens(nullptr, 4), (std::vector<SizeType32>{0, 1, 2, 3}));
+}
+
+TEST(KvCacheEvictionPolicyTest, HeavyHittersByScore)
+{
+    KvCacheEvictionPolicy policy{{Policy::kHEAVY_HITTER, 1, 2, 1, 0}};
+    std::vector<float> const scores{9.f, 0.1f, 0.5f, 0.2f, 0.5f, 0.3f, 0.f, 0.f};
+    // Token 4 wins the tie with token 2.
+    EXPECT_EQ(policy.selectTokens(scores.data(), 8), (std::vector<SizeType32>{0, 4, 6, 7}));
+}
+
+TEST(KvCacheEvictionPolicyTest, NumFreedBlocks)
+{
+    EXPECT_EQ(KvCacheEvictionPolicy::getNumFreedBlocks(100, 40, 16), 4);
+    EXPECT_EQ(KvCacheEvictionPolicy::getNumFreedBlocks(96, 33, 16), 3);
+    EXPECT_EQ(KvCacheEvictionPolicy::getNumFreedBlocks(40, 40, 16), 0);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/kvCacheReshardPlan.h"
+
+#include <set>
+#include <tuple>
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+//! \brief Every generation rank receives each of its (layer, head) pairs exactly once, from a rank that holds it.
+void checkCoverage(SizeType32 numLayers, SizeType32 numKvHeads, WorldConfig const& src, WorldConfig const& dst)
+{
+    KvCacheReshardPlan const plan(numLayers, numKvHeads, src, dst);
+    for (SizeType32 dstRank = 0; dstRank < dst.getSize(); ++dstRank)
+    {
+        auto const [dstLayerBegin, dstNumLayers] = KvCacheReshardPlan::getLocalLayers(
+            numLayers, dst.getPipelineParallelism(), dstRank / dst.getTensorParallelism());
+        auto const [dstHeadBegin, dstNumHeads] = KvCacheReshardPlan::getLocalHeads(
+            numKvHeads, dst.getTensorParallelism(), dstRank % dst.getTensorParallelism());
+        std::set<std::tuple<SizeType32, SizeType32>> received;
+        for (auto const& slice : plan.getSlicesForDst(dstRank))
+        {
+            auto const [srcLayerBegin, srcNumLayers] = KvCacheReshardPlan::getLocalLayers(
+                numLayers, src.getPipelineParallelism(), slice.srcRank / src.getTensorParallelism());
+            auto const [srcHeadBegin, srcNumHeads] = KvCacheReshardPlan::getLocalHeads(
+                numKvHeads, src.getTensorParallelism(), slice.srcRank % src.getTensorParallelism());
+            EXPECT_EQ(slice.layerBegin, srcLayerBegin + slice.srcLayerOffset);
+            EXPECT_EQ(slice.layerBegin, dstLayerBegin + slice.dstLayerOffset);
+            EXPECT_EQ(slice.headBegin, srcHeadBegin + slice.srcHeadOffset);
+            EXPECT_EQ(slice.headBegin, dstHeadBegin + slice.dstHeadOffset);
+            EXPECT_LE(slice.srcLayerOffset + slice.numLayers, srcNumLayers);
+            EXPECT_LE(slice.srcHeadOffset + slice.numHeads, srcNumHeads);
+            for (SizeType32 layer = slice.layerBegin; layer < slice.layerBegin + slice.numLayers; ++layer)
+            {
+                for (SizeType32 head = slice.headBegin; head < slice.headBegin + slice.numHeads; ++head)
+                {
+                    EXPECT_TRUE(received.emplace(layer, head).second) << "layer " << layer << " head " << head;
+                }
+            }
+        }
+        EXPECT_EQ(received.size(), static_cast<std::size_t>(dstNumLayers * dstNumHeads)) << "rank " << dstRank;
+    }
+}
+
+} // namespace
+
+TEST(KvCacheReshardPlanTest, SameLayoutIsIdentity)
+{
+    WorldConfig const world{2, 2};
+    KvCacheReshardPlan const plan(8, 4, world, world);
+    EXPECT_TRUE(plan.isIdentity());
+    for (SizeType32 rank = 0; rank < world.getSize(); ++rank)
+    {
+        auto const slices = plan.getSlicesForDst(rank);
+        ASSERT_EQ(slices.size(), 1);
+        EXPECT_EQ(slices[0].srcRank, rank);
+        EXPECT_EQ(slices[0].numLayers, 4);
+        EXPECT_EQ(slices[0].numHeads, 2);
+    }
+}
+
+TEST(KvCacheReshardPlanTest, SplitsHeadsOfWideContextRanks)
+{
+    // TP8 context, TP2 generation, 8 KV heads: every generation rank collects one head from each of 4 ranks
+    KvCacheReshardPlan const plan(4, 8, WorldConfig{8, 1}, WorldConfig{2, 1});
+    EXPECT_FALSE(plan.isIdentity());
+    auto const slices = plan.getSlicesForDst(1);
+    ASSERT_EQ(slices.size(), 4);
+    for (SizeType32 i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ(slices[i], (KvCacheSlice{4 + i, 1, 0, 4, 4 + i, 1, 0, 0, 0, i}));
+    }
+    EXPECT_EQ(plan.getSlicesForSrc(5).size(), 1);
+    checkCoverage(4, 8, WorldConfig{8, 1}, WorldConfig{2, 1});
+}
+
+TEST(KvCacheReshardPlanTest, SplitsLayersAcrossPipelines)
+{
+    // PP1 context, PP4 generation: every context rank sends a quarter of its layers to each pipeline rank
+    KvCacheReshardPlan const plan(8, 2, WorldConfig{1, 1}, WorldConfig{1, 4});
+    auto const slices = plan.getSlicesForSrc(0);
+    ASSERT_EQ(slices.size(), 4);
+    EXPECT_EQ(slices[2], (KvCacheSlice{0, 2, 4, 2, 0, 2, 4, 0, 0, 0}));
+    checkCoverage(8, 2, WorldConfig{1, 1}, WorldConfig{1, 4});
+    checkCoverage(8, 2, WorldConfig{1, 4}, WorldConfig{1, 2});
+}
+
+TEST(KvCacheReshardPlanTest, MixedLayouts)
+{
+    checkCoverage(12, 8, WorldConfig{8, 1}, WorldConfig{2, 3});
+    checkCoverage(12, 8, WorldConfig{2, 2}, WorldConfig{4, 3});
+    checkCoverage(12, 8, WorldConfig{4, 3}, WorldConfig{1, 1});
+}
+
+TEST(KvCacheReshardPlanTest, SpreadsReplicatedHeads)
+{
+    // 2 KV heads over TP8: every head lives on 4 context ranks, the generation ranks read from different replicas
+    KvCacheReshardPlan const plan(2, 2, WorldConfig{8, 1}, WorldConfig{4, 1});
+    std::set<SizeType32> sources;
+    for (SizeType32 dstRank = 0; dstRank < 4; ++dstRank)
+    {
+        auto const slices = plan.getSlicesForDst(dstRank);
+        ASSERT_EQ(slices.size(), 1);
+        sources.insert(slices[0].srcRank);
+    }
+    EXPECT_EQ(sources.size(), 4);
+    checkCoverage(2, 2, WorldConfig{8, 1}, WorldConfig{4, 1});
+    checkCoverage(2, 2, WorldConfig{1, 1}, WorldConfig{8, 2});
+}
+
+TEST(KvCacheReshardPlanTest, RejectsUnevenLayouts)
+{
+    EXPECT_THROW(KvCacheReshardPlan(6, 8, WorldConfig{1, 1}, WorldConfig{1, 4}), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(KvCacheReshardPlan(4, 6, WorldConfig{4, 1}, WorldConfig{1, 1}), tensorrt_llm::common::TllmException);
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/kvCacheSnapshot.h"
+#include "tensorrt_llm/common/tllmException.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+KVCacheSnapshotConfig makeConfig()
+{
+    return KVCacheSnapshotConfig{2, 4, 8, 4, 1, 64};
+}
+
+std::filesystem::path snapshotPath(char const* name)
+{
+    return std::filesystem::temp_directory_path() / name;
+}
+
+} // namespace
+
+TEST(KVCacheSnapshotTest, RoundTrip)
+{
+    auto const path = snapshotPath("kvCacheSnapshotTestRoundTrip.bin");
+    auto const config = makeConfig();
+    std::vector<std::uint8_t> payload0(config.blockSizeInBytes, 1);
+    std::vector<std::uint8_t> payload1(config.blockSizeInBytes, 2);
+    {
+        KVCacheSnapshotWriter writer{path, config};
+        writer.addBlock(KVCacheSnapshotBlock{11, std::nullopt, 3, {{1, 0}, {2, 0}, {3, 0}, {4, 0}}}, payload0.data());
+        writer.addBlock(KVCacheSnapshotBlock{12, 11, 3, {{5, 7}, {6, 0}}}, payload1.data());
+        EXPECT_EQ(writer.getNumBlocks(), 2);
+    }
+
+    KVCacheSnapshotReader reader{path, config};
+    EXPECT_EQ(reader.getNumBlocks(), 2);
+
+    KVCacheSnapshotBlock block;
+    auto const* data = reader.next(block);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(data) % KVCacheSnapshotReader::kPayloadAlignment, 0);
+    EXPECT_EQ(block.blockHash, 11);
+    EXPECT_FALSE(block.parentHash.has_value());
+    EXPECT_EQ(block.loraTaskId, 3);
+    EXPECT_EQ(block.tokens.size(), 4);
+    EXPECT_EQ(std::memcmp(data, payload0.data(), payload0.size()), 0);
+
+    data = reader.next(block);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(block.blockHash, 12);
+    EXPECT_EQ(block.parentHash, 11);
+    EXPECT_EQ(block.tokens, (VecUniqueTokens{{5, 7}, {6, 0}}));
+    EXPECT_EQ(std::memcmp(data, payload1.data(), payload1.size()), 0);
+
+    EXPECT_EQ(reader.next(block), nullptr);
+    std::filesystem::remove(path);
+}
+
+TEST(KVCacheSnapshotTest, RejectsMismatchingConfig)
+{
+    auto const path = snapshotPath("kvCacheSnapshotTestMismatch.bin");
+    auto const config = makeConfig();
+    {
+        KVCacheSnapshotWriter writer{path, config};
+    }
+
+    auto otherConfig = config;
+    otherConfig.tokensPerBlock = 8;
+    EXPECT_THROW(KVCacheSnapshotReader(path, otherConfig), tensorrt_llm::common::TllmException);
+    EXPECT_NO_THROW(KVCacheSnapshotReader(path, config));
+    std::filesystem::remove(path);
+}
+
+TEST(KVCacheSnapshotTest, RejectsInvalidFile)
+{
+    auto const path = snapshotPath("kvCacheSnapshotTestInvalid.bin");
+    {
+        std::ofstream os{path, std::ios::binary};
+        std::vector<char> garbage(128, 'x');
+        os.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+    }
+    EXPECT_THROW(KVCacheSnapshotReader(path, makeConfig()), tensorrt_llm::common::TllmException);
+    std::filesystem::remove(path);
+}
+
+} // namespace tensorrt_llm::runtime
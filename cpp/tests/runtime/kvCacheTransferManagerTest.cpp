@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/batch_manager/kvCacheTransferManager.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+
+#include <numeric>
+
+using namespace tensorrt_llm::runtime;
+using tensorrt_llm::batch_manager::kv_cache_manager::KVCacheTransferManager;
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+
+SizeType32 constexpr kBlockSize = 1 << 20;
+
+class KVCacheTransferManagerTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mComputeStream = std::make_shared<CudaStream>();
+        mManager = std::make_unique<BufferManager>(mComputeStream);
+    }
+
+    std::vector<float> toHost(ITensor const& tensor)
+    {
+        auto const host = mManager->copyFrom(tensor, MemoryType::kCPU);
+        mComputeStream->synchronize();
+        auto const* data = bufferCast<float>(*host);
+        return std::vector<float>(data, data + tensor.getSize());
+    }
+
+    std::shared_ptr<CudaStream> mComputeStream;
+    std::unique_ptr<BufferManager> mManager;
+};
+
+} // namespace
+
+TEST_F(KVCacheTransferManagerTest, CopyBlock)
+{
+    std::vector<float> values(kBlockSize);
+    std::iota(values.begin(), values.end(), 1.f);
+    auto const src = mManager->copyFrom(values, ITensor::makeShape({kBlockSize}), MemoryType::kPINNED);
+    auto dst = mManager->gpu(ITensor::makeShape({kBlockSize}), nvinfer1::DataType::kFLOAT);
+    mManager->setZero(*dst);
+
+    KVCacheTransferManager transferManager;
+    transferManager.copyBlockAsync(3, *src, *dst, *mComputeStream);
+    EXPECT_TRUE(transferManager.isPending(3));
+    EXPECT_EQ(transferManager.getNumPendingTransfers(), 1);
+    EXPECT_FALSE(transferManager.waitBlock(4, *mComputeStream));
+    EXPECT_TRUE(transferManager.waitBlock(3, *mComputeStream));
+    EXPECT_FALSE(transferManager.isPending(3));
+
+    // The compute stream was made to wait for the copy, reading dst on it sees the block.
+    EXPECT_EQ(toHost(*dst), values);
+
+    auto const wrongSize = mManager->gpu(ITensor::makeShape({kBlockSize / 2}), nvinfer1::DataType::kFLOAT);
+    EXPECT_THROW(transferManager.copyBlockAsync(3, *src, *wrongSize, *mComputeStream), std::runtime_error);
+}
+
+TEST_F(KVCacheTransferManagerTest, CopyAfterCompute)
+{
+    std::vector<float> values(kBlockSize);
+    std::iota(values.begin(), values.end(), 1.f);
+    auto const hostValues = mManager->copyFrom(values, ITensor::makeShape({kBlockSize}), MemoryType::kPINNED);
+    auto src = mManager->gpu(ITensor::makeShape({kBlockSize}), nvinfer1::DataType::kFLOAT);
+    mManager->setZero(*src);
+    mComputeStream->synchronize();
+    auto dst = mManager->gpu(ITensor::makeShape({kBlockSize}), nvinfer1::DataType::kFLOAT);
+
+    // Writes enqueued on the compute stream before the transfer must land before the block is copied.
+    mManager->copy(*hostValues, *src);
+    KVCacheTransferManager transferManager;
+    transferManager.copyBlockAsync(0, *src, *dst, *mComputeStream);
+    transferManager.waitAll(*mComputeStream);
+    EXPECT_EQ(transferManager.getNumPendingTransfers(), 0);
+    EXPECT_EQ(toHost(*dst), values);
+}
+
+TEST_F(KVCacheTransferManagerTest, PollCompleted)
+{
+    auto const src = mManager->gpu(ITensor::makeShape({kBlockSize}), nvinfer1::DataType::kFLOAT);
+    auto dst = mManager->gpu(ITensor::makeShape({kBlockSize}), nvinfer1::DataType::kFLOAT);
+
+    KVCacheTransferManager transferManager;
+    std::vector<KVCacheTransferManager::IdType> const blockIds{0, 1, 2};
+    for (auto const blockId : blockIds)
+    {
+        transferManager.copyBlockAsync(blockId, *src, *dst, *mComputeStream);
+    }
+    // A second transfer of a block replaces the pending one.
+    transferManager.copyBlockAsync(1, *src, *dst, *mComputeStream);
+    EXPECT_EQ(transferManager.getNumPendingTransfers(), 3);
+
+    transferManager.getCopyStream().synchronize();
+    transferManager.pollCompleted();
+    EXPECT_EQ(transferManager.getNumPendingTransfers(), 0);
+    EXPECT_EQ(transferManager.waitBlocks(blockIds, *mComputeStream), 0);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/latencySloTracker.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+using ms = std::chrono::milliseconds;
+auto const t0 = LatencySloTracker::TimePoint{};
+} // namespace
+
+TEST(LatencySloTrackerTest, TimeToFirstToken)
+{
+    LatencySloTracker tracker{executor::LatencySloConfig{ms{100}}, t0};
+    EXPECT_TRUE(tracker.hasTargets());
+    EXPECT_FALSE(tracker.isTimeToFirstTokenMet().has_value());
+    EXPECT_DOUBLE_EQ(tracker.getSlackMs(t0 + ms{30}, 20.0).value(), 50.0);
+
+    tracker.recordTokens(1, t0 + ms{120});
+    EXPECT_FALSE(tracker.isTimeToFirstTokenMet().value());
+    EXPECT_FALSE(tracker.isAttained());
+    // No target applies to the following tokens
+    EXPECT_FALSE(tracker.getSlackMs(t0 + ms{130}).has_value());
+}
+
+TEST(LatencySloTrackerTest, InterTokenLatencyBudget)
+{
+    LatencySloTracker tracker{ms{100}, ms{10}, t0};
+    tracker.recordTokens(1, t0 + ms{50});
+    EXPECT_FALSE(tracker.isInterTokenLatencyMet().has_value());
+    // Second token due at 60ms
+    EXPECT_DOUBLE_EQ(tracker.getSlackMs(t0 + ms{55}).value(), 5.0);
+
+    tracker.recordTokens(1, t0 + ms{55});
+    tracker.recordTokens(1, t0 + ms{72});
+    // 22ms for two tokens exceeds the 20ms budget
+    EXPECT_FALSE(tracker.isInterTokenLatencyMet().value());
+    tracker.recordTokens(2, t0 + ms{80});
+    EXPECT_TRUE(tracker.isInterTokenLatencyMet().value());
+    EXPECT_TRUE(tracker.isAttained());
+    EXPECT_EQ(tracker.getNumGeneratedTokens(), 5);
+}
+
+TEST(LatencySloTrackerTest, SortBySlack)
+{
+    std::vector<std::pair<int, std::optional<double>>> items{{0, std::nullopt}, {1, 30.0}, {2, -5.0}, {3, std::nullopt},
+        {4, 30.0}};
+    LatencySloTracker::sortBySlack(items, [](auto const& item) { return item.second; });
+    std::vector<int> order;
+    for (auto const& item : items)
+    {
+        order.push_back(item.first);
+    }
+    EXPECT_EQ(order, (std::vector<int>{2, 1, 4, 0, 3}));
+}
+
+} // namespace tensorrt_llm::runtime
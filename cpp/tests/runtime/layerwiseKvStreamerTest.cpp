@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/layerwiseKvStreamer.h"
+
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+class SentLayers
+{
+public:
+    void add(SizeType32 layerIdx)
+    {
+        std::lock_guard<std::mutex> const lock(mMutex);
+        mLayers.push_back(layerIdx);
+    }
+
+    std::vector<SizeType32> get()
+    {
+        std::lock_guard<std::mutex> const lock(mMutex);
+        return mLayers;
+    }
+
+private:
+    std::mutex mMutex;
+    std::vector<SizeType32> mLayers;
+};
+
+} // namespace
+
+TEST(LayerwiseKvStreamerTest, SendsLayersInOrder)
+{
+    SentLayers sent;
+    LayerwiseKvStreamer streamer(4, [&sent](SizeType32 layerIdx) { sent.add(layerIdx); });
+    EXPECT_EQ(streamer.getNumLayers(), 4);
+
+    streamer.begin();
+    // Layers becoming ready out of order are still sent in layer order
+    streamer.markLayerReady(2);
+    streamer.markLayerReady(0);
+    streamer.markLayerReady(3);
+    streamer.markLayerReady(1);
+    EXPECT_GE(streamer.waitUntilSent(), 0.0);
+    EXPECT_EQ(sent.get(), (std::vector<SizeType32>{0, 1, 2, 3}));
+
+    // The streamer is reused for the next step
+    streamer.begin();
+    for (SizeType32 layerIdx = 0; layerIdx < 4; ++layerIdx)
+    {
+        streamer.markLayerReady(layerIdx);
+    }
+    streamer.waitUntilSent();
+    EXPECT_EQ(sent.get().size(), 8);
+}
+
+TEST(LayerwiseKvStreamerTest, SendsWhileLaterLayersAreComputed)
+{
+    SentLayers sent;
+    LayerwiseKvStreamer streamer(3, [&sent](SizeType32 layerIdx) { sent.add(layerIdx); });
+    streamer.begin();
+    streamer.markLayerReady(0);
+    // Layer 0 goes out before the other layers are ready
+    for (int i = 0; i < 1000 && sent.get().empty(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(sent.get(), (std::vector<SizeType32>{0}));
+    streamer.markLayerReady(1);
+    streamer.markLayerReady(2);
+    streamer.waitUntilSent();
+    EXPECT_EQ(sent.get(), (std::vector<SizeType32>{0, 1, 2}));
+}
+
+TEST(LayerwiseKvStreamerTest, IgnoresMarksOutsideOfAStep)
+{
+    SentLayers sent;
+    LayerwiseKvStreamer streamer(2, [&sent](SizeType32 layerIdx) { sent.add(layerIdx); });
+    // E.g. the layers of a generation-only step
+    streamer.markLayerReady(0);
+    streamer.markLayerReady(1);
+    streamer.markLayerReady(5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_TRUE(sent.get().empty());
+
+    // Marks of the previous step do not carry over
+    streamer.begin();
+    streamer.markLayerReady(0);
+    streamer.markLayerReady(1);
+    streamer.waitUntilSent();
+    EXPECT_EQ(sent.get(), (std::vector<SizeType32>{0, 1}));
+
+    EXPECT_THROW(streamer.waitUntilSent(), tensorrt_llm::common::TllmException);
+}
+
+TEST(LayerwiseKvStreamerTest, RethrowsSendErrors)
+{
+    SentLayers sent;
+    LayerwiseKvStreamer streamer(3,
+        [&sent](SizeType32 layerIdx)
+        {
+            if (layerIdx == 1)
+            {
+                throw std::runtime_error("connection lost");
+            }
+            sent.add(layerIdx);
+        });
+    streamer.begin();
+    for (SizeType32 layerIdx = 0; layerIdx < 3; ++layerIdx)
+    {
+        streamer.markLayerReady(layerIdx);
+    }
+    EXPECT_THROW(streamer.waitUntilSent(), std::runtime_error);
+    // The step is given up at the failed layer
+    EXPECT_EQ(sent.get(), (std::vector<SizeType32>{0}));
+
+    // A step must be waited for before the next one begins
+    streamer.begin();
+    streamer.markLayerReady(0);
+    EXPECT_THROW(streamer.begin(), tensorrt_llm::common::TllmException);
+}
+
+TEST(LayerwiseKvStreamerTest, ActiveStreamer)
+{
+    EXPECT_EQ(LayerwiseKvStreamer::getActive(), nullptr);
+    {
+        LayerwiseKvStreamer streamer(1, [](SizeType32) {});
+        LayerwiseKvStreamer::setActive(&streamer);
+        EXPECT_EQ(LayerwiseKvStreamer::getActive(), &streamer);
+    }
+    // A destroyed streamer does not stay active
+    EXPECT_EQ(LayerwiseKvStreamer::getActive(), nullptr);
+}
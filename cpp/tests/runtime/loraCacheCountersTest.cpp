@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/runtime/loraCacheCounters.h"
+
+using namespace tensorrt_llm::runtime;
+
+TEST(LoraCacheCountersTest, CountsPerTier)
+{
+    LoraCacheCounters counters;
+    using Tier = LoraCacheCounters::Tier;
+    counters.recordHit(Tier::kHOST);
+    counters.recordHit(Tier::kHOST);
+    counters.recordMiss(Tier::kHOST);
+    counters.recordEvictions(Tier::kHOST, 3);
+    counters.recordLoadTime(Tier::kHOST, 1.5);
+    counters.recordHit(Tier::kDEVICE);
+    counters.recordMiss(Tier::kDEVICE);
+    counters.recordMiss(Tier::kDEVICE);
+    counters.recordLoadTime(Tier::kDEVICE, 0.25);
+    counters.recordLoadTime(Tier::kDEVICE, 0.5);
+
+    auto const stats = counters.getStats();
+    EXPECT_EQ(stats.numHostHits, 2);
+    EXPECT_EQ(stats.numHostMisses, 1);
+    EXPECT_EQ(stats.numHostEvictions, 3);
+    EXPECT_DOUBLE_EQ(stats.hostLoadMS, 1.5);
+    EXPECT_EQ(stats.numDeviceHits, 1);
+    EXPECT_EQ(stats.numDeviceMisses, 2);
+    EXPECT_EQ(stats.numDeviceEvictions, 0);
+    EXPECT_DOUBLE_EQ(stats.deviceLoadMS, 0.75);
+}
+
+TEST(LoraCacheCountersTest, RestartsAfterStats)
+{
+    LoraCacheCounters counters;
+    counters.recordMiss(LoraCacheCounters::Tier::kDEVICE);
+    counters.recordEvictions(LoraCacheCounters::Tier::kDEVICE, 2);
+    EXPECT_EQ(counters.getStats().numDeviceMisses, 1);
+
+    auto const stats = counters.getStats();
+    EXPECT_EQ(stats.numDeviceMisses, 0);
+    EXPECT_EQ(stats.numDeviceEvictions, 0);
+    EXPECT_DOUBLE_EQ(stats.deviceLoadMS, 0.0);
+}
+
+TEST(LoraCacheCountersTest, TierFollowsMemoryType)
+{
+    EXPECT_EQ(LoraCacheCounters::getTier(MemoryType::kGPU), LoraCacheCounters::Tier::kDEVICE);
+    EXPECT_EQ(LoraCacheCounters::getTier(MemoryType::kCPU), LoraCacheCounters::Tier::kHOST);
+    EXPECT_EQ(LoraCacheCounters::getTier(MemoryType::kPINNED), LoraCacheCounters::Tier::kHOST);
+}
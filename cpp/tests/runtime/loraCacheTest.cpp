@@ -30,6 +30,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <memory>
 
@@ -164,6 +165,31 @@ TEST_F(LoraCacheTest, LoraCachePageManagerTest)
     EXPECT_EQ(manager.pagePtr(singlePageId2.value().at(0))->data(), expectedPages.at(0)->data());
 }
 
+TEST_F(LoraCacheTest, LoraCachePageManagerClaimsFragmentedPages)
+{
+    LoraCachePageManagerConfig config(runtime::MemoryType::kCPU, nvinfer1::DataType::kFLOAT, 8, 3, 4, 8, 1);
+    LoraCachePageManager manager(config, *mManager);
+
+    auto pages = manager.claimPages(8);
+    ASSERT_TRUE(pages.has_value());
+
+    // Keep every other page, so that no two free pages are adjacent and the free pages span all blocks
+    std::vector<std::size_t> released;
+    for (std::size_t i = 0; i < pages.value().size(); i += 2)
+    {
+        released.push_back(pages.value().at(i));
+    }
+    manager.releasePages(released);
+    EXPECT_EQ(manager.numAvailablePages(), 4);
+
+    auto claimed = manager.claimPages(4);
+    ASSERT_TRUE(claimed.has_value());
+    std::sort(claimed.value().begin(), claimed.value().end());
+    std::sort(released.begin(), released.end());
+    EXPECT_EQ(claimed.value(), released);
+    EXPECT_EQ(manager.numAvailablePages(), 0);
+}
+
 TEST_F(LoraCacheTest, determineNumPages)
 {
     ModelConfig modelConfig(0, 2, 0, 1, 4, nvinfer1::DataType::kFLOAT);
@@ -356,6 +382,51 @@ TEST_F(LoraCacheTest, basicPutGet)
     }
 }
 
+TEST_F(LoraCacheTest, putPages)
+{
+    TensorPtr loraReqWeights = utils::loadNpy(*mManager, TEST_SOURCE_LORA_TP2.string(), MemoryType::kCPU);
+    TensorPtr loraReqKeys = utils::loadNpy(*mManager, TEST_KEYS_LORA_TP2.string(), MemoryType::kCPU);
+
+    mLoraCache->put(1234, loraReqWeights, loraReqKeys);
+    auto const& values = *mLoraCache->get(1234);
+
+    // Fill the pages of the device cache from the pages of the host cache, like a shard received from the leader
+    std::vector<SizeType32> filledSlots;
+    auto const fillPages = [&](std::vector<TensorPtr> const& pages, std::vector<SizeType32> const& usedSlots)
+    {
+        ASSERT_EQ(pages.size(), usedSlots.size());
+        for (std::size_t i = 0; i < pages.size(); ++i)
+        {
+            auto const hostPage = mLoraCache->getPagePtr(values.front().pageId + i);
+            mManager->copy(*ITensor::slice(hostPage, 0, usedSlots[i]), *ITensor::slice(pages[i], 0, usedSlots[i]));
+        }
+        filledSlots = usedSlots;
+    };
+    EXPECT_TRUE(mLoraCache2->putPages(1234, loraReqKeys, fillPages));
+    mManager->getStream().synchronize();
+    EXPECT_EQ(filledSlots, (std::vector<SizeType32>{64, 16}));
+    EXPECT_TRUE(mLoraCache2->isLoaded(1234));
+    EXPECT_FALSE(mLoraCache2->putPages(1234, loraReqKeys, fillPages));
+
+    auto const& values2 = *mLoraCache2->get(1234);
+    ASSERT_EQ(values.size(), values2.size());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        EXPECT_EQ(values.at(i), values2.at(i));
+        auto page1 = mLoraCache->getPagePtr(values.at(i).pageId);
+        auto hostPage2 = mManager->copyFrom(*mLoraCache2->getPagePtr(values2.at(i).pageId), MemoryType::kCPU);
+        auto const p1 = bufferCast<float>(*page1);
+        auto const p2 = bufferCast<float>(*hostPage2);
+        auto const pageWidth = static_cast<size_t>(mLoraCache->getPageManagerConfig().getPageWidth());
+        auto const begin = values.at(i).slotIdx * pageWidth;
+        auto const end = begin + values.at(i).numSlots * pageWidth;
+        for (size_t j = begin; j < end; ++j)
+        {
+            ASSERT_FLOAT_EQ(p1[j], p2[j]);
+        }
+    }
+}
+
 TEST_F(LoraCacheTest, splitTransposeCpu)
 {
     auto modelConfig = ModelConfig(0, 2, 0, 1, 16, nvinfer1::DataType::kFLOAT);
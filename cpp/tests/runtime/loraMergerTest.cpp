@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/runtime/loraMerger.h"
+
+#include <cmath>
+#include <random>
+
+using namespace tensorrt_llm::runtime;
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+
+LoraMergePolicy::Config getConfig()
+{
+    LoraMergePolicy::Config config;
+    config.mergeShare = 0.6f;
+    config.unmergeShare = 0.4f;
+    config.decay = 0.99f;
+    config.minRequests = 10;
+    return config;
+}
+
+} // namespace
+
+TEST(LoraMergePolicyTest, MergesDominantTask)
+{
+    LoraMergePolicy policy{getConfig()};
+    for (int i = 0; i < 9; ++i)
+    {
+        policy.record(1);
+    }
+    // Not enough requests yet
+    EXPECT_EQ(policy.update().action, LoraMergePolicy::Action::kNONE);
+
+    policy.record(std::nullopt);
+    EXPECT_NEAR(policy.getShare(1), 0.9f, 0.01f);
+    auto const decision = policy.update();
+    EXPECT_EQ(decision.action, LoraMergePolicy::Action::kMERGE);
+    EXPECT_EQ(decision.taskId, 1);
+    EXPECT_TRUE(policy.isMerged(1));
+    EXPECT_FALSE(policy.isMerged(2));
+    EXPECT_FALSE(policy.isMerged(std::nullopt));
+    EXPECT_EQ(policy.update().action, LoraMergePolicy::Action::kNONE);
+}
+
+TEST(LoraMergePolicyTest, KeepsMixedTrafficUnmerged)
+{
+    LoraMergePolicy policy{getConfig()};
+    for (int i = 0; i < 100; ++i)
+    {
+        policy.record(i % 2 + 1);
+    }
+    EXPECT_NEAR(policy.getShare(1), 0.5f, 0.01f);
+    EXPECT_EQ(policy.update().action, LoraMergePolicy::Action::kNONE);
+    EXPECT_FALSE(policy.getMergedTask().has_value());
+}
+
+TEST(LoraMergePolicyTest, UnmergesWhenTrafficShifts)
+{
+    LoraMergePolicy policy{getConfig()};
+    for (int i = 0; i < 50; ++i)
+    {
+        policy.record(1);
+    }
+    ASSERT_EQ(policy.update().action, LoraMergePolicy::Action::kMERGE);
+
+    // Between the thresholds the task stays merged
+    while (policy.getShare(1) >= 0.5f)
+    {
+        policy.record(2);
+    }
+    EXPECT_EQ(policy.update().action, LoraMergePolicy::Action::kNONE);
+    EXPECT_TRUE(policy.isMerged(1));
+
+    while (policy.getShare(1) >= 0.4f)
+    {
+        policy.record(2);
+    }
+    auto const decision = policy.update();
+    EXPECT_EQ(decision.action, LoraMergePolicy::Action::kUNMERGE);
+    EXPECT_EQ(decision.taskId, 1);
+    EXPECT_FALSE(policy.getMergedTask().has_value());
+
+    // The new dominant task is merged on a later update
+    while (policy.getShare(2) < 0.6f)
+    {
+        policy.record(2);
+    }
+    EXPECT_EQ(policy.update().taskId, 2);
+    EXPECT_TRUE(policy.isMerged(2));
+}
+
+TEST(LoraMergePolicyTest, RenormalizesLongRuns)
+{
+    auto config = getConfig();
+    config.decay = 0.5f;
+    LoraMergePolicy policy{config};
+    for (int i = 0; i < 1000; ++i)
+    {
+        policy.record(i % 4 == 0 ? 2 : 1);
+    }
+    policy.record(3);
+    EXPECT_GT(policy.getShare(3), 0.4f);
+    EXPECT_LT(policy.getShare(3), 0.6f);
+    EXPECT_FALSE(std::isnan(policy.getShare(1)));
+}
+
+class LoraWeightMergerTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mManager = std::make_unique<BufferManager>(std::make_shared<CudaStream>());
+    }
+
+    std::unique_ptr<BufferManager> mManager;
+};
+
+TEST_F(LoraWeightMergerTest, MergesModulesIntoCopies)
+{
+    SizeType32 constexpr hidden = 16;
+    SizeType32 constexpr numHeads = 2;
+    SizeType32 constexpr numKvHeads = 1;
+    SizeType32 constexpr headSize = 8;
+    SizeType32 constexpr qkvRows = (numHeads + 2 * numKvHeads) * headSize;
+    SizeType32 constexpr rank = 4;
+
+    ModelConfig modelConfig(0, 1, 0, numHeads, hidden, nvinfer1::DataType::kFLOAT);
+    modelConfig.setNbKvHeads(numKvHeads);
+    modelConfig.setSizePerHead(headSize);
+    modelConfig.setLoraModules({
+        LoraModule(LoraModule::ModuleType::kATTN_V, hidden, numKvHeads * headSize, false, true, -1, 0),
+        LoraModule(LoraModule::ModuleType::kATTN_DENSE, hidden, hidden, false, true, 1, -1),
+    });
+    WorldConfig const worldConfig{};
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distr(-1.f, 1.f);
+    auto const randomVector = [&](std::size_t size)
+    {
+        std::vector<float> values(size);
+        for (auto& value : values)
+        {
+            value = distr(generator);
+        }
+        return values;
+    };
+
+    auto const qkv = randomVector(qkvRows * hidden);
+    auto const dense = randomVector(hidden * hidden);
+    LoraWeightMerger::TensorMap baseWeights;
+    auto const qkvName = LoraWeightMerger::getDefaultWeightName(LoraModule::ModuleType::kATTN_QKV, 0);
+    auto const denseName = LoraWeightMerger::getDefaultWeightName(LoraModule::ModuleType::kATTN_DENSE, 0);
+    baseWeights[qkvName] = mManager->copyFrom(qkv, ITensor::makeShape({qkvRows, hidden}), MemoryType::kGPU);
+    baseWeights[denseName] = mManager->copyFrom(dense, ITensor::makeShape({hidden, hidden}), MemoryType::kGPU);
+
+    SizeType32 const vRows = numKvHeads * headSize;
+    auto const vIn = randomVector(rank * hidden);
+    auto const vOut = randomVector(vRows * rank);
+    auto const denseIn = randomVector(rank * hidden);
+    auto const denseOut = randomVector(hidden * rank);
+    std::vector<ITensor::SharedPtr> loraBuffers;
+    auto const toDevice = [&](std::vector<float> const& values)
+    {
+        loraBuffers.push_back(
+            mManager->copyFrom(values, ITensor::makeShape({static_cast<SizeType32>(values.size())}), MemoryType::kGPU));
+        return reinterpret_cast<std::int64_t>(loraBuffers.back()->data());
+    };
+    std::vector<LoraCache::TaskLayerModuleConfig> task{
+        {0, 0, rank * hidden, vRows * rank, static_cast<SizeType32>(LoraModule::ModuleType::kATTN_V), 0, rank, 1,
+            toDevice(vIn), toDevice(vOut)},
+        {0, 1, rank * hidden, hidden * rank, static_cast<SizeType32>(LoraModule::ModuleType::kATTN_DENSE), 0, rank, 1,
+            toDevice(denseIn), toDevice(denseOut)},
+    };
+
+    LoraWeightMerger const merger(modelConfig, worldConfig);
+    auto const merged = merger.merge(task, baseWeights, *mManager);
+    ASSERT_EQ(merged.size(), 2);
+
+    auto const expectMerged = [&](std::string const& name, std::vector<float> const& base, SizeType32 rowOffset,
+                                  SizeType32 numRows, std::vector<float> const& in, std::vector<float> const& out)
+    {
+        auto const device = tensorrt_llm::executor::detail::toITensor(merged.at(name));
+        EXPECT_NE(device->data(), baseWeights.at(name)->data());
+        auto const host = mManager->copyFrom(*device, MemoryType::kCPU);
+        mManager->getStream().synchronize();
+        auto const* values = bufferCast<float>(*host);
+        for (SizeType32 row = 0; row < static_cast<SizeType32>(base.size()) / hidden; ++row)
+        {
+            for (SizeType32 col = 0; col < hidden; ++col)
+            {
+                float expected = base[row * hidden + col];
+                if (row >= rowOffset && row < rowOffset + numRows)
+                {
+                    for (SizeType32 r = 0; r < rank; ++r)
+                    {
+                        expected += out[(row - rowOffset) * rank + r] * in[r * hidden + col];
+                    }
+                }
+                EXPECT_NEAR(values[row * hidden + col], expected, 1e-4f) << name << " " << row << " " << col;
+            }
+        }
+    };
+    expectMerged(qkvName, qkv, (numHeads + numKvHeads) * headSize, vRows, vIn, vOut);
+    expectMerged(denseName, dense, 0, hidden, denseIn, denseOut);
+
+    // The base weights are left untouched and restored as they are
+    auto const restored = merger.restore(task, baseWeights);
+    ASSERT_EQ(restored.size(), 2);
+    EXPECT_EQ(tensorrt_llm::executor::detail::toITensor(restored.at(qkvName))->data(),
+        baseWeights.at(qkvName)->data());
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/loraPrefetcher.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/loraCachePageManagerConfig.h"
+#include "tensorrt_llm/runtime/loraModule.h"
+#include "tensorrt_llm/runtime/utils/numpyUtils.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+
+namespace fs = std::filesystem;
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+auto const TEST_RESOURCE_PATH = fs::path{TOP_LEVEL_DIR} / "cpp/tests/resources/data";
+auto const TEST_SOURCE_LORA_TP2 = TEST_RESOURCE_PATH / "lora-test-weights-tp2/source.npy";
+auto const TEST_KEYS_LORA_TP2 = TEST_RESOURCE_PATH / "lora-test-weights-tp2/config.npy";
+
+class FakeAdapterStore : public LoraAdapterStore
+{
+public:
+    explicit FakeAdapterStore(BufferManager const& manager)
+        : mAdapter{utils::loadNpy(manager, TEST_SOURCE_LORA_TP2.string(), MemoryType::kCPU),
+            utils::loadNpy(manager, TEST_KEYS_LORA_TP2.string(), MemoryType::kCPU)}
+    {
+    }
+
+    [[nodiscard]] bool contains(TaskIdType taskId) const override
+    {
+        return taskId == 1 || taskId == 2;
+    }
+
+    [[nodiscard]] Adapter load(TaskIdType /*taskId*/) const override
+    {
+        ++mNumLoads;
+        return mAdapter;
+    }
+
+    mutable std::atomic<int> mNumLoads{0};
+
+private:
+    Adapter mAdapter;
+};
+
+} // namespace
+
+class LoraPrefetcherTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    void SetUp() override
+    {
+        if (common::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mModelConfig = std::make_unique<ModelConfig>(0, 2, 0, 1, 16, nvinfer1::DataType::kFLOAT);
+        mModelConfig->setMlpHiddenSize(32);
+        mWorldConfig = std::make_unique<WorldConfig>(2, 1, 0);
+        std::vector<LoraModule> modules{
+            LoraModule(LoraModule::ModuleType::kATTN_QKV, 16, 3 * 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kATTN_Q, 16, 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kATTN_K, 16, 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kATTN_V, 16, 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kATTN_DENSE, 16, 16, false, true, 1, -1),
+            LoraModule(LoraModule::ModuleType::kMLP_H_TO_4H, 16, 32, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kMLP_4H_TO_H, 32, 16, false, true, 1, -1),
+            LoraModule(LoraModule::ModuleType::kMLP_GATE, 16, 32, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kCROSS_ATTN_QKV, 16, 3 * 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kCROSS_ATTN_Q, 16, 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kCROSS_ATTN_K, 16, 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kCROSS_ATTN_V, 16, 16, false, true, -1, 0),
+            LoraModule(LoraModule::ModuleType::kCROSS_ATTN_DENSE, 16, 16, false, true, 1, -1),
+        };
+        mModelConfig->setLoraModules(modules);
+        mManager = std::make_unique<BufferManager>(std::make_shared<CudaStream>());
+
+        auto hostPageConfig = LoraCachePageManagerConfig(
+            runtime::MemoryType::kCPU, nvinfer1::DataType::kFLOAT, 2 * 8, 6, 64, 4 * 16, 1);
+        auto devicePageConfig = hostPageConfig;
+        devicePageConfig.setMemoryType(runtime::MemoryType::kGPU);
+        mHostCache = std::make_unique<LoraCache>(hostPageConfig, *mModelConfig, *mWorldConfig, *mManager);
+        mDeviceCache = std::make_unique<LoraCache>(devicePageConfig, *mModelConfig, *mWorldConfig, *mManager);
+        mStore = std::make_shared<FakeAdapterStore>(*mManager);
+        mPrefetcher = std::make_unique<LoraPrefetcher>(mStore, *mHostCache, std::make_shared<WorkerPool>(1));
+    }
+
+    std::unique_ptr<BufferManager> mManager;
+    std::unique_ptr<ModelConfig> mModelConfig;
+    std::unique_ptr<WorldConfig> mWorldConfig;
+    std::unique_ptr<LoraCache> mHostCache;
+    std::unique_ptr<LoraCache> mDeviceCache;
+    std::shared_ptr<FakeAdapterStore> mStore;
+    std::unique_ptr<LoraPrefetcher> mPrefetcher;
+};
+
+TEST_F(LoraPrefetcherTest, LoadsColdTasksOnce)
+{
+    EXPECT_FALSE(mPrefetcher->isReady(1));
+    auto const first = mPrefetcher->prefetch(1);
+    auto const second = mPrefetcher->prefetch(1);
+    first.wait();
+    second.wait();
+    EXPECT_TRUE(mPrefetcher->isReady(1));
+    EXPECT_TRUE(mHostCache->isLoaded(1));
+    EXPECT_EQ(mStore->mNumLoads, 1);
+    EXPECT_EQ(mPrefetcher->getNumLoads(), 1);
+
+    // Cached tasks are ready right away.
+    EXPECT_TRUE(mPrefetcher->prefetch(1).valid());
+    EXPECT_EQ(mStore->mNumLoads, 1);
+
+    EXPECT_THROW(mPrefetcher->prefetch(3), LoraExpectedException);
+}
+
+TEST_F(LoraPrefetcherTest, PromotesHotTasks)
+{
+    for (auto const taskId : {1, 1, 1, 2})
+    {
+        mPrefetcher->prefetch(taskId).wait();
+    }
+    // The requests using the tasks are done.
+    mHostCache->markTaskDone(1);
+    mHostCache->markTaskDone(2);
+    EXPECT_EQ(mPrefetcher->getHotTasks(2), (std::vector<LoraCache::TaskIdType>{1, 2}));
+
+    EXPECT_EQ(mPrefetcher->promoteHotTasks(*mDeviceCache, 1), 1);
+    EXPECT_TRUE(mDeviceCache->isLoaded(1));
+    EXPECT_TRUE(mDeviceCache->isDone(1));
+    EXPECT_TRUE(mHostCache->isDone(1));
+    EXPECT_FALSE(mDeviceCache->has(2));
+
+    // Use counts are halved on every promotion, task 2 is forgotten.
+    EXPECT_EQ(mPrefetcher->getHotTasks(2), (std::vector<LoraCache::TaskIdType>{1}));
+}
+
+} // namespace tensorrt_llm::runtime
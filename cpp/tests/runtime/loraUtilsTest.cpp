@@ -127,4 +127,43 @@ TEST_F(LoraUtilsTest, loraValidateRequestTensors)
         testing::Throws<std::runtime_error>());
 }
 
+TEST(LoraQuantizationTest, quantizeWeightRows)
+{
+    SizeType32 constexpr numRows = 3;
+    SizeType32 constexpr numCols = 5;
+    std::vector<float> const weights{
+        1.f, -2.f, 0.5f, 0.f, 0.25f,  //
+        0.f, 0.f, 0.f, 0.f, 0.f,      //
+        -0.1f, 0.3f, 0.2f, -0.3f, 0.f //
+    };
+    std::vector<std::int8_t> quantized(numRows * numCols);
+    std::vector<float> scales(numRows);
+    quantizeWeightRows(quantized.data(), scales.data(), weights.data(), numRows, numCols, nvinfer1::DataType::kFLOAT,
+        nvinfer1::DataType::kINT8);
+
+    EXPECT_FLOAT_EQ(scales[0], 2.f / 127.f);
+    // All zero rows keep a unit scale
+    EXPECT_FLOAT_EQ(scales[1], 1.f);
+    EXPECT_FLOAT_EQ(scales[2], 0.3f / 127.f);
+    EXPECT_EQ(quantized[1], -127);
+    EXPECT_EQ(quantized[13], -127);
+    for (SizeType32 i = 0; i < numRows * numCols; ++i)
+    {
+        EXPECT_NEAR(quantized[i] * scales[i / numCols], weights[i], scales[i / numCols] / 2) << i;
+    }
+}
+
+TEST(LoraQuantizationTest, getQuantizedLocalInOutSize)
+{
+    // in [8, 64 / 2] and out [48, 8] of a tensor parallel split module
+    LoraModule const module(LoraModule::ModuleType::kATTN_DENSE, 64, 48, false, true, 1, -1);
+    SizeType32 constexpr adapterSize = 8;
+    SizeType32 constexpr tpSize = 2;
+    EXPECT_EQ(getQuantizedLocalInOutSize(module, adapterSize, tpSize), 32 + 8 * 32 + 192 + 48 * 8);
+
+    LoraModule const oddModule(LoraModule::ModuleType::kATTN_Q, 12, 12, false, true, -1, 0);
+    // 3 scales padded to 16 bytes, 3 * 12 in bytes padded to 48, 6 scales padded to 32, 6 * 3 out bytes padded to 32
+    EXPECT_EQ(getQuantizedLocalInOutSize(oddModule, 3, tpSize), 16 + 48 + 32 + 32);
+}
+
 } // namespace tensorrt_llm::runtime::lora
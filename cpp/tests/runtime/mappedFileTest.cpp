@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/mappedFile.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+std::filesystem::path writeTempFile(std::string const& name, std::string const& content)
+{
+    auto const path = std::filesystem::temp_directory_path() / name;
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+    return path;
+}
+} // namespace
+
+TEST(MappedFileTest, MapsWholeFile)
+{
+    std::string const content(10000, 'x');
+    auto const path = writeTempFile("mappedFileTest.bin", content);
+    {
+        MappedFile file{path};
+        ASSERT_EQ(file.size(), content.size());
+        EXPECT_EQ(std::memcmp(file.data(), content.data(), content.size()), 0);
+        EXPECT_EQ(file.getPath(), path);
+
+        // Pages are read again after release
+        file.release();
+        EXPECT_EQ(static_cast<char const*>(file.data())[9999], 'x');
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(MappedFileTest, InvalidFiles)
+{
+    EXPECT_ANY_THROW(MappedFile(std::filesystem::temp_directory_path() / "mappedFileTestMissing.bin"));
+    auto const path = writeTempFile("mappedFileTestEmpty.bin", "");
+    EXPECT_ANY_THROW(MappedFile{path});
+    std::filesystem::remove(path);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/medusaTreeTuner.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <set>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+using MedusaChoices = MedusaTreeTuner::MedusaChoices;
+
+MedusaChoices const kSmallTree = {{0}, {1}, {2}, {0, 0}, {0, 1}, {1, 0}};
+
+// Counts by linear idx of kSmallTree: the first head is confident, the top-1 chain is accepted most of the time
+std::vector<SizeType32> const kDeepCounts = {100, 90, 5, 0, 80, 5, 1};
+} // namespace
+
+TEST(MedusaTreeTunerTest, SortsChoicesByLinearIdx)
+{
+    MedusaTreeTuner tuner({{1, 0}, {2}, {0, 1}, {0}, {1}, {0, 0}}, 6, 4, 1);
+    EXPECT_EQ(tuner.getChoices(), kSmallTree);
+    EXPECT_FLOAT_EQ(tuner.getExpectedAcceptedLen(), 1.F);
+}
+
+TEST(MedusaTreeTunerTest, UpdateInterval)
+{
+    MedusaTreeTuner tuner(kSmallTree, 6, 4, 3);
+    EXPECT_FALSE(tuner.onIteration());
+    EXPECT_FALSE(tuner.onIteration());
+    EXPECT_TRUE(tuner.onIteration());
+    EXPECT_FALSE(tuner.update(std::vector<SizeType32>(kSmallTree.size() + 1, 0)).has_value());
+    EXPECT_FALSE(tuner.onIteration());
+
+    MedusaTreeTuner fromConfig(kSmallTree, 6, 4, executor::MedusaTreeTuningConfig{2, true});
+    EXPECT_TRUE(fromConfig.isPinned());
+    EXPECT_FALSE(fromConfig.onIteration());
+    EXPECT_TRUE(fromConfig.onIteration());
+}
+
+TEST(MedusaTreeTunerTest, GrowsAlongAcceptedPaths)
+{
+    MedusaTreeTuner tuner(kSmallTree, 6, 4, 1, false, 3);
+    auto const choices = tuner.update(kDeepCounts);
+    ASSERT_TRUE(choices.has_value());
+    // The never accepted {2} and the rarely accepted {1, 0} make room for a deeper top-1 chain
+    MedusaChoices const expected = {{0}, {1}, {0, 0}, {0, 1}, {0, 0, 0}, {0, 0, 0, 0}};
+    EXPECT_EQ(*choices, expected);
+    EXPECT_EQ(tuner.getChoices(), expected);
+    EXPECT_GT(tuner.getExpectedAcceptedLen(), 1.F + 0.9F + 0.05F + 0.8F + 0.05F + 0.01F);
+}
+
+TEST(MedusaTreeTunerTest, Pinned)
+{
+    MedusaTreeTuner tuner(kSmallTree, 6, 4, 1, true, 3);
+    EXPECT_FALSE(tuner.update(kDeepCounts).has_value());
+    EXPECT_EQ(tuner.getChoices(), kSmallTree);
+    std::vector<float> const expectedRates = {0.9F, 0.05F, 0.F, 0.8F, 0.05F, 0.01F};
+    ASSERT_EQ(tuner.getAcceptRates().size(), expectedRates.size());
+    for (std::size_t ni = 0; ni < expectedRates.size(); ++ni)
+    {
+        EXPECT_FLOAT_EQ(tuner.getAcceptRates()[ni], expectedRates[ni]);
+    }
+
+    tuner.setPinned(false);
+    EXPECT_TRUE(tuner.update(kDeepCounts).has_value());
+}
+
+TEST(MedusaTreeTunerTest, SmoothsRates)
+{
+    MedusaTreeTuner tuner(kSmallTree, 6, 4, 1, true, 3, 0.5F);
+    EXPECT_FALSE(tuner.update({100, 100, 0, 0, 0, 0, 0}).has_value());
+    EXPECT_FALSE(tuner.update({50, 0, 0, 0, 0, 0, 0}).has_value());
+    EXPECT_FLOAT_EQ(tuner.getAcceptRates()[0], 0.5F);
+    // Intervals without Medusa steps leave the rates alone
+    EXPECT_FALSE(tuner.update({0, 0, 0, 0, 0, 0, 0}).has_value());
+    EXPECT_FLOAT_EQ(tuner.getAcceptRates()[0], 0.5F);
+}
+
+TEST(MedusaTreeTunerTest, KeepsTreeValid)
+{
+    SizeType32 constexpr maxDecodingDraftTokens = 12;
+    SizeType32 constexpr maxDraftPathLen = 3;
+    MedusaChoices const start = {{0}, {1}, {2}, {3}, {0, 0}, {0, 1}, {1, 0}, {0, 0, 0}};
+    MedusaTreeTuner tuner(start, maxDecodingDraftTokens, maxDraftPathLen, 1);
+    // A flat workload, only the first level is accepted
+    auto const choices = tuner.update({100, 40, 30, 20, 10, 0, 0, 0, 0});
+    ASSERT_TRUE(choices.has_value());
+    EXPECT_LE(static_cast<SizeType32>(choices->size()), maxDecodingDraftTokens);
+
+    std::set<std::vector<SizeType32>> const nodes(choices->begin(), choices->end());
+    std::vector<SizeType32> topKs(maxDraftPathLen, 0);
+    for (auto const& choice : *choices)
+    {
+        ASSERT_FALSE(choice.empty());
+        ASSERT_LE(static_cast<SizeType32>(choice.size()), maxDraftPathLen);
+        if (choice.size() > 1)
+        {
+            EXPECT_EQ(nodes.count(std::vector<SizeType32>(choice.begin(), choice.end() - 1)), 1);
+        }
+        topKs[choice.size() - 1] = std::max(topKs[choice.size() - 1], choice.back() + 1);
+    }
+    EXPECT_LE(topKs[0] + topKs[1] + topKs[2], maxDecodingDraftTokens);
+    EXPECT_TRUE(std::is_sorted(choices->begin(), choices->end(),
+        [](auto const& a, auto const& b) { return a.size() < b.size() || (a.size() == b.size() && a < b); }));
+    // The tree widens at the first level
+    EXPECT_EQ(nodes.count({4}), 1);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/memoryPlanner.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+std::size_t constexpr kMiB = std::size_t{1} << 20;
+
+ModelConfig createModelConfig()
+{
+    ModelConfig modelConfig{32000, 4, 0, 8, 512, nvinfer1::DataType::kHALF};
+    modelConfig.setKVCacheType(ModelConfig::KVCacheType::kPAGED);
+    modelConfig.setTokensPerBlock(64);
+    return modelConfig;
+}
+
+MemoryPlanner::Options createOptions()
+{
+    MemoryPlanner::Options options{};
+    options.maxBatchSize = 8;
+    options.maxBeamWidth = 1;
+    options.maxSequenceLen = 1024;
+    options.maxNumTokens = 2048;
+    options.freeGpuMemoryFraction = 0.5F;
+    options.kvCacheHostSize = 64 * kMiB;
+    options.loraDeviceCachePercent = 0.02F;
+    return options;
+}
+} // namespace
+
+TEST(MemoryPlannerTest, Breakdown)
+{
+    MemoryPlanner planner{createModelConfig(), WorldConfig{}, createOptions()};
+    // [2, 8 kv heads, 64 tokens, 64 head size] per layer, 4 layers in half precision
+    EXPECT_EQ(planner.getKvBlockSize(), 2 * 8 * 64 * 64 * 4 * 2);
+    // Float logits of 8 sequences plus int32 ids, parent ids and float log probs of 8 x 1024 tokens
+    EXPECT_EQ(planner.getDecoderBufferSize(), 8 * 32000 * 4 + 8 * 1024 * 12);
+    EXPECT_EQ(planner.getPinnedBufferSize(), 8 * 1024 * 4 + 2 * 8 * 4);
+
+    auto const breakdown = planner.plan(2048 * kMiB, {1024 * kMiB, 256 * kMiB});
+    auto const freeAfterRuntime = (2048 - 1024 - 256) * kMiB - planner.getDecoderBufferSize();
+    EXPECT_EQ(breakdown.numKvBlocks, static_cast<SizeType32>(freeAfterRuntime / 2 / planner.getKvBlockSize()));
+    EXPECT_EQ(breakdown.numKvBlocks, 766);
+    EXPECT_EQ(breakdown.kvCache, breakdown.numKvBlocks * planner.getKvBlockSize());
+    EXPECT_EQ(breakdown.numHostKvBlocks, 128);
+    EXPECT_EQ(breakdown.numKvBlocksPerSequence, 16);
+    EXPECT_EQ(breakdown.loraCache, 0);
+    EXPECT_TRUE(breakdown.fits());
+    EXPECT_LE(breakdown.getGpuTotal(), 2048 * kMiB);
+    EXPECT_FALSE(breakdown.toString().empty());
+}
+
+TEST(MemoryPlannerTest, LimitsAndLora)
+{
+    auto modelConfig = createModelConfig();
+    modelConfig.useLoraPlugin(true);
+    auto options = createOptions();
+    options.maxKvCacheTokens = 10000;
+    MemoryPlanner planner{modelConfig, WorldConfig{}, options};
+
+    auto const breakdown = planner.plan(2048 * kMiB, {1024 * kMiB, 256 * kMiB});
+    auto const freeAfterRuntime = (2048 - 1024 - 256) * kMiB - planner.getDecoderBufferSize();
+    EXPECT_EQ(breakdown.loraCache, static_cast<std::size_t>(static_cast<double>(freeAfterRuntime) * 0.02F));
+    // ceil(10000 / 64)
+    EXPECT_EQ(breakdown.numKvBlocks, 157);
+
+    // The engine alone exceeds the memory
+    auto const tooSmall = planner.plan(1024 * kMiB, {1024 * kMiB, 256 * kMiB});
+    EXPECT_EQ(tooSmall.numKvBlocks, 0);
+    EXPECT_FALSE(tooSmall.fits());
+}
+
+TEST(MemoryPlannerTest, Int4KvCache)
+{
+    auto modelConfig = createModelConfig();
+    modelConfig.setQuantMode(common::QuantMode::int4KvCache());
+    EXPECT_EQ(modelConfig.getKvDataType(), nvinfer1::DataType::kINT8);
+    // 32 bytes of packed values and 2 fp16 group scales per head
+    EXPECT_EQ(modelConfig.getKvCacheSizePerHead(), 36);
+
+    MemoryPlanner planner{modelConfig, WorldConfig{}, createOptions()};
+    EXPECT_EQ(planner.getKvBlockSize(), 2 * 8 * 64 * 36 * 4);
+}
+
+} // namespace tensorrt_llm::runtime
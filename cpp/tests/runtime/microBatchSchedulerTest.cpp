@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/microBatchScheduler.h"
+#include "tensorrt_llm/common/tllmException.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+using RequestIds = std::vector<MicroBatchScheduler::RequestIdType>;
+
+TEST(MicroBatchSchedulerTest, SpreadsContextOverMicroBatches)
+{
+    MicroBatchScheduler scheduler{{/*numMicroBatches=*/4, /*maxBatchSize=*/64, /*maxNumTokens=*/1024}};
+    for (MicroBatchScheduler::RequestIdType requestId = 0; requestId < 8; ++requestId)
+    {
+        scheduler.enqueue(requestId, 100);
+    }
+
+    // 800 queued tokens over 4 micro batches, each takes its 200
+    for (SizeType32 mb = 0; mb < 4; ++mb)
+    {
+        auto const batch = scheduler.scheduleMicroBatch(mb);
+        EXPECT_EQ(batch.contextRequestIds, (RequestIds{2U * mb, 2U * mb + 1})) << "micro batch " << mb;
+        EXPECT_EQ(batch.numContextTokens, 200);
+        EXPECT_TRUE(batch.generationRequestIds.empty());
+    }
+    EXPECT_EQ(scheduler.getNumQueuedRequests(), 0);
+
+    // The requests generate in the micro batch that ran their context
+    auto const batch = scheduler.scheduleMicroBatch(2);
+    EXPECT_EQ(batch.generationRequestIds, (RequestIds{4, 5}));
+    EXPECT_EQ(batch.getNumTokens(), 2);
+    EXPECT_EQ(scheduler.getNumGenerationRequests(2), 2);
+}
+
+TEST(MicroBatchSchedulerTest, BalancesGenerationTokens)
+{
+    MicroBatchScheduler scheduler{{/*numMicroBatches=*/2, /*maxBatchSize=*/64, /*maxNumTokens=*/1024}};
+    for (MicroBatchScheduler::RequestIdType requestId = 0; requestId < 10; ++requestId)
+    {
+        scheduler.enqueue(requestId, 1);
+    }
+    // Ten single token contexts split evenly, then micro batch 0 has generation tokens to offset
+    EXPECT_EQ(scheduler.scheduleMicroBatch(0).contextRequestIds.size(), 5);
+    EXPECT_EQ(scheduler.scheduleMicroBatch(1).contextRequestIds.size(), 5);
+    for (MicroBatchScheduler::RequestIdType requestId = 10; requestId < 14; ++requestId)
+    {
+        scheduler.enqueue(requestId, 4);
+    }
+    // (5 in flight + 16 queued + 5 generation) / 2 = 13, micro batch 0 takes 2 requests of 4 next to its 5
+    auto const batch = scheduler.scheduleMicroBatch(0);
+    EXPECT_EQ(batch.contextRequestIds, (RequestIds{10, 11}));
+    EXPECT_EQ(batch.getNumTokens(), 13);
+}
+
+TEST(MicroBatchSchedulerTest, AdmitsRequestsLongerThanTheShare)
+{
+    MicroBatchScheduler scheduler{{/*numMicroBatches=*/4, /*maxBatchSize=*/64, /*maxNumTokens=*/1024}};
+    scheduler.enqueue(0, 1000);
+    scheduler.enqueue(1, 10);
+
+    auto batch = scheduler.scheduleMicroBatch(0);
+    EXPECT_EQ(batch.contextRequestIds, (RequestIds{0}));
+    batch = scheduler.scheduleMicroBatch(1);
+    EXPECT_EQ(batch.contextRequestIds, (RequestIds{1}));
+}
+
+TEST(MicroBatchSchedulerTest, RespectsLimits)
+{
+    MicroBatchScheduler scheduler{{/*numMicroBatches=*/1, /*maxBatchSize=*/2, /*maxNumTokens=*/100}};
+    scheduler.enqueue(0, 10);
+    scheduler.enqueue(1, 10);
+    scheduler.enqueue(2, 10);
+    EXPECT_EQ(scheduler.scheduleMicroBatch(0).contextRequestIds, (RequestIds{0, 1}));
+    // Two generation requests fill the batch
+    EXPECT_TRUE(scheduler.scheduleMicroBatch(0).contextRequestIds.empty());
+
+    EXPECT_THROW(scheduler.enqueue(3, 101), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(scheduler.scheduleMicroBatch(1), tensorrt_llm::common::TllmException);
+}
+
+TEST(MicroBatchSchedulerTest, RemovesRequests)
+{
+    MicroBatchScheduler scheduler{{/*numMicroBatches=*/2, /*maxBatchSize=*/64, /*maxNumTokens=*/1024}};
+    scheduler.enqueue(0, 10);
+    scheduler.enqueue(1, 10);
+    scheduler.enqueue(2, 10);
+    EXPECT_EQ(scheduler.scheduleMicroBatch(0).contextRequestIds, (RequestIds{0}));
+
+    // A generation request and a queued one
+    scheduler.remove(0);
+    scheduler.remove(2);
+    EXPECT_EQ(scheduler.getNumQueuedRequests(), 1);
+    auto const batch = scheduler.scheduleMicroBatch(0);
+    EXPECT_TRUE(batch.generationRequestIds.empty());
+    EXPECT_EQ(batch.contextRequestIds, (RequestIds{1}));
+}
+
+} // namespace tensorrt_llm::runtime
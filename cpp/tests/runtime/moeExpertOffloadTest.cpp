@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/moeExpertOffload.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+SizeType32 constexpr kNumExperts = 8;
+
+// Router logits of tokens that select a pair of experts each
+std::vector<float> getRouting(std::vector<std::pair<SizeType32, SizeType32>> const& tokens)
+{
+    std::vector<float> routing;
+    for (auto const& [first, second] : tokens)
+    {
+        std::vector<float> logits(kNumExperts, 0.f);
+        logits[first] = 2.f;
+        logits[second] = 1.f;
+        routing.insert(routing.end(), logits.begin(), logits.end());
+    }
+    return routing;
+}
+
+} // namespace
+
+TEST(MoeExpertResidencyTest, SplitsTokensIntoChunksThatFit)
+{
+    MoeExpertResidency residency(kNumExperts, 3, 2);
+    auto const routing = getRouting({{0, 1}, {1, 0}, {2, 3}, {0, 2}});
+    auto const chunks = residency.plan(routing.data(), 4);
+    ASSERT_EQ(chunks.size(), 2);
+
+    EXPECT_EQ(chunks[0].beginToken, 0);
+    EXPECT_EQ(chunks[0].endToken, 2);
+    ASSERT_EQ(chunks[0].loads.size(), 2);
+    EXPECT_FALSE(chunks[0].overwritesPrevious);
+    EXPECT_EQ(chunks[0].expertSlots[0], chunks[0].loads[0].slot);
+    EXPECT_EQ(chunks[0].expertSlots[1], chunks[0].loads[1].slot);
+
+    // Expert 0 stays resident, experts 2 and 3 take the empty slot and the slot of expert 1
+    EXPECT_EQ(chunks[1].beginToken, 2);
+    EXPECT_EQ(chunks[1].endToken, 4);
+    ASSERT_EQ(chunks[1].loads.size(), 2);
+    EXPECT_TRUE(chunks[1].overwritesPrevious);
+    EXPECT_EQ(chunks[1].expertSlots[0], chunks[0].expertSlots[0]);
+    EXPECT_EQ(chunks[1].expertSlots[3], chunks[0].expertSlots[1]);
+    EXPECT_FLOAT_EQ(residency.getFrequency(0), 3.f);
+}
+
+TEST(MoeExpertResidencyTest, KeepsFrequentExpertsResident)
+{
+    MoeExpertResidency residency(kNumExperts, 4, 2, 0.5f);
+    for (int step = 0; step < 4; ++step)
+    {
+        auto const routing = getRouting({{0, 1}, {0, 2}});
+        auto const chunks = residency.plan(routing.data(), 2);
+        ASSERT_EQ(chunks.size(), 1);
+        EXPECT_EQ(chunks[0].loads.empty(), step > 0);
+    }
+
+    // Expert 3 evicts expert 1 or 2, not expert 0 which every token selected
+    auto const routing = getRouting({{3, 4}});
+    auto const chunks = residency.plan(routing.data(), 1);
+    ASSERT_EQ(chunks.size(), 1);
+    ASSERT_EQ(chunks[0].loads.size(), 2);
+    auto const& slotExperts = residency.getSlotExperts();
+    EXPECT_NE(std::find(slotExperts.begin(), slotExperts.end(), 0), slotExperts.end());
+    EXPECT_NE(std::find(slotExperts.begin(), slotExperts.end(), 3), slotExperts.end());
+    EXPECT_NE(std::find(slotExperts.begin(), slotExperts.end(), 4), slotExperts.end());
+}
+
+TEST(MoeExpertResidencyTest, TiesSelectAllTiedExperts)
+{
+    MoeExpertResidency residency(kNumExperts, 3, 2);
+    std::vector<float> routing(kNumExperts, 0.f);
+    routing[5] = 1.f;
+    routing[6] = 1.f;
+    routing[7] = 1.f;
+    auto const chunks = residency.plan(routing.data(), 1);
+    ASSERT_EQ(chunks.size(), 1);
+    EXPECT_EQ(chunks[0].loads.size(), 3);
+
+    std::vector<float> const allTied(kNumExperts, 1.f);
+    EXPECT_THROW(static_cast<void>(residency.plan(allTied.data(), 1)), std::runtime_error);
+}
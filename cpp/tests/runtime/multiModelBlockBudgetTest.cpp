@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/multiModelBlockBudget.h"
+#include "tensorrt_llm/common/tllmException.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+TEST(MultiModelBlockBudgetTest, PoolsFollowDemand)
+{
+    MultiModelBlockBudget budget{10000};
+    auto const small = budget.addModel("small", 100, 2);
+    auto const large = budget.addModel("large", 200);
+    EXPECT_EQ(budget.getNumBlocks(small), 2);
+    EXPECT_EQ(budget.getNumBlocks(large), 0);
+
+    budget.updateUsage(small, {0, 20, 1});
+    budget.updateUsage(large, {0, 30, 1});
+    EXPECT_TRUE(budget.rebalance());
+    // Both demands are covered, the headroom is shared in proportion to the needed bytes
+    EXPECT_EQ(budget.getNumBlocks(small), 25);
+    EXPECT_EQ(budget.getNumBlocks(large), 37);
+    EXPECT_LE(budget.getAllocatedBytes(), budget.getMemoryBudget());
+    EXPECT_FALSE(budget.rebalance());
+}
+
+TEST(MultiModelBlockBudgetTest, IdleModelReleasesMemory)
+{
+    MultiModelBlockBudget budget{5000};
+    auto const small = budget.addModel("small", 100, 2);
+    auto const large = budget.addModel("large", 200);
+
+    budget.updateUsage(small, {0, 20, 1});
+    budget.updateUsage(large, {0, 30, 1});
+    budget.rebalance();
+    budget.updateUsage(small, {10, 20, 1});
+    budget.updateUsage(large, {5, 30, 1});
+    budget.rebalance();
+    // Oversubscribed, the missing blocks are shared in proportion to the missing bytes
+    EXPECT_EQ(budget.getNumBlocks(small), 15);
+    EXPECT_EQ(budget.getNumBlocks(large), 17);
+
+    budget.updateUsage(small, {0, 0, 0});
+    budget.updateUsage(large, {17, 30, 1});
+    budget.rebalance();
+    EXPECT_EQ(budget.getNumBlocks(small), 2);
+    EXPECT_EQ(budget.getNumBlocks(large), 24);
+
+    // Blocks in use are never taken away
+    EXPECT_THROW(budget.updateUsage(large, {25, 30, 1}), tensorrt_llm::common::TllmException);
+}
+
+TEST(MultiModelBlockBudgetTest, RoundRobinScheduling)
+{
+    MultiModelBlockBudget budget{1000};
+    auto const first = budget.addModel("first", 10);
+    auto const second = budget.addModel("second", 10);
+    EXPECT_FALSE(budget.getNextModel().has_value());
+
+    budget.updateUsage(first, {0, 1, 1});
+    EXPECT_EQ(budget.getNextModel(), first);
+    EXPECT_EQ(budget.getNextModel(), first);
+
+    budget.updateUsage(second, {0, 1, 3});
+    EXPECT_EQ(budget.getNextModel(), second);
+    EXPECT_EQ(budget.getNextModel(), first);
+    EXPECT_EQ(budget.getNextModel(), second);
+}
+
+} // namespace tensorrt_llm::runtime
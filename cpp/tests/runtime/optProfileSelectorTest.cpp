@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/optProfileSelector.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+using Range = OptProfileSelector::ProfileRange;
+
+// Decode with up to 64 tokens, mixed batches around 512 tokens and long prefills around 4096 tokens
+OptProfileSelector makeSelector()
+{
+    return OptProfileSelector{{
+        Range{1, 32, 64, 1, 64},
+        Range{1, 512, 1024, 1, 64},
+        Range{1, 4096, 8192, 1, 8},
+    }};
+}
+} // namespace
+
+TEST(OptProfileSelectorTest, GenerationOnlyPrefersDecodeProfile)
+{
+    auto const selector = makeSelector();
+    EXPECT_EQ(selector.select(48, 48, 0), 0);
+    // Too many tokens for the decode profile
+    EXPECT_EQ(selector.select(128, 64, 0), 1);
+}
+
+TEST(OptProfileSelectorTest, ContextPrefersClosestOptAbove)
+{
+    auto const selector = makeSelector();
+    EXPECT_EQ(selector.select(20, 4, 1), 0);
+    EXPECT_EQ(selector.select(300, 16, 2), 1);
+    EXPECT_EQ(selector.select(1000, 4, 1), 2);
+    // Too many sequences for the prefill profile, fall back to the largest opt below
+    EXPECT_EQ(selector.select(1000, 16, 1), 1);
+}
+
+TEST(OptProfileSelectorTest, NoProfileAccepts)
+{
+    auto const selector = makeSelector();
+    EXPECT_EQ(selector.select(10000, 1, 1), std::nullopt);
+    EXPECT_EQ(selector.select(16, 128, 0), std::nullopt);
+    EXPECT_ANY_THROW(OptProfileSelector({}));
+    EXPECT_ANY_THROW(OptProfileSelector({Range{1, 128, 64, 1, 8}}));
+}
+
+} // namespace tensorrt_llm::runtime
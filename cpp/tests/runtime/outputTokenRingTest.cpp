@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/outputTokenRing.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+SizeType32 constexpr kMaxBatchSize = 2;
+SizeType32 constexpr kCapacity = 4;
+
+class OutputTokenRingTest : public ::testing::Test
+{
+protected:
+    OutputTokenRingTest()
+        : mMemory(OutputTokenRing::getBlockSize(kMaxBatchSize, kCapacity) / sizeof(std::uint64_t), 0)
+        , mRing(kMaxBatchSize, kCapacity, IBuffer::wrap(mMemory))
+    {
+    }
+
+    //! Append tokens to the ring of slot and publish them the way invokeWriteOutputTokenRing does
+    void append(SizeType32 slot, std::uint32_t requestSeq, SizeType32 first, std::vector<TokenIdType> const& tokens,
+        bool publish = true)
+    {
+        auto* entries = reinterpret_cast<OutputTokenRing::Entry*>(mMemory.data() + kMaxBatchSize) + slot * kCapacity;
+        for (std::size_t ti = 0; ti < tokens.size(); ++ti)
+        {
+            auto const idx = first + static_cast<SizeType32>(ti);
+            entries[idx % kCapacity] = OutputTokenRing::Entry{tokens[ti], -0.5F * static_cast<float>(idx), 0};
+        }
+        if (publish)
+        {
+            mMemory[slot] = (static_cast<std::uint64_t>(requestSeq) << 32)
+                | static_cast<std::uint32_t>(first + static_cast<SizeType32>(tokens.size()));
+        }
+    }
+
+    std::vector<std::uint64_t> mMemory;
+    OutputTokenRing mRing;
+};
+} // namespace
+
+TEST_F(OutputTokenRingTest, RequestSequenceNumbers)
+{
+    EXPECT_EQ(mRing.getRequestSeq(0), 0);
+    EXPECT_EQ(mRing.startRequest(0), 1);
+    EXPECT_EQ(mRing.startRequest(0, false), 0);
+    EXPECT_EQ(mRing.getRequestSeq(0), 0);
+    // Unpublished requests still advance the numbers
+    EXPECT_EQ(mRing.startRequest(0), 3);
+    EXPECT_EQ(mRing.startRequest(1), 1);
+    EXPECT_EQ(mRing.getRequestSeq(0), 3);
+}
+
+TEST_F(OutputTokenRingTest, ReadsPublishedTokens)
+{
+    auto const requestSeq = mRing.startRequest(1);
+    std::vector<OutputTokenRing::Entry> entries;
+    auto result = mRing.read(1, requestSeq, 0, entries);
+    EXPECT_EQ(result.numTokens, 0);
+    EXPECT_TRUE(entries.empty());
+
+    append(1, requestSeq, 0, {10, 11});
+    result = mRing.read(1, requestSeq, 0, entries);
+    EXPECT_EQ(result.numTokens, 2);
+    EXPECT_FALSE(result.overrun);
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[1].token, 11);
+    EXPECT_FLOAT_EQ(entries[1].logProb, -0.5F);
+
+    // Written but not yet published
+    append(1, requestSeq, 2, {12}, false);
+    result = mRing.read(1, requestSeq, 2, entries);
+    EXPECT_EQ(result.numTokens, 2);
+    EXPECT_EQ(entries.size(), 2);
+
+    // Wraps around the ring
+    append(1, requestSeq, 2, {12, 13, 14});
+    result = mRing.read(1, requestSeq, 2, entries);
+    EXPECT_EQ(result.numTokens, 5);
+    EXPECT_FALSE(result.overrun);
+    ASSERT_EQ(entries.size(), 5);
+    EXPECT_EQ(entries[4].token, 14);
+
+    // The other slot and other requests see nothing
+    EXPECT_EQ(mRing.read(0, requestSeq, 0, entries).numTokens, 0);
+    EXPECT_EQ(mRing.read(1, requestSeq + 1, 0, entries).numTokens, 0);
+    EXPECT_EQ(entries.size(), 5);
+}
+
+TEST_F(OutputTokenRingTest, ReportsOverrun)
+{
+    auto const requestSeq = mRing.startRequest(0);
+    append(0, requestSeq, 0, {1, 2, 3, 4, 5, 6});
+    std::vector<OutputTokenRing::Entry> entries;
+    auto const result = mRing.read(0, requestSeq, 0, entries);
+    EXPECT_EQ(result.numTokens, 6);
+    EXPECT_TRUE(result.overrun);
+    // Only the last capacity tokens are left
+    ASSERT_EQ(entries.size(), kCapacity);
+    EXPECT_EQ(entries.front().token, 3);
+    EXPECT_EQ(entries.back().token, 6);
+}
+
+TEST_F(OutputTokenRingTest, StaleHeaderOfPreviousRequest)
+{
+    auto const previous = mRing.startRequest(0);
+    append(0, previous, 0, {1, 2, 3});
+    auto const current = mRing.startRequest(0);
+    std::vector<OutputTokenRing::Entry> entries;
+    EXPECT_EQ(mRing.read(0, current, 0, entries).numTokens, 0);
+    append(0, current, 0, {7});
+    EXPECT_EQ(mRing.read(0, current, 0, entries).numTokens, 1);
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(entries[0].token, 7);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/overlapScheduleState.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+TEST(OverlapScheduleStateTest, ResolveDropsFinishedRequests)
+{
+    OverlapScheduleState state;
+    state.scheduleNext({{10, 0, 1}, {11, 1, 1}, {12, 2, 4}});
+    EXPECT_TRUE(state.hasPendingStep());
+    EXPECT_ANY_THROW(state.scheduleNext({}));
+
+    auto const fixup = state.resolve({12, 42});
+    EXPECT_FALSE(state.hasPendingStep());
+    EXPECT_EQ(fixup.active, (std::vector<bool>{true, true, false}));
+    ASSERT_EQ(fixup.dropped.size(), 1);
+    EXPECT_EQ(fixup.dropped[0].seqSlot, 2);
+    EXPECT_EQ(fixup.numReleasedTokens, 4);
+    ASSERT_EQ(state.getCurrentStep().size(), 2);
+    EXPECT_EQ(state.getCurrentStep()[1].requestId, 11);
+    EXPECT_EQ(state.getNumMispredictedSteps(), 1);
+}
+
+TEST(OverlapScheduleStateTest, CorrectSpeculation)
+{
+    OverlapScheduleState state;
+    EXPECT_ANY_THROW(state.resolve({}));
+    state.scheduleNext({{1, 0, 1}});
+    auto const fixup = state.resolve({});
+    EXPECT_TRUE(fixup.dropped.empty());
+    EXPECT_EQ(fixup.numReleasedTokens, 0);
+    EXPECT_EQ(state.getNumMispredictedSteps(), 0);
+    state.scheduleNext({{1, 0, 1}});
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/pinnedStagingPool.h"
+
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+namespace tc = tensorrt_llm::common;
+
+class PinnedStagingPoolTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "No GPU detected";
+        }
+    }
+};
+
+TEST(PinnedStagingPoolSizeClassTest, RoundsUpToPowersOfTwo)
+{
+    EXPECT_EQ(PinnedStagingPool::getSizeClass(0), 0);
+    EXPECT_EQ(PinnedStagingPool::getSizeClass(1), 0);
+    EXPECT_EQ(PinnedStagingPool::getSizeClass(256), 0);
+    EXPECT_EQ(PinnedStagingPool::getSizeClass(257), 1);
+    EXPECT_EQ(PinnedStagingPool::getSizeClass(4096), 4);
+    EXPECT_EQ(PinnedStagingPool::getSizeClass(PinnedStagingPool::kMaxClassSize), PinnedStagingPool::kNumClasses - 1);
+    EXPECT_EQ(PinnedStagingPool::getSizeClass(PinnedStagingPool::kMaxClassSize + 1), PinnedStagingPool::kNumClasses);
+}
+
+TEST_F(PinnedStagingPoolTest, ReusesFreedBlocks)
+{
+    PinnedStagingPool pool;
+    auto* a = pool.allocate(1000);
+    auto* b = pool.allocate(1024);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(pool.getUsedSize(), 2048);
+    EXPECT_EQ(pool.getReservedSize(), PinnedStagingPool::kSlabSize);
+
+    pool.deallocate(a, 1000);
+    // Same size class, same block, no new slab
+    EXPECT_EQ(pool.allocate(700), a);
+    auto const stats = pool.getStats();
+    EXPECT_EQ(stats.numAllocations, 3);
+    EXPECT_EQ(stats.numMisses, 1);
+    EXPECT_EQ(stats.usedBytes, 2048);
+    EXPECT_EQ(pool.getStats().numAllocations, 0);
+
+    // A block of the wrong size class is rejected
+    EXPECT_THROW(pool.deallocate(b, 100), tc::TllmException);
+    pool.deallocate(a, 700);
+    pool.deallocate(b, 1024);
+    EXPECT_EQ(pool.getUsedSize(), 0);
+}
+
+TEST_F(PinnedStagingPoolTest, ServesLargeRequestsFromThePinnedPool)
+{
+    PinnedStagingPool pool;
+    auto const size = PinnedStagingPool::kMaxClassSize * 3;
+    auto* ptr = pool.allocate(size);
+    EXPECT_EQ(pool.getReservedSize(), 0);
+    EXPECT_EQ(pool.getUsedSize(), size);
+    pool.deallocate(ptr, size);
+    EXPECT_EQ(pool.getUsedSize(), 0);
+}
+
+TEST_F(PinnedStagingPoolTest, TrimsUnusedSlabs)
+{
+    PinnedStagingPool pool;
+    // Two slabs of the largest class, and one of the smallest
+    auto constexpr blockSize = PinnedStagingPool::kMaxClassSize;
+    auto constexpr blocksPerSlab = PinnedStagingPool::kSlabSize / blockSize;
+    std::vector<void*> blocks;
+    for (std::size_t i = 0; i < blocksPerSlab + 1; ++i)
+    {
+        blocks.push_back(pool.allocate(blockSize));
+    }
+    auto* small = pool.allocate(16);
+    EXPECT_EQ(pool.getReservedSize(), 3 * PinnedStagingPool::kSlabSize);
+
+    // Every slab is in use
+    EXPECT_EQ(pool.trimTo(0), 0);
+
+    for (auto* block : blocks)
+    {
+        pool.deallocate(block, blockSize);
+    }
+    EXPECT_EQ(pool.trimTo(2 * PinnedStagingPool::kSlabSize), PinnedStagingPool::kSlabSize);
+    EXPECT_EQ(pool.trimTo(0), PinnedStagingPool::kSlabSize);
+    EXPECT_EQ(pool.getReservedSize(), PinnedStagingPool::kSlabSize);
+    EXPECT_EQ(pool.getStats().trimmedBytes, 2 * PinnedStagingPool::kSlabSize);
+
+    // The trimmed class refills
+    pool.deallocate(pool.allocate(blockSize), blockSize);
+    pool.deallocate(small, 16);
+}
+
+TEST_F(PinnedStagingPoolTest, BacksBufferManagerStaging)
+{
+    auto& pool = PinnedStagingPool::getInstance();
+    auto const usedSize = pool.getUsedSize();
+    {
+        auto tensor = BufferManager::pinnedStaging(ITensor::makeShape({4, 100}), nvinfer1::DataType::kFLOAT);
+        EXPECT_EQ(tensor->getMemoryType(), MemoryType::kPINNEDPOOL);
+        EXPECT_EQ(pool.getUsedSize(), usedSize + 2048);
+        tensor->resize(2000);
+        EXPECT_EQ(pool.getUsedSize(), usedSize + 8192);
+    }
+    EXPECT_EQ(pool.getUsedSize(), usedSize);
+}
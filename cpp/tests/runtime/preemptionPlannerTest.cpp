@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/preemptionPlanner.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+using Ids = std::vector<PreemptionPlanner::RequestIdType>;
+} // namespace
+
+TEST(PreemptionPlannerTest, LowestPriorityLatestFirst)
+{
+    std::vector<PreemptionPlanner::Candidate> const inFlight{
+        {1, 0.2F, 4, 0}, {2, 0.2F, 4, 1}, {3, 0.5F, 8, 2}, {4, 0.9F, 16, 3}};
+    EXPECT_EQ(PreemptionPlanner::selectVictims(inFlight, 1.0F, 6, 0), (Ids{2, 1}));
+    EXPECT_EQ(PreemptionPlanner::selectVictims(inFlight, 1.0F, 6, 2), (Ids{2}));
+    EXPECT_EQ(PreemptionPlanner::selectVictims(inFlight, 1.0F, 10, 0), (Ids{2, 1, 3}));
+    EXPECT_TRUE(PreemptionPlanner::selectVictims(inFlight, 1.0F, 6, 6).empty());
+}
+
+TEST(PreemptionPlannerTest, NeverPausesEqualOrHigherPriority)
+{
+    std::vector<PreemptionPlanner::Candidate> const inFlight{{1, 0.2F, 4, 0}, {2, 0.5F, 32, 1}};
+    // Only request 1 may be paused, which is not enough
+    EXPECT_TRUE(PreemptionPlanner::selectVictims(inFlight, 0.5F, 8, 0).empty());
+    EXPECT_EQ(PreemptionPlanner::selectVictims(inFlight, 0.5F, 4, 0), (Ids{1}));
+}
+
+TEST(PreemptionPlannerTest, ResumeOrder)
+{
+    std::vector<PreemptionPlanner::Candidate> paused{{1, 0.2F, 4, 5}, {2, 0.8F, 4, 7}, {3, 0.2F, 4, 2}};
+    PreemptionPlanner::sortForResume(paused);
+    EXPECT_EQ(paused[0].requestId, 2);
+    EXPECT_EQ(paused[1].requestId, 3);
+    EXPECT_EQ(paused[2].requestId, 1);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/promptEmbeddingCache.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+SizeType32 constexpr kTableSize{256};
+std::size_t constexpr kTableBytes{kTableSize * sizeof(float)};
+
+class PromptEmbeddingCacheTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    void SetUp() override
+    {
+        if (common::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "No GPU detected";
+        }
+        mManager = std::make_unique<BufferManager>(std::make_shared<CudaStream>());
+    }
+
+    [[nodiscard]] ITensor::SharedPtr makeTable(float value) const
+    {
+        auto table = BufferManager::cpu(ITensor::makeShape({1, kTableSize}), nvinfer1::DataType::kFLOAT);
+        auto* data = bufferCast<float>(*table);
+        std::fill(data, data + kTableSize, value);
+        return table;
+    }
+
+    [[nodiscard]] float readFirst(ITensor::SharedPtr const& table) const
+    {
+        auto host = mManager->copyFrom(*table, MemoryType::kCPU);
+        mManager->getStream().synchronize();
+        return bufferCast<float>(*host)[0];
+    }
+
+    std::unique_ptr<BufferManager> mManager;
+};
+
+} // namespace
+
+TEST_F(PromptEmbeddingCacheTest, SharesTablesByIdAndContent)
+{
+    PromptEmbeddingCache cache{2 * kTableBytes, kTableBytes, *mManager};
+    EXPECT_FALSE(cache.get(1).has_value());
+
+    auto const a = cache.put(1, *makeTable(1.F));
+    EXPECT_EQ(readFirst(a), 1.F);
+    // Same id and content, nothing is copied
+    EXPECT_EQ(cache.put(1, *makeTable(1.F)), a);
+    // Another id with the same content shares the device copy
+    EXPECT_EQ(cache.put(2, *makeTable(1.F)), a);
+    auto const cached = cache.get(2);
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(*cached, a);
+
+    auto const& stats = cache.getStats();
+    EXPECT_EQ(stats.deviceBytes, kTableBytes);
+    EXPECT_EQ(stats.numDedups, 1);
+    EXPECT_EQ(stats.numHits, 2);
+    EXPECT_EQ(stats.numMisses, 2);
+
+    // Rebinding an id keeps the table of the other id
+    auto const b = cache.put(1, *makeTable(2.F));
+    EXPECT_NE(b, a);
+    EXPECT_EQ(readFirst(b), 2.F);
+    EXPECT_EQ(readFirst(*cache.get(2)), 1.F);
+    EXPECT_EQ(stats.deviceBytes, 2 * kTableBytes);
+
+    cache.erase(2);
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_EQ(stats.deviceBytes, kTableBytes);
+}
+
+TEST_F(PromptEmbeddingCacheTest, SpillsToHostAndReloads)
+{
+    PromptEmbeddingCache cache{2 * kTableBytes, kTableBytes, *mManager};
+    static_cast<void>(cache.put(1, *makeTable(1.F)));
+    static_cast<void>(cache.put(2, *makeTable(2.F)));
+    // Spills table 1, the least recently used, to the host
+    static_cast<void>(cache.put(3, *makeTable(3.F)));
+    auto const& stats = cache.getStats();
+    EXPECT_EQ(stats.numSpills, 1);
+    EXPECT_EQ(stats.deviceBytes, 2 * kTableBytes);
+    EXPECT_EQ(stats.hostBytes, kTableBytes);
+
+    // Reloading table 1 evicts table 2, which does not fit on the host next to table 1 and is dropped
+    auto const reloaded = cache.get(1);
+    ASSERT_TRUE(reloaded.has_value());
+    EXPECT_EQ(readFirst(*reloaded), 1.F);
+    EXPECT_EQ(stats.numReloads, 1);
+    EXPECT_FALSE(cache.contains(2));
+    EXPECT_TRUE(cache.contains(3));
+    EXPECT_EQ(stats.deviceBytes, 2 * kTableBytes);
+    // The host copy of table 1 is kept, spilling it again needs no copy
+    EXPECT_EQ(stats.hostBytes, kTableBytes);
+}
+
+} // namespace tensorrt_llm::runtime
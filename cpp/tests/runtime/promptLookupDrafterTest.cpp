@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/promptLookupDrafter.h"
+#include "tensorrt_llm/common/tllmException.h"
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+using Tokens = std::vector<TokenIdType>;
+
+TEST(PromptLookupDrafterTest, DraftsContinuationFromPrompt)
+{
+    PromptLookupDrafter drafter{3, 4};
+    drafter.setup({10, 11, 12, 13, 14, 15, 16, 20, 21});
+    // No suffix of the prompt occurred before
+    EXPECT_TRUE(drafter.draft().empty());
+
+    drafter.append({11, 12});
+    EXPECT_EQ(drafter.draft(), (Tokens{13, 14, 15, 16}));
+
+    // The latest earlier occurrence of the suffix is used
+    drafter.append({13, 14, 15});
+    EXPECT_EQ(drafter.draft(), (Tokens{16, 20, 21, 11}));
+}
+
+TEST(PromptLookupDrafterTest, PrefersLongestSuffix)
+{
+    PromptLookupDrafter drafter{2, 2};
+    // "2" is followed by 3 first and by 4 later, "1 2" only by 3
+    drafter.setup({1, 2, 3, 5, 2, 4, 6, 1, 2});
+    EXPECT_EQ(drafter.draft(), (Tokens{3, 5}));
+
+    drafter.setup({1, 2, 3, 5, 2, 4, 6, 7, 2});
+    EXPECT_EQ(drafter.draft(), (Tokens{4, 6}));
+}
+
+TEST(PromptLookupDrafterTest, MatchesAcceptedOutput)
+{
+    PromptLookupDrafter drafter{2, 3, 2};
+    drafter.setup({1, 2});
+    drafter.append({7, 8, 9, 3});
+    EXPECT_TRUE(drafter.draft().empty());
+
+    drafter.append({7, 8});
+    EXPECT_EQ(drafter.draft(), (Tokens{9, 3, 7}));
+    EXPECT_EQ(drafter.getSequence().size(), 8);
+}
+
+TEST(PromptLookupDrafterTest, InvalidSizes)
+{
+    EXPECT_THROW(PromptLookupDrafter(1, 4, 2), tensorrt_llm::common::TllmException);
+    EXPECT_THROW(PromptLookupDrafter(2, 0), tensorrt_llm::common::TllmException);
+}
+
+} // namespace tensorrt_llm::runtime
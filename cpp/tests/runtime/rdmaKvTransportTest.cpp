@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/runtime/rdmaKvTransport.h"
+
+#include <numeric>
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+std::size_t constexpr kBlockBytes = 1024;
+
+} // namespace
+
+TEST(KvTransferPlannerTest, CoalescesConsecutiveBlocks)
+{
+    KvTransferPlanner const planner;
+    auto const batches = planner.plan({4, 5, 6, 9, 10}, {0, 1, 2, 7, 3}, kBlockBytes);
+    ASSERT_EQ(batches.size(), 1);
+    auto const& segments = batches.front();
+    ASSERT_EQ(segments.size(), 3);
+    EXPECT_EQ(segments[0].srcOffset, 4 * kBlockBytes);
+    EXPECT_EQ(segments[0].dstOffset, 0);
+    EXPECT_EQ(segments[0].size, 3 * kBlockBytes);
+    // Consecutive in the source pool only
+    EXPECT_EQ(segments[1].dstOffset, 7 * kBlockBytes);
+    EXPECT_EQ(segments[1].size, kBlockBytes);
+    EXPECT_EQ(segments[2].srcOffset, 10 * kBlockBytes);
+    EXPECT_EQ(segments[2].dstOffset, 3 * kBlockBytes);
+}
+
+TEST(KvTransferPlannerTest, CoalescesUnorderedBlocks)
+{
+    KvTransferPlanner const planner;
+    auto const batches = planner.plan({2, 0, 1}, {12, 10, 11}, kBlockBytes);
+    ASSERT_EQ(batches.size(), 1);
+    ASSERT_EQ(batches.front().size(), 1);
+    EXPECT_EQ(batches.front().front().srcOffset, 0);
+    EXPECT_EQ(batches.front().front().dstOffset, 10 * kBlockBytes);
+    EXPECT_EQ(batches.front().front().size, 3 * kBlockBytes);
+}
+
+TEST(KvTransferPlannerTest, SplitsSegmentsAndBatches)
+{
+    KvTransferPlanner::Config config;
+    config.maxSegmentBytes = 2 * kBlockBytes;
+    config.maxSegmentsPerBatch = 2;
+    KvTransferPlanner const planner{config};
+
+    std::vector<SizeType32> blocks(7);
+    std::iota(blocks.begin(), blocks.end(), 0);
+    auto const batches = planner.plan(blocks, blocks, kBlockBytes);
+    ASSERT_EQ(batches.size(), 2);
+    EXPECT_EQ(batches[0].size(), 2);
+    ASSERT_EQ(batches[1].size(), 2);
+    EXPECT_EQ(batches[1][0].srcOffset, 4 * kBlockBytes);
+    EXPECT_EQ(batches[1][0].size, 2 * kBlockBytes);
+    EXPECT_EQ(batches[1][1].size, kBlockBytes);
+}
+
+TEST(KvTransferPlannerTest, RejectsMismatchedBlockLists)
+{
+    KvTransferPlanner const planner;
+    EXPECT_TRUE(planner.plan({}, {}, kBlockBytes).empty());
+    EXPECT_THROW((void) planner.plan({0, 1}, {0}, kBlockBytes), std::runtime_error);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/runtime/requestMigration.h"
+
+namespace tle = tensorrt_llm::executor;
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+
+tle::MigratedRequest makeMigrated(bool streaming, tle::OutputConfig outputConfig = tle::OutputConfig{})
+{
+    tle::Request request({1, 2, 3}, 8, streaming, tle::SamplingConfig{}, outputConfig);
+    return tle::MigratedRequest{
+        std::move(request), {4, 5}, std::nullopt, std::nullopt, 2, tle::ContextPhaseParams{tle::VecTokens{5}}};
+}
+
+} // namespace
+
+TEST(RequestMigrationTest, ContinuesFromGeneratedTokens)
+{
+    RequestMigration const migration{makeMigrated(false)};
+    EXPECT_EQ(migration.getInputTokenIds(), (tle::VecTokens{1, 2, 3, 4, 5}));
+    EXPECT_EQ(migration.getNumCachedTokens(), 4);
+    EXPECT_EQ(migration.getMaxNewTokens(), 6);
+    EXPECT_EQ(migration.getRandomStep(), 2);
+}
+
+TEST(RequestMigrationTest, StitchesFullOutputs)
+{
+    tle::OutputConfig outputConfig;
+    outputConfig.returnLogProbs = true;
+    auto migrated = makeMigrated(false, outputConfig);
+    migrated.logProbs = tle::VecLogProbs{-1.f, -2.f};
+    migrated.cumLogProb = -3.f;
+    RequestMigration const migration{std::move(migrated)};
+
+    tle::Result result{};
+    result.outputTokenIds = {{6, 7}};
+    result.logProbs = std::vector<tle::VecLogProbs>{{-0.5f, -0.25f}};
+    result.cumLogProbs = tle::VecLogProbs{-0.75f};
+    migration.stitch(result);
+    EXPECT_EQ(result.outputTokenIds.at(0), (tle::VecTokens{1, 2, 3, 4, 5, 6, 7}));
+    EXPECT_EQ(result.logProbs->at(0), (tle::VecLogProbs{-1.f, -2.f, -0.5f, -0.25f}));
+    EXPECT_FLOAT_EQ(result.cumLogProbs->at(0), -3.75f);
+}
+
+TEST(RequestMigrationTest, StitchesWithoutInput)
+{
+    tle::OutputConfig outputConfig;
+    outputConfig.excludeInputFromOutput = true;
+    RequestMigration const migration{makeMigrated(false, outputConfig)};
+
+    tle::Result result{};
+    result.outputTokenIds = {{6}};
+    migration.stitch(result);
+    EXPECT_EQ(result.outputTokenIds.at(0), (tle::VecTokens{4, 5, 6}));
+}
+
+TEST(RequestMigrationTest, PassesStreamedDeltas)
+{
+    auto migrated = makeMigrated(true);
+    migrated.cumLogProb = -1.f;
+    RequestMigration const migration{std::move(migrated)};
+
+    tle::Result result{};
+    result.outputTokenIds = {{6}};
+    result.cumLogProbs = tle::VecLogProbs{-0.5f};
+    migration.stitch(result);
+    EXPECT_EQ(result.outputTokenIds.at(0), (tle::VecTokens{6}));
+    EXPECT_FLOAT_EQ(result.cumLogProbs->at(0), -1.5f);
+}
+
+TEST(RequestMigrationTest, RejectsFinishedRequests)
+{
+    auto migrated = makeMigrated(false);
+    migrated.generatedTokens.assign(8, 4);
+    EXPECT_THROW(RequestMigration{std::move(migrated)}, std::runtime_error);
+
+    auto empty = makeMigrated(false);
+    empty.generatedTokens.clear();
+    EXPECT_THROW(RequestMigration{std::move(empty)}, std::runtime_error);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/requestTimingCollector.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+namespace tle = executor;
+using ms = std::chrono::milliseconds;
+auto const t0 = RequestTimingCollector::TimePoint{} + ms{1000};
+
+tle::RequestStats makeStats(tle::IdType id, tle::RequestStage stage, tle::SizeType32 contextPrefillPosition,
+    bool scheduled, bool paused = false)
+{
+    tle::RequestStats stats{};
+    stats.id = id;
+    stats.stage = stage;
+    stats.contextPrefillPosition = contextPrefillPosition;
+    stats.scheduled = scheduled;
+    stats.paused = paused;
+    return stats;
+}
+
+tle::Response makeResponse(tle::IdType id, tle::VecTokens tokens)
+{
+    tle::Result result{};
+    result.outputTokenIds = {std::move(tokens)};
+    return tle::Response{id, std::move(result)};
+}
+} // namespace
+
+TEST(RequestTimingCollectorTest, RecordsTimeline)
+{
+    RequestTimingCollector collector;
+    tle::IdType constexpr id = 3;
+    collector.recordArrival(id, t0);
+    EXPECT_EQ(collector.getTimingStats(id)->arrivalTimeUs, 1000000);
+
+    // Queued, then two context chunks
+    collector.recordRequestStats({0, {makeStats(id, tle::RequestStage::kQUEUED, 0, false)}}, t0 + ms{5});
+    collector.recordRequestStats(
+        {1, {makeStats(id, tle::RequestStage::kCONTEXT_IN_PROGRESS, 64, true)}}, t0 + ms{10});
+    collector.recordRequestStats(
+        {2, {makeStats(id, tle::RequestStage::kGENERATION_IN_PROGRESS, 100, true)}}, t0 + ms{20});
+    collector.recordResponses({makeResponse(id, {7})}, t0 + ms{22});
+
+    // Paused once
+    collector.recordRequestStats(
+        {3, {makeStats(id, tle::RequestStage::kGENERATION_IN_PROGRESS, 100, false, true)}}, t0 + ms{30});
+    collector.recordRequestStats(
+        {4, {makeStats(id, tle::RequestStage::kGENERATION_IN_PROGRESS, 100, false, true)}}, t0 + ms{35});
+    collector.recordRequestStats(
+        {5, {makeStats(id, tle::RequestStage::kGENERATION_IN_PROGRESS, 100, true)}}, t0 + ms{42});
+    collector.recordResponses({makeResponse(id, {8}), makeResponse(id + 1, {9})}, t0 + ms{45});
+    // Responses without tokens do not count
+    collector.recordResponses({makeResponse(id, {})}, t0 + ms{50});
+
+    auto const timing = collector.take(id);
+    ASSERT_TRUE(timing.has_value());
+    EXPECT_DOUBLE_EQ(timing->firstScheduledMS.value(), 10.0);
+    EXPECT_EQ(timing->contextChunkEndMS, (std::vector<double>{10.0, 20.0}));
+    EXPECT_DOUBLE_EQ(timing->firstTokenMS.value(), 22.0);
+    EXPECT_DOUBLE_EQ(timing->lastTokenMS.value(), 45.0);
+    EXPECT_EQ(timing->numPauses, 1);
+    EXPECT_DOUBLE_EQ(timing->pausedMS, 12.0);
+    EXPECT_FALSE(collector.take(id).has_value());
+    EXPECT_EQ(collector.getNumRequests(), 0U);
+}
+
+TEST(RequestTimingCollectorTest, UnchunkedContextEndsWithGeneration)
+{
+    RequestTimingCollector collector;
+    collector.recordArrival(1, t0);
+    collector.recordRequestStats({0, {makeStats(1, tle::RequestStage::kCONTEXT_IN_PROGRESS, 0, true)}}, t0 + ms{2});
+    EXPECT_TRUE(collector.getTimingStats(1)->contextChunkEndMS.empty());
+    collector.recordRequestStats(
+        {1, {makeStats(1, tle::RequestStage::kGENERATION_IN_PROGRESS, 0, true)}}, t0 + ms{9});
+    collector.recordRequestStats(
+        {2, {makeStats(1, tle::RequestStage::kGENERATION_COMPLETE, 0, false)}}, t0 + ms{15});
+    EXPECT_EQ(collector.getTimingStats(1)->contextChunkEndMS, (std::vector<double>{9.0}));
+    // Unknown requests are ignored
+    EXPECT_FALSE(collector.getTimingStats(2).has_value());
+}
+
+} // namespace tensorrt_llm::runtime
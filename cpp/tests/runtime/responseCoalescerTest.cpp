@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tensorrt_llm/runtime/responseCoalescer.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace texec = tensorrt_llm::executor;
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+texec::Response makeResponse(texec::IdType requestId, texec::VecTokens tokens, bool isFinal = false,
+    texec::SizeType32 sequenceIndex = 0)
+{
+    texec::Result result;
+    result.isFinal = isFinal;
+    result.isSequenceFinal = isFinal;
+    result.outputTokenIds = {std::move(tokens)};
+    result.sequenceIndex = sequenceIndex;
+    return texec::Response{requestId, std::move(result)};
+}
+
+texec::VecTokens getTokens(texec::Response const& response)
+{
+    return response.getResult().outputTokenIds.front();
+}
+
+} // namespace
+
+TEST(ResponseCoalescerTest, PassThroughWithoutConfig)
+{
+    ResponseCoalescer coalescer;
+    EXPECT_FALSE(coalescer.isEnabled());
+    auto const out = coalescer.push({makeResponse(1, {10}), makeResponse(2, {20})});
+    ASSERT_EQ(out.size(), 2);
+    EXPECT_EQ(getTokens(out[0]), texec::VecTokens{10});
+    EXPECT_EQ(getTokens(out[1]), texec::VecTokens{20});
+    EXPECT_EQ(coalescer.getNumHeld(), 0);
+}
+
+TEST(ResponseCoalescerTest, MaxTokens)
+{
+    ResponseCoalescer coalescer{texec::ResponseCoalescingConfig{3}};
+    EXPECT_TRUE(coalescer.push({makeResponse(1, {10})}).empty());
+    EXPECT_TRUE(coalescer.push({makeResponse(1, {11})}).empty());
+    EXPECT_EQ(coalescer.getNumHeld(), 1);
+    auto const out = coalescer.push({makeResponse(1, {12})});
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(out[0].getRequestId(), 1);
+    EXPECT_EQ(getTokens(out[0]), (texec::VecTokens{10, 11, 12}));
+    EXPECT_EQ(coalescer.getNumHeld(), 0);
+
+    // The final response goes out with whatever is held
+    EXPECT_TRUE(coalescer.push({makeResponse(1, {13})}).empty());
+    auto const last = coalescer.push({makeResponse(1, {14}, true)});
+    ASSERT_EQ(last.size(), 1);
+    EXPECT_TRUE(last[0].getResult().isFinal);
+    EXPECT_EQ(getTokens(last[0]), (texec::VecTokens{13, 14}));
+}
+
+TEST(ResponseCoalescerTest, MaxDelay)
+{
+    ResponseCoalescer coalescer{texec::ResponseCoalescingConfig{std::nullopt, 10ms}};
+    auto const start = ResponseCoalescer::Clock::now();
+    EXPECT_TRUE(coalescer.push({makeResponse(1, {10})}, start).empty());
+    EXPECT_TRUE(coalescer.push({makeResponse(1, {11})}, start + 5ms).empty());
+    ASSERT_TRUE(coalescer.getNextDeadline().has_value());
+    EXPECT_EQ(*coalescer.getNextDeadline(), start + 10ms);
+    EXPECT_TRUE(coalescer.flushExpired(start + 9ms).empty());
+    auto const out = coalescer.flushExpired(start + 10ms);
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(getTokens(out[0]), (texec::VecTokens{10, 11}));
+    EXPECT_FALSE(coalescer.getNextDeadline().has_value());
+
+    // An expired deadline is also honored on push
+    EXPECT_TRUE(coalescer.push({makeResponse(1, {12})}, start + 20ms).empty());
+    EXPECT_EQ(coalescer.push({makeResponse(1, {13})}, start + 31ms).size(), 1);
+}
+
+TEST(ResponseCoalescerTest, FlushTokens)
+{
+    ResponseCoalescer coalescer{texec::ResponseCoalescingConfig{std::nullopt, std::nullopt, {13}}};
+    EXPECT_TRUE(coalescer.push({makeResponse(1, {10})}).empty());
+    auto const out = coalescer.push({makeResponse(1, {13})});
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(getTokens(out[0]), (texec::VecTokens{10, 13}));
+}
+
+TEST(ResponseCoalescerTest, RequestConfigOverridesDefault)
+{
+    ResponseCoalescer coalescer{texec::ResponseCoalescingConfig{4}};
+    coalescer.setRequestConfig(2, texec::ResponseCoalescingConfig{1});
+    auto const out = coalescer.push({makeResponse(1, {10}), makeResponse(2, {20})});
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(out[0].getRequestId(), 2);
+    EXPECT_EQ(coalescer.getNumHeld(), 1);
+}
+
+TEST(ResponseCoalescerTest, ErrorFlushesRequest)
+{
+    ResponseCoalescer coalescer{texec::ResponseCoalescingConfig{8}};
+    EXPECT_TRUE(coalescer.push({makeResponse(1, {10}), makeResponse(2, {20})}).empty());
+    auto const out = coalescer.push({texec::Response{1, "failed"}});
+    ASSERT_EQ(out.size(), 2);
+    EXPECT_EQ(getTokens(out[0]), texec::VecTokens{10});
+    EXPECT_TRUE(out[1].hasError());
+    EXPECT_EQ(coalescer.getNumHeld(), 1);
+}
+
+TEST(ResponseCoalescerTest, SequencesAreHeldSeparately)
+{
+    ResponseCoalescer coalescer{texec::ResponseCoalescingConfig{2}};
+    EXPECT_TRUE(coalescer.push({makeResponse(1, {10}, false, 0), makeResponse(1, {20}, false, 1)}).empty());
+    EXPECT_EQ(coalescer.getNumHeld(), 2);
+    auto const out = coalescer.push({makeResponse(1, {21}, false, 1)});
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(out[0].getResult().sequenceIndex, 1);
+    EXPECT_EQ(getTokens(out[0]), (texec::VecTokens{20, 21}));
+}
+
+TEST(ResponseCoalescerTest, BeamSearchReplaces)
+{
+    ResponseCoalescer coalescer{texec::ResponseCoalescingConfig{2}};
+    texec::Result result;
+    result.isFinal = false;
+    result.isSequenceFinal = false;
+    result.outputTokenIds = {{10}, {11}};
+    EXPECT_TRUE(coalescer.push({texec::Response{1, result}}).empty());
+    result.outputTokenIds = {{10, 12}, {11, 13}};
+    auto const out = coalescer.push({texec::Response{1, result}});
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_EQ(out[0].getResult().outputTokenIds, (texec::BeamTokens{{10, 12}, {11, 13}}));
+}
+
+TEST(ResponseCoalescerTest, LogProbsAreAppended)
+{
+    ResponseCoalescer coalescer{texec::ResponseCoalescingConfig{2}};
+    auto first = makeResponse(1, {10}).getResult();
+    first.logProbs = std::vector<texec::VecLogProbs>{{-1.F}};
+    auto second = makeResponse(1, {11}).getResult();
+    second.logProbs = std::vector<texec::VecLogProbs>{{-2.F}};
+    EXPECT_TRUE(coalescer.push({texec::Response{1, first}}).empty());
+    auto const out = coalescer.push({texec::Response{1, second}});
+    ASSERT_EQ(out.size(), 1);
+    ASSERT_TRUE(out[0].getResult().logProbs.has_value());
+    EXPECT_EQ(out[0].getResult().logProbs->front(), (texec::VecLogProbs{-1.F, -2.F}));
+}
+
+TEST(ResponseCoalescingConfigTest, Validation)
+{
+    EXPECT_THROW(texec::ResponseCoalescingConfig{0}, std::exception);
+    EXPECT_THROW(texec::ResponseCoalescingConfig(std::nullopt, -1ms), std::exception);
+}
+
+} // namespace tensorrt_llm::runtime
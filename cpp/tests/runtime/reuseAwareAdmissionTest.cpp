@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/reuseAwareAdmission.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+using RequestIds = std::vector<ReuseAwareAdmission::RequestIdType>;
+} // namespace
+
+TEST(ReuseAwareAdmissionTest, HighReuseFirst)
+{
+    ReuseAwareAdmission const admission{};
+    auto const order = admission.order({{1, 0}, {2, 512}, {3, 64}, {4, 512}});
+    EXPECT_EQ(order, (RequestIds{2, 4, 3, 1}));
+}
+
+TEST(ReuseAwareAdmissionTest, StarvationProtection)
+{
+    ReuseAwareAdmission admission{2};
+    std::vector<ReuseAwareAdmission::Candidate> queued{{1, 0}, {2, 0}, {3, 256}};
+    // Request 3 arrived last but is admitted first, passing over 1 and 2
+    EXPECT_EQ(admission.order(queued).front(), 3);
+    admission.update(queued, {3});
+    EXPECT_EQ(admission.getNumBypasses(1), 1);
+    EXPECT_EQ(admission.getNumBypasses(2), 1);
+    EXPECT_EQ(admission.getNumBypasses(3), 0);
+
+    // Admitting the first in arrival order passes nobody over
+    queued = {{1, 0}, {2, 0}, {4, 256}};
+    admission.update(queued, {});
+    EXPECT_EQ(admission.getNumBypasses(1), 1);
+
+    admission.update(queued, {4});
+    EXPECT_EQ(admission.getNumBypasses(1), 2);
+    queued = {{1, 0}, {2, 0}, {5, 1024}};
+    EXPECT_EQ(admission.order(queued), (RequestIds{1, 2, 5}));
+
+    // Requests that left the queue are forgotten
+    admission.update(queued, {1});
+    EXPECT_EQ(admission.getNumBypasses(1), 0);
+    EXPECT_EQ(admission.getNumBypasses(2), 2);
+    EXPECT_EQ(admission.getNumBypasses(5), 0);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/rnnStateCache.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+VecUniqueTokens makeTokens(std::vector<TokenIdType> const& ids)
+{
+    VecUniqueTokens tokens;
+    for (auto const id : ids)
+    {
+        tokens.push_back(UniqueToken{id, 0});
+    }
+    return tokens;
+}
+
+} // namespace
+
+class RnnStateCacheTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    static constexpr SizeType32 kTokensPerBlock = 2;
+
+    void SetUp() override
+    {
+        if (common::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+        mManager = std::make_unique<BufferManager>(std::make_shared<CudaStream>());
+        // An SSM and a conv state of a single layer
+        mStates = {mManager->gpu(ITensor::makeShape({1, 4}), nvinfer1::DataType::kFLOAT),
+            mManager->gpu(ITensor::makeShape({1, 2}), nvinfer1::DataType::kFLOAT)};
+    }
+
+    [[nodiscard]] std::size_t getSnapshotSize() const
+    {
+        return mStates[0]->getSizeInBytes() + mStates[1]->getSizeInBytes();
+    }
+
+    void setStates(float value)
+    {
+        for (auto const& state : mStates)
+        {
+            std::vector<float> const values(state->getSize(), value);
+            mManager->copy(values.data(), *state, MemoryType::kCPU);
+        }
+    }
+
+    void expectStates(float value)
+    {
+        for (auto const& state : mStates)
+        {
+            std::vector<float> values(state->getSize());
+            mManager->copy(*state, values.data(), MemoryType::kCPU);
+            mManager->getStream().synchronize();
+            EXPECT_EQ(values, std::vector<float>(state->getSize(), value));
+        }
+    }
+
+    std::unique_ptr<BufferManager> mManager;
+    std::vector<ITensor::SharedPtr> mStates;
+};
+
+TEST_F(RnnStateCacheTest, RestoresBlockAlignedPrefixes)
+{
+    RnnStateCache cache{kTokensPerBlock, getSnapshotSize(), 4, 0, *mManager};
+    auto const prompt = makeTokens({1, 2, 3, 4, 5});
+
+    setStates(1.f);
+    EXPECT_FALSE(cache.store(prompt, 0, 3, mStates));
+    EXPECT_TRUE(cache.store(prompt, 0, 4, mStates));
+    EXPECT_FALSE(cache.store(prompt, 0, 4, mStates));
+    setStates(0.f);
+
+    auto const match = cache.findLongestPrefix(makeTokens({1, 2, 3, 4, 9, 9}), 0);
+    ASSERT_TRUE(match.has_value());
+    EXPECT_EQ(match->numTokens, 4);
+    EXPECT_TRUE(cache.restore(*match, mStates));
+    expectStates(1.f);
+
+    // The last prompt token is always computed, and other LoRA tasks or prefixes don't match.
+    EXPECT_FALSE(cache.findLongestPrefix(makeTokens({1, 2, 3, 4}), 0).has_value());
+    EXPECT_FALSE(cache.findLongestPrefix(prompt, 1).has_value());
+    EXPECT_FALSE(cache.findLongestPrefix(makeTokens({1, 3, 3, 4, 5}), 0).has_value());
+
+    auto const& stats = cache.getStats();
+    EXPECT_EQ(stats.numDeviceSnapshots, 1);
+    EXPECT_EQ(stats.numHits, 1);
+    EXPECT_EQ(stats.numMisses, 3);
+    EXPECT_EQ(stats.numReusedTokens, 4);
+}
+
+TEST_F(RnnStateCacheTest, OffloadsToHostBeforeEvicting)
+{
+    RnnStateCache cache{kTokensPerBlock, getSnapshotSize(), 1, 1, *mManager};
+    auto const a = makeTokens({1, 2, 0});
+    auto const b = makeTokens({3, 4, 0});
+    auto const c = makeTokens({5, 6, 0});
+
+    setStates(1.f);
+    EXPECT_TRUE(cache.store(a, 0, 2, mStates));
+    setStates(2.f);
+    EXPECT_TRUE(cache.store(b, 0, 2, mStates));
+    EXPECT_EQ(cache.getStats().numHostSnapshots, 1);
+    EXPECT_EQ(cache.getStats().numOffloadedSnapshots, 1);
+
+    // a was offloaded and is restored from host memory.
+    setStates(0.f);
+    auto const matchA = cache.findLongestPrefix(a, 0);
+    ASSERT_TRUE(matchA.has_value());
+    EXPECT_TRUE(cache.restore(*matchA, mStates));
+    expectStates(1.f);
+
+    // Storing c offloads b and drops a from the full host pool.
+    setStates(3.f);
+    EXPECT_TRUE(cache.store(c, 0, 2, mStates));
+    EXPECT_FALSE(cache.restore(*matchA, mStates));
+    EXPECT_FALSE(cache.findLongestPrefix(a, 0).has_value());
+
+    auto const matchB = cache.findLongestPrefix(b, 0);
+    ASSERT_TRUE(matchB.has_value());
+    EXPECT_TRUE(cache.restore(*matchB, mStates));
+    expectStates(2.f);
+
+    auto const& stats = cache.getStats();
+    EXPECT_EQ(stats.numDeviceSnapshots, 1);
+    EXPECT_EQ(stats.numHostSnapshots, 1);
+    EXPECT_EQ(stats.numOffloadedSnapshots, 2);
+    EXPECT_EQ(stats.numEvictedSnapshots, 1);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -19,6 +19,8 @@
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/common/stlUtils.h"
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/batchedCopier.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/common.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
@@ -30,6 +32,7 @@
 #include <cstdint>
 #include <memory>
 #include <numeric>
+#include <random>
 #include <vector>
 
 using namespace tensorrt_llm::runtime;
@@ -998,3 +1001,147 @@ TEST_F(RuntimeKernelTest, CopyBatchStride5)
 {
     testCopyBatch(5, *mManager, *mStream);
 }
+
+TEST_F(RuntimeKernelTest, BatchedFill)
+{
+    SizeType32 constexpr batchSize{8};
+    SizeType32 constexpr rowSize{1000};
+    auto ints = mManager->gpu(ITensor::makeShape({batchSize, rowSize}), nvinfer1::DataType::kINT32);
+    auto bytes = mManager->gpu(ITensor::makeShape({batchSize}), nvinfer1::DataType::kUINT8);
+    mManager->setZero(*ints);
+    kernels::invokeFill(*bytes, std::uint8_t{1}, *mStream);
+
+    std::vector<std::int32_t> const srcHost{7, 8, 9};
+    auto src = mManager->copyFrom(srcHost, MemoryType::kGPU);
+
+    std::vector<SizeType32> const slots{1, 4, 6};
+    std::vector<kernels::BatchedFill> fills;
+    for (auto const slot : slots)
+    {
+        fills.push_back(kernels::BatchedFill::create(bufferCast<std::int32_t>(*ints) + slot * rowSize,
+            static_cast<std::size_t>(rowSize), -1, bufferCast<std::int32_t>(*src), srcHost.size()));
+        fills.push_back(kernels::BatchedFill::create(bufferCast<std::uint8_t>(*bytes) + slot, 1, std::uint8_t{0}));
+    }
+    auto fillsDevice = mManager->gpu(fills.size() * sizeof(kernels::BatchedFill), nvinfer1::DataType::kUINT8);
+    mManager->copy(fills.data(), *fillsDevice);
+    kernels::invokeBatchedFill(
+        static_cast<kernels::BatchedFill const*>(fillsDevice->data()), fills.size(), rowSize, *mStream);
+
+    auto intsHost = mManager->copyFrom(*ints, MemoryType::kCPU);
+    auto bytesHost = mManager->copyFrom(*bytes, MemoryType::kCPU);
+    auto const intsPtr = bufferCast<std::int32_t>(*intsHost);
+    auto const bytesPtr = bufferCast<std::uint8_t>(*bytesHost);
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const isFilled = std::find(slots.begin(), slots.end(), bi) != slots.end();
+        EXPECT_EQ(bytesPtr[bi], isFilled ? 0 : 1);
+        for (SizeType32 i = 0; i < rowSize; ++i)
+        {
+            auto const expected = !isFilled ? 0 : (i < static_cast<SizeType32>(srcHost.size()) ? srcHost[i] : -1);
+            ASSERT_EQ(intsPtr[bi * rowSize + i], expected) << "Error at " << bi << ", " << i;
+        }
+    }
+}
+
+TEST_F(RuntimeKernelTest, BatchedCopier)
+{
+    // Sizes and offsets that exercise the 16-byte, 4-byte and byte paths, and one copy large enough for memcpy
+    std::vector<std::pair<std::size_t, std::size_t>> const offsetsAndSizes{
+        {0, 64}, {64, 12}, {80, 3}, {85, 1000}, {2048, BatchedCopier::kMinMemcpySize}};
+    auto const totalSize = 2048 + BatchedCopier::kMinMemcpySize;
+
+    std::vector<std::uint8_t> srcHost(totalSize);
+    std::iota(srcHost.begin(), srcHost.end(), std::uint8_t{1});
+    auto srcDevice = mManager->copyFrom(srcHost, MemoryType::kGPU);
+    auto srcPinned = mManager->copyFrom(srcHost, MemoryType::kPINNED);
+    auto dst = mManager->gpu(2 * totalSize, nvinfer1::DataType::kUINT8);
+    mManager->setZero(*dst);
+
+    BatchedCopier copier;
+    for (auto const& [offset, size] : offsetsAndSizes)
+    {
+        // The first half from device memory, the second half from pinned memory
+        copier.add(bufferCast<std::uint8_t>(*dst) + offset, bufferCast<std::uint8_t>(*srcDevice) + offset, size);
+        copier.add(bufferCast<std::uint8_t>(*dst) + totalSize + offset, bufferCast<std::uint8_t>(*srcPinned) + offset,
+            size);
+    }
+    EXPECT_EQ(copier.getNumCopies(), 2 * offsetsAndSizes.size());
+    copier.execute(*mManager);
+    EXPECT_EQ(copier.getNumCopies(), 0);
+
+    auto const dstHost = mManager->copyFrom(*dst, MemoryType::kCPU);
+    auto const dstPtr = bufferCast<std::uint8_t>(*dstHost);
+    std::vector<bool> copied(totalSize, false);
+    for (auto const& [offset, size] : offsetsAndSizes)
+    {
+        std::fill_n(copied.begin() + offset, size, true);
+    }
+    for (std::size_t half = 0; half < 2; ++half)
+    {
+        for (std::size_t i = 0; i < totalSize; ++i)
+        {
+            ASSERT_EQ(dstPtr[half * totalSize + i], copied[i] ? srcHost[i] : 0) << "Error at " << half << ", " << i;
+        }
+    }
+
+    auto cpuBuffer = mManager->cpu(16, nvinfer1::DataType::kUINT8);
+    EXPECT_THROW(copier.add(*dst, *cpuBuffer), tc::TllmException);
+}
+
+TEST_F(RuntimeKernelTest, GatherLastTokenLmHeadTopK)
+{
+    // A vocabulary that does not fill the last tile
+    SizeType32 constexpr hiddenSize{96};
+    SizeType32 constexpr vocabSize{1000};
+    SizeType32 constexpr topK{4};
+    std::vector<SizeType32> const lastTokenIdsHost{3, 8, 10};
+    auto const batchSize = static_cast<SizeType32>(lastTokenIdsHost.size());
+    auto const numTokens = lastTokenIdsHost.back();
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    std::vector<float> hiddenHost(numTokens * hiddenSize);
+    std::vector<float> weightHost(vocabSize * hiddenSize);
+    std::generate(hiddenHost.begin(), hiddenHost.end(), [&] { return dist(gen); });
+    std::generate(weightHost.begin(), weightHost.end(), [&] { return dist(gen); });
+
+    auto hidden = mManager->copyFrom(hiddenHost, ITensor::makeShape({numTokens, hiddenSize}), MemoryType::kGPU);
+    auto weight = mManager->copyFrom(weightHost, ITensor::makeShape({vocabSize, hiddenSize}), MemoryType::kGPU);
+    auto lastTokenIds = mManager->copyFrom(lastTokenIdsHost, ITensor::makeShape({batchSize}), MemoryType::kGPU);
+    auto topKIds = mManager->gpu(ITensor::makeShape({batchSize, topK}), nvinfer1::DataType::kINT32);
+    auto topKLogits = mManager->gpu(ITensor::makeShape({batchSize, topK}), nvinfer1::DataType::kFLOAT);
+    auto fullLogits = mManager->gpu(ITensor::makeShape({batchSize, vocabSize}), nvinfer1::DataType::kFLOAT);
+    auto workspace = mManager->gpu(
+        kernels::getLmHeadTopKWorkspaceSize(batchSize, vocabSize, topK), nvinfer1::DataType::kUINT8);
+
+    kernels::gatherLastTokenLmHeadTopK(
+        *topKIds, *topKLogits, fullLogits.get(), *workspace, *hidden, *weight, *lastTokenIds, *mStream);
+
+    auto topKIdsHost = mManager->copyFrom(*topKIds, MemoryType::kCPU);
+    auto topKLogitsHost = mManager->copyFrom(*topKLogits, MemoryType::kCPU);
+    auto fullLogitsHost = mManager->copyFrom(*fullLogits, MemoryType::kCPU);
+    auto const topKIdsPtr = bufferCast<SizeType32>(*topKIdsHost);
+    auto const topKLogitsPtr = bufferCast<float>(*topKLogitsHost);
+    auto const fullLogitsPtr = bufferCast<float>(*fullLogitsHost);
+
+    for (SizeType32 bi = 0; bi < batchSize; ++bi)
+    {
+        auto const* hiddenPtr = hiddenHost.data() + (lastTokenIdsHost[bi] - 1) * hiddenSize;
+        std::vector<float> expectedLogits(vocabSize);
+        for (SizeType32 vi = 0; vi < vocabSize; ++vi)
+        {
+            expectedLogits[vi]
+                = std::inner_product(hiddenPtr, hiddenPtr + hiddenSize, weightHost.data() + vi * hiddenSize, 0.f);
+            ASSERT_NEAR(fullLogitsPtr[bi * vocabSize + vi], expectedLogits[vi], 1e-4f) << bi << ", " << vi;
+        }
+        std::vector<SizeType32> expectedIds(vocabSize);
+        std::iota(expectedIds.begin(), expectedIds.end(), 0);
+        std::partial_sort(expectedIds.begin(), expectedIds.begin() + topK, expectedIds.end(),
+            [&](SizeType32 a, SizeType32 b) { return expectedLogits[a] > expectedLogits[b]; });
+        for (SizeType32 k = 0; k < topK; ++k)
+        {
+            EXPECT_EQ(topKIdsPtr[bi * topK + k], expectedIds[k]) << bi << ", " << k;
+            EXPECT_NEAR(topKLogitsPtr[bi * topK + k], expectedLogits[expectedIds[k]], 1e-4f) << bi << ", " << k;
+        }
+    }
+}
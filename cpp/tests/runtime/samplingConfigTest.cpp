@@ -78,3 +78,27 @@ TEST(samplingConfigTest, validInputs)
         EXPECT_THAT(samplingCfg.earlyStopping.value(), testing::ElementsAre(earlyStopping));
     }
 }
+
+TEST(samplingConfigTest, numReturnSequences)
+{
+    {
+        tr::SamplingConfig samplingCfg(1);
+        EXPECT_TRUE(samplingCfg.validate());
+        samplingCfg.numReturnSequences = 4;
+        EXPECT_TRUE(samplingCfg.validate());
+        samplingCfg.numReturnSequences = 0;
+        EXPECT_FALSE(samplingCfg.validate());
+    }
+    {
+        tr::SamplingConfig samplingCfg(2);
+        samplingCfg.numReturnSequences = 2;
+        EXPECT_TRUE(samplingCfg.validate());
+        samplingCfg.numReturnSequences = 3;
+        EXPECT_FALSE(samplingCfg.validate());
+    }
+    {
+        tr::SamplingConfig samplingCfg(1);
+        samplingCfg.numReturnSequences = 3;
+        EXPECT_FALSE(samplingCfg == tr::SamplingConfig(1));
+    }
+}
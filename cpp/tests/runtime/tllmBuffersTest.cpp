@@ -27,6 +27,7 @@
 #include <algorithm>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <random>
 #include <sstream>
 #include <thread>
@@ -128,6 +129,44 @@ TEST_F(TllmBuffersTest, HostAllocator)
     EXPECT_EQ(allocator.getMemoryType(), MemoryType::kCPU);
 }
 
+TEST_F(TllmBuffersTest, TaggedAllocations)
+{
+    auto constexpr size = 1024;
+    auto& counters = MemoryCounters::getInstance();
+    counters.resetTaggedPeaks();
+    auto const untagged = counters.getTagged(MemoryTag::kUNTAGGED, MemoryType::kCPU);
+
+    std::optional<HostBuffer> buffer;
+    {
+        MemoryCounters::TagScope const loraScope{MemoryTag::kLORA};
+        {
+            MemoryCounters::TagScope const decoderScope{MemoryTag::kDECODER};
+            EXPECT_EQ(MemoryCounters::getCurrentTag(), MemoryTag::kDECODER);
+        }
+        EXPECT_EQ(MemoryCounters::getCurrentTag(), MemoryTag::kLORA);
+        buffer.emplace(size, nvinfer1::DataType::kINT8);
+    }
+    EXPECT_EQ(MemoryCounters::getCurrentTag(), MemoryTag::kUNTAGGED);
+    EXPECT_EQ(counters.getTagged(MemoryTag::kLORA, MemoryType::kCPU), size);
+
+    // The buffer keeps its tag when it is resized outside of the scope
+    buffer->resize(2 * size);
+    EXPECT_EQ(counters.getTagged(MemoryTag::kLORA, MemoryType::kCPU), 2 * size);
+    EXPECT_EQ(counters.getTagged(MemoryTag::kUNTAGGED, MemoryType::kCPU), untagged);
+    buffer->release();
+    EXPECT_EQ(counters.getTagged(MemoryTag::kLORA, MemoryType::kCPU), 0);
+    EXPECT_EQ(counters.getTaggedPeak(MemoryTag::kLORA, MemoryType::kCPU), 2 * size);
+
+    auto const stats = counters.getTagStats();
+    auto const lora = std::find_if(stats.begin(), stats.end(), [](auto const& s) { return s.tag == "lora"; });
+    ASSERT_NE(lora, stats.end());
+    EXPECT_EQ(lora->cpuMemUsage, 0);
+    EXPECT_EQ(lora->peakCpuMemUsage, 2 * size);
+
+    counters.resetTaggedPeaks();
+    EXPECT_EQ(counters.getTaggedPeak(MemoryTag::kLORA, MemoryType::kCPU), 0);
+}
+
 TEST_F(TllmBuffersTest, UVMAllocator)
 {
     auto constexpr size = 1024;
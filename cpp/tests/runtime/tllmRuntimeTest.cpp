@@ -23,6 +23,7 @@
 #include <gtest/gtest.h>
 
 #include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/runtime/engineRegistry.h"
 #include "tensorrt_llm/runtime/rawEngine.h"
 #include "tensorrt_llm/runtime/tllmLogger.h"
 #include "tensorrt_llm/runtime/tllmRuntime.h"
@@ -30,7 +31,9 @@
 #include <algorithm>
 #include <array>
 #include <filesystem>
+#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -145,3 +148,56 @@ TEST_F(TllmRuntimeTest, SinglePass)
     auto max = std::max_element(output.begin(), output.end());
     EXPECT_NEAR(*max, 0.140218f, 1e-5f);
 }
+
+TEST_F(TllmRuntimeTest, StageManagedWeights)
+{
+    EXPECT_TRUE(mSerializedEngine);
+    TllmRuntime rt{RawEngine(mSerializedEngine.get()), &mLogger, 1.0F};
+    EXPECT_FALSE(rt.hasStagedManagedWeights());
+    EXPECT_FALSE(rt.commitManagedWeights());
+
+    // The MNIST engine has no managed weights, so any update is rejected
+    std::vector<float> values(10);
+    std::map<std::string, tensorrt_llm::executor::Tensor> weights;
+    weights.emplace("weight", tensorrt_llm::executor::Tensor::of(values.data(), {10}));
+    EXPECT_THROW(rt.stageManagedWeights(weights), tc::TllmException);
+    EXPECT_FALSE(rt.hasStagedManagedWeights());
+}
+
+TEST_F(TllmRuntimeTest, ProfileContextIsReused)
+{
+    TllmRuntime rt{RawEngine(mSerializedEngine.get()), &mLogger, 1.0F};
+    EXPECT_EQ(rt.selectContext(1, 1, 0), 0);
+    EXPECT_EQ(rt.selectContext(1, 1, 1), 0);
+    EXPECT_EQ(rt.getProfileContext(0), 0);
+    EXPECT_EQ(rt.getNbContexts(), 1);
+    EXPECT_ANY_THROW(rt.getProfileContext(rt.getNbProfiles()));
+
+    rt.clearContexts();
+    EXPECT_EQ(rt.getNbContexts(), 0);
+    EXPECT_EQ(rt.getProfileContext(0), 0);
+    EXPECT_EQ(rt.getNbContexts(), 1);
+}
+
+TEST_F(TllmRuntimeTest, SharedEngine)
+{
+    RawEngine rawEngine{mSerializedEngine.get()};
+    auto const numEngines = EngineRegistry::getInstance().getNumEngines();
+    {
+        TllmRuntime first{rawEngine, &mLogger, 1.0F};
+        TllmRuntime unshared{rawEngine, &mLogger, 1.0F};
+        EXPECT_NE(&first.getEngine(), &unshared.getEngine());
+
+        rawEngine.setShareKey("mnist");
+        TllmRuntime shared{rawEngine, &mLogger, 1.0F};
+        TllmRuntime sharing{rawEngine, &mLogger, 1.0F};
+        EXPECT_EQ(&shared.getEngine(), &sharing.getEngine());
+        EXPECT_EQ(EngineRegistry::getInstance().getNumEngines(), numEngines + 1);
+
+        // Each runtime keeps its own contexts
+        shared.addContext(0);
+        EXPECT_EQ(shared.getNbContexts(), 1);
+        EXPECT_EQ(sharing.getNbContexts(), 0);
+    }
+    EXPECT_EQ(EngineRegistry::getInstance().getNumEngines(), numEngines);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/tokenBitmaskBuilder.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+//! Automaton for the decimal numbers [0-9]+
+std::shared_ptr<ByteDfa const> createNumberDfa()
+{
+    auto dfa = std::make_shared<ByteDfa>(2);
+    for (char c = '0'; c <= '9'; ++c)
+    {
+        dfa->addTransition(0, c, 1);
+        dfa->addTransition(1, c, 1);
+    }
+    dfa->setAccepting(1);
+    return dfa;
+}
+
+bool isAllowed(std::vector<std::int32_t> const& bitmask, TokenIdType token)
+{
+    return (static_cast<std::uint32_t>(bitmask[token / 32]) >> (token % 32)) & 1u;
+}
+} // namespace
+
+TEST(TokenBitmaskBuilderTest, ByteDfa)
+{
+    auto const dfa = createNumberDfa();
+    EXPECT_EQ(dfa->step(0, "42"), 1);
+    EXPECT_EQ(dfa->step(0, "4a"), ByteDfa::kDeadState);
+    EXPECT_EQ(dfa->step(0, ""), 0);
+    EXPECT_FALSE(dfa->isAccepting(0));
+    EXPECT_TRUE(dfa->isAccepting(1));
+    EXPECT_FALSE(dfa->isAccepting(ByteDfa::kDeadState));
+}
+
+TEST(TokenBitmaskBuilderTest, FillBitmask)
+{
+    // 40 tokens so the mask spans two words, token 39 is the end token and token 38 a special token
+    std::vector<std::string> tokenBytes(40, "x");
+    tokenBytes[3] = "7";
+    tokenBytes[33] = "12";
+    tokenBytes[34] = "1a";
+    tokenBytes[38] = "";
+    TokenIdType constexpr endId = 39;
+    TokenBitmaskBuilder builder{createNumberDfa(), tokenBytes, endId};
+    ASSERT_EQ(builder.getBitmaskSize(), 2);
+
+    std::vector<std::int32_t> bitmask(builder.getBitmaskSize());
+    builder.fillBitmask(0, bitmask.data());
+    for (TokenIdType token = 0; token < builder.getVocabSize(); ++token)
+    {
+        EXPECT_EQ(isAllowed(bitmask, token), token == 3 || token == 33) << token;
+    }
+
+    // The end token is allowed once a number was generated
+    auto const state = builder.advance(0, 33);
+    EXPECT_EQ(state, 1);
+    builder.fillBitmask(state, bitmask.data());
+    EXPECT_TRUE(isAllowed(bitmask, endId));
+    EXPECT_FALSE(isAllowed(bitmask, 38));
+    EXPECT_EQ(builder.advance(state, endId), state);
+    EXPECT_EQ(builder.advance(0, endId), ByteDfa::kDeadState);
+
+    builder.fillBitmask(ByteDfa::kDeadState, bitmask.data());
+    EXPECT_EQ(bitmask, (std::vector<std::int32_t>{0, 0}));
+}
+
+TEST(TokenBitmaskBuilderTest, FillBitmasksAsync)
+{
+    std::vector<std::string> tokenBytes{"1", "a", "23", ""};
+    TokenBitmaskBuilder builder{createNumberDfa(), tokenBytes, 3};
+
+    WorkerPool pool{2};
+    std::vector<ByteDfa::StateType> const states{0, 1, 1, ByteDfa::kDeadState};
+    std::vector<std::int32_t> bitmask(states.size() * builder.getBitmaskSize(), -1);
+    for (auto& future : builder.fillBitmasksAsync(pool, states, bitmask.data()))
+    {
+        future.get();
+    }
+    EXPECT_EQ(bitmask, (std::vector<std::int32_t>{0b0101, 0b1101, 0b1101, 0}));
+}
+
+} // namespace tensorrt_llm::runtime
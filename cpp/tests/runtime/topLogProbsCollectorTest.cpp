@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/topLogProbsCollector.h"
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+SizeType32 constexpr kBeamWidth = 2;
+SizeType32 constexpr kVocabSize = 8;
+SizeType32 constexpr kVocabSizePadded = 10;
+
+//! Logits whose most likely token of beam b is (step + b) % kVocabSize, followed by the next tokens in order
+executor::Tensor makeLogits(BufferManager const& manager, SizeType32 step)
+{
+    auto host = BufferManager::pinned(ITensor::makeShape({kBeamWidth, kVocabSizePadded}), nvinfer1::DataType::kFLOAT);
+    auto* data = bufferCast<float>(*host);
+    for (SizeType32 beam = 0; beam < kBeamWidth; ++beam)
+    {
+        for (SizeType32 vi = 0; vi < kVocabSizePadded; ++vi)
+        {
+            auto const rank = (vi - step - beam + 2 * kVocabSize) % kVocabSize;
+            // Padding must never be selected
+            data[beam * kVocabSizePadded + vi] = vi < kVocabSize ? -static_cast<float>(rank) : 100.f;
+        }
+    }
+    return executor::detail::ofITensor(manager.copyFrom(*host, MemoryType::kGPU));
+}
+} // namespace
+
+TEST(TopLogProbsCollectorTest, TakeReturnsStepsSinceLastTake)
+{
+    if (common::getDeviceCount() == 0)
+    {
+        GTEST_SKIP() << "No GPU available";
+    }
+    SizeType32 constexpr numTopLogProbs = 3;
+    auto stream = std::make_shared<CudaStream>();
+    BufferManager manager{stream};
+    TopLogProbsCollector collector{kVocabSize, numTopLogProbs};
+    auto processor = collector.getLogitsPostProcessor();
+    executor::BeamTokens const beamTokens(kBeamWidth);
+
+    executor::IdType constexpr requestId = 7;
+    for (SizeType32 step = 0; step < 2; ++step)
+    {
+        auto logits = makeLogits(manager, step);
+        processor(requestId, logits, beamTokens, stream, std::nullopt);
+    }
+    EXPECT_TRUE(collector.take(requestId + 1).empty());
+
+    auto const result = collector.take(requestId);
+    ASSERT_EQ(result.size(), static_cast<std::size_t>(kBeamWidth));
+    double sum{0.0};
+    for (SizeType32 vi = 0; vi < kVocabSize; ++vi)
+    {
+        sum += std::exp(-static_cast<double>(vi));
+    }
+    for (SizeType32 beam = 0; beam < kBeamWidth; ++beam)
+    {
+        ASSERT_EQ(result[beam].size(), 2U);
+        for (SizeType32 step = 0; step < 2; ++step)
+        {
+            auto const& top = result[beam][step];
+            ASSERT_EQ(top.tokens.size(), static_cast<std::size_t>(numTopLogProbs));
+            ASSERT_EQ(top.logProbs.size(), static_cast<std::size_t>(numTopLogProbs));
+            for (SizeType32 ki = 0; ki < numTopLogProbs; ++ki)
+            {
+                EXPECT_EQ(top.tokens[ki], (step + beam + ki) % kVocabSize) << beam << " " << step << " " << ki;
+                EXPECT_NEAR(top.logProbs[ki], -ki - std::log(sum), 1e-4) << beam << " " << step << " " << ki;
+            }
+        }
+    }
+    EXPECT_TRUE(collector.take(requestId).empty());
+
+    // Dropped steps are not returned
+    auto logits = makeLogits(manager, 0);
+    processor(requestId, logits, beamTokens, stream, std::nullopt);
+    collector.erase(requestId);
+    EXPECT_TRUE(collector.take(requestId).empty());
+}
+
+TEST(TopLogProbsCollectorTest, AlternativesFollowTheWrappedProcessor)
+{
+    if (common::getDeviceCount() == 0)
+    {
+        GTEST_SKIP() << "No GPU available";
+    }
+    auto stream = std::make_shared<CudaStream>();
+    BufferManager manager{stream};
+    TokenIdType constexpr bannedToken = 0;
+    // Bans the most likely token of beam 0 at step 0
+    executor::LogitsPostProcessor ban = [](executor::IdType, executor::Tensor& logits, executor::BeamTokens const&,
+                                            executor::StreamPtr const& processorStream, std::optional<executor::IdType>)
+    {
+        auto const& tensor = executor::detail::toITensor(logits);
+        float const value = -1e4f;
+        TLLM_CUDA_CHECK(cudaMemcpyAsync(bufferCast<float>(*tensor) + bannedToken, &value, sizeof(value),
+            cudaMemcpyHostToDevice, processorStream->get()));
+        processorStream->synchronize();
+    };
+    TopLogProbsCollector collector{kVocabSize, 1, ban};
+    auto processor = collector.getLogitsPostProcessor();
+
+    auto logits = makeLogits(manager, 0);
+    processor(1, logits, executor::BeamTokens(kBeamWidth), stream, std::nullopt);
+    auto const result = collector.take(1);
+    ASSERT_EQ(result.size(), static_cast<std::size_t>(kBeamWidth));
+    EXPECT_EQ(result[0].front().tokens.front(), 1);
+    EXPECT_EQ(result[1].front().tokens.front(), 1);
+}
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/runtime/traceRecorder.h"
+
+#include <nlohmann/json.hpp>
+
+using namespace tensorrt_llm::runtime;
+using namespace std::chrono_literals;
+
+namespace
+{
+// The trace events without the lane name metadata
+nlohmann::json getEvents(TraceRecorder const& recorder)
+{
+    auto events = nlohmann::json::parse(recorder.toChromeTrace())["traceEvents"];
+    nlohmann::json filtered = nlohmann::json::array();
+    for (auto& event : events)
+    {
+        if (event["ph"] != "M")
+        {
+            filtered.push_back(std::move(event));
+        }
+    }
+    return filtered;
+}
+} // namespace
+
+TEST(TraceRecorderTest, DisabledRecordsNothing)
+{
+    TraceRecorder recorder;
+    auto const t0 = TraceRecorder::Clock::time_point{};
+    recorder.recordSpan(TraceRecorder::kITERATION, TraceRecorder::Lane::kITERATION, t0, t0 + 1ms, 0);
+    {
+        TraceRecorder::ScopedSpan const span{
+            TraceRecorder::kFORWARD, TraceRecorder::Lane::kITERATION, 0, std::nullopt, recorder};
+    }
+    EXPECT_TRUE(getEvents(recorder).empty());
+}
+
+TEST(TraceRecorderTest, SpansAndFlows)
+{
+    TraceRecorder recorder;
+    recorder.setProcessId(3);
+    recorder.start(16);
+    auto const t0 = TraceRecorder::Clock::time_point{} + 1s;
+    recorder.recordSpan(TraceRecorder::kITERATION, TraceRecorder::Lane::kITERATION, t0, t0 + 2ms, 7);
+    recorder.recordRequestFlow(42, TraceRecorder::FlowPoint::kBEGIN, t0 + 1ms);
+    recorder.recordRequestFlow(42, TraceRecorder::FlowPoint::kEND, t0 + 3ms);
+
+    auto const events = getEvents(recorder);
+    ASSERT_EQ(events.size(), 3);
+    EXPECT_EQ(events[0]["name"], "iteration");
+    EXPECT_EQ(events[0]["ph"], "X");
+    EXPECT_EQ(events[0]["pid"], 3);
+    EXPECT_DOUBLE_EQ(events[0]["ts"].get<double>(), 1e6);
+    EXPECT_DOUBLE_EQ(events[0]["dur"].get<double>(), 2000.0);
+    EXPECT_EQ(events[0]["args"]["iteration"], 7);
+    EXPECT_EQ(events[1]["ph"], "s");
+    EXPECT_EQ(events[1]["id"], 42);
+    EXPECT_EQ(events[1]["bp"], "e");
+    EXPECT_EQ(events[2]["ph"], "f");
+}
+
+TEST(TraceRecorderTest, LayersEndAtReport)
+{
+    TraceRecorder recorder;
+    recorder.start(16);
+    auto const end = TraceRecorder::Clock::time_point{} + 1s;
+    recorder.recordLayerTimes({{"attention", 1.5f}, {"mlp", 0.5f}}, end);
+
+    auto const events = getEvents(recorder);
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[0]["name"], "attention");
+    EXPECT_EQ(events[0]["tid"], static_cast<int>(TraceRecorder::Lane::kLAYERS));
+    EXPECT_NEAR(events[0]["ts"].get<double>(), 1e6 - 2000.0, 1e-3);
+    EXPECT_NEAR(events[1]["ts"].get<double>(), 1e6 - 500.0, 1e-3);
+    EXPECT_DOUBLE_EQ(events[1]["dur"].get<double>(), 500.0);
+}
+
+TEST(TraceRecorderTest, RingBufferKeepsNewest)
+{
+    TraceRecorder recorder;
+    recorder.start(3);
+    auto const t0 = TraceRecorder::Clock::time_point{};
+    for (std::uint64_t iteration = 0; iteration < 5; ++iteration)
+    {
+        auto const start = t0 + iteration * 1ms;
+        recorder.recordSpan(TraceRecorder::kITERATION, TraceRecorder::Lane::kITERATION, start, start + 1ms, iteration);
+    }
+    EXPECT_EQ(recorder.getNumDropped(), 2);
+
+    auto const events = getEvents(recorder);
+    ASSERT_EQ(events.size(), 3);
+    for (std::size_t i = 0; i < events.size(); ++i)
+    {
+        EXPECT_EQ(events[i]["args"]["iteration"], i + 2);
+    }
+
+    recorder.stop();
+    recorder.recordSpan(TraceRecorder::kITERATION, TraceRecorder::Lane::kITERATION, t0, t0 + 1ms, 5);
+    EXPECT_EQ(getEvents(recorder).size(), 3);
+
+    recorder.start(3);
+    EXPECT_TRUE(getEvents(recorder).empty());
+    EXPECT_EQ(recorder.getNumDropped(), 0);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/uvmPrefetcher.h"
+
+using namespace tensorrt_llm::runtime;
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+
+using Range = UvmPrefetcher::Range;
+
+void expectRanges(std::vector<Range> const& actual, std::vector<Range> const& expected)
+{
+    ASSERT_EQ(actual.size(), expected.size());
+    for (std::size_t i = 0; i < actual.size(); ++i)
+    {
+        EXPECT_EQ(actual[i].begin, expected[i].begin) << i;
+        EXPECT_EQ(actual[i].end, expected[i].end) << i;
+    }
+}
+
+} // namespace
+
+TEST(UvmPrefetcherTest, CoalescesAdjacentAndOverlappingRanges)
+{
+    expectRanges(UvmPrefetcher::coalesce({{300, 400}, {100, 200}, {200, 250}, {350, 500}, {600, 700}}),
+        {{100, 250}, {300, 500}, {600, 700}});
+    expectRanges(UvmPrefetcher::coalesce({}), {});
+}
+
+TEST(UvmPrefetcherTest, SubtractsDeviceRangesFromHostRanges)
+{
+    // A removed range splits a range, covers the end of one and the start of the next, or misses all of them
+    expectRanges(UvmPrefetcher::subtract({{0, 100}, {200, 300}, {400, 500}}, {{40, 60}, {90, 210}, {600, 700}}),
+        {{0, 40}, {60, 90}, {210, 300}, {400, 500}});
+    expectRanges(UvmPrefetcher::subtract({{0, 100}}, {{0, 100}}), {});
+}
+
+TEST(UvmPrefetcherTest, AlignsHostRangesToWholePages)
+{
+    expectRanges(UvmPrefetcher::alignInward({{10, 4096 * 3 + 5}, {4096 * 4, 4096 * 4 + 100}}, 4096),
+        {{4096, 4096 * 3}});
+}
+
+class UvmPrefetcherDeviceTest : public ::testing::Test // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+protected:
+    void SetUp() override
+    {
+        if (tc::getDeviceCount() == 0)
+        {
+            GTEST_SKIP() << "This test suite cannot run on systems with no devices.";
+        }
+    }
+};
+
+TEST_F(UvmPrefetcherDeviceTest, KeepsSharedMemoryOnDevice)
+{
+    std::size_t constexpr pageSize = 64 << 10;
+    auto const buffer = BufferManager::managed(9 * pageSize);
+    // Page aligned, for the host ranges to keep their pages
+    auto const begin = (reinterpret_cast<std::uintptr_t>(buffer->data()) + pageSize - 1) & ~(pageSize - 1);
+    auto const* base = reinterpret_cast<std::uint8_t const*>(begin);
+    UvmPrefetcher prefetcher(tc::getDevice(), pageSize);
+
+    // The blocks of a paused sequence, the second of which a scheduled sequence reuses
+    prefetcher.toHost(base, 4 * pageSize);
+    prefetcher.toDevice(base + 2 * pageSize, pageSize + 10);
+    prefetcher.toDevice(base + 6 * pageSize, 2 * pageSize);
+    auto const plan = prefetcher.takePlan();
+    expectRanges(plan.toDevice,
+        {{begin + 2 * pageSize, begin + 3 * pageSize + 10}, {begin + 6 * pageSize, begin + 8 * pageSize}});
+    // The page holding the end of the device range stays on the device
+    expectRanges(plan.toHost, {{begin, begin + 2 * pageSize}});
+    EXPECT_TRUE(prefetcher.takePlan().toDevice.empty());
+
+    CudaStream stream;
+    prefetcher.toHost(base, 2 * pageSize);
+    prefetcher.toDevice(base + 6 * pageSize, 2 * pageSize);
+    prefetcher.execute(stream);
+    stream.synchronize();
+    int concurrentManagedAccess{0};
+    TLLM_CUDA_CHECK(
+        cudaDeviceGetAttribute(&concurrentManagedAccess, cudaDevAttrConcurrentManagedAccess, tc::getDevice()));
+    EXPECT_EQ(prefetcher.getNumBytesToDevice(), concurrentManagedAccess ? 2 * pageSize : 0);
+    EXPECT_EQ(prefetcher.getNumBytesToHost(), concurrentManagedAccess ? 2 * pageSize : 0);
+}
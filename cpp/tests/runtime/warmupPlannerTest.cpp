@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/warmupPlanner.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+using Batch = WarmupPlanner::Batch;
+} // namespace
+
+TEST(WarmupPlannerTest, PlanWithinLimits)
+{
+    WarmupPlanner::Limits const limits{8, 1024, 1030, 2048, false};
+    auto const batches = WarmupPlanner::plan({1, 8, 16}, {128, 1024, 4096}, 8, limits);
+    EXPECT_EQ(batches, (std::vector<Batch>{{8, 1024, 6}, {1, 1024, 6}, {8, 128, 8}, {1, 128, 8}}));
+}
+
+TEST(WarmupPlannerTest, MaxNumTokensNeedsChunking)
+{
+    WarmupPlanner::Limits limits{4, 4096, 8192, 1024, false};
+    EXPECT_EQ(WarmupPlanner::plan({1}, {512, 2048}, 4, limits), (std::vector<Batch>{{1, 512, 4}}));
+    limits.enableChunkedContext = true;
+    EXPECT_EQ(WarmupPlanner::plan({1}, {512, 2048}, 4, limits), (std::vector<Batch>{{1, 2048, 4}, {1, 512, 4}}));
+}
+
+TEST(WarmupPlannerTest, PhaseTimer)
+{
+    WarmupPlanner planner;
+    EXPECT_ANY_THROW(planner.stopPhase(0));
+    planner.startPhase("context");
+    planner.stopPhase(3);
+    planner.startPhase("generation");
+    auto const stats = planner.finish();
+    ASSERT_EQ(stats.phases.size(), 2);
+    EXPECT_EQ(stats.phases[0].name, "context");
+    EXPECT_EQ(stats.phases[0].numBatches, 3);
+    EXPECT_EQ(stats.phases[1].name, "generation");
+    EXPECT_GE(stats.totalDurationMS, stats.phases[0].durationMS);
+}
+
+} // namespace tensorrt_llm::runtime
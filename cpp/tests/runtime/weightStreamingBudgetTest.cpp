@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/weightStreamingBudget.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+TEST(WeightStreamingBudgetTest, FixedBudget)
+{
+    WeightStreamingBudget budget{1000, 400, std::nullopt, 10};
+    EXPECT_FALSE(budget.isAdaptive());
+    EXPECT_EQ(budget.adapt(10000), std::nullopt);
+    EXPECT_EQ(budget.getBudget(), 400);
+    EXPECT_ANY_THROW(WeightStreamingBudget(1000, 1001, std::nullopt, 10));
+    EXPECT_ANY_THROW(WeightStreamingBudget(0, 0, std::nullopt, 10));
+}
+
+TEST(WeightStreamingBudgetTest, AdaptToFreeMemory)
+{
+    WeightStreamingBudget budget{1000, 400, 100, 50};
+    // Grows into the memory over the headroom
+    EXPECT_EQ(budget.adapt(300), 600);
+    // Steps below the minimum are not worth recreating the contexts
+    EXPECT_EQ(budget.adapt(130), std::nullopt);
+    // Shrinks by the missing headroom
+    EXPECT_EQ(budget.adapt(20), 520);
+    // Never below nothing or above everything
+    EXPECT_EQ(budget.adapt(0), 420);
+    EXPECT_EQ(budget.adapt(-1000), 0);
+    EXPECT_EQ(budget.adapt(5000), 1000);
+    // The last small step to streaming nothing is taken
+    EXPECT_EQ(budget.adapt(20), 920);
+    EXPECT_EQ(budget.adapt(160), 980);
+    EXPECT_EQ(budget.adapt(130), 1000);
+}
+
+TEST(WeightStreamingBudgetTest, StreamedBytes)
+{
+    WeightStreamingBudget budget{1000, 400, 0, 1};
+    budget.onForward();
+    budget.onForward();
+    EXPECT_EQ(budget.adapt(300), 700);
+    budget.onForward();
+    auto stats = budget.takeStats();
+    EXPECT_EQ(stats.streamableBytes, 1000);
+    EXPECT_EQ(stats.budgetBytes, 700);
+    EXPECT_EQ(stats.numForwards, 3);
+    EXPECT_EQ(stats.streamedBytes, 2 * 600 + 300);
+    EXPECT_EQ(stats.numBudgetChanges, 1);
+
+    stats = budget.takeStats();
+    EXPECT_EQ(stats.numForwards, 0);
+    EXPECT_EQ(stats.streamedBytes, 0);
+    EXPECT_EQ(stats.numBudgetChanges, 0);
+}
+
+} // namespace tensorrt_llm::runtime
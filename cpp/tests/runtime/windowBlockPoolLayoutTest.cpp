@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/windowBlockPoolLayout.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+TEST(WindowBlockPoolLayoutTest, GroupsLayersByWindow)
+{
+    // Interleaved sliding window and global layers
+    WindowBlockPoolLayout layout{{256, 4096}, 6, 64, 4096};
+    ASSERT_EQ(layout.getNumPools(), 2);
+
+    auto const& pools = layout.getPools();
+    EXPECT_EQ(pools[0].windowSize, 256);
+    EXPECT_EQ(pools[0].layers, (std::vector<SizeType32>{0, 2, 4}));
+    EXPECT_TRUE(pools[0].isCyclic);
+    EXPECT_EQ(pools[0].blocksPerSequence, 5);
+
+    EXPECT_EQ(pools[1].windowSize, 4096);
+    EXPECT_EQ(pools[1].layers, (std::vector<SizeType32>{1, 3, 5}));
+    EXPECT_FALSE(pools[1].isCyclic);
+    EXPECT_EQ(pools[1].blocksPerSequence, 64);
+
+    EXPECT_EQ(layout.getPoolIdx(2), 0);
+    EXPECT_EQ(layout.getPoolIdx(3), 1);
+}
+
+TEST(WindowBlockPoolLayoutTest, WindowsAreClampedToSequenceLength)
+{
+    WindowBlockPoolLayout layout{{8192, 16384}, 2, 64, 4096};
+    ASSERT_EQ(layout.getNumPools(), 1);
+    EXPECT_FALSE(layout.getPools()[0].isCyclic);
+    EXPECT_EQ(layout.getPools()[0].layers.size(), 2);
+}
+
+TEST(WindowBlockPoolLayoutTest, AllocateBlocks)
+{
+    std::size_t constexpr bytesPerLayerBlock = 1024;
+    WindowBlockPoolLayout layout{{256, 4096}, 6, 64, 4096};
+    std::size_t const singlePoolBytesPerSequence = 6 * 64 * bytesPerLayerBlock;
+    EXPECT_EQ(layout.getBytesPerSequence(bytesPerLayerBlock), 3 * (5 + 64) * bytesPerLayerBlock);
+
+    auto const budget = 100 * singlePoolBytesPerSequence;
+    layout.allocateBlocks(budget, bytesPerLayerBlock);
+    // A single pool would hold 100 sequences, splitting by window almost doubles that
+    EXPECT_EQ(layout.getMaxNumSequences(), 185);
+
+    std::size_t usedBytes{0};
+    for (auto const& pool : layout.getPools())
+    {
+        usedBytes += pool.layers.size() * pool.numBlocks * bytesPerLayerBlock;
+    }
+    EXPECT_LE(usedBytes, budget);
+}
+
+TEST(WindowBlockPoolLayoutTest, CyclicBlockIdx)
+{
+    WindowBlockPoolLayout layout{{128, 1024}, 2, 64, 1024};
+    auto const& cyclic = layout.getPools()[0];
+    auto const& full = layout.getPools()[1];
+    ASSERT_EQ(cyclic.blocksPerSequence, 3);
+
+    EXPECT_EQ(WindowBlockPoolLayout::getCyclicBlockIdx(0, 64, cyclic), 0);
+    EXPECT_EQ(WindowBlockPoolLayout::getCyclicBlockIdx(191, 64, cyclic), 2);
+    EXPECT_EQ(WindowBlockPoolLayout::getCyclicBlockIdx(192, 64, cyclic), 0);
+    EXPECT_EQ(WindowBlockPoolLayout::getCyclicBlockIdx(192, 64, full), 3);
+}
+
+} // namespace tensorrt_llm::runtime
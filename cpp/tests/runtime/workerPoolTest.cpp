@@ -17,7 +17,12 @@
 #include "tensorrt_llm/runtime/workerPool.h"
 
 #include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
 #include <random>
+#include <vector>
 
 namespace tensorrt_llm::runtime
 {
@@ -70,6 +75,91 @@ TEST(WorkerPool, voidReturn)
     EXPECT_EQ(returnVal3, 10003);
 }
 
+TEST(WorkerPool, priorities)
+{
+    WorkerPool pool(1);
+
+    std::promise<void> gate;
+    auto blocker = pool.enqueue([opened = gate.get_future().share()]() { opened.wait(); });
+
+    std::mutex orderMutex;
+    std::vector<int> order;
+    auto record = [&](int value)
+    {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        order.push_back(value);
+    };
+    auto low = pool.enqueue([&]() { record(2); }, WorkerPool::Priority::kLOW);
+    auto normal1 = pool.enqueue([&]() { record(1); });
+    auto normal2 = pool.enqueue([&]() { record(11); });
+    auto high = pool.enqueue([&]() { record(0); }, WorkerPool::Priority::kHIGH);
+    EXPECT_EQ(pool.getNumPendingTasks(), 4);
+
+    gate.set_value();
+    low.get();
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 11, 2}));
+    EXPECT_EQ(pool.getNumPendingTasks(), 0);
+}
+
+TEST(WorkerPool, stealsNestedTasks)
+{
+    WorkerPool pool(2);
+
+    // The outer task blocks its worker until the tasks it queued on its own worker are done, so another worker has to
+    // steal them.
+    auto outer = pool.enqueue(
+        [&pool]()
+        {
+            std::vector<std::future<int>> inner;
+            for (int i = 0; i < 16; ++i)
+            {
+                inner.push_back(pool.enqueue([i]() { return i; }));
+            }
+            int sum = 0;
+            for (auto& f : inner)
+            {
+                sum += f.get();
+            }
+            return sum;
+        });
+    EXPECT_EQ(outer.get(), 120);
+}
+
+TEST(WorkerPool, detachedAndLargeTasks)
+{
+    std::atomic<int> counter{0};
+    {
+        WorkerPool pool(4);
+        for (int i = 0; i < 100; ++i)
+        {
+            pool.enqueueDetached([&counter]() { ++counter; });
+        }
+        pool.enqueueDetached([]() { throw std::runtime_error("logged, not rethrown"); });
+
+        // Does not fit inline and is move-only
+        std::array<char, 4 * WorkerPool::Task::kInlineSize> large{};
+        large.back() = 7;
+        auto f = pool.enqueue([large, owned = std::make_unique<int>(35)]() { return large.back() + *owned; });
+        EXPECT_EQ(f.get(), 42);
+    }
+    // Queued tasks are drained before the pool is destroyed
+    EXPECT_EQ(counter, 100);
+}
+
+TEST(WorkerPool, exceptionsPropagate)
+{
+    WorkerPool pool(1);
+    auto f = pool.enqueue([]() -> int { throw std::runtime_error("failed"); });
+    EXPECT_THROW(f.get(), std::runtime_error);
+}
+
+TEST(WorkerPool, parseCpuList)
+{
+    EXPECT_EQ(WorkerPool::parseCpuList("0-3,8,10-11\n"), (std::vector<std::int32_t>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(WorkerPool::parseCpuList("5"), (std::vector<std::int32_t>{5}));
+    EXPECT_TRUE(WorkerPool::parseCpuList("").empty());
+}
+
 class WorkerPoolTest : public ::testing::TestWithParam<std::tuple<int, int>>
 {
 protected:
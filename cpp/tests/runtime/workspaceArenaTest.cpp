@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/workspaceArena.h"
+#include "tensorrt_llm/common/tllmException.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorrt_llm::runtime
+{
+
+TEST(WorkspaceArenaTest, DisjointLifetimesAlias)
+{
+    WorkspaceArena arena{128};
+    auto const a = arena.addBlock(1000, 0);
+    auto const b = arena.addBlock(300, 1);
+    auto const c = arena.addBlock(2000, 2);
+    EXPECT_EQ(arena.getOffset(a), 0);
+    EXPECT_EQ(arena.getOffset(b), 0);
+    EXPECT_EQ(arena.getOffset(c), 0);
+    EXPECT_EQ(arena.getTotalSize(), 2048);
+    EXPECT_EQ(arena.getUnsharedSize(), 1024 + 384 + 2048);
+}
+
+TEST(WorkspaceArenaTest, OverlappingLifetimesDoNotAlias)
+{
+    WorkspaceArena arena{128};
+    // a is alive across all phases, e.g. the runtime logits handed from one layer to the next
+    auto const a = arena.addBlock(256, 0, 2);
+    auto const b = arena.addBlock(1024, 0);
+    auto const c = arena.addBlock(512, 1);
+    auto const d = arena.addBlock(128, 1);
+
+    EXPECT_EQ(arena.getOffset(b), 0);
+    EXPECT_EQ(arena.getOffset(a), 1024);
+    EXPECT_EQ(arena.getOffset(c), 0);
+    EXPECT_EQ(arena.getOffset(d), 512);
+    EXPECT_EQ(arena.getTotalSize(), 1280);
+
+    // Blocks added later trigger a new plan
+    auto const e = arena.addBlock(4096, 2);
+    EXPECT_EQ(arena.getOffset(e), 0);
+    EXPECT_EQ(arena.getOffset(a), 4096);
+    EXPECT_EQ(arena.getTotalSize(), 4096 + 256);
+
+    std::int8_t base[1];
+    EXPECT_EQ(arena.getPointer<std::int8_t>(base, a), base + 4096);
+}
+
+TEST(WorkspaceArenaTest, FillsGaps)
+{
+    WorkspaceArena arena{1};
+    arena.addBlock(100, 0, 1);
+    arena.addBlock(50, 0);
+    auto const small = arena.addBlock(30, 1);
+    // The blocks of phases 0 and 1 both sit after the long-lived one and alias each other
+    EXPECT_EQ(arena.getOffset(small), 100);
+    EXPECT_EQ(arena.getTotalSize(), 150);
+    EXPECT_THROW(arena.addBlock(10, 2, 1), common::TllmException);
+}
+
+} // namespace tensorrt_llm::runtime